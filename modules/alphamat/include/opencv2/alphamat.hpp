@@ -29,11 +29,17 @@ namespace cv { namespace alphamat {
  * @param image Input RGB image
  * @param tmap Input greyscale trimap image
  * @param result Output alpha matte image
+ * @param tolerance Relative residual at which the preconditioned conjugate gradient solver stops, 0 runs it until maxIterations
+ * @param maxIterations Maximum number of iterations of the solver
+ * @param maxUnknownPixels If the unknown region has more pixels, the matte is computed on a downscaled image where it has about maxUnknownPixels pixels and then upscaled, 0 always solves at full resolution
  *
  * The function infoFlow performs alpha matting on a RGB image using a greyscale trimap image, and outputs a greyscale alpha matte image. The output alpha matte can be used to softly extract the foreground object from a background image. Examples can be found in the samples directory.
  *
+ * The time and memory grow with the size of the image, for large images a tolerance around 1e-5 and a limit of a few hundred thousand unknown pixels keep them reasonable.
+ *
  */
-CV_EXPORTS_W void infoFlow(InputArray image, InputArray tmap, OutputArray result);
+CV_EXPORTS_W void infoFlow(InputArray image, InputArray tmap, OutputArray result,
+                           double tolerance = 0, int maxIterations = 500, int maxUnknownPixels = 0);
 
 //! @}
 }}  // namespace
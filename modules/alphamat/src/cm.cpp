@@ -9,138 +9,112 @@
 namespace cv { namespace alphamat {
 
 static
-void generateFVectorCM(my_vector_of_vectors_t& samples, Mat& img)
+void generateFVectorCM(Mat& samples, Mat& img)
 {
     int nRows = img.rows;
     int nCols = img.cols;
 
-    samples.resize(nRows * nCols);
+    samples.create(nRows * nCols, ALPHAMAT_DIM, CV_64FC1);
 
-    int i, j;
-
-    for (i = 0; i < nRows; ++i)
+    parallel_for_(Range(0, nRows), [&](const Range& range)
     {
-        for (j = 0; j < nCols; ++j)
+        for (int i = range.start; i < range.end; ++i)
         {
-            samples[i * nCols + j].resize(ALPHAMAT_DIM);
-            samples[i * nCols + j][0] = img.at<cv::Vec3b>(i, j)[0] / 255.0;
-            samples[i * nCols + j][1] = img.at<cv::Vec3b>(i, j)[1] / 255.0;
-            samples[i * nCols + j][2] = img.at<cv::Vec3b>(i, j)[2] / 255.0;
-            samples[i * nCols + j][3] = double(i) / nRows;
-            samples[i * nCols + j][4] = double(j) / nCols;
+            const cv::Vec3b* row = img.ptr<cv::Vec3b>(i);
+            for (int j = 0; j < nCols; ++j)
+            {
+                double* s = samples.ptr<double>(i * nCols + j);
+                s[0] = row[j][0] / 255.0;
+                s[1] = row[j][1] / 255.0;
+                s[2] = row[j][2] / 255.0;
+                s[3] = double(i) / nRows;
+                s[4] = double(j) / nCols;
+            }
         }
-    }
+    });
 }
 
 static
-void kdtree_CM(Mat& img, my_vector_of_vectors_t& indm, my_vector_of_vectors_t& samples, std::unordered_set<int>& unk)
+void kdtree_CM(Mat& img, std::vector<int>& indm, Mat& samples, const std::vector<int>& unk)
 {
     // Generate feature vectors for intra U:
     generateFVectorCM(samples, img);
 
     // Query point: same as samples from which KD tree is generated
-
-    // construct a kd-tree index:
-    // Dimensionality set at run-time (default: L2)
-    // ------------------------------------------------------------
-    typedef KDTreeVectorOfVectorsAdaptor<my_vector_of_vectors_t, double> my_kd_tree_t;
-    my_kd_tree_t mat_index(ALPHAMAT_DIM /*dim*/, samples, 10 /* max leaf */);
-    mat_index.index->buildIndex();
-
     // do a knn search with cm = 20
-    const size_t num_results = 20 + 1;
-
-    int N = unk.size();
-
-    std::vector<size_t> ret_indexes(num_results);
-    std::vector<double> out_dists_sqr(num_results);
-    nanoflann::KNNResultSet<double> resultSet(num_results);
-
-    indm.resize(N);
-    int i = 0;
-    for (std::unordered_set<int>::iterator it = unk.begin(); it != unk.end(); it++)
-    {
-        resultSet.init(&ret_indexes[0], &out_dists_sqr[0]);
-        mat_index.index->findNeighbors(resultSet, &samples[*it][0], nanoflann::SearchParams(10));
-
-        indm[i].resize(num_results - 1);
-        for (std::size_t j = 1; j < num_results; j++)
-        {
-            indm[i][j - 1] = ret_indexes[j];
-        }
-        i++;
-    }
+    knnSearch(samples, unk, 20, indm);
 }
 
 static
-void lle(my_vector_of_vectors_t& indm, my_vector_of_vectors_t& samples, float eps, std::unordered_set<int>& unk,
+void lle(std::vector<int>& indm, Mat& samples, float eps, const std::vector<int>& unk,
         SparseMatrix<double>& Wcm, SparseMatrix<double>& Dcm, Mat& img)
 {
     CV_LOG_INFO(NULL, "ALPHAMAT: In cm's lle function");
-    int k = indm[0].size();  //number of neighbours that we are considering
-    int n = indm.size();  //number of unknown pixels
+    int n = (int)unk.size();  //number of unknown pixels
+    if (n == 0)
+        return;
+    int k = (int)(indm.size() / n);  //number of neighbours that we are considering
 
+    // the weights of every unknown pixel fill their own slots, so the triplets keep the order of the serial loop
     typedef Triplet<double> T;
-    std::vector<T> triplets, td;
+    std::vector<T> triplets((size_t)n * k), td((size_t)n * k);
 
-    my_vector_of_vectors_t wcm;
-    wcm.resize(n);
-
-    Mat C(20, 20, DataType<float>::type), rhs(20, 1, DataType<float>::type), Z(3, 20, DataType<float>::type), weights(20, 1, DataType<float>::type), pt(3, 1, DataType<float>::type);
-    Mat ptDotN(20, 1, DataType<float>::type), imd(20, 1, DataType<float>::type);
-    Mat Cones(20, 1, DataType<float>::type), Cinv(20, 1, DataType<float>::type);
-    float alpha, beta, lagrangeMult;
-    Cones.setTo(cv::Scalar::all(1));
-
-    C.setTo(cv::Scalar::all(0));
-    rhs = 1;
-
-    int i, ind = 0;
-    for (std::unordered_set<int>::iterator it = unk.begin(); it != unk.end(); it++)
+    parallel_for_(Range(0, n), [&](const Range& range)
     {
-        // filling values in Z
-        i = *it;
+        Mat C(20, 20, DataType<float>::type), Z(3, 20, DataType<float>::type), weights(20, 1, DataType<float>::type), pt(3, 1, DataType<float>::type);
+        Mat ptDotN(20, 1, DataType<float>::type), imd(20, 1, DataType<float>::type);
+        Mat Cones(20, 1, DataType<float>::type), Cinv(20, 1, DataType<float>::type);
+        float alpha, beta, lagrangeMult;
+        Cones.setTo(cv::Scalar::all(1));
+
+        C.setTo(cv::Scalar::all(0));
 
-        int index_nbr;
-        for (int j = 0; j < k; j++)
+        for (int ind = range.start; ind < range.end; ind++)
         {
-            index_nbr = indm[ind][j];
-            for (int p = 0; p < ALPHAMAT_DIM - 2; p++)
+            // filling values in Z
+            int i = unk[ind];
+            const int* nbrs = &indm[(size_t)ind * k];
+
+            for (int j = 0; j < k; j++)
             {
-                Z.at<float>(p, j) = samples[index_nbr][p];
+                const double* s = samples.ptr<double>(nbrs[j]);
+                for (int p = 0; p < ALPHAMAT_DIM - 2; p++)
+                {
+                    Z.at<float>(p, j) = s[p];
+                }
             }
-        }
-        pt.at<float>(0, 0) = samples[i][0];
-        pt.at<float>(1, 0) = samples[i][1];
-        pt.at<float>(2, 0) = samples[i][2];
+            const double* si = samples.ptr<double>(i);
+            pt.at<float>(0, 0) = si[0];
+            pt.at<float>(1, 0) = si[1];
+            pt.at<float>(2, 0) = si[2];
 
-        C = Z.t() * Z;
-        for (int p = 0; p < k; p++)
-        {
-            C.at<float>(p, p) += eps;
-        }
+            C = Z.t() * Z;
+            for (int p = 0; p < k; p++)
+            {
+                C.at<float>(p, p) += eps;
+            }
 
-        ptDotN = Z.t() * pt;
-        solve(C, ptDotN, imd);
-        alpha = 1 - cv::sum(imd)[0];
-        solve(C, Cones, Cinv);
-        beta = cv::sum(Cinv)[0];  //% sum of elements of inv(corr)
-        lagrangeMult = alpha / beta;
-        solve(C, ptDotN + lagrangeMult * Cones, weights);
+            ptDotN = Z.t() * pt;
+            solve(C, ptDotN, imd);
+            alpha = 1 - cv::sum(imd)[0];
+            solve(C, Cones, Cinv);
+            beta = cv::sum(Cinv)[0];  //% sum of elements of inv(corr)
+            lagrangeMult = alpha / beta;
+            solve(C, ptDotN + lagrangeMult * Cones, weights);
 
-        float sum = cv::sum(weights)[0];
-        weights = weights / sum;
+            float sum = cv::sum(weights)[0];
+            weights = weights / sum;
 
-        int cMaj_i = findColMajorInd(i, img.rows, img.cols);
+            int cMaj_i = findColMajorInd(i, img.rows, img.cols);
 
-        for (int j = 0; j < k; j++)
-        {
-            int cMaj_ind_j = findColMajorInd(indm[ind][j], img.rows, img.cols);
-            triplets.push_back(T(cMaj_i, cMaj_ind_j, weights.at<float>(j, 0)));
-            td.push_back(T(cMaj_i, cMaj_i, weights.at<float>(j, 0)));
+            for (int j = 0; j < k; j++)
+            {
+                int cMaj_ind_j = findColMajorInd(nbrs[j], img.rows, img.cols);
+                triplets[(size_t)ind * k + j] = T(cMaj_i, cMaj_ind_j, weights.at<float>(j, 0));
+                td[(size_t)ind * k + j] = T(cMaj_i, cMaj_i, weights.at<float>(j, 0));
+            }
         }
-        ind++;
-    }
+    });
 
     Wcm.setFromTriplets(triplets.begin(), triplets.end());
     Dcm.setFromTriplets(td.begin(), td.end());
@@ -148,17 +122,18 @@ void lle(my_vector_of_vectors_t& indm, my_vector_of_vectors_t& samples, float ep
 
 void cm(Mat& image, Mat& tmap, SparseMatrix<double>& Wcm, SparseMatrix<double>& Dcm)
 {
-    my_vector_of_vectors_t samples, indm, Euu;
+    Mat samples;
+    std::vector<int> indm;
 
-    int i, j;
-    std::unordered_set<int> unk;
-    for (i = 0; i < tmap.rows; i++)
+    // unknown pixels in row major order
+    std::vector<int> unk;
+    for (int i = 0; i < tmap.rows; i++)
     {
-        for (j = 0; j < tmap.cols; j++)
+        const uchar* row = tmap.ptr<uchar>(i);
+        for (int j = 0; j < tmap.cols; j++)
         {
-            uchar pix = tmap.at<uchar>(i, j);
-            if (pix == 128)
-                unk.insert(i * tmap.cols + j);
+            if (row[j] == 128)
+                unk.push_back(i * tmap.cols + j);
         }
     }
 
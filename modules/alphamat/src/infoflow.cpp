@@ -11,56 +11,65 @@ using namespace Eigen;
 namespace cv { namespace alphamat {
 
 static
-void solve(SparseMatrix<double> Wcm, SparseMatrix<double> Wuu, SparseMatrix<double> Wl, SparseMatrix<double> Dcm,
-        SparseMatrix<double> Duu, SparseMatrix<double> Dl, SparseMatrix<double> T,
-        Mat& wf, Mat& alpha)
+void solve(const SparseMatrix<double>& A, const VectorXd& b, const VectorXd& guess,
+        double tolerance, int maxIterations, Mat& alpha)
 {
-    float suu = 0.01, sl = 0.1, lamd = 100;
-
-    SparseMatrix<double> Lifm = ((Dcm - Wcm).transpose()) * (Dcm - Wcm) + sl * (Dl - Wl) + suu * (Duu - Wuu);
-
-    SparseMatrix<double> A;
-    int n = wf.rows;
-    VectorXd b(n), x(n);
-
-    Eigen::VectorXd wf_;
-    cv2eigen(wf, wf_);
-
-    A = Lifm + lamd * T;
-    b = (lamd * T) * (wf_);
-
-    ConjugateGradient<SparseMatrix<double>, Lower | Upper> cg;
+    // Jacobi preconditioned conjugate gradient, started from the alpha of the known pixels
+    ConjugateGradient<SparseMatrix<double>, Lower | Upper, DiagonalPreconditioner<double> > cg;
 
-    cg.setMaxIterations(500);
+    cg.setMaxIterations(maxIterations);
+    if (tolerance > 0)
+        cg.setTolerance(tolerance);
     cg.compute(A);
-    x = cg.solve(b);
+    VectorXd x = cg.solveWithGuess(b, guess);
     CV_LOG_INFO(NULL, "ALPHAMAT: #iterations:     " << cg.iterations());
     CV_LOG_INFO(NULL, "ALPHAMAT: estimated error: " << cg.error());
 
     int nRows = alpha.rows;
     int nCols = alpha.cols;
-    float pix_alpha;
-    for (int j = 0; j < nCols; ++j)
+    parallel_for_(Range(0, nRows), [&](const Range& range)
     {
-        for (int i = 0; i < nRows; ++i)
+        for (int i = range.start; i < range.end; ++i)
         {
-            pix_alpha = x(i + j * nRows);
-            if (pix_alpha < 0)
-                pix_alpha = 0;
-            if (pix_alpha > 1)
-                pix_alpha = 1;
-            alpha.at<uchar>(i, j) = uchar(pix_alpha * 255);
+            uchar* row = alpha.ptr<uchar>(i);
+            for (int j = 0; j < nCols; ++j)
+            {
+                float pix_alpha = x(i + j * nRows);
+                if (pix_alpha < 0)
+                    pix_alpha = 0;
+                if (pix_alpha > 1)
+                    pix_alpha = 1;
+                row[j] = uchar(pix_alpha * 255);
+            }
         }
-    }
+    });
 }
 
-void infoFlow(InputArray image_ia, InputArray tmap_ia, OutputArray result)
+//! maps the trimap to 0 (background), 128 (unknown) and 255 (foreground)
+static
+void preprocessTrimap(const Mat& src, Mat& dst)
 {
-    Mat image = image_ia.getMat();
-    Mat tmap = tmap_ia.getMat();
-
-    int64 begin = cv::getTickCount();
+    dst.create(src.size(), CV_8UC1);
+    for (int i = 0; i < src.rows; ++i)
+    {
+        const uchar* s = src.ptr<uchar>(i);
+        uchar* d = dst.ptr<uchar>(i);
+        for (int j = 0; j < src.cols; ++j)
+        {
+            uchar pix = s[j];
+            if (pix <= 0.2f * 255)
+                d[j] = 0;
+            else if (pix >= 0.8f * 255)
+                d[j] = 255;
+            else
+                d[j] = 128;
+        }
+    }
+}
 
+static
+void infoFlowSolve(Mat& image, Mat& tmap, Mat& alpha, double tolerance, int maxIterations)
+{
     int nRows = image.rows;
     int nCols = image.cols;
     int N = nRows * nCols;
@@ -68,23 +77,9 @@ void infoFlow(InputArray image_ia, InputArray tmap_ia, OutputArray result)
     SparseMatrix<double> T(N, N);
     typedef Triplet<double> Tr;
     std::vector<Tr> triplets;
+    triplets.reserve(N);
 
-    //Pre-process trimap
-    for (int i = 0; i < nRows; ++i)
-    {
-        for (int j = 0; j < nCols; ++j)
-        {
-            uchar& pix = tmap.at<uchar>(i, j);
-            if (pix <= 0.2f * 255)
-                pix = 0;
-            else if (pix >= 0.8f * 255)
-                pix = 255;
-            else
-                pix = 128;
-        }
-    }
-
-    Mat wf = Mat::zeros(nRows * nCols, 1, CV_8U);
+    VectorXd wf_(N);
 
     // Column Major Interpretation for working with SparseMatrix
     for (int i = 0; i < nRows; ++i)
@@ -97,33 +92,76 @@ void infoFlow(InputArray image_ia, InputArray tmap_ia, OutputArray result)
             triplets.push_back(Tr(i + j * nRows, i + j * nRows, (pix != 128) ? 1 : 0));
 
             // foreground pixel
-            wf.at<uchar>(i + j * nRows, 0) = (pix > 200) ? 1 : 0;
+            wf_(i + j * nRows) = (pix > 200) ? 1 : 0;
         }
     }
+    T.setFromTriplets(triplets.begin(), triplets.end());
+    std::vector<Tr>().swap(triplets);
 
-    SparseMatrix<double> Wl(N, N), Dl(N, N);
-    local_info(image, tmap, Wl, Dl);
+    float suu = 0.01, sl = 0.1, lamd = 100;
 
-    SparseMatrix<double> Wcm(N, N), Dcm(N, N);
-    cm(image, tmap, Wcm, Dcm);
+    SparseMatrix<double> A;
+    {
+        // the affinities are only needed to build the system
+        SparseMatrix<double> Wl(N, N), Dl(N, N);
+        local_info(image, tmap, Wl, Dl);
 
-    Mat new_tmap = tmap.clone();
+        SparseMatrix<double> Wcm(N, N), Dcm(N, N);
+        cm(image, tmap, Wcm, Dcm);
 
-    SparseMatrix<double> Wuu(N, N), Duu(N, N);
-    Mat image_t = image.t();
-    Mat tmap_t = tmap.t();
-    UU(image, tmap, Wuu, Duu);
+        SparseMatrix<double> Wuu(N, N), Duu(N, N);
+        UU(image, tmap, Wuu, Duu);
 
-    double elapsed_secs = ((double)(getTickCount() - begin)) / getTickFrequency();
+        SparseMatrix<double> Lcm = Dcm - Wcm;
+        A = (Lcm.transpose()) * Lcm + sl * (Dl - Wl) + suu * (Duu - Wuu) + lamd * T;
+    }
+    VectorXd b = (lamd * T) * (wf_);
 
-    T.setFromTriplets(triplets.begin(), triplets.end());
+    alpha.create(nRows, nCols, CV_8UC1);
+    solve(A, b, wf_, tolerance, maxIterations, alpha);
+}
+
+void infoFlow(InputArray image_ia, InputArray tmap_ia, OutputArray result,
+        double tolerance, int maxIterations, int maxUnknownPixels)
+{
+    Mat image = image_ia.getMat();
+    Mat tmap;
+    CV_Assert(image.type() == CV_8UC3 && tmap_ia.type() == CV_8UC1 && image.size() == tmap_ia.size());
+    CV_Assert(tolerance >= 0 && maxIterations > 0 && maxUnknownPixels >= 0);
 
-    Mat alpha = Mat::zeros(nRows, nCols, CV_8UC1);
-    solve(Wcm, Wuu, Wl, Dcm, Duu, Dl, T, wf, alpha);
+    int64 begin = cv::getTickCount();
+
+    //Pre-process trimap
+    preprocessTrimap(tmap_ia.getMat(), tmap);
+
+    Mat alpha;
+    int numUnknown = countNonZero(tmap == 128);
+    if (maxUnknownPixels > 0 && numUnknown > maxUnknownPixels)
+    {
+        // solve at the scale where the unknown region has about maxUnknownPixels pixels
+        double scale = std::sqrt((double)maxUnknownPixels / numUnknown);
+        Size small(std::max(cvRound(image.cols * scale), 3), std::max(cvRound(image.rows * scale), 3));
+        CV_LOG_INFO(NULL, "ALPHAMAT: solving at " << small.width << "x" << small.height);
+
+        Mat image_s, tmap_s, alpha_s;
+        resize(image, image_s, small, 0, 0, INTER_AREA);
+        resize(tmap, tmap_s, small, 0, 0, INTER_AREA);
+        preprocessTrimap(tmap_s, tmap_s);
+        infoFlowSolve(image_s, tmap_s, alpha_s, tolerance, maxIterations);
+
+        // the known pixels keep the value of the full resolution trimap
+        resize(alpha_s, alpha, image.size(), 0, 0, INTER_LINEAR);
+        alpha.setTo(0, tmap == 0);
+        alpha.setTo(255, tmap == 255);
+    }
+    else
+    {
+        infoFlowSolve(image, tmap, alpha, tolerance, maxIterations);
+    }
 
     alpha.copyTo(result);
 
-    elapsed_secs = ((double)(getTickCount() - begin)) / getTickFrequency();
+    double elapsed_secs = ((double)(getTickCount() - begin)) / getTickFrequency();
     CV_LOG_INFO(NULL, "ALPHAMAT: total time: " << elapsed_secs);
 }
 
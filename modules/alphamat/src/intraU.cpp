@@ -14,8 +14,38 @@ int findColMajorInd(int rowMajorInd, int nRows, int nCols)
     return (jInd * nRows + iInd);
 }
 
+void knnSearch(const Mat& samples, const std::vector<int>& queries, int k, std::vector<int>& indm)
+{
+    CV_Assert(samples.type() == CV_64FC1 && samples.cols == ALPHAMAT_DIM && samples.isContinuous());
+
+    // construct a kd-tree index once, the searches only read it
+    KDTreeMatAdaptor adaptor(samples);
+    KDTreeMatAdaptor::index_t index(ALPHAMAT_DIM /*dim*/, adaptor, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
+    index.buildIndex();
+
+    // the closest point is the query itself
+    const size_t num_results = k + 1;
+    const int N = (int)queries.size();
+    indm.resize((size_t)N * k);
+    parallel_for_(Range(0, N), [&](const Range& range)
+    {
+        std::vector<size_t> ret_indexes(num_results);
+        std::vector<double> out_dists_sqr(num_results);
+        nanoflann::KNNResultSet<double> resultSet(num_results);
+        for (int i = range.start; i < range.end; i++)
+        {
+            resultSet.init(&ret_indexes[0], &out_dists_sqr[0]);
+            index.findNeighbors(resultSet, samples.ptr<double>(queries[i]), nanoflann::SearchParams(10));
+
+            int* nbrs = &indm[(size_t)i * k];
+            for (std::size_t j = 1; j < num_results; j++)
+                nbrs[j - 1] = (int)ret_indexes[j];
+        }
+    });
+}
+
 static
-void generateFVectorIntraU(my_vector_of_vectors_t& samples, Mat& img, Mat& tmap, std::vector<int>& orig_ind)
+void generateFVectorIntraU(Mat& samples, Mat& img, Mat& tmap, std::vector<int>& orig_ind)
 {
     int nRows = img.rows;
     int nCols = img.cols;
@@ -30,7 +60,7 @@ void generateFVectorIntraU(my_vector_of_vectors_t& samples, Mat& img, Mat& tmap,
                 unk_count++;
         }
     }
-    samples.resize(unk_count);
+    samples.create(unk_count, ALPHAMAT_DIM, CV_64FC1);
     orig_ind.resize(unk_count);
 
     int c1 = 0;
@@ -41,12 +71,12 @@ void generateFVectorIntraU(my_vector_of_vectors_t& samples, Mat& img, Mat& tmap,
             uchar pix = tmap.at<uchar>(i, j);
             if (pix == 128)  // collection of unknown pixels samples
             {
-                samples[c1].resize(ALPHAMAT_DIM);
-                samples[c1][0] = img.at<cv::Vec3b>(i, j)[0] / 255.0;
-                samples[c1][1] = img.at<cv::Vec3b>(i, j)[1] / 255.0;
-                samples[c1][2] = img.at<cv::Vec3b>(i, j)[2] / 255.0;
-                samples[c1][3] = (double(i + 1) / nRows) / 20;
-                samples[c1][4] = (double(j + 1) / nCols) / 20;
+                double* s = samples.ptr<double>(c1);
+                s[0] = img.at<cv::Vec3b>(i, j)[0] / 255.0;
+                s[1] = img.at<cv::Vec3b>(i, j)[1] / 255.0;
+                s[2] = img.at<cv::Vec3b>(i, j)[2] / 255.0;
+                s[3] = (double(i + 1) / nRows) / 20;
+                s[4] = (double(j + 1) / nCols) / 20;
                 orig_ind[c1] = i * nCols + j;
                 c1++;
             }
@@ -57,39 +87,20 @@ void generateFVectorIntraU(my_vector_of_vectors_t& samples, Mat& img, Mat& tmap,
 }
 
 static
-void kdtree_intraU(Mat& img, Mat& tmap, my_vector_of_vectors_t& indm, my_vector_of_vectors_t& samples, std::vector<int>& orig_ind)
+void kdtree_intraU(Mat& img, Mat& tmap, std::vector<int>& indm, Mat& samples, std::vector<int>& orig_ind)
 {
     // Generate feature vectors for intra U:
     generateFVectorIntraU(samples, img, tmap, orig_ind);
 
-    typedef KDTreeVectorOfVectorsAdaptor<my_vector_of_vectors_t, double> my_kd_tree_t;
-    my_kd_tree_t mat_index(ALPHAMAT_DIM /*dim*/, samples, 10 /* max leaf */);
-    mat_index.index->buildIndex();
-    // do a knn search with ku  = 5
-    const size_t num_results = 5 + 1;
-
-    int N = samples.size();  // no. of unknown samples
-
-    std::vector<size_t> ret_indexes(num_results);
-    std::vector<double> out_dists_sqr(num_results);
-    nanoflann::KNNResultSet<double> resultSet(num_results);
-
-    indm.resize(N);
-    for (int i = 0; i < N; i++)
-    {
-        resultSet.init(&ret_indexes[0], &out_dists_sqr[0]);
-        mat_index.index->findNeighbors(resultSet, &samples[i][0], nanoflann::SearchParams(10));
-
-        indm[i].resize(num_results - 1);
-        for (std::size_t j = 1; j < num_results; j++)
-        {
-            indm[i][j - 1] = ret_indexes[j];
-        }
-    }
+    // do a knn search with ku  = 5, every unknown sample is a query
+    std::vector<int> queries(samples.rows);
+    for (int i = 0; i < samples.rows; i++)
+        queries[i] = i;
+    knnSearch(samples, queries, 5, indm);
 }
 
 static
-double l1norm(std::vector<double>& x, std::vector<double>& y)
+double l1norm(const double* x, const double* y)
 {
     double sum = 0;
     for (int i = 0; i < ALPHAMAT_DIM; i++)
@@ -98,42 +109,46 @@ double l1norm(std::vector<double>& x, std::vector<double>& y)
 }
 
 static
-void intraU(Mat& img, my_vector_of_vectors_t& indm, my_vector_of_vectors_t& samples,
+void intraU(Mat& img, std::vector<int>& indm, Mat& samples,
         std::vector<int>& orig_ind, SparseMatrix<double>& Wuu, SparseMatrix<double>& Duu)
 {
     // input: indm, samples
-    int n = indm.size();  // num of unknown samples
+    int n = samples.rows;  // num of unknown samples
     CV_LOG_INFO(NULL, "ALPHAMAT: num of unknown samples, n : " << n);
+    if (n == 0)
+        return;
+    const int num_nbr = (int)(indm.size() / n);
 
-    int i, j, nbr_ind;
-    for (i = 0; i < n; i++)
+    for (int i = 0; i < n; i++)
     {
-        samples[i][3] *= 1 / 100;
-        samples[i][4] *= 1 / 100;
+        double* s = samples.ptr<double>(i);
+        s[3] *= 1 / 100;
+        s[4] *= 1 / 100;
     }
 
-    my_vector_of_vectors_t weights;
+    // every neighbourhood fills its own slots, so the triplets keep the order of the serial loop
     typedef Triplet<double> T;
-    std::vector<T> triplets, td;
-
-    double weight;
-    for (i = 0; i < n; i++)
+    std::vector<T> triplets((size_t)n * num_nbr * 2), td((size_t)n * num_nbr * 2);
+    parallel_for_(Range(0, n), [&](const Range& range)
     {
-        int num_nbr = indm[i].size();
-        int cMaj_i = findColMajorInd(orig_ind[i], img.rows, img.cols);
-        for (j = 0; j < num_nbr; j++)
+        for (int i = range.start; i < range.end; i++)
         {
-            nbr_ind = indm[i][j];
-            int cMaj_nbr_j = findColMajorInd(orig_ind[nbr_ind], img.rows, img.cols);
-            weight = max(1 - l1norm(samples[i], samples[j]), 0.0);
+            int cMaj_i = findColMajorInd(orig_ind[i], img.rows, img.cols);
+            for (int j = 0; j < num_nbr; j++)
+            {
+                int nbr_ind = indm[(size_t)i * num_nbr + j];
+                int cMaj_nbr_j = findColMajorInd(orig_ind[nbr_ind], img.rows, img.cols);
+                double weight = max(1 - l1norm(samples.ptr<double>(i), samples.ptr<double>(j)), 0.0);
 
-            triplets.push_back(T(cMaj_i, cMaj_nbr_j, weight / 2));
-            td.push_back(T(cMaj_i, cMaj_i, weight / 2));
+                size_t t = ((size_t)i * num_nbr + j) * 2;
+                triplets[t] = T(cMaj_i, cMaj_nbr_j, weight / 2);
+                td[t] = T(cMaj_i, cMaj_i, weight / 2);
 
-            triplets.push_back(T(cMaj_nbr_j, cMaj_i, weight / 2));
-            td.push_back(T(cMaj_nbr_j, cMaj_nbr_j, weight / 2));
+                triplets[t + 1] = T(cMaj_nbr_j, cMaj_i, weight / 2);
+                td[t + 1] = T(cMaj_nbr_j, cMaj_nbr_j, weight / 2);
+            }
         }
-    }
+    });
 
     Wuu.setFromTriplets(triplets.begin(), triplets.end());
     Duu.setFromTriplets(td.begin(), td.end());
@@ -141,8 +156,8 @@ void intraU(Mat& img, my_vector_of_vectors_t& indm, my_vector_of_vectors_t& samp
 
 void UU(Mat& image, Mat& tmap, SparseMatrix<double>& Wuu, SparseMatrix<double>& Duu)
 {
-    my_vector_of_vectors_t samples, indm;
-    std::vector<int> orig_ind;
+    Mat samples;
+    std::vector<int> indm, orig_ind;
 
     kdtree_intraU(image, tmap, indm, samples, orig_ind);
     intraU(image, indm, samples, orig_ind, Wuu, Duu);
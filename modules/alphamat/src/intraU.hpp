@@ -14,8 +14,29 @@ using namespace nanoflann;
 
 typedef std::vector<std::vector<double>> my_vector_of_vectors_t;
 
+/** nanoflann adaptor over the rows of a continuous CV_64F matrix of ALPHAMAT_DIM columns,
+ * so that the feature vectors of all the pixels are stored in a single allocation */
+struct KDTreeMatAdaptor
+{
+    typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Adaptor<double, KDTreeMatAdaptor>,
+            KDTreeMatAdaptor, ALPHAMAT_DIM> index_t;
+
+    explicit KDTreeMatAdaptor(const Mat& samples) : data(samples) {}
+
+    inline size_t kdtree_get_point_count() const { return (size_t)data.rows; }
+    inline double kdtree_get_pt(const size_t idx, const size_t dim) const { return data.ptr<double>((int)idx)[dim]; }
+    template <class BBOX> bool kdtree_get_bbox(BBOX&) const { return false; }
+
+    const Mat& data;
+};
+
 int findColMajorInd(int rowMajorInd, int nRows, int nCols);
 
+/** Finds the k nearest neighbours among the rows of samples of every row listed in queries, the
+ * query itself excluded. The tree is built once and the queries run in parallel, the neighbours
+ * of queries[i] are written to indm[i*k] .. indm[i*k + k - 1]. */
+void knnSearch(const Mat& samples, const std::vector<int>& queries, int k, std::vector<int>& indm);
+
 void UU(Mat& image, Mat& tmap, SparseMatrix<double>& Wuu, SparseMatrix<double>& Duu);
 
 }}  // namespace
@@ -40,73 +40,88 @@ void local_info(Mat& img, Mat& tmap, SparseMatrix<double>& Wl, SparseMatrix<doub
     int num_win = (win_size * 2 + 1) * (win_size * 2 + 1);  // number of pixels in window
     typedef Triplet<double> T;
     std::vector<T> triplets, td, tl;
-    int neighInd[9];
-    int i, j;
-    for (j = win_size; j < nCols - win_size; j++)
+
+    // the columns are processed in parallel into their own lists, appended in the order of the serial loop
+    std::vector<std::vector<T> > colTriplets(std::max(nCols - 2 * win_size, 0));
+    parallel_for_(Range(win_size, std::max(win_size, nCols - win_size)), [&](const Range& range)
     {
-        for (i = win_size; i < nRows - win_size; i++)
+        int neighInd[9];
+        for (int j = range.start; j < range.end; j++)
         {
-            uchar pix = tmap.at<uchar>(i, j);
-            //std::cout << i+j*nRows << " --> " << pix << std::endl;
-            if (pix != 128)
-                continue;
-            // extract the window out of image
-            Mat win = img.rowRange(i - win_size, i + win_size + 1);
-            win = win.colRange(j - win_size, j + win_size + 1);
-            Mat win_ravel = Mat::zeros(9, 3, CV_64F);  // doubt ??
-            double sum1 = 0;
-            double sum2 = 0;
-            double sum3 = 0;
-
-            int c = 0;
-            for (int q = -1; q <= 1; q++)
+            std::vector<T>& colT = colTriplets[j - win_size];
+            for (int i = win_size; i < nRows - win_size; i++)
             {
-                for (int p = -1; p <= 1; p++)
+                uchar pix = tmap.at<uchar>(i, j);
+                if (pix != 128)
+                    continue;
+                // extract the window out of image
+                Mat win = img.rowRange(i - win_size, i + win_size + 1);
+                win = win.colRange(j - win_size, j + win_size + 1);
+                Mat win_ravel = Mat::zeros(9, 3, CV_64F);  // doubt ??
+                double sum1 = 0;
+                double sum2 = 0;
+                double sum3 = 0;
+
+                int c = 0;
+                for (int q = -1; q <= 1; q++)
                 {
-                    neighInd[c] = (j + q) * nRows + (i + p);  // column major
-                    c++;
+                    for (int p = -1; p <= 1; p++)
+                    {
+                        neighInd[c] = (j + q) * nRows + (i + p);  // column major
+                        c++;
+                    }
                 }
-            }
 
-            c = 0;
-            //parsing column major way in the window
-            for (int q = 0; q < win_size * 2 + 1; q++)
-            {
-                for (int p = 0; p < win_size * 2 + 1; p++)
+                c = 0;
+                //parsing column major way in the window
+                for (int q = 0; q < win_size * 2 + 1; q++)
                 {
-                    win_ravel.at<double>(c, 0) = win.at<cv::Vec3b>(p, q)[0] / 255.0;
-                    win_ravel.at<double>(c, 1) = win.at<cv::Vec3b>(p, q)[1] / 255.0;
-                    win_ravel.at<double>(c, 2) = win.at<cv::Vec3b>(p, q)[2] / 255.0;
-                    sum1 += win.at<cv::Vec3b>(p, q)[0] / 255.0;
-                    sum2 += win.at<cv::Vec3b>(p, q)[1] / 255.0;
-                    sum3 += win.at<cv::Vec3b>(p, q)[2] / 255.0;
-                    c++;
+                    for (int p = 0; p < win_size * 2 + 1; p++)
+                    {
+                        win_ravel.at<double>(c, 0) = win.at<cv::Vec3b>(p, q)[0] / 255.0;
+                        win_ravel.at<double>(c, 1) = win.at<cv::Vec3b>(p, q)[1] / 255.0;
+                        win_ravel.at<double>(c, 2) = win.at<cv::Vec3b>(p, q)[2] / 255.0;
+                        sum1 += win.at<cv::Vec3b>(p, q)[0] / 255.0;
+                        sum2 += win.at<cv::Vec3b>(p, q)[1] / 255.0;
+                        sum3 += win.at<cv::Vec3b>(p, q)[2] / 255.0;
+                        c++;
+                    }
                 }
-            }
-            win = win_ravel;
-            Mat win_mean = Mat::zeros(1, 3, CV_64F);
-            win_mean.at<double>(0, 0) = sum1 / num_win;
-            win_mean.at<double>(0, 1) = sum2 / num_win;
-            win_mean.at<double>(0, 2) = sum3 / num_win;
+                win = win_ravel;
+                Mat win_mean = Mat::zeros(1, 3, CV_64F);
+                win_mean.at<double>(0, 0) = sum1 / num_win;
+                win_mean.at<double>(0, 1) = sum2 / num_win;
+                win_mean.at<double>(0, 2) = sum3 / num_win;
 
-            // calculate the covariance matrix
-            Mat covariance = (win.t() * win / num_win) - (win_mean.t() * win_mean);
+                // calculate the covariance matrix
+                Mat covariance = (win.t() * win / num_win) - (win_mean.t() * win_mean);
 
-            Mat I = Mat::eye(img.channels(), img.channels(), CV_64F);
-            Mat I1 = (covariance + (eps / num_win) * I);
-            Mat I1_inv = I1.inv();
+                Mat I = Mat::eye(img.channels(), img.channels(), CV_64F);
+                Mat I1 = (covariance + (eps / num_win) * I);
+                Mat I1_inv = I1.inv();
 
-            Mat X = win - repeat(win_mean, num_win, 1);
-            Mat vals = (1 + X * I1_inv * X.t()) / num_win;
+                Mat X = win - repeat(win_mean, num_win, 1);
+                Mat vals = (1 + X * I1_inv * X.t()) / num_win;
 
-            for (int q = 0; q < num_win; q++)
-            {
-                for (int p = 0; p < num_win; p++)
+                for (int q = 0; q < num_win; q++)
                 {
-                    triplets.push_back(T(neighInd[p], neighInd[q], vals.at<double>(p, q)));
+                    for (int p = 0; p < num_win; p++)
+                    {
+                        colT.push_back(T(neighInd[p], neighInd[q], vals.at<double>(p, q)));
+                    }
                 }
             }
         }
+    });
+
+    size_t total = 0;
+    for (size_t c = 0; c < colTriplets.size(); c++)
+        total += colTriplets[c].size();
+    triplets.reserve(total);
+    for (size_t c = 0; c < colTriplets.size(); c++)
+    {
+        triplets.insert(triplets.end(), colTriplets[c].begin(), colTriplets[c].end());
+        std::vector<T>().swap(colTriplets[c]);
     }
 
     std::vector<T> tsp;
@@ -224,6 +224,62 @@ CV_EXPORTS_W void detectMarkers(InputArray image, const Ptr<Dictionary> &diction
 
 
 
+/**
+ * @brief Marker detector which keeps its internal buffers between detections
+ *
+ * Produces the same results as detectMarkers(), but the grey conversion buffer, the thresholded
+ * images and the candidate containers are owned by the object and reused in consecutive calls.
+ * This avoids most of the per frame allocations when processing video streams.
+ * An ArucoDetector instance must not be used from several threads at the same time, create one
+ * instance per stream instead.
+ * @sa detectMarkers
+ */
+class CV_EXPORTS_W ArucoDetector : public Algorithm {
+    public:
+    /**
+     * @brief Create a detector
+     *
+     * @param dictionary indicates the type of markers that will be searched
+     * @param parameters marker detection parameters
+     */
+    CV_WRAP static Ptr<ArucoDetector> create(const Ptr<Dictionary> &dictionary,
+                                             const Ptr<DetectorParameters> &parameters = DetectorParameters::create());
+
+    /**
+     * @brief Basic marker detection, see detectMarkers() for the description of the parameters
+     */
+    CV_WRAP virtual void detectMarkers(InputArray image, OutputArrayOfArrays corners, OutputArray ids,
+                                       OutputArrayOfArrays rejectedImgPoints = noArray(),
+                                       InputArray cameraMatrix = noArray(), InputArray distCoeff = noArray()) = 0;
+
+    CV_WRAP virtual Ptr<Dictionary> getDictionary() const = 0;
+    CV_WRAP virtual void setDictionary(const Ptr<Dictionary> &dictionary) = 0;
+
+    CV_WRAP virtual Ptr<DetectorParameters> getDetectorParameters() const = 0;
+    CV_WRAP virtual void setDetectorParameters(const Ptr<DetectorParameters> &parameters) = 0;
+
+    /**
+     * @brief Enable or disable the temporal tracking mode (disabled by default)
+     *
+     * @param enabled whether markers of the previous frame are tracked
+     * @param fullSearchInterval a full frame search is done at least once every fullSearchInterval
+     * frames
+     * @param roiMarginRate margin added around the previous corners of each marker to build its
+     * search region. It is defined as a rate respect to the marker size (bounding box side)
+     *
+     * In tracking mode, the markers found in the previous frame are searched only inside small regions
+     * around their previous position, which is much cheaper than a full frame search for static or
+     * slowly moving scenes. Corner refinement is applied inside each region as in a full search.
+     * The detector falls back to a full frame search whenever one of the tracked markers is not found
+     * in its region. New markers entering the scene are reported after the next full frame search.
+     * Rejected candidates are the ones found inside the search regions.
+     */
+    CV_WRAP virtual void setTracking(bool enabled, int fullSearchInterval = 10, float roiMarginRate = 0.5f) = 0;
+    CV_WRAP virtual bool getTracking() const = 0;
+};
+
+
+
 /**
  * @brief Pose estimation for single markers
  *
@@ -257,6 +313,37 @@ CV_EXPORTS_W void estimatePoseSingleMarkers(InputArrayOfArrays corners, float ma
                                             InputArray cameraMatrix, InputArray distCoeffs,
                                             OutputArray rvecs, OutputArray tvecs, OutputArray _objPoints = noArray());
 
+/**
+ * @brief Batched pose estimation for single markers using a closed-form planar solver
+ *
+ * @param corners vector of already detected markers corners, as in estimatePoseSingleMarkers.
+ * @param markerLength the length of the markers' side. The returning translation vectors will
+ * be in the same unit. Normally, unit is meters.
+ * @param cameraMatrix input 3x3 floating-point camera matrix
+ * \f$A = \vecthreethree{f_x}{0}{c_x}{0}{f_y}{c_y}{0}{0}{1}\f$
+ * @param distCoeffs vector of distortion coefficients
+ * \f$(k_1, k_2, p_1, p_2[, k_3[, k_4, k_5, k_6],[s_1, s_2, s_3, s_4]])\f$ of 4, 5, 8 or 12 elements
+ * @param rvecs array of output rotation vectors (@sa Rodrigues) (e.g. std::vector<cv::Vec3d>).
+ * Existing storage of the right size and type (Nx1, CV_64FC3) is reused.
+ * @param tvecs array of output translation vectors (e.g. std::vector<cv::Vec3d>).
+ * Existing storage of the right size and type (Nx1, CV_64FC3) is reused.
+ * @param reprojectionErrors optional output array (Nx1, CV_64F) with the RMS reprojection error of
+ * each marker in pixels. It is measured on the undistorted corners and comes for free with the
+ * solution, no additional projection pass is done.
+ * @param objPoints array of object points of all the marker corners
+ *
+ * Produces the same poses as estimatePoseSingleMarkers, with the same marker coordinate system,
+ * but is meant for many small markers per frame: all the corners are undistorted in a single call
+ * and every pose is computed in closed form with the Infinitesimal Plane-based Pose Estimation
+ * (IPPE) for squares, keeping the solution of the planar ambiguity with the lowest reprojection
+ * error. Markers with degenerate corners fall back to solvePnP.
+ */
+CV_EXPORTS_W void estimatePoseSingleMarkersBatch(InputArrayOfArrays corners, float markerLength,
+                                                 InputArray cameraMatrix, InputArray distCoeffs,
+                                                 OutputArray rvecs, OutputArray tvecs,
+                                                 OutputArray reprojectionErrors = noArray(),
+                                                 OutputArray objPoints = noArray());
+
 
 
 /**
@@ -101,6 +101,11 @@ class CV_EXPORTS_W Dictionary {
     /**
      * @brief Given a matrix of bits. Returns whether if marker is identified or not.
      * It returns by reference the correct id (if any) and the correct rotation
+     *
+     * The first call builds a multi-index hash over bytesList, so the search only checks the
+     * markers sharing at least one exact substring with the input instead of the whole dictionary.
+     * The index is rebuilt if bytesList is reassigned or resized, but not if its bytes are
+     * modified in place.
      */
     bool identify(const Mat &onlyBits, int &idx, int &rotation, double maxCorrectionRate) const;
 
@@ -127,6 +132,12 @@ class CV_EXPORTS_W Dictionary {
       * @brief Transform list of bytes to matrix of bits
       */
     CV_WRAP static Mat getBitsFromByteList(const Mat &byteList, int markerSize);
+
+    private:
+    /// multi-index over the codewords, built on first identify() call
+    struct Index;
+    Ptr<Index> getIndex() const;
+    mutable Ptr<Index> index_;
 };
 
 
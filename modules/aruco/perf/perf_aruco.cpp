@@ -0,0 +1,195 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+CV_ENUM(RefineMethods, aruco::CORNER_REFINE_NONE, aruco::CORNER_REFINE_SUBPIX, aruco::CORNER_REFINE_CONTOUR,
+        aruco::CORNER_REFINE_APRILTAG)
+CV_ENUM(BoardDictionaries, aruco::DICT_6X6_250, aruco::DICT_APRILTAG_36h11)
+
+/**
+ * @brief Render a board image into a frame of the given size, with a mild perspective
+ */
+static Mat renderBoard(const Ptr<aruco::Board> &board, Size frameSize, bool charuco)
+{
+    int side = std::min(frameSize.width, frameSize.height) * 9 / 10;
+    Mat boardImg;
+    if(charuco)
+        board.dynamicCast<aruco::CharucoBoard>()->draw(Size(side, side), boardImg, side / 20, 1);
+    else
+        aruco::drawPlanarBoard(board, Size(side, side), boardImg, side / 20, 1);
+
+    float w = (float)boardImg.cols, h = (float)boardImg.rows;
+    Point2f center(frameSize.width / 2.f, frameSize.height / 2.f);
+    Point2f src[4] = { Point2f(0, 0), Point2f(w, 0), Point2f(w, h), Point2f(0, h) };
+    Point2f dst[4] = { center + Point2f(-0.45f * w, -0.42f * h), center + Point2f(0.42f * w, -0.47f * h),
+                       center + Point2f(0.47f * w, 0.45f * h), center + Point2f(-0.42f * w, 0.42f * h) };
+    Mat frame;
+    warpPerspective(boardImg, frame, getPerspectiveTransform(src, dst), frameSize, INTER_LINEAR,
+                    BORDER_CONSTANT, Scalar::all(255));
+    return frame;
+}
+
+static Mat syntheticCameraMatrix(Size frameSize)
+{
+    double f = frameSize.width;
+    return (Mat_<double>(3, 3) << f, 0, frameSize.width / 2., 0, f, frameSize.height / 2., 0, 0, 1);
+}
+
+typedef tuple< Size, int, BoardDictionaries, RefineMethods > DetectMarkersParams;
+typedef TestBaseWithParam< DetectMarkersParams > ArucoDetectMarkersPerfTest;
+
+PERF_TEST_P(ArucoDetectMarkersPerfTest, detectMarkers,
+            Combine(Values(szVGA, sz720p, sz1080p), Values(4, 8), BoardDictionaries::all(), RefineMethods::all()))
+{
+    const Size frameSize = get<0>(GetParam());
+    const int markersPerSide = get<1>(GetParam());
+    Ptr<aruco::Dictionary> dictionary = aruco::getPredefinedDictionary((int)get<2>(GetParam()));
+    Ptr<aruco::DetectorParameters> params = aruco::DetectorParameters::create();
+    params->cornerRefinementMethod = (int)get<3>(GetParam());
+
+    Ptr<aruco::GridBoard> board = aruco::GridBoard::create(markersPerSide, markersPerSide, 1.f, 0.25f, dictionary);
+    Mat frame = renderBoard(board, frameSize, false);
+
+    vector< vector< Point2f > > corners;
+    vector< int > ids;
+    TEST_CYCLE()
+    {
+        aruco::detectMarkers(frame, dictionary, corners, ids, params);
+    }
+
+    EXPECT_GE(ids.size(), board->ids.size() / 2);
+    SANITY_CHECK_NOTHING();
+}
+
+typedef tuple< Size, BoardDictionaries > ArucoDetectorParams;
+typedef TestBaseWithParam< ArucoDetectorParams > ArucoDetectorPerfTest;
+
+PERF_TEST_P(ArucoDetectorPerfTest, detectMarkers, Combine(Values(szVGA, sz1080p), BoardDictionaries::all()))
+{
+    const Size frameSize = get<0>(GetParam());
+    Ptr<aruco::Dictionary> dictionary = aruco::getPredefinedDictionary((int)get<1>(GetParam()));
+    Ptr<aruco::ArucoDetector> detector = aruco::ArucoDetector::create(dictionary);
+
+    Ptr<aruco::GridBoard> board = aruco::GridBoard::create(8, 8, 1.f, 0.25f, dictionary);
+    Mat frame = renderBoard(board, frameSize, false);
+
+    vector< vector< Point2f > > corners;
+    vector< int > ids;
+    TEST_CYCLE()
+    {
+        detector->detectMarkers(frame, corners, ids);
+    }
+
+    EXPECT_GE(ids.size(), board->ids.size() / 2);
+    SANITY_CHECK_NOTHING();
+}
+
+typedef tuple< Size, int, bool > InterpolateCharucoParams;
+typedef TestBaseWithParam< InterpolateCharucoParams > CharucoInterpolatePerfTest;
+
+PERF_TEST_P(CharucoInterpolatePerfTest, interpolateCornersCharuco,
+            Combine(Values(szVGA, sz1080p), Values(5, 10), Bool()))
+{
+    const Size frameSize = get<0>(GetParam());
+    const int squaresPerSide = get<1>(GetParam());
+    const bool useCameraMatrix = get<2>(GetParam());
+
+    Ptr<aruco::Dictionary> dictionary = aruco::getPredefinedDictionary(aruco::DICT_6X6_250);
+    Ptr<aruco::CharucoBoard> board = aruco::CharucoBoard::create(squaresPerSide, squaresPerSide, 1.f, 0.7f,
+                                                                 dictionary);
+    Mat frame = renderBoard(board, frameSize, true);
+
+    vector< vector< Point2f > > markerCorners;
+    vector< int > markerIds;
+    aruco::detectMarkers(frame, dictionary, markerCorners, markerIds);
+    ASSERT_FALSE(markerIds.empty());
+
+    Mat cameraMatrix, distCoeffs;
+    if(useCameraMatrix) {
+        cameraMatrix = syntheticCameraMatrix(frameSize);
+        distCoeffs = Mat::zeros(1, 5, CV_64FC1);
+    }
+
+    vector< Point2f > charucoCorners;
+    vector< int > charucoIds;
+    TEST_CYCLE()
+    {
+        aruco::interpolateCornersCharuco(markerCorners, markerIds, frame, board, charucoCorners, charucoIds,
+                                         cameraMatrix, distCoeffs);
+    }
+
+    EXPECT_FALSE(charucoIds.empty());
+    SANITY_CHECK_NOTHING();
+}
+
+typedef TestBaseWithParam< int > EstimatePoseBoardPerfTest;
+
+PERF_TEST_P(EstimatePoseBoardPerfTest, estimatePoseBoard, Values(4, 8, 16))
+{
+    const Size frameSize = sz1080p;
+    const int markersPerSide = GetParam();
+
+    Ptr<aruco::Dictionary> dictionary = aruco::getPredefinedDictionary(aruco::DICT_6X6_1000);
+    Ptr<aruco::GridBoard> board = aruco::GridBoard::create(markersPerSide, markersPerSide, 1.f, 0.25f, dictionary);
+    Mat frame = renderBoard(board, frameSize, false);
+
+    vector< vector< Point2f > > corners;
+    vector< int > ids;
+    aruco::detectMarkers(frame, dictionary, corners, ids);
+    ASSERT_FALSE(ids.empty());
+
+    Mat cameraMatrix = syntheticCameraMatrix(frameSize);
+    Mat distCoeffs = Mat::zeros(1, 5, CV_64FC1);
+    Vec3d rvec, tvec;
+    int nUsed = 0;
+    TEST_CYCLE()
+    {
+        nUsed = aruco::estimatePoseBoard(corners, ids, board, cameraMatrix, distCoeffs, rvec, tvec);
+    }
+
+    EXPECT_GT(nUsed, 0);
+    SANITY_CHECK_NOTHING();
+}
+
+CV_ENUM(SingleMarkerPoseMethod, 0, 1)
+
+typedef tuple< int, SingleMarkerPoseMethod > EstimatePoseSingleMarkersParams;
+typedef TestBaseWithParam< EstimatePoseSingleMarkersParams > EstimatePoseSingleMarkersPerfTest;
+
+// method 0 is the per marker solvePnP path, 1 the batched closed-form one
+PERF_TEST_P(EstimatePoseSingleMarkersPerfTest, estimatePoseSingleMarkers,
+            Combine(Values(8, 16), SingleMarkerPoseMethod::all()))
+{
+    const Size frameSize = sz1080p;
+    const int markersPerSide = get<0>(GetParam());
+    const bool batch = get<1>(GetParam()) == 1;
+
+    Ptr<aruco::Dictionary> dictionary = aruco::getPredefinedDictionary(aruco::DICT_6X6_1000);
+    Ptr<aruco::GridBoard> board = aruco::GridBoard::create(markersPerSide, markersPerSide, 1.f, 0.25f, dictionary);
+    Mat frame = renderBoard(board, frameSize, false);
+
+    vector< vector< Point2f > > corners;
+    vector< int > ids;
+    aruco::detectMarkers(frame, dictionary, corners, ids);
+    ASSERT_FALSE(ids.empty());
+
+    Mat cameraMatrix = syntheticCameraMatrix(frameSize);
+    Mat distCoeffs = Mat::zeros(1, 5, CV_64FC1);
+    vector< Vec3d > rvecs, tvecs;
+    vector< double > errors;
+    TEST_CYCLE()
+    {
+        if(batch)
+            aruco::estimatePoseSingleMarkersBatch(corners, 0.05f, cameraMatrix, distCoeffs, rvecs, tvecs, errors);
+        else
+            aruco::estimatePoseSingleMarkers(corners, 0.05f, cameraMatrix, distCoeffs, rvecs, tvecs);
+    }
+
+    EXPECT_EQ(corners.size(), tvecs.size());
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
@@ -0,0 +1,54 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+CV_ENUM(DictionaryNames, aruco::DICT_4X4_1000, aruco::DICT_5X5_1000, aruco::DICT_6X6_1000,
+        aruco::DICT_7X7_1000, aruco::DICT_ARUCO_ORIGINAL, aruco::DICT_APRILTAG_36h11)
+
+typedef TestBaseWithParam< DictionaryNames > DictionaryIdentifyPerfTest;
+
+PERF_TEST_P(DictionaryIdentifyPerfTest, identify, DictionaryNames::all())
+{
+    Ptr<aruco::Dictionary> dictionary = aruco::getPredefinedDictionary((int)GetParam());
+    const int nCandidates = 500;
+
+    // candidates are dictionary markers with some bits flipped, plus random (invalid) codes
+    RNG rng(0);
+    vector< Mat > candidates;
+    for(int i = 0; i < nCandidates; i++) {
+        Mat bits;
+        if(i % 2 == 0) {
+            int id = rng.uniform(0, dictionary->bytesList.rows);
+            bits = aruco::Dictionary::getBitsFromByteList(dictionary->bytesList.rowRange(id, id + 1),
+                                                          dictionary->markerSize);
+            int nFlips = rng.uniform(0, dictionary->maxCorrectionBits + 1);
+            for(int f = 0; f < nFlips; f++) {
+                uchar &bit = bits.at< uchar >(rng.uniform(0, bits.rows), rng.uniform(0, bits.cols));
+                bit = (uchar)(1 - bit);
+            }
+        } else {
+            bits.create(dictionary->markerSize, dictionary->markerSize, CV_8UC1);
+            rng.fill(bits, RNG::UNIFORM, 0, 2);
+        }
+        candidates.push_back(bits);
+    }
+
+    int nFound = 0;
+    TEST_CYCLE()
+    {
+        nFound = 0;
+        for(int i = 0; i < nCandidates; i++) {
+            int idx, rotation;
+            if(dictionary->identify(candidates[i], idx, rotation, 0.6))
+                nFound++;
+        }
+    }
+
+    EXPECT_GT(nFound, 0);
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
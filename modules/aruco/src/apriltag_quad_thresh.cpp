@@ -18,6 +18,7 @@
 
 #include "precomp.hpp"
 #include "apriltag_quad_thresh.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 //#define APRIL_DEBUG
 #ifdef APRIL_DEBUG
@@ -1035,24 +1036,22 @@ int fit_quad(const Ptr<DetectorParameters> &_params, const Mat im, zarray_t *clu
  * @param nClusters
  * @param nW
  * @param nH
- * @param nquads
+ * @param nquads one slot per cluster, written only where nfound is set
+ * @param nfound
  * @param td
  * @param im
  */
-static void do_quad(int nCidx0, int nCidx1, zarray_t &nClusters, int nW, int nH, zarray_t *nquads, const Ptr<DetectorParameters> &td, const Mat im){
+static void do_quad(int nCidx0, int nCidx1, std::vector<zarray_t> &nClusters, int nW, int nH,
+                    std::vector<struct sQuad> &nquads, std::vector<uchar> &nfound,
+                    const Ptr<DetectorParameters> &td, const Mat im){
 
-    CV_Assert(nquads != NULL);
+    CV_Assert(nquads.size() == nClusters.size() && nfound.size() == nClusters.size());
 
-    //struct quad_task *task = (struct quad_task*) p;
-
-    //zarray_t *clusters = nClusters;
-    zarray_t *quads = nquads;
     int w = nW, h = nH;
 
     for (int cidx = nCidx0; cidx < nCidx1; cidx++) {
 
-        zarray_t *cluster;
-        _zarray_get(&nClusters, cidx, &cluster);
+        zarray_t *cluster = &nClusters[cidx];
 
         if (_zarray_size(cluster) < td->aprilTagMinClusterPixels)
             continue;
@@ -1067,13 +1066,11 @@ static void do_quad(int nCidx0, int nCidx1, zarray_t &nClusters, int nW, int nH,
             continue;
         }
 
-        struct sQuad quad;
+        struct sQuad &quad = nquads[cidx];
         memset(&quad, 0, sizeof(struct sQuad));
 
         if (fit_quad(td, im, cluster, &quad)) {
-            //pthread_mutex_lock(&td.mutex);
-            _zarray_add(quads, &quad);
-            //pthread_mutex_unlock(&td.mutex);
+            nfound[cidx] = 1;
         }
     }
 }
@@ -1122,103 +1119,101 @@ void threshold(const Mat mIm, const Ptr<DetectorParameters> &parameters, Mat& mT
     int tw = w / tilesz;
     int th = h / tilesz;
 
-    uint8_t *im_max = (uint8_t*)calloc(tw*th, sizeof(uint8_t));
-    uint8_t *im_min = (uint8_t*)calloc(tw*th, sizeof(uint8_t));
-
+    // the tile statistics are tiny, the per-row buffers are reused for every tile row
+    const int wt = tw*tilesz;
+    Mat im_max(th, tw, CV_8UC1), im_min(th, tw, CV_8UC1);
+    AutoBuffer<uint8_t> rowBuf(2*wt + 1);
+    uint8_t *rowA = rowBuf.data(), *rowB = rowA + wt;
 
-    // first, collect min/max statistics for each tile
+    // first, collect min/max statistics for each tile: a vertical pass
+    // over the tilesz rows of a tile row, then a horizontal reduction.
     for (int ty = 0; ty < th; ty++) {
+        const uint8_t *src = mIm.ptr<uint8_t>(ty*tilesz);
+        int x = 0;
+#if CV_SIMD128
+        for (; x <= wt - 16; x += 16) {
+            v_uint8x16 vmax = v_load(src + x), vmin = vmax;
+            for (int dy = 1; dy < tilesz; dy++) {
+                v_uint8x16 v = v_load(src + dy*s + x);
+                vmax = v_max(vmax, v);
+                vmin = v_min(vmin, v);
+            }
+            v_store(rowA + x, vmax);
+            v_store(rowB + x, vmin);
+        }
+#endif
+        for (; x < wt; x++) {
+            uint8_t max = src[x], min = src[x];
+            for (int dy = 1; dy < tilesz; dy++) {
+                uint8_t v = src[dy*s + x];
+                if (v < min)
+                    min = v;
+                if (v > max)
+                    max = v;
+            }
+            rowA[x] = max;
+            rowB[x] = min;
+        }
+
+        uint8_t *tmax = im_max.ptr<uint8_t>(ty), *tmin = im_min.ptr<uint8_t>(ty);
         for (int tx = 0; tx < tw; tx++) {
             uint8_t max = 0, min = 255;
-
-            for (int dy = 0; dy < tilesz; dy++) {
-
-                for (int dx = 0; dx < tilesz; dx++) {
-
-                    uint8_t v = mIm.data[(ty*tilesz+dy)*s + tx*tilesz + dx];
-                    if (v < min)
-                        min = v;
-                    if (v > max)
-                        max = v;
-                }
+            for (int dx = 0; dx < tilesz; dx++) {
+                max = std::max(max, rowA[tx*tilesz + dx]);
+                min = std::min(min, rowB[tx*tilesz + dx]);
             }
-            im_max[ty*tw+tx] = max;
-            im_min[ty*tw+tx] = min;
+            tmax[tx] = max;
+            tmin[tx] = min;
         }
     }
 
     // second, apply 3x3 max/min convolution to "blur" these values
     // over larger areas. This reduces artifacts due to abrupt changes
-    // in the threshold value.
-    uint8_t *im_max_tmp = (uint8_t*)calloc(tw*th, sizeof(uint8_t));
-    uint8_t *im_min_tmp = (uint8_t*)calloc(tw*th, sizeof(uint8_t));
-
-    for (int ty = 0; ty < th; ty++) {
-        for (int tx = 0; tx < tw; tx++) {
-            uint8_t max = 0, min = 255;
-
-            for (int dy = -1; dy <= 1; dy++) {
-                if (ty+dy < 0 || ty+dy >= th)
-                    continue;
-                for (int dx = -1; dx <= 1; dx++) {
-                    if (tx+dx < 0 || tx+dx >= tw)
-                        continue;
-
-                    uint8_t m = im_max[(ty+dy)*tw+tx+dx];
-                    if (m > max)
-                        max = m;
-                    m = im_min[(ty+dy)*tw+tx+dx];
-                    if (m < min)
-                        min = m;
-                }
-            }
-
-            im_max_tmp[ty*tw + tx] = max;
-            im_min_tmp[ty*tw + tx] = min;
-        }
+    // in the threshold value. The default constant border of dilate/erode
+    // ignores the tiles outside of the image, like the original loop did.
+    if (tw > 0 && th > 0) {
+        Mat im_max_tmp, im_min_tmp;
+        dilate(im_max, im_max_tmp, Mat());
+        erode(im_min, im_min_tmp, Mat());
+        im_max = im_max_tmp;
+        im_min = im_min_tmp;
     }
-    free(im_max);
-    free(im_min);
-    im_max = im_max_tmp;
-    im_min = im_min_tmp;
 
+    // expand the per-tile threshold and low contrast mask to pixel rows and
+    // binarize the full tiles a row at a time.
+    const int minWhiteBlackDiff = parameters->aprilTagMinWhiteBlackDiff;
     for (int ty = 0; ty < th; ty++) {
+        const uint8_t *tmax = im_max.ptr<uint8_t>(ty), *tmin = im_min.ptr<uint8_t>(ty);
         for (int tx = 0; tx < tw; tx++) {
-
-            int min_ = im_min[ty*tw + tx];
-            int max_ = im_max[ty*tw + tx];
+            int min_ = tmin[tx];
+            int max_ = tmax[tx];
 
             // low contrast region? (no edges)
-            if (max_ - min_ < parameters->aprilTagMinWhiteBlackDiff) {
-                for (int dy = 0; dy < tilesz; dy++) {
-                    int y = ty*tilesz + dy;
-
-                    for (int dx = 0; dx < tilesz; dx++) {
-                        int x = tx*tilesz + dx;
-
-                        //threshim->buf[y*s+x] = 127;
-                        mThresh.data[y*s+x] = 127;
-                    }
-                }
-                continue;
-            }
-
-            // otherwise, actually threshold this tile.
+            uint8_t low = (max_ - min_ < minWhiteBlackDiff) ? 255 : 0;
 
             // argument for biasing towards dark; specular highlights
             // can be substantially brighter than white tag parts
             uint8_t thresh = saturate_cast<uint8_t>((max_ + min_) / 2);
+            for (int dx = 0; dx < tilesz; dx++) {
+                rowA[tx*tilesz + dx] = thresh;
+                rowB[tx*tilesz + dx] = low;
+            }
+        }
 
-            for (int dy = 0; dy < tilesz; dy++) {
-                int y = ty*tilesz + dy;
-
-                for (int dx = 0; dx < tilesz; dx++) {
-                    int x = tx*tilesz + dx;
-
-                    uint8_t v = mIm.data[y*s+x];
-                    mThresh.data[y*s+x] = (v > thresh) ? 255 : 0;
-                }
+        for (int dy = 0; dy < tilesz; dy++) {
+            int y = ty*tilesz + dy;
+            const uint8_t *src = mIm.ptr<uint8_t>(y);
+            uint8_t *dst = mThresh.ptr<uint8_t>(y);
+            int x = 0;
+#if CV_SIMD128
+            const v_uint8x16 v127 = v_setall_u8(127);
+            for (; x <= wt - 16; x += 16) {
+                v_uint8x16 binary = v_load(src + x) > v_load(rowA + x);
+                v_store(dst + x, v_select(v_load(rowB + x), v127, binary));
             }
+#endif
+            for (; x < wt; x++)
+                dst[x] = rowB[x] ? 127 : ((src[x] > rowA[x]) ? 255 : 0);
         }
     }
 
@@ -1235,6 +1230,13 @@ void threshold(const Mat mIm, const Ptr<DetectorParameters> &parameters, Mat& mT
             x0 = tw*tilesz; // we only need to do the right most part.
         }
 
+        // images smaller than a single tile have no statistics at all
+        if (tw == 0 || th == 0) {
+            for (int x = x0; x < w; x++)
+                mThresh.data[y*s+x] = 127;
+            continue;
+        }
+
         // compute tile coordinates and clamp.
         int ty = y / tilesz;
         if (ty >= th)
@@ -1245,8 +1247,8 @@ void threshold(const Mat mIm, const Ptr<DetectorParameters> &parameters, Mat& mT
             if (tx >= tw)
                 tx = tw - 1;
 
-            int max = im_max[ty*tw + tx];
-            int min = im_min[ty*tw + tx];
+            int max = im_max.at<uint8_t>(ty, tx);
+            int min = im_min.at<uint8_t>(ty, tx);
             int thresh = min + (max - min) / 2;
 
             uint8_t v = mIm.data[y*s+x];
@@ -1258,40 +1260,15 @@ void threshold(const Mat mIm, const Ptr<DetectorParameters> &parameters, Mat& mT
             }
         }
     }
-    free(im_min);
-    free(im_max);
 
     // this is a dilate/erode deglitching scheme that does not improve
-    // anything as far as I can tell.
-    if (parameters->aprilTagDeglitch) {
-        Mat tmp(h,w, mIm.type());
-        for (int y = 1; y + 1 < h; y++) {
-            for (int x = 1; x + 1 < w; x++) {
-                uint8_t max = 0;
-                for (int dy = -1; dy <= 1; dy++) {
-                    for (int dx = -1; dx <= 1; dx++) {
-                        uint8_t v = mThresh.data[(y+dy)*s + x + dx];
-                        if (v > max)
-                            max = v;
-                    }
-                }
-                tmp.data[y*s+x] = max;
-            }
-        }
-
-        for (int y = 1; y + 1 < h; y++) {
-            for (int x = 1; x + 1 < w; x++) {
-                uint8_t min = 255;
-                for (int dy = -1; dy <= 1; dy++) {
-                    for (int dx = -1; dx <= 1; dx++) {
-                        uint8_t v = tmp.data[(y+dy)*s + x + dx];
-                        if (v < min)
-                            min = v;
-                    }
-                }
-                mThresh.data[y*s+x] = min;
-            }
-        }
+    // anything as far as I can tell. The outermost pixels are kept as is.
+    if (parameters->aprilTagDeglitch && w > 2 && h > 2) {
+        Mat tmp, deglitched;
+        dilate(mThresh, tmp, Mat(), Point(-1, -1), 1, BORDER_REPLICATE);
+        erode(tmp, deglitched, Mat(), Point(-1, -1), 1, BORDER_REPLICATE);
+        Rect inner(1, 1, w - 2, h - 2);
+        deglitched(inner).copyTo(mThresh(inner));
     }
 
 }
@@ -1306,6 +1283,61 @@ static void _darken(const Mat &im){
 }
 #endif
 
+/**
+ * Open addressing map from the id of a cluster (the pair of region
+ * representatives it separates) to a dense cluster index, numbered in
+ * order of insertion.
+ */
+class ClusterIndexMap {
+public:
+    explicit ClusterIndexMap(int expected) : count_(0) {
+        size_t capacity = 64;
+        while (capacity < 2*(size_t)expected)
+            capacity <<= 1;
+        keys_.resize(capacity);
+        values_.assign(capacity, -1);
+    }
+
+    int getOrInsert(uint64_t id) {
+        size_t mask = keys_.size() - 1;
+        size_t i = u64hash_2(id) & mask;
+        while (values_[i] >= 0) {
+            if (keys_[i] == id)
+                return values_[i];
+            i = (i + 1) & mask;
+        }
+        keys_[i] = id;
+        values_[i] = count_;
+        if (2*(size_t)++count_ > keys_.size())
+            grow();
+        return count_ - 1;
+    }
+
+    int size() const { return count_; }
+
+private:
+    void grow() {
+        std::vector<uint64_t> keys(keys_.size()*2);
+        std::vector<int> values(keys.size(), -1);
+        size_t mask = keys.size() - 1;
+        for (size_t j = 0; j < keys_.size(); j++) {
+            if (values_[j] < 0)
+                continue;
+            size_t i = u64hash_2(keys_[j]) & mask;
+            while (values[i] >= 0)
+                i = (i + 1) & mask;
+            keys[i] = keys_[j];
+            values[i] = values_[j];
+        }
+        keys_.swap(keys);
+        values_.swap(values);
+    }
+
+    std::vector<uint64_t> keys_;
+    std::vector<int> values_;
+    int count_;
+};
+
 /**
  *
  * @param parameters
@@ -1334,15 +1366,34 @@ zarray_t *apriltag_quad_thresh(const Ptr<DetectorParameters> &parameters, const
 
     unionfind_t *uf = unionfind_create(w * h);
 
-    // TODO PARALLELIZE
-    for (int y = 0; y < h - 1; y++) {
-        do_unionfind_line(uf, thold, w, ts, y);
+    // The lines of one horizontal stripe only connect pixels inside that
+    // stripe, so stripes are merged in parallel. The last line of every
+    // stripe joins it to the next one and is processed afterwards.
+    const int nlines = h - 1;
+    const int nstripes = std::max(1, std::min(getNumThreads(), nlines / 32));
+    const int stripeLines = (nlines + nstripes - 1) / nstripes;
+
+    parallel_for_(Range(0, nstripes), [&](const Range& range) {
+        for (int stripe = range.start; stripe < range.end; stripe++) {
+            int y1 = std::min(nlines, (stripe + 1)*stripeLines);
+            for (int y = stripe*stripeLines; y < y1 - 1; y++) {
+                do_unionfind_line(uf, thold, w, ts, y);
+            }
+        }
+    });
+    for (int stripe = 0; stripe < nstripes; stripe++) {
+        int y1 = std::min(nlines, (stripe + 1)*stripeLines);
+        if (y1 - 1 >= stripe*stripeLines)
+            do_unionfind_line(uf, thold, w, ts, y1 - 1);
     }
 
-    // XXX sizing??
-    int nclustermap = 2*w*h - 1;
-
-    struct uint64_zarray_entry **clustermap = (struct uint64_zarray_entry**)calloc(nclustermap, sizeof(struct uint64_zarray_entry*));
+    // boundary points are gathered once with the index of their cluster,
+    // then bucketed into a single pooled buffer.
+    ClusterIndexMap clustermap(std::max(64, (w + h)*4));
+    std::vector<struct pt> points;
+    std::vector<int> pointClusters;
+    points.reserve((size_t)(w + h)*16);
+    pointClusters.reserve(points.capacity());
 
     for (int y = 1; y < h-1; y++) {
         for (int x = 1; x < w-1; x++) {
@@ -1386,27 +1437,13 @@ zarray_t *apriltag_quad_thresh(const Ptr<DetectorParameters> &parameters, const
                 else                                                \
                 clusterid = (rep0 << 32) + rep1;                \
                 \
-                /* XXX lousy hash function */                       \
-        uint32_t clustermap_bucket = u64hash_2(clusterid) % nclustermap; \
-        struct uint64_zarray_entry *entry = clustermap[clustermap_bucket]; \
-        while (entry && entry->id != clusterid)     {       \
-            entry = entry->next;                            \
-        }                                                   \
-        \
-        if (!entry) {                                       \
-            entry = (struct uint64_zarray_entry*)calloc(1, sizeof(struct uint64_zarray_entry)); \
-            entry->id = clusterid;                          \
-            entry->cluster = _zarray_create(sizeof(struct pt)); \
-            entry->next = clustermap[clustermap_bucket];    \
-            clustermap[clustermap_bucket] = entry;          \
-        }                                                   \
-        \
         struct pt p;                                        \
         p.x = saturate_cast<uint16_t>(2*x + dx);            \
         p.y = saturate_cast<uint16_t>(2*y + dy);            \
         p.gx = saturate_cast<uint16_t>(dx*((int) v1-v0));   \
         p.gy = saturate_cast<uint16_t>(dy*((int) v1-v0));   \
-        _zarray_add(entry->cluster, &p);                    \
+        points.push_back(p);                                \
+        pointClusters.push_back(clustermap.getOrInsert(clusterid)); \
         }                                                   \
     }
 
@@ -1455,22 +1492,41 @@ imwrite("2.3 debug_segmentation.pnm", out);
 out = Mat::zeros(h, w, CV_8UC3);
 #endif
 
+
     ////////////////////////////////////////////////////////
     // step 3. process each connected component.
-    zarray_t *clusters = _zarray_create(sizeof(zarray_t*)); //, uint64_zarray_hash_size(clustermap));
-    CV_Assert(clusters != NULL);
 
-    for (int i = 0; i < nclustermap; i++) {
-        for (struct uint64_zarray_entry *entry = clustermap[i]; entry; entry = entry->next) {
-            // XXX reject clusters here?
-            _zarray_add(clusters, &entry->cluster);
-        }
+    // counting sort of the points by cluster; the scan order is kept inside
+    // each cluster and clusters are numbered by their first point.
+    const int nclusters = clustermap.size();
+    std::vector<int> clusterStart(nclusters + 1, 0);
+    for (size_t i = 0; i < pointClusters.size(); i++)
+        clusterStart[pointClusters[i] + 1]++;
+    for (int i = 0; i < nclusters; i++)
+        clusterStart[i + 1] += clusterStart[i];
+
+    std::vector<struct pt> clusterPoints(points.size());
+    {
+        std::vector<int> next(clusterStart.begin(), clusterStart.end() - 1);
+        for (size_t i = 0; i < points.size(); i++)
+            clusterPoints[next[pointClusters[i]]++] = points[i];
+    }
+    std::vector<struct pt>().swap(points);
+    std::vector<int>().swap(pointClusters);
+
+    // the clusters are non-owning views into clusterPoints: fit_quad only
+    // reorders and shrinks them, they must never be grown or destroyed.
+    std::vector<zarray_t> clusters(nclusters);
+    for (int i = 0; i < nclusters; i++) {
+        zarray_t &cluster = clusters[i];
+        cluster.el_sz = sizeof(struct pt);
+        cluster.size = cluster.alloc = clusterStart[i + 1] - clusterStart[i];
+        cluster.data = (char*)(clusterPoints.data() + clusterStart[i]);
     }
 
 #ifdef APRIL_DEBUG
-for (int i = 0; i < _zarray_size(clusters); i++) {
-    zarray_t *cluster;
-    _zarray_get(clusters, i, &cluster);
+for (int i = 0; i < nclusters; i++) {
+    zarray_t *cluster = &clusters[i];
 
     uint32_t r, g, b;
 
@@ -1495,41 +1551,30 @@ imwrite("2.4 debug_clusters.pnm", out);
 out = Mat::zeros(h, w, CV_8UC3);
 #endif
 
-    for (int i = 0; i < _zarray_size(clusters); i++) {
-        zarray_t *cluster;
-        _zarray_get(clusters, i, &cluster);
-
-        std::vector< Point > cnt;
-        for (int j = 0; j < _zarray_size(cluster); j++) {
-            struct pt *p;
-            _zarray_get_volatile(cluster, j, &p);
-
-            Point pnt(p->x, p->y);
-            cnt.push_back(pnt);
+    contours.reserve(contours.size() + nclusters);
+    for (int i = 0; i < nclusters; i++) {
+        const struct pt *p = clusterPoints.data() + clusterStart[i];
+        contours.push_back(std::vector< Point >());
+        std::vector< Point > &cnt = contours.back();
+        cnt.reserve(clusterStart[i + 1] - clusterStart[i]);
+        for (int j = clusterStart[i]; j < clusterStart[i + 1]; j++, p++) {
+            cnt.push_back(Point(p->x, p->y));
         }
-        contours.push_back(cnt);
     }
 
-    for (int i = 0; i < nclustermap; i++) {
-        struct uint64_zarray_entry *entry = clustermap[i];
-        while (entry) {
-            struct uint64_zarray_entry *tmp = entry->next;
-            free(entry);
-            entry = tmp;
-        }
-    }
-    free(clustermap);
+    // fit the quads in parallel, then collect them in cluster order so that
+    // the result does not depend on the number of threads.
+    std::vector<struct sQuad> clusterQuads(nclusters);
+    std::vector<uchar> quadFound(nclusters, 0);
+    const int quadStripes = std::min(nclusters, 4*std::max(1, getNumThreads()));
+    parallel_for_(Range(0, nclusters), [&](const Range& range) {
+        do_quad(range.start, range.end, clusters, w, h, clusterQuads, quadFound, parameters, mImg);
+    }, quadStripes);
 
     zarray_t *quads = _zarray_create(sizeof(struct sQuad));
-
-    //int chunksize = 1 + sz / (APRILTAG_TASKS_PER_THREAD_TARGET * numberOfThreads);
-    int chunksize = h / (10 * getNumThreads());
-    int sz = _zarray_size(clusters);
-
-    // TODO PARALLELIZE
-    for (int i = 0; i < sz; i += chunksize) {
-        int min = sz < (i+chunksize)? sz: (i+chunksize);
-        do_quad(i, min, *clusters, w, h, quads, parameters, mImg);
+    for (int i = 0; i < nclusters; i++) {
+        if (quadFound[i])
+            _zarray_add(quads, &clusterQuads[i]);
     }
 
 #ifdef APRIL_DEBUG
@@ -1557,13 +1602,6 @@ imwrite("2.5 debug_lines.pnm", out);
 #endif
 
     unionfind_destroy(uf);
-
-    for (int i = 0; i < _zarray_size(clusters); i++) {
-        zarray_t *cluster;
-        _zarray_get(clusters, i, &cluster);
-        _zarray_destroy(cluster);
-    }
-    _zarray_destroy(clusters);
     return quads;
 }
 
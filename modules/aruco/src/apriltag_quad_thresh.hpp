@@ -31,13 +31,6 @@ static inline uint32_t u64hash_2(uint64_t x) {
     return uint32_t((2654435761UL * x) >> 32);
 }
 
-struct uint64_zarray_entry{
-    uint64_t id;
-    zarray_t *cluster;
-
-    struct uint64_zarray_entry *next;
-};
-
 struct pt{
     // Note: these represent 2*actual value.
     uint16_t x, y;
@@ -47,6 +47,7 @@ the use of this software, even if advised of the possibility of such damage.
 //#define APRIL_DEBUG
 #ifdef APRIL_DEBUG
 #include "opencv2/imgcodecs.hpp"
+#include "opencv2/core/utils/trace.hpp"
 #endif
 
 namespace cv {
@@ -113,6 +114,39 @@ static void _convertToGrey(InputArray _in, OutputArray _out) {
 }
 
 
+/**
+  * @brief Get a grey view of the input image. Single channel images are referenced without copy,
+  * 3-channels images are converted into the (reusable) buffer
+  */
+static Mat _getGreyView(InputArray _in, Mat &buffer) {
+
+    CV_Assert(_in.type() == CV_8UC1 || _in.type() == CV_8UC3);
+
+    if(_in.type() == CV_8UC3) {
+        cvtColor(_in, buffer, COLOR_BGR2GRAY);
+        return buffer;
+    }
+    return _in.getMat();
+}
+
+
+/**
+  * @brief Buffers of the detection process that can be kept between consecutive detections to
+  * avoid reallocating them on every frame (see ArucoDetector)
+  */
+struct DetectionWorkspace {
+    Mat greyBuffer;                                     // conversion target for 3-channels inputs
+    vector< Mat > thresholds;                           // one thresholded image per window size
+    vector< vector< vector< Point > > > rawContours;    // findContours output per window size
+    vector< vector< vector< Point2f > > > candidatesArrays;
+    vector< vector< vector< Point > > > contoursArrays;
+    vector< vector< Point2f > > candidates;
+    vector< vector< Point > > contours;
+    vector< vector< vector< Point2f > > > candidatesSet;
+    vector< vector< vector< Point > > > contoursSet;
+};
+
+
 /**
   * @brief Threshold input image using adaptive thresholding
   */
@@ -131,29 +165,30 @@ static void _threshold(InputArray _in, OutputArray _out, int winSize, double con
 static void _findMarkerContours(InputArray _in, vector< vector< Point2f > > &candidates,
                                 vector< vector< Point > > &contoursOut, double minPerimeterRate,
                                 double maxPerimeterRate, double accuracyRate,
-                                double minCornerDistanceRate, int minDistanceToBorder) {
+                                double minCornerDistanceRate, int minDistanceToBorder,
+                                vector< vector< Point > > &contours) {
 
     CV_Assert(minPerimeterRate > 0 && maxPerimeterRate > 0 && accuracyRate > 0 &&
               minCornerDistanceRate >= 0 && minDistanceToBorder >= 0);
 
+    // findContours does not modify its input, so the thresholded image is used directly
+    Mat contoursImg = _in.getMat();
+
     // calculate maximum and minimum sizes in pixels
     unsigned int minPerimeterPixels =
-        (unsigned int)(minPerimeterRate * max(_in.getMat().cols, _in.getMat().rows));
+        (unsigned int)(minPerimeterRate * max(contoursImg.cols, contoursImg.rows));
     unsigned int maxPerimeterPixels =
-        (unsigned int)(maxPerimeterRate * max(_in.getMat().cols, _in.getMat().rows));
+        (unsigned int)(maxPerimeterRate * max(contoursImg.cols, contoursImg.rows));
 
-    Mat contoursImg;
-    _in.getMat().copyTo(contoursImg);
-    vector< vector< Point > > contours;
     findContours(contoursImg, contours, RETR_LIST, CHAIN_APPROX_NONE);
     // now filter list of contours
+    vector< Point > approxCurve;
     for(unsigned int i = 0; i < contours.size(); i++) {
         // check perimeter
         if(contours[i].size() < minPerimeterPixels || contours[i].size() > maxPerimeterPixels)
             continue;
 
         // check is square and is convex
-        vector< Point > approxCurve;
         approxPolyDP(contours[i], approxCurve, double(contours[i].size()) * accuracyRate, true);
         if(approxCurve.size() != 4 || !isContourConvex(approxCurve)) continue;
 
@@ -352,8 +387,10 @@ static void _filterTooCloseCandidates(const vector< vector< Point2f > > &candida
  */
 static void _detectInitialCandidates(const Mat &grey, vector< vector< Point2f > > &candidates,
                                      vector< vector< Point > > &contours,
-                                     const Ptr<DetectorParameters> &params) {
+                                     const Ptr<DetectorParameters> &params,
+                                     DetectionWorkspace &ws) {
 
+    CV_TRACE_FUNCTION();
     CV_Assert(params->adaptiveThreshWinSizeMin >= 3 && params->adaptiveThreshWinSizeMax >= 3);
     CV_Assert(params->adaptiveThreshWinSizeMax >= params->adaptiveThreshWinSizeMin);
     CV_Assert(params->adaptiveThreshWinSizeStep > 0);
@@ -362,8 +399,13 @@ static void _detectInitialCandidates(const Mat &grey, vector< vector< Point2f >
     int nScales =  (params->adaptiveThreshWinSizeMax - params->adaptiveThreshWinSizeMin) /
                       params->adaptiveThreshWinSizeStep + 1;
 
-    vector< vector< vector< Point2f > > > candidatesArrays((size_t) nScales);
-    vector< vector< vector< Point > > > contoursArrays((size_t) nScales);
+    // per scale buffers are kept in the workspace, so their memory is reused between calls
+    ws.thresholds.resize((size_t) nScales);
+    ws.rawContours.resize((size_t) nScales);
+    ws.candidatesArrays.resize((size_t) nScales);
+    ws.contoursArrays.resize((size_t) nScales);
+    vector< vector< vector< Point2f > > > &candidatesArrays = ws.candidatesArrays;
+    vector< vector< vector< Point > > > &contoursArrays = ws.contoursArrays;
 
     ////for each value in the interval of thresholding window sizes
     parallel_for_(Range(0, nScales), [&](const Range& range) {
@@ -372,19 +414,29 @@ static void _detectInitialCandidates(const Mat &grey, vector< vector< Point2f >
 
         for (int i = begin; i < end; i++) {
             int currScale = params->adaptiveThreshWinSizeMin + i * params->adaptiveThreshWinSizeStep;
+            candidatesArrays[i].clear();
+            contoursArrays[i].clear();
+
             // threshold
-            Mat thresh;
+            CV_TRACE_REGION("threshold");
+            Mat &thresh = ws.thresholds[i];
             _threshold(grey, thresh, currScale, params->adaptiveThreshConstant);
 
             // detect rectangles
+            CV_TRACE_REGION_NEXT("findMarkerContours");
             _findMarkerContours(thresh, candidatesArrays[i], contoursArrays[i],
                                 params->minMarkerPerimeterRate, params->maxMarkerPerimeterRate,
                                 params->polygonalApproxAccuracyRate, params->minCornerDistanceRate,
-                                params->minDistanceToBorder);
+                                params->minDistanceToBorder, ws.rawContours[i]);
         }
-    });
+    }, nScales);
 
     // join candidates
+    size_t nCandidates = 0;
+    for(int i = 0; i < nScales; i++)
+        nCandidates += candidatesArrays[i].size();
+    candidates.reserve(candidates.size() + nCandidates);
+    contours.reserve(contours.size() + nCandidates);
     for(int i = 0; i < nScales; i++) {
         for(unsigned int j = 0; j < candidatesArrays[i].size(); j++) {
             candidates.push_back(candidatesArrays[i][j]);
@@ -397,25 +449,24 @@ static void _detectInitialCandidates(const Mat &grey, vector< vector< Point2f >
 /**
  * @brief Detect square candidates in the input image
  */
-static void _detectCandidates(InputArray _image, vector< vector< vector< Point2f > > >& candidatesSetOut,
-                              vector< vector< vector< Point > > >& contoursSetOut, const Ptr<DetectorParameters> &_params) {
+static void _detectCandidates(const Mat &grey, vector< vector< vector< Point2f > > >& candidatesSetOut,
+                              vector< vector< vector< Point > > >& contoursSetOut, const Ptr<DetectorParameters> &_params,
+                              DetectionWorkspace &ws) {
 
-    Mat image = _image.getMat();
-    CV_Assert(image.total() != 0);
+    CV_Assert(grey.total() != 0 && grey.type() == CV_8UC1);
 
-    /// 1. CONVERT TO GRAY
-    Mat grey;
-    _convertToGrey(image, grey);
+    /// 1. DETECT FIRST SET OF CANDIDATES
+    vector< vector< Point2f > > &candidates = ws.candidates;
+    vector< vector< Point > > &contours = ws.contours;
+    candidates.clear();
+    contours.clear();
+    _detectInitialCandidates(grey, candidates, contours, _params, ws);
 
-    vector< vector< Point2f > > candidates;
-    vector< vector< Point > > contours;
-    /// 2. DETECT FIRST SET OF CANDIDATES
-    _detectInitialCandidates(grey, candidates, contours, _params);
-
-    /// 3. SORT CORNERS
+    /// 2. SORT CORNERS
     _reorderCandidatesCorners(candidates);
 
-    /// 4. FILTER OUT NEAR CANDIDATE PAIRS
+    /// 3. FILTER OUT NEAR CANDIDATE PAIRS
+    CV_TRACE_REGION("filterTooCloseCandidates");
     // save the outter/inner border (i.e. potential candidates)
     _filterTooCloseCandidates(candidates, candidatesSetOut, contours, contoursSetOut,
                               _params->minMarkerDistanceRate, _params->detectInvertedMarker);
@@ -424,11 +475,11 @@ static void _detectCandidates(InputArray _image, vector< vector< vector< Point2f
 
 /**
   * @brief Given an input image and candidate corners, extract the bits of the candidate, including
-  * the border bits
+  * the border bits. resultImg is a scratch buffer for the perspective-free marker image.
   */
 static Mat _extractBits(InputArray _image, InputArray _corners, int markerSize,
                         int markerBorderBits, int cellSize, double cellMarginRate,
-                        double minStdDevOtsu) {
+                        double minStdDevOtsu, Mat &resultImg) {
 
     CV_Assert(_image.getMat().channels() == 1);
     CV_Assert(_corners.total() == 4);
@@ -439,7 +490,7 @@ static Mat _extractBits(InputArray _image, InputArray _corners, int markerSize,
     int markerSizeWithBorders = markerSize + 2 * markerBorderBits;
     int cellMarginPixels = int(cellMarginRate * cellSize);
 
-    Mat resultImg; // marker image after removing perspective
+    // resultImg is the marker image after removing perspective
     int resultImgSize = markerSizeWithBorders * cellSize;
     Mat resultImgCorners(4, 1, CV_32FC2);
     resultImgCorners.ptr< Point2f >(0)[0] = Point2f(0, 0);
@@ -492,6 +543,15 @@ static Mat _extractBits(InputArray _image, InputArray _corners, int markerSize,
 }
 
 
+static Mat _extractBits(InputArray _image, InputArray _corners, int markerSize,
+                        int markerBorderBits, int cellSize, double cellMarginRate,
+                        double minStdDevOtsu) {
+    Mat resultImg;
+    return _extractBits(_image, _corners, markerSize, markerBorderBits, cellSize, cellMarginRate,
+                        minStdDevOtsu, resultImg);
+}
+
+
 
 /**
   * @brief Return number of erroneous bits in border, i.e. number of white bits in border.
@@ -527,7 +587,8 @@ static int _getBorderErrors(const Mat &bits, int markerSize, int borderSize) {
  */
 static uint8_t _identifyOneCandidate(const Ptr<Dictionary>& dictionary, InputArray _image,
                                   vector<Point2f>& _corners, int& idx,
-                                  const Ptr<DetectorParameters>& params, int& rotation)
+                                  const Ptr<DetectorParameters>& params, int& rotation,
+                                  Mat &scratch)
 {
     CV_Assert(_corners.size() == 4);
     CV_Assert(_image.getMat().total() != 0);
@@ -538,7 +599,7 @@ static uint8_t _identifyOneCandidate(const Ptr<Dictionary>& dictionary, InputArr
     Mat candidateBits =
         _extractBits(_image, _corners, dictionary->markerSize, params->markerBorderBits,
                      params->perspectiveRemovePixelPerCell,
-                     params->perspectiveRemoveIgnoredMarginPerCell, params->minOtsuStdDev);
+                     params->perspectiveRemoveIgnoredMarginPerCell, params->minOtsuStdDev, scratch);
 
     // analyze border bits
     int maximumErrorsInBorder =
@@ -616,42 +677,46 @@ static void correctCornerPosition( vector< Point2f >& _candidate, int rotate){
 /**
  * @brief Identify square candidates according to a marker dictionary
  */
-static void _identifyCandidates(InputArray _image, vector< vector< vector< Point2f > > >& _candidatesSet,
+static void _identifyCandidates(const Mat &grey, vector< vector< vector< Point2f > > >& _candidatesSet,
                                 vector< vector< vector<Point> > >& _contoursSet, const Ptr<Dictionary> &_dictionary,
                                 vector< vector< Point2f > >& _accepted, vector< vector<Point> >& _contours, vector< int >& ids,
                                 const Ptr<DetectorParameters> &params,
                                 OutputArrayOfArrays _rejected = noArray()) {
 
+    CV_TRACE_FUNCTION();
     int ncandidates = (int)_candidatesSet[0].size();
     vector< vector< Point2f > > accepted;
     vector< vector< Point2f > > rejected;
 
     vector< vector< Point > > contours;
 
-    CV_Assert(_image.getMat().total() != 0);
-
-    Mat grey;
-    _convertToGrey(_image.getMat(), grey);
+    CV_Assert(grey.total() != 0 && grey.type() == CV_8UC1);
 
     vector< int > idsTmp(ncandidates, -1);
     vector< int > rotated(ncandidates, 0);
     vector< uint8_t > validCandidates(ncandidates, 0);
 
+    // group candidates in a few stripes per thread, so each stripe can reuse its bit extraction
+    // buffer instead of allocating it for every candidate
+    double nstripes = std::min((double)ncandidates, 4. * std::max(1, getNumThreads()));
+
     //// Analyze each of the candidates
     parallel_for_(Range(0, ncandidates), [&](const Range &range) {
         const int begin = range.start;
         const int end = range.end;
 
         vector< vector< Point2f > >& candidates = params->detectInvertedMarker ? _candidatesSet[1] : _candidatesSet[0];
+        Mat scratch;
 
         for(int i = begin; i < end; i++) {
             int currId;
-            validCandidates[i] = _identifyOneCandidate(_dictionary, grey, candidates[i], currId, params, rotated[i]);
+            validCandidates[i] = _identifyOneCandidate(_dictionary, grey, candidates[i], currId, params, rotated[i],
+                                                       scratch);
 
             if(validCandidates[i] > 0)
                 idsTmp[i] = currId;
         }
-    });
+    }, nstripes);
 
     for(int i = 0; i < ncandidates; i++) {
         if(validCandidates[i] > 0) {
@@ -865,6 +930,7 @@ static void _darken(const Mat &im){
 static void _apriltag(Mat im_orig, const Ptr<DetectorParameters> & _params, std::vector< std::vector< Point2f > > &candidates,
         std::vector< std::vector< Point > > &contours){
 
+    CV_TRACE_FUNCTION();
     ///////////////////////////////////////////////////////////
     /// Step 1. Detect quads according to requested image decimation
     /// and blurring parameters.
@@ -981,23 +1047,29 @@ static void _apriltag(Mat im_orig, const Ptr<DetectorParameters> & _params, std:
 
 
 /**
-  */
-void detectMarkers(InputArray _image, const Ptr<Dictionary> &_dictionary, OutputArrayOfArrays _corners,
-                   OutputArray _ids, const Ptr<DetectorParameters> &_params,
-                   OutputArrayOfArrays _rejectedImgPoints, InputArrayOfArrays camMatrix, InputArrayOfArrays distCoeff) {
+ * @brief Marker detection using the buffers of the given workspace
+ */
+static void _detectMarkers(DetectionWorkspace &ws, InputArray _image, const Ptr<Dictionary> &_dictionary,
+                           OutputArrayOfArrays _corners, OutputArray _ids, const Ptr<DetectorParameters> &_params,
+                           OutputArrayOfArrays _rejectedImgPoints, InputArrayOfArrays camMatrix,
+                           InputArrayOfArrays distCoeff) {
 
+    CV_TRACE_FUNCTION();
     CV_Assert(!_image.empty());
 
-    Mat grey;
-    _convertToGrey(_image.getMat(), grey);
+    CV_TRACE_REGION("convertToGrey");
+    Mat grey = _getGreyView(_image, ws.greyBuffer);
 
     /// STEP 1: Detect marker candidates
+    CV_TRACE_REGION_NEXT("detectCandidates");
     vector< vector< Point2f > > candidates;
     vector< vector< Point > > contours;
     vector< int > ids;
 
-    vector< vector< vector< Point2f > > > candidatesSet;
-    vector< vector< vector< Point > > > contoursSet;
+    vector< vector< vector< Point2f > > > &candidatesSet = ws.candidatesSet;
+    vector< vector< vector< Point > > > &contoursSet = ws.contoursSet;
+    candidatesSet.clear();
+    contoursSet.clear();
     /// STEP 1.a Detect marker candidates :: using AprilTag
     if(_params->cornerRefinementMethod == CORNER_REFINE_APRILTAG){
         _apriltag(grey, _params, candidates, contours);
@@ -1008,9 +1080,10 @@ void detectMarkers(InputArray _image, const Ptr<Dictionary> &_dictionary, Output
 
     /// STEP 1.b Detect marker candidates :: traditional way
     else
-        _detectCandidates(grey, candidatesSet, contoursSet, _params);
+        _detectCandidates(grey, candidatesSet, contoursSet, _params, ws);
 
     /// STEP 2: Check candidate codification (identify markers)
+    CV_TRACE_REGION_NEXT("identifyCandidates");
     _identifyCandidates(grey, candidatesSet, contoursSet, _dictionary, candidates, contours, ids, _params,
                         _rejectedImgPoints);
 
@@ -1019,6 +1092,7 @@ void detectMarkers(InputArray _image, const Ptr<Dictionary> &_dictionary, Output
     Mat(ids).copyTo(_ids);
 
     /// STEP 3: Corner refinement :: use corner subpix
+    CV_TRACE_REGION_NEXT("refineCorners");
     if( _params->cornerRefinementMethod == CORNER_REFINE_SUBPIX ) {
         CV_Assert(_params->cornerRefinementWinSize > 0 && _params->cornerRefinementMaxIterations > 0 &&
                   _params->cornerRefinementMinAccuracy > 0);
@@ -1058,6 +1132,215 @@ void detectMarkers(InputArray _image, const Ptr<Dictionary> &_dictionary, Output
     }
 }
 
+
+/**
+  */
+void detectMarkers(InputArray _image, const Ptr<Dictionary> &_dictionary, OutputArrayOfArrays _corners,
+                   OutputArray _ids, const Ptr<DetectorParameters> &_params,
+                   OutputArrayOfArrays _rejectedImgPoints, InputArrayOfArrays camMatrix, InputArrayOfArrays distCoeff) {
+
+    CV_TRACE_FUNCTION();
+    DetectionWorkspace ws;
+    _detectMarkers(ws, _image, _dictionary, _corners, _ids, _params, _rejectedImgPoints, camMatrix, distCoeff);
+}
+
+
+/**
+ * @brief Search previously detected markers inside regions around their last position
+ * @return false if one of the tracked markers is lost, so a full frame search is required
+ */
+static bool _trackMarkers(DetectionWorkspace &ws, const Mat &grey, const Ptr<Dictionary> &_dictionary,
+                          const Ptr<DetectorParameters> &_params, float roiMarginRate,
+                          const vector< vector< Point2f > > &prevCorners, const vector< int > &prevIds,
+                          vector< vector< Point2f > > &corners, vector< int > &ids,
+                          vector< vector< Point2f > > &rejected, InputArray camMatrix, InputArray distCoeff) {
+
+    CV_TRACE_FUNCTION();
+    CV_Assert(prevCorners.size() == prevIds.size());
+    CV_Assert(roiMarginRate >= 0);
+
+    corners.clear();
+    ids.clear();
+    rejected.clear();
+
+    Rect imageRect(0, 0, grey.cols, grey.rows);
+    Mat camMatrixFull = camMatrix.getMat(), roiCamMatrix;
+    vector< vector< Point2f > > roiCorners, roiRejected;
+    vector< int > roiIds;
+
+    for(size_t m = 0; m < prevIds.size(); m++) {
+        // search region :: previous bounding box plus margin, so the refinement window also fits in
+        Rect box = boundingRect(prevCorners[m]);
+        int margin = cvCeil(roiMarginRate * max(box.width, box.height)) +
+                     _params->cornerRefinementWinSize + _params->minDistanceToBorder;
+        Rect roi = Rect(box.x - margin, box.y - margin, box.width + 2 * margin, box.height + 2 * margin) &
+                   imageRect;
+        if(roi.empty()) return false;
+
+        // move the principal point, so the contour refinement undistorts the region correctly
+        if(!camMatrixFull.empty()) {
+            camMatrixFull.convertTo(roiCamMatrix, CV_64F);
+            roiCamMatrix.at< double >(0, 2) -= roi.x;
+            roiCamMatrix.at< double >(1, 2) -= roi.y;
+        }
+
+        roiCorners.clear();
+        roiIds.clear();
+        roiRejected.clear();
+        _detectMarkers(ws, grey(roi), _dictionary, roiCorners, roiIds, _params, roiRejected, roiCamMatrix,
+                       distCoeff);
+
+        // keep the detection of the same id closest to the previous position
+        Point2f offset((float)roi.x, (float)roi.y);
+        Point2f prevCenter = (prevCorners[m][0] + prevCorners[m][1] + prevCorners[m][2] + prevCorners[m][3]) / 4.f;
+        int bestIdx = -1;
+        double bestDist = std::numeric_limits< double >::max();
+        for(size_t k = 0; k < roiIds.size(); k++) {
+            if(roiIds[k] != prevIds[m]) continue;
+            Point2f center = (roiCorners[k][0] + roiCorners[k][1] + roiCorners[k][2] + roiCorners[k][3]) / 4.f +
+                             offset;
+            double dist = cv::norm(center - prevCenter);
+            if(dist < bestDist) {
+                bestDist = dist;
+                bestIdx = (int)k;
+            }
+        }
+        if(bestIdx < 0) return false; // marker lost
+
+        for(int c = 0; c < 4; c++)
+            roiCorners[bestIdx][c] += offset;
+
+        // two tracked markers converged to the same detection
+        for(size_t k = 0; k < ids.size(); k++) {
+            if(ids[k] == prevIds[m] && cv::norm(corners[k][0] - roiCorners[bestIdx][0]) < 1.)
+                return false;
+        }
+
+        corners.push_back(roiCorners[bestIdx]);
+        ids.push_back(prevIds[m]);
+
+        for(size_t k = 0; k < roiRejected.size(); k++) {
+            for(size_t c = 0; c < roiRejected[k].size(); c++)
+                roiRejected[k][c] += offset;
+            rejected.push_back(roiRejected[k]);
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief ArucoDetector implementation, keeps a DetectionWorkspace alive between detections
+ */
+class ArucoDetectorImpl : public ArucoDetector {
+public:
+    ArucoDetectorImpl(const Ptr<Dictionary> &dictionary, const Ptr<DetectorParameters> &parameters)
+        : dictionary_(dictionary), parameters_(parameters), tracking_(false), fullSearchInterval_(10),
+          roiMarginRate_(0.5f), framesSinceFullSearch_(0) {
+        CV_Assert(!dictionary_.empty() && !parameters_.empty());
+    }
+
+    void detectMarkers(InputArray image, OutputArrayOfArrays corners, OutputArray ids,
+                       OutputArrayOfArrays rejectedImgPoints, InputArray cameraMatrix,
+                       InputArray distCoeff) CV_OVERRIDE {
+        CV_TRACE_FUNCTION();
+        if(!tracking_) {
+            _detectMarkers(ws_, image, dictionary_, corners, ids, parameters_, rejectedImgPoints,
+                           cameraMatrix, distCoeff);
+            return;
+        }
+
+        CV_Assert(!image.empty());
+        Mat grey = _getGreyView(image, ws_.greyBuffer);
+
+        vector< vector< Point2f > > currCorners, currRejected;
+        vector< int > currIds;
+        bool tracked = false;
+        if(!prevIds_.empty() && grey.size() == prevSize_ && ++framesSinceFullSearch_ < fullSearchInterval_)
+            tracked = _trackMarkers(trackingWs_, grey, dictionary_, parameters_, roiMarginRate_, prevCorners_,
+                                    prevIds_, currCorners, currIds, currRejected, cameraMatrix, distCoeff);
+        if(!tracked) {
+            currCorners.clear();
+            currIds.clear();
+            currRejected.clear();
+            _detectMarkers(ws_, grey, dictionary_, currCorners, currIds, parameters_, currRejected,
+                           cameraMatrix, distCoeff);
+            framesSinceFullSearch_ = 0;
+        }
+
+        prevCorners_ = currCorners;
+        prevIds_ = currIds;
+        prevSize_ = grey.size();
+
+        _copyVector2Output(currCorners, corners);
+        Mat(currIds).copyTo(ids);
+        if(rejectedImgPoints.needed())
+            _copyVector2Output(currRejected, rejectedImgPoints);
+    }
+
+    Ptr<Dictionary> getDictionary() const CV_OVERRIDE { return dictionary_; }
+
+    void setDictionary(const Ptr<Dictionary> &dictionary) CV_OVERRIDE {
+        CV_Assert(!dictionary.empty());
+        dictionary_ = dictionary;
+        resetTracking();
+    }
+
+    Ptr<DetectorParameters> getDetectorParameters() const CV_OVERRIDE { return parameters_; }
+
+    void setDetectorParameters(const Ptr<DetectorParameters> &parameters) CV_OVERRIDE {
+        CV_Assert(!parameters.empty());
+        parameters_ = parameters;
+        resetTracking();
+    }
+
+    void setTracking(bool enabled, int fullSearchInterval, float roiMarginRate) CV_OVERRIDE {
+        CV_Assert(fullSearchInterval > 0 && roiMarginRate >= 0);
+        tracking_ = enabled;
+        fullSearchInterval_ = fullSearchInterval;
+        roiMarginRate_ = roiMarginRate;
+        resetTracking();
+    }
+
+    bool getTracking() const CV_OVERRIDE { return tracking_; }
+
+    void clear() CV_OVERRIDE {
+        ws_ = DetectionWorkspace();
+        trackingWs_ = DetectionWorkspace();
+        resetTracking();
+    }
+
+private:
+    void resetTracking() {
+        prevCorners_.clear();
+        prevIds_.clear();
+        framesSinceFullSearch_ = 0;
+    }
+
+    Ptr<Dictionary> dictionary_;
+    Ptr<DetectorParameters> parameters_;
+    DetectionWorkspace ws_;
+
+    // tracking mode state
+    bool tracking_;
+    int fullSearchInterval_;
+    float roiMarginRate_;
+    int framesSinceFullSearch_;
+    Size prevSize_;
+    vector< vector< Point2f > > prevCorners_;
+    vector< int > prevIds_;
+    DetectionWorkspace trackingWs_;
+};
+
+
+/**
+  */
+Ptr<ArucoDetector> ArucoDetector::create(const Ptr<Dictionary> &dictionary,
+                                         const Ptr<DetectorParameters> &parameters) {
+    return makePtr<ArucoDetectorImpl>(dictionary, parameters);
+}
+
 /**
   */
 void estimatePoseSingleMarkers(InputArrayOfArrays _corners, float markerLength,
@@ -1091,6 +1374,192 @@ void estimatePoseSingleMarkers(InputArrayOfArrays _corners, float markerLength,
 }
 
 
+/**
+  * @brief Closed-form pose of a square marker from its undistorted corners in normalized
+  * coordinates (IPPE, Collins and Bartoli, "Infinitesimal Plane-Based Pose Estimation", 2014).
+  * The corners follow the order of _getSingleMarkerObjectPoints. Both solutions of the planar
+  * ambiguity are evaluated and the one with the lowest reprojection error is kept.
+  * Returns false for degenerate corners.
+  */
+static bool _solveSquarePoseIPPE(const Point2f *pts, double markerLength, const Matx33d &camMatrix,
+                                 Vec3d &rvec, Vec3d &tvec, double &reprojErr) {
+
+    const double x0 = pts[0].x, y0 = pts[0].y, x1 = pts[1].x, y1 = pts[1].y;
+    const double x2 = pts[2].x, y2 = pts[2].y, x3 = pts[3].x, y3 = pts[3].y;
+
+    // homography from the unit square (0,0), (1,0), (1,1), (0,1) to the corners
+    double sx = x0 - x1 + x2 - x3, sy = y0 - y1 + y2 - y3;
+    double dx1 = x1 - x2, dx2 = x3 - x2, dy1 = y1 - y2, dy2 = y3 - y2;
+    double den = dx1 * dy2 - dx2 * dy1;
+    if(std::fabs(den) < DBL_EPSILON) return false;
+    double g = (sx * dy2 - dx2 * sy) / den, h = (dx1 * sy - sx * dy1) / den;
+    double a = x1 - x0 + g * x1, b = x3 - x0 + h * x3, c = x0;
+    double d = y1 - y0 + g * y1, e = y3 - y0 + h * y3, f = y0;
+
+    // projection (p, q) of the marker center and jacobian of the marker plane to image mapping
+    // there. The unit square maps to the marker plane through X = L*(u - 1/2), Y = L*(1/2 - v)
+    double w = 0.5 * (g + h) + 1.;
+    if(std::fabs(w) < DBL_EPSILON) return false;
+    double p = (0.5 * (a + b) + c) / w, q = (0.5 * (d + e) + f) / w;
+    double wl = w * markerLength;
+    double j00 = (a - g * p) / wl, j01 = -(b - h * p) / wl;
+    double j10 = (d - g * q) / wl, j11 = -(e - h * q) / wl;
+
+    // Rv rotates the z axis onto the line of sight of the marker center
+    double nrm = std::sqrt(p * p + q * q + 1.);
+    double ax = p / nrm, ay = q / nrm, az = 1. / nrm;
+    double s = 1. / (1. + az);
+    Matx33d Rv(1. - ax * ax * s, -ax * ay * s, ax,
+               -ax * ay * s, 1. - ay * ay * s, ay,
+               -ax, -ay, 1. - (ax * ax + ay * ay) * s);
+
+    double b00 = Rv(0, 0) - p * Rv(2, 0), b01 = Rv(0, 1) - p * Rv(2, 1);
+    double b10 = Rv(1, 0) - q * Rv(2, 0), b11 = Rv(1, 1) - q * Rv(2, 1);
+    double bdet = b00 * b11 - b01 * b10;
+    if(std::fabs(bdet) < DBL_EPSILON) return false;
+    bdet = 1. / bdet;
+
+    // A = B^-1 * J, its largest singular value gives the scale of the 2x2 rotation part
+    double a00 = bdet * (b11 * j00 - b01 * j10), a01 = bdet * (b11 * j01 - b01 * j11);
+    double a10 = bdet * (b00 * j10 - b10 * j00), a11 = bdet * (b00 * j11 - b10 * j01);
+    double ata00 = a00 * a00 + a01 * a01, ata01 = a00 * a10 + a01 * a11, ata11 = a10 * a10 + a11 * a11;
+    double gamma = std::sqrt(0.5 * (ata00 + ata11 +
+                                    std::sqrt((ata00 - ata11) * (ata00 - ata11) + 4. * ata01 * ata01)));
+    if(gamma < DBL_EPSILON) return false;
+
+    double r00 = a00 / gamma, r01 = a01 / gamma, r10 = a10 / gamma, r11 = a11 / gamma;
+    double c0 = std::sqrt(std::max(0., 1. - r00 * r00 - r10 * r10));
+    double c1 = std::sqrt(std::max(0., 1. - r01 * r01 - r11 * r11));
+    if(-r00 * r01 - r10 * r11 < 0) c1 = -c1;
+
+    const double half = 0.5 * markerLength;
+    const double objX[4] = { -half, half, half, -half };
+    const double objY[4] = { half, half, -half, -half };
+
+    // the translation system only depends on the image points
+    double su = 0, sv = 0, suv = 0;
+    for(int k = 0; k < 4; k++) {
+        su += pts[k].x;
+        sv += pts[k].y;
+        suv += pts[k].x * pts[k].x + pts[k].y * pts[k].y;
+    }
+    const Matx33d ata(4., 0., -su,
+                      0., 4., -sv,
+                      -su, -sv, suv);
+
+    double bestErr = DBL_MAX;
+    for(int sol = 0; sol < 2; sol++) {
+        double sgn = sol == 0 ? 1. : -1.;
+        Vec3d col0(r00, r10, sgn * c0), col1(r01, r11, sgn * c1);
+        Vec3d col2 = col0.cross(col1);
+        Matx33d R = Rv * Matx33d(col0[0], col1[0], col2[0],
+                                 col0[1], col1[1], col2[1],
+                                 col0[2], col1[2], col2[2]);
+
+        // linear least squares for t from u * (R_3 * P + tz) = R_1 * P + tx (same for v)
+        Vec3d atb(0, 0, 0);
+        for(int k = 0; k < 4; k++) {
+            double z = R(2, 0) * objX[k] + R(2, 1) * objY[k];
+            double ex = pts[k].x * z - (R(0, 0) * objX[k] + R(0, 1) * objY[k]);
+            double ey = pts[k].y * z - (R(1, 0) * objX[k] + R(1, 1) * objY[k]);
+            atb[0] += ex;
+            atb[1] += ey;
+            atb[2] -= pts[k].x * ex + pts[k].y * ey;
+        }
+        Vec3d t = ata.solve(atb, DECOMP_LU);
+
+        // squared reprojection error in pixels, measured on the undistorted image
+        double err = 0;
+        for(int k = 0; k < 4 && err < bestErr; k++) {
+            Vec3d P(R(0, 0) * objX[k] + R(0, 1) * objY[k] + t[0],
+                    R(1, 0) * objX[k] + R(1, 1) * objY[k] + t[1],
+                    R(2, 0) * objX[k] + R(2, 1) * objY[k] + t[2]);
+            if(P[2] <= 0) {
+                err = DBL_MAX;
+                break;
+            }
+            double ex = P[0] / P[2] - pts[k].x, ey = P[1] / P[2] - pts[k].y;
+            double ux = camMatrix(0, 0) * ex + camMatrix(0, 1) * ey, uy = camMatrix(1, 1) * ey;
+            err += ux * ux + uy * uy;
+        }
+
+        if(err < bestErr) {
+            bestErr = err;
+            Rodrigues(R, rvec);
+            tvec = t;
+        }
+    }
+    if(bestErr == DBL_MAX) return false;
+
+    reprojErr = std::sqrt(bestErr / 4.);
+    return true;
+}
+
+
+/**
+  */
+void estimatePoseSingleMarkersBatch(InputArrayOfArrays _corners, float markerLength,
+                                    InputArray _cameraMatrix, InputArray _distCoeffs,
+                                    OutputArray _rvecs, OutputArray _tvecs,
+                                    OutputArray _reprojectionErrors, OutputArray _objPoints) {
+
+    CV_Assert(markerLength > 0);
+    CV_Assert(!_cameraMatrix.empty());
+
+    Mat markerObjPoints;
+    _getSingleMarkerObjectPoints(markerLength, markerObjPoints);
+    int nMarkers = (int)_corners.total();
+    _rvecs.create(nMarkers, 1, CV_64FC3);
+    _tvecs.create(nMarkers, 1, CV_64FC3);
+    Mat rvecs = _rvecs.getMat(), tvecs = _tvecs.getMat();
+
+    Mat reprojErrs;
+    if(_reprojectionErrors.needed()) {
+        _reprojectionErrors.create(nMarkers, 1, CV_64F);
+        reprojErrs = _reprojectionErrors.getMat();
+    }
+
+    if(nMarkers > 0) {
+        // gather all the corners and undistort them at once
+        Mat imgPoints(4 * nMarkers, 1, CV_32FC2), normPoints;
+        for(int i = 0; i < nMarkers; i++) {
+            Mat corners = _corners.getMat(i);
+            CV_Assert(corners.total() == 4 && corners.channels() == 2);
+            Mat dst = imgPoints.rowRange(4 * i, 4 * i + 4);
+            corners.reshape(2, 4).convertTo(dst, CV_32F);
+        }
+        undistortPoints(imgPoints, normPoints, _cameraMatrix, _distCoeffs);
+
+        Matx33d camMatrix;
+        _cameraMatrix.getMat().convertTo(camMatrix, CV_64F);
+        const Point2f *normalized = normPoints.ptr< Point2f >();
+
+        const int nstripes = std::min(nMarkers, 4 * std::max(1, getNumThreads()));
+        parallel_for_(Range(0, nMarkers), [&](const Range& range) {
+            for(int i = range.start; i < range.end; i++) {
+                Vec3d &rvec = rvecs.at< Vec3d >(i), &tvec = tvecs.at< Vec3d >(i);
+                double err = 0;
+                if(!_solveSquarePoseIPPE(normalized + 4 * i, markerLength, camMatrix, rvec, tvec, err)) {
+                    Mat corners = imgPoints.rowRange(4 * i, 4 * i + 4);
+                    solvePnP(markerObjPoints, corners, _cameraMatrix, _distCoeffs, rvec, tvec);
+                    if(!reprojErrs.empty()) {
+                        vector< Point2f > projected;
+                        projectPoints(markerObjPoints, rvec, tvec, _cameraMatrix, _distCoeffs, projected);
+                        err = norm(Mat(projected).reshape(2, 4), corners, NORM_L2) / 2.;
+                    }
+                }
+                if(!reprojErrs.empty())
+                    reprojErrs.at< double >(i) = err;
+            }
+        }, nstripes);
+    }
+
+    if(_objPoints.needed()){
+        markerObjPoints.convertTo(_objPoints, -1);
+    }
+}
+
+
 
 void getBoardObjectAndImagePoints(const Ptr<Board> &board, InputArrayOfArrays detectedCorners,
     InputArray detectedIds, OutputArray objPoints, OutputArray imgPoints) {
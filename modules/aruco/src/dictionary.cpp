@@ -92,6 +92,109 @@ Ptr<Dictionary> Dictionary::get(int dict) {
 }
 
 
+/**
+ * @brief Multi-index hash over the marker codewords in their 4 rotations
+ *
+ * Each codeword is split into maxCorrectionBits + 1 disjoint substrings. Any codeword within
+ * maxCorrectionBits of a query matches it exactly in at least one substring, so only the entries
+ * of the matching buckets need to be compared.
+ */
+struct Dictionary::Index {
+    // bytesList properties at build time, to detect when the index is outdated
+    const uchar *data;
+    int rows;
+    int markerSize;
+    int maxCorrectionBits;
+
+    int nbytes;
+    std::vector< uint64 > codes;           // codeword of each entry, entry = marker * 4 + rotation
+    std::vector< int > substringStart;     // first bit of each substring, plus the total of bits
+    // per substring, (substring value, entry) pairs sorted by value
+    std::vector< std::vector< std::pair< uint64, int > > > tables;
+
+    bool isValidFor(const Dictionary &dictionary) const {
+        return data == dictionary.bytesList.data && rows == dictionary.bytesList.rows &&
+               markerSize == dictionary.markerSize && maxCorrectionBits == dictionary.maxCorrectionBits;
+    }
+
+    uint64 substring(uint64 code, int k) const {
+        int len = substringStart[k + 1] - substringStart[k];
+        uint64 mask = len >= 64 ? ~(uint64)0 : (((uint64)1 << len) - 1);
+        return (code >> substringStart[k]) & mask;
+    }
+};
+
+
+static uint64 _packCode(const uchar *bytes, int nbytes) {
+    uint64 code = 0;
+    for(int j = 0; j < nbytes; j++)
+        code = (code << 8) | bytes[j];
+    return code;
+}
+
+
+static int _popCount(uint64 x) {
+    int count = 0;
+    for(; x != 0; count++)
+        x &= x - 1;
+    return count;
+}
+
+
+static Mutex &_getIndexMutex() {
+    static Mutex mutex;
+    return mutex;
+}
+
+
+/**
+ * @brief Get the (lazily built) index, or an empty pointer if indexing is not worth it
+ */
+Ptr<Dictionary::Index> Dictionary::getIndex() const {
+
+    AutoLock lock(_getIndexMutex());
+    if(index_ && index_->isValidFor(*this))
+        return index_->tables.empty() ? Ptr<Index>() : index_;
+
+    Ptr<Index> index = makePtr<Index>();
+    index->data = bytesList.data;
+    index->rows = bytesList.rows;
+    index->markerSize = markerSize;
+    index->maxCorrectionBits = maxCorrectionBits;
+    index->nbytes = (markerSize * markerSize + 8 - 1) / 8;
+    index_ = index;
+
+    // small dictionaries are faster with the linear search, and codewords must fit in 64 bits
+    const int minEntries = 64, minSubstringBits = 4;
+    int nbits = 8 * index->nbytes;
+    int nsubstrings = maxCorrectionBits + 1;
+    if(bytesList.empty() || 4 * bytesList.rows < minEntries || index->nbytes > 8 || maxCorrectionBits < 0 ||
+       nbits / nsubstrings < minSubstringBits)
+        return Ptr<Index>();
+
+    int nentries = 4 * bytesList.rows;
+    index->codes.resize(nentries);
+    for(int m = 0; m < bytesList.rows; m++) {
+        for(int r = 0; r < 4; r++)
+            index->codes[4 * m + r] = _packCode(bytesList.ptr(m) + r * index->nbytes, index->nbytes);
+    }
+
+    index->substringStart.resize(nsubstrings + 1);
+    for(int k = 0; k <= nsubstrings; k++)
+        index->substringStart[k] = k * nbits / nsubstrings;
+
+    index->tables.resize(nsubstrings);
+    for(int k = 0; k < nsubstrings; k++) {
+        std::vector< std::pair< uint64, int > > &table = index->tables[k];
+        table.resize(nentries);
+        for(int e = 0; e < nentries; e++)
+            table[e] = std::make_pair(index->substring(index->codes[e], k), e);
+        std::sort(table.begin(), table.end());
+    }
+    return index;
+}
+
+
 /**
  */
 bool Dictionary::identify(const Mat &onlyBits, int &idx, int &rotation,
@@ -106,6 +209,37 @@ bool Dictionary::identify(const Mat &onlyBits, int &idx, int &rotation,
 
     idx = -1; // by default, not found
 
+    Ptr<Index> index = getIndex();
+    if(index && maxCorrectionRecalculed <= index->maxCorrectionBits) {
+        // same result as the linear search: lowest marker id within the allowed distance, and its
+        // closest rotation (the lowest one in case of tie)
+        uint64 query = _packCode(candidateBytes.ptr(), index->nbytes);
+        int bestMarker = bytesList.rows, bestDistance = 0, bestRotation = 0;
+        for(size_t k = 0; k < index->tables.size(); k++) {
+            const std::vector< std::pair< uint64, int > > &table = index->tables[k];
+            uint64 key = index->substring(query, (int)k);
+            std::vector< std::pair< uint64, int > >::const_iterator it =
+                std::lower_bound(table.begin(), table.end(), std::make_pair(key, -1));
+            for(; it != table.end() && it->first == key; ++it) {
+                int m = it->second / 4, r = it->second % 4;
+                if(m > bestMarker) continue;
+                int distance = _popCount(index->codes[it->second] ^ query);
+                if(distance > maxCorrectionRecalculed) continue;
+                if(m < bestMarker || distance < bestDistance ||
+                   (distance == bestDistance && r < bestRotation)) {
+                    bestMarker = m;
+                    bestDistance = distance;
+                    bestRotation = r;
+                }
+            }
+        }
+        if(bestMarker < bytesList.rows) {
+            idx = bestMarker;
+            rotation = bestRotation;
+        }
+        return idx != -1;
+    }
+
     // search closest marker in dict
     for(int m = 0; m < bytesList.rows; m++) {
         int currentMinDistance = markerSize * markerSize + 1;
@@ -554,4 +554,71 @@ TEST(CV_ArucoBitCorrection, algorithmic) {
     test.safe_run();
 }
 
+TEST(CV_ArucoDetector, reusedStateMatchesDetectMarkers) {
+    Ptr<aruco::Dictionary> dictionary = aruco::getPredefinedDictionary(aruco::DICT_6X6_250);
+    Ptr<aruco::DetectorParameters> params = aruco::DetectorParameters::create();
+    Ptr<aruco::ArucoDetector> detector = aruco::ArucoDetector::create(dictionary, params);
+
+    const int markerSidePixels = 100;
+    for(int i = 0; i < 4; i++) {
+        Mat img(500, 500, CV_8UC1, Scalar::all(255));
+        Mat marker;
+        aruco::drawMarker(dictionary, i, markerSidePixels, marker);
+        marker.copyTo(img(Rect(50 + 60 * i, 50 + 40 * i, markerSidePixels, markerSidePixels)));
+        aruco::drawMarker(dictionary, i + 10, markerSidePixels, marker);
+        marker.copyTo(img(Rect(370, 300 - 50 * i, markerSidePixels, markerSidePixels)));
+        // alternate grey and color inputs to exercise the reused conversion buffer
+        if(i % 2 == 1) cvtColor(img, img, COLOR_GRAY2BGR);
+
+        vector< vector< Point2f > > corners, expectedCorners;
+        vector< int > ids, expectedIds;
+        aruco::detectMarkers(img, dictionary, expectedCorners, expectedIds, params);
+        detector->detectMarkers(img, corners, ids);
+
+        ASSERT_EQ(2u, ids.size());
+        ASSERT_EQ(expectedIds, ids);
+        for(size_t m = 0; m < ids.size(); m++) {
+            for(int c = 0; c < 4; c++)
+                EXPECT_LE(cv::norm(expectedCorners[m][c] - corners[m][c]), 1e-5);
+        }
+    }
+}
+
+TEST(CV_ArucoDetector, trackingMode) {
+    Ptr<aruco::Dictionary> dictionary = aruco::getPredefinedDictionary(aruco::DICT_6X6_250);
+    Ptr<aruco::DetectorParameters> params = aruco::DetectorParameters::create();
+    params->cornerRefinementMethod = aruco::CORNER_REFINE_SUBPIX;
+    Ptr<aruco::ArucoDetector> detector = aruco::ArucoDetector::create(dictionary, params);
+    detector->setTracking(true, 4);
+    EXPECT_TRUE(detector->getTracking());
+
+    const int markerSidePixels = 80;
+    for(int frame = 0; frame < 10; frame++) {
+        // markers slowly moving, the second one disappears in the last frames
+        Mat img(480, 640, CV_8UC1, Scalar::all(255));
+        Mat marker;
+        aruco::drawMarker(dictionary, 3, markerSidePixels, marker);
+        marker.copyTo(img(Rect(60 + 2 * frame, 80 + frame, markerSidePixels, markerSidePixels)));
+        bool secondVisible = frame < 7;
+        if(secondVisible) {
+            aruco::drawMarker(dictionary, 7, markerSidePixels, marker);
+            marker.copyTo(img(Rect(400 - frame, 300, markerSidePixels, markerSidePixels)));
+        }
+
+        vector< vector< Point2f > > corners, expectedCorners;
+        vector< int > ids, expectedIds;
+        aruco::detectMarkers(img, dictionary, expectedCorners, expectedIds, params);
+        detector->detectMarkers(img, corners, ids);
+
+        ASSERT_EQ(secondVisible ? 2u : 1u, ids.size()) << "frame " << frame;
+        ASSERT_EQ(expectedIds.size(), ids.size());
+        for(size_t m = 0; m < ids.size(); m++) {
+            size_t e = std::find(expectedIds.begin(), expectedIds.end(), ids[m]) - expectedIds.begin();
+            ASSERT_LT(e, expectedIds.size());
+            for(int c = 0; c < 4; c++)
+                EXPECT_LE(cv::norm(expectedCorners[e][c] - corners[m][c]), 0.1) << "frame " << frame;
+        }
+    }
+}
+
 }} // namespace
@@ -24,4 +24,102 @@ TEST(CV_ArucoDrawMarker, regression_1226)
     });
 }
 
+TEST(CV_ArucoDictionary, identifyMatchesLinearSearch)
+{
+    const int dictionaries[] = { aruco::DICT_4X4_250, aruco::DICT_5X5_1000, aruco::DICT_6X6_1000,
+                                 aruco::DICT_7X7_50, aruco::DICT_APRILTAG_36h11 };
+    RNG rng(1234);
+    for(size_t d = 0; d < sizeof(dictionaries) / sizeof(dictionaries[0]); d++) {
+        Ptr<aruco::Dictionary> dictionary = aruco::getPredefinedDictionary(dictionaries[d]);
+        const int nMarkers = dictionary->bytesList.rows;
+        for(int i = 0; i < 200; i++) {
+            int id = rng.uniform(0, nMarkers);
+            Mat bits = aruco::Dictionary::getBitsFromByteList(dictionary->bytesList.rowRange(id, id + 1),
+                                                              dictionary->markerSize);
+            // flip a few bits, sometimes more than the correction capability
+            int nFlips = rng.uniform(0, dictionary->maxCorrectionBits + 2);
+            for(int f = 0; f < nFlips; f++) {
+                uchar &bit = bits.at< uchar >(rng.uniform(0, bits.rows), rng.uniform(0, bits.cols));
+                bit = (uchar)(1 - bit);
+            }
+
+            const double correctionRate = 0.6;
+            int maxCorrection = int(double(dictionary->maxCorrectionBits) * correctionRate);
+            int expectedId = -1;
+            for(int m = 0; m < nMarkers && expectedId < 0; m++) {
+                if(dictionary->getDistanceToId(bits, m) <= maxCorrection)
+                    expectedId = m;
+            }
+
+            int idx = -1, rotation = -1;
+            bool found = dictionary->identify(bits, idx, rotation, correctionRate);
+            EXPECT_EQ(expectedId >= 0, found);
+            EXPECT_EQ(expectedId, idx);
+            if(found)
+                EXPECT_LE(dictionary->getDistanceToId(bits, idx), maxCorrection);
+            if(nFlips == 0)
+                EXPECT_EQ(0, rotation);
+        }
+    }
+}
+
+TEST(CV_ArucoPoseSingleMarkersBatch, matchesProjection)
+{
+    const float markerLength = 0.05f;
+    Mat cameraMatrix = (Mat_<double>(3, 3) << 800, 0, 320, 0, 820, 240, 0, 0, 1);
+    Mat distCoeffs = (Mat_<double>(1, 5) << -0.1, 0.02, 0.001, -0.001, 0);
+    const float half = markerLength / 2.f;
+    vector< Point3f > objPoints;
+    objPoints.push_back(Point3f(-half, half, 0));
+    objPoints.push_back(Point3f(half, half, 0));
+    objPoints.push_back(Point3f(half, -half, 0));
+    objPoints.push_back(Point3f(-half, -half, 0));
+
+    RNG rng(4321);
+    vector< vector< Point2f > > corners;
+    vector< Vec3d > expectedR, expectedT;
+    for(int i = 0; i < 100; i++) {
+        // markers facing the camera, tilted up to ~45 degrees
+        Mat tilt = (Mat_<double>(3, 1) << rng.uniform(-0.8, 0.8), rng.uniform(-0.8, 0.8), rng.uniform(-3., 3.));
+        Mat Rt, Rflip;
+        Rodrigues(tilt, Rt);
+        Rodrigues(Vec3d(CV_PI, 0, 0), Rflip);
+        Vec3d rvec;
+        Rodrigues(Mat(Rflip * Rt), rvec);
+        Vec3d tvec(rng.uniform(-0.1, 0.1), rng.uniform(-0.08, 0.08), rng.uniform(0.3, 1.0));
+
+        vector< Point2f > projected;
+        projectPoints(objPoints, rvec, tvec, cameraMatrix, distCoeffs, projected);
+        corners.push_back(projected);
+        expectedR.push_back(rvec);
+        expectedT.push_back(tvec);
+    }
+
+    vector< Vec3d > rvecs, tvecs;
+    vector< double > errors;
+    aruco::estimatePoseSingleMarkersBatch(corners, markerLength, cameraMatrix, distCoeffs, rvecs, tvecs, errors);
+    ASSERT_EQ(corners.size(), rvecs.size());
+    ASSERT_EQ(corners.size(), tvecs.size());
+    ASSERT_EQ(corners.size(), errors.size());
+
+    for(size_t i = 0; i < corners.size(); i++) {
+        Mat R, Rexpected;
+        Rodrigues(rvecs[i], R);
+        Rodrigues(expectedR[i], Rexpected);
+        EXPECT_LE(cvtest::norm(R, Rexpected, NORM_INF), 1e-3) << "marker " << i;
+        EXPECT_LE(cvtest::norm(tvecs[i], expectedT[i], NORM_INF), 1e-4) << "marker " << i;
+        EXPECT_LE(errors[i], 1e-2) << "marker " << i;
+
+        vector< Point2f > projected;
+        projectPoints(objPoints, rvecs[i], tvecs[i], cameraMatrix, distCoeffs, projected);
+        EXPECT_LE(cvtest::norm(projected, corners[i], NORM_INF), 1e-2) << "marker " << i;
+    }
+
+    // the output storage is reused and kept in sync with the number of markers
+    corners.resize(10);
+    aruco::estimatePoseSingleMarkersBatch(corners, markerLength, cameraMatrix, distCoeffs, rvecs, tvecs, errors);
+    EXPECT_EQ(10u, rvecs.size());
+    EXPECT_EQ(10u, errors.size());
+}
+
 }} // namespace
@@ -0,0 +1,63 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+typedef tuple<std::string, Size> BarcodeParams_t;
+typedef perf::TestBaseWithParam<BarcodeParams_t> Barcode_single;
+typedef perf::TestBaseWithParam<BarcodeParams_t> Barcode_multi;
+
+static Mat loadBarcodeImage(const std::string& path, Size sz)
+{
+    Mat img = imread(getDataPath(path));
+    CV_Assert(!img.empty());
+    resize(img, img, sz, 0, 0, INTER_LINEAR_EXACT);
+    return img;
+}
+
+PERF_TEST_P(Barcode_single, detectAndDecode,
+            Combine(Values("book.jpg", "bottle_1.jpg", "bottle_2.jpg"),
+                    Values(Size(480, 360), Size(640, 480), Size(800, 600))))
+{
+    Mat img = loadBarcodeImage("cv/barcode/single/" + get<0>(GetParam()), get<1>(GetParam()));
+    barcode::BarcodeDetector bardet;
+    std::vector<std::string> infos;
+    std::vector<barcode::BarcodeType> types;
+    std::vector<Point2f> corners;
+
+    TEST_CYCLE() bardet.detectAndDecode(img, infos, types, corners);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Barcode_multi, detect,
+            Combine(Values("4_barcodes.jpg"),
+                    Values(Size(680, 907), Size(1361, 1815), Size(2041, 2722))))
+{
+    Mat img = loadBarcodeImage("cv/barcode/multiple/" + get<0>(GetParam()), get<1>(GetParam()));
+    barcode::BarcodeDetector bardet;
+    std::vector<Point2f> corners;
+
+    TEST_CYCLE() bardet.detect(img, corners);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Barcode_multi, detectAndDecode,
+            Combine(Values("4_barcodes.jpg"),
+                    Values(Size(680, 907), Size(1361, 1815), Size(2041, 2722))))
+{
+    Mat img = loadBarcodeImage("cv/barcode/multiple/" + get<0>(GetParam()), get<1>(GetParam()));
+    barcode::BarcodeDetector bardet;
+    std::vector<std::string> infos;
+    std::vector<barcode::BarcodeType> types;
+    std::vector<Point2f> corners;
+
+    TEST_CYCLE() bardet.detectAndDecode(img, infos, types, corners);
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
@@ -84,24 +84,30 @@ void BarDecode::init(const vector<Mat> &bar_imgs_)
 
 bool BarDecode::decodeMultiplyProcess()
 {
-    static float constexpr THRESHOLD_CONF = 0.6f;
     result_info.clear();
     result_info.resize(bar_imgs.size());
     parallel_for_(Range(0, int(bar_imgs.size())), [&](const Range &range) {
+        // the binarizations are shared by the decoders, they are computed on first use
+        // into buffers reused by the images of the range
+        std::array<Mat, sizeof(binary_types) / sizeof(binary_types[0])> bin_bars;
         for (int i = range.start; i < range.end; i++)
         {
-            Mat bin_bar;
             Result max_res;
             float max_conf = -1.f;
             bool decoded = false;
+            uint binarized = 0;
             for (const auto &decoder:getDecoders())
             {
                 if (decoded)
                 { break; }
-                for (const auto binary_type : binary_types)
+                for (size_t j = 0; j < bin_bars.size(); j++)
                 {
-                    binarize(bar_imgs[i], bin_bar, binary_type);
-                    auto cur_res = decoder->decodeROI(bin_bar);
+                    if ((binarized & (1u << j)) == 0)
+                    {
+                        binarize(bar_imgs[i], bin_bars[j], binary_types[j]);
+                        binarized |= 1u << j;
+                    }
+                    auto cur_res = decoder->decodeROI(bin_bars[j]);
                     if (cur_res.second > max_conf)
                     {
                         max_res = cur_res.first;
@@ -139,20 +145,21 @@ public:
 // return cropped and scaled bar img
 vector<Mat> BarcodeDetector::Impl::initDecode(const Mat &src, const vector<vector<Point2f>> &points) const
 {
-    vector<Mat> bar_imgs;
-    for (auto &corners : points)
-    {
-        Mat bar_img;
-        cropROI(src, bar_img, corners);
-//        sharpen(bar_img, bar_img);
-        // empirical settings
-        if (bar_img.cols < 320 || bar_img.cols > 640)
+    vector<Mat> bar_imgs(points.size());
+    parallel_for_(Range(0, int(points.size())), [&](const Range &range) {
+        for (int i = range.start; i < range.end; i++)
         {
-            float scale = 560.0f / static_cast<float>(bar_img.cols);
-            sr->processImageScale(bar_img, bar_img, scale, use_nn_sr);
+            Mat &bar_img = bar_imgs[i];
+            cropROI(src, bar_img, points[i]);
+//            sharpen(bar_img, bar_img);
+            // empirical settings
+            if (bar_img.cols < 320 || bar_img.cols > 640)
+            {
+                float scale = 560.0f / static_cast<float>(bar_img.cols);
+                sr->processImageScale(bar_img, bar_img, scale, use_nn_sr);
+            }
         }
-        bar_imgs.emplace_back(bar_img);
-    }
+    });
     return bar_imgs;
 
 }
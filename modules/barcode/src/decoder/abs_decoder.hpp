@@ -63,6 +63,9 @@ void cropROI(const Mat &_src, Mat &_dst, const std::vector<Point2f> &rect);
 
 void fillCounter(const std::vector<uchar> &row, uint start, Counter &counter);
 
+//! confidence above which a decoding result is accepted without trying the other decoders
+constexpr static float THRESHOLD_CONF = 0.6f;
+
 constexpr static uint INTEGER_MATH_SHIFT = 8;
 constexpr static uint PATTERN_MATCH_RESULT_SCALE_FACTOR = 1 << INTEGER_MATH_SHIFT;
 
@@ -26,6 +26,8 @@ public:
 private:
     dnn::Net srnet_;
     bool net_loaded_ = false;
+    //! the rectangles are scaled in parallel, the net runs one forward at a time
+    Mutex srnet_mutex_;
 
     int superResolutionScale(const cv::Mat &src, cv::Mat &dst);
 };
@@ -130,6 +130,25 @@ int UPCEANDecoder::decodeDigit(const std::vector<uchar> &row, Counter &counters,
     // -1 is Mismatch or means error.
 }
 
+// the lines are checksum-valid results, the remaining lines can neither change the majority nor
+// bring the confidence below the acceptance threshold, so they don't need to be decoded
+static bool isVoteDecided(const std::map<std::string, int> &result_vote, const std::string &max_result,
+                          int vote_cnt, int total_vote, int remaining)
+{
+    if ((float) vote_cnt / (float) DIVIDE_PART <= THRESHOLD_CONF || (vote_cnt << 2) < total_vote + remaining)
+    {
+        return false;
+    }
+    for (const auto &vote : result_vote)
+    {
+        if (vote.first != max_result && vote.second + remaining > vote_cnt)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 /*Input a ROI mat return result */
 std::pair<Result, float> UPCEANDecoder::decodeROI(const Mat &bar_img) const
 {
@@ -168,6 +187,10 @@ std::pair<Result, float> UPCEANDecoder::decodeROI(const Mat &bar_img) const
                 max_result = result.result;
                 max_type = result.format;
             }
+            if (isVoteDecided(result_vote, max_result, vote_cnt, total_vote, DIVIDE_PART - i - 1))
+            {
+                break;
+            }
         }
     }
     if (total_vote == 0 || (vote_cnt << 2) < total_vote)
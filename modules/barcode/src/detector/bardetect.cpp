@@ -20,22 +20,6 @@ static constexpr float HALF_PI = static_cast<float>(CV_PI / 2);
     (result) = (bottom_right - bottom_left - top_right + top_left);
 
 
-inline bool Detect::isValidCoord(const Point &coord, const Size &limit)
-{
-    if ((coord.x < 0) || (coord.y < 0))
-    {
-        return false;
-    }
-
-    if ((unsigned) coord.x > (unsigned) (limit.width - 1) || ((unsigned) coord.y > (unsigned) (limit.height - 1)))
-    {
-        return false;
-    }
-
-    return true;
-}
-
-
 void Detect::init(const Mat &src)
 {
     const double min_side = std::min(src.size().width, src.size().height);
@@ -82,13 +66,22 @@ void Detect::localization()
     // empirical setting
     static constexpr float SCALE_LIST[] = {0.01f, 0.03f, 0.06f, 0.08f};
     const auto min_side = static_cast<float>(std::min(width, height));
-    int window_size;
+    vector<CoherenceMaps> maps;
     for (const float scale:SCALE_LIST)
     {
-        window_size = cvRound(min_side * scale);
-        calCoherence(window_size);
-        barcodeErode();
-        regionGrowing(window_size);
+        CoherenceMaps scale_maps;
+        scale_maps.window_size = cvRound(min_side * scale);
+        if (scale_maps.window_size > 0)
+        {
+            maps.push_back(scale_maps);
+        }
+    }
+    // all the window sizes are read from the same integral images at once
+    calCoherence(maps);
+    for (auto &scale_maps : maps)
+    {
+        barcodeErode(scale_maps.coherence);
+        regionGrowing(scale_maps);
     }
 
 }
@@ -167,41 +160,48 @@ void Detect::preprocess()
 }
 
 
-// Change coherence orientation edge_nums
-// depend on width height integral_edges integral_x_sq integral_y_sq integral_xy
-void Detect::calCoherence(int window_size)
+namespace {
+
+class CoherenceBody : public ParallelLoopBody
 {
-    static constexpr float THRESHOLD_COHERENCE = 0.9f;
-    int right_col, left_col, top_row, bottom_row;
-    float xy, x_sq, y_sq, d, rect_area;
-    const float THRESHOLD_AREA = float(window_size * window_size) * 0.42f;
-    Size new_size(width / window_size, height / window_size);
-    coherence = Mat(new_size, CV_8U), orientation = Mat(new_size, CV_32F), edge_nums = Mat(new_size, CV_32F);
-
-    float top_left, top_right, bottom_left, bottom_right;
-    int integral_cols = width + 1;
-    const auto *edges_ptr = integral_edges.ptr<float_t>(), *x_sq_ptr = integral_x_sq.ptr<float_t>(), *y_sq_ptr = integral_y_sq.ptr<float_t>(), *xy_ptr = integral_xy.ptr<float_t>();
-    for (int y = 0; y < new_size.height; y++)
+public:
+    CoherenceBody(vector<CoherenceMaps> &_maps, const vector<int> &_first_rows, int _width, int _height,
+                  const Mat &_integral_edges, const Mat &_integral_x_sq, const Mat &_integral_y_sq, const Mat &_integral_xy)
+            : maps(_maps), first_rows(_first_rows), width(_width), height(_height), integral_edges(_integral_edges),
+              integral_x_sq(_integral_x_sq), integral_y_sq(_integral_y_sq), integral_xy(_integral_xy)
+    {}
+
+    // the range enumerates the grid rows of all the window sizes one after the other
+    void operator()(const Range &range) const CV_OVERRIDE
     {
-        auto *coherence_row = coherence.ptr<uint8_t>(y);
-        auto *orientation_row = orientation.ptr<float_t>(y);
-        auto *edge_nums_row = edge_nums.ptr<float_t>(y);
-        if (y * window_size >= height)
+        for (int r = range.start; r < range.end; r++)
         {
-            continue;
+            size_t i = std::upper_bound(first_rows.begin(), first_rows.end(), r) - first_rows.begin() - 1;
+            calCoherenceRow(maps[i], r - first_rows[i]);
         }
+    }
+
+private:
+    void calCoherenceRow(CoherenceMaps &scale_maps, int y) const
+    {
+        static constexpr float THRESHOLD_COHERENCE = 0.9f;
+        const int window_size = scale_maps.window_size;
+        int right_col, left_col, top_row, bottom_row;
+        float xy, x_sq, y_sq, d, rect_area;
+        const float THRESHOLD_AREA = float(window_size * window_size) * 0.42f;
+
+        float top_left, top_right, bottom_left, bottom_right;
+        int integral_cols = width + 1;
+        const auto *edges_ptr = integral_edges.ptr<float_t>(), *x_sq_ptr = integral_x_sq.ptr<float_t>(), *y_sq_ptr = integral_y_sq.ptr<float_t>(), *xy_ptr = integral_xy.ptr<float_t>();
+
+        auto *coherence_row = scale_maps.coherence.ptr<uint8_t>(y);
+        auto *orientation_row = scale_maps.orientation.ptr<float_t>(y);
+        auto *edge_nums_row = scale_maps.edge_nums.ptr<float_t>(y);
         top_row = y * window_size;
         bottom_row = min(height, (y + 1) * window_size);
 
-        for (int pos = 0; pos < new_size.width; pos++)
+        for (int pos = 0; pos < scale_maps.coherence.cols; pos++)
         {
-
-            // then calculate the column locations of the rectangle and set them to -1
-            // if they are outside the matrix bounds
-            if (pos * window_size >= width)
-            {
-                continue;
-            }
             left_col = pos * window_size;
             right_col = min(width, (pos + 1) * window_size);
 
@@ -230,135 +230,247 @@ void Detect::calCoherence(int window_size)
             {
                 coherence_row[pos] = 0;
             }
-
         }
+    }
+
+    vector<CoherenceMaps> &maps;
+    const vector<int> &first_rows;
+    const int width, height;
+    const Mat &integral_edges, &integral_x_sq, &integral_y_sq, &integral_xy;
+
+    CoherenceBody &operator=(const CoherenceBody &);
+};
 
+// the root of a set is its smallest cell index, i.e. the first cell of the region in raster order
+inline int findRoot(int *parent, int i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
     }
+    return i;
 }
 
-// will change localization_bbox bbox_scores
-// will change coherence,
-// depend on coherence orientation edge_nums
-void Detect::regionGrowing(int window_size)
+inline void unite(int *parent, int a, int b)
 {
-    static constexpr float LOCAL_THRESHOLD_COHERENCE = 0.95f, THRESHOLD_RADIAN =
-            PI / 30, LOCAL_RATIO = 0.5f, EXPANSION_FACTOR = 1.2f;
-    static constexpr uint THRESHOLD_BLOCK_NUM = 35;
-    Point pt_to_grow, pt;                       //point to grow
-
-    float src_value;
-    float cur_value;
-    float edge_num;
-    float rect_orientation;
-    float sin_sum, cos_sum;
-    uint counter;
-    //grow direction
-    static constexpr int DIR[8][2] = {{-1, -1},
-                                      {0,  -1},
-                                      {1,  -1},
-                                      {1,  0},
-                                      {1,  1},
-                                      {0,  1},
-                                      {-1, 1},
-                                      {-1, 0}};
-    vector<Point2f> growingPoints, growingImgPoints;
-    for (int y = 0; y < coherence.rows; y++)
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a < b)
+    {
+        parent[b] = a;
+    }
+    else if (b < a)
     {
-        auto *coherence_row = coherence.ptr<uint8_t>(y);
+        parent[a] = b;
+    }
+}
+
+static constexpr float THRESHOLD_RADIAN = PI / 30;
 
-        for (int x = 0; x < coherence.cols; x++)
+inline bool isSimilarOrientation(float a, float b)
+{
+    const float diff = abs(a - b);
+    return diff < THRESHOLD_RADIAN || diff > PI - THRESHOLD_RADIAN;
+}
+
+// joins the coherent cells with a similar orientation, the 8-connected neighbours above a cell are
+// only visited inside of its strip, the strip borders are joined afterwards
+class RegionUnionBody : public ParallelLoopBody
+{
+public:
+    RegionUnionBody(const Mat &_coherence, const Mat &_orientation, int *_parent, int _strip_rows)
+            : coherence(_coherence), orientation(_orientation), parent(_parent), strip_rows(_strip_rows)
+    {}
+
+    void operator()(const Range &range) const CV_OVERRIDE
+    {
+        const int cols = coherence.cols;
+        for (int strip = range.start; strip < range.end; strip++)
         {
-            if (coherence_row[x] == 0)
-            {
-                continue;
-            }
-            // flag
-            coherence_row[x] = 0;
-            growingPoints.clear();
-            growingImgPoints.clear();
-
-            pt = Point(x, y);
-            cur_value = orientation.at<float_t>(pt);
-            sin_sum = sin(2 * cur_value);
-            cos_sum = cos(2 * cur_value);
-            counter = 1;
-            edge_num = edge_nums.at<float_t>(pt);
-            growingPoints.push_back(pt);
-            growingImgPoints.push_back(Point(pt));
-            while (!growingPoints.empty())
+            const int y0 = strip * strip_rows, y1 = std::min(coherence.rows, y0 + strip_rows);
+            for (int y = y0; y < y1; y++)
             {
-                pt = growingPoints.back();
-                growingPoints.pop_back();
-                src_value = orientation.at<float_t>(pt);
-
-                //growing in eight directions
-                for (auto i : DIR)
+                const auto *coherence_row = coherence.ptr<uint8_t>(y);
+                const auto *orientation_row = orientation.ptr<float_t>(y);
+                int *parent_row = parent + y * cols;
+                for (int x = 0; x < cols; x++)
                 {
-                    pt_to_grow = Point(pt.x + i[0], pt.y + i[1]);
-
-                    //check if out of boundary
-                    if (!isValidCoord(pt_to_grow, coherence.size()))
+                    parent_row[x] = coherence_row[x] != 0 ? y * cols + x : -1;
+                }
+                for (int x = 0; x < cols; x++)
+                {
+                    if (parent_row[x] < 0)
                     {
                         continue;
                     }
-
-                    if (coherence.at<uint8_t>(pt_to_grow) == 0)
+                    if (x > 0 && parent_row[x - 1] >= 0 && isSimilarOrientation(orientation_row[x], orientation_row[x - 1]))
                     {
-                        continue;
+                        unite(parent, y * cols + x, y * cols + x - 1);
                     }
-                    cur_value = orientation.at<float_t>(pt_to_grow);
-                    if (abs(cur_value - src_value) < THRESHOLD_RADIAN ||
-                        abs(cur_value - src_value) > PI - THRESHOLD_RADIAN)
+                    if (y > y0)
                     {
-                        coherence.at<uint8_t>(pt_to_grow) = 0;
-                        sin_sum += sin(2 * cur_value);
-                        cos_sum += cos(2 * cur_value);
-                        counter += 1;
-                        edge_num += edge_nums.at<float_t>(pt_to_grow);
-                        growingPoints.push_back(pt_to_grow);                 //push next point to grow back to stack
-                        growingImgPoints.push_back(pt_to_grow);
+                        uniteAbove(y, x);
                     }
                 }
             }
-            //minimum block num
-            if (counter < THRESHOLD_BLOCK_NUM)
+        }
+    }
+
+    void uniteAbove(int y, int x) const
+    {
+        const int cols = coherence.cols;
+        const auto *orientation_row = orientation.ptr<float_t>(y);
+        const auto *prev_orientation_row = orientation.ptr<float_t>(y - 1);
+        const int *prev_parent_row = parent + (y - 1) * cols;
+        for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, cols - 1); nx++)
+        {
+            if (prev_parent_row[nx] >= 0 && isSimilarOrientation(orientation_row[x], prev_orientation_row[nx]))
             {
-                continue;
+                unite(parent, y * cols + x, (y - 1) * cols + nx);
             }
-            float local_coherence = (sin_sum * sin_sum + cos_sum * cos_sum) / static_cast<float>(counter * counter);
-            // minimum local gradient orientation_arg coherence_arg
-            if (local_coherence < LOCAL_THRESHOLD_COHERENCE)
+        }
+    }
+
+private:
+    const Mat &coherence, &orientation;
+    int *parent;
+    const int strip_rows;
+
+    RegionUnionBody &operator=(const RegionUnionBody &);
+};
+
+struct Region
+{
+    float sin_sum = 0.f, cos_sum = 0.f, edge_num = 0.f;
+    uint counter = 0;
+    vector<Point> points;
+};
+
+}
+
+// Change coherence orientation edge_nums
+// depend on width height integral_edges integral_x_sq integral_y_sq integral_xy
+void Detect::calCoherence(vector<CoherenceMaps> &maps) const
+{
+    vector<int> first_rows;
+    int total_rows = 0;
+    for (auto &scale_maps : maps)
+    {
+        const int window_size = scale_maps.window_size;
+        Size new_size(width / window_size, height / window_size);
+        scale_maps.coherence = Mat(new_size, CV_8U);
+        scale_maps.orientation = Mat(new_size, CV_32F);
+        scale_maps.edge_nums = Mat(new_size, CV_32F);
+        first_rows.push_back(total_rows);
+        total_rows += new_size.height;
+    }
+    parallel_for_(Range(0, total_rows),
+                  CoherenceBody(maps, first_rows, width, height, integral_edges, integral_x_sq, integral_y_sq, integral_xy));
+}
+
+// will change localization_bbox bbox_scores
+// will change coherence,
+// depend on coherence orientation edge_nums
+void Detect::regionGrowing(CoherenceMaps &maps)
+{
+    static constexpr float LOCAL_THRESHOLD_COHERENCE = 0.95f, LOCAL_RATIO = 0.5f, EXPANSION_FACTOR = 1.2f;
+    static constexpr uint THRESHOLD_BLOCK_NUM = 35;
+    static constexpr int STRIP_ROWS = 16;
+    const Mat &coherence = maps.coherence, &orientation = maps.orientation, &edge_nums = maps.edge_nums;
+    const int window_size = maps.window_size;
+    const int rows = coherence.rows, cols = coherence.cols;
+    float rect_orientation;
+
+    // the regions are the connected components of the similar orientation graph, they are labelled
+    // with a union-find over strips of rows instead of growing them one by one
+    vector<int> parent(rows * cols);
+    const int strips = (rows + STRIP_ROWS - 1) / STRIP_ROWS;
+    RegionUnionBody body(coherence, orientation, parent.data(), STRIP_ROWS);
+    parallel_for_(Range(0, strips), body);
+    for (int strip = 1; strip < strips; strip++)
+    {
+        const int y = strip * STRIP_ROWS;
+        for (int x = 0; x < cols; x++)
+        {
+            if (parent[y * cols + x] >= 0)
             {
-                continue;
+                body.uniteAbove(y, x);
             }
-            RotatedRect minRect = minAreaRect(growingImgPoints);
-            if (edge_num < minRect.size.area() * float(window_size * window_size) * LOCAL_RATIO ||
-                static_cast<float>(counter) < minRect.size.area() * LOCAL_RATIO)
+        }
+    }
+
+    // the regions are enumerated by their first cell in raster order, as the seeds of the growing were
+    vector<Region> regions;
+    vector<int> region_index(rows * cols, -1);
+    for (int y = 0; y < rows; y++)
+    {
+        const auto *orientation_row = orientation.ptr<float_t>(y);
+        const auto *edge_nums_row = edge_nums.ptr<float_t>(y);
+        for (int x = 0; x < cols; x++)
+        {
+            const int i = y * cols + x;
+            if (parent[i] < 0)
             {
                 continue;
             }
-            const float local_orientation = atan2(cos_sum, sin_sum) / 2.0f;
-            // only orientation_arg is approximately equal to the rectangle orientation_arg
-            rect_orientation = (minRect.angle) * PI / 180.f;
-            if (minRect.size.width < minRect.size.height)
+            const int root = findRoot(parent.data(), i);
+            if (root == i)
             {
-                rect_orientation += (rect_orientation <= 0.f ? HALF_PI : -HALF_PI);
-                std::swap(minRect.size.width, minRect.size.height);
+                region_index[i] = static_cast<int>(regions.size());
+                regions.emplace_back();
             }
-            if (abs(local_orientation - rect_orientation) > THRESHOLD_RADIAN &&
-                abs(local_orientation - rect_orientation) < PI - THRESHOLD_RADIAN)
-            {
-                continue;
-            }
-            minRect.angle = local_orientation * 180.f / PI;
-            minRect.size.width *= static_cast<float>(window_size) * EXPANSION_FACTOR;
-            minRect.size.height *= static_cast<float>(window_size);
-            minRect.center.x = (minRect.center.x + 0.5f) * static_cast<float>(window_size);
-            minRect.center.y = (minRect.center.y + 0.5f) * static_cast<float>(window_size);
-            localization_bbox.push_back(minRect);
-            bbox_scores.push_back(edge_num);
+            Region &region = regions[region_index[root]];
+            const float cur_value = orientation_row[x];
+            region.sin_sum += sin(2 * cur_value);
+            region.cos_sum += cos(2 * cur_value);
+            region.counter += 1;
+            region.edge_num += edge_nums_row[x];
+            region.points.emplace_back(x, y);
+        }
+    }
 
+    for (const auto &region : regions)
+    {
+        const uint counter = region.counter;
+        //minimum block num
+        if (counter < THRESHOLD_BLOCK_NUM)
+        {
+            continue;
+        }
+        const float sin_sum = region.sin_sum, cos_sum = region.cos_sum, edge_num = region.edge_num;
+        float local_coherence = (sin_sum * sin_sum + cos_sum * cos_sum) / static_cast<float>(counter * counter);
+        // minimum local gradient orientation_arg coherence_arg
+        if (local_coherence < LOCAL_THRESHOLD_COHERENCE)
+        {
+            continue;
+        }
+        RotatedRect minRect = minAreaRect(region.points);
+        if (edge_num < minRect.size.area() * float(window_size * window_size) * LOCAL_RATIO ||
+            static_cast<float>(counter) < minRect.size.area() * LOCAL_RATIO)
+        {
+            continue;
+        }
+        const float local_orientation = atan2(cos_sum, sin_sum) / 2.0f;
+        // only orientation_arg is approximately equal to the rectangle orientation_arg
+        rect_orientation = (minRect.angle) * PI / 180.f;
+        if (minRect.size.width < minRect.size.height)
+        {
+            rect_orientation += (rect_orientation <= 0.f ? HALF_PI : -HALF_PI);
+            std::swap(minRect.size.width, minRect.size.height);
+        }
+        if (abs(local_orientation - rect_orientation) > THRESHOLD_RADIAN &&
+            abs(local_orientation - rect_orientation) < PI - THRESHOLD_RADIAN)
+        {
+            continue;
         }
+        minRect.angle = local_orientation * 180.f / PI;
+        minRect.size.width *= static_cast<float>(window_size) * EXPANSION_FACTOR;
+        minRect.size.height *= static_cast<float>(window_size);
+        minRect.center.x = (minRect.center.x + 0.5f) * static_cast<float>(window_size);
+        minRect.center.y = (minRect.center.y + 0.5f) * static_cast<float>(window_size);
+        localization_bbox.push_back(minRect);
+        bbox_scores.push_back(edge_num);
     }
 }
 
@@ -375,7 +487,7 @@ inline const std::array<Mat, 4> &getStructuringElement()
 }
 
 // Change mat
-void Detect::barcodeErode()
+void Detect::barcodeErode(Mat &coherence)
 {
     static const std::array<Mat, 4> &structuringElement = getStructuringElement();
     Mat m0, m1, m2, m3;
@@ -14,6 +14,13 @@ namespace cv {
 namespace barcode {
 using std::vector;
 
+//! coherence of the structure tensor over a grid of window_size x window_size cells
+struct CoherenceMaps
+{
+    int window_size;
+    Mat coherence, orientation, edge_nums;
+};
+
 class Detect
 {
 private:
@@ -43,17 +50,15 @@ protected:
 
     double coeff_expansion = 1.0;
     int height, width;
-    Mat resized_barcode, gradient_magnitude, coherence, orientation, edge_nums, integral_x_sq, integral_y_sq, integral_xy, integral_edges;
+    Mat resized_barcode, gradient_magnitude, integral_x_sq, integral_y_sq, integral_xy, integral_edges;
 
     void preprocess();
 
-    void calCoherence(int window_size);
-
-    static inline bool isValidCoord(const Point &coord, const Size &limit);
+    void calCoherence(vector<CoherenceMaps> &maps) const;
 
-    void regionGrowing(int window_size);
+    void regionGrowing(CoherenceMaps &maps);
 
-    void barcodeErode();
+    static void barcodeErode(Mat &coherence);
 
 
 };
@@ -65,6 +65,27 @@ TEST(Barcode_BarcodeDetector_detect_multi, detect_regression)
     }
 }
 
+TEST(Barcode_BarcodeDetector_detect_multi, same_result_with_threads)
+{
+    const std::string root = "barcode/multiple/";
+    datasetType validation = initValidation(root + "result.csv");
+    auto bardet = barcode::BarcodeDetector();
+    const int threads = getNumThreads();
+    for (datasetType::iterator iterator = validation.begin(); iterator != validation.end(); iterator++)
+    {
+        std::string image_path = findDataFile(root + iterator->first);
+        Mat src = imread(image_path);
+        ASSERT_FALSE(src.empty()) << "Can't read image: " << image_path;
+
+        std::vector<Point> corners, corners_single;
+        bardet.detect(src, corners);
+        setNumThreads(1);
+        bardet.detect(src, corners_single);
+        setNumThreads(threads);
+        EXPECT_EQ(corners, corners_single) << iterator->first;
+    }
+}
+
 TEST(Barcode_BarcodeDetector_basic, not_found_barcode)
 {
     auto bardet = barcode::BarcodeDetector();
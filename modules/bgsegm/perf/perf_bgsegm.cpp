@@ -0,0 +1,62 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+enum { BGS_CNT, BGS_CNT_HISTORY, BGS_GMG, BGS_GSOC, BGS_LSBP, BGS_MOG };
+CV_ENUM(BgSubtractorType, BGS_CNT, BGS_CNT_HISTORY, BGS_GMG, BGS_GSOC, BGS_LSBP, BGS_MOG)
+
+typedef tuple<Size, BgSubtractorType> BgSubtractorParams_t;
+typedef perf::TestBaseWithParam<BgSubtractorParams_t> BgSubtractor;
+
+static Ptr<BackgroundSubtractor> createSubtractor(int type)
+{
+    switch (type)
+    {
+    case BGS_CNT: return createBackgroundSubtractorCNT(15, false);
+    case BGS_CNT_HISTORY: return createBackgroundSubtractorCNT(15, true);
+    case BGS_GMG: return createBackgroundSubtractorGMG(20);
+    case BGS_GSOC: return createBackgroundSubtractorGSOC();
+    case BGS_LSBP: return createBackgroundSubtractorLSBP();
+    default: return createBackgroundSubtractorMOG();
+    }
+}
+
+PERF_TEST_P(BgSubtractor, apply, Combine(Values(szVGA, sz720p), BgSubtractorType::all()))
+{
+    const Size sz = get<0>(GetParam());
+    const int type = get<1>(GetParam());
+
+    Mat background = imread(getDataPath("cv/shared/fruits.png"));
+    Mat object = imread(getDataPath("cv/shared/baboon.png"));
+    ASSERT_FALSE(background.empty());
+    ASSERT_FALSE(object.empty());
+    resize(background, background, sz, 0, 0, INTER_LINEAR_EXACT);
+    resize(object, object, Size(sz.width / 6, sz.width / 6), 0, 0, INTER_LINEAR_EXACT);
+    Ptr<SyntheticSequenceGenerator> generator = createSyntheticSequenceGenerator(background, object);
+
+    const int numFrames = 30;
+    std::vector<Mat> frames(numFrames);
+    Mat gtMask;
+    for (int i = 0; i < numFrames; ++i)
+        generator->getNextFrame(frames[i], gtMask);
+
+    Ptr<BackgroundSubtractor> bgs = createSubtractor(type);
+    Mat fgMask;
+    // the model is initialized outside of the measured part
+    for (int i = 0; i < numFrames / 2; ++i)
+        bgs->apply(frames[i], fgMask);
+
+    int frameIdx = numFrames / 2;
+    TEST_CYCLE()
+    {
+        bgs->apply(frames[frameIdx], fgMask);
+        frameIdx = frameIdx + 1 < numFrames ? frameIdx + 1 : numFrames / 2;
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
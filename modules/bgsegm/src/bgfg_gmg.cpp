@@ -50,6 +50,7 @@
 
 #include "precomp.hpp"
 #include "opencv2/core/utility.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include <limits>
 
 namespace cv
@@ -223,7 +224,17 @@ void BackgroundSubtractorGMGImpl::initialize(Size frameSize, double minVal, doub
 
 static float findFeature(int color, const int* colors, const float* weights, int nfeatures)
 {
-    for (int i = 0; i < nfeatures; ++i)
+    int i = 0;
+#if CV_SIMD128
+    const v_int32x4 v_color = v_setall_s32(color);
+    for (; i <= nfeatures - 4; i += 4)
+    {
+        const int mask = v_signmask(v_load(colors + i) == v_color);
+        if (mask)
+            return weights[i + trailingZeros32(mask)];
+    }
+#endif
+    for (; i < nfeatures; ++i)
     {
         if (color == colors[i])
             return weights[i];
@@ -233,6 +244,18 @@ static float findFeature(int color, const int* colors, const float* weights, int
     return 0.0f;
 }
 
+static void scaleHistogram(float* weights, int nfeatures, float scale)
+{
+    int i = 0;
+#if CV_SIMD128
+    const v_float32x4 v_scale = v_setall_f32(scale);
+    for (; i <= nfeatures - 4; i += 4)
+        v_store(weights + i, v_load(weights + i) * v_scale);
+#endif
+    for (; i < nfeatures; ++i)
+        weights[i] *= scale;
+}
+
 static void normalizeHistogram(float* weights, int nfeatures)
 {
     float total = 0.0f;
@@ -295,16 +318,18 @@ static bool insertFeature(int color, float weight, int* colors, float* weights,
 
 template <typename T> struct Quantization
 {
-    static int apply(const void* src_, int x, int cn, double minVal, double maxVal, int quantizationLevels)
+    //! quantized colors of a row of pixels
+    static void apply(const void* src_, int* dst, int cols, int cn, double minVal, double maxVal, int quantizationLevels)
     {
         const T* src = static_cast<const T*>(src_);
-        src += x * cn;
-
-        unsigned int res = 0;
-        for (int i = 0, shift = 0; i < cn; ++i, ++src, shift += 8)
-            res |= static_cast<int>((*src - minVal) * quantizationLevels / (maxVal - minVal)) << shift;
 
-        return res;
+        for (int x = 0; x < cols; ++x)
+        {
+            unsigned int res = 0;
+            for (int i = 0, shift = 0; i < cn; ++i, ++src, shift += 8)
+                res |= static_cast<int>((*src - minVal) * quantizationLevels / (maxVal - minVal)) << shift;
+            dst[x] = res;
+        }
     }
 };
 
@@ -347,7 +372,7 @@ private:
 
 void GMG_LoopBody::operator() (const Range& range) const
 {
-    typedef int (*func_t)(const void* src_, int x, int cn, double minVal, double maxVal, int quantizationLevels);
+    typedef void (*func_t)(const void* src_, int* dst, int cols, int cn, double minVal, double maxVal, int quantizationLevels);
     static const func_t funcs[] =
     {
         Quantization<uchar>::apply,
@@ -363,20 +388,22 @@ void GMG_LoopBody::operator() (const Range& range) const
     CV_Assert(func != 0);
 
     const int cn = frame_.channels();
+    AutoBuffer<int> featureColors(frame_.cols);
 
     for (int y = range.start, featureIdx = y * frame_.cols; y < range.end; ++y)
     {
-        const uchar* frame_row = frame_.ptr(y);
         int* nfeatures_row = nfeatures_[y];
         uchar* fgmask_row = fgmask_[y];
 
+        func(frame_.ptr(y), featureColors.data(), frame_.cols, cn, minVal_, maxVal_, quantizationLevels_);
+
         for (int x = 0; x < frame_.cols; ++x, ++featureIdx)
         {
             int nfeatures = nfeatures_row[x];
             int* colors = colors_[featureIdx];
             float* weights = weights_[featureIdx];
 
-            int newFeatureColor = func(frame_row, x, cn, minVal_, maxVal_, quantizationLevels_);
+            int newFeatureColor = featureColors[x];
 
             bool isForeground = false;
 
@@ -395,8 +422,7 @@ void GMG_LoopBody::operator() (const Range& range) const
 
                 if (updateBackgroundModel_)
                 {
-                    for (int i = 0; i < nfeatures; ++i)
-                        weights[i] *= (float)(1.0f - learningRate_);
+                    scaleHistogram(weights, nfeatures, (float)(1.0f - learningRate_));
 
                     bool inserted = insertFeature(newFeatureColor, (float)learningRate_, colors, weights, nfeatures, maxFeatures_);
 
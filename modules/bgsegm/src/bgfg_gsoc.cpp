@@ -154,50 +154,81 @@ void removeNoise(Mat& fgMask, const Mat& compMask, const size_t threshold, const
                 fgMask.at<uchar>(i, j) = filler;
 }
 
-void FindSparseCorrLK(const Mat& src, const Mat& dst, std::vector<Point2f>& srcPoints, std::vector<Point2f>& dstPoints) {
-    Size size = src.size();
-    const unsigned blockSize = 16;
-
-    for (int x = blockSize / 2; x < size.width; x += blockSize)
-        for (int y = blockSize / 2; y < size.height; y += blockSize) {
-            srcPoints.push_back(Point2f(float(x), float(y)));
-            dstPoints.push_back(Point2f(float(x), float(y)));
+// Estimates the camera motion by tracking a regular grid of points from the current frame to the previous one.
+// The image pyramid of a frame is built once and serves as the target of the next frame,
+// the points are initialized with the motion found for the previous frame.
+class CameraMotionLK {
+public:
+    CameraMotionLK() : prevH(Matx33d::eye()) {}
+
+    // Finds the homography which maps the current frame to the previous one.
+    // Returns false on the first frame and when there is not enough tracked points.
+    bool estimate(const Mat& frame, Matx33d& H) {
+        const Size winSize(21, 21);
+        const int maxLevel = 3;
+        const unsigned blockSize = 16;
+
+        Mat frameGr;
+        frame.convertTo(frameGr, CV_8U, 255);
+        std::vector<Mat> pyr;
+        buildOpticalFlowPyramid(frameGr, pyr, winSize, maxLevel, true);
+
+        if (prevPyr.empty() || frame.size() != gridSize) {
+            gridSize = frame.size();
+            gridPoints.clear();
+            for (int x = blockSize / 2; x < gridSize.width; x += blockSize)
+                for (int y = blockSize / 2; y < gridSize.height; y += blockSize)
+                    gridPoints.push_back(Point2f(float(x), float(y)));
+            prevPyr.swap(pyr);
+            prevH = Matx33d::eye();
+            return false;
         }
 
-    std::vector<uchar> predictedStatus;
-    std::vector<float> predictedError;
-    Mat srcGr, dstGr;
-    src.copyTo(srcGr);
-    dst.copyTo(dstGr);
-    srcGr *= 255;
-    dstGr *= 255;
-    srcGr.convertTo(srcGr, CV_8UC3);
-    dstGr.convertTo(dstGr, CV_8UC3);
-
-    calcOpticalFlowPyrLK(srcGr, dstGr, srcPoints, dstPoints, predictedStatus, predictedError);
-
-    size_t j = 0;
-    for (size_t i = 0; i < srcPoints.size(); ++i) {
-        if (predictedStatus[i]) {
-            srcPoints[j] = srcPoints[i];
-            dstPoints[j] = dstPoints[i];
-            ++j;
+        perspectiveTransform(gridPoints, predictedPoints, prevH);
+        calcOpticalFlowPyrLK(pyr, prevPyr, gridPoints, predictedPoints, predictedStatus, predictedError, winSize, maxLevel,
+                             TermCriteria(TermCriteria::COUNT + TermCriteria::EPS, 30, 0.01), OPTFLOW_USE_INITIAL_FLOW);
+        prevPyr.swap(pyr);
+
+        srcPoints.clear();
+        dstPoints.clear();
+        for (size_t i = 0; i < gridPoints.size(); ++i) {
+            if (predictedStatus[i]) {
+                srcPoints.push_back(gridPoints[i]);
+                dstPoints.push_back(predictedPoints[i]);
+            }
         }
-    }
-    srcPoints.resize(j);
-    dstPoints.resize(j);
-}
 
-class BackgroundSampleGSOC {
-public:
-    Point3f color;
-    int desc;
-    uint64 time;
-    uint64 hits;
+        Mat Hm;
+        if (srcPoints.size() >= 4)
+            Hm = findHomography(srcPoints, dstPoints, LMEDS);
+        if (Hm.empty()) {
+            prevH = Matx33d::eye();
+            return false;
+        }
 
-    BackgroundSampleGSOC(Point3f c = Point3f(), int d = 0, uint64 t = 0, uint64 h = 0) : color(c), desc(d), time(t), hits(h) {}
+        H = prevH = Matx33d(Hm);
+        return true;
+    }
+
+private:
+    std::vector<Mat> prevPyr;
+    Matx33d prevH;
+    Size gridSize;
+    std::vector<Point2f> gridPoints, predictedPoints, srcPoints, dstPoints;
+    std::vector<uchar> predictedStatus;
+    std::vector<float> predictedError;
 };
 
+// Pixel rows are updated in stripes of a fixed height, each stripe with its own random stream,
+// so the results do not depend on the number of threads.
+const int updateStripeRows = 8;
+
+void generateStripeSeeds(RNG& rng, int rows, std::vector<uint64>& seeds) {
+    seeds.resize((rows + updateStripeRows - 1) / updateStripeRows);
+    for (size_t s = 0; s < seeds.size(); ++s)
+        seeds[s] = rng.next() | (uint64(rng.next()) << 32);
+}
+
 class BackgroundSampleLSBP {
 public:
     Point3f color;
@@ -207,6 +238,42 @@ public:
     BackgroundSampleLSBP(Point3f c = Point3f(), int d = 0, float mdd = 1e9f) : color(c), desc(d), minDecisionDist(mdd) {}
 };
 
+// Moves the samples of every pixel of the model to where the homography H maps the pixel to
+template<typename BackgroundModelType>
+class ParallelMotionCompensation : public ParallelLoopBody {
+private:
+    BackgroundModelType& dst;
+    const BackgroundModelType& src;
+    const Matx33d H;
+
+    ParallelMotionCompensation &operator=(const ParallelMotionCompensation&);
+
+public:
+    ParallelMotionCompensation(BackgroundModelType& _dst, const BackgroundModelType& _src, const Matx33d& _H) : dst(_dst), src(_src), H(_H) {};
+
+    void operator()(const Range &range) const CV_OVERRIDE {
+        const Size size = dst.getSize();
+        for (int i = range.start; i < range.end; ++i)
+            for (int j = 0; j < size.width; ++j) {
+                const double w = H(2, 0) * j + H(2, 1) * i + H(2, 2);
+                Point2f pf(0, 0);
+                if (std::abs(w) > FLT_EPSILON)
+                    pf = Point2f(float((H(0, 0) * j + H(0, 1) * i + H(0, 2)) / w), float((H(1, 0) * j + H(1, 1) * i + H(1, 2)) / w));
+
+                Point2i p = pf;
+                p.x = std::min(std::max(p.x, 0), size.width - 1);
+                p.y = std::min(std::max(p.y, 0), size.height - 1);
+
+                dst.copySamples(i * size.width + j, src, p.y * size.width + p.x);
+            }
+    }
+};
+
+template<typename BackgroundModelType>
+void compensateMotion(BackgroundModelType& dst, const BackgroundModelType& src, const Matx33d& H) {
+    parallel_for_(Range(0, dst.getSize().height), ParallelMotionCompensation<BackgroundModelType>(dst, src, H));
+}
+
 template<typename BackgroundSampleType>
 class BackgroundModel {
 protected:
@@ -224,22 +291,9 @@ public:
         samples.swap(bm.samples);
     }
 
-    void motionCompensation(const BackgroundModel& bm, const std::vector<Point2f>& points) {
-        for (int i = 0; i < size.height; ++i)
-                for (int j = 0; j < size.width; ++j) {
-                    Point2i p = points[j * size.height + i];
-                    if (p.x < 0)
-                        p.x = 0;
-                    if (p.y < 0)
-                        p.y = 0;
-                    if (p.x >= size.width)
-                        p.x = size.width - 1;
-                    if (p.y >= size.height)
-                        p.y = size.height - 1;
-
-                    for (int k = 0; k < nSamples; k++)
-                        samples[i * stride + j * nSamples + k] = bm.samples[p.y * stride + p.x * nSamples + k];
-                }
+    void copySamples(int pixel, const BackgroundModel& bm, int srcPixel) {
+        for (int k = 0; k < nSamples; k++)
+            samples[pixel * nSamples + k] = bm.samples[srcPixel * nSamples + k];
     }
 
     const BackgroundSampleType& operator()(int k) const {
@@ -263,33 +317,82 @@ public:
     }
 };
 
-class BackgroundModelGSOC : public BackgroundModel<BackgroundSampleGSOC> {
+// GSOC model with the fields of the samples stored in separate arrays,
+// the matching reads the colors only and the replacement reads the times only.
+class BackgroundModelGSOC {
+private:
+    std::vector<Point3f> colors;
+    std::vector<uint64> times;
+    std::vector<uint64> hits;
+    const Size size;
+    const int nSamples;
+    const int stride;
+
 public:
-    BackgroundModelGSOC(Size sz, int S) : BackgroundModel(sz, S) {};
+    BackgroundModelGSOC(Size sz, int S) : size(sz), nSamples(S), stride(sz.width * S) {
+        colors.resize(sz.area() * S);
+        times.resize(sz.area() * S);
+        hits.resize(sz.area() * S);
+    }
+
+    void swap(BackgroundModelGSOC& bm) {
+        colors.swap(bm.colors);
+        times.swap(bm.times);
+        hits.swap(bm.hits);
+    }
+
+    void copySamples(int pixel, const BackgroundModelGSOC& bm, int srcPixel) {
+        std::copy(bm.colors.begin() + srcPixel * nSamples, bm.colors.begin() + (srcPixel + 1) * nSamples, colors.begin() + pixel * nSamples);
+        std::copy(bm.times.begin() + srcPixel * nSamples, bm.times.begin() + (srcPixel + 1) * nSamples, times.begin() + pixel * nSamples);
+        std::copy(bm.hits.begin() + srcPixel * nSamples, bm.hits.begin() + (srcPixel + 1) * nSamples, hits.begin() + pixel * nSamples);
+    }
+
+    void initSamples(int i, int j, const Point3f& color) {
+        const int beg = i * stride + j * nSamples;
+        std::fill(colors.begin() + beg, colors.begin() + beg + nSamples, color);
+        std::fill(times.begin() + beg, times.begin() + beg + nSamples, uint64(0));
+        std::fill(hits.begin() + beg, hits.begin() + beg + nSamples, uint64(0));
+    }
+
+    Point3f& color(int k) {
+        return colors[k];
+    }
+
+    uint64& time(int k) {
+        return times[k];
+    }
+
+    uint64& hitCount(int k) {
+        return hits[k];
+    }
 
     float findClosest(int i, int j, const Point3f& color, int& indOut) const {
-        const int end = i * stride + (j + 1) * nSamples;
-        int minInd = i * stride + j * nSamples;
-        float minDist = L2sqdist(color - samples[minInd].color);
-        for (int k = minInd + 1; k < end; ++k) {
-            const float dist = L2sqdist(color - samples[k].color);
+        const int beg = i * stride + j * nSamples;
+        const Point3f* c = &colors[beg];
+        int minInd = 0;
+        float minDist = L2sqdist(color - c[0]);
+        for (int k = 1; k < nSamples; ++k) {
+            const float dist = L2sqdist(color - c[k]);
             if (dist < minDist) {
                 minInd = k;
                 minDist = dist;
             }
         }
-        indOut = minInd;
+        indOut = beg + minInd;
         return minDist;
     }
 
-    void replaceOldest(int i, int j, const BackgroundSampleGSOC& sample) {
-        const int end = i * stride + (j + 1) * nSamples;
-        int minInd = i * stride + j * nSamples;
-        for (int k = minInd + 1; k < end; ++k) {
-            if (samples[k].time < samples[minInd].time)
+    void replaceOldest(int i, int j, const Point3f& color, uint64 time, uint64 hitCount) {
+        const int beg = i * stride + j * nSamples;
+        const uint64* t = &times[beg];
+        int minInd = 0;
+        for (int k = 1; k < nSamples; ++k) {
+            if (t[k] < t[minInd])
                 minInd = k;
         }
-        samples[minInd] = sample;
+        colors[beg + minInd] = color;
+        times[beg + minInd] = time;
+        hits[beg + minInd] = hitCount;
     }
 
     Point3f getMean(int i, int j, uint64 threshold) const {
@@ -297,21 +400,25 @@ public:
         Point3f acc(0, 0, 0);
         int cnt = 0;
         for (int k = i * stride + j * nSamples; k < end; ++k) {
-            if (samples[k].hits > threshold) {
-                acc += samples[k].color;
+            if (hits[k] > threshold) {
+                acc += colors[k];
                 ++cnt;
             }
         }
         if (cnt == 0) {
             cnt = nSamples;
             for (int k = i * stride + j * nSamples; k < end; ++k)
-                acc += samples[k].color;
+                acc += colors[k];
         }
         acc.x /= cnt;
         acc.y /= cnt;
         acc.z /= cnt;
         return acc;
     }
+
+    Size getSize() const {
+        return size;
+    }
 };
 
 class BackgroundModelLSBP : public BackgroundModel<BackgroundSampleLSBP> {
@@ -474,9 +581,10 @@ private:
     const float noiseRemovalThresholdFacFG;
     Mat distMovingAvg;
     Mat prevFgMask;
-    Mat prevFrame;
     Mat blinkingSupression;
+    CameraMotionLK cameraMotion;
     RNG rng;
+    std::vector<uint64> stripeSeeds;
 
     void postprocessing(Mat& fgMask);
 
@@ -498,6 +606,7 @@ public:
     CV_WRAP virtual void getBackgroundImage(OutputArray backgroundImage) const CV_OVERRIDE;
 
     friend class ParallelGSOC;
+    friend class ParallelGSOCBlinkingSupression;
 };
 
 class BackgroundSubtractorLSBPImpl CV_FINAL : public BackgroundSubtractorLSBP {
@@ -519,8 +628,9 @@ private:
     const int minCount;
     Mat T;
     Mat R;
-    Mat prevFrame;
+    CameraMotionLK cameraMotion;
     RNG rng;
+    std::vector<uint64> stripeSeeds;
     Point2i LSBPSamplePoints[32];
 
     void postprocessing(Mat& fgMask);
@@ -555,53 +665,100 @@ private:
     const Mat& frame;
     const double learningRate;
     Mat& fgMask;
+    const int parity;
 
     ParallelGSOC &operator=(const ParallelGSOC&);
 
 public:
-    ParallelGSOC(const Size& _sz, BackgroundSubtractorGSOCImpl* _bgs, const Mat& _frame, double _learningRate, Mat& _fgMask)
-    : sz(_sz), bgs(_bgs), frame(_frame), learningRate(_learningRate), fgMask(_fgMask) {};
+    // Updates the stripes of the given parity, the samples of the stripes may be propagated to their neighbouring rows
+    ParallelGSOC(const Size& _sz, BackgroundSubtractorGSOCImpl* _bgs, const Mat& _frame, double _learningRate, Mat& _fgMask, int _parity)
+    : sz(_sz), bgs(_bgs), frame(_frame), learningRate(_learningRate), fgMask(_fgMask), parity(_parity) {};
 
     void operator()(const Range &range) const CV_OVERRIDE {
         BackgroundModelGSOC* backgroundModel = bgs->backgroundModel.get();
         Mat& distMovingAvg = bgs->distMovingAvg;
 
-        for (int index = range.start; index < range.end; ++index) {
-            const int i = index / sz.width, j = index % sz.width;
-            int k;
-            const float minDist = backgroundModel->findClosest(i, j, frame.at<Point3f>(i, j), k);
+        for (int stripe = 2 * range.start + parity; stripe < 2 * range.end + parity; stripe += 2) {
+            RNG rng(bgs->stripeSeeds[stripe]);
+            const int iEnd = std::min((stripe + 1) * updateStripeRows, sz.height);
+
+            for (int i = stripe * updateStripeRows; i < iEnd; ++i) {
+                const Point3f* frameRow = frame.ptr<Point3f>(i);
+                float* distRow = distMovingAvg.ptr<float>(i);
+                uchar* fgRow = fgMask.ptr<uchar>(i);
+
+                for (int j = 0; j < sz.width; ++j) {
+                    int k;
+                    const float minDist = backgroundModel->findClosest(i, j, frameRow[j], k);
+
+                    distRow[j] *= 1 - float(learningRate);
+                    distRow[j] += float(learningRate) * minDist;
+
+                    const float threshold = bgs->alpha * distRow[j] + bgs->beta;
+
+                    if (minDist > threshold) {
+                        fgRow[j] = 255;
+
+                        if (rng.uniform(0.0f, 1.0f) < bgs->replaceRate)
+                            backgroundModel->replaceOldest(i, j, frameRow[j], bgs->currentTime, 0);
+                    }
+                    else {
+                        Point3f& color = backgroundModel->color(k);
+                        uint64& hits = backgroundModel->hitCount(k);
+                        color *= 1 - learningRate;
+                        color += learningRate * frameRow[j];
+                        backgroundModel->time(k) = bgs->currentTime;
+                        ++hits;
+
+                        // Propagation to neighbors
+                        if (hits > bgs->hitsThreshold && rng.uniform(0.0f, 1.0f) < bgs->propagationRate) {
+                            const Point3f c = color;
+                            const uint64 h = hits;
+                            if (i + 1 < sz.height)
+                                backgroundModel->replaceOldest(i + 1, j, c, bgs->currentTime, h);
+                            if (j + 1 < sz.width)
+                                backgroundModel->replaceOldest(i, j + 1, c, bgs->currentTime, h);
+                            if (i > 0)
+                                backgroundModel->replaceOldest(i - 1, j, c, bgs->currentTime, h);
+                            if (j > 0)
+                                backgroundModel->replaceOldest(i, j - 1, c, bgs->currentTime, h);
+                        }
+
+                        fgRow[j] = 0;
+                    }
+                }
+            }
+        }
+    }
+};
+
+class ParallelGSOCBlinkingSupression : public ParallelLoopBody {
+private:
+    const Size sz;
+    BackgroundSubtractorGSOCImpl* bgs;
+    const Mat& frame;
+    const Mat& prob;
 
-            distMovingAvg.at<float>(i, j) *= 1 - float(learningRate);
-            distMovingAvg.at<float>(i, j) += float(learningRate) * minDist;
+    ParallelGSOCBlinkingSupression &operator=(const ParallelGSOCBlinkingSupression&);
 
-            const float threshold = bgs->alpha * distMovingAvg.at<float>(i, j) + bgs->beta;
-            BackgroundSampleGSOC& sample = (* backgroundModel)(k);
+public:
+    ParallelGSOCBlinkingSupression(const Size& _sz, BackgroundSubtractorGSOCImpl* _bgs, const Mat& _frame, const Mat& _prob)
+    : sz(_sz), bgs(_bgs), frame(_frame), prob(_prob) {};
 
-            if (minDist > threshold) {
-                fgMask.at<uchar>(i, j) = 255;
+    void operator()(const Range &range) const CV_OVERRIDE {
+        BackgroundModelGSOC* backgroundModel = bgs->backgroundModel.get();
 
-                if (bgs->rng.uniform(0.0f, 1.0f) < bgs->replaceRate)
-                    backgroundModel->replaceOldest(i, j, BackgroundSampleGSOC(frame.at<Point3f>(i, j), 0, bgs->currentTime));
-            }
-            else {
-                sample.color *= 1 - learningRate;
-                sample.color += learningRate * frame.at<Point3f>(i, j);
-                sample.time = bgs->currentTime;
-                ++sample.hits;
-
-                // Propagation to neighbors
-                if (sample.hits > bgs->hitsThreshold && bgs->rng.uniform(0.0f, 1.0f) < bgs->propagationRate) {
-                    if (i + 1 < sz.height)
-                        backgroundModel->replaceOldest(i + 1, j, sample);
-                    if (j + 1 < sz.width)
-                        backgroundModel->replaceOldest(i, j + 1, sample);
-                    if (i > 0)
-                        backgroundModel->replaceOldest(i - 1, j, sample);
-                    if (j > 0)
-                        backgroundModel->replaceOldest(i, j - 1, sample);
-                }
+        for (int stripe = range.start; stripe < range.end; ++stripe) {
+            RNG rng(bgs->stripeSeeds[stripe]);
+            const int iEnd = std::min((stripe + 1) * updateStripeRows, sz.height);
 
-                fgMask.at<uchar>(i, j) = 0;
+            for (int i = stripe * updateStripeRows; i < iEnd; ++i) {
+                const Point3f* frameRow = frame.ptr<Point3f>(i);
+                const float* probRow = prob.ptr<float>(i);
+
+                for (int j = 0; j < sz.width; ++j)
+                    if (rng.uniform(0.0f, 1.0f) < probRow[j])
+                        backgroundModel->replaceOldest(i, j, frameRow[j], bgs->currentTime, 0);
             }
         }
     }
@@ -615,53 +772,66 @@ private:
     const double learningRate;
     const Mat& LSBPDesc;
     Mat& fgMask;
+    const int parity;
 
     ParallelLSBP &operator=(const ParallelLSBP&);
 
 public:
-    ParallelLSBP(const Size& _sz, BackgroundSubtractorLSBPImpl* _bgs, const Mat& _frame, double _learningRate, const Mat& _LSBPDesc, Mat& _fgMask)
-    : sz(_sz), bgs(_bgs), frame(_frame), learningRate(_learningRate), LSBPDesc(_LSBPDesc), fgMask(_fgMask) {};
+    // Updates the stripes of the given parity, the samples of the stripes may be copied to their neighbouring rows
+    ParallelLSBP(const Size& _sz, BackgroundSubtractorLSBPImpl* _bgs, const Mat& _frame, double _learningRate, const Mat& _LSBPDesc, Mat& _fgMask, int _parity)
+    : sz(_sz), bgs(_bgs), frame(_frame), learningRate(_learningRate), LSBPDesc(_LSBPDesc), fgMask(_fgMask), parity(_parity) {};
 
     void operator()(const Range &range) const CV_OVERRIDE {
         BackgroundModelLSBP* backgroundModel = bgs->backgroundModel.get();
         Mat& T = bgs->T;
         Mat& R = bgs->R;
 
-        for (int index = range.start; index < range.end; ++index) {
-            const int i = index / sz.width, j = index % sz.width;
+        for (int stripe = 2 * range.start + parity; stripe < 2 * range.end + parity; stripe += 2) {
+            RNG rng(bgs->stripeSeeds[stripe]);
+            const int iEnd = std::min((stripe + 1) * updateStripeRows, sz.height);
 
-            float minDist = 1e9f;
-            const float DMean = backgroundModel->getDMean(i, j);
+            for (int i = stripe * updateStripeRows; i < iEnd; ++i) {
+                const Point3f* frameRow = frame.ptr<Point3f>(i);
+                const int* descRow = LSBPDesc.ptr<int>(i);
+                float* TRow = T.ptr<float>(i);
+                float* RRow = R.ptr<float>(i);
+                uchar* fgRow = fgMask.ptr<uchar>(i);
 
-            if (R.at<float>(i, j) > DMean * bgs->Rscale)
-                R.at<float>(i, j) *= 1 - bgs->Rincdec;
-            else
-                R.at<float>(i, j) *= 1 + bgs->Rincdec;
+                for (int j = 0; j < sz.width; ++j) {
+                    float minDist = 1e9f;
+                    const float DMean = backgroundModel->getDMean(i, j);
 
-            if (backgroundModel->countMatches(i, j, frame.at<Point3f>(i, j), LSBPDesc.at<int>(i, j), R.at<float>(i, j), bgs->LSBPthreshold, minDist) < bgs->minCount) {
-                fgMask.at<uchar>(i, j) = 255;
+                    if (RRow[j] > DMean * bgs->Rscale)
+                        RRow[j] *= 1 - bgs->Rincdec;
+                    else
+                        RRow[j] *= 1 + bgs->Rincdec;
 
-                T.at<float>(i, j) += bgs->Tinc / DMean;
-            }
-            else {
-                fgMask.at<uchar>(i, j) = 0;
+                    if (backgroundModel->countMatches(i, j, frameRow[j], descRow[j], RRow[j], bgs->LSBPthreshold, minDist) < bgs->minCount) {
+                        fgRow[j] = 255;
 
-                T.at<float>(i, j) -= bgs->Tdec / DMean;
+                        TRow[j] += bgs->Tinc / DMean;
+                    }
+                    else {
+                        fgRow[j] = 0;
 
-                if (bgs->rng.uniform(0.0f, 1.0f) < 1 / T.at<float>(i, j))
-                    (* backgroundModel)(i, j, bgs->rng.uniform(0, bgs->nSamples)) = BackgroundSampleLSBP(frame.at<Point3f>(i, j), LSBPDesc.at<int>(i, j), minDist);
+                        TRow[j] -= bgs->Tdec / DMean;
 
-                if (bgs->rng.uniform(0.0f, 1.0f) < 1 / T.at<float>(i, j)) {
-                    const int oi = i + bgs->rng.uniform(-1, 2);
-                    const int oj = j + bgs->rng.uniform(-1, 2);
+                        if (rng.uniform(0.0f, 1.0f) < 1 / TRow[j])
+                            (* backgroundModel)(i, j, rng.uniform(0, bgs->nSamples)) = BackgroundSampleLSBP(frameRow[j], descRow[j], minDist);
 
-                    if (oi >= 0 && oi < sz.height && oj >= 0 && oj < sz.width)
-                        (* backgroundModel)(oi, oj, bgs->rng.uniform(0, bgs->nSamples)) = BackgroundSampleLSBP(frame.at<Point3f>(oi, oj), LSBPDesc.at<int>(oi, oj), minDist);
+                        if (rng.uniform(0.0f, 1.0f) < 1 / TRow[j]) {
+                            const int oi = i + rng.uniform(-1, 2);
+                            const int oj = j + rng.uniform(-1, 2);
+
+                            if (oi >= 0 && oi < sz.height && oj >= 0 && oj < sz.width)
+                                (* backgroundModel)(oi, oj, rng.uniform(0, bgs->nSamples)) = BackgroundSampleLSBP(frame.at<Point3f>(oi, oj), LSBPDesc.at<int>(oi, oj), minDist);
+                        }
+                    }
+
+                    TRow[j] = std::min(TRow[j], bgs->Tupper);
+                    TRow[j] = std::max(TRow[j], bgs->Tlower);
                 }
             }
-
-            T.at<float>(i, j) = std::min(T.at<float>(i, j), bgs->Tupper);
-            T.at<float>(i, j) = std::max(T.at<float>(i, j), bgs->Tlower);
         }
     }
 };
@@ -736,47 +906,28 @@ void BackgroundSubtractorGSOCImpl::apply(InputArray _image, OutputArray _fgmask,
 
         for (int i = 0; i < sz.height; ++i)
             for (int j = 0; j < sz.width; ++j) {
-                BackgroundSampleGSOC sample(frame.at<Point3f>(i, j), 0);
-                for (int k = 0; k < nSamples; ++k) {
-                    (* backgroundModel)(i, j, k) = sample;
-                    (* backgroundModelPrev)(i, j, k) = sample;
-                }
+                backgroundModel->initSamples(i, j, frame.at<Point3f>(i, j));
+                backgroundModelPrev->initSamples(i, j, frame.at<Point3f>(i, j));
             }
     }
 
     CV_Assert(backgroundModel->getSize() == sz);
 
-    if (motionCompensation) {
-        std::vector<Point2f> srcPoints;
-        std::vector<Point2f> dstPoints;
-
-        if (prevFrame.empty())
-            frame.copyTo(prevFrame);
-
-        if (motionCompensation == LSBP_CAMERA_MOTION_COMPENSATION_LK)
-            FindSparseCorrLK(frame, prevFrame, srcPoints, dstPoints);
-
-        if (srcPoints.size()) {
-            Mat H = findHomography(srcPoints, dstPoints, LMEDS);
-
-            srcPoints.clear();
-            for (int x = 0; x < sz.width; ++x)
-                for (int y = 0; y < sz.height; ++y)
-                    srcPoints.push_back(Point2f(float(x), float(y)));
-            dstPoints.resize(srcPoints.size());
-            perspectiveTransform(srcPoints, dstPoints, H);
-
+    if (motionCompensation == LSBP_CAMERA_MOTION_COMPENSATION_LK) {
+        Matx33d H;
+        if (cameraMotion.estimate(frame, H)) {
             backgroundModel->swap(* backgroundModelPrev);
-            backgroundModel->motionCompensation(* backgroundModelPrev, dstPoints);
+            compensateMotion(* backgroundModel, * backgroundModelPrev, H);
         }
-
-        frame.copyTo(prevFrame);
     }
 
     if (learningRate > 1 || learningRate < 0)
         learningRate = 0.1;
 
-    parallel_for_(Range(0, sz.area()), ParallelGSOC(sz, this, frame, learningRate, fgMask));
+    generateStripeSeeds(rng, sz.height, stripeSeeds);
+    const int nStripes = (int)stripeSeeds.size();
+    for (int parity = 0; parity < 2; ++parity)
+        parallel_for_(Range(0, (nStripes + 1 - parity) / 2), ParallelGSOC(sz, this, frame, learningRate, fgMask, parity));
 
     ++currentTime;
 
@@ -785,10 +936,8 @@ void BackgroundSubtractorGSOCImpl::apply(InputArray _image, OutputArray _fgmask,
     fgMask.copyTo(prevFgMask);
     Mat prob = blinkingSupression * (blinkingSupressionMultiplier * (1 - blinkingSupressionDecay) / blinkingSupressionDecay);
 
-    for (int i = 0; i < sz.height; ++i)
-        for (int j = 0; j < sz.width; ++j)
-            if (rng.uniform(0.0f, 1.0f) < prob.at<float>(i, j))
-                backgroundModel->replaceOldest(i, j, BackgroundSampleGSOC(frame.at<Point3f>(i, j), 0, currentTime));
+    generateStripeSeeds(rng, sz.height, stripeSeeds);
+    parallel_for_(Range(0, (int)stripeSeeds.size()), ParallelGSOCBlinkingSupression(sz, this, frame, prob));
 
     this->postprocessing(fgMask);
 }
@@ -893,37 +1042,21 @@ void BackgroundSubtractorLSBPImpl::apply(InputArray _image, OutputArray _fgmask,
 
     CV_Assert(backgroundModel->getSize() == sz);
 
-    if (motionCompensation) {
-        std::vector<Point2f> srcPoints;
-        std::vector<Point2f> dstPoints;
-
-        if (prevFrame.empty())
-            frame.copyTo(prevFrame);
-
-        if (motionCompensation == LSBP_CAMERA_MOTION_COMPENSATION_LK)
-            FindSparseCorrLK(frame, prevFrame, srcPoints, dstPoints);
-
-        if (srcPoints.size()) {
-            Mat H = findHomography(srcPoints, dstPoints, LMEDS);
-
-            srcPoints.clear();
-            for (int x = 0; x < sz.width; ++x)
-                for (int y = 0; y < sz.height; ++y)
-                    srcPoints.push_back(Point2f(float(x), float(y)));
-            dstPoints.resize(srcPoints.size());
-            perspectiveTransform(srcPoints, dstPoints, H);
-
+    if (motionCompensation == LSBP_CAMERA_MOTION_COMPENSATION_LK) {
+        Matx33d H;
+        if (cameraMotion.estimate(frame, H)) {
             backgroundModel->swap(* backgroundModelPrev);
-            backgroundModel->motionCompensation(* backgroundModelPrev, dstPoints);
+            compensateMotion(* backgroundModel, * backgroundModelPrev, H);
         }
-
-        frame.copyTo(prevFrame);
     }
 
     if (learningRate > 1 || learningRate < 0)
         learningRate = 0.1;
 
-    parallel_for_(Range(0, sz.area()), ParallelLSBP(sz, this, frame, learningRate, LSBPDesc, fgMask));
+    generateStripeSeeds(rng, sz.height, stripeSeeds);
+    const int nStripes = (int)stripeSeeds.size();
+    for (int parity = 0; parity < 2; ++parity)
+        parallel_for_(Range(0, (nStripes + 1 - parity) / 2), ParallelLSBP(sz, this, frame, learningRate, LSBPDesc, fgMask, parity));
 
     this->postprocessing(fgMask);
 }
@@ -43,6 +43,7 @@
 
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include <functional>
 
 namespace cv
@@ -167,6 +168,16 @@ class CNTFunctor
 {
 public:
     virtual void operator()(Vec4i &vec, uchar currColor, uchar prevColor, uchar &fgMaskPixelRef) = 0;
+
+    //! processes a row of pixels, fgMaskRow is set to 255 for the foreground pixels and left untouched otherwise
+    virtual void processRow(Vec4i* row, const uchar* frameRow, const uchar* prevFrameRow, uchar* fgMaskRow, int cols)
+    {
+        for (int c = 0; c < cols; ++c)
+        {
+            (*this)(row[c], frameRow[c], prevFrameRow[c], fgMaskRow[c]);
+        }
+    }
+
     //! the destructor
     virtual ~CNTFunctor() {}
 };
@@ -209,6 +220,47 @@ struct BGSubtractPixel : public CNTFunctor
         }
     }
 
+#if CV_SIMD128
+    // branchless update of 4 pixels, returns the foreground mask
+    inline v_int32x4 update(v_int32x4& stability, v_int32x4& bgImg, const v_int32x4& currColor, const v_int32x4& prevColor) const
+    {
+        const v_int32x4 zero = v_setzero_s32();
+        const v_int32x4 same = v_reinterpret_as_s32(v_absdiff(currColor, prevColor)) < v_setall_s32(threshold);
+        const v_int32x4 incremented = stability + v_setall_s32(1);
+        const v_int32x4 isBg = same & (incremented == v_setall_s32(minPixelStability));
+
+        stability = v_select(same, v_select(isBg, stability, incremented), zero);
+        bgImg = v_select(isBg, prevColor, bgImg);
+        return ~isBg;
+    }
+
+    void processRow(Vec4i* row, const uchar* frameRow, const uchar* prevFrameRow, uchar* fgMaskRow, int cols) CV_OVERRIDE
+    {
+        int c = 0;
+        for (; c <= cols - 8; c += 8)
+        {
+            v_uint32x4 curr[2], prev[2];
+            v_expand(v_load_expand(frameRow + c), curr[0], curr[1]);
+            v_expand(v_load_expand(prevFrameRow + c), prev[0], prev[1]);
+
+            v_int32x4 fg[2];
+            for (int k = 0; k < 2; ++k)
+            {
+                int* vec = row[c + 4 * k].val;
+                v_int32x4 stability, history, histStability, bgImg;
+                v_load_deinterleave(vec, stability, history, histStability, bgImg);
+                fg[k] = update(stability, bgImg, v_reinterpret_as_s32(curr[k]), v_reinterpret_as_s32(prev[k]));
+                v_store_interleave(vec, stability, history, histStability, bgImg);
+            }
+            v_pack_store((schar*)(fgMaskRow + c), v_pack(fg[0], fg[1]));
+        }
+        for (; c < cols; ++c)
+        {
+            (*this)(row[c], frameRow[c], prevFrameRow[c], fgMaskRow[c]);
+        }
+    }
+#endif
+
     int minPixelStability;
     int threshold;
     const Mat &frame;
@@ -298,6 +350,63 @@ struct BGSubtractPixelWithHistory : public CNTFunctor
 
     }
 
+#if CV_SIMD128
+    // branchless update of 4 pixels, returns the foreground mask
+    inline v_int32x4 update(v_int32x4& stability, v_int32x4& historyColor, v_int32x4& histStability, v_int32x4& bgImg,
+                            const v_int32x4& currColor, const v_int32x4& prevColor) const
+    {
+        const v_int32x4 zero = v_setzero_s32();
+        const v_int32x4 minStability = v_setall_s32(minPixelStability), maxStability = v_setall_s32(maxPixelStability);
+        // the masks are -1 where set, subtracting a mask increments the counter
+        const v_int32x4 histIncr = histStability - (histStability < maxStability);
+        const v_int32x4 histDecr = histStability + (histStability > zero);
+
+        // no change compared to history
+        const v_int32x4 sameAsHistory = v_reinterpret_as_s32(v_absdiff(currColor, historyColor)) < v_setall_s32(thresholdHistory);
+        const v_int32x4 historyBg = sameAsHistory & (histIncr > minStability);
+        // no change compared to prev
+        const v_int32x4 sameAsPrev = v_andnot(v_reinterpret_as_s32(v_absdiff(currColor, prevColor)) < v_setall_s32(threshold), sameAsHistory);
+        const v_int32x4 stabIncr = stability - (stability < maxStability);
+        const v_int32x4 stable = sameAsPrev & (stabIncr > minStability);
+        const v_int32x4 newHistory = stable & (stabIncr >= histStability);
+        const v_int32x4 keepsHistStability = v_andnot(sameAsPrev, stable);
+
+        stability = stabIncr & sameAsPrev;
+        histStability = v_select(sameAsHistory, histIncr,
+                        v_select(newHistory, stabIncr,
+                        v_select(keepsHistStability, histStability, histDecr)));
+        historyColor = v_select(newHistory, currColor, historyColor);
+        bgImg = v_select(historyBg, historyColor, v_select(newHistory, currColor, bgImg));
+        return ~(historyBg | newHistory);
+    }
+
+    void processRow(Vec4i* row, const uchar* frameRow, const uchar* prevFrameRow, uchar* fgMaskRow, int cols) CV_OVERRIDE
+    {
+        int c = 0;
+        for (; c <= cols - 8; c += 8)
+        {
+            v_uint32x4 curr[2], prev[2];
+            v_expand(v_load_expand(frameRow + c), curr[0], curr[1]);
+            v_expand(v_load_expand(prevFrameRow + c), prev[0], prev[1]);
+
+            v_int32x4 fg[2];
+            for (int k = 0; k < 2; ++k)
+            {
+                int* vec = row[c + 4 * k].val;
+                v_int32x4 stability, historyColor, histStability, bgImg;
+                v_load_deinterleave(vec, stability, historyColor, histStability, bgImg);
+                fg[k] = update(stability, historyColor, histStability, bgImg, v_reinterpret_as_s32(curr[k]), v_reinterpret_as_s32(prev[k]));
+                v_store_interleave(vec, stability, historyColor, histStability, bgImg);
+            }
+            v_pack_store((schar*)(fgMaskRow + c), v_pack(fg[0], fg[1]));
+        }
+        for (; c < cols; ++c)
+        {
+            (*this)(row[c], frameRow[c], prevFrameRow[c], fgMaskRow[c]);
+        }
+    }
+#endif
+
     int minPixelStability;
     int maxPixelStability;
     int threshold;
@@ -320,14 +429,7 @@ public:
     {
         for (int r = range.start; r < range.end; ++r)
         {
-            Vec4i* row = data.ptr<Vec4i>(r);
-            uchar* frameRow = img.ptr<uchar>(r);
-            uchar* prevFrameRow = prevFrame.ptr<uchar>(r);
-            uchar* fgMaskRow = fgMask.ptr<uchar>(r);
-            for (int c = 0; c < data.cols; ++c)
-            {
-                functor(row[c], frameRow[c], prevFrameRow[c], fgMaskRow[c]);
-            }
+            functor.processRow(data.ptr<Vec4i>(r), img.ptr<uchar>(r), prevFrame.ptr<uchar>(r), fgMask.ptr<uchar>(r), data.cols);
         }
     }
 
@@ -384,24 +486,14 @@ void BackgroundSubtractorCNTImpl::apply(InputArray image, OutputArray _fgmask, d
         functor = new BGSubtractPixel(minPixelStability, threshold*3, frame, prevFrame, fgMask);
     }
 
+    CNTInvoker invoker(data, frame, prevFrame, fgMask, *functor);
     if (isParallel)
     {
-        parallel_for_(Range(0, frame.rows),
-                      CNTInvoker(data, frame, prevFrame, fgMask, *functor));
+        parallel_for_(Range(0, frame.rows), invoker);
     }
     else
     {
-        for (int r = 0; r < data.rows; ++r)
-        {
-            Vec4i* row = data.ptr<Vec4i>(r);
-            uchar* frameRow = frame.ptr<uchar>(r);
-            uchar* prevFrameRow = prevFrame.ptr<uchar>(r);
-            uchar* fgMaskRow = fgMask.ptr<uchar>(r);
-            for (int c = 0; c < data.cols; ++c)
-            {
-                (*functor)(row[c], frameRow[c], prevFrameRow[c], fgMaskRow[c]);
-            }
-        }
+        invoker(Range(0, frame.rows));
     }
 
     delete functor;
@@ -118,6 +118,17 @@ public:
     */
     CV_WRAP virtual void applyFastToneMapping(InputArray inputImage, OutputArray outputToneMappedImage)=0;
 
+    /** @brief applies applyFastToneMapping to a batch of images of the size given at creation
+
+    The images are shared between a few tone mapping pipelines which run in parallel and are kept
+    allocated for the next calls. Since the low pass filters of the tone mapping are set up without
+    temporal integration, the results are the same as the ones of successive applyFastToneMapping calls.
+
+    @param inputImages the input images to process, RGB or gray levels
+    @param outputToneMappedImages the output tone mapped images, in the order of the input images
+    */
+    CV_WRAP virtual void applyFastToneMappingSequence(InputArrayOfArrays inputImages, OutputArrayOfArrays outputToneMappedImages)=0;
+
     /** @brief updates tone mapping behaviors by adjusing the local luminance computation area
 
     @param photoreceptorsNeighborhoodRadius the first stage local adaptation area
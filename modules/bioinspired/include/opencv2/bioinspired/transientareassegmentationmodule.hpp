@@ -174,6 +174,9 @@ public:
     virtual void write( cv::FileStorage& fs ) const CV_OVERRIDE = 0;
 
     /** @brief main processing method, get result using methods getSegmentationPicture()
+
+    A single channel continuous CV_32F input, such as the output of Retina::getMagnoRAW for the
+    same frame, is read in place without conversion.
     @param inputToSegment : the image to process, it must match the instance buffer size !
     @param channelIndex : the channel to process in case of multichannel images
     */
@@ -68,6 +68,7 @@
 #include <cstdlib>
 #include "basicretinafilter.hpp"
 #include <cmath>
+#include "opencv2/core/hal/intrin.hpp"
 
 
 namespace cv
@@ -76,6 +77,168 @@ namespace bioinspired
 {
 // @author Alexandre BENOIT, benoit.alexandre.vision@gmail.com, LISTIC : www.listic.univ-savoie.fr Gipsa-Lab, France: www.gipsa-lab.inpg.fr/
 
+//////////////////////////////////////////////////////////
+//                 RECURSIVE FILTERS KERNELS
+//////////////////////////////////////////////////////////
+
+void horizontalRecursiveFilter(float *outputFrame, const float *inputFrame, const unsigned int nbColumns,
+                               const unsigned int IDrowStart, const unsigned int IDrowEnd,
+                               const float a, const float tau, const float gain, const bool anticausal)
+{
+    unsigned int IDrow=IDrowStart;
+#if CV_SIMD128
+    const v_float32x4 v_a=v_setall_f32(a), v_tau=v_setall_f32(tau), v_gain=v_setall_f32(gain);
+    const int width=(int)nbColumns;
+    for (; IDrow+4<=IDrowEnd; IDrow+=4)
+    {
+        float *o0=outputFrame+IDrow*nbColumns, *o1=o0+nbColumns, *o2=o1+nbColumns, *o3=o2+nbColumns;
+        // the 4 rows results, one per lane
+        v_float32x4 result=v_setzero_f32();
+        float results[4];
+        if (!anticausal)
+        {
+            const float *i0=inputFrame ? inputFrame+IDrow*nbColumns : NULL;
+            int index=0;
+            for (; index+4<=width; index+=4)
+            {
+                v_float32x4 c[4];
+                v_transpose4x4(v_load(o0+index), v_load(o1+index), v_load(o2+index), v_load(o3+index), c[0], c[1], c[2], c[3]);
+                if (inputFrame)
+                {
+                    v_float32x4 in[4];
+                    v_transpose4x4(v_load(i0+index), v_load(i0+nbColumns+index), v_load(i0+2*nbColumns+index), v_load(i0+3*nbColumns+index),
+                                   in[0], in[1], in[2], in[3]);
+                    for (int k=0; k<4; ++k)
+                    {
+                        result = in[k] + v_tau*c[k] + v_a*result;
+                        c[k]=result;
+                    }
+                }
+                else
+                {
+                    for (int k=0; k<4; ++k)
+                    {
+                        result = c[k] + v_a*result;
+                        c[k]=result;
+                    }
+                }
+                v_float32x4 r0, r1, r2, r3;
+                v_transpose4x4(c[0], c[1], c[2], c[3], r0, r1, r2, r3);
+                v_store(o0+index, r0); v_store(o1+index, r1); v_store(o2+index, r2); v_store(o3+index, r3);
+            }
+            v_store(results, result);
+            for (int k=0; k<4; ++k)
+            {
+                float *outputPTR=o0+k*nbColumns;
+                const float *inputPTR=inputFrame ? i0+k*nbColumns : NULL;
+                for (int x=index; x<width; ++x)
+                {
+                    results[k] = inputPTR ? inputPTR[x] + tau*outputPTR[x] + a*results[k] : outputPTR[x] + a*results[k];
+                    outputPTR[x]=results[k];
+                }
+            }
+        }
+        else
+        {
+            int index=width-4;
+            for (; index>=0; index-=4)
+            {
+                v_float32x4 c[4];
+                v_transpose4x4(v_load(o0+index), v_load(o1+index), v_load(o2+index), v_load(o3+index), c[0], c[1], c[2], c[3]);
+                for (int k=3; k>=0; --k)
+                {
+                    result = c[k] + v_a*result;
+                    c[k]=v_gain*result;
+                }
+                v_float32x4 r0, r1, r2, r3;
+                v_transpose4x4(c[0], c[1], c[2], c[3], r0, r1, r2, r3);
+                v_store(o0+index, r0); v_store(o1+index, r1); v_store(o2+index, r2); v_store(o3+index, r3);
+            }
+            v_store(results, result);
+            for (int k=0; k<4; ++k)
+            {
+                float *outputPTR=o0+k*nbColumns;
+                for (int x=index+3; x>=0; --x)
+                {
+                    results[k] = outputPTR[x] + a*results[k];
+                    outputPTR[x]=gain*results[k];
+                }
+            }
+        }
+    }
+#endif
+    for (; IDrow<IDrowEnd; ++IDrow)
+    {
+        float result=0;
+        if (!anticausal)
+        {
+            float* outputPTR=outputFrame+IDrow*nbColumns;
+            const float* inputPTR=inputFrame ? inputFrame+IDrow*nbColumns : NULL;
+            for (unsigned int index=0; index<nbColumns; ++index)
+            {
+                result = inputPTR ? *(inputPTR++) + tau**(outputPTR) + a*result : *(outputPTR) + a*result;
+                *(outputPTR++) = result;
+            }
+        }
+        else
+        {
+            float* outputPTR=outputFrame+(IDrow+1)*nbColumns-1;
+            for (unsigned int index=0; index<nbColumns; ++index)
+            {
+                result = *(outputPTR) + a*result;
+                *(outputPTR--) = gain*result;
+            }
+        }
+    }
+}
+
+float verticalRecursiveFilter(float *outputFrame, const float *spatialConstantBuffer, const float *gainBuffer,
+                              const unsigned int nbRows, const unsigned int nbColumns,
+                              const unsigned int IDcolumnStart, const unsigned int IDcolumnEnd,
+                              const float a, const float gain, const bool anticausal)
+{
+    const int width=(int)(IDcolumnEnd-IDcolumnStart);
+    if (width<=0)
+        return 0;
+    // one running result per column
+    cv::AutoBuffer<float> buffer(width);
+    float *results=buffer.data();
+    std::fill(results, results+width, 0.f);
+    float sum=0;
+#if CV_SIMD128
+    const v_float32x4 v_a=v_setall_f32(a), v_gain=v_setall_f32(gain);
+    v_float32x4 v_sum=v_setzero_f32();
+#endif
+    for (unsigned int index=0; index<nbRows; ++index)
+    {
+        const size_t offset=(size_t)(anticausal ? nbRows-1-index : index)*nbColumns+IDcolumnStart;
+        float *outputPTR=outputFrame+offset;
+        const float *spatialConstantPTR=spatialConstantBuffer ? spatialConstantBuffer+offset : NULL;
+        const float *gainPTR=gainBuffer ? gainBuffer+offset : NULL;
+        int IDcolumn=0;
+#if CV_SIMD128
+        for (; IDcolumn+4<=width; IDcolumn+=4)
+        {
+            v_float32x4 result = v_load(outputPTR+IDcolumn) + (spatialConstantPTR ? v_load(spatialConstantPTR+IDcolumn) : v_a)*v_load(results+IDcolumn);
+            v_store(results+IDcolumn, result);
+            result = (gainPTR ? v_load(gainPTR+IDcolumn) : v_gain)*result;
+            v_store(outputPTR+IDcolumn, result);
+            v_sum += result;
+        }
+#endif
+        for (; IDcolumn<width; ++IDcolumn)
+        {
+            results[IDcolumn] = outputPTR[IDcolumn] + (spatialConstantPTR ? spatialConstantPTR[IDcolumn] : a)*results[IDcolumn];
+            outputPTR[IDcolumn] = (gainPTR ? gainPTR[IDcolumn] : gain)*results[IDcolumn];
+            sum += outputPTR[IDcolumn];
+        }
+    }
+#if CV_SIMD128
+    sum += v_reduce_sum(v_sum);
+#endif
+    return sum;
+}
+
 //////////////////////////////////////////////////////////
 //                 BASIC RETINA FILTER
 //////////////////////////////////////////////////////////
@@ -347,7 +510,7 @@ void BasicRetinaFilter::_localLuminanceAdaptation(const float *inputFrame, const
         updateCompressionParameter(meanLuminance);
     }
 #ifdef MAKE_PARALLEL
-        cv::parallel_for_(cv::Range(0,_filterOutput.getNBpixels()), Parallel_localAdaptation(localLuminance, inputFrame, outputFrame, _localLuminanceFactor, _localLuminanceAddon, _maxInputValue));
+        cv::parallel_for_(cv::Range(0,_filterOutput.getNBpixels()), Parallel_localAdaptation(localLuminance, inputFrame, outputFrame, _localLuminanceFactor, _localLuminanceAddon, _maxInputValue), _pixelStripes(_filterOutput.getNBpixels()));
 #else
     //std::cout<<meanLuminance<<std::endl;
     const float *localLuminancePTR=localLuminance;
@@ -450,96 +613,41 @@ float BasicRetinaFilter::_squaringSpatiotemporalLPfilter(const float *inputFrame
 //  horizontal causal filter which adds the input inside
 void BasicRetinaFilter::_horizontalCausalFilter(float *outputFrame, unsigned int IDrowStart, unsigned int IDrowEnd)
 {
-
-
-    //#pragma omp parallel for
-    for (unsigned int IDrow=IDrowStart; IDrow<IDrowEnd; ++IDrow)
-    {
-        float* outputPTR=outputFrame+(IDrowStart+IDrow)*_filterOutput.getNBcolumns();
-        float result=0;
-        for (unsigned int index=0; index<_filterOutput.getNBcolumns(); ++index)
-        {
-            result = *(outputPTR)+  _a* result;
-            *(outputPTR++) = result;
-        }
-    }
+    horizontalRecursiveFilter(outputFrame, NULL, _filterOutput.getNBcolumns(), IDrowStart, IDrowEnd, _a, 0.f, 1.f, false);
 }
 //  horizontal causal filter which adds the input inside
 void BasicRetinaFilter::_horizontalCausalFilter_addInput(const float *inputFrame, float *outputFrame, unsigned int IDrowStart, unsigned int IDrowEnd)
 {
 #ifdef MAKE_PARALLEL
-        cv::parallel_for_(cv::Range(IDrowStart,IDrowEnd), Parallel_horizontalCausalFilter_addInput(inputFrame, outputFrame, IDrowStart, _filterOutput.getNBcolumns(), _a, _tau));
+        cv::parallel_for_(cv::Range(IDrowStart,IDrowEnd), Parallel_horizontalCausalFilter_addInput(inputFrame, outputFrame, 0, _filterOutput.getNBcolumns(), _a, _tau), _horizontalStripes(IDrowStart, IDrowEnd));
 #else
-    for (unsigned int IDrow=IDrowStart; IDrow<IDrowEnd; ++IDrow)
-    {
-        float* outputPTR=outputFrame+(IDrowStart+IDrow)*_filterOutput.getNBcolumns();
-        const float* inputPTR=inputFrame+(IDrowStart+IDrow)*_filterOutput.getNBcolumns();
-        float result=0;
-        for (unsigned int index=0; index<_filterOutput.getNBcolumns(); ++index)
-        {
-            result = *(inputPTR++) + _tau**(outputPTR)+  _a* result;
-            *(outputPTR++) = result;
-        }
-    }
+    horizontalRecursiveFilter(outputFrame, inputFrame, _filterOutput.getNBcolumns(), IDrowStart, IDrowEnd, _a, _tau, 1.f, false);
 #endif
 }
 
 //  horizontal anticausal filter  (basic way, no add on)
 void BasicRetinaFilter::_horizontalAnticausalFilter(float *outputFrame, unsigned int IDrowStart, unsigned int IDrowEnd)
 {
-
 #ifdef MAKE_PARALLEL
-        cv::parallel_for_(cv::Range(IDrowStart,IDrowEnd), Parallel_horizontalAnticausalFilter(outputFrame, IDrowEnd, _filterOutput.getNBcolumns(), _a ));
+        cv::parallel_for_(cv::Range(IDrowStart,IDrowEnd), Parallel_horizontalAnticausalFilter(outputFrame, IDrowEnd, _filterOutput.getNBcolumns(), _a ), _horizontalStripes(IDrowStart, IDrowEnd));
 #else
-    for (unsigned int IDrow=IDrowStart; IDrow<IDrowEnd; ++IDrow)
-    {
-        float* outputPTR=outputFrame+(IDrowEnd-IDrow)*(_filterOutput.getNBcolumns())-1;
-        float result=0;
-        for (unsigned int index=0; index<_filterOutput.getNBcolumns(); ++index)
-        {
-            result = *(outputPTR)+  _a* result;
-            *(outputPTR--) = result;
-        }
-    }
+    horizontalRecursiveFilter(outputFrame, NULL, _filterOutput.getNBcolumns(), IDrowStart, IDrowEnd, _a, 0.f, 1.f, true);
 #endif
 }
 
 //  horizontal anticausal filter which multiplies the output by _gain
 void BasicRetinaFilter::_horizontalAnticausalFilter_multGain(float *outputFrame, unsigned int IDrowStart, unsigned int IDrowEnd)
 {
-
-    //#pragma omp parallel for
-    for (unsigned int IDrow=IDrowStart; IDrow<IDrowEnd; ++IDrow)
-    {
-        float* outputPTR=outputFrame+(IDrowEnd-IDrow)*(_filterOutput.getNBcolumns())-1;
-        float result=0;
-        for (unsigned int index=0; index<_filterOutput.getNBcolumns(); ++index)
-        {
-            result = *(outputPTR)+  _a* result;
-            *(outputPTR--) = _gain*result;
-        }
-    }
+    horizontalRecursiveFilter(outputFrame, NULL, _filterOutput.getNBcolumns(), IDrowStart, IDrowEnd, _a, 0.f, _gain, true);
 }
 
 //  vertical anticausal filter
 void BasicRetinaFilter::_verticalCausalFilter(float *outputFrame, unsigned int IDcolumnStart, unsigned int IDcolumnEnd)
 {
 #ifdef MAKE_PARALLEL
-        cv::parallel_for_(cv::Range(IDcolumnStart,IDcolumnEnd), Parallel_verticalCausalFilter(outputFrame, _filterOutput.getNBrows(), _filterOutput.getNBcolumns(), _a ));
+        cv::parallel_for_(cv::Range(IDcolumnStart,IDcolumnEnd), Parallel_verticalCausalFilter(outputFrame, _filterOutput.getNBrows(), _filterOutput.getNBcolumns(), _a ), _verticalStripes(IDcolumnStart, IDcolumnEnd));
 #else
-        for (unsigned int IDcolumn=IDcolumnStart; IDcolumn<IDcolumnEnd; ++IDcolumn)
-    {
-        float result=0;
-        float *outputPTR=outputFrame+IDcolumn;
-
-        for (unsigned int index=0; index<_filterOutput.getNBrows(); ++index)
-        {
-            result = *(outputPTR) + _a * result;
-            *(outputPTR) = result;
-            outputPTR+=_filterOutput.getNBcolumns();
-
-        }
-    }
+    verticalRecursiveFilter(outputFrame, NULL, NULL, _filterOutput.getNBrows(), _filterOutput.getNBcolumns(), IDcolumnStart, IDcolumnEnd, _a, 1.f, false);
 #endif
 }
 
@@ -547,44 +655,16 @@ void BasicRetinaFilter::_verticalCausalFilter(float *outputFrame, unsigned int I
 //  vertical anticausal filter (basic way, no add on)
 void BasicRetinaFilter::_verticalAnticausalFilter(float *outputFrame, unsigned int IDcolumnStart, unsigned int IDcolumnEnd)
 {
-    float* offset=outputFrame+_filterOutput.getNBpixels()-_filterOutput.getNBcolumns();
-    //#pragma omp parallel for
-    for (unsigned int IDcolumn=IDcolumnStart; IDcolumn<IDcolumnEnd; ++IDcolumn)
-    {
-        float result=0;
-        float *outputPTR=offset+IDcolumn;
-
-        for (unsigned int index=0; index<_filterOutput.getNBrows(); ++index)
-        {
-            result = *(outputPTR) + _a * result;
-            *(outputPTR) = result;
-            outputPTR-=_filterOutput.getNBcolumns();
-
-        }
-    }
+    verticalRecursiveFilter(outputFrame, NULL, NULL, _filterOutput.getNBrows(), _filterOutput.getNBcolumns(), IDcolumnStart, IDcolumnEnd, _a, 1.f, true);
 }
 
 //  vertical anticausal filter which multiplies the output by _gain
 void BasicRetinaFilter::_verticalAnticausalFilter_multGain(float *outputFrame, unsigned int IDcolumnStart, unsigned int IDcolumnEnd)
 {
 #ifdef MAKE_PARALLEL
-        cv::parallel_for_(cv::Range(IDcolumnStart,IDcolumnEnd), Parallel_verticalAnticausalFilter_multGain(outputFrame, _filterOutput.getNBrows(), _filterOutput.getNBcolumns(), _a, _gain ));
+        cv::parallel_for_(cv::Range(IDcolumnStart,IDcolumnEnd), Parallel_verticalAnticausalFilter_multGain(outputFrame, _filterOutput.getNBrows(), _filterOutput.getNBcolumns(), _a, _gain ), _verticalStripes(IDcolumnStart, IDcolumnEnd));
 #else
-        float* offset=outputFrame+_filterOutput.getNBpixels()-_filterOutput.getNBcolumns();
-    //#pragma omp parallel for
-    for (unsigned int IDcolumn=IDcolumnStart; IDcolumn<IDcolumnEnd; ++IDcolumn)
-    {
-        float result=0;
-        float *outputPTR=offset+IDcolumn;
-
-        for (unsigned int index=0; index<_filterOutput.getNBrows(); ++index)
-        {
-            result = *(outputPTR) + _a * result;
-            *(outputPTR) = _gain*result;
-            outputPTR-=_filterOutput.getNBcolumns();
-
-        }
-    }
+    verticalRecursiveFilter(outputFrame, NULL, NULL, _filterOutput.getNBrows(), _filterOutput.getNBcolumns(), IDcolumnStart, IDcolumnEnd, _a, _gain, true);
 #endif
 }
 
@@ -594,41 +674,45 @@ void BasicRetinaFilter::_verticalAnticausalFilter_multGain(float *outputFrame, u
 // -> squaring horizontal causal filter
 void BasicRetinaFilter::_squaringHorizontalCausalFilter(const float *inputFrame, float *outputFrame, unsigned int IDrowStart, unsigned int IDrowEnd)
 {
-    float* outputPTR=outputFrame+IDrowStart*_filterOutput.getNBcolumns();
-    const float* inputPTR=inputFrame+IDrowStart*_filterOutput.getNBcolumns();
-    for (unsigned int IDrow=IDrowStart; IDrow<IDrowEnd; ++IDrow)
+    const unsigned int nbColumns=_filterOutput.getNBcolumns();
+    const float a=_a, tau=_tau;
+    cv::parallel_for_(cv::Range(IDrowStart, IDrowEnd), [&](const cv::Range& range)
     {
-        float result=0;
-        for (unsigned int index=0; index<_filterOutput.getNBcolumns(); ++index)
+        for (int IDrow=range.start; IDrow<range.end; ++IDrow)
         {
-            result = *(inputPTR)**(inputPTR) + _tau**(outputPTR)+  _a* result;
-            *(outputPTR++) = result;
-            ++inputPTR;
+            float* outputPTR=outputFrame+IDrow*nbColumns;
+            const float* inputPTR=inputFrame+IDrow*nbColumns;
+            float result=0;
+            for (unsigned int index=0; index<nbColumns; ++index)
+            {
+                result = *(inputPTR)**(inputPTR) + tau**(outputPTR)+  a* result;
+                *(outputPTR++) = result;
+                ++inputPTR;
+            }
         }
-    }
+    }, _horizontalStripes(IDrowStart, IDrowEnd));
 }
 
 //  vertical anticausal filter that returns the mean value of its result
 float BasicRetinaFilter::_verticalAnticausalFilter_returnMeanValue(float *outputFrame, unsigned int IDcolumnStart, unsigned int IDcolumnEnd)
 {
-    float meanValue=0;
-    float* offset=outputFrame+_filterOutput.getNBpixels()-_filterOutput.getNBcolumns();
-    for (unsigned int IDcolumn=IDcolumnStart; IDcolumn<IDcolumnEnd; ++IDcolumn)
+    // the columns are filtered by blocks in parallel, their sums are added in the blocks order
+    const unsigned int blockSize=64;
+    const int nbBlocks=(int)((IDcolumnEnd-IDcolumnStart+blockSize-1)/blockSize);
+    std::vector<float> sums(nbBlocks, 0.f);
+    cv::parallel_for_(cv::Range(0, nbBlocks), [&](const cv::Range& range)
     {
-        float result=0;
-        float *outputPTR=offset+IDcolumn;
-
-        for (unsigned int index=0; index<_filterOutput.getNBrows(); ++index)
+        for (int block=range.start; block<range.end; ++block)
         {
-            result = *(outputPTR) + _a * result;
-            *(outputPTR) = _gain*result;
-            meanValue+=*(outputPTR);
-            outputPTR-=_filterOutput.getNBcolumns();
-
+            const unsigned int start=IDcolumnStart+block*blockSize;
+            sums[block]=verticalRecursiveFilter(outputFrame, NULL, NULL, _filterOutput.getNBrows(), _filterOutput.getNBcolumns(),
+                                                start, std::min(start+blockSize, IDcolumnEnd), _a, _gain, true);
         }
-    }
-
-    return meanValue/(float)_filterOutput.getNBpixels();
+    });
+    float sum=0;
+    for (int block=0; block<nbBlocks; ++block)
+        sum+=sums[block];
+    return sum/(float)_filterOutput.getNBpixels();
 }
 
 // LP filter with integration in specific areas (regarding true values of a binary parameters image)
@@ -843,46 +927,16 @@ void BasicRetinaFilter::_horizontalAnticausalFilter_Irregular(float *outputFrame
 void BasicRetinaFilter::_verticalCausalFilter_Irregular(float *outputFrame, unsigned int IDcolumnStart, unsigned int IDcolumnEnd, const float *spatialConstantBuffer)
 {
 #ifdef MAKE_PARALLEL
-        cv::parallel_for_(cv::Range(IDcolumnStart,IDcolumnEnd), Parallel_verticalCausalFilter_Irregular(outputFrame, spatialConstantBuffer, _filterOutput.getNBrows(), _filterOutput.getNBcolumns()));
+        cv::parallel_for_(cv::Range(IDcolumnStart,IDcolumnEnd), Parallel_verticalCausalFilter_Irregular(outputFrame, spatialConstantBuffer, _filterOutput.getNBrows(), _filterOutput.getNBcolumns()), _verticalStripes(IDcolumnStart, IDcolumnEnd));
 #else
-    for (unsigned int IDcolumn=IDcolumnStart; IDcolumn<IDcolumnEnd; ++IDcolumn)
-    {
-        float result=0;
-        float *outputPTR=outputFrame+IDcolumn;
-        const float *spatialConstantPTR=spatialConstantBuffer+IDcolumn;
-        for (unsigned int index=0; index<_filterOutput.getNBrows(); ++index)
-        {
-            result = *(outputPTR) + *(spatialConstantPTR) * result;
-            *(outputPTR) = result;
-            outputPTR+=_filterOutput.getNBcolumns();
-            spatialConstantPTR+=_filterOutput.getNBcolumns();
-        }
-    }
+    verticalRecursiveFilter(outputFrame, spatialConstantBuffer, NULL, _filterOutput.getNBrows(), _filterOutput.getNBcolumns(), IDcolumnStart, IDcolumnEnd, 0.f, 1.f, false);
 #endif
 }
 
 //  vertical anticausal filter which multiplies the output by _gain
 void BasicRetinaFilter::_verticalAnticausalFilter_Irregular_multGain(float *outputFrame, unsigned int IDcolumnStart, unsigned int IDcolumnEnd)
 {
-    float* outputOffset=outputFrame+_filterOutput.getNBpixels()-_filterOutput.getNBcolumns();
-    const float* constantOffset=&_progressiveSpatialConstant[0]+_filterOutput.getNBpixels()-_filterOutput.getNBcolumns();
-    const float* gainOffset=&_progressiveGain[0]+_filterOutput.getNBpixels()-_filterOutput.getNBcolumns();
-    for (unsigned int IDcolumn=IDcolumnStart; IDcolumn<IDcolumnEnd; ++IDcolumn)
-    {
-        float result=0;
-        float *outputPTR=outputOffset+IDcolumn;
-        const float *spatialConstantPTR=constantOffset+IDcolumn;
-        const float *progressiveGainPTR=gainOffset+IDcolumn;
-        for (unsigned int index=0; index<_filterOutput.getNBrows(); ++index)
-        {
-            result = *(outputPTR) + *(spatialConstantPTR) * result;
-            *(outputPTR) = *(progressiveGainPTR)*result;
-            outputPTR-=_filterOutput.getNBcolumns();
-            spatialConstantPTR-=_filterOutput.getNBcolumns();
-            progressiveGainPTR-=_filterOutput.getNBcolumns();
-        }
-    }
-
+    verticalRecursiveFilter(outputFrame, &_progressiveSpatialConstant[0], &_progressiveGain[0], _filterOutput.getNBrows(), _filterOutput.getNBcolumns(), IDcolumnStart, IDcolumnEnd, 0.f, 1.f, true);
 }
 }// end of namespace bioinspired
 }// end of namespace cv
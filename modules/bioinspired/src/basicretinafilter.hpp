@@ -116,6 +116,30 @@ namespace cv
 {
 namespace bioinspired
 {
+    /**
+    * first order recursive low pass filter along the rows [IDrowStart, IDrowEnd) of a frame:
+    * result = input + tau * output + a * result on the causal way (input is optional, in place filtering when NULL),
+    * result = output + a * result then output = gain * result on the anticausal way.
+    * Blocks of 4 rows are transposed so the 4 rows are filtered together in a SIMD register.
+    */
+    void horizontalRecursiveFilter(float *outputFrame, const float *inputFrame, const unsigned int nbColumns,
+                                   const unsigned int IDrowStart, const unsigned int IDrowEnd,
+                                   const float a, const float tau, const float gain, const bool anticausal);
+
+    /**
+    * first order recursive low pass filter along the columns [IDcolumnStart, IDcolumnEnd) of a frame:
+    * result = output + a * result then output = gain * result, from the top row or from the bottom row (anticausal).
+    * The rows are swept one after the other so the neighbouring columns are filtered together, on contiguous memory
+    * and several of them in a SIMD register.
+    * @param spatialConstantBuffer: per pixel a if not NULL
+    * @param gainBuffer: per pixel gain if not NULL
+    * @return the sum of the output values
+    */
+    float verticalRecursiveFilter(float *outputFrame, const float *spatialConstantBuffer, const float *gainBuffer,
+                                  const unsigned int nbRows, const unsigned int nbColumns,
+                                  const unsigned int IDcolumnStart, const unsigned int IDcolumnEnd,
+                                  const float a, const float gain, const bool anticausal);
+
     class BasicRetinaFilter
     {
     public:
@@ -458,6 +482,12 @@ namespace bioinspired
         void _local_verticalCausalFilter(float *outputFrame, unsigned int IDcolumnStart, unsigned int IDcolumnEnd, const unsigned int *integrationAreas);
         void _local_verticalAnticausalFilter_multGain(float *outputFrame, unsigned int IDcolumnStart, unsigned int IDcolumnEnd, const unsigned int *integrationAreas); // this functions affects _gain at the output
 
+        // number of stripes of the parallel 1D filters, so that their SIMD kernels get blocks of rows (or columns)
+        double _horizontalStripes(unsigned int IDrowStart, unsigned int IDrowEnd) const { return std::max(1., (IDrowEnd-IDrowStart)/16.); }
+        double _verticalStripes(unsigned int IDcolumnStart, unsigned int IDcolumnEnd) const { return std::max(1., (IDcolumnEnd-IDcolumnStart)/64.); }
+        // number of stripes of the parallel per pixel loops, the default of a stripe per pixel is mostly scheduling overhead
+        double _pixelStripes(unsigned int nbPixels) const { return std::max(1., nbPixels/16384.); }
+
 #ifdef MAKE_PARALLEL
         /******************************************************
         ** IF some parallelizing thread methods are available, then, main loops are parallelized using these functors
@@ -496,16 +526,7 @@ namespace bioinspired
                     //<<"\n\t last index="<<filterParam
                     <<std::endl;
 #endif
-                for (int IDrow=r.start; IDrow!=r.end; ++IDrow)
-                {
-                    float* outputPTR=outputFrame+(IDrowEnd-IDrow)*(nbColumns)-1;
-                    float result=0;
-                    for (unsigned int index=0; index<nbColumns; ++index)
-                    {
-                        result = *(outputPTR)+  filterParam_a* result;
-                        *(outputPTR--) = result;
-                    }
-                }
+                horizontalRecursiveFilter(outputFrame, NULL, nbColumns, IDrowEnd-r.end, IDrowEnd-r.start, filterParam_a, 0.f, 1.f, true);
             }
         };
 
@@ -521,17 +542,7 @@ namespace bioinspired
                 :inputFrame(bufferToAddAsInputProcess), outputFrame(bufferToProcess), IDrowStart(idStart), nbColumns(nbCols), filterParam_a(a), filterParam_tau(tau){}
 
             virtual void operator()( const Range& r ) const CV_OVERRIDE {
-                for (int IDrow=r.start; IDrow!=r.end; ++IDrow)
-                {
-                    float* outputPTR=outputFrame+(IDrowStart+IDrow)*nbColumns;
-                    const float* inputPTR=inputFrame+(IDrowStart+IDrow)*nbColumns;
-                    float result=0;
-                    for (unsigned int index=0; index<nbColumns; ++index)
-                    {
-                        result = *(inputPTR++) + filterParam_tau**(outputPTR)+  filterParam_a* result;
-                        *(outputPTR++) = result;
-                    }
-                }
+                horizontalRecursiveFilter(outputFrame, inputFrame, nbColumns, IDrowStart+r.start, IDrowStart+r.end, filterParam_a, filterParam_tau, 1.f, false);
             }
         };
 
@@ -546,19 +557,7 @@ namespace bioinspired
                 :outputFrame(bufferToProcess), nbRows(nbRws), nbColumns(nbCols), filterParam_a(a){}
 
             virtual void operator()( const Range& r ) const CV_OVERRIDE {
-                for (int IDcolumn=r.start; IDcolumn!=r.end; ++IDcolumn)
-                {
-                    float result=0;
-                    float *outputPTR=outputFrame+IDcolumn;
-
-                    for (unsigned int index=0; index<nbRows; ++index)
-                    {
-                        result = *(outputPTR) + filterParam_a * result;
-                        *(outputPTR) = result;
-                        outputPTR+=nbColumns;
-
-                    }
-                }
+                verticalRecursiveFilter(outputFrame, NULL, NULL, nbRows, nbColumns, r.start, r.end, filterParam_a, 1.f, false);
             }
         };
 
@@ -573,20 +572,7 @@ namespace bioinspired
                 :outputFrame(bufferToProcess), nbRows(nbRws), nbColumns(nbCols), filterParam_a(a), filterParam_gain(gain){}
 
             virtual void operator()( const Range& r ) const CV_OVERRIDE {
-                float* offset=outputFrame+nbColumns*nbRows-nbColumns;
-                for (int IDcolumn=r.start; IDcolumn!=r.end; ++IDcolumn)
-                {
-                    float result=0;
-                    float *outputPTR=offset+IDcolumn;
-
-                    for (unsigned int index=0; index<nbRows; ++index)
-                    {
-                        result = *(outputPTR) + filterParam_a * result;
-                        *(outputPTR) = filterParam_gain*result;
-                        outputPTR-=nbColumns;
-
-                    }
-                }
+                verticalRecursiveFilter(outputFrame, NULL, NULL, nbRows, nbColumns, r.start, r.end, filterParam_a, filterParam_gain, true);
             }
         };
 
@@ -653,19 +639,7 @@ namespace bioinspired
                 :outputFrame(bufferToProcess), spatialConstantBuffer(spatialConst), nbRows(nbRws), nbColumns(nbCols){}
 
             virtual void operator()( const Range& r ) const CV_OVERRIDE {
-                for (int IDcolumn=r.start; IDcolumn!=r.end; ++IDcolumn)
-                {
-                    float result=0;
-                    float *outputPTR=outputFrame+IDcolumn;
-                    const float* spatialConstantPTR=spatialConstantBuffer+IDcolumn;
-                    for (unsigned int index=0; index<nbRows; ++index)
-                    {
-                        result = *(outputPTR) +  *(spatialConstantPTR) * result;
-                        *(outputPTR) = result;
-                        outputPTR+=nbColumns;
-                        spatialConstantPTR+=nbColumns;
-                    }
-                }
+                verticalRecursiveFilter(outputFrame, spatialConstantBuffer, NULL, nbRows, nbColumns, r.start, r.end, 0.f, 1.f, false);
             }
         };
 
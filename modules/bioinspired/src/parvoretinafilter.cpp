@@ -207,7 +207,7 @@ void ParvoRetinaFilter::_OPL_OnOffWaysComputing() // WARNING : this method requi
     // positive part goes on the ON way, negative pat goes on the OFF way
 
 #ifdef MAKE_PARALLEL
-        cv::parallel_for_(cv::Range(0,_filterOutput.getNBpixels()), Parallel_OPL_OnOffWaysComputing(&_photoreceptorsOutput[0], &_horizontalCellsOutput[0], &_bipolarCellsOutputON[0], &_bipolarCellsOutputOFF[0], &_parvocellularOutputON[0], &_parvocellularOutputOFF[0]));
+        cv::parallel_for_(cv::Range(0,_filterOutput.getNBpixels()), Parallel_OPL_OnOffWaysComputing(&_photoreceptorsOutput[0], &_horizontalCellsOutput[0], &_bipolarCellsOutputON[0], &_bipolarCellsOutputOFF[0], &_parvocellularOutputON[0], &_parvocellularOutputOFF[0]), _pixelStripes(_filterOutput.getNBpixels()));
 #else
     float *photoreceptorsOutput_PTR= &_photoreceptorsOutput[0];
     float *horizontalCellsOutput_PTR= &_horizontalCellsOutput[0];
@@ -438,7 +438,7 @@ void RetinaColor::clipRGBOutput_0_maxInputValue(float *inputOutputBuffer, const
         inputOutputBuffer= &_demultiplexedColorFrame[0];
 
 #ifdef MAKE_PARALLEL // call the TemplateBuffer TBB clipping method
-        cv::parallel_for_(cv::Range(0,_filterOutput.getNBpixels()*3), Parallel_clipBufferValues<float>(inputOutputBuffer, 0,  maxInputValue));
+        cv::parallel_for_(cv::Range(0,_filterOutput.getNBpixels()*3), Parallel_clipBufferValues<float>(inputOutputBuffer, 0,  maxInputValue), _pixelStripes(_filterOutput.getNBpixels()*3));
 #else
     float *inputOutputBufferPTR=inputOutputBuffer;
     for (unsigned int jf = 0; jf < _filterOutput.getNBpixels()*3; ++jf, ++inputOutputBufferPTR)
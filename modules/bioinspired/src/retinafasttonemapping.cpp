@@ -71,6 +71,7 @@
 #include "precomp.hpp"
 #include "basicretinafilter.hpp"
 #include "retinacolor.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include <cstdio>
 #include <sstream>
 #include <valarray>
@@ -109,6 +110,7 @@ public:
         if (nbPixels <= 0)
         throw cv::Exception(-1, "Bad retina size setup : size height and with must be superior to zero", "RetinaImpl::setup", "retinafasttonemapping.cpp", 0);
 
+        _inputSize = imageInput;
         // resize buffers
         _inputBuffer.resize(nbPixels*3); // buffer supports gray images but also 3 channels color buffers... (larger is better...)
         _imageOutput.resize(nbPixels*3);
@@ -151,6 +153,46 @@ public:
 
     }
 
+    /**
+     * applies the tone mapping to a batch of images, the images are dispatched to a few tone mapping objects
+     * running in parallel, which are kept for the next calls
+     * @param inputImages the input images to process RGB or gray levels
+     * @param outputToneMappedImages the output tone mapped images
+     */
+    virtual void applyFastToneMappingSequence(InputArrayOfArrays inputImages, OutputArrayOfArrays outputToneMappedImages) CV_OVERRIDE
+    {
+        std::vector<Mat> inputs;
+        inputImages.getMatVector(inputs);
+        const int nbImages = (int)inputs.size();
+        std::vector<Mat> outputs(nbImages);
+
+        // this object is the first pipeline, the others are allocated once and set up as this one
+        const int nbPipelines = std::max(1, std::min(nbImages, cv::getNumThreads()));
+        while ((int)_pipelines.size() < nbPipelines - 1)
+        {
+            Ptr<RetinaFastToneMappingImpl> pipeline = makePtr<RetinaFastToneMappingImpl>(_inputSize);
+            pipeline->setup(_photoreceptorsNeighborhoodRadius, _ganglioncellsNeighborhoodRadius, _meanLuminanceModulatorK);
+            _pipelines.push_back(pipeline);
+        }
+
+        cv::parallel_for_(cv::Range(0, nbPipelines), [&](const cv::Range& range)
+        {
+            for (int p = range.start; p < range.end; ++p)
+            {
+                RetinaFastToneMappingImpl* pipeline = p == 0 ? this : _pipelines[p - 1].get();
+                for (int i = p; i < nbImages; i += nbPipelines)
+                    pipeline->applyFastToneMapping(inputs[i], outputs[i]);
+            }
+        }, nbPipelines);
+
+        outputToneMappedImages.create(nbImages, 1, 0, -1, true);
+        for (int i = 0; i < nbImages; ++i)
+        {
+            outputToneMappedImages.create(outputs[i].size(), outputs[i].type(), i, true);
+            outputToneMappedImages.getMatRef(i) = outputs[i];
+        }
+    }
+
     /**
      * setup method that updates tone mapping behaviors by adjusing the local luminance computation area
      * @param photoreceptorsNeighborhoodRadius the first stage local adaptation area
@@ -160,10 +202,14 @@ public:
     virtual void setup(const float photoreceptorsNeighborhoodRadius=3.f, const float ganglioncellsNeighborhoodRadius=1.f, const float meanLuminanceModulatorK=1.f) CV_OVERRIDE
     {
         // setup the spatio-temporal properties of each filter
+        _photoreceptorsNeighborhoodRadius = photoreceptorsNeighborhoodRadius;
+        _ganglioncellsNeighborhoodRadius = ganglioncellsNeighborhoodRadius;
         _meanLuminanceModulatorK = meanLuminanceModulatorK;
         _multiuseFilter->setV0CompressionParameter(1.f, 255.f, 128.f);
         _multiuseFilter->setLPfilterParameters(0.f, 0.f, photoreceptorsNeighborhoodRadius, 1);
         _multiuseFilter->setLPfilterParameters(0.f, 0.f, ganglioncellsNeighborhoodRadius, 2);
+        for (size_t i = 0; i < _pipelines.size(); ++i)
+            _pipelines[i]->setup(photoreceptorsNeighborhoodRadius, ganglioncellsNeighborhoodRadius, meanLuminanceModulatorK);
     }
 
 private:
@@ -175,46 +221,68 @@ private:
     std::valarray<float> _inputBuffer;
     std::valarray<float> _imageOutput;
     std::valarray<float> _temp2;
+    Size _inputSize;
+    float _photoreceptorsNeighborhoodRadius, _ganglioncellsNeighborhoodRadius;
     float _meanLuminanceModulatorK;
 
+    //!< the other tone mapping pipelines of applyFastToneMappingSequence
+    std::vector<Ptr<RetinaFastToneMappingImpl> > _pipelines;
+
 
 void _convertValarrayBuffer2cvMat(const std::valarray<float> &grayMatrixToConvert, const unsigned int nbRows, const unsigned int nbColumns, const bool colorMode, OutputArray outBuffer)
 {
-    // fill output buffer with the valarray buffer
+    // fill output buffer with the valarray buffer, the values are truncated
     const float *valarrayPTR=get_data(grayMatrixToConvert);
-    if (!colorMode)
+    const unsigned int nbPixels=nbColumns*nbRows;
+    outBuffer.create(cv::Size(nbColumns, nbRows), colorMode ? CV_8UC3 : CV_8U);
+    Mat outMat = outBuffer.getMat();
+    cv::parallel_for_(cv::Range(0, nbRows), [&](const cv::Range& range)
     {
-        outBuffer.create(cv::Size(nbColumns, nbRows), CV_8U);
-        Mat outMat = outBuffer.getMat();
-        for (unsigned int i=0;i<nbRows;++i)
+        for (int i=range.start;i<range.end;++i)
         {
-            for (unsigned int j=0;j<nbColumns;++j)
+            const float *redPTR=valarrayPTR+i*nbColumns;
+            unsigned char *outPTR=outMat.ptr<unsigned char>(i);
+            int j=0;
+            if (!colorMode)
             {
-                cv::Point2d pixel(j,i);
-                outMat.at<unsigned char>(pixel)=(unsigned char)*(valarrayPTR++);
+#if CV_SIMD128
+                for (;j<=(int)nbColumns-16;j+=16)
+                {
+                    v_int32x4 v0=v_trunc(v_load(redPTR+j)), v1=v_trunc(v_load(redPTR+j+4));
+                    v_int32x4 v2=v_trunc(v_load(redPTR+j+8)), v3=v_trunc(v_load(redPTR+j+12));
+                    v_store(outPTR+j, v_pack_u(v_pack(v0, v1), v_pack(v2, v3)));
+                }
+#endif
+                for (;j<(int)nbColumns;++j)
+                    outPTR[j]=(unsigned char)redPTR[j];
             }
-        }
-    }
-    else
-    {
-        const unsigned int nbPixels=nbColumns*nbRows;
-        const unsigned int doubleNBpixels=nbColumns*nbRows*2;
-        outBuffer.create(cv::Size(nbColumns, nbRows), CV_8UC3);
-        Mat outMat = outBuffer.getMat();
-        for (unsigned int i=0;i<nbRows;++i)
-        {
-            for (unsigned int j=0;j<nbColumns;++j,++valarrayPTR)
+            else
             {
-                cv::Point2d pixel(j,i);
-                cv::Vec3b pixelValues;
-                pixelValues[2]=(unsigned char)*(valarrayPTR);
-                pixelValues[1]=(unsigned char)*(valarrayPTR+nbPixels);
-                pixelValues[0]=(unsigned char)*(valarrayPTR+doubleNBpixels);
-
-                outMat.at<cv::Vec3b>(pixel)=pixelValues;
+                // the planes are interleaved into BGR pixels
+                const float *greenPTR=redPTR+nbPixels, *bluePTR=greenPTR+nbPixels;
+#if CV_SIMD128
+                for (;j<=(int)nbColumns-16;j+=16)
+                {
+                    v_uint8x16 planes[3];
+                    const float *planePTR[3]={bluePTR, greenPTR, redPTR};
+                    for (int c=0;c<3;++c)
+                    {
+                        v_int32x4 v0=v_trunc(v_load(planePTR[c]+j)), v1=v_trunc(v_load(planePTR[c]+j+4));
+                        v_int32x4 v2=v_trunc(v_load(planePTR[c]+j+8)), v3=v_trunc(v_load(planePTR[c]+j+12));
+                        planes[c]=v_pack_u(v_pack(v0, v1), v_pack(v2, v3));
+                    }
+                    v_store_interleave(outPTR+3*j, planes[0], planes[1], planes[2]);
+                }
+#endif
+                for (;j<(int)nbColumns;++j)
+                {
+                    outPTR[3*j]=(unsigned char)bluePTR[j];
+                    outPTR[3*j+1]=(unsigned char)greenPTR[j];
+                    outPTR[3*j+2]=(unsigned char)redPTR[j];
+                }
             }
         }
-    }
+    });
 }
 
 bool _convertCvMat2ValarrayBuffer(InputArray inputMat, std::valarray<float> &outputValarrayMatrix)
@@ -224,6 +292,9 @@ bool _convertCvMat2ValarrayBuffer(InputArray inputMat, std::valarray<float> &out
     if (inputMatToConvert.empty())
         throw cv::Exception(-1, "RetinaImpl cannot be applied, input buffer is empty", "RetinaImpl::run", "RetinaImpl.h", 0);
 
+    // the buffers are allocated for the size given at construction
+    CV_Assert(inputMatToConvert.size() == _inputSize);
+
     // retreive color mode from image input
     int imageNumberOfChannels = inputMatToConvert.channels();
 
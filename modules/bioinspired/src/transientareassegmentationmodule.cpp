@@ -76,6 +76,7 @@
 
 #include "precomp.hpp"
 #include "basicretinafilter.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include <sstream>
 
@@ -179,10 +180,9 @@ protected:
 
     /**
      * main processing method
-     * @param inputToSegment : the image to process as a valarray buffer it must match the instance buffer size !
-     * @param channelIndex : the channel to process in case of multichannel images
+     * @param inputToSegment : the image plane to process, it must match the instance buffer size !
      */
-    void _run(const std::valarray<float> &inputToSegment, const int channelIndex=0);
+    void _run(const float *inputToSegment);
 
     /**
      * access function
@@ -426,31 +426,34 @@ void TransientAreasSegmentationModuleImpl::run(InputArray inputToProcess, const
     	throw cv::Exception(-1, errorMsg.str().c_str(), "SegmentationModule::run", "SegmentationModule.cpp", 0);
     }
 
+    // a single channel float input, as the Retina magno output, is processed in place
+    if (inputToSegment.type() == CV_32FC1 && inputToSegment.isContinuous())
+    {
+        _run(inputToSegment.ptr<float>());
+        return;
+    }
+
     // create a cv::Mat header for the input valarray
     // convert to float AND fill the valarray buffer
     typedef float T; // define here the target pixel format, here, float
     const int dsttype = cv::DataType<T>::depth; // output buffer is float format
     cv::Mat dst(inputToSegment.size(), dsttype, &_inputToSegment[0]);
-    inputToSegment.convertTo(dst, dsttype);
-    //cv::imshow("Mask",dst);
-    //cv::waitKey();
+    if (inputToSegment.channels() > 1)
+    {
+        cv::extractChannel(inputToSegment, _conversionBuffer, channelIndex);
+        _conversionBuffer.convertTo(dst, dsttype);
+    }
+    else
+        inputToSegment.convertTo(dst, dsttype);
     // call the low level method
-    _run(_inputToSegment, channelIndex);
+    _run(&_inputToSegment[0]);
 }
 
-void TransientAreasSegmentationModuleImpl::_run(const std::valarray<float> &inputToSegment, const int channelIndex)
+void TransientAreasSegmentationModuleImpl::_run(const float *inputToSegment)
 {
-#ifdef SEGMENTATIONDEBUG
-    std::cout<<"Input length vs internal buffers length = "<<inputToSegment.size()<<", "<<_localMotion.size()<<std::endl;
-#endif
-    // preliminary basic error check
-    // FIXME validate basic tests
-    //if (inputToSegment.size() != _localMotion.size())
-    //    throw cv::Exception(-1, "Input matrix size does not match instance buffers setup !", "SegmentationModule::run", "SegmentationModule.cpp", 0);
-
     // first square the input in order to increase the signal to noise ratio
     // get motion local energy
-    _squaringSpatiotemporalLPfilter(&const_cast<std::valarray<float>&>(inputToSegment)[channelIndex*getNBpixels()], &_localMotion[0]);
+    _squaringSpatiotemporalLPfilter(inputToSegment, &_localMotion[0]);
 
     // second low pass filter: access to the neighborhood motion energy
     _spatiotemporalLPfilter(&_localMotion[0], &_neighborhoodMotion[0], 1);
@@ -459,55 +462,44 @@ void TransientAreasSegmentationModuleImpl::_run(const std::valarray<float> &inpu
     _spatiotemporalLPfilter(&_localMotion[0], &_contextMotionEnergy[0], 2);
 
     // compute the ON and OFF ways (positive and negative values of the difference of the two filterings)
-    float*localMotionPTR=&_localMotion[0], *neighborhoodMotionPTR=&_neighborhoodMotion[0], *contextMotionPTR=&_contextMotionEnergy[0];
+    const float *localMotion=&_localMotion[0], *neighborhoodMotion=&_neighborhoodMotion[0], *contextMotion=&_contextMotionEnergy[0];
+    // bool buffer written as bytes of 0 and 1
+    uchar *segmentationPicture=(uchar*)&_segmentedAreas[0];
+    const float thresholdON=_segmentationParameters.thresholdON;
 
-    // float meanEnergy=LPfilter2.sum()/(float)_LPfilter2.size();
-    bool *segmentationPicturePTR= &_segmentedAreas[0];
-    for (unsigned int index=0; index<_filterOutput.getNBpixels() ; ++index, ++segmentationPicturePTR, ++localMotionPTR, ++neighborhoodMotionPTR, contextMotionPTR++)
+    const int nbPixels=(int)_filterOutput.getNBpixels();
+    cv::parallel_for_(cv::Range(0, nbPixels), [&](const cv::Range& range)
     {
-        float generalMotionContextDecision=*neighborhoodMotionPTR-*contextMotionPTR;
-
-        if (generalMotionContextDecision>0) // local maximum should be detected in this case
+        int index=range.start;
+#if CV_SIMD128
+        const v_float32x4 v_thresholdON=v_setall_f32(thresholdON), v_zero=v_setzero_f32();
+        const v_uint32x4 v_one=v_setall_u32(1);
+        for (; index<=range.end-16; index+=16)
         {
-            /* apply segmentation on local motion superior to its neighborhood
-             * => to segment objects moving faster than their neighborhood
-             */
-            if (generalMotionContextDecision>_segmentationParameters.thresholdON)// && meanEnergy*1.1<*neighborhoodMotionPTR)
+            v_uint32x4 decisions[4];
+            for (int k=0; k<4; ++k)
             {
-                *segmentationPicturePTR=((*localMotionPTR-*neighborhoodMotionPTR)>_segmentationParameters.thresholdON);
+                const v_float32x4 local=v_load(localMotion+index+4*k), neighborhood=v_load(neighborhoodMotion+index+4*k);
+                const v_float32x4 generalMotionContextDecision=neighborhood-v_load(contextMotion+index+4*k);
+                const v_float32x4 mask=(generalMotionContextDecision>v_zero) & (generalMotionContextDecision>v_thresholdON) & ((local-neighborhood)>v_thresholdON);
+                decisions[k]=v_reinterpret_as_u32(mask) & v_one;
             }
-            else
-                *segmentationPicturePTR=false;
+            v_store(segmentationPicture+index, v_pack(v_pack(decisions[0], decisions[1]), v_pack(decisions[2], decisions[3])));
         }
-#ifdef USE_LOCALMINIMUMS
-        else  // local minimum should be detected in this case
+#endif
+        for (; index<range.end; ++index)
         {
-            /* apply segmentation for non moving objects
-             * only if the wide area around motion energy is high
-             * => to segment object moving slower than the neighborhood
+            float generalMotionContextDecision=neighborhoodMotion[index]-contextMotion[index];
+
+            /* apply segmentation on local motion superior to its neighborhood
+             * => to segment objects moving faster than their neighborhood
+             * (local maximum, generalMotionContextDecision>0)
              */
-            if (-1.0*generalMotionContextDecision>_segmentationParameters.thresholdOFF && meanEnergy*0.9>*neighborhoodMotionPTR)
-            {
-                /* in order to segment non moving objects in a camera motion case
-                 * we focus on local energy which is much lower than the wide neighborhood
-                 */
-                *segmentationPicturePTR+=(*neighborhoodMotionPTR-*localMotionPTR>_segmentationParameters.thresholdOFF)*127;
-            }
+            bool segmented=generalMotionContextDecision>0 && generalMotionContextDecision>thresholdON
+                           && (localMotion[index]-neighborhoodMotion[index])>thresholdON;
+            segmentationPicture[index]=(uchar)segmented;
         }
-#else
-        else
-            *segmentationPicturePTR=false;
-#endif
-    }
-    /*
-#ifdef SEGMENTATIONDEBUG
-    std::cout<<"ON: max, min="<<_localMotionON.min()<<", "<<_localMotionON.max();
-    std::cout<<"/// \\\ OFF: max, min="<<_localMotionOFF.min()<<", "<<_localMotionOFF.max()<<std::endl;
-    std::cout<<"/// \\\ motion: max, min="<<_globalMotionEnergy.min()<<", "<<_globalMotionEnergy.max()<<std::endl;
-    std::cout<<"/// \\\ thresholds: ON, OFF="<<_thresholdON<<", "<<_thresholdOFF<<", meanEnergy= "<<meanEnergy<<std::endl;
-#endif
-     */
-
+    }, std::max(1., nbPixels/16384.));
 }
 
 void TransientAreasSegmentationModuleImpl::getSegmentationPicture(OutputArray transientAreas)
@@ -518,19 +510,9 @@ void TransientAreasSegmentationModuleImpl::getSegmentationPicture(OutputArray tr
 
 void TransientAreasSegmentationModuleImpl::_convertValarrayBuffer2cvMat(const std::valarray<bool> &grayMatrixToConvert, const unsigned int nbRows, const unsigned int nbColumns, OutputArray outBuffer)
 {
-    // fill output buffer with the valarray buffer
+    // fill output buffer with the valarray buffer, its bool values are bytes of 0 and 1
     const bool *valarrayPTR=get_data(grayMatrixToConvert);
-
-    outBuffer.create(cv::Size(nbColumns, nbRows), CV_8U);
-    Mat outMat = outBuffer.getMat();
-    for (unsigned int i=0;i<nbRows;++i)
-    {
-        for (unsigned int j=0;j<nbColumns;++j)
-        {
-            cv::Point2d pixel(j,i);
-            outMat.at<unsigned char>(pixel)=(unsigned char)*(valarrayPTR++);
-        }
-    }
+    cv::Mat((int)nbRows, (int)nbColumns, CV_8U, (void*)valarrayPTR).copyTo(outBuffer);
 }
 
 bool TransientAreasSegmentationModuleImpl::_convertCvMat2ValarrayBuffer(InputArray inputMat, std::valarray<float> &outputValarrayMatrix)
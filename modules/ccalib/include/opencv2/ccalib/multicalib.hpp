@@ -167,6 +167,11 @@ private:
 
     void computeJacobianExtrinsic(const Mat& extrinsicParams, Mat& JTJ_inv, Mat& JTE);
 
+    void computeEdgeJacobians(const Mat& extrinsicParams, std::vector<Mat>& jacobianPhoto, std::vector<Mat>& jacobianCamera,
+        std::vector<Mat>& errors);
+
+    bool computeUpdateExtrinsic(const Mat& extrinsicParams, Mat& G);
+
     void computePhotoCameraJacobian(const Mat& rvecPhoto, const Mat& tvecPhoto, const Mat& rvecCamera,
         const Mat& tvecCamera, Mat& rvecTran, Mat& tvecTran, const Mat& objectPoints, const Mat& imagePoints, const Mat& K,
         const Mat& distort, const Mat& xi, Mat& jacobianPhoto, Mat& jacobianCamera, Mat& E);
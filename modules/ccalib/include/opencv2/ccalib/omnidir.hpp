@@ -245,6 +245,57 @@ namespace omnidir
         OutputArray disparity, OutputArray image1Rec, OutputArray image2Rec, const Size& newSize = Size(), InputArray Knew = cv::noArray(),
         OutputArray pointCloud = cv::noArray(), int pointType = XYZRGB);
 
+    /** @brief Undistortion of a stream of omnidirectional images.
+
+    It computes the maps of omnidir::initUndistortRectifyMap once, in the CV_16SC2 fixed point format, and
+    remaps every image with them. The results are the same as omnidir::undistortImage.
+    */
+    class CV_EXPORTS_W OmniRectifier
+    {
+    public:
+        virtual ~OmniRectifier() {}
+
+        /** @brief Undistort an image.
+
+        @param distorted The input omnidirectional image.
+        @param undistorted The output undistorted image.
+        @note If no new size was given, the maps are computed again when the size of the input images changes.
+        */
+        CV_WRAP virtual void apply(InputArray distorted, OutputArray undistorted) = 0;
+
+        /** @brief Returns the maps used by apply, see omnidir::initUndistortRectifyMap. They are empty if no
+        new size was given and no image was undistorted yet.
+        */
+        CV_WRAP virtual void getMaps(OutputArray map1, OutputArray map2) const = 0;
+
+        /** @brief Creates the rectifier, the parameters are the ones of omnidir::undistortImage.
+        */
+        CV_WRAP static Ptr<OmniRectifier> create(InputArray K, InputArray D, InputArray xi, int flags,
+            InputArray Knew = cv::noArray(), const Size& new_size = Size(), InputArray R = Mat::eye(3, 3, CV_64F));
+    };
+
+    /** @brief Stereo 3D reconstruction of a stream of image pairs.
+
+    The rectification maps of both cameras and the StereoSGBM matcher are created once and reused by every
+    call of compute, which gives the same results as omnidir::stereoReconstruct.
+    */
+    class CV_EXPORTS_W OmniStereoReconstructor
+    {
+    public:
+        virtual ~OmniStereoReconstructor() {}
+
+        /** @brief Reconstruct a pair of images, the outputs are the ones of omnidir::stereoReconstruct.
+        */
+        CV_WRAP virtual void compute(InputArray image1, InputArray image2, OutputArray disparity, OutputArray image1Rec,
+            OutputArray image2Rec, OutputArray pointCloud = cv::noArray(), int pointType = XYZRGB) = 0;
+
+        /** @brief Creates the reconstructor, the parameters are the ones of omnidir::stereoReconstruct.
+        */
+        CV_WRAP static Ptr<OmniStereoReconstructor> create(InputArray K1, InputArray D1, InputArray xi1,
+            InputArray K2, InputArray D2, InputArray xi2, InputArray R, InputArray T, int flag, int numDisparities,
+            int SADWindowSize, const Size& newSize = Size(), InputArray Knew = cv::noArray());
+    };
+
 namespace internal
 {
     void initializeCalibration(InputArrayOfArrays objectPoints, InputArrayOfArrays imagePoints, Size size, OutputArrayOfArrays omAll,
@@ -257,6 +308,11 @@ namespace internal
     void computeJacobian(InputArrayOfArrays objectPoints, InputArrayOfArrays imagePoints, InputArray parameters, Mat& JTJ_inv, Mat& JTE, int flags,
 							double epsilon);
 
+    //! Gauss-Newton update JTJ_inv*JTE of computeJacobian, solved by the Schur complement of the extrinsic parameters,
+    //! returns false if it is not positive definite
+    bool computeUpdateSchur(InputArrayOfArrays objectPoints, InputArrayOfArrays imagePoints, InputArray parameters, Mat& G, int flags,
+        double epsilon);
+
     void computeJacobianStereo(InputArrayOfArrays objectPoints, InputArrayOfArrays imagePoints1, InputArrayOfArrays imagePoints2,
         InputArray parameters, Mat& JTJ_inv, Mat& JTE, int flags, double epsilon);
 
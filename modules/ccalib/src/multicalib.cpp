@@ -63,6 +63,7 @@
 #include <string>
 #include <vector>
 #include <queue>
+#include <algorithm>
 #include <iostream>
 
 namespace cv { namespace multicalib {
@@ -365,9 +366,14 @@ double MultiCameraCalibration::optimizeExtrinsics()
             (_criteria.type == 3 && (change <= _criteria.epsilon || iter >= _criteria.maxCount)))
             break;
         double alpha_smooth2 = 1 - std::pow(1 - alpha_smooth, (double)iter + 1.0);
-        Mat JTJ_inv, JTError;
-        this->computeJacobianExtrinsic(extrinParam, JTJ_inv, JTError);
-        Mat G = alpha_smooth2*JTJ_inv * JTError;
+        Mat G;
+        if (!this->computeUpdateExtrinsic(extrinParam, G))
+        {
+            Mat JTJ_inv, JTError;
+            this->computeJacobianExtrinsic(extrinParam, JTJ_inv, JTError);
+            G = JTJ_inv * JTError;
+        }
+        G = alpha_smooth2 * G;
         if (G.depth() == CV_64F)
         {
             G.convertTo(G, CV_32F);
@@ -400,70 +406,177 @@ double MultiCameraCalibration::optimizeExtrinsics()
     return error;
 }
 
+void MultiCameraCalibration::computeEdgeJacobians(const Mat& extrinsicParams, std::vector<Mat>& jacobianPhoto,
+    std::vector<Mat>& jacobianCamera, std::vector<Mat>& errors)
+{
+    int nEdge = (int)_edgeList.size();
+    jacobianPhoto.resize(nEdge);
+    jacobianCamera.resize(nEdge);
+    errors.resize(nEdge);
+
+    parallel_for_(Range(0, nEdge), [&](const Range& range)
+    {
+        for (int edgeIdx = range.start; edgeIdx < range.end; ++edgeIdx)
+        {
+            int photoVertex = _edgeList[edgeIdx].photoVertex;
+            int photoIndex = _edgeList[edgeIdx].photoIndex;
+            int cameraVertex = _edgeList[edgeIdx].cameraVertex;
+
+            Mat objectPoints = _objectPointsForEachCamera[cameraVertex][photoIndex];
+            Mat imagePoints = _imagePointsForEachCamera[cameraVertex][photoIndex];
+
+            Mat rvecTran, tvecTran;
+            Mat R = _edgeList[edgeIdx].transform.rowRange(0, 3).colRange(0, 3);
+            tvecTran = _edgeList[edgeIdx].transform.rowRange(0, 3).col(3);
+            cv::Rodrigues(R, rvecTran);
+
+            Mat rvecPhoto = extrinsicParams.colRange((photoVertex-1)*6, (photoVertex-1)*6 + 3);
+            Mat tvecPhoto = extrinsicParams.colRange((photoVertex-1)*6 + 3, (photoVertex-1)*6 + 6);
+
+            Mat rvecCamera, tvecCamera;
+            if (cameraVertex > 0)
+            {
+                rvecCamera = extrinsicParams.colRange((cameraVertex-1)*6, (cameraVertex-1)*6 + 3);
+                tvecCamera = extrinsicParams.colRange((cameraVertex-1)*6 + 3, (cameraVertex-1)*6 + 6);
+            }
+            else
+            {
+                rvecCamera = Mat::zeros(3, 1, CV_32F);
+                tvecCamera = Mat::zeros(3, 1, CV_32F);
+            }
+
+            computePhotoCameraJacobian(rvecPhoto, tvecPhoto, rvecCamera, tvecCamera, rvecTran, tvecTran,
+                objectPoints, imagePoints, this->_cameraMatrix[cameraVertex], this->_distortCoeffs[cameraVertex],
+                this->_xi[cameraVertex], jacobianPhoto[edgeIdx], jacobianCamera[edgeIdx], errors[edgeIdx]);
+        }
+    });
+}
+
 void MultiCameraCalibration::computeJacobianExtrinsic(const Mat& extrinsicParams, Mat& JTJ_inv, Mat& JTE)
 {
     int nParam = (int)extrinsicParams.total();
     int nEdge = (int)_edgeList.size();
-    std::vector<int> pointsLocation(nEdge+1, 0);
 
+    std::vector<Mat> jacobianPhoto, jacobianCamera, errors;
+    computeEdgeJacobians(extrinsicParams, jacobianPhoto, jacobianCamera, errors);
+
+    // every edge only depends on the pose of its photo and of its camera, so J^T*J and J^T*E
+    // are accumulated from the 6x6 blocks of the edges instead of the whole J
+    Mat JTJ = Mat::zeros(nParam, nParam, CV_64F);
+    JTE = Mat::zeros(nParam, 1, CV_64F);
     for (int edgeIdx = 0; edgeIdx < nEdge; ++edgeIdx)
     {
-        int nPoints = (int)_objectPointsForEachCamera[_edgeList[edgeIdx].cameraVertex][_edgeList[edgeIdx].photoIndex].total();
-        pointsLocation[edgeIdx+1] = pointsLocation[edgeIdx] + nPoints*2;
+        int photoOffset = (_edgeList[edgeIdx].photoVertex-1)*6;
+        int cameraVertex = _edgeList[edgeIdx].cameraVertex;
+        const Mat& Jp = jacobianPhoto[edgeIdx];
+
+        JTJ(Rect(photoOffset, photoOffset, 6, 6)) += Jp.t() * Jp;
+        JTE.rowRange(photoOffset, photoOffset + 6) += Jp.t() * errors[edgeIdx];
+        if (cameraVertex > 0)
+        {
+            int cameraOffset = (cameraVertex-1)*6;
+            const Mat& Jc = jacobianCamera[edgeIdx];
+            Mat JpTJc = Jp.t() * Jc;
+            JTJ(Rect(cameraOffset, cameraOffset, 6, 6)) += Jc.t() * Jc;
+            JTJ(Rect(cameraOffset, photoOffset, 6, 6)) += JpTJc;
+            JTJ(Rect(photoOffset, cameraOffset, 6, 6)) += JpTJc.t();
+            JTE.rowRange(cameraOffset, cameraOffset + 6) += Jc.t() * errors[edgeIdx];
+        }
     }
+    JTJ_inv = (JTJ + 1e-10).inv();
+}
 
-    JTJ_inv = Mat(nParam, nParam, CV_64F);
-    JTE = Mat(nParam, 1, CV_64F);
+bool MultiCameraCalibration::computeUpdateExtrinsic(const Mat& extrinsicParams, Mat& G)
+{
+    int nParam = (int)extrinsicParams.total();
+    int nEdge = (int)_edgeList.size();
+    int nCameraParam = (_nCamera-1)*6;
+    int nPhoto = (nParam - nCameraParam) / 6;
+    if (nCameraParam == 0 || nPhoto <= 0)
+        return false;
+    for (int edgeIdx = 0; edgeIdx < nEdge; ++edgeIdx)
+    {
+        if (_edgeList[edgeIdx].photoVertex < _nCamera)
+            return false;
+    }
 
-    Mat J = Mat::zeros(pointsLocation[nEdge], nParam, CV_64F);
-    Mat E = Mat::zeros(pointsLocation[nEdge], 1, CV_64F);
+    std::vector<Mat> jacobianPhoto, jacobianCamera, errors;
+    computeEdgeJacobians(extrinsicParams, jacobianPhoto, jacobianCamera, errors);
 
+    // the photo poses only couple with the camera poses, so V, the photo part of J^T*J, is block diagonal
+    // and they are eliminated photo by photo. The solve of computeJacobianExtrinsic adds 1e-10 to every
+    // element of J^T*J, which is the rank one update 1e-10*1*1^T applied with the Sherman-Morrison
+    // formula, so both right hand sides J^T*E and 1 are solved.
+    Mat U = Mat::zeros(nCameraParam, nCameraParam, CV_64F), bCamera = Mat::zeros(nCameraParam, 2, CV_64F);
+    std::vector<Mat> V(nPhoto), W(nPhoto), bPhoto(nPhoto);
+    for (int p = 0; p < nPhoto; ++p)
+    {
+        V[p] = Mat::zeros(6, 6, CV_64F);
+        W[p] = Mat::zeros(6, nCameraParam, CV_64F);
+        bPhoto[p] = Mat::zeros(6, 2, CV_64F);
+        bPhoto[p].col(1).setTo(1);
+    }
+    bCamera.col(1).setTo(1);
     for (int edgeIdx = 0; edgeIdx < nEdge; ++edgeIdx)
     {
-        int photoVertex = _edgeList[edgeIdx].photoVertex;
-        int photoIndex = _edgeList[edgeIdx].photoIndex;
+        int p = _edgeList[edgeIdx].photoVertex - _nCamera;
         int cameraVertex = _edgeList[edgeIdx].cameraVertex;
+        const Mat& Jp = jacobianPhoto[edgeIdx];
 
-        Mat objectPoints = _objectPointsForEachCamera[cameraVertex][photoIndex];
-        Mat imagePoints = _imagePointsForEachCamera[cameraVertex][photoIndex];
-
-        Mat rvecTran, tvecTran;
-        Mat R = _edgeList[edgeIdx].transform.rowRange(0, 3).colRange(0, 3);
-        tvecTran = _edgeList[edgeIdx].transform.rowRange(0, 3).col(3);
-        cv::Rodrigues(R, rvecTran);
-
-        Mat rvecPhoto = extrinsicParams.colRange((photoVertex-1)*6, (photoVertex-1)*6 + 3);
-        Mat tvecPhoto = extrinsicParams.colRange((photoVertex-1)*6 + 3, (photoVertex-1)*6 + 6);
-
-        Mat rvecCamera, tvecCamera;
+        V[p] += Jp.t() * Jp;
+        bPhoto[p].col(0) += Jp.t() * errors[edgeIdx];
         if (cameraVertex > 0)
         {
-            rvecCamera = extrinsicParams.colRange((cameraVertex-1)*6, (cameraVertex-1)*6 + 3);
-            tvecCamera = extrinsicParams.colRange((cameraVertex-1)*6 + 3, (cameraVertex-1)*6 + 6);
-        }
-        else
-        {
-            rvecCamera = Mat::zeros(3, 1, CV_32F);
-            tvecCamera = Mat::zeros(3, 1, CV_32F);
+            int cameraOffset = (cameraVertex-1)*6;
+            const Mat& Jc = jacobianCamera[edgeIdx];
+            U(Rect(cameraOffset, cameraOffset, 6, 6)) += Jc.t() * Jc;
+            W[p].colRange(cameraOffset, cameraOffset + 6) += Jp.t() * Jc;
+            bCamera.rowRange(cameraOffset, cameraOffset + 6).col(0) += Jc.t() * errors[edgeIdx];
         }
+    }
 
-        Mat jacobianPhoto, jacobianCamera, error;
-        computePhotoCameraJacobian(rvecPhoto, tvecPhoto, rvecCamera, tvecCamera, rvecTran, tvecTran,
-            objectPoints, imagePoints, this->_cameraMatrix[cameraVertex], this->_distortCoeffs[cameraVertex],
-            this->_xi[cameraVertex], jacobianPhoto, jacobianCamera, error);
-        if (cameraVertex > 0)
+    std::vector<Mat> VinvW(nPhoto), Vinvb(nPhoto), reducedU(nPhoto), reducedb(nPhoto);
+    std::vector<uchar> valid(nPhoto, 1);
+    parallel_for_(Range(0, nPhoto), [&](const Range& range)
+    {
+        for (int p = range.start; p < range.end; ++p)
         {
-            jacobianCamera.copyTo(J.rowRange(pointsLocation[edgeIdx], pointsLocation[edgeIdx+1]).
-                colRange((cameraVertex-1)*6, cameraVertex*6));
+            Mat Vinv;
+            if (cv::invert(V[p], Vinv, DECOMP_CHOLESKY) == 0)
+            {
+                valid[p] = 0;
+                continue;
+            }
+            VinvW[p] = Vinv * W[p];
+            Vinvb[p] = Vinv * bPhoto[p];
+            reducedU[p] = W[p].t() * VinvW[p];
+            reducedb[p] = W[p].t() * Vinvb[p];
         }
-        jacobianPhoto.copyTo(J.rowRange(pointsLocation[edgeIdx], pointsLocation[edgeIdx+1]).
-            colRange((photoVertex-1)*6, photoVertex*6));
-        error.copyTo(E.rowRange(pointsLocation[edgeIdx], pointsLocation[edgeIdx+1]));
+    });
+    if (std::find(valid.begin(), valid.end(), 0) != valid.end())
+        return false;
+
+    for (int p = 0; p < nPhoto; ++p)
+    {
+        U -= reducedU[p];
+        bCamera -= reducedb[p];
+    }
+    Mat xCamera;
+    if (!cv::solve(U, bCamera, xCamera, DECOMP_CHOLESKY))
+        return false;
+
+    // columns of x are (J^T*J)^-1*J^T*E and (J^T*J)^-1*1
+    Mat x(nParam, 2, CV_64F);
+    xCamera.copyTo(x.rowRange(0, nCameraParam));
+    for (int p = 0; p < nPhoto; ++p)
+    {
+        Mat xPhoto = Vinvb[p] - VinvW[p] * xCamera;
+        xPhoto.copyTo(x.rowRange(nCameraParam + p*6, nCameraParam + p*6 + 6));
     }
-    //std::cout << J.t() * J << std::endl;
-    JTJ_inv = (J.t() * J + 1e-10).inv();
-    JTE = J.t() * E;
 
+    double sumStep = cv::sum(x.col(0))[0], sumOnes = cv::sum(x.col(1))[0];
+    G = x.col(0) - x.col(1) * (1e-10 * sumStep / (1 + 1e-10 * sumOnes));
+    return true;
 }
 void MultiCameraCalibration::computePhotoCameraJacobian(const Mat& rvecPhoto, const Mat& tvecPhoto, const Mat& rvecCamera,
     const Mat& tvecCamera, Mat& rvecTran, Mat& tvecTran, const Mat& objectPoints, const Mat& imagePoints, const Mat& K,
@@ -60,6 +60,7 @@
 #include "opencv2/ccalib/omnidir.hpp"
 #include <fstream>
 #include <iostream>
+#include <algorithm>
 namespace cv { namespace
 {
     struct JacobianRow
@@ -405,130 +406,140 @@ void cv::omnidir::initUndistortRectifyMap(InputArray K, InputArray D, InputArray
     cv::Matx33d iK = PP.inv(cv::DECOMP_SVD);
     cv::Matx33d iR = RR.inv(cv::DECOMP_SVD);
 
+    Mat _map1 = map1.getMat(), _map2 = map2.getMat();
+    // the rows are independent, every stripe gets a few of them
+    const double nstripes = std::max(1, size.height / 16);
+
     if (flags == omnidir::RECTIFY_PERSPECTIVE)
     {
-        for (int i = 0; i < size.height; ++i)
+        parallel_for_(Range(0, size.height), [&](const Range& range)
         {
-            float* m1f = map1.getMat().ptr<float>(i);
-            float* m2f = map2.getMat().ptr<float>(i);
-            short*  m1 = (short*)m1f;
-            ushort* m2 = (ushort*)m2f;
-
-            double _x = i*iKR(0, 1) + iKR(0, 2),
-                   _y = i*iKR(1, 1) + iKR(1, 2),
-                   _w = i*iKR(2, 1) + iKR(2, 2);
-            for(int j = 0; j < size.width; ++j, _x+=iKR(0,0), _y+=iKR(1,0), _w+=iKR(2,0))
+            for (int i = range.start; i < range.end; ++i)
             {
-                // project back to unit sphere
-                double r = sqrt(_x*_x + _y*_y + _w*_w);
-                double Xs = _x / r;
-                double Ys = _y / r;
-                double Zs = _w / r;
-                // project to image plane
-                double xu = Xs / (Zs + _xi),
-                    yu = Ys / (Zs + _xi);
-                // add distortion
-                double r2 = xu*xu + yu*yu;
-                double r4 = r2*r2;
-                double xd = (1+k[0]*r2+k[1]*r4)*xu + 2*p[0]*xu*yu + p[1]*(r2+2*xu*xu);
-                double yd = (1+k[0]*r2+k[1]*r4)*yu + p[0]*(r2+2*yu*yu) + 2*p[1]*xu*yu;
-                // to image pixel
-                double u = f[0]*xd + s*yd + c[0];
-                double v = f[1]*yd + c[1];
-
-                if( m1type == CV_16SC2 )
-                {
-                    int iu = cv::saturate_cast<int>(u*cv::INTER_TAB_SIZE);
-                    int iv = cv::saturate_cast<int>(v*cv::INTER_TAB_SIZE);
-                    m1[j*2+0] = (short)(iu >> cv::INTER_BITS);
-                    m1[j*2+1] = (short)(iv >> cv::INTER_BITS);
-                    m2[j] = (ushort)((iv & (cv::INTER_TAB_SIZE-1))*cv::INTER_TAB_SIZE + (iu & (cv::INTER_TAB_SIZE-1)));
-                }
-                else if( m1type == CV_32FC1 )
+                float* m1f = _map1.ptr<float>(i);
+                float* m2f = _map2.ptr<float>(i);
+                short*  m1 = (short*)m1f;
+                ushort* m2 = (ushort*)m2f;
+
+                double _x = i*iKR(0, 1) + iKR(0, 2),
+                       _y = i*iKR(1, 1) + iKR(1, 2),
+                       _w = i*iKR(2, 1) + iKR(2, 2);
+                for(int j = 0; j < size.width; ++j, _x+=iKR(0,0), _y+=iKR(1,0), _w+=iKR(2,0))
                 {
-                    m1f[j] = (float)u;
-                    m2f[j] = (float)v;
+                    // project back to unit sphere
+                    double r = sqrt(_x*_x + _y*_y + _w*_w);
+                    double Xs = _x / r;
+                    double Ys = _y / r;
+                    double Zs = _w / r;
+                    // project to image plane
+                    double xu = Xs / (Zs + _xi),
+                        yu = Ys / (Zs + _xi);
+                    // add distortion
+                    double r2 = xu*xu + yu*yu;
+                    double r4 = r2*r2;
+                    double xd = (1+k[0]*r2+k[1]*r4)*xu + 2*p[0]*xu*yu + p[1]*(r2+2*xu*xu);
+                    double yd = (1+k[0]*r2+k[1]*r4)*yu + p[0]*(r2+2*yu*yu) + 2*p[1]*xu*yu;
+                    // to image pixel
+                    double u = f[0]*xd + s*yd + c[0];
+                    double v = f[1]*yd + c[1];
+
+                    if( m1type == CV_16SC2 )
+                    {
+                        int iu = cv::saturate_cast<int>(u*cv::INTER_TAB_SIZE);
+                        int iv = cv::saturate_cast<int>(v*cv::INTER_TAB_SIZE);
+                        m1[j*2+0] = (short)(iu >> cv::INTER_BITS);
+                        m1[j*2+1] = (short)(iv >> cv::INTER_BITS);
+                        m2[j] = (ushort)((iv & (cv::INTER_TAB_SIZE-1))*cv::INTER_TAB_SIZE + (iu & (cv::INTER_TAB_SIZE-1)));
+                    }
+                    else if( m1type == CV_32FC1 )
+                    {
+                        m1f[j] = (float)u;
+                        m2f[j] = (float)v;
+                    }
                 }
             }
-        }
+        }, nstripes);
     }
     else if(flags == omnidir::RECTIFY_CYLINDRICAL || flags == omnidir::RECTIFY_LONGLATI ||
         flags == omnidir::RECTIFY_STEREOGRAPHIC)
     {
-        for (int i = 0; i < size.height; ++i)
+        parallel_for_(Range(0, size.height), [&](const Range& range)
         {
-            float* m1f = map1.getMat().ptr<float>(i);
-            float* m2f = map2.getMat().ptr<float>(i);
-            short*  m1 = (short*)m1f;
-            ushort* m2 = (ushort*)m2f;
+            for (int i = range.start; i < range.end; ++i)
+            {
+                float* m1f = _map1.ptr<float>(i);
+                float* m2f = _map2.ptr<float>(i);
+                short*  m1 = (short*)m1f;
+                ushort* m2 = (ushort*)m2f;
 
-            // for RECTIFY_LONGLATI, theta and h are longittude and latitude
-            double theta = i*iK(0, 1) + iK(0, 2),
-                   h     = i*iK(1, 1) + iK(1, 2);
+                // for RECTIFY_LONGLATI, theta and h are longittude and latitude
+                double theta = i*iK(0, 1) + iK(0, 2),
+                       h     = i*iK(1, 1) + iK(1, 2);
 
-            for (int j = 0; j < size.width; ++j, theta+=iK(0,0), h+=iK(1,0))
-            {
-                double _xt = 0.0, _yt = 0.0, _wt = 0.0;
-                if (flags == omnidir::RECTIFY_CYLINDRICAL)
-                {
-                    //_xt = std::sin(theta);
-                    //_yt = h;
-                    //_wt = std::cos(theta);
-                    _xt = std::cos(theta);
-                    _yt = std::sin(theta);
-                    _wt = h;
-                }
-                else if (flags == omnidir::RECTIFY_LONGLATI)
-                {
-                    _xt = -std::cos(theta);
-                    _yt = -std::sin(theta) * std::cos(h);
-                    _wt = std::sin(theta) * std::sin(h);
-                }
-                else if (flags == omnidir::RECTIFY_STEREOGRAPHIC)
+                for (int j = 0; j < size.width; ++j, theta+=iK(0,0), h+=iK(1,0))
                 {
-                    double a = theta*theta + h*h + 4;
-                    double b = -2*theta*theta - 2*h*h;
-                    double c2 = theta*theta + h*h -4;
+                    double _xt = 0.0, _yt = 0.0, _wt = 0.0;
+                    if (flags == omnidir::RECTIFY_CYLINDRICAL)
+                    {
+                        //_xt = std::sin(theta);
+                        //_yt = h;
+                        //_wt = std::cos(theta);
+                        _xt = std::cos(theta);
+                        _yt = std::sin(theta);
+                        _wt = h;
+                    }
+                    else if (flags == omnidir::RECTIFY_LONGLATI)
+                    {
+                        _xt = -std::cos(theta);
+                        _yt = -std::sin(theta) * std::cos(h);
+                        _wt = std::sin(theta) * std::sin(h);
+                    }
+                    else if (flags == omnidir::RECTIFY_STEREOGRAPHIC)
+                    {
+                        double a = theta*theta + h*h + 4;
+                        double b = -2*theta*theta - 2*h*h;
+                        double c2 = theta*theta + h*h -4;
 
-                    _yt = (-b-std::sqrt(b*b - 4*a*c2))/(2*a);
-                    _xt = theta*(1 - _yt) / 2;
-                    _wt = h*(1 - _yt) / 2;
-                }
-                double _x = iR(0,0)*_xt + iR(0,1)*_yt + iR(0,2)*_wt;
-                double _y = iR(1,0)*_xt + iR(1,1)*_yt + iR(1,2)*_wt;
-                double _w = iR(2,0)*_xt + iR(2,1)*_yt + iR(2,2)*_wt;
-
-                double r = sqrt(_x*_x + _y*_y + _w*_w);
-                double Xs = _x / r;
-                double Ys = _y / r;
-                double Zs = _w / r;
-                // project to image plane
-                double xu = Xs / (Zs + _xi),
-                       yu = Ys / (Zs + _xi);
-                // add distortion
-                double r2 = xu*xu + yu*yu;
-                double r4 = r2*r2;
-                double xd = (1+k[0]*r2+k[1]*r4)*xu + 2*p[0]*xu*yu + p[1]*(r2+2*xu*xu);
-                double yd = (1+k[0]*r2+k[1]*r4)*yu + p[0]*(r2+2*yu*yu) + 2*p[1]*xu*yu;
-                // to image pixel
-                double u = f[0]*xd + s*yd + c[0];
-                double v = f[1]*yd + c[1];
-
-                if( m1type == CV_16SC2 )
-                {
-                    int iu = cv::saturate_cast<int>(u*cv::INTER_TAB_SIZE);
-                    int iv = cv::saturate_cast<int>(v*cv::INTER_TAB_SIZE);
-                    m1[j*2+0] = (short)(iu >> cv::INTER_BITS);
-                    m1[j*2+1] = (short)(iv >> cv::INTER_BITS);
-                    m2[j] = (ushort)((iv & (cv::INTER_TAB_SIZE-1))*cv::INTER_TAB_SIZE + (iu & (cv::INTER_TAB_SIZE-1)));
-                }
-                else if( m1type == CV_32FC1 )
-                {
-                    m1f[j] = (float)u;
-                    m2f[j] = (float)v;
+                        _yt = (-b-std::sqrt(b*b - 4*a*c2))/(2*a);
+                        _xt = theta*(1 - _yt) / 2;
+                        _wt = h*(1 - _yt) / 2;
+                    }
+                    double _x = iR(0,0)*_xt + iR(0,1)*_yt + iR(0,2)*_wt;
+                    double _y = iR(1,0)*_xt + iR(1,1)*_yt + iR(1,2)*_wt;
+                    double _w = iR(2,0)*_xt + iR(2,1)*_yt + iR(2,2)*_wt;
+
+                    double r = sqrt(_x*_x + _y*_y + _w*_w);
+                    double Xs = _x / r;
+                    double Ys = _y / r;
+                    double Zs = _w / r;
+                    // project to image plane
+                    double xu = Xs / (Zs + _xi),
+                           yu = Ys / (Zs + _xi);
+                    // add distortion
+                    double r2 = xu*xu + yu*yu;
+                    double r4 = r2*r2;
+                    double xd = (1+k[0]*r2+k[1]*r4)*xu + 2*p[0]*xu*yu + p[1]*(r2+2*xu*xu);
+                    double yd = (1+k[0]*r2+k[1]*r4)*yu + p[0]*(r2+2*yu*yu) + 2*p[1]*xu*yu;
+                    // to image pixel
+                    double u = f[0]*xd + s*yd + c[0];
+                    double v = f[1]*yd + c[1];
+
+                    if( m1type == CV_16SC2 )
+                    {
+                        int iu = cv::saturate_cast<int>(u*cv::INTER_TAB_SIZE);
+                        int iv = cv::saturate_cast<int>(v*cv::INTER_TAB_SIZE);
+                        m1[j*2+0] = (short)(iu >> cv::INTER_BITS);
+                        m1[j*2+1] = (short)(iv >> cv::INTER_BITS);
+                        m2[j] = (ushort)((iv & (cv::INTER_TAB_SIZE-1))*cv::INTER_TAB_SIZE + (iu & (cv::INTER_TAB_SIZE-1)));
+                    }
+                    else if( m1type == CV_32FC1 )
+                    {
+                        m1f[j] = (float)u;
+                        m2f[j] = (float)v;
+                    }
                 }
             }
-        }
+        }, nstripes);
     }
 }
 
@@ -848,73 +859,92 @@ void cv::omnidir::internal::initializeStereoCalibration(InputArrayOfArrays objec
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /// cv::omnidir::internal::computeJacobian
 
-void cv::omnidir::internal::computeJacobian(InputArrayOfArrays objectPoints, InputArrayOfArrays imagePoints,
-    InputArray parameters, Mat& JTJ_inv, Mat& JTE, int flags, double epsilon)
+namespace cv { namespace
 {
-    CV_Assert(!objectPoints.empty() && objectPoints.type() == CV_64FC3);
-    CV_Assert(!imagePoints.empty() && imagePoints.type() == CV_64FC2);
 
+// blocks of the normal equation that one view contributes to, JEx and JIn are the Jacobians
+// of its reprojection error by its extrinsic and by the intrinsic parameters
+struct ViewNormalBlocks
+{
+    Mat JExTJEx;    // 6x6
+    Mat JExTJIn;    // 6x10
+    Mat JInTJIn;    // 10x10
+    Mat JExTE;      // 6x1
+    Mat JInTE;      // 10x1
+};
+
+void computeViewNormalBlocks(InputArrayOfArrays objectPoints, InputArrayOfArrays imagePoints, const Mat& parameters,
+    std::vector<ViewNormalBlocks>& blocks)
+{
     int n = (int)objectPoints.total();
-
-    Mat JTJ = Mat::zeros(10 + 6*n, 10 + 6*n, CV_64F);
-    JTJ_inv = Mat::zeros(10 + 6*n, 10 + 6*n, CV_64F);
-    JTE = Mat::zeros(10 + 6*n, 1, CV_64F);
-
-    int nPointsAll = 0;
-    for (int i = 0; i < n; ++i)
+    std::vector<Mat> objPointsAll(n), imgPointsAll(n);
+    for (int i = 0; i < n; i++)
     {
-        nPointsAll += (int)objectPoints.getMat(i).total();
+        objectPoints.getMat(i).copyTo(objPointsAll[i]);
+        imagePoints.getMat(i).copyTo(imgPointsAll[i]);
+        objPointsAll[i] = objPointsAll[i].reshape(3, objPointsAll[i].rows*objPointsAll[i].cols);
+        imgPointsAll[i] = imgPointsAll[i].reshape(2, imgPointsAll[i].rows*imgPointsAll[i].cols);
     }
 
-    Mat J = Mat::zeros(2*nPointsAll, 10+6*n, CV_64F);
-    Mat exAll = Mat::zeros(2*nPointsAll, 10+6*n, CV_64F);
-    double *para = parameters.getMat().ptr<double>();
+    const double *para = parameters.ptr<double>();
     Matx33d K(para[6*n], para[6*n+2], para[6*n+3],
         0,    para[6*n+1], para[6*n+4],
         0,    0,  1);
     Matx14d D(para[6*n+6], para[6*n+7], para[6*n+8], para[6*n+9]);
     double xi = para[6*n+5];
-    for (int i = 0; i < n; i++)
-    {
-        Mat objPoints, imgPoints, om, T;
-		objectPoints.getMat(i).copyTo(objPoints);
-		imagePoints.getMat(i).copyTo(imgPoints);
-		objPoints = objPoints.reshape(3, objPoints.rows*objPoints.cols);
-		imgPoints = imgPoints.reshape(2, imgPoints.rows*imgPoints.cols);
-
-        om = parameters.getMat().colRange(i*6, i*6+3);
-        T = parameters.getMat().colRange(i*6+3, (i+1)*6);
-        Mat imgProj, jacobian;
-        omnidir::projectPoints(objPoints, imgProj, om, T, K, xi, D, jacobian);
-        Mat projError = imgPoints - imgProj;
-
-        // The intrinsic part of Jacobian
-        Mat JIn(jacobian.rows, 10, CV_64F);
-        Mat JEx(jacobian.rows, 6, CV_64F);
 
-        jacobian.colRange(6, 16).copyTo(JIn);
-        jacobian.colRange(0, 6).copyTo(JEx);
-
-        JTJ(Rect(6*n, 6*n, 10, 10)) = JTJ(Rect(6*n, 6*n, 10, 10)) + JIn.t()*JIn;
+    blocks.resize(n);
+    parallel_for_(Range(0, n), [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            Mat om = parameters.colRange(i*6, i*6+3);
+            Mat T = parameters.colRange(i*6+3, (i+1)*6);
+            Mat imgProj, jacobian;
+            omnidir::projectPoints(objPointsAll[i], imgProj, om, T, K, xi, D, jacobian);
+            Mat projError = imgPointsAll[i] - imgProj;
+            projError = projError.reshape(1, 2*(int)projError.total());
+
+            Mat JIn = jacobian.colRange(6, 16);
+            Mat JEx = jacobian.colRange(0, 6);
+
+            ViewNormalBlocks& b = blocks[i];
+            b.JExTJEx = JEx.t() * JEx;
+            b.JExTJIn = JEx.t() * JIn;
+            b.JInTJIn = JIn.t() * JIn;
+            b.JExTE = JEx.t() * projError;
+            b.JInTE = JIn.t() * projError;
+        }
+    });
+}
+}}
 
-        JTJ(Rect(i*6, i*6, 6, 6)) = JEx.t() * JEx;
+void cv::omnidir::internal::computeJacobian(InputArrayOfArrays objectPoints, InputArrayOfArrays imagePoints,
+    InputArray parameters, Mat& JTJ_inv, Mat& JTE, int flags, double epsilon)
+{
+    CV_Assert(!objectPoints.empty() && objectPoints.type() == CV_64FC3);
+    CV_Assert(!imagePoints.empty() && imagePoints.type() == CV_64FC2);
 
-        Mat JExTIn = JEx.t() * JIn;
+    int n = (int)objectPoints.total();
 
-        JExTIn.copyTo(JTJ(Rect(6*n, i*6, 10, 6)));
+    Mat JTJ = Mat::zeros(10 + 6*n, 10 + 6*n, CV_64F);
+    JTJ_inv = Mat::zeros(10 + 6*n, 10 + 6*n, CV_64F);
+    JTE = Mat::zeros(10 + 6*n, 1, CV_64F);
 
-        Mat(JIn.t()*JEx).copyTo(JTJ(Rect(i*6, 6*n, 6, 10)));
+    std::vector<ViewNormalBlocks> blocks;
+    computeViewNormalBlocks(objectPoints, imagePoints, parameters.getMat(), blocks);
 
-        JTE(Rect(0, 6*n, 1, 10)) = JTE(Rect(0, 6*n,1, 10)) + JIn.t() * projError.reshape(1, 2*(int)projError.total());
-        JTE(Rect(0, i*6, 1, 6)) = JEx.t() * projError.reshape(1, 2*(int)projError.total());
+    for (int i = 0; i < n; i++)
+    {
+        const ViewNormalBlocks& b = blocks[i];
+        JTJ(Rect(6*n, 6*n, 10, 10)) += b.JInTJIn;
+        b.JExTJEx.copyTo(JTJ(Rect(i*6, i*6, 6, 6)));
+        b.JExTJIn.copyTo(JTJ(Rect(6*n, i*6, 10, 6)));
+        Mat(b.JExTJIn.t()).copyTo(JTJ(Rect(i*6, 6*n, 6, 10)));
 
-        //int nPoints = objectPoints.getMat(i).total();
-        //JIn.copyTo(J(Rect(6*n, i*nPoints*2, 10, nPoints*2)));
-        //JEx.copyTo(J(Rect(6*i, i*nPoints*2, 6, nPoints*2)));
-        //projError.reshape(1, 2*projError.rows).copyTo(exAll.rowRange(i*2*nPoints, (i+1)*2*nPoints));
+        JTE(Rect(0, 6*n, 1, 10)) += b.JInTE;
+        b.JExTE.copyTo(JTE(Rect(0, i*6, 1, 6)));
     }
-    //JTJ = J.t()*J;
-    //JTE = J.t()*exAll;
     std::vector<int> _idx(6*n+10, 1);
     flags2idx(flags, _idx, n);
 
@@ -934,6 +964,87 @@ void cv::omnidir::internal::computeJacobian(InputArrayOfArrays objectPoints, Inp
     JTJ_inv = Mat(JTJ+epsilon).inv();
 }
 
+bool cv::omnidir::internal::computeUpdateSchur(InputArrayOfArrays objectPoints, InputArrayOfArrays imagePoints,
+    InputArray parameters, Mat& G, int flags, double epsilon)
+{
+    CV_Assert(!objectPoints.empty() && objectPoints.type() == CV_64FC3);
+    CV_Assert(!imagePoints.empty() && imagePoints.type() == CV_64FC2);
+
+    int n = (int)objectPoints.total();
+
+    std::vector<int> _idx(6*n+10, 1);
+    flags2idx(flags, _idx, n);
+    std::vector<int> idxIn(_idx.begin() + 6*n, _idx.end());
+    int nIn = cv::countNonZero(idxIn);
+    if (nIn == 0)
+        return false;
+
+    std::vector<ViewNormalBlocks> blocks;
+    computeViewNormalBlocks(objectPoints, imagePoints, parameters.getMat(), blocks);
+
+    // JTJ is block diagonal in the extrinsic parameters, so they are eliminated view by view and only
+    // the Schur complement of the intrinsic part is solved. computeJacobian adds epsilon to every
+    // element of JTJ, that is the rank one update epsilon*1*1^T, which is applied with the
+    // Sherman-Morrison formula, so both right hand sides JTE and 1 are solved at once.
+    std::vector<Mat> JExTJIn(n), VinvRhs(n), reduced(n);
+    std::vector<uchar> valid(n, 1);
+    parallel_for_(Range(0, n), [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            Mat Vinv;
+            if (cv::invert(blocks[i].JExTJEx, Vinv, DECOMP_CHOLESKY) == 0)
+            {
+                valid[i] = 0;
+                continue;
+            }
+            subMatrix(blocks[i].JExTJIn, JExTJIn[i], idxIn, std::vector<int>(6, 1));
+            Mat rhs(6, nIn + 2, CV_64F);
+            JExTJIn[i].copyTo(rhs.colRange(0, nIn));
+            blocks[i].JExTE.copyTo(rhs.col(nIn));
+            rhs.col(nIn + 1).setTo(1);
+            VinvRhs[i] = Vinv * rhs;
+            reduced[i] = JExTJIn[i].t() * VinvRhs[i];
+        }
+    });
+    if (std::find(valid.begin(), valid.end(), 0) != valid.end())
+        return false;
+
+    Mat JInTJIn = Mat::zeros(10, 10, CV_64F), JInTE = Mat::zeros(10, 1, CV_64F);
+    for (int i = 0; i < n; i++)
+    {
+        JInTJIn += blocks[i].JInTJIn;
+        JInTE += blocks[i].JInTE;
+    }
+    Mat S, JInTEReduced, rhsIn(nIn, 2, CV_64F);
+    subMatrix(JInTJIn, S, idxIn, idxIn);
+    subMatrix(JInTE, JInTEReduced, std::vector<int>(1, 1), idxIn);
+    JInTEReduced.copyTo(rhsIn.col(0));
+    rhsIn.col(1).setTo(1);
+    for (int i = 0; i < n; i++)
+    {
+        S -= reduced[i].colRange(0, nIn);
+        rhsIn -= reduced[i].colRange(nIn, nIn + 2);
+    }
+
+    Mat xIn;
+    if (!cv::solve(S, rhsIn, xIn, DECOMP_CHOLESKY))
+        return false;
+
+    // columns of x are JTJ^-1*JTE and JTJ^-1*1, ordered like the parameters left by flags2idx
+    Mat x(6*n + nIn, 2, CV_64F);
+    for (int i = 0; i < n; i++)
+    {
+        Mat xEx = VinvRhs[i].colRange(nIn, nIn + 2) - VinvRhs[i].colRange(0, nIn) * xIn;
+        xEx.copyTo(x.rowRange(i*6, i*6 + 6));
+    }
+    xIn.copyTo(x.rowRange(6*n, 6*n + nIn));
+
+    double sumStep = cv::sum(x.col(0))[0], sumOnes = cv::sum(x.col(1))[0];
+    G = x.col(0) - x.col(1) * (epsilon * sumStep / (1 + epsilon * sumOnes));
+    return true;
+}
+
 void cv::omnidir::internal::computeJacobianStereo(InputArrayOfArrays objectPoints, InputArrayOfArrays imagePoints1, InputArrayOfArrays imagePoints2,
     InputArray parameters, Mat& JTJ_inv, Mat& JTE, int flags, double epsilon)
 {
@@ -1129,10 +1240,15 @@ double cv::omnidir::calibrate(InputArrayOfArrays patternPoints, InputArrayOfArra
         double alpha_smooth2 = 1 - std::pow(1 - alpha_smooth, (double)iter + 1.0);
         Mat JTJ_inv, JTError;
 		double epsilon = 0.01 * std::pow(0.9, (double)iter/10);
-        cv::omnidir::internal::computeJacobian(_patternPoints, _imagePoints, currentParam, JTJ_inv, JTError, flags, epsilon);
+        Mat G;
+        if (!cv::omnidir::internal::computeUpdateSchur(_patternPoints, _imagePoints, currentParam, G, flags, epsilon))
+        {
+            cv::omnidir::internal::computeJacobian(_patternPoints, _imagePoints, currentParam, JTJ_inv, JTError, flags, epsilon);
+            G = JTJ_inv * JTError;
+        }
 
         // Gauss - Newton
-        Mat G = alpha_smooth2*JTJ_inv * JTError;
+        G = alpha_smooth2 * G;
 
         omnidir::internal::fillFixed(G, flags, n);
 
@@ -1385,159 +1501,249 @@ void cv::omnidir::stereoReconstruct(InputArray image1, InputArray image2, InputA
     int numDisparities, int SADWindowSize, OutputArray disparity, OutputArray image1Rec, OutputArray image2Rec,
     const Size& newSize, InputArray Knew, OutputArray pointCloud, int pointType)
 {
-    CV_Assert(!K1.empty() && K1.size() == Size(3,3) && (K1.type() == CV_64F || K1.type() == CV_32F));
-    CV_Assert(!K2.empty() && K2.size() == Size(3,3) && (K2.type() == CV_64F || K2.type() == CV_32F));
-    CV_Assert(!D1.empty() && D1.total() == 4 && (D1.type() == CV_64F || D1.type() == CV_32F));
-    CV_Assert(!D2.empty() && D2.total() == 4 && (D2.type() == CV_64F || D2.type() == CV_32F));
-    CV_Assert(!R.empty() && (R.size() == Size(3,3) || R.total() == 3) && (R.type() == CV_64F || R.type() == CV_32F));
-    CV_Assert(!T.empty() && T.total() == 3 && (T.type() == CV_64F || T.type() == CV_32F));
-    CV_Assert(!image1.empty() && (image1.type() == CV_8U || image1.type() == CV_8UC3));
-    CV_Assert(!image2.empty() && (image2.type() == CV_8U || image2.type() == CV_8UC3));
-    CV_Assert(flag == omnidir::RECTIFY_LONGLATI || flag == omnidir::RECTIFY_PERSPECTIVE);
-
-    Mat _K1, _D1, _K2, _D2, _R, _T;
-
-    K1.getMat().convertTo(_K1, CV_64F);
-    K2.getMat().convertTo(_K2, CV_64F);
-    D1.getMat().convertTo(_D1, CV_64F);
-    D2.getMat().convertTo(_D2, CV_64F);
-    T.getMat().reshape(1, 3).convertTo(_T, CV_64F);
+    Ptr<OmniStereoReconstructor> reconstructor = OmniStereoReconstructor::create(K1, D1, xi1, K2, D2, xi2, R, T,
+        flag, numDisparities, SADWindowSize, newSize, Knew);
+    reconstructor->compute(image1, image2, disparity, image1Rec, image2Rec, pointCloud, pointType);
+}
 
-    if (R.size() == Size(3, 3))
+namespace cv { namespace omnidir {
+
+class OmniRectifierImpl CV_FINAL : public OmniRectifier
+{
+public:
+    OmniRectifierImpl(InputArray K, InputArray D, InputArray xi, int flags, InputArray Knew,
+        const Size& new_size, InputArray R) : flags_(flags), newSize_(new_size)
     {
-        R.getMat().convertTo(_R, CV_64F);
+        K.getMat().copyTo(K_);
+        D.getMat().copyTo(D_);
+        xi.getMat().copyTo(xi_);
+        Knew.getMat().copyTo(Knew_);
+        R.getMat().copyTo(R_);
+        if (!newSize_.empty())
+            computeMaps(newSize_);
     }
-    else if (R.total() == 3)
+
+    void apply(InputArray distorted, OutputArray undistorted) CV_OVERRIDE
     {
-        Rodrigues(R.getMat(), _R);
-        _R.convertTo(_R, CV_64F);
+        if (map1_.empty() || (newSize_.empty() && map1_.size() != distorted.size()))
+            computeMaps(distorted.size());
+        cv::remap(distorted, undistorted, map1_, map2_, INTER_LINEAR, BORDER_CONSTANT);
     }
-    // stereo rectify so that stereo matching can be applied in one line
-    Mat R1, R2;
-    stereoRectify(_R, _T, R1, R2);
-    Mat undis1, undis2;
-    Matx33d _Knew = Matx33d(_K1);
-    if (!Knew.empty())
+
+    void getMaps(OutputArray map1, OutputArray map2) const CV_OVERRIDE
     {
-        Knew.getMat().convertTo(_Knew, CV_64F);
+        map1_.copyTo(map1);
+        map2_.copyTo(map2);
     }
 
-    undistortImage(image1.getMat(), undis1, _K1, _D1, xi1, flag, _Knew, newSize, R1);
-    undistortImage(image2.getMat(), undis2, _K2, _D2, xi2, flag, _Knew, newSize, R2);
+private:
+    void computeMaps(const Size& size)
+    {
+        omnidir::initUndistortRectifyMap(K_, D_, xi_, R_, Knew_, size, CV_16SC2, map1_, map2_, flags_);
+    }
 
-    undis1.copyTo(image1Rec);
-    undis2.copyTo(image2Rec);
+    Mat K_, D_, xi_, Knew_, R_;
+    int flags_;
+    Size newSize_;
+    Mat map1_, map2_;
+};
 
-    // stereo matching by semi-global
-    Mat _disMap;
-    int channel = image1.channels();
+class OmniStereoReconstructorImpl CV_FINAL : public OmniStereoReconstructor
+{
+public:
+    OmniStereoReconstructorImpl(InputArray K1, InputArray D1, InputArray xi1, InputArray K2, InputArray D2,
+        InputArray xi2, InputArray R, InputArray T, int flag, int numDisparities, int SADWindowSize,
+        const Size& newSize, InputArray Knew)
+        : flag_(flag), numDisparities_(numDisparities), SADWindowSize_(SADWindowSize), sgbmChannels_(0)
+    {
+        CV_Assert(!K1.empty() && K1.size() == Size(3,3) && (K1.type() == CV_64F || K1.type() == CV_32F));
+        CV_Assert(!K2.empty() && K2.size() == Size(3,3) && (K2.type() == CV_64F || K2.type() == CV_32F));
+        CV_Assert(!D1.empty() && D1.total() == 4 && (D1.type() == CV_64F || D1.type() == CV_32F));
+        CV_Assert(!D2.empty() && D2.total() == 4 && (D2.type() == CV_64F || D2.type() == CV_32F));
+        CV_Assert(!R.empty() && (R.size() == Size(3,3) || R.total() == 3) && (R.type() == CV_64F || R.type() == CV_32F));
+        CV_Assert(!T.empty() && T.total() == 3 && (T.type() == CV_64F || T.type() == CV_32F));
+        CV_Assert(flag == omnidir::RECTIFY_LONGLATI || flag == omnidir::RECTIFY_PERSPECTIVE);
+
+        Mat _K1, _D1, _K2, _D2, _R, _T;
+
+        K1.getMat().convertTo(_K1, CV_64F);
+        K2.getMat().convertTo(_K2, CV_64F);
+        D1.getMat().convertTo(_D1, CV_64F);
+        D2.getMat().convertTo(_D2, CV_64F);
+        T.getMat().reshape(1, 3).convertTo(_T, CV_64F);
+
+        if (R.size() == Size(3, 3))
+        {
+            R.getMat().convertTo(_R, CV_64F);
+        }
+        else if (R.total() == 3)
+        {
+            Rodrigues(R.getMat(), _R);
+            _R.convertTo(_R, CV_64F);
+        }
+        // stereo rectify so that stereo matching can be applied in one line
+        Mat R1, R2;
+        stereoRectify(_R, _T, R1, R2);
+        Knew_ = Matx33d(_K1);
+        if (!Knew.empty())
+        {
+            Knew.getMat().convertTo(Knew_, CV_64F);
+        }
+        baseline_ = cv::norm(_T);
 
-    //cv::StereoSGBM matching(0, numDisparities, SADWindowSize, 8*channel*SADWindowSize*SADWindowSize, 32*channel*SADWindowSize*SADWindowSize);
-    //matching(undis1, undis2, _depthMap);
-	Ptr<StereoSGBM> sgbm = StereoSGBM::create(0, numDisparities, SADWindowSize, 8 * channel*SADWindowSize*SADWindowSize, 32 * channel*SADWindowSize*SADWindowSize);
+        rectifier1_ = OmniRectifier::create(_K1, _D1, xi1, flag, Knew_, newSize, R1);
+        rectifier2_ = OmniRectifier::create(_K2, _D2, xi2, flag, Knew_, newSize, R2);
+    }
 
-	sgbm->compute(undis1, undis2, _disMap);
+    void compute(InputArray image1, InputArray image2, OutputArray disparity, OutputArray image1Rec,
+        OutputArray image2Rec, OutputArray pointCloud, int pointType) CV_OVERRIDE
+    {
+        CV_Assert(!image1.empty() && (image1.type() == CV_8U || image1.type() == CV_8UC3));
+        CV_Assert(!image2.empty() && (image2.type() == CV_8U || image2.type() == CV_8UC3));
 
-    // some regions of image1 is black, the corresponding regions of disparity map is also invalid.
-    Mat realDis;
-	_disMap.convertTo(_disMap, CV_32F);
-    Mat(_disMap/16.0f).convertTo(realDis, CV_32F);
+        const int flag = flag_;
+        const Matx33d& _Knew = Knew_;
+        Mat undis1, undis2;
+        rectifier1_->apply(image1, undis1);
+        rectifier2_->apply(image2, undis2);
 
-    Mat grayImg, binaryImg, idx;
-    if (undis1.channels() == 3)
-    {
-        cvtColor(undis1, grayImg, COLOR_RGB2GRAY);
-    }
-    else
-    {
-        grayImg = undis1;
-    }
+        undis1.copyTo(image1Rec);
+        undis2.copyTo(image2Rec);
 
-    binaryImg = (grayImg <= 0);
-    findNonZero(binaryImg, idx);
-    for (int i = 0; i < (int)idx.total(); ++i)
-    {
-        Vec2i _idx = idx.at<Vec2i>(i);
-        realDis.at<float>(_idx[1], _idx[0]) = 0.0f;
-    }
+        // stereo matching by semi-global
+        Mat _disMap;
+        int channel = image1.channels();
 
-    disparity.create(realDis.size(), realDis.type());
-    realDis.copyTo(disparity.getMat());
+        // the penalties depend on the number of channels
+        if (!sgbm_ || sgbmChannels_ != channel)
+        {
+            sgbm_ = StereoSGBM::create(0, numDisparities_, SADWindowSize_, 8 * channel*SADWindowSize_*SADWindowSize_, 32 * channel*SADWindowSize_*SADWindowSize_);
+            sgbmChannels_ = channel;
+        }
+        sgbm_->compute(undis1, undis2, _disMap);
 
-    std::vector<Vec3f> _pointCloud;
-    std::vector<Vec6f> _pointCloudColor;
-    double baseline = cv::norm(T);
-    double f = _Knew(0, 0);
-    Matx33d K_inv = _Knew.inv();
+        // some regions of image1 is black, the corresponding regions of disparity map is also invalid.
+        Mat realDis;
+        _disMap.convertTo(_disMap, CV_32F);
+        Mat(_disMap/16.0f).convertTo(realDis, CV_32F);
 
-    std::vector<Mat> rgb;
-    if (undis1.channels() == 3)
-    {
-        split(undis1, rgb);
-    }
+        Mat grayImg, binaryImg;
+        if (undis1.channels() == 3)
+        {
+            cvtColor(undis1, grayImg, COLOR_RGB2GRAY);
+        }
+        else
+        {
+            grayImg = undis1;
+        }
 
-    if (pointCloud.needed())
-    {
-        for (int i = 0; i < newSize.width; ++i)
+        binaryImg = (grayImg <= 0);
+        realDis.setTo(0.0f, binaryImg);
+
+        disparity.create(realDis.size(), realDis.type());
+        realDis.copyTo(disparity.getMat());
+
+        std::vector<Vec3f> _pointCloud;
+        std::vector<Vec6f> _pointCloudColor;
+        double baseline = baseline_;
+        double f = _Knew(0, 0);
+        Matx33d K_inv = _Knew.inv();
+
+        std::vector<Mat> rgb;
+        if (undis1.channels() == 3)
+        {
+            split(undis1, rgb);
+        }
+
+        if (pointCloud.needed())
         {
-            for(int j = 0; j < newSize.height; ++j)
+            for (int i = 0; i < realDis.cols; ++i)
             {
-                Vec3f point;
-                Vec6f pointColor;
-                if (realDis.at<float>(j, i) > 15)
+                for(int j = 0; j < realDis.rows; ++j)
                 {
-                    float depth = float(baseline * f /realDis.at<float>(j, i));
-                    // for RECTIFY_PERSPECTIVE, (x,y) are image plane points,
-                    // for RECTIFY_LONGLATI, (x,y) are (theta, phi) angles
-                    float x = float(K_inv(0,0) * i + K_inv(0,1) * j + K_inv(0,2));
-                    float y = float(K_inv(1,0) * i + K_inv(1,1) * j + K_inv(1,2));
-                    if (flag == omnidir::RECTIFY_LONGLATI)
+                    Vec3f point;
+                    Vec6f pointColor;
+                    if (realDis.at<float>(j, i) > 15)
                     {
-                        point = Vec3f((float)-std::cos(x), (float)(-std::sin(x)*std::cos(y)), (float)(std::sin(x)*std::sin(y))) * depth;
-                    }
-                    else if(flag == omnidir::RECTIFY_PERSPECTIVE)
-                    {
-                        point = Vec3f(float(x), float(y), 1.0f) * depth;
-                    }
-                    if (pointType == XYZ)
-                    {
-                        _pointCloud.push_back(point);
-                    }
-                    else if (pointType == XYZRGB)
-                    {
-                        pointColor[0] = point[0];
-                        pointColor[1] = point[1];
-                        pointColor[2] = point[2];
-
-                        if (undis1.channels() == 1)
+                        float depth = float(baseline * f /realDis.at<float>(j, i));
+                        // for RECTIFY_PERSPECTIVE, (x,y) are image plane points,
+                        // for RECTIFY_LONGLATI, (x,y) are (theta, phi) angles
+                        float x = float(K_inv(0,0) * i + K_inv(0,1) * j + K_inv(0,2));
+                        float y = float(K_inv(1,0) * i + K_inv(1,1) * j + K_inv(1,2));
+                        if (flag == omnidir::RECTIFY_LONGLATI)
+                        {
+                            point = Vec3f((float)-std::cos(x), (float)(-std::sin(x)*std::cos(y)), (float)(std::sin(x)*std::sin(y))) * depth;
+                        }
+                        else if(flag == omnidir::RECTIFY_PERSPECTIVE)
+                        {
+                            point = Vec3f(float(x), float(y), 1.0f) * depth;
+                        }
+                        if (pointType == XYZ)
                         {
-                            pointColor[3] = float(undis1.at<uchar>(j, i));
-                            pointColor[4] = pointColor[3];
-                            pointColor[5] = pointColor[3];
+                            _pointCloud.push_back(point);
                         }
-                        else if (undis1.channels() == 3)
+                        else if (pointType == XYZRGB)
                         {
-                            pointColor[3] = rgb[0].at<uchar>(j, i);
-                            pointColor[4] = rgb[1].at<uchar>(j, i);
-                            pointColor[5] = rgb[2].at<uchar>(j, i);
+                            pointColor[0] = point[0];
+                            pointColor[1] = point[1];
+                            pointColor[2] = point[2];
+
+                            if (undis1.channels() == 1)
+                            {
+                                pointColor[3] = float(undis1.at<uchar>(j, i));
+                                pointColor[4] = pointColor[3];
+                                pointColor[5] = pointColor[3];
+                            }
+                            else if (undis1.channels() == 3)
+                            {
+                                pointColor[3] = rgb[0].at<uchar>(j, i);
+                                pointColor[4] = rgb[1].at<uchar>(j, i);
+                                pointColor[5] = rgb[2].at<uchar>(j, i);
+                            }
+                            _pointCloudColor.push_back(pointColor);
                         }
-                        _pointCloudColor.push_back(pointColor);
                     }
                 }
             }
-        }
 
-        if (pointType == XYZ)
-        {
-            Mat(_pointCloud).convertTo(pointCloud, CV_MAKE_TYPE(CV_32F, 3));
-        }
-        else if (pointType == XYZRGB)
-        {
-            Mat(_pointCloudColor).convertTo(pointCloud, CV_MAKE_TYPE(CV_32F, 6));
+            if (pointType == XYZ)
+            {
+                Mat(_pointCloud).convertTo(pointCloud, CV_MAKE_TYPE(CV_32F, 3));
+            }
+            else if (pointType == XYZRGB)
+            {
+                Mat(_pointCloudColor).convertTo(pointCloud, CV_MAKE_TYPE(CV_32F, 6));
+            }
         }
     }
+
+private:
+    int flag_;
+    int numDisparities_;
+    int SADWindowSize_;
+    Matx33d Knew_;
+    double baseline_;
+    Ptr<OmniRectifier> rectifier1_, rectifier2_;
+    Ptr<StereoSGBM> sgbm_;
+    int sgbmChannels_;
+};
+
+Ptr<OmniRectifier> OmniRectifier::create(InputArray K, InputArray D, InputArray xi, int flags,
+    InputArray Knew, const Size& new_size, InputArray R)
+{
+    return makePtr<OmniRectifierImpl>(K, D, xi, flags, Knew, new_size, R);
 }
 
+Ptr<OmniStereoReconstructor> OmniStereoReconstructor::create(InputArray K1, InputArray D1, InputArray xi1,
+    InputArray K2, InputArray D2, InputArray xi2, InputArray R, InputArray T, int flag, int numDisparities,
+    int SADWindowSize, const Size& newSize, InputArray Knew)
+{
+    return makePtr<OmniStereoReconstructorImpl>(K1, D1, xi1, K2, D2, xi2, R, T, flag, numDisparities,
+        SADWindowSize, newSize, Knew);
+}
+
+}} // namespace cv::omnidir
+
 void cv::omnidir::internal::encodeParameters(InputArray K, InputArrayOfArrays omAll, InputArrayOfArrays tAll, InputArray distoaration, double xi, OutputArray parameters)
 {
     CV_Assert(K.type() == CV_64F && K.size() == Size(3,3));
@@ -56,18 +56,20 @@ the use of this software, even if advised of the possibility of such damage.
 #include <string.h>
 #include <stdlib.h>
 #include <dirent.h>
-#define CPU_ONLY
-
-#include <caffe/blob.hpp>
-#include <caffe/common.hpp>
-#include <caffe/net.hpp>
-#include <caffe/proto/caffe.pb.h>
-#include <caffe/util/io.hpp>
 
+#include "opencv2/opencv_modules.hpp"
 #include "opencv2/viz/vizcore.hpp"
 #include "opencv2/highgui.hpp"
 #include "opencv2/highgui/highgui_c.h"
 #include "opencv2/imgproc.hpp"
+#ifdef HAVE_OPENCV_DNN
+#include "opencv2/dnn.hpp"
+#endif
+
+namespace caffe
+{
+    template <typename Dtype> class Net;
+}
 
 /** @defgroup cnn_3dobj 3D object recognition and pose estimation API
 
@@ -210,6 +212,13 @@ namespace cnn_3dobj
     {
         private:
         caffe::Net<float>* convnet;
+#ifdef HAVE_OPENCV_DNN
+        cv::dnn::Net dnnnet;
+#endif
+        bool use_dnn;
+        int dnn_backend;
+        int dnn_target;
+        int batch_size;
         cv::Size input_geometry;
         int num_channels;
         bool net_set;
@@ -223,11 +232,17 @@ namespace cnn_3dobj
          */
         void setMean(const String& mean_file);
 
-        /** @brief Wrap the input layer of the network in separate cv::Mat objects(one per channel).
+        /** @brief Wrap one image of the input batch in separate cv::Mat objects(one per channel).
          This way we save one memcpy operation and we don't need to rely on cudaMemcpy2D.
          The last preprocessing operation will write the separate channels directly to the input layer.
+        @param input_data First element of the image in the input batch.
+        @param input_channels Output channels.
+         */
+        void wrapInput(float* input_data, std::vector<cv::Mat>* input_channels);
+
+        /** @brief Run the net on a batch of images and write their features to consecutive rows of feature.
          */
-        void wrapInput(std::vector<cv::Mat>* input_channels);
+        void extractBatch(const std::vector<cv::Mat>& imgs, cv::Mat& feature, const String& feature_blob);
 
         /** @brief Convert the input image to the input image format of the network.
          */
@@ -260,6 +275,25 @@ namespace cnn_3dobj
          */
         void setDeviceId(const int& device_id);
 
+        /** @brief Set the number of images passed through the network at once by extract(), 16 by default.
+         Larger batches are faster on GPU, at the cost of memory.
+        @param size Number of images of a batch.
+         */
+        void setBatchSize(int size);
+
+        /** @brief Get the number of images passed through the network at once by extract().
+         */
+        int getBatchSize() const;
+
+#ifdef HAVE_OPENCV_DNN
+        /** @brief Run the network with the cv::dnn module instead of Caffe, which is then not needed at runtime.
+         This is the only choice if the module is built without Caffe. Must be called before loadNet().
+        @param backend One of cv::dnn::Backend.
+        @param target One of cv::dnn::Target.
+         */
+        void setDnnBackend(int backend = cv::dnn::DNN_BACKEND_DEFAULT, int target = cv::dnn::DNN_TARGET_CPU);
+#endif
+
         /** @brief Initiate a classification structure, the net work parameter is stored in model_file,
          the network structure is stored in trained_file, you can decide whether to use mean images or not.
         @param model_file Path of caffemodel which including all parameters in CNN.
@@ -270,6 +304,8 @@ namespace cnn_3dobj
 
         /** @brief Extract features from a single image or from a vector of images.
          If loadNet was not called before, this method invocation will fail.
+         The images of a vector are preprocessed in parallel and passed through the network
+         in batches of getBatchSize() images.
         @param inputimg Input images.
         @param feature Output features.
         @param feature_blob Layer which the feature is extracted from.
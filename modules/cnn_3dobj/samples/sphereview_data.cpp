@@ -259,7 +259,32 @@ int main(int argc, char *argv[])
             name_bkg.at(i) = bakgrdir + name_bkg.at(i);
         }
     }
-    /* Images will be saved as .png files. */
+    /* Images will be saved as .png files. Rendering is sequential, but the encoding and
+     * writing of the rendered views is done in parallel for batches of views. */
+    const int write_batch = 64;
+    std::vector<String> batch_files;
+    std::vector<Mat> batch_views;
+    std::vector<int> batch_poses;
+    auto writeViews = [&]()
+    {
+        parallel_for_(Range(0, static_cast<int>(batch_views.size())), [&](const Range& range)
+        {
+            for (int i = range.start; i < range.end; i++)
+                imwrite(batch_files[i], batch_views[i]);
+        });
+        if (binary_out)
+        {
+            /* Write images into binary files for further using in CNN training, in the order of the views. */
+            for (size_t i = 0; i < batch_files.size(); i++)
+            {
+                int pose = batch_poses[i];
+                ViewSphere.writeBinaryfile(batch_files[i], binaryPath, headerPath,static_cast<int>(campos.size())*num_class, label_class, static_cast<int>(campos.at(pose).x*100), static_cast<int>(campos.at(pose).y*100), static_cast<int>(campos.at(pose).z*100), rgb_use);
+            }
+        }
+        batch_files.clear();
+        batch_views.clear();
+        batch_poses.clear();
+    };
     size_t cnt_img;
     srand((int)time(0));
     do
@@ -316,15 +341,15 @@ int main(int argc, char *argv[])
             /* Set the viewer pose to that of camera. */
             if (camera_pov)
                 myWindow.setViewerPose(cam_pose);
-            /* Save screen shot as images. */
-            myWindow.saveScreenshot(filename);
-            if (binary_out)
-            {
-            /* Write images into binary files for further using in CNN training. */
-                ViewSphere.writeBinaryfile(filename, binaryPath, headerPath,static_cast<int>(campos.size())*num_class, label_class, static_cast<int>(campos.at(pose).x*100), static_cast<int>(campos.at(pose).y*100), static_cast<int>(campos.at(pose).z*100), rgb_use);
-            }
+            /* Render the view, it is saved as image with the next batch. */
+            batch_files.push_back(filename);
+            batch_views.push_back(myWindow.getScreenshot());
+            batch_poses.push_back(pose);
+            if (static_cast<int>(batch_views.size()) == write_batch)
+                writeViews();
             cnt_img++;
         }
+        writeViews();
     } while (cnt_img != campos.size());
     imglabel.close();
     return 1;
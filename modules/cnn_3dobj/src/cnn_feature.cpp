@@ -1,25 +1,66 @@
 #include "precomp.hpp"
+#ifdef HAVE_CAFFE
 using namespace caffe;
+#endif
 
 namespace cv
 {
 namespace cnn_3dobj
 {
+    /* Read the input dimensions (num, channels, height, width) declared by a deploy prototxt,
+     * either as input_dim fields or as the dim fields of an input_shape. */
+    static std::vector<int> readInputDims(const String& model_file)
+    {
+        std::ifstream proto(model_file.c_str());
+        if (!proto.is_open())
+            CV_Error(Error::StsError, "Could not open the network structure " + model_file);
+        std::vector<int> dims;
+        std::string token;
+        while (dims.size() < 4 && proto >> token)
+        {
+            if (token == "layer" || token == "layers")
+                break;
+            if (token == "input_dim:" || token == "dim:")
+            {
+                int dim;
+                if (proto >> dim)
+                    dims.push_back(dim);
+            }
+        }
+        if (dims.size() != 4)
+            CV_Error(Error::StsError, "The network structure must declare the 4 dimensions of its input: " + model_file);
+        return dims;
+    }
+
     descriptorExtractor::descriptorExtractor(const String& device_type, int device_id)
     {
+        convnet = NULL;
+#ifdef HAVE_CAFFE
+        use_dnn = false;
+#else
+        use_dnn = true;
+#endif
+        dnn_backend = 0;
+        dnn_target = 0;
+        batch_size = 16;
         net_ready = 0;
+        deviceId = device_id;
         if (strcmp(device_type.c_str(), "CPU") == 0 || strcmp(device_type.c_str(), "GPU") == 0)
         {
             if (strcmp(device_type.c_str(), "CPU") == 0)
             {
+#ifdef HAVE_CAFFE
                 caffe::Caffe::set_mode(caffe::Caffe::CPU);
+#endif
                 deviceType = "CPU";
                 std::cout << "Using CPU" << std::endl;
             }
             else
             {
+#ifdef HAVE_CAFFE
                 caffe::Caffe::set_mode(caffe::Caffe::GPU);
                 caffe::Caffe::SetDevice(device_id);
+#endif
                 deviceType = "GPU";
                 std::cout << "Using GPU" << std::endl;
                 std::cout << "Using Device_id=" << device_id << std::endl;
@@ -53,13 +94,17 @@ namespace cnn_3dobj
         {
             if (strcmp(device_type.c_str(), "CPU") == 0)
             {
+#ifdef HAVE_CAFFE
                 caffe::Caffe::set_mode(caffe::Caffe::CPU);
+#endif
                 deviceType = "CPU";
                 std::cout << "Using CPU" << std::endl;
             }
             else
             {
+#ifdef HAVE_CAFFE
                 caffe::Caffe::set_mode(caffe::Caffe::GPU);
+#endif
                 deviceType = "GPU";
                 std::cout << "Using GPU" << std::endl;
             }
@@ -74,7 +119,9 @@ namespace cnn_3dobj
     {
         if (strcmp(deviceType.c_str(), "GPU") == 0)
         {
+#ifdef HAVE_CAFFE
             caffe::Caffe::SetDevice(device_id);
+#endif
             deviceId = device_id;
             std::cout << "Using GPU with Device ID = " << device_id << std::endl;
         }
@@ -84,22 +131,62 @@ namespace cnn_3dobj
         }
     };
 
+    void descriptorExtractor::setBatchSize(int size)
+    {
+        CV_Assert(size > 0);
+        batch_size = size;
+    };
+
+    int descriptorExtractor::getBatchSize() const
+    {
+        return batch_size;
+    };
+
+#ifdef HAVE_OPENCV_DNN
+    void descriptorExtractor::setDnnBackend(int backend, int target)
+    {
+        use_dnn = true;
+        dnn_backend = backend;
+        dnn_target = target;
+    };
+#endif
+
     void descriptorExtractor::loadNet(const String& model_file, const String& trained_file, const String& mean_file)
     {
         if (net_set)
         {
-            /* Load the network. */
-            convnet = new Net<float>(model_file, TEST);
-            convnet->CopyTrainedLayersFrom(trained_file);
-            if (convnet->num_inputs() != 1)
-                std::cout << "Network should have exactly one input." << std::endl;
-            if (convnet->num_outputs() != 1)
-                std::cout << "Network should have exactly one output." << std::endl;
-            Blob<float>* input_layer = convnet->input_blobs()[0];
-            num_channels = input_layer->channels();
+            if (use_dnn)
+            {
+#ifdef HAVE_OPENCV_DNN
+                std::vector<int> dims = readInputDims(model_file);
+                num_channels = dims[1];
+                input_geometry = cv::Size(dims[3], dims[2]);
+                dnnnet = dnn::readNetFromCaffe(model_file, trained_file);
+                dnnnet.setPreferableBackend(dnn_backend);
+                dnnnet.setPreferableTarget(dnn_target);
+#else
+                CV_Error(Error::StsNotImplemented, "The cnn_3dobj module is built without the dnn module");
+#endif
+            }
+            else
+            {
+#ifdef HAVE_CAFFE
+                /* Load the network. */
+                convnet = new Net<float>(model_file, TEST);
+                convnet->CopyTrainedLayersFrom(trained_file);
+                if (convnet->num_inputs() != 1)
+                    std::cout << "Network should have exactly one input." << std::endl;
+                if (convnet->num_outputs() != 1)
+                    std::cout << "Network should have exactly one output." << std::endl;
+                Blob<float>* input_layer = convnet->input_blobs()[0];
+                num_channels = input_layer->channels();
+                input_geometry = cv::Size(input_layer->width(), input_layer->height());
+#else
+                CV_Error(Error::StsNotImplemented, "The cnn_3dobj module is built without Caffe, use setDnnBackend");
+#endif
+            }
             if (num_channels != 3 && num_channels != 1)
                 std::cout << "Input layer should have 1 or 3 channels." << std::endl;
-            input_geometry = cv::Size(input_layer->width(), input_layer->height());
             /* Load the binaryproto mean file. */
             if (!mean_file.empty())
             {
@@ -120,6 +207,7 @@ namespace cnn_3dobj
     /* Load the mean file in binaryproto format. */
     void descriptorExtractor::setMean(const String& mean_file)
     {
+#ifdef HAVE_CAFFE
         BlobProto blob_proto;
         ReadProtoFromBinaryFileOrDie(mean_file.c_str(), &blob_proto);
         /* Convert from BlobProto to Blob<float> */
@@ -144,77 +232,105 @@ namespace cnn_3dobj
          * filled with this value. */
         cv::Scalar channel_mean = cv::mean(mean);
         mean_ = cv::Mat(input_geometry, mean.type(), channel_mean);
+#else
+        CV_UNUSED(mean_file);
+        CV_Error(Error::StsNotImplemented, "Reading binaryproto mean files requires Caffe");
+#endif
     };
 
     void descriptorExtractor::extract(InputArrayOfArrays inputimg, OutputArray feature, String feature_blob)
     {
         if (net_ready)
         {
-            Blob<float>* input_layer = convnet->input_blobs()[0];
-            input_layer->Reshape(1, num_channels,
-            input_geometry.height, input_geometry.width);
-            /* Forward dimension change to all layers. */
-            convnet->Reshape();
-            std::vector<cv::Mat> input_channels;
-            wrapInput(&input_channels);
-            if (inputimg.kind() == 65536)
-            {/* this is a Mat */
-                Mat img = inputimg.getMat();
-                preprocess(img, &input_channels);
-                convnet->ForwardPrefilled();
-                /* Copy the output layer to a std::vector */
-                Blob<float>* output_layer = convnet->blob_by_name(feature_blob).get();
-                const float* begin = output_layer->cpu_data();
-                const float* end = begin + output_layer->channels();
-                std::vector<float> featureVec = std::vector<float>(begin, end);
-                cv::Mat feature_mat = cv::Mat(featureVec, true).t();
-                feature_mat.copyTo(feature);
-            }
+            std::vector<Mat> img;
+            if (inputimg.kind() == _InputArray::MAT)
+                img.push_back(inputimg.getMat());
             else
-            {/* This is a vector<Mat> */
-                vector<Mat> img;
                 inputimg.getMatVector(img);
-                Mat feature_vector;
-                for (unsigned int i = 0; i < img.size(); ++i)
-                {
-                    preprocess(img[i], &input_channels);
-                    convnet->ForwardPrefilled();
-                    /* Copy the output layer to a std::vector */
-                    Blob<float>* output_layer = convnet->blob_by_name(feature_blob).get();
-                    const float* begin = output_layer->cpu_data();
-                    const float* end = begin + output_layer->channels();
-                    std::vector<float> featureVec = std::vector<float>(begin, end);
-                    if (i == 0)
-                    {
-                        feature_vector = cv::Mat(featureVec, true).t();
-                        int dim_feature = feature_vector.cols;
-                        feature_vector.resize(img.size(), dim_feature);
-                    }
-                    feature_vector.row(i) = cv::Mat(featureVec, true).t();
-                }
-                feature_vector.copyTo(feature);
+            Mat feature_vector;
+            for (size_t first = 0; first < img.size(); first += batch_size)
+            {
+                size_t last = std::min(img.size(), first + (size_t)batch_size);
+                std::vector<Mat> batch(img.begin() + first, img.begin() + last);
+                Mat batch_feature;
+                extractBatch(batch, batch_feature, feature_blob);
+                if (feature_vector.empty())
+                    feature_vector.create((int)img.size(), batch_feature.cols, CV_32F);
+                batch_feature.copyTo(feature_vector.rowRange((int)first, (int)last));
             }
+            feature_vector.copyTo(feature);
         }
         else
           std::cout << "Device must be set properly using constructor and the net must be set in advance using loadNet.";
     };
 
-    /* Wrap the input layer of the network in separate cv::Mat objects
+    void descriptorExtractor::extractBatch(const std::vector<cv::Mat>& imgs, cv::Mat& feature, const String& feature_blob)
+    {
+        const int num = (int)imgs.size();
+        const size_t image_size = (size_t)num_channels * input_geometry.area();
+        float* input_data = NULL;
+        Mat dnn_input;
+        if (use_dnn)
+        {
+            int dims[] = { num, num_channels, input_geometry.height, input_geometry.width };
+            dnn_input.create(4, dims, CV_32F);
+            input_data = dnn_input.ptr<float>();
+        }
+        else
+        {
+#ifdef HAVE_CAFFE
+            Blob<float>* input_layer = convnet->input_blobs()[0];
+            if (input_layer->num() != num)
+            {
+                input_layer->Reshape(num, num_channels,
+                input_geometry.height, input_geometry.width);
+                /* Forward dimension change to all layers. */
+                convnet->Reshape();
+            }
+            input_data = input_layer->mutable_cpu_data();
+#endif
+        }
+        /* Every image writes its own part of the input batch. */
+        parallel_for_(Range(0, num), [&](const Range& range)
+        {
+            for (int i = range.start; i < range.end; ++i)
+            {
+                std::vector<cv::Mat> input_channels;
+                wrapInput(input_data + i * image_size, &input_channels);
+                preprocess(imgs[i], &input_channels);
+            }
+        });
+        if (use_dnn)
+        {
+#ifdef HAVE_OPENCV_DNN
+            dnnnet.setInput(dnn_input);
+            Mat output = dnnnet.forward(feature_blob);
+            output.reshape(1, num).copyTo(feature);
+#endif
+        }
+        else
+        {
+#ifdef HAVE_CAFFE
+            convnet->ForwardPrefilled();
+            /* Copy the output layer, one row per image. */
+            Blob<float>* output_layer = convnet->blob_by_name(feature_blob).get();
+            Mat(num, output_layer->count() / num, CV_32F, (void*)output_layer->cpu_data()).copyTo(feature);
+#endif
+        }
+    };
+
+    /* Wrap one image of the input batch in separate cv::Mat objects
      * (one per channel). This way we save one memcpy operation and we
      * don't need to rely on cudaMemcpy2D. The last preprocessing
      * operation will write the separate channels directly to the input
      * layer. */
-    void descriptorExtractor::wrapInput(std::vector<cv::Mat>* input_channels)
+    void descriptorExtractor::wrapInput(float* input_data, std::vector<cv::Mat>* input_channels)
     {
-        Blob<float>* input_layer = convnet->input_blobs()[0];
-        int width = input_layer->width();
-        int height = input_layer->height();
-        float* input_data = input_layer->mutable_cpu_data();
-        for (int i = 0; i < input_layer->channels(); ++i)
+        for (int i = 0; i < num_channels; ++i)
         {
-            cv::Mat channel(height, width, CV_32FC1, input_data);
+            cv::Mat channel(input_geometry.height, input_geometry.width, CV_32FC1, input_data);
             input_channels->push_back(channel);
-            input_data += width * height;
+            input_data += input_geometry.area();
         }
     };
 
@@ -248,9 +364,9 @@ namespace cnn_3dobj
         /* This operation will write the separate BGR planes directly to the
          * input layer of the network because it is wrapped by the cv::Mat
          * objects in input_channels. */
+        const uchar* input_data = input_channels->at(0).data;
         cv::split(sample_normalized, *input_channels);
-        if (reinterpret_cast<float*>(input_channels->at(0).data)
-      != convnet->input_blobs()[0]->cpu_data())
+        if (input_channels->at(0).data != input_data)
             std::cout << "Input channels are not wrapping the input layer of the network." << std::endl;
     };
 } /* namespace cnn_3dobj */
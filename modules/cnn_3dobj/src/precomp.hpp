@@ -43,5 +43,16 @@ the use of this software, even if advised of the possibility of such damage.
 #define __OPENCV_CNN_3DOBJ_PRECOMP_HPP__
 
 #include <opencv2/cnn_3dobj.hpp>
+#include <opencv2/core/utility.hpp>
+
+#ifdef HAVE_CAFFE
+#define CPU_ONLY
+
+#include <caffe/blob.hpp>
+#include <caffe/common.hpp>
+#include <caffe/net.hpp>
+#include <caffe/proto/caffe.pb.h>
+#include <caffe/util/io.hpp>
+#endif
 
 #endif
@@ -63,4 +63,52 @@ void CV_CNN_Feature_Test::run(int)
 
 TEST(CNN_FEATURE, accuracy) { CV_CNN_Feature_Test test; test.safe_run(); }
 
+static void checkBatchedExtraction(cv::cnn_3dobj::descriptorExtractor& descriptor)
+{
+    String caffemodel = cvtest::findDataFile("contrib/cnn_3dobj/3d_triplet_iter_30000.caffemodel");
+    String network_forIMG = cvtest::findDataFile("contrib/cnn_3dobj/3d_triplet_testIMG.prototxt");
+    cv::Mat img = cv::imread(cvtest::findDataFile("contrib/cnn_3dobj/4_78.png"), -1);
+    ASSERT_FALSE(img.empty());
+    descriptor.loadNet(network_forIMG, caffemodel);
+
+    cv::Mat feature_single;
+    descriptor.extract(img, feature_single, "feat");
+    Mat feature_reference = (Mat_<float>(1,3) << -312.4805, 8.4768486, -224.98953);
+    EXPECT_LE(cvtest::norm(feature_single, feature_reference, NORM_L1), 5);
+
+    // 5 images in batches of 2, the last batch is smaller
+    std::vector<cv::Mat> imgs;
+    for (int i = 0; i < 5; i++)
+    {
+        cv::Mat flipped;
+        cv::flip(img, flipped, i % 2);
+        imgs.push_back(i % 2 ? flipped : img);
+    }
+    descriptor.setBatchSize(2);
+    cv::Mat features;
+    descriptor.extract(imgs, features, "feat");
+    ASSERT_EQ(features.rows, 5);
+    for (int i = 0; i < 5; i++)
+    {
+        cv::Mat expected;
+        descriptor.extract(imgs[i], expected, "feat");
+        EXPECT_LE(cvtest::norm(features.row(i), expected, NORM_L1), 1e-3) << "image " << i;
+    }
+}
+
+TEST(CNN_FEATURE, batches)
+{
+    cv::cnn_3dobj::descriptorExtractor descriptor("CPU");
+    checkBatchedExtraction(descriptor);
+}
+
+#ifdef HAVE_OPENCV_DNN
+TEST(CNN_FEATURE, dnn_backend)
+{
+    cv::cnn_3dobj::descriptorExtractor descriptor("CPU");
+    descriptor.setDnnBackend();
+    checkBatchedExtraction(descriptor);
+}
+#endif
+
 }} // namespace
@@ -457,6 +457,68 @@ CV_EXPORTS_W void cartToPolar(InputArray x, InputArray y, OutputArray magnitude,
  */
 CV_EXPORTS_W void polarToCart(InputArray magnitude, InputArray angle, OutputArray x, OutputArray y, bool angleInDegrees = false, Stream& stream = Stream::Null());
 
+/** @brief Chain of per-element operations with scalars executed by a single kernel.
+
+Calling cuda::add, cuda::multiply, cuda::min, cuda::max and GpuMat::convertTo one after another reads and writes the
+whole image for every call. The chain applies all of its operations to each element in registers, so the image is read
+and written once. The operations are applied in the order they were added, in single precision floating point, and the
+result is saturated to the destination depth at the end only.
+
+@code
+    Ptr<cuda::ElementwiseChain> chain = cuda::createElementwiseChain();
+    chain->add(Scalar::all(-mean));        // normalize
+    chain->multiply(Scalar::all(1 / std)); // scale
+    chain->clamp(Scalar::all(-3), Scalar::all(3));
+    chain->apply(src, dst, CV_32F, stream); // convert
+@endcode
+ */
+class CV_EXPORTS_W ElementwiseChain : public Algorithm
+{
+public:
+    //! Maximum number of operations of a chain.
+    enum { MAX_OPS = 16 };
+
+    //! x + value
+    CV_WRAP virtual void add(Scalar value) = 0;
+    //! x * value
+    CV_WRAP virtual void multiply(Scalar value) = 0;
+    //! |x - value|
+    CV_WRAP virtual void absdiff(Scalar value) = 0;
+    //! min(x, value)
+    CV_WRAP virtual void min(Scalar value) = 0;
+    //! max(x, value)
+    CV_WRAP virtual void max(Scalar value) = 0;
+    //! min(max(x, low), high)
+    CV_WRAP virtual void clamp(Scalar low, Scalar high) = 0;
+    //! |x|
+    CV_WRAP virtual void abs() = 0;
+    //! x * x
+    CV_WRAP virtual void sqr() = 0;
+    //! sqrt(x)
+    CV_WRAP virtual void sqrt() = 0;
+    //! exp(x)
+    CV_WRAP virtual void exp() = 0;
+    //! log(x)
+    CV_WRAP virtual void log() = 0;
+
+    //! Removes all the operations.
+    CV_WRAP virtual void clear() = 0;
+    CV_WRAP virtual int getNumOps() const = 0;
+
+    /** @brief Applies the chain to every element of the source matrix.
+
+    @param src Source matrix. CV_8U, CV_16U, CV_16S and CV_32F depths with 1 to 4 channels are supported.
+    @param dst Destination matrix with the same size and number of channels as src.
+    @param dtype Depth of the destination, CV_8U, CV_16U, CV_16S or CV_32F. -1 means the depth of src.
+    @param stream Stream for the asynchronous version.
+     */
+    CV_WRAP virtual void apply(InputArray src, OutputArray dst, int dtype = -1, Stream& stream = Stream::Null()) = 0;
+};
+
+/** @brief Creates an empty cuda::ElementwiseChain .
+ */
+CV_EXPORTS_W Ptr<ElementwiseChain> createElementwiseChain();
+
 //! @} cudaarithm_elem
 
 //! @addtogroup cudaarithm_core
@@ -705,6 +767,56 @@ CV_EXPORTS_W void meanStdDev(InputArray mtx, OutputArray dst, Stream& stream = S
  */
 CV_EXPORTS_W void rectStdDev(InputArray src, InputArray sqr, OutputArray dst, Rect rect, Stream& stream = Stream::Null());
 
+/** @brief Computes sums of elements of many rectangular regions of an image.
+
+@param src Source image of any depth, with up to 4 channels.
+@param rois Regions of src. They must lie inside of the image and be non-empty.
+@param dst Output 1 x rois.size() array of CV_64FC(src.channels()) type, (i) element is the sum of
+the rois[i] region.
+@param stream Stream for the asynchronous version.
+
+All regions are reduced by one kernel launch and the results stay in dst, so they can be consumed on
+the device or downloaded once.
+
+@sa calcSum
+ */
+CV_EXPORTS_W void calcSumRois(InputArray src, const std::vector<Rect>& rois, OutputArray dst, Stream& stream = Stream::Null());
+
+/** @brief Computes mean values and standard deviations of many rectangular regions of an image.
+
+@param src Single-channel source image of any depth.
+@param rois Regions of src. They must lie inside of the image and be non-empty.
+@param dst Output 1 x rois.size() array of CV_64FC2 type holding (mean, stddev) pairs.
+@param stream Stream for the asynchronous version.
+
+@sa meanStdDev, calcSumRois
+ */
+CV_EXPORTS_W void meanStdDevRois(InputArray src, const std::vector<Rect>& rois, OutputArray dst, Stream& stream = Stream::Null());
+
+/** @brief Finds minimum and maximum elements and their locations in many rectangular regions of an image.
+
+@param src Single-channel source image of any depth.
+@param rois Regions of src. They must lie inside of the image and be non-empty.
+@param minMaxVals Output 1 x rois.size() array of CV_64FC2 type holding (min, max) pairs.
+@param loc Output 1 x rois.size() array of CV_32SC4 type holding (minX, minY, maxX, maxY) in src coordinates.
+@param stream Stream for the asynchronous version.
+
+@sa findMinMaxLoc, calcSumRois
+ */
+CV_EXPORTS_W void findMinMaxLocRois(InputArray src, const std::vector<Rect>& rois, OutputArray minMaxVals, OutputArray loc,
+                                    Stream& stream = Stream::Null());
+
+/** @brief Counts non-zero elements of many rectangular regions of an image.
+
+@param src Single-channel source image of any depth.
+@param rois Regions of src. They must lie inside of the image and be non-empty.
+@param dst Output 1 x rois.size() array of CV_32SC1 type.
+@param stream Stream for the asynchronous version.
+
+@sa countNonZero, calcSumRois
+ */
+CV_EXPORTS_W void countNonZeroRois(InputArray src, const std::vector<Rect>& rois, OutputArray dst, Stream& stream = Stream::Null());
+
 /** @brief Normalizes the norm or value range of an array.
 
 @param src Input array.
@@ -0,0 +1,149 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "opencv2/opencv_modules.hpp"
+
+#ifndef HAVE_OPENCV_CUDEV
+
+#error "opencv_cudev is required"
+
+#else
+
+#include "../elementwise_chain.hpp"
+
+#include "opencv2/cudaarithm.hpp"
+#include "opencv2/cudev.hpp"
+#include "opencv2/core/private.cuda.hpp"
+
+using namespace cv;
+using namespace cv::cuda;
+using namespace cv::cudev;
+using namespace cv::cuda::elementwise_chain;
+
+namespace
+{
+    __device__ __forceinline__ float applyOp(const Op& op, float x, int c)
+    {
+        switch (op.code)
+        {
+        case OP_ADD:     return x + op.val[c];
+        case OP_MUL:     return x * op.val[c];
+        case OP_ABSDIFF: return ::fabsf(x - op.val[c]);
+        case OP_MIN:     return ::fminf(x, op.val[c]);
+        case OP_MAX:     return ::fmaxf(x, op.val[c]);
+        case OP_ABS:     return ::fabsf(x);
+        case OP_SQR:     return x * x;
+        case OP_SQRT:    return ::sqrtf(x);
+        case OP_EXP:     return ::expf(x);
+        case OP_LOG:     return ::logf(x);
+        }
+        return x;
+    }
+
+    template <typename SrcType, typename DstType> struct ChainOp : unary_function<SrcType, DstType>
+    {
+        typedef typename VecTraits<SrcType>::elem_type src_elem_type;
+        typedef typename VecTraits<DstType>::elem_type dst_elem_type;
+        enum { cn = VecTraits<SrcType>::cn };
+
+        Program program;
+
+        __device__ __forceinline__ DstType operator ()(const SrcType& a) const
+        {
+            const src_elem_type* in = reinterpret_cast<const src_elem_type*>(&a);
+
+            float work[cn];
+            #pragma unroll
+            for (int c = 0; c < cn; ++c)
+                work[c] = in[c];
+
+            for (int i = 0; i < program.count; ++i)
+            {
+                const Op& op = program.ops[i];
+
+                #pragma unroll
+                for (int c = 0; c < cn; ++c)
+                    work[c] = applyOp(op, work[c], c);
+            }
+
+            DstType res;
+            dst_elem_type* out = reinterpret_cast<dst_elem_type*>(&res);
+
+            #pragma unroll
+            for (int c = 0; c < cn; ++c)
+                out[c] = saturate_cast<dst_elem_type>(work[c]);
+
+            return res;
+        }
+    };
+
+    template <typename SrcDepth, typename DstDepth, int cn>
+    void chainImpl(const GpuMat& src, GpuMat& dst, const Program& program, Stream& stream)
+    {
+        typedef typename MakeVec<SrcDepth, cn>::type SrcType;
+        typedef typename MakeVec<DstDepth, cn>::type DstType;
+
+        ChainOp<SrcType, DstType> op;
+        op.program = program;
+
+        gridTransformUnary(globPtr<SrcType>(src), globPtr<DstType>(dst), op, stream);
+    }
+
+    typedef void (*func_t)(const GpuMat& src, GpuMat& dst, const Program& program, Stream& stream);
+
+    template <typename SrcDepth, typename DstDepth> struct ChainFuncs
+    {
+        static func_t get(int cn)
+        {
+            static const func_t funcs[] =
+            {
+                chainImpl<SrcDepth, DstDepth, 1>, chainImpl<SrcDepth, DstDepth, 2>, chainImpl<SrcDepth, DstDepth, 3>, chainImpl<SrcDepth, DstDepth, 4>
+            };
+            return funcs[cn - 1];
+        }
+    };
+
+    template <typename SrcDepth> func_t getChainFunc(int ddepth, int cn)
+    {
+        switch (ddepth)
+        {
+        case CV_8U:  return ChainFuncs<SrcDepth, uchar>::get(cn);
+        case CV_16U: return ChainFuncs<SrcDepth, ushort>::get(cn);
+        case CV_16S: return ChainFuncs<SrcDepth, short>::get(cn);
+        case CV_32F: return ChainFuncs<SrcDepth, float>::get(cn);
+        }
+        return 0;
+    }
+}
+
+void cv::cuda::ElementwiseChainImpl::apply(InputArray _src, OutputArray _dst, int dtype, Stream& stream)
+{
+    GpuMat src = getInputMat(_src, stream);
+
+    const int sdepth = src.depth();
+    const int cn = src.channels();
+    const int ddepth = dtype < 0 ? sdepth : CV_MAT_DEPTH(dtype);
+
+    CV_Assert( sdepth == CV_8U || sdepth == CV_16U || sdepth == CV_16S || sdepth == CV_32F );
+    CV_Assert( ddepth == CV_8U || ddepth == CV_16U || ddepth == CV_16S || ddepth == CV_32F );
+    CV_Assert( cn <= 4 );
+
+    GpuMat dst = getOutputMat(_dst, src.size(), CV_MAKE_TYPE(ddepth, cn), stream);
+
+    func_t func = 0;
+    switch (sdepth)
+    {
+    case CV_8U:  func = getChainFunc<uchar>(ddepth, cn); break;
+    case CV_16U: func = getChainFunc<ushort>(ddepth, cn); break;
+    case CV_16S: func = getChainFunc<short>(ddepth, cn); break;
+    case CV_32F: func = getChainFunc<float>(ddepth, cn); break;
+    }
+    CV_Assert( func != 0 );
+
+    func(src, dst, program_, stream);
+
+    syncOutput(dst, _dst, stream);
+}
+
+#endif
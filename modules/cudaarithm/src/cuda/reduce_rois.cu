@@ -0,0 +1,414 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "opencv2/opencv_modules.hpp"
+
+#ifndef HAVE_OPENCV_CUDEV
+
+#error "opencv_cudev is required"
+
+#else
+
+#include "opencv2/cudaarithm.hpp"
+#include "opencv2/cudev.hpp"
+#include "opencv2/core/private.cuda.hpp"
+
+using namespace cv;
+using namespace cv::cuda;
+using namespace cv::cudev;
+
+// Segmented reductions: one block reduces one rectangle of the source,
+// all rectangles of the list are processed by a single launch.
+
+namespace
+{
+    const int BLOCK_W = 32;
+    const int BLOCK_H = 8;
+    const int BLOCK_SIZE = BLOCK_W * BLOCK_H;
+
+    template <typename R>
+    __device__ R blockSum(R* smem, R val)
+    {
+        const int tid = threadIdx.y * BLOCK_W + threadIdx.x;
+
+        smem[tid] = val;
+        __syncthreads();
+
+        for (int s = BLOCK_SIZE / 2; s > 0; s >>= 1)
+        {
+            if (tid < s)
+                smem[tid] += smem[tid + s];
+            __syncthreads();
+        }
+
+        const R res = smem[0];
+        __syncthreads();
+
+        return res;
+    }
+
+    template <typename T, int cn>
+    __global__ void sumRois(const PtrStepb src, const int4* rois, double* dst)
+    {
+        __shared__ double smem[BLOCK_SIZE];
+
+        const int4 roi = rois[blockIdx.x];
+
+        double acc[cn];
+        #pragma unroll
+        for (int c = 0; c < cn; ++c)
+            acc[c] = 0.0;
+
+        for (int y = roi.y + threadIdx.y; y < roi.y + roi.w; y += BLOCK_H)
+        {
+            const T* row = (const T*) src.ptr(y);
+
+            for (int x = roi.x + threadIdx.x; x < roi.x + roi.z; x += BLOCK_W)
+            {
+                #pragma unroll
+                for (int c = 0; c < cn; ++c)
+                    acc[c] += row[x * cn + c];
+            }
+        }
+
+        #pragma unroll
+        for (int c = 0; c < cn; ++c)
+        {
+            const double res = blockSum(smem, acc[c]);
+
+            if (threadIdx.x == 0 && threadIdx.y == 0)
+                dst[blockIdx.x * cn + c] = res;
+        }
+    }
+
+    template <typename T>
+    __global__ void meanStdDevRois(const PtrStepb src, const int4* rois, double* dst)
+    {
+        __shared__ double smem[BLOCK_SIZE];
+
+        const int4 roi = rois[blockIdx.x];
+
+        double sum = 0.0, sqsum = 0.0;
+
+        for (int y = roi.y + threadIdx.y; y < roi.y + roi.w; y += BLOCK_H)
+        {
+            const T* row = (const T*) src.ptr(y);
+
+            for (int x = roi.x + threadIdx.x; x < roi.x + roi.z; x += BLOCK_W)
+            {
+                const double val = row[x];
+                sum += val;
+                sqsum += val * val;
+            }
+        }
+
+        sum = blockSum(smem, sum);
+        sqsum = blockSum(smem, sqsum);
+
+        if (threadIdx.x == 0 && threadIdx.y == 0)
+        {
+            const double area = static_cast<double>(roi.z) * roi.w;
+            const double mean = sum / area;
+
+            dst[blockIdx.x * 2] = mean;
+            dst[blockIdx.x * 2 + 1] = ::sqrt(::fmax(sqsum / area - mean * mean, 0.0));
+        }
+    }
+
+    // the first position in the raster order wins the ties, as in cv::minMaxLoc
+    __device__ __forceinline__ void mergeMin(double& val, int& idx, double otherVal, int otherIdx)
+    {
+        if (otherVal < val || (otherVal == val && otherIdx < idx))
+        {
+            val = otherVal;
+            idx = otherIdx;
+        }
+    }
+
+    __device__ __forceinline__ void mergeMax(double& val, int& idx, double otherVal, int otherIdx)
+    {
+        if (otherVal > val || (otherVal == val && otherIdx < idx))
+        {
+            val = otherVal;
+            idx = otherIdx;
+        }
+    }
+
+    template <typename T>
+    __global__ void minMaxLocRois(const PtrStepb src, const int cols, const int4* rois, double* vals, int* locs)
+    {
+        __shared__ double sminVal[BLOCK_SIZE];
+        __shared__ double smaxVal[BLOCK_SIZE];
+        __shared__ int sminIdx[BLOCK_SIZE];
+        __shared__ int smaxIdx[BLOCK_SIZE];
+
+        const int tid = threadIdx.y * BLOCK_W + threadIdx.x;
+        const int4 roi = rois[blockIdx.x];
+
+        double minVal = numeric_limits<double>::max(), maxVal = -numeric_limits<double>::max();
+        int minIdx = numeric_limits<int>::max(), maxIdx = numeric_limits<int>::max();
+
+        for (int y = roi.y + threadIdx.y; y < roi.y + roi.w; y += BLOCK_H)
+        {
+            const T* row = (const T*) src.ptr(y);
+
+            for (int x = roi.x + threadIdx.x; x < roi.x + roi.z; x += BLOCK_W)
+            {
+                const double val = row[x];
+                mergeMin(minVal, minIdx, val, y * cols + x);
+                mergeMax(maxVal, maxIdx, val, y * cols + x);
+            }
+        }
+
+        sminVal[tid] = minVal; sminIdx[tid] = minIdx;
+        smaxVal[tid] = maxVal; smaxIdx[tid] = maxIdx;
+        __syncthreads();
+
+        for (int s = BLOCK_SIZE / 2; s > 0; s >>= 1)
+        {
+            if (tid < s)
+            {
+                mergeMin(sminVal[tid], sminIdx[tid], sminVal[tid + s], sminIdx[tid + s]);
+                mergeMax(smaxVal[tid], smaxIdx[tid], smaxVal[tid + s], smaxIdx[tid + s]);
+            }
+            __syncthreads();
+        }
+
+        if (tid == 0)
+        {
+            vals[blockIdx.x * 2] = sminVal[0];
+            vals[blockIdx.x * 2 + 1] = smaxVal[0];
+
+            locs[blockIdx.x * 4] = sminIdx[0] % cols;
+            locs[blockIdx.x * 4 + 1] = sminIdx[0] / cols;
+            locs[blockIdx.x * 4 + 2] = smaxIdx[0] % cols;
+            locs[blockIdx.x * 4 + 3] = smaxIdx[0] / cols;
+        }
+    }
+
+    template <typename T>
+    __global__ void countNonZeroRois(const PtrStepb src, const int4* rois, int* dst)
+    {
+        __shared__ int smem[BLOCK_SIZE];
+
+        const int4 roi = rois[blockIdx.x];
+
+        int count = 0;
+
+        for (int y = roi.y + threadIdx.y; y < roi.y + roi.w; y += BLOCK_H)
+        {
+            const T* row = (const T*) src.ptr(y);
+
+            for (int x = roi.x + threadIdx.x; x < roi.x + roi.z; x += BLOCK_W)
+                count += row[x] != 0;
+        }
+
+        count = blockSum(smem, count);
+
+        if (threadIdx.x == 0 && threadIdx.y == 0)
+            dst[blockIdx.x] = count;
+    }
+
+    GpuMat uploadRois(const GpuMat& src, const std::vector<Rect>& rois, BufferPool& pool, Stream& stream)
+    {
+        const Rect whole(0, 0, src.cols, src.rows);
+
+        for (size_t i = 0; i < rois.size(); ++i)
+            CV_Assert( rois[i].area() > 0 && (rois[i] & whole) == rois[i] );
+
+        GpuMat d_rois = pool.getBuffer(1, static_cast<int>(rois.size()), CV_32SC4);
+        d_rois.upload(Mat(1, d_rois.cols, CV_32SC4, (void*)&rois[0]), stream);
+
+        return d_rois;
+    }
+
+    template <typename T, int cn>
+    void sumRoisImpl(const GpuMat& src, const GpuMat& rois, GpuMat& dst, Stream& stream)
+    {
+        const dim3 block(BLOCK_W, BLOCK_H);
+        const dim3 grid(rois.cols);
+        cudaStream_t s = StreamAccessor::getStream(stream);
+
+        sumRois<T, cn><<<grid, block, 0, s>>>(src, rois.ptr<int4>(), dst.ptr<double>());
+        CV_CUDEV_SAFE_CALL( cudaGetLastError() );
+    }
+
+    template <typename T>
+    void meanStdDevRoisImpl(const GpuMat& src, const GpuMat& rois, GpuMat& dst, Stream& stream)
+    {
+        const dim3 block(BLOCK_W, BLOCK_H);
+        const dim3 grid(rois.cols);
+        cudaStream_t s = StreamAccessor::getStream(stream);
+
+        meanStdDevRois<T><<<grid, block, 0, s>>>(src, rois.ptr<int4>(), dst.ptr<double>());
+        CV_CUDEV_SAFE_CALL( cudaGetLastError() );
+    }
+
+    template <typename T>
+    void minMaxLocRoisImpl(const GpuMat& src, const GpuMat& rois, GpuMat& vals, GpuMat& locs, Stream& stream)
+    {
+        const dim3 block(BLOCK_W, BLOCK_H);
+        const dim3 grid(rois.cols);
+        cudaStream_t s = StreamAccessor::getStream(stream);
+
+        minMaxLocRois<T><<<grid, block, 0, s>>>(src, src.cols, rois.ptr<int4>(), vals.ptr<double>(), locs.ptr<int>());
+        CV_CUDEV_SAFE_CALL( cudaGetLastError() );
+    }
+
+    template <typename T>
+    void countNonZeroRoisImpl(const GpuMat& src, const GpuMat& rois, GpuMat& dst, Stream& stream)
+    {
+        const dim3 block(BLOCK_W, BLOCK_H);
+        const dim3 grid(rois.cols);
+        cudaStream_t s = StreamAccessor::getStream(stream);
+
+        countNonZeroRois<T><<<grid, block, 0, s>>>(src, rois.ptr<int4>(), dst.ptr<int>());
+        CV_CUDEV_SAFE_CALL( cudaGetLastError() );
+    }
+}
+
+void cv::cuda::calcSumRois(InputArray _src, const std::vector<Rect>& rois, OutputArray _dst, Stream& stream)
+{
+    typedef void (*func_t)(const GpuMat& src, const GpuMat& rois, GpuMat& dst, Stream& stream);
+    static const func_t funcs[7][4] =
+    {
+        {sumRoisImpl<uchar , 1>, sumRoisImpl<uchar , 2>, sumRoisImpl<uchar , 3>, sumRoisImpl<uchar , 4>},
+        {sumRoisImpl<schar , 1>, sumRoisImpl<schar , 2>, sumRoisImpl<schar , 3>, sumRoisImpl<schar , 4>},
+        {sumRoisImpl<ushort, 1>, sumRoisImpl<ushort, 2>, sumRoisImpl<ushort, 3>, sumRoisImpl<ushort, 4>},
+        {sumRoisImpl<short , 1>, sumRoisImpl<short , 2>, sumRoisImpl<short , 3>, sumRoisImpl<short , 4>},
+        {sumRoisImpl<int   , 1>, sumRoisImpl<int   , 2>, sumRoisImpl<int   , 3>, sumRoisImpl<int   , 4>},
+        {sumRoisImpl<float , 1>, sumRoisImpl<float , 2>, sumRoisImpl<float , 3>, sumRoisImpl<float , 4>},
+        {sumRoisImpl<double, 1>, sumRoisImpl<double, 2>, sumRoisImpl<double, 3>, sumRoisImpl<double, 4>}
+    };
+
+    const GpuMat src = getInputMat(_src, stream);
+
+    CV_Assert( src.depth() <= CV_64F && src.channels() <= 4 );
+
+    if (rois.empty())
+    {
+        _dst.release();
+        return;
+    }
+
+    BufferPool pool(stream);
+    const GpuMat d_rois = uploadRois(src, rois, pool, stream);
+
+    GpuMat dst = getOutputMat(_dst, 1, static_cast<int>(rois.size()), CV_64FC(src.channels()), stream);
+
+    const func_t func = funcs[src.depth()][src.channels() - 1];
+    func(src, d_rois, dst, stream);
+
+    syncOutput(dst, _dst, stream);
+}
+
+void cv::cuda::meanStdDevRois(InputArray _src, const std::vector<Rect>& rois, OutputArray _dst, Stream& stream)
+{
+    typedef void (*func_t)(const GpuMat& src, const GpuMat& rois, GpuMat& dst, Stream& stream);
+    static const func_t funcs[] =
+    {
+        meanStdDevRoisImpl<uchar>,
+        meanStdDevRoisImpl<schar>,
+        meanStdDevRoisImpl<ushort>,
+        meanStdDevRoisImpl<short>,
+        meanStdDevRoisImpl<int>,
+        meanStdDevRoisImpl<float>,
+        meanStdDevRoisImpl<double>
+    };
+
+    const GpuMat src = getInputMat(_src, stream);
+
+    CV_Assert( src.depth() <= CV_64F && src.channels() == 1 );
+
+    if (rois.empty())
+    {
+        _dst.release();
+        return;
+    }
+
+    BufferPool pool(stream);
+    const GpuMat d_rois = uploadRois(src, rois, pool, stream);
+
+    GpuMat dst = getOutputMat(_dst, 1, static_cast<int>(rois.size()), CV_64FC2, stream);
+
+    const func_t func = funcs[src.depth()];
+    func(src, d_rois, dst, stream);
+
+    syncOutput(dst, _dst, stream);
+}
+
+void cv::cuda::findMinMaxLocRois(InputArray _src, const std::vector<Rect>& rois, OutputArray _minMaxVals, OutputArray _loc, Stream& stream)
+{
+    typedef void (*func_t)(const GpuMat& src, const GpuMat& rois, GpuMat& vals, GpuMat& locs, Stream& stream);
+    static const func_t funcs[] =
+    {
+        minMaxLocRoisImpl<uchar>,
+        minMaxLocRoisImpl<schar>,
+        minMaxLocRoisImpl<ushort>,
+        minMaxLocRoisImpl<short>,
+        minMaxLocRoisImpl<int>,
+        minMaxLocRoisImpl<float>,
+        minMaxLocRoisImpl<double>
+    };
+
+    const GpuMat src = getInputMat(_src, stream);
+
+    CV_Assert( src.depth() <= CV_64F && src.channels() == 1 );
+
+    if (rois.empty())
+    {
+        _minMaxVals.release();
+        _loc.release();
+        return;
+    }
+
+    BufferPool pool(stream);
+    const GpuMat d_rois = uploadRois(src, rois, pool, stream);
+
+    GpuMat minMaxVals = getOutputMat(_minMaxVals, 1, static_cast<int>(rois.size()), CV_64FC2, stream);
+    GpuMat loc = getOutputMat(_loc, 1, static_cast<int>(rois.size()), CV_32SC4, stream);
+
+    const func_t func = funcs[src.depth()];
+    func(src, d_rois, minMaxVals, loc, stream);
+
+    syncOutput(minMaxVals, _minMaxVals, stream);
+    syncOutput(loc, _loc, stream);
+}
+
+void cv::cuda::countNonZeroRois(InputArray _src, const std::vector<Rect>& rois, OutputArray _dst, Stream& stream)
+{
+    typedef void (*func_t)(const GpuMat& src, const GpuMat& rois, GpuMat& dst, Stream& stream);
+    static const func_t funcs[] =
+    {
+        countNonZeroRoisImpl<uchar>,
+        countNonZeroRoisImpl<schar>,
+        countNonZeroRoisImpl<ushort>,
+        countNonZeroRoisImpl<short>,
+        countNonZeroRoisImpl<int>,
+        countNonZeroRoisImpl<float>,
+        countNonZeroRoisImpl<double>
+    };
+
+    const GpuMat src = getInputMat(_src, stream);
+
+    CV_Assert( src.depth() <= CV_64F && src.channels() == 1 );
+
+    if (rois.empty())
+    {
+        _dst.release();
+        return;
+    }
+
+    BufferPool pool(stream);
+    const GpuMat d_rois = uploadRois(src, rois, pool, stream);
+
+    GpuMat dst = getOutputMat(_dst, 1, static_cast<int>(rois.size()), CV_32SC1, stream);
+
+    const func_t func = funcs[src.depth()];
+    func(src, d_rois, dst, stream);
+
+    syncOutput(dst, _dst, stream);
+}
+
+#endif
@@ -108,7 +108,8 @@ double cv::cuda::threshold(InputArray _src, OutputArray _dst, double thresh, dou
     src = src.reshape(1);
     dst = dst.reshape(1);
 
-    if (depth == CV_32F && type == 2 /*THRESH_TRUNC*/)
+    // NppStreamHandler switches the global NPP stream, it can not be recorded into a CUDA graph
+    if (depth == CV_32F && type == 2 /*THRESH_TRUNC*/ && !isStreamCapturing(stream))
     {
         NppStreamHandler h(StreamAccessor::getStream(stream));
 
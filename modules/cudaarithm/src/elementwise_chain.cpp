@@ -0,0 +1,46 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+using namespace cv;
+using namespace cv::cuda;
+
+#if !defined (HAVE_CUDA) || defined (CUDA_DISABLER)
+
+Ptr<ElementwiseChain> cv::cuda::createElementwiseChain() { throw_no_cuda(); return Ptr<ElementwiseChain>(); }
+
+#else /* !defined (HAVE_CUDA) || defined (CUDA_DISABLER) */
+
+#include "elementwise_chain.hpp"
+
+ElementwiseChainImpl::ElementwiseChainImpl()
+{
+    program_.count = 0;
+}
+
+void ElementwiseChainImpl::push(int code, const Scalar& value)
+{
+    CV_Assert( program_.count < MAX_OPS );
+
+    elementwise_chain::Op& op = program_.ops[program_.count++];
+    op.code = code;
+    for (int c = 0; c < 4; ++c)
+        op.val[c] = static_cast<float>(value[c]);
+}
+
+void ElementwiseChainImpl::clamp(Scalar low, Scalar high)
+{
+    CV_Assert( program_.count + 2 <= MAX_OPS );
+
+    push(elementwise_chain::OP_MAX, low);
+    push(elementwise_chain::OP_MIN, high);
+}
+
+Ptr<ElementwiseChain> cv::cuda::createElementwiseChain()
+{
+    return makePtr<ElementwiseChainImpl>();
+}
+
+#endif
@@ -0,0 +1,72 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __CUDAARITHM_ELEMENTWISE_CHAIN_HPP__
+#define __CUDAARITHM_ELEMENTWISE_CHAIN_HPP__
+
+#include "opencv2/cudaarithm.hpp"
+
+namespace cv { namespace cuda {
+
+namespace elementwise_chain
+{
+    enum OpCode
+    {
+        OP_ADD,
+        OP_MUL,
+        OP_ABSDIFF,
+        OP_MIN,
+        OP_MAX,
+        OP_ABS,
+        OP_SQR,
+        OP_SQRT,
+        OP_EXP,
+        OP_LOG
+    };
+
+    struct Op
+    {
+        int code;
+        float val[4];
+    };
+
+    //! Passed to the kernel by value, so that no upload is needed and a launch can be captured into a CUDA graph
+    struct Program
+    {
+        int count;
+        Op ops[ElementwiseChain::MAX_OPS];
+    };
+}
+
+class ElementwiseChainImpl : public ElementwiseChain
+{
+public:
+    ElementwiseChainImpl();
+
+    void add(Scalar value) CV_OVERRIDE { push(elementwise_chain::OP_ADD, value); }
+    void multiply(Scalar value) CV_OVERRIDE { push(elementwise_chain::OP_MUL, value); }
+    void absdiff(Scalar value) CV_OVERRIDE { push(elementwise_chain::OP_ABSDIFF, value); }
+    void min(Scalar value) CV_OVERRIDE { push(elementwise_chain::OP_MIN, value); }
+    void max(Scalar value) CV_OVERRIDE { push(elementwise_chain::OP_MAX, value); }
+    void clamp(Scalar low, Scalar high) CV_OVERRIDE;
+    void abs() CV_OVERRIDE { push(elementwise_chain::OP_ABS, Scalar()); }
+    void sqr() CV_OVERRIDE { push(elementwise_chain::OP_SQR, Scalar()); }
+    void sqrt() CV_OVERRIDE { push(elementwise_chain::OP_SQRT, Scalar()); }
+    void exp() CV_OVERRIDE { push(elementwise_chain::OP_EXP, Scalar()); }
+    void log() CV_OVERRIDE { push(elementwise_chain::OP_LOG, Scalar()); }
+
+    void clear() CV_OVERRIDE { program_.count = 0; }
+    int getNumOps() const CV_OVERRIDE { return program_.count; }
+
+    void apply(InputArray src, OutputArray dst, int dtype, Stream& stream) CV_OVERRIDE;
+
+private:
+    void push(int code, const Scalar& value);
+
+    elementwise_chain::Program program_;
+};
+
+} }
+
+#endif // __CUDAARITHM_ELEMENTWISE_CHAIN_HPP__
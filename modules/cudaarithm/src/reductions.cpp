@@ -74,6 +74,11 @@ void cv::cuda::meanStdDev(InputArray, OutputArray, Stream&) { throw_no_cuda(); }
 
 void cv::cuda::rectStdDev(InputArray, InputArray, OutputArray, Rect, Stream&) { throw_no_cuda(); }
 
+void cv::cuda::calcSumRois(InputArray, const std::vector<Rect>&, OutputArray, Stream&) { throw_no_cuda(); }
+void cv::cuda::meanStdDevRois(InputArray, const std::vector<Rect>&, OutputArray, Stream&) { throw_no_cuda(); }
+void cv::cuda::findMinMaxLocRois(InputArray, const std::vector<Rect>&, OutputArray, OutputArray, Stream&) { throw_no_cuda(); }
+void cv::cuda::countNonZeroRois(InputArray, const std::vector<Rect>&, OutputArray, Stream&) { throw_no_cuda(); }
+
 void cv::cuda::normalize(InputArray, OutputArray, double, double, int, int, InputArray, Stream&) { throw_no_cuda(); }
 
 void cv::cuda::integral(InputArray, OutputArray, Stream&) { throw_no_cuda(); }
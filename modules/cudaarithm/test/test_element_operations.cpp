@@ -2857,5 +2857,69 @@ INSTANTIATE_TEST_CASE_P(CUDA_Arithm, PolarToCart, testing::Combine(
     testing::Values(AngleInDegrees(false), AngleInDegrees(true)),
     WHOLE_SUBMAT));
 
+////////////////////////////////////////////////////////////////////////////////
+// ElementwiseChain
+
+PARAM_TEST_CASE(ElementwiseChain, cv::cuda::DeviceInfo, cv::Size, MatDepth, MatDepth, Channels, UseRoi)
+{
+    cv::cuda::DeviceInfo devInfo;
+    cv::Size size;
+    int depth;
+    int dst_depth;
+    int channels;
+    bool useRoi;
+
+    virtual void SetUp()
+    {
+        devInfo = GET_PARAM(0);
+        size = GET_PARAM(1);
+        depth = GET_PARAM(2);
+        dst_depth = GET_PARAM(3);
+        channels = GET_PARAM(4);
+        useRoi = GET_PARAM(5);
+
+        cv::cuda::setDevice(devInfo.deviceID());
+    }
+};
+
+CUDA_TEST_P(ElementwiseChain, Accuracy)
+{
+    const int type = CV_MAKE_TYPE(depth, channels);
+    cv::Mat src = randomMat(size, type);
+
+    const cv::Scalar mean = randomScalar(0, 100);
+    const cv::Scalar scale = randomScalar(0.5, 2.0);
+
+    cv::Ptr<cv::cuda::ElementwiseChain> chain = cv::cuda::createElementwiseChain();
+    chain->add(-mean);
+    chain->multiply(scale);
+    chain->abs();
+    chain->clamp(cv::Scalar::all(10), cv::Scalar::all(200));
+    ASSERT_EQ(5, chain->getNumOps());
+
+    cv::cuda::GpuMat dst = createMat(size, CV_MAKE_TYPE(dst_depth, channels), useRoi);
+    chain->apply(loadMat(src, useRoi), dst, dst_depth);
+
+    cv::Mat work;
+    src.convertTo(work, CV_32F);
+    cv::add(work, -mean, work);
+    cv::multiply(work, scale, work);
+    work = cv::abs(work);
+    cv::max(work, cv::Scalar::all(10), work);
+    cv::min(work, cv::Scalar::all(200), work);
+    cv::Mat dst_gold;
+    work.convertTo(dst_gold, dst_depth);
+
+    EXPECT_MAT_NEAR(dst_gold, dst, dst_depth == CV_32F ? 1e-3 : 1.0);
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_Arithm, ElementwiseChain, testing::Combine(
+    ALL_DEVICES,
+    DIFFERENT_SIZES,
+    testing::Values(MatDepth(CV_8U), MatDepth(CV_16U), MatDepth(CV_16S), MatDepth(CV_32F)),
+    testing::Values(MatDepth(CV_8U), MatDepth(CV_32F)),
+    ALL_CHANNELS,
+    WHOLE_SUBMAT));
+
 }} // namespace
 #endif // HAVE_CUDA
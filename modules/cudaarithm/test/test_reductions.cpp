@@ -816,6 +816,126 @@ INSTANTIATE_TEST_CASE_P(CUDA_Arithm, CountNonZero, testing::Combine(
     ALL_DEPTH,
     WHOLE_SUBMAT));
 
+////////////////////////////////////////////////////////////////////////////
+// ReduceRois
+
+PARAM_TEST_CASE(ReduceRois, cv::cuda::DeviceInfo, MatDepth, UseRoi)
+{
+    cv::cuda::DeviceInfo devInfo;
+    int depth;
+    bool useRoi;
+
+    cv::Mat src;
+    std::vector<cv::Rect> rois;
+
+    virtual void SetUp()
+    {
+        devInfo = GET_PARAM(0);
+        depth = GET_PARAM(1);
+        useRoi = GET_PARAM(2);
+
+        cv::cuda::setDevice(devInfo.deviceID());
+
+        cv::Mat srcBase = randomMat(cv::Size(640, 480), CV_8U, 0.0, 4.0);
+        srcBase.convertTo(src, depth);
+
+        cv::RNG& rng = cv::theRNG();
+        for (int i = 0; i < 500; ++i)
+        {
+            const int w = rng.uniform(1, 100);
+            const int h = rng.uniform(1, 100);
+            rois.push_back(cv::Rect(rng.uniform(0, src.cols - w), rng.uniform(0, src.rows - h), w, h));
+        }
+        rois.push_back(cv::Rect(0, 0, src.cols, src.rows));
+    }
+};
+
+CUDA_TEST_P(ReduceRois, Sum)
+{
+    cv::cuda::Stream stream;
+
+    cv::cuda::HostMem dst;
+    cv::cuda::calcSumRois(loadMat(src, useRoi), rois, dst, stream);
+
+    stream.waitForCompletion();
+
+    const cv::Mat vals = dst.createMatHeader();
+    ASSERT_EQ(static_cast<int>(rois.size()), vals.cols);
+
+    for (size_t i = 0; i < rois.size(); ++i)
+        EXPECT_NEAR(cv::sum(src(rois[i]))[0], vals.at<double>(0, static_cast<int>(i)), 1e-6);
+}
+
+CUDA_TEST_P(ReduceRois, MeanStdDev)
+{
+    cv::cuda::Stream stream;
+
+    cv::cuda::HostMem dst;
+    cv::cuda::meanStdDevRois(loadMat(src, useRoi), rois, dst, stream);
+
+    stream.waitForCompletion();
+
+    const cv::Mat vals = dst.createMatHeader();
+
+    for (size_t i = 0; i < rois.size(); ++i)
+    {
+        cv::Scalar mean_gold, stddev_gold;
+        cv::meanStdDev(src(rois[i]), mean_gold, stddev_gold);
+
+        const cv::Vec2d val = vals.at<cv::Vec2d>(0, static_cast<int>(i));
+        EXPECT_NEAR(mean_gold[0], val[0], 1e-5);
+        EXPECT_NEAR(stddev_gold[0], val[1], 1e-5);
+    }
+}
+
+CUDA_TEST_P(ReduceRois, MinMaxLoc)
+{
+    cv::cuda::Stream stream;
+
+    cv::cuda::HostMem minMaxVals, loc;
+    cv::cuda::findMinMaxLocRois(loadMat(src, useRoi), rois, minMaxVals, loc, stream);
+
+    stream.waitForCompletion();
+
+    const cv::Mat vals = minMaxVals.createMatHeader();
+    const cv::Mat locs = loc.createMatHeader();
+
+    for (size_t i = 0; i < rois.size(); ++i)
+    {
+        double minVal_gold, maxVal_gold;
+        cv::Point minLoc_gold, maxLoc_gold;
+        cv::minMaxLoc(src(rois[i]), &minVal_gold, &maxVal_gold, &minLoc_gold, &maxLoc_gold);
+
+        const cv::Vec2d val = vals.at<cv::Vec2d>(0, static_cast<int>(i));
+        const cv::Vec4i pos = locs.at<cv::Vec4i>(0, static_cast<int>(i));
+
+        EXPECT_EQ(minVal_gold, val[0]);
+        EXPECT_EQ(maxVal_gold, val[1]);
+        EXPECT_EQ(minLoc_gold + rois[i].tl(), cv::Point(pos[0], pos[1]));
+        EXPECT_EQ(maxLoc_gold + rois[i].tl(), cv::Point(pos[2], pos[3]));
+    }
+}
+
+CUDA_TEST_P(ReduceRois, CountNonZero)
+{
+    cv::cuda::Stream stream;
+
+    cv::cuda::HostMem dst;
+    cv::cuda::countNonZeroRois(loadMat(src, useRoi), rois, dst, stream);
+
+    stream.waitForCompletion();
+
+    const cv::Mat vals = dst.createMatHeader();
+
+    for (size_t i = 0; i < rois.size(); ++i)
+        EXPECT_EQ(cv::countNonZero(src(rois[i])), vals.at<int>(0, static_cast<int>(i)));
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_Arithm, ReduceRois, testing::Combine(
+    ALL_DEVICES,
+    testing::Values(MatDepth(CV_8U), MatDepth(CV_16S), MatDepth(CV_32S), MatDepth(CV_32F)),
+    WHOLE_SUBMAT));
+
 //////////////////////////////////////////////////////////////////////////////
 // Reduce
 
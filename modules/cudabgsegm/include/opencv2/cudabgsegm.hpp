@@ -155,6 +155,52 @@ CV_EXPORTS_W Ptr<cuda::BackgroundSubtractorMOG2>
     createBackgroundSubtractorMOG2(int history = 500, double varThreshold = 16,
                                    bool detectShadows = true);
 
+/** @brief MOG2 Background Subtractor for several video streams of the same size and type.
+
+The Gaussian mixture models of all streams are kept in one device buffer and a frame set is processed
+by a single kernel launch. All streams share the parameters of the subtractor. The single frame
+methods inherited from cuda::BackgroundSubtractorMOG2 are only valid for a batch of one stream.
+ */
+class CV_EXPORTS_W BackgroundSubtractorMOG2Batch : public cuda::BackgroundSubtractorMOG2
+{
+public:
+    using cuda::BackgroundSubtractorMOG2::apply;
+    using cuda::BackgroundSubtractorMOG2::getBackgroundImage;
+
+    /** @brief Updates the models of all streams with one frame per stream.
+
+    @param images Next frame of every stream, CV_8UC1, CV_8UC3 or CV_8UC4, all of the same size and type.
+    @param fgmasks Output foreground masks, one per stream.
+    @param learningRate See cv::BackgroundSubtractorMOG2::apply.
+    @param stream Stream for the asynchronous version.
+     */
+    virtual void apply(const std::vector<GpuMat>& images, std::vector<GpuMat>& fgmasks,
+                       double learningRate, Stream& stream) = 0;
+
+    /** @brief Computes the background image of one stream.
+
+    @param idx Index of the stream.
+    @param backgroundImage Output background image.
+    @param stream Stream for the asynchronous version.
+     */
+    virtual void getBackgroundImage(int idx, OutputArray backgroundImage, Stream& stream) const = 0;
+
+    CV_WRAP virtual int getNumStreams() const = 0;
+};
+
+/** @brief Creates MOG2 Background Subtractor for a batch of video streams
+
+@param nstreams Number of video streams.
+@param history Length of the history.
+@param varThreshold Threshold on the squared Mahalanobis distance between the pixel and the model.
+@param detectShadows If true, the algorithm will detect shadows and mark them.
+
+@sa createBackgroundSubtractorMOG2
+ */
+CV_EXPORTS_W Ptr<cuda::BackgroundSubtractorMOG2Batch>
+    createBackgroundSubtractorMOG2Batch(int nstreams, int history = 500, double varThreshold = 16,
+                                        bool detectShadows = true);
+
 //! @}
 
 }} // namespace cv { namespace cuda {
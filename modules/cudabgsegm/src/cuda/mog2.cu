@@ -111,201 +111,233 @@ __device__ __forceinline__ void swap(Ptr2D &ptr, int x, int y, int k, int rows)
 // MOG2
 
 template <bool detectShadows, typename SrcT, typename WorkT>
-__global__ void mog2(const PtrStepSz<SrcT> frame, PtrStepb fgmask, PtrStepb modesUsed,
-                     PtrStepf gmm_weight, PtrStepf gmm_variance, PtrStep<WorkT> gmm_mean,
-                     const float alphaT, const float alpha1, const float prune, const Constants *const constants)
+__device__ __forceinline__ void mog2_pixel(const int x, const int y, const PtrStepSz<SrcT>& frame, PtrStepb fgmask, PtrStepb modesUsed,
+                                           PtrStepf gmm_weight, PtrStepf gmm_variance, PtrStep<WorkT> gmm_mean,
+                                           const float alphaT, const float alpha1, const float prune, const Constants *const constants)
 {
-    const int x = blockIdx.x * blockDim.x + threadIdx.x;
-    const int y = blockIdx.y * blockDim.y + threadIdx.y;
+    WorkT pix = cvt(frame(y, x));
 
-    if (x < frame.cols && y < frame.rows)
-    {
-        WorkT pix = cvt(frame(y, x));
+    //calculate distances to the modes (+ sort)
+    //here we need to go in descending order!!!
 
-        //calculate distances to the modes (+ sort)
-        //here we need to go in descending order!!!
+    bool background = false; // true - the pixel classified as background
 
-        bool background = false; // true - the pixel classified as background
+    //internal:
 
-        //internal:
+    bool fitsPDF = false; //if it remains zero a new GMM mode will be added
 
-        bool fitsPDF = false; //if it remains zero a new GMM mode will be added
-
-        int nmodes = modesUsed(y, x);
-        const int nNewModes = nmodes; //current number of modes in GMM
+    int nmodes = modesUsed(y, x);
+    const int nNewModes = nmodes; //current number of modes in GMM
 
-        float totalWeight = 0.0f;
+    float totalWeight = 0.0f;
 
-        //go through all modes
+    //go through all modes
 
-        for (int mode = 0; mode < nmodes; ++mode)
+    for (int mode = 0; mode < nmodes; ++mode)
+    {
+        //need only weight if fit is found
+        float weight = alpha1 * gmm_weight(mode * frame.rows + y, x) + prune;
+        int swap_count = 0;
+        //fit not found yet
+        if (!fitsPDF)
         {
-            //need only weight if fit is found
-            float weight = alpha1 * gmm_weight(mode * frame.rows + y, x) + prune;
-            int swap_count = 0;
-            //fit not found yet
-            if (!fitsPDF)
-            {
-                //check if it belongs to some of the remaining modes
-                const float var = gmm_variance(mode * frame.rows + y, x);
-
-                const WorkT mean = gmm_mean(mode * frame.rows + y, x);
+            //check if it belongs to some of the remaining modes
+            const float var = gmm_variance(mode * frame.rows + y, x);
 
-                //calculate difference and distance
-                const WorkT diff = mean - pix;
-                const float dist2 = sqr(diff);
+            const WorkT mean = gmm_mean(mode * frame.rows + y, x);
 
-                //background? - Tb - usually larger than Tg
-                if (totalWeight < constants->TB_ && dist2 < constants->Tb_ * var)
-                    background = true;
+            //calculate difference and distance
+            const WorkT diff = mean - pix;
+            const float dist2 = sqr(diff);
 
-                //check fit
-                if (dist2 < constants->Tg_ * var)
-                {
-                    //belongs to the mode
-                    fitsPDF = true;
+            //background? - Tb - usually larger than Tg
+            if (totalWeight < constants->TB_ && dist2 < constants->Tb_ * var)
+                background = true;
 
-                    //update distribution
+            //check fit
+            if (dist2 < constants->Tg_ * var)
+            {
+                //belongs to the mode
+                fitsPDF = true;
 
-                    //update weight
-                    weight += alphaT;
-                    float k = alphaT / weight;
+                //update distribution
 
-                    //update mean
-                    gmm_mean(mode * frame.rows + y, x) = mean - k * diff;
+                //update weight
+                weight += alphaT;
+                float k = alphaT / weight;
 
-                    //update variance
-                    float varnew = var + k * (dist2 - var);
+                //update mean
+                gmm_mean(mode * frame.rows + y, x) = mean - k * diff;
 
-                    //limit the variance
-                    varnew = ::fmaxf(varnew, constants->varMin_);
-                    varnew = ::fminf(varnew, constants->varMax_);
+                //update variance
+                float varnew = var + k * (dist2 - var);
 
-                    gmm_variance(mode * frame.rows + y, x) = varnew;
+                //limit the variance
+                varnew = ::fmaxf(varnew, constants->varMin_);
+                varnew = ::fminf(varnew, constants->varMax_);
 
-                    //sort
-                    //all other weights are at the same place and
-                    //only the matched (iModes) is higher -> just find the new place for it
+                gmm_variance(mode * frame.rows + y, x) = varnew;
 
-                    for (int i = mode; i > 0; --i)
-                    {
-                        //check one up
-                        if (weight < gmm_weight((i - 1) * frame.rows + y, x))
-                            break;
+                //sort
+                //all other weights are at the same place and
+                //only the matched (iModes) is higher -> just find the new place for it
 
-                        swap_count++;
-                        //swap one up
-                        swap(gmm_weight, x, y, i - 1, frame.rows);
-                        swap(gmm_variance, x, y, i - 1, frame.rows);
-                        swap(gmm_mean, x, y, i - 1, frame.rows);
-                    }
+                for (int i = mode; i > 0; --i)
+                {
+                    //check one up
+                    if (weight < gmm_weight((i - 1) * frame.rows + y, x))
+                        break;
 
-                    //belongs to the mode - bFitsPDF becomes 1
+                    swap_count++;
+                    //swap one up
+                    swap(gmm_weight, x, y, i - 1, frame.rows);
+                    swap(gmm_variance, x, y, i - 1, frame.rows);
+                    swap(gmm_mean, x, y, i - 1, frame.rows);
                 }
-            } // !fitsPDF
 
-            //check prune
-            if (weight < -prune)
-            {
-                weight = 0.0f;
-                nmodes--;
+                //belongs to the mode - bFitsPDF becomes 1
             }
+        } // !fitsPDF
 
-            gmm_weight((mode - swap_count) * frame.rows + y, x) = weight; //update weight by the calculated value
-            totalWeight += weight;
+        //check prune
+        if (weight < -prune)
+        {
+            weight = 0.0f;
+            nmodes--;
         }
 
-        //renormalize weights
+        gmm_weight((mode - swap_count) * frame.rows + y, x) = weight; //update weight by the calculated value
+        totalWeight += weight;
+    }
 
-        totalWeight = 1.f / totalWeight;
-        for (int mode = 0; mode < nmodes; ++mode)
-            gmm_weight(mode * frame.rows + y, x) *= totalWeight;
+    //renormalize weights
 
-        nmodes = nNewModes;
+    totalWeight = 1.f / totalWeight;
+    for (int mode = 0; mode < nmodes; ++mode)
+        gmm_weight(mode * frame.rows + y, x) *= totalWeight;
 
-        //make new mode if needed and exit
+    nmodes = nNewModes;
 
-        if (!fitsPDF)
-        {
-            // replace the weakest or add a new one
-            const int mode = nmodes == constants->nmixtures_ ? constants->nmixtures_ - 1 : nmodes++;
+    //make new mode if needed and exit
 
-            if (nmodes == 1)
-                gmm_weight(mode * frame.rows + y, x) = 1.f;
-            else
-            {
-                gmm_weight(mode * frame.rows + y, x) = alphaT;
+    if (!fitsPDF)
+    {
+        // replace the weakest or add a new one
+        const int mode = nmodes == constants->nmixtures_ ? constants->nmixtures_ - 1 : nmodes++;
 
-                // renormalize all other weights
+        if (nmodes == 1)
+            gmm_weight(mode * frame.rows + y, x) = 1.f;
+        else
+        {
+            gmm_weight(mode * frame.rows + y, x) = alphaT;
 
-                for (int i = 0; i < nmodes - 1; ++i)
-                    gmm_weight(i * frame.rows + y, x) *= alpha1;
-            }
+            // renormalize all other weights
 
-            // init
+            for (int i = 0; i < nmodes - 1; ++i)
+                gmm_weight(i * frame.rows + y, x) *= alpha1;
+        }
 
-            gmm_mean(mode * frame.rows + y, x) = pix;
-            gmm_variance(mode * frame.rows + y, x) = constants->varInit_;
+        // init
 
-            //sort
-            //find the new place for it
+        gmm_mean(mode * frame.rows + y, x) = pix;
+        gmm_variance(mode * frame.rows + y, x) = constants->varInit_;
 
-            for (int i = nmodes - 1; i > 0; --i)
-            {
-                // check one up
-                if (alphaT < gmm_weight((i - 1) * frame.rows + y, x))
-                    break;
+        //sort
+        //find the new place for it
 
-                //swap one up
-                swap(gmm_weight, x, y, i - 1, frame.rows);
-                swap(gmm_variance, x, y, i - 1, frame.rows);
-                swap(gmm_mean, x, y, i - 1, frame.rows);
-            }
+        for (int i = nmodes - 1; i > 0; --i)
+        {
+            // check one up
+            if (alphaT < gmm_weight((i - 1) * frame.rows + y, x))
+                break;
+
+            //swap one up
+            swap(gmm_weight, x, y, i - 1, frame.rows);
+            swap(gmm_variance, x, y, i - 1, frame.rows);
+            swap(gmm_mean, x, y, i - 1, frame.rows);
         }
+    }
 
-        //set the number of modes
-        modesUsed(y, x) = nmodes;
+    //set the number of modes
+    modesUsed(y, x) = nmodes;
 
-        bool isShadow = false;
-        if (detectShadows && !background)
+    bool isShadow = false;
+    if (detectShadows && !background)
+    {
+        float tWeight = 0.0f;
+
+        // check all the components  marked as background:
+        for (int mode = 0; mode < nmodes; ++mode)
         {
-            float tWeight = 0.0f;
+            const WorkT mean = gmm_mean(mode * frame.rows + y, x);
 
-            // check all the components  marked as background:
-            for (int mode = 0; mode < nmodes; ++mode)
-            {
-                const WorkT mean = gmm_mean(mode * frame.rows + y, x);
+            const WorkT pix_mean = pix * mean;
 
-                const WorkT pix_mean = pix * mean;
+            const float numerator = sum(pix_mean);
+            const float denominator = sqr(mean);
 
-                const float numerator = sum(pix_mean);
-                const float denominator = sqr(mean);
+            // no division by zero allowed
+            if (denominator == 0)
+                break;
 
-                // no division by zero allowed
-                if (denominator == 0)
-                    break;
+            // if tau < a < 1 then also check the color distortion
+            else if (numerator <= denominator && numerator >= constants->tau_ * denominator)
+            {
+                const float a = numerator / denominator;
 
-                // if tau < a < 1 then also check the color distortion
-                else if (numerator <= denominator && numerator >= constants->tau_ * denominator)
+                WorkT dD = a * mean - pix;
+
+                if (sqr(dD) < constants->Tb_ * gmm_variance(mode * frame.rows + y, x) * a * a)
                 {
-                    const float a = numerator / denominator;
+                    isShadow = true;
+                    break;
+                }
+            };
 
-                    WorkT dD = a * mean - pix;
+            tWeight += gmm_weight(mode * frame.rows + y, x);
+            if (tWeight > constants->TB_)
+                break;
+        }
+    }
 
-                    if (sqr(dD) < constants->Tb_ * gmm_variance(mode * frame.rows + y, x) * a * a)
-                    {
-                        isShadow = true;
-                        break;
-                    }
-                };
+    fgmask(y, x) = background ? 0 : isShadow ? constants->shadowVal_ : 255;
+}
 
-                tWeight += gmm_weight(mode * frame.rows + y, x);
-                if (tWeight > constants->TB_)
-                    break;
-            }
-        }
+template <bool detectShadows, typename SrcT, typename WorkT>
+__global__ void mog2(const PtrStepSz<SrcT> frame, PtrStepb fgmask, PtrStepb modesUsed,
+                     PtrStepf gmm_weight, PtrStepf gmm_variance, PtrStep<WorkT> gmm_mean,
+                     const float alphaT, const float alpha1, const float prune, const Constants *const constants)
+{
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int y = blockIdx.y * blockDim.y + threadIdx.y;
 
-        fgmask(y, x) = background ? 0 : isShadow ? constants->shadowVal_ : 255;
+    if (x < frame.cols && y < frame.rows)
+        mog2_pixel<detectShadows>(x, y, frame, fgmask, modesUsed, gmm_weight, gmm_variance, gmm_mean, alphaT, alpha1, prune, constants);
+}
+
+// blockIdx.z is the stream, the models of the streams are stacked: rows * nmixtures rows per stream
+// for weight, variance and mean and rows rows per stream for modesUsed
+template <bool detectShadows, typename SrcT, typename WorkT>
+__global__ void mog2_batch(const PtrStepSzb* frames, const PtrStepSzb* fgmasks, PtrStepb modesUsed,
+                           PtrStepf gmm_weight, PtrStepf gmm_variance, PtrStep<WorkT> gmm_mean,
+                           const float alphaT, const float alpha1, const float prune, const Constants *const constants)
+{
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int y = blockIdx.y * blockDim.y + threadIdx.y;
+    const int z = blockIdx.z;
+
+    const PtrStepSz<SrcT> frame = (PtrStepSz<SrcT>)frames[z];
+
+    if (x < frame.cols && y < frame.rows)
+    {
+        const int modelRows = frame.rows * constants->nmixtures_;
+
+        mog2_pixel<detectShadows>(x, y, frame, fgmasks[z],
+                                  PtrStepb(modesUsed.ptr(z * frame.rows), modesUsed.step),
+                                  PtrStepf(gmm_weight.ptr(z * modelRows), gmm_weight.step),
+                                  PtrStepf(gmm_variance.ptr(z * modelRows), gmm_variance.step),
+                                  PtrStep<WorkT>(gmm_mean.ptr(z * modelRows), gmm_mean.step),
+                                  alphaT, alpha1, prune, constants);
     }
 }
 
@@ -353,6 +385,54 @@ void mog2_gpu(PtrStepSzb frame, int cn, PtrStepSzb fgmask, PtrStepSzb modesUsed,
     funcs[cn](frame, fgmask, modesUsed, weight, variance, mean, alphaT, prune, detectShadows, constants, stream);
 }
 
+template <typename SrcT, typename WorkT>
+void mog2_batch_caller(const PtrStepSzb* frames, const PtrStepSzb* fgmasks, int nstreams, Size frameSize, PtrStepSzb modesUsed,
+                       PtrStepSzf weight, PtrStepSzf variance, PtrStepSzb mean,
+                       float alphaT, float prune, bool detectShadows, const Constants *const constants, cudaStream_t stream)
+{
+    dim3 block(32, 8);
+    dim3 grid(divUp(frameSize.width, block.x), divUp(frameSize.height, block.y), nstreams);
+
+    const float alpha1 = 1.0f - alphaT;
+
+    if (detectShadows)
+    {
+        cudaSafeCall(cudaFuncSetCacheConfig(mog2_batch<true, SrcT, WorkT>, cudaFuncCachePreferL1));
+
+        mog2_batch<true, SrcT, WorkT><<<grid, block, 0, stream>>>(frames, fgmasks, modesUsed,
+                                                                  weight, variance, (PtrStepSz<WorkT>)mean,
+                                                                  alphaT, alpha1, prune, constants);
+    }
+    else
+    {
+        cudaSafeCall(cudaFuncSetCacheConfig(mog2_batch<false, SrcT, WorkT>, cudaFuncCachePreferL1));
+
+        mog2_batch<false, SrcT, WorkT><<<grid, block, 0, stream>>>(frames, fgmasks, modesUsed,
+                                                                   weight, variance, (PtrStepSz<WorkT>)mean,
+                                                                   alphaT, alpha1, prune, constants);
+    }
+
+    cudaSafeCall(cudaGetLastError());
+
+    if (stream == 0)
+        cudaSafeCall(cudaDeviceSynchronize());
+}
+
+void mog2_batch_gpu(const PtrStepSzb* frames, const PtrStepSzb* fgmasks, int nstreams, Size frameSize, int cn, PtrStepSzb modesUsed,
+                    PtrStepSzf weight, PtrStepSzf variance, PtrStepSzb mean,
+                    float alphaT, float prune, bool detectShadows, const Constants *const constants, cudaStream_t stream)
+{
+    typedef void (*func_t)(const PtrStepSzb* frames, const PtrStepSzb* fgmasks, int nstreams, Size frameSize, PtrStepSzb modesUsed,
+                           PtrStepSzf weight, PtrStepSzf variance, PtrStepSzb mean,
+                           float alphaT, float prune, bool detectShadows, const Constants *const constants, cudaStream_t stream);
+
+    static const func_t funcs[] =
+        {
+            0, mog2_batch_caller<uchar, float>, 0, mog2_batch_caller<uchar3, float3>, mog2_batch_caller<uchar4, float4>};
+
+    funcs[cn](frames, fgmasks, nstreams, frameSize, modesUsed, weight, variance, mean, alphaT, prune, detectShadows, constants, stream);
+}
+
 template <typename WorkT, typename OutT>
 __global__ void getBackgroundImage2(const PtrStepSzb modesUsed, const PtrStepf gmm_weight, const PtrStep<WorkT> gmm_mean, PtrStep<OutT> dst, const Constants *const constants)
 {
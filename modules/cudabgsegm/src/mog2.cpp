@@ -55,6 +55,12 @@ Ptr<cuda::BackgroundSubtractorMOG2> cv::cuda::createBackgroundSubtractorMOG2(int
     return Ptr<cuda::BackgroundSubtractorMOG2>();
 }
 
+Ptr<cuda::BackgroundSubtractorMOG2Batch> cv::cuda::createBackgroundSubtractorMOG2Batch(int, int, double, bool)
+{
+    throw_no_cuda();
+    return Ptr<cuda::BackgroundSubtractorMOG2Batch>();
+}
+
 #else
 
 namespace
@@ -74,17 +80,21 @@ const float defaultCT = 0.05f;                // complexity reduction prior cons
 const unsigned char defaultShadowValue = 127; // value to use in the segmentation mask for shadows, set 0 not to do shadow detection
 const float defaultShadowThreshold = 0.5f;    // Tau - shadow threshold, see the paper for explanation
 
-class MOG2Impl CV_FINAL : public cuda::BackgroundSubtractorMOG2
+class MOG2Impl CV_FINAL : public cuda::BackgroundSubtractorMOG2Batch
 {
 public:
-    MOG2Impl(int history, double varThreshold, bool detectShadows);
+    MOG2Impl(int nstreams, int history, double varThreshold, bool detectShadows);
     ~MOG2Impl();
 
     void apply(InputArray image, OutputArray fgmask, double learningRate = -1) CV_OVERRIDE;
     void apply(InputArray image, OutputArray fgmask, double learningRate, Stream &stream) CV_OVERRIDE;
+    void apply(const std::vector<GpuMat>& images, std::vector<GpuMat>& fgmasks, double learningRate, Stream &stream) CV_OVERRIDE;
 
     void getBackgroundImage(OutputArray backgroundImage) const CV_OVERRIDE;
     void getBackgroundImage(OutputArray backgroundImage, Stream &stream) const CV_OVERRIDE;
+    void getBackgroundImage(int idx, OutputArray backgroundImage, Stream &stream) const CV_OVERRIDE;
+
+    int getNumStreams() const CV_OVERRIDE { return nstreams_; }
 
     int getHistory() const CV_OVERRIDE { return history_; }
     void setHistory(int history) CV_OVERRIDE { history_ = history; }
@@ -128,6 +138,8 @@ private:
     Constants constantsHost_;
     Constants *constantsDevice_;
 
+    int nstreams_;
+
     int history_;
     float ct_;
     bool detectShadows_;
@@ -142,10 +154,16 @@ private:
 
     //keep track of number of modes per pixel
     GpuMat bgmodelUsedModes_;
+
+    //frames and masks of a batch, uploaded for every frame set
+    std::vector<PtrStepSzb> batchHeaders_;
+    GpuMat batchHeadersDevice_;
 };
 
-MOG2Impl::MOG2Impl(int history, double varThreshold, bool detectShadows) : frameSize_(0, 0), frameType_(0), nframes_(0)
+MOG2Impl::MOG2Impl(int nstreams, int history, double varThreshold, bool detectShadows) : nstreams_(nstreams), frameSize_(0, 0), frameType_(0), nframes_(0)
 {
+    CV_Assert(nstreams > 0);
+
     history_ = history > 0 ? history : defaultHistory;
     detectShadows_ = detectShadows;
     ct_ = defaultCT;
@@ -178,6 +196,8 @@ void MOG2Impl::apply(InputArray _frame, OutputArray _fgmask, double learningRate
 {
     using namespace cv::cuda::device::mog2;
 
+    CV_Assert(nstreams_ == 1);
+
     GpuMat frame = _frame.getGpuMat();
 
     int ch = frame.channels();
@@ -199,19 +219,70 @@ void MOG2Impl::apply(InputArray _frame, OutputArray _fgmask, double learningRate
              (float)learningRate, static_cast<float>(-learningRate * ct_), detectShadows_, constantsDevice_, StreamAccessor::getStream(stream));
 }
 
+void MOG2Impl::apply(const std::vector<GpuMat>& frames, std::vector<GpuMat>& fgmasks, double learningRate, Stream &stream)
+{
+    using namespace cv::cuda::device::mog2;
+
+    CV_Assert(static_cast<int>(frames.size()) == nstreams_);
+
+    const Size frameSize = frames[0].size();
+    const int frameType = frames[0].type();
+    for (int i = 1; i < nstreams_; ++i)
+        CV_Assert(frames[i].size() == frameSize && frames[i].type() == frameType);
+
+    if (nframes_ == 0 || learningRate >= 1.0 || frameSize != frameSize_ || frameType != frameType_)
+        initialize(frameSize, frameType, stream);
+
+    fgmasks.resize(nstreams_);
+    batchHeaders_.resize(2 * nstreams_);
+    for (int i = 0; i < nstreams_; ++i)
+    {
+        fgmasks[i].create(frameSize_, CV_8UC1);
+        batchHeaders_[i] = frames[i];
+        batchHeaders_[nstreams_ + i] = fgmasks[i];
+    }
+
+    const int headersSize = static_cast<int>(batchHeaders_.size() * sizeof(PtrStepSzb));
+    ensureSizeIsEnough(1, headersSize, CV_8UC1, batchHeadersDevice_);
+    cudaSafeCall(cudaMemcpyAsync(batchHeadersDevice_.data, &batchHeaders_[0], headersSize, cudaMemcpyHostToDevice, StreamAccessor::getStream(stream)));
+
+    ++nframes_;
+    learningRate = learningRate >= 0 && nframes_ > 1 ? learningRate : 1.0 / std::min(2 * nframes_, history_);
+    CV_Assert(learningRate >= 0);
+
+    const PtrStepSzb* headers = batchHeadersDevice_.ptr<PtrStepSzb>();
+    mog2_batch_gpu(headers, headers + nstreams_, nstreams_, frameSize_, CV_MAT_CN(frameType_), bgmodelUsedModes_, weight_, variance_, mean_,
+                   (float)learningRate, static_cast<float>(-learningRate * ct_), detectShadows_, constantsDevice_, StreamAccessor::getStream(stream));
+}
+
 void MOG2Impl::getBackgroundImage(OutputArray backgroundImage) const
 {
     getBackgroundImage(backgroundImage, Stream::Null());
 }
 
 void MOG2Impl::getBackgroundImage(OutputArray _backgroundImage, Stream &stream) const
+{
+    CV_Assert(nstreams_ == 1);
+
+    getBackgroundImage(0, _backgroundImage, stream);
+}
+
+void MOG2Impl::getBackgroundImage(int idx, OutputArray _backgroundImage, Stream &stream) const
 {
     using namespace cv::cuda::device::mog2;
 
+    CV_Assert(idx >= 0 && idx < nstreams_);
+
     _backgroundImage.create(frameSize_, frameType_);
     GpuMat backgroundImage = _backgroundImage.getGpuMat();
 
-    getBackgroundImage2_gpu(backgroundImage.channels(), bgmodelUsedModes_, weight_, mean_, backgroundImage, constantsDevice_, StreamAccessor::getStream(stream));
+    // models of the stream idx
+    const int modelRows = frameSize_.height * getNMixtures();
+    const GpuMat modesUsed = bgmodelUsedModes_.rowRange(idx * frameSize_.height, (idx + 1) * frameSize_.height);
+    const GpuMat weight = weight_.rowRange(idx * modelRows, (idx + 1) * modelRows);
+    const GpuMat mean = mean_.rowRange(idx * modelRows, (idx + 1) * modelRows);
+
+    getBackgroundImage2_gpu(backgroundImage.channels(), modesUsed, weight, mean, backgroundImage, constantsDevice_, StreamAccessor::getStream(stream));
 }
 
 void MOG2Impl::initialize(cv::Size frameSize, int frameType, Stream &stream)
@@ -231,12 +302,13 @@ void MOG2Impl::initialize(cv::Size frameSize, int frameType, Stream &stream)
     // the mixture weight (w),
     // the mean (nchannels values) and
     // the covariance
-    weight_.create(frameSize.height * getNMixtures(), frameSize_.width, CV_32FC1);
-    variance_.create(frameSize.height * getNMixtures(), frameSize_.width, CV_32FC1);
-    mean_.create(frameSize.height * getNMixtures(), frameSize_.width, CV_32FC(work_ch));
+    // the models of the streams of a batch are stacked vertically
+    weight_.create(nstreams_ * frameSize.height * getNMixtures(), frameSize_.width, CV_32FC1);
+    variance_.create(nstreams_ * frameSize.height * getNMixtures(), frameSize_.width, CV_32FC1);
+    mean_.create(nstreams_ * frameSize.height * getNMixtures(), frameSize_.width, CV_32FC(work_ch));
 
     //make the array for keeping track of the used modes per pixel - all zeros at start
-    bgmodelUsedModes_.create(frameSize_, CV_8UC1);
+    bgmodelUsedModes_.create(nstreams_ * frameSize_.height, frameSize_.width, CV_8UC1);
     bgmodelUsedModes_.setTo(Scalar::all(0));
 
     cudaSafeCall(cudaMemcpyAsync(constantsDevice_, &constantsHost_, sizeof(Constants), cudaMemcpyHostToDevice, StreamAccessor::getStream(stream)));
@@ -245,7 +317,12 @@ void MOG2Impl::initialize(cv::Size frameSize, int frameType, Stream &stream)
 
 Ptr<cuda::BackgroundSubtractorMOG2> cv::cuda::createBackgroundSubtractorMOG2(int history, double varThreshold, bool detectShadows)
 {
-    return makePtr<MOG2Impl>(history, varThreshold, detectShadows);
+    return makePtr<MOG2Impl>(1, history, varThreshold, detectShadows);
+}
+
+Ptr<cuda::BackgroundSubtractorMOG2Batch> cv::cuda::createBackgroundSubtractorMOG2Batch(int nstreams, int history, double varThreshold, bool detectShadows)
+{
+    return makePtr<MOG2Impl>(nstreams, history, varThreshold, detectShadows);
 }
 
 #endif
@@ -151,6 +151,67 @@ CUDA_TEST_P(MOG2, getBackgroundImage)
     ASSERT_MAT_NEAR(background_gold, background, 1);
 }
 
+CUDA_TEST_P(MOG2, Batch)
+{
+    cv::VideoCapture cap(inputFile);
+    ASSERT_TRUE(cap.isOpened());
+
+    const int nstreams = 3;
+
+    cv::Ptr<cv::cuda::BackgroundSubtractorMOG2Batch> mog2_batch = cv::cuda::createBackgroundSubtractorMOG2Batch(nstreams);
+    mog2_batch->setDetectShadows(detectShadow);
+    ASSERT_EQ(nstreams, mog2_batch->getNumStreams());
+
+    std::vector<cv::Ptr<cv::cuda::BackgroundSubtractorMOG2> > mog2(nstreams);
+    for (int k = 0; k < nstreams; ++k)
+    {
+        mog2[k] = cv::cuda::createBackgroundSubtractorMOG2();
+        mog2[k]->setDetectShadows(detectShadow);
+    }
+
+    cv::Mat frame;
+    std::vector<cv::cuda::GpuMat> frames(nstreams), foregrounds;
+    cv::cuda::GpuMat foreground;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        cap >> frame;
+        ASSERT_FALSE(frame.empty());
+
+        if (useGray)
+        {
+            cv::Mat temp;
+            cv::cvtColor(frame, temp, cv::COLOR_BGR2GRAY);
+            cv::swap(temp, frame);
+        }
+
+        // every stream sees a different view of the video
+        for (int k = 0; k < nstreams; ++k)
+        {
+            cv::Mat view;
+            cv::flip(frame, view, k - 1);
+            frames[k] = loadMat(view, useRoi);
+        }
+
+        mog2_batch->apply(frames, foregrounds, -1, cv::cuda::Stream::Null());
+        ASSERT_EQ(static_cast<size_t>(nstreams), foregrounds.size());
+
+        for (int k = 0; k < nstreams; ++k)
+        {
+            mog2[k]->apply(frames[k], foreground);
+            ASSERT_MAT_NEAR(foreground, foregrounds[k], 0);
+        }
+    }
+
+    for (int k = 0; k < nstreams; ++k)
+    {
+        cv::cuda::GpuMat background, background_batch;
+        mog2[k]->getBackgroundImage(background);
+        mog2_batch->getBackgroundImage(k, background_batch, cv::cuda::Stream::Null());
+        ASSERT_MAT_NEAR(background, background_batch, 0);
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(CUDA_BgSegm, MOG2, testing::Combine(
     ALL_DEVICES,
     testing::Values(std::string("768x576.avi")),
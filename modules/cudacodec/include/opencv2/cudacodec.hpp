@@ -103,6 +103,7 @@ struct CV_EXPORTS_W EncoderParams
     int DisableCabac;    //!< NVVE_DISABLE_CABAC,
     int NaluFramingType; //!< NVVE_CONFIGURE_NALU_FRAMING_TYPE
     int DisableSPSPPS;   //!< NVVE_DISABLE_SPS_PPS
+    int InFlightFrames;  //!< Number of input surfaces VideoWriter::write with a stream may fill ahead of the encoder.
 
     EncoderParams();
     /** @brief Constructors.
@@ -189,6 +190,22 @@ public:
      */
     CV_WRAP virtual void write(InputArray frame, bool lastFrame = false) = 0;
 
+    /** @brief Queues the next video frame for encoding.
+
+    @param frame The written frame, it must be a GpuMat.
+    @param stream Stream the frame is converted or copied on to an input surface of the encoder.
+    @param lastFrame Indicates that it is end of stream.
+
+    The method returns once the copy is queued. Up to EncoderParams::InFlightFrames frames wait for the encoder,
+    beyond that the method blocks until a surface is free. The frames are encoded on a worker thread in the order
+    of the calls, the EncoderCallBack methods are called from that thread.
+     */
+    virtual void write(InputArray frame, Stream& stream, bool lastFrame = false) = 0;
+
+    /** @brief Blocks until all queued frames are encoded.
+     */
+    CV_WRAP virtual void flush() = 0;
+
     CV_WRAP virtual EncoderParams getEncoderParams() const = 0;
 };
 
@@ -302,12 +319,26 @@ public:
 
     If no frames has been grabbed (there are no more frames in video file), the methods return false .
     The method throws Exception if error occurs.
+
+    The frame has the format selected by VideoReaderInitParams::colorFormat . With VideoReaderInitParams::zeroCopy
+    it is a view of the decoder surface which is only valid until the next call.
      */
     CV_WRAP virtual bool nextFrame(CV_OUT GpuMat& frame, Stream &stream = Stream::Null()) = 0;
 
     /** @brief Returns information about video file format.
     */
     virtual FormatInfo format() const = 0;
+
+    /** @brief Moves the reader to a timestamp.
+
+    @param timestampMs Position in milliseconds from the start of the video.
+
+    Frames decoded before the call are dropped and the decoder is reset. Decoding resumes at the first key frame at or
+    after the timestamp, which is exact for the H.264, HEVC, VP8 and MJPEG codecs; for other codecs it starts at the
+    packet the source lands on. Returns false if the video source can not seek, decoding then resumes at the next key
+    frame of the current position.
+     */
+    CV_WRAP virtual bool seek(double timestampMs) = 0;
 };
 
 /** @brief Interface for video demultiplexing. :
@@ -329,19 +360,118 @@ public:
     /** @brief Returns information about video file format.
     */
     virtual FormatInfo format() const = 0;
+
+    /** @brief Moves the source to a timestamp, so that the next packet is at or after it.
+
+    @param timestampMs Position in milliseconds from the start of the video.
+
+    The default implementation does not support seeking and returns false, the position of the source must not change
+    then.
+     */
+    virtual bool seek(double timestampMs) { CV_UNUSED(timestampMs); return false; }
+};
+
+/** @brief Formats of the frames returned by cudacodec::VideoReader::nextFrame .
+ */
+enum ColorFormat
+{
+    BGRA = 1, //!< 8 bit 4 channel BGR image with opaque alpha.
+    BGR  = 2, //!< 8 bit 3 channel BGR image.
+    GRAY = 3, //!< 8 bit single channel image holding the luma plane of the decoded frame.
+    NV12 = 4, //!< Decoded frame as is: single channel image of height*3/2 rows, the luma plane followed by interleaved UV rows.
+    YUV  = 5  //!< Planar 4:2:0 YUV (I420) in a single channel image of height*3/2 rows. The luma plane is followed by
+              //!< the U and V planes, both of them with a row pitch of half the step of the image.
+};
+
+/** @brief Sizes of the decoding pipeline and output format of a video reader.
+
+Deep buffered streams benefit from more decode surfaces, while readers running many streams at once
+may reduce both values to save device memory.
+ */
+struct CV_EXPORTS_W_SIMPLE VideoReaderInitParams
+{
+    CV_WRAP VideoReaderInitParams() : decodeSurfaces(20), displayQueueSize(20), colorFormat(BGRA), zeroCopy(false), keyFramesOnly(false) {}
+
+    //! Number of surfaces allocated by the hardware decoder. It bounds how far decoding may get ahead of nextFrame().
+    CV_PROP_RW int decodeSurfaces;
+    //! Capacity of the queue of decoded frames waiting for nextFrame().
+    CV_PROP_RW int displayQueueSize;
+    //! Format of the returned frames.
+    CV_PROP_RW ColorFormat colorFormat;
+    /** Return the mapped decoder surface instead of a copy, only supported with cudacodec::NV12 and cudacodec::GRAY.
+    The returned frame is a view of memory owned by the decoder: it stays valid until the next call of nextFrame() or
+    the destruction of the reader, and keeps its decode surface from being reused until then.
+    */
+    CV_PROP_RW bool zeroCopy;
+    /** Only decode the key frames of the video, the other packets are dropped before reaching the decoder.
+    Supported with the H.264, HEVC, VP8 and MJPEG codecs and sources returning whole frames as packets.
+    */
+    CV_PROP_RW bool keyFramesOnly;
 };
 
 /** @brief Creates video reader.
 
 @param filename Name of the input video file.
+@param params Sizes of the decoding pipeline and output format.
 
 FFMPEG is used to read videos. User can implement own demultiplexing with cudacodec::RawVideoSource
  */
-CV_EXPORTS_W Ptr<VideoReader> createVideoReader(const String& filename);
+CV_EXPORTS_W Ptr<VideoReader> createVideoReader(const String& filename, const VideoReaderInitParams& params = VideoReaderInitParams());
 /** @overload
 @param source RAW video source implemented by user.
+@param params Sizes of the decoding pipeline and output format.
 */
-CV_EXPORTS_W Ptr<VideoReader> createVideoReader(const Ptr<RawVideoSource>& source);
+CV_EXPORTS_W Ptr<VideoReader> createVideoReader(const Ptr<RawVideoSource>& source, const VideoReaderInitParams& params = VideoReaderInitParams());
+
+/** @brief Video reader decoding many streams over a shared CUDA context and a small pool of worker threads.
+
+Instead of one reader thread per stream, the workers feed the packets of the streams to their decoders in turn,
+skipping streams whose decoded frames are not consumed yet. nextFrame() returns the next decoded frame of any stream,
+serving the streams round robin.
+
+@note Each stream still has its own hardware decoder session, as the reference frames of a stream live in the
+surfaces of its decoder.
+ */
+class CV_EXPORTS_W MultiStreamVideoReader
+{
+public:
+    virtual ~MultiStreamVideoReader() {}
+
+    /** @brief Adds a video file, decoding starts at once.
+
+    @param filename Name of the input video file, it is demultiplexed with FFMPEG.
+    @return Index of the stream.
+     */
+    CV_WRAP virtual int addStream(const String& filename) = 0;
+    /** @overload
+    @param source RAW video source implemented by user.
+    */
+    virtual int addStream(const Ptr<RawVideoSource>& source) = 0;
+
+    /** @brief Returns the next decoded frame of any stream.
+
+    @param frame Decoded frame in the format selected by VideoReaderInitParams::colorFormat .
+    @param streamIdx Index of the stream the frame belongs to.
+    @param stream Stream for the asynchronous version.
+
+    The method blocks until a frame is decoded. It returns false when all the streams have ended.
+     */
+    CV_WRAP virtual bool nextFrame(CV_OUT GpuMat& frame, CV_OUT int& streamIdx, Stream &stream = Stream::Null()) = 0;
+
+    /** @brief Returns information about the video format of a stream.
+    */
+    virtual FormatInfo format(int streamIdx) const = 0;
+
+    //! Number of the added streams.
+    CV_WRAP virtual int getNumStreams() const = 0;
+};
+
+/** @brief Creates a multi stream video reader.
+
+@param numWorkers Number of threads feeding the decoders.
+@param params Sizes of the decoding pipeline and output format, used for every stream.
+ */
+CV_EXPORTS_W Ptr<MultiStreamVideoReader> createMultiStreamVideoReader(int numWorkers = 2, const VideoReaderInitParams& params = VideoReaderInitParams());
 
 //! @}
 
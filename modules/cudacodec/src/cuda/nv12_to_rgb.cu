@@ -61,6 +61,8 @@ using namespace cv;
 using namespace cv::cudev;
 
 void videoDecPostProcessFrame(const GpuMat& decodedFrame, GpuMat& _outFrame, int width, int height, cudaStream_t stream);
+void videoDecPostProcessFrameBGR(const GpuMat& decodedFrame, GpuMat& _outFrame, int width, int height, cudaStream_t stream);
+void videoDecNV12ToYUV(const GpuMat& decodedFrame, GpuMat& _outFrame, int width, int height, cudaStream_t stream);
 
 namespace
 {
@@ -107,13 +109,19 @@ namespace
         return ARGBpixel;
     }
 
-    // CUDA kernel for outputting the final ARGB output from NV12
+    __device__ static uchar clamp_10bit_to_8bit(float value)
+    {
+        return (uchar)((uint)::fmin(::fmax(value, 0.0f), 1023.f) >> 2);
+    }
+
+    // CUDA kernel for outputting the final ARGB (or BGR with packed == false) output from NV12
 
     #define COLOR_COMPONENT_BIT_SIZE 10
     #define COLOR_COMPONENT_MASK     0x3FF
 
+    template <bool packed>
     __global__ void NV12_to_RGB(const uchar* srcImage, size_t nSourcePitch,
-                                  uint* dstImage, size_t nDestPitch,
+                                  uchar* dstImage, size_t nDestPitch,
                                   uint width, uint height)
     {
         // Pad borders with duplicate pixels, and we multiply by 2 because we process 2 pixels per thread
@@ -179,25 +187,93 @@ namespace
 
         // Clamp the results to RGBA
 
-        const size_t dstImagePitch = nDestPitch >> 2;
+        if (packed)
+        {
+            uint* dstRow = (uint*)(dstImage + y * nDestPitch);
+
+            dstRow[x    ] = RGBA_pack_10bit(red[0], green[0], blue[0], ((uint)0xff << 24));
+            dstRow[x + 1] = RGBA_pack_10bit(red[1], green[1], blue[1], ((uint)0xff << 24));
+        }
+        else
+        {
+            uchar* dstRow = dstImage + y * nDestPitch + x * 3;
+
+            for (int i = 0; i < 2; ++i)
+            {
+                dstRow[i * 3    ] = clamp_10bit_to_8bit(blue[i]);
+                dstRow[i * 3 + 1] = clamp_10bit_to_8bit(green[i]);
+                dstRow[i * 3 + 2] = clamp_10bit_to_8bit(red[i]);
+            }
+        }
+    }
+
+    // Splits the interleaved UV rows of NV12 into the U and V planes of I420, each thread moves one chroma sample
+    __global__ void NV12_UV_to_planar(const uchar* srcChroma, size_t nSourcePitch,
+                                      uchar* dstU, uchar* dstV, size_t nPlanePitch,
+                                      uint chromaWidth, uint chromaHeight)
+    {
+        const int x = blockIdx.x * blockDim.x + threadIdx.x;
+        const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+        if (x >= chromaWidth || y >= chromaHeight)
+            return;
+
+        const uchar* src = srcChroma + y * nSourcePitch + (x << 1);
+
+        dstU[y * nPlanePitch + x] = src[0];
+        dstV[y * nPlanePitch + x] = src[1];
+    }
+
+    template <bool packed>
+    void NV12_to_RGB_caller(const GpuMat& decodedFrame, GpuMat& outFrame, int width, int height, cudaStream_t stream)
+    {
+        outFrame.create(height, width, packed ? CV_8UC4 : CV_8UC3);
+
+        dim3 block(32, 8);
+        dim3 grid(divUp(width, 2 * block.x), divUp(height, block.y));
+
+        NV12_to_RGB<packed><<<grid, block, 0, stream>>>(decodedFrame.ptr<uchar>(), decodedFrame.step,
+                                     outFrame.ptr<uchar>(), outFrame.step,
+                                     width, height);
 
-        dstImage[y * dstImagePitch + x     ] = RGBA_pack_10bit(red[0], green[0], blue[0], ((uint)0xff << 24));
-        dstImage[y * dstImagePitch + x + 1 ] = RGBA_pack_10bit(red[1], green[1], blue[1], ((uint)0xff << 24));
+        CV_CUDEV_SAFE_CALL( cudaGetLastError() );
+        if (stream == 0)
+          CV_CUDEV_SAFE_CALL( cudaDeviceSynchronize() );
     }
 }
 
 void videoDecPostProcessFrame(const GpuMat& decodedFrame, GpuMat& outFrame, int width, int height, cudaStream_t stream)
 {
     // Final Stage: NV12toARGB color space conversion
+    NV12_to_RGB_caller<true>(decodedFrame, outFrame, width, height, stream);
+}
+
+void videoDecPostProcessFrameBGR(const GpuMat& decodedFrame, GpuMat& outFrame, int width, int height, cudaStream_t stream)
+{
+    NV12_to_RGB_caller<false>(decodedFrame, outFrame, width, height, stream);
+}
+
+void videoDecNV12ToYUV(const GpuMat& decodedFrame, GpuMat& outFrame, int width, int height, cudaStream_t stream)
+{
+    outFrame.create(height * 3 / 2, width, CV_8UC1);
+
+    // luma plane is the same in both layouts
+    CV_CUDEV_SAFE_CALL( cudaMemcpy2DAsync(outFrame.data, outFrame.step, decodedFrame.data, decodedFrame.step,
+                                          width, height, cudaMemcpyDeviceToDevice, stream) );
+
+    const int chromaWidth = width / 2;
+    const int chromaHeight = height / 2;
+    const size_t planePitch = outFrame.step / 2;
 
-    outFrame.create(height, width, CV_8UC4);
+    uchar* dstU = outFrame.ptr<uchar>(height);
+    uchar* dstV = dstU + chromaHeight * planePitch;
 
     dim3 block(32, 8);
-    dim3 grid(divUp(width, 2 * block.x), divUp(height, block.y));
+    dim3 grid(divUp(chromaWidth, block.x), divUp(chromaHeight, block.y));
 
-    NV12_to_RGB<<<grid, block, 0, stream>>>(decodedFrame.ptr<uchar>(), decodedFrame.step,
-                                 outFrame.ptr<uint>(), outFrame.step,
-                                 width, height);
+    NV12_UV_to_planar<<<grid, block, 0, stream>>>(decodedFrame.ptr<uchar>(height), decodedFrame.step,
+                                                  dstU, dstV, planePitch,
+                                                  chromaWidth, chromaHeight);
 
     CV_CUDEV_SAFE_CALL( cudaGetLastError() );
     if (stream == 0)
@@ -52,7 +52,7 @@
 
 using namespace cv::cudev;
 
-void RGB_to_YV12(const GpuMat& src, GpuMat& dst);
+void RGB_to_YV12(const GpuMat& src, GpuMat& dst, cudaStream_t stream);
 
 namespace
 {
@@ -142,7 +142,7 @@ namespace
     }
 }
 
-void RGB_to_YV12(const GpuMat& src, GpuMat& dst)
+void RGB_to_YV12(const GpuMat& src, GpuMat& dst, cudaStream_t stream)
 {
     const dim3 block(32, 8);
     const dim3 grid(divUp(src.cols, block.x * 2), divUp(src.rows, block.y * 2));
@@ -150,18 +150,19 @@ void RGB_to_YV12(const GpuMat& src, GpuMat& dst)
     switch (src.channels())
     {
     case 1:
-        Gray_to_YV12<<<grid, block>>>(globPtr<uchar>(src), globPtr<uchar>(dst));
+        Gray_to_YV12<<<grid, block, 0, stream>>>(globPtr<uchar>(src), globPtr<uchar>(dst));
         break;
     case 3:
-        RGB_to_YV12<<<grid, block>>>(globPtr<uchar3>(src), globPtr<uchar>(dst));
+        RGB_to_YV12<<<grid, block, 0, stream>>>(globPtr<uchar3>(src), globPtr<uchar>(dst));
         break;
     case 4:
-        RGB_to_YV12<<<grid, block>>>(globPtr<uchar4>(src), globPtr<uchar>(dst));
+        RGB_to_YV12<<<grid, block, 0, stream>>>(globPtr<uchar4>(src), globPtr<uchar>(dst));
         break;
     }
 
     CV_CUDEV_SAFE_CALL( cudaGetLastError() );
-    CV_CUDEV_SAFE_CALL( cudaDeviceSynchronize() );
+    if (stream == 0)
+        CV_CUDEV_SAFE_CALL( cudaDeviceSynchronize() );
 }
 
 #endif
@@ -153,4 +153,10 @@ bool cv::cudacodec::detail::FFmpegVideoSource::getNextPacket(unsigned char** dat
     return *size != 0;
 }
 
+bool cv::cudacodec::detail::FFmpegVideoSource::seek(double timestampMs)
+{
+    // the backend seeks to the preceding key frame and reads on up to the timestamp
+    return cap.set(CAP_PROP_POS_MSEC, timestampMs);
+}
+
 #endif // HAVE_CUDA
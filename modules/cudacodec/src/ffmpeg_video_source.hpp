@@ -58,6 +58,8 @@ public:
 
     FormatInfo format() const CV_OVERRIDE;
 
+    bool seek(double timestampMs) CV_OVERRIDE;
+
 private:
     FormatInfo format_;
     VideoCapture cap;
@@ -45,74 +45,101 @@
 
 #ifdef HAVE_NVCUVID
 
-cv::cudacodec::detail::FrameQueue::FrameQueue() :
-    endOfDecode_(0),
+cv::cudacodec::detail::FrameQueue::FrameQueue(int maxDecodeSurfaces, int displayQueueSize) :
+    isFrameInUse_(maxDecodeSurfaces, false),
+    endOfDecode_(false),
     framesInQueue_(0),
     readPosition_(0)
 {
-    std::memset(displayQueue_, 0, sizeof(displayQueue_));
-    std::memset((void*) isFrameInUse_, 0, sizeof(isFrameInUse_));
+    CV_Assert(maxDecodeSurfaces > 0 && displayQueueSize > 0);
+    CUVIDPARSERDISPINFO empty;
+    std::memset(&empty, 0, sizeof(empty));
+    displayQueue_.assign(displayQueueSize, empty);
 }
 
-bool cv::cudacodec::detail::FrameQueue::waitUntilFrameAvailable(int pictureIndex)
+void cv::cudacodec::detail::FrameQueue::endDecode()
 {
-    while (isInUse(pictureIndex))
     {
-        // Decoder is getting too far ahead from display
-        Thread::sleep(1);
-
-        if (isEndOfDecode())
-            return false;
+        std::lock_guard<std::mutex> lock(mtx_);
+        endOfDecode_ = true;
     }
+    cond_.notify_all();
+}
 
-    return true;
+bool cv::cudacodec::detail::FrameQueue::isEndOfDecode() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    return endOfDecode_;
+}
+
+bool cv::cudacodec::detail::FrameQueue::isFull() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    return framesInQueue_ >= (int)displayQueue_.size();
+}
+
+bool cv::cudacodec::detail::FrameQueue::waitUntilFrameAvailable(int pictureIndex)
+{
+    CV_Assert(pictureIndex >= 0 && pictureIndex < (int)isFrameInUse_.size());
+
+    // Decoder is getting too far ahead from display
+    std::unique_lock<std::mutex> lock(mtx_);
+    cond_.wait(lock, [&] { return !isFrameInUse_[pictureIndex] || endOfDecode_; });
+
+    return !isFrameInUse_[pictureIndex];
 }
 
 void cv::cudacodec::detail::FrameQueue::enqueue(const CUVIDPARSERDISPINFO* picParams)
 {
-    // Mark the frame as 'in-use' so we don't re-use it for decoding until it is no longer needed
-    // for display
-    isFrameInUse_[picParams->picture_index] = true;
+    CV_Assert(picParams->picture_index >= 0 && picParams->picture_index < (int)isFrameInUse_.size());
+    const int queueSize = (int)displayQueue_.size();
 
-    // Wait until we have a free entry in the display queue (should never block if we have enough entries)
-    do
     {
-        bool isFramePlaced = false;
-
-        {
-            AutoLock autoLock(mtx_);
-
-            if (framesInQueue_ < MaximumSize)
-            {
-                int writePosition = (readPosition_ + framesInQueue_) % MaximumSize;
-                displayQueue_[writePosition] = *picParams;
-                framesInQueue_++;
-                isFramePlaced = true;
-            }
-        }
-
-        if (isFramePlaced) // Done
-            break;
-
-        // Wait a bit
-        Thread::sleep(1);
-    } while (!isEndOfDecode());
+        std::unique_lock<std::mutex> lock(mtx_);
+
+        // Mark the frame as 'in-use' so we don't re-use it for decoding until it is no longer needed
+        // for display
+        isFrameInUse_[picParams->picture_index] = true;
+
+        // Wait until we have a free entry in the display queue (should never block if we have enough entries)
+        cond_.wait(lock, [&] { return framesInQueue_ < queueSize || endOfDecode_; });
+        if (framesInQueue_ >= queueSize)
+            return;
+
+        int writePosition = (readPosition_ + framesInQueue_) % queueSize;
+        displayQueue_[writePosition] = *picParams;
+        framesInQueue_++;
+    }
+    cond_.notify_all();
 }
 
-bool cv::cudacodec::detail::FrameQueue::dequeue(CUVIDPARSERDISPINFO& displayInfo)
+bool cv::cudacodec::detail::FrameQueue::dequeue(CUVIDPARSERDISPINFO& displayInfo, int timeoutMs)
 {
-    AutoLock autoLock(mtx_);
-
-    if (framesInQueue_ > 0)
     {
+        std::unique_lock<std::mutex> lock(mtx_);
+
+        if (timeoutMs > 0)
+            cond_.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] { return framesInQueue_ > 0 || endOfDecode_; });
+
+        if (framesInQueue_ == 0)
+            return false;
+
         int entry = readPosition_;
         displayInfo = displayQueue_[entry];
-        readPosition_ = (entry + 1) % MaximumSize;
+        readPosition_ = (entry + 1) % (int)displayQueue_.size();
         framesInQueue_--;
-        return true;
     }
+    cond_.notify_all();
+    return true;
+}
 
-    return false;
+void cv::cudacodec::detail::FrameQueue::releaseFrame(const CUVIDPARSERDISPINFO& picParams)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        isFrameInUse_[picParams.picture_index] = false;
+    }
+    cond_.notify_all();
 }
 
 #endif // HAVE_NVCUVID
@@ -45,48 +45,57 @@
 #define __FRAME_QUEUE_HPP__
 
 #include "opencv2/core/utility.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <vector>
 
 namespace cv { namespace cudacodec { namespace detail {
 
 class FrameQueue
 {
 public:
-    static const int MaximumSize = 20; // MAX_FRM_CNT;
+    // Parameters:
+    //      maxDecodeSurfaces - count of the decoder surfaces, picture indices are below it.
+    //      displayQueueSize - capacity of the queue of frames waiting for display.
+    FrameQueue(int maxDecodeSurfaces, int displayQueueSize);
 
-    FrameQueue();
+    void endDecode();
+    bool isEndOfDecode() const;
 
-    void endDecode() { endOfDecode_ = true; }
-    bool isEndOfDecode() const { return endOfDecode_ != 0;}
+    // True when enqueue() would block on the display queue.
+    bool isFull() const;
 
-    // Spins until frame becomes available or decoding gets canceled.
+    // Blocks until frame becomes available or decoding gets canceled.
     // If the requested frame is available the method returns true.
     // If decoding was interrupted before the requested frame becomes
     // available, the method returns false.
     bool waitUntilFrameAvailable(int pictureIndex);
 
+    // Blocks while the display queue is full, unless decoding gets canceled.
     void enqueue(const CUVIDPARSERDISPINFO* picParams);
 
     // Deque the next frame.
     // Parameters:
     //      displayInfo - New frame info gets placed into this object.
+    //      timeoutMs - how long to wait for a frame, 0 returns at once.
     // Returns:
     //      true, if a new frame was returned,
-    //      false, if the queue was empty and no new frame could be returned.
-    bool dequeue(CUVIDPARSERDISPINFO& displayInfo);
+    //      false, if the queue stayed empty or decoding ended and no new frame could be returned.
+    bool dequeue(CUVIDPARSERDISPINFO& displayInfo, int timeoutMs = 0);
 
-    void releaseFrame(const CUVIDPARSERDISPINFO& picParams) { isFrameInUse_[picParams.picture_index] = false; }
+    void releaseFrame(const CUVIDPARSERDISPINFO& picParams);
 
 private:
-    bool isInUse(int pictureIndex) const { return isFrameInUse_[pictureIndex] != 0; }
-
-    Mutex mtx_;
+    mutable std::mutex mtx_;
+    // notified when a frame is released, queued or dequeued and on the end of decode
+    std::condition_variable cond_;
 
-    volatile int isFrameInUse_[MaximumSize];
-    volatile int endOfDecode_;
+    std::vector<bool> isFrameInUse_;
+    bool endOfDecode_;
 
     int framesInQueue_;
     int readPosition_;
-    CUVIDPARSERDISPINFO displayQueue_[MaximumSize];
+    std::vector<CUVIDPARSERDISPINFO> displayQueue_;
 };
 
 }}}
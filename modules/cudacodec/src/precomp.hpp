@@ -44,10 +44,13 @@
 #ifndef OPENCV_PRECOMP_H
 #define OPENCV_PRECOMP_H
 
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
 #include <deque>
+#include <mutex>
 #include <utility>
+#include <vector>
 #include <stdexcept>
 #include <iostream>
 
@@ -49,7 +49,8 @@ namespace cv { namespace cudacodec { namespace detail {
 class VideoDecoder
 {
 public:
-    VideoDecoder(const FormatInfo& videoFormat, CUcontext ctx, CUvideoctxlock lock) : ctx_(ctx), lock_(lock), decoder_(0)
+    VideoDecoder(const FormatInfo& videoFormat, CUcontext ctx, CUvideoctxlock lock, int numDecodeSurfaces) :
+        lock_(lock), ctx_(ctx), decoder_(0), numDecodeSurfaces_(numDecodeSurfaces)
     {
         create(videoFormat);
     }
@@ -102,6 +103,7 @@ private:
     CUcontext ctx_;
     CUVIDDECODECREATEINFO createInfo_;
     CUvideodecoder        decoder_;
+    int numDecodeSurfaces_;
 };
 
 }}}
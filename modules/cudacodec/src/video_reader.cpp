@@ -48,27 +48,189 @@ using namespace cv::cudacodec;
 
 #ifndef HAVE_NVCUVID
 
-Ptr<VideoReader> cv::cudacodec::createVideoReader(const String&) { throw_no_cuda(); return Ptr<VideoReader>(); }
-Ptr<VideoReader> cv::cudacodec::createVideoReader(const Ptr<RawVideoSource>&) { throw_no_cuda(); return Ptr<VideoReader>(); }
+Ptr<VideoReader> cv::cudacodec::createVideoReader(const String&, const VideoReaderInitParams&) { throw_no_cuda(); return Ptr<VideoReader>(); }
+Ptr<VideoReader> cv::cudacodec::createVideoReader(const Ptr<RawVideoSource>&, const VideoReaderInitParams&) { throw_no_cuda(); return Ptr<VideoReader>(); }
+Ptr<MultiStreamVideoReader> cv::cudacodec::createMultiStreamVideoReader(int, const VideoReaderInitParams&) { throw_no_cuda(); return Ptr<MultiStreamVideoReader>(); }
 
 #else // HAVE_NVCUVID
 
 void videoDecPostProcessFrame(const GpuMat& decodedFrame, GpuMat& _outFrame, int width, int height, cudaStream_t stream);
+void videoDecPostProcessFrameBGR(const GpuMat& decodedFrame, GpuMat& _outFrame, int width, int height, cudaStream_t stream);
+void videoDecNV12ToYUV(const GpuMat& decodedFrame, GpuMat& _outFrame, int width, int height, cudaStream_t stream);
 
 using namespace cv::cudacodec::detail;
 
 namespace
 {
+    class VideoCtxAutoLock
+    {
+    public:
+        VideoCtxAutoLock(CUvideoctxlock lock) : m_lock(lock) { cuSafeCall( cuvidCtxLock(m_lock, 0) ); }
+        ~VideoCtxAutoLock() { cuvidCtxUnlock(m_lock, 0); }
+
+    private:
+        CUvideoctxlock m_lock;
+    };
+
+    typedef std::deque< std::pair<CUVIDPARSERDISPINFO, CUVIDPROCPARAMS> > FieldQueue;
+
+    void queueFields(const CUVIDPARSERDISPINFO& displayInfo, FieldQueue& frames)
+    {
+        bool isProgressive = displayInfo.progressive_frame != 0;
+        const int num_fields = isProgressive ? 1 : 2 + displayInfo.repeat_first_field;
+
+        for (int active_field = 0; active_field < num_fields; ++active_field)
+        {
+            CUVIDPROCPARAMS videoProcParams;
+            std::memset(&videoProcParams, 0, sizeof(CUVIDPROCPARAMS));
+
+            videoProcParams.progressive_frame = displayInfo.progressive_frame;
+            videoProcParams.second_field      = active_field;
+            videoProcParams.top_field_first   = displayInfo.top_field_first;
+            videoProcParams.unpaired_field    = (num_fields == 1);
+
+            frames.push_back(std::make_pair(displayInfo, videoProcParams));
+        }
+    }
+
+    // Maps decoded fields and hands them out in the requested color format
+    class FrameOutput
+    {
+    public:
+        explicit FrameOutput(const VideoReaderInitParams& params);
+
+        // Outputs the first field of frames and pops it
+        void outputFrame(VideoDecoder& decoder, FrameQueue& frameQueue, CUvideoctxlock lock, FieldQueue& frames,
+                         GpuMat& frame, Stream& stream);
+
+        // Gives the surface of the last zero copy frame back to its decoder
+        void releaseMappedFrame();
+
+    private:
+        void convertFrame(const GpuMat& decodedFrame, GpuMat& frame, int width, int height, Stream& stream) const;
+
+        ColorFormat colorFormat_;
+        bool zeroCopy_;
+
+        // surface handed out by the last zero copy outputFrame()
+        GpuMat mappedFrame_;
+        CUVIDPARSERDISPINFO mappedInfo_;
+        bool releaseMappedInfo_;
+        VideoDecoder* mappedDecoder_;
+        FrameQueue* mappedQueue_;
+        CUvideoctxlock mappedLock_;
+    };
+
+    FrameOutput::FrameOutput(const VideoReaderInitParams& params) :
+        colorFormat_(params.colorFormat),
+        zeroCopy_(params.zeroCopy),
+        releaseMappedInfo_(false),
+        mappedDecoder_(0),
+        mappedQueue_(0),
+        mappedLock_(0)
+    {
+        CV_Assert(params.decodeSurfaces > 0 && params.displayQueueSize > 0);
+        CV_Assert(colorFormat_ == BGRA || colorFormat_ == BGR || colorFormat_ == GRAY || colorFormat_ == NV12 || colorFormat_ == YUV);
+        if (zeroCopy_ && colorFormat_ != NV12 && colorFormat_ != GRAY)
+            CV_Error(Error::StsBadArg, "Zero copy output is only supported with NV12 and GRAY color formats");
+    }
+
+    void FrameOutput::releaseMappedFrame()
+    {
+        if (!mappedFrame_.empty())
+        {
+            VideoCtxAutoLock autoLock(mappedLock_);
+            mappedDecoder_->unmapFrame(mappedFrame_);
+        }
+
+        if (releaseMappedInfo_)
+        {
+            mappedQueue_->releaseFrame(mappedInfo_);
+            releaseMappedInfo_ = false;
+        }
+    }
+
+    void FrameOutput::convertFrame(const GpuMat& decodedFrame, GpuMat& frame, int width, int height, Stream& stream) const
+    {
+        cudaStream_t cudaStream = StreamAccessor::getStream(stream);
+
+        switch (colorFormat_)
+        {
+        case BGRA:
+            videoDecPostProcessFrame(decodedFrame, frame, width, height, cudaStream);
+            break;
+        case BGR:
+            videoDecPostProcessFrameBGR(decodedFrame, frame, width, height, cudaStream);
+            break;
+        case GRAY:
+            decodedFrame.rowRange(0, height).copyTo(frame, stream);
+            break;
+        case NV12:
+            decodedFrame.copyTo(frame, stream);
+            break;
+        case YUV:
+            videoDecNV12ToYUV(decodedFrame, frame, width, height, cudaStream);
+            break;
+        }
+    }
+
+    void FrameOutput::outputFrame(VideoDecoder& decoder, FrameQueue& frameQueue, CUvideoctxlock lock, FieldQueue& frames,
+                                  GpuMat& frame, Stream& stream)
+    {
+        CV_DbgAssert(mappedFrame_.empty() && !releaseMappedInfo_);
+
+        std::pair<CUVIDPARSERDISPINFO, CUVIDPROCPARAMS> frameInfo = frames.front();
+        frames.pop_front();
+
+        {
+            VideoCtxAutoLock autoLock(lock);
+
+            // map decoded video frame to CUDA surface
+            GpuMat decodedFrame = decoder.mapFrame(frameInfo.first.picture_index, frameInfo.second);
+
+            if (zeroCopy_)
+            {
+                // the surface stays mapped until the next call, the caller gets a view of it
+                mappedFrame_ = decodedFrame;
+                mappedInfo_ = frameInfo.first;
+                releaseMappedInfo_ = frames.empty();
+                mappedDecoder_ = &decoder;
+                mappedQueue_ = &frameQueue;
+                mappedLock_ = lock;
+
+                if (colorFormat_ == GRAY)
+                    frame = decodedFrame.rowRange(0, decoder.targetHeight());
+                else
+                    frame = decodedFrame;
+
+                return;
+            }
+
+            // perform post processing on the CUDA surface (performs colors space conversion and post processing)
+            convertFrame(decodedFrame, frame, decoder.targetWidth(), decoder.targetHeight(), stream);
+
+            // unmap video frame
+            // unmapFrame() synchronizes with the VideoDecode API (ensures the frame has finished decoding)
+            decoder.unmapFrame(decodedFrame);
+        }
+
+        // release the frame, so it can be re-used in decoder
+        if (frames.empty())
+            frameQueue.releaseFrame(frameInfo.first);
+    }
+
     class VideoReaderImpl : public VideoReader
     {
     public:
-        explicit VideoReaderImpl(const Ptr<VideoSource>& source);
+        VideoReaderImpl(const Ptr<VideoSource>& source, const VideoReaderInitParams& params);
         ~VideoReaderImpl();
 
         bool nextFrame(GpuMat& frame, Stream& stream) CV_OVERRIDE;
 
         FormatInfo format() const CV_OVERRIDE;
 
+        bool seek(double timestampMs) CV_OVERRIDE;
+
     private:
         Ptr<VideoSource> videoSource_;
 
@@ -78,7 +240,10 @@ namespace
 
         CUvideoctxlock lock_;
 
-        std::deque< std::pair<CUVIDPARSERDISPINFO, CUVIDPROCPARAMS> > frames_;
+        VideoReaderInitParams params_;
+
+        FieldQueue frames_;
+        FrameOutput output_;
     };
 
     FormatInfo VideoReaderImpl::format() const
@@ -86,10 +251,15 @@ namespace
         return videoSource_->format();
     }
 
-    VideoReaderImpl::VideoReaderImpl(const Ptr<VideoSource>& source) :
+    VideoReaderImpl::VideoReaderImpl(const Ptr<VideoSource>& source, const VideoReaderInitParams& params) :
         videoSource_(source),
-        lock_(0)
+        lock_(0),
+        params_(params),
+        output_(params)
     {
+        if (params.keyFramesOnly && !isKeyFrameDetectionSupported(videoSource_->format().codec))
+            CV_Error(Error::StsNotImplemented, "Key frame only decoding is not supported for the codec of the video source");
+
         // init context
         GpuMat temp(1, 1, CV_8UC1);
         temp.release();
@@ -98,32 +268,27 @@ namespace
         cuSafeCall( cuCtxGetCurrent(&ctx) );
         cuSafeCall( cuvidCtxLockCreate(&lock_, ctx) );
 
-        frameQueue_.reset(new FrameQueue);
-        videoDecoder_.reset(new VideoDecoder(videoSource_->format(), ctx, lock_));
+        frameQueue_.reset(new FrameQueue(params.decodeSurfaces, params.displayQueueSize));
+        videoDecoder_.reset(new VideoDecoder(videoSource_->format(), ctx, lock_, params.decodeSurfaces));
         videoParser_.reset(new VideoParser(videoDecoder_, frameQueue_));
 
         videoSource_->setVideoParser(videoParser_);
+        videoSource_->setKeyFrameFilter(params.keyFramesOnly, false);
         videoSource_->start();
     }
 
     VideoReaderImpl::~VideoReaderImpl()
     {
+        output_.releaseMappedFrame();
         frameQueue_->endDecode();
         videoSource_->stop();
     }
 
-    class VideoCtxAutoLock
-    {
-    public:
-        VideoCtxAutoLock(CUvideoctxlock lock) : m_lock(lock) { cuSafeCall( cuvidCtxLock(m_lock, 0) ); }
-        ~VideoCtxAutoLock() { cuvidCtxUnlock(m_lock, 0); }
-
-    private:
-        CUvideoctxlock m_lock;
-    };
-
     bool VideoReaderImpl::nextFrame(GpuMat& frame, Stream& stream)
     {
+        // the surface of the previous zero copy frame is given back to the decoder first
+        output_.releaseMappedFrame();
+
         if (videoSource_->hasError() || videoParser_->hasError())
             CV_Error(Error::StsUnsupportedFormat, "Unsupported video source");
 
@@ -133,7 +298,9 @@ namespace
 
             for (;;)
             {
-                if (frameQueue_->dequeue(displayInfo))
+                // Blocks until a frame is queued or decoding ends, the timeout only bounds
+                // the delay of noticing errors of the video source
+                if (frameQueue_->dequeue(displayInfo, 10))
                     break;
 
                 if (videoSource_->hasError() || videoParser_->hasError())
@@ -141,58 +308,337 @@ namespace
 
                 if (frameQueue_->isEndOfDecode())
                     return false;
-
-                // Wait a bit
-                Thread::sleep(1);
             }
 
-            bool isProgressive = displayInfo.progressive_frame != 0;
-            const int num_fields = isProgressive ? 1 : 2 + displayInfo.repeat_first_field;
+            queueFields(displayInfo, frames_);
+        }
+
+        if (frames_.empty())
+            return false;
+
+        output_.outputFrame(*videoDecoder_, *frameQueue_, lock_, frames_, frame, stream);
+
+        return true;
+    }
+
+    bool VideoReaderImpl::seek(double timestampMs)
+    {
+        output_.releaseMappedFrame();
+
+        // unblocks the parser callbacks, so that the source thread stops
+        frameQueue_->endDecode();
+        videoSource_->stop();
+
+        const bool seeked = videoSource_->seek(timestampMs);
+
+        // the parser and the queued frames refer to the old position, the decoder surfaces are reused
+        frames_.clear();
+        videoParser_.release();
+        frameQueue_.reset(new FrameQueue(params_.decodeSurfaces, params_.displayQueueSize));
+        videoParser_.reset(new VideoParser(videoDecoder_, frameQueue_));
+
+        // pictures before the next key frame would reference frames the new parser has not seen
+        videoSource_->setVideoParser(videoParser_);
+        videoSource_->setKeyFrameFilter(params_.keyFramesOnly, true);
+        videoSource_->start();
+
+        return seeked;
+    }
+
+    class MultiStreamVideoReaderImpl : public MultiStreamVideoReader
+    {
+    public:
+        MultiStreamVideoReaderImpl(int numWorkers, const VideoReaderInitParams& params);
+        ~MultiStreamVideoReaderImpl();
+
+        int addStream(const String& filename) CV_OVERRIDE;
+        int addStream(const Ptr<RawVideoSource>& source) CV_OVERRIDE;
+
+        bool nextFrame(GpuMat& frame, int& streamIdx, Stream& stream) CV_OVERRIDE;
+
+        FormatInfo format(int streamIdx) const CV_OVERRIDE;
+        int getNumStreams() const CV_OVERRIDE;
+
+    private:
+        struct StreamState
+        {
+            Ptr<RawVideoSource> source;
+            Codec codec;
+            Ptr<FrameQueue> frameQueue;
+            Ptr<VideoDecoder> videoDecoder;
+            Ptr<VideoParser> videoParser;
+
+            // accessed by nextFrame() only
+            FieldQueue frames;
+
+            // guarded by mtx_
+            bool busy;      // a worker is feeding the decoder
+            bool finished;  // all packets are parsed
+            bool hasError;
+        };
+
+        static void workerLoop(void* userData);
+
+        // Parses a few packets of the stream, returns false at the end of the stream
+        static bool feedDecoder(StreamState& state, bool keyFramesOnly);
+
+        // Index of the next stream a worker may feed or -1, mtx_ must be locked
+        int pickStream();
+
+        VideoReaderInitParams params_;
+        CUcontext ctx_;
+        CUvideoctxlock lock_;
+
+        mutable std::mutex mtx_;
+        // notified when a stream becomes schedulable
+        std::condition_variable workCond_;
+        // notified when a worker has parsed packets
+        std::condition_variable frameCond_;
+        std::vector< Ptr<StreamState> > streams_;
+        int workCursor_;
+        bool stop_;
+
+        std::vector< Ptr<Thread> > workers_;
+
+        int frameCursor_;
+        FrameOutput output_;
+    };
+
+    MultiStreamVideoReaderImpl::MultiStreamVideoReaderImpl(int numWorkers, const VideoReaderInitParams& params) :
+        params_(params),
+        ctx_(0),
+        lock_(0),
+        workCursor_(0),
+        stop_(false),
+        frameCursor_(-1),
+        output_(params)
+    {
+        CV_Assert(numWorkers > 0);
+
+        // init context
+        GpuMat temp(1, 1, CV_8UC1);
+        temp.release();
+
+        // all the streams share the context and its lock
+        cuSafeCall( cuCtxGetCurrent(&ctx_) );
+        cuSafeCall( cuvidCtxLockCreate(&lock_, ctx_) );
+
+        for (int i = 0; i < numWorkers; ++i)
+            workers_.push_back(makePtr<Thread>(workerLoop, this));
+    }
+
+    MultiStreamVideoReaderImpl::~MultiStreamVideoReaderImpl()
+    {
+        output_.releaseMappedFrame();
+
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+            // unblocks the workers waiting for display queue entries or decode surfaces
+            for (size_t i = 0; i < streams_.size(); ++i)
+                streams_[i]->frameQueue->endDecode();
+        }
+        workCond_.notify_all();
+
+        for (size_t i = 0; i < workers_.size(); ++i)
+            workers_[i]->wait();
+    }
+
+    int MultiStreamVideoReaderImpl::addStream(const String& filename)
+    {
+        CV_Assert( !filename.empty() );
+
+        Ptr<RawVideoSource> source(new FFmpegVideoSource(filename));
+        return addStream(source);
+    }
+
+    int MultiStreamVideoReaderImpl::addStream(const Ptr<RawVideoSource>& source)
+    {
+        CV_Assert( !source.empty() );
+
+        const FormatInfo videoFormat = source->format();
+        if (params_.keyFramesOnly && !isKeyFrameDetectionSupported(videoFormat.codec))
+            CV_Error(Error::StsNotImplemented, "Key frame only decoding is not supported for the codec of the video source");
+
+        Ptr<StreamState> state = makePtr<StreamState>();
+        state->source = source;
+        state->codec = videoFormat.codec;
+        state->frameQueue.reset(new FrameQueue(params_.decodeSurfaces, params_.displayQueueSize));
+        state->videoDecoder.reset(new VideoDecoder(videoFormat, ctx_, lock_, params_.decodeSurfaces));
+        state->videoParser.reset(new VideoParser(state->videoDecoder, state->frameQueue));
+        state->busy = false;
+        state->finished = false;
+        state->hasError = false;
+
+        int idx;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            idx = (int)streams_.size();
+            streams_.push_back(state);
+        }
+        workCond_.notify_one();
+
+        return idx;
+    }
+
+    FormatInfo MultiStreamVideoReaderImpl::format(int streamIdx) const
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        CV_Assert(streamIdx >= 0 && streamIdx < (int)streams_.size());
+        return streams_[streamIdx]->source->format();
+    }
+
+    int MultiStreamVideoReaderImpl::getNumStreams() const
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return (int)streams_.size();
+    }
+
+    int MultiStreamVideoReaderImpl::pickStream()
+    {
+        const int numStreams = (int)streams_.size();
 
-            for (int active_field = 0; active_field < num_fields; ++active_field)
+        for (int i = 0; i < numStreams; ++i)
+        {
+            const int idx = (workCursor_ + i) % numStreams;
+            const StreamState& state = *streams_[idx];
+
+            // a stream with a full display queue would block the worker until its frames are consumed
+            if (!state.busy && !state.finished && !state.frameQueue->isFull())
             {
-                CUVIDPROCPARAMS videoProcParams;
-                std::memset(&videoProcParams, 0, sizeof(CUVIDPROCPARAMS));
+                workCursor_ = idx + 1;
+                return idx;
+            }
+        }
+
+        return -1;
+    }
 
-                videoProcParams.progressive_frame = displayInfo.progressive_frame;
-                videoProcParams.second_field      = active_field;
-                videoProcParams.top_field_first   = displayInfo.top_field_first;
-                videoProcParams.unpaired_field    = (num_fields == 1);
+    bool MultiStreamVideoReaderImpl::feedDecoder(StreamState& state, bool keyFramesOnly)
+    {
+        const int packetsPerTurn = 4;
+
+        for (int i = 0; i < packetsPerTurn; ++i)
+        {
+            unsigned char* data;
+            size_t size;
 
-                frames_.push_back(std::make_pair(displayInfo, videoProcParams));
+            if (!state.source->getNextPacket(&data, &size))
+            {
+                state.videoParser->parseVideoData(0, 0, true);
+                return false;
             }
+
+            if (keyFramesOnly && keyFrameState(state.codec, data, size) == 0)
+                continue;
+
+            if (!state.videoParser->parseVideoData(data, size, false))
+                return false;
         }
 
-        if (frames_.empty())
-            return false;
+        return true;
+    }
+
+    void MultiStreamVideoReaderImpl::workerLoop(void* userData)
+    {
+        MultiStreamVideoReaderImpl* thiz = static_cast<MultiStreamVideoReaderImpl*>(userData);
 
-        std::pair<CUVIDPARSERDISPINFO, CUVIDPROCPARAMS> frameInfo = frames_.front();
-        frames_.pop_front();
+        std::unique_lock<std::mutex> lock(thiz->mtx_);
 
+        while (!thiz->stop_)
         {
-            VideoCtxAutoLock autoLock(lock_);
+            const int idx = thiz->pickStream();
 
-            // map decoded video frame to CUDA surface
-            GpuMat decodedFrame = videoDecoder_->mapFrame(frameInfo.first.picture_index, frameInfo.second);
+            if (idx < 0)
+            {
+                // the timeout covers the display queues drained without notification
+                thiz->workCond_.wait_for(lock, std::chrono::milliseconds(10));
+                continue;
+            }
 
-            // perform post processing on the CUDA surface (performs colors space conversion and post processing)
-            // comment this out if we include the line of code seen above
-            videoDecPostProcessFrame(decodedFrame, frame, videoDecoder_->targetWidth(), videoDecoder_->targetHeight(), StreamAccessor::getStream(stream));
+            StreamState& state = *thiz->streams_[idx];
+            state.busy = true;
 
-            // unmap video frame
-            // unmapFrame() synchronizes with the VideoDecode API (ensures the frame has finished decoding)
-            videoDecoder_->unmapFrame(decodedFrame);
+            lock.unlock();
+            const bool hasMore = feedDecoder(state, thiz->params_.keyFramesOnly);
+            lock.lock();
+
+            state.busy = false;
+            if (!hasMore)
+            {
+                state.finished = true;
+                state.hasError = state.videoParser->hasError();
+                state.frameQueue->endDecode();
+            }
+
+            thiz->frameCond_.notify_all();
         }
+    }
 
-        // release the frame, so it can be re-used in decoder
-        if (frames_.empty())
-            frameQueue_->releaseFrame(frameInfo.first);
+    bool MultiStreamVideoReaderImpl::nextFrame(GpuMat& frame, int& streamIdx, Stream& stream)
+    {
+        // the surface of the previous zero copy frame is given back to the decoder first
+        output_.releaseMappedFrame();
 
-        return true;
+        for (;;)
+        {
+            std::vector< Ptr<StreamState> > streams;
+            std::vector<uchar> finished;
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                streams = streams_;
+                finished.resize(streams.size());
+                for (size_t i = 0; i < streams.size(); ++i)
+                {
+                    if (streams[i]->hasError)
+                        CV_Error(Error::StsUnsupportedFormat, cv::format("Unsupported video source of stream %d", (int)i));
+                    finished[i] = streams[i]->finished;
+                }
+            }
+
+            const int numStreams = (int)streams.size();
+            bool allEnded = true;
+
+            // round robin over the streams, starting after the stream of the previous frame
+            for (int i = 1; i <= numStreams; ++i)
+            {
+                const int idx = (frameCursor_ + i) % numStreams;
+                StreamState& state = *streams[idx];
+
+                if (state.frames.empty())
+                {
+                    CUVIDPARSERDISPINFO displayInfo;
+                    if (state.frameQueue->dequeue(displayInfo))
+                    {
+                        // an entry of the display queue became free
+                        workCond_.notify_one();
+                        queueFields(displayInfo, state.frames);
+                    }
+                }
+
+                if (!state.frames.empty())
+                {
+                    output_.outputFrame(*state.videoDecoder, *state.frameQueue, lock_, state.frames, frame, stream);
+                    frameCursor_ = idx;
+                    streamIdx = idx;
+                    return true;
+                }
+
+                // the finished flag was read before the queue, so no frame can follow
+                if (!finished[idx])
+                    allEnded = false;
+            }
+
+            if (allEnded)
+                return false;
+
+            std::unique_lock<std::mutex> lock(mtx_);
+            frameCond_.wait_for(lock, std::chrono::milliseconds(10));
+        }
     }
 }
 
-Ptr<VideoReader> cv::cudacodec::createVideoReader(const String& filename)
+Ptr<VideoReader> cv::cudacodec::createVideoReader(const String& filename, const VideoReaderInitParams& params)
 {
     CV_Assert( !filename.empty() );
 
@@ -206,16 +652,24 @@ Ptr<VideoReader> cv::cudacodec::createVideoReader(const String& filename)
     }
     catch (...)
     {
+        // the packets of the CUDA demuxer are not split at frame boundaries
+        if (params.keyFramesOnly)
+            throw;
         videoSource.reset(new CuvidVideoSource(filename));
     }
 
-    return makePtr<VideoReaderImpl>(videoSource);
+    return makePtr<VideoReaderImpl>(videoSource, params);
 }
 
-Ptr<VideoReader> cv::cudacodec::createVideoReader(const Ptr<RawVideoSource>& source)
+Ptr<VideoReader> cv::cudacodec::createVideoReader(const Ptr<RawVideoSource>& source, const VideoReaderInitParams& params)
 {
     Ptr<VideoSource> videoSource(new RawVideoSourceWrapper(source));
-    return makePtr<VideoReaderImpl>(videoSource);
+    return makePtr<VideoReaderImpl>(videoSource, params);
+}
+
+Ptr<MultiStreamVideoReader> cv::cudacodec::createMultiStreamVideoReader(int numWorkers, const VideoReaderInitParams& params)
+{
+    return makePtr<MultiStreamVideoReaderImpl>(numWorkers, params);
 }
 
 #endif // HAVE_NVCUVID
@@ -49,8 +49,86 @@ using namespace cv;
 using namespace cv::cudacodec;
 using namespace cv::cudacodec::detail;
 
+int cv::cudacodec::detail::keyFrameState(Codec codec, const uchar* data, size_t size)
+{
+    if (size == 0)
+        return -1;
+
+    switch (codec)
+    {
+    case JPEG:
+        return 1;
+
+    case VP8:
+        // frame tag, the lowest bit is 0 for key frames
+        return (data[0] & 1) == 0 ? 1 : 0;
+
+    case H264:
+    case HEVC:
+    {
+        // scan the NAL units of the Annex B byte stream
+        bool hasPicture = false;
+
+        for (size_t i = 0; i + 3 < size; ++i)
+        {
+            if (data[i] != 0 || data[i + 1] != 0 || data[i + 2] != 1)
+                continue;
+
+            const uchar header = data[i + 3];
+
+            if (codec == H264)
+            {
+                const int type = header & 0x1f;
+                if (type == 5) // IDR slice
+                    return 1;
+                if (type >= 1 && type <= 4)
+                    hasPicture = true;
+            }
+            else
+            {
+                const int type = (header >> 1) & 0x3f;
+                if (type >= 16 && type <= 23) // IRAP pictures: BLA, IDR and CRA
+                    return 1;
+                if (type < 16)
+                    hasPicture = true;
+            }
+
+            i += 2;
+        }
+
+        return hasPicture ? 0 : -1;
+    }
+
+    default:
+        return 1;
+    }
+}
+
+bool cv::cudacodec::detail::isKeyFrameDetectionSupported(Codec codec)
+{
+    return codec == H264 || codec == HEVC || codec == VP8 || codec == JPEG;
+}
+
+void cv::cudacodec::detail::VideoSource::setKeyFrameFilter(bool keyFramesOnly, bool waitKeyFrame)
+{
+    codec_ = format().codec;
+    keyFramesOnly_ = keyFramesOnly;
+    waitKeyFrame_ = waitKeyFrame && isKeyFrameDetectionSupported(codec_);
+}
+
 bool cv::cudacodec::detail::VideoSource::parseVideoData(const unsigned char* data, size_t size, bool endOfStream)
 {
+    if ((keyFramesOnly_ || waitKeyFrame_) && !endOfStream)
+    {
+        const int state = keyFrameState(codec_, data, size);
+
+        if (state == 0)
+            return true; // dropped
+
+        if (state == 1)
+            waitKeyFrame_ = false;
+    }
+
     return videoParser_->parseVideoData(data, size, endOfStream);
 }
 
@@ -89,6 +167,12 @@ bool cv::cudacodec::detail::RawVideoSourceWrapper::hasError() const
     return hasError_;
 }
 
+bool cv::cudacodec::detail::RawVideoSourceWrapper::seek(double timestampMs)
+{
+    CV_Assert( !thread_ );
+    return source_->seek(timestampMs);
+}
+
 void cv::cudacodec::detail::RawVideoSourceWrapper::readLoop(void* userData)
 {
     RawVideoSourceWrapper* thiz = static_cast<RawVideoSourceWrapper*>(userData);
@@ -50,9 +50,17 @@ namespace cv { namespace cudacodec { namespace detail {
 
 class VideoParser;
 
+// Returns 1 for a packet holding a key frame, 0 for other frames and -1 for packets without
+// pictures (e.g. parameter sets). The packet must hold whole frames.
+int keyFrameState(Codec codec, const uchar* data, size_t size);
+
+// True if keyFrameState() recognizes the key frames of the codec.
+bool isKeyFrameDetectionSupported(Codec codec);
+
 class VideoSource
 {
 public:
+    VideoSource() : videoParser_(0), keyFramesOnly_(false), waitKeyFrame_(false), codec_(NumCodecs) {}
     virtual ~VideoSource() {}
 
     virtual FormatInfo format() const = 0;
@@ -61,13 +69,24 @@ public:
     virtual bool isStarted() const = 0;
     virtual bool hasError() const = 0;
 
+    // Moves a stopped source to a timestamp, returns false if seeking is not supported.
+    virtual bool seek(double timestampMs) { CV_UNUSED(timestampMs); return false; }
+
     void setVideoParser(detail::VideoParser* videoParser) { videoParser_ = videoParser; }
 
+    // Drops the packets which are not key frames, either all of them or the ones before the next
+    // key frame. Only called while the source is stopped.
+    void setKeyFrameFilter(bool keyFramesOnly, bool waitKeyFrame);
+
 protected:
     bool parseVideoData(const uchar* data, size_t size, bool endOfStream = false);
 
 private:
     detail::VideoParser* videoParser_;
+
+    bool keyFramesOnly_;
+    bool waitKeyFrame_;
+    Codec codec_;
 };
 
 class RawVideoSourceWrapper : public VideoSource
@@ -80,6 +99,7 @@ public:
     void stop() CV_OVERRIDE;
     bool isStarted() const CV_OVERRIDE;
     bool hasError() const CV_OVERRIDE;
+    bool seek(double timestampMs) CV_OVERRIDE;
 
 private:
     Ptr<RawVideoSource> source_;
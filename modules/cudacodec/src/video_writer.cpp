@@ -62,7 +62,7 @@ Ptr<cv::cudacodec::VideoWriter> cv::cudacodec::createVideoWriter(const Ptr<Encod
 
 #else // !defined HAVE_NVCUVENC || !defined _WIN32
 
-void RGB_to_YV12(const GpuMat& src, GpuMat& dst);
+void RGB_to_YV12(const GpuMat& src, GpuMat& dst, cudaStream_t stream);
 
 ///////////////////////////////////////////////////////////////////////////
 // VideoWriterImpl
@@ -113,12 +113,21 @@ namespace
     public:
         VideoWriterImpl(const Ptr<EncoderCallBack>& callback, Size frameSize, double fps, SurfaceFormat format, CodecType codec = H264);
         VideoWriterImpl(const Ptr<EncoderCallBack>& callback, Size frameSize, double fps, const EncoderParams& params, SurfaceFormat format, CodecType codec = H264);
+        ~VideoWriterImpl();
 
         void write(InputArray frame, bool lastFrame = false);
+        void write(InputArray frame, Stream& stream, bool lastFrame = false);
+        void flush();
 
         EncoderParams getEncoderParams() const;
 
     private:
+        void checkFrame(const GpuMat& frame) const;
+        void uploadFrame(const GpuMat& frame, GpuMat& surface, cudaStream_t stream);
+        void encodeFrame(const GpuMat& surface, bool lastFrame);
+
+        static void encodeLoop(void* userData);
+
         void initEncoder(double fps);
         void setEncodeParams(const EncoderParams& params);
         void initGpuMemory();
@@ -137,6 +146,26 @@ namespace
         GpuMat videoFrame_;
         CUvideoctxlock cuCtxLock_;
 
+        // asynchronous writes, surfaces_[i] is either free or queued for the encode thread
+        struct InputSurface
+        {
+            GpuMat frame;
+            Event ready;
+            bool lastFrame;
+        };
+
+        int inFlightFrames_;
+        int deviceId_;
+        std::vector<InputSurface> surfaces_;
+        std::vector<int> freeSurfaces_;
+        std::deque<int> queuedSurfaces_;
+        bool encoding_;
+        bool stopEncoding_;
+        bool encodeError_;
+        std::mutex mtx_;
+        std::condition_variable cond_;
+        Ptr<detail::Thread> encodeThread_;
+
         // CallBacks
 
         static unsigned char* NVENCAPI HandleAcquireBitStream(int* pBufferSize, void* pUserdata);
@@ -150,7 +179,12 @@ namespace
         frameSize_(frameSize),
         codec_(codec),
         inputFormat_(format),
-        cuCtxLock_(0)
+        cuCtxLock_(0),
+        inFlightFrames_(EncoderParams().InFlightFrames),
+        deviceId_(getDevice()),
+        encoding_(false),
+        stopEncoding_(false),
+        encodeError_(false)
     {
         surfaceFormat_ = (inputFormat_ == SF_BGR ? YV12 : static_cast<NVVE_SurfaceFormat>(inputFormat_));
 
@@ -168,8 +202,15 @@ namespace
         frameSize_(frameSize),
         codec_(codec),
         inputFormat_(format),
-        cuCtxLock_(0)
+        cuCtxLock_(0),
+        inFlightFrames_(params.InFlightFrames),
+        deviceId_(getDevice()),
+        encoding_(false),
+        stopEncoding_(false),
+        encodeError_(false)
     {
+        CV_Assert( inFlightFrames_ > 0 );
+
         surfaceFormat_ = (inputFormat_ == SF_BGR ? YV12 : static_cast<NVVE_SurfaceFormat>(inputFormat_));
 
         initEncoder(fps);
@@ -416,6 +457,8 @@ namespace
         CV_Assert( err == 0 );
         params.DisableSPSPPS = DisableSPSPPS;
 
+        params.InFlightFrames = inFlightFrames_;
+
         return params;
     }
 
@@ -481,9 +524,18 @@ namespace
         CV_Assert( err == 0 );
     }
 
+    // synchronous copy on the null stream
+    void copy2D(const CUDA_MEMCPY2D& copyParams, CUstream stream)
+    {
+        if (stream)
+            cuSafeCall( cuMemcpy2DAsync(&copyParams, stream) );
+        else
+            cuSafeCall( cuMemcpy2D(&copyParams) );
+    }
+
     // UYVY/YUY2 are both 4:2:2 formats (16bpc)
     // Luma, U, V are interleaved, chroma is subsampled (w/2,h)
-    void copyUYVYorYUY2Frame(Size frameSize, const GpuMat& src, GpuMat& dst)
+    void copyUYVYorYUY2Frame(Size frameSize, const GpuMat& src, GpuMat& dst, CUstream stream)
     {
         // Source is YUVY/YUY2 4:2:2, the YUV data in a packed and interleaved
 
@@ -511,12 +563,12 @@ namespace
         stCopyYUV422.Height               = frameSize.height;
 
         // DMA Luma/Chroma
-        cuSafeCall( cuMemcpy2D(&stCopyYUV422) );
+        copy2D(stCopyYUV422, stream);
     }
 
     // YV12/IYUV are both 4:2:0 planar formats (12bpc)
     // Luma, U, V chroma planar (12bpc), chroma is subsampled (w/2,h/2)
-    void copyYV12orIYUVFrame(Size frameSize, const GpuMat& src, GpuMat& dst)
+    void copyYV12orIYUVFrame(Size frameSize, const GpuMat& src, GpuMat& dst, CUstream stream)
     {
         // Source is YV12/IYUV, this native format is converted to NV12 format by the video encoder
 
@@ -567,15 +619,15 @@ namespace
         stCopyChroma.Height             = frameSize.height; // U/V are sent together
 
         // DMA Luma
-        cuSafeCall( cuMemcpy2D(&stCopyLuma) );
+        copy2D(stCopyLuma, stream);
 
         // DMA Chroma channels (UV side by side)
-        cuSafeCall( cuMemcpy2D(&stCopyChroma) );
+        copy2D(stCopyChroma, stream);
     }
 
     // NV12 is 4:2:0 format (12bpc)
     // Luma followed by U/V chroma interleaved (12bpc), chroma is subsampled (w/2,h/2)
-    void copyNV12Frame(Size frameSize, const GpuMat& src, GpuMat& dst)
+    void copyNV12Frame(Size frameSize, const GpuMat& src, GpuMat& dst, CUstream stream)
     {
         // Source is NV12 in pitch linear memory
         // Because we are assume input is NV12 (if we take input in the native format), the encoder handles NV12 as a native format in pitch linear memory
@@ -604,13 +656,26 @@ namespace
         stCopyNV12.Height               = (frameSize.height * 3) >> 1;
 
         // DMA Luma/Chroma
-        cuSafeCall( cuMemcpy2D(&stCopyNV12) );
+        copy2D(stCopyNV12, stream);
     }
 
-    void VideoWriterImpl::write(InputArray _frame, bool lastFrame)
+    VideoWriterImpl::~VideoWriterImpl()
     {
-        GpuMat frame = _frame.getGpuMat();
+        if (!encodeThread_)
+            return;
+
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cond_.wait(lock, [&] { return (queuedSurfaces_.empty() && !encoding_) || encodeError_; });
+            stopEncoding_ = true;
+        }
+        cond_.notify_all();
+
+        encodeThread_->wait();
+    }
 
+    void VideoWriterImpl::checkFrame(const GpuMat& frame) const
+    {
         if (inputFormat_ == SF_BGR)
         {
             CV_Assert( frame.size() == frameSize_ );
@@ -621,25 +686,16 @@ namespace
             CV_Assert( frame.size() == videoFrame_.size() );
             CV_Assert( frame.type() == videoFrame_.type() );
         }
+    }
 
-        NVVE_EncodeFrameParams efparams;
-        efparams.Width = frameSize_.width;
-        efparams.Height = frameSize_.height;
-        efparams.Pitch = static_cast<int>(videoFrame_.step);
-        efparams.SurfFmt = surfaceFormat_;
-        efparams.PictureStruc = FRAME_PICTURE;
-        efparams.topfieldfirst =  0;
-        efparams.repeatFirstField = 0;
-        efparams.progressiveFrame = (surfaceFormat_ == NV12) ? 1 : 0;
-        efparams.bLast = lastFrame;
-        efparams.picBuf = 0; // Must be set to NULL in order to support device memory input
-
+    void VideoWriterImpl::uploadFrame(const GpuMat& frame, GpuMat& surface, cudaStream_t stream)
+    {
         // Don't forget we need to lock/unlock between memcopies
         cuSafeCall( cuvidCtxLock(cuCtxLock_, 0) );
 
         if (inputFormat_ == SF_BGR)
         {
-            RGB_to_YV12(frame, videoFrame_);
+            RGB_to_YV12(frame, surface, stream);
         }
         else
         {
@@ -647,26 +703,149 @@ namespace
             {
             case UYVY: // UYVY (4:2:2)
             case YUY2: // YUY2 (4:2:2)
-                copyUYVYorYUY2Frame(frameSize_, frame, videoFrame_);
+                copyUYVYorYUY2Frame(frameSize_, frame, surface, (CUstream) stream);
                 break;
 
             case YV12: // YV12 (4:2:0), Y V U
             case IYUV: // IYUV (4:2:0), Y U V
-                copyYV12orIYUVFrame(frameSize_, frame, videoFrame_);
+                copyYV12orIYUVFrame(frameSize_, frame, surface, (CUstream) stream);
                 break;
 
             case NV12: // NV12 (4:2:0)
-                copyNV12Frame(frameSize_, frame, videoFrame_);
+                copyNV12Frame(frameSize_, frame, surface, (CUstream) stream);
                 break;
             }
         }
 
         cuSafeCall( cuvidCtxUnlock(cuCtxLock_, 0) );
+    }
 
-        int err = NVEncodeFrame(encoder_, &efparams, 0, videoFrame_.data);
+    void VideoWriterImpl::encodeFrame(const GpuMat& surface, bool lastFrame)
+    {
+        NVVE_EncodeFrameParams efparams;
+        efparams.Width = frameSize_.width;
+        efparams.Height = frameSize_.height;
+        efparams.Pitch = static_cast<int>(surface.step);
+        efparams.SurfFmt = surfaceFormat_;
+        efparams.PictureStruc = FRAME_PICTURE;
+        efparams.topfieldfirst =  0;
+        efparams.repeatFirstField = 0;
+        efparams.progressiveFrame = (surfaceFormat_ == NV12) ? 1 : 0;
+        efparams.bLast = lastFrame;
+        efparams.picBuf = 0; // Must be set to NULL in order to support device memory input
+
+        int err = NVEncodeFrame(encoder_, &efparams, 0, surface.data);
         CV_Assert( err == 0 );
     }
 
+    void VideoWriterImpl::write(InputArray _frame, bool lastFrame)
+    {
+        GpuMat frame = _frame.getGpuMat();
+        checkFrame(frame);
+
+        // keeps the order with the frames queued by asynchronous writes
+        flush();
+
+        uploadFrame(frame, videoFrame_, 0);
+        encodeFrame(videoFrame_, lastFrame);
+    }
+
+    void VideoWriterImpl::write(InputArray _frame, Stream& stream, bool lastFrame)
+    {
+        GpuMat frame = _frame.getGpuMat();
+        checkFrame(frame);
+
+        if (!encodeThread_)
+        {
+            surfaces_.resize(inFlightFrames_);
+            for (int i = 0; i < inFlightFrames_; ++i)
+            {
+                surfaces_[i].frame.create(videoFrame_.size(), videoFrame_.type());
+                freeSurfaces_.push_back(i);
+            }
+
+            encodeThread_.reset(new detail::Thread(encodeLoop, this));
+        }
+
+        int idx;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cond_.wait(lock, [&] { return !freeSurfaces_.empty() || encodeError_; });
+            if (encodeError_)
+                CV_Error(Error::StsError, "Encoding of a queued frame failed");
+
+            idx = freeSurfaces_.back();
+            freeSurfaces_.pop_back();
+        }
+
+        InputSurface& surface = surfaces_[idx];
+
+        uploadFrame(frame, surface.frame, StreamAccessor::getStream(stream));
+        surface.ready.record(stream);
+        surface.lastFrame = lastFrame;
+
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            queuedSurfaces_.push_back(idx);
+        }
+        cond_.notify_all();
+    }
+
+    void VideoWriterImpl::flush()
+    {
+        if (!encodeThread_)
+            return;
+
+        std::unique_lock<std::mutex> lock(mtx_);
+        cond_.wait(lock, [&] { return (queuedSurfaces_.empty() && !encoding_) || encodeError_; });
+        if (encodeError_)
+            CV_Error(Error::StsError, "Encoding of a queued frame failed");
+    }
+
+    void VideoWriterImpl::encodeLoop(void* userData)
+    {
+        VideoWriterImpl* thiz = static_cast<VideoWriterImpl*>(userData);
+
+        // the events and the encoder belong to the device of the writer
+        setDevice(thiz->deviceId_);
+
+        for (;;)
+        {
+            int idx;
+            {
+                std::unique_lock<std::mutex> lock(thiz->mtx_);
+                thiz->cond_.wait(lock, [&] { return !thiz->queuedSurfaces_.empty() || thiz->stopEncoding_; });
+                if (thiz->queuedSurfaces_.empty())
+                    return;
+
+                idx = thiz->queuedSurfaces_.front();
+                thiz->queuedSurfaces_.pop_front();
+                thiz->encoding_ = true;
+            }
+
+            InputSurface& surface = thiz->surfaces_[idx];
+            bool failed = false;
+
+            try
+            {
+                surface.ready.waitForCompletion();
+                thiz->encodeFrame(surface.frame, surface.lastFrame);
+            }
+            catch (const cv::Exception&)
+            {
+                failed = true;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(thiz->mtx_);
+                thiz->freeSurfaces_.push_back(idx);
+                thiz->encoding_ = false;
+                thiz->encodeError_ = thiz->encodeError_ || failed;
+            }
+            thiz->cond_.notify_all();
+        }
+    }
+
     unsigned char* NVENCAPI VideoWriterImpl::HandleAcquireBitStream(int* pBufferSize, void* pUserdata)
     {
         VideoWriterImpl* thiz = static_cast<VideoWriterImpl*>(pUserdata);
@@ -829,6 +1008,7 @@ cv::cudacodec::EncoderParams::EncoderParams()
     DisableCabac = 0;
     NaluFramingType = 0;
     DisableSPSPPS = 0;
+    InFlightFrames = 3;
 }
 
 cv::cudacodec::EncoderParams::EncoderParams(const String& configFile)
@@ -860,6 +1040,7 @@ void cv::cudacodec::EncoderParams::load(const String& configFile)
     read(fs["DisableCabac"   ], DisableCabac, 0);
     read(fs["NaluFramingType"], NaluFramingType, 0);
     read(fs["DisableSPSPPS"  ], DisableSPSPPS, 0);
+    read(fs["InFlightFrames" ], InFlightFrames, 3);
 }
 
 void cv::cudacodec::EncoderParams::save(const String& configFile) const
@@ -886,6 +1067,7 @@ void cv::cudacodec::EncoderParams::save(const String& configFile) const
     write(fs, "DisableCabac"   , DisableCabac);
     write(fs, "NaluFramingType", NaluFramingType);
     write(fs, "DisableSPSPPS"  , DisableSPSPPS);
+    write(fs, "InFlightFrames" , InFlightFrames);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -71,6 +71,190 @@ CUDA_TEST_P(Video, Reader)
         ASSERT_FALSE(frame.empty());
     }
 }
+
+CUDA_TEST_P(Video, ReaderShortDisplayQueue)
+{
+    cv::cuda::setDevice(GET_PARAM(0).deviceID());
+
+    if (GET_PARAM(1) == "gpu/video/768x576.avi" && !videoio_registry::hasBackend(CAP_FFMPEG))
+        throw SkipTestException("FFmpeg backend not found");
+
+    std::string inputFile = std::string(cvtest::TS::ptr()->get_data_path()) + "../" + GET_PARAM(1);
+    cv::cudacodec::VideoReaderInitParams params;
+    params.displayQueueSize = 2;
+    cv::Ptr<cv::cudacodec::VideoReader> reader = cv::cudacodec::createVideoReader(inputFile, params);
+
+    // the decoder blocks on the full queue until the frames are consumed
+    cv::cuda::GpuMat frame;
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_TRUE(reader->nextFrame(frame));
+        ASSERT_FALSE(frame.empty());
+    }
+}
+
+CUDA_TEST_P(Video, ReaderColorFormats)
+{
+    cv::cuda::setDevice(GET_PARAM(0).deviceID());
+
+    if (GET_PARAM(1) == "gpu/video/768x576.avi" && !videoio_registry::hasBackend(CAP_FFMPEG))
+        throw SkipTestException("FFmpeg backend not found");
+
+    std::string inputFile = std::string(cvtest::TS::ptr()->get_data_path()) + "../" + GET_PARAM(1);
+
+    const cv::cudacodec::ColorFormat formats[] = { cv::cudacodec::BGR, cv::cudacodec::GRAY, cv::cudacodec::NV12, cv::cudacodec::YUV };
+    const int types[] = { CV_8UC3, CV_8UC1, CV_8UC1, CV_8UC1 };
+
+    cv::cuda::GpuMat reference;
+    {
+        cv::Ptr<cv::cudacodec::VideoReader> reader = cv::cudacodec::createVideoReader(inputFile);
+        ASSERT_TRUE(reader->nextFrame(reference));
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        for (int zeroCopy = 0; zeroCopy < 2; zeroCopy++)
+        {
+            if (zeroCopy && formats[i] != cv::cudacodec::GRAY && formats[i] != cv::cudacodec::NV12)
+                continue;
+
+            cv::cudacodec::VideoReaderInitParams params;
+            params.colorFormat = formats[i];
+            params.zeroCopy = zeroCopy != 0;
+            cv::Ptr<cv::cudacodec::VideoReader> reader = cv::cudacodec::createVideoReader(inputFile, params);
+
+            cv::cuda::GpuMat frame;
+            ASSERT_TRUE(reader->nextFrame(frame));
+            ASSERT_EQ(types[i], frame.type());
+            ASSERT_EQ(reference.cols, frame.cols);
+            if (formats[i] == cv::cudacodec::NV12 || formats[i] == cv::cudacodec::YUV)
+                ASSERT_EQ(reference.rows * 3 / 2, frame.rows);
+            else
+                ASSERT_EQ(reference.rows, frame.rows);
+
+            if (formats[i] == cv::cudacodec::BGR)
+            {
+                cv::Mat bgra, bgr(reference.size(), CV_8UC3);
+                reference.download(bgra);
+                const int fromTo[] = { 0, 0, 1, 1, 2, 2 };
+                cv::mixChannels(&bgra, 1, &bgr, 1, fromTo, 3);
+                EXPECT_MAT_NEAR(bgr, frame, 0);
+            }
+
+            // zero copy frames hand their surfaces back to the decoder on the next call
+            for (int j = 0; j < 30; j++)
+            {
+                ASSERT_TRUE(reader->nextFrame(frame));
+                ASSERT_EQ(types[i], frame.type());
+            }
+        }
+    }
+
+    cv::cudacodec::VideoReaderInitParams params;
+    params.colorFormat = cv::cudacodec::BGRA;
+    params.zeroCopy = true;
+    EXPECT_THROW(cv::cudacodec::createVideoReader(inputFile, params), cv::Exception);
+}
+
+CUDA_TEST_P(Video, ReaderKeyFramesOnly)
+{
+    cv::cuda::setDevice(GET_PARAM(0).deviceID());
+
+    const std::string file = GET_PARAM(1);
+    if (file.find(".h264") == std::string::npos && file.find(".h265") == std::string::npos)
+        throw SkipTestException("Key frames are only detected in H.264 and HEVC streams");
+    if (!videoio_registry::hasBackend(CAP_FFMPEG))
+        throw SkipTestException("FFmpeg backend not found");
+
+    std::string inputFile = std::string(cvtest::TS::ptr()->get_data_path()) + "../" + file;
+
+    int allFrames = 0;
+    {
+        cv::Ptr<cv::cudacodec::VideoReader> reader = cv::cudacodec::createVideoReader(inputFile);
+        cv::cuda::GpuMat frame;
+        while (reader->nextFrame(frame))
+            allFrames++;
+    }
+
+    cv::cudacodec::VideoReaderInitParams params;
+    params.keyFramesOnly = true;
+    cv::Ptr<cv::cudacodec::VideoReader> reader = cv::cudacodec::createVideoReader(inputFile, params);
+
+    int keyFrames = 0;
+    cv::cuda::GpuMat frame;
+    while (reader->nextFrame(frame))
+    {
+        ASSERT_FALSE(frame.empty());
+        keyFrames++;
+    }
+
+    EXPECT_GT(keyFrames, 0);
+    EXPECT_LT(keyFrames, allFrames);
+}
+
+CUDA_TEST_P(Video, ReaderSeek)
+{
+    cv::cuda::setDevice(GET_PARAM(0).deviceID());
+
+    if (!videoio_registry::hasBackend(CAP_FFMPEG))
+        throw SkipTestException("FFmpeg backend not found");
+
+    std::string inputFile = std::string(cvtest::TS::ptr()->get_data_path()) + "../" + GET_PARAM(1);
+    cv::Ptr<cv::cudacodec::VideoReader> reader = cv::cudacodec::createVideoReader(inputFile);
+
+    cv::cuda::GpuMat frame;
+    ASSERT_TRUE(reader->nextFrame(frame));
+
+    if (!reader->seek(1000))
+        throw SkipTestException("Video source can not seek");
+
+    // decoding goes on after the seek, back to the start as well
+    ASSERT_TRUE(reader->nextFrame(frame));
+    ASSERT_FALSE(frame.empty());
+    ASSERT_TRUE(reader->seek(0));
+    ASSERT_TRUE(reader->nextFrame(frame));
+    ASSERT_FALSE(frame.empty());
+}
+
+CUDA_TEST_P(Video, MultiStreamReader)
+{
+    cv::cuda::setDevice(GET_PARAM(0).deviceID());
+
+    if (!videoio_registry::hasBackend(CAP_FFMPEG))
+        throw SkipTestException("FFmpeg backend not found");
+
+    std::string inputFile = std::string(cvtest::TS::ptr()->get_data_path()) + "../" + GET_PARAM(1);
+
+    int expectedFrames = 0;
+    {
+        cv::Ptr<cv::cudacodec::VideoReader> reader = cv::cudacodec::createVideoReader(inputFile);
+        cv::cuda::GpuMat frame;
+        while (reader->nextFrame(frame))
+            expectedFrames++;
+    }
+
+    const int numStreams = 3;
+    cv::cudacodec::VideoReaderInitParams params;
+    params.displayQueueSize = 4;
+    cv::Ptr<cv::cudacodec::MultiStreamVideoReader> reader = cv::cudacodec::createMultiStreamVideoReader(2, params);
+    for (int i = 0; i < numStreams; i++)
+        ASSERT_EQ(i, reader->addStream(inputFile));
+    ASSERT_EQ(numStreams, reader->getNumStreams());
+
+    std::vector<int> frames(numStreams, 0);
+    cv::cuda::GpuMat frame;
+    int streamIdx = -1;
+    while (reader->nextFrame(frame, streamIdx))
+    {
+        ASSERT_GE(streamIdx, 0);
+        ASSERT_LT(streamIdx, numStreams);
+        ASSERT_FALSE(frame.empty());
+        frames[streamIdx]++;
+    }
+
+    for (int i = 0; i < numStreams; i++)
+        EXPECT_EQ(expectedFrames, frames[i]);
+}
 #endif // HAVE_NVCUVID
 
 #if defined(_WIN32) && defined(HAVE_NVCUVENC)
@@ -120,6 +304,56 @@ CUDA_TEST_P(Video, Writer)
     }
 }
 
+CUDA_TEST_P(Video, WriterAsync)
+{
+    cv::cuda::setDevice(GET_PARAM(0).deviceID());
+
+    const std::string inputFile = std::string(cvtest::TS::ptr()->get_data_path()) + "video/" + GET_PARAM(1);
+
+    std::string outputFile = cv::tempfile(".avi");
+    const double FPS = 25.0;
+
+    cv::VideoCapture reader(inputFile);
+    ASSERT_TRUE(reader.isOpened());
+
+    cv::Ptr<cv::cudacodec::VideoWriter> d_writer;
+    cv::cudacodec::EncoderParams params;
+    params.InFlightFrames = 2;
+
+    cv::cuda::Stream stream;
+    cv::Mat frame;
+    // the frames must stay alive until their copies are done
+    std::vector<cv::cuda::GpuMat> d_frames(10);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        reader >> frame;
+        ASSERT_FALSE(frame.empty());
+
+        d_frames[i].upload(frame, stream);
+
+        if (d_writer.empty())
+            d_writer = cv::cudacodec::createVideoWriter(outputFile, frame.size(), FPS, params);
+
+        d_writer->write(d_frames[i], stream, i == 9);
+    }
+
+    d_writer->flush();
+    ASSERT_EQ(2, d_writer->getEncoderParams().InFlightFrames);
+
+    reader.release();
+    d_writer.release();
+
+    reader.open(outputFile);
+    ASSERT_TRUE(reader.isOpened());
+
+    for (int i = 0; i < 5; ++i)
+    {
+        reader >> frame;
+        ASSERT_FALSE(frame.empty());
+    }
+}
+
 #endif // _WIN32, HAVE_NVCUVENC
 
 #define VIDEO_SRC "gpu/video/768x576.avi", "gpu/video/1920x1080.avi", "highgui/video/big_buck_bunny.avi", \
@@ -253,6 +253,9 @@ public:
     These extended variants of DescriptorMatcher::matchAsync methods find several best matches for each query
     descriptor. The matches are returned in the distance increasing order. See DescriptorMatcher::matchAsync
     for the details about query and train descriptors.
+
+    For k other than 2 the train set is processed by slices which keep their k best matches per query, the memory
+    used besides the result does not depend on the train set size. k must not be greater than 256 in this case.
      */
     CV_WRAP virtual void knnMatchAsync(InputArray queryDescriptors, InputArray trainDescriptors,
                                OutputArray matches,
@@ -79,15 +79,17 @@ namespace cv { namespace cuda { namespace device
     namespace bf_knnmatch
     {
         template <typename T> void matchL1_gpu(const PtrStepSzb& query, const PtrStepSzb& train, int k, const PtrStepSzb& mask,
-            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist,
+            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist,
             cudaStream_t stream);
         template <typename T> void matchL2_gpu(const PtrStepSzb& query, const PtrStepSzb& train, int k, const PtrStepSzb& mask,
-            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist,
+            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist,
             cudaStream_t stream);
         template <typename T> void matchHamming_gpu(const PtrStepSzb& query, const PtrStepSzb& train, int k, const PtrStepSzb& mask,
-            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist,
+            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist,
             cudaStream_t stream);
 
+        int tiledKnnMatchSlices(int nQuery, int nTrain);
+
         template <typename T> void match2L1_gpu(const PtrStepSzb& query, const PtrStepSzb& trains, const PtrStepSz<PtrStepb>& masks,
             const PtrStepSzb& trainIdx, const PtrStepSzb& imgIdx, const PtrStepSzb& distance,
             cudaStream_t stream);
@@ -594,7 +596,7 @@ namespace
         CV_Assert( mask.empty() || (mask.type() == CV_8UC1 && mask.rows == query.rows && mask.cols == train.rows) );
 
         typedef void (*caller_t)(const PtrStepSzb& query, const PtrStepSzb& train, int k, const PtrStepSzb& mask,
-                                 const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist,
+                                 const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist,
                                  cudaStream_t stream);
 
         static const caller_t callersL1[] =
@@ -627,7 +629,7 @@ namespace
         const int nQuery = query.rows;
         const int nTrain = train.rows;
 
-        GpuMat trainIdx, distance, allDist;
+        GpuMat trainIdx, distance, partIdx, partDist;
         if (k == 2)
         {
             _matches.create(2, nQuery, CV_32SC2);
@@ -644,13 +646,18 @@ namespace
             trainIdx = GpuMat(nQuery, k, CV_32SC1, matches.ptr(0), matches.step);
             distance = GpuMat(nQuery, k, CV_32FC1, matches.ptr(nQuery), matches.step);
 
+            // the train descriptors are matched by slices, each one gives k candidates per query
+            CV_Assert( k <= 256 );
+            const int slices = tiledKnnMatchSlices(nQuery, nTrain);
+
             BufferPool pool(stream);
-            allDist = pool.getBuffer(nQuery, nTrain, CV_32FC1);
+            partIdx = pool.getBuffer(nQuery, slices * k, CV_32SC1);
+            partDist = pool.getBuffer(nQuery, slices * k, CV_32FC1);
         }
 
         trainIdx.setTo(Scalar::all(-1), stream);
 
-        func(query, train, k, mask, trainIdx, distance, allDist, StreamAccessor::getStream(stream));
+        func(query, train, k, mask, trainIdx, distance, partIdx, partDist, StreamAccessor::getStream(stream));
     }
 
     void BFMatcher_Impl::knnMatchAsync(InputArray _queryDescriptors,
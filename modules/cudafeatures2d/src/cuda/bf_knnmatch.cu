@@ -49,6 +49,7 @@
 #include "opencv2/core/cuda/vec_distance.hpp"
 #include "opencv2/core/cuda/datamov_utils.hpp"
 #include "opencv2/core/cuda/warp_shuffle.hpp"
+#include <algorithm>
 
 namespace cv { namespace cuda { namespace device
 {
@@ -899,232 +900,209 @@ namespace cv { namespace cuda { namespace device
         }
 
         ///////////////////////////////////////////////////////////////////////////////
-        // Calc distance kernel
+        // Tiled knn match kernel
+        // The train set is split into slices, a block computes the distances of BLOCK_SIZE queries
+        // to its slice tile by tile and keeps the running k best matches of every query
+        // in shared memory. The partial results of the slices are merged by mergeKnnMatch.
 
-        template <int BLOCK_SIZE, int MAX_DESC_LEN, typename Dist, typename T, typename Mask>
-        __global__ void calcDistanceUnrolled(const PtrStepSz<T> query, const PtrStepSz<T> train, const Mask mask, PtrStepf allDist)
+        const int TILED_BLOCK_SIZE = 16;
+        const int TILED_MIN_SLICE = 1024;
+
+        template <int BLOCK_SIZE, typename Dist, typename T, typename Mask>
+        __global__ void tiledKnnMatch(const PtrStepSz<T> query, const PtrStepSz<T> train, const Mask mask, int k, int trainPerBlock,
+                                      PtrStepi partIdx, PtrStepf partDist)
         {
             extern __shared__ int smem[];
 
-            const int queryIdx = blockIdx.y * BLOCK_SIZE + threadIdx.y;
-            const int trainIdx = blockIdx.x * BLOCK_SIZE + threadIdx.x;
-
             typename Dist::value_type* s_query = (typename Dist::value_type*)(smem);
             typename Dist::value_type* s_train = (typename Dist::value_type*)(smem + BLOCK_SIZE * BLOCK_SIZE);
+            int* s_owner = smem + 2 * BLOCK_SIZE * BLOCK_SIZE;
+            float* s_bestDist = (float*)(s_owner + BLOCK_SIZE);
+            int* s_bestIdx = (int*)(s_bestDist + BLOCK_SIZE * k);
 
-            Dist dist;
-
-            #pragma unroll
-            for (int i = 0; i < MAX_DESC_LEN / BLOCK_SIZE; ++i)
-            {
-                const int loadX = threadIdx.x + i * BLOCK_SIZE;
-
-                if (loadX < query.cols)
-                {
-                    s_query[threadIdx.y * BLOCK_SIZE + threadIdx.x] = query.ptr(::min(queryIdx, query.rows - 1))[loadX];
-                    s_train[threadIdx.x * BLOCK_SIZE + threadIdx.y] = train.ptr(::min(blockIdx.x * BLOCK_SIZE + threadIdx.y, train.rows - 1))[loadX];
-                }
-                else
-                {
-                    s_query[threadIdx.y * BLOCK_SIZE + threadIdx.x] = 0;
-                    s_train[threadIdx.x * BLOCK_SIZE + threadIdx.y] = 0;
-                }
-
-                __syncthreads();
+            const int queryIdx = blockIdx.y * BLOCK_SIZE + threadIdx.y;
 
-                #pragma unroll
-                for (int j = 0; j < BLOCK_SIZE; ++j)
-                    dist.reduceIter(s_query[threadIdx.y * BLOCK_SIZE + j], s_train[j * BLOCK_SIZE + threadIdx.x]);
+            float* bestDist = s_bestDist + threadIdx.y * k;
+            int* bestIdx = s_bestIdx + threadIdx.y * k;
 
-                __syncthreads();
+            for (int i = threadIdx.x; i < k; i += BLOCK_SIZE)
+            {
+                bestDist[i] = numeric_limits<float>::max();
+                bestIdx[i] = -1;
             }
+            if (threadIdx.x == 0)
+                s_owner[threadIdx.y] = BLOCK_SIZE;
 
-            if (queryIdx < query.rows && trainIdx < train.rows)
-            {
-                float distVal = numeric_limits<float>::max();
+            __syncthreads();
 
-                if (mask(queryIdx, trainIdx))
-                    distVal = (typename Dist::result_type)dist;
+            const int trainBegin = blockIdx.x * trainPerBlock;
+            const int trainEnd = ::min(trainBegin + trainPerBlock, train.rows);
 
-                allDist.ptr(queryIdx)[trainIdx] = distVal;
-            }
-        }
+            for (int t = trainBegin; t < trainEnd; t += BLOCK_SIZE)
+            {
+                const int trainIdx = t + threadIdx.x;
 
-        template <int BLOCK_SIZE, int MAX_DESC_LEN, typename Dist, typename T, typename Mask>
-        void calcDistanceUnrolled(const PtrStepSz<T>& query, const PtrStepSz<T>& train, const Mask& mask, const PtrStepSzf& allDist, cudaStream_t stream)
-        {
-            const dim3 block(BLOCK_SIZE, BLOCK_SIZE);
-            const dim3 grid(divUp(train.rows, BLOCK_SIZE), divUp(query.rows, BLOCK_SIZE));
+                Dist dist;
 
-            const size_t smemSize = (2 * BLOCK_SIZE * BLOCK_SIZE) * sizeof(int);
+                for (int i = 0, endi = (query.cols + BLOCK_SIZE - 1) / BLOCK_SIZE; i < endi; ++i)
+                {
+                    const int loadX = threadIdx.x + i * BLOCK_SIZE;
 
-            calcDistanceUnrolled<BLOCK_SIZE, MAX_DESC_LEN, Dist><<<grid, block, smemSize, stream>>>(query, train, mask, allDist);
-            cudaSafeCall( cudaGetLastError() );
+                    if (loadX < query.cols)
+                    {
+                        s_query[threadIdx.y * BLOCK_SIZE + threadIdx.x] = query.ptr(::min(queryIdx, query.rows - 1))[loadX];
+                        s_train[threadIdx.x * BLOCK_SIZE + threadIdx.y] = train.ptr(::min(t + threadIdx.y, train.rows - 1))[loadX];
+                    }
+                    else
+                    {
+                        s_query[threadIdx.y * BLOCK_SIZE + threadIdx.x] = 0;
+                        s_train[threadIdx.x * BLOCK_SIZE + threadIdx.y] = 0;
+                    }
 
-            if (stream == 0)
-                cudaSafeCall( cudaDeviceSynchronize() );
-        }
+                    __syncthreads();
 
-        template <int BLOCK_SIZE, typename Dist, typename T, typename Mask>
-        __global__ void calcDistance(const PtrStepSz<T> query, const PtrStepSz<T> train, const Mask mask, PtrStepf allDist)
-        {
-            extern __shared__ int smem[];
+                    #pragma unroll
+                    for (int j = 0; j < BLOCK_SIZE; ++j)
+                        dist.reduceIter(s_query[threadIdx.y * BLOCK_SIZE + j], s_train[j * BLOCK_SIZE + threadIdx.x]);
 
-            const int queryIdx = blockIdx.y * BLOCK_SIZE + threadIdx.y;
-            const int trainIdx = blockIdx.x * BLOCK_SIZE + threadIdx.x;
+                    __syncthreads();
+                }
 
-            typename Dist::value_type* s_query = (typename Dist::value_type*)(smem);
-            typename Dist::value_type* s_train = (typename Dist::value_type*)(smem + BLOCK_SIZE * BLOCK_SIZE);
+                float distVal = numeric_limits<float>::max();
 
-            Dist dist;
+                if (queryIdx < query.rows && trainIdx < trainEnd && mask(queryIdx, trainIdx))
+                    distVal = (typename Dist::result_type)dist;
 
-            for (int i = 0, endi = (query.cols + BLOCK_SIZE - 1) / BLOCK_SIZE; i < endi; ++i)
-            {
-                const int loadX = threadIdx.x + i * BLOCK_SIZE;
+                // the candidates better than the current k-th match are inserted one at a time per query,
+                // the lowest train index first
+                bool pending = distVal < bestDist[k - 1];
 
-                if (loadX < query.cols)
-                {
-                    s_query[threadIdx.y * BLOCK_SIZE + threadIdx.x] = query.ptr(::min(queryIdx, query.rows - 1))[loadX];
-                    s_train[threadIdx.x * BLOCK_SIZE + threadIdx.y] = train.ptr(::min(blockIdx.x * BLOCK_SIZE + threadIdx.y, train.rows - 1))[loadX];
-                }
-                else
+                while (__syncthreads_or(pending))
                 {
-                    s_query[threadIdx.y * BLOCK_SIZE + threadIdx.x] = 0;
-                    s_train[threadIdx.x * BLOCK_SIZE + threadIdx.y] = 0;
-                }
+                    if (pending)
+                        atomicMin(s_owner + threadIdx.y, (int)threadIdx.x);
 
-                __syncthreads();
+                    __syncthreads();
 
-                #pragma unroll
-                for (int j = 0; j < BLOCK_SIZE; ++j)
-                    dist.reduceIter(s_query[threadIdx.y * BLOCK_SIZE + j], s_train[j * BLOCK_SIZE + threadIdx.x]);
+                    if (s_owner[threadIdx.y] == (int)threadIdx.x)
+                    {
+                        int pos = k - 1;
+                        for (; pos > 0 && bestDist[pos - 1] > distVal; --pos)
+                        {
+                            bestDist[pos] = bestDist[pos - 1];
+                            bestIdx[pos] = bestIdx[pos - 1];
+                        }
+                        bestDist[pos] = distVal;
+                        bestIdx[pos] = trainIdx;
+
+                        s_owner[threadIdx.y] = BLOCK_SIZE;
+                        pending = false;
+                    }
+
+                    __syncthreads();
 
-                __syncthreads();
+                    pending = pending && distVal < bestDist[k - 1];
+                }
             }
 
-            if (queryIdx < query.rows && trainIdx < train.rows)
+            if (queryIdx < query.rows)
             {
-                float distVal = numeric_limits<float>::max();
-
-                if (mask(queryIdx, trainIdx))
-                    distVal = (typename Dist::result_type)dist;
+                int* partIdxRow = partIdx.ptr(queryIdx) + blockIdx.x * k;
+                float* partDistRow = partDist.ptr(queryIdx) + blockIdx.x * k;
 
-                allDist.ptr(queryIdx)[trainIdx] = distVal;
+                for (int i = threadIdx.x; i < k; i += BLOCK_SIZE)
+                {
+                    partIdxRow[i] = bestIdx[i];
+                    partDistRow[i] = bestDist[i];
+                }
             }
         }
 
-        template <int BLOCK_SIZE, typename Dist, typename T, typename Mask>
-        void calcDistance(const PtrStepSz<T>& query, const PtrStepSz<T>& train, const Mask& mask, const PtrStepSzf& allDist, cudaStream_t stream)
+        __global__ void mergeKnnMatch(const PtrStepSzi partIdx, const PtrStepf partDist, int k, PtrStepi trainIdx, PtrStepf distance)
         {
-            const dim3 block(BLOCK_SIZE, BLOCK_SIZE);
-            const dim3 grid(divUp(train.rows, BLOCK_SIZE), divUp(query.rows, BLOCK_SIZE));
+            const int queryIdx = blockIdx.x * blockDim.x + threadIdx.x;
 
-            const size_t smemSize = (2 * BLOCK_SIZE * BLOCK_SIZE) * sizeof(int);
+            if (queryIdx >= partIdx.rows)
+                return;
 
-            calcDistance<BLOCK_SIZE, Dist><<<grid, block, smemSize, stream>>>(query, train, mask, allDist);
-            cudaSafeCall( cudaGetLastError() );
+            const int* partIdxRow = partIdx.ptr(queryIdx);
+            const float* partDistRow = partDist.ptr(queryIdx);
 
-            if (stream == 0)
-                cudaSafeCall( cudaDeviceSynchronize() );
-        }
+            float lastDist = -numeric_limits<float>::max();
+            int lastIdx = -1;
 
-        ///////////////////////////////////////////////////////////////////////////////
-        // Calc Distance dispatcher
-
-        template <typename Dist, typename T, typename Mask>
-        void calcDistanceDispatcher(const PtrStepSz<T>& query, const PtrStepSz<T>& train, const Mask& mask,
-                                    const PtrStepSzf& allDist,
-                                    cudaStream_t stream)
-        {
-            if (query.cols <= 64)
-            {
-                calcDistanceUnrolled<16, 64, Dist>(query, train, mask, allDist, stream);
-            }
-            else if (query.cols <= 128)
-            {
-                calcDistanceUnrolled<16, 128, Dist>(query, train, mask, allDist, stream);
-            }
-            /*else if (query.cols <= 256)
-            {
-                calcDistanceUnrolled<16, 256, Dist>(query, train, mask, allDist, stream);
-            }
-            else if (query.cols <= 512)
-            {
-                calcDistanceUnrolled<16, 512, Dist>(query, train, mask, allDist, stream);
-            }
-            else if (query.cols <= 1024)
-            {
-                calcDistanceUnrolled<16, 1024, Dist>(query, train, mask, allDist, stream);
-            }*/
-            else
+            for (int i = 0; i < k; ++i)
             {
-                calcDistance<16, Dist>(query, train, mask, allDist, stream);
-            }
-        }
+                // the next match in (distance, train index) order after the last one
+                float dist = numeric_limits<float>::max();
+                int bestIdx = -1;
 
-        ///////////////////////////////////////////////////////////////////////////////
-        // find knn match kernel
-
-        template <int BLOCK_SIZE>
-        __global__ void findBestMatch(PtrStepSzf allDist, int i, PtrStepi trainIdx, PtrStepf distance)
-        {
-            const int SMEM_SIZE = BLOCK_SIZE > 64 ? BLOCK_SIZE : 64;
-            __shared__ float s_dist[SMEM_SIZE];
-            __shared__ int s_trainIdx[SMEM_SIZE];
-
-            const int queryIdx = blockIdx.x;
+                for (int j = 0; j < partIdx.cols; ++j)
+                {
+                    const int idx = partIdxRow[j];
+                    const float val = partDistRow[j];
 
-            float* allDistRow = allDist.ptr(queryIdx);
+                    if (idx < 0)
+                        continue;
 
-            float dist = numeric_limits<float>::max();
-            int bestIdx = -1;
+                    const bool after = val > lastDist || (val == lastDist && idx > lastIdx);
+                    const bool before = val < dist || (val == dist && idx < bestIdx);
 
-            for (int i = threadIdx.x; i < allDist.cols; i += BLOCK_SIZE)
-            {
-                float reg = allDistRow[i];
-                if (reg < dist)
-                {
-                    dist = reg;
-                    bestIdx = i;
+                    if (after && before)
+                    {
+                        dist = val;
+                        bestIdx = idx;
+                    }
                 }
-            }
 
-            s_dist[threadIdx.x] = dist;
-            s_trainIdx[threadIdx.x] = bestIdx;
-            __syncthreads();
+                if (bestIdx < 0)
+                    break;
 
-            reduceKeyVal<BLOCK_SIZE>(s_dist, dist, s_trainIdx, bestIdx, threadIdx.x, less<float>());
+                trainIdx.ptr(queryIdx)[i] = bestIdx;
+                distance.ptr(queryIdx)[i] = dist;
 
-            if (threadIdx.x == 0)
-            {
-                if (dist < numeric_limits<float>::max())
-                {
-                    allDistRow[bestIdx] = numeric_limits<float>::max();
-                    trainIdx.ptr(queryIdx)[i] = bestIdx;
-                    distance.ptr(queryIdx)[i] = dist;
-                }
+                lastDist = dist;
+                lastIdx = bestIdx;
             }
         }
 
-        template <int BLOCK_SIZE>
-        void findKnnMatch(int k, const PtrStepSzi& trainIdx, const PtrStepSzf& distance, const PtrStepSzf& allDist, cudaStream_t stream)
+        template <int BLOCK_SIZE, typename Dist, typename T, typename Mask>
+        void tiledKnnMatch(const PtrStepSz<T>& query, const PtrStepSz<T>& train, int k, const Mask& mask,
+                           const PtrStepSzi& trainIdx, const PtrStepSzf& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist,
+                           cudaStream_t stream)
         {
-            const dim3 block(BLOCK_SIZE, 1, 1);
-            const dim3 grid(trainIdx.rows, 1, 1);
+            const int slices = partIdx.cols / k;
+            const int trainPerBlock = divUp(divUp(train.rows, slices), BLOCK_SIZE) * BLOCK_SIZE;
 
-            for (int i = 0; i < k; ++i)
-            {
-                findBestMatch<BLOCK_SIZE><<<grid, block, 0, stream>>>(allDist, i, trainIdx, distance);
-                cudaSafeCall( cudaGetLastError() );
-            }
+            const dim3 block(BLOCK_SIZE, BLOCK_SIZE);
+            const dim3 grid(divUp(train.rows, trainPerBlock), divUp(query.rows, BLOCK_SIZE));
+
+            const size_t smemSize = (2 * BLOCK_SIZE * BLOCK_SIZE + BLOCK_SIZE) * sizeof(int) + BLOCK_SIZE * k * (sizeof(float) + sizeof(int));
+
+            tiledKnnMatch<BLOCK_SIZE, Dist><<<grid, block, smemSize, stream>>>(query, train, mask, k, trainPerBlock, partIdx, partDist);
+            cudaSafeCall( cudaGetLastError() );
+
+            // rounding of the slice length may leave the last slices without a block
+            const PtrStepSzi usedPartIdx(partIdx.rows, grid.x * k, partIdx.data, partIdx.step);
+
+            mergeKnnMatch<<<divUp(query.rows, 128), 128, 0, stream>>>(usedPartIdx, partDist, k, trainIdx, distance);
+            cudaSafeCall( cudaGetLastError() );
 
             if (stream == 0)
                 cudaSafeCall( cudaDeviceSynchronize() );
         }
 
-        void findKnnMatchDispatcher(int k, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream)
+        int tiledKnnMatchSlices(int nQuery, int nTrain)
         {
-            findKnnMatch<256>(k, static_cast<PtrStepSzi>(trainIdx), static_cast<PtrStepSzf>(distance), allDist, stream);
+            int device, smCount;
+            cudaSafeCall( cudaGetDevice(&device) );
+            cudaSafeCall( cudaDeviceGetAttribute(&smCount, cudaDevAttrMultiProcessorCount, device) );
+
+            // enough blocks to fill the device, every slice is at least TILED_MIN_SLICE train descriptors long
+            const int queryBlocks = divUp(nQuery, TILED_BLOCK_SIZE);
+            const int maxSlices = divUp(nTrain, TILED_MIN_SLICE);
+
+            return std::max(1, std::min(maxSlices, divUp(4 * smCount, queryBlocks)));
         }
 
         ///////////////////////////////////////////////////////////////////////////////
@@ -1132,7 +1110,7 @@ namespace cv { namespace cuda { namespace device
 
         template <typename Dist, typename T, typename Mask>
         void matchDispatcher(const PtrStepSz<T>& query, const PtrStepSz<T>& train, int k, const Mask& mask,
-            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist,
+            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist,
             cudaStream_t stream)
         {
             if (k == 2)
@@ -1141,8 +1119,8 @@ namespace cv { namespace cuda { namespace device
             }
             else
             {
-                calcDistanceDispatcher<Dist>(query, train, mask, allDist, stream);
-                findKnnMatchDispatcher(k, trainIdx, distance, allDist, stream);
+                tiledKnnMatch<TILED_BLOCK_SIZE, Dist>(query, train, k, mask,
+                    static_cast<PtrStepSzi>(trainIdx), static_cast<PtrStepSzf>(distance), partIdx, partDist, stream);
             }
         }
 
@@ -1150,54 +1128,69 @@ namespace cv { namespace cuda { namespace device
         // knn match caller
 
         template <typename T> void matchL1_gpu(const PtrStepSzb& query, const PtrStepSzb& train, int k, const PtrStepSzb& mask,
-            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist,
+            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist,
             cudaStream_t stream)
         {
             if (mask.data)
-                matchDispatcher< L1Dist<T> >(static_cast< PtrStepSz<T> >(query), static_cast< PtrStepSz<T> >(train), k, SingleMask(mask), trainIdx, distance, allDist, stream);
+                matchDispatcher< L1Dist<T> >(static_cast< PtrStepSz<T> >(query), static_cast< PtrStepSz<T> >(train), k, SingleMask(mask), trainIdx, distance, partIdx, partDist, stream);
             else
-                matchDispatcher< L1Dist<T> >(static_cast< PtrStepSz<T> >(query), static_cast< PtrStepSz<T> >(train), k, WithOutMask(), trainIdx, distance, allDist, stream);
+                matchDispatcher< L1Dist<T> >(static_cast< PtrStepSz<T> >(query), static_cast< PtrStepSz<T> >(train), k, WithOutMask(), trainIdx, distance, partIdx, partDist, stream);
         }
 
-        template void matchL1_gpu<uchar >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        //template void matchL1_gpu<schar >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        template void matchL1_gpu<ushort>(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        template void matchL1_gpu<short >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        template void matchL1_gpu<int   >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        template void matchL1_gpu<float >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
+        template void matchL1_gpu<uchar >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        //template void matchL1_gpu<schar >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        template void matchL1_gpu<ushort>(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        template void matchL1_gpu<short >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        template void matchL1_gpu<int   >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        template void matchL1_gpu<float >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
 
         template <typename T> void matchL2_gpu(const PtrStepSzb& query, const PtrStepSzb& train, int k, const PtrStepSzb& mask,
-            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist,
+            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist,
             cudaStream_t stream)
         {
             if (mask.data)
-                matchDispatcher<L2Dist>(static_cast< PtrStepSz<T> >(query), static_cast< PtrStepSz<T> >(train), k, SingleMask(mask), trainIdx, distance, allDist, stream);
+                matchDispatcher<L2Dist>(static_cast< PtrStepSz<T> >(query), static_cast< PtrStepSz<T> >(train), k, SingleMask(mask), trainIdx, distance, partIdx, partDist, stream);
             else
-                matchDispatcher<L2Dist>(static_cast< PtrStepSz<T> >(query), static_cast< PtrStepSz<T> >(train), k, WithOutMask(), trainIdx, distance, allDist, stream);
+                matchDispatcher<L2Dist>(static_cast< PtrStepSz<T> >(query), static_cast< PtrStepSz<T> >(train), k, WithOutMask(), trainIdx, distance, partIdx, partDist, stream);
         }
 
-        //template void matchL2_gpu<uchar >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        //template void matchL2_gpu<schar >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        //template void matchL2_gpu<ushort>(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        //template void matchL2_gpu<short >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        //template void matchL2_gpu<int   >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        template void matchL2_gpu<float >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
+        //template void matchL2_gpu<uchar >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        //template void matchL2_gpu<schar >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        //template void matchL2_gpu<ushort>(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        //template void matchL2_gpu<short >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        //template void matchL2_gpu<int   >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        template void matchL2_gpu<float >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
 
         template <typename T> void matchHamming_gpu(const PtrStepSzb& query, const PtrStepSzb& train, int k, const PtrStepSzb& mask,
-            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist,
+            const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist,
             cudaStream_t stream)
         {
-            if (mask.data)
-                matchDispatcher<HammingDist>(static_cast< PtrStepSz<T> >(query), static_cast< PtrStepSz<T> >(train), k, SingleMask(mask), trainIdx, distance, allDist, stream);
+            const size_t rowSize = query.cols * sizeof(T);
+            const bool packed = sizeof(T) < sizeof(int) && k != 2 && rowSize % sizeof(int) == 0 &&
+                                ((size_t)query.data | query.step | (size_t)train.data | train.step) % sizeof(int) == 0;
+
+            if (packed)
+            {
+                // xor and popc of whole 32-bit words, the distance is the same
+                const PtrStepSz<int> query32(query.rows, static_cast<int>(rowSize / sizeof(int)), (int*)query.data, query.step);
+                const PtrStepSz<int> train32(train.rows, static_cast<int>(rowSize / sizeof(int)), (int*)train.data, train.step);
+
+                if (mask.data)
+                    matchDispatcher<HammingDist>(query32, train32, k, SingleMask(mask), trainIdx, distance, partIdx, partDist, stream);
+                else
+                    matchDispatcher<HammingDist>(query32, train32, k, WithOutMask(), trainIdx, distance, partIdx, partDist, stream);
+            }
+            else if (mask.data)
+                matchDispatcher<HammingDist>(static_cast< PtrStepSz<T> >(query), static_cast< PtrStepSz<T> >(train), k, SingleMask(mask), trainIdx, distance, partIdx, partDist, stream);
             else
-                matchDispatcher<HammingDist>(static_cast< PtrStepSz<T> >(query), static_cast< PtrStepSz<T> >(train), k, WithOutMask(), trainIdx, distance, allDist, stream);
+                matchDispatcher<HammingDist>(static_cast< PtrStepSz<T> >(query), static_cast< PtrStepSz<T> >(train), k, WithOutMask(), trainIdx, distance, partIdx, partDist, stream);
         }
 
-        template void matchHamming_gpu<uchar >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        //template void matchHamming_gpu<schar >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        template void matchHamming_gpu<ushort>(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        //template void matchHamming_gpu<short >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
-        template void matchHamming_gpu<int   >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzf& allDist, cudaStream_t stream);
+        template void matchHamming_gpu<uchar >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        //template void matchHamming_gpu<schar >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        template void matchHamming_gpu<ushort>(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        //template void matchHamming_gpu<short >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
+        template void matchHamming_gpu<int   >(const PtrStepSzb& queryDescs, const PtrStepSzb& trainDescs, int k, const PtrStepSzb& mask, const PtrStepSzb& trainIdx, const PtrStepSzb& distance, const PtrStepSzi& partIdx, const PtrStepSzf& partDist, cudaStream_t stream);
 
         template <typename T> void match2L1_gpu(const PtrStepSzb& query, const PtrStepSzb& trains, const PtrStepSz<PtrStepb>& masks,
             const PtrStepSzb& trainIdx, const PtrStepSzb& imgIdx, const PtrStepSzb& distance,
@@ -756,5 +756,70 @@ INSTANTIATE_TEST_CASE_P(CUDA_Features2D, BruteForceMatcher, testing::Combine(
     testing::Values(DescriptorSize(57), DescriptorSize(64), DescriptorSize(83), DescriptorSize(128), DescriptorSize(179), DescriptorSize(256), DescriptorSize(304)),
     testing::Values(UseMask(false), UseMask(true))));
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// BruteForceMatcher with a large train set
+
+PARAM_TEST_CASE(BruteForceMatcherLargeTrain, cv::cuda::DeviceInfo, NormCode)
+{
+    cv::cuda::DeviceInfo devInfo;
+    int normCode;
+
+    virtual void SetUp()
+    {
+        devInfo = GET_PARAM(0);
+        normCode = GET_PARAM(1);
+
+        cv::cuda::setDevice(devInfo.deviceID());
+    }
+};
+
+CUDA_TEST_P(BruteForceMatcherLargeTrain, KnnMatch_5)
+{
+    const int knn = 5;
+
+    cv::Mat query, train;
+    if (normCode == cv::NORM_HAMMING)
+    {
+        query = randomMat(cv::Size(32, 200), CV_8UC1, 0.0, 255.0);
+        train = randomMat(cv::Size(32, 20000), CV_8UC1, 0.0, 255.0);
+    }
+    else
+    {
+        query = randomMat(cv::Size(128, 200), CV_32FC1, 0.0, 1.0);
+        train = randomMat(cv::Size(128, 20000), CV_32FC1, 0.0, 1.0);
+    }
+
+    cv::Ptr<cv::cuda::DescriptorMatcher> matcher =
+            cv::cuda::DescriptorMatcher::createBFMatcher(normCode);
+
+    std::vector< std::vector<cv::DMatch> > matches;
+    matcher->knnMatch(loadMat(query), loadMat(train), matches, knn);
+
+    cv::BFMatcher matcher_gold(normCode);
+    std::vector< std::vector<cv::DMatch> > matches_gold;
+    matcher_gold.knnMatch(query, train, matches_gold, knn);
+
+    ASSERT_EQ(matches_gold.size(), matches.size());
+
+    // equal distances may come in a different order, so the distances are compared
+    for (size_t i = 0; i < matches.size(); i++)
+    {
+        ASSERT_EQ(static_cast<size_t>(knn), matches[i].size());
+
+        for (int k = 0; k < knn; k++)
+        {
+            const cv::DMatch& match = matches[i][k];
+
+            EXPECT_EQ((int)i, match.queryIdx);
+            EXPECT_NEAR(matches_gold[i][k].distance, match.distance, 1e-3);
+            EXPECT_NEAR(cv::norm(query.row((int)i), train.row(match.trainIdx), normCode), match.distance, 1e-3);
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_Features2D, BruteForceMatcherLargeTrain, testing::Combine(
+    ALL_DEVICES,
+    testing::Values(NormCode(cv::NORM_L1), NormCode(cv::NORM_L2), NormCode(cv::NORM_HAMMING))));
+
 }} // namespace
 #endif // HAVE_CUDA
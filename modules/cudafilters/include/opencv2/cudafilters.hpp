@@ -251,7 +251,8 @@ CV_EXPORTS_W Ptr<Filter> createGaussianFilter(int srcType, int dstType, Size ksi
 -   **MORPH_TOPHAT** "top hat"
 -   **MORPH_BLACKHAT** "black hat"
 @param srcType Input/output image type. Only CV_8UC1, CV_8UC4, CV_32FC1 and CV_32FC4 are supported.
-@param kernel 2D 8-bit structuring element for the morphological operation.
+@param kernel 2D 8-bit structuring element for the morphological operation. Rectangular elements larger
+than 5x5 are applied as separable row and column passes whose cost does not depend on the kernel size.
 @param anchor Anchor position within the structuring element. Negative values mean that the anchor
 is at the center.
 @param iterations Number of times erosion and dilation to be applied.
@@ -318,15 +319,19 @@ CV_EXPORTS_W Ptr<Filter> createColumnSumFilter(int srcType, int dstType, int ksi
 
 /** @brief Performs median filtering for each point of the source image.
 
-@param srcType type of of source image. Only CV_8UC1 images are supported for now.
+@param srcType type of of source image. Only CV_8UC1 and CV_16UC1 images are supported for now.
 @param windowSize Size of the kernerl used for the filtering. Uses a (windowSize x windowSize) filter.
 @param partition Specifies the parallel granularity of the workload. This parameter should be used GPU experts when optimizing performance.
 
-Outputs an image that has been filtered using a median-filtering formulation.
+Outputs an image that has been filtered using a median-filtering formulation. The cost per pixel does
+not depend on windowSize.
 
 Details on this algorithm can be found in:
 Green, O., 2017. "Efficient scalable median filtering using histogram-based operations",
                   IEEE Transactions on Image Processing, 27(5), pp.2217-2228.
+
+CV_16UC1 images are processed in tiles of columns with replicated borders, and use up to 512 MB of
+device memory for the histograms.
  */
 CV_EXPORTS_W Ptr<Filter> createMedianFilter(int srcType, int windowSize, int partition = 128);
 
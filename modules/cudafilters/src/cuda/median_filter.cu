@@ -323,6 +323,170 @@ namespace cv { namespace cuda { namespace device
         }
     }
 
+    // 16-bit version of the same scheme. The column histograms of 65536 bins are too large to keep for
+    // the whole image width, so each block sweeps a tile of columns down a band of rows, using only the
+    // histograms of the tile and its halo. The fine histograms of the window are updated lazily per
+    // coarse bin, as in Perreault, S., Hebert, P., 2007. "Median filtering in constant time",
+    // IEEE Transactions on Image Processing, 16(9), pp.2389-2394.
+    // The borders are replicated. One thread handles one histogram bin.
+
+    __device__ __forceinline__ void histogramScan256(int* scan)
+    {
+        const int tx = threadIdx.x;
+        for (int offset = 1; offset < 256; offset <<= 1)
+        {
+            const int v = tx >= offset ? scan[tx - offset] : 0;
+            __syncthreads();
+            scan[tx] += v;
+            __syncthreads();
+        }
+    }
+
+    __global__ void cuMedianFilter16u(const PtrStepSz<ushort> src, PtrStepSz<ushort> dest,
+                                      PtrStep<ushort> colFine, PtrStep<int> colCoarse, PtrStep<int> winFine,
+                                      const int r, const int tileWidth, const int tileCount, const int bandRows, const int bandCount)
+    {
+        __shared__ int HCoarse[256];
+        __shared__ int HScan[256];
+        __shared__ int luc[256];
+
+        __shared__ int medBin, countBelow;
+
+        const int tx = threadIdx.x;
+        const int lastRow = src.rows - 1, lastCol = src.cols - 1;
+        const int medPos = 2 * r * r + 2 * r;
+
+        // the histograms of this block: tileWidth + 2 * r columns and 256 window rows
+        const int histCols = tileWidth + 2 * r;
+        const int colOfs = blockIdx.x * histCols;
+
+        for (int item = blockIdx.x; item < tileCount * bandCount; item += gridDim.x)
+        {
+            const int x0 = (item % tileCount) * tileWidth;
+            const int y0 = (item / tileCount) * bandRows;
+            const int tw = ::min(tileWidth, src.cols - x0);
+            const int w = tw + 2 * r;
+            const int y1 = ::min(y0 + bandRows, src.rows);
+
+            // The column histograms are zero here. Fill them with the window rows of the first row.
+            for (int l = tx; l < w; l += blockDim.x)
+            {
+                const int x = ::min(::max(x0 - r + l, 0), lastCol);
+                ushort* fine = colFine.ptr(colOfs + l);
+                int* coarse = colCoarse.ptr(colOfs + l);
+                for (int i = y0 - r; i <= y0 + r; ++i)
+                {
+                    const int v = src(::min(::max(i, 0), lastRow), x);
+                    ++fine[v];
+                    ++coarse[v >> 8];
+                }
+            }
+            __syncthreads();
+
+            for (int y = y0; y < y1; ++y)
+            {
+                if (y > y0)
+                {
+                    const int ySub = ::max(y - r - 1, 0), yAdd = ::min(y + r, lastRow);
+                    for (int l = tx; l < w; l += blockDim.x)
+                    {
+                        const int x = ::min(::max(x0 - r + l, 0), lastCol);
+                        ushort* fine = colFine.ptr(colOfs + l);
+                        int* coarse = colCoarse.ptr(colOfs + l);
+                        const int vSub = src(ySub, x), vAdd = src(yAdd, x);
+                        --fine[vSub];
+                        ++fine[vAdd];
+                        --coarse[vSub >> 8];
+                        ++coarse[vAdd >> 8];
+                    }
+                    __syncthreads();
+                }
+
+                int sum = 0;
+                for (int l = 0; l <= 2 * r; ++l)
+                    sum += colCoarse.ptr(colOfs + l)[tx];
+                HCoarse[tx] = sum;
+                luc[tx] = 0;
+                __syncthreads();
+
+                for (int l = 0; l < tw; ++l)
+                {
+                    HScan[tx] = HCoarse[tx];
+                    __syncthreads();
+                    histogramScan256(HScan);
+
+                    if (HScan[tx] > medPos && (tx == 0 || HScan[tx - 1] <= medPos))
+                    {
+                        medBin = tx;
+                        countBelow = tx > 0 ? HScan[tx - 1] : 0;
+                    }
+                    __syncthreads();
+
+                    const int bin = medBin;
+                    const int fineOfs = (bin << 8) + tx;
+
+                    // bring the fine histogram of the median bin to the window columns [l, l + 2 * r]
+                    int* fineWin = winFine.ptr(blockIdx.x * 256 + bin);
+                    int loopIndex = luc[bin];
+                    int v;
+                    if (loopIndex <= l)
+                    {
+                        v = 0;
+                        for (loopIndex = l; loopIndex <= l + 2 * r; ++loopIndex)
+                            v += colFine.ptr(colOfs + loopIndex)[fineOfs];
+                    }
+                    else
+                    {
+                        v = fineWin[tx];
+                        for ( ; loopIndex <= l + 2 * r; ++loopIndex)
+                            v += colFine.ptr(colOfs + loopIndex)[fineOfs] - colFine.ptr(colOfs + loopIndex - 2 * r - 1)[fineOfs];
+                    }
+                    fineWin[tx] = v;
+                    HScan[tx] = v;
+                    __syncthreads();
+
+                    if (tx == 0)
+                        luc[bin] = l + 2 * r + 1;
+
+                    histogramScan256(HScan);
+
+                    const int leftOver = medPos - countBelow;
+                    if (HScan[tx] > leftOver && (tx == 0 || HScan[tx - 1] <= leftOver))
+                        dest(y, x0 + l) = static_cast<ushort>(fineOfs);
+
+                    if (l + 1 < tw)
+                        HCoarse[tx] += colCoarse.ptr(colOfs + l + 2 * r + 1)[tx] - colCoarse.ptr(colOfs + l)[tx];
+                    __syncthreads();
+                }
+            }
+
+            // leave zero column histograms for the next tile
+            for (int l = tx; l < w; l += blockDim.x)
+            {
+                const int x = ::min(::max(x0 - r + l, 0), lastCol);
+                ushort* fine = colFine.ptr(colOfs + l);
+                int* coarse = colCoarse.ptr(colOfs + l);
+                for (int i = y1 - 1 - r; i <= y1 - 1 + r; ++i)
+                {
+                    const int v = src(::min(::max(i, 0), lastRow), x);
+                    --fine[v];
+                    --coarse[v >> 8];
+                }
+            }
+            __syncthreads();
+        }
+    }
+
+    void medianFiltering16u_gpu(const PtrStepSz<ushort> src, PtrStepSz<ushort> dst, PtrStep<ushort> colFine, PtrStep<int> colCoarse, PtrStep<int> winFine,
+                                int kernel, int tileWidth, int tileCount, int bandRows, int bandCount, int blocks, cudaStream_t stream)
+    {
+        cuMedianFilter16u<<<blocks, 256, 0, stream>>>(src, dst, colFine, colCoarse, winFine, kernel, tileWidth, tileCount, bandRows, bandCount);
+        cudaSafeCall( cudaGetLastError() );
+
+        if (!stream)
+            cudaSafeCall( cudaDeviceSynchronize() );
+    }
+
     void medianFiltering_gpu(const PtrStepSzb src, PtrStepSzb dst, PtrStepSzi devHist, PtrStepSzi devCoarseHist,int kernel, int partitions,cudaStream_t stream){
         int medPos=2*kernel*kernel+2*kernel;
         dim3 gridDim; gridDim.x=partitions;
@@ -0,0 +1,261 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+// Rectangular erosion and dilation with a constant number of operations per pixel,
+// regardless of the kernel size. Details on this algorithm can be found in:
+// van Herk, M., 1992. "A fast algorithm for local minimum and maximum filters on rectangular
+//                      and octagonal kernels", Pattern Recognition Letters, 13(7), pp.517-521.
+// Gil, J., Werman, M., 1993. "Computing 2-D min, median, and max filters",
+//                            IEEE Transactions on PAMI, 15(5), pp.504-507.
+
+#if !defined CUDA_DISABLER
+
+#include "opencv2/core/cuda/common.hpp"
+#include "opencv2/core/cuda/border_interpolate.hpp"
+
+namespace cv { namespace cuda { namespace device
+{
+    namespace morph_rect
+    {
+        __device__ __forceinline__ uchar  minOf(uchar a, uchar b) { return ::min(a, b); }
+        __device__ __forceinline__ float  minOf(float a, float b) { return ::fminf(a, b); }
+        __device__ __forceinline__ uchar4 minOf(const uchar4& a, const uchar4& b) { return make_uchar4(::min(a.x, b.x), ::min(a.y, b.y), ::min(a.z, b.z), ::min(a.w, b.w)); }
+        __device__ __forceinline__ float4 minOf(const float4& a, const float4& b) { return make_float4(::fminf(a.x, b.x), ::fminf(a.y, b.y), ::fminf(a.z, b.z), ::fminf(a.w, b.w)); }
+
+        __device__ __forceinline__ uchar  maxOf(uchar a, uchar b) { return ::max(a, b); }
+        __device__ __forceinline__ float  maxOf(float a, float b) { return ::fmaxf(a, b); }
+        __device__ __forceinline__ uchar4 maxOf(const uchar4& a, const uchar4& b) { return make_uchar4(::max(a.x, b.x), ::max(a.y, b.y), ::max(a.z, b.z), ::max(a.w, b.w)); }
+        __device__ __forceinline__ float4 maxOf(const float4& a, const float4& b) { return make_float4(::fmaxf(a.x, b.x), ::fmaxf(a.y, b.y), ::fmaxf(a.z, b.z), ::fmaxf(a.w, b.w)); }
+
+        struct Erode
+        {
+            template <typename T> __device__ __forceinline__ T operator ()(const T& a, const T& b) const { return minOf(a, b); }
+        };
+
+        struct Dilate
+        {
+            template <typename T> __device__ __forceinline__ T operator ()(const T& a, const T& b) const { return maxOf(a, b); }
+        };
+
+        // The padded row (column) of length len = size + ksize - 1 is split into segments of ksize elements.
+        // g holds the running extremum from the start of each segment, h the one from its end, so that
+        // any window of ksize elements is covered by the suffix of one segment and the prefix of the next.
+
+        template <typename T, class Op>
+        __global__ void rowSegments(const PtrStepSz<T> src, PtrStep<T> g, PtrStep<T> h, const int ksize, const int anchor, const int len, const Op op)
+        {
+            const int seg = blockIdx.x * blockDim.x + threadIdx.x;
+            const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+            const int start = seg * ksize;
+
+            if (y >= src.rows || start >= len)
+                return;
+
+            const int end = ::min(start + ksize, len);
+
+            const BrdRowReflect101<T> brd(src.cols);
+            const T* srcRow = src.ptr(y);
+            T* gRow = g.ptr(y);
+            T* hRow = h.ptr(y);
+
+            T val = srcRow[brd.idx_col(start - anchor)];
+            gRow[start] = val;
+            for (int j = start + 1; j < end; ++j)
+            {
+                val = op(val, srcRow[brd.idx_col(j - anchor)]);
+                gRow[j] = val;
+            }
+
+            val = srcRow[brd.idx_col(end - 1 - anchor)];
+            hRow[end - 1] = val;
+            for (int j = end - 2; j >= start; --j)
+            {
+                val = op(val, srcRow[brd.idx_col(j - anchor)]);
+                hRow[j] = val;
+            }
+        }
+
+        template <typename T, class Op>
+        __global__ void rowMerge(const PtrStep<T> g, const PtrStep<T> h, PtrStepSz<T> dst, const int ksize, const Op op)
+        {
+            const int x = blockIdx.x * blockDim.x + threadIdx.x;
+            const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+            if (x >= dst.cols || y >= dst.rows)
+                return;
+
+            dst(y, x) = op(h(y, x), g(y, x + ksize - 1));
+        }
+
+        template <typename T, class Op>
+        __global__ void colSegments(const PtrStepSz<T> src, PtrStep<T> g, PtrStep<T> h, const int ksize, const int anchor, const int len, const Op op)
+        {
+            const int x = blockIdx.x * blockDim.x + threadIdx.x;
+            const int seg = blockIdx.y * blockDim.y + threadIdx.y;
+
+            const int start = seg * ksize;
+
+            if (x >= src.cols || start >= len)
+                return;
+
+            const int end = ::min(start + ksize, len);
+
+            const BrdColReflect101<T> brd(src.rows);
+
+            T val = src(brd.idx_row(start - anchor), x);
+            g(start, x) = val;
+            for (int i = start + 1; i < end; ++i)
+            {
+                val = op(val, src(brd.idx_row(i - anchor), x));
+                g(i, x) = val;
+            }
+
+            val = src(brd.idx_row(end - 1 - anchor), x);
+            h(end - 1, x) = val;
+            for (int i = end - 2; i >= start; --i)
+            {
+                val = op(val, src(brd.idx_row(i - anchor), x));
+                h(i, x) = val;
+            }
+        }
+
+        template <typename T, class Op>
+        __global__ void colMerge(const PtrStep<T> g, const PtrStep<T> h, PtrStepSz<T> dst, const int ksize, const Op op)
+        {
+            const int x = blockIdx.x * blockDim.x + threadIdx.x;
+            const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+            if (x >= dst.cols || y >= dst.rows)
+                return;
+
+            dst(y, x) = op(h(y, x), g(y + ksize - 1, x));
+        }
+
+        template <typename T, class Op>
+        void rowPass(const PtrStepSz<T> src, PtrStep<T> g, PtrStep<T> h, PtrStepSz<T> dst, int ksize, int anchor, cudaStream_t stream)
+        {
+            const int len = src.cols + ksize - 1;
+            const int segCount = divUp(len, ksize);
+
+            const dim3 segBlock(32, 8);
+            const dim3 segGrid(divUp(segCount, segBlock.x), divUp(src.rows, segBlock.y));
+
+            rowSegments<T, Op><<<segGrid, segBlock, 0, stream>>>(src, g, h, ksize, anchor, len, Op());
+            cudaSafeCall( cudaGetLastError() );
+
+            const dim3 block(32, 8);
+            const dim3 grid(divUp(dst.cols, block.x), divUp(dst.rows, block.y));
+
+            rowMerge<T, Op><<<grid, block, 0, stream>>>(g, h, dst, ksize, Op());
+            cudaSafeCall( cudaGetLastError() );
+        }
+
+        template <typename T, class Op>
+        void colPass(const PtrStepSz<T> src, PtrStep<T> g, PtrStep<T> h, PtrStepSz<T> dst, int ksize, int anchor, cudaStream_t stream)
+        {
+            const int len = src.rows + ksize - 1;
+            const int segCount = divUp(len, ksize);
+
+            const dim3 segBlock(32, 8);
+            const dim3 segGrid(divUp(src.cols, segBlock.x), divUp(segCount, segBlock.y));
+
+            colSegments<T, Op><<<segGrid, segBlock, 0, stream>>>(src, g, h, ksize, anchor, len, Op());
+            cudaSafeCall( cudaGetLastError() );
+
+            const dim3 block(32, 8);
+            const dim3 grid(divUp(dst.cols, block.x), divUp(dst.rows, block.y));
+
+            colMerge<T, Op><<<grid, block, 0, stream>>>(g, h, dst, ksize, Op());
+            cudaSafeCall( cudaGetLastError() );
+        }
+
+        template <typename T, class Op>
+        void morph(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h,
+                   int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream)
+        {
+            if (kHeight == 1)
+            {
+                rowPass<T, Op>((PtrStepSz<T>) src, (PtrStep<T>) g, (PtrStep<T>) h, (PtrStepSz<T>) dst, kWidth, anchorX, stream);
+            }
+            else if (kWidth == 1)
+            {
+                colPass<T, Op>((PtrStepSz<T>) src, (PtrStep<T>) g, (PtrStep<T>) h, (PtrStepSz<T>) dst, kHeight, anchorY, stream);
+            }
+            else
+            {
+                rowPass<T, Op>((PtrStepSz<T>) src, (PtrStep<T>) g, (PtrStep<T>) h, (PtrStepSz<T>) buf, kWidth, anchorX, stream);
+                colPass<T, Op>((PtrStepSz<T>) buf, (PtrStep<T>) g, (PtrStep<T>) h, (PtrStepSz<T>) dst, kHeight, anchorY, stream);
+            }
+
+            if (stream == 0)
+                cudaSafeCall( cudaDeviceSynchronize() );
+        }
+
+        template <typename T>
+        void erode(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h,
+                   int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream)
+        {
+            morph<T, Erode>(src, dst, buf, g, h, kWidth, kHeight, anchorX, anchorY, stream);
+        }
+
+        template <typename T>
+        void dilate(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h,
+                    int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream)
+        {
+            morph<T, Dilate>(src, dst, buf, g, h, kWidth, kHeight, anchorX, anchorY, stream);
+        }
+
+        template void erode<uchar >(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h, int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream);
+        template void erode<uchar4>(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h, int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream);
+        template void erode<float >(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h, int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream);
+        template void erode<float4>(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h, int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream);
+
+        template void dilate<uchar >(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h, int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream);
+        template void dilate<uchar4>(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h, int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream);
+        template void dilate<float >(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h, int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream);
+        template void dilate<float4>(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h, int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream);
+    }
+}}}
+
+#endif // CUDA_DISABLER
@@ -514,6 +514,20 @@ Ptr<Filter> cv::cuda::createGaussianFilter(int srcType, int dstType, Size ksize,
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Morphology Filter
 
+namespace cv { namespace cuda { namespace device
+{
+    namespace morph_rect
+    {
+        template <typename T>
+        void erode(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h,
+                   int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream);
+
+        template <typename T>
+        void dilate(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h,
+                    int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream);
+    }
+}}}
+
 namespace
 {
     class MorphologyFilter : public Filter
@@ -528,6 +542,10 @@ namespace
                                                const Npp8u* pMask, NppiSize oMaskSize, NppiPoint oAnchor);
         typedef NppStatus (*nppMorfFilter32f_t)(const Npp32f* pSrc, Npp32s nSrcStep, Npp32f* pDst, Npp32s nDstStep, NppiSize oSizeROI,
                                                 const Npp8u* pMask, NppiSize oMaskSize, NppiPoint oAnchor);
+        typedef void (*rectFilter_t)(PtrStepSzb src, PtrStepSzb dst, PtrStepSzb buf, PtrStepSzb g, PtrStepSzb h,
+                                     int kWidth, int kHeight, int anchorX, int anchorY, cudaStream_t stream);
+
+        void applyRect(const GpuMat& src, GpuMat& dst, Stream& stream);
 
         int type_;
         GpuMat kernel_;
@@ -536,8 +554,13 @@ namespace
         nppMorfFilter8u_t func8u_;
         nppMorfFilter32f_t func32f_;
 
+        // separable path for large rectangular kernels
+        Size rectSize_;
+        rectFilter_t rectFunc_;
+
         GpuMat srcBorder_;
         GpuMat buf_;
+        GpuMat rectG_, rectH_;
     };
 
     MorphologyFilter::MorphologyFilter(int op, int srcType, InputArray _kernel, Point anchor, int iterations) :
@@ -553,6 +576,17 @@ namespace
             {0, nppiErode_32f_C1R, 0, 0, nppiErode_32f_C4R },
             {0, nppiDilate_32f_C1R, 0, 0, nppiDilate_32f_C4R }
         };
+        static const rectFilter_t rectFuncs[2][2][5] =
+        {
+            {
+                {0, cv::cuda::device::morph_rect::erode<uchar>, 0, 0, cv::cuda::device::morph_rect::erode<uchar4> },
+                {0, cv::cuda::device::morph_rect::dilate<uchar>, 0, 0, cv::cuda::device::morph_rect::dilate<uchar4> }
+            },
+            {
+                {0, cv::cuda::device::morph_rect::erode<float>, 0, 0, cv::cuda::device::morph_rect::erode<float4> },
+                {0, cv::cuda::device::morph_rect::dilate<float>, 0, 0, cv::cuda::device::morph_rect::dilate<float4> }
+            }
+        };
 
         CV_Assert( op == MORPH_ERODE || op == MORPH_DILATE );
         CV_Assert( srcType == CV_8UC1 || srcType == CV_8UC4 || srcType == CV_32FC1 || srcType == CV_32FC4 );
@@ -580,6 +614,15 @@ namespace
 
         CV_Assert( kernel.channels() == 1 );
 
+        // Rectangular kernels are applied as a row and a column pass, each with a constant number of
+        // operations per pixel. For the small ones the NPP primitives are faster.
+        rectFunc_ = 0;
+        if (iters_ == 1 && kernel.total() > 25 && cv::countNonZero(kernel) == (int) kernel.total())
+        {
+            rectSize_ = kernel.size();
+            rectFunc_ = rectFuncs[CV_MAT_DEPTH(srcType) == CV_32F][op][CV_MAT_CN(srcType)];
+        }
+
         Mat kernel8U;
         kernel.convertTo(kernel8U, CV_8U);
 
@@ -601,6 +644,14 @@ namespace
         GpuMat src = _src.getGpuMat();
         CV_Assert( src.type() == type_ );
 
+        if (rectFunc_)
+        {
+            _dst.create(src.size(), src.type());
+            GpuMat dst = _dst.getGpuMat();
+            applyRect(src, dst, _stream);
+            return;
+        }
+
         Size ksize = kernel_.size();
         cuda::copyMakeBorder(src, srcBorder_, ksize.height, ksize.height, ksize.width, ksize.width, BORDER_DEFAULT, Scalar(), _stream);
 
@@ -662,6 +713,19 @@ namespace
         if (stream == 0)
             cudaSafeCall( cudaDeviceSynchronize() );
     }
+
+    void MorphologyFilter::applyRect(const GpuMat& src, GpuMat& dst, Stream& stream)
+    {
+        // the row pass needs rows x (cols + kWidth - 1) elements, the column pass (rows + kHeight - 1) x cols
+        ensureSizeIsEnough(src.rows + rectSize_.height - 1, src.cols + rectSize_.width - 1, type_, rectG_);
+        ensureSizeIsEnough(src.rows + rectSize_.height - 1, src.cols + rectSize_.width - 1, type_, rectH_);
+
+        if (rectSize_.width > 1 && rectSize_.height > 1)
+            ensureSizeIsEnough(src.size(), type_, buf_);
+
+        rectFunc_(src, dst, buf_, rectG_, rectH_, rectSize_.width, rectSize_.height, anchor_.x, anchor_.y,
+                  StreamAccessor::getStream(stream));
+    }
 }
 
 namespace
@@ -1053,6 +1117,8 @@ namespace cv { namespace cuda { namespace device
 {
     void medianFiltering_gpu(const PtrStepSzb src, PtrStepSzb dst, PtrStepSzi devHist,
         PtrStepSzi devCoarseHist,int kernel, int partitions, cudaStream_t stream);
+    void medianFiltering16u_gpu(const PtrStepSz<ushort> src, PtrStepSz<ushort> dst, PtrStep<ushort> colFine, PtrStep<int> colCoarse, PtrStep<int> winFine,
+        int kernel, int tileWidth, int tileCount, int bandRows, int bandCount, int blocks, cudaStream_t stream);
 }}}
 
 namespace
@@ -1065,16 +1131,20 @@ namespace
         void apply(InputArray src, OutputArray dst, Stream& stream = Stream::Null());
 
     private:
+        void apply16u(const GpuMat& src, GpuMat& dst, Stream& stream);
+
+        int type;
         int windowSize;
         int partitions;
         GpuMat devHist;
         GpuMat devCoarseHist;
+        GpuMat devWinHist;
     };
 
     MedianFilter::MedianFilter(int srcType, int _windowSize, int _partitions) :
-        windowSize(_windowSize),partitions(_partitions)
+        type(srcType),windowSize(_windowSize),partitions(_partitions)
     {
-        CV_Assert( srcType == CV_8UC1 );
+        CV_Assert( srcType == CV_8UC1 || srcType == CV_16UC1 );
         CV_Assert(windowSize>=3);
         CV_Assert(_partitions>=1);
 
@@ -1085,9 +1155,16 @@ namespace
         using namespace cv::cuda::device;
 
         GpuMat src = _src.getGpuMat();
+        CV_Assert( src.type() == type );
          _dst.create(src.rows, src.cols, src.type());
         GpuMat dst = _dst.getGpuMat();
 
+        if (type == CV_16UC1)
+        {
+            apply16u(src, dst, _stream);
+            return;
+        }
+
         if (partitions>src.rows)
             partitions=src.rows/2;
 
@@ -1108,6 +1185,39 @@ namespace
 
         medianFiltering_gpu(src,dst,devHist, devCoarseHist,kernel,partitions,StreamAccessor::getStream(_stream));
     }
+
+    void MedianFilter::apply16u(const GpuMat& src, GpuMat& dst, Stream& _stream)
+    {
+        using namespace cv::cuda::device;
+
+        // upper bound of the histogram memory, which decides how many blocks run at once
+        const size_t maxHistBytes = size_t(512) << 20;
+
+        const int kernel = windowSize / 2;
+
+        // the halo of 2*kernel columns is recomputed by every tile, keep it small relative to the tile
+        const int tileWidth = std::min(src.cols, std::max(256, 4 * kernel));
+        const int tileCount = cv::divUp(src.cols, tileWidth);
+        const int bandRows = cv::divUp(src.rows, std::min(partitions, src.rows));
+        const int bandCount = cv::divUp(src.rows, bandRows);
+
+        const int histCols = tileWidth + 2 * kernel;
+        const size_t blockBytes = histCols * (65536 * sizeof(ushort) + 256 * sizeof(int)) + 65536 * sizeof(int);
+        const int blocks = static_cast<int>(std::max<size_t>(1, std::min<size_t>(tileCount * bandCount, maxHistBytes / blockBytes)));
+
+        // The kernel leaves the column histograms zeroed, they only need clearing when reallocated.
+        if (devHist.rows != blocks * histCols || devHist.type() != CV_16UC1)
+        {
+            devHist.create(blocks * histCols, 65536, CV_16UC1);
+            devCoarseHist.create(blocks * histCols, 256, CV_32SC1);
+            devHist.setTo(0, _stream);
+            devCoarseHist.setTo(0, _stream);
+        }
+        ensureSizeIsEnough(blocks * 256, 256, CV_32SC1, devWinHist);
+
+        medianFiltering16u_gpu(src, dst, devHist, devCoarseHist, devWinHist,
+                               kernel, tileWidth, tileCount, bandRows, bandCount, blocks, StreamAccessor::getStream(_stream));
+    }
 }
 
 Ptr<Filter> cv::cuda::createMedianFilter(int srcType, int _windowSize, int _partitions)
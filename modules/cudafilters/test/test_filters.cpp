@@ -587,6 +587,58 @@ INSTANTIATE_TEST_CASE_P(CUDA_Filters, Dilate, testing::Combine(
     testing::Values(Iterations(1), Iterations(2), Iterations(3)),
     WHOLE_SUBMAT));
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// MorphRect
+
+PARAM_TEST_CASE(MorphRect, cv::cuda::DeviceInfo, cv::Size, MatType, KSize, UseRoi)
+{
+    cv::cuda::DeviceInfo devInfo;
+    cv::Size size;
+    int type;
+    cv::Size ksize;
+    bool useRoi;
+
+    virtual void SetUp()
+    {
+        devInfo = GET_PARAM(0);
+        size = GET_PARAM(1);
+        type = GET_PARAM(2);
+        ksize = GET_PARAM(3);
+        useRoi = GET_PARAM(4);
+
+        cv::cuda::setDevice(devInfo.deviceID());
+    }
+};
+
+CUDA_TEST_P(MorphRect, Accuracy)
+{
+    cv::Mat src = randomMat(size, type);
+    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, ksize);
+
+    cv::Ptr<cv::cuda::Filter> erode = cv::cuda::createMorphologyFilter(cv::MORPH_ERODE, src.type(), kernel);
+    cv::Ptr<cv::cuda::Filter> dilate = cv::cuda::createMorphologyFilter(cv::MORPH_DILATE, src.type(), kernel);
+
+    cv::cuda::GpuMat d_src = loadMat(src, useRoi);
+    cv::cuda::GpuMat dst_erode = createMat(size, type, useRoi);
+    cv::cuda::GpuMat dst_dilate = createMat(size, type, useRoi);
+    erode->apply(d_src, dst_erode);
+    dilate->apply(d_src, dst_dilate);
+
+    cv::Mat erode_gold, dilate_gold;
+    cv::erode(src, erode_gold, kernel);
+    cv::dilate(src, dilate_gold, kernel);
+
+    EXPECT_MAT_NEAR(getInnerROI(erode_gold, ksize), getInnerROI(dst_erode, ksize), 0.0);
+    EXPECT_MAT_NEAR(getInnerROI(dilate_gold, ksize), getInnerROI(dst_dilate, ksize), 0.0);
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_Filters, MorphRect, testing::Combine(
+    ALL_DEVICES,
+    DIFFERENT_SIZES,
+    testing::Values(MatType(CV_8UC1), MatType(CV_8UC4), MatType(CV_32FC1), MatType(CV_32FC4)),
+    testing::Values(KSize(cv::Size(7, 7)), KSize(cv::Size(15, 3)), KSize(cv::Size(1, 21)), KSize(cv::Size(31, 31))),
+    WHOLE_SUBMAT));
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // MorphEx
 
@@ -703,6 +755,67 @@ INSTANTIATE_TEST_CASE_P(CUDA_Filters, Median, testing::Combine(
     WHOLE_SUBMAT)
     );
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Median16U
+
+PARAM_TEST_CASE(Median16U, cv::cuda::DeviceInfo, cv::Size, KernelSize, UseRoi)
+{
+    cv::cuda::DeviceInfo devInfo;
+    cv::Size size;
+    int kernel;
+    bool useRoi;
+
+    virtual void SetUp()
+    {
+        devInfo = GET_PARAM(0);
+        size = GET_PARAM(1);
+        kernel = GET_PARAM(2);
+        useRoi = GET_PARAM(3);
+
+        cv::cuda::setDevice(devInfo.deviceID());
+    }
+};
+
+CUDA_TEST_P(Median16U, Accuracy)
+{
+    cv::Mat src = randomMat(size, CV_16UC1);
+
+    cv::Ptr<cv::cuda::Filter> median = cv::cuda::createMedianFilter(src.type(), kernel);
+
+    cv::cuda::GpuMat dst = createMat(size, CV_16UC1, useRoi);
+    median->apply(loadMat(src, useRoi), dst);
+
+    // cv::medianBlur supports 16-bit images for small kernels only
+    cv::Mat srcBorder;
+    cv::copyMakeBorder(src, srcBorder, kernel / 2, kernel / 2, kernel / 2, kernel / 2, cv::BORDER_REPLICATE);
+
+    cv::Mat dst_gold(size, CV_16UC1);
+    std::vector<ushort> window(kernel * kernel);
+    for (int y = 0; y < size.height; ++y)
+    {
+        for (int x = 0; x < size.width; ++x)
+        {
+            for (int i = 0; i < kernel; ++i)
+                for (int j = 0; j < kernel; ++j)
+                    window[i * kernel + j] = srcBorder.at<ushort>(y + i, x + j);
+
+            std::nth_element(window.begin(), window.begin() + window.size() / 2, window.end());
+            dst_gold.at<ushort>(y, x) = window[window.size() / 2];
+        }
+    }
+
+    EXPECT_MAT_NEAR(dst_gold, dst, 0.0);
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_Filters, Median16U, testing::Combine(
+    ALL_DEVICES,
+    DIFFERENT_SIZES,
+    testing::Values(KernelSize(3),
+                    KernelSize(7),
+                    KernelSize(15),
+                    KernelSize(31)),
+    WHOLE_SUBMAT));
+
 }} // namespace
 
 #endif // HAVE_CUDA
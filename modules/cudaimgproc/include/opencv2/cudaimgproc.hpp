@@ -226,13 +226,23 @@ class CV_EXPORTS_W CLAHE : public cv::CLAHE
 {
 public:
     using cv::CLAHE::apply;
-    /** @brief Equalizes the histogram of a grayscale image using Contrast Limited Adaptive Histogram Equalization.
+    /** @brief Equalizes the histogram of an image using Contrast Limited Adaptive Histogram Equalization.
 
-    @param src Source image with CV_8UC1 type.
+    @param src Source image with CV_8UC1, CV_16UC1, CV_8UC3 or CV_8UC4 type. BGR(A) images are
+    equalized in their luma, the Y channel of cv::COLOR_BGR2YCrCb, without a conversion pass: the
+    luma change is added to every color channel and the alpha channel is kept.
     @param dst Destination image.
     @param stream Stream for the asynchronous version.
      */
     CV_WRAP virtual void apply(InputArray src, OutputArray dst, Stream& stream) = 0;
+
+    /** @brief Equalizes a batch of images of the same size and type with one launch per stage.
+
+    @param src Source images with CV_8UC1, CV_8UC3 or CV_8UC4 type, see cuda::CLAHE::apply .
+    @param dst Destination images.
+    @param stream Stream for the asynchronous version.
+     */
+    virtual void applyBatch(const std::vector<GpuMat>& src, std::vector<GpuMat>& dst, Stream& stream = Stream::Null()) = 0;
 };
 
 /** @brief Creates implementation for cuda::CLAHE .
@@ -363,6 +373,19 @@ public:
      */
     CV_WRAP virtual void downloadResults(InputArray d_lines, OutputArray h_lines, OutputArray h_votes = noArray(), Stream& stream = Stream::Null()) = 0;
 
+    /** @brief Finds lines without synchronizing the stream.
+
+    @param src 8-bit, single-channel binary source image.
+    @param lines Output GpuMat of fixed capacity getMaxLines(), laid out as the result of
+    cuda::HoughLinesDetector::detect . Only the first count entries are valid.
+    @param count Output 1x1 CV_32SC1 number of found lines, clamped to getMaxLines(). When it is a
+    GpuMat it never leaves the device, so the following kernels can consume the lines directly.
+    @param stream Stream for the asynchronous version.
+
+    With doSort enabled the whole capacity is sorted, the unused entries have votes -1.
+     */
+    CV_WRAP virtual void detect(InputArray src, OutputArray lines, OutputArray count, Stream& stream = Stream::Null()) = 0;
+
     CV_WRAP virtual void setRho(float rho) = 0;
     CV_WRAP virtual float getRho() const = 0;
 
@@ -411,6 +434,16 @@ public:
      */
     CV_WRAP virtual void detect(InputArray src, OutputArray lines, Stream& stream = Stream::Null()) = 0;
 
+    /** @brief Finds line segments without synchronizing the stream.
+
+    @param src 8-bit, single-channel binary source image.
+    @param lines Output 1 x getMaxLines() GpuMat of CV_32SC4 type. Only the first count entries are valid.
+    @param count Output 1x1 CV_32SC1 number of found segments, clamped to getMaxLines(). When it is a
+    GpuMat it never leaves the device.
+    @param stream Stream for the asynchronous version.
+     */
+    CV_WRAP virtual void detect(InputArray src, OutputArray lines, OutputArray count, Stream& stream = Stream::Null()) = 0;
+
     CV_WRAP virtual void setRho(float rho) = 0;
     CV_WRAP virtual float getRho() const = 0;
 
@@ -507,6 +540,37 @@ CV_EXPORTS_W Ptr<GeneralizedHoughBallard> createGeneralizedHoughBallard();
  */
 CV_EXPORTS_W Ptr<GeneralizedHoughGuil> createGeneralizedHoughGuil();
 
+/** @brief Generalized hough transform from @cite Ballard1981 for a set of templates.
+
+The edge points of an image are extracted once and the votes of all templates are accumulated in
+one pass over them. Only the final number of detections is read back by the host. The parameters
+of cv::GeneralizedHoughBallard apply to all templates, cv::GeneralizedHough::setTemplate replaces
+the set by a single template and cv::GeneralizedHough::detect reports the positions of all
+templates.
+ */
+class CV_EXPORTS GeneralizedHoughBallardBatch : public GeneralizedHoughBallard
+{
+public:
+    /** @brief Sets the templates to search for.
+
+    @param templs CV_8UC1 templates, the center of each one is its middle.
+     */
+    virtual void setTemplates(const std::vector<GpuMat>& templs) = 0;
+
+    /** @brief Finds all templates in an image.
+
+    @param image CV_8UC1 image.
+    @param positions Output vector of found objects, see cv::GeneralizedHough::detect .
+    @param votes Optional output vector of votes, see cv::GeneralizedHough::detect .
+    @param templateIds Output CV_32SC1 row with the index of the template at each position.
+     */
+    virtual void detectAll(InputArray image, OutputArray positions, OutputArray votes, OutputArray templateIds) = 0;
+};
+
+/** @brief Creates implementation for cuda::GeneralizedHoughBallardBatch .
+ */
+CV_EXPORTS Ptr<GeneralizedHoughBallardBatch> createGeneralizedHoughBallardBatch();
+
 //! @} cudaimgproc_hough
 
 ////////////////////////// Corners Detection ///////////////////////////
@@ -696,6 +760,46 @@ The following methods are supported for the CV_32F images for now:
  */
 CV_EXPORTS_W Ptr<TemplateMatching> createTemplateMatching(int srcType, int method, Size user_block_size = Size());
 
+/** @brief Base class for matching a fixed set of templates against a sequence of images. :
+
+The image dependent data (integral images, the float copy and, for large templates, the image
+spectrum) is computed once per image and shared by all templates. The template dependent data
+(sums, square sums and the template spectra) is computed once per template set and image size, so
+matching does not synchronize with the host.
+
+Each cached template spectrum takes about image.rows \* (image.cols \* image.channels() / 2 + 1) \* 8
+bytes of device memory.
+ */
+class CV_EXPORTS TemplateMatchingBatch : public Algorithm
+{
+public:
+    /** @brief Sets the templates to search for.
+
+    @param templs Templates with the type passed to createTemplateMatchingBatch, of any size.
+    @param stream Stream for the asynchronous version. The call waits for the template
+    statistics once.
+     */
+    virtual void setTemplates(const std::vector<GpuMat>& templs, Stream& stream = Stream::Null()) = 0;
+
+    /** @brief Computes proximity maps of all templates for an image.
+
+    @param image Source image, each template must fit into it.
+    @param results Map for each template, see TemplateMatching::match .
+    @param stream Stream for the asynchronous version.
+     */
+    virtual void match(InputArray image, std::vector<GpuMat>& results, Stream& stream = Stream::Null()) = 0;
+};
+
+/** @brief Creates implementation for cuda::TemplateMatchingBatch .
+
+@param srcType Input source type, as for createTemplateMatching .
+@param method Specifies the way to compare the templates with the image, as for
+createTemplateMatching .
+
+@sa createTemplateMatching
+ */
+CV_EXPORTS Ptr<TemplateMatchingBatch> createTemplateMatchingBatch(int srcType, int method);
+
 ////////////////////////// Bilateral Filter ///////////////////////////
 
 /** @brief Performs bilateral filtering of passed image
@@ -731,6 +835,44 @@ type.
 CV_EXPORTS_W void blendLinear(InputArray img1, InputArray img2, InputArray weights1, InputArray weights2,
                             OutputArray result, Stream& stream = Stream::Null());
 
+/////////////////////////// Connected Components ///////////////////////////
+
+/** @brief Computes the connected components labeled image of a binary image.
+
+@param image 8-bit single-channel image, non-zero pixels are the foreground.
+@param labels Destination labeled image of CV_32SC1 type. The background has label 0, the components
+are numbered from 1 without gaps in the raster order of their first pixels.
+@param connectivity 8 or 4 for 8-way or 4-way connectivity respectively.
+@param ltype Output image label type. Only CV_32S is supported.
+@param stream Stream for the asynchronous version.
+
+Tiles of the image are labeled with union-find in shared memory, then the tiles are merged along
+their borders. The function does not synchronize the stream.
+
+@sa connectedComponents
+ */
+CV_EXPORTS_W void connectedComponents(InputArray image, OutputArray labels, int connectivity = 8, int ltype = CV_32S,
+                                      Stream& stream = Stream::Null());
+
+/** @overload
+
+@param image 8-bit single-channel image, non-zero pixels are the foreground.
+@param labels Destination labeled image of CV_32SC1 type.
+@param stats Statistics output of CV_32SC1 type, one row per label including the background and
+the columns of cv::ConnectedComponentsTypes: left, top, width, height and area.
+@param centroids Centroid output of CV_64FC1 type, one (x, y) row per label.
+@param connectivity 8 or 4 for 8-way or 4-way connectivity respectively.
+@param ltype Output image label type. Only CV_32S is supported.
+@param stream Stream for the asynchronous version.
+
+The statistics are accumulated in the pass which writes the final labels. The number of labels is
+downloaded once to size the outputs and returned, the rest of the work stays asynchronous.
+
+@sa connectedComponentsWithStats
+ */
+CV_EXPORTS_W int connectedComponentsWithStats(InputArray image, OutputArray labels, OutputArray stats, OutputArray centroids,
+                                              int connectivity = 8, int ltype = CV_32S, Stream& stream = Stream::Null());
+
 //! @}
 
 }} // namespace cv { namespace cuda {
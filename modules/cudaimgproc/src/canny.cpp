@@ -112,8 +112,8 @@ namespace
         }
 
     private:
-        void createBuf(Size image_size);
-        void CannyCaller(GpuMat& edges, Stream& stream);
+        void createBuf(Size image_size, cudev::ScratchPool& pool);
+        void CannyCaller(GpuMat& edges, cudev::ScratchPool& pool, Stream& stream);
 
         double low_thresh_;
         double high_thresh_;
@@ -142,7 +142,8 @@ namespace
         if (low_thresh_ > high_thresh_)
             std::swap(low_thresh_, high_thresh_);
 
-        createBuf(image.size());
+        cudev::ScratchPool pool(stream);
+        createBuf(image.size(), pool);
 
         _edges.create(image.size(), CV_8UC1);
         GpuMat edges = _edges.getGpuMat();
@@ -168,7 +169,7 @@ namespace
 #endif
         }
 
-        CannyCaller(edges, stream);
+        CannyCaller(edges, pool, stream);
     }
 
     void CannyImpl::detect(InputArray _dx, InputArray _dy, OutputArray _edges, Stream& stream)
@@ -180,28 +181,29 @@ namespace
         CV_Assert( dy.type() == dx.type() && dy.size() == dx.size() );
         CV_Assert( deviceSupports(SHARED_ATOMICS) );
 
-        dx.copyTo(dx_, stream);
-        dy.copyTo(dy_, stream);
-
         if (low_thresh_ > high_thresh_)
             std::swap(low_thresh_, high_thresh_);
 
-        createBuf(dx.size());
+        cudev::ScratchPool pool(stream);
+        createBuf(dx.size(), pool);
+
+        dx.copyTo(dx_, stream);
+        dy.copyTo(dy_, stream);
 
         _edges.create(dx.size(), CV_8UC1);
         GpuMat edges = _edges.getGpuMat();
 
         canny::calcMagnitude(dx_, dy_, mag_, L2gradient_, StreamAccessor::getStream(stream));
 
-        CannyCaller(edges, stream);
+        CannyCaller(edges, pool, stream);
     }
 
-    void CannyImpl::createBuf(Size image_size)
+    void CannyImpl::createBuf(Size image_size, cudev::ScratchPool& pool)
     {
         CV_Assert(image_size.width < std::numeric_limits<short>::max() && image_size.height < std::numeric_limits<short>::max());
 
-        ensureSizeIsEnough(image_size, CV_32SC1, dx_);
-        ensureSizeIsEnough(image_size, CV_32SC1, dy_);
+        pool.ensureSizeIsEnough(image_size, CV_32SC1, dx_);
+        pool.ensureSizeIsEnough(image_size, CV_32SC1, dy_);
 
 #ifdef HAVE_OPENCV_CUDAFILTERS
         if (apperture_size_ != 3 && apperture_size_ != old_apperture_size_)
@@ -212,26 +214,27 @@ namespace
         }
 #endif
 
-        ensureSizeIsEnough(image_size, CV_32FC1, mag_);
-        ensureSizeIsEnough(image_size, CV_32SC1, map_);
+        pool.ensureSizeIsEnough(image_size, CV_32FC1, mag_);
+        pool.ensureSizeIsEnough(image_size, CV_32SC1, map_);
 
-        ensureSizeIsEnough(1, image_size.area(), CV_16SC2, st1_);
-        ensureSizeIsEnough(1, image_size.area(), CV_16SC2, st2_);
+        pool.ensureSizeIsEnough(1, image_size.area(), CV_16SC2, st1_);
+        pool.ensureSizeIsEnough(1, image_size.area(), CV_16SC2, st2_);
     }
 
-    void CannyImpl::CannyCaller(GpuMat& edges, Stream& stream)
+    void CannyImpl::CannyCaller(GpuMat& edges, cudev::ScratchPool& pool, Stream& stream)
     {
         map_.setTo(Scalar::all(0), stream);
 
         canny::calcMap(dx_, dy_, mag_, map_, static_cast<float>(low_thresh_), static_cast<float>(high_thresh_), StreamAccessor::getStream(stream));
 
-        cudaSafeCall( cudaMalloc(&d_counter, sizeof(int)) );
+        GpuMat counter = pool.getBuffer(1, 1, CV_32SC1);
+        d_counter = counter.ptr<int>();
 
         canny::edgesHysteresisLocal(map_, st1_.ptr<short2>(), d_counter, StreamAccessor::getStream(stream));
 
         canny::edgesHysteresisGlobal(map_, st1_.ptr<short2>(), st2_.ptr<short2>(), d_counter, StreamAccessor::getStream(stream));
 
-        cudaSafeCall( cudaFree(d_counter) );
+        d_counter = nullptr;
 
         canny::getEdges(map_, edges, StreamAccessor::getStream(stream));
     }
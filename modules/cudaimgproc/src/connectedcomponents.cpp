@@ -0,0 +1,91 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+using namespace cv;
+using namespace cv::cuda;
+
+#if !defined (HAVE_CUDA) || defined (CUDA_DISABLER)
+
+void cv::cuda::connectedComponents(InputArray, OutputArray, int, int, Stream&) { throw_no_cuda(); }
+int cv::cuda::connectedComponentsWithStats(InputArray, OutputArray, OutputArray, OutputArray, int, int, Stream&) { throw_no_cuda(); return 0; }
+
+#else /* !defined (HAVE_CUDA) */
+
+namespace cv { namespace cuda { namespace device
+{
+    namespace ccl
+    {
+        void labelComponents_gpu(PtrStepSzb img, PtrStepSzi labels, int* rank, bool conn8, cudaStream_t stream);
+        void relabel_gpu(PtrStepSzi labels, const int* rank, cudaStream_t stream);
+        void relabelWithStats_gpu(PtrStepSzi labels, const int* rank, PtrStepSzi stats, unsigned long long* sums, PtrStepd centroids, cudaStream_t stream);
+    }
+}}}
+
+namespace
+{
+    GpuMat labelComponents(InputArray _image, OutputArray _labels, int connectivity, int ltype, GpuMat& rank, Stream& stream)
+    {
+        using namespace cv::cuda::device::ccl;
+
+        GpuMat image = _image.getGpuMat();
+
+        CV_Assert( image.type() == CV_8UC1 && !image.empty() );
+        CV_Assert( connectivity == 8 || connectivity == 4 );
+        CV_Assert( ltype == CV_32S );
+        CV_Assert( image.size().area() < std::numeric_limits<int>::max() );
+
+        _labels.create(image.size(), CV_32SC1);
+        GpuMat labels = _labels.getGpuMat();
+
+        BufferPool pool(stream);
+        rank = pool.getBuffer(1, image.size().area(), CV_32SC1);
+
+        labelComponents_gpu(image, labels, rank.ptr<int>(), connectivity == 8, StreamAccessor::getStream(stream));
+
+        return labels;
+    }
+}
+
+void cv::cuda::connectedComponents(InputArray _image, OutputArray _labels, int connectivity, int ltype, Stream& stream)
+{
+    using namespace cv::cuda::device::ccl;
+
+    GpuMat rank;
+    GpuMat labels = labelComponents(_image, _labels, connectivity, ltype, rank, stream);
+
+    relabel_gpu(labels, rank.ptr<int>(), StreamAccessor::getStream(stream));
+}
+
+int cv::cuda::connectedComponentsWithStats(InputArray _image, OutputArray _labels, OutputArray _stats, OutputArray _centroids,
+                                           int connectivity, int ltype, Stream& stream)
+{
+    using namespace cv::cuda::device::ccl;
+
+    GpuMat rank;
+    GpuMat labels = labelComponents(_image, _labels, connectivity, ltype, rank, stream);
+
+    // the inclusive scan of the root marks ends with the number of components
+    int ncomponents;
+    rank.colRange(rank.cols - 1, rank.cols).download(Mat(1, 1, CV_32SC1, &ncomponents), stream);
+    stream.waitForCompletion();
+
+    const int nlabels = ncomponents + 1;
+
+    BufferPool pool(stream);
+    GpuMat sums = pool.getBuffer(1, 2 * nlabels, CV_64FC1);
+
+    GpuMat stats = getOutputMat(_stats, nlabels, CC_STAT_MAX, CV_32SC1, stream);
+    GpuMat centroids = getOutputMat(_centroids, nlabels, 2, CV_64FC1, stream);
+
+    relabelWithStats_gpu(labels, rank.ptr<int>(), stats, sums.ptr<unsigned long long>(), centroids, StreamAccessor::getStream(stream));
+
+    syncOutput(stats, _stats, stream);
+    syncOutput(centroids, _centroids, stream);
+
+    return nlabels;
+}
+
+#endif /* !defined (HAVE_CUDA) */
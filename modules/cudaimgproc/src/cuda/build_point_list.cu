@@ -106,7 +106,7 @@ namespace cv { namespace cuda { namespace device
                 list[gidx] = s_queues[threadIdx.y][i];
         }
 
-        int buildPointList_gpu(PtrStepSzb src, unsigned int* list, int* counterPtr, cudaStream_t stream)
+        void buildPointListAsync_gpu(PtrStepSzb src, unsigned int* list, int* counterPtr, cudaStream_t stream)
         {
             const int PIXELS_PER_THREAD = 16;
 
@@ -119,6 +119,11 @@ namespace cv { namespace cuda { namespace device
 
             buildPointList<PIXELS_PER_THREAD><<<grid, block, 0, stream>>>(src, list, counterPtr);
             cudaSafeCall( cudaGetLastError() );
+        }
+
+        int buildPointList_gpu(PtrStepSzb src, unsigned int* list, int* counterPtr, cudaStream_t stream)
+        {
+            buildPointListAsync_gpu(src, list, counterPtr, stream);
 
             int totalCount;
             cudaSafeCall( cudaMemcpyAsync(&totalCount, counterPtr, sizeof(int), cudaMemcpyDeviceToHost, stream) );
@@ -126,6 +131,17 @@ namespace cv { namespace cuda { namespace device
 
             return totalCount;
         }
+
+        __global__ void clampCount(const int* counterPtr, const int maxSize, int* dst)
+        {
+            *dst = ::min(*counterPtr, maxSize);
+        }
+
+        void clampCount_gpu(const int* counterPtr, int maxSize, int* dst, cudaStream_t stream)
+        {
+            clampCount<<<1, 1, 0, stream>>>(counterPtr, maxSize, dst);
+            cudaSafeCall( cudaGetLastError() );
+        }
     }
 }}}
 
@@ -48,8 +48,39 @@ using namespace cv::cudev;
 
 namespace clahe
 {
-    __global__ void calcLutKernel_8U(const PtrStepb src, PtrStepb lut,
-                                     const int2 tileSize, const int tilesX,
+    // counts the bin once per group of lanes of a warp which hit it
+    __device__ __forceinline__ void histAdd(int* hist, const int bin)
+    {
+    #if __CUDA_ARCH__ >= 700
+        const unsigned int peers = __match_any_sync(__activemask(), bin);
+        if (threadIdx.x % 32 == __ffs(peers) - 1)
+            ::atomicAdd(&hist[bin], __popc(peers));
+    #else
+        ::atomicAdd(&hist[bin], 1);
+    #endif
+    }
+
+    // the tiles may overlap the bottom and the right edges, they are extended as with BORDER_REFLECT_101
+    __device__ __forceinline__ int reflect101(const int i, const int len)
+    {
+        return i < len ? i : 2 * len - 2 - i;
+    }
+
+    // the value which is equalized: the pixel itself or the luma of a BGR(A) pixel, as in cv::COLOR_BGR2YCrCb
+    template <int cn>
+    __device__ __forceinline__ int claheValue(const uchar* row, const int x)
+    {
+        if (cn == 1)
+            return row[x];
+
+        const uchar* p = row + x * cn;
+        return (p[0] * 1868 + p[1] * 9617 + p[2] * 4899 + (1 << 13)) >> 14;
+    }
+
+    // blockIdx.z is the image of the batch, srcs is null for a single image
+    template <int cn>
+    __global__ void calcLutKernel_8U(const PtrStepb src, const PtrStepb* srcs, const int rows, const int cols,
+                                     PtrStepb lut, const int2 tileSize, const int tilesX, const int tilesY,
                                      const int clipLimit, const float lutScale)
     {
         __shared__ int smem[256];
@@ -58,16 +89,18 @@ namespace clahe
         const int ty = blockIdx.y;
         const unsigned int tid = threadIdx.y * blockDim.x + threadIdx.x;
 
+        const PtrStepb img = srcs ? srcs[blockIdx.z] : src;
+
         smem[tid] = 0;
         __syncthreads();
 
         for (int i = threadIdx.y; i < tileSize.y; i += blockDim.y)
         {
-            const uchar* srcPtr = src.ptr(ty * tileSize.y + i) + tx * tileSize.x;
+            const uchar* srcPtr = img.ptr(reflect101(ty * tileSize.y + i, rows));
             for (int j = threadIdx.x; j < tileSize.x; j += blockDim.x)
             {
-                const int data = srcPtr[j];
-                ::atomicAdd(&smem[data], 1);
+                const int data = claheValue<cn>(srcPtr, reflect101(tx * tileSize.x + j, cols));
+                histAdd(smem, data);
             }
         }
 
@@ -122,7 +155,7 @@ namespace clahe
 
         const int lutVal = blockScanInclusive<256>(tHistVal, smem, tid);
 
-        lut(ty * tilesX + tx, tid) = saturate_cast<uchar>(__float2int_rn(lutScale * lutVal));
+        lut((blockIdx.z * tilesY + ty) * tilesX + tx, tid) = saturate_cast<uchar>(__float2int_rn(lutScale * lutVal));
     }
 
     __global__ void calcLutKernel_16U(const PtrStepus src, PtrStepus lut,
@@ -325,12 +358,17 @@ namespace clahe
         #undef blockSize
     }
 
-    void calcLut_8U(PtrStepSzb src, PtrStepb lut, int tilesX, int tilesY, int2 tileSize, int clipLimit, float lutScale, cudaStream_t stream)
+    void calcLut_8U(PtrStepSzb src, const PtrStepb* srcs, int nimages, int cn, PtrStepb lut, int tilesX, int tilesY, int2 tileSize, int clipLimit, float lutScale, cudaStream_t stream)
     {
+        typedef void (*func_t)(const PtrStepb src, const PtrStepb* srcs, const int rows, const int cols,
+                               PtrStepb lut, const int2 tileSize, const int tilesX, const int tilesY,
+                               const int clipLimit, const float lutScale);
+        static const func_t funcs[] = { calcLutKernel_8U<1>, 0, calcLutKernel_8U<3>, calcLutKernel_8U<4> };
+
         const dim3 block(32, 8);
-        const dim3 grid(tilesX, tilesY);
+        const dim3 grid(tilesX, tilesY, nimages);
 
-        calcLutKernel_8U<<<grid, block, 0, stream>>>(src, lut, tileSize, tilesX, clipLimit, lutScale);
+        funcs[cn - 1]<<<grid, block, 0, stream>>>(src, srcs, src.rows, src.cols, lut, tileSize, tilesX, tilesY, clipLimit, lutScale);
 
         CV_CUDEV_SAFE_CALL( cudaGetLastError() );
 
@@ -401,7 +439,79 @@ namespace clahe
             CV_CUDEV_SAFE_CALL( cudaDeviceSynchronize() );
     }
 
-    template void transform<uchar>(PtrStepSz<uchar> src, PtrStepSz<uchar> dst, PtrStep<uchar> lut, int tilesX, int tilesY, int2 tileSize, cudaStream_t stream);
+    // color images get the luma change added to every channel, which is the same as equalizing
+    // the Y plane of YCrCb and converting back, the alpha channel is copied
+    template <int cn>
+    __global__ void transformKernel_8U(const PtrStepSzb src, const PtrStepb* srcs, PtrStepb dst, const PtrStepb* dsts,
+                                       const PtrStepb lut, const int2 tileSize, const int tilesX, const int tilesY)
+    {
+        const int x = blockIdx.x * blockDim.x + threadIdx.x;
+        const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+        if (x >= src.cols || y >= src.rows)
+            return;
+
+        const uchar* srcRow = srcs ? srcs[blockIdx.z].ptr(y) : src.ptr(y);
+        uchar* dstRow = dsts ? dsts[blockIdx.z].ptr(y) : dst.ptr(y);
+
+        const float tyf = (static_cast<float>(y) / tileSize.y) - 0.5f;
+        int ty1 = __float2int_rd(tyf);
+        int ty2 = ty1 + 1;
+        const float ya = tyf - ty1;
+        ty1 = ::max(ty1, 0);
+        ty2 = ::min(ty2, tilesY - 1);
+
+        const float txf = (static_cast<float>(x) / tileSize.x) - 0.5f;
+        int tx1 = __float2int_rd(txf);
+        int tx2 = tx1 + 1;
+        const float xa = txf - tx1;
+        tx1 = ::max(tx1, 0);
+        tx2 = ::min(tx2, tilesX - 1);
+
+        const int lutRow = blockIdx.z * tilesY * tilesX;
+        const int srcVal = claheValue<cn>(srcRow, x);
+
+        float res = 0;
+
+        res += lut(lutRow + ty1 * tilesX + tx1, srcVal) * ((1.0f - xa) * (1.0f - ya));
+        res += lut(lutRow + ty1 * tilesX + tx2, srcVal) * ((xa) * (1.0f - ya));
+        res += lut(lutRow + ty2 * tilesX + tx1, srcVal) * ((1.0f - xa) * (ya));
+        res += lut(lutRow + ty2 * tilesX + tx2, srcVal) * ((xa) * (ya));
+
+        if (cn == 1)
+        {
+            dstRow[x] = saturate_cast<uchar>(res);
+        }
+        else
+        {
+            const int delta = saturate_cast<uchar>(res) - srcVal;
+
+            #pragma unroll
+            for (int c = 0; c < 3; ++c)
+                dstRow[x * cn + c] = saturate_cast<uchar>(srcRow[x * cn + c] + delta);
+
+            if (cn == 4)
+                dstRow[x * cn + 3] = srcRow[x * cn + 3];
+        }
+    }
+
+    void transform_8U(PtrStepSzb src, const PtrStepb* srcs, PtrStepb dst, const PtrStepb* dsts, int nimages, int cn,
+                      PtrStepb lut, int tilesX, int tilesY, int2 tileSize, cudaStream_t stream)
+    {
+        typedef void (*func_t)(const PtrStepSzb src, const PtrStepb* srcs, PtrStepb dst, const PtrStepb* dsts,
+                               const PtrStepb lut, const int2 tileSize, const int tilesX, const int tilesY);
+        static const func_t funcs[] = { transformKernel_8U<1>, 0, transformKernel_8U<3>, transformKernel_8U<4> };
+
+        const dim3 block(32, 8);
+        const dim3 grid(divUp(src.cols, block.x), divUp(src.rows, block.y), nimages);
+
+        funcs[cn - 1]<<<grid, block, 0, stream>>>(src, srcs, dst, dsts, lut, tileSize, tilesX, tilesY);
+        CV_CUDEV_SAFE_CALL( cudaGetLastError() );
+
+        if (stream == 0)
+            CV_CUDEV_SAFE_CALL( cudaDeviceSynchronize() );
+    }
+
     template void transform<ushort>(PtrStepSz<ushort> src, PtrStepSz<ushort> dst, PtrStep<ushort> lut, int tilesX, int tilesY, int2 tileSize, cudaStream_t stream);
 }
 
@@ -0,0 +1,382 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#if !defined CUDA_DISABLER
+
+#include <thrust/device_ptr.h>
+#include <thrust/scan.h>
+#include <thrust/system/cuda/execution_policy.h>
+#include <climits>
+#include <math_constants.h>
+
+#include "opencv2/core/cuda/common.hpp"
+
+namespace cv { namespace cuda { namespace device
+{
+    namespace ccl
+    {
+        // Every label is the linear index of a pixel, the root of a component is its first pixel in the raster order.
+        // Unions keep the smaller root, so the roots never change their relative order.
+
+        const int TILE_W = 32;
+        const int TILE_H = 8;
+
+        // pixels of a row handled by one thread of the final pass, their runs of equal labels are accumulated at once
+        const int SEGMENT = 16;
+
+        __device__ __forceinline__ int findRoot(const int* s, int p)
+        {
+            int q = s[p];
+            while (q != p)
+            {
+                p = q;
+                q = s[p];
+            }
+            return p;
+        }
+
+        __device__ __forceinline__ void unite(int* s, int a, int b)
+        {
+            bool done;
+            do
+            {
+                a = findRoot(s, a);
+                b = findRoot(s, b);
+
+                if (a < b)
+                {
+                    const int old = ::atomicMin(s + b, a);
+                    done = (old == b);
+                    b = old;
+                }
+                else if (b < a)
+                {
+                    const int old = ::atomicMin(s + a, b);
+                    done = (old == a);
+                    a = old;
+                }
+                else
+                {
+                    done = true;
+                }
+            } while (!done);
+        }
+
+        __device__ __forceinline__ int* labelPtr(const PtrStepi& L, int cols, int p)
+        {
+            return L.ptr(p / cols) + p % cols;
+        }
+
+        __device__ __forceinline__ int findRoot(const PtrStepi& L, int cols, int p)
+        {
+            int q = *labelPtr(L, cols, p);
+            while (q != p)
+            {
+                p = q;
+                q = *labelPtr(L, cols, p);
+            }
+            return p;
+        }
+
+        __device__ __forceinline__ void unite(const PtrStepi& L, int cols, int a, int b)
+        {
+            bool done;
+            do
+            {
+                a = findRoot(L, cols, a);
+                b = findRoot(L, cols, b);
+
+                if (a < b)
+                {
+                    const int old = ::atomicMin(labelPtr(L, cols, b), a);
+                    done = (old == b);
+                    b = old;
+                }
+                else if (b < a)
+                {
+                    const int old = ::atomicMin(labelPtr(L, cols, a), b);
+                    done = (old == a);
+                    a = old;
+                }
+                else
+                {
+                    done = true;
+                }
+            } while (!done);
+        }
+
+        // labels one tile in shared memory, the background gets -1
+        template <bool conn8>
+        __global__ void labelTiles(const PtrStepSzb img, PtrStepi L)
+        {
+            __shared__ int s[TILE_W * TILE_H];
+
+            const int lx = threadIdx.x;
+            const int ly = threadIdx.y;
+            const int x = blockIdx.x * TILE_W + lx;
+            const int y = blockIdx.y * TILE_H + ly;
+            const int t = ly * TILE_W + lx;
+
+            const bool inside = x < img.cols && y < img.rows;
+            const bool fg = inside && img(y, x) != 0;
+
+            s[t] = fg ? t : -1;
+            __syncthreads();
+
+            if (fg)
+            {
+                if (lx > 0 && s[t - 1] >= 0)
+                    unite(s, t, t - 1);
+
+                if (ly > 0)
+                {
+                    if (s[t - TILE_W] >= 0)
+                        unite(s, t, t - TILE_W);
+
+                    if (conn8)
+                    {
+                        if (lx > 0 && s[t - TILE_W - 1] >= 0)
+                            unite(s, t, t - TILE_W - 1);
+                        if (lx < TILE_W - 1 && s[t - TILE_W + 1] >= 0)
+                            unite(s, t, t - TILE_W + 1);
+                    }
+                }
+            }
+
+            __syncthreads();
+
+            if (fg)
+            {
+                const int r = findRoot(s, t);
+                L(y, x) = (blockIdx.y * TILE_H + r / TILE_W) * img.cols + blockIdx.x * TILE_W + r % TILE_W;
+            }
+            else if (inside)
+            {
+                L(y, x) = -1;
+            }
+        }
+
+        // joins the pixels whose preceding neighbours belong to another tile
+        template <bool conn8>
+        __global__ void mergeTiles(const PtrStepSzb img, PtrStepi L)
+        {
+            const int lx = threadIdx.x;
+            const int ly = threadIdx.y;
+            const int x = blockIdx.x * TILE_W + lx;
+            const int y = blockIdx.y * TILE_H + ly;
+
+            if (x >= img.cols || y >= img.rows || !img(y, x))
+                return;
+
+            const int cols = img.cols;
+            const int p = y * cols + x;
+
+            if (lx == 0 && x > 0 && img(y, x - 1))
+                unite(L, cols, p, p - 1);
+
+            if (ly == 0 && y > 0 && img(y - 1, x))
+                unite(L, cols, p, p - cols);
+
+            if (conn8 && y > 0)
+            {
+                if ((lx == 0 || ly == 0) && x > 0 && img(y - 1, x - 1))
+                    unite(L, cols, p, p - cols - 1);
+
+                if ((lx == TILE_W - 1 || ly == 0) && x + 1 < cols && img(y - 1, x + 1))
+                    unite(L, cols, p, p - cols + 1);
+            }
+        }
+
+        // points every pixel to its root and marks the roots
+        __global__ void flatten(const PtrStepSzb img, PtrStepi L, int* rank)
+        {
+            const int x = blockIdx.x * blockDim.x + threadIdx.x;
+            const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+            if (x >= img.cols || y >= img.rows)
+                return;
+
+            const int p = y * img.cols + x;
+
+            if (img(y, x))
+            {
+                const int r = findRoot(L, img.cols, p);
+                L(y, x) = r;
+                rank[p] = r == p;
+            }
+            else
+            {
+                rank[p] = 0;
+            }
+        }
+
+        void labelComponents_gpu(PtrStepSzb img, PtrStepSzi labels, int* rank, bool conn8, cudaStream_t stream)
+        {
+            const dim3 block(TILE_W, TILE_H);
+            const dim3 grid(divUp(img.cols, block.x), divUp(img.rows, block.y));
+
+            if (conn8)
+            {
+                labelTiles<true><<<grid, block, 0, stream>>>(img, labels);
+                cudaSafeCall( cudaGetLastError() );
+                mergeTiles<true><<<grid, block, 0, stream>>>(img, labels);
+                cudaSafeCall( cudaGetLastError() );
+            }
+            else
+            {
+                labelTiles<false><<<grid, block, 0, stream>>>(img, labels);
+                cudaSafeCall( cudaGetLastError() );
+                mergeTiles<false><<<grid, block, 0, stream>>>(img, labels);
+                cudaSafeCall( cudaGetLastError() );
+            }
+
+            flatten<<<grid, block, 0, stream>>>(img, labels, rank);
+            cudaSafeCall( cudaGetLastError() );
+
+            // the rank of a root is its final label
+            thrust::device_ptr<int> rankPtr(rank);
+            thrust::inclusive_scan(thrust::cuda::par.on(stream), rankPtr, rankPtr + img.rows * img.cols, rankPtr);
+
+            if (stream == 0)
+                cudaSafeCall( cudaDeviceSynchronize() );
+        }
+
+        __global__ void relabel(PtrStepSzi L, const int* rank)
+        {
+            const int x = blockIdx.x * blockDim.x + threadIdx.x;
+            const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+            if (x >= L.cols || y >= L.rows)
+                return;
+
+            const int r = L(y, x);
+            L(y, x) = r >= 0 ? rank[r] : 0;
+        }
+
+        void relabel_gpu(PtrStepSzi labels, const int* rank, cudaStream_t stream)
+        {
+            const dim3 block(32, 8);
+            const dim3 grid(divUp(labels.cols, block.x), divUp(labels.rows, block.y));
+
+            relabel<<<grid, block, 0, stream>>>(labels, rank);
+            cudaSafeCall( cudaGetLastError() );
+
+            if (stream == 0)
+                cudaSafeCall( cudaDeviceSynchronize() );
+        }
+
+        __global__ void initStats(PtrStepSzi stats, unsigned long long* sums)
+        {
+            const int i = blockIdx.x * blockDim.x + threadIdx.x;
+
+            if (i >= stats.rows)
+                return;
+
+            int* row = stats.ptr(i);
+            row[0] = row[1] = INT_MAX;
+            row[2] = row[3] = -1;
+            row[4] = 0;
+
+            sums[2 * i] = sums[2 * i + 1] = 0;
+        }
+
+        __device__ __forceinline__ void accumulateRun(PtrStepi stats, unsigned long long* sums, int label, int y, int xs, int xe)
+        {
+            const unsigned int n = xe - xs + 1;
+            int* row = stats.ptr(label);
+
+            ::atomicMin(row + 0, xs);
+            ::atomicMin(row + 1, y);
+            ::atomicMax(row + 2, xe);
+            ::atomicMax(row + 3, y);
+            ::atomicAdd(row + 4, static_cast<int>(n));
+
+            ::atomicAdd(sums + 2 * label, static_cast<unsigned long long>(n) * (xs + xe) / 2);
+            ::atomicAdd(sums + 2 * label + 1, static_cast<unsigned long long>(n) * y);
+        }
+
+        __global__ void relabelWithStats(PtrStepSzi L, const int* rank, PtrStepi stats, unsigned long long* sums)
+        {
+            const int x0 = (blockIdx.x * blockDim.x + threadIdx.x) * SEGMENT;
+            const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+            if (x0 >= L.cols || y >= L.rows)
+                return;
+
+            const int x1 = ::min(x0 + SEGMENT, L.cols);
+
+            int* row = L.ptr(y);
+
+            int cur = -1;
+            int start = x0;
+
+            for (int x = x0; x < x1; ++x)
+            {
+                const int r = row[x];
+                const int label = r >= 0 ? rank[r] : 0;
+                row[x] = label;
+
+                if (label != cur)
+                {
+                    if (cur >= 0)
+                        accumulateRun(stats, sums, cur, y, start, x - 1);
+
+                    cur = label;
+                    start = x;
+                }
+            }
+
+            accumulateRun(stats, sums, cur, y, start, x1 - 1);
+        }
+
+        // converts the bounds into width and height and the sums into centroids
+        __global__ void finalizeStats(PtrStepSzi stats, const unsigned long long* sums, PtrStepd centroids)
+        {
+            const int i = blockIdx.x * blockDim.x + threadIdx.x;
+
+            if (i >= stats.rows)
+                return;
+
+            int* row = stats.ptr(i);
+            double* c = centroids.ptr(i);
+            const int area = row[4];
+
+            if (area == 0)
+            {
+                row[0] = row[1] = row[2] = row[3] = 0;
+                c[0] = c[1] = CUDART_NAN;
+                return;
+            }
+
+            row[2] = row[2] - row[0] + 1;
+            row[3] = row[3] - row[1] + 1;
+
+            c[0] = static_cast<double>(sums[2 * i]) / area;
+            c[1] = static_cast<double>(sums[2 * i + 1]) / area;
+        }
+
+        void relabelWithStats_gpu(PtrStepSzi labels, const int* rank, PtrStepSzi stats, unsigned long long* sums, PtrStepd centroids, cudaStream_t stream)
+        {
+            const dim3 statsBlock(256);
+            const dim3 statsGrid(divUp(stats.rows, statsBlock.x));
+
+            initStats<<<statsGrid, statsBlock, 0, stream>>>(stats, sums);
+            cudaSafeCall( cudaGetLastError() );
+
+            const dim3 block(32, 8);
+            const dim3 grid(divUp(divUp(labels.cols, SEGMENT), block.x), divUp(labels.rows, block.y));
+
+            relabelWithStats<<<grid, block, 0, stream>>>(labels, rank, stats, sums);
+            cudaSafeCall( cudaGetLastError() );
+
+            finalizeStats<<<statsGrid, statsBlock, 0, stream>>>(stats, sums, centroids);
+            cudaSafeCall( cudaGetLastError() );
+
+            if (stream == 0)
+                cudaSafeCall( cudaDeviceSynchronize() );
+        }
+    }
+}}}
+
+#endif /* CUDA_DISABLER */
@@ -205,12 +205,16 @@ namespace cv { namespace cuda { namespace device
         ////////////////////////////////////////////////////////////////////////
         // Ballard_Pos
 
+        // The R-tables and the histograms of the templates are stacked vertically,
+        // blockIdx.y (blockIdx.z) selects the template
+
         __global__ void Ballard_Pos_calcHist(const unsigned int* coordList, const float* thetaList, const int pointsCount,
-                                             const PtrStep<short2> r_table, const int* r_sizes,
-                                             PtrStepSzi hist,
+                                             const PtrStep<short2> r_table, const int* r_sizes, const int levels,
+                                             PtrStepi hist, const int histRows, const int histCols,
                                              const float idp, const float thetaScale)
         {
             const int tid = blockIdx.x * blockDim.x + threadIdx.x;
+            const int templ = blockIdx.y;
 
             if (tid >= pointsCount)
                 return;
@@ -221,11 +225,13 @@ namespace cv { namespace cuda { namespace device
             p.y = (coord >> 16) & 0xFFFF;
 
             const float theta = thetaList[tid];
-            const int n = __float2int_rn(theta * thetaScale);
+            const int n = templ * (levels + 1) + __float2int_rn(theta * thetaScale);
 
             const short2* r_row = r_table.ptr(n);
             const int r_row_size = r_sizes[n];
 
+            const int histOffset = templ * histRows + 1;
+
             for (int j = 0; j < r_row_size; ++j)
             {
                 short2 c = saturate_cast<short2>(p - r_row[j]);
@@ -233,78 +239,72 @@ namespace cv { namespace cuda { namespace device
                 c.x = __float2int_rn(c.x * idp);
                 c.y = __float2int_rn(c.y * idp);
 
-                if (c.x >= 0 && c.x < hist.cols - 2 && c.y >= 0 && c.y < hist.rows - 2)
-                    ::atomicAdd(hist.ptr(c.y + 1) + c.x + 1, 1);
+                if (c.x >= 0 && c.x < histCols - 2 && c.y >= 0 && c.y < histRows - 2)
+                    ::atomicAdd(hist.ptr(histOffset + c.y) + c.x + 1, 1);
             }
         }
 
         void Ballard_Pos_calcHist_gpu(const unsigned int* coordList, const float* thetaList, int pointsCount,
                                       PtrStepSz<short2> r_table, const int* r_sizes,
-                                      PtrStepSzi hist,
+                                      PtrStepSzi hist, int histRows, int templCount,
                                       float dp, int levels)
         {
             const dim3 block(256);
-            const dim3 grid(divUp(pointsCount, block.x));
+            const dim3 grid(divUp(pointsCount, block.x), templCount);
 
             const float idp = 1.0f / dp;
             const float thetaScale = levels / (2.0f * CV_PI_F);
 
-            Ballard_Pos_calcHist<<<grid, block>>>(coordList, thetaList, pointsCount, r_table, r_sizes, hist, idp, thetaScale);
+            Ballard_Pos_calcHist<<<grid, block>>>(coordList, thetaList, pointsCount, r_table, r_sizes, levels,
+                                                  hist, histRows, hist.cols, idp, thetaScale);
             cudaSafeCall( cudaGetLastError() );
-
-            cudaSafeCall( cudaDeviceSynchronize() );
         }
 
-        __global__ void Ballard_Pos_findPosInHist(const PtrStepSzi hist, float4* out, int3* votes,
+        __global__ void Ballard_Pos_findPosInHist(const PtrStepi hist, const int histRows, const int histCols, const int templOffset,
+                                                  float4* out, int3* votes, int* ids, int* counter,
                                                   const int maxSize, const float dp, const int threshold)
         {
             const int x = blockIdx.x * blockDim.x + threadIdx.x;
             const int y = blockIdx.y * blockDim.y + threadIdx.y;
+            const int templ = blockIdx.z;
 
-            if (x >= hist.cols - 2 || y >= hist.rows - 2)
+            if (x >= histCols - 2 || y >= histRows - 2)
                 return;
 
-            const int curVotes = hist(y + 1, x + 1);
+            const int row = templ * histRows + y + 1;
+
+            const int curVotes = hist(row, x + 1);
 
             if (curVotes > threshold &&
-                curVotes >  hist(y + 1, x) &&
-                curVotes >= hist(y + 1, x + 2) &&
-                curVotes >  hist(y, x + 1) &&
-                curVotes >= hist(y + 2, x + 1))
+                curVotes >  hist(row, x) &&
+                curVotes >= hist(row, x + 2) &&
+                curVotes >  hist(row - 1, x + 1) &&
+                curVotes >= hist(row + 1, x + 1))
             {
-                const int ind = ::atomicAdd(&g_counter, 1);
+                const int ind = ::atomicAdd(counter, 1);
 
                 if (ind < maxSize)
                 {
                     out[ind] = make_float4(x * dp, y * dp, 1.0f, 0.0f);
                     votes[ind] = make_int3(curVotes, 0, 0);
+                    ids[ind] = templOffset + templ;
                 }
             }
         }
 
-        int Ballard_Pos_findPosInHist_gpu(PtrStepSzi hist, float4* out, int3* votes, int maxSize, float dp, int threshold)
+        void Ballard_Pos_findPosInHist_gpu(PtrStepSzi hist, int histRows, int templCount, int templOffset,
+                                           float4* out, int3* votes, int* ids, int* counter,
+                                           int maxSize, float dp, int threshold)
         {
-            void* counterPtr;
-            cudaSafeCall( cudaGetSymbolAddress(&counterPtr, g_counter) );
-
-            cudaSafeCall( cudaMemset(counterPtr, 0, sizeof(int)) );
-
             const dim3 block(32, 8);
-            const dim3 grid(divUp(hist.cols - 2, block.x), divUp(hist.rows - 2, block.y));
+            const dim3 grid(divUp(hist.cols - 2, block.x), divUp(histRows - 2, block.y), templCount);
 
             cudaSafeCall( cudaFuncSetCacheConfig(Ballard_Pos_findPosInHist, cudaFuncCachePreferL1) );
 
-            Ballard_Pos_findPosInHist<<<grid, block>>>(hist, out, votes, maxSize, dp, threshold);
+            Ballard_Pos_findPosInHist<<<grid, block>>>(hist, histRows, hist.cols, templOffset,
+                                                       out, votes, ids, counter,
+                                                       maxSize, dp, threshold);
             cudaSafeCall( cudaGetLastError() );
-
-            cudaSafeCall( cudaDeviceSynchronize() );
-
-            int totalCount;
-            cudaSafeCall( cudaMemcpy(&totalCount, counterPtr, sizeof(int), cudaMemcpyDeviceToHost) );
-
-            totalCount = ::min(totalCount, maxSize);
-
-            return totalCount;
         }
 
         ////////////////////////////////////////////////////////////////////////
@@ -620,9 +620,10 @@ namespace cv { namespace cuda { namespace device
             cudaSafeCall( cudaDeviceSynchronize() );
         }
 
-        __global__ void Guil_Full_calcSHist(const int* templSizes, const int* imageSizes, int* SHist,
-                                            const float angle, const float angleEpsilon,
-                                            const float minScale, const float maxScale, const float iScaleStep, const int scaleRange)
+        // one scale histogram (a row of SHist) per candidate angle, in radians
+        __global__ void Guil_Full_calcSHist(const int* templSizes, const int* imageSizes, PtrStepi SHist, const float* angles,
+                                                 const float angleEpsilon,
+                                                 const float minScale, const float maxScale, const float iScaleStep, const int scaleRange)
         {
             extern __shared__ int s_SHist[];
             for (int i = threadIdx.x; i <= scaleRange; i += blockDim.x)
@@ -631,6 +632,7 @@ namespace cv { namespace cuda { namespace device
 
             const int tIdx = blockIdx.x;
             const int level = blockIdx.y;
+            const float angle = angles[blockIdx.z];
 
             const int tSize = templSizes[level];
 
@@ -660,26 +662,26 @@ namespace cv { namespace cuda { namespace device
             }
             __syncthreads();
 
+            int* SHistRow = SHist.ptr(blockIdx.z);
             for (int i = threadIdx.x; i <= scaleRange; i += blockDim.x)
-                ::atomicAdd(SHist + i, s_SHist[i]);
+                ::atomicAdd(SHistRow + i, s_SHist[i]);
         }
 
-        void Guil_Full_calcSHist_gpu(const int* templSizes, const int* imageSizes, int* SHist,
-                                     float angle, float angleEpsilon,
-                                     float minScale, float maxScale, float iScaleStep, int scaleRange,
-                                     int levels, int tMaxSize)
+        void Guil_Full_calcSHist_gpu(const int* templSizes, const int* imageSizes, PtrStepSzi SHist,
+                                          const float* angles, int angleCount, float angleEpsilon,
+                                          float minScale, float maxScale, float iScaleStep, int scaleRange,
+                                          int levels, int tMaxSize)
         {
             const dim3 block(256);
-            const dim3 grid(tMaxSize, levels + 1);
+            const dim3 grid(tMaxSize, levels + 1, angleCount);
 
-            angle *= (CV_PI_F / 180.0f);
             angleEpsilon *= (CV_PI_F / 180.0f);
 
             const size_t smemSize = (scaleRange + 1) * sizeof(float);
 
-            Guil_Full_calcSHist<<<grid, block, smemSize>>>(templSizes, imageSizes, SHist,
-                                                           angle, angleEpsilon,
-                                                           minScale, maxScale, iScaleStep, scaleRange);
+            Guil_Full_calcSHist<<<grid, block, smemSize>>>(templSizes, imageSizes, SHist, angles,
+                                                                angleEpsilon,
+                                                                minScale, maxScale, iScaleStep, scaleRange);
             cudaSafeCall( cudaGetLastError() );
 
             cudaSafeCall( cudaDeviceSynchronize() );
@@ -756,11 +758,9 @@ namespace cv { namespace cuda { namespace device
                                                  angle, sinVal, cosVal, angleEpsilon, scale,
                                                  1.0f / dp);
             cudaSafeCall( cudaGetLastError() );
-
-            cudaSafeCall( cudaDeviceSynchronize() );
         }
 
-        __global__ void Guil_Full_findPosInHist(const PtrStepSzi hist, float4* out, int3* votes, const int maxSize,
+        __global__ void Guil_Full_findPosInHist(const PtrStepSzi hist, float4* out, int3* votes, int* counter, const int maxSize,
                                                 const float angle, const int angleVotes, const float scale, const int scaleVotes,
                                                 const float dp, const int threshold)
         {
@@ -778,7 +778,7 @@ namespace cv { namespace cuda { namespace device
                 curVotes >  hist(y, x + 1) &&
                 curVotes >= hist(y + 2, x + 1))
             {
-                const int ind = ::atomicAdd(&g_counter, 1);
+                const int ind = ::atomicAdd(counter, 1);
 
                 if (ind < maxSize)
                 {
@@ -788,33 +788,19 @@ namespace cv { namespace cuda { namespace device
             }
         }
 
-        int Guil_Full_findPosInHist_gpu(PtrStepSzi hist, float4* out, int3* votes, int curSize, int maxSize,
-                                        float angle, int angleVotes, float scale, int scaleVotes,
-                                        float dp, int threshold)
+        void Guil_Full_findPosInHist_gpu(PtrStepSzi hist, float4* out, int3* votes, int* counter, int maxSize,
+                                         float angle, int angleVotes, float scale, int scaleVotes,
+                                         float dp, int threshold)
         {
-            void* counterPtr;
-            cudaSafeCall( cudaGetSymbolAddress(&counterPtr, g_counter) );
-
-            cudaSafeCall( cudaMemcpy(counterPtr, &curSize, sizeof(int), cudaMemcpyHostToDevice) );
-
             const dim3 block(32, 8);
             const dim3 grid(divUp(hist.cols - 2, block.x), divUp(hist.rows - 2, block.y));
 
             cudaSafeCall( cudaFuncSetCacheConfig(Guil_Full_findPosInHist, cudaFuncCachePreferL1) );
 
-            Guil_Full_findPosInHist<<<grid, block>>>(hist, out, votes, maxSize,
+            Guil_Full_findPosInHist<<<grid, block>>>(hist, out, votes, counter, maxSize,
                                                      angle, angleVotes, scale, scaleVotes,
                                                      dp, threshold);
             cudaSafeCall( cudaGetLastError() );
-
-            cudaSafeCall( cudaDeviceSynchronize() );
-
-            int totalCount;
-            cudaSafeCall( cudaMemcpy(&totalCount, counterPtr, sizeof(int), cudaMemcpyDeviceToHost) );
-
-            totalCount = ::min(totalCount, maxSize);
-
-            return totalCount;
         }
     }
 }}}
@@ -52,12 +52,17 @@
 
 namespace cv { namespace cuda { namespace device
 {
+    namespace hough
+    {
+        void clampCount_gpu(const int* counterPtr, int maxSize, int* dst, cudaStream_t stream);
+    }
+
     namespace hough_lines
     {
         ////////////////////////////////////////////////////////////////////////
         // linesAccum
 
-        __global__ void linesAccumGlobal(const unsigned int* list, const int count, PtrStepi accum, const float irho, const float theta, const int numrho)
+        __global__ void linesAccumGlobal(const unsigned int* list, const int count, const int* countPtr, PtrStepi accum, const float irho, const float theta, const int numrho)
         {
             const int n = blockIdx.x;
             const float ang = n * theta;
@@ -71,7 +76,8 @@ namespace cv { namespace cuda { namespace device
             const int shift = (numrho - 1) / 2;
 
             int* accumRow = accum.ptr(n + 1);
-            for (int i = threadIdx.x; i < count; i += blockDim.x)
+            const int total = countPtr ? *countPtr : count;
+            for (int i = threadIdx.x; i < total; i += blockDim.x)
             {
                 const unsigned int val = list[i];
 
@@ -85,7 +91,7 @@ namespace cv { namespace cuda { namespace device
             }
         }
 
-        __global__ void linesAccumShared(const unsigned int* list, const int count, PtrStepi accum, const float irho, const float theta, const int numrho)
+        __global__ void linesAccumShared(const unsigned int* list, const int count, const int* countPtr, PtrStepi accum, const float irho, const float theta, const int numrho)
         {
             int* smem = DynamicSharedMem<int>();
 
@@ -105,7 +111,8 @@ namespace cv { namespace cuda { namespace device
 
             const int shift = (numrho - 1) / 2;
 
-            for (int i = threadIdx.x; i < count; i += blockDim.x)
+            const int total = countPtr ? *countPtr : count;
+            for (int i = threadIdx.x; i < total; i += blockDim.x)
             {
                 const unsigned int val = list[i];
 
@@ -125,7 +132,8 @@ namespace cv { namespace cuda { namespace device
                 accumRow[i] = smem[i];
         }
 
-        void linesAccum_gpu(const unsigned int* list, int count, PtrStepSzi accum, float rho, float theta, size_t sharedMemPerBlock, bool has20, cudaStream_t stream)
+        // the number of points is read from countPtr on the device when it is not null
+        void linesAccumAsync_gpu(const unsigned int* list, int count, const int* countPtr, PtrStepSzi accum, float rho, float theta, size_t sharedMemPerBlock, bool has20, cudaStream_t stream)
         {
             const dim3 block(has20 ? 1024 : 512);
             const dim3 grid(accum.rows - 2);
@@ -133,11 +141,16 @@ namespace cv { namespace cuda { namespace device
             size_t smemSize = (accum.cols - 1) * sizeof(int);
 
             if (smemSize < sharedMemPerBlock - 1000)
-                linesAccumShared<<<grid, block, smemSize, stream>>>(list, count, accum, 1.0f / rho, theta, accum.cols - 2);
+                linesAccumShared<<<grid, block, smemSize, stream>>>(list, count, countPtr, accum, 1.0f / rho, theta, accum.cols - 2);
             else
-                linesAccumGlobal<<<grid, block, 0, stream>>>(list, count, accum, 1.0f / rho, theta, accum.cols - 2);
+                linesAccumGlobal<<<grid, block, 0, stream>>>(list, count, countPtr, accum, 1.0f / rho, theta, accum.cols - 2);
 
             cudaSafeCall( cudaGetLastError() );
+        }
+
+        void linesAccum_gpu(const unsigned int* list, int count, PtrStepSzi accum, float rho, float theta, size_t sharedMemPerBlock, bool has20, cudaStream_t stream)
+        {
+            linesAccumAsync_gpu(list, count, 0, accum, rho, theta, sharedMemPerBlock, has20, stream);
             cudaSafeCall( cudaStreamSynchronize(stream) );
         }
 
@@ -200,6 +213,32 @@ namespace cv { namespace cuda { namespace device
 
             return totalCount;
         }
+
+        // votes of the unused entries are set to -1, so the sort of the whole buffer keeps the found lines first
+        void linesGetResultAsync_gpu(PtrStepSzi accum, float2* out, int* votes, int maxSize, float rho, float theta, int threshold, bool doSort, int* counterPtr, int* countOut, cudaStream_t stream)
+        {
+            cudaSafeCall( cudaMemsetAsync(counterPtr, 0, sizeof(int), stream) );
+
+            if (doSort)
+                cudaSafeCall( cudaMemsetAsync(votes, 0xFF, maxSize * sizeof(int), stream) );
+
+            const dim3 block(32, 8);
+            const dim3 grid(divUp(accum.cols - 2, block.x), divUp(accum.rows - 2, block.y));
+
+            cudaSafeCall( cudaFuncSetCacheConfig(linesGetResult, cudaFuncCachePreferL1) );
+
+            linesGetResult<<<grid, block, 0, stream>>>(accum, out, votes, maxSize, rho, theta, threshold, accum.cols - 2, counterPtr);
+            cudaSafeCall( cudaGetLastError() );
+
+            hough::clampCount_gpu(counterPtr, maxSize, countOut, stream);
+
+            if (doSort)
+            {
+                thrust::device_ptr<float2> outPtr(out);
+                thrust::device_ptr<int> votesPtr(votes);
+                thrust::sort_by_key(thrust::cuda::par.on(stream), votesPtr, votesPtr + maxSize, outPtr, thrust::greater<int>());
+            }
+        }
     }
 }}}
 
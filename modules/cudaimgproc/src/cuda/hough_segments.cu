@@ -47,6 +47,11 @@
 
 namespace cv { namespace cuda { namespace device
 {
+    namespace hough
+    {
+        void clampCount_gpu(const int* counterPtr, int maxSize, int* dst, cudaStream_t stream);
+    }
+
     namespace hough_segments
     {
         texture<uchar, cudaTextureType2D, cudaReadModeElementType> tex_mask(false, cudaFilterModePoint, cudaAddressModeClamp);
@@ -239,6 +244,26 @@ namespace cv { namespace cuda { namespace device
 
             return totalCount;
         }
+
+        void houghLinesProbabilisticAsync_gpu(PtrStepSzb mask, PtrStepSzi accum, int4* out, int maxSize, float rho, float theta, int lineGap, int lineLength, int* counterPtr, int* countOut, cudaStream_t stream)
+        {
+            cudaSafeCall( cudaMemsetAsync(counterPtr, 0, sizeof(int), stream) );
+
+            const dim3 block(32, 8);
+            const dim3 grid(divUp(accum.cols - 2, block.x), divUp(accum.rows - 2, block.y));
+
+            bindTexture(&tex_mask, mask);
+
+            houghLinesProbabilistic<<<grid, block, 0, stream>>>(accum,
+                                                     out, maxSize,
+                                                     rho, theta,
+                                                     lineGap, lineLength,
+                                                     mask.rows, mask.cols,
+                                                     counterPtr);
+            cudaSafeCall( cudaGetLastError() );
+
+            hough::clampCount_gpu(counterPtr, maxSize, countOut, stream);
+        }
     }
 }}}
 
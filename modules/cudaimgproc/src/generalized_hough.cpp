@@ -49,6 +49,8 @@ using namespace cv::cuda;
 
 Ptr<GeneralizedHoughBallard> cv::cuda::createGeneralizedHoughBallard() { throw_no_cuda(); return Ptr<GeneralizedHoughBallard>(); }
 
+Ptr<GeneralizedHoughBallardBatch> cv::cuda::createGeneralizedHoughBallardBatch() { throw_no_cuda(); return Ptr<GeneralizedHoughBallardBatch>(); }
+
 Ptr<GeneralizedHoughGuil> cv::cuda::createGeneralizedHoughGuil() { throw_no_cuda(); return Ptr<GeneralizedHoughGuil>(); }
 
 #else /* !defined (HAVE_CUDA) */
@@ -65,9 +67,11 @@ namespace cv { namespace cuda { namespace device
 
         void Ballard_Pos_calcHist_gpu(const unsigned int* coordList, const float* thetaList, int pointsCount,
                                       PtrStepSz<short2> r_table, const int* r_sizes,
-                                      PtrStepSzi hist,
+                                      PtrStepSzi hist, int histRows, int templCount,
                                       float dp, int levels);
-        int Ballard_Pos_findPosInHist_gpu(PtrStepSzi hist, float4* out, int3* votes, int maxSize, float dp, int threshold);
+        void Ballard_Pos_findPosInHist_gpu(PtrStepSzi hist, int histRows, int templCount, int templOffset,
+                                           float4* out, int3* votes, int* ids, int* counter,
+                                           int maxSize, float dp, int threshold);
 
         void Guil_Full_setTemplFeatures(PtrStepb p1_pos, PtrStepb p1_theta, PtrStepb p2_pos, PtrStepb d12, PtrStepb r1, PtrStepb r2);
         void Guil_Full_setImageFeatures(PtrStepb p1_pos, PtrStepb p1_theta, PtrStepb p2_pos, PtrStepb d12, PtrStepb r1, PtrStepb r2);
@@ -82,17 +86,17 @@ namespace cv { namespace cuda { namespace device
         void Guil_Full_calcOHist_gpu(const int* templSizes, const int* imageSizes, int* OHist,
                                      float minAngle, float maxAngle, float angleStep, int angleRange,
                                      int levels, int tMaxSize);
-        void Guil_Full_calcSHist_gpu(const int* templSizes, const int* imageSizes, int* SHist,
-                                     float angle, float angleEpsilon,
+        void Guil_Full_calcSHist_gpu(const int* templSizes, const int* imageSizes, PtrStepSzi SHist,
+                                     const float* angles, int angleCount, float angleEpsilon,
                                      float minScale, float maxScale, float iScaleStep, int scaleRange,
                                      int levels, int tMaxSize);
         void Guil_Full_calcPHist_gpu(const int* templSizes, const int* imageSizes, PtrStepSzi PHist,
                                      float angle, float angleEpsilon, float scale,
                                      float dp,
                                      int levels, int tMaxSize);
-        int Guil_Full_findPosInHist_gpu(PtrStepSzi hist, float4* out, int3* votes, int curSize, int maxSize,
-                                        float angle, int angleVotes, float scale, int scaleVotes,
-                                        float dp, int threshold);
+        void Guil_Full_findPosInHist_gpu(PtrStepSzi hist, float4* out, int3* votes, int* counter, int maxSize,
+                                         float angle, int angleVotes, float scale, int scaleVotes,
+                                         float dp, int threshold);
     }
 }}}
 
@@ -137,6 +141,8 @@ namespace
         GpuMat edgePointList_;
 
         GpuMat outBuf_;
+        GpuMat outIds_;
+        GpuMat counter_;
         int posCount_;
 
     private:
@@ -157,6 +163,8 @@ namespace
         std::vector<int3> oldVoteBuf_;
         std::vector<float4> newPosBuf_;
         std::vector<int3> newVoteBuf_;
+        std::vector<int> oldIdBuf_;
+        std::vector<int> newIdBuf_;
         std::vector<int> indexies_;
     };
 
@@ -346,6 +354,12 @@ namespace
         cudaSafeCall( cudaMemcpy(&oldPosBuf_[0], outBuf_.ptr(0), posCount_ * sizeof(float4), cudaMemcpyDeviceToHost) );
         cudaSafeCall( cudaMemcpy(&oldVoteBuf_[0], outBuf_.ptr(1), posCount_ * sizeof(int3), cudaMemcpyDeviceToHost) );
 
+        // with several templates only positions of the same template suppress each other
+        const bool withIds = !outIds_.empty();
+        oldIdBuf_.assign(posCount_, 0);
+        if (withIds)
+            cudaSafeCall( cudaMemcpy(&oldIdBuf_[0], outIds_.ptr(), posCount_ * sizeof(int), cudaMemcpyDeviceToHost) );
+
         indexies_.resize(posCount_);
         for (int i = 0; i < posCount_; ++i)
             indexies_[i] = i;
@@ -353,14 +367,16 @@ namespace
 
         newPosBuf_.clear();
         newVoteBuf_.clear();
+        newIdBuf_.clear();
         newPosBuf_.reserve(posCount_);
         newVoteBuf_.reserve(posCount_);
+        newIdBuf_.reserve(posCount_);
 
         const int cellSize = cvRound(minDist_);
         const int gridWidth = (imageSize_.width + cellSize - 1) / cellSize;
         const int gridHeight = (imageSize_.height + cellSize - 1) / cellSize;
 
-        std::vector< std::vector<Point2f> > grid(gridWidth * gridHeight);
+        std::vector< std::vector<int> > grid(gridWidth * gridHeight);
 
         const double minDist2 = minDist_ * minDist_;
 
@@ -390,11 +406,14 @@ namespace
             {
                 for (int xx = x1; xx <= x2; ++xx)
                 {
-                    const std::vector<Point2f>& m = grid[yy * gridWidth + xx];
+                    const std::vector<int>& m = grid[yy * gridWidth + xx];
 
                     for(size_t j = 0; j < m.size(); ++j)
                     {
-                        const Point2f d = p - m[j];
+                        if (oldIdBuf_[m[j]] != oldIdBuf_[ind])
+                            continue;
+
+                        const Point2f d = p - Point2f(oldPosBuf_[m[j]].x, oldPosBuf_[m[j]].y);
 
                         if (d.ddot(d) < minDist2)
                         {
@@ -409,16 +428,19 @@ namespace
 
             if(good)
             {
-                grid[yCell * gridWidth + xCell].push_back(p);
+                grid[yCell * gridWidth + xCell].push_back(ind);
 
                 newPosBuf_.push_back(oldPosBuf_[ind]);
                 newVoteBuf_.push_back(oldVoteBuf_[ind]);
+                newIdBuf_.push_back(oldIdBuf_[ind]);
             }
         }
 
         posCount_ = static_cast<int>(newPosBuf_.size());
         cudaSafeCall( cudaMemcpy(outBuf_.ptr(0), &newPosBuf_[0], posCount_ * sizeof(float4), cudaMemcpyHostToDevice) );
         cudaSafeCall( cudaMemcpy(outBuf_.ptr(1), &newVoteBuf_[0], posCount_ * sizeof(int3), cudaMemcpyHostToDevice) );
+        if (withIds)
+            cudaSafeCall( cudaMemcpy(outIds_.ptr(), &newIdBuf_[0], posCount_ * sizeof(int), cudaMemcpyHostToDevice) );
     }
 
     void GeneralizedHoughBase::convertTo(OutputArray positions, OutputArray votes)
@@ -438,17 +460,21 @@ namespace
 
 namespace
 {
-    class GeneralizedHoughBallardImpl : public GeneralizedHoughBallard, private GeneralizedHoughBase
+    class GeneralizedHoughBallardImpl : public GeneralizedHoughBallardBatch, private GeneralizedHoughBase
     {
     public:
         GeneralizedHoughBallardImpl();
 
-        void setTemplate(InputArray templ, Point templCenter) { setTemplateImpl(templ, templCenter); }
-        void setTemplate(InputArray edges, InputArray dx, InputArray dy, Point templCenter) { setTemplateImpl(edges, dx, dy, templCenter); }
+        void setTemplate(InputArray templ, Point templCenter) { reserveTemplates(1); setTemplateImpl(templ, templCenter); }
+        void setTemplate(InputArray edges, InputArray dx, InputArray dy, Point templCenter) { reserveTemplates(1); setTemplateImpl(edges, dx, dy, templCenter); }
+
+        void setTemplates(const std::vector<GpuMat>& templs);
 
         void detect(InputArray image, OutputArray positions, OutputArray votes) { detectImpl(image, positions, votes); }
         void detect(InputArray edges, InputArray dx, InputArray dy, OutputArray positions, OutputArray votes) { detectImpl(edges, dx, dy, positions, votes); }
 
+        void detectAll(InputArray image, OutputArray positions, OutputArray votes, OutputArray templateIds);
+
         void setCannyLowThresh(int cannyLowThresh) { cannyLowThresh_ = cannyLowThresh; }
         int getCannyLowThresh() const { return cannyLowThresh_; }
 
@@ -471,15 +497,17 @@ namespace
         int getVotesThreshold() const { return votesThreshold_; }
 
     private:
+        void reserveTemplates(int count);
+
         void processTempl();
         void processImage();
 
-        void calcHist();
-        void findPosInHist();
-
         int levels_;
         int votesThreshold_;
 
+        int templCount_;
+
+        // R-tables of all templates, stacked vertically
         GpuMat r_table_;
         GpuMat r_sizes_;
 
@@ -490,66 +518,118 @@ namespace
     {
         levels_ = 360;
         votesThreshold_ = 100;
+        templCount_ = 0;
+    }
+
+    void GeneralizedHoughBallardImpl::reserveTemplates(int count)
+    {
+        CV_Assert( levels_ > 0 && count > 0 );
+
+        ensureSizeIsEnough(count * (levels_ + 1), maxBufferSize_, CV_16SC2, r_table_);
+        ensureSizeIsEnough(1, count * (levels_ + 1), CV_32SC1, r_sizes_);
+        r_sizes_.setTo(Scalar::all(0));
+
+        templCount_ = 0;
+    }
+
+    void GeneralizedHoughBallardImpl::setTemplates(const std::vector<GpuMat>& templs)
+    {
+        reserveTemplates(static_cast<int>(templs.size()));
+
+        for (size_t i = 0; i < templs.size(); ++i)
+            setTemplateImpl(templs[i], Point(-1, -1));
     }
 
     void GeneralizedHoughBallardImpl::processTempl()
     {
         using namespace cv::cuda::device::ght;
 
-        CV_Assert( levels_ > 0 );
+        CV_Assert( r_table_.rows == r_sizes_.cols && r_table_.rows % (levels_ + 1) == 0 );
+        CV_Assert( templCount_ < r_table_.rows / (levels_ + 1) );
 
         buildEdgePointList(templEdges_, templDx_, templDy_);
 
-        ensureSizeIsEnough(levels_ + 1, maxBufferSize_, CV_16SC2, r_table_);
-        ensureSizeIsEnough(1, levels_ + 1, CV_32SC1, r_sizes_);
-        r_sizes_.setTo(Scalar::all(0));
+        const Range rows(templCount_ * (levels_ + 1), (templCount_ + 1) * (levels_ + 1));
+        GpuMat r_table = r_table_.rowRange(rows);
+        GpuMat r_sizes = r_sizes_.colRange(rows);
 
         if (edgePointList_.cols > 0)
         {
             buildRTable_gpu(edgePointList_.ptr<unsigned int>(0), edgePointList_.ptr<float>(1), edgePointList_.cols,
-                            r_table_, r_sizes_.ptr<int>(), make_short2(templCenter_.x, templCenter_.y), levels_);
-            cuda::min(r_sizes_, maxBufferSize_, r_sizes_);
+                            r_table, r_sizes.ptr<int>(), make_short2(templCenter_.x, templCenter_.y), levels_);
+            cuda::min(r_sizes, maxBufferSize_, r_sizes);
         }
-    }
 
-    void GeneralizedHoughBallardImpl::processImage()
-    {
-        calcHist();
-        findPosInHist();
+        ++templCount_;
     }
 
-    void GeneralizedHoughBallardImpl::calcHist()
+    void GeneralizedHoughBallardImpl::processImage()
     {
         using namespace cv::cuda::device::ght;
 
-        CV_Assert( levels_ > 0 && r_table_.rows == (levels_ + 1) && r_sizes_.cols == (levels_ + 1) );
-        CV_Assert( dp_ > 0.0);
+        // the histograms of this many cells are accumulated in one pass
+        const size_t maxHistCells = 64 << 20;
+
+        CV_Assert( levels_ > 0 && templCount_ > 0 && r_table_.rows == templCount_ * (levels_ + 1) );
+        CV_Assert( dp_ > 0.0 );
+        CV_Assert( votesThreshold_ > 0 );
 
         const double idp = 1.0 / dp_;
 
         buildEdgePointList(imageEdges_, imageDx_, imageDy_);
 
-        ensureSizeIsEnough(cvCeil(imageSize_.height * idp) + 2, cvCeil(imageSize_.width * idp) + 2, CV_32SC1, hist_);
-        hist_.setTo(Scalar::all(0));
+        if (edgePointList_.cols == 0)
+            return;
 
-        if (edgePointList_.cols > 0)
+        const int histRows = cvCeil(imageSize_.height * idp) + 2;
+        const int histCols = cvCeil(imageSize_.width * idp) + 2;
+        const int chunk = static_cast<int>(std::max<size_t>(1, std::min<size_t>(templCount_, maxHistCells / ((size_t) histRows * histCols))));
+
+        ensureSizeIsEnough(chunk * histRows, histCols, CV_32SC1, hist_);
+
+        ensureSizeIsEnough(2, maxBufferSize_, CV_32FC4, outBuf_);
+        ensureSizeIsEnough(1, maxBufferSize_, CV_32SC1, outIds_);
+
+        // the number of positions stays on the device until all templates are processed
+        ensureSizeIsEnough(1, 1, CV_32SC1, counter_);
+        counter_.setTo(Scalar::all(0));
+
+        for (int first = 0; first < templCount_; first += chunk)
         {
+            const int count = std::min(chunk, templCount_ - first);
+
+            GpuMat hist = hist_.rowRange(0, count * histRows);
+            hist.setTo(Scalar::all(0));
+
             Ballard_Pos_calcHist_gpu(edgePointList_.ptr<unsigned int>(0), edgePointList_.ptr<float>(1), edgePointList_.cols,
-                                     r_table_, r_sizes_.ptr<int>(),
-                                     hist_,
+                                     r_table_.rowRange(first * (levels_ + 1), (first + count) * (levels_ + 1)),
+                                     r_sizes_.ptr<int>() + first * (levels_ + 1),
+                                     hist, histRows, count,
                                      (float)dp_, levels_);
+
+            Ballard_Pos_findPosInHist_gpu(hist, histRows, count, first,
+                                          outBuf_.ptr<float4>(0), outBuf_.ptr<int3>(1), outIds_.ptr<int>(), counter_.ptr<int>(),
+                                          maxBufferSize_, (float)dp_, votesThreshold_);
         }
+
+        int totalCount;
+        cudaSafeCall( cudaMemcpy(&totalCount, counter_.ptr<int>(), sizeof(int), cudaMemcpyDeviceToHost) );
+
+        posCount_ = std::min(totalCount, maxBufferSize_);
     }
 
-    void GeneralizedHoughBallardImpl::findPosInHist()
+    void GeneralizedHoughBallardImpl::detectAll(InputArray image, OutputArray positions, OutputArray votes, OutputArray templateIds)
     {
-        using namespace cv::cuda::device::ght;
-
-        CV_Assert( votesThreshold_ > 0 );
+        detectImpl(image, positions, votes);
 
-        ensureSizeIsEnough(2, maxBufferSize_, CV_32FC4, outBuf_);
+        if (posCount_ == 0)
+        {
+            templateIds.release();
+            return;
+        }
 
-        posCount_ = Ballard_Pos_findPosInHist_gpu(hist_, outBuf_.ptr<float4>(0), outBuf_.ptr<int3>(1), maxBufferSize_, (float)dp_, votesThreshold_);
+        ensureSizeIsEnough(1, posCount_, CV_32SC1, templateIds);
+        outIds_.colRange(0, posCount_).copyTo(templateIds);
     }
 }
 
@@ -558,6 +638,11 @@ Ptr<GeneralizedHoughBallard> cv::cuda::createGeneralizedHoughBallard()
     return makePtr<GeneralizedHoughBallardImpl>();
 }
 
+Ptr<GeneralizedHoughBallardBatch> cv::cuda::createGeneralizedHoughBallardBatch()
+{
+    return makePtr<GeneralizedHoughBallardImpl>();
+}
+
 // GeneralizedHoughGuil
 
 namespace
@@ -671,14 +756,18 @@ namespace
                               set_func_t set_func, build_func_t build_func, bool isTempl, Point2d center = Point2d());
 
         void calcOrientation();
-        void calcScale(double angle);
+        void calcScales();
         void calcPosition(double angle, int angleVotes, double scale, int scaleVotes);
 
         Feature templFeatures_;
         Feature imageFeatures_;
 
         std::vector< std::pair<double, int> > angles_;
-        std::vector< std::pair<double, int> > scales_;
+
+        std::vector<float> h_angles_;
+        GpuMat d_angles_;
+        GpuMat scaleHist_;
+        Mat h_scaleHist_;
 
         GpuMat hist_;
         std::vector<int> h_buf_;
@@ -754,21 +843,36 @@ namespace
 
         calcOrientation();
 
+        if (angles_.empty())
+            return;
+
+        calcScales();
+
+        // the number of positions stays on the device until all candidates are processed
+        ensureSizeIsEnough(1, 1, CV_32SC1, counter_);
+        counter_.setTo(Scalar::all(0));
+
         for (size_t i = 0; i < angles_.size(); ++i)
         {
             const double angle = angles_[i].first;
             const int angleVotes = angles_[i].second;
 
-            calcScale(angle);
+            const int* scaleHist = h_scaleHist_.ptr<int>(static_cast<int>(i));
 
-            for (size_t j = 0; j < scales_.size(); ++j)
+            for (int s = 0; s < scaleRange; ++s)
             {
-                const double scale = scales_[j].first;
-                const int scaleVotes = scales_[j].second;
-
-                calcPosition(angle, angleVotes, scale, scaleVotes);
+                if (scaleHist[s] >= scaleThresh_)
+                {
+                    const double scale = minScale_ + s * scaleStep_;
+                    calcPosition(angle, angleVotes, scale, scaleHist[s]);
+                }
             }
         }
+
+        int totalCount;
+        cudaSafeCall( cudaMemcpy(&totalCount, counter_.ptr<int>(), sizeof(int), cudaMemcpyDeviceToHost) );
+
+        posCount_ = std::min(totalCount, maxBufferSize_);
     }
 
     void GeneralizedHoughGuilImpl::Feature::create(int levels, int maxCapacity, bool isTempl)
@@ -838,29 +942,30 @@ namespace
         }
     }
 
-    void GeneralizedHoughGuilImpl::calcScale(double angle)
+    void GeneralizedHoughGuilImpl::calcScales()
     {
         using namespace cv::cuda::device::ght;
 
         const double iScaleStep = 1.0 / scaleStep_;
         const int scaleRange = cvCeil((maxScale_ - minScale_) * iScaleStep);
 
-        hist_.setTo(Scalar::all(0));
-        Guil_Full_calcSHist_gpu(templFeatures_.sizes.ptr<int>(), imageFeatures_.sizes.ptr<int>(0), hist_.ptr<int>(),
-                                (float)angle, (float)angleEpsilon_, (float)minScale_, (float)maxScale_,
-                                (float)iScaleStep, scaleRange, levels_, templFeatures_.maxSize);
-        cudaSafeCall( cudaMemcpy(&h_buf_[0], hist_.data, h_buf_.size() * sizeof(int), cudaMemcpyDeviceToHost) );
+        const int angleCount = static_cast<int>(angles_.size());
 
-        scales_.clear();
+        // the scale histograms of all candidate angles are built in one pass and read back at once
+        h_angles_.resize(angleCount);
+        for (int i = 0; i < angleCount; ++i)
+            h_angles_[i] = static_cast<float>(angles_[i].first * CV_PI / 180.0);
+        d_angles_.upload(Mat(1, angleCount, CV_32FC1, &h_angles_[0]));
 
-        for (int s = 0; s < scaleRange; ++s)
-        {
-            if (h_buf_[s] >= scaleThresh_)
-            {
-                const double scale = minScale_ + s * scaleStep_;
-                scales_.push_back(std::make_pair(scale, h_buf_[s]));
-            }
-        }
+        ensureSizeIsEnough(angleCount, scaleRange + 1, CV_32SC1, scaleHist_);
+        scaleHist_.setTo(Scalar::all(0));
+
+        Guil_Full_calcSHist_gpu(templFeatures_.sizes.ptr<int>(), imageFeatures_.sizes.ptr<int>(0), scaleHist_,
+                                d_angles_.ptr<float>(), angleCount, (float)angleEpsilon_,
+                                (float)minScale_, (float)maxScale_, (float)iScaleStep, scaleRange,
+                                levels_, templFeatures_.maxSize);
+
+        scaleHist_.download(h_scaleHist_);
     }
 
     void GeneralizedHoughGuilImpl::calcPosition(double angle, int angleVotes, double scale, int scaleVotes)
@@ -871,9 +976,9 @@ namespace
         Guil_Full_calcPHist_gpu(templFeatures_.sizes.ptr<int>(), imageFeatures_.sizes.ptr<int>(0), hist_,
                                 (float)angle, (float)angleEpsilon_, (float)scale, (float)dp_, levels_, templFeatures_.maxSize);
 
-        posCount_ = Guil_Full_findPosInHist_gpu(hist_, outBuf_.ptr<float4>(0), outBuf_.ptr<int3>(1),
-                                                posCount_, maxBufferSize_, (float)angle, angleVotes,
-                                                (float)scale, scaleVotes, (float)dp_, posThresh_);
+        Guil_Full_findPosInHist_gpu(hist_, outBuf_.ptr<float4>(0), outBuf_.ptr<int3>(1), counter_.ptr<int>(),
+                                    maxBufferSize_, (float)angle, angleVotes,
+                                    (float)scale, scaleVotes, (float)dp_, posThresh_);
     }
 }
 
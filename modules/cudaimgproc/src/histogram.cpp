@@ -137,9 +137,11 @@ void cv::cuda::equalizeHist(InputArray _src, OutputArray _dst, Stream& _stream)
 
 namespace clahe
 {
-    void calcLut_8U(PtrStepSzb src, PtrStepb lut, int tilesX, int tilesY, int2 tileSize, int clipLimit, float lutScale, cudaStream_t stream);
+    void calcLut_8U(PtrStepSzb src, const PtrStepb* srcs, int nimages, int cn, PtrStepb lut, int tilesX, int tilesY, int2 tileSize, int clipLimit, float lutScale, cudaStream_t stream);
     void calcLut_16U(PtrStepSzus src, PtrStepus lut, int tilesX, int tilesY, int2 tileSize, int clipLimit, float lutScale, PtrStepSzi hist, cudaStream_t stream);
     template <typename T> void transform(PtrStepSz<T> src, PtrStepSz<T> dst, PtrStep<T> lut, int tilesX, int tilesY, int2 tileSize, cudaStream_t stream);
+    void transform_8U(PtrStepSzb src, const PtrStepb* srcs, PtrStepb dst, const PtrStepb* dsts, int nimages, int cn,
+                      PtrStepb lut, int tilesX, int tilesY, int2 tileSize, cudaStream_t stream);
 }
 
 namespace
@@ -151,6 +153,7 @@ namespace
 
         void apply(cv::InputArray src, cv::OutputArray dst);
         void apply(InputArray src, OutputArray dst, Stream& stream);
+        void applyBatch(const std::vector<GpuMat>& src, std::vector<GpuMat>& dst, Stream& stream);
 
         void setClipLimit(double clipLimit);
         double getClipLimit() const;
@@ -161,6 +164,8 @@ namespace
         void collectGarbage();
 
     private:
+        void lutParams(Size tileSize, int histSize, int& clipLimit, float& lutScale) const;
+
         double clipLimit_;
         int tilesX_;
         int tilesY_;
@@ -168,6 +173,10 @@ namespace
         GpuMat srcExt_;
         GpuMat lut_;
         GpuMat hist_; // histogram on global memory for CV_16UC1 case
+
+        // source and destination headers of applyBatch
+        std::vector<PtrStepb> batchHeaders_;
+        GpuMat batchHeadersDevice_;
     };
 
     CLAHE_Impl::CLAHE_Impl(double clipLimit, int tilesX, int tilesY) :
@@ -180,22 +189,51 @@ namespace
         apply(_src, _dst, Stream::Null());
     }
 
+    void CLAHE_Impl::lutParams(Size tileSize, int histSize, int& clipLimit, float& lutScale) const
+    {
+        const int tileSizeTotal = tileSize.area();
+        lutScale = static_cast<float>(histSize - 1) / tileSizeTotal;
+
+        clipLimit = 0;
+        if (clipLimit_ > 0.0)
+        {
+            clipLimit = static_cast<int>(clipLimit_ * tileSizeTotal / histSize);
+            clipLimit = std::max(clipLimit, 1);
+        }
+    }
+
     void CLAHE_Impl::apply(InputArray _src, OutputArray _dst, Stream& s)
     {
         GpuMat src = _src.getGpuMat();
 
         const int type = src.type();
 
-        CV_Assert( type == CV_8UC1 || type == CV_16UC1 );
+        CV_Assert( type == CV_8UC1 || type == CV_8UC3 || type == CV_8UC4 || type == CV_16UC1 );
 
         _dst.create( src.size(), type );
         GpuMat dst = _dst.getGpuMat();
 
-        const int histSize = type == CV_8UC1 ? 256 : 65536;
+        cudaStream_t stream = StreamAccessor::getStream(s);
 
-        ensureSizeIsEnough(tilesX_ * tilesY_, histSize, type, lut_);
+        int clipLimit;
+        float lutScale;
 
-        cudaStream_t stream = StreamAccessor::getStream(s);
+        if (src.depth() == CV_8U)
+        {
+            // the tiles which cross the image edges are extended by the kernel itself
+            const cv::Size tileSize(divUp(src.cols, tilesX_), divUp(src.rows, tilesY_));
+            lutParams(tileSize, 256, clipLimit, lutScale);
+
+            ensureSizeIsEnough(tilesX_ * tilesY_, 256, CV_8UC1, lut_);
+
+            clahe::calcLut_8U(src, 0, 1, src.channels(), lut_, tilesX_, tilesY_, make_int2(tileSize.width, tileSize.height), clipLimit, lutScale, stream);
+            clahe::transform_8U(src, 0, dst, 0, 1, src.channels(), lut_, tilesX_, tilesY_, make_int2(tileSize.width, tileSize.height), stream);
+            return;
+        }
+
+        const int histSize = 65536;
+
+        ensureSizeIsEnough(tilesX_ * tilesY_, histSize, type, lut_);
 
         cv::Size tileSize;
         GpuMat srcForLut;
@@ -217,28 +255,57 @@ namespace
             srcForLut = srcExt_;
         }
 
-        const int tileSizeTotal = tileSize.area();
-        const float lutScale = static_cast<float>(histSize - 1) / tileSizeTotal;
+        lutParams(tileSize, histSize, clipLimit, lutScale);
 
-        int clipLimit = 0;
-        if (clipLimit_ > 0.0)
-        {
-            clipLimit = static_cast<int>(clipLimit_ * tileSizeTotal / histSize);
-            clipLimit = std::max(clipLimit, 1);
-        }
+        ensureSizeIsEnough(tilesX_ * tilesY_, histSize, CV_32SC1, hist_);
+        clahe::calcLut_16U(srcForLut, lut_, tilesX_, tilesY_, make_int2(tileSize.width, tileSize.height), clipLimit, lutScale, hist_, stream);
+
+        clahe::transform<ushort>(src, dst, lut_, tilesX_, tilesY_, make_int2(tileSize.width, tileSize.height), stream);
+    }
+
+    void CLAHE_Impl::applyBatch(const std::vector<GpuMat>& src, std::vector<GpuMat>& dst, Stream& s)
+    {
+        const int nimages = static_cast<int>(src.size());
+
+        dst.resize(nimages);
+        if (nimages == 0)
+            return;
 
-        if (type == CV_8UC1)
-            clahe::calcLut_8U(srcForLut, lut_, tilesX_, tilesY_, make_int2(tileSize.width, tileSize.height), clipLimit, lutScale, stream);
-        else // type == CV_16UC1
+        const int type = src[0].type();
+        const cv::Size size = src[0].size();
+
+        CV_Assert( type == CV_8UC1 || type == CV_8UC3 || type == CV_8UC4 );
+
+        batchHeaders_.resize(2 * nimages);
+        for (int i = 0; i < nimages; ++i)
         {
-            ensureSizeIsEnough(tilesX_ * tilesY_, histSize, CV_32SC1, hist_);
-            clahe::calcLut_16U(srcForLut, lut_, tilesX_, tilesY_, make_int2(tileSize.width, tileSize.height), clipLimit, lutScale, hist_, stream);
+            CV_Assert( src[i].type() == type && src[i].size() == size );
+
+            dst[i].create(size, type);
+
+            batchHeaders_[i] = src[i];
+            batchHeaders_[nimages + i] = dst[i];
         }
 
-        if (type == CV_8UC1)
-            clahe::transform<uchar>(src, dst, lut_, tilesX_, tilesY_, make_int2(tileSize.width, tileSize.height), stream);
-        else // type == CV_16UC1
-            clahe::transform<ushort>(src, dst, lut_, tilesX_, tilesY_, make_int2(tileSize.width, tileSize.height), stream);
+        const int headerBytes = static_cast<int>(batchHeaders_.size() * sizeof(PtrStepb));
+        ensureSizeIsEnough(1, headerBytes, CV_8UC1, batchHeadersDevice_);
+        batchHeadersDevice_.upload(Mat(1, headerBytes, CV_8UC1, &batchHeaders_[0]), s);
+
+        const PtrStepb* d_srcs = batchHeadersDevice_.ptr<PtrStepb>();
+        const PtrStepb* d_dsts = d_srcs + nimages;
+
+        cudaStream_t stream = StreamAccessor::getStream(s);
+
+        const cv::Size tileSize(divUp(size.width, tilesX_), divUp(size.height, tilesY_));
+
+        int clipLimit;
+        float lutScale;
+        lutParams(tileSize, 256, clipLimit, lutScale);
+
+        ensureSizeIsEnough(nimages * tilesX_ * tilesY_, 256, CV_8UC1, lut_);
+
+        clahe::calcLut_8U(src[0], d_srcs, nimages, src[0].channels(), lut_, tilesX_, tilesY_, make_int2(tileSize.width, tileSize.height), clipLimit, lutScale, stream);
+        clahe::transform_8U(src[0], d_srcs, dst[0], d_dsts, nimages, src[0].channels(), lut_, tilesX_, tilesY_, make_int2(tileSize.width, tileSize.height), stream);
     }
 
     void CLAHE_Impl::setClipLimit(double clipLimit)
@@ -266,6 +333,8 @@ namespace
     {
         srcExt_.release();
         lut_.release();
+        hist_.release();
+        batchHeadersDevice_.release();
     }
 }
 
@@ -56,12 +56,16 @@ namespace cv { namespace cuda { namespace device
     namespace hough
     {
         int buildPointList_gpu(PtrStepSzb src, unsigned int* list, int* counterPtr, cudaStream_t stream);
+        void buildPointListAsync_gpu(PtrStepSzb src, unsigned int* list, int* counterPtr, cudaStream_t stream);
     }
 
     namespace hough_lines
     {
         void linesAccum_gpu(const unsigned int* list, int count, PtrStepSzi accum, float rho, float theta, size_t sharedMemPerBlock, bool has20, cudaStream_t stream);
         int linesGetResult_gpu(PtrStepSzi accum, float2* out, int* votes, int maxSize, float rho, float theta, int threshold, bool doSort, int* counterPtr, cudaStream_t stream);
+
+        void linesAccumAsync_gpu(const unsigned int* list, int count, const int* countPtr, PtrStepSzi accum, float rho, float theta, size_t sharedMemPerBlock, bool has20, cudaStream_t stream);
+        void linesGetResultAsync_gpu(PtrStepSzi accum, float2* out, int* votes, int maxSize, float rho, float theta, int threshold, bool doSort, int* counterPtr, int* countOut, cudaStream_t stream);
     }
 }}}
 
@@ -74,6 +78,7 @@ namespace
         ~HoughLinesDetectorImpl();
 
         void detect(InputArray src, OutputArray lines, Stream& stream);
+        void detect(InputArray src, OutputArray lines, OutputArray count, Stream& stream);
         void downloadResults(InputArray d_lines, OutputArray h_lines, OutputArray h_votes, Stream& stream);
 
         void setRho(float rho) { rho_ = rho; }
@@ -149,7 +154,9 @@ namespace
         CV_Assert( src.cols < std::numeric_limits<unsigned short>::max() );
         CV_Assert( src.rows < std::numeric_limits<unsigned short>::max() );
 
-        ensureSizeIsEnough(1, src.size().area(), CV_32SC1, list_);
+        cudev::ScratchPool pool(stream);
+
+        pool.ensureSizeIsEnough(1, src.size().area(), CV_32SC1, list_);
         unsigned int* srcPoints = list_.ptr<unsigned int>();
 
         const int pointsCount = buildPointList_gpu(src, srcPoints, counterPtr_, cudaStream);
@@ -163,13 +170,13 @@ namespace
         const int numrho = cvRound(((src.cols + src.rows) * 2 + 1) / rho_);
         CV_Assert( numangle > 0 && numrho > 0 );
 
-        ensureSizeIsEnough(numangle + 2, numrho + 2, CV_32SC1, accum_);
+        pool.ensureSizeIsEnough(numangle + 2, numrho + 2, CV_32SC1, accum_);
         accum_.setTo(Scalar::all(0), stream);
 
         DeviceInfo devInfo;
         linesAccum_gpu(srcPoints, pointsCount, accum_, rho_, theta_, devInfo.sharedMemPerBlock(), devInfo.supports(FEATURE_SET_COMPUTE_20), cudaStream);
 
-        ensureSizeIsEnough(2, maxLines_, CV_32FC2, result_);
+        pool.ensureSizeIsEnough(2, maxLines_, CV_32FC2, result_);
 
         int linesCount = linesGetResult_gpu(accum_, result_.ptr<float2>(0), result_.ptr<int>(1), maxLines_, rho_, theta_, threshold_, doSort_, counterPtr_, cudaStream);
 
@@ -183,6 +190,47 @@ namespace
         result_.copyTo(lines, stream);
     }
 
+    void HoughLinesDetectorImpl::detect(InputArray _src, OutputArray _lines, OutputArray _count, Stream& stream)
+    {
+        using namespace cv::cuda::device::hough;
+        using namespace cv::cuda::device::hough_lines;
+
+        auto cudaStream = StreamAccessor::getStream(stream);
+        GpuMat src = _src.getGpuMat();
+
+        CV_Assert( src.type() == CV_8UC1 );
+        CV_Assert( src.cols < std::numeric_limits<unsigned short>::max() );
+        CV_Assert( src.rows < std::numeric_limits<unsigned short>::max() );
+        CV_Assert( _lines.kind() == _InputArray::CUDA_GPU_MAT );
+
+        const int numangle = cvRound(CV_PI / theta_);
+        const int numrho = cvRound(((src.cols + src.rows) * 2 + 1) / rho_);
+        CV_Assert( numangle > 0 && numrho > 0 );
+
+        cudev::ScratchPool pool(stream);
+
+        pool.ensureSizeIsEnough(1, src.size().area(), CV_32SC1, list_);
+        unsigned int* srcPoints = list_.ptr<unsigned int>();
+
+        // the number of points stays in counterPtr_ and is read by the accumulation kernel
+        buildPointListAsync_gpu(src, srcPoints, counterPtr_, cudaStream);
+
+        pool.ensureSizeIsEnough(numangle + 2, numrho + 2, CV_32SC1, accum_);
+        accum_.setTo(Scalar::all(0), stream);
+
+        DeviceInfo devInfo;
+        linesAccumAsync_gpu(srcPoints, 0, counterPtr_, accum_, rho_, theta_, devInfo.sharedMemPerBlock(), devInfo.supports(FEATURE_SET_COMPUTE_20), cudaStream);
+
+        _lines.create(2, maxLines_, CV_32FC2);
+        GpuMat lines = _lines.getGpuMat();
+
+        GpuMat count = getOutputMat(_count, 1, 1, CV_32SC1, stream);
+
+        linesGetResultAsync_gpu(accum_, lines.ptr<float2>(0), lines.ptr<int>(1), maxLines_, rho_, theta_, threshold_, doSort_, counterPtr_, count.ptr<int>(), cudaStream);
+
+        syncOutput(count, _count, stream);
+    }
+
     void HoughLinesDetectorImpl::downloadResults(InputArray _d_lines, OutputArray h_lines, OutputArray h_votes, Stream& stream)
     {
         GpuMat d_lines = _d_lines.getGpuMat();
@@ -56,16 +56,19 @@ namespace cv { namespace cuda { namespace device
     namespace hough
     {
         int buildPointList_gpu(PtrStepSzb src, unsigned int* list, int* counterPtr, cudaStream_t stream);
+        void buildPointListAsync_gpu(PtrStepSzb src, unsigned int* list, int* counterPtr, cudaStream_t stream);
     }
 
     namespace hough_lines
     {
         void linesAccum_gpu(const unsigned int* list, int count, PtrStepSzi accum, float rho, float theta, size_t sharedMemPerBlock, bool has20, cudaStream_t stream);
+        void linesAccumAsync_gpu(const unsigned int* list, int count, const int* countPtr, PtrStepSzi accum, float rho, float theta, size_t sharedMemPerBlock, bool has20, cudaStream_t stream);
     }
 
     namespace hough_segments
     {
         int houghLinesProbabilistic_gpu(PtrStepSzb mask, PtrStepSzi accum, int4* out, int maxSize, float rho, float theta, int lineGap, int lineLength, int* counterPtr, cudaStream_t stream);
+        void houghLinesProbabilisticAsync_gpu(PtrStepSzb mask, PtrStepSzi accum, int4* out, int maxSize, float rho, float theta, int lineGap, int lineLength, int* counterPtr, int* countOut, cudaStream_t stream);
     }
 }}}
 
@@ -78,6 +81,7 @@ namespace
         ~HoughSegmentDetectorImpl();
 
         void detect(InputArray src, OutputArray lines, Stream& stream);
+        void detect(InputArray src, OutputArray lines, OutputArray count, Stream& stream);
 
         void setRho(float rho) { rho_ = rho; }
         float getRho() const { return rho_; }
@@ -189,6 +193,46 @@ namespace
         result_.cols = linesCount;
         result_.copyTo(lines, stream);
     }
+
+    void HoughSegmentDetectorImpl::detect(InputArray _src, OutputArray _lines, OutputArray _count, Stream& stream)
+    {
+        using namespace cv::cuda::device::hough;
+        using namespace cv::cuda::device::hough_lines;
+        using namespace cv::cuda::device::hough_segments;
+
+        auto cudaStream = StreamAccessor::getStream(stream);
+        GpuMat src = _src.getGpuMat();
+
+        CV_Assert( src.type() == CV_8UC1 );
+        CV_Assert( src.cols < std::numeric_limits<unsigned short>::max() );
+        CV_Assert( src.rows < std::numeric_limits<unsigned short>::max() );
+        CV_Assert( _lines.kind() == _InputArray::CUDA_GPU_MAT );
+
+        const int numangle = cvRound(CV_PI / theta_);
+        const int numrho = cvRound(((src.cols + src.rows) * 2 + 1) / rho_);
+        CV_Assert( numangle > 0 && numrho > 0 );
+
+        ensureSizeIsEnough(1, src.size().area(), CV_32SC1, list_);
+        unsigned int* srcPoints = list_.ptr<unsigned int>();
+
+        // the number of points stays in counterPtr_ and is read by the accumulation kernel
+        buildPointListAsync_gpu(src, srcPoints, counterPtr_, cudaStream);
+
+        ensureSizeIsEnough(numangle + 2, numrho + 2, CV_32SC1, accum_);
+        accum_.setTo(Scalar::all(0), stream);
+
+        DeviceInfo devInfo;
+        linesAccumAsync_gpu(srcPoints, 0, counterPtr_, accum_, rho_, theta_, devInfo.sharedMemPerBlock(), devInfo.supports(FEATURE_SET_COMPUTE_20), cudaStream);
+
+        _lines.create(1, maxLines_, CV_32SC4);
+        GpuMat lines = _lines.getGpuMat();
+
+        GpuMat count = getOutputMat(_count, 1, 1, CV_32SC1, stream);
+
+        houghLinesProbabilisticAsync_gpu(src, accum_, lines.ptr<int4>(), maxLines_, rho_, theta_, maxLineGap_, minLineLength_, counterPtr_, count.ptr<int>(), cudaStream);
+
+        syncOutput(count, _count, stream);
+    }
 }
 
 Ptr<HoughSegmentDetector> cv::cuda::createHoughSegmentDetector(float rho, float theta, int minLineLength, int maxLineGap, int maxLines)
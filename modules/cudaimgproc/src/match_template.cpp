@@ -49,6 +49,8 @@ using namespace cv::cuda;
 
 Ptr<cuda::TemplateMatching> cv::cuda::createTemplateMatching(int, int, Size) { throw_no_cuda(); return Ptr<cuda::TemplateMatching>(); }
 
+Ptr<cuda::TemplateMatchingBatch> cv::cuda::createTemplateMatchingBatch(int, int) { throw_no_cuda(); return Ptr<cuda::TemplateMatchingBatch>(); }
+
 #else
 
 namespace cv { namespace cuda { namespace device
@@ -589,6 +591,383 @@ namespace
             }
         }
     }
+
+    ///////////////////////////////////////////////////////////////
+    // Batch
+
+    class MatchBatch : public TemplateMatchingBatch
+    {
+    public:
+        MatchBatch(int srcType, int method);
+
+        void setTemplates(const std::vector<GpuMat>& templs, Stream& stream = Stream::Null());
+        void match(InputArray image, std::vector<GpuMat>& results, Stream& stream = Stream::Null());
+
+    private:
+        // the way the correlation part of a method is computed for a template
+        enum Correlation
+        {
+            NAIVE_SQDIFF,
+            NAIVE_CCORR_8U,
+            NAIVE_CCORR_32F,
+            FFT_CCORR
+        };
+
+        struct Template
+        {
+            GpuMat templ;
+            GpuMat templf;
+            GpuMat spectrum;
+            Correlation corr;
+            Scalar sum;
+            Scalar sqsum;
+        };
+
+        void prepareSpectra(Size dftSize, Stream& stream);
+        void correlate(const GpuMat& image, const Template& t, GpuMat& result, Stream& stream);
+
+        int srcType_;
+        int method_;
+
+        std::vector<Template> templs_;
+
+        GpuMat imagef_;
+        std::vector<GpuMat> images_;
+        std::vector<GpuMat> image_sums_;
+        std::vector<GpuMat> image_sqsums_;
+
+        Size dftSize_;
+        Ptr<cuda::DFT> dft_;
+        Ptr<cuda::DFT> idft_;
+        GpuMat padded_;
+        GpuMat imageSpectrum_;
+        GpuMat product_;
+        GpuMat corr_;
+        GpuMat corrCn_;
+    };
+
+    MatchBatch::MatchBatch(int srcType, int method) : srcType_(srcType), method_(method)
+    {
+        const int depth = CV_MAT_DEPTH(srcType);
+
+        CV_Assert( depth == CV_8U || depth == CV_32F );
+        CV_Assert( CV_MAT_CN(srcType) <= 4 );
+
+        if (depth == CV_32F && method != TM_SQDIFF && method != TM_CCORR)
+            CV_Error( Error::StsBadFlag, "Unsopported method" );
+        if (method < TM_SQDIFF || method > TM_CCOEFF_NORMED)
+            CV_Error( Error::StsBadFlag, "Unsopported method" );
+    }
+
+    void MatchBatch::setTemplates(const std::vector<GpuMat>& templs, Stream& stream)
+    {
+        const int depth = CV_MAT_DEPTH(srcType_);
+
+        templs_.resize(templs.size());
+        std::vector<HostMem> sums(templs.size()), sqsums(templs.size());
+
+        for (size_t i = 0; i < templs.size(); ++i)
+        {
+            Template& t = templs_[i];
+
+            CV_Assert( templs[i].type() == srcType_ && !templs[i].empty() );
+            templs[i].copyTo(t.templ, stream);
+            t.spectrum.release();
+
+            const int area = t.templ.size().area();
+
+            if (depth == CV_32F)
+            {
+                if (method_ == TM_SQDIFF)
+                    t.corr = NAIVE_SQDIFF;
+                else
+                    t.corr = area < getTemplateThreshold(TM_CCORR, CV_32F) ? NAIVE_CCORR_32F : FFT_CCORR;
+            }
+            else if (method_ == TM_CCOEFF_NORMED)
+            {
+                t.corr = area < getTemplateThreshold(TM_CCORR, CV_32F) ? NAIVE_CCORR_32F : FFT_CCORR;
+            }
+            else if (method_ == TM_SQDIFF && area < getTemplateThreshold(TM_SQDIFF, CV_8U))
+            {
+                t.corr = NAIVE_SQDIFF;
+            }
+            else
+            {
+                t.corr = area < getTemplateThreshold(TM_CCORR, CV_8U) ? NAIVE_CCORR_8U : FFT_CCORR;
+            }
+
+            if (depth == CV_8U && (t.corr == NAIVE_CCORR_32F || t.corr == FFT_CCORR))
+                t.templ.convertTo(t.templf, CV_32F, stream);
+            else
+                t.templf = t.templ;
+
+            if (depth == CV_8U)
+            {
+                cuda::calcSum(t.templ, sums[i], noArray(), stream);
+                cuda::calcSqrSum(t.templ, sqsums[i], noArray(), stream);
+            }
+        }
+
+        // the spectra depend on the image size, they are computed by the first match
+        dftSize_ = Size();
+
+        if (depth != CV_8U)
+            return;
+
+        stream.waitForCompletion();
+
+        for (size_t i = 0; i < templs_.size(); ++i)
+        {
+            const int cn = sums[i].channels();
+            templs_[i].sum = Scalar::all(0);
+            templs_[i].sqsum = Scalar::all(0);
+            sums[i].createMatHeader().convertTo(Mat(1, 1, CV_64FC(cn), templs_[i].sum.val), CV_64F);
+            sqsums[i].createMatHeader().convertTo(Mat(1, 1, CV_64FC(cn), templs_[i].sqsum.val), CV_64F);
+        }
+    }
+
+    void MatchBatch::prepareSpectra(Size dftSize, Stream& stream)
+    {
+        if (dftSize == dftSize_)
+            return;
+
+        dft_ = cuda::createDFT(dftSize, 0);
+        idft_ = cuda::createDFT(dftSize, DFT_COMPLEX_INPUT | DFT_REAL_OUTPUT);
+
+        for (size_t i = 0; i < templs_.size(); ++i)
+        {
+            Template& t = templs_[i];
+
+            if (t.corr != FFT_CCORR)
+                continue;
+
+            // cuFFT needs continuous buffers
+            const GpuMat templ = t.templf.reshape(1);
+            createContinuous(dftSize, CV_32FC1, padded_);
+            cuda::copyMakeBorder(templ, padded_, 0, dftSize.height - templ.rows, 0, dftSize.width - templ.cols,
+                                 BORDER_CONSTANT, Scalar::all(0), stream);
+            dft_->compute(padded_, t.spectrum, stream);
+        }
+
+        dftSize_ = dftSize;
+    }
+
+    void MatchBatch::correlate(const GpuMat& image, const Template& t, GpuMat& result, Stream& stream)
+    {
+        using namespace cv::cuda::device::match_template;
+
+        cudaStream_t s = StreamAccessor::getStream(stream);
+        const int cn = image.channels();
+
+        switch (t.corr)
+        {
+        case NAIVE_SQDIFF:
+            if (image.depth() == CV_8U)
+                matchTemplateNaive_SQDIFF_8U(image, t.templ, result, cn, s);
+            else
+                matchTemplateNaive_SQDIFF_32F(image, t.templ, result, cn, s);
+            break;
+
+        case NAIVE_CCORR_8U:
+            matchTemplateNaive_CCORR_8U(image, t.templ, result, cn, s);
+            break;
+
+        case NAIVE_CCORR_32F:
+            matchTemplateNaive_CCORR_32F(imagef_, t.templf, result, cn, s);
+            break;
+
+        case FFT_CCORR:
+        {
+            // image (x) templ is the inverse transform of image_spectrum * conj(templ_spectrum),
+            // the image is handled as a single channel one of cn times the width
+            const Size size1(imagef_.cols * cn, imagef_.rows);
+            const Size tsize1(t.templf.cols * cn, t.templf.rows);
+
+            createContinuous(imageSpectrum_.size(), CV_32FC2, product_);
+            cuda::mulAndScaleSpectrums(imageSpectrum_, t.spectrum, product_, 0, 1.f / dftSize_.area(), true, stream);
+            idft_->compute(product_, corr_, stream);
+
+            const GpuMat valid = corr_(Rect(0, 0, size1.width - tsize1.width + 1, size1.height - tsize1.height + 1));
+            if (cn == 1)
+                valid.copyTo(result, stream);
+            else
+                extractFirstChannel_32F(valid, result, cn, s);
+            break;
+        }
+        }
+    }
+
+    void MatchBatch::match(InputArray _image, std::vector<GpuMat>& results, Stream& stream)
+    {
+        using namespace cv::cuda::device::match_template;
+
+        GpuMat image = _image.getGpuMat();
+
+        CV_Assert( image.type() == srcType_ );
+
+        const int cn = image.channels();
+        cudaStream_t s = StreamAccessor::getStream(stream);
+
+        bool needFloat = false;
+        bool needFFT = false;
+        for (size_t i = 0; i < templs_.size(); ++i)
+        {
+            CV_Assert( image.cols >= templs_[i].templ.cols && image.rows >= templs_[i].templ.rows );
+            needFloat = needFloat || templs_[i].corr == NAIVE_CCORR_32F || templs_[i].corr == FFT_CCORR;
+            needFFT = needFFT || templs_[i].corr == FFT_CCORR;
+        }
+
+        // everything that only depends on the image is computed here, once for all templates
+
+        if (image.depth() == CV_32F)
+            imagef_ = image;
+        else if (needFloat)
+            image.convertTo(imagef_, CV_32F, stream);
+
+        if (needFFT)
+        {
+            const GpuMat image1 = imagef_.reshape(1);
+            const Size dftSize(getOptimalDFTSize(image1.cols), getOptimalDFTSize(image1.rows));
+
+            prepareSpectra(dftSize, stream);
+
+            createContinuous(dftSize, CV_32FC1, padded_);
+            cuda::copyMakeBorder(image1, padded_, 0, dftSize.height - image1.rows, 0, dftSize.width - image1.cols,
+                                 BORDER_CONSTANT, Scalar::all(0), stream);
+            dft_->compute(padded_, imageSpectrum_, stream);
+        }
+
+        switch (method_)
+        {
+        case TM_SQDIFF:
+        case TM_SQDIFF_NORMED:
+        case TM_CCORR_NORMED:
+            if (image.depth() == CV_8U)
+            {
+                image_sqsums_.resize(1);
+                cuda::sqrIntegral(image.reshape(1), image_sqsums_[0], stream);
+            }
+            break;
+
+        case TM_CCOEFF:
+        case TM_CCOEFF_NORMED:
+            if (cn == 1)
+                images_.assign(1, image);
+            else
+                cuda::split(image, images_, stream);
+
+            image_sums_.resize(cn);
+            for (int c = 0; c < cn; ++c)
+                cuda::integral(images_[c], image_sums_[c], stream);
+
+            if (method_ == TM_CCOEFF_NORMED)
+            {
+                image_sqsums_.resize(cn);
+                for (int c = 0; c < cn; ++c)
+                    cuda::sqrIntegral(images_[c], image_sqsums_[c], stream);
+            }
+            break;
+        }
+
+        results.resize(templs_.size());
+
+        for (size_t i = 0; i < templs_.size(); ++i)
+        {
+            const Template& t = templs_[i];
+
+            results[i].create(image.rows - t.templ.rows + 1, image.cols - t.templ.cols + 1, CV_32FC1);
+            GpuMat& result = results[i];
+
+            correlate(image, t, result, stream);
+
+            if (image.depth() == CV_32F || t.corr == NAIVE_SQDIFF)
+                continue;
+
+            const int w = t.templ.cols;
+            const int h = t.templ.rows;
+            const double sqsum = t.sqsum[0] + t.sqsum[1] + t.sqsum[2] + t.sqsum[3];
+
+            switch (method_)
+            {
+            case TM_SQDIFF:
+                matchTemplatePrepared_SQDIFF_8U(w, h, image_sqsums_[0], sqsum, result, cn, s);
+                break;
+
+            case TM_SQDIFF_NORMED:
+                matchTemplatePrepared_SQDIFF_NORMED_8U(w, h, image_sqsums_[0], sqsum, result, cn, s);
+                break;
+
+            case TM_CCORR_NORMED:
+                normalize_8U(w, h, image_sqsums_[0], sqsum, result, cn, s);
+                break;
+
+            case TM_CCOEFF:
+                switch (cn)
+                {
+                case 1:
+                    matchTemplatePrepared_CCOFF_8U(w, h, image_sums_[0], (int)t.sum[0], result, s);
+                    break;
+                case 2:
+                    matchTemplatePrepared_CCOFF_8UC2(w, h, image_sums_[0], image_sums_[1],
+                                                     (int)t.sum[0], (int)t.sum[1], result, s);
+                    break;
+                case 3:
+                    matchTemplatePrepared_CCOFF_8UC3(w, h, image_sums_[0], image_sums_[1], image_sums_[2],
+                                                     (int)t.sum[0], (int)t.sum[1], (int)t.sum[2], result, s);
+                    break;
+                case 4:
+                    matchTemplatePrepared_CCOFF_8UC4(w, h, image_sums_[0], image_sums_[1], image_sums_[2], image_sums_[3],
+                                                     (int)t.sum[0], (int)t.sum[1], (int)t.sum[2], (int)t.sum[3], result, s);
+                    break;
+                default:
+                    CV_Error(Error::StsBadArg, "unsupported number of channels");
+                }
+                break;
+
+            case TM_CCOEFF_NORMED:
+                switch (cn)
+                {
+                case 1:
+                    matchTemplatePrepared_CCOFF_NORMED_8U(w, h, image_sums_[0], image_sqsums_[0],
+                                                          (int)t.sum[0], t.sqsum[0], result, s);
+                    break;
+                case 2:
+                    matchTemplatePrepared_CCOFF_NORMED_8UC2(w, h,
+                                                            image_sums_[0], image_sqsums_[0],
+                                                            image_sums_[1], image_sqsums_[1],
+                                                            (int)t.sum[0], t.sqsum[0],
+                                                            (int)t.sum[1], t.sqsum[1],
+                                                            result, s);
+                    break;
+                case 3:
+                    matchTemplatePrepared_CCOFF_NORMED_8UC3(w, h,
+                                                            image_sums_[0], image_sqsums_[0],
+                                                            image_sums_[1], image_sqsums_[1],
+                                                            image_sums_[2], image_sqsums_[2],
+                                                            (int)t.sum[0], t.sqsum[0],
+                                                            (int)t.sum[1], t.sqsum[1],
+                                                            (int)t.sum[2], t.sqsum[2],
+                                                            result, s);
+                    break;
+                case 4:
+                    matchTemplatePrepared_CCOFF_NORMED_8UC4(w, h,
+                                                            image_sums_[0], image_sqsums_[0],
+                                                            image_sums_[1], image_sqsums_[1],
+                                                            image_sums_[2], image_sqsums_[2],
+                                                            image_sums_[3], image_sqsums_[3],
+                                                            (int)t.sum[0], t.sqsum[0],
+                                                            (int)t.sum[1], t.sqsum[1],
+                                                            (int)t.sum[2], t.sqsum[2],
+                                                            (int)t.sum[3], t.sqsum[3],
+                                                            result, s);
+                    break;
+                default:
+                    CV_Error(Error::StsBadArg, "unsupported number of channels");
+                }
+                break;
+            }
+        }
+    }
 }
 
 Ptr<cuda::TemplateMatching> cv::cuda::createTemplateMatching(int srcType, int method, Size user_block_size)
@@ -641,4 +1020,9 @@ Ptr<cuda::TemplateMatching> cv::cuda::createTemplateMatching(int srcType, int me
     }
 }
 
+Ptr<cuda::TemplateMatchingBatch> cv::cuda::createTemplateMatchingBatch(int srcType, int method)
+{
+    return makePtr<MatchBatch>(srcType, method);
+}
+
 #endif
@@ -59,6 +59,10 @@
 #  include "opencv2/cudafilters.hpp"
 #endif
 
+#ifdef HAVE_OPENCV_CUDEV
+#  include "opencv2/cudev/util/stream_allocator.hpp"
+#endif
+
 #include <limits>
 #include <algorithm>
 
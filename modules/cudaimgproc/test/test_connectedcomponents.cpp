@@ -0,0 +1,121 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+#ifdef HAVE_CUDA
+
+namespace opencv_test { namespace {
+
+////////////////////////////////////////////////////////////////////////////
+// ConnectedComponents
+
+PARAM_TEST_CASE(ConnectedComponents, cv::cuda::DeviceInfo, cv::Size, int)
+{
+    cv::cuda::DeviceInfo devInfo;
+    cv::Size size;
+    int connectivity;
+
+    cv::Mat image;
+
+    virtual void SetUp()
+    {
+        devInfo = GET_PARAM(0);
+        size = GET_PARAM(1);
+        connectivity = GET_PARAM(2);
+
+        cv::cuda::setDevice(devInfo.deviceID());
+
+        // sparse noise gives many small components, the circles give large ones across the tiles
+        image = randomMat(size, CV_8UC1, 0, 256) > 200;
+        cv::circle(image, cv::Point(size.width / 3, size.height / 2), std::min(size.width, size.height) / 4, cv::Scalar::all(255), -1);
+        cv::circle(image, cv::Point(2 * size.width / 3, size.height / 3), std::min(size.width, size.height) / 6, cv::Scalar::all(0), 3);
+    }
+};
+
+// the labels of both implementations must be the same up to a permutation
+static void checkSameComponents(const cv::Mat& labels, const cv::Mat& labels_gold, int nlabels, std::vector<int>& gold_to_gpu)
+{
+    gold_to_gpu.assign(nlabels, -1);
+    std::vector<int> gpu_to_gold(nlabels, -1);
+
+    for (int y = 0; y < labels.rows; ++y)
+    {
+        for (int x = 0; x < labels.cols; ++x)
+        {
+            const int l = labels.at<int>(y, x);
+            const int l_gold = labels_gold.at<int>(y, x);
+
+            ASSERT_TRUE(l >= 0 && l < nlabels);
+            ASSERT_EQ(l == 0, l_gold == 0);
+
+            if (gold_to_gpu[l_gold] < 0)
+                gold_to_gpu[l_gold] = l;
+            if (gpu_to_gold[l] < 0)
+                gpu_to_gold[l] = l_gold;
+
+            ASSERT_EQ(gold_to_gpu[l_gold], l);
+            ASSERT_EQ(gpu_to_gold[l], l_gold);
+        }
+    }
+}
+
+CUDA_TEST_P(ConnectedComponents, Labels)
+{
+    cv::cuda::Stream stream;
+
+    cv::cuda::GpuMat d_labels;
+    cv::cuda::connectedComponents(loadMat(image), d_labels, connectivity, CV_32S, stream);
+
+    stream.waitForCompletion();
+
+    cv::Mat labels_gold;
+    const int nlabels = cv::connectedComponents(image, labels_gold, connectivity, CV_32S);
+
+    cv::Mat labels(d_labels);
+
+    double maxLabel;
+    cv::minMaxLoc(labels, 0, &maxLabel);
+    ASSERT_EQ(nlabels - 1, (int)maxLabel);
+
+    std::vector<int> gold_to_gpu;
+    checkSameComponents(labels, labels_gold, nlabels, gold_to_gpu);
+}
+
+CUDA_TEST_P(ConnectedComponents, Stats)
+{
+    cv::cuda::GpuMat d_labels, d_stats, d_centroids;
+    const int nlabels = cv::cuda::connectedComponentsWithStats(loadMat(image), d_labels, d_stats, d_centroids, connectivity);
+
+    cv::Mat labels_gold, stats_gold, centroids_gold;
+    const int nlabels_gold = cv::connectedComponentsWithStats(image, labels_gold, stats_gold, centroids_gold, connectivity, CV_32S);
+
+    ASSERT_EQ(nlabels_gold, nlabels);
+
+    std::vector<int> gold_to_gpu;
+    checkSameComponents(cv::Mat(d_labels), labels_gold, nlabels, gold_to_gpu);
+
+    const cv::Mat stats(d_stats), centroids(d_centroids);
+
+    for (int i = 0; i < nlabels; ++i)
+    {
+        const int j = gold_to_gpu[i];
+        if (j < 0)
+            continue;
+
+        for (int k = 0; k < cv::CC_STAT_MAX; ++k)
+            EXPECT_EQ(stats_gold.at<int>(i, k), stats.at<int>(j, k));
+
+        EXPECT_NEAR(centroids_gold.at<double>(i, 0), centroids.at<double>(j, 0), 1e-6);
+        EXPECT_NEAR(centroids_gold.at<double>(i, 1), centroids.at<double>(j, 1), 1e-6);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_ImgProc, ConnectedComponents, testing::Combine(
+    ALL_DEVICES,
+    DIFFERENT_SIZES,
+    testing::Values(4, 8)));
+
+}} // namespace
+#endif // HAVE_CUDA
@@ -357,6 +357,94 @@ INSTANTIATE_TEST_CASE_P(CUDA_ImgProc, CLAHE, testing::Combine(
     testing::Values(0.0, 5.0, 10.0, 20.0, 40.0),
     testing::Values(MatType(CV_8UC1), MatType(CV_16UC1))));
 
+PARAM_TEST_CASE(CLAHE_Color, cv::cuda::DeviceInfo, cv::Size, ClipLimit, Channels)
+{
+    cv::cuda::DeviceInfo devInfo;
+    cv::Size size;
+    double clipLimit;
+    int channels;
+
+    virtual void SetUp()
+    {
+        devInfo = GET_PARAM(0);
+        size = GET_PARAM(1);
+        clipLimit = GET_PARAM(2);
+        channels = GET_PARAM(3);
+
+        cv::cuda::setDevice(devInfo.deviceID());
+    }
+
+    // equalizes the luma and adds its change to the color channels
+    void claheGold(const cv::Mat& src, cv::Mat& dst)
+    {
+        cv::Mat bgr = src, ycrcb, luma, luma_eq;
+        if (src.channels() == 4)
+            cv::cvtColor(src, bgr, cv::COLOR_BGRA2BGR);
+        cv::cvtColor(bgr, ycrcb, cv::COLOR_BGR2YCrCb);
+        cv::extractChannel(ycrcb, luma, 0);
+
+        cv::Ptr<cv::CLAHE> clahe_gold = cv::createCLAHE(clipLimit);
+        clahe_gold->apply(luma, luma_eq);
+
+        dst.create(src.size(), src.type());
+        for (int y = 0; y < src.rows; ++y)
+        {
+            for (int x = 0; x < src.cols; ++x)
+            {
+                const int delta = luma_eq.at<uchar>(y, x) - luma.at<uchar>(y, x);
+                for (int c = 0; c < 3; ++c)
+                    dst.ptr(y)[x * src.channels() + c] = cv::saturate_cast<uchar>(src.ptr(y)[x * src.channels() + c] + delta);
+                if (src.channels() == 4)
+                    dst.ptr(y)[x * 4 + 3] = src.ptr(y)[x * 4 + 3];
+            }
+        }
+    }
+};
+
+CUDA_TEST_P(CLAHE_Color, Accuracy)
+{
+    cv::Mat src = randomMat(size, CV_MAKE_TYPE(CV_8U, channels));
+
+    cv::Ptr<cv::cuda::CLAHE> clahe = cv::cuda::createCLAHE(clipLimit);
+    cv::cuda::GpuMat dst;
+    clahe->apply(loadMat(src), dst);
+
+    cv::Mat dst_gold;
+    claheGold(src, dst_gold);
+
+    ASSERT_MAT_NEAR(dst_gold, dst, 1.0);
+}
+
+CUDA_TEST_P(CLAHE_Color, Batch)
+{
+    std::vector<cv::Mat> src(3);
+    std::vector<cv::cuda::GpuMat> d_src(src.size());
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = randomMat(size, CV_MAKE_TYPE(CV_8U, channels));
+        d_src[i] = loadMat(src[i]);
+    }
+
+    cv::Ptr<cv::cuda::CLAHE> clahe = cv::cuda::createCLAHE(clipLimit);
+    std::vector<cv::cuda::GpuMat> dst;
+    clahe->applyBatch(d_src, dst);
+
+    ASSERT_EQ(src.size(), dst.size());
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        cv::Mat dst_gold;
+        claheGold(src[i], dst_gold);
+
+        ASSERT_MAT_NEAR(dst_gold, dst[i], 1.0);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_ImgProc, CLAHE_Color, testing::Combine(
+    ALL_DEVICES,
+    DIFFERENT_SIZES,
+    testing::Values(0.0, 10.0, 40.0),
+    testing::Values(Channels(3), Channels(4))));
+
 
 }} // namespace
 #endif // HAVE_CUDA
@@ -108,6 +108,46 @@ CUDA_TEST_P(HoughLines, Accuracy)
     ASSERT_MAT_NEAR(src, dst, 0.0);
 }
 
+CUDA_TEST_P(HoughLines, DeviceCount)
+{
+    const cv::cuda::DeviceInfo devInfo = GET_PARAM(0);
+    cv::cuda::setDevice(devInfo.deviceID());
+    const cv::Size size = GET_PARAM(1);
+    const bool useRoi = GET_PARAM(2);
+
+    const float rho = 1.0f;
+    const float theta = (float) (1.5 * CV_PI / 180.0);
+    const int threshold = 100;
+
+    cv::Mat src(size, CV_8UC1);
+    generateLines(src);
+
+    cv::Ptr<cv::cuda::HoughLinesDetector> hough = cv::cuda::createHoughLinesDetector(rho, theta, threshold, true);
+
+    cv::cuda::Stream stream;
+    cv::cuda::GpuMat d_lines, d_count;
+    hough->detect(loadMat(src, useRoi), d_lines, d_count, stream);
+
+    cv::cuda::GpuMat d_lines_gold;
+    hough->detect(loadMat(src, useRoi), d_lines_gold);
+
+    stream.waitForCompletion();
+
+    int count = 0;
+    d_count.download(cv::Mat(1, 1, CV_32SC1, &count));
+
+    ASSERT_EQ(hough->getMaxLines(), d_lines.cols);
+    ASSERT_EQ(d_lines_gold.cols, count);
+
+    std::vector<cv::Vec2f> lines;
+    hough->downloadResults(d_lines.colRange(0, count), lines);
+
+    cv::Mat dst(size, CV_8UC1);
+    drawLines(dst, lines);
+
+    ASSERT_MAT_NEAR(src, dst, 0.0);
+}
+
 INSTANTIATE_TEST_CASE_P(CUDA_ImgProc, HoughLines, testing::Combine(
     ALL_DEVICES,
     DIFFERENT_SIZES,
@@ -252,6 +292,75 @@ CUDA_TEST_P(GeneralizedHough, Ballard)
     }
 }
 
+CUDA_TEST_P(GeneralizedHough, BallardBatch)
+{
+    const cv::cuda::DeviceInfo devInfo = GET_PARAM(0);
+    cv::cuda::setDevice(devInfo.deviceID());
+    const bool useRoi = GET_PARAM(1);
+
+    cv::Mat templ = readImage("../cv/shared/templ.png", cv::IMREAD_GRAYSCALE);
+    ASSERT_FALSE(templ.empty());
+
+    cv::Point templCenter(templ.cols / 2, templ.rows / 2);
+
+    const size_t gold_count = 3;
+    cv::Point pos_gold[gold_count];
+    pos_gold[0] = cv::Point(templCenter.x + 10, templCenter.y + 10);
+    pos_gold[1] = cv::Point(2 * templCenter.x + 40, templCenter.y + 10);
+    pos_gold[2] = cv::Point(2 * templCenter.x + 40, 2 * templCenter.y + 40);
+
+    cv::Mat image(templ.rows * 3, templ.cols * 3, CV_8UC1, cv::Scalar::all(0));
+    for (size_t i = 0; i < gold_count; ++i)
+    {
+        cv::Rect rec(pos_gold[i].x - templCenter.x, pos_gold[i].y - templCenter.y, templ.cols, templ.rows);
+        cv::Mat imageROI = image(rec);
+        templ.copyTo(imageROI);
+    }
+
+    // the same shape registered twice must be detected once per template
+    const int templ_count = 2;
+    std::vector<cv::cuda::GpuMat> templs(templ_count, loadMat(templ, useRoi));
+
+    cv::Ptr<cv::cuda::GeneralizedHoughBallardBatch> alg = cv::cuda::createGeneralizedHoughBallardBatch();
+    alg->setVotesThreshold(200);
+
+    alg->setTemplates(templs);
+
+    cv::cuda::GpuMat d_pos, d_ids;
+    alg->detectAll(loadMat(image, useRoi), d_pos, cv::noArray(), d_ids);
+
+    std::vector<cv::Vec4f> pos;
+    d_pos.download(pos);
+    std::vector<int> ids;
+    d_ids.download(ids);
+
+    ASSERT_EQ(gold_count * templ_count, pos.size());
+    ASSERT_EQ(pos.size(), ids.size());
+
+    for (int id = 0; id < templ_count; ++id)
+    {
+        for (size_t i = 0; i < gold_count; ++i)
+        {
+            cv::Point gold = pos_gold[i];
+
+            bool found = false;
+
+            for (size_t j = 0; j < pos.size(); ++j)
+            {
+                cv::Point2f p(pos[j][0], pos[j][1]);
+
+                if (ids[j] == id && ::fabs(p.x - gold.x) < 2 && ::fabs(p.y - gold.y) < 2)
+                {
+                    found = true;
+                    break;
+                }
+            }
+
+            ASSERT_TRUE(found) << "template " << id;
+        }
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(CUDA_ImgProc, GeneralizedHough, testing::Combine(
     ALL_DEVICES,
     WHOLE_SUBMAT));
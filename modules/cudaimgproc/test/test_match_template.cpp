@@ -111,6 +111,60 @@ INSTANTIATE_TEST_CASE_P(CUDA_ImgProc, MatchTemplate8U, testing::Combine(
     testing::Values(Channels(1), Channels(3), Channels(4)),
     ALL_TEMPLATE_METHODS));
 
+////////////////////////////////////////////////////////////////////////////////
+// MatchTemplateBatch
+
+PARAM_TEST_CASE(MatchTemplateBatch, cv::cuda::DeviceInfo, cv::Size, Channels, TemplateMethod)
+{
+    cv::cuda::DeviceInfo devInfo;
+    cv::Size size;
+    int cn;
+    int method;
+
+    virtual void SetUp()
+    {
+        devInfo = GET_PARAM(0);
+        size = GET_PARAM(1);
+        cn = GET_PARAM(2);
+        method = GET_PARAM(3);
+
+        cv::cuda::setDevice(devInfo.deviceID());
+    }
+};
+
+CUDA_TEST_P(MatchTemplateBatch, Accuracy)
+{
+    cv::Mat image = randomMat(size, CV_MAKETYPE(CV_8U, cn));
+
+    const cv::Size templ_sizes[] = {cv::Size(5, 5), cv::Size(16, 16), cv::Size(30, 30), cv::Size(48, 24)};
+    std::vector<cv::cuda::GpuMat> templs;
+    for (size_t i = 0; i < sizeof(templ_sizes) / sizeof(templ_sizes[0]); ++i)
+        templs.push_back(loadMat(randomMat(templ_sizes[i], CV_MAKETYPE(CV_8U, cn))));
+
+    cv::Ptr<cv::cuda::TemplateMatchingBatch> batch = cv::cuda::createTemplateMatchingBatch(image.type(), method);
+    batch->setTemplates(templs);
+
+    cv::cuda::GpuMat d_image = loadMat(image);
+    std::vector<cv::cuda::GpuMat> results;
+    batch->match(d_image, results);
+    ASSERT_EQ(templs.size(), results.size());
+
+    cv::Ptr<cv::cuda::TemplateMatching> alg = cv::cuda::createTemplateMatching(image.type(), method);
+    for (size_t i = 0; i < templs.size(); ++i)
+    {
+        cv::cuda::GpuMat dst_gold;
+        alg->match(d_image, templs[i], dst_gold);
+
+        EXPECT_MAT_NEAR(dst_gold, results[i], method == cv::TM_SQDIFF || method == cv::TM_CCORR || method == cv::TM_CCOEFF ? templs[i].size().area() * 1e-1 : 1e-3);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_ImgProc, MatchTemplateBatch, testing::Combine(
+    ALL_DEVICES,
+    DIFFERENT_SIZES,
+    testing::Values(Channels(1), Channels(3), Channels(4)),
+    ALL_TEMPLATE_METHODS));
+
 ////////////////////////////////////////////////////////////////////////////////
 // MatchTemplate32F
 
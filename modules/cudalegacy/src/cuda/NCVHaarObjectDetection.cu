@@ -172,7 +172,35 @@ __device__ Ncv32u d_outMaskPosition;
 
 __device__ void compactBlockWriteOutAnchorParallel(Ncv32u threadPassFlag, Ncv32u threadElem, Ncv32u *vectorOut)
 {
-#if __CUDA_ARCH__ && __CUDA_ARCH__ >= 110
+#if __CUDA_ARCH__ && __CUDA_ARCH__ >= 300
+
+    //every warp compacts its passed elements with a ballot and reserves their output range with a
+    //single atomic, so that no shared memory nor block barrier is needed. All the threads of the
+    //block get here, the inactive ones with a zero flag
+    const Ncv32u laneId = threadIdx.x & 31;
+#if __CUDACC_VER_MAJOR__ >= 9
+    const Ncv32u warpPassMask = __ballot_sync(0xFFFFFFFFu, threadPassFlag);
+#else
+    const Ncv32u warpPassMask = __ballot(threadPassFlag);
+#endif
+
+    Ncv32u warpOffset = 0;
+    if (laneId == 0 && warpPassMask != 0)
+    {
+        warpOffset = atomicAdd(&d_outMaskPosition, __popc(warpPassMask));
+    }
+#if __CUDACC_VER_MAJOR__ >= 9
+    warpOffset = __shfl_sync(0xFFFFFFFFu, warpOffset, 0);
+#else
+    warpOffset = __shfl(warpOffset, 0);
+#endif
+
+    if (threadPassFlag)
+    {
+        vectorOut[warpOffset + __popc(warpPassMask & ((1u << laneId) - 1))] = threadElem;
+    }
+
+#elif __CUDA_ARCH__ && __CUDA_ARCH__ >= 110
 
     __shared__ Ncv32u shmem[NUM_THREADS_ANCHORSPARALLEL];
     __shared__ Ncv32u numPassed;
@@ -990,6 +1018,9 @@ NCVStatus ncvApplyHaarClassifierCascade_device(NCVMatrix<Ncv32u> &integral,
     Ncv32u *hp_zero = &hp_pool32u.ptr()[0];
     Ncv32u *hp_numDet = &hp_pool32u.ptr()[1];
 
+    //the kernels and the copies of the counter are ordered by the stream and *hp_zero never changes,
+    //so the host only waits for the counter of detections before sizing the next grid
+
     NCV_SKIP_COND_BEGIN
     *hp_zero = 0;
     *hp_numDet = 0;
@@ -1074,7 +1105,6 @@ NCVStatus ncvApplyHaarClassifierCascade_device(NCVMatrix<Ncv32u> &integral,
         {
             ncvAssertCUDAReturn(cudaMemcpyToSymbolAsync(d_outMaskPosition, hp_zero, sizeof(Ncv32u),
                                                         0, cudaMemcpyHostToDevice, cuStream), NCV_CUDA_ERROR);
-            ncvAssertCUDAReturn(cudaStreamSynchronize(cuStream), NCV_CUDA_ERROR);
         }
 
         dim3 gridInit((((anchorsRoi.width + pixelStep - 1) / pixelStep + NUM_THREADS_ANCHORSPARALLEL - 1) / NUM_THREADS_ANCHORSPARALLEL),
@@ -1098,7 +1128,6 @@ NCVStatus ncvApplyHaarClassifierCascade_device(NCVMatrix<Ncv32u> &integral,
 
         if (bDoAtomicCompaction)
         {
-            ncvAssertCUDAReturn(cudaStreamSynchronize(cuStream), NCV_CUDA_ERROR);
             ncvAssertCUDAReturn(cudaMemcpyFromSymbolAsync(hp_numDet, d_outMaskPosition, sizeof(Ncv32u),
                                                           0, cudaMemcpyDeviceToHost, cuStream), NCV_CUDA_ERROR);
             ncvAssertCUDAReturn(cudaStreamSynchronize(cuStream), NCV_CUDA_ERROR);
@@ -1124,7 +1153,6 @@ NCVStatus ncvApplyHaarClassifierCascade_device(NCVMatrix<Ncv32u> &integral,
         {
             ncvAssertCUDAReturn(cudaMemcpyToSymbolAsync(d_outMaskPosition, hp_zero, sizeof(Ncv32u),
                                                         0, cudaMemcpyHostToDevice, cuStream), NCV_CUDA_ERROR);
-            ncvAssertCUDAReturn(cudaStreamSynchronize(cuStream), NCV_CUDA_ERROR);
         }
 
         dim3 grid1(((d_pixelMask.stride() + NUM_THREADS_ANCHORSPARALLEL - 1) / NUM_THREADS_ANCHORSPARALLEL),
@@ -1154,7 +1182,6 @@ NCVStatus ncvApplyHaarClassifierCascade_device(NCVMatrix<Ncv32u> &integral,
 
         if (bDoAtomicCompaction)
         {
-            ncvAssertCUDAReturn(cudaStreamSynchronize(cuStream), NCV_CUDA_ERROR);
             ncvAssertCUDAReturn(cudaMemcpyFromSymbolAsync(hp_numDet, d_outMaskPosition, sizeof(Ncv32u),
                                                           0, cudaMemcpyDeviceToHost, cuStream), NCV_CUDA_ERROR);
             ncvAssertCUDAReturn(cudaStreamSynchronize(cuStream), NCV_CUDA_ERROR);
@@ -1189,7 +1216,6 @@ NCVStatus ncvApplyHaarClassifierCascade_device(NCVMatrix<Ncv32u> &integral,
         {
             ncvAssertCUDAReturn(cudaMemcpyToSymbolAsync(d_outMaskPosition, hp_zero, sizeof(Ncv32u),
                                                         0, cudaMemcpyHostToDevice, cuStream), NCV_CUDA_ERROR);
-            ncvAssertCUDAReturn(cudaStreamSynchronize(cuStream), NCV_CUDA_ERROR);
         }
 
         dim3 grid2((numDetections + NUM_THREADS_ANCHORSPARALLEL - 1) / NUM_THREADS_ANCHORSPARALLEL);
@@ -1224,7 +1250,6 @@ NCVStatus ncvApplyHaarClassifierCascade_device(NCVMatrix<Ncv32u> &integral,
 
         if (bDoAtomicCompaction)
         {
-            ncvAssertCUDAReturn(cudaStreamSynchronize(cuStream), NCV_CUDA_ERROR);
             ncvAssertCUDAReturn(cudaMemcpyFromSymbolAsync(hp_numDet, d_outMaskPosition, sizeof(Ncv32u),
                                                           0, cudaMemcpyDeviceToHost, cuStream), NCV_CUDA_ERROR);
             ncvAssertCUDAReturn(cudaStreamSynchronize(cuStream), NCV_CUDA_ERROR);
@@ -1252,7 +1277,6 @@ NCVStatus ncvApplyHaarClassifierCascade_device(NCVMatrix<Ncv32u> &integral,
         {
             ncvAssertCUDAReturn(cudaMemcpyToSymbolAsync(d_outMaskPosition, hp_zero, sizeof(Ncv32u),
                                                         0, cudaMemcpyHostToDevice, cuStream), NCV_CUDA_ERROR);
-            ncvAssertCUDAReturn(cudaStreamSynchronize(cuStream), NCV_CUDA_ERROR);
         }
 
         dim3 grid3(numDetections);
@@ -1285,7 +1309,6 @@ NCVStatus ncvApplyHaarClassifierCascade_device(NCVMatrix<Ncv32u> &integral,
 
         if (bDoAtomicCompaction)
         {
-            ncvAssertCUDAReturn(cudaStreamSynchronize(cuStream), NCV_CUDA_ERROR);
             ncvAssertCUDAReturn(cudaMemcpyFromSymbolAsync(hp_numDet, d_outMaskPosition, sizeof(Ncv32u),
                                                           0, cudaMemcpyDeviceToHost, cuStream), NCV_CUDA_ERROR);
             ncvAssertCUDAReturn(cudaStreamSynchronize(cuStream), NCV_CUDA_ERROR);
@@ -2035,16 +2058,16 @@ static NCVStatus loadFromXML(const cv::String &filename,
                       std::vector<HaarClassifierNode128> &haarClassifierNodes,
                       std::vector<HaarFeature64> &haarFeatures)
 {
-    const char *CUDA_CC_SIZE = "size";
-    const char *CUDA_CC_STAGES = "stages";
-    const char *CUDA_CC_STAGE_THRESHOLD = "stage_threshold";
-    const char *CUDA_CC_TREES = "trees";
-    const char *CUDA_CC_FEATURE = "feature";
-    const char *CUDA_CC_RECT = "rects";
-    const char *CUDA_CC_TILTED = "tilted";
-    const char *CUDA_CC_THRESHOLD = "threshold";
+    const char *CUDA_CC_SIZE = "size";
+    const char *CUDA_CC_STAGES = "stages";
+    const char *CUDA_CC_STAGE_THRESHOLD = "stage_threshold";
+    const char *CUDA_CC_TREES = "trees";
+    const char *CUDA_CC_FEATURE = "feature";
+    const char *CUDA_CC_RECT = "rects";
+    const char *CUDA_CC_TILTED = "tilted";
+    const char *CUDA_CC_THRESHOLD = "threshold";
     const char *CUDA_CC_LEFT_VAL = "left_val";
-    const char *CUDA_CC_RIGHT_VAL = "right_val";
+    const char *CUDA_CC_RIGHT_VAL = "right_val";
     const char *CUDA_CC_LEFT_NODE = "left_node";
     const char *CUDA_CC_RIGHT_NODE = "right_node";
 
@@ -2065,12 +2088,12 @@ static NCVStatus loadFromXML(const cv::String &filename,
     haarClassifierNodes.resize(0);
     haarFeatures.resize(0);
 
-    cv::FileStorage fs(filename, cv::FileStorage::READ | cv::FileStorage::FORMAT_XML);
-
-    if (!fs.isOpened())
+    cv::FileStorage fs(filename, cv::FileStorage::READ | cv::FileStorage::FORMAT_XML);
+
+    if (!fs.isOpened())
         return NCV_FILE_ERROR;
 
-    const cv::FileNode &root = fs.getFirstTopLevelNode();
+    const cv::FileNode &root = fs.getFirstTopLevelNode();
     const cv::FileNode &fnSize = root[CUDA_CC_SIZE];
 
     // collect the cascade classifier window size
@@ -2078,47 +2101,47 @@ static NCVStatus loadFromXML(const cv::String &filename,
     haar.ClassifierSize.height = (int)fnSize[CUDA_CC_SIZE_H];
     CV_Assert(haar.ClassifierSize.height > 0 && haar.ClassifierSize.width > 0);
 
-    const cv::FileNode &fnStages = root[CUDA_CC_STAGES];
+    const cv::FileNode &fnStages = root[CUDA_CC_STAGES];
     cv::FileNodeIterator it = fnStages.begin(), it_end = fnStages.end();
 
-    for (; it != it_end; ++it) // by stages
-    {
-        cv::FileNode fnStage = *it;
+    for (; it != it_end; ++it) // by stages
+    {
+        cv::FileNode fnStage = *it;
         HaarStage64 curStage;
 
-        curStage.setStartClassifierRootNodeOffset(static_cast<Ncv32u>(haarClassifierNodes.size()));
+        curStage.setStartClassifierRootNodeOffset(static_cast<Ncv32u>(haarClassifierNodes.size()));
         curStage.setStageThreshold((float)fnStage[CUDA_CC_STAGE_THRESHOLD]);
 
-        // iterate over the trees
-        const cv::FileNode &fnTrees = fnStage[CUDA_CC_TREES];
-        cv::FileNodeIterator it1 = fnTrees.begin(), it1_end = fnTrees.end();
-
-        for (; it1 != it1_end; ++it1) // by trees
-        {
-            cv::FileNode tree = *it1;
-            Ncv32u nodeId = (size_t)0;
-            HaarClassifierNode128 curNode;
-
-            curNode.setThreshold((float)tree[0][CUDA_CC_THRESHOLD]);
-
-            NcvBool bIsLeftNodeLeaf = false;
-            NcvBool bIsRightNodeLeaf = false;
-
+        // iterate over the trees
+        const cv::FileNode &fnTrees = fnStage[CUDA_CC_TREES];
+        cv::FileNodeIterator it1 = fnTrees.begin(), it1_end = fnTrees.end();
+
+        for (; it1 != it1_end; ++it1) // by trees
+        {
+            cv::FileNode tree = *it1;
+            Ncv32u nodeId = (size_t)0;
+            HaarClassifierNode128 curNode;
+
+            curNode.setThreshold((float)tree[0][CUDA_CC_THRESHOLD]);
+
+            NcvBool bIsLeftNodeLeaf = false;
+            NcvBool bIsRightNodeLeaf = false;
+
             HaarClassifierNodeDescriptor32 nodeLeft;
 
             cv::FileNode leftNode = tree[0][CUDA_CC_LEFT_NODE];
 
             if (leftNode.fs == NULL)
             {
-                Ncv32f leftVal = tree[0][CUDA_CC_LEFT_VAL];
-                ncvStat = nodeLeft.create(leftVal);
+                Ncv32f leftVal = tree[0][CUDA_CC_LEFT_VAL];
+                ncvStat = nodeLeft.create(leftVal);
                 ncvAssertReturn(ncvStat == NCV_SUCCESS, ncvStat);
                 bIsLeftNodeLeaf = true;
             }
             else
             {
-                Ncv32u leftNodeOffset = (int)tree[0][CUDA_CC_LEFT_NODE];
-                nodeLeft.create((Ncv32u)(h_TmpClassifierNotRootNodes.size() + leftNodeOffset - 1));
+                Ncv32u leftNodeOffset = (int)tree[0][CUDA_CC_LEFT_NODE];
+                nodeLeft.create((Ncv32u)(h_TmpClassifierNotRootNodes.size() + leftNodeOffset - 1));
                 haar.bHasStumpsOnly = false;
             }
 
@@ -2129,15 +2152,15 @@ static NCVStatus loadFromXML(const cv::String &filename,
 
             if (rightNode.fs == NULL)
             {
-                Ncv32f rightVal = tree[0][CUDA_CC_RIGHT_VAL];
-                ncvStat = nodeRight.create(rightVal);
+                Ncv32f rightVal = tree[0][CUDA_CC_RIGHT_VAL];
+                ncvStat = nodeRight.create(rightVal);
                 ncvAssertReturn(ncvStat == NCV_SUCCESS, ncvStat);
                 bIsRightNodeLeaf = true;
             }
             else
             {
-                Ncv32u rightNodeOffset = (int)tree[0][CUDA_CC_RIGHT_NODE];
-                nodeRight.create((Ncv32u)(h_TmpClassifierNotRootNodes.size() + rightNodeOffset - 1));
+                Ncv32u rightNodeOffset = (int)tree[0][CUDA_CC_RIGHT_NODE];
+                nodeRight.create((Ncv32u)(h_TmpClassifierNotRootNodes.size() + rightNodeOffset - 1));
                 haar.bHasStumpsOnly = false;
             }
 
@@ -2147,9 +2170,9 @@ static NCVStatus loadFromXML(const cv::String &filename,
             Ncv32u tiltedVal = (int)fnFeature[CUDA_CC_TILTED];
             haar.bNeedsTiltedII = (tiltedVal != 0);
 
-            cv::FileNodeIterator it2 = fnFeature[CUDA_CC_RECT].begin(), it2_end = fnFeature[CUDA_CC_RECT].end();
+            cv::FileNodeIterator it2 = fnFeature[CUDA_CC_RECT].begin(), it2_end = fnFeature[CUDA_CC_RECT].end();
 
-            Ncv32u featureId = 0;
+            Ncv32u featureId = 0;
             for (; it2 != it2_end; ++it2) // by feature
             {
                 cv::FileNode rect = *it2;
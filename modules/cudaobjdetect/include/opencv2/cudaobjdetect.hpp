@@ -136,6 +136,12 @@ public:
     CV_WRAP virtual void setDescriptorFormat(HOGDescriptor::DescriptorStorageFormat descr_format) = 0;
     CV_WRAP virtual HOGDescriptor::DescriptorStorageFormat getDescriptorFormat() const = 0;
 
+    //! Store the normalized block histograms used by detect and detectMultiScale in half precision.
+    //! It halves the memory traffic of the classification, the confidences may differ slightly
+    //! from the single precision ones. Disabled by default.
+    CV_WRAP virtual void setUseFP16Histograms(bool use_fp16) = 0;
+    CV_WRAP virtual bool getUseFP16Histograms() const = 0;
+
     /** @brief Returns the number of coefficients required for the classification.
      */
     CV_WRAP virtual size_t getDescriptorSize() const = 0;
@@ -204,6 +210,20 @@ public:
         detectMultiScale(img, found_locations, NULL);
     }
 
+    /** @brief Performs object detection with a multi-scale window on a batch of images.
+
+    The histograms of all pyramid levels of all images are computed first, then the windows of the whole
+    batch are classified in a single launch. The result is the same as with a detectMultiScale call per image.
+
+    @param imgs Source images. See cuda::HOGDescriptor::detect for type limitations, the images may have
+    different sizes.
+    @param found_locations Detected objects boundaries, one vector per image.
+    @param confidences Optional output array for confidences, one vector per image.
+     */
+    virtual void detectMultiScale(const std::vector<GpuMat>& imgs,
+                                  std::vector<std::vector<Rect> >& found_locations,
+                                  std::vector<std::vector<double> >* confidences = NULL) = 0;
+
     /** @brief Returns block descriptors computed for the whole image.
 
     @param img Source image. See cuda::HOGDescriptor::detect for type limitations.
@@ -299,6 +319,20 @@ public:
                                   OutputArray objects,
                                   Stream& stream = Stream::Null()) = 0;
 
+    /** @brief Detects objects of different sizes in a batch of images.
+
+    @param images Matrices of type CV_8U, the images may have different sizes.
+    @param objects Buffers to store detected objects, one per image. Use CascadeClassifier::convert to get
+    the rectangles of each image.
+    @param stream CUDA stream.
+
+    LBP cascades put the pyramid levels of all images into one integral buffer and evaluate the windows of
+    the whole batch in a single launch. HAAR cascades process the images one by one.
+     */
+    virtual void detectMultiScale(const std::vector<GpuMat>& images,
+                                  std::vector<GpuMat>& objects,
+                                  Stream& stream = Stream::Null()) = 0;
+
     /** @brief Converts objects array from internal representation to standard vector.
 
     @param gpu_objects Objects array in internal representation.
@@ -120,6 +120,10 @@ namespace
                                       OutputArray objects,
                                       Stream& stream);
 
+        virtual void detectMultiScale(const std::vector<GpuMat>& images,
+                                      std::vector<GpuMat>& objects,
+                                      Stream& stream);
+
         virtual void convert(OutputArray gpu_objects,
                              std::vector<Rect>& objects);
 
@@ -200,6 +204,15 @@ namespace
         }
     }
 
+    void HaarCascade_Impl::detectMultiScale(const std::vector<GpuMat>& images,
+                                            std::vector<GpuMat>& objects,
+                                            Stream& stream)
+    {
+        objects.resize(images.size());
+        for (size_t i = 0; i < images.size(); ++i)
+            detectMultiScale(images[i], objects[i], stream);
+    }
+
     void HaarCascade_Impl::convert(OutputArray _gpu_objects, std::vector<Rect>& objects)
     {
         if (_gpu_objects.empty())
@@ -392,6 +405,22 @@ namespace cv { namespace cuda { namespace device
                              unsigned int* classified,
                              PtrStepSzi integral);
 
+        void classifyPyramidBatch(int windowW,
+                                  int windowH,
+                                  const PtrStepSzi& levels,
+                                  const float* scales,
+                                  int total,
+                                  const PtrStepSzb& mstages,
+                                  const int nstages,
+                                  const PtrStepSzi& mnodes,
+                                  const PtrStepSzf& mleaves,
+                                  const PtrStepSzi& msubsets,
+                                  const PtrStepSzb& mfeatures,
+                                  const int subsetSize,
+                                  PtrStepSz<int4> objects,
+                                  unsigned int* classified,
+                                  PtrStepSzi integral);
+
         void connectedConmonents(PtrStepSz<int4> candidates,
                                  int ncandidates,
                                  PtrStepSz<int4> objects,
@@ -471,6 +500,10 @@ namespace
                                       OutputArray objects,
                                       Stream& stream);
 
+        virtual void detectMultiScale(const std::vector<GpuMat>& images,
+                                      std::vector<GpuMat>& objects,
+                                      Stream& stream);
+
         virtual void convert(OutputArray gpu_objects,
                              std::vector<Rect>& objects);
 
@@ -511,6 +544,9 @@ namespace
         GpuMat resuzeBuffer;
 
         GpuMat candidates;
+
+        GpuMat batchIntegral;
+        GpuMat batchCandidates;
         static const int integralFactor = 4;
     };
 
@@ -605,6 +641,138 @@ namespace
         }
     }
 
+    void LbpCascade_Impl::detectMultiScale(const std::vector<GpuMat>& images,
+                                           std::vector<GpuMat>& objects,
+                                           Stream& stream)
+    {
+        CV_Assert( scaleFactor_ > 1 );
+        CV_Assert( !stream );
+
+        const float grouping_eps = 0.2f;
+        const int nimages = static_cast<int>(images.size());
+
+        objects.assign(nimages, GpuMat());
+        if (nimages == 0)
+            return;
+
+        cv::Size maxSize;
+        for (int i = 0; i < nimages; ++i)
+        {
+            CV_Assert( images[i].depth() == CV_8U);
+            maxSize.width  = std::max(maxSize.width, images[i].cols);
+            maxSize.height = std::max(maxSize.height, images[i].rows);
+        }
+
+        allocateBuffers(maxSize);
+
+        // pack the integrals of all levels of all images in shelves of one buffer
+        struct BatchLevel
+        {
+            PyrLavel level;
+            cv::Rect roi;
+        };
+
+        const int integralWidth = integralFactor * (maxSize.width + 1);
+
+        std::vector<BatchLevel> batchLevels;
+        std::vector<int> levelsTable;
+        std::vector<float> scales;
+        int total = 0;
+        int shelfX = 0, shelfY = 0, shelfHeight = 0;
+        for (int i = 0; i < nimages; ++i)
+        {
+            const cv::Size frame = images[i].size();
+            const cv::Size maxObjectSize = maxObjectSize_ == cv::Size() ? frame : maxObjectSize_;
+
+            for (PyrLavel level(0, scaleFactor_, frame, NxM, minObjectSize_); level.isFeasible(maxObjectSize);
+                 level = level.next(scaleFactor_, frame, NxM, minObjectSize_))
+            {
+                const int step = (level.scale <= 2.f);
+                const int windowsForLine = level.workArea.width >> step;
+                const int windows = windowsForLine * (level.workArea.height >> step);
+                if (windows <= 0)
+                    continue;
+
+                const cv::Size isize = level.sFrame + 1;
+                if (shelfX + isize.width > integralWidth)
+                {
+                    shelfX = 0;
+                    shelfY += shelfHeight;
+                    shelfHeight = 0;
+                }
+
+                BatchLevel bl = { level, cv::Rect(shelfX, shelfY, isize.width, isize.height) };
+                batchLevels.push_back(bl);
+
+                levelsTable.push_back(i);
+                levelsTable.push_back(shelfX);
+                levelsTable.push_back(shelfY);
+                levelsTable.push_back(total);
+                levelsTable.push_back(windowsForLine);
+                levelsTable.push_back(step);
+                scales.push_back(level.scale);
+
+                total += windows;
+                shelfX += isize.width;
+                shelfHeight = std::max(shelfHeight, isize.height);
+            }
+        }
+
+        if (total == 0 || minNeighbors_ <= 0)
+            return;
+
+        cuda::ensureSizeIsEnough(shelfY + shelfHeight, integralWidth, CV_32SC1, batchIntegral);
+        cuda::ensureSizeIsEnough(nimages, maxSize.width >> 1, CV_32SC4, batchCandidates);
+
+        for (size_t j = 0; j < batchLevels.size(); ++j)
+        {
+            const BatchLevel& bl = batchLevels[j];
+
+            // create sutable matrix headers
+            GpuMat src  = resuzeBuffer(cv::Rect(0, 0, bl.level.sFrame.width, bl.level.sFrame.height));
+            GpuMat sint = batchIntegral(bl.roi);
+
+            // generate integral for scale
+            cuda::resize(images[levelsTable[j * 6]], src, bl.level.sFrame, 0, 0, cv::INTER_LINEAR);
+            cuda::integral(src, sint);
+        }
+
+        BufferPool pool(stream);
+
+        GpuMat dlevels = pool.getBuffer(static_cast<int>(batchLevels.size()), 6, CV_32SC1);
+        dlevels.upload(Mat(levelsTable).reshape(1, static_cast<int>(batchLevels.size())));
+
+        GpuMat dscales = pool.getBuffer(1, static_cast<int>(scales.size()), CV_32FC1);
+        dscales.upload(Mat(scales).reshape(1, 1));
+
+        GpuMat dclassified = pool.getBuffer(1, nimages, CV_32S);
+        dclassified.setTo(Scalar::all(0));
+
+        // evaluate the windows of the whole batch at once
+        device::lbp::classifyPyramidBatch(NxM.width - 1, NxM.height - 1, dlevels, dscales.ptr<float>(), total,
+            stage_mat, stage_mat.cols / sizeof(Stage), nodes_mat, leaves_mat, subsets_mat, features_mat, subsetSize,
+            batchCandidates.rowRange(0, nimages).colRange(0, maxSize.width >> 1), dclassified.ptr<unsigned int>(), batchIntegral);
+
+        std::vector<unsigned int> classified(nimages);
+        cudaSafeCall( cudaMemcpy(&classified[0], dclassified.ptr(), nimages * sizeof(unsigned int), cudaMemcpyDeviceToHost) );
+
+        GpuMat batchObjects = pool.getBuffer(nimages, maxNumObjects_, traits::Type<Rect>::value);
+        for (int i = 0; i < nimages; ++i)
+        {
+            device::lbp::connectedConmonents(batchCandidates.row(i), classified[i], batchObjects.row(i), minNeighbors_, grouping_eps,
+                                             dclassified.ptr<unsigned int>() + i);
+        }
+
+        cudaSafeCall( cudaMemcpy(&classified[0], dclassified.ptr(), nimages * sizeof(unsigned int), cudaMemcpyDeviceToHost) );
+        cudaSafeCall( cudaDeviceSynchronize() );
+
+        for (int i = 0; i < nimages; ++i)
+        {
+            if (classified[i] > 0)
+                batchObjects.row(i).colRange(0, classified[i]).copyTo(objects[i]);
+        }
+    }
+
     void LbpCascade_Impl::convert(OutputArray _gpu_objects, std::vector<Rect>& objects)
     {
         if (_gpu_objects.empty())
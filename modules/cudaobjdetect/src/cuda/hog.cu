@@ -46,6 +46,7 @@
 #include "opencv2/core/cuda/reduce.hpp"
 #include "opencv2/core/cuda/functional.hpp"
 #include "opencv2/core/cuda/warp_shuffle.hpp"
+#include <cuda_fp16.h>
 
 namespace cv { namespace cuda { namespace device
 {
@@ -314,18 +315,27 @@ namespace cv { namespace cuda { namespace device
         }
 
 
+        __device__ __forceinline__ float load_hist(const float* hist) { return *hist; }
+        __device__ __forceinline__ float load_hist(const __half* hist) { return __half2float(*hist); }
+
+        __device__ __forceinline__ void store_hist(float* hist, float val) { *hist = val; }
+        __device__ __forceinline__ void store_hist(__half* hist, float val) { *hist = __float2half_rn(val); }
+
         template <int nthreads, // Number of threads which process one block historgam
-                  int nblocks> // Number of block hisograms processed by one GPU thread block
+                  int nblocks, // Number of block hisograms processed by one GPU thread block
+                  typename T>
         __global__ void normalize_hists_kernel_many_blocks(const int block_hist_size,
                                                            const int img_block_width,
-                                                           float* block_hists, float threshold)
+                                                           float* block_hists, float threshold,
+                                                           T* dst_hists)
         {
             if (blockIdx.x * blockDim.z + threadIdx.z >= img_block_width)
                 return;
 
-            float* hist = block_hists + (blockIdx.y * img_block_width +
-                                         blockIdx.x * blockDim.z + threadIdx.z) *
-                                        block_hist_size + threadIdx.x;
+            const int offset = (blockIdx.y * img_block_width +
+                                blockIdx.x * blockDim.z + threadIdx.z) *
+                               block_hist_size + threadIdx.x;
+            float* hist = block_hists + offset;
 
             __shared__ float sh_squares[nthreads * nblocks];
             float* squares = sh_squares + threadIdx.z * nthreads;
@@ -346,18 +356,20 @@ namespace cv { namespace cuda { namespace device
             scale = 1.0f / (::sqrtf(sum) + 1e-3f);
 
             if (threadIdx.x < block_hist_size)
-                hist[0] = elem * scale;
+                store_hist(dst_hists + offset, elem * scale);
         }
 
 
-        void normalize_hists(int nbins,
-                             int block_stride_x, int block_stride_y,
-                             int height, int width,
-                             float* block_hists,
-                             float threshold,
-                             int cell_size_x, int cell_size_y,
-                             int ncells_block_x, int ncells_block_y,
-                             const cudaStream_t& stream)
+        template <typename T>
+        static void normalize_hists_caller(int nbins,
+                                           int block_stride_x, int block_stride_y,
+                                           int height, int width,
+                                           float* block_hists,
+                                           float threshold,
+                                           int cell_size_x, int cell_size_y,
+                                           int ncells_block_x, int ncells_block_y,
+                                           T* dst_hists,
+                                           const cudaStream_t& stream)
         {
             const int nblocks = 1;
 
@@ -370,21 +382,49 @@ namespace cv { namespace cuda { namespace device
             dim3 grid(divUp(img_block_width, nblocks), img_block_height);
 
             if (nthreads == 32)
-                normalize_hists_kernel_many_blocks<32, nblocks><<<grid, threads, 0, stream>>>(block_hist_size, img_block_width, block_hists, threshold);
+                normalize_hists_kernel_many_blocks<32, nblocks, T><<<grid, threads, 0, stream>>>(block_hist_size, img_block_width, block_hists, threshold, dst_hists);
             else if (nthreads == 64)
-                normalize_hists_kernel_many_blocks<64, nblocks><<<grid, threads, 0, stream>>>(block_hist_size, img_block_width, block_hists, threshold);
+                normalize_hists_kernel_many_blocks<64, nblocks, T><<<grid, threads, 0, stream>>>(block_hist_size, img_block_width, block_hists, threshold, dst_hists);
             else if (nthreads == 128)
-                normalize_hists_kernel_many_blocks<128, nblocks><<<grid, threads, 0, stream>>>(block_hist_size, img_block_width, block_hists, threshold);
+                normalize_hists_kernel_many_blocks<128, nblocks, T><<<grid, threads, 0, stream>>>(block_hist_size, img_block_width, block_hists, threshold, dst_hists);
             else if (nthreads == 256)
-                normalize_hists_kernel_many_blocks<256, nblocks><<<grid, threads, 0, stream>>>(block_hist_size, img_block_width, block_hists, threshold);
+                normalize_hists_kernel_many_blocks<256, nblocks, T><<<grid, threads, 0, stream>>>(block_hist_size, img_block_width, block_hists, threshold, dst_hists);
             else if (nthreads == 512)
-                normalize_hists_kernel_many_blocks<512, nblocks><<<grid, threads, 0, stream>>>(block_hist_size, img_block_width, block_hists, threshold);
+                normalize_hists_kernel_many_blocks<512, nblocks, T><<<grid, threads, 0, stream>>>(block_hist_size, img_block_width, block_hists, threshold, dst_hists);
             else
                 CV_Error(cv::Error::StsBadArg, "normalize_hists: histogram's size is too big, try to decrease number of bins");
 
             cudaSafeCall( cudaGetLastError() );
         }
 
+        void normalize_hists(int nbins,
+                             int block_stride_x, int block_stride_y,
+                             int height, int width,
+                             float* block_hists,
+                             float threshold,
+                             int cell_size_x, int cell_size_y,
+                             int ncells_block_x, int ncells_block_y,
+                             const cudaStream_t& stream)
+        {
+            normalize_hists_caller<float>(nbins, block_stride_x, block_stride_y, height, width, block_hists, threshold,
+                                          cell_size_x, cell_size_y, ncells_block_x, ncells_block_y, block_hists, stream);
+        }
+
+        void normalize_hists(int nbins,
+                             int block_stride_x, int block_stride_y,
+                             int height, int width,
+                             float* block_hists,
+                             float threshold,
+                             int cell_size_x, int cell_size_y,
+                             int ncells_block_x, int ncells_block_y,
+                             unsigned short* block_hists_16f,
+                             const cudaStream_t& stream)
+        {
+            normalize_hists_caller<__half>(nbins, block_stride_x, block_stride_y, height, width, block_hists, threshold,
+                                           cell_size_x, cell_size_y, ncells_block_x, ncells_block_y,
+                                           reinterpret_cast<__half*>(block_hists_16f), stream);
+        }
+
 
         //---------------------------------------------------------------------
         //  Linear SVM based classification
@@ -392,17 +432,18 @@ namespace cv { namespace cuda { namespace device
 
        // return confidence values not just positive location
        template <int nthreads, // Number of threads per one histogram block
-                 int nblocks>  // Number of histogram block processed by single GPU thread block
+                 int nblocks,  // Number of histogram block processed by single GPU thread block
+                 typename T>
        __global__ void compute_confidence_hists_kernel_many_blocks(const int img_win_width, const int img_block_width,
                                                                                                            const int win_block_stride_x, const int win_block_stride_y,
-                                                                                                           const float* block_hists, const float* coefs,
+                                                                                                           const T* block_hists, const float* coefs,
                                                                                                            float free_coef, float threshold, float* confidences)
        {
            const int win_x = threadIdx.z;
            if (blockIdx.x * blockDim.z + win_x >= img_win_width)
                    return;
 
-           const float* hist = block_hists + (blockIdx.y * win_block_stride_y * img_block_width +
+           const T* hist = block_hists + (blockIdx.y * win_block_stride_y * img_block_width +
                                                                                 blockIdx.x * win_block_stride_x * blockDim.z + win_x) *
                                                                                cblock_hist_size;
 
@@ -411,7 +452,7 @@ namespace cv { namespace cuda { namespace device
            {
                    int offset_y = i / cdescr_width;
                    int offset_x = i - offset_y * cdescr_width;
-                   product += coefs[i] * hist[offset_y * img_block_width * cblock_hist_size + offset_x];
+                   product += coefs[i] * load_hist(hist + offset_y * img_block_width * cblock_hist_size + offset_x);
            }
 
            __shared__ float products[nthreads * nblocks];
@@ -425,8 +466,9 @@ namespace cv { namespace cuda { namespace device
 
        }
 
-       void compute_confidence_hists(int win_height, int win_width, int block_stride_y, int block_stride_x,
-                                               int win_stride_y, int win_stride_x, int height, int width, float* block_hists,
+       template <typename T>
+       static void compute_confidence_hists_caller(int win_height, int win_width, int block_stride_y, int block_stride_x,
+                                               int win_stride_y, int win_stride_x, int height, int width, const T* block_hists,
                                                float* coefs, float free_coef, float threshold, int cell_size_x, int ncells_block_x, float *confidences)
        {
            const int nthreads = 256;
@@ -440,31 +482,130 @@ namespace cv { namespace cuda { namespace device
            dim3 threads(nthreads, 1, nblocks);
            dim3 grid(divUp(img_win_width, nblocks), img_win_height);
 
-           cudaSafeCall(cudaFuncSetCacheConfig(compute_confidence_hists_kernel_many_blocks<nthreads, nblocks>,
+           cudaSafeCall(cudaFuncSetCacheConfig(compute_confidence_hists_kernel_many_blocks<nthreads, nblocks, T>,
                                                                                    cudaFuncCachePreferL1));
 
            int img_block_width = (width - ncells_block_x * cell_size_x + block_stride_x) /
                                                        block_stride_x;
-           compute_confidence_hists_kernel_many_blocks<nthreads, nblocks><<<grid, threads>>>(
+           compute_confidence_hists_kernel_many_blocks<nthreads, nblocks, T><<<grid, threads>>>(
                    img_win_width, img_block_width, win_block_stride_x, win_block_stride_y,
                    block_hists, coefs, free_coef, threshold, confidences);
            cudaSafeCall(cudaDeviceSynchronize());
        }
 
+       void compute_confidence_hists(int win_height, int win_width, int block_stride_y, int block_stride_x,
+                                     int win_stride_y, int win_stride_x, int height, int width, float* block_hists,
+                                     float* coefs, float free_coef, float threshold, int cell_size_x, int ncells_block_x, float *confidences)
+       {
+           compute_confidence_hists_caller<float>(win_height, win_width, block_stride_y, block_stride_x, win_stride_y, win_stride_x,
+                                                  height, width, block_hists, coefs, free_coef, threshold, cell_size_x, ncells_block_x, confidences);
+       }
+
+       void compute_confidence_hists(int win_height, int win_width, int block_stride_y, int block_stride_x,
+                                     int win_stride_y, int win_stride_x, int height, int width, const unsigned short* block_hists_16f,
+                                     float* coefs, float free_coef, float threshold, int cell_size_x, int ncells_block_x, float *confidences)
+       {
+           compute_confidence_hists_caller<__half>(win_height, win_width, block_stride_y, block_stride_x, win_stride_y, win_stride_x,
+                                                   height, width, reinterpret_cast<const __half*>(block_hists_16f), coefs, free_coef, threshold,
+                                                   cell_size_x, ncells_block_x, confidences);
+       }
+
+        // One GPU thread block per window of a batch of images and pyramid levels.
+        // Each job holds 4 ints: first window, img_win_width, histograms offset and img_block_width.
+        template <int nthreads, typename T>
+        __global__ void compute_confidence_hists_batch_kernel(const int* jobs, const int njobs,
+                                                              const int win_block_stride_x, const int win_block_stride_y,
+                                                              const T* block_hists, const float* coefs,
+                                                              float free_coef, float* confidences)
+        {
+            const int win = blockIdx.x;
+
+            int lo = 0, hi = njobs - 1;
+            while (lo < hi)
+            {
+                const int mid = (lo + hi + 1) >> 1;
+                if (jobs[mid * 4] <= win)
+                    lo = mid;
+                else
+                    hi = mid - 1;
+            }
+
+            const int* job = jobs + lo * 4;
+            const int img_win_width = job[1];
+            const int img_block_width = job[3];
+
+            const int win_idx = win - job[0];
+            const int win_y = win_idx / img_win_width;
+            const int win_x = win_idx - win_y * img_win_width;
+
+            const T* hist = block_hists + job[2] + (win_y * win_block_stride_y * img_block_width +
+                                                        win_x * win_block_stride_x) * cblock_hist_size;
+
+            float product = 0.f;
+            for (int i = threadIdx.x; i < cdescr_size; i += nthreads)
+            {
+                int offset_y = i / cdescr_width;
+                int offset_x = i - offset_y * cdescr_width;
+                product += coefs[i] * load_hist(hist + offset_y * img_block_width * cblock_hist_size + offset_x);
+            }
+
+            __shared__ float products[nthreads];
+
+            reduce<nthreads>(products, product, threadIdx.x, plus<float>());
+
+            if (threadIdx.x == 0)
+                confidences[win] = product + free_coef;
+        }
+
+        template <typename T>
+        static void compute_confidence_hists_batch_caller(int win_stride_y, int win_stride_x, int block_stride_y, int block_stride_x,
+                                                          const int* jobs, int njobs, int nwins, const T* block_hists,
+                                                          float* coefs, float free_coef, float* confidences)
+        {
+            const int nthreads = 256;
+
+            cudaSafeCall(cudaFuncSetCacheConfig(compute_confidence_hists_batch_kernel<nthreads, T>, cudaFuncCachePreferL1));
+
+            compute_confidence_hists_batch_kernel<nthreads, T><<<nwins, nthreads>>>(
+                jobs, njobs, win_stride_x / block_stride_x, win_stride_y / block_stride_y,
+                block_hists, coefs, free_coef, confidences);
+            cudaSafeCall(cudaGetLastError());
+
+            cudaSafeCall(cudaDeviceSynchronize());
+        }
+
+        void compute_confidence_hists_batch(int win_stride_y, int win_stride_x, int block_stride_y, int block_stride_x,
+                                            const int* jobs, int njobs, int nwins, float* block_hists,
+                                            float* coefs, float free_coef, float* confidences)
+        {
+            compute_confidence_hists_batch_caller<float>(win_stride_y, win_stride_x, block_stride_y, block_stride_x,
+                                                         jobs, njobs, nwins, block_hists, coefs, free_coef, confidences);
+        }
+
+        void compute_confidence_hists_batch(int win_stride_y, int win_stride_x, int block_stride_y, int block_stride_x,
+                                            const int* jobs, int njobs, int nwins, const unsigned short* block_hists_16f,
+                                            float* coefs, float free_coef, float* confidences)
+        {
+            compute_confidence_hists_batch_caller<__half>(win_stride_y, win_stride_x, block_stride_y, block_stride_x,
+                                                          jobs, njobs, nwins, reinterpret_cast<const __half*>(block_hists_16f),
+                                                          coefs, free_coef, confidences);
+        }
+
 
 
         template <int nthreads, // Number of threads per one histogram block
-                  int nblocks>  // Number of histogram block processed by single GPU thread block
+                  int nblocks,  // Number of histogram block processed by single GPU thread block
+                  typename T>
         __global__ void classify_hists_kernel_many_blocks(const int img_win_width, const int img_block_width,
                                                           const int win_block_stride_x, const int win_block_stride_y,
-                                                          const float* block_hists, const float* coefs,
+                                                          const T* block_hists, const float* coefs,
                                                           float free_coef, float threshold, unsigned char* labels)
         {
             const int win_x = threadIdx.z;
             if (blockIdx.x * blockDim.z + win_x >= img_win_width)
                 return;
 
-            const float* hist = block_hists + (blockIdx.y * win_block_stride_y * img_block_width +
+            const T* hist = block_hists + (blockIdx.y * win_block_stride_y * img_block_width +
                                                blockIdx.x * win_block_stride_x * blockDim.z + win_x) *
                                               cblock_hist_size;
 
@@ -473,7 +614,7 @@ namespace cv { namespace cuda { namespace device
             {
                 int offset_y = i / cdescr_width;
                 int offset_x = i - offset_y * cdescr_width;
-                product += coefs[i] * hist[offset_y * img_block_width * cblock_hist_size + offset_x];
+                product += coefs[i] * load_hist(hist + offset_y * img_block_width * cblock_hist_size + offset_x);
             }
 
             __shared__ float products[nthreads * nblocks];
@@ -487,9 +628,10 @@ namespace cv { namespace cuda { namespace device
         }
 
 
-        void classify_hists(int win_height, int win_width, int block_stride_y, int block_stride_x,
-                            int win_stride_y, int win_stride_x, int height, int width, float* block_hists,
-                            float* coefs, float free_coef, float threshold, int cell_size_x, int ncells_block_x, unsigned char* labels)
+        template <typename T>
+        static void classify_hists_caller(int win_height, int win_width, int block_stride_y, int block_stride_x,
+                                          int win_stride_y, int win_stride_x, int height, int width, const T* block_hists,
+                                          float* coefs, float free_coef, float threshold, int cell_size_x, int ncells_block_x, unsigned char* labels)
         {
             const int nthreads = 256;
             const int nblocks = 1;
@@ -502,10 +644,10 @@ namespace cv { namespace cuda { namespace device
             dim3 threads(nthreads, 1, nblocks);
             dim3 grid(divUp(img_win_width, nblocks), img_win_height);
 
-            cudaSafeCall(cudaFuncSetCacheConfig(classify_hists_kernel_many_blocks<nthreads, nblocks>, cudaFuncCachePreferL1));
+            cudaSafeCall(cudaFuncSetCacheConfig(classify_hists_kernel_many_blocks<nthreads, nblocks, T>, cudaFuncCachePreferL1));
 
             int img_block_width = (width - ncells_block_x * cell_size_x + block_stride_x) / block_stride_x;
-            classify_hists_kernel_many_blocks<nthreads, nblocks><<<grid, threads>>>(
+            classify_hists_kernel_many_blocks<nthreads, nblocks, T><<<grid, threads>>>(
                 img_win_width, img_block_width, win_block_stride_x, win_block_stride_y,
                 block_hists, coefs, free_coef, threshold, labels);
             cudaSafeCall( cudaGetLastError() );
@@ -513,6 +655,23 @@ namespace cv { namespace cuda { namespace device
             cudaSafeCall( cudaDeviceSynchronize() );
         }
 
+        void classify_hists(int win_height, int win_width, int block_stride_y, int block_stride_x,
+                            int win_stride_y, int win_stride_x, int height, int width, float* block_hists,
+                            float* coefs, float free_coef, float threshold, int cell_size_x, int ncells_block_x, unsigned char* labels)
+        {
+            classify_hists_caller<float>(win_height, win_width, block_stride_y, block_stride_x, win_stride_y, win_stride_x,
+                                         height, width, block_hists, coefs, free_coef, threshold, cell_size_x, ncells_block_x, labels);
+        }
+
+        void classify_hists(int win_height, int win_width, int block_stride_y, int block_stride_x,
+                            int win_stride_y, int win_stride_x, int height, int width, const unsigned short* block_hists_16f,
+                            float* coefs, float free_coef, float threshold, int cell_size_x, int ncells_block_x, unsigned char* labels)
+        {
+            classify_hists_caller<__half>(win_height, win_width, block_stride_y, block_stride_x, win_stride_y, win_stride_x,
+                                          height, width, reinterpret_cast<const __half*>(block_hists_16f), coefs, free_coef, threshold,
+                                          cell_size_x, ncells_block_x, labels);
+        }
+
         //----------------------------------------------------------------------------
         // Extract descriptors
 
@@ -297,6 +297,63 @@ namespace cv { namespace cuda { namespace device
             Cascade cascade((Stage*)mstages.ptr(), nstages, (ClNode*)mnodes.ptr(), mleaves.ptr(), msubsets.ptr(), (uchar4*)mfeatures.ptr(), subsetSize);
             lbp_cascade<<<grid, block>>>(cascade, frameW, frameH, windowW, windowH, initialScale, factor, workAmount, integral.ptr(), (int)integral.step / sizeof(int), objects, classified);
         }
+
+        // levels of several images packed into one integral buffer,
+        // each row of levels is image, x and y offsets in the integral, first window, windows per line, step shift
+        __global__ void lbp_cascade_batch(const Cascade cascade, int windowW, int windowH, const PtrStepSzi levels, const float* scales,
+            const int total, int* integral, const int pitch, PtrStepSz<int4> objects, unsigned int* classified)
+        {
+            int ftid = blockIdx.x * blockDim.x + threadIdx.x;
+            if (ftid >= total) return;
+
+            int lo = 0, hi = levels.rows - 1;
+            while (lo < hi)
+            {
+                int mid = (lo + hi + 1) >> 1;
+                if (levels(mid, 3) <= ftid)
+                    lo = mid;
+                else
+                    hi = mid - 1;
+            }
+
+            const int* level = levels.ptr(lo);
+            const int step = level[5];
+            const int windowsForLine = level[4];
+
+            int scaleTid = ftid - level[3];
+
+            int y = scaleTid / windowsForLine;
+            int x = scaleTid - y * windowsForLine;
+
+            x <<= step;
+            y <<= step;
+
+            if (cascade(y + level[2], x + level[1], integral, pitch))
+            {
+                const float scale = scales[lo];
+
+                int4 rect;
+                rect.x = __float2int_rn(x * scale);
+                rect.y = __float2int_rn(y * scale);
+                rect.z = __float2int_rn(windowW * scale);
+                rect.w = __float2int_rn(windowH * scale);
+
+                int res = atomicInc(classified + level[0], (unsigned int)objects.cols);
+                objects(level[0], res) = rect;
+            }
+        }
+
+        void classifyPyramidBatch(int windowW, int windowH, const PtrStepSzi& levels, const float* scales, int workAmount,
+            const PtrStepSzb& mstages, const int nstages, const PtrStepSzi& mnodes, const PtrStepSzf& mleaves, const PtrStepSzi& msubsets, const PtrStepSzb& mfeatures,
+            const int subsetSize, PtrStepSz<int4> objects, unsigned int* classified, PtrStepSzi integral)
+        {
+            const int block = 128;
+            int grid = divUp(workAmount, block);
+            cudaFuncSetCacheConfig(lbp_cascade_batch, cudaFuncCachePreferL1);
+            Cascade cascade((Stage*)mstages.ptr(), nstages, (ClNode*)mnodes.ptr(), mleaves.ptr(), msubsets.ptr(), (uchar4*)mfeatures.ptr(), subsetSize);
+            lbp_cascade_batch<<<grid, block>>>(cascade, windowW, windowH, levels, scales, workAmount, integral.ptr(), (int)integral.step / sizeof(int), objects, classified);
+            cudaSafeCall( cudaGetLastError() );
+        }
     }
 }}}
 
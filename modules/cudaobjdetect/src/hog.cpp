@@ -88,15 +88,38 @@ namespace cv { namespace cuda { namespace device
                              int cell_size_x, int cell_size_y,
                              int ncells_block_x, int ncells_block_y,
                              const cudaStream_t& stream);
+        void normalize_hists(int nbins,
+                             int block_stride_x, int block_stride_y,
+                             int height, int width,
+                             float* block_hists,
+                             float threshold,
+                             int cell_size_x, int cell_size_y,
+                             int ncells_block_x, int ncells_block_y,
+                             unsigned short* block_hists_16f,
+                             const cudaStream_t& stream);
 
         void classify_hists(int win_height, int win_width, int block_stride_y,
                             int block_stride_x, int win_stride_y, int win_stride_x, int height,
                             int width, float* block_hists, float* coefs, float free_coef,
                             float threshold, int cell_size_x, int ncells_block_x, unsigned char* labels);
+        void classify_hists(int win_height, int win_width, int block_stride_y,
+                            int block_stride_x, int win_stride_y, int win_stride_x, int height,
+                            int width, const unsigned short* block_hists_16f, float* coefs, float free_coef,
+                            float threshold, int cell_size_x, int ncells_block_x, unsigned char* labels);
 
         void compute_confidence_hists(int win_height, int win_width, int block_stride_y, int block_stride_x,
                                       int win_stride_y, int win_stride_x, int height, int width, float* block_hists,
                                       float* coefs, float free_coef, float threshold, int cell_size_x, int ncells_block_x, float *confidences);
+        void compute_confidence_hists(int win_height, int win_width, int block_stride_y, int block_stride_x,
+                                      int win_stride_y, int win_stride_x, int height, int width, const unsigned short* block_hists_16f,
+                                      float* coefs, float free_coef, float threshold, int cell_size_x, int ncells_block_x, float *confidences);
+
+        void compute_confidence_hists_batch(int win_stride_y, int win_stride_x, int block_stride_y, int block_stride_x,
+                                            const int* jobs, int njobs, int nwins, float* block_hists,
+                                            float* coefs, float free_coef, float* confidences);
+        void compute_confidence_hists_batch(int win_stride_y, int win_stride_x, int block_stride_y, int block_stride_x,
+                                            const int* jobs, int njobs, int nwins, const unsigned short* block_hists_16f,
+                                            float* coefs, float free_coef, float* confidences);
 
         void extract_descrs_by_rows(int win_height, int win_width,
                                     int block_stride_y, int block_stride_x,
@@ -173,6 +196,9 @@ namespace
         virtual void setDescriptorFormat(HOGDescriptor::DescriptorStorageFormat descr_format) { descr_format_ = descr_format; }
         virtual HOGDescriptor::DescriptorStorageFormat getDescriptorFormat() const { return descr_format_; }
 
+        virtual void setUseFP16Histograms(bool use_fp16) { use_fp16_ = use_fp16; }
+        virtual bool getUseFP16Histograms() const { return use_fp16_; }
+
         virtual size_t getDescriptorSize() const;
 
         virtual size_t getBlockHistogramSize() const;
@@ -189,6 +215,10 @@ namespace
                                       std::vector<Rect>& found_locations,
                                       std::vector<double>* confidences);
 
+        virtual void detectMultiScale(const std::vector<GpuMat>& imgs,
+                                      std::vector<std::vector<Rect> >& found_locations,
+                                      std::vector<std::vector<double> >* confidences);
+
         virtual void compute(InputArray img,
                              OutputArray descriptors,
                              Stream& stream);
@@ -209,16 +239,29 @@ namespace
         double scale0_;
         int group_threshold_;
         HOGDescriptor::DescriptorStorageFormat descr_format_;
+        bool use_fp16_;
         Size cells_per_block_;
 
     private:
         int getTotalHistSize(Size img_size) const;
+        std::vector<double> computeLevelScales(Size img_size) const;
         void computeBlockHistograms(const GpuMat& img, GpuMat& block_hists, Stream& stream);
+        void computeBlockHistograms(const GpuMat& img, GpuMat& block_hists, GpuMat& grad, GpuMat& qangle,
+                                    GpuMat* block_hists_16f, Stream& stream);
+        void classify(GpuMat& block_hists, Size img_size, std::vector<Point>& hits, std::vector<double>* confidences);
 //        void computeGradient(const GpuMat& img, GpuMat& grad, GpuMat& qangle, Stream& stream);
 
         // Coefficients of the separating plane
         float free_coef_;
         GpuMat detector_;
+
+        // Scratch buffers of detect and detectMultiScale, kept between the pyramid levels and the calls
+        GpuMat grad_buf_;
+        GpuMat qangle_buf_;
+        GpuMat block_hists_buf_;
+        GpuMat block_hists_16f_buf_;
+        GpuMat smaller_img_buf_;
+        GpuMat labels_buf_;
     };
 
     HOG_Impl::HOG_Impl(Size win_size,
@@ -241,6 +284,7 @@ namespace
         scale0_(1.05),
         group_threshold_(2),
         descr_format_(HOGDescriptor::DESCR_FORMAT_COL_BY_COL),
+        use_fp16_(false),
         cells_per_block_(block_size.width / cell_size.width, block_size.height / cell_size.height)
     {
         CV_Assert((win_size.width  - block_size.width ) % block_stride.width  == 0 &&
@@ -327,6 +371,12 @@ namespace
             return getPeopleDetector48x96();
     }
 
+    static GpuMat getScratch(GpuMat& buf, int rows, int cols, int type)
+    {
+        cuda::ensureSizeIsEnough(rows, cols, type, buf);
+        return buf(Rect(0, 0, cols, rows));
+    }
+
     void HOG_Impl::detect(InputArray _img, std::vector<Point>& hits, std::vector<double>* confidences)
     {
         const GpuMat img = _img.getGpuMat();
@@ -338,27 +388,55 @@ namespace
         if (detector_.empty())
             return;
 
-        BufferPool pool(Stream::Null());
+        const int total_hist_size = getTotalHistSize(img.size());
 
-        GpuMat block_hists = pool.getBuffer(1, getTotalHistSize(img.size()), CV_32FC1);
-        computeBlockHistograms(img, block_hists, Stream::Null());
+        GpuMat block_hists = getScratch(block_hists_buf_, 1, total_hist_size, CV_32FC1);
+        GpuMat grad        = getScratch(grad_buf_, img.rows, img.cols, CV_32FC2);
+        GpuMat qangle      = getScratch(qangle_buf_, img.rows, img.cols, CV_8UC2);
 
-        Size wins_per_img = numPartsWithin(img.size(), win_size_, win_stride_);
+        if (use_fp16_)
+        {
+            GpuMat block_hists_16f = getScratch(block_hists_16f_buf_, 1, total_hist_size, CV_16FC1);
+            computeBlockHistograms(img, block_hists, grad, qangle, &block_hists_16f, Stream::Null());
+            classify(block_hists_16f, img.size(), hits, confidences);
+        }
+        else
+        {
+            computeBlockHistograms(img, block_hists, grad, qangle, NULL, Stream::Null());
+            classify(block_hists, img.size(), hits, confidences);
+        }
+    }
+
+    void HOG_Impl::classify(GpuMat& block_hists, Size img_size, std::vector<Point>& hits, std::vector<double>* confidences)
+    {
+        Size wins_per_img = numPartsWithin(img_size, win_size_, win_stride_);
 
         if (confidences == NULL)
         {
-            GpuMat labels = pool.getBuffer(1, wins_per_img.area(), CV_8UC1);
-
-            hog::classify_hists(win_size_.height, win_size_.width,
-                                block_stride_.height, block_stride_.width,
-                                win_stride_.height, win_stride_.width,
-                                img.rows, img.cols,
-                                block_hists.ptr<float>(),
-                                detector_.ptr<float>(),
-                                (float)free_coef_,
-                                (float)hit_threshold_,
-                                cell_size_.width, cells_per_block_.width,
-                                labels.ptr());
+            GpuMat labels = getScratch(labels_buf_, 1, wins_per_img.area(), CV_8UC1);
+
+            if (block_hists.depth() == CV_16F)
+                hog::classify_hists(win_size_.height, win_size_.width,
+                                    block_stride_.height, block_stride_.width,
+                                    win_stride_.height, win_stride_.width,
+                                    img_size.height, img_size.width,
+                                    block_hists.ptr<unsigned short>(),
+                                    detector_.ptr<float>(),
+                                    (float)free_coef_,
+                                    (float)hit_threshold_,
+                                    cell_size_.width, cells_per_block_.width,
+                                    labels.ptr());
+            else
+                hog::classify_hists(win_size_.height, win_size_.width,
+                                    block_stride_.height, block_stride_.width,
+                                    win_stride_.height, win_stride_.width,
+                                    img_size.height, img_size.width,
+                                    block_hists.ptr<float>(),
+                                    detector_.ptr<float>(),
+                                    (float)free_coef_,
+                                    (float)hit_threshold_,
+                                    cell_size_.width, cells_per_block_.width,
+                                    labels.ptr());
 
             Mat labels_host;
             labels.download(labels_host);
@@ -374,18 +452,30 @@ namespace
         }
         else
         {
-            GpuMat labels = pool.getBuffer(1, wins_per_img.area(), CV_32FC1);
-
-            hog::compute_confidence_hists(win_size_.height, win_size_.width,
-                                          block_stride_.height, block_stride_.width,
-                                          win_stride_.height, win_stride_.width,
-                                          img.rows, img.cols,
-                                          block_hists.ptr<float>(),
-                                          detector_.ptr<float>(),
-                                          (float)free_coef_,
-                                          (float)hit_threshold_,
-                                          cell_size_.width, cells_per_block_.width,
-                                          labels.ptr<float>());
+            GpuMat labels = getScratch(labels_buf_, 1, wins_per_img.area(), CV_32FC1);
+
+            if (block_hists.depth() == CV_16F)
+                hog::compute_confidence_hists(win_size_.height, win_size_.width,
+                                              block_stride_.height, block_stride_.width,
+                                              win_stride_.height, win_stride_.width,
+                                              img_size.height, img_size.width,
+                                              block_hists.ptr<unsigned short>(),
+                                              detector_.ptr<float>(),
+                                              (float)free_coef_,
+                                              (float)hit_threshold_,
+                                              cell_size_.width, cells_per_block_.width,
+                                              labels.ptr<float>());
+            else
+                hog::compute_confidence_hists(win_size_.height, win_size_.width,
+                                              block_stride_.height, block_stride_.width,
+                                              win_stride_.height, win_stride_.width,
+                                              img_size.height, img_size.width,
+                                              block_hists.ptr<float>(),
+                                              detector_.ptr<float>(),
+                                              (float)free_coef_,
+                                              (float)hit_threshold_,
+                                              cell_size_.width, cells_per_block_.width,
+                                              labels.ptr<float>());
 
             Mat labels_host;
             labels.download(labels_host);
@@ -415,30 +505,12 @@ namespace
         CV_Assert( img.type() == CV_8UC1 || img.type() == CV_8UC4 );
         CV_Assert( confidences == NULL || group_threshold_ == 0 );
 
-        std::vector<double> level_scale;
-        double scale = 1.0;
-        int levels = 0;
-        for (levels = 0; levels < nlevels_; levels++)
-        {
-            level_scale.push_back(scale);
-
-            if (cvRound(img.cols / scale) < win_size_.width ||
-                cvRound(img.rows / scale) < win_size_.height ||
-                scale0_ <= 1)
-            {
-                break;
-            }
-
-            scale *= scale0_;
-        }
-        levels = std::max(levels, 1);
-        level_scale.resize(levels);
+        std::vector<double> level_scale = computeLevelScales(img.size());
+        double scale;
 
         std::vector<Point> level_hits;
         std::vector<double> level_confidences;
 
-        BufferPool pool(Stream::Null());
-
         found_locations.clear();
         for (size_t i = 0; i < level_scale.size(); i++)
         {
@@ -453,7 +525,7 @@ namespace
             }
             else
             {
-                smaller_img = pool.getBuffer(sz, img.type());
+                smaller_img = getScratch(smaller_img_buf_, sz.height, sz.width, img.type());
                 switch (img.type())
                 {
                     case CV_8UC1: hog::resize_8UC1(img, smaller_img); break;
@@ -527,6 +599,189 @@ namespace
         }
     }
 
+    void HOG_Impl::detectMultiScale(const std::vector<GpuMat>& imgs,
+                                    std::vector<std::vector<Rect> >& found_locations,
+                                    std::vector<std::vector<double> >* confidences)
+    {
+        CV_Assert( confidences == NULL || group_threshold_ == 0 );
+        CV_Assert( win_stride_.width % block_stride_.width == 0 && win_stride_.height % block_stride_.height == 0 );
+
+        const int nimages = static_cast<int>(imgs.size());
+
+        found_locations.assign(nimages, std::vector<Rect>());
+        if (confidences)
+            confidences->assign(nimages, std::vector<double>());
+
+        if (detector_.empty() || nimages == 0)
+            return;
+
+        struct Level
+        {
+            int image;
+            double scale;
+            Size size;
+            Size wins;
+        };
+
+        // enumerate the pyramid levels of all images, levels without windows are skipped
+        std::vector<Level> levels;
+        std::vector<int> jobs;
+        int total_hist_size = 0;
+        int total_wins = 0;
+        for (int i = 0; i < nimages; ++i)
+        {
+            CV_Assert( imgs[i].type() == CV_8UC1 || imgs[i].type() == CV_8UC4 );
+
+            const std::vector<double> level_scale = computeLevelScales(imgs[i].size());
+            for (size_t j = 0; j < level_scale.size(); ++j)
+            {
+                Level level;
+                level.image = i;
+                level.scale = level_scale[j];
+                level.size = Size(cvRound(imgs[i].cols / level.scale), cvRound(imgs[i].rows / level.scale));
+                level.wins = numPartsWithin(level.size, win_size_, win_stride_);
+
+                if (level.size.width < win_size_.width || level.size.height < win_size_.height || level.wins.area() <= 0)
+                    continue;
+
+                jobs.push_back(total_wins);
+                jobs.push_back(level.wins.width);
+                jobs.push_back(total_hist_size);
+                jobs.push_back(numPartsWithin(level.size, block_size_, block_stride_).width);
+
+                levels.push_back(level);
+                total_hist_size += getTotalHistSize(level.size);
+                total_wins += level.wins.area();
+            }
+        }
+
+        if (levels.empty())
+            return;
+
+        BufferPool pool(Stream::Null());
+
+        GpuMat block_hists = getScratch(block_hists_buf_, 1, total_hist_size, CV_32FC1);
+        GpuMat block_hists_16f;
+        if (use_fp16_)
+            block_hists_16f = getScratch(block_hists_16f_buf_, 1, total_hist_size, CV_16FC1);
+
+        for (size_t j = 0; j < levels.size(); ++j)
+        {
+            const Level& level = levels[j];
+            const GpuMat& img = imgs[level.image];
+
+            GpuMat smaller_img;
+            if (level.size == img.size())
+            {
+                smaller_img = img;
+            }
+            else
+            {
+                smaller_img = getScratch(smaller_img_buf_, level.size.height, level.size.width, img.type());
+                switch (img.type())
+                {
+                    case CV_8UC1: hog::resize_8UC1(img, smaller_img); break;
+                    case CV_8UC4: hog::resize_8UC4(img, smaller_img); break;
+                }
+            }
+
+            GpuMat grad   = getScratch(grad_buf_, level.size.height, level.size.width, CV_32FC2);
+            GpuMat qangle = getScratch(qangle_buf_, level.size.height, level.size.width, CV_8UC2);
+
+            const Range hists_range(jobs[j * 4 + 2], jobs[j * 4 + 2] + getTotalHistSize(level.size));
+            GpuMat level_hists = block_hists.colRange(hists_range);
+            if (use_fp16_)
+            {
+                GpuMat level_hists_16f = block_hists_16f.colRange(hists_range);
+                computeBlockHistograms(smaller_img, level_hists, grad, qangle, &level_hists_16f, Stream::Null());
+            }
+            else
+            {
+                computeBlockHistograms(smaller_img, level_hists, grad, qangle, NULL, Stream::Null());
+            }
+        }
+
+        GpuMat d_jobs = pool.getBuffer(1, static_cast<int>(jobs.size()), CV_32SC1);
+        d_jobs.upload(Mat(jobs).reshape(1, 1));
+
+        GpuMat d_confidences = pool.getBuffer(1, total_wins, CV_32FC1);
+
+        // classify the windows of all levels at once
+        if (use_fp16_)
+            hog::compute_confidence_hists_batch(win_stride_.height, win_stride_.width,
+                                                block_stride_.height, block_stride_.width,
+                                                d_jobs.ptr<int>(), static_cast<int>(levels.size()), total_wins,
+                                                block_hists_16f.ptr<unsigned short>(),
+                                                detector_.ptr<float>(),
+                                                (float)free_coef_,
+                                                d_confidences.ptr<float>());
+        else
+            hog::compute_confidence_hists_batch(win_stride_.height, win_stride_.width,
+                                                block_stride_.height, block_stride_.width,
+                                                d_jobs.ptr<int>(), static_cast<int>(levels.size()), total_wins,
+                                                block_hists.ptr<float>(),
+                                                detector_.ptr<float>(),
+                                                (float)free_coef_,
+                                                d_confidences.ptr<float>());
+
+        Mat h_confidences;
+        d_confidences.download(h_confidences);
+        const float* vec = h_confidences.ptr<float>();
+
+        for (size_t j = 0; j < levels.size(); ++j)
+        {
+            const Level& level = levels[j];
+            const float* level_vec = vec + jobs[j * 4];
+
+            Size scaled_win_size(cvRound(win_size_.width * level.scale),
+                                 cvRound(win_size_.height * level.scale));
+
+            for (int k = 0; k < level.wins.area(); ++k)
+            {
+                if (level_vec[k] < hit_threshold_)
+                    continue;
+
+                int y = k / level.wins.width;
+                int x = k - level.wins.width * y;
+                Point hit(x * win_stride_.width, y * win_stride_.height);
+
+                found_locations[level.image].push_back(Rect(Point2d(hit) * level.scale, scaled_win_size));
+                if (confidences)
+                    (*confidences)[level.image].push_back((double)level_vec[k]);
+            }
+        }
+
+        if (group_threshold_ > 0)
+        {
+            for (int i = 0; i < nimages; ++i)
+                groupRectangles(found_locations[i], group_threshold_, 0.2/*magic number copied from CPU version*/);
+        }
+    }
+
+    std::vector<double> HOG_Impl::computeLevelScales(Size img_size) const
+    {
+        std::vector<double> level_scale;
+        double scale = 1.0;
+        int levels = 0;
+        for (levels = 0; levels < nlevels_; levels++)
+        {
+            level_scale.push_back(scale);
+
+            if (cvRound(img_size.width / scale) < win_size_.width ||
+                cvRound(img_size.height / scale) < win_size_.height ||
+                scale0_ <= 1)
+            {
+                break;
+            }
+
+            scale *= scale0_;
+        }
+        levels = std::max(levels, 1);
+        level_scale.resize(levels);
+
+        return level_scale;
+    }
+
     int HOG_Impl::getTotalHistSize(Size img_size) const
     {
         size_t block_hist_size = getBlockHistogramSize();
@@ -537,11 +792,18 @@ namespace
     void HOG_Impl::computeBlockHistograms(const GpuMat& img, GpuMat& block_hists, Stream& stream)
     {
         BufferPool pool(stream);
-        cv::Size blocks_per_win = numPartsWithin(win_size_, block_size_, block_stride_);
-        float  angleScale = static_cast<float>(nbins_ / CV_PI);
         GpuMat grad       = pool.getBuffer(img.size(), CV_32FC2);
         GpuMat qangle     = pool.getBuffer(img.size(), CV_8UC2);
 
+        computeBlockHistograms(img, block_hists, grad, qangle, NULL, stream);
+    }
+
+    void HOG_Impl::computeBlockHistograms(const GpuMat& img, GpuMat& block_hists, GpuMat& grad, GpuMat& qangle,
+                                          GpuMat* block_hists_16f, Stream& stream)
+    {
+        cv::Size blocks_per_win = numPartsWithin(win_size_, block_size_, block_stride_);
+        float  angleScale = static_cast<float>(nbins_ / CV_PI);
+
         hog::set_up_constants(nbins_,
                               block_stride_.width, block_stride_.height,
                               blocks_per_win.width, blocks_per_win.height,
@@ -578,14 +840,25 @@ namespace
                            cells_per_block_.width, cells_per_block_.height,
                            StreamAccessor::getStream(stream));
 
-        hog::normalize_hists(nbins_,
-                             block_stride_.width, block_stride_.height,
-                             img.rows, img.cols,
-                             block_hists.ptr<float>(),
-                             (float)threshold_L2hys_,
-                             cell_size_.width, cell_size_.height,
-                             cells_per_block_.width, cells_per_block_.height,
-                             StreamAccessor::getStream(stream));
+        if (block_hists_16f)
+            hog::normalize_hists(nbins_,
+                                 block_stride_.width, block_stride_.height,
+                                 img.rows, img.cols,
+                                 block_hists.ptr<float>(),
+                                 (float)threshold_L2hys_,
+                                 cell_size_.width, cell_size_.height,
+                                 cells_per_block_.width, cells_per_block_.height,
+                                 block_hists_16f->ptr<unsigned short>(),
+                                 StreamAccessor::getStream(stream));
+        else
+            hog::normalize_hists(nbins_,
+                                 block_stride_.width, block_stride_.height,
+                                 img.rows, img.cols,
+                                 block_hists.ptr<float>(),
+                                 (float)threshold_L2hys_,
+                                 cell_size_.width, cell_size_.height,
+                                 cells_per_block_.width, cells_per_block_.height,
+                                 StreamAccessor::getStream(stream));
     }
 }
 
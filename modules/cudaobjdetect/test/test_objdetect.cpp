@@ -263,6 +263,52 @@ CUDA_TEST_P(CalTech, HOG)
 #endif
 }
 
+CUDA_TEST_P(CalTech, HOG_Batch)
+{
+    cv::Mat img_small;
+    cv::resize(img, img_small, cv::Size(img.cols * 3 / 4, img.rows * 3 / 4));
+
+    std::vector<cv::cuda::GpuMat> d_imgs;
+    d_imgs.push_back(cv::cuda::GpuMat(img));
+    d_imgs.push_back(cv::cuda::GpuMat(img_small));
+
+    cv::Ptr<cv::cuda::HOG> d_hog = cv::cuda::HOG::create();
+    d_hog->setSVMDetector(d_hog->getDefaultPeopleDetector());
+
+    std::vector<std::vector<cv::Rect> > batch_locations;
+    d_hog->detectMultiScale(d_imgs, batch_locations);
+    ASSERT_EQ(d_imgs.size(), batch_locations.size());
+
+    for (size_t i = 0; i < d_imgs.size(); ++i)
+    {
+        std::vector<cv::Rect> found_locations;
+        d_hog->detectMultiScale(d_imgs[i], found_locations);
+        EXPECT_EQ(found_locations, batch_locations[i]);
+    }
+}
+
+CUDA_TEST_P(CalTech, HOG_FP16)
+{
+    cv::cuda::GpuMat d_img(img);
+
+    cv::Ptr<cv::cuda::HOG> d_hog = cv::cuda::HOG::create();
+    d_hog->setSVMDetector(d_hog->getDefaultPeopleDetector());
+    d_hog->setHitThreshold(-1000.0);
+
+    std::vector<cv::Point> locations, locations_16f;
+    std::vector<double> confidences, confidences_16f;
+    d_hog->detect(d_img, locations, &confidences);
+
+    d_hog->setUseFP16Histograms(true);
+    ASSERT_TRUE(d_hog->getUseFP16Histograms());
+    d_hog->detect(d_img, locations_16f, &confidences_16f);
+
+    ASSERT_EQ(locations, locations_16f);
+    ASSERT_EQ(confidences.size(), confidences_16f.size());
+    for (size_t i = 0; i < confidences.size(); ++i)
+        EXPECT_NEAR(confidences[i], confidences_16f[i], 1e-2);
+}
+
 INSTANTIATE_TEST_CASE_P(detect, CalTech, testing::Combine(ALL_DEVICES,
     ::testing::Values<std::string>("caltech/image_00000009_0.png", "caltech/image_00000032_0.png",
         "caltech/image_00000165_0.png", "caltech/image_00000261_0.png", "caltech/image_00000469_0.png",
@@ -555,6 +601,45 @@ CUDA_TEST_P(LBP_classify, Accuracy)
 #endif
 }
 
+CUDA_TEST_P(LBP_classify, Batch)
+{
+    std::string classifierXmlPath = std::string(cvtest::TS::ptr()->get_data_path()) + "lbpcascade/lbpcascade_frontalface.xml";
+    std::string imagePath = std::string(cvtest::TS::ptr()->get_data_path()) + "lbpcascade/er.png";
+
+    cv::Mat image = cv::imread(imagePath);
+    ASSERT_FALSE(image.empty());
+    cv::Mat grey;
+    cvtColor(image, grey, cv::COLOR_BGR2GRAY);
+
+    std::vector<cv::cuda::GpuMat> images;
+    images.push_back(cv::cuda::GpuMat(grey.colRange(0, grey.cols / 2)));
+    images.push_back(cv::cuda::GpuMat(grey.colRange(grey.cols / 2, grey.cols / 2 * 2)));
+    images.push_back(cv::cuda::GpuMat(grey.colRange(0, grey.cols / 2)));
+
+    cv::Ptr<cv::cuda::CascadeClassifier> gpuClassifier =
+            cv::cuda::CascadeClassifier::create(classifierXmlPath);
+
+    std::vector<cv::cuda::GpuMat> gpu_rects_bufs;
+    gpuClassifier->detectMultiScale(images, gpu_rects_bufs);
+    ASSERT_EQ(images.size(), gpu_rects_bufs.size());
+
+    std::vector<std::vector<cv::Rect> > batch_rects(images.size());
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        gpuClassifier->convert(gpu_rects_bufs[i], batch_rects[i]);
+
+        cv::cuda::GpuMat gpu_rects_buf;
+        gpuClassifier->detectMultiScale(images[i], gpu_rects_buf);
+
+        std::vector<cv::Rect> gpu_rects;
+        gpuClassifier->convert(gpu_rects_buf, gpu_rects);
+
+        EXPECT_EQ(gpu_rects.size(), batch_rects[i].size());
+    }
+
+    EXPECT_EQ(batch_rects[0].size(), batch_rects[2].size());
+}
+
 INSTANTIATE_TEST_CASE_P(CUDA_ObjDetect, LBP_classify,
                         testing::Combine(ALL_DEVICES, testing::Values<int>(0)));
 
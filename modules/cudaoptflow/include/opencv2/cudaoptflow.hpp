@@ -215,6 +215,33 @@ public:
     CV_WRAP virtual bool getUseInitialFlow() const = 0;
     CV_WRAP virtual void setUseInitialFlow(bool useInitialFlow) = 0;
 
+    /** @brief Tracks points into the next frame of a sequence.
+
+    The pyramid of every frame is built once: it is kept on the device and used as the previous pyramid
+    by the next call. On the first call after creation or resetTracking there is no previous frame,
+    the pyramid of nextImg is only stored, nextPts is set to prevPts and all statuses are 1.
+
+    @param nextImg Next frame of the sequence, all frames must have the same size and type.
+    @param prevPts Points of the previous frame, 1xN CV_32FC2.
+    @param nextPts Output positions of the points in nextImg.
+    @param status Output status vector, see SparseOpticalFlow::calc.
+    @param err Optional output vector of error responses.
+    @param fbErr Optional forward-backward error. The points are tracked back from nextImg to the
+    previous frame with the cached pyramids and the distance to prevPts is returned. A point that is
+    lost when it is tracked back gets status 0.
+    @param stream Stream for the asynchronous version.
+     */
+    CV_WRAP virtual void track(InputArray nextImg,
+                               InputArray prevPts, InputOutputArray nextPts,
+                               OutputArray status,
+                               OutputArray err = cv::noArray(),
+                               OutputArray fbErr = cv::noArray(),
+                               Stream& stream = Stream::Null()) = 0;
+
+    /** @brief Drops the cached pyramid of the previous frame, the next call of track starts a new sequence.
+     */
+    CV_WRAP virtual void resetTracking() = 0;
+
     CV_WRAP static Ptr<cuda::SparsePyrLKOpticalFlow> create(
             Size winSize = Size(21, 21),
             int maxLevel = 3,
@@ -510,6 +537,33 @@ public:
     */
     CV_WRAP virtual void convertToFloat(InputArray flow, InputOutputArray floatFlow) = 0;
 
+    /** @brief Calculates the optical flow between the previous frame of a sequence and the given one, without synchronizing with the host.
+    *
+    * Each frame is copied once to the hardware input buffers, which alternate between the input and the reference
+    * frame of successive calls, and two output buffers are used in turn so that the hardware computes the next flow while
+    * the previous one is still being converted. The flow is returned in floating point representation, upsampled to
+    * getGridSize() if the hardware uses a coarser grid, in a single kernel. Successive calls only wait for each other
+    * on the GPU: the flow is ready once the work queued in stream is, and one object per video allows several videos to
+    * be processed at once.
+
+    @param frame Next frame of the sequence, CV_8UC1 image of the size passed to create(), or the cudacodec::NV12 frame of
+                 that size returned by cudacodec::VideoReader, of which the luma plane is used. Pass a GpuMat to avoid the upload.
+    @param flow Buffer of type CV_32FC2 containing the flow vectors from the previous frame to frame, one flow vector for
+                gridSize x gridSize pixels. Pass a GpuMat to avoid the download. Released for the first frame of a sequence.
+    @param stream Stream on which frame is produced and flow is consumed.
+    @param usePreviousFlowAsHint Pass the flow vectors of the previous call as external hints for this one. Requires
+                                 enableExternalHints and a hint grid size equal to the output grid size of the hardware.
+                                 If external hints are enabled and this is false, zero hints are used.
+    @return false for the first frame of a sequence, for which no flow is computed.
+    @note The cost buffer is not filled by this function.
+    */
+    CV_WRAP virtual bool calcNext(InputArray frame, OutputArray flow, Stream& stream = Stream::Null(),
+        bool usePreviousFlowAsHint = false) = 0;
+
+    /** @brief Starts a new sequence, the next frame passed to calcNext() becomes its first frame.
+    */
+    CV_WRAP virtual void resetSequence() = 0;
+
     /** @brief Instantiate NVIDIA Optical Flow
 
     @param imageSize Size of input image in pixels.
@@ -94,6 +94,40 @@ void FlowUpsample(void* srcDevPtr, uint32_t nSrcWidth, uint32_t nSrcPitch, uint3
             0, dstDevPtr, nDstWidth, nDstPitch, nDstHeight,
             nScaleFactor);
 
+        checkCudaErrors(cudaGetLastError());
+}
+
+// converts the S10.5 flow vectors of the hardware grid to float, replicating each of them
+// nScaleFactor x nScaleFactor times in the output grid
+extern "C"
+__global__ void FlowToFloatKernel(const void* srcDevPtr, uint32_t src_w, uint32_t src_pitch, uint32_t src_h,
+                                  void* dstDevPtr, uint32_t dst_w, uint32_t dst_pitch, uint32_t dst_h,
+                                  uint32_t nScaleFactor)
+{
+    uint32_t x = blockDim.x * blockIdx.x + threadIdx.x;
+    uint32_t y = blockDim.y * blockIdx.y + threadIdx.y;
+
+    if (x >= dst_w || y >= dst_h)
+        return;
+
+    uint32_t x0 = min(x / nScaleFactor, src_w - 1);
+    uint32_t y0 = min(y / nScaleFactor, src_h - 1);
+
+    short2 v = *(const short2*)((const uint8_t*)srcDevPtr + y0 * src_pitch + (x0 << 2));
+    *(float2*)((uint8_t*)dstDevPtr + y * dst_pitch + (x << 3)) =
+        make_float2(v.x * (1.f / (1 << 5)), v.y * (1.f / (1 << 5)));
+}
+
+void FlowToFloat(const void* srcDevPtr, uint32_t nSrcWidth, uint32_t nSrcPitch, uint32_t nSrcHeight,
+                 void* dstDevPtr, uint32_t nDstWidth, uint32_t nDstPitch, uint32_t nDstHeight,
+                 uint32_t nScaleFactor, cudaStream_t stream)
+{
+        dim3 blockDim(BLOCKDIM_X, BLOCKDIM_Y);
+        dim3 gridDim((nDstWidth + blockDim.x - 1) / blockDim.x, (nDstHeight + blockDim.y - 1) / blockDim.y);
+        FlowToFloatKernel << <gridDim, blockDim, 0, stream >> > (srcDevPtr, nSrcWidth, nSrcPitch, nSrcHeight,
+            dstDevPtr, nDstWidth, nDstPitch, nDstHeight,
+            nScaleFactor);
+
         checkCudaErrors(cudaGetLastError());
 }}}}}
 #endif //defined(__CUDACC_VER_MAJOR__) && (10 <= __CUDACC_VER_MAJOR__)
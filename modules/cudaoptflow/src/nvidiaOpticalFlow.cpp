@@ -56,6 +56,10 @@ namespace cv { namespace cuda { namespace device { namespace optflow_nvidia
 void FlowUpsample(void* srcDevPtr, uint32_t nSrcWidth, uint32_t nSrcPitch, uint32_t nSrcHeight,
     void* dstDevPtr, uint32_t nDstWidth, uint32_t nDstPitch, uint32_t nDstHeight,
     uint32_t nScaleFactor);
+
+void FlowToFloat(const void* srcDevPtr, uint32_t nSrcWidth, uint32_t nSrcPitch, uint32_t nSrcHeight,
+    void* dstDevPtr, uint32_t nDstWidth, uint32_t nDstPitch, uint32_t nDstHeight,
+    uint32_t nScaleFactor, cudaStream_t stream);
 }}}}
 
 #if defined(_WIN32) || defined(_WIN64)
@@ -752,6 +756,18 @@ private:
     NV_OF_CUDA_BUFFER_STRIDE_INFO m_hintBufferStrideInfo;
     NV_OF_CUDA_BUFFER_STRIDE_INFO m_costBufferStrideInfo;
 
+    //calcNext() state: the input buffers alternate between input and reference frame,
+    //the output buffers are used in turn so that an execution does not wait for the
+    //conversion of the previous flow
+    int m_sequenceFrames;
+    NvOFGPUBufferHandle m_hOutputBuffers[2];
+    CUdeviceptr m_flowXYcuDevPtrs[2];
+    NV_OF_CUDA_BUFFER_STRIDE_INFO m_outputBuffersStrideInfo[2];
+    Event m_inputCopied;
+    Event m_executed[2];
+    Event m_converted[2];
+    GpuMat m_floatFlow;
+
     NV_OF_CUDA_API_FUNCTION_LIST* GetAPI()
     {
         std::lock_guard<std::mutex> lock(m_lock);
@@ -760,6 +776,22 @@ private:
 
     NvOFHandle GetHandle() { return m_hOF; }
 
+    GpuMat inputBuffer(int index)
+    {
+        return index == 0 ?
+            GpuMat(m_height, m_width, CV_8UC1, (void*)m_frame0cuDevPtr,
+                m_inputBufferStrideInfo.strideInfo[0].strideXInBytes) :
+            GpuMat(m_height, m_width, CV_8UC1, (void*)m_frame1cuDevPtr,
+                m_referenceBufferStrideInfo.strideInfo[0].strideXInBytes);
+    }
+
+    GpuMat outputBuffer(int index)
+    {
+        return GpuMat(Size((m_width + m_hwGridSize - 1) / m_hwGridSize,
+            (m_height + m_hwGridSize - 1) / m_hwGridSize), CV_16SC2,
+            (void*)m_flowXYcuDevPtrs[index], m_outputBuffersStrideInfo[index].strideInfo[0].strideXInBytes);
+    }
+
 protected:
     std::mutex m_lock;
 
@@ -777,6 +809,11 @@ public:
 
     virtual void convertToFloat(InputArray flow, InputOutputArray floatFlow);
 
+    virtual bool calcNext(InputArray frame, OutputArray flow, Stream& stream = Stream::Null(),
+        bool usePreviousFlowAsHint = false);
+
+    virtual void resetSequence() { m_sequenceFrames = 0; }
+
     virtual int getGridSize() const { return m_gridSize; }
 };
 
@@ -793,7 +830,7 @@ NvidiaOpticalFlowImpl_2::NvidiaOpticalFlowImpl_2(
     m_enableCostBuffer((NV_OF_BOOL)bEnableCostBuffer), m_gpuId(gpuId),
     m_inputStream(inputStream), m_outputStream(outputStream),
     m_cuContext(nullptr), m_scaleFactor(1), m_format(NV_OF_BUFFER_FORMAT_GRAYSCALE8),
-    m_hwGridSize((NV_OF_OUTPUT_VECTOR_GRID_SIZE)0)
+    m_hwGridSize((NV_OF_OUTPUT_VECTOR_GRID_SIZE)0), m_sequenceFrames(0)
 {
     LoadNvidiaModules& LoadNvidiaModulesObj = LoadNvidiaModules::Init();
 
@@ -968,6 +1005,13 @@ NvidiaOpticalFlowImpl_2::NvidiaOpticalFlowImpl_2(
     NVOF_API_CALL(GetAPI()->nvOFGPUBufferGetStrideInfo(
         m_hOutputBuffer, &m_outputBufferStrideInfo));
 
+    //the second output buffer of calcNext() is only created on its first use
+    m_hOutputBuffers[0] = m_hOutputBuffer;
+    m_hOutputBuffers[1] = nullptr;
+    m_flowXYcuDevPtrs[0] = m_flowXYcuDevPtr;
+    m_flowXYcuDevPtrs[1] = 0;
+    m_outputBuffersStrideInfo[0] = m_outputBufferStrideInfo;
+
     if (m_scaleFactor > 1)
     {
         m_outputBufferDesc.width = (m_width + m_gridSize - 1) / m_gridSize;;
@@ -1140,6 +1184,125 @@ void NvidiaOpticalFlowImpl_2::calc(InputArray _frame0, InputArray _frame1, Input
     m_outputStream.waitForCompletion();
 }
 
+bool NvidiaOpticalFlowImpl_2::calcNext(InputArray _frame, OutputArray _flow, Stream& stream,
+    bool usePreviousFlowAsHint)
+{
+    //the luma plane of NV12 frames is used as is
+    CV_Assert(_frame.type() == CV_8UC1 && _frame.size().width == m_width);
+    CV_Assert(_frame.size().height == m_height || _frame.size().height == m_height * 3 / 2);
+    if (usePreviousFlowAsHint)
+    {
+        if (!m_enableExternalHints)
+            CV_Error(Error::StsBadArg, "Using the previous flow as hint requires enableExternalHints");
+        if ((int)m_hintGridSize != (int)m_hwGridSize)
+            CV_Error(Error::StsBadArg, "Using the previous flow as hint requires a hint grid size equal to the hardware output grid size");
+    }
+
+    if (!m_hOutputBuffers[1])
+    {
+        NV_OF_BUFFER_DESCRIPTOR outputBufferDesc = m_outputBufferDesc;
+        outputBufferDesc.width = (m_width + m_hwGridSize - 1) / m_hwGridSize;
+        outputBufferDesc.height = (m_height + m_hwGridSize - 1) / m_hwGridSize;
+        NVOF_API_CALL(GetAPI()->nvOFCreateGPUBufferCuda(GetHandle(),
+            &outputBufferDesc, NV_OF_CUDA_BUFFER_TYPE_CUDEVICEPTR, &m_hOutputBuffers[1]));
+        m_flowXYcuDevPtrs[1] = GetAPI()->nvOFGPUBufferGetCUdeviceptr(m_hOutputBuffers[1]);
+        NVOF_API_CALL(GetAPI()->nvOFGPUBufferGetStrideInfo(
+            m_hOutputBuffers[1], &m_outputBuffersStrideInfo[1]));
+
+        m_inputCopied = Event(Event::DISABLE_TIMING);
+        for (int i = 0; i < 2; i++)
+        {
+            m_executed[i] = Event(Event::DISABLE_TIMING);
+            m_converted[i] = Event(Event::DISABLE_TIMING);
+        }
+    }
+
+    //frame n is written to the input buffer n % 2, the flow of execution n to the output buffer n % 2
+    const int n = m_sequenceFrames;
+    const int cur = n % 2, prev = 1 - cur;
+
+    //the input buffer was last read by the previous execution
+    if (n >= 2)
+        stream.waitEvent(m_executed[prev]);
+    GpuMat frameBuffer = inputBuffer(cur);
+    if (_frame.isGpuMat())
+        _frame.getGpuMat().rowRange(0, m_height).copyTo(frameBuffer, stream);
+    else if (_frame.isMat())
+        frameBuffer.upload(_frame.getMat().rowRange(0, m_height), stream);
+    else
+        CV_Error(Error::StsBadArg, "Incorrect input. Pass frame as Mat or GpuMat");
+
+    m_sequenceFrames++;
+    if (n == 0)
+    {
+        _flow.release();
+        return false;
+    }
+
+    m_inputCopied.record(stream);
+    m_inputStream.waitEvent(m_inputCopied);
+    //the output buffer is still read by the conversion of execution n - 2
+    if (n >= 3)
+        m_inputStream.waitEvent(m_converted[cur]);
+
+    if (m_enableExternalHints)
+    {
+        GpuMat hintGpuMat(outputBuffer(0).size(), CV_16SC2, (void*)m_hintcuDevPtr,
+            m_hintBufferStrideInfo.strideInfo[0].strideXInBytes);
+        if (usePreviousFlowAsHint && n >= 2)
+        {
+            m_inputStream.waitEvent(m_executed[prev]);
+            outputBuffer(prev).copyTo(hintGpuMat, m_inputStream);
+        }
+        else
+        {
+            hintGpuMat.setTo(Scalar::all(0), m_inputStream);
+        }
+    }
+
+    NV_OF_EXECUTE_INPUT_PARAMS exeInParams;
+    NV_OF_EXECUTE_OUTPUT_PARAMS exeOutParams;
+    memset(&exeInParams, 0, sizeof(exeInParams));
+    exeInParams.inputFrame = prev == 0 ? m_hInputBuffer : m_hReferenceBuffer;
+    exeInParams.referenceFrame = cur == 0 ? m_hInputBuffer : m_hReferenceBuffer;
+    exeInParams.disableTemporalHints = (NV_OF_BOOL)m_enableTemporalHints == NV_OF_TRUE ?
+        NV_OF_FALSE : NV_OF_TRUE;
+    exeInParams.externalHints = m_initParams.enableExternalHints == NV_OF_TRUE ?
+        m_hHintBuffer : nullptr;
+    exeInParams.numRois = m_initParams.enableRoi == NV_OF_TRUE ? m_roiDataRect.size() : 0;
+    exeInParams.roiData = m_initParams.enableRoi == NV_OF_TRUE ? m_roiData : nullptr;
+    memset(&exeOutParams, 0, sizeof(exeOutParams));
+    exeOutParams.outputBuffer = m_hOutputBuffers[cur];
+    exeOutParams.outputCostBuffer = m_initParams.enableOutputCost == NV_OF_TRUE ?
+        m_hCostBuffer : nullptr;
+    NVOF_API_CALL(GetAPI()->nvOFExecute(GetHandle(), &exeInParams, &exeOutParams));
+    m_executed[cur].record(m_outputStream);
+
+    //upsampling to the requested grid and conversion to float in one pass, on the caller's stream
+    stream.waitEvent(m_executed[cur]);
+    const GpuMat hwFlow = outputBuffer(cur);
+    const Size flowSize((m_width + m_gridSize - 1) / m_gridSize, (m_height + m_gridSize - 1) / m_gridSize);
+    GpuMat floatFlow;
+    if (_flow.isGpuMat())
+    {
+        _flow.create(flowSize, CV_32FC2);
+        floatFlow = _flow.getGpuMat();
+    }
+    else
+    {
+        m_floatFlow.create(flowSize, CV_32FC2);
+        floatFlow = m_floatFlow;
+    }
+    cv::cuda::device::optflow_nvidia::FlowToFloat(hwFlow.data, hwFlow.cols, (uint32_t)hwFlow.step,
+        hwFlow.rows, floatFlow.data, floatFlow.cols, (uint32_t)floatFlow.step, floatFlow.rows,
+        m_scaleFactor, StreamAccessor::getStream(stream));
+    m_converted[cur].record(stream);
+
+    if (!_flow.isGpuMat())
+        floatFlow.download(_flow, stream);
+    return true;
+}
+
 void NvidiaOpticalFlowImpl_2::collectGarbage()
 {
     if (m_enableROI)
@@ -1162,6 +1325,12 @@ void NvidiaOpticalFlowImpl_2::collectGarbage()
     {
         NVOF_API_CALL(GetAPI()->nvOFDestroyGPUBufferCuda(m_hOutputUpScaledBuffer));
     }
+    if (m_hOutputBuffers[1])
+    {
+        NVOF_API_CALL(GetAPI()->nvOFDestroyGPUBufferCuda(m_hOutputBuffers[1]));
+        m_hOutputBuffers[1] = nullptr;
+    }
+    m_floatFlow.release();
     if (m_enableExternalHints)
     {
         if (m_hHintBuffer)
@@ -1192,6 +1361,19 @@ void NvidiaOpticalFlowImpl_2::collectGarbage()
 
 void NvidiaOpticalFlowImpl_2::convertToFloat(InputArray _flow, InputOutputArray floatFlow)
 {
+    if (_flow.isGpuMat() && floatFlow.isGpuMat())
+    {
+        //stays on the device
+        GpuMat flow = _flow.getGpuMat();
+        CV_Assert(flow.channels() == 2 && flow.elemSize1() == sizeof(int16_t));
+        floatFlow.create(flow.size(), CV_32FC2);
+        GpuMat output = floatFlow.getGpuMat();
+        cv::cuda::device::optflow_nvidia::FlowToFloat(flow.data, flow.cols, (uint32_t)flow.step,
+            flow.rows, output.data, output.cols, (uint32_t)output.step, output.rows, 1, 0);
+        cuSafeCall(cudaStreamSynchronize(0));
+        return;
+    }
+
     Mat flow;
     if (_flow.isMat())
     {
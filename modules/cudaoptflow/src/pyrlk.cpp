@@ -302,7 +302,7 @@ namespace
     {
     public:
         SparsePyrLKOpticalFlowImpl(Size winSize, int maxLevel, int iters, bool useInitialFlow) :
-            PyrLKOpticalFlowBase(winSize, maxLevel, iters, useInitialFlow)
+            PyrLKOpticalFlowBase(winSize, maxLevel, iters, useInitialFlow), trackIdx_(0)
         {
         }
 
@@ -348,7 +348,106 @@ namespace
             }
         }
 
+        virtual void track(InputArray _nextImg,
+                           InputArray _prevPts, InputOutputArray _nextPts,
+                           OutputArray _status,
+                           OutputArray _err,
+                           OutputArray _fbErr,
+                           Stream& stream)
+        {
+            const GpuMat nextImg = _nextImg.getGpuMat();
+            const GpuMat prevPts = _prevPts.getGpuMat();
+            GpuMat& nextPts = _nextPts.getGpuMatRef();
+            GpuMat& status = _status.getGpuMatRef();
+            GpuMat* err = _err.needed() ? &(_err.getGpuMatRef()) : NULL;
+            GpuMat* fbErr = _fbErr.needed() ? &(_fbErr.getGpuMatRef()) : NULL;
+
+            CV_Assert( nextImg.channels() == 1 || nextImg.channels() == 3 || nextImg.channels() == 4 );
+            CV_Assert( maxLevel_ >= 0 );
+
+            std::vector<GpuMat>& prevPyr = trackPyr_[trackIdx_];
+            std::vector<GpuMat>& nextPyr = trackPyr_[trackIdx_ ^ 1];
+
+            const bool hasPrev = !prevPyr.empty();
+            if (hasPrev)
+                CV_Assert( prevPyr[0].size() == nextImg.size() && prevPyr[0].type() == nextImg.type() );
+
+            // keep an own copy of the frame, the caller may reuse its buffer for the next one
+            nextPyr.resize(maxLevel_ + 1);
+            nextImg.copyTo(nextPyr[0], stream);
+            for (int level = 1; level <= maxLevel_; ++level)
+                cuda::pyrDown(nextPyr[level - 1], nextPyr[level], stream);
+
+            // the number of levels has been changed since the previous frame
+            if (hasPrev && prevPyr.size() != nextPyr.size())
+            {
+                prevPyr.resize(maxLevel_ + 1);
+                for (int level = 1; level <= maxLevel_; ++level)
+                    cuda::pyrDown(prevPyr[level - 1], prevPyr[level], stream);
+            }
+
+            trackIdx_ ^= 1;
+
+            if (prevPts.empty())
+            {
+                nextPts.release();
+                status.release();
+                if (err) err->release();
+                if (fbErr) fbErr->release();
+                return;
+            }
+
+            if (!hasPrev)
+            {
+                prevPts.copyTo(nextPts, stream);
+                ensureSizeIsEnough(1, prevPts.cols, CV_8UC1, status);
+                status.setTo(Scalar::all(1), stream);
+                if (err)
+                {
+                    ensureSizeIsEnough(1, prevPts.cols, CV_32FC1, *err);
+                    err->setTo(Scalar::all(0), stream);
+                }
+                if (fbErr)
+                {
+                    ensureSizeIsEnough(1, prevPts.cols, CV_32FC1, *fbErr);
+                    fbErr->setTo(Scalar::all(0), stream);
+                }
+                return;
+            }
+
+            sparse(prevPyr, nextPyr, prevPts, nextPts, status, err, stream);
+
+            if (fbErr)
+            {
+                BufferPool pool(stream);
+                GpuMat backPts = pool.getBuffer(1, prevPts.cols, CV_32FC2);
+                GpuMat backStatus = pool.getBuffer(1, prevPts.cols, CV_8UC1);
+
+                // track back from the found positions
+                const bool useInitialFlow = useInitialFlow_;
+                useInitialFlow_ = false;
+                sparse(nextPyr, prevPyr, nextPts, backPts, backStatus, NULL, stream);
+                useInitialFlow_ = useInitialFlow;
+
+                cuda::subtract(backPts, prevPts, backPts, noArray(), -1, stream);
+                cuda::magnitude(backPts, *fbErr, stream);
+                cuda::bitwise_and(status, backStatus, status, noArray(), stream);
+            }
+        }
+
+        virtual void resetTracking()
+        {
+            trackPyr_[0].clear();
+            trackPyr_[1].clear();
+            trackIdx_ = 0;
+        }
+
         virtual String getDefaultName() const { return "SparseOpticalFlow.SparsePyrLKOpticalFlow"; }
+
+    private:
+        // pyramids of the two last frames of track, trackPyr_[trackIdx_] is the previous one
+        std::vector<GpuMat> trackPyr_[2];
+        int trackIdx_;
     };
 
     class DensePyrLKOpticalFlowImpl : public DensePyrLKOpticalFlow, private PyrLKOpticalFlowBase
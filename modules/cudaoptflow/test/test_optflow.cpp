@@ -271,6 +271,76 @@ INSTANTIATE_TEST_CASE_P(CUDA_OptFlow, PyrLKOpticalFlow, testing::Combine(
     testing::Values(Chan(1), Chan(3), Chan(4)),
     testing::Values(DataType(CV_8U), DataType(CV_16U), DataType(CV_32S), DataType(CV_32F))));
 
+PARAM_TEST_CASE(PyrLKOpticalFlowTrack, cv::cuda::DeviceInfo)
+{
+    cv::cuda::DeviceInfo devInfo;
+
+    virtual void SetUp()
+    {
+        devInfo = GET_PARAM(0);
+        cv::cuda::setDevice(devInfo.deviceID());
+    }
+};
+
+CUDA_TEST_P(PyrLKOpticalFlowTrack, Accuracy)
+{
+    cv::Mat frame0 = readImage("opticalflow/frame0.png", cv::IMREAD_GRAYSCALE);
+    ASSERT_FALSE(frame0.empty());
+
+    cv::Mat frame1 = readImage("opticalflow/frame1.png", cv::IMREAD_GRAYSCALE);
+    ASSERT_FALSE(frame1.empty());
+
+    std::vector<cv::Point2f> pts;
+    cv::goodFeaturesToTrack(frame0, pts, 1000, 0.01, 0.0);
+
+    cv::cuda::GpuMat d_pts;
+    cv::Mat pts_mat(1, (int) pts.size(), CV_32FC2, (void*) &pts[0]);
+    d_pts.upload(pts_mat);
+
+    cv::Ptr<cv::cuda::SparsePyrLKOpticalFlow> pyrLK =
+            cv::cuda::SparsePyrLKOpticalFlow::create();
+
+    cv::cuda::GpuMat d_nextPts_gold, d_status_gold;
+    pyrLK->calc(loadMat(frame0), loadMat(frame1), d_pts, d_nextPts_gold, d_status_gold);
+
+    // the first frame only fills the cache
+    cv::cuda::GpuMat d_nextPts, d_status, d_fbErr;
+    pyrLK->track(loadMat(frame0), d_pts, d_nextPts, d_status);
+    EXPECT_MAT_NEAR(d_pts, d_nextPts, 0.0);
+
+    pyrLK->track(loadMat(frame1), d_pts, d_nextPts, d_status, cv::noArray(), d_fbErr);
+
+    cv::Mat status_gold(d_status_gold), status(d_status);
+    cv::Mat fbErr(d_fbErr);
+    ASSERT_EQ(CV_32FC1, fbErr.type());
+    ASSERT_EQ(d_pts.cols, fbErr.cols);
+
+    EXPECT_MAT_NEAR(d_nextPts_gold, d_nextPts, 0.0);
+
+    int tracked = 0, consistent = 0;
+    for (int i = 0; i < status.cols; ++i)
+    {
+        // tracking back can only drop points
+        EXPECT_LE(status.at<uchar>(i), status_gold.at<uchar>(i));
+
+        if (status.at<uchar>(i))
+        {
+            ++tracked;
+            if (fbErr.at<float>(i) < 1.f)
+                ++consistent;
+        }
+    }
+
+    ASSERT_GT(tracked, 0);
+    ASSERT_GE(consistent, tracked * 0.9);
+
+    pyrLK->resetTracking();
+    pyrLK->track(loadMat(frame1), d_pts, d_nextPts, d_status);
+    EXPECT_MAT_NEAR(d_pts, d_nextPts, 0.0);
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_OptFlow, PyrLKOpticalFlowTrack, ALL_DEVICES);
+
 
 
 //////////////////////////////////////////////////////
@@ -643,6 +713,50 @@ CUDA_TEST_P(NvidiaOpticalFlow_2_0, OpticalFlowNan)
     d_nvof->collectGarbage();
 };
 
+CUDA_TEST_P(NvidiaOpticalFlow_2_0, CalcNext)
+{
+    cv::Mat frame0 = readImage("opticalflow/frame0.png", cv::IMREAD_GRAYSCALE);
+    ASSERT_FALSE(frame0.empty());
+
+    cv::Mat frame1 = readImage("opticalflow/frame1.png", cv::IMREAD_GRAYSCALE);
+    ASSERT_FALSE(frame1.empty());
+
+    cv::Ptr<cv::cuda::NvidiaOpticalFlow_2_0> d_nvof;
+    try
+    {
+        d_nvof = cv::cuda::NvidiaOpticalFlow_2_0::create(frame0.size(),
+            cv::cuda::NvidiaOpticalFlow_2_0::NVIDIA_OF_PERF_LEVEL::NV_OF_PERF_LEVEL_SLOW);
+    }
+    catch (const cv::Exception& e)
+    {
+        if (e.code == Error::StsBadFunc || e.code == Error::StsBadArg || e.code == Error::StsNullPtr)
+            throw SkipTestException("Current configuration is not supported");
+        throw;
+    }
+
+    Mat flow;
+    d_nvof->calc(loadMat(frame0), loadMat(frame1), flow);
+    Mat expected;
+    d_nvof->convertToFloat(flow, expected);
+
+    // NV12 frame: the luma plane is followed by the interleaved chroma rows
+    cv::Mat nv12;
+    cv::vconcat(frame1, cv::Mat(frame1.rows / 2, frame1.cols, CV_8UC1, cv::Scalar::all(128)), nv12);
+
+    cv::cuda::Stream stream;
+    cv::cuda::GpuMat d_flow;
+    EXPECT_FALSE(d_nvof->calcNext(loadMat(frame0), d_flow, stream));
+    EXPECT_TRUE(d_flow.empty());
+    EXPECT_TRUE(d_nvof->calcNext(loadMat(nv12), d_flow, stream));
+    stream.waitForCompletion();
+
+    EXPECT_MAT_NEAR(expected, d_flow, 0);
+
+    d_nvof->resetSequence();
+    EXPECT_FALSE(d_nvof->calcNext(loadMat(frame0), d_flow, stream));
+    d_nvof->collectGarbage();
+}
+
 INSTANTIATE_TEST_CASE_P(CUDA_OptFlow, NvidiaOpticalFlow_2_0, ALL_DEVICES);
 
 }} // namespace
@@ -272,6 +272,14 @@ public:
     @sa compute
     */
     CV_WRAP_AS(compute_with_stream) virtual void compute(InputArray left, InputArray right, OutputArray disparity, Stream& stream) = 0;
+
+    /** @brief Aggregates the path costs with packed 8-bit arithmetics, four disparities per instruction.
+
+    The path costs are stored as 8-bit values in both cases. The result is the same as the default one as long as
+    P2 <= 223, larger P2 values saturate the costs. Disabled by default.
+    */
+    CV_WRAP virtual void setUsePackedCosts(bool usePackedCosts) = 0;
+    CV_WRAP virtual bool getUsePackedCosts() const = 0;
 };
 
 /** @brief Creates StereoSGM object.
@@ -288,6 +296,44 @@ It will consume O(W\*H\*numDisparities) bytes. By default, it is set to StereoSG
 */
 CV_EXPORTS_W Ptr<cuda::StereoSGM> createStereoSGM(int minDisparity = 0, int numDisparities = 128, int P1 = 10, int P2 = 120, int uniquenessRatio = 5, int mode = cv::cuda::StereoSGM::MODE_HH4);
 
+/////////////////////////////////////////
+// StereoMultiDevice
+
+/** @brief Runs a CUDA stereo matcher on several devices, each of them matching a horizontal band of the image pair.
+
+The image pair is split into one band of rows per device. Every band is extended by overlap rows above and below, so
+that the aggregation paths of StereoSGM and the messages of StereoBeliefPropagation / StereoConstantSpaceBP crossing the
+band borders are approximated, the extension is dropped when the disparity bands are stitched. The matchers of the
+devices are copies of the prototype matcher made when its parameters are read by the first compute call.
+
+The devices work in parallel, compute returns when all of them have finished. The inputs can be host matrices or
+GpuMat on the current device, the disparity map is created on the current device for GpuMat outputs.
+ */
+class CV_EXPORTS_W StereoMultiDevice : public cv::StereoMatcher
+{
+public:
+    using cv::StereoMatcher::compute;
+
+    CV_WRAP virtual void compute(InputArray left, InputArray right, OutputArray disparity, Stream& stream) = 0;
+
+    CV_WRAP virtual std::vector<int> getDevices() const = 0;
+
+    //! number of rows added above and below of each band
+    CV_WRAP virtual int getOverlap() const = 0;
+    CV_WRAP virtual void setOverlap(int overlap) = 0;
+};
+
+/** @brief Creates StereoMultiDevice object.
+
+@param matcher Prototype matcher, cuda::StereoSGM, cuda::StereoBeliefPropagation, cuda::StereoConstantSpaceBP or
+cuda::StereoBM. Changes of its parameters are applied to the device matchers on the next compute call.
+@param devices Devices to run on. An empty vector means all the CUDA devices.
+@param overlap Number of rows added above and below of each band. Message passing with several levels needs about
+\f$2^{levels}\f$ rows more than SGM.
+ */
+CV_EXPORTS_W Ptr<cuda::StereoMultiDevice>
+    createStereoMultiDevice(const Ptr<cv::StereoMatcher>& matcher, const std::vector<int>& devices = std::vector<int>(), int overlap = 32);
+
 /////////////////////////////////////////
 // DisparityBilateralFilter
 
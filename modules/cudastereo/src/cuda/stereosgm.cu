@@ -16,6 +16,8 @@
 #include "stereosgm.hpp"
 #include "opencv2/cudev/common.hpp"
 #include "opencv2/cudev/warp/warp.hpp"
+#include "opencv2/cudev/util/simd_functions.hpp"
+#include <type_traits>
 #include "opencv2/cudastereo.hpp"
 
 namespace cv { namespace cuda { namespace device {
@@ -282,6 +284,22 @@ __device__ inline void store_uint8_vector<16u>(uint8_t *dest, const uint32_t *pt
 }
 
 
+template <unsigned int N>
+__device__ inline void store_packed_uint8_vector(uint8_t *dest, const uint32_t *ptr);
+
+template <>
+__device__ inline void store_packed_uint8_vector<2u>(uint8_t *dest, const uint32_t *ptr)
+{
+    store_as<uint2>(dest, make_uint2(ptr[0], ptr[1]));
+}
+
+template <>
+__device__ inline void store_packed_uint8_vector<4u>(uint8_t *dest, const uint32_t *ptr)
+{
+    store_as<uint4>(dest, make_uint4(ptr[0], ptr[1], ptr[2], ptr[3]));
+}
+
+
 template <unsigned int N>
 __device__ inline void load_uint16_vector(uint32_t *dest, const uint16_t *ptr);
 
@@ -550,10 +568,107 @@ template <
         }
         last_min = subgroup_min<WARPS_PER_BLOCK, SUBGROUP_SIZE>(local_min, mask);
     }
+
+    __device__ void store(uint8_t *dest) const
+    {
+        store_uint8_vector<DP_BLOCK_SIZE>(dest, dp);
+    }
+};
+
+template <
+    unsigned int DP_BLOCK_SIZE,
+    unsigned int SUBGROUP_SIZE,
+    unsigned int WARPS_PER_BLOCK>
+    struct PackedDynamicProgramming
+{
+    static_assert(
+        DP_BLOCK_SIZE % 4 == 0,
+        "DP_BLOCK_SIZE must be a multiple of 4");
+    static_assert(
+        (SUBGROUP_SIZE & (SUBGROUP_SIZE - 1)) == 0,
+        "SUBGROUP_SIZE must be a power of 2");
+
+    static constexpr unsigned int NUM_WORDS = DP_BLOCK_SIZE / 4;
+
+    uint32_t last_min;
+    // four 8-bit costs per word, byte b of dp[w] is the cost of disparity 4 * w + b
+    uint32_t dp[NUM_WORDS];
+
+    __device__ PackedDynamicProgramming()
+        : last_min(0)
+    {
+        for (unsigned int i = 0; i < NUM_WORDS; ++i)
+        {
+            dp[i] = 0;
+        }
+    }
+
+    // Same recurrence as DynamicProgramming::update, computed for four disparities
+    // at once with saturated 8-bit arithmetics. The costs never exceed p2 + 32,
+    // so the results are exact as long as p2 <= 223.
+    __device__ void update(
+        uint32_t *local_costs, uint32_t p1, uint32_t p2, uint32_t mask)
+    {
+        const unsigned int lane_id = threadIdx.x % SUBGROUP_SIZE;
+
+        const uint32_t prev = detail::shfl_up<WARPS_PER_BLOCK>(dp[NUM_WORDS - 1], 1, cudev::WARP_SIZE, mask);
+        const uint32_t next = detail::shfl_down<WARPS_PER_BLOCK>(dp[0], 1, cudev::WARP_SIZE, mask);
+
+        const uint32_t last_min4 = last_min * 0x01010101u;
+        const uint32_t p1_4 = ::min(p1, 255u) * 0x01010101u;
+        const uint32_t p2_4 = ::min(p2, 255u) * 0x01010101u;
+
+        uint32_t out[NUM_WORDS];
+        uint32_t local_min = 0xffffffffu;
+        for (unsigned int i = 0; i < NUM_WORDS; ++i)
+        {
+            // costs of the disparities d - 1 and d + 1, the missing bytes come from the neighbouring words
+            const uint32_t lower = __byte_perm(dp[i], i == 0 ? prev : dp[i - 1], 0x2107);
+            const uint32_t upper = __byte_perm(dp[i], i + 1 == NUM_WORDS ? next : dp[i + 1], 0x4321);
+
+            uint32_t lower_cost = cudev::vadd4(cudev::vsub4(lower, last_min4), p1_4);
+            uint32_t upper_cost = cudev::vadd4(cudev::vsub4(upper, last_min4), p1_4);
+            if (i == 0 && lane_id == 0)
+            {
+                lower_cost |= 0x000000ffu;
+            }
+            if (i + 1 == NUM_WORDS && lane_id + 1 == SUBGROUP_SIZE)
+            {
+                upper_cost |= 0xff000000u;
+            }
+
+            uint32_t o = cudev::vmin4(cudev::vsub4(dp[i], last_min4), p2_4);
+            o = cudev::vmin4(o, cudev::vmin4(lower_cost, upper_cost));
+            out[i] = cudev::vadd4(o, pack_uint8x4(
+                local_costs[4 * i + 0], local_costs[4 * i + 1], local_costs[4 * i + 2], local_costs[4 * i + 3]));
+            local_min = cudev::vmin4(local_min, out[i]);
+        }
+        for (unsigned int i = 0; i < NUM_WORDS; ++i)
+        {
+            dp[i] = out[i];
+        }
+        local_min = cudev::vmin4(local_min, local_min >> 16);
+        local_min = cudev::vmin4(local_min, local_min >> 8);
+        last_min = subgroup_min<WARPS_PER_BLOCK, SUBGROUP_SIZE>(local_min & 0xffu, mask);
+    }
+
+    __device__ void store(uint8_t *dest) const
+    {
+        store_packed_uint8_vector<NUM_WORDS>(dest, dp);
+    }
+};
+
+template <bool PACKED, unsigned int DP_BLOCK_SIZE, unsigned int SUBGROUP_SIZE, unsigned int WARPS_PER_BLOCK>
+struct PathDynamicProgramming
+{
+    typedef typename std::conditional<PACKED,
+        PackedDynamicProgramming<DP_BLOCK_SIZE, SUBGROUP_SIZE, WARPS_PER_BLOCK>,
+        DynamicProgramming<DP_BLOCK_SIZE, SUBGROUP_SIZE, WARPS_PER_BLOCK> >::type type;
 };
 
 template <unsigned int SIZE>
 __device__ unsigned int generate_mask()
+
 {
     static_assert(SIZE <= 32, "SIZE must be less than or equal to 32");
     return static_cast<unsigned int>((1ull << SIZE) - 1u);
@@ -570,7 +685,7 @@ static constexpr unsigned int WARPS_PER_BLOCK = 4u;
 static constexpr unsigned int BLOCK_SIZE = cudev::WARP_SIZE * WARPS_PER_BLOCK;
 
 
-template <int DIRECTION, unsigned int MAX_DISPARITY>
+template <int DIRECTION, unsigned int MAX_DISPARITY, bool PACKED>
 __global__ void aggregate_horizontal_path_kernel(
     PtrStep<int32_t> left,
     PtrStep<int32_t> right,
@@ -595,7 +710,7 @@ __global__ void aggregate_horizontal_path_kernel(
     }
 
     int32_t right_buffer[DP_BLOCKS_PER_THREAD][DP_BLOCK_SIZE];
-    DynamicProgramming<DP_BLOCK_SIZE, SUBGROUP_SIZE, WARPS_PER_BLOCK> dp[DP_BLOCKS_PER_THREAD];
+    typename PathDynamicProgramming<PACKED, DP_BLOCK_SIZE, SUBGROUP_SIZE, WARPS_PER_BLOCK>::type dp[DP_BLOCKS_PER_THREAD];
 
     const unsigned int warp_id = cudev::Warp::warpId();
     const unsigned int group_id = cudev::Warp::laneId() / SUBGROUP_SIZE;
@@ -707,9 +822,7 @@ __global__ void aggregate_horizontal_path_kernel(
                     local_costs[k] = __popc(left_value ^ right_buffer[j][k]);
                 }
                 dp[j].update(local_costs, p1, p2, shfl_mask);
-                store_uint8_vector<DP_BLOCK_SIZE>(
-                    &dest(0, j * dest_step + x * MAX_DISPARITY + dp_offset),
-                    dp[j].dp);
+                dp[j].store(&dest(0, j * dest_step + x * MAX_DISPARITY + dp_offset));
             }
         }
         x0 += static_cast<int>(DP_BLOCK_SIZE) * DIRECTION;
@@ -725,7 +838,8 @@ void aggregateLeft2RightPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream)
+    Stream& _stream,
+    bool packed)
 {
     CV_Assert(left.size() == right.size());
     CV_Assert(left.type() == right.type());
@@ -737,8 +851,12 @@ void aggregateLeft2RightPath(
     const int gdim = cudev::divUp(left.rows, PATHS_PER_BLOCK);
     const int bdim = BLOCK_SIZE;
     cudaStream_t stream = cv::cuda::StreamAccessor::getStream(_stream);
-    aggregate_horizontal_path_kernel<1, MAX_DISPARITY><<<gdim, bdim, 0, stream>>>(
-        left, right, dest, left.cols, left.rows, p1, p2, min_disp);
+    if (packed)
+        aggregate_horizontal_path_kernel<1, MAX_DISPARITY, true><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, left.cols, left.rows, p1, p2, min_disp);
+    else
+        aggregate_horizontal_path_kernel<1, MAX_DISPARITY, false><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, left.cols, left.rows, p1, p2, min_disp);
 }
 
 template <unsigned int MAX_DISPARITY>
@@ -749,7 +867,8 @@ void aggregateRight2LeftPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream)
+    Stream& _stream,
+    bool packed)
 {
     CV_Assert(left.size() == right.size());
     CV_Assert(left.type() == right.type());
@@ -761,8 +880,12 @@ void aggregateRight2LeftPath(
     const int gdim = cudev::divUp(left.rows, PATHS_PER_BLOCK);
     const int bdim = BLOCK_SIZE;
     cudaStream_t stream = cv::cuda::StreamAccessor::getStream(_stream);
-    aggregate_horizontal_path_kernel<-1, MAX_DISPARITY><<<gdim, bdim, 0, stream>>>(
-        left, right, dest, left.cols, left.rows, p1, p2, min_disp);
+    if (packed)
+        aggregate_horizontal_path_kernel<-1, MAX_DISPARITY, true><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, left.cols, left.rows, p1, p2, min_disp);
+    else
+        aggregate_horizontal_path_kernel<-1, MAX_DISPARITY, false><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, left.cols, left.rows, p1, p2, min_disp);
 }
 
 
@@ -773,7 +896,8 @@ template CV_EXPORTS void aggregateLeft2RightPath<64u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream);
+    Stream& _stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateLeft2RightPath<128u>(
     const GpuMat& left,
@@ -782,7 +906,8 @@ template CV_EXPORTS void aggregateLeft2RightPath<128u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream);
+    Stream& _stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateLeft2RightPath<256u>(
     const GpuMat& left,
@@ -791,7 +916,8 @@ template CV_EXPORTS void aggregateLeft2RightPath<256u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream);
+    Stream& _stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateRight2LeftPath<64u>(
     const GpuMat& left,
@@ -800,7 +926,8 @@ template CV_EXPORTS void aggregateRight2LeftPath<64u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream);
+    Stream& _stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateRight2LeftPath<128u>(
     const GpuMat& left,
@@ -809,7 +936,8 @@ template CV_EXPORTS void aggregateRight2LeftPath<128u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream);
+    Stream& _stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateRight2LeftPath<256u>(
     const GpuMat& left,
@@ -818,7 +946,8 @@ template CV_EXPORTS void aggregateRight2LeftPath<256u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream);
+    Stream& _stream,
+    bool packed);
 } // namespace horizontal
 
 namespace vertical
@@ -829,7 +958,7 @@ static constexpr unsigned int DP_BLOCK_SIZE = 16u;
 static constexpr unsigned int WARPS_PER_BLOCK = 8u;
 static constexpr unsigned int BLOCK_SIZE = cudev::WARP_SIZE * WARPS_PER_BLOCK;
 
-template <int DIRECTION, unsigned int MAX_DISPARITY>
+template <int DIRECTION, unsigned int MAX_DISPARITY, bool PACKED>
 __global__ void aggregate_vertical_path_kernel(
     PtrStep<int32_t> left,
     PtrStep<int32_t> right,
@@ -854,7 +983,7 @@ __global__ void aggregate_vertical_path_kernel(
     }
 
     __shared__ int32_t right_buffer[2 * DP_BLOCK_SIZE][RIGHT_BUFFER_ROWS + 1];
-    DynamicProgramming<DP_BLOCK_SIZE, SUBGROUP_SIZE, WARPS_PER_BLOCK> dp;
+    typename PathDynamicProgramming<PACKED, DP_BLOCK_SIZE, SUBGROUP_SIZE, WARPS_PER_BLOCK>::type dp;
 
     const unsigned int warp_id = cudev::Warp::warpId();
     const unsigned int group_id = cudev::Warp::laneId() / SUBGROUP_SIZE;
@@ -919,9 +1048,7 @@ __global__ void aggregate_vertical_path_kernel(
                 local_costs[j] = __popc(left_value ^ right_values[j]);
             }
             dp.update(local_costs, p1, p2, shfl_mask);
-            store_uint8_vector<DP_BLOCK_SIZE>(
-                &dest(0, dp_offset + x * MAX_DISPARITY + y * MAX_DISPARITY * width),
-                dp.dp);
+            dp.store(&dest(0, dp_offset + x * MAX_DISPARITY + y * MAX_DISPARITY * width));
         }
         __syncthreads();
     }
@@ -936,7 +1063,8 @@ void aggregateUp2DownPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream)
+    Stream& _stream,
+    bool packed)
 {
     static const unsigned int SUBGROUP_SIZE = MAX_DISPARITY / DP_BLOCK_SIZE;
     static const unsigned int PATHS_PER_BLOCK = BLOCK_SIZE / SUBGROUP_SIZE;
@@ -945,8 +1073,12 @@ void aggregateUp2DownPath(
     const int gdim = cudev::divUp(size.width, PATHS_PER_BLOCK);
     const int bdim = BLOCK_SIZE;
     cudaStream_t stream = cv::cuda::StreamAccessor::getStream(_stream);
-    aggregate_vertical_path_kernel<1, MAX_DISPARITY><<<gdim, bdim, 0, stream>>>(
-        left, right, dest, size.width, size.height, p1, p2, min_disp);
+    if (packed)
+        aggregate_vertical_path_kernel<1, MAX_DISPARITY, true><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, size.width, size.height, p1, p2, min_disp);
+    else
+        aggregate_vertical_path_kernel<1, MAX_DISPARITY, false><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, size.width, size.height, p1, p2, min_disp);
 }
 
 template <unsigned int MAX_DISPARITY>
@@ -957,7 +1089,8 @@ void aggregateDown2UpPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream)
+    Stream& _stream,
+    bool packed)
 {
     static const unsigned int SUBGROUP_SIZE = MAX_DISPARITY / DP_BLOCK_SIZE;
     static const unsigned int PATHS_PER_BLOCK = BLOCK_SIZE / SUBGROUP_SIZE;
@@ -966,8 +1099,12 @@ void aggregateDown2UpPath(
     const int gdim = cudev::divUp(size.width, PATHS_PER_BLOCK);
     const int bdim = BLOCK_SIZE;
     cudaStream_t stream = cv::cuda::StreamAccessor::getStream(_stream);
-    aggregate_vertical_path_kernel<-1, MAX_DISPARITY><<<gdim, bdim, 0, stream>>>(
-        left, right, dest, size.width, size.height, p1, p2, min_disp);
+    if (packed)
+        aggregate_vertical_path_kernel<-1, MAX_DISPARITY, true><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, size.width, size.height, p1, p2, min_disp);
+    else
+        aggregate_vertical_path_kernel<-1, MAX_DISPARITY, false><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, size.width, size.height, p1, p2, min_disp);
 }
 
 
@@ -978,7 +1115,8 @@ template CV_EXPORTS void aggregateUp2DownPath<64u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateUp2DownPath<128u>(
     const GpuMat& left,
@@ -987,7 +1125,8 @@ template CV_EXPORTS void aggregateUp2DownPath<128u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateUp2DownPath<256u>(
     const GpuMat& left,
@@ -996,7 +1135,8 @@ template CV_EXPORTS void aggregateUp2DownPath<256u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateDown2UpPath<64u>(
     const GpuMat& left,
@@ -1005,7 +1145,8 @@ template CV_EXPORTS void aggregateDown2UpPath<64u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateDown2UpPath<128u>(
     const GpuMat& left,
@@ -1014,7 +1155,8 @@ template CV_EXPORTS void aggregateDown2UpPath<128u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateDown2UpPath<256u>(
     const GpuMat& left,
@@ -1023,7 +1165,8 @@ template CV_EXPORTS void aggregateDown2UpPath<256u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 } // namespace vertical
 
@@ -1035,7 +1178,7 @@ static constexpr unsigned int DP_BLOCK_SIZE = 16u;
 static constexpr unsigned int WARPS_PER_BLOCK = 8u;
 static constexpr unsigned int BLOCK_SIZE = cudev::WARP_SIZE * WARPS_PER_BLOCK;
 
-template <int X_DIRECTION, int Y_DIRECTION, unsigned int MAX_DISPARITY>
+template <int X_DIRECTION, int Y_DIRECTION, unsigned int MAX_DISPARITY, bool PACKED>
 __global__ void aggregate_oblique_path_kernel(
     PtrStep<int32_t> left,
     PtrStep<int32_t> right,
@@ -1061,7 +1204,7 @@ __global__ void aggregate_oblique_path_kernel(
     }
 
     __shared__ int32_t right_buffer[2 * DP_BLOCK_SIZE][RIGHT_BUFFER_ROWS];
-    DynamicProgramming<DP_BLOCK_SIZE, SUBGROUP_SIZE, WARPS_PER_BLOCK> dp;
+    typename PathDynamicProgramming<PACKED, DP_BLOCK_SIZE, SUBGROUP_SIZE, WARPS_PER_BLOCK>::type dp;
 
     const unsigned int warp_id = cudev::Warp::warpId();
     const unsigned int group_id = cudev::Warp::laneId() / SUBGROUP_SIZE;
@@ -1126,9 +1269,7 @@ __global__ void aggregate_oblique_path_kernel(
                 local_costs[j] = __popc(left_value ^ right_values[j]);
             }
             dp.update(local_costs, p1, p2, shfl_mask);
-            store_uint8_vector<DP_BLOCK_SIZE>(
-                &dest(0, dp_offset + x * MAX_DISPARITY + y * MAX_DISPARITY * width),
-                dp.dp);
+            dp.store(&dest(0, dp_offset + x * MAX_DISPARITY + y * MAX_DISPARITY * width));
         }
         __syncthreads();
     }
@@ -1143,7 +1284,8 @@ void aggregateUpleft2DownrightPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream)
+    Stream& _stream,
+    bool packed)
 {
     static const unsigned int SUBGROUP_SIZE = MAX_DISPARITY / DP_BLOCK_SIZE;
     static const unsigned int PATHS_PER_BLOCK = BLOCK_SIZE / SUBGROUP_SIZE;
@@ -1152,8 +1294,12 @@ void aggregateUpleft2DownrightPath(
     const int gdim = cudev::divUp(size.width + size.height - 1, PATHS_PER_BLOCK);
     const int bdim = BLOCK_SIZE;
     cudaStream_t stream = StreamAccessor::getStream(_stream);
-    aggregate_oblique_path_kernel<1, 1, MAX_DISPARITY><<<gdim, bdim, 0, stream>>>(
-        left, right, dest, size.width, size.height, p1, p2, min_disp);
+    if (packed)
+        aggregate_oblique_path_kernel<1, 1, MAX_DISPARITY, true><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, size.width, size.height, p1, p2, min_disp);
+    else
+        aggregate_oblique_path_kernel<1, 1, MAX_DISPARITY, false><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, size.width, size.height, p1, p2, min_disp);
 }
 
 template <unsigned int MAX_DISPARITY>
@@ -1164,7 +1310,8 @@ void aggregateUpright2DownleftPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream)
+    Stream& _stream,
+    bool packed)
 {
     static const unsigned int SUBGROUP_SIZE = MAX_DISPARITY / DP_BLOCK_SIZE;
     static const unsigned int PATHS_PER_BLOCK = BLOCK_SIZE / SUBGROUP_SIZE;
@@ -1173,8 +1320,12 @@ void aggregateUpright2DownleftPath(
     const int gdim = cudev::divUp(size.width + size.height - 1, PATHS_PER_BLOCK);
     const int bdim = BLOCK_SIZE;
     cudaStream_t stream = StreamAccessor::getStream(_stream);
-    aggregate_oblique_path_kernel<-1, 1, MAX_DISPARITY><<<gdim, bdim, 0, stream>>>(
-        left, right, dest, size.width, size.height, p1, p2, min_disp);
+    if (packed)
+        aggregate_oblique_path_kernel<-1, 1, MAX_DISPARITY, true><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, size.width, size.height, p1, p2, min_disp);
+    else
+        aggregate_oblique_path_kernel<-1, 1, MAX_DISPARITY, false><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, size.width, size.height, p1, p2, min_disp);
 }
 
 template <unsigned int MAX_DISPARITY>
@@ -1185,7 +1336,8 @@ void aggregateDownright2UpleftPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream)
+    Stream& _stream,
+    bool packed)
 {
     static const unsigned int SUBGROUP_SIZE = MAX_DISPARITY / DP_BLOCK_SIZE;
     static const unsigned int PATHS_PER_BLOCK = BLOCK_SIZE / SUBGROUP_SIZE;
@@ -1194,8 +1346,12 @@ void aggregateDownright2UpleftPath(
     const int gdim = cudev::divUp(size.width + size.height - 1, PATHS_PER_BLOCK);
     const int bdim = BLOCK_SIZE;
     cudaStream_t stream = StreamAccessor::getStream(_stream);
-    aggregate_oblique_path_kernel<-1, -1, MAX_DISPARITY><<<gdim, bdim, 0, stream>>>(
-        left, right, dest, size.width, size.height, p1, p2, min_disp);
+    if (packed)
+        aggregate_oblique_path_kernel<-1, -1, MAX_DISPARITY, true><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, size.width, size.height, p1, p2, min_disp);
+    else
+        aggregate_oblique_path_kernel<-1, -1, MAX_DISPARITY, false><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, size.width, size.height, p1, p2, min_disp);
 }
 
 template <unsigned int MAX_DISPARITY>
@@ -1206,7 +1362,8 @@ void aggregateDownleft2UprightPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& _stream)
+    Stream& _stream,
+    bool packed)
 {
     static const unsigned int SUBGROUP_SIZE = MAX_DISPARITY / DP_BLOCK_SIZE;
     static const unsigned int PATHS_PER_BLOCK = BLOCK_SIZE / SUBGROUP_SIZE;
@@ -1215,8 +1372,12 @@ void aggregateDownleft2UprightPath(
     const int gdim = cudev::divUp(size.width + size.height - 1, PATHS_PER_BLOCK);
     const int bdim = BLOCK_SIZE;
     cudaStream_t stream = StreamAccessor::getStream(_stream);
-    aggregate_oblique_path_kernel<1, -1, MAX_DISPARITY><<<gdim, bdim, 0, stream>>>(
-        left, right, dest, size.width, size.height, p1, p2, min_disp);
+    if (packed)
+        aggregate_oblique_path_kernel<1, -1, MAX_DISPARITY, true><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, size.width, size.height, p1, p2, min_disp);
+    else
+        aggregate_oblique_path_kernel<1, -1, MAX_DISPARITY, false><<<gdim, bdim, 0, stream>>>(
+            left, right, dest, size.width, size.height, p1, p2, min_disp);
 }
 
 template CV_EXPORTS void aggregateUpleft2DownrightPath<64u>(
@@ -1226,7 +1387,8 @@ template CV_EXPORTS void aggregateUpleft2DownrightPath<64u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateUpleft2DownrightPath<128u>(
     const GpuMat& left,
@@ -1235,7 +1397,8 @@ template CV_EXPORTS void aggregateUpleft2DownrightPath<128u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateUpleft2DownrightPath<256u>(
     const GpuMat& left,
@@ -1244,7 +1407,8 @@ template CV_EXPORTS void aggregateUpleft2DownrightPath<256u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateUpright2DownleftPath<64u>(
     const GpuMat& left,
@@ -1253,7 +1417,8 @@ template CV_EXPORTS void aggregateUpright2DownleftPath<64u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateUpright2DownleftPath<128u>(
     const GpuMat& left,
@@ -1262,7 +1427,8 @@ template CV_EXPORTS void aggregateUpright2DownleftPath<128u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateUpright2DownleftPath<256u>(
     const GpuMat& left,
@@ -1271,7 +1437,8 @@ template CV_EXPORTS void aggregateUpright2DownleftPath<256u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateDownright2UpleftPath<64u>(
     const GpuMat& left,
@@ -1280,7 +1447,8 @@ template CV_EXPORTS void aggregateDownright2UpleftPath<64u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateDownright2UpleftPath<128u>(
     const GpuMat& left,
@@ -1289,7 +1457,8 @@ template CV_EXPORTS void aggregateDownright2UpleftPath<128u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateDownright2UpleftPath<256u>(
     const GpuMat& left,
@@ -1298,7 +1467,8 @@ template CV_EXPORTS void aggregateDownright2UpleftPath<256u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateDownleft2UprightPath<64u>(
     const GpuMat& left,
@@ -1307,7 +1477,8 @@ template CV_EXPORTS void aggregateDownleft2UprightPath<64u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateDownleft2UprightPath<128u>(
     const GpuMat& left,
@@ -1316,7 +1487,8 @@ template CV_EXPORTS void aggregateDownleft2UprightPath<128u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template CV_EXPORTS void aggregateDownleft2UprightPath<256u>(
     const GpuMat& left,
@@ -1325,12 +1497,13 @@ template CV_EXPORTS void aggregateDownleft2UprightPath<256u>(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 } // namespace oblique
 
 template <size_t MAX_DISPARITY>
-void PathAggregation::operator() (const GpuMat& left, const GpuMat& right, GpuMat& dest, int mode, int p1, int p2, int min_disp, Stream& stream)
+void PathAggregation::operator() (const GpuMat& left, const GpuMat& right, GpuMat& dest, int mode, int p1, int p2, int min_disp, bool packed, Stream& stream)
 {
     CV_Assert(left.size() == right.size());
     CV_Assert(left.type() == right.type());
@@ -1349,17 +1522,17 @@ void PathAggregation::operator() (const GpuMat& left, const GpuMat& right, GpuMa
         subs[i] = dest.colRange(i * buffer_step, (i + 1) * buffer_step);
     }
 
-    vertical::aggregateUp2DownPath<MAX_DISPARITY>(left, right, subs[0], p1, p2, min_disp, streams[0]);
-    vertical::aggregateDown2UpPath<MAX_DISPARITY>(left, right, subs[1], p1, p2, min_disp, streams[1]);
-    horizontal::aggregateLeft2RightPath<MAX_DISPARITY>(left, right, subs[2], p1, p2, min_disp, streams[2]);
-    horizontal::aggregateRight2LeftPath<MAX_DISPARITY>(left, right, subs[3], p1, p2, min_disp, streams[3]);
+    vertical::aggregateUp2DownPath<MAX_DISPARITY>(left, right, subs[0], p1, p2, min_disp, streams[0], packed);
+    vertical::aggregateDown2UpPath<MAX_DISPARITY>(left, right, subs[1], p1, p2, min_disp, streams[1], packed);
+    horizontal::aggregateLeft2RightPath<MAX_DISPARITY>(left, right, subs[2], p1, p2, min_disp, streams[2], packed);
+    horizontal::aggregateRight2LeftPath<MAX_DISPARITY>(left, right, subs[3], p1, p2, min_disp, streams[3], packed);
 
     if (mode == StereoSGBM::MODE_HH)
     {
-        oblique::aggregateUpleft2DownrightPath<MAX_DISPARITY>(left, right, subs[4], p1, p2, min_disp, streams[4]);
-        oblique::aggregateUpright2DownleftPath<MAX_DISPARITY>(left, right, subs[5], p1, p2, min_disp, streams[5]);
-        oblique::aggregateDownright2UpleftPath<MAX_DISPARITY>(left, right, subs[6], p1, p2, min_disp, streams[6]);
-        oblique::aggregateDownleft2UprightPath<MAX_DISPARITY>(left, right, subs[7], p1, p2, min_disp, streams[7]);
+        oblique::aggregateUpleft2DownrightPath<MAX_DISPARITY>(left, right, subs[4], p1, p2, min_disp, streams[4], packed);
+        oblique::aggregateUpright2DownleftPath<MAX_DISPARITY>(left, right, subs[5], p1, p2, min_disp, streams[5], packed);
+        oblique::aggregateDownright2UpleftPath<MAX_DISPARITY>(left, right, subs[6], p1, p2, min_disp, streams[6], packed);
+        oblique::aggregateDownleft2UprightPath<MAX_DISPARITY>(left, right, subs[7], p1, p2, min_disp, streams[7], packed);
     }
 
     // synchronization
@@ -1371,9 +1544,9 @@ void PathAggregation::operator() (const GpuMat& left, const GpuMat& right, GpuMa
     }
 }
 
-template void PathAggregation::operator()< 64>(const GpuMat& left, const GpuMat& right, GpuMat& dest, int mode, int p1, int p2, int min_disp, Stream& stream);
-template void PathAggregation::operator()<128>(const GpuMat& left, const GpuMat& right, GpuMat& dest, int mode, int p1, int p2, int min_disp, Stream& stream);
-template void PathAggregation::operator()<256>(const GpuMat& left, const GpuMat& right, GpuMat& dest, int mode, int p1, int p2, int min_disp, Stream& stream);
+template void PathAggregation::operator()< 64>(const GpuMat& left, const GpuMat& right, GpuMat& dest, int mode, int p1, int p2, int min_disp, bool packed, Stream& stream);
+template void PathAggregation::operator()<128>(const GpuMat& left, const GpuMat& right, GpuMat& dest, int mode, int p1, int p2, int min_disp, bool packed, Stream& stream);
+template void PathAggregation::operator()<256>(const GpuMat& left, const GpuMat& right, GpuMat& dest, int mode, int p1, int p2, int min_disp, bool packed, Stream& stream);
 
 } // namespace path_aggregation
 
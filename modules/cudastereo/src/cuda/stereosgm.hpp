@@ -30,7 +30,7 @@ private:
     std::array<GpuMat, MAX_NUM_PATHS> subs;
 public:
     template <size_t MAX_DISPARITY>
-    void operator() (const GpuMat& left, const GpuMat& right, GpuMat& dest, int mode, int p1, int p2, int min_disp, Stream& stream);
+    void operator() (const GpuMat& left, const GpuMat& right, GpuMat& dest, int mode, int p1, int p2, int min_disp, bool packed, Stream& stream);
 };
 }
 
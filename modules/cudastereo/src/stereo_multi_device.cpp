@@ -0,0 +1,279 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+using namespace cv;
+using namespace cv::cuda;
+
+#if !defined (HAVE_CUDA) || defined (CUDA_DISABLER)
+
+Ptr<cuda::StereoMultiDevice> cv::cuda::createStereoMultiDevice(const Ptr<cv::StereoMatcher>&, const std::vector<int>&, int) { throw_no_cuda(); return Ptr<cuda::StereoMultiDevice>(); }
+
+#else /* !defined (HAVE_CUDA) */
+
+namespace
+{
+    //! Creates a matcher of the same kind as the prototype on the current device
+    Ptr<cv::StereoMatcher> createSameMatcher(const Ptr<cv::StereoMatcher>& proto)
+    {
+        if (proto.dynamicCast<cuda::StereoSGM>())
+            return cuda::createStereoSGM();
+        if (proto.dynamicCast<cuda::StereoConstantSpaceBP>())
+            return cuda::createStereoConstantSpaceBP();
+        if (proto.dynamicCast<cuda::StereoBeliefPropagation>())
+            return cuda::createStereoBeliefPropagation();
+        if (proto.dynamicCast<cuda::StereoBM>())
+            return cuda::createStereoBM();
+
+        CV_Error(Error::StsNotImplemented, "Only cuda::StereoSGM, cuda::StereoBeliefPropagation, cuda::StereoConstantSpaceBP and cuda::StereoBM matchers are supported");
+    }
+
+    void copyParams(const Ptr<cv::StereoMatcher>& src, const Ptr<cv::StereoMatcher>& dst)
+    {
+        dst->setMinDisparity(src->getMinDisparity());
+        dst->setNumDisparities(src->getNumDisparities());
+        dst->setBlockSize(src->getBlockSize());
+        dst->setSpeckleWindowSize(src->getSpeckleWindowSize());
+        dst->setSpeckleRange(src->getSpeckleRange());
+        dst->setDisp12MaxDiff(src->getDisp12MaxDiff());
+
+        if (Ptr<cuda::StereoSGM> sgm = src.dynamicCast<cuda::StereoSGM>())
+        {
+            Ptr<cuda::StereoSGM> d = dst.dynamicCast<cuda::StereoSGM>();
+            d->setP1(sgm->getP1());
+            d->setP2(sgm->getP2());
+            d->setUniquenessRatio(sgm->getUniquenessRatio());
+            d->setMode(sgm->getMode());
+            d->setUsePackedCosts(sgm->getUsePackedCosts());
+        }
+        else if (Ptr<cuda::StereoBeliefPropagation> bp = src.dynamicCast<cuda::StereoBeliefPropagation>())
+        {
+            Ptr<cuda::StereoBeliefPropagation> d = dst.dynamicCast<cuda::StereoBeliefPropagation>();
+            d->setNumIters(bp->getNumIters());
+            d->setNumLevels(bp->getNumLevels());
+            d->setMaxDataTerm(bp->getMaxDataTerm());
+            d->setDataWeight(bp->getDataWeight());
+            d->setMaxDiscTerm(bp->getMaxDiscTerm());
+            d->setDiscSingleJump(bp->getDiscSingleJump());
+            d->setMsgType(bp->getMsgType());
+
+            if (Ptr<cuda::StereoConstantSpaceBP> csbp = src.dynamicCast<cuda::StereoConstantSpaceBP>())
+            {
+                Ptr<cuda::StereoConstantSpaceBP> dcsbp = dst.dynamicCast<cuda::StereoConstantSpaceBP>();
+                dcsbp->setNrPlane(csbp->getNrPlane());
+                dcsbp->setUseLocalInitDataCost(csbp->getUseLocalInitDataCost());
+            }
+        }
+        else if (Ptr<cuda::StereoBM> bm = src.dynamicCast<cuda::StereoBM>())
+        {
+            Ptr<cuda::StereoBM> d = dst.dynamicCast<cuda::StereoBM>();
+            d->setPreFilterType(bm->getPreFilterType());
+            d->setPreFilterCap(bm->getPreFilterCap());
+            d->setTextureThreshold(bm->getTextureThreshold());
+        }
+    }
+
+    void computeOnStream(const Ptr<cv::StereoMatcher>& matcher, const GpuMat& left, const GpuMat& right, GpuMat& disp, Stream& stream)
+    {
+        if (Ptr<cuda::StereoSGM> sgm = matcher.dynamicCast<cuda::StereoSGM>())
+            sgm->compute(left, right, disp, stream);
+        else if (Ptr<cuda::StereoBeliefPropagation> bp = matcher.dynamicCast<cuda::StereoBeliefPropagation>())
+            bp->compute(left, right, disp, stream);
+        else
+            matcher.dynamicCast<cuda::StereoBM>()->compute(left, right, disp, stream);
+    }
+
+    // Copies between the memory of any devices, the unified address space tells the runtime where the buffers are
+    void copyAcrossDevices(const GpuMat& src, GpuMat& dst, cudaStream_t stream)
+    {
+        CV_DbgAssert( src.size() == dst.size() && src.type() == dst.type() );
+        cudaSafeCall( cudaMemcpy2DAsync(dst.data, dst.step, src.data, src.step, src.cols * src.elemSize(), src.rows, cudaMemcpyDefault, stream) );
+    }
+
+    struct DeviceSlot
+    {
+        int device;
+        Ptr<cv::StereoMatcher> matcher;
+        Ptr<Stream> stream;
+        GpuMat left, right, disp;
+        //! rows of the band and of its extension by the overlap
+        Range band, extended;
+    };
+
+    class StereoMultiDeviceImpl CV_FINAL : public cuda::StereoMultiDevice
+    {
+    public:
+        StereoMultiDeviceImpl(const Ptr<cv::StereoMatcher>& matcher, const std::vector<int>& devices, int overlap);
+
+        void compute(InputArray left, InputArray right, OutputArray disparity) CV_OVERRIDE;
+        void compute(InputArray left, InputArray right, OutputArray disparity, Stream& stream) CV_OVERRIDE;
+
+        std::vector<int> getDevices() const CV_OVERRIDE { return devices_; }
+
+        int getOverlap() const CV_OVERRIDE { return overlap_; }
+        void setOverlap(int overlap) CV_OVERRIDE { CV_Assert( overlap >= 0 ); overlap_ = overlap; }
+
+        int getMinDisparity() const CV_OVERRIDE { return proto_->getMinDisparity(); }
+        void setMinDisparity(int minDisparity) CV_OVERRIDE { proto_->setMinDisparity(minDisparity); }
+
+        int getNumDisparities() const CV_OVERRIDE { return proto_->getNumDisparities(); }
+        void setNumDisparities(int numDisparities) CV_OVERRIDE { proto_->setNumDisparities(numDisparities); }
+
+        int getBlockSize() const CV_OVERRIDE { return proto_->getBlockSize(); }
+        void setBlockSize(int blockSize) CV_OVERRIDE { proto_->setBlockSize(blockSize); }
+
+        int getSpeckleWindowSize() const CV_OVERRIDE { return proto_->getSpeckleWindowSize(); }
+        void setSpeckleWindowSize(int speckleWindowSize) CV_OVERRIDE { proto_->setSpeckleWindowSize(speckleWindowSize); }
+
+        int getSpeckleRange() const CV_OVERRIDE { return proto_->getSpeckleRange(); }
+        void setSpeckleRange(int speckleRange) CV_OVERRIDE { proto_->setSpeckleRange(speckleRange); }
+
+        int getDisp12MaxDiff() const CV_OVERRIDE { return proto_->getDisp12MaxDiff(); }
+        void setDisp12MaxDiff(int disp12MaxDiff) CV_OVERRIDE { proto_->setDisp12MaxDiff(disp12MaxDiff); }
+
+    private:
+        void computeBand(DeviceSlot& slot, const _InputArray& left, const _InputArray& right, int dispType);
+
+        Ptr<cv::StereoMatcher> proto_;
+        std::vector<int> devices_;
+        int overlap_;
+        std::vector<DeviceSlot> slots_;
+    };
+
+    StereoMultiDeviceImpl::StereoMultiDeviceImpl(const Ptr<cv::StereoMatcher>& matcher, const std::vector<int>& devices, int overlap) :
+        proto_(matcher), devices_(devices), overlap_(overlap)
+    {
+        CV_Assert( !proto_.empty() );
+        CV_Assert( overlap_ >= 0 );
+
+        if (devices_.empty())
+        {
+            const int count = getCudaEnabledDeviceCount();
+            for (int i = 0; i < count; ++i)
+                devices_.push_back(i);
+        }
+        CV_Assert( !devices_.empty() );
+
+        // fails early for unsupported matchers
+        createSameMatcher(proto_);
+
+        slots_.resize(devices_.size());
+        for (size_t i = 0; i < devices_.size(); ++i)
+            slots_[i].device = devices_[i];
+    }
+
+    void StereoMultiDeviceImpl::compute(InputArray left, InputArray right, OutputArray disparity)
+    {
+        compute(left, right, disparity, Stream::Null());
+    }
+
+    void StereoMultiDeviceImpl::computeBand(DeviceSlot& slot, const _InputArray& left, const _InputArray& right, int dispType)
+    {
+        setDevice(slot.device);
+
+        if (slot.matcher.empty())
+        {
+            // created with the device current, the matchers allocate their buffers lazily on it
+            slot.matcher = createSameMatcher(proto_);
+            slot.stream = makePtr<Stream>();
+        }
+        copyParams(proto_, slot.matcher);
+
+        Stream& stream = *slot.stream;
+        cudaStream_t s = StreamAccessor::getStream(stream);
+
+        const _InputArray* src[] = { &left, &right };
+        GpuMat* dst[] = { &slot.left, &slot.right };
+        for (int k = 0; k < 2; ++k)
+        {
+            if (src[k]->kind() == _InputArray::CUDA_GPU_MAT)
+            {
+                GpuMat band = src[k]->getGpuMat().rowRange(slot.extended);
+                dst[k]->create(band.size(), band.type());
+                copyAcrossDevices(band, *dst[k], s);
+            }
+            else
+            {
+                dst[k]->upload(src[k]->getMat().rowRange(slot.extended), stream);
+            }
+        }
+
+        if (dispType >= 0)
+            slot.disp.create(slot.left.size(), dispType);
+        else
+            slot.disp.release();
+
+        computeOnStream(slot.matcher, slot.left, slot.right, slot.disp, stream);
+
+        stream.waitForCompletion();
+    }
+
+    void StereoMultiDeviceImpl::compute(InputArray _left, InputArray _right, OutputArray _disparity, Stream& _stream)
+    {
+        const Size size = _left.size();
+        CV_Assert( _right.size() == size && _right.type() == _left.type() );
+
+        const int nbands = std::min(static_cast<int>(slots_.size()), size.height);
+        const int bandRows = divUp(size.height, nbands);
+
+        for (int i = 0; i < nbands; ++i)
+        {
+            DeviceSlot& slot = slots_[i];
+            slot.band = Range(i * bandRows, std::min((i + 1) * bandRows, size.height));
+            slot.extended = Range(std::max(slot.band.start - overlap_, 0), std::min(slot.band.end + overlap_, size.height));
+        }
+
+        // BP keeps the type of a non-empty output
+        const int dispType = _disparity.empty() ? -1 : _disparity.type();
+
+        // the inputs on the current device are read by the other devices
+        if (_left.kind() == _InputArray::CUDA_GPU_MAT || _right.kind() == _InputArray::CUDA_GPU_MAT)
+            _stream.waitForCompletion();
+
+        const int currentDevice = getDevice();
+
+        parallel_for_(Range(0, nbands), [&](const Range& range)
+        {
+            for (int i = range.start; i < range.end; ++i)
+                computeBand(slots_[i], _left, _right, dispType);
+        });
+
+        setDevice(currentDevice);
+
+        const int type = slots_[0].disp.type();
+
+        if (_disparity.kind() == _InputArray::CUDA_GPU_MAT)
+        {
+            _disparity.create(size, type);
+            GpuMat disparity = _disparity.getGpuMat();
+
+            for (int i = 0; i < nbands; ++i)
+            {
+                const DeviceSlot& slot = slots_[i];
+                GpuMat dst = disparity.rowRange(slot.band);
+                copyAcrossDevices(slot.disp.rowRange(slot.band.start - slot.extended.start, slot.band.end - slot.extended.start), dst,
+                                  StreamAccessor::getStream(_stream));
+            }
+        }
+        else
+        {
+            _disparity.create(size, type);
+            Mat disparity = _disparity.getMat();
+
+            for (int i = 0; i < nbands; ++i)
+            {
+                const DeviceSlot& slot = slots_[i];
+                slot.disp.rowRange(slot.band.start - slot.extended.start, slot.band.end - slot.extended.start).download(disparity.rowRange(slot.band));
+            }
+        }
+    }
+}
+
+Ptr<cuda::StereoMultiDevice> cv::cuda::createStereoMultiDevice(const Ptr<cv::StereoMatcher>& matcher, const std::vector<int>& devices, int overlap)
+{
+    return makePtr<StereoMultiDeviceImpl>(matcher, devices, overlap);
+}
+
+#endif /* !defined (HAVE_CUDA) */
@@ -27,7 +27,8 @@ struct StereoSGMParams
     int P2;
     int uniquenessRatio;
     int mode;
-    StereoSGMParams(int minDisparity = 0, int numDisparities = 128, int P1 = 10, int P2 = 120, int uniquenessRatio = 5, int mode = StereoSGM::MODE_HH4) : minDisparity(minDisparity), numDisparities(numDisparities), P1(P1), P2(P2), uniquenessRatio(uniquenessRatio), mode(mode) {}
+    bool usePackedCosts;
+    StereoSGMParams(int minDisparity = 0, int numDisparities = 128, int P1 = 10, int P2 = 120, int uniquenessRatio = 5, int mode = StereoSGM::MODE_HH4) : minDisparity(minDisparity), numDisparities(numDisparities), P1(P1), P2(P2), uniquenessRatio(uniquenessRatio), mode(mode), usePackedCosts(false) {}
 };
 
 class StereoSGMImpl CV_FINAL : public StereoSGM
@@ -71,6 +72,9 @@ public:
     int getPreFilterCap() const CV_OVERRIDE { return -1; }
     void setPreFilterCap(int /*preFilterCap*/) CV_OVERRIDE {}
 
+    bool getUsePackedCosts() const CV_OVERRIDE { return params.usePackedCosts; }
+    void setUsePackedCosts(bool usePackedCosts) CV_OVERRIDE { params.usePackedCosts = usePackedCosts; }
+
 private:
     StereoSGMParams params;
     device::stereosgm::path_aggregation::PathAggregation pathAggregation;
@@ -107,31 +111,34 @@ void StereoSGMImpl::compute(InputArray _left, InputArray _right, OutputArray _di
     CV_Assert(left.type() == CV_8UC1 || left.type() == CV_16UC1);
     CV_Assert(size == right.size() && left.type() == right.type());
 
+    // with stream ordered allocation the buffers are released at the end of the call
+    cudev::ScratchPool pool(_stream);
+
     _disparity.create(size, CV_16SC1);
-    ensureSizeIsEnough(size, CV_16SC1, right_disp);
+    pool.ensureSizeIsEnough(size, CV_16SC1, right_disp);
     GpuMat left_disp = _disparity.getGpuMat();
 
-    ensureSizeIsEnough(size, CV_32SC1, censused_left);
-    ensureSizeIsEnough(size, CV_32SC1, censused_right);
+    pool.ensureSizeIsEnough(size, CV_32SC1, censused_left);
+    pool.ensureSizeIsEnough(size, CV_32SC1, censused_right);
     census_transform::censusTransform(left, censused_left, _stream);
     census_transform::censusTransform(right, censused_right, _stream);
 
-    ensureSizeIsEnough(1, size.width * size.height * params.numDisparities * num_paths, CV_8UC1, aggregated);
-    ensureSizeIsEnough(size, CV_16SC1, left_disp_tmp);
-    ensureSizeIsEnough(size, CV_16SC1, right_disp_tmp);
+    pool.ensureSizeIsEnough(1, size.width * size.height * params.numDisparities * num_paths, CV_8UC1, aggregated);
+    pool.ensureSizeIsEnough(size, CV_16SC1, left_disp_tmp);
+    pool.ensureSizeIsEnough(size, CV_16SC1, right_disp_tmp);
 
     switch (params.numDisparities)
     {
     case 64:
-        pathAggregation.operator()<64>(censused_left, censused_right, aggregated, params.mode, params.P1, params.P2, params.minDisparity, _stream);
+        pathAggregation.operator()<64>(censused_left, censused_right, aggregated, params.mode, params.P1, params.P2, params.minDisparity, params.usePackedCosts, _stream);
         winner_takes_all::winnerTakesAll<64>(aggregated, left_disp_tmp, right_disp_tmp, (float)(100 - params.uniquenessRatio) / 100, true, params.mode, _stream);
         break;
     case 128:
-        pathAggregation.operator()<128>(censused_left, censused_right, aggregated, params.mode, params.P1, params.P2, params.minDisparity, _stream);
+        pathAggregation.operator()<128>(censused_left, censused_right, aggregated, params.mode, params.P1, params.P2, params.minDisparity, params.usePackedCosts, _stream);
         winner_takes_all::winnerTakesAll<128>(aggregated, left_disp_tmp, right_disp_tmp, (float)(100 - params.uniquenessRatio) / 100, true, params.mode, _stream);
         break;
     case 256:
-        pathAggregation.operator()<256>(censused_left, censused_right, aggregated, params.mode, params.P1, params.P2, params.minDisparity, _stream);
+        pathAggregation.operator()<256>(censused_left, censused_right, aggregated, params.mode, params.P1, params.P2, params.minDisparity, params.usePackedCosts, _stream);
         winner_takes_all::winnerTakesAll<256>(aggregated, left_disp_tmp, right_disp_tmp, (float)(100 - params.uniquenessRatio) / 100, true, params.mode, _stream);
         break;
     default:
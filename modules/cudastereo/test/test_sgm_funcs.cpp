@@ -37,7 +37,8 @@ void aggregateLeft2RightPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template <unsigned int MAX_DISPARITY>
 void aggregateRight2LeftPath(
@@ -47,7 +48,8 @@ void aggregateRight2LeftPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 }
 
 namespace vertical
@@ -60,7 +62,8 @@ void aggregateUp2DownPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template <unsigned int MAX_DISPARITY>
 void aggregateDown2UpPath(
@@ -70,7 +73,8 @@ void aggregateDown2UpPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 }
 
 namespace oblique
@@ -83,7 +87,8 @@ void aggregateUpleft2DownrightPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template <unsigned int MAX_DISPARITY>
 void aggregateUpright2DownleftPath(
@@ -93,7 +98,8 @@ void aggregateUpright2DownleftPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template <unsigned int MAX_DISPARITY>
 void aggregateDownright2UpleftPath(
@@ -103,7 +109,8 @@ void aggregateDownright2UpleftPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 
 template <unsigned int MAX_DISPARITY>
 void aggregateDownleft2UprightPath(
@@ -113,7 +120,8 @@ void aggregateDownleft2UprightPath(
     unsigned int p1,
     unsigned int p2,
     int min_disp,
-    Stream& stream);
+    Stream& stream,
+    bool packed);
 }
 } // namespace path_aggregation
 
@@ -263,12 +271,13 @@ namespace opencv_test { namespace {
     static constexpr int P1 = 10;
     static constexpr int P2 = 120;
 
-    PARAM_TEST_CASE(StereoSGM_PathAggregation, cv::cuda::DeviceInfo, cv::Size, UseRoi, int)
+    PARAM_TEST_CASE(StereoSGM_PathAggregation, cv::cuda::DeviceInfo, cv::Size, UseRoi, int, bool)
     {
         cv::cuda::DeviceInfo devInfo;
         cv::Size size;
         bool useRoi;
         int minDisp;
+        bool packed;
 
         virtual void SetUp()
         {
@@ -276,6 +285,7 @@ namespace opencv_test { namespace {
             size = GET_PARAM(1);
             useRoi = GET_PARAM(2);
             minDisp = GET_PARAM(3);
+            packed = GET_PARAM(4);
 
             cv::cuda::setDevice(devInfo.deviceID());
         }
@@ -290,7 +300,7 @@ namespace opencv_test { namespace {
 
             cv::cuda::GpuMat g_dst;
             g_dst.create(cv::Size(left_image.cols * left_image.rows * DISPARITY, 1), CV_8UC1);
-            func(loadMat(left_image, useRoi), loadMat(right_image, useRoi), g_dst, P1, P2, minDisp, cv::cuda::Stream::Null());
+            func(loadMat(left_image, useRoi), loadMat(right_image, useRoi), g_dst, P1, P2, minDisp, cv::cuda::Stream::Null(), packed);
 
             cv::Mat dst;
             g_dst.download(dst);
@@ -343,7 +353,8 @@ namespace opencv_test { namespace {
         ALL_DEVICES,
         DIFFERENT_SIZES,
         WHOLE_SUBMAT,
-        testing::Values(0, 1, 10)));
+        testing::Values(0, 1, 10),
+        testing::Bool()));
 
 
     void winner_takes_all_left(
@@ -965,5 +965,56 @@ protected:
 
 TEST(CudaStereo_StereoSGM, regression) { CV_Cuda_StereoSGMTest test; test.safe_run(); }
 
+//////////////////////////////////////////////////////////////////////////
+// StereoMultiDevice
+
+struct StereoMultiDevice : testing::TestWithParam<cv::cuda::DeviceInfo>
+{
+    cv::cuda::DeviceInfo devInfo;
+
+    virtual void SetUp()
+    {
+        devInfo = GetParam();
+
+        cv::cuda::setDevice(devInfo.deviceID());
+    }
+};
+
+CUDA_TEST_P(StereoMultiDevice, SGM)
+{
+    cv::Mat left_image  = readImage("stereobm/aloe-L.png", cv::IMREAD_GRAYSCALE);
+    cv::Mat right_image = readImage("stereobm/aloe-R.png", cv::IMREAD_GRAYSCALE);
+
+    ASSERT_FALSE(left_image.empty());
+    ASSERT_FALSE(right_image.empty());
+
+    cv::Ptr<cv::cuda::StereoSGM> sgm = cv::cuda::createStereoSGM(0, 64);
+
+    cv::cuda::GpuMat d_gold;
+    sgm->compute(loadMat(left_image), loadMat(right_image), d_gold);
+    cv::Mat gold(d_gold);
+
+    // the same device twice, bands run as on two devices
+    std::vector<int> devices(2, devInfo.deviceID());
+
+    // bands extended to the whole image give the same result as a single matcher
+    cv::Ptr<cv::cuda::StereoMultiDevice> full = cv::cuda::createStereoMultiDevice(sgm, devices, left_image.rows);
+    cv::cuda::GpuMat d_disp;
+    full->compute(loadMat(left_image), loadMat(right_image), d_disp);
+    EXPECT_MAT_NEAR(gold, d_disp, 0.0);
+
+    cv::Ptr<cv::cuda::StereoMultiDevice> split = cv::cuda::createStereoMultiDevice(sgm, devices, 32);
+    cv::Mat disp;
+    split->compute(left_image, right_image, disp);
+    ASSERT_EQ(gold.size(), disp.size());
+    ASSERT_EQ(gold.type(), disp.type());
+
+    cv::Mat diff;
+    cv::absdiff(gold, disp, diff);
+    EXPECT_LE(cv::countNonZero(diff > 16), gold.total() / 50);
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_Stereo, StereoMultiDevice, ALL_DEVICES);
+
 }} // namespace
 #endif // HAVE_CUDA
@@ -225,6 +225,54 @@ are supported.
 CV_EXPORTS_W void rotate(InputArray src, OutputArray dst, Size dsize, double angle, double xShift = 0, double yShift = 0,
                        int interpolation = INTER_LINEAR, Stream& stream = Stream::Null());
 
+/** @brief Warps regions of an image into a planar tensor in one pass.
+
+Every output image i of size dsize is sampled from src with the transformation M[i], its channels are
+optionally swapped, normalized as (value - mean) \* scale and written as planes of a NCHW tensor,
+see dnn::blobFromImages. There are no intermediate images.
+
+@param src Source image, CV_8UC1, CV_8UC3 or CV_8UC4. The alpha channel of 4-channel images is dropped.
+@param blob Output continuous tensor of N = M.size() images, stored as a matrix with N\*C\*dsize.height
+rows and dsize.width columns. C is 1 for single channel sources and 3 otherwise.
+@param M *2x3* transformation matrices, one per output image.
+@param dsize Size of the output images.
+@param scale Multiplier of the values.
+@param mean Values subtracted from the channels, in the output channel order.
+@param swapRB Flag which indicates that the first and the last channels should be swapped.
+@param ddepth Depth of the output, CV_32F or CV_16F.
+@param flags INTER_NEAREST or INTER_LINEAR and the optional flag WARP_INVERSE_MAP specifying that
+the matrices are inverse transformations ( dst=\>src ).
+@param borderMode BORDER_CONSTANT or BORDER_REPLICATE.
+@param borderValue Value used in case of a constant border, before the normalization.
+@param stream Stream for the asynchronous version.
+
+@sa cuda::warpAffine, cuda::resizeBlob
+ */
+CV_EXPORTS void warpAffineBlob(InputArray src, OutputArray blob, const std::vector<Mat>& M, Size dsize,
+    double scale = 1.0, const Scalar& mean = Scalar(), bool swapRB = false, int ddepth = CV_32F,
+    int flags = INTER_LINEAR, int borderMode = BORDER_CONSTANT, Scalar borderValue = Scalar(),
+    Stream& stream = Stream::Null());
+
+/** @brief Crops and resizes regions of an image into a planar tensor in one pass.
+
+Same as cuda::warpAffineBlob with the transformations which map every region of interest to dsize,
+the pixels are sampled as cuda::resize does with the replicated border.
+
+@param src Source image, CV_8UC1, CV_8UC3 or CV_8UC4.
+@param blob Output continuous tensor of rois.size() images, see cuda::warpAffineBlob.
+@param rois Regions of src, for example detected faces.
+@param dsize Size of the output images.
+@param scale Multiplier of the values.
+@param mean Values subtracted from the channels, in the output channel order.
+@param swapRB Flag which indicates that the first and the last channels should be swapped.
+@param ddepth Depth of the output, CV_32F or CV_16F.
+@param interpolation INTER_NEAREST or INTER_LINEAR.
+@param stream Stream for the asynchronous version.
+ */
+CV_EXPORTS void resizeBlob(InputArray src, OutputArray blob, const std::vector<Rect>& rois, Size dsize,
+    double scale = 1.0, const Scalar& mean = Scalar(), bool swapRB = false, int ddepth = CV_32F,
+    int interpolation = INTER_LINEAR, Stream& stream = Stream::Null());
+
 /** @brief Smoothes an image and downsamples it.
 
 @param src Source image.
@@ -53,14 +53,23 @@ namespace cv { namespace cuda { namespace device
 {
     namespace imgproc
     {
-        __constant__ float c_warpMat[3 * 3];
+        // The coefficients are passed to the kernels by value, there is no upload to constant memory
+        // which would synchronize the device and could not be captured into a CUDA graph.
 
         struct AffineTransform
         {
-            static __device__ __forceinline__ float2 calcCoord(int x, int y)
+            float m[2 * 3];
+
+            explicit AffineTransform(const float* coeffs)
+            {
+                for (int i = 0; i < 2 * 3; ++i)
+                    m[i] = coeffs[i];
+            }
+
+            __device__ __forceinline__ float2 calcCoord(int x, int y) const
             {
-                const float xcoo = c_warpMat[0] * x + c_warpMat[1] * y + c_warpMat[2];
-                const float ycoo = c_warpMat[3] * x + c_warpMat[4] * y + c_warpMat[5];
+                const float xcoo = m[0] * x + m[1] * y + m[2];
+                const float ycoo = m[3] * x + m[4] * y + m[5];
 
                 return make_float2(xcoo, ycoo);
             }
@@ -68,12 +77,20 @@ namespace cv { namespace cuda { namespace device
 
         struct PerspectiveTransform
         {
-            static __device__ __forceinline__ float2 calcCoord(int x, int y)
+            float m[3 * 3];
+
+            explicit PerspectiveTransform(const float* coeffs)
+            {
+                for (int i = 0; i < 3 * 3; ++i)
+                    m[i] = coeffs[i];
+            }
+
+            __device__ __forceinline__ float2 calcCoord(int x, int y) const
             {
-                const float coeff = 1.0f / (c_warpMat[6] * x + c_warpMat[7] * y + c_warpMat[8]);
+                const float coeff = 1.0f / (m[6] * x + m[7] * y + m[8]);
 
-                const float xcoo = coeff * (c_warpMat[0] * x + c_warpMat[1] * y + c_warpMat[2]);
-                const float ycoo = coeff * (c_warpMat[3] * x + c_warpMat[4] * y + c_warpMat[5]);
+                const float xcoo = coeff * (m[0] * x + m[1] * y + m[2]);
+                const float ycoo = coeff * (m[3] * x + m[4] * y + m[5]);
 
                 return make_float2(xcoo, ycoo);
             }
@@ -82,26 +99,26 @@ namespace cv { namespace cuda { namespace device
         ///////////////////////////////////////////////////////////////////
         // Build Maps
 
-        template <class Transform> __global__ void buildWarpMaps(PtrStepSzf xmap, PtrStepf ymap)
+        template <class Transform> __global__ void buildWarpMaps(const Transform transform, PtrStepSzf xmap, PtrStepf ymap)
         {
             const int x = blockDim.x * blockIdx.x + threadIdx.x;
             const int y = blockDim.y * blockIdx.y + threadIdx.y;
 
             if (x < xmap.cols && y < xmap.rows)
             {
-                const float2 coord = Transform::calcCoord(x, y);
+                const float2 coord = transform.calcCoord(x, y);
 
                 xmap(y, x) = coord.x;
                 ymap(y, x) = coord.y;
             }
         }
 
-        template <class Transform> void buildWarpMaps_caller(PtrStepSzf xmap, PtrStepSzf ymap, cudaStream_t stream)
+        template <class Transform> void buildWarpMaps_caller(const Transform& transform, PtrStepSzf xmap, PtrStepSzf ymap, cudaStream_t stream)
         {
             dim3 block(32, 8);
             dim3 grid(divUp(xmap.cols, block.x), divUp(xmap.rows, block.y));
 
-            buildWarpMaps<Transform><<<grid, block, 0, stream>>>(xmap, ymap);
+            buildWarpMaps<Transform><<<grid, block, 0, stream>>>(transform, xmap, ymap);
             cudaSafeCall( cudaGetLastError() );
 
             if (stream == 0)
@@ -110,29 +127,25 @@ namespace cv { namespace cuda { namespace device
 
         void buildWarpAffineMaps_gpu(float coeffs[2 * 3], PtrStepSzf xmap, PtrStepSzf ymap, cudaStream_t stream)
         {
-            cudaSafeCall( cudaMemcpyToSymbol(c_warpMat, coeffs, 2 * 3 * sizeof(float)) );
-
-            buildWarpMaps_caller<AffineTransform>(xmap, ymap, stream);
+            buildWarpMaps_caller(AffineTransform(coeffs), xmap, ymap, stream);
         }
 
         void buildWarpPerspectiveMaps_gpu(float coeffs[3 * 3], PtrStepSzf xmap, PtrStepSzf ymap, cudaStream_t stream)
         {
-            cudaSafeCall( cudaMemcpyToSymbol(c_warpMat, coeffs, 3 * 3 * sizeof(float)) );
-
-            buildWarpMaps_caller<PerspectiveTransform>(xmap, ymap, stream);
+            buildWarpMaps_caller(PerspectiveTransform(coeffs), xmap, ymap, stream);
         }
 
         ///////////////////////////////////////////////////////////////////
         // Warp
 
-        template <class Transform, class Ptr2D, typename T> __global__ void warp(const Ptr2D src, PtrStepSz<T> dst)
+        template <class Transform, class Ptr2D, typename T> __global__ void warp(const Transform transform, const Ptr2D src, PtrStepSz<T> dst)
         {
             const int x = blockDim.x * blockIdx.x + threadIdx.x;
             const int y = blockDim.y * blockIdx.y + threadIdx.y;
 
             if (x < dst.cols && y < dst.rows)
             {
-                const float2 coord = Transform::calcCoord(x, y);
+                const float2 coord = transform.calcCoord(x, y);
 
                 dst.ptr(y)[x] = saturate_cast<T>(src(coord.y, coord.x));
             }
@@ -140,7 +153,7 @@ namespace cv { namespace cuda { namespace device
 
         template <class Transform, template <typename> class Filter, template <typename> class B, typename T> struct WarpDispatcherStream
         {
-            static void call(PtrStepSz<T> src, PtrStepSz<T> dst, const float* borderValue, cudaStream_t stream, bool)
+            static void call(const Transform& transform, PtrStepSz<T> src, PtrStepSz<T> dst, const float* borderValue, cudaStream_t stream, bool)
             {
                 typedef typename TypeVec<float, VecTraits<T>::cn>::vec_type work_type;
 
@@ -151,14 +164,14 @@ namespace cv { namespace cuda { namespace device
                 BorderReader< PtrStep<T>, B<work_type> > brdSrc(src, brd);
                 Filter< BorderReader< PtrStep<T>, B<work_type> > > filter_src(brdSrc);
 
-                warp<Transform><<<grid, block, 0, stream>>>(filter_src, dst);
+                warp<<<grid, block, 0, stream>>>(transform, filter_src, dst);
                 cudaSafeCall( cudaGetLastError() );
             }
         };
 
         template <class Transform, template <typename> class Filter, template <typename> class B, typename T> struct WarpDispatcherNonStream
         {
-            static void call(PtrStepSz<T> src, PtrStepSz<T> srcWhole, int xoff, int yoff, PtrStepSz<T> dst, const float* borderValue, bool)
+            static void call(const Transform& transform, PtrStepSz<T> src, PtrStepSz<T> srcWhole, int xoff, int yoff, PtrStepSz<T> dst, const float* borderValue, bool)
             {
                 CV_UNUSED(xoff);
                 CV_UNUSED(yoff);
@@ -173,7 +186,7 @@ namespace cv { namespace cuda { namespace device
                 BorderReader< PtrStep<T>, B<work_type> > brdSrc(src, brd);
                 Filter< BorderReader< PtrStep<T>, B<work_type> > > filter_src(brdSrc);
 
-                warp<Transform><<<grid, block>>>(filter_src, dst);
+                warp<<<grid, block>>>(transform, filter_src, dst);
                 cudaSafeCall( cudaGetLastError() );
 
                 cudaSafeCall( cudaDeviceSynchronize() );
@@ -195,7 +208,7 @@ namespace cv { namespace cuda { namespace device
             }; \
             template <class Transform, template <typename> class Filter, template <typename> class B> struct WarpDispatcherNonStream<Transform, Filter, B, type> \
             { \
-                static void call(PtrStepSz< type > src, PtrStepSz< type > srcWhole, int xoff, int yoff, PtrStepSz< type > dst, const float* borderValue, bool cc20) \
+                static void call(const Transform& transform, PtrStepSz< type > src, PtrStepSz< type > srcWhole, int xoff, int yoff, PtrStepSz< type > dst, const float* borderValue, bool cc20) \
                 { \
                     typedef typename TypeVec<float, VecTraits< type >::cn>::vec_type work_type; \
                     dim3 block(32, cc20 ? 8 : 4); \
@@ -205,14 +218,14 @@ namespace cv { namespace cuda { namespace device
                     B<work_type> brd(src.rows, src.cols, VecTraits<work_type>::make(borderValue)); \
                     BorderReader< tex_warp_ ## type ##_reader, B<work_type> > brdSrc(texSrc, brd); \
                     Filter< BorderReader< tex_warp_ ## type ##_reader, B<work_type> > > filter_src(brdSrc); \
-                    warp<Transform><<<grid, block>>>(filter_src, dst); \
+                    warp<<<grid, block>>>(transform, filter_src, dst); \
                     cudaSafeCall( cudaGetLastError() ); \
                     cudaSafeCall( cudaDeviceSynchronize() ); \
                 } \
             }; \
             template <class Transform, template <typename> class Filter> struct WarpDispatcherNonStream<Transform, Filter, BrdReplicate, type> \
             { \
-                static void call(PtrStepSz< type > src, PtrStepSz< type > srcWhole, int xoff, int yoff, PtrStepSz< type > dst, const float*, bool) \
+                static void call(const Transform& transform, PtrStepSz< type > src, PtrStepSz< type > srcWhole, int xoff, int yoff, PtrStepSz< type > dst, const float*, bool) \
                 { \
                     dim3 block(32, 8); \
                     dim3 grid(divUp(dst.cols, block.x), divUp(dst.rows, block.y)); \
@@ -221,14 +234,14 @@ namespace cv { namespace cuda { namespace device
                     if (srcWhole.cols == src.cols && srcWhole.rows == src.rows) \
                     { \
                         Filter< tex_warp_ ## type ##_reader > filter_src(texSrc); \
-                        warp<Transform><<<grid, block>>>(filter_src, dst); \
+                        warp<<<grid, block>>>(transform, filter_src, dst); \
                     } \
                     else \
                     { \
                         BrdReplicate<type> brd(src.rows, src.cols); \
                         BorderReader< tex_warp_ ## type ##_reader, BrdReplicate<type> > brdSrc(texSrc, brd); \
                         Filter< BorderReader< tex_warp_ ## type ##_reader, BrdReplicate<type> > > filter_src(brdSrc); \
-                        warp<Transform><<<grid, block>>>(filter_src, dst); \
+                        warp<<<grid, block>>>(transform, filter_src, dst); \
                     } \
                     cudaSafeCall( cudaGetLastError() ); \
                     cudaSafeCall( cudaDeviceSynchronize() ); \
@@ -263,20 +276,20 @@ namespace cv { namespace cuda { namespace device
 
         template <class Transform, template <typename> class Filter, template <typename> class B, typename T> struct WarpDispatcher
         {
-            static void call(PtrStepSz<T> src, PtrStepSz<T> srcWhole, int xoff, int yoff, PtrStepSz<T> dst, const float* borderValue, cudaStream_t stream, bool cc20)
+            static void call(const Transform& transform, PtrStepSz<T> src, PtrStepSz<T> srcWhole, int xoff, int yoff, PtrStepSz<T> dst, const float* borderValue, cudaStream_t stream, bool cc20)
             {
                 if (stream == 0)
-                    WarpDispatcherNonStream<Transform, Filter, B, T>::call(src, srcWhole, xoff, yoff, dst, borderValue, cc20);
+                    WarpDispatcherNonStream<Transform, Filter, B, T>::call(transform, src, srcWhole, xoff, yoff, dst, borderValue, cc20);
                 else
-                    WarpDispatcherStream<Transform, Filter, B, T>::call(src, dst, borderValue, stream, cc20);
+                    WarpDispatcherStream<Transform, Filter, B, T>::call(transform, src, dst, borderValue, stream, cc20);
             }
         };
 
         template <class Transform, typename T>
-        void warp_caller(PtrStepSzb src, PtrStepSzb srcWhole, int xoff, int yoff, PtrStepSzb dst, int interpolation,
+        void warp_caller(const Transform& transform, PtrStepSzb src, PtrStepSzb srcWhole, int xoff, int yoff, PtrStepSzb dst, int interpolation,
                          int borderMode, const float* borderValue, cudaStream_t stream, bool cc20)
         {
-            typedef void (*func_t)(PtrStepSz<T> src, PtrStepSz<T> srcWhole, int xoff, int yoff, PtrStepSz<T> dst, const float* borderValue, cudaStream_t stream, bool cc20);
+            typedef void (*func_t)(const Transform& transform, PtrStepSz<T> src, PtrStepSz<T> srcWhole, int xoff, int yoff, PtrStepSz<T> dst, const float* borderValue, cudaStream_t stream, bool cc20);
 
             static const func_t funcs[3][5] =
             {
@@ -303,16 +316,14 @@ namespace cv { namespace cuda { namespace device
                 }
             };
 
-            funcs[interpolation][borderMode](static_cast< PtrStepSz<T> >(src), static_cast< PtrStepSz<T> >(srcWhole), xoff, yoff,
+            funcs[interpolation][borderMode](transform, static_cast< PtrStepSz<T> >(src), static_cast< PtrStepSz<T> >(srcWhole), xoff, yoff,
                 static_cast< PtrStepSz<T> >(dst), borderValue, stream, cc20);
         }
 
         template <typename T> void warpAffine_gpu(PtrStepSzb src, PtrStepSzb srcWhole, int xoff, int yoff, float coeffs[2 * 3], PtrStepSzb dst, int interpolation,
                                                   int borderMode, const float* borderValue, cudaStream_t stream, bool cc20)
         {
-            cudaSafeCall( cudaMemcpyToSymbol(c_warpMat, coeffs, 2 * 3 * sizeof(float)) );
-
-            warp_caller<AffineTransform, T>(src, srcWhole, xoff, yoff, dst, interpolation, borderMode, borderValue, stream, cc20);
+            warp_caller<AffineTransform, T>(AffineTransform(coeffs), src, srcWhole, xoff, yoff, dst, interpolation, borderMode, borderValue, stream, cc20);
         }
 
         template void warpAffine_gpu<uchar >(PtrStepSzb src, PtrStepSzb srcWhole, int xoff, int yoff, float coeffs[2 * 3], PtrStepSzb dst, int interpolation, int borderMode, const float* borderValue, cudaStream_t stream, bool cc20);
@@ -348,9 +359,7 @@ namespace cv { namespace cuda { namespace device
         template <typename T> void warpPerspective_gpu(PtrStepSzb src, PtrStepSzb srcWhole, int xoff, int yoff, float coeffs[3 * 3], PtrStepSzb dst, int interpolation,
                                                   int borderMode, const float* borderValue, cudaStream_t stream, bool cc20)
         {
-            cudaSafeCall( cudaMemcpyToSymbol(c_warpMat, coeffs, 3 * 3 * sizeof(float)) );
-
-            warp_caller<PerspectiveTransform, T>(src, srcWhole, xoff, yoff, dst, interpolation, borderMode, borderValue, stream, cc20);
+            warp_caller<PerspectiveTransform, T>(PerspectiveTransform(coeffs), src, srcWhole, xoff, yoff, dst, interpolation, borderMode, borderValue, stream, cc20);
         }
 
         template void warpPerspective_gpu<uchar >(PtrStepSzb src, PtrStepSzb srcWhole, int xoff, int yoff, float coeffs[3 * 3], PtrStepSzb dst, int interpolation, int borderMode, const float* borderValue, cudaStream_t stream, bool cc20);
@@ -0,0 +1,143 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#if !defined CUDA_DISABLER
+
+#include "opencv2/core/cuda/common.hpp"
+#include "opencv2/core/cuda/vec_traits.hpp"
+#include "opencv2/core/cuda/vec_math.hpp"
+#include <cuda_fp16.h>
+
+namespace cv { namespace cuda { namespace device
+{
+    namespace imgproc
+    {
+        // Inverse transformation of one output image and the source rectangle it reads from,
+        // the rectangle bounds the replicated border or the region outside of which the constant border is used.
+        struct WarpBlobItem
+        {
+            float m[2 * 3];
+            int x0, y0, x1, y1;
+        };
+
+        __device__ __forceinline__ float4 toFloat4(uchar v) { return make_float4(v, 0.f, 0.f, 0.f); }
+        __device__ __forceinline__ float4 toFloat4(const uchar3& v) { return make_float4(v.x, v.y, v.z, 0.f); }
+        __device__ __forceinline__ float4 toFloat4(const uchar4& v) { return make_float4(v.x, v.y, v.z, v.w); }
+
+        __device__ __forceinline__ float channel(const float4& v, int c)
+        {
+            return c == 0 ? v.x : c == 1 ? v.y : c == 2 ? v.z : v.w;
+        }
+
+        __device__ __forceinline__ void storeBlob(float* dst, float val) { *dst = val; }
+        __device__ __forceinline__ void storeBlob(__half* dst, float val) { *dst = __float2half_rn(val); }
+
+        template <typename T, bool replicate>
+        __device__ __forceinline__ float4 readBlobSrc(const PtrStep<T>& src, const WarpBlobItem& item, int y, int x, const float4& borderValue)
+        {
+            if (replicate)
+            {
+                x = ::min(::max(x, item.x0), item.x1 - 1);
+                y = ::min(::max(y, item.y0), item.y1 - 1);
+            }
+            else if (x < item.x0 || x >= item.x1 || y < item.y0 || y >= item.y1)
+            {
+                return borderValue;
+            }
+
+            return toFloat4(src(y, x));
+        }
+
+        // blockIdx.z is the output image, every thread writes all channels of one output pixel
+        template <typename T, typename D, bool linear, bool replicate>
+        __global__ void warpBlob(const PtrStep<T> src, const WarpBlobItem* items, PtrStep<D> blob, const int dcols, const int drows, const int dcn,
+                                 const float4 mean, const float scale, const bool swapRB, const float4 borderValue)
+        {
+            const int x = blockDim.x * blockIdx.x + threadIdx.x;
+            const int y = blockDim.y * blockIdx.y + threadIdx.y;
+            const int n = blockIdx.z;
+
+            if (x >= dcols || y >= drows)
+                return;
+
+            const WarpBlobItem item = items[n];
+
+            const float xcoo = item.m[0] * x + item.m[1] * y + item.m[2];
+            const float ycoo = item.m[3] * x + item.m[4] * y + item.m[5];
+
+            float4 val;
+            if (linear)
+            {
+                const int x1 = __float2int_rd(xcoo);
+                const int y1 = __float2int_rd(ycoo);
+                const float ax = xcoo - x1;
+                const float ay = ycoo - y1;
+
+                val = readBlobSrc<T, replicate>(src, item, y1, x1, borderValue) * ((1.f - ax) * (1.f - ay)) +
+                      readBlobSrc<T, replicate>(src, item, y1, x1 + 1, borderValue) * (ax * (1.f - ay)) +
+                      readBlobSrc<T, replicate>(src, item, y1 + 1, x1, borderValue) * ((1.f - ax) * ay) +
+                      readBlobSrc<T, replicate>(src, item, y1 + 1, x1 + 1, borderValue) * (ax * ay);
+            }
+            else
+            {
+                val = readBlobSrc<T, replicate>(src, item, __float2int_rd(ycoo), __float2int_rd(xcoo), borderValue);
+            }
+
+            for (int c = 0; c < dcn; ++c)
+            {
+                const int sc = swapRB ? dcn - 1 - c : c;
+                storeBlob(blob.ptr((n * dcn + c) * drows + y) + x, (channel(val, sc) - channel(mean, c)) * scale);
+            }
+        }
+
+        template <typename T, typename D, bool linear, bool replicate>
+        void warpBlob_caller(PtrStepSzb src, const void* items, int nitems, PtrStepSzb blob, int dcols, int drows, int dcn,
+                             const float* mean, float scale, bool swapRB, const float* borderValue, cudaStream_t stream)
+        {
+            const dim3 block(32, 8);
+            const dim3 grid(divUp(dcols, block.x), divUp(drows, block.y), nitems);
+
+            warpBlob<T, D, linear, replicate><<<grid, block, 0, stream>>>((PtrStep<T>)src, (const WarpBlobItem*)items, (PtrStep<D>)blob,
+                dcols, drows, dcn, make_float4(mean[0], mean[1], mean[2], mean[3]), scale, swapRB,
+                make_float4(borderValue[0], borderValue[1], borderValue[2], borderValue[3]));
+            cudaSafeCall( cudaGetLastError() );
+
+            if (stream == 0)
+                cudaSafeCall( cudaDeviceSynchronize() );
+        }
+
+        template <typename T, typename D>
+        void warpBlob_dispatch(PtrStepSzb src, const void* items, int nitems, PtrStepSzb blob, int dcols, int drows, int dcn,
+                               const float* mean, float scale, bool swapRB, bool linear, bool replicate, const float* borderValue, cudaStream_t stream)
+        {
+            typedef void (*func_t)(PtrStepSzb src, const void* items, int nitems, PtrStepSzb blob, int dcols, int drows, int dcn,
+                                   const float* mean, float scale, bool swapRB, const float* borderValue, cudaStream_t stream);
+
+            static const func_t funcs[2][2] =
+            {
+                { warpBlob_caller<T, D, false, false>, warpBlob_caller<T, D, false, true> },
+                { warpBlob_caller<T, D, true, false>,  warpBlob_caller<T, D, true, true>  }
+            };
+
+            funcs[linear][replicate](src, items, nitems, blob, dcols, drows, dcn, mean, scale, swapRB, borderValue, stream);
+        }
+
+        void warpBlob_gpu(PtrStepSzb src, int scn, const void* items, int nitems, PtrStepSzb blob, bool half, int dcols, int drows, int dcn,
+                          const float* mean, float scale, bool swapRB, bool linear, bool replicate, const float* borderValue, cudaStream_t stream)
+        {
+            typedef void (*func_t)(PtrStepSzb src, const void* items, int nitems, PtrStepSzb blob, int dcols, int drows, int dcn,
+                                   const float* mean, float scale, bool swapRB, bool linear, bool replicate, const float* borderValue, cudaStream_t stream);
+
+            static const func_t funcs[2][4] =
+            {
+                { warpBlob_dispatch<uchar, float>,  0, warpBlob_dispatch<uchar3, float>,  warpBlob_dispatch<uchar4, float>  },
+                { warpBlob_dispatch<uchar, __half>, 0, warpBlob_dispatch<uchar3, __half>, warpBlob_dispatch<uchar4, __half> }
+            };
+
+            funcs[half][scn - 1](src, items, nitems, blob, dcols, drows, dcn, mean, scale, swapRB, linear, replicate, borderValue, stream);
+        }
+    }
+}}}
+
+#endif /* CUDA_DISABLER */
@@ -47,4 +47,10 @@
 
 #include "opencv2/core/private.cuda.hpp"
 
+#include "opencv2/opencv_modules.hpp"
+
+#ifdef HAVE_OPENCV_CUDEV
+#  include "opencv2/cudev/util/graph_pipeline.hpp"
+#endif
+
 #endif /* __OPENCV_PRECOMP_H__ */
@@ -243,6 +243,10 @@ void cv::cuda::warpAffine(InputArray _src, OutputArray _dst, InputArray _M, Size
     bool useNpp = borderMode == BORDER_CONSTANT && ofs.x == 0 && ofs.y == 0 && useNppTab[src.depth()][src.channels() - 1][interpolation];
     // NPP bug on float data
     useNpp = useNpp && src.depth() != CV_32F;
+#ifdef HAVE_OPENCV_CUDEV
+    // NppStreamHandler switches the global NPP stream, it can not be recorded into a CUDA graph
+    useNpp = useNpp && !cudev::isStreamCapturing(stream);
+#endif
 
     if (useNpp)
     {
@@ -382,6 +386,10 @@ void cv::cuda::warpPerspective(InputArray _src, OutputArray _dst, InputArray _M,
     bool useNpp = borderMode == BORDER_CONSTANT && ofs.x == 0 && ofs.y == 0 && useNppTab[src.depth()][src.channels() - 1][interpolation];
     // NPP bug on float data
     useNpp = useNpp && src.depth() != CV_32F;
+#ifdef HAVE_OPENCV_CUDEV
+    // NppStreamHandler switches the global NPP stream, it can not be recorded into a CUDA graph
+    useNpp = useNpp && !cudev::isStreamCapturing(stream);
+#endif
 
     if (useNpp)
     {
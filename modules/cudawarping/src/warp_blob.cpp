@@ -0,0 +1,155 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+using namespace cv;
+using namespace cv::cuda;
+
+#if !defined HAVE_CUDA || defined(CUDA_DISABLER)
+
+void cv::cuda::warpAffineBlob(InputArray, OutputArray, const std::vector<Mat>&, Size, double, const Scalar&, bool, int, int, int, Scalar, Stream&) { throw_no_cuda(); }
+void cv::cuda::resizeBlob(InputArray, OutputArray, const std::vector<Rect>&, Size, double, const Scalar&, bool, int, int, Stream&) { throw_no_cuda(); }
+
+#else // HAVE_CUDA
+
+namespace cv { namespace cuda { namespace device
+{
+    namespace imgproc
+    {
+        void warpBlob_gpu(PtrStepSzb src, int scn, const void* items, int nitems, PtrStepSzb blob, bool half, int dcols, int drows, int dcn,
+                          const float* mean, float scale, bool swapRB, bool linear, bool replicate, const float* borderValue, cudaStream_t stream);
+    }
+}}}
+
+namespace
+{
+    // same layout as cv::cuda::device::imgproc::WarpBlobItem
+    struct WarpBlobItem
+    {
+        float m[2 * 3];
+        int x0, y0, x1, y1;
+    };
+
+    void warpBlob(const GpuMat& src, OutputArray _blob, const std::vector<WarpBlobItem>& items, Size dsize,
+                  double scale, const Scalar& mean, bool swapRB, int ddepth, bool linear, bool replicate,
+                  const Scalar& borderValue, Stream& stream)
+    {
+        using namespace cv::cuda::device::imgproc;
+
+        CV_Assert( src.type() == CV_8UC1 || src.type() == CV_8UC3 || src.type() == CV_8UC4 );
+        CV_Assert( ddepth == CV_32F || ddepth == CV_16F );
+        CV_Assert( dsize.area() > 0 );
+
+        const int scn = src.channels();
+        const int dcn = scn == 1 ? 1 : 3;
+        const int nitems = static_cast<int>(items.size());
+
+        if (nitems == 0)
+        {
+            _blob.release();
+            return;
+        }
+
+        GpuMat blob;
+        if (_blob.kind() == _InputArray::CUDA_GPU_MAT)
+        {
+            GpuMat& dst = _blob.getGpuMatRef();
+            if (dst.rows != nitems * dcn * dsize.height || dst.cols != dsize.width || dst.type() != ddepth || !dst.isContinuous())
+                dst = createContinuous(nitems * dcn * dsize.height, dsize.width, ddepth);
+            blob = dst;
+        }
+        else
+        {
+            _blob.create(nitems * dcn * dsize.height, dsize.width, ddepth);
+            blob = _blob.getGpuMat();
+        }
+
+        BufferPool pool(stream);
+        GpuMat d_items = pool.getBuffer(1, nitems * static_cast<int>(sizeof(WarpBlobItem)), CV_8UC1);
+        d_items.upload(Mat(1, d_items.cols, CV_8UC1, (void*)&items[0]), stream);
+
+        Scalar_<float> meanf = mean;
+        Scalar_<float> borderValuef = borderValue;
+
+        warpBlob_gpu(src, scn, d_items.data, nitems, blob, ddepth == CV_16F, dsize.width, dsize.height, dcn,
+                     meanf.val, static_cast<float>(scale), swapRB, linear, replicate, borderValuef.val, StreamAccessor::getStream(stream));
+    }
+}
+
+void cv::cuda::warpAffineBlob(InputArray _src, OutputArray _blob, const std::vector<Mat>& M, Size dsize,
+                              double scale, const Scalar& mean, bool swapRB, int ddepth,
+                              int flags, int borderMode, Scalar borderValue, Stream& stream)
+{
+    GpuMat src = _src.getGpuMat();
+
+    const int interpolation = flags & INTER_MAX;
+
+    CV_Assert( interpolation == INTER_NEAREST || interpolation == INTER_LINEAR );
+    CV_Assert( borderMode == BORDER_CONSTANT || borderMode == BORDER_REPLICATE );
+
+    std::vector<WarpBlobItem> items(M.size());
+    for (size_t i = 0; i < M.size(); ++i)
+    {
+        CV_Assert( M[i].rows == 2 && M[i].cols == 3 );
+
+        Mat coeffsMat(2, 3, CV_32F, (void*)items[i].m);
+
+        if (flags & WARP_INVERSE_MAP)
+            M[i].convertTo(coeffsMat, coeffsMat.type());
+        else
+        {
+            cv::Mat iM;
+            invertAffineTransform(M[i], iM);
+            iM.convertTo(coeffsMat, coeffsMat.type());
+        }
+
+        items[i].x0 = 0;
+        items[i].y0 = 0;
+        items[i].x1 = src.cols;
+        items[i].y1 = src.rows;
+    }
+
+    warpBlob(src, _blob, items, dsize, scale, mean, swapRB, ddepth, interpolation == INTER_LINEAR,
+             borderMode == BORDER_REPLICATE, borderValue, stream);
+}
+
+void cv::cuda::resizeBlob(InputArray _src, OutputArray _blob, const std::vector<Rect>& rois, Size dsize,
+                          double scale, const Scalar& mean, bool swapRB, int ddepth,
+                          int interpolation, Stream& stream)
+{
+    GpuMat src = _src.getGpuMat();
+
+    CV_Assert( interpolation == INTER_NEAREST || interpolation == INTER_LINEAR );
+    CV_Assert( dsize.area() > 0 );
+
+    std::vector<WarpBlobItem> items(rois.size());
+    for (size_t i = 0; i < rois.size(); ++i)
+    {
+        const Rect& roi = rois[i];
+        CV_Assert( roi.area() > 0 && 0 <= roi.x && roi.x + roi.width <= src.cols && 0 <= roi.y && roi.y + roi.height <= src.rows );
+
+        const float fx = static_cast<float>(roi.width) / dsize.width;
+        const float fy = static_cast<float>(roi.height) / dsize.height;
+
+        // pixel centers are aligned for the bilinear interpolation, as in cuda::resize
+        const float shift = interpolation == INTER_LINEAR ? 0.5f : 0.f;
+
+        WarpBlobItem& item = items[i];
+        item.m[0] = fx;
+        item.m[1] = 0.f;
+        item.m[2] = roi.x + shift * fx - shift;
+        item.m[3] = 0.f;
+        item.m[4] = fy;
+        item.m[5] = roi.y + shift * fy - shift;
+        item.x0 = roi.x;
+        item.y0 = roi.y;
+        item.x1 = roi.x + roi.width;
+        item.y1 = roi.y + roi.height;
+    }
+
+    warpBlob(src, _blob, items, dsize, scale, mean, swapRB, ddepth, interpolation == INTER_LINEAR, true, Scalar(), stream);
+}
+
+#endif // HAVE_CUDA
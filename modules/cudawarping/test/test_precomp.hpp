@@ -47,6 +47,11 @@
 
 #include "opencv2/cudawarping.hpp"
 
+#include "opencv2/opencv_modules.hpp"
+#ifdef HAVE_OPENCV_CUDEV
+#  include "opencv2/cudev/util/graph_pipeline.hpp"
+#endif
+
 #include "cvconfig.h"
 
 #include "interpolation.hpp"
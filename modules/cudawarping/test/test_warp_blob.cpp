@@ -0,0 +1,136 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+#ifdef HAVE_CUDA
+
+namespace opencv_test { namespace {
+
+namespace
+{
+    // planes of one image of the tensor in the way cuda::warpAffineBlob lays them out
+    void blobFromImageGold(const cv::Mat& img, cv::Mat& blob, int n, double scale, const cv::Scalar& mean, bool swapRB)
+    {
+        std::vector<cv::Mat> channels;
+        cv::split(img, channels);
+        const int dcn = img.channels() == 1 ? 1 : 3;
+
+        for (int c = 0; c < dcn; ++c)
+        {
+            const int sc = swapRB ? dcn - 1 - c : c;
+            cv::Mat plane = blob.rowRange((n * dcn + c) * img.rows, (n * dcn + c + 1) * img.rows);
+            channels[sc].convertTo(plane, CV_32F, scale, -mean[c] * scale);
+        }
+    }
+}
+
+PARAM_TEST_CASE(WarpAffineBlob, cv::cuda::DeviceInfo, MatType, Interpolation, bool)
+{
+    cv::cuda::DeviceInfo devInfo;
+    int type;
+    int interpolation;
+    bool swapRB;
+
+    virtual void SetUp()
+    {
+        devInfo = GET_PARAM(0);
+        type = GET_PARAM(1);
+        interpolation = GET_PARAM(2);
+        swapRB = GET_PARAM(3);
+
+        cv::cuda::setDevice(devInfo.deviceID());
+    }
+};
+
+CUDA_TEST_P(WarpAffineBlob, Accuracy)
+{
+    cv::Mat src = randomMat(cv::Size(320, 240), type);
+    const cv::Size dsize(96, 64);
+    const double scale = 1.0 / 255;
+    const cv::Scalar mean(104, 117, 123);
+    const int dcn = src.channels() == 1 ? 1 : 3;
+
+    std::vector<cv::Mat> M;
+    M.push_back(cv::getRotationMatrix2D(cv::Point2f(100, 80), 30.0, 1.5));
+    M.push_back(cv::getRotationMatrix2D(cv::Point2f(200, 120), -45.0, 0.5));
+    M.push_back(cv::getRotationMatrix2D(cv::Point2f(160, 120), 0.0, 0.3));
+
+    cv::cuda::GpuMat dst;
+    cv::cuda::warpAffineBlob(loadMat(src), dst, M, dsize, scale, mean, swapRB, CV_32F, interpolation);
+
+    ASSERT_EQ(static_cast<int>(M.size()) * dcn * dsize.height, dst.rows);
+    ASSERT_EQ(dsize.width, dst.cols);
+    ASSERT_TRUE(dst.isContinuous());
+
+    cv::Mat dst_gold(dst.size(), CV_32FC1);
+    for (size_t i = 0; i < M.size(); ++i)
+    {
+        cv::Mat warped;
+        cv::warpAffine(src, warped, M[i], dsize, interpolation, cv::BORDER_CONSTANT);
+        blobFromImageGold(warped, dst_gold, static_cast<int>(i), scale, mean, swapRB);
+    }
+
+    EXPECT_MAT_NEAR(dst_gold, dst, 1.5 * scale);
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_Warping, WarpAffineBlob, testing::Combine(
+    ALL_DEVICES,
+    testing::Values(MatType(CV_8UC1), MatType(CV_8UC3), MatType(CV_8UC4)),
+    testing::Values(Interpolation(cv::INTER_NEAREST), Interpolation(cv::INTER_LINEAR)),
+    testing::Bool()));
+
+/////////////////
+
+PARAM_TEST_CASE(ResizeBlob, cv::cuda::DeviceInfo, MatType, Interpolation)
+{
+    cv::cuda::DeviceInfo devInfo;
+    int type;
+    int interpolation;
+
+    virtual void SetUp()
+    {
+        devInfo = GET_PARAM(0);
+        type = GET_PARAM(1);
+        interpolation = GET_PARAM(2);
+
+        cv::cuda::setDevice(devInfo.deviceID());
+    }
+};
+
+CUDA_TEST_P(ResizeBlob, Accuracy)
+{
+    cv::Mat src = randomMat(cv::Size(320, 240), type);
+    const cv::Size dsize(64, 64);
+    const cv::Scalar mean(127.5, 127.5, 127.5);
+
+    std::vector<cv::Rect> rois;
+    rois.push_back(cv::Rect(0, 0, 100, 120));
+    rois.push_back(cv::Rect(150, 40, 170, 200));
+    rois.push_back(cv::Rect(10, 200, 32, 32));
+
+    cv::cuda::GpuMat dst;
+    cv::cuda::resizeBlob(loadMat(src), dst, rois, dsize, 1.0, mean, true, CV_16F, interpolation);
+
+    cv::Mat dst_gold(dst.size(), CV_32FC1);
+    for (size_t i = 0; i < rois.size(); ++i)
+    {
+        cv::Mat resized;
+        cv::resize(src(rois[i]), resized, dsize, 0, 0, interpolation);
+        blobFromImageGold(resized, dst_gold, static_cast<int>(i), 1.0, mean, true);
+    }
+
+    cv::Mat dst32;
+    cv::Mat(dst).convertTo(dst32, CV_32F);
+
+    EXPECT_MAT_NEAR(dst_gold, dst32, 1.5);
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_Warping, ResizeBlob, testing::Combine(
+    ALL_DEVICES,
+    testing::Values(MatType(CV_8UC1), MatType(CV_8UC3), MatType(CV_8UC4)),
+    testing::Values(Interpolation(cv::INTER_NEAREST), Interpolation(cv::INTER_LINEAR))));
+
+}} // namespace
+#endif // HAVE_CUDA
@@ -280,6 +280,59 @@ INSTANTIATE_TEST_CASE_P(CUDA_Warping, WarpPerspectiveNPP, testing::Combine(
     DIRECT_INVERSE,
     testing::Values(Interpolation(cv::INTER_NEAREST), Interpolation(cv::INTER_LINEAR), Interpolation(cv::INTER_CUBIC))));
 
+#ifdef HAVE_OPENCV_CUDEV
+
+///////////////////////////////////////////////////////////////////
+// Test CUDA graph capture
+
+PARAM_TEST_CASE(WarpPerspectiveGraph, cv::cuda::DeviceInfo, MatType)
+{
+    cv::cuda::DeviceInfo devInfo;
+    int type;
+
+    virtual void SetUp()
+    {
+        devInfo = GET_PARAM(0);
+        type = GET_PARAM(1);
+
+        cv::cuda::setDevice(devInfo.deviceID());
+    }
+};
+
+CUDA_TEST_P(WarpPerspectiveGraph, Replay)
+{
+    const cv::Size size(640, 480);
+    cv::Mat M = createTransformMatrix(size, CV_PI / 4);
+
+    cv::cuda::Stream stream;
+    cv::cuda::GpuMat d_src(size, type), d_dst(size, type);
+
+    cv::cudev::GraphPipeline graph(stream);
+    graph.record([&](cv::cuda::Stream& s) { cv::cuda::warpPerspective(d_src, d_dst, M, size, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar::all(0), s); });
+    ASSERT_TRUE(graph.isRecorded());
+
+    for (int i = 0; i < 2; ++i)
+    {
+        cv::Mat src = randomMat(size, type);
+        d_src.upload(src, stream);
+        graph.launch();
+
+        cv::Mat dst;
+        d_dst.download(dst, stream);
+        stream.waitForCompletion();
+
+        cv::Mat dst_gold;
+        warpPerspectiveGold(src, M, false, size, dst_gold, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar::all(0));
+
+        EXPECT_MAT_NEAR(dst_gold, dst, src.depth() == CV_32F ? 1e-1 : 1.0);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(CUDA_Warping, WarpPerspectiveGraph, testing::Combine(
+    ALL_DEVICES,
+    testing::Values(MatType(CV_8UC1), MatType(CV_8UC4), MatType(CV_32FC1))));
+
+#endif // HAVE_OPENCV_CUDEV
 
 }} // namespace
 #endif // HAVE_CUDA
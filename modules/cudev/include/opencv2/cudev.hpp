@@ -49,9 +49,11 @@
 #include "cudev/common.hpp"
 
 #include "cudev/util/atomic.hpp"
+#include "cudev/util/graph_pipeline.hpp"
 #include "cudev/util/limits.hpp"
 #include "cudev/util/saturate_cast.hpp"
 #include "cudev/util/simd_functions.hpp"
+#include "cudev/util/stream_allocator.hpp"
 #include "cudev/util/tuple.hpp"
 #include "cudev/util/type_traits.hpp"
 #include "cudev/util/vec_math.hpp"
@@ -0,0 +1,91 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#pragma once
+
+#ifndef OPENCV_CUDEV_UTIL_GRAPH_PIPELINE_HPP
+#define OPENCV_CUDEV_UTIL_GRAPH_PIPELINE_HPP
+
+#include "../common.hpp"
+#include <functional>
+
+namespace cv { namespace cudev {
+
+//! @addtogroup cudev
+//! @{
+
+/** @brief Returns true if the stream is being captured into a CUDA graph.
+
+Algorithms use it to avoid the code paths which cannot be captured, e.g. NPP functions which change the global NPP
+stream. Always false with CUDA runtimes older than 10.1.
+ */
+CV_EXPORTS bool isStreamCapturing(Stream& stream);
+
+/** @brief Records a sequence of CUDA algorithm calls into a CUDA graph once and replays it.
+
+Replaying a graph launches all of its kernels with a single call, which removes most of the launch overhead of
+pipelines made of many small kernels. The recorded calls must use the same buffers for every frame, so the inputs are
+copied into (or decoded to) the buffers used while recording, and all the outputs and temporary buffers have to be
+sized before recording. While recording, allocations and synchronizations on the recording thread raise an error.
+
+@code
+    cv::cuda::Stream stream;
+    cv::cuda::GpuMat frame(1080, 1920, CV_8UC3), small, gray, blurred, warped, mask;
+    // size the outputs with a first run
+    pipeline(frame, small, gray, blurred, warped, mask, stream);
+
+    cv::cudev::GraphPipeline graph(stream);
+    graph.record([&](cv::cuda::Stream& s) { pipeline(frame, small, gray, blurred, warped, mask, s); });
+
+    for (;;)
+    {
+        frame.upload(hostFrame, stream);
+        graph.launch();
+        mask.download(hostMask, stream);
+        stream.waitForCompletion();
+    }
+@endcode
+
+Kernel arguments such as the warp matrix are part of the graph. To change them record again, which updates the
+instantiated graph in place when its topology has not changed.
+ */
+class CV_EXPORTS GraphPipeline
+{
+public:
+    //! @param stream Stream to record the calls on and to launch the graph on, it can not be the default stream.
+    explicit GraphPipeline(Stream& stream);
+    ~GraphPipeline();
+
+    //! Starts the capture of the calls made on the stream by the current thread.
+    void beginCapture();
+    //! Ends the capture and instantiates the graph.
+    void endCapture();
+
+    //! Captures the calls made by body on the stream.
+    void record(const std::function<void(Stream&)>& body);
+
+    //! Launches the recorded graph on the stream.
+    void launch();
+
+    bool isRecorded() const { return exec_ != 0; }
+    bool isCapturing() const { return capturing_; }
+
+    //! Releases the recorded graph.
+    void reset();
+
+private:
+    GraphPipeline(const GraphPipeline&);
+    GraphPipeline& operator=(const GraphPipeline&);
+
+    Stream& stream_;
+    void* graph_;
+    void* exec_;
+    bool capturing_;
+};
+
+//! @}
+
+}}
+
+#endif
@@ -0,0 +1,103 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#pragma once
+
+#ifndef OPENCV_CUDEV_UTIL_STREAM_ALLOCATOR_HPP
+#define OPENCV_CUDEV_UTIL_STREAM_ALLOCATOR_HPP
+
+#include "../common.hpp"
+#include <vector>
+
+namespace cv { namespace cudev {
+
+//! @addtogroup cudev
+//! @{
+
+/** @brief Allocation statistics of the stream ordered allocator of a stream.
+ */
+struct StreamAllocationStats
+{
+    size_t allocations;  //!< Number of allocations since the creation of the allocator or the last reset.
+    size_t currentBytes; //!< Size of the buffers which are not freed yet.
+    size_t peakBytes;    //!< Maximum of currentBytes since the creation of the allocator or the last reset.
+};
+
+/** @brief GpuMat allocator which allocates and frees buffers in the order of a stream.
+
+Buffers come from the memory pool of the device through cudaMallocAsync and are given back with cudaFreeAsync, so
+neither of them synchronizes the device. The pool keeps the freed memory for later allocations. With CUDA runtimes
+older than 11.2 the allocator falls back to cudaMalloc and cudaFree.
+
+A buffer must be released before the destruction of its stream.
+ */
+class CV_EXPORTS StreamOrderedAllocator : public GpuMat::Allocator
+{
+public:
+    explicit StreamOrderedAllocator(cudaStream_t stream);
+
+    bool allocate(GpuMat* mat, int rows, int cols, size_t elemSize) CV_OVERRIDE;
+    void free(GpuMat* mat) CV_OVERRIDE;
+
+    cudaStream_t stream() const { return stream_; }
+
+    StreamAllocationStats stats() const;
+    void resetStats();
+
+    //! Allocator of a stream, created on the first use and kept for the lifetime of the process.
+    static StreamOrderedAllocator* get(cudaStream_t stream);
+
+private:
+    struct Impl;
+
+    cudaStream_t stream_;
+    Ptr<Impl> impl_;
+};
+
+/** @brief Enables stream ordered allocation of the temporary buffers of the CUDA algorithms.
+
+It is disabled by default, the algorithms then use BufferPool or keep their buffers between calls.
+ */
+CV_EXPORTS void setStreamOrderedAllocation(bool enabled);
+CV_EXPORTS bool useStreamOrderedAllocation();
+
+//! Statistics of the stream ordered allocations made on a stream.
+CV_EXPORTS StreamAllocationStats getStreamAllocationStats(Stream& stream);
+CV_EXPORTS void resetStreamAllocationStats(Stream& stream);
+
+/** @brief Temporary buffers of an algorithm call.
+
+When stream ordered allocation is enabled the buffers come from the StreamOrderedAllocator of the stream, and the
+buffer members set by ensureSizeIsEnough() are released by the destructor, so that no memory stays bound to the stream
+after the call. Otherwise getBuffer() falls back to BufferPool and ensureSizeIsEnough() to cv::cuda::ensureSizeIsEnough,
+which keeps the members for the next call.
+ */
+class CV_EXPORTS ScratchPool
+{
+public:
+    explicit ScratchPool(Stream& stream);
+    ~ScratchPool();
+
+    GpuMat getBuffer(int rows, int cols, int type);
+    GpuMat getBuffer(Size size, int type) { return getBuffer(size.height, size.width, type); }
+
+    void ensureSizeIsEnough(int rows, int cols, int type, GpuMat& m);
+    void ensureSizeIsEnough(Size size, int type, GpuMat& m) { ensureSizeIsEnough(size.height, size.width, type, m); }
+
+    bool isStreamOrdered() const { return allocator_ != 0; }
+
+private:
+    ScratchPool(const ScratchPool&);
+    ScratchPool& operator=(const ScratchPool&);
+
+    Stream& stream_;
+    StreamOrderedAllocator* allocator_;
+    std::vector<GpuMat*> members_;
+};
+
+//! @}
+
+}}
+
+#endif
@@ -0,0 +1,159 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "opencv2/cudev/util/graph_pipeline.hpp"
+
+using namespace cv;
+using namespace cv::cuda;
+using namespace cv::cudev;
+
+#if CUDART_VERSION >= 10010
+#  define CV_CUDEV_HAVE_GRAPH_CAPTURE 1
+#endif
+
+bool cv::cudev::isStreamCapturing(Stream& stream)
+{
+#ifdef CV_CUDEV_HAVE_GRAPH_CAPTURE
+    cudaStream_t s = StreamAccessor::getStream(stream);
+    if (s == 0)
+        return false;
+
+    cudaStreamCaptureStatus status = cudaStreamCaptureStatusNone;
+    CV_CUDEV_SAFE_CALL( cudaStreamIsCapturing(s, &status) );
+    return status == cudaStreamCaptureStatusActive;
+#else
+    CV_UNUSED(stream);
+    return false;
+#endif
+}
+
+GraphPipeline::GraphPipeline(Stream& stream) :
+    stream_(stream), graph_(0), exec_(0), capturing_(false)
+{
+    CV_Assert( StreamAccessor::getStream(stream_) != 0 );
+#ifndef CV_CUDEV_HAVE_GRAPH_CAPTURE
+    CV_Error(Error::StsNotImplemented, "CUDA graph capture requires CUDA 10.1 or newer");
+#endif
+}
+
+GraphPipeline::~GraphPipeline()
+{
+#ifdef CV_CUDEV_HAVE_GRAPH_CAPTURE
+    if (capturing_)
+    {
+        cudaGraph_t graph = 0;
+        cudaStreamEndCapture(StreamAccessor::getStream(stream_), &graph);
+        if (graph)
+            cudaGraphDestroy(graph);
+    }
+    if (exec_)
+        cudaGraphExecDestroy(static_cast<cudaGraphExec_t>(exec_));
+    if (graph_)
+        cudaGraphDestroy(static_cast<cudaGraph_t>(graph_));
+#endif
+}
+
+void GraphPipeline::beginCapture()
+{
+    CV_Assert( !capturing_ );
+#ifdef CV_CUDEV_HAVE_GRAPH_CAPTURE
+    // Thread local mode turns the allocations and synchronizations made by the recorded calls into errors
+    // instead of silently baking their results into the graph
+    CV_CUDEV_SAFE_CALL( cudaStreamBeginCapture(StreamAccessor::getStream(stream_), cudaStreamCaptureModeThreadLocal) );
+    capturing_ = true;
+#endif
+}
+
+void GraphPipeline::endCapture()
+{
+    CV_Assert( capturing_ );
+#ifdef CV_CUDEV_HAVE_GRAPH_CAPTURE
+    capturing_ = false;
+
+    cudaGraph_t graph = 0;
+    CV_CUDEV_SAFE_CALL( cudaStreamEndCapture(StreamAccessor::getStream(stream_), &graph) );
+
+    if (exec_)
+    {
+        // the kernel arguments of an unchanged topology are updated in place, which is much cheaper than
+        // a new instantiation
+        bool updated = false;
+#if CUDART_VERSION >= 12000
+        cudaGraphExecUpdateResultInfo info;
+        updated = cudaGraphExecUpdate(static_cast<cudaGraphExec_t>(exec_), graph, &info) == cudaSuccess;
+#elif CUDART_VERSION >= 10020
+        cudaGraphNode_t errorNode;
+        cudaGraphExecUpdateResult result;
+        updated = cudaGraphExecUpdate(static_cast<cudaGraphExec_t>(exec_), graph, &errorNode, &result) == cudaSuccess;
+#endif
+        if (!updated)
+        {
+            // clear the error of the failed update
+            cudaGetLastError();
+            CV_CUDEV_SAFE_CALL( cudaGraphExecDestroy(static_cast<cudaGraphExec_t>(exec_)) );
+            exec_ = 0;
+        }
+    }
+
+    if (graph_)
+        CV_CUDEV_SAFE_CALL( cudaGraphDestroy(static_cast<cudaGraph_t>(graph_)) );
+    graph_ = graph;
+
+    if (!exec_)
+    {
+        cudaGraphExec_t exec = 0;
+#if CUDART_VERSION >= 12000
+        CV_CUDEV_SAFE_CALL( cudaGraphInstantiate(&exec, graph, 0) );
+#else
+        CV_CUDEV_SAFE_CALL( cudaGraphInstantiate(&exec, graph, 0, 0, 0) );
+#endif
+        exec_ = exec;
+    }
+#endif
+}
+
+void GraphPipeline::record(const std::function<void(Stream&)>& body)
+{
+    beginCapture();
+    try
+    {
+        body(stream_);
+    }
+    catch (...)
+    {
+#ifdef CV_CUDEV_HAVE_GRAPH_CAPTURE
+        // the stream can not be used again before the end of the capture
+        cudaGraph_t graph = 0;
+        cudaStreamEndCapture(StreamAccessor::getStream(stream_), &graph);
+        if (graph)
+            cudaGraphDestroy(graph);
+        cudaGetLastError();
+#endif
+        capturing_ = false;
+        throw;
+    }
+    endCapture();
+}
+
+void GraphPipeline::launch()
+{
+    CV_Assert( !capturing_ );
+    CV_Assert( isRecorded() );
+#ifdef CV_CUDEV_HAVE_GRAPH_CAPTURE
+    CV_CUDEV_SAFE_CALL( cudaGraphLaunch(static_cast<cudaGraphExec_t>(exec_), StreamAccessor::getStream(stream_)) );
+#endif
+}
+
+void GraphPipeline::reset()
+{
+    CV_Assert( !capturing_ );
+#ifdef CV_CUDEV_HAVE_GRAPH_CAPTURE
+    if (exec_)
+        CV_CUDEV_SAFE_CALL( cudaGraphExecDestroy(static_cast<cudaGraphExec_t>(exec_)) );
+    if (graph_)
+        CV_CUDEV_SAFE_CALL( cudaGraphDestroy(static_cast<cudaGraph_t>(graph_)) );
+#endif
+    exec_ = 0;
+    graph_ = 0;
+}
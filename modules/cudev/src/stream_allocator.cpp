@@ -0,0 +1,205 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "opencv2/cudev/util/stream_allocator.hpp"
+#include "opencv2/core/utility.hpp"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+using namespace cv;
+using namespace cv::cuda;
+using namespace cv::cudev;
+
+#if CUDART_VERSION >= 11020
+#  define CV_CUDEV_HAVE_MALLOC_ASYNC 1
+#endif
+
+namespace
+{
+    // keeps the step of 2D buffers suitable for texture binding
+    const size_t stepAlignment = 512;
+
+    bool streamOrderedAllocation = false;
+
+    std::mutex& registryMutex()
+    {
+        static std::mutex mtx;
+        return mtx;
+    }
+
+    std::map<cudaStream_t, StreamOrderedAllocator*>& registry()
+    {
+        static std::map<cudaStream_t, StreamOrderedAllocator*> allocators;
+        return allocators;
+    }
+
+    // The default pool gives its memory back to the system at every synchronization, which would make the
+    // stream ordered allocations as slow as cudaMalloc
+    void keepPoolMemory()
+    {
+#ifdef CV_CUDEV_HAVE_MALLOC_ASYNC
+        int device;
+        CV_CUDEV_SAFE_CALL( cudaGetDevice(&device) );
+
+        cudaMemPool_t pool;
+        CV_CUDEV_SAFE_CALL( cudaDeviceGetDefaultMemPool(&pool, device) );
+
+        unsigned long long threshold = ~0ull;
+        CV_CUDEV_SAFE_CALL( cudaMemPoolSetAttribute(pool, cudaMemPoolAttrReleaseThreshold, &threshold) );
+#endif
+    }
+}
+
+struct StreamOrderedAllocator::Impl
+{
+    mutable std::mutex mtx;
+    std::map<void*, size_t> sizes;
+    StreamAllocationStats stats;
+};
+
+StreamOrderedAllocator::StreamOrderedAllocator(cudaStream_t stream) :
+    stream_(stream),
+    impl_(makePtr<Impl>())
+{
+    resetStats();
+    keepPoolMemory();
+}
+
+bool StreamOrderedAllocator::allocate(GpuMat* mat, int rows, int cols, size_t elemSize)
+{
+    // single row or single column buffers must be continuous
+    const size_t step = (rows > 1 && cols > 1) ? alignSize(elemSize * cols, (int)stepAlignment) : elemSize * cols;
+    const size_t size = step * rows;
+
+    void* data = 0;
+#ifdef CV_CUDEV_HAVE_MALLOC_ASYNC
+    CV_CUDEV_SAFE_CALL( cudaMallocAsync(&data, size, stream_) );
+#else
+    CV_CUDEV_SAFE_CALL( cudaMalloc(&data, size) );
+#endif
+
+    mat->data = static_cast<uchar*>(data);
+    mat->step = step;
+    mat->refcount = static_cast<int*>(fastMalloc(sizeof(int)));
+
+    std::lock_guard<std::mutex> lock(impl_->mtx);
+    impl_->sizes[data] = size;
+    impl_->stats.allocations++;
+    impl_->stats.currentBytes += size;
+    impl_->stats.peakBytes = std::max(impl_->stats.peakBytes, impl_->stats.currentBytes);
+
+    return true;
+}
+
+void StreamOrderedAllocator::free(GpuMat* mat)
+{
+    {
+        std::lock_guard<std::mutex> lock(impl_->mtx);
+        std::map<void*, size_t>::iterator it = impl_->sizes.find(mat->datastart);
+        if (it != impl_->sizes.end())
+        {
+            impl_->stats.currentBytes -= it->second;
+            impl_->sizes.erase(it);
+        }
+    }
+
+#ifdef CV_CUDEV_HAVE_MALLOC_ASYNC
+    cudaFreeAsync(mat->datastart, stream_);
+#else
+    cudaFree(mat->datastart);
+#endif
+    fastFree(mat->refcount);
+}
+
+StreamAllocationStats StreamOrderedAllocator::stats() const
+{
+    std::lock_guard<std::mutex> lock(impl_->mtx);
+    return impl_->stats;
+}
+
+void StreamOrderedAllocator::resetStats()
+{
+    std::lock_guard<std::mutex> lock(impl_->mtx);
+    impl_->stats.allocations = 0;
+    impl_->stats.currentBytes = 0;
+    for (std::map<void*, size_t>::const_iterator it = impl_->sizes.begin(); it != impl_->sizes.end(); ++it)
+        impl_->stats.currentBytes += it->second;
+    impl_->stats.peakBytes = impl_->stats.currentBytes;
+}
+
+StreamOrderedAllocator* StreamOrderedAllocator::get(cudaStream_t stream)
+{
+    std::lock_guard<std::mutex> lock(registryMutex());
+
+    StreamOrderedAllocator*& allocator = registry()[stream];
+    if (!allocator)
+        allocator = new StreamOrderedAllocator(stream);
+
+    return allocator;
+}
+
+void cv::cudev::setStreamOrderedAllocation(bool enabled)
+{
+    streamOrderedAllocation = enabled;
+}
+
+bool cv::cudev::useStreamOrderedAllocation()
+{
+    return streamOrderedAllocation;
+}
+
+StreamAllocationStats cv::cudev::getStreamAllocationStats(Stream& stream)
+{
+    return StreamOrderedAllocator::get(StreamAccessor::getStream(stream))->stats();
+}
+
+void cv::cudev::resetStreamAllocationStats(Stream& stream)
+{
+    StreamOrderedAllocator::get(StreamAccessor::getStream(stream))->resetStats();
+}
+
+ScratchPool::ScratchPool(Stream& stream) :
+    stream_(stream),
+    allocator_(streamOrderedAllocation ? StreamOrderedAllocator::get(StreamAccessor::getStream(stream)) : 0)
+{
+}
+
+ScratchPool::~ScratchPool()
+{
+    for (size_t i = 0; i < members_.size(); ++i)
+    {
+        members_[i]->release();
+        members_[i]->allocator = GpuMat::defaultAllocator();
+    }
+}
+
+GpuMat ScratchPool::getBuffer(int rows, int cols, int type)
+{
+    if (allocator_)
+        return GpuMat(rows, cols, type, allocator_);
+
+    BufferPool pool(stream_);
+    return pool.getBuffer(rows, cols, type);
+}
+
+void ScratchPool::ensureSizeIsEnough(int rows, int cols, int type, GpuMat& m)
+{
+    if (!allocator_)
+    {
+        cv::cuda::ensureSizeIsEnough(rows, cols, type, m);
+        return;
+    }
+
+    if (m.allocator != allocator_)
+    {
+        m.release();
+        m.allocator = allocator_;
+    }
+    cv::cuda::ensureSizeIsEnough(rows, cols, type, m);
+
+    if (std::find(members_.begin(), members_.end(), &m) == members_.end())
+        members_.push_back(&m);
+}
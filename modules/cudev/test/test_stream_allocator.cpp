@@ -0,0 +1,69 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace cv::cuda;
+using namespace cv::cudev;
+using namespace cvtest;
+
+namespace opencv_test { namespace {
+
+TEST(StreamOrderedAllocator, AllocateAndFree)
+{
+    Stream stream;
+    StreamOrderedAllocator* allocator = StreamOrderedAllocator::get(StreamAccessor::getStream(stream));
+    ASSERT_TRUE(allocator != 0);
+    allocator->resetStats();
+
+    {
+        GpuMat m(480, 640, CV_8UC3, allocator);
+        ASSERT_FALSE(m.empty());
+        EXPECT_EQ(0u, m.step % 512);
+
+        m.setTo(Scalar(1, 2, 3), stream);
+
+        Mat h;
+        m.download(h, stream);
+        stream.waitForCompletion();
+        EXPECT_MAT_NEAR(Mat(480, 640, CV_8UC3, Scalar(1, 2, 3)), h, 0.0);
+
+        const StreamAllocationStats st = allocator->stats();
+        EXPECT_EQ(1u, st.allocations);
+        EXPECT_GE(st.currentBytes, m.step * m.rows);
+    }
+
+    const StreamAllocationStats st = allocator->stats();
+    EXPECT_EQ(0u, st.currentBytes);
+    EXPECT_GT(st.peakBytes, 0u);
+}
+
+TEST(StreamOrderedAllocator, ScratchPoolReleasesMembers)
+{
+    Stream stream;
+    GpuMat member;
+
+    const bool prev = useStreamOrderedAllocation();
+    setStreamOrderedAllocation(true);
+    resetStreamAllocationStats(stream);
+    {
+        ScratchPool pool(stream);
+        ASSERT_TRUE(pool.isStreamOrdered());
+
+        pool.ensureSizeIsEnough(100, 200, CV_32FC1, member);
+        GpuMat buf = pool.getBuffer(10, 10, CV_32SC1);
+        EXPECT_EQ(100, member.rows);
+        EXPECT_EQ(200, member.cols);
+        EXPECT_FALSE(buf.empty());
+        EXPECT_EQ(2u, getStreamAllocationStats(stream).allocations);
+    }
+    setStreamOrderedAllocation(prev);
+
+    EXPECT_TRUE(member.empty());
+    EXPECT_EQ(GpuMat::defaultAllocator(), member.allocator);
+    EXPECT_EQ(0u, getStreamAllocationStats(stream).currentBytes);
+}
+
+}} // namespace
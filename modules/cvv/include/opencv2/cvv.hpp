@@ -17,6 +17,7 @@ See cvv tutorial for a commented example application using cvv.
 */
 
 #include <opencv2/cvv/call_meta_data.hpp>
+#include <opencv2/cvv/capture.hpp>
 #include <opencv2/cvv/debug_mode.hpp>
 #include <opencv2/cvv/dmatch.hpp>
 #include <opencv2/cvv/filter.hpp>
@@ -0,0 +1,132 @@
+#ifndef CVVISUAL_CAPTURE_HPP
+#define CVVISUAL_CAPTURE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "opencv2/core.hpp"
+
+#include "call_meta_data.hpp"
+#include "debug_mode.hpp"
+
+#ifdef CV_DOXYGEN
+#define CVVISUAL_DEBUGMODE
+#endif
+
+namespace cvv
+{
+
+//! @addtogroup cvv
+//! @{
+
+/**
+ * @brief Settings of the capture mode, in which the debug-calls are recorded
+ * in the background instead of being shown.
+ */
+struct CaptureSettings
+{
+	/**
+	 * @brief Number of captured calls kept in memory, the oldest ones are
+	 * dropped first.
+	 */
+	size_t capacity = 64;
+
+	/**
+	 * @brief Only one out of sampleEvery debug-calls is captured.
+	 */
+	size_t sampleEvery = 1;
+
+	/**
+	 * @brief If set, a sampled call is only captured if the condition
+	 * returns true for its location and description.
+	 */
+	std::function<bool(const impl::CallMetaData &, const char *)> condition;
+
+	/**
+	 * @brief Keep references to the images instead of copies.
+	 *
+	 * The captured images share the data of the ones passed to the calls,
+	 * which is only safe if the program does not modify them in place
+	 * afterwards (writing new images to the same variables is fine).
+	 */
+	bool shareImages = false;
+
+	/**
+	 * @brief If not empty, every captured call is also written to this file
+	 * by a background thread, to be viewed later with showCapture().
+	 *
+	 * The calls are dropped instead of blocking the program if the thread
+	 * falls behind by more than capacity calls.
+	 */
+	std::string file;
+};
+
+namespace impl
+{
+// implementation outside API
+CV_EXPORTS void startCapture(const CaptureSettings &settings);
+CV_EXPORTS void stopCapture();
+CV_EXPORTS void writeCapture(const std::string &file);
+CV_EXPORTS void showCapture(const std::string &file);
+} // namespace impl
+
+#ifdef CVVISUAL_DEBUGMODE
+/**
+ * @brief Starts capturing the debug-calls of all threads instead of showing
+ * them, until stopCapture() or finalShow() is called.
+ */
+static inline void startCapture(const CaptureSettings &settings = CaptureSettings())
+{
+	impl::startCapture(settings);
+}
+
+/**
+ * @brief Stops the capture mode and waits for the captured calls to be
+ * written to the file of the settings.
+ */
+static inline void stopCapture()
+{
+	impl::stopCapture();
+}
+
+/**
+ * @brief Writes the captured calls kept in memory to a file (use .gz for
+ * compression), which can be viewed with showCapture().
+ */
+static inline void writeCapture(const std::string &file)
+{
+	impl::writeCapture(file);
+}
+
+/**
+ * @brief Loads the calls of a capture file and passes the control to the
+ * debug-window to view them.
+ */
+static inline void showCapture(const std::string &file)
+{
+	impl::showCapture(file);
+}
+#else
+static inline void startCapture(const CaptureSettings & = CaptureSettings())
+{
+}
+
+static inline void stopCapture()
+{
+}
+
+static inline void writeCapture(const std::string &)
+{
+}
+
+static inline void showCapture(const std::string &)
+{
+}
+#endif
+
+//! @}
+
+} // namespace cvv
+
+#endif
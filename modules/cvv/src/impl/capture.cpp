@@ -0,0 +1,319 @@
+#include "capture.hpp"
+
+#include <QString>
+
+#include "data_controller.hpp"
+#include "filter_call.hpp"
+#include "match_call.hpp"
+#include "single_image_call.hpp"
+
+#include "../util/util.hpp"
+
+namespace cvv
+{
+namespace impl
+{
+
+namespace
+{
+
+std::shared_ptr<CaptureSession> activeSession;
+
+std::mutex stoppedMutex;
+std::shared_ptr<CaptureSession> stoppedSession;
+
+void writeCall(cv::FileStorage &fs, const CapturedCall &call)
+{
+	fs << "{";
+	fs << "type" << call.type;
+	fs << "description" << call.description;
+	fs << "view" << call.view;
+	fs << "known" << (int)call.isKnown;
+	fs << "file" << call.file;
+	fs << "line" << (int)call.line;
+	fs << "function" << call.function;
+	fs << "images" << "[";
+	for (const auto &img : call.images)
+	{
+		fs << img;
+	}
+	fs << "]";
+	if (call.type == "match")
+	{
+		cv::write(fs, "keypoints1", call.keypoints1);
+		cv::write(fs, "keypoints2", call.keypoints2);
+		cv::write(fs, "matches", call.matches);
+		fs << "useTrainDescriptor" << (int)call.useTrainDescriptor;
+	}
+	fs << "}";
+}
+
+/**
+ * @brief Keeps the strings of the locations of loaded calls alive, since
+ * CallMetaData only points to them.
+ */
+const char *persistentString(const std::string &str)
+{
+	static std::deque<std::string> pool;
+	pool.push_back(str);
+	return pool.back().c_str();
+}
+
+std::unique_ptr<Call> readCall(const cv::FileNode &node)
+{
+	std::string type, description, view, file, function;
+	node["type"] >> type;
+	node["description"] >> description;
+	node["view"] >> view;
+	node["file"] >> file;
+	node["function"] >> function;
+	const CallMetaData data =
+	    (int)node["known"]
+	        ? CallMetaData(persistentString(file), (size_t)(int)node["line"],
+	                       persistentString(function))
+	        : CallMetaData();
+
+	std::vector<cv::Mat> images;
+	const cv::FileNode imagesNode = node["images"];
+	for (auto it = imagesNode.begin(); it != imagesNode.end(); ++it)
+	{
+		cv::Mat img;
+		*it >> img;
+		images.push_back(img);
+	}
+
+	const QString qtType = QString::fromStdString(type);
+	const QString qtDescription = QString::fromLocal8Bit(description.c_str());
+	const QString qtView = QString::fromLocal8Bit(view.c_str());
+	if (type == "match")
+	{
+		CV_Assert(images.size() == 2);
+		std::vector<cv::KeyPoint> keypoints1, keypoints2;
+		std::vector<cv::DMatch> matches;
+		cv::read(node["keypoints1"], keypoints1);
+		cv::read(node["keypoints2"], keypoints2);
+		cv::read(node["matches"], matches);
+		return util::make_unique<MatchCall>(
+		    images[0], std::move(keypoints1), images[1],
+		    std::move(keypoints2), std::move(matches), data, qtType,
+		    qtDescription, qtView, (int)node["useTrainDescriptor"] != 0);
+	}
+	if (images.size() == 2)
+	{
+		return util::make_unique<FilterCall>(images[0], images[1], data,
+		                                     qtType, qtDescription, qtView);
+	}
+	CV_Assert(images.size() == 1);
+	return util::make_unique<SingleImageCall>(images[0], data, qtType,
+	                                          qtDescription, qtView);
+}
+}
+
+CapturedCall::CapturedCall(const char *type, const CallMetaData &data,
+                           const char *description, const char *view)
+    : type{ type },
+      description{ description ? description : "<no description>" },
+      view{ view ? view : "" }, isKnown{ data.isKnown },
+      file{ data.file ? data.file : "" }, line{ data.line },
+      function{ data.function ? data.function : "" },
+      useTrainDescriptor{ false }
+{
+}
+
+CaptureSession::CaptureSession(CaptureSettings settings)
+    : settings_{ std::move(settings) }, counter_{ 0 }, captured_{ 0 },
+      dropped_{ 0 }, finished_{ false }
+{
+	CV_Assert(settings_.capacity > 0 && settings_.sampleEvery > 0);
+	if (!settings_.file.empty())
+	{
+		if (!fs_.open(settings_.file, cv::FileStorage::WRITE))
+		{
+			CV_Error(cv::Error::StsError,
+			         "could not open the capture file " +
+			             settings_.file);
+		}
+		fs_ << "calls"
+		    << "[";
+		writer_ = std::thread{ &CaptureSession::writerLoop, this };
+	}
+}
+
+CaptureSession::~CaptureSession()
+{
+	finish();
+}
+
+bool CaptureSession::sample(const CallMetaData &data, const char *description)
+{
+	if (counter_++ % settings_.sampleEvery != 0)
+	{
+		return false;
+	}
+	return !settings_.condition || settings_.condition(data, description);
+}
+
+cv::Mat CaptureSession::keep(cv::InputArray img) const
+{
+	if (settings_.shareImages && img.kind() == cv::_InputArray::MAT)
+	{
+		return img.getMat();
+	}
+	cv::Mat copy;
+	img.copyTo(copy);
+	return copy;
+}
+
+void CaptureSession::add(CapturedCall call)
+{
+	auto shared = std::make_shared<const CapturedCall>(std::move(call));
+	std::lock_guard<std::mutex> lock{ mutex_ };
+	if (finished_)
+	{
+		return;
+	}
+	captured_++;
+	if (ring_.size() == settings_.capacity)
+	{
+		ring_.pop_front();
+	}
+	ring_.push_back(shared);
+	if (writer_.joinable())
+	{
+		// never block the program for the writer, drop the oldest calls
+		// instead
+		if (pending_.size() == settings_.capacity)
+		{
+			pending_.pop_front();
+			dropped_++;
+		}
+		pending_.push_back(std::move(shared));
+		pendingChanged_.notify_one();
+	}
+}
+
+void CaptureSession::finish()
+{
+	{
+		std::lock_guard<std::mutex> lock{ mutex_ };
+		if (finished_)
+		{
+			return;
+		}
+		finished_ = true;
+		pendingChanged_.notify_one();
+	}
+	if (writer_.joinable())
+	{
+		writer_.join();
+		fs_ << "]";
+		fs_ << "dropped" << (int)dropped_;
+		fs_.release();
+	}
+}
+
+void CaptureSession::write(const std::string &file) const
+{
+	std::deque<std::shared_ptr<const CapturedCall>> calls;
+	size_t captured;
+	{
+		std::lock_guard<std::mutex> lock{ mutex_ };
+		calls = ring_;
+		captured = captured_;
+	}
+	cv::FileStorage fs{ file, cv::FileStorage::WRITE };
+	if (!fs.isOpened())
+	{
+		CV_Error(cv::Error::StsError,
+		         "could not open the capture file " + file);
+	}
+	fs << "calls"
+	   << "[";
+	for (const auto &call : calls)
+	{
+		writeCall(fs, *call);
+	}
+	fs << "]";
+	fs << "dropped" << (int)(captured - calls.size());
+}
+
+void CaptureSession::writerLoop()
+{
+	std::unique_lock<std::mutex> lock{ mutex_ };
+	while (true)
+	{
+		pendingChanged_.wait(
+		    lock, [this] { return finished_ || !pending_.empty(); });
+		if (pending_.empty())
+		{
+			return;
+		}
+		auto call = std::move(pending_.front());
+		pending_.pop_front();
+		lock.unlock();
+		writeCall(fs_, *call);
+		lock.lock();
+	}
+}
+
+std::shared_ptr<CaptureSession> captureSession()
+{
+	return std::atomic_load(&activeSession);
+}
+
+void startCapture(const CaptureSettings &settings)
+{
+	stopCapture();
+	std::atomic_store(&activeSession,
+	                  std::make_shared<CaptureSession>(settings));
+}
+
+void stopCapture()
+{
+	auto session = std::atomic_exchange(
+	    &activeSession, std::shared_ptr<CaptureSession>{});
+	if (!session)
+	{
+		return;
+	}
+	session->finish();
+	std::lock_guard<std::mutex> lock{ stoppedMutex };
+	stoppedSession = std::move(session);
+}
+
+void writeCapture(const std::string &file)
+{
+	auto session = captureSession();
+	if (!session)
+	{
+		std::lock_guard<std::mutex> lock{ stoppedMutex };
+		session = stoppedSession;
+	}
+	if (!session)
+	{
+		CV_Error(cv::Error::StsError, "no calls were captured");
+	}
+	session->write(file);
+}
+
+void showCapture(const std::string &file)
+{
+	cv::FileStorage fs{ file, cv::FileStorage::READ };
+	if (!fs.isOpened())
+	{
+		CV_Error(cv::Error::StsError,
+		         "could not open the capture file " + file);
+	}
+	auto &controller = dataController();
+	const cv::FileNode calls = fs["calls"];
+	for (auto it = calls.begin(); it != calls.end(); ++it)
+	{
+		controller.addCall(readCall(*it), false);
+	}
+	if (controller.numCalls() != 0)
+	{
+		controller.callUI();
+	}
+}
+}
+} // namespaces cvv::impl
@@ -0,0 +1,114 @@
+#ifndef CVVISUAL_CAPTURE_SESSION_HPP
+#define CVVISUAL_CAPTURE_SESSION_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "opencv2/core.hpp"
+#include "opencv2/features2d.hpp"
+
+#include "opencv2/cvv/call_meta_data.hpp"
+#include "opencv2/cvv/capture.hpp"
+
+namespace cvv
+{
+namespace impl
+{
+
+/**
+ * @brief All the data of a captured debug-call, independant of Qt and of the
+ * lifetime of the strings passed to the call.
+ */
+struct CapturedCall
+{
+	CapturedCall(const char *type, const CallMetaData &data,
+	             const char *description, const char *view);
+
+	std::string type;
+	std::string description;
+	std::string view;
+	bool isKnown;
+	std::string file;
+	size_t line;
+	std::string function;
+
+	std::vector<cv::Mat> images;
+	std::vector<cv::KeyPoint> keypoints1;
+	std::vector<cv::KeyPoint> keypoints2;
+	std::vector<cv::DMatch> matches;
+	bool useTrainDescriptor;
+};
+
+/**
+ * @brief Records the debug-calls in a ring of the last calls and optionally
+ * streams them to a file from a background thread.
+ */
+class CaptureSession
+{
+      public:
+	explicit CaptureSession(CaptureSettings settings);
+
+	/**
+	 * @brief Waits for the writer-thread.
+	 */
+	~CaptureSession();
+
+	/**
+	 * @brief Whether the call is to be captured, counts the call.
+	 */
+	bool sample(const CallMetaData &data, const char *description);
+
+	/**
+	 * @brief Returns the image to store in a captured call, a reference or
+	 * a copy depending on the settings.
+	 */
+	cv::Mat keep(cv::InputArray img) const;
+
+	/**
+	 * @brief Adds a call to the ring and to the queue of the writer.
+	 */
+	void add(CapturedCall call);
+
+	/**
+	 * @brief Writes the remaining queued calls and closes the file.
+	 */
+	void finish();
+
+	/**
+	 * @brief Writes the calls of the ring to a file.
+	 */
+	void write(const std::string &file) const;
+
+      private:
+	void writerLoop();
+
+	CaptureSettings settings_;
+	std::atomic_size_t counter_;
+
+	mutable std::mutex mutex_;
+	std::condition_variable pendingChanged_;
+	std::deque<std::shared_ptr<const CapturedCall>> ring_;
+	std::deque<std::shared_ptr<const CapturedCall>> pending_;
+	size_t captured_;
+	size_t dropped_;
+	bool finished_;
+
+	cv::FileStorage fs_;
+	std::thread writer_;
+};
+
+/**
+ * @brief Returns the active capture session, nullptr if the calls have to be
+ * shown.
+ */
+std::shared_ptr<CaptureSession> captureSession();
+}
+} // namespaces cvv::impl
+
+#endif
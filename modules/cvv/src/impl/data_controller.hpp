@@ -27,9 +27,10 @@ class DataController
 	}
 
 	/**
-	 * Add a new call to the calls-list.
+	 * Add a new call to the calls-list and pass control to the UI unless
+	 * showUI is false.
 	 */
-	void addCall(std::unique_ptr<Call> call);
+	void addCall(std::unique_ptr<Call> call, bool showUI = true);
 
 	/**
 	 * Remove a call.
@@ -88,6 +89,11 @@ void deleteDataController();
  * call.
  */
 DataController &dataController();
+
+/**
+ * @brief Whether the global DataController exists.
+ */
+bool hasDataController();
 }
 } // namespaces cvv::impl
 
@@ -1,6 +1,7 @@
 #include "opencv2/cvv/dmatch.hpp"
 
 #include "opencv2/cvv/call_meta_data.hpp"
+#include "capture.hpp"
 #include "match_call.hpp"
 
 namespace cvv
@@ -14,6 +15,20 @@ void debugDMatch(cv::InputArray img1, std::vector<cv::KeyPoint> keypoints1,
                  const char *description, const char *view,
                  bool useTrainDescriptor)
 {
+	if (auto session = captureSession())
+	{
+		if (session->sample(data, description))
+		{
+			CapturedCall call{ "match", data, description, view };
+			call.images = { session->keep(img1), session->keep(img2) };
+			call.keypoints1 = std::move(keypoints1);
+			call.keypoints2 = std::move(keypoints2);
+			call.matches = std::move(matches);
+			call.useTrainDescriptor = useTrainDescriptor;
+			session->add(std::move(call));
+		}
+		return;
+	}
 	debugMatchCall(img1, std::move(keypoints1), img2, std::move(keypoints2),
 	               std::move(matches), data, description, view,
 	               useTrainDescriptor);
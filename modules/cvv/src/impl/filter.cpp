@@ -1,6 +1,7 @@
 #include "opencv2/cvv/filter.hpp"
 
 #include "opencv2/cvv/call_meta_data.hpp"
+#include "capture.hpp"
 #include "filter_call.hpp"
 
 namespace cvv
@@ -12,6 +13,17 @@ void debugFilter(cv::InputArray original, cv::InputArray result,
                  const CallMetaData &data, const char *description,
                  const char *view)
 {
+	if (auto session = captureSession())
+	{
+		if (session->sample(data, description))
+		{
+			CapturedCall call{ "filter", data, description, view };
+			call.images = { session->keep(original),
+			                session->keep(result) };
+			session->add(std::move(call));
+		}
+		return;
+	}
 	debugFilterCall(original, result, data, description, view, "filter");
 }
 }
@@ -1,5 +1,7 @@
 #include "opencv2/cvv/final_show.hpp"
 
+#include "opencv2/cvv/capture.hpp"
+
 #include "data_controller.hpp"
 
 namespace cvv
@@ -9,6 +11,12 @@ namespace impl
 
 void finalShow()
 {
+	impl::stopCapture();
+	// don't create the UI if all the calls were captured
+	if (!impl::hasDataController())
+	{
+		return;
+	}
 	auto &controller = impl::dataController();
 	if (controller.numCalls() != 0)
 	{
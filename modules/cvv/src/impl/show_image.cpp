@@ -1,6 +1,7 @@
 #include "opencv2/cvv/show_image.hpp"
 
 #include "opencv2/cvv/call_meta_data.hpp"
+#include "capture.hpp"
 #include "single_image_call.hpp"
 
 namespace cvv
@@ -11,6 +12,16 @@ namespace impl
 void showImage(cv::InputArray img, const CallMetaData &data,
                const char *description, const char *view)
 {
+	if (auto session = captureSession())
+	{
+		if (session->sample(data, description))
+		{
+			CapturedCall call{ "singleImage", data, description, view };
+			call.images = { session->keep(img) };
+			session->add(std::move(call));
+		}
+		return;
+	}
 	debugSingleImageCall(img, data, description, view, "singleImage");
 }
 }
@@ -0,0 +1,85 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+/**
+ * Tests whether the capture mode (from /include/opencv2/cvv/capture.hpp)
+ * records the sampled calls instead of showing them.
+ */
+
+TEST(CaptureTest, StreamsSampledCallsToFile)
+{
+	const std::string file = cv::tempfile(".yml");
+	cvv::CaptureSettings settings;
+	settings.sampleEvery = 3;
+	settings.file = file;
+	cvv::impl::startCapture(settings);
+	for (int i = 0; i < 10; i++)
+	{
+		cv::Mat img(4, 5, CV_8UC1, cv::Scalar(i));
+		cvv::impl::showImage(img, CVVISUAL_LOCATION, "image", nullptr);
+	}
+	cvv::impl::stopCapture();
+
+	cv::FileStorage fs(file, cv::FileStorage::READ);
+	ASSERT_TRUE(fs.isOpened());
+	cv::FileNode calls = fs["calls"];
+	ASSERT_EQ(calls.size(), 4u);
+	EXPECT_EQ((int)fs["dropped"], 0);
+	for (int i = 0; i < 4; i++)
+	{
+		cv::FileNode call = calls[i];
+		EXPECT_EQ((std::string)call["type"], "singleImage");
+		EXPECT_EQ((std::string)call["description"], "image");
+		EXPECT_EQ((int)call["known"], 1);
+		cv::Mat img;
+		call["images"][0] >> img;
+		ASSERT_EQ(img.size(), cv::Size(5, 4));
+		EXPECT_EQ(cv::countNonZero(img != 3 * i), 0);
+	}
+	fs.release();
+	std::remove(file.c_str());
+}
+
+TEST(CaptureTest, KeepsLastCallsMatchingCondition)
+{
+	cvv::CaptureSettings settings;
+	settings.capacity = 2;
+	settings.condition = [](const cvv::impl::CallMetaData &,
+	                        const char *description) {
+		return std::string(description) == "kept";
+	};
+	cvv::impl::startCapture(settings);
+	for (int i = 0; i < 6; i++)
+	{
+		cv::Mat img(3, 3, CV_8UC1, cv::Scalar(i));
+		cvv::impl::debugFilter(img, img, cvv::impl::CallMetaData(),
+		                       i % 2 ? "kept" : "skipped", nullptr);
+	}
+	cvv::impl::stopCapture();
+
+	const std::string file = cv::tempfile(".yml");
+	cvv::impl::writeCapture(file);
+	cv::FileStorage fs(file, cv::FileStorage::READ);
+	ASSERT_TRUE(fs.isOpened());
+	cv::FileNode calls = fs["calls"];
+	ASSERT_EQ(calls.size(), 2u);
+	EXPECT_EQ((int)fs["dropped"], 1);
+	for (int i = 0; i < 2; i++)
+	{
+		cv::FileNode call = calls[i];
+		EXPECT_EQ((std::string)call["type"], "filter");
+		EXPECT_EQ((int)call["known"], 0);
+		ASSERT_EQ(call["images"].size(), 2u);
+		cv::Mat img;
+		call["images"][1] >> img;
+		EXPECT_EQ(cv::countNonZero(img != 3 + 2 * i), 0);
+	}
+	fs.release();
+	std::remove(file.c_str());
+}
+
+}} // namespace
@@ -51,6 +51,7 @@
 #include <fstream>
 
 #include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
 
 namespace cv
 {
@@ -66,6 +67,23 @@ void CV_EXPORTS createDirectory(const std::string &path);
 
 void CV_EXPORTS getDirList(const std::string &dirName, std::vector<std::string> &fileNames);
 
+/** @brief Decodes images by batches, the next batch is decoded by worker threads while the current one is used.
+
+The file names are usually built from the image names of the dataset objects and the dataset path. The batch
+returned by the i-th call of next() holds the images of fileNames[i*batchSize] and the following ones, empty Mats
+stand for the files which could not be read.
+*/
+class CV_EXPORTS ImagePrefetcher
+{
+public:
+    virtual ~ImagePrefetcher() {}
+
+    //! returns the next batch, false once all the images were returned
+    virtual bool next(std::vector<Mat> &batch) = 0;
+
+    static Ptr<ImagePrefetcher> create(const std::vector<std::string> &fileNames, int batchSize, int flags = IMREAD_COLOR);
+};
+
 //! @}
 
 }
@@ -109,19 +109,32 @@ void OR_imagenetImp::loadDataset(const string &path)
     string pathTrain(path + "train/");
     vector<string> fileNames;
     getDirList(pathTrain, fileNames);
-    for (vector<string>::iterator it=fileNames.begin(); it!=fileNames.end(); ++it)
+    // the synsets directories are listed in parallel, then merged in their order
+    vector< vector< Ptr<Object> > > synsets(fileNames.size());
+    parallel_for_(Range(0, (int)fileNames.size()), [&](const Range &range)
     {
-        string pathSyn((*it) + "/");
-        vector<string> fileNamesSyn;
-        getDirList((pathTrain + pathSyn), fileNamesSyn);
-        for (vector<string>::iterator itSyn=fileNamesSyn.begin(); itSyn!=fileNamesSyn.end(); ++itSyn)
+        for (int i=range.start; i<range.end; ++i)
         {
-            Ptr<OR_imagenetObj> curr(new OR_imagenetObj);
-            curr->image = "train/" + pathSyn + *itSyn;
-            curr->id = labels[*it];
-
-            train.back().push_back(curr);
+            map<string, int>::const_iterator label = labels.find(fileNames[i]);
+            int id = label != labels.end() ? label->second : 0;
+
+            string pathSyn(fileNames[i] + "/");
+            vector<string> fileNamesSyn;
+            getDirList((pathTrain + pathSyn), fileNamesSyn);
+            synsets[i].reserve(fileNamesSyn.size());
+            for (vector<string>::iterator itSyn=fileNamesSyn.begin(); itSyn!=fileNamesSyn.end(); ++itSyn)
+            {
+                Ptr<OR_imagenetObj> curr(new OR_imagenetObj);
+                curr->image = "train/" + pathSyn + *itSyn;
+                curr->id = id;
+
+                synsets[i].push_back(curr);
+            }
         }
+    });
+    for (size_t i=0; i<synsets.size(); ++i)
+    {
+        train.back().insert(train.back().end(), synsets[i].begin(), synsets[i].end());
     }
 
     ifstream infileVal((path + "ILSVRC2010_validation_ground_truth.txt").c_str());
@@ -74,51 +74,43 @@ void OR_mnistImp::load(const string &path)
     loadDataset(path);
 }
 
-void OR_mnistImp::loadDatasetPart(const string &imagesFile, const string &labelsFile, unsigned int num, vector< Ptr<Object> > &dataset_)
+static bool readPart(const string &fileName, long headerSize, uchar *data, size_t size)
 {
-    FILE *f = fopen(imagesFile.c_str(), "rb");
-    fseek(f, 16, SEEK_CUR);
-    unsigned int imageSize = 28*28;
-    char *images = new char[num*imageSize];
-    size_t res = fread(images, 1, num*imageSize, f);
+    FILE *f = fopen(fileName.c_str(), "rb");
+    if (!f)
+    {
+        return false;
+    }
+    fseek(f, headerSize, SEEK_CUR);
+    size_t res = fread(data, 1, size, f);
     fclose(f);
-    if (num*imageSize != res)
+    return size == res;
+}
+
+void OR_mnistImp::loadDatasetPart(const string &imagesFile, const string &labelsFile, unsigned int num, vector< Ptr<Object> > &dataset_)
+{
+    // all the images share one buffer read at once, each sample refers to its rows
+    const int imageSize = 28;
+    Mat images((int)num*imageSize, imageSize, CV_8U);
+    if (!readPart(imagesFile, 16, images.data, images.total()))
     {
-        delete[] images;
         return;
     }
-    f = fopen(labelsFile.c_str(), "rb");
-    fseek(f, 8, SEEK_CUR);
-    char *labels = new char[num];
-    res = fread(labels, 1, num, f);
-    fclose(f);
-    if (num != res)
+    vector<uchar> labels(num);
+    if (!readPart(labelsFile, 8, &labels[0], num))
     {
-        delete[] images;
-        delete[] labels;
         return;
     }
 
+    dataset_.reserve(dataset_.size() + num);
     for (unsigned int i=0; i<num; ++i)
     {
         Ptr<OR_mnistObj> curr(new OR_mnistObj);
-        curr->label = labels[i];
-
-        curr->image = Mat(28, 28, CV_8U);
-        unsigned int imageIdx = i*imageSize;
-        for (int j=0; j<curr->image.rows; ++j)
-        {
-            char *im = curr->image.ptr<char>(j);
-            for (int k=0; k<curr->image.cols; ++k)
-            {
-                im[k] = images[imageIdx + j*28 + k];
-            }
-        }
+        curr->label = (char)labels[i];
+        curr->image = images.rowRange((int)i*imageSize, (int)(i+1)*imageSize);
 
         dataset_.push_back(curr);
     }
-    delete[] images;
-    delete[] labels;
 }
 
 void OR_mnistImp::loadDataset(const string &path)
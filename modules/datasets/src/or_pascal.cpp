@@ -49,6 +49,7 @@
 #if defined(__GNUC__) && __GNUC__ >= 5
 #pragma GCC diagnostic pop
 #endif
+#include <algorithm>
 #include <fstream>
 
 namespace cv
@@ -68,7 +69,7 @@ public:
 
 private:
     void loadDataset(const string &path, const string &nameImageSet, vector< Ptr<Object> > &imageSet);
-    Ptr<Object> parseAnnotation(const string &path, const string &id);
+    Ptr<Object> parseAnnotation(XMLDocument &doc, const string &path, const string &id);
     const char*  parseNodeText(XMLElement* node, const string &nodeName, const string &defaultValue);
 };
 
@@ -96,19 +97,51 @@ void OR_pascalImp::loadDataset(const string &path, const string &nameImageSet, v
         CV_Error(Error::StsBadArg, error_message);
 
     string id = "";
+    vector<string> ids;
 
     while( getline(in, id) )
     {
-        if( strcmp(nameImageSet.c_str(), "test") == 0 ) // test set ground truth is not available
+        ids.push_back(id);
+    }
+
+    if( strcmp(nameImageSet.c_str(), "test") == 0 ) // test set ground truth is not available
+    {
+        for (size_t i = 0; i < ids.size(); i++)
         {
             Ptr<OR_pascalObj> annotation(new OR_pascalObj);
-            annotation->filename = path + "JPEGImages/" + id + ".jpg";
+            annotation->filename = path + "JPEGImages/" + ids[i] + ".jpg";
             imageSet.push_back(annotation);
         }
-        else
+        return;
+    }
+
+    // the annotation files are parsed in parallel, every stripe reuses the node pools of its document
+    const size_t first = imageSet.size();
+    imageSet.resize(first + ids.size());
+    vector<cv::Exception> errors(ids.size());
+    vector<uchar> failed(ids.size(), 0);
+    parallel_for_(Range(0, (int)ids.size()), [&](const Range &range)
+    {
+        XMLDocument doc;
+        for (int i = range.start; i < range.end; i++)
         {
-            imageSet.push_back(parseAnnotation(path, id));
+            try
+            {
+                imageSet[first + i] = parseAnnotation(doc, path, ids[i]);
+            }
+            catch (const cv::Exception &e)
+            {
+                errors[i] = e;
+                failed[i] = 1;
+            }
         }
+    }, std::min((double)ids.size(), 4. * getNumThreads()));
+
+    // report the first failing file, as a sequential parse would
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        if (failed[i])
+            throw errors[i];
     }
 }
 
@@ -125,13 +158,12 @@ const char* OR_pascalImp::parseNodeText(XMLElement* node, const string &nodeName
     return e ;
 }
 
-Ptr<Object> OR_pascalImp::parseAnnotation(const string &path, const string &id)
+Ptr<Object> OR_pascalImp::parseAnnotation(XMLDocument &doc, const string &path, const string &id)
 {
     string pathAnnotations(path + "Annotations/");
     string pathImages(path + "JPEGImages/");
     Ptr<OR_pascalObj> annotation(new OR_pascalObj);
 
-    XMLDocument doc;
     string xml_file = pathAnnotations + id + ".xml";
 
     XMLError error_code = doc.LoadFile(xml_file.c_str());
@@ -81,81 +81,87 @@ void SLAM_kittiImp::loadDataset(const string &path)
     string pathSequence(path + "sequences/");
     vector<string> fileNames;
     getDirList(pathSequence, fileNames);
-    for (vector<string>::iterator it=fileNames.begin(); it!=fileNames.end(); ++it)
+    // the sequences are independent, each one is loaded by its own worker
+    vector< Ptr<Object> > sequences(fileNames.size());
+    parallel_for_(Range(0, (int)fileNames.size()), [&](const Range &range)
     {
-        Ptr<SLAM_kittiObj> curr(new SLAM_kittiObj);
-        curr->name = *it;
-
-        string currPath(pathSequence + curr->name);
-
-        // loading velodyne
-        string pathVelodyne(currPath + "/velodyne/");
-        vector<string> velodyneNames;
-        getDirList(pathVelodyne, velodyneNames);
-        for (vector<string>::iterator itV=velodyneNames.begin(); itV!=velodyneNames.end(); ++itV)
+        for (int seq=range.start; seq<range.end; ++seq)
         {
-            curr->velodyne.push_back(*itV);
-        }
+            Ptr<SLAM_kittiObj> curr(new SLAM_kittiObj);
+            curr->name = fileNames[seq];
 
-        // loading gray & color images
-        for (unsigned int i=0; i<=3; ++i)
-        {
-            char tmp[2];
-            sprintf(tmp, "%u", i);
-            string pathImage(currPath + "/image_" + tmp + "/");
-            vector<string> imageNames;
-            getDirList(pathImage, imageNames);
-            for (vector<string>::iterator itImage=imageNames.begin(); itImage!=imageNames.end(); ++itImage)
+            string currPath(pathSequence + curr->name);
+
+            // loading velodyne
+            string pathVelodyne(currPath + "/velodyne/");
+            vector<string> velodyneNames;
+            getDirList(pathVelodyne, velodyneNames);
+            for (vector<string>::iterator itV=velodyneNames.begin(); itV!=velodyneNames.end(); ++itV)
             {
-                curr->images[i].push_back(*itImage);
+                curr->velodyne.push_back(*itV);
             }
-        }
 
-        // loading times
-        ifstream infile((currPath + "/times.txt").c_str());
-        string line;
-        while (getline(infile, line))
-        {
-            curr->times.push_back(atof(line.c_str()));
-        }
+            // loading gray & color images
+            for (unsigned int i=0; i<=3; ++i)
+            {
+                char tmp[2];
+                sprintf(tmp, "%u", i);
+                string pathImage(currPath + "/image_" + tmp + "/");
+                vector<string> imageNames;
+                getDirList(pathImage, imageNames);
+                for (vector<string>::iterator itImage=imageNames.begin(); itImage!=imageNames.end(); ++itImage)
+                {
+                    curr->images[i].push_back(*itImage);
+                }
+            }
 
-        // loading calibration
-        ifstream infile2((currPath + "/calib.txt").c_str());
-        for (unsigned int i=0; i<4; ++i)
-        {
-            getline(infile2, line);
-            vector<string> elems;
-            split(line, elems, ' ');
-            vector<string>::iterator itE=elems.begin();
-            for (++itE; itE!=elems.end(); ++itE)
+            // loading times
+            ifstream infile((currPath + "/times.txt").c_str());
+            string line;
+            while (getline(infile, line))
             {
-                curr->p[i].push_back(atof((*itE).c_str()));
+                curr->times.push_back(atof(line.c_str()));
             }
-        }
 
-        // loading poses
-        ifstream infile3((path + "poses/" + curr->name + ".txt").c_str());
-        while (getline(infile3, line))
-        {
-            pose p;
+            // loading calibration
+            ifstream infile2((currPath + "/calib.txt").c_str());
+            for (unsigned int i=0; i<4; ++i)
+            {
+                getline(infile2, line);
+                vector<string> elems;
+                split(line, elems, ' ');
+                vector<string>::iterator itE=elems.begin();
+                for (++itE; itE!=elems.end(); ++itE)
+                {
+                    curr->p[i].push_back(atof((*itE).c_str()));
+                }
+            }
 
-            unsigned int i=0;
-            vector<string> elems;
-            split(line, elems, ' ');
-            for (vector<string>::iterator itE=elems.begin(); itE!=elems.end(); ++itE, ++i)
+            // loading poses
+            ifstream infile3((path + "poses/" + curr->name + ".txt").c_str());
+            while (getline(infile3, line))
             {
-                if (i>11)
+                pose p;
+
+                unsigned int i=0;
+                vector<string> elems;
+                split(line, elems, ' ');
+                for (vector<string>::iterator itE=elems.begin(); itE!=elems.end(); ++itE, ++i)
                 {
-                    break;
+                    if (i>11)
+                    {
+                        break;
+                    }
+                    p.elem[i] = atof((*itE).c_str());
                 }
-                p.elem[i] = atof((*itE).c_str());
+
+                curr->posesArray.push_back(p);
             }
 
-            curr->posesArray.push_back(p);
+            sequences[seq] = curr;
         }
-
-        train.back().push_back(curr);
-    }
+    });
+    train.back().insert(train.back().end(), sequences.begin(), sequences.end());
 }
 
 Ptr<SLAM_kitti> SLAM_kitti::create()
@@ -138,11 +138,17 @@ void TR_svtImp::loadDataset(const string &path)
     string trainXml(path + "train.xml");
     string testXml(path + "test.xml");
 
-    // loading train images description
-    xmlParse(trainXml, train.back());
-
-    // loading test images description
-    xmlParse(testXml, test.back());
+    // loading train & test images description, both files are parsed at the same time
+    parallel_for_(Range(0, 2), [&](const Range &range)
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            if (i == 0)
+                xmlParse(trainXml, train.back());
+            else
+                xmlParse(testXml, test.back());
+        }
+    }, 2);
 }
 
 Ptr<TR_svt> TR_svt::create()
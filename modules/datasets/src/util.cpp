@@ -41,9 +41,11 @@
 
 #include "opencv2/datasets/util.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 
 #include <sstream>
+#include <thread>
 
 #ifndef _WIN32
     #include <unistd.h>
@@ -116,5 +118,84 @@ void getDirList(const string &dirName, vector<string> &fileNames)
 #endif
 }
 
+class ImagePrefetcherImp CV_FINAL : public ImagePrefetcher
+{
+public:
+    ImagePrefetcherImp(const vector<string> &fileNames, int batchSize, int flags)
+        : fileNames_(fileNames), batchSize_((size_t)batchSize), flags_(flags), next_(0)
+    {
+        CV_Assert(batchSize > 0);
+        prefetch();
+    }
+
+    virtual ~ImagePrefetcherImp() CV_OVERRIDE
+    {
+        if (worker_.joinable())
+        {
+            worker_.join();
+        }
+    }
+
+    virtual bool next(vector<Mat> &batch) CV_OVERRIDE
+    {
+        if (!worker_.joinable())
+        {
+            batch.clear();
+            return false;
+        }
+        worker_.join();
+        if (!error_.empty())
+        {
+            CV_Error(Error::StsError, error_);
+        }
+        batch.swap(buffer_);
+        prefetch();
+        return true;
+    }
+
+private:
+    void prefetch()
+    {
+        if (next_ >= fileNames_.size())
+        {
+            return;
+        }
+        const size_t begin = next_;
+        const size_t end = std::min(next_ + batchSize_, fileNames_.size());
+        next_ = end;
+        worker_ = std::thread([this, begin, end]()
+        {
+            try
+            {
+                buffer_.assign(end - begin, Mat());
+                parallel_for_(Range(0, (int)(end - begin)), [&](const Range &range)
+                {
+                    for (int i=range.start; i<range.end; ++i)
+                    {
+                        buffer_[i] = imread(fileNames_[begin + i], flags_);
+                    }
+                });
+            }
+            catch (const cv::Exception &e)
+            {
+                error_ = e.what();
+            }
+        });
+    }
+
+    vector<string> fileNames_;
+    size_t batchSize_;
+    int flags_;
+    size_t next_;
+    vector<Mat> buffer_;
+    string error_;
+    std::thread worker_;
+};
+
+Ptr<ImagePrefetcher> ImagePrefetcher::create(const vector<string> &fileNames, int batchSize, int flags)
+{
+    return Ptr<ImagePrefetcherImp>(new ImagePrefetcherImp(fileNames, batchSize, flags));
+}
+
 }
 }
@@ -35,10 +35,23 @@ namespace dnn_face
             @param loc Blob containing relative coordinates of bounding boxes (bboxes) and landmarks
             @param conf Blob containing the probability values of being faces or not
             @param iou Blob containing the IoU values between predicted bboxes and the matched ground truth.
+            @param score_thresh Only the faces with scores bigger than the given value are decoded
              */
             std::vector<Face> decode(const Mat& loc,
                                      const Mat& conf,
-                                     const Mat& iou);
+                                     const Mat& iou,
+                                     float score_thresh = -1.f) const;
+
+            /** @brief Computes the scores of all the priors, sqrt(conf * iou)
+            @param conf Blob containing the probability values of being faces or not
+            @param iou Blob containing the IoU values between predicted bboxes and the matched ground truth.
+            @param dst Vector to hold the score of each prior
+             */
+            void scores(const Mat& conf, const Mat& iou, std::vector<float>& dst) const;
+
+            /** @brief The size (shape) of input image the priors are generated for
+             */
+            Size size() const;
 
         protected:
             /** @brief Generate priors according to the input shape
@@ -100,6 +113,9 @@ namespace dnn_face
                                        const int top_k = 5000);
         private:
             dnn::Net net;
+            /** @brief Priors of the last input size
+             */
+            Ptr<PriorBox> prior_box;
     };
 
     //! @}
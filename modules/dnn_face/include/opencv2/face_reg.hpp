@@ -17,19 +17,26 @@ namespace dnn_face
     class CV_EXPORTS DNNFaceRecognizer
     {
     public:
-        /** 
+        /**
             @brief Default constructer.
             @param onnx_path const String& The path of the onnx model used for face recognition.
         */
         DNNFaceRecognizer(const String& onnx_path);
 
-        /** 
+        /**
             @brief Extracting face feature.
             @param face_image Mat The input face.
         */
         Mat facefeature(Mat face_image);
 
-        /** 
+        /**
+            @brief Extracting the features of several faces with one forward pass.
+            @param face_images const std::vector<Mat>& The input faces, eg. all the aligned faces of a frame.
+            @return Mat with the feature of each face in a row. The model must accept a variable batch size.
+        */
+        Mat facefeatures(const std::vector<Mat>& face_images);
+
+        /**
             @brief Calculating the distance between two face features.
             @param featureVec1 Mat The first input feature.
             @param featureVec2 Mat The second input feature of the same size and the same type as src1.
@@ -5,6 +5,7 @@
 #include "precomp.hpp"
 
 #include "opencv2/face_det.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -78,61 +79,85 @@ namespace dnn_face
         }
     }
 
+    Size PriorBox::size() const
+    {
+        return Size(image_width, image_height);
+    }
+
+    void PriorBox::scores(const Mat& conf, const Mat& iou, std::vector<float>& dst) const
+    {
+        CV_Assert(conf.type() == CV_32F && conf.isContinuous() && conf.total() == priors.size() * 2);
+        CV_Assert(iou.type() == CV_32F && iou.isContinuous() && iou.total() == priors.size());
+
+        const float* conf_v = conf.ptr<float>();
+        const float* iou_v = iou.ptr<float>();
+        const int num = (int)priors.size();
+        dst.resize(num);
+
+        // score = sqrt(cls_score * clamp(iou_score, 0, 1))
+        int i = 0;
+#if CV_SIMD128
+        const v_float32x4 v_zero = v_setzero_f32(), v_one = v_setall_f32(1.f);
+        for (; i <= num - v_float32x4::nlanes; i += v_float32x4::nlanes)
+        {
+            v_float32x4 bg_score, cls_score;
+            v_load_deinterleave(conf_v + i*2, bg_score, cls_score);
+            v_float32x4 iou_score = v_min(v_max(v_load(iou_v + i), v_zero), v_one);
+            v_store(&dst[i], v_sqrt(cls_score * iou_score));
+        }
+#endif
+        for (; i < num; ++i)
+        {
+            float cls_score = conf_v[i*2+1];
+            float iou_score = std::min(std::max(iou_v[i], 0.f), 1.f);
+            dst[i] = std::sqrt(cls_score * iou_score);
+        }
+    }
+
     std::vector<Face> PriorBox::decode(const Mat& loc,
                              const Mat& conf,
-                             const Mat& iou)
+                             const Mat& iou,
+                             float score_thresh) const
     {
-        const std::vector<float> variance = {0.1, 0.2};
+        const float variance[2] = {0.1f, 0.2f};
+        CV_Assert(loc.type() == CV_32F && loc.isContinuous() && loc.total() == priors.size() * 14);
+
+        // the boxes and landmarks are only decoded for the priors kept by the score
+        std::vector<float> face_scores;
+        scores(conf, iou, face_scores);
 
         // num * [bbox (Rect2i), 5-landmarks (Landmarks_5), score (float)]
         std::vector<Face> dets;
 
-        float* loc_v = (float*)(loc.data);
-        float* conf_v = (float*)(conf.data);
-        float* iou_v = (float*)(iou.data);
+        const float* loc_v = loc.ptr<float>();
         for (size_t i = 0; i < priors.size(); ++i) {
-            Face face;
+            if (!(face_scores[i] > score_thresh))
+                continue;
 
-            // Get score
-            float cls_score = conf_v[i*2+1];
-            float iou_score = iou_v[i];
-            // Clamp
-            if (iou_score < 0.f) {
-                iou_score = 0.f;
-            }
-            else if (iou_score > 1.f) {
-                iou_score = 1.f;
-            }
-            float score = std::sqrt(cls_score * iou_score);
-            face.score = score;
+            Face face;
+            face.score = face_scores[i];
 
             // Get bounding box
-            float cx = (priors[i].x + loc_v[i*14+0] * variance[0] * priors[i].width) * image_width;
-            float cy = (priors[i].y + loc_v[i*14+1] * variance[0] * priors[i].height) * image_height;
-            float w  = priors[i].width * exp(loc_v[i*14+2] * variance[0]) * image_width;
-            float h  = priors[i].height * exp(loc_v[i*14+3] * variance[1]) * image_height;
+            const float* l = loc_v + i*14;
+            const Rect2f& prior = priors[i];
+            float cx = (prior.x + l[0] * variance[0] * prior.width) * image_width;
+            float cy = (prior.y + l[1] * variance[0] * prior.height) * image_height;
+            float w  = prior.width * exp(l[2] * variance[0]) * image_width;
+            float h  = prior.height * exp(l[3] * variance[1]) * image_height;
             int x1 = int(cx - w / 2);
             int y1 = int(cy - h / 2);
             face.box_tlwh = { x1, y1, int(w), int(h) };
 
             // Get landmarks
-            int x_re = int((priors[i].x + loc_v[i*14+ 4] * variance[0] * priors[i].width)  * image_width);
-            int y_re = int((priors[i].y + loc_v[i*14+ 5] * variance[0] * priors[i].height) * image_height);
-            int x_le = int((priors[i].x + loc_v[i*14+ 6] * variance[0] * priors[i].width)  * image_width);
-            int y_le = int((priors[i].y + loc_v[i*14+ 7] * variance[0] * priors[i].height) * image_height);
-            int x_n = int((priors[i].x + loc_v[i*14+ 8] * variance[0] * priors[i].width)  * image_width);
-            int y_n = int((priors[i].y + loc_v[i*14+ 9] * variance[0] * priors[i].height) * image_height);
-            int x_mr  = int((priors[i].x + loc_v[i*14+10] * variance[0] * priors[i].width)  * image_width);
-            int y_mr  = int((priors[i].y + loc_v[i*14+11] * variance[0] * priors[i].height) * image_height);
-            int x_ml = int((priors[i].x + loc_v[i*14+12] * variance[0] * priors[i].width)  * image_width);
-            int y_ml = int((priors[i].y + loc_v[i*14+13] * variance[0] * priors[i].height) * image_height);
-            face.landmarks = {
-                {x_re, y_re}, // right eye
-                {x_le, y_le}, // left eye
-                {x_n,  y_n }, // nose
-                {x_mr, y_mr}, // mouth right
-                {x_ml, y_ml}  // mouth left
+            auto landmark = [&](int k) {
+                return Point2i(int((prior.x + l[k] * variance[0] * prior.width)  * image_width),
+                               int((prior.y + l[k+1] * variance[0] * prior.height) * image_height));
             };
+            face.landmarks.right_eye   = landmark(4);
+            face.landmarks.left_eye    = landmark(6);
+            face.landmarks.nose_tip    = landmark(8);
+            face.landmarks.mouth_right = landmark(10);
+            face.landmarks.mouth_left  = landmark(12);
 
             dets.push_back(face);
         }
@@ -173,20 +198,21 @@ namespace dnn_face
                                                 const float nms_thresh,
                                                 const int top_k)
     {
-        // Decode from priorbox and deltas
-        PriorBox pb(shape);
-        std::vector<Face> faces = pb.decode(loc, conf, iou);
+        // Decode from priorbox and deltas, the priors are generated once per input size
+        if (prior_box.empty() || prior_box->size() != shape)
+            prior_box = makePtr<PriorBox>(shape);
+        std::vector<Face> faces = prior_box->decode(loc, conf, iou, score_thresh);
 
         // Perform NMS
         if (faces.size() > 1)
         {
             // Retrieve boxes and scores
-            std::vector<Rect2i> face_boxes;
-            std::vector<float> face_scores;
-            for (Face f: faces)
+            std::vector<Rect2i> face_boxes(faces.size());
+            std::vector<float> face_scores(faces.size());
+            for (size_t i = 0; i < faces.size(); ++i)
             {
-                face_boxes.push_back(f.box_tlwh);
-                face_scores.push_back(f.score);
+                face_boxes[i] = faces[i].box_tlwh;
+                face_scores[i] = faces[i].score;
             }
 
             std::vector<int> keep_idx;
@@ -194,7 +220,8 @@ namespace dnn_face
 
             // Get results
             std::vector<Face> nms_faces;
-            for (int idx: keep_idx) 
+            nms_faces.reserve(keep_idx.size());
+            for (int idx: keep_idx)
             {
                 nms_faces.push_back(faces[idx]);
             }
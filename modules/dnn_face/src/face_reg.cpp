@@ -20,6 +20,16 @@ Mat DNNFaceRecognizer::facefeature(Mat face_image){
     return this->model.forward().clone();
 }
 
+Mat DNNFaceRecognizer::facefeatures(const std::vector<Mat>& face_images){
+    if (face_images.empty())
+        return Mat();
+    Mat inputBlob = dnn::blobFromImages(face_images, 1, Size(112, 112), Scalar(0, 0, 0), true, false);
+    this->model.setInput(inputBlob);
+    Mat features = this->model.forward();
+    CV_Assert(features.total() % face_images.size() == 0);
+    return features.reshape(1, (int)face_images.size()).clone();
+}
+
 float DNNFaceRecognizer::facematch(Mat featureVec1, Mat featureVec2, const String& distance){
     featureVec1 /= norm(featureVec1);
     featureVec2 /= norm(featureVec2);
@@ -48,6 +48,20 @@ namespace dnn_objdetect
          */
         void filter(double thresh =  0.8);
 
+        /** @brief Filters the bounding boxes of a batch of images
+        @param _delta_bbox Blob containing relative coordinates of bounding boxes of N images
+        @param _class_scores Blob containing the probability values of each class of N images
+        @param _conf_scores Blob containing the confidence scores of N images
+        @param detections Final detections of each image
+        @param thresh Probability threshold of the detections
+
+        The blobs hold the predictions of the images one after the other, as returned by the network
+        for a batch of N images. The images are post processed in parallel.
+         */
+        static void filterBatch(Mat _delta_bbox, Mat _class_scores, Mat _conf_scores,
+                                std::vector<std::vector<object> > &detections,
+                                double thresh = 0.8);
+
         /** @brief Vector which holds the final detections of the model
          */
         std::vector<object> detections;
@@ -119,6 +133,11 @@ namespace dnn_objdetect
         }
 
       private:
+        /** @brief Decodes, filters and suppresses the predictions of one image, appends the detections
+         */
+        void decode(const float *deltas, const float *classes, const float *confs,
+                    double thresh, std::vector<object> &dets) const;
+
         Mat delta_bbox;
         Mat class_scores;
         Mat conf_scores;
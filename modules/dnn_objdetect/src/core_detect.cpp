@@ -4,6 +4,7 @@
 #include "precomp.hpp"
 
 #include "opencv2/core_detect.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 
 namespace cv
@@ -83,49 +84,208 @@ namespace cv
       }
     }
 
+    namespace
+    {
+      // IOU of the boxes [xmin, ymin, xmax, ymax] stored by coordinate with the base box
+      void iou_with_base(const double *xmins, const double *ymins,
+                         const double *xmaxs, const double *ymaxs, size_t n,
+                         const double *base_box, double epsilon, double *iou)
+      {
+        const double base_box_w = base_box[2] - base_box[0];
+        const double base_box_h = base_box[3] - base_box[1];
+        const double base_area = base_box_h * base_box_w;
+        size_t b = 0;
+#if CV_SIMD128_64F
+        const v_float64x2 v_gxmin = v_setall_f64(base_box[0]);
+        const v_float64x2 v_gymin = v_setall_f64(base_box[1]);
+        const v_float64x2 v_gxmax = v_setall_f64(base_box[2]);
+        const v_float64x2 v_gymax = v_setall_f64(base_box[3]);
+        const v_float64x2 v_zero = v_setzero_f64();
+        const v_float64x2 v_base_area = v_setall_f64(base_area);
+        const v_float64x2 v_eps = v_setall_f64(epsilon);
+        for (; b + v_float64x2::nlanes <= n; b += v_float64x2::nlanes)
+        {
+          const v_float64x2 bxmin = v_load(xmins + b), bymin = v_load(ymins + b);
+          const v_float64x2 bxmax = v_load(xmaxs + b), bymax = v_load(ymaxs + b);
+          const v_float64x2 w = v_max(v_zero, v_min(bxmax, v_gxmax) - v_max(bxmin, v_gxmin));
+          const v_float64x2 h = v_max(v_zero, v_min(bymax, v_gymax) - v_max(bymin, v_gymin));
+          const v_float64x2 inter_ = w * h;
+          const v_float64x2 union_ = (bymax - bymin) * (bxmax - bxmin) + v_base_area - inter_;
+          v_store(iou + b, inter_ / (union_ + v_eps));
+        }
+#endif
+        for (; b < n; ++b)
+        {
+          // Intersection
+          double w = std::max(0.0, std::min(xmaxs[b], base_box[2]) - std::max(xmins[b], base_box[0]));
+          double h = std::max(0.0, std::min(ymaxs[b], base_box[3]) - std::max(ymins[b], base_box[1]));
+          // Union
+          double inter_ = w * h;
+          double union_ = (ymaxs[b] - ymins[b]) * (xmaxs[b] - xmins[b]) + base_area - inter_;
+          iou[b] = inter_ / (union_ + epsilon);
+        }
+      }
+    }
+
     void InferBbox::filter(double thresh)
     {
       this->intersection_thresh = thresh;
-      // Some containers
-      std::vector<std::vector<double> > transformed_bbox_preds(this->anchors);
-      std::vector<std::vector<double> > min_max_bboxes(this->anchors);
-      std::vector<std::vector<double> > final_probs(this->anchors);
+      CV_Assert(delta_bbox.type() == CV_32F && delta_bbox.isContinuous() &&
+                delta_bbox.total() == anchors * 4);
+      CV_Assert(class_scores.type() == CV_32F && class_scores.isContinuous() &&
+                class_scores.total() == anchors * num_classes);
+      CV_Assert(conf_scores.type() == CV_32F && conf_scores.isContinuous() &&
+                conf_scores.total() == anchors);
+      decode(delta_bbox.ptr<float>(), class_scores.ptr<float>(),
+             conf_scores.ptr<float>(), thresh, this->detections);
+    }
 
-      for (size_t i = 0; i < this->anchors; ++i)
+    void InferBbox::filterBatch(Mat _delta_bbox, Mat _class_scores,
+      Mat _conf_scores, std::vector<std::vector<object> > &detections,
+      double thresh)
+    {
+      InferBbox inf(Mat(), Mat(), Mat());
+      CV_Assert(_delta_bbox.type() == CV_32F && _delta_bbox.isContinuous());
+      CV_Assert(_class_scores.type() == CV_32F && _class_scores.isContinuous());
+      CV_Assert(_conf_scores.type() == CV_32F && _conf_scores.isContinuous());
+      CV_Assert(_delta_bbox.total() % (inf.anchors * 4) == 0);
+      const size_t batch = _delta_bbox.total() / (inf.anchors * 4);
+      CV_Assert(_class_scores.total() == batch * inf.anchors * inf.num_classes);
+      CV_Assert(_conf_scores.total() == batch * inf.anchors);
+
+      detections.assign(batch, std::vector<object>());
+      const float *deltas = _delta_bbox.ptr<float>();
+      const float *classes = _class_scores.ptr<float>();
+      const float *confs = _conf_scores.ptr<float>();
+      parallel_for_(Range(0, (int)batch), [&](const Range &range)
       {
-        transformed_bbox_preds[i].resize(4);
-        final_probs[i].resize(num_classes);
-        min_max_bboxes[i].resize(4);
-      }
+        for (int i = range.start; i < range.end; ++i)
+        {
+          inf.decode(deltas + i * inf.anchors * 4,
+                     classes + i * inf.anchors * inf.num_classes,
+                     confs + i * inf.anchors, thresh, detections[i]);
+        }
+      });
+    }
 
-      // Transform relative coordinates from ConvDet to bounding box coordinates
-      transform_bboxes(&transformed_bbox_preds);
+    void InferBbox::decode(const float *deltas, const float *classes,
+      const float *confs, double thresh, std::vector<object> &dets) const
+    {
+      CV_Assert(anchors >= n_top_detections);
+
+      // Transform the deltas to clipped [xmin, ymin, xmax, ymax] boxes and
+      // keep the most probable class of each anchor, the blobs are indexed
+      // by anchor with the layouts (H, W, anchor * 4), (H * W * anchor, class)
+      // and (H, W, anchor)
+      std::vector<double> boxes(anchors * 4);
+      std::vector<double> max_class_probs(anchors);
+      std::vector<size_t> max_class_idxs(anchors);
+      const double x_max = image_width - 1.0, y_max = image_height - 1.0;
+      for (size_t anchor = 0; anchor < anchors; ++anchor)
+      {
+        const std::vector<double> &av = anchors_values[anchor];
+        const float *delta = deltas + anchor * 4;
+        double c_x = av[0] + av[3] * (double)delta[0];
+        double c_y = av[1] + av[2] * (double)delta[1];
+        double b_h = av[2] * exp((double)delta[2]);
+        double b_w = av[3] * exp((double)delta[3]);
+
+        double *box = &boxes[anchor * 4];
+        box[0] = std::min(std::max(0.0, c_x - b_w / 2.0), x_max);
+        box[1] = std::min(std::max(0.0, c_y - b_h / 2.0), y_max);
+        box[2] = std::max(std::min(x_max, c_x + b_w / 2.0), 0.0);
+        box[3] = std::max(std::min(y_max, c_y + b_h / 2.0), 0.0);
+
+        const double pr_object = confs[anchor];
+        const float *pr_class = classes + anchor * num_classes;
+        size_t best = 0;
+        double best_prob = pr_object * pr_class[0];
+        for (size_t c = 1; c < num_classes; ++c)
+        {
+          double prob = pr_object * pr_class[c];
+          if (prob > best_prob)
+          {
+            best_prob = prob;
+            best = c;
+          }
+        }
+        max_class_probs[anchor] = best_prob;
+        max_class_idxs[anchor] = best;
+      }
 
-      // Do the inverse transformation of the predicted bboxes
-      transform_bboxes_inv(&transformed_bbox_preds, &min_max_bboxes);
+      // Get n_top_detections, sorted once by decreasing probability
+      std::vector<size_t> order(anchors);
+      std::iota(order.begin(), order.end(), (size_t)0);
+      std::partial_sort(order.begin(), order.begin() + n_top_detections,
+        order.end(), [&](size_t l, size_t r)
+        {
+          return max_class_probs[l] > max_class_probs[r] ||
+                 (max_class_probs[l] == max_class_probs[r] && l < r);
+        });
+
+      // Apply Non-Maximal-Supression per class, the boxes of a class stay
+      // sorted by probability and are stored by coordinate for the IOU
+      std::vector<double> xmins, ymins, xmaxs, ymaxs, probs, iou;
+      std::vector<size_t> idxs;
+      std::vector<bool> keep;
+      for (size_t c = 0; c < num_classes; ++c)
+      {
+        idxs.clear();
+        for (size_t n = 0; n < n_top_detections; ++n)
+        {
+          if (max_class_idxs[order[n]] == c)
+            idxs.push_back(order[n]);
+        }
 
-      // Ensure that the predicted bounding boxes are well within the image
-      // dimensions
-      assert_predictions(&min_max_bboxes);
+        // Just continue in case there are no objects of this class
+        if (idxs.empty())
+          continue;
 
-      // Compute the final probability values
-      final_probability_dist(&final_probs);
+        const size_t m = idxs.size();
+        xmins.resize(m); ymins.resize(m); xmaxs.resize(m); ymaxs.resize(m);
+        for (size_t i = 0; i < m; ++i)
+        {
+          const double *box = &boxes[idxs[i] * 4];
+          xmins[i] = box[0]; ymins[i] = box[1];
+          xmaxs[i] = box[2]; ymaxs[i] = box[3];
+        }
 
-      // Filter the classes of n_top_detections
-      std::vector<std::vector<double> > top_n_boxes(n_top_detections);
-      std::vector<size_t> top_n_idxs(n_top_detections);
-      std::vector<double> top_n_probs(n_top_detections);
-      for (size_t i = 0; i < n_top_detections; ++i)
-      {
-        top_n_boxes[i].resize(4);
-      }
+        // every box suppresses the less probable overlapping ones, as in the
+        // reference SqueezeDet implementation
+        keep.assign(m, true);
+        iou.resize(m);
+        for (size_t i = 0; i + 1 < m; ++i)
+        {
+          const double base_box[4] = { xmins[i], ymins[i], xmaxs[i], ymaxs[i] };
+          const size_t rest = m - i - 1;
+          iou_with_base(&xmins[i + 1], &ymins[i + 1], &xmaxs[i + 1],
+                        &ymaxs[i + 1], rest, base_box, epsilon, &iou[0]);
+          for (size_t j = 0; j < rest; ++j)
+          {
+            if (iou[j] > nms_intersection_thresh)
+              keep[i + j + 1] = false;
+          }
+        }
 
-      filter_top_n(&final_probs, &min_max_bboxes, top_n_boxes,
-        top_n_idxs, top_n_probs);
+        for (size_t i = 0; i < m; ++i)
+        {
+          const double prob = max_class_probs[idxs[i]];
+          if (keep[i] && prob > thresh)
+          {
+            dnn_objdetect::object new_detection;
 
-      // Apply Non-Maximal-Supression to the n_top_detections
-      nms_wrapper(top_n_boxes, top_n_idxs, top_n_probs);
+            new_detection.class_idx = c;
+            new_detection.label_name = this->label_map[c];
+            new_detection.xmin = (int)xmins[i];
+            new_detection.ymin = (int)ymins[i];
+            new_detection.xmax = (int)xmaxs[i];
+            new_detection.ymax = (int)ymaxs[i];
+            new_detection.class_prob = prob;
 
+            dets.push_back(new_detection);
+          }
+        }
+      }
     }
 
     void InferBbox::transform_bboxes(std::vector<std::vector<double> > *bboxes)
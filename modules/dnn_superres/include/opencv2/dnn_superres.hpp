@@ -49,6 +49,16 @@ private:
 
     int sc; //scale factor
 
+    int tile_size; //side of the input tiles, 0 when the whole image is upsampled at once
+
+    int tile_overlap; //input pixels shared by neighbouring tiles
+
+    int tile_batch; //tiles per forward pass
+
+    Mat forwardImage(const Mat& inpImg, const Scalar& mean);
+
+    Mat forwardTiles(const Mat& inpImg, const Scalar& mean);
+
     void reconstruct_YCrCb(InputArray inpImg, InputArray origImg, OutputArray outpImg, int scale);
 
     void preprocess_YCrCb(InputArray inpImg, OutputArray outpImg);
@@ -102,6 +112,19 @@ public:
     */
     CV_WRAP void setPreferableTarget(int targetId);
 
+    /** @brief Set tiled upsampling for large images
+
+    upsample() splits the images which are larger than the tiles and passes the tiles through the network
+    one batch after the other, so that the activation memory is bounded by the tile size instead of the image size.
+    The overlapping parts of the upscaled tiles are blended linearly. Preparing the next batch and stitching the
+    previous one run concurrently with the inference.
+    @param tileSize Side of the square input tiles in pixels, 0 disables tiling (default).
+    @param overlap Number of input pixels shared by neighbouring tiles, it should cover the receptive field
+    of the network near the tile borders. Must be less than tileSize.
+    @param batchSize Number of tiles passed through the network at once.
+     */
+    CV_WRAP void setTiling(int tileSize, int overlap = 16, int batchSize = 1);
+
     /** @brief Upsample via neural network
     @param img Image to upscale
     @param result Destination upscaled image
@@ -6,6 +6,8 @@
 
 #include "opencv2/dnn_superres.hpp"
 
+#include <future>
+
 namespace cv
 {
 namespace dnn_superres
@@ -49,12 +51,13 @@ Ptr<DnnSuperResImpl> DnnSuperResImpl::create(){
 }
 
 DnnSuperResImpl::DnnSuperResImpl()
+    : sc(0), tile_size(0), tile_overlap(0), tile_batch(1)
 {
     DepthToSpace::registerLayer();
 }
 
 DnnSuperResImpl::DnnSuperResImpl(const String& algo, int scale)
-    : alg(algo), sc(scale)
+    : alg(algo), sc(scale), tile_size(0), tile_overlap(0), tile_batch(1)
 {
     DepthToSpace::registerLayer();
 }
@@ -109,6 +112,182 @@ void DnnSuperResImpl::setPreferableTarget(int targetId)
     CV_LOG_INFO(NULL, "Successfully set target device.");
 }
 
+void DnnSuperResImpl::setTiling(int tileSize, int overlap, int batchSize)
+{
+    CV_Assert(tileSize >= 0 && overlap >= 0 && batchSize >= 1);
+    CV_Assert(tileSize == 0 || overlap < tileSize);
+
+    this->tile_size = tileSize;
+    this->tile_overlap = overlap;
+    this->tile_batch = batchSize;
+}
+
+//Tile origins along one axis: the tiles advance by step and the last one ends at the border
+static void tileStarts(int size, int tile, int step, std::vector<int>& starts)
+{
+    starts.clear();
+    for (int x = 0; ; x += step)
+    {
+        if (x + tile >= size)
+        {
+            starts.push_back(size - tile);
+            break;
+        }
+        starts.push_back(x);
+    }
+}
+
+//Blending weights of the upscaled tiles along one axis: linear ramps over the parts which are shared
+//with the neighbouring tiles, normalized so that the weights of every output pixel sum up to one
+static void blendWeights(const std::vector<int>& starts, int tile, int scale, std::vector<Mat_<float> >& weights)
+{
+    const int n = (int)starts.size();
+    const int len = tile * scale;
+    Mat_<float> sum = Mat_<float>::zeros(1, (starts.back() + tile) * scale);
+
+    weights.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        const int begin = starts[i] * scale;
+        const int left = i > 0 ? (starts[i - 1] + tile) * scale - begin : 0;
+        const int right = i + 1 < n ? begin + len - starts[i + 1] * scale : 0;
+
+        weights[i].create(1, len);
+        for (int x = 0; x < len; x++)
+        {
+            float w = 1.f;
+            if (left > 0)
+                w = std::min(w, (x + 0.5f) / left);
+            if (right > 0)
+                w = std::min(w, (len - x - 0.5f) / right);
+            weights[i](x) = w;
+            sum(begin + x) += w;
+        }
+    }
+    for (int i = 0; i < n; i++)
+    {
+        const int begin = starts[i] * scale;
+        for (int x = 0; x < len; x++)
+            weights[i](x) /= sum(begin + x);
+    }
+}
+
+//Adds an upscaled tile weighted by the product of its blending weights to dst at org
+static void accumulateTile(const Mat& tile, const Mat_<float>& wx, const Mat_<float>& wy, Mat& dst, Point org)
+{
+    CV_Assert(tile.depth() == CV_32F && tile.type() == dst.type());
+    const int cn = tile.channels();
+
+    parallel_for_(Range(0, tile.rows), [&](const Range& range)
+    {
+        for (int y = range.start; y < range.end; y++)
+        {
+            const float* src = tile.ptr<float>(y);
+            float* d = dst.ptr<float>(org.y + y) + org.x * cn;
+            const float wy_ = wy(y);
+            for (int x = 0; x < tile.cols; x++)
+            {
+                const float w = wx(x) * wy_;
+                for (int c = 0; c < cn; c++)
+                    d[x * cn + c] += src[x * cn + c] * w;
+            }
+        }
+    });
+}
+
+Mat DnnSuperResImpl::forwardImage(const Mat& inpImg, const Scalar& mean)
+{
+    if (this->tile_size > 0 && (inpImg.cols > this->tile_size || inpImg.rows > this->tile_size))
+        return forwardTiles(inpImg, mean);
+
+    //Create blob from image so it has size [1,C,Width,Height] and subtract the mean
+    cv::Mat blob;
+    dnn::blobFromImage(inpImg, blob, 1.0, Size(), mean);
+
+    this->net.setInput(blob);
+    Mat blob_output = this->net.forward();
+
+    //Convert from blob
+    std::vector <Mat> model_outs;
+    dnn::imagesFromBlob(blob_output, model_outs);
+    return model_outs[0];
+}
+
+Mat DnnSuperResImpl::forwardTiles(const Mat& inpImg, const Scalar& mean)
+{
+    CV_Assert(this->sc > 0);
+    const int scale = this->sc;
+    const int tw = std::min(this->tile_size, inpImg.cols);
+    const int th = std::min(this->tile_size, inpImg.rows);
+
+    std::vector<int> xs, ys;
+    tileStarts(inpImg.cols, tw, std::max(tw - this->tile_overlap, 1), xs);
+    tileStarts(inpImg.rows, th, std::max(th - this->tile_overlap, 1), ys);
+
+    std::vector<Mat_<float> > wx, wy;
+    blendWeights(xs, tw, scale, wx);
+    blendWeights(ys, th, scale, wy);
+
+    const int tiles_x = (int)xs.size();
+    const int num_tiles = tiles_x * (int)ys.size();
+    const int batch = this->tile_batch;
+    const int num_batches = (num_tiles + batch - 1) / batch;
+
+    //All the tiles have the same size, so that they can be stacked into one blob
+    auto prepare = [&](int b) -> Mat
+    {
+        std::vector<Mat> tiles;
+        for (int t = b * batch; t < std::min((b + 1) * batch, num_tiles); t++)
+            tiles.push_back(inpImg(Rect(xs[t % tiles_x], ys[t / tiles_x], tw, th)));
+        Mat blob;
+        dnn::blobFromImages(tiles, blob, 1.0, Size(), mean);
+        return blob;
+    };
+
+    //The result is allocated with the first tile, the number of output channels depends on the model
+    Mat result;
+    auto stitch = [&](int b, const std::vector<Mat>& outs)
+    {
+        for (size_t k = 0; k < outs.size(); k++)
+        {
+            const int t = b * batch + (int)k;
+            const int i = t % tiles_x, j = t / tiles_x;
+            CV_Assert(outs[k].cols == tw * scale && outs[k].rows == th * scale);
+            if (result.empty())
+                result = Mat::zeros(inpImg.rows * scale, inpImg.cols * scale, outs[k].type());
+            accumulateTile(outs[k], wx[i], wy[j], result, Point(xs[i] * scale, ys[j] * scale));
+        }
+    };
+
+    Mat blob = prepare(0);
+    std::vector<Mat> outs, prev_outs;
+    for (int b = 0; b < num_batches; b++)
+    {
+        this->net.setInput(blob);
+
+        //Stitch the previous batch and prepare the next one while the network runs.
+        //The future waits for the task on destruction, also when forward() throws.
+        Mat next_blob;
+        std::future<void> task = std::async(std::launch::async, [&]()
+        {
+            if (b > 0)
+                stitch(b - 1, prev_outs);
+            if (b + 1 < num_batches)
+                next_blob = prepare(b + 1);
+        });
+
+        //imagesFromBlob() copies the outputs, the network reuses its output blob in the next pass
+        dnn::imagesFromBlob(this->net.forward(), outs);
+        task.get();
+
+        std::swap(outs, prev_outs);
+        blob = next_blob;
+    }
+    stitch(num_batches - 1, prev_outs);
+
+    return result;
+}
+
 void DnnSuperResImpl::upsample(InputArray img, OutputArray result)
 {
     if (net.empty())
@@ -126,19 +305,8 @@ void DnnSuperResImpl::upsample(InputArray img, OutputArray result)
 
         Mat Y = ycbcr_channels[0];
 
-        //Create blob from image so it has size 1,1,Width,Height
-        cv::Mat blob;
-        dnn::blobFromImage(Y, blob, 1.0);
-
         //Get the HR output
-        this->net.setInput(blob);
-
-        Mat blob_output = this->net.forward();
-
-        //Convert from blob
-        std::vector <Mat> model_outs;
-        dnn::imagesFromBlob(blob_output, model_outs);
-        Mat out_img = model_outs[0];
+        Mat out_img = forwardImage(Y, Scalar());
 
         //Reconstruct: upscale the Cr and Cb space and merge the three layer
         reconstruct_YCrCb(out_img, preproc_img, result, this->sc);
@@ -152,20 +320,11 @@ void DnnSuperResImpl::upsample(InputArray img, OutputArray result)
         Mat float_img;
         img.getMat().convertTo(float_img, CV_32F, 1.0);
 
-        //Create blob from image so it has size [1,3,Width,Height] and subtract dataset mean
-        cv::Mat blob;
-        dnn::blobFromImage(float_img, blob, 1.0, Size(), mean);
-
-        //Get the HR output
-        this->net.setInput(blob);
-        Mat blob_output = this->net.forward();
-
-        //Convert from blob
-        std::vector <Mat> model_outs;
-        dnn::imagesFromBlob(blob_output, model_outs);
+        //Get the HR output, the dataset mean is subtracted from the input
+        Mat out_img = forwardImage(float_img, mean);
 
         //Post-process: add mean.
-        Mat(model_outs[0] + mean).convertTo(result, CV_8U);
+        Mat(out_img + mean).convertTo(result, CV_8U);
     }
     else
     {
@@ -59,6 +59,34 @@ TEST(CV_DnnSuperResSingleOutputTest, accuracy_fsrcnn_3)
     runSingleModel("fsrcnn", 3, "FSRCNN_x3.pb");
 }
 
+TEST(CV_DnnSuperResSingleOutputTest, tiled_upsample)
+{
+    Ptr <DnnSuperResImpl> dnn_sr = makePtr<DnnSuperResImpl>();
+
+    std::string path = cvtest::findDataFile(DNN_SUPERRES_DIR + "/" + IMAGE_FILENAME);
+    Mat img = imread(path);
+    ASSERT_FALSE(img.empty()) << "Test image can't be loaded: " << path;
+
+    dnn_sr->readModel(cvtest::findDataFile(DNN_SUPERRES_DIR + "/FSRCNN_x2.pb"));
+    dnn_sr->setModel("fsrcnn", 2);
+
+    Mat result;
+    dnn_sr->upsample(img, result);
+
+    // tiles which cover the image give the same result
+    Mat result_single;
+    dnn_sr->setTiling(std::max(img.cols, img.rows), 8);
+    dnn_sr->upsample(img, result_single);
+    EXPECT_EQ(0, cvtest::norm(result, result_single, NORM_INF));
+
+    Mat result_tiled;
+    dnn_sr->setTiling(96, 24, 3);
+    dnn_sr->upsample(img, result_tiled);
+    ASSERT_EQ(result.size(), result_tiled.size());
+    ASSERT_EQ(result.type(), result_tiled.type());
+    EXPECT_GT(cv::PSNR(result, result_tiled), 40);
+}
+
 
 /****************************************************************************************\
 *                                Test multi output models                               *
@@ -41,6 +41,7 @@
 
 #include "dpm_cascade.hpp"
 #include "dpm_nms.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include <limits>
 #include <fstream>
@@ -113,7 +114,8 @@ void DPMCascade::initDPMCascade()
         dtLevelOffset[i] = dtLevelOffset[i-1] + numDefParams*featDimsProd[i-1];
     }
 
-    // cache of precomputed deformation costs
+    // cache of precomputed deformation costs, indexed by the displacement
+    // x - px + halfWindowSize so that neighbor locations read neighbor costs
     defCostCacheX.resize(numDefParams);
     defCostCacheY.resize(numDefParams);
 
@@ -127,7 +129,7 @@ void DPMCascade::initDPMCascade()
 
         for (int j = 0; j < 2*halfWindowSize + 1; j++)
         {
-            int delta = j - halfWindowSize;
+            int delta = halfWindowSize - j;
             int deltaSquare = delta*delta;
             defCostCacheX[i][j] = -def[0]*deltaSquare - def[1]*delta;
             defCostCacheY[i][j] = -def[2]*deltaSquare - def[3]*delta;
@@ -151,6 +153,19 @@ vector< vector<double> > DPMCascade::detect(Mat &image)
     // compute features
     computeFeatures(image);
 
+    return detectFeatures();
+}
+
+vector< vector<double> > DPMCascade::detect(const vector< Mat > &sharedPyramid,
+        const PyramidParameter &sharedParams)
+{
+    setFeatures(sharedPyramid, sharedParams);
+
+    return detectFeatures();
+}
+
+vector< vector<double> > DPMCascade::detectFeatures()
+{
     // pre-allocate storage
     initDPMCascade();
 
@@ -165,16 +180,20 @@ vector< vector<double> > DPMCascade::detect(Mat &image)
     return detections;
 }
 
-void DPMCascade::computeFeatures(const Mat &im)
+PyramidParameter DPMCascade::getPyramidParameters() const
 {
-    // initialize feature pyramid
     PyramidParameter params;
     params.padx = model.maxSizeX;
     params.pady = model.maxSizeY;
     params.interval = model.interval;
     params.binSize = model.sBin;
+    return params;
+}
 
-    feature = Feature(params);
+void DPMCascade::computeFeatures(const Mat &im)
+{
+    // initialize feature pyramid
+    feature = Feature(getPyramidParameters());
 
     // compute pyramid
     feature.computeFeaturePyramid(im, pyramid);
@@ -183,6 +202,38 @@ void DPMCascade::computeFeatures(const Mat &im)
     feature.projectFeaturePyramid(model.pcaCoeff, pyramid, pcaPyramid);
 }
 
+void DPMCascade::setFeatures(const vector< Mat > &sharedPyramid,
+        const PyramidParameter &sharedParams)
+{
+    PyramidParameter params = getPyramidParameters();
+    CV_Assert(sharedParams.interval == params.interval && sharedParams.binSize == params.binSize);
+    CV_Assert(sharedParams.padx >= params.padx && sharedParams.pady >= params.pady);
+
+    // the padding cells of the HOG features do not depend on the image, so
+    // removing the extra padding of the shared pyramid gives the features
+    // the pyramid of this model would have
+    const int dx = sharedParams.padx - params.padx;
+    const int dy = sharedParams.pady - params.pady;
+    pyramid.resize(sharedPyramid.size());
+    for (size_t i = 0; i < sharedPyramid.size(); i++)
+    {
+        const Mat &feat = sharedPyramid[i];
+        if (feat.empty())
+            pyramid[i] = Mat();
+        else
+            pyramid[i] = feat(Rect(dx*feature.dimHOG, dy,
+                        feat.cols - 2*dx*feature.dimHOG, feat.rows - 2*dy));
+    }
+
+    params = sharedParams;
+    params.padx = model.maxSizeX;
+    params.pady = model.maxSizeY;
+    feature = Feature(params);
+
+    // compute projected pyramid
+    feature.projectFeaturePyramid(model.pcaCoeff, pyramid, pcaPyramid);
+}
+
 void DPMCascade::computeLocationScores(vector< vector< double > >  &locationScores)
 {
     vector< vector < double > > locationWeight = model.locationWeight;
@@ -212,66 +263,68 @@ void DPMCascade::computeLocationScores(vector< vector< double > >  &locationScor
 
 void DPMCascade::computeRootPCAScores(vector< vector< Mat > > &rootScores)
 {
-    PyramidParameter params = feature.getPyramidParameters();
+    const PyramidParameter &params = feature.getPyramidParameters();
     rootScores.resize(model.numComponents);
     int nlevels = (int) pyramid.size();
     int interval = params.interval;
 
     for (int comp = 0; comp < model.numComponents; comp++)
-    {
         rootScores[comp].resize(nlevels);
-        ParalComputeRootPCAScores paralTask(pcaPyramid, model.rootPCAFilters[comp],
-                model.pcaDim, rootScores[comp]);
-        parallel_for_(Range(interval, nlevels), paralTask);
-    }
+
+    // the levels of all the components are convolved in parallel
+    ParalComputeRootPCAScores paralTask(pcaPyramid, model.rootPCAFilters,
+            model.pcaDim, interval, rootScores);
+    parallel_for_(Range(0, model.numComponents*(nlevels - interval)), paralTask);
 }
 
 ParalComputeRootPCAScores::ParalComputeRootPCAScores(
         const vector< Mat > &pcaPyrad,
-        const Mat &f,
+        const vector< Mat > &f,
         int dim,
-        vector< Mat > &sc):
+        int firstLevel,
+        vector< vector< Mat > > &sc):
     pcaPyramid(pcaPyrad),
-    filter(f),
+    filters(f),
     pcaDim(dim),
+    startLevel(firstLevel),
     scores(sc)
 {
 }
 
 void ParalComputeRootPCAScores::operator() (const Range &range) const
 {
-    for (int level = range.start; level != range.end; level++)
+    const int numLevels = (int)pcaPyramid.size() - startLevel;
+    // convolution engine
+    ConvolutionEngine convEngine;
+
+    for (int task = range.start; task != range.end; task++)
     {
-        Mat feat = pcaPyramid[level];
+        int comp = task / numLevels;
+        int level = startLevel + task % numLevels;
+        const Mat &feat = pcaPyramid[level];
+        const Mat &filter = filters[comp];
 
         // compute size of output
         int height = feat.rows - filter.rows + 1;
         int width = (feat.cols - filter.cols) / pcaDim + 1;
 
         Mat result = Mat::zeros(Size(width, height), CV_64F);
-        // convolution engine
-        ConvolutionEngine convEngine;
         convEngine.convolve(feat, filter, pcaDim, result);
-        scores[level] = result;
+        scores[comp][level] = result;
     }
 }
 
-void DPMCascade::process( vector< vector<double> > &dets)
+void DPMCascade::process( vector< vector<double> > &detections)
 {
-    PyramidParameter params = feature.getPyramidParameters();
+    const PyramidParameter &params = feature.getPyramidParameters();
     int interval = params.interval;
     int padx = params.padx;
     int pady = params.pady;
-    vector<double> scales = params.scales;
+    const vector<double> &scales = params.scales;
 
     int nlevels = (int)pyramid.size() - interval;
     CV_Assert(nlevels > 0);
 
-    // keep track of the PCA scores for each PCA filter
-    vector< vector< double > > pcaScore(model.numComponents);
-    for (int comp = 0; comp < model.numComponents; comp++)
-        pcaScore[comp].resize(model.numParts[comp]+1);
-
     // compute location scores
     vector< vector< double > > locationScores;
     computeLocationScores(locationScores);
@@ -280,149 +333,195 @@ void DPMCascade::process( vector< vector<double> > &dets)
     vector< vector< Mat > > rootPCAScores;
     computeRootPCAScores(rootPCAScores);
 
+    // the storage of the cascade is split by pyramid level, so the levels of
+    // a component are processed in parallel, each level keeping its own
+    // detections to record them in the same order as a serial process
+    vector< vector< vector<double> > > levelDets(nlevels);
+
     // process each model component and pyramid level
     for (int comp = 0; comp < model.numComponents; comp++)
     {
-        for (int plevel = 0; plevel < nlevels; plevel++)
+        parallel_for_(Range(0, nlevels), [&](const Range &range)
         {
-            // root filter pyramid level
-            int rlevel = plevel + interval;
-            double bias = model.bias[comp] + locationScores[comp][rlevel];
-            // get the scores of the first PCA filter
-            Mat rtscore = rootPCAScores[comp][rlevel];
-            // process each location in the current pyramid level
-            for (int rx = (int)ceil(padx/2.0); rx < rtscore.cols - (int)ceil(padx/2.0); rx++)
+            // keep track of the PCA scores for each PCA filter
+            vector< double > pcaScore(model.numParts[comp]+1);
+
+            for (int plevel = range.start; plevel < range.end; plevel++)
             {
-                for (int ry = (int)ceil(pady/2.0); ry < rtscore.rows - (int)ceil(pady/2.0); ry++)
+                vector< vector<double> > &dets = levelDets[plevel];
+                // root filter pyramid level
+                int rlevel = plevel + interval;
+                double bias = model.bias[comp] + locationScores[comp][rlevel];
+                // get the scores of the first PCA filter
+                Mat rtscore = rootPCAScores[comp][rlevel];
+                // process each location in the current pyramid level
+                for (int rx = (int)ceil(padx/2.0); rx < rtscore.cols - (int)ceil(padx/2.0); rx++)
                 {
-                    // get stage 0 score
-                    double score = rtscore.at<double>(ry, rx) + bias;
-                    // record PCA score
-                    pcaScore[comp][0] = score - bias;
-                    // cascade stage 1 through 2*numparts + 2
-                    int stage = 1;
-                    int numstages = 2*model.numParts[comp] + 2;
-                    for(; stage < numstages; stage++)
+                    for (int ry = (int)ceil(pady/2.0); ry < rtscore.rows - (int)ceil(pady/2.0); ry++)
                     {
-                        double t = model.prunThreshold[comp][2*stage-1];
-                        // check for hypothesis pruning
-                        if (score < t)
-                            break;
-
-                        // pca == 1 if place filters
-                        // pca == 0 if place non-pca filters
-                        bool isPCA = (stage < model.numParts[comp] + 1 ? true : false);
-                        // get the part index
-                        // root parts have index -1, none-root part are indexed 0:numParts-1
-                        int part = model.partOrder[comp][stage] - 1;// partOrder
-
-                        if (part == -1)
+                        // get stage 0 score
+                        double score = rtscore.at<double>(ry, rx) + bias;
+                        // record PCA score
+                        pcaScore[0] = score - bias;
+                        // cascade stage 1 through 2*numparts + 2
+                        int stage = 1;
+                        int numstages = 2*model.numParts[comp] + 2;
+                        for(; stage < numstages; stage++)
                         {
-                            // calculate the root non-pca score
-                            // and replace the PCA score
-                            double rscore = 0.0;
-                            if (isPCA)
+                            double t = model.prunThreshold[comp][2*stage-1];
+                            // check for hypothesis pruning
+                            if (score < t)
+                                break;
+
+                            // pca == 1 if place filters
+                            // pca == 0 if place non-pca filters
+                            bool isPCA = (stage < model.numParts[comp] + 1 ? true : false);
+                            // get the part index
+                            // root parts have index -1, none-root part are indexed 0:numParts-1
+                            int part = model.partOrder[comp][stage] - 1;// partOrder
+
+                            if (part == -1)
                             {
-                                rscore = convolutionEngine.convolve(pcaPyramid[rlevel],
-                                        model.rootPCAFilters[comp],
-                                        model.pcaDim, rx, ry);
+                                // calculate the root non-pca score
+                                // and replace the PCA score
+                                double rscore = 0.0;
+                                if (isPCA)
+                                {
+                                    rscore = convolutionEngine.convolve(pcaPyramid[rlevel],
+                                            model.rootPCAFilters[comp],
+                                            model.pcaDim, rx, ry);
+                                }
+                                else
+                                {
+                                    rscore = convolutionEngine.convolve(pyramid[rlevel],
+                                            model.rootFilters[comp],
+                                            model.numFeatures, rx, ry);
+                                }
+                                score += rscore - pcaScore[0];
                             }
                             else
                             {
-                                rscore = convolutionEngine.convolve(pyramid[rlevel],
-                                        model.rootFilters[comp],
-                                        model.numFeatures, rx, ry);
-                            }
-                            score += rscore - pcaScore[comp][0];
-                        }
-                        else
+                                // place a non-root filter
+                                int pId = model.pFind[comp][part];
+                                int px = 2*rx + (int)model.anchors[pId][0];
+                                int py = 2*ry + (int)model.anchors[pId][1];
+
+                                // look up the filter and deformation model
+                                double defThreshold =
+                                    model.prunThreshold[comp][2*stage] - score;
+
+                                double ps = computePartScore(plevel, pId, px, py,
+                                        isPCA, defThreshold);
+
+                                if (isPCA)
+                                {
+                                    // record PCA filter score
+                                    pcaScore[part+1] = ps;
+                                    // update the hypothesis score
+                                    score += ps;
+                                }
+                                else
+                                {
+                                    // update the hypothesis score by replacing
+                                    // the PCA score
+                                    score += ps - pcaScore[part+1];
+                                } // isPCA == false
+                            } // part != -1
+
+                        } // stages
+
+                        // check if the hypothesis passed all stages with a
+                        // final score over the global threshold
+                        if (stage == numstages && score >= model.scoreThresh)
                         {
-                            // place a non-root filter
-                            int pId = model.pFind[comp][part];
-                            int px = 2*rx + (int)model.anchors[pId][0];
-                            int py = 2*ry + (int)model.anchors[pId][1];
-
-                            // look up the filter and deformation model
-                            double defThreshold =
-                                model.prunThreshold[comp][2*stage] - score;
+                            vector<double> coords;
+                            // compute and record image coordinates of the detection window
+                            double scale = model.sBin/scales[rlevel];
+                            double x1 = (rx-padx)*scale;
+                            double y1 = (ry-pady)*scale;
+                            double x2 = x1 + model.rootFilterDims[comp].width*scale - 1;
+                            double y2 = y1 + model.rootFilterDims[comp].height*scale - 1;
 
-                            double ps = computePartScore(plevel, pId, px, py,
-                                    isPCA, defThreshold);
+                            coords.push_back(x1);
+                            coords.push_back(y1);
+                            coords.push_back(x2);
+                            coords.push_back(y2);
 
-                            if (isPCA)
+                            // compute and record image coordinates of the part filters
+                            scale = model.sBin/scales[plevel];
+                            int featWidth = pyramid[plevel].cols/feature.dimHOG;
+                            for (int p = 0; p < model.numParts[comp]; p++)
                             {
-                                // record PCA filter score
-                                pcaScore[comp][part+1] = ps;
-                                // update the hypothesis score
-                                score += ps;
+                                int pId = model.pFind[comp][p];
+                                int probx = 2*rx + (int)model.anchors[pId][0];
+                                int proby = 2*ry + (int)model.anchors[pId][1];
+                                int offset = dtLevelOffset[plevel] +
+                                    pId*featDimsProd[plevel] +
+                                    (proby - pady)*featWidth +
+                                    probx - padx;
+                                int px = dtArgmaxX[offset] + padx;
+                                int py = dtArgmaxY[offset] + pady;
+                                x1 = (px - 2*padx)*scale;
+                                y1 = (py - 2*pady)*scale;
+                                x2 = x1 + model.partFilterDims[p].width*scale - 1;
+                                y2 = y1 + model.partFilterDims[p].height*scale - 1;
+                                coords.push_back(x1);
+                                coords.push_back(y1);
+                                coords.push_back(x2);
+                                coords.push_back(y2);
                             }
-                            else
-                            {
-                                // update the hypothesis score by replacing
-                                // the PCA score
-                                score += ps - pcaScore[comp][part+1];
-                            } // isPCA == false
-                        } // part != -1
 
-                    } // stages
+                            // record component number and score
+                            coords.push_back(comp + 1);
+                            coords.push_back(score);
 
-                    // check if the hypothesis passed all stages with a
-                    // final score over the global threshold
-                    if (stage == numstages && score >= model.scoreThresh)
-                    {
-                        vector<double> coords;
-                        // compute and record image coordinates of the detection window
-                        double scale = model.sBin/scales[rlevel];
-                        double x1 = (rx-padx)*scale;
-                        double y1 = (ry-pady)*scale;
-                        double x2 = x1 + model.rootFilterDims[comp].width*scale - 1;
-                        double y2 = y1 + model.rootFilterDims[comp].height*scale - 1;
-
-                        coords.push_back(x1);
-                        coords.push_back(y1);
-                        coords.push_back(x2);
-                        coords.push_back(y2);
-
-                        // compute and record image coordinates of the part filters
-                        scale = model.sBin/scales[plevel];
-                        int featWidth = pyramid[plevel].cols/feature.dimHOG;
-                        for (int p = 0; p < model.numParts[comp]; p++)
-                        {
-                            int pId = model.pFind[comp][p];
-                            int probx = 2*rx + (int)model.anchors[pId][0];
-                            int proby = 2*ry + (int)model.anchors[pId][1];
-                            int offset = dtLevelOffset[plevel] +
-                                pId*featDimsProd[plevel] +
-                                (proby - pady)*featWidth +
-                                probx - padx;
-                            int px = dtArgmaxX[offset] + padx;
-                            int py = dtArgmaxY[offset] + pady;
-                            x1 = (px - 2*padx)*scale;
-                            y1 = (py - 2*pady)*scale;
-                            x2 = x1 + model.partFilterDims[p].width*scale - 1;
-                            y2 = y1 + model.partFilterDims[p].height*scale - 1;
-                            coords.push_back(x1);
-                            coords.push_back(y1);
-                            coords.push_back(x2);
-                            coords.push_back(y2);
+                            dets.push_back(coords);
                         }
+                    } // ry
+                } // rx
+            } // for each pyramid level
+        });
 
-                        // record component number and score
-                        coords.push_back(comp + 1);
-                        coords.push_back(score);
-
-                        dets.push_back(coords);
-                    }
-                } // ry
-            } // rx
-        } // for each pyramid level
+        for (int plevel = 0; plevel < nlevels; plevel++)
+        {
+            detections.insert(detections.end(), levelDets[plevel].begin(), levelDets[plevel].end());
+            levelDets[plevel].clear();
+        }
     } // for each component
 }
 
+// add the deformation costs to a row of convolution values of the distance
+// transform window, returns the maximum of the row
+static inline double addDeformationCosts(const double *conv, const double *defX,
+        double defY, double *v, int len)
+{
+    int x = 0;
+    double rowMax = -numeric_limits<double>::infinity();
+#if CV_SIMD128_64F
+    v_float64x2 v_defY = v_setall_f64(defY);
+    v_float64x2 v_rowMax = v_setall_f64(rowMax);
+    for (; x <= len - v_float64x2::nlanes; x += v_float64x2::nlanes)
+    {
+        v_float64x2 v_val = v_load(conv + x) + (v_load(defX + x) + v_defY);
+        v_store(v + x, v_val);
+        v_rowMax = v_max(v_rowMax, v_val);
+    }
+    double CV_DECL_ALIGNED(16) buf[v_float64x2::nlanes];
+    v_store_aligned(buf, v_rowMax);
+    rowMax = std::max(buf[0], buf[1]);
+#endif
+    for (; x < len; x++)
+    {
+        v[x] = conv[x] + (defX[x] + defY);
+        rowMax = std::max(rowMax, v[x]);
+    }
+    return rowMax;
+}
+
 double DPMCascade::computePartScore(int plevel, int pId, int px, int py, bool isPCA, double defThreshold)
 {
     // remove virtual padding
-    PyramidParameter params = feature.getPyramidParameters();
+    const PyramidParameter &params = feature.getPyramidParameters();
     px -= params.padx;
     py -= params.pady;
 
@@ -487,8 +586,8 @@ double DPMCascade::computePartScore(int plevel, int pId, int px, int py, bool is
                 continue;
 
             // check for deformation pruning
-            double defCost = defCostCacheX[pId][px - x + halfWindowSize]
-                + defCostCacheY[pId][py - y + halfWindowSize];
+            double defCost = defCostCacheX[pId][x - px + halfWindowSize]
+                + defCostCacheY[pId][y - py + halfWindowSize];
 
             if (defCost < defThreshold)
                 continue;
@@ -511,33 +610,31 @@ double DPMCascade::computePartScore(int plevel, int pId, int px, int py, bool is
     // do distance transform over the region.
     // the region is small enought that brut force DT
     // is the fastest method
+    const vector< double > &convs = isPCA ? pcaConvValues : convValues;
     double max = -numeric_limits<double>::infinity();
     int xargmax = 0;
     int yargmax = 0;
 
-    for (int y = ystart; y <= yend; y++)
+    const int len = xend - xstart + 1;
+    double v[2*halfWindowSize + 1];
+    for (int y = ystart; y <= yend && len > 0; y++)
     {
-        int loc = convBaseOffset + y*featWidth + xstart - 1;
-        for (int x = xstart; x <= xend; x++)
+        const double *conv = &convs[convBaseOffset + y*featWidth + xstart];
+        const double *defX = &defCostCacheX[pId][xstart - px + halfWindowSize];
+        double defY = defCostCacheY[pId][y - py + halfWindowSize];
+        double rowMax = addDeformationCosts(conv, defX, defY, v, len);
+
+        // the first location of the row reaching its maximum, as a serial
+        // scan keeping the strictly greater values does
+        if (rowMax > max)
         {
-            loc++;
-            double v;
-
-            if (isPCA)
-                v = pcaConvValues[loc];
-            else
-                v = convValues[loc];
-
-            v += defCostCacheX[pId][px - x + halfWindowSize]
-                + defCostCacheY[pId][py - y + halfWindowSize];
-
-            if (v > max)
-            {
-                max = v;
-                xargmax = x;
-                yargmax = y;
-            } // if v
-        } // for x
+            int x = 0;
+            while (v[x] != rowMax)
+                x++;
+            max = rowMax;
+            xargmax = xstart + x;
+            yargmax = y;
+        }
     } // for y
 
     // record max and argmax for DT
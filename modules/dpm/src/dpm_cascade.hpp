@@ -106,9 +106,18 @@ class DPMCascade
         // load cascade mode and initialize cascade
         void loadCascadeModel(const std::string &modelPath);
 
+        // parameters of the feature pyramid of the model
+        PyramidParameter getPyramidParameters() const;
+
         // compute feature pyramid and projected feature pyramid
         void computeFeatures(const Mat &im);
 
+        // use a feature pyramid computed with the same cell size and
+        // interval and a padding at least as large as the one of the model,
+        // and compute the projected feature pyramid
+        void setFeatures(const std::vector< Mat > &sharedPyramid,
+                const PyramidParameter &sharedParams);
+
         // compute root PCA scores
         void computeRootPCAScores(std::vector< std::vector< Mat > > &rootScores);
 
@@ -126,18 +135,26 @@ class DPMCascade
 
         // detect object from image
         std::vector< std::vector<double> > detect(Mat &image);
+
+        // detect object from a feature pyramid shared with other models
+        std::vector< std::vector<double> > detect(const std::vector< Mat > &sharedPyramid,
+                const PyramidParameter &sharedParams);
+
+    private:
+        // cascade process and non-maximum suppression of the features
+        std::vector< std::vector<double> > detectFeatures();
 };
 
 /** @brief This class convolves root PCA feature pyramid
  * and root PCA filters in parallel using Intel Threading
- * Building Blocks (TBB)
+ * Building Blocks (TBB), one task per component and level
  */
 class ParalComputeRootPCAScores : public ParallelLoopBody
 {
     public:
         // constructor
-        ParalComputeRootPCAScores(const std::vector< Mat > &pcaPyramid, const Mat &filter,\
-                int dim, std::vector< Mat > &scores);
+        ParalComputeRootPCAScores(const std::vector< Mat > &pcaPyramid, const std::vector< Mat > &filters,\
+                int dim, int firstLevel, std::vector< std::vector< Mat > > &scores);
 
         // parallel loop body
         void operator() (const Range &range) const CV_OVERRIDE;
@@ -146,9 +163,10 @@ class ParalComputeRootPCAScores : public ParallelLoopBody
 
     private:
         const std::vector< Mat > &pcaPyramid;
-        const Mat &filter;
+        const std::vector< Mat > &filters;
         int pcaDim;
-        std::vector< Mat > &scores;
+        int startLevel;
+        std::vector< std::vector< Mat > > &scores;
 };
 } // namespace dpm
 } // namespace cv
@@ -151,11 +151,47 @@ void DPMDetectorImpl::detect( Mat &image,
 {
     objectDetections.clear();
 
+    if (image.channels() == 1)
+        cvtColor(image, image, COLOR_GRAY2BGR);
+
+    if (image.depth() != CV_64F)
+        image.convertTo(image, CV_64FC3);
+
+    // the models with the same cell size and interval share one feature
+    // pyramid, computed with the largest padding of these models
+    vector< vector< vector<double> > > classDetections(detectors.size());
+    vector<bool> processed(detectors.size(), false);
     for( size_t classID = 0; classID < detectors.size(); classID++ )
     {
+        if (processed[classID])
+            continue;
+
+        PyramidParameter params = detectors[classID]->getPyramidParameters();
+        vector<size_t> group;
+        for( size_t j = classID; j < detectors.size(); j++ )
+        {
+            PyramidParameter p = detectors[j]->getPyramidParameters();
+            if (processed[j] || p.interval != params.interval || p.binSize != params.binSize)
+                continue;
+            params.padx = max(params.padx, p.padx);
+            params.pady = max(params.pady, p.pady);
+            processed[j] = true;
+            group.push_back(j);
+        }
+
+        Feature feature(params);
+        vector< Mat > pyramid;
+        feature.computeFeaturePyramid(image, pyramid);
+
         // detect objects
-        vector< vector<double> > detections;
-        detections = detectors[classID]->detect(image);
+        for( size_t k = 0; k < group.size(); k++ )
+            classDetections[group[k]] = detectors[group[k]]->detect(pyramid,
+                    feature.getPyramidParameters());
+    }
+
+    for( size_t classID = 0; classID < detectors.size(); classID++ )
+    {
+        const vector< vector<double> > &detections = classDetections[classID];
 
         for (unsigned int i = 0; i < detections.size(); i++)
         {
@@ -40,11 +40,36 @@
 //M*/
 
 #include "dpm_convolution.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+using namespace std;
 
 namespace cv
 {
 namespace dpm
 {
+// dot product of two arrays of doubles
+static inline double dotProduct(const double *a, const double *b, int len)
+{
+    int i = 0;
+    double val = 0;
+#if CV_SIMD128_64F
+    v_float64x2 s0 = v_setzero_f64(), s1 = v_setzero_f64();
+    for (; i <= len - 4; i += 4)
+    {
+        s0 = v_muladd(v_load(a + i), v_load(b + i), s0);
+        s1 = v_muladd(v_load(a + i + 2), v_load(b + i + 2), s1);
+    }
+    double CV_DECL_ALIGNED(16) buf[2];
+    v_store_aligned(buf, s0 + s1);
+    val = buf[0] + buf[1];
+#endif
+    for (; i < len; i++)
+        val += a[i] * b[i];
+
+    return val;
+}
+
 double ConvolutionEngine::convolve(const Mat &feat, const Mat &filter,
         int dimHOG, int x, int y)
 {
@@ -54,10 +79,7 @@ double ConvolutionEngine::convolve(const Mat &feat, const Mat &filter,
         const double *pfeat = (double*)feat.ptr(y + yp) + x * dimHOG;
         const double *pfilter = (double*)filter.ptr(yp);
 
-        for (int xp = 0; xp < filter.cols; xp++)
-        {
-            val += pfeat[xp] * pfilter[xp];
-        }
+        val += dotProduct(pfeat, pfilter, filter.cols);
     }
 
     return val;
@@ -65,27 +87,60 @@ double ConvolutionEngine::convolve(const Mat &feat, const Mat &filter,
 
 void ConvolutionEngine::convolve(const Mat &feat, const Mat &filter,
         int dimHOG, Mat &result)
+{
+    if (filter.rows * (filter.cols / dimHOG) >= fftMinFilterCells)
+        convolveFFT(feat, filter, dimHOG, result);
+    else
+        convolveDirect(feat, filter, dimHOG, result);
+}
+
+void ConvolutionEngine::convolveDirect(const Mat &feat, const Mat &filter,
+        int dimHOG, Mat &result)
 {
     for (int y = 0; y < result.rows; y++)
     {
         double *presult = (double*)result.ptr(y);
         for (int x = 0; x < result.cols; x++)
-        {
-            double val = 0;
-            for (int yp = 0; yp < filter.rows; yp++)
-            {
-                const double *pfeat = (double*)feat.ptr(y + yp) + x * dimHOG;
-                const double *pfilter = (double*)filter.ptr(yp);
-
-                for (int xp = 0; xp < filter.cols; xp++)
-                {
-                    val += pfeat[xp] * pfilter[xp];
-                }
-            } // yp
-
-            presult[x] = val;
-        } // x
+            presult[x] = convolve(feat, filter, dimHOG, x, y);
     } // y
 }
+
+void ConvolutionEngine::convolveFFT(const Mat &feat, const Mat &filter,
+        int dimHOG, Mat &result)
+{
+    CV_Assert(feat.type() == CV_64F && filter.type() == CV_64F);
+    CV_Assert(dimHOG <= CV_CN_MAX);
+
+    // the feature dimensions are interleaved, one plane per dimension
+    vector< Mat > featPlanes, filterPlanes;
+    split(feat.reshape(dimHOG), featPlanes);
+    split(filter.reshape(dimHOG), filterPlanes);
+
+    // the circular correlation equals the linear one on the valid region
+    // as long as the transform is at least the size of the feature map
+    const Size dftSize(getOptimalDFTSize(featPlanes[0].cols),
+            getOptimalDFTSize(featPlanes[0].rows));
+
+    Mat padded, featSpectrum, filterSpectrum, product;
+    Mat sum = Mat::zeros(dftSize, CV_64F);
+    for (int d = 0; d < dimHOG; d++)
+    {
+        copyMakeBorder(featPlanes[d], padded, 0, dftSize.height - featPlanes[d].rows,
+                0, dftSize.width - featPlanes[d].cols, BORDER_CONSTANT, Scalar::all(0));
+        dft(padded, featSpectrum, 0, featPlanes[d].rows);
+
+        copyMakeBorder(filterPlanes[d], padded, 0, dftSize.height - filterPlanes[d].rows,
+                0, dftSize.width - filterPlanes[d].cols, BORDER_CONSTANT, Scalar::all(0));
+        dft(padded, filterSpectrum, 0, filterPlanes[d].rows);
+
+        // the spectra are accumulated so that a single inverse transform is needed
+        mulSpectrums(featSpectrum, filterSpectrum, product, 0, true);
+        sum += product;
+    }
+
+    Mat correlation;
+    dft(sum, correlation, DFT_INVERSE | DFT_SCALE | DFT_REAL_OUTPUT, result.rows);
+    correlation(Rect(0, 0, result.cols, result.rows)).copyTo(result);
+}
 } // namespace cv
 } // namespace dpm
@@ -66,8 +66,22 @@ class ConvolutionEngine
 
         // compute convolution of a feature map and multiple filters
         // sum the filter convolution values into results
+        // large filters are convolved in the frequency domain
         void convolve(const Mat &feat, const Mat &filter,
                 int dimHOG, Mat &result);
+
+        // compute convolution of a feature map and a filter directly
+        void convolveDirect(const Mat &feat, const Mat &filter,
+                int dimHOG, Mat &result);
+
+        // compute convolution of a feature map and a filter with the
+        // discrete Fourier transform of each feature dimension
+        void convolveFFT(const Mat &feat, const Mat &filter,
+                int dimHOG, Mat &result);
+
+        // minimum number of cells of a filter to be convolved with the
+        // DFT, the same criterion filter2D uses for double kernels
+        static const int fftMinFilterCells = 50;
 };
 } // namespace dpm
 } // namespace cv
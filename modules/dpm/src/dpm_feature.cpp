@@ -58,15 +58,36 @@ Feature::Feature (PyramidParameter p):params(p)
 
 void Feature::computeFeaturePyramid(const Mat &imageM, vector< Mat > &pyramid)
 {
-    ParalComputePyramid paralTask(imageM, pyramid, params);
+    vector< Mat > images;
+    ParalComputePyramid paralTask(imageM, pyramid, images, params);
     paralTask.initialize();
+    // the scaled images of an octave are obtained from the previous one,
+    // so each task computes the images of a chain of octaves
     parallel_for_(Range(0, params.interval), paralTask);
+
+    // the features of all the levels are independent from each other
+    const PyramidParameter &p = params;
+    parallel_for_(Range(0, (int)pyramid.size()), [&](const Range &range)
+    {
+        for (int i = range.start; i != range.end; i++)
+        {
+            if (images[i].empty())
+            {
+                pyramid[i].release();
+                continue;
+            }
+            // First octave at twice the image resolution
+            const int sbin = i < p.interval ? p.binSize/2 : p.binSize;
+            Feature::computeHOG32D(images[i], pyramid[i], sbin, p.padx + 1, p.pady + 1);
+        }
+    });
 }
 
 ParalComputePyramid::ParalComputePyramid(const Mat &inputImage, \
         vector< Mat > &outputPyramid,\
+        vector< Mat > &levelImages,\
         PyramidParameter &p):
-    imageM(inputImage), pyramid(outputPyramid), params(p)
+    imageM(inputImage), pyramid(outputPyramid), images(levelImages), params(p)
 {
 }
 
@@ -86,6 +107,7 @@ void ParalComputePyramid::initialize()
     }
 
     pyramid.resize(params.maxScale + params.interval);
+    images.assign(params.maxScale + params.interval, Mat());
     params.scales.resize(params.maxScale + params.interval);
 }
 
@@ -100,13 +122,11 @@ void ParalComputePyramid::operator() (const Range &range) const
         params.scales[i] = 2*scale;
 
         // First octave at twice the image resolution
-        Feature::computeHOG32D(imScaled, pyramid[i],
-                params.binSize/2, params.padx + 1, params.pady + 1);
+        images[i] = imScaled;
 
         // Second octave at the original resolution
         if (i + params.interval <= params.maxScale)
-            Feature::computeHOG32D(imScaled, pyramid[i+params.interval],
-                    params.binSize, params.padx + 1, params.pady + 1);
+            images[i+params.interval] = imScaled;
 
         params.scales[i+params.interval] = scale;
 
@@ -117,8 +137,7 @@ void ParalComputePyramid::operator() (const Range &range) const
             Size_<double> imScaledSize = imScaled.size();
             resize(imScaled, imScaled2, imScaledSize*0.5);
             imScaled = imScaled2;
-            Feature::computeHOG32D(imScaled2, pyramid[j+params.interval],
-                    params.binSize, params.padx + 1, params.pady + 1);
+            images[j+params.interval] = imScaled2;
             params.scales[j+params.interval] = params.scales[j]*0.5;
         }
     }
@@ -344,45 +363,44 @@ void Feature::projectFeaturePyramid(const Mat &pcaCoeff, const std::vector< Mat
 
     projPyramid.resize(pyramid.size());
 
+    // each PCA eigenvector is stored in a row
+    Mat coeffT;
+    transpose(pcaCoeff, coeffT);
+    coeffT.convertTo(coeffT, CV_64F);
+
     // loop for each level of the pyramid
-    for (unsigned int i = 0; i < pyramid.size(); i++)
+    parallel_for_(Range(0, (int)pyramid.size()), [&](const Range &range)
     {
-        Mat orgM = pyramid[i];
-        // note that the features are stored in 32-32-32
-        int width = orgM.cols/dimHOG;
-        int height = orgM.rows;
-        // initialize the project feature matrix
-        Mat projM = Mat::zeros(height, width*dimPCA, CV_64F);
-        //get the pointer of the matrix
-        double* const featOrg = orgM.ptr<double>(0);
-        double* const featProj = projM.ptr<double>(0);
-
-        // get the stride of each matrix
-        const size_t orgStride = orgM.step1();
-        const size_t projStride = projM.step1();
-
-        for (int y = 0; y < height; y++)
+        for (int i = range.start; i != range.end; i++)
         {
-            for (int x = 0; x < width; x++)
+            const Mat &orgM = pyramid[i];
+            // note that the features are stored in 32-32-32
+            int width = orgM.cols/dimHOG;
+            int height = orgM.rows;
+            // initialize the project feature matrix
+            Mat projM = Mat::zeros(height, width*dimPCA, CV_64F);
+
+            for (int y = 0; y < height; y++)
             {
-                double* proj = featProj + y*projStride + x*dimPCA;
-                // for each pca dimension
-                for (int c = 0; c < dimPCA; c++)
+                const double* featOrg = orgM.ptr<double>(y);
+                double* proj = projM.ptr<double>(y);
+                for (int x = 0; x < width; x++)
                 {
-                    double* org = featOrg + y*orgStride + x*dimHOG;
-                    // dot product 32d HOG feature with the coefficient vector
-                    for (int r = 0; r < dimHOG; r++)
+                    // for each pca dimension
+                    for (int c = 0; c < dimPCA; c++)
                     {
-                        *proj += *org * pcaCoeff.at<double>(r, c);
-                        org++;
+                        const double* org = featOrg + x*dimHOG;
+                        const double* coeff = coeffT.ptr<double>(c);
+                        // dot product 32d HOG feature with the coefficient vector
+                        for (int r = 0; r < dimHOG; r++)
+                            *proj += org[r] * coeff[r];
+                        proj++;
                     }
-                    proj++;
-                }
-
-            } // for x
-        } // for y
-        projPyramid[i] = projM;
-    } // for each level of the pyramid
+                } // for x
+            } // for y
+            projPyramid[i] = projM;
+        }
+    }); // for each level of the pyramid
 }
 
 void Feature::computeLocationFeatures(const int numLevels, Mat &locFeature)
@@ -104,7 +104,7 @@ class Feature
         }
 
         // returns pyramid parameters
-        PyramidParameter getPyramidParameters()
+        const PyramidParameter &getPyramidParameters() const
         {
             return params;
         }
@@ -137,8 +137,8 @@ class Feature
 
 };
 
-/** @brief This class computes feature pyramid in parallel
- * using Intel Threading Building Blocks (TBB)
+/** @brief This class computes the scaled images of the feature pyramid
+ * in parallel using Intel Threading Building Blocks (TBB)
  */
 class ParalComputePyramid : public ParallelLoopBody
 {
@@ -146,6 +146,7 @@ class ParalComputePyramid : public ParallelLoopBody
         // constructor
         ParalComputePyramid(const Mat &inputImage, \
                 std::vector< Mat > &outputPyramid,\
+                std::vector< Mat > &levelImages,\
                 PyramidParameter &p);
 
         // initializate parameters
@@ -161,6 +162,8 @@ class ParalComputePyramid : public ParallelLoopBody
         Size_<double> imSize;
         // output feature pyramid
         std::vector< Mat > &pyramid;
+        // scaled image of each level of the pyramid
+        std::vector< Mat > &images;
         // pyramid parameters
         PyramidParameter &params;
 };
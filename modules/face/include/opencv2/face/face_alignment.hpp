@@ -54,6 +54,14 @@ public:
     virtual bool setFaceDetector(bool(*f)(InputArray , OutputArray, void*), void* userData)=0;
     /// get faces using the custom detector
     virtual bool getFaces(InputArray image, OutputArray faces)=0;
+
+    /** @brief Saves the loaded or trained model in a compact binary layout.
+    *
+    * loadModel() memory maps such files and uses the regression trees in place instead of parsing them,
+    * which makes the loading of large models almost free. The file is written in the native byte order.
+    *@param filename A variable of type cv::String which stores the name of the file to write.
+    */
+    virtual void saveCompactModel(const String& filename)=0;
 };
 
 }} // namespace
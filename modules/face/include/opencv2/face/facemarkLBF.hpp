@@ -110,6 +110,14 @@ public:
 
     static Ptr<FacemarkLBF> create(const FacemarkLBF::Params &parameters = FacemarkLBF::Params() );
     virtual ~FacemarkLBF(){};
+
+    /** @brief Saves the loaded or trained model in a compact binary layout.
+
+    loadModel() memory maps such files and uses the forests and the regression weights in place
+    instead of parsing the FileStorage model. The file is written in the native byte order.
+    @param filename name of the file to write
+    */
+    virtual void saveCompactModel(const String& filename) = 0;
 }; /* LBF */
 
 //! @}
@@ -34,6 +34,19 @@ public:
     CV_WRAP cv::Mat getEigenVectors() const;
     CV_WRAP cv::Mat getMean() const;
 
+    /** @brief Predicts the labels of several images at once.
+
+    All the queries are projected with one matrix product and compared with the projections of the
+    training data with matrix products as well, which is much faster than calling predict() per image.
+    The results are those of predict(InputArray, int&, double&) up to rounding errors of the distances.
+
+    @param src The query images, each of them with as many elements as the training images.
+    @param labels The predicted label per image, -1 if no projection is closer than the threshold.
+    @param distances The distance to the nearest projection per image, DBL_MAX if no projection is
+    closer than the threshold.
+     */
+    CV_WRAP void predictBatch(InputArrayOfArrays src, CV_OUT std::vector<int>& labels, CV_OUT std::vector<double>& distances) const;
+
     virtual void read(const FileNode& fn) CV_OVERRIDE;
     virtual void write(FileStorage& fs) const CV_OVERRIDE;
     virtual bool empty() const CV_OVERRIDE;
@@ -169,6 +182,8 @@ public:
     -   The Circular Local Binary Patterns (used in training and prediction) expect the data given as
         grayscale images, use cvtColor to convert between the color spaces.
     -   This model supports updating.
+    -   The prediction scans a half precision copy of the histograms in parallel, so the distances
+        can differ from compareHist with HISTCMP_CHISQR_ALT on getHistograms() by the float16 rounding.
 
     ### Model internal data:
 
@@ -0,0 +1,79 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+enum { RECOGNIZER_EIGEN, RECOGNIZER_FISHER, RECOGNIZER_LBPH };
+CV_ENUM(RecognizerType, RECOGNIZER_EIGEN, RECOGNIZER_FISHER, RECOGNIZER_LBPH)
+
+static Ptr<face::FaceRecognizer> createRecognizer(int type)
+{
+    switch (type)
+    {
+    case RECOGNIZER_EIGEN: return face::EigenFaceRecognizer::create();
+    case RECOGNIZER_FISHER: return face::FisherFaceRecognizer::create();
+    default: return face::LBPHFaceRecognizer::create();
+    }
+}
+
+// numSubjects subjects with 5 noisy views of a random face of the AT&T database size each
+static void makeFaces(int numSubjects, std::vector<Mat>& images, std::vector<int>& labels)
+{
+    const Size sz(92, 112);
+    RNG rng(0);
+    images.clear();
+    labels.clear();
+    for (int s = 0; s < numSubjects; ++s)
+    {
+        Mat base(sz, CV_8UC1);
+        rng.fill(base, RNG::UNIFORM, 0, 256);
+        GaussianBlur(base, base, Size(9, 9), 3);
+        for (int v = 0; v < 5; ++v)
+        {
+            Mat noise(sz, CV_8UC1), view;
+            rng.fill(noise, RNG::NORMAL, 0, 10);
+            add(base, noise, view);
+            images.push_back(view);
+            labels.push_back(s);
+        }
+    }
+}
+
+typedef tuple<int, RecognizerType> FaceRecognizerParams_t;
+typedef perf::TestBaseWithParam<FaceRecognizerParams_t> FaceRecognizer;
+
+PERF_TEST_P(FaceRecognizer, train, Combine(Values(10, 40), RecognizerType::all()))
+{
+    std::vector<Mat> images;
+    std::vector<int> labels;
+    makeFaces(get<0>(GetParam()), images, labels);
+    Ptr<face::FaceRecognizer> model = createRecognizer(get<1>(GetParam()));
+
+    TEST_CYCLE() model->train(images, labels);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(FaceRecognizer, predict, Combine(Values(10, 40, 100), RecognizerType::all()))
+{
+    std::vector<Mat> images;
+    std::vector<int> labels;
+    makeFaces(get<0>(GetParam()), images, labels);
+    Ptr<face::FaceRecognizer> model = createRecognizer(get<1>(GetParam()));
+    model->train(images, labels);
+
+    size_t idx = 0;
+    int label = -1;
+    double confidence = 0;
+    TEST_CYCLE()
+    {
+        model->predict(images[idx], label, confidence);
+        idx = (idx + 7) % images.size();
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
@@ -31,6 +31,11 @@ bool FacemarkKazemiImpl::getFaces(InputArray image, OutputArray faces)
     return faceDetector(image, faces, faceDetectorData);
 }
 FacemarkKazemiImpl::FacemarkKazemiImpl(const FacemarkKazemi::Params& parameters) :
+    flat_cascade_size(0),
+    flat_num_trees(0),
+    flat_trees(NULL),
+    flat_nodes(NULL),
+    flat_leaves(NULL),
     faceDetector(NULL),
     faceDetectorData(NULL)
 {
@@ -5,6 +5,7 @@
 #ifndef __OPENCV_FACE_ALIGNMENTIMPL_HPP__
 #define __OPENCV_FACE_ALIGNMENTIMPL_HPP__
 #include "opencv2/face.hpp"
+#include "model_file.hpp"
 #include <string>
 #include <sstream>
 #include <vector>
@@ -45,6 +46,43 @@ struct tree_node{
 struct regtree{
     std::vector<tree_node> nodes;
 };
+/** @brief node of the regression trees in the compact model layout.
+* The children of node k of a tree are the nodes 2k+1 and 2k+2 of the same tree.
+*/
+struct flat_node{
+    uint32_t index1;
+    uint32_t index2;
+    float thresh;
+    //! leaf index among the leaves of the model, -1 for split nodes
+    int32_t leaf;
+};
+static const char KAZEMI_MODEL_MAGIC[] = "KZMFLAT\x01";
+static const uint32_t KAZEMI_MODEL_VERSION = 1;
+/** @brief header of the compact model file.
+* The arrays follow at 8 byte aligned offsets from the beginning of the file, all of them
+* in the native byte order, so that a mapped file is used in place.
+*/
+struct kazemi_model_header{
+    char magic[8];
+    uint32_t version;
+    uint32_t cascade_size;
+    uint32_t num_trees;
+    uint32_t num_pixels;
+    uint32_t num_landmarks;
+    uint32_t reserved;
+    uint64_t num_nodes;
+    uint64_t num_leaves;
+    //! cascade_size x num_pixels Point2f
+    uint64_t pixels_offset;
+    //! num_landmarks Point2f
+    uint64_t meanshape_offset;
+    //! cascade_size*num_trees+1 uint64_t, index of the first node of every tree
+    uint64_t trees_offset;
+    //! num_nodes flat_node
+    uint64_t nodes_offset;
+    //! num_leaves x num_landmarks Point2f
+    uint64_t leaves_offset;
+};
 /** @brief Represents a training sample
 *It contains current shape, difference between actual shape
 *and current shape. It also stores the image whose shape is being
@@ -74,6 +112,7 @@ public:
     bool setFaceDetector(FN_FaceDetector f, void* userdata) CV_OVERRIDE;
     bool getFaces(InputArray image, OutputArray faces) CV_OVERRIDE;
     bool fit(InputArray image, InputArray faces, OutputArrayOfArrays landmarks ) CV_OVERRIDE;
+    void saveCompactModel(const String& filename) CV_OVERRIDE;
     void training(String imageList, String groundTruth);
     bool training(vector<Mat>& images, vector< vector<Point2f> >& landmarks,string filename,Size scale,string modelFilename) CV_OVERRIDE;
     // Destructor for the class.
@@ -93,6 +132,13 @@ protected:
     std::vector<Point2f> meanshape;
     std::vector< std::vector<regtree> > loaded_forests;
     std::vector< std::vector<Point2f> > loaded_pixel_coordinates;
+    /* compact model used by fit(), either a mapped file or built from loaded_forests */
+    Ptr<MappedFile> model_data;
+    unsigned long flat_cascade_size;
+    unsigned long flat_num_trees;
+    const uint64_t* flat_trees;
+    const flat_node* flat_nodes;
+    const Point2f* flat_leaves;
     FN_FaceDetector faceDetector;
     void* faceDetectorData;
     bool findNearestLandmarks(std::vector< std::vector<int> >& nearest);
@@ -112,6 +158,10 @@ protected:
     void writePixels(std::ofstream& f,int index);
     // This function saves model to the binary file
     bool saveModel(String filename);
+    // This function stores loaded_forests, loaded_pixel_coordinates and meanshape in the compact layout
+    void flattenForests(std::vector<uchar>& blob);
+    // This function validates a compact model and uses it for fitting
+    void setCompactModel(const Ptr<MappedFile>& data);
     // This funcrion reads pixel coordinates from the model file
     void readPixels(std::ifstream& is,uint64_t index);
     //This function reads the split node of the tree from binary file
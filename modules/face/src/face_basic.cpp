@@ -98,3 +98,117 @@ bool BasicFaceRecognizer::empty() const
 {
     return (_labels.empty());
 }
+
+namespace {
+
+// nearest projection of blocks of projected queries, the squared distances are expanded as
+// |q|^2 + |p|^2 - 2 q.p so that each block of queries and samples is one matrix product
+class NearestProjectionBody : public ParallelLoopBody
+{
+public:
+    NearestProjectionBody(const Mat& _queries, const Mat& _samples, const Mat& _sampleNorms,
+                          int _queryBlock, int _sampleBlock, std::vector<int>& _nearest, std::vector<double>& _dists)
+        : queries(_queries), samples(_samples), sampleNorms(_sampleNorms),
+          queryBlock(_queryBlock), sampleBlock(_sampleBlock), nearest(_nearest), dists(_dists) {}
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        Mat products;
+        for (int b = range.start; b < range.end; b++)
+        {
+            const int q0 = b * queryBlock, q1 = std::min(queries.rows, q0 + queryBlock);
+            const Mat q = queries.rowRange(q0, q1);
+            for (int i = q0; i < q1; i++)
+            {
+                nearest[i] = -1;
+                dists[i] = DBL_MAX;
+            }
+            for (int s0 = 0; s0 < samples.rows; s0 += sampleBlock)
+            {
+                const int s1 = std::min(samples.rows, s0 + sampleBlock);
+                gemm(q, samples.rowRange(s0, s1), -2, noArray(), 0, products, GEMM_2_T);
+                const double* norms = sampleNorms.ptr<double>() + s0;
+                for (int i = q0; i < q1; i++)
+                {
+                    const double* row = products.ptr<double>(i - q0);
+                    const double queryNorm = queries.row(i).dot(queries.row(i));
+                    // the first sample wins the ties as in the collectors
+                    for (int j = 0; j < s1 - s0; j++)
+                    {
+                        const double dist = queryNorm + norms[j] + row[j];
+                        if (dist < dists[i])
+                        {
+                            dists[i] = dist;
+                            nearest[i] = s0 + j;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    const Mat& queries;
+    const Mat& samples;
+    const Mat& sampleNorms;
+    const int queryBlock, sampleBlock;
+    std::vector<int>& nearest;
+    std::vector<double>& dists;
+
+    NearestProjectionBody& operator=(const NearestProjectionBody&);
+};
+
+}
+
+void BasicFaceRecognizer::predictBatch(InputArrayOfArrays _src, std::vector<int>& labels, std::vector<double>& distances) const
+{
+    if(_projections.empty()) {
+        String error_message = "This model is not computed yet. Did you call the train method?";
+        CV_Error(Error::StsError, error_message);
+    }
+    labels.clear();
+    distances.clear();
+    if(_src.total() == 0)
+        return;
+    // make sure the user is passing correct data
+    Mat queries = asRowMatrix(_src, CV_64FC1);
+    if(_eigenvectors.rows != queries.cols) {
+        String error_message = format("Wrong input image size. Reason: Training and Test images must be of equal size! Expected an image with %d elements, but got %d.", _eigenvectors.rows, queries.cols);
+        CV_Error(Error::StsBadArg, error_message);
+    }
+    // project all the queries into the subspace at once
+    Mat W, mean;
+    _eigenvectors.convertTo(W, CV_64F);
+    _mean.reshape(1, 1).convertTo(mean, CV_64F);
+    for(int i = 0; i < queries.rows; i++)
+        queries.row(i) -= mean;
+    Mat projected;
+    gemm(queries, W, 1, noArray(), 0, projected);
+    // contiguous copy of the projections of the training data
+    Mat samples((int)_projections.size(), projected.cols, CV_64F);
+    Mat sampleNorms((int)_projections.size(), 1, CV_64F);
+    for(size_t sampleIdx = 0; sampleIdx < _projections.size(); sampleIdx++) {
+        CV_Assert(_projections[sampleIdx].total() == (size_t)samples.cols);
+        Mat row = samples.row((int)sampleIdx);
+        _projections[sampleIdx].reshape(1, 1).convertTo(row, CV_64F);
+        sampleNorms.at<double>((int)sampleIdx) = row.dot(row);
+    }
+    // the blocks of the distance matrix stay in the cache
+    const int queryBlock = 64, sampleBlock = 4096;
+    std::vector<int> nearest(projected.rows);
+    std::vector<double> dists(projected.rows);
+    parallel_for_(Range(0, (projected.rows + queryBlock - 1) / queryBlock),
+                  NearestProjectionBody(projected, samples, sampleNorms, queryBlock, sampleBlock, nearest, dists));
+    labels.resize(projected.rows);
+    distances.resize(projected.rows);
+    for(int i = 0; i < projected.rows; i++) {
+        const double dist = std::sqrt(std::max(dists[i], 0.0));
+        if(nearest[i] >= 0 && dist < _threshold) {
+            labels[i] = _labels.at<int>(nearest[i]);
+            distances[i] = dist;
+        } else {
+            labels[i] = -1;
+            distances[i] = DBL_MAX;
+        }
+    }
+}
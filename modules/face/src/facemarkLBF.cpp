@@ -36,7 +36,10 @@ Mentor: Delia Passalacqua
 
 #include "precomp.hpp"
 #include "opencv2/face.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+#include "model_file.hpp"
 #include <fstream>
+#include <cstring>
 #include <cmath>
 #include <ctime>
 #include <cstdio>
@@ -55,6 +58,33 @@ namespace face {
     x = x_tmp; y = y_tmp;                                     \
 } while(0)
 
+/* Compact model layout, the arrays follow the header at 8 byte aligned offsets from the beginning
+*  of the file in the native byte order, so that a mapped file is used in place:
+*  - mean shape, n_landmarks x 2 doubles
+*  - per stage: the split features (nodes x 4 doubles) and the thresholds (nodes ints) of the flattened forest
+*    and the transposed regression weights (F x 2*n_landmarks doubles)
+*/
+static const char LBF_MODEL_MAGIC[] = "LBFFLAT\x01";
+static const uint32_t LBF_MODEL_VERSION = 1;
+
+struct LBFModelHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t stages_n;
+    int32_t tree_n;
+    int32_t tree_depth;
+    int32_t n_landmarks;
+    int32_t reserved;
+    uint64_t meanshape_offset;
+    uint64_t stages_offset; //!< stages_n LBFStageOffsets
+};
+
+struct LBFStageOffsets {
+    uint64_t feats;
+    uint64_t thresholds;
+    uint64_t weights;
+};
+
 FacemarkLBF::Params::Params(){
 
     cascade_face = "";
@@ -106,6 +136,7 @@ public:
     void write( FileStorage& /*fs*/ ) const CV_OVERRIDE;
 
     void loadModel(String fs) CV_OVERRIDE;
+    void saveCompactModel(const String& filename) CV_OVERRIDE;
 
     bool setFaceDetector(bool(*f)(InputArray , OutputArray, void * extra_params ), void* userData) CV_OVERRIDE;
     bool getFaces(InputArray image, OutputArray faces) CV_OVERRIDE;
@@ -117,6 +148,7 @@ protected:
 
     bool fit(InputArray image, InputArray faces, OutputArrayOfArrays landmarks) CV_OVERRIDE;
     bool fitImpl( const Mat image, std::vector<Point2f> & landmarks );//!< from a face
+    void fitFace( const Mat& gray, const Rect& box, std::vector<Point2f> & landmarks );//!< from a face of a gray image
 
     bool addTrainingSample(InputArray image, InputArray landmarks) CV_OVERRIDE;
     void training(void* parameters) CV_OVERRIDE;
@@ -188,6 +220,9 @@ private:
         void train(std::vector<cv::Mat> &imgs, std::vector<cv::Mat> &current_shapes, \
                    std::vector<BBox> &bboxes, std::vector<cv::Mat> &delta_shapes, cv::Mat &mean_shape, int stage);
         Mat generateLBF(Mat &img, Mat &current_shape, BBox &bbox, Mat &mean_shape);
+        void flatten();
+        //! uses the flattened forest of a compact model, the trees are not restored
+        void setFlat(int landmark_n, int trees_n, int tree_depth, const Mat_<double> &feats, const Mat_<int> &thresholds);
 
         void write(FileStorage fs, int forestId);
         void read(FileStorage fs, int forestId);
@@ -197,6 +232,10 @@ private:
         int trees_n, tree_depth;
         double overlap_ratio;
         std::vector<std::vector<RandomTree> > random_trees;
+        // split features and thresholds of all the trees one after the other, landmark by landmark
+        Mat_<double> flat_feats;
+        Mat_<int> flat_thresholds;
+        int nodes_n;
 
         std::vector<int> feats_m;
         std::vector<double> radius_m;
@@ -221,11 +260,14 @@ private:
 
         void write(FileStorage fs, Params config);
         void read(FileStorage fs, Params & config);
+        void writeCompact(std::vector<uchar> &blob);
+        void readCompact(const uchar *data, size_t size, Params & config);
 
         void globalRegressionTrain(
             std::vector<Mat> &lbfs, std::vector<Mat> &delta_shapes,
             int stage, Params config
         );
+        void transposeWeights(int stage);
 
         Mat supportVectorRegression(
             feature_node **x, double *y, int nsamples, int feat_size, bool verbose=0
@@ -236,10 +278,13 @@ private:
         cv::Mat mean_shape;
         std::vector<RandomForest> random_forests;
         std::vector<cv::Mat> gl_regression_weights;
+        // gl_regression_weights with a row per LBF feature, the active features are contiguous rows
+        std::vector<cv::Mat> gl_regression_weights_t;
 
     }; // LBF
 
     Regressor regressor;
+    Ptr<MappedFile> model_data; //!< memory of the compact model used by the regressor
 }; // class
 
 /*
@@ -410,14 +455,25 @@ bool FacemarkLBFImpl::fit(InputArray image, InputArray roi, OutputArrayOfArrays
     std::vector<Rect> faces = roimat.reshape(4, roimat.rows);
     if (faces.empty()) return false;
 
+    if (!isModelTrained) {
+        CV_Error(Error::StsBadArg, "The LBF model is not trained yet. Please provide a trained model.");
+    }
+
+    Mat img = image.getMat();
+    if(img.channels()>1){
+        cvtColor(img,img,COLOR_BGR2GRAY);
+    }
+
     std::vector<std::vector<Point2f> > landmarks;
 
     landmarks.resize(faces.size());
 
-    for(unsigned i=0; i<faces.size();i++){
-        params.detectROI = faces[i];
-        fitImpl(image.getMat(), landmarks[i]);
-    }
+    // the faces are independent, the model is only read
+    parallel_for_(Range(0, (int)faces.size()), [&](const Range& range) {
+        for(int i=range.start; i<range.end;i++){
+            fitFace(img, faces[i], landmarks[i]);
+        }
+    });
     _copyVector2Output(landmarks, _landmarks);
     return true;
 }
@@ -448,6 +504,13 @@ bool FacemarkLBFImpl::fitImpl( const Mat image, std::vector<Point2f>& landmarks)
         box = rects[0];
     }
 
+    fitFace(img, box, landmarks);
+    params.detectROI.width = -1;
+
+    return 1;
+}
+
+void FacemarkLBFImpl::fitFace( const Mat& img, const Rect& box, std::vector<Point2f>& landmarks){
     double min_x, min_y, max_x, max_y;
     min_x = std::max(0., (double)box.x - box.width / 2);
     max_x = std::min(img.cols - 1., (double)box.x+box.width + box.width / 2);
@@ -461,14 +524,7 @@ bool FacemarkLBFImpl::fitImpl( const Mat image, std::vector<Point2f>& landmarks)
     Mat crop = img(Rect((int)min_x, (int)min_y, (int)w, (int)h)).clone();
     Mat shape = regressor.predict(crop, bbox);
 
-    if(params.detectROI.width>0){
-        landmarks = Mat(shape.reshape(2)+Scalar(min_x, min_y));
-        params.detectROI.width = -1;
-    }else{
-        landmarks = Mat(shape.reshape(2)+Scalar(min_x, min_y));
-    }
-
-    return 1;
+    landmarks = Mat(shape.reshape(2)+Scalar(min_x, min_y));
 }
 
 void FacemarkLBFImpl::read( const cv::FileNode& fn ){
@@ -487,12 +543,30 @@ void FacemarkLBFImpl::loadModel(String s){
         CV_Error(Error::StsBadArg, "No valid input file was given, please check the given filename.");
     }
 
-    FileStorage fs(s.c_str(),FileStorage::READ);
-    regressor.read(fs, params);
+    Ptr<MappedFile> data = makePtr<MappedFile>();
+    if (data->open(s) && data->hasMagic(LBF_MODEL_MAGIC)) {
+        regressor.readCompact(data->data(), data->size(), params);
+        model_data = data;
+    }
+    else {
+        data.release();
+        FileStorage fs(s.c_str(),FileStorage::READ);
+        regressor.read(fs, params);
+        model_data.release();
+    }
 
     isModelTrained = true;
 }
 
+void FacemarkLBFImpl::saveCompactModel(const String& filename){
+    if (!isModelTrained) {
+        CV_Error(Error::StsBadArg, "The LBF model is not trained yet. Please provide a trained model.");
+    }
+    std::vector<uchar> blob;
+    regressor.writeCompact(blob);
+    writeModelFile(filename, &blob[0], blob.size());
+}
+
 Rect FacemarkLBFImpl::getBBox(Mat &img, const Mat_<double> shape) {
     std::vector<Rect> rects;
 
@@ -994,6 +1068,37 @@ void FacemarkLBFImpl::RandomForest::train(std::vector<Mat> &imgs, std::vector<Ma
         if(verbose) printf("Train %2dth of %d landmark Done, it costs %.4lf s\n", i+1, landmark_n, TIMER_NOW);
     TIMER_END
     }
+    flatten();
+}
+
+void FacemarkLBFImpl::RandomForest::flatten() {
+    nodes_n = 1 << tree_depth;
+    // the previous arrays may be read only memory of a compact model
+    flat_feats.release();
+    flat_thresholds.release();
+    flat_feats.create(landmark_n*trees_n*nodes_n, 4);
+    flat_thresholds.create(landmark_n*trees_n*nodes_n, 1);
+    for (int i = 0; i < landmark_n; i++) {
+        for (int j = 0; j < trees_n; j++) {
+            const RandomTree &tree = random_trees[i][j];
+            CV_Assert(tree.feats.rows == nodes_n && (int)tree.thresholds.size() == nodes_n);
+            const int offset = (i*trees_n + j)*nodes_n;
+            tree.feats.copyTo(flat_feats.rowRange(offset, offset + nodes_n));
+            std::copy(tree.thresholds.begin(), tree.thresholds.end(), flat_thresholds.ptr<int>(offset));
+        }
+    }
+}
+
+void FacemarkLBFImpl::RandomForest::setFlat(int _landmark_n, int _trees_n, int _tree_depth,
+                                            const Mat_<double> &feats, const Mat_<int> &thresholds) {
+    landmark_n = _landmark_n;
+    trees_n = _trees_n;
+    tree_depth = _tree_depth;
+    nodes_n = 1 << tree_depth;
+    CV_Assert(feats.rows == landmark_n*trees_n*nodes_n && feats.cols == 4 && thresholds.rows == feats.rows);
+    random_trees.clear();
+    flat_feats = feats;
+    flat_thresholds = thresholds;
 }
 
 Mat FacemarkLBFImpl::RandomForest::generateLBF(Mat &img, Mat &current_shape, BBox &bbox, Mat &mean_shape) {
@@ -1003,32 +1108,40 @@ Mat FacemarkLBFImpl::RandomForest::generateLBF(Mat &img, Mat &current_shape, BBo
     calcSimilarityTransform(bbox.project(current_shape), mean_shape, scale, rotate);
 
     int base = 1 << (tree_depth - 1);
+    const double r00 = rotate(0, 0), r01 = rotate(0, 1);
+    const double r10 = rotate(1, 0), r11 = rotate(1, 1);
+    const double max_x = img.cols - 1., max_y = img.rows - 1.;
+    const size_t img_step = img.step;
+    const uchar *img_data = img.ptr<uchar>();
 
-    #ifdef _OPENMP
-    #pragma omp parallel for
-    #endif
+    // the callers run in parallel over the faces or the samples
     for (int i = 0; i < landmark_n; i++) {
+        const double cx = current_shape.at<double>(i, 0), cy = current_shape.at<double>(i, 1);
         for (int j = 0; j < trees_n; j++) {
-            RandomTree &tree = random_trees[i][j];
+            const int tree_offset = (i*trees_n + j)*nodes_n;
+            const double *feats = flat_feats.ptr<double>(tree_offset);
+            const int *thresholds = flat_thresholds.ptr<int>(tree_offset);
             int code = 0;
             int idx = 1;
-            for (int k = 1; k < tree.depth; k++) {
-                double x1 = tree.feats(idx, 0);
-                double y1 = tree.feats(idx, 1);
-                double x2 = tree.feats(idx, 2);
-                double y2 = tree.feats(idx, 3);
-                SIMILARITY_TRANSFORM(x1, y1, scale, rotate);
-                SIMILARITY_TRANSFORM(x2, y2, scale, rotate);
-
-                x1 = x1*bbox.x_scale + current_shape.at<double>(i, 0);
-                y1 = y1*bbox.y_scale + current_shape.at<double>(i, 1);
-                x2 = x2*bbox.x_scale + current_shape.at<double>(i, 0);
-                y2 = y2*bbox.y_scale + current_shape.at<double>(i, 1);
-                x1 = max(0., min(img.cols - 1., x1)); y1 = max(0., min(img.rows - 1., y1));
-                x2 = max(0., min(img.cols - 1., x2)); y2 = max(0., min(img.rows - 1., y2));
-                int density = img.at<uchar>(int(y1), int(x1)) - img.at<uchar>(int(y2), int(x2));
+            for (int k = 1; k < tree_depth; k++) {
+                const double *feat = feats + 4*idx;
+                double x1 = feat[0];
+                double y1 = feat[1];
+                double x2 = feat[2];
+                double y2 = feat[3];
+                // SIMILARITY_TRANSFORM
+                double tx1 = scale * (r00*x1 + r01*y1), ty1 = scale * (r10*x1 + r11*y1);
+                double tx2 = scale * (r00*x2 + r01*y2), ty2 = scale * (r10*x2 + r11*y2);
+
+                x1 = tx1*bbox.x_scale + cx;
+                y1 = ty1*bbox.y_scale + cy;
+                x2 = tx2*bbox.x_scale + cx;
+                y2 = ty2*bbox.y_scale + cy;
+                x1 = max(0., min(max_x, x1)); y1 = max(0., min(max_y, y1));
+                x2 = max(0., min(max_x, x2)); y2 = max(0., min(max_y, y2));
+                int density = img_data[int(y1)*img_step + int(x1)] - img_data[int(y2)*img_step + int(x2)];
                 code <<= 1;
-                if (density < tree.thresholds[idx]) {
+                if (density < thresholds[idx]) {
                     idx = 2 * idx;
                 }
                 else {
@@ -1058,6 +1171,7 @@ void FacemarkLBFImpl::RandomForest::read(FileStorage fs,int k)
             random_trees[i][j].read(fs,k,i,j);
         }
     }
+    flatten();
 }
 
 /*---------------Regressor Implementation---------------------*/
@@ -1080,6 +1194,9 @@ void FacemarkLBFImpl::Regressor::initRegressor(Params config) {
     mean_shape.create(config.n_landmarks, 2, CV_64FC1);
 
     gl_regression_weights.resize(stages_n);
+    // the previous weights may be read only memory of a compact model
+    gl_regression_weights_t.clear();
+    gl_regression_weights_t.resize(stages_n);
     int F = config.n_landmarks * config.tree_n * (1 << (config.tree_depth - 1));
 
     for (int i = 0; i < stages_n; i++) {
@@ -1106,9 +1223,11 @@ void FacemarkLBFImpl::Regressor::trainRegressor(std::vector<Mat> &imgs, std::vec
         // generate lbf of every train data
         std::vector<Mat> lbfs;
         lbfs.resize(N);
-        for (int i = 0; i < N; i++) {
-            lbfs[i] = random_forests[k].generateLBF(imgs[i], current_shapes[i], bboxes[i], mean_shape);
-        }
+        parallel_for_(Range(0, N), [&](const Range& range) {
+            for (int i = range.start; i < range.end; i++) {
+                lbfs[i] = random_forests[k].generateLBF(imgs[i], current_shapes[i], bboxes[i], mean_shape);
+            }
+        });
 
         // global regression
         if(config.verbose) printf("start train global regression of %dth stage\n", k);
@@ -1175,6 +1294,7 @@ void FacemarkLBFImpl::Regressor::globalRegressionTrain(
     }
 
     gl_regression_weights[stage] = weights;
+    transposeWeights(stage);
 
     // free
     for (int i = 0; i < N; i++) free(X[i]);
@@ -1363,23 +1483,29 @@ Mat FacemarkLBFImpl::Regressor::supportVectorRegression(
 
 }//end
 
+void FacemarkLBFImpl::Regressor::transposeWeights(int stage) {
+    Mat weight;
+    gl_regression_weights[stage].convertTo(weight, CV_64F);
+    transpose(weight, gl_regression_weights_t[stage]);
+}
+
+// the LBF feature is binary with one active leaf per tree, the regression sums the weights of the active leaves
 Mat FacemarkLBFImpl::Regressor::globalRegressionPredict(const Mat &lbf, int stage) {
-    const Mat_<double> &weight = (Mat_<double>)gl_regression_weights[stage];
-    Mat_<double> delta_shape(weight.rows / 2, 2);
-    const double *w_ptr = NULL;
+    const Mat &weight_t = gl_regression_weights_t[stage];
+    const int outputs = weight_t.cols;
+    Mat_<double> delta_shape(outputs / 2, 2, 0.);
+    double *y = delta_shape.ptr<double>();
     const int *lbf_ptr = lbf.ptr<int>(0);
 
-    //#pragma omp parallel for num_threads(2) private(w_ptr)
-    for (int i = 0; i < delta_shape.rows; i++) {
-        w_ptr = weight.ptr<double>(2 * i);
-        double y = 0;
-        for (int j = 0; j < lbf.cols; j++) y += w_ptr[lbf_ptr[j]];
-        delta_shape(i, 0) = y;
-
-        w_ptr = weight.ptr<double>(2 * i + 1);
-        y = 0;
-        for (int j = 0; j < lbf.cols; j++) y += w_ptr[lbf_ptr[j]];
-        delta_shape(i, 1) = y;
+    for (int j = 0; j < lbf.cols; j++) {
+        const double *w_ptr = weight_t.ptr<double>(lbf_ptr[j]);
+        int i = 0;
+#if CV_SIMD128_64F
+        for (; i <= outputs - v_float64x2::nlanes; i += v_float64x2::nlanes)
+            v_store(y + i, v_load(y + i) + v_load(w_ptr + i));
+#endif
+        for (; i < outputs; i++)
+            y[i] += w_ptr[i];
     }
     return std::move(delta_shape);
 } // Regressor::globalRegressionPredict
@@ -1449,6 +1575,105 @@ void FacemarkLBFImpl::Regressor::read(FileStorage fs, Params & config){
 
         x = cv::format("weights_%i",k);
         fs[x] >> gl_regression_weights[k];
+        transposeWeights(k);
+    }
+}
+
+void FacemarkLBFImpl::Regressor::writeCompact(std::vector<uchar> &blob) {
+    CV_Assert(stages_n > 0 && (int)random_forests.size() == stages_n && (int)gl_regression_weights_t.size() == stages_n);
+    const RandomForest &forest0 = random_forests[0];
+
+    LBFModelHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LBF_MODEL_MAGIC, sizeof(header.magic));
+    header.version = LBF_MODEL_VERSION;
+    header.stages_n = stages_n;
+    header.tree_n = forest0.trees_n;
+    header.tree_depth = forest0.tree_depth;
+    header.n_landmarks = landmark_n;
+
+    Mat mean;
+    mean_shape.convertTo(mean, CV_64F);
+    CV_Assert(mean.isContinuous() && mean.rows == landmark_n && mean.cols == 2);
+
+    blob.clear();
+    appendAligned(blob, &header, sizeof(header));
+    header.meanshape_offset = appendAligned(blob, mean.ptr(), mean.total()*mean.elemSize());
+    std::vector<LBFStageOffsets> stages(stages_n);
+    header.stages_offset = appendAligned(blob, &stages[0], stages.size()*sizeof(stages[0]));
+    const int F = landmark_n * forest0.trees_n * (1 << (forest0.tree_depth - 1));
+    for (int k = 0; k < stages_n; k++) {
+        const RandomForest &forest = random_forests[k];
+        const Mat &weight_t = gl_regression_weights_t[k];
+        CV_Assert(forest.trees_n == header.tree_n && forest.tree_depth == header.tree_depth);
+        CV_Assert(forest.flat_feats.isContinuous() && forest.flat_thresholds.isContinuous());
+        CV_Assert(weight_t.type() == CV_64FC1 && weight_t.isContinuous() && weight_t.rows == F && weight_t.cols == 2 * landmark_n);
+        stages[k].feats = appendAligned(blob, forest.flat_feats.ptr(), forest.flat_feats.total()*sizeof(double));
+        stages[k].thresholds = appendAligned(blob, forest.flat_thresholds.ptr(), forest.flat_thresholds.total()*sizeof(int));
+        stages[k].weights = appendAligned(blob, weight_t.ptr(), weight_t.total()*sizeof(double));
+    }
+    memcpy(&blob[header.stages_offset], &stages[0], stages.size()*sizeof(stages[0]));
+    memcpy(&blob[0], &header, sizeof(header));
+}
+
+void FacemarkLBFImpl::Regressor::readCompact(const uchar *data, size_t size, Params & config) {
+    const char *error_message = "The compact LBF model is corrupted.";
+    if (size < sizeof(LBFModelHeader)) {
+        CV_Error(Error::StsBadArg, error_message);
+    }
+    const LBFModelHeader &header = *(const LBFModelHeader*)data;
+    if (memcmp(header.magic, LBF_MODEL_MAGIC, sizeof(header.magic)) != 0 || header.version != LBF_MODEL_VERSION) {
+        CV_Error(Error::StsBadArg, "Unsupported version of the compact LBF model.");
+    }
+    if (header.stages_n <= 0 || header.tree_n <= 0 || header.n_landmarks <= 0 ||
+        header.tree_depth <= 0 || header.tree_depth > 24) {
+        CV_Error(Error::StsBadArg, error_message);
+    }
+    const uint64_t trees = (uint64_t)header.n_landmarks * header.tree_n;
+    if (trees > (uint64_t)(std::numeric_limits<int>::max() >> (header.tree_depth + 2))) {
+        CV_Error(Error::StsBadArg, error_message);
+    }
+    const uint64_t nodes = trees << header.tree_depth;
+    const uint64_t F = nodes / 2;
+    if (
+        !isArrayInside(header.meanshape_offset, (uint64_t)header.n_landmarks * 2, sizeof(double), size) ||
+        !isArrayInside(header.stages_offset, (uint64_t)header.stages_n, sizeof(LBFStageOffsets), size)) {
+        CV_Error(Error::StsBadArg, error_message);
+    }
+    const LBFStageOffsets *stages = (const LBFStageOffsets*)(data + header.stages_offset);
+    for (int k = 0; k < header.stages_n; k++) {
+        if (!isArrayInside(stages[k].feats, nodes * 4, sizeof(double), size) ||
+            !isArrayInside(stages[k].thresholds, nodes, sizeof(int), size) ||
+            !isArrayInside(stages[k].weights, F * 2 * header.n_landmarks, sizeof(double), size)) {
+            CV_Error(Error::StsBadArg, error_message);
+        }
+    }
+
+    config.stages_n = header.stages_n;
+    config.tree_n = header.tree_n;
+    config.tree_depth = header.tree_depth;
+    config.n_landmarks = header.n_landmarks;
+    stages_n = config.stages_n;
+    landmark_n = config.n_landmarks;
+
+    // only the mean shape is copied, the forests and the weights are used in place
+    uchar *base = const_cast<uchar*>(data);
+    mean_shape = Mat(landmark_n, 2, CV_64FC1, base + header.meanshape_offset).clone();
+    random_forests.clear();
+    random_forests.resize(stages_n);
+    gl_regression_weights.clear();
+    gl_regression_weights.resize(stages_n);
+    gl_regression_weights_t.clear();
+    gl_regression_weights_t.resize(stages_n);
+    for (int k = 0; k < stages_n; k++) {
+        random_forests[k].verbose = config.verbose;
+        random_forests[k].overlap_ratio = config.bagging_overlap;
+        random_forests[k].feats_m = config.feats_m;
+        random_forests[k].radius_m = config.radius_m;
+        random_forests[k].setFlat(landmark_n, config.tree_n, config.tree_depth,
+                                  Mat_<double>((int)nodes, 4, (double*)(base + stages[k].feats)),
+                                  Mat_<int>((int)nodes, 1, (int*)(base + stages[k].thresholds)));
+        gl_regression_weights_t[k] = Mat((int)F, 2 * landmark_n, CV_64FC1, base + stages[k].weights);
     }
 }
 
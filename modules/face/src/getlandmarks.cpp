@@ -44,12 +44,81 @@ void FacemarkKazemiImpl :: readPixels(ifstream& is,uint64_t index)
 {
     is.read((char*)&loaded_pixel_coordinates[(unsigned long)index][0], loaded_pixel_coordinates[(unsigned long)index].size() * sizeof(Point2f));
 }
+void FacemarkKazemiImpl :: setCompactModel(const Ptr<MappedFile>& data){
+    const String error_message = "Data not saved properly.Aborting.....";
+    if(data->size() < sizeof(kazemi_model_header) || !data->hasMagic(KAZEMI_MODEL_MAGIC))
+        CV_Error(Error::StsBadArg, error_message);
+    const uchar* base = data->data();
+    const size_t size = data->size();
+    const kazemi_model_header& header = *(const kazemi_model_header*)base;
+    if(header.version != KAZEMI_MODEL_VERSION)
+        CV_Error(Error::StsBadArg, "Unsupported version of the compact model. Aborting....");
+    const uint64_t L = header.num_landmarks;
+    const uint64_t num_trees = (uint64_t)header.cascade_size*header.num_trees;
+    if(header.cascade_size == 0 || header.num_trees == 0 || header.num_pixels == 0 || L == 0 ||
+       !isArrayInside(header.pixels_offset, (uint64_t)header.cascade_size*header.num_pixels, sizeof(Point2f), size) ||
+       !isArrayInside(header.meanshape_offset, L, sizeof(Point2f), size) ||
+       !isArrayInside(header.trees_offset, num_trees + 1, sizeof(uint64_t), size) ||
+       !isArrayInside(header.nodes_offset, header.num_nodes, sizeof(flat_node), size) ||
+       header.num_leaves > (uint64_t)std::numeric_limits<int32_t>::max() ||
+       !isArrayInside(header.leaves_offset, header.num_leaves*L, sizeof(Point2f), size))
+        CV_Error(Error::StsBadArg, error_message);
+    const uint64_t* trees = (const uint64_t*)(base + header.trees_offset);
+    const flat_node* nodes = (const flat_node*)(base + header.nodes_offset);
+    if(trees[0] != 0 || trees[num_trees] != header.num_nodes)
+        CV_Error(Error::StsBadArg, error_message);
+    // only the nodes reachable from the roots are used by fit()
+    vector<uint64_t> stack;
+    for(uint64_t t=0;t<num_trees;t++){
+        if(trees[t] >= trees[t+1] || trees[t+1] > header.num_nodes)
+            CV_Error(Error::StsBadArg, error_message);
+        const flat_node* tree = nodes + trees[t];
+        const uint64_t tree_size = trees[t+1] - trees[t];
+        stack.assign(1, 0);
+        while(!stack.empty()){
+            uint64_t k = stack.back();
+            stack.pop_back();
+            const flat_node& curr_node = tree[k];
+            if(curr_node.leaf >= 0){
+                if((uint64_t)curr_node.leaf >= header.num_leaves)
+                    CV_Error(Error::StsBadArg, error_message);
+                continue;
+            }
+            if(curr_node.index1 >= header.num_pixels || curr_node.index2 >= header.num_pixels || 2*k+2 >= tree_size)
+                CV_Error(Error::StsBadArg, error_message);
+            stack.push_back(2*k+1);
+            stack.push_back(2*k+2);
+        }
+    }
+    const Point2f* pixels = (const Point2f*)(base + header.pixels_offset);
+    const Point2f* mean = (const Point2f*)(base + header.meanshape_offset);
+    loaded_pixel_coordinates.resize(header.cascade_size);
+    for(unsigned long i=0;i<header.cascade_size;i++)
+        loaded_pixel_coordinates[i].assign(pixels + i*header.num_pixels, pixels + (i+1)*header.num_pixels);
+    meanshape.assign(mean, mean + L);
+    if(!setMeanExtreme())
+        CV_Error(Error::StsBadArg, error_message);
+    model_data = data;
+    flat_cascade_size = header.cascade_size;
+    flat_num_trees = header.num_trees;
+    flat_trees = trees;
+    flat_nodes = nodes;
+    flat_leaves = (const Point2f*)(base + header.leaves_offset);
+    isModelLoaded = true;
+}
 void FacemarkKazemiImpl :: loadModel(String filename){
     if(filename.empty()){
         String error_message = "No filename found.Aborting....";
         CV_Error(Error::StsBadArg, error_message);
         return ;
     }
+    Ptr<MappedFile> data = makePtr<MappedFile>();
+    if(data->open(filename) && data->hasMagic(KAZEMI_MODEL_MAGIC)){
+        // compact models are used in place
+        setCompactModel(data);
+        return ;
+    }
+    data->release();
     ifstream f(filename.c_str(),ios::binary);
     if(!f.is_open()){
         String error_message = "No file with given name found.Aborting....";
@@ -166,7 +235,12 @@ void FacemarkKazemiImpl :: loadModel(String filename){
         }
     }
     f.close();
-    isModelLoaded = true;
+    // the trees are converted to the compact layout which is used by fit()
+    vector<uchar> blob;
+    flattenForests(blob);
+    vector< vector<regtree> >().swap(loaded_forests);
+    data->assign(blob);
+    setCompactModel(data);
 }
 
 /**
@@ -227,50 +301,39 @@ bool FacemarkKazemiImpl::fit(InputArray img, InputArray roi, OutputArrayOfArrays
         CV_Error(Error::StsBadArg, error_message);
         return false;
     }
-    if(meanshape.empty()||loaded_forests.empty()||loaded_pixel_coordinates.empty()){
+    if(meanshape.empty()||model_data.empty()||loaded_pixel_coordinates.size()!=flat_cascade_size){
         String error_message = "Model not loaded properly.Aborting...";
         CV_Error(Error::StsBadArg, error_message);
         return false;
     }
-    if(loaded_forests.size()==0){
-        String error_message = "Model not loaded properly.Aboerting...";
-        CV_Error(Error::StsBadArg, error_message);
-        return false;
-    }
-    if(loaded_pixel_coordinates.size()==0){
-        String error_message = "Model not loaded properly.Aboerting...";
-        CV_Error(Error::StsBadArg, error_message);
-        return false;
-    }
     vector< vector<int> > nearest_landmarks;
     findNearestLandmarks(nearest_landmarks);
-    tree_node curr_node;
     vector<Point2f> pixel_relative;
     vector<int> pixel_intensity;
     Mat warp_mat;
+    const size_t num_landmarks = meanshape.size();
     for(size_t e=0;e<faces.size();e++){
         shapes[e]=meanshape;
         convertToActual(faces[e],warp_mat);
-        for(size_t i=0;i<loaded_forests.size();i++){
+        for(size_t i=0;i<flat_cascade_size;i++){
             pixel_intensity.clear();
             pixel_relative = loaded_pixel_coordinates[i];
             getRelativePixels(shapes[e],pixel_relative,nearest_landmarks[i]);
             getPixelIntensities(image,pixel_relative,pixel_intensity,faces[e]);
-            for(size_t j=0;j<loaded_forests[i].size();j++){
-                regtree tree = loaded_forests[i][j];
-                curr_node = tree.nodes[0];
+            for(size_t j=0;j<flat_num_trees;j++){
+                const flat_node* tree = flat_nodes + flat_trees[i*flat_num_trees + j];
                 unsigned long curr_node_index = 0;
-                while(curr_node.leaf.size()==0)
+                while(tree[curr_node_index].leaf < 0)
                 {
-                    if ((float)pixel_intensity[(unsigned long)curr_node.split.index1] - (float)pixel_intensity[(unsigned long)curr_node.split.index2] > curr_node.split.thresh)
-                    {
+                    const flat_node& curr_node = tree[curr_node_index];
+                    if ((float)pixel_intensity[curr_node.index1] - (float)pixel_intensity[curr_node.index2] > curr_node.thresh)
                         curr_node_index=left(curr_node_index);
-                    }                    else
+                    else
                         curr_node_index=right(curr_node_index);
-                    curr_node = tree.nodes[curr_node_index];
                 }
-                for(size_t p=0;p<curr_node.leaf.size();p++){
-                    shapes[e][p]=shapes[e][p] + curr_node.leaf[p];
+                const Point2f* leaf = flat_leaves + (size_t)tree[curr_node_index].leaf*num_landmarks;
+                for(size_t p=0;p<num_landmarks;p++){
+                    shapes[e][p]=shapes[e][p] + leaf[p];
                 }
             }
         }
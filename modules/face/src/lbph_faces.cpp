@@ -18,6 +18,7 @@
 #include "precomp.hpp"
 #include "opencv2/face.hpp"
 #include "face_utils.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv { namespace face {
 
@@ -39,6 +40,13 @@ private:
     std::vector<Mat> _histograms;
     Mat _labels;
 
+    // half precision copy of _histograms with one sample per row, it is scanned by predict()
+    // and built on the first prediction after the model changed
+    mutable Mat _packedHistograms;
+    mutable Mutex _packedMutex;
+
+    Mat getPackedHistograms() const;
+
     // Computes a LBPH model with images in src and
     // corresponding labels in labels, possibly preserving
     // old model data.
@@ -135,6 +143,7 @@ void LBPH::read(const FileNode& fs) {
     //read matrices
     readFileNodeList(fs["histograms"], _histograms);
     fs["labels"] >> _labels;
+    _packedHistograms.release();
     const FileNode& fn = fs["labelsInfo"];
     if (fn.type() == FileNode::SEQ)
     {
@@ -249,12 +258,65 @@ inline void elbp_(InputArray _src, OutputArray _dst, int radius, int neighbors)
     }
 }
 
+// elbp_<unsigned char> with the pixels of a row compared at once
+static void elbp8u(InputArray _src, OutputArray _dst, int radius, int neighbors) {
+    Mat src = _src.getMat();
+    _dst.create(src.rows-2*radius, src.cols-2*radius, CV_32SC1);
+    Mat dst = _dst.getMat();
+    dst.setTo(0);
+    const int width = dst.cols;
+    for(int n=0; n<neighbors; n++) {
+        // sample points
+        float x = static_cast<float>(radius * cos(2.0*CV_PI*n/static_cast<float>(neighbors)));
+        float y = static_cast<float>(-radius * sin(2.0*CV_PI*n/static_cast<float>(neighbors)));
+        // relative indices
+        int fx = static_cast<int>(floor(x));
+        int fy = static_cast<int>(floor(y));
+        int cx = static_cast<int>(ceil(x));
+        int cy = static_cast<int>(ceil(y));
+        // fractional part
+        float ty = y - fy;
+        float tx = x - fx;
+        // set interpolation weights
+        float w1 = (1 - tx) * (1 - ty);
+        float w2 =      tx  * (1 - ty);
+        float w3 = (1 - tx) *      ty;
+        float w4 =      tx  *      ty;
+        for(int i=radius; i < src.rows-radius;i++) {
+            const uchar* center = src.ptr<uchar>(i) + radius;
+            const uchar* top = src.ptr<uchar>(i+fy) + radius;
+            const uchar* bottom = src.ptr<uchar>(i+cy) + radius;
+            int* code = dst.ptr<int>(i-radius);
+            int j = 0;
+#if CV_SIMD128
+            const v_float32x4 v_w1 = v_setall_f32(w1), v_w2 = v_setall_f32(w2);
+            const v_float32x4 v_w3 = v_setall_f32(w3), v_w4 = v_setall_f32(w4);
+            const v_float32x4 v_eps = v_setall_f32(std::numeric_limits<float>::epsilon());
+            const v_int32x4 v_bit = v_setall_s32(1 << n);
+            for(; j <= width - v_float32x4::nlanes; j += v_float32x4::nlanes) {
+                v_float32x4 t = v_w1 * v_cvt_f32(v_reinterpret_as_s32(v_load_expand_q(top + j + fx)));
+                t = t + v_w2 * v_cvt_f32(v_reinterpret_as_s32(v_load_expand_q(top + j + cx)));
+                t = t + v_w3 * v_cvt_f32(v_reinterpret_as_s32(v_load_expand_q(bottom + j + fx)));
+                t = t + v_w4 * v_cvt_f32(v_reinterpret_as_s32(v_load_expand_q(bottom + j + cx)));
+                v_float32x4 c = v_cvt_f32(v_reinterpret_as_s32(v_load_expand_q(center + j)));
+                v_float32x4 mask = (t > c) | (v_abs(t - c) < v_eps);
+                v_store(code + j, v_load(code + j) + (v_reinterpret_as_s32(mask) & v_bit));
+            }
+#endif
+            for(; j < width; j++) {
+                float t = static_cast<float>(w1*top[j+fx] + w2*top[j+cx] + w3*bottom[j+fx] + w4*bottom[j+cx]);
+                code[j] += ((t > center[j]) || (std::abs(t-center[j]) < std::numeric_limits<float>::epsilon())) << n;
+            }
+        }
+    }
+}
+
 static void elbp(InputArray src, OutputArray dst, int radius, int neighbors)
 {
     int type = src.type();
     switch (type) {
     case CV_8SC1:   elbp_<char>(src,dst, radius, neighbors); break;
-    case CV_8UC1:   elbp_<unsigned char>(src, dst, radius, neighbors); break;
+    case CV_8UC1:   elbp8u(src, dst, radius, neighbors); break;
     case CV_16SC1:  elbp_<short>(src,dst, radius, neighbors); break;
     case CV_16UC1:  elbp_<unsigned short>(src,dst, radius, neighbors); break;
     case CV_32SC1:  elbp_<int>(src,dst, radius, neighbors); break;
@@ -324,6 +386,25 @@ static Mat spatial_histogram(InputArray _src, int numPatterns,
     // return matrix with zeros if no data was given
     if(src.empty())
         return result.reshape(1,1);
+    // the patterns are counted directly into the cells of the feature vector
+    if(src.type() == CV_32SC1) {
+        const float scale = width * height > 0 ? static_cast<float>(1.0 / (width * height)) : 0.f;
+        for(int i = 0; i < grid_y; i++) {
+            for(int j = 0; j < grid_x; j++) {
+                float* hist = result.ptr<float>(i * grid_x + j);
+                for(int y = i*height; y < (i+1)*height; y++) {
+                    const int* pattern = src.ptr<int>(y) + j*width;
+                    for(int x = 0; x < width; x++) {
+                        if((unsigned)pattern[x] < (unsigned)numPatterns)
+                            hist[pattern[x]]++;
+                    }
+                }
+                for(int k = 0; k < numPatterns; k++)
+                    hist[k] *= scale;
+            }
+        }
+        return result.reshape(1,1);
+    }
     // initial result_row
     int resultRowIdx = 0;
     // iterate through grid
@@ -379,6 +460,7 @@ void LBPH::train(InputArrayOfArrays _in_src, InputArray _in_labels, bool preserv
         _labels.release();
         _histograms.clear();
     }
+    _packedHistograms.release();
     // append labels to _labels matrix
     for(size_t labelIdx = 0; labelIdx < labels.total(); labelIdx++) {
         _labels.push_back(labels.at<int>((int)labelIdx));
@@ -399,6 +481,69 @@ void LBPH::train(InputArrayOfArrays _in_src, InputArray _in_labels, bool preserv
     }
 }
 
+// HISTCMP_CHISQR_ALT distances between a CV_32F query and the CV_16F rows of the packed samples
+class ChiSquareBody : public ParallelLoopBody
+{
+public:
+    ChiSquareBody(const Mat& _samples, const Mat& _query, std::vector<double>& _dists)
+        : samples(_samples), query(_query), dists(_dists) {}
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        const float* q = query.ptr<float>();
+        const int dims = samples.cols;
+        for (int i = range.start; i < range.end; i++)
+        {
+            const float16_t* h = samples.ptr<float16_t>(i);
+            double result = 0;
+            int j = 0;
+#if CV_SIMD128
+            const v_float32x4 v_eps = v_setall_f32(FLT_EPSILON), v_zero = v_setzero_f32();
+            v_float32x4 v_sum = v_zero;
+            for (; j <= dims - v_float32x4::nlanes; j += v_float32x4::nlanes)
+            {
+                v_float32x4 a = v_load(q + j), b = v_load_expand(h + j);
+                v_float32x4 diff = a - b, sum = a + b;
+                v_sum += v_select(v_abs(sum) > v_eps, diff * diff / sum, v_zero);
+            }
+            result = v_reduce_sum(v_sum);
+#endif
+            for (; j < dims; j++)
+            {
+                double a = q[j], b = (float)h[j];
+                double diff = a - b, sum = a + b;
+                if (std::abs(sum) > DBL_EPSILON)
+                    result += diff * diff / sum;
+            }
+            dists[i] = 2 * result;
+        }
+    }
+
+private:
+    const Mat& samples;
+    const Mat& query;
+    std::vector<double>& dists;
+
+    ChiSquareBody& operator=(const ChiSquareBody&);
+};
+
+Mat LBPH::getPackedHistograms() const {
+    AutoLock lock(_packedMutex);
+    if(_packedHistograms.empty() && !_histograms.empty()) {
+        const size_t dims = _histograms[0].total();
+        for(size_t sampleIdx = 0; sampleIdx < _histograms.size(); sampleIdx++) {
+            if(_histograms[sampleIdx].total() != dims || _histograms[sampleIdx].channels() != 1)
+                return _packedHistograms;
+        }
+        _packedHistograms.create((int)_histograms.size(), (int)dims, CV_16F);
+        for(size_t sampleIdx = 0; sampleIdx < _histograms.size(); sampleIdx++) {
+            Mat row = _packedHistograms.row((int)sampleIdx);
+            _histograms[sampleIdx].reshape(1, 1).convertTo(row, CV_16F);
+        }
+    }
+    return _packedHistograms;
+}
+
 void LBPH::predict(InputArray _src, Ptr<PredictCollector> collector) const {
     if(_histograms.empty()) {
         // throw error if no data (or simply return -1?)
@@ -414,12 +559,24 @@ void LBPH::predict(InputArray _src, Ptr<PredictCollector> collector) const {
             _grid_x, /* grid size x */
             _grid_y, /* grid size y */
             true /* normed histograms */);
-    // find 1-nearest neighbor
+    Mat packed = getPackedHistograms();
     collector->init((int)_histograms.size());
-    for (size_t sampleIdx = 0; sampleIdx < _histograms.size(); sampleIdx++) {
-        double dist = compareHist(_histograms[sampleIdx], query, HISTCMP_CHISQR_ALT);
-        int label = _labels.at<int>((int)sampleIdx);
-        if (!collector->collect(label, dist))return;
+    if(packed.empty()) {
+        // the samples have different sizes, compare them one by one
+        for (size_t sampleIdx = 0; sampleIdx < _histograms.size(); sampleIdx++) {
+            double dist = compareHist(_histograms[sampleIdx], query, HISTCMP_CHISQR_ALT);
+            int label = _labels.at<int>((int)sampleIdx);
+            if (!collector->collect(label, dist))return;
+        }
+        return;
+    }
+    CV_Assert(query.total() == (size_t)packed.cols);
+    // find 1-nearest neighbor, the distances are computed in parallel and collected in the sample order
+    std::vector<double> dists(packed.rows);
+    parallel_for_(Range(0, packed.rows), ChiSquareBody(packed, query, dists));
+    for (int sampleIdx = 0; sampleIdx < packed.rows; sampleIdx++) {
+        int label = _labels.at<int>(sampleIdx);
+        if (!collector->collect(label, dists[sampleIdx]))return;
     }
 }
 
@@ -0,0 +1,116 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "model_file.hpp"
+#include <fstream>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define HAVE_FACE_MMAP 1
+#endif
+
+namespace cv {
+namespace face {
+
+MappedFile::MappedFile() : data_(NULL), size_(0), mapped_(NULL)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+void MappedFile::release()
+{
+#ifdef HAVE_FACE_MMAP
+    if (mapped_)
+        munmap(mapped_, size_);
+#endif
+    mapped_ = NULL;
+    data_ = NULL;
+    size_ = 0;
+    std::vector<uchar>().swap(buffer_);
+}
+
+bool MappedFile::open(const String& filename)
+{
+    release();
+#ifdef HAVE_FACE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void* ptr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr != MAP_FAILED)
+        {
+            mapped_ = ptr;
+            data_ = (const uchar*)ptr;
+            size_ = (size_t)st.st_size;
+        }
+    }
+    ::close(fd);
+    if (mapped_)
+        return true;
+#endif
+    std::ifstream f(filename.c_str(), std::ios::binary | std::ios::ate);
+    if (!f.is_open())
+        return false;
+    std::streamoff len = f.tellg();
+    if (len <= 0)
+        return true;
+    std::vector<uchar> buf((size_t)len);
+    f.seekg(0);
+    f.read((char*)&buf[0], len);
+    if (!f)
+        return false;
+    assign(buf);
+    return true;
+}
+
+void MappedFile::assign(std::vector<uchar>& buf)
+{
+    release();
+    buffer_.swap(buf);
+    data_ = buffer_.empty() ? NULL : &buffer_[0];
+    size_ = buffer_.size();
+}
+
+bool MappedFile::hasMagic(const char* magic) const
+{
+    return size_ >= 8 && memcmp(data_, magic, 8) == 0;
+}
+
+size_t appendAligned(std::vector<uchar>& blob, const void* data, size_t size)
+{
+    size_t offset = alignSize(blob.size(), 8);
+    blob.resize(offset + size);
+    if (size > 0)
+        memcpy(&blob[offset], data, size);
+    return offset;
+}
+
+bool isArrayInside(uint64 offset, uint64 count, size_t elem_size, size_t size)
+{
+    return offset % 8 == 0 && offset <= size && count <= (size - offset) / elem_size;
+}
+
+void writeModelFile(const String& filename, const uchar* data, size_t size)
+{
+    std::ofstream f(filename.c_str(), std::ios::binary);
+    if (!f.is_open())
+        CV_Error(Error::StsError, "Error while opening file to write model: " + filename);
+    f.write((const char*)data, size);
+    if (!f)
+        CV_Error(Error::StsError, "Error while writing model: " + filename);
+}
+
+}} // namespace
@@ -0,0 +1,58 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_FACE_MODEL_FILE_HPP__
+#define __OPENCV_FACE_MODEL_FILE_HPP__
+
+#include <vector>
+
+namespace cv {
+namespace face {
+
+/** @brief Read only contents of a compact model file.
+ *
+ * The file is memory mapped where the platform supports it, so the models use the arrays in place
+ * and only the pages which are read get loaded. Elsewhere the file is read into memory at once.
+ * The data is aligned to at least 8 bytes.
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    //! maps the file, returns false if it can not be opened
+    bool open(const String& filename);
+    //! takes the contents of an in memory model, buf is left empty
+    void assign(std::vector<uchar>& buf);
+    void release();
+
+    const uchar* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    //! whether the contents start with the given 8 bytes
+    bool hasMagic(const char* magic) const;
+
+private:
+    const uchar* data_;
+    size_t size_;
+    void* mapped_;
+    std::vector<uchar> buffer_;
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+//! appends size bytes to blob at an offset aligned to 8 bytes, returns the offset
+size_t appendAligned(std::vector<uchar>& blob, const void* data, size_t size);
+
+//! whether count elements at offset are inside of a model of the given size, the offset must be aligned to 8 bytes
+bool isArrayInside(uint64 offset, uint64 count, size_t elem_size, size_t size);
+
+//! writes the whole blob to a binary file
+void writeModelFile(const String& filename, const uchar* data, size_t size);
+
+}} // namespace
+
+#endif
@@ -6,6 +6,7 @@
 #include "face_alignmentimpl.hpp"
 #include "opencv2/calib3d.hpp"
 #include <climits>
+#include <cstring>
 
 using namespace std;
 namespace cv{
@@ -302,6 +303,76 @@ bool FacemarkKazemiImpl :: saveModel(String filename){
     }
     return true;
 }
+void FacemarkKazemiImpl :: flattenForests(vector<uchar>& blob){
+    if(loaded_forests.empty()||loaded_forests.size()!=loaded_pixel_coordinates.size()||meanshape.empty()){
+        String error_message = "Model not loaded properly.Aborting...";
+        CV_Error(Error::StsBadArg, error_message);
+    }
+    kazemi_model_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, KAZEMI_MODEL_MAGIC, sizeof(header.magic));
+    header.version = KAZEMI_MODEL_VERSION;
+    header.cascade_size = (uint32_t)loaded_forests.size();
+    header.num_trees = (uint32_t)loaded_forests[0].size();
+    header.num_pixels = (uint32_t)loaded_pixel_coordinates[0].size();
+    header.num_landmarks = (uint32_t)meanshape.size();
+    vector<Point2f> pixels;
+    vector<uint64_t> trees;
+    vector<flat_node> nodes;
+    vector<Point2f> leaves;
+    for(unsigned long i=0;i<loaded_forests.size();i++){
+        if(loaded_forests[i].size()!=header.num_trees||loaded_pixel_coordinates[i].size()!=header.num_pixels){
+            String error_message = "Incorrect training data. Aborting....";
+            CV_Error(Error::StsBadArg, error_message);
+        }
+        pixels.insert(pixels.end(),loaded_pixel_coordinates[i].begin(),loaded_pixel_coordinates[i].end());
+        for(unsigned long j=0;j<loaded_forests[i].size();j++){
+            const regtree& tree = loaded_forests[i][j];
+            trees.push_back(nodes.size());
+            for(size_t k=0;k<tree.nodes.size();k++){
+                const tree_node& curr_node = tree.nodes[k];
+                flat_node node;
+                if(curr_node.leaf.empty()){
+                    // indices out of range are only allowed in the unreachable nodes, they are rejected on loading otherwise
+                    node.index1 = (uint32_t)std::min<uint64_t>(curr_node.split.index1, std::numeric_limits<uint32_t>::max());
+                    node.index2 = (uint32_t)std::min<uint64_t>(curr_node.split.index2, std::numeric_limits<uint32_t>::max());
+                    node.thresh = curr_node.split.thresh;
+                    node.leaf = -1;
+                }
+                else{
+                    if(curr_node.leaf.size()!=meanshape.size()){
+                        String error_message = "Data not saved properly.Aborting.....";
+                        CV_Error(Error::StsBadArg, error_message);
+                    }
+                    node.index1 = node.index2 = 0;
+                    node.thresh = 0;
+                    node.leaf = (int32_t)(leaves.size()/meanshape.size());
+                    leaves.insert(leaves.end(),curr_node.leaf.begin(),curr_node.leaf.end());
+                }
+                nodes.push_back(node);
+            }
+        }
+    }
+    trees.push_back(nodes.size());
+    header.num_nodes = nodes.size();
+    header.num_leaves = leaves.size()/meanshape.size();
+
+    blob.clear();
+    appendAligned(blob, &header, sizeof(header));
+    header.pixels_offset = appendAligned(blob, &pixels[0], pixels.size()*sizeof(Point2f));
+    header.meanshape_offset = appendAligned(blob, &meanshape[0], meanshape.size()*sizeof(Point2f));
+    header.trees_offset = appendAligned(blob, &trees[0], trees.size()*sizeof(uint64_t));
+    header.nodes_offset = appendAligned(blob, nodes.empty() ? NULL : &nodes[0], nodes.size()*sizeof(flat_node));
+    header.leaves_offset = appendAligned(blob, leaves.empty() ? NULL : &leaves[0], leaves.size()*sizeof(Point2f));
+    memcpy(&blob[0], &header, sizeof(header));
+}
+void FacemarkKazemiImpl :: saveCompactModel(const String& filename){
+    if(!isModelLoaded||model_data.empty()){
+        String error_message = "No model loaded. Aborting....";
+        CV_Error(Error::StsBadArg, error_message);
+    }
+    writeModelFile(filename, model_data->data(), model_data->size());
+}
 void FacemarkKazemiImpl::training(String imageList, String groundTruth){
     imageList.clear();
     groundTruth.clear();
@@ -339,6 +410,11 @@ bool FacemarkKazemiImpl::training(vector<Mat>& images, vector< vector<Point2f> >
         loaded_forests.push_back(gradientBoosting(samples,loaded_pixel_coordinates[i]));
     }
     saveModel(modelFilename);
+    vector<uchar> blob;
+    flattenForests(blob);
+    Ptr<MappedFile> data = makePtr<MappedFile>();
+    data->assign(blob);
+    setCompactModel(data);
     return true;
 }
 }//cv
@@ -0,0 +1,55 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+static void checkPredictBatch(const Ptr<BasicFaceRecognizer>& model)
+{
+    RNG& rng = theRNG();
+    std::vector<Mat> images;
+    std::vector<int> labels;
+    for (int i = 0; i < 12; i++)
+    {
+        Mat m(24, 20, CV_8U);
+        rng.fill(m, RNG::UNIFORM, 0, 256);
+        images.push_back(m);
+        labels.push_back(i / 3);
+    }
+    model->train(images, labels);
+
+    std::vector<Mat> queries(images.begin(), images.begin() + 5);
+    for (int i = 0; i < 70; i++)
+    {
+        Mat m(24, 20, CV_8U);
+        rng.fill(m, RNG::UNIFORM, 0, 256);
+        queries.push_back(m);
+    }
+    std::vector<int> batchLabels;
+    std::vector<double> batchDists;
+    model->predictBatch(queries, batchLabels, batchDists);
+    ASSERT_EQ(queries.size(), batchLabels.size());
+    ASSERT_EQ(queries.size(), batchDists.size());
+    for (size_t i = 0; i < queries.size(); i++)
+    {
+        int label = -1;
+        double dist = DBL_MAX;
+        model->predict(queries[i], label, dist);
+        EXPECT_EQ(label, batchLabels[i]) << i;
+        EXPECT_NEAR(dist, batchDists[i], 1e-6 * std::max(dist, 1.0)) << i;
+    }
+}
+
+TEST(Face_EigenFaceRecognizer, predictBatch)
+{
+    checkPredictBatch(EigenFaceRecognizer::create());
+}
+
+TEST(Face_FisherFaceRecognizer, predictBatch)
+{
+    checkPredictBatch(FisherFaceRecognizer::create());
+}
+
+}} // namespace
@@ -89,5 +89,33 @@ TEST(CV_Face_FacemarkKazemi, can_detect_landmarks) {
     EXPECT_NO_THROW(facemark->fit(img,faces,shapes));
     shapes.clear();
 }
+TEST(CV_Face_FacemarkKazemi, compact_model_gives_same_landmarks) {
+    string cascade_name = cvtest::findDataFile("face/lbpcascade_frontalface_improved.xml", true);
+    CascadeClassifier face_cascade;
+    face_cascade.load(cascade_name);
+    FacemarkKazemi::Params params;
+    Ptr<FacemarkKazemi> facemark = FacemarkKazemi::create(params);
+    EXPECT_TRUE(facemark->setFaceDetector((cv::face::FN_FaceDetector)myDetector, &face_cascade));
+    string imgname = cvtest::findDataFile("face/detect.jpg");
+    string modelfilename = cvtest::findDataFile("face/face_landmark_model.dat",true);
+    Mat img = imread(imgname);
+    ASSERT_FALSE(img.empty());
+    ASSERT_NO_THROW(facemark->loadModel(modelfilename));
+    vector<Rect> faces;
+    ASSERT_TRUE(facemark->getFaces(img,faces));
+    ASSERT_FALSE(faces.empty());
+    vector< vector<Point2f> > shapes, compact_shapes;
+    ASSERT_TRUE(facemark->fit(img,faces,shapes));
+
+    string compactfilename = cv::tempfile(".dat");
+    ASSERT_NO_THROW(facemark->saveCompactModel(compactfilename));
+    Ptr<FacemarkKazemi> compact = FacemarkKazemi::create(params);
+    ASSERT_NO_THROW(compact->loadModel(compactfilename));
+    ASSERT_TRUE(compact->fit(img,faces,compact_shapes));
+    ASSERT_EQ(shapes.size(), compact_shapes.size());
+    for(size_t i=0;i<shapes.size();i++)
+        EXPECT_EQ(0, cvtest::norm(Mat(shapes[i]), Mat(compact_shapes[i]), NORM_INF));
+    remove(compactfilename.c_str());
+}
 
 }} // namespace
@@ -135,6 +135,18 @@ TEST(CV_Face_FacemarkLBF, test_workflow) {
     EXPECT_TRUE(rects.size()>0);
     EXPECT_TRUE(facemark->fit(image, rects, facial_points));
     EXPECT_TRUE(facial_points[0].size()>0);
+
+    /*------------ Compact model ---------------*/
+    string compact_filename = cv::tempfile(".bin");
+    EXPECT_NO_THROW(facemark->saveCompactModel(compact_filename));
+    Ptr<FacemarkLBF> compact = FacemarkLBF::create(params);
+    EXPECT_NO_THROW(compact->loadModel(compact_filename));
+    std::vector<std::vector<Point2f> > compact_points;
+    EXPECT_TRUE(compact->fit(image, rects, compact_points));
+    ASSERT_EQ(facial_points.size(), compact_points.size());
+    for (size_t i = 0; i < facial_points.size(); i++)
+        EXPECT_EQ(0, cvtest::norm(Mat(facial_points[i]), Mat(compact_points[i]), NORM_INF));
+    remove(compact_filename.c_str());
 }
 
 }} // namespace
@@ -0,0 +1,52 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+TEST(Face_LBPH, predict_distances)
+{
+    RNG& rng = theRNG();
+    std::vector<Mat> images;
+    std::vector<int> labels;
+    for (int i = 0; i < 20; i++)
+    {
+        Mat m(67, 59, CV_8U);
+        rng.fill(m, RNG::UNIFORM, 0, 256);
+        images.push_back(m);
+        labels.push_back(i / 2);
+    }
+    Ptr<LBPHFaceRecognizer> model = LBPHFaceRecognizer::create(2, 8, 5, 6);
+    model->train(images, labels);
+
+    Mat query(67, 59, CV_8U);
+    rng.fill(query, RNG::UNIFORM, 0, 256);
+    Ptr<StandardCollector> collector = StandardCollector::create();
+    model->predict(query, collector);
+    // the samples are collected in the training order
+    std::vector<std::pair<int, double> > results = collector->getResults(false);
+    ASSERT_EQ(images.size(), results.size());
+
+    // reference distances of the float histograms
+    Ptr<LBPHFaceRecognizer> queryModel = LBPHFaceRecognizer::create(2, 8, 5, 6);
+    queryModel->train(std::vector<Mat>(1, query), std::vector<int>(1, 0));
+    Mat queryHist = queryModel->getHistograms()[0];
+    std::vector<Mat> histograms = model->getHistograms();
+    for (size_t i = 0; i < histograms.size(); i++)
+    {
+        double dist = compareHist(histograms[i], queryHist, HISTCMP_CHISQR_ALT);
+        EXPECT_EQ(labels[i], results[i].first);
+        EXPECT_NEAR(dist, results[i].second, dist * 1e-2) << i;
+    }
+
+    // the histograms of the training images are found
+    int label = -1;
+    double dist = DBL_MAX;
+    model->predict(images[7], label, dist);
+    EXPECT_EQ(labels[7], label);
+    EXPECT_LT(dist, 1e-2);
+}
+
+}} // namespace
@@ -95,6 +95,17 @@ If you want to draw small glyph, small is better.
 
     CV_WRAP virtual void setSplitNumber( int num ) = 0;
 
+/** @brief Set the size of the glyph and text caches
+
+The rendered glyphs ( keyed by font height, glyph and drawing mode ) and the shaped strings are
+kept in least recently used caches, so that drawing the same labels again does not load, render
+or shape them again. The caches are cleared when a font is loaded.
+
+@param num maximum number of glyphs, and of strings, kept in the caches
+*/
+
+    CV_WRAP virtual void setCacheSize( int num ) = 0;
+
 /** @brief Draws a text string.
 
 The function putText renders the specified text string in the image. Symbols that cannot be rendered using the specified font are replaced by "Tofu" or non-drawn.
@@ -115,6 +126,28 @@ The function putText renders the specified text string in the image. Symbols tha
         int thickness, int line_type, bool bottomLeftOrigin
     ) = 0;
 
+/** @brief Draws several text strings.
+
+The function putTexts draws texts[i] at orgs[i] for every i, in order, with the same
+parameters as putText. The checks and the font setup are done once for all the strings.
+
+@param img Image. (Only 8UC3 image is supported.)
+@param texts Text strings to be drawn.
+@param orgs Bottom-left/Top-left corners of the text strings in the image, one for each string.
+@param fontHeight Drawing font size by pixel unit.
+@param color Text color.
+@param thickness Thickness of the lines used to draw a text when negative, the glyph is filled. Otherwise, the glyph is drawn with this thickness.
+@param line_type Line type. See the line for details.
+@param bottomLeftOrigin When true, the image data origin is at the bottom-left corner. Otherwise, it is at the top-left corner.
+*/
+
+    CV_WRAP virtual void putTexts(
+        InputOutputArray img, const std::vector<String>& texts,
+        const std::vector<Point>& orgs,
+        int fontHeight, Scalar color,
+        int thickness, int line_type, bool bottomLeftOrigin
+    ) = 0;
+
 /** @brief Calculates the width and height of a text string.
 
 The function getTextSize calculates and returns the approximate size of a box that contains the specified text.
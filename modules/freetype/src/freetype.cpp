@@ -56,11 +56,78 @@
 #include <hb.h>
 #include <hb-ft.h>
 
+#include <list>
+#include <unordered_map>
+#include <type_traits>
+#include <cstring>
+
+#include "opencv2/core/hal/intrin.hpp"
+
 namespace cv {
 namespace freetype {
 
 using namespace std;
 
+/**
+ * Least recently used cache, the pointers and references to the values
+ * stay valid until they are evicted by a later put().
+ */
+template< typename Key, typename Value >
+class LRUCache
+{
+public:
+    explicit LRUCache( size_t capacity ) : mCapacity( capacity ) {}
+
+    Value* get( const Key& key )
+    {
+        typename Map::iterator it = mMap.find( key );
+        if ( it == mMap.end() ) {
+            return NULL;
+        }
+        // Move to the front as the most recently used
+        mItems.splice( mItems.begin(), mItems, it->second );
+        return &( it->second->second );
+    }
+
+    Value& put( const Key& key, const Value& value )
+    {
+        CV_DbgAssert( mMap.find( key ) == mMap.end() );
+        trim( mCapacity - 1 );
+        mItems.push_front( std::make_pair( key, value ) );
+        mMap[key] = mItems.begin();
+        return mItems.front().second;
+    }
+
+    void setCapacity( size_t capacity )
+    {
+        CV_Assert( capacity > 0 );
+        mCapacity = capacity;
+        trim( mCapacity );
+    }
+
+    void clear()
+    {
+        mMap.clear();
+        mItems.clear();
+    }
+
+private:
+    typedef std::list< std::pair< Key, Value > > List;
+    typedef std::unordered_map< Key, typename List::iterator > Map;
+
+    void trim( size_t size )
+    {
+        while ( mItems.size() > size ) {
+            mMap.erase( mItems.back().first );
+            mItems.pop_back();
+        }
+    }
+
+    size_t mCapacity;
+    List   mItems;
+    Map    mMap;
+};
+
 class CV_EXPORTS_W FreeType2Impl CV_FINAL : public FreeType2
 {
 public:
@@ -68,34 +135,85 @@ public:
     ~FreeType2Impl();
     void loadFontData(String fontFileName, int id) CV_OVERRIDE;
     void setSplitNumber( int num ) CV_OVERRIDE;
+    void setCacheSize( int num ) CV_OVERRIDE;
     void putText(
         InputOutputArray img, const String& text, Point org,
         int fontHeight, Scalar color,
         int thickness, int line_type, bool bottomLeftOrigin
     ) CV_OVERRIDE;
+    void putTexts(
+        InputOutputArray img, const std::vector<String>& texts,
+        const std::vector<Point>& orgs,
+        int fontHeight, Scalar color,
+        int thickness, int line_type, bool bottomLeftOrigin
+    ) CV_OVERRIDE;
     Size getTextSize(
         const String& text, int fontHeight, int thickness,
         CV_OUT int* baseLine
     ) CV_OVERRIDE;
 
 private:
+    enum GlyphMode { GLYPH_OUTLINE = 0, GLYPH_MONO = 1, GLYPH_GRAY = 2 };
+
+    typedef std::remove_pointer< decltype( FT_Outline::tags ) >::type     OutlineTag;
+    typedef std::remove_pointer< decltype( FT_Outline::contours ) >::type OutlineContour;
+
+    /**
+     * Glyph loaded at a font height, either its outline ( flipped, in FreeType
+     * coordinates ) or its bitmap ( coverage for gray, 0/1 for mono ).
+     */
+    struct CachedGlyph
+    {
+        FT_Vector advance;
+        int       bearingX;
+        int       bearingY;
+        Mat       bitmap;
+
+        std::vector< FT_Vector >      points;
+        std::vector< OutlineTag >     tags;
+        std::vector< OutlineContour > contours;
+        int                           flags;
+
+        //! outline sharing the storage of the cached points
+        FT_Outline outline()
+        {
+            FT_Outline o;
+            o.n_contours = static_cast< decltype( o.n_contours ) >( contours.size() );
+            o.n_points   = static_cast< decltype( o.n_points ) >( points.size() );
+            o.points     = points.empty()   ? NULL : &points[0];
+            o.tags       = tags.empty()     ? NULL : &tags[0];
+            o.contours   = contours.empty() ? NULL : &contours[0];
+            o.flags      = flags;
+            return o;
+        }
+    };
+
     FT_Library       mLibrary;
     FT_Face          mFace;
     FT_Outline_Funcs mFn;
 
     bool             mIsFaceAvailable;
     int              mCtoL;
+    int              mFontHeight; // pixel size currently set to mFace
     hb_font_t        *mHb_font;
+    hb_buffer_t      *mHb_buffer;
 
-    void putTextBitmapMono(
+    LRUCache< uint64, CachedGlyph >                          mGlyphCache;
+    LRUCache< std::string, std::vector< unsigned int > >     mShapeCache;
+
+    void setFontHeight( int fontHeight );
+    const std::vector< unsigned int >& shapeText( const String& text );
+    CachedGlyph& getGlyph( unsigned int glyphIndex, GlyphMode mode );
+
+    void putTextCached(
         InputOutputArray img, const String& text, Point org,
         int fontHeight, Scalar color,
         int thickness, int line_type, bool bottomLeftOrigin
     );
-    void putTextBitmapBlend(
+    void putTextBitmap(
         InputOutputArray img, const String& text, Point org,
         int fontHeight, Scalar color,
-        int thickness, int line_type, bool bottomLeftOrigin
+        GlyphMode mode, bool bottomLeftOrigin
     );
     void putTextOutline(
         InputOutputArray img, const String& text, Point org,
@@ -141,7 +259,11 @@ private:
     };
 };
 
+// Number of glyphs and shaped strings kept by default
+static const int defaultCacheSize = 1024;
+
 FreeType2Impl::FreeType2Impl()
+    : mGlyphCache( defaultCacheSize ), mShapeCache( defaultCacheSize )
 {
     FT_Init_FreeType(&(this->mLibrary) );
 
@@ -154,6 +276,9 @@ FreeType2Impl::FreeType2Impl()
     mFn.conic_to = FreeType2Impl::coFn;
 
     mIsFaceAvailable = false;
+    mFontHeight      = 0;
+    mHb_buffer       = hb_buffer_create ();
+    CV_Assert( mHb_buffer != NULL );
 }
 
 FreeType2Impl::~FreeType2Impl()
@@ -163,6 +288,7 @@ FreeType2Impl::~FreeType2Impl()
         CV_Assert(!FT_Done_Face(mFace));
         mIsFaceAvailable = false;
     }
+    hb_buffer_destroy (mHb_buffer);
     CV_Assert(!FT_Done_FreeType(mLibrary));
 }
 
@@ -172,6 +298,12 @@ void FreeType2Impl::loadFontData(String fontFileName, int idx)
         hb_font_destroy (mHb_font);
         CV_Assert(!FT_Done_Face(mFace));
     }
+    // The cached glyphs belong to the previous font
+    mGlyphCache.clear();
+    mShapeCache.clear();
+    mFontHeight = 0;
+    mIsFaceAvailable = false;
+
     CV_Assert(!FT_New_Face( mLibrary, fontFileName.c_str(), idx, &(mFace) ) );
     mHb_font = hb_ft_font_create (mFace, NULL);
     CV_Assert( mHb_font != NULL );
@@ -183,11 +315,115 @@ void FreeType2Impl::setSplitNumber(int num ){
     mCtoL        = num;
 }
 
+void FreeType2Impl::setCacheSize(int num ){
+    CV_Assert( num > 0 );
+    mGlyphCache.setCapacity( num );
+    mShapeCache.setCapacity( num );
+}
+
+void FreeType2Impl::setFontHeight( int _fontHeight )
+{
+    if ( mFontHeight != _fontHeight ) {
+        CV_Assert(!FT_Set_Pixel_Sizes( mFace, _fontHeight, _fontHeight ));
+        mFontHeight = _fontHeight;
+    }
+}
+
+const std::vector< unsigned int >& FreeType2Impl::shapeText( const String& _text )
+{
+    std::string key( _text.c_str() );
+    std::vector< unsigned int > *cached = mShapeCache.get( key );
+    if ( cached != NULL ) {
+        return *cached;
+    }
+
+    hb_buffer_reset (mHb_buffer);
+    hb_buffer_add_utf8 (mHb_buffer, _text.c_str(), -1, 0, -1);
+    hb_buffer_guess_segment_properties (mHb_buffer);
+    hb_shape (mHb_font, mHb_buffer, NULL, 0);
+
+    // The glyph infos are read after shaping, which may merge or split the characters
+    unsigned int textLen;
+    hb_glyph_info_t *info =
+        hb_buffer_get_glyph_infos(mHb_buffer,&textLen );
+    CV_Assert( info != NULL || textLen == 0 );
+
+    std::vector< unsigned int > glyphs( textLen );
+    for( unsigned int i = 0 ; i < textLen ; i ++ ){
+        glyphs[i] = info[i].codepoint;
+    }
+    return mShapeCache.put( key, glyphs );
+}
+
+FreeType2Impl::CachedGlyph& FreeType2Impl::getGlyph( unsigned int glyphIndex, GlyphMode mode )
+{
+    const uint64 key = ( (uint64)mFontHeight << 34 ) | ( (uint64)mode << 32 ) | glyphIndex;
+    CachedGlyph *cached = mGlyphCache.get( key );
+    if ( cached != NULL ) {
+        return *cached;
+    }
+
+    CV_Assert(!FT_Load_Glyph(mFace, glyphIndex, 0 ));
+
+    CachedGlyph glyph;
+    glyph.advance  = mFace->glyph->advance;
+    glyph.bearingX = mFace->glyph->metrics.horiBearingX >> 6;
+    glyph.bearingY = mFace->glyph->metrics.horiBearingY >> 6;
+    glyph.flags    = 0;
+
+    if ( mode == GLYPH_OUTLINE ) {
+        const FT_Outline& src = mFace->glyph->outline;
+        if ( src.n_points > 0 ) {
+            glyph.points.assign( src.points, src.points + src.n_points );
+            glyph.tags.assign( src.tags, src.tags + src.n_points );
+        }
+        if ( src.n_contours > 0 ) {
+            glyph.contours.assign( src.contours, src.contours + src.n_contours );
+        }
+        glyph.flags = src.flags;
+
+        // Flip ( in FreeType coordinates )
+        FT_Outline outline = glyph.outline();
+        FT_Matrix mtx = { 1 << 16 , 0 , 0 , -(1 << 16) };
+        FT_Outline_Transform(&outline, &mtx);
+    }else{
+        CV_Assert( !FT_Render_Glyph( mFace->glyph,
+            ( mode == GLYPH_MONO ) ? FT_RENDER_MODE_MONO : FT_RENDER_MODE_NORMAL ) );
+        const FT_Bitmap *bmp = &(mFace->glyph->bitmap);
+        glyph.bitmap.create( (int)bmp->rows, (int)bmp->width, CV_8UC1 );
+        for (int row = 0; row < (int)bmp->rows; row ++) {
+            const uchar *src = bmp->buffer + row * bmp->pitch;
+            uchar *dst = glyph.bitmap.ptr<uchar>( row );
+            if ( mode == GLYPH_MONO ) {
+                // Unpack the bits, the most significant bit first
+                for (int col = 0; col < (int)bmp->width; col ++) {
+                    dst[col] = ( src[col >> 3] >> ( 7 - ( col & 7 ) ) ) & 0x01;
+                }
+            }else{
+                memcpy( dst, src, bmp->width );
+            }
+        }
+    }
+
+    return mGlyphCache.put( key, glyph );
+}
+
 void FreeType2Impl::putText(
     InputOutputArray _img, const String& _text, Point _org,
     int _fontHeight, Scalar _color,
     int _thickness, int _line_type, bool _bottomLeftOrigin
 )
+{
+    putTexts( _img, std::vector<String>( 1, _text ), std::vector<Point>( 1, _org ),
+        _fontHeight, _color, _thickness, _line_type, _bottomLeftOrigin );
+}
+
+void FreeType2Impl::putTexts(
+    InputOutputArray _img, const std::vector<String>& _texts,
+    const std::vector<Point>& _orgs,
+    int _fontHeight, Scalar _color,
+    int _thickness, int _line_type, bool _bottomLeftOrigin
+)
 {
     CV_Assert( mIsFaceAvailable == true );
     CV_Assert( ( _img.empty()    == false ) &&
@@ -199,11 +435,8 @@ void FreeType2Impl::putText(
                ( _line_type == 4 ) ||
                ( _line_type == 8 ) );
     CV_Assert( _fontHeight >= 0 );
+    CV_Assert( _texts.size() == _orgs.size() );
 
-    if ( _text.empty() )
-    {
-         return;
-    }
     if ( _fontHeight == 0 )
     {
          return;
@@ -213,20 +446,32 @@ void FreeType2Impl::putText(
         _line_type = 8;
     }
 
-    CV_Assert(!FT_Set_Pixel_Sizes( mFace, _fontHeight, _fontHeight ));
+    setFontHeight( _fontHeight );
+
+    // The strings are drawn in order, so the later ones are on top
+    for( size_t i = 0 ; i < _texts.size() ; i ++ ){
+        if ( _texts[i].empty() )
+        {
+             continue;
+        }
+        putTextCached( _img, _texts[i], _orgs[i], _fontHeight, _color,
+            _thickness, _line_type, _bottomLeftOrigin );
+    }
+}
 
+void FreeType2Impl::putTextCached(
+    InputOutputArray _img, const String& _text, Point _org,
+    int _fontHeight, Scalar _color,
+    int _thickness, int _line_type, bool _bottomLeftOrigin
+)
+{
     if( _thickness < 0 ) // CV_FILLED
     {
-        if ( _line_type == CV_AA ) {
-            putTextBitmapBlend( _img, _text, _org, _fontHeight, _color,
-                _thickness, _line_type, _bottomLeftOrigin );
-        }else{
-            putTextBitmapMono( _img, _text, _org, _fontHeight, _color,
-                _thickness, _line_type, _bottomLeftOrigin );
-        }
+        putTextBitmap( _img, _text, _org, _fontHeight, _color,
+            ( _line_type == CV_AA ) ? GLYPH_GRAY : GLYPH_MONO, _bottomLeftOrigin );
     }else{
-            putTextOutline( _img, _text, _org, _fontHeight, _color,
-                _thickness, _line_type, _bottomLeftOrigin );
+        putTextOutline( _img, _text, _org, _fontHeight, _color,
+            _thickness, _line_type, _bottomLeftOrigin );
     }
 }
 
@@ -235,20 +480,9 @@ void FreeType2Impl::putTextOutline(
    int _fontHeight, Scalar _color,
    int _thickness, int _line_type, bool _bottomLeftOrigin )
 {
-    hb_buffer_t *hb_buffer = hb_buffer_create ();
-    CV_Assert( hb_buffer != NULL );
-
-    unsigned int textLen;
-    hb_buffer_guess_segment_properties (hb_buffer);
-    hb_buffer_add_utf8 (hb_buffer, _text.c_str(), -1, 0, -1);
+    const std::vector< unsigned int >& glyphs = shapeText( _text );
     FT_Vector currentPos = {0,0};
 
-    hb_glyph_info_t *info =
-        hb_buffer_get_glyph_infos(hb_buffer,&textLen );
-    CV_Assert( info != NULL );
-
-    hb_shape (mHb_font, hb_buffer, NULL, 0);
-
     PathUserData *userData = new PathUserData( _img );
     userData->mColor     = _color;
     userData->mCtoL      = mCtoL;
@@ -264,15 +498,9 @@ void FreeType2Impl::putTextOutline(
         currentPos.y += _fontHeight * 64;
     }
 
-    for( unsigned int i = 0 ; i < textLen ; i ++ ){
-        CV_Assert(!FT_Load_Glyph(mFace, info[i].codepoint, 0 ));
-
-        FT_GlyphSlot slot  = mFace->glyph;
-        FT_Outline outline = slot->outline;
-
-        // Flip ( in FreeType coordinates )
-        FT_Matrix mtx = { 1 << 16 , 0 , 0 , -(1 << 16) };
-        FT_Outline_Transform(&outline, &mtx);
+    for( size_t i = 0 ; i < glyphs.size() ; i ++ ){
+        CachedGlyph& glyph = getGlyph( glyphs[i], GLYPH_OUTLINE );
+        FT_Outline outline = glyph.outline();
 
         // Move to current position ( in FreeType coordinates )
         FT_Outline_Translate(&outline,
@@ -282,160 +510,114 @@ void FreeType2Impl::putTextOutline(
         // Draw ( in FreeType coordinates )
         CV_Assert( !FT_Outline_Decompose(&outline, &mFn, (void*)userData) );
 
+        // Restore the cached outline ( in FreeType coordinates )
+        FT_Outline_Translate(&outline,
+                             -currentPos.x,
+                             -currentPos.y);
+
         // Draw (Last Path) ( in FreeType coordinates )
         mvFn( NULL, (void*)userData );
 
         // Update current position ( in FreeType coordinates )
-        currentPos.x += mFace->glyph->advance.x;
-        currentPos.y += mFace->glyph->advance.y;
+        currentPos.x += glyph.advance.x;
+        currentPos.y += glyph.advance.y;
    }
    delete userData;
-   hb_buffer_destroy (hb_buffer);
 }
 
-void FreeType2Impl::putTextBitmapMono(
-   InputOutputArray _img, const String& _text, Point _org,
-   int _fontHeight, Scalar _color,
-   int _thickness, int _line_type, bool _bottomLeftOrigin )
+/**
+ * Blend the color over the BGR pixels, with the coverage in [0, 255]
+ * of the glyph as alpha, rounding ( color * a + dst * ( 255 - a ) ) / 255
+ */
+static void blendRow( const uchar *cover, uchar *dst, int len, const uchar *color )
 {
-    CV_Assert( _thickness < 0 );
-    CV_Assert( _line_type == 4 || _line_type == 8);
-
-    Mat dst = _img.getMat();
-    hb_buffer_t *hb_buffer = hb_buffer_create ();
-    CV_Assert( hb_buffer != NULL );
-
-    unsigned int textLen;
-    hb_buffer_guess_segment_properties (hb_buffer);
-    hb_buffer_add_utf8 (hb_buffer, _text.c_str(), -1, 0, -1);
-    hb_glyph_info_t *info =
-        hb_buffer_get_glyph_infos(hb_buffer,&textLen );
-    CV_Assert( info != NULL );
-
-    hb_shape (mHb_font, hb_buffer, NULL, 0);
-
-    _org.y += _fontHeight;
-    if( _bottomLeftOrigin == true ){
-        _org.y -= _fontHeight;
+    int col = 0;
+#if CV_SIMD128
+    const v_uint16x8 v255 = v_setall_u16( 255 ), v128 = v_setall_u16( 128 );
+    const v_uint16x8 vColor[3] = { v_setall_u16( color[0] ),
+                                   v_setall_u16( color[1] ),
+                                   v_setall_u16( color[2] ) };
+    for( ; col <= len - 16 ; col += 16 ){
+        v_uint16x8 a0, a1;
+        v_expand( v_load( cover + col ), a0, a1 );
+        const v_uint16x8 na0 = v255 - a0, na1 = v255 - a1;
+
+        v_uint8x16 ch[3];
+        v_load_deinterleave( dst + col * 3, ch[0], ch[1], ch[2] );
+        for( int c = 0 ; c < 3 ; c ++ ){
+            v_uint16x8 d0, d1;
+            v_expand( ch[c], d0, d1 );
+            v_uint16x8 t0 = vColor[c] * a0 + d0 * na0 + v128;
+            v_uint16x8 t1 = vColor[c] * a1 + d1 * na1 + v128;
+            t0 = ( t0 + ( t0 >> 8 ) ) >> 8;
+            t1 = ( t1 + ( t1 >> 8 ) ) >> 8;
+            ch[c] = v_pack( t0, t1 );
+        }
+        v_store_interleave( dst + col * 3, ch[0], ch[1], ch[2] );
     }
-
-    for( unsigned int i = 0 ; i < textLen ; i ++ ){
-        CV_Assert( !FT_Load_Glyph(mFace, info[i].codepoint, 0 ) );
-        CV_Assert( !FT_Render_Glyph( mFace->glyph, FT_RENDER_MODE_MONO ) );
-        FT_Bitmap    *bmp = &(mFace->glyph->bitmap);
-
-        Point gPos = _org;
-        gPos.y -= ( mFace->glyph->metrics.horiBearingY >> 6) ;
-        gPos.x += ( mFace->glyph->metrics.horiBearingX >> 6) ;
-
-        for (int row = 0; row < (int)bmp->rows; row ++) {
-            if( gPos.y + row < 0 ) {
-                continue;
-            }
-            if( gPos.y + row >= dst.rows ) {
-                break;
-            }
-
-            for (int col = 0; col < bmp->pitch; col ++) {
-                int cl = bmp->buffer[ row * bmp->pitch + col ];
-                if ( cl == 0 ) {
-                    continue;
-                }
-                for(int bit = 7; bit >= 0; bit -- ){
-                    if( gPos.x + col * 8 + (7 - bit) < 0 )
-                    {
-                        continue;
-                    }
-                    if( gPos.x + col * 8 + (7 - bit) >= dst.cols )
-                    {
-                        break;
-                    }
-
-                    if ( ( (cl >> bit) & 0x01 ) == 1 ) {
-                        cv::Vec3b* ptr = dst.ptr<cv::Vec3b>( gPos.y + row,  gPos.x + col * 8 + (7 - bit) );
-                        (*ptr)[0] = _color[0];
-                        (*ptr)[1] = _color[1];
-                        (*ptr)[2] = _color[2];
-                    }
-                }
-            }
+#endif
+    for( ; col < len ; col ++ ){
+        int a = cover[col];
+        if ( a == 0 ) {
+            continue;
+        }
+        for( int c = 0 ; c < 3 ; c ++ ){
+            int t = color[c] * a + dst[col * 3 + c] * ( 255 - a ) + 128;
+            dst[col * 3 + c] = (uchar)( ( t + ( t >> 8 ) ) >> 8 );
         }
-
-        _org.x += ( mFace->glyph->advance.x ) >> 6;
-        _org.y += ( mFace->glyph->advance.y ) >> 6;
     }
-    hb_buffer_destroy (hb_buffer);
 }
 
-void FreeType2Impl::putTextBitmapBlend(
+void FreeType2Impl::putTextBitmap(
    InputOutputArray _img, const String& _text, Point _org,
    int _fontHeight, Scalar _color,
-   int _thickness, int _line_type, bool _bottomLeftOrigin )
+   GlyphMode mode, bool _bottomLeftOrigin )
 {
-    CV_Assert( _thickness < 0 );
-    CV_Assert( _line_type == 16 );
-
     Mat dst = _img.getMat();
-    hb_buffer_t *hb_buffer = hb_buffer_create ();
-    CV_Assert( hb_buffer != NULL );
-
-    unsigned int textLen;
-    hb_buffer_guess_segment_properties (hb_buffer);
-    hb_buffer_add_utf8 (hb_buffer, _text.c_str(), -1, 0, -1);
-    hb_glyph_info_t *info =
-        hb_buffer_get_glyph_infos(hb_buffer,&textLen );
-    CV_Assert( info != NULL );
-
-    hb_shape (mHb_font, hb_buffer, NULL, 0);
+    const std::vector< unsigned int >& glyphs = shapeText( _text );
+    const uchar color[3] = { saturate_cast<uchar>( _color[0] ),
+                             saturate_cast<uchar>( _color[1] ),
+                             saturate_cast<uchar>( _color[2] ) };
 
     _org.y += _fontHeight;
     if( _bottomLeftOrigin == true ){
         _org.y -= _fontHeight;
     }
 
-    for( unsigned int i = 0 ; i < textLen ; i ++ ){
-        CV_Assert( !FT_Load_Glyph(mFace, info[i].codepoint, 0 ) );
-        CV_Assert( !FT_Render_Glyph( mFace->glyph, FT_RENDER_MODE_NORMAL ) );
-        FT_Bitmap    *bmp = &(mFace->glyph->bitmap);
+    for( size_t i = 0 ; i < glyphs.size() ; i ++ ){
+        const CachedGlyph& glyph = getGlyph( glyphs[i], mode );
+        const Mat& bmp = glyph.bitmap;
 
         Point gPos = _org;
-        gPos.y -= ( mFace->glyph->metrics.horiBearingY >> 6) ;
-        gPos.x += ( mFace->glyph->metrics.horiBearingX >> 6) ;
-
-        for (int row = 0; row < (int)bmp->rows; row ++) {
-            if( gPos.y + row < 0 ) {
-                continue;
-            }
-            if( gPos.y + row >= dst.rows ) {
-                break;
-            }
-
-            for (int col = 0; col < bmp->pitch; col ++) {
-                int cl = bmp->buffer[ row * bmp->pitch + col ];
-                if ( cl == 0 ) {
-                    continue;
-                }
-                if( gPos.x + col < 0 )
-                {
-                    continue;
-                }
-                if( gPos.x + col >= dst.cols )
-                {
-                    break;
+        gPos.y -= glyph.bearingY;
+        gPos.x += glyph.bearingX;
+
+        // Clip the glyph to the image
+        const int colStart = std::max( 0, -gPos.x );
+        const int colEnd   = std::min( bmp.cols, dst.cols - gPos.x );
+        const int rowStart = std::max( 0, -gPos.y );
+        const int rowEnd   = ( colStart < colEnd ) ? std::min( bmp.rows, dst.rows - gPos.y ) : 0;
+
+        for (int row = rowStart; row < rowEnd; row ++) {
+            const uchar *cover = bmp.ptr<uchar>( row ) + colStart;
+            uchar *ptr = dst.ptr<uchar>( gPos.y + row ) + ( gPos.x + colStart ) * 3;
+            const int len = colEnd - colStart;
+            if ( mode == GLYPH_GRAY ) {
+                blendRow( cover, ptr, len, color );
+            }else{
+                for (int col = 0; col < len; col ++) {
+                    if ( cover[col] ) {
+                        ptr[col * 3 + 0] = color[0];
+                        ptr[col * 3 + 1] = color[1];
+                        ptr[col * 3 + 2] = color[2];
+                    }
                 }
-
-                cv::Vec3b* ptr = dst.ptr<cv::Vec3b>( gPos.y + row , gPos.x + col);
-                double blendAlpha = (double ) cl / 255.0;
-
-                (*ptr)[0] = (double) _color[0] * blendAlpha + (*ptr)[0] * (1.0 - blendAlpha );
-                (*ptr)[1] = (double) _color[1] * blendAlpha + (*ptr)[1] * (1.0 - blendAlpha );
-                (*ptr)[2] = (double) _color[2] * blendAlpha + (*ptr)[2] * (1.0 - blendAlpha );
             }
         }
-        _org.x += ( mFace->glyph->advance.x ) >> 6;
-        _org.y += ( mFace->glyph->advance.y ) >> 6;
+
+        _org.x += ( glyph.advance.x ) >> 6;
+        _org.y += ( glyph.advance.y ) >> 6;
     }
-    hb_buffer_destroy (hb_buffer);
 }
 
 Size FreeType2Impl::getTextSize(
@@ -455,35 +637,21 @@ Size FreeType2Impl::getTextSize(
          return Size(0,0);
     }
 
-    CV_Assert(!FT_Set_Pixel_Sizes( mFace, _fontHeight, _fontHeight ));
+    CV_Assert( mIsFaceAvailable == true );
+    setFontHeight( _fontHeight );
 
-    hb_buffer_t *hb_buffer = hb_buffer_create ();
-    CV_Assert( hb_buffer != NULL );
+    const std::vector< unsigned int >& glyphs = shapeText( _text );
     FT_Vector currentPos = {0,0};
 
-    unsigned int textLen;
-    hb_buffer_guess_segment_properties (hb_buffer);
-    hb_buffer_add_utf8 (hb_buffer, _text.c_str(), -1, 0, -1);
-    hb_glyph_info_t *info =
-        hb_buffer_get_glyph_infos(hb_buffer,&textLen );
-    CV_Assert( info != NULL );
-    hb_shape (mHb_font, hb_buffer, NULL, 0);
-
     // Initilize BoundaryBox ( in OpenCV coordinates )
     int xMin = INT_MAX, yMin = INT_MAX;
     int xMax = INT_MIN, yMax = INT_MIN;
 
-    for( unsigned int i = 0 ; i < textLen ; i ++ ){
-        CV_Assert(!FT_Load_Glyph(mFace, info[i].codepoint, 0 ));
-
-        FT_GlyphSlot slot  = mFace->glyph;
-        FT_Outline outline = slot->outline;
+    for( size_t i = 0 ; i < glyphs.size() ; i ++ ){
+        CachedGlyph& glyph = getGlyph( glyphs[i], GLYPH_OUTLINE );
+        FT_Outline outline = glyph.outline();
         FT_BBox bbox ;
 
-        // Flip ( in FreeType coordinates )
-        FT_Matrix mtx = { 1 << 16 , 0 , 0 , -(1 << 16) };
-        FT_Outline_Transform(&outline, &mtx);
-
         // Move to current position ( in FreeType coordinates )
         FT_Outline_Translate(&outline,
                              currentPos.x,
@@ -492,6 +660,11 @@ Size FreeType2Impl::getTextSize(
         // Get BoundaryBox ( in FreeType coordinatrs )
         CV_Assert( !FT_Outline_Get_BBox( &outline, &bbox ) );
 
+        // Restore the cached outline ( in FreeType coordinates )
+        FT_Outline_Translate(&outline,
+                             -currentPos.x,
+                             -currentPos.y );
+
         // If codepoint is space(0x20), it has no glyph.
         // A dummy boundary box is needed when last code is space.
         if(
@@ -499,14 +672,14 @@ Size FreeType2Impl::getTextSize(
             (bbox.yMin == 0 ) && (bbox.yMax == 0 )
         ){
             bbox.xMin = currentPos.x ;
-            bbox.xMax = currentPos.x + ( mFace->glyph->advance.x );
+            bbox.xMax = currentPos.x + ( glyph.advance.x );
             bbox.yMin = yMin;
             bbox.yMax = yMax;
         }
 
         // Update current position ( in FreeType coordinates )
-        currentPos.x += mFace->glyph->advance.x;
-        currentPos.y += mFace->glyph->advance.y;
+        currentPos.x += glyph.advance.x;
+        currentPos.y += glyph.advance.y;
 
         // Update BoundaryBox ( in OpenCV coordinates )
         xMin = cv::min ( xMin, ftd(bbox.xMin) );
@@ -515,8 +688,6 @@ Size FreeType2Impl::getTextSize(
         yMax = cv::max ( yMax, ftd(bbox.yMax) );
     }
 
-    hb_buffer_destroy (hb_buffer);
-
     // Calcurate width/height/baseline ( in OpenCV coordinates )
     int width  = xMax - xMin ;
     int height = -yMin ;
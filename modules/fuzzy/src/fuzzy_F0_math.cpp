@@ -40,9 +40,333 @@
 //M*/
 
 #include "precomp.hpp"
+#include "fuzzy_F0_separable.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 using namespace cv;
 
+namespace
+{
+    // dst += a * src
+    void axpy(float a, const float* src, float* dst, int n)
+    {
+        int x = 0;
+
+#if CV_SIMD128
+        v_float32x4 va = v_setall_f32(a);
+
+        for (; x <= n - 4; x += 4)
+        {
+            v_store(dst + x, v_muladd(va, v_load(src + x), v_load(dst + x)));
+        }
+#endif
+
+        for (; x < n; x++)
+        {
+            dst[x] += a * src[x];
+        }
+    }
+}
+
+bool ft::detail::separateKernel(const Mat& kernel, std::vector<float>& kx, std::vector<float>& ky)
+{
+    if (kernel.empty() || kernel.cols % 2 == 0 || kernel.rows % 2 == 0 || kernel.cols < 3 || kernel.rows < 3)
+    {
+        return false;
+    }
+
+    Mat kernelFloat;
+    kernel.convertTo(kernelFloat, CV_32F);
+
+    std::vector<Mat> channels;
+    split(kernelFloat, channels);
+
+    for (size_t c = 1; c < channels.size(); c++)
+    {
+        if (norm(channels[c], channels[0], NORM_INF) != 0)
+        {
+            return false;
+        }
+    }
+
+    const Mat& k = channels[0];
+
+    double maxValue;
+    Point maxLoc;
+    minMaxLoc(abs(k), NULL, &maxValue, NULL, &maxLoc);
+
+    if (maxValue == 0)
+    {
+        return false;
+    }
+
+    const float pivot = k.at<float>(maxLoc);
+
+    kx.assign(k.ptr<float>(maxLoc.y), k.ptr<float>(maxLoc.y) + k.cols);
+    ky.resize(k.rows);
+
+    for (int y = 0; y < k.rows; y++)
+    {
+        ky[y] = k.at<float>(y, maxLoc.x) / pivot;
+    }
+
+    const double tolerance = maxValue * 1e-5;
+
+    for (int y = 0; y < k.rows; y++)
+    {
+        const float* kRow = k.ptr<float>(y);
+
+        for (int x = 0; x < k.cols; x++)
+        {
+            if (std::abs(kRow[x] - ky[y] * kx[x]) > tolerance)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int ft::detail::separableComponents(const Mat& image, const Mat& mask, const std::vector<float>& kx, const std::vector<float>& ky,
+                                    const Mat& active, Mat& components, Mat& defined)
+{
+    const int cn = image.channels();
+    const int width = image.cols;
+    const int height = image.rows;
+    const int radiusX = ((int)kx.size() - 1) / 2;
+    const int radiusY = ((int)ky.size() - 1) / 2;
+    const int An = width / radiusX + 1;
+    const int Bn = height / radiusY + 1;
+
+    CV_Assert(mask.size() == image.size() && mask.channels() == 1);
+    CV_Assert(active.empty() || (active.type() == CV_8UC1 && active.rows == Bn && active.cols == An));
+
+    Mat imageFloat;
+    image.convertTo(imageFloat, CV_32F);
+
+    Mat maskBinary;
+    compare(mask, 0, maskBinary, CMP_NE);
+
+    // the masked image and the mask as 0/1, so that the numerator and the denominator of all the
+    // components are weighted sums of their rows
+    Mat masked(height, width * cn, CV_32F);
+    Mat maskFloat(height, width, CV_32F);
+
+    parallel_for_(Range(0, height), [&](const Range& range)
+    {
+        for (int y = range.start; y < range.end; y++)
+        {
+            const float* imageRow = imageFloat.ptr<float>(y);
+            const uchar* maskRow = maskBinary.ptr<uchar>(y);
+            float* maskedRow = masked.ptr<float>(y);
+            float* maskFloatRow = maskFloat.ptr<float>(y);
+
+            for (int x = 0; x < width; x++)
+            {
+                const bool valid = maskRow[x] != 0;
+
+                maskFloatRow[x] = valid ? 1.0f : 0.0f;
+
+                for (int c = 0; c < cn; c++)
+                {
+                    maskedRow[x * cn + c] = valid ? imageRow[x * cn + c] : 0.0f;
+                }
+            }
+        }
+    });
+
+    components.create(Bn, An, CV_MAKETYPE(CV_32F, cn));
+    defined.create(Bn, An, CV_8UC1);
+
+    parallel_for_(Range(0, Bn), [&](const Range& range)
+    {
+        std::vector<float> columnNumerator(width * cn);
+        std::vector<float> columnDenominator(width);
+        std::vector<double> numerator(cn);
+
+        for (int o = range.start; o < range.end; o++)
+        {
+            const uchar* activeRow = active.empty() ? NULL : active.ptr<uchar>(o);
+            float* componentsRow = components.ptr<float>(o);
+            uchar* definedRow = defined.ptr<uchar>(o);
+
+            int first = 0, last = An - 1;
+
+            if (activeRow)
+            {
+                while (first < An && !activeRow[first])
+                {
+                    first++;
+                }
+                while (last >= first && !activeRow[last])
+                {
+                    last--;
+                }
+            }
+
+            std::fill(componentsRow, componentsRow + An * cn, 0.0f);
+            std::fill(definedRow, definedRow + An, (uchar)1);
+
+            if (first > last)
+            {
+                continue;
+            }
+
+            // column pass over the span of the computed components
+            const int xStart = std::max(first * radiusX - radiusX, 0);
+            const int xEnd = std::min(last * radiusX + radiusX + 1, width);
+
+            std::fill(columnNumerator.begin() + xStart * cn, columnNumerator.begin() + xEnd * cn, 0.0f);
+            std::fill(columnDenominator.begin() + xStart, columnDenominator.begin() + xEnd, 0.0f);
+
+            for (int v = 0; v < (int)ky.size(); v++)
+            {
+                const int y = o * radiusY - radiusY + v;
+
+                if (y < 0 || y >= height || ky[v] == 0)
+                {
+                    continue;
+                }
+
+                axpy(ky[v], masked.ptr<float>(y) + xStart * cn, &columnNumerator[xStart * cn], (xEnd - xStart) * cn);
+                axpy(ky[v], maskFloat.ptr<float>(y) + xStart, &columnDenominator[xStart], xEnd - xStart);
+            }
+
+            // row pass
+            for (int i = first; i <= last; i++)
+            {
+                if (activeRow && !activeRow[i])
+                {
+                    continue;
+                }
+
+                const int x0 = i * radiusX - radiusX;
+                const int uStart = std::max(-x0, 0);
+                const int uEnd = std::min((int)kx.size(), width - x0);
+
+                double denominator = 0;
+                std::fill(numerator.begin(), numerator.end(), 0.0);
+
+                for (int u = uStart; u < uEnd; u++)
+                {
+                    const int x = x0 + u;
+
+                    denominator += kx[u] * columnDenominator[x];
+
+                    for (int c = 0; c < cn; c++)
+                    {
+                        numerator[c] += kx[u] * columnNumerator[x * cn + c];
+                    }
+                }
+
+                if (denominator == 0)
+                {
+                    definedRow[i] = 0;
+                    continue;
+                }
+
+                for (int c = 0; c < cn; c++)
+                {
+                    componentsRow[i * cn + c] = (float)(numerator[c] / denominator);
+                }
+            }
+        }
+    });
+
+    return Bn * An - countNonZero(defined);
+}
+
+void ft::detail::separableInverse(const Mat& components, const std::vector<float>& kx, const std::vector<float>& ky,
+                                  Size size, OutputArray output)
+{
+    const int cn = components.channels();
+    const int width = size.width;
+    const int height = size.height;
+    const int radiusX = ((int)kx.size() - 1) / 2;
+    const int radiusY = ((int)ky.size() - 1) / 2;
+    const int An = components.cols;
+    const int Bn = components.rows;
+
+    CV_Assert(components.depth() == CV_32F);
+
+    // every row of components spread along the x axis
+    Mat spread(Bn, width * cn, CV_32F, Scalar(0));
+
+    parallel_for_(Range(0, Bn), [&](const Range& range)
+    {
+        for (int o = range.start; o < range.end; o++)
+        {
+            const float* componentsRow = components.ptr<float>(o);
+            float* spreadRow = spread.ptr<float>(o);
+
+            for (int i = 0; i < An; i++)
+            {
+                const int x0 = i * radiusX - radiusX;
+                const int uStart = std::max(-x0, 0);
+                const int uEnd = std::min((int)kx.size(), width - x0);
+
+                for (int u = uStart; u < uEnd; u++)
+                {
+                    for (int c = 0; c < cn; c++)
+                    {
+                        spreadRow[(x0 + u) * cn + c] += componentsRow[i * cn + c] * kx[u];
+                    }
+                }
+            }
+        }
+    });
+
+    output.create(height, width, CV_MAKETYPE(CV_32F, cn));
+    Mat outputMat = output.getMat();
+
+    parallel_for_(Range(0, height), [&](const Range& range)
+    {
+        for (int y = range.start; y < range.end; y++)
+        {
+            float* outputRow = outputMat.ptr<float>(y);
+
+            std::fill(outputRow, outputRow + width * cn, 0.0f);
+
+            // the components whose basic function covers the row
+            const int oStart = std::max((y + radiusY - 1) / radiusY - 1, 0);
+            const int oEnd = std::min(y / radiusY + 1, Bn - 1);
+
+            for (int o = oStart; o <= oEnd; o++)
+            {
+                const int v = y - o * radiusY + radiusY;
+
+                if (v < 0 || v >= (int)ky.size() || ky[v] == 0)
+                {
+                    continue;
+                }
+
+                axpy(ky[v], spread.ptr<float>(o), outputRow, width * cn);
+            }
+        }
+    });
+}
+
+void ft::detail::clearUndefined(const Mat& defined, int radiusX, int radiusY, Mat& mask)
+{
+    const Rect image(0, 0, mask.cols, mask.rows);
+
+    for (int o = 0; o < defined.rows; o++)
+    {
+        const uchar* definedRow = defined.ptr<uchar>(o);
+
+        for (int i = 0; i < defined.cols; i++)
+        {
+            if (!definedRow[i])
+            {
+                Rect area(i * radiusX - radiusX + 1, o * radiusY - radiusY + 1, 2 * radiusX - 1, 2 * radiusY - 1);
+
+                mask(area & image).setTo(0);
+            }
+        }
+    }
+}
+
 void ft::FT02D_FL_process(InputArray matrix, const int radius, OutputArray output)
 {
     CV_Assert(matrix.channels() == 3);
@@ -316,6 +640,17 @@ void ft::FT02D_components(InputArray matrix, InputArray kernel, OutputArray comp
         inputMask = mask.getMat();
     }
 
+    std::vector<float> kx, ky;
+
+    if (detail::separateKernel(kernel.getMat(), kx, ky))
+    {
+        Mat componentsMat, defined;
+        detail::separableComponents(matrix.getMat(), inputMask, kx, ky, Mat(), componentsMat, defined);
+        componentsMat.copyTo(components);
+
+        return;
+    }
+
     int radiusX = (kernel.cols() - 1) / 2;
     int radiusY = (kernel.rows() - 1) / 2;
     int An = matrix.cols() / radiusX + 1;
@@ -362,6 +697,15 @@ void ft::FT02D_inverseFT(InputArray components, InputArray kernel, OutputArray o
 
     Mat componentsMat = components.getMat();
 
+    std::vector<float> kx, ky;
+
+    if (detail::separateKernel(kernel.getMat(), kx, ky))
+    {
+        detail::separableInverse(componentsMat, kx, ky, Size(width, height), output);
+
+        return;
+    }
+
     int radiusX = (kernel.cols() - 1) / 2;
     int radiusY = (kernel.rows() - 1) / 2;
     int outputWidthPadded = radiusX + width + kernel.cols();
@@ -409,6 +753,17 @@ void ft::FT02D_process(InputArray matrix, InputArray kernel, OutputArray output,
         inputMask = mask.getMat();
     }
 
+    std::vector<float> kx, ky;
+
+    if (detail::separateKernel(kernel.getMat(), kx, ky))
+    {
+        Mat components, defined;
+        detail::separableComponents(matrix.getMat(), inputMask, kx, ky, Mat(), components, defined);
+        detail::separableInverse(components, kx, ky, matrix.size(), output);
+
+        return;
+    }
+
     int radiusX = (kernel.cols() - 1) / 2;
     int radiusY = (kernel.rows() - 1) / 2;
     int An = matrix.cols() / radiusX + 1;
@@ -478,6 +833,29 @@ int ft::FT02D_iteration(InputArray matrix, InputArray kernel, OutputArray output
         maskOutput.setTo(1);
     }
 
+    std::vector<float> kx, ky;
+
+    if (detail::separateKernel(kernel.getMat(), kx, ky))
+    {
+        Mat components, defined;
+        undefinedComponents = detail::separableComponents(matrix.getMat(), mask.getMat(), kx, ky, Mat(), components, defined);
+
+        if (firstStop && undefinedComponents > 0)
+        {
+            return -1;
+        }
+
+        detail::separableInverse(components, kx, ky, matrix.size(), output);
+
+        if (maskOutput.needed())
+        {
+            Mat maskOutputMat = maskOutput.getMat();
+            detail::clearUndefined(defined, radiusX, radiusY, maskOutputMat);
+        }
+
+        return undefinedComponents;
+    }
+
     Mat matrixOutputMat = Mat::zeros(outputHeightPadded, outputWidthPadded, CV_MAKETYPE(CV_32F, matrix.channels()));
     Mat maskOutputMat = Mat::ones(outputHeightPadded, outputWidthPadded, CV_8UC1);
 
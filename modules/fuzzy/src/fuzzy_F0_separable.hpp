@@ -0,0 +1,51 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_FUZZY_F0_SEPARABLE_H__
+#define __OPENCV_FUZZY_F0_SEPARABLE_H__
+
+#include "opencv2/core.hpp"
+
+#include <vector>
+
+namespace cv
+{
+
+namespace ft
+{
+
+namespace detail
+{
+    /*
+     * Splits the kernel into kernel(y, x) = ky[y] * kx[x]. Returns false if the kernel is not
+     * such an outer product, or if its channels are not all the same.
+     */
+    bool separateKernel(const Mat& kernel, std::vector<float>& kx, std::vector<float>& ky);
+
+    /*
+     * F0 components of the masked image computed with a column pass followed by a row pass. Only
+     * the components set in active are computed when it is not empty, the other ones are set to 0
+     * and counted as defined. The components with no masked pixel under their basic function are
+     * set to 0 and cleared in defined, their number is returned.
+     */
+    int separableComponents(const Mat& image, const Mat& mask, const std::vector<float>& kx, const std::vector<float>& ky,
+                            const Mat& active, Mat& components, Mat& defined);
+
+    /*
+     * Inverse F0 transform of the components to an image of the given size.
+     */
+    void separableInverse(const Mat& components, const std::vector<float>& kx, const std::vector<float>& ky,
+                          Size size, OutputArray output);
+
+    /*
+     * Clears the inner part of the basic functions of the undefined components in the mask, as
+     * `ft::FT02D_iteration` does for the mask of the next iteration.
+     */
+    void clearUndefined(const Mat& defined, int radiusX, int radiusY, Mat& mask);
+}
+
+}
+}
+
+#endif // __OPENCV_FUZZY_F0_SEPARABLE_H__
@@ -40,9 +40,50 @@
 //M*/
 
 #include "precomp.hpp"
+#include "fuzzy_F0_separable.hpp"
 
 using namespace cv;
 
+namespace
+{
+    // marks the components whose basic function covers a pixel outside the mask
+    void unfilledComponents(const Mat& mask, int radiusX, int radiusY, Mat& active)
+    {
+        const int An = mask.cols / radiusX + 1;
+        const int Bn = mask.rows / radiusY + 1;
+
+        active = Mat::zeros(Bn, An, CV_8UC1);
+
+        for (int y = 0; y < mask.rows; y++)
+        {
+            const uchar* maskRow = mask.ptr<uchar>(y);
+            const int oStart = std::max((y + radiusY - 1) / radiusY - 1, 0);
+            const int oEnd = std::min(y / radiusY + 1, Bn - 1);
+
+            for (int x = 0; x < mask.cols; x++)
+            {
+                if (maskRow[x])
+                {
+                    continue;
+                }
+
+                const int iStart = std::max((x + radiusX - 1) / radiusX - 1, 0);
+                const int iEnd = std::min(x / radiusX + 1, An - 1);
+
+                for (int o = oStart; o <= oEnd; o++)
+                {
+                    uchar* activeRow = active.ptr<uchar>(o);
+
+                    for (int i = iStart; i <= iEnd; i++)
+                    {
+                        activeRow[i] = 1;
+                    }
+                }
+            }
+        }
+    }
+}
+
 void ft::createKernel(InputArray A, InputArray B, OutputArray kernel, const int chn)
 {
     Mat AMat = A.getMat();
@@ -140,6 +181,43 @@ void ft::inpaint(InputArray image, InputArray mask, OutputArray output, int radi
         Mat processingMask;
         mask.copyTo(processingMask);
 
+        std::vector<float> kx, ky;
+        ft::createKernel(function, currentRadius, kernel, image.channels());
+
+        if (processingMask.type() == CV_8UC1 && ft::detail::separateKernel(kernel, kx, ky))
+        {
+            // only the components covering a pixel not filled yet change the output, so the
+            // other ones are skipped
+            Mat active, components, defined;
+
+            do
+            {
+                ft::createKernel(function, currentRadius, kernel, image.channels());
+                ft::detail::separateKernel(kernel, kx, ky);
+
+                unfilledComponents(processingMask, currentRadius, currentRadius, active);
+
+                state = ft::detail::separableComponents(processingInput, processingMask, kx, ky, active, components, defined);
+
+                ft::detail::separableInverse(components, kx, ky, processingInput.size(), processingOutput);
+
+                Mat invMask;
+                compare(processingMask, 0, invMask, CMP_EQ);
+                processingOutput.copyTo(processingInput, invMask);
+
+                maskOutput = Mat::ones(processingMask.size(), CV_8UC1);
+                ft::detail::clearUndefined(defined, currentRadius, currentRadius, maskOutput);
+                maskOutput.copyTo(processingMask);
+
+                currentRadius++;
+            }
+            while(state != 0);
+
+            processingInput.copyTo(output);
+
+            return;
+        }
+
         do
         {
             ft::createKernel(function, currentRadius, kernel, image.channels());
@@ -94,6 +94,39 @@ TEST(fuzzy_image, filtering)
     EXPECT_LE(n1, 1);
 }
 
+TEST(fuzzy_image, iterative_inpainting_matches_full_iterations)
+{
+    Mat image(61, 83, CV_8UC3);
+    randu(image, Scalar::all(0), Scalar::all(255));
+
+    Mat mask(image.size(), CV_8UC1, Scalar(1));
+    mask(Rect(10, 7, 25, 30)).setTo(0);
+    mask(Rect(50, 40, 3, 3)).setTo(0);
+    mask(Rect(70, 5, 13, 2)).setTo(0);
+
+    Mat res;
+    ft::inpaint(image, mask, res, 2, ft::LINEAR, ft::ITERATIVE);
+
+    // every component recomputed at every iteration
+    Mat input, processingMask, kernel, output, maskOutput;
+    image.convertTo(input, CV_32F);
+    mask.copyTo(processingMask);
+    int state = 0;
+    int radius = 2;
+    do
+    {
+        ft::createKernel(ft::LINEAR, radius, kernel, 3);
+        Mat invMask = 1 - processingMask;
+        state = ft::FT02D_iteration(input, kernel, output, processingMask, maskOutput, false);
+        maskOutput.copyTo(processingMask);
+        output.copyTo(input, invMask);
+        radius++;
+    }
+    while (state != 0);
+
+    EXPECT_LE(cvtest::norm(input, res, NORM_INF), 1e-3);
+}
+
 TEST(fuzzy_image, kernel)
 {
     Mat kernel1;
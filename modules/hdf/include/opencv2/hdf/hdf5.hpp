@@ -47,6 +47,57 @@ using namespace std;
 //! @addtogroup hdf5
 //! @{
 
+/** @brief Sequential reader of a dataset by blocks along its first dimension.
+
+When the HDF5 library is built thread safe the next block is read in background while the caller
+processes the current one. @sa HDF5::dsreader()
+ */
+class CV_EXPORTS DatasetReader
+{
+public:
+    virtual ~DatasetReader() {}
+
+    /** @brief Read the next block of the dataset.
+    @param block Mat container for the block. It has the dataset dimensions except for the first one
+           which holds the rows of the block, the last block can be shorter.
+
+    Returns false once the whole dataset has been read.
+
+    @note A Mat which already has the size and type of the block is filled in place, even if it is
+    a region of a larger Mat. When reading in background the buffers are exchanged with the container instead,
+    so its previous data is reused for the next block unless it is still referenced elsewhere.
+     */
+    virtual bool read( OutputArray block ) = 0;
+
+    //! offset over the first dimension of the next block to be read
+    virtual int position() const = 0;
+};
+
+/** @brief Sequential writer appending blocks along the first dimension of a dataset.
+
+When the HDF5 library is built thread safe the blocks are written in background while the caller
+prepares the next one. @sa HDF5::dswriter()
+ */
+class CV_EXPORTS DatasetWriter
+{
+public:
+    virtual ~DatasetWriter() {}
+
+    /** @brief Append a block at the end of the dataset.
+    @param block Mat with the dataset type and dimensions except for the first one. The data is copied
+           before returning when written in background, so the block can be reused right away.
+
+    @note Pending errors of the background writes are reported by the next call or by flush().
+     */
+    virtual void write( InputArray block ) = 0;
+
+    //! wait for the pending writes
+    virtual void flush() = 0;
+
+    //! offset over the first dimension where the next block will be written
+    virtual int position() const = 0;
+};
+
 
 /** @brief Hierarchical Data Format version 5 interface.
 
@@ -64,6 +115,7 @@ public:
        H5_GETDIMS = 100,      //!< Get the dimension information of a dataset. @sa dsgetsize()
        H5_GETMAXDIMS = 101,   //!< Get the maximum dimension information of a dataset. @sa dsgetsize()
        H5_GETCHUNKDIMS = 102, //!< Get the chunk sizes of a dataset. @sa dsgetsize()
+       H5_SHUFFLE = 256,      //!< Shuffle the bytes before compression, combined with a compression level 0-9. @sa dscreate()
     };
 
     virtual ~HDF5() {}
@@ -217,7 +269,9 @@ public:
                          The value 0 also means no compression.
                          A value 9 indicating the best compression ration. Note
                          that a higher compression level indicates a higher computational cost. It relies
-                         on GNU gzip for compression.
+                         on GNU gzip for compression. Combining the level with H5_SHUFFLE, e.g. `6 | HDF5::H5_SHUFFLE`,
+                         reorders the bytes of the elements before compression which usually helps with
+                         floating point and multi byte integer data.
     @param dims_chunks each array member specifies the chunking size to be used for block I/O,
            by default NULL means none at all.
 
@@ -297,7 +351,9 @@ public:
                          The value 0 also means no compression.
                          A value 9 indicating the best compression ration. Note
                          that a higher compression level indicates a higher computational cost. It relies
-                         on GNU gzip for compression.
+                         on GNU gzip for compression. Combining the level with H5_SHUFFLE, e.g. `6 | HDF5::H5_SHUFFLE`,
+                         reorders the bytes of the elements before compression which usually helps with
+                         floating point and multi byte integer data.
     @param dims_chunks each array member specifies chunking sizes to be used for block I/O,
            by default NULL means none at all.
     @note If the dataset already exists, an exception will be thrown. Existence of the dataset can be checked
@@ -575,6 +631,44 @@ public:
     CV_WRAP virtual void dsread( OutputArray Array, const String& dslabel,
                  const int* dims_offset, const int* dims_counts ) const = 0;
 
+    /** @brief Open a dataset for reading by blocks.
+    @param dslabel specify the source hdf5 dataset label.
+    @param block_rows amount of data over the first dimension read at once.
+
+    Each hyperslab is read straight into the block container. Block sizes matching the chunk size of
+    the first dimension avoid decompressing the same chunk twice, see dsgetsize() with H5_GETCHUNKDIMS.
+
+    - Example below processes a large dataset by blocks of 1000 rows reusing the same memory:
+    @code{.cpp}
+      cv::Ptr<cv::hdf::HDF5> h5io = cv::hdf::open( "features.h5" );
+      cv::Ptr<cv::hdf::DatasetReader> reader = h5io->dsreader( "descriptors", 1000 );
+      cv::Mat block;
+      while ( reader->read( block ) )
+        process( block );
+    @endcode
+     */
+    virtual Ptr<DatasetReader> dsreader( const String& dslabel, const int block_rows ) const = 0;
+
+    /** @brief Open a dataset for appending by blocks.
+    @param dslabel specify the target hdf5 dataset label.
+
+    The dataset must exist and have H5_UNLIMITED as its first dimension, the blocks are appended after
+    its current end, see dscreate().
+
+    - Example below streams row blocks into a compressed dataset:
+    @code{.cpp}
+      cv::Ptr<cv::hdf::HDF5> h5io = cv::hdf::open( "features.h5" );
+      int sizes[2] = { cv::hdf::HDF5::H5_UNLIMITED, 128 };
+      int chunks[2] = { 1024, 128 };
+      h5io->dscreate( 2, sizes, CV_32F, "descriptors", 4 | cv::hdf::HDF5::H5_SHUFFLE, chunks );
+      cv::Ptr<cv::hdf::DatasetWriter> writer = h5io->dswriter( "descriptors" );
+      for ( size_t i = 0; i < images.size(); i++ )
+        writer->write( computeDescriptors( images[i] ) );
+      writer->flush();
+    @endcode
+     */
+    virtual Ptr<DatasetWriter> dswriter( const String& dslabel ) const = 0;
+
     /** @brief Fetch keypoint dataset size
     @param kplabel specify the hdf5 dataset label to be measured.
     @param dims_flag will fetch dataset dimensions on H5_GETDIMS, and dataset maximum dimensions on H5_GETMAXDIMS.
@@ -594,6 +688,7 @@ public:
     @param size declare fixed number of KeyPoints
     @param kplabel specify the hdf5 dataset label, any existing dataset with the same label will be overwritten.
     @param compresslevel specify the compression level 0-9 to be used, H5_NONE is default and means no compression.
+           It can be combined with H5_SHUFFLE as in dscreate().
     @param chunks each array member specifies chunking sizes to be used for block I/O,
            H5_NONE is default and means no compression.
     @note If the dataset already exists an exception will be thrown. Existence of the dataset can be checked
@@ -678,7 +773,7 @@ public:
       h5io->close();
     @endcode
      */
-    virtual void kpwrite( const vector<KeyPoint> keypoints, const String& kplabel,
+    virtual void kpwrite( const vector<KeyPoint>& keypoints, const String& kplabel,
              const int offset = H5_NONE, const int counts = H5_NONE ) const = 0;
 
     /** @brief Insert or overwrite list of KeyPoint into specified dataset and autoexpand dataset size if **unlimited** property allows.
@@ -713,9 +808,33 @@ public:
       h5io->close();
     @endcode
      */
-    virtual void kpinsert( const vector<KeyPoint> keypoints, const String& kplabel,
+    virtual void kpinsert( const vector<KeyPoint>& keypoints, const String& kplabel,
              const int offset = H5_NONE, const int counts = H5_NONE ) const = 0;
 
+    /** @brief Append list of KeyPoint at the end of an **unlimited** keypoint dataset.
+    @param keypoints specify keypoints data list to be appended.
+    @param kplabel specify the target hdf5 dataset label.
+
+    Returns the offset of the first appended keypoint in the dataset.
+
+    @note The dataset must be created with H5_UNLIMITED size, see kpcreate(). The dataset is extended once for
+    the whole list, so large sets are best appended in batches matching the chunk size.
+
+    - Example below appends the keypoints of several images into the same dataset:
+    @code{.cpp}
+      cv::Ptr<cv::hdf::HDF5> h5io = cv::hdf::open( "mytest.h5" );
+      h5io->kpcreate( cv::hdf::HDF5::H5_UNLIMITED, "keypoints", 4 | cv::hdf::HDF5::H5_SHUFFLE, 4096 );
+      for ( size_t i = 0; i < images.size(); i++ )
+      {
+        std::vector<cv::KeyPoint> keypoints;
+        detector->detect( images[i], keypoints );
+        h5io->kpappend( keypoints, "keypoints" );
+      }
+      h5io->close();
+    @endcode
+     */
+    virtual int kpappend( const vector<KeyPoint>& keypoints, const String& kplabel ) const = 0;
+
     /** @brief Read specific keypoint dataset from hdf5 file into vector<KeyPoint> object.
     @param keypoints vector<KeyPoint> container where data reads will be returned.
     @param kplabel specify the source hdf5 dataset label.
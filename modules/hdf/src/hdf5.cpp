@@ -36,6 +36,9 @@
 
 #include <hdf5.h>
 
+#include <algorithm>
+#include <thread>
+
 using namespace std;
 
 namespace cv
@@ -166,6 +169,12 @@ public:
     virtual void dsread( OutputArray Array, const String& dslabel,
              const int* dims_offset, const int* dims_counts ) const CV_OVERRIDE;
 
+    // stream dataset by blocks
+    virtual Ptr<DatasetReader> dsreader( const String& dslabel, const int block_rows ) const CV_OVERRIDE;
+
+    // append blocks to dataset
+    virtual Ptr<DatasetWriter> dswriter( const String& dslabel ) const CV_OVERRIDE;
+
     /*
      *  std::vector<cv::KeyPoint>
      */
@@ -178,13 +187,16 @@ public:
              const int compresslevel = H5_NONE, const int chunks = H5_NONE ) const CV_OVERRIDE;
 
     // write KeyPoint structures
-    virtual void kpwrite( const vector<KeyPoint> keypoints, const String& kplabel,
+    virtual void kpwrite( const vector<KeyPoint>& keypoints, const String& kplabel,
              const int offset = H5_NONE, const int counts = H5_NONE ) const CV_OVERRIDE;
 
     // append / merge KeyPoint structures
-    virtual void kpinsert( const vector<KeyPoint> keypoints, const String& kplabel,
+    virtual void kpinsert( const vector<KeyPoint>& keypoints, const String& kplabel,
              const int offset = H5_NONE, const int counts = H5_NONE ) const CV_OVERRIDE;
 
+    // append KeyPoint structures at the end
+    virtual int kpappend( const vector<KeyPoint>& keypoints, const String& kplabel ) const CV_OVERRIDE;
+
     // read KeyPoint structure
     virtual void kpread( vector<KeyPoint>& keypoints, const String& kplabel,
              const int offset = H5_NONE, const int counts = H5_NONE ) const CV_OVERRIDE;
@@ -203,6 +215,9 @@ private:
     //! translate h5Type -> cvType
     inline int GetCVtype( hid_t h5Type ) const;
 
+    //! memory type of a Mat element, to be closed by the caller
+    hid_t CreateH5type( int cvType ) const;
+
 };
 
 inline hid_t HDF5Impl::GetH5type( int cvType ) const
@@ -262,6 +277,47 @@ inline int HDF5Impl::GetCVtype( hid_t h5Type ) const
     return cvType;
 }
 
+hid_t HDF5Impl::CreateH5type( int cvType ) const
+{
+    if ( CV_MAT_CN( cvType ) == 1 )
+      return H5Tcopy( GetH5type( cvType ) );
+
+    hsize_t adims[1] = { (hsize_t)CV_MAT_CN( cvType ) };
+    return H5Tarray_create( GetH5type( cvType ), 1, adims );
+}
+
+//! deflate level of compresslevel without the H5_SHUFFLE flag
+static int getDeflateLevel( const int compresslevel )
+{
+    if ( compresslevel < 0 )
+      return compresslevel;
+    return compresslevel & ~HDF5::H5_SHUFFLE;
+}
+
+//! set the shuffle and deflate filters of a dataset creation property
+static void setCompression( hid_t dsdcpl, const int compresslevel )
+{
+    const int level = getDeflateLevel( compresslevel );
+    if ( level < 0 )
+      return;
+
+    // shuffle has to run before deflate
+    if ( compresslevel & HDF5::H5_SHUFFLE )
+      H5Pset_shuffle( dsdcpl );
+    H5Pset_deflate( dsdcpl, level );
+}
+
+//! whether the library can be called from a background thread
+static bool isThreadSafe()
+{
+#if H5_VERSION_GE(1, 8, 16)
+    hbool_t threadsafe = 0;
+    return H5is_library_threadsafe( &threadsafe ) >= 0 && threadsafe;
+#else
+    return false;
+#endif
+}
+
 HDF5Impl::HDF5Impl( const String& _hdf5_filename )
                   : m_hdf5_filename( _hdf5_filename )
 {
@@ -707,8 +763,8 @@ void HDF5Impl::dscreate( const vector<int>& sizes, const int type,
 void HDF5Impl::dscreate( const int n_dims, const int* sizes, const int type,
                  const String& dslabel, const int compresslevel, const int* dims_chunks ) const
 {
-    // compress valid H5_NONE, 0-9
-    CV_Assert( compresslevel >= H5_NONE && compresslevel <= 9 );
+    // compress valid H5_NONE, 0-9, optionally with H5_SHUFFLE
+    CV_Assert( getDeflateLevel( compresslevel ) >= H5_NONE && getDeflateLevel( compresslevel ) <= 9 );
 
     if ( hlexists( dslabel ) == true )
       CV_Error_(Error::StsInternal, ("Requested dataset '%s' already exists.", dslabel.c_str()));
@@ -751,8 +807,7 @@ void HDF5Impl::dscreate( const int n_dims, const int* sizes, const int type,
     hid_t dsdcpl = H5Pcreate( H5P_DATASET_CREATE );
 
     // set properties
-    if ( compresslevel >= 0 )
-      H5Pset_deflate( dsdcpl, compresslevel );
+    setCompression( dsdcpl, compresslevel );
 
     if ( dims_chunks != NULL || compresslevel >= 0 )
       H5Pset_chunk( dsdcpl, n_dims, chunks );
@@ -1141,10 +1196,321 @@ void HDF5Impl::dsinsert( InputArray Array, const String& dslabel,
     H5Dclose( dsdata );
 }
 
+/*
+ * streaming
+ */
+
+//! transfers rows [offset, offset + counts[0]) over the first dimension of a dataset from or to a block
+static herr_t transferRows( hid_t dsdata, hid_t mmtype, const vector<hsize_t>& counts,
+                            hsize_t offset, const Mat& block, bool write )
+{
+    const int n_dims = (int) counts.size();
+
+    // a region of a larger Mat is selected inside of its rows
+    vector<hsize_t> mmdims( counts );
+    if ( !block.isContinuous() )
+    {
+      CV_Assert( n_dims == 2 && block.step[0] % block.elemSize() == 0 );
+      mmdims[1] = block.step[0] / block.elemSize();
+    }
+
+    vector<hsize_t> foffset( n_dims, 0 );
+    hid_t dspace = H5Screate_simple( n_dims, &mmdims[0], NULL );
+    H5Sselect_hyperslab( dspace, H5S_SELECT_SET,
+                         &foffset[0], NULL, &counts[0], NULL );
+
+    herr_t status = 0;
+    if ( write )
+    {
+      // grow the dataset up to the end of the block
+      hid_t fspace = H5Dget_space( dsdata );
+      vector<hsize_t> fsdims( n_dims );
+      H5Sget_simple_extent_dims( fspace, &fsdims[0], NULL );
+      H5Sclose( fspace );
+      if ( fsdims[0] < offset + counts[0] )
+      {
+        fsdims[0] = offset + counts[0];
+        status = H5Dset_extent( dsdata, &fsdims[0] );
+      }
+    }
+
+    foffset[0] = offset;
+    hid_t fspace = H5Dget_space( dsdata );
+    H5Sselect_hyperslab( fspace, H5S_SELECT_SET,
+                         &foffset[0], NULL, &counts[0], NULL );
+
+    if ( status >= 0 )
+    {
+      if ( write )
+        status = H5Dwrite( dsdata, mmtype, dspace, fspace, H5P_DEFAULT, block.data );
+      else
+        status = H5Dread( dsdata, mmtype, dspace, fspace, H5P_DEFAULT, block.data );
+    }
+
+    H5Sclose( dspace );
+    H5Sclose( fspace );
+
+    return status;
+}
+
+class DatasetReaderImpl CV_FINAL : public DatasetReader
+{
+public:
+    DatasetReaderImpl( hid_t dsdata, hid_t mmtype, int type, int block_rows )
+        : m_dsdata( dsdata ), m_mmtype( mmtype ), m_type( type ), m_block_rows( block_rows ),
+          m_position( 0 ), m_status( 0 ), m_background( isThreadSafe() )
+    {
+      hid_t fspace = H5Dget_space( dsdata );
+      m_dims.resize( H5Sget_simple_extent_ndims( fspace ) );
+      H5Sget_simple_extent_dims( fspace, &m_dims[0], NULL );
+      H5Sclose( fspace );
+
+      if ( m_background )
+        prefetch();
+    }
+
+    virtual ~DatasetReaderImpl() CV_OVERRIDE
+    {
+      if ( m_worker.joinable() )
+        m_worker.join();
+      H5Tclose( m_mmtype );
+      H5Dclose( m_dsdata );
+    }
+
+    virtual bool read( OutputArray block ) CV_OVERRIDE
+    {
+      if ( m_position >= m_dims[0] )
+        return false;
+
+      const hsize_t rows = blockRows();
+      if ( m_background )
+      {
+        m_worker.join();
+        if ( m_status < 0 )
+          CV_Error_(Error::StsError, ("Failed to read dataset block at %d.", (int)m_position));
+
+        // hand over the prefetched block and recycle the memory of the caller
+        if ( block.kind() == _InputArray::MAT )
+        {
+          std::swap( block.getMatRef(), m_buffer );
+          if ( m_buffer.u && m_buffer.u->refcount > 1 )
+            m_buffer.release();
+        }
+        else
+          m_buffer.copyTo( block );
+
+        m_position += rows;
+        prefetch();
+      }
+      else
+      {
+        createBlock( block, rows );
+        if ( transferRows( m_dsdata, m_mmtype, blockCounts( rows ), m_position, block.getMat(), false ) < 0 )
+          CV_Error_(Error::StsError, ("Failed to read dataset block at %d.", (int)m_position));
+        m_position += rows;
+      }
+      return true;
+    }
+
+    virtual int position() const CV_OVERRIDE
+    {
+      return (int) m_position;
+    }
+
+private:
+    hsize_t blockRows() const
+    {
+      return std::min( (hsize_t)m_block_rows, m_dims[0] - m_position );
+    }
+
+    vector<hsize_t> blockCounts( hsize_t rows ) const
+    {
+      vector<hsize_t> counts( m_dims );
+      counts[0] = rows;
+      return counts;
+    }
+
+    void createBlock( OutputArray block, hsize_t rows ) const
+    {
+      vector<int> sizes( m_dims.size() );
+      for ( size_t d = 0; d < sizes.size(); d++ )
+        sizes[d] = (int) m_dims[d];
+      sizes[0] = (int) rows;
+      block.create( (int)sizes.size(), &sizes[0], m_type );
+    }
+
+    //! starts reading the next block in background
+    void prefetch()
+    {
+      if ( m_position >= m_dims[0] )
+        return;
+
+      const hsize_t rows = blockRows();
+      createBlock( m_buffer, rows );
+      const vector<hsize_t> counts = blockCounts( rows );
+      const hsize_t offset = m_position;
+      m_worker = std::thread( [this, counts, offset]()
+      {
+        m_status = transferRows( m_dsdata, m_mmtype, counts, offset, m_buffer, false );
+      });
+    }
+
+    hid_t m_dsdata;
+    hid_t m_mmtype;
+    int m_type;
+    int m_block_rows;
+    vector<hsize_t> m_dims;
+    hsize_t m_position;
+    Mat m_buffer;
+    herr_t m_status;
+    bool m_background;
+    std::thread m_worker;
+};
+
+class DatasetWriterImpl CV_FINAL : public DatasetWriter
+{
+public:
+    DatasetWriterImpl( hid_t dsdata, hid_t mmtype, int type )
+        : m_dsdata( dsdata ), m_mmtype( mmtype ), m_type( type ),
+          m_status( 0 ), m_background( isThreadSafe() )
+    {
+      hid_t fspace = H5Dget_space( dsdata );
+      m_dims.resize( H5Sget_simple_extent_ndims( fspace ) );
+      H5Sget_simple_extent_dims( fspace, &m_dims[0], NULL );
+      H5Sclose( fspace );
+      m_position = m_dims[0];
+    }
+
+    virtual ~DatasetWriterImpl() CV_OVERRIDE
+    {
+      // errors can only be reported by flush()
+      if ( m_worker.joinable() )
+        m_worker.join();
+      H5Tclose( m_mmtype );
+      H5Dclose( m_dsdata );
+    }
+
+    virtual void write( InputArray block ) CV_OVERRIDE
+    {
+      Mat matrix = block.getMat();
+      if ( matrix.empty() )
+        return;
+
+      CV_Assert( matrix.type() == m_type );
+
+      // match the dataset dimensions besides the first one
+      vector<hsize_t> counts( m_dims );
+      counts[0] = matrix.size[0];
+      if ( m_dims.size() == 1 )
+        CV_Assert( matrix.dims == 2 && matrix.cols == 1 );
+      else
+      {
+        CV_Assert( matrix.dims == (int)m_dims.size() );
+        for ( size_t d = 1; d < m_dims.size(); d++ )
+          CV_Assert( (hsize_t)matrix.size[(int)d] == m_dims[d] );
+      }
+
+      if ( m_background )
+      {
+        flush();
+        matrix.copyTo( m_buffer );
+        const hsize_t offset = m_position;
+        m_worker = std::thread( [this, counts, offset]()
+        {
+          m_status = transferRows( m_dsdata, m_mmtype, counts, offset, m_buffer, true );
+        });
+      }
+      else
+      {
+        if ( !matrix.isContinuous() && matrix.dims > 2 )
+          matrix = matrix.clone();
+        if ( transferRows( m_dsdata, m_mmtype, counts, m_position, matrix, true ) < 0 )
+          CV_Error_(Error::StsError, ("Failed to write dataset block at %d.", (int)m_position));
+      }
+      m_position += counts[0];
+    }
+
+    virtual void flush() CV_OVERRIDE
+    {
+      if ( m_worker.joinable() )
+        m_worker.join();
+      if ( m_status < 0 )
+      {
+        m_status = 0;
+        CV_Error(Error::StsError, "Failed to write dataset block.");
+      }
+    }
+
+    virtual int position() const CV_OVERRIDE
+    {
+      return (int) m_position;
+    }
+
+private:
+    hid_t m_dsdata;
+    hid_t m_mmtype;
+    int m_type;
+    vector<hsize_t> m_dims;
+    hsize_t m_position;
+    Mat m_buffer;
+    herr_t m_status;
+    bool m_background;
+    std::thread m_worker;
+};
+
+Ptr<DatasetReader> HDF5Impl::dsreader( const String& dslabel, const int block_rows ) const
+{
+    CV_Assert( block_rows > 0 );
+
+    // check dataset exists
+    if ( hlexists( dslabel ) == false )
+      CV_Error_(Error::StsInternal, ("Dataset '%s' does not exist.", dslabel.c_str()));
+
+    const int type = dsgettype( dslabel );
+
+    // open dataset
+    hid_t dsdata = H5Dopen( m_h5_file_id, dslabel.c_str(), H5P_DEFAULT );
+
+    return makePtr<DatasetReaderImpl>( dsdata, CreateH5type( type ), type, block_rows );
+}
+
+Ptr<DatasetWriter> HDF5Impl::dswriter( const String& dslabel ) const
+{
+    // check dataset exists
+    if ( hlexists( dslabel ) == false )
+      CV_Error_(Error::StsInternal, ("Dataset '%s' does not exist.", dslabel.c_str()));
+
+    // first dimension has to grow
+    vector<int> maxdims = dsgetsize( dslabel, H5_GETMAXDIMS );
+    if ( maxdims[0] != H5_UNLIMITED )
+      CV_Error_(Error::StsInternal, ("Dataset '%s' is not unlimited on its first dimension.", dslabel.c_str()));
+
+    const int type = dsgettype( dslabel );
+
+    // open dataset
+    hid_t dsdata = H5Dopen( m_h5_file_id, dslabel.c_str(), H5P_DEFAULT );
+
+    return makePtr<DatasetWriterImpl>( dsdata, CreateH5type( type ), type );
+}
+
 /*
  *  std::vector<cv::KeyPoint>
  */
 
+//! compound type of a KeyPoint, to be closed by the caller
+static hid_t createKeyPointType()
+{
+    hid_t kptype = H5Tcreate( H5T_COMPOUND, sizeof( KeyPoint ) );
+    H5Tinsert( kptype, "xpos",     HOFFSET( KeyPoint, pt.x     ), H5T_NATIVE_FLOAT );
+    H5Tinsert( kptype, "ypos",     HOFFSET( KeyPoint, pt.y     ), H5T_NATIVE_FLOAT );
+    H5Tinsert( kptype, "size",     HOFFSET( KeyPoint, size     ), H5T_NATIVE_FLOAT );
+    H5Tinsert( kptype, "angle",    HOFFSET( KeyPoint, angle    ), H5T_NATIVE_FLOAT );
+    H5Tinsert( kptype, "response", HOFFSET( KeyPoint, response ), H5T_NATIVE_FLOAT );
+    H5Tinsert( kptype, "octave",   HOFFSET( KeyPoint, octave   ), H5T_NATIVE_INT32 );
+    H5Tinsert( kptype, "class_id", HOFFSET( KeyPoint, class_id ), H5T_NATIVE_INT32 );
+    return kptype;
+}
+
 int HDF5Impl::kpgetsize( const String& kplabel, int dims_flag ) const
 {
     vector<int> sizes = dsgetsize( kplabel, dims_flag );
@@ -1163,8 +1529,8 @@ void HDF5Impl::kpcreate( const int size, const String& kplabel,
     // valid chunks
     CV_Assert( chunks == H5_NONE || chunks > 0 );
 
-    // compress valid -1, 0-9
-    CV_Assert( compresslevel >= H5_NONE && compresslevel <= 9 );
+    // compress valid -1, 0-9, optionally with H5_SHUFFLE
+    CV_Assert( getDeflateLevel( compresslevel ) >= H5_NONE && getDeflateLevel( compresslevel ) <= 9 );
 
     if ( hlexists( kplabel ) == true )
       CV_Error_(Error::StsInternal, ("Requested dataset '%s' already exists.", kplabel.c_str()));
@@ -1195,14 +1561,7 @@ void HDF5Impl::kpcreate( const int size, const String& kplabel,
       dchunk[0] = chunks;
 
     // dataset compound type
-    hid_t dstype = H5Tcreate( H5T_COMPOUND, sizeof( KeyPoint ) );
-    H5Tinsert( dstype, "xpos",     HOFFSET( KeyPoint, pt.x     ), H5T_NATIVE_FLOAT );
-    H5Tinsert( dstype, "ypos",     HOFFSET( KeyPoint, pt.y     ), H5T_NATIVE_FLOAT );
-    H5Tinsert( dstype, "size",     HOFFSET( KeyPoint, size     ), H5T_NATIVE_FLOAT );
-    H5Tinsert( dstype, "angle",    HOFFSET( KeyPoint, angle    ), H5T_NATIVE_FLOAT );
-    H5Tinsert( dstype, "response", HOFFSET( KeyPoint, response ), H5T_NATIVE_FLOAT );
-    H5Tinsert( dstype, "octave",   HOFFSET( KeyPoint, octave   ), H5T_NATIVE_INT32 );
-    H5Tinsert( dstype, "class_id", HOFFSET( KeyPoint, class_id ), H5T_NATIVE_INT32 );
+    hid_t dstype = createKeyPointType();
 
     // create dataset space
     hid_t dspace = H5Screate_simple( 1, dsdims, maxdim );
@@ -1211,8 +1570,7 @@ void HDF5Impl::kpcreate( const int size, const String& kplabel,
     hid_t dsdcpl = H5Pcreate( H5P_DATASET_CREATE );
 
     // set properties
-    if ( compresslevel >= 0 )
-      H5Pset_deflate( dsdcpl, compresslevel );
+    setCompression( dsdcpl, compresslevel );
 
     // if chunking or compression
     if ( dchunk[0] > 0 || compresslevel >= 0 )
@@ -1227,7 +1585,7 @@ void HDF5Impl::kpcreate( const int size, const String& kplabel,
     H5Sclose( dspace );
 }
 
-void HDF5Impl::kpwrite( const vector<KeyPoint> keypoints, const String& kplabel,
+void HDF5Impl::kpwrite( const vector<KeyPoint>& keypoints, const String& kplabel,
              const int offset, const int counts ) const
 {
     CV_Assert( keypoints.size() > 0 );
@@ -1265,14 +1623,7 @@ void HDF5Impl::kpwrite( const vector<KeyPoint> keypoints, const String& kplabel,
                          doffset, NULL, dsddims, NULL );
 
     // memory compound type
-    hid_t mmtype = H5Tcreate( H5T_COMPOUND, sizeof( KeyPoint ) );
-    H5Tinsert( mmtype, "xpos",     HOFFSET( KeyPoint, pt.x     ), H5T_NATIVE_FLOAT );
-    H5Tinsert( mmtype, "ypos",     HOFFSET( KeyPoint, pt.y     ), H5T_NATIVE_FLOAT );
-    H5Tinsert( mmtype, "size",     HOFFSET( KeyPoint, size     ), H5T_NATIVE_FLOAT );
-    H5Tinsert( mmtype, "angle",    HOFFSET( KeyPoint, angle    ), H5T_NATIVE_FLOAT );
-    H5Tinsert( mmtype, "response", HOFFSET( KeyPoint, response ), H5T_NATIVE_FLOAT );
-    H5Tinsert( mmtype, "octave",   HOFFSET( KeyPoint, octave   ), H5T_NATIVE_INT32 );
-    H5Tinsert( mmtype, "class_id", HOFFSET( KeyPoint, class_id ), H5T_NATIVE_INT32 );
+    hid_t mmtype = createKeyPointType();
 
     // write into dataset
     H5Dwrite( dsdata, mmtype, dspace, fspace, H5P_DEFAULT, &keypoints[0] );
@@ -1283,7 +1634,7 @@ void HDF5Impl::kpwrite( const vector<KeyPoint> keypoints, const String& kplabel,
     H5Dclose( dsdata );
 }
 
-void HDF5Impl::kpinsert( const vector<KeyPoint> keypoints, const String& kplabel,
+void HDF5Impl::kpinsert( const vector<KeyPoint>& keypoints, const String& kplabel,
              const int offset, const int counts ) const
 {
     CV_Assert( keypoints.size() > 0 );
@@ -1347,14 +1698,7 @@ void HDF5Impl::kpinsert( const vector<KeyPoint> keypoints, const String& kplabel
                          doffset, NULL, dsddims, NULL );
 
     // memory compound type
-    hid_t mmtype = H5Tcreate( H5T_COMPOUND, sizeof( KeyPoint ) );
-    H5Tinsert( mmtype, "xpos",     HOFFSET( KeyPoint, pt.x     ), H5T_NATIVE_FLOAT );
-    H5Tinsert( mmtype, "ypos",     HOFFSET( KeyPoint, pt.y     ), H5T_NATIVE_FLOAT );
-    H5Tinsert( mmtype, "size",     HOFFSET( KeyPoint, size     ), H5T_NATIVE_FLOAT );
-    H5Tinsert( mmtype, "angle",    HOFFSET( KeyPoint, angle    ), H5T_NATIVE_FLOAT );
-    H5Tinsert( mmtype, "response", HOFFSET( KeyPoint, response ), H5T_NATIVE_FLOAT );
-    H5Tinsert( mmtype, "octave",   HOFFSET( KeyPoint, octave   ), H5T_NATIVE_INT32 );
-    H5Tinsert( mmtype, "class_id", HOFFSET( KeyPoint, class_id ), H5T_NATIVE_INT32 );
+    hid_t mmtype = createKeyPointType();
 
     // write into dataset
     H5Dwrite( dsdata, mmtype, dspace, fspace, H5P_DEFAULT, &keypoints[0] );
@@ -1367,6 +1711,62 @@ void HDF5Impl::kpinsert( const vector<KeyPoint> keypoints, const String& kplabel
     H5Dclose( dsdata );
 }
 
+int HDF5Impl::kpappend( const vector<KeyPoint>& keypoints, const String& kplabel ) const
+{
+    // check dataset exists
+    if ( hlexists( kplabel ) == false )
+      CV_Error_(Error::StsInternal, ("Dataset '%s' does not exist.", kplabel.c_str()));
+
+    // open dataset
+    hid_t dsdata = H5Dopen( m_h5_file_id, kplabel.c_str(), H5P_DEFAULT );
+
+    // get actual file space and dims
+    hid_t fspace = H5Dget_space( dsdata );
+    int f_dims = H5Sget_simple_extent_ndims( fspace );
+    hsize_t fsdims[1], maxdim[1];
+    if ( f_dims == 1 )
+      H5Sget_simple_extent_dims( fspace, fsdims, maxdim );
+    H5Sclose( fspace );
+
+    if ( f_dims != 1 || maxdim[0] != H5S_UNLIMITED )
+    {
+      H5Dclose( dsdata );
+      CV_Error_(Error::StsInternal, ("Dataset '%s' is not an unlimited keypoint dataset.", kplabel.c_str()));
+    }
+
+    if ( !keypoints.empty() )
+    {
+      hsize_t doffset[1] = { fsdims[0] };
+      hsize_t dsddims[1] = { keypoints.size() };
+      hsize_t nwdims[1] = { fsdims[0] + keypoints.size() };
+
+      // extend dataset once for the whole list
+      H5Dset_extent( dsdata, nwdims );
+
+      // get the extended data space
+      fspace = H5Dget_space( dsdata );
+      H5Sselect_hyperslab( fspace, H5S_SELECT_SET,
+                           doffset, NULL, dsddims, NULL );
+
+      // create input data space
+      hid_t dspace = H5Screate_simple( 1, dsddims, NULL );
+
+      // memory compound type
+      hid_t mmtype = createKeyPointType();
+
+      // write into dataset
+      H5Dwrite( dsdata, mmtype, dspace, fspace, H5P_DEFAULT, &keypoints[0] );
+
+      H5Tclose( mmtype );
+      H5Sclose( dspace );
+      H5Sclose( fspace );
+    }
+
+    H5Dclose( dsdata );
+
+    return (int) fsdims[0];
+}
+
 void HDF5Impl::kpread( vector<KeyPoint>& keypoints, const String& kplabel,
              const int offset, const int counts ) const
 {
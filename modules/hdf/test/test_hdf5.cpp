@@ -371,4 +371,90 @@ TEST_F(HDF5_Test, test_attribute_InutArray_OutputArray_2d)
     m_hdf_io->close();
 }
 
+TEST_F(HDF5_Test, stream_dataset_by_blocks)
+{
+    reset();
+
+    String dataset_name = "/stream";
+    Mat expected(103, 7, CV_32FC2);
+    randu(expected, -100, 100);
+
+    m_hdf_io = hdf::open(m_filename);
+
+    int sizes[2] = {hdf::HDF5::H5_UNLIMITED, expected.cols};
+    int chunks[2] = {16, expected.cols};
+    m_hdf_io->dscreate(2, sizes, expected.type(), dataset_name, 4 | hdf::HDF5::H5_SHUFFLE, chunks);
+
+    Ptr<hdf::DatasetWriter> writer = m_hdf_io->dswriter(dataset_name);
+    for (int row = 0; row < expected.rows; row += 10)
+    {
+        // the block is reused right after the call
+        Mat block = expected.rowRange(row, std::min(row + 10, expected.rows)).clone();
+        writer->write(block);
+        block.setTo(0);
+    }
+    writer->flush();
+    EXPECT_EQ(writer->position(), expected.rows);
+    writer.release();
+
+    std::vector<int> stored = m_hdf_io->dsgetsize(dataset_name);
+    ASSERT_EQ(stored.size(), (size_t)2);
+    EXPECT_EQ(stored[0], expected.rows);
+    EXPECT_EQ(stored[1], expected.cols);
+
+    Ptr<hdf::DatasetReader> reader = m_hdf_io->dsreader(dataset_name, 16);
+    Mat block;
+    int row = 0;
+    while (reader->read(block))
+    {
+        ASSERT_EQ(block.type(), expected.type());
+        ASSERT_EQ(block.cols, expected.cols);
+        ASSERT_LE(row + block.rows, expected.rows);
+        EXPECT_EQ(cvtest::norm(block, expected.rowRange(row, row + block.rows), NORM_INF), 0);
+        row += block.rows;
+        EXPECT_EQ(reader->position(), row);
+    }
+    EXPECT_EQ(row, expected.rows);
+    reader.release();
+
+    // only unlimited datasets can be appended to
+    m_hdf_io->dswrite(m_single_channel, "/fixed");
+    EXPECT_ANY_THROW(m_hdf_io->dswriter("/fixed"));
+
+    m_hdf_io->close();
+}
+
+TEST_F(HDF5_Test, append_keypoints)
+{
+    reset();
+
+    String dataset_name = "/keypoints";
+    std::vector<KeyPoint> expected;
+    for (int i = 0; i < 25; i++)
+        expected.push_back(KeyPoint((float)i, (float)-i, 1.f + i, (float)i, 0.5f, i % 3, i));
+
+    m_hdf_io = hdf::open(m_filename);
+    m_hdf_io->kpcreate(hdf::HDF5::H5_UNLIMITED, dataset_name, 6 | hdf::HDF5::H5_SHUFFLE, 8);
+
+    for (size_t i = 0; i < expected.size(); i += 10)
+    {
+        std::vector<KeyPoint> batch(expected.begin() + i, expected.begin() + std::min(i + 10, expected.size()));
+        EXPECT_EQ(m_hdf_io->kpappend(batch, dataset_name), (int)i);
+    }
+    EXPECT_EQ(m_hdf_io->kpgetsize(dataset_name), (int)expected.size());
+
+    std::vector<KeyPoint> keypoints;
+    m_hdf_io->kpread(keypoints, dataset_name);
+    ASSERT_EQ(keypoints.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        EXPECT_EQ(keypoints[i].pt, expected[i].pt);
+        EXPECT_EQ(keypoints[i].size, expected[i].size);
+        EXPECT_EQ(keypoints[i].octave, expected[i].octave);
+        EXPECT_EQ(keypoints[i].class_id, expected[i].class_id);
+    }
+
+    m_hdf_io->close();
+}
+
 }} // namespace
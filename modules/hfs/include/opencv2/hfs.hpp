@@ -130,6 +130,18 @@ CV_WRAP virtual Mat performSegmentGpu(InputArray src, bool ifDraw = true) = 0;
 */
 CV_WRAP virtual Mat performSegmentCpu(InputArray src, bool ifDraw = true) = 0;
 
+/** @brief do segmentation of a sequence of frames with gpu, in a pipelined way
+* The segmentation of the given frame on the gpu overlaps the merging of the
+* regions of the previously given frame on the cpu, so the result of a frame
+* is returned by the next call.
+* @param src: the input image of the current frame. An empty image flushes the
+* pipeline, returning the result of the last frame.
+* @param ifDraw: same as in performSegmentGpu
+* @return the result of the frame given to the previous call, or an empty Mat
+* if there was none
+*/
+CV_WRAP virtual Mat performSegmentGpuPipelined(InputArray src, bool ifDraw = true) = 0;
+
 /** @brief: create a hfs object
 * @param height: the height of the input image
 * @param width: the width of the input image
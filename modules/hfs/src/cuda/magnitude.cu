@@ -215,7 +215,6 @@ void Magnitude::nonMaxSuppGpu()
 
 void Magnitude::processImgGpu(const Mat& bgr3u, Mat& mag1u)
 {
-    Mat gray, blur1u;
     cvtColor(bgr3u, gray, COLOR_BGR2GRAY);
     GaussianBlur(gray, blur1u, Size(7, 7), 1, 1);
 
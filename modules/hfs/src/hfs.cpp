@@ -92,6 +92,7 @@ public:
 
     Mat performSegmentGpu(InputArray src, bool ifDraw = true) CV_OVERRIDE;
     Mat performSegmentCpu(InputArray src, bool ifDraw = true) CV_OVERRIDE;
+    Mat performSegmentGpuPipelined(InputArray src, bool ifDraw = true) CV_OVERRIDE;
 private:
     Ptr<HfsCore> core;
 };
@@ -131,6 +132,19 @@ Mat HfsSegmentImpl::performSegmentCpu(InputArray src, bool ifDraw) {
     }
 }
 
+Mat HfsSegmentImpl::performSegmentGpuPipelined(InputArray src, bool ifDraw) {
+    Mat src_ = src.getMat();
+
+    if (!src_.empty()) {
+        CV_Assert(src_.rows == core->hfsSettings.slicSettings.img_size.y);
+        CV_Assert(src_.cols == core->hfsSettings.slicSettings.img_size.x);
+    }
+
+    Mat res;
+    core->processImagePipelined(src_, ifDraw, res);
+    return res;
+}
+
 Ptr<HfsSegment> HfsSegment::create(int height, int width, float segEgbThresholdI, int minRegionSizeI,
                                    float segEgbThresholdII, int minRegionSizeII,
                                    float spatialWeight, int spixelSize, int numIter)
@@ -31,6 +31,7 @@ const Point CIRCLE2[13] =
 HfsCore::HfsCore(int height, int width,
     float segThresholdI, int minRegionSizeI, float segThresholdII, int minRegionSizeII,
     float spatialWeight, int spixelSize, int numIter)
+    : pipe_next(0), pipe_pending(false)
 {
     hfsSettings.egbThresholdI = segThresholdI;
     hfsSettings.minRegionSizeI = minRegionSizeI;
@@ -97,29 +98,36 @@ void HfsCore::loadImage( const Mat& inimg, Ptr<UChar4Image> outimg )
 
 
 
-Mat HfsCore::getSLICIdxCpu(const Mat& img3u, int &num_css)
+// the labels of the superpixels are made consecutive, and stored in idx_mat
+static void compactSLICIdx(const int* idx_img, int _h, int _w,
+    int spixel_size, Mat& idx_mat, int &num_css)
 {
-    const int _h = img3u.rows;
-    const int _w = img3u.cols;
     const int _s = _h*_w;
 
-    slic::cSLIC cslic;
-    vector<int> idx_img = cslic.generate_superpixels(img3u,
-        hfsSettings.slicSettings.spixel_size, hfsSettings.slicSettings.coh_weight);
-
     num_css = 0;
-    int _max =
-        (int)ceil((float)_w / 8.0f)*(int)ceil((float)_h / 8.0f);
+    int _max = (int)ceil((float)_w / spixel_size)*(int)ceil((float)_h / spixel_size);
     vector<int> indexes(_max, 0);
     for (int i = 0; i < _s; i++)
         indexes[idx_img[i]]++;
     for (int i = 0; i < _max; i++)
         indexes[i] = (indexes[i] != 0) ? num_css++ : 0;
-    for (int i = 0; i < _s; i++)
-        idx_img[i] = indexes[idx_img[i]];
-    Mat idx_mat(_h, _w, CV_32S, idx_img.data());
-    idx_mat.convertTo(idx_mat, CV_16U);
-    return idx_mat;
+
+    idx_mat.create(_h, _w, CV_16U);
+    for (int r = 0; r < _h; r++)
+    {
+        const int* iP = idx_img + r*_w;
+        ushort* oP = idx_mat.ptr<ushort>(r);
+        for (int c = 0; c < _w; c++)
+            oP[c] = saturate_cast<ushort>(indexes[iP[c]]);
+    }
+}
+
+void HfsCore::getSLICIdxCpu(const Mat& img3u, Mat& idx_mat, int &num_css)
+{
+    const vector<int>& idx_img = slic_engine.generate_superpixels(img3u,
+        hfsSettings.slicSettings.spixel_size, hfsSettings.slicSettings.coh_weight);
+    compactSLICIdx(idx_img.data(), img3u.rows, img3u.cols,
+        hfsSettings.slicSettings.spixel_size, idx_mat, num_css);
 }
 
 Vec4f HfsCore::getColorFeature( const Vec3f& in1, const Vec3f& in2 )
@@ -435,71 +443,95 @@ void HfsCore::drawSegmentationRes( const Mat& seg,
     }
 }
 
-int HfsCore::processImageCpu(const Mat &img3u, Mat &seg)
+void HfsCore::prepareFrameCpu(const Mat &img3u, HfsFrame &frame_)
 {
-    Mat idx_mat, lab3u, mag1u, tmp;
-    int num_css;
+    getSLICIdxCpu(img3u, frame_.idx_mat, frame_.num_css);
+    cv::cvtColor(img3u, frame_.lab3u, COLOR_BGR2Lab);
 
-    idx_mat = getSLICIdxCpu(img3u, num_css);
-    cv::cvtColor(img3u, lab3u, COLOR_BGR2Lab);
+    mag_engine->processImgCpu(img3u, frame_.mag1u);
+}
 
-    mag_engine->processImgCpu(img3u, mag1u);
+void HfsCore::prepareFrameGpu(const Mat &img3u, HfsFrame &frame_)
+{
+#ifdef _HFS_CUDA_ON_
+    getSLICIdxGpu(img3u, frame_.idx_mat, frame_.num_css);
+    cv::cvtColor(img3u, frame_.lab3u, COLOR_BGR2Lab);
 
-    getSegmentationI( lab3u, mag1u, idx_mat,
-        hfsSettings.egbThresholdI, hfsSettings.minRegionSizeI, tmp, num_css );
-    getSegmentationII(lab3u, mag1u, tmp,
+    mag_engine->processImgGpu(img3u, frame_.mag1u);
+#else
+    prepareFrameCpu(img3u, frame_);
+#endif
+}
+
+int HfsCore::mergeFrame(HfsFrame &frame_, Mat &seg)
+{
+    int num_css = frame_.num_css;
+    getSegmentationI(frame_.lab3u, frame_.mag1u, frame_.idx_mat,
+        hfsSettings.egbThresholdI, hfsSettings.minRegionSizeI, frame_.segI, num_css);
+    getSegmentationII(frame_.lab3u, frame_.mag1u, frame_.segI,
         hfsSettings.egbThresholdII, hfsSettings.minRegionSizeII, seg, num_css);
     return num_css;
 }
 
-int HfsCore::processImageGpu(const Mat &img3u, Mat &seg)
+int HfsCore::processImageCpu(const Mat &img3u, Mat &seg)
 {
-#ifdef _HFS_CUDA_ON_
-    Mat idx_mat, lab3u, mag1u, tmp;
-    int num_css;
+    prepareFrameCpu(img3u, frame);
+    return mergeFrame(frame, seg);
+}
 
-    idx_mat = getSLICIdxGpu(img3u, num_css);
-    cv::cvtColor(img3u, lab3u, COLOR_BGR2Lab);
+int HfsCore::processImageGpu(const Mat &img3u, Mat &seg)
+{
+    prepareFrameGpu(img3u, frame);
+    return mergeFrame(frame, seg);
+}
 
-    mag_engine->processImgGpu(img3u, mag1u);
+bool HfsCore::processImagePipelined(const Mat &img3u, bool ifDraw, Mat &res)
+{
+    HfsFrame& next = pipe_frames[pipe_next];
+    HfsFrame& prev = pipe_frames[1 - pipe_next];
+    const bool has_next = !img3u.empty();
+    const bool has_prev = pipe_pending;
+
+    // the new frame is prepared on the device while the host merges the
+    // regions of the previous one, the frame is copied since the caller is
+    // free to overwrite it before its result is drawn
+    parallel_for_(Range(0, 2), [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            if (i == 0 && has_next)
+            {
+                img3u.copyTo(next.img3u);
+                prepareFrameGpu(next.img3u, next);
+            }
+            else if (i == 1 && has_prev)
+            {
+                Mat seg;
+                int num_css = mergeFrame(prev, seg);
+                if (ifDraw)
+                    drawSegmentationRes(seg, prev.img3u, num_css, res);
+                else
+                    res = seg;
+            }
+        }
+    }, 2);
 
-    getSegmentationI(lab3u, mag1u, idx_mat,
-        hfsSettings.egbThresholdI, hfsSettings.minRegionSizeI, tmp, num_css);
-    getSegmentationII(lab3u, mag1u, tmp,
-        hfsSettings.egbThresholdII, hfsSettings.minRegionSizeII, seg, num_css);
-    return num_css;
-#else
-    return processImageCpu(img3u, seg);
-#endif
+    pipe_pending = has_next;
+    if (has_next)
+        pipe_next = 1 - pipe_next;
+    return has_prev;
 }
 
 #ifdef _HFS_CUDA_ON_
-Mat HfsCore::getSLICIdxGpu(const Mat& img3u, int &num_css)
+void HfsCore::getSLICIdxGpu(const Mat& img3u, Mat& idx_mat, int &num_css)
 {
-    const int _h = img3u.rows;
-    const int _w = img3u.cols;
-    const int _s = _h*_w;
-
     loadImage(img3u, in_img);
     gslic_engine->setImageSize(img3u.cols, img3u.rows);
 
     gslic_engine->processFrame(in_img);
     const IntImage *idx_img = gslic_engine->getSegRes();
-    int* idx_img_ptr = (int*)idx_img->getCpuData();
-
-    num_css = 0;
-    int _max =
-        (int)ceil((float)_w / 8.0f)*(int)ceil((float)_h / 8.0f);
-    vector<int> indexes(_max, 0);
-    for (int i = 0; i < _s; i++)
-        indexes[idx_img_ptr[i]]++;
-    for (int i = 0; i < _max; i++)
-        indexes[i] = (indexes[i] != 0) ? num_css++ : 0;
-    for (int i = 0; i < _s; i++)
-        idx_img_ptr[i] = indexes[idx_img_ptr[i]];
-    Mat idx_mat(_h, _w, CV_32S, idx_img_ptr);
-    idx_mat.convertTo(idx_mat, CV_16U);
-    return idx_mat;
+    compactSLICIdx(idx_img->getCpuData(), img3u.rows, img3u.cols,
+        hfsSettings.slicSettings.spixel_size, idx_mat, num_css);
 }
 
 #endif
@@ -27,6 +27,16 @@ struct HfsSettings
     cv::hfs::slic::slicSettings slicSettings;
 };
 
+// intermediate results of the segmentation of a frame, kept from a call to the
+// next so that the buffers are reused for input of a fixed size
+struct HfsFrame
+{
+    cv::Mat img3u, lab3u, mag1u, idx_mat, segI;
+    int num_css;
+
+    HfsFrame() : num_css(0) {}
+};
+
 class HfsCore
 {
 public:
@@ -57,10 +67,22 @@ public:
     void drawSegmentationRes( const cv::Mat& seg, const cv::Mat& img3u,
                               int num_css, cv::Mat& show );
 
-    cv::Mat getSLICIdxCpu(const cv::Mat& img3u, int &num_css);
+    void getSLICIdxCpu(const cv::Mat& img3u, cv::Mat& idx_mat, int &num_css);
     int processImageCpu( const cv::Mat& img3u, cv::Mat& seg );
     int processImageGpu(const cv::Mat& img3u, cv::Mat& seg);
 
+    // first stage of the segmentation: superpixels, lab image and gradient
+    // magnitude of the frame
+    void prepareFrameCpu(const cv::Mat& img3u, HfsFrame& frame);
+    void prepareFrameGpu(const cv::Mat& img3u, HfsFrame& frame);
+    // second stage: merging of the superpixels of a prepared frame on the host
+    int mergeFrame(HfsFrame& frame, cv::Mat& seg);
+
+    // prepares img3u on the gpu while the regions of the previously given frame
+    // are merged, res receiving the result of that frame. An empty img3u flushes
+    // the pipeline. Returns false if there was no previous frame
+    bool processImagePipelined(const cv::Mat& img3u, bool ifDraw, cv::Mat& res);
+
     void constructEngine();
     void reconstructEngine();
 
@@ -70,10 +92,16 @@ public:
 private:
     std::vector<float> w1, w2;
     Ptr<Magnitude> mag_engine;
+    slic::cSLIC slic_engine;
+
+    HfsFrame frame;
+    HfsFrame pipe_frames[2];
+    int pipe_next;
+    bool pipe_pending;
 
 #ifdef _HFS_CUDA_ON_
 public:
-    cv::Mat getSLICIdxGpu(const cv::Mat& img3u, int &num_css);
+    void getSLICIdxGpu(const cv::Mat& img3u, cv::Mat& idx_mat, int &num_css);
 private:
     cv::Ptr<UChar4Image> in_img, out_img;
     cv::Ptr<slic::engines::CoreEngine> gslic_engine;
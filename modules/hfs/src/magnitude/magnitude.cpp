@@ -26,14 +26,7 @@ void Magnitude::loadImage(const Mat& inimg, Ptr<UCharImage> outimg)
     const int _h = inimg.rows, _w = inimg.cols;
     uchar* outimg_ptr = outimg->getCpuData();
     for (int y = 0; y < _h; y++)
-    {
-        const uchar *ptr = inimg.ptr<uchar>(y);
-        for (int x = 0; x < _w; x++)
-        {
-            int idx = x + y * _w;
-            outimg_ptr[idx] = ptr[x];
-        }
-    }
+        memcpy(outimg_ptr + y * _w, inimg.ptr<uchar>(y), _w);
 }
 
 void Magnitude::loadImage(const Ptr<UCharImage> inimg, Mat& outimg)
@@ -41,14 +34,7 @@ void Magnitude::loadImage(const Ptr<UCharImage> inimg, Mat& outimg)
     const int _h = outimg.rows, _w = outimg.cols;
     const uchar* inimg_ptr = inimg->getCpuData();
     for (int y = 0; y < _h; y++)
-    {
-        uchar *ptr = outimg.ptr<uchar>(y);
-        for (int x = 0; x < _w; x++)
-        {
-            int idx = x + y * outimg.cols;
-            ptr[x] = inimg_ptr[idx];
-        }
-    }
+        memcpy(outimg.ptr<uchar>(y), inimg_ptr + y * _w, _w);
 }
 
 void Magnitude::derrivativeXYCpu()
@@ -58,27 +44,29 @@ void Magnitude::derrivativeXYCpu()
     int *dy_ptr = delta_y->getCpuData();
     int *mag_ptr = mag->getCpuData();
 
-    for (int y = 0; y < img_size.y; ++y) {
-        for (int x = 0; x < img_size.x; ++x) {
-            int idx = y * img_size.x + x;
-            if (x == 0)
-                dx_ptr[idx] = gray_ptr[idx + 1] - gray_ptr[idx];
-            else if (x == img_size.x - 1)
-                dx_ptr[idx] = gray_ptr[idx] - gray_ptr[idx - 1];
-            else
-                dx_ptr[idx] = gray_ptr[idx + 1] - gray_ptr[idx - 1];
-
-            if (y == 0)
-                dy_ptr[idx] = gray_ptr[idx + img_size.x] - gray_ptr[idx];
-            else if (y == img_size.y - 1)
-                dy_ptr[idx] = gray_ptr[idx] - gray_ptr[idx - img_size.x];
-            else
-                dy_ptr[idx] = gray_ptr[idx + img_size.x] - gray_ptr[idx - img_size.x];
-
-            mag_ptr[idx] = (int)(0.5 + sqrt((double)(dx_ptr[idx] * dx_ptr[idx] + dy_ptr[idx] * dy_ptr[idx])));
+    parallel_for_(Range(0, img_size.y), [&](const Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            for (int x = 0; x < img_size.x; ++x) {
+                int idx = y * img_size.x + x;
+                if (x == 0)
+                    dx_ptr[idx] = gray_ptr[idx + 1] - gray_ptr[idx];
+                else if (x == img_size.x - 1)
+                    dx_ptr[idx] = gray_ptr[idx] - gray_ptr[idx - 1];
+                else
+                    dx_ptr[idx] = gray_ptr[idx + 1] - gray_ptr[idx - 1];
+
+                if (y == 0)
+                    dy_ptr[idx] = gray_ptr[idx + img_size.x] - gray_ptr[idx];
+                else if (y == img_size.y - 1)
+                    dy_ptr[idx] = gray_ptr[idx] - gray_ptr[idx - img_size.x];
+                else
+                    dy_ptr[idx] = gray_ptr[idx + img_size.x] - gray_ptr[idx - img_size.x];
+
+                mag_ptr[idx] = (int)(0.5 + sqrt((double)(dx_ptr[idx] * dx_ptr[idx] + dy_ptr[idx] * dy_ptr[idx])));
 
+            }
         }
-    }
+    });
 }
 
 void Magnitude::nonMaxSuppCpu()
@@ -88,122 +76,123 @@ void Magnitude::nonMaxSuppCpu()
     int *mag_ptr = mag->getCpuData();
     uchar *nms_ptr = nms_mag->getCpuData();
 
-    for (int y = 0; y < img_size.y; ++y) {
-        for (int x = 0; x < img_size.x; ++x) {
-            int idx = y*img_size.x + x;
-            if (x == 0 || x == img_size.x - 1 || y == 0 || y == img_size.y - 1) {
-                nms_ptr[idx] = 0;
-                continue;
-            }
-            int m00, gx, gy, z1, z2;
-            double mag1, mag2, xprep, yprep;
-
-            m00 = mag_ptr[idx];
-            if (m00 == 0) {
-                nms_ptr[idx] = 0;
-                continue;
-            }
-            else {
-                xprep = -(gx = dx_ptr[idx]) / ((double)m00);
-                yprep = (gy = dy_ptr[idx]) / ((double)m00);
-            }
-
-            if (gx >= 0) {
-                if (gy >= 0) {
-                    if (gx >= gy) {
-                        z1 = mag_ptr[idx - 1];
-                        z2 = mag_ptr[idx - img_size.x - 1];
-                        mag1 = (m00 - z1)*xprep + (z2 - z1)*yprep;
-
-                        z1 = mag_ptr[idx + 1];
-                        z2 = mag_ptr[idx + img_size.x + 1];
-                        mag2 = (m00 - z1)*xprep + (z2 - z1)*yprep;
-                    }
-                    else {
-                        z1 = mag_ptr[idx - img_size.x];
-                        z2 = mag_ptr[idx - img_size.x - 1];
-                        mag1 = (z1 - z2)*xprep + (z1 - m00)*yprep;
+    parallel_for_(Range(0, img_size.y), [&](const Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            for (int x = 0; x < img_size.x; ++x) {
+                int idx = y*img_size.x + x;
+                if (x == 0 || x == img_size.x - 1 || y == 0 || y == img_size.y - 1) {
+                    nms_ptr[idx] = 0;
+                    continue;
+                }
+                int m00, gx, gy, z1, z2;
+                double mag1, mag2, xprep, yprep;
 
-                        z1 = mag_ptr[idx + img_size.x];
-                        z2 = mag_ptr[idx + img_size.x + 1];
-                        mag2 = (z1 - z2)*xprep + (z1 - m00)*yprep;
-                    }
+                m00 = mag_ptr[idx];
+                if (m00 == 0) {
+                    nms_ptr[idx] = 0;
+                    continue;
                 }
                 else {
-                    if (gx >= -gy) {
-                        z1 = mag_ptr[idx - 1];
-                        z2 = mag_ptr[idx + img_size.x - 1];
-                        mag1 = (m00 - z1)*xprep + (z1 - z2)*yprep;
-
-                        z1 = mag_ptr[idx + 1];
-                        z2 = mag_ptr[idx - img_size.x + 1];
-                        mag2 = (m00 - z1)*xprep + (z1 - z2)*yprep;
-                    }
-                    else {
-                        z1 = mag_ptr[idx + img_size.x];
-                        z2 = mag_ptr[idx + img_size.x - 1];
-                        mag1 = (z1 - z2)*xprep + (m00 - z1)*yprep;
-
-                        z1 = mag_ptr[idx - img_size.x];
-                        z2 = mag_ptr[idx - img_size.x + 1];
-                        mag2 = (z1 - z2)*xprep + (m00 - z1)*yprep;
-                    }
+                    xprep = -(gx = dx_ptr[idx]) / ((double)m00);
+                    yprep = (gy = dy_ptr[idx]) / ((double)m00);
                 }
-            }
-            else {
-                if (gy >= 0) {
-                    if (-gx >= gy) {
-                        z1 = mag_ptr[idx + 1];
-                        z2 = mag_ptr[idx - img_size.x + 1];
-                        mag1 = (z1 - m00)*xprep + (z2 - z1)*yprep;
-
-                        z1 = mag_ptr[idx - 1];
-                        z2 = mag_ptr[idx + img_size.x - 1];
-                        mag2 = (z1 - m00)*xprep + (z2 - z1)*yprep;
+
+                if (gx >= 0) {
+                    if (gy >= 0) {
+                        if (gx >= gy) {
+                            z1 = mag_ptr[idx - 1];
+                            z2 = mag_ptr[idx - img_size.x - 1];
+                            mag1 = (m00 - z1)*xprep + (z2 - z1)*yprep;
+
+                            z1 = mag_ptr[idx + 1];
+                            z2 = mag_ptr[idx + img_size.x + 1];
+                            mag2 = (m00 - z1)*xprep + (z2 - z1)*yprep;
+                        }
+                        else {
+                            z1 = mag_ptr[idx - img_size.x];
+                            z2 = mag_ptr[idx - img_size.x - 1];
+                            mag1 = (z1 - z2)*xprep + (z1 - m00)*yprep;
+
+                            z1 = mag_ptr[idx + img_size.x];
+                            z2 = mag_ptr[idx + img_size.x + 1];
+                            mag2 = (z1 - z2)*xprep + (z1 - m00)*yprep;
+                        }
                     }
                     else {
-                        z1 = mag_ptr[idx - img_size.x];
-                        z2 = mag_ptr[idx - img_size.x + 1];
-                        mag1 = (z2 - z1)*xprep + (z1 - m00)*yprep;
-
-                        z1 = mag_ptr[idx + img_size.x];
-                        z2 = mag_ptr[idx + img_size.x - 1];
-                        mag2 = (z2 - z1)*xprep + (z1 - m00)*yprep;
+                        if (gx >= -gy) {
+                            z1 = mag_ptr[idx - 1];
+                            z2 = mag_ptr[idx + img_size.x - 1];
+                            mag1 = (m00 - z1)*xprep + (z1 - z2)*yprep;
+
+                            z1 = mag_ptr[idx + 1];
+                            z2 = mag_ptr[idx - img_size.x + 1];
+                            mag2 = (m00 - z1)*xprep + (z1 - z2)*yprep;
+                        }
+                        else {
+                            z1 = mag_ptr[idx + img_size.x];
+                            z2 = mag_ptr[idx + img_size.x - 1];
+                            mag1 = (z1 - z2)*xprep + (m00 - z1)*yprep;
+
+                            z1 = mag_ptr[idx - img_size.x];
+                            z2 = mag_ptr[idx - img_size.x + 1];
+                            mag2 = (z1 - z2)*xprep + (m00 - z1)*yprep;
+                        }
                     }
                 }
                 else {
-                    if (-gx > -gy) {
-                        z1 = mag_ptr[idx + 1];
-                        z2 = mag_ptr[idx + img_size.x + 1];
-                        mag1 = (z1 - m00)*xprep + (z1 - z2)*yprep;
-
-                        z1 = mag_ptr[idx - 1];
-                        z2 = mag_ptr[idx - img_size.x - 1];
-                        mag2 = (z1 - m00)*xprep + (z1 - z2)*yprep;
+                    if (gy >= 0) {
+                        if (-gx >= gy) {
+                            z1 = mag_ptr[idx + 1];
+                            z2 = mag_ptr[idx - img_size.x + 1];
+                            mag1 = (z1 - m00)*xprep + (z2 - z1)*yprep;
+
+                            z1 = mag_ptr[idx - 1];
+                            z2 = mag_ptr[idx + img_size.x - 1];
+                            mag2 = (z1 - m00)*xprep + (z2 - z1)*yprep;
+                        }
+                        else {
+                            z1 = mag_ptr[idx - img_size.x];
+                            z2 = mag_ptr[idx - img_size.x + 1];
+                            mag1 = (z2 - z1)*xprep + (z1 - m00)*yprep;
+
+                            z1 = mag_ptr[idx + img_size.x];
+                            z2 = mag_ptr[idx + img_size.x - 1];
+                            mag2 = (z2 - z1)*xprep + (z1 - m00)*yprep;
+                        }
                     }
                     else {
-                        z1 = mag_ptr[idx + img_size.x];
-                        z2 = mag_ptr[idx + img_size.x + 1];
-                        mag1 = (z2 - z1)*xprep + (m00 - z1)*yprep;
-
-                        z1 = mag_ptr[idx - img_size.x];
-                        z2 = mag_ptr[idx - img_size.x - 1];
-                        mag2 = (z2 - z1)*xprep + (m00 - z1)*yprep;
+                        if (-gx > -gy) {
+                            z1 = mag_ptr[idx + 1];
+                            z2 = mag_ptr[idx + img_size.x + 1];
+                            mag1 = (z1 - m00)*xprep + (z1 - z2)*yprep;
+
+                            z1 = mag_ptr[idx - 1];
+                            z2 = mag_ptr[idx - img_size.x - 1];
+                            mag2 = (z1 - m00)*xprep + (z1 - z2)*yprep;
+                        }
+                        else {
+                            z1 = mag_ptr[idx + img_size.x];
+                            z2 = mag_ptr[idx + img_size.x + 1];
+                            mag1 = (z2 - z1)*xprep + (m00 - z1)*yprep;
+
+                            z1 = mag_ptr[idx - img_size.x];
+                            z2 = mag_ptr[idx - img_size.x - 1];
+                            mag2 = (z2 - z1)*xprep + (m00 - z1)*yprep;
+                        }
                     }
                 }
-            }
 
-            if (mag1 > 0 || mag2 >= 0)
-                nms_ptr[idx] = 0;
-            else
-                nms_ptr[idx] = (uchar)min(max(m00, 0), 255);
+                if (mag1 > 0 || mag2 >= 0)
+                    nms_ptr[idx] = 0;
+                else
+                    nms_ptr[idx] = (uchar)min(max(m00, 0), 255);
+            }
         }
-    }
+    });
 }
 
 void Magnitude::processImgCpu(const Mat &bgr3u, Mat &mag1u)
 {
-    Mat gray, blur1u;
     cvtColor(bgr3u, gray, COLOR_BGR2GRAY);
     GaussianBlur(gray, blur1u, Size(7, 7), 1, 1);
 
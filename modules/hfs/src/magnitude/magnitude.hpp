@@ -23,6 +23,8 @@ class Magnitude
     cv::Ptr<IntImage> delta_x, delta_y, mag;
     cv::Ptr<UCharImage> gray_img, nms_mag;
     Vector2i img_size;
+    // intermediate images of the cpu path, kept from a call to the next
+    cv::Mat gray, blur1u;
 
 public:
     Magnitude(int height, int width);
@@ -6,6 +6,7 @@
 #define _OPENCV_PRECOMP_HPP_
 
 #include "opencv2/core.hpp"
+#include "opencv2/core/utility.hpp"
 #include "opencv2/imgproc.hpp"
 #include <vector>
 #include "math.h"
@@ -39,7 +39,7 @@ class cSLIC {
 private:
     cv::Mat image;
     cv::Mat lab;
-    std::vector<int> idx_img;
+    std::vector<int> idx_img, idx_img_cpy;
 
     cv::Vec2i map_size;
     std::vector<cSpixelInfo> spixel_list;
@@ -47,10 +47,10 @@ private:
     float spatial_weight;
     float max_xy_dist, max_color_dist;
 
-    float compute_dist(cv::Point pix, cSpixelInfo center_info);
+    float compute_dist(cv::Point pix, const cSpixelInfo& center_info) const;
 
     void init_data(cv::Mat image_);
-    cv::Mat cvt_img_space();
+    void cvt_img_space();
     void find_association();
     void update_cluster_center();
     void enforce_connect(int padding, int diff_threshold);
@@ -58,7 +58,8 @@ public:
     cSLIC() {}
     ~cSLIC() {}
 
-    std::vector<int> generate_superpixels(cv::Mat image, int spixel_size_, float spatial_weight_);
+    // the returned index map is owned by the object and is valid until the next call
+    const std::vector<int>& generate_superpixels(cv::Mat image, int spixel_size_, float spatial_weight_);
 };
 
 #ifdef _HFS_CUDA_ON_
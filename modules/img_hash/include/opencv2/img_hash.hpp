@@ -8,6 +8,7 @@
 #include "opencv2/img_hash/average_hash.hpp"
 #include "opencv2/img_hash/block_mean_hash.hpp"
 #include "opencv2/img_hash/color_moment_hash.hpp"
+#include "opencv2/img_hash/hash_index.hpp"
 #include "opencv2/img_hash/marr_hildreth_hash.hpp"
 #include "opencv2/img_hash/phash.hpp"
 #include "opencv2/img_hash/radial_variance_hash.hpp"
@@ -29,6 +30,8 @@ Namespace for all functions is cv::img_hash.
 - Block Mean Hash (modes 0 and 1)
 - Color Moment Hash (this is the one and only hash algorithm resist to rotation attack(-90~90 degree))
 
+The binary hashes of large data sets are searched by Hamming distance with img_hash::HashIndex.
+
 You can study more about image hashing from following paper and websites:
 
 - "Implementation and benchmarking of perceptual image hash functions" @cite zauner2010implementation
@@ -0,0 +1,71 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_HASH_INDEX_HPP
+#define OPENCV_HASH_INDEX_HPP
+
+#include "opencv2/core.hpp"
+
+namespace cv {
+namespace img_hash {
+
+//! @addtogroup img_hash
+//! @{
+
+/** @brief Index of binary hashes searched by Hamming distance
+
+Finds the near duplicates among the hashes of AverageHash, PHash, BlockMeanHash or MarrHildrethHash
+without comparing the query with every hash. The hashes are split into substrings which are each
+indexed by a hash table, a hash within a distance r of the query has at least one substring within
+a distance r/m of the query, m being the number of substrings (multi-index hashing @cite norouzi2012fast).
+The candidates found in the tables are verified with the full Hamming distance, large radiuses
+fall back to a parallel scan of all the hashes.
+
+The tables are built by the first search after hashes are added.
+*/
+class CV_EXPORTS_W HashIndex : public Algorithm
+{
+public:
+    /** @brief Adds hashes to the index
+        @param hashes CV_8UC1 hashes, one per row. All the hashes of an index have the same size, their
+        indices follow the order they are added in.
+    */
+    CV_WRAP virtual void add(InputArray hashes) = 0;
+
+    /** @brief Removes all the hashes */
+    CV_WRAP virtual void clear() = 0;
+
+    /** @brief Number of hashes in the index */
+    CV_WRAP virtual int size() const = 0;
+
+    /** @brief Finds all the hashes within a Hamming distance of the query
+        @param query hash to search
+        @param indices indices of the hashes found, sorted by distance then index
+        @param distances Hamming distances of the hashes found
+        @param radius maximum distance
+    */
+    CV_WRAP virtual void radiusSearch(InputArray query, CV_OUT std::vector<int>& indices,
+                                      CV_OUT std::vector<int>& distances, int radius) const = 0;
+
+    /** @brief Finds the nearest hashes of the query
+        @param query hash to search
+        @param indices indices of the k nearest hashes, sorted by distance then index
+        @param distances Hamming distances of the hashes found
+        @param k number of hashes to find
+    */
+    CV_WRAP virtual void knnSearch(InputArray query, CV_OUT std::vector<int>& indices,
+                                   CV_OUT std::vector<int>& distances, int k) const = 0;
+
+    /** @brief Creates an empty index
+        @param numSubstrings number of substrings the hashes are split to, each has at most 16 bits.
+        0 selects it from the number of hashes when the tables are built.
+    */
+    CV_WRAP static Ptr<HashIndex> create(int numSubstrings = 0);
+};
+
+//! @}
+
+}} // cv::img_hash::
+
+#endif // OPENCV_HASH_INDEX_HPP
@@ -26,6 +26,11 @@ public:
         @param outputArr hash of the image
     */
     CV_WRAP void compute(cv::InputArray inputArr, cv::OutputArray outputArr);
+    /** @brief Computes hashes of several images in parallel
+        @param inputArrs input images want to compute hash value
+        @param outputArr hashes of the images, one row per image with the same type as compute() gives
+    */
+    CV_WRAP void computeBatch(cv::InputArrayOfArrays inputArrs, cv::OutputArray outputArr);
     /** @brief Compare the hash value between inOne and inTwo
         @param hashOne Hash value one
         @param hashTwo Hash value two
@@ -0,0 +1,76 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+enum { HASH_AVERAGE, HASH_BLOCK_MEAN, HASH_COLOR_MOMENT, HASH_MARR_HILDRETH, HASH_PHASH, HASH_RADIAL_VARIANCE };
+CV_ENUM(HashType, HASH_AVERAGE, HASH_BLOCK_MEAN, HASH_COLOR_MOMENT, HASH_MARR_HILDRETH, HASH_PHASH, HASH_RADIAL_VARIANCE)
+
+static Ptr<img_hash::ImgHashBase> createHash(int type)
+{
+    switch (type)
+    {
+    case HASH_AVERAGE: return img_hash::AverageHash::create();
+    case HASH_BLOCK_MEAN: return img_hash::BlockMeanHash::create();
+    case HASH_COLOR_MOMENT: return img_hash::ColorMomentHash::create();
+    case HASH_MARR_HILDRETH: return img_hash::MarrHildrethHash::create();
+    case HASH_PHASH: return img_hash::PHash::create();
+    default: return img_hash::RadialVarianceHash::create();
+    }
+}
+
+typedef tuple<Size, HashType> ImgHashParams_t;
+typedef perf::TestBaseWithParam<ImgHashParams_t> ImgHash;
+
+PERF_TEST_P(ImgHash, compute, Combine(Values(szVGA, sz1080p), HashType::all()))
+{
+    const Size sz = get<0>(GetParam());
+    Ptr<img_hash::ImgHashBase> hash = createHash(get<1>(GetParam()));
+
+    Mat img(sz, CV_8UC3), code;
+    declare.in(img, WARMUP_RNG);
+
+    TEST_CYCLE() hash->compute(img, code);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef tuple<int, int> HashIndexParams_t;
+typedef perf::TestBaseWithParam<HashIndexParams_t> HashIndex;
+
+PERF_TEST_P(HashIndex, knnSearch, Combine(Values(10000, 100000), Values(1, 10)))
+{
+    const int count = get<0>(GetParam());
+    const int k = get<1>(GetParam());
+
+    // 64 bits codes as computed by PHash, the queries are stored codes with a few bits flipped
+    Mat codes(count, 8, CV_8UC1);
+    randu(codes, 0, 256);
+    Ptr<img_hash::HashIndex> index = img_hash::HashIndex::create();
+    index->add(codes);
+
+    const int numQueries = 100;
+    Mat queries(numQueries, 8, CV_8UC1);
+    RNG rng(42);
+    for (int i = 0; i < numQueries; ++i)
+    {
+        codes.row(rng.uniform(0, count)).copyTo(queries.row(i));
+        for (int b = 0; b < 3; ++b)
+            queries.at<uchar>(i, rng.uniform(0, 8)) ^= (uchar)(1 << rng.uniform(0, 8));
+    }
+
+    std::vector<int> indices, distances;
+    index->knnSearch(queries.row(0), indices, distances, k);
+
+    TEST_CYCLE()
+    {
+        for (int i = 0; i < numQueries; ++i)
+            index->knnSearch(queries.row(i), indices, distances, k);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
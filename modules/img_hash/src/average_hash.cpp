@@ -55,6 +55,11 @@ public:
     {
         return norm(hashOne, hashTwo, NORM_HAMMING);
     }
+
+    virtual Ptr<ImgHashImpl> clone() const CV_OVERRIDE
+    {
+        return makePtr<AverageHashImpl>();
+    }
 };
 
 } // namespace::
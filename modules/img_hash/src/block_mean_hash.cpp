@@ -78,6 +78,11 @@ public:
         return norm(hashOne, hashTwo, NORM_HAMMING);
     }
 
+    virtual Ptr<ImgHashImpl> clone() const CV_OVERRIDE
+    {
+        return makePtr<BlockMeanHashImpl>(mode_);
+    }
+
     void setMode(int mode)
     {
         CV_Assert(mode == BLOCK_MEAN_HASH_MODE_0 || mode == BLOCK_MEAN_HASH_MODE_1);
@@ -105,17 +110,23 @@ public:
     }
     void findMean(int pixRowStep, int pixColStep)
     {
+        // the sums of the blocks are exact integers, so the means are the same as cv::mean gives
+        cv::integral(grayImg_, sumImg_, CV_32S);
         size_t blockIdx = 0;
         for(int row = 0; row <= rowSize; row += pixRowStep)
         {
+            int const *top = sumImg_.ptr<int>(row);
+            int const *bottom = sumImg_.ptr<int>(row + blockHeigth);
             for(int col = 0; col <= colSize; col += pixColStep)
             {
-                mean_[blockIdx++] = cv::mean(grayImg_(cv::Rect(col, row, blockWidth, blockHeigth)))[0];
+                int const sum = bottom[col + blockWidth] - bottom[col] - top[col + blockWidth] + top[col];
+                mean_[blockIdx++] = static_cast<double>(sum) / (blockWidth * blockHeigth);
             }
         }
     }
 
     cv::Mat grayImg_;
+    cv::Mat sumImg_;
     std::vector<double> mean_;
     int mode_;
     cv::Mat resizeImg_;
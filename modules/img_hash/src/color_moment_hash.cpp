@@ -55,6 +55,11 @@ public:
       return norm(hashOne, hashTwo, NORM_L2) * 10000;
     }
 
+    virtual Ptr<ImgHashImpl> clone() const CV_OVERRIDE
+    {
+      return makePtr<ColorMomentHashImpl>();
+    }
+
 private:
     void computeMoments(double *inout)
     {
@@ -0,0 +1,350 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "opencv2/core/hal/hal.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+using namespace cv;
+using namespace cv::img_hash;
+using namespace std;
+
+namespace {
+
+//! the substrings index 2^16 buckets at most
+const int MAX_SUBSTRING_BITS = 16;
+
+struct Neighbor
+{
+    int dist;
+    int idx;
+    Neighbor(int d, int i) : dist(d), idx(i) {}
+    bool operator<(const Neighbor& other) const
+    {
+        return dist < other.dist || (dist == other.dist && idx < other.idx);
+    }
+};
+
+//! number of subsets of k elements among n, as a double to avoid overflows
+inline double binomial(int n, int k)
+{
+    double res = 1;
+    for (int i = 1; i <= k; ++i)
+        res = res * (n - k + i) / i;
+    return res;
+}
+
+//! next integer with the same number of bits set (Gosper's hack)
+inline unsigned nextCombination(unsigned v)
+{
+    unsigned c = v & (0u - v);
+    unsigned r = v + c;
+    return (((r ^ v) >> 2) / c) | r;
+}
+
+class HashIndexImpl CV_FINAL : public HashIndex
+{
+public:
+    explicit HashIndexImpl(int numSubstrings)
+        : numSubstrings_(numSubstrings), maxSubstringBits_(0), dirty_(false)
+    {
+        CV_Assert(numSubstrings >= 0);
+    }
+
+    virtual void add(InputArray hashes) CV_OVERRIDE
+    {
+        Mat h = hashes.getMat();
+        if (h.empty())
+            return;
+        CV_Assert(h.type() == CV_8UC1);
+        CV_Assert(codes_.empty() || h.cols == codes_.cols);
+        AutoLock lock(mutex_);
+        codes_.push_back(h);
+        dirty_ = true;
+    }
+
+    virtual void clear() CV_OVERRIDE
+    {
+        AutoLock lock(mutex_);
+        codes_.release();
+        substrings_.clear();
+        dirty_ = false;
+    }
+
+    virtual int size() const CV_OVERRIDE
+    {
+        return codes_.rows;
+    }
+
+    virtual void radiusSearch(InputArray query, std::vector<int>& indices,
+                              std::vector<int>& distances, int radius) const CV_OVERRIDE
+    {
+        CV_Assert(radius >= 0);
+        indices.clear();
+        distances.clear();
+        Mat queryMat = prepare(query);
+        if (queryMat.empty())
+            return;
+        const uchar* q = queryMat.ptr();
+
+        std::vector<Neighbor> res;
+        const int subRadius = radius / (int)substrings_.size();
+        if (probeCount(subRadius) >= codes_.rows)
+        {
+            std::vector<int> dist;
+            linearScan(q, dist);
+            for (int i = 0; i < codes_.rows; ++i)
+                if (dist[i] <= radius)
+                    res.push_back(Neighbor(dist[i], i));
+        }
+        else
+        {
+            std::vector<int> candidates;
+            for (size_t j = 0; j < substrings_.size(); ++j)
+                for (int e = 0; e <= subRadius; ++e)
+                    probe(substrings_[j], q, e, candidates);
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+            for (size_t i = 0; i < candidates.size(); ++i)
+            {
+                int d = distance(q, candidates[i]);
+                if (d <= radius)
+                    res.push_back(Neighbor(d, candidates[i]));
+            }
+        }
+        std::sort(res.begin(), res.end());
+        output(res, indices, distances);
+    }
+
+    virtual void knnSearch(InputArray query, std::vector<int>& indices,
+                           std::vector<int>& distances, int k) const CV_OVERRIDE
+    {
+        CV_Assert(k >= 0);
+        indices.clear();
+        distances.clear();
+        Mat queryMat = prepare(query);
+        if (queryMat.empty() || k == 0)
+            return;
+        const uchar* q = queryMat.ptr();
+        k = std::min(k, codes_.rows);
+
+        // the hashes not found yet at the level r have all their substrings farther than r,
+        // so they are at least m*(r+1) away from the query
+        const int m = (int)substrings_.size();
+        std::vector<Neighbor> heap;
+        std::unordered_set<int> seen;
+        std::vector<int> candidates;
+        double probes = 0;
+        bool done = false;
+        for (int r = 0; !done; ++r)
+        {
+            probes += probeCount(r) - (r > 0 ? probeCount(r - 1) : 0);
+            if (probes >= codes_.rows || r > maxSubstringBits_)
+                break;
+            candidates.clear();
+            for (int j = 0; j < m; ++j)
+                probe(substrings_[j], q, r, candidates);
+            for (size_t i = 0; i < candidates.size(); ++i)
+            {
+                int idx = candidates[i];
+                if (!seen.insert(idx).second)
+                    continue;
+                Neighbor n(distance(q, idx), idx);
+                if ((int)heap.size() < k)
+                {
+                    heap.push_back(n);
+                    std::push_heap(heap.begin(), heap.end());
+                }
+                else if (n < heap.front())
+                {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = n;
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+            done = (int)heap.size() == k && heap.front().dist < m * (r + 1);
+            done = done || (int)seen.size() == codes_.rows;
+        }
+
+        if (!done)
+        {
+            std::vector<int> dist;
+            linearScan(q, dist);
+            heap.clear();
+            heap.reserve(codes_.rows);
+            for (int i = 0; i < codes_.rows; ++i)
+                heap.push_back(Neighbor(dist[i], i));
+            std::partial_sort(heap.begin(), heap.begin() + k, heap.end());
+            heap.resize(k);
+        }
+        else
+        {
+            std::sort(heap.begin(), heap.end());
+        }
+        output(heap, indices, distances);
+    }
+
+private:
+    //! bucket table of the bits [start, start + len) of the hashes
+    struct Substring
+    {
+        int start;
+        int len;
+        //! ids of the hashes of bucket v are ids[offsets[v]] .. ids[offsets[v + 1] - 1]
+        std::vector<int> offsets;
+        std::vector<int> ids;
+    };
+
+    //! checks the query and builds the tables if hashes were added, returns an empty query if the index is empty
+    Mat prepare(InputArray query) const
+    {
+        {
+            AutoLock lock(mutex_);
+            if (dirty_)
+                build();
+        }
+        if (codes_.empty())
+            return Mat();
+        Mat q = query.getMat();
+        CV_Assert(q.type() == CV_8UC1 && q.isContinuous() && (int)q.total() == codes_.cols);
+        return q;
+    }
+
+    void build() const
+    {
+        const int bits = codes_.cols * 8;
+        const int minSubstrings = (bits + MAX_SUBSTRING_BITS - 1) / MAX_SUBSTRING_BITS;
+        int m = numSubstrings_;
+        if (m == 0)
+        {
+            int len = cvRound(std::log((double)codes_.rows) / std::log(2.0));
+            len = std::min(std::max(len, 4), MAX_SUBSTRING_BITS);
+            m = (bits + len - 1) / len;
+        }
+        m = std::min(std::max(m, minSubstrings), bits);
+
+        substrings_.resize(m);
+        maxSubstringBits_ = 0;
+        for (int j = 0, start = 0; j < m; ++j)
+        {
+            Substring& s = substrings_[j];
+            s.start = start;
+            s.len = bits / m + (j < bits % m ? 1 : 0);
+            start += s.len;
+            maxSubstringBits_ = std::max(maxSubstringBits_, s.len);
+        }
+
+        const int n = codes_.rows;
+        parallel_for_(Range(0, m), [&](const Range& range)
+        {
+            std::vector<int> keys(n);
+            for (int j = range.start; j < range.end; ++j)
+            {
+                Substring& s = substrings_[j];
+                s.offsets.assign(((size_t)1 << s.len) + 1, 0);
+                for (int i = 0; i < n; ++i)
+                {
+                    keys[i] = key(codes_.ptr(i), s);
+                    s.offsets[keys[i] + 1]++;
+                }
+                for (size_t v = 1; v < s.offsets.size(); ++v)
+                    s.offsets[v] += s.offsets[v - 1];
+                s.ids.resize(n);
+                std::vector<int> pos(s.offsets.begin(), s.offsets.end() - 1);
+                for (int i = 0; i < n; ++i)
+                    s.ids[pos[keys[i]]++] = i;
+            }
+        });
+        dirty_ = false;
+    }
+
+    int key(const uchar* code, const Substring& s) const
+    {
+        const int byte = s.start >> 3;
+        unsigned v = code[byte];
+        if (byte + 1 < codes_.cols)
+            v |= (unsigned)code[byte + 1] << 8;
+        if (byte + 2 < codes_.cols)
+            v |= (unsigned)code[byte + 2] << 16;
+        return (int)((v >> (s.start & 7)) & ((1u << s.len) - 1));
+    }
+
+    //! number of buckets read in every substring table by probing up to the substring radius r
+    double probeCount(int r) const
+    {
+        double res = 0;
+        for (size_t j = 0; j < substrings_.size(); ++j)
+            for (int e = 0; e <= std::min(r, substrings_[j].len); ++e)
+                res += binomial(substrings_[j].len, e);
+        return res;
+    }
+
+    //! appends the hashes of the buckets at exactly e bits from the substring of the query
+    void probe(const Substring& s, const uchar* q, int e, std::vector<int>& candidates) const
+    {
+        if (e > s.len)
+            return;
+        const unsigned qkey = (unsigned)key(q, s);
+        const unsigned limit = 1u << s.len;
+        unsigned mask = (1u << e) - 1;
+        for (;;)
+        {
+            const unsigned v = qkey ^ mask;
+            candidates.insert(candidates.end(), s.ids.begin() + s.offsets[v], s.ids.begin() + s.offsets[v + 1]);
+            if (e == 0)
+                break;
+            mask = nextCombination(mask);
+            if (mask >= limit)
+                break;
+        }
+    }
+
+    int distance(const uchar* q, int idx) const
+    {
+        return hal::normHamming(q, codes_.ptr(idx), codes_.cols);
+    }
+
+    void linearScan(const uchar* q, std::vector<int>& dist) const
+    {
+        dist.resize(codes_.rows);
+        parallel_for_(Range(0, codes_.rows), [&](const Range& range)
+        {
+            for (int i = range.start; i < range.end; ++i)
+                dist[i] = distance(q, i);
+        }, std::max(1., codes_.rows / 4096.));
+    }
+
+    static void output(const std::vector<Neighbor>& res, std::vector<int>& indices, std::vector<int>& distances)
+    {
+        indices.resize(res.size());
+        distances.resize(res.size());
+        for (size_t i = 0; i < res.size(); ++i)
+        {
+            indices[i] = res[i].idx;
+            distances[i] = res[i].dist;
+        }
+    }
+
+    int numSubstrings_;
+    Mat codes_;
+    mutable std::vector<Substring> substrings_;
+    mutable int maxSubstringBits_;
+    mutable bool dirty_;
+    mutable Mutex mutex_;
+};
+
+} // namespace::
+
+//==================================================================================================
+
+namespace cv { namespace img_hash {
+
+Ptr<HashIndex> HashIndex::create(int numSubstrings)
+{
+    return makePtr<HashIndexImpl>(numSubstrings);
+}
+
+}} // cv::img_hash::
@@ -20,6 +20,39 @@ void ImgHashBase::compute(cv::InputArray inputArr, cv::OutputArray outputArr)
     pImpl->compute(inputArr, outputArr);
 }
 
+void ImgHashBase::computeBatch(cv::InputArrayOfArrays inputArrs, cv::OutputArray outputArr)
+{
+    std::vector<Mat> inputs;
+    inputArrs.getMatVector(inputs);
+    if (inputs.empty())
+    {
+        outputArr.release();
+        return;
+    }
+
+    // all the hashes of an algorithm have the size and type of the first one
+    Mat first;
+    pImpl->compute(inputs[0], first);
+    first = first.reshape(0, 1);
+    outputArr.create((int)inputs.size(), first.cols, first.type());
+    Mat hashes = outputArr.getMat();
+    first.copyTo(hashes.row(0));
+
+    // every stripe reuses the buffers of its own instance
+    parallel_for_(Range(1, (int)inputs.size()), [&](const Range& range)
+    {
+        Ptr<ImgHashImpl> impl = pImpl->clone();
+        Mat hash;
+        for (int i = range.start; i < range.end; i++)
+        {
+            impl->compute(inputs[i], hash);
+            hash = hash.reshape(0, 1);
+            CV_Assert(hash.cols == hashes.cols && hash.type() == hashes.type());
+            hash.copyTo(hashes.row(i));
+        }
+    }, std::max(1, getNumThreads()));
+}
+
 double ImgHashBase::compare(cv::InputArray hashOne, cv::InputArray hashTwo) const
 {
     return pImpl->compare(hashOne, hashTwo);
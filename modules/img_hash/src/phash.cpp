@@ -28,25 +28,23 @@ public:
 
         grayImg.convertTo(grayFImg, CV_32F);
         cv::dct(grayFImg, dctImg);
-        dctImg(cv::Rect(0, 0, 8, 8)).copyTo(topLeftDCT);
-        topLeftDCT.at<float>(0, 0) = 0;
+        dctImg.at<float>(0, 0) = 0;
+        cv::Mat const topLeftDCT = dctImg(cv::Rect(0, 0, 8, 8));
         float const imgMean = static_cast<float>(cv::mean(topLeftDCT)[0]);
 
-        cv::compare(topLeftDCT, imgMean, bitsImg, CMP_GT);
-        bitsImg /= 255;
+        // bit k of the byte j is set if the coefficient k of the row j is above the mean
         outputArr.create(1, 8, CV_8U);
         cv::Mat hash = outputArr.getMat();
         uchar *hash_ptr = hash.ptr<uchar>(0);
-        uchar const *bits_ptr = bitsImg.ptr<uchar>(0);
-        std::bitset<8> bits;
-        for(size_t i = 0, j = 0; i != bitsImg.total(); ++j)
+        for(int j = 0; j != 8; ++j)
         {
-            for(size_t k = 0; k != 8; ++k)
+            float const *dct_ptr = topLeftDCT.ptr<float>(j);
+            uchar byte = 0;
+            for(int k = 0; k != 8; ++k)
             {
-                //avoid warning C4800, casting do not work
-                bits[k] = bits_ptr[i++] != 0;
+                byte |= static_cast<uchar>((dct_ptr[k] > imgMean) << k);
             }
-            hash_ptr[j] = static_cast<uchar>(bits.to_ulong());
+            hash_ptr[j] = byte;
         }
     }
 
@@ -55,13 +53,16 @@ public:
         return norm(hashOne, hashTwo, NORM_HAMMING);
     }
 
+    virtual Ptr<ImgHashImpl> clone() const CV_OVERRIDE
+    {
+        return makePtr<PHashImpl>();
+    }
+
 private:
-    cv::Mat bitsImg;
     cv::Mat dctImg;
     cv::Mat grayFImg;
     cv::Mat grayImg;
     cv::Mat resizeImg;
-    cv::Mat topLeftDCT;
 };
 
 } // namespace::
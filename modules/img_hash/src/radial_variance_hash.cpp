@@ -37,8 +37,17 @@ public:
     cv::Mat projections_;
     double sigma_;
 
+    //! the projections of an image size, projections_[projDst_[i]] = input[projSrc_[i]] in this order
+    std::vector<int> projDst_;
+    std::vector<int> projSrc_;
+    cv::Size projSize_;
+    size_t projStep_;
+    int projAngles_;
+    //! cosines of the DCT of the features, hashSize rows of features_.size() values
+    std::vector<double> dctTable_;
+
     RadialVarianceHashImpl(double sigma, int numOfAngleLine)
-        : numOfAngelLine_(numOfAngleLine), sigma_(sigma)
+        : numOfAngelLine_(numOfAngleLine), sigma_(sigma), projStep_(0), projAngles_(0)
     {
     }
 
@@ -111,6 +120,11 @@ public:
         return max;
     }
 
+    virtual Ptr<ImgHashImpl> clone() const CV_OVERRIDE
+    {
+        return makePtr<RadialVarianceHashImpl>(sigma_, numOfAngelLine_);
+    }
+
     int getNumOfAngleLine() const
     {
         return numOfAngelLine_;
@@ -134,34 +148,38 @@ public:
     void afterHalfProjections(cv::Mat const &input, int D, int xOff, int yOff)
     {
         int *pplPtr = pixPerLine_.ptr<int>(0);
+        int const step = static_cast<int>(input.step);
         int const init = 3*numOfAngelLine_/4;
         for(int k = init, j = 0; k < numOfAngelLine_; ++k, j += 2)
         {
             float const theta = k*3.14159f/numOfAngelLine_;
             float const alpha = std::tan(theta);
-            uchar *projDown = projections_.ptr<uchar>(k);
-            uchar *projUp = projections_.ptr<uchar>(k-j);
             for(int x = 0; x < D; ++x)
             {
                 float const y = alpha*(x-xOff);
                 int const yd = static_cast<int>(std::floor(y + roundingFactor(y)));
                 if((yd + yOff >= 0)&&(yd + yOff < input.rows) && (x < input.cols))
                 {
-                    projDown[x] = input.at<uchar>(yd+yOff, x);
+                    addProjection(k*D + x, (yd+yOff)*step + x);
                     pplPtr[k] += 1;
                 }
                 if ((yOff - yd >= 0)&&(yOff - yd < input.cols)&&
                         (2*yOff - x >= 0)&&(2*yOff- x < input.rows)&&
                         (k != init))
                 {
-                    projUp[x] =
-                            input.at<uchar>(-(x-yOff)+yOff, -yd+yOff);
+                    addProjection((k-j)*D + x, (-(x-yOff)+yOff)*step + (-yd+yOff));
                     pplPtr[k-j] += 1;
                 }
             }
         }
     }
 
+    void addProjection(int dst, int src)
+    {
+        projDst_.push_back(dst);
+        projSrc_.push_back(src);
+    }
+
     void findFeatureVector()
     {
         features_.resize(numOfAngelLine_);
@@ -170,8 +188,9 @@ public:
         int const *pplPtr = pixPerLine_.ptr<int>(0);
         for(int k=0; k < numOfAngelLine_; ++k)
         {
-            double lineSum = 0.0;
-            double lineSumSqd = 0.0;
+            // the sums of the pixels are exact in integers
+            int lineSum = 0;
+            int64 lineSumSqd = 0;
             //original implementation of pHash may generate zero pixNum, this
             //will cause NaN value and make the features become less discriminative
             //to avoid this problem, I add a small value--0.00001
@@ -180,12 +199,12 @@ public:
             uchar const *projPtr = projections_.ptr<uchar>(k);
             for(int i = 0; i < projections_.cols; ++i)
             {
-                double const value = projPtr[i];
+                int const value = projPtr[i];
                 lineSum += value;
                 lineSumSqd += value * value;
             }
-            features_[k] = (lineSumSqd/pixNum) -
-                    (lineSum*lineSum)/(pixNumPow2);
+            features_[k] = (static_cast<double>(lineSumSqd)/pixNum) -
+                    (static_cast<double>(lineSum)*lineSum)/(pixNumPow2);
             sum += features_[k];
             sumSqd += features_[k]*features_[k];
         }
@@ -201,27 +220,26 @@ public:
     void firstHalfProjections(cv::Mat const &input, int D, int xOff, int yOff)
     {
         int *pplPtr = pixPerLine_.ptr<int>(0);
+        int const step = static_cast<int>(input.step);
         for(int k = 0; k < numOfAngelLine_/4+1; ++k)
         {
             float const theta = k*3.14159f/numOfAngelLine_;
             float const alpha = std::tan(theta);
-            uchar *projOne = projections_.ptr<uchar>(k);
-            uchar *projTwo = projections_.ptr<uchar>(numOfAngelLine_/2-k);
+            int const kTwo = numOfAngelLine_/2-k;
             for(int x = 0; x < D; ++x)
             {
                 float const y = alpha*(x-xOff);
                 int const yd = static_cast<int>(std::floor(y + roundingFactor(y)));
                 if((yd + yOff >= 0)&&(yd + yOff < input.rows) && (x < input.cols))
                 {
-                    projOne[x] = input.at<uchar>(yd+yOff, x);
+                    addProjection(k*D + x, (yd+yOff)*step + x);
                     pplPtr[k] += 1;
                 }
                 if((yd + xOff >= 0) && (yd + xOff < input.cols) &&
                         (k != numOfAngelLine_/4) && (x < input.rows))
                 {
-                    projTwo[x] =
-                            input.at<uchar>(x, yd+xOff);
-                    pplPtr[numOfAngelLine_/2-k] += 1;
+                    addProjection(kTwo*D + x, x*step + yd+xOff);
+                    pplPtr[kTwo] += 1;
                 }
             }
         }
@@ -235,12 +253,24 @@ public:
         size_t const featureSize = features_.size();
         //constexpr is a better choice
         double const sqrtTwo = 1.4142135623730950488016887242097;
+        if(dctTable_.size() != hashSize*featureSize)
+        {
+            dctTable_.resize(hashSize*featureSize);
+            for(int k = 0; k < hashSize; ++k)
+            {
+                for(size_t n = 0; n < featureSize; ++n)
+                {
+                    dctTable_[k*featureSize + n] = std::cos((3.14159*(2*n+1)*k)/(2*featureSize));
+                }
+            }
+        }
         for(int k = 0; k < hash.cols; ++k)
         {
             double sum = 0;
+            double const *cosPtr = &dctTable_[k*featureSize];
             for(size_t n = 0; n < featureSize; ++n)
             {
-                sum += features_[n]*std::cos((3.14159*(2*n+1)*k)/(2*featureSize));
+                sum += features_[n]*cosPtr[n];
             }
             temp[k] = k == 0 ? sum/std::sqrt(featureSize) :
                                sum*sqrtTwo/std::sqrt(featureSize);
@@ -277,13 +307,32 @@ public:
         //because cv::Mat is row major but not column major
         projections_.create(numOfAngelLine_, D, CV_8U);
         projections_.setTo(cv::Scalar::all(0));
-        pixPerLine_.create(1, numOfAngelLine_, CV_32S);
-        pixPerLine_.setTo(cv::Scalar::all(0));
-        int const xOff = createOffSet(input.cols);
-        int const yOff = createOffSet(input.rows);
 
-        firstHalfProjections(input, D, xOff, yOff);
-        afterHalfProjections(input, D, xOff, yOff);
+        // the sampled pixels only depend on the geometry, they are found once per image size
+        if(projSize_ != input.size() || projStep_ != input.step || projAngles_ != numOfAngelLine_)
+        {
+            pixPerLine_.create(1, numOfAngelLine_, CV_32S);
+            pixPerLine_.setTo(cv::Scalar::all(0));
+            projDst_.clear();
+            projSrc_.clear();
+            int const xOff = createOffSet(input.cols);
+            int const yOff = createOffSet(input.rows);
+
+            firstHalfProjections(input, D, xOff, yOff);
+            afterHalfProjections(input, D, xOff, yOff);
+            projSize_ = input.size();
+            projStep_ = input.step;
+            projAngles_ = numOfAngelLine_;
+        }
+
+        uchar *projPtr = projections_.ptr<uchar>(0);
+        uchar const *inPtr = input.ptr<uchar>(0);
+        int const *dstPtr = projDst_.empty() ? NULL : &projDst_[0];
+        int const *srcPtr = projSrc_.empty() ? NULL : &projSrc_[0];
+        for(size_t i = 0; i < projDst_.size(); ++i)
+        {
+            projPtr[dstPtr[i]] = inPtr[srcPtr[i]];
+        }
     }
 };
 
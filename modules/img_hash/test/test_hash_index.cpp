@@ -0,0 +1,129 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+static void bruteForce(const Mat& codes, const Mat& query, int radius, int k,
+                       std::vector<int>& indices, std::vector<int>& distances)
+{
+    std::vector<std::pair<int, int> > res;
+    for (int i = 0; i < codes.rows; ++i)
+    {
+        int d = (int)cvtest::norm(codes.row(i), query, NORM_HAMMING);
+        if (d <= radius)
+            res.push_back(std::make_pair(d, i));
+    }
+    std::sort(res.begin(), res.end());
+    if (k >= 0 && (int)res.size() > k)
+        res.resize(k);
+    indices.clear();
+    distances.clear();
+    for (size_t i = 0; i < res.size(); ++i)
+    {
+        distances.push_back(res[i].first);
+        indices.push_back(res[i].second);
+    }
+}
+
+//! random hashes with clusters of near duplicates
+static Mat randomCodes(RNG& rng, int n, int bytes)
+{
+    Mat codes(n, bytes, CV_8UC1);
+    rng.fill(codes, RNG::UNIFORM, 0, 256);
+    for (int i = 1; i < n; i += 3)
+    {
+        codes.row(i - 1).copyTo(codes.row(i));
+        for (int f = rng.uniform(0, 6); f > 0; --f)
+        {
+            int bit = rng.uniform(0, bytes * 8);
+            codes.at<uchar>(i, bit / 8) ^= (uchar)(1 << (bit % 8));
+        }
+    }
+    return codes;
+}
+
+TEST(HashIndex, search_matches_brute_force)
+{
+    RNG& rng = theRNG();
+    const int bytes[] = { 8, 9, 16 };
+    for (int b = 0; b < 3; ++b)
+    {
+        Mat codes = randomCodes(rng, 2000, bytes[b]);
+        Ptr<img_hash::HashIndex> index = img_hash::HashIndex::create();
+        index->add(codes.rowRange(0, 1000));
+        index->add(codes.rowRange(1000, codes.rows));
+        ASSERT_EQ(codes.rows, index->size());
+
+        for (int t = 0; t < 20; ++t)
+        {
+            Mat query = codes.row(rng.uniform(0, codes.rows)).clone();
+            query.at<uchar>(0, rng.uniform(0, bytes[b])) ^= 1;
+
+            std::vector<int> indices, distances, expectedIndices, expectedDistances;
+            const int radius = rng.uniform(0, bytes[b] * 4);
+            index->radiusSearch(query, indices, distances, radius);
+            bruteForce(codes, query, radius, -1, expectedIndices, expectedDistances);
+            EXPECT_EQ(expectedIndices, indices) << "radius " << radius;
+            EXPECT_EQ(expectedDistances, distances) << "radius " << radius;
+
+            const int k = rng.uniform(1, 30);
+            index->knnSearch(query, indices, distances, k);
+            bruteForce(codes, query, bytes[b] * 8, k, expectedIndices, expectedDistances);
+            EXPECT_EQ(expectedIndices, indices) << "k " << k;
+            EXPECT_EQ(expectedDistances, distances) << "k " << k;
+        }
+    }
+}
+
+TEST(HashIndex, empty_and_clear)
+{
+    Ptr<img_hash::HashIndex> index = img_hash::HashIndex::create(4);
+    std::vector<int> indices, distances;
+    index->knnSearch(Mat::zeros(1, 8, CV_8UC1), indices, distances, 3);
+    EXPECT_TRUE(indices.empty());
+
+    index->add(Mat::zeros(2, 8, CV_8UC1));
+    index->radiusSearch(Mat::zeros(1, 8, CV_8UC1), indices, distances, 0);
+    EXPECT_EQ(2u, indices.size());
+
+    index->clear();
+    EXPECT_EQ(0, index->size());
+    index->radiusSearch(Mat::zeros(1, 8, CV_8UC1), indices, distances, 64);
+    EXPECT_TRUE(indices.empty());
+}
+
+TEST(ImgHashBase, computeBatch_matches_compute)
+{
+    RNG& rng = theRNG();
+    std::vector<Mat> images(7);
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        images[i].create(64 + (int)i * 5, 80, CV_8UC3);
+        rng.fill(images[i], RNG::UNIFORM, 0, 256);
+    }
+
+    std::vector<Ptr<img_hash::ImgHashBase> > hashes;
+    hashes.push_back(img_hash::AverageHash::create());
+    hashes.push_back(img_hash::PHash::create());
+    hashes.push_back(img_hash::BlockMeanHash::create());
+    hashes.push_back(img_hash::MarrHildrethHash::create());
+    hashes.push_back(img_hash::RadialVarianceHash::create());
+    hashes.push_back(img_hash::ColorMomentHash::create());
+    for (size_t h = 0; h < hashes.size(); ++h)
+    {
+        Mat batch;
+        hashes[h]->computeBatch(images, batch);
+        ASSERT_EQ((int)images.size(), batch.rows);
+        for (size_t i = 0; i < images.size(); ++i)
+        {
+            Mat single;
+            hashes[h]->compute(images[i], single);
+            EXPECT_EQ(0, cvtest::norm(single.reshape(1, 1), batch.row((int)i), NORM_INF)) << h << " " << i;
+        }
+    }
+}
+
+}} // namespace
@@ -151,4 +151,24 @@ void CV_RadialVarianceHashTest::run(int)
 
 TEST(radial_variance_hash_test, accuracy) { CV_RadialVarianceHashTest test; test.safe_run(); }
 
+TEST(radial_variance_hash_test, reused_for_other_sizes)
+{
+    RNG& rng = theRNG();
+    Ptr<RadialVarianceHash> reused = RadialVarianceHash::create(1, 20);
+    const Size sizes[] = { Size(64, 48), Size(48, 64), Size(64, 48), Size(33, 33) };
+    for (int i = 0; i < 4; ++i)
+    {
+        Mat input(sizes[i], CV_8UC1);
+        rng.fill(input, RNG::UNIFORM, 0, 256);
+        Mat hash, expected;
+        reused->compute(input, hash);
+        RadialVarianceHash::create(1, reused->getNumOfAngleLine())->compute(input, expected);
+        EXPECT_EQ(0, cvtest::norm(hash, expected, NORM_INF)) << sizes[i];
+        if (i == 1)
+            reused->setNumOfAngleLine(30);
+        else if (i == 2)
+            reused->setNumOfAngleLine(20);
+    }
+}
+
 }} // namespace
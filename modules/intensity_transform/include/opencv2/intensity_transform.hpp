@@ -7,6 +7,8 @@
 
 #include "opencv2/core.hpp"
 
+#include <vector>
+
 /**
  * @defgroup intensity_transform The module brings implementations of intensity transformation algorithms to adjust image contrast.
  *
@@ -72,6 +74,49 @@ CV_EXPORTS_W void autoscaling(const Mat input, Mat& output);
 */
 CV_EXPORTS_W void contrastStretching(const Mat input, Mat& output, const int r1, const int s1, const int r2, const int s2);
 
+/**
+ * @brief Chain of intensity transformations of 8-bit images applied in a single lookup pass.
+ *
+ * The transformations are applied in the order they are added, with the same results as calling
+ * the corresponding functions one after the other. The statistics needed by logTransform and
+ * autoscaling are derived from the values present in the input, so the whole chain is compiled
+ * to one table of 256 entries by every call to apply().
+ */
+class CV_EXPORTS_W IntensityTransformPipeline
+{
+public:
+    CV_WRAP IntensityTransformPipeline();
+
+    //! Appends logTransform().
+    CV_WRAP void addLogTransform();
+    //! Appends gammaCorrection() with the given gamma.
+    CV_WRAP void addGammaCorrection(float gamma);
+    //! Appends autoscaling().
+    CV_WRAP void addAutoscaling();
+    //! Appends contrastStretching() with the given points.
+    CV_WRAP void addContrastStretching(int r1, int s1, int r2, int s2);
+    //! Removes all the transformations.
+    CV_WRAP void clear();
+
+    /**
+     * @brief Applies the chain to an 8-bit image.
+     *
+     * @param input input 8-bit bgr or grayscale image.
+     * @param output resulting image, of the type of the input.
+     */
+    CV_WRAP void apply(InputArray input, OutputArray output) const;
+
+private:
+    struct Step
+    {
+        int type;
+        float gamma;
+        int r1, s1, r2, s2;
+    };
+
+    std::vector<Step> steps_;
+};
+
 /**
  * @brief Given an input color image, enhance low-light images using the BIMEF method (@cite ying2017bio @cite ying2017new).
  *
@@ -28,49 +28,31 @@
 
 #include "precomp.hpp"
 
-#ifdef HAVE_EIGEN
-#include <Eigen/Sparse>
-#include <opencv2/core/eigen.hpp>
+#include <opencv2/core/utility.hpp>
 #include <opencv2/imgproc.hpp>
-#endif
 
 namespace cv {
 namespace intensity_transform {
 
-#ifdef HAVE_EIGEN
 static void diff(const Mat_<float>& src, Mat_<float>& srcVDiff, Mat_<float>& srcHDiff)
 {
     srcVDiff = Mat_<float>(src.size());
-    for (int i = 0; i < src.rows; i++)
+    srcHDiff = Mat_<float>(src.size());
+    parallel_for_(Range(0, src.rows), [&](const Range& range)
     {
-        if (i < src.rows-1)
-        {
-            for (int j = 0; j < src.cols; j++)
-            {
-                srcVDiff(i,j) = src(i+1,j) - src(i,j);
-            }
-        }
-        else
+        for (int i = range.start; i < range.end; i++)
         {
+            const float* srcRow = src[i];
+            const float* srcNextRow = src[i < src.rows-1 ? i+1 : 0];
+            float* vDiffRow = srcVDiff[i];
+            float* hDiffRow = srcHDiff[i];
             for (int j = 0; j < src.cols; j++)
             {
-                srcVDiff(i,j) = src(0,j) - src(i,j);
+                vDiffRow[j] = srcNextRow[j] - srcRow[j];
+                hDiffRow[j] = srcRow[j < src.cols-1 ? j+1 : 0] - srcRow[j];
             }
         }
-    }
-
-    srcHDiff = Mat_<float>(src.size());
-    for (int j = 0; j < src.cols-1; j++)
-    {
-        for (int i = 0; i < src.rows; i++)
-        {
-            srcHDiff(i,j) = src(i,j+1) - src(i,j);
-        }
-    }
-    for (int i = 0; i < src.rows; i++)
-    {
-        srcHDiff(i,src.cols-1) = src(i,0) - src(i,src.cols-1);
-    }
+    });
 }
 
 static void computeTextureWeights(const Mat_<float>& x, float sigma, float sharpness, Mat_<float>& W_h, Mat_<float>& W_v)
@@ -89,152 +71,217 @@ static void computeTextureWeights(const Mat_<float>& x, float sigma, float sharp
     W_h = Mat_<float>(gauker_h.size());
     W_v = Mat_<float>(gauker_v.size());
 
-    for (int i = 0; i < gauker_h.rows; i++)
+    parallel_for_(Range(0, gauker_h.rows), [&](const Range& range)
     {
-        for (int j = 0; j < gauker_h.cols; j++)
+        for (int i = range.start; i < range.end; i++)
         {
-            W_h(i,j) = 1 / (std::abs(gauker_h(i,j)) * std::abs(dt0_h(i,j)) + sharpness);
-            W_v(i,j) = 1 / (std::abs(gauker_v(i,j)) * std::abs(dt0_v(i,j)) + sharpness);
-        }
-    }
-}
-
-template <class numeric_t>
-static Eigen::SparseMatrix<numeric_t> spdiags(const Eigen::Matrix<numeric_t,-1,-1> &B,
-                                              const Eigen::VectorXi &d, int m, int n) {
-    typedef Eigen::Triplet<numeric_t> triplet_t;
-    std::vector<triplet_t> triplets;
-    triplets.reserve(static_cast<size_t>(std::min(m,n)*d.size()));
-
-    for (int k = 0; k < d.size(); ++k) {
-        int diag = d(k);  // get diagonal
-        int i_start = std::max(-diag, 0); // get row of 1st element
-        int i_end = std::min(m, m-diag-(m-n)); // get row of last element
-        int j = -std::min(0, -diag); // get col of 1st element
-        int B_i; // start index i in matrix B
-        if (m < n) {
-            B_i = std::max(-diag,0); // m < n
-        } else {
-            B_i = std::max(0,diag); // m >= n
-        }
-        for (int i = i_start; i < i_end; ++i, ++j, ++B_i) {
-            triplets.push_back( {i, j,  B(B_i,k)} );
+            for (int j = 0; j < gauker_h.cols; j++)
+            {
+                W_h(i,j) = 1 / (std::abs(gauker_h(i,j)) * std::abs(dt0_h(i,j)) + sharpness);
+                W_v(i,j) = 1 / (std::abs(gauker_v(i,j)) * std::abs(dt0_v(i,j)) + sharpness);
+            }
         }
-    }
-    Eigen::SparseMatrix<numeric_t> A(m,n);
-    A.setFromTriplets(triplets.begin(), triplets.end());
-    return A;
+    });
 }
 
-
-static Mat solveLinearEquation(const Mat_<float>& img, Mat_<float>& W_h_, Mat_<float>& W_v_, float lambda)
+// The system of the smoothing is (I + lambda*L) x = img, L being the Laplacian of the periodic
+// 4-connected grid whose edge (i,j)-(i,j+1) is weighted by W_h(i,j) and edge (i,j)-(i+1,j) by
+// W_v(i,j). It is applied without building the matrix, one pass over the rows.
+struct SmoothingOperator
 {
-    Eigen::MatrixXf W_h;
-    cv2eigen(W_h_, W_h);
-    Eigen::MatrixXf tempx(W_h.rows(), W_h.cols());
-    tempx.block(0, 1, tempx.rows(), tempx.cols()-1) = W_h.block(0, 0, W_h.rows(), W_h.cols()-1);
-    for (Eigen::Index i = 0; i < tempx.rows(); i++)
+    SmoothingOperator(const Mat_<float>& W_h, const Mat_<float>& W_v, float lambda)
+        : wh(W_h * lambda), wv(W_v * lambda), diag(W_h.size())
     {
-        tempx(i,0) = W_h(i, W_h.cols()-1);
+        const int rows = wh.rows, cols = wh.cols;
+        parallel_for_(Range(0, rows), [&](const Range& range)
+        {
+            for (int i = range.start; i < range.end; i++)
+            {
+                const float* whRow = wh[i];
+                const float* wvRow = wv[i];
+                const float* wvPrevRow = wv[i > 0 ? i-1 : rows-1];
+                float* diagRow = diag[i];
+                for (int j = 0; j < cols; j++)
+                {
+                    diagRow[j] = 1 + whRow[j] + whRow[j > 0 ? j-1 : cols-1] + wvRow[j] + wvPrevRow[j];
+                }
+            }
+        });
     }
 
-    Eigen::MatrixXf W_v;
-    cv2eigen(W_v_, W_v);
-    Eigen::MatrixXf tempy(W_v.rows(), W_v.cols());
-    tempy.block(1, 0, tempx.rows()-1, tempx.cols()) = W_v.block(0, 0, W_v.rows()-1, W_v.cols());
-    for (Eigen::Index j = 0; j < tempy.cols(); j++)
+    // y = A*x, returns the dot product of x and y
+    double apply(const Mat_<float>& x, Mat_<float>& y) const
     {
-        tempy(0,j) = W_v(W_v.rows()-1, j);
+        const int rows = x.rows, cols = x.cols;
+        std::vector<double> rowDots(rows);
+        parallel_for_(Range(0, rows), [&](const Range& range)
+        {
+            for (int i = range.start; i < range.end; i++)
+            {
+                const int up = i > 0 ? i-1 : rows-1, down = i < rows-1 ? i+1 : 0;
+                const float* xRow = x[i];
+                const float* xUpRow = x[up];
+                const float* xDownRow = x[down];
+                const float* whRow = wh[i];
+                const float* wvRow = wv[i];
+                const float* wvUpRow = wv[up];
+                const float* diagRow = diag[i];
+                float* yRow = y[i];
+                double rowDot = 0;
+                for (int j = 0; j < cols; j++)
+                {
+                    const int left = j > 0 ? j-1 : cols-1, right = j < cols-1 ? j+1 : 0;
+                    yRow[j] = diagRow[j] * xRow[j]
+                            - whRow[j] * xRow[right] - whRow[left] * xRow[left]
+                            - wvRow[j] * xDownRow[j] - wvUpRow[j] * xUpRow[j];
+                    rowDot += (double)xRow[j] * yRow[j];
+                }
+                rowDots[i] = rowDot;
+            }
+        });
+
+        double res = 0;
+        for (int i = 0; i < rows; i++)
+        {
+            res += rowDots[i];
+        }
+        return res;
     }
 
+    Mat_<float> wh, wv, diag;
+};
 
-    Eigen::VectorXf dx(W_h.rows()*W_h.cols());
-    Eigen::VectorXf dy(W_v.rows()*W_v.cols());
+// Jacobi preconditioned conjugate gradient, stopped when |b - A*x| <= tolerance*|b|
+static Mat solveLinearEquation(const Mat_<float>& img, const Mat_<float>& W_h, const Mat_<float>& W_v, float lambda,
+                               float tolerance = 0.1f, int maxIterations = 50)
+{
+    const SmoothingOperator A(W_h, W_v, lambda);
+    const int rows = img.rows, cols = img.cols;
 
-    Eigen::VectorXf dxa(tempx.rows()*tempx.cols());
-    Eigen::VectorXf dya(tempy.rows()*tempy.cols());
+    // the smoothed image is close to the image itself
+    Mat_<float> x = img.clone();
+    Mat_<float> r(img.size()), z(img.size()), p(img.size()), Ap(img.size());
+    std::vector<double> rowSums(2 * rows);
 
-    //Flatten in a col-major order
-    for (Eigen::Index j = 0; j < W_h.cols(); j++)
+    // r = b - A*x, z = r / diag, returns r.z and r.r
+    auto updateResidual = [&](bool initial, float alpha, double& rz, double& rr)
     {
-        for (Eigen::Index i = 0; i < W_h.rows(); i++)
+        parallel_for_(Range(0, rows), [&](const Range& range)
         {
-            dx(j*W_h.rows() + i) = -lambda*W_h(i,j);
-            dy(j*W_h.rows() + i) = -lambda*W_v(i,j);
+            for (int i = range.start; i < range.end; i++)
+            {
+                const float* bRow = img[i];
+                const float* diagRow = A.diag[i];
+                const float* pRow = p[i];
+                const float* ApRow = Ap[i];
+                float* xRow = x[i];
+                float* rRow = r[i];
+                float* zRow = z[i];
+                double rowRz = 0, rowRr = 0;
+                for (int j = 0; j < cols; j++)
+                {
+                    if (initial)
+                    {
+                        rRow[j] = bRow[j] - ApRow[j];
+                    }
+                    else
+                    {
+                        xRow[j] += alpha * pRow[j];
+                        rRow[j] -= alpha * ApRow[j];
+                    }
+                    zRow[j] = rRow[j] / diagRow[j];
+                    rowRz += (double)rRow[j] * zRow[j];
+                    rowRr += (double)rRow[j] * rRow[j];
+                }
+                rowSums[2*i] = rowRz;
+                rowSums[2*i+1] = rowRr;
+            }
+        });
 
-            dxa(j*W_h.rows() + i) = -lambda*tempx(i,j);
-            dya(j*W_h.rows() + i) = -lambda*tempy(i,j);
+        rz = rr = 0;
+        for (int i = 0; i < rows; i++)
+        {
+            rz += rowSums[2*i];
+            rr += rowSums[2*i+1];
         }
-    }
-
-    tempx.setZero();
-    tempx.col(0) = W_h.col(W_h.cols()-1);
+    };
 
-    tempy.setZero();
-    tempy.row(0) = W_v.row(W_v.rows()-1);
-
-    W_h.col(W_h.cols()-1).setZero();
-    W_v.row(W_v.rows()-1).setZero();
+    const double bNorm2 = img.dot(img);
+    if (bNorm2 == 0)
+    {
+        return Mat_<float>::zeros(img.size());
+    }
+    const double threshold = (double)tolerance * tolerance * bNorm2;
 
-    Eigen::VectorXf dxd1(tempx.rows()*tempx.cols());
-    Eigen::VectorXf dyd1(tempy.rows()*tempy.cols());
-    Eigen::VectorXf dxd2(W_h.rows()*W_h.cols());
-    Eigen::VectorXf dyd2(W_v.rows()*W_v.cols());
+    double rz, rr;
+    A.apply(x, Ap);
+    updateResidual(true, 0.f, rz, rr);
+    z.copyTo(p);
 
-    //Flatten in a col-major order
-    for (Eigen::Index j = 0; j < tempx.cols(); j++)
+    for (int iter = 0; iter < maxIterations && rr > threshold; iter++)
     {
-        for (Eigen::Index i = 0; i < tempx.rows(); i++)
+        const double pAp = A.apply(p, Ap);
+        if (pAp <= 0)
         {
-            dxd1(j*tempx.rows() + i) = -lambda*tempx(i,j);
-            dyd1(j*tempx.rows() + i) = -lambda*tempy(i,j);
-
-            dxd2(j*tempx.rows() + i) = -lambda*W_h(i,j);
-            dyd2(j*tempx.rows() + i) = -lambda*W_v(i,j);
+            break;
         }
+        const float alpha = static_cast<float>(rz / pAp);
+
+        const double rzPrev = rz;
+        updateResidual(false, alpha, rz, rr);
+
+        const float beta = static_cast<float>(rz / rzPrev);
+        parallel_for_(Range(0, rows), [&](const Range& range)
+        {
+            for (int i = range.start; i < range.end; i++)
+            {
+                const float* zRow = z[i];
+                float* pRow = p[i];
+                for (int j = 0; j < cols; j++)
+                {
+                    pRow[j] = zRow[j] + beta * pRow[j];
+                }
+            }
+        });
     }
 
-    Eigen::MatrixXf dxd(dxd1.rows(), dxd1.cols()+dxd2.cols());
-    dxd << dxd1, dxd2;
+    return std::move(x);
+}
 
-    Eigen::MatrixXf dyd(dyd1.rows(), dyd1.cols()+dyd2.cols());
-    dyd << dyd1, dyd2;
+// Upsamples the illumination map with a guided filter whose coefficients are computed at the low
+// resolution against the downscaled guide, then interpolated and applied to the full guide, so that
+// the map follows the strong edges of the input instead of blurring them
+static Mat_<float> guidedUpsample(const Mat_<float>& src, const Mat_<float>& guideLowRes, const Mat_<float>& guide,
+                                  int radius = 2, float eps = 0.01f)
+{
+    const Size ksize(2*radius + 1, 2*radius + 1);
 
-    const int k = img.rows*img.cols;
-    const int r = img.rows;
-    Eigen::Matrix<int, 2, 1> diagx_idx;
-    diagx_idx << -k+r, -r;
-    Eigen::SparseMatrix<float> Ax = spdiags(dxd, diagx_idx, k, k);
+    Mat_<float> meanI, meanP, corrI, corrIP;
+    boxFilter(guideLowRes, meanI, CV_32F, ksize);
+    boxFilter(src, meanP, CV_32F, ksize);
+    boxFilter(guideLowRes.mul(guideLowRes), corrI, CV_32F, ksize);
+    boxFilter(guideLowRes.mul(src), corrIP, CV_32F, ksize);
 
-    Eigen::Matrix<int, 2, 1> diagy_idx;
-    diagy_idx << -r+1, -1;
-    Eigen::SparseMatrix<float> Ay = spdiags(dyd, diagy_idx, k, k);
+    Mat_<float> varI = corrI - meanI.mul(meanI);
+    Mat_<float> covIP = corrIP - meanI.mul(meanP);
 
-    Eigen::MatrixXf D = (dx + dy + dxa + dya);
-    D = Eigen::MatrixXf::Ones(D.rows(), D.cols()) - D;
+    Mat_<float> a = covIP / (varI + eps);
+    Mat_<float> b = meanP - a.mul(meanI);
 
-    Eigen::Matrix<int, 1, 1> diag_idx_zero;
-    diag_idx_zero << 0;
-    Eigen::SparseMatrix<float> A = (Ax + Ay) + Eigen::SparseMatrix<float>((Ax + Ay).transpose()) + spdiags(D, diag_idx_zero, k, k);
+    Mat_<float> meanA, meanB;
+    boxFilter(a, meanA, CV_32F, ksize);
+    boxFilter(b, meanB, CV_32F, ksize);
 
-    //CG solver of Eigen
-    Eigen::ConjugateGradient<Eigen::SparseMatrix<float>, Eigen::Lower|Eigen::Upper, Eigen::IncompleteCholesky<float> > cg;
-    cg.setTolerance(0.1f);
-    cg.setMaxIterations(50);
-    cg.compute(A);
-    Mat_<float> img_t = img.t();
-    Eigen::Map<const Eigen::VectorXf> tin(img_t.ptr<float>(), img_t.rows*img_t.cols);
-    Eigen::VectorXf x = cg.solve(tin);
+    Mat_<float> meanAUp, meanBUp;
+    resize(meanA, meanAUp, guide.size(), 0, 0, INTER_LINEAR);
+    resize(meanB, meanBUp, guide.size(), 0, 0, INTER_LINEAR);
 
-    Mat_<float> tout(img.rows, img.cols);
-    tout.forEach(
-        [&](float &pixel, const int * position) -> void
-        {
-            pixel = x(position[1]*img.rows + position[0]);
-        }
-    );
+    Mat_<float> dst = meanAUp.mul(guide) + meanBUp;
 
-    return std::move(tout);
+    // the map is raised to the power mu afterwards
+    dst = min(max(dst, 0.0), 1.0);
+
+    return dst;
 }
 
 static Mat_<float> tsmooth(const Mat_<float>& src, float lambda=0.01f, float sigma=3.0f, float sharpness=0.001f)
@@ -474,7 +521,7 @@ static Mat_<Vec3f> maxEntropyEnhance(const Mat_<Vec3f>& I, const Mat_<uchar>& is
 
 static void BIMEF_impl(InputArray input_, OutputArray output_, float mu, float *k, float a, float b)
 {
-    CV_INSTRUMENT_REGION()
+    CV_INSTRUMENT_REGION();
 
     Mat input = input_.getMat();
     if (input.empty())
@@ -503,8 +550,7 @@ static void BIMEF_impl(InputArray input_, OutputArray output_, float mu, float *
     Mat_<float> t_b_resize;
     resize(t_b, t_b_resize, Size(), 0.5, 0.5);
 
-    Mat_<float> t_our = tsmooth(t_b_resize, lambda, sigma);
-    resize(t_our, t_our, t_b.size());
+    Mat_<float> t_our = guidedUpsample(tsmooth(t_b_resize, lambda, sigma), t_b_resize, t_b);
 
     // k: exposure ratio
     Mat_<Vec3f> J;
@@ -552,12 +598,6 @@ static void BIMEF_impl(InputArray input_, OutputArray output_, float mu, float *
         }
     );
 }
-#else
-static void BIMEF_impl(InputArray, OutputArray, float, float *, float, float)
-{
-    CV_Error(Error::StsNotImplemented, "This algorithm requires OpenCV built with the Eigen library.");
-}
-#endif
 
 void BIMEF(InputArray input, OutputArray output, float mu, float a, float b)
 {
@@ -10,10 +10,24 @@ using namespace std;
 namespace cv {
 namespace intensity_transform {
 
-void logTransform(const Mat input, Mat& output)
+namespace {
+
+enum { STEP_LOG, STEP_GAMMA, STEP_AUTOSCALING, STEP_CONTRAST_STRETCHING };
+
+// The tables of the data dependent transformations are computed by the very same operations as
+// the full images, on the ramp of all the 8-bit values, so that both give the same results.
+Mat ramp8u()
+{
+    Mat ramp(1, 256, CV_8U);
+    for (int i = 0; i < 256; i++)
+    {
+        ramp.at<uchar>(i) = (uchar)i;
+    }
+    return ramp;
+}
+
+void logTransformImpl(const Mat& input, double maxVal, Mat& output)
 {
-    double maxVal;
-    minMaxLoc(input, NULL, &maxVal, NULL, NULL);
     const double c = 255 / log(1 + maxVal);
     Mat add_one_64f;
     input.convertTo(add_one_64f, CV_64F, 1, 1.0f);
@@ -22,13 +36,79 @@ void logTransform(const Mat input, Mat& output)
     log_64f.convertTo(output, CV_8UC3, c, 0.0f);
 }
 
-void gammaCorrection(const Mat input, Mat& output, const float gamma)
+void autoscalingImpl(const Mat& input, double minVal, double maxVal, Mat& output)
 {
-    std::array<uchar, 256> table;
+    output = 255 * (input - minVal) / (maxVal - minVal);
+}
+
+void gammaTable(float gamma, Mat& table)
+{
+    table.create(1, 256, CV_8U);
     for (int i = 0; i < 256; i++)
     {
-        table[i] = saturate_cast<uchar>(pow((i / 255.0), gamma) * 255.0);
+        table.at<uchar>(i) = saturate_cast<uchar>(pow((i / 255.0), gamma) * 255.0);
     }
+}
+
+void contrastStretchingTable(int r1, int s1, int r2, int s2, Mat& table)
+{
+    table.create(1, 256, CV_8U);
+    for (int i = 0; i < 256; i++)
+    {
+        uchar& value = table.at<uchar>(i);
+        if (i <= r1)
+        {
+            value = saturate_cast<uchar>(((float)s1 / (float)r1) * i);
+        }
+        else if (r1 < i && i <= r2)
+        {
+            value = saturate_cast<uchar>(((float)(s2 - s1)/(float)(r2 - r1)) * (i - r1) + s1);
+        }
+        else // (r2 < i)
+        {
+            value = saturate_cast<uchar>(((float)(255 - s2)/(float)(255 - r2)) * (i - r2) + s2);
+        }
+    }
+}
+
+// range of the values present in the image, as given by minMaxLoc on the image itself
+void presentRange(const bool* present, double& minVal, double& maxVal)
+{
+    int lo = 0, hi = 255;
+    while (lo < 255 && !present[lo])
+    {
+        lo++;
+    }
+    while (hi > 0 && !present[hi])
+    {
+        hi--;
+    }
+    minVal = lo;
+    maxVal = hi;
+}
+
+} // namespace
+
+void logTransform(const Mat input, Mat& output)
+{
+    double maxVal;
+    minMaxLoc(input, NULL, &maxVal, NULL, NULL);
+
+    if (input.depth() == CV_8U)
+    {
+        Mat table;
+        logTransformImpl(ramp8u(), maxVal, table);
+        LUT(input, table, output);
+        return;
+    }
+
+    logTransformImpl(input, maxVal, output);
+}
+
+void gammaCorrection(const Mat input, Mat& output, const float gamma)
+{
+    Mat table;
+    gammaTable(gamma, table);
 
     LUT(input, table, output);
 }
@@ -37,29 +117,127 @@ void autoscaling(const Mat input, Mat& output)
 {
     double minVal, maxVal;
     minMaxLoc(input, &minVal, &maxVal, NULL, NULL);
-    output = 255 * (input - minVal) / (maxVal - minVal);
+
+    if (input.depth() == CV_8U)
+    {
+        Mat table;
+        autoscalingImpl(ramp8u(), minVal, maxVal, table);
+        LUT(input, table, output);
+        return;
+    }
+
+    autoscalingImpl(input, minVal, maxVal, output);
 }
 
 void contrastStretching(const Mat input, Mat& output, const int r1, const int s1, const int r2, const int s2)
 {
-    std::array<uchar, 256> table;
-    for (int i = 0; i < 256; i++)
+    Mat table;
+    contrastStretchingTable(r1, s1, r2, s2, table);
+
+    LUT(input, table, output);
+}
+
+IntensityTransformPipeline::IntensityTransformPipeline()
+{
+}
+
+void IntensityTransformPipeline::addLogTransform()
+{
+    Step step = { STEP_LOG, 0.f, 0, 0, 0, 0 };
+    steps_.push_back(step);
+}
+
+void IntensityTransformPipeline::addGammaCorrection(float gamma)
+{
+    Step step = { STEP_GAMMA, gamma, 0, 0, 0, 0 };
+    steps_.push_back(step);
+}
+
+void IntensityTransformPipeline::addAutoscaling()
+{
+    Step step = { STEP_AUTOSCALING, 0.f, 0, 0, 0, 0 };
+    steps_.push_back(step);
+}
+
+void IntensityTransformPipeline::addContrastStretching(int r1, int s1, int r2, int s2)
+{
+    Step step = { STEP_CONTRAST_STRETCHING, 0.f, r1, s1, r2, s2 };
+    steps_.push_back(step);
+}
+
+void IntensityTransformPipeline::clear()
+{
+    steps_.clear();
+}
+
+void IntensityTransformPipeline::apply(InputArray _input, OutputArray _output) const
+{
+    CV_INSTRUMENT_REGION();
+
+    Mat input = _input.getMat();
+    CV_CheckDepthEQ(input.depth(), CV_8U, "Input image must be 8-bits");
+
+    bool dataDependent = false;
+    for (size_t i = 0; i < steps_.size(); i++)
     {
-        if (i <= r1)
+        dataDependent = dataDependent || steps_[i].type == STEP_LOG || steps_[i].type == STEP_AUTOSCALING;
+    }
+
+    // values present in the image after the steps applied so far
+    bool present[256] = { false };
+    if (dataDependent && !input.empty())
+    {
+        const int cols = input.cols * input.channels();
+        for (int y = 0; y < input.rows; y++)
         {
-            table[i] = saturate_cast<uchar>(((float)s1 / (float)r1) * i);
+            const uchar* row = input.ptr<uchar>(y);
+            for (int x = 0; x < cols; x++)
+            {
+                present[row[x]] = true;
+            }
         }
-        else if (r1 < i && i <= r2)
+    }
+
+    Mat lut = ramp8u(), table;
+    uchar* lutData = lut.ptr<uchar>();
+
+    for (size_t i = 0; i < steps_.size(); i++)
+    {
+        const Step& step = steps_[i];
+        double minVal, maxVal;
+
+        switch (step.type)
         {
-            table[i] = saturate_cast<uchar>(((float)(s2 - s1)/(float)(r2 - r1)) * (i - r1) + s1);
+        case STEP_LOG:
+            presentRange(present, minVal, maxVal);
+            logTransformImpl(ramp8u(), maxVal, table);
+            break;
+        case STEP_GAMMA:
+            gammaTable(step.gamma, table);
+            break;
+        case STEP_AUTOSCALING:
+            presentRange(present, minVal, maxVal);
+            autoscalingImpl(ramp8u(), minVal, maxVal, table);
+            break;
+        default:
+            contrastStretchingTable(step.r1, step.s1, step.r2, step.s2, table);
+            break;
         }
-        else // (r2 < i)
+
+        const uchar* tableData = table.ptr<uchar>();
+        bool next[256] = { false };
+        for (int v = 0; v < 256; v++)
         {
-            table[i] = saturate_cast<uchar>(((float)(255 - s2)/(float)(255 - r2)) * (i - r2) + s2);
+            if (present[v])
+            {
+                next[tableData[v]] = true;
+            }
+            lutData[v] = tableData[lutData[v]];
         }
+        std::copy(next, next + 256, present);
     }
 
-    LUT(input, table, output);
+    LUT(input, lut, _output);
 }
 
-}} // cv::intensity_transform::
\ No newline at end of file
+}} // cv::intensity_transform::
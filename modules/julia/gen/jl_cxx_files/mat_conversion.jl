@@ -35,15 +35,62 @@ function cpp_to_julia(mat::CxxMat)
     else
         error("Bad type returned from OpenCV")
     end
-    steps = [rets[6]/sizeof(dtype), rets[7]/sizeof(dtype)]
-    # println(steps[1]/rets[3], steps[2]/rets[3]/rets[4])
-    #TODO: Implement views when steps do not result in continous memory
-    arr = Base.unsafe_wrap(Array{dtype, 3}, Ptr{dtype}(rets[1].cpp_object), (rets[3], rets[4], rets[5]))
+    ptr = Ptr{dtype}(rets[1].cpp_object)
+    cn, cols, rows = rets[3], rets[4], rets[5]
+    rowstep = rets[7]
+    if rows <= 1 || rowstep == cn*cols*sizeof(dtype)
+        arr = Base.unsafe_wrap(Array{dtype, 3}, ptr, (cn, cols, rows))
+    elseif rowstep % (cn*sizeof(dtype)) == 0
+        # ROI of a larger Mat, expose the padded rows through a strided view
+        padded = Base.unsafe_wrap(Array{dtype, 3}, ptr, (cn, div(rowstep, cn*sizeof(dtype)), rows))
+        arr = view(padded, :, 1:cols, :)
+    else
+        # Rows are not aligned to whole pixels, gather them
+        arr = Array{dtype, 3}(undef, cn, cols, rows)
+        for r in 1:rows
+            unsafe_copyto!(pointer(arr, (r-1)*cn*cols+1), ptr + (r-1)*rowstep, cn*cols)
+        end
+        return Mat{dtype}(nothing, arr)
+    end
+
+    # Output written in place into an array passed from Julia, keep it alive
+    # together with the Mat
+    owner = julia_owner(UInt(ptr))
+    if owner !== nothing
+        return Mat{dtype}((mat, owner), arr)
+    end
 
     #Preserve Mat so that array allocated by C++ isn't deallocated
     return Mat{dtype}(mat, arr)
 end
 
+# Arrays whose memory was handed to OpenCV, keyed by their data pointer. Lets
+# cpp_to_julia recognize outputs that OpenCV wrote into Julia memory instead
+# of allocating them.
+const julia_owned_arrays = Dict{UInt, WeakRef}()
+const julia_owned_lock = ReentrantLock()
+
+function julia_register_owner(ptr::UInt, arr)
+    lock(julia_owned_lock) do
+        if length(julia_owned_arrays) >= 256
+            filter!(p -> p.second.value !== nothing, julia_owned_arrays)
+        end
+        julia_owned_arrays[ptr] = WeakRef(arr)
+    end
+end
+
+# Object keeping the memory of an array alive, WeakRef needs a mutable one
+julia_storage(a::SubArray) = julia_storage(parent(a))
+julia_storage(a::Mat) = a.mat isa Tuple ? a.mat[2] : (a.mat === nothing ? julia_storage(a.data_raw) : a.mat)
+julia_storage(a) = a
+
+function julia_owner(ptr::UInt)
+    lock(julia_owned_lock) do
+        ref = get(julia_owned_arrays, ptr, nothing)
+        return ref === nothing ? nothing : ref.value
+    end
+end
+
 function julia_to_cpp(img::InputArray)
     if typeof(img) <: CxxMat
         return img
@@ -57,7 +104,9 @@ function julia_to_cpp(img::InputArray)
         steps = strides(img)
     end
 
-    if steps[1] <= steps[2] <= steps[3] && steps[1]==1
+    # Mat has no step for channels, so they have to be packed within a pixel
+    if steps[1] == 1 && steps[2] == size(img, 1) && steps[2] <= steps[3]
+        julia_register_owner(UInt(pointer(img)), julia_storage(img))
         steps_a = Array{size_t, 1}()
         ndims_a = Array{Int32, 1}()
         sz = sizeof(eltype(img))
@@ -23,6 +23,17 @@ ve_gray = OpenCV.cvtColor(ve, OpenCV.COLOR_RGB2GRAY)
 # Shape check
 @test size(ve_gray)[1] == 1 && size(img_gray)[1] == 1
 
+# Preallocated output is written in place
+out_gray = zeros(UInt8, 1, 500, 500)
+res_gray = OpenCV.cvtColor(img, OpenCV.COLOR_RGB2GRAY, dst = out_gray)
+@test pointer(res_gray) == pointer(out_gray)
+@test out_gray == img_gray
+
+# Channels not packed within a pixel are copied before wrapping
+ch = view(img, 1:1, :, :)
+ch_gray = OpenCV.cvtColor(OpenCV.cvtColor(ch, OpenCV.COLOR_GRAY2RGB), OpenCV.COLOR_RGB2GRAY)
+@test ch_gray == ch
+
 
 
 print("imgproc test passed\n")
@@ -901,11 +901,26 @@ void add( const std::vector<Mat>& descriptors );
 
 /** @brief Update dataset by inserting into it all descriptors that were stored locally by *add* function.
 
-@note Every time this function is invoked, current dataset is deleted and locally stored descriptors
-are inserted into dataset. The locally stored copy of just inserted descriptors is then removed.
+@note The dataset is kept between calls: only the descriptors stored locally since the last call are
+inserted into it, so it can be grown incrementally without being rebuilt. The locally stored copy of
+just inserted descriptors is then removed. Use *clear* to delete the dataset.
  */
 void train();
 
+/** @brief Read a dataset stored by *write* and replace the current one with it
+
+@param fn source FileNode file
+ */
+virtual void read( const cv::FileNode& fn ) CV_OVERRIDE;
+
+/** @brief Store the dataset, together with descriptors added but not yet trained, to a FileStorage object
+
+@param fs output FileStorage file
+
+@note Only the descriptors and their grouping by image are stored, hash tables are rebuilt by *read*.
+ */
+virtual void write( cv::FileStorage& fs ) const CV_OVERRIDE;
+
 /** @brief Create a BinaryDescriptorMatcher object and return a smart pointer to it.
  */
 static Ptr<BinaryDescriptorMatcher> createBinaryDescriptorMatcher();
@@ -940,7 +955,7 @@ BucketGroup(bool needAllocateGroup = true);
 void insert( int subindex, UINT32 data );
 
 /** perform a query to the bucket */
-UINT32* query( int subindex, int *size );
+const UINT32* query( int subindex, int *size ) const;
 
 /** utility functions */
 void insert_value( std::vector<uint32_t>& vec, int index, UINT32 data );
@@ -979,7 +994,7 @@ int init( int _b );
 void insert( UINT64 index, UINT32 data );
 
 /** query data */
-UINT32* query( UINT64 index, int* size );
+const UINT32* query( UINT64 index, int* size ) const;
 
 /** Bits per index */
 int b;
@@ -1039,7 +1054,7 @@ inline void set( UINT64 index )
 arr[index >> 5] |= ( (UINT32) 0x01 ) << ( index % 32 );
 }
 
-inline UINT8 get( UINT64 index )
+inline UINT8 get( UINT64 index ) const
 {
 return ( arr[index >> 5] & ( ( (UINT32) 0x01 ) << ( index % 32 ) ) ) != 0;
 }
@@ -1086,18 +1101,12 @@ UINT64 N;
 /** Table of original full-length codes */
 cv::Mat codes;
 
-/** Counter for eliminating duplicate results (it is not thread safe) */
-Ptr<bitarray> counter;
-
 /** Array of m hashtables */
 std::vector<SparseHashtable> H;
 
 /** Volume of a b-bit Hamming ball with radius s (for s = 0 to d) */
 std::vector<UINT32> xornum;
 
-/** Used within generation of binary codes at a certain Hamming distance */
-int power[100];
-
 /** constructor */
 Mihasher();
 
@@ -1110,18 +1119,21 @@ Mihasher( int B, int m );
 /** K setter */
 void setK( int K );
 
-/** populate tables */
-void populate( cv::Mat & codes, UINT32 N, int dim1codes );
-
-/** execute a batch query */
-void batchquery( UINT32 * results, UINT32 *numres/*, qstat *stats*/, const cv::Mat & q, UINT32 numq, int dim1queries );
+/** append codes to the table and insert them into the hashtables */
+void populate( const cv::Mat & codes, UINT32 N, int dim1codes );
 
-private:
+/** execute a batch query (queries are processed in parallel) */
+void batchquery( UINT32 * results, UINT32 *numres/*, qstat *stats*/, const cv::Mat & q, UINT32 numq, int dim1queries ) const;
 
-/** execute a single query */
-void query( UINT32 * results, UINT32* numres/*, qstat *stats*/, UINT8 *q, UINT64 * chunks, UINT32 * res );
+/** execute a single query, counter must be clear on entry and is left clear on exit */
+void query( UINT32 * results, UINT32* numres/*, qstat *stats*/, const UINT8 *q, UINT64 * chunks, UINT32 * res, bitarray& counter,
+            std::vector<UINT32>& visited ) const;
 };
 
+/** return the Mihasher indexing trainDescriptors, it is rebuilt only if they changed since last call */
+Ptr<Mihasher> getTrainIndex( const Mat& trainDescriptors ) const;
+
+
 /** retrieve Hamming distances */
 void checkKDistances( UINT32 * numres, int k, std::vector<int>& k_distances, int row, int string_length ) const;
 
@@ -1143,6 +1155,12 @@ int numImages;
 /** number of descriptors in dataset */
 int descrInDS;
 
+/** Mihasher built on the last train descriptors given to pairwise functions */
+mutable Ptr<Mihasher> trainIndex;
+
+/** guards trainIndex */
+mutable Mutex trainIndexMutex;
+
 };
 
 /* --------------------------------------------------------------------------------------------
@@ -40,6 +40,7 @@
  //M*/
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #ifdef _MSC_VER
     #pragma warning(disable:4702)  // unreachable code
@@ -346,23 +347,22 @@ static inline int get2Pow( int i )
 /* compute Gaussian pyramids */
 void BinaryDescriptor::computeGaussianPyramid( const Mat& image, const int numOctaves )
 {
-  /* clear class fields */
-  images_sizes.clear();
-  octaveImages.clear();
+  /* octave images are kept between calls, so that their memory is reused
+   when images of the same size are processed */
+  images_sizes.resize( numOctaves );
+  octaveImages.resize( numOctaves );
 
   /* insert input image into pyramid */
-  cv::Mat currentMat = image.clone();
-  cv::GaussianBlur( currentMat, currentMat, cv::Size( 5, 5 ), 1 );
-  octaveImages.push_back( currentMat );
-  images_sizes.push_back( currentMat.size() );
+  cv::GaussianBlur( image, octaveImages[0], cv::Size( 5, 5 ), 1 );
+  images_sizes[0] = octaveImages[0].size();
 
   /* fill Gaussian pyramid */
   for ( int pyrCounter = 1; pyrCounter < numOctaves; pyrCounter++ )
   {
     /* compute and store next image in pyramid and its size */
-    pyrDown( currentMat, currentMat, Size( currentMat.cols / params.reductionRatio, currentMat.rows / params.reductionRatio ) );
-    octaveImages.push_back( currentMat );
-    images_sizes.push_back( currentMat.size() );
+    const Mat& previous = octaveImages[pyrCounter - 1];
+    pyrDown( previous, octaveImages[pyrCounter], Size( previous.cols / params.reductionRatio, previous.rows / params.reductionRatio ) );
+    images_sizes[pyrCounter] = octaveImages[pyrCounter].size();
   }
 }
 
@@ -373,25 +373,19 @@ void BinaryDescriptor::computeSobel( const cv::Mat& image, const int numOctaves
   /* compute Gaussian pyramids */
   computeGaussianPyramid( image, numOctaves );
 
-  /* reinitialize class structures */
-  dxImg_vector.clear();
-  dyImg_vector.clear();
-
-//  dxImg_vector.resize( params.numOfOctave_ );
-//  dyImg_vector.resize( params.numOfOctave_ );
-
+  /* reinitialize class structures (derivative images of previous call are reused) */
   dxImg_vector.resize( octaveImages.size() );
   dyImg_vector.resize( octaveImages.size() );
 
-  /* compute derivatives */
-  for ( size_t sobelCnt = 0; sobelCnt < octaveImages.size(); sobelCnt++ )
+  /* compute derivatives, octaves are independent from each other */
+  parallel_for_( Range( 0, (int) octaveImages.size() ), [&]( const Range& range )
   {
-    dxImg_vector[sobelCnt].create( images_sizes[sobelCnt].height, images_sizes[sobelCnt].width, CV_16SC1 );
-    dyImg_vector[sobelCnt].create( images_sizes[sobelCnt].height, images_sizes[sobelCnt].width, CV_16SC1 );
-
-    cv::Sobel( octaveImages[sobelCnt], dxImg_vector[sobelCnt], CV_16SC1, 1, 0, 3 );
-    cv::Sobel( octaveImages[sobelCnt], dyImg_vector[sobelCnt], CV_16SC1, 0, 1, 3 );
-  }
+    for ( int sobelCnt = range.start; sobelCnt < range.end; sobelCnt++ )
+    {
+      cv::Sobel( octaveImages[sobelCnt], dxImg_vector[sobelCnt], CV_16SC1, 1, 0, 3 );
+      cv::Sobel( octaveImages[sobelCnt], dyImg_vector[sobelCnt], CV_16SC1, 0, 1, 3 );
+    }
+  } );
 }
 
 /* utility function for conversion of an LBD descriptor to its binary representation */
@@ -1436,6 +1430,54 @@ BinaryDescriptor::EDLineDetector::~EDLineDetector()
   }
 }
 
+/* compute, in a single pass, the thresholded gradient g = (|dx| + |dy|) / 4, the gradient without
+ threshold and the direction image (Horizontal if |dx| < |dy|). Results are the same as the ones of
+ cv::abs, cv::add, cv::threshold (THRESH_TOZERO), division by 4 and cv::compare (CMP_LT) */
+static void computeEdgeGradient( const Mat& dxImg, const Mat& dyImg, int threshold, Mat& gImg, Mat& gImgWO, Mat& dirImg )
+{
+  parallel_for_( Range( 0, dxImg.rows ), [&]( const Range& range )
+  {
+    for ( int y = range.start; y < range.end; y++ )
+    {
+      const short* pdx = dxImg.ptr<short>( y );
+      const short* pdy = dyImg.ptr<short>( y );
+      short* pg = gImg.ptr<short>( y );
+      short* pgWO = gImgWO.ptr<short>( y );
+      uchar* pdir = dirImg.ptr( y );
+      int x = 0;
+#if CV_SIMD128
+      const v_uint16x8 vmax = v_setall_u16( SHRT_MAX ), vthr = v_setall_u16( (ushort) std::max( threshold, 0 ) );
+      const v_uint16x8 vone = v_setall_u16( 1 );
+      for ( ; x <= dxImg.cols - 16; x += 16 )
+      {
+        v_uint16x8 adx0 = v_min( v_abs( v_load( pdx + x ) ), vmax ), adx1 = v_min( v_abs( v_load( pdx + x + 8 ) ), vmax );
+        v_uint16x8 ady0 = v_min( v_abs( v_load( pdy + x ) ), vmax ), ady1 = v_min( v_abs( v_load( pdy + x + 8 ) ), vmax );
+        v_uint16x8 sum0 = v_min( adx0 + ady0, vmax ), sum1 = v_min( adx1 + ady1, vmax );
+
+        /* rounding division by 4, halfway cases to even as cvRound */
+        v_uint16x8 wo0 = ( sum0 + vone + ( ( sum0 >> 2 ) & vone ) ) >> 2;
+        v_uint16x8 wo1 = ( sum1 + vone + ( ( sum1 >> 2 ) & vone ) ) >> 2;
+        v_store( pgWO + x, v_reinterpret_as_s16( wo0 ) );
+        v_store( pgWO + x + 8, v_reinterpret_as_s16( wo1 ) );
+        v_store( pg + x, v_reinterpret_as_s16( wo0 & ( sum0 > vthr ) ) );
+        v_store( pg + x + 8, v_reinterpret_as_s16( wo1 & ( sum1 > vthr ) ) );
+        v_store( pdir + x, v_pack( adx0 < ady0, adx1 < ady1 ) );
+      }
+#endif
+      for ( ; x < dxImg.cols; x++ )
+      {
+        int adx = std::min( std::abs( (int) pdx[x] ), (int) SHRT_MAX );
+        int ady = std::min( std::abs( (int) pdy[x] ), (int) SHRT_MAX );
+        int sum = std::min( adx + ady, (int) SHRT_MAX );
+        short wo = (short) cvRound( sum * 0.25 );
+        pgWO[x] = wo;
+        pg[x] = sum > threshold ? wo : (short) 0;
+        pdir[x] = adx < ady ? Horizontal : Vertical;
+      }
+    }
+  } );
+}
+
 int BinaryDescriptor::EDLineDetector::EdgeDrawing( cv::Mat &image, EdgeChains &edgeChains )
 {
   imageWidth = image.cols;
@@ -1478,57 +1520,59 @@ int BinaryDescriptor::EDLineDetector::EdgeDrawing( cv::Mat &image, EdgeChains &e
   cv::Sobel( image, dyImg_, CV_16SC1, 0, 1, 3 );
 
   //compute gradient and direction images
-  cv::Mat dxABS_m = cv::abs( dxImg_ );
-  cv::Mat dyABS_m = cv::abs( dyImg_ );
-  cv::Mat sumDxDy;
-  cv::add( dyABS_m, dxABS_m, sumDxDy );
-
-  cv::threshold( sumDxDy, gImg_, gradienThreshold_ + 1, 255, cv::THRESH_TOZERO );
-  gImg_ = gImg_ / 4;
-  gImgWO_ = sumDxDy / 4;
-  cv::compare( dxABS_m, dyABS_m, dirImg_, cv::CMP_LT );
+  computeEdgeGradient( dxImg_, dyImg_, gradienThreshold_ + 1, gImg_, gImgWO_, dirImg_ );
 
   short *pgImg = gImg_.ptr<short>();
   unsigned char *pdirImg = dirImg_.ptr();
 
-  //extract the anchors in the gradient image, store into a vector
-  memset( pAnchorX_, 0, edgePixelArraySize * sizeof(unsigned int) );  //initialization
-  memset( pAnchorY_, 0, edgePixelArraySize * sizeof(unsigned int) );
-  unsigned int anchorsSize = 0;
-  int indexInArray;
-  unsigned char gValue1, gValue2, gValue3;
-  for ( unsigned int w = 1; w < imageWidth - 1; w = w + scanIntervals_ )
+  //extract the anchors in the gradient image, store into a vector.
+  //Stripes of columns are scanned in parallel and concatenated in order,
+  //so that anchors are listed as by a sequential column-wise scan
+  int numOfScanCols = imageWidth > 2 ? (int) ( ( imageWidth - 2 + scanIntervals_ - 1 ) / scanIntervals_ ) : 0;
+  int numOfStripes = std::max( 1, std::min( numOfScanCols, getNumThreads() * 4 ) );
+  std::vector<std::vector<uint64> > stripeAnchors( numOfStripes );
+  parallel_for_( Range( 0, numOfStripes ), [&]( const Range& range )
   {
-    for ( unsigned int h = 1; h < imageHeight - 1; h = h + scanIntervals_ )
+    for ( int stripe = range.start; stripe < range.end; stripe++ )
     {
-      indexInArray = h * imageWidth + w;
-      //gValue1 = pdirImg[indexInArray];
-      if( pdirImg[indexInArray] == Horizontal )
-      {  //if the direction of pixel is horizontal, then compare with up and down
-         //gValue2 = pgImg[indexInArray];
-        if( pgImg[indexInArray] >= pgImg[indexInArray - imageWidth] + anchorThreshold_
-            && pgImg[indexInArray] >= pgImg[indexInArray + imageWidth] + anchorThreshold_ )
-        {       // (w,h) is accepted as an anchor
-          pAnchorX_[anchorsSize] = w;
-          pAnchorY_[anchorsSize++] = h;
-        }
-      }
-      else
-      {       // if(pdirImg[indexInArray]==Vertical){//it is vertical edge, should be compared with left and right
-        //gValue2 = pgImg[indexInArray];
-        if( pgImg[indexInArray] >= pgImg[indexInArray - 1] + anchorThreshold_ && pgImg[indexInArray] >= pgImg[indexInArray + 1] + anchorThreshold_ )
-        {       // (w,h) is accepted as an anchor
-          pAnchorX_[anchorsSize] = w;
-          pAnchorY_[anchorsSize++] = h;
+      std::vector<uint64>& anchors = stripeAnchors[stripe];
+      int colBegin = (int) ( (int64) numOfScanCols * stripe / numOfStripes );
+      int colEnd = (int) ( (int64) numOfScanCols * ( stripe + 1 ) / numOfStripes );
+      for ( unsigned int w = 1 + colBegin * scanIntervals_; w < 1 + colEnd * scanIntervals_; w = w + scanIntervals_ )
+      {
+        for ( unsigned int h = 1; h < imageHeight - 1; h = h + scanIntervals_ )
+        {
+          int index = h * imageWidth + w;
+          int offset = pdirImg[index] == Horizontal ? (int) imageWidth : 1;  //compare with up and down or with left and right
+          if( pgImg[index] >= pgImg[index - offset] + anchorThreshold_ && pgImg[index] >= pgImg[index + offset] + anchorThreshold_ )
+          {       // (w,h) is accepted as an anchor
+            anchors.push_back( ( (uint64) w << 32 ) | h );
+          }
         }
       }
     }
-  }
+  } );
+
+  unsigned int anchorsSize = 0;
+  for ( int stripe = 0; stripe < numOfStripes; stripe++ )
+    anchorsSize += (unsigned int) stripeAnchors[stripe].size();
   if( anchorsSize > edgePixelArraySize )
   {
     std::cout << "anchor size is larger than its maximal size. anchorsSize=" << anchorsSize << ", maximal size = " << edgePixelArraySize << std::endl;
     return -1;
   }
+  anchorsSize = 0;
+  for ( int stripe = 0; stripe < numOfStripes; stripe++ )
+  {
+    for ( size_t i = 0; i < stripeAnchors[stripe].size(); i++ )
+    {
+      pAnchorX_[anchorsSize] = (unsigned int) ( stripeAnchors[stripe][i] >> 32 );
+      pAnchorY_[anchorsSize++] = (unsigned int) ( stripeAnchors[stripe][i] & 0xFFFFFFFF );
+    }
+  }
+
+  int indexInArray;
+  unsigned char gValue1, gValue2, gValue3;
 
   //link the anchors by smart routing
   edgeImage_.setTo( 0 );
@@ -85,19 +85,95 @@ void BinaryDescriptorMatcher::train()
   if( !dataset )
     dataset = Ptr<Mihasher>(new Mihasher( 256, 32 ));
 
+  /* only descriptors added since last call are inserted, the ones already
+   in dataset are kept in its hashtables */
   if( descriptorsMat.rows > 0 )
     dataset->populate( descriptorsMat, descriptorsMat.rows, descriptorsMat.cols );
 
-  descrInDS = descriptorsMat.rows;
+  descrInDS = (int) dataset->N;
   descriptorsMat.release();
 }
 
+/* read dataset from a FileNode object */
+void BinaryDescriptorMatcher::read( const cv::FileNode& fn )
+{
+  clear();
+
+  Mat codes, pending;
+  std::vector<int> firstIndexes, images;
+  fn["codes"] >> codes;
+  fn["pending"] >> pending;
+  fn["firstIndexes"] >> firstIndexes;
+  fn["images"] >> images;
+
+  CV_Assert( firstIndexes.size() == images.size() );
+  CV_Assert( codes.empty() || ( codes.type() == CV_8UC1 && codes.cols == 32 ) );
+  CV_Assert( pending.empty() || ( pending.type() == CV_8UC1 && pending.cols == 32 ) );
+
+  for ( size_t i = 0; i < firstIndexes.size(); i++ )
+    indexesMap.insert( std::pair<int, int>( firstIndexes[i], images[i] ) );
+
+  nextAddedIndex = (int) fn["nextAddedIndex"];
+  numImages = (int) fn["numImages"];
+
+  /* hashtables are not stored, rebuild them from the codes */
+  dataset = Ptr<Mihasher>(new Mihasher( 256, 32 ));
+  if( codes.rows > 0 )
+    dataset->populate( codes, codes.rows, codes.cols );
+  descrInDS = (int) dataset->N;
+
+  descriptorsMat = pending;
+}
+
+/* store dataset to a FileStorage object */
+void BinaryDescriptorMatcher::write( cv::FileStorage& fs ) const
+{
+  std::vector<int> firstIndexes, images;
+  for ( std::map<int, int>::const_iterator it = indexesMap.begin(); it != indexesMap.end(); ++it )
+  {
+    firstIndexes.push_back( it->first );
+    images.push_back( it->second );
+  }
+
+  writeFormat( fs );
+  fs << "codes" << ( dataset ? dataset->codes : Mat() );
+  fs << "pending" << descriptorsMat;
+  fs << "firstIndexes" << firstIndexes;
+  fs << "images" << images;
+  fs << "nextAddedIndex" << nextAddedIndex;
+  fs << "numImages" << numImages;
+}
+
+/* return the Mihasher indexing trainDescriptors, it is rebuilt only if they changed since last call
+ (trainIndexMutex must be held by the caller) */
+Ptr<BinaryDescriptorMatcher::Mihasher> BinaryDescriptorMatcher::getTrainIndex( const Mat& trainDescriptors ) const
+{
+  bool reuse = trainIndex && trainIndex->codes.rows == trainDescriptors.rows && trainIndex->codes.cols == trainDescriptors.cols
+      && trainIndex->codes.type() == trainDescriptors.type();
+
+  /* comparing the codes is much cheaper than inserting them into the hashtables again */
+  for ( int i = 0; reuse && i < trainDescriptors.rows; i++ )
+    reuse = memcmp( trainIndex->codes.ptr( i ), trainDescriptors.ptr( i ), trainDescriptors.cols * trainDescriptors.elemSize() ) == 0;
+
+  if( !reuse )
+  {
+    trainIndex = Ptr<Mihasher>(new Mihasher( 256, 32 ));
+    trainIndex->populate( trainDescriptors, trainDescriptors.rows, trainDescriptors.cols );
+  }
+
+  return trainIndex;
+}
+
 /* clear dataset and internal data */
 void BinaryDescriptorMatcher::clear()
 {
   descriptorsMat.release();
   indexesMap.clear();
   dataset.release();
+  {
+    AutoLock lock( trainIndexMutex );
+    trainIndex.release();
+  }
   nextAddedIndex = 0;
   numImages = 0;
   descrInDS = 0;
@@ -211,12 +287,9 @@ void BinaryDescriptorMatcher::match( const Mat& queryDescriptors, const Mat& tra
     return;
   }
 
-  /* create a new mihasher object */
-  Mihasher *mh = new Mihasher( 256, 32 );
-
-  /* populate mihasher */
-  cv::Mat copy = trainDescriptors.clone();
-  mh->populate( copy, copy.rows, copy.cols );
+  /* get a mihasher object indexing train descriptors */
+  AutoLock lock( trainIndexMutex );
+  Ptr<Mihasher> mh = getTrainIndex( trainDescriptors );
   mh->setK( 1 );
 
   /* prepare structures for query */
@@ -247,7 +320,6 @@ void BinaryDescriptorMatcher::match( const Mat& queryDescriptors, const Mat& tra
   }
 
   /* delete data */
-  delete mh;
   delete[] results;
   delete[] numres;
 
@@ -273,12 +345,9 @@ void BinaryDescriptorMatcher::knnMatch( const Mat& queryDescriptors, const Mat&
     return;
   }
 
-  /* create a new mihasher object */
-  Mihasher *mh = new Mihasher( 256, 32 );
-
-  /* populate mihasher */
-  cv::Mat copy = trainDescriptors.clone();
-  mh->populate( copy, copy.rows, copy.cols );
+  /* get a mihasher object indexing train descriptors */
+  AutoLock lock( trainIndexMutex );
+  Ptr<Mihasher> mh = getTrainIndex( trainDescriptors );
 
   /* set K */
   mh->setK( k );
@@ -329,7 +398,6 @@ void BinaryDescriptorMatcher::knnMatch( const Mat& queryDescriptors, const Mat&
   }
 
   /* delete data */
-  delete mh;
   delete[] results;
   delete[] numres;
 }
@@ -444,13 +512,9 @@ void BinaryDescriptorMatcher::radiusMatch( const Mat& queryDescriptors, const Ma
     return;
   }
 
-  /* create a new Mihasher */
-  Mihasher* mh = new Mihasher( 256, 32 );
-
-  /* populate Mihasher */
-  //Mat copy = queryDescriptors.clone();
-  Mat copy = trainDescriptors.clone();
-  mh->populate( copy, copy.rows, copy.cols );
+  /* get a Mihasher indexing train descriptors */
+  AutoLock lock( trainIndexMutex );
+  Ptr<Mihasher> mh = getTrainIndex( trainDescriptors );
 
   /* set K */
   mh->setK( trainDescriptors.rows );
@@ -498,7 +562,6 @@ void BinaryDescriptorMatcher::radiusMatch( const Mat& queryDescriptors, const Ma
   }
 
   /* delete data */
-  delete mh;
   delete[] results;
   delete[] numres;
 }
@@ -593,44 +656,25 @@ void BinaryDescriptorMatcher::radiusMatch( const Mat& queryDescriptors, std::vec
 }
 
 /* execute a batch query */
-void BinaryDescriptorMatcher::Mihasher::batchquery( UINT32 * results, UINT32 *numres, const cv::Mat & queries, UINT32 numq, int dim1queries )
+void BinaryDescriptorMatcher::Mihasher::batchquery( UINT32 * results, UINT32 *numres, const cv::Mat & queries, UINT32 numq, int /*dim1queries*/ ) const
 {
-  /* create and initialize a bitarray */
-  counter = makePtr<bitarray>();
-  counter->init( N );
-
-  UINT32 *res = new UINT32[K * ( D + 1 )];
-  UINT64 *chunks = new UINT64[m];
-  UINT32 * presults = results;
-  UINT32 *pnumres = numres;
-
-  /* make a copy of input queries */
-  cv::Mat queries_clone = queries.clone();
-
-  /* set a pointer to first query (row) */
-  UINT8 *pq = queries_clone.ptr();
-
-  /* loop over number of descriptors */
-  for ( size_t i = 0; i < numq; i++ )
-  {
-    /* for every descriptor, query database */
-    query( presults, pnumres, pq, chunks, res );
-
-    /* move pointer to write next K indeces */
-    presults += K;
-    pnumres += B + 1;
-
-    /* move forward pointer to current row in descriptors matrix */
-    pq += dim1queries;
-
-  }
-
-  delete[] res;
-  delete[] chunks;
+  /* every stripe of queries gets its own buffers and duplicates counter,
+   so that no state is shared among threads */
+  parallel_for_( Range( 0, (int) numq ), [&]( const Range& range )
+  {
+    bitarray counter( N );
+    std::vector<UINT32> visited;
+    std::vector<UINT32> res( (size_t) K * ( D + 1 ) );
+    std::vector<UINT64> chunks( m );
+
+    for ( int i = range.start; i < range.end; i++ )
+      query( results + (size_t) i * K, numres + (size_t) i * ( B + 1 ), queries.ptr( i ), &chunks[0], res.empty() ? NULL : &res[0], counter, visited );
+  }, std::max( 1, getNumThreads() ) * 4 );
 }
 
 /* execute a single query */
-void BinaryDescriptorMatcher::Mihasher::query( UINT32* results, UINT32* numres, UINT8 * Query, UINT64 *chunks, UINT32 *res )
+void BinaryDescriptorMatcher::Mihasher::query( UINT32* results, UINT32* numres, const UINT8 * Query, UINT64 *chunks, UINT32 *res, bitarray& counter,
+                                                std::vector<UINT32>& visited ) const
 {
   /* if K == 0 that means we want everything to be processed.
    So maxres = N in that case. Otherwise K limits the results processed */
@@ -647,15 +691,18 @@ void BinaryDescriptorMatcher::Mihasher::query( UINT32* results, UINT32* numres,
   UINT32 nl = 0;
 
   UINT32 nd = 0;
-  UINT32 *arr;
+  const UINT32 *arr;
   int size = 0;
   UINT32 index;
   int hammd;
 
-  counter->erase();
+  /* used within generation of binary codes at a certain Hamming distance */
+  int power[100];
+
+  visited.clear();
   memset( numres, 0, ( B + 1 ) * sizeof ( *numres ) );
 
-  split( chunks, Query, m, mplus, b );
+  split( chunks, (UINT8*) Query, m, mplus, b );
 
   /* the growing search radius per substring */
   int s;
@@ -710,10 +757,11 @@ void BinaryDescriptorMatcher::Mihasher::query( UINT32* results, UINT32* numres,
             for ( int c = 0; c < size; c++ )
             {
               index = arr[c];
-              if( !counter->get( index ) )
+              if( !counter.get( index ) )
               { /* if it is not a duplicate */
-                counter->set( index );
-                hammd = cv::line_descriptor::match( codes.ptr() + (UINT64) index * ( B_over_8 ), Query, B_over_8 );
+                counter.set( index );
+                visited.push_back( index );
+                hammd = cv::line_descriptor::match( (UINT8*) codes.ptr( (int) index ), (UINT8*) Query, B_over_8 );
 
                 nc++;
                 if( hammd <= D && numres[hammd] < maxres )
@@ -748,6 +796,10 @@ void BinaryDescriptorMatcher::Mihasher::query( UINT32* results, UINT32* numres,
       results[n++] = res[s * K + c];
   }
 
+  /* only reset the bits which were set, instead of erasing the whole counter */
+  for ( size_t i = 0; i < visited.size(); i++ )
+    counter.flip( visited[i] );
+
 }
 
 /* constructor 2 */
@@ -755,6 +807,8 @@ BinaryDescriptorMatcher::Mihasher::Mihasher( int B_val, int _m )
 {
   B = B_val;
   B_over_8 = B / 8;
+  K = 0;
+  N = 0;
   m = _m;
   b = (int) ceil( (double) B / m );
 
@@ -792,22 +846,22 @@ BinaryDescriptorMatcher::Mihasher::~Mihasher()
 }
 
 /* populate tables */
-void BinaryDescriptorMatcher::Mihasher::populate( cv::Mat & _codes, UINT32 N_val, int dim1codes )
+void BinaryDescriptorMatcher::Mihasher::populate( const cv::Mat & _codes, UINT32 N_val, int dim1codes )
 {
-  N = N_val;
-  codes = _codes;
+  CV_Assert( dim1codes == B_over_8 && _codes.rows >= (int) N_val );
+
+  /* new codes are appended to the ones already indexed */
+  UINT64 first = N;
+  codes.push_back( _codes.rowRange( 0, (int) N_val ) );
+  N += N_val;
   UINT64 * chunks = new UINT64[m];
 
-  UINT8 * pcodes = codes.ptr();
-  for ( UINT64 i = 0; i < N; i++, pcodes += dim1codes )
+  for ( UINT64 i = first; i < N; i++ )
   {
-    split( chunks, pcodes, m, mplus, b );
+    split( chunks, codes.ptr( (int) i ), m, mplus, b );
 
     for ( int k = 0; k < m; k++ )
       H[k].insert( chunks[k], (UINT32) i );
-
-    if( i % (int) ceil( N / 1000.0 ) == 0 )
-      fflush (stdout);
   }
 
   delete[] chunks;
@@ -847,7 +901,7 @@ void BinaryDescriptorMatcher::SparseHashtable::insert( UINT64 index, UINT32 data
 }
 
 /* query data */
-UINT32* BinaryDescriptorMatcher::SparseHashtable::query( UINT64 index, int *Size )
+const UINT32* BinaryDescriptorMatcher::SparseHashtable::query( UINT64 index, int *Size ) const
 {
   return table[(size_t)(index >> 5)].query( (int) ( index & 31 ), Size );
 }
@@ -943,7 +997,7 @@ void BinaryDescriptorMatcher::BucketGroup::insert( int subindex, UINT32 data )
 }
 
 /* perform a query to the bucket */
-UINT32* BinaryDescriptorMatcher::BucketGroup::query( int subindex, int *size )
+const UINT32* BinaryDescriptorMatcher::BucketGroup::query( int subindex, int *size ) const
 {
   if( empty & ( (UINT32) 1 << subindex ) )
   {
@@ -577,4 +577,62 @@ TEST( BinaryDescriptor_Matcher, regression)
   test.safe_run();
 }
 
+TEST( BinaryDescriptor_Matcher, incremental_train_and_persistence )
+{
+  Mat train( 400, 32, CV_8UC1 );
+  RNG& rng = theRNG();
+  rng.fill( train, RNG::UNIFORM, 0, 256 );
+  Mat query = train.rowRange( 100, 300 ).clone();
+
+  /* dataset grown by two train() calls must behave as one built at once */
+  Ptr<BinaryDescriptorMatcher> incremental = BinaryDescriptorMatcher::createBinaryDescriptorMatcher();
+  incremental->add( std::vector<Mat>( 1, train.rowRange( 0, 200 ) ) );
+  incremental->train();
+  incremental->add( std::vector<Mat>( 1, train.rowRange( 200, 400 ) ) );
+  incremental->train();
+
+  std::vector<DMatch> matches;
+  incremental->match( query, matches );
+  ASSERT_EQ( (size_t) query.rows, matches.size() );
+  for ( size_t i = 0; i < matches.size(); i++ )
+  {
+    EXPECT_EQ( (int) i + 100, matches[i].trainIdx );
+    EXPECT_EQ( matches[i].trainIdx < 200 ? 0 : 1, matches[i].imgIdx );
+    EXPECT_EQ( 0.f, matches[i].distance );
+  }
+
+  /* dataset read back from a file must give the same matches,
+   including the descriptors that were added but not trained */
+  incremental->add( std::vector<Mat>( 1, query ) );
+  FileStorage fs( "matcher.yml", FileStorage::WRITE + FileStorage::MEMORY );
+  incremental->write( fs );
+  std::string data = fs.releaseAndGetString();
+
+  Ptr<BinaryDescriptorMatcher> restored = BinaryDescriptorMatcher::createBinaryDescriptorMatcher();
+  FileStorage fs2( data, FileStorage::READ + FileStorage::MEMORY );
+  restored->read( fs2.root() );
+
+  std::vector<std::vector<DMatch> > expected, actual;
+  incremental->knnMatch( query, expected, 2 );
+  restored->knnMatch( query, actual, 2 );
+  ASSERT_EQ( expected.size(), actual.size() );
+  for ( size_t i = 0; i < expected.size(); i++ )
+  {
+    ASSERT_EQ( expected[i].size(), actual[i].size() );
+    for ( size_t j = 0; j < expected[i].size(); j++ )
+    {
+      EXPECT_EQ( expected[i][j].imgIdx, actual[i][j].imgIdx );
+      EXPECT_EQ( expected[i][j].distance, actual[i][j].distance );
+    }
+  }
+
+  /* pairwise match with the same train descriptors reuses the index and must not change results */
+  std::vector<DMatch> first, second;
+  incremental->match( query, train, first );
+  incremental->match( query, train, second );
+  ASSERT_EQ( first.size(), second.size() );
+  for ( size_t i = 0; i < first.size(); i++ )
+    EXPECT_EQ( first[i].trainIdx, second[i].trainIdx );
+}
+
 }} // namespace
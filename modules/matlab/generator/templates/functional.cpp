@@ -106,11 +106,11 @@ addVariant("{{ fun.name }}", {{ fun.req|inputs|length }}, {{ fun.opt|inputs|leng
   {% if fun|ninputs or (fun|noutputs and not fun.constructor) %}
   // - inputs
   {% for arg in fun.req|inputs %}
-  {{arg.tp}} {{arg.name}} = inputs[{{ loop.index0 }}].to{{arg.tp|toUpperCamelCase}}();
+  {{arg.tp}} {{arg.name}} = inputs[{{ loop.index0 }}].to{{arg.tp|toUpperCamelCase}}{% if arg.tp == 'Mat' and not arg.O %}View{% endif %}();
   {% endfor %}
   // - inputs (opt)
   {% for opt in fun.opt|inputs %}
-  {{opt.tp}} {{opt.name}} = inputs[{{loop.index0 + fun.req|inputs|length}}].empty() ? ({{opt.tp}}) {% if opt.ref == '*' -%} {{opt.tp}}() {%- else -%} {{opt.default}} {%- endif %} : inputs[{{loop.index0 + fun.req|inputs|length}}].to{{opt.tp|toUpperCamelCase}}();
+  {{opt.tp}} {{opt.name}} = inputs[{{loop.index0 + fun.req|inputs|length}}].empty() ? ({{opt.tp}}) {% if opt.ref == '*' -%} {{opt.tp}}() {%- else -%} {{opt.default}} {%- endif %} : inputs[{{loop.index0 + fun.req|inputs|length}}].to{{opt.tp|toUpperCamelCase}}{% if opt.tp == 'Mat' and not opt.O %}View{% endif %}();
   {% endfor %}
   // - outputs
   {% for arg in fun.req|only|outputs %}
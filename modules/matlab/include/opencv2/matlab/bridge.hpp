@@ -47,6 +47,7 @@
 */
 
 #include "mxarray.hpp"
+#include "transpose.hpp"
 #include <vector>
 #include <string>
 #include <opencv2/core.hpp>
@@ -223,6 +224,15 @@ public:
   cv::Mat toMat() const;
   operator cv::Mat() const { return toMat(); }
 
+  /*! @brief read-only cv::Mat view of the Matlab array
+   *
+   * single channel vectors and scalars have the same layout in row and column
+   * major order, so they are wrapped without copying when their class maps
+   * to itself under toMat(). Anything else falls back to toMat(). The view
+   * aliases the Matlab data, so it must only be used for pure inputs.
+   */
+  cv::Mat toMatView() const;
+
   template <typename Scalar>
   static matlab::MxArray FromMat(const cv::Mat& mat) {
     matlab::MxArray arr(mat.rows, mat.cols, mat.channels(), matlab::Traits<Scalar>::ScalarType);
@@ -590,6 +600,26 @@ cv::Mat Bridge::toMat<matlab::InheritType>() const {
 Bridge& Bridge::operator=(const cv::Mat& mat) { ptr_ = FromMat<matlab::InheritType>(mat); return *this; }
 cv::Mat Bridge::toMat() const { return toMat<matlab::InheritType>(); }
 
+cv::Mat Bridge::toMatView() const {
+  if (ptr_.channels() == 1 && (ptr_.rows() == 1 || ptr_.cols() == 1)) {
+    int depth = -1;
+    switch (ptr_.ID()) {
+      case mxINT8_CLASS:    depth = CV_8S;  break;
+      case mxUINT8_CLASS:   depth = CV_8U;  break;
+      case mxINT16_CLASS:   depth = CV_16S; break;
+      case mxUINT16_CLASS:  depth = CV_16U; break;
+      case mxINT32_CLASS:   depth = CV_32S; break;
+      case mxSINGLE_CLASS:  depth = CV_32F; break;
+      default: break;
+    }
+    if (depth >= 0) {
+      void* data = const_cast<uint8_t*>(ptr_.real<uint8_t>());
+      return cv::Mat(static_cast<int>(ptr_.rows()), static_cast<int>(ptr_.cols()), depth, data);
+    }
+  }
+  return toMat();
+}
+
 
 // ----------------------------------------------------------------------------
 //                            MATRIX TRANSPOSE
@@ -598,58 +628,40 @@ cv::Mat Bridge::toMat() const { return toMat<matlab::InheritType>(); }
 
 template <typename InputScalar, typename OutputScalar>
 void deepCopyAndTranspose(const cv::Mat& in, matlab::MxArray& out) {
-  const int cols = out.cols();
-  const int rows = out.rows();
+  const size_t cols = out.cols();
+  const size_t rows = out.rows();
   matlab::conditionalError(static_cast<size_t>(in.rows) == out.rows(), "Matrices must have the same number of rows");
   matlab::conditionalError(static_cast<size_t>(in.cols) == out.cols(), "Matrices must have the same number of cols");
   matlab::conditionalError(static_cast<size_t>(in.channels()) == out.channels(), "Matrices must have the same number of channels");
-  std::vector<cv::Mat> channels;
-  cv::split(in, channels);
+  // write each plane straight into the Matlab memory, casting while transposing
+  OutputScalar* outp = out.real<OutputScalar>();
   for (size_t c = 0; c < out.channels(); ++c) {
-    cv::Mat_<InputScalar> m;
-    cv::transpose(channels[c], m);
-    OutputScalar* dst_plane = (OutputScalar*)out.real<InputScalar>() + cols*rows*c;
-    for (int x = 0; x < cols; x++)
-    {
-        OutputScalar* dst_col = dst_plane + x * rows;
-        for (int y = 0; y < rows; y++)
-        {
-            dst_col[y] = cv::saturate_cast<OutputScalar>(m(y, x));
-        }
-    }
+    cv::Mat plane = in;
+    if (in.channels() > 1) cv::extractChannel(in, plane, static_cast<int>(c));
+    const InputScalar* inp = plane.ptr<InputScalar>(0);
+    gemt('R', rows, cols, inp, plane.step1(), outp + cols*rows*c, rows);
   }
-  //const InputScalar* inp = in.ptr<InputScalar>(0);
-  //OutputScalar* outp = out.real<OutputScalar>();
-  //gemt('R', out.rows(), out.cols(), inp, in.step1(), outp, out.rows());
 }
 
 template <typename InputScalar, typename OutputScalar>
 void deepCopyAndTranspose(const matlab::MxArray& in, cv::Mat& out) {
-  const int cols = in.cols();
-  const int rows = in.rows();
+  const size_t cols = in.cols();
+  const size_t rows = in.rows();
   matlab::conditionalError(in.rows() == static_cast<size_t>(out.rows), "Matrices must have the same number of rows");
   matlab::conditionalError(in.cols() == static_cast<size_t>(out.cols), "Matrices must have the same number of cols");
   matlab::conditionalError(in.channels() == static_cast<size_t>(out.channels()), "Matrices must have the same number of channels");
-  std::vector<cv::Mat> channels;
+  const InputScalar* inp = in.real<InputScalar>();
+  // a single plane is cast and transposed straight into the destination
+  if (in.channels() == 1) {
+    gemt('C', rows, cols, inp, rows, out.ptr<OutputScalar>(0), out.step1());
+    return;
+  }
+  std::vector<cv::Mat> channels(in.channels());
   for (size_t c = 0; c < in.channels(); ++c) {
-    cv::Mat_<OutputScalar> m(cols, rows);
-    const InputScalar* src_plane = in.real<InputScalar>() + cols*rows*c;
-    for (int x = 0; x < cols; x++)
-    {
-        const InputScalar* src_col = src_plane + x * rows;
-        for (int y = 0; y < rows; y++)
-        {
-            m(y, x) = cv::saturate_cast<InputScalar>(src_col[y]);
-        }
-    }
-    cv::transpose(m, m);
-    channels.push_back(m);
+    channels[c].create(out.rows, out.cols, cv::DataType<OutputScalar>::type);
+    gemt('C', rows, cols, inp + cols*rows*c, rows, channels[c].ptr<OutputScalar>(0), channels[c].step1());
   }
   cv::merge(channels, out);
-
-  //const InputScalar* inp = in.real<InputScalar>();
-  //OutputScalar* outp = out.ptr<OutputScalar>(0);
-  //gemt('C', in.rows(), in.cols(), inp, in.rows(), outp, out.step1());
 }
 
 //! @}
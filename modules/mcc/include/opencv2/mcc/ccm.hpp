@@ -493,6 +493,11 @@ public:
     /** @brief make color correction */
     CV_WRAP void run();
 
+    /** @brief make color correction of many models concurrently, e.g. one per chart.
+    @param models the models to fit, as if run() was called on each of them.
+    */
+    static void run(std::vector<ColorCorrectionModel>& models);
+
     CV_WRAP Mat getCCM() const;
     CV_WRAP double getLoss() const;
     CV_WRAP Mat get_src_rgbl() const;
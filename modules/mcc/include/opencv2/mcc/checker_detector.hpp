@@ -196,6 +196,29 @@ public:
             const int nc = 1, bool useNet = false,
             const Ptr<DetectorParameters> &params = DetectorParameters::create()) = 0;
 
+    /** \brief Find the ColorCharts in many images at once.
+    *
+    * The images are searched concurrently and, if the network is used, it
+    * runs on all the images of the same size in a single batch. The results
+    * are the same as calling process() on every image, but they are returned
+    * instead of being stored in the detector.
+    * \param images images in color space BGR
+    * \param chartType type of the chart to detect
+    * \param checkers detected charts of each image, sorted as in
+    *                 getListColorChecker()
+    * \param nc number of charts in each image
+    * \param useNet if it is true the network provided using the setNet()
+    *               is used for preliminary search for regions where chart
+    *               could be present.
+    * \param params parameters of the detection system.
+    * \return true if atleast one chart is detected in any image
+    */
+    virtual bool
+    processBatch(InputArrayOfArrays images, const TYPECHART chartType,
+                 std::vector<std::vector<Ptr<CChecker>>> &checkers,
+                 const int nc = 1, bool useNet = false,
+                 const Ptr<DetectorParameters> &params = DetectorParameters::create()) = 0;
+
     /** \brief Get the best color checker. By the best it means the one
     *         detected with the highest confidence.
     * \return checker A single colorchecker, if atleast one colorchecker
@@ -35,7 +35,7 @@ public:
     Mat src;
     std::shared_ptr<Color> dst = std::make_shared<Color>();
     Mat dist;
-    RGBBase_& cs;
+    std::shared_ptr<RGBBase_> cs;
     Mat mask;
 
     // RGBl of detected data and the reference
@@ -137,7 +137,7 @@ public:
 };
 
 ColorCorrectionModel::Impl::Impl()
-    : cs(*GetCS::getInstance().get_rgb(COLOR_SPACE_sRGB))
+    : cs(GetCS::getInstance().get_rgb(COLOR_SPACE_sRGB))
     , ccm_type(CCM_3x3)
     , distance(DISTANCE_CIE2000)
     , linear_type(LINEARIZATION_GAMMA)
@@ -183,7 +183,7 @@ void ColorCorrectionModel::Impl::calWeightsMasks(const Mat& weights_list_, doubl
     }
     else if (weights_coeff_ != 0)
     {
-        pow(dst->toLuminant(cs.io), weights_coeff_, weights);
+        pow(dst->toLuminant(cs->io), weights_coeff_, weights);
     }
 
     // masks
@@ -263,7 +263,7 @@ double ColorCorrectionModel::Impl::calc_loss_(Color color)
 double ColorCorrectionModel::Impl::calc_loss(const Mat ccm_)
 {
     Mat converted = src_rgbl.reshape(1, 0) * ccm_;
-    Color color(converted.reshape(3, 0), *(cs.l));
+    Color color(converted.reshape(3, 0), *(cs->l));
     return calc_loss_(color);
 }
 
@@ -296,7 +296,7 @@ Mat ColorCorrectionModel::infer(const Mat& img, bool islinear)
     {
         return img_ccm;
     }
-    return p->cs.fromL(img_ccm);
+    return p->cs->fromL(img_ccm);
 }
 
 void ColorCorrectionModel::Impl::getColor(CONST_COLOR constcolor)
@@ -332,7 +332,7 @@ ColorCorrectionModel::ColorCorrectionModel(const Mat& src_, Mat colors_, COLOR_S
 
 void ColorCorrectionModel::setColorSpace(COLOR_SPACE cs_)
 {
-    p->cs = *GetCS::getInstance().get_rgb(cs_);
+    p->cs = GetCS::getInstance().get_rgb(cs_);
 }
 void ColorCorrectionModel::setCCM_TYPE(CCM_TYPE ccm_type_)
 {
@@ -382,11 +382,11 @@ void ColorCorrectionModel::run()
 {
 
     Mat saturate_mask = saturate(p->src, p->saturated_threshold[0], p->saturated_threshold[1]);
-    p->linear = getLinear(p->gamma, p->deg, p->src, *(p->dst), saturate_mask, (p->cs), p->linear_type);
+    p->linear = getLinear(p->gamma, p->deg, p->src, *(p->dst), saturate_mask, *(p->cs), p->linear_type);
     p->calWeightsMasks(p->weights_list, p->weights_coeff, saturate_mask);
     p->src_rgbl = p->linear->linearize(maskCopyTo(p->src, p->mask));
     p->dst->colors = maskCopyTo(p->dst->colors, p->mask);
-    p->dst_rgbl = p->dst->to(*(p->cs.l)).colors;
+    p->dst_rgbl = p->dst->to(*(p->cs->l)).colors;
 
     // make no change for CCM_3x3, make change for CCM_4x3.
     p->src_rgbl = p->prepare(p->src_rgbl);
@@ -414,6 +414,15 @@ void ColorCorrectionModel::run()
     }
     p->fitting();
 }
+void ColorCorrectionModel::run(std::vector<ColorCorrectionModel>& models)
+{
+    parallel_for_(Range(0, (int)models.size()), [&](const Range& range) {
+        for (int i = range.start; i < range.end; i++)
+        {
+            models[i].run();
+        }
+    });
+}
 Mat ColorCorrectionModel::getCCM() const
 {
     return p->ccm;
@@ -40,7 +40,11 @@ namespace cv
 namespace mcc
 {
 
-std::mutex mtx; // mutex for critical section
+#ifdef MCC_DEBUG
+static const double PARALLEL_STRIPES = 1; //Run only one thread in debug mode
+#else
+static const double PARALLEL_STRIPES = -1;
+#endif
 
 Ptr<CCheckerDetector> CCheckerDetector::create()
 {
@@ -65,435 +69,406 @@ bool CCheckerDetectorImpl::
 }
 
 bool CCheckerDetectorImpl::
-    _no_net_process(InputArray image, const TYPECHART chartType, const int nc,
-                    const Ptr<DetectorParameters> &params,
-                    std::vector<cv::Rect> regionsOfInterest)
+    process(InputArray image, const TYPECHART chartType,const std::vector<cv::Rect> &regionsOfInterest,
+            const int nc /*= 1*/, bool useNet /*=false*/, const Ptr<DetectorParameters> &params)
 {
-    m_checkers.clear();
-    this->net_used = false;
+    std::vector<std::vector<Ptr<CChecker>>> checkers;
+    detect(std::vector<cv::Mat>(1, image.getMat()),
+           std::vector<std::vector<cv::Rect>>(1, regionsOfInterest),
+           chartType, nc, useNet, params, checkers);
+    m_checkers = checkers[0];
+    return !m_checkers.empty();
+}
 
-    cv::Mat img = image.getMat();
-    for (const cv::Rect &region : regionsOfInterest)
-    {
-        //-------------------------------------------------------------------
-        // Run the model to find good regions
-        //-------------------------------------------------------------------
-        cv::Mat croppedImage = img(region);
-#ifdef MCC_DEBUG
-        std::string pathOut = "./";
-#endif
-        //-------------------------------------------------------------------
-        // prepare image
-        //-------------------------------------------------------------------
 
-        cv::Mat img_bgr, img_gray;
-        float asp;
-        prepareImage(croppedImage, img_gray, img_bgr, asp, params);
+//Overload for the above function
+bool CCheckerDetectorImpl::
+    process(InputArray image, const TYPECHART chartType,
+            const int nc /*= 1*/, bool useNet /*=false*/, const Ptr<DetectorParameters> &params)
+{
+    return process(image, chartType, std::vector<cv::Rect>(1, Rect(0, 0, image.cols(), image.rows())),
+                   nc,useNet, params);
+}
 
-#ifdef MCC_DEBUG
-        showAndSave("prepare_image", img_gray, pathOut);
-#endif
-        //-------------------------------------------------------------------
-        // thresholding
-        //-------------------------------------------------------------------
-        std::vector<cv::Mat> img_bw;
-        performThreshold(img_gray, img_bw, params);
+bool CCheckerDetectorImpl::
+    processBatch(InputArrayOfArrays images, const TYPECHART chartType,
+                 std::vector<std::vector<Ptr<CChecker>>> &checkers,
+                 const int nc /*= 1*/, bool useNet /*=false*/, const Ptr<DetectorParameters> &params)
+{
+    std::vector<cv::Mat> imgs;
+    images.getMatVector(imgs);
 
-        cv::Mat3f img_rgb_f(img_bgr);
-        cv::cvtColor(img_rgb_f, img_rgb_f, COLOR_BGR2RGB);
-        img_rgb_f /= 255;
+    std::vector<std::vector<cv::Rect>> regionsOfInterest(imgs.size());
+    for (size_t i = 0; i < imgs.size(); i++)
+        regionsOfInterest[i].push_back(Rect(0, 0, imgs[i].cols, imgs[i].rows));
 
-        cv::Mat img_rgb_org, img_ycbcr_org;
-        std::vector<cv::Mat> rgb_planes(3), ycbcr_planes(3);
+    detect(imgs, regionsOfInterest, chartType, nc, useNet, params, checkers);
+    m_checkers.clear();
 
-        // Convert to RGB and YCbCr space
-        cv::cvtColor(croppedImage, img_rgb_org, COLOR_BGR2RGB);
-        cv::cvtColor(croppedImage, img_ycbcr_org, COLOR_BGR2YCrCb);
+    bool found = false;
+    for (size_t i = 0; i < checkers.size(); i++)
+        found = found || !checkers[i].empty();
+    return found;
+}
 
-        // Get chanels
-        split(img_rgb_org, rgb_planes);
-        split(img_ycbcr_org, ycbcr_planes);
+void CCheckerDetectorImpl::
+    detect(const std::vector<cv::Mat> &images,
+           const std::vector<std::vector<cv::Rect>> &regionsOfInterest,
+           const TYPECHART chartType, const int nc, bool useNet,
+           const Ptr<DetectorParameters> &params,
+           std::vector<std::vector<Ptr<CChecker>>> &checkers)
+{
+    CV_Assert(images.size() == regionsOfInterest.size());
+    checkers.assign(images.size(), std::vector<Ptr<CChecker>>());
 
-        parallel_for_(
-            Range(0, (int)img_bw.size()), [&](const Range &range) {
-                const int begin = range.start;
-                const int end = range.end;
-                for (int i = begin; i < end; i++)
-                {
+    std::vector<SearchRegion> regions;
+    if (!this->net.empty() && useNet)
+    {
+        this->net_used = true;
+        findNetRegions(images, regionsOfInterest, params, regions);
+        detectInRegions(regions, chartType, nc, params, checkers);
+    }
 
-#ifdef MCC_DEBUG
-                    showAndSave("threshold_image", img_bw[i], pathOut);
-#endif
-                    // find contour
-                    //-------------------------------------------------------------------
-                    ContoursVector contours;
-                    findContours(img_bw[i], contours, params);
+    // The classical method looks for the charts in the whole regions of interest. It is also
+    // the failsafe of the images where nothing was found with the network.
+    this->net_used = false;
+    regions.clear();
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        if (!checkers[i].empty())
+            continue;
+        for (const cv::Rect &roi : regionsOfInterest[i])
+        {
+            SearchRegion region;
+            region.imageIdx = (int)i;
+            region.image = images[i](roi);
+            region.offset = roi.tl();
+            regions.push_back(region);
+        }
+    }
+    detectInRegions(regions, chartType, nc, params, checkers);
 
-                    if (contours.empty())
-                        continue;
-#ifdef MCC_DEBUG
-                    cv::Mat im_contour(img_bgr.size(), CV_8UC1);
-                    im_contour = cv::Scalar(0);
-                    cv::drawContours(im_contour, contours, -1, cv::Scalar(255), 2, LINE_AA);
-                    showAndSave("find_contour", im_contour, pathOut);
-#endif
-                    //-------------------------------------------------------------------
-                    // find candidate
-                    //-------------------------------------------------------------------
+    for (size_t i = 0; i < checkers.size(); i++)
+    {
+        //remove too close detections
+        removeTooCloseDetections(checkers[i], params);
+        checkers[i].resize(min(nc, (int)checkers[i].size()));
+    }
+}
 
-                    std::vector<CChart> detectedCharts;
-                    findCandidates(contours, detectedCharts, params);
+void CCheckerDetectorImpl::
+    findNetRegions(const std::vector<cv::Mat> &images,
+                   const std::vector<std::vector<cv::Rect>> &regionsOfInterest,
+                   const Ptr<DetectorParameters> &params,
+                   std::vector<SearchRegion> &regions)
+{
+    // The colors of the charts are read from the whole image, shared by all its regions
+    std::vector<SearchRegion> colors(images.size());
+    parallel_for_(
+        Range(0, (int)images.size()), [&](const Range &range) {
+            for (int i = range.start; i < range.end; i++)
+            {
+                // Convert to RGB and YCbCr space
+                cv::cvtColor(images[i], colors[i].img_rgb_org, COLOR_BGR2RGB);
+                cv::cvtColor(images[i], colors[i].img_ycbcr_org, COLOR_BGR2YCrCb);
 
-                    if (detectedCharts.empty())
-                        continue;
+                // Get chanels
+                split(colors[i].img_rgb_org, colors[i].rgb_planes);
+                split(colors[i].img_ycbcr_org, colors[i].ycbcr_planes);
+            }
+        });
 
-#ifdef MCC_DEBUG
-                    cv::Mat img_chart;
-                    img_bgr.copyTo(img_chart);
+    std::vector<std::pair<int, cv::Rect>> crops;
+    for (size_t i = 0; i < images.size(); i++)
+        for (const cv::Rect &roi : regionsOfInterest[i])
+            crops.push_back(std::make_pair((int)i, roi));
 
-                    for (size_t ind = 0; ind < detectedCharts.size(); ind++)
-                    {
+    std::vector<std::vector<SearchRegion>> cropRegions(crops.size());
+    std::vector<bool> done(crops.size(), false);
+    for (size_t c = 0; c < crops.size(); c++)
+    {
+        if (done[c])
+            continue;
 
-                        CChartDraw chrtdrw((detectedCharts[ind]), img_chart);
-                        chrtdrw.drawCenter();
-                        chrtdrw.drawContour();
-                    }
-                    showAndSave("find_candidate", img_chart, pathOut);
-#endif
-                    //-------------------------------------------------------------------
-                    // clusters analysis
-                    //-------------------------------------------------------------------
+        //-------------------------------------------------------------------
+        // Run the model to find good regions, in a single batch for all the
+        // crops with the same size
+        //-------------------------------------------------------------------
+        std::vector<size_t> batch;
+        std::vector<cv::Mat> batchImages;
+        for (size_t k = c; k < crops.size(); k++)
+        {
+            if (!done[k] && crops[k].second.size() == crops[c].second.size())
+            {
+                done[k] = true;
+                batch.push_back(k);
+                batchImages.push_back(images[crops[k].first](crops[k].second));
+            }
+        }
 
-                    std::vector<int> G;
-                    clustersAnalysis(detectedCharts, G, params);
+        net.setInput(cv::dnn::blobFromImages(batchImages, 1.0, cv::Size(), cv::Scalar(), true));
+        cv::Mat output = net.forward();
 
-                    if (G.empty())
-                        continue;
+        Mat detectionMat(output.size[2], output.size[3], CV_32F, output.ptr<float>());
 
-#ifdef MCC_DEBUG
-                    cv::Mat im_gru;
-                    img_bgr.copyTo(im_gru);
-                    RNG rng(0xFFFFFFFF);
-                    int radius = 10, thickness = -1;
-
-                    std::vector<int> g;
-                    unique(G, g);
-                    size_t Nc = g.size();
-                    std::vector<cv::Scalar> colors(Nc);
-                    for (size_t ind = 0; ind < Nc; ind++)
-                        colors[ind] = randomcolor(rng);
-
-                    for (size_t ind = 0; ind < detectedCharts.size(); ind++)
-                        cv::circle(im_gru, detectedCharts[ind].center, radius, colors[G[ind]],
-                                   thickness);
-                    showAndSave("clusters_analysis", im_gru, pathOut);
-#endif
-                    //-------------------------------------------------------------------
-                    // checker color recognize
-                    //-------------------------------------------------------------------
+        for (int i = 0; i < detectionMat.rows; i++)
+        {
+            // the first column is the index of the image in the batch
+            int b = cvRound(detectionMat.at<float>(i, 0));
+            float confidence = detectionMat.at<float>(i, 2);
+            if (b < 0 || b >= (int)batch.size() || !(confidence > params->confidenceThreshold))
+                continue;
 
-                    std::vector<std::vector<cv::Point2f>> colorCharts;
-                    checkerRecognize(img_bgr, detectedCharts, G, chartType, colorCharts, params);
+            const std::pair<int, cv::Rect> &crop = crops[batch[b]];
+            cv::Mat croppedImage = batchImages[b];
+            int rows = croppedImage.size[0];
+            int cols = croppedImage.size[1];
 
-                    if (colorCharts.empty())
-                        continue;
+            float xTopLeft = max(0.0f, detectionMat.at<float>(i, 3) * cols - params->borderWidth);
+            float yTopLeft = max(0.0f, detectionMat.at<float>(i, 4) * rows - params->borderWidth);
+            float xBottomRight = min((float)cols - 1, detectionMat.at<float>(i, 5) * cols + params->borderWidth);
+            float yBottomRight = min((float)rows - 1, detectionMat.at<float>(i, 6) * rows + params->borderWidth);
 
-#ifdef MCC_DEBUG
-                    cv::Mat image_box;
-                    img_bgr.copyTo(image_box);
-                    for (size_t ind = 0; ind < colorCharts.size(); ind++)
-                    {
-                        std::vector<cv::Point2f> ibox = colorCharts[ind];
-                        cv::Scalar color_box = CV_RGB(0, 0, 255);
-                        int thickness_box = 2;
-                        cv::line(image_box, ibox[0], ibox[1], color_box, thickness_box, LINE_AA);
-                        cv::line(image_box, ibox[1], ibox[2], color_box, thickness_box, LINE_AA);
-                        cv::line(image_box, ibox[2], ibox[3], color_box, thickness_box, LINE_AA);
-                        cv::line(image_box, ibox[3], ibox[0], color_box, thickness_box, LINE_AA);
-                        //cv::circle(image_box, ibox[0], 10, cv::Scalar(0, 0, 255), 3);
-                        //cv::circle(image_box, ibox[1], 10, cv::Scalar(0, 255, 0), 3);
-                    }
-                    showAndSave("checker_recognition", image_box, pathOut);
-#endif
-                    //-------------------------------------------------------------------
-                    // checker color analysis
-                    //-------------------------------------------------------------------
-                    std::vector<Ptr<CChecker>> checkers;
-                    checkerAnalysis(img_rgb_f, chartType, nc, colorCharts, checkers, asp, params,
-                                    img_rgb_org, img_ycbcr_org, rgb_planes, ycbcr_planes);
+            cv::Point2f topLeft = {xTopLeft, yTopLeft};
+            cv::Point2f bottomRight = {xBottomRight, yBottomRight};
 
-#ifdef MCC_DEBUG
-                    cv::Mat image_checker;
-                    croppedImage.copyTo(image_checker);
-                    for (size_t ck = 0; ck < checkers.size(); ck++)
-                    {
-                        Ptr<CCheckerDraw> cdraw = CCheckerDraw::create((checkers[ck]));
-                        cdraw->draw(image_checker);
-                    }
-                    showAndSave("checker_analysis", image_checker, pathOut);
-#endif
-                    for (Ptr<CChecker> checker : checkers)
-                    {
-                        for (cv::Point2f &corner : checker->getBox())
-                            corner += static_cast<cv::Point2f>(region.tl());
-
-                        mtx.lock(); // push_back is not thread safe
-                        m_checkers.push_back(checker);
-                        mtx.unlock();
-                    }
-                }
-#ifdef MCC_DEBUG
-            },
-            1); //Run only one thread in debug mode
-#else
-            });
-#endif
+            cv::Rect innerRegion(topLeft, bottomRight);
+
+            SearchRegion region = colors[crop.first];
+            region.imageIdx = crop.first;
+            region.image = croppedImage(innerRegion);
+            region.offset = crop.second.tl() + innerRegion.tl();
+            cropRegions[batch[b]].push_back(region);
+        }
     }
-    //remove too close detections
-    removeTooCloseDetections(params);
-    m_checkers.resize(min(nc, (int)m_checkers.size()));
-    return !m_checkers.empty();
+
+    // keep the order of the regions of interest
+    for (size_t c = 0; c < crops.size(); c++)
+        regions.insert(regions.end(), cropRegions[c].begin(), cropRegions[c].end());
 }
 
-bool CCheckerDetectorImpl::
-    process(InputArray image, const TYPECHART chartType,const std::vector<cv::Rect> &regionsOfInterest,
-            const int nc /*= 1*/, bool useNet /*=false*/, const Ptr<DetectorParameters> &params)
+void CCheckerDetectorImpl::
+    detectInRegions(std::vector<SearchRegion> &regions, const TYPECHART chartType, const int nc,
+                    const Ptr<DetectorParameters> &params,
+                    std::vector<std::vector<Ptr<CChecker>>> &checkers)
 {
-    m_checkers.clear();
-
-    if (this->net.empty() || !useNet)
+    // The regions are processed in groups, so that the thresholded images of a large batch do
+    // not have to be in memory at once
+    const int groupSize = std::max(1, getNumThreads());
+    for (int g = 0; g < (int)regions.size(); g += groupSize)
     {
-        return _no_net_process(image, chartType, nc, params, regionsOfInterest);
-    }
-    this->net_used = true;
+        const int groupEnd = std::min(g + groupSize, (int)regions.size());
 
-    cv::Mat img = image.getMat();
-
-    cv::Mat img_rgb_org, img_ycbcr_org;
-    std::vector<cv::Mat> rgb_planes(3), ycbcr_planes(3);
-
-    // Convert to RGB and YCbCr space
-    cv::cvtColor(img, img_rgb_org, COLOR_BGR2RGB);
-    cv::cvtColor(img, img_ycbcr_org, COLOR_BGR2YCrCb);
-
-    // Get chanels
-    split(img_rgb_org, rgb_planes);
-    split(img_ycbcr_org, ycbcr_planes);
-
-    for (const cv::Rect &region : regionsOfInterest)
-    {
         //-------------------------------------------------------------------
-        // Run the model to find good regions
+        // prepare image and thresholding
         //-------------------------------------------------------------------
+        parallel_for_(
+            Range(g, groupEnd), [&](const Range &range) {
+                for (int r = range.start; r < range.end; r++)
+                    prepareRegion(regions[r], params);
+            },
+            PARALLEL_STRIPES);
 
-        cv::Mat croppedImage = img(region);
+        // every threshold of every region is evaluated in parallel and gives
+        // its own list of checkers, so no synchronization is needed
+        std::vector<std::pair<int, int>> tasks;
+        for (int r = g; r < groupEnd; r++)
+            for (int t = 0; t < (int)regions[r].img_bw.size(); t++)
+                tasks.push_back(std::make_pair(r, t));
 
-        int rows = croppedImage.size[0];
-        int cols = croppedImage.size[1];
-        net.setInput(cv::dnn::blobFromImage(croppedImage, 1.0, cv::Size(), cv::Scalar(), true));
-        cv::Mat output = net.forward();
-
-        Mat detectionMat(output.size[2], output.size[3], CV_32F, output.ptr<float>());
+        std::vector<std::vector<Ptr<CChecker>>> found(tasks.size());
+        parallel_for_(
+            Range(0, (int)tasks.size()), [&](const Range &range) {
+                for (int i = range.start; i < range.end; i++)
+                    evaluateThreshold(regions[tasks[i].first], tasks[i].second,
+                                      chartType, nc, params, found[i]);
+            },
+            PARALLEL_STRIPES);
 
-        for (int i = 0; i < detectionMat.rows; i++)
+        // the checkers are gathered in the order of a serial evaluation
+        for (size_t i = 0; i < tasks.size(); i++)
         {
-            float confidence = detectionMat.at<float>(i, 2);
-            if (confidence > params->confidenceThreshold)
-            {
-                float xTopLeft = max(0.0f, detectionMat.at<float>(i, 3) * cols - params->borderWidth);
-                float yTopLeft = max(0.0f, detectionMat.at<float>(i, 4) * rows - params->borderWidth);
-                float xBottomRight = min((float)cols - 1, detectionMat.at<float>(i, 5) * cols + params->borderWidth);
-                float yBottomRight = min((float)rows - 1, detectionMat.at<float>(i, 6) * rows + params->borderWidth);
-
-                cv::Point2f topLeft = {xTopLeft, yTopLeft};
-                cv::Point2f bottomRight = {xBottomRight, yBottomRight};
+            std::vector<Ptr<CChecker>> &dst = checkers[regions[tasks[i].first].imageIdx];
+            dst.insert(dst.end(), found[i].begin(), found[i].end());
+        }
 
-                cv::Rect innerRegion(topLeft, bottomRight);
-                cv::Mat innerCroppedImage = croppedImage(innerRegion);
+        for (int r = g; r < groupEnd; r++)
+            regions[r].release();
+    }
+}
 
+void CCheckerDetectorImpl::
+    prepareRegion(SearchRegion &region, const Ptr<DetectorParameters> &params) const
+{
 #ifdef MCC_DEBUG
-                std::string pathOut = "./";
+    std::string pathOut = "./";
 #endif
-                //-------------------------------------------------------------------
-                // prepare image
-                //-------------------------------------------------------------------
+    //-------------------------------------------------------------------
+    // prepare image
+    //-------------------------------------------------------------------
 
-                cv::Mat img_bgr, img_gray;
-                float asp;
-                prepareImage(innerCroppedImage, img_gray, img_bgr, asp, params);
+    cv::Mat img_gray;
+    prepareImage(region.image, img_gray, region.img_bgr, region.asp, params);
 
-                //-------------------------------------------------------------------
-                // thresholding
-                //-------------------------------------------------------------------
-
-                std::vector<cv::Mat> img_bw;
-                performThreshold(img_gray, img_bw, params);
-
-                cv::Mat3f img_rgb_f(img_bgr);
-                cv::cvtColor(img_rgb_f, img_rgb_f, COLOR_BGR2RGB);
-                img_rgb_f /= 255;
-
-                parallel_for_(
-                    Range(0, (int)img_bw.size()), [&](const Range &range) {
-                        const int begin = range.start;
-                        const int end = range.end;
+#ifdef MCC_DEBUG
+    showAndSave("prepare_image", img_gray, pathOut);
+#endif
+    //-------------------------------------------------------------------
+    // thresholding
+    //-------------------------------------------------------------------
+    performThreshold(img_gray, region.img_bw, params);
+
+    cv::Mat3f img_rgb_f(region.img_bgr);
+    cv::cvtColor(img_rgb_f, img_rgb_f, COLOR_BGR2RGB);
+    img_rgb_f /= 255;
+    region.img_rgb_f = img_rgb_f;
+
+    // Without colors of the whole image, they are read from the region itself
+    if (region.img_rgb_org.empty())
+    {
+        // Convert to RGB and YCbCr space
+        cv::cvtColor(region.image, region.img_rgb_org, COLOR_BGR2RGB);
+        cv::cvtColor(region.image, region.img_ycbcr_org, COLOR_BGR2YCrCb);
 
-                        for (int ind = begin; ind < end; ind++)
-                        {
+        // Get chanels
+        split(region.img_rgb_org, region.rgb_planes);
+        split(region.img_ycbcr_org, region.ycbcr_planes);
+    }
+}
 
+void CCheckerDetectorImpl::
+    evaluateThreshold(SearchRegion &region, int t, const TYPECHART chartType, const int nc,
+                      const Ptr<DetectorParameters> &params,
+                      std::vector<Ptr<CChecker>> &found)
+{
 #ifdef MCC_DEBUG
-                            showAndSave("threshold_image", img_bw[ind], pathOut);
+    std::string pathOut = "./";
+    const cv::Mat &img_bgr = region.img_bgr;
+
+    showAndSave("threshold_image", region.img_bw[t], pathOut);
 #endif
-                            //------------------------------------------------------------------
-                            // find contour
-                            //-------------------------------------------------------------------
-                            ContoursVector contours;
-                            findContours(img_bw[ind], contours, params);
-
-                            if (contours.empty())
-                                continue;
+    //-------------------------------------------------------------------
+    // find contour
+    //-------------------------------------------------------------------
+    ContoursVector contours;
+    findContours(region.img_bw[t], contours, params);
+
+    if (contours.empty())
+        return;
 #ifdef MCC_DEBUG
-                            cv::Mat im_contour(img_bgr.size(), CV_8UC1);
-                            im_contour = cv::Scalar(0);
-                            cv::drawContours(im_contour, contours, -1, cv::Scalar(255), 2, LINE_AA);
-                            showAndSave("find_contour", im_contour, pathOut);
+    cv::Mat im_contour(img_bgr.size(), CV_8UC1);
+    im_contour = cv::Scalar(0);
+    cv::drawContours(im_contour, contours, -1, cv::Scalar(255), 2, LINE_AA);
+    showAndSave("find_contour", im_contour, pathOut);
 #endif
-                            //-------------------------------------------------------------------
-                            // find candidate
-                            //-------------------------------------------------------------------
+    //-------------------------------------------------------------------
+    // find candidate
+    //-------------------------------------------------------------------
 
-                            std::vector<CChart> detectedCharts;
-                            findCandidates(contours, detectedCharts, params);
+    std::vector<CChart> detectedCharts;
+    findCandidates(contours, detectedCharts, params);
 
-                            if (detectedCharts.empty())
-                                continue;
+    if (detectedCharts.empty())
+        return;
 
 #ifdef MCC_DEBUG
-                            cv::Mat img_chart;
-                            img_bgr.copyTo(img_chart);
+    cv::Mat img_chart;
+    img_bgr.copyTo(img_chart);
 
-                            for (size_t index = 0; index < detectedCharts.size(); index++)
-                            {
+    for (size_t ind = 0; ind < detectedCharts.size(); ind++)
+    {
 
-                                CChartDraw chrtdrw((detectedCharts[index]), img_chart);
-                                chrtdrw.drawCenter();
-                                chrtdrw.drawContour();
-                            }
-                            showAndSave("find_candidate", img_chart, pathOut);
+        CChartDraw chrtdrw((detectedCharts[ind]), img_chart);
+        chrtdrw.drawCenter();
+        chrtdrw.drawContour();
+    }
+    showAndSave("find_candidate", img_chart, pathOut);
 #endif
-                            //-------------------------------------------------------------------
-                            // clusters analysis
-                            //-------------------------------------------------------------------
+    //-------------------------------------------------------------------
+    // clusters analysis
+    //-------------------------------------------------------------------
 
-                            std::vector<int> G;
-                            clustersAnalysis(detectedCharts, G, params);
+    std::vector<int> G;
+    clustersAnalysis(detectedCharts, G, params);
+
+    if (G.empty())
+        return;
 
-                            if (G.empty())
-                                continue;
 #ifdef MCC_DEBUG
-                            cv::Mat im_gru;
-                            img_bgr.copyTo(im_gru);
-                            RNG rng(0xFFFFFFFF);
-                            int radius = 10, thickness = -1;
-
-                            std::vector<int> g;
-                            unique(G, g);
-                            size_t Nc = g.size();
-                            std::vector<cv::Scalar> colors(Nc);
-                            for (size_t index = 0; index < Nc; index++)
-                                colors[index] = randomcolor(rng);
-
-                            for (size_t index = 0; index < detectedCharts.size(); index++)
-                                cv::circle(im_gru, detectedCharts[index].center, radius, colors[G[index]],
-                                           thickness);
-                            showAndSave("clusters_analysis", im_gru, pathOut);
+    cv::Mat im_gru;
+    img_bgr.copyTo(im_gru);
+    RNG rng(0xFFFFFFFF);
+    int radius = 10, thickness = -1;
+
+    std::vector<int> g;
+    unique(G, g);
+    size_t Nc = g.size();
+    std::vector<cv::Scalar> colors(Nc);
+    for (size_t ind = 0; ind < Nc; ind++)
+        colors[ind] = randomcolor(rng);
+
+    for (size_t ind = 0; ind < detectedCharts.size(); ind++)
+        cv::circle(im_gru, detectedCharts[ind].center, radius, colors[G[ind]],
+                   thickness);
+    showAndSave("clusters_analysis", im_gru, pathOut);
 #endif
+    //-------------------------------------------------------------------
+    // checker color recognize
+    //-------------------------------------------------------------------
 
-                            //-------------------------------------------------------------------
-                            // checker color recognize
-                            //-------------------------------------------------------------------
-
-                            std::vector<std::vector<cv::Point2f>> colorCharts;
-                            checkerRecognize(img_bgr, detectedCharts, G, chartType, colorCharts, params);
+    std::vector<std::vector<cv::Point2f>> colorCharts;
+    checkerRecognize(region.img_bgr, detectedCharts, G, chartType, colorCharts, params);
 
-                            if (colorCharts.empty())
-                                continue;
+    if (colorCharts.empty())
+        return;
 
 #ifdef MCC_DEBUG
-                            cv::Mat image_box;
-                            img_bgr.copyTo(image_box);
-                            for (size_t index = 0; index < colorCharts.size(); index++)
-                            {
-                                std::vector<cv::Point2f> ibox = colorCharts[index];
-                                cv::Scalar color_box = CV_RGB(0, 0, 255);
-                                int thickness_box = 2;
-                                cv::line(image_box, ibox[0], ibox[1], color_box, thickness_box, LINE_AA);
-                                cv::line(image_box, ibox[1], ibox[2], color_box, thickness_box, LINE_AA);
-                                cv::line(image_box, ibox[2], ibox[3], color_box, thickness_box, LINE_AA);
-                                cv::line(image_box, ibox[3], ibox[0], color_box, thickness_box, LINE_AA);
-                                //cv::circle(image_box, ibox[0], 10, cv::Scalar(0, 0, 255), 3);
-                                //cv::circle(image_box, ibox[1], 10, cv::Scalar(0, 255, 0), 3);
-                            }
-                            showAndSave("checker_recognition", image_box, pathOut);
-#endif
-                            //-------------------------------------------------------------------
-                            // checker color analysis
-                            //-------------------------------------------------------------------
-                            std::vector<Ptr<CChecker>> checkers;
-                            checkerAnalysis(img_rgb_f, chartType, nc, colorCharts, checkers, asp, params,
-                                            img_rgb_org, img_ycbcr_org, rgb_planes, ycbcr_planes);
-#ifdef MCC_DEBUG
-                            cv::Mat image_checker;
-                            innerCroppedImage.copyTo(image_checker);
-                            for (size_t ck = 0; ck < checkers.size(); ck++)
-                            {
-                                Ptr<CCheckerDraw> cdraw = CCheckerDraw::create((checkers[ck]));
-                                cdraw->draw(image_checker);
-                            }
-                            showAndSave("checker_analysis", image_checker, pathOut);
+    cv::Mat image_box;
+    img_bgr.copyTo(image_box);
+    for (size_t ind = 0; ind < colorCharts.size(); ind++)
+    {
+        std::vector<cv::Point2f> ibox = colorCharts[ind];
+        cv::Scalar color_box = CV_RGB(0, 0, 255);
+        int thickness_box = 2;
+        cv::line(image_box, ibox[0], ibox[1], color_box, thickness_box, LINE_AA);
+        cv::line(image_box, ibox[1], ibox[2], color_box, thickness_box, LINE_AA);
+        cv::line(image_box, ibox[2], ibox[3], color_box, thickness_box, LINE_AA);
+        cv::line(image_box, ibox[3], ibox[0], color_box, thickness_box, LINE_AA);
+        //cv::circle(image_box, ibox[0], 10, cv::Scalar(0, 0, 255), 3);
+        //cv::circle(image_box, ibox[1], 10, cv::Scalar(0, 255, 0), 3);
+    }
+    showAndSave("checker_recognition", image_box, pathOut);
 #endif
-                            for (Ptr<CChecker> checker : checkers)
-                            {
-                                for (cv::Point2f &corner : checker->getBox())
-                                    corner += static_cast<cv::Point2f>(region.tl() + innerRegion.tl());
-                                mtx.lock(); // push_back is not thread safe
-                                m_checkers.push_back(checker);
-                                mtx.unlock();
-                            }
-                        }
+    //-------------------------------------------------------------------
+    // checker color analysis
+    //-------------------------------------------------------------------
+    std::vector<Ptr<CChecker>> checkers;
+    checkerAnalysis(region.img_rgb_f, chartType, nc, colorCharts, checkers, region.asp, params,
+                    region.img_rgb_org, region.img_ycbcr_org, region.rgb_planes, region.ycbcr_planes);
+
 #ifdef MCC_DEBUG
-                    },
-                    1); //Run only one thread in debug mode
-#else
-                    });
-#endif
-            }
-        }
+    cv::Mat image_checker;
+    region.image.copyTo(image_checker);
+    for (size_t ck = 0; ck < checkers.size(); ck++)
+    {
+        Ptr<CCheckerDraw> cdraw = CCheckerDraw::create((checkers[ck]));
+        cdraw->draw(image_checker);
     }
-    // As a failsafe try the classical method
-    if (m_checkers.empty())
+    showAndSave("checker_analysis", image_checker, pathOut);
+#endif
+    for (Ptr<CChecker> checker : checkers)
     {
-        return _no_net_process(image, chartType, nc, params, regionsOfInterest);
+        // getBox() returns a copy, the moved box has to be set again
+        const cv::Point2f offset = static_cast<cv::Point2f>(region.offset);
+        std::vector<cv::Point2f> box = checker->getBox();
+        for (cv::Point2f &corner : box)
+            corner += offset;
+        checker->setBox(box);
+        checker->setCenter(checker->getCenter() + offset);
+        found.push_back(checker);
     }
-    //remove too close detections
-    removeTooCloseDetections(params);
-
-    m_checkers.resize(min(nc, (int)m_checkers.size()));
-
-    return !m_checkers.empty();
-}
-
-
-//Overload for the above function
-bool CCheckerDetectorImpl::
-    process(InputArray image, const TYPECHART chartType,
-            const int nc /*= 1*/, bool useNet /*=false*/, const Ptr<DetectorParameters> &params)
-{
-    return process(image, chartType, std::vector<cv::Rect>(1, Rect(0, 0, image.cols(), image.rows())),
-                   nc,useNet, params);
 }
 
-
 void CCheckerDetectorImpl::
     prepareImage(InputArray bgr, OutputArray grayOut,
                  OutputArray bgrOut, float &aspOut,
@@ -1034,20 +1009,20 @@ void CCheckerDetectorImpl::
 }
 
 void CCheckerDetectorImpl::
-    removeTooCloseDetections(const Ptr<DetectorParameters> &params)
+    removeTooCloseDetections(std::vector<Ptr<CChecker>> &checkers, const Ptr<DetectorParameters> &params) const
 {
     // Remove these elements which corners are too close to each other.
     // Eliminate overlaps!!!
     // First detect candidates for removal:
     std::vector<std::pair<int, int>> tooNearCandidates;
-    for (int i = 0; i < (int)m_checkers.size(); i++)
+    for (int i = 0; i < (int)checkers.size(); i++)
     {
-        const Ptr<CChecker> &m1 = m_checkers[i];
+        const Ptr<CChecker> &m1 = checkers[i];
 
         //calculate the average distance of each corner to the nearest corner of the other chart candidate
-        for (int j = i + 1; j < (int)m_checkers.size(); j++)
+        for (int j = i + 1; j < (int)checkers.size(); j++)
         {
-            const Ptr<CChecker> &m2 = m_checkers[j];
+            const Ptr<CChecker> &m2 = checkers[j];
 
             float distSquared = 0;
 
@@ -1067,12 +1042,12 @@ void CCheckerDetectorImpl::
     }
 
     // Mark for removal the element of the pair with smaller cost
-    std::vector<bool> removalMask(m_checkers.size(), false);
+    std::vector<bool> removalMask(checkers.size(), false);
 
     for (size_t i = 0; i < tooNearCandidates.size(); i++)
     {
-        float p1 = m_checkers[tooNearCandidates[i].first]->getCost();
-        float p2 = m_checkers[tooNearCandidates[i].second]->getCost();
+        float p1 = checkers[tooNearCandidates[i].first]->getCost();
+        float p2 = checkers[tooNearCandidates[i].second]->getCost();
 
         size_t removalIndex;
         if (p1 < p2)
@@ -1083,17 +1058,17 @@ void CCheckerDetectorImpl::
         removalMask[removalIndex] = true;
     }
 
-    std::vector<Ptr<CChecker>> copy_m_checkers = m_checkers;
-    m_checkers.clear();
+    std::vector<Ptr<CChecker>> copy_checkers = checkers;
+    checkers.clear();
 
-    for (size_t i = 0; i < copy_m_checkers.size(); i++)
+    for (size_t i = 0; i < copy_checkers.size(); i++)
     {
         if (removalMask[i])
             continue;
-        m_checkers.push_back(copy_m_checkers[i]);
+        checkers.push_back(copy_checkers[i]);
     }
 
-    sort( m_checkers.begin(), m_checkers.end(),
+    sort( checkers.begin(), checkers.end(),
           [&](const Ptr<CChecker> &a, const Ptr<CChecker> &b)
           {
               return a->getCost() < b->getCost();
@@ -70,11 +70,75 @@ public:
         return m_checkers;
     }
 
+    bool processBatch(InputArrayOfArrays images, const TYPECHART chartType,
+                      std::vector<std::vector<Ptr<CChecker>>> &checkers,
+                      const int nc = 1, bool use_net = false,
+                      const Ptr<DetectorParameters> &params = DetectorParameters::create()) CV_OVERRIDE;
+
+protected: // search regions
+    /// Part of an image where the charts are looked for, with the data shared
+    /// by all its threshold evaluations
+    struct SearchRegion
+    {
+        int imageIdx = 0;              ///< index of the image in the batch
+        cv::Mat image;                 ///< the region itself
+        cv::Point offset;              ///< position of the region in the image
+        cv::Mat img_bgr;               ///< rescaled region
+        std::vector<cv::Mat> img_bw;   ///< thresholded images, one per scale
+        cv::Mat img_rgb_f;
+        float asp = 1;
+        cv::Mat img_rgb_org, img_ycbcr_org;
+        std::vector<cv::Mat> rgb_planes, ycbcr_planes;
+
+        void release()
+        {
+            img_bgr.release();
+            img_bw.clear();
+            img_rgb_f.release();
+        }
+    };
+
+    /// detect
+    /** \brief Find the charts in the regions of interest of every image
+      * \param[out] checkers sorted checkers of each image, at most nc of them
+      */
+    void detect(const std::vector<cv::Mat> &images,
+                const std::vector<std::vector<cv::Rect>> &regionsOfInterest,
+                const TYPECHART chartType, const int nc, bool useNet,
+                const Ptr<DetectorParameters> &params,
+                std::vector<std::vector<Ptr<CChecker>>> &checkers);
+
+    /// findNetRegions
+    /** \brief Regions found by the network, run once for all the regions of
+      *        interest of the same size
+      */
+    void findNetRegions(const std::vector<cv::Mat> &images,
+                        const std::vector<std::vector<cv::Rect>> &regionsOfInterest,
+                        const Ptr<DetectorParameters> &params,
+                        std::vector<SearchRegion> &regions);
+
+    /// detectInRegions
+    /** \brief Evaluates all the thresholds of all the regions in parallel and
+      *        appends the checkers found to the lists of their images
+      */
+    void detectInRegions(std::vector<SearchRegion> &regions, const TYPECHART chartType,
+                         const int nc, const Ptr<DetectorParameters> &params,
+                         std::vector<std::vector<Ptr<CChecker>>> &checkers);
+
+    /// prepareRegion
+    /** \brief Rescaled, thresholded and color images of a region
+      */
+    void prepareRegion(SearchRegion &region, const Ptr<DetectorParameters> &params) const;
+
+    /// evaluateThreshold
+    /** \brief Pipeline from the contours to the checkers for the threshold t
+      *        of a region
+      */
+    void evaluateThreshold(SearchRegion &region, int t, const TYPECHART chartType,
+                           const int nc, const Ptr<DetectorParameters> &params,
+                           std::vector<Ptr<CChecker>> &found);
+
 protected: // methods pipeline
-    bool _no_net_process(InputArray image, const TYPECHART chartType,
-                         const int nc,
-                         const Ptr<DetectorParameters> &params,
-                         std::vector<cv::Rect> regionsOfInterest);
     /// prepareImage
     /** \brief Prepare Image
       * \param[in] bgrMat image in color space BGR
@@ -154,7 +218,8 @@ protected: // methods pipeline
                     std::vector<cv::Mat> &ycbcr_planes);
 
     virtual void
-    removeTooCloseDetections(const Ptr<DetectorParameters> &params);
+    removeTooCloseDetections(std::vector<Ptr<CChecker>> &checkers,
+                             const Ptr<DetectorParameters> &params) const;
 
 protected:
     std::vector<Ptr<CChecker>> m_checkers;
@@ -33,6 +33,15 @@
 
 namespace cv {
 namespace ccm {
+
+// The color spaces and the adaptation matrices are created on first use and shared by all
+// the models, which may run concurrently
+static Mutex& getColorSpaceMutex()
+{
+    static Mutex* mutex = new Mutex();
+    return *mutex;
+}
+
 static const std::vector<double>& getIlluminants(const IO& io)
 {
     static const std::map<IO, std::vector<double>> illuminants = {
@@ -357,6 +366,7 @@ Operations XYZ::cam(IO dio, CAM method)
 }
 Mat XYZ::cam_(IO sio, IO dio, CAM method) const
 {
+    AutoLock lock(getColorSpaceMutex());
     static std::map<std::tuple<IO, IO, CAM>, Mat> cams;
 
     if (sio == dio)
@@ -392,6 +402,7 @@ Mat XYZ::cam_(IO sio, IO dio, CAM method) const
 
 std::shared_ptr<XYZ> XYZ::get(IO io)
 {
+    AutoLock lock(getColorSpaceMutex());
     static std::map<IO, std::shared_ptr<XYZ>> xyz_cs;
 
     if (xyz_cs.count(io) == 1)
@@ -459,6 +470,7 @@ Mat Lab::tosrc(Mat& src)
 
 std::shared_ptr<Lab> Lab::get(IO io)
 {
+    AutoLock lock(getColorSpaceMutex());
     static std::map<IO, std::shared_ptr<Lab>> 	lab_cs;
 
     if (lab_cs.count(io) == 1)
@@ -483,6 +495,7 @@ GetCS& GetCS::getInstance()
 
 std::shared_ptr<RGBBase_> GetCS::get_rgb(enum COLOR_SPACE cs_name)
 {
+    AutoLock lock(getColorSpaceMutex());
     switch (cs_name)
     {
     case cv::ccm::COLOR_SPACE_sRGB:
@@ -600,6 +613,7 @@ std::shared_ptr<RGBBase_> GetCS::get_rgb(enum COLOR_SPACE cs_name)
 
 std::shared_ptr<ColorSpace> GetCS::get_cs(enum COLOR_SPACE cs_name)
 {
+    AutoLock lock(getColorSpaceMutex());
     switch (cs_name)
     {
     case cv::ccm::COLOR_SPACE_sRGB:
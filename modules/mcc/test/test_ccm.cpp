@@ -162,5 +162,29 @@ TEST(CV_ccmRunColorCorrection, test_masks_weights_2)
     ASSERT_MAT_NEAR(model2.getMask(), mask, 0.0);
 }
 
+TEST(CV_ccmRunColorCorrection, test_run_batch)
+{
+    const CCM_TYPE types[] = { CCM_3x3, CCM_4x3 };
+    const COLOR_SPACE spaces[] = { COLOR_SPACE_sRGB, COLOR_SPACE_AdobeRGB };
+    std::vector<ColorCorrectionModel> models, singles;
+    for (int i = 0; i < 4; i++)
+    {
+        for (int k = 0; k < 2; k++)
+        {
+            ColorCorrectionModel model(s / 255 * (1 - 0.05 * i), COLORCHECKER_Macbeth);
+            model.setCCM_TYPE(types[i % 2]);
+            model.setColorSpace(spaces[i / 2]);
+            (k == 0 ? models : singles).push_back(model);
+        }
+    }
+    ColorCorrectionModel::run(models);
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        singles[i].run();
+        ASSERT_MAT_NEAR(models[i].getCCM(), singles[i].getCCM(), 1e-10);
+        EXPECT_NEAR(models[i].getLoss(), singles[i].getLoss(), 1e-10);
+    }
+}
+
 } // namespace
 } // namespace opencv_test
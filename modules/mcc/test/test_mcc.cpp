@@ -81,5 +81,35 @@ TEST(CV_mccRunCCheckerDetectorBasic, accuracy_VINYL18)
     runCCheckerDetectorBasic("VINYL18.png", VINYL18);
 }
 
+TEST(CV_mccRunCCheckerDetectorBasic, processBatch)
+{
+    const std::string names[] = { "SG140.png", "MCC24.png", "VINYL18.png" };
+    std::vector<cv::Mat> images;
+    for (const std::string &name : names)
+    {
+        std::string path = cvtest::findDataFile("mcc/" + name);
+        images.push_back(imread(path));
+        ASSERT_FALSE(images.back().empty()) << "Test image can't be loaded: " << path;
+    }
+
+    Ptr<CCheckerDetector> detector = CCheckerDetector::create();
+    std::vector<std::vector<Ptr<CChecker>>> checkers;
+    ASSERT_TRUE(detector->processBatch(images, MCC24, checkers));
+    ASSERT_EQ(images.size(), checkers.size());
+
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        bool found = detector->process(images[i], MCC24);
+        std::vector<Ptr<CChecker>> expected = detector->getListColorChecker();
+        ASSERT_EQ(found, !checkers[i].empty());
+        ASSERT_EQ(expected.size(), checkers[i].size());
+        for (size_t j = 0; j < expected.size(); j++)
+        {
+            EXPECT_EQ(expected[j]->getCost(), checkers[i][j]->getCost());
+            EXPECT_EQ(expected[j]->getBox(), checkers[i][j]->getBox());
+        }
+    }
+}
+
 } // namespace
 } // namespace opencv_test
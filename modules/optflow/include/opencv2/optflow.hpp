@@ -278,6 +278,13 @@ public:
     CV_WRAP virtual int getMedianFiltering() const = 0;
     /** @copybrief getMedianFiltering @see getMedianFiltering */
     CV_WRAP virtual void setMedianFiltering(int val) = 0;
+    //! @brief Video mode: the coarsest scale starts from the flow of the previous call, and when
+    //! the first frame equals the previous second frame its pyramid is reused. Ignored if the
+    //! initial flow is used.
+    /** @see setVideoMode */
+    CV_WRAP virtual bool getVideoMode() const = 0;
+    /** @copybrief getVideoMode @see getVideoMode */
+    CV_WRAP virtual void setVideoMode(bool val) = 0;
 
     /** @brief Creates instance of cv::DualTVL1OpticalFlow*/
     CV_WRAP static Ptr<DualTVL1OpticalFlow> create(
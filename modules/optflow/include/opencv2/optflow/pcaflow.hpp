@@ -90,6 +90,9 @@ public:
 };
 
 /** @brief PCAFlow algorithm.
+ *
+ * If the first image of a call is the second image of the previous call, as for consecutive video frames,
+ * the features tracked into it are reused and new corners are only detected in the regions without them.
  */
 class CV_EXPORTS_W OpticalFlowPCAFlow : public DenseOpticalFlow
 {
@@ -103,6 +106,11 @@ protected:
   const float claheClip;
   bool useOpenCL;
 
+  // second image of the previous call, before and after CLAHE, and the features tracked into it
+  Mat prevImage;
+  UMat prevEqualized;
+  std::vector<Point2f> prevFeatures;
+
 public:
   /** @brief Creates an instance of PCAFlow algorithm.
    * @param _prior Learned prior or no prior (default). @see cv::optflow::PCAPrior
@@ -121,8 +129,8 @@ public:
   void collectGarbage() CV_OVERRIDE;
 
 private:
-  void findSparseFeatures( UMat &from, UMat &to, std::vector<Point2f> &features,
-                           std::vector<Point2f> &predictedFeatures ) const;
+  void findSparseFeatures( UMat &from, UMat &to, const std::vector<Point2f> &trackedFeatures,
+                           std::vector<Point2f> &features, std::vector<Point2f> &predictedFeatures ) const;
 
   void removeOcclusions( UMat &from, UMat &to, std::vector<Point2f> &features,
                          std::vector<Point2f> &predictedFeatures ) const;
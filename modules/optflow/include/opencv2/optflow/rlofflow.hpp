@@ -433,6 +433,25 @@ public:
     */
     CV_WRAP virtual float getForwardBackward() const = 0;
 
+    /** @brief Calculates the sparse optical flow of several point sets between one pair of images.
+     *
+     * The point sets, e.g. of several trackers, are estimated together in a single parallel pass and
+     * share the image pyramids and support regions. For each set the result equals the one of calc().
+     * The pyramids are also kept between calls, calling calc() or calcBatch() with the next image of the
+     * previous call as the previous image reuses them.
+     *    @param prevImg first 8-bit input image, see calc().
+     *    @param nextImg second input image of the same size and the same type as prevImg.
+     *    @param prevPts vector of 2D point sets for which the flow needs to be found.
+     *    @param nextPts output vector of point sets with the calculated new positions of the input points.
+     *    If optflow::RLOFOpticalFlowParameter::useInitialFlow is set, it contains the initial estimations.
+     *    @param status optional output vector of status vectors, one per point set.
+     *    @param err optional output vector of error vectors, one per point set.
+    */
+    CV_WRAP virtual void calcBatch(InputArray prevImg, InputArray nextImg,
+                                   InputArrayOfArrays prevPts, InputOutputArrayOfArrays nextPts,
+                                   OutputArrayOfArrays status = noArray(),
+                                   OutputArrayOfArrays err = noArray()) = 0;
+
     //! @brief Creates instance of SparseRLOFOpticalFlow
     /**
      *    @param rlofParam see setRLOFOpticalFlowParameter
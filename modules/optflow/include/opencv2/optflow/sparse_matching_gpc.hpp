@@ -222,9 +222,15 @@ private:
 
     void operator()( const Range &range ) const CV_OVERRIDE
     {
-      for ( int t = range.start; t < range.end; ++t )
-        for ( size_t i = 0; i < descr->size(); ++i )
-          trails->at( i ).leaf[t] = forest->tree[t].findLeafForPatch( descr->at( i ) );
+      // Patches are passed through all trees in blocks, so the upper nodes of each tree stay in cache
+      const int blockSize = 256;
+      for ( int i0 = range.start; i0 < range.end; i0 += blockSize )
+      {
+        const int i1 = std::min( i0 + blockSize, range.end );
+        for ( int t = 0; t < T; ++t )
+          for ( int i = i0; i < i1; ++i )
+            trails->at( i ).leaf[t] = forest->tree[t].findLeafForPatch( descr->at( i ) );
+      }
     }
   };
 
@@ -332,18 +338,20 @@ void GPCForest< T >::findCorrespondences( InputArray imgFrom, InputArray imgTo,
 
   for ( size_t i = 0; i < descr.size(); ++i )
     GPCDetails::getCoordinatesFromIndex( i, from.size(), trailsFrom[i].coord.x, trailsFrom[i].coord.y );
-  parallel_for_( Range( 0, T ), ParallelTrailsFilling( this, &descr, &trailsFrom ) );
+  parallel_for_( Range( 0, (int)descr.size() ), ParallelTrailsFilling( this, &descr, &trailsFrom ) );
 
   descr.clear();
   GPCDetails::getAllDescriptorsForImage( toCh, descr, params, tree[0].getDescriptorType() );
 
   for ( size_t i = 0; i < descr.size(); ++i )
     GPCDetails::getCoordinatesFromIndex( i, to.size(), trailsTo[i].coord.x, trailsTo[i].coord.y );
-  parallel_for_( Range( 0, T ), ParallelTrailsFilling( this, &descr, &trailsTo ) );
+  parallel_for_( Range( 0, (int)descr.size() ), ParallelTrailsFilling( this, &descr, &trailsTo ) );
 
   std::sort( trailsFrom.begin(), trailsFrom.end() );
   std::sort( trailsTo.begin(), trailsTo.end() );
 
+  // Both trail lists are sorted, unique trails are matched with a single merge pass
+  size_t j = 0;
   for ( size_t i = 0; i < trailsFrom.size(); ++i )
   {
     bool uniq = true;
@@ -351,9 +359,10 @@ void GPCForest< T >::findCorrespondences( InputArray imgFrom, InputArray imgTo,
       ++i, uniq = false;
     if ( uniq )
     {
-      typename std::vector< Trail >::const_iterator lb = std::lower_bound( trailsTo.begin(), trailsTo.end(), trailsFrom[i] );
-      if ( lb != trailsTo.end() && *lb == trailsFrom[i] && ( ( lb + 1 ) == trailsTo.end() || !( *lb == *( lb + 1 ) ) ) )
-        corr.push_back( std::make_pair( trailsFrom[i].coord, lb->coord ) );
+      while ( j < trailsTo.size() && trailsTo[j] < trailsFrom[i] )
+        ++j;
+      if ( j < trailsTo.size() && trailsTo[j] == trailsFrom[i] && ( j + 1 == trailsTo.size() || !( trailsTo[j] == trailsTo[j + 1] ) ) )
+        corr.push_back( std::make_pair( trailsFrom[i].coord, trailsTo[j].coord ) );
     }
   }
 
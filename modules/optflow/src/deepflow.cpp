@@ -41,6 +41,8 @@
  //M*/
 
 #include "precomp.hpp"
+#include "opencl_kernels_optflow.hpp"
+#include "opencv2/core/opencl/ocl_defs.hpp"
 
 namespace cv
 {
@@ -70,7 +72,13 @@ protected:
     int interpolationType;
 
 private:
-    std::vector<Mat> buildPyramid( const Mat& src );
+    template <typename T>
+    std::vector<T> buildPyramid( const T& src );
+
+#ifdef HAVE_OPENCL
+    bool ocl_refine( const UMat& I0, const UMat& I1, UMat& u, UMat& v );
+    bool ocl_calc( InputArray I0, InputArray I1, InputOutputArray flow );
+#endif
 
 };
 
@@ -92,14 +100,15 @@ OpticalFlowDeepFlow::OpticalFlowDeepFlow()
     maxLayers = 200;
 }
 
-std::vector<Mat> OpticalFlowDeepFlow::buildPyramid( const Mat& src )
+template <typename T>
+std::vector<T> OpticalFlowDeepFlow::buildPyramid( const T& src )
 {
-    std::vector<Mat> pyramid;
+    std::vector<T> pyramid;
     pyramid.push_back(src);
-    Mat prev = pyramid[0];
+    T prev = pyramid[0];
     for( int i = 0; i < this->maxLayers; ++i)
     {
-        Mat next; //TODO: filtering at each level?
+        T next; //TODO: filtering at each level?
         Size nextSize((int) (prev.cols * downscaleFactor + 0.5f),
                         (int) (prev.rows * downscaleFactor + 0.5f));
         if( nextSize.height <= minSize || nextSize.width <= minSize)
@@ -113,14 +122,159 @@ std::vector<Mat> OpticalFlowDeepFlow::buildPyramid( const Mat& src )
     return pyramid;
 }
 
+#ifdef HAVE_OPENCL
+
+// Same energy as VariationalRefinement: color and gradient constancy with robust penalizers,
+// the increments of each level are found with red-black SOR after fixed point linearization.
+bool OpticalFlowDeepFlow::ocl_refine( const UMat& I0, const UMat& I1, UMat& u, UMat& v )
+{
+    const Size sz = I0.size();
+    const int rows = sz.height, cols = sz.width;
+    const float zeta2 = 0.1f * 0.1f, eps2 = 0.001f * 0.001f;
+    const float alpha2 = 4 * alpha / 2, delta2 = delta / 3 / 2, gamma2 = gamma / 3 / 2;
+
+    if (!I0.isContinuous() || !I1.isContinuous() || !u.isContinuous() || !v.isContinuous())
+        return false;
+
+    ocl::Kernel warpKernel("deepflowWarp", ocl::optflow::deepflow_oclsrc);
+    ocl::Kernel dataKernel("deepflowDataTerm", ocl::optflow::deepflow_oclsrc);
+    ocl::Kernel weightsKernel("deepflowSmoothnessWeights", ocl::optflow::deepflow_oclsrc);
+    ocl::Kernel smoothKernel("deepflowSmoothnessTerm", ocl::optflow::deepflow_oclsrc);
+    ocl::Kernel sorKernel("deepflowRedBlackSOR", ocl::optflow::deepflow_oclsrc);
+    if (warpKernel.empty() || dataKernel.empty() || weightsKernel.empty() ||
+        smoothKernel.empty() || sorKernel.empty())
+        return false;
+
+    // five point derivative kernels as in VariationalRefinement
+    Mat derivX = (Mat_<float>(1, 5) << 1.f / 12, -8.f / 12, 0.f, 8.f / 12, -1.f / 12);
+    Mat derivY = derivX.t();
+
+    UMat I0x, I0y, I1x, I1y;
+    filter2D(I0, I0x, CV_32F, derivX, Point(-1, -1), 0, BORDER_REPLICATE);
+    filter2D(I0, I0y, CV_32F, derivY, Point(-1, -1), 0, BORDER_REPLICATE);
+    filter2D(I1, I1x, CV_32F, derivX, Point(-1, -1), 0, BORDER_REPLICATE);
+    filter2D(I1, I1y, CV_32F, derivY, Point(-1, -1), 0, BORDER_REPLICATE);
+
+    UMat Ix(sz, CV_32F), Iy(sz, CV_32F), Iz(sz, CV_32F);
+    size_t globalsize[2] = { (size_t)cols, (size_t)rows };
+    warpKernel.args(ocl::KernelArg::PtrReadOnly(I0), ocl::KernelArg::PtrReadOnly(I1),
+                    ocl::KernelArg::PtrReadOnly(I0x), ocl::KernelArg::PtrReadOnly(I0y),
+                    ocl::KernelArg::PtrReadOnly(I1x), ocl::KernelArg::PtrReadOnly(I1y),
+                    ocl::KernelArg::PtrReadOnly(u), ocl::KernelArg::PtrReadOnly(v),
+                    ocl::KernelArg::PtrWriteOnly(Ix), ocl::KernelArg::PtrWriteOnly(Iy),
+                    ocl::KernelArg::PtrWriteOnly(Iz), rows, cols);
+    if (!warpKernel.run(2, globalsize, NULL, false))
+        return false;
+
+    UMat Ixx, Ixy, Iyy, Ixz, Iyz;
+    filter2D(Ix, Ixx, CV_32F, derivX, Point(-1, -1), 0, BORDER_REPLICATE);
+    filter2D(Ix, Ixy, CV_32F, derivY, Point(-1, -1), 0, BORDER_REPLICATE);
+    filter2D(Iy, Iyy, CV_32F, derivY, Point(-1, -1), 0, BORDER_REPLICATE);
+    filter2D(Iz, Ixz, CV_32F, derivX, Point(-1, -1), 0, BORDER_REPLICATE);
+    filter2D(Iz, Iyz, CV_32F, derivY, Point(-1, -1), 0, BORDER_REPLICATE);
+
+    UMat du = UMat::zeros(sz, CV_32F), dv = UMat::zeros(sz, CV_32F);
+    UMat A11(sz, CV_32F), A12(sz, CV_32F), A22(sz, CV_32F), b1(sz, CV_32F), b2(sz, CV_32F);
+    UMat w(sz, CV_32F);
+
+    size_t totalsize = (size_t)rows * cols;
+    dataKernel.args(ocl::KernelArg::PtrReadOnly(Ix), ocl::KernelArg::PtrReadOnly(Iy),
+                    ocl::KernelArg::PtrReadOnly(Iz), ocl::KernelArg::PtrReadOnly(Ixx),
+                    ocl::KernelArg::PtrReadOnly(Ixy), ocl::KernelArg::PtrReadOnly(Iyy),
+                    ocl::KernelArg::PtrReadOnly(Ixz), ocl::KernelArg::PtrReadOnly(Iyz),
+                    ocl::KernelArg::PtrReadOnly(du), ocl::KernelArg::PtrReadOnly(dv),
+                    ocl::KernelArg::PtrWriteOnly(A11), ocl::KernelArg::PtrWriteOnly(A12),
+                    ocl::KernelArg::PtrWriteOnly(A22), ocl::KernelArg::PtrWriteOnly(b1),
+                    ocl::KernelArg::PtrWriteOnly(b2), delta2, gamma2, zeta2, eps2, rows * cols);
+    weightsKernel.args(ocl::KernelArg::PtrReadOnly(u), ocl::KernelArg::PtrReadOnly(v),
+                       ocl::KernelArg::PtrReadOnly(du), ocl::KernelArg::PtrReadOnly(dv),
+                       ocl::KernelArg::PtrWriteOnly(w), alpha2, eps2, rows, cols);
+    smoothKernel.args(ocl::KernelArg::PtrReadOnly(u), ocl::KernelArg::PtrReadOnly(v),
+                      ocl::KernelArg::PtrReadOnly(w), ocl::KernelArg::PtrReadWrite(A11),
+                      ocl::KernelArg::PtrReadWrite(A22), ocl::KernelArg::PtrReadWrite(b1),
+                      ocl::KernelArg::PtrReadWrite(b2), rows, cols);
+
+    for (int i = 0; i < fixedPointIterations; i++)
+    {
+        if (!dataKernel.run(1, &totalsize, NULL, false) ||
+            !weightsKernel.run(2, globalsize, NULL, false) ||
+            !smoothKernel.run(2, globalsize, NULL, false))
+            return false;
+
+        for (int j = 0; j < sorIterations; j++)
+        {
+            for (int parity = 0; parity < 2; parity++)
+            {
+                sorKernel.args(ocl::KernelArg::PtrReadWrite(du), ocl::KernelArg::PtrReadWrite(dv),
+                               ocl::KernelArg::PtrReadOnly(w), ocl::KernelArg::PtrReadOnly(A11),
+                               ocl::KernelArg::PtrReadOnly(A12), ocl::KernelArg::PtrReadOnly(A22),
+                               ocl::KernelArg::PtrReadOnly(b1), ocl::KernelArg::PtrReadOnly(b2),
+                               omega, parity, rows, cols);
+                if (!sorKernel.run(2, globalsize, NULL, false))
+                    return false;
+            }
+        }
+    }
+
+    add(u, du, u);
+    add(v, dv, v);
+    return true;
+}
+
+bool OpticalFlowDeepFlow::ocl_calc( InputArray _I0, InputArray _I1, InputOutputArray _flow )
+{
+    UMat I0, I1;
+    _I0.getUMat().convertTo(I0, CV_32F);
+    _I1.getUMat().convertTo(I1, CV_32F);
+
+    // pre-smooth images
+    int kernelLen = ((int)floor(3 * sigma) * 2) + 1;
+    Size kernelSize(kernelLen, kernelLen);
+    GaussianBlur(I0, I0, kernelSize, sigma);
+    GaussianBlur(I1, I1, kernelSize, sigma);
+    // build down-sized pyramids
+    std::vector<UMat> pyramid_I0 = buildPyramid(I0);
+    std::vector<UMat> pyramid_I1 = buildPyramid(I1);
+    int levelCount = (int) pyramid_I0.size();
+
+    // initialize the first version of flow estimate to zeros
+    Size smallestSize = pyramid_I0[levelCount - 1].size();
+    UMat u = UMat::zeros(smallestSize, CV_32F), v = UMat::zeros(smallestSize, CV_32F);
+
+    for ( int level = levelCount - 1; level >= 0; --level )
+    { //iterate through  all levels, beginning with the most coarse
+        if (!ocl_refine(pyramid_I0[level], pyramid_I1[level], u, v))
+            return false;
+        if ( level > 0 ) //not the last level
+        {
+            UMat temp;
+            Size newSize = pyramid_I0[level - 1].size();
+            resize(u, temp, newSize, 0, 0, interpolationType); //resize calculated flow
+            temp.convertTo(u, CV_32F, 1.0f / downscaleFactor); //scale values
+            resize(v, temp, newSize, 0, 0, interpolationType);
+            temp.convertTo(v, CV_32F, 1.0f / downscaleFactor);
+        }
+    }
+
+    UMat uv[] = { u, v };
+    merge(uv, 2, _flow);
+    return true;
+}
+
+#endif
+
 void OpticalFlowDeepFlow::calc( InputArray _I0, InputArray _I1, InputOutputArray _flow )
 {
+    CV_Assert(_I0.size() == _I1.size());
+    CV_Assert(_I0.type() == _I1.type());
+    CV_Assert(_I0.channels() == 1);
+
+    CV_OCL_RUN(_flow.isUMat(),
+               ocl_calc(_I0, _I1, _flow))
+
     Mat I0temp = _I0.getMat();
     Mat I1temp = _I1.getMat();
 
-    CV_Assert(I0temp.size() == I1temp.size());
-    CV_Assert(I0temp.type() == I1temp.type());
-    CV_Assert(I0temp.channels() == 1);
     // TODO: currently only grayscale - data term could be computed in color version as well...
 
     Mat I0, I1;
@@ -145,17 +299,17 @@ void OpticalFlowDeepFlow::calc( InputArray _I0, InputArray _I1, InputOutputArray
     Size smallestSize = pyramid_I0[levelCount - 1].size();
     W = Mat::zeros(smallestSize, CV_32FC2);
 
+    // the refinement is parallel over red and black pixel sets, one instance serves all levels
+    Ptr<VariationalRefinement> var = VariationalRefinement::create();
+    var->setAlpha(4 * alpha);
+    var->setDelta(delta / 3);
+    var->setGamma(gamma / 3);
+    var->setFixedPointIterations(fixedPointIterations);
+    var->setSorIterations(sorIterations);
+    var->setOmega(omega);
+
     for ( int level = levelCount - 1; level >= 0; --level )
     { //iterate through  all levels, beginning with the most coarse
-        Ptr<VariationalRefinement> var = VariationalRefinement::create();
-
-        var->setAlpha(4 * alpha);
-        var->setDelta(delta / 3);
-        var->setGamma(gamma / 3);
-        var->setFixedPointIterations(fixedPointIterations);
-        var->setSorIterations(sorIterations);
-        var->setOmega(omega);
-
         var->calc(pyramid_I0[level], pyramid_I1[level], W);
         if ( level > 0 ) //not the last level
         {
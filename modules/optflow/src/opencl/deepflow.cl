@@ -0,0 +1,197 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+// Variational refinement of DeepFlow. All buffers are continuous single channel float
+// images of rows x cols elements, flow increments are solved with red-black SOR.
+
+inline float bilinear(__global const float* src, int i00, int i01, int i10, int i11,
+                      float w00, float w01, float w10, float w11)
+{
+    return src[i00] * w00 + src[i01] * w01 + src[i10] * w10 + src[i11] * w11;
+}
+
+// samples I1 and its derivatives at x + (u, v) with replicated border
+__kernel void deepflowWarp(__global const float* I0, __global const float* I1,
+                           __global const float* I0x, __global const float* I0y,
+                           __global const float* I1x, __global const float* I1y,
+                           __global const float* u, __global const float* v,
+                           __global float* Ix, __global float* Iy, __global float* Iz,
+                           int rows, int cols)
+{
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+
+    if (x >= cols || y >= rows)
+        return;
+
+    int i = mad24(y, cols, x);
+    float fx = clamp(x + u[i], -1.f, (float)cols);
+    float fy = clamp(y + v[i], -1.f, (float)rows);
+    float x0f = floor(fx), y0f = floor(fy);
+    float ax = fx - x0f, ay = fy - y0f;
+
+    int x0 = (int)x0f, y0 = (int)y0f;
+    int xa = clamp(x0, 0, cols - 1), xb = clamp(x0 + 1, 0, cols - 1);
+    int ya = clamp(y0, 0, rows - 1) * cols, yb = clamp(y0 + 1, 0, rows - 1) * cols;
+
+    float w00 = (1.f - ax) * (1.f - ay), w01 = ax * (1.f - ay);
+    float w10 = (1.f - ax) * ay, w11 = ax * ay;
+
+    float I1w  = bilinear(I1,  ya + xa, ya + xb, yb + xa, yb + xb, w00, w01, w10, w11);
+    float I1wx = bilinear(I1x, ya + xa, ya + xb, yb + xa, yb + xb, w00, w01, w10, w11);
+    float I1wy = bilinear(I1y, ya + xa, ya + xb, yb + xa, yb + xb, w00, w01, w10, w11);
+
+    Ix[i] = 0.5f * (I1wx + I0x[i]);
+    Iy[i] = 0.5f * (I1wy + I0y[i]);
+    Iz[i] = I1w - I0[i];
+}
+
+// color and gradient constancy terms of the linear system, linearized around the current increments
+__kernel void deepflowDataTerm(__global const float* Ix, __global const float* Iy, __global const float* Iz,
+                               __global const float* Ixx, __global const float* Ixy, __global const float* Iyy,
+                               __global const float* Ixz, __global const float* Iyz,
+                               __global const float* du, __global const float* dv,
+                               __global float* A11, __global float* A12, __global float* A22,
+                               __global float* b1, __global float* b2,
+                               float delta2, float gamma2, float zeta2, float eps2, int total)
+{
+    int i = get_global_id(0);
+
+    if (i >= total)
+        return;
+
+    float ix = Ix[i], iy = Iy[i], iz = Iz[i];
+    float dui = du[i], dvi = dv[i];
+
+    float derivNorm = ix * ix + iy * iy + zeta2;
+    float Ik1z = iz + ix * dui + iy * dvi;
+    float weight = (delta2 / sqrt(Ik1z * Ik1z / derivNorm + eps2)) / derivNorm;
+
+    float a11 = weight * (ix * ix) + zeta2;
+    float a12 = weight * (ix * iy);
+    float a22 = weight * (iy * iy) + zeta2;
+    float c1 = -weight * (iz * ix);
+    float c2 = -weight * (iz * iy);
+
+    float ixx = Ixx[i], ixy = Ixy[i], iyy = Iyy[i], ixz = Ixz[i], iyz = Iyz[i];
+
+    derivNorm = ixx * ixx + ixy * ixy + zeta2;
+    float derivNorm2 = iyy * iyy + ixy * ixy + zeta2;
+    float Ik1zx = ixz + ixx * dui + ixy * dvi;
+    float Ik1zy = iyz + ixy * dui + iyy * dvi;
+    weight = gamma2 / sqrt(Ik1zx * Ik1zx / derivNorm + Ik1zy * Ik1zy / derivNorm2 + eps2);
+
+    A11[i] = a11 + weight * (ixx * ixx / derivNorm + ixy * ixy / derivNorm2);
+    A12[i] = a12 + weight * (ixx * ixy / derivNorm + ixy * iyy / derivNorm2);
+    A22[i] = a22 + weight * (ixy * ixy / derivNorm + iyy * iyy / derivNorm2);
+    b1[i] = c1 - weight * (ixx * ixz / derivNorm + ixy * iyz / derivNorm2);
+    b2[i] = c2 - weight * (ixy * ixz / derivNorm + iyy * iyz / derivNorm2);
+}
+
+// robust smoothness weight of the edges to the right and bottom neighbours
+__kernel void deepflowSmoothnessWeights(__global const float* u, __global const float* v,
+                                        __global const float* du, __global const float* dv,
+                                        __global float* w, float alpha2, float eps2, int rows, int cols)
+{
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+
+    if (x >= cols || y >= rows)
+        return;
+
+    int i = mad24(y, cols, x);
+    int ir = x < cols - 1 ? i + 1 : i;
+    int id = y < rows - 1 ? i + cols : i;
+
+    float uc = u[i] + du[i], vc = v[i] + dv[i];
+    float ux = u[ir] + du[ir] - uc, vx = v[ir] + dv[ir] - vc;
+    float uy = u[id] + du[id] - uc, vy = v[id] + dv[id] - vc;
+
+    w[i] = alpha2 / sqrt(ux * ux + uy * uy + vx * vx + vy * vy + eps2);
+}
+
+// adds the smoothness term of the current flow to the linear system
+__kernel void deepflowSmoothnessTerm(__global const float* u, __global const float* v, __global const float* w,
+                                     __global float* A11, __global float* A22,
+                                     __global float* b1, __global float* b2, int rows, int cols)
+{
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+
+    if (x >= cols || y >= rows)
+        return;
+
+    int i = mad24(y, cols, x);
+    float uc = u[i], vc = v[i];
+    float sumW = 0.f, divU = 0.f, divV = 0.f;
+
+    if (x > 0)
+    {
+        float wq = w[i - 1];
+        sumW += wq; divU += wq * (u[i - 1] - uc); divV += wq * (v[i - 1] - vc);
+    }
+    if (x < cols - 1)
+    {
+        float wq = w[i];
+        sumW += wq; divU += wq * (u[i + 1] - uc); divV += wq * (v[i + 1] - vc);
+    }
+    if (y > 0)
+    {
+        float wq = w[i - cols];
+        sumW += wq; divU += wq * (u[i - cols] - uc); divV += wq * (v[i - cols] - vc);
+    }
+    if (y < rows - 1)
+    {
+        float wq = w[i];
+        sumW += wq; divU += wq * (u[i + cols] - uc); divV += wq * (v[i + cols] - vc);
+    }
+
+    A11[i] += sumW;
+    A22[i] += sumW;
+    b1[i] += divU;
+    b2[i] += divV;
+}
+
+// one half of a SOR iteration, the pixels with (x + y) % 2 == parity are updated
+__kernel void deepflowRedBlackSOR(__global float* du, __global float* dv, __global const float* w,
+                                  __global const float* A11, __global const float* A12, __global const float* A22,
+                                  __global const float* b1, __global const float* b2,
+                                  float omega, int parity, int rows, int cols)
+{
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+
+    if (x >= cols || y >= rows || ((x + y) & 1) != parity)
+        return;
+
+    int i = mad24(y, cols, x);
+    float sigmaU = 0.f, sigmaV = 0.f;
+
+    if (x > 0)
+    {
+        float wq = w[i - 1];
+        sigmaU += wq * du[i - 1]; sigmaV += wq * dv[i - 1];
+    }
+    if (x < cols - 1)
+    {
+        float wq = w[i];
+        sigmaU += wq * du[i + 1]; sigmaV += wq * dv[i + 1];
+    }
+    if (y > 0)
+    {
+        float wq = w[i - cols];
+        sigmaU += wq * du[i - cols]; sigmaV += wq * dv[i - cols];
+    }
+    if (y < rows - 1)
+    {
+        float wq = w[i];
+        sigmaU += wq * du[i + cols]; sigmaV += wq * dv[i + cols];
+    }
+
+    float a12 = A12[i];
+    float dui = du[i];
+    dui += omega * ((sigmaU + b1[i] - dv[i] * a12) / A11[i] - dui);
+    du[i] = dui;
+    dv[i] += omega * ((sigmaV + b2[i] - dui * a12) / A22[i] - dv[i]);
+}
@@ -119,7 +119,7 @@ inline void symOrtho( double a, double b, double &c, double &s, double &r )
  * Output:
  *   x -- approximate solution
  */
-void solveLSQR( const Mat &A, const Mat &b, OutputArray xOut, const double damp = 0.0, const unsigned iter_lim = 10 )
+void solveLSQR( const Mat &A, const Mat &AT, const Mat &b, OutputArray xOut, const double damp = 0.0, const unsigned iter_lim = 10 )
 {
   const int n = A.size().width;
   CV_Assert( A.size().height == b.size().height );
@@ -134,7 +134,6 @@ void solveLSQR( const Mat &A, const Mat &b, OutputArray xOut, const double damp
   double alfa = 0;
   double beta = cv::norm( u, NORM_L2 );
   Mat w( n, 1, CV_32F, 0.0f );
-  const Mat AT = A.t();
 
   if ( beta > 0 )
   {
@@ -191,14 +190,83 @@ void solveLSQR( const Mat &A, const Mat &b, OutputArray xOut, const double damp
   }
 }
 
+/* Solves the least squares problems for both flow components in parallel.
+ */
+class ParallelLSQR : public ParallelLoopBody
+{
+private:
+  const Mat *A[2];
+  const Mat *AT[2];
+  const Mat *b[2];
+  Mat *x[2];
+  const double damp;
+
+  ParallelLSQR &operator=( const ParallelLSQR & );
+
+public:
+  ParallelLSQR( const Mat &A1, const Mat &AT1, const Mat &b1, Mat &x1, const Mat &A2, const Mat &AT2, const Mat &b2, Mat &x2,
+                double _damp )
+      : damp( _damp )
+  {
+    A[0] = &A1, AT[0] = &AT1, b[0] = &b1, x[0] = &x1;
+    A[1] = &A2, AT[1] = &AT2, b[1] = &b2, x[1] = &x2;
+  }
+
+  void operator()( const Range &range ) const CV_OVERRIDE
+  {
+    for ( int i = range.start; i < range.end; ++i )
+      solveLSQR( *A[i], *AT[i], *b[i], *x[i], damp );
+  }
+};
+
+/* The basis functions are separable, the cosines are evaluated once per axis.
+ */
 inline void _cpu_fillDCTSampledPoints( float *row, const Point2f &p, const Size &basisSize, const Size &size )
 {
+  AutoBuffer<float> cosY( basisSize.height );
+  for ( int n2 = 0; n2 < basisSize.height; ++n2 )
+    cosY[n2] = cosf( ( n2 * CV_PI / size.height ) * ( p.y + 0.5 ) );
+
   for ( int n1 = 0; n1 < basisSize.width; ++n1 )
+  {
+    const float cosX = cosf( ( n1 * CV_PI / size.width ) * ( p.x + 0.5 ) );
     for ( int n2 = 0; n2 < basisSize.height; ++n2 )
-      row[n1 * basisSize.height + n2] =
-        cosf( ( n1 * CV_PI / size.width ) * ( p.x + 0.5 ) ) * cosf( ( n2 * CV_PI / size.height ) * ( p.y + 0.5 ) );
+      row[n1 * basisSize.height + n2] = cosX * cosY[n2];
+  }
 }
 
+class ParallelDCTSampledPointsFiller : public ParallelLoopBody
+{
+private:
+  const std::vector<Point2f> &features;
+  const std::vector<Point2f> &predictedFeatures;
+  const Size basisSize;
+  const Size size;
+  Mat &A;
+  Mat &b1;
+  Mat &b2;
+
+  ParallelDCTSampledPointsFiller &operator=( const ParallelDCTSampledPointsFiller & );
+
+public:
+  ParallelDCTSampledPointsFiller( const std::vector<Point2f> &_features, const std::vector<Point2f> &_predictedFeatures,
+                                  const Size &_basisSize, const Size &_size, Mat &_A, Mat &_b1, Mat &_b2 )
+      : features( _features ), predictedFeatures( _predictedFeatures ), basisSize( _basisSize ), size( _size ), A( _A ),
+        b1( _b1 ), b2( _b2 ){};
+
+  void operator()( const Range &range ) const CV_OVERRIDE
+  {
+    for ( int i = range.start; i < range.end; ++i )
+    {
+      if ( !A.empty() )
+        _cpu_fillDCTSampledPoints( A.ptr<float>( i ), features[i], basisSize, size );
+      const Point2f flow = predictedFeatures[i] - features[i];
+      b1.at<float>( i ) = flow.x;
+      b2.at<float>( i ) = flow.y;
+    }
+  }
+};
+
 ocl::ProgramSource _ocl_fillDCTSampledPointsSource(
   "__kernel void fillDCTSampledPoints(__global const uchar* features, int fstep, int foff, __global "
   "uchar* A, int Astep, int Aoff, int fs, int bsw, int bsh, int sw, int sh) {"
@@ -253,12 +321,33 @@ void reduceToFlow( const Mat &w1, const Mat &w2, Mat &flow, const Size &basisSiz
 }
 }
 
-void OpticalFlowPCAFlow::findSparseFeatures( UMat &from, UMat &to, std::vector<Point2f> &features,
-                                             std::vector<Point2f> &predictedFeatures ) const
+void OpticalFlowPCAFlow::findSparseFeatures( UMat &from, UMat &to, const std::vector<Point2f> &trackedFeatures,
+                                             std::vector<Point2f> &features, std::vector<Point2f> &predictedFeatures ) const
 {
   Size size = from.size();
   const unsigned maxFeatures = size.area() * sparseRate;
-  goodFeaturesToTrack( from, features, maxFeatures * retainedCornersFraction, 0.005, 3 );
+  const unsigned maxCorners = maxFeatures * retainedCornersFraction;
+
+  // Features tracked into the first image by the previous call are kept,
+  // new corners are detected only away from them
+  features.clear();
+  for ( size_t i = 0; i < trackedFeatures.size() && features.size() < maxCorners; ++i )
+    if ( Rect( 0, 0, size.width, size.height ).contains( trackedFeatures[i] ) )
+      features.push_back( trackedFeatures[i] );
+
+  if ( features.empty() )
+    goodFeaturesToTrack( from, features, maxCorners, 0.005, 3 );
+  else if ( features.size() < maxCorners )
+  {
+    const int radius = std::max( 3, cvRound( 0.5 * sqrt( (float)size.area() / maxFeatures ) ) );
+    Mat mask( size, CV_8U, Scalar( 255 ) );
+    for ( size_t i = 0; i < features.size(); ++i )
+      circle( mask, features[i], radius, Scalar( 0 ), FILLED );
+
+    std::vector<Point2f> corners;
+    goodFeaturesToTrack( from, corners, (int)( maxCorners - features.size() ), 0.005, 3, mask );
+    features.insert( features.end(), corners.begin(), corners.end() );
+  }
 
   // Add points along the grid if not enough features
   if ( maxFeatures > features.size() )
@@ -336,12 +425,8 @@ void OpticalFlowPCAFlow::getSystem( OutputArray AOut, OutputArray b1Out, OutputA
              (int)basisSize.height, (int)size.width, (int)size.height )
       .run( 3, globSize, 0, true );
 
-    for ( size_t i = 0; i < features.size(); ++i )
-    {
-      const Point2f flow = predictedFeatures[i] - features[i];
-      b1.at<float>( i ) = flow.x;
-      b2.at<float>( i ) = flow.y;
-    }
+    Mat noA;
+    parallel_for_( Range( 0, features.size() ), ParallelDCTSampledPointsFiller( features, predictedFeatures, basisSize, size, noA, b1, b2 ) );
   }
   else
   {
@@ -349,13 +434,7 @@ void OpticalFlowPCAFlow::getSystem( OutputArray AOut, OutputArray b1Out, OutputA
     Mat b1 = b1Out.getMat();
     Mat b2 = b2Out.getMat();
 
-    for ( size_t i = 0; i < features.size(); ++i )
-    {
-      _cpu_fillDCTSampledPoints( A.ptr<float>( i ), features[i], basisSize, size );
-      const Point2f flow = predictedFeatures[i] - features[i];
-      b1.at<float>( i ) = flow.x;
-      b2.at<float>( i ) = flow.y;
-    }
+    parallel_for_( Range( 0, features.size() ), ParallelDCTSampledPointsFiller( features, predictedFeatures, basisSize, size, A, b1, b2 ) );
   }
 }
 
@@ -385,12 +464,8 @@ void OpticalFlowPCAFlow::getSystem( OutputArray A1Out, OutputArray A2Out, Output
              (int)basisSize.height, (int)size.width, (int)size.height )
       .run( 3, globSize, 0, true );
 
-    for ( size_t i = 0; i < features.size(); ++i )
-    {
-      const Point2f flow = predictedFeatures[i] - features[i];
-      b1.at<float>( i ) = flow.x;
-      b2.at<float>( i ) = flow.y;
-    }
+    Mat noA;
+    parallel_for_( Range( 0, features.size() ), ParallelDCTSampledPointsFiller( features, predictedFeatures, basisSize, size, noA, b1, b2 ) );
   }
   else
   {
@@ -398,13 +473,7 @@ void OpticalFlowPCAFlow::getSystem( OutputArray A1Out, OutputArray A2Out, Output
     Mat b1 = b1Out.getMat();
     Mat b2 = b2Out.getMat();
 
-    for ( size_t i = 0; i < features.size(); ++i )
-    {
-      _cpu_fillDCTSampledPoints( A1.ptr<float>( i ), features[i], basisSize, size );
-      const Point2f flow = predictedFeatures[i] - features[i];
-      b1.at<float>( i ) = flow.x;
-      b2.at<float>( i ) = flow.y;
-    }
+    parallel_for_( Range( 0, features.size() ), ParallelDCTSampledPointsFiller( features, predictedFeatures, basisSize, size, A1, b1, b2 ) );
   }
 
   Mat A1 = A1Out.getMat();
@@ -448,13 +517,27 @@ void OpticalFlowPCAFlow::calc( InputArray I0, InputArray I1, InputOutputArray fl
   const Mat fromOrig = from.getMat( ACCESS_READ ).clone();
   useOpenCL = flowOut.isUMat() && ocl::useOpenCL();
 
-  applyCLAHE( from, claheClip );
+  const Mat toOrig = to.getMat( ACCESS_READ ).clone();
+
+  // the first image continues the previous call, its equalized version and tracked features are reused
+  const bool continued = prevImage.size() == size && cv::norm( fromOrig, prevImage, NORM_INF ) == 0;
+  if ( continued )
+    from = prevEqualized;
+  else
+  {
+    applyCLAHE( from, claheClip );
+    prevFeatures.clear();
+  }
   applyCLAHE( to, claheClip );
 
   std::vector<Point2f> features, predictedFeatures;
-  findSparseFeatures( from, to, features, predictedFeatures );
+  findSparseFeatures( from, to, prevFeatures, features, predictedFeatures );
   removeOcclusions( from, to, features, predictedFeatures );
 
+  prevImage = toOrig;
+  prevEqualized = to;
+  prevFeatures = predictedFeatures;
+
   flowOut.create( size, CV_32FC2 );
   Mat flow = flowOut.getMat();
 
@@ -463,15 +546,15 @@ void OpticalFlowPCAFlow::calc( InputArray I0, InputArray I1, InputOutputArray fl
   {
     Mat A1, A2, b1, b2;
     getSystem( A1, A2, b1, b2, features, predictedFeatures, size );
-    solveLSQR( A1, b1, w1, dampingFactor * size.area() );
-    solveLSQR( A2, b2, w2, dampingFactor * size.area() );
+    const Mat AT1 = A1.t(), AT2 = A2.t();
+    parallel_for_( Range( 0, 2 ), ParallelLSQR( A1, AT1, b1, w1, A2, AT2, b2, w2, dampingFactor * size.area() ) );
   }
   else
   {
     Mat A, b1, b2;
     getSystem( A, b1, b2, features, predictedFeatures, size );
-    solveLSQR( A, b1, w1, dampingFactor * size.area() );
-    solveLSQR( A, b2, w2, dampingFactor * size.area() );
+    const Mat AT = A.t();
+    parallel_for_( Range( 0, 2 ), ParallelLSQR( A, AT, b1, w1, A, AT, b2, w2, dampingFactor * size.area() ) );
   }
   Mat flowSmall( ( size / 8 ) * 2, CV_32FC2 );
   reduceToFlow( w1, w2, flowSmall, basisSize );
@@ -491,7 +574,12 @@ OpticalFlowPCAFlow::OpticalFlowPCAFlow( Ptr<const PCAPrior> _prior, const Size _
   CV_Assert( occlusionsThreshold > 0 );
 }
 
-void OpticalFlowPCAFlow::collectGarbage() {}
+void OpticalFlowPCAFlow::collectGarbage()
+{
+  prevImage.release();
+  prevEqualized.release();
+  prevFeatures.clear();
+}
 
 Ptr<DenseOpticalFlow> createOptFlow_PCAFlow() { return makePtr<OpticalFlowPCAFlow>(); }
 
@@ -217,7 +217,7 @@ void preCalcCrossSegmentation(
     int hWinSize = (winSize - 1) / 2;
     cv::Mat data = img;
     data.adjustROI(hWinSize, hWinSize, hWinSize, hWinSize);
-    if( dst.size() != dst.size() || dst.type() != CV_32SC4)
+    if( dst.size() != data.size() || dst.type() != CV_32SC4)
     {
         dst.release();
         dst.create(data.size(), CV_32SC4);
@@ -358,13 +358,36 @@ int CImageBuffer::buildPyramid(cv::Size winSize, int maxLevel, float levelScale[
 {
     if (! m_Overwrite)
         return m_maxLevel;
+    if (m_PyramidValid && m_PyramidWinSize == winSize && m_PyramidMaxLevel == maxLevel && m_PyramidBlurred == withBlurredImage)
+        return m_maxLevel;
     if (withBlurredImage)
         m_maxLevel = buildOpticalFlowPyramidScale(m_BlurredImage, m_ImagePyramid, winSize, maxLevel, false, 4, 0, true, levelScale);
     else
         m_maxLevel = buildOpticalFlowPyramidScale(m_Image, m_ImagePyramid, winSize, maxLevel, false, 4, 0, true, levelScale);
+    m_PyramidValid = true;
+    m_PyramidWinSize = winSize;
+    m_PyramidMaxLevel = maxLevel;
+    m_PyramidBlurred = withBlurredImage;
+    m_CrossValid = false;
     return m_maxLevel;
 }
 
+bool CImageBuffer::hasCrossPyramid(const cv::Point2f * pts, int npoints, int winSize, int threshold) const
+{
+    return m_CrossValid && m_CrossWinSize == winSize && m_CrossThreshold == threshold
+        && static_cast<int>(m_CrossPyramid.size()) == m_maxLevel + 1
+        && m_CrossPoints.size() == static_cast<size_t>(npoints)
+        && std::equal(m_CrossPoints.begin(), m_CrossPoints.end(), pts);
+}
+
+void CImageBuffer::setCrossKey(const cv::Point2f * pts, int npoints, int winSize, int threshold)
+{
+    m_CrossPoints.assign(pts, pts + npoints);
+    m_CrossWinSize = winSize;
+    m_CrossThreshold = threshold;
+    m_CrossValid = true;
+}
+
 static
 void calcLocalOpticalFlowCore(
     Ptr<CImageBuffer>  prevPyramids[2],
@@ -428,6 +451,11 @@ void calcLocalOpticalFlowCore(
         criteria.epsilon = std::min(std::max(criteria.epsilon, 0.), 10.);
     criteria.epsilon *= criteria.epsilon;
 
+    // the support regions depend on the points only, they are reused if the same points are tracked again
+    bool reuseCross = usePreComputedCross && prevPyramids[1]->hasCrossPyramid(prevPts, npoints, winSizes[1], param.crossSegmentationThreshold);
+    if (usePreComputedCross && !reuseCross)
+        prevPyramids[1]->m_CrossPyramid.resize(maxLevel + 1);
+
     // dI/dx ~ Ix, dI/dy ~ Iy
     Mat derivIBuf;
     derivIBuf.create(prevPyramids[0]->m_ImagePyramid[0].rows + iWinSize * 2, prevPyramids[0]->m_ImagePyramid[0].cols + iWinSize * 2, CV_MAKETYPE(derivDepth, prevPyramids[0]->m_ImagePyramid[0].channels() * 2));
@@ -455,10 +483,11 @@ void calcLocalOpticalFlowCore(
         cv::Mat prevImage = prevPyramids[0]->getImage(level);
         cv::Mat currImage = currPyramids[0]->getImage(level);
 
-        cv::Mat preCrossMap;
         if( usePreComputedCross )
         {
-            preCalcCrossSegmentation(prevPts, npoints, (float)(1./(1 << level)), tRGBPrevPyr, winSizes[1], preCrossMap, param.crossSegmentationThreshold);
+            cv::Mat & preCrossMap = prevPyramids[1]->m_CrossPyramid[level];
+            if (!reuseCross)
+                preCalcCrossSegmentation(prevPts, npoints, (float)(1./(1 << level)), tRGBPrevPyr, winSizes[1], preCrossMap, param.crossSegmentationThreshold);
             tRGBNextPyr = cv::Mat();
             tRGBPrevPyr = preCrossMap;
         }
@@ -596,6 +625,8 @@ void calcLocalOpticalFlowCore(
         prevPyramids[0]->m_Overwrite = true;
         currPyramids[0]->m_Overwrite = true;
     }
+    if (usePreComputedCross && !reuseCross)
+        prevPyramids[1]->setCrossKey(prevPts, npoints, winSizes[1], param.crossSegmentationThreshold);
 }
 
 static
@@ -677,6 +708,13 @@ void calcLocalOpticalFlow(
 {
     if (prevImage.empty() == false && currImage.empty()== false)
     {
+        // on a frame sequence the previous image is the current image of the last call,
+        // its buffers are swapped in so that the pyramids are not built again
+        if (!prevPyramids[0]->hasSource(prevImage) && currPyramids[0]->hasSource(prevImage))
+        {
+            std::swap(*prevPyramids[0], *currPyramids[0]);
+            std::swap(*prevPyramids[1], *currPyramids[1]);
+        }
         prevPyramids[0]->m_Overwrite = true;
         currPyramids[0]->m_Overwrite = true;
         prevPyramids[1]->m_Overwrite = true;
@@ -75,33 +75,81 @@ class CImageBuffer
 {
 public:
     CImageBuffer()
-        : m_Overwrite(true)
+        : m_maxLevel(0)
+        , m_Overwrite(true)
+        , m_BlurValid(false)
+        , m_PyramidValid(false)
+        , m_PyramidBlurred(false)
+        , m_PyramidMaxLevel(-1)
+        , m_CrossValid(false)
+        , m_CrossWinSize(0)
+        , m_CrossThreshold(0)
     {}
+    //! true if the buffer has been filled from an image with the same content
+    bool hasSource(const cv::Mat & inp) const
+    {
+        return !m_Source.empty() && m_Source.size() == inp.size() && m_Source.type() == inp.type()
+            && cv::norm(m_Source, inp, cv::NORM_INF) == 0;
+    }
     void setGrayFromRGB(const cv::Mat & inp)
     {
-        if(m_Overwrite)
+        if(m_Overwrite && updateSource(inp))
             cv::cvtColor(inp, m_Image, cv::COLOR_BGR2GRAY);
     }
     void setImage(const cv::Mat & inp)
     {
-        if(m_Overwrite)
-            inp.copyTo(m_Image);
+        if(m_Overwrite && updateSource(inp))
+            m_Image = m_Source;
     }
     void setBlurFromRGB(const cv::Mat & inp)
     {
-        if(m_Overwrite)
+        if(m_Overwrite && !(m_BlurValid && hasSource(inp)))
+        {
             cv::GaussianBlur(inp, m_BlurredImage, cv::Size(7,7), -1);
+            m_BlurValid = true;
+            m_PyramidValid = false;
+        }
     }
 
     int buildPyramid(cv::Size winSize, int maxLevel, float levelScale[2], bool withBlurredImage = false);
     cv::Mat & getImage(int level) {return m_ImagePyramid[level];}
 
+    //! true if m_CrossPyramid holds the support regions of the given points
+    bool hasCrossPyramid(const cv::Point2f * pts, int npoints, int winSize, int threshold) const;
+    void setCrossKey(const cv::Point2f * pts, int npoints, int winSize, int threshold);
+
     std::vector<cv::Mat>     m_ImagePyramid;
     cv::Mat                  m_BlurredImage;
     cv::Mat                  m_Image;
     std::vector<cv::Mat>     m_CrossPyramid;
     int                      m_maxLevel;
     bool                     m_Overwrite;
+
+private:
+    //! keeps a copy of the input, the derived images and pyramids are invalidated if it changes
+    bool updateSource(const cv::Mat & inp)
+    {
+        if (hasSource(inp))
+            return false;
+        inp.copyTo(m_Source);
+        m_BlurValid = false;
+        m_PyramidValid = false;
+        m_CrossValid = false;
+        return true;
+    }
+
+    cv::Mat                  m_Source;
+    bool                     m_BlurValid;
+    // parameters the pyramid has been built with
+    bool                     m_PyramidValid;
+    bool                     m_PyramidBlurred;
+    int                      m_PyramidMaxLevel;
+    cv::Size                 m_PyramidWinSize;
+    // points and parameters the support regions have been computed for
+    bool                     m_CrossValid;
+    int                      m_CrossWinSize;
+    int                      m_CrossThreshold;
+    std::vector<cv::Point2f> m_CrossPoints;
 };
 
 void calcLocalOpticalFlow(
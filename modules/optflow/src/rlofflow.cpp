@@ -405,7 +405,7 @@ class SparseRLOFOpticalFlowImpl : public SparseRLOFOpticalFlow
         }
 
         calcLocalOpticalFlow(prevImage, nextImage, prevPyramid, currPyramid, prevPoints, nextPoints, *(param.get()));
-        cv::Mat(1,npoints , CV_32FC2, &nextPoints[0]).copyTo(nextPtsMat);
+        cv::Mat(1,npoints , CV_32FC2, &nextPoints[0]).reshape(2, nextPtsMat.rows).copyTo(nextPtsMat);
         if (forwardBackwardThreshold > 0)
         {
             // reuse image pyramids
@@ -421,7 +421,71 @@ class SparseRLOFOpticalFlowImpl : public SparseRLOFOpticalFlow
 
     }
 
+    virtual void calcBatch(InputArray prevImg, InputArray nextImg,
+        InputArrayOfArrays prevPts, InputOutputArrayOfArrays nextPts,
+        OutputArrayOfArrays status,
+        OutputArrayOfArrays err) CV_OVERRIDE
+    {
+        if (param.empty())
+        {
+            param = makePtr<RLOFOpticalFlowParameter>();
+        }
+        int nsets = static_cast<int>(prevPts.total());
+        std::vector<int> offsets(nsets + 1, 0);
+        for (int i = 0; i < nsets; i++)
+        {
+            int npoints = prevPts.getMat(i).checkVector(2, CV_32F, true);
+            CV_Assert(npoints >= 0);
+            offsets[i + 1] = offsets[i] + npoints;
+        }
+        if (param->useInitialFlow)
+            CV_Assert(static_cast<int>(nextPts.total()) == nsets);
+
+        // all point sets are tracked as one
+        Mat allPrevPts(offsets[nsets], 1, CV_32FC2), allNextPts, allStatus, allErr;
+        if (param->useInitialFlow)
+            allNextPts.create(offsets[nsets], 1, CV_32FC2);
+        for (int i = 0; i < nsets; i++)
+        {
+            int npoints = offsets[i + 1] - offsets[i];
+            if (npoints == 0)
+                continue;
+            prevPts.getMat(i).reshape(2, npoints).copyTo(allPrevPts.rowRange(offsets[i], offsets[i + 1]));
+            if (param->useInitialFlow)
+            {
+                Mat initPts = nextPts.getMat(i);
+                CV_Assert(initPts.checkVector(2, CV_32F, true) == npoints);
+                initPts.reshape(2, npoints).copyTo(allNextPts.rowRange(offsets[i], offsets[i + 1]));
+            }
+        }
+
+        calc(prevImg, nextImg, allPrevPts, allNextPts, allStatus, allErr);
+
+        splitPointSets(allNextPts, offsets, CV_32FC2, nextPts);
+        if (status.needed())
+            splitPointSets(allStatus, offsets, CV_8U, status);
+        if (err.needed())
+            splitPointSets(allErr, offsets, CV_32F, err);
+    }
+
 protected:
+    //! copies the rows of src into one array per point set
+    static void splitPointSets(const Mat & src, const std::vector<int> & offsets, int type, OutputArrayOfArrays dst)
+    {
+        int nsets = static_cast<int>(offsets.size()) - 1;
+        dst.create(nsets, 1, type);
+        for (int i = 0; i < nsets; i++)
+        {
+            int npoints = offsets[i + 1] - offsets[i];
+            dst.create(npoints, 1, type, i, true);
+            if (npoints == 0)
+                continue;
+            Mat dstMat = dst.getMat(i);
+            src.reshape(CV_MAT_CN(type), offsets[nsets]).rowRange(offsets[i], offsets[i + 1])
+               .reshape(CV_MAT_CN(type), dstMat.rows).copyTo(dstMat);
+        }
+    }
+
     Ptr<RLOFOpticalFlowParameter> param;
     float                forwardBackwardThreshold;
     Ptr<CImageBuffer>    prevPyramid[2];
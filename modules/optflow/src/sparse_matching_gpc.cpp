@@ -237,18 +237,42 @@ void getWHTPatchDescriptor( GPCPatchDescriptor &patchDescr, const Mat *imgCh, in
   patchDescr.feature /= patchRadius;
 }
 
+// Correlates the images with the DCT basis functions, job k filters src[k % nSrc] with kernels[k / nSrc]
+class ParallelDCTBasisFilter : public ParallelLoopBody
+{
+private:
+  const Mat *src;
+  const int nSrc;
+  const Mat *kernels;
+  const Point anchor;
+  Mat *dst;
+
+  ParallelDCTBasisFilter &operator=( const ParallelDCTBasisFilter & );
+
+public:
+  ParallelDCTBasisFilter( const Mat *_src, int _nSrc, const Mat *_kernels, Point _anchor, Mat *_dst )
+      : src( _src ), nSrc( _nSrc ), kernels( _kernels ), anchor( _anchor ), dst( _dst ){};
+
+  void operator()( const Range &range ) const CV_OVERRIDE
+  {
+    for ( int k = range.start; k < range.end; ++k )
+      filter2D( src[k % nSrc], dst[k], CV_32F, kernels[k / nSrc], anchor, 0, BORDER_REPLICATE );
+  }
+};
+
 class ParallelDCTFiller : public ParallelLoopBody
 {
 private:
   const Size sz;
-  const Mat *imgCh;
+  const Mat *coef;
+  const Mat *chSum;
   std::vector< GPCPatchDescriptor > *descr;
 
   ParallelDCTFiller &operator=( const ParallelDCTFiller & );
 
 public:
-  ParallelDCTFiller( const Size &_sz, const Mat *_imgCh, std::vector< GPCPatchDescriptor > *_descr )
-      : sz( _sz ), imgCh( _imgCh ), descr( _descr ){};
+  ParallelDCTFiller( const Size &_sz, const Mat *_coef, const Mat *_chSum, std::vector< GPCPatchDescriptor > *_descr )
+      : sz( _sz ), coef( _coef ), chSum( _chSum ), descr( _descr ){};
 
   void operator()( const Range &range ) const CV_OVERRIDE
   {
@@ -256,7 +280,11 @@ public:
     {
       int x, y;
       GPCDetails::getCoordinatesFromIndex( i, sz, x, y );
-      getDCTPatchDescriptor( descr->at( i ), imgCh, y, x );
+      double *feature = descr->at( i ).feature.val;
+      for ( int k = 0; k < 16; ++k )
+        feature[k] = coef[k].at< float >( y, x );
+      feature[16] = chSum[0].at< float >( y, x ) / ( 2 * patchRadius );
+      feature[17] = chSum[1].at< float >( y, x ) / ( 2 * patchRadius );
     }
   }
 };
@@ -298,8 +326,26 @@ void getAllDCTDescriptorsForImage( const Mat *imgCh, std::vector< GPCPatchDescri
   CV_UNUSED(mp); // Fix unused parameter warning in case OpenCL is not available
   CV_OCL_RUN( mp.useOpenCL, ocl_getAllDCTDescriptorsForImage( imgCh, descr ) )
 
+  // The 4x4 low frequency coefficients of the patch DCT are separable correlations with the DCT basis functions,
+  // they are computed for all patches at once with vectorized row and column filters instead of a DCT per patch.
+  const int n = 2 * patchRadius;
+  Mat rowKernels[4], colKernels[4];
+  for ( int k = 0; k < 4; ++k )
+  {
+    rowKernels[k].create( 1, n, CV_32F );
+    for ( int j = 0; j < n; ++j )
+      rowKernels[k].at< float >( j ) = std::cos( CV_PI * ( j + 0.5 ) * k / n ) * std::sqrt( 1.0 / patchRadius ) * ( k == 0 ? SQRT2_INV : 1.0 );
+    colKernels[k] = rowKernels[k].t();
+  }
+
+  Mat rowCoef[4], coef[16], chSum[2];
+  parallel_for_( Range( 0, 4 ), ParallelDCTBasisFilter( imgCh, 1, rowKernels, Point( patchRadius, 0 ), rowCoef ) );
+  parallel_for_( Range( 0, 16 ), ParallelDCTBasisFilter( rowCoef, 4, colKernels, Point( 0, patchRadius ), coef ) );
+  boxFilter( imgCh[1], chSum[0], CV_32F, Size( n, n ), Point( patchRadius, patchRadius ), false, BORDER_REPLICATE );
+  boxFilter( imgCh[2], chSum[1], CV_32F, Size( n, n ), Point( patchRadius, patchRadius ), false, BORDER_REPLICATE );
+
   descr.resize( ( sz.height - 2 * patchRadius ) * ( sz.width - 2 * patchRadius ) );
-  parallel_for_( Range( 0, descr.size() ), ParallelDCTFiller( sz, imgCh, &descr ) );
+  parallel_for_( Range( 0, descr.size() ), ParallelDCTFiller( sz, coef, chSum, &descr ) );
 }
 
 class ParallelWHTFiller : public ParallelLoopBody
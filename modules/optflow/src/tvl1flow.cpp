@@ -79,6 +79,7 @@
 #include <iomanip>
 #include <iostream>
 #include "opencv2/core/opencl/ocl_defs.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv {
 namespace optflow {
@@ -94,7 +95,7 @@ public:
         tau(tau_), lambda(lambda_), theta(theta_), gamma(gamma_), nscales(nscales_),
         warps(warps_), epsilon(epsilon_), innerIterations(innerIterations_),
         outerIterations(outerIterations_), useInitialFlow(useInitialFlow_),
-        scaleStep(scaleStep_), medianFiltering(medianFiltering_)
+        scaleStep(scaleStep_), medianFiltering(medianFiltering_), videoMode(false), prevScales(0)
     {
     }
     OpticalFlowDual_TVL1();
@@ -128,6 +129,8 @@ public:
     inline void setScaleStep(double val) CV_OVERRIDE { scaleStep = val; }
     inline int getMedianFiltering() const CV_OVERRIDE { return medianFiltering; }
     inline void setMedianFiltering(int val) CV_OVERRIDE { medianFiltering = val; }
+    inline bool getVideoMode() const CV_OVERRIDE { return videoMode; }
+    inline void setVideoMode(bool val) CV_OVERRIDE { videoMode = val; }
 
 protected:
     double tau;
@@ -142,6 +145,7 @@ protected:
     bool useInitialFlow;
     double scaleStep;
     int medianFiltering;
+    bool videoMode;
 
 private:
     void procOneScale(const Mat_<float>& I0, const Mat_<float>& I1, Mat_<float>& u1, Mat_<float>& u2, Mat_<float>& u3);
@@ -172,29 +176,19 @@ private:
         Mat_<float> grad_buf;
         Mat_<float> rho_c_buf;
 
-        Mat_<float> v1_buf;
-        Mat_<float> v2_buf;
-        Mat_<float> v3_buf;
-
         Mat_<float> p11_buf;
         Mat_<float> p12_buf;
         Mat_<float> p21_buf;
         Mat_<float> p22_buf;
         Mat_<float> p31_buf;
         Mat_<float> p32_buf;
-
-        Mat_<float> div_p1_buf;
-        Mat_<float> div_p2_buf;
-        Mat_<float> div_p3_buf;
-
-        Mat_<float> u1x_buf;
-        Mat_<float> u1y_buf;
-        Mat_<float> u2x_buf;
-        Mat_<float> u2y_buf;
-        Mat_<float> u3x_buf;
-        Mat_<float> u3y_buf;
     } dm;
 
+    // state of the previous call used by the video mode
+    Size prevSize;
+    int prevScales;
+    double prevScaleStep;
+
 #ifdef HAVE_OPENCL
     struct dataUMat
     {
@@ -397,6 +391,9 @@ OpticalFlowDual_TVL1::OpticalFlowDual_TVL1()
     useInitialFlow = false;
     medianFiltering = 5;
     scaleStep      = 0.8;
+    videoMode      = false;
+    prevScales     = 0;
+    prevScaleStep  = 0;
 }
 
 void OpticalFlowDual_TVL1::calc(InputArray _I0, InputArray _I1, InputOutputArray _flow)
@@ -418,6 +415,21 @@ void OpticalFlowDual_TVL1::calc(InputArray _I0, InputArray _I1, InputOutputArray
     CV_Assert( !useInitialFlow || (_flow.size() == I0.size() && _flow.type() == CV_32FC2) );
     CV_Assert( nscales > 0 );
     bool use_gamma = gamma != 0;
+
+    // in video mode the coarsest scale starts from the flow of the previous call, and if I0 is
+    // the previous I1 (consecutive frames) its pyramid is reused
+    const bool warmStart = videoMode && !useInitialFlow && prevScales == nscales &&
+                           prevScaleStep == scaleStep && prevSize == I0.size();
+    bool reusePyramid = false;
+    Mat_<float> I0f;
+    if (warmStart)
+    {
+        I0.convertTo(I0f, I0f.depth(), I0.depth() == CV_8U ? 1.0 : 255.0);
+        reusePyramid = cv::norm(I0f, dm.I1s[0], NORM_INF) == 0;
+        if (reusePyramid)
+            std::swap(dm.I0s, dm.I1s);
+    }
+
     // allocate memory for the pyramid structure
     dm.I0s.resize(nscales);
     dm.I1s.resize(nscales);
@@ -425,7 +437,10 @@ void OpticalFlowDual_TVL1::calc(InputArray _I0, InputArray _I1, InputOutputArray
     dm.u2s.resize(nscales);
     dm.u3s.resize(nscales);
 
-    I0.convertTo(dm.I0s[0], dm.I0s[0].depth(), I0.depth() == CV_8U ? 1.0 : 255.0);
+    if (warmStart && !reusePyramid)
+        dm.I0s[0] = I0f;
+    else if (!warmStart)
+        I0.convertTo(dm.I0s[0], dm.I0s[0].depth(), I0.depth() == CV_8U ? 1.0 : 255.0);
     I1.convertTo(dm.I1s[0], dm.I1s[0].depth(), I1.depth() == CV_8U ? 1.0 : 255.0);
 
     dm.u1s[0].create(I0.size());
@@ -451,10 +466,6 @@ void OpticalFlowDual_TVL1::calc(InputArray _I0, InputArray _I1, InputOutputArray
     dm.grad_buf.create(I0.size());
     dm.rho_c_buf.create(I0.size());
 
-    dm.v1_buf.create(I0.size());
-    dm.v2_buf.create(I0.size());
-    dm.v3_buf.create(I0.size());
-
     dm.p11_buf.create(I0.size());
     dm.p12_buf.create(I0.size());
     dm.p21_buf.create(I0.size());
@@ -462,21 +473,11 @@ void OpticalFlowDual_TVL1::calc(InputArray _I0, InputArray _I1, InputOutputArray
     dm.p31_buf.create(I0.size());
     dm.p32_buf.create(I0.size());
 
-    dm.div_p1_buf.create(I0.size());
-    dm.div_p2_buf.create(I0.size());
-    dm.div_p3_buf.create(I0.size());
-
-    dm.u1x_buf.create(I0.size());
-    dm.u1y_buf.create(I0.size());
-    dm.u2x_buf.create(I0.size());
-    dm.u2y_buf.create(I0.size());
-    dm.u3x_buf.create(I0.size());
-    dm.u3y_buf.create(I0.size());
-
     // create the scales
     for (int s = 1; s < nscales; ++s)
     {
-        resize(dm.I0s[s - 1], dm.I0s[s], Size(), scaleStep, scaleStep, INTER_LINEAR);
+        if (!reusePyramid)
+            resize(dm.I0s[s - 1], dm.I0s[s], Size(), scaleStep, scaleStep, INTER_LINEAR);
         resize(dm.I1s[s - 1], dm.I1s[s], Size(), scaleStep, scaleStep, INTER_LINEAR);
 
         if (dm.I0s[s].cols < 16 || dm.I0s[s].rows < 16)
@@ -500,7 +501,7 @@ void OpticalFlowDual_TVL1::calc(InputArray _I0, InputArray _I1, InputOutputArray
         }
         if (use_gamma) dm.u3s[s].create(dm.I0s[s].size());
     }
-    if (!useInitialFlow)
+    if (!useInitialFlow && !warmStart)
     {
         dm.u1s[nscales - 1].setTo(Scalar::all(0));
         dm.u2s[nscales - 1].setTo(Scalar::all(0));
@@ -530,6 +531,10 @@ void OpticalFlowDual_TVL1::calc(InputArray _I0, InputArray _I1, InputOutputArray
 
     Mat uxy[] = { dm.u1s[0], dm.u2s[0] };
     merge(uxy, 2, _flow);
+
+    prevSize = I0.size();
+    prevScales = nscales;
+    prevScaleStep = scaleStep;
 }
 
 #ifdef HAVE_OPENCL
@@ -769,135 +774,6 @@ static void centeredGradient(const Mat_<float>& src, Mat_<float>& dx, Mat_<float
     dy(last_row, last_col) = 0.5f * (src(last_row, last_col) - src(last_row - 1, last_col));
 }
 
-////////////////////////////////////////////////////////////
-// forwardGradient
-
-struct ForwardGradientBody : ParallelLoopBody
-{
-    void operator() (const Range& range) const CV_OVERRIDE;
-
-    Mat_<float> src;
-    mutable Mat_<float> dx;
-    mutable Mat_<float> dy;
-};
-
-void ForwardGradientBody::operator() (const Range& range) const
-{
-    const int last_col = src.cols - 1;
-
-    for (int y = range.start; y < range.end; ++y)
-    {
-        const float* srcCurRow = src[y];
-        const float* srcNextRow = src[y + 1];
-
-        float* dxRow = dx[y];
-        float* dyRow = dy[y];
-
-        for (int x = 0; x < last_col; ++x)
-        {
-            dxRow[x] = srcCurRow[x + 1] - srcCurRow[x];
-            dyRow[x] = srcNextRow[x] - srcCurRow[x];
-        }
-    }
-}
-
-static void forwardGradient(const Mat_<float>& src, Mat_<float>& dx, Mat_<float>& dy)
-{
-    CV_DbgAssert( src.rows > 2 && src.cols > 2 );
-    CV_DbgAssert( dx.size() == src.size() );
-    CV_DbgAssert( dy.size() == src.size() );
-
-    const int last_row = src.rows - 1;
-    const int last_col = src.cols - 1;
-
-    // compute the gradient on the central body of the image
-    {
-        ForwardGradientBody body;
-
-        body.src = src;
-        body.dx = dx;
-        body.dy = dy;
-
-        parallel_for_(Range(0, last_row), body);
-    }
-
-    // compute the gradient on the last row
-    for (int x = 0; x < last_col; ++x)
-    {
-        dx(last_row, x) = src(last_row, x + 1) - src(last_row, x);
-        dy(last_row, x) = 0.0f;
-    }
-
-    // compute the gradient on the last column
-    for (int y = 0; y < last_row; ++y)
-    {
-        dx(y, last_col) = 0.0f;
-        dy(y, last_col) = src(y + 1, last_col) - src(y, last_col);
-    }
-
-    dx(last_row, last_col) = 0.0f;
-    dy(last_row, last_col) = 0.0f;
-}
-
-////////////////////////////////////////////////////////////
-// divergence
-
-struct DivergenceBody : ParallelLoopBody
-{
-    void operator() (const Range& range) const CV_OVERRIDE;
-
-    Mat_<float> v1;
-    Mat_<float> v2;
-    mutable Mat_<float> div;
-};
-
-void DivergenceBody::operator() (const Range& range) const
-{
-    for (int y = range.start; y < range.end; ++y)
-    {
-        const float* v1Row = v1[y];
-        const float* v2PrevRow = v2[y - 1];
-        const float* v2CurRow = v2[y];
-
-        float* divRow = div[y];
-
-        for(int x = 1; x < v1.cols; ++x)
-        {
-            const float v1x = v1Row[x] - v1Row[x - 1];
-            const float v2y = v2CurRow[x] - v2PrevRow[x];
-
-            divRow[x] = v1x + v2y;
-        }
-    }
-}
-
-static void divergence(const Mat_<float>& v1, const Mat_<float>& v2, Mat_<float>& div)
-{
-    CV_DbgAssert( v1.rows > 2 && v1.cols > 2 );
-    CV_DbgAssert( v2.size() == v1.size() );
-    CV_DbgAssert( div.size() == v1.size() );
-
-    {
-        DivergenceBody body;
-
-        body.v1 = v1;
-        body.v2 = v2;
-        body.div = div;
-
-        parallel_for_(Range(1, v1.rows), body);
-    }
-
-    // compute the divergence on the first row
-    for(int x = 1; x < v1.cols; ++x)
-        div(0, x) = v1(0, x) - v1(0, x - 1) + v2(0, x);
-
-    // compute the divergence on the first column
-    for (int y = 1; y < v1.rows; ++y)
-        div(y, 0) = v1(y, 0) + v2(y, 0) - v2(y - 1, 0);
-
-    div(0, 0) = v1(0, 0) + v2(0, 0);
-}
-
 ////////////////////////////////////////////////////////////
 // calcGradRho
 
@@ -969,165 +845,228 @@ static void calcGradRho(const Mat_<float>& I0, const Mat_<float>& I1w, const Mat
 }
 
 ////////////////////////////////////////////////////////////
-// estimateV
+// estimateU
 
-struct EstimateVBody : ParallelLoopBody
+// The thresholding step for (v1, v2, v3), the divergence of the dual variable (p1, p2, p3)
+// and the update of (u1, u2, u3) are done in one pass. The error is accumulated per row and
+// summed in row order, so it does not depend on the number of threads.
+struct EstimateUBody : ParallelLoopBody
 {
     void operator() (const Range& range) const CV_OVERRIDE;
+    float estimateRow(int y, int x0, int x1) const;
 
     Mat_<float> I1wx;
     Mat_<float> I1wy;
-    Mat_<float> u1;
-    Mat_<float> u2;
-    Mat_<float> u3;
     Mat_<float> grad;
     Mat_<float> rho_c;
-    mutable Mat_<float> v1;
-    mutable Mat_<float> v2;
-    mutable Mat_<float> v3;
+    Mat_<float> p11;
+    Mat_<float> p12;
+    Mat_<float> p21;
+    Mat_<float> p22;
+    Mat_<float> p31;
+    Mat_<float> p32;
+    mutable Mat_<float> u1;
+    mutable Mat_<float> u2;
+    mutable Mat_<float> u3;
+    float* rowErrors;
     float l_t;
+    float theta;
     float gamma;
 };
 
-void EstimateVBody::operator() (const Range& range) const
+float EstimateUBody::estimateRow(int y, int x0, int x1) const
 {
-    bool use_gamma = gamma != 0;
+    const bool use_gamma = gamma != 0;
+
+    const float* I1wxRow = I1wx[y];
+    const float* I1wyRow = I1wy[y];
+    const float* gradRow = grad[y];
+    const float* rhoRow = rho_c[y];
+    const float* p11Row = p11[y];
+    const float* p12Row = p12[y];
+    const float* p12PrevRow = y > 0 ? p12[y - 1] : NULL;
+    const float* p21Row = p21[y];
+    const float* p22Row = p22[y];
+    const float* p22PrevRow = y > 0 ? p22[y - 1] : NULL;
+    const float* p31Row = use_gamma ? p31[y] : NULL;
+    const float* p32Row = use_gamma ? p32[y] : NULL;
+    const float* p32PrevRow = use_gamma && y > 0 ? p32[y - 1] : NULL;
+
+    float* u1Row = u1[y];
+    float* u2Row = u2[y];
+    float* u3Row = use_gamma ? u3[y] : NULL;
+
+    float error = 0.0f;
+    for (int x = x0; x < x1; ++x)
+    {
+        const float u1k = u1Row[x];
+        const float u2k = u2Row[x];
+        const float u3k = use_gamma ? u3Row[x] : 0;
+
+        const float rho = use_gamma ? rhoRow[x] + (I1wxRow[x] * u1k + I1wyRow[x] * u2k) + gamma * u3k :
+                                      rhoRow[x] + (I1wxRow[x] * u1k + I1wyRow[x] * u2k);
+        float d1 = 0.0f;
+        float d2 = 0.0f;
+        float d3 = 0.0f;
+        if (rho < -l_t * gradRow[x])
+        {
+            d1 = l_t * I1wxRow[x];
+            d2 = l_t * I1wyRow[x];
+            if (use_gamma) d3 = l_t * gamma;
+        }
+        else if (rho > l_t * gradRow[x])
+        {
+            d1 = -l_t * I1wxRow[x];
+            d2 = -l_t * I1wyRow[x];
+            if (use_gamma) d3 = -l_t * gamma;
+        }
+        else if (gradRow[x] > std::numeric_limits<float>::epsilon())
+        {
+            float fi = -rho / gradRow[x];
+            d1 = fi * I1wxRow[x];
+            d2 = fi * I1wyRow[x];
+            if (use_gamma) d3 = fi * gamma;
+        }
+
+        // the dual variable is zero outside of the image
+        const float div1 = (p11Row[x] - (x > 0 ? p11Row[x - 1] : 0.0f)) + (p12Row[x] - (p12PrevRow ? p12PrevRow[x] : 0.0f));
+        const float div2 = (p21Row[x] - (x > 0 ? p21Row[x - 1] : 0.0f)) + (p22Row[x] - (p22PrevRow ? p22PrevRow[x] : 0.0f));
+
+        u1Row[x] = (u1k + d1) + theta * div1;
+        u2Row[x] = (u2k + d2) + theta * div2;
+        error += (u1Row[x] - u1k) * (u1Row[x] - u1k) + (u2Row[x] - u2k) * (u2Row[x] - u2k);
+
+        if (use_gamma)
+        {
+            const float div3 = (p31Row[x] - (x > 0 ? p31Row[x - 1] : 0.0f)) + (p32Row[x] - (p32PrevRow ? p32PrevRow[x] : 0.0f));
+            u3Row[x] = (u3k + d3) + theta * div3;
+            error += (u3Row[x] - u3k) * (u3Row[x] - u3k);
+        }
+    }
+
+    return error;
+}
+
+void EstimateUBody::operator() (const Range& range) const
+{
+    const int cols = u1.cols;
+
     for (int y = range.start; y < range.end; ++y)
     {
+        if (gamma != 0)
+        {
+            rowErrors[y] = estimateRow(y, 0, cols);
+            continue;
+        }
+
+        // x = 0 has no left neighbour of the dual variable, it is left to the scalar code
+        float error = estimateRow(y, 0, std::min(1, cols));
+        int x = 1;
+#if CV_SIMD128
         const float* I1wxRow = I1wx[y];
         const float* I1wyRow = I1wy[y];
-        const float* u1Row = u1[y];
-        const float* u2Row = u2[y];
-        const float* u3Row = use_gamma?u3[y]:NULL;
         const float* gradRow = grad[y];
         const float* rhoRow = rho_c[y];
+        const float* p11Row = p11[y];
+        const float* p12Row = p12[y];
+        const float* p21Row = p21[y];
+        const float* p22Row = p22[y];
+        const float* p12PrevRow = y > 0 ? p12[y - 1] : NULL;
+        const float* p22PrevRow = y > 0 ? p22[y - 1] : NULL;
+        float* u1Row = u1[y];
+        float* u2Row = u2[y];
 
-        float* v1Row = v1[y];
-        float* v2Row = v2[y];
-        float* v3Row = use_gamma ? v3[y]:NULL;
-
-        for (int x = 0; x < I1wx.cols; ++x)
+        const v_float32x4 v_lt = v_setall_f32(l_t);
+        const v_float32x4 v_nlt = v_setall_f32(-l_t);
+        const v_float32x4 v_theta = v_setall_f32(theta);
+        const v_float32x4 v_eps = v_setall_f32(std::numeric_limits<float>::epsilon());
+        const v_float32x4 v_zero = v_setzero_f32();
+        v_float32x4 v_error = v_zero;
+        for (; x <= cols - 4; x += 4)
         {
-            const float rho = use_gamma ? rhoRow[x] + (I1wxRow[x] * u1Row[x] + I1wyRow[x] * u2Row[x]) + gamma * u3Row[x] :
-                                          rhoRow[x] + (I1wxRow[x] * u1Row[x] + I1wyRow[x] * u2Row[x]);
-            float d1 = 0.0f;
-            float d2 = 0.0f;
-            float d3 = 0.0f;
-            if (rho < -l_t * gradRow[x])
-            {
-                d1 = l_t * I1wxRow[x];
-                d2 = l_t * I1wyRow[x];
-                if (use_gamma) d3 = l_t * gamma;
-            }
-            else if (rho > l_t * gradRow[x])
-            {
-                d1 = -l_t * I1wxRow[x];
-                d2 = -l_t * I1wyRow[x];
-                if (use_gamma) d3 = -l_t * gamma;
-            }
-            else if (gradRow[x] > std::numeric_limits<float>::epsilon())
-            {
-                float fi = -rho / gradRow[x];
-                d1 = fi * I1wxRow[x];
-                d2 = fi * I1wyRow[x];
-                if (use_gamma) d3 = fi * gamma;
-            }
-
-            v1Row[x] = u1Row[x] + d1;
-            v2Row[x] = u2Row[x] + d2;
-            if (use_gamma) v3Row[x] = u3Row[x] + d3;
+            v_float32x4 ix = v_load(I1wxRow + x);
+            v_float32x4 iy = v_load(I1wyRow + x);
+            v_float32x4 g = v_load(gradRow + x);
+            v_float32x4 u1k = v_load(u1Row + x);
+            v_float32x4 u2k = v_load(u2Row + x);
+
+            v_float32x4 rho = v_load(rhoRow + x) + (ix * u1k + iy * u2k);
+            v_float32x4 fi = v_select(g > v_eps, v_zero - rho / g, v_zero);
+            v_float32x4 scale = v_select(rho < v_nlt * g, v_lt, v_select(rho > v_lt * g, v_nlt, fi));
+
+            v_float32x4 div1 = (v_load(p11Row + x) - v_load(p11Row + x - 1)) +
+                               (v_load(p12Row + x) - (p12PrevRow ? v_load(p12PrevRow + x) : v_zero));
+            v_float32x4 div2 = (v_load(p21Row + x) - v_load(p21Row + x - 1)) +
+                               (v_load(p22Row + x) - (p22PrevRow ? v_load(p22PrevRow + x) : v_zero));
+
+            v_float32x4 u1n = (u1k + scale * ix) + v_theta * div1;
+            v_float32x4 u2n = (u2k + scale * iy) + v_theta * div2;
+            v_store(u1Row + x, u1n);
+            v_store(u2Row + x, u2n);
+
+            v_float32x4 e1 = u1n - u1k, e2 = u2n - u2k;
+            v_error += e1 * e1 + e2 * e2;
         }
+        error += v_reduce_sum(v_error);
+#endif
+        rowErrors[y] = error + estimateRow(y, x, cols);
     }
 }
 
-static void estimateV(const Mat_<float>& I1wx, const Mat_<float>& I1wy, const Mat_<float>& u1, const Mat_<float>& u2, const Mat_<float>& u3, const Mat_<float>& grad, const Mat_<float>& rho_c,
-   Mat_<float>& v1, Mat_<float>& v2, Mat_<float>& v3, float l_t, float gamma)
+static float estimateU(const Mat_<float>& I1wx, const Mat_<float>& I1wy, const Mat_<float>& grad, const Mat_<float>& rho_c,
+            const Mat_<float>& p11, const Mat_<float>& p12, const Mat_<float>& p21, const Mat_<float>& p22,
+            const Mat_<float>& p31, const Mat_<float>& p32,
+            Mat_<float>& u1, Mat_<float>& u2, Mat_<float>& u3,
+            float l_t, float theta, float gamma)
 {
     CV_DbgAssert( I1wy.size() == I1wx.size() );
-    CV_DbgAssert( u1.size() == I1wx.size() );
-    CV_DbgAssert( u2.size() == I1wx.size() );
     CV_DbgAssert( grad.size() == I1wx.size() );
     CV_DbgAssert( rho_c.size() == I1wx.size() );
-    CV_DbgAssert( v1.size() == I1wx.size() );
-    CV_DbgAssert( v2.size() == I1wx.size() );
+    CV_DbgAssert( p11.size() == I1wx.size() );
+    CV_DbgAssert( p22.size() == I1wx.size() );
+    CV_DbgAssert( u1.size() == I1wx.size() );
+    CV_DbgAssert( u2.size() == I1wx.size() );
+
+    AutoBuffer<float> rowErrors(u1.rows);
 
-    EstimateVBody body;
+    EstimateUBody body;
     bool use_gamma = gamma != 0;
     body.I1wx = I1wx;
     body.I1wy = I1wy;
+    body.grad = grad;
+    body.rho_c = rho_c;
+    body.p11 = p11;
+    body.p12 = p12;
+    body.p21 = p21;
+    body.p22 = p22;
+    if (use_gamma) body.p31 = p31;
+    if (use_gamma) body.p32 = p32;
     body.u1 = u1;
     body.u2 = u2;
     if (use_gamma) body.u3 = u3;
-    body.grad = grad;
-    body.rho_c = rho_c;
-    body.v1 = v1;
-    body.v2 = v2;
-    if (use_gamma) body.v3 = v3;
+    body.rowErrors = rowErrors.data();
     body.l_t = l_t;
+    body.theta = theta;
     body.gamma = gamma;
-    parallel_for_(Range(0, I1wx.rows), body);
-}
-
-////////////////////////////////////////////////////////////
-// estimateU
-
-static float estimateU(const Mat_<float>& v1, const Mat_<float>& v2, const Mat_<float>& v3,
-            const Mat_<float>& div_p1, const Mat_<float>& div_p2, const Mat_<float>& div_p3,
-            Mat_<float>& u1, Mat_<float>& u2, Mat_<float>& u3,
-            float theta, float gamma)
-{
-    CV_DbgAssert( v2.size() == v1.size() );
-    CV_DbgAssert( div_p1.size() == v1.size() );
-    CV_DbgAssert( div_p2.size() == v1.size() );
-    CV_DbgAssert( u1.size() == v1.size() );
-    CV_DbgAssert( u2.size() == v1.size() );
+    parallel_for_(Range(0, u1.rows), body);
 
     float error = 0.0f;
-    bool use_gamma = gamma != 0;
-    for (int y = 0; y < v1.rows; ++y)
-    {
-        const float* v1Row = v1[y];
-        const float* v2Row = v2[y];
-        const float* v3Row = use_gamma?v3[y]:NULL;
-        const float* divP1Row = div_p1[y];
-        const float* divP2Row = div_p2[y];
-        const float* divP3Row = use_gamma?div_p3[y]:NULL;
-
-        float* u1Row = u1[y];
-        float* u2Row = u2[y];
-        float* u3Row = use_gamma?u3[y]:NULL;
-
-
-        for (int x = 0; x < v1.cols; ++x)
-        {
-            const float u1k = u1Row[x];
-            const float u2k = u2Row[x];
-            const float u3k = use_gamma?u3Row[x]:0;
-
-            u1Row[x] = v1Row[x] + theta * divP1Row[x];
-            u2Row[x] = v2Row[x] + theta * divP2Row[x];
-            if (use_gamma) u3Row[x] = v3Row[x] + theta * divP3Row[x];
-            error += use_gamma?(u1Row[x] - u1k) * (u1Row[x] - u1k) + (u2Row[x] - u2k) * (u2Row[x] - u2k) + (u3Row[x] - u3k) * (u3Row[x] - u3k):
-                               (u1Row[x] - u1k) * (u1Row[x] - u1k) + (u2Row[x] - u2k) * (u2Row[x] - u2k);
-        }
-    }
-
+    for (int y = 0; y < u1.rows; ++y)
+        error += rowErrors[y];
     return error;
 }
 
 ////////////////////////////////////////////////////////////
 // estimateDualVariables
 
+// The forward gradient of (u1, u2, u3) is computed on the fly, it is zero at the last row and column.
 struct EstimateDualVariablesBody : ParallelLoopBody
 {
     void operator() (const Range& range) const CV_OVERRIDE;
 
-    Mat_<float> u1x;
-    Mat_<float> u1y;
-    Mat_<float> u2x;
-    Mat_<float> u2y;
-    Mat_<float> u3x;
-    Mat_<float> u3y;
+    Mat_<float> u1;
+    Mat_<float> u2;
+    Mat_<float> u3;
     mutable Mat_<float> p11;
     mutable Mat_<float> p12;
     mutable Mat_<float> p21;
@@ -1138,86 +1077,80 @@ struct EstimateDualVariablesBody : ParallelLoopBody
     bool use_gamma;
 };
 
-void EstimateDualVariablesBody::operator() (const Range& range) const
+static inline void updateDualVariable(const float* uRow, const float* uNextRow, float* pxRow, float* pyRow,
+                                      int cols, float taut)
 {
-    for (int y = range.start; y < range.end; ++y)
+    const int last_col = cols - 1;
+    int x = 0;
+#if CV_SIMD128
+    const v_float32x4 v_taut = v_setall_f32(taut);
+    const v_float32x4 v_one = v_setall_f32(1.0f);
+    for (; x <= last_col - 4; x += 4)
     {
-        const float* u1xRow = u1x[y];
-        const float* u1yRow = u1y[y];
-        const float* u2xRow = u2x[y];
-        const float* u2yRow = u2y[y];
-        const float* u3xRow = u3x[y];
-        const float* u3yRow = u3y[y];
-
-        float* p11Row = p11[y];
-        float* p12Row = p12[y];
-        float* p21Row = p21[y];
-        float* p22Row = p22[y];
-        float* p31Row = p31[y];
-        float* p32Row = p32[y];
-
-        for (int x = 0; x < u1x.cols; ++x)
-        {
-            const float g1 = static_cast<float>(hypot(u1xRow[x], u1yRow[x]));
-            const float g2 = static_cast<float>(hypot(u2xRow[x], u2yRow[x]));
+        v_float32x4 u = v_load(uRow + x);
+        v_float32x4 ux = v_load(uRow + x + 1) - u;
+        v_float32x4 uy = v_load(uNextRow + x) - u;
+        v_float32x4 ng = v_one + v_taut * v_sqrt(ux * ux + uy * uy);
+        v_store(pxRow + x, (v_load(pxRow + x) + v_taut * ux) / ng);
+        v_store(pyRow + x, (v_load(pyRow + x) + v_taut * uy) / ng);
+    }
+#endif
+    for (; x < cols; ++x)
+    {
+        const float ux = x < last_col ? uRow[x + 1] - uRow[x] : 0.0f;
+        const float uy = uNextRow[x] - uRow[x];
+        const float ng = 1.0f + taut * std::sqrt(ux * ux + uy * uy);
+        pxRow[x] = (pxRow[x] + taut * ux) / ng;
+        pyRow[x] = (pyRow[x] + taut * uy) / ng;
+    }
+}
 
-            const float ng1  = 1.0f + taut * g1;
-            const float ng2 =  1.0f + taut * g2;
+void EstimateDualVariablesBody::operator() (const Range& range) const
+{
+    const int last_row = u1.rows - 1;
 
-            p11Row[x] = (p11Row[x] + taut * u1xRow[x]) / ng1;
-            p12Row[x] = (p12Row[x] + taut * u1yRow[x]) / ng1;
-            p21Row[x] = (p21Row[x] + taut * u2xRow[x]) / ng2;
-            p22Row[x] = (p22Row[x] + taut * u2yRow[x]) / ng2;
+    for (int y = range.start; y < range.end; ++y)
+    {
+        // the last row has no vertical gradient, it is taken against itself
+        const int yNext = std::min(y + 1, last_row);
 
-            if (use_gamma)
-            {
-                const float g3 = static_cast<float>(hypot(u3xRow[x], u3yRow[x]));
-                const float ng3 = 1.0f + taut * g3;
-                p31Row[x] = (p31Row[x] + taut * u3xRow[x]) / ng3;
-                p32Row[x] = (p32Row[x] + taut * u3yRow[x]) / ng3;
-            }
-        }
+        updateDualVariable(u1[y], u1[yNext], p11[y], p12[y], u1.cols, taut);
+        updateDualVariable(u2[y], u2[yNext], p21[y], p22[y], u1.cols, taut);
+        if (use_gamma)
+            updateDualVariable(u3[y], u3[yNext], p31[y], p32[y], u1.cols, taut);
     }
 }
 
-static void estimateDualVariables(const Mat_<float>& u1x, const Mat_<float>& u1y,
-                     const Mat_<float>& u2x, const Mat_<float>& u2y,
-                     const Mat_<float>& u3x, const Mat_<float>& u3y,
-                           Mat_<float>& p11, Mat_<float>& p12,
+static void estimateDualVariables(const Mat_<float>& u1, const Mat_<float>& u2, const Mat_<float>& u3,
+                     Mat_<float>& p11, Mat_<float>& p12,
                      Mat_<float>& p21, Mat_<float>& p22,
                      Mat_<float>& p31, Mat_<float>& p32,
                      float taut, bool use_gamma)
 {
-    CV_DbgAssert( u1y.size() == u1x.size() );
-    CV_DbgAssert( u2x.size() == u1x.size() );
-    CV_DbgAssert( u3x.size() == u1x.size() );
-    CV_DbgAssert( u2y.size() == u1x.size() );
-    CV_DbgAssert( u3y.size() == u1x.size() );
-    CV_DbgAssert( p11.size() == u1x.size() );
-    CV_DbgAssert( p12.size() == u1x.size() );
-    CV_DbgAssert( p21.size() == u1x.size() );
-    CV_DbgAssert( p22.size() == u1x.size() );
-    CV_DbgAssert( p31.size() == u1x.size() );
-    CV_DbgAssert( p32.size() == u1x.size() );
+    CV_DbgAssert( u2.size() == u1.size() );
+    CV_DbgAssert( p11.size() == u1.size() );
+    CV_DbgAssert( p12.size() == u1.size() );
+    CV_DbgAssert( p21.size() == u1.size() );
+    CV_DbgAssert( p22.size() == u1.size() );
 
     EstimateDualVariablesBody body;
 
-    body.u1x = u1x;
-    body.u1y = u1y;
-    body.u2x = u2x;
-    body.u2y = u2y;
-    body.u3x = u3x;
-    body.u3y = u3y;
+    body.u1 = u1;
+    body.u2 = u2;
     body.p11 = p11;
     body.p12 = p12;
     body.p21 = p21;
     body.p22 = p22;
-    body.p31 = p31;
-    body.p32 = p32;
+    if (use_gamma)
+    {
+        body.u3 = u3;
+        body.p31 = p31;
+        body.p32 = p32;
+    }
     body.taut = taut;
     body.use_gamma = use_gamma;
 
-    parallel_for_(Range(0, u1x.rows), body);
+    parallel_for_(Range(0, u1.rows), body);
 }
 
 #ifdef HAVE_OPENCL
@@ -1333,10 +1266,6 @@ void OpticalFlowDual_TVL1::procOneScale(const Mat_<float>& I0, const Mat_<float>
     Mat_<float> grad = dm.grad_buf(Rect(0, 0, I0.cols, I0.rows));
     Mat_<float> rho_c = dm.rho_c_buf(Rect(0, 0, I0.cols, I0.rows));
 
-    Mat_<float> v1 = dm.v1_buf(Rect(0, 0, I0.cols, I0.rows));
-    Mat_<float> v2 = dm.v2_buf(Rect(0, 0, I0.cols, I0.rows));
-    Mat_<float> v3 = dm.v3_buf(Rect(0, 0, I0.cols, I0.rows));
-
     Mat_<float> p11 = dm.p11_buf(Rect(0, 0, I0.cols, I0.rows));
     Mat_<float> p12 = dm.p12_buf(Rect(0, 0, I0.cols, I0.rows));
     Mat_<float> p21 = dm.p21_buf(Rect(0, 0, I0.cols, I0.rows));
@@ -1351,17 +1280,6 @@ void OpticalFlowDual_TVL1::procOneScale(const Mat_<float>& I0, const Mat_<float>
     if (use_gamma) p31.setTo(Scalar::all(0));
     if (use_gamma) p32.setTo(Scalar::all(0));
 
-    Mat_<float> div_p1 = dm.div_p1_buf(Rect(0, 0, I0.cols, I0.rows));
-    Mat_<float> div_p2 = dm.div_p2_buf(Rect(0, 0, I0.cols, I0.rows));
-    Mat_<float> div_p3 = dm.div_p3_buf(Rect(0, 0, I0.cols, I0.rows));
-
-    Mat_<float> u1x = dm.u1x_buf(Rect(0, 0, I0.cols, I0.rows));
-    Mat_<float> u1y = dm.u1y_buf(Rect(0, 0, I0.cols, I0.rows));
-    Mat_<float> u2x = dm.u2x_buf(Rect(0, 0, I0.cols, I0.rows));
-    Mat_<float> u2y = dm.u2y_buf(Rect(0, 0, I0.cols, I0.rows));
-    Mat_<float> u3x = dm.u3x_buf(Rect(0, 0, I0.cols, I0.rows));
-    Mat_<float> u3y = dm.u3y_buf(Rect(0, 0, I0.cols, I0.rows));
-
     const float l_t = static_cast<float>(lambda * theta);
     const float taut = static_cast<float>(tau / theta);
 
@@ -1384,24 +1302,13 @@ void OpticalFlowDual_TVL1::procOneScale(const Mat_<float>& I0, const Mat_<float>
             }
             for (int n_inner = 0; error > scaledEpsilon && n_inner < innerIterations; ++n_inner)
             {
-                // estimate the values of the variable (v1, v2) (thresholding operator TH)
-                estimateV(I1wx, I1wy, u1, u2, u3, grad, rho_c, v1, v2, v3, l_t, static_cast<float>(gamma));
-
-                // compute the divergence of the dual variable (p1, p2, p3)
-                divergence(p11, p12, div_p1);
-                divergence(p21, p22, div_p2);
-                if (use_gamma) divergence(p31, p32, div_p3);
-
-                // estimate the values of the optical flow (u1, u2)
-                error = estimateU(v1, v2, v3, div_p1, div_p2, div_p3, u1, u2, u3, static_cast<float>(theta), static_cast<float>(gamma));
+                // estimate the values of the variable (v1, v2) (thresholding operator TH) and
+                // the values of the optical flow (u1, u2) from v and the divergence of the dual variable
+                error = estimateU(I1wx, I1wy, grad, rho_c, p11, p12, p21, p22, p31, p32, u1, u2, u3,
+                                  l_t, static_cast<float>(theta), static_cast<float>(gamma));
 
-                // compute the gradient of the optical flow (Du1, Du2)
-                forwardGradient(u1, u1x, u1y);
-                forwardGradient(u2, u2x, u2y);
-                if (use_gamma) forwardGradient(u3, u3x, u3y);
-
-                // estimate the values of the dual variable (p1, p2, p3)
-                estimateDualVariables(u1x, u1y, u2x, u2y, u3x, u3y, p11, p12, p21, p22, p31, p32, taut, use_gamma);
+                // estimate the values of the dual variable (p1, p2, p3) from the gradient of the optical flow
+                estimateDualVariables(u1, u2, u3, p11, p12, p21, p22, p31, p32, taut, use_gamma);
             }
         }
     }
@@ -1410,6 +1317,7 @@ void OpticalFlowDual_TVL1::procOneScale(const Mat_<float>& I0, const Mat_<float>
 void OpticalFlowDual_TVL1::collectGarbage()
 {
     //dataMat structure dm
+    prevScales = 0;
     dm.I0s.clear();
     dm.I1s.clear();
     dm.u1s.clear();
@@ -1428,21 +1336,11 @@ void OpticalFlowDual_TVL1::collectGarbage()
     dm.grad_buf.release();
     dm.rho_c_buf.release();
 
-    dm.v1_buf.release();
-    dm.v2_buf.release();
-
     dm.p11_buf.release();
     dm.p12_buf.release();
     dm.p21_buf.release();
     dm.p22_buf.release();
 
-    dm.div_p1_buf.release();
-    dm.div_p2_buf.release();
-
-    dm.u1x_buf.release();
-    dm.u1y_buf.release();
-    dm.u2x_buf.release();
-    dm.u2y_buf.release();
 
 #ifdef HAVE_OPENCL
     //dataUMat structure dum
@@ -0,0 +1,59 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "../test_precomp.hpp"
+#include "opencv2/ts/ocl_test.hpp"
+
+#ifdef HAVE_OPENCL
+
+namespace opencv_test {
+namespace ocl {
+
+static double calcRMSE(const Mat& gt, const Mat& flow)
+{
+    double sum = 0;
+    int counter = 0;
+    for (int y = 0; y < gt.rows; ++y)
+    {
+        for (int x = 0; x < gt.cols; ++x)
+        {
+            Vec2f g = gt.at<Vec2f>(y, x), f = flow.at<Vec2f>(y, x);
+            if (cvIsNaN(g[0]) || cvIsNaN(g[1]) || fabs(g[0]) >= 1e9 || fabs(g[1]) >= 1e9)
+                continue;
+            sum += (g[0] - f[0]) * (g[0] - f[0]) + (g[1] - f[1]) * (g[1] - f[1]);
+            counter++;
+        }
+    }
+    return sqrt(sum / (1e-9 + counter));
+}
+
+OCL_TEST(OpticalFlowDeepFlow, Mat)
+{
+    Mat frame0 = readImage("optflow/RubberWhale1.png", IMREAD_GRAYSCALE);
+    ASSERT_FALSE(frame0.empty());
+
+    Mat frame1 = readImage("optflow/RubberWhale2.png", IMREAD_GRAYSCALE);
+    ASSERT_FALSE(frame1.empty());
+
+    Mat GT = readOpticalFlow(cvtest::TS::ptr()->get_data_path() + "optflow/RubberWhale.flo");
+    ASSERT_FALSE(GT.empty());
+
+    Ptr<DenseOpticalFlow> alg = createOptFlow_DeepFlow();
+
+    Mat flow; UMat uflow;
+    OCL_OFF(alg->calc(frame0, frame1, flow));
+    OCL_ON(alg->calc(frame0, frame1, uflow));
+
+    ASSERT_EQ(flow.size(), uflow.size());
+    ASSERT_EQ(CV_32FC2, uflow.type());
+
+    // the OpenCL solver minimizes the same energy, its accuracy should match the CPU path
+    double rmseCPU = calcRMSE(GT, flow);
+    double rmseOCL = calcRMSE(GT, uflow.getMat(ACCESS_READ));
+    EXPECT_LE(rmseOCL, rmseCPU * 1.1 + 0.02);
+}
+
+} } // namespace opencv_test::ocl
+
+#endif // HAVE_OPENCL
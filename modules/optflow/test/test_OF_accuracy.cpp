@@ -243,6 +243,45 @@ TEST(SparseOpticalFlow, ReferenceAccuracy)
     EXPECT_LE(calcRMSE(prevPts, currPts, GT), 0.28f);
 }
 
+TEST(SparseOpticalFlow, BatchAndPyramidReuse)
+{
+    Mat frame1, frame2, GT;
+    ASSERT_TRUE(readRubberWhale(frame1, frame2, GT));
+    vector<vector<Point2f> > prevPts(3);
+    for (int r = 0; r < frame1.rows; r+=10)
+    {
+        for (int c = 0; c < frame1.cols; c+=10)
+        {
+            prevPts[(r + c) % 3].push_back(Point2f(static_cast<float>(c), static_cast<float>(r)));
+        }
+    }
+    Ptr<RLOFOpticalFlowParameter> param = Ptr<RLOFOpticalFlowParameter>(new RLOFOpticalFlowParameter);
+    param->supportRegionType = SR_CROSS;
+    Ptr<SparseRLOFOpticalFlow> algo = SparseRLOFOpticalFlow::create(param);
+
+    vector<vector<Point2f> > batchPts;
+    vector<vector<uchar> > batchStatus;
+    algo->calcBatch(frame1, frame2, prevPts, batchPts, batchStatus);
+    ASSERT_EQ(prevPts.size(), batchPts.size());
+    ASSERT_EQ(prevPts.size(), batchStatus.size());
+    for (size_t i = 0; i < prevPts.size(); i++)
+    {
+        vector<Point2f> currPts;
+        vector<uchar> status;
+        SparseRLOFOpticalFlow::create(param)->calc(frame1, frame2, prevPts[i], currPts, status);
+        EXPECT_EQ(0., cv::norm(currPts, batchPts[i], NORM_INF));
+        EXPECT_EQ(status, batchStatus[i]);
+    }
+
+    // the pyramids of frame2 are reused as the previous image
+    vector<Point2f> currPts, refPts;
+    vector<uchar> status, refStatus;
+    algo->calc(frame2, frame1, batchPts[0], currPts, status);
+    SparseRLOFOpticalFlow::create(param)->calc(frame2, frame1, batchPts[0], refPts, refStatus);
+    EXPECT_EQ(0., cv::norm(refPts, currPts, NORM_INF));
+    EXPECT_EQ(refStatus, status);
+}
+
 TEST(DenseOpticalFlow_RLOF, ReferenceAccuracy)
 {
     Mat frame1, frame2, GT;
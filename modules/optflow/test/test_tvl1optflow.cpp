@@ -170,4 +170,36 @@ TEST(Contrib_calcOpticalFlowDual_TVL1, Regression)
 #endif
 }
 
+TEST(Contrib_calcOpticalFlowDual_TVL1, VideoMode)
+{
+    const string frame1_path = TS::ptr()->get_data_path() + "optflow/RubberWhale1.png";
+    const string frame2_path = TS::ptr()->get_data_path() + "optflow/RubberWhale2.png";
+    const string gold_flow_path = TS::ptr()->get_data_path() + "optflow/tvl1_flow.flo";
+
+    Mat frame1 = imread(frame1_path, IMREAD_GRAYSCALE);
+    Mat frame2 = imread(frame2_path, IMREAD_GRAYSCALE);
+    ASSERT_FALSE(frame1.empty());
+    ASSERT_FALSE(frame2.empty());
+
+    Mat_<Point2f> gold;
+    readOpticalFlowFromFile(gold, gold_flow_path);
+
+    Ptr<DualTVL1OpticalFlow> tvl1 = cv::optflow::DualTVL1OpticalFlow::create();
+    tvl1->setVideoMode(true);
+
+    // the first call has no previous state
+    Mat_<Point2f> flow;
+    tvl1->calc(frame1, frame2, flow);
+    check(gold, flow);
+
+    // I0 is the previous I1, its pyramid is reused
+    Mat_<Point2f> backward;
+    tvl1->calc(frame2, frame1, backward);
+    tvl1->calc(frame1, frame2, flow);
+
+    ASSERT_EQ(gold.rows, flow.rows);
+    ASSERT_EQ(gold.cols, flow.cols);
+    check(gold, flow, 0.1, 0.9);
+}
+
 }} // namespace
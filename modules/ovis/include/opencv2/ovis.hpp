@@ -89,7 +89,9 @@ public:
 
     /**
      * set window background to custom image
-     * @param image
+     *
+     * the background texture is dynamic, so it can be updated every frame, e.g. with camera images
+     * @param image a Mat, UMat or ogl::Buffer
      */
     CV_WRAP virtual void setBackground(InputArray image) = 0;
 
@@ -360,7 +362,7 @@ CV_EXPORTS_W void setMaterialProperty(const String& name, int prop, const String
  * set the texture of a material to the given value
  * @param name material name
  * @param prop @ref MaterialProperty
- * @param value the texture data
+ * @param value the texture data, a Mat, UMat or ogl::Buffer
  */
 CV_EXPORTS_AS(setMaterialTexture) void setMaterialProperty(const String& name, int prop, InputArray value);
 
@@ -392,6 +394,17 @@ CV_EXPORTS_W void createPlaneMesh(const String& name, const Size2f& size, InputA
  */
 CV_EXPORTS_W void createPointCloudMesh(const String& name, InputArray vertices, InputArray colors = noArray());
 
+/**
+ * updates the vertices of a point cloud mesh
+ *
+ * the mesh buffers are switched to dynamic usage on the first update, so that meshes updated every
+ * frame do not have to wait for the rendering of the previous content.
+ * @param name name of a mesh created with createPointCloudMesh
+ * @param vertices float vector of positions, a Mat, UMat or ogl::Buffer
+ * @param colors uchar vector of colors. Must be given if and only if the mesh was created with colors.
+ */
+CV_EXPORTS_W void updatePointCloudMesh(const String& name, InputArray vertices, InputArray colors = noArray());
+
 /**
  * creates a grid
  *
@@ -413,6 +426,17 @@ CV_EXPORTS_W void createGridMesh(const String& name, const Size2f& size, const S
  */
 CV_EXPORTS_W void createTriangleMesh(const String& name, InputArray vertices, InputArray normals = noArray(), InputArray indices = noArray());
 
+/**
+ * updates the vertices and optionally the indices of a triangle mesh
+ *
+ * @see updatePointCloudMesh
+ * @param name name of a mesh created with createTriangleMesh
+ * @param vertices float vector of positions, a Mat, UMat or ogl::Buffer
+ * @param normals float vector of normals. Must be given if and only if the mesh was created with normals.
+ * @param indices int vector of indices. The previous indices are kept if empty.
+ */
+CV_EXPORTS_W void updateTriangleMesh(const String& name, InputArray vertices, InputArray normals = noArray(), InputArray indices = noArray());
+
 /// @deprecated use setMaterialProperty
 CV_EXPORTS_W void updateTexture(const String& name, InputArray image);
 //! @}
@@ -23,7 +23,7 @@ void createPlaneMesh(const String& name, const Size2f& size, InputArray image)
 
     if (!image.empty())
     {
-        _createTexture(name, image.getMat());
+        _createTexture(name, image);
         rpass->createTextureUnitState(name);
     }
 
@@ -34,14 +34,93 @@ void createPlaneMesh(const String& name, const Size2f& size, InputArray image)
     mesh->getSubMesh(0)->setMaterialName(name);
 }
 
-void createPointCloudMesh(const String& name, InputArray vertices, InputArray colors)
+static void _setBounds(Mesh* mesh, const Mat& vertices)
+{
+    AxisAlignedBox bounds(AxisAlignedBox::EXTENT_NULL);
+    if (!vertices.empty())
+    {
+        Mat pts = vertices.reshape(1, (int)vertices.total());
+        Mat lo, hi;
+        reduce(pts, lo, 0, REDUCE_MIN);
+        reduce(pts, hi, 0, REDUCE_MAX);
+        bounds.setExtents(Vector3(lo.at<float>(0), lo.at<float>(1), lo.at<float>(2)),
+                          Vector3(hi.at<float>(0), hi.at<float>(1), hi.at<float>(2)));
+    }
+    mesh->_setBounds(bounds);
+}
+
+// converts the colors straight into the buffer as RGBA
+static void _writeColors(const HardwareVertexBufferSharedPtr& hwbuf, const Mat& colors)
+{
+    Mat col4(colors.size(), CV_8UC4, hwbuf->lock(0, colors.total() * 4, HardwareBuffer::HBL_DISCARD));
+    cvtColor(colors, col4, colors.type() == CV_8UC3 ? COLOR_BGR2RGBA : COLOR_BGRA2RGBA);
+    hwbuf->unlock();
+}
+
+// buffers are created static and replaced by dynamic ones on their first update, so that meshes
+// updated every frame are written with a discarding lock instead of waiting for the GPU
+static HardwareVertexBufferSharedPtr _getDynamicVertexBuffer(VertexData* vdata, unsigned short source, size_t n)
+{
+    VertexBufferBinding* binding = vdata->vertexBufferBinding;
+    HardwareVertexBufferSharedPtr hwbuf = binding->getBuffer(source);
+
+    if (hwbuf->getNumVertices() < n || !(hwbuf->getUsage() & HardwareBuffer::HBU_DYNAMIC))
+    {
+        hwbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+            vdata->vertexDeclaration->getVertexSize(source), n, HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+        binding->setBinding(source, hwbuf);
+    }
+    return hwbuf;
+}
+
+static void _writeVertices(VertexData* vdata, VertexElementSemantic semantic, const Mat& data)
+{
+    const VertexElement* elem = vdata->vertexDeclaration->findElementBySemantic(semantic);
+    HardwareVertexBufferSharedPtr hwbuf = _getDynamicVertexBuffer(vdata, elem->getSource(), data.total());
+    if (semantic == VES_DIFFUSE)
+        _writeColors(hwbuf, data);
+    else
+        hwbuf->writeData(0, data.total() * hwbuf->getVertexSize(), data.ptr(), true);
+}
+
+static void _checkPointCloud(const Mat& vertices, const Mat& colors)
 {
     int color_type = colors.type();
-    CV_Assert(_app);
     CV_CheckTypeEQ(vertices.type(), CV_32FC3, "vertices type must be Vec3f");
     CV_Assert(vertices.isContinuous());
     if (!colors.empty())
+    {
         CV_CheckType(color_type, color_type == CV_8UC3 || color_type == CV_8UC4, "unsupported type");
+        CV_Assert(colors.total() == vertices.total());
+    }
+}
+
+static void _checkTriangleMesh(const Mat& vertices, const Mat& normals, const Mat& indices)
+{
+    CV_CheckTypeEQ(vertices.type(), CV_32FC3, "vertices type must be Vec3f");
+    CV_Assert(vertices.isContinuous());
+
+    if(!normals.empty())
+    {
+        CV_CheckTypeEQ(normals.type(), CV_32FC3, "normals type must be Vec3f");
+        CV_Assert(normals.isContinuous());
+        CV_Assert(normals.size() == vertices.size());
+    }
+    if(!indices.empty())
+    {
+        CV_CheckTypeEQ(indices.type(), CV_32S, "indices type must be int");
+        CV_Assert(indices.isContinuous());
+    }
+}
+
+void createPointCloudMesh(const String& name, InputArray vertices, InputArray colors)
+{
+    CV_Assert(_app);
+
+    _HostArray hvertices(vertices), hcolors(colors);
+    const Mat& _vertices = hvertices.mat;
+    const Mat& _colors = hcolors.mat;
+    _checkPointCloud(_vertices, _colors);
 
     // material
     MaterialPtr mat = MaterialManager::getSingleton().create(name, RESOURCEGROUP_NAME);
@@ -56,7 +135,7 @@ void createPointCloudMesh(const String& name, InputArray vertices, InputArray co
     sub->operationType = RenderOperation::OT_POINT_LIST;
     sub->setMaterialName(name);
 
-    int n = vertices.rows();
+    int n = (int)_vertices.total();
 
     mesh->sharedVertexData = new VertexData();
     mesh->sharedVertexData->vertexCount = n;
@@ -65,8 +144,6 @@ void createPointCloudMesh(const String& name, InputArray vertices, InputArray co
     // vertex data
     HardwareBufferManager& hbm = HardwareBufferManager::getSingleton();
 
-    Mat _vertices = vertices.getMat();
-
     int source = 0;
     HardwareVertexBufferSharedPtr hwbuf;
 
@@ -76,48 +153,55 @@ void createPointCloudMesh(const String& name, InputArray vertices, InputArray co
     mesh->sharedVertexData->vertexBufferBinding->setBinding(source, hwbuf);
 
     // color data
-    if (!colors.empty())
+    if (!_colors.empty())
     {
         mat->setLightingEnabled(false);
         source += 1;
 
-        Mat col4;
-        cvtColor(colors, col4, color_type == CV_8UC3 ? COLOR_BGR2RGBA : COLOR_BGRA2RGBA);
-
         decl->addElement(source, 0, VET_COLOUR, VES_DIFFUSE);
         hwbuf =
             hbm.createVertexBuffer(decl->getVertexSize(source), n, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
-        hwbuf->writeData(0, hwbuf->getSizeInBytes(), col4.ptr(), true);
+        _writeColors(hwbuf, _colors);
         mesh->sharedVertexData->vertexBufferBinding->setBinding(source, hwbuf);
 
         rpass->setVertexColourTracking(TVC_DIFFUSE);
     }
 
-    AxisAlignedBox bounds(AxisAlignedBox::EXTENT_NULL);
-    for (int i = 0; i < n; i++)
-    {
-        Vec3f v = _vertices.at<Vec3f>(i);
-        bounds.merge(Vector3(v[0], v[1], v[2]));
-    }
-    mesh->_setBounds(bounds);
+    _setBounds(mesh.get(), _vertices);
 }
 
-void createTriangleMesh(const String& name, InputArray vertices, InputArray normals, InputArray indices)
+void updatePointCloudMesh(const String& name, InputArray vertices, InputArray colors)
 {
-    CV_CheckTypeEQ(vertices.type(), CV_32FC3, "vertices type must be Vec3f");
-    CV_Assert(vertices.isContinuous());
+    CV_Assert(_app);
 
-    if(!normals.empty())
-    {
-        CV_CheckTypeEQ(normals.type(), CV_32FC3, "normals type must be Vec3f");
-        CV_Assert(normals.isContinuous());
-        CV_Assert(normals.size() == vertices.size());
-    }
-    if(!indices.empty())
-    {
-        CV_CheckTypeEQ(indices.type(), CV_32S, "indices type must be int");
-        CV_Assert(indices.isContinuous());
-    }
+    MeshPtr mesh = MeshManager::getSingleton().getByName(name, RESOURCEGROUP_NAME);
+    CV_Assert(mesh && mesh->sharedVertexData);
+
+    _HostArray hvertices(vertices), hcolors(colors);
+    const Mat& _vertices = hvertices.mat;
+    const Mat& _colors = hcolors.mat;
+    _checkPointCloud(_vertices, _colors);
+
+    // the buffers of all the attributes must be large enough for the new vertex count
+    VertexData* vdata = mesh->sharedVertexData;
+    bool hasColors = vdata->vertexDeclaration->findElementBySemantic(VES_DIFFUSE) != NULL;
+    CV_Assert(_colors.empty() == !hasColors);
+
+    _writeVertices(vdata, VES_POSITION, _vertices);
+    if (hasColors)
+        _writeVertices(vdata, VES_DIFFUSE, _colors);
+    vdata->vertexCount = _vertices.total();
+
+    _setBounds(mesh.get(), _vertices);
+}
+
+void createTriangleMesh(const String& name, InputArray vertices, InputArray normals, InputArray indices)
+{
+    _HostArray hvertices(vertices), hnormals(normals), hindices(indices);
+    const Mat& _vertices = hvertices.mat;
+    const Mat& _normals = hnormals.mat;
+    const Mat& _indices = hindices.mat;
+    _checkTriangleMesh(_vertices, _normals, _indices);
 
     // default material
     auto mat = MaterialManager::getSingleton().create(name, RESOURCEGROUP_NAME);
@@ -129,7 +213,7 @@ void createTriangleMesh(const String& name, InputArray vertices, InputArray norm
     sub->operationType = RenderOperation::OT_TRIANGLE_LIST;
     sub->setMaterialName(name);
 
-    int n = vertices.rows();
+    int n = (int)_vertices.total();
 
     mesh->sharedVertexData = new VertexData();
     mesh->sharedVertexData->vertexCount = n;
@@ -138,8 +222,6 @@ void createTriangleMesh(const String& name, InputArray vertices, InputArray norm
     // vertex data
     HardwareBufferManager& hbm = HardwareBufferManager::getSingleton();
 
-    Mat _vertices = vertices.getMat();
-
     int source = 0;
     HardwareVertexBufferSharedPtr hwbuf;
 
@@ -149,11 +231,10 @@ void createTriangleMesh(const String& name, InputArray vertices, InputArray norm
     mesh->sharedVertexData->vertexBufferBinding->setBinding(source, hwbuf);
 
     // normals
-    if (!normals.empty())
+    if (!_normals.empty())
     {
         source += 1;
 
-        Mat _normals = normals.getMat();
         decl->addElement(source, 0, VET_FLOAT3, VES_NORMAL);
         hwbuf =
             hbm.createVertexBuffer(decl->getVertexSize(source), n, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
@@ -166,26 +247,62 @@ void createTriangleMesh(const String& name, InputArray vertices, InputArray norm
     }
 
     // indices
-    if (!indices.empty())
+    if (!_indices.empty())
     {
-        Mat _indices = indices.getMat();
-
         HardwareIndexBufferSharedPtr ibuf = HardwareBufferManager::getSingleton().createIndexBuffer(
-            HardwareIndexBuffer::IT_32BIT, indices.total(), HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+            HardwareIndexBuffer::IT_32BIT, _indices.total(), HardwareBuffer::HBU_STATIC_WRITE_ONLY);
         ibuf->writeData(0, ibuf->getSizeInBytes(), _indices.ptr(), true);
 
         sub->indexData->indexBuffer = ibuf;
         sub->indexData->indexStart = 0;
-        sub->indexData->indexCount = indices.total();
+        sub->indexData->indexCount = _indices.total();
     }
 
-    AxisAlignedBox bounds(AxisAlignedBox::EXTENT_NULL);
-    for (int i = 0; i < n; i++)
+    _setBounds(mesh.get(), _vertices);
+}
+
+void updateTriangleMesh(const String& name, InputArray vertices, InputArray normals, InputArray indices)
+{
+    CV_Assert(_app);
+
+    MeshPtr mesh = MeshManager::getSingleton().getByName(name, RESOURCEGROUP_NAME);
+    CV_Assert(mesh && mesh->sharedVertexData);
+
+    _HostArray hvertices(vertices), hnormals(normals), hindices(indices);
+    const Mat& _vertices = hvertices.mat;
+    const Mat& _normals = hnormals.mat;
+    const Mat& _indices = hindices.mat;
+    _checkTriangleMesh(_vertices, _normals, _indices);
+
+    VertexData* vdata = mesh->sharedVertexData;
+    bool hasNormals = vdata->vertexDeclaration->findElementBySemantic(VES_NORMAL) != NULL;
+    CV_Assert(_normals.empty() == !hasNormals);
+
+    _writeVertices(vdata, VES_POSITION, _vertices);
+    if (hasNormals)
+        _writeVertices(vdata, VES_NORMAL, _normals);
+    vdata->vertexCount = _vertices.total();
+
+    // the previous indices are kept if none are given
+    if (!_indices.empty())
     {
-        Vec3f v = _vertices.at<Vec3f>(i);
-        bounds.merge(Vector3(v[0], v[1], v[2]));
+        IndexData* idata = mesh->getSubMesh(0)->indexData;
+        HardwareIndexBufferSharedPtr ibuf = idata->indexBuffer;
+        size_t count = _indices.total();
+
+        if (!ibuf || ibuf->getNumIndexes() < count || !(ibuf->getUsage() & HardwareBuffer::HBU_DYNAMIC))
+        {
+            ibuf = HardwareBufferManager::getSingleton().createIndexBuffer(
+                HardwareIndexBuffer::IT_32BIT, count, HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+            idata->indexBuffer = ibuf;
+        }
+        ibuf->writeData(0, count * sizeof(int), _indices.ptr(), true);
+
+        idata->indexStart = 0;
+        idata->indexCount = count;
     }
-    mesh->_setBounds(bounds);
+
+    _setBounds(mesh.get(), _vertices);
 }
 
 void createGridMesh(const String& name, const Size2f& size, const Size& segments)
@@ -31,8 +31,11 @@ static Vector2 toOGRE_SS = Vector2(1, -1);
 
 WindowScene::~WindowScene() {}
 
-void _createTexture(const String& name, Mat image)
+void _createTexture(const String& name, InputArray _image)
 {
+    _HostArray host(_image);
+    const Mat& image = host.mat;
+
     PixelFormat format;
     switch(image.type())
     {
@@ -61,13 +64,30 @@ void _createTexture(const String& name, Mat image)
 
     if(!tex)
     {
+        // textures are dynamic, so that updating them with a discarding lock does not wait for
+        // the GPU to be done with the previous content
         tex = texMgr.createManual(name, RESOURCEGROUP_NAME, TEX_TYPE_2D, image.cols, image.rows,
-                                  MIP_DEFAULT, format);
+                                  MIP_DEFAULT, format, TU_DYNAMIC_WRITE_ONLY_DISCARDABLE | TU_AUTOMIPMAP);
+    }
+    else if(tex->getWidth() != uint32(image.cols) || tex->getHeight() != uint32(image.rows) ||
+            tex->getDesiredFormat() != format)
+    {
+        // resize the texture instead of scaling every new image to the old size on the CPU
+        tex->freeInternalResources();
+        tex->setWidth(image.cols);
+        tex->setHeight(image.rows);
+        tex->setFormat(format);
+        tex->createInternalResources();
     }
 
     PixelBox box(image.cols, image.rows, 1, format, image.ptr());
     box.rowPitch = image.step[0] / PixelUtil::getNumElemBytes(format);
-    tex->getBuffer()->blitFromMemory(box);
+
+    // copy straight into the discarded buffer, converting if the render system picked another
+    // internal format
+    HardwarePixelBufferSharedPtr buf = tex->getBuffer();
+    PixelUtil::bulkPixelConversion(box, buf->lock(Box(0, 0, image.cols, image.rows), HardwareBuffer::HBL_DISCARD));
+    buf->unlock();
 }
 
 static void _convertRT(InputArray rot, InputArray tvec, Quaternion& q, Vector3& t, bool invert = false)
@@ -443,7 +463,7 @@ public:
 
         String name = sceneMgr->getName() + "_Background";
 
-        _createTexture(name, image.getMat());
+        _createTexture(name, image);
 
         bgplane->setDefaultUVs();
 
@@ -1083,7 +1103,7 @@ void setMaterialProperty(const String& name, int prop, InputArray value)
     auto texName = tu->getTextureName();
     if(texName.empty()) texName = name;
 
-    _createTexture(texName, value.getMat());
+    _createTexture(texName, value);
     tu->setTextureName(texName);
 }
 
@@ -1147,7 +1167,7 @@ void updateTexture(const String& name, InputArray image)
     CV_Assert(_app);
     TexturePtr tex = TextureManager::getSingleton().getByName(name, RESOURCEGROUP_NAME);
     CV_Assert(tex);
-    _createTexture(name, image.getMat());
+    _createTexture(name, image);
 }
 }
 }
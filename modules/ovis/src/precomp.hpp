@@ -7,6 +7,7 @@
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
+#include <opencv2/core/opengl.hpp>
 #include "opencv2/ovis.hpp"
 #include "opencv2/opencv_modules.hpp"
 
@@ -18,7 +19,40 @@ struct Application;
 extern Ptr<Application> _app;
 
 extern const char* RESOURCEGROUP_NAME;
-void _createTexture(const String& name, Mat image);
+void _createTexture(const String& name, InputArray image);
+
+/// host view of an array, the data of an ogl::Buffer is mapped for the lifetime of the view
+class _HostArray
+{
+public:
+    explicit _HostArray(InputArray arr) : mapped(false)
+    {
+        if (arr.kind() == _InputArray::OPENGL_BUFFER)
+        {
+            buffer = arr.getOGlBuffer();
+            mat = buffer.mapHost(ogl::Buffer::READ_ONLY);
+            mapped = true;
+        }
+        else
+        {
+            mat = arr.getMat();
+        }
+    }
+
+    ~_HostArray()
+    {
+        if (mapped)
+            buffer.unmapHost();
+    }
+
+    Mat mat;
+private:
+    ogl::Buffer buffer;
+    bool mapped;
+
+    _HostArray(const _HostArray&);
+    _HostArray& operator=(const _HostArray&);
+};
 }
 }
 
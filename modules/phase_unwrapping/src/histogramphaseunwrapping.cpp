@@ -40,6 +40,8 @@
  //M*/
 
 
+#include "precomp.hpp"
+
 #include "precomp.hpp"
 
 namespace cv {
@@ -60,116 +62,46 @@ public:
     void getInverseReliabilityMap( OutputArray reliabilityMap ) CV_OVERRIDE;
 
 private:
-    // Class describing a pixel
-    class Pixel
-    {
-    private:
-        // Value from the wrapped phase map
-        float phaseValue;
-        // Id of a pixel. Computed from its position in the Mat
-        int idx;
-        // Pixel is valid if it's not in a shadow region
-        bool valid;
-        // "Quality" parameter. See reference paper
-        float inverseReliability;
-        // Number of 2pi  that needs to be added to the pixel to unwrap the phase map
-        int increment;
-        // Number of pixels that are in the same group as the current pixel
-        int nbrOfPixelsInGroup;
-        // Group id. At first, group id is the same value as idx
-        int groupId;
-        // Pixel is alone in its group
-        bool singlePixelGroup;
-    public:
-        Pixel();
-        Pixel( float pV, int id, bool v, float iR, int inc );
-        float getPhaseValue();
-        int getIndex();
-        bool getValidity();
-        float getInverseReliability();
-        int getIncrement();
-        int getNbrOfPixelsInGroup();
-        int getGroupId();
-        bool getSinglePixelGroup();
-        void setIncrement( int inc );
-        // When a pixel which is not in a single group is added to a new group, we need to keep the previous increment and add "inc" to it.
-        void changeIncrement( int inc );
-        void setNbrOfPixelsInGroup( int nbr );
-        void setGroupId( int gId );
-        void setSinglePixelGroup( bool s );
-    };
-    // Class describing an Edge as presented in the reference paper
-    class Edge
+    // Edge between two valid neighbouring pixels as presented in the reference paper.
+    // The second pixel is the right or the lower neighbour of the first one.
+    struct Edge
     {
-    private:
-        // Id of the first pixel that forms the edge
         int pixOneId;
-        // Id of the second pixel that forms the edge
         int pixTwoId;
-        // Number of 2pi that needs to be added to the second pixel to remove discontinuities
-        int increment;
-    public:
-        Edge();
-        Edge( int p1, int p2, int inc );
-        int getPixOneId();
-        int getPixTwoId();
-        int getIncrement();
-    };
-    // Class describing a bin from the histogram
-    class HistogramBin
-    {
-    private:
-        float start;
-        float end;
-        std::vector<Edge> edges;
-    public:
-        HistogramBin();
-        HistogramBin( float s, float e );
-        void addEdge( Edge e );
-        std::vector<Edge> getEdges();
-    };
-    // Class describing the histogram. Bins before "thresh" are smaller than the one after "thresh" value
-    class Histogram
-    {
-    private:
-        std::vector<HistogramBin> bins;
-        float thresh;
-        float smallWidth;
-        float largeWidth;
-        int nbrOfSmallBins;
-        int nbrOfLargeBins;
-        int nbrOfBins;
-    public:
-        Histogram();
-        void createBins( float t, int nbrOfBinsBeforeThresh, int nbrOfBinsAfterThresh );
-        void addBin( HistogramBin b );
-        void addEdgeInBin( Edge e, int binIndex);
-        float getThresh();
-        float getSmallWidth();
-        float getLargeWidth();
-        int getNbrOfBins();
-        std::vector<Edge> getEdgesFromBin( int binIndex );
     };
     // Params for phase unwrapping
     Params params;
-    // Pixels from the wrapped phase map
-    std::vector<Pixel> pixels;
-    // Histogram used to unwrap
-    Histogram histogram;
+    // Wrapped phase map
+    Mat phaseMap;
+    // "Quality" parameter of the pixels. See reference paper
+    Mat inverseReliability;
+    // Pixels which are not in a shadow region
+    Mat valid;
+    // Edges sorted in the histogram. Bins before "thresh" are smaller than the ones after "thresh" value.
+    // The edges of bin b are edges[binOffsets[b]] .. edges[binOffsets[b + 1] - 1], in the order of their first pixel
+    std::vector<Edge> edges;
+    std::vector<int> binOffsets;
+    /* Groups of pixels, as a disjoint-set forest. The number of 2pi that needs to be added to a pixel
+     * to unwrap the phase map is the sum of "increment" on its path to the root of its group */
+    std::vector<int> parent;
+    std::vector<int> increment;
+    std::vector<int> groupSize;
     // Compute pixel reliability.
-    void computePixelsReliability( InputArray wrappedPhaseMap, InputArray shadowMask = noArray() );
+    void computePixelsReliability( const Mat &wrappedPhaseMap, const Mat &shadowMask );
     // Compute edges reliability and sort them in the histogram
     void computeEdgesReliabilityAndCreateHistogram();
-    // Methods that is used in the previous one
-    void createAndSortEdge( int idx1, int idx2 );
+    // Bin of the histogram in which an edge of this reliability is sorted
+    int getBinIndex( float edgeReliability, float smallWidth, float largeWidth ) const;
+    // Returns the group of a pixel and the number of 2pi that needs to be added to it
+    int findGroup( int idx, int &inc );
     // Unwrap the phase map thanks to the histogram
     void unwrapHistogram();
     // add right number of 2*pi to the pixels
     void addIncrement( OutputArray unwrappedPhaseMap );
     // Gamma function from the paper
-    float wrap( float a, float b );
+    float wrap( float a, float b ) const;
     // Similar to the previous one but returns the number of 2pi that needs to be added
-    int findInc( float a, float b );
+    int findInc( float a, float b ) const;
 };
 // Default parameters
 HistogramPhaseUnwrapping::Params::Params(){
@@ -185,201 +117,6 @@ HistogramPhaseUnwrapping_Impl::HistogramPhaseUnwrapping_Impl(
 
 }
 
-HistogramPhaseUnwrapping_Impl::Pixel::Pixel()
-{
-
-}
-// Constructor
-HistogramPhaseUnwrapping_Impl::Pixel::Pixel( float pV, int id, bool v, float iR, int inc )
-{
-    phaseValue = pV;
-    idx = id;
-    valid = v;
-    inverseReliability = iR;
-    increment = inc;
-    nbrOfPixelsInGroup = 1;
-    groupId = id;
-    singlePixelGroup = true;
-}
-
-float HistogramPhaseUnwrapping_Impl::Pixel::getPhaseValue()
-{
-    return phaseValue;
-}
-
-int HistogramPhaseUnwrapping_Impl::Pixel::getIndex()
-{
-    return idx;
-}
-
-bool HistogramPhaseUnwrapping_Impl::Pixel::getValidity()
-{
-    return valid;
-}
-
-float HistogramPhaseUnwrapping_Impl::Pixel::getInverseReliability()
-{
-    return inverseReliability;
-}
-
-int HistogramPhaseUnwrapping_Impl::Pixel::getIncrement()
-{
-    return increment;
-}
-
-int HistogramPhaseUnwrapping_Impl::Pixel::getNbrOfPixelsInGroup()
-{
-    return nbrOfPixelsInGroup;
-}
-
-int HistogramPhaseUnwrapping_Impl::Pixel::getGroupId()
-{
-    return groupId;
-}
-
-bool HistogramPhaseUnwrapping_Impl::Pixel::getSinglePixelGroup()
-{
-    return singlePixelGroup;
-}
-
-void HistogramPhaseUnwrapping_Impl::Pixel::setIncrement( int inc )
-{
-    increment = inc;
-}
-/* When a pixel of a non-single group is added to an other non-single group, we need to add a new
-increment to the one that was there previously and that was already removing some wraps.
-*/
-void HistogramPhaseUnwrapping_Impl::Pixel::changeIncrement( int inc )
-{
-    increment += inc;
-}
-
-void HistogramPhaseUnwrapping_Impl::Pixel::setNbrOfPixelsInGroup( int nbr )
-{
-    nbrOfPixelsInGroup = nbr;
-}
-void HistogramPhaseUnwrapping_Impl::Pixel::setGroupId( int gId )
-{
-    groupId = gId;
-}
-
-void HistogramPhaseUnwrapping_Impl::Pixel::setSinglePixelGroup( bool s )
-{
-    singlePixelGroup = s;
-}
-
-HistogramPhaseUnwrapping_Impl::Edge::Edge()
-{
-
-}
-// Constructor
-HistogramPhaseUnwrapping_Impl::Edge::Edge( int p1, int p2, int inc )
-{
-    pixOneId = p1;
-    pixTwoId = p2;
-    increment = inc;
-}
-
-int HistogramPhaseUnwrapping_Impl::Edge::getPixOneId()
-{
-    return pixOneId;
-}
-
-int HistogramPhaseUnwrapping_Impl::Edge::getPixTwoId()
-{
-    return pixTwoId;
-}
-
-int HistogramPhaseUnwrapping_Impl::Edge::getIncrement()
-{
-    return increment;
-}
-
-HistogramPhaseUnwrapping_Impl::HistogramBin::HistogramBin()
-{
-
-}
-
-HistogramPhaseUnwrapping_Impl::HistogramBin::HistogramBin( float s, float e )
-{
-    start = s;
-    end = e;
-}
-
-void HistogramPhaseUnwrapping_Impl::HistogramBin::addEdge( Edge e )
-{
-    edges.push_back(e);
-}
-std::vector<HistogramPhaseUnwrapping_Impl::Edge> HistogramPhaseUnwrapping_Impl::HistogramBin::getEdges()
-{
-    return edges;
-}
-HistogramPhaseUnwrapping_Impl::Histogram::Histogram()
-{
-
-}
-/*
- * create histogram bins. Bins size is not uniform, as in the reference paper
- *
- */
-void HistogramPhaseUnwrapping_Impl::Histogram::createBins( float t, int nbrOfBinsBeforeThresh,
-                                                           int nbrOfBinsAfterThresh )
-{
-    thresh = t;
-
-    nbrOfSmallBins = nbrOfBinsBeforeThresh;
-    nbrOfLargeBins = nbrOfBinsAfterThresh;
-    nbrOfBins = nbrOfBinsBeforeThresh + nbrOfBinsAfterThresh;
-
-    smallWidth = thresh / nbrOfSmallBins;
-    largeWidth = static_cast<float>(32 * CV_PI * CV_PI - thresh) / static_cast<float>(nbrOfLargeBins);
-
-    for( int i = 0; i < nbrOfSmallBins; ++i )
-    {
-        addBin(HistogramBin(i * smallWidth, ( i + 1 ) * smallWidth));
-    }
-    for( int i = 0; i < nbrOfLargeBins; ++i )
-    {
-        addBin(HistogramBin(thresh + i * largeWidth, thresh + ( i + 1 ) * largeWidth));
-    }
-}
-// Add a bin b to the histogram
-void HistogramPhaseUnwrapping_Impl::Histogram::addBin( HistogramBin b )
-{
-    bins.push_back(b);
-}
-// Add edge E in bin binIndex
-void HistogramPhaseUnwrapping_Impl::Histogram::addEdgeInBin( Edge e, int binIndex )
-{
-    bins[binIndex].addEdge(e);
-}
-float HistogramPhaseUnwrapping_Impl::Histogram::getThresh()
-{
-    return thresh;
-}
-
-float HistogramPhaseUnwrapping_Impl::Histogram::getSmallWidth()
-{
-    return smallWidth;
-}
-
-float HistogramPhaseUnwrapping_Impl::Histogram::getLargeWidth()
-{
-    return largeWidth;
-}
-
-int HistogramPhaseUnwrapping_Impl::Histogram::getNbrOfBins()
-{
-    return nbrOfBins;
-}
-
-std::vector<HistogramPhaseUnwrapping_Impl::Edge> HistogramPhaseUnwrapping_Impl::
-                                                 Histogram::getEdgesFromBin( int binIndex )
-{
-    std::vector<HistogramPhaseUnwrapping_Impl::Edge> temp;
-    temp = bins[binIndex].getEdges();
-    return temp;
-}
 /* Method in which reliabilities are computed and edges are sorted in the histogram.
 Increments are computed for each pixels.
  */
@@ -404,6 +141,8 @@ void HistogramPhaseUnwrapping_Impl::unwrapPhaseMap( InputArray wrappedPhaseMap,
 
     CV_CheckTypeEQ(wPhaseMap.type(), CV_32FC1, "");
     CV_CheckTypeEQ(mask.type(), CV_8UC1, "");
+    CV_Assert( wPhaseMap.rows >= rows && wPhaseMap.cols >= cols );
+    CV_Assert( mask.rows >= rows && mask.cols >= cols );
 
     computePixelsReliability(wPhaseMap, mask);
     computeEdgesReliabilityAndCreateHistogram();
@@ -414,297 +153,283 @@ void HistogramPhaseUnwrapping_Impl::unwrapPhaseMap( InputArray wrappedPhaseMap,
 
 //compute pixels reliabilities according to "A novel algorithm based on histogram processing of reliability for two-dimensional phase unwrapping"
 
-void HistogramPhaseUnwrapping_Impl::computePixelsReliability( InputArray wrappedPhaseMap,
-                                                              InputArray shadowMask )
+void HistogramPhaseUnwrapping_Impl::computePixelsReliability( const Mat &wPhaseMap,
+                                                              const Mat &mask )
 {
     int rows = params.height;
     int cols = params.width;
 
-    Mat &wPhaseMap = *(Mat*) wrappedPhaseMap.getObj();
-    Mat &mask = *(Mat*) shadowMask.getObj();
-
-    int idx; //idx is used to store pixel position (idx = i*cols + j)
-    bool valid;//tells if a pixel is in the valid mask region
+    wPhaseMap(Rect(0, 0, cols, rows)).copyTo(phaseMap);
+    inverseReliability.create(rows, cols, CV_32FC1);
+    valid.create(rows, cols, CV_8UC1);
 
-    // H, V, D1, D2 are from the paper
-    float H, V, D1, D2, D;
-    /* used to store neighbours coordinates
-     * ul = upper left, um = upper middle, ur = upper right
-     * ml = middle left, mr = middle right
-     * ll = lower left, lm = lower middle, lr = lower right
-     */
-    Point ul, um, ur, ml, mr, ll, lm, lr;
+    const float maxInverseReliability = static_cast<float>(16 * CV_PI * CV_PI);
 
-    for( int i = 0; i < rows; ++i )
+    parallel_for_(Range(0, rows), [&](const Range& range)
     {
-        for( int j = 0; j < cols; ++j )
+        for( int i = range.start; i < range.end; ++i )
         {
-            if( mask.at<uchar>( i, j ) != 0 ) //if pixel is in a valid region
+            const uchar *m = mask.ptr<uchar>(i);
+            const float *p = phaseMap.ptr<float>(i);
+            float *invRel = inverseReliability.ptr<float>(i);
+            uchar *v = valid.ptr<uchar>(i);
+            for( int j = 0; j < cols; ++j )
             {
-                if( i == 0 || i == rows - 1 || j == 0 || j == cols - 1 )
+                if( m[j] == 0 ) // pixel is not in a valid region. It's inverse reliability is set to the maximum
                 {
-                    idx = i * cols + j;
-                    valid = true;
-                    Pixel p(wPhaseMap.at<float>(i, j), idx, valid,
-                            static_cast<float>(16 * CV_PI * CV_PI), 0);
-                    pixels.push_back(p);
+                    v[j] = 0;
+                    invRel[j] = maxInverseReliability;
+                    continue;
                 }
-                else
+                v[j] = 1;
+                /* if one of the neighbouring pixel is not valid (255 in the mask), pixel (i,j) is
+                 * considered as being on the border.
+                 */
+                bool border = i == 0 || i == rows - 1 || j == 0 || j == cols - 1;
+                for( int y = -1; y <= 1 && !border; ++y )
                 {
-                    ul = Point(j-1, i-1);
-                    um = Point(j, i-1);
-                    ur = Point(j+1, i-1);
-                    ml = Point(j-1, i);
-                    mr = Point(j+1, i);
-                    ll = Point(j-1, i+1);
-                    lm = Point(j, i+1);
-                    lr = Point(j+1, i+1);
-
-                    Mat neighbourhood = mask( Rect( j-1, i-1, 3, 3 ) );
-                    Scalar meanValue = mean(neighbourhood);
-
-                    /* if mean value is different from 255, it means that one of the neighbouring
-                     * pixel is not valid -> pixel (i,j) is considered as being on the border.
-                     */
-                    if( meanValue[0] != 255 )
-                    {
-                        idx = i * cols + j;
-                        valid = true;
-                        Pixel p(wPhaseMap.at<float>(i, j), idx, valid,
-                                static_cast<float>(16 * CV_PI * CV_PI), 0);
-                        pixels.push_back(p);
-                    }
-                    else
-                    {
-                        H = wrap(wPhaseMap.at<float>(ml.y, ml.x), wPhaseMap.at<float>(i, j))
-                            - wrap(wPhaseMap.at<float>(i, j), wPhaseMap.at<float>(mr.y, mr.x));
-                        V = wrap(wPhaseMap.at<float>(um.y, um.x), wPhaseMap.at<float>(i, j))
-                            - wrap(wPhaseMap.at<float>(i, j), wPhaseMap.at<float>(lm.y, lm.x));
-                        D1 = wrap(wPhaseMap.at<float>(ul.y, ul.x), wPhaseMap.at<float>(i, j))
-                            - wrap(wPhaseMap.at<float>(i, j), wPhaseMap.at<float>(lr.y, lr.x));
-                        D2 = wrap(wPhaseMap.at<float>(ur.y, ur.x), wPhaseMap.at<float>(i, j))
-                            - wrap(wPhaseMap.at<float>(i, j), wPhaseMap.at<float>(ll.y, ll.x));
-                        D = H * H + V * V + D1 * D1 + D2 * D2;
-
-                        idx = i * cols + j;
-                        valid = true;
-                        Pixel p(wPhaseMap.at<float>(i, j), idx, valid, D, 0);
-                        pixels.push_back(p);
-                    }
+                    const uchar *mn = mask.ptr<uchar>(i + y);
+                    border = mn[j - 1] != 255 || mn[j] != 255 || mn[j + 1] != 255;
                 }
+                if( border )
+                {
+                    invRel[j] = maxInverseReliability;
+                    continue;
+                }
+                /* neighbours of (i,j): u = upper row, l = lower row
+                 * H, V, D1, D2 are from the paper
+                 */
+                const float *u = phaseMap.ptr<float>(i - 1);
+                const float *l = phaseMap.ptr<float>(i + 1);
+                float H = wrap(p[j - 1], p[j]) - wrap(p[j], p[j + 1]);
+                float V = wrap(u[j], p[j]) - wrap(p[j], l[j]);
+                float D1 = wrap(u[j - 1], p[j]) - wrap(p[j], l[j + 1]);
+                float D2 = wrap(u[j + 1], p[j]) - wrap(p[j], l[j - 1]);
+                invRel[j] = H * H + V * V + D1 * D1 + D2 * D2;
             }
-            else // pixel is not in a valid region. It's inverse reliability is set to the maximum
-            {
-                idx = i * cols + j;
-                valid = false;
-                Pixel p(wPhaseMap.at<float>(i, j), idx, valid,
-                        static_cast<float>(16 * CV_PI * CV_PI), 0);
-                pixels.push_back(p);
-            }
+        }
+    }, std::max(1, rows / 32));
+}
+
+int HistogramPhaseUnwrapping_Impl::getBinIndex( float edgeReliability, float smallWidth, float largeWidth ) const
+{
+    int binIndex;
+    if( edgeReliability < params.histThresh )
+    {
+        binIndex = static_cast<int> (ceil(edgeReliability / smallWidth) - 1);
+        if( binIndex == -1 )
+        {
+            binIndex = 0;
         }
     }
+    else
+    {
+        binIndex = params.nbrOfSmallBins +
+                   static_cast<int> (ceil((edgeReliability - params.histThresh) / largeWidth) - 1);
+    }
+    return std::min(binIndex, params.nbrOfSmallBins + params.nbrOfLargeBins - 1);
 }
-/* Edges are created from the vector of pixels. We loop on the vector and create the edges
- * that link the current pixel to his right neighbour (first edge) and the one that is under it (second edge)
+
+/* Edges link a valid pixel to his right neighbour (first edge) and the one that is under it (second edge)
+ * if they are valid too. They are counting sorted in the histogram: the bins of the edges are computed
+ * in bands of rows in parallel, then every band writes its edges after the ones of the previous bands.
  */
 void HistogramPhaseUnwrapping_Impl::computeEdgesReliabilityAndCreateHistogram()
 {
-    int row;
-    int col;
-    histogram.createBins(params.histThresh, params.nbrOfSmallBins, params.nbrOfLargeBins);
-    int nbrOfPixels = static_cast<int>(pixels.size());
-    /* Edges are built by considering a pixel and it's right-neighbour and lower-neighbour.
-     We discard non-valid pixels here.
-     */
-    for( int i = 0; i < nbrOfPixels; ++i )
+    int rows = params.height;
+    int cols = params.width;
+    int nbrOfBins = params.nbrOfSmallBins + params.nbrOfLargeBins;
+    CV_Assert( params.nbrOfSmallBins > 0 && params.nbrOfLargeBins > 0 && nbrOfBins < 128 );
+
+    float smallWidth = params.histThresh / params.nbrOfSmallBins;
+    float largeWidth = static_cast<float>(32 * CV_PI * CV_PI - params.histThresh) /
+                       static_cast<float>(params.nbrOfLargeBins);
+
+    const int bandHeight = 32;
+    const int nbrOfBands = (rows + bandHeight - 1) / bandHeight;
+    // bins of the right and lower edges of every pixel, -1 where there is no edge
+    Mat binRight(rows, cols, CV_8SC1), binDown(rows, cols, CV_8SC1);
+    std::vector<int> bandCounts((size_t)nbrOfBands * nbrOfBins, 0);
+
+    parallel_for_(Range(0, nbrOfBands), [&](const Range& range)
     {
-        if( pixels[i].getValidity() )
+        for( int band = range.start; band < range.end; ++band )
         {
-            row = pixels[i].getIndex() / params.width;
-            col = pixels[i].getIndex() % params.width;
-
-            if( row != params.height - 1 && col != params.width -1 )
-            {
-                int idxRight, idxDown;
-                idxRight = row * params.width + col + 1; // Pixel to the right
-                idxDown = ( row + 1 ) * params.width + col; // Pixel under pixel i.
-                createAndSortEdge(i, idxRight);
-                createAndSortEdge(i, idxDown);
-            }
-            else if( row != params.height - 1 && col == params.width - 1 )
+            int *counts = &bandCounts[(size_t)band * nbrOfBins];
+            for( int i = band * bandHeight; i < std::min(rows, (band + 1) * bandHeight); ++i )
             {
-                int idxDown = ( row + 1 ) * params.width + col;
-                createAndSortEdge(i, idxDown);
-            }
-            else if( row == params.height - 1 && col != params.width - 1 )
-            {
-                int idxRight = row * params.width + col + 1;
-                createAndSortEdge(i, idxRight);
+                const uchar *v = valid.ptr<uchar>(i);
+                const uchar *vDown = valid.ptr<uchar>(std::min(i + 1, rows - 1));
+                const float *invRel = inverseReliability.ptr<float>(i);
+                const float *invRelDown = inverseReliability.ptr<float>(std::min(i + 1, rows - 1));
+                schar *right = binRight.ptr<schar>(i);
+                schar *down = binDown.ptr<schar>(i);
+                for( int j = 0; j < cols; ++j )
+                {
+                    right[j] = down[j] = -1;
+                    if( !v[j] )
+                        continue;
+                    if( j != cols - 1 && v[j + 1] )
+                    {
+                        right[j] = (schar)getBinIndex(invRel[j] + invRel[j + 1], smallWidth, largeWidth);
+                        counts[right[j]]++;
+                    }
+                    if( i != rows - 1 && vDown[j] )
+                    {
+                        down[j] = (schar)getBinIndex(invRel[j] + invRelDown[j], smallWidth, largeWidth);
+                        counts[down[j]]++;
+                    }
+                }
             }
         }
-    }
-}
-/*used along the previous method to sort edges in the histogram*/
-void HistogramPhaseUnwrapping_Impl::createAndSortEdge( int idx1, int idx2 )
-{
-    if( pixels[idx2].getValidity() )
+    });
+
+    // start of every bin, then of every band inside of a bin
+    binOffsets.assign(nbrOfBins + 1, 0);
+    std::vector<int> bandStarts((size_t)nbrOfBands * nbrOfBins);
+    int total = 0;
+    for( int b = 0; b < nbrOfBins; ++b )
     {
-        float edgeReliability = pixels[idx1].getInverseReliability() +
-                                pixels[idx2].getInverseReliability();
-        int inc = findInc(pixels[idx2].getPhaseValue(), pixels[idx1].getPhaseValue());
-        Edge e(idx1, idx2, inc);
+        binOffsets[b] = total;
+        for( int band = 0; band < nbrOfBands; ++band )
+        {
+            bandStarts[(size_t)band * nbrOfBins + b] = total;
+            total += bandCounts[(size_t)band * nbrOfBins + b];
+        }
+    }
+    binOffsets[nbrOfBins] = total;
+    edges.resize(total);
 
-        if( edgeReliability < histogram.getThresh() )
+    parallel_for_(Range(0, nbrOfBands), [&](const Range& range)
+    {
+        for( int band = range.start; band < range.end; ++band )
         {
-            int binIndex = static_cast<int> (ceil(edgeReliability / histogram.getSmallWidth()) - 1);
-            if( binIndex == -1 )
+            int *pos = &bandStarts[(size_t)band * nbrOfBins];
+            for( int i = band * bandHeight; i < std::min(rows, (band + 1) * bandHeight); ++i )
             {
-                binIndex = 0;
+                const schar *right = binRight.ptr<schar>(i);
+                const schar *down = binDown.ptr<schar>(i);
+                for( int j = 0; j < cols; ++j )
+                {
+                    int idx = i * cols + j;
+                    if( right[j] >= 0 )
+                    {
+                        Edge e = { idx, idx + 1 };
+                        edges[pos[right[j]]++] = e;
+                    }
+                    if( down[j] >= 0 )
+                    {
+                        Edge e = { idx, idx + cols };
+                        edges[pos[down[j]]++] = e;
+                    }
+                }
             }
-            histogram.addEdgeInBin(e, binIndex);
-        }
-        else
-        {
-            int binIndex = params.nbrOfSmallBins +
-                           static_cast<int> (ceil((edgeReliability - histogram.getThresh()) /
-                                 histogram.getLargeWidth()) - 1);
-            histogram.addEdgeInBin(e, binIndex);
         }
+    });
+}
+
+int HistogramPhaseUnwrapping_Impl::findGroup( int idx, int &inc )
+{
+    int root = idx;
+    int sum = 0;
+    while( parent[root] != root )
+    {
+        sum += increment[root];
+        root = parent[root];
+    }
+    inc = sum + increment[root];
+    // path compression, the increments become relative to the root
+    while( parent[idx] != idx )
+    {
+        int next = parent[idx];
+        int relativeInc = increment[idx];
+        parent[idx] = root;
+        increment[idx] = sum;
+        sum -= relativeInc;
+        idx = next;
     }
+    return root;
 }
 
 void HistogramPhaseUnwrapping_Impl::unwrapHistogram()
 {
-    int nbrOfPixels = static_cast<int>(pixels.size());
-    int nbrOfBins = histogram.getNbrOfBins();
-    /* This vector is used to keep track of the number of pixels in each group and avoid useless group.
-       For example, if lastPixelAddedToGroup[10] is equal to 5, it means that pixel "5" was the last one
-       to be added to group 10. So, pixel "5" is the only one that has the correct value for parameter
-       "numberOfPixelsInGroup" in order to avoid a loop on all the pixels to update this number*/
-    std::vector<int> lastPixelAddedToGroup(nbrOfPixels, 0);
-    for( int i = 0; i < nbrOfBins; ++i )
-    {
-        std::vector<Edge> currentEdges = histogram.getEdgesFromBin(i);
-        int nbrOfEdgesInBin = static_cast<int>(currentEdges.size());
+    int nbrOfPixels = params.height * params.width;
+    int nbrOfEdges = static_cast<int>(edges.size());
+    const float *phase = phaseMap.ptr<float>();
+    const float *invRel = inverseReliability.ptr<float>();
 
-        for( int j = 0; j < nbrOfEdgesInBin; ++j )
-        {
+    // every pixel starts in its own group, the root of a group keeps the increment of its own pixel
+    parent.resize(nbrOfPixels);
+    for( int i = 0; i < nbrOfPixels; ++i )
+        parent[i] = i;
+    increment.assign(nbrOfPixels, 0);
+    groupSize.assign(nbrOfPixels, 1);
 
-            int pOneId = currentEdges[j].getPixOneId();
-            int pTwoId = currentEdges[j].getPixTwoId();
-            // Both pixels are in a single group.
-            if( pixels[pOneId].getSinglePixelGroup() && pixels[pTwoId].getSinglePixelGroup() )
+    for( int j = 0; j < nbrOfEdges; ++j )
+    {
+        int pOneId = edges[j].pixOneId;
+        int pTwoId = edges[j].pixTwoId;
+        // Number of 2pi that needs to be added to the second pixel to remove discontinuities
+        int edgeInc = findInc(phase[pTwoId], phase[pOneId]);
+        int incOne, incTwo;
+        int pOneGroupId = findGroup(pOneId, incOne);
+        int pTwoGroupId = findGroup(pTwoId, incTwo);
+        bool pOneSingle = groupSize[pOneGroupId] == 1;
+        bool pTwoSingle = groupSize[pTwoGroupId] == 1;
+        // Both pixels are in a single group.
+        if( pOneSingle && pTwoSingle )
+        {
+            // Quality of pixel 2 is better than that of pixel 1 -> pixel 1 is added to group 2
+            if( invRel[pOneId] > invRel[pTwoId] )
             {
-                float invRel1 = pixels[pOneId].getInverseReliability();
-                float invRel2 = pixels[pTwoId].getInverseReliability();
-                // Quality of pixel 2 is better than that of pixel 1 -> pixel 1 is added to group 2
-                if( invRel1 > invRel2 )
-                {
-                    int newGroupId = pixels[pTwoId].getGroupId();
-                    int newInc = pixels[pTwoId].getIncrement() + currentEdges[j].getIncrement();
-                    pixels[pOneId].setGroupId(newGroupId);
-                    pixels[pOneId].setIncrement(newInc);
-                    lastPixelAddedToGroup[newGroupId] = pOneId; // Pixel 1 is the last one to be added to group 2
-                }
-                else
-                {
-                    int newGroupId = pixels[pOneId].getGroupId();
-                    int newInc = pixels[pOneId].getIncrement() - currentEdges[j].getIncrement();
-                    pixels[pTwoId].setGroupId(newGroupId);
-                    pixels[pTwoId].setIncrement(newInc);
-                    lastPixelAddedToGroup[newGroupId] = pTwoId;
-                }
-                pixels[pOneId].setNbrOfPixelsInGroup(2);
-                pixels[pTwoId].setNbrOfPixelsInGroup(2);
-                pixels[pOneId].setSinglePixelGroup(false);
-                pixels[pTwoId].setSinglePixelGroup(false);
+                parent[pOneId] = pTwoGroupId;
+                increment[pOneId] = incTwo + edgeInc - increment[pTwoGroupId];
+                groupSize[pTwoGroupId] = 2;
             }
-            //p1 is in a single group, p2 is not -> p1 added to p2
-            else if( pixels[pOneId].getSinglePixelGroup() && !pixels[pTwoId].getSinglePixelGroup() )
+            else
             {
-                int newGroupId = pixels[pTwoId].getGroupId();
-                int lastPix = lastPixelAddedToGroup[newGroupId];
-                int newNbrOfPixelsInGroup = pixels[lastPix].getNbrOfPixelsInGroup() + 1;
-                int newInc = pixels[pTwoId].getIncrement() + currentEdges[j].getIncrement();
-
-                pixels[pOneId].setGroupId(newGroupId);
-                pixels[pOneId].setNbrOfPixelsInGroup(newNbrOfPixelsInGroup);
-                pixels[pTwoId].setNbrOfPixelsInGroup(newNbrOfPixelsInGroup);
-                pixels[pOneId].setIncrement(newInc);
-                pixels[pOneId].setSinglePixelGroup(false);
-
-                lastPixelAddedToGroup[newGroupId] = pOneId;
+                parent[pTwoId] = pOneGroupId;
+                increment[pTwoId] = incOne - edgeInc - increment[pOneGroupId];
+                groupSize[pOneGroupId] = 2;
             }
-            //p2 is in a single group, p1 is not -> p2 added to p1
-            else if( !pixels[pOneId].getSinglePixelGroup() && pixels[pTwoId].getSinglePixelGroup() )
+        }
+        //p1 is in a single group, p2 is not -> p1 added to p2
+        else if( pOneSingle )
+        {
+            parent[pOneId] = pTwoGroupId;
+            increment[pOneId] = incTwo + edgeInc - increment[pTwoGroupId];
+            groupSize[pTwoGroupId]++;
+        }
+        //p2 is in a single group, p1 is not -> p2 added to p1
+        else if( pTwoSingle )
+        {
+            parent[pTwoId] = pOneGroupId;
+            increment[pTwoId] = incOne - edgeInc - increment[pOneGroupId];
+            groupSize[pOneGroupId]++;
+        }
+        //p1 and p2 are in two different groups
+        else if( pOneGroupId != pTwoGroupId )
+        {
+            int nbrOfPixelsInGroupOne = groupSize[pOneGroupId];
+            int nbrOfPixelsInGroupTwo = groupSize[pTwoGroupId];
+            int totalNbrOfPixels = nbrOfPixelsInGroupOne + nbrOfPixelsInGroupTwo;
+
+            /* When a group is added to an other one, the increment of all of its pixels changes by inc,
+             * that is added to the increment of its root, which becomes relative to the new root */
+            if( nbrOfPixelsInGroupOne < nbrOfPixelsInGroupTwo ||
+               (nbrOfPixelsInGroupOne == nbrOfPixelsInGroupTwo && invRel[pOneId] >= invRel[pTwoId]) ) //group p1 added to group p2
             {
-                int newGroupId = pixels[pOneId].getGroupId();
-                int lastPix = lastPixelAddedToGroup[newGroupId];
-                int newNbrOfPixelsInGroup = pixels[lastPix].getNbrOfPixelsInGroup() + 1;
-                int newInc = pixels[pOneId].getIncrement() - currentEdges[j].getIncrement();
-
-                pixels[pTwoId].setGroupId(newGroupId);
-                pixels[pTwoId].setNbrOfPixelsInGroup(newNbrOfPixelsInGroup);
-                pixels[pOneId].setNbrOfPixelsInGroup(newNbrOfPixelsInGroup);
-                pixels[pTwoId].setIncrement(newInc);
-                pixels[pTwoId].setSinglePixelGroup(false);
-
-                lastPixelAddedToGroup[newGroupId] = pTwoId;
+                int inc = incTwo + edgeInc - incOne;
+                parent[pOneGroupId] = pTwoGroupId;
+                increment[pOneGroupId] += inc - increment[pTwoGroupId];
+                groupSize[pTwoGroupId] = totalNbrOfPixels;
             }
-            //p1 and p2 are in two different groups
-            else if( pixels[pOneId].getGroupId() != pixels[pTwoId].getGroupId() )
+            else //group p2 added to group p1
             {
-                int pOneGroupId = pixels[pOneId].getGroupId();
-                int pTwoGroupId = pixels[pTwoId].getGroupId();
-
-                float invRel1 = pixels[pOneId].getInverseReliability();
-                float invRel2 = pixels[pTwoId].getInverseReliability();
-
-                int lastAddedToGroupOne = lastPixelAddedToGroup[pOneGroupId];
-                int lastAddedToGroupTwo = lastPixelAddedToGroup[pTwoGroupId];
-
-                int nbrOfPixelsInGroupOne = pixels[lastAddedToGroupOne].getNbrOfPixelsInGroup();
-                int nbrOfPixelsInGroupTwo = pixels[lastAddedToGroupTwo].getNbrOfPixelsInGroup();
-
-                int totalNbrOfPixels = nbrOfPixelsInGroupOne + nbrOfPixelsInGroupTwo;
-
-                if( nbrOfPixelsInGroupOne < nbrOfPixelsInGroupTwo ||
-                   (nbrOfPixelsInGroupOne == nbrOfPixelsInGroupTwo && invRel1 >= invRel2) ) //group p1 added to group p2
-                {
-                    pixels[pTwoId].setNbrOfPixelsInGroup(totalNbrOfPixels);
-                    pixels[pOneId].setNbrOfPixelsInGroup(totalNbrOfPixels);
-                    int inc = pixels[pTwoId].getIncrement() + currentEdges[j].getIncrement() -
-                                 pixels[pOneId].getIncrement();
-                    lastPixelAddedToGroup[pTwoGroupId] = pOneId;
-
-                    for( int k = 0; k < nbrOfPixels; ++k )
-                    {
-                        if( pixels[k].getGroupId() == pOneGroupId )
-                        {
-                            pixels[k].setGroupId(pTwoGroupId);
-                            pixels[k].changeIncrement(inc);
-                        }
-                    }
-                }
-                else if( nbrOfPixelsInGroupOne > nbrOfPixelsInGroupTwo ||
-                        (nbrOfPixelsInGroupOne == nbrOfPixelsInGroupTwo && invRel2 > invRel1) ) //group p2 added to group p1
-                {
-                    int oldGroupId = pTwoGroupId;
-                    pixels[pOneId].setNbrOfPixelsInGroup(totalNbrOfPixels);
-                    pixels[pTwoId].setNbrOfPixelsInGroup(totalNbrOfPixels);
-                    int inc = pixels[pOneId].getIncrement() - currentEdges[j].getIncrement() -
-                              pixels[pTwoId].getIncrement();
-                    lastPixelAddedToGroup[pOneGroupId] = pTwoId;
-
-                    for( int k = 0; k < nbrOfPixels; ++k )
-                    {
-                        if( pixels[k].getGroupId() == oldGroupId )
-                        {
-                            pixels[k].setGroupId(pOneGroupId);
-                            pixels[k].changeIncrement(inc);
-                        }
-                    }
-                }
+                int inc = incOne - edgeInc - incTwo;
+                parent[pTwoGroupId] = pOneGroupId;
+                increment[pTwoGroupId] += inc - increment[pOneGroupId];
+                groupSize[pOneGroupId] = totalNbrOfPixels;
             }
         }
     }
@@ -719,20 +444,28 @@ void HistogramPhaseUnwrapping_Impl::addIncrement( OutputArray unwrappedPhaseMap
         uPhaseMap.create(rows, cols, CV_32FC1);
         uPhaseMap = Scalar::all(0);
     }
-    int nbrOfPixels = static_cast<int>(pixels.size());
+    // absolute increments, the groups are flattened first so that the pixels can be read in parallel
+    int nbrOfPixels = rows * cols;
+    std::vector<int> inc(nbrOfPixels);
     for( int i = 0; i < nbrOfPixels; ++i )
-    {
-        int row = pixels[i].getIndex() / params.width;
-        int col = pixels[i].getIndex() % params.width;
+        findGroup(i, inc[i]);
 
-        if( pixels[i].getValidity() )
+    parallel_for_(Range(0, rows), [&](const Range& range)
+    {
+        for( int i = range.start; i < range.end; ++i )
         {
-            uPhaseMap.at<float>(row, col) = pixels[i].getPhaseValue() +
-                                            static_cast<float>(2 * CV_PI * pixels[i].getIncrement());
+            const float *phase = phaseMap.ptr<float>(i);
+            const uchar *v = valid.ptr<uchar>(i);
+            float *dst = uPhaseMap.ptr<float>(i);
+            for( int j = 0; j < cols; ++j )
+            {
+                if( v[j] )
+                    dst[j] = phase[j] + static_cast<float>(2 * CV_PI * inc[i * cols + j]);
+            }
         }
-    }
+    }, std::max(1, rows / 32));
 }
-float HistogramPhaseUnwrapping_Impl::wrap( float a, float b )
+float HistogramPhaseUnwrapping_Impl::wrap( float a, float b ) const
 {
     float result;
     float difference = a - b;
@@ -746,7 +479,7 @@ float HistogramPhaseUnwrapping_Impl::wrap( float a, float b )
     return result;
 }
 
-int HistogramPhaseUnwrapping_Impl::findInc( float a, float b )
+int HistogramPhaseUnwrapping_Impl::findInc( float a, float b ) const
 {
     float difference;
     int wrapValue;
@@ -764,19 +497,8 @@ int HistogramPhaseUnwrapping_Impl::findInc( float a, float b )
 //create a Mat that shows pixel inverse reliabilities
 void HistogramPhaseUnwrapping_Impl::getInverseReliabilityMap( OutputArray inverseReliabilityMap )
 {
-    int rows = params.height;
-    int cols = params.width;
     Mat &reliabilityMap_ = *(Mat*) inverseReliabilityMap.getObj();
-    if( reliabilityMap_.empty() )
-        reliabilityMap_.create(rows, cols, CV_32FC1);
-    for( int i = 0; i < rows; ++i )
-    {
-        for( int j = 0; j < cols; ++j )
-        {
-            int idx = i * cols + j;
-            reliabilityMap_.at<float>(i, j) = pixels[idx].getInverseReliability();
-        }
-    }
+    inverseReliability.copyTo(reliabilityMap_);
 }
 
 Ptr<HistogramPhaseUnwrapping> HistogramPhaseUnwrapping::create( const HistogramPhaseUnwrapping::Params
@@ -63,4 +63,56 @@ TEST( HistogramPhaseUnwrapping, unwrapPhaseMap )
     test.safe_run();
 }
 
+TEST( HistogramPhaseUnwrapping, shadowMaskAndRepeatedCalls )
+{
+    const int rows = 120, cols = 160;
+    Mat ramp(rows, cols, CV_32FC1), wrappedRamp(rows, cols, CV_32FC1);
+    for( int i = 0; i < rows; ++i )
+    {
+        for( int j = 0; j < cols; ++j )
+        {
+            float v = 0.3f * j + 0.2f * i;
+            ramp.at<float>(i, j) = v;
+            wrappedRamp.at<float>(i, j) = atan2(sin(v), cos(v));
+        }
+    }
+    // a shadow stripe splits the map in two regions
+    Mat mask(rows, cols, CV_8UC1, Scalar::all(255));
+    mask.colRange(70, 80).setTo(Scalar::all(0));
+
+    phase_unwrapping::HistogramPhaseUnwrapping::Params params;
+    params.width = cols;
+    params.height = rows;
+    Ptr<phase_unwrapping::HistogramPhaseUnwrapping> phaseUnwrapping = phase_unwrapping::HistogramPhaseUnwrapping::create(params);
+
+    Mat unwrapped, unwrappedAgain, reliability;
+    phaseUnwrapping->unwrapPhaseMap(wrappedRamp, unwrapped, mask);
+    phaseUnwrapping->getInverseReliabilityMap(reliability);
+    phaseUnwrapping->unwrapPhaseMap(wrappedRamp, unwrappedAgain, mask);
+
+    ASSERT_EQ(Size(cols, rows), reliability.size());
+    EXPECT_EQ(0, cvtest::norm(unwrapped, unwrappedAgain, NORM_INF));
+
+    // every region is unwrapped up to a constant number of 2pi
+    Range regions[] = { Range(0, 70), Range(80, cols) };
+    for( int r = 0; r < 2; ++r )
+    {
+        float offset = unwrapped.at<float>(0, regions[r].start) - ramp.at<float>(0, regions[r].start);
+        for( int i = 0; i < rows; ++i )
+        {
+            for( int j = regions[r].start; j < regions[r].end; ++j )
+            {
+                EXPECT_NEAR(ramp.at<float>(i, j) + offset, unwrapped.at<float>(i, j), 0.001);
+            }
+        }
+    }
+    for( int i = 0; i < rows; ++i )
+    {
+        for( int j = 70; j < 80; ++j )
+        {
+            EXPECT_EQ(0, unwrapped.at<float>(i, j));
+        }
+    }
+}
+
 }} // namespace
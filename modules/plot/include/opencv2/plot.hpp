@@ -94,6 +94,30 @@ namespace cv
              * @param pointIdx index of the required point in data array.
              */
             CV_WRAP virtual void setPointIdxToPrint(int pointIdx) = 0;
+            /**
+             * @brief Switches the plot to the scrolling mode, meant for data streams.
+             *
+             * @param width extent of the \f$X\f$ range, which then ends at the largest \f$X\f$ value of the points.
+             * The points left of that range are dropped, and the curve is kept on a canvas between the calls to
+             * render, which only draws the points appended since its previous call. 0 disables the scrolling mode.
+             */
+            CV_WRAP virtual void setScrollWidth(double width) = 0;
+            /**
+             * @brief Appends points to the plot.
+             *
+             * @param dataX \f$1xN\f$ or \f$Nx1\f$ matrix containing \f$X\f$ values of the new points.
+             * @param dataY \f$1xN\f$ or \f$Nx1\f$ matrix containing \f$Y\f$ values of the new points.
+             *
+             * The limits of the plot which were not set explicitly grow to include the new points.
+             */
+            CV_WRAP virtual void appendData(InputArray dataX, InputArray dataY) = 0;
+            /**
+             * @brief Appends points to the plot.
+             *
+             * @param dataY \f$1xN\f$ or \f$Nx1\f$ matrix containing \f$Y\f$ values of the new points. Their \f$X\f$
+             * values follow the one of the last point by steps of 1.
+             */
+            CV_WRAP virtual void appendData(InputArray dataY) = 0;
             CV_WRAP virtual void render(OutputArray _plotResult) = 0;
 
             /**
@@ -112,49 +112,63 @@ namespace cv
             {
                 plotMinX = _plotMinX;
                 plotMinX_plusZero = _plotMinX;
+                fixedMinX = true;
             }
             void setMaxX(double _plotMaxX) CV_OVERRIDE
             {
                 plotMaxX = _plotMaxX;
                 plotMaxX_plusZero = _plotMaxX;
+                fixedMaxX = true;
             }
             void setMinY(double _plotMinY) CV_OVERRIDE
             {
                 plotMinY = _plotMinY;
                 plotMinY_plusZero = _plotMinY;
+                fixedMinY = true;
+                canvasValid = false;
             }
             void setMaxY(double _plotMaxY) CV_OVERRIDE
             {
                 plotMaxY = _plotMaxY;
                 plotMaxY_plusZero = _plotMaxY;
+                fixedMaxY = true;
+                canvasValid = false;
             }
             void setPlotLineWidth(int _plotLineWidth) CV_OVERRIDE
             {
                 plotLineWidth = _plotLineWidth;
+                canvasValid = false;
+                gridValid = false;
             }
             void setInvertOrientation(bool _invertOrientation) CV_OVERRIDE
             {
                 invertOrientation = _invertOrientation;
+                canvasValid = false;
             }
             void setNeedPlotLine(bool _needPlotLine) CV_OVERRIDE
             {
                 needPlotLine = _needPlotLine;
+                canvasValid = false;
             }
             void setPlotLineColor(Scalar _plotLineColor) CV_OVERRIDE
             {
                 plotLineColor=_plotLineColor;
+                canvasValid = false;
             }
             void setPlotBackgroundColor(Scalar _plotBackgroundColor) CV_OVERRIDE
             {
                 plotBackgroundColor=_plotBackgroundColor;
+                canvasValid = false;
             }
             void setPlotAxisColor(Scalar _plotAxisColor) CV_OVERRIDE
             {
                 plotAxisColor=_plotAxisColor;
+                gridValid = false;
             }
             void setPlotGridColor(Scalar _plotGridColor) CV_OVERRIDE
             {
                 plotGridColor=_plotGridColor;
+                gridValid = false;
             }
             void setPlotTextColor(Scalar _plotTextColor) CV_OVERRIDE
             {
@@ -171,10 +185,14 @@ namespace cv
                     plotSizeHeight = _plotSizeHeight;
                 else
                     plotSizeHeight = 300;
+
+                canvasValid = false;
+                gridValid = false;
             }
             void setShowGrid(bool _needShowGrid) CV_OVERRIDE
             {
                 needShowGrid = _needShowGrid;
+                gridValid = false;
             }
             void setShowText(bool _needShowText) CV_OVERRIDE
             {
@@ -185,79 +203,97 @@ namespace cv
                 if(_gridLinesNumber <= 0)
                     _gridLinesNumber = 1;
                 gridLinesNumber = _gridLinesNumber;
+                gridValid = false;
             }
             void setPointIdxToPrint(int _cursorPos) CV_OVERRIDE
             {
-                if(_cursorPos >= plotDataX.rows || _cursorPos < 0)
-                    _cursorPos = plotDataX.rows - 1;
+                //an invalid index selects the last point, even after new points are appended
                 cursorPos = _cursorPos;
             }
+            void setScrollWidth(double _scrollWidth) CV_OVERRIDE
+            {
+                CV_Assert(_scrollWidth >= 0);
+                scrollWidth = _scrollWidth;
+                canvasValid = false;
+                if(scrollWidth > 0)
+                    dropScrolledPoints();
+            }
+            void appendData(InputArray dataY) CV_OVERRIDE
+            {
+                Mat _dataY = toColumn(dataY.getMat());
+                Mat _dataX(_dataY.rows, 1, CV_64F);
+                double lastX = plotDataX.rows > 0 ? plotDataX.at<double>(plotDataX.rows - 1, 0) : -1;
+                for(int i = 0; i < _dataX.rows; i++)
+                    _dataX.at<double>(i, 0) = lastX + i + 1;
+                appendPoints(_dataX, _dataY);
+            }
+            void appendData(InputArray dataX, InputArray dataY) CV_OVERRIDE
+            {
+                Mat _dataX = toColumn(dataX.getMat());
+                Mat _dataY = toColumn(dataY.getMat());
+                CV_Assert(_dataX.rows == _dataY.rows);
+                appendPoints(_dataX, _dataY);
+            }
             //render the plotResult to a Mat
             void render(OutputArray _plotResult) CV_OVERRIDE
             {
-                //create the plot result
+                //create the plot result, the buffer of the previous call is reused if it has the same size
                 _plotResult.create(plotSizeHeight, plotSizeWidth, CV_8UC3);
                 plotResult = _plotResult.getMat();
-                plotResult.setTo(plotBackgroundColor);
 
                 int NumVecElements = plotDataX.rows;
+                CV_Assert(NumVecElements > 0);
 
-                Mat InterpXdata = linearInterpolation(plotMinX, plotMaxX, 0, plotSizeWidth, plotDataX);
-                Mat InterpYdata = invertOrientation ?
-                                  linearInterpolation(plotMaxY, plotMinY, 0, plotSizeHeight, plotDataY) :
-                                  linearInterpolation(plotMinY, plotMaxY, 0, plotSizeHeight, plotDataY);
+                double minX = plotMinX, maxX = plotMaxX;
+                double minX_plusZero = plotMinX_plusZero, maxX_plusZero = plotMaxX_plusZero;
+                if(scrollWidth > 0)
+                {
+                    maxX = scrollMaxX;
+                    minX = maxX - scrollWidth;
+                    minX_plusZero = std::min(minX, 0.);
+                    maxX_plusZero = std::max(maxX, 0.);
+                }
 
                 //Find the zeros in image coordinates
-                Mat InterpXdataFindZero = linearInterpolation(plotMinX_plusZero, plotMaxX_plusZero, 0, plotSizeWidth, plotDataX_plusZero);
-                Mat InterpYdataFindZero = invertOrientation ?
-                                          linearInterpolation(plotMaxY_plusZero, plotMinY_plusZero, 0, plotSizeHeight, plotDataY_plusZero) :
-                                          linearInterpolation(plotMinY_plusZero, plotMaxY_plusZero, 0, plotSizeHeight, plotDataY_plusZero);
+                int ImageXzero = toImage(minX_plusZero, maxX_plusZero, 0, plotSizeWidth, 0);
+                int ImageYzero = invertOrientation ?
+                                 toImage(plotMaxY_plusZero, plotMinY_plusZero, 0, plotSizeHeight, 0) :
+                                 toImage(plotMinY_plusZero, plotMaxY_plusZero, 0, plotSizeHeight, 0);
 
-                int ImageXzero = (int)InterpXdataFindZero.at<double>(NumVecElements,0);
-                int ImageYzero = (int)InterpYdataFindZero.at<double>(NumVecElements,0);
+                int idx = cursorPos < 0 || cursorPos >= NumVecElements ? NumVecElements - 1 : cursorPos;
+                double CurrentX = plotDataX.at<double>(idx,0);
+                double CurrentY = plotDataY.at<double>(idx,0);
 
-                double CurrentX = plotDataX.at<double>(cursorPos,0);
-                double CurrentY = plotDataY.at<double>(cursorPos,0);
+                if(scrollWidth > 0)
+                {
+                    //the curve is kept on a canvas between calls, the axis are drawn over it
+                    updateCanvas();
 
-                drawAxis(ImageXzero,ImageYzero, CurrentX, CurrentY, plotAxisColor, plotGridColor);
+                    int W = plotSizeWidth;
+                    int start = (int)wrap(columnOf(scrollMaxX) - W + 1 - canvasPhase, W);
+                    canvas.colRange(start, W).copyTo(plotResult.colRange(0, W - start));
+                    if(start > 0)
+                        canvas.colRange(0, start).copyTo(plotResult.colRange(W - start, W));
 
-                if(needPlotLine)
-                {
-                    //Draw the plot by connecting lines between the points
-                    Point p1;
-                    p1.x = (int)InterpXdata.at<double>(0,0);
-                    p1.y = (int)InterpYdata.at<double>(0,0);
+                    drawAxis(ImageXzero,ImageYzero, CurrentX, CurrentY, plotAxisColor, plotGridColor, idx);
+                    return;
+                }
 
-                    for (int r=1; r<InterpXdata.rows; r++)
-                    {
-                        Point p2;
-                        p2.x = (int)InterpXdata.at<double>(r,0);
-                        p2.y = (int)InterpYdata.at<double>(r,0);
+                plotResult.setTo(plotBackgroundColor);
 
-                        line(plotResult, p1, p2, plotLineColor, plotLineWidth, 8, 0);
+                drawAxis(ImageXzero,ImageYzero, CurrentX, CurrentY, plotAxisColor, plotGridColor, idx);
 
-                        p1 = p2;
-                    }
-                }
-                else
+                drawCurve(plotResult, 0, NumVecElements, [&](int i)
                 {
-                    for (int r=0; r<InterpXdata.rows; r++)
-                    {
-                        Point p;
-                        p.x = (int)InterpXdata.at<double>(r,0);
-                        p.y = (int)InterpYdata.at<double>(r,0);
-
-                        circle(plotResult, p, 1, plotLineColor, plotLineWidth, 8, 0);
-                    }
-                }
+                    int x = toImage(minX, maxX, 0, plotSizeWidth, plotDataX.at<double>(i, 0));
+                    return Point(x, toImageY(plotDataY.at<double>(i, 0)));
+                });
             }
 
             protected:
 
             Mat plotDataX;
             Mat plotDataY;
-            Mat plotDataX_plusZero;
-            Mat plotDataY_plusZero;
             const char * plotName;
 
             //dimensions and limits of the plot
@@ -291,29 +327,40 @@ namespace cv
             //flag which enables/disables connection of plotted points by lines
             bool needPlotLine;
 
+            //the limits set explicitly, which are not extended by the appended points
+            bool fixedMinX;
+            bool fixedMaxX;
+            bool fixedMinY;
+            bool fixedMaxY;
+
+            //scrolling mode: extent of the X range, 0 if disabled, and largest X of the points
+            double scrollWidth;
+            double scrollMaxX;
+
+            //curve of the scrolling mode, a ring of columns: the absolute column a of the plot
+            //(see columnOf) is stored in the column (a - canvasPhase) mod plotSizeWidth
+            Mat canvas;
+            bool canvasValid;
+            int64 canvasPhase;
+            //absolute column of scrollMaxX and number of points drawn when the canvas was updated
+            int64 canvasEnd;
+            int canvasPoints;
+
+            //axis and grid drawn for the zeros at gridZero, and the pixels they cover
+            Mat gridLayer;
+            Mat gridMask;
+            bool gridValid;
+            Point gridZero;
+
             void plotHelper(Mat _plotDataX, Mat _plotDataY)
             {
                 plotDataX=_plotDataX;
                 plotDataY=_plotDataY;
 
-                int NumVecElements = plotDataX.rows;
-
-                plotDataX_plusZero = Mat::zeros(NumVecElements+1,1,CV_64F);
-                plotDataY_plusZero = Mat::zeros(NumVecElements+1,1,CV_64F);
-
-                for(int i=0; i<NumVecElements; i++){
-                    plotDataX_plusZero.at<double>(i,0) = plotDataX.at<double>(i,0);
-                    plotDataY_plusZero.at<double>(i,0) = plotDataY.at<double>(i,0);
-                }
-
                 double MinX;
                 double MaxX;
                 double MinY;
                 double MaxY;
-                double MinX_plusZero;
-                double MaxX_plusZero;
-                double MinY_plusZero;
-                double MaxY_plusZero;
 
                 needPlotLine = true;
                 invertOrientation = false;
@@ -324,21 +371,23 @@ namespace cv
                 //Obtain the minimum and maximum values of Ydata
                 minMaxLoc(plotDataY,&MinY,&MaxY);
 
-                //Obtain the minimum and maximum values of Xdata plus zero
-                minMaxLoc(plotDataX_plusZero,&MinX_plusZero,&MaxX_plusZero);
-
-                //Obtain the minimum and maximum values of Ydata plus zero
-                minMaxLoc(plotDataY_plusZero,&MinY_plusZero,&MaxY_plusZero);
-
                 //setting the min and max values for each axis
                 plotMinX = MinX;
                 plotMaxX = MaxX;
                 plotMinY = MinY;
                 plotMaxY = MaxY;
-                plotMinX_plusZero = MinX_plusZero;
-                plotMaxX_plusZero = MaxX_plusZero;
-                plotMinY_plusZero = MinY_plusZero;
-                plotMaxY_plusZero = MaxY_plusZero;
+                plotMinX_plusZero = std::min(MinX, 0.);
+                plotMaxX_plusZero = std::max(MaxX, 0.);
+                plotMinY_plusZero = std::min(MinY, 0.);
+                plotMaxY_plusZero = std::max(MaxY, 0.);
+                fixedMinX = fixedMaxX = fixedMinY = fixedMaxY = false;
+
+                scrollWidth = 0;
+                scrollMaxX = MaxX;
+                canvasValid = false;
+                canvasPhase = canvasEnd = 0;
+                canvasPoints = 0;
+                gridValid = false;
 
                 //setting the default size of a plot figure
                 setPlotSize(600, 400);
@@ -358,7 +407,7 @@ namespace cv
                 setPointIdxToPrint(-1);
             }
 
-            void drawAxis(int ImageXzero, int ImageYzero, double CurrentX, double CurrentY, Scalar axisColor, Scalar gridColor)
+            void drawAxis(int ImageXzero, int ImageYzero, double CurrentX, double CurrentY, Scalar axisColor, Scalar gridColor, int cursorIdx)
             {
                 if(needShowText)
                 {
@@ -366,14 +415,32 @@ namespace cv
                     drawValuesAsText(0, ImageXzero, ImageYzero, -20, 20);
                     drawValuesAsText(0, ImageXzero, ImageYzero, 10, -10);
                     drawValuesAsText(0, ImageXzero, ImageYzero, -20, -10);
-                    drawValuesAsText((format("X_%d = ", cursorPos) + "%g").c_str(), CurrentX, 0, 0, 40, 20);
-                    drawValuesAsText((format("Y_%d = ", cursorPos) + "%g").c_str(), CurrentY, 0, 20, 40, 20);
+                    drawValuesAsText((format("X_%d = ", cursorIdx) + "%g").c_str(), CurrentX, 0, 0, 40, 20);
+                    drawValuesAsText((format("Y_%d = ", cursorIdx) + "%g").c_str(), CurrentY, 0, 20, 40, 20);
                 }
 
+                //the axis and the grid only depend on the position of the zeros, they are drawn once on a
+                //layer copied over the plot by the next calls
+                if(!gridValid || gridZero != Point(ImageXzero, ImageYzero) || gridLayer.size() != plotResult.size())
+                {
+                    gridLayer.create(plotResult.size(), CV_8UC3);
+                    gridLayer.setTo(Scalar::all(0));
+                    gridMask.create(plotResult.size(), CV_8UC1);
+                    gridMask.setTo(Scalar::all(0));
+                    drawGrid(gridLayer, ImageXzero, ImageYzero, axisColor, gridColor);
+                    drawGrid(gridMask, ImageXzero, ImageYzero, Scalar::all(255), Scalar::all(255));
+                    gridZero = Point(ImageXzero, ImageYzero);
+                    gridValid = true;
+                }
+                gridLayer.copyTo(plotResult, gridMask);
+            }
+
+            void drawGrid(Mat& dst, int ImageXzero, int ImageYzero, Scalar axisColor, Scalar gridColor)
+            {
                 //Horizontal X axis and equispaced horizontal lines
                 int LineSpace = cvRound(plotSizeHeight / (float)gridLinesNumber);
                 int TraceSize = 5;
-                drawLine(0, plotSizeWidth, ImageYzero, ImageYzero, axisColor);
+                drawLine(dst, 0, plotSizeWidth, ImageYzero, ImageYzero, axisColor);
 
                if(needShowGrid)
                for(int i=-plotSizeHeight; i<plotSizeHeight; i=i+LineSpace){
@@ -381,14 +448,14 @@ namespace cv
                     if(i!=0){
                         int Trace=0;
                         while(Trace<plotSizeWidth){
-                            drawLine(Trace, Trace+TraceSize, ImageYzero+i, ImageYzero+i, gridColor);
+                            drawLine(dst, Trace, Trace+TraceSize, ImageYzero+i, ImageYzero+i, gridColor);
                             Trace = Trace+2*TraceSize;
                         }
                     }
                 }
 
                 //Vertical Y axis
-                drawLine(ImageXzero, ImageXzero, 0, plotSizeHeight, axisColor);
+                drawLine(dst, ImageXzero, ImageXzero, 0, plotSizeHeight, axisColor);
                 LineSpace = cvRound(LineSpace * (float)plotSizeWidth / plotSizeHeight );
 
                 if(needShowGrid)
@@ -397,27 +464,193 @@ namespace cv
                     if(i!=0){
                         int Trace=0;
                         while(Trace<plotSizeHeight){
-                            drawLine(ImageXzero+i, ImageXzero+i, Trace, Trace+TraceSize, gridColor);
+                            drawLine(dst, ImageXzero+i, ImageXzero+i, Trace, Trace+TraceSize, gridColor);
                             Trace = Trace+2*TraceSize;
                         }
                     }
                 }
             }
 
-            Mat linearInterpolation(double Xa, double Xb, double Ya, double Yb, Mat Xdata){
+            static int toImage(double Xa, double Xb, double Ya, double Yb, double X)
+            {
+                int Y = int(Ya + (Yb-Ya)*(X-Xa)/(Xb-Xa));
+                return Y < 0 ? 0 : Y;
+            }
 
-                Mat Ydata = Xdata*0;
+            int toImageY(double Y) const
+            {
+                return invertOrientation ?
+                       toImage(plotMaxY, plotMinY, 0, plotSizeHeight, Y) :
+                       toImage(plotMinY, plotMaxY, 0, plotSizeHeight, Y);
+            }
 
-                for (int i=0; i<Xdata.rows; i++){
+            static Mat toColumn(Mat data)
+            {
+                if(data.cols > 1 && data.rows > 1)
+                    CV_Error(Error::StsBadArg, "ERROR: Plot data must be a 1xN or Nx1 matrix.\n");
+                CV_Assert(data.empty() || data.type() == CV_64F);
+                return data.cols > data.rows ? data.t() : data;
+            }
 
-                    double X = Xdata.at<double>(i,0);
-                    Ydata.at<double>(i,0) = int(Ya + (Yb-Ya)*(X-Xa)/(Xb-Xa));
+            void appendPoints(const Mat& dataX, const Mat& dataY)
+            {
+                if(dataX.empty())
+                    return;
 
-                    if(Ydata.at<double>(i,0)<0)
-                        Ydata.at<double>(i,0)=0;
+                double MinX, MaxX, MinY, MaxY;
+                minMaxLoc(dataX, &MinX, &MaxX);
+                minMaxLoc(dataY, &MinY, &MaxY);
+
+                if(!fixedMinX) { plotMinX = std::min(plotMinX, MinX); plotMinX_plusZero = std::min(plotMinX, 0.); }
+                if(!fixedMaxX) { plotMaxX = std::max(plotMaxX, MaxX); plotMaxX_plusZero = std::max(plotMaxX, 0.); }
+                if(!fixedMinY && MinY < plotMinY)
+                {
+                    plotMinY = MinY;
+                    plotMinY_plusZero = std::min(plotMinY, 0.);
+                    canvasValid = false;
                 }
+                if(!fixedMaxY && MaxY > plotMaxY)
+                {
+                    plotMaxY = MaxY;
+                    plotMaxY_plusZero = std::max(plotMaxY, 0.);
+                    canvasValid = false;
+                }
+                scrollMaxX = std::max(scrollMaxX, MaxX);
+
+                //the data may still be shared with the caller, whose own appends would write over ours
+                if(plotDataX.u && plotDataX.u->refcount > 1)
+                    plotDataX = plotDataX.clone();
+                if(plotDataY.u && plotDataY.u->refcount > 1)
+                    plotDataY = plotDataY.clone();
+
+                plotDataX.push_back(dataX);
+                plotDataY.push_back(dataY);
+
+                if(scrollWidth > 0)
+                    dropScrolledPoints();
+            }
+
+            //drops the points left of the scrolling range but the last one, which the curve comes from
+            void dropScrolledPoints()
+            {
+                int first = 0;
+                double minX = scrollMaxX - scrollWidth;
+                while(first + 1 < plotDataX.rows && plotDataX.at<double>(first + 1, 0) < minX)
+                    first++;
+
+                //compact once half of the points are out of the range so that appending stays linear
+                if(first > 0 && first * 2 >= plotDataX.rows)
+                {
+                    plotDataX = plotDataX.rowRange(first, plotDataX.rows).clone();
+                    plotDataY = plotDataY.rowRange(first, plotDataY.rows).clone();
+                    canvasPoints = std::max(canvasPoints - first, 0);
+                }
+            }
+
+            static int64 wrap(int64 a, int n)
+            {
+                int64 r = a % n;
+                return r < 0 ? r + n : r;
+            }
+
+            //absolute pixel column of X in the scrolling mode
+            int64 columnOf(double X) const
+            {
+                return (int64)std::floor(X * plotSizeWidth / scrollWidth);
+            }
+
+            //draws the points appended since the previous update on the canvas of the scrolling mode
+            void updateCanvas()
+            {
+                const int W = plotSizeWidth;
+                int64 end = columnOf(scrollMaxX);
+
+                if(!canvasValid || canvas.size() != Size(plotSizeWidth, plotSizeHeight) || end - canvasEnd >= W ||
+                   canvasPoints > plotDataX.rows)
+                {
+                    //redraw everything with the visible columns in order
+                    canvas.create(plotSizeHeight, plotSizeWidth, CV_8UC3);
+                    canvas.setTo(plotBackgroundColor);
+                    canvasPhase = end - W + 1;
+                    drawCurve(canvas, 0, plotDataX.rows, [&](int i)
+                    {
+                        return Point((int)(columnOf(plotDataX.at<double>(i, 0)) - canvasPhase), toImageY(plotDataY.at<double>(i, 0)));
+                    });
+                }
+                else if(canvasPoints < plotDataX.rows)
+                {
+                    //clear the columns which scrolled in, they still hold the curve of W columns ago
+                    for(int64 a = canvasEnd + 1; a <= end; )
+                    {
+                        int c = (int)wrap(a - canvasPhase, W);
+                        int n = (int)std::min<int64>(end - a + 1, W - c);
+                        canvas.colRange(c, c + n).setTo(plotBackgroundColor);
+                        a += n;
+                    }
+
+                    //the new part of the curve starts from the last point drawn, it is drawn a second
+                    //time shifted by W for the part wrapped around the right border of the ring
+                    int64 base = end - wrap(end - canvasPhase, W);
+                    for(int shift = 0; shift <= W; shift += W)
+                        drawCurve(canvas, std::max(canvasPoints - 1, 0), plotDataX.rows, [&](int i)
+                        {
+                            return Point((int)(columnOf(plotDataX.at<double>(i, 0)) - base) + shift, toImageY(plotDataY.at<double>(i, 0)));
+                        });
+                }
+
+                canvasValid = true;
+                canvasEnd = end;
+                canvasPoints = plotDataX.rows;
+            }
+
+            /**
+             * Draws the points [from, to) mapped to the image by toPixel. The consecutive points which fall
+             * in the same pixel column are drawn as a single vertical segment spanning their rows: the lines
+             * between them cover the same pixels, so the cost depends on the width of the plot instead of
+             * the number of points.
+             */
+            template<typename ToPixel>
+            void drawCurve(Mat& dst, int from, int to, const ToPixel& toPixel)
+            {
+                if(from >= to)
+                    return;
 
-                return Ydata;
+                if(!needPlotLine)
+                {
+                    Point last = toPixel(from);
+                    circle(dst, last, 1, plotLineColor, plotLineWidth, 8, 0);
+                    for (int r=from+1; r<to; r++)
+                    {
+                        Point p = toPixel(r);
+                        if(p != last)
+                            circle(dst, p, 1, plotLineColor, plotLineWidth, 8, 0);
+                        last = p;
+                    }
+                    return;
+                }
+
+                Point last = toPixel(from);
+                int minY = last.y, maxY = last.y;
+                for (int r=from+1; r<=to; r++)
+                {
+                    Point p = r < to ? toPixel(r) : Point(INT_MIN, INT_MIN);
+                    if(p.x == last.x)
+                    {
+                        minY = std::min(minY, p.y);
+                        maxY = std::max(maxY, p.y);
+                        last = p;
+                        continue;
+                    }
+
+                    //end of the run of points in the column of last
+                    if(minY != maxY)
+                        line(dst, Point(last.x, minY), Point(last.x, maxY), plotLineColor, plotLineWidth, 8, 0);
+                    if(r < to)
+                        line(dst, last, p, plotLineColor, plotLineWidth, 8, 0);
+
+                    last = p;
+                    minY = maxY = p.y;
+                }
             }
 
             void drawValuesAsText(double Value, int Xloc, int Yloc, int XMargin, int YMargin){
@@ -447,7 +680,7 @@ namespace cv
             }
 
 
-            void drawLine(int Xstart, int Xend, int Ystart, int Yend, Scalar lineColor){
+            void drawLine(Mat& dst, int Xstart, int Xend, int Ystart, int Yend, Scalar lineColor){
 
                 Point Axis_start;
                 Point Axis_end;
@@ -456,7 +689,7 @@ namespace cv
                 Axis_end.x = Xend;
                 Axis_end.y = Yend;
 
-                line(plotResult, Axis_start, Axis_end, lineColor, plotLineWidth, 8, 0);
+                line(dst, Axis_start, Axis_end, lineColor, plotLineWidth, 8, 0);
             }
         };
 
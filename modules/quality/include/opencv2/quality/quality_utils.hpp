@@ -55,6 +55,15 @@ inline R expand_mat( InputArray src, int TYPE_DEFAULT = EXPANDED_MAT_DEFAULT_TYP
     return result;
 }
 
+// extract and expand image i of a vector of images, see expand_mat
+template <typename R>
+inline R expand_mat_at( InputArrayOfArrays src, int i, int TYPE_DEFAULT = EXPANDED_MAT_DEFAULT_TYPE)
+{
+    if (src.isUMatVector())
+        return expand_mat<R>(src.getUMat(i), TYPE_DEFAULT);
+    return expand_mat<R>(src.getMat(i), TYPE_DEFAULT);
+}
+
 // return mat of observed min/max pair per column
 //  row 0:  min per column
 //  row 1:  max per column
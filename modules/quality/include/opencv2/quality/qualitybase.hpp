@@ -34,6 +34,18 @@ public:
     */
     virtual CV_WRAP cv::Scalar compute( InputArray img ) = 0;
 
+    /**
+    @brief Compute quality scores of several images, see compute().  The full reference algorithms compare all the images with the same reference and skip the quality maps
+    @param imgs vector of comparison images, or images to evaluate for no-reference quality algorithms
+    @param scores per-channel score of each image
+    */
+    virtual CV_WRAP void computeBatch( InputArrayOfArrays imgs, CV_OUT std::vector<cv::Scalar>& scores )
+    {
+        scores.resize(imgs.total());
+        for (size_t i = 0; i < scores.size(); ++i)
+            scores[i] = imgs.isUMatVector() ? compute(imgs.getUMat((int)i)) : compute(imgs.getMat((int)i));
+    }
+
     /** @brief Returns output quality map that was generated during computation, if supported by the algorithm  */
     virtual CV_WRAP void getQualityMap(OutputArray dst) const
     {
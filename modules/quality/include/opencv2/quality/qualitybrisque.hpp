@@ -32,10 +32,18 @@ public:
     */
     CV_WRAP cv::Scalar compute( InputArray img ) CV_OVERRIDE;
 
+    /** @brief Computes BRISQUE quality scores of several images in parallel
+    @param imgs Images for which to compute quality
+    @param scores cv::Scalar with the score in the first element for each image
+    */
+    CV_WRAP void computeBatch( InputArrayOfArrays imgs, CV_OUT std::vector<cv::Scalar>& scores ) CV_OVERRIDE;
+
     /**
     @brief Create an object which calculates quality
     @param model_file_path cv::String which contains a path to the BRISQUE model data, eg. /path/to/brisque_model_live.yml
     @param range_file_path cv::String which contains a path to the BRISQUE range data, eg. /path/to/brisque_range_live.yml
+
+    The files are loaded once per process, the objects created from the same files share the model.
     */
     CV_WRAP static Ptr<QualityBRISQUE> create( const cv::String& model_file_path, const cv::String& range_file_path );
 
@@ -27,6 +27,13 @@ public:
     */
     CV_WRAP cv::Scalar compute( InputArray cmp ) CV_OVERRIDE;
 
+    /**
+    @brief Computes GMSD of several comparison images against the reference, without quality maps
+    @param cmpImgs comparison images
+    @param scores cv::Scalar with per-channel quality value for each image
+    */
+    CV_WRAP void computeBatch( InputArrayOfArrays cmpImgs, CV_OUT std::vector<cv::Scalar>& scores ) CV_OVERRIDE;
+
     /** @brief Implements Algorithm::empty()  */
     CV_WRAP bool empty() const CV_OVERRIDE { return _refImgData.empty() && QualityBase::empty(); }
 
@@ -73,8 +80,8 @@ protected:
         // returns flag if empty
         bool empty() const { return this->gradient_map.empty() && this->gradient_map_squared.empty(); }
 
-        // compute for a single frame
-        static std::pair<cv::Scalar, mat_type> compute(const _mat_data& lhs, const _mat_data& rhs);
+        // compute for a single frame, the quality map is empty if not needed
+        static std::pair<cv::Scalar, mat_type> compute(const _mat_data& lhs, const _mat_data& rhs, bool need_map = true);
 
     };  // mat_data
 
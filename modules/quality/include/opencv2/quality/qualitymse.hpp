@@ -24,6 +24,12 @@ public:
     */
     CV_WRAP cv::Scalar compute( InputArrayOfArrays cmpImgs ) CV_OVERRIDE;
 
+    /** @brief Computes MSE of several comparison images against the reference, without quality maps
+    @param cmpImgs Comparison images
+    @param scores cv::Scalar with per-channel quality values for each image
+    */
+    CV_WRAP void computeBatch( InputArrayOfArrays cmpImgs, CV_OUT std::vector<cv::Scalar>& scores ) CV_OVERRIDE;
+
     /** @brief Implements Algorithm::empty()  */
     CV_WRAP bool empty() const CV_OVERRIDE { return _ref.empty() && QualityBase::empty(); }
 
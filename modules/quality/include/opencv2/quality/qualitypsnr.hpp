@@ -55,6 +55,18 @@ public:
         );
     }
 
+    /**
+    @brief Compute the PSNR of several comparison images against the reference, without quality maps
+    @param cmpImgs Comparison images
+    @param scores Per-channel PSNR value of each image
+    */
+    CV_WRAP void computeBatch( InputArrayOfArrays cmpImgs, CV_OUT std::vector<cv::Scalar>& scores ) CV_OVERRIDE
+    {
+        _qualityMSE->computeBatch( cmpImgs, scores );
+        for (auto& score : scores)
+            score = _mse_to_psnr( score, _maxPixelValue );
+    }
+
     /** @brief Implements Algorithm::empty()  */
     CV_WRAP bool empty() const CV_OVERRIDE { return _qualityMSE->empty() && QualityBase::empty(); }
 
@@ -26,6 +26,13 @@ public:
     */
     CV_WRAP cv::Scalar compute( InputArray cmp ) CV_OVERRIDE;
 
+    /**
+    @brief Computes SSIM of several comparison images against the reference, without quality maps
+    @param cmpImgs Comparison images
+    @param scores cv::Scalar with per-channel quality values for each image
+    */
+    CV_WRAP void computeBatch( InputArrayOfArrays cmpImgs, CV_OUT std::vector<cv::Scalar>& scores ) CV_OVERRIDE;
+
     /** @brief Implements Algorithm::empty()  */
     CV_WRAP bool empty() const CV_OVERRIDE { return _refImgData.empty() && QualityBase::empty(); }
 
@@ -57,9 +64,7 @@ protected:
 
         mat_type
             I
-            , I_2
             , mu
-            , mu_2
             , sigma_2
             ;
 
@@ -73,10 +78,10 @@ protected:
         _mat_data(InputArray);
 
         // return flag if this is empty
-        bool empty() const { return I.empty() && I_2.empty() && mu.empty() && mu_2.empty() && sigma_2.empty(); }
+        bool empty() const { return I.empty() && mu.empty() && sigma_2.empty(); }
 
-        // computes ssim and quality map for single frame
-        static std::pair<cv::Scalar, mat_type> compute(const _mat_data& lhs, const _mat_data& rhs);
+        // computes ssim and quality map for single frame, the map is empty if not needed
+        static std::pair<cv::Scalar, mat_type> compute(const _mat_data& lhs, const _mat_data& rhs, bool need_map = true);
 
     };  // mat_data
 
@@ -0,0 +1,64 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+enum { QUALITY_MSE, QUALITY_PSNR, QUALITY_SSIM, QUALITY_GMSD };
+CV_ENUM(QualityType, QUALITY_MSE, QUALITY_PSNR, QUALITY_SSIM, QUALITY_GMSD)
+
+static Ptr<quality::QualityBase> createQuality(int type, InputArray ref)
+{
+    switch (type)
+    {
+    case QUALITY_MSE: return quality::QualityMSE::create(ref);
+    case QUALITY_PSNR: return quality::QualityPSNR::create(ref);
+    case QUALITY_SSIM: return quality::QualitySSIM::create(ref);
+    default: return quality::QualityGMSD::create(ref);
+    }
+}
+
+static void loadPair(Size sz, int cn, Mat& ref, Mat& cmp)
+{
+    ref = imread(getDataPath("cv/optflow/RubberWhale1.png"), cn == 1 ? IMREAD_GRAYSCALE : IMREAD_COLOR);
+    cmp = imread(getDataPath("cv/optflow/RubberWhale2.png"), cn == 1 ? IMREAD_GRAYSCALE : IMREAD_COLOR);
+    ASSERT_FALSE(ref.empty());
+    ASSERT_FALSE(cmp.empty());
+    resize(ref, ref, sz, 0, 0, INTER_LINEAR_EXACT);
+    resize(cmp, cmp, sz, 0, 0, INTER_LINEAR_EXACT);
+}
+
+typedef tuple<Size, int, QualityType> QualityParams_t;
+typedef perf::TestBaseWithParam<QualityParams_t> Quality;
+
+PERF_TEST_P(Quality, compute, Combine(Values(szVGA, sz1080p), Values(1, 3), QualityType::all()))
+{
+    const Size sz = get<0>(GetParam());
+    const int cn = get<1>(GetParam());
+    const int type = get<2>(GetParam());
+
+    Mat ref, cmp;
+    loadPair(sz, cn, ref, cmp);
+    // the reference is preprocessed once, as when comparing a stream of images against it
+    Ptr<quality::QualityBase> q = createQuality(type, ref);
+
+    TEST_CYCLE() q->compute(cmp);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef perf::TestBaseWithParam<Size> QualityBRISQUE;
+
+PERF_TEST_P(QualityBRISQUE, computeFeatures, Values(szVGA, sz1080p))
+{
+    Mat img, unused;
+    loadPair(GetParam(), 1, img, unused);
+    Mat features;
+
+    TEST_CYCLE() quality::QualityBRISQUE::computeFeatures(img, features);
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
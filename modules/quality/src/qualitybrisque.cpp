@@ -34,6 +34,9 @@ AND THE UNIVERSITY OF TEXAS AT AUSTIN HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 #include "opencv2/imgproc.hpp"
 #include "opencv2/quality/qualitybrisque.hpp"
 #include "opencv2/quality/quality_utils.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+#include <map>
 
 namespace
 {
@@ -76,6 +79,32 @@ namespace
         return result;
     }
 
+    // ratios r(gam) = gamma(2/gam)^2 / (gamma(1/gam) * gamma(3/gam)) sampled for the gam fit
+    struct AGGDTable
+    {
+        std::vector<double>
+            gam
+            , r_gam
+            ;
+
+        AGGDTable()
+        {
+            double sampling = 0.001;
+            for (double g = 0.2; g < 10; g += sampling) //possible to coarsen sampling to quicken the code, with some loss of accuracy
+            {
+                gam.push_back(g);
+                r_gam.push_back(tgamma(2 / g)*tgamma(2 / g) / (tgamma(1 / g)*tgamma(3 / g)));
+            }
+        }
+    };
+
+    // the table is built once per process, the static initialization is thread safe
+    const AGGDTable& aggd_table()
+    {
+        static const AGGDTable table;
+        return table;
+    }
+
     // function to compute best fit parameters from AGGDfit
     void AGGDfit(const brisque_mat_type& structdis, double& lsigma_best, double& rsigma_best, double& gamma_best)
     {
@@ -83,9 +112,10 @@ namespace
         double possqsum = 0, negsqsum = 0, abssum = 0;
         for (int i = 0; i < structdis.rows; i++)
         {
+            const brisque_calc_element_type* row = structdis.ptr<brisque_calc_element_type>(i);
             for (int j = 0; j < structdis.cols; j++)
             {
-                double pt = structdis.at<brisque_calc_element_type>(i, j);
+                double pt = row[j];
                 if (pt > 0)
                 {
                     poscount++;
@@ -109,20 +139,85 @@ namespace
         double rhat = cv::pow(abssum / totalcount, static_cast<double>(2)) / ((negsqsum + possqsum) / totalcount);
         double rhatnorm = rhat * (cv::pow(gammahat, 3) + 1)*(gammahat + 1) / pow(pow(gammahat, 2) + 1, 2);
 
+        // first local minimum of |r(gam) - rhatnorm| in the sampled table
+        const AGGDTable& table = aggd_table();
         double prevgamma = 0;
         double prevdiff = 1e10;
-        double sampling = 0.001;
-        for (double gam = 0.2; gam < 10; gam += sampling) //possible to coarsen sampling to quicken the code, with some loss of accuracy
+        for (size_t k = 0; k < table.gam.size(); ++k)
         {
-            double r_gam = tgamma(2 / gam)*tgamma(2 / gam) / (tgamma(1 / gam)*tgamma(3 / gam));
-            double diff = abs(r_gam - rhatnorm);
+            double diff = std::abs(table.r_gam[k] - rhatnorm);
             if (diff > prevdiff) break;
             prevdiff = diff;
-            prevgamma = gam;
+            prevgamma = table.gam[k];
         }
         gamma_best = prevgamma;
+    }
+
+    // MSCN coefficients of a row, (I - mu) / (sqrt(blur(I^2) - mu^2) + 1/255)
+    template <typename T>
+    void mscn_row(const T* img, const T* mu, const T* img_sq_blur, T* dst, int len, int j = 0)
+    {
+        const T eps = (T)(1.0 / 255);  // to avoid DivideByZero Error
+        for (; j < len; ++j)
+            dst[j] = (img[j] - mu[j]) / (std::sqrt(img_sq_blur[j] - mu[j] * mu[j]) + eps);
+    }
+
+#if CV_SIMD128
+    void mscn_row(const float* img, const float* mu, const float* img_sq_blur, float* dst, int len)
+    {
+        const v_float32x4 eps = v_setall_f32((float)(1.0 / 255));
+        int j = 0;
+        for (; j <= len - v_float32x4::nlanes; j += v_float32x4::nlanes)
+        {
+            const v_float32x4 m = v_load(mu + j);
+            const v_float32x4 sigma = v_sqrt(v_load(img_sq_blur + j) - m * m) + eps;
+            v_store(dst + j, (v_load(img + j) - m) / sigma);
+        }
+        mscn_row<float>(img, mu, img_sq_blur, dst, len, j);
+    }
+#endif
+
+    // MSCN image of a scaled image
+    void compute_mscn(const brisque_mat_type& imdist_scaled, brisque_mat_type& structdis)
+    {
+        // compute mu (local mean)
+        brisque_mat_type mu;
+        cv::GaussianBlur(imdist_scaled, mu, cv::Size(7, 7), 7. / 6., 0., cv::BORDER_REPLICATE );
+
+        // blur the squared image, sigma is computed per row with the coefficients
+        brisque_mat_type sigma;
+        cv::multiply(imdist_scaled, imdist_scaled, sigma);
+        cv::GaussianBlur(sigma, sigma, cv::Size(7, 7), 7./6., 0., cv::BORDER_REPLICATE );
 
-        // return structdis.clone();
+        structdis.create(imdist_scaled.size(), BRISQUE_CALC_MAT_TYPE);
+        for (int i = 0; i < structdis.rows; i++)
+            mscn_row(imdist_scaled.ptr<brisque_calc_element_type>(i), mu.ptr<brisque_calc_element_type>(i)
+                , sigma.ptr<brisque_calc_element_type>(i), structdis.ptr<brisque_calc_element_type>(i), structdis.cols);
+    }
+
+    // product of the MSCN image with itself shifted by (dy, dx), the shifted values outside of the image are 0
+    void pairwise_product(const brisque_mat_type& structdis, int dy, int dx, brisque_mat_type& dst)
+    {
+        dst.create(structdis.size(), BRISQUE_CALC_MAT_TYPE);
+        const int
+            cols = structdis.cols
+            , jbegin = std::max(0, -dx)
+            , jend = std::min(cols, cols - dx)
+            ;
+        for (int i = 0; i < structdis.rows; i++)
+        {
+            const brisque_calc_element_type* src = structdis.ptr<brisque_calc_element_type>(i);
+            brisque_calc_element_type* d = dst.ptr<brisque_calc_element_type>(i);
+            const bool inside = i + dy >= 0 && i + dy < structdis.rows;
+            const brisque_calc_element_type* shifted = inside ? structdis.ptr<brisque_calc_element_type>(i + dy) + dx : NULL;
+            for (int j = 0; j < cols; j++)
+            {
+                if (inside && j >= jbegin && j < jend)
+                    d[j] = src[j] * shifted[j];
+                else
+                    d[j] = src[j] * (brisque_calc_element_type)0;
+            }
+        }
     }
 
     std::vector<brisque_calc_element_type> ComputeBrisqueFeature( const brisque_mat_type& orig )
@@ -143,26 +238,8 @@ namespace
             cv::resize(orig_bw, imdist_scaled, dst_size, 0, 0, cv::INTER_CUBIC); // INTER_CUBIC
 
             // calculating MSCN coefficients
-            // compute mu (local mean)
-            brisque_mat_type mu;//  (imdist_scaled.size(), CV_64FC1, 1);
-            cv::GaussianBlur(imdist_scaled, mu, cv::Size(7, 7), 7. / 6., 0., cv::BORDER_REPLICATE );
-
-            brisque_mat_type mu_sq;
-            cv::pow(mu, double(2.0), mu_sq);
-
-            //compute sigma (local sigma)
-            brisque_mat_type sigma;// (imdist_scaled.size(), CV_64FC1, 1);
-            cv::multiply(imdist_scaled, imdist_scaled, sigma);
-
-            cv::GaussianBlur(sigma, sigma, cv::Size(7, 7), 7./6., 0., cv::BORDER_REPLICATE );
-
-            cv::subtract(sigma, mu_sq, sigma);
-            cv::pow(sigma, double(0.5), sigma);
-            cv::add(sigma, Scalar(1.0 / 255), sigma); // to avoid DivideByZero Error
-
-            brisque_mat_type structdis;// (imdist_scaled.size(), CV_64FC1, 1);
-            cv::subtract(imdist_scaled, mu, structdis);
-            cv::divide(structdis, sigma, structdis);  // structdis is MSCN image
+            brisque_mat_type structdis;
+            compute_mscn(imdist_scaled, structdis);  // structdis is MSCN image
 
             // Compute AGGD fit to MSCN image
             double lsigma_best, rsigma_best, gamma_best;
@@ -181,27 +258,9 @@ namespace
                 // select the shifting index from the 2D array
                 int* reqshift = shifts[itr_shift - 1];
 
-                // declare, create shifted_structdis as pairwise image
-                brisque_mat_type shifted_structdis(imdist_scaled.size(), BRISQUE_CALC_MAT_TYPE); //(imdist_scaled.size(), CV_64FC1, 1);
-
-                // create pair-wise product for the given orientation (reqshift)
-                for (int i = 0; i < structdis.rows; i++)
-                {
-                    for (int j = 0; j < structdis.cols; j++)
-                    {
-                        if (i + reqshift[0] >= 0 && i + reqshift[0] < structdis.rows && j + reqshift[1] >= 0 && j + reqshift[1] < structdis.cols)
-                        {
-                            shifted_structdis.at<brisque_calc_element_type>(i,j) = structdis.at<brisque_calc_element_type>(i + reqshift[0], j + reqshift[1]);
-                        }
-                        else
-                        {
-                            shifted_structdis.at<brisque_calc_element_type>(i, j) = (brisque_calc_element_type) 0;
-                        }
-                    }
-                }
-
-                // calculate the products of the pairs
-                cv::multiply(structdis, shifted_structdis, shifted_structdis);
+                // calculate the products of the pairs for the given orientation (reqshift)
+                brisque_mat_type shifted_structdis;
+                pairwise_product(structdis, reqshift[0], reqshift[1], shifted_structdis);
 
                 // fit the pairwise product to AGGD
                 // shifted_structdis = AGGDfit(shifted_structdis, lsigma_best, rsigma_best, gamma_best);
@@ -233,6 +292,34 @@ namespace
         return std::min( std::max( result.at<float>(0), 0.f ), 100.f ); // clamp to [0-100]
     }
 
+    // model and range data loaded from files
+    struct brisque_model
+    {
+        cv::Ptr<cv::ml::SVM> model;
+        cv::Mat range;
+    };
+
+    // the files are loaded once per process and the model is shared by the instances, the svm prediction is thread safe
+    brisque_model load_model(const cv::String& model_file_path, const cv::String& range_file_path)
+    {
+        static cv::Mutex mutex;
+        static std::map<std::pair<cv::String, cv::String>, brisque_model> models;
+
+        cv::AutoLock lock(mutex);
+        const auto key = std::make_pair(model_file_path, range_file_path);
+        const auto it = models.find(key);
+        if (it != models.end())
+            return it->second;
+
+        brisque_model result = {
+            cv::ml::SVM::load(model_file_path)
+            , cv::FileStorage(range_file_path, cv::FileStorage::READ)["range"].mat()
+        };
+        if (!result.model.empty() && !result.model->empty() && !result.range.empty())
+            models[key] = result;
+        return result;
+    }
+
     // computes score for a single frame
     cv::Scalar compute(const cv::Ptr<cv::ml::SVM>& model, const cv::Mat& range, const brisque_mat_type& img)
     {
@@ -262,11 +349,11 @@ cv::Scalar QualityBRISQUE::compute( InputArray img, const cv::String& model_file
 
 // QualityBRISQUE() constructor
 QualityBRISQUE::QualityBRISQUE(const cv::String& model_file_path, const cv::String& range_file_path)
-    : QualityBRISQUE(
-        cv::ml::SVM::load(model_file_path)
-        , cv::FileStorage(range_file_path, cv::FileStorage::READ)["range"].mat()
-    )
-{}
+{
+    const auto loaded = ::load_model(model_file_path, range_file_path);
+    this->_model = loaded.model;
+    this->_range = loaded.range;
+}
 
 cv::Scalar QualityBRISQUE::compute( InputArray img )
 {
@@ -277,6 +364,22 @@ cv::Scalar QualityBRISQUE::compute( InputArray img )
     return ::compute(this->_model, this->_range, mat );
 }
 
+void QualityBRISQUE::computeBatch( InputArrayOfArrays imgs, std::vector<cv::Scalar>& scores )
+{
+    scores.assign(imgs.total(), cv::Scalar());
+    cv::parallel_for_(Range(0, (int)scores.size()), [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; ++i)
+        {
+            auto mat = imgs.isUMatVector()
+                ? quality_utils::extract_mat<brisque_mat_type>(imgs.getUMat(i))
+                : quality_utils::extract_mat<brisque_mat_type>(imgs.getMat(i))
+                ;
+            scores[i] = ::compute(this->_model, this->_range, mat_convert(mat));
+        }
+    });
+}
+
 //static
 void QualityBRISQUE::computeFeatures(InputArray img, OutputArray features)
 {
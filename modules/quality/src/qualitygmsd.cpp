@@ -9,6 +9,7 @@
 
 #include "opencv2/imgproc.hpp"  // blur, resize
 #include "opencv2/quality/quality_utils.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace
 {
@@ -78,6 +79,92 @@ namespace
                 .rowRange((kernel.rows - 1) / 2, dest.rows - kernel.rows / 2);
         }
     }
+
+    const double T = 170.;
+
+    // gmsd quality map of the elements [i, len) of a row
+    template <typename _Tp>
+    void gmsd_row_tail(const _Tp* gm1, const _Tp* gm1_2, const _Tp* gm2, const _Tp* gm2_2, _Tp* dst, int len, int i)
+    {
+        for (; i < len; ++i)
+            dst[i] = ((_Tp)2 * gm1[i] * gm2[i] + (_Tp)T) / (gm1_2[i] + gm2_2[i] + (_Tp)T);
+    }
+
+    template <typename _Tp>
+    void gmsd_row(const _Tp* gm1, const _Tp* gm1_2, const _Tp* gm2, const _Tp* gm2_2, _Tp* dst, int len)
+    {
+        gmsd_row_tail<_Tp>(gm1, gm1_2, gm2, gm2_2, dst, len, 0);
+    }
+
+    template <>
+    void gmsd_row<float>(const float* gm1, const float* gm1_2, const float* gm2, const float* gm2_2, float* dst, int len)
+    {
+        int i = 0;
+#if CV_SIMD128
+        const v_float32x4
+            v_two = v_setall_f32(2.f)
+            , v_t = v_setall_f32((float)T)
+            ;
+        for (; i <= len - v_float32x4::nlanes; i += v_float32x4::nlanes)
+        {
+            const v_float32x4 num = v_two * v_load(gm1 + i) * v_load(gm2 + i) + v_t;
+            const v_float32x4 denom = v_load(gm1_2 + i) + v_load(gm2_2 + i) + v_t;
+            v_store(dst + i, num / denom);
+        }
+#endif
+        gmsd_row_tail<float>(gm1, gm1_2, gm2, gm2_2, dst, len, i);
+    }
+
+    // standard deviation of the quality map per channel in a single pass, fills qmap unless it is empty
+    template <typename _Tp>
+    cv::Scalar gmsd_fused(const Mat& gm1, const Mat& gm1_2, const Mat& gm2, const Mat& gm2_2, Mat& qmap)
+    {
+        const int
+            cn = gm1.channels()
+            , len = gm1.cols * cn
+            ;
+        CV_Assert(cn <= 4);
+
+        // per row sums, so the result does not depend on the number of threads
+        std::vector<double> row_sums((size_t)gm1.rows * cn * 2, 0.);
+        cv::parallel_for_(Range(0, gm1.rows), [&](const Range& range)
+        {
+            std::vector<_Tp> buf(qmap.empty() ? len : 0);
+            for (int y = range.start; y < range.end; ++y)
+            {
+                _Tp* dst = qmap.empty() ? buf.data() : qmap.ptr<_Tp>(y);
+                gmsd_row<_Tp>(gm1.ptr<_Tp>(y), gm1_2.ptr<_Tp>(y), gm2.ptr<_Tp>(y), gm2_2.ptr<_Tp>(y), dst, len);
+                double* sums = &row_sums[(size_t)y * cn * 2];
+                for (int c = 0; c < cn; ++c)
+                {
+                    double sum = 0., sqsum = 0.;
+                    for (int i = c; i < len; i += cn)
+                    {
+                        const double v = dst[i];
+                        sum += v;
+                        sqsum += v * v;
+                    }
+                    sums[2 * c] = sum;
+                    sums[2 * c + 1] = sqsum;
+                }
+            }
+        });
+
+        cv::Scalar result = {};
+        const double n = (double)gm1.total();
+        for (int c = 0; c < cn; ++c)
+        {
+            double sum = 0., sqsum = 0.;
+            for (int y = 0; y < gm1.rows; ++y)
+            {
+                sum += row_sums[((size_t)y * cn + c) * 2];
+                sqsum += row_sums[((size_t)y * cn + c) * 2 + 1];
+            }
+            const double mean = sum / n;
+            result[c] = std::sqrt(std::max(sqsum / n - mean * mean, 0.));
+        }
+        return result;
+    }
 }   // ns
 
 // construct mat_data from _mat_type
@@ -136,7 +223,7 @@ Ptr<QualityGMSD> QualityGMSD::create( InputArray ref )
 // static
 cv::Scalar QualityGMSD::compute( InputArray ref, InputArray cmp, OutputArray qualityMap )
 {
-    auto result = _mat_data::compute( _mat_data(ref), _mat_data(cmp) );
+    auto result = _mat_data::compute( _mat_data(ref), _mat_data(cmp), qualityMap.needed() );
 
     if (qualityMap.needed())
         qualityMap.assign(result.second);
@@ -150,12 +237,53 @@ cv::Scalar QualityGMSD::compute( InputArray cmp )
     return result.first;
 }
 
+void QualityGMSD::computeBatch( InputArrayOfArrays cmpImgs, std::vector<cv::Scalar>& scores )
+{
+    scores.assign(cmpImgs.total(), cv::Scalar());
+    const auto fn = [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; ++i)
+            scores[i] = _mat_data::compute(
+                this->_refImgData
+                , _mat_data(quality_utils::expand_mat_at<_mat_data::mat_type>(cmpImgs, i))
+                , false
+            ).first;
+    };
+
+    // the frames are processed concurrently on the cpu, the opencl path keeps one queue
+    if (cv::ocl::useOpenCL())
+        fn(Range(0, (int)scores.size()));
+    else
+        cv::parallel_for_(Range(0, (int)scores.size()), fn);
+}
+
 // computes gmsd and quality map for single frame
-std::pair<cv::Scalar, _quality_map_type> QualityGMSD::_mat_data::compute(const QualityGMSD::_mat_data& lhs, const QualityGMSD::_mat_data& rhs)
+std::pair<cv::Scalar, _quality_map_type> QualityGMSD::_mat_data::compute(const QualityGMSD::_mat_data& lhs, const QualityGMSD::_mat_data& rhs, bool need_map)
 {
-    static const double T = 170.;
     std::pair<cv::Scalar, _quality_map_type> result;
 
+    // on the cpu, the map and its deviation are computed in one pass without temporary images
+    const int depth = lhs.gradient_map.depth();
+    if (!cv::ocl::useOpenCL() && (depth == CV_32F || depth == CV_64F))
+    {
+        if (need_map)
+            result.second.create(lhs.gradient_map.size(), lhs.gradient_map.type());
+        {
+            const Mat
+                gm1 = lhs.gradient_map.getMat(ACCESS_READ)
+                , gm1_2 = lhs.gradient_map_squared.getMat(ACCESS_READ)
+                , gm2 = rhs.gradient_map.getMat(ACCESS_READ)
+                , gm2_2 = rhs.gradient_map_squared.getMat(ACCESS_READ)
+                ;
+            Mat qmap = need_map ? result.second.getMat(ACCESS_WRITE) : Mat();
+            result.first = (depth == CV_32F)
+                ? ::gmsd_fused<float>(gm1, gm1_2, gm2, gm2_2, qmap)
+                : ::gmsd_fused<double>(gm1, gm1_2, gm2, gm2_2, qmap)
+                ;
+        }
+        return result;
+    }
+
     // compute quality_map = (2 * gm1 .* gm2 + T) ./ (gm1 .^2 + gm2 .^2 + T);
     _mat_type num
         , denom
@@ -175,4 +303,4 @@ std::pair<cv::Scalar, _quality_map_type> QualityGMSD::_mat_data::compute(const Q
     result.second = std::move(qm);
 
     return result;
-}   // compute
\ No newline at end of file
+}   // compute
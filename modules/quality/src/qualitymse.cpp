@@ -5,6 +5,7 @@
 #include "precomp.hpp"
 #include "opencv2/quality/qualitymse.hpp"
 #include "opencv2/quality/quality_utils.hpp"
+#include "opencv2/core/ocl.hpp"
 
 namespace
 {
@@ -14,11 +15,63 @@ namespace
     using mse_mat_type = UMat;
     using _quality_map_type = mse_mat_type;
 
-    // computes mse and quality map for single frame
-    std::pair<cv::Scalar, _quality_map_type> compute(const mse_mat_type& lhs, const mse_mat_type& rhs)
+    // mean squared difference per channel in a single pass, without the quality map
+    template <typename T>
+    cv::Scalar mse_fused(const Mat& lhs, const Mat& rhs)
+    {
+        const int
+            cn = lhs.channels()
+            , len = lhs.cols * cn
+            ;
+        CV_Assert(cn <= 4);
+
+        // per row sums, so the result does not depend on the number of threads
+        std::vector<double> row_sums((size_t)lhs.rows * cn, 0.);
+        cv::parallel_for_(Range(0, lhs.rows), [&](const Range& range)
+        {
+            for (int y = range.start; y < range.end; ++y)
+            {
+                const T
+                    *l = lhs.ptr<T>(y)
+                    , *r = rhs.ptr<T>(y)
+                    ;
+                double* sums = &row_sums[(size_t)y * cn];
+                for (int c = 0; c < cn; ++c)
+                {
+                    double sum = 0.;
+                    for (int i = c; i < len; i += cn)
+                    {
+                        const double d = (double)l[i] - (double)r[i];
+                        sum += d * d;
+                    }
+                    sums[c] = sum;
+                }
+            }
+        });
+
+        cv::Scalar result = {};
+        for (int y = 0; y < lhs.rows; ++y)
+            for (int c = 0; c < cn; ++c)
+                result[c] += row_sums[(size_t)y * cn + c];
+        return result / (double)lhs.total();
+    }
+
+    // computes mse and quality map for single frame, the map is empty if not needed
+    std::pair<cv::Scalar, _quality_map_type> compute(const mse_mat_type& lhs, const mse_mat_type& rhs, bool need_map = true)
     {
         std::pair<cv::Scalar, _quality_map_type> result;
 
+        if (!need_map && !cv::ocl::useOpenCL() && (lhs.depth() == CV_32F || lhs.depth() == CV_64F))
+        {
+            CV_Assert(lhs.size() == rhs.size() && lhs.type() == rhs.type());
+            const Mat
+                l = lhs.getMat(ACCESS_READ)
+                , r = rhs.getMat(ACCESS_READ)
+                ;
+            result.first = (l.depth() == CV_32F) ? mse_fused<float>(l, r) : mse_fused<double>(l, r);
+            return result;
+        }
+
         cv::subtract( lhs, rhs, result.second );
 
         // cv::pow(diff, 2., diff);
@@ -42,7 +95,7 @@ cv::Scalar QualityMSE::compute( InputArray ref_, InputArray cmp_, OutputArray qu
     auto ref = quality_utils::expand_mat<mse_mat_type>(ref_);
     auto cmp = quality_utils::expand_mat<mse_mat_type>(cmp_);
 
-    auto result = ::compute(ref, cmp);
+    auto result = ::compute(ref, cmp, qualityMap.needed());
 
     if (qualityMap.needed())
         qualityMap.assign(result.second);
@@ -56,4 +109,20 @@ cv::Scalar QualityMSE::compute( InputArray cmp_ )
     auto result = ::compute( this->_ref, cmp );
     OutputArray(this->_qualityMap).assign(result.second);
     return result.first;
-}
\ No newline at end of file
+}
+
+void QualityMSE::computeBatch( InputArrayOfArrays cmpImgs, std::vector<cv::Scalar>& scores )
+{
+    scores.assign(cmpImgs.total(), cv::Scalar());
+    const auto fn = [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; ++i)
+            scores[i] = ::compute(this->_ref, quality_utils::expand_mat_at<mse_mat_type>(cmpImgs, i), false).first;
+    };
+
+    // the frames are processed concurrently on the cpu, the opencl path keeps one queue
+    if (cv::ocl::useOpenCL())
+        fn(Range(0, (int)scores.size()));
+    else
+        cv::parallel_for_(Range(0, (int)scores.size()), fn);
+}
@@ -6,6 +6,8 @@
 #include "opencv2/quality/qualityssim.hpp"
 #include "opencv2/imgproc.hpp"  // GaussianBlur
 #include "opencv2/quality/quality_utils.hpp"
+#include "opencv2/core/ocl.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace
 {
@@ -15,6 +17,11 @@ namespace
     using _mat_type = UMat;
     using _quality_map_type = _mat_type;
 
+    const double
+        C1 = 6.5025
+        , C2 = 58.5225
+        ;
+
     // SSIM blur function
     _mat_type blur(const _mat_type& mat)
     {
@@ -22,16 +29,103 @@ namespace
         cv::GaussianBlur( mat, result, cv::Size(11, 11), 1.5 );
         return result;
     }
+
+    // ssim of the elements [i, len) of a row from the blurred statistics, mu12 is the blurred product of the images
+    template <typename T>
+    void ssim_row_tail(const T* mu1, const T* sigma1, const T* mu2, const T* sigma2, const T* mu12, T* dst, int len, int i)
+    {
+        for (; i < len; ++i)
+        {
+            const T
+                mu1_mu2 = mu1[i] * mu2[i]
+                , sigma12 = mu12[i] - mu1_mu2
+                , num = ((T)2 * mu1_mu2 + (T)C1) * ((T)2 * sigma12 + (T)C2)
+                , denom = (mu1[i] * mu1[i] + mu2[i] * mu2[i] + (T)C1) * (sigma1[i] + sigma2[i] + (T)C2)
+                ;
+            dst[i] = num / denom;
+        }
+    }
+
+    template <typename T>
+    void ssim_row(const T* mu1, const T* sigma1, const T* mu2, const T* sigma2, const T* mu12, T* dst, int len)
+    {
+        ssim_row_tail<T>(mu1, sigma1, mu2, sigma2, mu12, dst, len, 0);
+    }
+
+    template <>
+    void ssim_row<float>(const float* mu1, const float* sigma1, const float* mu2, const float* sigma2, const float* mu12, float* dst, int len)
+    {
+        int i = 0;
+#if CV_SIMD128
+        const v_float32x4
+            v_two = v_setall_f32(2.f)
+            , v_c1 = v_setall_f32((float)C1)
+            , v_c2 = v_setall_f32((float)C2)
+            ;
+        for (; i <= len - v_float32x4::nlanes; i += v_float32x4::nlanes)
+        {
+            const v_float32x4 m1 = v_load(mu1 + i), m2 = v_load(mu2 + i);
+            const v_float32x4 mu1_mu2 = m1 * m2;
+            const v_float32x4 sigma12 = v_load(mu12 + i) - mu1_mu2;
+            const v_float32x4 num = (v_two * mu1_mu2 + v_c1) * (v_two * sigma12 + v_c2);
+            const v_float32x4 denom = (m1 * m1 + m2 * m2 + v_c1) * (v_load(sigma1 + i) + v_load(sigma2 + i) + v_c2);
+            v_store(dst + i, num / denom);
+        }
+#endif
+        ssim_row_tail<float>(mu1, sigma1, mu2, sigma2, mu12, dst, len, i);
+    }
+
+    // mean ssim per channel in a single pass over the statistics, fills qmap unless it is empty
+    template <typename T>
+    cv::Scalar ssim_fused(const Mat& mu1, const Mat& sigma1, const Mat& mu2, const Mat& sigma2, const Mat& mu12, Mat& qmap)
+    {
+        const int
+            cn = mu1.channels()
+            , len = mu1.cols * cn
+            ;
+        CV_Assert(cn <= 4);
+
+        // per row sums, so the result does not depend on the number of threads
+        std::vector<double> row_sums((size_t)mu1.rows * cn, 0.);
+        cv::parallel_for_(Range(0, mu1.rows), [&](const Range& range)
+        {
+            std::vector<T> buf(qmap.empty() ? len : 0);
+            for (int y = range.start; y < range.end; ++y)
+            {
+                T* dst = qmap.empty() ? buf.data() : qmap.ptr<T>(y);
+                ssim_row<T>(mu1.ptr<T>(y), sigma1.ptr<T>(y), mu2.ptr<T>(y), sigma2.ptr<T>(y), mu12.ptr<T>(y), dst, len);
+                double* sums = &row_sums[(size_t)y * cn];
+                for (int c = 0; c < cn; ++c)
+                {
+                    double sum = 0.;
+                    for (int i = c; i < len; i += cn)
+                        sum += dst[i];
+                    sums[c] = sum;
+                }
+            }
+        });
+
+        cv::Scalar result = {};
+        for (int y = 0; y < mu1.rows; ++y)
+            for (int c = 0; c < cn; ++c)
+                result[c] += row_sums[(size_t)y * cn + c];
+        return result / (double)mu1.total();
+    }
 }   // ns
 
 QualitySSIM::_mat_data::_mat_data( const _mat_type& mat )
 {
     this->I = mat;
-    cv::multiply(this->I, this->I, this->I_2);
     this->mu = ::blur(this->I);
-    cv::multiply(this->mu, this->mu, this->mu_2);
-    this->sigma_2 = ::blur(this->I_2);    // blur the squared img, subtract blurred_squared
-    cv::subtract(this->sigma_2, this->mu_2, this->sigma_2);
+
+    mat_type
+        I_2
+        , mu_2
+        ;
+    cv::multiply(this->I, this->I, I_2);
+    cv::multiply(this->mu, this->mu, mu_2);
+    this->sigma_2 = ::blur(I_2);    // blur the squared img, subtract blurred_squared
+    cv::subtract(this->sigma_2, mu_2, this->sigma_2);
 }
 
 QualitySSIM::_mat_data::_mat_data(InputArray arr )
@@ -47,7 +141,7 @@ Ptr<QualitySSIM> QualitySSIM::create( InputArray ref )
 // static
 cv::Scalar QualitySSIM::compute( InputArray ref, InputArray cmp, OutputArray qualityMap )
 {
-    auto result = _mat_data::compute( _mat_data(ref), _mat_data(cmp) );
+    auto result = _mat_data::compute( _mat_data(ref), _mat_data(cmp), qualityMap.needed() );
 
     if (qualityMap.needed())
         qualityMap.assign(result.second);
@@ -66,27 +160,71 @@ cv::Scalar QualitySSIM::compute( InputArray cmp )
     return result.first;
 }
 
+void QualitySSIM::computeBatch( InputArrayOfArrays cmpImgs, std::vector<cv::Scalar>& scores )
+{
+    scores.assign(cmpImgs.total(), cv::Scalar());
+    const auto fn = [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; ++i)
+            scores[i] = _mat_data::compute(
+                this->_refImgData
+                , _mat_data(quality_utils::expand_mat_at<_mat_data::mat_type>(cmpImgs, i))
+                , false
+            ).first;
+    };
+
+    // the frames are processed concurrently on the cpu, the opencl path keeps one queue
+    if (cv::ocl::useOpenCL())
+        fn(Range(0, (int)scores.size()));
+    else
+        cv::parallel_for_(Range(0, (int)scores.size()), fn);
+}
+
 // static.  computes ssim and quality map for single frame
 // based on https://docs.opencv.org/2.4/doc/tutorials/highgui/video-input-psnr-ssim/video-input-psnr-ssim.html
-std::pair<cv::Scalar, _mat_type> QualitySSIM::_mat_data::compute(const _mat_data& lhs, const _mat_data& rhs)
+std::pair<cv::Scalar, _mat_type> QualitySSIM::_mat_data::compute(const _mat_data& lhs, const _mat_data& rhs, bool need_map)
 {
-    const double
-        C1 = 6.5025
-        , C2 = 58.5225
+    mat_type
+        I1_I2
+        , mu12
         ;
 
+    cv::multiply(lhs.I, rhs.I, I1_I2);
+    mu12 = ::blur(I1_I2);
+
+    // on the cpu, the remaining terms are combined in one pass without temporary images
+    if (!cv::ocl::useOpenCL() && (lhs.mu.depth() == CV_32F || lhs.mu.depth() == CV_64F))
+    {
+        std::pair<cv::Scalar, _mat_type> result;
+        if (need_map)
+            result.second.create(lhs.mu.size(), lhs.mu.type());
+        {
+            const Mat
+                mu1 = lhs.mu.getMat(ACCESS_READ)
+                , sigma1 = lhs.sigma_2.getMat(ACCESS_READ)
+                , mu2 = rhs.mu.getMat(ACCESS_READ)
+                , sigma2 = rhs.sigma_2.getMat(ACCESS_READ)
+                , mu12_ = mu12.getMat(ACCESS_READ)
+                ;
+            Mat qmap = need_map ? result.second.getMat(ACCESS_WRITE) : Mat();
+            result.first = (mu1.depth() == CV_32F)
+                ? ::ssim_fused<float>(mu1, sigma1, mu2, sigma2, mu12_, qmap)
+                : ::ssim_fused<double>(mu1, sigma1, mu2, sigma2, mu12_, qmap)
+                ;
+        }
+        return result;
+    }
+
     mat_type
-        I1_I2
-        , mu1_mu2
+        mu1_mu2
         , t1
         , t2
         , t3
         , sigma12
         ;
 
-    cv::multiply(lhs.I, rhs.I, I1_I2);
     cv::multiply(lhs.mu, rhs.mu, mu1_mu2);
-    cv::subtract(::blur(I1_I2), mu1_mu2, sigma12);
+    cv::subtract(mu12, mu1_mu2, sigma12);
 
     // t3 = ((2*mu1_mu2 + C1).*(2*sigma12 + C2))
     cv::multiply(mu1_mu2, 2., t1);
@@ -99,7 +237,9 @@ std::pair<cv::Scalar, _mat_type> QualitySSIM::_mat_data::compute(const _mat_data
     cv::multiply(t1, t2, t3);
 
     // t1 =((mu1_2 + mu2_2 + C1).*(sigma1_2 + sigma2_2 + C2))
-    cv::add(lhs.mu_2, rhs.mu_2, t1);
+    cv::multiply(lhs.mu, lhs.mu, t1);
+    cv::multiply(rhs.mu, rhs.mu, t2);
+    cv::add(t1, t2, t1);
     cv::add(t1, C1, t1);
 
     cv::add(lhs.sigma_2, rhs.sigma_2, t2);
@@ -115,4 +255,4 @@ std::pair<cv::Scalar, _mat_type> QualitySSIM::_mat_data::compute(const _mat_data
         cv::mean(t3)
         , std::move(t3)
     };
-}   // compute
\ No newline at end of file
+}   // compute
@@ -66,6 +66,14 @@ TEST(TEST_CASE_NAME, model_persistence )
     fn();   // model/range should persist with brisque ptr through multiple invocations
 }
 
+// several images scored in parallel, with and without opencl
+TEST(TEST_CASE_NAME, batch)
+{
+    auto fn = []() { quality_batch_test(create_brisque(), { get_testfile_1a(), get_testfile_2a(), get_testfile_1a() }, { BRISQUE_EXPECTED_1, BRISQUE_EXPECTED_2, BRISQUE_EXPECTED_1 }); };
+    OCL_OFF( fn() );
+    OCL_ON( fn() );
+}
+
 // check compute features interface method
 TEST(TEST_CASE_NAME, compute_features)
 {
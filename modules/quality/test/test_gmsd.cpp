@@ -39,6 +39,24 @@ TEST(TEST_CASE_NAME, multi_channel)
     quality_test(quality::QualityGMSD::create(get_testfile_2a()), get_testfile_2b(), GMSD_EXPECTED_2);
 }
 
+// static method, score only
+TEST(TEST_CASE_NAME, static_no_map)
+{
+    quality_expect_near(quality::QualityGMSD::compute(get_testfile_1a(), get_testfile_1b(), cv::noArray()), GMSD_EXPECTED_1);
+}
+
+// several comparison images against one reference, with/without opencl
+TEST(TEST_CASE_NAME, batch)
+{
+    auto fn = []()
+    {
+        quality_batch_test(quality::QualityGMSD::create(get_testfile_1a()), { get_testfile_1b(), get_testfile_1a() }, { GMSD_EXPECTED_1, cv::Scalar(0.) });
+        quality_batch_test(quality::QualityGMSD::create(get_testfile_2a()), { get_testfile_2b(), get_testfile_2a(), get_testfile_2b() }, { GMSD_EXPECTED_2, cv::Scalar(0., 0., 0.), GMSD_EXPECTED_2 });
+    };
+    OCL_OFF(fn());
+    OCL_ON(fn());
+}
+
 // internal A/B test
 /*
 TEST(TEST_CASE_NAME, performance)
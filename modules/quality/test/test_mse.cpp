@@ -33,6 +33,24 @@ TEST(TEST_CASE_NAME, multi_channel)
     quality_test(quality::QualityMSE::create(get_testfile_2a()), get_testfile_2b(), MSE_EXPECTED_2);
 }
 
+// static method, score only
+TEST(TEST_CASE_NAME, static_no_map)
+{
+    quality_expect_near(quality::QualityMSE::compute(get_testfile_1a(), get_testfile_1b(), cv::noArray()), MSE_EXPECTED_1);
+}
+
+// several comparison images against one reference, with/without opencl
+TEST(TEST_CASE_NAME, batch)
+{
+    auto fn = []()
+    {
+        quality_batch_test(quality::QualityMSE::create(get_testfile_1a()), { get_testfile_1b(), get_testfile_1a() }, { MSE_EXPECTED_1, cv::Scalar(0.) });
+        quality_batch_test(quality::QualityMSE::create(get_testfile_2a()), { get_testfile_2b(), get_testfile_2a(), get_testfile_2b() }, { MSE_EXPECTED_2, cv::Scalar(0., 0., 0.), MSE_EXPECTED_2 });
+    };
+    OCL_OFF(fn());
+    OCL_ON(fn());
+}
+
 // internal a/b test
 /*
 TEST(TEST_CASE_NAME, performance)
@@ -101,6 +101,16 @@ inline void quality_test(cv::Ptr<quality::QualityBase> ptr, const TMat& cmp, con
     EXPECT_TRUE(ptr->empty());
 }
 
+// execute batch quality test, the scores are expected in the order of the comparison images
+inline void quality_batch_test(cv::Ptr<quality::QualityBase> ptr, const std::vector<cv::Mat>& cmps, const std::vector<cv::Scalar>& expected)
+{
+    std::vector<cv::Scalar> scores;
+    ptr->computeBatch(cmps, scores);
+    ASSERT_EQ(expected.size(), scores.size());
+    for (size_t i = 0; i < scores.size(); ++i)
+        quality_expect_near(expected[i], scores[i]);
+}
+
 /* A/B test benchmarking for development purposes */
 /*
 template <typename Fn>
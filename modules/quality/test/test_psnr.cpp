@@ -38,6 +38,24 @@ TEST(TEST_CASE_NAME, multi_channel)
     quality_test(quality::QualityPSNR::create(get_testfile_2a()), get_testfile_2b(), PSNR_EXPECTED_2);
 }
 
+// static method, score only
+TEST(TEST_CASE_NAME, static_no_map)
+{
+    quality_expect_near(quality::QualityPSNR::compute(get_testfile_1a(), get_testfile_1b(), cv::noArray()), PSNR_EXPECTED_1);
+}
+
+// several comparison images against one reference, with/without opencl
+TEST(TEST_CASE_NAME, batch)
+{
+    auto fn = []()
+    {
+        quality_batch_test(quality::QualityPSNR::create(get_testfile_1a()), { get_testfile_1b(), get_testfile_1a() }, { PSNR_EXPECTED_1, cv::Scalar(INFINITY, INFINITY, INFINITY, INFINITY) });
+        quality_batch_test(quality::QualityPSNR::create(get_testfile_2a()), { get_testfile_2b(), get_testfile_2a(), get_testfile_2b() }, { PSNR_EXPECTED_2, cv::Scalar(INFINITY, INFINITY, INFINITY, INFINITY), PSNR_EXPECTED_2 });
+    };
+    OCL_OFF(fn());
+    OCL_ON(fn());
+}
+
 // internal a/b test
 /*
 TEST(TEST_CASE_NAME, performance)
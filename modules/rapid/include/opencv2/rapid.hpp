@@ -134,6 +134,26 @@ public:
     CV_WRAP virtual void clearState() = 0;
 };
 
+/**
+ * Track several objects in the same video frame
+ *
+ * Runs @ref Tracker::compute of every tracker in parallel. Each tracker keeps its own state and
+ * buffers, so a tracker must appear only once in the list.
+ * @param trackers the trackers, one per object
+ * @param img the video frame
+ * @param num number of search lines per object
+ * @param len search line radius
+ * @param K camera matrix
+ * @param rvecs rotations between the meshes and the camera, one per tracker. Refined in place.
+ * @param tvecs translations between the meshes and the camera, one per tracker. Refined in place.
+ * @param termcrit termination criteria of every tracker, see @ref Tracker::compute
+ * @return the ratios returned by the trackers
+ */
+CV_EXPORTS std::vector<float>
+computeMultiple(const std::vector<Ptr<Tracker> >& trackers, InputArray img, int num, int len, InputArray K,
+                InputOutputArrayOfArrays rvecs, InputOutputArrayOfArrays tvecs,
+                const TermCriteria& termcrit = TermCriteria(TermCriteria::MAX_ITER | TermCriteria::EPS, 5, 1.5));
+
 /// wrapper around @ref rapid function for uniform access
 class CV_EXPORTS_W Rapid : public Tracker
 {
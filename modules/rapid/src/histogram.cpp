@@ -13,18 +13,23 @@ static void compute1DCanny(const cv::Mat& src, cv::Mat& dst, uchar threshold)
     compute1DSobel(src, dst);
 
     // step2: compute 1D non-maximum suppression + threshold
-    for (int i = 0; i < dst.rows; i++)
+    // the rows are independent, within a row the suppressed values are used by the next pixel
+    parallel_for_(Range(0, dst.rows), [&](const Range& range)
     {
-        for (int j = 1; j < dst.cols - 1; j++)
+        for (int i = range.start; i < range.end; i++)
         {
-            if (dst.at<uchar>(i, j) <= dst.at<uchar>(i, j - 1) || dst.at<uchar>(i, j) <= dst.at<uchar>(i, j + 1))
-                dst.at<uchar>(i, j) = 0;
+            uchar* d = dst.ptr<uchar>(i);
+            for (int j = 1; j < dst.cols - 1; j++)
+            {
+                if (d[j] <= d[j - 1] || d[j] <= d[j + 1])
+                    d[j] = 0;
 
-            // threshold
-            if(dst.at<uchar>(i, j) < threshold)
-                dst.at<uchar>(i, j) = 0;
+                // threshold
+                if(d[j] < threshold)
+                    d[j] = 0;
+            }
         }
-    }
+    });
 }
 
 static void calcHueSatHist(const Mat_<Vec3b>& hsv, Mat_<float>& hist)
@@ -184,6 +189,12 @@ struct HistTrackerImpl : public OLSTracker
 
     bool useGOS;
 
+    // buffers reused across iterations and frames
+    Mat pts2d, pts3d;
+    Mat lineBundle, imgLoc;
+    Mat bundleHSV, bundleGrad;
+    Mat_<float> scores, bgScores;
+
     HistTrackerImpl(InputArray _pts3d, InputArray _tris, int histBins, uchar _sobelThesh, bool _useGOS)
     {
         CV_Assert(_tris.getMat().checkVector(3, CV_32S) > 0);
@@ -200,74 +211,101 @@ struct HistTrackerImpl : public OLSTracker
 
     void computeAppearanceScores(const Mat& bundleHSV, const Mat& bundleGrad, Mat_<float>& scores) const
     {
-        scores.resize(bundleHSV.rows);
+        scores.create(bundleHSV.size());
         scores = 0;
-        Mat_<float> hist(fgHist.size());
 
-        for (int i = 0; i < bundleHSV.rows; i++)
+        // the search lines are independent
+        parallel_for_(Range(0, bundleHSV.rows), [&](const Range& range)
         {
-            int start = 0;
-            for (int j = 0; j < bundleHSV.cols; j++)
+            Mat_<float> hist(fgHist.size());
+            for (int i = range.start; i < range.end; i++)
             {
-                if (bundleGrad.at<uchar>(i, j))
+                int start = 0;
+                for (int j = 0; j < bundleHSV.cols; j++)
                 {
-                    // compute the histogram between last candidate point to current candidate point
-                    // as in eq. (4)
-                    hist = 0;
-                    calcHueSatHist(bundleHSV({i, i + 1}, {start, j}), hist);
-                    hist /= std::max(sum(hist), 1.0f);
-
-                    double s = bhattacharyyaCoeff(fgHist, hist);
-                    // handle object clutter as in eq. (5)
-                    if(s > tau)
-                        s = 1.0 - bhattacharyyaCoeff(bgHist, hist);
-                    scores(i, j) = float(s);
-                    start = j;
+                    if (bundleGrad.at<uchar>(i, j))
+                    {
+                        // compute the histogram between last candidate point to current candidate point
+                        // as in eq. (4)
+                        hist = 0;
+                        calcHueSatHist(bundleHSV({i, i + 1}, {start, j}), hist);
+                        hist /= std::max(sum(hist), 1.0f);
+
+                        double s = bhattacharyyaCoeff(fgHist, hist);
+                        // handle object clutter as in eq. (5)
+                        if(s > tau)
+                            s = 1.0 - bhattacharyyaCoeff(bgHist, hist);
+                        scores(i, j) = float(s);
+                        start = j;
+                    }
                 }
             }
-        }
+        });
     }
 
-    void computeBackgroundScores(const Mat& bundleHSV, const Mat& bundleGrad, Mat_<float>& scores)
+    void computeBackgroundScores(const Mat& bundleHSV, const Mat& bundleGrad, Mat_<float>& scores) const
     {
-        scores.resize(bundleHSV.rows);
+        scores.create(bundleHSV.size());
         scores = 0;
 
-        Mat_<float> hist(fgHist.size());
-
-        for (int i = 0; i < bundleHSV.rows; i++)
+        // the search lines are independent
+        parallel_for_(Range(0, bundleHSV.rows), [&](const Range& range)
         {
-            int end = bundleHSV.cols - 1;
-            for (int j = bundleHSV.cols - 1; j >= 0; j--)
+            Mat_<float> hist(fgHist.size());
+            for (int i = range.start; i < range.end; i++)
             {
-                if (bundleGrad.at<uchar>(i, j))
+                int end = bundleHSV.cols - 1;
+                for (int j = bundleHSV.cols - 1; j >= 0; j--)
                 {
-                    // compute the histogram between last candidate point to current candidate point
-                    hist = 0;
-                    calcHueSatHist(bundleHSV({i, i + 1}, {j, end}), hist);
-                    hist /= std::max(sum(hist), 1.0f);
+                    if (bundleGrad.at<uchar>(i, j))
+                    {
+                        // compute the histogram between last candidate point to current candidate point
+                        hist = 0;
+                        calcHueSatHist(bundleHSV({i, i + 1}, {j, end}), hist);
+                        hist /= std::max(sum(hist), 1.0f);
 
-                    double s = 1 - bhattacharyyaCoeff(fgHist, hist);
-                    if (s <= tau)
-                        s = bhattacharyyaCoeff(bgHist, hist);
+                        double s = 1 - bhattacharyyaCoeff(fgHist, hist);
+                        if (s <= tau)
+                            s = bhattacharyyaCoeff(bgHist, hist);
 
-                    scores(i, j) = float(s);
-                    end = j;
+                        scores(i, j) = float(s);
+                        end = j;
+                    }
                 }
             }
-        }
+        });
     }
 
     void updateFgBgHist(const Mat_<Vec3b>& hsv, const Mat_<int>& cols)
     {
+        // stripes of search lines are counted in parallel, the counts are integers so
+        // adding the stripes gives the same histograms as the serial loop
+        const int STRIPE_ROWS = 16;
+        const int nstripes = (hsv.rows + STRIPE_ROWS - 1) / STRIPE_ROWS;
+        std::vector<Mat_<float> > fgHists(nstripes), bgHists(nstripes);
+        parallel_for_(Range(0, nstripes), [&](const Range& range)
+        {
+            for (int s = range.start; s < range.end; s++)
+            {
+                fgHists[s].create(fgHist.size());
+                bgHists[s].create(bgHist.size());
+                fgHists[s] = 0;
+                bgHists[s] = 0;
+                for (int i = s * STRIPE_ROWS; i < std::min((s + 1) * STRIPE_ROWS, hsv.rows); i++)
+                {
+                    int col = cols(i) < 0 ? hsv.cols / 2 + 1 : cols(i);
+                    calcHueSatHist(hsv({i, i + 1}, {0, col}), fgHists[s]);
+                    calcHueSatHist(hsv({i, i + 1}, {col + 1, hsv.cols}), bgHists[s]);
+                }
+            }
+        });
+
         fgHist = 0;
         bgHist = 0;
-
-        for (int i = 0; i < hsv.rows; i++)
+        for (int s = 0; s < nstripes; s++)
         {
-            int col = cols(i) < 0 ? hsv.cols / 2 + 1 : cols(i);
-            calcHueSatHist(hsv({i, i + 1}, {0, col}), fgHist);
-            calcHueSatHist(hsv({i, i + 1}, {col + 1, hsv.cols}), bgHist);
+            fgHist += fgHists[s];
+            bgHist += bgHists[s];
         }
 
         fgHist /= sum(fgHist);
@@ -278,7 +316,6 @@ struct HistTrackerImpl : public OLSTracker
                   InputOutputArray tvec, const TermCriteria& termcrit) CV_OVERRIDE
     {
         CV_Assert(num >= 3);
-        Mat pts2d, pts3d;
 
         float ret = 0;
 
@@ -289,10 +326,8 @@ struct HistTrackerImpl : public OLSTracker
             if (pts2d.empty())
                 return 0;
 
-            Mat lineBundle, imgLoc;
             extractLineBundle(len, pts2d, img, lineBundle, imgLoc);
 
-            Mat bundleHSV;
             cvtColor(lineBundle, bundleHSV, COLOR_BGR2HSV_FULL);
 
             Mat_<int> cols(num, 1);
@@ -304,15 +339,12 @@ struct HistTrackerImpl : public OLSTracker
                 updateFgBgHist(bundleHSV, cols);
             }
 
-            Mat bundleGrad;
             compute1DCanny(lineBundle, bundleGrad, sobelThresh);
 
-            Mat_<float> scores(lineBundle.size());
             computeAppearanceScores(bundleHSV, bundleGrad, scores);
 
             if(useGOS)
             {
-                Mat_<float> bgScores(scores.size());
                 computeBackgroundScores(bundleHSV, bundleGrad, bgScores);
                 findCorrespondenciesGOS(bundleGrad, scores, bgScores, imgLoc, cols);
             }
@@ -180,20 +180,24 @@ void extractLineBundle(int len, InputArray ctl2d, InputArray img, OutputArray bu
     srcLocations.create(N, W, CV_16SC2);
     Mat_<Vec2s> _srcLocations = srcLocations.getMat();
 
-    for (int i = 0; i < N; i++) {
-        // central difference
-        const Point2f diff = contour((i + 1) % N) - contour((i - 1 + N) % N);
-        Point2f n(normalize(Vec2f(-diff.y, diff.x))); // perpendicular to diff
-        // make it cover L pixels
-        n *= len / std::max(std::abs(n.x), std::abs(n.y));
-
-        LineIterator li(_img, contour(i) - n, contour(i) + n);
-        CV_DbgAssert(li.count == W);
-
-        for (int j = 0; j < li.count; j++, ++li) {
-            _srcLocations(i, j) = Vec2i(li.pos());
+    // the search lines are independent
+    parallel_for_(Range(0, N), [&](const Range& range) {
+        for (int i = range.start; i < range.end; i++) {
+            // central difference
+            const Point2f diff = contour((i + 1) % N) - contour((i - 1 + N) % N);
+            Point2f n(normalize(Vec2f(-diff.y, diff.x))); // perpendicular to diff
+            // make it cover L pixels
+            n *= len / std::max(std::abs(n.x), std::abs(n.y));
+
+            LineIterator li(_img, contour(i) - n, contour(i) + n);
+            CV_DbgAssert(li.count == W);
+
+            Vec2s* loc = _srcLocations[i];
+            for (int j = 0; j < li.count; j++, ++li) {
+                loc[j] = Vec2i(li.pos());
+            }
         }
-    }
+    });
 
     remap(img, bundle, srcLocations, noArray(),
           INTER_NEAREST); // inter_nearest as we use integer locations
@@ -208,19 +212,24 @@ void compute1DSobel(const Mat& src, Mat& dst)
 
     dst.create(src.size(), CV_8U);
 
-    for (int i = 0; i < src.rows; i++) {
-        for (int j = 1; j < src.cols - 1; j++) {
-            // central difference kernel: [-1, 0, 1]
-            if (channels == 3) {
-                const Vec3s diff = Vec3s(src.at<Vec3b>(i, j + 1)) - Vec3s(src.at<Vec3b>(i, j - 1));
-                dst.at<uchar>(i, j) =
-                    (uchar)std::max(std::max(std::abs(diff[0]), std::abs(diff[1])), std::abs(diff[2]));
-            } else {
-                dst.at<uchar>(i, j) = (uchar)std::abs(src.at<uchar>(i, j + 1) - src.at<uchar>(i, j - 1));
+    parallel_for_(Range(0, src.rows), [&](const Range& range) {
+        for (int i = range.start; i < range.end; i++) {
+            const uchar* s = src.ptr<uchar>(i);
+            uchar* d = dst.ptr<uchar>(i);
+            for (int j = 1; j < src.cols - 1; j++) {
+                // central difference kernel: [-1, 0, 1]
+                if (channels == 3) {
+                    const uchar* l = s + (j - 1) * 3;
+                    const uchar* r = s + (j + 1) * 3;
+                    d[j] = (uchar)std::max(std::max(std::abs(r[0] - l[0]), std::abs(r[1] - l[1])),
+                                           std::abs(r[2] - l[2]));
+                } else {
+                    d[j] = (uchar)std::abs(s[j + 1] - s[j - 1]);
+                }
             }
+            d[0] = d[src.cols - 1] = 0; // border
         }
-        dst.at<uchar>(i, 0) = dst.at<uchar>(i, src.cols - 1) = 0; // border
-    }
+    });
 }
 
 void findCorrespondencies(InputArray bundle, OutputArray _cols, OutputArray _response)
@@ -325,28 +334,36 @@ void convertCorrespondencies(InputArray _cols, InputArray _srcLocations, OutputA
         opts3d.copyTo(_pts3d);
 }
 
-float rapid(InputArray img, int num, int len, InputArray vtx, InputArray tris, InputArray K,
-            InputOutputArray rvec, InputOutputArray tvec, double* rmsd)
+/// buffers of a rapid iteration, kept by the trackers to reuse them across iterations and frames
+struct RapidBuffers
 {
-    CV_Assert(num >= 3);
     Mat pts2d, pts3d;
+    Mat lineBundle, imgLoc;
+    Mat cols, response, mask;
+};
+
+static float rapid(InputArray img, int num, int len, InputArray vtx, InputArray tris, InputArray K,
+                   InputOutputArray rvec, InputOutputArray tvec, double* rmsd, RapidBuffers& buf)
+{
+    CV_Assert(num >= 3);
+    Mat& pts2d = buf.pts2d;
+    Mat& pts3d = buf.pts3d;
     extractControlPoints(num, len, vtx, rvec, tvec, K, img.size(), tris, pts2d, pts3d);
     if (pts2d.empty())
         return 0;
 
-    Mat lineBundle, imgLoc;
-    extractLineBundle(len, pts2d, img, lineBundle, imgLoc);
+    extractLineBundle(len, pts2d, img, buf.lineBundle, buf.imgLoc);
 
-    Mat cols, response;
-    findCorrespondencies(lineBundle, cols, response);
+    Mat& cols = buf.cols;
+    findCorrespondencies(buf.lineBundle, cols, buf.response);
 
     const uchar sobel_thresh = 20;
-    Mat mask = response > sobel_thresh;
-    convertCorrespondencies(cols, imgLoc, pts2d, pts3d, mask);
+    compare(buf.response, sobel_thresh, buf.mask, CMP_GT);
+    convertCorrespondencies(cols, buf.imgLoc, pts2d, pts3d, buf.mask);
 
     if(rmsd)
     {
-        cols.copyTo(cols, mask);
+        cols.copyTo(cols, buf.mask);
         cols -= len + 1;
         *rmsd = std::sqrt(norm(cols, NORM_L2SQR) / cols.rows);
     }
@@ -359,12 +376,47 @@ float rapid(InputArray img, int num, int len, InputArray vtx, InputArray tris, I
     return float(pts2d.rows) / num;
 }
 
+float rapid(InputArray img, int num, int len, InputArray vtx, InputArray tris, InputArray K,
+            InputOutputArray rvec, InputOutputArray tvec, double* rmsd)
+{
+    RapidBuffers buf;
+    return rapid(img, num, len, vtx, tris, K, rvec, tvec, rmsd, buf);
+}
+
 Tracker::~Tracker() {}
 
+std::vector<float> computeMultiple(const std::vector<Ptr<Tracker> >& trackers, InputArray img, int num, int len,
+                                   InputArray K, InputOutputArrayOfArrays rvecs, InputOutputArrayOfArrays tvecs,
+                                   const TermCriteria& termcrit)
+{
+    const int N = int(trackers.size());
+    CV_Assert(int(rvecs.total()) == N && int(tvecs.total()) == N);
+
+    Mat _img = img.getMat();
+    Mat _K = K.getMat();
+    std::vector<Mat> rv(N), tv(N);
+    for (int i = 0; i < N; i++)
+    {
+        CV_Assert(trackers[i]);
+        // share the data of the poses, which are refined in place
+        rv[i] = rvecs.getMat(i);
+        tv[i] = tvecs.getMat(i);
+    }
+
+    // every tracker owns its state, the objects are tracked in parallel
+    std::vector<float> ratios(N, 0.f);
+    parallel_for_(Range(0, N), [&](const Range& range) {
+        for (int i = range.start; i < range.end; i++)
+            ratios[i] = trackers[i]->compute(_img, num, len, _K, rv[i], tv[i], termcrit);
+    });
+    return ratios;
+}
+
 struct RapidImpl : public Rapid
 {
     Mat pts3d;
     Mat tris;
+    RapidBuffers buf;
     RapidImpl(InputArray _pts3d, InputArray _tris)
     {
         CV_Assert(_tris.getMat().checkVector(3, CV_32S) > 0);
@@ -379,11 +431,10 @@ struct RapidImpl : public Rapid
         int niter = std::max(1, termcrit.maxCount);
 
         double rmsd;
-        Mat cols;
         for(int i = 0; i < niter; i++)
         {
             ret = rapid(img, num, len, pts3d, tris, K, rvec, tvec,
-                        termcrit.type & TermCriteria::EPS ? &rmsd : NULL);
+                        termcrit.type & TermCriteria::EPS ? &rmsd : NULL, buf);
 
             if((termcrit.type & TermCriteria::EPS) && rmsd < termcrit.epsilon)
             {
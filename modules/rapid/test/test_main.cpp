@@ -44,4 +44,60 @@ TEST(CV_Rapid, rapid)
     ASSERT_LT(cv::norm(trans - t_init), 0.075);
 }
 
+TEST(CV_Rapid, computeMultiple)
+{
+    // a unit sized box
+    std::vector<Vec3f> vtx = {
+        {1, -1, -1}, {1, -1, 1}, {-1, -1, 1}, {-1, -1, -1}, {1, 1, -1}, {1, 1, 1}, {-1, 1, 1}, {-1, 1, -1},
+    };
+    std::vector<Vec3i> tris = {
+        {2, 4, 1}, {8, 6, 5}, {5, 2, 1}, {6, 3, 2}, {3, 8, 4}, {1, 8, 5},
+        {2, 3, 4}, {8, 7, 6}, {5, 6, 2}, {6, 7, 3}, {3, 7, 8}, {1, 4, 8},
+    };
+    Mat(tris) -= Scalar(1, 1, 1);
+
+    // camera setup
+    Size sz(1280, 720);
+
+    Mat K = getDefaultNewCameraMatrix(Matx33f::diag(Vec3f(800, 800, 1)), sz, true);
+    std::vector<Vec3f> trans = {{-2.5f, 0, 8}, {2.5f, 0, 8}};
+    Vec3f rot = {0.7f, 0.6f, 0};
+
+    // draw two boxes side by side
+    Mat_<uchar> img(sz, uchar(0));
+    for (size_t i = 0; i < trans.size(); i++)
+    {
+        Mat pts2d;
+        projectPoints(vtx, rot, trans[i], K, noArray(), pts2d);
+        rapid::drawWireframe(img, pts2d, tris, Scalar(255), LINE_8);
+    }
+
+    // recover the poses from different positions
+    std::vector<Mat> rvecs, tvecs;
+    std::vector<Ptr<rapid::Tracker> > trackers;
+    for (size_t i = 0; i < trans.size(); i++)
+    {
+        rvecs.push_back(Mat(rot, true));
+        tvecs.push_back(Mat(trans[i] + Vec3f(0.1f, 0, 0), true));
+        trackers.push_back(rapid::Rapid::create(vtx, tris));
+    }
+
+    // do two iterations
+    TermCriteria term(TermCriteria::MAX_ITER, 2, 0);
+    std::vector<float> ratios = rapid::computeMultiple(trackers, img, 100, 20, K, rvecs, tvecs, term);
+    ASSERT_EQ(trans.size(), ratios.size());
+
+    for (size_t i = 0; i < trans.size(); i++)
+    {
+        // same result as tracking the object on its own
+        Vec3f r = rot, t = trans[i] + Vec3f(0.1f, 0, 0);
+        float ratio = rapid::Rapid::create(vtx, tris)->compute(img, 100, 20, K, r, t, term);
+        EXPECT_EQ(ratio, ratios[i]);
+        EXPECT_LE(cv::norm(Vec3f(tvecs[i]) - t), 1e-6);
+
+        // assert that it improved from init
+        EXPECT_LT(cv::norm(trans[i] - Vec3f(tvecs[i])), 0.1);
+    }
+}
+
 }} // namespace
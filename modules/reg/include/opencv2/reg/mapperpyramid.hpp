@@ -63,10 +63,24 @@ public:
 
     CV_WRAP virtual cv::Ptr<Map> calculate(InputArray img1, InputArray img2, cv::Ptr<Map> init = cv::Ptr<Map>()) const CV_OVERRIDE;
 
+    /*
+     * Registers many pairs of images concurrently
+     * \param[in] img1 Reference images
+     * \param[in] img2 Warped images, one for each reference image
+     * \param[in,out] maps Map from img1[i] to img2[i] for every pair. If it is not empty on input, it
+     *                  has an element per pair whose non empty values are initial estimations that
+     *                  are refined in place, so they must be different objects.
+     */
+    void calculateBatch(InputArrayOfArrays img1, InputArrayOfArrays img2,
+                        std::vector<cv::Ptr<Map> >& maps) const;
+
     CV_WRAP cv::Ptr<Map> getMap() const CV_OVERRIDE;
 
     CV_PROP_RW int numLev_;           /*!< Number of levels of the pyramid */
     CV_PROP_RW int numIterPerScale_;  /*!< Number of iterations at a given scale of the pyramid */
+    CV_PROP_RW double convergenceThreshold_;  /*!< The iterations at a given scale stop when an update
+                                                   moves the image corners less than this number of
+                                                   pixels. Zero disables the early termination */
 
 private:
     MapperPyramid& operator=(const MapperPyramid&);
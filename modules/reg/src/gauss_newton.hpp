@@ -0,0 +1,133 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_REG_GAUSS_NEWTON_HPP
+#define OPENCV_REG_GAUSS_NEWTON_HPP
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/utility.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace cv {
+namespace reg {
+
+/*
+ * Thread local buffer for the image warped with the initial estimation, so that the iterations of
+ * a mapper do not allocate a new image every time
+ */
+Mat& getWarpBuffer();
+
+/*
+ * Dot product of two arrays of doubles
+ */
+double dotProduct(const double* a, const double* b, int len);
+
+/*
+ * Adds to Ab (upper triangle of A by rows followed by b) the contribution of the given rows. The
+ * gradient of img2 is calculated on the fly with the [-1, 0, 1]/2 kernel and replicated borders,
+ * exactly as Mapper::gradient does.
+ */
+template<typename T, int N, typename Jacobian>
+void accumulateGaussNewtonRows(const Mat& img1, const Mat& img2, const Range& rows, double* Ab,
+                               const Jacobian& jacobian)
+{
+    // Samples are processed in blocks, so that the Jacobian of a block stays in the cache while
+    // all the products are accumulated
+    enum { BLOCK = 64 };
+    double J[N][BLOCK], e[BLOCK], d[N];
+
+    const int cn = img1.channels();
+    const int cols = img1.cols;
+    const int width = cols*cn;
+    const int lastRow = img1.rows - 1;
+    for(int r_i = rows.start; r_i < rows.end; ++r_i) {
+        const T* ref = img1.ptr<T>(r_i);
+        const T* cur = img2.ptr<T>(r_i);
+        const T* up = img2.ptr<T>(std::max(r_i - 1, 0));
+        const T* down = img2.ptr<T>(std::min(r_i + 1, lastRow));
+        for(int k0 = 0; k0 < width; k0 += BLOCK) {
+            const int len = std::min((int)BLOCK, width - k0);
+            for(int j = 0; j < len; ++j) {
+                const int k = k0 + j;
+                const int c_i = k/cn;
+                const int kl = c_i > 0 ? k - cn : k;
+                const int kr = c_i < cols - 1 ? k + cn : k;
+                const double ix = ((double)cur[kr] - (double)cur[kl])*0.5;
+                const double iy = ((double)down[k] - (double)up[k])*0.5;
+                jacobian((double)c_i, (double)r_i, ix, iy, d);
+                for(int p = 0; p < N; ++p) {
+                    J[p][j] = d[p];
+                }
+                e[j] = (double)cur[k] - (double)ref[k];
+            }
+            double* acc = Ab;
+            for(int p = 0; p < N; ++p) {
+                for(int q = p; q < N; ++q) {
+                    *acc++ += dotProduct(J[p], J[q], len);
+                }
+            }
+            for(int p = 0; p < N; ++p) {
+                *acc++ -= dotProduct(e, J[p], len);
+            }
+        }
+    }
+}
+
+/*
+ * Builds the normal equations A*k = b of a Gauss-Newton step in a single pass over the images,
+ * A = sum(J^T*J) and b = -sum(It*J) over all the pixels and channels, It being img2 - img1 and J
+ * the derivatives of img2 with respect to the N parameters of the motion. The functor
+ * jacobian(x, y, Ix, Iy, J) writes the derivatives of a sample at column x and row y whose
+ * gradient is (Ix, Iy). The rows are split in stripes added in a fixed order, so the result does
+ * not depend on the number of threads.
+ */
+template<int N, typename Jacobian>
+void accumulateGaussNewton(const Mat& image1, const Mat& image2,
+                           Matx<double, N, N>& A, Vec<double, N>& b, const Jacobian& jacobian)
+{
+    CV_Assert(image1.size() == image2.size() && image1.type() == image2.type());
+
+    Mat img1 = image1, img2 = image2;
+    if(img1.depth() != CV_32F && img1.depth() != CV_64F) {
+        image1.convertTo(img1, CV_64F);
+        image2.convertTo(img2, CV_64F);
+    }
+
+    enum { STRIPE_ROWS = 16, SIZE = N*(N + 1)/2 + N };
+    const int numStripes = (img1.rows + STRIPE_ROWS - 1)/STRIPE_ROWS;
+    std::vector<double> partial((size_t)numStripes*SIZE, 0.);
+    parallel_for_(Range(0, numStripes), [&](const Range& range)
+    {
+        for(int s_i = range.start; s_i < range.end; ++s_i) {
+            Range rows(s_i*STRIPE_ROWS, std::min((s_i + 1)*STRIPE_ROWS, img1.rows));
+            double* Ab = &partial[(size_t)s_i*SIZE];
+            if(img1.depth() == CV_32F)
+                accumulateGaussNewtonRows<float, N>(img1, img2, rows, Ab, jacobian);
+            else
+                accumulateGaussNewtonRows<double, N>(img1, img2, rows, Ab, jacobian);
+        }
+    });
+
+    double Ab[SIZE] = {};
+    for(int s_i = 0; s_i < numStripes; ++s_i) {
+        for(int i = 0; i < SIZE; ++i) {
+            Ab[i] += partial[(size_t)s_i*SIZE + i];
+        }
+    }
+
+    const double* acc = Ab;
+    for(int p = 0; p < N; ++p) {
+        for(int q = p; q < N; ++q) {
+            A(p, q) = A(q, p) = *acc++;
+        }
+    }
+    for(int p = 0; p < N; ++p) {
+        b(p) = *acc++;
+    }
+}
+
+}}  // namespace cv::reg
+
+#endif  // OPENCV_REG_GAUSS_NEWTON_HPP
@@ -38,6 +38,8 @@
 #include "precomp.hpp"
 #include <opencv2/imgproc.hpp>
 #include "opencv2/reg/mapper.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+#include "gauss_newton.hpp"
 
 namespace cv {
 namespace reg {
@@ -46,16 +48,13 @@ namespace reg {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 void Mapper::gradient(const Mat& img1, const Mat& img2, Mat& Ix, Mat& Iy, Mat& It) const
 {
-    Size sz1 = img2.size();
-
     Mat xkern = (Mat_<double>(1, 3) << -1., 0., 1.)/2.;
     filter2D(img2, Ix, -1, xkern, Point(-1,-1), 0., BORDER_REPLICATE);
 
     Mat ykern = (Mat_<double>(3, 1) << -1., 0., 1.)/2.;
     filter2D(img2, Iy, -1, ykern, Point(-1,-1), 0., BORDER_REPLICATE);
 
-    It = Mat::zeros(sz1, img1.type());
-    It = img2 - img1;
+    subtract(img2, img1, It);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -99,5 +98,33 @@ void Mapper::grid(const Mat& img, Mat& grid_r, Mat& grid_c) const
         fillGridMatrices<double>(img, grid_r, grid_c);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Mat& getWarpBuffer()
+{
+    static TLSData<Mat>* warpBuffers = new TLSData<Mat>();
+    return *warpBuffers->get();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+double dotProduct(const double* a, const double* b, int len)
+{
+    double res = 0.;
+    int i = 0;
+#if CV_SIMD128_64F
+    v_float64x2 v_res0 = v_setzero_f64(), v_res1 = v_setzero_f64();
+    for(; i <= len - 2*v_float64x2::nlanes; i += 2*v_float64x2::nlanes) {
+        v_res0 = v_muladd(v_load(a + i), v_load(b + i), v_res0);
+        v_res1 = v_muladd(v_load(a + i + v_float64x2::nlanes), v_load(b + i + v_float64x2::nlanes), v_res1);
+    }
+    double CV_DECL_ALIGNED(16) buf[v_float64x2::nlanes];
+    v_store_aligned(buf, v_res0 + v_res1);
+    res = buf[0] + buf[1];
+#endif
+    for(; i < len; ++i) {
+        res += a[i]*b[i];
+    }
+    return res;
+}
+
 
 }}  // namespace cv::reg
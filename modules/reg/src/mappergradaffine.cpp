@@ -36,6 +36,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "gauss_newton.hpp"
 #include "opencv2/reg/mappergradaffine.hpp"
 #include "opencv2/reg/mapaffine.hpp"
 
@@ -59,7 +60,6 @@ MapperGradAffine::~MapperGradAffine()
 cv::Ptr<Map> MapperGradAffine::calculate(InputArray _img1, InputArray image2, cv::Ptr<Map> init) const
 {
     Mat img1 = _img1.getMat();
-    Mat gradx, grady, imgDiff;
     Mat img2;
 
     CV_DbgAssert(img1.size() == image2.size());
@@ -68,77 +68,27 @@ cv::Ptr<Map> MapperGradAffine::calculate(InputArray _img1, InputArray image2, cv
 
     if(!init.empty()) {
         // We have initial values for the registration: we move img2 to that initial reference
-        init->inverseWarp(image2, img2);
+        Mat& warped = getWarpBuffer();
+        init->inverseWarp(image2, warped);
+        img2 = warped;
     } else {
         img2 = image2.getMat();
     }
 
-    // Get gradient in all channels
-    gradient(img1, img2, gradx, grady, imgDiff);
-
-    // Matrices with reference frame coordinates
-    Mat grid_r, grid_c;
-    grid(img1, grid_r, grid_c);
-
-    // Calculate parameters using least squares
+    // Calculate parameters using least squares. The normal equations are accumulated in a single
+    // pass over the images, with the gradient and the pixel coordinates calculated on the fly.
     Matx<double, 6, 6> A;
     Vec<double, 6> b;
-    // For each value in A, all the matrix elements are added and then the channels are also added,
-    // so we have two calls to "sum". The result can be found in the first element of the final
-    // Scalar object.
-    Mat xIx = grid_c.mul(gradx);
-    Mat xIy = grid_c.mul(grady);
-    Mat yIx = grid_r.mul(gradx);
-    Mat yIy = grid_r.mul(grady);
-    Mat Ix2 = gradx.mul(gradx);
-    Mat Iy2 = grady.mul(grady);
-    Mat xy = grid_c.mul(grid_r);
-    Mat IxIy = gradx.mul(grady);
-    A(0, 0) = sum(sum(sqr(xIx)))[0];
-    A(0, 1) = sum(sum(xy.mul(Ix2)))[0];
-    A(0, 2) = sum(sum(grid_c.mul(Ix2)))[0];
-    A(0, 3) = sum(sum(sqr(grid_c).mul(IxIy)))[0];
-    A(0, 4) = sum(sum(xy.mul(IxIy)))[0];
-    A(0, 5) = sum(sum(grid_c.mul(IxIy)))[0];
-    A(1, 1) = sum(sum(sqr(yIx)))[0];
-    A(1, 2) = sum(sum(grid_r.mul(Ix2)))[0];
-    A(1, 3) = A(0, 4);
-    A(1, 4) = sum(sum(sqr(grid_r).mul(IxIy)))[0];
-    A(1, 5) = sum(sum(grid_r.mul(IxIy)))[0];
-    A(2, 2) = sum(sum(Ix2))[0];
-    A(2, 3) = A(0, 5);
-    A(2, 4) = A(1, 5);
-    A(2, 5) = sum(sum(IxIy))[0];
-    A(3, 3) = sum(sum(sqr(xIy)))[0];
-    A(3, 4) = sum(sum(xy.mul(Iy2)))[0];
-    A(3, 5) = sum(sum(grid_c.mul(Iy2)))[0];
-    A(4, 4) = sum(sum(sqr(yIy)))[0];
-    A(4, 5) = sum(sum(grid_r.mul(Iy2)))[0];
-    A(5, 5) = sum(sum(Iy2))[0];
-    // Lower half values (A is symmetric)
-    A(1, 0) = A(0, 1);
-    A(2, 0) = A(0, 2);
-    A(2, 1) = A(1, 2);
-    A(3, 0) = A(0, 3);
-    A(3, 1) = A(1, 3);
-    A(3, 2) = A(2, 3);
-    A(4, 0) = A(0, 4);
-    A(4, 1) = A(1, 4);
-    A(4, 2) = A(2, 4);
-    A(4, 3) = A(3, 4);
-    A(5, 0) = A(0, 5);
-    A(5, 1) = A(1, 5);
-    A(5, 2) = A(2, 5);
-    A(5, 3) = A(3, 5);
-    A(5, 4) = A(4, 5);
-
-    // Calculation of b
-    b(0) = -sum(sum(imgDiff.mul(xIx)))[0];
-    b(1) = -sum(sum(imgDiff.mul(yIx)))[0];
-    b(2) = -sum(sum(imgDiff.mul(gradx)))[0];
-    b(3) = -sum(sum(imgDiff.mul(xIy)))[0];
-    b(4) = -sum(sum(imgDiff.mul(yIy)))[0];
-    b(5) = -sum(sum(imgDiff.mul(grady)))[0];
+    accumulateGaussNewton(img1, img2, A, b,
+        [](double x, double y, double Ix, double Iy, double* J)
+        {
+            J[0] = x*Ix;
+            J[1] = y*Ix;
+            J[2] = Ix;
+            J[3] = x*Iy;
+            J[4] = y*Iy;
+            J[5] = Iy;
+        });
 
     // Calculate affine transformation. We use Cholesky decomposition, as A is symmetric.
     Vec<double, 6> k = A.inv(DECOMP_CHOLESKY)*b;
@@ -36,6 +36,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "gauss_newton.hpp"
 #include "opencv2/reg/mappergradeuclid.hpp"
 #include "opencv2/reg/mapaffine.hpp"
 
@@ -60,7 +61,6 @@ cv::Ptr<Map> MapperGradEuclid::calculate(
     InputArray _img1, InputArray image2, cv::Ptr<Map> init) const
 {
     Mat img1 = _img1.getMat();
-    Mat gradx, grady, imgDiff;
     Mat img2;
 
     CV_DbgAssert(img1.size() == image2.size());
@@ -69,40 +69,24 @@ cv::Ptr<Map> MapperGradEuclid::calculate(
 
     if(!init.empty()) {
         // We have initial values for the registration: we move img2 to that initial reference
-        init->inverseWarp(image2, img2);
+        Mat& warped = getWarpBuffer();
+        init->inverseWarp(image2, warped);
+        img2 = warped;
     } else {
         img2 = image2.getMat();
     }
 
-    // Matrices with reference frame coordinates
-    Mat grid_r, grid_c;
-    grid(img1, grid_r, grid_c);
-
-    // Get gradient in all channels
-    gradient(img1, img2, gradx, grady, imgDiff);
-
-    // Calculate parameters using least squares
+    // Calculate parameters using least squares. The normal equations are accumulated in a single
+    // pass over the images, with the gradient and the pixel coordinates calculated on the fly.
     Matx<double, 3, 3> A;
     Vec<double, 3> b;
-    // For each value in A, all the matrix elements are added and then the channels are also added,
-    // so we have two calls to "sum". The result can be found in the first element of the final
-    // Scalar object.
-    Mat xIy_yIx = grid_c.mul(grady);
-    xIy_yIx -= grid_r.mul(gradx);
-
-    A(0, 0) = sum(sum(gradx.mul(gradx)))[0];
-    A(0, 1) = sum(sum(gradx.mul(grady)))[0];
-    A(0, 2) = sum(sum(gradx.mul(xIy_yIx)))[0];
-    A(1, 1) = sum(sum(grady.mul(grady)))[0];
-    A(1, 2) = sum(sum(grady.mul(xIy_yIx)))[0];
-    A(2, 2) = sum(sum(xIy_yIx.mul(xIy_yIx)))[0];
-    A(1, 0) = A(0, 1);
-    A(2, 0) = A(0, 2);
-    A(2, 1) = A(1, 2);
-
-    b(0) = -sum(sum(imgDiff.mul(gradx)))[0];
-    b(1) = -sum(sum(imgDiff.mul(grady)))[0];
-    b(2) = -sum(sum(imgDiff.mul(xIy_yIx)))[0];
+    accumulateGaussNewton(img1, img2, A, b,
+        [](double x, double y, double Ix, double Iy, double* J)
+        {
+            J[0] = Ix;
+            J[1] = Iy;
+            J[2] = x*Iy - y*Ix;
+        });
 
     // Calculate parameters. We use Cholesky decomposition, as A is symmetric.
     Vec<double, 3> k = A.inv(DECOMP_CHOLESKY)*b;
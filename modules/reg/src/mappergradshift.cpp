@@ -36,6 +36,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "gauss_newton.hpp"
 #include "opencv2/reg/mappergradshift.hpp"
 #include "opencv2/reg/mapshift.hpp"
 
@@ -60,35 +61,29 @@ cv::Ptr<Map> MapperGradShift::calculate(
     InputArray _img1, InputArray image2, cv::Ptr<Map> init) const
 {
     Mat img1 = _img1.getMat();
-    Mat gradx, grady, imgDiff;
     Mat img2;
 
     CV_DbgAssert(img1.size() == image2.size());
 
     if(!init.empty()) {
         // We have initial values for the registration: we move img2 to that initial reference
-        init->inverseWarp(image2, img2);
+        Mat& warped = getWarpBuffer();
+        init->inverseWarp(image2, warped);
+        img2 = warped;
     } else {
         img2 = image2.getMat();
     }
 
-    // Get gradient in all channels
-    gradient(img1, img2, gradx, grady, imgDiff);
-
-    // Calculate parameters using least squares
+    // Calculate parameters using least squares. The normal equations are accumulated in a single
+    // pass over the images, with the gradient and the pixel coordinates calculated on the fly.
     Matx<double, 2, 2> A;
     Vec<double, 2> b;
-    // For each value in A, all the matrix elements are added and then the channels are also added,
-    // so we have two calls to "sum". The result can be found in the first element of the final
-    // Scalar object.
-
-    A(0, 0) = sum(sum(gradx.mul(gradx)))[0];
-    A(0, 1) = sum(sum(gradx.mul(grady)))[0];
-    A(1, 1) = sum(sum(grady.mul(grady)))[0];
-    A(1, 0) = A(0, 1);
-
-    b(0) = -sum(sum(imgDiff.mul(gradx)))[0];
-    b(1) = -sum(sum(imgDiff.mul(grady)))[0];
+    accumulateGaussNewton(img1, img2, A, b,
+        [](double, double, double Ix, double Iy, double* J)
+        {
+            J[0] = Ix;
+            J[1] = Iy;
+        });
 
     // Calculate shift. We use Cholesky decomposition, as A is symmetric.
     Vec<double, 2> shift = A.inv(DECOMP_CHOLESKY)*b;
@@ -36,6 +36,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "gauss_newton.hpp"
 #include "opencv2/reg/mappergradsimilar.hpp"
 #include "opencv2/reg/mapaffine.hpp"
 
@@ -60,7 +61,6 @@ cv::Ptr<Map> MapperGradSimilar::calculate(
     InputArray _img1, InputArray image2, cv::Ptr<Map> init) const
 {
     Mat img1 = _img1.getMat();
-    Mat gradx, grady, imgDiff;
     Mat img2;
 
     CV_DbgAssert(img1.size() == image2.size());
@@ -69,58 +69,25 @@ cv::Ptr<Map> MapperGradSimilar::calculate(
 
     if(!init.empty()) {
         // We have initial values for the registration: we move img2 to that initial reference
-        init->inverseWarp(image2, img2);
+        Mat& warped = getWarpBuffer();
+        init->inverseWarp(image2, warped);
+        img2 = warped;
     } else {
         img2 = image2.getMat();
     }
 
-    // Get gradient in all channels
-    gradient(img1, img2, gradx, grady, imgDiff);
-
-    // Matrices with reference frame coordinates
-    Mat grid_r, grid_c;
-    grid(img1, grid_r, grid_c);
-
-    // Calculate parameters using least squares
+    // Calculate parameters using least squares. The normal equations are accumulated in a single
+    // pass over the images, with the gradient and the pixel coordinates calculated on the fly.
     Matx<double, 4, 4> A;
     Vec<double, 4> b;
-    // For each value in A, all the matrix elements are added and then the channels are also added,
-    // so we have two calls to "sum". The result can be found in the first element of the final
-    // Scalar object.
-    Mat xIx_p_yIy = grid_c.mul(gradx);
-    xIx_p_yIy += grid_r.mul(grady);
-    Mat yIx_m_xIy = grid_r.mul(gradx);
-    yIx_m_xIy -= grid_c.mul(grady);
-
-    A(0, 0) = sum(sum(sqr(xIx_p_yIy)))[0];
-    A(0, 1) = sum(sum(xIx_p_yIy.mul(yIx_m_xIy)))[0];
-    A(0, 2) = sum(sum(gradx.mul(xIx_p_yIy)))[0];
-    A(0, 3) = sum(sum(grady.mul(xIx_p_yIy)))[0];
-
-    A(1, 1) = sum(sum(sqr(yIx_m_xIy)))[0];
-    A(1, 2) = sum(sum(gradx.mul(yIx_m_xIy)))[0];
-    A(1, 3) = sum(sum(grady.mul(yIx_m_xIy)))[0];
-
-    A(2, 2) = sum(sum(sqr(gradx)))[0];
-    A(2, 3) = sum(sum(gradx.mul(grady)))[0];
-
-    A(3, 3) = sum(sum(sqr(grady)))[0];
-
-    // Lower half values (A is symmetric)
-    A(1, 0) = A(0, 1);
-    A(2, 0) = A(0, 2);
-    A(3, 0) = A(0, 3);
-
-    A(2, 1) = A(1, 2);
-    A(3, 1) = A(1, 3);
-
-    A(3, 2) = A(2, 3);
-
-    // Calculation of b
-    b(0) = -sum(sum(imgDiff.mul(xIx_p_yIy)))[0];
-    b(1) = -sum(sum(imgDiff.mul(yIx_m_xIy)))[0];
-    b(2) = -sum(sum(imgDiff.mul(gradx)))[0];
-    b(3) = -sum(sum(imgDiff.mul(grady)))[0];
+    accumulateGaussNewton(img1, img2, A, b,
+        [](double x, double y, double Ix, double Iy, double* J)
+        {
+            J[0] = x*Ix + y*Iy;
+            J[1] = y*Ix - x*Iy;
+            J[2] = Ix;
+            J[3] = Iy;
+        });
 
     // Calculate affine transformation. We use Cholesky decomposition, as A is symmetric.
     Vec<double, 4> k = A.inv(DECOMP_CHOLESKY)*b;
@@ -37,7 +37,9 @@
 
 #include "precomp.hpp"
 #include <vector>
+#include <cfloat>
 
+#include "opencv2/core/utility.hpp"
 #include "opencv2/imgproc.hpp"
 #include "opencv2/reg/mapperpyramid.hpp"
 
@@ -47,32 +49,135 @@ namespace cv {
 namespace reg {
 
 
+namespace {
+
+/*
+ * Pyramid images of a registration. They are kept by the thread after each call, so the following
+ * registrations of images with the same size do not allocate them again.
+ */
+struct PyramidWorkspace
+{
+    vector<Mat> pyrIm1, pyrIm2;
+    Mat warped;
+};
+
+typedef vector<Ptr<PyramidWorkspace> > PyramidWorkspacePool;
+
+/*
+ * Takes a workspace from the pool of the calling thread and gives it back on destruction. A pool
+ * instead of a single workspace per thread allows for nested pyramids.
+ */
+class PyramidWorkspaceLease
+{
+public:
+    PyramidWorkspaceLease()
+        : pool_(getPool())
+    {
+        if(pool_.empty()) {
+            ws_ = makePtr<PyramidWorkspace>();
+        } else {
+            ws_ = pool_.back();
+            pool_.pop_back();
+        }
+    }
+
+    ~PyramidWorkspaceLease()
+    {
+        pool_.push_back(ws_);
+    }
+
+    PyramidWorkspace& operator*() const { return *ws_; }
+
+private:
+    static PyramidWorkspacePool& getPool()
+    {
+        static TLSData<PyramidWorkspacePool>* pools = new TLSData<PyramidWorkspacePool>();
+        return *pools->get();
+    }
+
+    PyramidWorkspacePool& pool_;
+    Ptr<PyramidWorkspace> ws_;
+
+    PyramidWorkspaceLease(const PyramidWorkspaceLease&);
+    PyramidWorkspaceLease& operator=(const PyramidWorkspaceLease&);
+};
+
+/*
+ * Largest distance between the positions where two maps of the same kind move the corners of an
+ * image of the given size. It is infinite for maps of an unknown kind.
+ */
+double maxCornerDistance(const Map& map1, const Map& map2, Size sz)
+{
+    const Vec<double, 2> corners[4] = {
+        Vec<double, 2>(0., 0.), Vec<double, 2>(sz.width - 1., 0.),
+        Vec<double, 2>(0., sz.height - 1.), Vec<double, 2>(sz.width - 1., sz.height - 1.)
+    };
+
+    const MapShift* shift1 = dynamic_cast<const MapShift*>(&map1);
+    const MapShift* shift2 = dynamic_cast<const MapShift*>(&map2);
+    if(shift1 && shift2) {
+        return norm(shift1->getShift() - shift2->getShift());
+    }
+
+    double res = 0.;
+    const MapAffine* affine1 = dynamic_cast<const MapAffine*>(&map1);
+    const MapAffine* affine2 = dynamic_cast<const MapAffine*>(&map2);
+    if(affine1 && affine2) {
+        Matx<double, 2, 2> dLinTr = affine1->getLinTr() - affine2->getLinTr();
+        Vec<double, 2> dShift = affine1->getShift() - affine2->getShift();
+        for(int i = 0; i < 4; ++i) {
+            res = std::max(res, norm(dLinTr*corners[i] + dShift));
+        }
+        return res;
+    }
+
+    const MapProjec* projec1 = dynamic_cast<const MapProjec*>(&map1);
+    const MapProjec* projec2 = dynamic_cast<const MapProjec*>(&map2);
+    if(projec1 && projec2) {
+        for(int i = 0; i < 4; ++i) {
+            Vec<double, 3> p(corners[i](0), corners[i](1), 1.);
+            Vec<double, 3> p1 = projec1->getProjTr()*p;
+            Vec<double, 3> p2 = projec2->getProjTr()*p;
+            Vec<double, 2> d(p1(0)/p1(2) - p2(0)/p2(2), p1(1)/p1(2) - p2(1)/p2(2));
+            res = std::max(res, norm(d));
+        }
+        return res;
+    }
+
+    return DBL_MAX;
+}
+
+}  // namespace
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 MapperPyramid::MapperPyramid(Ptr<Mapper> baseMapper)
-    : numLev_(3), numIterPerScale_(3), baseMapper_(*baseMapper)
+    : numLev_(3), numIterPerScale_(3), convergenceThreshold_(0.), baseMapper_(*baseMapper)
 {
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 Ptr<Map> MapperPyramid::calculate(InputArray _img1, InputArray image2, Ptr<Map> init) const
 {
-    Mat img1 = _img1.getMat();
-    Mat img2;
+    PyramidWorkspaceLease lease;
+    PyramidWorkspace& ws = *lease;
+    vector<Mat>& pyrIm1 = ws.pyrIm1;
+    vector<Mat>& pyrIm2 = ws.pyrIm2;
+    pyrIm1.resize(numLev_);
+    pyrIm2.resize(numLev_);
 
     if(!init.empty()) {
         // We have initial values for the registration: we move img2 to that initial reference
-        init->inverseWarp(image2, img2);
+        init->inverseWarp(image2, ws.warped);
+        pyrIm2[0] = ws.warped;
     } else {
         init = baseMapper_.getMap();
-        img2 = image2.getMat();
+        pyrIm2[0] = image2.getMat();
     }
+    pyrIm1[0] = _img1.getMat();
 
     cv::Ptr<Map> ident = baseMapper_.getMap();
 
-    // Precalculate pyramid images
-    vector<Mat> pyrIm1(numLev_), pyrIm2(numLev_);
-    pyrIm1[0] = img1;
-    pyrIm2[0] = img2;
+    // Precalculate pyramid images, reusing the buffers of the previous registrations
     for(int im_i = 1; im_i < numLev_; ++im_i) {
         pyrDown(pyrIm1[im_i - 1], pyrIm1[im_i]);
         pyrDown(pyrIm2[im_i - 1], pyrIm2[im_i]);
@@ -87,14 +192,44 @@ Ptr<Map> MapperPyramid::calculate(InputArray _img1, InputArray image2, Ptr<Map>
             ident->scale(2.);
         }
         for(int it_i = 0; it_i < numIterPerScale_; ++it_i) {
-            ident = baseMapper_.calculate(currRef, currImg, ident);
+            cv::Ptr<Map> next = baseMapper_.calculate(currRef, currImg, ident);
+            // Stop refining at this scale once the update is a negligible motion
+            bool converged = convergenceThreshold_ > 0. && !next.empty() && !ident.empty() &&
+                maxCornerDistance(*next, *ident, currRef.size()) < convergenceThreshold_;
+            ident = next;
+            if(converged) {
+                break;
+            }
         }
     }
 
+    // Do not keep the input images alive through the workspace
+    pyrIm1[0].release();
+    pyrIm2[0].release();
+
     init->compose(ident);
     return init;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void MapperPyramid::calculateBatch(InputArrayOfArrays img1, InputArrayOfArrays img2,
+                                   std::vector<Ptr<Map> >& maps) const
+{
+    vector<Mat> refs, imgs;
+    img1.getMatVector(refs);
+    img2.getMatVector(imgs);
+    CV_Assert(refs.size() == imgs.size());
+    CV_Assert(maps.empty() || maps.size() == refs.size());
+    maps.resize(refs.size());
+
+    parallel_for_(Range(0, (int)refs.size()), [&](const Range& range)
+    {
+        for(int i = range.start; i < range.end; ++i) {
+            maps[i] = calculate(refs[i], imgs[i], maps[i]);
+        }
+    });
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 cv::Ptr<Map> MapperPyramid::getMap() const
 {
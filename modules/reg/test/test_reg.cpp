@@ -58,6 +58,7 @@ public:
     void testSimilarity();
     void testAffine();
     void testProjective();
+    void testBatch();
 private:
     Mat img1;
 };
@@ -233,6 +234,39 @@ void RegTest::testProjective()
     EXPECT_GE(projNorm, sqrt(3.) - 0.01);
 }
 
+void RegTest::testBatch()
+{
+    const int numPairs = 4;
+    vector<Mat> refs(numPairs), imgs(numPairs);
+    vector<Vec<double, 2> > shifts(numPairs);
+    for(int i = 0; i < numPairs; ++i) {
+        shifts[i] = Vec<double, 2>(2. + i, 5. - i);
+        refs[i] = img1;
+        MapShift(shifts[i]).warp(img1, imgs[i]);
+    }
+
+    // Register
+    Ptr<Mapper> mapper = makePtr<MapperGradShift>();
+    MapperPyramid mappPyr(mapper);
+    mappPyr.convergenceThreshold_ = 0.01;
+    vector<Ptr<Map> > maps;
+    mappPyr.calculateBatch(refs, imgs, maps);
+    ASSERT_EQ((size_t)numPairs, maps.size());
+
+    for(int i = 0; i < numPairs; ++i) {
+        // Same result as registering the pair alone
+        Ptr<MapShift> mapShift = MapTypeCaster::toShift(maps[i]);
+        Ptr<MapShift> single = MapTypeCaster::toShift(mappPyr.calculate(refs[i], imgs[i]));
+        EXPECT_LE(cv::norm(mapShift->getShift() - single->getShift()), 1e-9);
+
+        // Check accuracy
+        MapShift mapTest(shifts[i]);
+        Ptr<Map> mapInv(mapShift->inverseMap());
+        mapTest.compose(mapInv);
+        EXPECT_LE(cv::norm(mapTest.getShift()), 0.1);
+    }
+}
+
 void RegTest::loadImage(int dstDataType)
 {
     const string imageName = cvtest::TS::ptr()->get_data_path() + "reg/home.png";
@@ -285,4 +319,10 @@ TEST_F(RegTest, projective_dt64fc1)
     testProjective();
 }
 
+TEST_F(RegTest, batch)
+{
+    loadImage();
+    testBatch();
+}
+
 }} // namespace
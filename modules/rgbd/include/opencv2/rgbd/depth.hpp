@@ -505,6 +505,23 @@ namespace rgbd
     CV_WRAP void
     releasePyramids();
 
+    /** Builds the pyramids which do not depend on odometry parameters: image, depth and point cloud pyramids,
+     * and for CACHE_DST also image gradients and normals. Independent pyramids are built in parallel.
+     * A frame prepared once this way may be passed to several odometries (e.g. RgbdOdometry and ICPOdometry)
+     * having the same camera matrix and not more than levels pyramid levels, they only compute the masks then.
+     * Masks depend on the odometry, call releaseMasks() before passing the frame to the next one.
+     * Pyramids which are already set are checked and kept.
+     * @param cameraMatrix Camera matrix of the frame
+     * @param levels Count of pyramid levels
+     * @param cacheType Role of the frame, one of CACHE_SRC, CACHE_DST and CACHE_ALL
+     */
+    //! Releases the mask pyramids only, they are specific to the odometry which computed them
+    CV_WRAP void
+    releaseMasks();
+
+    CV_WRAP void
+    preparePyramids(const Mat& cameraMatrix, int levels, int cacheType = CACHE_ALL);
+
     CV_PROP std::vector<Mat> pyramidImage;
     CV_PROP std::vector<Mat> pyramidDepth;
     CV_PROP std::vector<Mat> pyramidMask;
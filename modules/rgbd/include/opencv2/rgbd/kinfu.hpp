@@ -9,6 +9,7 @@
 
 #include "opencv2/core.hpp"
 #include "opencv2/core/affine.hpp"
+#include "opencv2/core/async.hpp"
 #include <opencv2/rgbd/volume.hpp>
 
 namespace cv {
@@ -120,9 +121,29 @@ struct CV_EXPORTS_W Params
     /** @brief Minimal camera movement in meters
 
     Integrate new depth frame only if camera movement exceeds this value.
+    Frames with smaller movement since the last raycast are treated as static:
+    they are not integrated and the previous raycast is reused for ICP.
     */
     CV_PROP_RW float tsdf_min_camera_movement;
 
+    /** @brief Depth difference in meters for a pixel to be counted as changed
+
+    Used to detect scene changes when the camera is static, 0 disables the check.
+    */
+    CV_PROP_RW float tsdf_static_depth_change;
+
+    /** @brief Max ratio of changed pixels for a frame to be treated as static
+
+    Compared against the last integrated frame.
+    */
+    CV_PROP_RW float tsdf_static_changed_ratio;
+
+    /** @brief Number of static frames between integrations
+
+    Static frames are integrated once per this number of frames, 0 means they are never integrated.
+    */
+    CV_PROP_RW int tsdf_static_integrate_period;
+
     /** @brief initial volume pose in meters */
     Affine3f volumePose;
 
@@ -262,6 +283,28 @@ public:
     @return true if succeeded to align new frame with current scene, false if opposite
     */
     CV_WRAP virtual bool update(InputArray depth) = 0;
+
+    /** @brief Process next depth frame asynchronously
+
+      Same as update() but returns immediately. Frames are processed in a pipeline:
+      preprocessing of a frame runs concurrently with integration and raycast of the previous one,
+      and the result becomes available as soon as ICP is finished.
+      All other methods wait until the queued frames are processed.
+
+    @param depth one-channel image which size and depth scale is described in algorithm's parameters,
+    it is copied so the buffer can be reused right after the call
+    @return AsyncArray containing a 4x4 CV_32F camera pose if succeeded to align new frame
+    with current scene or an empty Mat if opposite
+    */
+    CV_WRAP virtual AsyncArray updateAsync(InputArray depth) = 0;
+
+    /** @brief Get integration counters since the last reset
+
+    @param integrated number of integrated frames
+    @param skipped number of static frames which were not integrated
+    @param raycastsReused number of frames tracked against the previous raycast
+    */
+    CV_WRAP virtual void getIntegrationStats(CV_OUT int& integrated, CV_OUT int& skipped, CV_OUT int& raycastsReused) const = 0;
 };
 
 //! @}
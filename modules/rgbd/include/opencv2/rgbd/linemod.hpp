@@ -392,6 +392,22 @@ public:
                    const String& format = "templates_%s.yml.gz");
   CV_WRAP void writeClasses(const String& format = "templates_%s.yml.gz") const;
 
+  /**
+   * \brief Write the templates of all classes into a single binary file.
+   *
+   * The file consists of 32-bit little-endian fields and stores the features of each
+   * template contiguously, so it is loaded without any text parsing.
+   */
+  CV_WRAP void writeClassesBinary(const String& filename) const;
+  /**
+   * \brief Read classes written by writeClassesBinary().
+   *
+   * \param filename  Binary template database.
+   * \param class_ids Classes to load, all classes of the file if empty.
+   */
+  CV_WRAP void readClassesBinary(const String& filename,
+                                 const std::vector<String>& class_ids = std::vector<String>());
+
 protected:
   std::vector< Ptr<Modality> > modalities;
   int pyramid_levels;
@@ -410,6 +426,13 @@ protected:
                   float threshold, std::vector<Match>& matches,
                   const String& class_id,
                   const std::vector<TemplatePyramid>& template_pyramids) const;
+
+  //! Matches a single template, appending its matches to matches
+  void matchTemplate(const LinearMemoryPyramid& lm_pyramid,
+                     const std::vector<Size>& sizes,
+                     float threshold, std::vector<Match>& matches,
+                     const String& class_id, int template_id,
+                     const TemplatePyramid& tp) const;
 };
 
 /**
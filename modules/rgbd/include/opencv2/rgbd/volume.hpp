@@ -41,6 +41,17 @@ class CV_EXPORTS_W Volume
     virtual void fetchPointsNormals(OutputArray points, OutputArray normals) const             = 0;
     virtual void reset()                                                                       = 0;
 
+    /** @brief Extracts the surface as a triangle mesh using marching cubes
+        Every 3 consecutive vertices form a triangle, both outputs are of CV_32FC4 type.
+        Implemented by HashTSDF volume on CPU, which caches the triangles of each volume unit
+        and re-meshes only the units integrated since the previous call.
+    */
+    virtual void fetchMesh(OutputArray vertices, OutputArray normals) const
+    {
+        CV_UNUSED(vertices); CV_UNUSED(normals);
+        CV_Error(Error::StsNotImplemented, "Mesh extraction is not implemented for this volume");
+    }
+
    public:
     const float voxelSize;
     const float voxelSizeInv;
@@ -75,6 +86,12 @@ struct CV_EXPORTS_W VolumeParams
     */
     CV_PROP_RW int unitResolution = {0};
 
+    /** @brief Store TSDF volume in 8x8x8 voxel bricks allocated on first touch
+        Applicable only for TSDF volume, which then runs on CPU.
+        Saves memory for mostly empty volumes and lets raycast skip empty bricks.
+    */
+    CV_PROP_RW bool bricked = {false};
+
     /** @brief Initial pose of the volume in meters */
     Affine3f pose;
 
@@ -102,6 +119,21 @@ struct CV_EXPORTS_W VolumeParams
     */
     CV_PROP_RW float raycastStepFactor;
 
+    /** @brief Directory to stream volume units to, empty keeps all of them in memory
+        Applicable only for HashTSDF volume, which then runs on CPU.
+        Units not seen for streamingEvictFrames frames are written to a file in this directory
+        and read back when the camera sees them again. Requires increasing frame ids in integrate().
+    */
+    CV_PROP_RW String streamingDirectory;
+
+    /** @brief Number of frames a volume unit can stay unseen before it's streamed out */
+    CV_PROP_RW int streamingEvictFrames = {30};
+
+    /** @brief Memory for the volume units kept in RAM in megabytes, 0 means no limit
+        When exceeded, the least recently seen units are streamed out first.
+    */
+    CV_PROP_RW int streamingMemoryBudgetMB = {0};
+
     /** @brief Default set of parameters that provide higher quality reconstruction
         at the cost of slow performance.
     */
@@ -0,0 +1,557 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+// This code is also subject to the license terms in the LICENSE_KinectFusion.md file found in this module's directory
+
+#include "precomp.hpp"
+#include "bricked_tsdf.hpp"
+
+#include <unordered_set>
+
+namespace cv {
+
+namespace kinfu {
+
+TSDFVolumeBrickedCPU::TSDFVolumeBrickedCPU(float _voxelSize, Matx44f _pose, float _raycastStepFactor,
+                                           float _truncDist, int _maxWeight, Point3i _resolution,
+                                           float _truncateThreshold)
+    : TSDFVolume(_voxelSize, _pose, _raycastStepFactor, _truncDist, _maxWeight, _resolution),
+      nAllocatedBricks(0),
+      emptyTsdf(tsdfToFloat(floatToTsdf(0.f))),
+      truncateThreshold(_truncateThreshold)
+{
+    const int br = brickResolution;
+    brickDims = Point3i((volResolution.x + br - 1) / br,
+                        (volResolution.y + br - 1) / br,
+                        (volResolution.z + br - 1) / br);
+    // z-first order inside of a brick
+    brickStrides = Vec4i(br * br, br, 1);
+
+    reset();
+}
+
+void TSDFVolumeBrickedCPU::reset()
+{
+    CV_TRACE_FUNCTION();
+
+    int nBricks = brickDims.x * brickDims.y * brickDims.z;
+    brickRows.assign(nBricks, -1);
+    occupancy.assign((nBricks + 63) / 64, 0);
+    bricks.release();
+    nAllocatedBricks = 0;
+}
+
+TsdfVoxel TSDFVolumeBrickedCPU::at(const Vec3i& volumeIdx) const
+{
+    //! Out of bounds
+    if ((volumeIdx[0] >= volResolution.x || volumeIdx[0] < 0) ||
+        (volumeIdx[1] >= volResolution.y || volumeIdx[1] < 0) ||
+        (volumeIdx[2] >= volResolution.z || volumeIdx[2] < 0))
+    {
+        return TsdfVoxel(floatToTsdf(1.f), 0);
+    }
+
+    const TsdfVoxel* v = voxelPtr(volumeIdx[0], volumeIdx[1], volumeIdx[2]);
+    return v ? *v : TsdfVoxel(floatToTsdf(0.f), 0);
+}
+
+// use depth instead of distance (optimization)
+void TSDFVolumeBrickedCPU::integrate(InputArray _depth, float depthFactor, const Matx44f& cameraPose,
+                                     const Intr& intrinsics, const int frameId)
+{
+    CV_TRACE_FUNCTION();
+    CV_UNUSED(frameId);
+    CV_Assert(_depth.type() == DEPTH_TYPE);
+    CV_Assert(!_depth.empty());
+    Depth depth = _depth.getMat();
+
+    //! Find the bricks touched by truncation band of the frame
+    const int depthStride = 2;
+    const float invDepthFactor = 1.f / depthFactor;
+    const Intr::Reprojector reproj(intrinsics.makeReprojector());
+    const Affine3f cam2vol(pose.inv() * Affine3f(cameraPose));
+    const Point3f truncPt(truncDist, truncDist, truncDist);
+    const Point3i maxVoxel = volResolution - Point3i(1, 1, 1);
+    std::vector<int> newBricks;
+    Mutex mutex;
+
+    parallel_for_(Range(0, depth.rows), [&](const Range& range)
+    {
+        std::unordered_set<int> localBricks;
+        for (int y = range.start; y < range.end; y += depthStride)
+        {
+            const depthType* depthRow = depth[y];
+            for (int x = 0; x < depth.cols; x += depthStride)
+            {
+                depthType z = depthRow[x] * invDepthFactor;
+                if (z <= 0 || (truncateThreshold > 0 && z > truncateThreshold))
+                    continue;
+                Point3f volPoint = cam2vol * reproj(Point3f((float)x, (float)y, z));
+                Point3f lo = (volPoint - truncPt) * voxelSizeInv;
+                Point3f hi = (volPoint + truncPt) * voxelSizeInv;
+                Point3i lower(max(cvFloor(lo.x), 0), max(cvFloor(lo.y), 0), max(cvFloor(lo.z), 0));
+                Point3i upper(min(cvCeil(hi.x), maxVoxel.x), min(cvCeil(hi.y), maxVoxel.y), min(cvCeil(hi.z), maxVoxel.z));
+                if (lower.x > upper.x || lower.y > upper.y || lower.z > upper.z)
+                    continue;
+
+                for (int i = lower.x >> brickDegree; i <= (upper.x >> brickDegree); i++)
+                    for (int j = lower.y >> brickDegree; j <= (upper.y >> brickDegree); j++)
+                        for (int k = lower.z >> brickDegree; k <= (upper.z >> brickDegree); k++)
+                        {
+                            int idx = brickIdx(i, j, k);
+                            if (brickRows[idx] < 0)
+                                localBricks.insert(idx);
+                        }
+            }
+        }
+
+        AutoLock al(mutex);
+        newBricks.insert(newBricks.end(), localBricks.begin(), localBricks.end());
+    });
+
+    //! Perform the allocation
+    std::sort(newBricks.begin(), newBricks.end());
+    newBricks.erase(std::unique(newBricks.begin(), newBricks.end()), newBricks.end());
+    const int brickVoxels = brickResolution * brickResolution * brickResolution;
+    if (nAllocatedBricks + (int)newBricks.size() > bricks.rows)
+    {
+        int capacity = max(bricks.rows * 2, 64);
+        while (capacity < nAllocatedBricks + (int)newBricks.size())
+            capacity *= 2;
+        Mat grown(capacity, brickVoxels, rawType<TsdfVoxel>());
+        if (nAllocatedBricks > 0)
+            bricks.rowRange(0, nAllocatedBricks).copyTo(grown.rowRange(0, nAllocatedBricks));
+        bricks = grown;
+    }
+    for (int idx : newBricks)
+    {
+        int row = nAllocatedBricks++;
+        brickRows[idx] = row;
+        bricks.row(row).forEach<VecTsdfVoxel>([](VecTsdfVoxel& vv, const int* /* position */)
+        {
+            TsdfVoxel& v = reinterpret_cast<TsdfVoxel&>(vv);
+            v.tsdf = floatToTsdf(0.0f); v.weight = 0;
+        });
+    }
+
+    //! Integrate the allocated bricks seen by the camera
+    const Affine3f vol2cam(Affine3f(cameraPose.inv()) * pose);
+    const Intr::Projector proj(intrinsics.makeProjector());
+    const float brickSize = voxelSize * brickResolution;
+    // half of the brick diagonal
+    const float brickRadius = brickSize * 0.8660254f;
+    std::vector<int> activeBricks;
+    for (int idx = 0; idx < (int)brickRows.size(); idx++)
+    {
+        if (brickRows[idx] < 0)
+            continue;
+        int bx = idx / (brickDims.y * brickDims.z);
+        int by = (idx / brickDims.z) % brickDims.y;
+        int bz = idx % brickDims.z;
+        Point3f center = (Point3f((float)bx, (float)by, (float)bz) + Point3f(0.5f, 0.5f, 0.5f)) * brickSize;
+        Point3f camPt = vol2cam * center;
+        if (camPt.z + brickRadius <= 0 || (truncateThreshold > 0 && camPt.z - brickRadius > truncateThreshold))
+            continue;
+        Point2f pix = proj(Point3f(camPt.x, camPt.y, max(camPt.z, brickRadius)));
+        float margin = brickRadius * intrinsics.fx / max(camPt.z, brickRadius);
+        if (pix.x >= -margin && pix.y >= -margin && pix.x < depth.cols + margin && pix.y < depth.rows + margin)
+            activeBricks.push_back(idx);
+    }
+
+    Vec6f newParams((float)depth.rows, (float)depth.cols,
+        intrinsics.fx, intrinsics.fy,
+        intrinsics.cx, intrinsics.cy);
+    if (!(frameParams == newParams))
+    {
+        frameParams = newParams;
+        pixNorms = preCalculationPixNorm(depth, intrinsics);
+    }
+
+    std::vector<uchar> activeOccupied(activeBricks.size(), 0);
+    parallel_for_(Range(0, (int)activeBricks.size()), [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            int idx = activeBricks[i];
+            int bx = idx / (brickDims.y * brickDims.z);
+            int by = (idx / brickDims.z) % brickDims.y;
+            int bz = idx % brickDims.z;
+            Vec3f origin = Vec3f((float)bx, (float)by, (float)bz) * brickSize;
+            Matx44f brickPose = (pose * Affine3f(Matx33f::eye(), origin)).matrix;
+            Mat brick = bricks.row(brickRows[idx]);
+
+            integrateVolumeUnit(truncDist, voxelSize, maxWeight, brickPose,
+                Point3i(brickResolution, brickResolution, brickResolution), brickStrides, depth,
+                depthFactor, cameraPose, intrinsics, pixNorms, brick);
+
+            const TsdfVoxel* voxels = brick.ptr<TsdfVoxel>();
+            for (int v = 0; v < brickVoxels; v++)
+            {
+                if (voxels[v].weight != 0)
+                {
+                    activeOccupied[i] = 1;
+                    break;
+                }
+            }
+        }
+    });
+
+    for (size_t i = 0; i < activeBricks.size(); i++)
+    {
+        int idx = activeBricks[i];
+        if (activeOccupied[i])
+            occupancy[idx >> 6] |= (uint64_t)1 << (idx & 63);
+    }
+}
+
+// all coordinate checks should be done in inclosing cycle
+float TSDFVolumeBrickedCPU::interpolateVoxel(const Point3f& p) const
+{
+    int ix = cvFloor(p.x);
+    int iy = cvFloor(p.y);
+    int iz = cvFloor(p.z);
+
+    float tx = p.x - ix;
+    float ty = p.y - iy;
+    float tz = p.z - iz;
+
+    float vx[8];
+    for (int i = 0; i < 8; i++)
+        vx[i] = voxelTsdf(ix + ((i >> 2) & 1), iy + ((i >> 1) & 1), iz + (i & 1));
+
+    float v00 = vx[0] + tz*(vx[1] - vx[0]);
+    float v01 = vx[2] + tz*(vx[3] - vx[2]);
+    float v10 = vx[4] + tz*(vx[5] - vx[4]);
+    float v11 = vx[6] + tz*(vx[7] - vx[6]);
+
+    float v0 = v00 + ty*(v01 - v00);
+    float v1 = v10 + ty*(v11 - v10);
+
+    return v0 + tx*(v1 - v0);
+}
+
+Point3f TSDFVolumeBrickedCPU::getNormalVoxel(const Point3f& p) const
+{
+    if(p.x < 1 || p.x >= volResolution.x - 2 ||
+       p.y < 1 || p.y >= volResolution.y - 2 ||
+       p.z < 1 || p.z >= volResolution.z - 2)
+        return nan3;
+
+    int ix = cvFloor(p.x);
+    int iy = cvFloor(p.y);
+    int iz = cvFloor(p.z);
+
+    float tx = p.x - ix;
+    float ty = p.y - iy;
+    float tz = p.z - iz;
+
+    Vec3f an;
+    for(int c = 0; c < 3; c++)
+    {
+        Vec3i shift;
+        shift[c] = 1;
+        float& nv = an[c];
+
+        float vx[8];
+        for (int i = 0; i < 8; i++)
+        {
+            Vec3i v(ix + ((i >> 2) & 1), iy + ((i >> 1) & 1), iz + (i & 1));
+            vx[i] = voxelTsdf(v[0] + shift[0], v[1] + shift[1], v[2] + shift[2]) -
+                    voxelTsdf(v[0] - shift[0], v[1] - shift[1], v[2] - shift[2]);
+        }
+
+        float v00 = vx[0] + tz*(vx[1] - vx[0]);
+        float v01 = vx[2] + tz*(vx[3] - vx[2]);
+        float v10 = vx[4] + tz*(vx[5] - vx[4]);
+        float v11 = vx[6] + tz*(vx[7] - vx[6]);
+
+        float v0 = v00 + ty*(v01 - v00);
+        float v1 = v10 + ty*(v11 - v10);
+
+        nv = v0 + tx*(v1 - v0);
+    }
+
+    float nv = sqrt(an[0] * an[0] +
+                    an[1] * an[1] +
+                    an[2] * an[2]);
+    return nv < 0.0001f ? nan3 : an / nv;
+}
+
+void TSDFVolumeBrickedCPU::raycast(const Matx44f& cameraPose, const Intr& intrinsics, const Size& frameSize,
+                                   OutputArray _points, OutputArray _normals) const
+{
+    CV_TRACE_FUNCTION();
+
+    CV_Assert(frameSize.area() > 0);
+
+    _points.create (frameSize, POINT_TYPE);
+    _normals.create(frameSize, POINT_TYPE);
+
+    Points points   =  _points.getMat();
+    Normals normals = _normals.getMat();
+
+    const float tstep = truncDist * raycastStepFactor;
+    // We do subtract voxel size to minimize checks after
+    // Note: origin of volume coordinate is placed
+    // in the center of voxel (0,0,0), not in the corner of the voxel!
+    const Point3f boxMax(volSize - Point3f(voxelSize, voxelSize, voxelSize));
+    const Point3f boxMin;
+    const Affine3f cam2vol(pose.inv() * Affine3f(cameraPose));
+    const Affine3f vol2cam(Affine3f(cameraPose.inv()) * pose);
+    const Intr::Reprojector reproj(intrinsics.makeReprojector());
+    const float halfVoxel = 0.5f;
+
+    auto RaycastInvoker = [&](const Range& range)
+    {
+        const Point3f camTrans = cam2vol.translation();
+        const Matx33f  camRot  = cam2vol.rotation();
+        const Matx33f  volRot  = vol2cam.rotation();
+
+        for(int y = range.start; y < range.end; y++)
+        {
+            ptype* ptsRow = points[y];
+            ptype* nrmRow = normals[y];
+
+            for(int x = 0; x < points.cols; x++)
+            {
+                Point3f point = nan3, normal = nan3;
+
+                Point3f orig = camTrans;
+                // direction through pixel in volume space
+                Point3f dir = normalize(Vec3f(camRot * reproj(Point3f(float(x), float(y), 1.f))));
+
+                // compute intersection of ray with all six bbox planes
+                Vec3f rayinv(1.f/dir.x, 1.f/dir.y, 1.f/dir.z);
+                Point3f tbottom = rayinv.mul(boxMin - orig);
+                Point3f ttop    = rayinv.mul(boxMax - orig);
+
+                // re-order intersections to find smallest and largest on each axis
+                Point3f minAx(min(ttop.x, tbottom.x), min(ttop.y, tbottom.y), min(ttop.z, tbottom.z));
+                Point3f maxAx(max(ttop.x, tbottom.x), max(ttop.y, tbottom.y), max(ttop.z, tbottom.z));
+
+                // near clipping plane
+                const float clip = 0.f;
+                float tmin = max({ minAx.x, minAx.y, minAx.z, clip });
+                float tmax = min({ maxAx.x, maxAx.y, maxAx.z });
+
+                // precautions against getting coordinates out of bounds
+                tmin = tmin + tstep;
+                tmax = tmax - tstep;
+
+                if(tmin < tmax)
+                {
+                    // interpolation optimized a little
+                    orig = orig*voxelSizeInv;
+                    dir  =  dir*voxelSizeInv;
+                    Vec3f dirinv(1.f/dir.x, 1.f/dir.y, 1.f/dir.z);
+
+                    Point3f rayStep = dir * tstep;
+                    Point3f next = (orig + dir * tmin);
+                    float f = interpolateVoxel(next), fnext = f;
+
+                    //raymarch
+                    int steps = 0;
+                    int nSteps = int(floor((tmax - tmin)/tstep));
+                    for(; steps < nSteps; steps++)
+                    {
+                        next += rayStep;
+                        int ix = cvRound(next.x);
+                        int iy = cvRound(next.y);
+                        int iz = cvRound(next.z);
+                        int bx = ix >> brickDegree, by = iy >> brickDegree, bz = iz >> brickDegree;
+                        if(!isBrickOccupied(brickIdx(bx, by, bz)))
+                        {
+                            // jump to the last sample inside of the empty brick,
+                            // the brick contains points which are rounded to its voxels
+                            Vec3f bmin = Vec3f((float)bx, (float)by, (float)bz) * (float)brickResolution -
+                                         Vec3f::all(halfVoxel);
+                            Vec3f bmax = bmin + Vec3f::all((float)brickResolution);
+                            float texit = std::numeric_limits<float>::max();
+                            for(int c = 0; c < 3; c++)
+                            {
+                                float nc = c == 0 ? next.x : (c == 1 ? next.y : next.z);
+                                float dc = c == 0 ? dir.x : (c == 1 ? dir.y : dir.z);
+                                if (dc > 0)
+                                    texit = min(texit, (bmax[c] - nc)*dirinv[c]);
+                                else if (dc < 0)
+                                    texit = min(texit, (bmin[c] - nc)*dirinv[c]);
+                            }
+                            int nSkip = min(int(texit/tstep), nSteps - 1 - steps);
+                            if(nSkip > 0)
+                            {
+                                next += rayStep*(float)nSkip;
+                                steps += nSkip;
+                                fnext = interpolateVoxel(next);
+                                if(std::signbit(f) != std::signbit(fnext))
+                                    break;
+                                f = fnext;
+                                continue;
+                            }
+                        }
+
+                        fnext = voxelTsdf(ix, iy, iz);
+                        if(fnext != f)
+                        {
+                            fnext = interpolateVoxel(next);
+                            // when ray crosses a surface
+                            if(std::signbit(f) != std::signbit(fnext))
+                                break;
+
+                            f = fnext;
+                        }
+                    }
+                    // if ray penetrates a surface from outside
+                    // linearly interpolate t between two f values
+                    if(f > 0.f && fnext < 0.f)
+                    {
+                        Point3f tp    = next - rayStep;
+                        float ft   = interpolateVoxel(tp);
+                        float ftdt = interpolateVoxel(next);
+                        float ts = tmin + tstep*(steps - ft/(ftdt - ft));
+
+                        // avoid division by zero
+                        if(!cvIsNaN(ts) && !cvIsInf(ts))
+                        {
+                            Point3f pv = (orig + dir*ts);
+                            Point3f nv = getNormalVoxel(pv);
+
+                            if(!isNaN(nv))
+                            {
+                                //convert pv and nv to camera space
+                                normal = volRot * nv;
+                                // interpolation optimized a little
+                                point = vol2cam * (pv*voxelSize);
+                            }
+                        }
+                    }
+                }
+                ptsRow[x] = toPtype(point);
+                nrmRow[x] = toPtype(normal);
+            }
+        }
+    };
+
+    parallel_for_(Range(0, points.rows), RaycastInvoker);
+}
+
+void TSDFVolumeBrickedCPU::fetchPointsNormals(OutputArray _points, OutputArray _normals) const
+{
+    CV_TRACE_FUNCTION();
+
+    if(!_points.needed())
+        return;
+
+    bool needNormals = _normals.needed();
+    std::vector<int> allocated;
+    for (int idx = 0; idx < (int)brickRows.size(); idx++)
+    {
+        if (brickRows[idx] >= 0)
+            allocated.push_back(idx);
+    }
+
+    std::vector<std::vector<ptype>> pVecs(allocated.size()), nVecs(allocated.size());
+    parallel_for_(Range(0, (int)allocated.size()), [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            int idx = allocated[i];
+            Point3i base(idx / (brickDims.y * brickDims.z),
+                         (idx / brickDims.z) % brickDims.y,
+                         idx % brickDims.z);
+            base *= brickResolution;
+            std::vector<ptype>& points = pVecs[i];
+            std::vector<ptype>& normals = nVecs[i];
+
+            for (int lx = 0; lx < brickResolution; lx++)
+            for (int ly = 0; ly < brickResolution; ly++)
+            for (int lz = 0; lz < brickResolution; lz++)
+            {
+                Point3i v0i = base + Point3i(lx, ly, lz);
+                if (v0i.x >= volResolution.x || v0i.y >= volResolution.y || v0i.z >= volResolution.z)
+                    continue;
+                const TsdfVoxel& voxel0 = *voxelPtr(v0i.x, v0i.y, v0i.z);
+                float v0 = tsdfToFloat(voxel0.tsdf);
+                if (voxel0.weight == 0 || v0 == 1.f)
+                    continue;
+
+                Point3f V(Point3f((float)v0i.x + 0.5f, (float)v0i.y + 0.5f, (float)v0i.z + 0.5f)*voxelSize);
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    Point3i shift(axis == 0, axis == 1, axis == 2);
+                    Point3i vdi = v0i + shift;
+                    if (vdi.x >= volResolution.x || vdi.y >= volResolution.y || vdi.z >= volResolution.z)
+                        continue;
+                    const TsdfVoxel* voxeld = voxelPtr(vdi.x, vdi.y, vdi.z);
+                    if (!voxeld)
+                        continue;
+                    float vd = tsdfToFloat(voxeld->tsdf);
+                    if (voxeld->weight != 0 && vd != 1.f && ((v0 > 0 && vd < 0) || (v0 < 0 && vd > 0)))
+                    {
+                        //linearly interpolate coordinate
+                        float Vc    = axis == 0 ? V.x : (axis == 1 ? V.y : V.z);
+                        float Vn    = Vc + voxelSize;
+                        float dinv  = 1.f/(abs(v0)+abs(vd));
+                        float inter = (Vc*abs(vd) + Vn*abs(v0))*dinv;
+
+                        Point3f p(shift.x ? inter : V.x,
+                                  shift.y ? inter : V.y,
+                                  shift.z ? inter : V.z);
+                        points.push_back(toPtype(pose * p));
+                        if (needNormals)
+                            normals.push_back(toPtype(pose.rotation() * getNormalVoxel(p*voxelSizeInv)));
+                    }
+                }
+            }
+        }
+    });
+
+    std::vector<ptype> points, normals;
+    for (size_t i = 0; i < pVecs.size(); i++)
+    {
+        points.insert(points.end(), pVecs[i].begin(), pVecs[i].end());
+        normals.insert(normals.end(), nVecs[i].begin(), nVecs[i].end());
+    }
+
+    _points.create((int)points.size(), 1, POINT_TYPE);
+    if (!points.empty())
+        Mat((int)points.size(), 1, POINT_TYPE, &points[0]).copyTo(_points.getMat());
+
+    if (needNormals)
+    {
+        _normals.create((int)normals.size(), 1, POINT_TYPE);
+        if (!normals.empty())
+            Mat((int)normals.size(), 1, POINT_TYPE, &normals[0]).copyTo(_normals.getMat());
+    }
+}
+
+void TSDFVolumeBrickedCPU::fetchNormals(InputArray _points, OutputArray _normals) const
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(!_points.empty());
+    if(_normals.needed())
+    {
+        Points points = _points.getMat();
+        CV_Assert(points.type() == POINT_TYPE);
+
+        _normals.createSameSize(_points, _points.type());
+        Normals normals = _normals.getMat();
+
+        const Affine3f invPose(pose.inv());
+        points.forEach([&](const ptype& pp, const int* position)
+        {
+            Point3f p = fromPtype(pp);
+            Point3f n = nan3;
+            if (!isNaN(p))
+            {
+                Point3f voxPt = (invPose * p);
+                voxPt = voxPt * voxelSizeInv;
+                n = pose.rotation() * getNormalVoxel(voxPt);
+            }
+            normals(position[0], position[1]) = toPtype(n);
+        });
+    }
+}
+
+}  // namespace kinfu
+}  // namespace cv
@@ -0,0 +1,102 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+// This code is also subject to the license terms in the LICENSE_KinectFusion.md file found in this
+// module's directory
+
+#ifndef __OPENCV_KINFU_BRICKED_TSDF_H__
+#define __OPENCV_KINFU_BRICKED_TSDF_H__
+
+#include "tsdf_functions.hpp"
+
+namespace cv
+{
+namespace kinfu
+{
+
+//! Dense TSDF volume which voxels are stored in bricks of brickResolution^3 voxels.
+//! A brick is allocated when the truncation band of a depth frame touches it for the first time,
+//! unallocated bricks read as never integrated voxels.
+//! Each brick has an occupancy bit which is set when any of its voxels has non-zero weight,
+//! raycast jumps over the bricks without it.
+class TSDFVolumeBrickedCPU : public TSDFVolume
+{
+   public:
+    static const int brickResolution = 8;
+    static const int brickDegree = 3;
+
+    // dimension in voxels, size in meters
+    TSDFVolumeBrickedCPU(float _voxelSize, Matx44f _pose, float _raycastStepFactor, float _truncDist,
+                         int _maxWeight, Point3i _resolution, float _truncateThreshold);
+
+    virtual void integrate(InputArray _depth, float depthFactor, const Matx44f& cameraPose,
+                           const kinfu::Intr& intrinsics, const int frameId = 0) override;
+    virtual void raycast(const Matx44f& cameraPose, const kinfu::Intr& intrinsics, const Size& frameSize,
+                         OutputArray points, OutputArray normals) const override;
+    virtual void integrate(InputArray, InputArray, float, const Matx44f&, const kinfu::Intr&, const Intr&, const int) override
+        { CV_Error(Error::StsNotImplemented, "Not implemented"); };
+    virtual void raycast(const Matx44f&, const kinfu::Intr&, const Size&, OutputArray, OutputArray, OutputArray) const override
+        { CV_Error(Error::StsNotImplemented, "Not implemented"); };
+
+    virtual void fetchNormals(InputArray points, OutputArray _normals) const override;
+    virtual void fetchPointsNormals(OutputArray points, OutputArray normals) const override;
+
+    virtual void reset() override;
+    TsdfVoxel at(const Vec3i& volumeIdx) const;
+
+    //! Number of bricks which have memory allocated
+    int getAllocatedBricks() const { return nAllocatedBricks; }
+
+    float interpolateVoxel(const cv::Point3f& p) const;
+    Point3f getNormalVoxel(const cv::Point3f& p) const;
+
+    inline int brickIdx(int bx, int by, int bz) const
+    {
+        return (bx * brickDims.y + by) * brickDims.z + bz;
+    }
+
+    inline bool isBrickOccupied(int idx) const
+    {
+        return (occupancy[idx >> 6] >> (idx & 63)) & 1;
+    }
+
+    //! Pointer to a voxel inside of the volume or null if its brick is not allocated
+    inline const TsdfVoxel* voxelPtr(int x, int y, int z) const
+    {
+        if ((unsigned)x >= (unsigned)volResolution.x || (unsigned)y >= (unsigned)volResolution.y ||
+            (unsigned)z >= (unsigned)volResolution.z)
+            return nullptr;
+        int row = brickRows[brickIdx(x >> brickDegree, y >> brickDegree, z >> brickDegree)];
+        if (row < 0)
+            return nullptr;
+        const int mask = brickResolution - 1;
+        return bricks.ptr<TsdfVoxel>(row) + (x & mask) * brickStrides[0] + (y & mask) * brickStrides[1] + (z & mask);
+    }
+
+    inline float voxelTsdf(int x, int y, int z) const
+    {
+        const TsdfVoxel* v = voxelPtr(x, y, z);
+        return v ? tsdfToFloat(v->tsdf) : emptyTsdf;
+    }
+
+    Point3i brickDims;
+    Vec4i brickStrides;
+    //! Row of a brick in bricks, -1 for unallocated bricks
+    std::vector<int> brickRows;
+    //! One bit per brick
+    std::vector<uint64_t> occupancy;
+    //! Rows of brickResolution^3 voxels
+    Mat bricks;
+    int nAllocatedBricks;
+    //! Value of voxels which have never been integrated
+    float emptyTsdf;
+
+    float truncateThreshold;
+    Vec6f frameParams;
+    Mat pixNorms;
+};
+
+}  // namespace kinfu
+}  // namespace cv
+#endif
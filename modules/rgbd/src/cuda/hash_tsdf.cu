@@ -0,0 +1,703 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+// This code is also subject to the license terms in the LICENSE_KinectFusion.md file found in this module's directory
+
+#if !defined CUDA_DISABLER
+
+#include <math_constants.h>
+
+#include "opencv2/core/cuda/common.hpp"
+
+#include "hash_tsdf_cuda.hpp"
+
+namespace cv
+{
+namespace kinfu
+{
+namespace cuda
+{
+using cv::cuda::PtrStepSzf;
+using cv::cuda::PtrStepSz;
+using cv::cuda::PtrStep;
+using cv::cuda::device::divUp;
+
+static const unsigned long long EMPTY_KEY = 0xffffffffffffffffull;
+
+///////////////////////////////////////////////////////////////
+// Utility
+
+__device__ __forceinline__ float3 transformPoint(const DeviceAffine& a, float3 p)
+{
+    return make_float3(a.m[0] * p.x + a.m[1] * p.y + a.m[ 2] * p.z + a.m[ 3],
+                       a.m[4] * p.x + a.m[5] * p.y + a.m[ 6] * p.z + a.m[ 7],
+                       a.m[8] * p.x + a.m[9] * p.y + a.m[10] * p.z + a.m[11]);
+}
+
+__device__ __forceinline__ float3 rotateVector(const DeviceAffine& a, float3 p)
+{
+    return make_float3(a.m[0] * p.x + a.m[1] * p.y + a.m[ 2] * p.z,
+                       a.m[4] * p.x + a.m[5] * p.y + a.m[ 6] * p.z,
+                       a.m[8] * p.x + a.m[9] * p.y + a.m[10] * p.z);
+}
+
+__device__ __forceinline__ float lerp(float a, float b, float t)
+{
+    return a + (b - a) * t;
+}
+
+__device__ __forceinline__ float tsdfToFloat(signed char num)
+{
+    return float(num) * (-1.f / 128.f);
+}
+
+__device__ __forceinline__ signed char floatToTsdf(float num)
+{
+    signed char res = (signed char)(num * (-128.f));
+    return res ? res : (num < 0 ? 1 : -1);
+}
+
+__device__ __forceinline__ int3 floorToInt(float3 p)
+{
+    return make_int3(__float2int_rd(p.x), __float2int_rd(p.y), __float2int_rd(p.z));
+}
+
+///////////////////////////////////////////////////////////////
+// Hash table of volume units
+
+__device__ __forceinline__ unsigned long long packUnitIdx(int3 idx)
+{
+    // 21 bits per coordinate, enough for 2^20 units around the volume origin in every direction
+    const int offset = 1 << 20;
+    const unsigned long long mask = (1ull << 21) - 1;
+    return ((((unsigned long long)(idx.x + offset)) & mask) << 42) |
+           ((((unsigned long long)(idx.y + offset)) & mask) << 21) |
+            (((unsigned long long)(idx.z + offset)) & mask);
+}
+
+__device__ __forceinline__ unsigned int hashKey(unsigned long long key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return (unsigned int)key;
+}
+
+__device__ __forceinline__ int findUnit(const HashTSDFDeviceData& data, int3 idx)
+{
+    const unsigned long long key = packUnitIdx(idx);
+    unsigned int slot = hashKey(key) & data.hashMask;
+    for (int probe = 0; probe <= data.hashMask; probe++)
+    {
+        unsigned long long k = data.keys[slot];
+        if (k == key)
+            return data.values[slot];
+        if (k == EMPTY_KEY)
+            return -1;
+        slot = (slot + 1) & data.hashMask;
+    }
+    return -1;
+}
+
+//! Inserts the unit if it's not there yet and gives it the next free index.
+//! Running out of units or slots raises COUNTER_OVERFLOW, the host then grows the storage,
+//! rebuilds the table and runs the allocation again.
+__device__ void insertUnit(const HashTSDFDeviceData& data, int3 idx)
+{
+    const unsigned long long key = packUnitIdx(idx);
+    unsigned int slot = hashKey(key) & data.hashMask;
+    for (int probe = 0; probe <= data.hashMask; probe++)
+    {
+        unsigned long long k = data.keys[slot];
+        if (k == key)
+            return;
+        if (k == EMPTY_KEY)
+        {
+            k = atomicCAS(&data.keys[slot], EMPTY_KEY, key);
+            if (k == EMPTY_KEY)
+            {
+                int unit = atomicAdd(&data.counters[COUNTER_UNITS], 1);
+                if (unit < data.unitCapacity)
+                {
+                    data.unitCoords[3 * unit + 0] = idx.x;
+                    data.unitCoords[3 * unit + 1] = idx.y;
+                    data.unitCoords[3 * unit + 2] = idx.z;
+                    data.values[slot] = unit;
+                }
+                else
+                {
+                    data.values[slot] = -1;
+                    data.counters[COUNTER_OVERFLOW] = 1;
+                }
+                return;
+            }
+            if (k == key)
+                return;
+        }
+        slot = (slot + 1) & data.hashMask;
+    }
+    data.counters[COUNTER_OVERFLOW] = 1;
+}
+
+__global__ void rebuildHashTableKernel(const HashTSDFDeviceData data, const int nUnits)
+{
+    const int unit = blockIdx.x * blockDim.x + threadIdx.x;
+    if (unit >= nUnits)
+        return;
+
+    const int3 idx = make_int3(data.unitCoords[3 * unit + 0], data.unitCoords[3 * unit + 1],
+                               data.unitCoords[3 * unit + 2]);
+    const unsigned long long key = packUnitIdx(idx);
+    unsigned int slot = hashKey(key) & data.hashMask;
+    while (atomicCAS(&data.keys[slot], EMPTY_KEY, key) != EMPTY_KEY)
+        slot = (slot + 1) & data.hashMask;
+    data.values[slot] = unit;
+}
+
+void clearHashTable(const HashTSDFDeviceData& data)
+{
+    cudaSafeCall( cudaMemset(data.keys, 0xff, sizeof(unsigned long long) * (size_t(data.hashMask) + 1)) );
+}
+
+void rebuildHashTable(const HashTSDFDeviceData& data, int nUnits)
+{
+    clearHashTable(data);
+    if (nUnits <= 0)
+        return;
+
+    const dim3 block(256);
+    const dim3 grid(divUp(nUnits, block.x));
+    rebuildHashTableKernel<<<grid, block>>>(data, nUnits);
+    cudaSafeCall( cudaGetLastError() );
+}
+
+///////////////////////////////////////////////////////////////
+// Allocation
+
+//! Marches along the ray of every valid depth pixel through the truncation band
+//! around the surface and inserts the volume units it crosses
+__global__ void allocateVolumeUnitsKernel(const HashTSDFDeviceData data, const HashTSDFDeviceParams params,
+                                          const PtrStepSzf depth, const float invDepthFactor,
+                                          const DeviceAffine cam2vol, const DeviceIntrinsics intr)
+{
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int y = blockIdx.y * blockDim.y + threadIdx.y;
+    if (x >= depth.cols || y >= depth.rows)
+        return;
+
+    const float z = depth(y, x) * invDepthFactor;
+    if (!(z > 0) || z > params.truncateThreshold)
+        return;
+
+    const float3 dir = make_float3((x - intr.cx) / intr.fx, (y - intr.cy) / intr.fy, 1.f);
+    const float dirLen = sqrtf(dir.x * dir.x + dir.y * dir.y + 1.f);
+
+    // truncation band and step along the ray, expressed as depth
+    const float band = params.truncDist / dirLen;
+    const float zStep = 0.5f * params.volumeUnitSize / dirLen;
+    const float zStart = fmaxf(z - band, 0.f), zEnd = z + band;
+    const int nSteps = (int)ceilf((zEnd - zStart) / zStep);
+    const float unitSizeInv = 1.f / params.volumeUnitSize;
+
+    int3 prevIdx = make_int3(INT_MIN, INT_MIN, INT_MIN);
+    for (int i = 0; i <= nSteps; i++)
+    {
+        const float zi = fminf(zStart + i * zStep, zEnd);
+        const float3 volPt = transformPoint(cam2vol, make_float3(dir.x * zi, dir.y * zi, zi));
+        const int3 idx = floorToInt(make_float3(volPt.x * unitSizeInv, volPt.y * unitSizeInv, volPt.z * unitSizeInv));
+        if (idx.x == prevIdx.x && idx.y == prevIdx.y && idx.z == prevIdx.z)
+            continue;
+        insertUnit(data, idx);
+        prevIdx = idx;
+    }
+}
+
+void allocateVolumeUnits(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+                         const PtrStepSzf& depth, float invDepthFactor,
+                         const DeviceAffine& cam2vol, const DeviceIntrinsics& intr)
+{
+    const dim3 block(32, 8);
+    const dim3 grid(divUp(depth.cols, block.x), divUp(depth.rows, block.y));
+    allocateVolumeUnitsKernel<<<grid, block>>>(data, params, depth, invDepthFactor, cam2vol, intr);
+    cudaSafeCall( cudaGetLastError() );
+}
+
+__global__ void initVolumeUnitsKernel(const HashTSDFDeviceData data, const HashTSDFDeviceParams params,
+                                      const int begin, const int end, const int frameId)
+{
+    const int unit = begin + blockIdx.y;
+    if (unit >= end)
+        return;
+
+    const int volCubed = 1 << (3 * params.unitDegree);
+    short* row = (short*)data.voxels.ptr(unit);
+    const unsigned char empty[2] = { (unsigned char)params.emptyTsdf, 0 };
+    const short emptyVoxel = *(const short*)empty;
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < volCubed; i += blockDim.x * gridDim.x)
+        row[i] = emptyVoxel;
+
+    if (blockIdx.x == 0 && threadIdx.x == 0)
+        data.lastVisibleIndices[unit] = frameId;
+}
+
+void initVolumeUnits(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+                     int begin, int end, int frameId)
+{
+    if (begin >= end)
+        return;
+
+    const int volCubed = 1 << (3 * params.unitDegree);
+    const dim3 block(256);
+    const dim3 grid(divUp(volCubed, block.x), end - begin);
+    initVolumeUnitsKernel<<<grid, block>>>(data, params, begin, end, frameId);
+    cudaSafeCall( cudaGetLastError() );
+}
+
+//! Collects units which are new or whose origin is seen by the camera
+__global__ void markActiveKernel(const HashTSDFDeviceData data, const HashTSDFDeviceParams params,
+                                 const DeviceAffine vol2cam, const DeviceIntrinsics intr,
+                                 const int width, const int height,
+                                 const int nUnits, const int firstNewUnit, const int frameId)
+{
+    const int unit = blockIdx.x * blockDim.x + threadIdx.x;
+    if (unit >= nUnits)
+        return;
+
+    bool active = unit >= firstNewUnit;
+    if (!active)
+    {
+        const float3 unitPos = make_float3(data.unitCoords[3 * unit + 0] * params.volumeUnitSize,
+                                           data.unitCoords[3 * unit + 1] * params.volumeUnitSize,
+                                           data.unitCoords[3 * unit + 2] * params.volumeUnitSize);
+        const float3 camPt = transformPoint(vol2cam, unitPos);
+        if (camPt.z < 0 || camPt.z > params.truncateThreshold)
+            return;
+
+        const float invz = 1.f / camPt.z;
+        const float u = intr.fx * camPt.x * invz + intr.cx;
+        const float v = intr.fy * camPt.y * invz + intr.cy;
+        if (u >= 0 && v >= 0 && u < width && v < height)
+        {
+            data.lastVisibleIndices[unit] = frameId;
+            active = true;
+        }
+    }
+
+    if (active)
+    {
+        int pos = atomicAdd(&data.counters[COUNTER_ACTIVE], 1);
+        data.activeUnits[pos] = unit;
+    }
+}
+
+void markActive(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+                const DeviceAffine& vol2cam, const DeviceIntrinsics& intr, int width, int height,
+                int nUnits, int firstNewUnit, int frameId)
+{
+    cudaSafeCall( cudaMemset(data.counters + COUNTER_ACTIVE, 0, sizeof(int)) );
+    if (nUnits <= 0)
+        return;
+
+    const dim3 block(256);
+    const dim3 grid(divUp(nUnits, block.x));
+    markActiveKernel<<<grid, block>>>(data, params, vol2cam, intr, width, height, nUnits, firstNewUnit, frameId);
+    cudaSafeCall( cudaGetLastError() );
+}
+
+///////////////////////////////////////////////////////////////
+// Integration
+
+//! Same scheme as the OpenCL integrateAllVolumeUnits: every thread updates one voxel column of an active unit
+__global__ void integrateKernel(const HashTSDFDeviceData data, const HashTSDFDeviceParams params,
+                                const PtrStepSzf depth, const float dfac,
+                                const DeviceAffine vol2cam, const DeviceAffine camInv,
+                                const DeviceIntrinsics intr)
+{
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int y = blockIdx.y * blockDim.y + threadIdx.y;
+    const int res = params.unitResolution;
+    if (x >= res || y >= res)
+        return;
+
+    const int unit = data.activeUnits[blockIdx.z];
+    char2* volume = (char2*)data.voxels.ptr(unit);
+
+    // volUnit2cam = vol2cam + camInv * (idx * volumeUnitSize)
+    const float3 mulIdx = make_float3(data.unitCoords[3 * unit + 0] * params.volumeUnitSize,
+                                      data.unitCoords[3 * unit + 1] * params.volumeUnitSize,
+                                      data.unitCoords[3 * unit + 2] * params.volumeUnitSize);
+    DeviceAffine unit2cam = vol2cam;
+    const float3 shift = rotateVector(camInv, mulIdx);
+    unit2cam.m[3] += shift.x; unit2cam.m[7] += shift.y; unit2cam.m[11] += shift.z;
+
+    const float2 limits = make_float2(depth.cols - 1, depth.rows - 1);
+    const float truncDistInv = 1.f / params.truncDist;
+
+    const float3 basePt = transformPoint(unit2cam, make_float3(x * params.voxelSize, y * params.voxelSize, 0));
+    const float3 zStep = make_float3(unit2cam.m[2] * params.voxelSize, unit2cam.m[6] * params.voxelSize,
+                                     unit2cam.m[10] * params.voxelSize);
+    float3 camSpacePt = basePt;
+
+    const int volYidx = x * params.volStrides[0] + y * params.volStrides[1];
+
+    int startZ, endZ;
+    if (fabsf(zStep.z) > 1e-5f)
+    {
+        int baseZ = (int)(-basePt.z / zStep.z);
+        if (zStep.z > 0)
+        {
+            startZ = baseZ;
+            endZ = res;
+        }
+        else
+        {
+            startZ = 0;
+            endZ = baseZ;
+        }
+    }
+    else
+    {
+        startZ = 0;
+        endZ = basePt.z > 0 ? res : 0;
+    }
+    startZ = max(0, startZ);
+    endZ = min(res, endZ);
+
+    for (int z = startZ; z < endZ; z++)
+    {
+        camSpacePt = make_float3(basePt.x + zStep.x * z, basePt.y + zStep.y * z, basePt.z + zStep.z * z);
+        if (camSpacePt.z <= 0)
+            continue;
+
+        const float px = camSpacePt.x / camSpacePt.z, py = camSpacePt.y / camSpacePt.z;
+        const float2 projected = make_float2(px * intr.fx + intr.cx, py * intr.fy + intr.cy);
+
+        // bilinearly interpolate depth at projected
+        if (!(projected.x >= 0 && projected.y >= 0 && projected.x < limits.x && projected.y < limits.y))
+            continue;
+
+        const int xi = __float2int_rd(projected.x), yi = __float2int_rd(projected.y);
+        const float v00 = depth(yi, xi), v01 = depth(yi, xi + 1);
+        const float v10 = depth(yi + 1, xi), v11 = depth(yi + 1, xi + 1);
+
+        // assume correct depth is positive
+        if (!(v00 > 0 && v01 > 0 && v10 > 0 && v11 > 0))
+            continue;
+
+        const float tx = projected.x - xi, ty = projected.y - yi;
+        const float v = lerp(lerp(v00, v01, tx), lerp(v10, v11, tx), ty);
+
+        const float nx = (xi - intr.cx) / intr.fx, ny = (yi - intr.cy) / intr.fy;
+        const float pixNorm = sqrtf(nx * nx + ny * ny + 1.f);
+
+        // difference between distances of point and of surface to camera
+        const float sdf = pixNorm * (v * dfac - camSpacePt.z);
+        if (sdf >= -params.truncDist)
+        {
+            const float tsdf = fminf(1.f, sdf * truncDistInv);
+            const int volIdx = volYidx + z * params.volStrides[2];
+
+            char2 voxel = volume[volIdx];
+            float value = tsdfToFloat(voxel.x);
+            int weight = (unsigned char)voxel.y;
+            // update TSDF
+            value = (value * weight + tsdf) / (weight + 1);
+            weight = min(weight + 1, params.maxWeight);
+
+            voxel.x = floatToTsdf(value);
+            voxel.y = (char)weight;
+            volume[volIdx] = voxel;
+        }
+    }
+}
+
+void integrateActiveUnits(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+                          const PtrStepSzf& depth, float invDepthFactor,
+                          const DeviceAffine& vol2cam, const DeviceAffine& camInv,
+                          const DeviceIntrinsics& intr, int nActive)
+{
+    if (nActive <= 0)
+        return;
+
+    const int side = min(params.unitResolution, 16);
+    const dim3 block(side, side);
+    const dim3 grid(divUp(params.unitResolution, block.x), divUp(params.unitResolution, block.y), nActive);
+    integrateKernel<<<grid, block>>>(data, params, depth, invDepthFactor, vol2cam, camInv, intr);
+    cudaSafeCall( cudaGetLastError() );
+}
+
+///////////////////////////////////////////////////////////////
+// Voxel access and normals
+
+__device__ __forceinline__ char2 voxelAt(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+                                         int3 local, int unit)
+{
+    const char2* volume = (const char2*)data.voxels.ptr(unit);
+    return volume[local.x * params.volStrides[0] + local.y * params.volStrides[1] + local.z * params.volStrides[2]];
+}
+
+__device__ __forceinline__ float interpolate(float tx, float ty, float tz, const float* vz)
+{
+    const float vy0 = lerp(vz[0], vz[1], tz), vy1 = lerp(vz[2], vz[3], tz);
+    const float vy2 = lerp(vz[4], vz[5], tz), vy3 = lerp(vz[6], vz[7], tz);
+    return lerp(lerp(vy0, vy1, ty), lerp(vy2, vy3, ty), tx);
+}
+
+//! Gradient of the interpolated TSDF, same stencil as the CPU and OpenCL getNormalVoxel
+__device__ float3 getNormalVoxel(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params, float3 ptVox)
+{
+    const float3 fip = make_float3(floorf(ptVox.x), floorf(ptVox.y), floorf(ptVox.z));
+    const int3 iptVox = make_int3((int)fip.x, (int)fip.y, (int)fip.z);
+
+    // A small cache to reduce the number of findUnit() calls
+    // -2 means not queried yet, -1 means not found
+    int iterMap[8];
+    int3 iterIdx[8];
+    for (int i = 0; i < 8; i++)
+        iterMap[i] = -2;
+
+    const int offsets[32][3] = { { 0,  0,  0}, { 0,  0,  1}, { 0,  1,  0}, { 0,  1,  1}, //  0-3
+                                 { 1,  0,  0}, { 1,  0,  1}, { 1,  1,  0}, { 1,  1,  1}, //  4-7
+                                 {-1,  0,  0}, {-1,  0,  1}, {-1,  1,  0}, {-1,  1,  1}, //  8-11
+                                 { 2,  0,  0}, { 2,  0,  1}, { 2,  1,  0}, { 2,  1,  1}, // 12-15
+                                 { 0, -1,  0}, { 0, -1,  1}, { 1, -1,  0}, { 1, -1,  1}, // 16-19
+                                 { 0,  2,  0}, { 0,  2,  1}, { 1,  2,  0}, { 1,  2,  1}, // 20-23
+                                 { 0,  0, -1}, { 0,  1, -1}, { 1,  0, -1}, { 1,  1, -1}, // 24-27
+                                 { 0,  0,  2}, { 0,  1,  2}, { 1,  0,  2}, { 1,  1,  2}, // 28-31
+    };
+
+    float vals[32];
+    for (int i = 0; i < 32; i++)
+    {
+        const int3 pt = make_int3(iptVox.x + offsets[i][0], iptVox.y + offsets[i][1], iptVox.z + offsets[i][2]);
+        const int3 unitIdx = make_int3(pt.x >> params.unitDegree, pt.y >> params.unitDegree, pt.z >> params.unitDegree);
+        const int dictIdx = (unitIdx.x & 1) + (unitIdx.y & 1) * 2 + (unitIdx.z & 1) * 4;
+
+        int it = iterMap[dictIdx];
+        if (it < -1 || iterIdx[dictIdx].x != unitIdx.x || iterIdx[dictIdx].y != unitIdx.y ||
+            iterIdx[dictIdx].z != unitIdx.z)
+        {
+            it = findUnit(data, unitIdx);
+            iterMap[dictIdx] = it;
+            iterIdx[dictIdx] = unitIdx;
+        }
+
+        if (it < 0)
+        {
+            vals[i] = 1.f;
+            continue;
+        }
+        const int3 local = make_int3(pt.x - (unitIdx.x << params.unitDegree), pt.y - (unitIdx.y << params.unitDegree),
+                                     pt.z - (unitIdx.z << params.unitDegree));
+        vals[i] = tsdfToFloat(voxelAt(data, params, local, it).x);
+    }
+
+    const int idxxn[8] = {  8,  9, 10, 11,  0,  1,  2,  3 };
+    const int idxxp[8] = {  4,  5,  6,  7, 12, 13, 14, 15 };
+    const int idxyn[8] = { 16, 17,  0,  1, 18, 19,  4,  5 };
+    const int idxyp[8] = {  2,  3, 20, 21,  6,  7, 22, 23 };
+    const int idxzn[8] = { 24,  0, 25,  2, 26,  4, 27,  6 };
+    const int idxzp[8] = {  1, 28,  3, 29,  5, 30,  7, 31 };
+
+    float cx[8], cy[8], cz[8];
+    for (int i = 0; i < 8; i++)
+    {
+        cx[i] = vals[idxxp[i]] - vals[idxxn[i]];
+        cy[i] = vals[idxyp[i]] - vals[idxyn[i]];
+        cz[i] = vals[idxzp[i]] - vals[idxzn[i]];
+    }
+
+    const float tx = ptVox.x - fip.x, ty = ptVox.y - fip.y, tz = ptVox.z - fip.z;
+    float3 normal = make_float3(interpolate(tx, ty, tz, cx), interpolate(tx, ty, tz, cy), interpolate(tx, ty, tz, cz));
+
+    const float nv = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+    if (nv < 0.0001f)
+        return make_float3(CUDART_NAN_F, CUDART_NAN_F, CUDART_NAN_F);
+    return make_float3(normal.x / nv, normal.y / nv, normal.z / nv);
+}
+
+///////////////////////////////////////////////////////////////
+// Raycast
+
+__global__ void raycastKernel(const HashTSDFDeviceData data, const HashTSDFDeviceParams params,
+                              const DeviceAffine cam2vol, const DeviceAffine vol2cam, const DeviceIntrinsics intr,
+                              PtrStepSz<float4> points, PtrStep<float4> normals)
+{
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int y = blockIdx.y * blockDim.y + threadIdx.y;
+    if (x >= points.cols || y >= points.rows)
+        return;
+
+    float3 point  = make_float3(CUDART_NAN_F, CUDART_NAN_F, CUDART_NAN_F);
+    float3 normal = point;
+
+    float3 planed = rotateVector(cam2vol, make_float3((x - intr.cx) / intr.fx, (y - intr.cy) / intr.fy, 1.f));
+    const float dirInv = rsqrtf(planed.x * planed.x + planed.y * planed.y + planed.z * planed.z);
+
+    const float3 origScaled = make_float3(cam2vol.m[3] * params.voxelSizeInv, cam2vol.m[7] * params.voxelSizeInv,
+                                          cam2vol.m[11] * params.voxelSizeInv);
+    const float3 dirScaled = make_float3(planed.x * dirInv * params.voxelSizeInv, planed.y * dirInv * params.voxelSizeInv,
+                                         planed.z * dirInv * params.voxelSizeInv);
+
+    const float tmax = params.truncateThreshold;
+    float tcurr = 0, tprev = 0;
+    float prevTsdf = params.truncDist;
+
+    while (tcurr < tmax)
+    {
+        const float3 currRayPosVox = make_float3(origScaled.x + tcurr * dirScaled.x, origScaled.y + tcurr * dirScaled.y,
+                                                 origScaled.z + tcurr * dirScaled.z);
+        const int3 currVoxel = floorToInt(currRayPosVox);
+        const int3 currUnitIdx = make_int3(currVoxel.x >> params.unitDegree, currVoxel.y >> params.unitDegree,
+                                           currVoxel.z >> params.unitDegree);
+
+        const int unit = findUnit(data, currUnitIdx);
+
+        float currTsdf = prevTsdf;
+        int currWeight = 0;
+        float stepSize = 0.5f * params.volumeUnitSize;
+
+        if (unit >= 0)
+        {
+            const int3 local = make_int3(currVoxel.x - (currUnitIdx.x << params.unitDegree),
+                                         currVoxel.y - (currUnitIdx.y << params.unitDegree),
+                                         currVoxel.z - (currUnitIdx.z << params.unitDegree));
+            const char2 voxel = voxelAt(data, params, local, unit);
+            currTsdf = tsdfToFloat(voxel.x);
+            currWeight = (unsigned char)voxel.y;
+            stepSize = params.raycastStep;
+        }
+
+        if (prevTsdf > 0.f && currTsdf <= 0.f && currWeight > 0)
+        {
+            const float tInterp = (tcurr * prevTsdf - tprev * currTsdf) / (prevTsdf - currTsdf);
+            if (isfinite(tInterp))
+            {
+                const float3 pvox = make_float3(origScaled.x + tInterp * dirScaled.x, origScaled.y + tInterp * dirScaled.y,
+                                                origScaled.z + tInterp * dirScaled.z);
+                const float3 nv = getNormalVoxel(data, params, pvox);
+
+                if (!isnan(nv.x) && !isnan(nv.y) && !isnan(nv.z))
+                {
+                    //convert pv and nv to camera space
+                    normal = rotateVector(vol2cam, nv);
+                    point = transformPoint(vol2cam, make_float3(pvox.x * params.voxelSize, pvox.y * params.voxelSize,
+                                                                pvox.z * params.voxelSize));
+                }
+            }
+            break;
+        }
+        prevTsdf = currTsdf;
+        tprev = tcurr;
+        tcurr += stepSize;
+    }
+
+    points(y, x) = make_float4(point.x, point.y, point.z, 0.f);
+    normals(y, x) = make_float4(normal.x, normal.y, normal.z, 0.f);
+}
+
+void raycast(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+             const DeviceAffine& cam2vol, const DeviceAffine& vol2cam, const DeviceIntrinsics& intr,
+             PtrStepSz<float4> points, PtrStep<float4> normals)
+{
+    const dim3 block(32, 8);
+    const dim3 grid(divUp(points.cols, block.x), divUp(points.rows, block.y));
+    raycastKernel<<<grid, block>>>(data, params, cam2vol, vol2cam, intr, points, normals);
+    cudaSafeCall( cudaGetLastError() );
+    cudaSafeCall( cudaDeviceSynchronize() );
+}
+
+///////////////////////////////////////////////////////////////
+// Fetching
+
+__global__ void fetchNormalsKernel(const HashTSDFDeviceData data, const HashTSDFDeviceParams params,
+                                   const DeviceAffine invPose, const DeviceAffine pose,
+                                   const PtrStepSz<float4> points, PtrStep<float4> normals)
+{
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int y = blockIdx.y * blockDim.y + threadIdx.y;
+    if (x >= points.cols || y >= points.rows)
+        return;
+
+    const float4 p = points(y, x);
+    float3 n = make_float3(CUDART_NAN_F, CUDART_NAN_F, CUDART_NAN_F);
+    if (!isnan(p.x) && !isnan(p.y) && !isnan(p.z))
+    {
+        const float3 voxelPt = transformPoint(invPose, make_float3(p.x, p.y, p.z));
+        n = rotateVector(pose, getNormalVoxel(data, params, make_float3(voxelPt.x * params.voxelSizeInv,
+                                                                        voxelPt.y * params.voxelSizeInv,
+                                                                        voxelPt.z * params.voxelSizeInv)));
+    }
+    normals(y, x) = make_float4(n.x, n.y, n.z, 0.f);
+}
+
+void fetchNormals(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+                  const DeviceAffine& invPose, const DeviceAffine& pose,
+                  PtrStepSz<float4> points, PtrStep<float4> normals)
+{
+    const dim3 block(32, 8);
+    const dim3 grid(divUp(points.cols, block.x), divUp(points.rows, block.y));
+    fetchNormalsKernel<<<grid, block>>>(data, params, invPose, pose, points, normals);
+    cudaSafeCall( cudaGetLastError() );
+    cudaSafeCall( cudaDeviceSynchronize() );
+}
+
+__global__ void fetchPointsNormalsKernel(const HashTSDFDeviceData data, const HashTSDFDeviceParams params,
+                                         float4* points, float4* normals, const int capacity)
+{
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int y = blockIdx.y * blockDim.y + threadIdx.y;
+    const int res = params.unitResolution;
+    if (x >= res || y >= res)
+        return;
+
+    const int unit = blockIdx.z;
+    const float3 base = make_float3(data.unitCoords[3 * unit + 0] * params.volumeUnitSize,
+                                    data.unitCoords[3 * unit + 1] * params.volumeUnitSize,
+                                    data.unitCoords[3 * unit + 2] * params.volumeUnitSize);
+    for (int z = 0; z < res; z++)
+    {
+        const char2 voxel = voxelAt(data, params, make_int3(x, y, z), unit);
+        if (voxel.x == -128 || voxel.y == 0)
+            continue;
+
+        const int pos = atomicAdd(&data.counters[COUNTER_POINTS], 1);
+        if (!points || pos >= capacity)
+            continue;
+
+        const float3 pt = make_float3(base.x + x * params.voxelSize, base.y + y * params.voxelSize,
+                                      base.z + z * params.voxelSize);
+        points[pos] = make_float4(pt.x, pt.y, pt.z, 0.f);
+        if (normals)
+        {
+            const float3 n = getNormalVoxel(data, params, make_float3(pt.x * params.voxelSizeInv, pt.y * params.voxelSizeInv,
+                                                                      pt.z * params.voxelSizeInv));
+            normals[pos] = make_float4(n.x, n.y, n.z, 0.f);
+        }
+    }
+}
+
+int fetchPointsNormals(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params, int nUnits,
+                       float4* points, float4* normals, int capacity)
+{
+    cudaSafeCall( cudaMemset(data.counters + COUNTER_POINTS, 0, sizeof(int)) );
+    if (nUnits <= 0)
+        return 0;
+
+    const int side = min(params.unitResolution, 16);
+    const dim3 block(side, side);
+    const dim3 grid(divUp(params.unitResolution, block.x), divUp(params.unitResolution, block.y), nUnits);
+    fetchPointsNormalsKernel<<<grid, block>>>(data, params, points, normals, capacity);
+    cudaSafeCall( cudaGetLastError() );
+
+    int count = 0;
+    cudaSafeCall( cudaMemcpy(&count, data.counters + COUNTER_POINTS, sizeof(int), cudaMemcpyDeviceToHost) );
+    return count;
+}
+
+} // namespace cuda
+} // namespace kinfu
+} // namespace cv
+
+#endif /* CUDA_DISABLER */
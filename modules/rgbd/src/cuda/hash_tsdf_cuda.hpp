@@ -0,0 +1,110 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+// This code is also subject to the license terms in the LICENSE_KinectFusion.md file found in this module's directory
+
+#ifndef __OPENCV_RGBD_HASH_TSDF_CUDA_HPP__
+#define __OPENCV_RGBD_HASH_TSDF_CUDA_HPP__
+
+#include <cuda_runtime.h>
+#include "opencv2/core/cuda_types.hpp"
+
+namespace cv
+{
+namespace kinfu
+{
+namespace cuda
+{
+
+enum
+{
+    //! indices in HashTSDFDeviceData::counters
+    COUNTER_UNITS    = 0,
+    COUNTER_ACTIVE   = 1,
+    COUNTER_OVERFLOW = 2,
+    COUNTER_POINTS   = 3,
+    NUM_COUNTERS     = 4
+};
+
+//! Device side storage of a hashed TSDF volume, all pointers are device memory.
+//! Volume units are kept in an open addressing hash table from packed unit
+//! coordinates to unit indices, keys equal to ~0ull mark empty slots.
+struct HashTSDFDeviceData
+{
+    unsigned long long* keys;
+    int* values;
+    int hashMask; //!< capacity of the hash table minus 1, the capacity is a power of 2
+
+    int unitCapacity;
+    int* unitCoords;        //!< 3 ints per unit
+    int* lastVisibleIndices;
+    int* activeUnits;       //!< indices of the units to integrate, COUNTER_ACTIVE of them
+    cv::cuda::PtrStepb voxels; //!< one row of (tsdf, weight) pairs per unit
+    int* counters;
+};
+
+struct HashTSDFDeviceParams
+{
+    float voxelSize;
+    float voxelSizeInv;
+    float volumeUnitSize;
+    float truncDist;
+    float truncateThreshold;
+    float raycastStep;
+    int maxWeight;
+    int unitResolution;
+    int unitDegree;
+    int volStrides[3];
+    //! floatToTsdf(0), the value of never integrated voxels
+    signed char emptyTsdf;
+};
+
+//! First 3 rows of a 4x4 rigid transform, row-major
+struct DeviceAffine
+{
+    float m[12];
+};
+
+struct DeviceIntrinsics
+{
+    float fx, fy, cx, cy;
+};
+
+void clearHashTable(const HashTSDFDeviceData& data);
+void rebuildHashTable(const HashTSDFDeviceData& data, int nUnits);
+
+void allocateVolumeUnits(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+                         const cv::cuda::PtrStepSzf& depth, float invDepthFactor,
+                         const DeviceAffine& cam2vol, const DeviceIntrinsics& intr);
+
+void initVolumeUnits(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+                     int begin, int end, int frameId);
+
+void markActive(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+                const DeviceAffine& vol2cam, const DeviceIntrinsics& intr, int width, int height,
+                int nUnits, int firstNewUnit, int frameId);
+
+void integrateActiveUnits(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+                          const cv::cuda::PtrStepSzf& depth, float invDepthFactor,
+                          const DeviceAffine& vol2cam, const DeviceAffine& camInv,
+                          const DeviceIntrinsics& intr, int nActive);
+
+void raycast(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+             const DeviceAffine& cam2vol, const DeviceAffine& vol2cam, const DeviceIntrinsics& intr,
+             cv::cuda::PtrStepSz<float4> points, cv::cuda::PtrStep<float4> normals);
+
+void fetchNormals(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params,
+                  const DeviceAffine& invPose, const DeviceAffine& pose,
+                  cv::cuda::PtrStepSz<float4> points, cv::cuda::PtrStep<float4> normals);
+
+//! Writes the points (and normals if not null) of observed voxels, in volume coordinates.
+//! With null points only counts them. Returns the number of points.
+int fetchPointsNormals(const HashTSDFDeviceData& data, const HashTSDFDeviceParams& params, int nUnits,
+                       float4* points, float4* normals, int capacity);
+
+} // namespace cuda
+} // namespace kinfu
+} // namespace cv
+
+#endif
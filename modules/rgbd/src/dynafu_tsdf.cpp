@@ -59,6 +59,9 @@ public:
 
 private:
     Point3f interpolate(Point3f p1, Point3f p2, float v1, float v2) const;
+
+    // version of the warp field nodes the voxel neighbours were searched among
+    uint64 neighboursVersion;
 };
 
 
@@ -112,7 +115,8 @@ TSDFVolume::TSDFVolume(Point3i _res, float _voxelSize, Affine3f _pose, float _tr
 // dimension in voxels, size in meters
 TSDFVolumeCPU::TSDFVolumeCPU(Point3i _res, float _voxelSize, cv::Affine3f _pose, float _truncDist, int _maxWeight,
                              float _raycastStepFactor, bool zFirstMemOrder) :
-    TSDFVolume(_res, _voxelSize, _pose, _truncDist, _maxWeight, _raycastStepFactor, zFirstMemOrder)
+    TSDFVolume(_res, _voxelSize, _pose, _truncDist, _maxWeight, _raycastStepFactor, zFirstMemOrder),
+    neighboursVersion(0)
 {
     volume = Mat(1, volResolution.x * volResolution.y * volResolution.z, rawType<Voxel>());
 
@@ -127,8 +131,9 @@ void TSDFVolumeCPU::reset()
     volume.forEach<VecT>([](VecT& vv, const int* /* position */)
     {
         Voxel& v = reinterpret_cast<Voxel&>(vv);
-        v.v = 0; v.weight = 0;
+        v.v = 0; v.weight = 0; v.n = 0;
     });
+    neighboursVersion = 0;
 }
 
 static const bool fixMissingData = false;
@@ -209,7 +214,7 @@ static inline depthType bilinearDepth(const Depth& m, cv::Point2f pt)
 struct IntegrateInvoker : ParallelLoopBody
 {
     IntegrateInvoker(TSDFVolumeCPU& _volume, const Depth& _depth, Intr intrinsics, cv::Affine3f cameraPose,
-                     float depthFactor, Ptr<WarpField> wf) :
+                     float depthFactor, Ptr<WarpField> wf, bool _updateNeighbours) :
         ParallelLoopBody(),
         volume(_volume),
         depth(_depth),
@@ -217,7 +222,8 @@ struct IntegrateInvoker : ParallelLoopBody
         vol2cam(cameraPose.inv() * _volume.pose),
         truncDistInv(1.f/_volume.truncDist),
         dfac(1.f/depthFactor),
-        warpfield(wf)
+        warpfield(wf),
+        updateNeighbours(_updateNeighbours)
     {
         volDataStart = volume.volume.ptr<Voxel>();
     }
@@ -226,6 +232,9 @@ struct IntegrateInvoker : ParallelLoopBody
     {
         CV_TRACE_FUNCTION();
 
+        std::vector<int> indices(warpfield->k);
+        std::vector<float> dists(warpfield->k);
+
         for(int x = range.start; x < range.end; x++)
         {
             Voxel* volDataX = volDataStart + x*volume.volDims[0];
@@ -239,10 +248,8 @@ struct IntegrateInvoker : ParallelLoopBody
 
                     Point3f volPt = Point3f((float)x, (float)y, (float)z)*volume.voxelSize;
 
-                    if(warpfield->getNodeIndex())
+                    if(updateNeighbours)
                     {
-                        std::vector<int> indices(warpfield->k);
-                        std::vector<float> dists(warpfield->k);
                         warpfield->findNeighbours(volPt, indices, dists);
 
                         voxel.n = 0;
@@ -314,6 +321,7 @@ struct IntegrateInvoker : ParallelLoopBody
     const float dfac;
     Voxel* volDataStart;
     Ptr<WarpField> warpfield;
+    const bool updateNeighbours;
 };
 
 // use depth instead of distance (optimization)
@@ -324,9 +332,15 @@ void TSDFVolumeCPU::integrate(InputArray _depth, float depthFactor, cv::Affine3f
     CV_Assert(_depth.type() == DEPTH_TYPE);
     Depth depth = _depth.getMat();
 
-    IntegrateInvoker ii(*this, depth, intrinsics, cameraPose, depthFactor, wf);
+    // The nearest nodes of the voxels only change with the nodes, the search is skipped otherwise
+    const bool updateNeighbours = wf->getNodeIndex() && wf->getNodesVersion() != neighboursVersion;
+
+    IntegrateInvoker ii(*this, depth, intrinsics, cameraPose, depthFactor, wf, updateNeighbours);
     Range range(0, volResolution.x);
     parallel_for_(range, ii);
+
+    if(updateNeighbours)
+        neighboursVersion = wf->getNodesVersion();
 }
 
 inline volumeType TSDFVolumeCPU::interpolateVoxel(Point3f p) const
@@ -4,19 +4,29 @@
 #include "precomp.hpp"
 #include "hash_tsdf.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <cstdio>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <limits>
 #include <vector>
 
 #include "kinfu_frame.hpp"
+#include "marchingcubes.hpp"
 #include "opencv2/core/cvstd.hpp"
 #include "opencv2/core/utility.hpp"
 #include "opencv2/core/utils/trace.hpp"
 #include "utils.hpp"
 #include "opencl_kernels_rgbd.hpp"
 
+#ifdef HAVE_CUDA
+#include "opencv2/core/cuda.hpp"
+#include "opencv2/core/utils/configuration.private.hpp"
+#include "cuda/hash_tsdf_cuda.hpp"
+#endif
+
 #define USE_INTERPOLATION_IN_GETNORMAL 1
 #define VOLUMES_SIZE 8192
 
@@ -81,7 +91,10 @@ struct tsdf_hash
 struct VolumeUnit
 {
     cv::Vec3i coord;
+    //! row in the voxel data, -1 when the unit is streamed out
     int index;
+    //! slot in the disk storage when the unit is streamed out, -1 otherwise
+    int diskSlot = -1;
     cv::Matx44f pose;
     int lastVisibleIndex = 0;
     bool isActive;
@@ -90,6 +103,83 @@ struct VolumeUnit
 typedef std::unordered_set<cv::Vec3i, tsdf_hash> VolumeUnitIndexSet;
 typedef std::unordered_map<cv::Vec3i, VolumeUnit, tsdf_hash> VolumeUnitIndexes;
 
+//! Triangles of the cubes starting in a volume unit
+struct VolumeUnitMesh
+{
+    std::vector<ptype> vertices;
+    std::vector<ptype> normals;
+};
+
+typedef std::unordered_map<cv::Vec3i, VolumeUnitMesh, tsdf_hash> VolumeUnitMeshes;
+
+//! Scratch file of fixed-size slots keeping the voxels of streamed out volume units.
+//! A slot is freed as soon as its unit is read back.
+class VolumeUnitDiskStorage
+{
+public:
+    VolumeUnitDiskStorage() : unitBytes(0), nSlots(0) { }
+    ~VolumeUnitDiskStorage() { close(); }
+
+    void open(const String& _path, size_t _unitBytes)
+    {
+        close();
+        path = _path;
+        unitBytes = _unitBytes;
+        file.open(path.c_str(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            CV_Error_(Error::StsError, ("Can't open volume unit storage: %s", path.c_str()));
+    }
+
+    void close()
+    {
+        if (file.is_open())
+        {
+            file.close();
+            std::remove(path.c_str());
+        }
+        freeSlots.clear();
+        nSlots = 0;
+    }
+
+    bool isOpen() const { return file.is_open(); }
+
+    int store(const uchar* data)
+    {
+        int slot;
+        if (!freeSlots.empty())
+        {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else
+        {
+            slot = nSlots++;
+        }
+        file.seekp(std::streamoff(slot) * std::streamoff(unitBytes));
+        file.write((const char*)data, unitBytes);
+        if (!file)
+            CV_Error_(Error::StsError, ("Failed to write volume unit storage: %s", path.c_str()));
+        return slot;
+    }
+
+    void load(int slot, uchar* data)
+    {
+        CV_Assert(slot >= 0 && slot < nSlots);
+        file.seekg(std::streamoff(slot) * std::streamoff(unitBytes));
+        file.read((char*)data, unitBytes);
+        if (!file)
+            CV_Error_(Error::StsError, ("Failed to read volume unit storage: %s", path.c_str()));
+        freeSlots.push_back(slot);
+    }
+
+private:
+    String path;
+    std::fstream file;
+    size_t unitBytes;
+    int nSlots;
+    std::vector<int> freeSlots;
+};
+
 class HashTSDFVolumeCPU : public HashTSDFVolume
 {
 public:
@@ -99,6 +189,11 @@ public:
 
     HashTSDFVolumeCPU(const VolumeParams& _volumeParams, bool zFirstMemOrder = true);
 
+    //! Streams out units unseen for evictFrames frames to a file in the given directory,
+    //! at most maxResidentUnits units are kept in memory (0 means no limit).
+    //! Should be called before anything is integrated.
+    void setStreaming(const String& directory, int evictFrames, size_t maxResidentUnits);
+
     virtual void integrate(InputArray, InputArray, float, const Matx44f&, const kinfu::Intr&, const Intr&, const int) override
         { CV_Error(Error::StsNotImplemented, "Not implemented"); };
     void integrate(InputArray _depth, float depthFactor, const Matx44f& cameraPose, const kinfu::Intr& intrinsics,
@@ -109,6 +204,7 @@ public:
         { CV_Error(Error::StsNotImplemented, "Not implemented"); };
     void fetchNormals(InputArray points, OutputArray _normals) const override;
     void fetchPointsNormals(OutputArray points, OutputArray normals) const override;
+    void fetchMesh(OutputArray vertices, OutputArray normals) const override;
 
     void reset() override;
     size_t getTotalVolumeUnits() const override { return volumeUnits.size(); }
@@ -136,19 +232,46 @@ public:
     Point3f voxelCoordToVolume(const Vec3i& voxelIdx) const;
     Vec3i volumeToVoxelCoord(const Point3f& point) const;
 
+    //! Streaming of volume units, paging doesn't change the contents of the volume
+    int allocateVolumeUnitRow();
+    void storeVolumeUnit(VolumeUnit& vu);
+    void loadVolumeUnit(VolumeUnit& vu);
+    void evictVolumeUnits(int frameId);
+    void loadVolumeUnitsInFrustum(const Matx44f& cameraPose, const Intr& intrinsics, const Size& frameSize);
+    void loadVolumeUnitsAround(const std::vector<Point3f>& points);
+    void loadAllVolumeUnits();
+
+    //! Runs marching cubes over the cubes whose lowest corner is in the unit,
+    //! returns false if the unit is streamed out and can't be meshed now
+    bool marchCubesVolumeUnit(const Vec3i& volumeUnitIdx, VolumeUnitMesh& mesh, bool withNormals) const;
+
 public:
     Vec6f frameParams;
     Mat pixNorms;
     VolumeUnitIndexes volumeUnits;
     cv::Mat volUnitsData;
     int lastVolIndex;
+    //! rows of volUnitsData released by streamed out units
+    std::vector<int> freeRows;
+
+    String streamingPath;
+    int streamingEvictFrames;
+    size_t maxResidentUnits;
+    VolumeUnitDiskStorage diskStorage;
+
+    //! Mesh cache, units whose cubes changed since the last fetchMesh() call are dirty
+    mutable VolumeUnitIndexSet meshDirtyUnits;
+    mutable VolumeUnitMeshes meshCache;
+    mutable bool meshCacheHasNormals;
 };
 
 
 HashTSDFVolumeCPU::HashTSDFVolumeCPU(float _voxelSize, const Matx44f& _pose, float _raycastStepFactor, float _truncDist,
                                      int _maxWeight, float _truncateThreshold, int _volumeUnitRes, bool _zFirstMemOrder)
     :HashTSDFVolume(_voxelSize, _pose, _raycastStepFactor, _truncDist, _maxWeight, _truncateThreshold, _volumeUnitRes,
-           _zFirstMemOrder)
+           _zFirstMemOrder),
+    streamingEvictFrames(0),
+    maxResidentUnits(0)
 {
     reset();
 }
@@ -157,6 +280,28 @@ HashTSDFVolumeCPU::HashTSDFVolumeCPU(const VolumeParams& _params, bool _zFirstMe
     : HashTSDFVolumeCPU(_params.voxelSize, _params.pose.matrix, _params.raycastStepFactor, _params.tsdfTruncDist, _params.maxWeight,
            _params.depthTruncThreshold, _params.unitResolution, _zFirstMemOrder)
 {
+    if (!_params.streamingDirectory.empty())
+    {
+        size_t unitBytes = volUnitsData.cols * volUnitsData.elemSize();
+        size_t budgetUnits = size_t(_params.streamingMemoryBudgetMB) * 1024 * 1024 / unitBytes;
+        if (_params.streamingMemoryBudgetMB > 0)
+            budgetUnits = std::max(budgetUnits, size_t(1));
+        setStreaming(_params.streamingDirectory, _params.streamingEvictFrames, budgetUnits);
+    }
+}
+
+void HashTSDFVolumeCPU::setStreaming(const String& directory, int evictFrames, size_t _maxResidentUnits)
+{
+    CV_Assert(volumeUnits.empty());
+    CV_Assert(evictFrames > 0);
+
+    //! Every volume gets its own file, e.g. submaps of LargeKinfu share the directory
+    static std::atomic<int> volumeCounter(0);
+    streamingPath = directory.empty() ? String() :
+        format("%s/hash_tsdf_%lld_%d.units", directory.c_str(), (long long)getTickCount(), volumeCounter++);
+    streamingEvictFrames = evictFrames;
+    maxResidentUnits = _maxResidentUnits;
+    reset();
 }
 
 // zero volume, leave rest params the same
@@ -168,6 +313,137 @@ void HashTSDFVolumeCPU::reset()
     frameParams = Vec6f();
     pixNorms = Mat();
     volumeUnits = VolumeUnitIndexes();
+    freeRows.clear();
+    meshDirtyUnits.clear();
+    meshCache.clear();
+    meshCacheHasNormals = false;
+    if (!streamingPath.empty())
+        diskStorage.open(streamingPath, volUnitsData.cols * volUnitsData.elemSize());
+}
+
+int HashTSDFVolumeCPU::allocateVolumeUnitRow()
+{
+    if (!freeRows.empty())
+    {
+        int row = freeRows.back();
+        freeRows.pop_back();
+        return row;
+    }
+
+    int row = lastVolIndex; lastVolIndex++;
+    if (lastVolIndex > int(volUnitsData.size().height))
+    {
+        volUnitsData.resize((lastVolIndex - 1) * 2);
+    }
+    return row;
+}
+
+void HashTSDFVolumeCPU::storeVolumeUnit(VolumeUnit& vu)
+{
+    CV_DbgAssert(vu.index >= 0);
+    vu.diskSlot = diskStorage.store(volUnitsData.ptr(vu.index));
+    freeRows.push_back(vu.index);
+    vu.index = -1;
+}
+
+void HashTSDFVolumeCPU::loadVolumeUnit(VolumeUnit& vu)
+{
+    CV_DbgAssert(vu.index < 0);
+    vu.index = allocateVolumeUnitRow();
+    diskStorage.load(vu.diskSlot, volUnitsData.ptr(vu.index));
+    vu.diskSlot = -1;
+}
+
+void HashTSDFVolumeCPU::evictVolumeUnits(int frameId)
+{
+    CV_TRACE_FUNCTION();
+
+    std::vector<VolumeUnit*> resident;
+    for (auto& keyvalue : volumeUnits)
+    {
+        VolumeUnit& vu = keyvalue.second;
+        if (vu.index < 0)
+            continue;
+        if (vu.lastVisibleIndex <= frameId - streamingEvictFrames)
+            storeVolumeUnit(vu);
+        else
+            resident.push_back(&vu);
+    }
+
+    if (maxResidentUnits > 0 && resident.size() > maxResidentUnits)
+    {
+        //! Least recently seen units go first, the ones seen in this frame stay even above the budget
+        std::sort(resident.begin(), resident.end(), [](const VolumeUnit* a, const VolumeUnit* b)
+            {
+                return a->lastVisibleIndex < b->lastVisibleIndex;
+            });
+        size_t nEvict = resident.size() - maxResidentUnits;
+        for (size_t i = 0; i < nEvict && resident[i]->lastVisibleIndex < frameId; i++)
+            storeVolumeUnit(*resident[i]);
+    }
+}
+
+void HashTSDFVolumeCPU::loadVolumeUnitsInFrustum(const Matx44f& cameraPose, const Intr& intrinsics, const Size& frameSize)
+{
+    CV_TRACE_FUNCTION();
+
+    const Affine3f vol2cam(Affine3f(cameraPose.inv()) * pose);
+    const Intr::Projector proj(intrinsics.makeProjector());
+    const float halfUnit = 0.5f * volumeUnitSize;
+    //! bounding sphere of a volume unit
+    const float radius = halfUnit * std::sqrt(3.f);
+    const float fmax = std::max(intrinsics.fx, intrinsics.fy);
+
+    for (auto& keyvalue : volumeUnits)
+    {
+        VolumeUnit& vu = keyvalue.second;
+        if (vu.index >= 0)
+            continue;
+
+        Point3f center = vol2cam * (volumeUnitIdxToVolume(keyvalue.first) + Point3f(halfUnit, halfUnit, halfUnit));
+        if (center.z < -radius || center.z > truncateThreshold + radius)
+            continue;
+        if (center.z > radius)
+        {
+            Point2f p = proj(center);
+            float margin = radius * fmax / center.z;
+            if (p.x < -margin || p.y < -margin || p.x >= frameSize.width + margin || p.y >= frameSize.height + margin)
+                continue;
+        }
+        loadVolumeUnit(vu);
+    }
+}
+
+void HashTSDFVolumeCPU::loadVolumeUnitsAround(const std::vector<Point3f>& points)
+{
+    CV_TRACE_FUNCTION();
+
+    //! getNormalVoxel() reads 2 voxels around the point in every direction
+    const Point3f margin(2 * voxelSize, 2 * voxelSize, 2 * voxelSize);
+    for (const Point3f& p : points)
+    {
+        Vec3i lower = volumeToVolumeUnitIdx(p - margin);
+        Vec3i upper = volumeToVolumeUnitIdx(p + margin);
+        for (int i = lower[0]; i <= upper[0]; i++)
+            for (int j = lower[1]; j <= upper[1]; j++)
+                for (int k = lower[2]; k <= upper[2]; k++)
+                {
+                    VolumeUnitIndexes::iterator it = volumeUnits.find(Vec3i(i, j, k));
+                    if (it != volumeUnits.end() && it->second.index < 0)
+                        loadVolumeUnit(it->second);
+                }
+    }
+}
+
+void HashTSDFVolumeCPU::loadAllVolumeUnits()
+{
+    CV_TRACE_FUNCTION();
+
+    for (auto& keyvalue : volumeUnits)
+    {
+        if (keyvalue.second.index < 0)
+            loadVolumeUnit(keyvalue.second);
+    }
 }
 
 void HashTSDFVolumeCPU::integrate(InputArray _depth, float depthFactor, const Matx44f& cameraPose, const Intr& intrinsics, const int frameId)
@@ -239,11 +515,7 @@ void HashTSDFVolumeCPU::integrate(InputArray _depth, float depthFactor, const Ma
         Matx44f subvolumePose = pose.translate(volumeUnitIdxToVolume(idx)).matrix;
 
         vu.pose = subvolumePose;
-        vu.index = lastVolIndex; lastVolIndex++;
-        if (lastVolIndex > int(volUnitsData.size().height))
-        {
-            volUnitsData.resize((lastVolIndex - 1) * 2);
-        }
+        vu.index = allocateVolumeUnitRow();
         volUnitsData.row(vu.index).forEach<VecTsdfVoxel>([](VecTsdfVoxel& vv, const int* /* position */)
             {
                 TsdfVoxel& v = reinterpret_cast<TsdfVoxel&>(vv);
@@ -291,6 +563,29 @@ void HashTSDFVolumeCPU::integrate(InputArray _depth, float depthFactor, const Ma
         }
         });
 
+    //! Bring back streamed out units which are going to be integrated
+    if (diskStorage.isOpen())
+    {
+        for (auto& keyvalue : volumeUnits)
+        {
+            VolumeUnit& vu = keyvalue.second;
+            if (vu.isActive && vu.index < 0)
+                loadVolumeUnit(vu);
+        }
+    }
+
+    //! Cubes of the lower neighbours end in the integrated units and normals of all neighbours
+    //! are computed across the borders, so they need re-meshing too
+    for (const auto& keyvalue : volumeUnits)
+    {
+        if (!keyvalue.second.isActive)
+            continue;
+        for (int i = -1; i <= 1; i++)
+            for (int j = -1; j <= 1; j++)
+                for (int k = -1; k <= 1; k++)
+                    meshDirtyUnits.insert(keyvalue.first + Vec3i(i, j, k));
+    }
+
     Vec6f newParams((float)depth.rows, (float)depth.cols,
         intrinsics.fx, intrinsics.fy,
         intrinsics.cx, intrinsics.cy);
@@ -322,6 +617,9 @@ void HashTSDFVolumeCPU::integrate(InputArray _depth, float depthFactor, const Ma
             }
         }
         });
+
+    if (diskStorage.isOpen())
+        evictVolumeUnits(frameId);
 }
 
 cv::Vec3i HashTSDFVolumeCPU::volumeToVolumeUnitIdx(const cv::Point3f& p) const
@@ -356,6 +654,11 @@ inline TsdfVoxel HashTSDFVolumeCPU::_at(const cv::Vec3i& volumeIdx, int indx) co
     {
         return TsdfVoxel(floatToTsdf(1.f), 0);
     }
+    //! Streamed out units look unallocated
+    if (indx < 0)
+    {
+        return TsdfVoxel(floatToTsdf(1.f), 0);
+    }
 
     const TsdfVoxel* volData = volUnitsData.ptr<TsdfVoxel>(indx);
     int coordBase =
@@ -405,7 +708,7 @@ TsdfVoxel HashTSDFVolumeCPU::at(const Point3f& point) const
 
 TsdfVoxel HashTSDFVolumeCPU::atVolumeUnit(const Vec3i& point, const Vec3i& volumeUnitIdx, VolumeUnitIndexes::const_iterator it) const
 {
-    if (it == volumeUnits.end())
+    if (it == volumeUnits.end() || it->second.index < 0)
     {
         return TsdfVoxel(floatToTsdf(1.f), 0);
     }
@@ -647,6 +950,9 @@ void HashTSDFVolumeCPU::raycast(const Matx44f& cameraPose, const kinfu::Intr& in
     CV_TRACE_FUNCTION();
     CV_Assert(frameSize.area() > 0);
 
+    if (diskStorage.isOpen())
+        const_cast<HashTSDFVolumeCPU*>(this)->loadVolumeUnitsInFrustum(cameraPose, intrinsics, frameSize);
+
     _points.create(frameSize, POINT_TYPE);
     _normals.create(frameSize, POINT_TYPE);
 
@@ -710,7 +1016,7 @@ void HashTSDFVolumeCPU::raycast(const Matx44f& cameraPose, const kinfu::Intr& in
 
 
                     //! The subvolume exists in hashtable
-                    if (it != volume.volumeUnits.end())
+                    if (it != volume.volumeUnits.end() && it->second.index >= 0)
                     {
                         cv::Point3f currVolUnitPos =
                             volume.volumeUnitIdxToVolume(currVolumeUnitIdx);
@@ -759,6 +1065,10 @@ void HashTSDFVolumeCPU::fetchPointsNormals(OutputArray _points, OutputArray _nor
 
     if (_points.needed())
     {
+        //! The whole volume is read back, the next integrate() streams it out again
+        if (diskStorage.isOpen())
+            const_cast<HashTSDFVolumeCPU*>(this)->loadAllVolumeUnits();
+
         std::vector<std::vector<ptype>> pVecs, nVecs;
 
         std::vector<Vec3i> totalVolUnits;
@@ -843,6 +1153,20 @@ void HashTSDFVolumeCPU::fetchNormals(InputArray _points, OutputArray _normals) c
         Points points = _points.getMat();
         CV_Assert(points.type() == POINT_TYPE);
 
+        if (diskStorage.isOpen())
+        {
+            Affine3f invPose(pose.inv());
+            std::vector<Point3f> volPoints;
+            for (int y = 0; y < points.rows; y++)
+                for (int x = 0; x < points.cols; x++)
+                {
+                    Point3f p = fromPtype(points(y, x));
+                    if (!isNaN(p))
+                        volPoints.push_back(invPose * p);
+                }
+            const_cast<HashTSDFVolumeCPU*>(this)->loadVolumeUnitsAround(volPoints);
+        }
+
         _normals.createSameSize(_points, _points.type());
         Normals normals = _normals.getMat();
 
@@ -863,6 +1187,153 @@ void HashTSDFVolumeCPU::fetchNormals(InputArray _points, OutputArray _normals) c
     }
 }
 
+bool HashTSDFVolumeCPU::marchCubesVolumeUnit(const Vec3i& volumeUnitIdx, VolumeUnitMesh& mesh, bool withNormals) const
+{
+    VolumeUnitIndexes::const_iterator it = volumeUnits.find(volumeUnitIdx);
+    if (it == volumeUnits.end())
+        return true;
+    if (it->second.index < 0)
+        return false;
+
+    static const Vec3i mcNeighbourPts[8] = { {0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0},
+                                             {1, 0, 0}, {1, 0, 1}, {1, 1, 1}, {1, 1, 0} };
+    static const int mcEdgeCorners[12][2] = { {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6},
+                                              {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7} };
+
+    //! Voxels of the unit and the first layer of its upper neighbours
+    const int res = volumeUnitResolution;
+    const int side = res + 1;
+    const TsdfVoxel emptyVoxel(floatToTsdf(1.f), 0);
+    const TsdfVoxel* neighbourData[8];
+    for (int i = 0; i < 8; i++)
+    {
+        VolumeUnitIndexes::const_iterator nit =
+            volumeUnits.find(volumeUnitIdx + Vec3i((i >> 2) & 1, (i >> 1) & 1, i & 1));
+        neighbourData[i] = (nit == volumeUnits.end() || nit->second.index < 0) ? nullptr :
+                           volUnitsData.ptr<TsdfVoxel>(nit->second.index);
+    }
+
+    AutoBuffer<TsdfVoxel> blockBuf(side * side * side);
+    TsdfVoxel* block = blockBuf.data();
+    for (int x = 0; x < side; x++)
+        for (int y = 0; y < side; y++)
+            for (int z = 0; z < side; z++)
+            {
+                int n = (x == res) * 4 + (y == res) * 2 + (z == res);
+                const TsdfVoxel* data = neighbourData[n];
+                int coordBase = (x % res) * volStrides[0] + (y % res) * volStrides[1] + (z % res) * volStrides[2];
+                block[(x * side + y) * side + z] = data ? data[coordBase] : emptyVoxel;
+            }
+
+    const Vec3i unitBase = volumeUnitIdx * res;
+    const Matx33f rot = pose.rotation();
+    for (int x = 0; x < res; x++)
+        for (int y = 0; y < res; y++)
+            for (int z = 0; z < res; z++)
+            {
+                int cubeIndex = 0;
+                float tsdfValues[8];
+                bool observed = true;
+                for (int i = 0; i < 8 && observed; i++)
+                {
+                    const Vec3i& c = mcNeighbourPts[i];
+                    const TsdfVoxel& v = block[((x + c[0]) * side + (y + c[1])) * side + z + c[2]];
+                    observed = v.weight != 0;
+                    tsdfValues[i] = tsdfToFloat(v.tsdf);
+                    if (tsdfValues[i] <= 0)
+                        cubeIndex |= (1 << i);
+                }
+                if (!observed || dynafu::edgeTable[cubeIndex] == 0)
+                    continue;
+
+                Point3f basePt = Point3f(Vec3f(unitBase + Vec3i(x, y, z)));
+                Point3f vertices[12];
+                for (int e = 0; e < 12; e++)
+                {
+                    if (!(dynafu::edgeTable[cubeIndex] & (1 << e)))
+                        continue;
+                    int c1 = mcEdgeCorners[e][0], c2 = mcEdgeCorners[e][1];
+                    float v1 = tsdfValues[c1], v2 = tsdfValues[c2];
+                    float dV = 0.5f;
+                    if (abs(v1 - v2) > 0.0001f)
+                        dV = v1 / (v1 - v2);
+                    Point3f p1 = Point3f(Vec3f(mcNeighbourPts[c1])), p2 = Point3f(Vec3f(mcNeighbourPts[c2]));
+                    vertices[e] = (basePt + p1 + dV * (p2 - p1)) * voxelSize;
+                }
+
+                for (int i = 0; dynafu::triTable[cubeIndex][i] != -1; i++)
+                {
+                    const Point3f& p = vertices[dynafu::triTable[cubeIndex][i]];
+                    mesh.vertices.push_back(toPtype(pose * p));
+                    if (withNormals)
+                    {
+                        Point3f n = getNormalVoxel(p);
+                        mesh.normals.push_back(toPtype(isNaN(n) ? n : rot * n));
+                    }
+                }
+            }
+    return true;
+}
+
+void HashTSDFVolumeCPU::fetchMesh(OutputArray _vertices, OutputArray _normals) const
+{
+    CV_TRACE_FUNCTION();
+
+    //! Cached meshes have no normals, all of them are to be redone
+    if (_normals.needed() && !meshCacheHasNormals)
+    {
+        for (const auto& keyvalue : volumeUnits)
+            meshDirtyUnits.insert(keyvalue.first);
+        meshCacheHasNormals = true;
+    }
+    const bool withNormals = meshCacheHasNormals;
+
+    std::vector<Vec3i> dirtyUnits(meshDirtyUnits.begin(), meshDirtyUnits.end());
+    std::vector<VolumeUnitMesh> meshes(dirtyUnits.size());
+    std::vector<uchar> meshed(dirtyUnits.size(), 0);
+    parallel_for_(Range(0, (int)dirtyUnits.size()), [&](const Range& range)
+        {
+            for (int i = range.start; i < range.end; i++)
+                meshed[i] = marchCubesVolumeUnit(dirtyUnits[i], meshes[i], withNormals);
+        });
+
+    for (size_t i = 0; i < dirtyUnits.size(); i++)
+    {
+        //! Streamed out units keep their previous mesh and stay dirty
+        if (!meshed[i])
+            continue;
+        if (meshes[i].vertices.empty())
+            meshCache.erase(dirtyUnits[i]);
+        else
+            meshCache[dirtyUnits[i]] = std::move(meshes[i]);
+        meshDirtyUnits.erase(dirtyUnits[i]);
+    }
+
+    size_t nVertices = 0;
+    for (const auto& keyvalue : meshCache)
+        nVertices += keyvalue.second.vertices.size();
+
+    _vertices.create((int)nVertices, 1, POINT_TYPE);
+    if (_normals.needed())
+        _normals.create((int)nVertices, 1, POINT_TYPE);
+    if (nVertices == 0)
+        return;
+
+    Mat vertices = _vertices.getMat(), normals;
+    if (_normals.needed())
+        normals = _normals.getMat();
+    int offset = 0;
+    for (const auto& keyvalue : meshCache)
+    {
+        const VolumeUnitMesh& mesh = keyvalue.second;
+        int n = (int)mesh.vertices.size();
+        Mat(n, 1, POINT_TYPE, (void*)mesh.vertices.data()).copyTo(vertices.rowRange(offset, offset + n));
+        if (!normals.empty())
+            Mat(n, 1, POINT_TYPE, (void*)mesh.normals.data()).copyTo(normals.rowRange(offset, offset + n));
+        offset += n;
+    }
+}
+
 int HashTSDFVolumeCPU::getVisibleBlocks(int currFrameId, int frameThreshold) const
 {
     int numVisibleBlocks = 0;
@@ -1769,9 +2240,346 @@ int HashTSDFVolumeGPU::getVisibleBlocks(int currFrameId, int frameThreshold) con
 
 #endif
 
+///////// CUDA implementation /////////
+
+#ifdef HAVE_CUDA
+
+//! Keeps the whole volume on the device: the hash table of volume units, their voxels
+//! and the visibility data. Only a few counters are read back per frame.
+class HashTSDFVolumeCUDA : public HashTSDFVolume
+{
+public:
+    HashTSDFVolumeCUDA(float _voxelSize, const Matx44f& _pose, float _raycastStepFactor, float _truncDist, int _maxWeight,
+        float _truncateThreshold, int _volumeUnitRes, bool zFirstMemOrder = false);
+
+    HashTSDFVolumeCUDA(const VolumeParams& _volumeParams, bool zFirstMemOrder = false);
+
+    void reset() override;
+
+    virtual void integrate(InputArray, InputArray, float, const Matx44f&, const kinfu::Intr&, const Intr&, const int) override
+        { CV_Error(Error::StsNotImplemented, "Not implemented"); };
+    void integrate(InputArray _depth, float depthFactor, const Matx44f& cameraPose, const kinfu::Intr& intrinsics,
+        const int frameId = 0) override;
+    void raycast(const Matx44f& cameraPose, const kinfu::Intr& intrinsics, const Size& frameSize, OutputArray points,
+        OutputArray normals) const override;
+    void raycast(const Matx44f&, const kinfu::Intr&, const Size&, OutputArray, OutputArray, OutputArray) const override
+        { CV_Error(Error::StsNotImplemented, "Not implemented"); };
+
+    void fetchNormals(InputArray points, OutputArray _normals) const override;
+    void fetchPointsNormals(OutputArray points, OutputArray normals) const override;
+
+    size_t getTotalVolumeUnits() const override { return size_t(lastVolIndex); }
+    int getVisibleBlocks(int currFrameId, int frameThreshold) const override;
+
+private:
+    //! Reallocates per-unit storage keeping the first lastVolIndex units, rebuilds the hash table
+    void growStorage(int newUnitCapacity);
+
+    cuda::HashTSDFDeviceData deviceData() const;
+    cuda::HashTSDFDeviceParams deviceParams() const;
+
+public:
+    int unitCapacity;
+    int lastVolIndex;
+
+    // hash table, 4 slots per volume unit
+    cv::cuda::GpuMat hashKeys;
+    cv::cuda::GpuMat hashValues;
+
+    // per-volume-unit data
+    cv::cuda::GpuMat unitCoords;
+    cv::cuda::GpuMat lastVisibleIndices;
+    cv::cuda::GpuMat activeUnits;
+    cv::cuda::GpuMat volUnitsData;
+
+    cv::cuda::GpuMat counters;
+
+    mutable cv::cuda::GpuMat depthBuf, pointsBuf, normalsBuf;
+};
+
+static cuda::DeviceAffine toDeviceAffine(const Affine3f& a)
+{
+    cuda::DeviceAffine d;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 4; j++)
+            d.m[i * 4 + j] = a.matrix(i, j);
+    return d;
+}
+
+static cuda::DeviceIntrinsics toDeviceIntrinsics(const Intr& intrinsics)
+{
+    cuda::DeviceIntrinsics d = { intrinsics.fx, intrinsics.fy, intrinsics.cx, intrinsics.cy };
+    return d;
+}
+
+HashTSDFVolumeCUDA::HashTSDFVolumeCUDA(float _voxelSize, const Matx44f& _pose, float _raycastStepFactor, float _truncDist, int _maxWeight,
+    float _truncateThreshold, int _volumeUnitRes, bool _zFirstMemOrder)
+    :HashTSDFVolume(_voxelSize, _pose, _raycastStepFactor, _truncDist, _maxWeight, _truncateThreshold, _volumeUnitRes, _zFirstMemOrder)
+{
+    reset();
+}
+
+HashTSDFVolumeCUDA::HashTSDFVolumeCUDA(const VolumeParams & _params, bool _zFirstMemOrder)
+    : HashTSDFVolumeCUDA(_params.voxelSize, _params.pose.matrix, _params.raycastStepFactor, _params.tsdfTruncDist, _params.maxWeight,
+                         _params.depthTruncThreshold, _params.unitResolution, _zFirstMemOrder)
+{
+}
+
+// zero volume, leave rest params the same
+void HashTSDFVolumeCUDA::reset()
+{
+    CV_TRACE_FUNCTION();
+
+    unitCapacity = 0;
+    lastVolIndex = 0;
+    unitCoords.release();
+    lastVisibleIndices.release();
+    volUnitsData.release();
+
+    growStorage(VOLUMES_SIZE);
+}
+
+void HashTSDFVolumeCUDA::growStorage(int newUnitCapacity)
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(newUnitCapacity >= lastVolIndex);
+
+    const int volCubed = volumeUnitResolution * volumeUnitResolution * volumeUnitResolution;
+    cv::cuda::GpuMat newCoords(1, newUnitCapacity, CV_32SC3);
+    cv::cuda::GpuMat newVisible(1, newUnitCapacity, CV_32S);
+    cv::cuda::GpuMat newData(newUnitCapacity, volCubed, CV_8UC2);
+    if (lastVolIndex > 0)
+    {
+        cv::cuda::GpuMat dstCoords = newCoords.colRange(0, lastVolIndex);
+        cv::cuda::GpuMat dstVisible = newVisible.colRange(0, lastVolIndex);
+        cv::cuda::GpuMat dstData = newData.rowRange(0, lastVolIndex);
+        unitCoords.colRange(0, lastVolIndex).copyTo(dstCoords);
+        lastVisibleIndices.colRange(0, lastVolIndex).copyTo(dstVisible);
+        volUnitsData.rowRange(0, lastVolIndex).copyTo(dstData);
+    }
+    unitCoords = newCoords;
+    lastVisibleIndices = newVisible;
+    volUnitsData = newData;
+    activeUnits.create(1, newUnitCapacity, CV_32S);
+    unitCapacity = newUnitCapacity;
+
+    // power of 2 for masking, keeps the load factor under 1/4
+    hashKeys.create(1, 4 * newUnitCapacity, CV_32SC2);
+    hashValues.create(1, 4 * newUnitCapacity, CV_32S);
+    CV_Assert(!(hashKeys.cols & (hashKeys.cols - 1)));
+    cuda::rebuildHashTable(deviceData(), lastVolIndex);
+
+    Mat hostCounters = Mat::zeros(1, cuda::NUM_COUNTERS, CV_32S);
+    hostCounters.at<int>(cuda::COUNTER_UNITS) = lastVolIndex;
+    counters.upload(hostCounters);
+}
+
+cuda::HashTSDFDeviceData HashTSDFVolumeCUDA::deviceData() const
+{
+    cuda::HashTSDFDeviceData d;
+    d.keys = (unsigned long long*)hashKeys.data;
+    d.values = (int*)hashValues.data;
+    d.hashMask = hashKeys.cols - 1;
+    d.unitCapacity = unitCapacity;
+    d.unitCoords = (int*)unitCoords.data;
+    d.lastVisibleIndices = (int*)lastVisibleIndices.data;
+    d.activeUnits = (int*)activeUnits.data;
+    d.voxels = cv::cuda::PtrStepb(volUnitsData.data, volUnitsData.step);
+    d.counters = (int*)counters.data;
+    return d;
+}
+
+cuda::HashTSDFDeviceParams HashTSDFVolumeCUDA::deviceParams() const
+{
+    cuda::HashTSDFDeviceParams p;
+    p.voxelSize = voxelSize;
+    p.voxelSizeInv = voxelSizeInv;
+    p.volumeUnitSize = volumeUnitSize;
+    p.truncDist = truncDist;
+    p.truncateThreshold = truncateThreshold;
+    p.raycastStep = truncDist * raycastStepFactor;
+    p.maxWeight = maxWeight;
+    p.unitResolution = volumeUnitResolution;
+    p.unitDegree = volumeUnitDegree;
+    for (int i = 0; i < 3; i++)
+        p.volStrides[i] = volStrides[i];
+    p.emptyTsdf = floatToTsdf(0.0f);
+    return p;
+}
+
+void HashTSDFVolumeCUDA::integrate(InputArray _depth, float depthFactor, const Matx44f& cameraPose, const Intr& intrinsics,
+                                   const int frameId)
+{
+    CV_TRACE_FUNCTION();
+
+    CV_Assert(_depth.type() == DEPTH_TYPE);
+    if (_depth.isGpuMat())
+        depthBuf = _depth.getGpuMat();
+    else
+        depthBuf.upload(_depth);
+    CV_Assert(!depthBuf.empty());
+
+    const float invDepthFactor = 1.f / depthFactor;
+    const Affine3f cam2vol(pose.inv() * Affine3f(cameraPose));
+    const Affine3f vol2cam(Affine3f(cameraPose.inv()) * pose);
+    const Affine3f camInv(Affine3f(cameraPose).inv());
+    const cuda::DeviceIntrinsics intr = toDeviceIntrinsics(intrinsics);
+    const cuda::HashTSDFDeviceParams params = deviceParams();
+
+    //! Allocate the units touched by the truncation band, growing the storage on overflow.
+    //! Units inserted before the overflow stay in the table and are found on the next pass.
+    const int firstNewUnit = lastVolIndex;
+    Mat hostCounters;
+    for (;;)
+    {
+        cuda::allocateVolumeUnits(deviceData(), params, depthBuf, invDepthFactor, toDeviceAffine(cam2vol), intr);
+        counters.download(hostCounters);
+        const int* c = hostCounters.ptr<int>();
+        if (!c[cuda::COUNTER_OVERFLOW])
+        {
+            lastVolIndex = c[cuda::COUNTER_UNITS];
+            break;
+        }
+        lastVolIndex = std::min(c[cuda::COUNTER_UNITS], unitCapacity);
+        growStorage(unitCapacity * 2);
+    }
+
+    cuda::initVolumeUnits(deviceData(), params, firstNewUnit, lastVolIndex, frameId);
+
+    //! Mark the new units and the ones seen by the camera, integrate only those
+    cuda::markActive(deviceData(), params, toDeviceAffine(vol2cam), intr, depthBuf.cols, depthBuf.rows,
+                     lastVolIndex, firstNewUnit, frameId);
+    counters.download(hostCounters);
+    const int nActive = hostCounters.at<int>(cuda::COUNTER_ACTIVE);
+
+    cuda::integrateActiveUnits(deviceData(), params, depthBuf, invDepthFactor,
+                               toDeviceAffine(vol2cam), toDeviceAffine(camInv), intr, nActive);
+}
+
+void HashTSDFVolumeCUDA::raycast(const Matx44f& cameraPose, const kinfu::Intr& intrinsics, const Size& frameSize,
+                                 OutputArray _points, OutputArray _normals) const
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(frameSize.area() > 0);
+
+    const Affine3f cam2vol(pose.inv() * Affine3f(cameraPose));
+    const Affine3f vol2cam(Affine3f(cameraPose.inv()) * pose);
+
+    //! GpuMat outputs are filled in place, otherwise the results are downloaded
+    const bool onDevice = _points.isGpuMat() && _normals.isGpuMat();
+    if (onDevice)
+    {
+        _points.create(frameSize, POINT_TYPE);
+        _normals.create(frameSize, POINT_TYPE);
+        pointsBuf = _points.getGpuMat();
+        normalsBuf = _normals.getGpuMat();
+    }
+    else
+    {
+        pointsBuf.create(frameSize, POINT_TYPE);
+        normalsBuf.create(frameSize, POINT_TYPE);
+    }
+
+    cuda::raycast(deviceData(), deviceParams(), toDeviceAffine(cam2vol), toDeviceAffine(vol2cam),
+                  toDeviceIntrinsics(intrinsics), pointsBuf, normalsBuf);
+
+    if (!onDevice)
+    {
+        pointsBuf.download(_points);
+        normalsBuf.download(_normals);
+    }
+}
+
+void HashTSDFVolumeCUDA::fetchNormals(InputArray _points, OutputArray _normals) const
+{
+    CV_TRACE_FUNCTION();
+
+    if (_normals.needed())
+    {
+        CV_Assert(_points.type() == POINT_TYPE);
+        if (_points.isGpuMat())
+            pointsBuf = _points.getGpuMat();
+        else
+            pointsBuf.upload(_points);
+        normalsBuf.create(pointsBuf.size(), POINT_TYPE);
+
+        cuda::fetchNormals(deviceData(), deviceParams(), toDeviceAffine(pose.inv()), toDeviceAffine(pose),
+                           pointsBuf, normalsBuf);
+
+        normalsBuf.download(_normals);
+    }
+}
+
+void HashTSDFVolumeCUDA::fetchPointsNormals(OutputArray _points, OutputArray _normals) const
+{
+    CV_TRACE_FUNCTION();
+
+    if (_points.needed())
+    {
+        const cuda::HashTSDFDeviceParams params = deviceParams();
+        const int nPoints = cuda::fetchPointsNormals(deviceData(), params, lastVolIndex, nullptr, nullptr, 0);
+
+        _points.create(nPoints, 1, POINT_TYPE);
+        if (_normals.needed())
+            _normals.create(nPoints, 1, POINT_TYPE);
+        if (nPoints == 0)
+            return;
+
+        pointsBuf.create(1, nPoints, POINT_TYPE);
+        if (_normals.needed())
+            normalsBuf.create(1, nPoints, POINT_TYPE);
+        cuda::fetchPointsNormals(deviceData(), params, lastVolIndex, pointsBuf.ptr<float4>(),
+                                 _normals.needed() ? normalsBuf.ptr<float4>() : nullptr, nPoints);
+
+        Mat hostPoints;
+        pointsBuf.download(hostPoints);
+        hostPoints.reshape(0, nPoints).copyTo(_points);
+        if (_normals.needed())
+        {
+            Mat hostNormals;
+            normalsBuf.download(hostNormals);
+            hostNormals.reshape(0, nPoints).copyTo(_normals);
+        }
+    }
+}
+
+int HashTSDFVolumeCUDA::getVisibleBlocks(int currFrameId, int frameThreshold) const
+{
+    if (lastVolIndex == 0)
+        return 0;
+
+    Mat cpuIndices;
+    lastVisibleIndices.colRange(0, lastVolIndex).download(cpuIndices);
+
+    int numVisibleBlocks = 0;
+    for (int i = 0; i < lastVolIndex; i++)
+    {
+        if (cpuIndices.at<int>(i) > (currFrameId - frameThreshold))
+            numVisibleBlocks++;
+    }
+    return numVisibleBlocks;
+}
+
+//! CUDA backend is used by default when a device is present, OPENCV_RGBD_HASHTSDF_USE_CUDA=0 disables it
+static bool useCUDAHashTSDF()
+{
+    static const bool enabled = utils::getConfigurationParameterBool("OPENCV_RGBD_HASHTSDF_USE_CUDA", true);
+    return enabled && cv::cuda::getCudaEnabledDeviceCount() > 0;
+}
+
+#endif
+
 //template<typename T>
 Ptr<HashTSDFVolume> makeHashTSDFVolume(const VolumeParams& _params)
 {
+    //! Streaming is implemented on CPU only
+    if (!_params.streamingDirectory.empty())
+        return makePtr<HashTSDFVolumeCPU>(_params);
+#ifdef HAVE_CUDA
+    if (useCUDAHashTSDF())
+        return makePtr<HashTSDFVolumeCUDA>(_params.voxelSize, _params.pose.matrix, _params.raycastStepFactor, _params.tsdfTruncDist, _params.maxWeight,
+            _params.depthTruncThreshold, _params.unitResolution);
+#endif
 #ifdef HAVE_OPENCL
     if (ocl::useOpenCL())
         return makePtr<HashTSDFVolumeGPU>(_params.voxelSize, _params.pose.matrix, _params.raycastStepFactor, _params.tsdfTruncDist, _params.maxWeight,
@@ -1785,6 +2593,11 @@ Ptr<HashTSDFVolume> makeHashTSDFVolume(const VolumeParams& _params)
 Ptr<HashTSDFVolume> makeHashTSDFVolume(float _voxelSize, Matx44f _pose, float _raycastStepFactor, float _truncDist,
     int _maxWeight, float truncateThreshold, int volumeUnitResolution)
 {
+#ifdef HAVE_CUDA
+    if (useCUDAHashTSDF())
+        return makePtr<HashTSDFVolumeCUDA>(_voxelSize, _pose, _raycastStepFactor, _truncDist, _maxWeight, truncateThreshold,
+            volumeUnitResolution);
+#endif
 #ifdef HAVE_OPENCL
     if (ocl::useOpenCL())
         return makePtr<HashTSDFVolumeGPU>(_voxelSize, _pose, _raycastStepFactor, _truncDist, _maxWeight, truncateThreshold,
@@ -10,6 +10,10 @@
 #include "hash_tsdf.hpp"
 #include "kinfu_frame.hpp"
 
+#include "opencv2/core/detail/async_promise.hpp"
+#include <future>
+#include <type_traits>
+
 namespace cv {
 namespace kinfu {
 
@@ -55,6 +59,9 @@ Ptr<Params> Params::defaultParams()
     p.pyramidLevels = (int)p.icpIterations.size();
 
     p.tsdf_min_camera_movement = 0.f; //meters, disabled
+    p.tsdf_static_depth_change = 0.01f; //meters
+    p.tsdf_static_changed_ratio = 0.02f;
+    p.tsdf_static_integrate_period = 0; //frames, static frames are not integrated
 
     p.volumeDims = Vec3i::all(512); //number of voxels
 
@@ -142,9 +149,26 @@ public:
 
     bool update(InputArray depth) CV_OVERRIDE;
 
+    AsyncArray updateAsync(InputArray depth) CV_OVERRIDE;
+
+    void getIntegrationStats(int& integrated, int& skipped, int& raycastsReused) const CV_OVERRIDE;
+
     bool updateT(const MatType& depth);
 
 private:
+    void makeFrame(const MatType& _depth, MatType& depth,
+                   std::vector<MatType>& newPoints, std::vector<MatType>& newNormals) const;
+    //! Estimates the pose of the frame and decides if it should be integrated and raycasted
+    bool trackFrame(const MatType& depth, const std::vector<MatType>& newPoints, const std::vector<MatType>& newNormals,
+                    bool& doIntegrate, bool& doRaycast);
+    //! Ratio of pixels which depth differs from the last integrated frame
+    double depthChangeRatio(const MatType& depth) const;
+    //! Integrates the frame and raycasts the model for the next ICP
+    void integrateFrame(const MatType& depth, const std::vector<MatType>& newPoints,
+                        const std::vector<MatType>& newNormals, bool doIntegrate, bool doRaycast);
+    //! Waits until all frames passed to updateAsync() are processed
+    void waitPending() const;
+
     Params params;
 
     cv::Ptr<ICP> icp;
@@ -152,8 +176,17 @@ private:
 
     int frameCounter;
     Matx44f pose;
+    //! pose of the current pyrPoints and pyrNormals
+    Matx44f raycastPose;
     std::vector<MatType> pyrPoints;
     std::vector<MatType> pyrNormals;
+
+    MatType lastIntegratedDepth;
+    int staticFrames;
+    int integratedCounter, skippedCounter, raycastReusedCounter;
+
+    //! Finishes when the last frame from updateAsync() is integrated and raycasted
+    mutable std::shared_future<void> pipelineTail;
 };
 
 
@@ -171,14 +204,40 @@ KinFuImpl<MatType>::KinFuImpl(const Params &_params) :
 template< typename MatType >
 void KinFuImpl<MatType >::reset()
 {
+    waitPending();
     frameCounter = 0;
     pose = Affine3f::Identity().matrix;
+    raycastPose = pose;
+    lastIntegratedDepth.release();
+    staticFrames = 0;
+    integratedCounter = skippedCounter = raycastReusedCounter = 0;
     volume->reset();
 }
 
 template< typename MatType >
 KinFuImpl<MatType>::~KinFuImpl()
-{ }
+{
+    try
+    {
+        waitPending();
+    }
+    catch (const cv::Exception& e)
+    {
+        CV_LOG_ERROR(NULL, "KinFu: " << e.what());
+    }
+}
+
+template< typename MatType >
+void KinFuImpl<MatType>::waitPending() const
+{
+    if (pipelineTail.valid())
+    {
+        std::shared_future<void> tail = pipelineTail;
+        pipelineTail = std::shared_future<void>();
+        // rethrows exceptions from integration
+        tail.get();
+    }
+}
 
 template< typename MatType >
 const Params& KinFuImpl<MatType>::getParams() const
@@ -186,9 +245,19 @@ const Params& KinFuImpl<MatType>::getParams() const
     return params;
 }
 
+template< typename MatType >
+void KinFuImpl<MatType>::getIntegrationStats(int& integrated, int& skipped, int& raycastsReused) const
+{
+    waitPending();
+    integrated = integratedCounter;
+    skipped = skippedCounter;
+    raycastsReused = raycastReusedCounter;
+}
+
 template< typename MatType >
 const Affine3f KinFuImpl<MatType>::getPose() const
 {
+    waitPending();
     return pose;
 }
 
@@ -198,6 +267,8 @@ bool KinFuImpl<Mat>::update(InputArray _depth)
 {
     CV_Assert(!_depth.empty() && _depth.size() == params.frameSize);
 
+    waitPending();
+
     Mat depth;
     if(_depth.isUMat())
     {
@@ -216,6 +287,8 @@ bool KinFuImpl<UMat>::update(InputArray _depth)
 {
     CV_Assert(!_depth.empty() && _depth.size() == params.frameSize);
 
+    waitPending();
+
     UMat depth;
     if(!_depth.isUMat())
     {
@@ -230,18 +303,69 @@ bool KinFuImpl<UMat>::update(InputArray _depth)
 
 
 template< typename MatType >
-bool KinFuImpl<MatType>::updateT(const MatType& _depth)
+AsyncArray KinFuImpl<MatType>::updateAsync(InputArray _depth)
+{
+    CV_TRACE_FUNCTION();
+
+    CV_Assert(!_depth.empty() && _depth.size() == params.frameSize);
+
+    // the caller may reuse its buffer
+    MatType depthCopy;
+    _depth.copyTo(depthCopy);
+
+    AsyncPromise promise;
+    AsyncArray result = promise.getArrayResult();
+
+    std::shared_future<void> prev = pipelineTail;
+    pipelineTail = std::async(std::launch::async, [this, depthCopy, prev, promise]() mutable
+    {
+        MatType depth;
+        std::vector<MatType> newPoints, newNormals;
+        bool doIntegrate = false, doRaycast = false;
+        try
+        {
+            // runs concurrently with the integration and raycast of the previous frame
+            makeFrame(depthCopy, depth, newPoints, newNormals);
+
+            if (prev.valid())
+                prev.get();
+
+            if (!trackFrame(depth, newPoints, newNormals, doIntegrate, doRaycast))
+            {
+                promise.setValue(Mat());
+                return;
+            }
+            promise.setValue(Mat(pose));
+        }
+        catch (const cv::Exception& e)
+        {
+            promise.setException(e);
+            return;
+        }
+
+        integrateFrame(depth, newPoints, newNormals, doIntegrate, doRaycast);
+#ifdef HAVE_OPENCL
+        // next frame is tracked on another thread with its own OpenCL queue
+        if (std::is_same<MatType, UMat>::value)
+            cv::ocl::finish();
+#endif
+    }).share();
+
+    return result;
+}
+
+
+template< typename MatType >
+void KinFuImpl<MatType>::makeFrame(const MatType& _depth, MatType& depth,
+                                   std::vector<MatType>& newPoints, std::vector<MatType>& newNormals) const
 {
     CV_TRACE_FUNCTION();
 
-    MatType depth;
     if(_depth.type() != DEPTH_TYPE)
         _depth.convertTo(depth, DEPTH_TYPE);
     else
         depth = _depth;
 
-
-    std::vector<MatType> newPoints, newNormals;
     makeFrameFromDepth(depth, newPoints, newNormals, params.intr,
                        params.pyramidLevels,
                        params.depthFactor,
@@ -249,38 +373,124 @@ bool KinFuImpl<MatType>::updateT(const MatType& _depth)
                        params.bilateral_sigma_spatial,
                        params.bilateral_kernel_size,
                        params.truncateThreshold);
+}
+
+
+template< typename MatType >
+double KinFuImpl<MatType>::depthChangeRatio(const MatType& depth) const
+{
+    CV_TRACE_FUNCTION();
+
+    MatType diff, changed;
+    absdiff(depth, lastIntegratedDepth, diff);
+    compare(diff, params.tsdf_static_depth_change * params.depthFactor, changed, CMP_GT);
+    return (double)countNonZero(changed) / changed.total();
+}
+
+
+template< typename MatType >
+bool KinFuImpl<MatType>::trackFrame(const MatType& depth, const std::vector<MatType>& newPoints,
+                                    const std::vector<MatType>& newNormals, bool& doIntegrate, bool& doRaycast)
+{
+    CV_TRACE_FUNCTION();
+
     if(frameCounter == 0)
+    {
+        doIntegrate = doRaycast = true;
+        return true;
+    }
+
+    // ICP gives the transform from the pose of the last raycast
+    Affine3f affine;
+    bool success = icp->estimateTransform(affine, pyrPoints, pyrNormals, newPoints, newNormals);
+    if(!success)
+        return false;
+
+    pose = (Affine3f(raycastPose) * affine).matrix;
+
+    float rnorm = (float)cv::norm(affine.rvec());
+    float tnorm = (float)cv::norm(affine.translation());
+    bool isStatic = ((rnorm + tnorm)/2 < params.tsdf_min_camera_movement);
+    // a static camera may still observe moving objects
+    if(isStatic && params.tsdf_static_depth_change > 0 && !lastIntegratedDepth.empty())
+    {
+        isStatic = (depthChangeRatio(depth) <= params.tsdf_static_changed_ratio);
+    }
+
+    if(isStatic)
+    {
+        staticFrames++;
+        int period = params.tsdf_static_integrate_period;
+        doIntegrate = (period > 0 && staticFrames >= period);
+    }
+    else
+    {
+        doIntegrate = true;
+    }
+    // the model and the pose are the same, so is the raycast
+    doRaycast = doIntegrate || !isStatic;
+    return true;
+}
+
+
+template< typename MatType >
+void KinFuImpl<MatType>::integrateFrame(const MatType& depth, const std::vector<MatType>& newPoints,
+                                        const std::vector<MatType>& newNormals, bool doIntegrate, bool doRaycast)
+{
+    CV_TRACE_FUNCTION();
+
+    if(doIntegrate)
     {
         // use depth instead of distance
         volume->integrate(depth, params.depthFactor, pose, params.intr);
-        pyrPoints  = newPoints;
-        pyrNormals = newNormals;
+        integratedCounter++;
+        staticFrames = 0;
+        if(params.tsdf_min_camera_movement > 0 && params.tsdf_static_depth_change > 0)
+            depth.copyTo(lastIntegratedDepth);
     }
     else
     {
-        Affine3f affine;
-        bool success = icp->estimateTransform(affine, pyrPoints, pyrNormals, newPoints, newNormals);
-        if(!success)
-            return false;
-
-        pose = (Affine3f(pose) * affine).matrix;
+        skippedCounter++;
+    }
 
-        float rnorm = (float)cv::norm(affine.rvec());
-        float tnorm = (float)cv::norm(affine.translation());
-        // We do not integrate volume if camera does not move
-        if((rnorm + tnorm)/2 >= params.tsdf_min_camera_movement)
-        {
-            // use depth instead of distance
-            volume->integrate(depth, params.depthFactor, pose, params.intr);
-        }
+    if(frameCounter == 0)
+    {
+        pyrPoints  = newPoints;
+        pyrNormals = newNormals;
+        raycastPose = pose;
+    }
+    else if(doRaycast)
+    {
         MatType& points  = pyrPoints [0];
         MatType& normals = pyrNormals[0];
         volume->raycast(pose, params.intr, params.frameSize, points, normals);
         buildPyramidPointsNormals(points, normals, pyrPoints, pyrNormals,
                                   params.pyramidLevels);
+        raycastPose = pose;
+    }
+    else
+    {
+        raycastReusedCounter++;
     }
 
     frameCounter++;
+}
+
+
+template< typename MatType >
+bool KinFuImpl<MatType>::updateT(const MatType& _depth)
+{
+    CV_TRACE_FUNCTION();
+
+    MatType depth;
+    std::vector<MatType> newPoints, newNormals;
+    makeFrame(_depth, depth, newPoints, newNormals);
+
+    bool doIntegrate = false, doRaycast = false;
+    if(!trackFrame(depth, newPoints, newNormals, doIntegrate, doRaycast))
+        return false;
+
+    integrateFrame(depth, newPoints, newNormals, doIntegrate, doRaycast);
     return true;
 }
 
@@ -289,6 +499,7 @@ template< typename MatType >
 void KinFuImpl<MatType>::render(OutputArray image) const
 {
     CV_TRACE_FUNCTION();
+    waitPending();
 
     renderPointsNormals(pyrPoints[0], pyrNormals[0], image, params.lightPose);
 }
@@ -298,6 +509,7 @@ template< typename MatType >
 void KinFuImpl<MatType>::render(OutputArray image, const Matx44f& _cameraPose) const
 {
     CV_TRACE_FUNCTION();
+    waitPending();
 
     Affine3f cameraPose(_cameraPose);
     MatType points, normals;
@@ -309,6 +521,7 @@ void KinFuImpl<MatType>::render(OutputArray image, const Matx44f& _cameraPose) c
 template< typename MatType >
 void KinFuImpl<MatType>::getCloud(OutputArray p, OutputArray n) const
 {
+    waitPending();
     volume->fetchPointsNormals(p, n);
 }
 
@@ -316,6 +529,7 @@ void KinFuImpl<MatType>::getCloud(OutputArray p, OutputArray n) const
 template< typename MatType >
 void KinFuImpl<MatType>::getPoints(OutputArray points) const
 {
+    waitPending();
     volume->fetchPointsNormals(points, noArray());
 }
 
@@ -323,6 +537,7 @@ void KinFuImpl<MatType>::getPoints(OutputArray points) const
 template< typename MatType >
 void KinFuImpl<MatType>::getNormals(InputArray points, OutputArray normals) const
 {
+    waitPending();
     volume->fetchNormals(points, normals);
 }
 
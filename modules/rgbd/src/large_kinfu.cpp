@@ -12,6 +12,9 @@
 #include "submap.hpp"
 #include "tsdf.hpp"
 
+#include <chrono>
+#include <future>
+
 namespace cv
 {
 namespace large_kinfu
@@ -128,6 +131,9 @@ class LargeKinfuImpl : public LargeKinfu
     bool updateT(const MatType& depth);
 
    private:
+    //! Applies the result of finished background optimization to the map, if any
+    void collectPoseGraphResult(bool wait);
+
     Params params;
 
     cv::Ptr<ICP> icp;
@@ -136,11 +142,17 @@ class LargeKinfuImpl : public LargeKinfu
 
     int frameCounter;
     Affine3f pose;
+
+    //! Pose graph optimization runs in a background thread so that tracking is not blocked,
+    //! a new optimization is started when the map has changed and the previous one is finished
+    std::future<int> poseGraphJob;
+    Ptr<kinfu::detail::PoseGraph> optimizedPoseGraph;
+    bool poseGraphPending;
 };
 
 template<typename MatType>
 LargeKinfuImpl<MatType>::LargeKinfuImpl(const Params& _params)
-    : params(_params)
+    : params(_params), poseGraphPending(false)
 {
     icp = makeICP(params.intr, params.icpIterations, params.icpAngleThresh, params.icpDistThresh);
 
@@ -153,6 +165,12 @@ LargeKinfuImpl<MatType>::LargeKinfuImpl(const Params& _params)
 template<typename MatType>
 void LargeKinfuImpl<MatType>::reset()
 {
+    if (poseGraphJob.valid())
+        poseGraphJob.wait();
+    poseGraphJob = std::future<int>();
+    optimizedPoseGraph.release();
+    poseGraphPending = false;
+
     frameCounter = 0;
     pose         = Affine3f::Identity();
     submapMgr->reset();
@@ -161,6 +179,28 @@ void LargeKinfuImpl<MatType>::reset()
 template<typename MatType>
 LargeKinfuImpl<MatType>::~LargeKinfuImpl()
 {
+    if (poseGraphJob.valid())
+        poseGraphJob.wait();
+}
+
+template<typename MatType>
+void LargeKinfuImpl<MatType>::collectPoseGraphResult(bool wait)
+{
+    if (!poseGraphJob.valid())
+        return;
+    if (!wait && poseGraphJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+
+    int iters = poseGraphJob.get();
+    if (iters < 0)
+    {
+        CV_LOG_INFO(NULL, "Failed to perform pose graph optimization");
+    }
+    else
+    {
+        submapMgr->PoseGraphToMap(optimizedPoseGraph);
+    }
+    optimizedPoseGraph.release();
 }
 
 template<typename MatType>
@@ -276,20 +316,19 @@ bool LargeKinfuImpl<MatType>::updateT(const MatType& _depth)
     //4. Update map
     bool isMapUpdated = submapMgr->updateMap(frameCounter, newPoints, newNormals);
 
+    collectPoseGraphResult(false);
+
     if(isMapUpdated)
+        poseGraphPending = true;
+
+    if (poseGraphPending && !poseGraphJob.valid())
     {
-        // TODO: Convert constraints to posegraph
+        // the pose graph is a snapshot of the map, submaps created meanwhile are not touched
         Ptr<kinfu::detail::PoseGraph> poseGraph = submapMgr->MapToPoseGraph();
         CV_LOG_INFO(NULL, "Created posegraph");
-        int iters = poseGraph->optimize();
-        if (iters < 0)
-        {
-            CV_LOG_INFO(NULL, "Failed to perform pose graph optimization");
-            return false;
-        }
-
-        submapMgr->PoseGraphToMap(poseGraph);
-
+        optimizedPoseGraph = poseGraph;
+        poseGraphJob = std::async(std::launch::async, [poseGraph]() { return poseGraph->optimize(); });
+        poseGraphPending = false;
     }
     CV_LOG_INFO(NULL, "Number of submaps: " << submapMgr->submapList.size());
 
@@ -5,6 +5,7 @@
 // This code is also subject to the license terms in the LICENSE_WillowGarage.md file found in this module's directory
 
 #include "precomp.hpp"
+#include <fstream>
 
 namespace cv
 {
@@ -917,51 +918,13 @@ static void orUnaligned8u(const uchar * src, const int src_stride,
                    uchar * dst, const int dst_stride,
                    const int width, const int height)
 {
-#if CV_SSE2
-  volatile bool haveSSE2 = checkHardwareSupport(CPU_SSE2);
-#if CV_SSE3
-  volatile bool haveSSE3 = checkHardwareSupport(CPU_SSE3);
-#endif
-  bool src_aligned = reinterpret_cast<unsigned long long>(src) % 16 == 0;
-#endif
-
   for (int r = 0; r < height; ++r)
   {
     int c = 0;
 
-#if CV_SSE2
-    // Use aligned loads if possible
-    if (haveSSE2 && src_aligned)
-    {
-      for ( ; c < width - 15; c += 16)
-      {
-        const __m128i* src_ptr = reinterpret_cast<const __m128i*>(src + c);
-        __m128i* dst_ptr = reinterpret_cast<__m128i*>(dst + c);
-        *dst_ptr = _mm_or_si128(*dst_ptr, *src_ptr);
-      }
-    }
-#if CV_SSE3
-    // Use LDDQU for fast unaligned load
-    else if (haveSSE3)
-    {
-      for ( ; c < width - 15; c += 16)
-      {
-        __m128i val = _mm_lddqu_si128(reinterpret_cast<const __m128i*>(src + c));
-        __m128i* dst_ptr = reinterpret_cast<__m128i*>(dst + c);
-        *dst_ptr = _mm_or_si128(*dst_ptr, val);
-      }
-    }
-#endif
-    // Fall back to MOVDQU
-    else if (haveSSE2)
-    {
-      for ( ; c < width - 15; c += 16)
-      {
-        __m128i val = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + c));
-        __m128i* dst_ptr = reinterpret_cast<__m128i*>(dst + c);
-        *dst_ptr = _mm_or_si128(*dst_ptr, val);
-      }
-    }
+#if CV_SIMD128
+    for ( ; c < width - 15; c += 16)
+      v_store(dst + c, v_load(dst + c) | v_load(src + c));
 #endif
     for ( ; c < width; ++c)
       dst[c] |= src[c];
@@ -1038,11 +1001,17 @@ static void computeResponseMaps(const Mat& src, std::vector<Mat>& response_maps)
 
 #if CV_SSSE3
   volatile bool haveSSSE3 = checkHardwareSupport(CV_CPU_SSSE3);
-  if (haveSSSE3)
+#endif
+
+  // Each orientation writes its own response map
+  parallel_for_(Range(0, 8), [&](const Range& range)
   {
-    const __m128i* lut = reinterpret_cast<const __m128i*>(SIMILARITY_LUT);
-    for (int ori = 0; ori < 8; ++ori)
+  for (int ori = range.start; ori < range.end; ++ori)
+  {
+#if CV_SSSE3
+    if (haveSSSE3)
     {
+      const __m128i* lut = reinterpret_cast<const __m128i*>(SIMILARITY_LUT);
       __m128i* map_data = response_maps[ori].ptr<__m128i>();
       __m128i* lsb4_data = lsb4.ptr<__m128i>();
       __m128i* msb4_data = msb4.ptr<__m128i>();
@@ -1059,12 +1028,8 @@ static void computeResponseMaps(const Mat& src, std::vector<Mat>& response_maps)
         map_data[i] = _mm_max_epu8(res1, res2);
       }
     }
-  }
-  else
+    else
 #endif
-  {
-    // For each of the 8 quantized orientations...
-    for (int ori = 0; ori < 8; ++ori)
     {
       uchar* map_data = response_maps[ori].ptr<uchar>();
       uchar* lsb4_data = lsb4.ptr<uchar>();
@@ -1078,6 +1043,7 @@ static void computeResponseMaps(const Mat& src, std::vector<Mat>& response_maps)
       }
     }
   }
+  });
 }
 
 /**
@@ -1156,7 +1122,8 @@ static const unsigned char* accessLinearMemory(const std::vector<Mat>& linear_me
  *
  * \param[in]  linear_memories Vector of 8 linear memories, one for each label.
  * \param[in]  templ           Template to match against.
- * \param[out] dst             Destination 8-bit similarity image of size (W/T, H/T).
+ * \param[out] dst             Destination similarity image of size (W/T, H/T), 8-bit for
+ *                             templates of 63 features or less and 16-bit otherwise.
  * \param      size            Size (W, H) of the original input image.
  * \param      T               Sampling step.
  */
@@ -1165,10 +1132,10 @@ static void similarity(const std::vector<Mat>& linear_memories, const Template&
 {
   // 63 features or less is a special case because the max similarity per-feature is 4.
   // 255/4 = 63, so up to that many we can add up similarities in 8 bits without worrying
-  // about overflow. Therefore here we use _mm_add_epi8 as the workhorse, whereas a more
-  // general function would use _mm_add_epi16.
-  CV_Assert(templ.features.size() <= 63);
-  /// @todo Handle more than 255/MAX_RESPONSE features!!
+  // about overflow. Larger templates are accumulated in 16 bits, which holds up to
+  // 65535/4 = 16383 features.
+  CV_Assert(templ.features.size() <= 16383);
+  const bool acc8u = templ.features.size() <= 63;
 
   // Decimate input image size by factor of T
   int W = size.width / T;
@@ -1190,15 +1157,7 @@ static void similarity(const std::vector<Mat>& linear_memories, const Template&
 
   /// @todo In old code, dst is buffer of size m_U. Could make it something like
   /// (span_x)x(span_y) instead?
-  dst = Mat::zeros(H, W, CV_8U);
-  uchar* dst_ptr = dst.ptr<uchar>();
-
-#if CV_SSE2
-  volatile bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
-#if CV_SSE3
-  volatile bool haveSSE3 = checkHardwareSupport(CV_CPU_SSE3);
-#endif
-#endif
+  dst = Mat::zeros(H, W, acc8u ? CV_8U : CV_16U);
 
   // Compute the similarity measure for this template by accumulating the contribution of
   // each feature
@@ -1213,36 +1172,34 @@ static void similarity(const std::vector<Mat>& linear_memories, const Template&
       continue;
     const uchar* lm_ptr = accessLinearMemory(linear_memories, f, T, W);
 
-    // Now we do an aligned/unaligned add of dst_ptr and lm_ptr with template_positions elements
+    // Now we do an unaligned add of dst_ptr and lm_ptr with template_positions elements
     int j = 0;
-    // Process responses 16 at a time if vectorization possible
-#if CV_SSE2
-#if CV_SSE3
-    if (haveSSE3)
+    if (acc8u)
     {
-      // LDDQU may be more efficient than MOVDQU for unaligned load of next 16 responses
+      uchar* dst_ptr = dst.ptr<uchar>();
+#if CV_SIMD128
+      // Process responses 16 at a time
       for ( ; j < template_positions - 15; j += 16)
-      {
-        __m128i responses = _mm_lddqu_si128(reinterpret_cast<const __m128i*>(lm_ptr + j));
-        __m128i* dst_ptr_sse = reinterpret_cast<__m128i*>(dst_ptr + j);
-        *dst_ptr_sse = _mm_add_epi8(*dst_ptr_sse, responses);
-      }
+        v_store(dst_ptr + j, v_add_wrap(v_load(dst_ptr + j), v_load(lm_ptr + j)));
+#endif
+      for ( ; j < template_positions; ++j)
+        dst_ptr[j] = uchar(dst_ptr[j] + lm_ptr[j]);
     }
     else
-#endif
-    if (haveSSE2)
     {
-      // Fall back to MOVDQU
+      ushort* dst_ptr = dst.ptr<ushort>();
+#if CV_SIMD128
       for ( ; j < template_positions - 15; j += 16)
       {
-        __m128i responses = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lm_ptr + j));
-        __m128i* dst_ptr_sse = reinterpret_cast<__m128i*>(dst_ptr + j);
-        *dst_ptr_sse = _mm_add_epi8(*dst_ptr_sse, responses);
+        v_uint16x8 lo, hi;
+        v_expand(v_load(lm_ptr + j), lo, hi);
+        v_store(dst_ptr + j, v_load(dst_ptr + j) + lo);
+        v_store(dst_ptr + j + 8, v_load(dst_ptr + j + 8) + hi);
       }
-    }
 #endif
-    for ( ; j < template_positions; ++j)
-      dst_ptr[j] = uchar(dst_ptr[j] + lm_ptr[j]);
+      for ( ; j < template_positions; ++j)
+        dst_ptr[j] = ushort(dst_ptr[j] + lm_ptr[j]);
+    }
   }
 }
 
@@ -1251,7 +1208,8 @@ static void similarity(const std::vector<Mat>& linear_memories, const Template&
  *
  * \param[in]  linear_memories Vector of 8 linear memories, one for each label.
  * \param[in]  templ           Template to match against.
- * \param[out] dst             Destination 8-bit similarity image, 16x16.
+ * \param[out] dst             Destination similarity image, 16x16, 8-bit for templates
+ *                             of 63 features or less and 16-bit otherwise.
  * \param      size            Size (W, H) of the original input image.
  * \param      T               Sampling step.
  * \param      center          Center of the local region.
@@ -1261,11 +1219,12 @@ static void similarityLocal(const std::vector<Mat>& linear_memories, const Templ
 {
   // Similar to whole-image similarity() above. This version takes a position 'center'
   // and computes the energy in the 16x16 patch centered on it.
-  CV_Assert(templ.features.size() <= 63);
+  CV_Assert(templ.features.size() <= 16383);
+  const bool acc8u = templ.features.size() <= 63;
 
   // Compute the similarity map in a 16x16 patch around center
   int W = size.width / T;
-  dst = Mat::zeros(16, 16, CV_8U);
+  dst = Mat::zeros(16, 16, acc8u ? CV_8U : CV_16U);
 
   // Offset each feature point by the requested center. Further adjust to (-8,-8) from the
   // center to get the top-left corner of the 16x16 patch.
@@ -1273,14 +1232,6 @@ static void similarityLocal(const std::vector<Mat>& linear_memories, const Templ
   int offset_x = (center.x / T - 8) * T;
   int offset_y = (center.y / T - 8) * T;
 
-#if CV_SSE2
-  volatile bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
-#if CV_SSE3
-  volatile bool haveSSE3 = checkHardwareSupport(CV_CPU_SSE3);
-#endif
-  __m128i* dst_ptr_sse = dst.ptr<__m128i>();
-#endif
-
   for (int i = 0; i < (int)templ.features.size(); ++i)
   {
     Feature f = templ.features[i];
@@ -1292,39 +1243,36 @@ static void similarityLocal(const std::vector<Mat>& linear_memories, const Templ
 
     const uchar* lm_ptr = accessLinearMemory(linear_memories, f, T, W);
 
-    // Process whole row at a time if vectorization possible
-#if CV_SSE2
-#if CV_SSE3
-    if (haveSSE3)
+    // Process whole row at a time
+    if (acc8u)
     {
-      // LDDQU may be more efficient than MOVDQU for unaligned load of 16 responses from current row
+      uchar* dst_ptr = dst.ptr<uchar>();
       for (int row = 0; row < 16; ++row)
       {
-        __m128i aligned = _mm_lddqu_si128(reinterpret_cast<const __m128i*>(lm_ptr));
-        dst_ptr_sse[row] = _mm_add_epi8(dst_ptr_sse[row], aligned);
-        lm_ptr += W; // Step to next row
-      }
-    }
-    else
+#if CV_SIMD128
+        v_store(dst_ptr, v_add_wrap(v_load(dst_ptr), v_load(lm_ptr)));
+#else
+        for (int col = 0; col < 16; ++col)
+          dst_ptr[col] = uchar(dst_ptr[col] + lm_ptr[col]);
 #endif
-    if (haveSSE2)
-    {
-      // Fall back to MOVDQU
-      for (int row = 0; row < 16; ++row)
-      {
-        __m128i aligned = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lm_ptr));
-        dst_ptr_sse[row] = _mm_add_epi8(dst_ptr_sse[row], aligned);
+        dst_ptr += 16;
         lm_ptr += W; // Step to next row
       }
     }
     else
-#endif
     {
-      uchar* dst_ptr = dst.ptr<uchar>();
+      ushort* dst_ptr = dst.ptr<ushort>();
       for (int row = 0; row < 16; ++row)
       {
+#if CV_SIMD128
+        v_uint16x8 lo, hi;
+        v_expand(v_load(lm_ptr), lo, hi);
+        v_store(dst_ptr, v_load(dst_ptr) + lo);
+        v_store(dst_ptr + 8, v_load(dst_ptr + 8) + hi);
+#else
         for (int col = 0; col < 16; ++col)
-          dst_ptr[col] = uchar(dst_ptr[col] + lm_ptr[col]);
+          dst_ptr[col] = ushort(dst_ptr[col] + lm_ptr[col]);
+#endif
         dst_ptr += 16;
         lm_ptr += W;
       }
@@ -1334,22 +1282,25 @@ static void similarityLocal(const std::vector<Mat>& linear_memories, const Templ
 
 static void addUnaligned8u16u(const uchar * src1, const uchar * src2, ushort * res, int length)
 {
-  const uchar * end = src1 + length;
-
-  while (src1 != end)
+  int i = 0;
+#if CV_SIMD128
+  for ( ; i < length - 15; i += 16)
   {
-    *res = *src1 + *src2;
-
-    ++src1;
-    ++src2;
-    ++res;
+    v_uint16x8 a_lo, a_hi, b_lo, b_hi;
+    v_expand(v_load(src1 + i), a_lo, a_hi);
+    v_expand(v_load(src2 + i), b_lo, b_hi);
+    v_store(res + i, a_lo + b_lo);
+    v_store(res + i + 8, a_hi + b_hi);
   }
+#endif
+  for ( ; i < length; ++i)
+    res[i] = ushort(src1[i] + src2[i]);
 }
 
 /**
- * \brief Accumulate one or more 8-bit similarity images.
+ * \brief Accumulate one or more 8-bit or 16-bit similarity images.
  *
- * \param[in]  similarities Source 8-bit similarity images.
+ * \param[in]  similarities Source similarity images.
  * \param[out] dst          Destination 16-bit similarity image.
  */
 static void addSimilarities(const std::vector<Mat>& similarities, Mat& dst)
@@ -1360,9 +1311,14 @@ static void addSimilarities(const std::vector<Mat>& similarities, Mat& dst)
   }
   else
   {
-    // NOTE: add() seems to be rather slow in the 8U + 8U -> 16U case
-    dst.create(similarities[0].size(), CV_16U);
-    addUnaligned8u16u(similarities[0].ptr(), similarities[1].ptr(), dst.ptr<ushort>(), static_cast<int>(dst.total()));
+    if (similarities[0].type() == CV_8U && similarities[1].type() == CV_8U)
+    {
+      // NOTE: add() seems to be rather slow in the 8U + 8U -> 16U case
+      dst.create(similarities[0].size(), CV_16U);
+      addUnaligned8u16u(similarities[0].ptr(), similarities[1].ptr(), dst.ptr<ushort>(), static_cast<int>(dst.total()));
+    }
+    else
+      add(similarities[0], similarities[1], dst, noArray(), CV_16U);
 
     /// @todo Optimize 16u + 8u -> 16u when more than 2 modalities
     for (size_t i = 2; i < similarities.size(); ++i)
@@ -1424,31 +1380,38 @@ void Detector::match(const std::vector<Mat>& sources, float threshold, std::vect
         quantizers[i]->pyrDown();
     }
 
-    Mat quantized, spread_quantized;
-    std::vector<Mat> response_maps;
+    std::vector<Mat> quantized(quantizers.size());
     for (int i = 0; i < (int)quantizers.size(); ++i)
     {
-      quantizers[i]->quantize(quantized);
-      spread(quantized, spread_quantized, T);
+      Mat spread_quantized;
+      std::vector<Mat> response_maps;
+      quantizers[i]->quantize(quantized[i]);
+      spread(quantized[i], spread_quantized, T);
       computeResponseMaps(spread_quantized, response_maps);
 
       LinearMemories& memories = lm_level[i];
-      for (int j = 0; j < 8; ++j)
-        linearize(response_maps[j], memories[j], T);
+      parallel_for_(Range(0, 8), [&](const Range& range)
+      {
+        for (int j = range.start; j < range.end; ++j)
+          linearize(response_maps[j], memories[j], T);
+      });
 
       if (quantized_images.needed()) //use copyTo here to side step reference semantics.
-        quantized.copyTo(quantized_images.getMatRef(static_cast<int>(l*quantizers.size() + i)));
+        quantized[i].copyTo(quantized_images.getMatRef(static_cast<int>(l*quantizers.size() + i)));
     }
 
-    sizes.push_back(quantized.size());
+    sizes.push_back(quantized.back().size());
   }
 
+  // Templates of all requested classes are matched at once, so that the work is spread
+  // over the threads even when there are only a few classes
+  std::vector<TemplatesMap::const_iterator> classes;
   if (class_ids.empty())
   {
     // Match all templates
     TemplatesMap::const_iterator it = class_templates.begin(), itend = class_templates.end();
     for ( ; it != itend; ++it)
-      matchClass(lm_pyramid, sizes, threshold, matches, it->first, it->second);
+      classes.push_back(it);
   }
   else
   {
@@ -1457,10 +1420,30 @@ void Detector::match(const std::vector<Mat>& sources, float threshold, std::vect
     {
       TemplatesMap::const_iterator it = class_templates.find(class_ids[i]);
       if (it != class_templates.end())
-        matchClass(lm_pyramid, sizes, threshold, matches, it->first, it->second);
+        classes.push_back(it);
     }
   }
 
+  std::vector<std::pair<int, int> > jobs; // (index in classes, template id)
+  for (int c = 0; c < (int)classes.size(); ++c)
+    for (int t = 0; t < (int)classes[c]->second.size(); ++t)
+      jobs.push_back(std::make_pair(c, t));
+
+  // Candidates of each template are kept apart and joined in order, so the result
+  // does not depend on the number of threads
+  std::vector< std::vector<Match> > job_matches(jobs.size());
+  parallel_for_(Range(0, (int)jobs.size()), [&](const Range& range)
+  {
+    for (int j = range.start; j < range.end; ++j)
+    {
+      TemplatesMap::const_iterator it = classes[jobs[j].first];
+      int template_id = jobs[j].second;
+      matchTemplate(lm_pyramid, sizes, threshold, job_matches[j], it->first, template_id, it->second[template_id]);
+    }
+  });
+  for (size_t j = 0; j < job_matches.size(); ++j)
+    matches.insert(matches.end(), job_matches[j].begin(), job_matches[j].end());
+
   // Sort matches by similarity, and prune any duplicates introduced by pyramid refinement
   std::sort(matches.begin(), matches.end());
   std::vector<Match>::iterator new_end = std::unique(matches.begin(), matches.end());
@@ -1481,126 +1464,137 @@ void Detector::matchClass(const LinearMemoryPyramid& lm_pyramid,
                           const String& class_id,
                           const std::vector<TemplatePyramid>& template_pyramids) const
 {
-  // For each template...
-  for (size_t template_id = 0; template_id < template_pyramids.size(); ++template_id)
+  std::vector< std::vector<Match> > template_matches(template_pyramids.size());
+  parallel_for_(Range(0, (int)template_pyramids.size()), [&](const Range& range)
   {
-    const TemplatePyramid& tp = template_pyramids[template_id];
-
-    // First match over the whole image at the lowest pyramid level
-    /// @todo Factor this out into separate function
-    const std::vector<LinearMemories>& lowest_lm = lm_pyramid.back();
-
-    // Compute similarity maps for each modality at lowest pyramid level
-    std::vector<Mat> similarities(modalities.size());
-    int lowest_start = static_cast<int>(tp.size() - modalities.size());
-    int lowest_T = T_at_level.back();
-    int num_features = 0;
-    for (int i = 0; i < (int)modalities.size(); ++i)
-    {
-      const Template& templ = tp[lowest_start + i];
-      num_features += static_cast<int>(templ.features.size());
-      similarity(lowest_lm[i], templ, similarities[i], sizes.back(), lowest_T);
-    }
+    for (int template_id = range.start; template_id < range.end; ++template_id)
+      matchTemplate(lm_pyramid, sizes, threshold, template_matches[template_id], class_id,
+                    template_id, template_pyramids[template_id]);
+  });
+  for (size_t template_id = 0; template_id < template_matches.size(); ++template_id)
+    matches.insert(matches.end(), template_matches[template_id].begin(), template_matches[template_id].end());
+}
+
+void Detector::matchTemplate(const LinearMemoryPyramid& lm_pyramid,
+                             const std::vector<Size>& sizes,
+                             float threshold, std::vector<Match>& matches,
+                             const String& class_id, int template_id,
+                             const TemplatePyramid& tp) const
+{
+  // First match over the whole image at the lowest pyramid level
+  /// @todo Factor this out into separate function
+  const std::vector<LinearMemories>& lowest_lm = lm_pyramid.back();
+
+  // Compute similarity maps for each modality at lowest pyramid level
+  std::vector<Mat> similarities(modalities.size());
+  int lowest_start = static_cast<int>(tp.size() - modalities.size());
+  int lowest_T = T_at_level.back();
+  int num_features = 0;
+  for (int i = 0; i < (int)modalities.size(); ++i)
+  {
+    const Template& templ = tp[lowest_start + i];
+    num_features += static_cast<int>(templ.features.size());
+    similarity(lowest_lm[i], templ, similarities[i], sizes.back(), lowest_T);
+  }
 
-    // Combine into overall similarity
-    /// @todo Support weighting the modalities
-    Mat total_similarity;
-    addSimilarities(similarities, total_similarity);
+  // Combine into overall similarity
+  /// @todo Support weighting the modalities
+  Mat total_similarity;
+  addSimilarities(similarities, total_similarity);
 
-    // Convert user-friendly percentage to raw similarity threshold. The percentage
-    // threshold scales from half the max response (what you would expect from applying
-    // the template to a completely random image) to the max response.
-    // NOTE: This assumes max per-feature response is 4, so we scale between [2*nf, 4*nf].
-    int raw_threshold = static_cast<int>(2*num_features + (threshold / 100.f) * (2*num_features) + 0.5f);
+  // Convert user-friendly percentage to raw similarity threshold. The percentage
+  // threshold scales from half the max response (what you would expect from applying
+  // the template to a completely random image) to the max response.
+  // NOTE: This assumes max per-feature response is 4, so we scale between [2*nf, 4*nf].
+  int raw_threshold = static_cast<int>(2*num_features + (threshold / 100.f) * (2*num_features) + 0.5f);
 
-    // Find initial matches
-    std::vector<Match> candidates;
-    for (int r = 0; r < total_similarity.rows; ++r)
+  // Find initial matches
+  std::vector<Match> candidates;
+  for (int r = 0; r < total_similarity.rows; ++r)
+  {
+    ushort* row = total_similarity.ptr<ushort>(r);
+    for (int c = 0; c < total_similarity.cols; ++c)
     {
-      ushort* row = total_similarity.ptr<ushort>(r);
-      for (int c = 0; c < total_similarity.cols; ++c)
+      int raw_score = row[c];
+      if (raw_score > raw_threshold)
       {
-        int raw_score = row[c];
-        if (raw_score > raw_threshold)
-        {
-          int offset = lowest_T / 2 + (lowest_T % 2 - 1);
-          int x = c * lowest_T + offset;
-          int y = r * lowest_T + offset;
-          float score =(raw_score * 100.f) / (4 * num_features) + 0.5f;
-          candidates.push_back(Match(x, y, score, class_id, static_cast<int>(template_id)));
-        }
+        int offset = lowest_T / 2 + (lowest_T % 2 - 1);
+        int x = c * lowest_T + offset;
+        int y = r * lowest_T + offset;
+        float score =(raw_score * 100.f) / (4 * num_features) + 0.5f;
+        candidates.push_back(Match(x, y, score, class_id, template_id));
       }
     }
+  }
 
-    // Locally refine each match by marching up the pyramid
-    for (int l = pyramid_levels - 2; l >= 0; --l)
+  // Locally refine each match by marching up the pyramid
+  for (int l = pyramid_levels - 2; l >= 0; --l)
+  {
+    const std::vector<LinearMemories>& lms = lm_pyramid[l];
+    int T = T_at_level[l];
+    int start = static_cast<int>(l * modalities.size());
+    Size size = sizes[l];
+    int border = 8 * T;
+    int offset = T / 2 + (T % 2 - 1);
+    int max_x = size.width - tp[start].width - border;
+    int max_y = size.height - tp[start].height - border;
+
+    std::vector<Mat> similarities2(modalities.size());
+    Mat total_similarity2;
+    for (int m = 0; m < (int)candidates.size(); ++m)
     {
-      const std::vector<LinearMemories>& lms = lm_pyramid[l];
-      int T = T_at_level[l];
-      int start = static_cast<int>(l * modalities.size());
-      Size size = sizes[l];
-      int border = 8 * T;
-      int offset = T / 2 + (T % 2 - 1);
-      int max_x = size.width - tp[start].width - border;
-      int max_y = size.height - tp[start].height - border;
-
-      std::vector<Mat> similarities2(modalities.size());
-      Mat total_similarity2;
-      for (int m = 0; m < (int)candidates.size(); ++m)
-      {
-        Match& match2 = candidates[m];
-        int x = match2.x * 2 + 1; /// @todo Support other pyramid distance
-        int y = match2.y * 2 + 1;
+      Match& match2 = candidates[m];
+      int x = match2.x * 2 + 1; /// @todo Support other pyramid distance
+      int y = match2.y * 2 + 1;
 
-        // Require 8 (reduced) row/cols to the up/left
-        x = std::max(x, border);
-        y = std::max(y, border);
+      // Require 8 (reduced) row/cols to the up/left
+      x = std::max(x, border);
+      y = std::max(y, border);
 
-        // Require 8 (reduced) row/cols to the down/left, plus the template size
-        x = std::min(x, max_x);
-        y = std::min(y, max_y);
+      // Require 8 (reduced) row/cols to the down/left, plus the template size
+      x = std::min(x, max_x);
+      y = std::min(y, max_y);
 
-        // Compute local similarity maps for each modality
-        int numFeatures = 0;
-        for (int i = 0; i < (int)modalities.size(); ++i)
-        {
-          const Template& templ = tp[start + i];
-          numFeatures += static_cast<int>(templ.features.size());
-          similarityLocal(lms[i], templ, similarities2[i], size, T, Point(x, y));
-        }
-        addSimilarities(similarities2, total_similarity2);
+      // Compute local similarity maps for each modality
+      int numFeatures = 0;
+      for (int i = 0; i < (int)modalities.size(); ++i)
+      {
+        const Template& templ = tp[start + i];
+        numFeatures += static_cast<int>(templ.features.size());
+        similarityLocal(lms[i], templ, similarities2[i], size, T, Point(x, y));
+      }
+      addSimilarities(similarities2, total_similarity2);
 
-        // Find best local adjustment
-        int best_score = 0;
-        int best_r = -1, best_c = -1;
-        for (int r = 0; r < total_similarity2.rows; ++r)
+      // Find best local adjustment
+      int best_score = 0;
+      int best_r = -1, best_c = -1;
+      for (int r = 0; r < total_similarity2.rows; ++r)
+      {
+        ushort* row = total_similarity2.ptr<ushort>(r);
+        for (int c = 0; c < total_similarity2.cols; ++c)
         {
-          ushort* row = total_similarity2.ptr<ushort>(r);
-          for (int c = 0; c < total_similarity2.cols; ++c)
+          int score = row[c];
+          if (score > best_score)
           {
-            int score = row[c];
-            if (score > best_score)
-            {
-              best_score = score;
-              best_r = r;
-              best_c = c;
-            }
+            best_score = score;
+            best_r = r;
+            best_c = c;
           }
         }
-        // Update current match
-        match2.x = (x / T - 8 + best_c) * T + offset;
-        match2.y = (y / T - 8 + best_r) * T + offset;
-        match2.similarity = (best_score * 100.f) / (4 * numFeatures);
       }
-
-      // Filter out any matches that drop below the similarity threshold
-      std::vector<Match>::iterator new_end = std::remove_if(candidates.begin(), candidates.end(),
-                                                            MatchPredicate(threshold));
-      candidates.erase(new_end, candidates.end());
+      // Update current match
+      match2.x = (x / T - 8 + best_c) * T + offset;
+      match2.y = (y / T - 8 + best_r) * T + offset;
+      match2.similarity = (best_score * 100.f) / (4 * numFeatures);
     }
 
-    matches.insert(matches.end(), candidates.begin(), candidates.end());
+    // Filter out any matches that drop below the similarity threshold
+    std::vector<Match>::iterator new_end = std::remove_if(candidates.begin(), candidates.end(),
+                                                          MatchPredicate(threshold));
+    candidates.erase(new_end, candidates.end());
   }
+
+  matches.insert(matches.end(), candidates.begin(), candidates.end());
 }
 
 int Detector::addTemplate(const std::vector<Mat>& sources, const String& class_id,
@@ -1819,6 +1813,189 @@ void Detector::writeClasses(const String& format) const
   }
 }
 
+/****************************************************************************************\
+*                               Binary template database                                 *
+\****************************************************************************************/
+
+// "LMDB" followed by the format version
+static const char BINARY_MAGIC[4] = { 'L', 'M', 'D', 'B' };
+static const int BINARY_VERSION = 1;
+
+static void writeInt(std::vector<uchar>& buf, int v)
+{
+  // little-endian regardless of the host
+  unsigned u = static_cast<unsigned>(v);
+  for (int i = 0; i < 4; ++i)
+    buf.push_back(static_cast<uchar>(u >> (8 * i)));
+}
+
+static void writeString(std::vector<uchar>& buf, const String& str)
+{
+  writeInt(buf, static_cast<int>(str.size()));
+  buf.insert(buf.end(), str.begin(), str.end());
+}
+
+class BinaryReader
+{
+public:
+  BinaryReader(const std::vector<uchar>& _buf) : buf(_buf), pos(0) {}
+
+  int readInt()
+  {
+    require(4);
+    const uchar* p = &buf[pos];
+    pos += 4;
+    return static_cast<int>(unsigned(p[0]) | (unsigned(p[1]) << 8) |
+                            (unsigned(p[2]) << 16) | (unsigned(p[3]) << 24));
+  }
+
+  String readString()
+  {
+    int len = readInt();
+    CV_Assert(len >= 0);
+    require((size_t)len);
+    String str(reinterpret_cast<const char*>(&buf[0]) + pos, len);
+    pos += len;
+    return str;
+  }
+
+  void readFeatures(std::vector<Feature>& features, int count)
+  {
+    CV_Assert(count >= 0);
+    require((size_t)count * 12);
+    features.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+      features[i].x = readInt();
+      features[i].y = readInt();
+      features[i].label = readInt();
+    }
+  }
+
+  void skip(size_t n) { require(n); pos += n; }
+
+private:
+  void require(size_t n) const
+  {
+    if (buf.size() - pos < n)
+      CV_Error(Error::StsParseError, "Truncated linemod template database");
+  }
+
+  const std::vector<uchar>& buf;
+  size_t pos;
+};
+
+void Detector::writeClassesBinary(const String& filename) const
+{
+  std::vector<uchar> buf(BINARY_MAGIC, BINARY_MAGIC + 4);
+  writeInt(buf, BINARY_VERSION);
+  writeInt(buf, pyramid_levels);
+  writeInt(buf, static_cast<int>(modalities.size()));
+  for (size_t i = 0; i < modalities.size(); ++i)
+    writeString(buf, modalities[i]->name());
+  writeInt(buf, static_cast<int>(class_templates.size()));
+
+  TemplatesMap::const_iterator it = class_templates.begin(), it_end = class_templates.end();
+  for ( ; it != it_end; ++it)
+  {
+    const std::vector<TemplatePyramid>& tps = it->second;
+    writeString(buf, it->first);
+    size_t size_pos = buf.size();
+    // byte size of the class data, lets a reader skip the classes it does not need
+    writeInt(buf, 0);
+    writeInt(buf, static_cast<int>(tps.size()));
+    for (size_t i = 0; i < tps.size(); ++i)
+    {
+      writeInt(buf, static_cast<int>(tps[i].size()));
+      for (size_t j = 0; j < tps[i].size(); ++j)
+      {
+        const Template& templ = tps[i][j];
+        writeInt(buf, templ.width);
+        writeInt(buf, templ.height);
+        writeInt(buf, templ.pyramid_level);
+        writeInt(buf, static_cast<int>(templ.features.size()));
+        for (size_t k = 0; k < templ.features.size(); ++k)
+        {
+          writeInt(buf, templ.features[k].x);
+          writeInt(buf, templ.features[k].y);
+          writeInt(buf, templ.features[k].label);
+        }
+      }
+    }
+    int class_size = static_cast<int>(buf.size() - size_pos - 4);
+    for (int i = 0; i < 4; ++i)
+      buf[size_pos + i] = static_cast<uchar>(unsigned(class_size) >> (8 * i));
+  }
+
+  std::ofstream ofs(filename.c_str(), std::ios::binary);
+  if (!ofs.write(reinterpret_cast<const char*>(&buf[0]), buf.size()))
+    CV_Error(Error::StsError, "Can not write linemod template database " + filename);
+}
+
+void Detector::readClassesBinary(const String& filename, const std::vector<String>& class_ids)
+{
+  std::vector<uchar> buf;
+  {
+    std::ifstream ifs(filename.c_str(), std::ios::binary | std::ios::ate);
+    if (!ifs)
+      CV_Error(Error::StsError, "Can not open linemod template database " + filename);
+    std::streamoff size = ifs.tellg();
+    buf.resize(static_cast<size_t>(size));
+    ifs.seekg(0);
+    if (size > 0 && !ifs.read(reinterpret_cast<char*>(&buf[0]), size))
+      CV_Error(Error::StsError, "Can not read linemod template database " + filename);
+  }
+
+  if (buf.size() < 4 || !std::equal(BINARY_MAGIC, BINARY_MAGIC + 4, buf.begin()))
+    CV_Error(Error::StsParseError, filename + " is not a linemod template database");
+
+  BinaryReader reader(buf);
+  reader.skip(4);
+  if (reader.readInt() != BINARY_VERSION)
+    CV_Error(Error::StsParseError, "Unsupported linemod template database version");
+
+  // Verify compatible with Detector settings
+  CV_Assert(reader.readInt() == pyramid_levels);
+  CV_Assert(reader.readInt() == (int)modalities.size());
+  for (size_t i = 0; i < modalities.size(); ++i)
+    CV_Assert(reader.readString() == modalities[i]->name());
+
+  int num_classes = reader.readInt();
+  for (int c = 0; c < num_classes; ++c)
+  {
+    String class_id = reader.readString();
+    int class_size = reader.readInt();
+    CV_Assert(class_size >= 0);
+    if (!class_ids.empty() && std::find(class_ids.begin(), class_ids.end(), class_id) == class_ids.end())
+    {
+      reader.skip((size_t)class_size);
+      continue;
+    }
+
+    // Detector should not already have this class
+    CV_Assert(class_templates.find(class_id) == class_templates.end());
+    std::vector<TemplatePyramid>& tps = class_templates[class_id];
+
+    int num_pyramids = reader.readInt();
+    CV_Assert(num_pyramids >= 0);
+    tps.resize(num_pyramids);
+    for (int i = 0; i < num_pyramids; ++i)
+    {
+      int num_templates = reader.readInt();
+      CV_Assert(num_templates >= 0);
+      tps[i].resize(num_templates);
+      for (int j = 0; j < num_templates; ++j)
+      {
+        Template& templ = tps[i][j];
+        templ.width = reader.readInt();
+        templ.height = reader.readInt();
+        templ.pyramid_level = reader.readInt();
+        reader.readFeatures(templ.features, reader.readInt());
+      }
+    }
+  }
+}
+
 static const int T_DEFAULTS[] = {5, 8};
 
 Ptr<Detector> getDefaultLINE()
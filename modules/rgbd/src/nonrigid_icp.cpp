@@ -7,6 +7,7 @@
 #include <algorithm>
 #include "precomp.hpp"
 #include "nonrigid_icp.hpp"
+#include "sparse_block_matrix.hpp"
 
 #define MAD_SCALE 1.4826f
 #define TUKEY_B 4.6851f
@@ -86,11 +87,20 @@ float ICPImpl::huberWeight(Vec3f v, float sigma) const
     return (x > HUBER_K)? HUBER_K/x : 1.f;
 }
 
+static inline Matx33f skew(const Vec3f& v)
+{
+    return Matx33f(0, -v[2], v[1],
+                   v[2], 0, -v[0],
+                   -v[1], v[0], 0);
+}
+
 bool ICPImpl::estimateWarpNodes(WarpField& currentWarp, const Affine3f &pose,
                                 InputArray _vertImage, InputArray _oldPoints,
                                 InputArray _oldNormals, InputArray _newPoints,
                                 InputArray _newNormals) const
 {
+    CV_TRACE_FUNCTION();
+
     CV_Assert(_vertImage.isMat());
     CV_Assert(_oldPoints.isMat());
     CV_Assert(_newPoints.isMat());
@@ -118,10 +128,9 @@ bool ICPImpl::estimateWarpNodes(WarpField& currentWarp, const Affine3f &pose,
     int totalNodes = (int)warpNodes.size();
     for(const auto& nodes: regNodes) totalNodes += (int)nodes.size();
 
-    // level-wise regularisation components of A and b (from Ax = b) for each node in hierarchy
-    Mat_<float> b_reg(6*totalNodes, 1, 0.f);
-    Mat_<float> A_reg(6*totalNodes, 6*totalNodes, 0.f);
-
+    // normal equations (Ax = b) in 6x6 blocks, one block row per node in hierarchy
+    BlockSparseMat<float, 6, 6> A(totalNodes);
+    std::vector<float> b(6*totalNodes, 0.f);
 
     // indices for each node block to A,b matrices. It determines the order
     // in which paramters are laid out
@@ -133,9 +142,6 @@ bool ICPImpl::estimateWarpNodes(WarpField& currentWarp, const Affine3f &pose,
         baseIndices[l] = baseIndices[l+1]+6*((int)regNodes[l].size());
     }
 
-    for(const int& i: baseIndices) std::cout << i << ", ";
-    std::cout << std::endl;
-
     // populate residuals for each edge in the graph to calculate sigma
     std::vector<float> reg_residuals;
     float RegEnergy = 0;
@@ -148,9 +154,6 @@ bool ICPImpl::estimateWarpNodes(WarpField& currentWarp, const Affine3f &pose,
 
         const NodeVectorType& nextLevelNodes = regNodes[l];
 
-        std::cout << currentLevelNodes.size() << " " << nextLevelNodes.size() << std::endl;
-
-
         for(size_t node = 0; node < level.size(); node++)
         {
             const nodeNeighboursType& children = level[node];
@@ -173,9 +176,7 @@ bool ICPImpl::estimateWarpNodes(WarpField& currentWarp, const Affine3f &pose,
         }
     }
 
-    Mat_<float> J_reg(6*numEdges, 6*totalNodes, 0.f);
-
-    std::cout << "Total reg energy: " << RegEnergy << ", Average: " << RegEnergy/numEdges << std::endl;
+    CV_LOG_DEBUG(NULL, "Total reg energy: " << RegEnergy << ", Average: " << RegEnergy/std::max(numEdges, 1));
 
     float reg_med = median(reg_residuals);
     std::for_each(reg_residuals.begin(), reg_residuals.end(),
@@ -185,8 +186,10 @@ bool ICPImpl::estimateWarpNodes(WarpField& currentWarp, const Affine3f &pose,
                   });
 
     float reg_sigma = MAD_SCALE * median(reg_residuals);
-    std::cout << "[Reg] Sigma: " << reg_sigma << " from " << reg_residuals.size() << " residuals " << std::endl;
 
+    // Gauss-Newton terms of the edge residual
+    // r = T_i * (v_j - v_i) + v_i - (v_j + t_j)
+    // with respect to the twists of the node i and of its child j
     for(int l = 0; l < (currentWarp.n_levels-1); l++)
     {
         const std::vector<nodeNeighboursType>& level = regGraph[l];
@@ -200,7 +203,7 @@ bool ICPImpl::estimateWarpNodes(WarpField& currentWarp, const Affine3f &pose,
             Vec3f nodePos = currentLevelNodes[node]->pos;
             Affine3f nodeTransform = currentLevelNodes[node]->transform;
 
-            int parentIndex = baseIndices[l]+6*(int)node;
+            int parentBlock = (baseIndices[l]+6*(int)node) / 6;
 
             for(int edge = 0; edge < currentWarp.k; edge++)
             {
@@ -219,253 +222,264 @@ bool ICPImpl::estimateWarpNodes(WarpField& currentWarp, const Affine3f &pose,
                 // take sqrt since radius is stored as squared distance
                 float edgeWeight = sqrt(min(childNode->radius, currentLevelNodes[node]->radius));
 
-                Vec3f v1 = transformedChild.cross(r_edge);
-
-
                 float w = 1 * robustWeight * edgeWeight;
-                b_reg(parentIndex+0) += -w * v1[0];
-                b_reg(parentIndex+1) += -w * v1[1];
-                b_reg(parentIndex+2) += -w * v1[2];
-                b_reg(parentIndex+3) += -w * r_edge[0];
-                b_reg(parentIndex+4) += -w * r_edge[1];
-                b_reg(parentIndex+5) += -w * r_edge[2];
-
-                int childIndex = baseIndices[l+1]+6*child;
-                Vec3f v2 = childTranslation.cross(r_edge);
-                b_reg(childIndex+0) += w * v2[0];
-                b_reg(childIndex+1) += w * v2[1];
-                b_reg(childIndex+2) += w * v2[2];
-                b_reg(childIndex+3) += w * r_edge[0];
-                b_reg(childIndex+4) += w * r_edge[1];
-                b_reg(childIndex+5) += w * r_edge[2];
-
-
-                Matx33f Tj_Vj_Vi_cross(0, -transformedChild[2], transformedChild[1],
-                                       transformedChild[2], 0, -transformedChild[0],
-                                       -transformedChild[1], transformedChild[0], 0);
-                Matx33f tj_cross(0, -childTranslation[2], childTranslation[1],
-                                 childTranslation[2], 0, -childTranslation[0],
-                                 -childTranslation[1], childTranslation[0], 0);
-
-                // place top left elements
-                Matx33f top_left = Tj_Vj_Vi_cross * tj_cross;
-                for(int i = 0; i < 3; i++)
-                    for (int j = 0; j < 3; j++)
-                    {
-                        A_reg(parentIndex+i, childIndex+j) += w * top_left(i, j);
-                        A_reg(childIndex+i, parentIndex+j) += w * top_left(i, j);
-                    }
 
-                // place top right elements
-                for(int i = 0; i < 3; i++)
-                    for(int j = 0; j < 3; j++)
-                    {
-                        A_reg(parentIndex+i, childIndex+j+3) += - w * Tj_Vj_Vi_cross(i, j);
-                        A_reg(childIndex+i, parentIndex+j+3) += - w * Tj_Vj_Vi_cross(i, j);
-                    }
+                int childBlock = (baseIndices[l+1]+6*child) / 6;
 
-                // place bottom left elements
+                Matx33f R_i = nodeTransform.rotation();
+                Matx33f R_j = childNode->transform.rotation();
+                Matx<float, 3, 6> J_i, J_j;
+                Matx33f J_rot = -(R_i * skew(childPos - nodePos));
                 for(int i = 0; i < 3; i++)
                     for(int j = 0; j < 3; j++)
                     {
-                        A_reg(parentIndex+i+3, childIndex+j) += w * tj_cross(i, j);
-                        A_reg(childIndex+i+3, parentIndex+j) += w * tj_cross(i, j);
+                        J_i(i, j) = J_rot(i, j);
+                        J_i(i, j+3) = R_i(i, j);
+                        J_j(i, j+3) = -R_j(i, j);
                     }
 
-                // place bottom right elements (which is -I_3)
-                for(int i = 0; i < 3; i++)
+                Matx<float, 6, 3> J_iT = J_i.t(), J_jT = J_j.t();
+                Matx66f A_ij = w * (J_iT * J_j);
+                A.refBlock(parentBlock, parentBlock) += w * (J_iT * J_i);
+                A.refBlock(childBlock, childBlock) += w * (J_jT * J_j);
+                A.refBlock(parentBlock, childBlock) += A_ij;
+                A.refBlock(childBlock, parentBlock) += A_ij.t();
+
+                Vec<float, 6> b_i = J_iT * r_edge, b_j = J_jT * r_edge;
+                for(int row = 0; row < 6; row++)
                 {
-                    A_reg(parentIndex+i+3, childIndex+i+3) += -w;
-                    A_reg(childIndex+i+3, parentIndex+i+3) += -w;
+                    b[6*parentBlock+row] += -w * b_i[row];
+                    b[6*childBlock+row] += -w * b_j[row];
                 }
-
             }
         }
     }
 
-    std::vector<float> residuals;
-
     Mat Vg(oldPoints.size(), CV_32FC3, nan3);
 
     Mat Vc(oldPoints.size(), CV_32FC3, nan3);
     Mat Nc(oldPoints.size(), CV_32FC3, nan3);
+    Mat_<float> pixResiduals(oldPoints.size(), std::numeric_limits<float>::quiet_NaN());
     cv::kinfu::Intr::Projector proj = intrinsics.makeProjector();
 
-    for (int y = 0; y < oldPoints.size().height; y++)
+    parallel_for_(Range(0, oldPoints.rows), [&](const Range& range)
     {
-        for (int x = 0; x < oldPoints.size().width; x++)
+        for (int y = range.start; y < range.end; y++)
         {
-            // Obtain correspondence by projecting Tu_Vg
-            Vec3f curV = oldPoints.at<Vec3f>(y, x);
-            if (curV == Vec3f::all(0) || cvIsNaN(curV[0]) || cvIsNaN(curV[1]) || cvIsNaN(curV[2]))
-                continue;
-
-            Point2f newCoords = proj(oldPoints.at<Point3f>(y, x));
-            if(!(newCoords.x >= 0 && newCoords.x < newPoints.cols - 1 &&
-                 newCoords.y >= 0 && newCoords.y < newPoints.rows - 1))
-                continue;
-
-            // TODO: interpolate Vg instead of simply converting projected coords to int
-            Vg.at<Vec3f>(y, x) = vertImage.at<Vec3f>((int)newCoords.y, (int)newCoords.x);
+            for (int x = 0; x < oldPoints.size().width; x++)
+            {
+                // Obtain correspondence by projecting Tu_Vg
+                Vec3f curV = oldPoints.at<Vec3f>(y, x);
+                if (curV == Vec3f::all(0) || cvIsNaN(curV[0]) || cvIsNaN(curV[1]) || cvIsNaN(curV[2]))
+                    continue;
 
-            // bilinearly interpolate newPoints under newCoords point
-            int xi = cvFloor(newCoords.x), yi = cvFloor(newCoords.y);
-            float tx  = newCoords.x - xi, ty = newCoords.y - yi;
+                Point2f newCoords = proj(oldPoints.at<Point3f>(y, x));
+                if(!(newCoords.x >= 0 && newCoords.x < newPoints.cols - 1 &&
+                     newCoords.y >= 0 && newCoords.y < newPoints.rows - 1))
+                    continue;
 
-            const ptype* prow0 = newPoints.ptr<ptype>(yi+0);
-            const ptype* prow1 = newPoints.ptr<ptype>(yi+1);
+                // TODO: interpolate Vg instead of simply converting projected coords to int
+                Vg.at<Vec3f>(y, x) = vertImage.at<Vec3f>((int)newCoords.y, (int)newCoords.x);
 
-            Point3f p00 = fromPtype(prow0[xi+0]);
-            Point3f p01 = fromPtype(prow0[xi+1]);
-            Point3f p10 = fromPtype(prow1[xi+0]);
-            Point3f p11 = fromPtype(prow1[xi+1]);
+                // bilinearly interpolate newPoints under newCoords point
+                int xi = cvFloor(newCoords.x), yi = cvFloor(newCoords.y);
+                float tx  = newCoords.x - xi, ty = newCoords.y - yi;
 
-            //do not fix missing data
-            if(!(fastCheck(p00) && fastCheck(p01) &&
-                fastCheck(p10) && fastCheck(p11)))
-                continue;
+                const ptype* prow0 = newPoints.ptr<ptype>(yi+0);
+                const ptype* prow1 = newPoints.ptr<ptype>(yi+1);
 
-            Point3f p0 = p00 + tx*(p01 - p00);
-            Point3f p1 = p10 + tx*(p11 - p10);
-            Point3f newP = (p0 + ty*(p1 - p0));
+                Point3f p00 = fromPtype(prow0[xi+0]);
+                Point3f p01 = fromPtype(prow0[xi+1]);
+                Point3f p10 = fromPtype(prow1[xi+0]);
+                Point3f p11 = fromPtype(prow1[xi+1]);
 
-            const ptype* nrow0 = newNormals.ptr<ptype>(yi+0);
-            const ptype* nrow1 = newNormals.ptr<ptype>(yi+1);
+                //do not fix missing data
+                if(!(fastCheck(p00) && fastCheck(p01) &&
+                    fastCheck(p10) && fastCheck(p11)))
+                    continue;
 
-            Point3f n00 = fromPtype(nrow0[xi+0]);
-            Point3f n01 = fromPtype(nrow0[xi+1]);
-            Point3f n10 = fromPtype(nrow1[xi+0]);
-            Point3f n11 = fromPtype(nrow1[xi+1]);
+                Point3f p0 = p00 + tx*(p01 - p00);
+                Point3f p1 = p10 + tx*(p11 - p10);
+                Point3f newP = (p0 + ty*(p1 - p0));
 
-            if(!(fastCheck(n00) && fastCheck(n01) &&
-                fastCheck(n10) && fastCheck(n11)))
-                continue;
+                const ptype* nrow0 = newNormals.ptr<ptype>(yi+0);
+                const ptype* nrow1 = newNormals.ptr<ptype>(yi+1);
 
-            Point3f n0 = n00 + tx*(n01 - n00);
-            Point3f n1 = n10 + tx*(n11 - n10);
-            Point3f newN = n0 + ty*(n1 - n0);
+                Point3f n00 = fromPtype(nrow0[xi+0]);
+                Point3f n01 = fromPtype(nrow0[xi+1]);
+                Point3f n10 = fromPtype(nrow1[xi+0]);
+                Point3f n11 = fromPtype(nrow1[xi+1]);
 
-            Vc.at<Point3f>(y, x) = newP;
-            Nc.at<Point3f>(y, x) = newN;
+                if(!(fastCheck(n00) && fastCheck(n01) &&
+                    fastCheck(n10) && fastCheck(n11)))
+                    continue;
 
-            Vec3f diff = oldPoints.at<Vec3f>(y, x) - Vec3f(newP);
-            if(diff.dot(diff) > 0.0004f) continue;
-            if(abs(newN.dot(oldNormals.at<Point3f>(y, x))) < std::cos((float)CV_PI / 2)) continue;
+                Point3f n0 = n00 + tx*(n01 - n00);
+                Point3f n1 = n10 + tx*(n11 - n10);
+                Point3f newN = n0 + ty*(n1 - n0);
 
-            float rd = newN.dot(diff);
+                Vc.at<Point3f>(y, x) = newP;
+                Nc.at<Point3f>(y, x) = newN;
 
+                Vec3f diff = oldPoints.at<Vec3f>(y, x) - Vec3f(newP);
+                if(diff.dot(diff) > 0.0004f) continue;
+                if(abs(newN.dot(oldNormals.at<Point3f>(y, x))) < std::cos((float)CV_PI / 2)) continue;
 
-            residuals.push_back(rd);
+                pixResiduals(y, x) = newN.dot(diff);
+            }
+        }
+    });
 
+    // residuals are collected in the pixel order to get the same median regardless of the threads number
+    std::vector<float> residuals;
+    for (int y = 0; y < pixResiduals.rows; y++)
+    {
+        for (int x = 0; x < pixResiduals.cols; x++)
+        {
+            float rd = pixResiduals(y, x);
+            if (!cvIsNaN(rd))
+                residuals.push_back(rd);
         }
     }
 
     float med = median(residuals);
     std::for_each(residuals.begin(), residuals.end(), [med](float& x){x =  std::abs(x-med);});
-    std::cout << "median: " << med << " from " << residuals.size() << " residuals " << std::endl;
     float sigma = MAD_SCALE * median(residuals);
 
-    float total_error = 0;
-    int pix_count = 0;
+    // Data terms are accumulated in parallel over stripes of rows. The stripes are fixed and summed
+    // in order so that the result does not depend on the number of threads.
+    const int stripeRows = 8;
+    const int nStripes = (oldPoints.rows + stripeRows - 1) / stripeRows;
+    const int baseBlock = baseIndices[0] / 6;
+    std::vector<BlockSparseMat<float, 6, 6> > stripeA(nStripes, BlockSparseMat<float, 6, 6>(totalNodes));
+    std::vector<std::vector<Vec<float, 6> > > stripeB(nStripes);
+    std::vector<float> stripeError(nStripes, 0.f);
 
-    for(int y = 0; y < oldPoints.size().height; y++)
+    parallel_for_(Range(0, nStripes), [&](const Range& range)
     {
-        for(int x = 0; x < oldPoints.size().width; x++)
+        for (int stripe = range.start; stripe < range.end; stripe++)
         {
-            Vec3f curV = oldPoints.at<Vec3f>(y, x);
-            if (curV == Vec3f::all(0) || cvIsNaN(curV[0]))
-                continue;
+            BlockSparseMat<float, 6, 6>& sA = stripeA[stripe];
+            std::vector<Vec<float, 6> >& sB = stripeB[stripe];
+            sB.assign(warpNodes.size(), Vec<float, 6>::all(0));
 
-            Vec3f V = Vg.at<Vec3f>(y, x);
-            if (V == Vec3f::all(0) || cvIsNaN(V[0]))
-                continue;
+            for(int y = stripe*stripeRows; y < std::min((stripe+1)*stripeRows, oldPoints.rows); y++)
+            {
+                for(int x = 0; x < oldPoints.size().width; x++)
+                {
+                    Vec3f curV = oldPoints.at<Vec3f>(y, x);
+                    if (curV == Vec3f::all(0) || cvIsNaN(curV[0]))
+                        continue;
 
-            V[0] *= volume->volResolution.x;
-            V[1] *= volume->volResolution.y;
-            V[2] *= volume->volResolution.z;
+                    Vec3f V = Vg.at<Vec3f>(y, x);
+                    if (V == Vec3f::all(0) || cvIsNaN(V[0]))
+                        continue;
 
-            if(!fastCheck(Vc.at<Point3f>(y, x)))
-                continue;
+                    V[0] *= volume->volResolution.x;
+                    V[1] *= volume->volResolution.y;
+                    V[2] *= volume->volResolution.z;
 
-            if(!fastCheck(Nc.at<Point3f>(y, x)))
-                continue;
+                    if(!fastCheck(Vc.at<Point3f>(y, x)))
+                        continue;
 
-            Point3i p((int)V[0], (int)V[1], (int)V[2]);
-            Vec3f diff = oldPoints.at<Vec3f>(y, x) - Vc.at<Vec3f>(y, x);
+                    if(!fastCheck(Nc.at<Point3f>(y, x)))
+                        continue;
 
-            float rd = Nc.at<Vec3f>(y, x).dot(diff);
+                    Point3i p((int)V[0], (int)V[1], (int)V[2]);
+                    Vec3f diff = oldPoints.at<Vec3f>(y, x) - Vc.at<Vec3f>(y, x);
 
-            total_error += tukeyWeight(rd, sigma) * rd * rd;
-            pix_count++;
+                    float rd = Nc.at<Vec3f>(y, x).dot(diff);
 
-            int n;
-            nodeNeighboursType neighbours = volume->getVoxelNeighbours(p, n);
-            float totalNeighbourWeight = 0.f;
-            float neighWeights[DYNAFU_MAX_NEIGHBOURS];
-            for (int i = 0; i < n; i++)
-            {
-                int neigh = neighbours[i];
-                neighWeights[i] = warpNodes[neigh]->weight(Point3f(V)*volume->voxelSize);
+                    float robustWeight = tukeyWeight(rd, sigma);
+                    stripeError[stripe] += robustWeight * rd * rd;
 
-                totalNeighbourWeight += neighWeights[i];
-            }
-
-            if(totalNeighbourWeight < 1e-5) continue;
+                    int n;
+                    nodeNeighboursType neighbours = volume->getVoxelNeighbours(p, n);
+                    float totalNeighbourWeight = 0.f;
+                    float neighWeights[DYNAFU_MAX_NEIGHBOURS];
+                    for (int i = 0; i < n; i++)
+                    {
+                        int neigh = neighbours[i];
+                        neighWeights[i] = warpNodes[neigh]->weight(Point3f(V)*volume->voxelSize);
 
-            for (int i = 0; i < n; i++)
-            {
-                if(neighWeights[i] < 0.01) continue;
-                int neigh = neighbours[i];
+                        totalNeighbourWeight += neighWeights[i];
+                    }
 
-                Vec3f Tj_Vg_Vj = (warpNodes[neigh]->transform *
-                                 (Point3f(V)*volume->voxelSize - warpNodes[neigh]->pos));
+                    if(totalNeighbourWeight < 1e-5) continue;
 
-                Matx33f Tj_Vg_Vj_x(0, -Tj_Vg_Vj[2], Tj_Vg_Vj[1],
-                                   Tj_Vg_Vj[2], 0, -Tj_Vg_Vj[0],
-                                   -Tj_Vg_Vj[1], Tj_Vg_Vj[0], 0);
+                    Vec3f v2 = T_lw.rotation().t() * Nc.at<Vec3f>(y, x);
 
-                Vec3f v1 = (Tj_Vg_Vj_x * T_lw.rotation().t()) * Nc.at<Vec3f>(y, x);
-                Vec3f v2 = T_lw.rotation().t() * Nc.at<Vec3f>(y, x);
+                    for (int i = 0; i < n; i++)
+                    {
+                        if(neighWeights[i] < 0.01) continue;
+                        int neigh = neighbours[i];
 
-                Matx61f J_dataT(v1[0], v1[1], v1[2], v2[0], v2[1], v2[2]);
-                Matx16f J_data = J_dataT.t();
-                Matx66f H_data = J_dataT * J_data;
+                        Vec3f Tj_Vg_Vj = (warpNodes[neigh]->transform *
+                                         (Point3f(V)*volume->voxelSize - warpNodes[neigh]->pos));
 
-                float w = (neighWeights[i] / totalNeighbourWeight);
+                        Vec3f v1 = (skew(Tj_Vg_Vj) * T_lw.rotation().t()) * Nc.at<Vec3f>(y, x);
 
-                float robustWeight = tukeyWeight(rd, sigma);
+                        Matx61f J_dataT(v1[0], v1[1], v1[2], v2[0], v2[1], v2[2]);
+                        Matx16f J_data = J_dataT.t();
+                        Matx66f H_data = J_dataT * J_data;
 
-                int blockIndex = baseIndices[0]+6*neigh;
-                for(int row = 0; row < 6; row++)
-                    for(int col = 0; col < 6; col++)
-                        A_reg(blockIndex+row, blockIndex+col) += robustWeight * w * w * H_data(row, col);
+                        float w = (neighWeights[i] / totalNeighbourWeight);
 
-                for(int row = 0; row < 6; row++)
-                    b_reg(blockIndex+row) += -robustWeight * rd * w * J_dataT(row);
+                        sA.refBlock(baseBlock+neigh, baseBlock+neigh) += (robustWeight * w * w) * H_data;
+                        for(int row = 0; row < 6; row++)
+                            sB[neigh][row] += -robustWeight * rd * w * J_dataT(row);
+                    }
+                }
             }
-
         }
+    });
+
+    float total_error = 0;
+    for(int stripe = 0; stripe < nStripes; stripe++)
+    {
+        A += stripeA[stripe];
+        for(size_t i = 0; i < warpNodes.size(); i++)
+            for(int row = 0; row < 6; row++)
+                b[baseIndices[0]+6*i+row] += stripeB[stripe][i][row];
+        total_error += stripeError[stripe];
     }
+    CV_LOG_DEBUG(NULL, "Data energy: " << total_error << " from " << residuals.size() << " residuals");
 
-    double det = determinant(A_reg);
-    std::cout << "A_reg det:" << det  << std::endl;
+    // Nodes without any data or edge terms are kept in place
+    const float damping = 1e-6f;
+    for(int i = 0; i < totalNodes; i++)
+        A.refBlock(i, i) += damping * Matx66f::eye();
 
-    std::cout << "Solving " << 6*totalNodes << std::endl;
-    Mat_<float> nodeTwists(6*totalNodes, 1, 0.f);
-    bool result = solve(A_reg, b_reg, nodeTwists, DECOMP_SVD);
-    std::cout << "Done " << result << std::endl;
+    std::vector<float> nodeTwists;
+    BlockSparseCholesky<float, 6> solver;
+    solver.analyzePattern(A);
+    if(solver.factorize(A))
+    {
+        solver.solve(b, nodeTwists);
+    }
+    else
+    {
+        CV_LOG_INFO(NULL, "Warp field normal equations are not positive definite, solving them densely");
+        Mat_<float> denseA(6*totalNodes, 6*totalNodes, 0.f);
+        for(const auto& ijv : A.ijValue)
+        {
+            Mat(ijv.second).copyTo(denseA(Rect(6*ijv.first.y, 6*ijv.first.x, 6, 6)));
+        }
+        Mat_<float> x;
+        if(!solve(denseA, Mat(b), x, DECOMP_SVD))
+            return false;
+        x.copyTo(nodeTwists);
+    }
 
     for(int i = 0; i < (int)warpNodes.size(); i++)
     {
         int idx = baseIndices[0]+6*i;
-        Vec3f r(nodeTwists(idx), nodeTwists(idx+1), nodeTwists(idx+2));
-        Vec3f t(nodeTwists(idx+3), nodeTwists(idx+4), nodeTwists(idx+5));
+        Vec3f r(nodeTwists[idx], nodeTwists[idx+1], nodeTwists[idx+2]);
+        Vec3f t(nodeTwists[idx+3], nodeTwists[idx+4], nodeTwists[idx+5]);
         Affine3f tinc(r, t);
         warpNodes[i]->transform = warpNodes[i]->transform * tinc;
     }
 
-    std::cout << "Nan count: " << "/" << warpNodes.size() << "\n" << std::endl;
-
     return true;
 }
 
@@ -614,16 +614,87 @@ void calcICPEquationCoeffsTranslation(double* C, const Point3f& /*p0*/, const Ve
 typedef
 void (*CalcICPEquationCoeffsPtr)(double*, const Point3f&, const Vec3f&);
 
+// Sums A^T*A and A^T*b over the equations in parallel.
+// coeffs(i, A, b) fills transformDim coefficients and the right side of i-th equation.
+// Partial sums are taken over fixed blocks and added in their order,
+// so the result does not depend on the number of threads.
+template<typename CoeffsFunc>
+static
+void accumulateLsm(int count, int transformDim, const CoeffsFunc& coeffs, Mat& AtA, Mat& AtB)
+{
+    CV_Assert(transformDim <= 6);
+
+    const int blockSize = 1024;
+    const int nBlocks = (count + blockSize - 1) / blockSize;
+    std::vector<Matx66d> blockAtA(nBlocks);
+    std::vector<Vec6d> blockAtB(nBlocks);
+
+    parallel_for_(Range(0, nBlocks), [&](const Range& range)
+    {
+        for(int bi = range.start; bi < range.end; bi++)
+        {
+            double* ata = blockAtA[bi].val;
+            double* atb = blockAtB[bi].val;
+            double A[6] = { 0, 0, 0, 0, 0, 0 };
+            double b = 0;
+            int end = std::min(count, (bi + 1) * blockSize);
+            for(int i = bi * blockSize; i < end; i++)
+            {
+                coeffs(i, A, b);
+#if CV_SIMD128_64F
+                if(transformDim == 6)
+                {
+                    v_float64x2 a01 = v_load(A), a23 = v_load(A + 2), a45 = v_load(A + 4);
+                    for(int y = 0; y < 6; y++)
+                    {
+                        v_float64x2 ay = v_setall_f64(A[y]);
+                        double* row = ata + y * 6;
+                        v_store(row,     v_muladd(ay, a01, v_load(row)));
+                        v_store(row + 2, v_muladd(ay, a23, v_load(row + 2)));
+                        v_store(row + 4, v_muladd(ay, a45, v_load(row + 4)));
+                    }
+                    v_float64x2 vb = v_setall_f64(b);
+                    v_store(atb,     v_muladd(vb, a01, v_load(atb)));
+                    v_store(atb + 2, v_muladd(vb, a23, v_load(atb + 2)));
+                    v_store(atb + 4, v_muladd(vb, a45, v_load(atb + 4)));
+                    continue;
+                }
+#endif
+                for(int y = 0; y < transformDim; y++)
+                {
+                    double* row = ata + y * 6;
+                    for(int x = 0; x < transformDim; x++)
+                        row[x] += A[y] * A[x];
+
+                    atb[y] += A[y] * b;
+                }
+            }
+        }
+    });
+
+    AtA = Mat(transformDim, transformDim, CV_64FC1, Scalar(0));
+    AtB = Mat(transformDim, 1, CV_64FC1, Scalar(0));
+    Matx66d sumAtA;
+    Vec6d sumAtB;
+    for(int bi = 0; bi < nBlocks; bi++)
+    {
+        sumAtA += blockAtA[bi];
+        sumAtB += blockAtB[bi];
+    }
+    for(int y = 0; y < transformDim; y++)
+    {
+        for(int x = 0; x < transformDim; x++)
+            AtA.at<double>(y, x) = sumAtA(y, x);
+        AtB.at<double>(y) = sumAtB[y];
+    }
+}
+
 static
 void calcRgbdLsmMatrices(const Mat& image0, const Mat& cloud0, const Mat& Rt,
                const Mat& image1, const Mat& dI_dx1, const Mat& dI_dy1,
                const Mat& corresps, double fx, double fy, double sobelScaleIn,
                Mat& AtA, Mat& AtB, CalcRgbdEquationCoeffsPtr func, int transformDim)
 {
-    AtA = Mat(transformDim, transformDim, CV_64FC1, Scalar(0));
-    AtB = Mat(transformDim, 1, CV_64FC1, Scalar(0));
-    double* AtB_ptr = AtB.ptr<double>();
-
     const int correspsCount = corresps.rows;
 
     CV_Assert(Rt.type() == CV_64FC1);
@@ -647,10 +718,7 @@ void calcRgbdLsmMatrices(const Mat& image0, const Mat& cloud0, const Mat& Rt,
     }
     sigma = std::sqrt(sigma/correspsCount);
 
-    std::vector<double> A_buf(transformDim);
-    double* A_ptr = &A_buf[0];
-
-    for(int correspIndex = 0; correspIndex < corresps.rows; correspIndex++)
+    accumulateLsm(correspsCount, transformDim, [&](int correspIndex, double* A_ptr, double& b)
     {
          const Vec4i& c = corresps_ptr[correspIndex];
          int u0 = c[0], v0 = c[1];
@@ -672,19 +740,8 @@ void calcRgbdLsmMatrices(const Mat& image0, const Mat& cloud0, const Mat& Rt,
               w_sobelScale * dI_dy1.at<short int>(v1,u1),
               tp0, fx, fy);
 
-        for(int y = 0; y < transformDim; y++)
-        {
-            double* AtA_ptr = AtA.ptr<double>(y);
-            for(int x = y; x < transformDim; x++)
-                AtA_ptr[x] += A_ptr[y] * A_ptr[x];
-
-            AtB_ptr[y] += A_ptr[y] * w * diffs_ptr[correspIndex];
-        }
-    }
-
-    for(int y = 0; y < transformDim; y++)
-        for(int x = y+1; x < transformDim; x++)
-            AtA.at<double>(x,y) = AtA.at<double>(y,x);
+         b = w * diffs_ptr[correspIndex];
+    }, AtA, AtB);
 }
 
 static
@@ -693,10 +750,6 @@ void calcICPLsmMatrices(const Mat& cloud0, const Mat& Rt,
                         const Mat& corresps,
                         Mat& AtA, Mat& AtB, CalcICPEquationCoeffsPtr func, int transformDim)
 {
-    AtA = Mat(transformDim, transformDim, CV_64FC1, Scalar(0));
-    AtB = Mat(transformDim, 1, CV_64FC1, Scalar(0));
-    double* AtB_ptr = AtB.ptr<double>();
-
     const int correspsCount = corresps.rows;
 
     CV_Assert(Rt.type() == CV_64FC1);
@@ -733,9 +786,7 @@ void calcICPLsmMatrices(const Mat& cloud0, const Mat& Rt,
 
     sigma = std::sqrt(sigma/correspsCount);
 
-    std::vector<double> A_buf(transformDim);
-    double* A_ptr = &A_buf[0];
-    for(int correspIndex = 0; correspIndex < corresps.rows; correspIndex++)
+    accumulateLsm(correspsCount, transformDim, [&](int correspIndex, double* A_ptr, double& b)
     {
         const Vec4i& c = corresps_ptr[correspIndex];
         int u1 = c[2], v1 = c[3];
@@ -745,19 +796,8 @@ void calcICPLsmMatrices(const Mat& cloud0, const Mat& Rt,
 
         func(A_ptr, tps0_ptr[correspIndex], normals1.at<Vec3f>(v1, u1) * w);
 
-        for(int y = 0; y < transformDim; y++)
-        {
-            double* AtA_ptr = AtA.ptr<double>(y);
-            for(int x = y; x < transformDim; x++)
-                AtA_ptr[x] += A_ptr[y] * A_ptr[x];
-
-            AtB_ptr[y] += A_ptr[y] * w * diffs_ptr[correspIndex];
-        }
-    }
-
-    for(int y = 0; y < transformDim; y++)
-        for(int x = y+1; x < transformDim; x++)
-            AtA.at<double>(x,y) = AtA.at<double>(y,x);
+        b = w * diffs_ptr[correspIndex];
+    }, AtA, AtB);
 }
 
 static
@@ -1039,6 +1079,69 @@ void OdometryFrame::releasePyramids()
     pyramidNormalsMask.clear();
 }
 
+void OdometryFrame::releaseMasks()
+{
+    pyramidMask.clear();
+    pyramidTexturedMask.clear();
+    pyramidNormalsMask.clear();
+}
+
+void OdometryFrame::preparePyramids(const Mat& cameraMatrix, int levels, int cacheType)
+{
+    CV_TRACE_FUNCTION();
+
+    CV_Assert(levels > 0);
+    CV_Assert(cameraMatrix.size() == Size(3,3) && (cameraMatrix.type() == CV_32FC1 || cameraMatrix.type() == CV_64FC1));
+    checkDepth(depth, depth.size());
+    if(!image.empty())
+        checkImage(image);
+
+    const bool withImage = !image.empty();
+    const bool withDst = (cacheType & CACHE_DST) != 0;
+
+    // independent chains are built at the same time, each task writes its own pyramid only
+    parallel_for_(Range(0, 2), [&](const Range& range)
+    {
+        for(int task = range.start; task < range.end; task++)
+        {
+            if(task == 0)
+                preparePyramidDepth(depth, pyramidDepth, levels);
+            else if(withImage)
+                preparePyramidImage(image, pyramidImage, levels);
+        }
+    });
+
+    parallel_for_(Range(0, 3), [&](const Range& range)
+    {
+        for(int task = range.start; task < range.end; task++)
+        {
+            if(task == 0)
+                preparePyramidCloud(pyramidDepth, cameraMatrix, pyramidCloud);
+            else if(withImage && withDst)
+                preparePyramidSobel(pyramidImage, task == 1 ? 1 : 0, task == 1 ? 0 : 1,
+                                    task == 1 ? pyramid_dI_dx : pyramid_dI_dy);
+        }
+    });
+
+    if(withDst)
+    {
+        if(normals.empty())
+        {
+            if(!pyramidNormals.empty())
+                normals = pyramidNormals[0];
+            else
+            {
+                RgbdNormals normalsComputer(depth.rows, depth.cols, depth.depth(), cameraMatrix,
+                                            normalWinSize, normalMethod);
+                normalsComputer(pyramidCloud[0], normals);
+            }
+        }
+        checkNormals(normals, depth.size());
+
+        preparePyramidNormals(normals, pyramidDepth, pyramidNormals);
+    }
+}
+
 bool Odometry::compute(const Mat& srcImage, const Mat& srcDepth, const Mat& srcMask,
                        const Mat& dstImage, const Mat& dstDepth, const Mat& dstMask,
                        OutputArray Rt, const Mat& initRt) const
@@ -40,8 +40,6 @@ static inline cv::Matx44d m_right(cv::Quatd q)
              z,  y, -x,  w };
 }
 
-// precaution against "unused function" warning when there's no Eigen
-#if defined(HAVE_EIGEN)
 // jacobian of quaternionic (exp(x)*q) : R_3 -> H near x == 0
 static inline cv::Matx43d expQuatJacobian(cv::Quatd q)
 {
@@ -51,7 +49,6 @@ static inline cv::Matx43d expQuatJacobian(cv::Quatd q)
                        -z,  w,  x,
                         y, -x,  w);
 }
-#endif
 
 // concatenate matrices vertically
 template<typename _Tp, int m, int n, int k> static inline
@@ -359,6 +356,13 @@ bool PoseGraphImpl::isValid() const
     if (!numNodes || !numEdges)
         return false;
 
+    std::unordered_map<size_t, std::vector<size_t>> adjacency;
+    for (const Edge& e : edges)
+    {
+        adjacency[e.sourceNodeId].push_back(e.targetNodeId);
+        adjacency[e.targetNodeId].push_back(e.sourceNodeId);
+    }
+
     std::unordered_set<size_t> nodesVisited;
     std::vector<size_t> nodesToVisit;
 
@@ -369,27 +373,17 @@ bool PoseGraphImpl::isValid() const
     {
         size_t currNodeId = nodesToVisit.back();
         nodesToVisit.pop_back();
-        nodesVisited.insert(currNodeId);
-        // Since each node does not maintain its neighbor list
-        for (size_t i = 0; i < numEdges; i++)
-        {
-            const Edge& potentialEdge = edges.at(i);
-            size_t nextNodeId = (size_t)(-1);
+        if (!nodesVisited.insert(currNodeId).second)
+            continue;
 
-            if (potentialEdge.sourceNodeId == currNodeId)
-            {
-                nextNodeId = potentialEdge.targetNodeId;
-            }
-            else if (potentialEdge.targetNodeId == currNodeId)
-            {
-                nextNodeId = potentialEdge.sourceNodeId;
-            }
-            if (nextNodeId != (size_t)(-1))
+        auto it = adjacency.find(currNodeId);
+        if (it == adjacency.end())
+            continue;
+        for (size_t nextNodeId : it->second)
+        {
+            if (nodesVisited.count(nextNodeId) == 0)
             {
-                if (nodesVisited.count(nextNodeId) == 0)
-                {
-                    nodesToVisit.push_back(nextNodeId);
-                }
+                nodesToVisit.push_back(nextNodeId);
             }
         }
     }
@@ -499,26 +493,31 @@ double PoseGraphImpl::calcEnergy() const
 // estimate current energy
 double PoseGraphImpl::calcEnergyNodes(const std::map<size_t, Node>& newNodes) const
 {
-    double totalErr = 0;
-    for (const auto& e : edges)
+    // errors are summed up sequentially to get the same result regardless of the threads number
+    std::vector<double> edgeErrors(edges.size());
+    parallel_for_(Range(0, (int)edges.size()), [&](const Range& range)
     {
-        Pose3d srcP = newNodes.at(e.sourceNodeId).pose;
-        Pose3d tgtP = newNodes.at(e.targetNodeId).pose;
+        for (int i = range.start; i < range.end; i++)
+        {
+            const Edge& e = edges[i];
+            Pose3d srcP = newNodes.at(e.sourceNodeId).pose;
+            Pose3d tgtP = newNodes.at(e.targetNodeId).pose;
 
-        Vec6d res;
-        Matx<double, 6, 3> stj, ttj;
-        Matx<double, 6, 4> sqj, tqj;
-        double err = poseError(srcP.q, srcP.t, tgtP.q, tgtP.t, e.pose.q, e.pose.t, e.sqrtInfo,
-                               /* needJacobians = */ false, sqj, stj, tqj, ttj, res);
+            Vec6d res;
+            Matx<double, 6, 3> stj, ttj;
+            Matx<double, 6, 4> sqj, tqj;
+            edgeErrors[i] = poseError(srcP.q, srcP.t, tgtP.q, tgtP.t, e.pose.q, e.pose.t, e.sqrtInfo,
+                                      /* needJacobians = */ false, sqj, stj, tqj, ttj, res);
+        }
+    });
 
+    double totalErr = 0;
+    for (double err : edgeErrors)
         totalErr += err;
-    }
     return totalErr * 0.5;
 };
 
 
-#if defined(HAVE_EIGEN)
-
 // from Ceres, equation energy change:
 // eq. energy = 1/2 * (residuals + J * step)^2 =
 // 1/2 * ( residuals^2 + 2 * residuals^T * J * step + (J*step)^T * J * step)
@@ -573,6 +572,15 @@ static inline void doJacobiScaling(BlockSparseMat<double, 6, 6>& jtj, std::vecto
 }
 
 
+// J^T*J and J^T*b contributions of one edge
+struct EdgeTerms
+{
+    size_t srcPlace, dstPlace;
+    Matx66d ss, tt, st;
+    Vec6d bs, bt;
+};
+
+
 int PoseGraphImpl::optimize(const cv::TermCriteria& tc)
 {
     if (!isValid())
@@ -614,6 +622,10 @@ int PoseGraphImpl::optimize(const cv::TermCriteria& tc)
     size_t nVars = nVarNodes * 6;
     BlockSparseMat<double, 6, 6> jtj(nVarNodes);
     std::vector<double> jtb(nVars);
+    // the block pattern of J^T*J stays the same between iterations,
+    // so the ordering and the structure of the factor are computed once
+    BlockSparseCholesky<double, 6> cholesky;
+    std::vector<EdgeTerms> edgeTerms(numEdges);
 
     double energy = calcEnergyNodes(nodes);
     double oldEnergy = energy;
@@ -654,75 +666,97 @@ int PoseGraphImpl::optimize(const cv::TermCriteria& tc)
     bool done = false;
     while (!done)
     {
-        jtj.clear();
+        // keep the block pattern, just zero the values
+        for (auto& ijv : jtj.ijValue)
+        {
+            ijv.second = Matx66d::zeros();
+        }
         std::fill(jtb.begin(), jtb.end(), 0.0);
 
         // caching nodes jacobians
-        std::vector<cv::Matx<double, 7, 6>> cachedJac;
-        for (auto id : placesIds)
+        std::vector<cv::Matx<double, 7, 6>> cachedJac(nVarNodes);
+        for (size_t i = 0; i < nVarNodes; i++)
         {
-            Pose3d p = nodes.at(id).pose;
+            Pose3d p = nodes.at(placesIds[i]).pose;
             Matx43d qj = expQuatJacobian(p.q);
             // x node layout is (rot_x, rot_y, rot_z, trans_x, trans_y, trans_z)
             // pose layout is (q_w, q_x, q_y, q_z, trans_x, trans_y, trans_z)
-            Matx<double, 7, 6> j = concatVert(concatHor(qj, Matx43d()),
-                                              concatHor(Matx33d(), Matx33d::eye()));
-            cachedJac.push_back(j);
+            cachedJac[i] = concatVert(concatHor(qj, Matx43d()),
+                                      concatHor(Matx33d(), Matx33d::eye()));
         }
 
-        // fill jtj and jtb
-        for (const auto& e : edges)
+        // calculate edge contributions in parallel
+        parallel_for_(Range(0, (int)numEdges), [&](const Range& range)
         {
-            size_t srcId = e.sourceNodeId, dstId = e.targetNodeId;
-            const Node& srcNode = nodes.at(srcId);
-            const Node& dstNode = nodes.at(dstId);
+            for (int ei = range.start; ei < range.end; ei++)
+            {
+                const Edge& e = edges[ei];
+                EdgeTerms& et = edgeTerms[ei];
+                size_t srcId = e.sourceNodeId, dstId = e.targetNodeId;
+                const Node& srcNode = nodes.at(srcId);
+                const Node& dstNode = nodes.at(dstId);
+
+                Pose3d srcP = srcNode.pose;
+                Pose3d tgtP = dstNode.pose;
+
+                Vec6d res;
+                Matx<double, 6, 3> stj, ttj;
+                Matx<double, 6, 4> sqj, tqj;
+                poseError(srcP.q, srcP.t, tgtP.q, tgtP.t, e.pose.q, e.pose.t, e.sqrtInfo,
+                          /* needJacobians = */ true, sqj, stj, tqj, ttj, res);
+
+                et.srcPlace = (size_t)(-1), et.dstPlace = (size_t)(-1);
+                Matx66d sj, tj;
+                if (!srcNode.isFixed)
+                {
+                    et.srcPlace = idToPlace.at(srcId);
+                    sj = concatHor(sqj, stj) * cachedJac[et.srcPlace];
+                    et.ss = sj.t() * sj;
+                    et.bs = sj.t() * res;
+                }
 
-            Pose3d srcP = srcNode.pose;
-            Pose3d tgtP = dstNode.pose;
-            bool srcFixed = srcNode.isFixed;
-            bool dstFixed = dstNode.isFixed;
+                if (!dstNode.isFixed)
+                {
+                    et.dstPlace = idToPlace.at(dstId);
+                    tj = concatHor(tqj, ttj) * cachedJac[et.dstPlace];
+                    et.tt = tj.t() * tj;
+                    et.bt = tj.t() * res;
+                }
 
-            Vec6d res;
-            Matx<double, 6, 3> stj, ttj;
-            Matx<double, 6, 4> sqj, tqj;
-            poseError(srcP.q, srcP.t, tgtP.q, tgtP.t, e.pose.q, e.pose.t, e.sqrtInfo,
-                      /* needJacobians = */ true, sqj, stj, tqj, ttj, res);
+                if (!(srcNode.isFixed || dstNode.isFixed))
+                {
+                    et.st = sj.t() * tj;
+                }
+            }
+        });
 
-            size_t srcPlace = (size_t)(-1), dstPlace = (size_t)(-1);
-            Matx66d sj, tj;
-            if (!srcFixed)
+        // fill jtj and jtb, sequentially to keep the summation order
+        for (const EdgeTerms& et : edgeTerms)
+        {
+            bool srcVar = (et.srcPlace != (size_t)(-1));
+            bool dstVar = (et.dstPlace != (size_t)(-1));
+            if (srcVar)
             {
-                srcPlace = idToPlace.at(srcId);
-                sj = concatHor(sqj, stj) * cachedJac[srcPlace];
-
-                jtj.refBlock(srcPlace, srcPlace) += sj.t() * sj;
-
-                Vec6f jtbSrc = sj.t() * res;
+                jtj.refBlock(et.srcPlace, et.srcPlace) += et.ss;
                 for (int i = 0; i < 6; i++)
                 {
-                    jtb[6 * srcPlace + i] += -jtbSrc[i];
+                    jtb[6 * et.srcPlace + i] += -et.bs[i];
                 }
             }
 
-            if (!dstFixed)
+            if (dstVar)
             {
-                dstPlace = idToPlace.at(dstId);
-                tj = concatHor(tqj, ttj) * cachedJac[dstPlace];
-
-                jtj.refBlock(dstPlace, dstPlace) += tj.t() * tj;
-
-                Vec6f jtbDst = tj.t() * res;
+                jtj.refBlock(et.dstPlace, et.dstPlace) += et.tt;
                 for (int i = 0; i < 6; i++)
                 {
-                    jtb[6 * dstPlace + i] += -jtbDst[i];
+                    jtb[6 * et.dstPlace + i] += -et.bt[i];
                 }
             }
 
-            if (!(srcFixed || dstFixed))
+            if (srcVar && dstVar)
             {
-                Matx66d sjttj = sj.t() * tj;
-                jtj.refBlock(srcPlace, dstPlace) += sjttj;
-                jtj.refBlock(dstPlace, srcPlace) += sjttj.t();
+                jtj.refBlock(et.srcPlace, et.dstPlace) += et.st;
+                jtj.refBlock(et.dstPlace, et.srcPlace) += et.st.t();
             }
         }
 
@@ -779,9 +813,17 @@ int PoseGraphImpl::optimize(const cv::TermCriteria& tc)
 
             CV_LOG_INFO(NULL, "sparse solve...");
 
-            // use double or convert everything to float
+            if (!cholesky.isAnalyzed())
+            {
+                cholesky.analyzePattern(jtj);
+            }
+
             std::vector<double> x;
-            bool solved = jtj.sparseSolve(jtb, x, false);
+            bool solved = cholesky.factorize(jtj);
+            if (solved)
+            {
+                cholesky.solve(jtb, x);
+            }
 
             CV_LOG_INFO(NULL, (solved ? "OK" : "FAIL"));
 
@@ -891,13 +933,6 @@ int PoseGraphImpl::optimize(const cv::TermCriteria& tc)
     return (found ? iter : -1);
 }
 
-#else
-int PoseGraphImpl::optimize(const cv::TermCriteria& /*tc*/)
-{
-    CV_Error(Error::StsNotImplemented, "Eigen library required for sparse matrix solve during pose graph optimization, dense solver is not implemented");
-}
-#endif
-
 
 Ptr<detail::PoseGraph> detail::PoseGraph::create()
 {
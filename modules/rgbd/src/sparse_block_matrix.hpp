@@ -2,8 +2,11 @@
 // It is subject to the license terms in the LICENSE file found in the top-level directory
 // of this distribution and at http://opencv.org/license.html
 
+#include <algorithm>
 #include <iostream>
+#include <set>
 #include <unordered_map>
+#include <vector>
 
 #include "opencv2/core/base.hpp"
 #include "opencv2/core/types.hpp"
@@ -196,5 +199,255 @@ struct BlockSparseMat
     IDtoBlockValueMap ijValue;
 };
 
+/*!
+ * \class BlockSparseCholesky
+ * Cholesky decomposition A = L*L^T of a symmetric positive definite BlockSparseMat.
+ * Each block is a dense supernode of the factor.
+ * analyzePattern() computes the minimum degree ordering of blocks and the block structure of L once,
+ * factorize() reuses them for any matrix with the same block pattern.
+ * Both triangles of A should be present.
+ */
+template<typename _Tp, size_t blockSize>
+struct BlockSparseCholesky
+{
+    typedef Matx<_Tp, blockSize, blockSize> MatType;
+    typedef Vec<_Tp, blockSize> VecType;
+    typedef BlockSparseMat<_Tp, blockSize, blockSize> SparseMatType;
+
+    BlockSparseCholesky() : nBlocks(0) {}
+
+    bool isAnalyzed() const { return nBlocks > 0; }
+
+    void analyzePattern(const SparseMatType& A)
+    {
+        nBlocks = A.nBlocks;
+        int n = (int)nBlocks;
+
+        std::vector<std::set<int>> adj(n);
+        for (const auto& ijv : A.ijValue)
+        {
+            int i = ijv.first.x, j = ijv.first.y;
+            if (i != j)
+            {
+                adj[i].insert(j);
+                adj[j].insert(i);
+            }
+        }
+
+        //! Greedy minimum degree on the elimination graph, the neighbours of an eliminated block
+        //! form a clique and give the rows of its column in L
+        perm.resize(n);
+        iperm.assign(n, -1);
+        std::vector<std::vector<int>> eliminated(n);
+        std::set<std::pair<size_t, int>> degrees;
+        for (int i = 0; i < n; i++)
+            degrees.insert({ adj[i].size(), i });
+
+        for (int k = 0; k < n; k++)
+        {
+            int v = degrees.begin()->second;
+            degrees.erase(degrees.begin());
+            perm[k] = v;
+            iperm[v] = k;
+
+            std::vector<int> nbrs(adj[v].begin(), adj[v].end());
+            for (int u : nbrs)
+            {
+                degrees.erase({ adj[u].size(), u });
+                adj[u].erase(v);
+            }
+            for (size_t a = 0; a < nbrs.size(); a++)
+            {
+                for (size_t b = a + 1; b < nbrs.size(); b++)
+                {
+                    adj[nbrs[a]].insert(nbrs[b]);
+                    adj[nbrs[b]].insert(nbrs[a]);
+                }
+            }
+            for (int u : nbrs)
+                degrees.insert({ adj[u].size(), u });
+            adj[v].clear();
+            eliminated[k] = std::move(nbrs);
+        }
+
+        colRows.resize(n);
+        for (int k = 0; k < n; k++)
+        {
+            std::vector<int>& rows = colRows[k];
+            rows.clear();
+            for (int v : eliminated[k])
+                rows.push_back(iperm[v]);
+            std::sort(rows.begin(), rows.end());
+        }
+    }
+
+    //! Returns false if the matrix is not positive definite
+    bool factorize(const SparseMatType& A)
+    {
+        CV_Assert(isAnalyzed() && A.nBlocks == nBlocks);
+        int n = (int)nBlocks;
+
+        diag.assign(n, MatType::zeros());
+        lower.resize(n);
+        for (int k = 0; k < n; k++)
+            lower[k].assign(colRows[k].size(), MatType::zeros());
+
+        for (const auto& ijv : A.ijValue)
+        {
+            int i = iperm[ijv.first.x], j = iperm[ijv.first.y];
+            if (i == j)
+                diag[i] += ijv.second;
+            else if (i > j)
+                lower[j][rowSlot(j, i)] += ijv.second;
+        }
+
+        for (int k = 0; k < n; k++)
+        {
+            if (!choleskyBlock(diag[k]))
+                return false;
+
+            std::vector<MatType>& col = lower[k];
+            const std::vector<int>& rows = colRows[k];
+            for (size_t a = 0; a < col.size(); a++)
+                col[a] = solveRightLowerT(diag[k], col[a]);
+
+            for (size_t a = 0; a < rows.size(); a++)
+            {
+                int r1 = rows[a];
+                MatType colAt = col[a].t();
+                diag[r1] -= col[a] * colAt;
+                for (size_t b = a + 1; b < rows.size(); b++)
+                {
+                    lower[r1][rowSlot(r1, rows[b])] -= col[b] * colAt;
+                }
+            }
+        }
+        return true;
+    }
+
+    void solve(const std::vector<_Tp>& b, std::vector<_Tp>& x) const
+    {
+        int n = (int)nBlocks;
+        CV_Assert(b.size() == nBlocks * blockSize);
+
+        std::vector<VecType> y(n);
+        for (int k = 0; k < n; k++)
+            y[k] = VecType(&b[perm[k] * blockSize]);
+
+        // L*y = b
+        for (int k = 0; k < n; k++)
+        {
+            y[k] = forwardSubst(diag[k], y[k]);
+            const std::vector<int>& rows = colRows[k];
+            for (size_t a = 0; a < rows.size(); a++)
+                y[rows[a]] -= lower[k][a] * y[k];
+        }
+
+        // L^T*x = y
+        for (int k = n - 1; k >= 0; k--)
+        {
+            const std::vector<int>& rows = colRows[k];
+            for (size_t a = 0; a < rows.size(); a++)
+                y[k] -= lower[k][a].t() * y[rows[a]];
+            y[k] = backSubstT(diag[k], y[k]);
+        }
+
+        x.resize(nBlocks * blockSize);
+        for (int k = 0; k < n; k++)
+        {
+            for (size_t i = 0; i < blockSize; i++)
+                x[perm[k] * blockSize + i] = y[k][(int)i];
+        }
+    }
+
+    size_t nBlocks;
+    //! new block index to the original one and back
+    std::vector<int> perm, iperm;
+    //! sorted rows of non-zero blocks below diagonal for each block column of L
+    std::vector<std::vector<int>> colRows;
+    std::vector<MatType> diag;
+    std::vector<std::vector<MatType>> lower;
+
+protected:
+    inline size_t rowSlot(int col, int row) const
+    {
+        const std::vector<int>& rows = colRows[col];
+        auto it = std::lower_bound(rows.begin(), rows.end(), row);
+        CV_DbgAssert(it != rows.end() && *it == row);
+        return it - rows.begin();
+    }
+
+    //! In-place dense Cholesky, keeps the lower triangle
+    static bool choleskyBlock(MatType& m)
+    {
+        const int bs = (int)blockSize;
+        for (int j = 0; j < bs; j++)
+        {
+            _Tp d = m(j, j);
+            for (int k = 0; k < j; k++)
+                d -= m(j, k) * m(j, k);
+            if (!(d > 0))
+                return false;
+            _Tp ljj = std::sqrt(d);
+            m(j, j) = ljj;
+            for (int i = j + 1; i < bs; i++)
+            {
+                _Tp v = m(i, j);
+                for (int k = 0; k < j; k++)
+                    v -= m(i, k) * m(j, k);
+                m(i, j) = v / ljj;
+                m(j, i) = 0;
+            }
+        }
+        return true;
+    }
+
+    //! B * L^-T for lower triangular L
+    static MatType solveRightLowerT(const MatType& L, const MatType& B)
+    {
+        const int bs = (int)blockSize;
+        MatType X;
+        for (int r = 0; r < bs; r++)
+        {
+            for (int i = 0; i < bs; i++)
+            {
+                _Tp v = B(r, i);
+                for (int j = 0; j < i; j++)
+                    v -= L(i, j) * X(r, j);
+                X(r, i) = v / L(i, i);
+            }
+        }
+        return X;
+    }
+
+    static VecType forwardSubst(const MatType& L, const VecType& b)
+    {
+        const int bs = (int)blockSize;
+        VecType x;
+        for (int i = 0; i < bs; i++)
+        {
+            _Tp v = b[i];
+            for (int j = 0; j < i; j++)
+                v -= L(i, j) * x[j];
+            x[i] = v / L(i, i);
+        }
+        return x;
+    }
+
+    static VecType backSubstT(const MatType& L, const VecType& b)
+    {
+        const int bs = (int)blockSize;
+        VecType x;
+        for (int i = bs - 1; i >= 0; i--)
+        {
+            _Tp v = b[i];
+            for (int j = i + 1; j < bs; j++)
+                v -= L(j, i) * x[j];
+            x[i] = v / L(i, i);
+        }
+        return x;
+    }
+};
+
 }  // namespace kinfu
 }  // namespace cv
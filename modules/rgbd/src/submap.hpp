@@ -523,6 +523,9 @@ void SubmapManager<MatType>::PoseGraphToMap(const Ptr<detail::PoseGraph>& update
 {
     for(const auto& currSubmap : submapList)
     {
+        // submaps created after the pose graph was built
+        if(!updatedPoseGraph->isNodeExist(currSubmap->id))
+            continue;
         Affine3d pose = updatedPoseGraph->getNodePose(currSubmap->id);
         if(!updatedPoseGraph->isNodeFixed(currSubmap->id))
             currSubmap->pose = pose;
@@ -7,6 +7,7 @@
 #include "precomp.hpp"
 //#include "tsdf.hpp"
 #include "tsdf_functions.hpp"
+#include "bricked_tsdf.hpp"
 #include "opencl_kernels_rgbd.hpp"
 
 namespace cv {
@@ -1138,6 +1139,10 @@ Ptr<TSDFVolume> makeTSDFVolume(float _voxelSize, Matx44f _pose, float _raycastSt
 
 Ptr<TSDFVolume> makeTSDFVolume(const VolumeParams& _params)
 {
+    if (_params.bricked)
+        return makePtr<TSDFVolumeBrickedCPU>(_params.voxelSize, _params.pose.matrix, _params.raycastStepFactor,
+                                             _params.tsdfTruncDist, _params.maxWeight, _params.resolution,
+                                             _params.depthTruncThreshold);
 #ifdef HAVE_OPENCL
     if (ocl::useOpenCL())
         return makePtr<TSDFVolumeGPU>(_params.voxelSize, _params.pose.matrix, _params.raycastStepFactor,
@@ -1,9 +1,18 @@
 #include "precomp.hpp"
 #include "warpfield.hpp"
 
+#include <atomic>
+
 namespace cv {
 namespace dynafu {
 
+// versions are unique among all warp fields, a cache filled from one of them never matches another one
+static uint64 newNodesVersion()
+{
+    static std::atomic<uint64> lastVersion(0);
+    return ++lastVersion;
+}
+
 WarpField::WarpField(int _maxNeighbours, int K, int levels, float baseResolution, float resolutionGrowth):
 k(K), n_levels(levels),
 nodes(), maxNeighbours(_maxNeighbours), // good amount for dense kinfu pointclouds
@@ -11,7 +20,8 @@ baseRes(baseResolution),
 resGrowthRate(resolutionGrowth),
 regGraphNodes(n_levels-1),
 heirarchy(n_levels-1),
-nodeIndex(nullptr)
+nodeIndex(nullptr),
+nodesVersion(newNodesVersion())
 {
     CV_Assert(k <= DYNAFU_MAX_NEIGHBOURS);
 }
@@ -84,11 +94,15 @@ void WarpField::updateNodesFromPoints(InputArray inputPoints)
     }
 
     initTransforms(newNodes);
-    nodes.insert(nodes.end(), newNodes.begin(), newNodes.end());
-    nodesPos = getNodesPos(nodes);
-    //re-build index
-    nodeIndex = new flann::GenericIndex<flann::L2_Simple<float> >(nodesPos,
-                                                                  cvflann::LinearIndexParams());
+    if(!newNodes.empty() || !nodeIndex)
+    {
+        nodes.insert(nodes.end(), newNodes.begin(), newNodes.end());
+        nodesPos = getNodesPos(nodes);
+        //re-build index
+        nodeIndex = new flann::GenericIndex<flann::L2_Simple<float> >(nodesPos,
+                                                                      cvflann::LinearIndexParams());
+        nodesVersion = newNodesVersion();
+    }
 
     constructRegGraph();
 }
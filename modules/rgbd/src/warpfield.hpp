@@ -45,6 +45,12 @@ public:
         return nodes.size();
     }
 
+    //! Changes whenever nodes are added, so that the caches of nearest nodes can be kept in between
+    uint64 getNodesVersion() const
+    {
+        return nodesVersion;
+    }
+
     Point3f applyWarp(Point3f p, const nodeNeighboursType neighbours, int n, bool normal=false) const;
 
     void setAllRT(Affine3f warpRT);
@@ -83,6 +89,8 @@ private:
 
     Mat nodesPos;
 
+    uint64 nodesVersion;
+
 };
 
 bool PtCmp(cv::Point3f a, cv::Point3f b);
@@ -372,6 +372,98 @@ TEST(KinectFusion, DISABLED_OCL)
 }
 #endif
 
+void asyncTest(bool hiDense)
+{
+    Ptr<kinfu::Params> params;
+    if(hiDense)
+        params = kinfu::Params::defaultParams();
+    else
+        params = kinfu::Params::coarseParams();
+
+    Ptr<Scene> scene = Scene::create(hiDense, params->frameSize, params->intr, params->depthFactor);
+
+    Ptr<kinfu::KinFu> kfSync  = kinfu::KinFu::create(params);
+    Ptr<kinfu::KinFu> kfAsync = kinfu::KinFu::create(params);
+
+    std::vector<Affine3f> poses = scene->getPoses();
+    std::vector<AsyncArray> results;
+    std::vector<Affine3f> syncPoses;
+    Mat depth;
+    for(size_t i = 0; i < poses.size(); i++)
+    {
+        scene->depth(poses[i]).copyTo(depth);
+
+        // the frame is copied, so the buffer can be rewritten right away
+        results.push_back(kfAsync->updateAsync(depth));
+
+        ASSERT_TRUE(kfSync->update(depth));
+        syncPoses.push_back(kfSync->getPose());
+    }
+
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        Mat asyncPose;
+        results[i].get(asyncPose);
+        ASSERT_FALSE(asyncPose.empty());
+        EXPECT_LE(cvtest::norm(asyncPose, Mat(syncPoses[i].matrix), NORM_INF), 1e-5) << "frame " << i;
+    }
+    EXPECT_LE(cvtest::norm(Mat(kfAsync->getPose().matrix), Mat(kfSync->getPose().matrix), NORM_INF), 1e-5);
+}
+
+#ifdef OPENCV_ENABLE_NONFREE
+TEST( KinectFusion, updateAsync )
+#else
+TEST(KinectFusion, DISABLED_updateAsync)
+#endif
+{
+    asyncTest(false);
+}
+
+#ifdef OPENCV_ENABLE_NONFREE
+TEST( KinectFusion, staticCamera )
+#else
+TEST(KinectFusion, DISABLED_staticCamera)
+#endif
+{
+    Ptr<kinfu::Params> params = kinfu::Params::coarseParams();
+    params->tsdf_min_camera_movement = 0.005f;
+    params->tsdf_static_integrate_period = 4;
+
+    Ptr<Scene> scene = Scene::create(false, params->frameSize, params->intr, params->depthFactor);
+    Ptr<kinfu::KinFu> kf = kinfu::KinFu::create(params);
+
+    std::vector<Affine3f> poses = scene->getPoses();
+    Mat depth = scene->depth(poses[0]);
+    const int nFrames = 9;
+    for(int i = 0; i < nFrames; i++)
+    {
+        ASSERT_TRUE(kf->update(depth));
+    }
+
+    int integrated = 0, skipped = 0, reused = 0;
+    kf->getIntegrationStats(integrated, skipped, reused);
+    // first frame and every 4th static frame
+    EXPECT_EQ(3, integrated);
+    EXPECT_EQ(nFrames - integrated, skipped);
+    EXPECT_EQ(skipped, reused);
+
+    Affine3f pose = kf->getPose();
+    EXPECT_LT(cv::norm(pose.rvec()), 0.01);
+    EXPECT_LT(cv::norm(pose.translation()), 0.01);
+
+    // moving objects in front of the static camera are integrated
+    Mat changed = depth.clone();
+    changed(Rect(0, 0, changed.cols/4, changed.rows)) *= 0.9f;
+    ASSERT_TRUE(kf->update(changed));
+    int integratedAfter = 0;
+    kf->getIntegrationStats(integratedAfter, skipped, reused);
+    EXPECT_EQ(integrated + 1, integratedAfter);
+
+    kf->reset();
+    kf->getIntegrationStats(integrated, skipped, reused);
+    EXPECT_EQ(0, integrated + skipped + reused);
+}
+
 TEST( KinectFusion, DISABLED_hashTsdf )
 {
     flyTest(false, false, true);
@@ -328,5 +328,47 @@ TEST(RGBD_Odometry_FastICP, algorithmic)
     test.safe_run();
 }
 
+TEST(RGBD_Odometry, sharedFramePyramids)
+{
+    std::string dataPath = cvtest::TS::ptr()->get_data_path();
+    Mat image = imread(dataPath + "rgbd/rgb.png", 0);
+    Mat depth16 = imread(dataPath + "rgbd/depth.png", -1);
+    ASSERT_FALSE(image.empty());
+    ASSERT_FALSE(depth16.empty());
+    Mat depth;
+    depth16.convertTo(depth, CV_32FC1, 1.f/5000.f);
+    depth.setTo(std::numeric_limits<float>::quiet_NaN(), depth < FLT_EPSILON);
+
+    Mat K = (Mat_<float>(3, 3) << 525.f, 0, 319.5f, 0, 525.f, 239.5f, 0, 0, 1);
+    Mat rvec = (Mat_<double>(3, 1) << 0.01, -0.02, 0.015);
+    Mat tvec = (Mat_<double>(3, 1) << 0.01, 0.005, -0.01);
+    Mat warpedImage, warpedDepth;
+    warpFrame(image, depth, rvec, tvec, K, warpedImage, warpedDepth);
+    dilateFrame(warpedImage, warpedDepth);
+
+    Ptr<Odometry> odometries[] = { Odometry::create("RgbdOdometry"), Odometry::create("ICPOdometry") };
+    const int levels = 4;
+
+    Ptr<OdometryFrame> srcShared = OdometryFrame::create(image, depth);
+    Ptr<OdometryFrame> dstShared = OdometryFrame::create(warpedImage, warpedDepth);
+    srcShared->preparePyramids(K, levels, OdometryFrame::CACHE_SRC);
+    dstShared->preparePyramids(K, levels, OdometryFrame::CACHE_DST);
+
+    for(size_t i = 0; i < sizeof(odometries) / sizeof(odometries[0]); i++)
+    {
+        odometries[i]->setCameraMatrix(K);
+        srcShared->releaseMasks();
+        dstShared->releaseMasks();
+
+        Mat sharedRt, ownRt;
+        ASSERT_TRUE(odometries[i]->compute(srcShared, dstShared, sharedRt));
+
+        Ptr<OdometryFrame> src = OdometryFrame::create(image, depth);
+        Ptr<OdometryFrame> dst = OdometryFrame::create(warpedImage, warpedDepth);
+        ASSERT_TRUE(odometries[i]->compute(src, dst, ownRt));
+
+        EXPECT_LE(cvtest::norm(sharedRt, ownRt, NORM_INF), 1e-6) << "odometry " << i;
+    }
+}
 
 }} // namespace
@@ -107,7 +107,6 @@ TEST( PoseGraph, sphereG2O )
     std::string filename = cvtest::TS::ptr()->get_data_path() + "rgbd/sphere_bignoise_vertex3.g2o";
     Ptr<kinfu::detail::PoseGraph> pg = readG2OFile(filename);
 
-#ifdef HAVE_EIGEN
     // You may change logging level to view detailed optimization report
     // For example, set env. variable like this: OPENCV_LOG_LEVEL=INFO
 
@@ -142,9 +141,6 @@ TEST( PoseGraph, sphereG2O )
 
         of.close();
     }
-#else
-    throw SkipTestException("Build with Eigen required for pose graph optimization");
-#endif
 }
 
 
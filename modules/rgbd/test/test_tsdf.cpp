@@ -4,6 +4,10 @@
 
 #include "test_precomp.hpp"
 
+#ifdef HAVE_CUDA
+#include "opencv2/core/cuda.hpp"
+#endif
+
 namespace opencv_test {
 namespace {
 
@@ -451,6 +455,153 @@ void valid_points_test(bool isHashTSDF)
     ASSERT_LT(abs(0.5 - percentValidity), 0.3) << "percentValidity out of [0.3; 0.7] (percentValidity=" << percentValidity << ")";
 }
 
+void streaming_test()
+{
+    Settings settings(true, true);
+    const kinfu::Params& p = *settings.params;
+
+    kinfu::VolumeParams vp;
+    vp.type = kinfu::VolumeType::HASHTSDF;
+    vp.unitResolution = 16;
+    vp.pose = p.volumePose;
+    vp.voxelSize = p.voxelSize;
+    vp.tsdfTruncDist = p.tsdf_trunc_dist;
+    vp.maxWeight = p.tsdf_max_weight;
+    vp.depthTruncThreshold = p.truncateThreshold;
+    vp.raycastStepFactor = p.raycast_step_factor;
+    Ptr<kinfu::Volume> reference = kinfu::makeVolume(vp);
+
+    std::string tmp = cv::tempfile();
+    vp.streamingDirectory = tmp.substr(0, tmp.find_last_of("/\\"));
+    vp.streamingEvictFrames = 1;
+    vp.streamingMemoryBudgetMB = 1;
+    Ptr<kinfu::Volume> streamed = kinfu::makeVolume(vp);
+
+    // going around the scene evicts the units seen at the first frame
+    const int nFrames = 20;
+    for (int i = 0; i < nFrames; i++)
+    {
+        Mat depth = settings.scene->depth(settings.poses[i]);
+        reference->integrate(depth, p.depthFactor, settings.poses[i].matrix, p.intr, i);
+        streamed->integrate(depth, p.depthFactor, settings.poses[i].matrix, p.intr, i);
+    }
+
+    Mat refPoints, refNormals, points, normals;
+    reference->raycast(settings.poses[0].matrix, p.intr, p.frameSize, refPoints, refNormals);
+    streamed->raycast(settings.poses[0].matrix, p.intr, p.frameSize, points, normals);
+    patchNaNs(refPoints);
+    patchNaNs(points);
+
+    int valid = counterOfValid(refPoints);
+    ASSERT_GT(valid, 0) << "There is no points in reference";
+
+    int mismatched = 0;
+    for (int y = 0; y < points.rows; y++)
+        for (int x = 0; x < points.cols; x++)
+        {
+            Vec4f d = points.at<Vec4f>(y, x) - refPoints.at<Vec4f>(y, x);
+            if (norm(Vec3f(d[0], d[1], d[2])) > 1e-3)
+                mismatched++;
+        }
+    EXPECT_LT(mismatched, valid / 100) << "Streamed volume differs from in-memory one";
+}
+
+void bricked_test()
+{
+    Settings settings(false, true);
+    const kinfu::Params& p = *settings.params;
+
+    kinfu::VolumeParams vp;
+    vp.type = kinfu::VolumeType::TSDF;
+    vp.resolution = p.volumeDims;
+    vp.pose = p.volumePose;
+    vp.voxelSize = p.voxelSize;
+    vp.tsdfTruncDist = p.tsdf_trunc_dist;
+    vp.maxWeight = p.tsdf_max_weight;
+    vp.depthTruncThreshold = p.truncateThreshold;
+    vp.raycastStepFactor = p.raycast_step_factor;
+    vp.bricked = true;
+    Ptr<kinfu::Volume> bricked = kinfu::makeVolume(vp);
+
+    const int nFrames = 5;
+    for (int i = 0; i < nFrames; i++)
+    {
+        Mat depth = settings.scene->depth(settings.poses[i]);
+        settings.volume->integrate(depth, p.depthFactor, settings.poses[i].matrix, p.intr);
+        bricked->integrate(depth, p.depthFactor, settings.poses[i].matrix, p.intr);
+    }
+
+    Mat refPoints, refNormals, points, normals;
+    settings.volume->raycast(settings.poses[0].matrix, p.intr, p.frameSize, refPoints, refNormals);
+    bricked->raycast(settings.poses[0].matrix, p.intr, p.frameSize, points, normals);
+    patchNaNs(refPoints);
+    patchNaNs(points);
+
+    int valid = counterOfValid(refPoints);
+    ASSERT_GT(valid, 0) << "There is no points in dense volume";
+    normalsCheck(normals);
+
+    int mismatched = 0;
+    for (int y = 0; y < points.rows; y++)
+        for (int x = 0; x < points.cols; x++)
+        {
+            Vec4f d = points.at<Vec4f>(y, x) - refPoints.at<Vec4f>(y, x);
+            if (norm(Vec3f(d[0], d[1], d[2])) > 1e-3)
+                mismatched++;
+        }
+    EXPECT_LT(mismatched, valid / 50) << "Bricked volume differs from dense one";
+
+    Mat refCloud, cloud;
+    settings.volume->fetchPointsNormals(refCloud, noArray());
+    bricked->fetchPointsNormals(cloud, noArray());
+    ASSERT_GT(cloud.rows, 0);
+    EXPECT_LT(abs(cloud.rows - refCloud.rows), refCloud.rows / 50 + 1);
+}
+
+static bool vec4fLess(const Vec4f& a, const Vec4f& b)
+{
+    return std::lexicographical_compare(a.val, a.val + 4, b.val, b.val + 4);
+}
+
+void fetch_mesh_test()
+{
+#ifdef HAVE_CUDA
+    if (cv::cuda::getCudaEnabledDeviceCount() > 0)
+        throw SkipTestException("Mesh extraction is implemented for CPU HashTSDF volume only");
+#endif
+    Settings settings(true, true);
+    Settings fresh(true, true);
+    const kinfu::Params& p = *settings.params;
+
+    Mat vertices, normals;
+    for (int i = 0; i < 10; i++)
+    {
+        Mat depth = settings.scene->depth(settings.poses[i]);
+        settings.volume->integrate(depth, p.depthFactor, settings.poses[i].matrix, p.intr, i);
+        fresh.volume->integrate(depth, p.depthFactor, settings.poses[i].matrix, p.intr, i);
+        // re-meshing the touched units only
+        if (i == 4)
+            settings.volume->fetchMesh(vertices, normals);
+    }
+    settings.volume->fetchMesh(vertices, normals);
+
+    Mat freshVertices, freshNormals;
+    fresh.volume->fetchMesh(freshVertices, freshNormals);
+
+    ASSERT_GT(vertices.rows, 0) << "There is no mesh";
+    ASSERT_EQ(vertices.rows % 3, 0);
+    ASSERT_EQ(vertices.rows, normals.rows);
+    normalsCheck(normals);
+
+    // incremental mesh should be the same as the one built at once
+    ASSERT_EQ(vertices.rows, freshVertices.rows);
+    std::vector<Vec4f> v1(vertices.begin<Vec4f>(), vertices.end<Vec4f>());
+    std::vector<Vec4f> v2(freshVertices.begin<Vec4f>(), freshVertices.end<Vec4f>());
+    std::sort(v1.begin(), v1.end(), vec4fLess);
+    std::sort(v2.begin(), v2.end(), vec4fLess);
+    EXPECT_EQ(0, cvtest::norm(Mat(v1), Mat(v2), NORM_INF));
+}
+
 #ifndef HAVE_OPENCL
 TEST(TSDF, raycast_normals) { normal_test(false, true, false, false); }
 TEST(TSDF, fetch_points_normals) { normal_test(false, false, true, false); }
@@ -461,6 +612,9 @@ TEST(HashTSDF, raycast_normals) { normal_test(true, true, false, false); }
 TEST(HashTSDF, fetch_points_normals) { normal_test(true, false, true, false); }
 TEST(HashTSDF, fetch_normals) { normal_test(true, false, false, true); }
 TEST(HashTSDF, valid_points) { valid_points_test(true); }
+TEST(TSDF, bricked) { bricked_test(); }
+TEST(HashTSDF, streaming) { streaming_test(); }
+TEST(HashTSDF, fetch_mesh) { fetch_mesh_test(); }
 #else
 TEST(TSDF_CPU, raycast_normals)
 {
@@ -490,6 +644,13 @@ TEST(TSDF_CPU, valid_points)
     cv::ocl::setUseOpenCL(true);
 }
 
+TEST(TSDF_CPU, bricked)
+{
+    cv::ocl::setUseOpenCL(false);
+    bricked_test();
+    cv::ocl::setUseOpenCL(true);
+}
+
 TEST(HashTSDF_CPU, raycast_normals)
 {
     cv::ocl::setUseOpenCL(false);
@@ -517,6 +678,20 @@ TEST(HashTSDF_CPU, valid_points)
     valid_points_test(true);
     cv::ocl::setUseOpenCL(true);
 }
+
+TEST(HashTSDF_CPU, streaming)
+{
+    cv::ocl::setUseOpenCL(false);
+    streaming_test();
+    cv::ocl::setUseOpenCL(true);
+}
+
+TEST(HashTSDF_CPU, fetch_mesh)
+{
+    cv::ocl::setUseOpenCL(false);
+    fetch_mesh_test();
+    cv::ocl::setUseOpenCL(true);
+}
 #endif
 }
 }  // namespace
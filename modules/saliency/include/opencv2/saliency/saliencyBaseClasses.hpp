@@ -102,6 +102,14 @@ class CV_EXPORTS_W StaticSaliency : public virtual Saliency
     @param _binaryMap the binary map
      */
   CV_WRAP bool computeBinaryMap( InputArray _saliencyMap, OutputArray _binaryMap );
+
+    /** @brief Computes the saliency maps of several images, the images are processed in parallel.
+
+    @param images the input images
+    @param saliencyMaps the saliency maps, one for every image
+    @return false if one of the images is empty or its saliency map can not be computed
+     */
+  CV_WRAP bool computeSaliencyBatch( InputArrayOfArrays images, OutputArrayOfArrays saliencyMaps );
  protected:
   virtual bool computeSaliencyImpl( InputArray image, OutputArray saliencyMap ) CV_OVERRIDE = 0;
 
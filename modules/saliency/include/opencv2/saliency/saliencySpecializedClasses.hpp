@@ -145,9 +145,9 @@ protected:
 private:
   void calcIntensityChannel(Mat src, Mat dst);
   void copyImage(Mat src, Mat dst);
-  void getIntensityScaled(Mat integralImage, Mat gray, Mat saliencyOn, Mat saliencyOff, int neighborhood);
+  void getIntensityScaled(Mat integralImage, Mat gray, Mat mixedOn, Mat mixedOff);
   float getMean(Mat srcArg, Point2i PixArg, int neighbourhood, int centerVal);
-  void mixScales(Mat *saliencyOn, Mat intensityOn, Mat *saliencyOff, Mat intensityOff, const int numScales);
+  void mixScales(Mat mixedOn, Mat intensityOn, Mat mixedOff, Mat intensityOff);
   void mixOnOff(Mat intensityOn, Mat intensityOff, Mat intensity);
   void getIntensity(Mat srcArg, Mat dstArg,  Mat dstOnArg,  Mat dstOffArg, bool generateOnOff);
 };
@@ -238,16 +238,22 @@ private:
   bool activityControl(const Mat& current_noisePixelsMask);
   bool decisionThresholdAdaptation();
 
+  // number of pixels whose first template is activated / initialized
+  int countInitializedPixels();
+
   // changing structure
-  std::vector<Ptr<Mat> > backgroundModel;// The vector represents the background template T0---TK of reference paper.
-  // Matrices are two-channel matrix. In the first layer there are the B (background value)
-  // for each pixel. In the second layer, there are the C (efficacy) value for each pixel
+  Mat backgroundModel;// The background templates T0---TK of reference paper, stored contiguously for each pixel.
+  // The matrix has 2*(K+1) channels: for the template z, the channel 2*z holds the B (background value)
+  // of each pixel and the channel 2*z+1 holds the C (efficacy) value of each pixel
   Mat potentialBackground;// Two channel Matrix. For each pixel, in the first level there are the Ba value (potential background value)
                           // and in the secon level there are the Ca value, the counter for each potential value.
   Mat epslonPixelsValue;// epslon threshold
 
   Mat activityPixelsValue;// Activity level of each pixel
 
+  // scratch matrices reused across the frames
+  Mat highResMask, lowResMask, currentNoiseMask, templateEfficacy;
+
   //vector<Mat> noisePixelMask; // We define a ‘noise-pixel’ as a pixel that has been classified as a foreground pixel during the full resolution
   Mat noisePixelMask;// We define a ‘noise-pixel’ as a pixel that has been classified as a foreground pixel during the full resolution
   //detection process,however, after the low resolution detection, it has become a
@@ -319,6 +325,19 @@ public:
      */
   CV_WRAP std::vector<float> getobjectnessValues();
 
+  /** @brief Computes the objectness bounding boxes of several images.
+
+    The trained models are loaded once and reused for the whole batch, and the window sizes of every
+    image are processed in parallel.
+    @param images input images
+    @param boundingBoxes for every image its bounding boxes in descending order of objectness,
+    as returned by computeSaliency()
+    @param values for every image the objectness values of its bounding boxes, as returned by
+    getobjectnessValues()
+     */
+  bool computeSaliencyBatch( InputArrayOfArrays images, std::vector<std::vector<Vec4i> >& boundingBoxes,
+                             std::vector<std::vector<float> >& values );
+
   /** @brief This is a utility function that allows to set the correct path from which the algorithm will load
     the trained model.
     @param trainingPath trained model path
@@ -429,6 +448,16 @@ private:
     G
   };
 
+  // Trained model of a color space, kept to avoid reading it for every image
+  struct TrainedModel
+  {
+    std::string modelName;// Model files the parameters were read from, empty if none
+    int state;// Return value of loadTrainedModel()
+    std::vector<int> svmSzIdxs;
+    Mat svmFilter, svmReW1f;
+    FilterTIG tigF;
+  };
+
   double _base, _logBase;  // base for window size quantization
   int _W;// As described in the paper: #Size, Size(_W, _H) of feature window.
   int _NSS;// Size for non-maximal suppress
@@ -444,6 +473,7 @@ private:
   Mat _svmFilter;// Filters learned at stage I, each is a _H by _W CV_32F matrix
   FilterTIG _tigF;// TIG filter
   Mat _svmReW1f;// Re-weight parameters learned at stage II.
+  TrainedModel _models[3];// Models already read for every color space
 
 // List of the rectangles' objectness value, in the same order as
 // the  vector<Vec4i> objectnessBoundingBox returned by the algorithm (in computeSaliencyImpl function)
@@ -465,6 +495,7 @@ private:
 
 // Load trained model.
   int loadTrainedModel();// Return -1, 0, or 1 if partial, none, or all loaded
+  int readTrainedModel();// Reads the model files, same return values as loadTrainedModel()
 
 // Get potential bounding boxes, each of which is represented by a Vec4i for (minX, minY, maxX, maxY).
 // The trained model should be prepared before calling this function: loadTrainedModel() or trainStageI() + trainStageII().
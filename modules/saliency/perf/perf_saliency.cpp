@@ -0,0 +1,71 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+enum { SALIENCY_SPECTRAL_RESIDUAL, SALIENCY_FINE_GRAINED };
+CV_ENUM(StaticSaliencyType, SALIENCY_SPECTRAL_RESIDUAL, SALIENCY_FINE_GRAINED)
+
+typedef tuple<Size, StaticSaliencyType> StaticSaliencyParams_t;
+typedef perf::TestBaseWithParam<StaticSaliencyParams_t> StaticSaliency;
+
+PERF_TEST_P(StaticSaliency, computeSaliency, Combine(Values(szVGA, sz720p), StaticSaliencyType::all()))
+{
+    const Size sz = get<0>(GetParam());
+    const int type = get<1>(GetParam());
+
+    Mat img = imread(getDataPath("cv/shared/fruits.png"));
+    ASSERT_FALSE(img.empty());
+    resize(img, img, sz, 0, 0, INTER_LINEAR_EXACT);
+
+    Ptr<saliency::Saliency> sal;
+    if (type == SALIENCY_SPECTRAL_RESIDUAL)
+        sal = saliency::StaticSaliencySpectralResidual::create();
+    else
+        sal = saliency::StaticSaliencyFineGrained::create();
+    Mat map;
+
+    TEST_CYCLE() sal->computeSaliency(img, map);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef perf::TestBaseWithParam<Size> MotionSaliency;
+
+PERF_TEST_P(MotionSaliency, computeSaliency, Values(szQVGA, szVGA))
+{
+    const Size sz = GetParam();
+
+    // an object moving over a noisy background
+    const int numFrames = 20;
+    std::vector<Mat> frames(numFrames);
+    RNG rng(0);
+    for (int i = 0; i < numFrames; ++i)
+    {
+        frames[i].create(sz, CV_8UC1);
+        rng.fill(frames[i], RNG::UNIFORM, 100, 120);
+        rectangle(frames[i], Rect(i * sz.width / (2 * numFrames), sz.height / 3, sz.width / 5, sz.height / 4),
+                  Scalar::all(220), FILLED);
+    }
+
+    Ptr<saliency::MotionSaliencyBinWangApr2014> sal = saliency::MotionSaliencyBinWangApr2014::create();
+    sal->setImagesize(sz.width, sz.height);
+    sal->init();
+    Mat map;
+    // the background model is initialized outside of the measured part
+    for (int i = 0; i < numFrames / 2; ++i)
+        sal->computeSaliency(frames[i], map);
+
+    int frameIdx = numFrames / 2;
+    TEST_CYCLE()
+    {
+        sal->computeSaliency(frames[frameIdx], map);
+        frameIdx = frameIdx + 1 < numFrames ? frameIdx + 1 : numFrames / 2;
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
@@ -55,8 +55,9 @@ struct TIGbits
   TIGbits() : bc0(0), bc1(0) {}
   inline void accumulate(TIG_TYPE tig, TIG_TYPE tigMask0, TIG_TYPE tigMask1, uchar shift)
   {
-    bc0 += ((POPCNT64(tigMask0 & tig) << 1) - POPCNT64(tig)) << shift;
-    bc1 += ((POPCNT64(tigMask1 & tig) << 1) - POPCNT64(tig)) << shift;
+    const TIG_TYPE bc = POPCNT64(tig);
+    bc0 += ((POPCNT64(tigMask0 & tig) << 1) - bc) << shift;
+    bc1 += ((POPCNT64(tigMask1 & tig) << 1) - bc) << shift;
   }
   TIG_TYPE bc0;
   TIG_TYPE bc1;
@@ -113,44 +114,30 @@ void ObjectnessBING::FilterTIG::reconstruct( Mat &w1f )
 Mat ObjectnessBING::FilterTIG::matchTemplate( const Mat &mag1u )
 {
   const int H = mag1u.rows, W = mag1u.cols;
-  const Size sz( W + 1, H + 1 );  // Expand original size to avoid dealing with boundary conditions
-  Mat_<MAT_TIG_TYPE> Tig1 = Mat_<MAT_TIG_TYPE>::zeros( sz ), Tig2 = Mat_<MAT_TIG_TYPE>::zeros( sz );
-  Mat_<MAT_TIG_TYPE> Tig4 = Mat_<MAT_TIG_TYPE>::zeros( sz ), Tig8 = Mat_<MAT_TIG_TYPE>::zeros( sz );
-  Mat_<BYTE> Row1 = Mat_<BYTE>::zeros( sz ), Row2 = Mat_<BYTE>::zeros( sz );
-  Mat_<BYTE> Row4 = Mat_<BYTE>::zeros( sz ), Row8 = Mat_<BYTE>::zeros( sz );
-  Mat_<float> scores( sz );
-  for ( int y = 1; y <= H; y++ )
+  Mat matchCost1f( H - 7, W - 7, CV_32F );
+
+  // Binary TIGs of the last row for every column, each row shifts the oldest one out
+  std::vector<TIG_TYPE> tig1( W, 0 ), tig2( W, 0 ), tig4( W, 0 ), tig8( W, 0 );
+  for ( int y = 0; y < H; y++ )
   {
-    const BYTE* G = mag1u.ptr<BYTE>( y - 1 );
-    TIG_TYPE* T1 = Tig1.ptr<TIG_TYPE>( y );  // Binary TIG of current row
-    TIG_TYPE* T2 = Tig2.ptr<TIG_TYPE>( y );
-    TIG_TYPE* T4 = Tig4.ptr<TIG_TYPE>( y );
-    TIG_TYPE* T8 = Tig8.ptr<TIG_TYPE>( y );
-    TIG_TYPE* Tu1 = Tig1.ptr<TIG_TYPE>( y - 1 );  // Binary TIG of upper row
-    TIG_TYPE* Tu2 = Tig2.ptr<TIG_TYPE>( y - 1 );
-    TIG_TYPE* Tu4 = Tig4.ptr<TIG_TYPE>( y - 1 );
-    TIG_TYPE* Tu8 = Tig8.ptr<TIG_TYPE>( y - 1 );
-    BYTE* R1 = Row1.ptr<BYTE>( y );
-    BYTE* R2 = Row2.ptr<BYTE>( y );
-    BYTE* R4 = Row4.ptr<BYTE>( y );
-    BYTE* R8 = Row8.ptr<BYTE>( y );
-    float *s = scores.ptr<float>( y );
-    for ( int x = 1; x <= W; x++ )
+    const BYTE* G = mag1u.ptr<BYTE>( y );
+    float* s = y >= 7 ? matchCost1f.ptr<float>( y - 7 ) : NULL;
+    BYTE r1 = 0, r2 = 0, r4 = 0, r8 = 0;  // Binary row features, left to right
+    for ( int x = 0; x < W; x++ )
     {
-      BYTE g = G[x - 1];
-      R1[x] = ( R1[x - 1] << 1 ) | ( ( g >> 4 ) & 1 );
-      R2[x] = ( R2[x - 1] << 1 ) | ( ( g >> 5 ) & 1 );
-      R4[x] = ( R4[x - 1] << 1 ) | ( ( g >> 6 ) & 1 );
-      R8[x] = ( R8[x - 1] << 1 ) | ( ( g >> 7 ) & 1 );
-      T1[x] = ( Tu1[x] << 8 ) | R1[x];
-      T2[x] = ( Tu2[x] << 8 ) | R2[x];
-      T4[x] = ( Tu4[x] << 8 ) | R4[x];
-      T8[x] = ( Tu8[x] << 8 ) | R8[x];
-      s[x] = dot( T1[x], T2[x], T4[x], T8[x] );
+      BYTE g = G[x];
+      r1 = (BYTE) ( ( r1 << 1 ) | ( ( g >> 4 ) & 1 ) );
+      r2 = (BYTE) ( ( r2 << 1 ) | ( ( g >> 5 ) & 1 ) );
+      r4 = (BYTE) ( ( r4 << 1 ) | ( ( g >> 6 ) & 1 ) );
+      r8 = (BYTE) ( ( r8 << 1 ) | ( ( g >> 7 ) & 1 ) );
+      tig1[x] = ( tig1[x] << 8 ) | r1;
+      tig2[x] = ( tig2[x] << 8 ) | r2;
+      tig4[x] = ( tig4[x] << 8 ) | r4;
+      tig8[x] = ( tig8[x] << 8 ) | r8;
+      if( s && x >= 7 )
+        s[x - 7] = dot( tig1[x], tig2[x], tig4[x], tig8[x] );
     }
   }
-  Mat matchCost1f;
-  scores( Rect( 8, 8, W - 7, H - 7 ) ).copyTo( matchCost1f );
   return matchCost1f;
 }
 
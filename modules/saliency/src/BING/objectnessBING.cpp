@@ -96,6 +96,32 @@ void ObjectnessBING::setBBResDir(const String &resultsDir )
 }
 
 int ObjectnessBING::loadTrainedModel()  // Return -1, 0, or 1 if partial, none, or all loaded
+{
+  // The model files of a color space are only read again when the training path changes
+  TrainedModel& model = _models[_Clr];
+  if( model.modelName == _modelName )
+  {
+    _tigF = model.tigF;
+    _svmSzIdxs = model.svmSzIdxs;
+    _svmFilter = model.svmFilter;
+    _svmReW1f = model.svmReW1f;
+    return model.state;
+  }
+
+  int state = readTrainedModel();
+  if( state != 0 )
+  {
+    model.modelName = _modelName;
+    model.state = state;
+    model.tigF = _tigF;
+    model.svmSzIdxs = _svmSzIdxs;
+    model.svmFilter = _svmFilter;
+    model.svmReW1f = _svmReW1f;
+  }
+  return state;
+}
+
+int ObjectnessBING::readTrainedModel()
 {
   CStr s1 = _modelName + ".wS1", s2 = _modelName + ".wS2", sI = _modelName + ".idx";
   Mat filters1f, reW1f, idx1i, show3u;
@@ -129,40 +155,53 @@ void ObjectnessBING::predictBBoxSI( Mat &img3u, ValStructVec<float, Vec4i> &valB
   valBoxes.reserve( 10000 );
   sz.clear();
   sz.reserve( 10000 );
-  for ( int ir = numSz - 1; ir >= 0; ir-- )
-  {
-    int r = _svmSzIdxs[ir];
-    int height = cvRound( pow( _base, r / _numT + _minT ) ), width = cvRound( pow( _base, r % _numT + _minT ) );
-    if( height > imgH * _base || width > imgW * _base )
-      continue;
 
-    height = min( height, imgH ), width = min( width, imgW );
-    Mat im3u, matchCost1f, mag1u;
-    resize( img3u, im3u, Size( cvRound( _W * imgW * 1.0 / width ), cvRound( _W * imgH * 1.0 / height ) ), 0, 0, INTER_LINEAR_EXACT );
-    gradientMag( im3u, mag1u );
-
-    matchCost1f = _tigF.matchTemplate( mag1u );
-
-    ValStructVec<float, Point> matchCost;
-    nonMaxSup( matchCost1f, matchCost, _NSS, NUM_WIN_PSZ, fast );
+  // The window sizes are independent, their boxes are merged afterwards in the sequential order
+  std::vector<ValStructVec<float, Vec4i> > sizeBoxes( numSz );
+  parallel_for_( Range( 0, numSz ), [&]( const Range& range )
+  {
+    for ( int ir = range.start; ir < range.end; ir++ )
+    {
+      int r = _svmSzIdxs[ir];
+      int height = cvRound( pow( _base, r / _numT + _minT ) ), width = cvRound( pow( _base, r % _numT + _minT ) );
+      if( height > imgH * _base || width > imgW * _base )
+        continue;
+
+      height = min( height, imgH ), width = min( width, imgW );
+      Mat im3u, matchCost1f, mag1u;
+      resize( img3u, im3u, Size( cvRound( _W * imgW * 1.0 / width ), cvRound( _W * imgH * 1.0 / height ) ), 0, 0, INTER_LINEAR_EXACT );
+      gradientMag( im3u, mag1u );
+
+      matchCost1f = _tigF.matchTemplate( mag1u );
+
+      ValStructVec<float, Point> matchCost;
+      nonMaxSup( matchCost1f, matchCost, _NSS, NUM_WIN_PSZ, fast );
+
+      // Find true locations and match values
+      double ratioX = width / _W, ratioY = height / _W;
+      int iMax = min( matchCost.size(), NUM_WIN_PSZ );
+      for ( int i = 0; i < iMax; i++ )
+      {
+        float mVal = matchCost( i );
+        Point pnt = matchCost[i];
+        Vec4i box( cvRound( pnt.x * ratioX ), cvRound( pnt.y * ratioY ) );
+        box[2] = cvRound( min( box[0] + width, imgW ) );
+        box[3] = cvRound( min( box[1] + height, imgH ) );
+        box[0]++;
+        box[1]++;
+        sizeBoxes[ir].pushBack( mVal, box );
+      }
+    }
+  });
 
-    // Find true locations and match values
-    double ratioX = width / _W, ratioY = height / _W;
-    int iMax = min( matchCost.size(), NUM_WIN_PSZ );
-    for ( int i = 0; i < iMax; i++ )
+  for ( int ir = numSz - 1; ir >= 0; ir-- )
+  {
+    for ( int i = 0; i < sizeBoxes[ir].size(); i++ )
     {
-      float mVal = matchCost( i );
-      Point pnt = matchCost[i];
-      Vec4i box( cvRound( pnt.x * ratioX ), cvRound( pnt.y * ratioY ) );
-      box[2] = cvRound( min( box[0] + width, imgW ) );
-      box[3] = cvRound( min( box[1] + height, imgH ) );
-      box[0]++;
-      box[1]++;
-      valBoxes.pushBack( mVal, box );
+      valBoxes.pushBack( sizeBoxes[ir]( i ), sizeBoxes[ir][i] );
       sz.push_back( ir );
     }
   }
-
 }
 
 void ObjectnessBING::predictBBoxSII( ValStructVec<float, Vec4i> &valBoxes, const std::vector<int> &sz )
@@ -483,6 +522,30 @@ bool ObjectnessBING::computeSaliencyImpl( InputArray image, OutputArray objectne
   return true;
 }
 
+bool ObjectnessBING::computeSaliencyBatch( InputArrayOfArrays images, std::vector<std::vector<Vec4i> >& boundingBoxes,
+                                           std::vector<std::vector<float> >& values )
+{
+  std::vector<Mat> imgs;
+  images.getMatVector( imgs );
+  boundingBoxes.resize( imgs.size() );
+  values.resize( imgs.size() );
+
+  // The models are read by the first image, the next ones use the loaded ones
+  bool res = true;
+  for ( size_t i = 0; i < imgs.size(); i++ )
+  {
+    boundingBoxes[i].clear();
+    values[i].clear();
+    if( imgs[i].empty() || !computeSaliencyImpl( imgs[i], boundingBoxes[i] ) )
+    {
+      res = false;
+      continue;
+    }
+    values[i] = objectnessValues;
+  }
+  return res;
+}
+
 template<typename VT, typename ST>
 void ObjectnessBING::ValStructVec<VT, ST>::append( const ValStructVec<VT, ST> &newVals, int startV )
 {
@@ -39,6 +39,7 @@
  //
  //M*/
 
+
 #include <limits>
 #include "precomp.hpp"
 
@@ -89,16 +90,12 @@ bool MotionSaliencyBinWangApr2014::init()
   Size imgSize( imageWidth, imageHeight );
   epslonPixelsValue = Mat( imgSize.height, imgSize.width, CV_32F, Scalar( epslonGeneric ) );
   potentialBackground = Mat( imgSize.height, imgSize.width, CV_8UC2, Scalar( 0, 0 ) );
-  backgroundModel.resize( K + 1 );
 
-  for ( int i = 0; i < K + 1; i++ )
-  {
-    Mat* tmpm = new Mat;
-    tmpm->create( imgSize.height, imgSize.width, CV_32FC2 );
-    tmpm->setTo( Scalar( std::numeric_limits<float>::quiet_NaN(), 0 ) );
-    Ptr<Mat> tmp = Ptr<Mat>( tmpm );
-    backgroundModel[i] = tmp;
-  }
+  // every template of every pixel starts with B = NaN and C = 0
+  std::vector<float> templates( 2 * ( K + 1 ), 0.f );
+  for ( int z = 0; z < K + 1; z++ )
+    templates[2 * z] = std::numeric_limits<float>::quiet_NaN();
+  repeat( Mat( 1, 1, CV_32FC( 2 * ( K + 1 ) ), &templates[0] ), imgSize.height, imgSize.width, backgroundModel );
 
   noisePixelMask.create( imgSize.height, imgSize.width, CV_8U );
   noisePixelMask.setTo( Scalar( 0 ) );
@@ -114,285 +111,233 @@ MotionSaliencyBinWangApr2014::~MotionSaliencyBinWangApr2014()
 
 }
 
-// classification (and adaptation) functions
-bool MotionSaliencyBinWangApr2014::fullResolutionDetection( const Mat& image2, Mat& highResBFMask )
+int MotionSaliencyBinWangApr2014::countInitializedPixels()
 {
-  Mat image = image2.clone();
+  extractChannel( backgroundModel, templateEfficacy, 1 );
+  return countNonZero( templateEfficacy );
+}
 
-  uchar currentPixelValue;
-  float currentEpslonValue;
-  bool backgFlag = false;
+// classification (and adaptation) functions
+bool MotionSaliencyBinWangApr2014::fullResolutionDetection( const Mat& image, Mat& highResBFMask )
+{
+  const int cn = backgroundModel.channels();
 
-  // Initially, all pixels are considered as foreground and then we evaluate with the background model
   highResBFMask.create( image.rows, image.cols, CV_8U );
-  highResBFMask.setTo( 1 );
-
-  uchar* pImage;
-  float* pEpslon;
-  uchar* pMask;
 
-  // Scan all pixels of image
-  for ( int i = 0; i < image.rows; i++ )
+  // Every pixel only reads and updates its own templates, so the rows are processed in parallel
+  parallel_for_( Range( 0, image.rows ), [&]( const Range& range )
   {
-
-    pImage = image.ptr<uchar>( i );
-    pEpslon = epslonPixelsValue.ptr<float>( i );
-    pMask = highResBFMask.ptr<uchar>( i );
-    for ( int j = 0; j < image.cols; j++ )
+    for ( int i = range.start; i < range.end; i++ )
     {
-      /*    Pixels with activity greater than Bth are eliminated from the detection result. In this way,
-       continuously blinking noise-pixels will be eliminated from the detection results,
-       preventing the generation of false positives.*/
-      if( activityPixelsValue.at<uchar>( i, j ) < Bth )
-      {
-        backgFlag = false;
-        currentPixelValue = pImage[j];
-        currentEpslonValue = pEpslon[j];
+      const uchar* pImage = image.ptr<uchar>( i );
+      const float* pEpslon = epslonPixelsValue.ptr<float>( i );
+      const uchar* pActivity = activityPixelsValue.ptr<uchar>( i );
+      uchar* pMask = highResBFMask.ptr<uchar>( i );
+      float* pModel = backgroundModel.ptr<float>( i );
 
-        int counter = 0;
-        for ( size_t z = 0; z < backgroundModel.size(); z++ )
+      for ( int j = 0; j < image.cols; j++ )
+      {
+        /*    Pixels with activity greater than Bth are eliminated from the detection result. In this way,
+         continuously blinking noise-pixels will be eliminated from the detection results,
+         preventing the generation of false positives.*/
+        if( pActivity[j] >= Bth )
         {
+          pMask[j] = 0;
+          continue;
+        }
 
-          counter += (int) backgroundModel[z]->ptr<Vec2f>( i )[j][1];
-          if( counter != 0 )
+        float* T = pModel + j * cn;
+        bool initialized = false;
+        for ( int z = 1; z < cn; z += 2 )
+        {
+          if( T[z] != 0 )
+          {
+            initialized = true;
             break;
+          }
         }
 
-        if( counter != 0 )  //if at least the first template is activated / initialized
+        // if the model of the current pixel is not yet initialized, we mark the pixels as foreground
+        uchar mask = 1;
+        if( initialized )  //if at least the first template is activated / initialized
         {
+          const float currentPixelValue = pImage[j];
+          const float currentEpslonValue = pEpslon[j];
+          bool backgFlag = false;
 
-          // scan background model vector
-          for ( size_t z = 0; z < backgroundModel.size(); z++ )
+          // scan background model templates
+          for ( int z = 0; z < cn / 2; z++ )
           {
-            float* currentB;
-            float* currentC;
-            currentB = & ( backgroundModel[z]->ptr<Vec2f>( i )[j][0] );
-            currentC = & ( backgroundModel[z]->ptr<Vec2f>( i )[j][1] );
+            float& currentB = T[2 * z];
+            float& currentC = T[2 * z + 1];
 
-            //continue;
-            if( ( *currentC ) > 0 )  //The current template is active
+            if( currentC > 0 )  //The current template is active
             {
               // If there is a match with a current background template
-              if( abs( currentPixelValue - ( *currentB ) ) < currentEpslonValue && !backgFlag )
+              if( !backgFlag && std::abs( currentPixelValue - currentB ) < currentEpslonValue )
               {
                 // The correspondence pixel in the  BF mask is set as background ( 0 value)
-                pMask[j] = 0;
-                if( ( *currentC < L0 && z == 0 ) || ( *currentC < L1 && z == 1 ) || ( z > 1 ) )
+                mask = 0;
+                if( ( currentC < L0 && z == 0 ) || ( currentC < L1 && z == 1 ) || ( z > 1 ) )
                 {
-                  *currentC += 1;  // increment the efficacy of this template
+                  currentC += 1;  // increment the efficacy of this template
                 }
 
-                *currentB = ( ( 1 - alpha ) * ( *currentB ) ) + ( alpha * currentPixelValue );  // Update the template value
+                currentB = ( ( 1 - alpha ) * currentB ) + ( alpha * currentPixelValue );  // Update the template value
                 backgFlag = true;
               }
               else
               {
-                *currentC -= 1;  // decrement the efficacy of this template
+                currentC -= 1;  // decrement the efficacy of this template
               }
-
             }
-
-          }  // end "for" cicle of template vector
-
-        }
-        else
-        {
-          pMask[j] = 1;  //if the model of the current pixel is not yet initialized, we mark the pixels as foreground
+          }
         }
+        pMask[j] = mask;
       }
-      else
-      {
-        pMask[j] = 0;
-      }
-
     }
-  }  // end "for" cicle of all image's pixels
+  } );
 
   return true;
 }
 
 bool MotionSaliencyBinWangApr2014::lowResolutionDetection( const Mat& image, Mat& lowResBFMask )
 {
-  std::vector<Mat> mv;
-  split( *backgroundModel[0], mv );
+  // Initially, all pixels are considered as foreground and then we evaluate with the background model
+  lowResBFMask.create( image.rows, image.cols, CV_8U );
+  lowResBFMask.setTo( 1 );
 
   //if at least the first template is activated / initialized for all pixels
-  if( countNonZero( mv[1] ) > ( mv[1].cols * mv[1].rows ) / 2 )
-  {
-    float currentPixelValue;
-    float currentEpslonValue;
-    float currentB;
-    float currentC;
-
-    // Create a mask to select ROI in the original Image and Backgound model and at the same time compute the mean
+  if( countInitializedPixels() <= ( backgroundModel.cols * backgroundModel.rows ) / 2 )
+    return false;
 
-    Rect roi( Point( 0, 0 ), Size( N, N ) );
-    Scalar imageROImean;
-    Scalar backGModelROImean;
-    Mat currentModel;
+  const int cn = backgroundModel.channels();
+  const int blockRows = ( image.rows + N - 1 ) / N;
+  const int blockCols = ( image.cols + N - 1 ) / N;
+  const Rect imageRect( 0, 0, image.cols, image.rows );
 
-    // Initially, all pixels are considered as foreground and then we evaluate with the background model
-    lowResBFMask.create( image.rows, image.cols, CV_8U );
-    lowResBFMask.setTo( 1 );
+  // The rows of blocks cover disjoint rows of the mask, so they are processed in parallel
+  parallel_for_( Range( 0, blockRows ), [&]( const Range& range )
+  {
+    // sums of the image, epslon and of the B, C values of the first N_DS templates over a block
+    std::vector<double> sums( 2 + 2 * N_DS );
 
-    // Scan all the ROI of original matrices
-    for ( int i = 0; i < (int)ceil( (float) image.rows / N ); i++ )
+    for ( int i = range.start; i < range.end; i++ )
     {
-      if( ( roi.y + ( N - 1 ) ) <= ( image.rows - 1 ) )
-      {
-        // Reset original ROI dimension
-        roi = Rect( Point( roi.x, roi.y ), Size( N, N ) );
-      }
+      // The ROI is only shifted from left to right after a block has been evaluated
+      Rect roi( 0, i * N, N, std::min( N, image.rows - i * N ) );
 
-      for ( int j = 0; j < (int)ceil( (float) image.cols / N ); j++ )
+      for ( int j = 0; j < blockCols; j++ )
       {
+        const Rect block = roi & imageRect;
+        bool background = true;
+
         /* Pixels with activity greater than Bth are eliminated from the detection result. In this way,
          continuously blinking noise-pixels will be eliminated from the detection results,
          preventing the generation of false positives.*/
         if( activityPixelsValue.at<uchar>( i, j ) < Bth )
         {
+          // Compute the mean of image's block, epslonMatrix's block and of the templates' blocks
+          std::fill( sums.begin(), sums.end(), 0. );
+          for ( int y = block.y; y < block.y + block.height; y++ )
+          {
+            const uchar* pImage = image.ptr<uchar>( y );
+            const float* pEpslon = epslonPixelsValue.ptr<float>( y );
+            const float* pModel = backgroundModel.ptr<float>( y );
+            for ( int x = block.x; x < block.x + block.width; x++ )
+            {
+              sums[0] += pImage[x];
+              sums[1] += pEpslon[x];
+              const float* T = pModel + x * cn;
+              for ( int c = 0; c < 2 * N_DS; c++ )
+                sums[2 + c] += T[c];
+            }
+          }
+          const double area = block.area();
+          const float currentPixelValue = (float) ( sums[0] / area );
+          const float currentEpslonValue = (float) ( sums[1] / area );
 
-          // Compute the mean of image's block and epslonMatrix's block based on ROI
-          Mat roiImage = image( roi );
-          Mat roiEpslon = epslonPixelsValue( roi );
-          currentPixelValue = (float) mean( roiImage ).val[0];
-          currentEpslonValue = (float) mean( roiEpslon ).val[0];
-
-          // scan background model vector
+          background = false;
           for ( int z = 0; z < N_DS; z++ )
           {
-            // Select the current template 2 channel matrix, select ROI and compute the mean for each channel separately
-            Mat roiTemplate = ( * ( backgroundModel[z] ) )( roi );
-            Scalar templateMean = mean( roiTemplate );
-            currentB = (float) templateMean[0];
-            currentC = (float) templateMean[1];
+            const float currentB = (float) ( sums[2 + 2 * z] / area );
+            const float currentC = (float) ( sums[3 + 2 * z] / area );
 
-            if( ( currentC ) > 0 )  //The current template is active
+            //The current template is active and there is a match with it
+            if( currentC > 0 && std::abs( currentPixelValue - currentB ) < currentEpslonValue )
             {
-              // If there is a match with a current background template
-              if( abs( currentPixelValue - ( currentB ) ) < currentEpslonValue )
-              {
-                // The correspondence pixel in the  BF mask is set as background ( 0 value)
-                rectangle( lowResBFMask, roi, Scalar( 0 ), FILLED );
-                break;
-              }
+              background = true;
+              break;
             }
           }
+
           // Shift the ROI from left to right follow the block dimension
-          roi = roi + Point( N, 0 );
-          if( ( roi.x + ( roi.width - 1 ) ) > ( image.cols - 1 ) && ( roi.y + ( N - 1 ) ) <= ( image.rows - 1 ) )
-          {
-            roi = Rect( Point( roi.x, roi.y ), Size( abs( ( image.cols - 1 ) - roi.x ) + 1, N ) );
-          }
-          else if( ( roi.x + ( roi.width - 1 ) ) > ( image.cols - 1 ) && ( roi.y + ( N - 1 ) ) > ( image.rows - 1 ) )
-          {
-            roi = Rect( Point( roi.x, roi.y ), Size( abs( ( image.cols - 1 ) - roi.x ) + 1, abs( ( image.rows - 1 ) - roi.y ) + 1 ) );
-          }
+          roi.x += N;
+          if( ( roi.x + ( roi.width - 1 ) ) > ( image.cols - 1 ) )
+            roi.width = std::abs( ( image.cols - 1 ) - roi.x ) + 1;
         }
-        else
+
+        if( background )
         {
-          // The correspondence pixel in the  BF mask is set as background ( 0 value)
-          rectangle( lowResBFMask, roi, Scalar( 0 ), FILLED );
+          // The correspondence pixels in the  BF mask are set as background ( 0 value)
+          for ( int y = block.y; y < block.y + block.height; y++ )
+            memset( lowResBFMask.ptr<uchar>( y ) + block.x, 0, block.width );
         }
       }
-      //Shift the ROI from up to down follow the block dimension, also bringing it back to beginning of row
-      roi.x = 0;
-      roi.y += N;
-      if( ( roi.y + ( roi.height - 1 ) ) > ( image.rows - 1 ) )
-      {
-        roi = Rect( Point( roi.x, roi.y ), Size( N, abs( ( image.rows - 1 ) - roi.y ) + 1 ) );
-      }
-
     }
-    return true;
-  }
-  else
-  {
-    lowResBFMask.create( image.rows, image.cols, CV_8U );
-    lowResBFMask.setTo( 1 );
-    return false;
-  }
-
-}
-
-bool inline pairCompare( std::pair<float, float> t, std::pair<float, float> t_plusOne )
-{
-
-  return ( t.second > t_plusOne.second );
+  } );
 
+  return true;
 }
 
 bool MotionSaliencyBinWangApr2014::templateOrdering()
 {
+  const int cn = backgroundModel.channels();
+  const float thetaLValue = (float) thetaL;
 
-  Mat dstMask, tempMat, dstMask2, dstMask3;
-  Mat convertMat1, convertMat2;
-  int backGroundModelSize = (int)backgroundModel.size();
-
-  std::vector<std::vector<Mat> > channelSplit( backGroundModelSize );
-  for ( int i = 0; i < backGroundModelSize; i++ )
-  {
-    split( *backgroundModel[i], channelSplit[i] );
-
-  }
-
-  //Bubble sort : Template T1 - Tk
-  for ( int i = 1; i < backGroundModelSize - 1; i++ )
+  parallel_for_( Range( 0, backgroundModel.rows ), [&]( const Range& range )
   {
-    // compare and order the i-th template with the others
-    for ( int j = i + 1; j < backGroundModelSize; j++ )
+    for ( int r = range.start; r < range.end; r++ )
     {
+      float* pModel = backgroundModel.ptr<float>( r );
+      for ( int c = 0; c < backgroundModel.cols; c++ )
+      {
+        float* T = pModel + c * cn;
 
-      compare( channelSplit[j][1], channelSplit[i][1], dstMask, CMP_GT );
-
-      channelSplit[i][0].copyTo( tempMat );
-      channelSplit[j][0].copyTo( channelSplit[i][0], dstMask );
-      tempMat.copyTo( channelSplit[j][0], dstMask );
+        //Bubble sort : Template T1 - Tk
+        for ( int i = 2; i < cn - 2; i += 2 )
+        {
+          // compare and order the i-th template with the others
+          for ( int j = i + 2; j < cn; j += 2 )
+          {
+            if( T[j + 1] > T[i + 1] )
+            {
+              std::swap( T[i], T[j] );
+              std::swap( T[i + 1], T[j + 1] );
+            }
+          }
+        }
 
-      channelSplit[i][1].copyTo( tempMat );
-      channelSplit[j][1].copyTo( channelSplit[i][1], dstMask );
-      tempMat.copyTo( channelSplit[j][1], dstMask );
+        // SORT Template T0 and T1
+        if( T[3] > thetaLValue && thetaLValue > T[1] )
+        {
+          // swap the B elements of T0 and T1, copy the C element of T0 inside T1
+          std::swap( T[0], T[2] );
+          T[3] = T[1];
+          // set the new C0 value as thetaL
+          T[1] = thetaLValue;
+        }
+      }
     }
-  }
-
-  // SORT Template T0 and T1
-  Mat M_deltaL( backgroundModel[0]->rows, backgroundModel[0]->cols, CV_32F, Scalar( thetaL ) );
-
-  compare( channelSplit[1][1], M_deltaL, dstMask2, CMP_GT );
-  compare( M_deltaL, channelSplit[0][1], dstMask3, CMP_GT );
-
-  threshold( dstMask2, dstMask2, 0, 1, THRESH_BINARY );
-  threshold( dstMask3, dstMask3, 0, 1, THRESH_BINARY );
-
-  bitwise_and( dstMask2, dstMask3, dstMask );
-
-  //copy correct B element of T1 inside T0 and swap
-  channelSplit[0][0].copyTo( tempMat );
-  channelSplit[1][0].copyTo( channelSplit[0][0], dstMask );
-  tempMat.copyTo( channelSplit[1][0], dstMask );
-
-  //copy correct C element of T0 inside T1
-  channelSplit[0][1].copyTo( channelSplit[1][1], dstMask );
-
-  //set new C0 values as gamma * thetaL
-  M_deltaL.mul( gamma );
-  M_deltaL.copyTo( channelSplit[0][1], dstMask );
-
-  for ( int i = 0; i < backGroundModelSize; i++ )
-  {
-    merge( channelSplit[i], *backgroundModel[i] );
-  }
+  } );
 
   return true;
 }
 
 bool MotionSaliencyBinWangApr2014::templateReplacement( const Mat& finalBFMask, const Mat& image )
 {
-  std::vector<Mat> temp;
-  split( *backgroundModel[0], temp );
-
 //if at least the first template is activated / initialized for all pixels
-  if( countNonZero( temp[1] ) <= ( temp[1].cols * temp[1].rows ) / 2 )
+  if( countInitializedPixels() <= ( backgroundModel.cols * backgroundModel.rows ) / 2 )
   {
     thetaA = 50;
     thetaL = 150;
@@ -408,29 +353,27 @@ bool MotionSaliencyBinWangApr2014::templateReplacement( const Mat& finalBFMask,
     neighborhoodCheck = true;
   }
 
-  int roiSize = 3;  // FIXED ROI SIZE, not change until you first appropriately adjust the following controls in the EVALUATION section!
-  int countNonZeroElements = 0;
-  std::vector<Mat> mv;
-  Mat replicateCurrentBAMat( roiSize, roiSize, CV_8U );
-  Mat backgroundModelROI( roiSize, roiSize, CV_32F );
-  Mat diffResult( roiSize, roiSize, CV_8U );
-
-// Scan all pixels of finalBFMask and all pixels of others models (the dimension are the same)
-  const uchar* finalBFMaskP;
-  Vec2b* pbgP;
-  const uchar* imageP;
-  float* epslonP;
-  for ( int i = 0; i < finalBFMask.rows; i++ )
+  const int cn = backgroundModel.channels();
+  const int lastTemplate = cn - 2;  // offset of TK among the templates of a pixel
+
+  // The maintenance only changes the values of the own pixel; this is also true for the replacement
+  // when there is no neighborhood check, so the rows are processed in parallel
+  parallel_for_( Range( 0, finalBFMask.rows ), [&]( const Range& range )
   {
-    finalBFMaskP = finalBFMask.ptr<uchar>( i );
-    pbgP = potentialBackground.ptr<Vec2b>( i );
-    imageP = image.ptr<uchar>( i );
-    epslonP = epslonPixelsValue.ptr<float>( i );
-    for ( int j = 0; j < finalBFMask.cols; j++ )
+    for ( int i = range.start; i < range.end; i++ )
     {
-      /////////////////// MAINTENANCE of potentialBackground model ///////////////////
-      if( finalBFMaskP[j] == 1 )  // i.e. the corresponding frame pixel has been market as foreground
+      const uchar* finalBFMaskP = finalBFMask.ptr<uchar>( i );
+      Vec2b* pbgP = potentialBackground.ptr<Vec2b>( i );
+      const uchar* imageP = image.ptr<uchar>( i );
+      const float* epslonP = epslonPixelsValue.ptr<float>( i );
+      float* modelP = backgroundModel.ptr<float>( i );
+
+      for ( int j = 0; j < finalBFMask.cols; j++ )
       {
+        /////////////////// MAINTENANCE of potentialBackground model ///////////////////
+        if( finalBFMaskP[j] != 1 )  // i.e. the corresponding frame pixel has not been market as foreground
+          continue;
+
         /* For the pixels with CA= 0, if the current frame pixel has been classified as foreground, its value
          * will be loaded into BA and CA will be set to 1*/
         if( pbgP[j][1] == 0 )
@@ -441,7 +384,7 @@ bool MotionSaliencyBinWangApr2014::templateReplacement( const Mat& finalBFMask,
 
         /*the distance between this pixel value and BA is calculated, and if this distance is smaller than
          the decision threshold epslon, then CA is increased by 1, otherwise is decreased by 1*/
-        else if( abs( (float) imageP[j] - pbgP[j][0] ) < epslonP[j] )
+        else if( std::abs( (float) imageP[j] - pbgP[j][0] ) < epslonP[j] )
         {
           pbgP[j][1] += 1;
         }
@@ -449,174 +392,128 @@ bool MotionSaliencyBinWangApr2014::templateReplacement( const Mat& finalBFMask,
         {
           pbgP[j][1] -= 1;
         }
-        /*}*/  /////////////////// END of potentialBackground model MAINTENANCE///////////////////
-        /////////////////// EVALUATION of potentialBackground values ///////////////////
-        if( pbgP[j][1] > thetaA )
-        {
-          if( neighborhoodCheck )
-          {
-            // replicate currentBA value
-            replicateCurrentBAMat.setTo( pbgP[j][0] );
-
-            for ( size_t z = 0; z < backgroundModel.size(); z++ )
-            {
-              // Neighborhood of current pixel in the current background model template.
-              // The ROI is centered in the pixel coordinates
-
-              if( i > 0 && j > 0 && i < ( backgroundModel[z]->rows - 1 ) && j < ( backgroundModel[z]->cols - 1 ) )
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0]( Rect( j - (int) floor((float) roiSize / 2 ), i - (int) floor((float) roiSize / 2 ), roiSize, roiSize ) );
-              }
-              else if( i == 0 && j == 0 )  // upper leftt
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0]( Rect( j, i, (int) ceil((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ) ) );
-              }
-              else if( j == 0 && i > 0 && i < ( backgroundModel[z]->rows - 1 ) )  // middle left
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0]( Rect( j, i - (int) floor((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ), roiSize ) );
-              }
-              else if( i == ( backgroundModel[z]->rows - 1 ) && j == 0 )  //down left
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0]( Rect( j, i - (int) floor((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ) ) );
-              }
-              else if( i == 0 && j > 0 && j < ( backgroundModel[z]->cols - 1 ) )  // upper - middle
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0]( Rect( ( j - (int) floor((float) roiSize / 2 ) ), i, roiSize, (int) ceil((float) roiSize / 2 ) ) );
-              }
-              else if( i == ( backgroundModel[z]->rows - 1 ) && j > 0 && j < ( backgroundModel[z]->cols - 1 ) )  //down middle
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0](
-                    Rect( j - (int) floor((float) roiSize / 2 ), i - (int) floor((float) roiSize / 2 ), roiSize, (int) ceil((float) roiSize / 2 ) ) );
-              }
-              else if( i == 0 && j == ( backgroundModel[z]->cols - 1 ) )  // upper right
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0]( Rect( j - (int) floor((float) roiSize / 2 ), i, (int) ceil((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ) ) );
-              }
-              else if( j == ( backgroundModel[z]->cols - 1 ) && i > 0 && i < ( backgroundModel[z]->rows - 1 ) )  // middle - right
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0](
-                    Rect( j - (int) floor((float) roiSize / 2 ), i - (int) floor((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ), roiSize ) );
-              }
-              else if( i == ( backgroundModel[z]->rows - 1 ) && j == ( backgroundModel[z]->cols - 1 ) )  // down right
-              {
-                split( *backgroundModel[z], mv );
-                backgroundModelROI = mv[0](
-                    Rect( j - (int) floor((float) roiSize / 2 ), i - (int) floor((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ), (int) ceil((float) roiSize / 2 ) ) );
-              }
-
-              /* Check if the value of current pixel BA in potentialBackground model is already contained in at least one of its neighbors'
-               * background model
-               */
-              resize( replicateCurrentBAMat, replicateCurrentBAMat, Size( backgroundModelROI.cols, backgroundModelROI.rows ), 0, 0, INTER_LINEAR_EXACT );
-              resize( diffResult, diffResult, Size( backgroundModelROI.cols, backgroundModelROI.rows ), 0, 0, INTER_LINEAR_EXACT );
+        /////////////////// END of potentialBackground model MAINTENANCE///////////////////
 
-              backgroundModelROI.convertTo( backgroundModelROI, CV_8U );
+        if( pbgP[j][1] > thetaA && !neighborhoodCheck )
+        {
+          /////////////////// REPLACEMENT of backgroundModel template ///////////////////
+          //replace TA with current TK
+          modelP[j * cn + lastTemplate] = pbgP[j][0];
+          modelP[j * cn + lastTemplate + 1] = pbgP[j][1];
+          pbgP[j] = Vec2b( 0, 0 );
+        }
+      }
+    }
+  } );
 
-              absdiff( replicateCurrentBAMat, backgroundModelROI, diffResult );
-              threshold( diffResult, diffResult, epslonP[j], 255, THRESH_BINARY_INV );
-              countNonZeroElements = countNonZero( diffResult );
+  if( !neighborhoodCheck )
+    return true;
 
-              if( countNonZeroElements > 0 )
-              {
-                /////////////////// REPLACEMENT of backgroundModel template ///////////////////
-                //replace TA with current TK
-                backgroundModel[backgroundModel.size() - 1]->at<Vec2f>( i, j ) = potentialBackground.at<Vec2b>( i, j );
-                potentialBackground.at<Vec2b>( i, j )[0] = 0;
-                potentialBackground.at<Vec2b>( i, j )[1] = 0;
+  /////////////////// EVALUATION of potentialBackground values ///////////////////
+  // A replaced TK is seen by the neighborhood check of the following pixels, so this pass keeps the scan order
+  for ( int i = 0; i < finalBFMask.rows; i++ )
+  {
+    const uchar* finalBFMaskP = finalBFMask.ptr<uchar>( i );
+    Vec2b* pbgP = potentialBackground.ptr<Vec2b>( i );
+    const float* epslonP = epslonPixelsValue.ptr<float>( i );
+    float* modelP = backgroundModel.ptr<float>( i );
 
-                break;
-              }
-            }  // end for backgroundModel size
-          }
-          else
+    for ( int j = 0; j < finalBFMask.cols; j++ )
+    {
+      if( finalBFMaskP[j] != 1 || pbgP[j][1] <= thetaA )
+        continue;
+
+      /* Check if the value of current pixel BA in potentialBackground model is already contained in at least one of its neighbors'
+       * background model. The 3x3 neighborhood is centered in the pixel coordinates and clipped to the image, the
+       * background values are compared as 8-bit values.
+       */
+      const int currentBA = pbgP[j][0];
+      const int epslon = cvFloor( epslonP[j] );
+      const int y0 = std::max( i - 1, 0 ), y1 = std::min( i + 1, finalBFMask.rows - 1 );
+      const int x0 = std::max( j - 1, 0 ), x1 = std::min( j + 1, finalBFMask.cols - 1 );
+      bool contained = false;
+      for ( int z = 0; z < cn && !contained; z += 2 )
+      {
+        for ( int y = y0; y <= y1 && !contained; y++ )
+        {
+          const float* neighborsB = backgroundModel.ptr<float>( y ) + z;
+          for ( int x = x0; x <= x1; x++ )
           {
-            backgroundModel[backgroundModel.size() - 1]->at<Vec2f>( i, j ) = potentialBackground.at<Vec2b>( i, j );
-            potentialBackground.at<Vec2b>( i, j )[0] = 0;
-            potentialBackground.at<Vec2b>( i, j )[1] = 0;
+            if( std::abs( saturate_cast<uchar>( neighborsB[x * cn] ) - currentBA ) <= epslon )
+            {
+              contained = true;
+              break;
+            }
           }
-        }  // close if of EVALUATION
-      }  // end of  if( finalBFMask.at<uchar>( i, j ) == 1 )  // i.e. the corresponding frame pixel has been market as foreground
+        }
+      }
 
-    }  // end of second for
-  }  // end of first for
+      if( contained )
+      {
+        /////////////////// REPLACEMENT of backgroundModel template ///////////////////
+        //replace TA with current TK
+        modelP[j * cn + lastTemplate] = pbgP[j][0];
+        modelP[j * cn + lastTemplate + 1] = pbgP[j][1];
+        pbgP[j] = Vec2b( 0, 0 );
+      }
+    }
+  }
 
   return true;
 }
 
 bool MotionSaliencyBinWangApr2014::activityControl( const Mat& current_noisePixelsMask )
 {
-  Mat discordanceFramesNoise, not_current_noisePixelsMask;
-  Mat nonZeroIndexes, not_discordanceFramesNoise;  //u_current_noisePixelsMask;
-
-//current_noisePixelsMask.convertTo( u_current_noisePixelsMask, CV_8UC1 );
-
-// Derive the discrepancy between noise in the frame n-1 and frame n
-//threshold( u_current_noisePixelsMask, not_current_noisePixelsMask, 0.5, 1.0, THRESH_BINARY_INV );
-  threshold( current_noisePixelsMask, not_current_noisePixelsMask, 0.5, 1.0, THRESH_BINARY_INV );
-  bitwise_and( noisePixelMask, not_current_noisePixelsMask, discordanceFramesNoise );
-
-// indices in which the pixel at frame n-1 was the noise (or not) and now no (or yes) (blinking pixels)
-  findNonZero( discordanceFramesNoise, nonZeroIndexes );
-
-  Vec2i temp;
-
-// we increase the activity value of these pixels
-  for ( int i = 0; i < nonZeroIndexes.rows; i++ )
+  parallel_for_( Range( 0, activityPixelsValue.rows ), [&]( const Range& range )
   {
-    //TODO check rows, cols inside at
-    temp = nonZeroIndexes.at<Vec2i>( i );
-    if( activityPixelsValue.at<uchar>( temp.val[1], temp.val[0] ) < Bmax )
+    for ( int i = range.start; i < range.end; i++ )
     {
-      activityPixelsValue.at<uchar>( temp.val[1], temp.val[0] ) += Ainc;
-    }
-  }
-
-// decrement other pixels that have not changed (not blinking)
-  threshold( discordanceFramesNoise, not_discordanceFramesNoise, 0.5, 1.0, THRESH_BINARY_INV );
-  findNonZero( not_discordanceFramesNoise, nonZeroIndexes );
-
-  Vec2i temp2;
-
-  for ( int j = 0; j < nonZeroIndexes.rows; j++ )
-  {
-    temp2 = nonZeroIndexes.at<Vec2i>( j );
-    if( activityPixelsValue.at<uchar>( temp2.val[1], temp2.val[0] ) > 0 )
-    {
-      activityPixelsValue.at<uchar>( temp2.val[1], temp2.val[0] ) -= 1;
+      const uchar* currentNoiseP = current_noisePixelsMask.ptr<uchar>( i );
+      uchar* noiseP = noisePixelMask.ptr<uchar>( i );
+      uchar* activityP = activityPixelsValue.ptr<uchar>( i );
+      for ( int j = 0; j < activityPixelsValue.cols; j++ )
+      {
+        // the pixel at frame n-1 was the noise and now no (blinking pixels): we increase the activity value
+        if( noiseP[j] != 0 && currentNoiseP[j] == 0 )
+        {
+          if( activityP[j] < Bmax )
+            activityP[j] += Ainc;
+        }
+        // decrement other pixels that have not changed (not blinking)
+        else if( activityP[j] > 0 )
+        {
+          activityP[j] -= 1;
+        }
+        // update the noisePixelsMask
+        noiseP[j] = currentNoiseP[j];
+      }
     }
-  }
-// update the noisePixelsMask
-  current_noisePixelsMask.copyTo( noisePixelMask );
+  } );
 
   return true;
 }
 
 bool MotionSaliencyBinWangApr2014::decisionThresholdAdaptation()
 {
-
-  for ( int i = 0; i < activityPixelsValue.rows; i++ )
+  parallel_for_( Range( 0, activityPixelsValue.rows ), [&]( const Range& range )
   {
-    for ( int j = 0; j < activityPixelsValue.cols; j++ )
+    for ( int i = range.start; i < range.end; i++ )
     {
-      if( activityPixelsValue.at<uchar>( i, j ) > Binc && ( epslonPixelsValue.at<float>( i, j ) + deltaINC ) < epslonMAX )
+      const uchar* activityP = activityPixelsValue.ptr<uchar>( i );
+      float* epslonP = epslonPixelsValue.ptr<float>( i );
+      for ( int j = 0; j < activityPixelsValue.cols; j++ )
       {
-
-        epslonPixelsValue.at<float>( i, j ) += deltaINC;
-      }
-      else if( activityPixelsValue.at<uchar>( i, j ) < Bdec && ( epslonPixelsValue.at<float>( i, j ) - deltaDEC ) > epslonMIN )
-      {
-        epslonPixelsValue.at<float>( i, j ) -= deltaDEC;
+        if( activityP[j] > Binc && ( epslonP[j] + deltaINC ) < epslonMAX )
+        {
+          epslonP[j] += deltaINC;
+        }
+        else if( activityP[j] < Bdec && ( epslonP[j] - deltaDEC ) > epslonMIN )
+        {
+          epslonP[j] -= deltaDEC;
+        }
       }
     }
-  }
+  } );
 
   return true;
 }
@@ -625,31 +522,27 @@ bool MotionSaliencyBinWangApr2014::computeSaliencyImpl( InputArray image, Output
 {
   CV_Assert(image.channels() == 1);
 
-  Mat highResBFMask, u_highResBFMask;
-  Mat lowResBFMask, u_lowResBFMask;
-  Mat not_lowResBFMask;
-  Mat current_noisePixelsMask;
-
-  fullResolutionDetection( image.getMat(), highResBFMask );
-  lowResolutionDetection( image.getMat(), lowResBFMask );
+  Mat img = image.getMat();
+  fullResolutionDetection( img, highResMask );
+  lowResolutionDetection( img, lowResMask );
 
 // Compute the final background-foreground mask. One pixel is marked as foreground if and only if it is
 // foreground in both masks (full and low)
-  bitwise_and( highResBFMask, lowResBFMask, saliencyMap );
+  bitwise_and( highResMask, lowResMask, saliencyMap );
 
   if( activityControlFlag )
   {
 
 // Detect the noise pixels (i.e. for a given pixel, fullRes(pixel) = foreground and lowRes(pixel)= background)
-    threshold( lowResBFMask, not_lowResBFMask, 0.5, 1.0, THRESH_BINARY_INV );
-    bitwise_and( highResBFMask, not_lowResBFMask, current_noisePixelsMask );
+    threshold( lowResMask, currentNoiseMask, 0.5, 1.0, THRESH_BINARY_INV );
+    bitwise_and( highResMask, currentNoiseMask, currentNoiseMask );
 
-    activityControl( current_noisePixelsMask );
+    activityControl( currentNoiseMask );
     decisionThresholdAdaptation();
   }
 
   templateOrdering();
-  templateReplacement( saliencyMap.getMat(), image.getMat() );
+  templateReplacement( saliencyMap.getMat(), img );
   templateOrdering();
 
   activityControlFlag = true;
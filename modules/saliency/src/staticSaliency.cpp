@@ -99,5 +99,29 @@ bool StaticSaliency::computeBinaryMap( InputArray _saliencyMap, OutputArray _bin
 
 }
 
+bool StaticSaliency::computeSaliencyBatch( InputArrayOfArrays images, OutputArrayOfArrays saliencyMaps )
+{
+  std::vector<Mat> imgs;
+  images.getMatVector( imgs );
+  std::vector<Mat> maps( imgs.size() );
+  std::vector<uchar> done( imgs.size(), 0 );
+
+  // the static algorithms do not keep state between images, so each image is computed independently
+  parallel_for_( Range( 0, (int) imgs.size() ), [&]( const Range& range )
+  {
+    for ( int i = range.start; i < range.end; i++ )
+      done[i] = !imgs[i].empty() && computeSaliencyImpl( imgs[i], maps[i] );
+  } );
+
+  saliencyMaps.create( (int) imgs.size(), 1, CV_32F );
+  bool res = true;
+  for ( size_t i = 0; i < imgs.size(); i++ )
+  {
+    saliencyMaps.getMatRef( (int) i ) = maps[i];
+    res = res && done[i];
+  }
+  return res;
+}
+
 }/* namespace saliency */
 }/* namespace cv */
@@ -40,6 +40,7 @@
  //M*/
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -88,25 +89,14 @@ void StaticSaliencyFineGrained::calcIntensityChannel(Mat srcArg, Mat dstArg)
         //("Error: Destiny image must have only one channel.\n");
         return;
     }
-    const int numScales = 6;
-    Mat intensityScaledOn[numScales];
-    Mat intensityScaledOff[numScales];
     Mat gray = Mat::zeros(Size(srcArg.cols, srcArg.rows), CV_8UC1);
     Mat integralImage(Size(srcArg.cols + 1, srcArg.rows + 1), CV_32FC1);
+    Mat mixedValuesOn(Size(srcArg.cols, srcArg.rows), CV_16UC1);
+    Mat mixedValuesOff(Size(srcArg.cols, srcArg.rows), CV_16UC1);
     Mat intensity(Size(srcArg.cols, srcArg.rows), CV_8UC1);
     Mat intensityOn(Size(srcArg.cols, srcArg.rows), CV_8UC1);
     Mat intensityOff(Size(srcArg.cols, srcArg.rows), CV_8UC1);
 
-    int i;
-    int neighborhood;
-    int neighborhoods[] = {3*4, 3*4*2, 3*4*2*2, 7*4, 7*4*2, 7*4*2*2};
-
-    for(i=0; i<numScales; i++)
-    {
-        intensityScaledOn[i] = Mat(Size(srcArg.cols, srcArg.rows), CV_8UC1);
-        intensityScaledOff[i] = Mat(Size(srcArg.cols, srcArg.rows), CV_8UC1);
-    }
-
     // Prepare the input image: put it into a grayscale image.
     if(srcArg.channels()==3)
     {
@@ -125,51 +115,95 @@ void StaticSaliencyFineGrained::calcIntensityChannel(Mat srcArg, Mat dstArg)
     // Calculate integral image, only once.
     integral(gray, integralImage, CV_32F);
 
+    // all the scales are summed up in a single pass over the integral image
+    getIntensityScaled(integralImage, gray, mixedValuesOn, mixedValuesOff);
 
-    for(i=0; i< numScales; i++)
-    {
-        neighborhood = neighborhoods[i] ;
-        getIntensityScaled(integralImage, gray, intensityScaledOn[i], intensityScaledOff[i], neighborhood);
-    }
-
-    mixScales(intensityScaledOn, intensityOn, intensityScaledOff, intensityOff, numScales);
+    mixScales(mixedValuesOn, intensityOn, mixedValuesOff, intensityOff);
 
     mixOnOff(intensityOn, intensityOff, intensity);
 
     intensity.copyTo(dstArg);
 }
 
-void StaticSaliencyFineGrained::getIntensityScaled(Mat integralImage, Mat gray, Mat intensityScaledOn, Mat intensityScaledOff, int neighborhood)
+static inline void addOnOff(float value, int centerVal, int& sumOn, int& sumOff)
 {
-    float value, meanOn, meanOff;
-    Point2i point;
-    int x,y;
-    intensityScaledOn.setTo(Scalar::all(0));
-    intensityScaledOff.setTo(Scalar::all(0));
+    float meanOn = centerVal - value;
+    float meanOff = value - centerVal;
 
+    if(meanOn > 0)
+        sumOn += (uchar)meanOn;
+    if(meanOff > 0)
+        sumOff += (uchar)meanOff;
+}
+
+void StaticSaliencyFineGrained::getIntensityScaled(Mat integralImage, Mat gray, Mat mixedValuesOn, Mat mixedValuesOff)
+{
+    const int numScales = 6;
+    const int neighborhoods[numScales] = {3*4, 3*4*2, 3*4*2*2, 7*4, 7*4*2, 7*4*2*2};
+    const int width = gray.cols;
+    const int height = gray.rows;
 
-    for(y = 0; y < gray.rows; y++)
+    parallel_for_(Range(0, height), [&](const Range& range)
     {
-        for(x = 0; x < gray.cols; x++)
+        std::vector<int> sumOn(width), sumOff(width);
+
+        for(int y = range.start; y < range.end; y++)
         {
-            point.x = x;
-            point.y = y;
-            value = getMean(integralImage, point, neighborhood, gray.at<uchar>(y, x));
-
-            meanOn = gray.at<uchar>(y, x) - value;
-            meanOff = value - gray.at<uchar>(y, x);
-
-            if(meanOn > 0)
-                intensityScaledOn.at<uchar>(y, x) = (uchar)meanOn;
-            else
-                intensityScaledOn.at<uchar>(y, x) = 0;
-
-            if(meanOff > 0)
-                intensityScaledOff.at<uchar>(y, x) = (uchar)meanOff;
-            else
-                intensityScaledOff.at<uchar>(y, x) = 0;
+            const uchar* grayRow = gray.ptr<uchar>(y);
+            std::fill(sumOn.begin(), sumOn.end(), 0);
+            std::fill(sumOff.begin(), sumOff.end(), 0);
+
+            for(int i = 0; i < numScales; i++)
+            {
+                const int neighborhood = neighborhoods[i];
+
+                // the neighborhoods of the columns [xStart, xEnd) are not clipped horizontally, so they all
+                // have the same area; the other columns go through getMean
+                const int xStart = std::min(neighborhood - 1, width);
+                const int xEnd = std::max(width - neighborhood, xStart);
+                int x;
+                for(x = 0; x < xStart; x++)
+                    addOnOff(getMean(integralImage, Point2i(x, y), neighborhood, grayRow[x]), grayRow[x], sumOn[x], sumOff[x]);
+                for(x = xEnd; x < width; x++)
+                    addOnOff(getMean(integralImage, Point2i(x, y), neighborhood, grayRow[x]), grayRow[x], sumOn[x], sumOff[x]);
+
+                const int y1 = std::min(std::max(y - neighborhood + 1, 0), height);
+                const int y2 = std::min(y + neighborhood + 1, height);
+                const float* top = integralImage.ptr<float>(y1);
+                const float* bottom = integralImage.ptr<float>(y2);
+                const float area = (float)(2 * neighborhood * (y2 - y1) - 1);
+                x = xStart;
+#if CV_SIMD128
+                const v_float32x4 v_area = v_setall_f32(area);
+                const v_int32x4 v_zero = v_setzero_s32();
+                for(; x <= xEnd - v_float32x4::nlanes; x += v_float32x4::nlanes)
+                {
+                    v_float32x4 center = v_cvt_f32(v_reinterpret_as_s32(v_load_expand_q(grayRow + x)));
+                    v_float32x4 value = v_load(bottom + x + neighborhood + 1) + v_load(top + x - neighborhood + 1) -
+                                        v_load(bottom + x - neighborhood + 1) - v_load(top + x + neighborhood + 1);
+                    value = (value - center) / v_area;
+                    v_store(&sumOn[x], v_load(&sumOn[x]) + v_max(v_trunc(center - value), v_zero));
+                    v_store(&sumOff[x], v_load(&sumOff[x]) + v_max(v_trunc(value - center), v_zero));
+                }
+#endif
+                for(; x < xEnd; x++)
+                {
+                    float value = bottom[x + neighborhood + 1] + top[x - neighborhood + 1] -
+                                  bottom[x - neighborhood + 1] - top[x + neighborhood + 1];
+                    value = (value - grayRow[x]) / area;
+                    addOnOff(value, grayRow[x], sumOn[x], sumOff[x]);
+                }
+            }
+
+            unsigned short* onRow = mixedValuesOn.ptr<unsigned short>(y);
+            unsigned short* offRow = mixedValuesOff.ptr<unsigned short>(y);
+            for(int x = 0; x < width; x++)
+            {
+                onRow[x] = (unsigned short)sumOn[x];
+                offRow[x] = (unsigned short)sumOff[x];
+            }
         }
-    }
+    });
 }
 
 float StaticSaliencyFineGrained::getMean(Mat srcArg, Point2i PixArg, int neighbourhood, int centerVal)
@@ -210,99 +244,49 @@ float StaticSaliencyFineGrained::getMean(Mat srcArg, Point2i PixArg, int neighbo
     return value;
 }
 
-void StaticSaliencyFineGrained::mixScales(Mat *intensityScaledOn, Mat intensityOn, Mat *intensityScaledOff, Mat intensityOff, const int numScales)
+void StaticSaliencyFineGrained::mixScales(Mat mixedValuesOn, Mat intensityOn, Mat mixedValuesOff, Mat intensityOff)
 {
-    int i=0, x, y;
-    int width = intensityScaledOn[0].cols;
-    int height = intensityScaledOn[0].rows;
-    short int maxValOn = 0, currValOn=0;
-    short int maxValOff = 0, currValOff=0;
-    int maxValSumOff = 0, maxValSumOn=0;
-    Mat mixedValuesOn(Size(width, height), CV_16UC1);
-    Mat mixedValuesOff(Size(width, height), CV_16UC1);
-
-    mixedValuesOn.setTo(Scalar::all(0));
-    mixedValuesOff.setTo(Scalar::all(0));
-
-    for(i=0;i<numScales;i++)
-    {
-        for(y=0;y<height;y++)
-            for(x=0;x<width;x++)
-            {
-                      currValOn = intensityScaledOn[i].at<uchar>(y, x);
-                      if(currValOn > maxValOn)
-                          maxValOn = currValOn;
+    int width = mixedValuesOn.cols;
+    int height = mixedValuesOn.rows;
+    double maxValSumOn = 0, maxValSumOff = 0;
 
-                      currValOff = intensityScaledOff[i].at<uchar>(y, x);
-                      if(currValOff > maxValOff)
-                          maxValOff = currValOff;
+    minMaxLoc(mixedValuesOn, NULL, &maxValSumOn);
+    minMaxLoc(mixedValuesOff, NULL, &maxValSumOff);
 
-                      mixedValuesOn.at<unsigned short>(y, x) += currValOn;
-                      mixedValuesOff.at<unsigned short>(y, x) += currValOff;
-            }
-    }
-
-    for(y=0;y<height;y++)
-        for(x=0;x<width;x++)
-        {
-            currValOn = mixedValuesOn.at<unsigned short>(y, x);
-            currValOff = mixedValuesOff.at<unsigned short>(y, x);
-                  if(currValOff > maxValSumOff)
-                      maxValSumOff = currValOff;
-                  if(currValOn > maxValSumOn)
-                      maxValSumOn = currValOn;
-        }
-
-
-    for(y=0;y<height;y++)
-        for(x=0;x<width;x++)
+    const float maxOn = (float)maxValSumOn;
+    const float maxOff = (float)maxValSumOff;
+    for(int y = 0; y < height; y++)
+    {
+        const unsigned short* mixedOnRow = mixedValuesOn.ptr<unsigned short>(y);
+        const unsigned short* mixedOffRow = mixedValuesOff.ptr<unsigned short>(y);
+        uchar* onRow = intensityOn.ptr<uchar>(y);
+        uchar* offRow = intensityOff.ptr<uchar>(y);
+        for(int x = 0; x < width; x++)
         {
-            intensityOn.at<uchar>(y, x) = (uchar)(255.*((float)(mixedValuesOn.at<unsigned short>(y, x) / (float)maxValSumOn)));
-            intensityOff.at<uchar>(y, x) = (uchar)(255.*((float)(mixedValuesOff.at<unsigned short>(y, x) / (float)maxValSumOff)));
+            onRow[x] = (uchar)(255.*((float)(mixedOnRow[x] / maxOn)));
+            offRow[x] = (uchar)(255.*((float)(mixedOffRow[x] / maxOff)));
         }
-
+    }
 }
 
 void StaticSaliencyFineGrained::mixOnOff(Mat intensityOn, Mat intensityOff, Mat intensityArg)
 {
-    int x,y;
     int width = intensityOn.cols;
     int height= intensityOn.rows;
-    int maxVal=0;
-
-    int currValOn, currValOff, maxValSumOff, maxValSumOn;
+    double maxValSumOn = 0, maxValSumOff = 0;
 
-    Mat intensity(Size(width, height), CV_8UC1);
+    minMaxLoc(intensityOn, NULL, &maxValSumOn);
+    minMaxLoc(intensityOff, NULL, &maxValSumOff);
 
-
-    maxValSumOff = 0;
-    maxValSumOn = 0;
-
-    for(y=0;y<height;y++)
-    for(x=0;x<width;x++)
+    const float maxVal = (float)std::max(maxValSumOn, maxValSumOff);
+    for(int y = 0; y < height; y++)
     {
-        currValOn = intensityOn.at<uchar>(y, x);
-        currValOff = intensityOff.at<uchar>(y, x);
-              if(currValOff > maxValSumOff)
-                  maxValSumOff = currValOff;
-              if(currValOn > maxValSumOn)
-                  maxValSumOn = currValOn;
+        const uchar* onRow = intensityOn.ptr<uchar>(y);
+        const uchar* offRow = intensityOff.ptr<uchar>(y);
+        uchar* intensityRow = intensityArg.ptr<uchar>(y);
+        for(int x = 0; x < width; x++)
+            intensityRow[x] = (uchar) (255. * (float) (onRow[x] + offRow[x]) / maxVal);
     }
-
-    if(maxValSumOn > maxValSumOff)
-        maxVal = maxValSumOn;
-    else
-        maxVal = maxValSumOff;
-
-
-
-    for(y=0;y<height;y++)
-        for(x=0;x<width;x++)
-        {
-            intensity.at<uchar>(y, x) = (uchar) (255. * (float) (intensityOn.at<uchar>(y, x) + intensityOff.at<uchar>(y, x)) / (float)maxVal);
-        }
-
-    intensity.copyTo(intensityArg);
 }
 
 
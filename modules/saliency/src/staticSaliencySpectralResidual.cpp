@@ -73,64 +73,75 @@ void StaticSaliencySpectralResidual::write( cv::FileStorage& /*fs*/) const
   //params.write( fs );
 }
 
+namespace
+{
+
+// buffers of a spectral residual computation, kept for each thread because the image size rarely changes
+struct SpectralResidualWorkspace
+{
+  Mat imageGR, grayDown;
+  Mat planes[2];
+  Mat combinedImage, imageDFT;
+  Mat magnitude, angle;
+  Mat logAmplitude, logAmplitude_blur;
+  Mat saliencyDown;
+};
+
+TLSData<SpectralResidualWorkspace>& getWorkspaces()
+{
+  static TLSData<SpectralResidualWorkspace>* workspaces = new TLSData<SpectralResidualWorkspace>();
+  return *workspaces;
+}
+
+}
+
 bool StaticSaliencySpectralResidual::computeSaliencyImpl( InputArray image, OutputArray saliencyMap )
 {
-  Mat grayTemp, grayDown;
-  std::vector<Mat> mv;
+  SpectralResidualWorkspace& ws = *getWorkspaces().get();
   Size resizedImageSize( resImWidth, resImHeight );
 
-  Mat realImage( resizedImageSize, CV_64F );
-  Mat imaginaryImage( resizedImageSize, CV_64F );
-  imaginaryImage.setTo( 0 );
-  Mat combinedImage( resizedImageSize, CV_64FC2 );
-  Mat imageDFT;
-  Mat logAmplitude;
-  Mat angle( resizedImageSize, CV_64F );
-  Mat magnitude( resizedImageSize, CV_64F );
-  Mat logAmplitude_blur, imageGR;
-
   if( image.channels() == 3 )
   {
-    cvtColor( image, imageGR, COLOR_BGR2GRAY );
-    resize( imageGR, grayDown, resizedImageSize, 0, 0, INTER_LINEAR_EXACT );
+    cvtColor( image, ws.imageGR, COLOR_BGR2GRAY );
+    resize( ws.imageGR, ws.grayDown, resizedImageSize, 0, 0, INTER_LINEAR_EXACT );
   }
   else
   {
-    resize( image, grayDown, resizedImageSize, 0, 0, INTER_LINEAR_EXACT );
+    resize( image, ws.grayDown, resizedImageSize, 0, 0, INTER_LINEAR_EXACT );
   }
 
-  grayDown.convertTo( realImage, CV_64F );
-
-  mv.push_back( realImage );
-  mv.push_back( imaginaryImage );
-  merge( mv, combinedImage );
-  dft( combinedImage, imageDFT );
-  split( imageDFT, mv );
+  ws.grayDown.convertTo( ws.planes[0], CV_64F );
+  ws.planes[1].create( resizedImageSize, CV_64F );
+  ws.planes[1].setTo( 0 );
+  merge( ws.planes, 2, ws.combinedImage );
+  dft( ws.combinedImage, ws.imageDFT );
+  split( ws.imageDFT, ws.planes );
 
   //-- Get magnitude and phase of frequency spectrum --//
-  cartToPolar( mv.at( 0 ), mv.at( 1 ), magnitude, angle, false );
-  log( magnitude + Scalar( 1 ), logAmplitude );
+  cartToPolar( ws.planes[0], ws.planes[1], ws.magnitude, ws.angle, false );
+  add( ws.magnitude, Scalar( 1 ), ws.logAmplitude );
+  log( ws.logAmplitude, ws.logAmplitude );
   //-- Blur log amplitude with averaging filter --//
-  blur( logAmplitude, logAmplitude_blur, Size( 3, 3 ), Point( -1, -1 ), BORDER_DEFAULT );
+  blur( ws.logAmplitude, ws.logAmplitude_blur, Size( 3, 3 ), Point( -1, -1 ), BORDER_DEFAULT );
 
-  exp( logAmplitude - logAmplitude_blur, magnitude );
+  subtract( ws.logAmplitude, ws.logAmplitude_blur, ws.logAmplitude );
+  exp( ws.logAmplitude, ws.magnitude );
   //-- Back to cartesian frequency domain --//
-  polarToCart( magnitude, angle, mv.at( 0 ), mv.at( 1 ), false );
-  merge( mv, imageDFT );
-  dft( imageDFT, combinedImage, DFT_INVERSE );
-  split( combinedImage, mv );
+  polarToCart( ws.magnitude, ws.angle, ws.planes[0], ws.planes[1], false );
+  merge( ws.planes, 2, ws.imageDFT );
+  dft( ws.imageDFT, ws.combinedImage, DFT_INVERSE );
+  split( ws.combinedImage, ws.planes );
 
-  cartToPolar( mv.at( 0 ), mv.at( 1 ), magnitude, angle, false );
-  GaussianBlur( magnitude, magnitude, Size( 5, 5 ), 8, 0, BORDER_DEFAULT );
-  magnitude = magnitude.mul( magnitude );
+  cartToPolar( ws.planes[0], ws.planes[1], ws.magnitude, ws.angle, false );
+  GaussianBlur( ws.magnitude, ws.magnitude, Size( 5, 5 ), 8, 0, BORDER_DEFAULT );
+  multiply( ws.magnitude, ws.magnitude, ws.magnitude );
 
   double minVal, maxVal;
-  minMaxLoc( magnitude, &minVal, &maxVal );
+  minMaxLoc( ws.magnitude, &minVal, &maxVal );
 
-  magnitude = magnitude / maxVal;
-  magnitude.convertTo( magnitude, CV_32F );
+  ws.magnitude.convertTo( ws.saliencyDown, CV_32F, 1. / maxVal );
 
-  resize( magnitude, saliencyMap, image.size(), 0, 0, INTER_LINEAR_EXACT );
+  resize( ws.saliencyDown, saliencyMap, image.size(), 0, 0, INTER_LINEAR_EXACT );
 
 #ifdef SALIENCY_DEBUG
   // visualize saliency map
@@ -50,4 +50,26 @@ TEST(CV_StaticSaliencySpectralResidual, should_not_contain_nan)
     EXPECT_FALSE(std::isnan(saliencyMap.at<float>(0, 0)));
 }
 
+TEST(CV_StaticSaliencySpectralResidual, batch_matches_single_images)
+{
+    Ptr<StaticSaliencySpectralResidual> saliencyAlgorithm = StaticSaliencySpectralResidual::create();
+    RNG& rng = theRNG();
+    std::vector<Mat> images(5);
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        images[i].create(48 + 16 * (int)i, 80, CV_8U);
+        rng.fill(images[i], RNG::UNIFORM, 0, 256);
+    }
+
+    std::vector<Mat> saliencyMaps;
+    ASSERT_TRUE(saliencyAlgorithm->computeSaliencyBatch(images, saliencyMaps));
+    ASSERT_EQ(images.size(), saliencyMaps.size());
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        Mat saliencyMap;
+        ASSERT_TRUE(saliencyAlgorithm->computeSaliency(images[i], saliencyMap));
+        EXPECT_EQ(0, cvtest::norm(saliencyMap, saliencyMaps[i], NORM_INF)) << "image " << i;
+    }
+}
+
 }} // namespace
@@ -128,12 +128,23 @@ enum { SFM_REFINE_FOCAL_LENGTH         = (1 << 0),  // libmv::BUNDLE_FOCAL_LENGT
 };
 
 
+/** @brief Linear solvers of the bundle adjustment.
+ */
+enum { SFM_BUNDLE_ITERATIVE_SCHUR = 0,  // libmv::BUNDLE_ITERATIVE_SCHUR
+       SFM_BUNDLE_DENSE_SCHUR     = 1,  // libmv::BUNDLE_DENSE_SCHUR
+       SFM_BUNDLE_SPARSE_SCHUR    = 2   // libmv::BUNDLE_SPARSE_SCHUR
+};
+
 /** @brief Data structure describing the reconstruction options.
   @param _keyframe1 first keyframe used in order to initialize the reconstruction.
   @param _keyframe2 second keyframe used in order to initialize the reconstruction.
   @param _refine_intrinsics camera parameter or combination of parameters to refine.
   @param _select_keyframes allows to select automatically the initial keyframes. If 1 then autoselection is enabled. If 0 then is disabled.
   @param _verbosity_level verbosity logs level for Glog. If -1 then logs are disabled, otherwise the log level will be the input integer.
+  @param _bundle_num_threads number of threads of the bundle adjustment. If 0 then all OpenMP threads are used when libmv is built with OpenMP, a single thread otherwise.
+  @param _bundle_linear_solver linear solver of the bundle adjustment, one of SFM_BUNDLE_ITERATIVE_SCHUR, SFM_BUNDLE_DENSE_SCHUR or SFM_BUNDLE_SPARSE_SCHUR. The sparse solver needs Ceres built with a sparse linear algebra library.
+  @param _matching_window when reconstructing from images, number of previous images of the sequence every image is matched with. If 0 then all the pairs of images are matched.
+  @param _features_cache_dir when reconstructing from images, existing directory where the features of every image are stored and loaded from in the next runs. If empty then the cache is disabled.
  */
 class CV_EXPORTS_W_SIMPLE libmv_ReconstructionOptions
 {
@@ -143,16 +154,28 @@ public:
                               const int _keyframe2=2,
                               const int _refine_intrinsics=1,
                               const int _select_keyframes=1,
-                              const int _verbosity_level=-1)
+                              const int _verbosity_level=-1,
+                              const int _bundle_num_threads=0,
+                              const int _bundle_linear_solver=SFM_BUNDLE_ITERATIVE_SCHUR,
+                              const int _matching_window=0,
+                              const String& _features_cache_dir=String())
     : keyframe1(_keyframe1), keyframe2(_keyframe2),
       refine_intrinsics(_refine_intrinsics),
       select_keyframes(_select_keyframes),
-      verbosity_level(_verbosity_level) {}
+      verbosity_level(_verbosity_level),
+      bundle_num_threads(_bundle_num_threads),
+      bundle_linear_solver(_bundle_linear_solver),
+      matching_window(_matching_window),
+      features_cache_dir(_features_cache_dir) {}
 
   CV_PROP_RW int keyframe1, keyframe2;
   CV_PROP_RW int refine_intrinsics;
   CV_PROP_RW int select_keyframes;
   CV_PROP_RW int verbosity_level;
+  CV_PROP_RW int bundle_num_threads;
+  CV_PROP_RW int bundle_linear_solver;
+  CV_PROP_RW int matching_window;
+  CV_PROP_RW String features_cache_dir;
 };
 
 
@@ -239,6 +262,16 @@ public:
   virtual void run(const std::vector<String> &images, InputOutputArray K, OutputArray Rs,
                    OutputArray Ts, OutputArray points3d) CV_OVERRIDE = 0;
 
+  /** @brief Extends the last reconstruction with new frames or tracks.
+    @param points2d Input vector of vectors of 2d points (the inner vector is per image), with the frames and tracks of the last run followed by the new ones.
+
+    The cameras and points already estimated are kept as initial guess: only the new cameras are
+    resected and the new points intersected before the bundle adjustment, so the two frames
+    initialization is not repeated. If there is no valid reconstruction yet, it calls run().
+  */
+  CV_WRAP
+  virtual void update(InputArrayOfArrays points2d) = 0;
+
   /** @brief Returns the computed reprojection error.
   */
   CV_WRAP
@@ -0,0 +1,65 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+// numViews cameras looking at numPoints random points in front of them, with noisy projections
+static void makeScene(int numViews, int numPoints, std::vector<Mat>& points2d, std::vector<Mat>& projections)
+{
+    RNG rng(0);
+    Mat points3d(3, numPoints, CV_64F);
+    rng.fill(points3d.row(0), RNG::UNIFORM, -1, 1);
+    rng.fill(points3d.row(1), RNG::UNIFORM, -1, 1);
+    rng.fill(points3d.row(2), RNG::UNIFORM, 4, 6);
+    const Matx33d K(800, 0, 320, 0, 800, 240, 0, 0, 1);
+
+    points2d.resize(numViews);
+    projections.resize(numViews);
+    for (int v = 0; v < numViews; ++v)
+    {
+        Vec3d rvec(0, 0.05 * v, 0.01 * v);
+        Matx33d R;
+        Rodrigues(rvec, R);
+        Vec3d t(-0.3 * v, 0.02 * v, 0);
+        sfm::projectionFromKRt(K, R, t, projections[v]);
+
+        Mat P = projections[v], X;
+        sfm::euclideanToHomogeneous(points3d, X);
+        Mat x = P * X;
+        sfm::homogeneousToEuclidean(x, points2d[v]);
+        Mat noise(points2d[v].size(), CV_64F);
+        rng.fill(noise, RNG::NORMAL, 0, 0.5);
+        points2d[v] += noise;
+    }
+}
+
+typedef tuple<int, int> TriangulateParams_t;
+typedef perf::TestBaseWithParam<TriangulateParams_t> TriangulatePoints;
+
+PERF_TEST_P(TriangulatePoints, DLT, Combine(Values(2, 4), Values(1000, 10000)))
+{
+    std::vector<Mat> points2d, projections;
+    makeScene(get<0>(GetParam()), get<1>(GetParam()), points2d, projections);
+    Mat points3d;
+
+    TEST_CYCLE() sfm::triangulatePoints(points2d, projections, points3d);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef perf::TestBaseWithParam<int> NormalizedEightPoint;
+
+PERF_TEST_P(NormalizedEightPoint, solve, Values(8, 100, 1000))
+{
+    std::vector<Mat> points2d, projections;
+    makeScene(2, GetParam(), points2d, projections);
+    Mat F;
+
+    TEST_CYCLE() sfm::normalizedEightPointSolver(points2d[0], points2d[1], F);
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
@@ -357,6 +357,30 @@ static void finishReconstruction(
 }
 
 
+/* Sets the solver options of the bundle adjustments of the calling thread
+ * for the lifetime of the object
+ */
+
+class libmv_ScopedBundleSolverOptions {
+ public:
+  explicit libmv_ScopedBundleSolverOptions(
+      const libmv_ReconstructionOptions &libmv_reconstruction_options)
+    : previous_(GetBundleSolverOptions()) {
+    BundleSolverOptions options;
+    options.num_threads = libmv_reconstruction_options.bundle_num_threads;
+    options.linear_solver = libmv_reconstruction_options.bundle_linear_solver;
+    SetBundleSolverOptions(options);
+  }
+
+  ~libmv_ScopedBundleSolverOptions() {
+    SetBundleSolverOptions(previous_);
+  }
+
+ private:
+  BundleSolverOptions previous_;
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////////////
 // Based on the 'libmv_solveReconstruction()' function from 'libmv_capi' (blender API)
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -370,6 +394,7 @@ std::shared_ptr<libmv_Reconstruction> libmv_solveReconstruction(
     const libmv_CameraIntrinsicsOptions* libmv_camera_intrinsics_options,
     libmv_ReconstructionOptions* libmv_reconstruction_options) {
   std::shared_ptr<libmv_Reconstruction> libmv_reconstruction = std::make_shared<libmv_Reconstruction>();
+  libmv_ScopedBundleSolverOptions bundle_options(*libmv_reconstruction_options);
 
   Tracks tracks = libmv_tracks;
   EuclideanReconstruction &reconstruction =
@@ -443,4 +468,45 @@ std::shared_ptr<libmv_Reconstruction> libmv_solveReconstruction(
   return libmv_reconstruction;
 }
 
+/* Extend a valid reconstruction with the cameras and points of new tracks.
+ * The cameras and points already reconstructed are kept as initial guess, so
+ * only the missing ones are resected and intersected before the final bundle.
+ */
+
+static
+void libmv_updateReconstruction(
+    const Tracks &libmv_tracks,
+    libmv_Reconstruction *libmv_reconstruction,
+    libmv_ReconstructionOptions* libmv_reconstruction_options) {
+  CV_Assert(libmv_reconstruction->is_valid);
+  libmv_ScopedBundleSolverOptions bundle_options(*libmv_reconstruction_options);
+
+  EuclideanReconstruction &reconstruction =
+    libmv_reconstruction->reconstruction;
+  CameraIntrinsics *camera_intrinsics = libmv_reconstruction->intrinsics.get();
+
+  /* The new tracks are normalized with the refined intrinsics. */
+  Tracks normalized_tracks;
+  libmv_getNormalizedTracks(libmv_tracks, *camera_intrinsics, &normalized_tracks);
+
+  EuclideanCompleteReconstruction(normalized_tracks,
+                                  &reconstruction,
+                                  NULL);
+
+  if (libmv_reconstruction_options->refine_intrinsics) {
+    libmv_solveRefineIntrinsics(
+                                libmv_tracks,
+                                libmv_reconstruction_options->refine_intrinsics,
+                                libmv::BUNDLE_NO_CONSTRAINTS,
+                                &reconstruction,
+                                camera_intrinsics);
+  }
+
+  EuclideanScaleToUnity(&reconstruction);
+
+  finishReconstruction(libmv_tracks,
+                       *camera_intrinsics,
+                       libmv_reconstruction);
+}
+
 #endif
@@ -18,8 +18,11 @@
 // FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 // IN THE SOFTWARE.
 
+#include <opencv2/core/utility.hpp>
 #include <opencv2/imgcodecs.hpp>
 
+#include <sstream>
+
 #include "libmv/base/vector_utils.h"
 #include "libmv/correspondence/feature.h"
 #include "libmv/correspondence/feature_matching.h"
@@ -43,6 +46,117 @@ nRobustViewMatching::nRobustViewMatching(
   m_pDescriber = pDescriber;
 }
 
+nRobustViewMatching::nRobustViewMatching(
+    const Feature2DFactory & detectorFactory,
+    const Feature2DFactory & describerFactory)
+  : m_detectorFactory(detectorFactory),
+    m_describerFactory(describerFactory) {
+  m_pDetector = detectorFactory();
+  m_pDescriber = describerFactory();
+}
+
+namespace {
+
+/// Detect and describe the keypoints of an image.
+bool describeImage(const string & filename,
+                   cv::Feature2D & detector,
+                   cv::Feature2D & describer,
+                   FeatureSet * KeypointData)
+{
+  cv::Mat im_cv = cv::imread(filename, 0);
+  if (im_cv.empty()) {
+    LOG(FATAL) << "Failed loading image: " << filename;
+    return false;
+  }
+
+  std::vector<cv::KeyPoint> features_cv;
+  detector.detect( im_cv, features_cv );
+
+  cv::Mat descriptors;
+  describer.compute(im_cv, features_cv, descriptors);
+
+  // Copy data.
+  KeypointData->features.resize(descriptors.rows);
+  for(int i = 0;i < descriptors.rows; ++i)
+  {
+    KeypointFeature & feat = KeypointData->features[i];
+    descriptors.row(i).copyTo(feat.descriptor);
+    PointFeature point(features_cv[i]);
+    *(PointFeature*)(&feat) = point;
+  }
+  return true;
+}
+
+} // namespace
+
+string nRobustViewMatching::featuresCachePath(const string & filename) const
+{
+  std::ostringstream path;
+  path << m_featuresCacheDir << "/" << std::hex
+       << std::hash<string>()(filename) << ".yml.gz";
+  return path.str();
+}
+
+bool nRobustViewMatching::loadFeatures(const string & filename,
+                                       FeatureSet * KeypointData) const
+{
+  if (m_featuresCacheDir.empty())
+    return false;
+
+  cv::FileStorage fs(featuresCachePath(filename), cv::FileStorage::READ);
+  if (!fs.isOpened() || (string)fs["image"] != filename)
+    return false;
+
+  cv::Mat points, descriptors;
+  fs["points"] >> points;
+  fs["descriptors"] >> descriptors;
+  if (points.rows != descriptors.rows ||
+      (!points.empty() && (points.type() != CV_32F || points.cols != 4)))
+    return false;
+
+  KeypointData->features.resize(descriptors.rows);
+  for (int i = 0; i < descriptors.rows; ++i)
+  {
+    KeypointFeature & feat = KeypointData->features[i];
+    const float * p = points.ptr<float>(i);
+    feat.coords[0] = p[0];
+    feat.coords[1] = p[1];
+    feat.scale = p[2];
+    feat.orientation = p[3];
+    descriptors.row(i).copyTo(feat.descriptor);
+  }
+  return true;
+}
+
+void nRobustViewMatching::saveFeatures(const string & filename,
+                                       const FeatureSet & KeypointData) const
+{
+  if (m_featuresCacheDir.empty())
+    return;
+
+  const int n = (int)KeypointData.features.size();
+  cv::Mat points(n, 4, CV_32F), descriptors;
+  for (int i = 0; i < n; ++i)
+  {
+    const KeypointFeature & feat = KeypointData.features[i];
+    float * p = points.ptr<float>(i);
+    p[0] = feat.coords[0];
+    p[1] = feat.coords[1];
+    p[2] = feat.scale;
+    p[3] = feat.orientation;
+    descriptors.push_back(feat.descriptor);
+  }
+
+  cv::FileStorage fs(featuresCachePath(filename), cv::FileStorage::WRITE);
+  if (!fs.isOpened()) {
+    LOG(INFO) << "[nViewMatching::saveFeatures] "
+              << "Could not write the features cache of: " << filename;
+    return;
+  }
+  fs << "image" << filename << "points" << points
+     << "descriptors" << descriptors;
+}
+
 /**
  * Compute the data and store it in the class map<string,T>
  *
@@ -52,38 +166,88 @@ nRobustViewMatching::nRobustViewMatching(
  */
 bool nRobustViewMatching::computeData(const string & filename)
 {
-  cv::Mat im_cv = cv::imread(filename, 0);
-  if (im_cv.empty()) {
-    LOG(FATAL) << "Failed loading image: " << filename;
-    return false;
-  }
-  else
+  FeatureSet KeypointData;
+  if (!loadFeatures(filename, &KeypointData))
   {
-    libmv::vector<libmv::Feature *> features;
-    std::vector<cv::KeyPoint> features_cv;
-    m_pDetector->detect( im_cv, features_cv );
-    features.resize(features_cv.size());
-    for(size_t i=0; i<features_cv.size(); ++i)
-      features[i] = new libmv::PointFeature(features_cv[i]);
-
-    cv::Mat descriptors;
-    m_pDescriber->compute(im_cv, features_cv, descriptors);
-
-    // Copy data.
-    m_ViewData.insert( make_pair(filename,FeatureSet()) );
-    FeatureSet & KeypointData = m_ViewData[filename];
-    KeypointData.features.resize(descriptors.rows);
-    for(int i = 0;i < descriptors.rows; ++i)
-    {
-      KeypointFeature & feat = KeypointData.features[i];
-      descriptors.row(i).copyTo(feat.descriptor);
-      *(PointFeature*)(&feat) = *(PointFeature*)features[i];
+    if (!describeImage(filename, *m_pDetector, *m_pDescriber, &KeypointData))
+      return false;
+    saveFeatures(filename, KeypointData);
+  }
+  m_ViewData[filename].features.swap(KeypointData.features);
+  return true;
+}
+
+bool nRobustViewMatching::computeAllData(const std::vector<string> & vec_data)
+{
+  const int n = (int)vec_data.size();
+  std::vector<FeatureSet> data(n);
+  std::vector<unsigned char> done(n, 0);
+
+  // The shared detector and describer are not reentrant, so without
+  // factories the images are processed one after the other.
+  const bool concurrent = m_detectorFactory && m_describerFactory;
+  cv::parallel_for_(cv::Range(0, n), [&](const cv::Range & range) {
+    cv::Ptr<cv::Feature2D> detector, describer;
+    for (int i = range.start; i < range.end; ++i) {
+      if (loadFeatures(vec_data[i], &data[i])) {
+        done[i] = 1;
+        continue;
+      }
+      if (!detector) {
+        detector = concurrent ? m_detectorFactory() : cv::Ptr<cv::Feature2D>(m_pDetector);
+        describer = concurrent ? m_describerFactory() : cv::Ptr<cv::Feature2D>(m_pDescriber);
+      }
+      if (describeImage(vec_data[i], *detector, *describer, &data[i])) {
+        saveFeatures(vec_data[i], data[i]);
+        done[i] = 1;
+      }
     }
+  }, concurrent ? n : 1);
 
-    DeleteElements(&features);
+  bool bRes = true;
+  for (int i = 0; i < n; ++i) {
+    if (done[i])
+      m_ViewData[vec_data[i]].features.swap(data[i].features);
+    bRes &= done[i] != 0;
+  }
+  return bRes;
+}
 
-    return true;
+bool nRobustViewMatching::MatchPairs(const std::vector< pair<int,int> > & pairs)
+{
+  // The putative matches are independent, while the robust filtering draws
+  // random samples and grows the tracks, so it keeps the sequential order.
+  const int n = (int)pairs.size();
+  std::vector<Matches> putative(n);
+  const map<string,FeatureSet> & views = m_ViewData;
+  cv::parallel_for_(cv::Range(0, n), [&](const cv::Range & range) {
+    for (int k = range.start; k < range.end; ++k) {
+      //TODO(pmoulon) make FindCandidatesMatches a parameter.
+      FindCandidateMatches_Ratio(
+        views.find(m_vec_InputNames[pairs[k].first])->second,
+        views.find(m_vec_InputNames[pairs[k].second])->second,
+        &putative[k]);
+    }
+  });
+
+  for (int k = 0; k < n; ++k) {
+    const int iDataA = pairs[k].first, iDataB = pairs[k].second;
+    Matches & matches = putative[k];
+    Matches consistent_matches;
+    if (computeConstrainMatches(matches,iDataA,iDataB,&consistent_matches))
+    {
+      matches = consistent_matches;
+    }
+    if (matches.NumTracks() > 0)
+    {
+      m_sharedData.insert(
+        make_pair(
+          make_pair(m_vec_InputNames[iDataA],m_vec_InputNames[iDataB]),
+          matches)
+        );
+    }
   }
+  return true;
 }
 
 /**
@@ -122,36 +286,20 @@ bool nRobustViewMatching::MatchData(const string & dataA, const string & dataB)
   int iDataB = find(m_vec_InputNames.begin(), m_vec_InputNames.end(), dataB)
                 - m_vec_InputNames.begin();
 
-  Matches matches;
-  //TODO(pmoulon) make FindCandidatesMatches a parameter.
-  FindCandidateMatches_Ratio(m_ViewData[dataA],
-                       m_ViewData[dataB],
-                       &matches);
-  Matches consistent_matches;
-  if (computeConstrainMatches(matches,iDataA,iDataB,&consistent_matches))
-  {
-    matches = consistent_matches;
-  }
-  if (matches.NumTracks() > 0)
-  {
-    m_sharedData.insert(
-      make_pair(
-        make_pair(m_vec_InputNames[iDataA],m_vec_InputNames[iDataB]),
-        matches)
-      );
-  }
-
-  return true;
+  return MatchPairs(std::vector< pair<int,int> >(1, make_pair(iDataA, iDataB)));
 }
 
 /**
 * From a series of element it computes the cross putative match list.
 *
 * \param[in] vec_data The data on which we want compute cross matches.
+* \param[in] window If positive, every element is only matched with the
+*                   window previous ones (sequential scan order).
 *
 * \return True if success (and any matches was found).
 */
-bool nRobustViewMatching::computeCrossMatch( const std::vector<string> & vec_data)
+bool nRobustViewMatching::computeCrossMatch( const std::vector<string> & vec_data,
+                                             int window)
 {
   if (m_pDetector == NULL || m_pDescriber == NULL)  {
     LOG(FATAL) << "Invalid Detector or Describer.";
@@ -159,23 +307,21 @@ bool nRobustViewMatching::computeCrossMatch( const std::vector<string> & vec_dat
   }
 
   m_vec_InputNames = vec_data;
-  bool bRes = true;
-  for (int i=0; i < vec_data.size(); ++i) {
-    bRes &= computeData(vec_data[i]);
-  }
+  computeAllData(vec_data);
 
-  bool bRes2 = true;
+  std::vector< pair<int,int> > pairs;
   for (int i=0; i < vec_data.size(); ++i) {
-    for (int j=0; j < i; ++j)
+    const int first = window > 0 ? std::max(0, i - window) : 0;
+    for (int j=first; j < i; ++j)
     {
       if (m_ViewData.find(vec_data[i]) != m_ViewData.end() &&
         m_ViewData.find(vec_data[j]) != m_ViewData.end())
       {
-        bRes2 &= this->MatchData( vec_data[i], vec_data[j]);
+        pairs.push_back(make_pair(i, j));
       }
     }
   }
-  return bRes2;
+  return MatchPairs(pairs);
 }
 
 bool nRobustViewMatching::computeRelativeMatch(
@@ -186,19 +332,17 @@ bool nRobustViewMatching::computeRelativeMatch(
   }
 
   m_vec_InputNames = vec_data;
-  bool bRes = true;
-  for (int i=0; i < vec_data.size(); ++i) {
-    bRes &= computeData(vec_data[i]);
-  }
+  computeAllData(vec_data);
 
-  bool bRes2 = true;
+  std::vector< pair<int,int> > pairs;
   for (int i=1; i < vec_data.size(); ++i) {
     if (m_ViewData.find(vec_data[i-1]) != m_ViewData.end() &&
         m_ViewData.find(vec_data[i])   != m_ViewData.end())
     {
-      bRes2 &= this->MatchData(vec_data[i-1], vec_data[i]);
+      pairs.push_back(make_pair(i-1, i));
     }
   }
+  bool bRes2 = MatchPairs(pairs);
   // Match the first and the last images (in order to detect loop)
   bRes2 &= this->MatchData(vec_data[0], vec_data[vec_data.size() - 1]);
   return bRes2;
@@ -22,6 +22,7 @@
 #define LIBMV_CORRESPONDENCE_N_ROBUST_VIEW_MATCHING_INTERFACE_H_
 
 struct FeatureSet;
+#include <functional>
 #include <map>
 
 #include "libmv/correspondence/feature.h"
@@ -41,10 +42,22 @@ class nRobustViewMatching :public nViewMatchingInterface  {
   // The class do not handle memory management over this two parameter.
   nRobustViewMatching(cv::Ptr<cv::FeatureDetector> pDetector,
                       cv::Ptr<cv::DescriptorExtractor> pDescriber);
+  // Constructor (Specify how to create the detector and the describer)
+  // Every worker creates its own instances so the images are processed
+  // concurrently.
+  typedef std::function<cv::Ptr<cv::Feature2D>()> Feature2DFactory;
+  nRobustViewMatching(const Feature2DFactory & detectorFactory,
+                      const Feature2DFactory & describerFactory);
   //TODO(pmoulon) Add a constructor with a Detector and a Descriptor
   // Add also a Template function to make the match robust..
   ~nRobustViewMatching(){};
 
+  /**
+   * Store the computed features of every image in the given directory and
+   * load them from there in the next runs. Empty disables the cache.
+   */
+  void setFeaturesCacheDir(const string & dir) { m_featuresCacheDir = dir; }
+
   /**
    * Compute the data and store it in the class map<string,T>
    *
@@ -70,10 +83,13 @@ class nRobustViewMatching :public nViewMatchingInterface  {
   * From a series of element it computes the cross putative match list.
   *
   * \param[in] vec_data The data on which we want compute cross matches.
+  * \param[in] window If positive, every element is only matched with the
+  *                   window previous ones (sequential scan order).
   *
   * \return True if success (and any matches was found).
   */
-  bool computeCrossMatch( const std::vector<string> & vec_data);
+  bool computeCrossMatch( const std::vector<string> & vec_data,
+                          int window = 0);
 
 
   /**
@@ -112,6 +128,16 @@ class nRobustViewMatching :public nViewMatchingInterface  {
     { return m_tracks;  }
 
 private :
+  /// Compute the data of all the input names, concurrently if possible.
+  bool computeAllData(const std::vector<string> & vec_data);
+  /// Match the given pairs, the putative matches are computed concurrently.
+  bool MatchPairs(const std::vector< pair<int,int> > & pairs);
+  /// Load the features of an image from the cache, false if not there.
+  bool loadFeatures(const string & filename, FeatureSet * features) const;
+  /// Store the features of an image in the cache.
+  void saveFeatures(const string & filename, const FeatureSet & features) const;
+  string featuresCachePath(const string & filename) const;
+
   /// Input data names
   std::vector<string> m_vec_InputNames;
   /// Data that represent each named element.
@@ -130,6 +156,10 @@ private :
   std::shared_ptr<cv::FeatureDetector> m_pDetector;
   /// Interface to describe Keypoint.
   std::shared_ptr<cv::DescriptorExtractor> m_pDescriber;
+  /// Creation of the detector and the describer of every worker.
+  Feature2DFactory m_detectorFactory, m_describerFactory;
+  /// Directory of the features cache, none if empty.
+  string m_featuresCacheDir;
 };
 
 } // using namespace correspondence
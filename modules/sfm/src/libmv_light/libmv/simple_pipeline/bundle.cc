@@ -40,6 +40,55 @@
 
 namespace libmv {
 
+namespace {
+
+// Options of the bundle adjustments of each thread.
+thread_local BundleSolverOptions bundle_solver_options;
+
+// Configure the solver from the options of the calling thread.
+void ConfigureSolverOptions(ceres::Solver::Options *options) {
+  const BundleSolverOptions &solver_options = bundle_solver_options;
+  options->use_nonmonotonic_steps = true;
+  options->preconditioner_type = ceres::SCHUR_JACOBI;
+  switch (solver_options.linear_solver) {
+    case BUNDLE_DENSE_SCHUR:
+      options->linear_solver_type = ceres::DENSE_SCHUR;
+      break;
+    case BUNDLE_SPARSE_SCHUR:
+      options->linear_solver_type = ceres::SPARSE_SCHUR;
+      break;
+    default:
+      options->linear_solver_type = ceres::ITERATIVE_SCHUR;
+      options->use_explicit_schur_complement = true;
+      break;
+  }
+  options->use_inner_iterations = true;
+  options->max_num_iterations = 100;
+
+  int num_threads = solver_options.num_threads;
+#ifdef _OPENMP
+  if (num_threads <= 0)
+    num_threads = omp_get_max_threads();
+#endif
+  if (num_threads > 0) {
+    options->num_threads = num_threads;
+#if CERES_VERSION_MAJOR <= 1 && CERES_VERSION_MINOR <= 13
+    // deprecated since Ceres 1.14.0
+    options->num_linear_solver_threads = num_threads;
+#endif
+  }
+}
+
+}  // namespace
+
+void SetBundleSolverOptions(const BundleSolverOptions &options) {
+  bundle_solver_options = options;
+}
+
+const BundleSolverOptions &GetBundleSolverOptions() {
+  return bundle_solver_options;
+}
+
 // The intrinsics need to get combined into a single parameter block; use these
 // enums to index instead of numeric constants.
 enum {
@@ -421,20 +470,7 @@ void EuclideanBundlePointsOnly(const DistortionModelType distortion_model,
 
   // Configure the solver.
   ceres::Solver::Options options;
-  options.use_nonmonotonic_steps = true;
-  options.preconditioner_type = ceres::SCHUR_JACOBI;
-  options.linear_solver_type = ceres::ITERATIVE_SCHUR;
-  options.use_explicit_schur_complement = true;
-  options.use_inner_iterations = true;
-  options.max_num_iterations = 100;
-
-#ifdef _OPENMP
-  options.num_threads = omp_get_max_threads();
-#if CERES_VERSION_MAJOR <= 1 && CERES_VERSION_MINOR <= 13
-  // deprecated since Ceres 1.14.0
-  options.num_linear_solver_threads = omp_get_max_threads();
-#endif
-#endif
+  ConfigureSolverOptions(&options);
 
   // Solve!
   ceres::Solver::Summary summary;
@@ -594,20 +630,7 @@ void EuclideanBundleCommonIntrinsics(
 
   // Configure the solver.
   ceres::Solver::Options options;
-  options.use_nonmonotonic_steps = true;
-  options.preconditioner_type = ceres::SCHUR_JACOBI;
-  options.linear_solver_type = ceres::ITERATIVE_SCHUR;
-  options.use_explicit_schur_complement = true;
-  options.use_inner_iterations = true;
-  options.max_num_iterations = 100;
-
-#ifdef _OPENMP
-  options.num_threads = omp_get_max_threads();
-#if CERES_VERSION_MAJOR <= 1 && CERES_VERSION_MINOR <= 13
-  // deprecated since Ceres 1.14.0
-  options.num_linear_solver_threads = omp_get_max_threads();
-#endif
-#endif
+  ConfigureSolverOptions(&options);
 
   // Solve!
   ceres::Solver::Summary summary;
@@ -55,6 +55,35 @@ struct BundleEvaluation {
   Mat jacobian;
 };
 
+enum BundleLinearSolver {
+  BUNDLE_ITERATIVE_SCHUR = 0,
+  BUNDLE_DENSE_SCHUR = 1,
+  BUNDLE_SPARSE_SCHUR = 2,
+};
+
+struct BundleSolverOptions {
+  BundleSolverOptions() :
+    num_threads(0),
+    linear_solver(BUNDLE_ITERATIVE_SCHUR) {
+  }
+
+  // Number of threads used by the solver, 0 keeps the default one:
+  // all OpenMP threads when OpenMP is available, a single thread elsewhere.
+  int num_threads;
+
+  // One of BundleLinearSolver. The iterative Schur solver with a Schur
+  // Jacobi preconditioner is the default, the sparse Schur solver needs
+  // Ceres to be built with a sparse linear algebra library.
+  int linear_solver;
+};
+
+/*!
+    Set the solver options of the bundle adjustments run by the calling
+    thread, including the ones run by the reconstruction pipeline.
+*/
+void SetBundleSolverOptions(const BundleSolverOptions &options);
+const BundleSolverOptions &GetBundleSolverOptions();
+
 /*!
     Refine camera poses and 3D coordinates using bundle adjustment.
 
@@ -124,17 +124,22 @@ std::shared_ptr<libmv_Reconstruction> libmv_solveReconstructionImpl(
   const libmv_CameraIntrinsicsOptions* libmv_camera_intrinsics_options,
   libmv_ReconstructionOptions* libmv_reconstruction_options)
 {
-  Ptr<Feature2D> edetector = ORB::create(10000);
-  Ptr<Feature2D> edescriber = xfeatures2d::DAISY::create();
-  //Ptr<Feature2D> edescriber = xfeatures2d::LATCH::create(64, true, 4);
+  // Every image is detected and described by its own instances
+  libmv::correspondence::nRobustViewMatching::Feature2DFactory edetector =
+    []() -> Ptr<Feature2D> { return ORB::create(10000); };
+  libmv::correspondence::nRobustViewMatching::Feature2DFactory edescriber =
+    []() -> Ptr<Feature2D> { return xfeatures2d::DAISY::create(); };
+  //  []() -> Ptr<Feature2D> { return xfeatures2d::LATCH::create(64, true, 4); };
   std::vector<std::string> sImages;
   for (int i=0;i<images.size();i++)
       sImages.push_back(images[i].c_str());
   cout << "Initialize nViewMatcher ... ";
   libmv::correspondence::nRobustViewMatching nViewMatcher(edetector, edescriber);
+  nViewMatcher.setFeaturesCacheDir(libmv_reconstruction_options->features_cache_dir);
 
   cout << "OK" << endl << "Performing Cross Matching ... ";
-  nViewMatcher.computeCrossMatch(sImages); cout << "OK" << endl;
+  nViewMatcher.computeCrossMatch(sImages, libmv_reconstruction_options->matching_window);
+  cout << "OK" << endl;
 
   // Building tracks
   libmv::Tracks tracks;
@@ -189,6 +194,31 @@ public:
     CV_Assert(libmv_reconstruction_);
   }
 
+  /* Extend the last reconstruction given 2d points
+   */
+
+  virtual void update(InputArrayOfArrays _points2d)
+  {
+    if (!libmv_reconstruction_ || !libmv_reconstruction_->is_valid)
+    {
+      run(_points2d);
+      return;
+    }
+
+    std::vector<Mat> points2d;
+    _points2d.getMatVector(points2d);
+    CV_Assert( _points2d.total() >= 2 );
+
+    // Parse 2d points to Tracks
+    Tracks tracks;
+    parser_2D_tracks(points2d, tracks);
+
+    // Perform reconstruction
+    libmv_updateReconstruction(tracks,
+                               libmv_reconstruction_.get(),
+                               &libmv_reconstruction_options_);
+  }
+
   virtual void run(InputArrayOfArrays points2d, InputOutputArray K, OutputArray Rs,
                    OutputArray Ts, OutputArray points3d)
   {
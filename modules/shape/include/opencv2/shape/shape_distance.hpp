@@ -180,6 +180,18 @@ public:
      */
     CV_WRAP virtual void setTransformAlgorithm(Ptr<ShapeTransformer> transformer) = 0;
     CV_WRAP virtual Ptr<ShapeTransformer> getTransformAlgorithm() const = 0;
+
+    /** @brief Compute the shape distances between a query shape and many other shapes, e.g. for shape retrieval.
+
+    The shapes are compared in parallel when the transformation algorithm is a thin plate spline or
+    an affine transformer, otherwise one after the other. The image appearance cost is not supported,
+    as its images are set for a single pair of shapes.
+
+    @param query Contour defining the query shape.
+    @param contours Contours defining the shapes compared to the query.
+    @param distances For every contour, the same value as computeDistance(query, contour).
+     */
+    CV_WRAP virtual void computeDistances(InputArray query, InputArrayOfArrays contours, CV_OUT std::vector<float>& distances) = 0;
 };
 
 /* Complete constructor */
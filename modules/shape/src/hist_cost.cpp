@@ -40,10 +40,40 @@
 //M*/
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
 
+//! copy of the descriptors with every row normalized to a unit sum
+static void normalizeRows(const Mat& descriptors, Mat& normalized)
+{
+    descriptors.copyTo(normalized);
+    parallel_for_(Range(0, normalized.rows), [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            Mat row = normalized.row(i);
+            row /= (sum(row)[0] + FLT_EPSILON);
+        }
+    });
+}
+
+//! fills the rows of the cost matrix in parallel, cost(i, j) gives the cost between two real descriptors
+template<typename Cost>
+static void fillCostMatrix(Mat& costMatrix, int rows1, int rows2, float defaultCost, const Cost& cost)
+{
+    parallel_for_(Range(0, costMatrix.rows), [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            float* costRow = costMatrix.ptr<float>(i);
+            for (int j = 0; j < costMatrix.cols; j++)
+                costRow[j] = (i < rows1 && j < rows2) ? cost(i, j) : defaultCost;
+        }
+    });
+}
+
 /*!  */
 class NormHistogramCostExtractorImpl CV_FINAL : public NormHistogramCostExtractor
 {
@@ -134,37 +164,16 @@ void NormHistogramCostExtractorImpl::buildCostMatrix(InputArray _descriptors1, I
     _costMatrix.create(costrows, costrows, CV_32F);
     Mat costMatrix=_costMatrix.getMat();
 
-
-    // Obtain copies of the descriptors //
-    cv::Mat scd1 = descriptors1.clone();
-    cv::Mat scd2 = descriptors2.clone();
-
-    // row normalization //
-    for(int i=0; i<scd1.rows; i++)
-    {
-        scd1.row(i)/=(sum(scd1.row(i))[0]+FLT_EPSILON);
-    }
-    for(int i=0; i<scd2.rows; i++)
-    {
-        scd2.row(i)/=(sum(scd2.row(i))[0]+FLT_EPSILON);
-    }
+    // Obtain row normalized copies of the descriptors //
+    cv::Mat scd1, scd2;
+    normalizeRows(descriptors1, scd1);
+    normalizeRows(descriptors2, scd2);
 
     // Compute the Cost Matrix //
-    for(int i=0; i<costrows; i++)
+    fillCostMatrix(costMatrix, scd1.rows, scd2.rows, defaultCost, [&](int i, int j)
     {
-        for(int j=0; j<costrows; j++)
-        {
-            if (i<scd1.rows && j<scd2.rows)
-            {
-                Mat columnDiff = scd1.row(i)-scd2.row(j);
-                costMatrix.at<float>(i,j)=(float)norm(columnDiff, flag);
-            }
-            else
-            {
-                costMatrix.at<float>(i,j)=defaultCost;
-            }
-        }
-    }
+        return (float)norm(scd1.row(i), scd2.row(j), flag);
+    });
 }
 
 Ptr <HistogramCostExtractor> createNormHistogramCostExtractor(int flag, int nDummies, float defaultCost)
@@ -262,49 +271,37 @@ void EMDHistogramCostExtractorImpl::buildCostMatrix(InputArray _descriptors1, In
     _costMatrix.create(costrows, costrows, CV_32F);
     Mat costMatrix=_costMatrix.getMat();
 
-    // Obtain copies of the descriptors //
-    cv::Mat scd1=descriptors1.clone();
-    cv::Mat scd2=descriptors2.clone();
+    // Obtain row normalized copies of the descriptors //
+    cv::Mat scd1, scd2;
+    normalizeRows(descriptors1, scd1);
+    normalizeRows(descriptors2, scd2);
 
-    // row normalization //
-    for(int i=0; i<scd1.rows; i++)
+    // The signatures (weight, bin index) of every descriptor are built once //
+    std::vector<Mat> sigs1(scd1.rows), sigs2(scd2.rows);
+    for (int i=0; i<scd1.rows; i++)
     {
-        cv::Mat row = scd1.row(i);
-        scd1.row(i)/=(sum(row)[0]+FLT_EPSILON);
+        sigs1[i].create(scd1.cols, 2, CV_32F);
+        sigs1[i].col(0)=scd1.row(i).t();
+        for (int k=0; k<scd1.cols; k++)
+        {
+            sigs1[i].at<float>(k,1)=float(k);
+        }
     }
-    for(int i=0; i<scd2.rows; i++)
+    for (int j=0; j<scd2.rows; j++)
     {
-        cv::Mat row = scd2.row(i);
-        scd2.row(i)/=(sum(row)[0]+FLT_EPSILON);
+        sigs2[j].create(scd2.cols, 2, CV_32F);
+        sigs2[j].col(0)=scd2.row(j).t();
+        for (int k=0; k<scd2.cols; k++)
+        {
+            sigs2[j].at<float>(k,1)=float(k);
+        }
     }
 
     // Compute the Cost Matrix //
-    for(int i=0; i<costrows; i++)
+    fillCostMatrix(costMatrix, scd1.rows, scd2.rows, defaultCost, [&](int i, int j)
     {
-        for(int j=0; j<costrows; j++)
-        {
-            if (i<scd1.rows && j<scd2.rows)
-            {
-                cv::Mat sig1(scd1.cols,2,CV_32F), sig2(scd2.cols,2,CV_32F);
-                sig1.col(0)=scd1.row(i).t();
-                sig2.col(0)=scd2.row(j).t();
-                for (int k=0; k<sig1.rows; k++)
-                {
-                    sig1.at<float>(k,1)=float(k);
-                }
-                for (int k=0; k<sig2.rows; k++)
-                {
-                    sig2.at<float>(k,1)=float(k);
-                }
-
-                costMatrix.at<float>(i,j) = cv::EMD(sig1, sig2, flag);
-            }
-            else
-            {
-                costMatrix.at<float>(i,j) = defaultCost;
-            }
-        }
-    }
+        return cv::EMD(sigs1[i], sigs2[j], flag);
+    });
 }
 
 Ptr <HistogramCostExtractor> createEMDHistogramCostExtractor(int flag, int nDummies, float defaultCost)
@@ -375,6 +372,31 @@ protected:
     float defaultCost;
 };
 
+//! chi-square distance between two histograms of n bins
+static float chiSquareDistance(const float* h1, const float* h2, int n)
+{
+    float csum = 0;
+    int k = 0;
+#if CV_SIMD128
+    const v_float32x4 v_eps = v_setall_f32(FLT_EPSILON);
+    v_float32x4 v_csum = v_setzero_f32();
+    for (; k <= n - v_float32x4::nlanes; k += v_float32x4::nlanes)
+    {
+        v_float32x4 a = v_load(h1 + k), b = v_load(h2 + k);
+        v_float32x4 resta = a - b;
+        v_csum += resta*resta/(v_eps + a + b);
+    }
+    csum = v_reduce_sum(v_csum);
+#endif
+    for (; k < n; k++)
+    {
+        float resta=h1[k]-h2[k];
+        float suma=h1[k]+h2[k];
+        csum += resta*resta/(FLT_EPSILON+suma);
+    }
+    return csum;
+}
+
 void ChiHistogramCostExtractorImpl::buildCostMatrix(InputArray _descriptors1, InputArray _descriptors2, OutputArray _costMatrix)
 {
     CV_INSTRUMENT_REGION();
@@ -386,44 +408,16 @@ void ChiHistogramCostExtractorImpl::buildCostMatrix(InputArray _descriptors1, In
     _costMatrix.create(costrows, costrows, CV_32FC1);
     Mat costMatrix=_costMatrix.getMat();
 
-    // Obtain copies of the descriptors //
-    cv::Mat scd1=descriptors1.clone();
-    cv::Mat scd2=descriptors2.clone();
-
-    // row normalization //
-    for(int i=0; i<scd1.rows; i++)
-    {
-        cv::Mat row = scd1.row(i);
-        scd1.row(i)/=(sum(row)[0]+FLT_EPSILON);
-    }
-    for(int i=0; i<scd2.rows; i++)
-    {
-       cv::Mat row = scd2.row(i);
-        scd2.row(i)/=(sum(row)[0]+FLT_EPSILON);
-    }
+    // Obtain row normalized copies of the descriptors //
+    cv::Mat scd1, scd2;
+    normalizeRows(descriptors1, scd1);
+    normalizeRows(descriptors2, scd2);
 
     // Compute the Cost Matrix //
-    for(int i=0; i<costrows; i++)
+    fillCostMatrix(costMatrix, scd1.rows, scd2.rows, defaultCost, [&](int i, int j)
     {
-        for(int j=0; j<costrows; j++)
-        {
-            if (i<scd1.rows && j<scd2.rows)
-            {
-                float csum = 0;
-                for(int k=0; k<scd2.cols; k++)
-                {
-                    float resta=scd1.at<float>(i,k)-scd2.at<float>(j,k);
-                    float suma=scd1.at<float>(i,k)+scd2.at<float>(j,k);
-                    csum += resta*resta/(FLT_EPSILON+suma);
-                }
-                costMatrix.at<float>(i,j)=csum/2;
-            }
-            else
-            {
-                costMatrix.at<float>(i,j)=defaultCost;
-            }
-        }
-    }
+        return chiSquareDistance(scd1.ptr<float>(i), scd2.ptr<float>(j), scd2.cols)/2;
+    });
 }
 
 Ptr <HistogramCostExtractor> createChiHistogramCostExtractor(int nDummies, float defaultCost)
@@ -494,6 +488,23 @@ protected:
     float defaultCost;
 };
 
+//! cumulative sums of the first cols-1 bins of every descriptor
+static void cumulativeRows(const Mat& descriptors, Mat& cumulative)
+{
+    cumulative.create(descriptors.rows, std::max(descriptors.cols-1, 0), CV_32F);
+    for (int i=0; i<descriptors.rows; i++)
+    {
+        const float* h = descriptors.ptr<float>(i);
+        float* c = cumulative.ptr<float>(i);
+        float acc = 0;
+        for (int k=0; k<cumulative.cols; k++)
+        {
+            acc += h[k];
+            c[k] = acc;
+        }
+    }
+}
+
 void EMDL1HistogramCostExtractorImpl::buildCostMatrix(InputArray _descriptors1, InputArray _descriptors2, OutputArray _costMatrix)
 {
     CV_INSTRUMENT_REGION();
@@ -505,40 +516,24 @@ void EMDL1HistogramCostExtractorImpl::buildCostMatrix(InputArray _descriptors1,
     _costMatrix.create(costrows, costrows, CV_32F);
     Mat costMatrix=_costMatrix.getMat();
 
-    // Obtain copies of the descriptors //
-    cv::Mat scd1=descriptors1.clone();
-    cv::Mat scd2=descriptors2.clone();
+    // Obtain row normalized copies of the descriptors //
+    cv::Mat scd1, scd2;
+    normalizeRows(descriptors1, scd1);
+    normalizeRows(descriptors2, scd2);
+    CV_Assert(scd1.cols == scd2.cols);
 
-    // row normalization //
-    for(int i=0; i<scd1.rows; i++)
-    {
-        cv::Mat row = scd1.row(i);
-        scd1.row(i)/=(sum(row)[0]+FLT_EPSILON);
-    }
-    for(int i=0; i<scd2.rows; i++)
-    {
-        cv::Mat row = scd2.row(i);
-        scd2.row(i)/=(sum(row)[0]+FLT_EPSILON);
-    }
+    // The descriptors are single column signatures for EMDL1, i.e. a chain of bins: the ground flow
+    // from one bin to the next is the difference of the cumulative histograms there, so EMD-L1 is the
+    // L1 distance between the cumulative histograms, without running the network simplex //
+    cv::Mat cdf1, cdf2;
+    cumulativeRows(scd1, cdf1);
+    cumulativeRows(scd2, cdf2);
 
     // Compute the Cost Matrix //
-    for(int i=0; i<costrows; i++)
+    fillCostMatrix(costMatrix, scd1.rows, scd2.rows, defaultCost, [&](int i, int j)
     {
-        for(int j=0; j<costrows; j++)
-        {
-            if (i<scd1.rows && j<scd2.rows)
-            {
-                cv::Mat sig1(scd1.cols,1,CV_32F), sig2(scd2.cols,1,CV_32F);
-                sig1.col(0)=scd1.row(i).t();
-                sig2.col(0)=scd2.row(j).t();
-                costMatrix.at<float>(i,j) = cv::EMDL1(sig1, sig2);
-            }
-            else
-            {
-                costMatrix.at<float>(i,j) = defaultCost;
-            }
-        }
-    }
+        return cdf1.cols > 0 ? (float)norm(cdf1.row(i), cdf2.row(j), NORM_L1) : 0.f;
+    });
 }
 
 Ptr <HistogramCostExtractor> createEMDL1HistogramCostExtractor(int nDummies, float defaultCost)
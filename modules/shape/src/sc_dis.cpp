@@ -83,6 +83,8 @@ public:
     //! the main operator
     virtual float computeDistance(InputArray contour1, InputArray contour2) CV_OVERRIDE;
 
+    virtual void computeDistances(InputArray query, InputArrayOfArrays contours, std::vector<float>& distances) CV_OVERRIDE;
+
     //! Setters/Getters
     virtual void setAngularBins(int _nAngularBins) CV_OVERRIDE { CV_Assert(_nAngularBins>0); nAngularBins=_nAngularBins; }
     virtual int getAngularBins() const CV_OVERRIDE { return nAngularBins; }
@@ -167,6 +169,9 @@ public:
     }
 
 protected:
+    //! distance between two contours, the given transformer is used to align them
+    float computeShapeDistance(const Mat& contour1, const Mat& contour2, const Ptr<ShapeTransformer>& aligner) const;
+
     int nAngularBins;
     int nRadialBins;
     float innerRadius;
@@ -185,12 +190,59 @@ protected:
     String name_;
 };
 
+//! a new transformer of the same kind, or an empty one if the type of the transformer is unknown
+static Ptr<ShapeTransformer> cloneTransformer(const Ptr<ShapeTransformer>& transformer)
+{
+    Ptr<ThinPlateSplineShapeTransformer> tps = transformer.dynamicCast<ThinPlateSplineShapeTransformer>();
+    if (!tps.empty())
+        return createThinPlateSplineShapeTransformer(tps->getRegularizationParameter());
+    Ptr<AffineTransformer> affine = transformer.dynamicCast<AffineTransformer>();
+    if (!affine.empty())
+        return createAffineTransformer(affine->getFullAffine());
+    return Ptr<ShapeTransformer>();
+}
+
 float ShapeContextDistanceExtractorImpl::computeDistance(InputArray contour1, InputArray contour2)
 {
     CV_INSTRUMENT_REGION();
 
+    return computeShapeDistance(contour1.getMat(), contour2.getMat(), transformer);
+}
+
+void ShapeContextDistanceExtractorImpl::computeDistances(InputArray query, InputArrayOfArrays contours, std::vector<float>& distances)
+{
+    CV_INSTRUMENT_REGION();
+
+    if (imageAppearanceWeight!=0)
+        CV_Error(Error::StsNotImplemented, "The image appearance cost is only defined for a pair of shapes");
+
+    Mat queryMat = query.getMat();
+    std::vector<Mat> targets;
+    contours.getMatVector(targets);
+    distances.assign(targets.size(), 0.f);
+
+    // The transformer keeps the estimated transformation, so the shapes are only processed in
+    // parallel when every stripe can get its own transformer
+    if (cloneTransformer(transformer).empty())
+    {
+        for (size_t i = 0; i < targets.size(); i++)
+            distances[i] = computeShapeDistance(queryMat, targets[i], transformer);
+        return;
+    }
+
+    parallel_for_(Range(0, (int)targets.size()), [&](const Range& range)
+    {
+        Ptr<ShapeTransformer> stripeTransformer = cloneTransformer(transformer);
+        for (int i = range.start; i < range.end; i++)
+            distances[i] = computeShapeDistance(queryMat, targets[i], stripeTransformer);
+    });
+}
+
+float ShapeContextDistanceExtractorImpl::computeShapeDistance(const Mat& sset1, const Mat& sset2,
+                                                              const Ptr<ShapeTransformer>& aligner) const
+{
     // Checking //
-    Mat sset1=contour1.getMat(), sset2=contour2.getMat(), set1, set2;
+    Mat set1, set2;
     if (set1.type() != CV_32F)
         sset1.convertTo(set1, CV_32F);
     else
@@ -222,6 +274,7 @@ float ShapeContextDistanceExtractorImpl::computeDistance(InputArray contour1, In
     Mat set2SCD;
     SCDMatcher matcher;
     std::vector<DMatch> matches;
+    Ptr<HistogramCostExtractor> costExtractor = comparer;
 
     // Distance components (The output is a linear combination of these 3) //
     float sDistance=0, bEnergy=0, iAppearance=0;
@@ -230,7 +283,7 @@ float ShapeContextDistanceExtractorImpl::computeDistance(InputArray contour1, In
     // Initializing some variables //
     std::vector<int> inliers1, inliers2;
 
-    Ptr<ThinPlateSplineShapeTransformer> transDown = transformer.dynamicCast<ThinPlateSplineShapeTransformer>();
+    Ptr<ThinPlateSplineShapeTransformer> transDown = aligner.dynamicCast<ThinPlateSplineShapeTransformer>();
 
     Mat warpedImage;
     int ii, jj, pt;
@@ -248,13 +301,13 @@ float ShapeContextDistanceExtractorImpl::computeDistance(InputArray contour1, In
         beta *= beta;
 
         // match //
-        matcher.matchDescriptors(set1SCD, set2SCD, matches, comparer, inliers1, inliers2);
+        matcher.matchDescriptors(set1SCD, set2SCD, matches, costExtractor, inliers1, inliers2);
 
         // apply TPS transform //
         if ( !transDown.empty() )
             transDown->setRegularizationParameter(beta);
-        transformer->estimateTransformation(set1, set2, matches);
-        bEnergy += transformer->applyTransformation(set1, set1);
+        aligner->estimateTransformation(set1, set2, matches);
+        bEnergy += aligner->applyTransformation(set1, set1);
 
         // Image appearance //
         if (imageAppearanceWeight!=0)
@@ -271,7 +324,7 @@ float ShapeContextDistanceExtractorImpl::computeDistance(InputArray contour1, In
                     image1.copyTo(warpedImage);
                 }
             }
-            transformer->warpImage(warpedImage, warpedImage);
+            aligner->warpImage(warpedImage, warpedImage);
         }
     }
 
@@ -345,40 +398,47 @@ void SCD::extractSCD(cv::Mat &contour, cv::Mat &descriptors, const std::vector<i
     // Now, build the descriptor matrix (each row is a point) //
     descriptors = cv::Mat::zeros(contourMat.cols, descriptorSize(), CV_32F);
 
-    for (int ptidx=0; ptidx<contourMat.cols; ptidx++)
+    // every point only fills its own row //
+    parallel_for_(Range(0, contourMat.cols), [&](const Range& range)
     {
-        for (int cmp=0; cmp<contourMat.cols; cmp++)
+        for (int ptidx=range.start; ptidx<range.end; ptidx++)
         {
-            if (ptidx==cmp) continue;
-            if ((int)queryInliers.size()>0)
+            const float* disRow = disMatrix.ptr<float>(ptidx);
+            const float* angleRow = angleMatrix.ptr<float>(ptidx);
+            float* descriptor = descriptors.ptr<float>(ptidx);
+            for (int cmp=0; cmp<contourMat.cols; cmp++)
             {
-                if (queryInliers[ptidx]==0 || queryInliers[cmp]==0) continue; //avoid outliers
-            }
+                if (ptidx==cmp) continue;
+                if ((int)queryInliers.size()>0)
+                {
+                    if (queryInliers[ptidx]==0 || queryInliers[cmp]==0) continue; //avoid outliers
+                }
 
-            int angidx=-1, radidx=-1;
-            for (int i=0; i<nRadialBins; i++)
-            {
-                if (disMatrix.at<float>(ptidx, cmp)<logspaces[i])
+                int angidx=-1, radidx=-1;
+                for (int i=0; i<nRadialBins; i++)
                 {
-                    radidx=i;
-                    break;
+                    if (disRow[cmp]<logspaces[i])
+                    {
+                        radidx=i;
+                        break;
+                    }
                 }
-            }
-            for (int i=0; i<nAngularBins; i++)
-            {
-                if (angleMatrix.at<float>(ptidx, cmp)<angspaces[i])
+                for (int i=0; i<nAngularBins; i++)
                 {
-                    angidx=i;
-                    break;
+                    if (angleRow[cmp]<angspaces[i])
+                    {
+                        angidx=i;
+                        break;
+                    }
+                }
+                if (angidx!=-1 && radidx!=-1)
+                {
+                    int idx = angidx+radidx*nAngularBins;
+                    descriptor[idx]++;
                 }
-            }
-            if (angidx!=-1 && radidx!=-1)
-            {
-                int idx = angidx+radidx*nAngularBins;
-                descriptors.at<float>(ptidx, idx)++;
             }
         }
-    }
+    });
 }
 
 void SCD::logarithmicSpaces(std::vector<double> &vecSpaces) const
@@ -411,30 +471,45 @@ void SCD::angularSpaces(std::vector<double> &vecSpaces) const
 void SCD::buildNormalizedDistanceMatrix(cv::Mat &contour, cv::Mat &disMatrix, const std::vector<int> &queryInliers, const float _meanDistance)
 {
     cv::Mat contourMat = contour;
-    cv::Mat mask(disMatrix.rows, disMatrix.cols, CV_8U);
+    const cv::Point2f* points = contourMat.ptr<cv::Point2f>(0);
+    const bool useInliers = queryInliers.size()>0;
+
+    // sum and number of the distances between inliers, for each row //
+    std::vector<double> rowSums(contourMat.cols, 0);
+    std::vector<int> rowCounts(contourMat.cols, 0);
 
-    for (int i=0; i<contourMat.cols; i++)
+    parallel_for_(Range(0, contourMat.cols), [&](const Range& range)
     {
-      for (int j=0; j<contourMat.cols; j++)
-      {
-          disMatrix.at<float>(i,j) = (float)norm( cv::Mat(contourMat.at<cv::Point2f>(0,i)-contourMat.at<cv::Point2f>(0,j)), cv::NORM_L2 );
-          if (_meanDistance<0)
-          {
-              if (queryInliers.size()>0)
-              {
-                  mask.at<char>(i,j)=char(queryInliers[j] && queryInliers[i]);
-              }
-              else
-              {
-                  mask.at<char>(i,j)=1;
-              }
-          }
-      }
-    }
+        for (int i=range.start; i<range.end; i++)
+        {
+            float* disRow = disMatrix.ptr<float>(i);
+            double rowSum = 0;
+            int rowCount = 0;
+            for (int j=0; j<contourMat.cols; j++)
+            {
+                cv::Point2f dif = points[i]-points[j];
+                disRow[j] = (float)std::sqrt((double)dif.x*dif.x + (double)dif.y*dif.y);
+                if (!useInliers || (queryInliers[j] && queryInliers[i]))
+                {
+                    rowSum += disRow[j];
+                    rowCount++;
+                }
+            }
+            rowSums[i] = rowSum;
+            rowCounts[i] = rowCount;
+        }
+    });
 
     if (_meanDistance<0)
     {
-      meanDistance=(float)mean(disMatrix, mask)[0];
+      double totalSum = 0;
+      int totalCount = 0;
+      for (int i=0; i<contourMat.cols; i++)
+      {
+          totalSum += rowSums[i];
+          totalCount += rowCounts[i];
+      }
+      meanDistance = totalCount > 0 ? (float)(totalSum/totalCount) : 0.f;
     }
     else
     {
@@ -459,30 +534,39 @@ void SCD::buildAngleMatrix(cv::Mat &contour, cv::Mat &angleMatrix) const
         massCenter.y=massCenter.y/(float)contourMat.cols;
     }
 
-
-    for (int i=0; i<contourMat.cols; i++)
+    const cv::Point2f* points = contourMat.ptr<cv::Point2f>(0);
+    parallel_for_(Range(0, contourMat.cols), [&](const Range& range)
     {
-        for (int j=0; j<contourMat.cols; j++)
+        for (int i=range.start; i<range.end; i++)
         {
-            if (i==j)
+            float* angleRow = angleMatrix.ptr<float>(i);
+            float refAngle = 0;
+            if (rotationInvariant)
             {
-                angleMatrix.at<float>(i,j)=0.0;
+                cv::Point2f refPt = points[i] - massCenter;
+                refAngle = atan2(refPt.y, refPt.x);
             }
-            else
-            {
-                cv::Point2f dif = contourMat.at<cv::Point2f>(0,i) - contourMat.at<cv::Point2f>(0,j);
-                angleMatrix.at<float>(i,j) = std::atan2(dif.y, dif.x);
 
-                if (rotationInvariant)
+            for (int j=0; j<contourMat.cols; j++)
+            {
+                if (i==j)
                 {
-                    cv::Point2f refPt = contourMat.at<cv::Point2f>(0,i) - massCenter;
-                    float refAngle = atan2(refPt.y, refPt.x);
-                    angleMatrix.at<float>(i,j) -= refAngle;
+                    angleRow[j]=0.0;
+                }
+                else
+                {
+                    cv::Point2f dif = points[i] - points[j];
+                    angleRow[j] = std::atan2(dif.y, dif.x);
+
+                    if (rotationInvariant)
+                    {
+                        angleRow[j] -= refAngle;
+                    }
+                    angleRow[j] = float(fmod(double(angleRow[j]+(double)FLT_EPSILON),2*CV_PI)+CV_PI);
                 }
-                angleMatrix.at<float>(i,j) = float(fmod(double(angleMatrix.at<float>(i,j)+(double)FLT_EPSILON),2*CV_PI)+CV_PI);
             }
         }
-    }
+    });
 }
 
 //! SCDMatcher
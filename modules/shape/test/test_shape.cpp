@@ -321,4 +321,33 @@ TEST(computeDistance, regression_4976)
     EXPECT_NEAR(d2, 0.25804194808, 1e-3) << "ShapeContextDistanceExtractor";
 }
 
+TEST(computeDistances, matches_computeDistance)
+{
+    // ellipses of different elongations and orientations
+    vector<vector<Point2f> > shapes(6);
+    for (size_t i = 0; i < shapes.size(); i++)
+    {
+        const float a = 50.f + 10.f * i, b = 30.f, angle = 0.3f * i;
+        for (int k = 0; k < 60; k++)
+        {
+            const float t = (float)(2 * CV_PI * k / 60);
+            Point2f p(a * std::cos(t), b * std::sin(t));
+            shapes[i].push_back(Point2f(200 + p.x * std::cos(angle) - p.y * std::sin(angle),
+                                        200 + p.x * std::sin(angle) + p.y * std::cos(angle)));
+        }
+    }
+
+    Ptr<ShapeContextDistanceExtractor> sd = createShapeContextDistanceExtractor();
+    vector<float> distances;
+    sd->computeDistances(shapes[0], shapes, distances);
+    ASSERT_EQ(shapes.size(), distances.size());
+    for (size_t i = 0; i < shapes.size(); i++)
+        EXPECT_NEAR(sd->computeDistance(shapes[0], shapes[i]), distances[i], 1e-5) << "shape " << i;
+
+    sd->setCostExtractor(createEMDL1HistogramCostExtractor());
+    sd->computeDistances(shapes[0], shapes, distances);
+    for (size_t i = 0; i < shapes.size(); i++)
+        EXPECT_NEAR(sd->computeDistance(shapes[0], shapes[i]), distances[i], 1e-5) << "EMD-L1 shape " << i;
+}
+
 }} // namespace
@@ -199,7 +199,8 @@ namespace cv
             enum
             {
                 MODE_SGBM = 0,
-                MODE_HH   = 1
+                MODE_HH   = 1,
+                MODE_HH4  = 3   //!< 4 directions aggregated in parallel over the rows and the columns, as StereoSGBM::MODE_HH4
             };
 
             virtual int getPreFilterCap() const = 0;
@@ -257,7 +258,9 @@ namespace cv
             Normally, 1 or 2 is good enough.
             @param mode Set it to StereoSGBM::MODE_HH to run the full-scale two-pass dynamic programming
             algorithm. It will consume O(W\*H\*numDisparities) bytes, which is large for 640x480 stereo and
-            huge for HD-size pictures. By default, it is set to false .
+            huge for HD-size pictures. By default, it is set to false . Set it to StereoBinarySGBM::MODE_HH4 to
+            aggregate the costs along 4 directions only, every direction being processed in parallel over the rows
+            or the columns. It uses the same amount of memory as MODE_HH.
 
             The first constructor initializes StereoSGBM with all the default parameters. So, you only have to
             set StereoSGBM::numDisparities at minimum. The second constructor enables you to set each parameter
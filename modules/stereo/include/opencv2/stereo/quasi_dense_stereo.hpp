@@ -184,6 +184,31 @@ public:
     CV_WRAP virtual cv::Mat getDisparity() = 0;
 
 
+    /**
+     * @brief Enable or disable the video mode.
+     *
+     * In video mode the dense matches of the previous call of process are sampled every
+     * gftMinSeperationDist pixels and used as seeds of the next frame, after checking their zncc on
+     * the new images. The sparse matching is only run when too few of them remain, i.e. on the first
+     * frame and after large changes of the scene.
+     * @param[in] enabled The video mode is disabled by default.
+     */
+    CV_WRAP virtual void setVideoMode(bool enabled) = 0;
+    CV_WRAP virtual bool getVideoMode() const = 0;
+
+
+    /**
+     * @brief Set the number of horizontal bands of the image grown in parallel.
+     *
+     * Every band is densified independently from the seeds inside of it, then the matches along the
+     * borders of the bands are grown once more over the whole image. With 1, the default, the
+     * propagation follows a single priority queue as in the original algorithm.
+     * @param[in] numBands The number of bands, at least 1.
+     */
+    CV_WRAP virtual void setNumGrowingBands(int numBands) = 0;
+    CV_WRAP virtual int getNumGrowingBands() const = 0;
+
+
     CV_WRAP static cv::Ptr<QuasiDenseStereo> create(cv::Size monoImgSize, cv::String paramFilepath = cv::String());
 
 
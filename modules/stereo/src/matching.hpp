@@ -49,6 +49,7 @@
 
 #include <stdint.h>
 #include "opencv2/core.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -157,13 +158,33 @@ namespace cv
                 hammingDistance(const Mat &leftImage, const Mat &rightImage, short *cost, int maxDisp, int kerSize, int *hammingLUT):
                     left((int *)leftImage.data), right((int *)rightImage.data), c(cost), v(maxDisp),kernelSize(kerSize),width(leftImage.cols), MASK(65535), hammLut(hammingLUT){}
                 void operator()(const cv::Range &r) const CV_OVERRIDE {
+#if CV_SIMD128
+                    // the right row is read backwards for consecutive disparities, so it is reversed once per row
+                    std::vector<unsigned> reversed(width);
+#endif
                     for (int i = r.start; i < r.end ; i++)
                     {
                         int iw = i * width;
+#if CV_SIMD128
+                        for (int j = 0; j < width; j++)
+                            reversed[j] = (unsigned)right[iw + width - 1 - j];
+#endif
                         for (int j = kernelSize; j < width - kernelSize; j++)
                         {
                             int iwj = iw + j;
-                            for (int d = 0; d <= v; d++)
+                            int d = 0;
+#if CV_SIMD128
+                            // right[iw + j - d] == reversed[width - 1 - j + d] as long as d <= j
+                            const v_uint32x4 l = v_setall_u32((unsigned)left[iwj]);
+                            const unsigned* rrow = &reversed[width - 1 - j];
+                            for (; d + 7 <= std::min(v, j); d += 8)
+                            {
+                                v_uint32x4 c0 = v_popcount(l ^ v_load(rrow + d));
+                                v_uint32x4 c1 = v_popcount(l ^ v_load(rrow + d + 4));
+                                v_store(c + (iwj)* (v + 1) + d, v_pack(v_reinterpret_as_s32(c0), v_reinterpret_as_s32(c1)));
+                            }
+#endif
+                            for (; d <= v; d++)
                             {
                                 int j2 = std::max(0, j - d);
                                 int xorul = left[(iwj)] ^ right[(iw + j2)];
@@ -22,6 +22,9 @@ public:
     QuasiDenseStereoImpl(cv::Size monoImgSize, cv::String paramFilepath)
     {
         loadParameters(paramFilepath);
+        videoMode = false;
+        numGrowingBands = 1;
+        dMatchesLen = 0;
         width = monoImgSize.width;
         height = monoImgSize.height;
         refMap = cv::Mat_<cv::Point2i>(monoImgSize);
@@ -119,19 +122,11 @@ public:
      * The method initially discards low quality matches based on their zero-normalized cross
      * correlation (zncc) value. This is done by calling the "extractSparseSeeds" method. Remaining
      * high quality Matches stored in a t_matchPriorityQueue sorted according to their zncc value.
-     * The priority queue allows for new matches to be added while keeping track of the best Match.
-     * The algorithm then process the queue iteratively. In every iteration a Match is popped from
-     * the queue. The algorithm then tries to find candidate matches by matching every point in a
-     * small patch around the left Match feature, with a point within a same sized patch around the
-     * corresponding right feature. For each candidate point match, the zncc is computed and if it
-     * surpasses a threshold, the candidate pair is stored in a temporary priority queue. After this
-     * process completed the candidate matches are popped from the Local priority queue and if a
-     * match is not registered in refMap, it means that is the best match for this point. The
-     * algorithm registers this point in refMap and also push it to the Seed queue. If a candidate
-     * match is already registered, it means that is not the best and the algorithm discards it.
+     * The matches are then propagated by "growMatches". With several growing bands, the seeds of
+     * every band are grown in parallel inside of it, and the matches close to the borders of the
+     * bands are grown once more over the whole image.
      *
-     * @note This method does not have input arguments, but uses the "leftFeatures" and
-     * "rightFeatures" vectors.
+     * @note The texture descriptors and the integral images must be computed by "prepareImages".
      * Also there is no output since the method used refMap and mtcMap to store the results.
      * @param[in] featuresLeft The location of the features in the left image.
      * @param[in] featuresRight The location of the features in the right image.
@@ -143,20 +138,88 @@ public:
         refMap = cv::Mat_<cv::Point2i>(cv::Size(width, height), cv::Point2i(0, 0));
         mtcMap = cv::Point2i(0, 0);
 
-        // build texture homogeneity reference maps.
-        buildTextureDescriptor(grayLeft, textureDescLeft);
-        buildTextureDescriptor(grayRight, textureDescRight);
-
-        // generate the intergal images for fast variable window correlation calculations
-        cv::integral(grayLeft, sum0, ssum0);
-        cv::integral(grayRight, sum1, ssum1);
-
         // Seed priority queue. The algorithm wants to pop the best seed available in order to densify
         //the sparse set.
         t_matchPriorityQueue seeds = extractSparseSeeds(featuresLeft, featuresRight,
         refMap, mtcMap);
 
+        const int nbands = std::min(numGrowingBands, height);
+        if (nbands <= 1)
+        {
+            dMatchesLen = growMatches(seeds, 0, height);
+            return;
+        }
+
+        // the band of row y is [bandStart(b), bandStart(b+1)) with b = y*nbands/height
+        std::vector<int> bandStart(nbands + 1);
+        for (int b = 0; b <= nbands; b++)
+            bandStart[b] = (b*height + nbands - 1)/nbands;
+
+        std::vector<t_matchPriorityQueue> bandSeeds(nbands);
+        t_matchPriorityQueue borderSeeds;
+        while (!seeds.empty())
+        {
+            const MatchQuasiDense& m = seeds.top();
+            const int b0 = m.p0.y*nbands/height, b1 = m.p1.y*nbands/height;
+            if (b0 == b1)
+                bandSeeds[b0].push(m);
+            else
+                borderSeeds.push(m);
+            seeds.pop();
+        }
 
+        // every band only writes the rows of refMap and mtcMap inside of it
+        std::vector<int> bandMatchesLen(nbands, 0);
+        cv::parallel_for_(cv::Range(0, nbands), [&](const cv::Range& range)
+        {
+            for (int b = range.start; b < range.end; b++)
+                bandMatchesLen[b] = growMatches(bandSeeds[b], bandStart[b], bandStart[b+1]);
+        }, nbands);
+        for (int b = 0; b < nbands; b++)
+            dMatchesLen += bandMatchesLen[b];
+
+        // resume the propagation from the matches which could grow into the next band
+        const int reach = Param.neighborhoodSize + Param.disparityGradient;
+        for (int b = 1; b < nbands; b++)
+        {
+            for (int row = std::max(bandStart[b] - reach, 0); row < std::min(bandStart[b] + reach, height); row++)
+            {
+                for (int col = 0; col < width; col++)
+                {
+                    MatchQuasiDense m;
+                    m.p0 = cv::Point2i(col, row);
+                    m.p1 = refMap.at<cv::Point2i>(row, col);
+                    if (m.p1 == NO_MATCH)
+                        continue;
+                    m.corr = iZNCC_c1(m.p0, m.p1, Param.corrWinSizeX, Param.corrWinSizeY);
+                    borderSeeds.push(m);
+                }
+            }
+        }
+        dMatchesLen += growMatches(borderSeeds, 0, height);
+    }
+
+
+    /**
+     * @brief Propagate the matches of a priority queue of seeds.
+     *
+     * In every iteration a Match is popped from the queue. The algorithm then tries to find
+     * candidate matches by matching every point in a small patch around the left Match feature,
+     * with a point within a same sized patch around the corresponding right feature. For each
+     * candidate point match, the zncc is computed and if it surpasses a threshold, the candidate
+     * pair is stored in a temporary priority queue. After this process completed the candidate
+     * matches are popped from the Local priority queue and if a match is not registered in refMap,
+     * it means that is the best match for this point. The algorithm registers this point in refMap
+     * and also push it to the Seed queue. If a candidate match is already registered, it means that
+     * is not the best and the algorithm discards it.
+     * @param[in,out] seeds The seeds, empty on exit.
+     * @param[in] rowStart The first row where new matches can be found, in both images.
+     * @param[in] rowEnd The row after the last one where new matches can be found.
+     * @return The number of new matches.
+     */
+    int growMatches(t_matchPriorityQueue &seeds, const int rowStart, const int rowEnd)
+    {
+        int matchesLen = 0;
         // Do the propagation part
         while(!seeds.empty())
         {
@@ -177,6 +240,8 @@ public:
                 for(int x=-Param.neighborhoodSize;x<=Param.neighborhoodSize;x++)
                 {
                     cv::Point2i p0 = cv::Point2i(m.p0.x+x,m.p0.y+y);
+                    if(p0.y < rowStart || p0.y >= rowEnd)
+                        continue;
 
                     // Check if its unique in ref
                     if(refMap.at<cv::Point2i>(p0.y,p0.x) != NO_MATCH)
@@ -192,6 +257,8 @@ public:
                         for(int wx=-Param.disparityGradient; wx<=Param.disparityGradient; wx++)
                         {
                             cv::Point p1 = cv::Point(m.p1.x+x+wx,m.p1.y+y+wy);
+                            if(p1.y < rowStart || p1.y >= rowEnd)
+                                continue;
 
                             // Check if its unique in ref
                             if(mtcMap.at<cv::Point2i>(p1.y, p1.x) != NO_MATCH)
@@ -233,11 +300,61 @@ public:
                 // Unique match
                 refMap.at<cv::Point2i>(lm.p0.y, lm.p0.x) = lm.p1;
                 mtcMap.at<cv::Point2i>(lm.p1.y, lm.p1.x) = lm.p0;
-                dMatchesLen++;
+                matchesLen++;
                 // Add to the seed list
                 seeds.push(lm);
             }
         }
+        return matchesLen;
+    }
+
+
+    /**
+     * @brief Compute the texture descriptors and the integral images of the current images, used
+     * by the zncc and the propagation.
+     */
+    void prepareImages()
+    {
+        // build texture homogeneity reference maps.
+        buildTextureDescriptor(grayLeft, textureDescLeft);
+        buildTextureDescriptor(grayRight, textureDescRight);
+
+        // generate the intergal images for fast variable window correlation calculations
+        cv::integral(grayLeft, sum0, ssum0);
+        cv::integral(grayRight, sum1, ssum1);
+    }
+
+
+    /**
+     * @brief Sample the dense matches of the last frame as seeds of the current one.
+     *
+     * The matches are taken every gftMinSeperationDist pixels and kept if their zncc on the
+     * current images is over the correlation threshold.
+     * @param[out] featuresLeft The location of the seeds in the left image.
+     * @param[out] featuresRight The location of the seeds in the right image.
+     */
+    void propagateSeeds(std::vector< cv::Point2f > &featuresLeft,
+                        std::vector< cv::Point2f > &featuresRight)
+    {
+        featuresLeft.clear();
+        featuresRight.clear();
+        const int step = std::max(1, (int)Param.gftMinSeperationDist);
+        for (int row = 0; row < height; row += step)
+        {
+            for (int col = 0; col < width; col += step)
+            {
+                MatchQuasiDense m;
+                m.p0 = cv::Point2i(col, row);
+                m.p1 = refMap.at<cv::Point2i>(row, col);
+                if (m.p1 == NO_MATCH || !CheckBorder(m, Param.borderX, Param.borderY, width, height))
+                    continue;
+                if (iZNCC_c1(m.p0, m.p1, Param.corrWinSizeX, Param.corrWinSizeY) > Param.correlationThreshold)
+                {
+                    featuresLeft.push_back(m.p0);
+                    featuresRight.push_back(m.p1);
+                }
+            }
+        }
     }
 
 
@@ -304,15 +421,17 @@ public:
         s1 = sqrt(s1-wa*m1*m1);
 
 
-        for (int col=-wy; col<=wy; col++)
+        // the sums of the patches come from the integral images, only the cross term is accumulated.
+        // the products are exact in integers and their sum fits in the float mantissa as well.
+        int cross = 0;
+        for (int row=-wy; row<=wy; row++)
         {
-            for (int row=-wx; row<=wx; row++)
-            {
-                zncc += (float)grayLeft.at<uchar>(p0.y+row, p0.x+col) *
-                (float)grayRight.at<uchar>(p1.y+row, p1.x+col);
-            }
+            const uchar* r0 = grayLeft.ptr<uchar>(p0.y+row) + p0.x;
+            const uchar* r1 = grayRight.ptr<uchar>(p1.y+row) + p1.x;
+            for (int col=-wx; col<=wx; col++)
+                cross += r0[col]*r1[col];
         }
-        zncc = (zncc-wa*m0*m1)/(s0*s1);
+        zncc = ((float)cross-wa*m0*m1)/(s0*s1);
         return zncc;
     }
 
@@ -592,10 +711,47 @@ public:
             grayLeft = imgLeft.clone();
             grayRight = imgRight.clone();
         }
-        sparseMatching(grayLeft, grayRight, leftFeatures, rightFeatures);
+        prepareImages();
+        if (videoMode && dMatchesLen > 0)
+        {
+            // seeds from the last frame, completed by new features if the scene changed too much
+            propagateSeeds(leftFeatures, rightFeatures);
+            if ((int)leftFeatures.size() < Param.gftMaxNumFeatures / 4)
+            {
+                std::vector< cv::Point2f > newLeft, newRight;
+                sparseMatching(grayLeft, grayRight, newLeft, newRight);
+                leftFeatures.insert(leftFeatures.end(), newLeft.begin(), newLeft.end());
+                rightFeatures.insert(rightFeatures.end(), newRight.begin(), newRight.end());
+            }
+        }
+        else
+        {
+            sparseMatching(grayLeft, grayRight, leftFeatures, rightFeatures);
+        }
         quasiDenseMatching(leftFeatures, rightFeatures);
     }
 
+    void setVideoMode(bool enabled) override
+    {
+        videoMode = enabled;
+    }
+
+    bool getVideoMode() const override
+    {
+        return videoMode;
+    }
+
+    void setNumGrowingBands(int numBands) override
+    {
+        CV_Assert(numBands >= 1);
+        numGrowingBands = numBands;
+    }
+
+    int getNumGrowingBands() const override
+    {
+        return numGrowingBands;
+    }
+
     cv::Point2f getMatch(const int x, const int y) override
     {
         return refMap.at<cv::Point2i>(y, x);
@@ -617,6 +773,9 @@ public:
     int width;
     int height;
     int dMatchesLen;
+    // Seeds from the last frame and number of bands grown in parallel.
+    bool videoMode;
+    int numGrowingBands;
     // Containers to store input images.
     cv::Mat grayLeft;
     cv::Mat grayRight;
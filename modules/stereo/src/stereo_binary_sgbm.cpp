@@ -49,6 +49,7 @@ SGBM (Semi-global block matching)
 */
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include <limits.h>
 
 namespace cv
@@ -626,6 +627,312 @@ namespace cv
                 }
             }
         }
+        /*
+        one step of the dynamic programming along a direction:
+        Lr(p, d) = C(p, d) + min(Lr(p-r, d), Lr(p-r, d-1) + P1, Lr(p-r, d+1) + P1, min_k Lr(p-r, k) + P2) - min_k Lr(p-r, k)
+        C already contains P2 and delta = min_k Lr(p-r, k) + P2, Lprev[-1] and Lprev[D] must be MAX_COST.
+        returns min_k Lr(p, k)
+        */
+        static inline int aggregationStep(const CostType* Cp, const CostType* Lprev, CostType* Lp,
+                                          int D, int P1, int delta)
+        {
+            int d = 0, minL = SHRT_MAX;
+#if CV_SIMD128
+            const v_int16x8 _P1 = v_setall_s16((short)P1), _delta = v_setall_s16((short)delta);
+            v_int16x8 _minL = v_setall_s16(SHRT_MAX);
+            for( ; d <= D - 8; d += 8 )
+            {
+                v_int16x8 L = v_load(Lprev + d);
+                L = v_min(L, v_load(Lprev + d - 1) + _P1);
+                L = v_min(L, v_load(Lprev + d + 1) + _P1);
+                L = v_min(L, _delta);
+                L = (L - _delta) + v_load(Cp + d);
+                v_store(Lp + d, L);
+                _minL = v_min(_minL, L);
+            }
+            minL = v_reduce_min(_minL);
+#endif
+            for( ; d < D; d++ )
+            {
+                const int L = Cp[d] + std::min((int)Lprev[d], std::min(Lprev[d-1] + P1, std::min(Lprev[d+1] + P1, delta))) - delta;
+                Lp[d] = saturate_cast<CostType>(L);
+                minL = std::min(minL, (int)Lp[d]);
+            }
+            return minL;
+        }
+
+        //! S[d] += L[d] with saturation
+        static inline void accumulateCost(CostType* S, const CostType* L, int D)
+        {
+            int d = 0;
+#if CV_SIMD128
+            for( ; d <= D - 8; d += 8 )
+                v_store(S + d, v_load(S + d) + v_load(L + d));
+#endif
+            for( ; d < D; d++ )
+                S[d] = saturate_cast<CostType>(S[d] + L[d]);
+        }
+
+        /*
+        winner takes all on the summary cost of one row, followed by the uniqueness check,
+        the sub-pixel interpolation and the left-right consistency check, as in computeDisparityBinarySGBM.
+        disp2cost and disp2ptr are width-sized buffers of the row.
+        */
+        static void computeRowDisparity(const CostType* S, DispType* disp1ptr, CostType* disp2cost, DispType* disp2ptr,
+                                        const StereoBinarySGBMParams& params, int width, int minX1, int width1, int D,
+                                        int uniquenessRatio, int disp12MaxDiff)
+        {
+            const int DISP_SHIFT = StereoMatcher::DISP_SHIFT;
+            const int DISP_SCALE = (1 << DISP_SHIFT);
+            const CostType MAX_COST = SHRT_MAX;
+            const int minD = params.minDisparity;
+            const int INVALID_DISP_SCALED = (minD - 1)*DISP_SCALE;
+            int x, d;
+            for( x = 0; x < width; x++ )
+            {
+                disp1ptr[x] = disp2ptr[x] = (DispType)INVALID_DISP_SCALED;
+                disp2cost[x] = MAX_COST;
+            }
+            for( x = width1 - 1; x >= 0; x-- )
+            {
+                const CostType* Sp = S + x*D;
+                int minS = MAX_COST;
+                int bestDisp = -1;
+                for( d = 0; d < D; d++ )
+                {
+                    const int Sval = Sp[d];
+                    if( Sval < minS )
+                    {
+                        minS = Sval;
+                        bestDisp = d;
+                    }
+                }
+                for( d = 0; d < D; d++ )
+                {
+                    if( Sp[d]*(100 - uniquenessRatio) < minS*100 && std::abs(bestDisp - d) > 1 )
+                        break;
+                }
+                if( d < D )
+                    continue;
+                d = bestDisp;
+                const int _x2 = x + minX1 - d - minD;
+                if( _x2 >= 0 && disp2cost[_x2] > minS )
+                {
+                    disp2cost[_x2] = (CostType)minS;
+                    disp2ptr[_x2] = (DispType)(d + minD);
+                }
+                if( 0 < d && d < D-1 )
+                {
+                    if(params.subpixelInterpolationMethod == CV_SIMETRICV_INTERPOLATION)
+                    {
+                        const double m2 = Sp[d - 1];
+                        const double m3 = Sp[d + 1];
+                        const double m1 = Sp[d];
+                        const double m2m1 = m2 - m1;
+                        const double m3m1 = m3 - m1;
+                        if (!(m2m1 == 0 || m3m1 == 0))
+                        {
+                            double p = 0;
+                            if (m2 > m3)
+                            {
+                                p = (0.5 - 0.25 * ((m3m1 * m3m1) / (m2m1 * m2m1) + (m3m1 / m2m1)));
+                            }
+                            else
+                            {
+                                p = -1 * (0.5 - 0.25 * ((m2m1 * m2m1) / (m3m1 * m3m1) + (m2m1 / m3m1)));
+                            }
+                            if (p >= -0.5 && p <= 0.5)
+                                d = (int)(d * DISP_SCALE + p * DISP_SCALE );
+                        }
+                        else
+                        {
+                            d *= DISP_SCALE;
+                        }
+                    }
+                    else if(params.subpixelInterpolationMethod == CV_QUADRATIC_INTERPOLATION)
+                    {
+                        const int denom2 = std::max(Sp[d-1] + Sp[d+1] - 2*Sp[d], 1);
+                        d = d*DISP_SCALE + ((Sp[d-1] - Sp[d+1])*DISP_SCALE + denom2)/(denom2*2);
+                    }
+                }
+                else
+                    d *= DISP_SCALE;
+                disp1ptr[x + minX1] = (DispType)(d + minD*DISP_SCALE);
+            }
+            for( x = minX1; x < minX1 + width1; x++ )
+            {
+                const int d1 = disp1ptr[x];
+                if( d1 == INVALID_DISP_SCALED )
+                    continue;
+                const int _d = d1 >> DISP_SHIFT;
+                const int d_ = (d1 + DISP_SCALE-1) >> DISP_SHIFT;
+                const int _x = x - _d;
+                const int x_ = x - d_;
+                if( 0 <= _x && _x < width && disp2ptr[_x] >= minD && std::abs(disp2ptr[_x] - _d) > disp12MaxDiff &&
+                    0 <= x_ && x_ < width && disp2ptr[x_] >= minD && std::abs(disp2ptr[x_] - d_) > disp12MaxDiff )
+                    disp1ptr[x] = (DispType)INVALID_DISP_SCALED;
+            }
+        }
+
+        /*
+        4-directional variant of computeDisparityBinarySGBM (StereoBinarySGBM::MODE_HH4).
+        The costs are aggregated along the rows (left to right and right to left) and along the columns
+        (top to bottom and bottom to top). The paths of different rows, respectively columns, do not depend
+        on each other, so every pass runs in parallel over the image. It keeps the cost C and the summary
+        cost S of the whole image, i.e. O(W*H*numDisparities) memory as MODE_HH.
+        */
+        static void computeDisparityBinarySGBM_HH4( const Mat& img1,
+            Mat& disp1, const StereoBinarySGBMParams& params,
+            Mat& buffer, const Mat& hamDist)
+        {
+            const int ALIGN = 16;
+            const int DISP_SCALE = (1 << StereoMatcher::DISP_SHIFT);
+            const CostType MAX_COST = SHRT_MAX;
+            const int minD = params.minDisparity;
+            const int maxD = minD + params.numDisparities;
+            const int kernelSize = params.kernelSize > 0 ? params.kernelSize : 5;
+            const int uniquenessRatio = params.uniquenessRatio >= 0 ? params.uniquenessRatio : 10;
+            const int disp12MaxDiff = params.disp12MaxDiff > 0 ? params.disp12MaxDiff : 1;
+            const int P1 = params.P1 > 0 ? params.P1 : 2;
+            const int P2 = std::max(params.P2 > 0 ? params.P2 : 5, P1+1);
+            const int width = disp1.cols, height = disp1.rows;
+            const int minX1 = std::max(-maxD, 0);
+            const int maxX1 = width + std::min(minD, 0);
+            const int D = maxD - minD;
+            const int width1 = maxX1 - minX1;
+            const int SW2 = kernelSize/2, SH2 = kernelSize/2;
+            // lines of Lr with one MAX_COST element on each side, shifted by 8 to keep the alignment
+            const int D2 = D + 16;
+
+            if( minX1 >= maxX1 )
+            {
+                disp1 = Scalar::all((minD - 1)*DISP_SCALE);
+                return;
+            }
+            CV_Assert( D % 16 == 0 );
+            CV_UNUSED(img1);
+
+            const size_t costBufSize = (size_t)width1*D;
+            const size_t totalBufSize = costBufSize*height*2*sizeof(CostType) + ALIGN;
+            if( buffer.empty() || !buffer.isContinuous() ||
+                buffer.cols*buffer.rows*buffer.elemSize() < totalBufSize )
+                buffer.create(1, (int)totalBufSize, CV_8U);
+            CostType* Cbuf = (CostType*)alignPtr(buffer.ptr(), ALIGN);
+            CostType* Sbuf = Cbuf + costBufSize*height;
+            const short* ham = hamDist.ptr<short>();
+            const int hamStep = params.numDisparities + 1;
+
+            // horizontal box sums of the hamming costs, kept in S for now
+            parallel_for_(Range(0, height), [&](const Range& range)
+            {
+                for( int y = range.start; y < range.end; y++ )
+                {
+                    const short* hrow = ham + (size_t)y*width*hamStep;
+                    CostType* hsum = Sbuf + y*costBufSize;
+                    for( int d = 0; d < D; d++ )
+                    {
+                        int sum = 0;
+                        for( int k = -SW2; k <= SW2; k++ )
+                            sum += hrow[std::min(std::max(k, 0), width1 - 1)*hamStep + d];
+                        hsum[d] = saturate_cast<CostType>(sum);
+                    }
+                    for( int x = 1; x < width1; x++ )
+                    {
+                        const short* pixAdd = hrow + std::min(x + SW2, width1 - 1)*hamStep;
+                        const short* pixSub = hrow + std::max(x - SW2 - 1, 0)*hamStep;
+                        for( int d = 0; d < D; d++ )
+                            hsum[x*D + d] = saturate_cast<CostType>(hsum[(x - 1)*D + d] + pixAdd[d] - pixSub[d]);
+                    }
+                }
+            }, std::max(1, height / 8));
+
+            // C = P2 + vertical box sums, see computeDisparityBinarySGBM for the P2 offset
+            parallel_for_(Range(0, height), [&](const Range& range)
+            {
+                for( int y = range.start; y < range.end; y++ )
+                {
+                    CostType* C = Cbuf + y*costBufSize;
+                    for( size_t i = 0; i < costBufSize; i++ )
+                        C[i] = (CostType)P2;
+                    for( int k = y - SH2; k <= y + SH2; k++ )
+                        accumulateCost(C, Sbuf + std::min(std::max(k, 0), height - 1)*costBufSize, (int)costBufSize);
+                }
+            }, std::max(1, height / 8));
+
+            // left to right and right to left, S is overwritten by the sum of both
+            parallel_for_(Range(0, height), [&](const Range& range)
+            {
+                std::vector<CostType> Lbuf(D2*2, 0);
+                for( int y = range.start; y < range.end; y++ )
+                {
+                    const CostType* C = Cbuf + y*costBufSize;
+                    CostType* S = Sbuf + y*costBufSize;
+                    for( int dir = 0; dir < 2; dir++ )
+                    {
+                        CostType* Lprev = &Lbuf[8];
+                        CostType* Lp = &Lbuf[D2 + 8];
+                        std::fill(Lbuf.begin(), Lbuf.end(), (CostType)0);
+                        Lprev[-1] = Lprev[D] = Lp[-1] = Lp[D] = MAX_COST;
+                        int minLprev = 0;
+                        for( int i = 0; i < width1; i++ )
+                        {
+                            const int x = dir == 0 ? i : width1 - 1 - i;
+                            minLprev = aggregationStep(C + x*D, Lprev, Lp, D, P1, minLprev + P2);
+                            if( dir == 0 )
+                                std::copy(Lp, Lp + D, S + x*D);
+                            else
+                                accumulateCost(S + x*D, Lp, D);
+                            std::swap(Lprev, Lp);
+                        }
+                    }
+                }
+            }, std::max(1, height / 8));
+
+            // top to bottom and bottom to top over blocks of columns
+            const int blockCols = 16;
+            const int nblocks = (width1 + blockCols - 1) / blockCols;
+            parallel_for_(Range(0, nblocks), [&](const Range& range)
+            {
+                std::vector<CostType> Lbuf(blockCols*D2*2);
+                std::vector<int> minLbuf(blockCols);
+                for( int b = range.start; b < range.end; b++ )
+                {
+                    const int x0 = b*blockCols, x1 = std::min(x0 + blockCols, width1);
+                    for( int dir = 0; dir < 2; dir++ )
+                    {
+                        CostType* Lprev = &Lbuf[8];
+                        CostType* Lp = &Lbuf[blockCols*D2 + 8];
+                        std::fill(Lbuf.begin(), Lbuf.end(), (CostType)0);
+                        std::fill(minLbuf.begin(), minLbuf.end(), 0);
+                        for( int x = 0; x < blockCols; x++ )
+                            Lprev[x*D2 - 1] = Lprev[x*D2 + D] = Lp[x*D2 - 1] = Lp[x*D2 + D] = MAX_COST;
+                        for( int i = 0; i < height; i++ )
+                        {
+                            const int y = dir == 0 ? i : height - 1 - i;
+                            const CostType* C = Cbuf + y*costBufSize;
+                            CostType* S = Sbuf + y*costBufSize;
+                            for( int x = x0; x < x1; x++ )
+                            {
+                                CostType* L = Lp + (x - x0)*D2;
+                                minLbuf[x - x0] = aggregationStep(C + x*D, Lprev + (x - x0)*D2, L, D, P1, minLbuf[x - x0] + P2);
+                                accumulateCost(S + x*D, L, D);
+                            }
+                            std::swap(Lprev, Lp);
+                        }
+                    }
+                }
+            }, nblocks);
+
+            parallel_for_(Range(0, height), [&](const Range& range)
+            {
+                std::vector<CostType> disp2cost(width);
+                std::vector<DispType> disp2(width);
+                for( int y = range.start; y < range.end; y++ )
+                    computeRowDisparity(Sbuf + y*costBufSize, disp1.ptr<DispType>(y), &disp2cost[0], &disp2[0],
+                                        params, width, minX1, width1, D, uniquenessRatio, disp12MaxDiff);
+            }, std::max(1, height / 8));
+        }
+
         class StereoBinarySGBMImpl CV_FINAL : public StereoBinarySGBM, public Matching
         {
         public:
@@ -689,7 +996,10 @@ namespace cv
 
                 hammingDistanceBlockMatching(censusImageLeft, censusImageRight, hamDist, params.kernelSize);
 
-                computeDisparityBinarySGBM( left, disp, params, buffer,hamDist);
+                if( params.mode == StereoBinarySGBM::MODE_HH4 )
+                    computeDisparityBinarySGBM_HH4( left, disp, params, buffer, hamDist);
+                else
+                    computeDisparityBinarySGBM( left, disp, params, buffer,hamDist);
 
                 if(params.regionRemoval == CV_SPECKLE_REMOVAL_AVG_ALGORITHM)
                 {
@@ -64,6 +64,33 @@ TEST(qds_getDisparity, accuracy)
     ASSERT_LT(disparity_MAE(gt, outDisp),2) << "EPE should be 1.1053 for this sample/hyperparamters (Tested on version 4.5.1)";
 }
 
+TEST(qds_getDisparity, video_mode_and_bands)
+{
+    Mat image1, image2, gt;
+    image1 = imread(cvtest::TS::ptr()->get_data_path() + "stereomatching/datasets/cones/im2.png", IMREAD_GRAYSCALE);
+    image2 = imread(cvtest::TS::ptr()->get_data_path() + "stereomatching/datasets/cones/im6.png", IMREAD_GRAYSCALE);
+    gt = imread(cvtest::TS::ptr()->get_data_path() + "stereomatching/datasets/cones/disp2.png", IMREAD_GRAYSCALE);
+    ASSERT_FALSE(image1.empty() || image2.empty() || gt.empty()) << "Issue with input data";
+    gt.convertTo(gt, CV_32F);
+    gt = gt/4;
+
+    Ptr<stereo::QuasiDenseStereo> qds_matcher = stereo::QuasiDenseStereo::create(image1.size());
+    qds_matcher->setVideoMode(true);
+    qds_matcher->setNumGrowingBands(4);
+
+    // the second frame is seeded by the matches of the first one
+    for (int frame = 0; frame < 2; frame++)
+    {
+        qds_matcher->process(image1, image2);
+        std::vector<stereo::MatchQuasiDense> sparse;
+        qds_matcher->getSparseMatches(sparse);
+        EXPECT_FALSE(sparse.empty());
+        Mat outDisp = qds_matcher->getDisparity();
+        ASSERT_EQ(gt.size(), outDisp.size());
+        EXPECT_LT(disparity_MAE(gt, outDisp), 2) << "frame " << frame;
+    }
+}
+
 
 
 }} // namespace
\ No newline at end of file
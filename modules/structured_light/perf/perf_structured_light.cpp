@@ -0,0 +1,65 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+typedef perf::TestBaseWithParam<Size> GrayCodePattern;
+
+PERF_TEST_P(GrayCodePattern, decode, Values(Size(640, 480), Size(1024, 768), Size(1280, 800)))
+{
+    const Size sz = GetParam();
+    // the second camera sees the projector shifted to the right
+    const int shift = sz.width / 64;
+    Ptr<structured_light::GrayCodePattern> graycode = structured_light::GrayCodePattern::create(sz.width, sz.height);
+
+    std::vector<Mat> pattern;
+    graycode->generate(pattern);
+    std::vector<std::vector<Mat> > captured(2);
+    for (size_t i = 0; i < pattern.size(); i++)
+    {
+        captured[0].push_back(pattern[i]);
+        Mat shifted(sz, CV_8U, Scalar(0));
+        pattern[i].colRange(0, sz.width - shift).copyTo(shifted.colRange(shift, sz.width));
+        captured[1].push_back(shifted);
+    }
+    Mat black, white;
+    graycode->getImagesForShadowMasks(black, white);
+    std::vector<Mat> blackImages(2, black), whiteImages(2, white);
+    Mat disparity;
+
+    TEST_CYCLE() graycode->decode(captured, disparity, blackImages, whiteImages);
+
+    SANITY_CHECK_NOTHING();
+}
+
+CV_ENUM(SinusoidalMethod, structured_light::FTP, structured_light::PSP, structured_light::FAPS)
+
+typedef tuple<Size, SinusoidalMethod> SinusoidalPatternParams_t;
+typedef perf::TestBaseWithParam<SinusoidalPatternParams_t> SinusoidalPattern;
+
+PERF_TEST_P(SinusoidalPattern, computeAndUnwrapPhaseMap,
+            Combine(Values(Size(640, 480), Size(1024, 768)), SinusoidalMethod::all()))
+{
+    const Size sz = get<0>(GetParam());
+    Ptr<structured_light::SinusoidalPattern::Params> params = makePtr<structured_light::SinusoidalPattern::Params>();
+    params->width = sz.width;
+    params->height = sz.height;
+    params->methodId = get<1>(GetParam());
+    Ptr<structured_light::SinusoidalPattern> sinus = structured_light::SinusoidalPattern::create(params);
+
+    std::vector<Mat> patterns;
+    sinus->generate(patterns);
+    Mat wrapped, shadowMask, unwrapped;
+
+    TEST_CYCLE()
+    {
+        sinus->computePhaseMap(patterns, wrapped, shadowMask);
+        sinus->unwrapPhaseMap(wrapped, unwrapped, sz, shadowMask);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
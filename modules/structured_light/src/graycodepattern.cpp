@@ -40,6 +40,7 @@
  //M*/
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv {
 namespace structured_light {
@@ -102,8 +103,15 @@ class CV_EXPORTS_W GrayCodePattern_Impl CV_FINAL : public GrayCodePattern
   void computeShadowMasks( InputArrayOfArrays blackImages, InputArrayOfArrays whiteImages,
                            OutputArrayOfArrays shadowMasks ) const;
 
-  // Converts a gray code sequence (~ binary number) to a decimal number
-  int grayToDec( const std::vector<uchar>& gray ) const;
+  // Converts a gray code sequence, packed with the first pattern in the most significant bit, to a decimal number
+  int grayToDec( unsigned gray ) const;
+
+  // Computes the table from the packed gray codes of nbits to the decimal numbers, -1 for the ones out of [0, limit)
+  void computeGrayCodeTable( size_t nbits, int limit, std::vector<int>& table ) const;
+
+  // For every camera pixel inside of the shadow mask returns the corresponding projector pixel,
+  // (-1, -1) where it can not be decoded
+  void computeProjPixels( const std::vector<Mat>& patternImages, const Mat& shadowMask, Mat& projPixels ) const;
 };
 
 /*
@@ -220,89 +228,60 @@ bool GrayCodePattern_Impl::decode( const std::vector< std::vector<Mat> >& patter
     std::vector<Mat> shadowMasks;
     computeShadowMasks( blackImages, whitheImages, shadowMasks );
 
+    CV_Assert( acquired_pattern.size() >= 2 && shadowMasks.size() >= 2 );
+
     int cam_width = acquired_pattern[0][0].cols;
     int cam_height = acquired_pattern[0][0].rows;
 
-    Point projPixel;
-
-    // Storage for the pixels of the two cams that correspond to the same pixel of the projector
-    std::vector<std::vector<std::vector<Point> > > camsPixels;
-    camsPixels.resize( acquired_pattern.size() );
+    // Pixel to projector correspondences of the two cams
+    Mat projPixels[2];
+    for( int k = 0; k < 2; k++ )
+    {
+      computeProjPixels( acquired_pattern[k], shadowMasks[k], projPixels[k] );
+    }
 
-    // TODO: parallelize for (k and j)
-    for( size_t k = 0; k < acquired_pattern.size(); k++ )
+    // Sums of the x coordinates and numbers of the pixels of the two cams that correspond to the same pixel of the projector
+    const size_t projSize = ( size_t ) params.height * params.width;
+    std::vector<double> sumX[2];
+    std::vector<int> count[2];
+    for( int k = 0; k < 2; k++ )
     {
-      camsPixels[k].resize( params.height * params.width );
-      for( int i = 0; i < cam_width; i++ )
+      sumX[k].assign( projSize, 0. );
+      count[k].assign( projSize, 0 );
+      for( int j = 0; j < projPixels[k].rows; j++ )
       {
-        for( int j = 0; j < cam_height; j++ )
+        const Vec2i* proj = projPixels[k].ptr<Vec2i>( j );
+        for( int i = 0; i < projPixels[k].cols; i++ )
         {
-          //if the pixel is not shadowed, reconstruct
-          if( shadowMasks[k].at<uchar>( j, i ) )
-          {
-            //for a (x,y) pixel of the camera returns the corresponding projector pixel by calculating the decimal number
-            bool error = getProjPixel( acquired_pattern[k], i, j, projPixel );
-
-            if( error )
-            {
-              continue;
-            }
-
-            camsPixels[k][projPixel.x * params.height + projPixel.y].push_back( Point( i, j ) );
-          }
+          if( proj[i][0] < 0 )
+            continue;
+          size_t idx = ( size_t ) proj[i][0] * params.height + proj[i][1];
+          sumX[k][idx] += i;
+          count[k][idx]++;
         }
       }
     }
 
-    std::vector<Point> cam1Pixs, cam2Pixs;
-
     Mat& disparityMap_ = *( Mat* ) disparityMap.getObj();
     disparityMap_ = Mat( cam_height, cam_width, CV_64F, double( 0 ) );
 
-    double number_of_pixels_cam1 = 0;
-    double number_of_pixels_cam2 = 0;
-
-    for( int i = 0; i < params.width; i++ )
+    parallel_for_( Range( 0, cam_height ), [&]( const Range& range )
     {
-      for( int j = 0; j < params.height; j++ )
+      for( int j = range.start; j < range.end; j++ )
       {
-        cam1Pixs = camsPixels[0][i * params.height + j];
-        cam2Pixs = camsPixels[1][i * params.height + j];
-
-        if( cam1Pixs.size() == 0 || cam2Pixs.size() == 0 )
-          continue;
-
-        Point p1;
-        Point p2;
-
-        double sump1x = 0;
-        double sump2x = 0;
-
-        number_of_pixels_cam1 += cam1Pixs.size();
-        number_of_pixels_cam2 += cam2Pixs.size();
-        for( int c1 = 0; c1 < (int) cam1Pixs.size(); c1++ )
-        {
-          p1 = cam1Pixs[c1];
-          sump1x += p1.x;
-        }
-        for( int c2 = 0; c2 < (int) cam2Pixs.size(); c2++ )
-        {
-          p2 = cam2Pixs[c2];
-          sump2x += p2.x;
-        }
-
-        sump2x /= cam2Pixs.size();
-        sump1x /= cam1Pixs.size();
-        for( int c1 = 0; c1 < (int) cam1Pixs.size(); c1++ )
+        const Vec2i* proj = projPixels[0].ptr<Vec2i>( j );
+        double* disparity = disparityMap_.ptr<double>( j );
+        for( int i = 0; i < cam_width; i++ )
         {
-          p1 = cam1Pixs[c1];
-          disparityMap_.at<double>( p1.y, p1.x ) = ( double ) (sump2x - sump1x);
+          if( proj[i][0] < 0 )
+            continue;
+          size_t idx = ( size_t ) proj[i][0] * params.height + proj[i][1];
+          if( count[1][idx] == 0 )
+            continue;
+          disparity[i] = sumX[1][idx] / count[1][idx] - sumX[0][idx] / count[0][idx];
         }
-
-        sump2x = 0;
-        sump1x = 0;
       }
-    }
+    }, std::max( 1, cam_height / 32 ) );
 
     return true;
   }  // end if flags
@@ -334,30 +313,11 @@ void GrayCodePattern_Impl::computeShadowMasks( InputArrayOfArrays blackImages, I
 
   shadowMasks_.resize( whiteImages_.size() );
 
-  int cam_width = whiteImages_[0].cols;
-  int cam_height = whiteImages_[0].rows;
-
-  // TODO: parallelize for
   for( int k = 0; k < (int) shadowMasks_.size(); k++ )
   {
-    shadowMasks_[k] = Mat( cam_height, cam_width, CV_8U );
-    for( int i = 0; i < cam_width; i++ )
-    {
-      for( int j = 0; j < cam_height; j++ )
-      {
-        double white = whiteImages_[k].at<uchar>( Point( i, j ) );
-        double black = blackImages_[k].at<uchar>( Point( i, j ) );
-
-        if( abs(white - black) > blackThreshold )
-        {
-          shadowMasks_[k].at<uchar>( Point( i, j ) ) = ( uchar ) 1;
-        }
-        else
-        {
-          shadowMasks_[k].at<uchar>( Point( i, j ) ) = ( uchar ) 0;
-        }
-      }
-    }
+    Mat diff;
+    absdiff( whiteImages_[k], blackImages_[k], diff );
+    threshold( diff, shadowMasks_[k], ( double ) blackThreshold, 1, THRESH_BINARY );
   }
 }
 
@@ -375,8 +335,7 @@ void GrayCodePattern_Impl::getImagesForShadowMasks( InputOutputArray blackImage,
 bool GrayCodePattern_Impl::getProjPixel( InputArrayOfArrays patternImages, int x, int y, Point &projPix ) const
 {
   std::vector<Mat>& _patternImages = *( std::vector<Mat>* ) patternImages.getObj();
-  std::vector<uchar> grayCol;
-  std::vector<uchar> grayRow;
+  unsigned grayCol = 0, grayRow = 0;
 
   bool error = false;
   int xDec, yDec;
@@ -393,10 +352,7 @@ bool GrayCodePattern_Impl::getProjPixel( InputArrayOfArrays patternImages, int x
       error = true;
 
     // determine if projection pixel is on or off
-    if( val1 > val2 )
-      grayCol.push_back( 1 );
-    else
-      grayCol.push_back( 0 );
+    grayCol = ( grayCol << 1 ) | ( val1 > val2 ? 1 : 0 );
   }
 
   xDec = grayToDec( grayCol );
@@ -413,10 +369,7 @@ bool GrayCodePattern_Impl::getProjPixel( InputArrayOfArrays patternImages, int x
       error = true;
 
     // determine if projection pixel is on or off
-    if( val1 > val2 )
-      grayRow.push_back( 1 );
-    else
-      grayRow.push_back( 0 );
+    grayRow = ( grayRow << 1 ) | ( val1 > val2 ? 1 : 0 );
   }
 
   yDec = grayToDec( grayRow );
@@ -433,24 +386,112 @@ bool GrayCodePattern_Impl::getProjPixel( InputArrayOfArrays patternImages, int x
 }
 
 // Converts a gray code sequence (~ binary number) to a decimal number
-int GrayCodePattern_Impl::grayToDec( const std::vector<uchar>& gray ) const
+int GrayCodePattern_Impl::grayToDec( unsigned gray ) const
 {
-  int dec = 0;
+  // every binary digit is the XOR of the gray code digits above it
+  for( unsigned shift = 1; shift < 32; shift <<= 1 )
+    gray ^= gray >> shift;
 
-  uchar tmp = gray[0];
+  return ( int ) gray;
+}
 
-  if( tmp )
-    dec += ( int ) pow( ( float ) 2, int( gray.size() - 1 ) );
+void GrayCodePattern_Impl::computeGrayCodeTable( size_t nbits, int limit, std::vector<int>& table ) const
+{
+  table.resize( ( size_t ) 1 << nbits );
+  for( size_t gray = 0; gray < table.size(); gray++ )
+  {
+    int dec = grayToDec( ( unsigned ) gray );
+    table[gray] = dec < limit ? dec : -1;
+  }
+}
 
-  for( int i = 1; i < (int) gray.size(); i++ )
+// Shifts the bit of one pattern image and its inverse into the packed gray codes of a row, and marks
+// the pixels where they differ by less than thr as errors
+static void packPatternBits( const uchar* img, const uchar* inv, int width, uchar thr, unsigned* code, uchar* error )
+{
+  int x = 0;
+#if CV_SIMD128
+  const v_uint8x16 vthr = v_setall_u8( thr ), one = v_setall_u8( 1 );
+  for( ; x <= width - 16; x += 16 )
+  {
+    v_uint8x16 a = v_load( img + x ), b = v_load( inv + x );
+    v_store( error + x, v_load( error + x ) | ( v_absdiff( a, b ) < vthr ) );
+
+    v_uint16x8 b0, b1;
+    v_uint32x4 c0, c1, c2, c3;
+    v_expand( ( a > b ) & one, b0, b1 );
+    v_expand( b0, c0, c1 );
+    v_expand( b1, c2, c3 );
+    v_store( code + x, ( v_load( code + x ) << 1 ) | c0 );
+    v_store( code + x + 4, ( v_load( code + x + 4 ) << 1 ) | c1 );
+    v_store( code + x + 8, ( v_load( code + x + 8 ) << 1 ) | c2 );
+    v_store( code + x + 12, ( v_load( code + x + 12 ) << 1 ) | c3 );
+  }
+#endif
+  for( ; x < width; x++ )
   {
-    // XOR operation
-    tmp = tmp ^ gray[i];
-    if( tmp )
-      dec += (int) pow( ( float ) 2, int( gray.size() - i - 1 ) );
+    int a = img[x], b = inv[x];
+    if( std::abs( a - b ) < thr )
+      error[x] = 255;
+    code[x] = ( code[x] << 1 ) | ( a > b ? 1u : 0u );
   }
+}
 
-  return dec;
+void GrayCodePattern_Impl::computeProjPixels( const std::vector<Mat>& patternImages, const Mat& shadowMask, Mat& projPixels ) const
+{
+  CV_Assert( patternImages.size() >= numOfPatternImages );
+  const int width = patternImages[0].cols, height = patternImages[0].rows;
+  for( size_t i = 0; i < numOfPatternImages; i++ )
+  {
+    CV_Assert( patternImages[i].type() == CV_8UC1 && patternImages[i].size() == patternImages[0].size() );
+  }
+  CV_Assert( shadowMask.type() == CV_8UC1 && shadowMask.size() == patternImages[0].size() );
+
+  projPixels.create( height, width, CV_32SC2 );
+  projPixels.setTo( Scalar::all( -1 ) );
+  // no difference between a pattern and its inverse is larger than 255
+  if( whiteThreshold > 255 )
+    return;
+  const uchar thr = ( uchar ) whiteThreshold;
+
+  std::vector<int> colTable, rowTable;
+  computeGrayCodeTable( numOfColImgs, params.width, colTable );
+  computeGrayCodeTable( numOfRowImgs, params.height, rowTable );
+
+  // the projector pixels are decoded in bands of rows, the bits of all the pattern images are packed
+  // row by row into one gray code per pixel and direction
+  parallel_for_( Range( 0, height ), [&]( const Range& range )
+  {
+    std::vector<unsigned> colCode( width ), rowCode( width );
+    std::vector<uchar> error( width );
+    for( int y = range.start; y < range.end; y++ )
+    {
+      std::fill( colCode.begin(), colCode.end(), 0u );
+      std::fill( rowCode.begin(), rowCode.end(), 0u );
+      std::fill( error.begin(), error.end(), ( uchar ) 0 );
+      for( size_t count = 0; count < numOfColImgs; count++ )
+      {
+        packPatternBits( patternImages[count * 2].ptr( y ), patternImages[count * 2 + 1].ptr( y ), width, thr,
+                         &colCode[0], &error[0] );
+      }
+      for( size_t count = 0; count < numOfRowImgs; count++ )
+      {
+        packPatternBits( patternImages[count * 2 + numOfColImgs * 2].ptr( y ), patternImages[count * 2 + numOfColImgs * 2 + 1].ptr( y ),
+                         width, thr, &rowCode[0], &error[0] );
+      }
+
+      const uchar* mask = shadowMask.ptr( y );
+      Vec2i* proj = projPixels.ptr<Vec2i>( y );
+      for( int x = 0; x < width; x++ )
+      {
+        if( !mask[x] || error[x] )
+          continue;
+        int xDec = colTable[colCode[x]], yDec = rowTable[rowCode[x]];
+        if( xDec >= 0 && yDec >= 0 )
+          proj[x] = Vec2i( xDec, yDec );
+      }
+    }
+  }, std::max( 1, height / 32 ) );
 }
 
 // Sets the value for black threshold
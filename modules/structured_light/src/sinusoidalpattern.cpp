@@ -41,6 +41,8 @@
 
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+#include <cfloat>
 
 namespace cv {
 namespace structured_light {
@@ -106,6 +108,9 @@ private:
                               InputArray shadowMask, OutputArray wrappedPhaseMap );
     // Compute a shadow mask to discard shadow regions
     void computeShadowMask( InputArrayOfArrays patternImages, OutputArray shadowMask );
+    // Unwrap a phase map without changing the unwrapping parameters, so that several maps can be unwrapped in parallel
+    void unwrapPhaseMapImpl( const Mat &wrappedPhaseMap, Mat &unwrappedPhaseMap, const Mat &shadowMask,
+                             const phase_unwrapping::HistogramPhaseUnwrapping::Params &parameters ) const;
     // Data modulation term is used to isolate cross markers
 
     void extractMarkersLocation( InputArray dataModulationTerm,
@@ -129,6 +134,52 @@ private:
         void drawMarker( OutputArray pattern );
     };
 };
+// atan2(y, x) in [-pi, pi] with the polynomial of Abramowitz and Stegun 4.4.49, the error is below 1e-5 rad
+static inline float fastAtan2Rad( float y, float x )
+{
+    float ax = std::abs(x), ay = std::abs(y);
+    float t = std::min(ax, ay) / std::max(std::max(ax, ay), FLT_MIN);
+    float t2 = t * t;
+    float r = t * (0.9998660f + t2 * (-0.3302995f + t2 * (0.1801410f + t2 * (-0.0851330f + t2 * 0.0208351f))));
+    if( ay > ax )
+        r = (float)CV_PI / 2 - r;
+    if( x < 0 )
+        r = (float)CV_PI - r;
+    return y < 0 ? -r : r;
+}
+
+// Phase of every pixel of a row, 0 outside of the mask
+static void computeAtan2Row( const float *y, const float *x, const uchar *mask, float *dst, int cols )
+{
+    int j = 0;
+#if CV_SIMD128
+    const v_float32x4 c1 = v_setall_f32(0.9998660f), c3 = v_setall_f32(-0.3302995f),
+                      c5 = v_setall_f32(0.1801410f), c7 = v_setall_f32(-0.0851330f),
+                      c9 = v_setall_f32(0.0208351f), halfPi = v_setall_f32((float)CV_PI / 2),
+                      pi = v_setall_f32((float)CV_PI), zero = v_setzero_f32(),
+                      minValue = v_setall_f32(FLT_MIN);
+    for( ; j <= cols - 4; j += 4 )
+    {
+        v_float32x4 vy = v_load(y + j), vx = v_load(x + j);
+        v_float32x4 ax = v_abs(vx), ay = v_abs(vy);
+        v_float32x4 t = v_min(ax, ay) / v_max(v_max(ax, ay), minValue);
+        v_float32x4 t2 = t * t;
+        v_float32x4 r = t * (c1 + t2 * (c3 + t2 * (c5 + t2 * (c7 + t2 * c9))));
+        r = v_select(ay > ax, halfPi - r, r);
+        r = v_select(vx < zero, pi - r, r);
+        r = v_select(vy < zero, zero - r, r);
+        v_store(dst + j, r);
+    }
+#endif
+    for( ; j < cols; ++j )
+        dst[j] = fastAtan2Rad(y[j], x[j]);
+    for( j = 0; j < cols; ++j )
+    {
+        if( mask[j] == 0 )
+            dst[j] = 0;
+    }
+}
+
 // Default parameters value
 SinusoidalPattern::Params::Params()
 {
@@ -318,30 +369,31 @@ void SinusoidalPatternProfilometry_Impl::computePhaseMap( InputArrayOfArrays pat
         std::vector<Mat> dftMags(nbrOfPatterns);
         int halfWidth = cols/2;
         int halfHeight = rows/2;
-        Point m1, m2;
 
         computeShadowMask(pattern_, shadowMask_);
 
         //this loop symmetrically filters pattern to remove cross markers.
-        for( int i = 0; i < nbrOfPatterns; ++i )
+        parallel_for_(Range(0, nbrOfPatterns), [&](const Range& range)
         {
-            computeDft(pattern_[i], dftImages[i]);
-            swapQuadrants(dftImages[i], halfWidth, halfHeight);
-            frequencyFiltering(dftImages[i], halfHeight, halfWidth, dcHeight, dcWidth, false);
-            computeDftMagnitude(dftImages[i], dftMags[i]);
-            findMaxInHalvesTransform(dftMags[i], m1, m2);
-            frequencyFiltering(dftImages[i], m1.y, m1.x, bpHeight, bpWidth, true, m2.y, m2.x);//symmetrical filtering
-            swapQuadrants(dftImages[i], halfWidth, halfHeight);
-            computeInverseDft(dftImages[i], filteredPatterns[i], true);
-
-        }
+            for( int i = range.start; i < range.end; ++i )
+            {
+                Point m1, m2;
+                computeDft(pattern_[i], dftImages[i]);
+                swapQuadrants(dftImages[i], halfWidth, halfHeight);
+                frequencyFiltering(dftImages[i], halfHeight, halfWidth, dcHeight, dcWidth, false);
+                computeDftMagnitude(dftImages[i], dftMags[i]);
+                findMaxInHalvesTransform(dftMags[i], m1, m2);
+                frequencyFiltering(dftImages[i], m1.y, m1.x, bpHeight, bpWidth, true, m2.y, m2.x);//symmetrical filtering
+                swapQuadrants(dftImages[i], halfWidth, halfHeight);
+                computeInverseDft(dftImages[i], filteredPatterns[i], true);
+            }
+        }, nbrOfPatterns);
         computePsPhaseMap(filteredPatterns, shadowMask_, wrappedPhaseMap_);
     }
     else if( params.methodId == FAPS )
     {
         Mat &shadowMask_ = *(Mat*) shadowMask.getObj();
         int nbrOfPatterns = static_cast<int>(pattern_.size());
-        std::vector<Mat> unwrappedFTPhaseMaps;
         std::vector<Mat> filteredPatterns(nbrOfPatterns);
         Mat dmt;
         Mat theta1, theta2, a, b;
@@ -351,29 +403,37 @@ void SinusoidalPatternProfilometry_Impl::computePhaseMap( InputArrayOfArrays pat
         camSize.width = pattern_[0].cols;
         computeShadowMask(pattern_, shadowMask_);
 
-        for( int i = 0; i < nbrOfPatterns; ++i )
+        std::vector<Mat> unwrappedFTPhaseMaps(nbrOfPatterns);
+        phase_unwrapping::HistogramPhaseUnwrapping::Params parameters = unwrappingParams;
+        parameters.width = camSize.width;
+        parameters.height = camSize.height;
+        // the patterns are filtered and unwrapped independently
+        parallel_for_(Range(0, nbrOfPatterns), [&](const Range& range)
         {
-            Mat dftImage, complexInverseDft;
-            Mat dftMag;
-            Mat tempWrappedPhaseMap;
-            Mat tempUnwrappedPhaseMap;
-            int halfWidth = cols/2;
-            int halfHeight = rows/2;
-            Point m1, m2;
-
-            computeDft(pattern_[i], dftImage); //compute the complex pattern DFT
-            swapQuadrants(dftImage, halfWidth, halfHeight); //swap quadrants to get 0 frequency in (halfWidth, halfHeight)
-            frequencyFiltering(dftImage, halfHeight, halfWidth, dcHeight, dcWidth, false); //get rid of 0 frequency
-            computeDftMagnitude(dftImage, dftMag); //compute magnitude to find maxima
-            findMaxInHalvesTransform(dftMag, m1, m2); //look for maxima in the magnitude. Useful information is located around maxima
-            frequencyFiltering(dftImage, m2.y, m2.x, bpHeight, bpWidth, true); //keep useful information only
-            swapQuadrants(dftImage,halfWidth, halfHeight); //swap quadrants again to compute inverse dft
-            computeInverseDft(dftImage, complexInverseDft, false); //compute inverse dft. Result is complex since we only keep half of the spectrum
-            computeFtPhaseMap(complexInverseDft, shadowMask_, tempWrappedPhaseMap); //compute phaseMap from the complex image.
-            unwrapPhaseMap(tempWrappedPhaseMap, tempUnwrappedPhaseMap, camSize, shadowMask);
-            unwrappedFTPhaseMaps.push_back(tempUnwrappedPhaseMap);
-            computeInverseDft(dftImage, filteredPatterns[i], true);
-        }
+            for( int i = range.start; i < range.end; ++i )
+            {
+                Mat dftImage, complexInverseDft;
+                Mat dftMag;
+                Mat tempWrappedPhaseMap;
+                int halfWidth = cols/2;
+                int halfHeight = rows/2;
+                Point m1, m2;
+
+                computeDft(pattern_[i], dftImage); //compute the complex pattern DFT
+                swapQuadrants(dftImage, halfWidth, halfHeight); //swap quadrants to get 0 frequency in (halfWidth, halfHeight)
+                frequencyFiltering(dftImage, halfHeight, halfWidth, dcHeight, dcWidth, false); //get rid of 0 frequency
+                computeDftMagnitude(dftImage, dftMag); //compute magnitude to find maxima
+                findMaxInHalvesTransform(dftMag, m1, m2); //look for maxima in the magnitude. Useful information is located around maxima
+                frequencyFiltering(dftImage, m2.y, m2.x, bpHeight, bpWidth, true); //keep useful information only
+                swapQuadrants(dftImage,halfWidth, halfHeight); //swap quadrants again to compute inverse dft
+                computeInverseDft(dftImage, complexInverseDft, false); //compute inverse dft. Result is complex since we only keep half of the spectrum
+                computeFtPhaseMap(complexInverseDft, shadowMask_, tempWrappedPhaseMap); //compute phaseMap from the complex image.
+                unwrapPhaseMapImpl(tempWrappedPhaseMap, unwrappedFTPhaseMaps[i], shadowMask_, parameters);
+                computeInverseDft(dftImage, filteredPatterns[i], true);
+            }
+        }, nbrOfPatterns);
+        unwrappingParams.width = camSize.width;
+        unwrappingParams.height = camSize.height;
 
         theta1.create(camSize.height, camSize.width, unwrappedFTPhaseMaps[0].type());
         theta2.create(camSize.height, camSize.width, unwrappedFTPhaseMaps[0].type());
@@ -415,10 +475,17 @@ void SinusoidalPatternProfilometry_Impl::unwrapPhaseMap( InputArray wrappedPhase
         temp.copyTo(mask);
     }
 
+    unwrapPhaseMapImpl(wPhaseMap, uPhaseMap, mask, unwrappingParams);
+}
+
+void SinusoidalPatternProfilometry_Impl::unwrapPhaseMapImpl( const Mat &wrappedPhaseMap, Mat &unwrappedPhaseMap,
+                                                             const Mat &shadowMask,
+                                                             const phase_unwrapping::HistogramPhaseUnwrapping::Params &parameters ) const
+{
     Ptr<phase_unwrapping::HistogramPhaseUnwrapping> phaseUnwrapping =
-            phase_unwrapping::HistogramPhaseUnwrapping::create(unwrappingParams);
+            phase_unwrapping::HistogramPhaseUnwrapping::create(parameters);
 
-    phaseUnwrapping->unwrapPhaseMap(wPhaseMap, uPhaseMap, mask);
+    phaseUnwrapping->unwrapPhaseMap(wrappedPhaseMap, unwrappedPhaseMap, shadowMask);
 }
 
 void SinusoidalPatternProfilometry_Impl::findProCamMatches( InputArray projUnwrappedPhaseMap,
@@ -440,9 +507,8 @@ void SinusoidalPatternProfilometry_Impl::computeDft( InputArray patternImage,
     int n = getOptimalDFTSize(pattern_.cols);
     copyMakeBorder(pattern_, padded, 0, m - pattern_.rows, 0, n - pattern_.cols, BORDER_CONSTANT,
                    Scalar::all(0));
-    Mat planes[] = {Mat_<float>(padded), Mat::zeros(padded.size(), CV_32F)};
-    merge(planes, 2, FourierTransform_);
-    dft(FourierTransform_, FourierTransform_);
+    // the full spectrum of the real pattern, the same as the transform of the complex pattern with a null imaginary part
+    dft(Mat_<float>(padded), FourierTransform_, DFT_COMPLEX_OUTPUT);
 }
 
 void SinusoidalPatternProfilometry_Impl::computeInverseDft( InputArray FourierTransform,
@@ -481,32 +547,27 @@ void SinusoidalPatternProfilometry_Impl::computeFtPhaseMap( InputArray inverseFo
     Mat &inverseFourierTransform_ = *(Mat*) inverseFourierTransform.getObj();
     Mat &wrappedPhaseMap_ = *(Mat*) wrappedPhaseMap.getObj();
     Mat &shadowMask_ = *(Mat*) shadowMask.getObj();
-    Mat planes[2];
 
     int rows = inverseFourierTransform_.rows;
     int cols = inverseFourierTransform_.cols;
 
-    if( wrappedPhaseMap_.empty () )
-        wrappedPhaseMap_.create(rows, cols, CV_32FC1);
+    CV_Assert( inverseFourierTransform_.type() == CV_32FC2 );
+    wrappedPhaseMap_.create(rows, cols, CV_32FC1);
 
-    split(inverseFourierTransform_, planes);
-
-    for( int i = 0; i < rows; ++i )
+    parallel_for_(Range(0, rows), [&](const Range& range)
     {
-        for( int j = 0; j < cols; ++j )
+        std::vector<float> re(cols), im(cols);
+        for( int i = range.start; i < range.end; ++i )
         {
-            if( shadowMask_.at<uchar>(i, j) != 0 )
+            const float *src = inverseFourierTransform_.ptr<float>(i);
+            for( int j = 0; j < cols; ++j )
             {
-                float im = planes[1].at<float>(i, j);
-                float re = planes[0].at<float>(i, j);
-                wrappedPhaseMap_.at<float>(i, j) = atan2(re, im);
-            }
-            else
-            {
-                wrappedPhaseMap_.at<float>(i, j) = 0;
+                re[j] = src[2 * j];
+                im[j] = src[2 * j + 1];
             }
+            computeAtan2Row(&re[0], &im[0], shadowMask_.ptr<uchar>(i), wrappedPhaseMap_.ptr<float>(i), cols);
         }
-    }
+    }, std::max(1, rows / 16));
 }
 void SinusoidalPatternProfilometry_Impl::swapQuadrants( InputOutputArray image,
                                                        int centerX, int centerY )
@@ -637,41 +698,31 @@ void SinusoidalPatternProfilometry_Impl::computePsPhaseMap( InputArrayOfArrays p
     int rows = pattern_[0].rows;
     int cols = pattern_[0].cols;
 
-    float i1 = 0;
-    float i2 = 0;
-    float i3 = 0;
+    CV_Assert( pattern_[0].type() == CV_8UC1 || pattern_[0].type() == CV_32FC1 );
+    wrappedPhaseMap_.create(rows, cols, CV_32FC1);
 
-    if( wrappedPhaseMap_.empty() )
-        wrappedPhaseMap_.create(rows, cols, CV_32FC1);
+    Mat patterns[3];
+    for( int k = 0; k < 3; ++k )
+        pattern_[k].convertTo(patterns[k], CV_32F);
 
-    for( int i = 0; i < rows; ++i )
+    const float numScale = 1 - cos(params.shiftValue);
+    const float denScale = sin(params.shiftValue);
+    parallel_for_(Range(0, rows), [&](const Range& range)
     {
-        for( int j = 0; j < cols; ++j )
+        std::vector<float> num(cols), den(cols);
+        for( int i = range.start; i < range.end; ++i )
         {
-            if( shadowMask_.at<uchar>(i, j) != 0 )
+            const float *i1 = patterns[0].ptr<float>(i);
+            const float *i2 = patterns[1].ptr<float>(i);
+            const float *i3 = patterns[2].ptr<float>(i);
+            for( int j = 0; j < cols; ++j )
             {
-                if( pattern_[0].type() == CV_8UC1 )
-                {
-                    i1 = pattern_[0].at<uchar>(i, j);
-                    i2 = pattern_[1].at<uchar>(i, j);
-                    i3 = pattern_[2].at<uchar>(i, j);
-                }
-                else if( pattern_[0].type() == CV_32FC1 )
-                {
-                    i1 = pattern_[0].at<float>(i, j);
-                    i2 = pattern_[1].at<float>(i, j);
-                    i3 = pattern_[2].at<float>(i, j);
-                }
-                float num = (1- cos(params.shiftValue)) * (i3 - i2);
-                float den = sin(params.shiftValue) * (2 * i1 - i2 - i3);
-                wrappedPhaseMap_.at<float>(i,j) = atan2(num, den);
-            }
-            else
-            {
-                wrappedPhaseMap_.at<float>(i,j) = 0;
+                num[j] = numScale * (i3[j] - i2[j]);
+                den[j] = denScale * (2 * i1[j] - i2[j] - i3[j]);
             }
+            computeAtan2Row(&num[0], &den[0], shadowMask_.ptr<uchar>(i), wrappedPhaseMap_.ptr<float>(i), cols);
         }
-    }
+    }, std::max(1, rows / 16));
 }
 
 void SinusoidalPatternProfilometry_Impl::computeFapsPhaseMap( InputArray a,
@@ -691,29 +742,29 @@ void SinusoidalPatternProfilometry_Impl::computeFapsPhaseMap( InputArray a,
     int rows = a_.rows;
     int cols = a_.cols;
 
-    if( wrappedPhaseMap_.empty() )
-        wrappedPhaseMap_.create(rows, cols, CV_32FC1);
+    CV_Assert( a_.type() == CV_32FC1 && b_.type() == CV_32FC1 &&
+               theta1_.type() == CV_32FC1 && theta2_.type() == CV_32FC1 );
+    wrappedPhaseMap_.create(rows, cols, CV_32FC1);
 
-    for( int i = 0; i < rows; ++i )
+    parallel_for_(Range(0, rows), [&](const Range& range)
     {
-        for( int j = 0; j < cols; ++j )
+        Mat cos1(1, cols, CV_32F), sin1(1, cols, CV_32F), cos2(1, cols, CV_32F), sin2(1, cols, CV_32F);
+        std::vector<float> num(cols), den(cols);
+        for( int i = range.start; i < range.end; ++i )
         {
-            if( shadowMask_.at<uchar>(i, j ) != 0 )
+            polarToCart(noArray(), theta1_.row(i), cos1, sin1);
+            polarToCart(noArray(), theta2_.row(i), cos2, sin2);
+            const float *pa = a_.ptr<float>(i), *pb = b_.ptr<float>(i);
+            const float *c1 = cos1.ptr<float>(), *s1 = sin1.ptr<float>();
+            const float *c2 = cos2.ptr<float>(), *s2 = sin2.ptr<float>();
+            for( int j = 0; j < cols; ++j )
             {
-                float num = (1 - cos(theta2_.at<float>(i, j))) * a_.at<float>(i, j) +
-                            (1 - cos(theta1_.at<float>(i, j))) * b_.at<float>(i, j);
-
-                float den = sin(theta1_.at<float>(i, j)) * b_.at<float>(i, j) -
-                            sin(theta2_.at<float>(i, j)) * a_.at<float>(i, j);
-
-                wrappedPhaseMap_.at<float>(i, j) = atan2(num, den);
-            }
-            else
-            {
-                wrappedPhaseMap_.at<float>(i, j) = 0;
+                num[j] = (1 - c2[j]) * pa[j] + (1 - c1[j]) * pb[j];
+                den[j] = s1[j] * pb[j] - s2[j] * pa[j];
             }
+            computeAtan2Row(&num[0], &den[0], shadowMask_.ptr<uchar>(i), wrappedPhaseMap_.ptr<float>(i), cols);
         }
-    }
+    }, std::max(1, rows / 16));
 }
 
 //compute shadow mask from three patterns. Valid pixels are lit at least by one pattern
@@ -722,24 +773,12 @@ void SinusoidalPatternProfilometry_Impl::computeShadowMask( InputArrayOfArrays p
 {
     std::vector<Mat> &patternImages_ = *(std::vector<Mat>*) patternImages.getObj();
     Mat &shadowMask_ = *(Mat*) shadowMask.getObj();
-    Mat mean;
-    int rows = patternImages_[0].rows;
-    int cols = patternImages_[0].cols;
-    float i1, i2, i3;
+    Mat sum, mean;
 
-    mean.create(rows, cols, CV_32FC1);
-
-    for( int i = 0; i < rows; ++i )
-    {
-        for( int j = 0; j < cols; ++j )
-        {
-            i1 = (float) patternImages_[0].at<uchar>(i, j);
-            i2 = (float) patternImages_[1].at<uchar>(i, j);
-            i3 = (float) patternImages_[2].at<uchar>(i, j);
-            mean.at<float>(i, j) = (i1 + i2 + i3) / 3;
-        }
-    }
-    mean.convertTo(mean, CV_8UC1);
+    patternImages_[0].convertTo(sum, CV_32F);
+    accumulate(patternImages_[1], sum);
+    accumulate(patternImages_[2], sum);
+    sum.convertTo(mean, CV_8UC1, 1. / 3);
     threshold(mean, shadowMask_, 10, 255, 0);
 
 }
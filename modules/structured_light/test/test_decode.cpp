@@ -0,0 +1,46 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+TEST( GrayCodePattern, decode_shifted_cameras )
+{
+  // the second camera sees the projector shifted by shift pixels to the right
+  const int width = 100, height = 37, shift = 7;
+  Ptr<structured_light::GrayCodePattern> graycode = structured_light::GrayCodePattern::create( width, height );
+
+  vector<Mat> pattern;
+  graycode->generate( pattern );
+
+  vector<vector<Mat> > captured( 2 );
+  for( size_t i = 0; i < pattern.size(); i++ )
+  {
+    captured[0].push_back( pattern[i] );
+    Mat shifted( height, width, CV_8U, Scalar( 0 ) );
+    pattern[i].colRange( 0, width - shift ).copyTo( shifted.colRange( shift, width ) );
+    captured[1].push_back( shifted );
+  }
+
+  Mat black, white;
+  graycode->getImagesForShadowMasks( black, white );
+  vector<Mat> blackImages( 2, black ), whiteImages( 2, white );
+
+  Mat disparity;
+  ASSERT_TRUE( graycode->decode( captured, disparity, blackImages, whiteImages ) );
+  ASSERT_EQ( disparity.type(), CV_64F );
+  ASSERT_EQ( disparity.size(), Size( width, height ) );
+
+  for( int y = 0; y < height; y++ )
+  {
+    for( int x = 0; x < width; x++ )
+    {
+      double expected = x < width - shift ? shift : 0;
+      EXPECT_EQ( expected, disparity.at<double>( y, x ) ) << "at (" << x << ", " << y << ")";
+    }
+  }
+}
+
+}} // namespace
@@ -52,173 +52,56 @@ using namespace cv::superres::detail;
 
 namespace
 {
-#ifdef HAVE_OPENCL
-
-    bool ocl_calcRelativeMotions(InputArrayOfArrays _forwardMotions, InputArrayOfArrays _backwardMotions,
-                                 OutputArrayOfArrays _relForwardMotions, OutputArrayOfArrays _relBackwardMotions,
-                                 int baseIdx, const Size & size)
+    void upscaleMotion(InputArray _lowResMotion, OutputArray _highResMotion, int scale)
     {
-        std::vector<UMat> & forwardMotions = *(std::vector<UMat> *)_forwardMotions.getObj(),
-                & backwardMotions = *(std::vector<UMat> *)_backwardMotions.getObj(),
-                & relForwardMotions = *(std::vector<UMat> *)_relForwardMotions.getObj(),
-                & relBackwardMotions = *(std::vector<UMat> *)_relBackwardMotions.getObj();
+        // the OpenCL path has always used a bilinear interpolation
+        const int interpolation = _highResMotion.isUMat() ? INTER_LINEAR : INTER_CUBIC;
 
-        const int count = static_cast<int>(forwardMotions.size());
-
-        relForwardMotions.resize(count);
-        relForwardMotions[baseIdx].create(size, CV_32FC2);
-        relForwardMotions[baseIdx].setTo(Scalar::all(0));
+        resize(_lowResMotion, _highResMotion, Size(), scale, scale, interpolation);
+        multiply(_highResMotion, Scalar::all(scale), _highResMotion);
+    }
 
-        relBackwardMotions.resize(count);
-        relBackwardMotions[baseIdx].create(size, CV_32FC2);
-        relBackwardMotions[baseIdx].setTo(Scalar::all(0));
+    void buildIdentityMap(Size size, OutputArray _map)
+    {
+        Mat map(size, CV_32FC2);
 
-        for (int i = baseIdx - 1; i >= 0; --i)
+        for (int y = 0; y < size.height; ++y)
         {
-            add(relForwardMotions[i + 1], forwardMotions[i], relForwardMotions[i]);
-            add(relBackwardMotions[i + 1], backwardMotions[i + 1], relBackwardMotions[i]);
-        }
+            Point2f* mapRow = map.ptr<Point2f>(y);
 
-        for (int i = baseIdx + 1; i < count; ++i)
-        {
-            add(relForwardMotions[i - 1], backwardMotions[i], relForwardMotions[i]);
-            add(relBackwardMotions[i - 1], forwardMotions[i - 1], relBackwardMotions[i]);
+            for (int x = 0; x < size.width; ++x)
+                mapRow[x] = Point2f(static_cast<float>(x), static_cast<float>(y));
         }
 
-        return true;
+        map.copyTo(_map);
     }
 
-#endif
-
-    void calcRelativeMotions(InputArrayOfArrays _forwardMotions, InputArrayOfArrays _backwardMotions,
-                             OutputArrayOfArrays _relForwardMotions, OutputArrayOfArrays _relBackwardMotions,
-                             int baseIdx, const Size & size)
+    // Builds the remap tables of every frame of the window from the upscaled flows of the
+    // consecutive pairs: the map of a frame is the one of its neighbour towards the base frame
+    // plus the flow between them, so the relative motions are never stored.
+    template <typename MatT>
+    void buildMotionMaps(const std::vector<MatT>& forwardMotions, const std::vector<MatT>& backwardMotions,
+                         const MatT& identityMap, int baseIdx,
+                         std::vector<MatT>& forwardMaps, std::vector<MatT>& backwardMaps)
     {
-        CV_OCL_RUN(_forwardMotions.isUMatVector() && _backwardMotions.isUMatVector() &&
-                   _relForwardMotions.isUMatVector() && _relBackwardMotions.isUMatVector(),
-                   ocl_calcRelativeMotions(_forwardMotions, _backwardMotions, _relForwardMotions,
-                                           _relBackwardMotions, baseIdx, size))
-
-        std::vector<Mat> & forwardMotions = *(std::vector<Mat> *)_forwardMotions.getObj(),
-                & backwardMotions = *(std::vector<Mat> *)_backwardMotions.getObj(),
-                & relForwardMotions = *(std::vector<Mat> *)_relForwardMotions.getObj(),
-                & relBackwardMotions = *(std::vector<Mat> *)_relBackwardMotions.getObj();
-
         const int count = static_cast<int>(forwardMotions.size());
 
-        relForwardMotions.resize(count);
-        relForwardMotions[baseIdx].create(size, CV_32FC2);
-        relForwardMotions[baseIdx].setTo(Scalar::all(0));
+        forwardMaps.resize(count);
+        backwardMaps.resize(count);
 
-        relBackwardMotions.resize(count);
-        relBackwardMotions[baseIdx].create(size, CV_32FC2);
-        relBackwardMotions[baseIdx].setTo(Scalar::all(0));
+        identityMap.copyTo(forwardMaps[baseIdx]);
+        identityMap.copyTo(backwardMaps[baseIdx]);
 
         for (int i = baseIdx - 1; i >= 0; --i)
         {
-            add(relForwardMotions[i + 1], forwardMotions[i], relForwardMotions[i]);
-            add(relBackwardMotions[i + 1], backwardMotions[i + 1], relBackwardMotions[i]);
+            add(backwardMaps[i + 1], forwardMotions[i], backwardMaps[i]);
+            add(forwardMaps[i + 1], backwardMotions[i + 1], forwardMaps[i]);
         }
 
         for (int i = baseIdx + 1; i < count; ++i)
         {
-            add(relForwardMotions[i - 1], backwardMotions[i], relForwardMotions[i]);
-            add(relBackwardMotions[i - 1], forwardMotions[i - 1], relBackwardMotions[i]);
-        }
-    }
-#ifdef HAVE_OPENCL
-
-    bool ocl_upscaleMotions(InputArrayOfArrays _lowResMotions, OutputArrayOfArrays _highResMotions, int scale)
-    {
-        std::vector<UMat> & lowResMotions = *(std::vector<UMat> *)_lowResMotions.getObj(),
-                & highResMotions = *(std::vector<UMat> *)_highResMotions.getObj();
-
-        highResMotions.resize(lowResMotions.size());
-
-        for (size_t i = 0; i < lowResMotions.size(); ++i)
-        {
-            resize(lowResMotions[i], highResMotions[i], Size(), scale, scale, INTER_LINEAR); // TODO
-            multiply(highResMotions[i], Scalar::all(scale), highResMotions[i]);
-        }
-
-        return true;
-    }
-
-#endif
-
-    void upscaleMotions(InputArrayOfArrays _lowResMotions, OutputArrayOfArrays _highResMotions, int scale)
-    {
-        CV_OCL_RUN(_lowResMotions.isUMatVector() && _highResMotions.isUMatVector(),
-                   ocl_upscaleMotions(_lowResMotions, _highResMotions, scale))
-
-        std::vector<Mat> & lowResMotions = *(std::vector<Mat> *)_lowResMotions.getObj(),
-                & highResMotions = *(std::vector<Mat> *)_highResMotions.getObj();
-
-        highResMotions.resize(lowResMotions.size());
-
-        for (size_t i = 0; i < lowResMotions.size(); ++i)
-        {
-            resize(lowResMotions[i], highResMotions[i], Size(), scale, scale, INTER_CUBIC);
-            multiply(highResMotions[i], Scalar::all(scale), highResMotions[i]);
-        }
-    }
-
-#ifdef HAVE_OPENCL
-
-    bool ocl_buildMotionMaps(InputArray _forwardMotion, InputArray _backwardMotion,
-                             OutputArray _forwardMap, OutputArray _backwardMap)
-    {
-        ocl::Kernel k("buildMotionMaps", ocl::superres::superres_btvl1_oclsrc);
-        if (k.empty())
-            return false;
-
-        UMat forwardMotion = _forwardMotion.getUMat(), backwardMotion = _backwardMotion.getUMat();
-        Size size = forwardMotion.size();
-
-        _forwardMap.create(size, CV_32FC2);
-        _backwardMap.create(size, CV_32FC2);
-
-        UMat forwardMap = _forwardMap.getUMat(), backwardMap = _backwardMap.getUMat();
-
-        k.args(ocl::KernelArg::ReadOnlyNoSize(forwardMotion),
-               ocl::KernelArg::ReadOnlyNoSize(backwardMotion),
-               ocl::KernelArg::WriteOnlyNoSize(forwardMap),
-               ocl::KernelArg::WriteOnly(backwardMap));
-
-        size_t globalsize[2] = { (size_t)size.width, (size_t)size.height };
-        return k.run(2, globalsize, NULL, false);
-    }
-
-#endif
-
-    void buildMotionMaps(InputArray _forwardMotion, InputArray _backwardMotion,
-                         OutputArray _forwardMap, OutputArray _backwardMap)
-    {
-        CV_OCL_RUN(_forwardMap.isUMat() && _backwardMap.isUMat(),
-                   ocl_buildMotionMaps(_forwardMotion, _backwardMotion, _forwardMap,
-                                       _backwardMap));
-
-        Mat forwardMotion = _forwardMotion.getMat(), backwardMotion = _backwardMotion.getMat();
-
-        _forwardMap.create(forwardMotion.size(), CV_32FC2);
-        _backwardMap.create(forwardMotion.size(), CV_32FC2);
-
-        Mat forwardMap = _forwardMap.getMat(), backwardMap = _backwardMap.getMat();
-
-        for (int y = 0; y < forwardMotion.rows; ++y)
-        {
-            const Point2f* forwardMotionRow = forwardMotion.ptr<Point2f>(y);
-            const Point2f* backwardMotionRow = backwardMotion.ptr<Point2f>(y);
-            Point2f* forwardMapRow = forwardMap.ptr<Point2f>(y);
-            Point2f* backwardMapRow = backwardMap.ptr<Point2f>(y);
-
-            for (int x = 0; x < forwardMotion.cols; ++x)
-            {
-                Point2f base(static_cast<float>(x), static_cast<float>(y));
-
-                forwardMapRow[x] = base + backwardMotionRow[x];
-                backwardMapRow[x] = base + forwardMotionRow[x];
-            }
+            add(backwardMaps[i - 1], backwardMotions[i], backwardMaps[i]);
+            add(forwardMaps[i - 1], forwardMotions[i - 1], forwardMaps[i]);
         }
     }
 
@@ -462,11 +345,101 @@ namespace
         }
     }
 
+    // dst = src + tau * (diffTerm - lambda * BTV(src)) in a single pass, the regularization
+    // being zero on the borders as in calcBtvRegularization
+    template <typename T>
+    struct BtvUpdateBody : ParallelLoopBody
+    {
+        void operator ()(const Range& range) const CV_OVERRIDE;
+
+        Mat src;
+        Mat diffTerm;
+        mutable Mat dst;
+        int ksize;
+        const float* btvWeights;
+        float tau;
+        float lambda;
+    };
+
+    template <typename T>
+    void BtvUpdateBody<T>::operator ()(const Range& range) const
+    {
+        for (int i = range.start; i < range.end; ++i)
+        {
+            const T * const srcRow = src.ptr<T>(i);
+            const T * const diffRow = diffTerm.ptr<T>(i);
+            T * const dstRow = dst.ptr<T>(i);
+
+            const bool inner = i >= ksize && i < src.rows - ksize;
+            const int innerEnd = inner ? src.cols - ksize : ksize;
+
+            for (int j = 0; j < src.cols; ++j)
+            {
+                T reg = T();
+
+                if (j >= ksize && j < innerEnd)
+                {
+                    const T srcVal = srcRow[j];
+
+                    for (int m = 0, ind = 0; m <= ksize; ++m)
+                    {
+                        const T* srcRow2 = src.ptr<T>(i - m);
+                        const T* srcRow3 = src.ptr<T>(i + m);
+
+                        for (int l = ksize; l + m >= 0; --l, ++ind)
+                            reg += btvWeights[ind] * (diffSign(srcVal, srcRow3[j + l])
+                                                      - diffSign(srcRow2[j - l], srcVal));
+                    }
+                }
+
+                dstRow[j] = srcRow[j] + (diffRow[j] - reg * lambda) * tau;
+            }
+        }
+    }
+
+    template <typename T>
+    void calcBtvUpdateImpl(const Mat& src, const Mat& diffTerm, Mat& dst, int btvKernelSize,
+                           const std::vector<float>& btvWeights, double tau, double lambda)
+    {
+        dst.create(src.size(), src.type());
+
+        BtvUpdateBody<T> body;
+
+        body.src = src;
+        body.diffTerm = diffTerm;
+        body.dst = dst;
+        body.ksize = (btvKernelSize - 1) / 2;
+        body.btvWeights = &btvWeights[0];
+        body.tau = static_cast<float>(tau);
+        body.lambda = static_cast<float>(lambda);
+
+        parallel_for_(Range(0, src.rows), body);
+    }
+
+    void calcBtvUpdate(const Mat& src, const Mat& diffTerm, Mat& dst, int btvKernelSize,
+                       const std::vector<float>& btvWeights, double tau, double lambda)
+    {
+        if (src.channels() == 1)
+        {
+            calcBtvUpdateImpl<float>(src, diffTerm, dst, btvKernelSize, btvWeights, tau, lambda);
+        }
+        else if (src.channels() == 3)
+        {
+            calcBtvUpdateImpl<Point3f>(src, diffTerm, dst, btvKernelSize, btvWeights, tau, lambda);
+        }
+        else
+        {
+            CV_Error(Error::StsBadArg, "Unsupported number of channels in src");
+        }
+    }
+
     class BTVL1_Base : public cv::superres::SuperResolution
     {
     public:
         BTVL1_Base();
 
+        // forwardMotions and backwardMotions are the flows between consecutive frames of src,
+        // already upscaled to the output resolution
         void process(InputArrayOfArrays src, OutputArray dst, InputArrayOfArrays forwardMotions,
                      InputArrayOfArrays backwardMotions, int baseIdx);
 
@@ -521,27 +494,19 @@ namespace
         double curAlpha_;
 
         // Mat
-        std::vector<Mat> lowResForwardMotions_;
-        std::vector<Mat> lowResBackwardMotions_;
-
-        std::vector<Mat> highResForwardMotions_;
-        std::vector<Mat> highResBackwardMotions_;
+        Mat identityMap_;
 
         std::vector<Mat> forwardMaps_;
         std::vector<Mat> backwardMaps_;
 
-        Mat highRes_;
+        Mat highRes_, nextHighRes_;
 
-        Mat diffTerm_, regTerm_;
+        Mat diffTerm_;
         Mat a_, b_, c_;
 
 #ifdef HAVE_OPENCL
         // UMat
-        std::vector<UMat> ulowResForwardMotions_;
-        std::vector<UMat> ulowResBackwardMotions_;
-
-        std::vector<UMat> uhighResForwardMotions_;
-        std::vector<UMat> uhighResBackwardMotions_;
+        UMat uidentityMap_;
 
         std::vector<UMat> uforwardMaps_;
         std::vector<UMat> ubackwardMaps_;
@@ -601,21 +566,16 @@ namespace
             curAlpha_ = alpha_;
         }
 
-        // calc high res motions
-        calcRelativeMotions(forwardMotions, backwardMotions, ulowResForwardMotions_, ulowResBackwardMotions_, baseIdx, src[0].size());
-
-        upscaleMotions(ulowResForwardMotions_, uhighResForwardMotions_, scale_);
-        upscaleMotions(ulowResBackwardMotions_, uhighResBackwardMotions_, scale_);
-
-        uforwardMaps_.resize(uhighResForwardMotions_.size());
-        ubackwardMaps_.resize(uhighResForwardMotions_.size());
-        for (size_t i = 0; i < uhighResForwardMotions_.size(); ++i)
-            buildMotionMaps(uhighResForwardMotions_[i], uhighResBackwardMotions_[i], uforwardMaps_[i], ubackwardMaps_[i]);
-
         // initial estimation
         const Size lowResSize = src[0].size();
         const Size highResSize(lowResSize.width * scale_, lowResSize.height * scale_);
 
+        // motion maps
+        if (uidentityMap_.size() != highResSize)
+            buildIdentityMap(highResSize, uidentityMap_);
+
+        buildMotionMaps(forwardMotions, backwardMotions, uidentityMap_, baseIdx, uforwardMaps_, ubackwardMaps_);
+
         resize(src[baseIdx], uhighRes_, highResSize, 0, 0, INTER_LINEAR); // TODO
 
         // iterations
@@ -704,21 +664,16 @@ namespace
             curAlpha_ = alpha_;
         }
 
-        // calc high res motions
-        calcRelativeMotions(forwardMotions, backwardMotions, lowResForwardMotions_, lowResBackwardMotions_, baseIdx, src[0].size());
-
-        upscaleMotions(lowResForwardMotions_, highResForwardMotions_, scale_);
-        upscaleMotions(lowResBackwardMotions_, highResBackwardMotions_, scale_);
-
-        forwardMaps_.resize(highResForwardMotions_.size());
-        backwardMaps_.resize(highResForwardMotions_.size());
-        for (size_t i = 0; i < highResForwardMotions_.size(); ++i)
-            buildMotionMaps(highResForwardMotions_[i], highResBackwardMotions_[i], forwardMaps_[i], backwardMaps_[i]);
-
         // initial estimation
         const Size lowResSize = src[0].size();
         const Size highResSize(lowResSize.width * scale_, lowResSize.height * scale_);
 
+        // motion maps
+        if (identityMap_.size() != highResSize)
+            buildIdentityMap(highResSize, identityMap_);
+
+        buildMotionMaps(forwardMotions, backwardMotions, identityMap_, baseIdx, forwardMaps_, backwardMaps_);
+
         resize(src[baseIdx], highRes_, highResSize, 0, 0, INTER_CUBIC);
 
         // iterations
@@ -754,11 +709,11 @@ namespace
 
             if (lambda_ > 0)
             {
-                calcBtvRegularization(highRes_, regTerm_, btvKernelSize_, btvWeights_, ubtvWeights_);
-                addWeighted(diffTerm_, 1.0, regTerm_, -lambda_, 0.0, diffTerm_);
+                calcBtvUpdate(highRes_, diffTerm_, nextHighRes_, btvKernelSize_, btvWeights_, tau_, lambda_);
+                std::swap(highRes_, nextHighRes_);
             }
-
-            addWeighted(highRes_, 1.0, diffTerm_, tau_, 0.0, highRes_);
+            else
+                addWeighted(highRes_, 1.0, diffTerm_, tau_, 0.0, highRes_);
         }
 
         Rect inner(btvKernelSize_, btvKernelSize_, highRes_.cols - 2 * btvKernelSize_, highRes_.rows - 2 * btvKernelSize_);
@@ -768,30 +723,22 @@ namespace
     void BTVL1_Base::collectGarbage()
     {
         // Mat
-        lowResForwardMotions_.clear();
-        lowResBackwardMotions_.clear();
-
-        highResForwardMotions_.clear();
-        highResBackwardMotions_.clear();
+        identityMap_.release();
 
         forwardMaps_.clear();
         backwardMaps_.clear();
 
         highRes_.release();
+        nextHighRes_.release();
 
         diffTerm_.release();
-        regTerm_.release();
         a_.release();
         b_.release();
         c_.release();
 
 #ifdef HAVE_OPENCL
         // UMat
-        ulowResForwardMotions_.clear();
-        ulowResBackwardMotions_.clear();
-
-        uhighResForwardMotions_.clear();
-        uhighResBackwardMotions_.clear();
+        uidentityMap_.release();
 
         uforwardMaps_.clear();
         ubackwardMaps_.clear();
@@ -829,6 +776,9 @@ namespace
         void processFrame(int idx);
         bool ocl_processFrame(int idx);
 
+        template <typename MatT>
+        const MatT& highResMotion(const MatT& lowRes, MatT& highRes) const;
+
         int storePos_;
         int procPos_;
         int outPos_;
@@ -840,6 +790,8 @@ namespace
         std::vector<Mat> frames_;
         std::vector<Mat> forwardMotions_;
         std::vector<Mat> backwardMotions_;
+        std::vector<Mat> highResForwardMotions_;
+        std::vector<Mat> highResBackwardMotions_;
         std::vector<Mat> outputs_;
 
         std::vector<Mat> srcFrames_;
@@ -855,6 +807,8 @@ namespace
         std::vector<UMat> uframes_;
         std::vector<UMat> uforwardMotions_;
         std::vector<UMat> ubackwardMotions_;
+        std::vector<UMat> uhighResForwardMotions_;
+        std::vector<UMat> uhighResBackwardMotions_;
         std::vector<UMat> uoutputs_;
 
         std::vector<UMat> usrcFrames_;
@@ -880,6 +834,8 @@ namespace
         frames_.clear();
         forwardMotions_.clear();
         backwardMotions_.clear();
+        highResForwardMotions_.clear();
+        highResBackwardMotions_.clear();
         outputs_.clear();
 
         srcFrames_.clear();
@@ -895,6 +851,8 @@ namespace
         uframes_.clear();
         uforwardMotions_.clear();
         ubackwardMotions_.clear();
+        uhighResForwardMotions_.clear();
+        uhighResBackwardMotions_.clear();
         uoutputs_.clear();
 
         usrcFrames_.clear();
@@ -915,6 +873,8 @@ namespace
         uframes_.resize(cacheSize);
         uforwardMotions_.resize(cacheSize);
         ubackwardMotions_.resize(cacheSize);
+        uhighResForwardMotions_.resize(cacheSize);
+        uhighResBackwardMotions_.resize(cacheSize);
         uoutputs_.resize(cacheSize);
 
         storePos_ = -1;
@@ -940,6 +900,8 @@ namespace
         frames_.resize(cacheSize);
         forwardMotions_.resize(cacheSize);
         backwardMotions_.resize(cacheSize);
+        highResForwardMotions_.resize(cacheSize);
+        highResBackwardMotions_.resize(cacheSize);
         outputs_.resize(cacheSize);
 
         CV_OCL_RUN(isUmat_,
@@ -1012,6 +974,10 @@ namespace
         {
             opticalFlow_->calc(uprevFrame_, ucurFrame_, at(storePos_ - 1, uforwardMotions_));
             opticalFlow_->calc(ucurFrame_, uprevFrame_, at(storePos_, ubackwardMotions_));
+
+            // every pair is upscaled once and reused by all the windows containing it
+            upscaleMotion(at(storePos_ - 1, uforwardMotions_), at(storePos_ - 1, uhighResForwardMotions_), scale_);
+            upscaleMotion(at(storePos_, ubackwardMotions_), at(storePos_, uhighResBackwardMotions_), scale_);
         }
 
         ucurFrame_.copyTo(uprevFrame_);
@@ -1043,11 +1009,25 @@ namespace
         {
             opticalFlow_->calc(prevFrame_, curFrame_, at(storePos_ - 1, forwardMotions_));
             opticalFlow_->calc(curFrame_, prevFrame_, at(storePos_, backwardMotions_));
+
+            // every pair is upscaled once and reused by all the windows containing it
+            upscaleMotion(at(storePos_ - 1, forwardMotions_), at(storePos_ - 1, highResForwardMotions_), scale_);
+            upscaleMotion(at(storePos_, backwardMotions_), at(storePos_, highResBackwardMotions_), scale_);
         }
 
         curFrame_.copyTo(prevFrame_);
     }
 
+    template <typename MatT>
+    const MatT& BTVL1::highResMotion(const MatT& lowRes, MatT& highRes) const
+    {
+        // the scale may have been changed after the pair was read
+        if (highRes.size() != Size(lowRes.cols * scale_, lowRes.rows * scale_))
+            upscaleMotion(lowRes, highRes, scale_);
+
+        return highRes;
+    }
+
 #ifdef HAVE_OPENCL
 
     bool BTVL1::ocl_processFrame(int idx)
@@ -1072,9 +1052,9 @@ namespace
             usrcFrames_[k] = at(i, uframes_);
 
             if (i < endIdx)
-                usrcForwardMotions_[k] = at(i, uforwardMotions_);
+                usrcForwardMotions_[k] = highResMotion(at(i, uforwardMotions_), at(i, uhighResForwardMotions_));
             if (i > startIdx)
-                usrcBackwardMotions_[k] = at(i, ubackwardMotions_);
+                usrcBackwardMotions_[k] = highResMotion(at(i, ubackwardMotions_), at(i, uhighResBackwardMotions_));
         }
 
         process(usrcFrames_, at(idx, uoutputs_), usrcForwardMotions_, usrcBackwardMotions_, baseIdx);
@@ -1111,9 +1091,9 @@ namespace
             srcFrames_[k] = at(i, frames_);
 
             if (i < endIdx)
-                srcForwardMotions_[k] = at(i, forwardMotions_);
+                srcForwardMotions_[k] = highResMotion(at(i, forwardMotions_), at(i, highResForwardMotions_));
             if (i > startIdx)
-                srcBackwardMotions_[k] = at(i, backwardMotions_);
+                srcBackwardMotions_[k] = highResMotion(at(i, backwardMotions_), at(i, highResBackwardMotions_));
         }
 
         process(srcFrames_, at(idx, outputs_), srcForwardMotions_, srcBackwardMotions_, baseIdx);
@@ -61,86 +61,80 @@ Ptr<SuperResolution> cv::superres::createSuperResolution_BTVL1_CUDA()
 
 namespace btv_l1_cudev
 {
-    void buildMotionMaps(PtrStepSzf forwardMotionX, PtrStepSzf forwardMotionY,
-                         PtrStepSzf backwardMotionX, PtrStepSzf bacwardMotionY,
-                         PtrStepSzf forwardMapX, PtrStepSzf forwardMapY,
-                         PtrStepSzf backwardMapX, PtrStepSzf backwardMapY);
-
     template <int cn>
     void upscale(const PtrStepSzb src, PtrStepSzb dst, int scale, cudaStream_t stream);
 
     void diffSign(PtrStepSzf src1, PtrStepSzf src2, PtrStepSzf dst, cudaStream_t stream);
 
     void loadBtvWeights(const float* weights, size_t count);
-    template <int cn> void calcBtvRegularization(PtrStepSzb src, PtrStepSzb dst, int ksize);
+    template <int cn> void calcBtvUpdate(PtrStepSzb src, PtrStepSzb dst, int ksize, float weight, cudaStream_t stream);
 }
 
 namespace
 {
-    void calcRelativeMotions(const std::vector<std::pair<GpuMat, GpuMat> >& forwardMotions, const std::vector<std::pair<GpuMat, GpuMat> >& backwardMotions,
-                             std::vector<std::pair<GpuMat, GpuMat> >& relForwardMotions, std::vector<std::pair<GpuMat, GpuMat> >& relBackwardMotions,
-                             int baseIdx, Size size)
+    void upscaleMotion(const std::pair<GpuMat, GpuMat>& lowResMotion, std::pair<GpuMat, GpuMat>& highResMotion, int scale)
     {
-        const int count = static_cast<int>(forwardMotions.size());
+        cuda::resize(lowResMotion.first, highResMotion.first, Size(), scale, scale, INTER_CUBIC);
+        cuda::resize(lowResMotion.second, highResMotion.second, Size(), scale, scale, INTER_CUBIC);
 
-        relForwardMotions.resize(count);
-        relForwardMotions[baseIdx].first.create(size, CV_32FC1);
-        relForwardMotions[baseIdx].first.setTo(Scalar::all(0));
-        relForwardMotions[baseIdx].second.create(size, CV_32FC1);
-        relForwardMotions[baseIdx].second.setTo(Scalar::all(0));
+        cuda::multiply(highResMotion.first, Scalar::all(scale), highResMotion.first);
+        cuda::multiply(highResMotion.second, Scalar::all(scale), highResMotion.second);
+    }
 
-        relBackwardMotions.resize(count);
-        relBackwardMotions[baseIdx].first.create(size, CV_32FC1);
-        relBackwardMotions[baseIdx].first.setTo(Scalar::all(0));
-        relBackwardMotions[baseIdx].second.create(size, CV_32FC1);
-        relBackwardMotions[baseIdx].second.setTo(Scalar::all(0));
+    void buildIdentityMap(Size size, std::pair<GpuMat, GpuMat>& map)
+    {
+        Mat mapX(size, CV_32FC1), mapY(size, CV_32FC1);
 
-        for (int i = baseIdx - 1; i >= 0; --i)
+        for (int y = 0; y < size.height; ++y)
         {
-            cuda::add(relForwardMotions[i + 1].first, forwardMotions[i].first, relForwardMotions[i].first);
-            cuda::add(relForwardMotions[i + 1].second, forwardMotions[i].second, relForwardMotions[i].second);
+            float* mapXRow = mapX.ptr<float>(y);
+            float* mapYRow = mapY.ptr<float>(y);
 
-            cuda::add(relBackwardMotions[i + 1].first, backwardMotions[i + 1].first, relBackwardMotions[i].first);
-            cuda::add(relBackwardMotions[i + 1].second, backwardMotions[i + 1].second, relBackwardMotions[i].second);
+            for (int x = 0; x < size.width; ++x)
+            {
+                mapXRow[x] = static_cast<float>(x);
+                mapYRow[x] = static_cast<float>(y);
+            }
         }
 
-        for (int i = baseIdx + 1; i < count; ++i)
-        {
-            cuda::add(relForwardMotions[i - 1].first, backwardMotions[i].first, relForwardMotions[i].first);
-            cuda::add(relForwardMotions[i - 1].second, backwardMotions[i].second, relForwardMotions[i].second);
-
-            cuda::add(relBackwardMotions[i - 1].first, forwardMotions[i - 1].first, relBackwardMotions[i].first);
-            cuda::add(relBackwardMotions[i - 1].second, forwardMotions[i - 1].second, relBackwardMotions[i].second);
-        }
+        map.first.upload(mapX);
+        map.second.upload(mapY);
     }
 
-    void upscaleMotions(const std::vector<std::pair<GpuMat, GpuMat> >& lowResMotions, std::vector<std::pair<GpuMat, GpuMat> >& highResMotions, int scale)
+    void addMotion(const std::pair<GpuMat, GpuMat>& map, const std::pair<GpuMat, GpuMat>& motion, std::pair<GpuMat, GpuMat>& dst)
     {
-        highResMotions.resize(lowResMotions.size());
-
-        for (size_t i = 0; i < lowResMotions.size(); ++i)
-        {
-            cuda::resize(lowResMotions[i].first, highResMotions[i].first, Size(), scale, scale, INTER_CUBIC);
-            cuda::resize(lowResMotions[i].second, highResMotions[i].second, Size(), scale, scale, INTER_CUBIC);
-
-            cuda::multiply(highResMotions[i].first, Scalar::all(scale), highResMotions[i].first);
-            cuda::multiply(highResMotions[i].second, Scalar::all(scale), highResMotions[i].second);
-        }
+        cuda::add(map.first, motion.first, dst.first);
+        cuda::add(map.second, motion.second, dst.second);
     }
 
-    void buildMotionMaps(const std::pair<GpuMat, GpuMat>& forwardMotion, const std::pair<GpuMat, GpuMat>& backwardMotion,
-                         std::pair<GpuMat, GpuMat>& forwardMap, std::pair<GpuMat, GpuMat>& backwardMap)
+    // Builds the remap tables of every frame of the window from the upscaled flows of the
+    // consecutive pairs: the map of a frame is the one of its neighbour towards the base frame
+    // plus the flow between them, so the relative motions are never stored.
+    void buildMotionMaps(const std::vector<std::pair<GpuMat, GpuMat> >& forwardMotions, const std::vector<std::pair<GpuMat, GpuMat> >& backwardMotions,
+                         const std::pair<GpuMat, GpuMat>& identityMap, int baseIdx,
+                         std::vector<std::pair<GpuMat, GpuMat> >& forwardMaps, std::vector<std::pair<GpuMat, GpuMat> >& backwardMaps)
     {
-        forwardMap.first.create(forwardMotion.first.size(), CV_32FC1);
-        forwardMap.second.create(forwardMotion.first.size(), CV_32FC1);
+        const int count = static_cast<int>(forwardMotions.size());
+
+        forwardMaps.resize(count);
+        backwardMaps.resize(count);
+
+        identityMap.first.copyTo(forwardMaps[baseIdx].first);
+        identityMap.second.copyTo(forwardMaps[baseIdx].second);
+        identityMap.first.copyTo(backwardMaps[baseIdx].first);
+        identityMap.second.copyTo(backwardMaps[baseIdx].second);
 
-        backwardMap.first.create(forwardMotion.first.size(), CV_32FC1);
-        backwardMap.second.create(forwardMotion.first.size(), CV_32FC1);
+        for (int i = baseIdx - 1; i >= 0; --i)
+        {
+            addMotion(backwardMaps[i + 1], forwardMotions[i], backwardMaps[i]);
+            addMotion(forwardMaps[i + 1], backwardMotions[i + 1], forwardMaps[i]);
+        }
 
-        btv_l1_cudev::buildMotionMaps(forwardMotion.first, forwardMotion.second,
-                                       backwardMotion.first, backwardMotion.second,
-                                       forwardMap.first, forwardMap.second,
-                                       backwardMap.first, backwardMap.second);
+        for (int i = baseIdx + 1; i < count; ++i)
+        {
+            addMotion(backwardMaps[i - 1], backwardMotions[i], backwardMaps[i]);
+            addMotion(forwardMaps[i - 1], forwardMotions[i - 1], forwardMaps[i]);
+        }
     }
 
     void upscale(const GpuMat& src, GpuMat& dst, int scale, Stream& stream)
@@ -154,7 +148,7 @@ namespace
         CV_Assert( src.channels() == 1 || src.channels() == 3 || src.channels() == 4 );
 
         dst.create(src.rows * scale, src.cols * scale, src.type());
-        dst.setTo(Scalar::all(0));
+        dst.setTo(Scalar::all(0), stream);
 
         const func_t func = funcs[src.channels()];
 
@@ -186,24 +180,24 @@ namespace
         btv_l1_cudev::loadBtvWeights(&btvWeights[0], size);
     }
 
-    void calcBtvRegularization(const GpuMat& src, GpuMat& dst, int btvKernelSize)
+    // dst = src + weight * BTV(src), the regularization being zero on the borders
+    void calcBtvUpdate(const GpuMat& src, GpuMat& dst, int btvKernelSize, double weight, Stream& stream)
     {
-        typedef void (*func_t)(PtrStepSzb src, PtrStepSzb dst, int ksize);
+        typedef void (*func_t)(PtrStepSzb src, PtrStepSzb dst, int ksize, float weight, cudaStream_t stream);
         static const func_t funcs[] =
         {
             0,
-            btv_l1_cudev::calcBtvRegularization<1>,
+            btv_l1_cudev::calcBtvUpdate<1>,
             0,
-            btv_l1_cudev::calcBtvRegularization<3>,
-            btv_l1_cudev::calcBtvRegularization<4>
+            btv_l1_cudev::calcBtvUpdate<3>,
+            btv_l1_cudev::calcBtvUpdate<4>
         };
 
         dst.create(src.size(), src.type());
-        dst.setTo(Scalar::all(0));
 
         const int ksize = (btvKernelSize - 1) / 2;
 
-        funcs[src.channels()](src, dst, ksize);
+        funcs[src.channels()](src, dst, ksize, static_cast<float>(weight), StreamAccessor::getStream(stream));
     }
 
     class BTVL1_CUDA_Base : public cv::superres::SuperResolution
@@ -260,21 +254,17 @@ namespace
         int curBtvKernelSize_;
         double curAlpha_;
 
-        std::vector<std::pair<GpuMat, GpuMat> > lowResForwardMotions_;
-        std::vector<std::pair<GpuMat, GpuMat> > lowResBackwardMotions_;
-
-        std::vector<std::pair<GpuMat, GpuMat> > highResForwardMotions_;
-        std::vector<std::pair<GpuMat, GpuMat> > highResBackwardMotions_;
+        std::pair<GpuMat, GpuMat> identityMap_;
 
         std::vector<std::pair<GpuMat, GpuMat> > forwardMaps_;
         std::vector<std::pair<GpuMat, GpuMat> > backwardMaps_;
 
-        GpuMat highRes_;
+        GpuMat highRes_, nextHighRes_;
 
         std::vector<Stream> streams_;
         std::vector<GpuMat> diffTerms_;
         std::vector<GpuMat> a_, b_, c_;
-        GpuMat regTerm_;
+        Stream btvStream_;
     };
 
     BTVL1_CUDA_Base::BTVL1_CUDA_Base()
@@ -334,23 +324,18 @@ namespace
             curAlpha_ = alpha_;
         }
 
-        // calc motions between input frames
-
-        calcRelativeMotions(forwardMotions, backwardMotions, lowResForwardMotions_, lowResBackwardMotions_, baseIdx, src[0].size());
-
-        upscaleMotions(lowResForwardMotions_, highResForwardMotions_, scale_);
-        upscaleMotions(lowResBackwardMotions_, highResBackwardMotions_, scale_);
-
-        forwardMaps_.resize(highResForwardMotions_.size());
-        backwardMaps_.resize(highResForwardMotions_.size());
-        for (size_t i = 0; i < highResForwardMotions_.size(); ++i)
-            buildMotionMaps(highResForwardMotions_[i], highResBackwardMotions_[i], forwardMaps_[i], backwardMaps_[i]);
-
         // initial estimation
 
         const Size lowResSize = src[0].size();
         const Size highResSize(lowResSize.width * scale_, lowResSize.height * scale_);
 
+        // motion maps
+
+        if (identityMap_.first.size() != highResSize)
+            buildIdentityMap(highResSize, identityMap_);
+
+        buildMotionMaps(forwardMotions, backwardMotions, identityMap_, baseIdx, forwardMaps_, backwardMaps_);
+
         cuda::resize(src[baseIdx], highRes_, highResSize, 0, 0, INTER_CUBIC);
 
         // iterations
@@ -382,10 +367,13 @@ namespace
                 cuda::remap(b_[k], diffTerms_[k], forwardMaps_[k].first, forwardMaps_[k].second, INTER_NEAREST, BORDER_REPLICATE, Scalar(), streams_[k]);
             }
 
+            // the regularization only reads the current estimation, so it runs concurrently
+            // with the data terms and writes the next estimation directly
             if (lambda_ > 0)
             {
-                calcBtvRegularization(highRes_, regTerm_, btvKernelSize_);
-                cuda::addWeighted(highRes_, 1.0, regTerm_, -tau_ * lambda_, 0.0, highRes_);
+                calcBtvUpdate(highRes_, nextHighRes_, btvKernelSize_, -tau_ * lambda_, btvStream_);
+                btvStream_.waitForCompletion();
+                highRes_.swap(nextHighRes_);
             }
 
             for (size_t k = 0; k < src.size(); ++k)
@@ -403,22 +391,19 @@ namespace
     {
         filters_.clear();
 
-        lowResForwardMotions_.clear();
-        lowResBackwardMotions_.clear();
-
-        highResForwardMotions_.clear();
-        highResBackwardMotions_.clear();
+        identityMap_.first.release();
+        identityMap_.second.release();
 
         forwardMaps_.clear();
         backwardMaps_.clear();
 
         highRes_.release();
+        nextHighRes_.release();
 
         diffTerms_.clear();
         a_.clear();
         b_.clear();
         c_.clear();
-        regTerm_.release();
     }
 
 ////////////////////////////////////////////////////////////
@@ -438,12 +423,16 @@ namespace
         void readNextFrame(Ptr<FrameSource>& frameSource);
         void processFrame(int idx);
 
+        const std::pair<GpuMat, GpuMat>& highResMotion(const std::pair<GpuMat, GpuMat>& lowRes, std::pair<GpuMat, GpuMat>& highRes) const;
+
         GpuMat curFrame_;
         GpuMat prevFrame_;
 
         std::vector<GpuMat> frames_;
         std::vector<std::pair<GpuMat, GpuMat> > forwardMotions_;
         std::vector<std::pair<GpuMat, GpuMat> > backwardMotions_;
+        std::vector<std::pair<GpuMat, GpuMat> > highResForwardMotions_;
+        std::vector<std::pair<GpuMat, GpuMat> > highResBackwardMotions_;
         std::vector<GpuMat> outputs_;
 
         int storePos_;
@@ -469,6 +458,8 @@ namespace
         frames_.clear();
         forwardMotions_.clear();
         backwardMotions_.clear();
+        highResForwardMotions_.clear();
+        highResBackwardMotions_.clear();
         outputs_.clear();
 
         srcFrames_.clear();
@@ -487,6 +478,8 @@ namespace
         frames_.resize(cacheSize);
         forwardMotions_.resize(cacheSize);
         backwardMotions_.resize(cacheSize);
+        highResForwardMotions_.resize(cacheSize);
+        highResBackwardMotions_.resize(cacheSize);
         outputs_.resize(cacheSize);
 
         storePos_ = -1;
@@ -546,11 +539,24 @@ namespace
 
             opticalFlow_->calc(prevFrame_, curFrame_, forwardMotion.first, forwardMotion.second);
             opticalFlow_->calc(curFrame_, prevFrame_, backwardMotion.first, backwardMotion.second);
+
+            // every pair is upscaled once and reused by all the windows containing it
+            upscaleMotion(forwardMotion, at(storePos_ - 1, highResForwardMotions_), scale_);
+            upscaleMotion(backwardMotion, at(storePos_, highResBackwardMotions_), scale_);
         }
 
         curFrame_.copyTo(prevFrame_);
     }
 
+    const std::pair<GpuMat, GpuMat>& BTVL1_CUDA::highResMotion(const std::pair<GpuMat, GpuMat>& lowRes, std::pair<GpuMat, GpuMat>& highRes) const
+    {
+        // the scale may have been changed after the pair was read
+        if (highRes.first.size() != Size(lowRes.first.cols * scale_, lowRes.first.rows * scale_))
+            upscaleMotion(lowRes, highRes, scale_);
+
+        return highRes;
+    }
+
     void BTVL1_CUDA::processFrame(int idx)
     {
         const int startIdx = std::max(idx - temporalAreaRadius_, 0);
@@ -573,9 +579,9 @@ namespace
             srcFrames_[k] = at(i, frames_);
 
             if (i < endIdx)
-                srcForwardMotions_[k] = at(i, forwardMotions_);
+                srcForwardMotions_[k] = highResMotion(at(i, forwardMotions_), at(i, highResForwardMotions_));
             if (i > startIdx)
-                srcBackwardMotions_[k] = at(i, backwardMotions_);
+                srcBackwardMotions_[k] = highResMotion(at(i, backwardMotions_), at(i, highResBackwardMotions_));
         }
 
         process(srcFrames_, at(idx, outputs_), srcForwardMotions_, srcBackwardMotions_, baseIdx);
@@ -54,63 +54,17 @@ using namespace cv::cuda::device;
 
 namespace btv_l1_cudev
 {
-    void buildMotionMaps(PtrStepSzf forwardMotionX, PtrStepSzf forwardMotionY,
-                         PtrStepSzf backwardMotionX, PtrStepSzf bacwardMotionY,
-                         PtrStepSzf forwardMapX, PtrStepSzf forwardMapY,
-                         PtrStepSzf backwardMapX, PtrStepSzf backwardMapY);
-
     template <int cn>
     void upscale(const PtrStepSzb src, PtrStepSzb dst, int scale, cudaStream_t stream);
 
     void diffSign(PtrStepSzf src1, PtrStepSzf src2, PtrStepSzf dst, cudaStream_t stream);
 
     void loadBtvWeights(const float* weights, size_t count);
-    template <int cn> void calcBtvRegularization(PtrStepSzb src, PtrStepSzb dst, int ksize);
+    template <int cn> void calcBtvUpdate(PtrStepSzb src, PtrStepSzb dst, int ksize, float weight, cudaStream_t stream);
 }
 
 namespace btv_l1_cudev
 {
-    __global__ void buildMotionMapsKernel(const PtrStepSzf forwardMotionX, const PtrStepf forwardMotionY,
-                                          PtrStepf backwardMotionX, PtrStepf backwardMotionY,
-                                          PtrStepf forwardMapX, PtrStepf forwardMapY,
-                                          PtrStepf backwardMapX, PtrStepf backwardMapY)
-    {
-        const int x = blockIdx.x * blockDim.x + threadIdx.x;
-        const int y = blockIdx.y * blockDim.y + threadIdx.y;
-
-        if (x >= forwardMotionX.cols || y >= forwardMotionX.rows)
-            return;
-
-        const float fx = forwardMotionX(y, x);
-        const float fy = forwardMotionY(y, x);
-
-        const float bx = backwardMotionX(y, x);
-        const float by = backwardMotionY(y, x);
-
-        forwardMapX(y, x) = x + bx;
-        forwardMapY(y, x) = y + by;
-
-        backwardMapX(y, x) = x + fx;
-        backwardMapY(y, x) = y + fy;
-    }
-
-    void buildMotionMaps(PtrStepSzf forwardMotionX, PtrStepSzf forwardMotionY,
-                         PtrStepSzf backwardMotionX, PtrStepSzf bacwardMotionY,
-                         PtrStepSzf forwardMapX, PtrStepSzf forwardMapY,
-                         PtrStepSzf backwardMapX, PtrStepSzf backwardMapY)
-    {
-        const dim3 block(32, 8);
-        const dim3 grid(divUp(forwardMapX.cols, block.x), divUp(forwardMapX.rows, block.y));
-
-        buildMotionMapsKernel<<<grid, block>>>(forwardMotionX, forwardMotionY,
-                                               backwardMotionX, bacwardMotionY,
-                                               forwardMapX, forwardMapY,
-                                               backwardMapX, backwardMapY);
-        cudaSafeCall( cudaGetLastError() );
-
-        cudaSafeCall( cudaDeviceSynchronize() );
-    }
-
     template <typename T>
     __global__ void upscaleKernel(const PtrStepSz<T> src, PtrStep<T> dst, const int scale)
     {
@@ -192,25 +146,31 @@ namespace btv_l1_cudev
     __constant__ float c_btvRegWeights[16*16];
 
     template <typename T>
-    __global__ void calcBtvRegularizationKernel(const PtrStepSz<T> src, PtrStep<T> dst, const int ksize)
+    __global__ void calcBtvUpdateKernel(const PtrStepSz<T> src, PtrStep<T> dst, const int ksize, const float weight)
     {
-        const int x = blockIdx.x * blockDim.x + threadIdx.x + ksize;
-        const int y = blockIdx.y * blockDim.y + threadIdx.y + ksize;
+        const int x = blockIdx.x * blockDim.x + threadIdx.x;
+        const int y = blockIdx.y * blockDim.y + threadIdx.y;
 
-        if (y >= src.rows - ksize || x >= src.cols - ksize)
+        if (y >= src.rows || x >= src.cols)
             return;
 
         const T srcVal = src(y, x);
 
-        T dstVal = VecTraits<T>::all(0);
+        if (y < ksize || y >= src.rows - ksize || x < ksize || x >= src.cols - ksize)
+        {
+            dst(y, x) = srcVal;
+            return;
+        }
+
+        T regVal = VecTraits<T>::all(0);
 
         for (int m = 0, count = 0; m <= ksize; ++m)
         {
             for (int l = ksize; l + m >= 0; --l, ++count)
-                dstVal = dstVal + c_btvRegWeights[count] * (diffSign(srcVal, src(y + m, x + l)) - diffSign(src(y - m, x - l), srcVal));
+                regVal = regVal + c_btvRegWeights[count] * (diffSign(srcVal, src(y + m, x + l)) - diffSign(src(y - m, x - l), srcVal));
         }
 
-        dst(y, x) = dstVal;
+        dst(y, x) = srcVal + weight * regVal;
     }
 
     void loadBtvWeights(const float* weights, size_t count)
@@ -219,22 +179,23 @@ namespace btv_l1_cudev
     }
 
     template <int cn>
-    void calcBtvRegularization(PtrStepSzb src, PtrStepSzb dst, int ksize)
+    void calcBtvUpdate(PtrStepSzb src, PtrStepSzb dst, int ksize, float weight, cudaStream_t stream)
     {
         typedef typename TypeVec<float, cn>::vec_type src_t;
 
         const dim3 block(32, 8);
         const dim3 grid(divUp(src.cols, block.x), divUp(src.rows, block.y));
 
-        calcBtvRegularizationKernel<src_t><<<grid, block>>>((PtrStepSz<src_t>) src, (PtrStepSz<src_t>) dst, ksize);
+        calcBtvUpdateKernel<src_t><<<grid, block, 0, stream>>>((PtrStepSz<src_t>) src, (PtrStepSz<src_t>) dst, ksize, weight);
         cudaSafeCall( cudaGetLastError() );
 
-        cudaSafeCall( cudaDeviceSynchronize() );
+        if (stream == 0)
+            cudaSafeCall( cudaDeviceSynchronize() );
     }
 
-    template void calcBtvRegularization<1>(PtrStepSzb src, PtrStepSzb dst, int ksize);
-    template void calcBtvRegularization<3>(PtrStepSzb src, PtrStepSzb dst, int ksize);
-    template void calcBtvRegularization<4>(PtrStepSzb src, PtrStepSzb dst, int ksize);
+    template void calcBtvUpdate<1>(PtrStepSzb src, PtrStepSzb dst, int ksize, float weight, cudaStream_t stream);
+    template void calcBtvUpdate<3>(PtrStepSzb src, PtrStepSzb dst, int ksize, float weight, cudaStream_t stream);
+    template void calcBtvUpdate<4>(PtrStepSzb src, PtrStepSzb dst, int ksize, float weight, cudaStream_t stream);
 }
 
 #endif
@@ -51,34 +51,6 @@
 #define src_elem_at(_src, y, step, x) *(__global const float *)(_src + mad24(y, step, (x) * sz))
 #define dst_elem_at(_dst, y, step, x) *(__global float *)(_dst + mad24(y, step, (x) * sz))
 
-__kernel void buildMotionMaps(__global const uchar * forwardMotionPtr, int forwardMotion_step, int forwardMotion_offset,
-                              __global const uchar * backwardMotionPtr, int backwardMotion_step, int backwardMotion_offset,
-                              __global const uchar * forwardMapPtr, int forwardMap_step, int forwardMap_offset,
-                              __global const uchar * backwardMapPtr, int backwardMap_step, int backwardMap_offset,
-                              int rows, int cols)
-{
-    int x = get_global_id(0);
-    int y = get_global_id(1);
-
-    if (x < cols && y < rows)
-    {
-        int forwardMotion_index = mad24(forwardMotion_step, y, (int)sizeof(float2) * x + forwardMotion_offset);
-        int backwardMotion_index = mad24(backwardMotion_step, y, (int)sizeof(float2) * x + backwardMotion_offset);
-        int forwardMap_index = mad24(forwardMap_step, y, (int)sizeof(float2) * x + forwardMap_offset);
-        int backwardMap_index = mad24(backwardMap_step, y, (int)sizeof(float2) * x + backwardMap_offset);
-
-        float2 forwardMotion = *(__global const float2 *)(forwardMotionPtr + forwardMotion_index);
-        float2 backwardMotion = *(__global const float2 *)(backwardMotionPtr + backwardMotion_index);
-        __global float2 * forwardMap = (__global float2 *)(forwardMapPtr + forwardMap_index);
-        __global float2 * backwardMap = (__global float2 *)(backwardMapPtr + backwardMap_index);
-
-        float2 basePoint = (float2)(x, y);
-
-        forwardMap[0] = basePoint + backwardMotion;
-        backwardMap[0] = basePoint + forwardMotion;
-    }
-}
-
 __kernel void upscale(__global const uchar * srcptr, int src_step, int src_offset, int src_rows, int src_cols,
                       __global uchar * dstptr, int dst_step, int dst_offset, int scale)
 {
@@ -151,7 +151,37 @@ public:
      */
   CV_WRAP int registerModelToScene(const Mat& srcPC, const Mat& dstPC, CV_IN_OUT std::vector<Pose3DPtr>& poses);
 
+  /**
+     *  \brief Set a static scene for the registrations without a dstPC argument
+     *
+     *  @param [in] dstPC The input point cloud for the scene with the normals (Nx6), CV_32F.
+     *
+     *  \details The search structures of the sampled scene are built on the first use for each
+     *  model size and then reused by all the following registrations against this scene.
+     */
+  CV_WRAP void setScene(const Mat& dstPC);
+
+  /**
+     *  \brief Perform registration against the scene given by setScene()
+     *  @see registerModelToScene(const Mat&, const Mat&, double&, Matx44d&)
+     */
+  int registerModelToScene(const Mat& srcPC, double& residual, Matx44d& pose);
+
+  /**
+     *  \brief Perform registration with multiple initial poses against the scene given by setScene().
+     *  The poses are refined in parallel.
+     *  @see registerModelToScene(const Mat&, const Mat&, std::vector<Pose3DPtr>&)
+     */
+  int registerModelToScene(const Mat& srcPC, std::vector<Pose3DPtr>& poses);
+
+  struct SceneIndex;
+
 private:
+  int registerModel(const Mat& srcPC, SceneIndex& scene, double& residual, Matx44d& pose) const;
+  void prepareScene(SceneIndex& scene, int numModelPoints) const;
+
+  Ptr<SceneIndex> m_scene;
+
   float m_tolerance;
   int m_maxIterations;
   float m_rejectionScale;
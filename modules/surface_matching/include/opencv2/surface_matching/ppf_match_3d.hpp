@@ -82,6 +82,66 @@ typedef struct THash
   int i, ppfInd;
 } THash;
 
+/**
+  * @brief Flat hash table of point pair features
+  *
+  * The entries are stored in one contiguous array grouped by their keys (CSR layout), and the keys
+  * are indexed by an open addressing table. A lookup costs one probe sequence and returns a
+  * contiguous range of entries, without any per-node allocations or pointer chasing.
+  */
+class CV_EXPORTS PPFHashTable
+{
+public:
+  PPFHashTable() : mask(0) {}
+
+  /**
+    * Builds the table from the entries, the id of each entry is used as its key.
+    * The entries are reordered and moved into the table.
+    */
+  void build(std::vector<THash>& entries);
+
+  /**
+    * Returns the entries with the given key.
+    * @param [in] key Key to search for
+    * @param [out] count Count of the entries
+    */
+  const THash* find(KeyType key, int& count) const;
+
+  /**
+    * Looks up several keys at once.
+    * @param [in] keys Keys to search for
+    * @param [in] n Count of the keys
+    * @param [out] first First entry for each key
+    * @param [out] counts Count of the entries for each key
+    */
+  void find(const KeyType* keys, int n, const THash** first, int* counts) const;
+
+  void clear();
+  bool empty() const { return entries.empty(); }
+  size_t size() const { return entries.size(); }
+  //! Memory held by the table in bytes
+  size_t memoryUsage() const;
+
+  //! Writes the entries and the index as they are laid out in memory, returns 0 on success
+  int write(FILE* f) const;
+  //! Reads a table written by write(), returns 0 on success
+  int read(FILE* f);
+
+  void write(FileStorage& fs) const;
+  void read(const FileNode& fn);
+
+private:
+  struct Slot
+  {
+    KeyType key;
+    int begin, count; //!< count is 0 for empty slots
+  };
+
+  std::vector<THash> entries;
+  std::vector<Slot> slots;
+  size_t mask;
+};
+
 /**
   * @brief Class, allowing the load and matching 3D models.
   * Typical Use:
@@ -143,14 +203,31 @@ public:
   void read(const FileNode& fn);
   void write(FileStorage& fs) const;
 
+  /**
+    *  \brief Saves the trained model into a binary file.
+    *
+    *  The sampled model, the point pair features and the hash table are stored as flat arrays in
+    *  their in-memory layout, so loading a model is bounded by the file read and the file is
+    *  shared by all the processes reading it through the page cache.
+    *  @param [in] FileName Output file
+    *  @return 0 on success, -1 otherwise
+    */
+  CV_WRAP int writeModel(const String& FileName) const;
+
+  /**
+    *  \brief Loads a model saved with writeModel. After loading the detector is ready for matching.
+    *  @param [in] FileName Input file
+    *  @return 0 on success, -1 otherwise
+    */
+  CV_WRAP int readModel(const String& FileName);
+
 protected:
 
   double angle_step, angle_step_radians, distance_step;
   double sampling_step_relative, angle_step_relative, distance_step_relative;
   Mat sampled_pc, ppf;
   int num_ref_points;
-  hashtable_int* hash_table;
-  THash* hash_nodes;
+  PPFHashTable hash_table;
 
   double position_threshold, rotation_threshold;
   bool use_weighted_avg;
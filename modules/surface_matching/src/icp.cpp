@@ -192,31 +192,70 @@ static float getRejectionThreshold(float* r, int m, float outlierScale)
 }
 
 // Kok Lim Low's linearization
+// The normal equations are accumulated over fixed blocks of correspondences and the block sums are
+// added in order, so the result does not depend on the number of threads.
 static void minimizePointToPlaneMetric(Mat Src, Mat Dst, Vec3d& rpy, Vec3d& t)
 {
-  //Mat sub = Dst - Src;
-  Mat A = Mat(Src.rows, 6, CV_64F);
-  Mat b = Mat(Src.rows, 1, CV_64F);
-  Mat rpy_t;
+  const int blockSize = 1024;
+  const int numBlocks = divUp(Src.rows, blockSize);
+  std::vector<Matx66d> blockAtA(numBlocks);
+  std::vector<Vec6d> blockAtb(numBlocks);
 
-#if defined _OPENMP
-#pragma omp parallel for
+  parallel_for_(Range(0, numBlocks), [&](const Range& range)
+  {
+    for (int bi = range.start; bi < range.end; bi++)
+    {
+      double* ata = blockAtA[bi].val;
+      double* atb = blockAtb[bi].val;
+      const int end = std::min(Src.rows, (bi + 1) * blockSize);
+      for (int i = bi * blockSize; i < end; i++)
+      {
+        const Vec3d srcPt(Src.ptr<double>(i));
+        const Vec3d dstPt(Dst.ptr<double>(i));
+        const Vec3d normals(Dst.ptr<double>(i) + 3);
+        const Vec3d sub = dstPt - srcPt;
+        const Vec3d axis = srcPt.cross(normals);
+
+        const double a[6] = { axis[0], axis[1], axis[2], normals[0], normals[1], normals[2] };
+        const double b = sub.dot(normals);
+#if CV_SIMD128_64F
+        v_float64x2 a01 = v_load(a), a23 = v_load(a + 2), a45 = v_load(a + 4);
+        for (int y = 0; y < 6; y++)
+        {
+          v_float64x2 ay = v_setall_f64(a[y]);
+          double* row = ata + y * 6;
+          v_store(row,     v_muladd(ay, a01, v_load(row)));
+          v_store(row + 2, v_muladd(ay, a23, v_load(row + 2)));
+          v_store(row + 4, v_muladd(ay, a45, v_load(row + 4)));
+        }
+        v_float64x2 vb = v_setall_f64(b);
+        v_store(atb,     v_muladd(vb, a01, v_load(atb)));
+        v_store(atb + 2, v_muladd(vb, a23, v_load(atb + 2)));
+        v_store(atb + 4, v_muladd(vb, a45, v_load(atb + 4)));
+#else
+        for (int y = 0; y < 6; y++)
+        {
+          for (int x = 0; x < 6; x++)
+            ata[y * 6 + x] += a[y] * a[x];
+          atb[y] += a[y] * b;
+        }
 #endif
-  for (int i=0; i<Src.rows; i++)
+      }
+    }
+  });
+
+  Matx66d AtA;
+  Vec6d Atb;
+  for (int bi = 0; bi < numBlocks; bi++)
   {
-    const Vec3d srcPt(Src.ptr<double>(i));
-    const Vec3d dstPt(Dst.ptr<double>(i));
-    const Vec3d normals(Dst.ptr<double>(i) + 3);
-    const Vec3d sub = dstPt - srcPt;
-    const Vec3d axis = srcPt.cross(normals);
-
-    *b.ptr<double>(i) = sub.dot(normals);
-    hconcat(axis.reshape<1, 3>(), normals.reshape<1, 3>(), A.row(i));
+    AtA += blockAtA[bi];
+    Atb += blockAtb[bi];
   }
 
-  cv::solve(A, b, rpy_t, DECOMP_SVD);
-  rpy_t.rowRange(0, 3).copyTo(rpy);
-  rpy_t.rowRange(3, 6).copyTo(t);
+  Vec6d rpy_t;
+  cv::solve(AtA, Atb, rpy_t, DECOMP_SVD);
+  rpy = Vec3d(rpy_t[0], rpy_t[1], rpy_t[2]);
+  t = Vec3d(rpy_t[3], rpy_t[4], rpy_t[5]);
 }
 
 static void getTransformMat(Vec3d& euler, Vec3d& t, Matx44d& Pose)
@@ -242,9 +281,90 @@ static hashtable_int* getHashtable(int* data, size_t length, int numMaxElement)
   return hashtable;
 }
 
+//! Sampled scene of one pyramid level and its search index
+struct SceneLevel
+{
+  SceneLevel(const Mat& pc, int sampleStep)
+  {
+    flann = indexPCFlann(samplePCUniform(pc, sampleStep));
+  }
+  ~SceneLevel() { destroyFlann(flann); }
+
+  void* flann;
+};
+
+struct ICP::SceneIndex
+{
+  SceneIndex(const Mat& _pc) : pc(_pc) {}
+
+  //! The index of the scene sampled with sampleStep, built on the first request
+  Ptr<SceneLevel> getLevel(int sampleStep)
+  {
+    AutoLock lock(mutex);
+    Ptr<SceneLevel>& level = levels[sampleStep];
+    if (level.empty())
+      level = makePtr<SceneLevel>(pc, sampleStep);
+    return level;
+  }
+
+  Mat pc;
+  Mutex mutex;
+  std::map<int, Ptr<SceneLevel> > levels;
+};
+
+static int levelSampleStep(int n, int level)
+{
+  const int numSamples = divUp(n, 1 << level);
+  return cvRound((double)n/(double)numSamples);
+}
+
+void ICP::prepareScene(SceneIndex& scene, int numModelPoints) const
+{
+  for (int level = m_numLevels-1; level >=0; level--)
+    scene.getLevel(levelSampleStep(numModelPoints, level));
+}
+
+void ICP::setScene(const Mat& dstPC)
+{
+  CV_Assert(dstPC.type() == CV_32F || dstPC.type() == CV_32FC1);
+  m_scene = makePtr<SceneIndex>(dstPC.clone());
+}
+
 // source point clouds are assumed to contain their normals
 int ICP::registerModelToScene(const Mat& srcPC, const Mat& dstPC, double& residual, Matx44d& pose)
 {
+  SceneIndex scene(dstPC);
+  return registerModel(srcPC, scene, residual, pose);
+}
+
+int ICP::registerModelToScene(const Mat& srcPC, double& residual, Matx44d& pose)
+{
+  CV_Assert(!m_scene.empty() && "setScene() has to be called first");
+  return registerModel(srcPC, *m_scene, residual, pose);
+}
+
+// The scene index is built over the original scene points, while the registration runs on
+// the normalized clouds: the queries are mapped back and the squared distances are rescaled.
+// Nearest neighbors do not change under translation and uniform scaling.
+static void queryScene(void* flann, const Mat& srcMoved, const Vec3d& mean, double scale,
+                       Mat& indices, Mat& distances)
+{
+  Mat query(srcMoved.rows, 3, CV_32F);
+  const float invScale = (float)(1.0 / scale);
+  for (int i = 0; i < srcMoved.rows; i++)
+  {
+    const float* p = srcMoved.ptr<float>(i);
+    float* q = query.ptr<float>(i);
+    for (int c = 0; c < 3; c++)
+      q[c] = p[c] * invScale + (float)mean[c];
+  }
+  queryPCFlann(flann, query, indices, distances);
+  distances *= scale * scale;
+}
+
+int ICP::registerModel(const Mat& srcPC, SceneIndex& scene, double& residual, Matx44d& pose) const
+{
+  const Mat& dstPC = scene.pc;
   int n = srcPC.rows;
   CV_CheckGT(n, 0, "");
 
@@ -281,14 +401,13 @@ int ICP::registerModelToScene(const Mat& srcPC, const Mat& dstPC, double& residu
   // walk the pyramid
   for (int level = m_numLevels-1; level >=0; level--)
   {
-    const int numSamples = divUp(n, 1 << level);
     const double TolP = m_tolerance*(double)(level+1)*(level+1);
     const int MaxIterationsPyr = cvRound((double)m_maxIterations/(level+1));
 
     // Obtain the sampled point clouds for this level: Also rotates the normals
     Mat srcPCT = transformPCPose(srcPC0, pose);
 
-    const int sampleStep = cvRound((double)n/(double)numSamples);
+    const int sampleStep = levelSampleStep(n, level);
 
     srcPCT = samplePCUniform(srcPCT, sampleStep);
     /*
@@ -296,7 +415,7 @@ int ICP::registerModelToScene(const Mat& srcPC, const Mat& dstPC, double& residu
     Hamdi Sahloul, however, noticed that accuracy increased (pose residual decreased slightly).
     */
     Mat dstPCS = samplePCUniform(dstPC0, sampleStep);
-    void* flann = indexPCFlann(dstPCS);
+    Ptr<SceneLevel> sceneLevel = scene.getLevel(sampleStep);
 
     double fval_old=9999999999;
     double fval_perc=0;
@@ -326,7 +445,7 @@ int ICP::registerModelToScene(const Mat& srcPC, const Mat& dstPC, double& residu
     {
       uint di=0, selInd = 0;
 
-      queryPCFlann(flann, Src_Moved, Indices, Distances);
+      queryScene(sceneLevel->flann, Src_Moved, meanAvg, scale, Indices, Distances);
 
       for (di=0; di<numElSrc; di++)
       {
@@ -453,7 +572,6 @@ int ICP::registerModelToScene(const Mat& srcPC, const Mat& dstPC, double& residu
     delete[] indices;
 
     tempResidual = fval_min;
-    destroyFlann(flann);
   }
 
   Matx33d Rpose;
@@ -470,16 +588,38 @@ int ICP::registerModelToScene(const Mat& srcPC, const Mat& dstPC, double& residu
 // source point clouds are assumed to contain their normals
 int ICP::registerModelToScene(const Mat& srcPC, const Mat& dstPC, std::vector<Pose3DPtr>& poses)
 {
-  #if defined _OPENMP
-  #pragma omp parallel for
-  #endif
-  for (int i=0; i<(int)poses.size(); i++)
+  // the scene of all the poses is indexed once
+  SceneIndex scene(dstPC);
+  prepareScene(scene, srcPC.rows);
+
+  parallel_for_(Range(0, (int)poses.size()), [&](const Range& range)
   {
-    Matx44d poseICP = Matx44d::eye();
-    Mat srcTemp = transformPCPose(srcPC, poses[i]->pose);
-    registerModelToScene(srcTemp, dstPC, poses[i]->residual, poseICP);
-    poses[i]->appendPose(poseICP);
-  }
+    for (int i = range.start; i < range.end; i++)
+    {
+      Matx44d poseICP = Matx44d::eye();
+      Mat srcTemp = transformPCPose(srcPC, poses[i]->pose);
+      registerModel(srcTemp, scene, poses[i]->residual, poseICP);
+      poses[i]->appendPose(poseICP);
+    }
+  });
+  return 0;
+}
+
+int ICP::registerModelToScene(const Mat& srcPC, std::vector<Pose3DPtr>& poses)
+{
+  CV_Assert(!m_scene.empty() && "setScene() has to be called first");
+  prepareScene(*m_scene, srcPC.rows);
+
+  parallel_for_(Range(0, (int)poses.size()), [&](const Range& range)
+  {
+    for (int i = range.start; i < range.end; i++)
+    {
+      Matx44d poseICP = Matx44d::eye();
+      Mat srcTemp = transformPCPose(srcPC, poses[i]->pose);
+      registerModel(srcTemp, *m_scene, poses[i]->residual, poseICP);
+      poses[i]->appendPose(poseICP);
+    }
+  });
   return 0;
 }
 
@@ -55,6 +55,14 @@ static bool pose3DPtrCompare(const Pose3DPtr& a, const Pose3DPtr& b)
   return ( a->numVotes > b->numVotes );
 }
 
+struct CellHash
+{
+  size_t operator()(const Vec3i& c) const
+  {
+    return ((size_t)c[0] * 73856093) ^ ((size_t)c[1] * 19349669) ^ ((size_t)c[2] * 83492791);
+  }
+};
+
 static int sortPoseClusters(const PoseCluster3DPtr& a, const PoseCluster3DPtr& b)
 {
   CV_Assert(!a.empty() && !b.empty());
@@ -116,6 +124,139 @@ static double computeAlpha(const Vec3d& p1, const Vec3d& n1, const Vec3d& p2)
   return (-alpha);
 }
 
+static bool hashEntryLess(const THash& a, const THash& b)
+{
+  if (a.id != b.id)
+    return (KeyType)a.id < (KeyType)b.id;
+  return a.ppfInd < b.ppfInd;
+}
+
+void PPFHashTable::build(std::vector<THash>& _entries)
+{
+  entries.swap(_entries);
+  _entries.clear();
+  std::sort(entries.begin(), entries.end(), hashEntryLess);
+
+  int numKeys = 0;
+  for (size_t k = 0; k < entries.size(); k++)
+    if (k == 0 || entries[k].id != entries[k-1].id)
+      numKeys++;
+
+  // keep the load factor at most 1/2, so that the probe sequences stay short
+  size_t numSlots = next_power_of_two((uint)std::max(16, 2 * numKeys));
+  Slot empty = { 0, 0, 0 };
+  slots.assign(numSlots, empty);
+  mask = numSlots - 1;
+
+  for (size_t begin = 0; begin < entries.size(); )
+  {
+    size_t end = begin + 1;
+    while (end < entries.size() && entries[end].id == entries[begin].id)
+      end++;
+
+    KeyType key = (KeyType)entries[begin].id;
+    size_t s = key & mask;
+    while (slots[s].count)
+      s = (s + 1) & mask;
+    slots[s].key = key;
+    slots[s].begin = (int)begin;
+    slots[s].count = (int)(end - begin);
+
+    begin = end;
+  }
+}
+
+const THash* PPFHashTable::find(KeyType key, int& count) const
+{
+  count = 0;
+  if (slots.empty())
+    return NULL;
+
+  for (size_t s = key & mask; slots[s].count; s = (s + 1) & mask)
+  {
+    if (slots[s].key == key)
+    {
+      count = slots[s].count;
+      return &entries[slots[s].begin];
+    }
+  }
+  return NULL;
+}
+
+void PPFHashTable::find(const KeyType* keys, int n, const THash** first, int* counts) const
+{
+  for (int k = 0; k < n; k++)
+    first[k] = find(keys[k], counts[k]);
+}
+
+void PPFHashTable::clear()
+{
+  std::vector<THash>().swap(entries);
+  std::vector<Slot>().swap(slots);
+  mask = 0;
+}
+
+size_t PPFHashTable::memoryUsage() const
+{
+  return entries.capacity() * sizeof(THash) + slots.capacity() * sizeof(Slot);
+}
+
+int PPFHashTable::write(FILE* f) const
+{
+  const int numEntries = (int)entries.size(), numSlots = (int)slots.size();
+  if (fwrite(&numEntries, sizeof(int), 1, f) != 1 || fwrite(&numSlots, sizeof(int), 1, f) != 1)
+    return -1;
+  if (numEntries && fwrite(&entries[0], sizeof(THash), numEntries, f) != (size_t)numEntries)
+    return -1;
+  if (numSlots && fwrite(&slots[0], sizeof(Slot), numSlots, f) != (size_t)numSlots)
+    return -1;
+  return 0;
+}
+
+int PPFHashTable::read(FILE* f)
+{
+  int numEntries = 0, numSlots = 0;
+  if (fread(&numEntries, sizeof(int), 1, f) != 1 || fread(&numSlots, sizeof(int), 1, f) != 1)
+    return -1;
+  // the index is a power of 2 in size
+  if (numEntries < 0 || numSlots < 0 || (numSlots & (numSlots - 1)) != 0)
+    return -1;
+
+  entries.resize(numEntries);
+  slots.resize(numSlots);
+  if (numEntries && fread(&entries[0], sizeof(THash), numEntries, f) != (size_t)numEntries)
+    return -1;
+  if (numSlots && fread(&slots[0], sizeof(Slot), numSlots, f) != (size_t)numSlots)
+    return -1;
+  mask = numSlots ? numSlots - 1 : 0;
+  return 0;
+}
+
+void PPFHashTable::write(FileStorage& fs) const
+{
+  CV_StaticAssert(sizeof(THash) == 3*sizeof(int) && sizeof(Slot) == 3*sizeof(int), "Unexpected padding");
+  fs << "entries" << Mat((int)entries.size(), 3, CV_32S, (void*)(entries.empty() ? NULL : &entries[0]));
+  fs << "slots" << Mat((int)slots.size(), 3, CV_32S, (void*)(slots.empty() ? NULL : &slots[0]));
+}
+
+void PPFHashTable::read(const FileNode& fn)
+{
+  Mat e, sl;
+  fn["entries"] >> e;
+  fn["slots"] >> sl;
+  CV_Assert(e.empty() || (e.type() == CV_32S && e.cols == 3));
+  CV_Assert(sl.empty() || (sl.type() == CV_32S && sl.cols == 3));
+  CV_Assert((sl.rows & (sl.rows - 1)) == 0);
+
+  entries.resize(e.rows);
+  slots.resize(sl.rows);
+  if (e.rows)
+    memcpy(&entries[0], e.ptr(), entries.size() * sizeof(THash));
+  if (sl.rows)
+    memcpy(&slots[0], sl.ptr(), slots.size() * sizeof(Slot));
+  mask = sl.rows ? sl.rows - 1 : 0;
+}
+
 PPF3DDetector::PPF3DDetector()
 {
   sampling_step_relative = 0.05;
@@ -126,9 +267,6 @@ PPF3DDetector::PPF3DDetector()
   angle_step = angle_step_radians;
   trained = false;
 
-  hash_table = NULL;
-  hash_nodes = NULL;
-
   setSearchParams();
 }
 
@@ -142,9 +280,6 @@ PPF3DDetector::PPF3DDetector(const double RelativeSamplingStep, const double Rel
   angle_step = angle_step_radians;
   trained = false;
 
-  hash_table = NULL;
-  hash_nodes = NULL;
-
   setSearchParams();
 }
 
@@ -181,17 +316,7 @@ void PPF3DDetector::computePPFFeatures(const Vec3d& p1, const Vec3d& n1,
 
 void PPF3DDetector::clearTrainingModels()
 {
-  if (this->hash_nodes)
-  {
-    free(this->hash_nodes);
-    this->hash_nodes=0;
-  }
-
-  if (this->hash_table)
-  {
-    hashtableDestroy(this->hash_table);
-    this->hash_table=0;
-  }
+  hash_table.clear();
 }
 
 PPF3DDetector::~PPF3DDetector()
@@ -218,24 +343,16 @@ void PPF3DDetector::trainModel(const Mat &PC)
 
   Mat sampled = samplePCByQuantization(PC, xRange, yRange, zRange, (float)sampling_step_relative,0);
 
-  int size = sampled.rows*sampled.rows;
-
-  hashtable_int* hashTable = hashtableCreate(size, NULL);
-
   int numPPF = sampled.rows*sampled.rows;
   ppf = Mat(numPPF, PPF_LENGTH, CV_32FC1);
 
   // TODO: Maybe I could sample 1/5th of them here. Check the performance later.
   int numRefPoints = sampled.rows;
 
-  // pre-allocate the hash nodes
-  hash_nodes = (THash*)calloc(numRefPoints*numRefPoints, sizeof(THash));
+  // all the hash nodes are collected first and indexed at once
+  std::vector<THash> hashNodes;
+  hashNodes.reserve(numRefPoints*(numRefPoints - 1));
 
-  // TODO : This can easily be parallelized. But we have to lock hashtable_insert.
-  // I realized that performance drops when this loop is parallelized (unordered
-  // inserts into the hashtable
-  // But it is still there to be investigated. For now, I leave this unparallelized
-  // since this is just a training part.
   for (int i=0; i<numRefPoints; i++)
   {
     const Vec3f p1(sampled.ptr<float>(i));
@@ -256,12 +373,11 @@ void PPF3DDetector::trainModel(const Mat &PC)
         double alpha = computeAlpha(p1, n1, p2);
         uint ppfInd = i*numRefPoints+j;
 
-        THash* hashNode = &hash_nodes[i*numRefPoints+j];
-        hashNode->id = hashValue;
-        hashNode->i = i;
-        hashNode->ppfInd = ppfInd;
-
-        hashtableInsertHashed(hashTable, hashValue, (void*)hashNode);
+        THash hashNode;
+        hashNode.id = (int)hashValue;
+        hashNode.i = i;
+        hashNode.ppfInd = (int)ppfInd;
+        hashNodes.push_back(hashNode);
 
         Mat(f).reshape(1, 1).convertTo(ppf.row(ppfInd).colRange(0, 4), CV_32F);
         ppf.ptr<float>(ppfInd)[4] = (float)alpha;
@@ -269,9 +385,11 @@ void PPF3DDetector::trainModel(const Mat &PC)
     }
   }
 
+  clearTrainingModels();
+  hash_table.build(hashNodes);
+
   angle_step = angle_step_radians;
   distance_step = distanceStep;
-  hash_table = hashTable;
   num_ref_points = numRefPoints;
   sampled_pc = sampled;
   trained = true;
@@ -279,6 +397,147 @@ void PPF3DDetector::trainModel(const Mat &PC)
 
 
 
+void PPF3DDetector::write(FileStorage& fs) const
+{
+  fs << "angle_step" << angle_step;
+  fs << "angle_step_radians" << angle_step_radians;
+  fs << "distance_step" << distance_step;
+  fs << "sampling_step_relative" << sampling_step_relative;
+  fs << "angle_step_relative" << angle_step_relative;
+  fs << "distance_step_relative" << distance_step_relative;
+  fs << "position_threshold" << position_threshold;
+  fs << "rotation_threshold" << rotation_threshold;
+  fs << "use_weighted_avg" << (int)use_weighted_avg;
+  fs << "trained" << (int)trained;
+  if (trained)
+  {
+    fs << "num_ref_points" << num_ref_points;
+    fs << "sampled_pc" << sampled_pc;
+    fs << "ppf" << ppf;
+    fs << "hash_table" << "{";
+    hash_table.write(fs);
+    fs << "}";
+  }
+}
+
+void PPF3DDetector::read(const FileNode& fn)
+{
+  clearTrainingModels();
+
+  angle_step = fn["angle_step"];
+  angle_step_radians = fn["angle_step_radians"];
+  distance_step = fn["distance_step"];
+  sampling_step_relative = fn["sampling_step_relative"];
+  angle_step_relative = fn["angle_step_relative"];
+  distance_step_relative = fn["distance_step_relative"];
+  position_threshold = fn["position_threshold"];
+  rotation_threshold = fn["rotation_threshold"];
+  use_weighted_avg = (int)fn["use_weighted_avg"] != 0;
+  trained = (int)fn["trained"] != 0;
+  if (trained)
+  {
+    num_ref_points = fn["num_ref_points"];
+    fn["sampled_pc"] >> sampled_pc;
+    fn["ppf"] >> ppf;
+    hash_table.read(fn["hash_table"]);
+    CV_Assert(sampled_pc.rows == num_ref_points && ppf.rows == num_ref_points * num_ref_points);
+  }
+}
+
+static const int PPF_MODEL_MAGIC = 0x4d465050; // "PPFM"
+static const int PPF_MODEL_VERSION = 1;
+
+static int writeMat32F(const Mat& m, FILE* f)
+{
+  CV_Assert(m.type() == CV_32FC1 && m.isContinuous());
+  const int dims[2] = { m.rows, m.cols };
+  if (fwrite(dims, sizeof(int), 2, f) != 2)
+    return -1;
+  if (m.total() && fwrite(m.ptr(), sizeof(float), m.total(), f) != m.total())
+    return -1;
+  return 0;
+}
+
+static int readMat32F(Mat& m, FILE* f)
+{
+  int dims[2] = { 0, 0 };
+  if (fread(dims, sizeof(int), 2, f) != 2 || dims[0] < 0 || dims[1] < 0)
+    return -1;
+  m.create(dims[0], dims[1], CV_32FC1);
+  if (m.total() && fread(m.ptr(), sizeof(float), m.total(), f) != m.total())
+    return -1;
+  return 0;
+}
+
+int PPF3DDetector::writeModel(const String& FileName) const
+{
+  if (!trained)
+    return -1;
+
+  FILE* f = fopen(FileName.c_str(), "wb");
+  if (!f)
+    return -1;
+
+  // all the fields are 4 or 8 bytes wide and stay aligned to their size
+  const int header[4] = { PPF_MODEL_MAGIC, PPF_MODEL_VERSION, (int)use_weighted_avg, num_ref_points };
+  const double params[8] = { angle_step, angle_step_radians, distance_step, sampling_step_relative,
+                             angle_step_relative, distance_step_relative, position_threshold, rotation_threshold };
+
+  int status = (fwrite(header, sizeof(int), 4, f) == 4 && fwrite(params, sizeof(double), 8, f) == 8) ? 0 : -1;
+  if (status == 0)
+    status = writeMat32F(sampled_pc, f);
+  if (status == 0)
+    status = writeMat32F(ppf, f);
+  if (status == 0)
+    status = hash_table.write(f);
+
+  fclose(f);
+  return status;
+}
+
+int PPF3DDetector::readModel(const String& FileName)
+{
+  FILE* f = fopen(FileName.c_str(), "rb");
+  if (!f)
+    return -1;
+
+  clearTrainingModels();
+  trained = false;
+
+  int header[4] = { 0, 0, 0, 0 };
+  double params[8];
+  int status = -1;
+  if (fread(header, sizeof(int), 4, f) == 4 && header[0] == PPF_MODEL_MAGIC && header[1] == PPF_MODEL_VERSION &&
+      fread(params, sizeof(double), 8, f) == 8)
+    status = 0;
+  if (status == 0)
+    status = readMat32F(sampled_pc, f);
+  if (status == 0)
+    status = readMat32F(ppf, f);
+  if (status == 0)
+    status = hash_table.read(f);
+  fclose(f);
+
+  num_ref_points = header[3];
+  if (status != 0 || sampled_pc.rows != num_ref_points || ppf.rows != num_ref_points * num_ref_points)
+  {
+    clearTrainingModels();
+    return -1;
+  }
+
+  use_weighted_avg = header[2] != 0;
+  angle_step = params[0];
+  angle_step_radians = params[1];
+  distance_step = params[2];
+  sampling_step_relative = params[3];
+  angle_step_relative = params[4];
+  distance_step_relative = params[5];
+  position_threshold = params[6];
+  rotation_threshold = params[7];
+  trained = true;
+  return 0;
+}
+
 ///////////////////////// MATCHING ////////////////////////////////////////
 
 
@@ -300,32 +559,55 @@ void PPF3DDetector::clusterPoses(std::vector<Pose3DPtr>& poseList, int numPoses,
   finalPoses.clear();
 
   // sort the poses for stability
-  std::sort(poseList.begin(), poseList.end(), pose3DPtrCompare);
+  std::stable_sort(poseList.begin(), poseList.end(), pose3DPtrCompare);
+
+  // A pose joins the first created cluster whose center matches it. Matching centers are
+  // closer than position_threshold, so only the clusters hashed into the 27 grid cells around
+  // the pose translation are tested. This gives the same clusters as testing all of them.
+  const double cellSize = position_threshold > 0 ? position_threshold : 1.0;
+  std::unordered_map<Vec3i, std::vector<int>, CellHash> grid;
 
   for (int i=0; i<numPoses; i++)
   {
     Pose3DPtr pose = poseList[i];
-    bool assigned = false;
+    const Vec3i cell(cvFloor(pose->t[0] / cellSize), cvFloor(pose->t[1] / cellSize), cvFloor(pose->t[2] / cellSize));
+    int assigned = -1;
 
-    // search all clusters
-    for (size_t j=0; j<poseClusters.size() && !assigned; j++)
+    // search the clusters around
+    for (int dx = -1; dx <= 1; dx++)
+      for (int dy = -1; dy <= 1; dy++)
+        for (int dz = -1; dz <= 1; dz++)
+        {
+          std::unordered_map<Vec3i, std::vector<int>, CellHash>::const_iterator it = grid.find(cell + Vec3i(dx, dy, dz));
+          if (it == grid.end())
+            continue;
+          const std::vector<int>& candidates = it->second;
+          for (size_t c = 0; c < candidates.size(); c++)
+          {
+            const int j = candidates[c];
+            if (assigned >= 0 && j > assigned)
+              break;
+            if (matchPose(*pose, *poseClusters[j]->poseList[0]))
+            {
+              assigned = j;
+              break;
+            }
+          }
+        }
+
+    if (assigned >= 0)
     {
-      const Pose3DPtr poseCenter = poseClusters[j]->poseList[0];
-      if (matchPose(*pose, *poseCenter))
-      {
-        poseClusters[j]->addPose(pose);
-        assigned = true;
-      }
+      poseClusters[assigned]->addPose(pose);
     }
-
-    if (!assigned)
+    else
     {
+      grid[cell].push_back((int)poseClusters.size());
       poseClusters.push_back(PoseCluster3DPtr(new PoseCluster3D(pose)));
     }
   }
 
   // sort the clusters so that we could output multiple hypothesis
-  std::sort(poseClusters.begin(), poseClusters.end(), sortPoseClusters);
+  std::stable_sort(poseClusters.begin(), poseClusters.end(), sortPoseClusters);
 
   finalPoses.resize(poseClusters.size());
 
@@ -333,11 +615,10 @@ void PPF3DDetector::clusterPoses(std::vector<Pose3DPtr>& poseList, int numPoses,
 
   if (use_weighted_avg)
   {
-#if defined _OPENMP
-#pragma omp parallel for
-#endif
     // uses weighting by the number of votes
-    for (int i=0; i<static_cast<int>(poseClusters.size()); i++)
+    parallel_for_(Range(0, static_cast<int>(poseClusters.size())), [&](const Range& range)
+    {
+    for (int i=range.start; i<range.end; i++)
     {
       // We could only average the quaternions. So I will make use of them here
       Vec4d qAvg = Vec4d::all(0);
@@ -371,13 +652,13 @@ void PPF3DDetector::clusterPoses(std::vector<Pose3DPtr>& poseList, int numPoses,
 
       finalPoses[i]=curPoses[0]->clone();
     }
+    });
   }
   else
   {
-#if defined _OPENMP
-#pragma omp parallel for
-#endif
-    for (int i=0; i<static_cast<int>(poseClusters.size()); i++)
+    parallel_for_(Range(0, static_cast<int>(poseClusters.size())), [&](const Range& range)
+    {
+    for (int i=range.start; i<range.end; i++)
     {
       // We could only average the quaternions. So I will make use of them here
       Vec4d qAvg = Vec4d::all(0);
@@ -402,6 +683,7 @@ void PPF3DDetector::clusterPoses(std::vector<Pose3DPtr>& poseList, int numPoses,
 
       finalPoses[i]=curPoses[0]->clone();
     }
+    });
   }
 
   poseClusters.clear();
@@ -443,13 +725,19 @@ void PPF3DDetector::match(const Mat& pc, std::vector<Pose3DPtr>& results, const
      uint* accumulator = (uint*)calloc(numAngles*n, sizeof(uint));
   #endif*/
 
-  poseList.reserve((sampled.rows/sceneSamplingStep)+4);
+  const int numSceneRefs = (sampled.rows + sceneSamplingStep - 1) / sceneSamplingStep;
+  poseList.resize(numSceneRefs);
 
-#if defined _OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < sampled.rows; i += sceneSamplingStep)
+  parallel_for_(Range(0, numSceneRefs), [&](const Range& range)
   {
+  // one accumulator serves all the reference points of the range,
+  // it is cleared while being maximized
+  std::vector<uint> accumulatorBuf(numAngles*n, 0);
+  uint* accumulator = &accumulatorBuf[0];
+
+  for (int r = range.start; r < range.end; r++)
+  {
+    const int i = r * sceneSamplingStep;
     uint refIndMax = 0, alphaIndMax = 0;
     uint maxVotes = 0;
 
@@ -458,7 +746,6 @@ void PPF3DDetector::match(const Mat& pc, std::vector<Pose3DPtr>& results, const
     Vec3d tsg = Vec3d::all(0);
     Matx33d Rsg = Matx33d::all(0), RInv = Matx33d::all(0);
 
-    uint* accumulator = (uint*)calloc(numAngles*n, sizeof(uint));
     computeTransformRT(p1, n1, Rsg, tsg);
 
     // Tolga Birdal's notice:
@@ -466,6 +753,12 @@ void PPF3DDetector::match(const Mat& pc, std::vector<Pose3DPtr>& results, const
     // To do this, simply search the local neighborhood by radius look up
     // and collect the neighbors to compute the relative pose
 
+    // keys and scene angles of all the pairs of this reference point, looked up at once
+    std::vector<KeyType> keys;
+    std::vector<double> sceneAlphas;
+    keys.reserve(sampled.rows);
+    sceneAlphas.reserve(sampled.rows);
+
     for (int j = 0; j < sampled.rows; j ++)
     {
       if (i!=j)
@@ -493,32 +786,41 @@ void PPF3DDetector::match(const Mat& pc, std::vector<Pose3DPtr>& results, const
 
         alpha_scene=-alpha_scene;
 
-        hashnode_i* node = hashtableGetBucketHashed(hash_table, (hashValue));
+        keys.push_back(hashValue);
+        sceneAlphas.push_back(alpha_scene);
+      }
+    }
 
-        while (node)
-        {
-          THash* tData = (THash*) node->data;
-          int corrI = (int)tData->i;
-          int ppfInd = (int)tData->ppfInd;
-          float* ppfCorrScene = ppf.ptr<float>(ppfInd);
-          double alpha_model = (double)ppfCorrScene[PPF_LENGTH-1];
-          double alpha = alpha_model - alpha_scene;
-
-          /*  Tolga Birdal's note: Map alpha to the indices:
-                  atan2 generates results in (-pi pi]
-                  That's why alpha should be in range [-2pi 2pi]
-                  So the quantization would be :
-                  numAngles * (alpha+2pi)/(4pi)
-                  */
-
-          //printf("%f\n", alpha);
-          int alpha_index = (int)(numAngles*(alpha + 2*M_PI) / (4*M_PI));
-
-          uint accIndex = corrI * numAngles + alpha_index;
-
-          accumulator[accIndex]++;
-          node = node->next;
-        }
+    const int numKeys = (int)keys.size();
+    std::vector<const THash*> firstEntries(numKeys);
+    std::vector<int> entryCounts(numKeys);
+    if (numKeys > 0)
+      hash_table.find(&keys[0], numKeys, &firstEntries[0], &entryCounts[0]);
+
+    for (int k = 0; k < numKeys; k++)
+    {
+      const THash* tData = firstEntries[k];
+      for (int e = 0; e < entryCounts[k]; e++)
+      {
+        int corrI = tData[e].i;
+        int ppfInd = tData[e].ppfInd;
+        float* ppfCorrScene = ppf.ptr<float>(ppfInd);
+        double alpha_model = (double)ppfCorrScene[PPF_LENGTH-1];
+        double alpha = alpha_model - sceneAlphas[k];
+
+        /*  Tolga Birdal's note: Map alpha to the indices:
+                atan2 generates results in (-pi pi]
+                That's why alpha should be in range [-2pi 2pi]
+                So the quantization would be :
+                numAngles * (alpha+2pi)/(4pi)
+                */
+
+        //printf("%f\n", alpha);
+        int alpha_index = (int)(numAngles*(alpha + 2*M_PI) / (4*M_PI));
+
+        uint accIndex = corrI * numAngles + alpha_index;
+
+        accumulator[accIndex]++;
       }
     }
 
@@ -536,9 +838,7 @@ void PPF3DDetector::match(const Mat& pc, std::vector<Pose3DPtr>& results, const
           alphaIndMax = j;
         }
 
-#if !defined (_OPENMP)
         accumulator[accInd ] = 0;
-#endif
       }
     }
 
@@ -576,15 +876,9 @@ void PPF3DDetector::match(const Mat& pc, std::vector<Pose3DPtr>& results, const
 
     Pose3DPtr pose(new Pose3D(alpha, refIndMax, maxVotes));
     pose->updatePose(rawPose);
-    #if defined (_OPENMP)
-    #pragma omp critical
-    #endif
-    {
-      poseList.push_back(pose);
-    }
-
-    free(accumulator);
+    poseList[r] = pose;
   }
+  });
 
   // TODO : Make the parameters relative if not arguments.
   //double MinMatchScore = 0.5;
@@ -451,6 +451,20 @@ public:
                      std::vector<std::string>* component_texts=NULL, std::vector<float>* component_confidences=NULL,
                      int component_level=0) CV_OVERRIDE;
 
+    /** @brief Recognize a batch of word images.
+
+    With the default character classifier the sliding windows of all the words are classified
+    together, and the words are decoded in parallel.
+
+    @param images Input images CV_8UC1 or CV_8UC3, each with a single word.
+
+    @param output_texts Output text of every image.
+
+    @param confidences If provided the method will output the confidence value of every recognition.
+     */
+    virtual void run(const std::vector<Mat>& images, std::vector<std::string>& output_texts,
+                     std::vector<float>* confidences=NULL);
+
     // aliases for scripting
     CV_WRAP String run(InputArray image, int min_confidence, int component_level=0);
 
@@ -6,6 +6,7 @@
 #define __OPENCV_TEXT_TEXTDETECTOR_HPP__
 
 #include "ocr.hpp"
+#include "opencv2/core/async.hpp"
 
 namespace cv
 {
@@ -50,6 +51,31 @@ public:
     */
     CV_WRAP virtual void detect(InputArray inputImage, CV_OUT std::vector<Rect>& Bbox, CV_OUT std::vector<float>& confidence) CV_OVERRIDE = 0;
 
+    /** @brief Detects text in several images
+
+    The images are resized to the same detection sizes, so the network processes them together as
+    batches.
+
+    @param inputImages images expected to be CV_U8C3 of any size
+    @param Bbox the detected word bounding boxes of every image
+    @param confidence the confidences of the boxes of every image
+    */
+    virtual void detect(InputArrayOfArrays inputImages, std::vector<std::vector<Rect> >& Bbox,
+                        std::vector<std::vector<float> >& confidence) = 0;
+
+    /** @brief Detects text in several images asynchronously
+
+    Same as detect() for several images but returns immediately. The calls are processed in a
+    pipeline: the images of a call are prepared while the network runs on the previous one.
+    The synchronous methods wait until the queued calls are processed.
+
+    @param inputImages images expected to be CV_U8C3 of any size, they are copied so the buffers can
+    be reused right after the call
+    @return AsyncArray containing a CV_32F matrix with a row per detected box:
+    image index, x, y, width, height and confidence
+    */
+    CV_WRAP virtual AsyncArray detectAsync(InputArrayOfArrays inputImages) = 0;
+
     /** @brief Creates an instance of the TextDetectorCNN class using the provided parameters.
 
     @param modelArchFilename the relative or absolute path to the prototxt file describing the classifiers architecture.
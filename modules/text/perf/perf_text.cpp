@@ -0,0 +1,46 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+// lines of dark text on a light textured background
+static Mat makeTextImage(Size sz)
+{
+    Mat img = imread(getDataPath("cv/shared/lena.png"));
+    CV_Assert(!img.empty());
+    resize(img, img, sz, 0, 0, INTER_LINEAR_EXACT);
+    img = img / 2 + Scalar::all(127);
+    const double fontScale = sz.height / 480.0;
+    for (int y = 40; y < sz.height; y += (int)(60 * fontScale))
+        putText(img, "OpenCV 0123 text", Point(20, y), FONT_HERSHEY_SIMPLEX, fontScale, Scalar::all(0),
+                std::max(1, cvRound(2 * fontScale)));
+    return img;
+}
+
+typedef perf::TestBaseWithParam<Size> TextDetectionSWT;
+
+PERF_TEST_P(TextDetectionSWT, detect, Values(szVGA, sz720p))
+{
+    Mat img = makeTextImage(GetParam());
+    std::vector<Rect> components;
+
+    TEST_CYCLE() text::detectTextSWT(img, components, true);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef perf::TestBaseWithParam<Size> ComputeNMChannels;
+
+PERF_TEST_P(ComputeNMChannels, RGBLGrad, Values(szVGA, sz720p))
+{
+    Mat img = makeTextImage(GetParam());
+    std::vector<Mat> channels;
+
+    TEST_CYCLE() text::computeNMChannels(img, channels, text::ERFILTER_NM_RGBLGrad);
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
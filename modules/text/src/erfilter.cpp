@@ -43,6 +43,7 @@
 #include "precomp.hpp"
 #include "opencv2/imgproc.hpp"
 #include "opencv2/ml.hpp"
+#include "opencv2/core/utils/trace.hpp"
 #include <limits>
 #include <fstream>
 #include <queue>
@@ -71,27 +72,6 @@ using namespace cv::ml;
 using namespace std;
 using namespace cv::ml;
 
-// Deletes a tree of ERStat regions starting at root. Used only
-// internally to this implementation.
-static void deleteERStatTree(ERStat* root) {
-    queue<ERStat*> to_delete;
-    to_delete.push(root);
-    while (!to_delete.empty()) {
-        ERStat* n = to_delete.front();
-        to_delete.pop();
-        ERStat* c = n->child;
-        if (c != NULL) {
-            to_delete.push(c);
-            ERStat* sibling = c->next;
-            while (sibling != NULL) {
-                to_delete.push(sibling);
-                sibling = sibling->next;
-            }
-        }
-        delete n;
-    }
-}
-
 ERStat::ERStat(int init_level, int init_pixel, int init_x, int init_y) : pixel(init_pixel),
                level(init_level), area(0), perimeter(0), euler(0), probability(1.0),
                parent(0), child(0), next(0), prev(0), local_maxima(0),
@@ -108,6 +88,135 @@ ERStat::ERStat(int init_level, int init_pixel, int init_x, int init_y) : pixel(i
 }
 
 
+// ER under construction in the component tree extraction.
+// The horizontal crossings of the rows of stat.rect are kept in a contiguous buffer which grows at
+// both ends, stat.crossings is not used.
+struct ERNode
+{
+    ERStat stat;
+    vector<int> crossings;
+    int first; // crossings of the row stat.rect.y
+    int count;
+
+    ERNode() : first(0), count(0)
+    {
+        stat.crossings.release();
+    }
+
+    // same initial state as ERStat(level, pixel, x, y) has
+    void reset(int level, int pixel, int x, int y)
+    {
+        stat.pixel = pixel;
+        stat.level = level;
+        stat.area = 0;
+        stat.perimeter = 0;
+        stat.euler = 0;
+        stat.rect = Rect(x, y, 1, 1);
+        stat.raw_moments[0] = stat.raw_moments[1] = 0.0;
+        stat.central_moments[0] = stat.central_moments[1] = stat.central_moments[2] = 0.0;
+        stat.med_crossings = 0.f;
+        stat.hole_area_ratio = stat.convex_hull_ratio = stat.num_inflexion_points = 0.f;
+        stat.pixels = NULL;
+        stat.probability = 1.0;
+        stat.parent = stat.child = stat.next = stat.prev = NULL;
+        stat.local_maxima = false;
+        stat.max_probability_ancestor = stat.min_probability_ancestor = NULL;
+
+        if (crossings.size() < 16)
+            crossings.resize(16);
+        first = (int)crossings.size() / 2;
+        count = 1;
+        crossings[first] = 0;
+    }
+
+    int& crossing(int i)
+    {
+        CV_DbgAssert(0 <= i && i < count);
+        return crossings[first + i];
+    }
+
+    void pushFront(int v)
+    {
+        if (first == 0)
+        {
+            int slack = max(count, 16);
+            crossings.insert(crossings.begin(), slack, 0);
+            first = slack;
+        }
+        crossings[--first] = v;
+        count++;
+    }
+
+    void pushBack(int v)
+    {
+        if (first + count == (int)crossings.size())
+            crossings.resize(crossings.size() + max(count, 16));
+        crossings[first + count] = v;
+        count++;
+    }
+};
+
+// Storage of the ERs of the component tree extraction.
+// The rejected ERs are recycled and the storage is kept by the filter from one image to the other,
+// so that the extraction does not allocate per region.
+class ERNodePool
+{
+public:
+    ERNodePool() : block_size(0), blocks_used(0), used(0) {}
+    // the copies of a filter get their own storage
+    ERNodePool(const ERNodePool&) : block_size(0), blocks_used(0), used(0) {}
+    ERNodePool& operator=(const ERNodePool&) { return *this; }
+
+    // makes all the ERs available again, the blocks are sized from the number of pixels of the image
+    void reset(int num_pixels)
+    {
+        size_t size = min(max((size_t)num_pixels / 16, (size_t)256), (size_t)16384);
+        if (size > block_size)
+        {
+            blocks.clear();
+            block_size = size;
+        }
+        blocks_used = 0;
+        used = block_size;
+        free_list.clear();
+    }
+
+    ERNode* get(int level, int pixel, int x, int y)
+    {
+        ERNode* er;
+        if (!free_list.empty())
+        {
+            er = free_list.back();
+            free_list.pop_back();
+        }
+        else
+        {
+            if (used == block_size)
+            {
+                if (blocks_used == blocks.size())
+                    blocks.push_back(vector<ERNode>(block_size));
+                blocks_used++;
+                used = 0;
+            }
+            er = &blocks[blocks_used - 1][used++];
+        }
+        er->reset(level, pixel, x, y);
+        return er;
+    }
+
+    void put(ERNode* er)
+    {
+        free_list.push_back(er);
+    }
+
+private:
+    size_t block_size;
+    size_t blocks_used; // blocks with ERs in use
+    size_t used;        // ERs taken from the last used block
+    vector< vector<ERNode> > blocks;
+    vector<ERNode*> free_list;
+};
+
 // derivative classes
 
 
@@ -151,20 +260,27 @@ public:
     void setNonMaxSuppression(bool nonMaxSuppression) CV_OVERRIDE;
     int  getNumRejected() const CV_OVERRIDE;
 
+    // whether the copies of the filter may run concurrently, they share the callback
+    bool isCallbackThreadSafe() const;
+    // takes the count of the rejected/accepted regions from another filter
+    void setCounters(const ERFilterNM& other);
+
 private:
     // pointer to the input/output regions vector
     vector<ERStat> *regions;
     // image mask used for feature calculations
     Mat region_mask;
+    // storage of the ERs during the extraction
+    ERNodePool er_pool;
 
     // extract the component tree and store all the ER regions
     void er_tree_extract( InputArray image );
     // accumulate a pixel into an ER
-    void er_add_pixel( ERStat *parent, int x, int y, int non_boundary_neighbours,
+    void er_add_pixel( ERNode *parent, int x, int y, int non_boundary_neighbours,
                        int non_boundary_neighbours_horiz,
                        int d_C1, int d_C2, int d_C3 );
     // merge an ER with its nested parent
-    void er_merge( ERStat *parent, ERStat *child );
+    void er_merge( ERNode *parent, ERNode *child );
     // copy extracted regions into the output vector
     ERStat* er_save( ERStat *er, ERStat *parent, ERStat *prev );
     // recursively walk the tree and filter (remove) regions using the callback classifier
@@ -233,15 +349,19 @@ void ERFilterNM::run( InputArray image, vector<ERStat>& _regions )
     // assert correct image type
     CV_Assert( image.getMat().type() == CV_8UC1 );
 
+    CV_TRACE_FUNCTION();
+
     regions = &_regions;
     region_mask = Mat::zeros(image.getMat().rows+2, image.getMat().cols+2, CV_8UC1);
 
     // if regions vector is empty we must extract the entire component tree
     if ( regions->size() == 0 )
     {
+        CV_TRACE_REGION("extractTree");
         er_tree_extract( image );
         if (nonMaxSuppression)
         {
+            CV_TRACE_REGION_NEXT("nonMaxSuppression");
             vector<ERStat> aux_regions;
             regions->swap(aux_regions);
             regions->reserve(aux_regions.size());
@@ -251,6 +371,7 @@ void ERFilterNM::run( InputArray image, vector<ERStat>& _regions )
     }
     else // if regions vector is already filled we'll just filter the current regions
     {
+        CV_TRACE_REGION("filterTree");
         // the tree root must have no parent
         CV_Assert( regions->front().parent == NULL );
 
@@ -281,7 +402,8 @@ void ERFilterNM::er_tree_extract( InputArray image )
     int width = src.cols, height = src.rows;
 
     // the component stack
-    vector<ERStat*> er_stack;
+    vector<ERNode*> er_stack;
+    er_pool.reset(width * height);
 
     // the quads for Euler's number calculation
     // quads[2][2] and quads[2][3] are never used.
@@ -305,7 +427,7 @@ void ERFilterNM::er_tree_extract( InputArray image )
     vector<int> boundary_edges[256];
 
     // add a dummy-component before start
-    er_stack.push_back(new ERStat);
+    er_stack.push_back(er_pool.get(256, 0, 0, 0));
 
     // we'll look initially for all pixels with grey-level lower than a grey-level higher than any allowed in the image
     int threshold_level = (255/thresholdDelta)+1;
@@ -325,7 +447,7 @@ void ERFilterNM::er_tree_extract( InputArray image )
 
         // push a component with current level in the component stack
         if (push_new_component)
-            er_stack.push_back(new ERStat(current_level, current_pixel, x, y));
+            er_stack.push_back(er_pool.get(current_level, current_pixel, x, y));
         push_new_component = false;
 
         // explore the (remaining) edges to the neighbors to the current pixel
@@ -520,18 +642,9 @@ void ERFilterNM::er_tree_extract( InputArray image )
 
             // save the extracted regions into the output vector
             regions->reserve(num_accepted_regions+1);
-            er_save(er_stack.back(), NULL, NULL);
+            er_save(&er_stack.back()->stat, NULL, NULL);
 
-            // clean memory
-            for (size_t r=0; r<er_stack.size(); r++)
-            {
-                ERStat *stat = er_stack.at(r);
-                if (stat->crossings)
-                {
-                    stat->crossings.release();
-                }
-                deleteERStatTree(stat);
-            }
+            // the ERs stay in er_pool for the next image
             er_stack.clear();
 
             return;
@@ -556,14 +669,14 @@ void ERFilterNM::er_tree_extract( InputArray image )
             current_level = new_level;
 
             // process components on the top of the stack until we reach the higher grey-level
-            while (er_stack.back()->level < new_level)
+            while (er_stack.back()->stat.level < new_level)
             {
-                ERStat* er = er_stack.back();
+                ERNode* er = er_stack.back();
                 er_stack.erase(er_stack.end()-1);
 
-                if (new_level < er_stack.back()->level)
+                if (new_level < er_stack.back()->stat.level)
                 {
-                    er_stack.push_back(new ERStat(new_level, current_pixel, current_pixel%width, current_pixel/width));
+                    er_stack.push_back(er_pool.get(new_level, current_pixel, current_pixel%width, current_pixel/width));
                     er_merge(er_stack.back(), er);
                     break;
                 }
@@ -577,22 +690,23 @@ void ERFilterNM::er_tree_extract( InputArray image )
 }
 
 // accumulate a pixel into an ER
-void ERFilterNM::er_add_pixel(ERStat *parent, int x, int y, int non_border_neighbours,
+void ERFilterNM::er_add_pixel(ERNode *node, int x, int y, int non_border_neighbours,
                                                             int non_border_neighbours_horiz,
                                                             int d_C1, int d_C2, int d_C3)
 {
+    ERStat *parent = &node->stat;
     parent->area++;
     parent->perimeter += 4 - 2*non_border_neighbours;
 
-    if (parent->crossings->size()>0)
+    if (node->count>0)
     {
-        if (y<parent->rect.y) parent->crossings->push_front(2);
-        else if (y>parent->rect.br().y-1) parent->crossings->push_back(2);
+        if (y<parent->rect.y) node->pushFront(2);
+        else if (y>parent->rect.br().y-1) node->pushBack(2);
         else {
-            parent->crossings->at(y - parent->rect.y) += 2-2*non_border_neighbours_horiz;
+            node->crossing(y - parent->rect.y) += 2-2*non_border_neighbours_horiz;
         }
     } else {
-        parent->crossings->push_back(2);
+        node->pushBack(2);
     }
 
     parent->euler += (d_C1 - d_C2 + 2*d_C3) / 4;
@@ -615,8 +729,10 @@ void ERFilterNM::er_add_pixel(ERStat *parent, int x, int y, int non_border_neigh
 }
 
 // merge an ER with its nested parent
-void ERFilterNM::er_merge(ERStat *parent, ERStat *child)
+void ERFilterNM::er_merge(ERNode *parent_node, ERNode *child_node)
 {
+    ERStat *parent = &parent_node->stat;
+    ERStat *child = &child_node->stat;
 
     parent->area += child->area;
 
@@ -625,19 +741,19 @@ void ERFilterNM::er_merge(ERStat *parent, ERStat *child)
 
     for (int i=parent->rect.y; i<=min(parent->rect.br().y-1,child->rect.br().y-1); i++)
         if (i-child->rect.y >= 0)
-            parent->crossings->at(i-parent->rect.y) += child->crossings->at(i-child->rect.y);
+            parent_node->crossing(i-parent->rect.y) += child_node->crossing(i-child->rect.y);
 
     for (int i=parent->rect.y-1; i>=child->rect.y; i--)
-        if (i-child->rect.y < (int)child->crossings->size())
-            parent->crossings->push_front(child->crossings->at(i-child->rect.y));
+        if (i-child->rect.y < child_node->count)
+            parent_node->pushFront(child_node->crossing(i-child->rect.y));
         else
-            parent->crossings->push_front(0);
+            parent_node->pushFront(0);
 
     for (int i=parent->rect.br().y; i<child->rect.y; i++)
-        parent->crossings->push_back(0);
+        parent_node->pushBack(0);
 
     for (int i=max(parent->rect.br().y,child->rect.y); i<=child->rect.br().y-1; i++)
-        parent->crossings->push_back(child->crossings->at(i-child->rect.y));
+        parent_node->pushBack(child_node->crossing(i-child->rect.y));
 
     parent->euler += child->euler;
 
@@ -657,15 +773,11 @@ void ERFilterNM::er_merge(ERStat *parent, ERStat *child)
     parent->central_moments[1] += child->central_moments[1];
     parent->central_moments[2] += child->central_moments[2];
 
-    vector<int> m_crossings;
-    m_crossings.push_back(child->crossings->at((int)(child->rect.height)/6));
-    m_crossings.push_back(child->crossings->at((int)3*(child->rect.height)/6));
-    m_crossings.push_back(child->crossings->at((int)5*(child->rect.height)/6));
-    sort(m_crossings.begin(), m_crossings.end());
-    child->med_crossings = (float)m_crossings.at(1);
-
-    // free unnecessary mem
-    child->crossings.release();
+    int m_crossings[3] = { child_node->crossing((int)(child->rect.height)/6),
+                           child_node->crossing((int)3*(child->rect.height)/6),
+                           child_node->crossing((int)5*(child->rect.height)/6) };
+    sort(m_crossings, m_crossings + 3);
+    child->med_crossings = (float)m_crossings[1];
 
     // recover the original grey-level
     child->level = child->level*thresholdDelta;
@@ -709,12 +821,7 @@ void ERFilterNM::er_merge(ERStat *parent, ERStat *child)
             child->child->parent = parent;
         }
 
-        // free mem
-        if(child->crossings)
-        {
-            child->crossings.release();
-        }
-        delete(child);
+        er_pool.put(child_node);
     }
 
 }
@@ -1196,6 +1303,20 @@ public:
     double eval(const ERStat& s) CV_OVERRIDE {if (s.area ==0) return (double)0.0; return (double)1.0;}
 };
 
+// the built-in classifiers do not modify their state in eval(), user callbacks may do
+bool ERFilterNM::isCallbackThreadSafe() const
+{
+    Callback* cb = classifier.get();
+    return !cb || dynamic_cast<ERClassifierNM1*>(cb) || dynamic_cast<ERClassifierNM2*>(cb) ||
+           dynamic_cast<ERDummyClassifier*>(cb);
+}
+
+void ERFilterNM::setCounters(const ERFilterNM& other)
+{
+    num_rejected_regions = other.num_rejected_regions;
+    num_accepted_regions = other.num_accepted_regions;
+}
+
 /* Create a dummy classifier that accepts all regions */
 Ptr<ERFilter::Callback> loadDummyClassifier();
 Ptr<ERFilter::Callback> loadDummyClassifier()
@@ -1244,6 +1365,7 @@ void get_gradient_magnitude(Mat& _grey_img, Mat& _gradient_magnitude)
 */
 void computeNMChannels(InputArray _src, CV_OUT OutputArrayOfArrays _channels, int _mode)
 {
+    CV_TRACE_FUNCTION();
 
     CV_Assert( ( _mode == ERFILTER_NM_RGBLGrad ) || ( _mode == ERFILTER_NM_IHSGrad ) );
 
@@ -1338,6 +1460,9 @@ public:
     // copies p to the internal point set
     void check_in (vector<float> *p);
 
+    // extends the box to the points of another box
+    void check_in (const Minibox &b);
+
     // returns the volume of the box
     long double volume();
 };
@@ -1362,6 +1487,22 @@ void Minibox::check_in (vector<float> *p)
     }
 }
 
+void Minibox::check_in (const Minibox &b)
+{
+    if (!b.initialized)
+        return;
+    if (!initialized)
+    {
+        *this = b;
+        return;
+    }
+    for (int i=0; i<(int)edge_begin.size(); i++)
+    {
+        edge_begin.at(i) = min(b.edge_begin.at(i),edge_begin.at(i));
+        edge_end.at(i) = max(b.edge_end.at(i),edge_end.at(i));
+    }
+}
+
 long double Minibox::volume ()
 {
     long double volume_ = 1;
@@ -1785,6 +1926,257 @@ static void MST_linkage_core_vector(const int_fast32_t N,
     }
 }
 
+/*
+    k-d tree of the data points for the minimum spanning tree of large point sets. Searches the
+    nearest point which belongs to another component than the query point, the nodes whose points
+    are all in the component of the query are skipped.
+*/
+class linkage_kdtree {
+private:
+    struct kd_node {
+        int_fast32_t begin, end; // range of index
+        int_fast32_t left, right;
+    };
+
+    const double * X;
+    int_fast32_t N;
+    ptrdiff_t dim;
+    vector<int_fast32_t> index;
+    vector<kd_node> nodes;
+    vector<double> lo, hi;          // bounding box of every node
+    const int_fast32_t * component; // component of every point
+    vector<int_fast32_t> node_component; // component of all the points of the node, -1 if they differ
+
+    static const int_fast32_t leaf_size = 8;
+
+    int_fast32_t build(const int_fast32_t begin, const int_fast32_t end)
+    {
+        const int_fast32_t n = (int_fast32_t)nodes.size();
+        kd_node nd = { begin, end, -1, -1 };
+        nodes.push_back(nd);
+        lo.resize(lo.size() + dim);
+        hi.resize(hi.size() + dim);
+        double * const l = &lo[n*dim];
+        double * const h = &hi[n*dim];
+        for (ptrdiff_t k=0; k<dim; k++)
+            l[k] = h[k] = X[index[begin]*dim+k];
+        for (int_fast32_t i=begin+1; i<end; i++)
+            for (ptrdiff_t k=0; k<dim; k++)
+            {
+                const double v = X[index[i]*dim+k];
+                l[k] = min(l[k], v);
+                h[k] = max(h[k], v);
+            }
+        if (end - begin <= leaf_size)
+            return n;
+
+        // split at the median of the widest dimension
+        ptrdiff_t split = 0;
+        for (ptrdiff_t k=1; k<dim; k++)
+            if (h[k] - l[k] > h[split] - l[split])
+                split = k;
+        const int_fast32_t mid = (begin + end) / 2;
+        const double * const Xs = X + split;
+        const ptrdiff_t step = dim;
+        nth_element(index.begin() + begin, index.begin() + mid, index.begin() + end,
+                    [Xs, step](int_fast32_t a, int_fast32_t b) { return Xs[a*step] < Xs[b*step]; });
+        const int_fast32_t left = build(begin, mid);
+        const int_fast32_t right = build(mid, end);
+        nodes[n].left = left;
+        nodes[n].right = right;
+        return n;
+    }
+
+    // squared euclidean distance from p to the bounding box of the node n
+    double lower_bound(const int_fast32_t n, const double * const p) const
+    {
+        const double * const l = &lo[n*dim];
+        const double * const h = &hi[n*dim];
+        double sum = 0;
+        for (ptrdiff_t k=0; k<dim; k++)
+        {
+            const double gap = (p[k] < l[k]) ? l[k] - p[k] : ((p[k] > h[k]) ? p[k] - h[k] : 0);
+            sum += gap*gap;
+        }
+        return sum;
+    }
+
+    template <typename t_dissimilarity>
+    void search(const int_fast32_t n, t_dissimilarity & dist, const int_fast32_t i,
+                double & best, int_fast32_t & best_j) const
+    {
+        const int_fast32_t c = component[i];
+        if (node_component[n] == c)
+            return;
+        const kd_node & nd = nodes[n];
+        if (nd.left < 0)
+        {
+            for (int_fast32_t k=nd.begin; k<nd.end; k++)
+            {
+                const int_fast32_t j = index[k];
+                if (component[j] == c)
+                    continue;
+                const double d = dist(i, j);
+                if (d < best || (d == best && j < best_j))
+                {
+                    best = d;
+                    best_j = j;
+                }
+            }
+            return;
+        }
+        const double * const p = X + i*dim;
+        const double dl = lower_bound(nd.left, p);
+        const double dr = lower_bound(nd.right, p);
+        const int_fast32_t first  = (dl <= dr) ? nd.left : nd.right;
+        const int_fast32_t second = (dl <= dr) ? nd.right : nd.left;
+        if (min(dl, dr) <= best)
+            search(first, dist, i, best, best_j);
+        if (max(dl, dr) <= best)
+            search(second, dist, i, best, best_j);
+    }
+
+public:
+    linkage_kdtree(const double * const _X, const int_fast32_t _N, const ptrdiff_t _dim)
+        : X(_X), N(_N), dim(_dim), index(_N), component(NULL)
+    {
+        for (int_fast32_t i=0; i<N; i++)
+            index[i] = i;
+        nodes.reserve(2*(N/leaf_size+1));
+        build(0, N);
+    }
+
+    void set_components(const int_fast32_t * const _component)
+    {
+        component = _component;
+        node_component.resize(nodes.size());
+        // the children have larger indices than their parent
+        for (int_fast32_t n=(int_fast32_t)nodes.size()-1; n>=0; n--)
+        {
+            const kd_node & nd = nodes[n];
+            int_fast32_t c;
+            if (nd.left < 0)
+            {
+                c = component[index[nd.begin]];
+                for (int_fast32_t k=nd.begin+1; k<nd.end && c>=0; k++)
+                    if (component[index[k]] != c)
+                        c = -1;
+            }
+            else
+            {
+                c = node_component[nd.left];
+                if (node_component[nd.right] != c)
+                    c = -1;
+            }
+            node_component[n] = c;
+        }
+    }
+
+    // nearest point of another component than the point i, the ties go to the lower index
+    template <typename t_dissimilarity>
+    void nearest(t_dissimilarity & dist, const int_fast32_t i, double & best, int_fast32_t & best_j) const
+    {
+        best = numeric_limits<double>::infinity();
+        best_j = -1;
+        search(0, dist, i, best, best_j);
+    }
+};
+
+static inline int_fast32_t find_component(vector<int_fast32_t> & parent, int_fast32_t i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// strict order of the edges, equal distances are ordered by the point indices
+static inline bool edge_less(const double d1, int_fast32_t i1, int_fast32_t j1,
+                             const double d2, int_fast32_t i2, int_fast32_t j2)
+{
+    if (d1 != d2)
+        return d1 < d2;
+    if (i1 > j1) std::swap(i1, j1);
+    if (i2 > j2) std::swap(i2, j2);
+    return (i1 != i2) ? (i1 < i2) : (j1 < j2);
+}
+
+template <typename t_dissimilarity>
+static void MST_linkage_core_kdtree(const int_fast32_t N,
+                                    const ptrdiff_t dim,
+                                    const double * const X,
+                                    t_dissimilarity & dist,
+                                    cluster_result & Z2) {
+/*
+     Hierarchical clustering using the minimum spanning tree, built by Boruvka's algorithm:
+     every round joins each component with its nearest other component, the nearest points are
+     searched in a k-d tree. Takes O(N log N) distances per round instead of the N^2 distances of
+     MST_linkage_core_vector, and finds the same tree. Only for the (squared) euclidean metric
+     and finite data.
+
+     N: integer, number of data points
+     dim: dimension of the data points
+     X: data points
+     dist: function pointer to the metric
+     Z2: output data structure
+*/
+    linkage_kdtree tree(X, N, dim);
+
+    vector<int_fast32_t> parent(N), component(N);
+    vector<int_fast32_t> point_nn(N), comp_i(N), comp_j(N);
+    vector<double> point_dist(N), comp_dist(N);
+    for (int_fast32_t i=0; i<N; i++)
+        parent[i] = i;
+
+    int_fast32_t num_edges = 0;
+    while (num_edges < N-1)
+    {
+        for (int_fast32_t i=0; i<N; i++)
+            component[i] = find_component(parent, i);
+        tree.set_components(&component[0]);
+
+        parallel_for_(Range(0, (int)N), [&](const Range& range)
+        {
+            for (int i=range.start; i<range.end; i++)
+                tree.nearest(dist, i, point_dist[i], point_nn[i]);
+        });
+
+        // the shortest edge of every component
+        fill(comp_i.begin(), comp_i.end(), -1);
+        for (int_fast32_t i=0; i<N; i++)
+        {
+            const int_fast32_t c = component[i];
+            const int_fast32_t j = point_nn[i];
+            if (j < 0)
+                continue;
+            if (comp_i[c] < 0 || edge_less(point_dist[i], i, j, comp_dist[c], comp_i[c], comp_j[c]))
+            {
+                comp_dist[c] = point_dist[i];
+                comp_i[c] = i;
+                comp_j[c] = j;
+            }
+        }
+
+        int_fast32_t new_edges = 0;
+        for (int_fast32_t c=0; c<N; c++)
+        {
+            if (comp_i[c] < 0)
+                continue;
+            const int_fast32_t a = find_component(parent, comp_i[c]);
+            const int_fast32_t b = find_component(parent, comp_j[c]);
+            if (a == b) // both components have chosen this edge
+                continue;
+            parent[a] = b;
+            Z2.append(comp_i[c], comp_j[c], comp_dist[c]);
+            new_edges++;
+        }
+        CV_Assert(new_edges > 0);
+        num_edges += new_edges;
+    }
+}
+
 class linkage_output {
 private:
     double * Z;
@@ -1999,6 +2391,9 @@ private:
     }
 };
 
+// below this number of points the exhaustive minimum spanning tree is faster than the k-d tree
+#define KDTREE_LINKAGE_MIN_POINTS 512
+
 /*Clustering for the "stored data approach": the input are points in a vector space.*/
 static int linkage_vector(double *X, int N, int dim, double * Z, unsigned char method, unsigned char metric)
 {
@@ -2012,7 +2407,10 @@ static int linkage_vector(double *X, int N, int dim, double * Z, unsigned char m
         cluster_result Z2(N-1);
         auto_array_ptr<int_fast32_t> members;
         dissimilarity dist(X, N, dim, members, method, metric, false);
-        MST_linkage_core_vector(N, dist, Z2);
+        if (N >= KDTREE_LINKAGE_MIN_POINTS && metric != METRIC_CITYBLOCK && checkRange(Mat(N, dim, CV_64F, X)))
+            MST_linkage_core_kdtree(N, dim, X, dist, Z2);
+        else
+            MST_linkage_core_vector(N, dist, Z2);
         dist.postprocess(Z2);
         generate_dendrogram(Z, Z2, N);
     } // try
@@ -2061,7 +2459,7 @@ struct HCluster{
     float dist_ext;         // distance where this merge will merge with another
     long double volume;     // volume of the bounding sphere (or bounding box)
     long double volume_ext; // volume of the sphere(or box) + envolvent empty space
-    vector<vector<float> > points; // nD points in this cluster
+    Minibox box;            // bounding box of the nD points in this cluster
     bool max_meaningful;    // is this merge max meaningful ?
     vector<int> max_in_branch; // otherwise which merges are the max_meaningful in this branch
     int min_nfa_in_branch;  // min nfa detected within the chilhood
@@ -2147,6 +2545,8 @@ void MaxMeaningfulClustering::build_merge_info(double *Z, double *X, int N, int
                                                vector< vector<int> > *meaningful_clusters)
 {
 
+    merge_info->reserve(merge_info->size() + N-1);
+
     // walk the whole dendrogram
     for (int i=0; i<(N-1)*4; i=i+4)
     {
@@ -2157,52 +2557,41 @@ void MaxMeaningfulClustering::build_merge_info(double *Z, double *X, int N, int
         int node2  = (int)Z[i+1];
         float dist = (float)Z[i+2];
 
+        // the box of the merge is the box of the boxes of both nodes, the points are not kept
         if (node1<N)
         {
-            vector<float> point;
-            for (int n=0; n<dim; n++)
-                point.push_back((float)X[node1*dim+n]);
-            cluster.points.push_back(point);
+            vector<float> point(X + node1*dim, X + (node1+1)*dim);
+            cluster.box.check_in(&point);
             cluster.elements.push_back((int)node1);
         }
         else
         {
-            for (int ii=0; ii<(int)merge_info->at(node1-N).points.size(); ii++)
-            {
-                cluster.points.push_back(merge_info->at(node1-N).points[ii]);
-                cluster.elements.push_back(merge_info->at(node1-N).elements[ii]);
-            }
+            cluster.box.check_in(merge_info->at(node1-N).box);
+            cluster.elements.insert(cluster.elements.end(),
+                                    merge_info->at(node1-N).elements.begin(),
+                                    merge_info->at(node1-N).elements.end());
             //update the extended volume of node1 using the dist where this cluster merge with another
             merge_info->at(node1-N).dist_ext = dist;
         }
         if (node2<N)
         {
-            vector<float> point;
-            for (int n=0; n<dim; n++)
-                point.push_back((float)X[node2*dim+n]);
-            cluster.points.push_back(point);
+            vector<float> point(X + node2*dim, X + (node2+1)*dim);
+            cluster.box.check_in(&point);
             cluster.elements.push_back((int)node2);
         }
         else
         {
-            for (int ii=0; ii<(int)merge_info->at(node2-N).points.size(); ii++)
-            {
-                cluster.points.push_back(merge_info->at(node2-N).points[ii]);
-                cluster.elements.push_back(merge_info->at(node2-N).elements[ii]);
-            }
+            cluster.box.check_in(merge_info->at(node2-N).box);
+            cluster.elements.insert(cluster.elements.end(),
+                                    merge_info->at(node2-N).elements.begin(),
+                                    merge_info->at(node2-N).elements.end());
 
             //update the extended volume of node2 using the dist where this cluster merge with another
             merge_info->at(node2-N).dist_ext = dist;
         }
 
-        Minibox mb;
-        for (int ii=0; ii<(int)cluster.points.size(); ii++)
-        {
-            mb.check_in(&cluster.points.at(ii));
-        }
-
         cluster.dist   = dist;
-        cluster.volume = mb.volume();
+        cluster.volume = cluster.box.volume();
         if (cluster.volume >= 1)
             cluster.volume = 0.999999;
         if (cluster.volume == 0)
@@ -3930,6 +4319,7 @@ void erGroupingNM(InputArray _img, InputArrayOfArrays _src, vector< vector<ERSta
 
 void erGrouping(InputArray image, InputArrayOfArrays channels, vector<vector<ERStat> > &regions,  vector<vector<Vec2i> > &groups,  vector<Rect> &groups_rects, int method, const string& filename, float minProbability)
 {
+    CV_TRACE_FUNCTION();
     CV_Assert( image.getMat().type() == CV_8UC3 );
     CV_Assert( !channels.empty() );
     CV_Assert( !((method == ERGROUPING_ORIENTATION_ANY) && (filename.empty())) );
@@ -3948,6 +4338,7 @@ void erGrouping(InputArray image, InputArrayOfArrays channels, vector<vector<ERS
 
 void erGrouping(InputArray image, InputArray channel, vector<vector<Point> > contours, CV_OUT std::vector<Rect> &groups_rects, int method, const String& filename, float minProbability)
 {
+    CV_TRACE_FUNCTION();
     CV_Assert( image.getMat().type() == CV_8UC3 );
     CV_Assert( channel.getMat().type() == CV_8UC1 );
     CV_Assert( !((method == ERGROUPING_ORIENTATION_ANY) && (filename.empty())) );
@@ -4035,9 +4426,54 @@ void MSERsToERStats(InputArray image, vector<vector<Point> > &contours, vector<v
   }
 }
 
+// Applies the 1st and 2nd stage filters to each channel. The channels are processed concurrently
+// by copies of the filters when the filters and their classifiers allow it, the copies share the
+// classifiers and each has its own ER storage.
+static void runERFiltersOnChannels(const vector<Mat>& channels, const Ptr<ERFilter>& er_filter1,
+                                   const Ptr<ERFilter>& er_filter2, vector<vector<ERStat> >& regions)
+{
+    ERFilterNM* nm1 = dynamic_cast<ERFilterNM*>(er_filter1.get());
+    ERFilterNM* nm2 = dynamic_cast<ERFilterNM*>(er_filter2.get());
+    int nchannels = (int)channels.size();
+
+    if (nchannels < 2 || getNumThreads() <= 1 || !nm1 || !nm2 ||
+        !nm1->isCallbackThreadSafe() || !nm2->isCallbackThreadSafe())
+    {
+        for (int c = 0; c < nchannels; c++)
+        {
+            er_filter1->run(channels[c], regions[c]);
+            er_filter2->run(channels[c], regions[c]);
+        }
+        return;
+    }
+
+    vector<Ptr<ERFilterNM> > filters1(nchannels), filters2(nchannels);
+    filters1[0] = er_filter1.staticCast<ERFilterNM>();
+    filters2[0] = er_filter2.staticCast<ERFilterNM>();
+    for (int c = 1; c < nchannels; c++)
+    {
+        filters1[c] = makePtr<ERFilterNM>(*nm1);
+        filters2[c] = makePtr<ERFilterNM>(*nm2);
+    }
+
+    parallel_for_(Range(0, nchannels), [&](const Range& range)
+    {
+        for (int c = range.start; c < range.end; c++)
+        {
+            filters1[c]->run(channels[c], regions[c]);
+            filters2[c]->run(channels[c], regions[c]);
+        }
+    });
+
+    // the counters are left as the sequential processing leaves them
+    nm1->setCounters(*filters1[nchannels - 1]);
+    nm2->setCounters(*filters2[nchannels - 1]);
+}
+
 // Utility function for scripting
 void detectRegions(InputArray image, const Ptr<ERFilter>& er_filter1, const Ptr<ERFilter>& er_filter2, CV_OUT vector< vector<Point> >& regions)
 {
+    CV_TRACE_FUNCTION();
     // assert correct image type
     CV_Assert( image.type() == CV_8UC1 );
     // at least one ERFilter must be passed
@@ -4089,6 +4525,7 @@ void detectRegions(InputArray image, const Ptr<ERFilter>& er_filter1, const Ptr<
                                            const String& filename,
                                            float minProbability)
 {
+    CV_TRACE_FUNCTION();
     // assert correct image type
     CV_Assert( image.type() == CV_8UC3 );
 
@@ -4096,6 +4533,7 @@ void detectRegions(InputArray image, const Ptr<ERFilter>& er_filter1, const Ptr<
     CV_Assert( !er_filter2.empty() );
 
     // Extract channels to be processed individually
+    CV_TRACE_REGION("extractChannels");
     vector<Mat> channels;
 
     Mat grey;
@@ -4107,13 +4545,11 @@ void detectRegions(InputArray image, const Ptr<ERFilter>& er_filter1, const Ptr<
 
     vector<vector<ERStat> > regions(channels.size());
 
-    // Apply the default cascade classifier to each independent channel (could be done in parallel)
-    for (int c=0; c<(int)channels.size(); c++)
-    {
-        er_filter1->run(channels[c], regions[c]);
-        er_filter2->run(channels[c], regions[c]);
-    }
+    // Apply the default cascade classifier to each independent channel
+    CV_TRACE_REGION_NEXT("runERFilters");
+    runERFiltersOnChannels(channels, er_filter1, er_filter2, regions);
    // Detect character groups
+    CV_TRACE_REGION_NEXT("erGrouping");
     vector< vector<Vec2i> > nm_region_groups;
     erGrouping(image, channels, regions, nm_region_groups, groups_rects, method, filename, minProbability);
 }
@@ -88,6 +88,22 @@ void OCRBeamSearchDecoder::run(Mat& image, Mat& mask, string& output_text, vecto
         component_confidences->clear();
 }
 
+void OCRBeamSearchDecoder::run(const vector<Mat>& images, vector<string>& output_texts,
+                               vector<float>* confidences)
+{
+    output_texts.assign(images.size(), string());
+    if (confidences != NULL)
+        confidences->assign(images.size(), 0.f);
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        Mat image = images[i];
+        vector<float> component_confidences;
+        run(image, output_texts[i], NULL, NULL, &component_confidences, OCR_LEVEL_WORD);
+        if (confidences != NULL && !component_confidences.empty())
+            (*confidences)[i] = component_confidences[0];
+    }
+}
+
 CV_WRAP String OCRBeamSearchDecoder::run(InputArray image, int min_confidence, int component_level)
 {
     std::string output1;
@@ -144,16 +160,31 @@ struct beamSearch_node {
     double score;
     vector<int> segmentation;
     bool expanded;
-    // TODO calculating score of its child would be much faster if we store the last column
-    //      of their "root" path.
+    // last row of the Viterbi table of the segmentation, so that the score of a child is computed
+    // by a single Viterbi step. Empty when the segmentation is not valid.
+    vector<double> viterbi;
 };
 
-bool beam_sort_function ( beamSearch_node a, beamSearch_node b );
-bool beam_sort_function ( beamSearch_node a, beamSearch_node b )
+bool beam_sort_function ( const beamSearch_node& a, const beamSearch_node& b );
+bool beam_sort_function ( const beamSearch_node& a, const beamSearch_node& b )
 {
     return (a.score > b.score);
 }
 
+// decoding state of a single word image
+struct beamSearch_word {
+    vector< beamSearch_node > beam;
+    bool beam_sorted;
+    vector< vector<double> > recognition_probabilities;
+    vector<int> oversegmentation;
+};
+
+// evaluates the sliding windows of all the words at once when the classifier is the default CNN,
+// returns false for other classifiers
+static bool evalClassifierBatch(OCRBeamSearchDecoder::ClassifierCallback* classifier, const vector<Mat>& words,
+                                vector< vector< vector<double> > >& recognition_probabilities,
+                                vector< vector<int> >& oversegmentation);
+
 
 class OCRBeamSearchDecoderImpl CV_FINAL : public OCRBeamSearchDecoder
 {
@@ -232,11 +263,85 @@ public:
         // TODO if input is a text line (not a word) we may need to split into words here!
 
         // do sliding window classification along a cropped word image
-        classifier->eval(src, recognition_probabilities, oversegmentation);
+        classifier->eval(src, word.recognition_probabilities, word.oversegmentation);
+
+        double lp;
+        if (!decode(word, out_sequence, lp))
+            return;
+
+        // fill other (dummy) output parameters
+        if (component_rects != NULL)
+            component_rects->push_back(Rect(0,0,src.cols,src.rows));
+        if (component_texts != NULL)
+            component_texts->push_back(out_sequence);
+        if (component_confidences != NULL)
+            component_confidences->push_back((float)exp(lp));
+
+        return;
+    }
+
+    void run( const vector<Mat>& images,
+              vector<string>& output_texts,
+              vector<float>* confidences) CV_OVERRIDE
+    {
+        int num_words = (int)images.size();
+        vector<Mat> words(num_words);
+        for (int i=0; i<num_words; i++)
+        {
+            CV_Assert( (images[i].type() == CV_8UC1) || (images[i].type() == CV_8UC3) );
+            CV_Assert( (images[i].cols > 0) && (images[i].rows > 0) );
+            if (images[i].type() == CV_8UC3)
+                cvtColor(images[i], words[i], COLOR_RGB2GRAY);
+            else
+                words[i] = images[i];
+        }
+
+        vector< vector< vector<double> > > recognition_probabilities(num_words);
+        vector< vector<int> > oversegmentation(num_words);
+        if (!evalClassifierBatch(classifier.get(), words, recognition_probabilities, oversegmentation))
+        {
+            for (int i=0; i<num_words; i++)
+                classifier->eval(words[i], recognition_probabilities[i], oversegmentation[i]);
+        }
+
+        output_texts.assign(num_words, string());
+        vector<float> word_confidences(num_words, 0.f);
+
+        // the decoding of every word only reads the tables of the decoder
+        parallel_for_(Range(0, num_words), [&](const Range& range)
+        {
+            beamSearch_word state;
+            for (int i=range.start; i<range.end; i++)
+            {
+                state.recognition_probabilities.swap(recognition_probabilities[i]);
+                state.oversegmentation.swap(oversegmentation[i]);
+                double lp;
+                if (decode(state, output_texts[i], lp))
+                    word_confidences[i] = (float)exp(lp);
+            }
+        });
+
+        if (confidences != NULL)
+            confidences->swap(word_confidences);
+    }
+
+private:
+    int win_size;
+    int step_size;
+
+    beamSearch_word word;
+
+    // beam search of the best segmentation of a word, false if the word has less than 2 candidate characters
+    bool decode( beamSearch_word& w, string& out_sequence, double& lp ) const
+    {
+        out_sequence.clear();
+        w.beam.clear();
 
         // if the number of oversegmentation points found is less than 2 we can not do nothing!!
-        if (oversegmentation.size() < 2) return;
+        if (w.oversegmentation.size() < 2) return false;
 
+        vector< vector<double> >& recognition_probabilities = w.recognition_probabilities;
+        vector<int>& oversegmentation = w.oversegmentation;
 
         //NMS of recognitions
         double last_best_p = 0;
@@ -292,8 +397,13 @@ public:
             }
         }
 
+        // the beam never holds more than beam_size nodes plus the one being inserted
+        w.beam.reserve(beam_size+1);
+        w.beam_sorted = true;
+
         // initialize the beam with all possible character's pairs
         int generated_chids = 0;
+        vector<int> childs;
         for (size_t i=0; i<recognition_probabilities.size()-1; i++)
         {
           for (size_t j=i+1; j<recognition_probabilities.size(); j++)
@@ -302,14 +412,16 @@ public:
             beamSearch_node node;
             node.segmentation.push_back((int)i);
             node.segmentation.push_back((int)j);
-            node.score = score_segmentation(node.segmentation, out_sequence);
-            vector< vector<int> > childs = generate_childs( node.segmentation );
+            node.score = score_segmentation(w, node.segmentation, NULL, &node.viterbi);
+            generate_childs( w, node.segmentation, childs );
             node.expanded = true;
 
-            beam.push_back( node );
+            if (!w.beam.empty() && node.score > w.beam.back().score)
+                w.beam_sorted = false;
+            w.beam.push_back( node );
 
             if (!childs.empty())
-              update_beam( childs );
+              update_beam( w, node, childs );
 
             generated_chids += (int)childs.size();
 
@@ -320,74 +432,74 @@ public:
         {
             generated_chids = 0;
 
-            for (size_t i=0; i<beam.size(); i++)
+            for (size_t i=0; i<w.beam.size(); i++)
             {
-                vector< vector<int> > childs;
-                if (!beam[i].expanded)
+                if (w.beam[i].expanded)
+                    continue;
+                w.beam[i].expanded = true;
+                generate_childs( w, w.beam[i].segmentation, childs );
+                if (!childs.empty())
                 {
-                  childs = generate_childs( beam[i].segmentation );
-                  beam[i].expanded = true;
+                    // the beam is modified by the update
+                    beamSearch_node parent = w.beam[i];
+                    update_beam( w, parent, childs );
                 }
-                if (!childs.empty())
-                    update_beam( childs );
                 generated_chids += (int)childs.size();
             }
         }
 
         // Done! Get the best prediction found into out_sequence
-        double lp = score_segmentation( beam[0].segmentation, out_sequence );
-
-        // fill other (dummy) output parameters
-        component_rects->push_back(Rect(0,0,src.cols,src.rows));
-        component_texts->push_back(out_sequence);
-        component_confidences->push_back((float)exp(lp));
-
-        return;
+        if (!w.beam_sorted)
+            sort(w.beam.begin(), w.beam.end(), beam_sort_function);
+        lp = score_segmentation( w, w.beam[0].segmentation, &out_sequence, NULL );
+        return true;
     }
 
-private:
-    int win_size;
-    int step_size;
-
-    vector< beamSearch_node > beam;
-    vector< vector<double> > recognition_probabilities;
-    vector<int> oversegmentation;
-
-    vector< vector<int> > generate_childs( vector<int> &segmentation )
+    // segmentation points which may follow the last one of a segmentation
+    void generate_childs( const beamSearch_word& w, const vector<int> &segmentation, vector<int>& childs ) const
     {
-
-        vector< vector<int> > childs;
-        for (size_t i=segmentation[segmentation.size()-1]+1; i<oversegmentation.size(); i++)
-        {
-            int seg_point = (int)i;
-            if (find(segmentation.begin(), segmentation.end(), seg_point) == segmentation.end())
-            {
-                vector<int> child = segmentation;
-                child.push_back(seg_point);
-                childs.push_back(child);
-            }
-        }
-        return childs;
+        childs.clear();
+        for (size_t i=segmentation[segmentation.size()-1]+1; i<w.oversegmentation.size(); i++)
+            childs.push_back((int)i);
     }
 
-    void update_beam ( vector< vector<int> > &childs )
+    void update_beam ( beamSearch_word& w, const beamSearch_node& parent, const vector<int>& childs ) const
     {
-        string out_sequence;
+        vector<beamSearch_node>& beam = w.beam;
         double min_score = -DBL_MAX; //min score value to be part of the beam
         if ((int)beam.size() >= beam_size)
+        {
+            if (!w.beam_sorted)
+            {
+                sort(beam.begin(),beam.end(),beam_sort_function);
+                w.beam_sorted = true;
+            }
             min_score = beam[beam_size-1].score; //last element has the lowest score
+        }
 
         for (size_t i=0; i<childs.size(); i++)
         {
-            double score = score_segmentation(childs[i], out_sequence);
+            beamSearch_node node;
+            double score = extend_segmentation(w, parent, childs[i], node.viterbi);
             if (score > min_score)
             {
-                beamSearch_node node;
                 node.score = score;
-                node.segmentation = childs[i];
+                node.segmentation.reserve(parent.segmentation.size()+1);
+                node.segmentation = parent.segmentation;
+                node.segmentation.push_back(childs[i]);
                 node.expanded = false;
-                beam.push_back(node);
-                sort(beam.begin(),beam.end(),beam_sort_function);
+
+                if (w.beam_sorted)
+                {
+                    vector<beamSearch_node>::iterator pos = upper_bound(beam.begin(), beam.end(), node, beam_sort_function);
+                    beam.insert(pos, std::move(node));
+                }
+                else
+                {
+                    beam.push_back(std::move(node));
+                    sort(beam.begin(),beam.end(),beam_sort_function);
+                    w.beam_sorted = true;
+                }
                 if ((int)beam.size() > beam_size)
                 {
                     beam.erase(beam.begin()+beam_size,beam.end());
@@ -397,8 +509,22 @@ private:
         }
     }
 
+    // whether two consecutive characters are neither too far apart nor overlap too much
+    bool valid_interdist( const beamSearch_word& w, int first, int second ) const
+    {
+        float interdist = (float)w.oversegmentation[second]*step_size
+                          - (float)w.oversegmentation[first]*step_size;
+        if ((float)interdist/win_size > 2.25) // TODO explain how did you set this thrs
+            return false;
+        if ((float)interdist/win_size < 0.15) // TODO explain how did you set this thrs
+            return false;
+        return true;
+    }
 
-    double score_segmentation( vector<int> &segmentation, string& outstring )
+    // score of a segmentation, optionally with its best character sequence and the last row
+    // of its Viterbi table
+    double score_segmentation( const beamSearch_word& w, const vector<int> &segmentation,
+                               string* outstring, vector<double>* viterbi ) const
     {
 
         // Score Heuristics:
@@ -407,23 +533,13 @@ private:
         //       in other cases we do it because the overlapping between two chars is too large
         // TODO  Add more heuristics (e.g. penalize large inter-character variance)
 
-        Mat interdist ((int)segmentation.size()-1, 1, CV_32F, 1);
+        if (viterbi != NULL)
+            viterbi->clear();
         for (size_t i=0; i<segmentation.size()-1; i++)
         {
-          interdist.at<float>((int)i,0) = (float)oversegmentation[segmentation[(int)i+1]]*step_size
-                                          - (float)oversegmentation[segmentation[(int)i]]*step_size;
-          if ((float)interdist.at<float>((int)i,0)/win_size > 2.25) // TODO explain how did you set this thrs
-          {
-             return -DBL_MAX;
-          }
-          if ((float)interdist.at<float>((int)i,0)/win_size < 0.15) // TODO explain how did you set this thrs
-          {
+          if (!valid_interdist(w, segmentation[i], segmentation[i+1]))
              return -DBL_MAX;
-          }
         }
-        Scalar m, std;
-        meanStdDev(interdist, m, std);
-        //double interdist_std = std[0];
 
         //TODO Extracting start probs from lexicon (if we have it) may boost accuracy!
         vector<double> start_p(vocabulary.size());
@@ -433,13 +549,16 @@ private:
 
         Mat V = Mat::ones((int)segmentation.size(),(int)vocabulary.size(),CV_64FC1);
         V = V * -DBL_MAX;
-        vector<string> path(vocabulary.size());
+        vector<string> path;
+        if (outstring != NULL)
+            path.resize(vocabulary.size());
 
         // Initialize base cases (t == 0)
         for (int i=0; i<(int)vocabulary.size(); i++)
         {
-            V.at<double>(0,i) = start_p[i] + recognition_probabilities[segmentation[0]][i];
-            path[i] = vocabulary.at(i);
+            V.at<double>(0,i) = start_p[i] + w.recognition_probabilities[segmentation[0]][i];
+            if (outstring != NULL)
+                path[i] = vocabulary.at(i);
         }
 
 
@@ -447,7 +566,9 @@ private:
         for (int t=1; t<(int)segmentation.size(); t++)
         {
 
-            vector<string> newpath(vocabulary.size());
+            vector<string> newpath;
+            if (outstring != NULL)
+                newpath.resize(vocabulary.size());
 
             for (int i=0; i<(int)vocabulary.size(); i++)
             {
@@ -455,7 +576,7 @@ private:
                 int best_idx = 0;
                 for (int j=0; j<(int)vocabulary.size(); j++)
                 {
-                    double prob = V.at<double>(t-1,j) + transition_p.at<double>(j,i) + recognition_probabilities[segmentation[t]][i];
+                    double prob = V.at<double>(t-1,j) + transition_p.at<double>(j,i) + w.recognition_probabilities[segmentation[t]][i];
                     if ( prob > max_prob)
                     {
                         max_prob = prob;
@@ -464,7 +585,8 @@ private:
                 }
 
                 V.at<double>(t,i) = max_prob;
-                newpath[i] = path[best_idx] + vocabulary.at(i);
+                if (outstring != NULL)
+                    newpath[i] = path[best_idx] + vocabulary.at(i);
             }
 
             // Don't need to remember the old paths
@@ -473,9 +595,10 @@ private:
 
         double max_prob = -DBL_MAX;
         int best_idx = 0;
+        const double* last = V.ptr<double>((int)segmentation.size()-1);
         for (int i=0; i<(int)vocabulary.size(); i++)
         {
-            double prob = V.at<double>((int)segmentation.size()-1,i);
+            double prob = last[i];
             if ( prob > max_prob)
             {
                 max_prob = prob;
@@ -483,12 +606,42 @@ private:
             }
         }
 
-        outstring = path[best_idx];
+        if (outstring != NULL)
+            *outstring = path[best_idx];
+        if (viterbi != NULL)
+            viterbi->assign(last, last + vocabulary.size());
         return (max_prob / (segmentation.size()-1));
     }
 
-};
+    // score of the parent segmentation followed by seg_point, from the Viterbi row of the parent
+    double extend_segmentation( const beamSearch_word& w, const beamSearch_node& parent, int seg_point,
+                                vector<double>& viterbi ) const
+    {
+        viterbi.clear();
+        // a segmentation with an invalid prefix is not valid
+        if (parent.viterbi.empty() || !valid_interdist(w, parent.segmentation.back(), seg_point))
+            return -DBL_MAX;
+
+        const vector<double>& rp = w.recognition_probabilities[seg_point];
+        viterbi.resize(vocabulary.size());
+        double best_prob = -DBL_MAX;
+        for (int i=0; i<(int)vocabulary.size(); i++)
+        {
+            double max_prob = -DBL_MAX;
+            for (int j=0; j<(int)vocabulary.size(); j++)
+            {
+                double prob = parent.viterbi[j] + transition_p.at<double>(j,i) + rp[i];
+                if ( prob > max_prob)
+                    max_prob = prob;
+            }
+            viterbi[i] = max_prob;
+            if ( max_prob > best_prob)
+                best_prob = max_prob;
+        }
+        return (best_prob / parent.segmentation.size());
+    }
 
+};
 Ptr<OCRBeamSearchDecoder> OCRBeamSearchDecoder::create( Ptr<OCRBeamSearchDecoder::ClassifierCallback> _classifier,
                                                         const string& _vocabulary,
                                                         InputArray transition_p,
@@ -518,6 +671,9 @@ public:
     ~OCRBeamSearchClassifierCNN() CV_OVERRIDE {}
 
     void eval( InputArray src, vector< vector<double> >& recognition_probabilities, vector<int>& oversegmentation ) CV_OVERRIDE;
+    // classifies the sliding windows of several word images together
+    void evalBatch( const vector<Mat>& words, vector< vector< vector<double> > >& recognition_probabilities,
+                    vector< vector<int> >& oversegmentation );
 
     int getWindowSize() {return window_size;}
     int getStepSize() {return step_size;}
@@ -578,130 +734,181 @@ void OCRBeamSearchClassifierCNN::eval( InputArray _src, vector< vector<double> >
 {
 
     CV_Assert(( _src.getMat().type() == CV_8UC3 ) || ( _src.getMat().type() == CV_8UC1 ));
-    if (!recognition_probabilities.empty())
-    {
-        for (size_t i=0; i<recognition_probabilities.size(); i++)
-            recognition_probabilities[i].clear();
-    }
-    recognition_probabilities.clear();
-    oversegmentation.clear();
 
+    vector<Mat> words(1, _src.getMat());
+    vector< vector< vector<double> > > word_probabilities;
+    vector< vector<int> > word_oversegmentation;
+    evalBatch(words, word_probabilities, word_oversegmentation);
 
-    Mat src = _src.getMat();
-    if(src.type() == CV_8UC3)
-    {
-        cvtColor(src,src,COLOR_RGB2GRAY);
-    }
+    recognition_probabilities.swap(word_probabilities[0]);
+    oversegmentation.swap(word_oversegmentation[0]);
+}
 
-    resize(src,src,Size(window_size*src.cols/src.rows,window_size),0,0,INTER_LINEAR_EXACT);
+// number of sliding windows whose patches are whitened and convolved together
+#define CNN_BATCH_WINDOWS 16
 
-    int seg_points = 0;
+void OCRBeamSearchClassifierCNN::evalBatch( const vector<Mat>& words,
+                                            vector< vector< vector<double> > >& recognition_probabilities,
+                                            vector< vector<int> >& oversegmentation )
+{
+    int num_words = (int)words.size();
+    recognition_probabilities.assign(num_words, vector< vector<double> >());
+    oversegmentation.assign(num_words, vector<int>());
+
+    // resize the words to the window height and collect the sliding windows of all of them
+    vector<Mat> src(num_words);
+    vector<Vec2i> windows; // word, x
+    for (int w = 0; w < num_words; w++)
+    {
+        CV_Assert(( words[w].type() == CV_8UC3 ) || ( words[w].type() == CV_8UC1 ));
+        Mat img = words[w];
+        if(img.type() == CV_8UC3)
+        {
+            cvtColor(img,img,COLOR_RGB2GRAY);
+        }
 
-    Mat quad;
-    Mat tmp;
-    Mat img;
+        resize(img,src[w],Size(window_size*img.cols/img.rows,window_size),0,0,INTER_LINEAR_EXACT);
 
-    int sz = src.cols - window_size;
+        int seg_points = 0;
+        int sz = src[w].cols - window_size;
+        for (int x_c = 0; x_c <= sz; x_c += step_size)
+        {
+            windows.push_back(Vec2i(w, x_c));
+            oversegmentation[w].push_back(seg_points);
+            seg_points++;
+        }
+        recognition_probabilities[w].resize(seg_points);
+    }
+    if (windows.empty())
+        return;
+
+    // position and quad of all the patches of a window, the quads (12x12) are numbered from 1 by columns
     int sz_window_quad = window_size - quad_size;
     int sz_half_quad = (int)(quad_size/2-1);
     int sz_quad_patch = quad_size - patch_size;
-    // begin sliding window loop foreach detection window
-    for (int x_c = 0; x_c <= sz; x_c += step_size)
+    vector<Point> patch_pos;
+    vector<int> patch_quad;
+    int quad_id = 1;
+    for (int q_x = 0; q_x <= sz_window_quad; q_x += sz_half_quad)
     {
-
-        img = src(Rect(Point(x_c,0),Size(window_size,window_size)));
-
-        int patch_count = 0;
-        vector< vector<double> > data_pool(9);
-
-
-        int quad_id = 1;
-
-        for (int q_x = 0; q_x <= sz_window_quad; q_x += sz_half_quad)
+        for (int q_y = 0; q_y <= sz_window_quad; q_y += sz_half_quad)
         {
-            for (int q_y = 0; q_y <= sz_window_quad; q_y += sz_half_quad)
+            for (int w_x = 0; w_x <= sz_quad_patch; w_x++)
             {
-                Rect quad_rect = Rect(q_x,q_y,quad_size,quad_size);
-                quad = img(quad_rect);
-
-                //start sliding window (8x8) in each tile and store the patch as row in data_pool
-                for (int w_x = 0; w_x <= sz_quad_patch; w_x++)
+                for (int w_y = 0; w_y <= sz_quad_patch; w_y++)
                 {
-                    for (int w_y = 0; w_y <= sz_quad_patch; w_y++)
-                    {
-                        quad(Rect(w_x,w_y,patch_size,patch_size)).convertTo(tmp, CV_64F);
-                        tmp = tmp.reshape(0,1);
-                        normalizeAndZCA(tmp);
-                        vector<double> patch;
-                        tmp.copyTo(patch);
-                        if ((quad_id == 1)||(quad_id == 2)||(quad_id == 6)||(quad_id == 7))
-                            data_pool[0].insert(data_pool[0].end(),patch.begin(),patch.end());
-                        if ((quad_id == 2)||(quad_id == 7)||(quad_id == 3)||(quad_id == 8)||(quad_id == 4)||(quad_id == 9))
-                            data_pool[1].insert(data_pool[1].end(),patch.begin(),patch.end());
-                        if ((quad_id == 4)||(quad_id == 9)||(quad_id == 5)||(quad_id == 10))
-                            data_pool[2].insert(data_pool[2].end(),patch.begin(),patch.end());
-                        if ((quad_id == 6)||(quad_id == 11)||(quad_id == 16)||(quad_id == 7)||(quad_id == 12)||(quad_id == 17))
-                            data_pool[3].insert(data_pool[3].end(),patch.begin(),patch.end());
-                        if ((quad_id == 7)||(quad_id == 12)||(quad_id == 17)||(quad_id == 8)||(quad_id == 13)||(quad_id == 18)||(quad_id == 9)||(quad_id == 14)||(quad_id == 19))
-                            data_pool[4].insert(data_pool[4].end(),patch.begin(),patch.end());
-                        if ((quad_id == 9)||(quad_id == 14)||(quad_id == 19)||(quad_id == 10)||(quad_id == 15)||(quad_id == 20))
-                            data_pool[5].insert(data_pool[5].end(),patch.begin(),patch.end());
-                        if ((quad_id == 16)||(quad_id == 21)||(quad_id == 17)||(quad_id == 22))
-                            data_pool[6].insert(data_pool[6].end(),patch.begin(),patch.end());
-                        if ((quad_id == 17)||(quad_id == 22)||(quad_id == 18)||(quad_id == 23)||(quad_id == 19)||(quad_id == 24))
-                            data_pool[7].insert(data_pool[7].end(),patch.begin(),patch.end());
-                        if ((quad_id == 19)||(quad_id == 24)||(quad_id == 20)||(quad_id == 25))
-                            data_pool[8].insert(data_pool[8].end(),patch.begin(),patch.end());
-                        patch_count++;
-                    }
+                    patch_pos.push_back(Point(q_x + w_x, q_y + w_y));
+                    patch_quad.push_back(quad_id);
                 }
-
-                quad_id++;
             }
+            quad_id++;
         }
+    }
+    int num_window_quads = quad_id - 1;
+    int num_patches = (int)patch_pos.size();
+
+    // the 9 pools average overlapping groups of quads
+    static const int pool_quads[9][10] = {
+        { 1, 2, 6, 7, 0 },
+        { 2, 7, 3, 8, 4, 9, 0 },
+        { 4, 9, 5, 10, 0 },
+        { 6, 11, 16, 7, 12, 17, 0 },
+        { 7, 12, 17, 8, 13, 18, 9, 14, 19, 0 },
+        { 9, 14, 19, 10, 15, 20, 0 },
+        { 16, 21, 17, 22, 0 },
+        { 17, 22, 18, 23, 19, 24, 0 },
+        { 19, 24, 20, 25, 0 }
+    };
+
+    // without whitening parameters they are computed from the first patch, as the patches are
+    // whitened one by one
+    if ((M.dims == 0) || (P.dims == 0))
+    {
+        Mat first;
+        src[windows[0][0]](Rect(windows[0][1] + patch_pos[0].x, patch_pos[0].y, patch_size, patch_size)).convertTo(first, CV_64F);
+        first = first.reshape(0,1);
+        normalizeAndZCA(first);
+    }
 
-
-        //do dot product of each normalized and whitened patch
-        //each pool is averaged and this yields a representation of 9xD
-        Mat feature = Mat::zeros(9,kernels.rows,CV_64FC1);
-        for (int i=0; i<9; i++)
+    int num_chunks = ((int)windows.size() + CNN_BATCH_WINDOWS - 1) / CNN_BATCH_WINDOWS;
+    parallel_for_(Range(0, num_chunks), [&](const Range& range)
+    {
+        Mat patches, responses, quad_features, feature;
+        for (int chunk = range.start; chunk < range.end; chunk++)
         {
-            Mat pool = Mat(data_pool[i]);
-            pool = pool.reshape(0,(int)data_pool[i].size()/kernels.cols);
-            for (int p=0; p<pool.rows; p++)
+            int first_window = chunk * CNN_BATCH_WINDOWS;
+            int chunk_windows = min(CNN_BATCH_WINDOWS, (int)windows.size() - first_window);
+
+            // every patch (8x8) of the windows is a row of patches
+            patches.create(chunk_windows * num_patches, patch_size * patch_size, CV_64F);
+            for (int k = 0; k < chunk_windows; k++)
             {
-                for (int f=0; f<kernels.rows; f++)
+                const Vec2i& win = windows[first_window + k];
+                Mat img = src[win[0]](Rect(Point(win[1],0),Size(window_size,window_size)));
+                for (int p = 0; p < num_patches; p++)
                 {
-                    feature.row(i).at<double>(0,f) = feature.row(i).at<double>(0,f) + max(0.0,std::abs(pool.row(p).dot(kernels.row(f)))-alpha);
+                    double* row = patches.ptr<double>(k * num_patches + p);
+                    for (int y = 0; y < patch_size; y++)
+                    {
+                        const uchar* s = img.ptr<uchar>(patch_pos[p].y + y) + patch_pos[p].x;
+                        for (int x = 0; x < patch_size; x++)
+                            row[y * patch_size + x] = s[x];
+                    }
                 }
             }
-        }
-        feature = feature.reshape(0,1);
+            normalizeAndZCA(patches);
 
+            // the response of every patch to every kernel
+            gemm(patches, kernels, 1, noArray(), 0, responses, GEMM_2_T);
 
-        // data must be normalized within the range obtained during training
-        double lower = -1.0;
-        double upper =  1.0;
-        for (int k=0; k<feature.cols; k++)
-        {
-            feature.at<double>(0,k) = lower + (upper-lower) *
-                    (feature.at<double>(0,k)-feature_min.at<double>(0,k))/
-                    (feature_max.at<double>(0,k)-feature_min.at<double>(0,k));
-        }
+            for (int k = 0; k < chunk_windows; k++)
+            {
+                const Vec2i& win = windows[first_window + k];
 
-        double *p = new double[nr_class];
-        double predict_label = eval_feature(feature,p);
+                //each pool is averaged and this yields a representation of 9xD
+                quad_features = Mat::zeros(num_window_quads, kernels.rows, CV_64FC1);
+                for (int p = 0; p < num_patches; p++)
+                {
+                    const double* r = responses.ptr<double>(k * num_patches + p);
+                    double* q = quad_features.ptr<double>(patch_quad[p] - 1);
+                    for (int f = 0; f < kernels.rows; f++)
+                        q[f] += max(0.0, std::abs(r[f]) - alpha);
+                }
 
-        if ( (predict_label < 0) || (predict_label > nr_class) )
-            CV_Error(Error::StsOutOfRange, "OCRBeamSearchClassifierCNN::eval Error: unexpected prediction in eval_feature()");
+                feature = Mat::zeros(9, kernels.rows, CV_64FC1);
+                for (int i = 0; i < 9; i++)
+                {
+                    double* pool = feature.ptr<double>(i);
+                    for (int j = 0; pool_quads[i][j] != 0; j++)
+                    {
+                        if (pool_quads[i][j] > num_window_quads)
+                            continue;
+                        const double* q = quad_features.ptr<double>(pool_quads[i][j] - 1);
+                        for (int f = 0; f < kernels.rows; f++)
+                            pool[f] += q[f];
+                    }
+                }
+                feature = feature.reshape(0,1);
 
+                // data must be normalized within the range obtained during training
+                double lower = -1.0;
+                double upper =  1.0;
+                for (int f=0; f<feature.cols; f++)
+                {
+                    feature.at<double>(0,f) = lower + (upper-lower) *
+                            (feature.at<double>(0,f)-feature_min.at<double>(0,f))/
+                            (feature_max.at<double>(0,f)-feature_min.at<double>(0,f));
+                }
 
-        vector<double> recognition_p(p, p+nr_class);
-        recognition_probabilities.push_back(recognition_p);
-        oversegmentation.push_back(seg_points);
-        seg_points++;
-    }
+                vector<double>& recognition_p = recognition_probabilities[win[0]][win[1] / step_size];
+                recognition_p.resize(nr_class);
+                double predict_label = eval_feature(feature, &recognition_p[0]);
 
+                if ( (predict_label < 0) || (predict_label > nr_class) )
+                    CV_Error(Error::StsOutOfRange, "OCRBeamSearchClassifierCNN::eval Error: unexpected prediction in eval_feature()");
+            }
+        }
+    });
 }
 
 // normalize for contrast and apply ZCA whitening to a set of image patches
@@ -711,10 +918,18 @@ void OCRBeamSearchClassifierCNN::normalizeAndZCA(Mat& patches)
     //Normalize for contrast
     for (int i=0; i<patches.rows; i++)
     {
-        Scalar row_mean, row_std;
-        meanStdDev(patches.row(i),row_mean,row_std);
-        row_std[0] = sqrt(pow(row_std[0],2)*patches.cols/(patches.cols-1)+10);
-        patches.row(i) = (patches.row(i) - row_mean[0]) / row_std[0];
+        double* row = patches.ptr<double>(i);
+        double sum = 0, sqsum = 0;
+        for (int k=0; k<patches.cols; k++)
+        {
+            sum += row[k];
+            sqsum += row[k]*row[k];
+        }
+        double row_mean = sum/patches.cols;
+        double row_var = max(sqsum/patches.cols - row_mean*row_mean, 0.);
+        double row_std = sqrt(row_var*patches.cols/(patches.cols-1)+10);
+        for (int k=0; k<patches.cols; k++)
+            row[k] = (row[k] - row_mean) / row_std;
     }
 
 
@@ -744,10 +959,17 @@ void OCRBeamSearchClassifierCNN::normalizeAndZCA(Mat& patches)
         P = V * D * V.t();
     }
 
+    const double* mean = M.ptr<double>();
     for (int i=0; i<patches.rows; i++)
-        patches.row(i) = patches.row(i) - M;
+    {
+        double* row = patches.ptr<double>(i);
+        for (int k=0; k<patches.cols; k++)
+            row[k] -= mean[k];
+    }
 
-    patches = patches * P;
+    Mat whitened;
+    gemm(patches, P, 1, noArray(), 0, whitened);
+    patches = whitened;
 
 }
 
@@ -780,6 +1002,17 @@ double OCRBeamSearchClassifierCNN::eval_feature(Mat& feature, double* prob_estim
     return dec_max_idx;
 }
 
+static bool evalClassifierBatch(OCRBeamSearchDecoder::ClassifierCallback* classifier, const vector<Mat>& words,
+                                vector< vector< vector<double> > >& recognition_probabilities,
+                                vector< vector<int> >& oversegmentation)
+{
+    OCRBeamSearchClassifierCNN* cnn = dynamic_cast<OCRBeamSearchClassifierCNN*>(classifier);
+    if (cnn == NULL)
+        return false;
+    cnn->evalBatch(words, recognition_probabilities, oversegmentation);
+    return true;
+}
+
 Ptr<OCRBeamSearchDecoder::ClassifierCallback> loadOCRBeamSearchClassifierCNN(const String& filename)
 
 {
@@ -6,9 +6,11 @@
 #include "opencv2/imgproc.hpp"
 #include "opencv2/core.hpp"
 #include "opencv2/dnn.hpp"
+#include "opencv2/core/detail/async_promise.hpp"
 
 #include <fstream>
 #include <algorithm>
+#include <future>
 
 using namespace cv::dnn;
 
@@ -17,6 +19,9 @@ namespace cv
 namespace text
 {
 
+// input values of a forward pass, larger batches are split
+static const size_t maxBatchInputSize = (size_t)1 << 24;
+
 class TextDetectorCNNImpl : public TextDetectorCNN
 {
 protected:
@@ -24,19 +29,28 @@ protected:
     std::vector<Size> sizes_;
     int inputChannelCount_;
 
-    void getOutputs(const float* buffer,int nbrTextBoxes,int nCol,
-                               std::vector<Rect>& Bbox, std::vector<float>& confidence, Size inputShape)
+    //! Finishes when the last batch from detectAsync() is processed
+    std::shared_future<void> pipelineTail;
+
+    // boxes of the images of a batch, the first column of the network output is the image index
+    void getOutputs(const float* buffer,int nbrTextBoxes,int nCol, const Size* inputShapes, int batchSize,
+                    std::vector<Rect>* Bbox, std::vector<float>* confidence)
     {
         for(int k = 0; k < nbrTextBoxes; k++)
         {
-            float confidence_ = buffer[k*nCol + 2];
+            const float* box = buffer + k*nCol;
+            float confidence_ = box[2];
             if (confidence_ <= FLT_EPSILON) continue;
 
-            float x_min_f = buffer[k*nCol + 3]*inputShape.width;
-            float y_min_f = buffer[k*nCol + 4]*inputShape.height;
+            int imageId = cvRound(box[0]);
+            if (imageId < 0 || imageId >= batchSize) continue;
+            Size inputShape = inputShapes[imageId];
 
-            float x_max_f = buffer[k*nCol + 5]*inputShape.width;
-            float y_max_f = buffer[k*nCol + 6]*inputShape.height;
+            float x_min_f = box[3]*inputShape.width;
+            float y_min_f = box[4]*inputShape.height;
+
+            float x_max_f = box[5]*inputShape.width;
+            float y_max_f = box[6]*inputShape.height;
 
             int x_min = cvRound(std::max(0.f, x_min_f));
             int y_min = cvRound(std::max(0.f, y_min_f));
@@ -50,11 +64,88 @@ protected:
             int wd = x_max - x_min;
             int ht = y_max - y_min;
 
-            Bbox.push_back(Rect(x_min, y_min, wd, ht));
-            confidence.push_back(confidence_);
+            Bbox[imageId].push_back(Rect(x_min, y_min, wd, ht));
+            confidence[imageId].push_back(confidence_);
         }
     }
 
+    struct Batch
+    {
+        int scale, begin, end;
+    };
+
+    void prepareBatch(const std::vector<Mat>& images, const Batch& batch, Mat& blob) const
+    {
+        std::vector<Mat> batchImages(images.begin() + batch.begin, images.begin() + batch.end);
+        blobFromImages(batchImages, blob, 1, sizes_[batch.scale], Scalar(123, 117, 104), false, false);
+    }
+
+    /** All the images are resized to the same network input at each scale, so they are passed
+     * through the network together, in batches of at most maxBatchInputSize values. The next batch
+     * is prepared while the network runs. The network is used after prev is finished. */
+    void detectImages(const std::vector<Mat>& images, std::vector<std::vector<Rect> >& Bbox,
+                      std::vector<std::vector<float> >& confidence, std::shared_future<void> prev)
+    {
+        int nimages = (int)images.size();
+        Bbox.assign(nimages, std::vector<Rect>());
+        confidence.assign(nimages, std::vector<float>());
+
+        std::vector<Size> imageSizes(nimages);
+        for (int i = 0; i < nimages; i++)
+        {
+            CV_CheckEQ(images[i].channels(), inputChannelCount_, "");
+            imageSizes[i] = images[i].size();
+        }
+
+        std::vector<Batch> batches;
+        for (int s = 0; s < (int)sizes_.size(); s++)
+        {
+            size_t inputSize = (size_t)inputChannelCount_ * sizes_[s].area();
+            int batchSize = (int)std::max((size_t)1, maxBatchInputSize / std::max(inputSize, (size_t)1));
+            for (int begin = 0; begin < nimages; begin += batchSize)
+            {
+                Batch b = { s, begin, std::min(begin + batchSize, nimages) };
+                batches.push_back(b);
+            }
+        }
+
+        Mat blob, nextBlob;
+        if (!batches.empty())
+            prepareBatch(images, batches[0], blob);
+        if (prev.valid())
+            prev.get();
+
+        for (size_t b = 0; b < batches.size(); b++)
+        {
+            // the network may still refer to the buffer of the previous batch
+            nextBlob = Mat();
+            std::future<void> preparing;
+            if (b + 1 < batches.size())
+                preparing = std::async(std::launch::async, [&]() { prepareBatch(images, batches[b + 1], nextBlob); });
+
+            net_.setInput(blob, "data");
+            Mat outputNet = net_.forward();
+            if (preparing.valid())
+                preparing.get();
+
+            int nbrTextBoxes = outputNet.size[2];
+            int nCol = outputNet.size[3];
+            int outputChannelCount = outputNet.size[1];
+            CV_CheckEQ(outputChannelCount, 1, "");
+            const Batch& batch = batches[b];
+            getOutputs((const float*)(outputNet.data), nbrTextBoxes, nCol, &imageSizes[batch.begin],
+                       batch.end - batch.begin, &Bbox[batch.begin], &confidence[batch.begin]);
+
+            std::swap(blob, nextBlob);
+        }
+    }
+
+    void waitPending() const
+    {
+        if (pipelineTail.valid())
+            pipelineTail.wait();
+    }
+
 public:
     TextDetectorCNNImpl(const String& modelArchFilename, const String& modelWeightsFilename, std::vector<Size> detectionSizes) :
         sizes_(detectionSizes)
@@ -64,25 +155,82 @@ public:
         inputChannelCount_ = 3;
     }
 
+    ~TextDetectorCNNImpl() CV_OVERRIDE
+    {
+        waitPending();
+    }
+
     void detect(InputArray inputImage_, std::vector<Rect>& Bbox, std::vector<float>& confidence) CV_OVERRIDE
     {
         CV_CheckEQ(inputImage_.channels(), inputChannelCount_, "");
-        Mat inputImage = inputImage_.getMat();
-        Bbox.resize(0);
-        confidence.resize(0);
+        std::vector<Mat> images(1, inputImage_.getMat());
+        std::vector<std::vector<Rect> > boxes;
+        std::vector<std::vector<float> > confidences;
+        waitPending();
+        detectImages(images, boxes, confidences, std::shared_future<void>());
+        Bbox.swap(boxes[0]);
+        confidence.swap(confidences[0]);
+    }
+
+    void detect(InputArrayOfArrays inputImages, std::vector<std::vector<Rect> >& Bbox,
+                std::vector<std::vector<float> >& confidence) CV_OVERRIDE
+    {
+        std::vector<Mat> images;
+        inputImages.getMatVector(images);
+        waitPending();
+        detectImages(images, Bbox, confidence, std::shared_future<void>());
+    }
 
-        for(size_t i = 0; i < sizes_.size(); i++)
+    AsyncArray detectAsync(InputArrayOfArrays inputImages) CV_OVERRIDE
+    {
+        std::vector<Mat> images;
+        inputImages.getMatVector(images);
+        // the caller may reuse its buffers
+        for (size_t i = 0; i < images.size(); i++)
         {
-            Size inputGeometry = sizes_[i];
-            net_.setInput(blobFromImage(inputImage, 1, inputGeometry, Scalar(123, 117, 104), false, false), "data");
-            Mat outputNet = net_.forward();
-            int nbrTextBoxes = outputNet.size[2];
-            int nCol = outputNet.size[3];
-            int outputChannelCount = outputNet.size[1];
-            CV_CheckEQ(outputChannelCount, 1, "");
-            getOutputs((float*)(outputNet.data), nbrTextBoxes, nCol, Bbox, confidence, inputImage.size());
+            CV_CheckEQ(images[i].channels(), inputChannelCount_, "");
+            images[i] = images[i].clone();
         }
-     }
+
+        AsyncPromise promise;
+        AsyncArray result = promise.getArrayResult();
+
+        std::shared_future<void> prev = pipelineTail;
+        pipelineTail = std::async(std::launch::async, [this, images, prev, promise]() mutable
+        {
+            try
+            {
+                std::vector<std::vector<Rect> > boxes;
+                std::vector<std::vector<float> > confidences;
+                detectImages(images, boxes, confidences, prev);
+
+                size_t total = 0;
+                for (size_t i = 0; i < boxes.size(); i++)
+                    total += boxes[i].size();
+                Mat detections((int)total, 6, CV_32F);
+                int row = 0;
+                for (size_t i = 0; i < boxes.size(); i++)
+                {
+                    for (size_t k = 0; k < boxes[i].size(); k++, row++)
+                    {
+                        float* d = detections.ptr<float>(row);
+                        const Rect& r = boxes[i][k];
+                        d[0] = (float)i;
+                        d[1] = (float)r.x; d[2] = (float)r.y;
+                        d[3] = (float)r.width; d[4] = (float)r.height;
+                        d[5] = confidences[i][k];
+                    }
+                }
+                promise.setValue(detections);
+            }
+            catch (const cv::Exception& e)
+            {
+                promise.setException(e);
+            }
+        }).share();
+
+        return result;
+    }
 };
 
 Ptr<TextDetectorCNN> TextDetectorCNN::create(const String &modelArchFilename, const String &modelWeightsFilename, std::vector<Size> detectionSizes)
@@ -4,6 +4,7 @@
 #include "precomp.hpp"
 #include "opencv2/core.hpp"
 #include "opencv2/imgproc.hpp"
+#include "opencv2/core/utils/trace.hpp"
 
 #include <unordered_map>
 #include <limits>
@@ -800,11 +801,13 @@ vector<cv::Rect> findValidChains(const Mat& input_image, const Mat& SWTImage, co
 
 void detectTextSWT(InputArray input_, CV_OUT std::vector<cv::Rect>& result, bool dark_on_light, OutputArray & draw /*=noArray()*/, OutputArray & chainBBs /*=noArray()*/)
 {
+    CV_TRACE_FUNCTION();
     CV_CheckTypeEQ(input_.type(), CV_8UC3, "");
 
     Mat input = input_.getMat();
 
     // Convert to grayscale
+    CV_TRACE_REGION("edgesAndGradients");
     Mat grayImage;
     cvtColor(input, grayImage, COLOR_BGR2GRAY);
     // Create Canny Image
@@ -829,6 +832,7 @@ void detectTextSWT(InputArray input_, CV_OUT std::vector<cv::Rect>& result, bool
     std::vector<Ray> rays;
     Mat SWTImage( input.size(), CV_32FC1 );
 
+    CV_TRACE_REGION_NEXT("strokeWidthTransform");
     SWTFirstPass (canny_edge_image, gradientX, gradientY, dark_on_light, SWTImage, rays );
 
     SWTSecondPass ( SWTImage, rays );
@@ -836,12 +840,14 @@ void detectTextSWT(InputArray input_, CV_OUT std::vector<cv::Rect>& result, bool
     Mat normalised_image(input.size(), CV_8UC1);
     normalizeAndScale(SWTImage, normalised_image);
 
+    CV_TRACE_REGION_NEXT("components");
     // Calculate legally connected components from SWT and gradient image.
     // return type is a vector of vectors, where each outer vector is a component and
     // the inner vector contains the (y,x) of each pixel in that component.
     std::vector<std::vector<SWTPoint> > components = getComponents(SWTImage);
     std::vector<Component> validComponents = filterComponents(SWTImage, components, false);
 
+    CV_TRACE_REGION_NEXT("findValidChains");
     vector<cv::Rect> outTextRegions;
 
     result = findValidChains(input, SWTImage, validComponents, draw, outTextRegions);
@@ -74,6 +74,34 @@ TEST_P(Detection, sample)
     EXPECT_GT(groups_boxes.size(), 3u);
 }
 
+TEST_P(Detection, concurrent_channels_match_sequential)
+{
+    InitERFilter();
+
+    if (GET_PARAM(1))
+        throw SkipTestException("the grouping mode does not matter here");
+    Mat src = cv::imread(findDataFile(GET_PARAM(0)));
+    ASSERT_FALSE(src.empty());
+
+    std::vector<Rect> rects_parallel, rects_again, rects_sequential;
+    detectRegions(src, er_filter1, er_filter2, rects_parallel);
+    // the second run reuses the storage of the filters
+    detectRegions(src, er_filter1, er_filter2, rects_again);
+
+    int nthreads = getNumThreads();
+    setNumThreads(1);
+    detectRegions(src, er_filter1, er_filter2, rects_sequential);
+    setNumThreads(nthreads);
+
+    ASSERT_EQ(rects_sequential.size(), rects_parallel.size());
+    ASSERT_EQ(rects_sequential.size(), rects_again.size());
+    for (size_t i = 0; i < rects_sequential.size(); i++)
+    {
+        EXPECT_EQ(rects_sequential[i], rects_parallel[i]);
+        EXPECT_EQ(rects_sequential[i], rects_again[i]);
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(Text, Detection,
     testing::Combine(
         testing::Values(
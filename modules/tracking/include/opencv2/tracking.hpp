@@ -148,6 +148,45 @@ public:
     virtual void setFeatureExtractor(FeatureExtractorCallbackFN callback, bool pca_func = false) = 0;
 };
 
+/** @brief Tracks several targets of one video at once.
+
+The targets are updated in parallel and the per frame work which does not depend on the target is done once
+per frame: the color conversions of TrackerCSRT and the half sized frame of TrackerKCF. When the patches of
+the TrackerKCF targets cover more pixels than the frame, e.g. for many or overlapping targets, their gray and
+color-names features are cropped from the features of the whole frame instead of being computed per patch.
+The results are the same as updating every tracker on its own.
+
+Trackers of other types are supported too, they are updated on the frame as is.
+*/
+class CV_EXPORTS_W MultiTargetTracker
+{
+protected:
+    MultiTargetTracker();  // use ::create()
+public:
+    virtual ~MultiTargetTracker();
+
+    /** @brief Initializes the tracker with a known bounding box and adds it as a new target
+    @param tracker tracker instance, it must not be shared with other targets
+    @param image the initial frame
+    @param boundingBox the initial bounding box of the target
+    @return index of the target
+    */
+    CV_WRAP virtual int add(const Ptr<Tracker>& tracker, InputArray image, const Rect& boundingBox) = 0;
+
+    /** @brief Updates all targets on the next frame
+    @param image the current frame
+    @param boundingBoxes bounding boxes of the targets in the order they were added
+    @param found whether the target was located, the bounding box of a lost target is left unchanged
+    */
+    CV_WRAP virtual void update(InputArray image, CV_OUT std::vector<Rect>& boundingBoxes, CV_OUT std::vector<uchar>& found) = 0;
+
+    //! Returns the number of targets
+    CV_WRAP virtual int getTargetCount() const = 0;
+
+    static CV_WRAP
+    Ptr<MultiTargetTracker> create();
+};
+
 
 //! @}
 
@@ -176,6 +176,20 @@ public:
     virtual std::vector<float> compute(const std::vector<cv::Mat> &descrs1,
                                        const std::vector<cv::Mat> &descrs2) = 0;
 
+    ///
+    /// \brief Computes distances between all pairs of two sets of descriptors.
+    /// The default implementation calls compute() for every required pair.
+    /// \param[in] descrs1 First descriptors, one per row of the result.
+    /// \param[in] descrs2 Second descriptors, one per column of the result.
+    /// \param[in] mask Optional CV_8U matrix of descrs1.size() x descrs2.size()
+    /// elements, only the distances of its non-zero elements are required.
+    /// \param[out] distances CV_32F matrix of descrs1.size() x descrs2.size()
+    /// distances, the elements which are not required may be left as 1.
+    ///
+    virtual void computeMatrix(const std::vector<cv::Mat> &descrs1,
+                               const std::vector<cv::Mat> &descrs2,
+                               const cv::Mat &mask, CV_OUT cv::Mat &distances);
+
     virtual ~IDescriptorDistance() {}
 };
 
@@ -209,6 +223,18 @@ public:
         const std::vector<cv::Mat> &descrs1,
         const std::vector<cv::Mat> &descrs2) override;
 
+    ///
+    /// \brief Computes distances between all pairs of descriptors with one
+    /// matrix product of the stacked descriptors, the mask is not used.
+    /// \param[in] descrs1 First descriptors, one per row of the result.
+    /// \param[in] descrs2 Second descriptors, one per column of the result.
+    /// \param[in] mask Not used, all distances are computed.
+    /// \param[out] distances CV_32F matrix of distances.
+    ///
+    void computeMatrix(const std::vector<cv::Mat> &descrs1,
+                       const std::vector<cv::Mat> &descrs2,
+                       const cv::Mat &mask, CV_OUT cv::Mat &distances) override;
+
 private:
     cv::Size descriptor_size_;
 };
@@ -250,6 +276,17 @@ public:
     ///
     std::vector<float> compute(const std::vector<cv::Mat> &descrs1,
                                const std::vector<cv::Mat> &descrs2) override;
+    ///
+    /// \brief Computes distances between the required pairs of descriptors
+    /// in parallel.
+    /// \param[in] descrs1 First descriptors, one per row of the result.
+    /// \param[in] descrs2 Second descriptors, one per column of the result.
+    /// \param[in] mask Optional CV_8U mask of the required pairs.
+    /// \param[out] distances CV_32F matrix of distances.
+    ///
+    void computeMatrix(const std::vector<cv::Mat> &descrs1,
+                       const std::vector<cv::Mat> &descrs2,
+                       const cv::Mat &mask, CV_OUT cv::Mat &distances) override;
     virtual ~MatchTemplateDistance() {}
 
 private:
@@ -0,0 +1,344 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include "featureMaps.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv {
+namespace detail {
+inline namespace tracking {
+
+class ParallelColorNames : public ParallelLoopBody
+{
+public:
+    ParallelColorNames(const Mat& _src, Mat& _dst) : src(_src), dst(_dst) {}
+
+    virtual void operator()(const Range& range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            const uchar* s = src.ptr<uchar>(i);
+            float* d = dst.ptr<float>(i);
+            for (int j = 0; j < src.cols; j++, s += 3, d += 10)
+            {
+                // 32 bins per channel, the same as floor(value / 8)
+                int index = (s[2] >> 3) + ((s[1] >> 3) << 5) + ((s[0] >> 3) << 10);
+                memcpy(d, ColorNames[index], 10 * sizeof(float));
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+
+    ParallelColorNames& operator=(const ParallelColorNames&);
+};
+
+void computeColorNames(const Mat& bgr, Mat& dst)
+{
+    CV_Assert(bgr.type() == CV_8UC3);
+    dst.create(bgr.size(), CV_32FC(10));
+    parallel_for_(Range(0, bgr.rows), ParallelColorNames(bgr, dst), bgr.total() / (double)(1 << 16));
+}
+
+// unit vectors of the orientation bins
+static const float fhogUU[9] = {1.000f, 0.9397f, 0.7660f, 0.5000f, 0.1736f, -0.1736f, -0.5000f, -0.7660f, -0.9397f};
+static const float fhogVV[9] = {0.000f, 0.3420f, 0.6428f, 0.8660f, 0.9848f,  0.9848f,  0.8660f,  0.6428f,  0.3420f};
+
+/** Gradient of the channel with the largest magnitude, snapped to one of the 18 orientations */
+class ParallelFHOGGradient : public ParallelLoopBody
+{
+public:
+    ParallelFHOGGradient(const Mat& _im, Mat& _mag, Mat& _ori) : im(_im), mag(_mag), ori(_ori) {}
+
+    virtual void operator()(const Range& range) const CV_OVERRIDE
+    {
+        const int width = mag.cols;
+        const int half = FHOGFeatureMap::numOrient / 2;
+        for (int y = range.start; y < range.end; y++)
+        {
+            const float* up = im.ptr<float>(y - 1);
+            const float* row = im.ptr<float>(y);
+            const float* down = im.ptr<float>(y + 1);
+            float* m = mag.ptr<float>(y);
+            int* o = ori.ptr<int>(y);
+
+            int x = 1;
+#if CV_SIMD128
+            const v_float32x4 v_zero = v_setzero_f32();
+            for (; x <= width - 5; x += 4)
+            {
+                v_float32x4 lb, lg, lr, rb, rg, rr, ub, ug, ur, db, dg, dr;
+                v_load_deinterleave(row + 3*(x-1), lb, lg, lr);
+                v_load_deinterleave(row + 3*(x+1), rb, rg, rr);
+                v_load_deinterleave(up + 3*x, ub, ug, ur);
+                v_load_deinterleave(down + 3*x, db, dg, dr);
+
+                v_float32x4 dx = rr - lr, dy = dr - ur;
+                v_float32x4 v = dx*dx + dy*dy;
+                v_float32x4 dxg = rg - lg, dyg = dg - ug;
+                v_float32x4 vg = dxg*dxg + dyg*dyg;
+                v_float32x4 dxb = rb - lb, dyb = db - ub;
+                v_float32x4 vb = dxb*dxb + dyb*dyb;
+
+                v_float32x4 mask = vg > v;
+                v = v_select(mask, vg, v); dx = v_select(mask, dxg, dx); dy = v_select(mask, dyg, dy);
+                mask = vb > v;
+                v = v_select(mask, vb, v); dx = v_select(mask, dxb, dx); dy = v_select(mask, dyb, dy);
+
+                v_float32x4 best = v_zero;
+                v_int32x4 best_o = v_setzero_s32();
+                for (int k = 0; k < half; k++)
+                {
+                    v_float32x4 dot = v_setall_f32(fhogUU[k])*dx + v_setall_f32(fhogVV[k])*dy;
+                    mask = dot > best;
+                    best = v_select(mask, dot, best);
+                    best_o = v_select(v_reinterpret_as_s32(mask), v_setall_s32(k), best_o);
+                    dot = v_zero - dot;
+                    mask = dot > best;
+                    best = v_select(mask, dot, best);
+                    best_o = v_select(v_reinterpret_as_s32(mask), v_setall_s32(k + half), best_o);
+                }
+                v_store(m + x, v_sqrt(v));
+                v_store(o + x, best_o);
+            }
+#endif
+            for (; x < width - 1; x++)
+            {
+                const float* s = row + 3*x;
+
+                float dyb = *(down + 3*x) - *(up + 3*x);
+                float dxb = *(s+3) - *(s-3);
+                float vb = dxb*dxb + dyb*dyb;
+
+                float dyg = *(down + 3*x + 1) - *(up + 3*x + 1);
+                float dxg = *(s+4) - *(s-2);
+                float vg = dxg*dxg + dyg*dyg;
+
+                float dy = *(down + 3*x + 2) - *(up + 3*x + 2);
+                float dx = *(s+5) - *(s-1);
+                float v = dx*dx + dy*dy;
+
+                // pick the channel with the strongest gradient
+                if (vg > v) { v = vg; dx = dxg; dy = dyg; }
+                if (vb > v) { v = vb; dx = dxb; dy = dyb; }
+
+                float best_dot = 0;
+                int best_o = 0;
+                for (int k = 0; k < half; k++)
+                {
+                    float dot = fhogUU[k]*dx + fhogVV[k]*dy;
+                    if (dot > best_dot)
+                    {
+                        best_dot = dot;
+                        best_o = k;
+                    }
+                    else if (-dot > best_dot)
+                    {
+                        best_dot = -dot;
+                        best_o = k + half;
+                    }
+                }
+                m[x] = std::sqrt(v);
+                o[x] = best_o;
+            }
+        }
+    }
+
+private:
+    const Mat& im;
+    Mat& mag;
+    Mat& ori;
+
+    ParallelFHOGGradient& operator=(const ParallelFHOGGradient&);
+};
+
+/** Bilinear voting of the pixels into the histograms, every range of cell rows is only written by its own thread */
+class ParallelFHOGHistograms : public ParallelLoopBody
+{
+public:
+    ParallelFHOGHistograms(const Mat& _mag, const Mat& _ori, int _sbin, Mat& _hist)
+        : mag(_mag), ori(_ori), sbin(_sbin), hist(_hist)
+    {
+        // the horizontal interpolation weights are the same for all rows
+        ixp.resize(mag.cols);
+        vx0.resize(mag.cols);
+        for (int x = 0; x < mag.cols; x++)
+        {
+            float xp = ((float)x + 0.5f) / (float)sbin - 0.5f;
+            ixp[x] = cvFloor(xp);
+            vx0[x] = xp - ixp[x];
+        }
+    }
+
+    virtual void operator()(const Range& range) const CV_OVERRIDE
+    {
+        const int numOrient = FHOGFeatureMap::numOrient;
+        const int bW = hist.cols / numOrient;
+        const int height = mag.rows, width = mag.cols;
+        for (int cy = range.start; cy < range.end; cy++)
+        {
+            float* h = hist.ptr<float>(cy);
+            int y0 = std::max(1, (cy - 1) * sbin), y1 = std::min(height - 1, (cy + 2) * sbin);
+            for (int y = y0; y < y1; y++)
+            {
+                float yp = ((float)y + 0.5f) / (float)sbin - 0.5f;
+                int iyp = cvFloor(yp);
+                float wy;
+                if (iyp == cy)
+                    wy = 1.f - (yp - iyp);
+                else if (iyp + 1 == cy)
+                    wy = yp - iyp;
+                else
+                    continue;
+
+                const float* m = mag.ptr<float>(y);
+                const int* o = ori.ptr<int>(y);
+                for (int x = 1; x < width - 1; x++)
+                {
+                    float v = m[x] * wy;
+                    int ix = ixp[x];
+                    if (ix >= 0)
+                        h[ix*numOrient + o[x]] += (1.f - vx0[x]) * v;
+                    if (ix + 1 < bW)
+                        h[(ix+1)*numOrient + o[x]] += vx0[x] * v;
+                }
+            }
+        }
+    }
+
+private:
+    const Mat& mag;
+    const Mat& ori;
+    int sbin;
+    Mat& hist;
+    std::vector<int> ixp;
+    std::vector<float> vx0;
+
+    ParallelFHOGHistograms& operator=(const ParallelFHOGHistograms&);
+};
+
+void FHOGFeatureMap::compute(const Mat& image, int _cellSize)
+{
+    CV_Assert(image.channels() == 3);
+    CV_Assert(_cellSize > 0);
+    cellSize = _cellSize;
+
+    image.convertTo(image32f, CV_32F, 1.0/255.0);
+
+    const int bW = image.cols / cellSize;
+    const int bH = image.rows / cellSize;
+    const Size visible(bW * cellSize, bH * cellSize);
+
+    hist.create(bH, bW * numOrient, CV_32F);
+    hist.setTo(Scalar::all(0));
+    norm.create(bH, bW, CV_32F);
+    if (visible.width < 3 || visible.height < 3)
+    {
+        norm.setTo(Scalar::all(0));
+        return;
+    }
+
+    mag.create(visible, CV_32F);
+    ori.create(visible, CV_32S);
+    parallel_for_(Range(1, visible.height - 1), ParallelFHOGGradient(image32f, mag, ori),
+                  visible.area() / (double)(1 << 16));
+    parallel_for_(Range(0, bH), ParallelFHOGHistograms(mag, ori, cellSize, hist),
+                  visible.area() / (double)(1 << 16));
+
+    // compute the energy in each block by summing over orientation
+    for (int y = 0; y < bH; y++)
+    {
+        const float* src = hist.ptr<float>(y);
+        float* dst = norm.ptr<float>(y);
+        for (int x = 0; x < bW; x++, src += numOrient)
+        {
+            float e = 0;
+            for (int o = 0; o < numOrient/2; o++)
+                e += (src[o] + src[o + numOrient/2]) * (src[o] + src[o + numOrient/2]);
+            dst[x] = e;
+        }
+    }
+}
+
+Rect FHOGFeatureMap::getValidCells() const
+{
+    return Rect(0, 0, std::max(norm.cols - 2, 0), std::max(norm.rows - 2, 0));
+}
+
+void FHOGFeatureMap::getFeatures(const Rect& roi, Mat& features, int pad) const
+{
+    CV_Assert(cellSize > 0 && pad >= 0);
+
+    // epsilon to avoid division by zero
+    const float eps = 0.0001f;
+    const Rect valid = getValidCells();
+
+    features.create(roi.height + 2*pad, roi.width + 2*pad, CV_32FC(dimHOG));
+    for (int oy = 0; oy < features.rows; oy++)
+    {
+        float* dst = features.ptr<float>(oy);
+        for (int ox = 0; ox < features.cols; ox++, dst += dimHOG)
+        {
+            const int x = roi.x + ox - pad, y = roi.y + oy - pad;
+            if (!valid.contains(Point(x, y)))
+            {
+                // truncation feature
+                memset(dst, 0, (dimHOG - 1) * sizeof(float));
+                dst[dimHOG - 1] = 1.f;
+                continue;
+            }
+
+            const float* p0 = norm.ptr<float>(y) + x;
+            const float* p1 = norm.ptr<float>(y + 1) + x;
+            const float* p2 = norm.ptr<float>(y + 2) + x;
+            float n1 = 1.0f / std::sqrt(p1[1] + p1[2] + p2[1] + p2[2] + eps);
+            float n2 = 1.0f / std::sqrt(p0[1] + p0[2] + p1[1] + p1[2] + eps);
+            float n3 = 1.0f / std::sqrt(p1[0] + p1[1] + p2[0] + p2[1] + eps);
+            float n4 = 1.0f / std::sqrt(p0[0] + p0[1] + p1[0] + p1[1] + eps);
+
+            float t1 = 0, t2 = 0, t3 = 0, t4 = 0;
+            const float* src = hist.ptr<float>(y + 1) + (x + 1)*numOrient;
+            float* d = dst;
+
+            // contrast-sensitive features
+            for (int o = 0; o < numOrient; o++)
+            {
+                float h1 = std::min(src[o]*n1, 0.2f);
+                float h2 = std::min(src[o]*n2, 0.2f);
+                float h3 = std::min(src[o]*n3, 0.2f);
+                float h4 = std::min(src[o]*n4, 0.2f);
+                *(d++) = 0.5f * (h1 + h2 + h3 + h4);
+                t1 += h1;
+                t2 += h2;
+                t3 += h3;
+                t4 += h4;
+            }
+
+            // contrast-insensitive features
+            for (int o = 0; o < numOrient/2; o++)
+            {
+                float sum = src[o] + src[o + numOrient/2];
+                float h1 = std::min(sum*n1, 0.2f);
+                float h2 = std::min(sum*n2, 0.2f);
+                float h3 = std::min(sum*n3, 0.2f);
+                float h4 = std::min(sum*n4, 0.2f);
+                *(d++) = 0.5f * (h1 + h2 + h3 + h4);
+            }
+
+            // texture features
+            *(d++) = 0.2357f * t1;
+            *(d++) = 0.2357f * t2;
+            *(d++) = 0.2357f * t3;
+            *(d++) = 0.2357f * t4;
+            // truncation feature
+            *d = 0;
+        }
+    }
+}
+
+}}}  // namespace
@@ -0,0 +1,51 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_TRACKING_FEATURE_MAPS_HPP__
+#define __OPENCV_TRACKING_FEATURE_MAPS_HPP__
+
+namespace cv {
+namespace detail {
+inline namespace tracking {
+
+/** Color names features (@cite KCF_CN) of a CV_8UC3 BGR image as CV_32FC(10) */
+void computeColorNames(const Mat& bgr, Mat& dst);
+
+/** Felzenszwalb HOG features with 18 contrast sensitive, 9 contrast insensitive, 4 texture
+ * and 1 truncation channel.
+ *
+ * compute() builds the orientation histograms of all cells of an image once, the normalized
+ * features of any rectangle of cells are assembled from them by getFeatures(), so several
+ * regions of one image share the gradient computation.
+ */
+class FHOGFeatureMap
+{
+public:
+    static const int dimHOG = 32;
+    static const int numOrient = 18;
+
+    FHOGFeatureMap() : cellSize(0) {}
+
+    /** computes the cell histograms of a 3 channel image, the values are scaled by 1/255
+     * whatever the depth is, as the original fhog implementation did */
+    void compute(const Mat& image, int cellSize);
+
+    /** rectangle of cells which have a complete 2x2 block neighbourhood, in output cell coordinates */
+    Rect getValidCells() const;
+
+    /** features of the cells inside of roi, surrounded by pad cells on each side, as CV_32FC(32).
+     * The cells outside of getValidCells() get the truncation feature only. */
+    void getFeatures(const Rect& roi, Mat& features, int pad = 1) const;
+
+private:
+    int cellSize;
+    Mat image32f;
+    Mat mag, ori;   // magnitude and orientation bin of the strongest channel gradient per pixel
+    Mat hist;       // numOrient bins per cell
+    Mat norm;       // energy of the contrast insensitive histogram per cell
+};
+
+}}}  // namespace
+
+#endif
@@ -46,6 +46,76 @@ std::vector<size_t> KuhnMunkres::Solve(const cv::Mat& dissimilarity_matrix) {
     return results;
 }
 
+namespace {
+int FindRoot(std::vector<int> &parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+}  // anonymous namespace
+
+std::vector<size_t> KuhnMunkres::SolveGated(const cv::Mat &dissimilarity_matrix, float gate) {
+    CV_Assert(dissimilarity_matrix.type() == CV_32F);
+    const int rows = dissimilarity_matrix.rows;
+    const int cols = dissimilarity_matrix.cols;
+
+    // union-find over the rows [0, rows) and the columns [rows, rows + cols)
+    std::vector<int> parent(rows + cols);
+    for (int i = 0; i < rows + cols; i++) {
+        parent[i] = i;
+    }
+    for (int i = 0; i < rows; i++) {
+        const auto ptr = dissimilarity_matrix.ptr<float>(i);
+        for (int j = 0; j < cols; j++) {
+            if (ptr[j] < gate) {
+                int a = FindRoot(parent, i), b = FindRoot(parent, rows + j);
+                if (a != b) parent[b] = a;
+            }
+        }
+    }
+
+    std::vector<std::vector<int>> component_rows(rows + cols), component_cols(rows + cols);
+    for (int i = 0; i < rows; i++) {
+        component_rows[FindRoot(parent, i)].push_back(i);
+    }
+    for (int j = 0; j < cols; j++) {
+        component_cols[FindRoot(parent, rows + j)].push_back(j);
+    }
+
+    std::vector<size_t> results(static_cast<size_t>(rows), static_cast<size_t>(-1));
+    cv::Mat sub;
+    for (int c = 0; c < rows + cols; c++) {
+        const auto &r = component_rows[c];
+        const auto &k = component_cols[c];
+        if (r.empty() || k.empty()) {
+            continue;
+        }
+        if (r.size() == 1 && k.size() == 1) {
+            results[r[0]] = k[0];
+            continue;
+        }
+
+        sub.create(static_cast<int>(r.size()), static_cast<int>(k.size()), CV_32F);
+        for (size_t i = 0; i < r.size(); i++) {
+            const auto src = dissimilarity_matrix.ptr<float>(r[i]);
+            auto dst = sub.ptr<float>(static_cast<int>(i));
+            for (size_t j = 0; j < k.size(); j++) {
+                dst[j] = src[k[j]];
+            }
+        }
+
+        auto res = KuhnMunkres().Solve(sub);
+        for (size_t i = 0; i < r.size(); i++) {
+            if (res[i] < k.size() && sub.at<float>(static_cast<int>(i), static_cast<int>(res[i])) < gate) {
+                results[r[i]] = k[res[i]];
+            }
+        }
+    }
+    return results;
+}
+
 void KuhnMunkres::TrySimpleCase() {
     auto is_row_visited = std::vector<int>(n_, 0);
     auto is_col_visited = std::vector<int>(n_, 0);
@@ -34,6 +34,18 @@ public:
     ///
     std::vector<size_t> Solve(const cv::Mat &dissimilarity_matrix);
 
+    ///
+    /// \brief Solves the assignment problem separately for every connected
+    /// component of the bipartite graph of the pairs whose dissimilarity is
+    /// less than gate. The pairs at or above the gate are never returned, so
+    /// when they all have the largest dissimilarity of the matrix the result is
+    /// an optimal assignment of the whole matrix without such pairs.
+    /// \param dissimilarity_matrix CV_32F dissimilarity matrix.
+    /// \param gate Pairs with dissimilarity less than gate can be matched.
+    /// \return Optimal column index for each row, -1 for unmatched rows.
+    ///
+    std::vector<size_t> SolveGated(const cv::Mat &dissimilarity_matrix, float gate);
+
 private:
     static constexpr int kStar = 1;
     static constexpr int kPrime = 2;
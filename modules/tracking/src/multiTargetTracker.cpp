@@ -0,0 +1,148 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include "multiTargetTracker.hpp"
+#include "featureMaps.hpp"
+#include "trackerCSRTUtils.hpp"
+
+namespace cv {
+inline namespace tracking {
+namespace impl {
+
+const Mat& SharedFrame::getHSV()
+{
+    AutoLock lock(mtx);
+    if (hsv.empty())
+        hsv = bgr2hsv(getColor());
+    return hsv;
+}
+
+const Mat& SharedFrame::getGray(bool halfSize)
+{
+    AutoLock lock(mtx);
+    Mat& dst = gray[halfSize ? 1 : 0];
+    if (dst.empty())
+    {
+        const Mat& src = halfSize ? getHalf() : img;
+        if (src.channels() > 1)
+            cvtColor(src, dst, COLOR_BGR2GRAY);
+        else
+            dst = src;
+        dst.convertTo(dst, CV_32F, 1.0 / 255.0, -0.5);
+    }
+    return dst;
+}
+
+const Mat& SharedFrame::getCN(bool halfSize)
+{
+    AutoLock lock(mtx);
+    Mat& dst = cn[halfSize ? 1 : 0];
+    if (dst.empty())
+        computeColorNames(halfSize ? getHalf() : img, dst);
+    return dst;
+}
+
+class ParallelTargetsUpdate : public ParallelLoopBody
+{
+public:
+    ParallelTargetsUpdate(std::vector<Ptr<Tracker> >& _trackers, std::vector<SharedFrameTracker*>& _shared,
+                          SharedFrame& _frame, std::vector<Rect>& _boxes, std::vector<uchar>& _found)
+        : trackers(_trackers), shared(_shared), frame(_frame), boxes(_boxes), found(_found)
+    {
+    }
+
+    virtual void operator()(const Range& range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            Rect bb;
+            bool res = shared[i] ? shared[i]->update(frame, bb) : trackers[i]->update(frame.image(), bb);
+            if (res)
+                boxes[i] = bb;
+            found[i] = res ? 1 : 0;
+        }
+    }
+
+private:
+    std::vector<Ptr<Tracker> >& trackers;
+    std::vector<SharedFrameTracker*>& shared;
+    SharedFrame& frame;
+    std::vector<Rect>& boxes;
+    std::vector<uchar>& found;
+
+    ParallelTargetsUpdate& operator=(const ParallelTargetsUpdate&);
+};
+
+class MultiTargetTrackerImpl CV_FINAL : public MultiTargetTracker
+{
+public:
+    virtual int add(const Ptr<Tracker>& tracker, InputArray image, const Rect& boundingBox) CV_OVERRIDE
+    {
+        CV_Assert(!tracker.empty());
+        for (size_t i = 0; i < trackers.size(); i++)
+            CV_Assert(trackers[i] != tracker);
+
+        tracker->init(image, boundingBox);
+        trackers.push_back(tracker);
+        shared.push_back(dynamic_cast<SharedFrameTracker*>(tracker.get()));
+        boxes.push_back(boundingBox);
+        return (int)trackers.size() - 1;
+    }
+
+    virtual void update(InputArray image, std::vector<Rect>& boundingBoxes, std::vector<uchar>& found) CV_OVERRIDE
+    {
+        SharedFrame frame(image.getMat());
+        const Mat& img = frame.image();
+
+        // the features of the whole frame pay off when the patches read more pixels than the frame has
+        double fullSizeArea = 0, halfSizeArea = 0;
+        for (size_t i = 0; i < shared.size(); i++)
+        {
+            if (!shared[i])
+                continue;
+            double full, half;
+            shared[i]->getFeatureMapsArea(full, half);
+            fullSizeArea += full;
+            halfSizeArea += half;
+        }
+        frame.setFeatureMaps(fullSizeArea > (double)img.total(),
+                             halfSizeArea > (double)(img.cols / 2) * (img.rows / 2));
+
+        found.assign(trackers.size(), 0);
+        parallel_for_(Range(0, (int)trackers.size()), ParallelTargetsUpdate(trackers, shared, frame, boxes, found));
+        boundingBoxes = boxes;
+    }
+
+    virtual int getTargetCount() const CV_OVERRIDE
+    {
+        return (int)trackers.size();
+    }
+
+private:
+    std::vector<Ptr<Tracker> > trackers;
+    //! the same trackers if they can be updated on a SharedFrame, null otherwise
+    std::vector<SharedFrameTracker*> shared;
+    std::vector<Rect> boxes;
+};
+
+}  // namespace impl
+
+MultiTargetTracker::MultiTargetTracker()
+{
+    // nothing
+}
+
+MultiTargetTracker::~MultiTargetTracker()
+{
+    // nothing
+}
+
+Ptr<MultiTargetTracker> MultiTargetTracker::create()
+{
+    return makePtr<MultiTargetTrackerImpl>();
+}
+
+}}  // namespace
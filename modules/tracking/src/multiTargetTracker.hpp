@@ -0,0 +1,84 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_TRACKING_MULTI_TARGET_TRACKER_HPP__
+#define __OPENCV_TRACKING_MULTI_TARGET_TRACKER_HPP__
+
+namespace cv {
+inline namespace tracking {
+namespace impl {
+
+/** Frame which is shared by the targets of MultiTargetTracker.
+ * The conversions of the whole frame are computed on the first request and reused by the other targets,
+ * the getters may be called from several threads at once.
+ */
+class SharedFrame
+{
+public:
+    explicit SharedFrame(const Mat& image) : img(image)
+    {
+        featureMaps[0] = featureMaps[1] = false;
+    }
+
+    const Mat& image() const { return img; }
+
+    //! frame with 3 channels, gray frames are converted to BGR
+    const Mat& getColor()
+    {
+        if (img.channels() != 1)
+            return img;
+        AutoLock lock(mtx);
+        if (color.empty())
+            cvtColor(img, color, COLOR_GRAY2BGR);
+        return color;
+    }
+
+    //! HSV conversion of getColor()
+    const Mat& getHSV();
+
+    //! frame resized to the half of its size with INTER_LINEAR_EXACT
+    const Mat& getHalf()
+    {
+        AutoLock lock(mtx);
+        if (half.empty())
+            resize(img, half, Size(img.cols / 2, img.rows / 2), 0, 0, INTER_LINEAR_EXACT);
+        return half;
+    }
+
+    //! KCF gray features of the full or the half sized frame, (gray / 255 - 0.5) as CV_32F
+    const Mat& getGray(bool halfSize);
+
+    //! KCF color names features of the full or the half sized frame as CV_32FC(10)
+    const Mat& getCN(bool halfSize);
+
+    //! whether the targets should crop their features from getGray() and getCN() instead of computing them per patch
+    void setFeatureMaps(bool fullSize, bool halfSize) { featureMaps[0] = fullSize; featureMaps[1] = halfSize; }
+    bool useFeatureMaps(bool halfSize) const { return featureMaps[halfSize ? 1 : 0]; }
+
+private:
+    Mat img;
+    Mat color, hsv, half;
+    Mat gray[2], cn[2];
+    bool featureMaps[2];
+    Mutex mtx;
+};
+
+/** Tracker which can be updated on a SharedFrame */
+class SharedFrameTracker
+{
+public:
+    virtual ~SharedFrameTracker() {}
+
+    virtual bool update(SharedFrame& frame, Rect& boundingBox) = 0;
+
+    //! number of pixels of the frame, and of its half, which are read per update by the feature maps capable descriptors
+    virtual void getFeatureMapsArea(double& fullSizeArea, double& halfSizeArea) const
+    {
+        fullSizeArea = halfSizeArea = 0;
+    }
+};
+
+}}}  // namespace
+
+#endif
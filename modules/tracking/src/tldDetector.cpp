@@ -56,7 +56,7 @@ namespace tld {
 		}
 
 		// Calculate posterior probability, that the patch belongs to the current EC model
-		double TLDDetector::ensembleClassifierNum(const uchar* data)
+		double TLDDetector::ensembleClassifierNum(const uchar* data) const
 		{
 			double p = 0;
 			for (int k = 0; k < (int)classifiers.size(); k++)
@@ -357,10 +357,64 @@ namespace tld {
 			CalcScSrParallelLoopBody& operator= (const CalcScSrParallelLoopBody&);
 		};
 
+		//Variance filter and ensemble classification of the scan windows of one scale, a range of window columns per call.
+		//The variance is read from the integral images of the detector, the classifiers are prepared for the row step of blurred.
+		class ScanWindowsParallelLoopBody: public cv::ParallelLoopBody
+		{
+		public:
+			ScanWindowsParallelLoopBody (const TLDDetector * detector, const Mat& blurred, Size initSize, int dx, int dy, int jmax, uchar* windowFlags):
+				detectorF (detector),
+				blurredF (blurred),
+				windowFlagsF (windowFlags),
+				initSizeF (initSize),
+				dxF (dx),
+				dyF (dy),
+				jmaxF (jmax)
+			{
+			}
+
+			virtual void operator () (const cv::Range & r) const CV_OVERRIDE
+			{
+				const Mat_<double>& intImgP = detectorF->intImgP;
+				const Mat_<double>& intImgP2 = detectorF->intImgP2;
+				const int width = initSizeF.width, height = initSizeF.height;
+				const double area = (double)(width * height);
+				const double threshold = VARIANCE_THRESHOLD * *detectorF->originalVariancePtr;
+				for (int i = r.start; i < r.end; ++i)
+				{
+					const int x = dxF * i;
+					uchar* flags = windowFlagsF + (size_t)i * jmaxF;
+					for (int j = 0; j < jmaxF; j++)
+					{
+						const int y = dyF * j;
+						const double* top = intImgP[y], *bottom = intImgP[y + height];
+						const double* top2 = intImgP2[y], *bottom2 = intImgP2[y + height];
+						double p = (top[x] + bottom[x + width] - top[x + width] - bottom[x]) / area;
+						double p2 = (top2[x] + bottom2[x + width] - top2[x + width] - bottom2[x]) / area;
+						if (!((p2 - p * p) > threshold))
+						{
+							flags[j] = TLDDetector::WINDOW_REJECTED;
+							continue;
+						}
+						flags[j] = detectorF->ensembleClassifierNum(blurredF.ptr<uchar>(y, x)) > ENSEMBLE_THRESHOLD ?
+							TLDDetector::WINDOW_ENSEMBLE_PASSED : TLDDetector::WINDOW_VARIANCE_PASSED;
+					}
+				}
+			}
+		private:
+			const TLDDetector * detectorF;
+			const Mat& blurredF;
+			uchar* windowFlagsF;
+			const Size initSizeF;
+			const int dxF, dyF, jmaxF;
+		private:
+			ScanWindowsParallelLoopBody (const ScanWindowsParallelLoopBody&);
+			ScanWindowsParallelLoopBody& operator= (const ScanWindowsParallelLoopBody&);
+		};
+
 		bool TLDDetector::detect(const Mat& img, const Mat& imgBlurred, Rect2d& res, std::vector<LabeledPatch>& patches, Size initSize)
 		{
 			patches.clear();
-			Mat tmp;
 			int dx = initSize.width / 10, dy = initSize.height / 10;
 			Size2d size = img.size();
 			double scale = 1.0;
@@ -369,51 +423,64 @@ namespace tld {
 			Rect2d maxScRect;
 			int scaleID;
 
-			resized_imgs.clear ();
-			blurred_imgs.clear ();
 			varBuffer.clear ();
 			ensBuffer.clear ();
 			varScaleIDs.clear ();
 			ensScaleIDs.clear ();
 
 			//Detection part
-			//Generate windows and filter by variance
+			//Generate windows, filter them by variance and classify them by the ensemble, one scale at a time.
+			//The pyramid buffers are kept between the frames.
 			scaleID = 0;
-			resized_imgs.push_back(img);
-			blurred_imgs.push_back(imgBlurred);
-			do
+			if (resized_imgs.empty())
+			{
+				resized_imgs.resize(1);
+				blurred_imgs.resize(1);
+			}
+			resized_imgs[0] = img;
+			blurred_imgs[0] = imgBlurred;
+			for (;;)
 			{
-				Mat_<double> intImgP, intImgP2;
 				computeIntegralImages(resized_imgs[scaleID], intImgP, intImgP2);
-				for (int i = 0, imax = cvFloor((0.0 + resized_imgs[scaleID].cols - initSize.width) / dx); i < imax; i++)
+				prepareClassifiers(static_cast<int> (blurred_imgs[scaleID].step[0]));
+
+				const int imax = std::max(cvFloor((0.0 + resized_imgs[scaleID].cols - initSize.width) / dx), 0);
+				const int jmax = std::max(cvFloor((0.0 + resized_imgs[scaleID].rows - initSize.height) / dy), 0);
+				windowFlags.resize((size_t)imax * jmax);
+				cv::parallel_for_ (cv::Range (0, imax), ScanWindowsParallelLoopBody (this, blurred_imgs[scaleID], initSize, dx, dy, jmax, windowFlags.data()));
+
+				//The windows are collected in the order of the serial scan
+				for (int i = 0, k = 0; i < imax; i++)
 				{
-					for (int j = 0, jmax = cvFloor((0.0 + resized_imgs[scaleID].rows - initSize.height) / dy); j < jmax; j++)
+					for (int j = 0; j < jmax; j++, k++)
 					{
-						if (!patchVariance(intImgP, intImgP2, originalVariancePtr, Point(dx * i, dy * j), initSize))
+						if (windowFlags[k] == WINDOW_REJECTED)
 							continue;
 						varBuffer.push_back(Point(dx * i, dy * j));
 						varScaleIDs.push_back(scaleID);
+						if (windowFlags[k] != WINDOW_ENSEMBLE_PASSED)
+							continue;
+						ensBuffer.push_back(Point(dx * i, dy * j));
+						ensScaleIDs.push_back(scaleID);
 					}
 				}
-				scaleID++;
+
 				size.width /= SCALE_STEP;
 				size.height /= SCALE_STEP;
 				scale *= SCALE_STEP;
-				resize(img, tmp, size, 0, 0, DOWNSCALE_MODE);
-				resized_imgs.push_back(tmp);
-				GaussianBlur(resized_imgs[scaleID], tmp, GaussBlurKernelSize, 0.0f);
-				blurred_imgs.push_back(tmp);
-			} while (size.width >= initSize.width && size.height >= initSize.height);
-
-			//Encsemble classification
-			for (int i = 0; i < (int)varBuffer.size(); i++)
-			{
-				prepareClassifiers(static_cast<int> (blurred_imgs[varScaleIDs[i]].step[0]));
-				if (ensembleClassifierNum(&blurred_imgs[varScaleIDs[i]].at<uchar>(varBuffer[i].y, varBuffer[i].x)) <= ENSEMBLE_THRESHOLD)
-					continue;
-				ensBuffer.push_back(varBuffer[i]);
-				ensScaleIDs.push_back(varScaleIDs[i]);
+				if (!(size.width >= initSize.width && size.height >= initSize.height))
+					break;
+				scaleID++;
+				if ((int)resized_imgs.size() <= scaleID)
+				{
+					resized_imgs.push_back(Mat());
+					blurred_imgs.push_back(Mat());
+				}
+				resize(img, resized_imgs[scaleID], size, 0, 0, DOWNSCALE_MODE);
+				GaussianBlur(resized_imgs[scaleID], blurred_imgs[scaleID], GaussBlurKernelSize, 0.0f);
 			}
+			resized_imgs.resize(scaleID + 1);
+			blurred_imgs.resize(scaleID + 1);
 
 			//Batch preparation
 			srValues.resize (ensBuffer.size());
@@ -501,7 +568,6 @@ namespace tld {
 			blurred_imgs.push_back(imgBlurred);
 			do
 			{
-				Mat_<double> intImgP, intImgP2;
 				computeIntegralImages(resized_imgs[scaleID], intImgP, intImgP2);
 				for (int i = 0, imax = cvFloor((0.0 + resized_imgs[scaleID].cols - initSize.width) / dx); i < imax; i++)
 				{
@@ -74,7 +74,7 @@ namespace tld {
 		public:
 			TLDDetector(){}
 			~TLDDetector(){}
-			double ensembleClassifierNum(const uchar* data);
+			double ensembleClassifierNum(const uchar* data) const;
 			void prepareClassifiers(int rowstep);
 			double Sr(const Mat_<uchar>& patch) const;
 			double Sc(const Mat_<uchar>& patch) const;
@@ -98,6 +98,11 @@ namespace tld {
 			std::vector <Point> varBuffer, ensBuffer;
 			std::vector <int> varScaleIDs, ensScaleIDs;
 
+			//! buffers of the scan of one scale, reused by the frames
+			enum { WINDOW_REJECTED = 0, WINDOW_VARIANCE_PASSED = 1, WINDOW_ENSEMBLE_PASSED = 2 };
+			Mat_<double> intImgP, intImgP2;
+			std::vector<uchar> windowFlags;
+
 			static void generateScanGrid(int rows, int cols, Size initBox, std::vector<Rect2d>& res, bool withScaling = false);
 			struct LabeledPatch
 			{
@@ -7,6 +7,8 @@
 #include "trackerCSRTSegmentation.hpp"
 #include "trackerCSRTUtils.hpp"
 #include "trackerCSRTScaleEstimation.hpp"
+#include "multiTargetTracker.hpp"
+#include "opencv2/core/utils/trace.hpp"
 
 namespace cv {
 inline namespace tracking {
@@ -25,7 +27,7 @@ protected:
     void modelUpdateImpl() CV_OVERRIDE {}
 };
 
-class TrackerCSRTImpl CV_FINAL : public TrackerCSRT
+class TrackerCSRTImpl CV_FINAL : public TrackerCSRT, public SharedFrameTracker
 {
 public:
     TrackerCSRTImpl(const Params &parameters = Params());
@@ -37,6 +39,7 @@ public:
     // Tracker API
     virtual void init(InputArray image, const Rect& boundingBox) CV_OVERRIDE;
     virtual bool update(InputArray image, Rect& boundingBox) CV_OVERRIDE;
+    virtual bool update(SharedFrame& frame, Rect& boundingBox) CV_OVERRIDE;
     virtual void setInitialMask(InputArray mask) CV_OVERRIDE;
 
 protected:
@@ -106,30 +109,19 @@ Mat TrackerCSRTImpl::calculate_response(const Mat &image, const std::vector<Mat>
 
     std::vector<Mat> ftrs = get_features(patch, yf.size());
     std::vector<Mat> Ffeatures = fourier_transform_features(ftrs);
-    Mat resp, res;
-    if(params.use_channel_weights){
-        res = Mat::zeros(Ffeatures[0].size(), CV_32FC2);
-        Mat resp_ch;
-        Mat mul_mat;
-        for(size_t i = 0; i < Ffeatures.size(); ++i) {
-            mulSpectrums(Ffeatures[i], filter[i], resp_ch, 0, true);
-            res += (resp_ch * filter_weights[i]);
-        }
-        idft(res, res, DFT_SCALE | DFT_REAL_OUTPUT);
-    } else {
-        res = Mat::zeros(Ffeatures[0].size(), CV_32FC2);
-        Mat resp_ch;
-        for(size_t i = 0; i < Ffeatures.size(); ++i) {
-            mulSpectrums(Ffeatures[i], filter[i], resp_ch, 0 , true);
-            res = res + resp_ch;
-        }
-        idft(res, res, DFT_SCALE | DFT_REAL_OUTPUT);
+    // sum of the channel responses accumulated in one pass per channel
+    Mat res = Mat::zeros(Ffeatures[0].size(), CV_32FC2);
+    for(size_t i = 0; i < Ffeatures.size(); ++i) {
+        accumulate_spectrums_product(Ffeatures[i], filter[i],
+                params.use_channel_weights ? filter_weights[i] : 1.0f, res);
     }
+    idft(res, res, DFT_SCALE | DFT_REAL_OUTPUT);
     return res;
 }
 
 void TrackerCSRTImpl::update_csr_filter(const Mat &image, const Mat &mask)
 {
+    CV_TRACE_FUNCTION();
     Mat patch = get_subwindow(image, object_center, cvFloor(current_scale_factor * template_size.width),
         cvFloor(current_scale_factor * template_size.height));
     resize(patch, patch, rescaled_template_size, 0, 0, INTER_CUBIC);
@@ -163,7 +155,7 @@ void TrackerCSRTImpl::update_csr_filter(const Mat &image, const Mat &mask)
         }
     }
     for(size_t i = 0; i < csr_filter.size(); ++i) {
-        csr_filter[i] = (1.0f - params.filter_lr)*csr_filter[i] + params.filter_lr * new_csr_filter[i];
+        addWeighted(csr_filter[i], 1.0f - params.filter_lr, new_csr_filter[i], params.filter_lr, 0, csr_filter[i]);
     }
     std::vector<Mat>().swap(ftrs);
     std::vector<Mat>().swap(Fftrs);
@@ -172,6 +164,7 @@ void TrackerCSRTImpl::update_csr_filter(const Mat &image, const Mat &mask)
 
 std::vector<Mat> TrackerCSRTImpl::get_features(const Mat &patch, const Size2i &feature_size)
 {
+    CV_TRACE_FUNCTION();
     std::vector<Mat> features;
     if (params.use_hog) {
         std::vector<Mat> hog = get_features_hog(patch, cell_size);
@@ -218,34 +211,75 @@ public:
     }
     virtual void operator ()(const Range& range) const CV_OVERRIDE
     {
+        CV_Assert(Y.type() == CV_32FC2 && P.type() == CV_32FC1 && P.size() == Y.size());
+        CV_Assert(Y.isContinuous() && P.isContinuous());
+        const int n = Y.rows * Y.cols;
+        const float* y = Y.ptr<float>();
+        const float* p = P.ptr<float>();
+
+        // the temporaries are shared by the channels of the range, the element-wise steps
+        // between the transforms are fused into single passes
+        Mat Sxy(Y.size(), CV_32FC2), Sxx(Y.size(), CV_32FC1);
+        Mat G(Y.size(), CV_32FC2), L(Y.size(), CV_32FC2), T(Y.size(), CV_32FC2);
+        Mat Hr(Y.size(), CV_32FC1);
+        float* sxy = Sxy.ptr<float>();
+        float* sxx = Sxx.ptr<float>();
+        float* g = G.ptr<float>();
+        float* l = L.ptr<float>();
+        float* t = T.ptr<float>();
+        float* hr = Hr.ptr<float>();
+
         for (int i = range.start; i < range.end; i++) {
             float mu = 5.0f;
             float beta = 3.0f;
             float mu_max = 20.0f;
             float lambda = mu / 100.0f;
 
-            Mat F = img_features[i];
-
-            Mat Sxy, Sxx;
-            mulSpectrums(F, Y, Sxy, 0, true);
-            mulSpectrums(F, F, Sxx, 0, true);
-
+            const Mat& F = img_features[i];
+            CV_Assert(F.type() == CV_32FC2 && F.size() == Y.size() && F.isContinuous());
+            const float* f = F.ptr<float>();
+
+            // Sxy = F * conj(Y), Sxx = |F|^2 and the initial filter Sxy / (Sxx + lambda)
+            for (int k = 0; k < n; k++) {
+                float fr = f[2*k], fi = f[2*k+1];
+                float yr = y[2*k], yi = y[2*k+1];
+                float a = fr*yr + fi*yi, b = fi*yr - fr*yi;
+                float c = fr*fr + fi*fi;
+                sxy[2*k] = a;
+                sxy[2*k+1] = b;
+                sxx[k] = c;
+                c += lambda;
+                t[2*k] = a*c / (c*c);
+                t[2*k+1] = b*c / (c*c);
+            }
+            idft(T, Hr, DFT_SCALE|DFT_REAL_OUTPUT);
+            for (int k = 0; k < n; k++)
+                hr[k] *= p[k];
             Mat H;
-            H = divide_complex_matrices(Sxy, (Sxx + lambda));
-            idft(H, H, DFT_SCALE|DFT_REAL_OUTPUT);
-            H = H.mul(P);
-            dft(H, H, DFT_COMPLEX_OUTPUT);
-            Mat L = Mat::zeros(H.size(), H.type()); //Lagrangian multiplier
-            Mat G;
+            dft(Hr, H, DFT_COMPLEX_OUTPUT);
+            L.setTo(Scalar::all(0)); //Lagrangian multiplier
             for(int iteration = 0; iteration < admm_iterations; ++iteration) {
-                G = divide_complex_matrices((Sxy + (mu * H) - L) , (Sxx + mu));
-                idft((mu * G) + L, H, DFT_SCALE | DFT_REAL_OUTPUT);
+                // G = (Sxy + mu * H - L) / (Sxx + mu), T = mu * G + L
+                const float* h = H.ptr<float>();
+                for (int k = 0; k < n; k++) {
+                    float c = sxx[k] + mu;
+                    float gr = (sxy[2*k] + mu*h[2*k] - l[2*k])*c / (c*c);
+                    float gi = (sxy[2*k+1] + mu*h[2*k+1] - l[2*k+1])*c / (c*c);
+                    g[2*k] = gr;
+                    g[2*k+1] = gi;
+                    t[2*k] = mu*gr + l[2*k];
+                    t[2*k+1] = mu*gi + l[2*k+1];
+                }
+                idft(T, Hr, DFT_SCALE | DFT_REAL_OUTPUT);
                 float lm = 1.0f / (lambda+mu);
-                H = H.mul(P*lm);
-                dft(H, H, DFT_COMPLEX_OUTPUT);
+                for (int k = 0; k < n; k++)
+                    hr[k] *= p[k]*lm;
+                dft(Hr, H, DFT_COMPLEX_OUTPUT);
 
                 //Update variables for next iteration
-                L = L + mu * (G - H);
+                h = H.ptr<float>();
+                for (int k = 0; k < 2*n; k++)
+                    l[k] += mu * (g[k] - h[k]);
                 mu = min(mu_max, beta*mu);
             }
             result_filter[i] = H;
@@ -380,6 +414,7 @@ void TrackerCSRTImpl::extract_histograms(const Mat &image, cv::Rect region, Hist
 
 void TrackerCSRTImpl::update_histograms(const Mat &image, const Rect &region)
 {
+    CV_TRACE_FUNCTION();
     // create temporary histograms
     Histogram hf(image.channels(), params.histogram_bins);
     Histogram hb(image.channels(), params.histogram_bins);
@@ -410,6 +445,7 @@ void TrackerCSRTImpl::update_histograms(const Mat &image, const Rect &region)
 
 Point2f TrackerCSRTImpl::estimate_new_position(const Mat &image)
 {
+    CV_TRACE_FUNCTION();
 
     Mat resp = calculate_response(image, csr_filter);
 
@@ -449,16 +485,22 @@ Point2f TrackerCSRTImpl::estimate_new_position(const Mat &image)
 // *********************************************************************
 bool TrackerCSRTImpl::update(InputArray image_, Rect& boundingBox)
 {
-    Mat image;
-    if(image_.channels() == 1)    //treat gray image as color image
-        cvtColor(image_, image, COLOR_GRAY2BGR);
-    else
-        image = image_.getMat();
+    SharedFrame frame(image_.getMat());
+    return update(frame, boundingBox);
+}
+
+bool TrackerCSRTImpl::update(SharedFrame& frame, Rect& boundingBox)
+{
+    CV_TRACE_FUNCTION();
+    //treat gray image as color image
+    const Mat& image = frame.getColor();
 
+    CV_TRACE_REGION("estimatePosition");
     object_center = estimate_new_position(image);
     if (object_center.x < 0 && object_center.y < 0)
         return false;
 
+    CV_TRACE_REGION_NEXT("estimateScale");
     current_scale_factor = dsst.getScale(image, object_center);
     //update bouding_box according to new scale and location
     bounding_box.x = object_center.x - current_scale_factor * original_target_size.width / 2.0f;
@@ -467,8 +509,10 @@ bool TrackerCSRTImpl::update(InputArray image_, Rect& boundingBox)
     bounding_box.height = current_scale_factor * original_target_size.height;
 
     //update tracker
+    CV_TRACE_REGION_NEXT("updateModel");
     if(params.use_segmentation) {
-        Mat hsv_img = bgr2hsv(image);
+        CV_TRACE_REGION("segmentation");
+        const Mat& hsv_img = frame.getHSV();
         update_histograms(hsv_img, bounding_box);
         filter_mask = segment_region(hsv_img, object_center,
                 template_size,original_target_size, current_scale_factor);
@@ -482,6 +526,7 @@ bool TrackerCSRTImpl::update(InputArray image_, Rect& boundingBox)
         filter_mask = default_mask;
     }
     update_csr_filter(image, filter_mask);
+    CV_TRACE_REGION_NEXT("updateScaleModel");
     dsst.update(image, object_center);
     boundingBox = bounding_box;
     return true;
@@ -492,6 +537,7 @@ bool TrackerCSRTImpl::update(InputArray image_, Rect& boundingBox)
 // *********************************************************************
 void TrackerCSRTImpl::init(InputArray image_, const Rect& boundingBox)
 {
+    CV_TRACE_FUNCTION();
     Mat image;
     if(image_.channels() == 1)    //treat gray image as color image
         cvtColor(image_, image, COLOR_GRAY2BGR);
@@ -116,17 +116,16 @@ DSST::DSST(const Mat &image,
     scale_model_sz = Size(cvFloor(template_size.width * scale_model_factor),
             cvFloor(template_size.height * scale_model_factor));
 
-    Mat scale_resp = get_scale_features(image, object_center, original_targ_sz,
-            current_scale_factor, scale_factors, scale_window, scale_model_sz);
+    get_scale_features(image, object_center, original_targ_sz,
+            current_scale_factor, scale_factors, scale_window, scale_model_sz, scale_features);
 
     Mat ysf_row = Mat(ys.size(), CV_32FC2);
     dft(ys, ysf_row, DFT_ROWS | DFT_COMPLEX_OUTPUT, 0);
-    ysf = repeat(ysf_row, scale_resp.rows, 1);
-    Mat Fscale_resp;
-    dft(scale_resp, Fscale_resp, DFT_ROWS | DFT_COMPLEX_OUTPUT);
-    mulSpectrums(ysf, Fscale_resp, sf_num, 0 , true);
+    ysf = repeat(ysf_row, scale_features.rows, 1);
+    dft(scale_features, Fscale_features, DFT_ROWS | DFT_COMPLEX_OUTPUT);
+    mulSpectrums(ysf, Fscale_features, sf_num, 0 , true);
     Mat sf_den_all;
-    mulSpectrums(Fscale_resp, Fscale_resp, sf_den_all, 0, true);
+    mulSpectrums(Fscale_features, Fscale_features, sf_den_all, 0, true);
     reduce(sf_den_all, sf_den, 0, REDUCE_SUM, -1);
 }
 
@@ -134,16 +133,16 @@ DSST::~DSST()
 {
 }
 
-Mat DSST::get_scale_features(
+void DSST::get_scale_features(
         Mat img,
         Point2f pos,
         Size2f base_target_sz,
         float current_scale,
         std::vector<float> &scale_factors,
         Mat scale_window,
-        Size scale_model_sz)
+        Size scale_model_sz,
+        Mat &result)
 {
-    Mat result;
     int col_len = 0;
     Size patch_sz = Size(cvFloor(current_scale * scale_factors[0] * base_target_sz.width),
             cvFloor(current_scale * scale_factors[0] * base_target_sz.height));
@@ -152,7 +151,7 @@ Mat DSST::get_scale_features(
     resize(img_patch, img_patch, Size(scale_model_sz.width, scale_model_sz.height),0,0,INTER_LINEAR);
     std::vector<Mat> hog;
     hog = get_features_hog(img_patch, 4);
-    result = Mat(Size((int)scale_factors.size(), hog[0].cols * hog[0].rows * (int)hog.size()), CV_32F);
+    result.create(Size((int)scale_factors.size(), hog[0].cols * hog[0].rows * (int)hog.size()), CV_32F);
     col_len = hog[0].cols * hog[0].rows;
     for (int i = 0; i < static_cast<int>(hog.size()); ++i) {
         hog[i] = hog[i].t();
@@ -163,42 +162,77 @@ Mat DSST::get_scale_features(
     ParallelGetScaleFeatures parallelGetScaleFeatures(img, pos, base_target_sz,
             current_scale, scale_factors, scale_window, scale_model_sz, col_len, result);
     parallel_for_(Range(1, static_cast<int>(scale_factors.size())), parallelGetScaleFeatures);
-    return result;
 }
 
 void DSST::update(const Mat &image, const Point2f object_center)
 {
-    Mat scale_features = get_scale_features(image, object_center, original_targ_sz,
-            current_scale_factor, scale_factors, scale_window, scale_model_sz);
-    Mat Fscale_features;
+    get_scale_features(image, object_center, original_targ_sz,
+            current_scale_factor, scale_factors, scale_window, scale_model_sz, scale_features);
     dft(scale_features, Fscale_features, DFT_ROWS | DFT_COMPLEX_OUTPUT);
-    Mat new_sf_num;
-    Mat new_sf_den;
-    Mat new_sf_den_all;
-    mulSpectrums(ysf, Fscale_features, new_sf_num, DFT_ROWS, true);
-    Mat sf_den_all;
-    mulSpectrums(Fscale_features, Fscale_features, new_sf_den_all, DFT_ROWS, true);
-    reduce(new_sf_den_all, new_sf_den, 0, REDUCE_SUM, -1);
 
-    sf_num = (1 - learn_rate) * sf_num + learn_rate * new_sf_num;
-    sf_den = (1 - learn_rate) * sf_den + learn_rate * new_sf_den;
+    // sf_num = (1 - lr) * sf_num + lr * ysf * conj(F), sf_den = (1 - lr) * sf_den + lr * sum_rows(|F|^2)
+    const int n = Fscale_features.cols;
+    scale_den.create(1, n, CV_32F);
+    float* den_all = scale_den.ptr<float>();
+    for (int i = 0; i < Fscale_features.rows; ++i) {
+        const float* f = Fscale_features.ptr<float>(i);
+        const float* y = ysf.ptr<float>(i);
+        float* num = sf_num.ptr<float>(i);
+        for (int j = 0; j < n; ++j) {
+            float fr = f[2*j], fi = f[2*j+1];
+            float yr = y[2*j], yi = y[2*j+1];
+            num[2*j] = (1 - learn_rate) * num[2*j] + learn_rate * (yr*fr + yi*fi);
+            num[2*j+1] = (1 - learn_rate) * num[2*j+1] + learn_rate * (yi*fr - yr*fi);
+            float d = fr*fr + fi*fi;
+            if (i == 0)
+                den_all[j] = d;
+            else
+                den_all[j] += d;
+        }
+    }
+    float* den = sf_den.ptr<float>();
+    for (int j = 0; j < n; ++j) {
+        den[2*j] = (1 - learn_rate) * den[2*j] + learn_rate * den_all[j];
+        den[2*j+1] = (1 - learn_rate) * den[2*j+1];
+    }
 }
 
 float DSST::getScale(const Mat &image, const Point2f object_center)
 {
-    Mat scale_features = get_scale_features(image, object_center, original_targ_sz,
-            current_scale_factor, scale_factors, scale_window, scale_model_sz);
-
-    Mat Fscale_features;
+    get_scale_features(image, object_center, original_targ_sz,
+            current_scale_factor, scale_factors, scale_window, scale_model_sz, scale_features);
     dft(scale_features, Fscale_features, DFT_ROWS | DFT_COMPLEX_OUTPUT);
 
-    mulSpectrums(Fscale_features, sf_num, Fscale_features, 0, false);
-    Mat scale_resp;
-    reduce(Fscale_features, scale_resp, 0, REDUCE_SUM, -1);
-    scale_resp = divide_complex_matrices(scale_resp, sf_den + 0.01f);
-    idft(scale_resp, scale_resp, DFT_REAL_OUTPUT|DFT_SCALE);
+    // scale_resp = sum_rows(F * sf_num) / (sf_den + 0.01)
+    const int n = Fscale_features.cols;
+    scale_resp.create(1, n, CV_32FC2);
+    float* resp = scale_resp.ptr<float>();
+    for (int i = 0; i < Fscale_features.rows; ++i) {
+        const float* f = Fscale_features.ptr<float>(i);
+        const float* num = sf_num.ptr<float>(i);
+        for (int j = 0; j < n; ++j) {
+            float re = f[2*j]*num[2*j] - f[2*j+1]*num[2*j+1];
+            float im = f[2*j]*num[2*j+1] + f[2*j+1]*num[2*j];
+            if (i == 0) {
+                resp[2*j] = re;
+                resp[2*j+1] = im;
+            } else {
+                resp[2*j] += re;
+                resp[2*j+1] += im;
+            }
+        }
+    }
+    const float* den = sf_den.ptr<float>();
+    for (int j = 0; j < n; ++j) {
+        float a = resp[2*j], b = resp[2*j+1];
+        float c = den[2*j] + 0.01f, d = den[2*j+1];
+        float div = c*c + d*d;
+        resp[2*j] = (a*c + b*d) / div;
+        resp[2*j+1] = (b*c - a*d) / div;
+    }
+    idft(scale_resp, scale_resp_real, DFT_REAL_OUTPUT|DFT_SCALE);
     Point max_loc;
-    minMaxLoc(scale_resp, NULL, NULL, NULL, &max_loc);
+    minMaxLoc(scale_resp_real, NULL, NULL, NULL, &max_loc);
 
     current_scale_factor *= scale_factors[max_loc.x];
     if(current_scale_factor < min_scale_factor)
@@ -17,8 +17,8 @@ public:
     void update(const Mat &image, const Point2f objectCenter);
     float getScale(const Mat &image, const Point2f objecCenter);
 private:
-    Mat get_scale_features(Mat img, Point2f pos, Size2f base_target_sz, float current_scale,
-            std::vector<float> &scale_factors, Mat scale_window, Size scale_model_sz);
+    void get_scale_features(Mat img, Point2f pos, Size2f base_target_sz, float current_scale,
+            std::vector<float> &scale_factors, Mat scale_window, Size scale_model_sz, Mat &result);
 
     Size scale_model_sz;
     Mat ys;
@@ -38,6 +38,13 @@ private:
     float learn_rate;
 
     Size original_targ_sz;
+
+    // workspaces reused by every update
+    Mat scale_features;
+    Mat Fscale_features;
+    Mat scale_den;
+    Mat scale_resp;
+    Mat scale_resp_real;
 };
 
 } /* namespace cv */
@@ -30,6 +30,8 @@ Mat circshift(Mat matrix, int dx, int dy);
 Mat gaussian_shaped_labels(const float sigma, const int w, const int h);
 std::vector<Mat> fourier_transform_features(const std::vector<Mat> &M);
 Mat divide_complex_matrices(const Mat &A, const Mat &B);
+// dst += weight * A * conj(B), for complex CV_32FC2 spectrums of the same size
+void accumulate_spectrums_product(const Mat &A, const Mat &B, float weight, Mat &dst);
 Mat get_subwindow(const Mat &image, const Point2f center,
         const int w, const int h,Rect *valid_pixels = NULL);
 
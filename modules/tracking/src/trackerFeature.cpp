@@ -40,6 +40,7 @@
  //M*/
 
 #include "precomp.hpp"
+#include "featureMaps.hpp"
 
 namespace cv {
 namespace detail {
@@ -126,9 +127,31 @@ TrackerFeatureHOG::~TrackerFeatureHOG()
 
 }
 
-bool TrackerFeatureHOG::computeImpl( const std::vector<Mat>& /*images*/, Mat& /*response*/)
+bool TrackerFeatureHOG::computeImpl( const std::vector<Mat>& images, Mat& response )
 {
-  return false;
+  if( images.empty() )
+  {
+    return false;
+  }
+
+  // one column of FHOG features with 4x4 cells per sample, the samples must have the same size
+  FHOGFeatureMap hog;
+  Mat color, features;
+  for ( size_t i = 0; i < images.size(); i++ )
+  {
+    CV_Assert( images[i].size() == images[0].size() );
+    if( images[i].channels() == 1 )
+      cvtColor( images[i], color, COLOR_GRAY2BGR );
+    else
+      color = images[i];
+
+    hog.compute( color, 4 );
+    hog.getFeatures( hog.getValidCells(), features, 1 );
+    if( i == 0 )
+      response.create( (int)features.total() * FHOGFeatureMap::dimHOG, (int)images.size(), CV_32F );
+    features.reshape( 1, response.rows ).copyTo( response.col( (int)i ) );
+  }
+  return true;
 }
 
 void TrackerFeatureHOG::selection( Mat& /*response*/, int /*npoints*/)
@@ -42,6 +42,8 @@
 #include "precomp.hpp"
 
 #include "opencl_kernels_tracking.hpp"
+#include "multiTargetTracker.hpp"
+#include "featureMaps.hpp"
 #include <complex>
 #include <cmath>
 
@@ -71,13 +73,15 @@ namespace impl {
   /*
  * Prototype
  */
-class TrackerKCFImpl CV_FINAL : public TrackerKCF
+class TrackerKCFImpl CV_FINAL : public TrackerKCF, public SharedFrameTracker
 {
 public:
     TrackerKCFImpl(const TrackerKCF::Params &parameters);
 
     virtual void init(InputArray image, const Rect& boundingBox) CV_OVERRIDE;
     virtual bool update(InputArray image, Rect& boundingBox) CV_OVERRIDE;
+    virtual bool update(SharedFrame& frame, Rect& boundingBox) CV_OVERRIDE;
+    virtual void getFeatureMapsArea(double& fullSizeArea, double& halfSizeArea) const CV_OVERRIDE;
     void setFeatureExtractor(void (*f)(const Mat, const Rect, Mat&), bool pca_func = false) CV_OVERRIDE;
 
     TrackerKCF::Params params;
@@ -93,8 +97,10 @@ protected:
     void inline updateProjectionMatrix(const Mat src, Mat & old_cov,Mat &  proj_matrix,float pca_rate, int compressed_sz,
                                        std::vector<Mat> & layers_pca,std::vector<Scalar> & average, Mat pca_data, Mat new_cov, Mat w, Mat u, Mat v);
     void inline compress(const Mat proj_matrix, const Mat src, Mat & dest, Mat & data, Mat & compressed) const;
+    bool updateImpl(const Mat& img, const Size& imageSize, Rect& boundingBox);
     bool getSubWindow(const Mat img, const Rect roi, Mat& feat, Mat& patch, TrackerKCF::MODE desc = GRAY) const;
     bool getSubWindow(const Mat img, const Rect roi, Mat& feat, void (*f)(const Mat, const Rect, Mat& )) const;
+    void cropPatch(const Mat& src, const Rect& region, const Rect& _roi, Mat& patch) const;
     void extractCN(Mat patch_data, Mat & cnFeatures) const;
     void denseGaussKernel(const float sigma, const Mat , const Mat y_data, Mat & k_data,
                           std::vector<Mat> & layers_data,std::vector<Mat> & xf_data,std::vector<Mat> & yf_data, std::vector<Mat> xyf_v, Mat xy, Mat xyf ) const;
@@ -134,6 +140,9 @@ private:
     std::vector<Scalar> average_data;
     Mat img_Patch;
 
+    // gray and CN features of the whole frame provided by MultiTargetTracker, empty when computed per patch
+    Mat gray_map, cn_map;
+
     // storage for the extracted features, KRLS model, KRLS compressed model
     Mat X[2],Z[2],Zc[2];
 
@@ -279,17 +288,48 @@ private:
    */
   bool TrackerKCFImpl::update(InputArray image, Rect& boundingBoxResult)
   {
-    double minVal, maxVal;	// min-max response
-    Point minLoc,maxLoc;	// min-max location
+    SharedFrame frame(image.getMat());
+    return update(frame, boundingBoxResult);
+  }
 
+  bool TrackerKCFImpl::update(SharedFrame& sharedFrame, Rect& boundingBoxResult)
+  {
+    const Mat& image = sharedFrame.image();
     CV_Assert(image.channels() == 1 || image.channels() == 3);
 
-    Mat img;
     // resize the image whenever needed
-    if (resizeImage)
-        resize(image, img, Size(image.cols()/2, image.rows()/2), 0, 0, INTER_LINEAR_EXACT);
-    else
-        image.copyTo(img);
+    Mat img = resizeImage ? sharedFrame.getHalf() : image;
+
+    gray_map.release();
+    cn_map.release();
+    if (sharedFrame.useFeatureMaps(resizeImage))
+    {
+      if(((params.desc_pca | params.desc_npca) & GRAY) == GRAY)
+        gray_map = sharedFrame.getGray(resizeImage);
+      if(((params.desc_pca | params.desc_npca) & CN) == CN)
+        cn_map = sharedFrame.getCN(resizeImage);
+    }
+
+    bool found = updateImpl(img, image.size(), boundingBoxResult);
+
+    gray_map.release();
+    cn_map.release();
+    return found;
+  }
+
+  void TrackerKCFImpl::getFeatureMapsArea(double& fullSizeArea, double& halfSizeArea) const
+  {
+    // gray and CN descriptors, extracted once for learning and once more for detection after the first frame
+    size_t ndesc = descriptors_pca.size() - extractor_pca.size() + descriptors_npca.size() - extractor_npca.size();
+    double area = roi.area() * (double)ndesc * (frame > 0 ? 2 : 1);
+    fullSizeArea = resizeImage ? 0 : area;
+    halfSizeArea = resizeImage ? area : 0;
+  }
+
+  bool TrackerKCFImpl::updateImpl(const Mat& img, const Size& imageSize, Rect& boundingBoxResult)
+  {
+    double minVal, maxVal;	// min-max response
+    Point minLoc,maxLoc;	// min-max location
 
     // detection part
     if(frame>0){
@@ -464,7 +504,7 @@ private:
     int y1 = cvRound(boundingBox.y);
     int x2 = cvRound(boundingBox.x + boundingBox.width);
     int y2 = cvRound(boundingBox.y + boundingBox.height);
-    boundingBoxResult = Rect(x1, y1, x2 - x1, y2 - y1) & Rect(Point(0, 0), image.size());
+    boundingBoxResult = Rect(x1, y1, x2 - x1, y2 - y1) & Rect(Point(0, 0), imageSize);
 
     return true;
   }
@@ -670,16 +710,15 @@ private:
     if (region.empty())
         return false;
 
-    patch=img(region).clone();
-
-    // add some padding to compensate when the patch is outside image border
-    int addTop,addBottom, addLeft, addRight;
-    addTop=region.y-_roi.y;
-    addBottom=(_roi.height+_roi.y>img.rows?_roi.height+_roi.y-img.rows:0);
-    addLeft=region.x-_roi.x;
-    addRight=(_roi.width+_roi.x>img.cols?_roi.width+_roi.x-img.cols:0);
+    // crop the features from the maps of the whole frame, the replicated border gives the same values
+    const Mat& map = desc == CN ? cn_map : gray_map;
+    if(!map.empty()){
+      cropPatch(map, region, _roi, feat);
+      feat=feat.mul(desc == CN ? hann_cn : hann); // hann window filter
+      return true;
+    }
 
-    copyMakeBorder(patch,patch,addTop,addBottom,addLeft,addRight,BORDER_REPLICATE);
+    cropPatch(img, region, _roi, patch);
     if(patch.rows==0 || patch.cols==0)return false;
 
     // extract the desired descriptors
@@ -705,6 +744,19 @@ private:
 
   }
 
+  void TrackerKCFImpl::cropPatch(const Mat& src, const Rect& region, const Rect& _roi, Mat& patch) const {
+    patch=src(region).clone();
+
+    // add some padding to compensate when the patch is outside image border
+    int addTop,addBottom, addLeft, addRight;
+    addTop=region.y-_roi.y;
+    addBottom=(_roi.height+_roi.y>src.rows?_roi.height+_roi.y-src.rows:0);
+    addLeft=region.x-_roi.x;
+    addRight=(_roi.width+_roi.x>src.cols?_roi.width+_roi.x-src.cols:0);
+
+    copyMakeBorder(patch,patch,addTop,addBottom,addLeft,addRight,BORDER_REPLICATE);
+  }
+
   /*
    * get feature using external function
    */
@@ -740,24 +792,7 @@ private:
   /* Convert BGR to ColorNames
    */
   void TrackerKCFImpl::extractCN(Mat patch_data, Mat & cnFeatures) const {
-    Vec3b & pixel = patch_data.at<Vec3b>(0,0);
-    unsigned index;
-
-    if(cnFeatures.type() != CV_32FC(10))
-      cnFeatures = Mat::zeros(patch_data.rows,patch_data.cols,CV_32FC(10));
-
-    for(int i=0;i<patch_data.rows;i++){
-      for(int j=0;j<patch_data.cols;j++){
-        pixel=patch_data.at<Vec3b>(i,j);
-        index=(unsigned)(floor((float)pixel[2]/8)+32*floor((float)pixel[1]/8)+32*32*floor((float)pixel[0]/8));
-
-        //copy the values
-        for(int _k=0;_k<10;_k++){
-          cnFeatures.at<Vec<float,10> >(i,j)[_k]=ColorNames[index][_k];
-        }
-      }
-    }
-
+    computeColorNames(patch_data, cnFeatures);
   }
 
   /*
@@ -33,6 +33,25 @@ inline namespace tracking {
 
 using namespace tbm;
 
+void IDescriptorDistance::computeMatrix(const std::vector<cv::Mat> &descrs1,
+                                        const std::vector<cv::Mat> &descrs2,
+                                        const cv::Mat &mask, cv::Mat &distances) {
+    TBM_CHECK(mask.empty() || (mask.type() == CV_8U &&
+              mask.size() == cv::Size(static_cast<int>(descrs2.size()), static_cast<int>(descrs1.size()))));
+
+    distances.create(static_cast<int>(descrs1.size()), static_cast<int>(descrs2.size()), CV_32F);
+    distances.setTo(1.f);
+    for (int i = 0; i < distances.rows; i++) {
+        auto ptr = distances.ptr<float>(i);
+        const uchar* m = mask.empty() ? nullptr : mask.ptr<uchar>(i);
+        for (int j = 0; j < distances.cols; j++) {
+            if (!m || m[j]) {
+                ptr[j] = compute(descrs1[i], descrs2[j]);
+            }
+        }
+    }
+}
+
 CosDistance::CosDistance(const cv::Size &descriptor_size)
     : descriptor_size_(descriptor_size) {
     TBM_CHECK(descriptor_size.area() != 0);
@@ -64,6 +83,49 @@ std::vector<float> CosDistance::compute(const std::vector<cv::Mat> &descrs1,
     return distances;
 }
 
+namespace {
+// one descriptor per row as CV_64F, the products of 8-bit descriptors stay exact
+void StackDescriptors(const std::vector<cv::Mat> &descrs, const cv::Size &descriptor_size,
+                      cv::Mat &stacked, std::vector<double> &sqr_norms) {
+    TBM_CHECK(!descrs.empty());
+    const int len = static_cast<int>(descrs[0].total()) * descrs[0].channels();
+    stacked.create(static_cast<int>(descrs.size()), len, CV_64F);
+    sqr_norms.resize(descrs.size());
+    for (size_t i = 0; i < descrs.size(); i++) {
+        const cv::Mat &d = descrs[i];
+        TBM_CHECK(!d.empty());
+        TBM_CHECK(d.size() == descriptor_size);
+        TBM_CHECK_EQ(static_cast<int>(d.total()) * d.channels(), len);
+        cv::Mat row = stacked.row(static_cast<int>(i));
+        (d.isContinuous() ? d : d.clone()).reshape(1, 1).convertTo(row, CV_64F);
+        sqr_norms[i] = row.dot(row);
+    }
+}
+}  // anonymous namespace
+
+void CosDistance::computeMatrix(const std::vector<cv::Mat> &descrs1,
+                                const std::vector<cv::Mat> &descrs2,
+                                const cv::Mat & /*mask*/, cv::Mat &distances) {
+    distances.create(static_cast<int>(descrs1.size()), static_cast<int>(descrs2.size()), CV_32F);
+    if (descrs1.empty() || descrs2.empty()) {
+        return;
+    }
+
+    cv::Mat a, b, xy;
+    std::vector<double> xx, yy;
+    StackDescriptors(descrs1, descriptor_size_, a, xx);
+    StackDescriptors(descrs2, descriptor_size_, b, yy);
+    cv::gemm(a, b, 1, cv::noArray(), 0, xy, cv::GEMM_2_T);
+
+    for (int i = 0; i < distances.rows; i++) {
+        const auto xy_ptr = xy.ptr<double>(i);
+        auto ptr = distances.ptr<float>(i);
+        for (int j = 0; j < distances.cols; j++) {
+            double norm = sqrt(xx[i] * yy[j]) + 1e-6;
+            ptr[j] = 0.5f * static_cast<float>(1.0 - xy_ptr[j] / norm);
+        }
+    }
+}
 
 float MatchTemplateDistance::compute(const cv::Mat &descr1,
                                      const cv::Mat &descr2) {
@@ -86,6 +148,51 @@ std::vector<float> MatchTemplateDistance::compute(const std::vector<cv::Mat> &de
     return result;
 }
 
+namespace {
+class ParallelMatchTemplateDistance : public cv::ParallelLoopBody {
+public:
+    ParallelMatchTemplateDistance(MatchTemplateDistance &distance,
+                                  const std::vector<cv::Mat> &descrs1,
+                                  const std::vector<cv::Mat> &descrs2,
+                                  const cv::Mat &mask, cv::Mat &distances)
+        : distance_(distance), descrs1_(descrs1), descrs2_(descrs2),
+          mask_(mask), distances_(distances) {}
+
+    void operator()(const cv::Range &range) const override {
+        for (int i = range.start; i < range.end; i++) {
+            auto ptr = distances_.ptr<float>(i);
+            const uchar* m = mask_.empty() ? nullptr : mask_.ptr<uchar>(i);
+            for (int j = 0; j < distances_.cols; j++) {
+                if (!m || m[j]) {
+                    ptr[j] = distance_.compute(descrs1_[i], descrs2_[j]);
+                }
+            }
+        }
+    }
+
+private:
+    MatchTemplateDistance &distance_;
+    const std::vector<cv::Mat> &descrs1_;
+    const std::vector<cv::Mat> &descrs2_;
+    const cv::Mat &mask_;
+    cv::Mat &distances_;
+
+    ParallelMatchTemplateDistance &operator=(const ParallelMatchTemplateDistance &);
+};
+}  // anonymous namespace
+
+void MatchTemplateDistance::computeMatrix(const std::vector<cv::Mat> &descrs1,
+                                          const std::vector<cv::Mat> &descrs2,
+                                          const cv::Mat &mask, cv::Mat &distances) {
+    TBM_CHECK(mask.empty() || (mask.type() == CV_8U &&
+              mask.size() == cv::Size(static_cast<int>(descrs2.size()), static_cast<int>(descrs1.size()))));
+
+    distances.create(static_cast<int>(descrs1.size()), static_cast<int>(descrs2.size()), CV_32F);
+    distances.setTo(1.f);
+    cv::parallel_for_(cv::Range(0, distances.rows),
+                      ParallelMatchTemplateDistance(*this, descrs1, descrs2, mask, distances));
+}
+
 namespace {
 cv::Point Center(const cv::Rect& rect) {
     return cv::Point((int)(rect.x + rect.width * .5), (int)(rect.y + rect.height * .5));
@@ -432,6 +539,9 @@ private:
 
     float Affinity(const TrackedObject &obj1, const TrackedObject &obj2);
 
+    // Computes shape, motion and time affinities of all tracks and detections in parallel.
+    class ParallelGeometricAffinity;
+
     void AddNewTrack(const cv::Mat &frame, const TrackedObject &detection,
                      const cv::Mat &fast_descriptor,
                      const cv::Mat &descriptor_strong = cv::Mat());
@@ -691,7 +801,9 @@ void TrackerByMatching::SolveAssignmentProblem(
     ComputeDissimilarityMatrix(track_ids, detections, descriptors,
                                dissimilarity);
 
-    auto res = KuhnMunkres().Solve(dissimilarity);
+    // the pairs with zero affinity are never accepted as matches, so the
+    // groups of tracks and detections connected by the others are independent
+    auto res = KuhnMunkres().SolveGated(dissimilarity, 1.f);
 
     for (size_t i = 0; i < detections.size(); i++) {
         unmatched_detections.insert(i);
@@ -991,21 +1103,88 @@ void TrackerByMatching::ComputeFastDesciptors(
     }
 }
 
+class TrackerByMatching::ParallelGeometricAffinity : public cv::ParallelLoopBody {
+public:
+    ParallelGeometricAffinity(const TrackerParams &params,
+                              const TrackedObjects &tracks,
+                              const TrackedObjects &detections,
+                              cv::Mat &shape_motion, cv::Mat &time, cv::Mat &mask)
+        : params_(params), tracks_(tracks), detections_(detections),
+          shape_motion_(shape_motion), time_(time), mask_(mask) {}
+
+    void operator()(const cv::Range &range) const override {
+        // the same gating as AffinityFast
+        const float eps = static_cast<float>(1e-6);
+        for (int i = range.start; i < range.end; i++) {
+            const auto &obj1 = tracks_[i];
+            auto sm_ptr = shape_motion_.ptr<float>(i);
+            auto time_ptr = time_.ptr<float>(i);
+            auto mask_ptr = mask_.ptr<uchar>(i);
+            for (size_t j = 0; j < detections_.size(); j++) {
+                const auto &obj2 = detections_[j];
+                mask_ptr[j] = 0;
+                float shp_aff = ShapeAffinity(params_.shape_affinity_w, obj1.rect, obj2.rect);
+                if (shp_aff < eps) continue;
+                float mot_aff = MotionAffinity(params_.motion_affinity_w, obj1.rect, obj2.rect);
+                if (mot_aff < eps) continue;
+                float time_aff = TimeAffinity(params_.time_affinity_w, static_cast<float>(obj1.frame_idx),
+                                              static_cast<float>(obj2.frame_idx));
+                if (time_aff < eps) continue;
+                sm_ptr[j] = shp_aff * mot_aff;
+                time_ptr[j] = time_aff;
+                mask_ptr[j] = 1;
+            }
+        }
+    }
+
+private:
+    const TrackerParams &params_;
+    const TrackedObjects &tracks_;
+    const TrackedObjects &detections_;
+    cv::Mat &shape_motion_;
+    cv::Mat &time_;
+    cv::Mat &mask_;
+
+    ParallelGeometricAffinity &operator=(const ParallelGeometricAffinity &);
+};
+
 void TrackerByMatching::ComputeDissimilarityMatrix(
     const std::set<size_t> &active_tracks, const TrackedObjects &detections,
     const std::vector<cv::Mat> &descriptors_fast,
     cv::Mat& dissimilarity_matrix) {
-    cv::Mat am(static_cast<int>(active_tracks.size()), static_cast<int>(detections.size()), CV_32F, cv::Scalar(0));
-    int i = 0;
+    const int rows = static_cast<int>(active_tracks.size());
+    const int cols = static_cast<int>(detections.size());
+
+    TrackedObjects last_dets;
+    std::vector<cv::Mat> track_descriptors;
     for (auto id : active_tracks) {
+        auto last_det = tracks_.at(id).objects.back();
+        last_det.rect = tracks_.at(id).predicted_rect;
+        last_dets.push_back(last_det);
+        track_descriptors.push_back(tracks_.at(id).descriptor_fast);
+    }
+
+    // the appearance distance is only required for the pairs which pass the geometric gating
+    cv::Mat shape_motion(rows, cols, CV_32F), time(rows, cols, CV_32F), mask(rows, cols, CV_8U);
+    cv::parallel_for_(cv::Range(0, rows),
+                      ParallelGeometricAffinity(params_, last_dets, detections, shape_motion, time, mask));
+
+    cv::Mat distances;
+    distance_fast_->computeMatrix(track_descriptors, descriptors_fast, mask, distances);
+
+    cv::Mat am(rows, cols, CV_32F, cv::Scalar(0));
+    for (int i = 0; i < rows; i++) {
         auto ptr = am.ptr<float>(i);
-        for (size_t j = 0; j < descriptors_fast.size(); j++) {
-            auto last_det = tracks_.at(id).objects.back();
-            last_det.rect = tracks_.at(id).predicted_rect;
-            ptr[j] = AffinityFast(tracks_.at(id).descriptor_fast, last_det,
-                                  descriptors_fast[j], detections[j]);
+        const auto sm_ptr = shape_motion.ptr<float>(i);
+        const auto time_ptr = time.ptr<float>(i);
+        const auto mask_ptr = mask.ptr<uchar>(i);
+        const auto dist_ptr = distances.ptr<float>(i);
+        for (int j = 0; j < cols; j++) {
+            if (mask_ptr[j]) {
+                float app_aff = static_cast<float>(1.0 - dist_ptr[j]);
+                ptr[j] = sm_ptr[j] * app_aff * time_ptr[j];
+            }
         }
-        i++;
     }
     dissimilarity_matrix = 1.0 - am;
 }
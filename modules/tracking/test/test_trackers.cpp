@@ -233,4 +233,60 @@ TEST_P(DistanceAndOverlap, Scaled_Data_CSRT_legacy)
 
 INSTANTIATE_TEST_CASE_P(Tracking, DistanceAndOverlap, TESTSET_NAMES);
 
+TEST(MultiTargetTracker, same_results_as_single_trackers)
+{
+  RNG& rng = theRNG();
+  Mat background(240, 320, CV_8UC3);
+  rng.fill(background, RNG::UNIFORM, 0, 256);
+  GaussianBlur(background, background, Size(5, 5), 1.5);
+
+  // overlapping KCF targets use the features of the whole frame, one of them on the half sized frame
+  std::vector<Rect> boxes;
+  std::vector<Ptr<Tracker> > single, targets;
+  TrackerKCF::Params kcfParams;
+  kcfParams.max_patch_size = 50 * 50;
+  for (int i = 0; i < 6; i++)
+  {
+    boxes.push_back(Rect(40 + 20 * i, 60 + 10 * i, 40, 40));
+    single.push_back(TrackerKCF::create());
+    targets.push_back(TrackerKCF::create());
+  }
+  boxes.push_back(Rect(100, 60, 100, 80));
+  single.push_back(TrackerKCF::create(kcfParams));
+  targets.push_back(TrackerKCF::create(kcfParams));
+  boxes.push_back(Rect(180, 100, 50, 40));
+  single.push_back(TrackerCSRT::create());
+  targets.push_back(TrackerCSRT::create());
+
+  Ptr<MultiTargetTracker> tracker = MultiTargetTracker::create();
+  for (size_t i = 0; i < boxes.size(); i++)
+  {
+    single[i]->init(background, boxes[i]);
+    EXPECT_EQ((int)i, tracker->add(targets[i], background, boxes[i]));
+  }
+  ASSERT_EQ((int)boxes.size(), tracker->getTargetCount());
+
+  for (int frame = 1; frame < 6; frame++)
+  {
+    Mat shift = (Mat_<double>(2, 3) << 1, 0, 2 * frame, 0, 1, frame);
+    Mat image;
+    warpAffine(background, image, shift, background.size(), INTER_LINEAR, BORDER_REFLECT);
+
+    std::vector<Rect> results;
+    std::vector<uchar> found;
+    tracker->update(image, results, found);
+    ASSERT_EQ(boxes.size(), results.size());
+    ASSERT_EQ(boxes.size(), found.size());
+
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+      Rect bb;
+      bool res = single[i]->update(image, bb);
+      EXPECT_EQ(res, found[i] != 0) << "target " << i << " frame " << frame;
+      if (res)
+        EXPECT_EQ(bb, results[i]) << "target " << i << " frame " << frame;
+    }
+  }
+}
+
 }} // namespace
@@ -243,6 +243,13 @@ public:
     void setOutlierRejector(Ptr<IOutlierRejector> val) { outlierRejector_ = val; }
     Ptr<IOutlierRejector> outlierRejector() const { return outlierRejector_; }
 
+    /** @brief Enables tracking of the points found in frame1 by the next estimate() call, when its frame0 is the same image.
+
+    The points are detected again once less than the given ratio of the detected ones is left, 0 disables the reuse.
+     */
+    void setPointsReuseRatio(float val) { CV_Assert(val >= 0.f && val <= 1.f); pointsReuseRatio_ = val; }
+    float pointsReuseRatio() const { return pointsReuseRatio_; }
+
     virtual void setFrameMask(InputArray mask) CV_OVERRIDE { mask_ = mask.getMat(); }
 
     virtual Mat estimate(const Mat &frame0, const Mat &frame1, bool *ok = 0) CV_OVERRIDE;
@@ -254,11 +261,16 @@ private:
     Ptr<ISparseOptFlowEstimator> optFlowEstimator_;
     Ptr<IOutlierRejector> outlierRejector_;
     Mat mask_;
+    float pointsReuseRatio_;
 
     std::vector<uchar> status_;
     std::vector<KeyPoint> keypointsPrev_;
     std::vector<Point2f> pointsPrev_, points_;
     std::vector<Point2f> pointsPrevGood_, pointsGood_;
+
+    Mat frame1Prev_;
+    std::vector<Point2f> pointsReused_;
+    size_t numDetected_;
 };
 
 #if defined(HAVE_OPENCV_CUDAIMGPROC) && defined(HAVE_OPENCV_CUDAOPTFLOW)
@@ -114,6 +114,32 @@ private:
 
 inline GaussianMotionFilter::GaussianMotionFilter(int _radius, float _stdev) { setParams(_radius, _stdev); }
 
+/** @brief Causal motion filter, the stabilized camera follows the real one with exponential smoothing.
+
+Only the motion from the previous frame is used, so with OnePassStabilizer the radius, which is the number of
+frames of lookahead, can be set to 1 when the latency matters. The frames must be stabilized in order, the filter
+starts over on any other index.
+ */
+class CV_EXPORTS ExponentialMotionFilter : public MotionFilterBase
+{
+public:
+    ExponentialMotionFilter(float smoothness = 0.9f);
+
+    //! weight of the previous stabilized frame in [0, 1), the higher the smoother
+    void setSmoothness(float val);
+    float smoothness() const { return smoothness_; }
+
+    virtual Mat stabilize(
+            int idx, const std::vector<Mat> &motions, const Range &range) CV_OVERRIDE;
+
+private:
+    float smoothness_;
+    int lastIdx_;
+    Mat lastStabilizationMotion_;
+};
+
+inline ExponentialMotionFilter::ExponentialMotionFilter(float _smoothness) : lastIdx_(-1) { setSmoothness(_smoothness); }
+
 class CV_EXPORTS LpMotionStabilizer : public IMotionStabilizer
 {
 public:
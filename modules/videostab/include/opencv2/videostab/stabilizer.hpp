@@ -55,6 +55,10 @@
 #include "opencv2/videostab/deblurring.hpp"
 #include "opencv2/videostab/wobble_suppression.hpp"
 
+#ifdef HAVE_OPENCV_CUDACODEC
+#  include "opencv2/cudacodec.hpp"
+#endif
+
 namespace cv
 {
 namespace videostab
@@ -174,11 +178,34 @@ public:
     void setEstimateTrimRatio(bool val) { mustEstTrimRatio_ = val; }
     bool mustEstimateTrimaRatio() const { return mustEstTrimRatio_; }
 
+    /** @brief Sets independent motion estimators for the first pass, each worker estimates the motions of
+    a contiguous part of the queued frame pairs with its own estimator. When empty, motionEstimator() is used
+    serially. The estimators must have the same motion model as motionEstimator().
+     */
+    void setPrePassMotionEstimators(const std::vector<Ptr<ImageMotionEstimatorBase> > &val) { prePassMotionEstimators_ = val; }
+    std::vector<Ptr<ImageMotionEstimatorBase> > prePassMotionEstimators() const { return prePassMotionEstimators_; }
+
+    //! maximal number of frames which are decoded ahead of the first pass motion estimation
+    void setPrePassQueueSize(int val) { CV_Assert(val > 0); prePassQueueSize_ = val; }
+    int prePassQueueSize() const { return prePassQueueSize_; }
+
+    /** @brief Sets the file where the motions of the first pass are cached.
+
+    The motions are read from the file when it was written for a video of the same first frame, otherwise they
+    are estimated and written to it, so a rerun with other stabilization settings skips the motion estimation.
+    The cache must be removed when the motion estimators change. Empty disables the cache.
+     */
+    void setMotionsCacheFile(const String &val) { motionsCacheFile_ = val; }
+    String motionsCacheFile() const { return motionsCacheFile_; }
+
     virtual void reset() CV_OVERRIDE;
     virtual Mat nextFrame() CV_OVERRIDE;
 
 protected:
     void runPrePassIfNecessary();
+    void estimatePrePassMotions(const Mat &firstFrame);
+    bool readMotionsCache(const Mat &firstFrame);
+    void writeMotionsCache(const Mat &firstFrame) const;
 
     virtual void setUp(const Mat &firstFrame) CV_OVERRIDE;
     virtual Mat estimateMotion() CV_OVERRIDE;
@@ -188,6 +215,9 @@ protected:
     Ptr<IMotionStabilizer> motionStabilizer_;
     Ptr<WobbleSuppressorBase> wobbleSuppressor_;
     bool mustEstTrimRatio_;
+    std::vector<Ptr<ImageMotionEstimatorBase> > prePassMotionEstimators_;
+    int prePassQueueSize_;
+    String motionsCacheFile_;
 
     int frameCount_;
     bool isPrePassDone_;
@@ -196,6 +226,120 @@ protected:
     Mat suppressedFrame_;
 };
 
+#if defined(HAVE_OPENCV_CUDAIMGPROC) && defined(HAVE_OPENCV_CUDAOPTFLOW) && defined(HAVE_OPENCV_CUDAWARPING)
+
+//! Source of device resident frames
+class CV_EXPORTS IFrameSourceGpu
+{
+public:
+    virtual ~IFrameSourceGpu() {}
+    virtual void reset() = 0;
+    //! returns false when there are no frames left, the frame may be overwritten by the next call
+    virtual bool nextFrame(cuda::GpuMat &frame) = 0;
+};
+
+#ifdef HAVE_OPENCV_CUDACODEC
+
+//! Frames decoded by cudacodec::VideoReader, converted to BGR on the device
+class CV_EXPORTS VideoReaderFrameSourceGpu : public IFrameSourceGpu
+{
+public:
+    VideoReaderFrameSourceGpu(const String &path);
+
+    virtual void reset() CV_OVERRIDE;
+    virtual bool nextFrame(cuda::GpuMat &frame) CV_OVERRIDE;
+
+private:
+    String path_;
+    Ptr<cudacodec::VideoReader> reader_;
+    cuda::GpuMat decoded_;
+};
+
+#endif
+
+/** @brief One pass stabilizer which keeps the frames on the device.
+
+The frames of the radius, their stabilized versions and masks are kept in rings of GpuMat, only the motions go
+to the host. Warping, deblurring (the same weighting as WeightingDeblurer does) and inpainting, which fills the
+missing pixels from the nearest frames of the radius having them, run on the device.
+ */
+class CV_EXPORTS OnePassStabilizerGpu
+{
+public:
+    OnePassStabilizerGpu();
+
+    void setLog(Ptr<ILog> ilog) { log_ = ilog; }
+    Ptr<ILog> log() const { return log_; }
+
+    void setRadius(int val) { CV_Assert(val > 0); radius_ = val; }
+    int radius() const { return radius_; }
+
+    void setFrameSource(Ptr<IFrameSourceGpu> val) { frameSource_ = val; }
+    Ptr<IFrameSourceGpu> frameSource() const { return frameSource_; }
+
+    void setMotionEstimator(Ptr<KeypointBasedMotionEstimatorGpu> val) { motionEstimator_ = val; }
+    Ptr<KeypointBasedMotionEstimatorGpu> motionEstimator() const { return motionEstimator_; }
+
+    void setMotionFilter(Ptr<MotionFilterBase> val) { motionFilter_ = val; }
+    Ptr<MotionFilterBase> motionFilter() const { return motionFilter_; }
+
+    void setTrimRatio(float val) { trimRatio_ = val; }
+    float trimRatio() const { return trimRatio_; }
+
+    void setCorrectionForInclusion(bool val) { doCorrectionForInclusion_ = val; }
+    bool doCorrectionForInclusion() const { return doCorrectionForInclusion_; }
+
+    void setBorderMode(int val) { borderMode_ = val; }
+    int borderMode() const { return borderMode_; }
+
+    //! sensitivity of the weighting deblurring, 0 disables the deblurring
+    void setDeblurringSensitivity(float val) { CV_Assert(val >= 0.f); deblurringSensitivity_ = val; }
+    float deblurringSensitivity() const { return deblurringSensitivity_; }
+
+    void setInpainting(bool val) { doInpainting_ = val; }
+    bool doInpainting() const { return doInpainting_; }
+
+    void reset();
+
+    //! returns false when all the frames are stabilized, the frame refers to the internal buffers
+    bool nextFrame(cuda::GpuMat &frame);
+
+protected:
+    bool doOneIteration();
+    void setUp(const cuda::GpuMat &firstFrame);
+    void stabilizeFrame();
+
+    Ptr<ILog> log_;
+    Ptr<IFrameSourceGpu> frameSource_;
+    Ptr<KeypointBasedMotionEstimatorGpu> motionEstimator_;
+    Ptr<MotionFilterBase> motionFilter_;
+    int radius_;
+    float trimRatio_;
+    bool doCorrectionForInclusion_;
+    int borderMode_;
+    float deblurringSensitivity_;
+    bool doInpainting_;
+
+    Size frameSize_;
+    int frameType_;
+    int curPos_;
+    int curStabilizedPos_;
+    cuda::GpuMat frame_;
+    cuda::GpuMat frameMask_;
+    cuda::GpuMat preProcessedFrame_;
+    cuda::GpuMat inpaintingMask_;
+    cuda::GpuMat deblurSums_;
+    cuda::GpuMat blurrinessBuf_;
+    std::vector<cuda::GpuMat> frames_;
+    std::vector<cuda::GpuMat> stabilizedFrames_;
+    std::vector<cuda::GpuMat> stabilizedMasks_;
+    std::vector<Mat> motions_; // motions_[i] is the motion from i-th to i+1-th frame
+    std::vector<Mat> stabilizationMotions_;
+    std::vector<float> blurrinessRates_;
+};
+
+#endif // defined(HAVE_OPENCV_CUDAIMGPROC) && defined(HAVE_OPENCV_CUDAOPTFLOW) && defined(HAVE_OPENCV_CUDAWARPING)
+
 //! @}
 
 } // namespace videostab
@@ -0,0 +1,70 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+using namespace cv::videostab;
+
+CV_ENUM(MotionModelType, MM_TRANSLATION, MM_TRANSLATION_AND_SCALE, MM_SIMILARITY, MM_AFFINE)
+
+typedef tuple<int, MotionModelType> GlobalMotionRansacParams_t;
+typedef perf::TestBaseWithParam<GlobalMotionRansacParams_t> GlobalMotionRansac;
+
+PERF_TEST_P(GlobalMotionRansac, estimate, Combine(Values(500, 2000), MotionModelType::all()))
+{
+    const int count = get<0>(GetParam());
+    const int model = get<1>(GetParam());
+
+    // points moved by a small similarity, with noise and 20% outliers
+    RNG rng(0);
+    Mat points0(count, 1, CV_32FC2), points1(count, 1, CV_32FC2);
+    rng.fill(points0, RNG::UNIFORM, 0, 640);
+    const float c = std::cos(0.02f), s = std::sin(0.02f);
+    for (int i = 0; i < count; ++i)
+    {
+        Point2f p = points0.at<Point2f>(i);
+        Point2f q(1.01f * (c * p.x - s * p.y) + 5.f, 1.01f * (s * p.x + c * p.y) - 3.f);
+        if (i % 5 == 0)
+            q = Point2f(rng.uniform(0.f, 640.f), rng.uniform(0.f, 640.f));
+        points1.at<Point2f>(i) = q + Point2f(rng.gaussian(0.5), rng.gaussian(0.5));
+    }
+    const RansacParams params = RansacParams::default2dMotion((MotionModel)model);
+
+    TEST_CYCLE()
+    {
+        // the same sequence of samples is drawn at every iteration
+        theRNG().state = 42;
+        estimateGlobalMotionRansac(points0, points1, model, params);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef perf::TestBaseWithParam<Size> KeypointBasedMotion;
+
+PERF_TEST_P(KeypointBasedMotion, estimate, Values(szVGA, sz720p))
+{
+    const Size sz = GetParam();
+    Mat frame0 = imread(getDataPath("cv/shared/fruits.png"), IMREAD_GRAYSCALE);
+    ASSERT_FALSE(frame0.empty());
+    resize(frame0, frame0, sz, 0, 0, INTER_LINEAR_EXACT);
+    Mat frame1;
+    Mat shake = getRotationMatrix2D(Point2f(sz.width * 0.5f, sz.height * 0.5f), 1.5, 1.0);
+    shake.at<double>(0, 2) += 4;
+    shake.at<double>(1, 2) -= 2;
+    warpAffine(frame0, frame1, shake, sz, INTER_LINEAR, BORDER_REFLECT);
+
+    KeypointBasedMotionEstimator estimator(makePtr<MotionEstimatorRansacL2>(MM_AFFINE));
+
+    TEST_CYCLE()
+    {
+        theRNG().state = 42;
+        estimator.estimate(frame0, frame1);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
@@ -0,0 +1,301 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#if !defined CUDA_DISABLER
+
+#include "opencv2/core/cuda/common.hpp"
+#include "opencv2/core/cuda/saturate_cast.hpp"
+
+namespace cv { namespace cuda { namespace device { namespace stabilizer {
+
+struct Matx33
+{
+    float m[9];
+};
+
+static Matx33 makeMatx33(const float *M)
+{
+    Matx33 res;
+    for (int i = 0; i < 9; ++i)
+        res.m[i] = M[i];
+    return res;
+}
+
+__device__ __forceinline__ int reflect101(int i, int n)
+{
+    i = i < 0 ? -i : i;
+    return i >= n ? 2*n - 2 - i : i;
+}
+
+__device__ __forceinline__ float intensity(const uchar3 &p)
+{
+    return 0.3f*p.x + 0.59f*p.y + 0.11f*p.z;
+}
+
+
+// sum of the squared Sobel derivatives over all the channels, as calcBlurriness() computes it
+__global__ void calcGradientEnergyKernel(const PtrStepSz<uchar3> frame, float *energy)
+{
+    __shared__ float smem[256];
+
+    const int x = blockDim.x * blockIdx.x + threadIdx.x;
+    const int y = blockDim.y * blockIdx.y + threadIdx.y;
+    const int tid = threadIdx.y * blockDim.x + threadIdx.x;
+
+    float sum = 0.f;
+
+    if (x < frame.cols && y < frame.rows)
+    {
+        const int xl = reflect101(x - 1, frame.cols), xr = reflect101(x + 1, frame.cols);
+        const int yt = reflect101(y - 1, frame.rows), yb = reflect101(y + 1, frame.rows);
+
+        const uchar3 tl = frame(yt, xl), t = frame(yt, x), tr = frame(yt, xr);
+        const uchar3 l = frame(y, xl), r = frame(y, xr);
+        const uchar3 bl = frame(yb, xl), b = frame(yb, x), br = frame(yb, xr);
+
+        float gx = (float)(tr.x + 2*r.x + br.x) - (float)(tl.x + 2*l.x + bl.x);
+        float gy = (float)(bl.x + 2*b.x + br.x) - (float)(tl.x + 2*t.x + tr.x);
+        sum += gx*gx + gy*gy;
+
+        gx = (float)(tr.y + 2*r.y + br.y) - (float)(tl.y + 2*l.y + bl.y);
+        gy = (float)(bl.y + 2*b.y + br.y) - (float)(tl.y + 2*t.y + tr.y);
+        sum += gx*gx + gy*gy;
+
+        gx = (float)(tr.z + 2*r.z + br.z) - (float)(tl.z + 2*l.z + bl.z);
+        gy = (float)(bl.z + 2*b.z + br.z) - (float)(tl.z + 2*t.z + tr.z);
+        sum += gx*gx + gy*gy;
+    }
+
+    smem[tid] = sum;
+    __syncthreads();
+
+    for (int s = 128; s > 0; s >>= 1)
+    {
+        if (tid < s)
+            smem[tid] += smem[tid + s];
+        __syncthreads();
+    }
+
+    if (tid == 0)
+        atomicAdd(energy, smem[0]);
+}
+
+
+float calcGradientEnergy(PtrStepSz<uchar3> frame, float *buf)
+{
+    cudaSafeCall(cudaMemset(buf, 0, sizeof(float)));
+
+    dim3 threads(32, 8);
+    dim3 grid(divUp(frame.cols, threads.x), divUp(frame.rows, threads.y));
+
+    calcGradientEnergyKernel<<<grid, threads>>>(frame, buf);
+    cudaSafeCall(cudaGetLastError());
+
+    float energy;
+    cudaSafeCall(cudaMemcpy(&energy, buf, sizeof(float), cudaMemcpyDeviceToHost));
+    return energy;
+}
+
+
+__global__ void deblurInitKernel(const PtrStepSz<uchar3> frame, PtrStep<float4> sums)
+{
+    const int x = blockDim.x * blockIdx.x + threadIdx.x;
+    const int y = blockDim.y * blockIdx.y + threadIdx.y;
+
+    if (x < frame.cols && y < frame.rows)
+    {
+        const uchar3 p = frame(y, x);
+        sums(y, x) = make_float4(p.x, p.y, p.z, 1.f);
+    }
+}
+
+
+// the neighbor pixels are weighted by the blurriness ratio and by the intensity difference,
+// the same way WeightingDeblurer does
+__global__ void deblurAccumulateKernel(
+        const PtrStepSz<uchar3> frame, const PtrStepSz<uchar3> neighbor, const Matx33 M,
+        const float bRatio, const float sensitivity, PtrStep<float4> sums)
+{
+    const int x = blockDim.x * blockIdx.x + threadIdx.x;
+    const int y = blockDim.y * blockIdx.y + threadIdx.y;
+
+    if (x < frame.cols && y < frame.rows)
+    {
+        const int x1 = __float2int_rn(M.m[0]*x + M.m[1]*y + M.m[2]);
+        const int y1 = __float2int_rn(M.m[3]*x + M.m[4]*y + M.m[5]);
+
+        if (x1 >= 0 && x1 < neighbor.cols && y1 >= 0 && y1 < neighbor.rows)
+        {
+            const uchar3 p = frame(y, x);
+            const uchar3 p1 = neighbor(y1, x1);
+            const float w = bRatio * sensitivity / (sensitivity + ::fabsf(intensity(p1) - intensity(p)));
+
+            float4 s = sums(y, x);
+            s.x += w * p1.x;
+            s.y += w * p1.y;
+            s.z += w * p1.z;
+            s.w += w;
+            sums(y, x) = s;
+        }
+    }
+}
+
+
+__global__ void deblurFinishKernel(const PtrStepSz<float4> sums, PtrStep<uchar3> frame)
+{
+    const int x = blockDim.x * blockIdx.x + threadIdx.x;
+    const int y = blockDim.y * blockIdx.y + threadIdx.y;
+
+    if (x < sums.cols && y < sums.rows)
+    {
+        const float4 s = sums(y, x);
+        const float wSumInv = 1.f / s.w;
+        frame(y, x) = make_uchar3(saturate_cast<uchar>(s.x * wSumInv),
+                                  saturate_cast<uchar>(s.y * wSumInv),
+                                  saturate_cast<uchar>(s.z * wSumInv));
+    }
+}
+
+
+void deblurInit(PtrStepSz<uchar3> frame, PtrStepSz<float4> sums)
+{
+    dim3 threads(32, 8);
+    dim3 grid(divUp(frame.cols, threads.x), divUp(frame.rows, threads.y));
+
+    deblurInitKernel<<<grid, threads>>>(frame, sums);
+    cudaSafeCall(cudaGetLastError());
+}
+
+
+void deblurAccumulate(
+        PtrStepSz<uchar3> frame, PtrStepSz<uchar3> neighbor, const float *M,
+        float bRatio, float sensitivity, PtrStepSz<float4> sums)
+{
+    dim3 threads(32, 8);
+    dim3 grid(divUp(frame.cols, threads.x), divUp(frame.rows, threads.y));
+
+    deblurAccumulateKernel<<<grid, threads>>>(frame, neighbor, makeMatx33(M), bRatio, sensitivity, sums);
+    cudaSafeCall(cudaGetLastError());
+}
+
+
+void deblurFinish(PtrStepSz<float4> sums, PtrStepSz<uchar3> frame)
+{
+    dim3 threads(32, 8);
+    dim3 grid(divUp(frame.cols, threads.x), divUp(frame.rows, threads.y));
+
+    deblurFinishKernel<<<grid, threads>>>(sums, frame);
+    cudaSafeCall(cudaGetLastError());
+}
+
+
+// 3x3 erosion, the pixels outside of the mask don't affect the result as with the default border of erode()
+__global__ void erodeMaskKernel(const PtrStepSzb src, PtrStepb dst)
+{
+    const int x = blockDim.x * blockIdx.x + threadIdx.x;
+    const int y = blockDim.y * blockIdx.y + threadIdx.y;
+
+    if (x < src.cols && y < src.rows)
+    {
+        uchar val = 255;
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            const int y1 = y + dy;
+            if (y1 < 0 || y1 >= src.rows)
+                continue;
+            for (int dx = -1; dx <= 1; ++dx)
+            {
+                const int x1 = x + dx;
+                if (x1 >= 0 && x1 < src.cols)
+                    val = ::min(val, src(y1, x1));
+            }
+        }
+        dst(y, x) = val;
+    }
+}
+
+
+void erodeMask(PtrStepSzb src, PtrStepSzb dst)
+{
+    dim3 threads(32, 8);
+    dim3 grid(divUp(src.cols, threads.x), divUp(src.rows, threads.y));
+
+    erodeMaskKernel<<<grid, threads>>>(src, dst);
+    cudaSafeCall(cudaGetLastError());
+}
+
+
+// fills the pixels which are still missing from the neighbor, M maps the stabilized frame into the neighbor
+__global__ void fillFromNeighborKernel(
+        const PtrStepSz<uchar3> neighbor, const Matx33 M, PtrStepSz<uchar3> frame, PtrStepb mask)
+{
+    const int x = blockDim.x * blockIdx.x + threadIdx.x;
+    const int y = blockDim.y * blockIdx.y + threadIdx.y;
+
+    if (x < frame.cols && y < frame.rows && !mask(y, x))
+    {
+        const float iz = 1.f / (M.m[6]*x + M.m[7]*y + M.m[8]);
+        const int x1 = __float2int_rn((M.m[0]*x + M.m[1]*y + M.m[2]) * iz);
+        const int y1 = __float2int_rn((M.m[3]*x + M.m[4]*y + M.m[5]) * iz);
+
+        if (x1 >= 0 && x1 < neighbor.cols && y1 >= 0 && y1 < neighbor.rows)
+        {
+            frame(y, x) = neighbor(y1, x1);
+            mask(y, x) = 255;
+        }
+    }
+}
+
+
+void fillFromNeighbor(PtrStepSz<uchar3> neighbor, const float *M, PtrStepSz<uchar3> frame, PtrStepSzb mask)
+{
+    dim3 threads(32, 8);
+    dim3 grid(divUp(frame.cols, threads.x), divUp(frame.rows, threads.y));
+
+    fillFromNeighborKernel<<<grid, threads>>>(neighbor, makeMatx33(M), frame, mask);
+    cudaSafeCall(cudaGetLastError());
+}
+
+}}}}
+
+
+#endif /* CUDA_DISABLER */
@@ -706,11 +706,12 @@ Mat ToFileMotionWriter::estimate(const Mat &frame0, const Mat &frame1, bool *ok)
 
 
 KeypointBasedMotionEstimator::KeypointBasedMotionEstimator(Ptr<MotionEstimatorBase> estimator)
-    : ImageMotionEstimatorBase(estimator->motionModel()), motionEstimator_(estimator)
+    : ImageMotionEstimatorBase(estimator->motionModel()), motionEstimator_(estimator), numDetected_(0)
 {
     setDetector(GFTTDetector::create());
     setOpticalFlowEstimator(makePtr<SparsePyrLkOptFlowEstimator>());
     setOutlierRejector(makePtr<NullOutlierRejector>());
+    setPointsReuseRatio(0.f);
 }
 
 
@@ -724,15 +725,30 @@ Mat KeypointBasedMotionEstimator::estimate(const Mat &frame0, const Mat &frame1,
 
 Mat KeypointBasedMotionEstimator::estimate(InputArray frame0, InputArray frame1, bool *ok)
 {
-    // find keypoints
-    detector_->detect(frame0, keypointsPrev_, mask_);
-    if (keypointsPrev_.empty())
-        return Mat::eye(3, 3, CV_32F);
-
-    // extract points from keypoints
-    pointsPrev_.resize(keypointsPrev_.size());
-    for (size_t i = 0; i < keypointsPrev_.size(); ++i)
-        pointsPrev_[i] = keypointsPrev_[i].pt;
+    // continue with the points tracked into frame0 by the previous call if enough of them are left
+    const bool reusePoints =
+            pointsReuseRatio_ > 0.f && frame0.isMat() && !frame1Prev_.empty() &&
+            frame0.getMat().data == frame1Prev_.data && frame0.size() == frame1Prev_.size() &&
+            !pointsReused_.empty() && (double)pointsReused_.size() >= pointsReuseRatio_ * (double)numDetected_;
+    frame1Prev_.release();
+
+    if (reusePoints)
+    {
+        pointsPrev_.swap(pointsReused_);
+    }
+    else
+    {
+        // find keypoints
+        detector_->detect(frame0, keypointsPrev_, mask_);
+        if (keypointsPrev_.empty())
+            return Mat::eye(3, 3, CV_32F);
+
+        // extract points from keypoints
+        pointsPrev_.resize(keypointsPrev_.size());
+        for (size_t i = 0; i < keypointsPrev_.size(); ++i)
+            pointsPrev_[i] = keypointsPrev_[i].pt;
+        numDetected_ = pointsPrev_.size();
+    }
 
     // find correspondences
     optFlowEstimator_->run(frame0, frame1, pointsPrev_, points_, status_, noArray());
@@ -777,6 +793,12 @@ Mat KeypointBasedMotionEstimator::estimate(InputArray frame0, InputArray frame1,
         }
     }
 
+    if (pointsReuseRatio_ > 0.f && frame1.isMat())
+    {
+        frame1Prev_ = frame1.getMat();
+        pointsReused_ = pointsGood_;
+    }
+
     // estimate motion
     return motionEstimator_->estimate(pointsPrevGood_, pointsGood_, ok);
 }
@@ -118,6 +118,31 @@ Mat GaussianMotionFilter::stabilize(int idx, const std::vector<Mat> &motions, co
 }
 
 
+void ExponentialMotionFilter::setSmoothness(float val)
+{
+    CV_Assert(val >= 0.f && val < 1.f);
+    smoothness_ = val;
+}
+
+
+Mat ExponentialMotionFilter::stabilize(int idx, const std::vector<Mat> &motions, const Range &range)
+{
+    const Mat &cur = at(idx, motions);
+    if (idx != lastIdx_ + 1 || idx <= range.start || lastStabilizationMotion_.empty())
+    {
+        lastStabilizationMotion_ = Mat::eye(cur.size(), cur.type());
+    }
+    else
+    {
+        // the previous stabilized frame seen from the current one, blended with the current frame
+        Mat M = lastStabilizationMotion_ * getMotion(idx, idx - 1, motions);
+        lastStabilizationMotion_ = smoothness_ * M + (1.f - smoothness_) * Mat::eye(cur.size(), cur.type());
+    }
+    lastIdx_ = idx;
+    return lastStabilizationMotion_.clone();
+}
+
+
 LpMotionStabilizer::LpMotionStabilizer(MotionModel model)
 {
     setMotionModel(model);
@@ -314,6 +314,7 @@ TwoPassStabilizer::TwoPassStabilizer()
     setMotionStabilizer(makePtr<GaussianMotionFilter>());
     setWobbleSuppressor(makePtr<NullWobbleSuppressor>());
     setEstimateTrimRatio(false);
+    setPrePassQueueSize(64);
     reset();
 }
 
@@ -382,43 +383,21 @@ void TwoPassStabilizer::runPrePassIfNecessary()
         clock_t startTime = clock();
         log_->print("first pass: estimating motions");
 
-        Mat prevFrame, frame;
-        bool ok = true, ok2 = true;
-
-        while (!(frame = frameSource_->nextFrame()).empty())
+        Mat firstFrame = frameSource_->nextFrame();
+        if (!firstFrame.empty())
         {
-            if (frameCount_ > 0)
-            {
-                if (maskSource_)
-                    motionEstimator_->setFrameMask(maskSource_->nextFrame());
-
-                motions_.push_back(motionEstimator_->estimate(prevFrame, frame, &ok));
-
-                if (doWobbleSuppression_)
-                {
-                    Mat M = wobbleSuppressor_->motionEstimator()->estimate(prevFrame, frame, &ok2);
-                    if (ok2)
-                        motions2_.push_back(M);
-                    else
-                        motions2_.push_back(motions_.back());
-                }
-
-                if (ok)
-                {
-                    if (ok2) log_->print(".");
-                    else log_->print("?");
-                }
-                else log_->print("x");
-            }
+            frameSize_ = firstFrame.size();
+            frameMask_.create(frameSize_, CV_8U);
+            frameMask_.setTo(255);
+
+            if (!motionsCacheFile_.empty() && readMotionsCache(firstFrame))
+                log_->print(" (read from %s)", motionsCacheFile_.c_str());
             else
             {
-                frameSize_ = frame.size();
-                frameMask_.create(frameSize_, CV_8U);
-                frameMask_.setTo(255);
+                estimatePrePassMotions(firstFrame);
+                if (!motionsCacheFile_.empty())
+                    writeMotionsCache(firstFrame);
             }
-
-            prevFrame = frame;
-            frameCount_++;
         }
 
         clock_t elapsedTime = clock() - startTime;
@@ -465,6 +444,200 @@ void TwoPassStabilizer::runPrePassIfNecessary()
 }
 
 
+class PrePassMotionEstimationBody : public ParallelLoopBody
+{
+public:
+    PrePassMotionEstimationBody(
+            const std::vector<Ptr<ImageMotionEstimatorBase> > &estimators, int numWorkers,
+            const std::vector<Mat> &frames, const std::vector<Mat> &masks,
+            std::vector<Mat> &motions, std::vector<uchar> &ok)
+        : estimators_(estimators), numWorkers_(numWorkers), frames_(frames), masks_(masks),
+          motions_(motions), ok_(ok)
+    {
+    }
+
+    virtual void operator()(const Range &range) const CV_OVERRIDE
+    {
+        int numPairs = static_cast<int>(motions_.size());
+        for (int w = range.start; w < range.end; ++w)
+        {
+            // the pairs of a worker are contiguous, so the estimator may reuse the data of its previous pair
+            ImageMotionEstimatorBase &estimator = *estimators_[w];
+            int iEnd = (w + 1) * numPairs / numWorkers_;
+            for (int i = w * numPairs / numWorkers_; i < iEnd; ++i)
+            {
+                if (!masks_.empty())
+                    estimator.setFrameMask(masks_[i + 1]);
+
+                bool ok = true;
+                motions_[i] = estimator.estimate(frames_[i], frames_[i + 1], &ok);
+                ok_[i] = ok;
+            }
+        }
+    }
+
+private:
+    const std::vector<Ptr<ImageMotionEstimatorBase> > &estimators_;
+    int numWorkers_;
+    const std::vector<Mat> &frames_;
+    const std::vector<Mat> &masks_;
+    std::vector<Mat> &motions_;
+    std::vector<uchar> &ok_;
+
+    PrePassMotionEstimationBody& operator=(const PrePassMotionEstimationBody&);
+};
+
+
+void TwoPassStabilizer::estimatePrePassMotions(const Mat &firstFrame)
+{
+    std::vector<Ptr<ImageMotionEstimatorBase> > estimators = prePassMotionEstimators_;
+    if (estimators.empty())
+        estimators.push_back(motionEstimator_);
+    for (size_t i = 0; i < estimators.size(); ++i)
+        CV_Assert(estimators[i] && estimators[i]->motionModel() == motionEstimator_->motionModel());
+
+    std::vector<Mat> frames(1, firstFrame), masks;
+    if (maskSource_)
+        masks.push_back(maskSource_->nextFrame());
+    frameCount_ = 1;
+
+    std::vector<Mat> motions;
+    std::vector<uchar> ok;
+    bool done = false;
+
+    while (!done)
+    {
+        // the last frame of the previous part is the first frame of the next one
+
+        frames.erase(frames.begin(), frames.end() - 1);
+        if (maskSource_)
+            masks.erase(masks.begin(), masks.end() - 1);
+
+        while (static_cast<int>(frames.size()) <= prePassQueueSize_)
+        {
+            Mat frame = frameSource_->nextFrame();
+            if (frame.empty())
+            {
+                done = true;
+                break;
+            }
+            frames.push_back(frame);
+            if (maskSource_)
+                masks.push_back(maskSource_->nextFrame());
+            frameCount_++;
+        }
+
+        int numPairs = static_cast<int>(frames.size()) - 1;
+        if (numPairs == 0)
+            break;
+
+        motions.assign(numPairs, Mat());
+        ok.assign(numPairs, 0);
+        int numWorkers = std::min(static_cast<int>(estimators.size()), numPairs);
+        parallel_for_(Range(0, numWorkers),
+                      PrePassMotionEstimationBody(estimators, numWorkers, frames, masks, motions, ok),
+                      numWorkers);
+
+        for (int i = 0; i < numPairs; ++i)
+        {
+            motions_.push_back(motions[i]);
+
+            bool ok2 = true;
+            if (doWobbleSuppression_)
+            {
+                Mat M = wobbleSuppressor_->motionEstimator()->estimate(frames[i], frames[i + 1], &ok2);
+                if (ok2)
+                    motions2_.push_back(M);
+                else
+                    motions2_.push_back(motions_.back());
+            }
+
+            if (ok[i])
+            {
+                if (ok2) log_->print(".");
+                else log_->print("?");
+            }
+            else log_->print("x");
+        }
+    }
+}
+
+
+static const char *motionsCacheTag = "videostab_motions";
+static const int motionsCacheVersion = 1;
+
+
+bool TwoPassStabilizer::readMotionsCache(const Mat &firstFrame)
+{
+    std::ifstream file(motionsCacheFile_.c_str());
+    if (!file.is_open())
+        return false;
+
+    // the cache is valid for the videos of the same first frame only
+
+    std::string tag;
+    int version = 0, frameCount = 0, cols = 0, rows = 0, type = -1, hasMotions2 = 0;
+    double firstFrameNorm = -1;
+    file >> tag >> version >> frameCount >> cols >> rows >> type >> firstFrameNorm >> hasMotions2;
+    if (!file || tag != motionsCacheTag || version != motionsCacheVersion || frameCount < 1 ||
+        Size(cols, rows) != firstFrame.size() || type != firstFrame.type() ||
+        firstFrameNorm != norm(firstFrame, NORM_L1) || (doWobbleSuppression_ && !hasMotions2))
+        return false;
+
+    std::vector<Mat> motions[2];
+    for (int j = 0; j < (hasMotions2 ? 2 : 1); ++j)
+    {
+        for (int i = 0; i < frameCount - 1; ++i)
+        {
+            Mat_<float> M(3, 3);
+            bool ok;
+            file >> M(0,0) >> M(0,1) >> M(0,2)
+                 >> M(1,0) >> M(1,1) >> M(1,2)
+                 >> M(2,0) >> M(2,1) >> M(2,2) >> ok;
+            motions[j].push_back(M);
+        }
+    }
+    if (!file)
+        return false;
+
+    frameCount_ = frameCount;
+    motions_.swap(motions[0]);
+    if (doWobbleSuppression_)
+        motions2_.swap(motions[1]);
+    return true;
+}
+
+
+void TwoPassStabilizer::writeMotionsCache(const Mat &firstFrame) const
+{
+    std::ofstream file(motionsCacheFile_.c_str());
+    if (!file.is_open())
+    {
+        log_->print("\ncan't write the motions cache %s", motionsCacheFile_.c_str());
+        return;
+    }
+
+    file.precision(17);
+    file << motionsCacheTag << " " << motionsCacheVersion << " " << frameCount_ << " "
+         << firstFrame.cols << " " << firstFrame.rows << " " << firstFrame.type() << " "
+         << norm(firstFrame, NORM_L1) << " " << (doWobbleSuppression_ ? 1 : 0) << std::endl;
+
+    // enough digits to read the same floats back
+    file.precision(9);
+    for (int j = 0; j < (doWobbleSuppression_ ? 2 : 1); ++j)
+    {
+        const std::vector<Mat> &motions = j == 0 ? motions_ : motions2_;
+        for (int i = 0; i < frameCount_ - 1; ++i)
+        {
+            Mat_<float> M = motions[i];
+            file << M(0,0) << " " << M(0,1) << " " << M(0,2) << " "
+                 << M(1,0) << " " << M(1,1) << " " << M(1,2) << " "
+                 << M(2,0) << " " << M(2,1) << " " << M(2,2) << " " << 1 << std::endl;
+        }
+    }
+}
+
+
 void TwoPassStabilizer::setUp(const Mat &firstFrame)
 {
     int cacheSize = 2*radius_ + 1;
@@ -0,0 +1,377 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+#include "opencv2/videostab/stabilizer.hpp"
+#include "opencv2/videostab/ring_buffer.hpp"
+
+#include "opencv2/core/private.cuda.hpp"
+
+#if defined(HAVE_OPENCV_CUDAIMGPROC) && defined(HAVE_OPENCV_CUDAOPTFLOW) && defined(HAVE_OPENCV_CUDAWARPING)
+#  include "opencv2/cudaimgproc.hpp"
+#  include "opencv2/cudawarping.hpp"
+
+    #if !defined HAVE_CUDA || defined(CUDA_DISABLER)
+        namespace cv { namespace cuda {
+            static float calcBlurriness(const GpuMat&, GpuMat&) { throw_no_cuda(); return 0; }
+            static void deblurInit(const GpuMat&, GpuMat&) { throw_no_cuda(); }
+            static void deblurAccumulate(const GpuMat&, const GpuMat&, const Mat&, float, float, GpuMat&) { throw_no_cuda(); }
+            static void deblurFinish(const GpuMat&, GpuMat&) { throw_no_cuda(); }
+            static void erodeMask(const GpuMat&, GpuMat&) { throw_no_cuda(); }
+            static void fillFromNeighbor(const GpuMat&, const Mat&, GpuMat&, GpuMat&) { throw_no_cuda(); }
+        }}
+    #else
+        namespace cv { namespace cuda { namespace device { namespace stabilizer {
+            float calcGradientEnergy(PtrStepSz<uchar3> frame, float *buf);
+            void deblurInit(PtrStepSz<uchar3> frame, PtrStepSz<float4> sums);
+            void deblurAccumulate(
+                    PtrStepSz<uchar3> frame, PtrStepSz<uchar3> neighbor, const float *M,
+                    float bRatio, float sensitivity, PtrStepSz<float4> sums);
+            void deblurFinish(PtrStepSz<float4> sums, PtrStepSz<uchar3> frame);
+            void erodeMask(PtrStepSzb src, PtrStepSzb dst);
+            void fillFromNeighbor(PtrStepSz<uchar3> neighbor, const float *M, PtrStepSz<uchar3> frame, PtrStepSzb mask);
+        }}}}
+        namespace cv { namespace cuda {
+            static float calcBlurriness(const GpuMat &frame, GpuMat &buf)
+            {
+                CV_Assert(frame.type() == CV_8UC3);
+                buf.create(1, 1, CV_32F);
+                float sumSq = cv::cuda::device::stabilizer::calcGradientEnergy(frame, buf.ptr<float>());
+                return static_cast<float>(1. / (sumSq / frame.size().area() + 1e-6));
+            }
+
+            static void deblurInit(const GpuMat &frame, GpuMat &sums)
+            {
+                CV_Assert(frame.type() == CV_8UC3);
+                sums.create(frame.size(), CV_32FC4);
+                cv::cuda::device::stabilizer::deblurInit(frame, sums);
+            }
+
+            static void deblurAccumulate(
+                    const GpuMat &frame, const GpuMat &neighbor, const Mat &M,
+                    float bRatio, float sensitivity, GpuMat &sums)
+            {
+                CV_Assert(M.size() == Size(3, 3) && M.type() == CV_32F && M.isContinuous());
+                CV_Assert(neighbor.type() == CV_8UC3 && sums.size() == frame.size());
+                cv::cuda::device::stabilizer::deblurAccumulate(
+                            frame, neighbor, M.ptr<float>(), bRatio, sensitivity, sums);
+            }
+
+            static void deblurFinish(const GpuMat &sums, GpuMat &frame)
+            {
+                CV_Assert(sums.type() == CV_32FC4 && sums.size() == frame.size());
+                cv::cuda::device::stabilizer::deblurFinish(sums, frame);
+            }
+
+            static void erodeMask(const GpuMat &src, GpuMat &dst)
+            {
+                CV_Assert(src.type() == CV_8U && src.data != dst.data);
+                dst.create(src.size(), CV_8U);
+                cv::cuda::device::stabilizer::erodeMask(src, dst);
+            }
+
+            static void fillFromNeighbor(const GpuMat &neighbor, const Mat &M, GpuMat &frame, GpuMat &mask)
+            {
+                CV_Assert(M.size() == Size(3, 3) && M.type() == CV_32F && M.isContinuous());
+                CV_Assert(neighbor.type() == CV_8UC3 && frame.type() == CV_8UC3);
+                CV_Assert(mask.type() == CV_8U && mask.size() == frame.size());
+                cv::cuda::device::stabilizer::fillFromNeighbor(neighbor, M.ptr<float>(), frame, mask);
+            }
+        }}
+    #endif
+
+namespace cv
+{
+namespace videostab
+{
+
+#ifdef HAVE_OPENCV_CUDACODEC
+
+VideoReaderFrameSourceGpu::VideoReaderFrameSourceGpu(const String &path)
+    : path_(path)
+{
+    reset();
+}
+
+
+void VideoReaderFrameSourceGpu::reset()
+{
+    reader_ = cudacodec::createVideoReader(path_);
+}
+
+
+bool VideoReaderFrameSourceGpu::nextFrame(cuda::GpuMat &frame)
+{
+    if (!reader_->nextFrame(decoded_))
+        return false;
+    cuda::cvtColor(decoded_, frame, COLOR_BGRA2BGR);
+    return true;
+}
+
+#endif
+
+
+OnePassStabilizerGpu::OnePassStabilizerGpu()
+{
+    setLog(makePtr<LogToStdout>());
+    setMotionEstimator(makePtr<KeypointBasedMotionEstimatorGpu>(makePtr<MotionEstimatorRansacL2>()));
+    setMotionFilter(makePtr<GaussianMotionFilter>());
+    setRadius(15);
+    setTrimRatio(0);
+    setCorrectionForInclusion(false);
+    setBorderMode(BORDER_REPLICATE);
+    setDeblurringSensitivity(0);
+    setInpainting(false);
+    reset();
+}
+
+
+void OnePassStabilizerGpu::reset()
+{
+    frameSize_ = Size(0, 0);
+    frameType_ = -1;
+    curPos_ = -1;
+    curStabilizedPos_ = -1;
+    frameMask_.release();
+    preProcessedFrame_.release();
+    warpedMask_.release();
+    inpaintingMask_.release();
+    deblurSums_.release();
+    frames_.clear();
+    stabilizedFrames_.clear();
+    stabilizedMasks_.clear();
+    motions_.clear();
+    stabilizationMotions_.clear();
+    blurrinessRates_.clear();
+    frame_.release();
+    blurrinessBuf_.release();
+}
+
+
+bool OnePassStabilizerGpu::nextFrame(cuda::GpuMat &frame)
+{
+    CV_Assert(frameSource_);
+
+    // check if we've processed all frames already
+    if (curStabilizedPos_ == curPos_ && curStabilizedPos_ != -1)
+        return false;
+
+    bool processed;
+    do processed = doOneIteration();
+    while (processed && curStabilizedPos_ == -1);
+
+    // check if the frame source is empty
+    if (curStabilizedPos_ == -1)
+        return false;
+
+    // trim frame
+    const cuda::GpuMat &stabilized = at(curStabilizedPos_, stabilizedFrames_);
+    int dx = static_cast<int>(floor(trimRatio_ * stabilized.cols));
+    int dy = static_cast<int>(floor(trimRatio_ * stabilized.rows));
+    frame = stabilized(Rect(dx, dy, stabilized.cols - 2*dx, stabilized.rows - 2*dy));
+    return true;
+}
+
+
+bool OnePassStabilizerGpu::doOneIteration()
+{
+    if (frameSource_->nextFrame(frame_))
+    {
+        CV_Assert(frame_.type() == CV_8UC3);
+        curPos_++;
+
+        if (curPos_ > 0)
+        {
+            CV_Assert(frame_.size() == frameSize_);
+
+            // the source may reuse its buffer, so the frames of the radius are copied into the ring
+            frame_.copyTo(at(curPos_, frames_));
+
+            if (deblurringSensitivity_ > 0)
+                at(curPos_, blurrinessRates_) = cuda::calcBlurriness(at(curPos_, frames_), blurrinessBuf_);
+
+            at(curPos_ - 1, motions_) = motionEstimator_->estimate(
+                        at(curPos_ - 1, frames_), at(curPos_, frames_));
+
+            if (curPos_ >= radius_)
+            {
+                curStabilizedPos_ = curPos_ - radius_;
+                stabilizeFrame();
+            }
+        }
+        else
+            setUp(frame_);
+
+        log_->print(".");
+        return true;
+    }
+    else if (curStabilizedPos_ < curPos_)
+    {
+        curStabilizedPos_++;
+        at(curPos_, motions_) = Mat::eye(3, 3, CV_32F);
+        stabilizeFrame();
+
+        log_->print(".");
+        return true;
+    }
+
+    return false;
+}
+
+
+void OnePassStabilizerGpu::setUp(const cuda::GpuMat &firstFrame)
+{
+    frameSize_ = firstFrame.size();
+    frameType_ = firstFrame.type();
+    frameMask_.create(frameSize_, CV_8U);
+    frameMask_.setTo(Scalar::all(255));
+
+    int cacheSize = 2*radius_ + 1;
+    frames_.resize(cacheSize);
+    stabilizedFrames_.resize(cacheSize);
+    stabilizedMasks_.resize(cacheSize);
+    motions_.resize(cacheSize);
+    stabilizationMotions_.resize(cacheSize);
+
+    // every slot gets its own buffer as the slots are overwritten in place later
+    for (int i = -radius_; i <= 0; ++i)
+    {
+        at(i, motions_) = Mat::eye(3, 3, CV_32F);
+        firstFrame.copyTo(at(i, frames_));
+    }
+
+    if (deblurringSensitivity_ > 0)
+    {
+        blurrinessRates_.resize(cacheSize);
+        float blurriness = cuda::calcBlurriness(firstFrame, blurrinessBuf_);
+        for (int i = -radius_; i <= 0; ++i)
+            at(i, blurrinessRates_) = blurriness;
+    }
+
+    log_->print("processing frames");
+}
+
+
+void OnePassStabilizerGpu::stabilizeFrame()
+{
+    Mat stabilizationMotion = motionFilter_->stabilize(curStabilizedPos_, motions_, Range(0, curPos_));
+    if (doCorrectionForInclusion_)
+        stabilizationMotion = ensureInclusionConstraint(stabilizationMotion, frameSize_, trimRatio_);
+
+    at(curStabilizedPos_, stabilizationMotions_) = stabilizationMotion;
+
+    const cuda::GpuMat &frame = at(curStabilizedPos_, frames_);
+
+    // deblur with the neighbors which are sharper than the frame
+
+    if (deblurringSensitivity_ > 0)
+    {
+        cuda::deblurInit(frame, deblurSums_);
+
+        float blurriness = at(curStabilizedPos_, blurrinessRates_);
+        int iMin = std::max(curStabilizedPos_ - radius_, 0);
+        int iMax = std::min(curStabilizedPos_ + radius_, curPos_);
+        for (int k = iMin; k <= iMax; ++k)
+        {
+            float bRatio = blurriness / at(k, blurrinessRates_);
+            if (bRatio > 1.f)
+                cuda::deblurAccumulate(
+                        frame, at(k, frames_), getMotion(curStabilizedPos_, k, motions_),
+                        bRatio, deblurringSensitivity_, deblurSums_);
+        }
+
+        preProcessedFrame_.create(frameSize_, frameType_);
+        cuda::deblurFinish(deblurSums_, preProcessedFrame_);
+    }
+    const cuda::GpuMat &src = deblurringSensitivity_ > 0 ? preProcessedFrame_ : frame;
+
+    // apply stabilization transformation
+
+    MotionModel model = motionEstimator_->motionModel();
+    cuda::GpuMat &stabilizedFrame = at(curStabilizedPos_, stabilizedFrames_);
+
+    if (model != MM_HOMOGRAPHY)
+        cuda::warpAffine(
+                src, stabilizedFrame, stabilizationMotion(Rect(0,0,3,2)),
+                frameSize_, INTER_LINEAR, borderMode_);
+    else
+        cuda::warpPerspective(
+                src, stabilizedFrame, stabilizationMotion,
+                frameSize_, INTER_LINEAR, borderMode_);
+
+    if (doInpainting_)
+    {
+        if (model != MM_HOMOGRAPHY)
+            cuda::warpAffine(
+                    frameMask_, warpedMask_, stabilizationMotion(Rect(0,0,3,2)),
+                    frameSize_, INTER_NEAREST);
+        else
+            cuda::warpPerspective(
+                    frameMask_, warpedMask_, stabilizationMotion, frameSize_, INTER_NEAREST);
+
+        cuda::GpuMat &stabilizedMask = at(curStabilizedPos_, stabilizedMasks_);
+        cuda::erodeMask(warpedMask_, stabilizedMask);
+        stabilizedMask.copyTo(inpaintingMask_);
+
+        // fill the missing pixels from the nearest frames first, the mosaic differs from
+        // ConsistentMosaicInpainter as no median over the neighbors is taken
+
+        Mat invS = stabilizationMotion.inv();
+        for (int d = 1; d <= radius_; ++d)
+        {
+            for (int sign = -1; sign <= 1; sign += 2)
+            {
+                int k = curStabilizedPos_ + sign*d;
+                if (k < 0 || k > curPos_)
+                    continue;
+
+                Mat M = getMotion(curStabilizedPos_, k, motions_) * invS;
+                cuda::fillFromNeighbor(at(k, frames_), M, stabilizedFrame, inpaintingMask_);
+            }
+        }
+    }
+}
+
+} // namespace videostab
+} // namespace cv
+
+#endif // defined(HAVE_OPENCV_CUDAIMGPROC) && defined(HAVE_OPENCV_CUDAOPTFLOW) && defined(HAVE_OPENCV_CUDAWARPING)
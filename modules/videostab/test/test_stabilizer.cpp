@@ -33,6 +33,49 @@ private:
     Mat frame_;
 };
 
+class FramesTestSource : public IFrameSource
+{
+public:
+    FramesTestSource(const Mat &frame, int frameCount)
+    {
+        frameNumber_ = 0;
+        frameCount_ = frameCount;
+        frame_ = frame;
+    }
+
+    virtual void reset() CV_OVERRIDE
+    {
+        frameNumber_ = 0;
+    }
+
+    virtual Mat nextFrame() CV_OVERRIDE
+    {
+        return (frameNumber_++ < frameCount_) ? frame_.clone() : Mat();
+    }
+
+private:
+    int frameNumber_;
+    int frameCount_;
+    Mat frame_;
+};
+
+class TranslationTestEstimator : public ImageMotionEstimatorBase
+{
+public:
+    TranslationTestEstimator() : ImageMotionEstimatorBase(MM_AFFINE), calls(0) {}
+
+    virtual Mat estimate(const Mat &/*frame0*/, const Mat &/*frame1*/, bool *ok) CV_OVERRIDE
+    {
+        CV_XADD(&calls, 1);
+        if (ok) *ok = true;
+        Mat M = Mat::eye(3, 3, CV_32F);
+        M.at<float>(0, 2) = 0.5f;
+        return M;
+    }
+
+    int calls;
+};
+
 TEST(OnePassStabilizer, oneFrame)
 {
     Mat frame(2, 3, CV_8UC3);
@@ -79,4 +122,99 @@ TEST(TwoPassStabilizer, oneFrame)
     EXPECT_TRUE(stabilizer.nextFrame().empty());
 }
 
+TEST(ExponentialMotionFilter, constantTranslation)
+{
+    const int n = 50;
+    std::vector<Mat> motions(n);
+    for (int i = 0; i < n; ++i)
+    {
+        motions[i] = Mat::eye(3, 3, CV_32F);
+        motions[i].at<float>(0, 2) = 1.f;
+    }
+
+    ExponentialMotionFilter filter(0.5f);
+    Mat S = filter.stabilize(0, motions, Range(0, n));
+    EXPECT_MAT_NEAR(Mat::eye(3, 3, CV_32F), S, 0);
+
+    // the stabilized camera lags behind by smoothness / (1 - smoothness) pixels
+    for (int i = 1; i < n; ++i)
+        S = filter.stabilize(i, motions, Range(0, n));
+    Mat expected = Mat::eye(3, 3, CV_32F);
+    expected.at<float>(0, 2) = -1.f;
+    EXPECT_MAT_NEAR(expected, S, 1e-4);
+
+    // starts over when a frame is skipped
+    S = filter.stabilize(n / 2, motions, Range(0, n));
+    EXPECT_MAT_NEAR(Mat::eye(3, 3, CV_32F), S, 0);
+}
+
+TEST(OnePassStabilizer, oneFrame_exponentialFilter)
+{
+    Mat frame(2, 3, CV_8UC3);
+    randu(frame, Scalar::all(0), Scalar::all(255));
+
+    OnePassStabilizer stabilizer;
+    stabilizer.setRadius(1);
+    stabilizer.setMotionFilter(makePtr<ExponentialMotionFilter>());
+    stabilizer.setFrameSource(makePtr<OneFrameTestSource>(frame));
+
+    Mat stabilizedFrame = stabilizer.nextFrame();
+    EXPECT_MAT_NEAR(frame, stabilizedFrame, 0);
+    EXPECT_TRUE(stabilizer.nextFrame().empty());
+}
+
+TEST(TwoPassStabilizer, motionsCache)
+{
+    Mat frame(16, 16, CV_8UC3);
+    randu(frame, Scalar::all(0), Scalar::all(255));
+    const int frameCount = 10;
+    const std::string cacheFile = cv::tempfile(".txt");
+
+    std::vector<Ptr<TranslationTestEstimator> > estimators;
+    std::vector<Ptr<ImageMotionEstimatorBase> > prePassEstimators;
+    for (int i = 0; i < 3; ++i)
+    {
+        estimators.push_back(makePtr<TranslationTestEstimator>());
+        prePassEstimators.push_back(estimators.back());
+    }
+
+    Ptr<TranslationTestEstimator> estimator = makePtr<TranslationTestEstimator>();
+    TwoPassStabilizer stabilizer;
+    stabilizer.setRadius(2);
+    stabilizer.setFrameSource(makePtr<FramesTestSource>(frame, frameCount));
+    stabilizer.setMotionEstimator(estimator);
+    stabilizer.setPrePassMotionEstimators(prePassEstimators);
+    stabilizer.setPrePassQueueSize(4);
+    stabilizer.setMotionsCacheFile(cacheFile);
+
+    std::vector<Mat> stabilizedFrames;
+    for (Mat stabilizedFrame; !(stabilizedFrame = stabilizer.nextFrame()).empty();)
+        stabilizedFrames.push_back(stabilizedFrame.clone());
+    ASSERT_EQ(frameCount, (int)stabilizedFrames.size());
+
+    int calls = 0;
+    for (size_t i = 0; i < estimators.size(); ++i)
+        calls += estimators[i]->calls;
+    EXPECT_EQ(frameCount - 1, calls);
+    EXPECT_EQ(0, estimator->calls);
+
+    // the second run reads the motions back
+    Ptr<TranslationTestEstimator> estimator2 = makePtr<TranslationTestEstimator>();
+    TwoPassStabilizer stabilizer2;
+    stabilizer2.setRadius(2);
+    stabilizer2.setFrameSource(makePtr<FramesTestSource>(frame, frameCount));
+    stabilizer2.setMotionEstimator(estimator2);
+    stabilizer2.setMotionsCacheFile(cacheFile);
+
+    for (int i = 0; i < frameCount; ++i)
+    {
+        Mat stabilizedFrame = stabilizer2.nextFrame();
+        EXPECT_MAT_NEAR(stabilizedFrames[i], stabilizedFrame, 0);
+    }
+    EXPECT_TRUE(stabilizer2.nextFrame().empty());
+    EXPECT_EQ(0, estimator2->calls);
+
+    remove(cacheFile.c_str());
+}
+
 }} // namespace
@@ -213,6 +213,24 @@ namespace cv
          */
         CV_EXPORTS_W void computeNormals(const Mesh& mesh, OutputArray normals);
 
+        ///////////////////////////////////////////////////////////////////////////////////////////////
+        /** Decimating clouds on a voxel grid
+         * @param cloud Input cloud. Supported depths: CV_32F and CV_64F. Supported channels: 3 and 4.
+         * @param decimated_cloud Mean of the points of every occupied voxel, a row of the type of cloud.
+         * @param voxel_size Edge length of the cubic voxels.
+         * @param colors Colors of the points. Supported depth: CV_8U. Supported channels: 1, 3 and 4.
+         * @param decimated_colors Mean color of every occupied voxel.
+         * @param normals Normals of the points. Supported depths: CV_32F and CV_64F. Supported channels: 3 and 4.
+         * @param decimated_normals Normalized mean normal of every occupied voxel.
+         *
+         * Points set to (NaN, NaN, NaN) are skipped. The voxels are output in the order of their first
+         * point, so that the decimation of a large cloud can be displayed in place of it while the
+         * viewer has to stay interactive.
+         */
+        CV_EXPORTS void decimateCloud(InputArray cloud, OutputArray decimated_cloud, double voxel_size,
+                                      InputArray colors = noArray(), OutputArray decimated_colors = noArray(),
+                                      InputArray normals = noArray(), OutputArray decimated_normals = noArray());
+
 //! @}
 
     } /* namespace viz */
@@ -715,6 +715,24 @@ namespace cv
             Points in the cloud belong to mask when they are set to (NaN, NaN, NaN).
              */
             WCloud(InputArray cloud, const Color &color, InputArray normals);
+
+            /** @brief Replaces the points of the widget.
+            @param cloud Set of points which can be of type: CV_32FC3, CV_32FC4, CV_64FC3, CV_64FC4.
+            @param colors Set of colors. It has to be of the same size with cloud.
+            @param normals Normals for each point in cloud. Size and type should match with the cloud parameter.
+
+            The arrays of the widget are overwritten in place when the number of valid points and the
+            types do not change, which makes it suitable to display a cloud updated every frame. Large
+            clouds can be decimated with viz::decimateCloud beforehand.
+             */
+            void setCloud(InputArray cloud, InputArray colors, InputArray normals = noArray());
+
+            /** @overload
+            @param cloud Set of points which can be of type: CV_32FC3, CV_32FC4, CV_64FC3, CV_64FC4.
+            @param color A single Color for the whole cloud.
+            @param normals Normals for each point in cloud.
+             */
+            void setCloud(InputArray cloud, const Color &color = Color::white(), InputArray normals = noArray());
         };
 
         class CV_EXPORTS WPaintedCloud: public Widget3D
@@ -74,8 +74,9 @@ cv::viz::WCloud::WCloud(cv::InputArray cloud, cv::InputArray colors, cv::InputAr
     cloud_source->SetColorCloudNormals(cloud, colors, normals);
     cloud_source->Update();
 
+    // The source stays connected to the mapper so that setCloud updates its arrays in place
     vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-    VtkUtils::SetInputData(mapper, cloud_source->GetOutput());
+    mapper->SetInputConnection(cloud_source->GetOutputPort());
     mapper->SetScalarModeToUsePointData();
 #if VTK_MAJOR_VERSION < 8
     mapper->ImmediateModeRenderingOff();
@@ -91,6 +92,37 @@ cv::viz::WCloud::WCloud(cv::InputArray cloud, cv::InputArray colors, cv::InputAr
     WidgetAccessor::setProp(*this, actor);
 }
 
+void cv::viz::WCloud::setCloud(InputArray cloud, InputArray colors, InputArray normals)
+{
+    CV_Assert(!cloud.empty() && !colors.empty());
+
+    vtkActor *actor = vtkActor::SafeDownCast(WidgetAccessor::getProp(*this));
+    CV_Assert("Widget type is not supported." && actor);
+
+    vtkSmartPointer<vtkPolyDataMapper> mapper = vtkPolyDataMapper::SafeDownCast(actor->GetMapper());
+    CV_Assert("Widget doesn't have a polydata mapper" && mapper);
+
+    vtkSmartPointer<vtkCloudMatSource> cloud_source;
+    if (mapper->GetNumberOfInputConnections(0) > 0)
+        cloud_source = vtkCloudMatSource::SafeDownCast(mapper->GetInputConnection(0, 0)->GetProducer());
+
+    // The source is disconnected once the points were transformed with applyTransform
+    if (!cloud_source)
+    {
+        cloud_source = vtkSmartPointer<vtkCloudMatSource>::New();
+        mapper->SetInputConnection(cloud_source->GetOutputPort());
+    }
+
+    cloud_source->SetColorCloudNormals(cloud, colors, normals);
+    cloud_source->Modified();
+    mapper->Update();
+}
+
+void cv::viz::WCloud::setCloud(InputArray cloud, const Color &color, InputArray normals)
+{
+    setCloud(cloud, Mat(cloud.size(), CV_8UC3, color), normals);
+}
+
 template<> cv::viz::WCloud cv::viz::Widget::cast<cv::viz::WCloud>() const
 {
     Widget3D widget = this->cast<Widget3D>();
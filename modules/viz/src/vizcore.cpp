@@ -45,6 +45,8 @@
 
 #include "precomp.hpp"
 
+#include <unordered_map>
+
 cv::Affine3d cv::viz::makeTransformToGlobal(const Vec3d& axis_x, const Vec3d& axis_y, const Vec3d& axis_z, const Vec3d& origin)
 {
     Affine3d::Mat3 R(axis_x[0], axis_y[0], axis_z[0],
@@ -350,3 +352,172 @@ void cv::viz::computeNormals(const Mesh& mesh, OutputArray _normals)
     else
         _normals.release();
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+/// Decimating clouds on a voxel grid
+
+namespace cv { namespace viz { namespace
+{
+    // Labels every point with the index of its voxel, in the order of the first point of the
+    // voxels, and -1 for the points set to NaN. Returns the number of occupied voxels.
+    template<typename _Tp>
+    int labelVoxels(const Mat& cloud, double voxel_size, std::vector<int>& labels)
+    {
+        const int cn = cloud.channels();
+        const int bits = 21;
+
+        Vec3d lo = Vec3d::all(std::numeric_limits<double>::max()), hi = -lo;
+        for (int y = 0; y < cloud.rows; ++y)
+        {
+            const _Tp* srow = cloud.ptr<_Tp>(y);
+            for (int x = 0; x < cloud.cols; ++x, srow += cn)
+                if (!isNan(srow))
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        lo[c] = std::min(lo[c], (double)srow[c]);
+                        hi[c] = std::max(hi[c], (double)srow[c]);
+                    }
+        }
+
+        for (int c = 0; c < 3; ++c)
+            CV_Assert("Voxel size is too small for the extent of the cloud." && (hi[c] - lo[c]) / voxel_size < (1 << bits) - 1);
+
+        std::unordered_map<uint64, int> voxels;
+        labels.resize(cloud.total());
+        int *label = labels.data();
+        for (int y = 0; y < cloud.rows; ++y)
+        {
+            const _Tp* srow = cloud.ptr<_Tp>(y);
+            for (int x = 0; x < cloud.cols; ++x, srow += cn, ++label)
+            {
+                if (isNan(srow))
+                {
+                    *label = -1;
+                    continue;
+                }
+
+                uint64 key = 0;
+                for (int c = 0; c < 3; ++c)
+                    key = (key << bits) | (uint64)((srow[c] - lo[c]) / voxel_size);
+                *label = voxels.insert(std::make_pair(key, (int)voxels.size())).first->second;
+            }
+        }
+        return (int)voxels.size();
+    }
+
+    // Mean of the elements of every voxel as a row of CV_64F elements with the channels of src
+    template<typename _Tp>
+    Mat voxelMeans(const Mat& src, const std::vector<int>& labels, const std::vector<int>& counts)
+    {
+        const int cn = src.channels();
+        Mat means(1, (int)counts.size(), CV_64FC(cn), Scalar::all(0));
+        double *sums = means.ptr<double>();
+
+        const int *label = labels.data();
+        for (int y = 0; y < src.rows; ++y)
+        {
+            const _Tp* srow = src.ptr<_Tp>(y);
+            for (int x = 0; x < src.cols; ++x, srow += cn, ++label)
+                if (*label >= 0)
+                {
+                    double *dst = sums + (size_t)*label * cn;
+                    for (int c = 0; c < cn; ++c)
+                        dst[c] += srow[c];
+                }
+        }
+
+        for (size_t i = 0; i < counts.size(); ++i)
+            for (int c = 0; c < cn; ++c)
+                sums[i * cn + c] /= counts[i];
+        return means;
+    }
+
+    Mat voxelMeans(const Mat& src, const std::vector<int>& labels, const std::vector<int>& counts)
+    {
+        switch (src.depth())
+        {
+        case CV_8U:  return voxelMeans<uchar>(src, labels, counts);
+        case CV_32F: return voxelMeans<float>(src, labels, counts);
+        case CV_64F: return voxelMeans<double>(src, labels, counts);
+        default: CV_Error(Error::StsError, "Unsupported depth");
+        }
+    }
+}}}
+
+void cv::viz::decimateCloud(InputArray _cloud, OutputArray _decimated_cloud, double voxel_size,
+                            InputArray _colors, OutputArray _decimated_colors,
+                            InputArray _normals, OutputArray _decimated_normals)
+{
+    CV_Assert(_cloud.depth() == CV_32F || _cloud.depth() == CV_64F);
+    CV_Assert(_cloud.channels() == 3 || _cloud.channels() == 4);
+    CV_Assert(voxel_size > 0);
+
+    Mat cloud = _cloud.getMat();
+    Mat colors = _colors.getMat();
+    Mat normals = _normals.getMat();
+
+    if (!colors.empty())
+    {
+        CV_Assert(colors.depth() == CV_8U && colors.channels() <= 4 && colors.channels() != 2);
+        CV_Assert(colors.size() == cloud.size());
+    }
+
+    if (!normals.empty())
+    {
+        CV_Assert(normals.depth() == CV_32F || normals.depth() == CV_64F);
+        CV_Assert(normals.channels() == 3 || normals.channels() == 4);
+        CV_Assert(normals.size() == cloud.size());
+    }
+
+    std::vector<int> labels;
+    int voxels = cloud.depth() == CV_32F ? labelVoxels<float>(cloud, voxel_size, labels)
+                                         : labelVoxels<double>(cloud, voxel_size, labels);
+
+    std::vector<int> counts(voxels, 0);
+    for (size_t i = 0; i < labels.size(); ++i)
+        if (labels[i] >= 0)
+            ++counts[labels[i]];
+
+    // All the means are computed before writing any output, which may share data with an input
+    Mat cloud_means, color_means, normal_means;
+    if (voxels > 0)
+    {
+        cloud_means = voxelMeans(cloud, labels, counts);
+        if (!colors.empty())
+            color_means = voxelMeans(colors, labels, counts);
+
+        if (!normals.empty())
+        {
+            normal_means = voxelMeans(normals, labels, counts);
+            double *n = normal_means.ptr<double>();
+            for (int i = 0, cn = normals.channels(); i < voxels; ++i, n += cn)
+            {
+                double norm = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                if (norm > 0)
+                    for (int c = 0; c < 3; ++c)
+                        n[c] /= norm;
+            }
+        }
+    }
+
+    if (cloud_means.empty())
+        _decimated_cloud.release();
+    else
+        cloud_means.convertTo(_decimated_cloud, cloud.depth());
+
+    if (_decimated_colors.needed())
+    {
+        if (color_means.empty())
+            _decimated_colors.release();
+        else
+            color_means.convertTo(_decimated_colors, CV_8U);
+    }
+
+    if (_decimated_normals.needed())
+    {
+        if (normal_means.empty())
+            _decimated_normals.release();
+        else
+            normal_means.convertTo(_decimated_normals, normals.depth());
+    }
+}
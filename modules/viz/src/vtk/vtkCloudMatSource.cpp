@@ -61,6 +61,29 @@ namespace cv { namespace viz
         const static int data_type = VTK_DOUBLE;
         typedef vtkDoubleArray array_type;
     };
+
+    template<> struct VtkDepthTraits<unsigned char>
+    {
+        const static int data_type = VTK_UNSIGNED_CHAR;
+        typedef vtkUnsignedCharArray array_type;
+    };
+
+    // Returns the array itself when it already has the requested type and size, so that updating
+    // a source with clouds of a steady size overwrites its arrays instead of allocating new ones
+    template<typename _Tp>
+    vtkSmartPointer<typename VtkDepthTraits<_Tp>::array_type> reuseArray(vtkDataArray *array, int components, int total)
+    {
+        typedef typename VtkDepthTraits<_Tp>::array_type array_type;
+        vtkSmartPointer<array_type> result = array_type::SafeDownCast(array);
+        if (!result || result->GetNumberOfComponents() != components || result->GetNumberOfTuples() != total)
+        {
+            result = vtkSmartPointer<array_type>::New();
+            result->SetNumberOfComponents(components);
+            result->SetNumberOfTuples(total);
+        }
+        result->Modified();
+        return result;
+    }
 }}
 
 cv::viz::vtkCloudMatSource::vtkCloudMatSource() { SetNumberOfInputPorts(0); }
@@ -73,13 +96,18 @@ int cv::viz::vtkCloudMatSource::SetCloud(InputArray _cloud)
 
     Mat cloud = _cloud.getMat();
 
+    vtkIdType previous = points ? points->GetNumberOfPoints() : -1;
     int total = _cloud.depth() == CV_32F ? filterNanCopy<float>(cloud) : filterNanCopy<double>(cloud);
 
-    vertices = vtkSmartPointer<vtkCellArray>::New();
-    vertices->Allocate(vertices->EstimateSize(1, total));
-    vertices->InsertNextCell(total);
-    for(int i = 0; i < total; ++i)
-        vertices->InsertCellPoint(i);
+    // The vertices only depend on the number of points
+    if (!vertices || previous != total)
+    {
+        vertices = vtkSmartPointer<vtkCellArray>::New();
+        vertices->Allocate(vertices->EstimateSize(1, total));
+        vertices->InsertNextCell(total);
+        for(int i = 0; i < total; ++i)
+            vertices->InsertCellPoint(i);
+    }
 
     return total;
 }
@@ -89,7 +117,10 @@ int cv::viz::vtkCloudMatSource::SetColorCloud(InputArray _cloud, InputArray _col
     int total = SetCloud(_cloud);
 
     if (_colors.empty())
+    {
+        scalars = 0;
         return total;
+    }
 
     CV_Assert(_colors.depth() == CV_8U && _colors.channels() <= 4 && _colors.channels() != 2);
     CV_Assert(_colors.size() == _cloud.size());
@@ -110,7 +141,10 @@ int cv::viz::vtkCloudMatSource::SetColorCloudNormals(InputArray _cloud, InputArr
     int total = SetColorCloud(_cloud, _colors);
 
     if (_normals.empty())
+    {
+        normals = 0;
         return total;
+    }
 
     CV_Assert(_normals.depth() == CV_32F || _normals.depth() == CV_64F);
     CV_Assert(_normals.channels() == 3 || _normals.channels() == 4);
@@ -138,7 +172,10 @@ int cv::viz::vtkCloudMatSource::SetColorCloudNormalsTCoords(InputArray _cloud, I
     int total = SetColorCloudNormals(_cloud, _colors, _normals);
 
     if (_tcoords.empty())
+    {
+        tcoords = 0;
         return total;
+    }
 
     CV_Assert(_tcoords.depth() == CV_32F || _tcoords.depth() == CV_64F);
     CV_Assert(_tcoords.channels() == 2 && _tcoords.size() == _cloud.size());
@@ -183,32 +220,64 @@ template<typename _Tp>
 int cv::viz::vtkCloudMatSource::filterNanCopy(const Mat& cloud)
 {
     CV_DbgAssert(DataType<_Tp>::depth == cloud.depth());
-    points = vtkSmartPointer<vtkPoints>::New();
-    points->SetDataType(VtkDepthTraits<_Tp>::data_type);
-    points->Allocate((vtkIdType)cloud.total());
-    points->SetNumberOfPoints((vtkIdType)cloud.total());
 
     int s_chs = cloud.channels();
-    int total = 0;
-    for (int y = 0; y < cloud.rows; ++y)
+    std::vector<int> offsets(cloud.rows + 1, 0);
+    parallel_for_(Range(0, cloud.rows), [&](const Range& range)
     {
-        const _Tp* srow = cloud.ptr<_Tp>(y);
-        const _Tp* send = srow + cloud.cols * s_chs;
+        for (int y = range.start; y < range.end; ++y)
+        {
+            const _Tp* srow = cloud.ptr<_Tp>(y);
+            const _Tp* send = srow + cloud.cols * s_chs;
 
-        for (; srow != send; srow += s_chs)
-            if (!isNan(srow))
-                points->SetPoint(total++, srow);
+            int count = 0;
+            for (; srow != send; srow += s_chs)
+                count += !isNan(srow);
+            offsets[y + 1] = count;
+        }
+    });
+    for (int y = 0; y < cloud.rows; ++y)
+        offsets[y + 1] += offsets[y];
+    int total = offsets[cloud.rows];
+
+    // The points are sized once to the number of valid points, so that they keep their memory
+    // as long as that number does not change
+    if (!points || points->GetDataType() != VtkDepthTraits<_Tp>::data_type || points->GetNumberOfPoints() != total)
+    {
+        points = vtkSmartPointer<vtkPoints>::New();
+        points->SetDataType(VtkDepthTraits<_Tp>::data_type);
+        points->SetNumberOfPoints(total);
     }
-    points->SetNumberOfPoints(total);
-    points->Squeeze();
+
+    _Tp* data = static_cast<_Tp*>(points->GetVoidPointer(0));
+    parallel_for_(Range(0, cloud.rows), [&](const Range& range)
+    {
+        for (int y = range.start; y < range.end; ++y)
+        {
+            const _Tp* srow = cloud.ptr<_Tp>(y);
+            const _Tp* send = srow + cloud.cols * s_chs;
+            _Tp* dst = data + offsets[y] * 3;
+
+            for (; srow != send; srow += s_chs)
+                if (!isNan(srow))
+                {
+                    dst[0] = srow[0];
+                    dst[1] = srow[1];
+                    dst[2] = srow[2];
+                    dst += 3;
+                }
+        }
+    });
+    points->Modified();
     return total;
 }
 
 template<typename _Msk>
 void cv::viz::vtkCloudMatSource::filterNanColorsCopy(const Mat& cloud_colors, const Mat& mask, int total)
 {
-    Vec3b* array = new Vec3b[total];
-    Vec3b* pos = array;
+    scalars = reuseArray<unsigned char>(scalars, 3, total);
+    scalars->SetName("Colors");
+    Vec3b* pos = reinterpret_cast<Vec3b*>(scalars->GetPointer(0));
 
     int s_chs = cloud_colors.channels();
     int m_chs = mask.channels();
@@ -230,26 +299,19 @@ void cv::viz::vtkCloudMatSource::filterNanColorsCopy(const Mat& cloud_colors, co
                     *pos++ = Vec3b(srow[2], srow[1], srow[0]);
 
     }
-
-    scalars = vtkSmartPointer<vtkUnsignedCharArray>::New();
-    scalars->SetName("Colors");
-    scalars->SetNumberOfComponents(3);
-    scalars->SetNumberOfTuples(total);
-    scalars->SetArray(array->val, total * 3, 0, vtkUnsignedCharArray::VTK_DATA_ARRAY_DELETE);
 }
 
 template<typename _Tn, typename _Msk>
 void cv::viz::vtkCloudMatSource::filterNanNormalsCopy(const Mat& cloud_normals, const Mat& mask, int total)
 {
-    normals = vtkSmartPointer< typename VtkDepthTraits<_Tn>::array_type >::New();
-    normals->SetName("Normals");
-    normals->SetNumberOfComponents(3);
-    normals->SetNumberOfTuples(total);
+    vtkSmartPointer<typename VtkDepthTraits<_Tn>::array_type> array = reuseArray<_Tn>(normals, 3, total);
+    array->SetName("Normals");
+    normals = array;
+    _Tn* pos = array->GetPointer(0);
 
     int s_chs = cloud_normals.channels();
     int m_chs = mask.channels();
 
-    int pos = 0;
     for (int y = 0; y < cloud_normals.rows; ++y)
     {
         const _Tn* srow = cloud_normals.ptr<_Tn>(y);
@@ -259,7 +321,12 @@ void cv::viz::vtkCloudMatSource::filterNanNormalsCopy(const Mat& cloud_normals,
 
         for (; srow != send; srow += s_chs, mrow += m_chs)
             if (!isNan(mrow))
-                normals->SetTuple(pos++, srow);
+            {
+                pos[0] = srow[0];
+                pos[1] = srow[1];
+                pos[2] = srow[2];
+                pos += 3;
+            }
     }
 }
 
@@ -267,12 +334,11 @@ template<typename _Tn, typename _Msk>
 void cv::viz::vtkCloudMatSource::filterNanTCoordsCopy(const Mat& _tcoords, const Mat& mask, int total)
 {
     typedef Vec<_Tn, 2> Vec2;
-    tcoords = vtkSmartPointer< typename VtkDepthTraits<_Tn>::array_type >::New();
-    tcoords->SetName("TextureCoordinates");
-    tcoords->SetNumberOfComponents(2);
-    tcoords->SetNumberOfTuples(total);
+    vtkSmartPointer<typename VtkDepthTraits<_Tn>::array_type> array = reuseArray<_Tn>(tcoords, 2, total);
+    array->SetName("TextureCoordinates");
+    tcoords = array;
+    Vec2* pos = reinterpret_cast<Vec2*>(array->GetPointer(0));
 
-    int pos = 0;
     for (int y = 0; y < mask.rows; ++y)
     {
         const Vec2* srow = _tcoords.ptr<Vec2>(y);
@@ -281,6 +347,6 @@ void cv::viz::vtkCloudMatSource::filterNanTCoordsCopy(const Mat& _tcoords, const
 
         for (; srow != send; ++srow, mrow += mask.channels())
             if (!isNan(mrow))
-                tcoords->SetTuple(pos++, srow->val);
+                *pos++ = *srow;
     }
 }
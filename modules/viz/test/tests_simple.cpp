@@ -94,6 +94,62 @@ TEST(Viz, show_cloud_masked)
     viz.spinOnce(500, true);
 }
 
+TEST(Viz, show_cloud_update)
+{
+    Mat dragon_cloud = readCloud(get_dragon_ply_file_path());
+
+    Mat colors(dragon_cloud.size(), CV_8UC3);
+    theRNG().fill(colors, RNG::UNIFORM, 0, 255);
+
+    Viz3d viz("show_cloud_update");
+    viz.showWidget("coosys", WCoordinateSystem());
+
+    WCloud cloud_widget(dragon_cloud, Color::bluberry());
+    viz.showWidget("dragon", cloud_widget);
+    viz.showWidget("text2d", WText("Cloud updated in place", Point(20, 20), 20, Color::green()));
+
+    for(int i = 0; i < 10; ++i)
+    {
+        Affine3f pose = Affine3f().rotate(Vec3f(0, 0.1f * i, 0));
+        Mat moved;
+        transform(dragon_cloud, moved, pose.matrix.get_minor<3, 4>(0, 0));
+        cloud_widget.setCloud(moved, colors);
+        viz.spinOnce(50, true);
+    }
+}
+
+TEST(Viz, decimate_cloud)
+{
+    Mat cloud(1, 6, CV_32FC3), colors(1, 6, CV_8UC3), normals(1, 6, CV_32FC3);
+    const float qnan = std::numeric_limits<float>::quiet_NaN();
+    cloud.at<Vec3f>(0) = Vec3f(0.1f, 0.1f, 0.1f);   colors.at<Vec3b>(0) = Vec3b(10, 20, 30);
+    cloud.at<Vec3f>(1) = Vec3f(2.5f, 0.5f, 0.5f);   colors.at<Vec3b>(1) = Vec3b(0, 0, 0);
+    cloud.at<Vec3f>(2) = Vec3f(0.3f, 0.5f, 0.9f);   colors.at<Vec3b>(2) = Vec3b(30, 40, 50);
+    cloud.at<Vec3f>(3) = Vec3f::all(qnan);           colors.at<Vec3b>(3) = Vec3b(255, 255, 255);
+    cloud.at<Vec3f>(4) = Vec3f(2.9f, 0.1f, 0.3f);   colors.at<Vec3b>(4) = Vec3b(100, 100, 100);
+    cloud.at<Vec3f>(5) = Vec3f(0.2f, 2.2f, 0.2f);   colors.at<Vec3b>(5) = Vec3b(1, 2, 3);
+    normals.setTo(Scalar(0, 0, 2));
+    normals.at<Vec3f>(2) = Vec3f(2, 0, 0);
+
+    Mat decimated, decimated_colors, decimated_normals;
+    decimateCloud(cloud, decimated, 1.0, colors, decimated_colors, normals, decimated_normals);
+
+    ASSERT_EQ(CV_32FC3, decimated.type());
+    ASSERT_EQ(3, (int)decimated.total());
+    EXPECT_LE(cvtest::norm(Vec3f(0.2f, 0.3f, 0.5f), decimated.at<Vec3f>(0), NORM_INF), 1e-5);
+    EXPECT_LE(cvtest::norm(Vec3f(2.7f, 0.3f, 0.4f), decimated.at<Vec3f>(1), NORM_INF), 1e-5);
+    EXPECT_LE(cvtest::norm(Vec3f(0.2f, 2.2f, 0.2f), decimated.at<Vec3f>(2), NORM_INF), 1e-5);
+
+    ASSERT_EQ(CV_8UC3, decimated_colors.type());
+    EXPECT_EQ(Vec3b(20, 30, 40), decimated_colors.at<Vec3b>(0));
+    EXPECT_EQ(Vec3b(50, 50, 50), decimated_colors.at<Vec3b>(1));
+    EXPECT_EQ(Vec3b(1, 2, 3), decimated_colors.at<Vec3b>(2));
+
+    ASSERT_EQ(CV_32FC3, decimated_normals.type());
+    EXPECT_LE(cvtest::norm(Vec3f(1, 0, 1) * (float)(1 / std::sqrt(2.0)), decimated_normals.at<Vec3f>(0), NORM_INF), 1e-5);
+    EXPECT_LE(cvtest::norm(Vec3f(0, 0, 1), decimated_normals.at<Vec3f>(1), NORM_INF), 1e-5);
+}
+
 TEST(Viz, show_cloud_collection)
 {
     Mat cloud = readCloud(get_dragon_ply_file_path());
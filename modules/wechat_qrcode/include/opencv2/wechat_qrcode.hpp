@@ -51,6 +51,30 @@ public:
     CV_WRAP std::vector<std::string> detectAndDecode(InputArray img,
                                                      OutputArrayOfArrays points = noArray());
 
+    /**
+     * @brief  Both detects and decodes QR codes on several images.
+     * The images of the same detector input size go through the detector in one batch, and
+     * the candidates which need the super resolution model are zoomed in one batch per crop size.
+     *
+     * @param imgs grayscale or color (BGR) images.
+     * @param points vertices of the found QR code quadrangles as CV_32FC2, per image.
+     * @return list of decoded strings, per image.
+     */
+    std::vector<std::vector<std::string> > detectAndDecodeBatch(const std::vector<Mat>& imgs,
+                                                               std::vector<std::vector<Mat> >& points);
+
+    /**
+     * @brief Sets the computation backend of the detector and super resolution models,
+     * see cv::dnn::Net::setPreferableBackend.
+     */
+    CV_WRAP void setPreferableBackend(int backendId);
+
+    /**
+     * @brief Sets the computation target of the detector and super resolution models,
+     * see cv::dnn::Net::setPreferableTarget.
+     */
+    CV_WRAP void setPreferableTarget(int targetId);
+
 protected:
     class Impl;
     Ptr<Impl> p;
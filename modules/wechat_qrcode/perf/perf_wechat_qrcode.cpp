@@ -0,0 +1,47 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+// the detector falls back to the traditional localization without the CNN models, this measures
+// the binarization and decoding that run in both cases
+typedef tuple<std::string, Size> WeChatQRCodeParams_t;
+typedef perf::TestBaseWithParam<WeChatQRCodeParams_t> WeChatQRCode;
+
+PERF_TEST_P(WeChatQRCode, detectAndDecode,
+            Combine(Values("version_1_down.jpg", "version_5_top.jpg", "link_ocv.jpg", "russian.jpg"),
+                    Values(szVGA, sz1080p)))
+{
+    Mat img = imread(getDataPath("cv/qrcode/" + get<0>(GetParam())));
+    ASSERT_FALSE(img.empty());
+    resize(img, img, get<1>(GetParam()), 0, 0, INTER_LINEAR_EXACT);
+
+    wechat_qrcode::WeChatQRCode detector;
+    std::vector<Mat> points;
+    std::vector<std::string> decoded;
+
+    TEST_CYCLE() decoded = detector.detectAndDecode(img, points);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef perf::TestBaseWithParam<std::string> WeChatQRCode_multi;
+
+PERF_TEST_P(WeChatQRCode_multi, detectAndDecode,
+            Values("2_qrcodes.png", "4_qrcodes.png", "6_qrcodes.png"))
+{
+    Mat img = imread(getDataPath("cv/qrcode/multiple/" + GetParam()));
+    ASSERT_FALSE(img.empty());
+
+    wechat_qrcode::WeChatQRCode detector;
+    std::vector<Mat> points;
+    std::vector<std::string> decoded;
+
+    TEST_CYCLE() decoded = detector.detectAndDecode(img, points);
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
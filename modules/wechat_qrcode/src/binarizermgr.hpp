@@ -41,6 +41,8 @@ public:
 
     void SetBinarizer(vector<BINARIZER> vecRotateBinarizer);
 
+    int GetBinarizerCount() const { return (int)m_vecRotateBinarizer.size(); }
+
 private:
     int m_iNowRotateIndex;
     int m_iNextOnceBinarizer;
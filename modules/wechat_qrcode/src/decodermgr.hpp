@@ -28,6 +28,12 @@ public:
 
     int decodeImage(cv::Mat src, bool use_nn_detector, string& result);
 
+    // the binarizers are tried in this order, the current one is the successful one after decodeImage
+    void setBinarizerOrder(const vector<BinarizerMgr::BINARIZER>& order) {
+        binarizer_mgr_.SetBinarizer(order);
+    }
+    int getCurBinarizer() { return binarizer_mgr_.GetCurBinarizer(); }
+
 private:
     zxing::Ref<zxing::UnicomBlock> qbarUicomBlock_;
     zxing::DecodeHints decode_hints_;
@@ -21,6 +21,11 @@ public:
     ~SSDDetector(){};
     int init(const std::string& proto_path, const std::string& model_path);
     std::vector<Mat> forward(Mat img, const int target_width, const int target_height);
+    // all the images are resized to the target size and go through the net in one batch
+    std::vector<std::vector<Mat>> forward(const std::vector<Mat>& imgs, const int target_width,
+                                          const int target_height);
+    void setPreferableBackend(int backendId) { net_.setPreferableBackend(backendId); }
+    void setPreferableTarget(int targetId) { net_.setPreferableTarget(targetId); }
 
 private:
     dnn::Net net_;
@@ -21,21 +21,14 @@ namespace wechat_qrcode {
 // Initialize the ImgSource
 ImgSource::ImgSource(unsigned char* pixels, int width, int height)
     : Super(width, height) {
-    luminances = new unsigned char[width * height];
-    memset(luminances, 0, width * height);
-
     rgbs = pixels;
 
     dataWidth = width;
     dataHeight = height;
     left = 0;
     top = 0;
-
-    // Make gray luminances first
-    makeGray();
 }
 
-// Added for crop function
 ImgSource::ImgSource(unsigned char* pixels, int width, int height, int left_, int top_,
                      int cropWidth, int cropHeight,
                      ErrorHandler& err_handler)
@@ -54,18 +47,9 @@ ImgSource::ImgSource(unsigned char* pixels, int width, int height, int left_, in
             zxing::IllegalArgumentErrorHandler("Crop rectangle does not fit within image data.");
         return;
     }
-
-    luminances = new unsigned char[width * height];
-
-    // Make gray luminances first
-    makeGray();
 }
 
-ImgSource::~ImgSource() {
-    if (luminances != NULL) {
-        delete[] luminances;
-    }
-}
+ImgSource::~ImgSource() {}
 
 Ref<ImgSource> ImgSource::create(unsigned char* pixels, int width, int height) {
     return Ref<ImgSource>(new ImgSource(pixels, width, height));
@@ -86,7 +70,7 @@ void ImgSource::reset(unsigned char* pixels, int width, int height) {
     setHeight(height);
     dataWidth = width;
     dataHeight = height;
-    makeGrayReset();
+    _matrix.reset(NULL);
 }
 
 ArrayRef<char> ImgSource::getRow(int y, zxing::ArrayRef<char> row,
@@ -103,7 +87,7 @@ ArrayRef<char> ImgSource::getRow(int y, zxing::ArrayRef<char> row,
     int offset = (y + top) * dataWidth + left;
 
     char* rowPtr = &row[0];
-    arrayCopy(luminances, offset, rowPtr, 0, width);
+    arrayCopy(rgbs, offset, rowPtr, 0, width);
 
     return row;
 }
@@ -119,6 +103,10 @@ ArrayRef<char> ImgSource::getMatrix() const {
     // give them the original data. The docs specifically warn that
     // result.length must be ignored.
     if (width == dataWidth && height == dataHeight) {
+        if (!_matrix) {
+            _matrix = zxing::ArrayRef<char>(area);
+            arrayCopy(rgbs, 0, &_matrix[0], 0, area);
+        }
         return _matrix;
     }
 
@@ -129,31 +117,20 @@ ArrayRef<char> ImgSource::getMatrix() const {
     // If the width matches the full width of the underlying data, perform a
     // single copy.
     if (width == dataWidth) {
-        arrayCopy(luminances, inputOffset, &newMatrix[0], 0, area);
+        arrayCopy(rgbs, inputOffset, &newMatrix[0], 0, area);
         return newMatrix;
     }
 
     // Otherwise copy one cropped row at a time.
     for (int y = 0; y < height; y++) {
         int outputOffset = y * width;
-        arrayCopy(luminances, inputOffset, &newMatrix[0], outputOffset, width);
+        arrayCopy(rgbs, inputOffset, &newMatrix[0], outputOffset, width);
         inputOffset += dataWidth;
     }
     return newMatrix;
 }
 
 
-void ImgSource::makeGray() {
-    int area = dataWidth * dataHeight;
-    _matrix = zxing::ArrayRef<char>(area);
-    arrayCopy(rgbs, 0, &_matrix[0], 0, area);
-}
-
-void ImgSource::makeGrayReset() {
-    int area = dataWidth * dataHeight;
-    arrayCopy(rgbs, 0, &_matrix[0], 0, area);
-}
-
 void ImgSource::arrayCopy(unsigned char* src, int inputOffset, char* dst, int outputOffset,
                           int length) const {
     const unsigned char* srcPtr = src + inputOffset;
@@ -182,6 +159,9 @@ Ref<LuminanceSource> ImgSource::rotateCounterClockwise(ErrorHandler& err_handler
 
 
 Ref<ByteMatrix> ImgSource::getByteMatrix() const {
+    if (getWidth() == dataWidth && getHeight() == dataHeight) {
+        return Ref<ByteMatrix>(new ByteMatrix(getWidth(), getHeight(), rgbs));
+    }
     return Ref<ByteMatrix>(new ByteMatrix(getWidth(), getHeight(), getMatrix()));
 }
 }  // namespace wechat_qrcode
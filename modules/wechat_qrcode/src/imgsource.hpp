@@ -15,18 +15,17 @@
 #include "zxing/luminance_source.hpp"
 namespace cv {
 namespace wechat_qrcode {
+// Luminance source which is a non-owning view over the gray pixels of the caller, the pixels must
+// outlive the source. The zxing matrix of the whole image is copied on the first request only.
 class ImgSource : public zxing::LuminanceSource {
 private:
     typedef LuminanceSource Super;
-    zxing::ArrayRef<char> _matrix;
+    mutable zxing::ArrayRef<char> _matrix;
     unsigned char* rgbs;
-    unsigned char* luminances;
     int dataWidth;
     int dataHeight;
     int left;
     int top;
-    void makeGray();
-    void makeGrayReset();
 
     void arrayCopy(unsigned char* src, int inputOffset, char* dst, int outputOffset,
                    int length) const;
@@ -24,11 +24,8 @@ Mat SuperScale::processImageScale(const Mat &src, float scale, const bool &use_s
         return dst;
     }
 
-    int width = src.cols;
-    int height = src.rows;
     if (scale == 2.0) {  // upsample
-        int SR_TH = sr_max_size;
-        if (use_sr && (int)sqrt(width * height * 1.0) < SR_TH && net_loaded_) {
+        if (needsSuperResolution(src, scale, use_sr, sr_max_size)) {
             int ret = superResoutionScale(src, dst);
             if (ret == 0) return dst;
         }
@@ -41,23 +38,57 @@ Mat SuperScale::processImageScale(const Mat &src, float scale, const bool &use_s
     return dst;
 }
 
-int SuperScale::superResoutionScale(const Mat &src, Mat &dst) {
-    Mat blob;
-    dnn::blobFromImage(src, blob, 1.0 / 255, Size(src.cols, src.rows), {0.0f}, false, false);
-
-    srnet_.setInput(blob);
-    auto prob = srnet_.forward();
-
+static void probToImage(const Mat &prob, int idx, Mat &dst) {
     dst = Mat(prob.size[2], prob.size[3], CV_8UC1);
 
     for (int row = 0; row < prob.size[2]; row++) {
-        const float *prob_score = prob.ptr<float>(0, 0, row);
+        const float *prob_score = prob.ptr<float>(idx, 0, row);
         for (int col = 0; col < prob.size[3]; col++) {
             float pixel = prob_score[col] * 255.0;
             dst.at<uint8_t>(row, col) = static_cast<uint8_t>(CLIP(pixel, 0.0f, 255.0f));
         }
     }
+}
+
+int SuperScale::superResoutionScale(const Mat &src, Mat &dst) {
+    Mat blob;
+    dnn::blobFromImage(src, blob, 1.0 / 255, Size(src.cols, src.rows), {0.0f}, false, false);
+
+    Mat prob;
+    {
+        AutoLock lock(srnet_mutex_);
+        srnet_.setInput(blob);
+        prob = srnet_.forward();
+    }
+    probToImage(prob, 0, dst);
     return 0;
 }
+
+void SuperScale::superResolutionBatch(const std::vector<Mat> &srcs, std::vector<Mat> &dsts) {
+    dsts.assign(srcs.size(), Mat());
+
+    std::map<std::pair<int, int>, std::vector<int>> groups;
+    for (size_t i = 0; i < srcs.size(); i++) {
+        groups[std::make_pair(srcs[i].cols, srcs[i].rows)].push_back((int)i);
+    }
+
+    for (auto &group : groups) {
+        std::vector<Mat> group_srcs;
+        for (int i : group.second) group_srcs.push_back(srcs[i]);
+
+        Mat blob;
+        dnn::blobFromImages(group_srcs, blob, 1.0 / 255, Size(group.first.first, group.first.second),
+                            {0.0f}, false, false);
+        Mat prob;
+        {
+            AutoLock lock(srnet_mutex_);
+            srnet_.setInput(blob);
+            prob = srnet_.forward();
+        }
+        for (size_t j = 0; j < group.second.size(); j++) {
+            probToImage(prob, (int)j, dsts[group.second[j]]);
+        }
+    }
+}
 }  // namespace wechat_qrcode
 }  // namespace cv
\ No newline at end of file
@@ -20,9 +20,20 @@ public:
     ~SuperScale(){};
     int init(const std::string &proto_path, const std::string &model_path);
     Mat processImageScale(const Mat &src, float scale, const bool &use_sr, int sr_max_size = 160);
+    // whether processImageScale runs the super resolution net for the image
+    bool needsSuperResolution(const Mat &src, float scale, const bool &use_sr,
+                              int sr_max_size = 160) const {
+        return scale == 2.0 && use_sr && net_loaded_ &&
+               (int)sqrt(src.cols * src.rows * 1.0) < sr_max_size;
+    }
+    // super resolution of several images, the images of the same size go through the net at once
+    void superResolutionBatch(const std::vector<Mat> &srcs, std::vector<Mat> &dsts);
+    void setPreferableBackend(int backendId) { srnet_.setPreferableBackend(backendId); }
+    void setPreferableTarget(int targetId) { srnet_.setPreferableTarget(targetId); }
 
 private:
     dnn::Net srnet_;
+    Mutex srnet_mutex_;  // the net is shared by the candidates decoded in parallel
     bool net_loaded_ = false;
     int superResoutionScale(const cv::Mat &src, cv::Mat &dst);
 };
@@ -11,38 +11,96 @@
 #include "detector/ssd_detector.hpp"
 #include "opencv2/core.hpp"
 #include "opencv2/core/utils/filesystem.hpp"
+#include "opencv2/core/utils/trace.hpp"
 #include "scale/super_scale.hpp"
 #include "zxing/result.hpp"
 namespace cv {
 namespace wechat_qrcode {
 class WeChatQRCode::Impl {
 public:
-    Impl() {}
+    Impl() {
+        for (int i = 0; i < kNumBinarizers; i++) binarizer_hits_[i] = 0;
+    }
     ~Impl() {}
     /**
-     * @brief detect QR codes from the given image
+     * @brief detect QR codes from the given images, the images of the same detector input size
+     * go through the detector in one batch
      *
-     * @param img supports grayscale or color (BGR) image.
-     * @return vector<Mat> detected QR code bounding boxes.
+     * @param imgs grayscale images.
+     * @return vector<Mat> detected QR code bounding boxes per image.
      */
-    std::vector<Mat> detect(const Mat& img);
+    std::vector<std::vector<Mat>> detect(const std::vector<Mat>& imgs);
     /**
      * @brief decode QR codes from detected points
      *
-     * @param img supports grayscale or color (BGR) image.
-     * @param candidate_points detected points. we name it "candidate points" which means no
-     * all the qrcode can be decoded.
-     * @param points succussfully decoded qrcode with bounding box points.
-     * @return vector<string>
+     * @param imgs grayscale images.
+     * @param candidate_points detected points per image. we name it "candidate points" which
+     * means no all the qrcode can be decoded.
+     * @param results decoded strings per image.
+     * @param points succussfully decoded qrcode with bounding box points per image.
      */
-    std::vector<std::string> decode(const Mat& img, std::vector<Mat>& candidate_points,
-                                    std::vector<Mat>& points);
-    int applyDetector(const Mat& img, std::vector<Mat>& points);
+    void decode(const std::vector<Mat>& imgs, const std::vector<std::vector<Mat>>& candidate_points,
+                std::vector<std::vector<std::string>>& results,
+                std::vector<std::vector<Mat>>& points);
+    void applyDetector(const std::vector<Mat>& imgs, std::vector<std::vector<Mat>>& points);
     Mat cropObj(const Mat& img, const Mat& point, Align& aligner);
     std::vector<float> getScaleList(const int width, const int height);
     std::shared_ptr<SSDDetector> detector_;
     std::shared_ptr<SuperScale> super_resolution_model_;
     bool use_nn_detector_, use_nn_sr_;
+
+    // decoding state of one candidate
+    struct DecodeTask {
+        int image_idx;
+        Mat point;
+        Mat cropped_img;
+        vector<float> scale_list;
+        size_t next_scale;
+        vector<BinarizerMgr::BINARIZER> binarizer_order;
+        Mat sr_img;  // super resolution of cropped_img, computed in a batch with the others
+        bool need_sr;
+        bool decoded;
+        string result;
+    };
+    void prepareTask(const Mat& img, DecodeTask& task);
+    /**
+     * @brief try the scales of the task from next_scale on, the scales and binarizers are ordered
+     * by their successes so far and the search stops at the first decoded scale. It pauses with
+     * need_sr set at the scale which requires the super resolution while sr_img is empty.
+     */
+    void runTask(DecodeTask& task);
+
+    class ParallelDecode;
+
+private:
+    static const int kNumBinarizers = 4;
+    // decoding statistics of this instance, shared by the candidates decoded in parallel
+    Mutex stats_mutex_;
+    std::map<float, int> scale_hits_;
+    int binarizer_hits_[kNumBinarizers];
+};
+
+class WeChatQRCode::Impl::ParallelDecode : public ParallelLoopBody {
+public:
+    ParallelDecode(WeChatQRCode::Impl& impl, const vector<Mat>& imgs, vector<DecodeTask>& tasks,
+                   const vector<int>& task_ids)
+        : impl_(impl), imgs_(imgs), tasks_(tasks), task_ids_(task_ids) {}
+
+    virtual void operator()(const Range& range) const CV_OVERRIDE {
+        for (int i = range.start; i < range.end; i++) {
+            DecodeTask& task = tasks_[task_ids_[i]];
+            if (task.cropped_img.empty()) impl_.prepareTask(imgs_[task.image_idx], task);
+            impl_.runTask(task);
+        }
+    }
+
+private:
+    WeChatQRCode::Impl& impl_;
+    const vector<Mat>& imgs_;
+    vector<DecodeTask>& tasks_;
+    const vector<int>& task_ids_;
+
+    ParallelDecode& operator=(const ParallelDecode&);
 };
 
 WeChatQRCode::WeChatQRCode(const String& detector_prototxt_path,
@@ -79,14 +137,13 @@ WeChatQRCode::WeChatQRCode(const String& detector_prototxt_path,
     }
 }
 
-vector<string> WeChatQRCode::detectAndDecode(InputArray img, OutputArrayOfArrays points) {
+static bool prepareInput(InputArray img, Mat& input_img) {
     CV_Assert(!img.empty());
     CV_CheckDepthEQ(img.depth(), CV_8U, "");
 
     if (img.cols() <= 20 || img.rows() <= 20) {
-        return vector<string>();  // image data is not enough for providing reliable results
+        return false;  // image data is not enough for providing reliable results
     }
-    Mat input_img;
     int incn = img.channels();
     CV_Check(incn, incn == 1 || incn == 3 || incn == 4, "");
     if (incn == 3 || incn == 4) {
@@ -94,94 +151,237 @@ vector<string> WeChatQRCode::detectAndDecode(InputArray img, OutputArrayOfArrays
     } else {
         input_img = img.getMat();
     }
-    auto candidate_points = p->detect(input_img);
-    auto res_points = vector<Mat>();
-    auto ret = p->decode(input_img, candidate_points, res_points);
+    return true;
+}
+
+vector<string> WeChatQRCode::detectAndDecode(InputArray img, OutputArrayOfArrays points) {
+    CV_TRACE_FUNCTION();
+    Mat input_img;
+    if (!prepareInput(img, input_img)) {
+        return vector<string>();
+    }
+    vector<Mat> imgs(1, input_img);
+    auto candidate_points = p->detect(imgs);
+    vector<vector<string>> ret;
+    vector<vector<Mat>> res_points;
+    p->decode(imgs, candidate_points, ret, res_points);
     // opencv type convert
     vector<Mat> tmp_points;
     if (points.needed()) {
-        for (size_t i = 0; i < res_points.size(); i++) {
+        for (size_t i = 0; i < res_points[0].size(); i++) {
             Mat tmp_point;
             tmp_points.push_back(tmp_point);
-            res_points[i].convertTo(((OutputArray)tmp_points[i]), CV_32FC2);
+            res_points[0][i].convertTo(((OutputArray)tmp_points[i]), CV_32FC2);
         }
         points.createSameSize(tmp_points, CV_32FC2);
         points.assign(tmp_points);
     }
-    return ret;
+    return ret[0];
 };
 
-vector<string> WeChatQRCode::Impl::decode(const Mat& img, vector<Mat>& candidate_points,
-                                          vector<Mat>& points) {
-    if (candidate_points.size() == 0) {
-        return vector<string>();
+vector<vector<string>> WeChatQRCode::detectAndDecodeBatch(const vector<Mat>& imgs,
+                                                          vector<vector<Mat>>& points) {
+    CV_TRACE_FUNCTION();
+    // the images which are too small get no results
+    vector<Mat> input_imgs;
+    vector<int> input_ids;
+    for (size_t i = 0; i < imgs.size(); i++) {
+        Mat input_img;
+        if (prepareInput(imgs[i], input_img)) {
+            input_imgs.push_back(input_img);
+            input_ids.push_back((int)i);
+        }
     }
-    vector<string> decode_results;
-    for (auto& point : candidate_points) {
-        Mat cropped_img;
-        if (use_nn_detector_) {
-            Align aligner;
-            cropped_img = cropObj(img, point, aligner);
-        } else {
-            cropped_img = img;
+
+    vector<vector<string>> ret(imgs.size());
+    points.assign(imgs.size(), vector<Mat>());
+    if (input_imgs.empty()) {
+        return ret;
+    }
+
+    auto candidate_points = p->detect(input_imgs);
+    vector<vector<string>> res;
+    vector<vector<Mat>> res_points;
+    p->decode(input_imgs, candidate_points, res, res_points);
+    for (size_t i = 0; i < input_ids.size(); i++) {
+        ret[input_ids[i]] = res[i];
+        for (size_t j = 0; j < res_points[i].size(); j++) {
+            Mat point;
+            res_points[i][j].convertTo(point, CV_32FC2);
+            points[input_ids[i]].push_back(point);
         }
-        // scale_list contains different scale ratios
-        auto scale_list = getScaleList(cropped_img.cols, cropped_img.rows);
-        for (auto cur_scale : scale_list) {
-            Mat scaled_img =
-                super_resolution_model_->processImageScale(cropped_img, cur_scale, use_nn_sr_);
-            string result;
-            DecoderMgr decodemgr;
-            auto ret = decodemgr.decodeImage(scaled_img, use_nn_detector_, result);
-
-            if (ret == 0) {
-                decode_results.push_back(result);
-                points.push_back(point);
-                break;
-            }
+    }
+    return ret;
+}
+
+void WeChatQRCode::setPreferableBackend(int backendId) {
+    if (p->detector_) p->detector_->setPreferableBackend(backendId);
+    p->super_resolution_model_->setPreferableBackend(backendId);
+}
+
+void WeChatQRCode::setPreferableTarget(int targetId) {
+    if (p->detector_) p->detector_->setPreferableTarget(targetId);
+    p->super_resolution_model_->setPreferableTarget(targetId);
+}
+
+void WeChatQRCode::Impl::decode(const vector<Mat>& imgs, const vector<vector<Mat>>& candidate_points,
+                                vector<vector<string>>& results, vector<vector<Mat>>& points) {
+    CV_TRACE_FUNCTION();
+    vector<DecodeTask> tasks;
+    for (size_t i = 0; i < candidate_points.size(); i++) {
+        for (auto& point : candidate_points[i]) {
+            DecodeTask task;
+            task.image_idx = (int)i;
+            task.point = point;
+            task.next_scale = 0;
+            task.need_sr = false;
+            task.decoded = false;
+            tasks.push_back(task);
         }
     }
 
-    return decode_results;
+    vector<int> task_ids(tasks.size());
+    for (size_t i = 0; i < tasks.size(); i++) task_ids[i] = (int)i;
+    CV_TRACE_REGION("decodeCandidates");
+    parallel_for_(Range(0, (int)task_ids.size()), ParallelDecode(*this, imgs, tasks, task_ids));
+
+    // the candidates which wait for the super resolution get it in one batch and go on
+    task_ids.clear();
+    vector<Mat> sr_srcs, sr_dsts;
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (tasks[i].need_sr) {
+            task_ids.push_back((int)i);
+            sr_srcs.push_back(tasks[i].cropped_img);
+        }
+    }
+    if (!task_ids.empty()) {
+        CV_TRACE_REGION("superResolution");
+        super_resolution_model_->superResolutionBatch(sr_srcs, sr_dsts);
+        for (size_t i = 0; i < task_ids.size(); i++) {
+            tasks[task_ids[i]].sr_img = sr_dsts[i];
+            tasks[task_ids[i]].need_sr = false;
+        }
+        CV_TRACE_REGION_NEXT("decodeSuperResolved");
+        parallel_for_(Range(0, (int)task_ids.size()), ParallelDecode(*this, imgs, tasks, task_ids));
+    }
+
+    // keep the order of the candidates
+    results.assign(imgs.size(), vector<string>());
+    points.assign(imgs.size(), vector<Mat>());
+    for (auto& task : tasks) {
+        if (task.decoded) {
+            results[task.image_idx].push_back(task.result);
+            points[task.image_idx].push_back(task.point);
+        }
+    }
+}
+
+void WeChatQRCode::Impl::prepareTask(const Mat& img, DecodeTask& task) {
+    if (use_nn_detector_) {
+        Align aligner;
+        task.cropped_img = cropObj(img, task.point, aligner);
+    } else {
+        task.cropped_img = img;
+    }
+    // scale_list contains different scale ratios
+    task.scale_list = getScaleList(task.cropped_img.cols, task.cropped_img.rows);
+
+    // the more successful scales and binarizers go first, the empirical order breaks the ties
+    task.binarizer_order = {BinarizerMgr::Hybrid, BinarizerMgr::FastWindow,
+                            BinarizerMgr::SimpleAdaptive, BinarizerMgr::AdaptiveThreshold};
+    AutoLock lock(stats_mutex_);
+    std::stable_sort(task.scale_list.begin(), task.scale_list.end(), [this](float a, float b) {
+        return scale_hits_[a] > scale_hits_[b];
+    });
+    std::stable_sort(task.binarizer_order.begin(), task.binarizer_order.end(),
+                     [this](BinarizerMgr::BINARIZER a, BinarizerMgr::BINARIZER b) {
+                         return binarizer_hits_[a] > binarizer_hits_[b];
+                     });
 }
 
-vector<Mat> WeChatQRCode::Impl::detect(const Mat& img) {
-    auto points = vector<Mat>();
+void WeChatQRCode::Impl::runTask(DecodeTask& task) {
+    CV_TRACE_FUNCTION();
+    const Mat& cropped_img = task.cropped_img;
+    for (; task.next_scale < task.scale_list.size(); task.next_scale++) {
+        float cur_scale = task.scale_list[task.next_scale];
+        // DecoderMgr rejects the images of 20 pixels or less, don't scale for them
+        if (cropped_img.cols * cur_scale <= 20 || cropped_img.rows * cur_scale <= 20) continue;
+        CV_TRACE_REGION("scale");
+        Mat scaled_img;
+        if (super_resolution_model_->needsSuperResolution(cropped_img, cur_scale, use_nn_sr_)) {
+            if (task.sr_img.empty()) {
+                task.need_sr = true;
+                return;
+            }
+            scaled_img = task.sr_img;
+        } else {
+            scaled_img =
+                super_resolution_model_->processImageScale(cropped_img, cur_scale, use_nn_sr_);
+        }
+        CV_TRACE_REGION_NEXT("binarizeAndDecode");
+        DecoderMgr decodemgr;
+        decodemgr.setBinarizerOrder(task.binarizer_order);
+        auto ret = decodemgr.decodeImage(scaled_img, use_nn_detector_, task.result);
+
+        if (ret == 0) {
+            int binarizer = decodemgr.getCurBinarizer();
+            AutoLock lock(stats_mutex_);
+            scale_hits_[cur_scale]++;
+            if (binarizer >= 0 && binarizer < kNumBinarizers) binarizer_hits_[binarizer]++;
+            task.decoded = true;
+            return;
+        }
+    }
+}
+
+vector<vector<Mat>> WeChatQRCode::Impl::detect(const vector<Mat>& imgs) {
+    CV_TRACE_FUNCTION();
+    auto points = vector<vector<Mat>>(imgs.size());
 
     if (use_nn_detector_) {
         // use cnn detector
-        auto ret = applyDetector(img, points);
-        CV_Assert(ret == 0);
+        applyDetector(imgs, points);
     } else {
-        auto width = img.cols, height = img.rows;
-        // if there is no detector, use the full image as input
-        auto point = Mat(4, 2, CV_32FC1);
-        point.at<float>(0, 0) = 0;
-        point.at<float>(0, 1) = 0;
-        point.at<float>(1, 0) = width - 1;
-        point.at<float>(1, 1) = 0;
-        point.at<float>(2, 0) = width - 1;
-        point.at<float>(2, 1) = height - 1;
-        point.at<float>(3, 0) = 0;
-        point.at<float>(3, 1) = height - 1;
-        points.push_back(point);
+        for (size_t i = 0; i < imgs.size(); i++) {
+            auto width = imgs[i].cols, height = imgs[i].rows;
+            // if there is no detector, use the full image as input
+            auto point = Mat(4, 2, CV_32FC1);
+            point.at<float>(0, 0) = 0;
+            point.at<float>(0, 1) = 0;
+            point.at<float>(1, 0) = width - 1;
+            point.at<float>(1, 1) = 0;
+            point.at<float>(2, 0) = width - 1;
+            point.at<float>(2, 1) = height - 1;
+            point.at<float>(3, 0) = 0;
+            point.at<float>(3, 1) = height - 1;
+            points[i].push_back(point);
+        }
     }
     return points;
 }
 
-int WeChatQRCode::Impl::applyDetector(const Mat& img, vector<Mat>& points) {
-    int img_w = img.cols;
-    int img_h = img.rows;
-
-    // hard code input size
-    int minInputSize = 400;
-    float resizeRatio = sqrt(img_w * img_h * 1.0 / (minInputSize * minInputSize));
-    int detect_width = img_w / resizeRatio;
-    int detect_height = img_h / resizeRatio;
+void WeChatQRCode::Impl::applyDetector(const vector<Mat>& imgs, vector<vector<Mat>>& points) {
+    // the images of the same detector input size are batched
+    std::map<std::pair<int, int>, vector<int>> groups;
+    for (size_t i = 0; i < imgs.size(); i++) {
+        int img_w = imgs[i].cols;
+        int img_h = imgs[i].rows;
 
-    points = detector_->forward(img, detect_width, detect_height);
+        // hard code input size
+        int minInputSize = 400;
+        float resizeRatio = sqrt(img_w * img_h * 1.0 / (minInputSize * minInputSize));
+        int detect_width = img_w / resizeRatio;
+        int detect_height = img_h / resizeRatio;
+        groups[std::make_pair(detect_width, detect_height)].push_back((int)i);
+    }
 
-    return 0;
+    for (auto& group : groups) {
+        vector<Mat> group_imgs;
+        for (int i : group.second) group_imgs.push_back(imgs[i]);
+        CV_TRACE_REGION("detectorForward");
+        auto group_points = detector_->forward(group_imgs, group.first.first, group.first.second);
+        for (size_t j = 0; j < group.second.size(); j++) points[group.second[j]] = group_points[j];
+    }
 }
 
 Mat WeChatQRCode::Impl::cropObj(const Mat& img, const Mat& point, Align& aligner) {
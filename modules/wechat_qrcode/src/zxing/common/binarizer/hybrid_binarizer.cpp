@@ -9,6 +9,7 @@
 // Licensed under the Apache License, Version 2.0 (the "License").
 #include "../../../precomp.hpp"
 #include "hybrid_binarizer.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 using zxing::HybridBinarizer;
 using zxing::BINARIZER_BLOCK;
@@ -259,6 +260,18 @@ void HybridBinarizer::thresholdBlock(Ref<ByteMatrix>& _luminances, int xoffset,
     pTemp += xoffset;
     bpTemp += xoffset;
 
+#if CV_SIMD128
+    if (threshold >= 0 && threshold <= 255) {
+        const cv::v_uint8x16 vthreshold = cv::v_setall_u8((uchar)threshold);
+        const cv::v_uint8x16 vone = cv::v_setall_u8(1);
+        for (int y = 0; y < BLOCK_SIZE; y++) {
+            cv::v_store_low((uchar*)bpTemp, (cv::v_load_low(pTemp) <= vthreshold) & vone);
+            pTemp += rowBitsSize;
+            bpTemp += rowSize;
+        }
+        return;
+    }
+#endif
     for (int y = 0; y < BLOCK_SIZE; y++) {
         for (int x = 0; x < BLOCK_SIZE; x++) {
             // comparison needs to be <= so that black == 0 pixels are black
@@ -324,6 +337,24 @@ int HybridBinarizer::initBlocks() {
             int sum = 0;
             int min = 0xFF;
             int max = 0;
+#if CV_SIMD128
+            // the whole block is scanned, the threshold is the same as with the
+            // short-circuited scalar loop as only the dynamic range test reads min and max
+            {
+                const unsigned char* pBlock = bytes + yoffset * width + xoffset;
+                cv::v_uint16x8 vrow = cv::v_load_expand(pBlock);
+                cv::v_uint16x8 vsum = vrow, vmin = vrow, vmax = vrow;
+                for (int yy = 1; yy < BLOCK_SIZE; yy++) {
+                    vrow = cv::v_load_expand(pBlock + yy * width);
+                    vsum += vrow;
+                    vmin = cv::v_min(vmin, vrow);
+                    vmax = cv::v_max(vmax, vrow);
+                }
+                sum = (int)cv::v_reduce_sum(vsum);
+                min = cv::v_reduce_min(vmin);
+                max = cv::v_reduce_max(vmax);
+            }
+#else
             for (int yy = 0, offset = yoffset * width + xoffset; yy < BLOCK_SIZE;
                  yy++, offset += width) {
                 for (int xx = 0; xx < BLOCK_SIZE; xx++) {
@@ -352,6 +383,7 @@ int HybridBinarizer::initBlocks() {
                 }
             }
 
+#endif
             blocks_[y * subWidth + x].min = min;
             blocks_[y * subWidth + x].max = max;
             blocks_[y * subWidth + x].sum = sum;
@@ -9,13 +9,48 @@
 // Licensed under the Apache License, Version 2.0 (the "License").
 #include "../../precomp.hpp"
 #include "bitmatrix.hpp"
+#include "opencv2/core/utility.hpp"
 
+using zxing::Array;
 using zxing::ArrayRef;
 using zxing::BitArray;
 using zxing::BitMatrix;
 using zxing::ErrorHandler;
 using zxing::Ref;
 
+namespace {
+// storage of the released matrices of a thread. The decoder binarizes every image with
+// several binarizers and scales, so the next matrices mostly find a large enough buffer here.
+struct BitMatrixStorage {
+    std::vector<std::vector<unsigned char> > bits;
+    std::vector<std::vector<COUNTER_TYPE> > counters;
+};
+
+const size_t kMaxPooledBits = 4;
+const size_t kMaxPooledCounters = 12;  // a matrix with all the records has 6 of them
+
+BitMatrixStorage& getStorage() {
+    static cv::TLSData<BitMatrixStorage>* storage = new cv::TLSData<BitMatrixStorage>();
+    return *storage->get();
+}
+
+template <typename T>
+void takeBuffer(std::vector<std::vector<T> >& pool, size_t n, std::vector<T>& dst) {
+    if (!pool.empty()) {
+        dst.swap(pool.back());
+        pool.pop_back();
+    }
+    dst.assign(n, T());
+}
+
+template <typename T>
+void giveBuffer(std::vector<std::vector<T> >& pool, size_t maxPooled, std::vector<T>& src) {
+    if (src.capacity() == 0 || pool.size() >= maxPooled) return;
+    pool.push_back(std::vector<T>());
+    pool.back().swap(src);
+}
+}  // namespace
+
 void BitMatrix::init(int _width, int _height, ErrorHandler& err_handler) {
     if (_width < 1 || _height < 1) {
         err_handler = IllegalArgumentErrorHandler("Both dimensions must be greater than 0");
@@ -24,7 +59,8 @@ void BitMatrix::init(int _width, int _height, ErrorHandler& err_handler) {
     width = _width;
     height = _height;
     this->rowBitsSize = width;
-    bits = ArrayRef<unsigned char>(width * height);
+    bits = ArrayRef<unsigned char>(new Array<unsigned char>());
+    takeBuffer(getStorage().bits, width * height, bits->values());
     rowOffsets = ArrayRef<int>(height);
 
     // offsetRowSize = new int[height];
@@ -48,9 +84,9 @@ void BitMatrix::initRowCounters() {
         return;
     }
 
-    row_counters = vector<COUNTER_TYPE>(width * height, 0);
-    row_counters_offset = vector<COUNTER_TYPE>(width * height, 0);
-    row_point_offset = vector<COUNTER_TYPE>(width * height, 0);
+    takeBuffer(getStorage().counters, width * height, row_counters);
+    takeBuffer(getStorage().counters, width * height, row_counters_offset);
+    takeBuffer(getStorage().counters, width * height, row_point_offset);
     row_counter_offset_end = vector<COUNTER_TYPE>(height, 0);
 
     row_counters_recorded = vector<bool>(height, false);
@@ -62,9 +98,9 @@ void BitMatrix::initColsCounters() {
         return;
     }
 
-    cols_counters = vector<COUNTER_TYPE>(width * height, 0);
-    cols_counters_offset = vector<COUNTER_TYPE>(width * height, 0);
-    cols_point_offset = vector<COUNTER_TYPE>(width * height, 0);
+    takeBuffer(getStorage().counters, width * height, cols_counters);
+    takeBuffer(getStorage().counters, width * height, cols_counters_offset);
+    takeBuffer(getStorage().counters, width * height, cols_point_offset);
     cols_counter_offset_end = vector<COUNTER_TYPE>(width, 0);
 
     cols_counters_recorded = vector<bool>(width, false);
@@ -111,7 +147,16 @@ void BitMatrix::xxor(Ref<BitMatrix> _bits) {
     }
 }
 
-BitMatrix::~BitMatrix() {}
+BitMatrix::~BitMatrix() {
+    BitMatrixStorage& storage = getStorage();
+    if (bits && bits->count() == 1) giveBuffer(storage.bits, kMaxPooledBits, bits->values());
+    giveBuffer(storage.counters, kMaxPooledCounters, row_counters);
+    giveBuffer(storage.counters, kMaxPooledCounters, row_counters_offset);
+    giveBuffer(storage.counters, kMaxPooledCounters, row_point_offset);
+    giveBuffer(storage.counters, kMaxPooledCounters, cols_counters);
+    giveBuffer(storage.counters, kMaxPooledCounters, cols_counters_offset);
+    giveBuffer(storage.counters, kMaxPooledCounters, cols_point_offset);
+}
 
 void BitMatrix::flip(int x, int y) {
     bits[rowOffsets[y] + x] = (bits[rowOffsets[y] + x] == (unsigned char)0);
@@ -13,6 +13,9 @@ using zxing::ErrorHandler;
 using zxing::Ref;
 
 void ByteMatrix::init(int _width, int _height) {
+    bytes = NULL;
+    row_offsets = NULL;
+    owns_bytes = true;
     if (_width < 1 || _height < 1) {
         return;
     }
@@ -36,8 +39,24 @@ ByteMatrix::ByteMatrix(int _width, int _height, ArrayRef<char> source) {
     memcpy(&bytes[0], &source[0], size);
 }
 
+ByteMatrix::ByteMatrix(int _width, int _height, unsigned char* data) {
+    bytes = data;
+    row_offsets = NULL;
+    owns_bytes = false;
+    width = _width;
+    height = _height;
+    if (_width < 1 || _height < 1) {
+        return;
+    }
+    row_offsets = new int[height];
+    row_offsets[0] = 0;
+    for (int i = 1; i < height; i++) {
+        row_offsets[i] = row_offsets[i - 1] + width;
+    }
+}
+
 ByteMatrix::~ByteMatrix() {
-    if (bytes) delete[] bytes;
+    if (bytes && owns_bytes) delete[] bytes;
     if (row_offsets) delete[] row_offsets;
 }
 
@@ -20,6 +20,8 @@ public:
     explicit ByteMatrix(int dimension);
     ByteMatrix(int _width, int _height);
     ByteMatrix(int _width, int _height, ArrayRef<char> source);
+    // non-owning view over continuous data, which must outlive the matrix
+    ByteMatrix(int _width, int _height, unsigned char* data);
     ~ByteMatrix();
 
     char get(int x, int y) const {
@@ -48,6 +50,8 @@ private:
     int* row_offsets;
 
 private:
+    bool owns_bytes;
+
     inline void init(int, int);
     ByteMatrix(const ByteMatrix&);
     ByteMatrix& operator=(const ByteMatrix&);
@@ -13,24 +13,25 @@
 
 #include <cstddef>
 #include <algorithm>
+#include "opencv2/core/cvdef.h"
 namespace zxing {
 
-/* base class for reference-counted objects */
+/* base class for reference-counted objects,
+ * the count is atomic as the static tables (versions, data masks) are shared by the decoding threads */
 class Counted {
 private:
-    unsigned int count_;
+    int count_;
 
 public:
     Counted() : count_(0) {}
     virtual ~Counted() {}
     Counted* retain() {
-        count_++;
+        CV_XADD(&count_, 1);
         return this;
     }
     void release() {
-        count_--;
-        if (count_ == 0) {
-            count_ = 0xDEADF001;
+        if (CV_XADD(&count_, -1) == 1) {
+            count_ = (int)0xDEADF001;
             delete this;
         }
     }
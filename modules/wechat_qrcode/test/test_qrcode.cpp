@@ -283,6 +283,37 @@ TEST_P(Objdetect_QRCode_Multi, regression) {
     }
 }
 
+TEST(Objdetect_QRCode_Batch, same_as_single) {
+    const std::string root = "qrcode/";
+    vector<Mat> srcs;
+    for (const std::string& name : {"version_1_down.jpg", "version_2_up.jpg", "link_ocv.jpg"}) {
+        std::string image_path = findDataFile(root + name);
+        Mat src = imread(image_path, IMREAD_GRAYSCALE);
+        ASSERT_FALSE(src.empty()) << "Can't read image: " << image_path;
+        srcs.push_back(src);
+    }
+    // too small to be decoded
+    srcs.push_back(Mat(10, 10, CV_8UC1, Scalar(255)));
+
+    auto detector = wechat_qrcode::WeChatQRCode();
+    vector<vector<Mat>> batch_points;
+    vector<vector<string>> batch_info = detector.detectAndDecodeBatch(srcs, batch_points);
+    ASSERT_EQ(srcs.size(), batch_info.size());
+    ASSERT_EQ(srcs.size(), batch_points.size());
+
+    for (size_t i = 0; i < srcs.size(); i++) {
+        vector<Mat> points;
+        vector<string> decoded_info = detector.detectAndDecode(srcs[i], points);
+        ASSERT_EQ(decoded_info.size(), batch_info[i].size());
+        ASSERT_EQ(points.size(), batch_points[i].size());
+        for (size_t j = 0; j < decoded_info.size(); j++) {
+            EXPECT_EQ(decoded_info[j], batch_info[i][j]);
+            EXPECT_EQ(0, cvtest::norm(points[j], batch_points[i][j], NORM_INF));
+        }
+    }
+    EXPECT_TRUE(batch_info.back().empty());
+}
+
 INSTANTIATE_TEST_CASE_P(/**/, Objdetect_QRCode, testing::ValuesIn(qrcode_images_name));
 INSTANTIATE_TEST_CASE_P(/**/, Objdetect_QRCode_Close, testing::ValuesIn(qrcode_images_close));
 INSTANTIATE_TEST_CASE_P(/**/, Objdetect_QRCode_Monitor, testing::ValuesIn(qrcode_images_monitor));
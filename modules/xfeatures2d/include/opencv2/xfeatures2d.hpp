@@ -41,6 +41,7 @@ the use of this software, even if advised of the possibility of such damage.
 
 #include "opencv2/features2d.hpp"
 #include "opencv2/xfeatures2d/nonfree.hpp"
+#include <functional>
 
 /** @defgroup xfeatures2d Extra 2D Features Framework
 @{
@@ -275,6 +276,29 @@ public:
      */
     virtual void compute( InputArray image, OutputArray descriptors ) = 0;
 
+    /** @overload
+     * @param image image to extract descriptors
+     * @param roi region of interest within image
+     * @param descriptors resulted descriptors array for roi image pixels
+     * @param ddepth depth of descriptors: CV_32F, CV_16F, or CV_8U where the values are scaled by 255 and
+     * saturated (meaningful with normalized descriptors, whose values are within [0, 1])
+     *
+     * With ddepth other than CV_32F the float descriptors are only kept for a band of rows at a time.
+     */
+    virtual void compute( InputArray image, Rect roi, OutputArray descriptors, int ddepth ) = 0;
+
+    /** @brief Computes dense descriptors of roi band by band, in bounded memory
+     * @param image image to extract descriptors
+     * @param roi region of interest within image
+     * @param bandHeight number of roi rows per band
+     * @param ddepth depth of descriptors, see compute( image, roi, descriptors, ddepth )
+     * @param callback called, in order from top to bottom, for every band with its rectangle in image
+     * and its descriptors (one row per band pixel, in row-major order). The descriptors matrix is reused
+     * for the next band, so it must be copied to be kept.
+     */
+    virtual void computeBands( InputArray image, Rect roi, int bandHeight, int ddepth,
+                               const std::function<void(const Rect& band, const Mat& descriptors)>& callback ) = 0;
+
     /**
      * @param y position y on image
      * @param x position x on image
@@ -897,6 +921,20 @@ public:
         const std::vector<Mat>& imageSignatures,
         std::vector<float>& distances) const = 0;
 
+    /**
+    * @brief Computes Signature Quadratic Form Distance between every query signature
+    *       and every image signature.
+    * @param querySignatures Vector of signatures to measure distance from.
+    * @param imageSignatures Vector of signatures to measure distance to.
+    * @param distances Output querySignatures.size() x imageSignatures.size() CV_32F matrix of measured distances.
+    * @note The self similarity of each signature is computed once, so this is faster than
+    *       measuring the distances of each query separately.
+    */
+    CV_WRAP virtual void computeQuadraticFormDistanceMatrix(
+        const std::vector<Mat>& querySignatures,
+        const std::vector<Mat>& imageSignatures,
+        OutputArray distances) const = 0;
+
 };
 
 /**
@@ -967,6 +1005,18 @@ public:
         return create(keypoint_detector, keypoint_detector);
     }
 
+    /**
+     * @brief Warps the elliptic regions into circles, as done before computing their descriptors.
+     *
+     * The patches are computed in parallel and are views of a single buffer. patchKeypoints holds
+     * every keypoint in the coordinates of its patch, so that any descriptor extractor can be run on them.
+     */
+    static void extractPatches(
+        InputArray image,
+        const std::vector<Elliptic_KeyPoint>& keypoints,
+        CV_OUT std::vector<Mat>& patches,
+        CV_OUT std::vector<KeyPoint>& patchKeypoints);
+
     using Feature2D::detect; // overload, don't hide
     /**
      * @brief Detects keypoints in the image using the wrapped detector and
@@ -1069,6 +1119,41 @@ CV_EXPORTS_W void matchGMS(const Size& size1, const Size& size2, const std::vect
                            const std::vector<DMatch>& matches1to2, CV_OUT std::vector<DMatch>& matchesGMS, const bool withRotation = false,
                            const bool withScale = false, const double thresholdFactor = 6.0);
 
+/** @brief GMS feature matching strategy keeping its state between calls, see matchGMS.
+
+The grid neighborhoods are computed once for the image sizes given at creation and the rotation and scale
+hypotheses are verified in parallel, which makes it suitable for filtering the matches of an image sequence.
+An instance should not be used from several threads at once.
+ */
+class CV_EXPORTS_W GMSMatcher : public Algorithm
+{
+public:
+    /** @brief Creates the matcher.
+    @param size1 Size of the images the keypoints1 come from.
+    @param size2 Size of the images the keypoints2 come from.
+    @param withRotation Take rotation transformation into account.
+    @param withScale Take scale transformation into account.
+    @param thresholdFactor The higher, the less matches.
+     */
+    CV_WRAP static Ptr<GMSMatcher> create(const Size& size1, const Size& size2, const bool withRotation = false,
+                                          const bool withScale = false, const double thresholdFactor = 6.0);
+
+    /** @brief Filters the matches, gives the same result as matchGMS unless the early stop ratio is set.
+    @param keypoints1 Input keypoints of image1.
+    @param keypoints2 Input keypoints of image2.
+    @param matches1to2 Input 1-nearest neighbor matches.
+    @param matchesGMS Matches returned by the GMS matching strategy.
+     */
+    CV_WRAP virtual void match(const std::vector<KeyPoint>& keypoints1, const std::vector<KeyPoint>& keypoints2,
+                               const std::vector<DMatch>& matches1to2, CV_OUT std::vector<DMatch>& matchesGMS) = 0;
+
+    /** @brief Skips the rotation and scale hypotheses when the identity one keeps at least this ratio of the matches.
+    0 (the default) always verifies all of them.
+     */
+    CV_WRAP virtual void setEarlyStopRatio(double ratio) = 0;
+    CV_WRAP virtual double getEarlyStopRatio() const = 0;
+};
+
 /** @brief LOGOS (Local geometric support for high-outlier spatial verification) feature matching strategy described in @cite Lowry2018LOGOSLG .
     @param keypoints1 Input keypoints of image1.
     @param keypoints2 Input keypoints of image2.
@@ -109,6 +109,15 @@ public:
 
     CV_WRAP virtual void setUpright(bool upright) = 0;
     CV_WRAP virtual bool getUpright() const = 0;
+
+    /** @brief Keeps the integral images and the Hessian layers between calls.
+
+    When enabled, the buffers are allocated once and reused for the following images of the same size,
+    which saves the allocations when processing a video stream. The object must not be used from several
+    threads at the same time in this mode. Disabled by default.
+     */
+    CV_WRAP virtual void setReuseBuffers(bool reuseBuffers) = 0;
+    CV_WRAP virtual bool getReuseBuffers() const = 0;
 };
 
 typedef SURF SurfFeatureDetector;
@@ -5,16 +5,19 @@
 
 namespace opencv_test { namespace {
 
-typedef perf::TestBaseWithParam<std::string> beblid;
+typedef tuple<std::string, int> BEBLID_Params_t;
+typedef perf::TestBaseWithParam<BEBLID_Params_t> beblid;
 
 #define BEBLID_IMAGES \
     "cv/detectors_descriptors_evaluation/images_datasets/leuven/img1.png",\
     "stitching/a3.png"
 
 #ifdef OPENCV_ENABLE_NONFREE
-PERF_TEST_P(beblid, extract, testing::Values(BEBLID_IMAGES))
+PERF_TEST_P(beblid, extract, testing::Combine(testing::Values(BEBLID_IMAGES),
+                                              testing::Values((int)BEBLID::SIZE_512_BITS, (int)BEBLID::SIZE_256_BITS)))
 {
-    string filename = getDataPath(GetParam());
+    string filename = getDataPath(get<0>(GetParam()));
+    const int n_bits = get<1>(GetParam());
     Mat frame = imread(filename, IMREAD_GRAYSCALE);
     ASSERT_FALSE(frame.empty()) << "Unable to load source image " << filename;
 
@@ -25,7 +28,7 @@ PERF_TEST_P(beblid, extract, testing::Values(BEBLID_IMAGES))
     vector<KeyPoint> points;
     detector->detect(frame, points, mask);
 
-    Ptr<BEBLID> descriptor = BEBLID::create(6.25f);
+    Ptr<BEBLID> descriptor = BEBLID::create(6.25f, n_bits);
     cv::Mat descriptors;
     TEST_CYCLE() descriptor->compute(frame, points, descriptors);
 
@@ -453,14 +453,23 @@ float selDifferentiationScale(const Mat & img, Mat & Lxm2smooth, Mat & Lxmysmoot
 void calcAffineCovariantRegions(const Mat & image, const std::vector<KeyPoint> & keypoints,
         std::vector<Elliptic_KeyPoint> & affRegions)
 {
+    //Keypoints are adapted independently, the converged ones are kept in order
+    std::vector<Elliptic_KeyPoint> adapted(keypoints.size());
+    std::vector<uchar> converged(keypoints.size(), 0);
+    parallel_for_(Range(0, (int)keypoints.size()), [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; ++i)
+        {
+            const KeyPoint& kp = keypoints[i];
+            adapted[i] = Elliptic_KeyPoint(kp.pt, 0, Size_<float> (kp.size / 2, kp.size / 2), kp.size,
+                    kp.size / 6);
+            converged[i] = calcAffineAdaptation(image, adapted[i]);
+        }
+    });
     for (size_t i = 0; i < keypoints.size(); ++i)
     {
-        KeyPoint kp = keypoints[i];
-        Elliptic_KeyPoint ex(kp.pt, 0, Size_<float> (kp.size / 2, kp.size / 2), kp.size,
-                kp.size / 6);
-
-        if (calcAffineAdaptation(image, ex))
-            affRegions.push_back(ex);
+        if (converged[i])
+            affRegions.push_back(adapted[i]);
     }
     //Erase similar keypoint
     float maxDiff = 4;
@@ -491,94 +500,102 @@ void calcAffineCovariantRegions(const Mat & image, const std::vector<KeyPoint> &
     }
 }
 
-void calcAffineCovariantDescriptors(const Ptr<DescriptorExtractor>& dextractor, const Mat& img,
-        std::vector<Elliptic_KeyPoint>& affRegions, Mat& descriptors)
+/*
+ * Geometry of the normalized patch of an elliptic region
+ */
+struct AffinePatch
 {
+    Rect imgRoi;       /*Window around the point in the image*/
+    Matx23f transf;    /*Transformation of the window*/
+    Size warpedSize;   /*Size of the warped window*/
+    Rect patchRoi;     /*Normalized patch in the warped window*/
+    Point2f pt;        /*Point in the normalized patch*/
+};
 
-    assert(!affRegions.empty());
-    int descriptorSize = dextractor->descriptorSize();
-    int descriptorType = dextractor->descriptorType();
-    descriptors.create(Size(descriptorSize, int(affRegions.size())), descriptorType);
-    descriptors.setTo(0);
-
-    int i = 0;
+AffinePatch calcAffinePatch(const Size& imgSize, const Elliptic_KeyPoint& kp)
+{
+    AffinePatch patch;
+    Point p = kp.pt;
 
-    for (std::vector<Elliptic_KeyPoint>::iterator it = affRegions.begin(); it < affRegions.end(); ++it)
-    {
-        Point p = it->pt;
+    Matx21f size;
+    size(0, 0) = size(1, 0) = kp.size;
 
-        Matx21f size;
-        size(0, 0) = size(1, 0) = it->size;
+    //U matrix
+    patch.transf = kp.transf;
+    Matx22f U(
+        patch.transf(0,0), patch.transf(0,1),
+        patch.transf(1,0), patch.transf(1,1)
+    );
 
-        //U matrix
-        Matx23f transf = it->transf;
-        Matx22f U(
-            transf(0,0), transf(0,1),
-            transf(1,0), transf(1,1)
-        );
+    float radius = kp.size / 2;
+    float si = kp.si;
 
-        float radius = it->size / 2;
-        float si = it->si;
+    Size_<float> boundingBox;
 
-        Size_<float> boundingBox;
+    float ac_b2 = float(determinant(U));
+    boundingBox.width  = ceil(U(1, 1)/ac_b2 * 3 * si );
+    boundingBox.height = ceil(U(0, 0)/ac_b2 * 3 * si );
 
-        float ac_b2 = float(determinant(U));
-        boundingBox.width  = ceil(U(1, 1)/ac_b2 * 3 * si );
-        boundingBox.height = ceil(U(0, 0)/ac_b2 * 3 * si );
+    //Create window around interest point
+    float half_width = std::min((float) std::min(imgSize.width - p.x-1, p.x), boundingBox.width);
+    float half_height = std::min((float) std::min(imgSize.height - p.y-1, p.y), boundingBox.height);
+    int roix = max(p.x - (int) boundingBox.width, 0);
+    int roiy = max(p.y - (int) boundingBox.height, 0);
+    patch.imgRoi = Rect(roix, roiy, p.x - roix + int(half_width)+1, p.y - roiy + int(half_height)+1);
 
-        //Create window around interest point
-        float half_width = std::min((float) std::min(img.cols - p.x-1, p.x), boundingBox.width);
-        float half_height = std::min((float) std::min(img.rows - p.y-1, p.y), boundingBox.height);
-        int roix = max(p.x - (int) boundingBox.width, 0);
-        int roiy = max(p.y - (int) boundingBox.height, 0);
-        Rect roi = Rect(roix, roiy, p.x - roix + int(half_width)+1, p.y - roiy + int(half_height)+1);
+    size(0, 0) = float(patch.imgRoi.width);
+    size(1, 0) = float(patch.imgRoi.height);
 
-        Mat img_roi = img(roi);
+    size = U * size;
+    patch.warpedSize = Size(int(ceil(size(0, 0))), int(ceil(size(1, 0))));
 
-        size(0, 0) = float(img_roi.cols);
-        size(1, 0) = float(img_roi.rows);
+    Matx21f c; //Transformed point
+    Matx21f pt; //Image point
+    //Point within the Roi
+    pt(0, 0) = float(p.x - roix);
+    pt(1, 0) = float(p.y - roiy);
 
-        size = U * size;
+    //Point in U-Normalized coordinates
+    c = U * pt;
+    float cx = c(0, 0);
+    float cy = c(1, 0);
 
-        Mat transfImgRoi, transfImg;
-        warpAffine(img_roi, transfImgRoi, transf, Size(int(ceil(size(0, 0))), int(ceil(size(1, 0)))),
-                INTER_AREA, BORDER_DEFAULT);
+    //Cut around point to have patch of 2*keypoint->size
 
-        Matx21f c; //Transformed point
-        Matx21f pt; //Image point
-        //Point within the Roi
-        pt(0, 0) = float(p.x - roix);
-        pt(1, 0) = float(p.y - roiy);
+    roix = std::max(int(ceil(cx - radius)), 0);
+    roiy = std::max(int(ceil(cy - radius)), 0);
 
-        //Point in U-Normalized coordinates
-        c = U * pt;
-        float cx = c(0, 0);
-        float cy = c(1, 0);
+    patch.patchRoi = Rect(roix, roiy, int(ceil(std::min(cx - roix + radius, size(0, 0)))),
+            int(ceil(std::min(cy - roiy + radius, size(1, 0)))));
 
-        //Cut around point to have patch of 2*keypoint->size
+    patch.pt = Point2f(c(0, 0) - roix, c(1, 0) - roiy);
+    return patch;
+}
 
-        roix = std::max(int(ceil(cx - radius)), 0);
-        roiy = std::max(int(ceil(cy - radius)), 0);
+void calcAffineCovariantDescriptors(const Ptr<DescriptorExtractor>& dextractor, const Mat& img,
+        std::vector<Elliptic_KeyPoint>& affRegions, Mat& descriptors)
+{
 
-        roi = Rect(roix, roiy, int(ceil(std::min(cx - roix + radius, size(0, 0)))),
-                int(ceil(std::min(cy - roiy + radius, size(1, 0)))));
-        transfImg = transfImgRoi(roi);
+    CV_Assert(!affRegions.empty());
+    int descriptorSize = dextractor->descriptorSize();
+    int descriptorType = dextractor->descriptorType();
+    descriptors.create(Size(descriptorSize, int(affRegions.size())), descriptorType);
+    descriptors.setTo(0);
 
-        cx = c(0, 0) - roix;
-        cy = c(1, 0) - roiy;
+    std::vector<Mat> patches;
+    std::vector<KeyPoint> patchKeypoints;
+    AffineFeature2D::extractPatches(img, affRegions, patches, patchKeypoints);
 
+    //The extractor may keep a state, descriptors are computed one by one
+    for (size_t i = 0; i < patches.size(); i++)
+    {
         Mat tmpDesc;
-        KeyPoint kp(Point(int(cx), int(cy)), it->size);
-
-        std::vector<KeyPoint> k(1, kp);
-
-        transfImg.convertTo(transfImg, CV_8U);
-        dextractor->compute(transfImg, k, tmpDesc);
+        std::vector<KeyPoint> k(1, patchKeypoints[i]);
 
-        tmpDesc.row(0).copyTo(descriptors.row(i));
-
-        i++;
+        dextractor->compute(patches[i], k, tmpDesc);
 
+        if (!tmpDesc.empty())
+            tmpDesc.row(0).copyTo(descriptors.row(int(i)));
     }
 
 }
@@ -610,6 +627,49 @@ private:
     Ptr<DescriptorExtractor> m_descriptor_extractor;
 };
 
+void AffineFeature2D::extractPatches(
+    InputArray _image,
+    const std::vector<Elliptic_KeyPoint>& keypoints,
+    std::vector<Mat>& patches,
+    std::vector<KeyPoint>& patchKeypoints)
+{
+    CV_INSTRUMENT_REGION();
+
+    Mat img = _image.getMat();
+    CV_Assert(!img.empty());
+
+    const int n = (int)keypoints.size();
+    std::vector<AffinePatch> geometry(n);
+    std::vector<size_t> offsets(n + 1, 0);
+    for (int i = 0; i < n; i++)
+    {
+        geometry[i] = calcAffinePatch(img.size(), keypoints[i]);
+        offsets[i + 1] = offsets[i] + geometry[i].patchRoi.area() * img.channels();
+    }
+
+    //All the patches share one buffer
+    Mat arena(1, (int)std::max(offsets[n], (size_t)1), CV_8U);
+    patches.resize(n);
+    patchKeypoints.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        const AffinePatch& g = geometry[i];
+        patches[i] = Mat(g.patchRoi.size(), CV_8UC(img.channels()), arena.ptr() + offsets[i]);
+        patchKeypoints[i] = KeyPoint(Point(int(g.pt.x), int(g.pt.y)), keypoints[i].size);
+    }
+
+    parallel_for_(Range(0, n), [&](const Range& range)
+    {
+        Mat transfImgRoi;
+        for (int i = range.start; i < range.end; i++)
+        {
+            const AffinePatch& g = geometry[i];
+            warpAffine(img(g.imgRoi), transfImgRoi, g.transf, g.warpedSize, INTER_AREA, BORDER_DEFAULT);
+            transfImgRoi(g.patchRoi).convertTo(patches[i], CV_8U);
+        }
+    });
+}
+
 Ptr<AffineFeature2D> AffineFeature2D::create(
     Ptr<FeatureDetector> keypoint_detector,
     Ptr<DescriptorExtractor> descriptor_extractor)
@@ -622,6 +682,8 @@ void AffineFeature2D_Impl::detect(
     std::vector<Elliptic_KeyPoint>& keypoints,
     InputArray mask)
 {
+    CV_INSTRUMENT_REGION();
+
     std::vector<KeyPoint> non_elliptic_keypoints;
     m_keypoint_detector->detect(image, non_elliptic_keypoints, mask);
     Mat fimage;
@@ -636,6 +698,8 @@ void AffineFeature2D_Impl::detectAndCompute(
         OutputArray descriptors,
         bool useProvidedKeypoints)
 {
+    CV_INSTRUMENT_REGION();
+
     if(!useProvidedKeypoints)
     {
         std::vector<KeyPoint> non_elliptic_keypoints;
@@ -654,6 +718,8 @@ void AffineFeature2D_Impl::detectAndCompute(
         OutputArray descriptors,
         bool useProvidedKeypoints)
 {
+    CV_INSTRUMENT_REGION();
+
     if(!useProvidedKeypoints)
     {
         m_keypoint_detector->detect(image, keypoints, mask);
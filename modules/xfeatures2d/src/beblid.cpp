@@ -9,6 +9,7 @@
 //     Pattern Recognition Letters, 133:366–372, 2020.
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #define CV_BEBLID_PARALLEL
 
@@ -56,6 +57,9 @@ public:
 
 private:
     std::vector<ABWLParams> wl_params_;
+    // wl_params_ laid out as structure of arrays, for the evaluation of several keypoints at once
+    std::vector<float> wl_x1_, wl_y1_, wl_x2_, wl_y2_, wl_radius_;
+    std::vector<int> wl_th_;
     float scale_factor_;
     cv::Size patch_size_;
 
@@ -104,13 +108,21 @@ static inline void rectifyABWL(const std::vector<ABWLParams> &wlPatchParams,
                                std::vector<ABWLParams> &wlImageParams,
                                const cv::KeyPoint &kp,
                                float scaleFactor = 1,
-                               const cv::Size &patchSize = cv::Size(32, 32))
+                               const cv::Size &patchSize = cv::Size(32, 32));
+
+/**
+ * @brief Computes the transformation from the normalized patch to the image applied by rectifyABWL.
+ * @param kp The keypoint defining the offset, rotation and scale to be applied
+ * @param scaleFactor A scale factor that magnifies the measurement functions w.r.t. the keypoint.
+ * @param patchSize The size of the normalized patch where the measurement functions were learnt.
+ * @param m The output 2x3 transformation, followed by its scale
+ */
+static inline void patchToImageTransform(const cv::KeyPoint &kp, float scaleFactor, const cv::Size &patchSize, float m[7])
 {
-    float m00, m01, m02, m10, m11, m12;
-    float s, cosine, sine;
+    float &m00 = m[0], &m01 = m[1], &m02 = m[2], &m10 = m[3], &m11 = m[4], &m12 = m[5], &s = m[6];
+    float cosine, sine;
 
     s = scaleFactor * kp.size / (0.5f * (patchSize.width + patchSize.height));
-    wlImageParams.resize(wlPatchParams.size());
 
     if (kp.angle == -1)
     {
@@ -133,6 +145,18 @@ static inline void rectifyABWL(const std::vector<ABWLParams> &wlPatchParams,
         m11 = s * cosine;
         m12 = (-s * sine - s * cosine) * patchSize.height * 0.5f + kp.pt.y;
     }
+}
+
+static inline void rectifyABWL(const std::vector<ABWLParams> &wlPatchParams,
+                               std::vector<ABWLParams> &wlImageParams,
+                               const cv::KeyPoint &kp,
+                               float scaleFactor,
+                               const cv::Size &patchSize)
+{
+    float m[7];
+    patchToImageTransform(kp, scaleFactor, patchSize, m);
+    const float m00 = m[0], m01 = m[1], m02 = m[2], m10 = m[3], m11 = m[4], m12 = m[5], s = m[6];
+    wlImageParams.resize(wlPatchParams.size());
 
     for (size_t i = 0; i < wlPatchParams.size(); i++)
     {
@@ -241,6 +265,8 @@ static inline float computeABWLResponse(const ABWLParams &wlImageParams,
 // descriptor computation using keypoints
 void BEBLID_Impl::compute(InputArray _image, vector<KeyPoint> &keypoints, OutputArray _descriptors)
 {
+    CV_INSTRUMENT_REGION();
+
     Mat image = _image.getMat();
 
     if (image.empty())
@@ -296,8 +322,84 @@ BEBLID_Impl::BEBLID_Impl(float scale_factor, int n_bits)
         wl_params_.assign(wl_params_256, wl_params_256 + sizeof(wl_params_256) / sizeof(wl_params_256[0]));
     else
         CV_Error(Error::StsBadArg, "n_wls should be either SIZE_512_BITS or SIZE_256_BITS");
+
+    for (size_t i = 0; i < wl_params_.size(); i++)
+    {
+        wl_x1_.push_back(float(wl_params_[i].x1));
+        wl_y1_.push_back(float(wl_params_[i].y1));
+        wl_x2_.push_back(float(wl_params_[i].x2));
+        wl_y2_.push_back(float(wl_params_[i].y2));
+        wl_radius_.push_back(float(wl_params_[i].boxRadius));
+        wl_th_.push_back(wl_params_[i].th);
+    }
 }
 
+#if CV_SIMD128
+/**
+ * @brief Computes the descriptors of 4 keypoints in the image center at once, one keypoint per lane.
+ * Gives the same results as the scalar code: the rectification is done with the same float operations
+ * and the box differences are exact integer sums.
+ * @param m Transformations of the 4 keypoints, as given by patchToImageTransform
+ * @param d Pointers to the 4 output descriptors
+ */
+static void computeBEBLID4(const int *integralPtr, int integralCols, const float (*m)[7],
+                           const std::vector<float> &wlX1, const std::vector<float> &wlY1,
+                           const std::vector<float> &wlX2, const std::vector<float> &wlY2,
+                           const std::vector<float> &wlRadius, const std::vector<int> &wlTh,
+                           uchar *d[4])
+{
+    const v_float32x4 m00(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const v_float32x4 m01(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const v_float32x4 m02(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const v_float32x4 m10(m[0][3], m[1][3], m[2][3], m[3][3]);
+    const v_float32x4 m11(m[0][4], m[1][4], m[2][4], m[3][4]);
+    const v_float32x4 m12(m[0][5], m[1][5], m[2][5], m[3][5]);
+    const v_float32x4 s(m[0][6], m[1][6], m[2][6], m[3][6]);
+    const v_float32x4 half = v_setall_f32(0.5f);
+    const v_int32x4 cols = v_setall_s32(integralCols), one = v_setall_s32(1);
+
+    v_int32x4 bytes = v_setzero_s32();
+    for (size_t wlIdx = 0; wlIdx < wlTh.size(); wlIdx++)
+    {
+        const int bit_idx = 7 - int(wlIdx % 8);
+        const v_float32x4 x1 = v_setall_f32(wlX1[wlIdx]), y1 = v_setall_f32(wlY1[wlIdx]);
+        const v_float32x4 x2 = v_setall_f32(wlX2[wlIdx]), y2 = v_setall_f32(wlY2[wlIdx]);
+
+        // rectified weak learner, CV_ROUNDNUM of every coordinate
+        v_int32x4 ix1 = v_trunc(m00 * x1 + m01 * y1 + m02 + half);
+        v_int32x4 iy1 = v_trunc(m10 * x1 + m11 * y1 + m12 + half);
+        v_int32x4 ix2 = v_trunc(m00 * x2 + m01 * y2 + m02 + half);
+        v_int32x4 iy2 = v_trunc(m10 * x2 + m11 * y2 + m12 + half);
+        v_int32x4 r = v_trunc(s * v_setall_f32(wlRadius[wlIdx]) + half);
+
+        v_int32x4 box1y1 = (iy1 - r) * cols, box1y2 = (iy1 + r + one) * cols;
+        v_int32x4 box1x1 = ix1 - r, box1x2 = ix1 + r + one;
+        v_int32x4 box2y1 = (iy2 - r) * cols, box2y2 = (iy2 + r + one) * cols;
+        v_int32x4 box2x1 = ix2 - r, box2x2 = ix2 + r + one;
+        v_int32x4 side = one + (r + r);
+
+        v_int32x4 areaResponseFun = v_lut(integralPtr, box1y1 + box1x1) + v_lut(integralPtr, box1y2 + box1x2)
+                                  - v_lut(integralPtr, box1y1 + box1x2) - v_lut(integralPtr, box1y2 + box1x1)
+                                  - v_lut(integralPtr, box2y1 + box2x1) - v_lut(integralPtr, box2y2 + box2x2)
+                                  + v_lut(integralPtr, box2y1 + box2x2) + v_lut(integralPtr, box2y2 + box2x1);
+
+        // Set the bit to 1 if the response function is less or equal to the threshod
+        v_int32x4 bit = areaResponseFun <= v_setall_s32(wlTh[wlIdx]) * (side * side);
+        bytes = bytes | (bit & v_setall_s32(1 << bit_idx));
+
+        // If we filled the bytes, save them
+        if (bit_idx == 0)
+        {
+            int b[4];
+            v_store(b, bytes);
+            for (int k = 0; k < 4; k++)
+                *d[k]++ = (uchar)b[k];
+            bytes = v_setzero_s32();
+        }
+    }
+}
+#endif
+
 // Internal function that implements the core of BEBLID descriptor
 void BEBLID_Impl::computeBEBLID(const cv::Mat &integralImg,
                                 const std::vector<cv::KeyPoint> &keypoints,
@@ -323,10 +425,38 @@ void BEBLID_Impl::computeBEBLID(const cv::Mat &integralImg,
         int box1x1, box1y1, box1x2, box1y2, box2x1, box2y1, box2x2, box2y2, bit_idx, side;
         uchar byte = 0;
         std::vector<ABWLParams> imgWLParams(wl_params_.size());
-        uchar *d = &descriptors.at<uchar>(range.start, 0);
+        uchar *d;
+
+#if CV_SIMD128
+        // The keypoints in the image center are evaluated by groups of 4, one per SIMD lane;
+        // the ones left over are processed one by one below
+        std::vector<int> centerKps;
+        for (kpIdx = range.start; kpIdx < range.end; kpIdx++)
+            if (!isKeypointInTheBorder(keypoints[kpIdx], frameSize, patch_size_, scale_factor_))
+                centerKps.push_back(kpIdx);
+        size_t nGrouped = centerKps.size() - centerKps.size() % 4;
+        std::vector<uchar> isGrouped(range.end - range.start, 0);
+        for (size_t g = 0; g < nGrouped; g += 4)
+        {
+            float m[4][7];
+            uchar *dst[4];
+            for (int k = 0; k < 4; k++)
+            {
+                patchToImageTransform(keypoints[centerKps[g + k]], scale_factor_, patch_size_, m[k]);
+                dst[k] = descriptors.ptr<uchar>(centerKps[g + k]);
+                isGrouped[centerKps[g + k] - range.start] = 1;
+            }
+            computeBEBLID4(integralPtr, integralImg.cols, m, wl_x1_, wl_y1_, wl_x2_, wl_y2_, wl_radius_, wl_th_, dst);
+        }
+#endif
 
         for (kpIdx = range.start; kpIdx < range.end; kpIdx++)
         {
+#if CV_SIMD128
+            if (isGrouped[kpIdx - range.start])
+                continue;
+#endif
+            d = descriptors.ptr<uchar>(kpIdx);
             // Rectify the weak learners coordinates using the keypoint information
             rectifyABWL(wl_params_, imgWLParams, keypoints[kpIdx], scale_factor_, patch_size_);
             if (isKeypointInTheBorder(keypoints[kpIdx], frameSize, patch_size_, scale_factor_))
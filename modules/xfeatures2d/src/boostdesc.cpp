@@ -53,6 +53,7 @@
 
 #include <bitset>
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 
 
@@ -282,30 +283,37 @@ static void computeGradientMaps( const Mat& im,
     }
 }
 
+/*
+ * integral images of the orientation maps followed by
+ * the one of their sum, one plane of (rows+1)*(cols+1) per row
+ */
 static void computeIntegrals( const vector<Mat>& gradMap,
                               const int orientQuant,
-                              vector<Mat>& integralMap )
+                              Mat& integralMap )
 {
     // init integral images
     int rows = gradMap[0].rows;
     int cols = gradMap[0].cols;
+    int planeSize = (rows+1)*(cols+1);
 
-    for ( int i = 0; i < orientQuant+1; i++ )
-      integralMap.push_back( Mat::zeros( rows+1, cols+1, CV_8UC1 ) );
+    integralMap.create( orientQuant+1, planeSize, CV_32SC1 );
 
     // generate corresponding integral images
     for( int i = 0; i < orientQuant; i++ )
-      integral( gradMap[i], integralMap[i] );
+    {
+      Mat plane = integralMap.row(i).reshape( 1, rows+1 );
+      integral( gradMap[i], plane, CV_32S );
+    }
 
     // copy the values from the first quantization bin
-    integralMap[0].copyTo( integralMap[orientQuant] );
+    integralMap.row(0).copyTo( integralMap.row(orientQuant) );
 
     int* ptrSum, *ptr;
     for ( int k = 1; k < orientQuant; k++ )
     {
-      ptr    = (int*) integralMap[k].ptr<int>();
-      ptrSum = (int*) integralMap[orientQuant].ptr<int>();
-      for (int i=0; i<(rows+1)*(cols+1); ++i)
+      ptr    = integralMap.ptr<int>(k);
+      ptrSum = integralMap.ptr<int>(orientQuant);
+      for (int i=0; i<planeSize; ++i)
       {
         *ptrSum += *ptr;
         ++ptrSum;
@@ -314,35 +322,90 @@ static void computeIntegrals( const vector<Mat>& gradMap,
     }
 }
 
-static float computeWLResponse( const int x_min,  const int x_max,
-                                const int y_min,  const int y_max,
-                                const int orient, const float thresh,
-                                const int orientQuant,
-                                const vector<Mat>& integralMap )
+/*
+ * weak learners stored as structure of arrays, the box
+ * corners are offsets inside of an integral image plane
+ */
+struct WeakLearners
 {
-    const int width = integralMap[0].cols;
-
-    const int idx1 = (y_min    ) * width + x_min;
-    const int idx2 = (y_min    ) * width + x_max + 1;
-    const int idx3 = (y_max + 1) * width + x_min;
-    const int idx4 = (y_max + 1) * width + x_max + 1;
-
-    const int* ptr = integralMap[orient].ptr<int>();
-
-    int A, B ,C, D;
-    A = ptr[idx1]; B = ptr[idx2];
-    C = ptr[idx3]; D = ptr[idx4];
-
-    const float current = float(D + A - B - C);
+    vector<int> plane;
+    vector<int> idx1, idx2, idx3, idx4;
+    vector<float> thresh;
+
+    void init( const Mat& x_min, const Mat& x_max,
+               const Mat& y_min, const Mat& y_max,
+               const Mat& orient, const Mat& thr,
+               const int patchSize )
+    {
+      const int width = patchSize + 1;
+      const int planeSize = width * width;
+      const int n = (int) x_min.total();
 
-    ptr = integralMap[orientQuant].ptr<int>();
+      plane.resize(n); thresh.resize(n);
+      idx1.resize(n); idx2.resize(n); idx3.resize(n); idx4.resize(n);
+      for ( int i = 0; i < n; i++ )
+      {
+        const int r = i / x_min.cols, c = i % x_min.cols;
+        plane[i] = orient.at<int>(r,c) * planeSize;
+        idx1[i] = (y_min.at<int>(r,c)    ) * width + x_min.at<int>(r,c);
+        idx2[i] = (y_min.at<int>(r,c)    ) * width + x_max.at<int>(r,c) + 1;
+        idx3[i] = (y_max.at<int>(r,c) + 1) * width + x_min.at<int>(r,c);
+        idx4[i] = (y_max.at<int>(r,c) + 1) * width + x_max.at<int>(r,c) + 1;
+        thresh[i] = thr.at<float>(r,c);
+      }
+    }
+};
 
-    A = ptr[idx1]; B = ptr[idx2];
-    C = ptr[idx3]; D = ptr[idx4];
+/*
+ * sign of all the weak learners responses, 1 for a
+ * response greater or equal to zero, 0 otherwise
+ */
+static void computeWLSigns( const WeakLearners& wl,
+                            const Mat& integralMap,
+                            const int orientQuant,
+                            uchar* signs )
+{
+    const int* ptr = integralMap.ptr<int>();
+    const int* ptrSum = integralMap.ptr<int>(orientQuant);
+    const int n = (int) wl.thresh.size();
+
+    int i = 0;
+#if CV_SIMD128
+    const v_float32x4 zero = v_setzero_f32();
+    for ( ; i <= n - 4; i += 4 )
+    {
+      const v_int32x4 idx1 = v_load(&wl.idx1[i]), idx2 = v_load(&wl.idx2[i]);
+      const v_int32x4 idx3 = v_load(&wl.idx3[i]), idx4 = v_load(&wl.idx4[i]);
+      const v_int32x4 plane = v_load(&wl.plane[i]);
+
+      const v_float32x4 current = v_cvt_f32( v_lut(ptr, plane + idx4) + v_lut(ptr, plane + idx1)
+                                           - v_lut(ptr, plane + idx2) - v_lut(ptr, plane + idx3) );
+      const v_float32x4 total = v_cvt_f32( v_lut(ptrSum, idx4) + v_lut(ptrSum, idx1)
+                                         - v_lut(ptrSum, idx2) - v_lut(ptrSum, idx3) );
+
+      // an empty box gives a zero response
+      const v_float32x4 empty = total == zero;
+      const v_float32x4 resp = ( current / v_select(empty, v_setall_f32(1.f), total) ) - v_load(&wl.thresh[i]);
+      const v_int32x4 sign = v_reinterpret_as_s32( empty | ( resp >= zero ) );
+
+      int s[4];
+      v_store( s, sign );
+      for ( int k = 0; k < 4; k++ )
+        signs[i+k] = (uchar) ( s[k] & 1 );
+    }
+#endif
+    for ( ; i < n; i++ )
+    {
+      const int idx1 = wl.idx1[i], idx2 = wl.idx2[i];
+      const int idx3 = wl.idx3[i], idx4 = wl.idx4[i];
+      const int* p = ptr + wl.plane[i];
 
-    const float total = float(D + A - B - C);
+      const float current = float(p[idx4] + p[idx1] - p[idx2] - p[idx3]);
+      const float total = float(ptrSum[idx4] + ptrSum[idx1] - ptrSum[idx2] - ptrSum[idx3]);
+      const float WLR = total ? ( (current / total) - wl.thresh[i] ) : 0.f;
 
-    return total ? ( (current / total) - thresh ) : 0.f;
+      signs[i] = ( WLR >= 0 ) ? 1 : 0;
+    }
 }
 
 static void rectifyPatch( const Mat& image, const KeyPoint& kp,
@@ -416,12 +479,19 @@ struct ComputeBoostDescInvoker : ParallelLoopBody
 
       scale_factor = _scale_factor;
       use_scale_orientation  = _use_scale_orientation;
+
+      wl.init( wl_x_min, wl_x_max, wl_y_min, wl_y_max,
+               wl_orient, wl_thresh, patch_size );
     }
 
     void operator ()( const cv::Range& range ) const CV_OVERRIDE
     {
       // maps
-      vector<Mat> gradMap, integralMap;
+      vector<Mat> gradMap;
+      Mat integralMap;
+
+      // signs of the weak learners responses
+      vector<uchar> signs( wl.thresh.size() );
 
       // small binary map
       uchar binLookUp[8];
@@ -439,8 +509,7 @@ struct ComputeBoostDescInvoker : ParallelLoopBody
         // compute gradient maps (and integral gradient maps)
         computeGradientMaps( patch, grad_atype, orient_q, gradMap );
         computeIntegrals( gradMap, orient_q, integralMap );
-
-        float WLR;
+        computeWLSigns( wl, integralMap, orient_q, &signs[0] );
 
         /*
          * BGM
@@ -452,13 +521,7 @@ struct ComputeBoostDescInvoker : ParallelLoopBody
         {
           uchar* desc = descriptors->ptr<uchar>(i);
           for ( int j = 0; j < nWLs; j++ )
-          {
-            WLR = computeWLResponse( wl_x_min.at<int>(0,j), wl_x_max.at<int>(0,j),
-                                     wl_y_min.at<int>(0,j), wl_y_max.at<int>(0,j),
-                                     wl_orient.at<int>(0,j), wl_thresh.at<float>(0,j),
-                                     orient_q, integralMap );
-            desc[j/8] |=  ( WLR >= 0 ) ? binLookUp[ j % 8 ] : 0;
-          }
+            desc[j/8] |=  signs[j] ? binLookUp[ j % 8 ] : 0;
         } // end BGM
 
         /*
@@ -469,13 +532,7 @@ struct ComputeBoostDescInvoker : ParallelLoopBody
           std::bitset<512> wlResponses;
 
           for ( int j = 0; j < nWLs; j++ )
-          {
-            WLR = computeWLResponse( wl_x_min.at<int>(0,j), wl_x_max.at<int>(0,j),
-                                     wl_y_min.at<int>(0,j), wl_y_max.at<int>(0,j),
-                                     wl_orient.at<int>(0,j), wl_thresh.at<float>(0,j),
-                                     orient_q, integralMap );
-            wlResponses[j] = ( WLR >= 0 ) ? 1 : 0;
-        }
+            wlResponses[j] = signs[j];
 
           float* desc = descriptors->ptr<float>(i);
           for ( int d = 0; d < Dims; d++ )
@@ -500,14 +557,8 @@ struct ComputeBoostDescInvoker : ParallelLoopBody
           {
             resp = 0;
             uchar* desc = descriptors->ptr<uchar>(i);
-            for ( int wl = 0; wl < nWLs; wl++ )
-            {
-              WLR = computeWLResponse( wl_x_min.at<int>(d,wl), wl_x_max.at<int>(d,wl),
-                                       wl_y_min.at<int>(d,wl), wl_y_max.at<int>(d,wl),
-                                       wl_orient.at<int>(d,wl), wl_thresh.at<float>(d,wl),
-                                       orient_q, integralMap );
-              resp += ( WLR >= 0 ) ? wl_beta.at<float>(d,wl) : -wl_beta.at<float>(d,wl);
-            }
+            for ( int j = 0; j < nWLs; j++ )
+              resp += signs[d*nWLs+j] ? wl_beta.at<float>(d,j) : -wl_beta.at<float>(d,j);
             desc[d/8] |= ( resp >= 0 ) ? binLookUp[d%8] : 0;
           }
         } // end BINBOOST
@@ -515,7 +566,6 @@ struct ComputeBoostDescInvoker : ParallelLoopBody
         // clean-up
         patch.release();
         gradMap.clear();
-        integralMap.clear();
 
       } // end for loop
     } // end operator
@@ -534,6 +584,7 @@ struct ComputeBoostDescInvoker : ParallelLoopBody
 
     Mat wl_x_min, wl_x_max, wl_y_min, wl_y_max;
     Mat wl_thresh, wl_orient, wl_alpha, wl_beta;
+    WeakLearners wl;
 
     float scale_factor;
     bool use_scale_orientation;
@@ -548,6 +599,8 @@ struct ComputeBoostDescInvoker : ParallelLoopBody
 // descriptor computation using keypoints
 void BoostDesc_Impl::compute( InputArray _image, vector<KeyPoint>& keypoints, OutputArray _descriptors )
 {
+    CV_INSTRUMENT_REGION();
+
     // do nothing if no image
     if( _image.getMat().empty() )
       return;
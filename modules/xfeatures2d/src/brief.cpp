@@ -232,6 +232,8 @@ void BriefDescriptorExtractorImpl::compute(InputArray image,
                                            std::vector<KeyPoint>& keypoints,
                                            OutputArray descriptors)
 {
+    CV_INSTRUMENT_REGION();
+
     // Construct integral image for fast smoothing (box filter)
     Mat sum;
 
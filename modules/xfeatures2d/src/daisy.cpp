@@ -135,6 +135,24 @@ public:
      */
     virtual void compute( InputArray image, OutputArray descriptors ) CV_OVERRIDE;
 
+    /** @overload
+     * @param image image to extract descriptors
+     * @param roi region of interest within image
+     * @param descriptors resulted descriptors array
+     * @param ddepth depth of descriptors (CV_32F, CV_16F or CV_8U)
+     */
+    virtual void compute( InputArray image, Rect roi, OutputArray descriptors, int ddepth ) CV_OVERRIDE;
+
+    /** @brief Computes dense descriptors of roi band by band
+     * @param image image to extract descriptors
+     * @param roi region of interest within image
+     * @param bandHeight number of roi rows per band
+     * @param ddepth depth of descriptors (CV_32F, CV_16F or CV_8U)
+     * @param callback called for every band
+     */
+    virtual void computeBands( InputArray image, Rect roi, int bandHeight, int ddepth,
+                               const std::function<void(const Rect& band, const Mat& descriptors)>& callback ) CV_OVERRIDE;
+
     /**
      * @param y position y on image
      * @param x position x on image
@@ -320,6 +338,10 @@ private:
     // applies one of the normalizations (partial,full,sift) to the desciptors.
     inline void normalize_descriptors( Mat* m_dense_descriptors );
 
+    // prepares the dense computation of roi, then computes it band by band
+    inline void initialize_dense_mode( InputArray image, Rect roi, int ddepth );
+    inline void compute_dense_band( Rect band, int ddepth, Mat& band_descriptors, Mat& dst );
+
     inline void update_selected_cubes();
 
 }; // END DAISY_Impl CLASS
@@ -993,6 +1015,7 @@ struct ComputeDescriptorsInvoker : ParallelLoopBody
     {
       x_off = _roi->x;
       x_end = _roi->x + _roi->width;
+      y_off = _roi->y;
       image = _image;
       layers = _layers;
       th_q_no = _th_q_no;
@@ -1010,7 +1033,8 @@ struct ComputeDescriptorsInvoker : ParallelLoopBody
       {
         for( int x = x_off; x < x_end; x++ )
         {
-          index = y*image->cols + x;
+          // descriptors hold the roi pixels only
+          index = (y - y_off)*(x_end - x_off) + (x - x_off);
           orientation = 0;
           if( !orientation_map->empty() )
               orientation = (int) orientation_map->at<ushort>( y, x );
@@ -1024,7 +1048,7 @@ struct ComputeDescriptorsInvoker : ParallelLoopBody
     }
 
     int th_q_no;
-    int x_off, x_end;
+    int x_off, x_end, y_off;
     std::vector<Mat>* layers;
     Mat *descriptors;
     Mat *orientation_map;
@@ -1483,6 +1507,8 @@ inline void DAISY_Impl::set_image( InputArray _image )
 // keypoint scope
 void DAISY_Impl::compute( InputArray _image, std::vector<KeyPoint>& keypoints, OutputArray _descriptors )
 {
+    CV_INSTRUMENT_REGION();
+
     // do nothing if no image
     if( _image.getMat().empty() )
       return;
@@ -1538,6 +1564,8 @@ void DAISY_Impl::compute( InputArray _image, std::vector<KeyPoint>& keypoints, O
 // full scope with roi
 void DAISY_Impl::compute( InputArray _image, Rect roi, OutputArray _descriptors )
 {
+    CV_INSTRUMENT_REGION();
+
     // do nothing if no image
     if( _image.getMat().empty() )
       return;
@@ -1564,6 +1592,8 @@ void DAISY_Impl::compute( InputArray _image, Rect roi, OutputArray _descriptors
 // full scope
 void DAISY_Impl::compute( InputArray _image, OutputArray _descriptors )
 {
+    CV_INSTRUMENT_REGION();
+
     // do nothing if no image
     if( _image.getMat().empty() )
       return;
@@ -1588,6 +1618,90 @@ void DAISY_Impl::compute( InputArray _image, OutputArray _descriptors )
     normalize_descriptors( &descriptors );
 }
 
+inline void DAISY_Impl::initialize_dense_mode( InputArray _image, Rect roi, int ddepth )
+{
+    CV_Assert( m_h_matrix.empty() );
+    CV_Assert( ! m_use_orientation );
+    CV_Assert( ddepth == CV_32F || ddepth == CV_16F || ddepth == CV_8U );
+
+    set_image( _image );
+    CV_Assert( roi.x >= 0 && roi.y >= 0 && roi.width > 0 && roi.height > 0 &&
+               roi.x + roi.width <= m_image.cols && roi.y + roi.height <= m_image.rows );
+
+    set_parameters();
+    initialize_single_descriptor_mode();
+}
+
+// computes the descriptors of band into band_descriptors (CV_32F) and stores them,
+// converted to ddepth, in dst (which can be band_descriptors itself if ddepth is CV_32F)
+inline void DAISY_Impl::compute_dense_band( Rect band, int ddepth, Mat& band_descriptors, Mat& dst )
+{
+    m_roi = band;
+    band_descriptors.create( band.width*band.height, m_descriptor_size, CV_32F );
+    compute_descriptors( &band_descriptors );
+    normalize_descriptors( &band_descriptors );
+
+    if( ddepth == CV_8U )
+        band_descriptors.convertTo( dst, CV_8U, 255.0 );
+    else if( ddepth == CV_16F )
+        band_descriptors.convertTo( dst, CV_16F );
+    else if( dst.data != band_descriptors.data )
+        band_descriptors.copyTo( dst );
+}
+
+// full scope with roi and quantized descriptors
+void DAISY_Impl::compute( InputArray _image, Rect roi, OutputArray _descriptors, int ddepth )
+{
+    CV_INSTRUMENT_REGION();
+
+    // do nothing if no image
+    if( _image.getMat().empty() )
+      return;
+
+    if( ddepth == CV_32F )
+    {
+      compute( _image, roi, _descriptors );
+      return;
+    }
+
+    initialize_dense_mode( _image, roi, ddepth );
+
+    _descriptors.create( roi.width*roi.height, m_descriptor_size, ddepth );
+    Mat descriptors = _descriptors.getMat();
+
+    // float descriptors are computed for about 32 MB worth of rows at a time
+    int bandHeight = std::max( 1, (int)( ( (size_t)32 << 20 ) / ( (size_t)roi.width * m_descriptor_size * sizeof(float) ) ) );
+    Mat band_descriptors;
+    for( int y = roi.y; y < roi.y + roi.height; y += bandHeight )
+    {
+      Rect band( roi.x, y, roi.width, std::min( bandHeight, roi.y + roi.height - y ) );
+      Mat dst = descriptors.rowRange( (y - roi.y)*roi.width, (y - roi.y + band.height)*roi.width );
+      compute_dense_band( band, ddepth, band_descriptors, dst );
+    }
+    m_roi = roi;
+}
+
+// full scope with roi, band by band
+void DAISY_Impl::computeBands( InputArray _image, Rect roi, int bandHeight, int ddepth,
+                               const std::function<void(const Rect& band, const Mat& descriptors)>& callback )
+{
+    // do nothing if no image
+    if( _image.getMat().empty() )
+      return;
+
+    CV_Assert( bandHeight > 0 );
+    initialize_dense_mode( _image, roi, ddepth );
+
+    Mat band_descriptors, descriptors;
+    for( int y = roi.y; y < roi.y + roi.height; y += bandHeight )
+    {
+      Rect band( roi.x, y, roi.width, std::min( bandHeight, roi.y + roi.height - y ) );
+      compute_dense_band( band, ddepth, band_descriptors, ddepth == CV_32F ? band_descriptors : descriptors );
+      callback( band, ddepth == CV_32F ? band_descriptors : descriptors );
+    }
+    m_roi = roi;
+}
+
 // constructor
 DAISY_Impl::DAISY_Impl( float _radius, int _q_radius, int _q_theta, int _q_hist,
              DAISY::NormalizationType _norm, InputArray _H, bool _interpolation, bool _use_orientation )
@@ -320,6 +320,8 @@ void FREAK_Impl::buildPattern()
 
 void FREAK_Impl::compute( InputArray _image, std::vector<KeyPoint>& keypoints, OutputArray _descriptors )
 {
+    CV_INSTRUMENT_REGION();
+
     Mat image = _image.getMat();
     if( image.empty() )
         return;
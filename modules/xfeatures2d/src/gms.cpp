@@ -65,18 +65,49 @@ const int mRotationPatterns[8][9] = {
 // 5 level scales
 const double mScaleRatios[5] = { 1.0, 1.0 / 2, 1.0 / std::sqrt(2.0), std::sqrt(2.0), 2.0 };
 
-class GMSMatcher
+// Get Neighbor 9
+static vector<int> getNB9(const int idx, const Size& gridSize)
+{
+    vector<int> NB9(9, -1);
+
+    int idx_x = idx % gridSize.width;
+    int idx_y = idx / gridSize.width;
+
+    for (int yi = -1; yi <= 1; yi++)
+    {
+        for (int xi = -1; xi <= 1; xi++)
+        {
+            int idx_xx = idx_x + xi;
+            int idx_yy = idx_y + yi;
+
+            if (idx_xx < 0 || idx_xx >= gridSize.width || idx_yy < 0 || idx_yy >= gridSize.height)
+                continue;
+
+            NB9[xi + 4 + yi * 3] = idx_xx + idx_yy * gridSize.width;
+        }
+    }
+    return NB9;
+}
+
+static void initalizeNeighbors(Mat &neighbor, const Size& gridSize)
+{
+    for (int i = 0; i < neighbor.rows; i++)
+    {
+        vector<int> NB9 = getNB9(i, gridSize);
+        int *data = neighbor.ptr<int>(i);
+        memcpy(data, &NB9[0], sizeof(int) * 9);
+    }
+}
+
+class GMSMatcherImpl CV_FINAL : public GMSMatcher
 {
 public:
-    // OpenCV Keypoints & Correspond Image Size & Nearest Neighbor Matches
-    GMSMatcher(const vector<KeyPoint>& vkp1, const Size& size1, const vector<KeyPoint>& vkp2, const Size& size2,
-               const vector<DMatch>& vDMatches, const double thresholdFactor) : mThresholdFactor(thresholdFactor)
+    GMSMatcherImpl(const Size& size1, const Size& size2, const bool withRotation, const bool withScale,
+                   const double thresholdFactor) :
+        mSize1(size1), mSize2(size2), mWithRotation(withRotation), mWithScale(withScale),
+        mThresholdFactor(thresholdFactor), mEarlyStopRatio(0)
     {
-        // Input initialize
-        normalizePoints(vkp1, size1, mvP1);
-        normalizePoints(vkp2, size2, mvP2);
-        mNumberMatches = vDMatches.size();
-        convertMatches(vDMatches, mvMatches);
+        CV_Assert(size1.width > 0 && size1.height > 0 && size2.width > 0 && size2.height > 0);
 
         // Grid initialize
         mGridSizeLeft = Size(20, 20);
@@ -85,116 +116,78 @@ public:
         // Initialize the neighbor of left grid
         mGridNeighborLeft = Mat::zeros(mGridNumberLeft, 9, CV_32SC1);
         initalizeNeighbors(mGridNeighborLeft, mGridSizeLeft);
-    }
-
-    ~GMSMatcher() {}
-
-    // Get Inlier Mask
-    // Return number of inliers
-    int getInlierMask(vector<bool> &vbInliers, const bool withRotation = false, const bool withScale = false);
 
+        // Initialize the neighbor of right grids, one per scale
+        mGridNumberRightMax = 0;
+        for (int scale = 0; scale < 5; scale++)
+        {
+            mGridSizeRight[scale].width = cvRound(mGridSizeLeft.width  * mScaleRatios[scale]);
+            mGridSizeRight[scale].height = cvRound(mGridSizeLeft.height * mScaleRatios[scale]);
+            int gridNumber = mGridSizeRight[scale].width * mGridSizeRight[scale].height;
+            mGridNumberRightMax = std::max(mGridNumberRightMax, gridNumber);
 
-private:
-    // Normalized Points
-    vector<Point2f> mvP1, mvP2;
-
-    // Matches
-    vector<pair<int, int> > mvMatches;
-
-    // Number of Matches
-    size_t mNumberMatches;
-
-    // Grid Size
-    Size mGridSizeLeft, mGridSizeRight;
-    int mGridNumberLeft;
-    int mGridNumberRight;
+            mGridNeighborRight[scale] = Mat::zeros(gridNumber, 9, CV_32SC1);
+            initalizeNeighbors(mGridNeighborRight[scale], mGridSizeRight[scale]);
+        }
+    }
 
-    // x      : left grid idx
-    // y      : right grid idx
-    // value  : how many matches from idx_left to idx_right
-    Mat mMotionStatistics;
+    void match(const vector<KeyPoint>& keypoints1, const vector<KeyPoint>& keypoints2,
+               const vector<DMatch>& matches1to2, vector<DMatch>& matchesGMS) CV_OVERRIDE;
 
-    //
-    vector<int> mNumberPointsInPerCellLeft;
+    void setEarlyStopRatio(double ratio) CV_OVERRIDE { mEarlyStopRatio = ratio; }
+    double getEarlyStopRatio() const CV_OVERRIDE { return mEarlyStopRatio; }
 
-    // Inldex  : grid_idx_left
-    // Value   : grid_idx_right
-    vector<int> mCellPairs;
+private:
+    // State of the verification of one hypothesis, reused between hypotheses and calls
+    struct Workspace
+    {
+        // x      : left grid idx
+        // y      : right grid idx
+        // value  : how many matches from idx_left to idx_right
+        Mat motionStatistics;
 
-    // Every Matches has a cell-pair
-    // first  : grid_idx_left
-    // second : grid_idx_right
-    vector<pair<int, int> > mvMatchPairs;
+        vector<int> numberPointsInPerCellLeft;
 
-    // Inlier Mask for output
-    vector<bool> mvbInlierMask;
+        // Inldex  : grid_idx_left
+        // Value   : grid_idx_right
+        vector<int> cellPairs;
 
-    //
-    Mat mGridNeighborLeft;
-    Mat mGridNeighborRight;
+        // Value of motionStatistics at cellPairs
+        vector<int> cellPairsNumber;
+    };
 
+    Size mSize1, mSize2;
+    bool mWithRotation, mWithScale;
     double mThresholdFactor;
+    double mEarlyStopRatio;
 
+    // Grid Size
+    Size mGridSizeLeft, mGridSizeRight[5];
+    int mGridNumberLeft;
+    int mGridNumberRightMax;
 
-    // Assign Matches to Cell Pairs
-    void assignMatchPairs(const int GridType);
-
-    void convertMatches(const vector<DMatch> &vDMatches, vector<pair<int, int> > &vMatches);
-
-    int getGridIndexLeft(const Point2f &pt, const int type);
-
-    int getGridIndexRight(const Point2f &pt);
+    Mat mGridNeighborLeft;
+    Mat mGridNeighborRight[5];
 
-    vector<int> getNB9(const int idx, const Size& GridSize);
+    // Left cell of every match for the 4 grid types and right cell for the 5 scales
+    vector<int> mLeftCells[4];
+    vector<int> mRightCells[5];
 
-    void initalizeNeighbors(Mat &neighbor, const Size& GridSize);
+    vector<Workspace> mWorkspaces;
 
-    void normalizePoints(const vector<KeyPoint> &kp, const Size &size, vector<Point2f> &npts);
+    int getGridIndexLeft(const Point2f &pt, const int type) const;
 
-    // Run
-    int run(const int rotationType);
+    int getGridIndexRight(const Point2f &pt, const int scale) const;
 
-    void setScale(const int scale);
+    // Inliers of a scale and rotation hypothesis
+    // Return number of inliers
+    int run(const int scale, const int rotationType, Workspace& ws, vector<uchar>& inlierMask) const;
 
     // Verify Cell Pairs
-    void verifyCellPairs(const int rotationType);
+    void verifyCellPairs(const int scale, const int rotationType, Workspace& ws) const;
 };
 
-void GMSMatcher::assignMatchPairs(const int gridType)
-{
-    for (size_t i = 0; i < mNumberMatches; i++)
-    {
-        Point2f &lp = mvP1[mvMatches[i].first];
-        Point2f &rp = mvP2[mvMatches[i].second];
-
-        int lgidx = mvMatchPairs[i].first = getGridIndexLeft(lp, gridType);
-        int rgidx = -1;
-
-        if (gridType == 1)
-        {
-            rgidx = mvMatchPairs[i].second = getGridIndexRight(rp);
-        }
-        else
-        {
-            rgidx = mvMatchPairs[i].second;
-        }
-
-        if (lgidx < 0 || rgidx < 0) continue;
-
-        mMotionStatistics.at<int>(lgidx, rgidx)++;
-        mNumberPointsInPerCellLeft[lgidx]++;
-    }
-}
-
-// Convert OpenCV DMatch to Match (pair<int, int>)
-void GMSMatcher::convertMatches(const vector<DMatch> &vDMatches, vector<pair<int, int> > &vMatches)
-{
-    vMatches.resize(mNumberMatches);
-    for (size_t i = 0; i < mNumberMatches; i++)
-        vMatches[i] = pair<int, int>(vDMatches[i].queryIdx, vDMatches[i].trainIdx);
-}
-
-int GMSMatcher::getGridIndexLeft(const Point2f &pt, const int type)
+int GMSMatcherImpl::getGridIndexLeft(const Point2f &pt, const int type) const
 {
     int x = 0, y = 0;
 
@@ -219,204 +212,89 @@ int GMSMatcher::getGridIndexLeft(const Point2f &pt, const int type)
     }
 
 
-    if (x >= mGridSizeLeft.width || y >= mGridSizeLeft.height)
+    if (x < 0 || y < 0 || x >= mGridSizeLeft.width || y >= mGridSizeLeft.height)
         return -1;
 
     return x + y * mGridSizeLeft.width;
 }
 
-int GMSMatcher::getGridIndexRight(const Point2f &pt)
+int GMSMatcherImpl::getGridIndexRight(const Point2f &pt, const int scale) const
 {
-    int x = cvFloor(pt.x * mGridSizeRight.width);
-    int y = cvFloor(pt.y * mGridSizeRight.height);
+    const Size& gridSize = mGridSizeRight[scale];
+    int x = cvFloor(pt.x * gridSize.width);
+    int y = cvFloor(pt.y * gridSize.height);
+
+    // keypoints outside of the image
+    if (x < 0 || y < 0 || x >= gridSize.width || y >= gridSize.height)
+        return -1;
 
-    return x + y * mGridSizeRight.width;
+    return x + y * gridSize.width;
 }
 
-int GMSMatcher::getInlierMask(vector<bool> &vbInliers, const bool withRotation, const bool withScale)
+int GMSMatcherImpl::run(const int scale, const int rotationType, Workspace& ws, vector<uchar>& inlierMask) const
 {
-    int max_inlier = 0;
+    const size_t numberMatches = mLeftCells[0].size();
+    const vector<int>& rightCells = mRightCells[scale];
+    inlierMask.assign(numberMatches, 0);
 
-    if (!withScale && !withRotation)
-    {
-        setScale(0);
-        max_inlier = run(1);
-        vbInliers = mvbInlierMask;
-        return max_inlier;
-    }
+    if (ws.motionStatistics.empty())
+        ws.motionStatistics = Mat::zeros(mGridNumberLeft, mGridNumberRightMax, CV_32SC1);
 
-    if (withRotation && withScale)
+    for (int gridType = 1; gridType <= 4; gridType++)
     {
-        for (int scale = 0; scale < 5; scale++)
-        {
-            setScale(scale);
-            for (int rotationType = 1; rotationType <= 8; rotationType++)
-            {
-                int num_inlier = run(rotationType);
+        const vector<int>& leftCells = mLeftCells[gridType - 1];
 
-                if (num_inlier > max_inlier)
-                {
-                    vbInliers = mvbInlierMask;
-                    max_inlier = num_inlier;
-                }
-            }
-        }
-        return max_inlier;
-    }
+        // initialize
+        ws.cellPairs.assign(mGridNumberLeft, -1);
+        ws.cellPairsNumber.assign(mGridNumberLeft, 0);
+        ws.numberPointsInPerCellLeft.assign(mGridNumberLeft, 0);
 
-    if (withRotation && !withScale)
-    {
-        setScale(0);
-        for (int rotationType = 1; rotationType <= 8; rotationType++)
+        // Assign Matches to Cell Pairs, the cell pair of a left cell is
+        // the first right cell with the most matches
+        for (size_t i = 0; i < numberMatches; i++)
         {
-            int num_inlier = run(rotationType);
+            int lgidx = leftCells[i], rgidx = rightCells[i];
+            if (lgidx < 0 || rgidx < 0) continue;
 
-            if (num_inlier > max_inlier)
+            int number = ++ws.motionStatistics.ptr<int>(lgidx)[rgidx];
+            ws.numberPointsInPerCellLeft[lgidx]++;
+            if (number > ws.cellPairsNumber[lgidx] || (number == ws.cellPairsNumber[lgidx] && rgidx < ws.cellPairs[lgidx]))
             {
-                vbInliers = mvbInlierMask;
-                max_inlier = num_inlier;
+                ws.cellPairs[lgidx] = rgidx;
+                ws.cellPairsNumber[lgidx] = number;
             }
         }
-        return max_inlier;
-    }
 
-    if (!withRotation && withScale)
-    {
-        for (int scale = 0; scale < 5; scale++)
-        {
-            setScale(scale);
-            int num_inlier = run(1);
+        verifyCellPairs(scale, rotationType, ws);
 
-            if (num_inlier > max_inlier)
-            {
-                vbInliers = mvbInlierMask;
-                max_inlier = num_inlier;
-            }
-
-        }
-        return max_inlier;
-    }
-
-    return max_inlier;
-}
-
-// Get Neighbor 9
-vector<int> GMSMatcher::getNB9(const int idx, const Size& gridSize)
-{
-    vector<int> NB9(9, -1);
-
-    int idx_x = idx % gridSize.width;
-    int idx_y = idx / gridSize.width;
-
-    for (int yi = -1; yi <= 1; yi++)
-    {
-        for (int xi = -1; xi <= 1; xi++)
+        // Mark inliers and clean the motion statistics for the next run
+        for (size_t i = 0; i < numberMatches; i++)
         {
-            int idx_xx = idx_x + xi;
-            int idx_yy = idx_y + yi;
-
-            if (idx_xx < 0 || idx_xx >= gridSize.width || idx_yy < 0 || idx_yy >= gridSize.height)
-                continue;
+            int lgidx = leftCells[i], rgidx = rightCells[i];
+            if (lgidx < 0 || rgidx < 0) continue;
 
-            NB9[xi + 4 + yi * 3] = idx_xx + idx_yy * gridSize.width;
+            if (ws.cellPairs[lgidx] == rgidx)
+                inlierMask[i] = 1;
+            ws.motionStatistics.ptr<int>(lgidx)[rgidx] = 0;
         }
     }
-    return NB9;
-}
 
-void GMSMatcher::initalizeNeighbors(Mat &neighbor, const Size& gridSize)
-{
-    for (int i = 0; i < neighbor.rows; i++)
-    {
-        vector<int> NB9 = getNB9(i, gridSize);
-        int *data = neighbor.ptr<int>(i);
-        memcpy(data, &NB9[0], sizeof(int) * 9);
-    }
-}
-
-// Normalize Key Points to Range(0 - 1)
-void GMSMatcher::normalizePoints(const vector<KeyPoint> &kp, const Size &size, vector<Point2f> &npts)
-{
-    const size_t numP = kp.size();
-    const int width   = size.width;
-    const int height  = size.height;
-    npts.resize(numP);
-
-    for (size_t i = 0; i < numP; i++)
-    {
-        npts[i].x = kp[i].pt.x / width;
-        npts[i].y = kp[i].pt.y / height;
-    }
+    return countNonZero(inlierMask); //number of inliers
 }
 
-int GMSMatcher::run(const int rotationType)
-{
-    mvbInlierMask.assign(mNumberMatches, false);
-
-    // Initialize Motion Statisctics
-    mMotionStatistics = Mat::zeros(mGridNumberLeft, mGridNumberRight, CV_32SC1);
-    mvMatchPairs.assign(mNumberMatches, pair<int, int>(0, 0));
-
-    for (int gridType = 1; gridType <= 4; gridType++)
-    {
-        // initialize
-        mMotionStatistics.setTo(0);
-        mCellPairs.assign(mGridNumberLeft, -1);
-        mNumberPointsInPerCellLeft.assign(mGridNumberLeft, 0);
-
-        assignMatchPairs(gridType);
-        verifyCellPairs(rotationType);
-
-        // Mark inliers
-        for (size_t i = 0; i < mNumberMatches; i++)
-        {
-            if (mvMatchPairs[i].first >= 0 && mCellPairs[mvMatchPairs[i].first] == mvMatchPairs[i].second)
-                mvbInlierMask[i] = true;
-        }
-    }
-
-    return (int) count(mvbInlierMask.begin(), mvbInlierMask.end(), true); //number of inliers
-}
-
-void GMSMatcher::setScale(const int scale)
-{
-    // Set Scale
-    mGridSizeRight.width = cvRound(mGridSizeLeft.width  * mScaleRatios[scale]);
-    mGridSizeRight.height = cvRound(mGridSizeLeft.height * mScaleRatios[scale]);
-    mGridNumberRight = mGridSizeRight.width * mGridSizeRight.height;
-
-    // Initialize the neighbor of right grid
-    mGridNeighborRight = Mat::zeros(mGridNumberRight, 9, CV_32SC1);
-    initalizeNeighbors(mGridNeighborRight, mGridSizeRight);
-}
-
-void GMSMatcher::verifyCellPairs(const int rotationType)
+void GMSMatcherImpl::verifyCellPairs(const int scale, const int rotationType, Workspace& ws) const
 {
     const int *CurrentRP = mRotationPatterns[rotationType - 1];
 
     for (int i = 0; i < mGridNumberLeft; i++)
     {
-        if (sum(mMotionStatistics.row(i))[0] == 0)
-        {
-            mCellPairs[i] = -1;
+        if (ws.numberPointsInPerCellLeft[i] == 0)
             continue;
-        }
-
-        int max_number = 0;
-        for (int j = 0; j < mGridNumberRight; j++)
-        {
-            int *value = mMotionStatistics.ptr<int>(i);
-            if (value[j] > max_number)
-            {
-                mCellPairs[i] = j;
-                max_number = value[j];
-            }
-        }
 
-        int idx_grid_rt = mCellPairs[i];
+        int idx_grid_rt = ws.cellPairs[i];
 
         const int *NB9_lt = mGridNeighborLeft.ptr<int>(i);
-        const int *NB9_rt = mGridNeighborRight.ptr<int>(idx_grid_rt);
+        const int *NB9_rt = mGridNeighborRight[scale].ptr<int>(idx_grid_rt);
 
         int score = 0;
         double thresh = 0;
@@ -429,32 +307,116 @@ void GMSMatcher::verifyCellPairs(const int rotationType)
             if (ll == -1 || rr == -1)
                 continue;
 
-            score += mMotionStatistics.at<int>(ll, rr);
-            thresh += mNumberPointsInPerCellLeft[ll];
+            score += ws.motionStatistics.ptr<int>(ll)[rr];
+            thresh += ws.numberPointsInPerCellLeft[ll];
             numpair++;
         }
 
         thresh = mThresholdFactor * std::sqrt(thresh / numpair);
 
         if (score < thresh)
-            mCellPairs[i] = -2;
+            ws.cellPairs[i] = -2;
     }
 }
 
-void matchGMS( const Size& size1, const Size& size2, const vector<KeyPoint>& keypoints1, const vector<KeyPoint>& keypoints2,
-               const vector<DMatch>& matches1to2, vector<DMatch>& matchesGMS, const bool withRotation, const bool withScale,
-               const double thresholdFactor )
+void GMSMatcherImpl::match(const vector<KeyPoint>& keypoints1, const vector<KeyPoint>& keypoints2,
+                           const vector<DMatch>& matches1to2, vector<DMatch>& matchesGMS)
 {
-    GMSMatcher gms(keypoints1, size1, keypoints2, size2, matches1to2, thresholdFactor);
-    vector<bool> inlierMask;
-    gms.getInlierMask(inlierMask, withRotation, withScale);
+    CV_INSTRUMENT_REGION();
+
+    const size_t numberMatches = matches1to2.size();
+    const int nScales = mWithScale ? 5 : 1;
+    const int nRotations = mWithRotation ? 8 : 1;
+    const int nHypotheses = nScales * nRotations;
+
+    // Cells of the normalized points, points in range (0 - 1)
+    for (int gridType = 0; gridType < 4; gridType++)
+        mLeftCells[gridType].resize(numberMatches);
+    for (int scale = 0; scale < nScales; scale++)
+        mRightCells[scale].resize(numberMatches);
+
+    for (size_t i = 0; i < numberMatches; i++)
+    {
+        const Point2f& kp1 = keypoints1[matches1to2[i].queryIdx].pt;
+        const Point2f& kp2 = keypoints2[matches1to2[i].trainIdx].pt;
+        const Point2f lp(kp1.x / mSize1.width, kp1.y / mSize1.height);
+        const Point2f rp(kp2.x / mSize2.width, kp2.y / mSize2.height);
+
+        for (int gridType = 0; gridType < 4; gridType++)
+            mLeftCells[gridType][i] = getGridIndexLeft(lp, gridType + 1);
+        for (int scale = 0; scale < nScales; scale++)
+            mRightCells[scale][i] = getGridIndexRight(rp, scale);
+    }
+
+    // Hypothesis h has scale h / nRotations and rotation type h % nRotations + 1
+    vector<vector<uchar> > inlierMasks(nHypotheses);
+    vector<int> numberInliers(nHypotheses, -1);
+
+    if (mWorkspaces.empty())
+        mWorkspaces.resize(1);
+
+    int first = 0;
+    if (mEarlyStopRatio > 0 && nHypotheses > 1)
+    {
+        // the images are often related by a small motion, skip the other
+        // hypotheses when the identity keeps enough matches already
+        numberInliers[0] = run(0, 1, mWorkspaces[0], inlierMasks[0]);
+        if (numberInliers[0] >= mEarlyStopRatio * numberMatches)
+            first = nHypotheses;
+        else
+            first = 1;
+    }
+
+    if (first < nHypotheses)
+    {
+        const int nstripes = std::max(1, std::min(getNumThreads(), nHypotheses - first));
+        if ((int)mWorkspaces.size() < nstripes)
+            mWorkspaces.resize(nstripes);
+
+        // every stripe owns a workspace and verifies every nstripes-th hypothesis
+        parallel_for_(Range(0, nstripes), [&](const Range& range)
+        {
+            for (int s = range.start; s < range.end; s++)
+                for (int h = first + s; h < nHypotheses; h += nstripes)
+                    numberInliers[h] = run(h / nRotations, h % nRotations + 1, mWorkspaces[s], inlierMasks[h]);
+        }, nstripes);
+    }
+
+    // the first hypothesis with the most inliers wins
+    int best = -1, maxInlier = 0;
+    for (int h = 0; h < nHypotheses; h++)
+    {
+        if (numberInliers[h] > maxInlier)
+        {
+            best = h;
+            maxInlier = numberInliers[h];
+        }
+    }
 
     matchesGMS.clear();
+    if (best < 0)
+        return;
+
+    const vector<uchar>& inlierMask = inlierMasks[best];
     for (size_t i = 0; i < inlierMask.size(); i++) {
         if (inlierMask[i])
             matchesGMS.push_back(matches1to2[i]);
     }
 }
 
+Ptr<GMSMatcher> GMSMatcher::create(const Size& size1, const Size& size2, const bool withRotation, const bool withScale,
+                                   const double thresholdFactor)
+{
+    return makePtr<GMSMatcherImpl>(size1, size2, withRotation, withScale, thresholdFactor);
+}
+
+void matchGMS( const Size& size1, const Size& size2, const vector<KeyPoint>& keypoints1, const vector<KeyPoint>& keypoints2,
+               const vector<DMatch>& matches1to2, vector<DMatch>& matchesGMS, const bool withRotation, const bool withScale,
+               const double thresholdFactor )
+{
+    GMSMatcherImpl gms(size1, size2, withRotation, withScale, thresholdFactor);
+    gms.match(keypoints1, keypoints2, matches1to2, matchesGMS);
+}
+
 } //namespace xfeatures2d
 } //namespace cv
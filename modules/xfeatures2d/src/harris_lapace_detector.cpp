@@ -391,6 +391,8 @@ void HarrisLaplaceFeatureDetector_Impl::write (FileStorage& fs) const
  */
 void HarrisLaplaceFeatureDetector_Impl::detect(InputArray img, std::vector<KeyPoint>& keypoints, InputArray msk )
 {
+    CV_INSTRUMENT_REGION();
+
     Mat image = img.getMat();
     if( image.empty() )
     {
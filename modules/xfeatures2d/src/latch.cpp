@@ -493,6 +493,8 @@ namespace cv
             std::vector<KeyPoint>& keypoints,
             OutputArray _descriptors)
         {
+            CV_INSTRUMENT_REGION();
+
             Mat image = _image.getMat();
 
             if ( image.empty() )
@@ -100,6 +100,8 @@ namespace cv {
         // gliese581h suggested filling a cv::Mat with descriptors to enable BFmatcher compatibility
         // speed-ups and enhancements by gliese581h
         void LUCIDImpl::compute(InputArray _src, std::vector<KeyPoint> &keypoints, OutputArray _desc) {
+            CV_INSTRUMENT_REGION();
+
             if (_src.empty()) return;
             CV_Assert(_src.depth() == CV_8U);
             cv::Mat src_input;
@@ -56,6 +56,7 @@ University of Bologna, Open Perception
 
 #include "precomp.hpp"
 #include "msd_pyramid.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include <limits>
 
 namespace cv
@@ -71,46 +72,30 @@ namespace cv
         {
         public:
 
-            // Multi-threaded contextualSelfDissimilarity method
+            // Multi-threaded contextualSelfDissimilarity method, the rows of all the pyramid levels
+            // are split in bands which are processed concurrently
             struct MSDSelfDissimilarityScan : ParallelLoopBody
             {
 
-                MSDSelfDissimilarityScan(MSDDetector_Impl& _detector, std::vector< std::vector<float> >* _saliency, cv::Mat& _img, int _level, int _border, int _split)
+                MSDSelfDissimilarityScan(const MSDDetector_Impl& _detector, std::vector< std::vector<float> >* _saliency,
+                                         const std::vector<cv::Mat>& _scaleSpace, const std::vector<cv::Vec3i>& _bands)
+                    : detector(&_detector), saliency(_saliency), scaleSpace(&_scaleSpace), bands(&_bands)
                 {
-                    detector = &_detector;
-                    saliency = _saliency;
-                    img = &_img;
-                    split = _split;
-                    level = _level;
-                    border = _border;
-                    int w = img->cols - border * 2;
-                    chunkSize = w / split;
-                    remains = w - chunkSize*split;
                 }
 
                 void operator()(const Range& range) const CV_OVERRIDE
                 {
                     for (int i = range.start; i < range.end; i++)
                     {
-                        int start = border + i*chunkSize;
-                        int end = border + (i + 1) * chunkSize;
-                        if (remains > 0)
-                            if (i == split - 1)
-                            {
-                                end = img->cols - border;
-                            }
-                        detector->contextualSelfDissimilarity(*img, start, end, &saliency->at(level)[0]);
+                        const cv::Vec3i& band = (*bands)[i];
+                        detector->contextualSelfDissimilarity((*scaleSpace)[band[0]], band[1], band[2], &saliency->at(band[0])[0]);
                     }
                 }
 
-                MSDDetector_Impl* detector;
+                const MSDDetector_Impl* detector;
                 std::vector< std::vector<float> >* saliency;
-                cv::Mat* img;
-                int level;
-                int split;
-                int border;
-                int chunkSize;
-                int remains;
+                const std::vector<cv::Mat>* scaleSpace;
+                const std::vector<cv::Vec3i>* bands;
             };
 
             /**
@@ -166,11 +151,15 @@ namespace cv
                     fill(saliency[r].begin(), saliency[r].end(), 0.0f);
                 }
 
+                // bands of rows (level, first row, last row + 1) of all the levels
+                const int bandRows = 32;
+                std::vector<cv::Vec3i> bands;
                 for (int r = 0; r < m_cur_n_scales; r++)
                 {
-                    int steps = cv::getNumThreads();
-                    parallel_for_(Range(0, steps), MSDSelfDissimilarityScan((*this), &saliency, m_scaleSpace[r], r, border, steps));
+                    for (int y = border; y < m_scaleSpace[r].rows - border; y += bandRows)
+                        bands.push_back(cv::Vec3i(r, y, std::min(y + bandRows, m_scaleSpace[r].rows - border)));
                 }
+                parallel_for_(Range(0, (int)bands.size()), MSDSelfDissimilarityScan((*this), &saliency, m_scaleSpace, bands));
 
                 nonMaximaSuppression(saliency, keypoints);
 
@@ -215,29 +204,15 @@ namespace cv
             cv::Mat m_mask;
 
             /**
-             * Computes the normalized average value of input vector
-             * @param minVals input vector
-             * @param den normalization factor (pre-multiplied by the number of elements of the input vector, assumed constant)
-             * @return normalized average value
-             */
-            inline float computeAvgDistance(std::vector<int> &minVals, int den)
-            {
-                float avg_dist = 0.0f;
-                for (unsigned int i = 0; i < minVals.size(); i++)
-                    avg_dist += minVals[i];
-
-                avg_dist /= den;
-                return avg_dist;
-            }
-
-            /**
-             * Computer the Contextual Self-Dissimilarity (CSD, [1]) for a specific range of image pixels (row-wise)
+             * Computer the Contextual Self-Dissimilarity (CSD, [1]) for a specific range of image rows.
+             * The patch distances are computed for one search offset at a time over the whole range,
+             * as box sums of the squared differences between the image and its shifted copy.
              * @param img input image
-             * @param xmin left-most range limit for the image pixels being processed
-             * @param xmax right-most range limit for the image pixels being processed
+             * @param ymin top-most range limit for the image pixels being processed
+             * @param ymax bottom-most range limit for the image pixels being processed
              * @param saliency output array being filled with the CSD value computed at each input pixel
              */
-            void contextualSelfDissimilarity(cv::Mat &img, int xmin, int xmax, float* saliency);
+            void contextualSelfDissimilarity(const cv::Mat &img, int ymin, int ymax, float* saliency) const;
 
             /**
              * Associates a canonical orientation (computed as in [1]) to each extracted key-point
@@ -319,206 +294,142 @@ namespace cv
             return true;
         }
 
-        void MSDDetector_Impl::contextualSelfDissimilarity(cv::Mat &img, int xmin, int xmax, float* saliency)
+        /**
+         * Adds the squared differences between the pixels of row0 and row1 to sums and
+         * subtracts the ones between the pixels of sub0 and sub1 (if not null)
+         */
+        static void accumulateSquaredDiff(const uchar* row0, const uchar* row1, const uchar* sub0, const uchar* sub1, int* sums, int n)
         {
+            int x = 0;
+#if CV_SIMD128
+            for (; x <= n - 8; x += 8)
+            {
+                v_int16x8 d = v_reinterpret_as_s16(v_load_expand(row0 + x)) - v_reinterpret_as_s16(v_load_expand(row1 + x));
+                v_int32x4 sq0, sq1;
+                v_mul_expand(d, d, sq0, sq1);
+                if (sub0)
+                {
+                    v_int16x8 ds = v_reinterpret_as_s16(v_load_expand(sub0 + x)) - v_reinterpret_as_s16(v_load_expand(sub1 + x));
+                    v_int32x4 sqs0, sqs1;
+                    v_mul_expand(ds, ds, sqs0, sqs1);
+                    sq0 -= sqs0;
+                    sq1 -= sqs1;
+                }
+                v_store(sums + x, v_load(sums + x) + sq0);
+                v_store(sums + x + 4, v_load(sums + x + 4) + sq1);
+            }
+#endif
+            for (; x < n; x++)
+            {
+                int temp = row0[x] - row1[x];
+                sums[x] += temp * temp;
+                if (sub0)
+                {
+                    temp = sub0[x] - sub1[x];
+                    sums[x] -= temp * temp;
+                }
+            }
+        }
+
+        void MSDDetector_Impl::contextualSelfDissimilarity(const cv::Mat &img, int ymin, int ymax, float* saliency) const
+        {
+            CV_Assert(img.type() == CV_8UC1);
+
             int r_s = m_patch_radius;
             int r_b = m_search_area_radius;
             int k = m_kNN;
 
             int w = img.cols;
-            int h = img.rows;
 
             int side_s = 2 * r_s + 1;
-            int side_b = 2 * r_b + 1;
             int border = r_s + r_b;
-            int temp;
             int den = side_s * side_s * k;
 
-            std::vector<int> minVals(k);
-            int *acc = new int[side_b * side_b];
-            int **vCol = new int *[w];
-            for (int i = 0; i < w; i++)
-                vCol[i] = new int[side_b * side_b];
+            int xmin = border, xmax = w - border;
+            int cols = xmax - xmin, rows = ymax - ymin;
+            if (cols <= 0 || rows <= 0)
+                return;
 
-            //first position
-            int x = xmin;
-            int y = border;
+            // k smallest patch distances of every pixel, sorted, one plane per rank
+            int planeSize = rows * cols;
+            std::vector<int> minVals(k * planeSize, std::numeric_limits<int>::max());
 
-            int ctrInd = 0;
-            for (int kk = 0; kk < k; kk++)
-                minVals[kk] = std::numeric_limits<int>::max();
+            // sums of the squared differences over a patch column, for the image columns
+            // [xmin - r_s, xmax + r_s), and over a whole patch for the processed pixels
+            int sumCols = cols + 2 * r_s;
+            std::vector<int> vCol(sumCols), acc(cols);
 
-            for (int j = y - r_b; j <= y + r_b; j++)
+            for (int dv = -r_b; dv <= r_b; dv++)
             {
-
-                for (int i = x - r_b; i <= x + r_b; i++)
+                for (int du = -r_b; du <= r_b; du++)
                 {
-                    if (j == y && i == x)
+                    if (du == 0 && dv == 0)
                         continue;
 
-                    acc[ctrInd] = 0;
-                    for (int u = -r_s; u <= r_s; u++)
+                    for (int y = ymin; y < ymax; y++)
                     {
-                        vCol[x + u][ctrInd] = 0;
-                        for (int v = -r_s; v <= r_s; v++)
+                        if (y == ymin)
                         {
-
-                            temp = img.at<unsigned char>(j + v, i + u) - img.at<unsigned char>(y + v, x + u);
-                            vCol[x + u][ctrInd] += (temp * temp);
+                            std::fill(vCol.begin(), vCol.end(), 0);
+                            for (int v = -r_s; v <= r_s; v++)
+                                accumulateSquaredDiff(img.ptr<uchar>(y + v + dv) + xmin - r_s + du, img.ptr<uchar>(y + v) + xmin - r_s,
+                                                      NULL, NULL, &vCol[0], sumCols);
                         }
-                        acc[ctrInd] += vCol[x + u][ctrInd];
-                    }
-
-                    if (acc[ctrInd] < minVals[k - 1])
-                    {
-                        minVals[k - 1] = acc[ctrInd];
-
-                        for (int kk = k - 2; kk >= 0; kk--)
+                        else
                         {
-                            if (minVals[kk] > minVals[kk + 1])
-                            {
-                                std::swap(minVals[kk], minVals[kk + 1]);
-                            } else
-                                break;
+                            accumulateSquaredDiff(img.ptr<uchar>(y + r_s + dv) + xmin - r_s + du, img.ptr<uchar>(y + r_s) + xmin - r_s,
+                                                  img.ptr<uchar>(y - r_s - 1 + dv) + xmin - r_s + du, img.ptr<uchar>(y - r_s - 1) + xmin - r_s,
+                                                  &vCol[0], sumCols);
                         }
-                    }
 
-                    ctrInd++;
-                }
-            }
-            saliency[y * w + x] = computeAvgDistance(minVals, den);
-
-            for (x = xmin + 1; x < xmax; x++)
-            {
-                ctrInd = 0;
-                for (int kk = 0; kk < k; kk++)
-                    minVals[kk] = std::numeric_limits<int>::max();
-
-                for (int j = y - r_b; j <= y + r_b; j++)
-                {
-                    for (int i = x - r_b; i <= x + r_b; i++)
-                    {
-                        if (j == y && i == x)
-                            continue;
-
-                        vCol[x + r_s][ctrInd] = 0;
-                        for (int v = -r_s; v <= r_s; v++)
+                        int x = 0;
+                        int* mins = &minVals[(y - ymin) * cols];
+#if CV_SIMD128
+                        for (; x <= cols - 4; x += 4)
                         {
-                            temp = img.at<unsigned char>(j + v, i + r_s) - img.at<unsigned char>(y + v, x + r_s);
-                            vCol[x + r_s][ctrInd] += (temp * temp);
-                        }
+                            v_int32x4 a = v_load(&vCol[x]);
+                            for (int u = 1; u < side_s; u++)
+                                a += v_load(&vCol[x + u]);
 
-                        acc[ctrInd] = acc[ctrInd] + vCol[x + r_s][ctrInd] - vCol[x - r_s - 1][ctrInd];
-
-                        if (acc[ctrInd] < minVals[k - 1])
-                        {
-                            minVals[k - 1] = acc[ctrInd];
-                            for (int kk = k - 2; kk >= 0; kk--)
+                            // sorted insertion of the new distance
+                            for (int kk = 0; kk < k; kk++)
                             {
-                                if (minVals[kk] > minVals[kk + 1])
-                                {
-                                    std::swap(minVals[kk], minVals[kk + 1]);
-                                } else
-                                    break;
+                                v_int32x4 m = v_load(mins + kk * planeSize + x);
+                                v_store(mins + kk * planeSize + x, v_min(m, a));
+                                a = v_max(m, a);
                             }
                         }
-
-                        ctrInd++;
-                    }
-                }
-                saliency[y * w + x] = computeAvgDistance(minVals, den);
-            }
-
-            for (y = border + 1; y < h - border; y++)
-            {
-                ctrInd = 0;
-                for (int kk = 0; kk < k; kk++)
-                    minVals[kk] = std::numeric_limits<int>::max();
-                x = xmin;
-
-                for (int j = y - r_b; j <= y + r_b; j++)
-                {
-                    for (int i = x - r_b; i <= x + r_b; i++)
-                    {
-                        if (j == y && i == x)
-                            continue;
-
-                        acc[ctrInd] = 0;
-                        for (int u = -r_s; u <= r_s; u++)
-                        {
-                            temp = img.at<unsigned char>(j + r_s, i + u) - img.at<unsigned char>(y + r_s, x + u);
-                            vCol[x + u][ctrInd] += (temp * temp);
-
-                            temp = img.at<unsigned char>(j - r_s - 1, i + u) - img.at<unsigned char>(y - r_s - 1, x + u);
-                            vCol[x + u][ctrInd] -= (temp * temp);
-
-                            acc[ctrInd] += vCol[x + u][ctrInd];
-                        }
-
-                        if (acc[ctrInd] < minVals[k - 1])
+#endif
+                        for (; x < cols; x++)
                         {
-                            minVals[k - 1] = acc[ctrInd];
+                            int a = vCol[x];
+                            for (int u = 1; u < side_s; u++)
+                                a += vCol[x + u];
 
-                            for (int kk = k - 2; kk >= 0; kk--)
+                            for (int kk = 0; kk < k; kk++)
                             {
-                                if (minVals[kk] > minVals[kk + 1])
-                                {
-                                    std::swap(minVals[kk], minVals[kk + 1]);
-                                } else
-                                    break;
+                                int m = mins[kk * planeSize + x];
+                                mins[kk * planeSize + x] = std::min(m, a);
+                                a = std::max(m, a);
                             }
                         }
-
-                        ctrInd++;
                     }
                 }
-                saliency[y * w + x] = computeAvgDistance(minVals, den);
+            }
 
-                for (x = xmin + 1; x < xmax; x++)
+            for (int y = ymin; y < ymax; y++)
+            {
+                const int* mins = &minVals[(y - ymin) * cols];
+                for (int x = 0; x < cols; x++)
                 {
-                    ctrInd = 0;
+                    float avg_dist = 0.0f;
                     for (int kk = 0; kk < k; kk++)
-                        minVals[kk] = std::numeric_limits<int>::max();
-
-                    for (int j = y - r_b; j <= y + r_b; j++)
-                    {
-                        for (int i = x - r_b; i <= x + r_b; i++)
-                        {
-                            if (j == y && i == x)
-                                continue;
-
-                            temp = img.at<unsigned char>(j + r_s, i + r_s) - img.at<unsigned char>(y + r_s, x + r_s);
-                            vCol[x + r_s][ctrInd] += (temp * temp);
+                        avg_dist += mins[kk * planeSize + x];
 
-                            temp = img.at<unsigned char>(j - r_s - 1, i + r_s) - img.at<unsigned char>(y - r_s - 1, x + r_s);
-                            vCol[x + r_s][ctrInd] -= (temp * temp);
-
-                            acc[ctrInd] = acc[ctrInd] + vCol[x + r_s][ctrInd] - vCol[x - r_s - 1][ctrInd];
-
-                            if (acc[ctrInd] < minVals[k - 1])
-                            {
-                                minVals[k - 1] = acc[ctrInd];
-
-                                for (int kk = k - 2; kk >= 0; kk--)
-                                {
-                                    if (minVals[kk] > minVals[kk + 1])
-                                    {
-                                        std::swap(minVals[kk], minVals[kk + 1]);
-                                    } else
-                                        break;
-                                }
-                            }
-                            ctrInd++;
-                        }
-                    }
-                    saliency[y * w + x] = computeAvgDistance(minVals, den);
+                    avg_dist /= den;
+                    saliency[y * w + x + xmin] = avg_dist;
                 }
             }
-
-            for (int i = 0; i < w; i++)
-                delete[] vCol[i];
-            delete[] vCol;
-            delete[] acc;
         }
 
         float MSDDetector_Impl::computeOrientation(cv::Mat &img, int x, int y, std::vector<cv::Point2f> circle)
@@ -57,6 +57,7 @@ References:
     ACM, 2010.
 */
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include "pct_signatures/constants.hpp"
 #include "pct_signatures/similarity.hpp"
@@ -67,6 +68,17 @@ namespace cv
     {
         namespace pct_signatures
         {
+            /**
+            * @brief Signature with its centroids also stored by columns (weights, then each dimension),
+            *       so that several centroids are compared with one vector operation.
+            */
+            struct SignatureColumns
+            {
+                Mat signature;
+                Mat columns;    // SIGNATURE_DIMENSION x signature.rows
+            };
+
+
             class PCTSignaturesSQFD_Impl : public PCTSignaturesSQFD
             {
             public:
@@ -91,6 +103,11 @@ namespace cv
                     const std::vector<Mat>& imageSignatures,
                     std::vector<float>& distances) const CV_OVERRIDE;
 
+                void computeQuadraticFormDistanceMatrix(
+                    const std::vector<Mat>& querySignatures,
+                    const std::vector<Mat>& imageSignatures,
+                    OutputArray distances) const CV_OVERRIDE;
+
 
             private:
                 int mDistanceFunction;
@@ -99,55 +116,37 @@ namespace cv
 
                 float computePartialSQFD(
                     const Mat& signature0,
-                    const Mat& signature1) const;
+                    const SignatureColumns& signature1) const;
+
+                /**
+                * @brief Distances of all signatures of the first list to all signatures of the second one.
+                */
+                void computeDistanceMatrix(
+                    const std::vector<Mat>& signatures0,
+                    const std::vector<Mat>& signatures1,
+                    Mat& distances) const;
 
             };
 
 
-            /**
-            * @brief Class implementing parallel computing of SQFD distance for multiple images.
-            */
-            class Parallel_computeSQFDs : public ParallelLoopBody
+            static void checkSignature(const Mat& signature, int id)
             {
-            private:
-                const PCTSignaturesSQFD* mPctSignaturesSQFDAlgorithm;
-                const Mat* mSourceSignature;
-                const std::vector<Mat>* mImageSignatures;
-                std::vector<float>* mDistances;
-
-            public:
-                Parallel_computeSQFDs(
-                    const PCTSignaturesSQFD* pctSignaturesSQFDAlgorithm,
-                    const Mat* sourceSignature,
-                    const std::vector<Mat>* imageSignatures,
-                    std::vector<float>* distances)
-                    : mPctSignaturesSQFDAlgorithm(pctSignaturesSQFDAlgorithm),
-                    mSourceSignature(sourceSignature),
-                    mImageSignatures(imageSignatures),
-                    mDistances(distances)
+                if (signature.empty())
                 {
-                    mDistances->resize(imageSignatures->size());
+                    CV_Error_(Error::StsBadArg, ("Signature ID: %d is empty!", id));
                 }
-
-                void operator()(const Range& range) const CV_OVERRIDE
+                if (signature.cols != SIGNATURE_DIMENSION || signature.type() != CV_32FC1)
                 {
-                    if (mSourceSignature->empty())
-                    {
-                        CV_Error(Error::StsBadArg, "Source signature is empty!");
-                    }
+                    CV_Error_(Error::StsBadArg, ("Signature dimension must be %d!", SIGNATURE_DIMENSION));
+                }
+            }
 
-                    for (int i = range.start; i < range.end; i++)
-                    {
-                        if (mImageSignatures[i].empty())
-                        {
-                            CV_Error_(Error::StsBadArg, ("Signature ID: %d is empty!", i));
-                        }
 
-                        (*mDistances)[i] = mPctSignaturesSQFDAlgorithm->computeQuadraticFormDistance(
-                            *mSourceSignature, (*mImageSignatures)[i]);
-                    }
-                }
-            };
+            static void transposeSignature(const Mat& signature, SignatureColumns& result)
+            {
+                result.signature = signature;
+                transpose(signature, result.columns);
+            }
 
 
             float PCTSignaturesSQFD_Impl::computeQuadraticFormDistance(
@@ -173,11 +172,15 @@ namespace cv
                     CV_Error(Error::StsBadArg, "Signature count must be greater than 0!");
                 }
 
+                SignatureColumns columns0, columns1;
+                transposeSignature(signature0, columns0);
+                transposeSignature(signature1, columns1);
+
                 // compute sqfd
                 float result = 0;
-                result += computePartialSQFD(signature0, signature0);
-                result += computePartialSQFD(signature1, signature1);
-                result -= computePartialSQFD(signature0, signature1) * 2;
+                result += computePartialSQFD(signature0, columns0);
+                result += computePartialSQFD(signature1, columns1);
+                result -= computePartialSQFD(signature0, columns1) * 2;
 
                 return sqrt(result);
             }
@@ -187,21 +190,206 @@ namespace cv
                       const std::vector<Mat>& imageSignatures,
                       std::vector<float>& distances) const
             {
-                parallel_for_(Range(0, (int)imageSignatures.size()),
-                    Parallel_computeSQFDs(this, &sourceSignature, &imageSignatures, &distances));
+                if (sourceSignature.empty())
+                {
+                    CV_Error(Error::StsBadArg, "Source signature is empty!");
+                }
+
+                Mat distanceMatrix;
+                computeDistanceMatrix(std::vector<Mat>(1, sourceSignature), imageSignatures, distanceMatrix);
+                distanceMatrix.copyTo(distances);
             }
 
+            void PCTSignaturesSQFD_Impl::computeQuadraticFormDistanceMatrix(
+                      const std::vector<Mat>& querySignatures,
+                      const std::vector<Mat>& imageSignatures,
+                      OutputArray _distances) const
+            {
+                Mat distances;
+                computeDistanceMatrix(querySignatures, imageSignatures, distances);
+                distances.copyTo(_distances);
+            }
+
+            void PCTSignaturesSQFD_Impl::computeDistanceMatrix(
+                      const std::vector<Mat>& signatures0,
+                      const std::vector<Mat>& signatures1,
+                      Mat& distances) const
+            {
+                const int count0 = (int)signatures0.size();
+                const int count1 = (int)signatures1.size();
+                distances.create(count0, count1, CV_32FC1);
+                if (count0 == 0 || count1 == 0)
+                {
+                    return;
+                }
+
+                for (int i = 0; i < count0; i++)
+                {
+                    checkSignature(signatures0[i], i);
+                }
+                for (int i = 0; i < count1; i++)
+                {
+                    checkSignature(signatures1[i], i);
+                }
+
+                // the self similarity of every signature is computed only once
+                std::vector<SignatureColumns> columns1(count1);
+                std::vector<float> partial0(count0), partial1(count1);
+                parallel_for_(Range(0, count0 + count1), [&](const Range& range)
+                {
+                    for (int i = range.start; i < range.end; i++)
+                    {
+                        if (i < count0)
+                        {
+                            SignatureColumns columns0;
+                            transposeSignature(signatures0[i], columns0);
+                            partial0[i] = computePartialSQFD(signatures0[i], columns0);
+                        }
+                        else
+                        {
+                            const int j = i - count0;
+                            transposeSignature(signatures1[j], columns1[j]);
+                            partial1[j] = computePartialSQFD(signatures1[j], columns1[j]);
+                        }
+                    }
+                });
+
+                // blocks of image signatures are compared to all the query signatures while they are in cache
+                const int blockSize = 64;
+                const int blockCount = (count1 + blockSize - 1) / blockSize;
+                parallel_for_(Range(0, blockCount * count0), [&](const Range& range)
+                {
+                    for (int task = range.start; task < range.end; task++)
+                    {
+                        const int block = task / count0, i = task % count0;
+                        float* dst = distances.ptr<float>(i);
+                        for (int j = block * blockSize; j < std::min((block + 1) * blockSize, count1); j++)
+                        {
+                            float result = 0;
+                            result += partial0[i];
+                            result += partial1[j];
+                            result -= computePartialSQFD(signatures0[i], columns1[j]) * 2;
+                            dst[j] = sqrt(result);
+                        }
+                    }
+                });
+            }
+
+#if CV_SIMD128
+            /**
+            * @brief Distances of a centroid to 4 centroids stored by columns,
+            *       the same operations as computeDistance are used.
+            */
+            static inline v_float32x4 computeDistance4(
+                const int distanceFunction,
+                const float* point, const float* columns, size_t step, int j)
+            {
+                v_float32x4 result = v_setzero_f32();
+                for (int d = 1; d < SIGNATURE_DIMENSION; ++d)
+                {
+                    v_float32x4 difference = v_setall_f32(point[d]) - v_load(columns + d * step + j);
+                    switch (distanceFunction)
+                    {
+                    case PCTSignatures::L0_25:
+                        result += v_sqrt(v_sqrt(v_abs(difference)));
+                        break;
+                    case PCTSignatures::L0_5:
+                        result += v_sqrt(v_abs(difference));
+                        break;
+                    case PCTSignatures::L1:
+                        result += v_abs(difference);
+                        break;
+                    case PCTSignatures::L2:
+                    case PCTSignatures::L2SQUARED:
+                        result += difference * difference;
+                        break;
+                    case PCTSignatures::L5:
+                        result += v_abs(difference) * difference * difference * difference * difference;
+                        break;
+                    case PCTSignatures::L_INFINITY:
+                        result = v_max(result, difference);
+                        break;
+                    }
+                }
+
+                switch (distanceFunction)
+                {
+                case PCTSignatures::L0_25:
+                    result *= result;
+                    return result * result;
+                case PCTSignatures::L0_5:
+                    return result * result;
+                case PCTSignatures::L2:
+                    return v_sqrt(result);
+                case PCTSignatures::L5:
+                {
+                    float r[4];
+                    v_store(r, result);
+                    for (int k = 0; k < 4; k++)
+                    {
+                        r[k] = std::pow(r[k], (float)0.2);
+                    }
+                    return v_load(r);
+                }
+                }
+                return result;
+            }
+
+            static inline v_float32x4 computeSimilarity4(
+                const int similarity,
+                const float similarityParameter,
+                const v_float32x4& distance)
+            {
+                switch (similarity)
+                {
+                case PCTSignatures::MINUS:
+                    return v_setzero_f32() - distance;
+                case PCTSignatures::GAUSSIAN:
+                {
+                    float r[4];
+                    v_store(r, v_setall_f32(-similarityParameter) * distance * distance);
+                    for (int k = 0; k < 4; k++)
+                    {
+                        r[k] = exp(r[k]);
+                    }
+                    return v_load(r);
+                }
+                case PCTSignatures::HEURISTIC:
+                    return v_setall_f32(1.f) / (v_setall_f32(similarityParameter) + distance);
+                }
+                CV_Error(Error::StsNotImplemented, "Similarity function not implemented!");
+            }
+#endif
+
             float PCTSignaturesSQFD_Impl::computePartialSQFD(
                       const Mat& signature0,
-                      const Mat& signature1) const
+                      const SignatureColumns& signature1) const
             {
+                const Mat& columns = signature1.columns;
+                const int count1 = columns.cols;
+                const float* weights1 = columns.ptr<float>(WEIGHT_IDX);
+
                 float result = 0;
                 for (int i = 0; i < signature0.rows; i++)
                 {
-                    for (int j = 0; j < signature1.rows; j++)
+                    const float* point = signature0.ptr<float>(i);
+                    int j = 0;
+#if CV_SIMD128
+                    const size_t step = columns.step1();
+                    const v_float32x4 weight0 = v_setall_f32(point[WEIGHT_IDX]);
+                    v_float32x4 sum = v_setzero_f32();
+                    for (; j <= count1 - 4; j += 4)
+                    {
+                        v_float32x4 distance = computeDistance4(mDistanceFunction, point, columns.ptr<float>(), step, j);
+                        sum += weight0 * v_load(weights1 + j)
+                            * computeSimilarity4(mSimilarityFunction, mSimilarityParameter, distance);
+                    }
+                    result += v_reduce_sum(sum);
+#endif
+                    for (; j < count1; j++)
                     {
-                        result += signature0.at<float>(i, WEIGHT_IDX) * signature1.at<float>(j, WEIGHT_IDX)
-                            * computeSimilarity(mDistanceFunction, mSimilarityFunction, mSimilarityParameter, signature0, i, signature1, j);
+                        result += point[WEIGHT_IDX] * weights1[j]
+                            * computeSimilarity(mDistanceFunction, mSimilarityFunction, mSimilarityParameter, signature0, i, signature1.signature, j);
                     }
                 }
                 return result;
@@ -489,6 +489,8 @@ StarDetectorImpl::StarDetectorImpl(int _maxSize, int _responseThreshold,
 
 void StarDetectorImpl::detect( InputArray _image, std::vector<KeyPoint>& keypoints, InputArray _mask )
 {
+    CV_INSTRUMENT_REGION();
+
     Mat image = _image.getMat(), mask = _mask.getMat(), grayImage = image;
     if( image.empty() )
     {
@@ -109,6 +109,7 @@ Modifications by Ian Mahon
 */
 #include "precomp.hpp"
 #include "surf.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -147,6 +148,34 @@ inline float calcHaarPattern( const int* origin, const SurfHF* f, int n )
     return (float)d;
 }
 
+#if CV_SIMD128_64F
+// loads the integral image values of 4 consecutive samples taken every sampleStep (1 or 2) pixels
+inline v_int32x4 loadSurfSamples( const int* ptr, int sampleStep )
+{
+    if( sampleStep == 1 )
+        return v_load( ptr );
+    v_int32x4 even, odd;
+    v_load_deinterleave( ptr, even, odd );
+    return even;
+}
+
+// calcHaarPattern for 4 consecutive samples; the products are accumulated in double
+// like the scalar version, so that the results are bit-exact
+inline v_float32x4 calcHaarPattern4( const int* origin, int sampleStep, const SurfHF* f, int n )
+{
+    v_float64x2 d0 = v_setzero_f64(), d1 = v_setzero_f64();
+    for( int k = 0; k < n; k++ )
+    {
+        v_int32x4 v = loadSurfSamples( origin + f[k].p0, sampleStep ) + loadSurfSamples( origin + f[k].p3, sampleStep ) -
+                      loadSurfSamples( origin + f[k].p1, sampleStep ) - loadSurfSamples( origin + f[k].p2, sampleStep );
+        v_float32x4 p = v_cvt_f32( v ) * v_setall_f32( f[k].w );
+        d0 += v_cvt_f64( p );
+        d1 += v_cvt_f64_high( p );
+    }
+    return v_cvt_f32( d0, d1 );
+}
+#endif
+
 static void
 resizeHaarPattern( const int src[][5], SurfHF* dst, int n, int oldSize, int newSize, int widthStep )
 {
@@ -198,7 +227,25 @@ static void calcLayerDetAndTrace( const Mat& sum, int size, int sampleStep,
         const int* sum_ptr = sum.ptr<int>(i*sampleStep);
         float* det_ptr = &det.at<float>(i+margin, margin);
         float* trace_ptr = &trace.at<float>(i+margin, margin);
-        for( int j = 0; j < samples_j; j++ )
+        int j = 0;
+#if CV_SIMD128_64F
+        if( sampleStep <= 2 )
+        {
+            const v_float32x4 k081 = v_setall_f32( 0.81f );
+            // with sampleStep 2 the deinterleaving loads read one value past the 4th sample,
+            // make sure a 5th sample exists
+            for( ; j + 4 + (sampleStep - 1) <= samples_j; j += 4 )
+            {
+                v_float32x4 dx  = calcHaarPattern4( sum_ptr, sampleStep, Dx , 3 );
+                v_float32x4 dy  = calcHaarPattern4( sum_ptr, sampleStep, Dy , 3 );
+                v_float32x4 dxy = calcHaarPattern4( sum_ptr, sampleStep, Dxy, 4 );
+                sum_ptr += 4*sampleStep;
+                v_store( det_ptr + j, dx*dy - k081*dxy*dxy );
+                v_store( trace_ptr + j, dx + dy );
+            }
+        }
+#endif
+        for( ; j < samples_j; j++ )
         {
             float dx  = calcHaarPattern( sum_ptr, Dx , 3 );
             float dy  = calcHaarPattern( sum_ptr, Dy , 3 );
@@ -465,7 +512,8 @@ struct KeypointGreater
 
 
 static void fastHessianDetector( const Mat& sum, const Mat& mask_sum, std::vector<KeyPoint>& keypoints,
-                                 int nOctaves, int nOctaveLayers, float hessianThreshold )
+                                 int nOctaves, int nOctaveLayers, float hessianThreshold,
+                                 std::vector<Mat>& dets, std::vector<Mat>& traces )
 {
     /* Sampling step along image x and y axes at first octave. This is doubled
        for each additional octave. WARNING: Increasing this improves speed,
@@ -475,8 +523,9 @@ static void fastHessianDetector( const Mat& sum, const Mat& mask_sum, std::vecto
     int nTotalLayers = (nOctaveLayers+2)*nOctaves;
     int nMiddleLayers = nOctaveLayers*nOctaves;
 
-    std::vector<Mat> dets(nTotalLayers);
-    std::vector<Mat> traces(nTotalLayers);
+    // layers of a previous call are reused when they have the same size
+    dets.resize(nTotalLayers);
+    traces.resize(nTotalLayers);
     std::vector<int> sizes(nTotalLayers);
     std::vector<int> sampleSteps(nTotalLayers);
     std::vector<int> middleIndices(nMiddleLayers);
@@ -876,6 +925,21 @@ SURF_Impl::SURF_Impl(double _threshold, int _nOctaves, int _nOctaveLayers, bool
     upright = _upright;
     nOctaves = _nOctaves;
     nOctaveLayers = _nOctaveLayers;
+    reuseBuffers = false;
+}
+
+void SURF_Impl::setReuseBuffers(bool reuseBuffers_)
+{
+    reuseBuffers = reuseBuffers_;
+    if( !reuseBuffers )
+    {
+        grayBuf.release();
+        sumBuf.release();
+        mask1Buf.release();
+        msumBuf.release();
+        detsBuf.clear();
+        tracesBuf.clear();
+    }
 }
 
 int SURF_Impl::descriptorSize() const { return extended ? 128 : 64; }
@@ -888,6 +952,8 @@ void SURF_Impl::detectAndCompute(InputArray _img, InputArray _mask,
                       OutputArray _descriptors,
                       bool useProvidedKeypoints)
 {
+    CV_INSTRUMENT_REGION();
+
     int imgtype = _img.type(), imgcn = CV_MAT_CN(imgtype);
     bool doDescriptors = _descriptors.needed();
 
@@ -923,10 +989,19 @@ void SURF_Impl::detectAndCompute(InputArray _img, InputArray _mask,
     }
 #endif // HAVE_OPENCL
 
-    Mat img = _img.getMat(), mask = _mask.getMat(), mask1, sum, msum;
+    Mat img = _img.getMat(), mask = _mask.getMat();
+    Mat localGray, localSum, localMask1, localMsum;
+    std::vector<Mat> localDets, localTraces;
+    Mat& gray = reuseBuffers ? grayBuf : localGray;
+    Mat& sum = reuseBuffers ? sumBuf : localSum;
+    Mat& mask1 = reuseBuffers ? mask1Buf : localMask1;
+    Mat& msum = reuseBuffers ? msumBuf : localMsum;
 
     if( imgcn > 1 )
-        cvtColor(img, img, COLOR_BGR2GRAY);
+    {
+        cvtColor(img, gray, COLOR_BGR2GRAY);
+        img = gray;
+    }
 
     CV_Assert(mask.empty() || (mask.type() == CV_8U && mask.size() == img.size()));
     CV_Assert(hessianThreshold >= 0);
@@ -938,12 +1013,15 @@ void SURF_Impl::detectAndCompute(InputArray _img, InputArray _mask,
     // Compute keypoints only if we are not asked for evaluating the descriptors are some given locations:
     if( !useProvidedKeypoints )
     {
+        Mat maskSum;
         if( !mask.empty() )
         {
             cv::min(mask, 1, mask1);
             integral(mask1, msum, CV_32S);
+            maskSum = msum;
         }
-        fastHessianDetector( sum, msum, keypoints, nOctaves, nOctaveLayers, (float)hessianThreshold );
+        fastHessianDetector( sum, maskSum, keypoints, nOctaves, nOctaveLayers, (float)hessianThreshold,
+                             reuseBuffers ? detsBuf : localDets, reuseBuffers ? tracesBuf : localTraces );
         if (!mask.empty())
         {
             for (size_t i = 0; i < keypoints.size(); )
@@ -57,11 +57,19 @@ public:
     void setUpright(bool upright_) CV_OVERRIDE { upright = upright_; }
     bool getUpright() const CV_OVERRIDE { return upright; }
 
+    void setReuseBuffers(bool reuseBuffers_) CV_OVERRIDE;
+    bool getReuseBuffers() const CV_OVERRIDE { return reuseBuffers; }
+
     double hessianThreshold;
     int nOctaves;
     int nOctaveLayers;
     bool extended;
     bool upright;
+    bool reuseBuffers;
+
+    // buffers kept between calls when reuseBuffers is set
+    Mat grayBuf, sumBuf, mask1Buf, msumBuf;
+    std::vector<Mat> detsBuf, tracesBuf;
 };
 
 #ifdef HAVE_OPENCL
@@ -78,6 +78,23 @@ class TBMR_Impl CV_FINAL : public TBMR
                      OutputArray descriptors,
                      bool useProvidedKeypoints = false) CV_OVERRIDE;
 
+    // Buffers of the construction of one component tree, kept between
+    // calls and only reallocated when the image size grows
+    struct TreeWorkspace
+    {
+        // component tree representation (parent,S): see
+        // https://ieeexplore.ieee.org/document/6850018
+        Mat parent;
+        Mat S;
+        // moments: compound type of: (area, x, y, xy, xx, yy)
+        Mat imaAttributes;
+
+        std::vector<uint> zpar, root, rank, numSons, vecNodes, vecTbmrs;
+        std::vector<uchar> dejaVu, isSeen, isParentofLeaf;
+
+        std::vector<Elliptic_KeyPoint> tbmrs;
+    };
+
     CV_INLINE uint zfindroot(uint *parent, uint p)
     {
         if (parent[p] == p)
@@ -88,28 +105,29 @@ class TBMR_Impl CV_FINAL : public TBMR
 
     // Calculate the Component tree. Based on the order of S, it will be a
     // min or max tree.
-    void calcMinMaxTree(Mat ima)
+    static void calcMinMaxTree(const Mat& ima, TreeWorkspace& ws)
     {
         int rs = ima.rows;
         int cs = ima.cols;
         uint imSize = (uint)rs * cs;
+        const Mat& S = ws.S;
+        Mat& parent = ws.parent;
+        Mat& imaAttributes = ws.imaAttributes;
 
         std::array<int, 4> offsets = {
             -ima.cols, -1, 1, ima.cols
         }; // {-1,0}, {0,-1}, {0,1}, {1,0} yx
         std::array<Vec2i, 4> offsetsv = { Vec2i(0, -1), Vec2i(-1, 0),
                                           Vec2i(1, 0), Vec2i(0, 1) }; //  xy
-        AutoBuffer<uint> zparb(imSize);
-        AutoBuffer<uint> rootb(imSize);
-        AutoBuffer<uint> rankb(imSize);
-        memset(rankb.data(), 0, imSize * sizeof(uint));
-        uint* zpar = zparb.data();
-        uint *root = rootb.data();
-        uint *rank = rankb.data();
-        parent = Mat(rs, cs, CV_32S); // unsigned
-        AutoBuffer<bool> dejaVub(imSize);
-        memset(dejaVub.data(), 0, imSize * sizeof(bool));
-        bool* dejaVu = dejaVub.data();
+        ws.zpar.resize(imSize);
+        ws.root.resize(imSize);
+        ws.rank.assign(imSize, 0);
+        uint* zpar = ws.zpar.data();
+        uint *root = ws.root.data();
+        uint *rank = ws.rank.data();
+        parent.create(rs, cs, CV_32S); // unsigned
+        ws.dejaVu.assign(imSize, 0);
+        uchar* dejaVu = ws.dejaVu.data();
 
         const uint *S_ptr = S.ptr<const uint>();
         uint *parent_ptr = parent.ptr<uint>();
@@ -186,21 +204,25 @@ class TBMR_Impl CV_FINAL : public TBMR
         }
     }
 
-    void calculateTBMRs(const Mat &image, std::vector<Elliptic_KeyPoint> &tbmrs,
-                        const Mat &mask, float scale, int octave)
+    void calculateTBMRs(const Mat &image, TreeWorkspace& ws,
+                        const Mat &mask, float scale, int octave) const
     {
+        std::vector<Elliptic_KeyPoint> &tbmrs = ws.tbmrs;
+        tbmrs.clear();
+
         uint imSize = image.cols * image.rows;
         uint maxArea =
             static_cast<uint>(params.maxAreaRelative * imSize * scale);
         uint minArea = static_cast<uint>(params.minArea * scale);
 
-        if (parent.empty() || parent.size != image.size)
-            parent = Mat(image.rows, image.cols, CV_32S);
+        ws.parent.create(image.rows, image.cols, CV_32S);
+        ws.imaAttributes.create(image.rows, image.cols, CV_32SC(6));
 
-        if (imaAttributes.empty() || imaAttributes.size != image.size)
-            imaAttributes = Mat(image.rows, image.cols, CV_32SC(6));
+        calcMinMaxTree(image, ws);
 
-        calcMinMaxTree(image);
+        const Mat& S = ws.S;
+        Mat& parent = ws.parent;
+        const Mat& imaAttributes = ws.imaAttributes;
 
         const Vec<uint, 6> *imaAttribute =
             imaAttributes.ptr<const Vec<uint, 6>>();
@@ -229,13 +251,11 @@ class TBMR_Impl CV_FINAL : public TBMR
         // as final TBMRs
         //--------------------------------------------------------------------------
 
-        AutoBuffer<uint> numSonsb(imSize);
-        memset(numSonsb.data(), 0, imSize * sizeof(uint));
-        uint* numSons = numSonsb.data();
+        ws.numSons.assign(imSize, 0);
+        uint* numSons = ws.numSons.data();
         uint vecNodesSize = imaAttribute[S_ptr[0]][0];               // area
-        AutoBuffer<uint> vecNodesb(vecNodesSize);
-        memset(vecNodesb.data(), 0, vecNodesSize * sizeof(uint));
-        uint *vecNodes = vecNodesb.data(); // area
+        ws.vecNodes.assign(vecNodesSize, 0);
+        uint *vecNodes = ws.vecNodes.data(); // area
         uint numNodes = 0;
 
         // leaf to root propagation to select the canonized nodes
@@ -250,14 +270,12 @@ class TBMR_Impl CV_FINAL : public TBMR
             }
         }
 
-        AutoBuffer<bool> isSeenb(imSize);
-        memset(isSeenb.data(), 0, imSize * sizeof(bool));
-        bool *isSeen = isSeenb.data();
+        ws.isSeen.assign(imSize, 0);
+        uchar *isSeen = ws.isSeen.data();
 
         // parent of critical leaf node
-        AutoBuffer<bool> isParentofLeafb(imSize);
-        memset(isParentofLeafb.data(), 0, imSize * sizeof(bool));
-        bool* isParentofLeaf = isParentofLeafb.data();
+        ws.isParentofLeaf.assign(imSize, 0);
+        uchar* isParentofLeaf = ws.isParentofLeaf.data();
 
         for (uint i = 0; i < vecNodesSize; i++)
         {
@@ -267,8 +285,8 @@ class TBMR_Impl CV_FINAL : public TBMR
         }
 
         uint numTbmrs = 0;
-        AutoBuffer<uint> vecTbmrsb(numNodes);
-        uint* vecTbmrs = vecTbmrsb.data();
+        ws.vecTbmrs.resize(std::max(numNodes, 1u));
+        uint* vecTbmrs = ws.vecTbmrs.data();
         for (uint i = 0; i < vecNodesSize; i++)
         {
             uint p = vecNodes[i];
@@ -453,12 +471,8 @@ class TBMR_Impl CV_FINAL : public TBMR
 
     Mat tempsrc;
 
-    // component tree representation (parent,S): see
-    // https://ieeexplore.ieee.org/document/6850018
-    Mat parent;
-    Mat S;
-    // moments: compound type of: (area, x, y, xy, xx, yy)
-    Mat imaAttributes;
+    // one per pyramid level and polarity
+    std::vector<TreeWorkspace> workspaces;
 
     Params params;
 };
@@ -466,6 +480,8 @@ class TBMR_Impl CV_FINAL : public TBMR
 void TBMR_Impl::detect(InputArray _image, std::vector<KeyPoint> &keypoints,
                        InputArray _mask)
 {
+    CV_INSTRUMENT_REGION();
+
     std::vector<Elliptic_KeyPoint> kp;
     detect(_image, kp, _mask);
     keypoints.resize(kp.size());
@@ -477,6 +493,8 @@ void TBMR_Impl::detect(InputArray _image,
                        std::vector<Elliptic_KeyPoint> &keypoints,
                        InputArray _mask)
 {
+    CV_INSTRUMENT_REGION();
+
     Mat mask = _mask.getMat();
     Mat src = _image.getMat();
 
@@ -517,20 +535,35 @@ void TBMR_Impl::detect(InputArray _image,
     MSDImagePyramid scaleSpacer(src, m_cur_n_scales, m_scale_factor);
     pyr = scaleSpacer.getImPyr();
 
+    // the max and min trees of all the levels are independent, they are
+    // built concurrently, then the duplicates are removed in order
+    const int nLevels = (int)pyr.size();
+    workspaces.resize(2 * nLevels);
+    parallel_for_(Range(0, nLevels), [&](const Range &range) {
+        for (int l = range.start; l < range.end; l++)
+        {
+            sortIdx(pyr[l].reshape(1, 1), workspaces[2 * l].S,
+                    SortFlags::SORT_ASCENDING | SortFlags::SORT_EVERY_ROW);
+            // reverse instead of sort
+            flip(workspaces[2 * l].S, workspaces[2 * l + 1].S, -1);
+        }
+    });
+    parallel_for_(Range(0, 2 * nLevels), [&](const Range &range) {
+        for (int t = range.start; t < range.end; t++)
+        {
+            const Mat &s = pyr[t / 2];
+            float scale = ((float)s.cols) / pyr.begin()->cols;
+            calculateTBMRs(s, workspaces[t], mask, scale, t / 2);
+        }
+    });
+
     int oct = 0;
-    for (auto &s : pyr)
+    for (int l = 0; l < nLevels; l++)
     {
-        float scale = ((float)s.cols) / pyr.begin()->cols;
-        std::vector<Elliptic_KeyPoint> kpts;
-
-        // append max tree tbmrs
-        sortIdx(s.reshape(1, 1), S,
-                SortFlags::SORT_ASCENDING | SortFlags::SORT_EVERY_ROW);
-        calculateTBMRs(s, kpts, mask, scale, oct);
-
-        // reverse instead of sort
-        flip(S, S, -1);
-        calculateTBMRs(s, kpts, mask, scale, oct);
+        // max tree tbmrs followed by the min tree ones
+        std::vector<Elliptic_KeyPoint> kpts = workspaces[2 * l].tbmrs;
+        kpts.insert(kpts.end(), workspaces[2 * l + 1].tbmrs.begin(),
+                    workspaces[2 * l + 1].tbmrs.end());
 
         if (oct == 0)
         {
@@ -566,6 +599,8 @@ void TBMR_Impl::detectAndCompute(
     CV_OUT std::vector<Elliptic_KeyPoint> &keypoints, OutputArray descriptors,
     bool useProvidedKeypoints)
 {
+    CV_INSTRUMENT_REGION();
+
     // We can use SIFT to compute descriptors for the extracted keypoints...
     auto sift = SIFT::create();
     auto dac = AffineFeature2D::create(this, sift);
@@ -316,17 +316,16 @@ static void get_desc( const Mat Patch, Mat& PatchTrans, int anglebins, bool img_
     Mat GMagT = GMag.t();
 
     // % feature channels
-    PatchTrans = Mat( (int)Patch.total(), anglebins, CV_32F, Scalar::all(0) );
+    // PatchTrans may be a view inside of a bigger matrix
+    PatchTrans.create( (int)Patch.total(), anglebins, CV_32F );
+    PatchTrans.setTo( Scalar::all(0) );
 
-    for ( int i = 0; i < anglebins; i++ )
+    // every pixel contributes to its two closest bins
+    for ( int p = 0; p < (int)Patch.total(); p++ )
     {
-      for ( int p = 0; p < (int)Patch.total(); p++ )
-      {
-        if ( Bin1T.at<uchar>(p) == i )
-          PatchTrans.at<float>(p,i) = w1.at<float>(p) * GMagT.at<float>(p);
-        if ( Bin2T.at<uchar>(p) == i )
-          PatchTrans.at<float>(p,i) = w2.at<float>(p) * GMagT.at<float>(p);
-      }
+      float* dst = PatchTrans.ptr<float>(p);
+      dst[Bin1T.at<uchar>(p)] = w1.at<float>(p) * GMagT.at<float>(p);
+      dst[Bin2T.at<uchar>(p)] = w2.at<float>(p) * GMagT.at<float>(p);
     }
 }
 
@@ -356,22 +355,37 @@ struct ComputeVGGInvoker : ParallelLoopBody
 
     void operator ()(const cv::Range& range) const CV_OVERRIDE
     {
-      Mat Desc, PatchTrans;
+      // keypoints are pooled and projected by batches,
+      // so every product is a single bigger gemm
+      const int batch = 16;
+
+      Mat Desc, PatchTrans, DescBatch;
       Mat Patch( 64, 64, CV_32F );
-      for (int k = range.start; k < range.end; k++)
+      for (int k0 = range.start; k0 < range.end; k0 += batch)
       {
-        // sample patch from image
-        get_patch( keypoints[k], Patch, image, use_scale_orientation, scale_factor );
-        // compute transform
-        get_desc( Patch, PatchTrans, anglebins, img_normalize );
+        const int n = std::min( batch, range.end - k0 );
+        PatchTrans.create( (int)Patch.total(), anglebins * n, CV_32F );
+        for (int k = 0; k < n; k++)
+        {
+          // sample patch from image
+          get_patch( keypoints[k0 + k], Patch, image, use_scale_orientation, scale_factor );
+          // compute transform
+          Mat Trans = PatchTrans.colRange( k * anglebins, (k + 1) * anglebins );
+          get_desc( Patch, Trans, anglebins, img_normalize );
+        }
         // pool features
         Desc = PRFilters * PatchTrans;
         // crop
         min( Desc, 1.0f, Desc );
-        // reshape
-        Desc = Desc.reshape( 1, (int)Desc.total() );
+        // reshape, one row per keypoint
+        DescBatch.create( n, PRFilters.rows * anglebins, CV_32F );
+        for (int k = 0; k < n; k++)
+        {
+          Mat Row = DescBatch.row( k ).reshape( 1, PRFilters.rows );
+          Desc.colRange( k * anglebins, (k + 1) * anglebins ).copyTo( Row );
+        }
         // project
-        descriptors->row( k ) = Desc.t() * Proj.t();
+        descriptors->rowRange( k0, k0 + n ) = DescBatch * Proj.t();
       }
     }
 
@@ -391,6 +405,8 @@ struct ComputeVGGInvoker : ParallelLoopBody
 // descriptor computation using keypoints
 void VGG_Impl::compute( InputArray _image, vector<KeyPoint>& keypoints, OutputArray _descriptors )
 {
+    CV_INSTRUMENT_REGION();
+
     // do nothing if no image
     if( _image.getMat().empty() )
       return;
@@ -135,6 +135,44 @@ TEST( Features2d_DescriptorExtractor_DAISY, regression )
     test.safe_run();
 }
 
+TEST( Features2d_DescriptorExtractor_DAISY, dense_bands_and_quantization )
+{
+    Mat img(64, 80, CV_8U);
+    randu(img, 0, 256);
+    GaussianBlur(img, img, Size(5, 5), 1.5);
+    const Rect roi(10, 7, 50, 41);
+
+    Ptr<DAISY> daisy = DAISY::create(15, 3, 8, 8, DAISY::NRM_FULL);
+    Mat ref;
+    daisy->compute(img, roi, ref);
+    ASSERT_EQ(roi.area(), ref.rows);
+
+    // streamed bands must cover the roi in order and match the single call
+    int nextRow = roi.y;
+    daisy->computeBands(img, roi, 16, CV_32F, [&](const Rect& band, const Mat& desc)
+    {
+        ASSERT_EQ(nextRow, band.y);
+        ASSERT_EQ(roi.x, band.x);
+        ASSERT_EQ(roi.width, band.width);
+        ASSERT_EQ(band.area(), desc.rows);
+        Mat expected = ref.rowRange((band.y - roi.y)*roi.width, (band.y - roi.y + band.height)*roi.width);
+        EXPECT_LE(cvtest::norm(expected, desc, NORM_INF), 1e-6);
+        nextRow += band.height;
+    });
+    EXPECT_EQ(roi.y + roi.height, nextRow);
+
+    Mat desc8u, desc16f, expected8u, desc16fAsFloat;
+    daisy->compute(img, roi, desc8u, CV_8U);
+    ASSERT_EQ(CV_8UC1, desc8u.type());
+    ref.convertTo(expected8u, CV_8U, 255.0);
+    EXPECT_EQ(0, cvtest::norm(expected8u, desc8u, NORM_INF));
+
+    daisy->compute(img, roi, desc16f, CV_16F);
+    ASSERT_EQ(CV_16FC1, desc16f.type());
+    desc16f.convertTo(desc16fAsFloat, CV_32F);
+    EXPECT_LE(cvtest::norm(ref, desc16fAsFloat, NORM_INF), 1e-3);
+}
+
 TEST( Features2d_DescriptorExtractor_FREAK, regression )
 {
     CV_DescriptorExtractorTest<Hamming> test("descriptor-freak", (CV_DescriptorExtractorTest<Hamming>::DistanceType)12.f,
@@ -309,6 +347,45 @@ TEST(Features2d_BruteForceDescriptorMatcher_knnMatch, regression)
         }
     }
 }
+
+TEST(Features2d_SURF, reuseBuffers)
+{
+    string path = string(cvtest::TS::ptr()->get_data_path()) + "shared/lena.png";
+    Mat img = imread(path);
+    ASSERT_FALSE(img.empty());
+    Mat mask(img.size(), CV_8U, Scalar(255));
+    mask(Rect(0, 0, img.cols/2, img.rows/2)).setTo(0);
+
+    Ptr<SURF> reference = SURF::create();
+    Ptr<SURF> surf = SURF::create();
+    surf->setReuseBuffers(true);
+    ASSERT_TRUE(surf->getReuseBuffers());
+
+    // the second call with the same image size runs on the kept buffers,
+    // the third one checks that the mask integral of a previous frame is not used
+    for (int iter = 0; iter < 3; iter++)
+    {
+        Mat frame;
+        if (iter == 1)
+            flip(img, frame, 1);
+        else
+            frame = img;
+        Mat frameMask = iter == 1 ? mask : Mat();
+
+        vector<KeyPoint> kpRef, kp;
+        Mat descRef, desc;
+        reference->detectAndCompute(frame, frameMask, kpRef, descRef);
+        surf->detectAndCompute(frame, frameMask, kp, desc);
+
+        ASSERT_EQ(kpRef.size(), kp.size());
+        for (size_t i = 0; i < kp.size(); i++)
+        {
+            EXPECT_EQ(kpRef[i].pt, kp[i].pt);
+            EXPECT_EQ(kpRef[i].response, kp[i].response);
+        }
+        EXPECT_EQ(0, cvtest::norm(descRef, desc, NORM_INF));
+    }
+}
 #endif
 
 class CV_DetectPlanarTest : public cvtest::BaseTest
@@ -452,6 +529,41 @@ TEST(Features2d_SIFT_using_mask, regression)
     test.safe_run();
 }
 
+TEST(Features2d_AffineFeature2D, extractPatches)
+{
+    string path = string(cvtest::TS::ptr()->get_data_path()) + "shared/lena.png";
+    Mat img = imread(path, IMREAD_GRAYSCALE);
+    ASSERT_FALSE(img.empty());
+    img = img(Rect(128, 128, 256, 256)).clone();
+
+    Ptr<SIFT> sift = SIFT::create();
+    Ptr<AffineFeature2D> affine = AffineFeature2D::create(HarrisLaplaceFeatureDetector::create(), sift);
+    vector<Elliptic_KeyPoint> keypoints;
+    Mat descriptors;
+    affine->detectAndCompute(img, noArray(), keypoints, descriptors);
+    ASSERT_FALSE(keypoints.empty());
+    ASSERT_EQ((int)keypoints.size(), descriptors.rows);
+
+    vector<Mat> patches;
+    vector<KeyPoint> patchKeypoints;
+    AffineFeature2D::extractPatches(img, keypoints, patches, patchKeypoints);
+    ASSERT_EQ(keypoints.size(), patches.size());
+    ASSERT_EQ(keypoints.size(), patchKeypoints.size());
+
+    for (size_t i = 0; i < patches.size(); i++)
+    {
+        // the patches follow each other in the same buffer
+        if (i > 0)
+            EXPECT_EQ(patches[i - 1].data + patches[i - 1].total(), patches[i].data);
+
+        vector<KeyPoint> k(1, patchKeypoints[i]);
+        Mat desc;
+        sift->compute(patches[i], k, desc);
+        ASSERT_EQ(1, desc.rows);
+        EXPECT_EQ(0, cvtest::norm(desc, descriptors.row((int)i), NORM_INF));
+    }
+}
+
 #ifdef OPENCV_ENABLE_NONFREE
 TEST(DISABLED_Features2d_SURF_using_mask, regression)
 {
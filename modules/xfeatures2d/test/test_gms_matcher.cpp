@@ -113,4 +113,55 @@ void CV_GMSMatcherTest::run( int )
 
 TEST(XFeatures2d_GMSMatcher, gms_matcher_regression) { CV_GMSMatcherTest test; test.safe_run(); }
 
+TEST(XFeatures2d_GMSMatcher, reused_state)
+{
+    const string path = cvtest::TS::ptr()->get_data_path() + "detectors_descriptors_evaluation/images_datasets/graf/";
+    Mat imgRef = imread(path + "img1.png");
+    ASSERT_FALSE(imgRef.empty());
+
+    Ptr<Feature2D> orb = ORB::create(5000);
+    vector<KeyPoint> keypointsRef, keypointsCur;
+    Mat descriptorsRef, descriptorsCur;
+    orb->detectAndCompute(imgRef, noArray(), keypointsRef, descriptorsRef);
+    Ptr<DescriptorMatcher> matcher = DescriptorMatcher::create("BruteForce-Hamming");
+
+    for (int comb = 0; comb < 4; comb++)
+    {
+        const bool withRotation = (comb & 1) != 0, withScale = (comb & 2) != 0;
+        Ptr<GMSMatcher> gms = GMSMatcher::create(imgRef.size(), imgRef.size(), withRotation, withScale);
+        for (int num = 2; num <= 3; num++)
+        {
+            Mat imgCur = imread(path + format("img%d.png", num));
+            ASSERT_FALSE(imgCur.empty());
+            ASSERT_EQ(imgRef.size(), imgCur.size());
+            orb->detectAndCompute(imgCur, noArray(), keypointsCur, descriptorsCur);
+
+            vector<DMatch> matchesAll, matchesGMS, matchesRef;
+            matcher->match(descriptorsCur, descriptorsRef, matchesAll);
+
+            matchGMS(imgCur.size(), imgRef.size(), keypointsCur, keypointsRef, matchesAll, matchesRef, withRotation, withScale);
+            gms->match(keypointsCur, keypointsRef, matchesAll, matchesGMS);
+
+            ASSERT_EQ(matchesRef.size(), matchesGMS.size());
+            for (size_t i = 0; i < matchesRef.size(); i++)
+            {
+                EXPECT_EQ(matchesRef[i].queryIdx, matchesGMS[i].queryIdx);
+                EXPECT_EQ(matchesRef[i].trainIdx, matchesGMS[i].trainIdx);
+            }
+
+            // with a tiny ratio only the identity hypothesis is verified
+            gms->setEarlyStopRatio(1e-9);
+            vector<DMatch> matchesEarly;
+            gms->match(keypointsCur, keypointsRef, matchesAll, matchesEarly);
+            if (withRotation || withScale)
+            {
+                vector<DMatch> matchesIdentity;
+                matchGMS(imgCur.size(), imgRef.size(), keypointsCur, keypointsRef, matchesAll, matchesIdentity);
+                ASSERT_EQ(matchesIdentity.size(), matchesEarly.size());
+            }
+            gms->setEarlyStopRatio(0);
+        }
+    }
+}
+
 }} // namespace
@@ -0,0 +1,58 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+static Mat randomSignature(RNG& rng, int count)
+{
+    Mat signature(count, 8, CV_32F);
+    rng.fill(signature, RNG::UNIFORM, 0.f, 1.f);
+    signature.col(0) /= sum(signature.col(0))[0];
+    return signature;
+}
+
+typedef testing::TestWithParam<tuple<int, int> > Features2d_PCTSignaturesSQFD;
+
+TEST_P(Features2d_PCTSignaturesSQFD, distance_matrix)
+{
+    const int distanceFunction = get<0>(GetParam());
+    const int similarityFunction = get<1>(GetParam());
+    Ptr<PCTSignaturesSQFD> sqfd = PCTSignaturesSQFD::create(distanceFunction, similarityFunction, 1.0f);
+
+    RNG& rng = theRNG();
+    std::vector<Mat> queries, images;
+    for (int i = 0; i < 3; i++)
+        queries.push_back(randomSignature(rng, rng.uniform(1, 40)));
+    for (int i = 0; i < 70; i++)
+        images.push_back(randomSignature(rng, rng.uniform(1, 40)));
+
+    Mat distances;
+    sqfd->computeQuadraticFormDistanceMatrix(queries, images, distances);
+    ASSERT_EQ(CV_32FC1, distances.type());
+    ASSERT_EQ(Size((int)images.size(), (int)queries.size()), distances.size());
+
+    for (size_t i = 0; i < queries.size(); i++)
+    {
+        std::vector<float> row;
+        sqfd->computeQuadraticFormDistances(queries[i], images, row);
+        ASSERT_EQ(images.size(), row.size());
+        for (size_t j = 0; j < images.size(); j++)
+        {
+            float expected = sqfd->computeQuadraticFormDistance(queries[i], images[j]);
+            EXPECT_EQ(row[j], distances.at<float>((int)i, (int)j));
+            if (cvIsNaN(expected))
+                EXPECT_TRUE(cvIsNaN(distances.at<float>((int)i, (int)j)));
+            else
+                EXPECT_NEAR(expected, distances.at<float>((int)i, (int)j), 1e-3 * std::max(1.f, std::abs(expected)));
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Features2d_PCTSignaturesSQFD, testing::Combine(
+    testing::Values((int)PCTSignatures::L1, (int)PCTSignatures::L2, (int)PCTSignatures::L5, (int)PCTSignatures::L_INFINITY),
+    testing::Values((int)PCTSignatures::MINUS, (int)PCTSignatures::GAUSSIAN, (int)PCTSignatures::HEURISTIC)));
+
+}} // namespace
@@ -70,6 +70,20 @@ CV_EXPORTS_W void GradientDericheY(InputArray op, OutputArray dst, double alpha,
 *
 */
 CV_EXPORTS_W void GradientDericheX(InputArray op, OutputArray dst, double alpha,double omega);
+/**
+* @brief   Applies X and Y Deriche filters to an image in one call.
+*
+* Equivalent to GradientDericheX and GradientDericheY, but both gradients share a single
+* horizontal pass over the source.
+*
+* @param   op         Source 8-bit or 16bit image, 1-channel or 3-channel image.
+* @param   dx         result CV_32FC image of the X filter with same number of channel than _op.
+* @param   dy         result CV_32FC image of the Y filter with same number of channel than _op.
+* @param   alpha double see paper
+* @param   omega   double see paper
+*
+*/
+CV_EXPORTS_W void GradientDericheXY(InputArray op, OutputArray dx, OutputArray dy, double alpha, double omega);
 
 }
 }
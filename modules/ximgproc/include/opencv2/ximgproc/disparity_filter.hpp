@@ -120,6 +120,23 @@ public:
     /** @brief Get the ROI used in the last filter call
      */
     CV_WRAP virtual Rect getROI() = 0;
+
+    /** memory-related parameters */
+
+    /** @brief TileSize is the maximal side of a tile when filtering in tiled mode. ROIs larger than it are
+    smoothed tile by tile, with the results blended over TileOverlap pixels, so that the memory used by
+    the solver is bounded by the tile size instead of the image size. The result is an approximation of
+    the global solution. The default value of 0 disables tiling.
+     */
+    CV_WRAP virtual int getTileSize() = 0;
+    /** @see getTileSize */
+    CV_WRAP virtual void setTileSize(int _tile_size) = 0;
+    /** @brief TileOverlap is the width of the band shared by neighbouring tiles in tiled mode, it is limited
+    by half of TileSize. Default value is 64.
+     */
+    CV_WRAP virtual int getTileOverlap() = 0;
+    /** @see getTileOverlap */
+    CV_WRAP virtual void setTileOverlap(int _tile_overlap) = 0;
 };
 
 /** @brief Convenience factory method that creates an instance of DisparityWLSFilter and sets up all the relevant
@@ -77,6 +77,20 @@ public:
     to src.depth().
      */
     CV_WRAP virtual void filter(InputArray src, OutputArray dst, int dDepth = -1) = 0;
+
+    /** @brief Produce domain transform filtering operation on several source images sharing the guide.
+
+    Sources of the same depth are packed together (up to 4 channels) and filtered in one sweep over
+    the transformed distances of the guide. The results are the same as of separate filter() calls.
+
+    @param src vector of filtering images with unsigned 8-bit or floating-point 32-bit depth and up to 4 channels.
+
+    @param dst vector of destination images.
+
+    @param dDepth optional depth of the output images. dDepth can be set to -1, which will be equivalent
+    to the depth of each source.
+     */
+    CV_WRAP virtual void filterMultiple(InputArrayOfArrays src, OutputArrayOfArrays dst, int dDepth = -1) = 0;
 };
 
 /** @brief Factory method, create instance of DTFilter and produce initialization routines.
@@ -153,9 +167,14 @@ channels then only first 3 channels will be used.
 @param eps regularization term of Guided Filter. \f${eps}^2\f$ is similar to the sigma in the color
 space into bilateralFilter.
 
+@param scale subsampling factor of the Fast Guided Filter, must be in (0, 1]. When it is less than 1
+the filter coefficients are computed on the guide and filtering images downscaled by this factor
+(with the radius scaled accordingly) and bilinearly upsampled before they are applied to the full
+resolution guide. For example scale = 0.5 computes them on a two times smaller image.
+
 For more details about Guided Filter parameters, see the original article @cite Kaiming10 .
  */
-CV_EXPORTS_W Ptr<GuidedFilter> createGuidedFilter(InputArray guide, int radius, double eps);
+CV_EXPORTS_W Ptr<GuidedFilter> createGuidedFilter(InputArray guide, int radius, double eps, double scale = 1.0);
 
 /** @brief Simple one-line Guided Filter call.
 
@@ -176,8 +195,10 @@ space into bilateralFilter.
 
 @param dDepth optional depth of the output image.
 
+@param scale subsampling factor of the Fast Guided Filter, see createGuidedFilter.
+
 @sa bilateralFilter, dtFilter, amFilter */
-CV_EXPORTS_W void guidedFilter(InputArray guide, InputArray src, OutputArray dst, int radius, double eps, int dDepth = -1);
+CV_EXPORTS_W void guidedFilter(InputArray guide, InputArray src, OutputArray dst, int radius, double eps, int dDepth = -1, double scale = 1.0);
 
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -393,6 +414,20 @@ public:
     @note Confidence images with CV_8U depth are expected to in [0, 255] and CV_32F in [0, 1] range.
     */
     CV_WRAP virtual void filter(InputArray src, InputArray confidence, OutputArray dst) = 0;
+
+    /** @brief Apply smoothing operation to several source images with the same confidence.
+
+    All channels of all images are solved together: the system matrix and the preconditioner are built
+    once and the conjugate gradient iterations of all channels run in lockstep, which is faster than
+    calling filter for each image.
+
+    @param src vector of source images with the same requirements as in filter.
+
+    @param confidence confidence image with unsigned 8-bit or floating-point 32-bit confidence and 1 channel.
+
+    @param dst vector of destination images, one for every source image.
+    */
+    CV_WRAP virtual void filterMultiple(InputArrayOfArrays src, InputArray confidence, OutputArrayOfArrays dst) = 0;
 };
 
 /** @brief Factory method, create instance of FastBilateralSolverFilter and execute the initialization routines.
@@ -508,6 +543,33 @@ it should be 0.25. Setting it to 1.0 may lead to streaking artifacts.
 */
 CV_EXPORTS_W void fastGlobalSmootherFilter(InputArray guide, InputArray src, OutputArray dst, double lambda, double sigma_color, double lambda_attenuation=0.25, int num_iter=3);
 
+/** @brief Interface for implementations of the L0 gradient minimization smoother.
+
+The object keeps the gradient operators in frequency domain and the intermediate buffers of the last
+processed image size, so batch processing of images of the same size avoids their recomputation.
+
+For more details about L0 Smoother, see the original paper @cite xu2011image.
+*/
+class CV_EXPORTS_W L0Smoother : public Algorithm
+{
+public:
+    /** @brief Apply L0 smoothing to the source image.
+
+    @param src source image for filtering with unsigned 8-bit or unsigned 16-bit or floating-point depth.
+
+    @param dst destination image of the same size and type as src.
+    */
+    CV_WRAP virtual void smooth(InputArray src, OutputArray dst) = 0;
+};
+
+/** @brief Factory method, create instance of L0Smoother and perform initialization routines.
+
+@param lambda parameter defining the smooth term weight.
+
+@param kappa parameter defining the increasing factor of the weight of the gradient data term.
+*/
+CV_EXPORTS_W Ptr<L0Smoother> createL0Smoother(double lambda = 0.02, double kappa = 2.0);
+
 /** @brief Global image smoothing via L0 gradient minimization.
 
 @param src source image for filtering with unsigned 8-bit or signed 16-bit or floating-point depth.
@@ -519,6 +581,7 @@ CV_EXPORTS_W void fastGlobalSmootherFilter(InputArray guide, InputArray src, Out
 @param kappa parameter defining the increasing factor of the weight of the gradient data term.
 
 For more details about L0 Smoother, see the original paper @cite xu2011image.
+If you have multiple images of the same size to filter then use L0Smoother interface to avoid extra computations.
 */
 CV_EXPORTS_W void l0Smooth(InputArray src, OutputArray dst, double lambda = 0.02, double kappa = 2.0);
 //! @}
@@ -137,6 +137,34 @@ CV_EXPORTS_W void FastHoughTransform( InputArray  src,
                                       int         op = FHT_ADD,
                                       int         makeSkew = HDO_DESKEW );
 
+/**
+* @brief   Calculates a band of rows of 2D Fast Hough transform of an image.
+* @param   dst         The destination image, rows of the result of transformation.
+* @param   src         The source (input) image.
+* @param   dstMatDepth The depth of destination image
+* @param   houghRows   The rows of the Hough image of angleRange to calculate,
+*                      row i of dst is row houghRows.start + i of the image
+*                      calculated by cv::ximgproc::FastHoughTransform
+* @param   angleRange  The part of Hough space to calculate, see cv::AngleRangeOption
+* @param   op          The operation to be applied, see cv::HoughOp
+* @param   makeSkew    Specifies to do or not to do image skewing, see cv::HoughDeskewOption
+*
+* Every row of a quadrant of Hough space corresponds to one line direction, so
+* the band selects an interval of angles. Only the quadrants and the parts of
+* the recursive transform the band depends on are calculated, which makes a
+* narrow interval (e.g. the near-horizontal lines of a document page) much
+* cheaper than the whole transform. The points of the band are converted to
+* lines by cv::ximgproc::HoughPoint2Line after adding houghRows.start to their
+* ordinate.
+*/
+CV_EXPORTS_W void FastHoughTransformRows( InputArray   src,
+                                          OutputArray  dst,
+                                          int          dstMatDepth,
+                                          const Range &houghRows,
+                                          int          angleRange = ARO_315_135,
+                                          int          op = FHT_ADD,
+                                          int          makeSkew = HDO_DESKEW );
+
 /**
 * @brief   Calculates coordinates of line segment corresponded by point in Hough space.
 * @param   houghPoint  Point in Hough space.
@@ -40,6 +40,10 @@ public:
       and ending point of a line.  Where Vec4f is (x1, y1, x2, y2), point
       1 is the start, point 2 - end. Returned lines are directed so that the
       brighter side is on their left.
+
+      The edge map and the intermediate point and segment buffers are kept by the
+      detector and reused by subsequent calls, so one detector object should be
+      kept per video stream rather than created per frame.
       */
     CV_WRAP virtual void detect(InputArray image, OutputArray lines) = 0;
 
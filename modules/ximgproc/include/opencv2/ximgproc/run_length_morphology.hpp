@@ -113,6 +113,77 @@ CV_EXPORTS void createRLEImage(const std::vector<cv::Point3i>& runs, OutputArray
 CV_EXPORTS void morphologyEx(InputArray rlSrc, OutputArray rlDest, int op, InputArray rlKernel,
     bool bBoundaryOnForErosion = true, Point anchor = Point(0,0));
 
+/**
+* @brief   Computes the intersection of two run-length encoded binary images.
+*
+*
+* @param   rlSrc1      first input image
+* @param   rlSrc2      second input image
+* @param   rlDest      result (the size is the maximum of the sizes of the inputs)
+*
+*/
+CV_EXPORTS void bitwise_and(InputArray rlSrc1, InputArray rlSrc2, OutputArray rlDest);
+
+/**
+* @brief   Computes the union of two run-length encoded binary images.
+*
+*
+* @param   rlSrc1      first input image
+* @param   rlSrc2      second input image
+* @param   rlDest      result (the size is the maximum of the sizes of the inputs)
+*
+*/
+CV_EXPORTS void bitwise_or(InputArray rlSrc1, InputArray rlSrc2, OutputArray rlDest);
+
+/**
+* @brief   Computes the pixels which are on in exactly one of two run-length encoded binary images.
+*
+*
+* @param   rlSrc1      first input image
+* @param   rlSrc2      second input image
+* @param   rlDest      result (the size is the maximum of the sizes of the inputs)
+*
+*/
+CV_EXPORTS void bitwise_xor(InputArray rlSrc1, InputArray rlSrc2, OutputArray rlDest);
+
+/**
+* @brief   Computes the pixels of a run-length encoded binary image which are not on in a second one.
+*
+*
+* @param   rlSrc1      image to subtract from
+* @param   rlSrc2      image to be subtracted
+* @param   rlDest      result (the size is the maximum of the sizes of the inputs)
+*
+*/
+CV_EXPORTS void subtract(InputArray rlSrc1, InputArray rlSrc2, OutputArray rlDest);
+
+/**
+* @brief   Counts the foreground pixels (the area) of a run-length encoded binary image.
+*
+* @param   rlSrc       input image
+*/
+CV_EXPORTS int countNonZero(InputArray rlSrc);
+
+/**
+* @brief   Computes the bounding rectangle of the foreground of a run-length encoded binary image.
+*
+* @param   rlSrc       input image
+*/
+CV_EXPORTS Rect boundingRect(InputArray rlSrc);
+
+/**
+* @brief   Splits a run-length encoded binary image into its connected components.
+*
+*
+* @param   rlSrc        input image
+* @param   rlComponents vector of run length encoded images, one per component, ordered by the position
+*                       of their first pixel in raster order (may be omitted if only the number is needed)
+* @param   connectivity 8 or 4 for 8-way or 4-way connectivity respectively
+* @return  number of connected components
+*
+*/
+CV_EXPORTS int connectedComponents(InputArray rlSrc, OutputArrayOfArrays rlComponents, int connectivity = 8);
+
 }
 }
 }
@@ -59,6 +59,14 @@ namespace cv {
 
                             CV_WRAP virtual void setMinSize(int min_size) = 0;
                             CV_WRAP virtual int getMinSize() = 0;
+
+                            /** @brief Build the segments of tile_size x tile_size tiles in parallel before joining them along the tile borders
+                                @param tile_size Side of the tiles in pixels, 0 (default) processes the whole image in a single pass.
+                                Segments of a tile only see the edges inside of the tile before the borders are merged, so the
+                                result is close to but not the same as the single pass one.
+                            */
+                            CV_WRAP virtual void setTileSize(int tile_size) = 0;
+                            CV_WRAP virtual int getTileSize() = 0;
                     };
 
                     /** @brief Creates a graph based segmentor
@@ -226,6 +234,9 @@ namespace cv {
 
                             /** @brief Add a new strategy in the list of strategy to process.
                                 @param s The strategy
+                                @note process() runs different strategies of the list concurrently. A strategy object
+                                (including the sub-strategies of a multiple strategy) should not be part of two entries,
+                                only the same object added twice is detected and makes the strategies run sequentially.
                             */
                             CV_WRAP virtual void addStrategy(Ptr<SelectiveSearchSegmentationStrategy> s) = 0;
 
@@ -235,6 +246,9 @@ namespace cv {
 
                             /** @brief Based on all images, graph segmentations and stragies, computes all possible rects and return them
                                 @param rects The list of rects. The first ones are more relevents than the lasts ones.
+
+                                The initial segmentations and the groupings of the different strategies run in parallel. The
+                                ranks of the regions are randomized with a fixed seed, so the result is the same on every run.
                             */
                             CV_WRAP virtual void process(CV_OUT std::vector<Rect>& rects) = 0;
                     };
@@ -100,6 +100,20 @@ public:
      */
     CV_WRAP virtual void iterate( int num_iterations = 10 ) = 0;
 
+    /** @brief Replaces the segmented image with the next frame of a video.
+
+    @param image Next frame, with the same size, number of channels and depth as the image given
+    to createSuperpixelSLIC().
+
+    @param flow Optional CV_32FC2 dense optical flow from the previous frame to the new one. Every
+    superpixel center is moved by the flow vector at its position.
+
+    The superpixel centers converged on the previous frame are kept as the starting state instead
+    of a new grid, so for slowly changing video one or two calls of iterate() are usually enough
+    to refine them for the new frame.
+     */
+    CV_WRAP virtual void updateImage( InputArray image, InputArray flow = noArray() ) = 0;
+
     /** @brief Returns the segmentation labeling of the image.
 
     Each label represents a superpixel, and each pixel is assigned to one superpixel label.
@@ -127,6 +127,15 @@ public:
     @param isParallel enables/disables parallel computing.
      */
     CV_WRAP virtual void edgesNms(cv::InputArray edge_image, cv::InputArray orientation_image, cv::OutputArray _dst, int r = 2, int s = 0, float m = 1, bool isParallel = true) const = 0;
+
+    /** @brief Keeps the smoothed feature channels read by the random forest as 16 bit floats.
+
+    This halves the memory traffic of the forest evaluation. Features are rounded to half precision,
+    so edges can differ slightly from the default single precision ones.
+    @param useFloat16 enables/disables half precision features (default false).
+     */
+    CV_WRAP virtual void setUseFloat16Features(bool useFloat16) = 0;
+    CV_WRAP virtual bool getUseFloat16Features() const = 0;
 };
 
 /*!
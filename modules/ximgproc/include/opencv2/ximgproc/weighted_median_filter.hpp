@@ -89,6 +89,32 @@ enum WMFWeightType
 */
 CV_EXPORTS_W void weightedMedianFilter(InputArray joint, InputArray src, OutputArray dst,
                                        int r, double sigma = 25.5, int weightType = WMF_EXP, InputArray mask = noArray());
+
+/**
+* @brief Interface for the weighted median filter which keeps its working memory between the calls.
+*
+* Filtering a sequence of the images of the same size (e.g. post-processing of optical flow fields of a video)
+* with one instance avoids reallocating the joint-histograms of every call.
+*
+* @sa weightedMedianFilter, createWeightedMedianFilter
+*/
+class CV_EXPORTS_W WeightedMedianFilter : public Algorithm
+{
+public:
+    /**
+    * @brief Applies weighted median filter to an image, see weightedMedianFilter for the parameters.
+    */
+    CV_WRAP virtual void filter(InputArray joint, InputArray src, OutputArray dst, InputArray mask = noArray()) = 0;
+};
+
+/**
+* @brief Creates an instance of WeightedMedianFilter.
+*
+* @param   r           Radius of filtering kernel, should be a positive integer.
+* @param   sigma       Filter range standard deviation for the joint image.
+* @param   weightType  weightType The type of weight definition, see WMFWeightType
+*/
+CV_EXPORTS_W Ptr<WeightedMedianFilter> createWeightedMedianFilter(int r, double sigma = 25.5, int weightType = WMF_EXP);
 }
 }
 
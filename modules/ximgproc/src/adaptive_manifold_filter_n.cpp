@@ -358,6 +358,8 @@ void AdaptiveManifoldFilterN::initSrcAndJoint(InputArray src_, InputArray joint_
 
 void AdaptiveManifoldFilterN::filter(InputArray src, OutputArray dst, InputArray joint)
 {
+    CV_INSTRUMENT_REGION();
+
     CV_Assert(sigma_s_ >= 1 && (sigma_r_ > 0 && sigma_r_ <= 1));
     num_pca_iterations_ = std::max(1, num_pca_iterations_);
 
@@ -868,6 +870,8 @@ Ptr<AdaptiveManifoldFilter> createAMFilter(double sigma_s, double sigma_r, bool
 
 void amFilter(InputArray joint, InputArray src, OutputArray dst, double sigma_s, double sigma_r, bool adjust_outliers)
 {
+    CV_INSTRUMENT_REGION();
+
     Ptr<AdaptiveManifoldFilter> amf = createAMFilter(sigma_s, sigma_r, adjust_outliers);
     amf->filter(src, dst, joint);
 }
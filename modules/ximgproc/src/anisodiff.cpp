@@ -199,6 +199,25 @@ public:
     float alpha_;
 };
 
+// Refreshes the 1-pixel BORDER_REPLICATE frame of a padded 3-channel buffer
+static void replicateBorder(Mat& bufx)
+{
+    const int cn = 3;
+    int rows = bufx.rows - 2, cols = bufx.cols - 2;
+    for (int i = 1; i <= rows; i++)
+    {
+        uchar* p = bufx.ptr<uchar>(i);
+        for (int c = 0; c < cn; c++)
+        {
+            p[c] = p[cn + c];
+            p[(cols + 1)*cn + c] = p[cols*cn + c];
+        }
+    }
+    size_t rowsz = bufx.cols*bufx.elemSize();
+    memcpy(bufx.ptr(0), bufx.ptr(1), rowsz);
+    memcpy(bufx.ptr(rows + 1), bufx.ptr(rows), rowsz);
+}
+
 #ifdef HAVE_OPENCL
 static bool ocl_anisotropicDiffusion(InputArray src_, OutputArray dst_,
                                      float alpha, int niters,
@@ -241,6 +260,8 @@ static bool ocl_anisotropicDiffusion(InputArray src_, OutputArray dst_,
 
 void anisotropicDiffusion(InputArray src_, OutputArray dst_, float alpha, float K, int niters )
 {
+    CV_INSTRUMENT_REGION();
+
     if( niters == 0 )
     {
         src_.copyTo(dst_);
@@ -271,19 +292,24 @@ void anisotropicDiffusion(InputArray src_, OutputArray dst_, float alpha, float
     int rows = src0.rows, cols = src0.cols;
 
     Mat dst0 = dst_.getMat();
-    Mat temp0x(rows + 2, cols + 2, type);
-    Mat temp1x(rows + 2, cols + 2, type);
+    Mat temp0x, temp1x(rows + 2, cols + 2, type);
+    copyMakeBorder(src0, temp0x, 1, 1, 1, 1, BORDER_REPLICATE);
     Mat temp0(temp0x, Rect(1, 1, cols, rows));
     Mat temp1(temp1x, Rect(1, 1, cols, rows));
 
+    // The padded buffers are only ping-ponged: each pass writes the interior of the
+    // other one and then refreshes its 1-pixel border in place.
     for (int t = 0; t < niters; t++)
     {
-        Mat src = temp0, dst = t == niters-1 ? dst0 : temp1;
-        copyMakeBorder(t == 0 ? src0 : src, temp0x, 1, 1, 1, 1, BORDER_REPLICATE);
+        bool last = t == niters-1;
+        Mat src = temp0, dst = last ? dst0 : temp1;
 
         ADBody body(&src, &dst, exptab, alpha);
         parallel_for_(Range(0, rows), body, 8);
 
+        if (!last)
+            replicateBorder(temp1x);
+
         std::swap(temp0, temp1);
         std::swap(temp0x, temp1x);
     }
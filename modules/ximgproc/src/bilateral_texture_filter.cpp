@@ -53,6 +53,8 @@ namespace ximgproc
   void bilateralTextureFilter(InputArray src_, OutputArray dst_, int fr,
                               int numIter, double sigmaAlpha, double sigmaAvg)
   {
+    CV_INSTRUMENT_REGION();
+
     CV_Assert(!src_.empty());
 
     Mat src = src_.getMat();
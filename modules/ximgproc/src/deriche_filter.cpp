@@ -34,9 +34,9 @@
  *  the use of this software, even if advised of the possibility of such damage.
  */
 #include "precomp.hpp"
+#include "iir_filter_common.hpp"
 #include <math.h>
 #include <vector>
-#include <iostream>
 
 /*
 If you use this code please cite this @cite deriche1987using
@@ -45,415 +45,232 @@ Using Canny's criteria to derive a recursively implemented optimal edge detector
 
 namespace cv {
 namespace ximgproc {
-template<typename T> static void
-VerticalIIRFilter(Mat &img,Mat &dst,const Range &r,double alpha,double omega)
-{
-    float                *f2;
-    int tailleSequence = (img.rows>img.cols) ? img.rows : img.cols;
-    Mat matG1(1, tailleSequence, CV_64FC1), matG2(1, tailleSequence, CV_64FC1);
-    double *g1 = matG1.ptr<double>(0), *g2 = (double*)matG2.ptr<double>(0);
-    double a2, a3;
-    double b1, b2;
-    int rows = img.rows, cols = img.cols;
-    double c = (1 - 2 * exp(-alpha)*cos(omega) + exp(-2 * alpha)) / (exp(-alpha)*sin(omega));
-
-    double a = -c * exp(-alpha)*sin(omega);
-    a2 = 1;// kp*exp(-alpha);
-    a3 = 1;//-kp*exp(-alpha);
-    b1 = -2 * exp(-alpha)*cos(omega);
-    b2 = exp(-2 * alpha);
 
-    for (int j = r.start; j<r.end; j++)
-    {
-        // Causal vertical  IIR filter
-        T *c1 = img.ptr<T>(0);
-        f2 = dst.ptr<float>(0);
-        f2 += j;
-        c1 += j;
-        int i = 0;
-        g1[i] = a2* *c1;
-        i++;
-        c1 += cols;
-        g1[i] =a2 * c1[-cols] - (b1)* g1[i - 1];
-        i++;
-        c1 += cols;
-        for (i = 2; i<rows; i++, c1 += cols)
-            g1[i] = a2 * c1[-cols] - b1*g1[i - 1] - b2 *g1[i - 2];
-        // Anticausal vertical IIR filter
-        c1 = img.ptr<T>(0);
-        c1 += (rows - 1)*cols + j;
-        i = rows - 1;
-        g2[i] = a3 * *c1;
-        i--;
-        c1 -= cols;
-        g2[i] = a3* c1[cols]  + (b1)*g2[i + 1];
-        i--;
-        c1 -= cols;
-        for (i = rows - 3; i >= 0; i--, c1 -= cols)
-            g2[i] = a3*c1[cols] -
-            b1*g2[i + 1] - b2*g2[i + 2];
-        for (i = 0; i<rows; i++, f2 += cols)
-            *f2 = static_cast<float>(a*(g1[i] - g2[i]));
-    }
-}
-
-template<typename T> static void
-HorizontalIIRFilter(Mat &img, Mat &dst, const Range &r, double alpha, double omega)
+struct DericheCoeffs
 {
-    float *f1;
-    int rows = img.rows, cols = img.cols;
-    int tailleSequence = (rows>cols) ? rows : cols;
-    Mat matG1(1, tailleSequence, CV_64FC1), matG2(1, tailleSequence, CV_64FC1);
-    double *g1 = (double*)matG1.ptr(0), *g2 = (double*)matG2.ptr(0);
-    double a,a2, a3;
-    double b1, b2;
-    double c = (1 - 2 * exp(-alpha)*cos(omega) + exp(-2 * alpha)) / (exp(-alpha)*sin(omega));
-
-    a = -c*exp(-alpha)*sin(omega);
-    a2 = 1;// kp*exp(-alpha);
-    a3 = 1;//-kp*exp(-alpha);
-    b1 = -2 * exp(-alpha)*cos(omega);
-    b2 = exp(-2 * alpha);
-
-    for (int i = r.start; i<r.end; i++)
+    DericheCoeffs(double alpha, double omega)
     {
-        f1 = dst.ptr<float>(i);
-        T *c1 = img.ptr<T>(i);
-        int j = 0;
-        g1[j] = a2* *c1;
-        j++;
-        c1++;
-        g1[j] = a2*c1[j - 1] - (b1)* g1[j - 1];
-        j++;
-        c1++;
-        for (j = 2; j<cols; j++, c1++)
-            g1[j] = a2 * c1[-1] - b1*g1[j - 1] - b2*g1[j - 2];
-        c1 = img.ptr<T>(0);
-        c1 += i*cols + cols - 1;
-        j = cols - 1;
-        g2[j] = a3* *c1;
-        j--;
-        c1--;
-        g2[j] = a3 * c1[1] - b1 * g2[j + 1];
-        j--;
-        c1--;
-        for (j = cols - 3; j >= 0; j--, c1--)
-            g2[j] = a3*c1[1] - b1*g2[j + 1] - b2*g2[j + 2];
-        for (j = 0; j<cols; j++, f1++)
-            *f1 = static_cast<float>(a*(g1[j] - g2[j]));
-    }
-}
-
-class ParallelGradientDericheYCols : public ParallelLoopBody
-{
-private:
-    Mat &img;
-    Mat &dst;
-    double alpha;
-    double omega;
-    bool verbose;
-
-
-public:
-    ParallelGradientDericheYCols(Mat &imgSrc, Mat &d, double ald,double o) :
-        img(imgSrc),
-        dst(d),
-        alpha(ald),
-        omega(o),
-        verbose(false)
-    {
-        int type = img.depth();
-        CV_CheckType(type, type == CV_8UC1 || type == CV_8SC1 || type == CV_16SC1 || type == CV_16UC1 || type == CV_32FC1, "Wrong input type for GradientDericheYCols");
-        type = dst.depth();
-        CV_CheckType(type, type==CV_32FC1, "Wrong output type for GradientDericheYCols");
-    }
-    void Verbose(bool b) { verbose = b; }
-    virtual void operator()(const Range& range) const CV_OVERRIDE
-    {
-        if (verbose)
-            std::cout << getThreadNum() << "# :Start from row " << range.start << " to " << range.end - 1 << " (" << range.end - range.start << " loops)" << std::endl;
-
-        switch (img.depth()) {
-        case CV_8U:
-            VerticalIIRFilter<uchar>(img,dst,range, alpha,omega);
-        break;
-        case CV_8S:
-            VerticalIIRFilter<char>(img, dst, range, alpha, omega);
-        break;
-        case CV_16U:
-            VerticalIIRFilter<ushort>(img, dst, range, alpha, omega);
-            break;
-        case CV_16S:
-            VerticalIIRFilter<short>(img, dst, range, alpha, omega);
-            break;
-        case CV_32F:
-            VerticalIIRFilter<float>(img, dst, range, alpha, omega);
-            break;
-        default:
-            return;
-        }
-    };
-    ParallelGradientDericheYCols& operator=(const ParallelGradientDericheYCols &) {
-        return *this;
-    };
-};
-
-
-class ParallelGradientDericheYRows : public ParallelLoopBody
-{
-private:
-    Mat &img;
-    Mat &dst;
-    double alpha;
-    double omega;
-    bool verbose;
-
-public:
-    ParallelGradientDericheYRows(Mat& imgSrc, Mat &d, double ald,double o) :
-        img(imgSrc),
-        dst(d),
-        alpha(ald),
-        omega(o),
-        verbose(false)
-    {
-        int type = img.depth();
-        CV_CheckType(type, type == CV_32FC1, "Wrong input type for GradientDericheYRows");
-        type = dst.depth();
-        CV_CheckType(type, type == CV_32FC1, "Wrong output type for GradientDericheYRows");
-    }
-    void Verbose(bool b) { verbose = b; }
-    virtual void operator()(const Range& range) const CV_OVERRIDE
-    {
-        if (verbose)
-            std::cout << getThreadNum() << "# :Start from row " << range.start << " to " << range.end - 1 << " (" << range.end - range.start << " loops)" << std::endl;
-        float *f1, *f2;
-        int tailleSequence = (img.rows>img.cols) ? img.rows : img.cols;
-        Mat matG1(1,tailleSequence,CV_64FC1), matG2(1,tailleSequence,CV_64FC1);
-        double *g1 = matG1.ptr<double>(0), *g2 = matG2.ptr<double>(0);
-        int cols = img.cols;
-
-
+        // Derivative filter
+        double c = (1 - 2 * exp(-alpha)*cos(omega) + exp(-2 * alpha)) / (exp(-alpha)*sin(omega));
+        da = (float)(-c * exp(-alpha)*sin(omega));
+        // Smoothing filter
         double a2po2 = (alpha*alpha + omega * omega);
         double k = (1 - 2 * exp(-alpha)*cos(omega) + exp(-2 * alpha))*a2po2;
         k = k / (2 * alpha*exp(-alpha)*sin(omega) + omega - omega * exp(-2 * alpha));
         double c1 = k * alpha / a2po2;
         double c2 = k * omega / a2po2;
-        double a0 = c2;
-        double a1 = (-c2 * cos(omega) + c1 * sin(omega))*exp(-alpha);
-        double b1 = -2 * exp(-alpha)*cos(omega);
-        double b2 = exp(-2 * alpha);
-        double a2 = a1 - c2 * b1, a3 = -c2 * b2;
+        double b1d = -2 * exp(-alpha)*cos(omega);
+        double b2d = exp(-2 * alpha);
+        double a1d = (-c2 * cos(omega) + c1 * sin(omega))*exp(-alpha);
+        a0 = (float)c2;
+        a1 = (float)a1d;
+        a2 = (float)(a1d - c2 * b1d);
+        a3 = (float)(-c2 * b2d);
+        b1 = (float)b1d;
+        b2 = (float)b2d;
+    }
+    float da;
+    float a0, a1, a2, a3;
+    float b1, b2;
+};
 
-        for (int i = range.start; i<range.end; i++)
+/* Derivative line: a*(g1 - g2), g1 causal and g2 anticausal. The causal pass is kept
+ * in dst and combined in place by the anticausal one, so only two previous values of
+ * each recursion are live. */
+struct DericheDerivLine
+{
+    DericheDerivLine(const DericheCoeffs& k_) : k(k_) {}
+    template<typename T, typename VT> void
+    apply(const T* src, size_t sstep, float* dst, size_t dstep, int n) const
+    {
+        typedef IIRVec<VT> V;
+        const VT a = V::all(k.da), b1 = V::all(k.b1), b2 = V::all(k.b2);
+
+        // Causal filter
+        VT xm1 = V::load(src), y1 = V::all(0.f), y2 = y1;
+        for (int i = 0; i < n; i++)
         {
-            f2 = dst.ptr<float>(i);
-            f1 = img.ptr<float>(i);
-            int j = 0;
-            g1[j] = (a0 + a1)* *f1;
-            j++;
-            f1++;
-            g1[j] = a0 * f1[0] + a1*f1[j - 1] - b1* g1[j - 1];
-            j++;
-            f1++;
-            for (j = 2; j<cols; j++, f1++)
-                g1[j] = a0 * f1[0] + a1 * f1[-1] - b1*g1[j - 1] - b2*g1[j - 2];
-            f1 = ((float*)img.ptr(0));
-            f1 += i*cols + cols - 1;
-            j = cols - 1;
-            g2[j] = (a2 + a3)* *f1;
-            j--;
-            f1--;
-            g2[j] = (a2 + a3) * f1[1] - b2* g2[j + 1];
-            j--;
-            f1--;
-            for (j = cols - 3; j >= 0; j--, f1--)
-                g2[j] = a2*f1[1] + a3*f1[2] - b1*g2[j + 1] - b2*g2[j + 2];
-            for (j = 0; j<cols; j++, f2++)
-                *f2 = (float)(g1[j] + g2[j]);
+            VT y = xm1 - b1 * y1 - b2 * y2;
+            V::store(dst + i * dstep, y);
+            y2 = y1;
+            y1 = y;
+            xm1 = V::load(src + i * sstep);
         }
-
-    };
-    ParallelGradientDericheYRows& operator=(const ParallelGradientDericheYRows &) {
-        return *this;
-    };
+        // Anticausal filter
+        float* d = dst + (n - 1) * dstep;
+        VT zp2 = V::load(src + (n - 1) * sstep);
+        V::store(d, a * (V::load(d) - zp2));
+        d -= dstep;
+        VT zp1 = zp2 + b1 * zp2;
+        V::store(d, a * (V::load(d) - zp1));
+        for (int i = n - 3; i >= 0; i--)
+        {
+            d -= dstep;
+            VT z = V::load(src + (i + 1) * sstep) - b1 * zp1 - b2 * zp2;
+            V::store(d, a * (V::load(d) - z));
+            zp2 = zp1;
+            zp1 = z;
+        }
+    }
+    DericheCoeffs k;
 };
 
-
-class ParallelGradientDericheXCols : public ParallelLoopBody
+/* Smoothing line: g1 + g2 */
+struct DericheSmoothLine
 {
-private:
-    Mat &img;
-    Mat &dst;
-    double alpha;
-    double omega;
-    bool verbose;
-
-public:
-    ParallelGradientDericheXCols(Mat& imgSrc, Mat &d, double alm,double o) :
-        img(imgSrc),
-        dst(d),
-        alpha(alm),
-        omega(o),
-        verbose(false)
+    DericheSmoothLine(const DericheCoeffs& k_) : k(k_) {}
+    template<typename T, typename VT> void
+    apply(const T* src, size_t sstep, float* dst, size_t dstep, int n) const
     {
-        int type = img.depth();
-        CV_CheckType(type, type == CV_32FC1, "Wrong input type for GradientDericheXCols");
-        type = dst.depth();
-        CV_CheckType(type, type == CV_32FC1, "Wrong output type for GradientDericheXCols");
-    }
-    void Verbose(bool b) { verbose = b; }
-    virtual void operator()(const Range& range) const CV_OVERRIDE
-    {
-        if (verbose)
-            std::cout << getThreadNum() << "# :Start from row " << range.start << " to " << range.end - 1 << " (" << range.end - range.start << " loops)" << std::endl;
-        float                *f1, *f2;
-        int rows = img.rows, cols = img.cols;
-
-        int tailleSequence = (rows>cols) ? rows : cols;
-        Mat matG1(1,tailleSequence,CV_64FC1), matG2(1,tailleSequence,CV_64FC1);
-        double *g1 = (double*)matG1.ptr(0), *g2 = (double*)matG2.ptr(0);
-        double a2po2 = (alpha*alpha + omega * omega);
-        double k = (1 - 2 * exp(-alpha)*cos(omega) + exp(-2 * alpha))*a2po2;
-        k = k / (2 * alpha*exp(-alpha)*sin(omega) + omega - omega * exp(-2 * alpha));
-        double c1 = k * alpha / a2po2;
-        double c2 = k * omega / a2po2;
-        double a0 = c2;
-        double a1 = (-c2 * cos(omega) + c1 * sin(omega))*exp(-alpha);
-        double b1 = -2 * exp(-alpha)*cos(omega);
-        double b2=exp(-2*alpha);
-        double a2=a1-c2*b1, a3=-c2*b2;
+        typedef IIRVec<VT> V;
+        const VT a0 = V::all(k.a0), a1 = V::all(k.a1), a2 = V::all(k.a2), a3 = V::all(k.a3);
+        const VT a23 = V::all(k.a2 + k.a3), b1 = V::all(k.b1), b2 = V::all(k.b2);
 
-
-        for (int j = range.start; j<range.end; j++)
+        // Causal filter
+        VT xm1 = V::load(src), y1 = V::all(0.f), y2 = y1;
+        for (int i = 0; i < n; i++)
         {
-            f1 = img.ptr<float>(0);
-            f1 += j;
-            int i = 0;
-            g1[i] = (a0 + a1)* *f1;
-            i++;
-            f1 += cols;
-            g1[i] = a0 * *f1 + a1 * f1[-cols] - (b1)* g1[i - 1];
-            i++;
-            f1 += cols;
-            for (i = 2; i<rows; i++, f1 += cols)
-                g1[i] = a0 * *f1 + a1 * f1[-cols] - b1*g1[i - 1] - b2 *g1[i - 2];
-            f1 = img.ptr<float>(0);
-            f1 += (rows - 1)*cols + j;
-            i = rows - 1;
-            g2[i] = (a2 + a3)* *f1;
-            i--;
-            f1 -= cols;
-            g2[i] = (a2 + a3)* f1[cols] - b2*g2[i + 1];
-            i--;
-            f1 -= cols;
-            for (i = rows - 3; i >= 0; i--, f1 -= cols)
-                g2[i] = a2*f1[cols] + a3* f1[2 * cols] -
-                b1*g2[i + 1] - b2*g2[i + 2];
-            for (i = 0; i<rows; i++, f2 += cols)
-            {
-                f2 = (dst.ptr<float>(i)) + (j*img.channels());
-                *f2 = (float)(g1[i] + g2[i]);
-            }
+            VT x = V::load(src + i * sstep);
+            VT y = a0 * x + a1 * xm1 - b1 * y1 - b2 * y2;
+            V::store(dst + i * dstep, y);
+            y2 = y1;
+            y1 = y;
+            xm1 = x;
         }
-    };
-    ParallelGradientDericheXCols& operator=(const ParallelGradientDericheXCols &) {
-        return *this;
-    };
+        // Anticausal filter
+        float* d = dst + (n - 1) * dstep;
+        VT xp2 = V::load(src + (n - 1) * sstep);
+        VT zp2 = a23 * xp2;
+        V::store(d, V::load(d) + zp2);
+        d -= dstep;
+        VT zp1 = a23 * xp2 - b2 * zp2;
+        V::store(d, V::load(d) + zp1);
+        for (int i = n - 3; i >= 0; i--)
+        {
+            d -= dstep;
+            VT xp1 = V::load(src + (i + 1) * sstep);
+            VT z = a2 * xp1 + a3 * xp2 - b1 * zp1 - b2 * zp2;
+            V::store(d, V::load(d) + z);
+            zp2 = zp1;
+            zp1 = z;
+            xp2 = xp1;
+        }
+    }
+    DericheCoeffs k;
 };
 
-
-class ParallelGradientDericheXRows : public ParallelLoopBody
+/* Horizontal pass of GradientDericheXY: the derivative and the smoothing of each row
+ * are computed while the row is still in cache. */
+class ParallelGradientDericheXYRows : public ParallelLoopBody
 {
-private:
-    Mat &img;
-    Mat &dst;
-    double alpha;
-    double omega;
-    bool verbose;
-
 public:
-    ParallelGradientDericheXRows(Mat& imgSrc, Mat &d, double ald, double o) :
-        img(imgSrc),
-        dst(d),
-        alpha(ald),
-        omega(o),
-        verbose(false)
+    ParallelGradientDericheXYRows(const Mat& img_, Mat& dx_, Mat& dy_, const DericheCoeffs& k) :
+        img(img_), dx(dx_), dy(dy_), deriv(k), smooth(k)
     {
-        int type = img.depth();
-        CV_CheckType(type, type == CV_8UC1 || type == CV_8SC1 || type == CV_16SC1 || type == CV_16UC1 || type == CV_32FC1, "Wrong input type for GradientDericheXRows");
-        type = dst.depth();
-        CV_CheckType(type, type == CV_32FC1, "Wrong output type for GradientDericheXRows");
+        int type = img.type();
+        CV_CheckType(type, type == CV_8UC1 || type == CV_8SC1 || type == CV_16SC1 || type == CV_16UC1 || type == CV_32FC1, "Wrong input type for GradientDericheXYRows");
     }
-    void Verbose(bool b) { verbose = b; }
     virtual void operator()(const Range& range) const CV_OVERRIDE
     {
-        if (verbose)
-            std::cout << getThreadNum() << "# :Start from row " << range.start << " to " << range.end - 1 << " (" << range.end - range.start << " loops)" << std::endl;
-
         switch (img.depth()) {
         case CV_8U:
-            HorizontalIIRFilter<uchar>(img,dst,range, alpha,omega);
+            filterRows<uchar>(range);
             break;
         case CV_8S:
-            HorizontalIIRFilter<char>(img, dst, range, alpha, omega);
+            filterRows<schar>(range);
             break;
         case CV_16U:
-            HorizontalIIRFilter<ushort>(img, dst, range, alpha, omega);
+            filterRows<ushort>(range);
             break;
         case CV_16S:
-            HorizontalIIRFilter<short>(img, dst, range, alpha, omega);
+            filterRows<short>(range);
             break;
         case CV_32F:
-            HorizontalIIRFilter<float>(img, dst, range, alpha, omega);
+            filterRows<float>(range);
             break;
         default:
             return;
         }
-    };
-    ParallelGradientDericheXRows& operator=(const ParallelGradientDericheXRows &) {
+    }
+    ParallelGradientDericheXYRows& operator=(const ParallelGradientDericheXYRows &) {
         return *this;
-    };
+    }
+private:
+    template<typename T> void filterRows(const Range& range) const
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            const T* src = img.ptr<T>(i);
+            deriv.apply<T, float>(src, 1, dx.ptr<float>(i), 1, img.cols);
+            smooth.apply<T, float>(src, 1, dy.ptr<float>(i), 1, img.cols);
+        }
+    }
+    const Mat& img;
+    Mat& dx;
+    Mat& dy;
+    DericheDerivLine deriv;
+    DericheSmoothLine smooth;
 };
 
 void GradientDericheY(InputArray _op, OutputArray _dst,double alphaDerive, double omega)
 {
+    CV_Assert(_op.rows() >= 2 && _op.cols() >= 2);
     std::vector<Mat> planSrc;
     split(_op, planSrc);
 
-    std::vector<Mat> planTmp;
-    std::vector<Mat> planDst;
+    DericheCoeffs k(alphaDerive, omega);
+    Mat planTmp(_op.size(), CV_32FC1);
+    std::vector<Mat> planDst(planSrc.size());
     for (size_t i = 0; i < planSrc.size(); i++)
     {
-        planTmp.push_back(Mat(_op.size(), CV_32FC1));
-        planDst.push_back(Mat(_op.size(), CV_32FC1));
-        CV_Assert(planSrc[i].isContinuous() && planTmp[i].isContinuous() && planDst[i].isContinuous());
-        ParallelGradientDericheYCols x(planSrc[i], planTmp[i], alphaDerive,omega);
-        parallel_for_(Range(0, planSrc[i].cols), x, getNumThreads());
-        ParallelGradientDericheYRows xr(planTmp[i], planDst[i], alphaDerive, omega);
-        parallel_for_(Range(0, planTmp[i].rows), xr, getNumThreads());
+        planDst[i].create(_op.size(), CV_32FC1);
+        runIIRFilter(planSrc[i], planTmp, DericheDerivLine(k), true);
+        runIIRFilter(planTmp, planDst[i], DericheSmoothLine(k), false);
     }
     merge(planDst, _dst);
 }
 
 void GradientDericheX(InputArray _op, OutputArray _dst, double alpha, double omega)
 {
+    CV_Assert(_op.rows() >= 2 && _op.cols() >= 2);
     std::vector<Mat> planSrc;
     split(_op, planSrc);
-    std::vector<Mat> planTmp;
-    std::vector<Mat> planDst;
+
+    DericheCoeffs k(alpha, omega);
+    Mat planTmp(_op.size(), CV_32FC1);
+    std::vector<Mat> planDst(planSrc.size());
     for (size_t i = 0; i < planSrc.size(); i++)
     {
-        planTmp.push_back(Mat(_op.size(), CV_32FC1));
-        planDst.push_back(Mat(_op.size(), CV_32FC1));
-        CV_Assert(planSrc[i].isContinuous() && planTmp[i].isContinuous() && planDst[i].isContinuous());
-
-        ParallelGradientDericheXRows x(planSrc[i], planTmp[i], alpha, omega);
-        parallel_for_(Range(0, planSrc[i].rows), x, getNumThreads());
-        ParallelGradientDericheXCols xr(planTmp[i], planDst[i], alpha, omega);
-        parallel_for_(Range(0, planTmp[i].cols), xr, getNumThreads());
+        planDst[i].create(_op.size(), CV_32FC1);
+        runIIRFilter(planSrc[i], planTmp, DericheDerivLine(k), false);
+        runIIRFilter(planTmp, planDst[i], DericheSmoothLine(k), true);
     }
     merge(planDst, _dst);
 }
 
+void GradientDericheXY(InputArray _op, OutputArray _dx, OutputArray _dy, double alpha, double omega)
+{
+    CV_Assert(_op.rows() >= 2 && _op.cols() >= 2);
+    std::vector<Mat> planSrc;
+    split(_op, planSrc);
+
+    // Row and column filters commute, so the Y gradient can smooth along rows first
+    // and share the horizontal pass with the X gradient.
+    DericheCoeffs k(alpha, omega);
+    Mat tmpX(_op.size(), CV_32FC1), tmpY(_op.size(), CV_32FC1);
+    std::vector<Mat> planDx(planSrc.size()), planDy(planSrc.size());
+    for (size_t i = 0; i < planSrc.size(); i++)
+    {
+        planDx[i].create(_op.size(), CV_32FC1);
+        planDy[i].create(_op.size(), CV_32FC1);
+        ParallelGradientDericheXYRows xy(planSrc[i], tmpX, tmpY, k);
+        parallel_for_(Range(0, planSrc[i].rows), xy, getNumThreads());
+        runIIRFilter(tmpX, planDx[i], DericheSmoothLine(k), true);
+        runIIRFilter(tmpY, planDy[i], DericheDerivLine(k), true);
+    }
+    merge(planDx, _dx);
+    merge(planDy, _dy);
+}
+
 } //end of cv::ximgproc
 } //end of cv
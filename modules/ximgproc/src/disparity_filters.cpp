@@ -61,11 +61,22 @@ protected:
     float depth_discontinuity_roll_off_factor;
     float resize_factor;
     int num_stripes;
+    int tile_size, tile_overlap;
+
+    /* solver of the last untiled filter call, it is reused while the guide and the parameters are unchanged */
+    Ptr<FastGlobalSmootherFilter> fgs;
+    Mat fgs_guide;
+    double fgs_lambda, fgs_sigma_color;
 
     void init(double _lambda, double _sigma_color, bool _use_confidence, int l_offs, int r_offs, int t_offs, int b_offs, int _min_disp);
     void computeDepthDiscontinuityMaps(Mat& left_disp, Mat& right_disp, Mat& left_dst, Mat& right_dst);
     void computeConfidenceMap(InputArray left_disp, InputArray right_disp);
 
+    Ptr<FastGlobalSmootherFilter> getGuideFilter(const Mat& guide);
+    void smoothDisparity(const Mat& guide, const Mat& disp, const Mat& conf, Mat& dst);
+    void smoothDisparityTiled(const Mat& guide, const Mat& disp, const Mat& conf, Mat& dst);
+    static void solve(FastGlobalSmootherFilter& solver, const Mat& disp, const Mat& conf, Mat& dst);
+
 protected:
     struct ComputeDiscontinuityAwareLRC_ParBody : public ParallelLoopBody
     {
@@ -138,6 +149,12 @@ public:
 
     Mat getConfidenceMap() CV_OVERRIDE { return confidence_map; }
     Rect getROI() CV_OVERRIDE { return valid_disp_ROI; }
+
+    int getTileSize() CV_OVERRIDE { return tile_size; }
+    void setTileSize(int _tile_size) CV_OVERRIDE { CV_Assert(_tile_size >= 0); tile_size = _tile_size; }
+
+    int getTileOverlap() CV_OVERRIDE { return tile_overlap; }
+    void setTileOverlap(int _tile_overlap) CV_OVERRIDE { CV_Assert(_tile_overlap >= 0); tile_overlap = _tile_overlap; }
 };
 
 void DisparityWLSFilterImpl::init(double _lambda, double _sigma_color, bool _use_confidence,  int l_offs, int r_offs, int t_offs, int b_offs, int _min_disp)
@@ -157,6 +174,121 @@ void DisparityWLSFilterImpl::init(double _lambda, double _sigma_color, bool _use
     depth_discontinuity_roll_off_factor = 0.001f;
     resize_factor = 1.0;
     num_stripes = getNumThreads();
+    tile_size = 0;
+    tile_overlap = 64;
+    fgs.release();
+    fgs_guide.release();
+    fgs_lambda = fgs_sigma_color = 0.0;
+}
+
+Ptr<FastGlobalSmootherFilter> DisparityWLSFilterImpl::getGuideFilter(const Mat& guide)
+{
+    bool same_guide = !fgs.empty() && fgs_lambda == lambda && fgs_sigma_color == sigma_color &&
+                      fgs_guide.size() == guide.size() && fgs_guide.type() == guide.type() &&
+                      norm(fgs_guide, guide, NORM_INF) == 0;
+    if (!same_guide)
+    {
+        fgs.release();
+        fgs = createFastGlobalSmootherFilter(guide, lambda, sigma_color);
+        guide.copyTo(fgs_guide);
+        fgs_lambda = lambda;
+        fgs_sigma_color = sigma_color;
+    }
+    return fgs;
+}
+
+void DisparityWLSFilterImpl::solve(FastGlobalSmootherFilter& solver, const Mat& disp, const Mat& conf, Mat& dst)
+{
+    if (conf.empty())
+    {
+        solver.filter(disp, dst);
+        return;
+    }
+
+    Mat disp_mul_conf;
+    disp_mul_conf = conf.mul(disp);
+    Mat conf_filtered;
+    solver.filter(disp_mul_conf,disp_mul_conf);
+    solver.filter(conf,conf_filtered);
+    dst = disp_mul_conf.mul(1/(conf_filtered+EPS));
+}
+
+void DisparityWLSFilterImpl::smoothDisparity(const Mat& guide, const Mat& disp, const Mat& conf, Mat& dst)
+{
+    if (tile_size > 0 && (guide.cols > tile_size || guide.rows > tile_size))
+    {
+        smoothDisparityTiled(guide, disp, conf, dst);
+        return;
+    }
+
+    Mat filtered_disp;
+    solve(*getGuideFilter(guide), disp, conf, filtered_disp);
+    filtered_disp.copyTo(dst);
+}
+
+/* Every tile is solved independently and the results are blended with weights linearly
+   ramping over the overlap, so only one tile of solver state is alive at any time */
+void DisparityWLSFilterImpl::smoothDisparityTiled(const Mat& guide, const Mat& disp, const Mat& conf, Mat& dst)
+{
+    int overlap = std::min(tile_overlap, tile_size / 2);
+    int step = tile_size - overlap;
+
+    vector<int> xs, ys;
+    for (int x = 0; ; x += step)
+    {
+        xs.push_back(std::min(x, std::max(guide.cols - tile_size, 0)));
+        if (x + tile_size >= guide.cols) break;
+    }
+    for (int y = 0; ; y += step)
+    {
+        ys.push_back(std::min(y, std::max(guide.rows - tile_size, 0)));
+        if (y + tile_size >= guide.rows) break;
+    }
+
+    //the solver of a previous untiled call would only hold memory here
+    fgs.release();
+    fgs_guide.release();
+
+    dst = Scalar::all(0);
+    Mat weight_sum = Mat::zeros(guide.size(), CV_32F);
+    vector<float> wx, wy;
+    for (size_t ty = 0; ty < ys.size(); ty++)
+    {
+        for (size_t tx = 0; tx < xs.size(); tx++)
+        {
+            Rect tile(xs[tx], ys[ty], std::min(tile_size, guide.cols - xs[tx]), std::min(tile_size, guide.rows - ys[ty]));
+
+            Ptr<FastGlobalSmootherFilter> solver = createFastGlobalSmootherFilter(guide(tile), lambda, sigma_color);
+            Mat tile_res;
+            solve(*solver, disp(tile), conf.empty() ? conf : conf(tile), tile_res);
+            solver.release();
+
+            wx.assign(tile.width, 1.0f);
+            wy.assign(tile.height, 1.0f);
+            for (int k = 0; k < overlap; k++)
+            {
+                float ramp = (k + 0.5f) / overlap;
+                if (tile.x > 0 && k < tile.width)                       wx[k] = std::min(wx[k], ramp);
+                if (tile.x + tile.width < guide.cols && k < tile.width)  wx[tile.width - 1 - k] = std::min(wx[tile.width - 1 - k], ramp);
+                if (tile.y > 0 && k < tile.height)                      wy[k] = std::min(wy[k], ramp);
+                if (tile.y + tile.height < guide.rows && k < tile.height) wy[tile.height - 1 - k] = std::min(wy[tile.height - 1 - k], ramp);
+            }
+
+            for (int i = 0; i < tile.height; i++)
+            {
+                const float* res_row = tile_res.ptr<float>(i);
+                float* dst_row = dst.ptr<float>(tile.y + i) + tile.x;
+                float* wsum_row = weight_sum.ptr<float>(tile.y + i) + tile.x;
+                for (int j = 0; j < tile.width; j++)
+                {
+                    float w = wy[i] * wx[j];
+                    dst_row[j] += w * res_row[j];
+                    wsum_row[j] += w;
+                }
+            }
+        }
+    }
+    divide(dst, weight_sum, dst);
 }
 
 void DisparityWLSFilterImpl::computeDepthDiscontinuityMaps(Mat& left_disp, Mat& right_disp, Mat& left_dst, Mat& right_dst)
@@ -292,9 +424,7 @@ void DisparityWLSFilterImpl::filter_(InputArray disparity_map_left, InputArray l
         Mat& dst_full_size = filtered_disparity_map.getMatRef();
         dst_full_size = Scalar(16*(min_disp-1));
         dst = Mat(dst_full_size,ROI);
-        Mat filtered_disp;
-        fastGlobalSmootherFilter(src,disp,filtered_disp,lambda,sigma_color);
-        filtered_disp.copyTo(dst);
+        smoothDisparity(src,disp,Mat(),dst);
     }
     else
     {
@@ -324,14 +454,7 @@ void DisparityWLSFilterImpl::filter_(InputArray disparity_map_left, InputArray l
         dst_full_size = Scalar(16*(min_disp-1));
         dst = Mat(dst_full_size,ROI);
         Mat conf(confidence_map,ROI);
-
-        Mat disp_mul_conf;
-        disp_mul_conf = conf.mul(disp);
-        Mat conf_filtered;
-        Ptr<FastGlobalSmootherFilter> wls = createFastGlobalSmootherFilter(src,lambda,sigma_color);
-        wls->filter(disp_mul_conf,disp_mul_conf);
-        wls->filter(conf,conf_filtered);
-        dst = disp_mul_conf.mul(1/(conf_filtered+EPS));
+        smoothDisparity(src,disp,conf,dst);
     }
 }
 
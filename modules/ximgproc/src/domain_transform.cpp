@@ -51,6 +51,8 @@ Ptr<DTFilter> createDTFilter(InputArray guide, double sigmaSpatial, double sigma
 CV_EXPORTS_W
 void dtFilter(InputArray guide, InputArray src, OutputArray dst, double sigmaSpatial, double sigmaColor, int mode, int numIters)
 {
+    CV_INSTRUMENT_REGION();
+
     Ptr<DTFilterCPU> dtf = DTFilterCPU::create(guide, sigmaSpatial, sigmaColor, mode, numIters);
     dtf->setSingleFilterCall(true);
     dtf->filter(src, dst);
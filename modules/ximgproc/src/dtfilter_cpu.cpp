@@ -121,6 +121,8 @@ void DTFilterCPU::init(InputArray guide_, double sigmaSpatial_, double sigmaColo
 
 void DTFilterCPU::filter(InputArray src_, OutputArray dst_, int dDepth)
 {
+    CV_INSTRUMENT_REGION();
+
     Mat src = src_.getMat();
     dst_.create(src.size(), src.type());
     Mat& dst = dst_.getMatRef();
@@ -160,6 +162,56 @@ void DTFilterCPU::filter(InputArray src_, OutputArray dst_, int dDepth)
     }
 }
 
+void DTFilterCPU::filterMultiple(InputArrayOfArrays src_, OutputArrayOfArrays dst_, int dDepth)
+{
+    CV_Assert(src_.isMatVector() || src_.isUMatVector());
+
+    int nsrc = (int)src_.total();
+    std::vector<Mat> srcs(nsrc);
+    for (int k = 0; k < nsrc; k++)
+    {
+        srcs[k] = src_.getMat(k);
+        CV_Assert(!srcs[k].empty() && srcs[k].channels() <= 4 && (srcs[k].depth() == CV_8U || srcs[k].depth() == CV_32F));
+    }
+
+    dst_.create(nsrc, 1, 0);
+
+    //consecutive sources of one depth are packed into one image of up to 4 channels,
+    //all channels are independent so every group is filtered in a single sweep
+    for (int first = 0; first < nsrc; )
+    {
+        int last = first + 1;
+        int cn = srcs[first].channels();
+        while (last < nsrc && srcs[last].depth() == srcs[first].depth() && srcs[last].size() == srcs[first].size() &&
+               cn + srcs[last].channels() <= 4)
+        {
+            cn += srcs[last++].channels();
+        }
+
+        Mat packed, filtered;
+        if (last - first == 1)
+            packed = srcs[first];
+        else
+            merge(&srcs[first], last - first, packed);
+
+        filter(packed, filtered, dDepth);
+
+        std::vector<Mat> dsts(last - first);
+        for (int k = first; k < last; k++)
+        {
+            dst_.create(filtered.size(), CV_MAKETYPE(filtered.depth(), srcs[k].channels()), k);
+            dsts[k - first] = dst_.getMat(k);
+        }
+
+        std::vector<int> fromTo(2 * cn);
+        for (int c = 0; c < cn; c++)
+            fromTo[2 * c] = fromTo[2 * c + 1] = c;
+        mixChannels(&filtered, 1, &dsts[0], dsts.size(), &fromTo[0], cn);
+
+        first = last;
+    }
+}
+
 void DTFilterCPU::setSingleFilterCall(bool value)
 {
     singleFilterCall = value;
@@ -61,6 +61,8 @@ public: /*Non-template methods*/
 
     void filter(InputArray src, OutputArray dst, int dDepth = -1) CV_OVERRIDE;
 
+    void filterMultiple(InputArrayOfArrays src, OutputArrayOfArrays dst, int dDepth = -1) CV_OVERRIDE;
+
     void setSingleFilterCall(bool value);
 
 public: /*Template methods*/
@@ -144,6 +146,20 @@ protected: /*Wrappers for parallelization*/
         void operator() (const Range& range) const CV_OVERRIDE;
     };
 
+    /*Vertical NC pass in place: columns are processed in blocks of blockCols, the integral of a block
+      is kept in a small (rows+1) x blockCols tile instead of transposing the whole image*/
+    template <typename WorkVec>
+    struct FilterNC_vertPass : public ParallelLoopBody
+    {
+        enum { blockCols = 16 };
+        Mat &res, &idist;
+        float radius;
+
+        FilterNC_vertPass(Mat& res_, Mat& idist_);
+        void operator() (const Range& range) const CV_OVERRIDE;
+        Range getRange() const { return Range(0, (res.cols + blockCols - 1) / blockCols); }
+    };
+
     template <typename WorkVec>
     struct FilterIC_horPass : public ParallelLoopBody
     {
@@ -173,6 +189,7 @@ protected: /*Wrappers for parallelization*/
 
         FilterRF_vertPass(Mat& res_, Mat& alphaD_, int iteration_);
         void operator() (const Range& range) const CV_OVERRIDE;
+        static void vertRowPass(WorkVec *curRow, const WorkVec *prevRow, const DistType *adRow, const Range& rcols);
         #ifdef CV_GET_NUM_THREAD_WORKS_PROPERLY
         Range getRange() const { return Range(0, cv::getNumThreads()); }
         #else
@@ -245,6 +262,8 @@ protected: /*Auxiliary implementation functions*/
     template<typename SrcVec, typename SrcWorkVec>
     static void integrateRow(const SrcVec *src, SrcWorkVec *dst, int cols);
 
+    static void filterRF_horRows4(float *rows[4], const float *adRows[4], int cols);
+
     inline static int getLeftBound(IDistType *idist, int pos, IDistType searchValue)
     {
         while (idist[pos] < searchValue)
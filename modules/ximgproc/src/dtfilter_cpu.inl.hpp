@@ -38,6 +38,7 @@
 #define __OPENCV_DTFILTER_INL_HPP__
 #include "precomp.hpp"
 #include "edgeaware_filters_common.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include <limits>
 
 namespace cv
@@ -148,18 +149,17 @@ void DTFilterCPU::filter_(const Mat& src, Mat& dst, int dDepth)
 
     if (mode == DTF_NC)
     {
-        Mat resT(src.cols, src.rows, traits::Type<WorkVec>::value);
         src.convertTo(res, traits::Type<WorkVec>::value);
 
-        FilterNC_horPass<WorkVec> horParBody(res, idistHor, resT);
-        FilterNC_horPass<WorkVec> vertParBody(resT, idistVert, res);
+        FilterNC_horPass<WorkVec> horParBody(res, idistHor, res);
+        FilterNC_vertPass<WorkVec> vertParBody(res, idistVert);
 
         for (int iter = 1; iter <= numIters; iter++)
         {
             horParBody.radius = vertParBody.radius = getIterRadius(iter);
 
             parallel_for_(Range(0, res.rows), horParBody);
-            parallel_for_(Range(0, resT.rows), vertParBody);
+            parallel_for_(vertParBody.getRange(), vertParBody);
         }
     }
     else if (mode == DTF_IC)
@@ -270,7 +270,7 @@ template <typename WorkVec>
 DTFilterCPU::FilterNC_horPass<WorkVec>::FilterNC_horPass(Mat& src_, Mat& idist_, Mat& dst_)
 : src(src_), idist(idist_), dst(dst_), radius(1.0f)
 {
-    CV_DbgAssert(src.type() == traits::Type<WorkVec>::value && dst.type() == traits::Type<WorkVec>::value && dst.rows == src.cols && dst.cols == src.rows);
+    CV_DbgAssert(src.type() == traits::Type<WorkVec>::value && dst.type() == traits::Type<WorkVec>::value && dst.size() == src.size());
 }
 
 template <typename WorkVec>
@@ -279,18 +279,24 @@ void DTFilterCPU::FilterNC_horPass<WorkVec>::operator()(const Range& range) cons
     #ifdef NC_USE_INTEGRAL_SRC
     std::vector<WorkVec> isrcBuf(src.cols + 1);
     WorkVec *isrcLine = &isrcBuf[0];
+    #else
+    std::vector<WorkVec> srcBuf(src.cols);
     #endif
 
     for (int i = range.start; i < range.end; i++)
     {
         const WorkVec   *srcLine    = src.ptr<WorkVec>(i);
         IDistType       *idistLine  = idist.ptr<IDistType>(i);
+        WorkVec         *dstLine    = dst.ptr<WorkVec>(i);
         int leftBound = 0, rightBound = 0;
         WorkVec sum;
 
         #ifdef NC_USE_INTEGRAL_SRC
         integrateRow(srcLine, isrcLine, src.cols);
         #else
+        //the pass can be done in place, the window moves over a copy of the source line
+        std::copy(srcLine, srcLine + src.cols, srcBuf.begin());
+        srcLine = &srcBuf[0];
         sum = srcLine[0];
         #endif
 
@@ -315,7 +321,59 @@ void DTFilterCPU::FilterNC_horPass<WorkVec>::operator()(const Range& range) cons
             }
             #endif
 
-            dst.at<WorkVec>(j, i) = sum / (float)(rightBound + 1 - leftBound);
+            dstLine[j] = sum / (float)(rightBound + 1 - leftBound);
+        }
+    }
+}
+
+template <typename WorkVec>
+DTFilterCPU::FilterNC_vertPass<WorkVec>::FilterNC_vertPass(Mat& res_, Mat& idist_)
+: res(res_), idist(idist_), radius(1.0f)
+{
+    CV_DbgAssert(res.type() == traits::Type<WorkVec>::value && idist.rows == res.cols && idist.cols == res.rows + 1);
+}
+
+template <typename WorkVec>
+void DTFilterCPU::FilterNC_vertPass<WorkVec>::operator()(const Range& range) const
+{
+    std::vector<WorkVec> isrcBuf((res.rows + 1) * blockCols);
+    WorkVec *isrcTile = &isrcBuf[0];
+    IDistType *idistLines[blockCols];
+    int leftBounds[blockCols], rightBounds[blockCols];
+
+    for (int b = range.start; b < range.end; b++)
+    {
+        int j0 = b * blockCols;
+        int bw = std::min((int)blockCols, res.cols - j0);
+
+        //integral of the columns of the block, accumulated in the same order as integrateRow does
+        for (int jj = 0; jj < bw; jj++)
+        {
+            isrcTile[jj] = WorkVec::all(0);
+            idistLines[jj] = idist.ptr<IDistType>(j0 + jj);
+            leftBounds[jj] = rightBounds[jj] = 0;
+        }
+        for (int i = 0; i < res.rows; i++)
+        {
+            const WorkVec *srcRow = res.ptr<WorkVec>(i) + j0;
+            const WorkVec *prevLine = isrcTile + i * blockCols;
+            WorkVec *curLine = isrcTile + (i + 1) * blockCols;
+            for (int jj = 0; jj < bw; jj++)
+                curLine[jj] = prevLine[jj] + srcRow[jj];
+        }
+
+        for (int i = 0; i < res.rows; i++)
+        {
+            WorkVec *dstRow = res.ptr<WorkVec>(i) + j0;
+            for (int jj = 0; jj < bw; jj++)
+            {
+                IDistType *idistLine = idistLines[jj];
+                IDistType curVal = idistLine[i];
+                int leftBound  = leftBounds[jj] = getLeftBound(idistLine, leftBounds[jj], curVal - radius);
+                int rightBound = rightBounds[jj] = getRightBound(idistLine, rightBounds[jj], curVal + radius);
+
+                dstRow[jj] = (isrcTile[(rightBound + 1) * blockCols + jj] - isrcTile[leftBound * blockCols + jj]) / (float)(rightBound + 1 - leftBound);
+            }
         }
     }
 }
@@ -392,7 +450,33 @@ DTFilterCPU::FilterRF_horPass<WorkVec>::FilterRF_horPass(Mat& res_, Mat& alphaD_
 template <typename WorkVec>
 void DTFilterCPU::FilterRF_horPass<WorkVec>::operator()(const Range& range) const
 {
-    for (int i = range.start; i < range.end; i++)
+    int i = range.start;
+
+#if CV_SIMD128
+    //single channel rows are filtered 4 at once, every lane runs the recursion of its own row
+    if (WorkVec::channels == 1 && res.cols >= 2)
+    {
+        for (; i + 3 < range.end; i += 4)
+        {
+            float *rows[4];
+            const float *adRows[4];
+            for (int k = 0; k < 4; k++)
+            {
+                rows[k] = (float*)res.ptr<WorkVec>(i + k);
+                DistType *adLine = alphaD.ptr<DistType>(i + k);
+                if (iteration > 1)
+                {
+                    for (int j = res.cols - 2; j >= 0; j--)
+                        adLine[j] *= adLine[j];
+                }
+                adRows[k] = adLine;
+            }
+            filterRF_horRows4(rows, adRows, res.cols);
+        }
+    }
+#endif
+
+    for (; i < range.end; i++)
     {
         WorkVec     *dstLine = res.ptr<WorkVec>(i);
         DistType    *adLine  = alphaD.ptr<DistType>(i);
@@ -417,6 +501,73 @@ void DTFilterCPU::FilterRF_horPass<WorkVec>::operator()(const Range& range) cons
 }
 
 
+inline void DTFilterCPU::filterRF_horRows4(float *rows[4], const float *adRows[4], int cols)
+{
+#if CV_SIMD128
+    float *r0 = rows[0], *r1 = rows[1], *r2 = rows[2], *r3 = rows[3];
+    const float *a0 = adRows[0], *a1 = adRows[1], *a2 = adRows[2], *a3 = adRows[3];
+    v_float32x4 d0, d1, d2, d3, c0, c1, c2, c3;
+    v_float32x4 w0, w1, w2, w3, b0, b1, b2, b3;
+    int j;
+
+    //left to right: blocks of 4 columns are transposed so that each register holds one column of the 4 rows
+    v_float32x4 prev(r0[0], r1[0], r2[0], r3[0]);
+    for (j = 1; j + 3 < cols; j += 4)
+    {
+        d0 = v_load(r0 + j); d1 = v_load(r1 + j); d2 = v_load(r2 + j); d3 = v_load(r3 + j);
+        v_transpose4x4(d0, d1, d2, d3, c0, c1, c2, c3);
+        w0 = v_load(a0 + j - 1); w1 = v_load(a1 + j - 1); w2 = v_load(a2 + j - 1); w3 = v_load(a3 + j - 1);
+        v_transpose4x4(w0, w1, w2, w3, b0, b1, b2, b3);
+
+        c0 = c0 + b0 * (prev - c0);
+        c1 = c1 + b1 * (c0 - c1);
+        c2 = c2 + b2 * (c1 - c2);
+        c3 = c3 + b3 * (c2 - c3);
+        prev = c3;
+
+        v_transpose4x4(c0, c1, c2, c3, d0, d1, d2, d3);
+        v_store(r0 + j, d0); v_store(r1 + j, d1); v_store(r2 + j, d2); v_store(r3 + j, d3);
+    }
+    for (int k = 0; k < 4; k++)
+    {
+        for (int jj = j; jj < cols; jj++)
+            rows[k][jj] += adRows[k][jj - 1] * (rows[k][jj - 1] - rows[k][jj]);
+    }
+
+    //right to left: the block of columns [j - 3, j] is processed from its right column
+    v_float32x4 next(r0[cols - 1], r1[cols - 1], r2[cols - 1], r3[cols - 1]);
+    for (j = cols - 2; j - 3 >= 0; j -= 4)
+    {
+        d0 = v_load(r0 + j - 3); d1 = v_load(r1 + j - 3); d2 = v_load(r2 + j - 3); d3 = v_load(r3 + j - 3);
+        v_transpose4x4(d0, d1, d2, d3, c0, c1, c2, c3);
+        w0 = v_load(a0 + j - 3); w1 = v_load(a1 + j - 3); w2 = v_load(a2 + j - 3); w3 = v_load(a3 + j - 3);
+        v_transpose4x4(w0, w1, w2, w3, b0, b1, b2, b3);
+
+        c3 = c3 + b3 * (next - c3);
+        c2 = c2 + b2 * (c3 - c2);
+        c1 = c1 + b1 * (c2 - c1);
+        c0 = c0 + b0 * (c1 - c0);
+        next = c0;
+
+        v_transpose4x4(c0, c1, c2, c3, d0, d1, d2, d3);
+        v_store(r0 + j - 3, d0); v_store(r1 + j - 3, d1); v_store(r2 + j - 3, d2); v_store(r3 + j - 3, d3);
+    }
+    for (int k = 0; k < 4; k++)
+    {
+        for (int jj = j; jj >= 0; jj--)
+            rows[k][jj] += adRows[k][jj] * (rows[k][jj + 1] - rows[k][jj]);
+    }
+#else
+    for (int k = 0; k < 4; k++)
+    {
+        for (int j = 1; j < cols; j++)
+            rows[k][j] += adRows[k][j - 1] * (rows[k][j - 1] - rows[k][j]);
+        for (int j = cols - 2; j >= 0; j--)
+            rows[k][j] += adRows[k][j] * (rows[k][j + 1] - rows[k][j]);
+    }
+#endif
+}
+
 template <typename WorkVec>
 DTFilterCPU::FilterRF_vertPass<WorkVec>::FilterRF_vertPass(Mat& res_, Mat& alphaD_, int iteration_)
 : res(res_), alphaD(alphaD_), iteration(iteration_)
@@ -447,10 +598,7 @@ void DTFilterCPU::FilterRF_vertPass<WorkVec>::operator()(const Range& range) con
                 adRow[j] *= adRow[j];
         }
 
-        for (int j = rcols.start; j < rcols.end; j++)
-        {
-            curRow[j] += adRow[j] * (prevRow[j] - curRow[j]);
-        }
+        vertRowPass(curRow, prevRow, adRow, rcols);
     }
 
     for (int i = res.rows - 2; i >= 0; i--)
@@ -459,11 +607,31 @@ void DTFilterCPU::FilterRF_vertPass<WorkVec>::operator()(const Range& range) con
         WorkVec     *curRow  = res.ptr<WorkVec>(i);
         DistType    *adRow   = alphaD.ptr<DistType>(i);
 
-        for (int j = rcols.start; j < rcols.end; j++)
+        vertRowPass(curRow, prevRow, adRow, rcols);
+    }
+}
+
+template <typename WorkVec>
+void DTFilterCPU::FilterRF_vertPass<WorkVec>::vertRowPass(WorkVec *curRow, const WorkVec *prevRow, const DistType *adRow, const Range& rcols)
+{
+    int j = rcols.start;
+#if CV_SIMD128
+    //the columns are independent, single channel rows are processed 4 columns at once
+    if (WorkVec::channels == 1)
+    {
+        float *cur = (float*)curRow;
+        const float *prev = (const float*)prevRow;
+        for (; j + 3 < rcols.end; j += 4)
         {
-            curRow[j] += adRow[j] * (prevRow[j] - curRow[j]);
+            v_float32x4 c = v_load(cur + j);
+            v_store(cur + j, c + v_load(adRow + j) * (v_load(prev + j) - c));
         }
     }
+#endif
+    for (; j < rcols.end; j++)
+    {
+        curRow[j] += adRow[j] * (prevRow[j] - curRow[j]);
+    }
 }
 
 template <typename GuideVec>
@@ -4,6 +4,7 @@
 
 #include "precomp.hpp"
 #include "edge_drawing_common.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 using namespace std;
 
@@ -24,6 +25,7 @@ int op;
 bool SumFlag;
 int* grads;
 bool PFmode;
+Mutex* gradsMutex;
 };
 
 void ComputeGradientBody::operator() (const Range& range) const
@@ -33,6 +35,11 @@ void ComputeGradientBody::operator() (const Range& range) const
     int gy = 0;
     int sum;
 
+    // the histogram of the gradient values is collected per stripe and merged once
+    std::vector<int> localGrads;
+    if (PFmode)
+        localGrads.resize(MAX_GRAD_VALUE, 0);
+
     for (int y = range.start; y < range.end; ++y)
     {
         const uchar* srcPrevRow = src[y - 1];
@@ -42,7 +49,77 @@ void ComputeGradientBody::operator() (const Range& range) const
         ushort* gradRow = gradImage[y];
         uchar* dirRow = dirImage[y];
 
-        for (int x = 1; x < last_col; ++x)
+        int x = 1;
+#if CV_SIMD128
+        // |gx| + |gy| fits 16 bits for all the operators, the L2 norm is left to the scalar loop
+        if (SumFlag)
+        {
+            const v_uint16x8 vThresh = v_setall_u16(saturate_cast<ushort>(gradThresh));
+            const v_uint16x8 vVertical = v_setall_u16(EDGE_VERTICAL);
+            const v_uint16x8 vHorizontal = v_setall_u16(EDGE_HORIZONTAL);
+
+            for (; x <= last_col - 8; x += 8)
+            {
+                v_int16x8 vgx, vgy;
+
+                if (op == EdgeDrawing::LSD)
+                {
+                    v_int16x8 c0 = v_reinterpret_as_s16(v_load_expand(srcCurRow + x));
+                    v_int16x8 c1 = v_reinterpret_as_s16(v_load_expand(srcCurRow + x + 1));
+                    v_int16x8 n0 = v_reinterpret_as_s16(v_load_expand(srcNextRow + x));
+                    v_int16x8 n1 = v_reinterpret_as_s16(v_load_expand(srcNextRow + x + 1));
+                    v_int16x8 com1 = n1 - c0;
+                    v_int16x8 com2 = c1 - n0;
+
+                    vgx = com1 + com2;
+                    vgy = com1 - com2;
+                }
+                else
+                {
+                    v_int16x8 p0 = v_reinterpret_as_s16(v_load_expand(srcPrevRow + x - 1));
+                    v_int16x8 p1 = v_reinterpret_as_s16(v_load_expand(srcPrevRow + x));
+                    v_int16x8 p2 = v_reinterpret_as_s16(v_load_expand(srcPrevRow + x + 1));
+                    v_int16x8 c0 = v_reinterpret_as_s16(v_load_expand(srcCurRow + x - 1));
+                    v_int16x8 c2 = v_reinterpret_as_s16(v_load_expand(srcCurRow + x + 1));
+                    v_int16x8 n0 = v_reinterpret_as_s16(v_load_expand(srcNextRow + x - 1));
+                    v_int16x8 n1 = v_reinterpret_as_s16(v_load_expand(srcNextRow + x));
+                    v_int16x8 n2 = v_reinterpret_as_s16(v_load_expand(srcNextRow + x + 1));
+                    v_int16x8 com1 = n2 - p0;
+                    v_int16x8 com2 = p2 - n0;
+                    v_int16x8 dx = c2 - c0;
+                    v_int16x8 dy = n1 - p1;
+
+                    if (op == EdgeDrawing::PREWITT)
+                    {
+                        vgx = com1 + com2 + dx;
+                        vgy = com1 - com2 + dy;
+                    }
+                    else if (op == EdgeDrawing::SOBEL)
+                    {
+                        vgx = com1 + com2 + dx + dx;
+                        vgy = com1 - com2 + dy + dy;
+                    }
+                    else
+                    {
+                        const v_int16x8 v3 = v_setall_s16(3), v10 = v_setall_s16(10);
+                        vgx = (com1 + com2) * v3 + dx * v10;
+                        vgy = (com1 - com2) * v3 + dy * v10;
+                    }
+                }
+
+                v_uint16x8 agx = v_abs(vgx);
+                v_uint16x8 agy = v_abs(vgy);
+                v_uint16x8 vsum = agx + agy;
+                v_store(gradRow + x, vsum);
+
+                // the direction is written for the edge pixels only, as in the scalar loop
+                v_uint16x8 vdir = v_select(agx >= agy, vVertical, vHorizontal);
+                vdir = v_select(vsum >= vThresh, vdir, v_load_expand(dirRow + x));
+                v_pack_store(dirRow + x, vdir);
+            }
+        }
+#endif
+        for (; x < last_col; ++x)
         {
             int com1 = srcNextRow[x + 1] - srcPrevRow[x - 1];
             int com2 = srcPrevRow[x + 1] - srcNextRow[x - 1];
@@ -78,9 +155,6 @@ void ComputeGradientBody::operator() (const Range& range) const
 
             gradRow[x] = (ushort)sum;
 
-            if (PFmode)
-                grads[sum]++;
-
             if (sum >= gradThresh)
             {
                 if (gx >= gy)
@@ -89,6 +163,19 @@ void ComputeGradientBody::operator() (const Range& range) const
                     dirRow[x] = EDGE_HORIZONTAL;
             }
         }
+
+        if (PFmode)
+        {
+            for (x = 1; x < last_col; ++x)
+                localGrads[gradRow[x]]++;
+        }
+    }
+
+    if (PFmode)
+    {
+        AutoLock lock(*gradsMutex);
+        for (int i = 0; i < MAX_GRAD_VALUE; i++)
+            grads[i] += localGrads[i];
     }
 }
 
@@ -121,6 +208,7 @@ protected:
     uchar *srcImg;
     vector<vector<Point> > segmentPoints;
     Mat smoothImage;
+    Mat smoothBuffer; // owned storage of the smoothed image, smoothImage may also refer to the source
     uchar *edgeImg;   // pointer to edge image data
     uchar *smoothImg; // pointer to smoothed image data
     int segmentNos;
@@ -142,8 +230,16 @@ private:
 
     int anchorNos;
     vector<Point> anchorPoints;
+    vector<vector<Point> > rowAnchorPoints;
     vector<Point> edgePoints;
 
+    // Linking buffers, they are kept between the calls on the images of the same size
+    vector<int> chainNosBuffer;
+    vector<Point> pixelsBuffer;
+    vector<StackNode> stackBuffer;
+    vector<Chain> chainsBuffer;
+    vector<int> anchorCounts;
+
     Mat edgeImage;
     Mat gradImage;
     Mat dirImage;
@@ -164,7 +260,7 @@ private:
     NFALUT* nfa;
 
     int ComputeMinLineLength();
-    void SplitSegment2Lines(double* x, double* y, int noPixels, int segmentNo);
+    void SplitSegment2Lines(double* x, double* y, int noPixels, int segmentNo, std::vector<EDLineSegment>& segmentLines) const;
     void JoinCollinearLines();
 
     void ValidateLineSegments();
@@ -368,16 +464,22 @@ void EdgeDrawingImpl::detectEdges(InputArray src)
     height = srcImage.rows;
     width = srcImage.cols;
 
-    edgeImage = Mat(height, width, CV_8UC1, Scalar(0)); // initialize edge Image
-    gradImage = Mat(height, width, CV_16UC1); // gradImage contains short values
-    dirImage = Mat(height, width, CV_8UC1);
+    // create() keeps the buffers of the previous call when the size does not change
+    edgeImage.create(height, width, CV_8UC1);
+    edgeImage.setTo(Scalar(0)); // initialize edge Image
+    gradImage.create(height, width, CV_16UC1); // gradImage contains short values
+    dirImage.create(height, width, CV_8UC1);
 
     if (params.Sigma < 1.0)
         smoothImage = srcImage;
-    else if (params.Sigma == 1.0)
-        GaussianBlur(srcImage, smoothImage, Size(5, 5), params.Sigma);
     else
-        GaussianBlur(srcImage, smoothImage, Size(), params.Sigma); // calculate kernel from sigma
+    {
+        if (params.Sigma == 1.0)
+            GaussianBlur(srcImage, smoothBuffer, Size(5, 5), params.Sigma);
+        else
+            GaussianBlur(srcImage, smoothBuffer, Size(), params.Sigma); // calculate kernel from sigma
+        smoothImage = smoothBuffer;
+    }
 
     // Assign Pointers from Mat's data
     smoothImg = smoothImage.data;
@@ -462,61 +564,130 @@ void EdgeDrawingImpl::ComputeGradient()
     body.grads = grads;
     body.PFmode = params.PFmode;
 
-    parallel_for_(Range(1, smoothImage.rows - 1), body);
+    Mutex gradsMutex;
+    body.gradsMutex = &gradsMutex;
+
+    // every stripe of the PF mode allocates its own histogram, so the stripes are kept coarse
+    double nstripes = params.PFmode ? (double)std::max(getNumThreads(), 1) * 4 : -1.;
+    parallel_for_(Range(1, smoothImage.rows - 1), body, nstripes);
 }
 
 void EdgeDrawingImpl::ComputeAnchorPoints()
 {
-    for (int i = 2; i < height - 2; i++)
+    anchorPoints.clear();
+    rowAnchorPoints.resize(height);
+
+    // The rows are scanned in parallel, their anchors are concatenated in the row order afterwards
+    parallel_for_(Range(2, std::max(height - 2, 2)), [&](const Range& range)
     {
-        int start = 2;
-        int inc = 1;
-        if (i % params.ScanInterval != 0)
+        for (int i = range.start; i < range.end; i++)
         {
-            start = params.ScanInterval;
-            inc = params.ScanInterval;
-        }
+            vector<Point>& rowAnchors = rowAnchorPoints[i];
+            rowAnchors.clear();
 
-        for (int j = start; j < width - 2; j += inc)
-        {
-            if (gradImg[i * width + j] < gradThresh)
-                continue;
+            int start = 2;
+            int inc = 1;
+            if (i % params.ScanInterval != 0)
+            {
+                start = params.ScanInterval;
+                inc = params.ScanInterval;
+            }
+
+            const ushort* gradRow = gradImg + i * width;
+            const ushort* gradPrevRow = gradRow - width;
+            const ushort* gradNextRow = gradRow + width;
+            const uchar* dirRow = dirImg + i * width;
+            uchar* edgeRow = edgeImg + i * width;
 
-            if (dirImg[i * width + j] == EDGE_VERTICAL)
+            int j = start;
+#if CV_SIMD128
+            if (inc == 1)
             {
-                // vertical edge
-                int diff1 = gradImg[i * width + j] - gradImg[i * width + j - 1];
-                int diff2 = gradImg[i * width + j] - gradImg[i * width + j + 1];
-                if (diff1 >= anchorThresh && diff2 >= anchorThresh)
+                // gradient values are below 2^15, so their differences fit 16 bit signed lanes
+                const v_uint16x8 vGradThresh = v_setall_u16(saturate_cast<ushort>(gradThresh));
+                const v_int16x8 vAnchorThresh = v_setall_s16(saturate_cast<short>(anchorThresh));
+                const v_uint16x8 vVertical = v_setall_u16(EDGE_VERTICAL);
+
+                for (; j <= width - 10; j += 8)
                 {
-                    edgeImg[i * width + j] = ANCHOR_PIXEL;
-                    anchorPoints.push_back(Point(j, i));
+                    v_uint16x8 g = v_load(gradRow + j);
+                    v_int16x8 sg = v_reinterpret_as_s16(g);
+
+                    v_int16x8 diffLeft = sg - v_reinterpret_as_s16(v_load(gradRow + j - 1));
+                    v_int16x8 diffRight = sg - v_reinterpret_as_s16(v_load(gradRow + j + 1));
+                    v_int16x8 diffUp = sg - v_reinterpret_as_s16(v_load(gradPrevRow + j));
+                    v_int16x8 diffDown = sg - v_reinterpret_as_s16(v_load(gradNextRow + j));
+
+                    v_uint16x8 vertical = v_load_expand(dirRow + j) == vVertical;
+                    v_uint16x8 verticalPeak = v_reinterpret_as_u16((diffLeft >= vAnchorThresh) & (diffRight >= vAnchorThresh));
+                    v_uint16x8 horizontalPeak = v_reinterpret_as_u16((diffUp >= vAnchorThresh) & (diffDown >= vAnchorThresh));
+                    v_uint16x8 anchor = (g >= vGradThresh) & v_select(vertical, verticalPeak, horizontalPeak);
+
+                    int mask = v_signmask(anchor);
+                    for (int k = 0; mask != 0; k++, mask >>= 1)
+                    {
+                        if (mask & 1)
+                        {
+                            edgeRow[j + k] = ANCHOR_PIXEL;
+                            rowAnchors.push_back(Point(j + k, i));
+                        }
+                    }
                 }
             }
-            else
+#endif
+            for (; j < width - 2; j += inc)
             {
-                // horizontal edge
-                int diff1 = gradImg[i * width + j] - gradImg[(i - 1) * width + j];
-                int diff2 = gradImg[i * width + j] - gradImg[(i + 1) * width + j];
-                if (diff1 >= anchorThresh && diff2 >= anchorThresh)
+                if (gradRow[j] < gradThresh)
+                    continue;
+
+                if (dirRow[j] == EDGE_VERTICAL)
+                {
+                    // vertical edge
+                    int diff1 = gradRow[j] - gradRow[j - 1];
+                    int diff2 = gradRow[j] - gradRow[j + 1];
+                    if (diff1 >= anchorThresh && diff2 >= anchorThresh)
+                    {
+                        edgeRow[j] = ANCHOR_PIXEL;
+                        rowAnchors.push_back(Point(j, i));
+                    }
+                }
+                else
                 {
-                    edgeImg[i * width + j] = ANCHOR_PIXEL;
-                    anchorPoints.push_back(Point(j, i));
+                    // horizontal edge
+                    int diff1 = gradRow[j] - gradPrevRow[j];
+                    int diff2 = gradRow[j] - gradNextRow[j];
+                    if (diff1 >= anchorThresh && diff2 >= anchorThresh)
+                    {
+                        edgeRow[j] = ANCHOR_PIXEL;
+                        rowAnchors.push_back(Point(j, i));
+                    }
                 }
             }
         }
-    }
+    });
+
+    size_t total = 0;
+    for (int i = 2; i < height - 2; i++)
+        total += rowAnchorPoints[i].size();
+
+    anchorPoints.reserve(total);
+    for (int i = 2; i < height - 2; i++)
+        anchorPoints.insert(anchorPoints.end(), rowAnchorPoints[i].begin(), rowAnchorPoints[i].end());
 
     anchorNos = (int)anchorPoints.size(); // get the total number of anchor points
 }
 
 void EdgeDrawingImpl::JoinAnchorPointsUsingSortedAnchors()
 {
-    int* chainNos = new int[(width + height) * 8];
+    chainNosBuffer.resize((size_t)(width + height) * 8);
+    pixelsBuffer.resize((size_t)width * height);
+    stackBuffer.resize((size_t)width * height);
+    chainsBuffer.resize((size_t)width * height);
 
-    Point* pixels = new Point[width * height];
-    StackNode* stack = new StackNode[width * height];
-    Chain* chains = new Chain[width * height];
+    int* chainNos = chainNosBuffer.data();
+    Point* pixels = pixelsBuffer.data();
+    StackNode* stack = stackBuffer.data();
+    Chain* chains = chainsBuffer.data();
 
     // sort the anchor points by their gradient value in decreasing order
     int* pAnchors = sortAnchorsByGradValue1();
@@ -1167,17 +1338,13 @@ StartOfWhile:
 
     // Clean up
     delete[] pAnchors;
-    delete[] chains;
-    delete[] stack;
-    delete[] chainNos;
-    delete[] pixels;
 }
 
 int* EdgeDrawingImpl::sortAnchorsByGradValue1()
 {
     int SIZE = 128 * 256;
-    int* C = new int[SIZE];
-    memset(C, 0, sizeof(int) * SIZE);
+    anchorCounts.assign(SIZE, 0);
+    int* C = &anchorCounts[0];
 
     // Count the number of grad values
     for (int i = 1; i < height - 1; i++)
@@ -1212,7 +1379,6 @@ int* EdgeDrawingImpl::sortAnchorsByGradValue1()
         }
     }
 
-    delete[] C;
     return A;
 }
 
@@ -1283,23 +1449,35 @@ void EdgeDrawingImpl::detectLines(OutputArray _lines)
     if (min_line_len < 9) // avoids small line segments in the result. Might be deleted!
         min_line_len = 9;
 
-    // Temporary buffers used during line fitting
-    double* x = new double[(width + height) * 8];
-    double* y = new double[(width + height) * 8];
-
-    linesNo = 0;
+    // The segments are split to lines in parallel, the lines are gathered in the segment order
+    const int noSegments = (int)segmentPoints.size();
+    std::vector<std::vector<EDLineSegment> > segmentLines(noSegments);
 
-    // Use the whole segment
-    for (size_t segmentNumber = 0; segmentNumber < segmentPoints.size(); segmentNumber++)
+    parallel_for_(Range(0, noSegments), [&](const Range& range)
     {
-        std::vector<Point> segment = segmentPoints[segmentNumber];
-        for (int k = 0; k < (int)segment.size(); k++)
+        // Temporary buffers used during line fitting
+        std::vector<double> x, y;
+
+        // Use the whole segment
+        for (int segmentNumber = range.start; segmentNumber < range.end; segmentNumber++)
         {
-            x[k] = segment[k].x;
-            y[k] = segment[k].y;
+            const std::vector<Point>& segment = segmentPoints[segmentNumber];
+            int noPixels = (int)segment.size();
+            x.resize(noPixels);
+            y.resize(noPixels);
+            for (int k = 0; k < noPixels; k++)
+            {
+                x[k] = segment[k].x;
+                y[k] = segment[k].y;
+            }
+            SplitSegment2Lines(x.data(), y.data(), noPixels, segmentNumber, segmentLines[segmentNumber]);
         }
-        SplitSegment2Lines(x, y, (int)segment.size(), (int)segmentNumber);
-    }
+    });
+
+    lines.clear();
+    for (int i = 0; i < noSegments; i++)
+        lines.insert(lines.end(), segmentLines[i].begin(), segmentLines[i].end());
+    linesNo = (int)lines.size();
 
     JoinCollinearLines();
 
@@ -1318,8 +1496,6 @@ void EdgeDrawingImpl::detectLines(OutputArray _lines)
         linePoints.push_back(line);
     }
     Mat(linePoints).copyTo(_lines);
-    delete[] x;
-    delete[] y;
 }
 
 // Computes the minimum line length using the NFA formula given width & height values
@@ -1339,7 +1515,7 @@ int EdgeDrawingImpl::ComputeMinLineLength()
 // Given a full segment of pixels, splits the chain to lines
 // This code is used when we use the whole segment of pixels
 //
-void EdgeDrawingImpl::SplitSegment2Lines(double* x, double* y, int noPixels, int segmentNo)
+void EdgeDrawingImpl::SplitSegment2Lines(double* x, double* y, int noPixels, int segmentNo, std::vector<EDLineSegment>& segmentLines) const
 {
     // First pixel of the line segment within the segment of points
     int firstPixelIndex = 0;
@@ -1426,8 +1602,7 @@ void EdgeDrawingImpl::SplitSegment2Lines(double* x, double* y, int noPixels, int
                     break;
 
                 // Add the line segment to lines
-                lines.push_back(EDLineSegment(lastA, lastB, lastInvert, sx, sy, ex, ey, segmentNo, firstPixelIndex + noSkippedPixels, index - noSkippedPixels + 1));
-                linesNo++;
+                segmentLines.push_back(EDLineSegment(lastA, lastB, lastInvert, sx, sy, ex, ey, segmentNo, firstPixelIndex + noSkippedPixels, index - noSkippedPixels + 1));
                 len = index + 1;
 
                 break;
@@ -1502,97 +1677,108 @@ void EdgeDrawingImpl::ValidateLineSegments()
         nfa = new NFALUT(lutSize, prob, width, height);
     }
 
-    int* x = new int[(width + height) * 4];
-    int* y = new int[(width + height) * 4];
+    // The lines are validated independently of each other, the valid ones are compacted in order afterwards
+    std::vector<uchar> validLines(linesNo, 0);
 
-    int noValidLines = 0;
-
-    for (int i = 0; i < linesNo; i++)
+    parallel_for_(Range(0, linesNo), [&](const Range& range)
     {
-        EDLineSegment* ls = &lines[i];
+        std::vector<int> x((width + height) * 4);
+        std::vector<int> y((width + height) * 4);
 
-        // Compute Line's angle
-        double lineAngle;
-
-        if (ls->invert == 0)
-        {
-            // y = a + bx
-            lineAngle = atan(ls->b);
-        }
-        else
+        for (int i = range.start; i < range.end; i++)
         {
-            // x = a + by
-            lineAngle = atan(1.0 / ls->b);
-        }
+            EDLineSegment* ls = &lines[i];
+
+            // Compute Line's angle
+            double lineAngle;
+
+            if (ls->invert == 0)
+            {
+                // y = a + bx
+                lineAngle = atan(ls->b);
+            }
+            else
+            {
+                // x = a + by
+                lineAngle = atan(1.0 / ls->b);
+            }
 
-        if (lineAngle < 0)
-            lineAngle += CV_PI;
+            if (lineAngle < 0)
+                lineAngle += CV_PI;
 
-        Point* pixels = &(segmentPoints[ls->segmentNo][0]);
-        int noPixels = ls->len;
+            const Point* pixels = &(segmentPoints[ls->segmentNo][0]);
+            int noPixels = ls->len;
 
-        bool valid = false;
+            bool valid = false;
 
-        // Accept very long lines without testing. They are almost never invalidated.
-        if (ls->len >= 80)
-        {
-            valid = true;
-            // Validate short line segments by a line support region rectangle having width=2
-        }
-        else if (ls->len <= 25)
-        {
-            valid = ValidateLineSegmentRect(x, y, ls);
-        }
-        else
-        {
-            // Longer line segments are first validated by a line support region rectangle having width=1 (for speed)
-            // If the line segment is still invalid, then a line support region rectangle having width=2 is tried
-            // If the line segment fails both tests, it is discarded
-            int aligned = 0;
-            int count = 0;
-            for (int j = 0; j < noPixels; j++)
+            // Accept very long lines without testing. They are almost never invalidated.
+            if (ls->len >= 80)
+            {
+                valid = true;
+                // Validate short line segments by a line support region rectangle having width=2
+            }
+            else if (ls->len <= 25)
             {
-                int r = pixels[j].x;
-                int c = pixels[j].y;
+                valid = ValidateLineSegmentRect(&x[0], &y[0], ls);
+            }
+            else
+            {
+                // Longer line segments are first validated by a line support region rectangle having width=1 (for speed)
+                // If the line segment is still invalid, then a line support region rectangle having width=2 is tried
+                // If the line segment fails both tests, it is discarded
+                int aligned = 0;
+                int count = 0;
+                for (int j = 0; j < noPixels; j++)
+                {
+                    int r = pixels[j].x;
+                    int c = pixels[j].y;
 
-                if (r <= 0 || r >= height - 1 || c <= 0 || c >= width - 1)
-                    continue;
+                    if (r <= 0 || r >= height - 1 || c <= 0 || c >= width - 1)
+                        continue;
 
-                count++;
+                    count++;
 
-                // compute gx & gy using the simple [-1 -1 -1]
-                //                                  [ 1  1  1]  filter in both directions
-                // Faster method below
-                // A B C
-                // D x E
-                // F G H
-                // gx = (C-A) + (E-D) + (H-F)
-                // gy = (F-A) + (G-B) + (H-C)
-                //
-                // To make this faster:
-                // com1 = (H-A)
-                // com2 = (C-F)
-                // Then: gx = com1 + com2 + (E-D) = (H-A) + (C-F) + (E-D) = (C-A) + (E-D) + (H-F)
-                //       gy = com2 - com1 + (G-B) = (H-A) - (C-F) + (G-B) = (F-A) + (G-B) + (H-C)
-                //
-                int com1 = srcImg[(r + 1) * width + c + 1] - srcImg[(r - 1) * width + c - 1];
-                int com2 = srcImg[(r - 1) * width + c + 1] - srcImg[(r + 1) * width + c - 1];
+                    // compute gx & gy using the simple [-1 -1 -1]
+                    //                                  [ 1  1  1]  filter in both directions
+                    // Faster method below
+                    // A B C
+                    // D x E
+                    // F G H
+                    // gx = (C-A) + (E-D) + (H-F)
+                    // gy = (F-A) + (G-B) + (H-C)
+                    //
+                    // To make this faster:
+                    // com1 = (H-A)
+                    // com2 = (C-F)
+                    // Then: gx = com1 + com2 + (E-D) = (H-A) + (C-F) + (E-D) = (C-A) + (E-D) + (H-F)
+                    //       gy = com2 - com1 + (G-B) = (H-A) - (C-F) + (G-B) = (F-A) + (G-B) + (H-C)
+                    //
+                    int com1 = srcImg[(r + 1) * width + c + 1] - srcImg[(r - 1) * width + c - 1];
+                    int com2 = srcImg[(r - 1) * width + c + 1] - srcImg[(r + 1) * width + c - 1];
 
-                int gx = com1 + com2 + srcImg[r * width + c + 1] - srcImg[r * width + c - 1];
-                int gy = com1 - com2 + srcImg[(r + 1) * width + c] - srcImg[(r - 1) * width + c];
+                    int gx = com1 + com2 + srcImg[r * width + c + 1] - srcImg[r * width + c - 1];
+                    int gy = com1 - com2 + srcImg[(r + 1) * width + c] - srcImg[(r - 1) * width + c];
 
-                double pixelAngle = nfa->myAtan2((double)gx, (double)-gy);
-                double diff = fabs(lineAngle - pixelAngle);
+                    double pixelAngle = nfa->myAtan2((double)gx, (double)-gy);
+                    double diff = fabs(lineAngle - pixelAngle);
 
-                if (diff <= precision || diff >= CV_PI - precision)
-                    aligned++;
+                    if (diff <= precision || diff >= CV_PI - precision)
+                        aligned++;
+                }
+
+                // Check validation by NFA computation (fast due to LUT)
+                valid = nfa->checkValidationByNFA(count, aligned) || ValidateLineSegmentRect(&x[0], &y[0], ls);
             }
 
-            // Check validation by NFA computation (fast due to LUT)
-            valid = nfa->checkValidationByNFA(count, aligned) || ValidateLineSegmentRect(x, y, ls);
+            validLines[i] = valid;
         }
+    });
+
+    int noValidLines = 0;
 
-        if (valid)
+    for (int i = 0; i < linesNo; i++)
+    {
+        if (validLines[i])
         {
             if (i != noValidLines)
                 lines[noValidLines] = lines[i];
@@ -1601,9 +1787,6 @@ void EdgeDrawingImpl::ValidateLineSegments()
     }
 
     linesNo = noValidLines;
-
-    delete[] x;
-    delete[] y;
 }
 
 bool EdgeDrawingImpl::ValidateLineSegmentRect(int* x, int* y, EDLineSegment* ls)
@@ -2440,83 +2623,150 @@ void EdgeDrawingImpl::detectEllipses(OutputArray ellipses)
 
 #define CIRCLE_MIN_LINE_LEN 6
 
-    for (int i = 0; i < segmentNos; i++)
+    // The segments are fitted in parallel, their circles, ellipses and lines are gathered
+    // in the segment order below, so the candidates are the same as the ones of a sequential scan
+    enum SegmentFitType { SEGMENT_SKIPPED, SEGMENT_CIRCLE, SEGMENT_ELLIPSE, SEGMENT_LINES };
+    struct SegmentFit
     {
-        // Make note of the starting line number for this segment
-        segmentStartLines[i] = (int)lines.size();
-
-        int noPixels = (int)segmentPoints[i].size();
-
-        if (noPixels < 2 * CIRCLE_MIN_LINE_LEN)
-            continue;
+        SegmentFitType type;
+        double xc, yc, r, circleFitError;
+        EllipseEquation eq;
+        double ellipseFitError;
+        std::vector<EDLineSegment> lines;
+    };
+    std::vector<SegmentFit> segmentFits(segmentNos);
 
-        double* x = bm->getX();
-        double* y = bm->getY();
+    parallel_for_(Range(0, segmentNos), [&](const Range& range)
+    {
+        std::vector<double> xBuffer, yBuffer;
 
-        for (int j = 0; j < noPixels; j++)
+        for (int i = range.start; i < range.end; i++)
         {
-            x[j] = segmentPoints[i][j].x;
-            y[j] = segmentPoints[i][j].y;
-        }
+            SegmentFit& fit = segmentFits[i];
+            fit.type = SEGMENT_SKIPPED;
 
-        // If the segment is reasonably long, then see if the segment traverses the boundary of a closed shape
-        if (noPixels >= 4 * CIRCLE_MIN_LINE_LEN)
-        {
-            // If the end-points of the segment is close to each other, then assume a circular/elliptic structure
-            double dx = x[0] - x[noPixels - 1];
-            double dy = y[0] - y[noPixels - 1];
-            double d = sqrt(dx * dx + dy * dy);
-            double r = noPixels / CV_2PI;      // Assume a complete circle
+            int noPixels = (int)segmentPoints[i].size();
+
+            if (noPixels < 2 * CIRCLE_MIN_LINE_LEN)
+                continue;
 
-            double maxDistanceBetweenEndPoints = std::max(3.0, r / 4.0);
+            xBuffer.resize(noPixels);
+            yBuffer.resize(noPixels);
+            double* x = xBuffer.data();
+            double* y = yBuffer.data();
 
-            // If almost closed loop, then try to fit a circle/ellipse
-            if (d <= maxDistanceBetweenEndPoints)
+            for (int j = 0; j < noPixels; j++)
             {
-                double xc, yc, circleFitError = 1e10;
+                x[j] = segmentPoints[i][j].x;
+                y[j] = segmentPoints[i][j].y;
+            }
 
-                CircleFit(x, y, noPixels, &xc, &yc, &r, &circleFitError);
+            // If the segment is reasonably long, then see if the segment traverses the boundary of a closed shape
+            if (noPixels >= 4 * CIRCLE_MIN_LINE_LEN)
+            {
+                // If the end-points of the segment is close to each other, then assume a circular/elliptic structure
+                double dx = x[0] - x[noPixels - 1];
+                double dy = y[0] - y[noPixels - 1];
+                double d = sqrt(dx * dx + dy * dy);
+                double r = noPixels / CV_2PI;      // Assume a complete circle
 
-                EllipseEquation eq;
-                double ellipseFitError = 1e10;
+                double maxDistanceBetweenEndPoints = std::max(3.0, r / 4.0);
 
-                if (circleFitError > LONG_ARC_ERROR)
+                // If almost closed loop, then try to fit a circle/ellipse
+                if (d <= maxDistanceBetweenEndPoints)
                 {
-                    // Try fitting an ellipse
-                    if (EllipseFit(x, y, noPixels, &eq))
-                        ellipseFitError = ComputeEllipseError(&eq, x, y, noPixels);
-                }
+                    double xc, yc, circleFitError = 1e10;
 
-                if (circleFitError <= LONG_ARC_ERROR)
-                {
-                    addCircle(circles1, noCircles1, xc, yc, r, circleFitError, x, y, noPixels);
-                    bm->move(noPixels);
-                    continue;
-                }
-                else if (ellipseFitError <= ELLIPSE_ERROR)
-                {
-                    double major, minor;
-                    ComputeEllipseCenterAndAxisLengths(&eq, &xc, &yc, &major, &minor);
+                    CircleFit(x, y, noPixels, &xc, &yc, &r, &circleFitError);
+
+                    EllipseEquation eq;
+                    double ellipseFitError = 1e10;
 
-                    // Assume major is longer. Otherwise, swap
-                    if (minor > major)
+                    if (circleFitError > LONG_ARC_ERROR)
                     {
-                        double tmp = major;
-                        major = minor;
-                        minor = tmp;
+                        // Try fitting an ellipse
+                        if (EllipseFit(x, y, noPixels, &eq))
+                            ellipseFitError = ComputeEllipseError(&eq, x, y, noPixels);
                     }
 
-                    if (major < 8 * minor)
+                    fit.xc = xc;
+                    fit.yc = yc;
+                    fit.r = r;
+                    fit.circleFitError = circleFitError;
+
+                    if (circleFitError <= LONG_ARC_ERROR)
                     {
-                        addCircle(circles1, noCircles1, xc, yc, r, circleFitError, &eq, ellipseFitError, x, y, noPixels);
-                        bm->move(noPixels);
+                        fit.type = SEGMENT_CIRCLE;
+                        continue;
+                    }
+                    else if (ellipseFitError <= ELLIPSE_ERROR)
+                    {
+                        double major, minor;
+                        ComputeEllipseCenterAndAxisLengths(&eq, &xc, &yc, &major, &minor);
+
+                        // Assume major is longer. Otherwise, swap
+                        if (minor > major)
+                        {
+                            double tmp = major;
+                            major = minor;
+                            minor = tmp;
+                        }
+
+                        if (major < 8 * minor)
+                        {
+                            fit.type = SEGMENT_ELLIPSE;
+                            fit.xc = xc;
+                            fit.yc = yc;
+                            fit.eq = eq;
+                            fit.ellipseFitError = ellipseFitError;
+                        }
+                        continue;
                     }
-                    continue;
                 }
             }
+            // Otherwise, split to lines
+            fit.type = SEGMENT_LINES;
+            SplitSegment2Lines(x, y, noPixels, i, fit.lines);
+        }
+    });
+
+    for (int i = 0; i < segmentNos; i++)
+    {
+        // Make note of the starting line number for this segment
+        segmentStartLines[i] = (int)lines.size();
+
+        const SegmentFit& fit = segmentFits[i];
+
+        if (fit.type == SEGMENT_LINES)
+        {
+            lines.insert(lines.end(), fit.lines.begin(), fit.lines.end());
+            continue;
+        }
+
+        if (fit.type == SEGMENT_SKIPPED)
+            continue;
+
+        // The circles keep pointers to their pixels, so these are copied to the buffer manager
+        int noPixels = (int)segmentPoints[i].size();
+        double* x = bm->getX();
+        double* y = bm->getY();
+
+        for (int j = 0; j < noPixels; j++)
+        {
+            x[j] = segmentPoints[i][j].x;
+            y[j] = segmentPoints[i][j].y;
+        }
+
+        if (fit.type == SEGMENT_CIRCLE)
+        {
+            addCircle(circles1, noCircles1, fit.xc, fit.yc, fit.r, fit.circleFitError, x, y, noPixels);
+        }
+        else
+        {
+            EllipseEquation eq = fit.eq;
+            addCircle(circles1, noCircles1, fit.xc, fit.yc, fit.r, fit.circleFitError, &eq, fit.ellipseFitError, x, y, noPixels);
         }
-        // Otherwise, split to lines
-        SplitSegment2Lines(x, y, noPixels, i);
+        bm->move(noPixels);
     }
 
     min_line_len = params.MinLineLength;
@@ -2597,7 +2847,10 @@ void EdgeDrawingImpl::detectEllipses(OutputArray ellipses)
     //----------------------------- VALIDATE CIRCLES --------------------------
     noCircles2 = 0;
     circles2 = new Circle[maxNoOfCircles];
-    GaussianBlur(srcImage, smoothImage, Size(), 0.50); // calculate kernel from sigma;
+    // the source is never blurred in place, smoothImage refers to it when Sigma < 1
+    GaussianBlur(srcImage, smoothBuffer, Size(), 0.50); // calculate kernel from sigma;
+    smoothImage = smoothBuffer;
+    smoothImg = smoothImage.data;
 
     ValidateCircles(params.NFAValidation);
 
@@ -160,18 +160,22 @@ private:
     vector<float> _scaleNorm;
     float _sxStep, _ayStep, _xyStepRatio;
 
-    // data structures for efficiency (see scoreBox)
-    Mat _sWts;
-    Mat _sDone, _sMap, _sIds;
-    int _sId;
+    // per-thread scratch of scoreBox(), indexed by segment id
+    struct ScoreBuffers
+    {
+        ScoreBuffers(int n) : sWts(n, 0.f), sDone(n, -1), sMap(n, 0), sIds(n, 0), sId(0) {}
+        vector<float> sWts;
+        vector<int> sDone, sMap, sIds;
+        int sId;
+    };
 
     // helper routines
     static bool boxesCompare(const Box &a, const Box &b) { return a.score < b.score; }
     void clusterEdges(Mat &edgeMap, Mat &orientationMap);
     void prepDataStructs(Mat &edgeMap);
     void scoreAllBoxes(Boxes &boxes);
-    void scoreBox(Box &box);
-    void refineBox(Box &box);
+    void scoreBox(Box &box, ScoreBuffers &buf, float pruneScore) const;
+    void refineBox(Box &box, ScoreBuffers &buf) const;
     float boxesOverlap(Box &a, Box &b);
     void boxesNms(Boxes &boxes, float thr, float eta, int maxBoxes);
 };
@@ -531,6 +535,7 @@ void EdgeBoxesImpl::prepDataStructs(Mat &edgeMap)
     for (y = 0; y < h; y++)
     {
         s = 0;
+        _hIdxs[y].clear();
         _hIdxs[y].push_back(s);
         for (x = 0; x < w; x++)
         {
@@ -549,6 +554,7 @@ void EdgeBoxesImpl::prepDataStructs(Mat &edgeMap)
     for (x = 0; x < w; x++)
     {
         s = 0;
+        _vIdxs[x].clear();
         _vIdxs[x].push_back(s);
         for (y = 0; y < h; y++)
         {
@@ -561,25 +567,19 @@ void EdgeBoxesImpl::prepDataStructs(Mat &edgeMap)
             _vIdxImg.at<int>(x, y) = (int)_vIdxs[x].size() - 1;
         }
     }
-
-    // initialize scoreBox() data structures
-    int n = _segCnt + 1;
-    _sWts = Mat::zeros(n, 1, DataType<float>::type);
-    _sDone = Mat(n, 1, DataType<int>::type,Scalar(-1));
-    _sMap = Mat::zeros(n, 1, DataType<int>::type);
-    _sIds = Mat::zeros(n, 1, DataType<int>::type);
-    _sId = 0;
 }
 
 
-void EdgeBoxesImpl::scoreBox(Box &box)
+// Scores box; boxes whose upper bound (edge magnitude inside the box minus the
+// middle quarter) does not exceed pruneScore get score 0 without tracing segments.
+void EdgeBoxesImpl::scoreBox(Box &box, ScoreBuffers &buf, float pruneScore) const
 {
     int i, j, k, q, bh, bw, y0, x0, y1, x1, y0m, y1m, x0m, x1m;
-    float *sWts = (float *)_sWts.data;
-    int *sDone = (int *)_sDone.data;
-    int *sMap = (int *)_sMap.data;
-    int *sIds = (int *)_sIds.data;
-    int sId = _sId++;
+    float *sWts = &buf.sWts[0];
+    int *sDone = &buf.sDone[0];
+    int *sMap = &buf.sMap[0];
+    int *sIds = &buf.sIds[0];
+    int sId = buf.sId++;
 
     // add edge count inside box
     y1 = clamp(box.y + box.h, 0, h - 1);
@@ -604,7 +604,7 @@ void EdgeBoxesImpl::scoreBox(Box &box)
     // short circuit computation if impossible to score highly
     float norm = _scaleNorm[bw + bh];
     box.score = v * norm;
-    if (box.score < _minScore)
+    if (box.score < _minScore || box.score <= pruneScore)
     {
         box.score = 0;
         return;
@@ -708,7 +708,7 @@ void EdgeBoxesImpl::scoreBox(Box &box)
 }
 
 
-void EdgeBoxesImpl::refineBox(Box &box)
+void EdgeBoxesImpl::refineBox(Box &box, ScoreBuffers &buf) const
 {
     int yStep = (int)(box.h * _xyStepRatio);
     int xStep = (int)(box.w * _xyStepRatio);
@@ -725,53 +725,53 @@ void EdgeBoxesImpl::refineBox(Box &box)
         B = box;
         B.y = box.y - yStep;
         B.h = B.h + yStep;
-        scoreBox(B);
+        scoreBox(B, buf, box.score);
 
         if (B.score <= box.score)
         {
             B = box;
             B.y = box.y + yStep;
             B.h = B.h - yStep;
-            scoreBox(B);
+            scoreBox(B, buf, box.score);
         }
         if (B.score > box.score) box = B;
         // search over y end
         B = box;
         B.h = B.h + yStep;
-        scoreBox(B);
+        scoreBox(B, buf, box.score);
 
         if (B.score <= box.score)
         {
             B = box;
             B.h = B.h - yStep;
-            scoreBox(B);
+            scoreBox(B, buf, box.score);
         }
         if (B.score > box.score) box = B;
         // search over x start
         B = box;
         B.x = box.x - xStep;
         B.w = B.w + xStep;
-        scoreBox(B);
+        scoreBox(B, buf, box.score);
 
         if (B.score <= box.score)
         {
             B = box;
             B.x = box.x + xStep;
             B.w = B.w - xStep;
-            scoreBox(B);
+            scoreBox(B, buf, box.score);
         }
 
         if (B.score > box.score) box = B;
         // search over x end
         B = box;
         B.w = B.w + xStep;
-        scoreBox(B);
+        scoreBox(B, buf, box.score);
 
         if (B.score <= box.score)
         {
             B = box;
             B.w = B.w - xStep;
-            scoreBox(B);
+            scoreBox(B, buf, box.score);
         }
         if (B.score > box.score) box = B;
     }
@@ -814,14 +814,22 @@ void EdgeBoxesImpl::scoreAllBoxes(Boxes &boxes)
     }
 
     // score all boxes, refine top candidates
-    int i, k = 0, m = (int)boxes.size();
-    for (i = 0; i < m; i++)
+    int m = (int)boxes.size();
+    int nSeg = _segCnt + 1;
+    parallel_for_(Range(0, m), [&](const Range& range)
     {
-        scoreBox(boxes[i]);
-        if (!boxes[i].score) continue;
-        k++;
-        refineBox(boxes[i]);
-    }
+        ScoreBuffers buf(nSeg);
+        for (int i = range.start; i < range.end; i++)
+        {
+            scoreBox(boxes[i], buf, -1.f);
+            if (boxes[i].score)
+                refineBox(boxes[i], buf);
+        }
+    }, std::max(1, m / 256));
+
+    int k = 0;
+    for (int i = 0; i < m; i++)
+        if (boxes[i].score) k++;
     sort(boxes.rbegin(), boxes.rend(), boxesCompare);
     boxes.resize(k);
 }
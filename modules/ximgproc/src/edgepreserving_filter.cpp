@@ -16,6 +16,8 @@ using namespace std;
 void edgePreservingFilter(InputArray _src, OutputArray _dst, int d,
                           double threshold)
 {
+    CV_INSTRUMENT_REGION();
+
     CV_Assert(_src.type() == CV_8UC3);
 
     Mat src = _src.getMat();
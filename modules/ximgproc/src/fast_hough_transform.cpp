@@ -42,6 +42,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/hal.hpp"
 
 namespace cv { namespace ximgproc {
 
@@ -49,46 +50,136 @@ namespace cv { namespace ximgproc {
     typedef __int32 int32_t;
 #endif
 
+// The lines of the butterfly are merged by the HAL kernels directly,
+// a Mat header and an arithm_op dispatch per line segment are too much for the short segments
+#define DEFINE_HOUGH_HAL(T, suffix)                                             \
+    static inline void houghAdd(T *pDst, const T *pSrc0, const T *pSrc1, int len) \
+    {                                                                           \
+        const size_t step = len * sizeof(T);                                    \
+        hal::add##suffix(pSrc0, step, pSrc1, step, pDst, step, len, 1, 0);      \
+    }                                                                           \
+    static inline void houghMin(T *pDst, const T *pSrc0, const T *pSrc1, int len) \
+    {                                                                           \
+        const size_t step = len * sizeof(T);                                    \
+        hal::min##suffix(pSrc0, step, pSrc1, step, pDst, step, len, 1, 0);      \
+    }                                                                           \
+    static inline void houghMax(T *pDst, const T *pSrc0, const T *pSrc1, int len) \
+    {                                                                           \
+        const size_t step = len * sizeof(T);                                    \
+        hal::max##suffix(pSrc0, step, pSrc1, step, pDst, step, len, 1, 0);      \
+    }                                                                           \
+    static inline void houghAve(T *pDst, const T *pSrc0, const T *pSrc1, int len) \
+    {                                                                           \
+        const size_t step = len * sizeof(T);                                    \
+        double scalars[] = { 0.5, 0.5, 0.0 };                                   \
+        hal::addWeighted##suffix(pSrc0, step, pSrc1, step, pDst, step, len, 1,  \
+                                 scalars);                                      \
+    }
+DEFINE_HOUGH_HAL(uchar,  8u)
+DEFINE_HOUGH_HAL(schar,  8s)
+DEFINE_HOUGH_HAL(ushort, 16u)
+DEFINE_HOUGH_HAL(short,  16s)
+DEFINE_HOUGH_HAL(int,    32s)
+DEFINE_HOUGH_HAL(float,  32f)
+DEFINE_HOUGH_HAL(double, 64f)
+#undef DEFINE_HOUGH_HAL
+
 template<typename T, int D, HoughOp Op>
 struct HoughOperator { };
-#define SPECIALIZE_HOUGHOP(TOp, body)                                         \
+#define SPECIALIZE_HOUGHOP(TOp, func)                                         \
     template<typename T, int D>                                               \
     struct HoughOperator<T, D, TOp> {                                         \
         static void operate(T *pDst, T *pSrc0, T* pSrc1, int len) {           \
-            Mat dst (Size(1, len), D, pDst);                                  \
-            Mat src0(Size(1, len), D, pSrc0);                                 \
-            Mat src1(Size(1, len), D, pSrc1);                                 \
-            body;                                                             \
+            if (len > 0)                                                      \
+                func(pDst, pSrc0, pSrc1, len);                                \
         }                                                                     \
     };
-SPECIALIZE_HOUGHOP(FHT_ADD, add(src0, src1, dst));
-SPECIALIZE_HOUGHOP(FHT_MIN, min(src0, src1, dst));
-SPECIALIZE_HOUGHOP(FHT_MAX, max(src0, src1, dst));
-SPECIALIZE_HOUGHOP(FHT_AVE, addWeighted(src0, 0.5, src1, 0.5, 0.0, dst));
+SPECIALIZE_HOUGHOP(FHT_ADD, houghAdd);
+SPECIALIZE_HOUGHOP(FHT_MIN, houghMin);
+SPECIALIZE_HOUGHOP(FHT_MAX, houghMax);
+SPECIALIZE_HOUGHOP(FHT_AVE, houghAve);
 #undef SPECIALIZE_HOUGHOP
 
 //----------------------fht----------------------------------------------------
 
-template <typename T, int D, HoughOp OP>
-void fhtCore(Mat     &img0,
-             Mat     &img1,
-             int32_t  y0,
-             int32_t  h,
-             bool     isPositiveShift,
-             int      level,
-             double   aspl)
+// A node of the recursive butterfly: the lines [y0, y0 + h) are merged from
+// the halves computed on the previous level, only the lines [first, last] of
+// the node are needed for the requested part of the Hough image
+struct FhtNode
+{
+    int32_t y0;
+    int32_t h;
+    int     level;
+    int32_t first;
+    int32_t last;
+};
+
+struct FhtPlan
+{
+    std::vector<std::vector<FhtNode> > nodes;    // nodes of every recursion depth
+    std::vector<std::vector<int> >     rowNodes; // node of every line per depth, -1 if none
+};
+
+static void buildFhtPlan(FhtPlan &plan,
+                         int32_t  y0,
+                         int32_t  h,
+                         int      level,
+                         int      depth,
+                         int32_t  first,
+                         int32_t  last,
+                         int      rows)
 {
-    if (level <= 0)
+    if (level <= 0 || first > last)
         return;
 
     CV_Assert(h > 0);
+    if ((int)plan.nodes.size() <= depth)
+    {
+        plan.nodes.resize(depth + 1);
+        plan.rowNodes.resize(depth + 1, std::vector<int>(rows, -1));
+    }
+
+    const FhtNode node = { y0, h, level, first, last };
+    const int idx = (int)plan.nodes[depth].size();
+    plan.nodes[depth].push_back(node);
+    for (int32_t s = 0; s < h; s++)
+        plan.rowNodes[depth][y0 + s] = idx;
+
+    if (h == 1)
+        return;
+
+    const int32_t k = h >> 1;
+    int au = 2 * k - 2;
+    int ad = 2 * h - 2 * k - 2;
+    int b = h - 1;
+    int d = 2 * h - 2;
+
+    // su and sd do not decrease with s, so the lines needed from the halves are ranges again
+    buildFhtPlan(plan, y0, k, level - 1, depth + 1,
+                 (first * au + b) / d, (last * au + b) / d, rows);
+    buildFhtPlan(plan, y0 + k, h - k, level - 1, depth + 1,
+                 (first * ad + b) / d, (last * ad + b) / d, rows);
+}
+
+template <typename T, int D, HoughOp OP>
+void fhtLine(Mat           &img0,
+             const Mat     &img1,
+             const FhtNode &node,
+             int32_t        s,
+             bool           isPositiveShift,
+             double         aspl)
+{
+    const int32_t y0 = node.y0;
+    const int32_t h = node.h;
+    const int level = node.level;
+
     if (h == 1)
     {
         if ((aspl != 0.0) && (level == 1))
         {
             int w = img0.cols;
             uchar* pLine0 = img0.data + img0.step * y0;
-            uchar* pLine1 = img1.data + img1.step * y0;
+            const uchar* pLine1 = img1.data + img1.step * y0;
             int dLine = cvRound(y0 * aspl);
             dLine = dLine % w;
             dLine = dLine * (int)(img1.elemSize());
@@ -105,10 +196,6 @@ void fhtCore(Mat     &img0,
         return;
     }
     const int32_t k = h >> 1;
-    fhtCore<T, D, OP>(img1, img0, y0, k,
-                      isPositiveShift, level - 1, aspl);
-    fhtCore<T, D, OP>(img1, img0, y0 + k, h - k,
-                      isPositiveShift, level - 1, aspl);
 
     int au = 2 * k - 2;
     int ad = 2 * h - 2 * k - 2;
@@ -117,125 +204,152 @@ void fhtCore(Mat     &img0,
     int w = img0.cols;
     int wm = (h / w + 1) * w;
 
-    for (int32_t s = 0; s < h; s++)
+    int su = (s * au + b) / d;
+    int sd = (s * ad + b) / d;
+    int rd = isPositiveShift ? sd - s : s - sd;
+    rd = (rd + wm) % w;
+    uchar *pLine0 = img0.data + img0.step * (y0 + s);
+    uchar *pLineU = img1.data + img1.step * (y0 + su);
+    uchar *pLineD = img1.data + img1.step * (y0 + k + sd);
+    int w0 = img0.channels() * rd;
+    int w1 = img0.channels() * (w - rd);
+
+    if ((aspl != 0.0) && (level == 1))
     {
-        int su = (s * au + b) / d;
-        int sd = (s * ad + b) / d;
-        int rd = isPositiveShift ? sd - s : s - sd;
-        rd = (rd + wm) % w;
-        uchar *pLine0 = img0.data + img0.step * (y0 + s);
-        uchar *pLineU = img1.data + img1.step * (y0 + su);
-        uchar *pLineD = img1.data + img1.step * (y0 + k + sd);
-        int w0 = img0.channels() * rd;
-        int w1 = img0.channels() * (w - rd);
-
-        if ((aspl != 0.0) && (level == 1))
+        int dU = cvRound((y0 + su) * aspl);
+        dU = dU % w;
+        dU *= img0.channels();
+        int dD = cvRound((y0 + k + sd) * aspl);
+        dD = dD % w;
+        dD *= img0.channels();
+        int wB = w * img0.channels();
+
+        int dX = dD - dU;
+        if (w0 >= dX)
         {
-            int dU = cvRound((y0 + su) * aspl);
-            dU = dU % w;
-            dU *= img0.channels();
-            int dD = cvRound((y0 + k + sd) * aspl);
-            dD = dD % w;
-            dD *= img0.channels();
-            int wB = w * img0.channels();
-
-            int dX = dD - dU;
-            if (w0 >= dX)
+            if (w0 >= dD)
             {
-                if (w0 >= dD)
-                {
-                    HoughOperator<T, D, OP>::operate((T *)pLine0 + dU,
-                                               (T *)pLineU,
-                                               (T *)pLineD + (w0 - dX),
-                                               w1 + dX);
-                    HoughOperator<T, D, OP>::operate((T *)pLine0 + (w1 + dD),
-                                               (T *)pLineU + (w1 + dX),
-                                               (T *)pLineD,
-                                               w0 - dD);
-                    HoughOperator<T, D, OP>::operate((T *)pLine0,
-                                               (T *)pLineU + (wB - dU),
-                                               (T *)pLineD + (w0 - dD),
-                                               dU);
-                }
-                else
-                {
-                    HoughOperator<T, D, OP>::operate((T *)pLine0 + dU,
-                                               (T *)pLineU,
-                                               (T *)pLineD + (w0 - dX),
-                                               wB - dU);
-                    HoughOperator<T, D, OP>::operate((T *)pLine0,
-                                               (T *)pLineU + (wB - dU),
-                                               (T *)pLineD + (w0 + wB - dD),
-                                               dD - w0);
-                    HoughOperator<T, D, OP>::operate((T *)pLine0 + (dD - w0),
-                                               (T *)pLineU + (w1 + dX),
-                                               (T *)pLineD,
-                                               w0 - dX);
-                }
+                HoughOperator<T, D, OP>::operate((T *)pLine0 + dU,
+                                           (T *)pLineU,
+                                           (T *)pLineD + (w0 - dX),
+                                           w1 + dX);
+                HoughOperator<T, D, OP>::operate((T *)pLine0 + (w1 + dD),
+                                           (T *)pLineU + (w1 + dX),
+                                           (T *)pLineD,
+                                           w0 - dD);
+                HoughOperator<T, D, OP>::operate((T *)pLine0,
+                                           (T *)pLineU + (wB - dU),
+                                           (T *)pLineD + (w0 - dD),
+                                           dU);
             }
             else
             {
                 HoughOperator<T, D, OP>::operate((T *)pLine0 + dU,
                                            (T *)pLineU,
-                                           (T *)pLineD + (wB - (dX - w0)),
-                                           dX - w0);
-                HoughOperator<T, D, OP>::operate((T *)pLine0 + (dD - w0),
-                                           (T *)pLineU + (dX - w0),
-                                           (T *)pLineD,
-                                           wB - (dX - w0) - dU);
+                                           (T *)pLineD + (w0 - dX),
+                                           wB - dU);
                 HoughOperator<T, D, OP>::operate((T *)pLine0,
                                            (T *)pLineU + (wB - dU),
-                                           (T *)pLineD + (wB - (dX - w0) - dU),
-                                           dU);
+                                           (T *)pLineD + (w0 + wB - dD),
+                                           dD - w0);
+                HoughOperator<T, D, OP>::operate((T *)pLine0 + (dD - w0),
+                                           (T *)pLineU + (w1 + dX),
+                                           (T *)pLineD,
+                                           w0 - dX);
             }
         }
         else
         {
+            HoughOperator<T, D, OP>::operate((T *)pLine0 + dU,
+                                       (T *)pLineU,
+                                       (T *)pLineD + (wB - (dX - w0)),
+                                       dX - w0);
+            HoughOperator<T, D, OP>::operate((T *)pLine0 + (dD - w0),
+                                       (T *)pLineU + (dX - w0),
+                                       (T *)pLineD,
+                                       wB - (dX - w0) - dU);
             HoughOperator<T, D, OP>::operate((T *)pLine0,
-                                        (T *)pLineU,
-                                        (T *)pLineD + w0,
-                                        w1);
-            HoughOperator<T, D, OP>::operate((T *)pLine0 + w1,
-                                        (T *)pLineU + w1,
-                                        (T *)pLineD,
-                                        w0);
+                                       (T *)pLineU + (wB - dU),
+                                       (T *)pLineD + (wB - (dX - w0) - dU),
+                                       dU);
         }
     }
+    else
+    {
+        HoughOperator<T, D, OP>::operate((T *)pLine0,
+                                    (T *)pLineU,
+                                    (T *)pLineD + w0,
+                                    w1);
+        HoughOperator<T, D, OP>::operate((T *)pLine0 + w1,
+                                    (T *)pLineU + w1,
+                                    (T *)pLineD,
+                                    w0);
+    }
 }
 
+// The recursion is evaluated level by level from the deepest one: the lines
+// of one level depend on the previous level only and are merged in parallel
 template <typename T, int D, HoughOp Op>
-void fhtVoT(Mat    &img0,
-            Mat    &img1,
-            bool    isPositiveShift,
-            double  aspl)
+void fhtVoT(Mat         &img0,
+            Mat         &img1,
+            bool         isPositiveShift,
+            double       aspl,
+            const Range &lines)
 {
     int level = 0;
     for (int thres = 1; img0.rows > thres; thres <<= 1)
         level++;
 
-    fhtCore<T, D, Op>(img0, img1, 0, img0.rows, isPositiveShift, level, aspl);
+    FhtPlan plan;
+    buildFhtPlan(plan, 0, img0.rows, level, 0, lines.start, lines.end - 1, img0.rows);
+
+    for (int depth = (int)plan.nodes.size() - 1; depth >= 0; depth--)
+    {
+        Mat &dst = (depth & 1) ? img1 : img0;
+        const Mat &src = (depth & 1) ? img0 : img1;
+        const std::vector<FhtNode> &nodes = plan.nodes[depth];
+        const std::vector<int> &rowNodes = plan.rowNodes[depth];
+
+        parallel_for_(Range(0, img0.rows), [&](const Range &range)
+        {
+            for (int y = range.start; y < range.end; y++)
+            {
+                const int idx = rowNodes[y];
+                if (idx < 0)
+                    continue;
+
+                const FhtNode &node = nodes[idx];
+                const int32_t s = y - node.y0;
+                if (s < node.first || s > node.last)
+                    continue;
+
+                fhtLine<T, D, Op>(dst, src, node, s, isPositiveShift, aspl);
+            }
+        });
+    }
 }
 
 template <typename T, int D>
-void fhtVo(Mat    &img0,
-           Mat    &img1,
-           bool    isPositiveShift,
-           int     operation,
-           double  aspl)
+void fhtVo(Mat         &img0,
+           Mat         &img1,
+           bool         isPositiveShift,
+           int          operation,
+           double       aspl,
+           const Range &lines)
 {
     switch (operation)
     {
     case FHT_ADD:
-        fhtVoT<T, D, FHT_ADD>(img0, img1, isPositiveShift, aspl);
+        fhtVoT<T, D, FHT_ADD>(img0, img1, isPositiveShift, aspl, lines);
         break;
     case FHT_AVE:
-        fhtVoT<T, D, FHT_AVE>(img0, img1, isPositiveShift, aspl);
+        fhtVoT<T, D, FHT_AVE>(img0, img1, isPositiveShift, aspl, lines);
         break;
     case FHT_MAX:
-        fhtVoT<T, D, FHT_MAX>(img0, img1, isPositiveShift, aspl);
+        fhtVoT<T, D, FHT_MAX>(img0, img1, isPositiveShift, aspl, lines);
         break;
     case FHT_MIN:
-        fhtVoT<T, D, FHT_MIN>(img0, img1, isPositiveShift, aspl);
+        fhtVoT<T, D, FHT_MIN>(img0, img1, isPositiveShift, aspl, lines);
         break;
     default:
         CV_Error_(CV_StsNotImplemented, ("Unknown operation %d", operation));
@@ -243,35 +357,36 @@ void fhtVo(Mat    &img0,
     }
 }
 
-static void fhtVo(Mat    &img0,
-                  Mat    &img1,
-                  bool    isPositiveShift,
-                  int     operation,
-                  double  aspl)
+static void fhtVo(Mat         &img0,
+                  Mat         &img1,
+                  bool         isPositiveShift,
+                  int          operation,
+                  double       aspl,
+                  const Range &lines)
 {
     int const depth = img0.depth();
     switch (depth)
     {
     case CV_8U:
-        fhtVo<uchar, CV_8UC1>(img0, img1, isPositiveShift, operation, aspl);
+        fhtVo<uchar, CV_8UC1>(img0, img1, isPositiveShift, operation, aspl, lines);
         break;
     case CV_8S:
-        fhtVo<schar, CV_8SC1>(img0, img1, isPositiveShift, operation, aspl);
+        fhtVo<schar, CV_8SC1>(img0, img1, isPositiveShift, operation, aspl, lines);
         break;
     case CV_16U:
-        fhtVo<ushort, CV_16UC1>(img0, img1, isPositiveShift, operation, aspl);
+        fhtVo<ushort, CV_16UC1>(img0, img1, isPositiveShift, operation, aspl, lines);
         break;
     case CV_16S:
-        fhtVo<short, CV_16SC1>(img0, img1, isPositiveShift, operation, aspl);
+        fhtVo<short, CV_16SC1>(img0, img1, isPositiveShift, operation, aspl, lines);
         break;
     case CV_32S:
-        fhtVo<int, CV_32SC1>(img0, img1, isPositiveShift, operation, aspl);
+        fhtVo<int, CV_32SC1>(img0, img1, isPositiveShift, operation, aspl, lines);
         break;
     case CV_32F:
-        fhtVo<float, CV_32FC1>(img0, img1, isPositiveShift, operation, aspl);
+        fhtVo<float, CV_32FC1>(img0, img1, isPositiveShift, operation, aspl, lines);
         break;
     case CV_64F:
-        fhtVo<double, CV_64FC1>(img0, img1, isPositiveShift, operation, aspl);
+        fhtVo<double, CV_64FC1>(img0, img1, isPositiveShift, operation, aspl, lines);
         break;
     default:
         CV_Error_(CV_StsNotImplemented, ("Unknown depth %d", depth));
@@ -279,12 +394,13 @@ static void fhtVo(Mat    &img0,
     }
 }
 
-static void FHT(Mat       &dst,
-                const Mat &src,
-                int        operation,
-                bool       isVertical,
-                bool       isClockwise,
-                double     aspl)
+static void FHT(Mat         &dst,
+                const Mat   &src,
+                int          operation,
+                bool         isVertical,
+                bool         isClockwise,
+                double       aspl,
+                const Range &lines)
 {
     CV_Assert(dst.cols > 0 && dst.rows > 0);
     CV_Assert(src.channels() == dst.channels());
@@ -292,10 +408,7 @@ static void FHT(Mat       &dst,
         CV_Assert(src.cols == dst.cols && src.rows == dst.rows);
     else
         CV_Assert(src.cols == dst.rows && src.rows == dst.cols);
-
-    int level = 0;
-    for (int thres = 1; dst.rows > thres; thres <<= 1)
-        level++;
+    CV_Assert(0 <= lines.start && lines.start < lines.end && lines.end <= dst.rows);
 
     Mat tmp;
     src.convertTo(tmp, dst.type());
@@ -305,13 +418,19 @@ static void FHT(Mat       &dst,
 
     fhtVo(dst, tmp,
           isVertical ? isClockwise : !isClockwise,
-          operation, aspl);
+          operation, aspl, lines);
 }
 
-static void calculateFHTQuadrant(Mat       &dst,
-                                 const Mat &src,
-                                 int        operation,
-                                 int        quadrant)
+static bool isFlippedQuadrant(int quadrant)
+{
+    return quadrant == ARO_315_0 || quadrant == ARO_45_90 || quadrant == ARO_CTR_VER;
+}
+
+static void calculateFHTQuadrant(Mat         &dst,
+                                 const Mat   &src,
+                                 int          operation,
+                                 int          quadrant,
+                                 const Range &lines)
 {
     bool bVert = true;
     bool bClock = true;
@@ -348,17 +467,14 @@ static void calculateFHTQuadrant(Mat       &dst,
         CV_Error_(CV_StsNotImplemented, ("Unknown quadrant %d", quadrant));
     }
 
-  FHT(dst, src, operation, bVert, bClock, aspl);
+  FHT(dst, src, operation, bVert, bClock, aspl, lines);
 }
 
-static void createDstFhtMat(OutputArray dst,
-                            InputArray  src,
-                            int         depth,
-                            int         angleRange)
+static Size getFHTDstSize(const Size &srcSize,
+                          int         angleRange)
 {
-    int const rows = src.size().height;
-    int const cols = src.size().width;
-    int const channels = src.channels();
+    int const rows = srcSize.height;
+    int const cols = srcSize.width;
 
     int wd = cols + rows;
     int ht = 0;
@@ -388,7 +504,7 @@ static void createDstFhtMat(OutputArray dst,
         CV_Error_(CV_StsNotImplemented, ("Unknown angleRange %d", angleRange));
     }
 
-    dst.create(ht, wd, CV_MAKETYPE(depth, channels));
+    return Size(wd, ht);
 }
 
 static void createFHTSrc(Mat       &srcFull,
@@ -429,11 +545,9 @@ static void createFHTSrc(Mat       &srcFull,
     src.copyTo(imgReg);
 }
 
-static void setFHTDstRegion(Mat       &dstRegion,
-                            const Mat &dst,
-                            const Mat &src,
-                            int        quadrant,
-                            int        angleRange)
+static Range getFHTDstRows(const Mat &src,
+                           int        quadrant,
+                           int        angleRange)
 {
     int base = -1;
     switch (angleRange)
@@ -484,7 +598,7 @@ static void setFHTDstRegion(Mat       &dstRegion,
         shift += (i & 2) ? src.cols - 1 : src.rows - 1;
     const int ht = (quad & 2) ? src.cols : src.rows;
 
-    dstRegion = Mat(dst, Rect(0, shift, src.rows + src.cols, ht));
+    return Range(shift, shift + ht);
 }
 
 
@@ -502,10 +616,12 @@ static void rotateLineRightCyclic(uchar *pLine,
     memcpy(pLine, pBuf + len - shift, shift);
 }
 
+// firstRow is the row of the quadrant which corresponds to the first row of quad
 static void skewQuadrant(Mat         &quad,
                          const Mat   &src,
                          uchar       *pBuf,
-                         int          quadrant)
+                         int          quadrant,
+                         int          firstRow)
 {
     CV_Assert(pBuf);
 
@@ -540,134 +656,164 @@ static void skewQuadrant(Mat         &quad,
     for (int y = 0; y < quad.rows; y++)
     {
         uchar *pLine = quad.ptr(y);
-        int shift = static_cast<int>(start + step * y) * pixlen;
+        int shift = static_cast<int>(start + step * (y + firstRow)) * pixlen;
         rotateLineRightCyclic(pLine, pBuf, len, shift);
     }
 }
 
-void FastHoughTransform(InputArray  src,
-                        OutputArray dst,
-                        int         dstMatDepth,
-                        int         angleRange,
-                        int         operation,
-                        int         makeSkew)
+// One quadrant of the requested Hough image, the quadrants of a range share
+// their border rows and the later one wins as in the sequential computation
+struct FHTQuadrantJob
+{
+    int        quadrant;
+    const Mat *src;
+    Range      dstRows; // rows of the whole Hough image provided by the quadrant
+    Range      rows;    // requested rows of the quadrant, in its own coordinates
+    Mat        result;
+};
+
+static void calculateFHTQuadrantRows(FHTQuadrantJob &job,
+                                     int             wd,
+                                     int             dstType,
+                                     int             operation,
+                                     int             makeSkew)
+{
+    const int ht = job.dstRows.size();
+    const bool flipped = isFlippedQuadrant(job.quadrant);
+
+    // the quadrant is flipped vertically after the transform
+    const Range lines = flipped ? Range(ht - job.rows.end, ht - job.rows.start) : job.rows;
+
+    Mat fht(ht, wd, dstType);
+    calculateFHTQuadrant(fht, *job.src, operation, job.quadrant, lines);
+
+    job.result.create(job.rows.size(), fht.cols, dstType);
+    for (int y = job.rows.start; y < job.rows.end; y++)
+        fht.row(flipped ? ht - 1 - y : y).copyTo(job.result.row(y - job.rows.start));
+
+    if (HDO_DESKEW == makeSkew)
+    {
+        std::vector<uchar> buf_(job.result.cols * job.result.elemSize());
+        skewQuadrant(job.result, *job.src, &buf_[0], job.quadrant, job.rows.start);
+    }
+}
+
+static void fastHoughTransformRows(InputArray  src,
+                                   OutputArray dst,
+                                   int         dstMatDepth,
+                                   Range       houghRows,
+                                   int         angleRange,
+                                   int         operation,
+                                   int         makeSkew)
 {
     Mat srcMat = src.getMat();
     if (!srcMat.isContinuous())
         srcMat = srcMat.clone();
     CV_Assert(srcMat.cols > 0 && srcMat.rows > 0);
 
-    createDstFhtMat(dst, src, dstMatDepth, angleRange);
+    const Size fhtSize = getFHTDstSize(srcMat.size(), angleRange);
+    if (houghRows == Range::all())
+        houghRows = Range(0, fhtSize.height);
+    CV_Assert(0 <= houghRows.start && houghRows.start < houghRows.end &&
+              houghRows.end <= fhtSize.height);
+
+    const int dstType = CV_MAKETYPE(dstMatDepth, srcMat.channels());
+    dst.create(houghRows.size(), fhtSize.width, dstType);
     Mat dstMat = dst.getMat();
 
-    Mat imgRegDst;
-    const int len = dstMat.cols * static_cast<int>(dstMat.elemSize());
-    CV_Assert(len > 0);
-    std::vector<uchar> buf_(len);
-    uchar *buf(&buf_[0]);
+    Mat imgSrcVer, imgSrcHor;
+    std::vector<FHTQuadrantJob> jobs;
+    const int vertical[] = { ARO_315_0, ARO_0_45 };
+    const int horizontal[] = { ARO_45_90, ARO_90_135 };
+    const bool allVertical = angleRange == ARO_315_45 || angleRange == ARO_315_135;
+    const bool allHorizontal = angleRange == ARO_45_135 || angleRange == ARO_315_135;
 
-    if (angleRange == ARO_315_135)
+    if (allVertical || allHorizontal)
     {
+        if (allVertical)
         {
-            Mat imgSrc;
-            createFHTSrc(imgSrc, srcMat, ARO_315_45);
-
-            setFHTDstRegion(imgRegDst, dstMat, srcMat, ARO_315_0, angleRange);
-            calculateFHTQuadrant(imgRegDst, imgSrc, operation, ARO_315_0);
-            flip(imgRegDst, imgRegDst, 0);
-            if (HDO_DESKEW == makeSkew)
-                skewQuadrant(imgRegDst, imgSrc, buf, ARO_315_0);
-
-            setFHTDstRegion(imgRegDst, dstMat, srcMat, ARO_0_45, angleRange);
-            calculateFHTQuadrant(imgRegDst, imgSrc, operation, ARO_0_45);
-            if (HDO_DESKEW == makeSkew)
-                skewQuadrant(imgRegDst, imgSrc, buf, ARO_0_45);
+            createFHTSrc(imgSrcVer, srcMat, ARO_315_45);
+            for (int i = 0; i < 2; i++)
+            {
+                FHTQuadrantJob job;
+                job.quadrant = vertical[i];
+                job.src = &imgSrcVer;
+                job.dstRows = getFHTDstRows(srcMat, vertical[i], angleRange);
+                jobs.push_back(job);
+            }
         }
+        if (allHorizontal)
         {
-            Mat imgSrc;
-            createFHTSrc(imgSrc, srcMat, ARO_45_135);
-
-            setFHTDstRegion(imgRegDst, dstMat, srcMat, ARO_45_90, angleRange);
-            calculateFHTQuadrant(imgRegDst, imgSrc, operation, ARO_45_90);
-            flip(imgRegDst, imgRegDst, 0);
-            if (HDO_DESKEW == makeSkew)
-                skewQuadrant(imgRegDst, imgSrc, buf, ARO_45_90);
-
-            setFHTDstRegion(imgRegDst, dstMat, srcMat, ARO_90_135, angleRange);
-            calculateFHTQuadrant(imgRegDst, imgSrc, operation, ARO_90_135);
-            if (HDO_DESKEW == makeSkew)
-                skewQuadrant(imgRegDst, imgSrc, buf, ARO_90_135);
+            createFHTSrc(imgSrcHor, srcMat, ARO_45_135);
+            for (int i = 0; i < 2; i++)
+            {
+                FHTQuadrantJob job;
+                job.quadrant = horizontal[i];
+                job.src = &imgSrcHor;
+                job.dstRows = getFHTDstRows(srcMat, horizontal[i], angleRange);
+                jobs.push_back(job);
+            }
         }
-        return;
+    }
+    else
+    {
+        createFHTSrc(imgSrcVer, srcMat, angleRange);
+        FHTQuadrantJob job;
+        job.quadrant = angleRange;
+        job.src = &imgSrcVer;
+        job.dstRows = Range(0, fhtSize.height);
+        jobs.push_back(job);
     }
 
-    Mat imgSrc;
-    createFHTSrc(imgSrc, srcMat, angleRange);
+    // only the quadrants intersecting the requested rows are calculated
+    std::vector<FHTQuadrantJob*> active;
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        FHTQuadrantJob &job = jobs[i];
+        const int first = std::max(houghRows.start, job.dstRows.start);
+        const int last = std::min(houghRows.end, job.dstRows.end);
+        job.rows = Range(first - job.dstRows.start, last - job.dstRows.start);
+        if (first < last)
+            active.push_back(&job);
+    }
 
-    switch (angleRange)
+    parallel_for_(Range(0, (int)active.size()), [&](const Range &range)
     {
-    case ARO_315_0:
-        calculateFHTQuadrant(dstMat, imgSrc, operation, angleRange);
-        flip(dstMat, dstMat, 0);
-        if (HDO_DESKEW == makeSkew)
-            skewQuadrant(dstMat, imgSrc, buf, angleRange);
-        return;
-    case ARO_0_45:
-        calculateFHTQuadrant(dstMat, imgSrc, operation, angleRange);
-        if (HDO_DESKEW == makeSkew)
-            skewQuadrant(dstMat, imgSrc, buf, angleRange);
-        return;
-    case ARO_45_90:
-        calculateFHTQuadrant(dstMat, imgSrc, operation, angleRange);
-        flip(dstMat, dstMat, 0);
-        if (HDO_DESKEW == makeSkew)
-            skewQuadrant(dstMat, imgSrc, buf, angleRange);
-        return;
-    case ARO_90_135:
-        calculateFHTQuadrant(dstMat, imgSrc, operation, angleRange);
-        if (HDO_DESKEW == makeSkew)
-            skewQuadrant(dstMat, imgSrc, buf, angleRange);
-        return;
-    case ARO_315_45:
-        setFHTDstRegion(imgRegDst, dstMat, srcMat, ARO_315_0, angleRange);
-        calculateFHTQuadrant(imgRegDst, imgSrc, operation, ARO_315_0);
-        flip(imgRegDst, imgRegDst, 0);
-        if (HDO_DESKEW == makeSkew)
-            skewQuadrant(imgRegDst, imgSrc, buf, ARO_315_0);
-
-        setFHTDstRegion(imgRegDst, dstMat, srcMat, ARO_0_45, angleRange);
-        calculateFHTQuadrant(imgRegDst, imgSrc, operation, ARO_0_45);
-        if (HDO_DESKEW == makeSkew)
-            skewQuadrant(imgRegDst, imgSrc, buf, ARO_0_45);
-        return;
-    case ARO_45_135:
-        setFHTDstRegion(imgRegDst, dstMat, srcMat, ARO_45_90, angleRange);
-        calculateFHTQuadrant(imgRegDst, imgSrc, operation, ARO_45_90);
-        flip(imgRegDst, imgRegDst, 0);
-        if (HDO_DESKEW == makeSkew)
-            skewQuadrant(imgRegDst, imgSrc, buf, ARO_45_90);
-
-        setFHTDstRegion(imgRegDst, dstMat, srcMat, ARO_90_135, angleRange);
-        calculateFHTQuadrant(imgRegDst, imgSrc, operation, ARO_90_135);
-        if (HDO_DESKEW == makeSkew)
-            skewQuadrant(imgRegDst, imgSrc, buf, ARO_90_135);
-        return;
-    case ARO_CTR_VER:
-        calculateFHTQuadrant(dstMat, imgSrc, operation, angleRange);
-        flip(dstMat, dstMat, 0);
-        if (HDO_DESKEW == makeSkew)
-            skewQuadrant(dstMat, imgSrc, buf, angleRange);
-        return;
-    case ARO_CTR_HOR:
-        calculateFHTQuadrant(dstMat, imgSrc, operation, angleRange);
-        if (HDO_DESKEW == makeSkew)
-            skewQuadrant(dstMat, imgSrc, buf, angleRange);
-        return;
-    default:
-        CV_Error_(CV_StsNotImplemented, ("Unknown angleRange %d", angleRange));
+        for (int i = range.start; i < range.end; i++)
+            calculateFHTQuadrantRows(*active[i], fhtSize.width, dstType, operation, makeSkew);
+    });
+
+    for (size_t i = 0; i < active.size(); i++)
+    {
+        const FHTQuadrantJob &job = *active[i];
+        const int first = job.dstRows.start + job.rows.start - houghRows.start;
+        job.result.copyTo(dstMat.rowRange(first, first + job.rows.size()));
     }
 }
 
+void FastHoughTransform(InputArray  src,
+                        OutputArray dst,
+                        int         dstMatDepth,
+                        int         angleRange,
+                        int         operation,
+                        int         makeSkew)
+{
+    fastHoughTransformRows(src, dst, dstMatDepth, Range::all(),
+                           angleRange, operation, makeSkew);
+}
+
+void FastHoughTransformRows(InputArray   src,
+                            OutputArray  dst,
+                            int          dstMatDepth,
+                            const Range &houghRows,
+                            int          angleRange,
+                            int          operation,
+                            int          makeSkew)
+{
+    fastHoughTransformRows(src, dst, dstMatDepth, houghRows,
+                           angleRange, operation, makeSkew);
+}
+
 //-----------------------------------------------------------------------------
 
 //----------------------fht point2line-----------------------------------------
@@ -37,6 +37,11 @@ class FastLineDetectorImpl : public FastLineDetector
         int canny_aperture_size;
         bool do_merge;
 
+        // buffers reused by consecutive detect() calls
+        Mat edge_map;
+        std::vector<Point2i> chain_points;
+        std::vector<SEGMENT> chain_segments, kept_segments;
+
         FastLineDetectorImpl& operator= (const FastLineDetectorImpl&); // to quiet MSVC
         template<class T>
             void incidentPoint(const Mat& l, T& pt);
@@ -91,14 +96,13 @@ void FastLineDetectorImpl::detect(InputArray _image, OutputArray _lines)
     Mat image = _image.getMat();
     CV_Assert(!image.empty() && image.type() == CV_8UC1);
 
-    std::vector<Vec4f> lines;
-    std::vector<SEGMENT> segments;
-    lineDetection(image, segments);
-    for(size_t i = 0; i < segments.size(); ++i)
+    std::vector<SEGMENT> segments_all;
+    lineDetection(image, segments_all);
+    std::vector<Vec4f> lines(segments_all.size());
+    for(size_t i = 0; i < segments_all.size(); ++i)
     {
-        const SEGMENT seg = segments[i];
-        Vec4f line(seg.x1, seg.y1, seg.x2, seg.y2);
-        lines.push_back(line);
+        const SEGMENT& seg = segments_all[i];
+        lines[i] = Vec4f(seg.x1, seg.y1, seg.x2, seg.y2);
     }
     Mat(lines).copyTo(_lines);
 }
@@ -502,19 +506,20 @@ void FastLineDetectorImpl::lineDetection(const Mat& src, std::vector<SEGMENT>& s
     int r, c;
     imageheight=src.rows; imagewidth=src.cols;
 
-    std::vector<Point2i> points;
-    std::vector<SEGMENT> segments, segments_tmp;
-    Mat canny;
+    chain_points.clear();
+    chain_segments.clear();
+    kept_segments.clear();
+    // the edge map is consumed while tracing, so it must not alias src
     if (canny_aperture_size == 0)
     {
-        canny = src;
+        src.copyTo(edge_map);
     }
     else
     {
-        Canny(src, canny, canny_th1, canny_th2, canny_aperture_size);
+        Canny(src, edge_map, canny_th1, canny_th2, canny_aperture_size);
     }
-    canny.colRange(0,6).rowRange(0,6).setTo(cv::Scalar::all(0));
-    canny.colRange(src.cols-5,src.cols).rowRange(src.rows-5,src.rows).setTo(cv::Scalar::all(0));
+    edge_map.colRange(0,6).rowRange(0,6).setTo(cv::Scalar::all(0));
+    edge_map.colRange(src.cols-5,src.cols).rowRange(src.rows-5,src.rows).setTo(cv::Scalar::all(0));
 
     SEGMENT seg, seg1, seg2;
 
@@ -523,40 +528,40 @@ void FastLineDetectorImpl::lineDetection(const Mat& src, std::vector<SEGMENT>& s
         for ( c = 0; c < imagewidth; c++ )
         {
             // Find seeds - skip for non-seeds
-            if ( canny.at<unsigned char>(r,c) == 0 )
+            if ( edge_map.at<unsigned char>(r,c) == 0 )
                 continue;
 
             // Found seeds
             Point2i pt = Point2i(c,r);
 
-            points.push_back(pt);
-            canny.at<unsigned char>(pt.y, pt.x) = 0;
+            chain_points.push_back(pt);
+            edge_map.at<unsigned char>(pt.y, pt.x) = 0;
 
             float direction = 0.0f;
             int step = 0;
-            while(getPointChain(canny, pt, pt, direction, step))
+            while(getPointChain(edge_map, pt, pt, direction, step))
             {
-                points.push_back(pt);
+                chain_points.push_back(pt);
                 step++;
-                canny.at<unsigned char>(pt.y, pt.x) = 0;
+                edge_map.at<unsigned char>(pt.y, pt.x) = 0;
             }
 
-            if ( points.size() < (unsigned int)threshold_length + 1 )
+            if ( chain_points.size() < (unsigned int)threshold_length + 1 )
             {
-                points.clear();
+                chain_points.clear();
                 continue;
             }
 
-            extractSegments(points, segments);
+            extractSegments(chain_points, chain_segments);
 
-            if ( segments.size() == 0 )
+            if ( chain_segments.size() == 0 )
             {
-                points.clear();
+                chain_points.clear();
                 continue;
             }
-            for ( int i = 0; i < (int)segments.size(); i++ )
+            for ( int i = 0; i < (int)chain_segments.size(); i++ )
             {
-                seg = segments[i];
+                seg = chain_segments[i];
                 float length = sqrt((seg.x1 - seg.x2)*(seg.x1 - seg.x2) +
                         (seg.y1 - seg.y2)*(seg.y1 - seg.y2));
                 if(length < threshold_length)
@@ -569,31 +574,31 @@ void FastLineDetectorImpl::lineDetection(const Mat& src, std::vector<SEGMENT>& s
                 additionalOperationsOnSegment(src, seg);
                 if(!do_merge)
                     segments_all.push_back(seg);
-                segments_tmp.push_back(seg);
+                kept_segments.push_back(seg);
             }
-            points.clear();
-            segments.clear();
+            chain_points.clear();
+            chain_segments.clear();
         }
     }
     if(!do_merge)
         return;
 
     bool is_merged = false;
-    int ith = (int)segments_tmp.size() - 1;
+    int ith = (int)kept_segments.size() - 1;
     int jth = ith - 1;
     while(ith > 1 || jth > 0)
     {
-        seg1 = segments_tmp[ith];
-        seg2 = segments_tmp[jth];
+        seg1 = kept_segments[ith];
+        seg2 = kept_segments[jth];
         SEGMENT seg_merged;
         is_merged = mergeSegments(seg1, seg2, seg_merged);
         if(is_merged == true)
         {
             seg2 = seg_merged;
             additionalOperationsOnSegment(src, seg2);
-            std::vector<SEGMENT>::iterator it = segments_tmp.begin() + ith;
+            std::vector<SEGMENT>::iterator it = kept_segments.begin() + ith;
             *it = seg2;
-            segments_tmp.erase(segments_tmp.begin()+jth);
+            kept_segments.erase(kept_segments.begin()+jth);
             ith--;
             jth = ith - 1;
         }
@@ -606,7 +611,7 @@ void FastLineDetectorImpl::lineDetection(const Mat& src, std::vector<SEGMENT>& s
             jth = ith - 1;
         }
     }
-    segments_all = segments_tmp;
+    segments_all = kept_segments;
 }
 
 inline void FastLineDetectorImpl::getAngle(SEGMENT& seg)
@@ -629,8 +634,8 @@ void FastLineDetectorImpl::additionalOperationsOnSegment(const Mat& src, SEGMENT
     dx = (double) end.x - (double) start.x;
     dy = (double) end.y - (double) start.y;
 
-    int num_points = 10;
-    Point2f *points = new Point2f[num_points];
+    const int num_points = 10;
+    Point2f points[num_points];
 
     points[0] = start;
     points[num_points - 1] = end;
@@ -642,8 +647,8 @@ void FastLineDetectorImpl::additionalOperationsOnSegment(const Mat& src, SEGMENT
         points[i].y = points[0].y + ((float)dy / float(num_points - 1) * (float) i);
     }
 
-    Point2i *points_right = new Point2i[num_points];
-    Point2i *points_left = new Point2i[num_points];
+    Point2i points_right[num_points];
+    Point2i points_left[num_points];
     double gap = 1.0;
 
     for(int i = 0; i < num_points; i++)
@@ -670,10 +675,6 @@ void FastLineDetectorImpl::additionalOperationsOnSegment(const Mat& src, SEGMENT
         getAngle(seg);
     }
 
-    delete[] points;
-    delete[] points_right;
-    delete[] points_left;
-
     return;
 }
 
@@ -40,9 +40,9 @@
 #include <vector>
 #include <memory>
 #include <stdlib.h>
-#include <iostream>
 #include <iterator>
 #include <algorithm>
+#include <limits>
 
 
 #ifdef HAVE_EIGEN
@@ -109,14 +109,7 @@ namespace ximgproc
 
             Mat conf = confidence.getMat();
 
-            for(int i=0;i<src.channels();i++)
-            {
-                Mat cur_res = src_channels[i].clone();
-
-                solve(cur_res,conf,cur_res);
-                cur_res.convertTo(cur_res, src.type());
-                dst_channels.push_back(cur_res);
-            }
+            solve(src_channels,conf,dst_channels);
 
             dst.create(src.size(),src_channels[0].type());
             if(src.channels()==1)
@@ -129,8 +122,52 @@ namespace ximgproc
             CV_Assert(src.type() == dst.type() && src.size() == dst.size());
         }
 
+        void filterMultiple(InputArrayOfArrays src, InputArray confidence, OutputArrayOfArrays dst) CV_OVERRIDE
+        {
+            CV_Assert(src.isMatVector() || src.isUMatVector());
+            CV_Assert(!confidence.empty() && (confidence.depth() == CV_8U || confidence.depth() == CV_32F) && confidence.channels()==1);
+            if (confidence.rows() != rows || confidence.cols() != cols)
+            {
+                CV_Error(Error::StsBadSize, "Size of the confidence image must be equal to the size of the guide image");
+                return;
+            }
+
+            int nsrc = (int)src.total();
+            std::vector<Mat> src_channels;
+            std::vector<int> src_cn(nsrc);
+            for(int k=0;k<nsrc;k++)
+            {
+                Mat cur_src = src.getMat(k);
+                CV_Assert(!cur_src.empty() && (cur_src.depth() == CV_8U || cur_src.depth() == CV_16S || cur_src.depth() == CV_16U || cur_src.depth() == CV_32F) && cur_src.channels()<=4);
+                if (cur_src.rows != rows || cur_src.cols != cols)
+                {
+                    CV_Error(Error::StsBadSize, "Size of the filtered image must be equal to the size of the guide image");
+                    return;
+                }
+                std::vector<Mat> cur_channels;
+                split(cur_src,cur_channels);
+                src_channels.insert(src_channels.end(), cur_channels.begin(), cur_channels.end());
+                src_cn[k] = cur_src.channels();
+            }
+
+            Mat conf = confidence.getMat();
+            std::vector<Mat> dst_channels;
+            solve(src_channels,conf,dst_channels);
+
+            dst.create(nsrc, 1, 0);
+            for(int k=0, c=0;k<nsrc;c+=src_cn[k],k++)
+            {
+                std::vector<Mat> cur_channels(dst_channels.begin()+c, dst_channels.begin()+c+src_cn[k]);
+                Mat cur_dst;
+                merge(cur_channels,cur_dst);
+                dst.create(cur_dst.size(), cur_dst.type(), k);
+                Mat dst_k = dst.getMat(k);
+                cur_dst.copyTo(dst_k);
+            }
+        }
+
     // protected:
-        void solve(cv::Mat& src, cv::Mat& confidence, cv::Mat& dst);
+        void solve(std::vector<Mat>& targets, const Mat& confidence, std::vector<Mat>& outputs);
         void init(cv::Mat& reference, double sigma_spatial, double sigma_luma, double sigma_chroma, double lambda, int num_iter, double max_tol);
 
         void Splat(Eigen::VectorXf& input, Eigen::VectorXf& dst);
@@ -458,67 +495,96 @@ namespace ximgproc
     }
 
 
-    void FastBilateralSolverFilterImpl::solve(cv::Mat& target,
-               cv::Mat& confidence,
-               cv::Mat& output)
+    static void targetToSolver(const Mat& target, float* x)
     {
-
-        Eigen::SparseMatrix<float, Eigen::ColMajor> M(nvertices,nvertices);
-        Eigen::SparseMatrix<float, Eigen::ColMajor> A_data(nvertices,nvertices);
-        Eigen::SparseMatrix<float, Eigen::ColMajor> A(nvertices,nvertices);
-        Eigen::VectorXf b(nvertices);
-        Eigen::VectorXf y(nvertices);
-        Eigen::VectorXf y0(nvertices);
-        Eigen::VectorXf y1(nvertices);
-        Eigen::VectorXf w_splat(nvertices);
-
-        Eigen::VectorXf x(npixels);
-        Eigen::VectorXf w(npixels);
-
+        int npixels = (int)target.total();
         if(target.depth() == CV_16S)
         {
-            const int16_t *pft = reinterpret_cast<const int16_t*>(target.data);
+            const int16_t *pft = target.ptr<int16_t>();
             for (int i = 0; i < npixels; i++)
-            {
-                x(i) = (cv::saturate_cast<float>(pft[i])+32768.0f)/65535.0f;
-            }
+                x[i] = (cv::saturate_cast<float>(pft[i])+32768.0f)/65535.0f;
         }
         else if(target.depth() == CV_16U)
         {
-            const uint16_t *pft = reinterpret_cast<const uint16_t*>(target.data);
+            const uint16_t *pft = target.ptr<uint16_t>();
             for (int i = 0; i < npixels; i++)
-            {
-                x(i) = cv::saturate_cast<float>(pft[i])/65535.0f;
-            }
+                x[i] = cv::saturate_cast<float>(pft[i])/65535.0f;
         }
         else if(target.depth() == CV_8U)
         {
-            const uchar *pft = reinterpret_cast<const uchar*>(target.data);
+            const uchar *pft = target.ptr<uchar>();
             for (int i = 0; i < npixels; i++)
-            {
-                x(i) = cv::saturate_cast<float>(pft[i])/255.0f;
-            }
+                x[i] = cv::saturate_cast<float>(pft[i])/255.0f;
+        }
+        else
+        {
+            const float *pft = target.ptr<float>();
+            for (int i = 0; i < npixels; i++)
+                x[i] = pft[i];
         }
-        else if(target.depth() == CV_32F)
+    }
+
+    // y points to the column of the solution, stride is the number of solved targets
+    static void solverToTarget(const std::vector<int>& splat_idx, const float* y, int stride, Mat& output)
+    {
+        int npixels = (int)splat_idx.size();
+        if(output.depth() == CV_16S)
         {
-            const float *pft = reinterpret_cast<const float*>(target.data);
+            int16_t *pftar = output.ptr<int16_t>();
             for (int i = 0; i < npixels; i++)
-            {
-                x(i) = pft[i];
-            }
+                pftar[i] = cv::saturate_cast<short>(y[splat_idx[i]*stride] * 65535.0f - 32768.0f);
+        }
+        else if(output.depth() == CV_16U)
+        {
+            uint16_t *pftar = output.ptr<uint16_t>();
+            for (int i = 0; i < npixels; i++)
+                pftar[i] = cv::saturate_cast<ushort>(y[splat_idx[i]*stride] * 65535.0f);
+        }
+        else if (output.depth() == CV_8U)
+        {
+            uchar *pftar = output.ptr<uchar>();
+            for (int i = 0; i < npixels; i++)
+                pftar[i] = cv::saturate_cast<uchar>(y[splat_idx[i]*stride] * 255.0f);
         }
+        else
+        {
+            float *pftar = output.ptr<float>();
+            for (int i = 0; i < npixels; i++)
+                pftar[i] = y[splat_idx[i]*stride];
+        }
+    }
+
+    /* All targets share the confidence, so the system matrix and its Jacobi preconditioner are built once.
+       The solutions are the columns of row-major matrices, that makes the sparse products vectorized over
+       targets, and every column follows the preconditioned conjugate gradient iterations of Eigen until it converges. */
+    void FastBilateralSolverFilterImpl::solve(std::vector<Mat>& targets,
+               const Mat& confidence,
+               std::vector<Mat>& outputs)
+    {
+        typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BlockXf;
+        typedef Eigen::Matrix<float, 1, Eigen::Dynamic> RowXf;
+
+        int ntargets = (int)targets.size();
+
+        Eigen::SparseMatrix<float, Eigen::ColMajor> A_data(nvertices,nvertices);
+        Eigen::SparseMatrix<float, Eigen::ColMajor> A(nvertices,nvertices);
+        Eigen::VectorXf w_splat(nvertices);
+        Eigen::VectorXf y1 = Eigen::VectorXf::Zero(nvertices);
+        Eigen::VectorXf w(npixels);
+        Eigen::VectorXf x(npixels);
 
-        if(confidence.depth() == CV_8U)
+        Mat conf = confidence.isContinuous() ? confidence : confidence.clone();
+        if(conf.depth() == CV_8U)
         {
-            const uchar *pfc = reinterpret_cast<const uchar*>(confidence.data);
+            const uchar *pfc = conf.ptr<uchar>();
             for (int i = 0; i < npixels; i++)
             {
                 w(i) = cv::saturate_cast<float>(pfc[i])/255.0f;
             }
         }
-        else if(confidence.depth() == CV_32F)
+        else
         {
-            const float *pfc = reinterpret_cast<const float*>(confidence.data);
+            const float *pfc = conf.ptr<float>();
             for (int i = 0; i < npixels; i++)
             {
                 w(i) = pfc[i];
@@ -531,75 +597,97 @@ namespace ximgproc
         diagonal(w_splat,A_data);
         A = bs_param.lam * (Dm - Dn * (blurs*Dn)) + A_data ;
 
-        //construct b
-        b.setZero();
-        for (int i = 0; i < int(splat_idx.size()); i++)
-        {
-            b(splat_idx[i]) += x(i) * w(i);
-        }
+        Eigen::VectorXf invdiag = A.diagonal();
+        for (int i = 0; i < nvertices; i++)
+            invdiag(i) = invdiag(i) != 0.0f ? 1.0f/invdiag(i) : 1.0f;
 
-        //construct guess for y
-        y0.setZero();
-        for (int i = 0; i < int(splat_idx.size()); i++)
-        {
-            y0(splat_idx[i]) += x(i);
-        }
-        y1.setZero();
-        for (int i = 0; i < int(splat_idx.size()); i++)
+        for (int i = 0; i < npixels; i++)
         {
             y1(splat_idx[i]) += 1.0f;
         }
-        for (int i = 0; i < nvertices; i++)
-        {
-            y0(i) = y0(i)/y1(i);
-        }
-
 
-        // solve Ay = b
-        Eigen::ConjugateGradient<Eigen::SparseMatrix<float>, Eigen::Lower|Eigen::Upper> cg;
-        cg.compute(A);
-        cg.setMaxIterations(bs_param.cg_maxiter);
-        cg.setTolerance(bs_param.cg_tol);
-        // y = cg.solve(b);
-        y = cg.solveWithGuess(b,y0);
-        std::cout << "#iterations:     " << cg.iterations() << std::endl;
-        std::cout << "estimated error: " << cg.error()      << std::endl;
-
-        //slice
-        if(target.depth() == CV_16S)
+        //construct b and the guess for y
+        BlockXf B = BlockXf::Zero(nvertices, ntargets);
+        BlockXf Y = BlockXf::Zero(nvertices, ntargets);
+        for (int k = 0; k < ntargets; k++)
         {
-            int16_t *pftar = (int16_t*) output.data;
-            for (int i = 0; i < int(splat_idx.size()); i++)
+            Mat target = targets[k].isContinuous() ? targets[k] : targets[k].clone();
+            targetToSolver(target, x.data());
+            for (int i = 0; i < npixels; i++)
             {
-                pftar[i] = cv::saturate_cast<short>(y(splat_idx[i]) * 65535.0f - 32768.0f);
+                B(splat_idx[i], k) += x(i) * w(i);
+                Y(splat_idx[i], k) += x(i);
             }
         }
-        else if(target.depth() == CV_16U)
+        Y = y1.cwiseInverse().asDiagonal() * Y;
+
+        // solve AY = B
+        const float considerAsZero = (std::numeric_limits<float>::min)();
+        RowXf rhsNorm2 = B.cwiseAbs2().colwise().sum();
+        RowXf threshold = (rhsNorm2 * (bs_param.cg_tol * bs_param.cg_tol)).cwiseMax(considerAsZero);
+        std::vector<bool> active(ntargets, true);
+        for (int k = 0; k < ntargets; k++)
         {
-            uint16_t *pftar = (uint16_t*) output.data;
-            for (int i = 0; i < int(splat_idx.size()); i++)
+            if (rhsNorm2(k) == 0.0f)
             {
-                pftar[i] = cv::saturate_cast<ushort>(y(splat_idx[i]) * 65535.0f);
+                Y.col(k).setZero();
+                active[k] = false;
             }
         }
-        else if (target.depth() == CV_8U)
+
+        BlockXf R = B - A * Y;
+        RowXf residualNorm2 = R.cwiseAbs2().colwise().sum();
+        int nactive = 0;
+        for (int k = 0; k < ntargets; k++)
         {
-            uchar *pftar = (uchar*) output.data;
-            for (int i = 0; i < int(splat_idx.size()); i++)
-            {
-                pftar[i] = cv::saturate_cast<uchar>(y(splat_idx[i]) * 255.0f);
-            }
+            if (active[k] && residualNorm2(k) < threshold(k))
+                active[k] = false;
+            nactive += active[k] ? 1 : 0;
         }
-        else
+
+        BlockXf P = invdiag.asDiagonal() * R;
+        BlockXf Z(nvertices, ntargets);
+        BlockXf AP(nvertices, ntargets);
+        RowXf absNew = R.cwiseProduct(P).colwise().sum();
+        RowXf alpha(ntargets), beta(ntargets);
+
+        for (int iter = 0; iter < bs_param.cg_maxiter && nactive > 0; iter++)
         {
-            float *pftar = (float*)(output.data);
-            for (int i = 0; i < int(splat_idx.size()); i++)
+            AP.noalias() = A * P;
+            RowXf pAp = P.cwiseProduct(AP).colwise().sum();
+            for (int k = 0; k < ntargets; k++)
+                alpha(k) = active[k] ? absNew(k) / pAp(k) : 0.0f;
+
+            Y.noalias() += P * alpha.asDiagonal();
+            R.noalias() -= AP * alpha.asDiagonal();
+
+            residualNorm2 = R.cwiseAbs2().colwise().sum();
+            for (int k = 0; k < ntargets; k++)
             {
-                pftar[i] = y(splat_idx[i]);
+                if (active[k] && residualNorm2(k) < threshold(k))
+                {
+                    active[k] = false;
+                    nactive--;
+                }
             }
+            if (nactive == 0)
+                break;
+
+            Z.noalias() = invdiag.asDiagonal() * R;
+            RowXf absOld = absNew;
+            absNew = R.cwiseProduct(Z).colwise().sum();
+            for (int k = 0; k < ntargets; k++)
+                beta(k) = active[k] ? absNew(k) / absOld(k) : 0.0f;
+            P = Z + P * beta.asDiagonal();
         }
 
-
+        //slice
+        outputs.resize(ntargets);
+        for (int k = 0; k < ntargets; k++)
+        {
+            outputs[k].create(rows, cols, targets[k].type());
+            solverToTarget(splat_idx, Y.data() + k, ntargets, outputs[k]);
+        }
     }
 
 
@@ -612,6 +700,8 @@ Ptr<FastBilateralSolverFilter> createFastBilateralSolverFilter(InputArray guide,
 
 void fastBilateralSolverFilter(InputArray guide, InputArray src, InputArray confidence, OutputArray dst, double sigma_spatial, double sigma_luma, double sigma_chroma, double lambda, int num_iter, double max_tol)
 {
+    CV_INSTRUMENT_REGION();
+
     Ptr<FastBilateralSolverFilter> fbs = createFastBilateralSolverFilter(guide, sigma_spatial, sigma_luma, sigma_chroma, lambda, num_iter, max_tol);
     fbs->filter(src, confidence, dst);
 }
@@ -181,6 +181,8 @@ Ptr<FastGlobalSmootherFilterImpl> FastGlobalSmootherFilterImpl::create(InputArra
 
 void FastGlobalSmootherFilterImpl::filter(InputArray src, OutputArray dst)
 {
+    CV_INSTRUMENT_REGION();
+
     CV_Assert(!src.empty() && (src.depth() == CV_8U || src.depth() == CV_16S || src.depth() == CV_32F) && src.channels()<=4);
     if (src.rows() != h || src.cols() != w)
     {
@@ -683,6 +685,8 @@ Ptr<FastGlobalSmootherFilter> createFastGlobalSmootherFilter(InputArray guide, d
 
 void fastGlobalSmootherFilter(InputArray guide, InputArray src, OutputArray dst, double lambda, double sigma_color, double lambda_attenuation, int num_iter)
 {
+    CV_INSTRUMENT_REGION();
+
     Ptr<FastGlobalSmootherFilter> fgs = createFastGlobalSmootherFilter(guide, lambda, sigma_color, lambda_attenuation, num_iter);
     fgs->filter(src, dst);
 }
@@ -40,6 +40,7 @@ the use of this software, even if advised of the possibility of such damage.
 
 #include "precomp.hpp"
 #include "opencv2/ximgproc/segmentation.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include <iostream>
 
@@ -89,6 +90,9 @@ namespace cv {
                     // Join two sets of points, based on their main point
                     void joinPoints(int p_a, int p_b);
 
+                    // Same as joinPoints without updating nb_elements, the sets of different threads must be disjoint
+                    void linkPoints(int p_a, int p_b);
+
                     // Return the set size of a set (based on the main point)
                     int size(unsigned int p) { return mapping[p].size; }
 
@@ -103,6 +107,7 @@ namespace cv {
                         sigma = 0.5;
                         k = 300;
                         min_size = 100;
+                        tile_size = 0;
                         name_ = "GraphSegmentation";
                     }
 
@@ -120,11 +125,15 @@ namespace cv {
                     virtual void setMinSize(int min_size_) CV_OVERRIDE { min_size = min_size_; }
                     virtual int getMinSize() CV_OVERRIDE { return min_size; }
 
+                    virtual void setTileSize(int tile_size_) CV_OVERRIDE { CV_Assert(tile_size_ >= 0); tile_size = tile_size_; }
+                    virtual int getTileSize() CV_OVERRIDE { return tile_size; }
+
                     virtual void write(FileStorage& fs) const CV_OVERRIDE {
                         fs << "name" << name_
                         << "sigma" << sigma
                         << "k" << k
-                        << "min_size" << (int)min_size;
+                        << "min_size" << (int)min_size
+                        << "tile_size" << tile_size;
                     }
 
                     virtual void read(const FileNode& fn) CV_OVERRIDE {
@@ -133,20 +142,27 @@ namespace cv {
                         sigma = (double)fn["sigma"];
                         k = (float)fn["k"];
                         min_size = (int)(int)fn["min_size"];
+                        tile_size = fn["tile_size"].empty() ? 0 : (int)fn["tile_size"];
                     }
 
                 private:
                     double sigma;
                     float k;
                     int min_size;
+                    int tile_size;
                     String name_;
 
+                    class TileForestInvoker;
+
                     // Pre-filter the image
                     void filter(const Mat &img, Mat &img_filtered);
 
                     // Build the graph between each pixels
                     void buildGraph(Edge **edges, int &nb_edges, const Mat &img_filtered);
 
+                    // Sort the edges by increasing weight
+                    void sortEdges(Edge *edges, const int &nb_edges);
+
                     // Segment the graph
                     void segmentGraph(Edge * edges, const int &nb_edges, const Mat & img_filtered, PointSet **es);
 
@@ -168,56 +184,177 @@ namespace cv {
                 GaussianBlur(img_converted, img_filtered, Size(0, 0), sigma, sigma);
             }
 
+            // w[j] is the distance between the pixels a[j] and b[j] of two rows with cn channels
+            static void edgeWeights(const float* a, const float* b, int n, int cn, float* w) {
+
+                int j = 0;
+#if CV_SIMD128
+                if (cn == 1) {
+                    for (; j <= n - 4; j += 4) {
+                        v_float32x4 d = v_load(a + j) - v_load(b + j);
+                        v_store(w + j, v_sqrt(d * d));
+                    }
+                } else if (cn == 3) {
+                    for (; j <= n - 4; j += 4) {
+                        v_float32x4 a0, a1, a2, b0, b1, b2;
+                        v_load_deinterleave(a + j * 3, a0, a1, a2);
+                        v_load_deinterleave(b + j * 3, b0, b1, b2);
+                        v_float32x4 d0 = a0 - b0, d1 = a1 - b1, d2 = a2 - b2;
+                        v_store(w + j, v_sqrt(v_fma(d2, d2, v_fma(d1, d1, d0 * d0))));
+                    }
+                } else if (cn == 4) {
+                    for (; j <= n - 4; j += 4) {
+                        v_float32x4 a0, a1, a2, a3, b0, b1, b2, b3;
+                        v_load_deinterleave(a + j * 4, a0, a1, a2, a3);
+                        v_load_deinterleave(b + j * 4, b0, b1, b2, b3);
+                        v_float32x4 d0 = a0 - b0, d1 = a1 - b1, d2 = a2 - b2, d3 = a3 - b3;
+                        v_store(w + j, v_sqrt(v_fma(d3, d3, v_fma(d2, d2, v_fma(d1, d1, d0 * d0)))));
+                    }
+                }
+#endif
+                for (; j < n; j++) {
+                    float tmp_total = 0;
+
+                    for (int channel = 0; channel < cn; channel++) {
+                        float d = a[j * cn + channel] - b[j * cn + channel];
+                        tmp_total += d * d;
+                    }
+
+                    w[j] = std::sqrt(tmp_total);
+                }
+            }
+
             void GraphSegmentationImpl::buildGraph(Edge **edges, int &nb_edges, const Mat &img_filtered) {
 
-                *edges = new Edge[img_filtered.rows * img_filtered.cols * 4];
+                const int rows = img_filtered.rows;
+                const int cols = img_filtered.cols;
+                const int nb_channels = img_filtered.channels();
+
+                // Each pair of 4-connected pixels is linked once, by its right or its bottom edge
+                *edges = new Edge[std::max(rows * (cols - 1) + (rows - 1) * cols, 0)];
 
                 nb_edges = 0;
 
-                int nb_channels = img_filtered.channels();
+                std::vector<float> weights(cols);
 
-                for (int i = 0; i < (int)img_filtered.rows; i++) {
+                for (int i = 0; i < rows; i++) {
                     const float* p = img_filtered.ptr<float>(i);
 
-                    for (int j = 0; j < (int)img_filtered.cols; j++) {
+                    // Right pixel
+                    edgeWeights(p, p + nb_channels, cols - 1, nb_channels, &weights[0]);
+                    for (int j = 0; j < cols - 1; j++) {
+                        (*edges)[nb_edges].weight = weights[j];
+                        (*edges)[nb_edges].from = i * cols + j;
+                        (*edges)[nb_edges].to = i * cols + j + 1;
+                        nb_edges++;
+                    }
 
-                        //Take the right, left, top and down pixel
-                        for (int delta = -1; delta <= 1; delta += 2) {
-                            for (int delta_j = 0, delta_i = 1; delta_j <= 1; delta_j++ || delta_i--) {
+                    // Down pixel
+                    if (i + 1 < rows) {
+                        edgeWeights(p, img_filtered.ptr<float>(i + 1), cols, nb_channels, &weights[0]);
+                        for (int j = 0; j < cols; j++) {
+                            (*edges)[nb_edges].weight = weights[j];
+                            (*edges)[nb_edges].from = i * cols + j;
+                            (*edges)[nb_edges].to = (i + 1) * cols + j;
+                            nb_edges++;
+                        }
+                    }
+                }
+            }
 
-                                int i2 = i + delta * delta_i;
-                                int j2 = j + delta * delta_j;
+            void GraphSegmentationImpl::sortEdges(Edge *edges, const int &nb_edges) {
 
-                                if (i2 >= 0 && i2 < img_filtered.rows && j2 >= 0 && j2 < img_filtered.cols) {
-                                    const float* p2 = img_filtered.ptr<float>(i2);
+                // Weights are positive floats, their bit patterns sort as unsigned integers.
+                // LSD radix sort with 3 passes of 11 bits, it is stable so equal weights keep the graph order.
+                const int radix_bits = 11;
+                const int radix_size = 1 << radix_bits;
 
-                                    float tmp_total = 0;
+                std::vector<Edge> tmp(nb_edges);
+                std::vector<int> counts(radix_size);
 
-                                    for ( int channel = 0; channel < nb_channels; channel++) {
-                                        tmp_total += pow(p[j * nb_channels + channel] - p2[j2 * nb_channels + channel], 2);
-                                    }
+                Edge* src = edges;
+                Edge* dst = nb_edges > 0 ? &tmp[0] : NULL;
 
-                                    float diff = 0;
-                                    diff = sqrt(tmp_total);
+                for (int shift = 0; shift < 32; shift += radix_bits) {
 
-                                    (*edges)[nb_edges].weight = diff;
-                                    (*edges)[nb_edges].from = i * img_filtered.cols +  j;
-                                    (*edges)[nb_edges].to = i2 * img_filtered.cols + j2;
+                    std::fill(counts.begin(), counts.end(), 0);
+                    for (int i = 0; i < nb_edges; i++) {
+                        Cv32suf key;
+                        key.f = src[i].weight;
+                        counts[(key.u >> shift) & (radix_size - 1)]++;
+                    }
+
+                    // Nothing to move when all keys have the same digit
+                    int offset = 0;
+                    bool single_bucket = false;
+                    for (int d = 0; d < radix_size; d++) {
+                        single_bucket = single_bucket || counts[d] == nb_edges;
+                        int c = counts[d];
+                        counts[d] = offset;
+                        offset += c;
+                    }
+                    if (single_bucket)
+                        continue;
+
+                    for (int i = 0; i < nb_edges; i++) {
+                        Cv32suf key;
+                        key.f = src[i].weight;
+                        dst[counts[(key.u >> shift) & (radix_size - 1)]++] = src[i];
+                    }
+                    std::swap(src, dst);
+                }
+
+                if (src != edges)
+                    std::copy(src, src + nb_edges, edges);
+            }
 
-                                    nb_edges++;
+            // Builds the forests of the tiles, each one only links pixels of its own tile
+            class GraphSegmentationImpl::TileForestInvoker : public ParallelLoopBody {
+                public:
+                    TileForestInvoker(Edge* edges_, const std::vector<int>& order_, const std::vector<int>& starts_,
+                                      float* thresholds_, PointSet* es_, float k_, std::vector<int>& joins_)
+                        : edges(edges_), order(order_), starts(starts_), thresholds(thresholds_), es(es_), k(k_), joins(joins_) {}
+
+                    virtual void operator()(const Range& range) const CV_OVERRIDE {
+                        for (int t = range.start; t < range.end; t++) {
+                            int nb_joins = 0;
+
+                            for (int n = starts[t]; n < starts[t + 1]; n++) {
+                                Edge& e = edges[order[n]];
+
+                                int p_a = es->getBasePoint(e.from);
+                                int p_b = es->getBasePoint(e.to);
+
+                                if (p_a != p_b && e.weight <= thresholds[p_a] && e.weight <= thresholds[p_b]) {
+                                    es->linkPoints(p_a, p_b);
+                                    p_a = es->getBasePoint(p_a);
+                                    thresholds[p_a] = e.weight + k / es->size(p_a);
+
+                                    e.weight = 0;
+                                    nb_joins++;
                                 }
                             }
+
+                            joins[t] = nb_joins;
                         }
                     }
-                }
-            }
+
+                private:
+                    Edge* edges;
+                    const std::vector<int>& order;
+                    const std::vector<int>& starts;
+                    float* thresholds;
+                    PointSet* es;
+                    float k;
+                    std::vector<int>& joins;
+            };
 
             void GraphSegmentationImpl::segmentGraph(Edge *edges, const int &nb_edges, const Mat &img_filtered, PointSet **es) {
 
                 int total_points = ( int)(img_filtered.rows * img_filtered.cols);
 
                 // Sort edges
-                std::sort(edges, edges + nb_edges);
+                sortEdges(edges, nb_edges);
 
                 // Create a set with all point (by default mapped to themselves)
                 *es = new PointSet(img_filtered.cols * img_filtered.rows);
@@ -228,7 +365,46 @@ namespace cv {
                 for (int i = 0; i < total_points; i++)
                     thresholds[i] = k;
 
-                for ( int i = 0; i < nb_edges; i++) {
+                int first_edge = 0;
+                std::vector<int> order;
+
+                const int tiles_x = tile_size > 0 ? (img_filtered.cols + tile_size - 1) / tile_size : 1;
+                const int tiles_y = tile_size > 0 ? (img_filtered.rows + tile_size - 1) / tile_size : 1;
+                const int nb_tiles = tiles_x * tiles_y;
+
+                if (nb_tiles > 1) {
+                    // Edges inside of a tile are processed by tile in parallel, in the global order of each tile.
+                    // The edges between tiles are processed afterwards, by the sequential loop below.
+                    const int cols = img_filtered.cols;
+                    std::vector<int> tile_of_edge(nb_edges);
+                    std::vector<int> starts(nb_tiles + 2, 0);
+
+                    for (int i = 0; i < nb_edges; i++) {
+                        const int tile_from = (edges[i].from / cols / tile_size) * tiles_x + (edges[i].from % cols) / tile_size;
+                        const int tile_to = (edges[i].to / cols / tile_size) * tiles_x + (edges[i].to % cols) / tile_size;
+                        tile_of_edge[i] = tile_from == tile_to ? tile_from : nb_tiles;
+                        starts[tile_of_edge[i] + 1]++;
+                    }
+                    for (int t = 0; t <= nb_tiles; t++)
+                        starts[t + 1] += starts[t];
+
+                    order.resize(nb_edges);
+                    std::vector<int> positions(starts.begin(), starts.end() - 1);
+                    for (int i = 0; i < nb_edges; i++)
+                        order[positions[tile_of_edge[i]]++] = i;
+
+                    std::vector<int> joins(nb_tiles, 0);
+                    parallel_for_(Range(0, nb_tiles), TileForestInvoker(edges, order, starts, thresholds, *es, k, joins));
+
+                    for (int t = 0; t < nb_tiles; t++)
+                        (*es)->nb_elements -= joins[t];
+
+                    first_edge = starts[nb_tiles];
+                }
+
+                for ( int n = first_edge; n < nb_edges; n++) {
+
+                    const int i = order.empty() ? n : order[n];
 
                     int p_a = (*es)->getBasePoint(edges[i].from);
                     int p_b = (*es)->getBasePoint(edges[i].to);
@@ -378,14 +554,19 @@ namespace cv {
 
             void PointSet::joinPoints(int p_a, int p_b) {
 
+                linkPoints(p_a, p_b);
+
+                nb_elements--;
+            }
+
+            void PointSet::linkPoints(int p_a, int p_b) {
+
                 // Always target smaller set, to avoid redirection in getBasePoint
                 if (mapping[p_a].size < mapping[p_b].size)
                     swap(p_a, p_b);
 
                 mapping[p_b].p = p_a;
                 mapping[p_a].size += mapping[p_b].size;
-
-                nb_elements--;
             }
 
         }
@@ -36,6 +36,7 @@
 
 #include "precomp.hpp"
 #include "edgeaware_filters_common.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include <vector>
 
 #ifdef _MSC_VER
@@ -128,7 +129,7 @@ class GuidedFilterImpl : public GuidedFilter
 {
 public:
 
-    static Ptr<GuidedFilterImpl> create(InputArray guide, int radius, double eps);
+    static Ptr<GuidedFilterImpl> create(InputArray guide, int radius, double eps, double scale = 1.0);
 
     void filter(InputArray src, OutputArray dst, int dDepth = -1) CV_OVERRIDE;
 
@@ -137,7 +138,11 @@ protected:
     int radius;
     double eps;
     int h, w;
+    int origH, origW;
 
+    /* guideCn and all coefficients have size h x w, which is smaller than the size
+       of guideCnOrig origH x origW when the filter works in the subsampled mode */
+    vector<Mat> guideCnOrig;
     vector<Mat> guideCn;
     vector<Mat> guideCnMean;
 
@@ -149,7 +154,12 @@ protected:
 
     GuidedFilterImpl() {}
 
-    void init(InputArray guide, int radius, double eps);
+    void init(InputArray guide, int radius, double eps, double scale);
+
+    inline bool isSubsampled() const
+    {
+        return h != origH || w != origW;
+    }
 
     void computeCovGuide(SymArray2D<Mat>& covars);
 
@@ -303,6 +313,24 @@ private: /*Parallel body classes*/
 
         void operator () (const Range& range) const CV_OVERRIDE;
     };
+
+    /* Bilinear upsampling of the subsampled coefficients fused with applying them to the full
+       resolution guide, upsampled coefficients live only in a row buffer. Range is in rows of dst */
+    struct ApplyTransformUpsampled_ParBody : public ParallelLoopBody
+    {
+        GuidedFilterImpl &gf;
+        vector<vector<Mat> > &alpha;
+        vector<Mat> &beta;
+        vector<Mat> &dst;
+        vector<int> xofs;
+        vector<float> xalpha;
+
+        ApplyTransformUpsampled_ParBody(GuidedFilterImpl& gf_, vector<vector<Mat> >& alpha_, vector<Mat>& beta_, vector<Mat>& dst_);
+
+        void upsampleRow(const Mat& coef, int y0, int y1, float ay, float *rowBuf, float *dstRow) const;
+
+        void operator () (const Range& range) const CV_OVERRIDE;
+    };
 };
 
 void GuidedFilterImpl::MulChannelsGuide_ParBody::operator()(const Range& range) const
@@ -599,6 +627,113 @@ void GuidedFilterImpl::ApplyTransform_ParBody::operator()(const Range& range) co
     }
 }
 
+GuidedFilterImpl::ApplyTransformUpsampled_ParBody::ApplyTransformUpsampled_ParBody(GuidedFilterImpl& gf_, vector<vector<Mat> >& alpha_, vector<Mat>& beta_, vector<Mat>& dst_)
+    : gf(gf_), alpha(alpha_), beta(beta_), dst(dst_)
+{
+    //same pixel centers mapping as resize with INTER_LINEAR
+    float fx = (float)gf.w / gf.origW;
+    xofs.resize(gf.origW);
+    xalpha.resize(gf.origW);
+    for (int x = 0; x < gf.origW; x++)
+    {
+        float sx = (x + 0.5f)*fx - 0.5f;
+        int x0 = cvFloor(sx);
+        float ax = sx - x0;
+        if (x0 < 0)
+        {
+            x0 = 0;
+            ax = 0.f;
+        }
+        if (x0 >= gf.w - 1)
+        {
+            x0 = gf.w - 1;
+            ax = 0.f;
+        }
+        xofs[x] = x0;
+        xalpha[x] = ax;
+    }
+}
+
+void GuidedFilterImpl::ApplyTransformUpsampled_ParBody::upsampleRow(const Mat& coef, int y0, int y1, float ay, float *rowBuf, float *dstRow) const
+{
+    const float *s0 = coef.ptr<float>(y0);
+    const float *s1 = coef.ptr<float>(y1);
+    const int *ofs = &xofs[0];
+    const float *ax = &xalpha[0];
+
+    int j = 0;
+#if CV_SIMD128
+    v_float32x4 vay = v_setall_f32(ay);
+    for (; j <= gf.w - 4; j += 4)
+    {
+        v_float32x4 a = v_load(s0 + j);
+        v_store(rowBuf + j, v_fma(v_load(s1 + j) - a, vay, a));
+    }
+#endif
+    for (; j < gf.w; j++)
+        rowBuf[j] = s0[j] + (s1[j] - s0[j])*ay;
+    //xofs[x] + 1 may point to the last pixel, where xalpha is zero
+    rowBuf[gf.w] = rowBuf[gf.w - 1];
+
+    int x = 0;
+#if CV_SIMD128
+    for (; x <= gf.origW - 4; x += 4)
+    {
+        v_float32x4 a = v_lut(rowBuf, ofs + x);
+        v_float32x4 b = v_lut(rowBuf + 1, ofs + x);
+        v_store(dstRow + x, v_fma(b - a, v_load(ax + x), a));
+    }
+#endif
+    for (; x < gf.origW; x++)
+    {
+        float a = rowBuf[ofs[x]];
+        dstRow[x] = a + (rowBuf[ofs[x] + 1] - a)*ax[x];
+    }
+}
+
+void GuidedFilterImpl::ApplyTransformUpsampled_ParBody::operator()(const Range& range) const
+{
+    int srcCnNum = (int)alpha.size();
+    float fy = (float)gf.h / gf.origH;
+
+    vector<float> rowBuf(gf.w + 1);
+    vector<float> coefRow(gf.origW);
+
+    for (int i = range.start; i < range.end; i++)
+    {
+        float sy = (i + 0.5f)*fy - 0.5f;
+        int y0 = cvFloor(sy);
+        float ay = sy - y0;
+        if (y0 < 0)
+        {
+            y0 = 0;
+            ay = 0.f;
+        }
+        if (y0 >= gf.h - 1)
+        {
+            y0 = gf.h - 1;
+            ay = 0.f;
+        }
+        int y1 = std::min(y0 + 1, gf.h - 1);
+
+        float *_g[4];
+        for (int gi = 0; gi < gf.gCnNum; gi++)
+            _g[gi] = gf.guideCnOrig[gi].ptr<float>(i);
+
+        for (int si = 0; si < srcCnNum; si++)
+        {
+            float *dstRow = dst[si].ptr<float>(i);
+            upsampleRow(beta[si], y0, y1, ay, &rowBuf[0], dstRow);
+
+            for (int gi = 0; gi < gf.gCnNum; gi++)
+            {
+                upsampleRow(alpha[si][gi], y0, y1, ay, &rowBuf[0], &coefRow[0]);
+                add_mul(dstRow, &coefRow[0], _g[gi], gf.origW);
+            }
+        }
+    }
+}
+
 GuidedFilterImpl::GFTransform_ParBody::GFTransform_ParBody(GuidedFilterImpl& gf_, vector<Mat>& srcv, vector<Mat>& dstv, TransformFunc func_)
     : gf(gf_), func(func_)
 {
@@ -666,28 +801,43 @@ void GuidedFilterImpl::getWalkPattern(int eid, int &cn1, int &cn2)
     cn2 = wdata[6 * 2 * (gCnNum-1) + 6 + eid];
 }
 
-Ptr<GuidedFilterImpl> GuidedFilterImpl::create(InputArray guide, int radius, double eps)
+Ptr<GuidedFilterImpl> GuidedFilterImpl::create(InputArray guide, int radius, double eps, double scale)
 {
     GuidedFilterImpl *gf = new GuidedFilterImpl();
-    gf->init(guide, radius, eps);
+    gf->init(guide, radius, eps, scale);
     return Ptr<GuidedFilterImpl>(gf);
 }
 
-void GuidedFilterImpl::init(InputArray guide, int radius_, double eps_)
+void GuidedFilterImpl::init(InputArray guide, int radius_, double eps_, double scale_)
 {
     CV_Assert( !guide.empty() && radius_ >= 0 && eps_ >= 0 );
     CV_Assert( (guide.depth() == CV_32F || guide.depth() == CV_8U || guide.depth() == CV_16U) && (guide.channels() <= 3) );
+    CV_Assert( scale_ > 0 && scale_ <= 1 );
 
     radius = radius_;
     eps = eps_;
 
-    splitFirstNChannels(guide, guideCn, 3);
-    gCnNum = (int)guideCn.size();
-    h = guideCn[0].rows;
-    w = guideCn[0].cols;
+    splitFirstNChannels(guide, guideCnOrig, 3);
+    gCnNum = (int)guideCnOrig.size();
+    origH = guideCnOrig[0].rows;
+    origW = guideCnOrig[0].cols;
+    parConvertToWorkType(guideCnOrig, guideCnOrig);
+
+    h = std::max(cvRound(origH*scale_), 1);
+    w = std::max(cvRound(origW*scale_), 1);
+    if (isSubsampled())
+    {
+        radius = cvRound(radius_*scale_);
+        guideCn.resize(gCnNum);
+        for (int i = 0; i < gCnNum; i++)
+            resize(guideCnOrig[i], guideCn[i], Size(w, h), 0, 0, INTER_AREA);
+    }
+    else
+    {
+        guideCn = guideCnOrig;
+    }
 
     guideCnMean.resize(gCnNum);
-    parConvertToWorkType(guideCn, guideCn);
     parMeanFilter(guideCn, guideCnMean);
 
     SymArray2D<Mat> covars;
@@ -711,8 +861,10 @@ void GuidedFilterImpl::computeCovGuide(SymArray2D<Mat>& covars)
 
 void GuidedFilterImpl::filter(InputArray src, OutputArray dst, int dDepth /*= -1*/)
 {
+    CV_INSTRUMENT_REGION();
+
     CV_Assert( !src.empty() && (src.depth() == CV_32F || src.depth() == CV_8U) );
-    if (src.rows() != h || src.cols() != w)
+    if (src.rows() != origH || src.cols() != origW)
     {
         CV_Error(Error::StsBadSize, "Size of filtering image must be equal to size of guide image");
         return;
@@ -730,6 +882,12 @@ void GuidedFilterImpl::filter(InputArray src, OutputArray dst, int dDepth /*= -1
         parConvertToWorkType(srcCn, srcCn);
     }
 
+    if (isSubsampled())
+    {
+        for (int i = 0; i < srcCnNum; i++)
+            resize(srcCn[i], srcCn[i], Size(w, h), 0, 0, INTER_AREA);
+    }
+
     vector<vector<Mat> > covSrcGuide(srcCnNum);
     computeCovGuideAndSrc(srcCn, srcCnMean, covSrcGuide);
 
@@ -749,13 +907,26 @@ void GuidedFilterImpl::filter(InputArray src, OutputArray dst, int dDepth /*= -1
     parMeanFilter(beta, beta);
     parMeanFilter(alpha, alpha);
 
-    runParBody(ApplyTransform_ParBody(*this, alpha, beta));
+    vector<Mat> dstCn;
+    if (isSubsampled())
+    {
+        dstCn.resize(srcCnNum);
+        for (int i = 0; i < srcCnNum; i++)
+            dstCn[i].create(origH, origW, CV_32FC1);
+        parallel_for_(Range(0, origH), ApplyTransformUpsampled_ParBody(*this, alpha, beta, dstCn));
+    }
+    else
+    {
+        runParBody(ApplyTransform_ParBody(*this, alpha, beta));
+        dstCn = beta;
+    }
+
     if (dDepth != CV_32F)
     {
         for (int i = 0; i < srcCnNum; i++)
-            beta[i].convertTo(beta[i], dDepth);
+            dstCn[i].convertTo(dstCn[i], dDepth);
     }
-    merge(beta, dst);
+    merge(dstCn, dst);
 }
 
 void GuidedFilterImpl::computeCovGuideAndSrc(vector<Mat>& srcCn, vector<Mat>& srcCnMean, vector<vector<Mat> >& cov)
@@ -782,15 +953,17 @@ void GuidedFilterImpl::computeCovGuideAndSrc(vector<Mat>& srcCn, vector<Mat>& sr
 //////////////////////////////////////////////////////////////////////////
 
 CV_EXPORTS_W
-Ptr<GuidedFilter> createGuidedFilter(InputArray guide, int radius, double eps)
+Ptr<GuidedFilter> createGuidedFilter(InputArray guide, int radius, double eps, double scale)
 {
-    return Ptr<GuidedFilter>(GuidedFilterImpl::create(guide, radius, eps));
+    return Ptr<GuidedFilter>(GuidedFilterImpl::create(guide, radius, eps, scale));
 }
 
 CV_EXPORTS_W
-void guidedFilter(InputArray guide, InputArray src, OutputArray dst, int radius, double eps, int dDepth)
+void guidedFilter(InputArray guide, InputArray src, OutputArray dst, int radius, double eps, int dDepth, double scale)
 {
-    Ptr<GuidedFilter> gf = createGuidedFilter(guide, radius, eps);
+    CV_INSTRUMENT_REGION();
+
+    Ptr<GuidedFilter> gf = createGuidedFilter(guide, radius, eps, scale);
     gf->filter(src, dst, dDepth);
 }
 
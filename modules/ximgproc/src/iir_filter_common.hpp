@@ -0,0 +1,128 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_IIR_FILTER_COMMON_HPP__
+#define __OPENCV_IIR_FILTER_COMMON_HPP__
+
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv {
+namespace ximgproc {
+
+/* Load/store helpers shared by the recursive (Deriche, Paillou) gradient filters.
+ * A 1D recursive line is written once against a lane type VT: with VT = float it
+ * filters one row or column, with VT = v_float32x4 it filters four adjacent
+ * columns at once, the vertical step being carried by the line stride. */
+template<typename VT> struct IIRVec;
+
+template<> struct IIRVec<float>
+{
+    enum { nlanes = 1 };
+    static inline float all(float v) { return v; }
+    template<typename T> static inline float load(const T* p) { return (float)*p; }
+    static inline void store(float* p, float v) { *p = v; }
+};
+
+#if CV_SIMD128
+template<> struct IIRVec<v_float32x4>
+{
+    enum { nlanes = 4 };
+    static inline v_float32x4 all(float v) { return v_setall_f32(v); }
+    static inline v_float32x4 load(const uchar* p) { return v_cvt_f32(v_reinterpret_as_s32(v_load_expand_q(p))); }
+    static inline v_float32x4 load(const schar* p) { return v_cvt_f32(v_load_expand_q(p)); }
+    static inline v_float32x4 load(const ushort* p) { return v_cvt_f32(v_reinterpret_as_s32(v_load_expand(p))); }
+    static inline v_float32x4 load(const short* p) { return v_cvt_f32(v_load_expand(p)); }
+    static inline v_float32x4 load(const float* p) { return v_load(p); }
+    static inline void store(float* p, const v_float32x4& v) { v_store(p, v); }
+};
+#endif
+
+/* Runs LineOp::apply<T, VT> down the columns [r.start, r.end) of img, several columns
+ * per call when SIMD is available. */
+template<typename T, typename LineOp> static void
+IIRFilterCols(const Mat& img, Mat& dst, const Range& r, const LineOp& op)
+{
+    const size_t sstep = img.step1(), dstep = dst.step1();
+    const T* src = img.ptr<T>(0);
+    float* d = dst.ptr<float>(0);
+    int j = r.start;
+#if CV_SIMD128
+    for (; j <= r.end - IIRVec<v_float32x4>::nlanes; j += IIRVec<v_float32x4>::nlanes)
+        op.template apply<T, v_float32x4>(src + j, sstep, d + j, dstep, img.rows);
+#endif
+    for (; j < r.end; j++)
+        op.template apply<T, float>(src + j, sstep, d + j, dstep, img.rows);
+}
+
+/* Runs LineOp::apply<T, float> along the rows [r.start, r.end) of img. */
+template<typename T, typename LineOp> static void
+IIRFilterRows(const Mat& img, Mat& dst, const Range& r, const LineOp& op)
+{
+    for (int i = r.start; i < r.end; i++)
+        op.template apply<T, float>(img.ptr<T>(i), 1, dst.ptr<float>(i), 1, img.cols);
+}
+
+/* Depth dispatch for the two drivers above. */
+template<typename LineOp> static void
+IIRFilter(const Mat& img, Mat& dst, const Range& r, const LineOp& op, bool vertical)
+{
+    switch (img.depth())
+    {
+    case CV_8U:
+        vertical ? IIRFilterCols<uchar>(img, dst, r, op) : IIRFilterRows<uchar>(img, dst, r, op);
+        break;
+    case CV_8S:
+        vertical ? IIRFilterCols<schar>(img, dst, r, op) : IIRFilterRows<schar>(img, dst, r, op);
+        break;
+    case CV_16U:
+        vertical ? IIRFilterCols<ushort>(img, dst, r, op) : IIRFilterRows<ushort>(img, dst, r, op);
+        break;
+    case CV_16S:
+        vertical ? IIRFilterCols<short>(img, dst, r, op) : IIRFilterRows<short>(img, dst, r, op);
+        break;
+    case CV_32F:
+        vertical ? IIRFilterCols<float>(img, dst, r, op) : IIRFilterRows<float>(img, dst, r, op);
+        break;
+    default:
+        CV_Error(Error::StsUnsupportedFormat, "Unsupported input depth for recursive filter");
+    }
+}
+
+/* Parallel body: filters columns (vertical) or rows of img into the CV_32FC1 dst. */
+template<typename LineOp> class ParallelIIRFilter : public ParallelLoopBody
+{
+public:
+    ParallelIIRFilter(const Mat& img_, Mat& dst_, const LineOp& op_, bool vertical_) :
+        img(img_), dst(dst_), op(op_), vertical(vertical_)
+    {
+        int type = img.type();
+        CV_CheckType(type, type == CV_8UC1 || type == CV_8SC1 || type == CV_16SC1 || type == CV_16UC1 || type == CV_32FC1, "Wrong input type for recursive filter");
+        type = dst.type();
+        CV_CheckType(type, type == CV_32FC1, "Wrong output type for recursive filter");
+        CV_Assert(img.size() == dst.size());
+    }
+    virtual void operator()(const Range& range) const CV_OVERRIDE
+    {
+        IIRFilter(img, dst, range, op, vertical);
+    }
+    ParallelIIRFilter& operator=(const ParallelIIRFilter&) {
+        return *this;
+    }
+private:
+    const Mat& img;
+    Mat& dst;
+    LineOp op;
+    bool vertical;
+};
+
+template<typename LineOp> static void
+runIIRFilter(const Mat& img, Mat& dst, const LineOp& op, bool vertical)
+{
+    ParallelIIRFilter<LineOp> body(img, dst, op, vertical);
+    parallel_for_(Range(0, vertical ? img.cols : img.rows), body, getNumThreads());
+}
+
+}
+}
+#endif
@@ -338,6 +338,8 @@ void jointBilateralFilter_8u(Mat& joint, Mat& src, Mat& dst, int radius, double
 
 void jointBilateralFilter(InputArray joint_, InputArray src_, OutputArray dst_, int d, double sigmaColor, double sigmaSpace, int borderType)
 {
+    CV_INSTRUMENT_REGION();
+
     CV_Assert(!src_.empty());
 
     if (joint_.empty())
@@ -81,44 +81,6 @@ namespace
         }
     };
 
-    class ParallelDivComplexByReal : public ParallelLoopBody
-    {
-    private:
-        vector<Mat> numer_;
-        vector<Mat> denom_;
-        vector<Mat> dst_;
-
-    public:
-        ParallelDivComplexByReal(vector<Mat> &numer, vector<Mat> &denom, vector<Mat> &dst)
-        {
-            numer_ = numer;
-            denom_ = denom;
-            dst_ = dst;
-        }
-        void operator() (const Range& range) const CV_OVERRIDE
-        {
-            for (int i = range.start; i != range.end; i++)
-            {
-                Mat aPanels[2];
-                Mat bPanels[2];
-                split(numer_[i], aPanels);
-                split(denom_[i], bPanels);
-
-                Mat realPart;
-                Mat imaginaryPart;
-
-                divide(aPanels[0], denom_[i], realPart);
-                divide(aPanels[1], denom_[i], imaginaryPart);
-
-                aPanels[0] = realPart;
-                aPanels[1] = imaginaryPart;
-
-                merge(aPanels, 2, dst_[i]);
-            }
-        }
-    };
-
-
     void shift(InputArray src, OutputArray dst, int shift_x, int shift_y)
     {
         Mat S = src.getMat();
@@ -180,63 +142,177 @@ namespace
         fft(padded, dst);
     }
 
-    void dftMultiChannel(InputArray src, vector<Mat> &dst)
+        // power of 2 of the absolute value of the complex
+    Mat pow2absComplex(InputArray src)
     {
         Mat S = src.getMat();
 
-        split(S, dst);
-
-        for(int i = 0; i < S.channels(); i++){
-            Mat planes[] = {dst[i].clone(), Mat::zeros(dst[i].size(), dst[i].type())};
-            merge(planes, 2, dst[i]);
-        }
+        Mat sPanels[2];
+        split(S, sPanels);
 
-        parallel_for_(cv::Range(0,S.channels()), ParallelDft(dst));
+        Mat mag;
+        magnitude(sPanels[0], sPanels[1], mag);
+        pow(mag, 2, mag);
 
+        return mag;
     }
+}
 
-    void idftMultiChannel(const vector<Mat> &src, OutputArray dst)
+    // forward differences with replicated border, zeroed where the squared gradient magnitude
+    // summed over channels does not exceed the threshold
+    class ParallelL0Gradients : public ParallelLoopBody
     {
-        vector<Mat> channels(src);
+    private:
+        const Mat &src_;
+        Mat &h_, &v_;
+        float thresh_;
+    public:
+        ParallelL0Gradients(const Mat &src, Mat &h, Mat &v, float thresh)
+            : src_(src), h_(h), v_(v), thresh_(thresh) {}
 
-        parallel_for_(Range(0, int(src.size())), ParallelIdft(channels));
+        void operator() (const Range& range) const CV_OVERRIDE
+        {
+            const int cn = src_.channels();
+            const int cols = src_.cols;
+            for (int y = range.start; y < range.end; y++)
+            {
+                const float *s0 = src_.ptr<float>(y);
+                const float *s1 = src_.ptr<float>(std::min(y + 1, src_.rows - 1));
+                float *hRow = h_.ptr<float>(y);
+                float *vRow = v_.ptr<float>(y);
 
-        for(int i = 0; unsigned(i) < src.size(); i++){
-            Mat panels[2];
-            split(channels[i], panels);
-            channels[i] = panels[0];
-        }
+                for (int x = 0; x < cols; x++)
+                {
+                    const int i = x * cn;
+                    const int iNext = std::min(x + 1, cols - 1) * cn;
 
-        Mat D;
-        merge(channels, D);
-        D.copyTo(dst);
-    }
+                    float mag = 0;
+                    for (int c = 0; c < cn; c++)
+                    {
+                        float dh = s0[iNext + c] - s0[i + c];
+                        float dv = s1[i + c] - s0[i + c];
+                        hRow[i + c] = dh;
+                        vRow[i + c] = dv;
+                        mag += dh * dh + dv * dv;
+                    }
 
-    void divComplexByRealMultiChannel(vector<Mat> &numer,
-        vector<Mat> &denom, vector<Mat> &dst)
+                    if (!(mag > thresh_))
+                    {
+                        for (int c = 0; c < cn; c++)
+                            hRow[i + c] = vRow[i + c] = 0;
+                    }
+                }
+            }
+        }
+    };
+
+    // backward differences of h and v (reflected border), channels 2k and 2k+1 are written
+    // as the real and imaginary parts of the k-th complex plane
+    class ParallelL0Divergence : public ParallelLoopBody
     {
+    private:
+        const Mat &h_, &v_;
+        vector<Mat> &dst_;
+    public:
+        ParallelL0Divergence(const Mat &h, const Mat &v, vector<Mat> &dst)
+            : h_(h), v_(v), dst_(dst) {}
 
-        for(int i = 0; unsigned(i) < numer.size(); i++)
+        void operator() (const Range& range) const CV_OVERRIDE
         {
-            dst[i].create(numer[i].size(), numer[i].type());
-        }
-        parallel_for_(Range(0, int(numer.size())), ParallelDivComplexByReal(numer, denom, dst));
+            const int cn = h_.channels();
+            const int cols = h_.cols;
+            const int xFirstPrev = cols > 1 ? 1 : 0;
+            for (int y = range.start; y < range.end; y++)
+            {
+                const int yPrev = y > 0 ? y - 1 : (h_.rows > 1 ? 1 : 0);
+                const float *hRow = h_.ptr<float>(y);
+                const float *vRow = v_.ptr<float>(y);
+                const float *vPrevRow = v_.ptr<float>(yPrev);
 
-    }
+                for (int c = 0; c < cn; c++)
+                {
+                    float *d = dst_[c >> 1].ptr<float>(y) + (c & 1);
+                    for (int x = 0; x < cols; x++)
+                    {
+                        const int i = x * cn + c;
+                        const int iPrev = (x > 0 ? x - 1 : xFirstPrev) * cn + c;
+                        d[2 * x] = (hRow[iPrev] - hRow[i]) + (vPrevRow[i] - vRow[i]);
+                    }
+                }
 
-        // power of 2 of the absolute value of the complex
-    Mat pow2absComplex(InputArray src)
+                if (cn & 1)
+                {
+                    float *d = dst_[cn >> 1].ptr<float>(y) + 1;
+                    for (int x = 0; x < cols; x++)
+                        d[2 * x] = 0;
+                }
+            }
+        }
+    };
+
+    // S subproblem in frequency domain: (F(I) + beta*F(div)) / (1 + beta*(|F(dx)|^2 + |F(dy)|^2))
+    class ParallelL0Update : public ParallelLoopBody
     {
-        Mat S = src.getMat();
+    private:
+        vector<Mat> &freq_;
+        const vector<Mat> &numerConst_;
+        const Mat &denomConst_;
+        float beta_;
+    public:
+        ParallelL0Update(vector<Mat> &freq, const vector<Mat> &numerConst, const Mat &denomConst, float beta)
+            : freq_(freq), numerConst_(numerConst), denomConst_(denomConst), beta_(beta) {}
 
-        Mat sPanels[2];
-        split(S, sPanels);
+        void operator() (const Range& range) const CV_OVERRIDE
+        {
+            const int cols = denomConst_.cols;
+            for (int y = range.start; y < range.end; y++)
+            {
+                const float *denomRow = denomConst_.ptr<float>(y);
+                for (size_t k = 0; k < freq_.size(); k++)
+                {
+                    Vec2f *f = freq_[k].ptr<Vec2f>(y);
+                    const Vec2f *n = numerConst_[k].ptr<Vec2f>(y);
+                    for (int x = 0; x < cols; x++)
+                    {
+                        float w = 1.f / (beta_ * denomRow[x] + 1.f);
+                        f[x][0] = (n[x][0] + f[x][0] * beta_) * w;
+                        f[x][1] = (n[x][1] + f[x][1] * beta_) * w;
+                    }
+                }
+            }
+        }
+    };
 
-        Mat mag;
-        magnitude(sPanels[0], sPanels[1], mag);
-        pow(mag, 2, mag);
+    // channels 2k and 2k+1 of src become the real and imaginary parts of dst[k]
+    void packChannels(const Mat &src, vector<Mat> &dst)
+    {
+        const int cn = src.channels();
+        vector<int> fromTo;
+        dst.resize((cn + 1) / 2);
+        for (size_t k = 0; k < dst.size(); k++)
+        {
+            dst[k].create(src.size(), CV_32FC2);
+            if (2 * (int)k + 1 == cn)
+                dst[k].setTo(Scalar::all(0));
+        }
+        for (int c = 0; c < cn; c++)
+        {
+            fromTo.push_back(c);
+            fromTo.push_back(c);
+        }
+        mixChannels(&src, 1, &dst[0], dst.size(), &fromTo[0], cn);
+    }
 
-        return mag;
+    void unpackChannels(const vector<Mat> &src, Mat &dst)
+    {
+        const int cn = dst.channels();
+        vector<int> fromTo;
+        for (int c = 0; c < cn; c++)
+        {
+            fromTo.push_back(c);
+            fromTo.push_back(c);
+        }
+        mixChannels(&src[0], src.size(), &dst, 1, &fromTo[0], cn);
     }
 }
 
@@ -245,22 +321,50 @@ namespace cv
     namespace ximgproc
     {
 
-        void l0Smooth(InputArray src, OutputArray dst, double lambda, double kappa)
+        class L0SmootherImpl : public L0Smoother
+        {
+        public:
+            L0SmootherImpl(double lambda, double kappa) : lambda_(lambda), kappa_(kappa)
+            {
+                CV_Assert(lambda > 0.0);
+                CV_Assert(kappa > 1.0);
+            }
+
+            void smooth(InputArray src, OutputArray dst) CV_OVERRIDE;
+
+        private:
+            void prepareDenominator(Size sz);
+
+            double lambda_, kappa_;
+
+            // |F(dx)|^2 + |F(dy)|^2 of the last processed size
+            Mat denomConst_;
+
+            Mat h_, v_;
+            vector<Mat> numerConst_, freq_;
+        };
+
+        void L0SmootherImpl::prepareDenominator(Size sz)
+        {
+            if (denomConst_.size() == sz)
+                return;
+
+            // gradient operators in frequency domain
+            Mat otfFx, otfFy;
+            float kernel_inv[2] = {1,-1};
+            psf2otf(Mat(1,2,CV_32FC1, kernel_inv), otfFx, sz.height, sz.width);
+            psf2otf(Mat(2,1,CV_32FC1, kernel_inv), otfFy, sz.height, sz.width);
+
+            denomConst_ = pow2absComplex(otfFx) + pow2absComplex(otfFy);
+        }
+
+        void L0SmootherImpl::smooth(InputArray src, OutputArray dst)
         {
             Mat S = src.getMat();
 
             CV_Assert(!S.empty());
             CV_Assert(S.depth() == CV_8U || S.depth() == CV_16U
             || S.depth() == CV_32F || S.depth() == CV_64F);
-            CV_Assert(lambda > 0.0);
-            CV_Assert(kappa > 1.0);
-
-            dst.create(src.size(), src.type());
-
-            if(S.data == dst.getMat().data)
-            {
-                S = S.clone();
-            }
 
             if(S.depth() == CV_8U)
             {
@@ -274,112 +378,74 @@ namespace cv
             {
                 S.convertTo(S, CV_32F);
             }
-
-            const double betaMax = 100000;
-
-            // gradient operators in frequency domain
-            Mat otfFx, otfFy;
-            float kernel[2] = {-1, 1};
-            float kernel_inv[2] = {1,-1};
-            psf2otf(Mat(1,2,CV_32FC1, kernel_inv), otfFx, S.rows, S.cols);
-            psf2otf(Mat(2,1,CV_32FC1, kernel_inv), otfFy, S.rows, S.cols);
-
-            vector<Mat> denomConst;
-            Mat tmp = pow2absComplex(otfFx) + pow2absComplex(otfFy);
-
-            for(int i = 0; i < S.channels(); i++)
+            else
             {
-                denomConst.push_back(tmp);
+                // S is overwritten by the solver
+                S = S.clone();
             }
 
-            // input image in frequency domain
-            vector<Mat> numerConst;
-            dftMultiChannel(S, numerConst);
+            const double betaMax = 100000;
+            const int cn = S.channels();
+            const int nPlanes = (cn + 1) / 2;
+
+            prepareDenominator(S.size());
+            h_.create(S.size(), S.type());
+            v_.create(S.size(), S.type());
+            freq_.resize(nPlanes);
+            for (int k = 0; k < nPlanes; k++)
+                freq_[k].create(S.size(), CV_32FC2);
+
+            // input image in frequency domain, the filter in frequency domain is real and
+            // symmetric so the pairs of channels are transformed as one complex image
+            packChannels(S, numerConst_);
+            parallel_for_(Range(0, nPlanes), ParallelDft(numerConst_));
             /*********************************
             * solver
             *********************************/
-            double beta = 2 * lambda;
+            double beta = 2 * lambda_;
             while(beta < betaMax){
                 // h, v subproblem
-                Mat h, v;
-
-                filter2D(S, h, -1, Mat(1, 2, CV_32FC1, kernel), Point(0, 0),
-                0, BORDER_REPLICATE);
-                filter2D(S, v, -1, Mat(2, 1, CV_32FC1, kernel), Point(0, 0),
-                0, BORDER_REPLICATE);
-
-                Mat hvMag = h.mul(h) + v.mul(v);
-
-                Mat mask;
-                if(S.channels() == 1)
-                {
-                    threshold(hvMag, mask, lambda/beta, 1, THRESH_BINARY);
-                }
-                else if(S.channels() > 1)
-                {
-                    vector<Mat> channels(S.channels());
-                    split(hvMag, channels);
-                    hvMag = channels[0];
-
-                    for(int i = 1; i < S.channels(); i++)
-                    {
-                        hvMag = hvMag + channels[i];
-                    }
-
-                    threshold(hvMag, mask, lambda/beta, 1, THRESH_BINARY);
-
-                    Mat in[] = {mask, mask, mask};
-                    merge(in, 3, mask);
-                }
-
-                h = h.mul(mask);
-                v = v.mul(mask);
+                parallel_for_(Range(0, S.rows), ParallelL0Gradients(S, h_, v_, (float)(lambda_/beta)));
 
                 // S subproblem
-                vector<Mat> denom(S.channels());
-                for(int i = 0; i < S.channels(); i++)
-                {
-                    denom[i] = beta * denomConst[i] + 1;
-                }
-
-                Mat hGrad, vGrad;
-                filter2D(h, hGrad, -1, Mat(1, 2, CV_32FC1, kernel_inv));
-                filter2D(v, vGrad, -1, Mat(2, 1, CV_32FC1, kernel_inv));
-
-                vector<Mat> hvGradFreq;
-                dftMultiChannel(hGrad+vGrad, hvGradFreq);
-
-                vector<Mat> numer(S.channels());
-                for(int i = 0; i < S.channels(); i++)
-                {
-                    numer[i] = numerConst[i] + hvGradFreq[i] * beta;
-                }
-
-                vector<Mat> sFreq(S.channels());
-                divComplexByRealMultiChannel(numer, denom, sFreq);
+                parallel_for_(Range(0, S.rows), ParallelL0Divergence(h_, v_, freq_));
+                parallel_for_(Range(0, nPlanes), ParallelDft(freq_));
+                parallel_for_(Range(0, S.rows), ParallelL0Update(freq_, numerConst_, denomConst_, (float)beta));
+                parallel_for_(Range(0, nPlanes), ParallelIdft(freq_));
+                unpackChannels(freq_, S);
 
-                idftMultiChannel(sFreq, S);
-
-                beta = beta * kappa;
+                beta = beta * kappa_;
             }
 
-            Mat D = dst.getMat();
-            if(D.depth() == CV_8U)
+            int dDepth = src.depth();
+            if(dDepth == CV_8U)
             {
-                S.convertTo(D, CV_8U, 255);
+                S.convertTo(dst, CV_8U, 255);
             }
-            else if(D.depth() == CV_16U)
+            else if(dDepth == CV_16U)
             {
-                S.convertTo(D, CV_16U, 65535);
+                S.convertTo(dst, CV_16U, 65535);
             }
-            else if(D.depth() == CV_64F)
+            else if(dDepth == CV_64F)
             {
-                S.convertTo(D, CV_64F);
+                S.convertTo(dst, CV_64F);
             }
             else
             {
-                S.copyTo(D);
+                S.copyTo(dst);
             }
         }
+
+        Ptr<L0Smoother> createL0Smoother(double lambda, double kappa)
+        {
+            return makePtr<L0SmootherImpl>(lambda, kappa);
+        }
+
+        void l0Smooth(InputArray src, OutputArray dst, double lambda, double kappa)
+        {
+            CV_INSTRUMENT_REGION();
+
+            createL0Smoother(lambda, kappa)->smooth(src, dst);
+        }
     }
 }
@@ -64,6 +64,9 @@ public:
     // perform amount of iteration
     virtual void iterate( int num_iterations = 10 ) CV_OVERRIDE;
 
+    // continue from current centers on next frame
+    virtual void updateImage( InputArray image, InputArray flow = noArray() ) CV_OVERRIDE;
+
     // get amount of superpixels
     virtual int getNumberOfSuperpixels() const CV_OVERRIDE;
 
@@ -262,6 +265,59 @@ void SuperpixelLSCImpl::iterate( int num_iterations )
     PerformLSC( num_iterations );
 }
 
+void SuperpixelLSCImpl::updateImage( InputArray _image, InputArray _flow )
+{
+    vector<Mat> chvec;
+    if ( _image.isMat() )
+    {
+      Mat image = _image.getMat();
+      CV_Assert( !image.empty() );
+      split( image, chvec );
+    }
+    else if ( _image.isMatVector() )
+      _image.getMatVector( chvec );
+    else
+      CV_Error( Error::StsInternal, "Invalid InputArray." );
+
+    // frames should be alike
+    CV_Assert( (int) chvec.size() == m_nr_channels );
+    CV_Assert( chvec[0].size() == Size( m_width, m_height ) );
+    CV_Assert( chvec[0].depth() == m_chvec[0].depth() );
+    m_chvec = chvec;
+
+    // max intensity
+    m_chvec_max = 0.0f;
+    for( int b = 0; b < m_nr_channels; b++ )
+    {
+      double chmin, chmax;
+      minMaxIdx( m_chvec[b], &chmin, &chmax );
+      if ( m_chvec_max < chmax ) m_chvec_max = (float) chmax;
+    }
+
+    // move centers along the motion
+    if ( !_flow.empty() )
+    {
+      Mat flow = _flow.getMat();
+      CV_Assert( flow.type() == CV_32FC2 && flow.size() == Size( m_width, m_height ) );
+      for( size_t n = 0; n < m_kseedsx.size(); n++ )
+      {
+        int x = min( max( cvRound(m_kseedsx[n]), 0 ), m_width - 1 );
+        int y = min( max( cvRound(m_kseedsy[n]), 0 ), m_height - 1 );
+        const Point2f& d = flow.at<Point2f>(y,x);
+        m_kseedsx[n] = min( max( m_kseedsx[n] + d.x, 0.0f ), (float)(m_width - 1) );
+        m_kseedsy[n] = min( max( m_kseedsy[n] + d.y, 0.0f ), (float)(m_height - 1) );
+      }
+    }
+
+    // labels may be recounted by connectivity,
+    // start from the same state as a new grid
+    m_klabels.setTo( Scalar::all(0) );
+    m_numlabels = (int) m_kseedsx.size();
+
+    // feature space
+    GetFeatureSpace();
+}
+
 void SuperpixelLSCImpl::getLabels(OutputArray labels_out) const
 {
     labels_out.assign( m_klabels );
@@ -1329,6 +1385,31 @@ struct FeatureSpaceCenters : ParallelLoopBody
     vector<float> *centerY1, *centerY2;
 };
 
+/*
+ * FeatureSpaceKmeans is run over rows, these are the
+ * seeds whose windows intersect every band of rows,
+ * in increasing order as in a loop over the seeds.
+ */
+struct SeedBands
+{
+    vector< vector<int> > bands;
+    int band_height;
+
+    SeedBands( const vector<float>& kseedsy, int numlabels, int height, int stepy )
+    {
+      band_height = max( stepy, 1 );
+      bands.resize( (height + band_height - 1) / band_height );
+      for( int i = 0; i < numlabels; i++ )
+      {
+        int Y = (int)kseedsy[i];
+        int minY = (Y-(stepy) <= 0) ? 0 : Y-stepy;
+        int maxY = (Y+(stepy) >= height-1) ? height-1 : Y+stepy;
+        for( int b = minY / band_height; b <= maxY / band_height; b++ )
+          bands[b].push_back(i);
+      }
+    }
+};
+
 struct FeatureSpaceKmeans : ParallelLoopBody
 {
     FeatureSpaceKmeans( Mat* _klabels, Mat* _dist,
@@ -1339,9 +1420,10 @@ struct FeatureSpaceKmeans : ParallelLoopBody
                         vector< vector<float> >& _centerC1, vector< vector<float> >& _centerC2,
                         const int _nr_channels, const float _chvec_max,
                         const float _dist_coeff, const float _color_coeff,
-                        const int _stepx, const int _stepy )
+                        const int _stepx, const int _stepy, const SeedBands* _seedbands )
     {
       W = _W;
+      seedbands = _seedbands;
       dist = _dist;
       chvec = _chvec;
       stepx = _stepx;
@@ -1364,26 +1446,32 @@ struct FeatureSpaceKmeans : ParallelLoopBody
       centerC1 = _centerC1; centerC2 = _centerC2;
     }
 
+    // range is over rows, every pixel is visited by
+    // its seeds in increasing order so labels do not
+    // depend on the parallel split
     void operator()( const Range& range ) const CV_OVERRIDE
     {
-      for( int i = range.start; i < range.end; i++ )
+      for( int y = range.start; y < range.end; y++ )
       {
-        int X = (int)kseedsx[i]; int Y = (int)kseedsy[i];
-        int minX = (X-(stepx) <= 0) ? 0 : X-stepx;
-        int minY = (Y-(stepy) <= 0) ? 0 : Y-stepy;
-        int maxX = (X+(stepx) >= width -1) ? width -1 : X+stepx;
-        int maxY = (Y+(stepy) >= height-1) ? height-1 : Y+stepy;
-
-        for( int x = minX; x <= maxX; x++ )
+        const vector<int>& band = seedbands->bands[y / seedbands->band_height];
+        for( size_t k = 0; k < band.size(); k++ )
         {
-          float thetaX = ( (float) x / (float) stepx ) * PI2;
+          const int i = band[k];
+          int X = (int)kseedsx[i]; int Y = (int)kseedsy[i];
+          int minX = (X-(stepx) <= 0) ? 0 : X-stepx;
+          int minY = (Y-(stepy) <= 0) ? 0 : Y-stepy;
+          int maxX = (X+(stepx) >= width -1) ? width -1 : X+stepx;
+          int maxY = (Y+(stepy) >= height-1) ? height-1 : Y+stepy;
+          if ( y < minY || y > maxY ) continue;
 
-          float tx1 = dist_coeff * cos(thetaX);
-          float tx2 = dist_coeff * sin(thetaX);
+          float thetaY = ( (float) y / (float) stepy ) * PI2;
 
-          for( int y = minY; y <= maxY; y++ )
+          for( int x = minX; x <= maxX; x++ )
           {
-            float thetaY = ( (float) y / (float) stepy ) * PI2;
+            float thetaX = ( (float) x / (float) stepx ) * PI2;
+
+            float tx1 = dist_coeff * cos(thetaX);
+            float tx2 = dist_coeff * sin(thetaX);
 
             // we do not store pre-computed x1, x2
             float x1 = tx1 / W.at<float>(y,x);
@@ -1461,6 +1549,7 @@ struct FeatureSpaceKmeans : ParallelLoopBody
     float dist_coeff;
     float color_coeff;
 
+    const SeedBands* seedbands;
     Mat* dist;
     Mat* klabels;
     vector<Mat> chvec;
@@ -1767,11 +1856,12 @@ inline void SuperpixelLSCImpl::PerformLSC( const int&  itrnum )
       dist.setTo( FLT_MAX );
 
       // k-mean
-      parallel_for_( Range(0, m_numlabels), FeatureSpaceKmeans(
+      SeedBands seedbands( m_kseedsy, m_numlabels, m_height, m_stepy );
+      parallel_for_( Range(0, m_height), FeatureSpaceKmeans(
                      &m_klabels, &dist, m_chvec, m_W, m_kseedsx, m_kseedsy,
                      centerX1, centerX2, centerY1, centerY2, centerC1, centerC2,
                      m_nr_channels, m_chvec_max, m_dist_coeff, m_color_coeff,
-                     m_stepx, m_stepy ) );
+                     m_stepx, m_stepy, &seedbands ) );
 
       // parallel reduce structure
       FeatureCenterDists fcd( m_chvec, m_W, m_klabels, m_nr_channels, m_chvec_max,
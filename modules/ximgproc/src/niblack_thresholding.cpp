@@ -49,6 +49,8 @@ namespace ximgproc {
 void niBlackThreshold( InputArray _src, OutputArray _dst, double maxValue,
         int type, int blockSize, double k, int binarizationMethod, double r)
 {
+    CV_INSTRUMENT_REGION();
+
     // Input grayscale image
     Mat src = _src.getMat();
     CV_Assert(src.channels() == 1);
@@ -34,9 +34,9 @@
 *  the use of this software, even if advised of the possibility of such damage.
 */
 #include "precomp.hpp"
+#include "iir_filter_common.hpp"
 #include <math.h>
 #include <vector>
-#include <iostream>
 
 /*
 If you use this code please cite this @cite paillou1997detecting
@@ -47,376 +47,135 @@ Equation xx pyyy mean equation xx at page yyy in previous paper
 namespace cv {
 namespace ximgproc {
 
-template<typename T> static void
-VerticalIIRFilter(Mat &img, Mat &dst, const Range &range, double a,double w)
+struct PaillouCoeffs
 {
-    float *f2;
-    int tailleSequence = (img.rows>img.cols) ? img.rows : img.cols;
-    Mat matYp(1, tailleSequence, CV_64FC1), matYm(1, tailleSequence, CV_64FC1);
-    double *yp = matYp.ptr<double>(0), *ym = matYm.ptr<double>(0);
-    int rows = img.rows, cols = img.cols;
-
-    // Equation 12 p193
-    double                b1 = -2 * exp(-a)*cosh(w);
-    double                a1 = 2 * exp(-a)*cosh(w) - exp(-2 * a) - 1;
-    double                b2 = exp(-2 * a);
-    for (int j = range.start; j < range.end; j++)
-    {
-        // Equation 26 p194
-        T *c1 = (T *)img.ptr(0) + j;
-        f2 = dst.ptr<float>(0) + j;
-        double border = *c1;
-        yp[0] = *c1;
-        c1 += cols;
-        yp[1] = *c1 - b1*yp[0] - b2*border;
-        c1 += cols;
-        for (int i = 2; i < rows; i++, c1 += cols)
-            yp[i] = *c1 - b1*yp[i - 1] - b2*yp[i - 2];
-        // Equation 27 p194
-        c1 = (T *)img.ptr(rows - 1) + j;
-        border = *c1;
-        ym[rows - 1] = *c1;
-        c1 -= cols;
-        ym[rows - 2] = *c1 - b1*ym[rows - 1];
-        c1 -= cols;
-        for (int i = rows - 3; i >= 0; i--, c1 -= cols)
-            ym[i] = *c1 - b1*ym[i + 1] - b2*ym[i + 2];
-        // Equation 25 p193
-        for (int i = 0; i < rows; i++, f2 += cols)
-            *f2 = (float)(a1*(ym[i] - yp[i]));
-    }
-}
-
-template<typename T> static void
-HorizontalIIRFilter(Mat &img, Mat &dst, const Range &range, double a, double w)
-{
-    int tailleSequence = (img.rows>img.cols) ? img.rows : img.cols;
-    Mat matYp(1, tailleSequence, CV_64FC1), matYm(1, tailleSequence, CV_64FC1);
-    double *yp = matYp.ptr<double>(0), *ym = matYm.ptr<double>(0);
-    int cols = img.cols;
-    float *f2;
-
-    // Equation 12 p193
-    double                b1 = -2 * exp(-a)*cosh(w);
-    double                a1 = 2 * exp(-a)*cosh(w) - exp(-2 * a) - 1;
-    double                b2 = exp(-2 * a);
-
-    for (int i = range.start; i<range.end; i++)
-    {
-        // Equation 26 p194
-        T *c1 = img.ptr<T>(i);
-        double border = *c1;
-        yp[0] = *c1;
-        c1++;
-        yp[1] = *c1 - b1*yp[0] - b2*border;
-        c1++;
-        for (int j = 2; j<cols; j++, c1++)
-            yp[j] = *c1 - b1*yp[j - 1] - b2*yp[j - 2];
-        // Equation 27 p194
-        c1 = img.ptr<T>(i) + cols - 1;
-        border = *c1;
-        ym[cols - 1] = *c1;
-        c1--;
-        ym[cols - 2] = *c1 - b1*ym[cols - 1];
-        c1--;
-        for (int j = cols - 3; j >= 0; j--, c1--)
-            ym[j] = *c1 - b1*ym[j + 1] - b2*ym[j + 2];
-        // Equation 25 p193
-        f2 = dst.ptr<float>(i);
-        for (int j = 0; j<cols; j++, f2++)
-            *f2 = (float)(a1*(ym[j] - yp[j]));
-    }
-}
-
-class ParallelGradientPaillouYCols: public ParallelLoopBody
-{
-private:
-    Mat &img;
-    Mat &dst;
-    double a;
-    double w;
-    bool verbose;
-public:
-    ParallelGradientPaillouYCols(Mat& imgSrc, Mat &d,double aa,double ww):
-        img(imgSrc),
-        dst(d),
-        a(aa),
-        w(ww),
-        verbose(false)
+    PaillouCoeffs(double a, double w)
     {
-        int type = img.depth();
-        CV_CheckType(type, type == CV_8UC1 || type == CV_8SC1 || type == CV_16SC1 || type == CV_16UC1 || type == CV_32FC1, "Wrong input type for GradientPaillouY");
-        type = dst.depth();
-        CV_CheckType(type, type == CV_32FC1, "Wrong output type for GradientPaillouYCols");
-    }
-    void Verbose(bool b){verbose=b;}
-    virtual void operator()(const Range& range) const CV_OVERRIDE
-    {
-        if (verbose)
-            std::cout << getThreadNum()<<"# :Start from row " << range.start << " to "  << range.end-1<<" ("<<range.end-range.start<<" loops)" << std::endl;
-
-        switch(img.depth()){
-        case CV_8U:
-            VerticalIIRFilter<uchar>(img, dst, range, a, w);
-            break;
-        case CV_8S:
-            VerticalIIRFilter<char>(img, dst, range, a, w);
-            break;
-        case CV_16S :
-            VerticalIIRFilter<short>(img, dst, range, a, w);
-            break;
-        case CV_16U:
-            VerticalIIRFilter<short>(img, dst, range, a, w);
-            break;
-        case CV_32F:
-            VerticalIIRFilter<float>(img, dst, range, a, w);
-            break;
-        default :
-            return ;
-            }
-    };
-    ParallelGradientPaillouYCols& operator=(const ParallelGradientPaillouYCols &) {
-         return *this;
-    };
-};
-
-
-class ParallelGradientPaillouYRows: public ParallelLoopBody
-{
-private:
-    Mat &img;
-    Mat &dst;
-    double a;
-    double w;
-    bool verbose;
-
-public:
-    ParallelGradientPaillouYRows(Mat& imgSrc, Mat &d,double aa,double ww):
-        img(imgSrc),
-        dst(d),
-        a(aa),
-        w(ww),
-        verbose(false)
-    {
-        int type = img.depth();
-        CV_CheckType(type, type == CV_32FC1, "Wrong input type for GradientPaillouYRows");
-        type = dst.depth();
-        CV_CheckType(type, type == CV_32FC1, "Wrong output type for GradientPaillouYRows");
-    }
-    void Verbose(bool b){verbose=b;}
-    virtual void operator()(const Range& range) const CV_OVERRIDE
-    {
-        if (verbose)
-            std::cout << getThreadNum()<<"# :Start from row " << range.start << " to "  << range.end-1<<" ("<<range.end-range.start<<" loops)" << std::endl;
-        float *iy,*iy0;
-        int tailleSequence=(img.rows>img.cols)?img.rows:img.cols;
-        Mat matIym(1,tailleSequence,CV_64FC1),  matIyp(1,tailleSequence,CV_64FC1);
-        double *iym=matIym.ptr<double>(0), *iyp=matIyp.ptr<double>(0);
-        int cols=img.cols;
-
-        // Equation 13 p193
-        double                d=(1-2*exp(-a)*cosh(w)+exp(-2*a))/(2*a*exp(-a)*sinh(w)+w*(1-exp(-2*a)));
-        double                c1=a*d;
-        double                c2=w*d;
         // Equation 12 p193
-        double                b1=-2*exp(-a)*cosh(w);
-        double                b2=exp(-2*a);
+        b1 = (float)(-2 * exp(-a)*cosh(w));
+        b2 = (float)exp(-2 * a);
+        a1 = (float)(2 * exp(-a)*cosh(w) - exp(-2 * a) - 1);
+        // Equation 13 p193
+        double d = (1 - 2 * exp(-a)*cosh(w) + exp(-2 * a)) / (2 * a*exp(-a)*sinh(w) + w*(1 - exp(-2 * a)));
+        double c1 = a*d;
+        double c2 = w*d;
         // Equation 14 p193
-        double                a0p=c2;
-        double                a1p=(c1*sinh(w)-c2*cosh(w))*exp(-a);
-        double                a1m=a1p-c2*b1;
-        double                a2m=-c2*b2;
-
-        for (int i=range.start;i<range.end;i++)
-            {
-            iy0 = img.ptr<float>(i);
-            int j=0;
-            iyp[0] = a0p*iy0[0] ;
-            iyp[1] = a0p*iy0[1] + a1p*iy0[0] - b1*iyp[0];
-            iy0 += 2;
-            for (j=2;j<cols;j++,iy0++)
-                iyp[j] = a0p*iy0[0] + a1p*iy0[-1] - b1*iyp[j-1] - b2*iyp[j-2];
-            iy0 = img.ptr<float>(i)+cols-1;
-            iym[cols-1] = 0;
-            iy0--;
-            iym[cols-2] = a1m*iy0[1]  - b1*iym[cols-1];
-            iy0--;
-            for (j=cols-3;j>=0;j--,iy0--)
-                iym[j] = a1m*iy0[1] + a2m*iy0[2] - b1*iym[j+1] - b2*iym[j+2];
-            iy = dst.ptr<float>(i);
-            for (j=0;j<cols;j++,iy++)
-                *iy = (float)(iym[j]+iyp[j]);
-            }
-
-    };
-    ParallelGradientPaillouYRows& operator=(const ParallelGradientPaillouYRows &) {
-         return *this;
-    };
+        double a1pd = (c1*sinh(w) - c2*cosh(w))*exp(-a);
+        a0p = (float)c2;
+        a1p = (float)a1pd;
+        a1m = (float)(a1pd + 2 * c2*exp(-a)*cosh(w));
+        a2m = (float)(-c2*exp(-2 * a));
+    }
+    float b1, b2, a1;
+    float a0p, a1p, a1m, a2m;
 };
 
-
-class ParallelGradientPaillouXCols: public ParallelLoopBody
+/* Derivative line, equations 25-27 p193-194. The causal pass is kept in dst and
+ * combined in place by the anticausal one. */
+struct PaillouDerivLine
 {
-private:
-    Mat &img;
-    Mat &dst;
-    double a;
-    double w;
-    bool verbose;
-
-public:
-    ParallelGradientPaillouXCols(Mat& imgSrc, Mat &d,double aa,double ww):
-        img(imgSrc),
-        dst(d),
-        a(aa),
-        w(ww),
-        verbose(false)
-    {
-        int type = img.depth();
-        CV_CheckType(type, type == CV_32FC1, "Wrong input type for GradientPaillouXCols");
-        type = dst.depth();
-        CV_CheckType(type, type == CV_32FC1, "Wrong output type for GradientPaillouXCols");
-    }
-    void Verbose(bool b){verbose=b;}
-    virtual void operator()(const Range& range) const CV_OVERRIDE
+    PaillouDerivLine(const PaillouCoeffs& k_) : k(k_) {}
+    template<typename T, typename VT> void
+    apply(const T* src, size_t sstep, float* dst, size_t dstep, int n) const
     {
-        if (verbose)
-            std::cout << getThreadNum() << "# :Start from row " << range.start << " to " << range.end - 1 << " (" << range.end - range.start << " loops)" << std::endl;
-        float *iy, *iy0;
-        int tailleSequence = (img.rows>img.cols) ? img.rows : img.cols;
-        Mat matIym(1,tailleSequence,CV_64FC1),  matIyp(1,tailleSequence,CV_64FC1);
-        double *iym=matIym.ptr<double>(0), *iyp=matIyp.ptr<double>(0);
-        int rows = img.rows,cols=img.cols;
+        typedef IIRVec<VT> V;
+        const VT a1 = V::all(k.a1), b1 = V::all(k.b1), b2 = V::all(k.b2);
 
-        // Equation 13 p193
-        double                d = (1 - 2 * exp(-a)*cosh(w) + exp(-2 * a)) / (2 * a*exp(-a)*sinh(w) + w*(1 - exp(-2 * a)));
-        double                c1 = a*d;
-        double                c2 = w*d;
-        // Equation 12 p193
-        double                b1 = -2 * exp(-a)*cosh(w);
-        double                b2 = exp(-2 * a);
-        // Equation 14 p193
-        double                a0p = c2;
-        double                a1p = (c1*sinh(w) - c2*cosh(w))*exp(-a);
-        double                a1m = a1p - c2*b1;
-        double                a2m = -c2*b2;
-
-        for (int j = range.start; j<range.end; j++)
+        // Equation 26 p194
+        VT border = V::load(src);
+        VT yp2 = border;
+        V::store(dst, yp2);
+        VT yp1 = V::load(src + sstep) - b1 * yp2 - b2 * border;
+        V::store(dst + dstep, yp1);
+        for (int i = 2; i < n; i++)
         {
-            iy0 = img.ptr<float>(0)+j;
-            iyp[0] = a0p*iy0[0];
-            iy0 +=cols;
-            iyp[1] = a0p*iy0[0] + a1p*iy0[-cols] - b1*iyp[0];
-            iy0 +=cols;
-            for (int i = 2; i<rows; i++, iy0+=cols)
-                iyp[i] = a0p*iy0[0] + a1p*iy0[-cols] - b1*iyp[i - 1] - b2*iyp[i - 2];
-            iy0 = img.ptr<float>(rows-1) + j;
-            iym[rows - 1] = 0;
-            iy0 -=cols;
-            iym[rows - 2] = a1m*iy0[cols] - b1*iym[rows-1];
-            iy0-=cols;
-            for (int i = rows - 3; i >= 0; i--, iy0-=cols)
-                iym[i] = a1m*iy0[cols] + a2m*iy0[2*cols] - b1*iym[i + 1] - b2*iym[i + 2];
-            iy = dst.ptr<float>(0)+j;
-            for (int i = 0; i<rows; i++, iy+=cols)
-                *iy = (float)(iym[i] + iyp[i]);
+            VT y = V::load(src + i * sstep) - b1 * yp1 - b2 * yp2;
+            V::store(dst + i * dstep, y);
+            yp2 = yp1;
+            yp1 = y;
         }
-
-    };
-    ParallelGradientPaillouXCols& operator=(const ParallelGradientPaillouXCols &) {
-         return *this;
-    };
+        // Equation 27 p194 and equation 25 p193
+        VT ym1 = V::all(0.f), ym2 = ym1;
+        for (int i = n - 1; i >= 0; i--)
+        {
+            float* d = dst + i * dstep;
+            VT y = V::load(src + i * sstep) - b1 * ym1 - b2 * ym2;
+            V::store(d, a1 * (y - V::load(d)));
+            ym2 = ym1;
+            ym1 = y;
+        }
+    }
+    PaillouCoeffs k;
 };
 
-
-class ParallelGradientPaillouXRows: public ParallelLoopBody
+/* Smoothing line */
+struct PaillouSmoothLine
 {
-private:
-    Mat &img;
-    Mat &im1;
-    double a;
-    double w;
-    bool verbose;
-
-public:
-    ParallelGradientPaillouXRows(Mat& imgSrc, Mat &d,double aa,double ww):
-        img(imgSrc),
-        im1(d),
-        a(aa),
-        w(ww),
-        verbose(false)
+    PaillouSmoothLine(const PaillouCoeffs& k_) : k(k_) {}
+    template<typename T, typename VT> void
+    apply(const T* src, size_t sstep, float* dst, size_t dstep, int n) const
     {
-        int type = img.depth();
-        CV_CheckType(type, type == CV_8UC1 || type == CV_8SC1 || type == CV_16SC1 || type == CV_16UC1 || type == CV_32FC1, "Wrong input type for GradientPaillouXRows");
-        type = im1.depth();
-        CV_CheckType(type, type == CV_32FC1, "Wrong output type for GradientPaillouXRows");
-    }
-    void Verbose(bool b){verbose=b;}
-    virtual void operator()(const Range& range) const CV_OVERRIDE
-    {
-        if (verbose)
-            std::cout << getThreadNum()<<"# :Start from row " << range.start << " to "  << range.end-1<<" ("<<range.end-range.start<<" loops)" << std::endl;
+        typedef IIRVec<VT> V;
+        const VT a0p = V::all(k.a0p), a1p = V::all(k.a1p), a1m = V::all(k.a1m), a2m = V::all(k.a2m);
+        const VT b1 = V::all(k.b1), b2 = V::all(k.b2);
 
-        // Equation 12 p193
-        switch(img.depth()){
-        case CV_8U :
-            HorizontalIIRFilter<uchar>(img,im1,range,a,w);
-            break;
-        case CV_8S :
-            HorizontalIIRFilter<char>(img, im1, range, a, w);
-            break;
-        case CV_16S :
-            HorizontalIIRFilter<short>(img, im1, range, a, w);
-            break;
-        case CV_16U:
-            HorizontalIIRFilter<ushort>(img, im1, range, a, w);
-            break;
-        case CV_32F:
-            HorizontalIIRFilter<float>(img, im1, range, a, w);
-            break;
-        default :
-            return ;
-            }
-    };
-    ParallelGradientPaillouXRows& operator=(const ParallelGradientPaillouXRows &) {
-         return *this;
-    };
+        VT xm1 = V::all(0.f), yp1 = xm1, yp2 = xm1;
+        for (int i = 0; i < n; i++)
+        {
+            VT x = V::load(src + i * sstep);
+            VT y = a0p * x + a1p * xm1 - b1 * yp1 - b2 * yp2;
+            V::store(dst + i * dstep, y);
+            yp2 = yp1;
+            yp1 = y;
+            xm1 = x;
+        }
+        VT xp1 = V::all(0.f), xp2 = xp1, ym1 = xp1, ym2 = xp1;
+        for (int i = n - 1; i >= 0; i--)
+        {
+            float* d = dst + i * dstep;
+            VT y = a1m * xp1 + a2m * xp2 - b1 * ym1 - b2 * ym2;
+            V::store(d, V::load(d) + y);
+            ym2 = ym1;
+            ym1 = y;
+            xp2 = xp1;
+            xp1 = V::load(src + i * sstep);
+        }
+    }
+    PaillouCoeffs k;
 };
 
 void GradientPaillouY(InputArray _op, OutputArray _dst, double alpha, double omega)
 {
+    CV_Assert(_op.rows() >= 2 && _op.cols() >= 2);
     std::vector<Mat> planSrc;
     split(_op,planSrc);
-    std::vector<Mat> planTmp;
-    std::vector<Mat> planDst;
-    for (int i = 0; i <static_cast<int>(planSrc.size()); i++)
+
+    PaillouCoeffs k(alpha, omega);
+    Mat planTmp(_op.size(), CV_32FC1);
+    std::vector<Mat> planDst(planSrc.size());
+    for (size_t i = 0; i < planSrc.size(); i++)
     {
-		planTmp.push_back(Mat(_op.size(), CV_32FC1));
-		planDst.push_back(Mat(_op.size(), CV_32FC1));
-        CV_Assert(planSrc[i].isContinuous() && planTmp[i].isContinuous() && planDst[i].isContinuous());
-        ParallelGradientPaillouYCols x(planSrc[i],planTmp[i],alpha,omega);
-        parallel_for_(Range(0, planSrc[i].cols), x,getNumThreads());
-        ParallelGradientPaillouYRows xr(planTmp[i],planDst[i],alpha,omega);
-        parallel_for_(Range(0, planTmp[i].rows), xr,getNumThreads());
+        planDst[i].create(_op.size(), CV_32FC1);
+        runIIRFilter(planSrc[i], planTmp, PaillouDerivLine(k), true);
+        runIIRFilter(planTmp, planDst[i], PaillouSmoothLine(k), false);
     }
     merge(planDst,_dst);
 }
 
 void GradientPaillouX(InputArray _op, OutputArray _dst, double alpha, double omega)
 {
+    CV_Assert(_op.rows() >= 2 && _op.cols() >= 2);
     std::vector<Mat> planSrc;
     split(_op,planSrc);
-    std::vector<Mat> planTmp;
-    std::vector<Mat> planDst;
-    for (int i = 0; i <static_cast<int>(planSrc.size()); i++)
+
+    PaillouCoeffs k(alpha, omega);
+    Mat planTmp(_op.size(), CV_32FC1);
+    std::vector<Mat> planDst(planSrc.size());
+    for (size_t i = 0; i < planSrc.size(); i++)
     {
-		planTmp.push_back(Mat(_op.size(), CV_32FC1));
-		planDst.push_back(Mat(_op.size(), CV_32FC1));
-        CV_Assert(planSrc[i].isContinuous() && planTmp[i].isContinuous() && planDst[i].isContinuous());
-        ParallelGradientPaillouXRows x(planSrc[i],planTmp[i],alpha,omega);
-        parallel_for_(Range(0, planSrc[i].rows), x,getNumThreads());
-        ParallelGradientPaillouXCols xr(planTmp[i],planDst[i],alpha,omega);
-        parallel_for_(Range(0, planTmp[i].cols), xr,getNumThreads());
+        planDst[i].create(_op.size(), CV_32FC1);
+        runIIRFilter(planSrc[i], planTmp, PaillouDerivLine(k), false);
+        runIIRFilter(planTmp, planDst[i], PaillouSmoothLine(k), true);
     }
     merge(planDst,_dst);
 }
@@ -44,6 +44,8 @@ namespace ximgproc
     void rollingGuidanceFilter(InputArray src_, OutputArray dst_, int d,
                                double sigmaColor, double sigmaSpace,  int numOfIter, int borderType)
     {
+        CV_INSTRUMENT_REGION();
+
         CV_Assert(!src_.empty());
 
         Mat guidance = src_.getMat();
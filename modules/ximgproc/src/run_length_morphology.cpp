@@ -54,6 +54,26 @@ struct rlType
 
 typedef std::vector<rlType> rlVec;
 
+// number of rows a band of the row parallel operations should have at least
+static const int minRowsPerBand = 32;
+
+static int getNumRowBands(int nRows)
+{
+    return std::max(1, std::min(getNumThreads() * 4, nRows / minRowsPerBand));
+}
+
+// concatenate the band results in band order
+static void concatenateBands(std::vector<rlVec>& bands, rlVec& res)
+{
+    size_t nTotal = 0;
+    for (size_t i = 0; i < bands.size(); ++i)
+        nTotal += bands[i].size();
+    res.clear();
+    res.reserve(nTotal);
+    for (size_t i = 0; i < bands.size(); ++i)
+        res.insert(res.end(), bands[i].begin(), bands[i].end());
+}
+
 template <class T>
 void _thresholdLine(T* pData, int nWidth, int nRow, T threshold, int type, rlVec& res)
 {
@@ -83,40 +103,39 @@ void _thresholdLine(T* pData, int nWidth, int nRow, T threshold, int type, rlVec
   }
 }
 
-static void _threshold(cv::Mat& img, rlVec& res, double threshold, int type)
+static void _thresholdRows(cv::Mat& img, int nRowStart, int nRowEnd, rlVec& res, double threshold, int type)
 {
-  res.clear();
   switch (img.depth())
   {
   case CV_8U:
-    for (int i = 0; i < img.rows; ++i)
+    for (int i = nRowStart; i < nRowEnd; ++i)
       _thresholdLine<uchar>(img.ptr(i), img.cols, i, (uchar) threshold, type, res);
     break;
   case CV_8S:
-    for (int i = 0; i < img.rows; ++i)
+    for (int i = nRowStart; i < nRowEnd; ++i)
       _thresholdLine<schar>((schar*) img.ptr(i), img.cols, i, (schar) threshold, type, res);
     break;
   case CV_16U:
-      for (int i = 0; i < img.rows; ++i)
+      for (int i = nRowStart; i < nRowEnd; ++i)
       {
           _thresholdLine<unsigned short>((unsigned short*)img.ptr(i), img.cols, i,
               (unsigned short)threshold, type, res);
       }
     break;
   case CV_16S:
-    for (int i = 0; i < img.rows; ++i)
+    for (int i = nRowStart; i < nRowEnd; ++i)
       _thresholdLine<short>((short*) img.ptr(i), img.cols, i, (short) threshold, type, res);
     break;
   case CV_32S:
-    for (int i = 0; i < img.rows; ++i)
+    for (int i = nRowStart; i < nRowEnd; ++i)
       _thresholdLine<int>((int*) img.ptr(i), img.cols, i, (int) threshold, type, res);
     break;
   case CV_32F:
-    for (int i = 0; i < img.rows; ++i)
+    for (int i = nRowStart; i < nRowEnd; ++i)
       _thresholdLine<float>((float*) img.ptr(i), img.cols, i, (float) threshold, type, res);
     break;
   case CV_64F:
-    for (int i = 0; i < img.rows; ++i)
+    for (int i = nRowStart; i < nRowEnd; ++i)
       _thresholdLine<double>((double*) img.ptr(i), img.cols, i, threshold, type, res);
     break;
   default:
@@ -124,6 +143,25 @@ static void _threshold(cv::Mat& img, rlVec& res, double threshold, int type)
   }
 }
 
+static void _threshold(cv::Mat& img, rlVec& res, double threshold, int type)
+{
+  res.clear();
+  int nBands = getNumRowBands(img.rows);
+  if (nBands == 1)
+  {
+    _thresholdRows(img, 0, img.rows, res, threshold, type);
+    return;
+  }
+
+  std::vector<rlVec> bands(nBands);
+  parallel_for_(Range(0, nBands), [&](const Range& range)
+  {
+    for (int b = range.start; b < range.end; ++b)
+      _thresholdRows(img, img.rows * b / nBands, img.rows * (b + 1) / nBands, bands[b], threshold, type);
+  });
+  concatenateBands(bands, res);
+}
+
 
 static void convertToOutputArray(rlVec& runs, Size size, OutputArray& res)
 {
@@ -237,56 +275,20 @@ CV_EXPORTS Mat getStructuringElement(int shape, Size ksize)
   return rlDest;
 }
 
-static void erode_rle (rlVec& regIn, rlVec& regOut, rlVec& se)
+// erosion result for the rows [nRowStart, nRowEnd); the row tables are shared by all bands
+static void erode_rle_rows(const rlVec& regIn, const std::vector<int>& pIdxChord1, const std::vector<int>& pIdxNextRow,
+    int nMinRow, const rlVec& se, int nRowStart, int nRowEnd, rlVec& regOut)
 {
   using namespace std;
 
-    regOut.clear();
-
-    if (regIn.size() == 0)
-        return;
-
-    int nMinRow = regIn[0].r;
-    int nMaxRow = regIn.back().r;
-
-    int nRows = nMaxRow - nMinRow + 1;
-
-
-    const int EMPTY = -1;
-
-    // setup a table which holds the index of the first chord for each row
-    vector<int> pIdxChord1(nRows);
-    vector<int> pIdxNextRow(nRows);
-
-    int i,j;
-
-    for (i=1;i<nRows;i++)
-    {
-        pIdxChord1[i] = EMPTY;
-        pIdxNextRow[i] = EMPTY;
-    }
-
-    pIdxChord1[0] = 0;
-    pIdxNextRow[nRows-1] = (int) regIn.size();
-
-    for (i=1; i < (int) regIn.size();i++)
-        if (regIn[i].r != regIn[i-1].r)
-        {
-            pIdxChord1[regIn[i].r - nMinRow] = i;
-            pIdxNextRow[regIn[i-1].r - nMinRow] = i;
-        }
-
     int nMinRowSE = se[0].r;
-    int nMaxRowSE = se.back().r;
-
-    int nRowsSE = nMaxRowSE - nMinRowSE + 1;
-
-    assert(nRowsSE == (int) se.size());
+    int nRowsSE = (int) se.size();
+    int i,j;
 
     vector<int> pCurIdxRow(nRowsSE);
 
     // loop through all possible rows
-    for (i=nMinRow - nMinRowSE; i<= nMaxRow - nMaxRowSE; i++)
+    for (i=nRowStart; i < nRowEnd; i++)
     {
         // check whether all relevant rows are available
         bool bNextRow = false;
@@ -361,7 +363,79 @@ static void erode_rle (rlVec& regIn, rlVec& regOut, rlVec& se)
         }
         } // end while (!bNextRow
     } // end for
+}
+
+static void erode_rle (rlVec& regIn, rlVec& regOut, rlVec& se)
+{
+  using namespace std;
+
+    regOut.clear();
+
+    if (regIn.size() == 0)
+        return;
 
+    int nMinRow = regIn[0].r;
+    int nMaxRow = regIn.back().r;
+
+    int nRows = nMaxRow - nMinRow + 1;
+
+
+    const int EMPTY = -1;
+
+    // setup a table which holds the index of the first chord for each row
+    vector<int> pIdxChord1(nRows);
+    vector<int> pIdxNextRow(nRows);
+
+    int i;
+
+    for (i=1;i<nRows;i++)
+    {
+        pIdxChord1[i] = EMPTY;
+        pIdxNextRow[i] = EMPTY;
+    }
+
+    pIdxChord1[0] = 0;
+    pIdxNextRow[nRows-1] = (int) regIn.size();
+
+    for (i=1; i < (int) regIn.size();i++)
+        if (regIn[i].r != regIn[i-1].r)
+        {
+            pIdxChord1[regIn[i].r - nMinRow] = i;
+            pIdxNextRow[regIn[i-1].r - nMinRow] = i;
+        }
+
+    int nMinRowSE = se[0].r;
+    int nMaxRowSE = se.back().r;
+
+    int nRowsSE = nMaxRowSE - nMinRowSE + 1;
+
+    assert(nRowsSE == (int) se.size());
+    CV_UNUSED(nRowsSE);
+
+    // the result rows are independent of each other -> process bands of rows in parallel
+    int nRowStart = nMinRow - nMinRowSE;
+    int nRowEnd = nMaxRow - nMaxRowSE + 1;
+    if (nRowEnd <= nRowStart)
+        return;
+
+    int nBands = getNumRowBands(nRowEnd - nRowStart);
+    if (nBands == 1)
+    {
+        erode_rle_rows(regIn, pIdxChord1, pIdxNextRow, nMinRow, se, nRowStart, nRowEnd, regOut);
+        return;
+    }
+
+    vector<rlVec> bands(nBands);
+    parallel_for_(Range(0, nBands), [&](const Range& range)
+    {
+        for (int b = range.start; b < range.end; ++b)
+        {
+            int nBandStart = nRowStart + (int) ((int64) (nRowEnd - nRowStart) * b / nBands);
+            int nBandEnd = nRowStart + (int) ((int64) (nRowEnd - nRowStart) * (b + 1) / nBands);
+            erode_rle_rows(regIn, pIdxChord1, pIdxNextRow, nMinRow, se, nBandStart, nBandEnd, bands[b]);
+        }
+    });
+    concatenateBands(bands, regOut);
 }
 
 static void convertInputArrayToRuns(InputArray& theArray, rlVec& runs, Size& theSize)
@@ -807,6 +881,182 @@ CV_EXPORTS void morphologyEx(InputArray rlSrc, OutputArray rlDest, int op, Input
     }
 }
 
+static void union_sorted(rlVec& reg1, rlVec& reg2, rlVec& regUnion)
+{
+    // both inputs are sorted -> a linear merge instead of sorting the concatenation
+    rlVec lAllChords(reg1.size() + reg2.size());
+    std::merge(reg1.begin(), reg1.end(), reg2.begin(), reg2.end(), lAllChords.begin());
+    mergeNeighbouringChords(lAllChords, regUnion);
+}
+
+enum { RL_AND, RL_OR, RL_XOR, RL_SUBTRACT };
+
+static void logicalOperation(InputArray rlSrc1, InputArray rlSrc2, OutputArray rlDest, int op)
+{
+    rlVec runs1, runs2, runsDestination;
+    Size size1, size2;
+    convertInputArrayToRuns(rlSrc1, runs1, size1);
+    convertInputArrayToRuns(rlSrc2, runs2, size2);
+
+    switch (op)
+    {
+    case RL_AND:
+        intersect(runs1, runs2, runsDestination);
+        break;
+    case RL_OR:
+        union_sorted(runs1, runs2, runsDestination);
+        break;
+    case RL_XOR:
+    {
+        rlVec runs1Only, runs2Only;
+        subtract_rle(runs1, runs2, runs1Only);
+        subtract_rle(runs2, runs1, runs2Only);
+        union_sorted(runs1Only, runs2Only, runsDestination);
+    }
+    break;
+    case RL_SUBTRACT:
+        subtract_rle(runs1, runs2, runsDestination);
+        break;
+    default:
+        CV_Error(CV_StsBadArg, "unknown logical operation");
+    }
+    convertToOutputArray(runsDestination, Size(std::max(size1.width, size2.width),
+        std::max(size1.height, size2.height)), rlDest);
+}
+
+CV_EXPORTS void bitwise_and(InputArray rlSrc1, InputArray rlSrc2, OutputArray rlDest)
+{
+    CV_INSTRUMENT_REGION();
+    logicalOperation(rlSrc1, rlSrc2, rlDest, RL_AND);
+}
+
+CV_EXPORTS void bitwise_or(InputArray rlSrc1, InputArray rlSrc2, OutputArray rlDest)
+{
+    CV_INSTRUMENT_REGION();
+    logicalOperation(rlSrc1, rlSrc2, rlDest, RL_OR);
+}
+
+CV_EXPORTS void bitwise_xor(InputArray rlSrc1, InputArray rlSrc2, OutputArray rlDest)
+{
+    CV_INSTRUMENT_REGION();
+    logicalOperation(rlSrc1, rlSrc2, rlDest, RL_XOR);
+}
+
+CV_EXPORTS void subtract(InputArray rlSrc1, InputArray rlSrc2, OutputArray rlDest)
+{
+    CV_INSTRUMENT_REGION();
+    logicalOperation(rlSrc1, rlSrc2, rlDest, RL_SUBTRACT);
+}
+
+CV_EXPORTS int countNonZero(InputArray rlSrc)
+{
+    rlVec runs;
+    Size size;
+    convertInputArrayToRuns(rlSrc, runs, size);
+
+    int nArea = 0;
+    for (rlVec::iterator it = runs.begin(); it != runs.end(); ++it)
+        nArea += it->ce - it->cb + 1;
+    return nArea;
+}
+
+CV_EXPORTS Rect boundingRect(InputArray rlSrc)
+{
+    rlVec runs;
+    Size size;
+    convertInputArrayToRuns(rlSrc, runs, size);
+    return getBoundingRectangle(runs);
+}
+
+static int findRoot(std::vector<int>& parent, int i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// the root is always the run with the smallest index, i.e. the first run of the component in raster order
+static void uniteRuns(std::vector<int>& parent, int i, int j)
+{
+    int ri = findRoot(parent, i);
+    int rj = findRoot(parent, j);
+    if (ri < rj)
+        parent[rj] = ri;
+    else if (rj < ri)
+        parent[ri] = rj;
+}
+
+CV_EXPORTS int connectedComponents(InputArray rlSrc, OutputArrayOfArrays rlComponents, int connectivity)
+{
+    CV_INSTRUMENT_REGION();
+
+    CV_Assert(connectivity == 4 || connectivity == 8);
+    rlVec runs;
+    Size size;
+    convertInputArrayToRuns(rlSrc, runs, size);
+
+    int nRuns = (int) runs.size();
+    std::vector<int> parent(nRuns);
+    for (int i = 0; i < nRuns; ++i)
+        parent[i] = i;
+
+    // with 8-connectivity diagonally touching runs are connected as well
+    int nGap = (connectivity == 8) ? 1 : 0;
+    int nPrevStart = 0, nPrevEnd = 0;
+    for (int i = 0; i < nRuns; )
+    {
+        int nCurStart = i;
+        int nCurRow = runs[i].r;
+        while (i < nRuns && runs[i].r == nCurRow)
+            ++i;
+        int nCurEnd = i;
+
+        if (nPrevEnd > nPrevStart && runs[nPrevStart].r == nCurRow - 1)
+        {
+            int p = nPrevStart;
+            for (int c = nCurStart; c < nCurEnd; ++c)
+            {
+                // skip the runs of the previous row which end left of the current run
+                while (p < nPrevEnd && runs[p].ce + nGap < runs[c].cb)
+                    ++p;
+                for (int q = p; q < nPrevEnd && runs[q].cb <= runs[c].ce + nGap; ++q)
+                    uniteRuns(parent, c, q);
+            }
+        }
+        nPrevStart = nCurStart;
+        nPrevEnd = nCurEnd;
+    }
+
+    // components are numbered in the raster order of their first run
+    std::vector<int> runLabels(nRuns);
+    int nLabels = 0;
+    for (int i = 0; i < nRuns; ++i)
+    {
+        int root = findRoot(parent, i);
+        runLabels[i] = (root == i) ? nLabels++ : runLabels[root];
+    }
+
+    if (rlComponents.needed())
+    {
+        std::vector<rlVec> components(nLabels);
+        for (int i = 0; i < nRuns; ++i)
+            components[runLabels[i]].push_back(runs[i]);
+
+        rlComponents.create(nLabels, 1, CV_32SC3);
+        for (int k = 0; k < nLabels; ++k)
+        {
+            Mat component;
+            convertToOutputArray(components[k], size, component);
+            rlComponents.create(component.rows, 1, CV_32SC3, k);
+            component.copyTo(rlComponents.getMat(k));
+        }
+    }
+    return nLabels;
+}
+
 }
 } //end of cv::ximgproc
 } //end of cv
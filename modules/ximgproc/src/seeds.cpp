@@ -61,6 +61,10 @@ using namespace std;
 
 #define MINIMUM_NR_SUBLABELS 1
 
+// side of the tiles which are updated in parallel, in pixels and in blocks
+#define PIXEL_TILE_SIZE 64
+#define BLOCK_TILE_SIZE 16
+
 
 // the type of the histogram and the T array
 typedef float HISTN;
@@ -69,6 +73,104 @@ typedef float HISTN;
 namespace cv {
 namespace ximgproc {
 
+/* Top level state (histograms, T and nr_partitions) of the labels touched while one tile
+ * is updated. The tiles of one color of a 2x2 checkerboard never touch each other's labels
+ * on the grid and are updated in parallel: each one works on private copies of the rows
+ * of the labels it touches, while the shared arrays stay read only. Once all tiles of
+ * the color are done the differences are added back. Counts are whole numbers, so the
+ * result neither depends on the number of threads nor on the order of the merge.
+ * A row holds the histogram_size_aligned bins followed by T and nr_partitions, so rows
+ * stay aligned and tiles never write to a shared cache line. */
+struct SeedsTileState
+{
+    SeedsTileState() : nr_slots(0), hist_size(0), hist_step(0),
+        hist(NULL), T(NULL), partitions(NULL) {}
+
+    void reset(HISTN* _hist, HISTN* _T, unsigned int* _partitions, int _hist_size, int _hist_step)
+    {
+        hist = _hist;
+        T = _T;
+        partitions = _partitions;
+        hist_size = _hist_size;
+        hist_step = _hist_step;
+        if( rows.cols != rowSize() )
+            rows.release();
+        nr_slots = 0;
+        slot_labels.clear();
+    }
+
+    // row of label, copied from the shared state on first use.
+    // adding a label may reallocate the rows, get all slots before taking pointers
+    inline int slot(int label)
+    {
+        for (int i = 0; i < nr_slots; i++)
+            if( slot_labels[i] == label )
+                return i;
+        return addSlot(label);
+    }
+
+    inline HISTN* row(int s) { return rows.ptr<HISTN>(s); }
+    inline HISTN& count(int s) { return row(s)[hist_step]; }
+    inline HISTN& partitionsAt(int s) { return row(s)[hist_step + 1]; }
+    inline unsigned int nrPartitions(int label) { return (unsigned int)partitionsAt(slot(label)); }
+
+    // turns the rows into differences to the shared state, the shared state must not have changed
+    void finish()
+    {
+        for (int s = 0; s < nr_slots; s++)
+        {
+            HISTN* r = row(s);
+            const HISTN* h = hist + (size_t)slot_labels[s] * hist_step;
+            for (int n = 0; n < hist_size; n++)
+                r[n] -= h[n];
+            r[hist_step] -= T[slot_labels[s]];
+            r[hist_step + 1] -= (HISTN)partitions[slot_labels[s]];
+        }
+    }
+
+    // adds the differences computed by finish() to the shared state
+    void merge()
+    {
+        for (int s = 0; s < nr_slots; s++)
+        {
+            const HISTN* r = row(s);
+            HISTN* h = hist + (size_t)slot_labels[s] * hist_step;
+            for (int n = 0; n < hist_size; n++)
+                h[n] += r[n];
+            T[slot_labels[s]] += r[hist_step];
+            partitions[slot_labels[s]] = (unsigned int)((int)partitions[slot_labels[s]] + (int)r[hist_step + 1]);
+        }
+    }
+
+private:
+    inline int rowSize() const { return hist_step + (int)(CV_MALLOC_ALIGN / sizeof(HISTN)); }
+
+    int addSlot(int label)
+    {
+        if( nr_slots == rows.rows )
+        {
+            Mat grown(std::max(16, 2 * rows.rows), rowSize(), DataType<HISTN>::type);
+            if( nr_slots > 0 )
+                rows.rowRange(0, nr_slots).copyTo(grown.rowRange(0, nr_slots));
+            rows = grown;
+        }
+        HISTN* r = row(nr_slots);
+        memcpy(r, hist + (size_t)label * hist_step, sizeof(HISTN) * hist_size);
+        r[hist_step] = T[label];
+        r[hist_step + 1] = (HISTN)partitions[label];
+        slot_labels.push_back(label);
+        return nr_slots++;
+    }
+
+    Mat rows;
+    vector<int> slot_labels;
+    int nr_slots;
+    int hist_size, hist_step;
+    HISTN* hist;
+    HISTN* T;
+    unsigned int* partitions;
+};
+
 class SuperpixelSEEDSImpl : public SuperpixelSEEDS
 {
 public:
@@ -99,29 +201,48 @@ private:
 
     /* pixel operations */
     inline void update(int label_new, int image_idx, int label_old);
+    inline void update(SeedsTileState& st, int label_new, int image_idx, int label_old);
     //image_idx = y*width+x
     inline void addPixel(int level, int label, int image_idx);
     inline void deletePixel(int level, int label, int image_idx);
-    inline bool probability(int image_idx, int label1, int label2, int prior1, int prior2);
+    inline bool probability(SeedsTileState& st, int image_idx, int label1, int label2,
+            int prior1, int prior2);
     inline int threebyfour(int x, int y, int label);
     inline int fourbythree(int x, int y, int label);
 
     inline void updateLabels();
     // main loop for pixel updating
     void updatePixels();
+    void updatePixelsTile(const Rect& tile, bool horizontal, SeedsTileState& st);
 
 
     /* block operations */
     void addBlock(int level, int label, int sublevel, int sublabel);
-    inline void addBlockToplevel(int label, int sublevel, int sublabel);
-    void deleteBlockToplevel(int label, int sublevel, int sublabel);
+    inline void addBlockToplevel(SeedsTileState& st, int label, int sublevel, int sublabel);
+    void deleteBlockToplevel(SeedsTileState& st, int label, int sublevel, int sublabel);
 
-    // intersection on label1A and intersection_delete on label1B
+    // intersection on top level label1A and intersection_delete on top level label1B
     // returns intA - intB
-    float intersectConf(int level1, int label1A, int label1B, int level2, int label2);
+    float intersectConf(SeedsTileState& st, int label1A, int label1B, int level2, int label2);
 
     //main loop for block updates
     void updateBlocks(int level, float req_confidence = 0.0f);
+    void updateBlocksTile(int level, float req_confidence, const Rect& tile,
+            bool horizontal, SeedsTileState& st);
+
+    /* checkerboard parallel updates */
+    enum TileMode
+    {
+        TILE_BLOCKS_HORIZONTAL,
+        TILE_BLOCKS_VERTICAL,
+        TILE_PIXELS_HORIZONTAL,
+        TILE_PIXELS_VERTICAL
+    };
+    class TileInvoker;
+    // runs one horizontal or vertical pass over the label grid of the pass, tile by tile
+    void updateTiled(TileMode mode, int level = 0, float req_confidence = 0.0f);
+    void updateTile(TileMode mode, int level, float req_confidence, const Rect& tile,
+            SeedsTileState& st);
 
     /* go to next block level */
     int goDownOneLevel();
@@ -172,6 +293,8 @@ private:
     vector<HISTN*> histogram; //[level][label * histogram_size_aligned + j]
     vector<HISTN*> T; //[level][label] how many pixels with this label
 
+    vector<SeedsTileState> tile_states; //[tile] reused by the parallel passes
+
     /* OpenCV containers for our memory arrays. This makes sure memory is
      * allocated & released properly */
     Mat labels_mat;
@@ -472,132 +595,151 @@ void SuperpixelSEEDSImpl::computeHistograms(int until_level)
 }
 
 void SuperpixelSEEDSImpl::updateBlocks(int level, float req_confidence)
+{
+    updateTiled(TILE_BLOCKS_HORIZONTAL, level, req_confidence);
+    updateTiled(TILE_BLOCKS_VERTICAL, level, req_confidence);
+}
+
+void SuperpixelSEEDSImpl::updateBlocksTile(int level, float req_confidence, const Rect& tile,
+        bool horizontal, SeedsTileState& st)
 {
     int labelA;
     int labelB;
     int sublabel;
     bool done;
     int step = nr_wh[2 * level];
+    int rows = nr_wh[2 * level + 1];
 
-    // horizontal bidirectional block updating
-    for (int y = 1; y < nr_wh[2 * level + 1] - 1; y++)
+    if( horizontal )
     {
-        for (int x = 1; x < nr_wh[2 * level] - 2; x++)
+        const int x0 = std::max(tile.x, 1), x1 = std::min(tile.x + tile.width, step - 2);
+        const int y0 = std::max(tile.y, 1), y1 = std::min(tile.y + tile.height, rows - 1);
+
+        // horizontal bidirectional block updating
+        for (int y = y0; y < y1; y++)
         {
-            // choose a label at the current level
-            sublabel = y * step + x;
-            // get the label at the top level (= superpixel label)
-            labelA = parent[level][y * step + x];
-            // get the neighboring label at the top level (= superpixel label)
-            labelB = parent[level][y * step + x + 1];
-
-            if( labelA == labelB )
-                continue;
-
-            // get the surrounding labels at the top level, to check for splitting
-            int a11 = parent[level][(y - 1) * step + (x - 1)];
-            int a12 = parent[level][(y - 1) * step + (x)];
-            int a21 = parent[level][(y) * step + (x - 1)];
-            int a22 = parent[level][(y) * step + (x)];
-            int a31 = parent[level][(y + 1) * step + (x - 1)];
-            int a32 = parent[level][(y + 1) * step + (x)];
-            done = false;
-
-            if( nr_partitions[labelA] == 2 || (nr_partitions[labelA] > 2 // 3 or more partitions
-                    && checkSplit_hf(a11, a12, a21, a22, a31, a32)) )
+            for (int x = x0; x < x1; x++)
             {
-                // run algorithm as usual
-                float conf = intersectConf(seeds_top_level, labelB, labelA, level, sublabel);
-                if( conf > req_confidence )
-                {
-                    deleteBlockToplevel(labelA, level, sublabel);
-                    addBlockToplevel(labelB, level, sublabel);
-                    done = true;
-                }
-            }
+                // choose a label at the current level
+                sublabel = y * step + x;
+                // get the label at the top level (= superpixel label)
+                labelA = parent[level][y * step + x];
+                // get the neighboring label at the top level (= superpixel label)
+                labelB = parent[level][y * step + x + 1];
+
+                if( labelA == labelB )
+                    continue;
+
+                // get the surrounding labels at the top level, to check for splitting
+                int a11 = parent[level][(y - 1) * step + (x - 1)];
+                int a12 = parent[level][(y - 1) * step + (x)];
+                int a21 = parent[level][(y) * step + (x - 1)];
+                int a22 = parent[level][(y) * step + (x)];
+                int a31 = parent[level][(y + 1) * step + (x - 1)];
+                int a32 = parent[level][(y + 1) * step + (x)];
+                done = false;
 
-            if( !done && (nr_partitions[labelB] > MINIMUM_NR_SUBLABELS) )
-            {
-                // try opposite direction
-                sublabel = y * step + x + 1;
-                int a13 = parent[level][(y - 1) * step + (x + 1)];
-                int a14 = parent[level][(y - 1) * step + (x + 2)];
-                int a23 = parent[level][(y) * step + (x + 1)];
-                int a24 = parent[level][(y) * step + (x + 2)];
-                int a33 = parent[level][(y + 1) * step + (x + 1)];
-                int a34 = parent[level][(y + 1) * step + (x + 2)];
-                if( nr_partitions[labelB] <= 2 // == 2
-                        || (nr_partitions[labelB] > 2 && checkSplit_hb(a13, a14, a23, a24, a33, a34)) )
+                if( st.nrPartitions(labelA) == 2 || (st.nrPartitions(labelA) > 2 // 3 or more partitions
+                        && checkSplit_hf(a11, a12, a21, a22, a31, a32)) )
                 {
                     // run algorithm as usual
-                    float conf = intersectConf(seeds_top_level, labelA, labelB, level, sublabel);
+                    float conf = intersectConf(st, labelB, labelA, level, sublabel);
                     if( conf > req_confidence )
                     {
-                        deleteBlockToplevel(labelB, level, sublabel);
-                        addBlockToplevel(labelA, level, sublabel);
-                        x++;
+                        deleteBlockToplevel(st, labelA, level, sublabel);
+                        addBlockToplevel(st, labelB, level, sublabel);
+                        done = true;
+                    }
+                }
+
+                if( !done && (st.nrPartitions(labelB) > MINIMUM_NR_SUBLABELS) )
+                {
+                    // try opposite direction
+                    sublabel = y * step + x + 1;
+                    int a13 = parent[level][(y - 1) * step + (x + 1)];
+                    int a14 = parent[level][(y - 1) * step + (x + 2)];
+                    int a23 = parent[level][(y) * step + (x + 1)];
+                    int a24 = parent[level][(y) * step + (x + 2)];
+                    int a33 = parent[level][(y + 1) * step + (x + 1)];
+                    int a34 = parent[level][(y + 1) * step + (x + 2)];
+                    if( st.nrPartitions(labelB) <= 2 // == 2
+                            || (st.nrPartitions(labelB) > 2 && checkSplit_hb(a13, a14, a23, a24, a33, a34)) )
+                    {
+                        // run algorithm as usual
+                        float conf = intersectConf(st, labelA, labelB, level, sublabel);
+                        if( conf > req_confidence )
+                        {
+                            deleteBlockToplevel(st, labelB, level, sublabel);
+                            addBlockToplevel(st, labelA, level, sublabel);
+                            x++;
+                        }
                     }
                 }
             }
         }
     }
-
-    // vertical bidirectional
-    for (int x = 1; x < nr_wh[2 * level] - 1; x++)
+    else
     {
-        for (int y = 1; y < nr_wh[2 * level + 1] - 2; y++)
+        const int x0 = std::max(tile.x, 1), x1 = std::min(tile.x + tile.width, step - 1);
+        const int y0 = std::max(tile.y, 1), y1 = std::min(tile.y + tile.height, rows - 2);
+
+        // vertical bidirectional
+        for (int x = x0; x < x1; x++)
         {
-            // choose a label at the current level
-            sublabel = y * step + x;
-            // get the label at the top level (= superpixel label)
-            labelA = parent[level][y * step + x];
-            // get the neighboring label at the top level (= superpixel label)
-            labelB = parent[level][(y + 1) * step + x];
-
-            if( labelA == labelB )
-                continue;
-
-            int a11 = parent[level][(y - 1) * step + (x - 1)];
-            int a12 = parent[level][(y - 1) * step + (x)];
-            int a13 = parent[level][(y - 1) * step + (x + 1)];
-            int a21 = parent[level][(y) * step + (x - 1)];
-            int a22 = parent[level][(y) * step + (x)];
-            int a23 = parent[level][(y) * step + (x + 1)];
-
-            done = false;
-            if( nr_partitions[labelA] == 2 || (nr_partitions[labelA] > 2 // 3 or more partitions
-                    && checkSplit_vf(a11, a12, a13, a21, a22, a23)) )
+            for (int y = y0; y < y1; y++)
             {
-                // run algorithm as usual
-                float conf = intersectConf(seeds_top_level, labelB, labelA, level, sublabel);
-                if( conf > req_confidence )
-                {
-                    deleteBlockToplevel(labelA, level, sublabel);
-                    addBlockToplevel(labelB, level, sublabel);
-                    done = true;
-                }
-            }
+                // choose a label at the current level
+                sublabel = y * step + x;
+                // get the label at the top level (= superpixel label)
+                labelA = parent[level][y * step + x];
+                // get the neighboring label at the top level (= superpixel label)
+                labelB = parent[level][(y + 1) * step + x];
+
+                if( labelA == labelB )
+                    continue;
+
+                int a11 = parent[level][(y - 1) * step + (x - 1)];
+                int a12 = parent[level][(y - 1) * step + (x)];
+                int a13 = parent[level][(y - 1) * step + (x + 1)];
+                int a21 = parent[level][(y) * step + (x - 1)];
+                int a22 = parent[level][(y) * step + (x)];
+                int a23 = parent[level][(y) * step + (x + 1)];
 
-            if( !done && (nr_partitions[labelB] > MINIMUM_NR_SUBLABELS) )
-            {
-                // try opposite direction
-                sublabel = (y + 1) * step + x;
-                int a31 = parent[level][(y + 1) * step + (x - 1)];
-                int a32 = parent[level][(y + 1) * step + (x)];
-                int a33 = parent[level][(y + 1) * step + (x + 1)];
-                int a41 = parent[level][(y + 2) * step + (x - 1)];
-                int a42 = parent[level][(y + 2) * step + (x)];
-                int a43 = parent[level][(y + 2) * step + (x + 1)];
-                if( nr_partitions[labelB] <= 2 // == 2
-                        || (nr_partitions[labelB] > 2 && checkSplit_vb(a31, a32, a33, a41, a42, a43)) )
+                done = false;
+                if( st.nrPartitions(labelA) == 2 || (st.nrPartitions(labelA) > 2 // 3 or more partitions
+                        && checkSplit_vf(a11, a12, a13, a21, a22, a23)) )
                 {
                     // run algorithm as usual
-                    float conf = intersectConf(seeds_top_level, labelA, labelB, level, sublabel);
+                    float conf = intersectConf(st, labelB, labelA, level, sublabel);
                     if( conf > req_confidence )
                     {
-                        deleteBlockToplevel(labelB, level, sublabel);
-                        addBlockToplevel(labelA, level, sublabel);
-                        y++;
+                        deleteBlockToplevel(st, labelA, level, sublabel);
+                        addBlockToplevel(st, labelB, level, sublabel);
+                        done = true;
+                    }
+                }
+
+                if( !done && (st.nrPartitions(labelB) > MINIMUM_NR_SUBLABELS) )
+                {
+                    // try opposite direction
+                    sublabel = (y + 1) * step + x;
+                    int a31 = parent[level][(y + 1) * step + (x - 1)];
+                    int a32 = parent[level][(y + 1) * step + (x)];
+                    int a33 = parent[level][(y + 1) * step + (x + 1)];
+                    int a41 = parent[level][(y + 2) * step + (x - 1)];
+                    int a42 = parent[level][(y + 2) * step + (x)];
+                    int a43 = parent[level][(y + 2) * step + (x + 1)];
+                    if( st.nrPartitions(labelB) <= 2 // == 2
+                            || (st.nrPartitions(labelB) > 2 && checkSplit_vb(a31, a32, a33, a41, a42, a43)) )
+                    {
+                        // run algorithm as usual
+                        float conf = intersectConf(st, labelA, labelB, level, sublabel);
+                        if( conf > req_confidence )
+                        {
+                            deleteBlockToplevel(st, labelB, level, sublabel);
+                            addBlockToplevel(st, labelA, level, sublabel);
+                            y++;
+                        }
                     }
                 }
             }
@@ -605,6 +747,85 @@ void SuperpixelSEEDSImpl::updateBlocks(int level, float req_confidence)
     }
 }
 
+class SuperpixelSEEDSImpl::TileInvoker : public ParallelLoopBody
+{
+public:
+    TileInvoker(SuperpixelSEEDSImpl* _impl, TileMode _mode, int _level, float _req_confidence,
+            const vector<Rect>& _tiles)
+        : impl(_impl), mode(_mode), level(_level), req_confidence(_req_confidence), tiles(_tiles) {}
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            SeedsTileState& st = impl->tile_states[i];
+            st.reset(impl->histogram[impl->seeds_top_level], impl->T[impl->seeds_top_level],
+                    impl->nr_partitions, impl->histogram_size, impl->histogram_size_aligned);
+            impl->updateTile(mode, level, req_confidence, tiles[i], st);
+            st.finish();
+        }
+    }
+
+private:
+    SuperpixelSEEDSImpl* impl;
+    TileMode mode;
+    int level;
+    float req_confidence;
+    const vector<Rect>& tiles;
+};
+
+void SuperpixelSEEDSImpl::updateTiled(TileMode mode, int level, float req_confidence)
+{
+    const bool blocks = mode == TILE_BLOCKS_HORIZONTAL || mode == TILE_BLOCKS_VERTICAL;
+    const int grid_w = blocks ? nr_wh[2 * level] : width;
+    const int grid_h = blocks ? nr_wh[2 * level + 1] : height;
+    const int tile_size = blocks ? BLOCK_TILE_SIZE : PIXEL_TILE_SIZE;
+    const int nr_tiles_x = (grid_w + tile_size - 1) / tile_size;
+    const int nr_tiles_y = (grid_h + tile_size - 1) / tile_size;
+
+    // a tile reads up to 2 and writes up to 1 cell beyond its borders, so tiles of the
+    // same color are independent. images with a single tile are updated exactly as before
+    vector<Rect> tiles;
+    for (int color = 0; color < 4; color++)
+    {
+        tiles.clear();
+        for (int ty = color >> 1; ty < nr_tiles_y; ty += 2)
+            for (int tx = color & 1; tx < nr_tiles_x; tx += 2)
+                tiles.push_back(Rect(tx * tile_size, ty * tile_size,
+                        std::min(tile_size, grid_w - tx * tile_size),
+                        std::min(tile_size, grid_h - ty * tile_size)));
+        if( tiles.empty() )
+            continue;
+
+        if( tile_states.size() < tiles.size() )
+            tile_states.resize(tiles.size());
+        parallel_for_(Range(0, (int)tiles.size()),
+                TileInvoker(this, mode, level, req_confidence, tiles));
+        for (size_t i = 0; i < tiles.size(); i++)
+            tile_states[i].merge();
+    }
+}
+
+void SuperpixelSEEDSImpl::updateTile(TileMode mode, int level, float req_confidence,
+        const Rect& tile, SeedsTileState& st)
+{
+    switch( mode )
+    {
+    case TILE_BLOCKS_HORIZONTAL:
+        updateBlocksTile(level, req_confidence, tile, true, st);
+        break;
+    case TILE_BLOCKS_VERTICAL:
+        updateBlocksTile(level, req_confidence, tile, false, st);
+        break;
+    case TILE_PIXELS_HORIZONTAL:
+        updatePixelsTile(tile, true, st);
+        break;
+    case TILE_PIXELS_VERTICAL:
+        updatePixelsTile(tile, false, st);
+        break;
+    }
+}
+
 int SuperpixelSEEDSImpl::goDownOneLevel()
 {
     int old_level = seeds_current_level;
@@ -636,219 +857,239 @@ int SuperpixelSEEDSImpl::goDownOneLevel()
 }
 
 void SuperpixelSEEDSImpl::updatePixels()
+{
+    int labelA;
+    int labelB;
+
+    updateTiled(TILE_PIXELS_HORIZONTAL);
+    updateTiled(TILE_PIXELS_VERTICAL);
+    forwardbackward = !forwardbackward;
+
+    // update border pixels
+    for (int x = 0; x < width; x++)
+    {
+        labelA = labels[x];
+        labelB = labels[width + x];
+        if( labelA != labelB )
+            update(labelB, x, labelA);
+        labelA = labels[(height - 1) * width + x];
+        labelB = labels[(height - 2) * width + x];
+        if( labelA != labelB )
+            update(labelB, (height - 1) * width + x, labelA);
+    }
+    for (int y = 0; y < height; y++)
+    {
+        labelA = labels[y * width];
+        labelB = labels[y * width + 1];
+        if( labelA != labelB )
+            update(labelB, y * width, labelA);
+        labelA = labels[y * width + width - 1];
+        labelB = labels[y * width + width - 2];
+        if( labelA != labelB )
+            update(labelB, y * width + width - 1, labelA);
+    }
+}
+
+void SuperpixelSEEDSImpl::updatePixelsTile(const Rect& tile, bool horizontal, SeedsTileState& st)
 {
     int labelA;
     int labelB;
     int priorA = 0;
     int priorB = 0;
 
-    for (int y = 1; y < height - 1; y++)
+    if( horizontal )
     {
-        for (int x = 1; x < width - 2; x++)
+        const int x0 = std::max(tile.x, 1), x1 = std::min(tile.x + tile.width, width - 2);
+        const int y0 = std::max(tile.y, 1), y1 = std::min(tile.y + tile.height, height - 1);
+
+        for (int y = y0; y < y1; y++)
         {
+            for (int x = x0; x < x1; x++)
+            {
 
-            labelA = labels[(y) * width + (x)];
-            labelB = labels[(y) * width + (x + 1)];
+                labelA = labels[(y) * width + (x)];
+                labelB = labels[(y) * width + (x + 1)];
 
-            if( labelA != labelB )
-            {
-                int a22 = labelA;
-                int a23 = labelB;
-                if( forwardbackward )
+                if( labelA != labelB )
                 {
-                    // horizontal bidirectional
-                    int a11 = labels[(y - 1) * width + (x - 1)];
-                    int a12 = labels[(y - 1) * width + (x)];
-                    int a21 = labels[(y) * width + (x - 1)];
-                    int a31 = labels[(y + 1) * width + (x - 1)];
-                    int a32 = labels[(y + 1) * width + (x)];
-                    if( checkSplit_hf(a11, a12, a21, a22, a31, a32) )
+                    int a22 = labelA;
+                    int a23 = labelB;
+                    if( forwardbackward )
                     {
-                        if( seeds_prior )
+                        // horizontal bidirectional
+                        int a11 = labels[(y - 1) * width + (x - 1)];
+                        int a12 = labels[(y - 1) * width + (x)];
+                        int a21 = labels[(y) * width + (x - 1)];
+                        int a31 = labels[(y + 1) * width + (x - 1)];
+                        int a32 = labels[(y + 1) * width + (x)];
+                        if( checkSplit_hf(a11, a12, a21, a22, a31, a32) )
                         {
-                            priorA = threebyfour(x, y, labelA);
-                            priorB = threebyfour(x, y, labelB);
-                        }
+                            if( seeds_prior )
+                            {
+                                priorA = threebyfour(x, y, labelA);
+                                priorB = threebyfour(x, y, labelB);
+                            }
 
-                        if( probability(y * width + x, labelA, labelB, priorA, priorB) )
-                        {
-                            update(labelB, y * width + x, labelA);
-                        }
-                        else
-                        {
-                            int a13 = labels[(y - 1) * width + (x + 1)];
-                            int a14 = labels[(y - 1) * width + (x + 2)];
-                            int a24 = labels[(y) * width + (x + 2)];
-                            int a33 = labels[(y + 1) * width + (x + 1)];
-                            int a34 = labels[(y + 1) * width + (x + 2)];
-                            if( checkSplit_hb(a13, a14, a23, a24, a33, a34) )
+                            if( probability(st, y * width + x, labelA, labelB, priorA, priorB) )
+                            {
+                                update(st, labelB, y * width + x, labelA);
+                            }
+                            else
                             {
-                                if( probability(y * width + x + 1, labelB, labelA, priorB, priorA) )
+                                int a13 = labels[(y - 1) * width + (x + 1)];
+                                int a14 = labels[(y - 1) * width + (x + 2)];
+                                int a24 = labels[(y) * width + (x + 2)];
+                                int a33 = labels[(y + 1) * width + (x + 1)];
+                                int a34 = labels[(y + 1) * width + (x + 2)];
+                                if( checkSplit_hb(a13, a14, a23, a24, a33, a34) )
                                 {
-                                    update(labelA, y * width + x + 1, labelB);
-                                    x++;
+                                    if( probability(st, y * width + x + 1, labelB, labelA, priorB, priorA) )
+                                    {
+                                        update(st, labelA, y * width + x + 1, labelB);
+                                        x++;
+                                    }
                                 }
                             }
                         }
                     }
-                }
-                else
-                { // forward backward
-                    // horizontal bidirectional
-                    int a13 = labels[(y - 1) * width + (x + 1)];
-                    int a14 = labels[(y - 1) * width + (x + 2)];
-                    int a24 = labels[(y) * width + (x + 2)];
-                    int a33 = labels[(y + 1) * width + (x + 1)];
-                    int a34 = labels[(y + 1) * width + (x + 2)];
-                    if( checkSplit_hb(a13, a14, a23, a24, a33, a34) )
-                    {
-                        if( seeds_prior )
+                    else
+                    { // forward backward
+                        // horizontal bidirectional
+                        int a13 = labels[(y - 1) * width + (x + 1)];
+                        int a14 = labels[(y - 1) * width + (x + 2)];
+                        int a24 = labels[(y) * width + (x + 2)];
+                        int a33 = labels[(y + 1) * width + (x + 1)];
+                        int a34 = labels[(y + 1) * width + (x + 2)];
+                        if( checkSplit_hb(a13, a14, a23, a24, a33, a34) )
                         {
-                            priorA = threebyfour(x, y, labelA);
-                            priorB = threebyfour(x, y, labelB);
-                        }
+                            if( seeds_prior )
+                            {
+                                priorA = threebyfour(x, y, labelA);
+                                priorB = threebyfour(x, y, labelB);
+                            }
 
-                        if( probability(y * width + x + 1, labelB, labelA, priorB, priorA) )
-                        {
-                            update(labelA, y * width + x + 1, labelB);
-                            x++;
-                        }
-                        else
-                        {
-                            int a11 = labels[(y - 1) * width + (x - 1)];
-                            int a12 = labels[(y - 1) * width + (x)];
-                            int a21 = labels[(y) * width + (x - 1)];
-                            int a31 = labels[(y + 1) * width + (x - 1)];
-                            int a32 = labels[(y + 1) * width + (x)];
-                            if( checkSplit_hf(a11, a12, a21, a22, a31, a32) )
+                            if( probability(st, y * width + x + 1, labelB, labelA, priorB, priorA) )
+                            {
+                                update(st, labelA, y * width + x + 1, labelB);
+                                x++;
+                            }
+                            else
                             {
-                                if( probability(y * width + x, labelA, labelB, priorA, priorB) )
+                                int a11 = labels[(y - 1) * width + (x - 1)];
+                                int a12 = labels[(y - 1) * width + (x)];
+                                int a21 = labels[(y) * width + (x - 1)];
+                                int a31 = labels[(y + 1) * width + (x - 1)];
+                                int a32 = labels[(y + 1) * width + (x)];
+                                if( checkSplit_hf(a11, a12, a21, a22, a31, a32) )
                                 {
-                                    update(labelB, y * width + x, labelA);
+                                    if( probability(st, y * width + x, labelA, labelB, priorA, priorB) )
+                                    {
+                                        update(st, labelB, y * width + x, labelA);
+                                    }
                                 }
                             }
                         }
                     }
-                }
-            } // labelA != labelB
-        } // for x
-    } // for y
-
-    for (int x = 1; x < width - 1; x++)
+                } // labelA != labelB
+            } // for x
+        } // for y
+    }
+    else
     {
-        for (int y = 1; y < height - 2; y++)
-        {
+        const int x0 = std::max(tile.x, 1), x1 = std::min(tile.x + tile.width, width - 1);
+        const int y0 = std::max(tile.y, 1), y1 = std::min(tile.y + tile.height, height - 2);
 
-            labelA = labels[(y) * width + (x)];
-            labelB = labels[(y + 1) * width + (x)];
-            if( labelA != labelB )
+        for (int x = x0; x < x1; x++)
+        {
+            for (int y = y0; y < y1; y++)
             {
-                int a22 = labelA;
-                int a32 = labelB;
 
-                if( forwardbackward )
+                labelA = labels[(y) * width + (x)];
+                labelB = labels[(y + 1) * width + (x)];
+                if( labelA != labelB )
                 {
-                    // vertical bidirectional
-                    int a11 = labels[(y - 1) * width + (x - 1)];
-                    int a12 = labels[(y - 1) * width + (x)];
-                    int a13 = labels[(y - 1) * width + (x + 1)];
-                    int a21 = labels[(y) * width + (x - 1)];
-                    int a23 = labels[(y) * width + (x + 1)];
-                    if( checkSplit_vf(a11, a12, a13, a21, a22, a23) )
+                    int a22 = labelA;
+                    int a32 = labelB;
+
+                    if( forwardbackward )
                     {
-                        if( seeds_prior )
+                        // vertical bidirectional
+                        int a11 = labels[(y - 1) * width + (x - 1)];
+                        int a12 = labels[(y - 1) * width + (x)];
+                        int a13 = labels[(y - 1) * width + (x + 1)];
+                        int a21 = labels[(y) * width + (x - 1)];
+                        int a23 = labels[(y) * width + (x + 1)];
+                        if( checkSplit_vf(a11, a12, a13, a21, a22, a23) )
                         {
-                            priorA = fourbythree(x, y, labelA);
-                            priorB = fourbythree(x, y, labelB);
-                        }
+                            if( seeds_prior )
+                            {
+                                priorA = fourbythree(x, y, labelA);
+                                priorB = fourbythree(x, y, labelB);
+                            }
 
-                        if( probability(y * width + x, labelA, labelB, priorA, priorB) )
-                        {
-                            update(labelB, y * width + x, labelA);
-                        }
-                        else
-                        {
-                            int a31 = labels[(y + 1) * width + (x - 1)];
-                            int a33 = labels[(y + 1) * width + (x + 1)];
-                            int a41 = labels[(y + 2) * width + (x - 1)];
-                            int a42 = labels[(y + 2) * width + (x)];
-                            int a43 = labels[(y + 2) * width + (x + 1)];
-                            if( checkSplit_vb(a31, a32, a33, a41, a42, a43) )
+                            if( probability(st, y * width + x, labelA, labelB, priorA, priorB) )
+                            {
+                                update(st, labelB, y * width + x, labelA);
+                            }
+                            else
                             {
-                                if( probability((y + 1) * width + x, labelB, labelA, priorB, priorA) )
+                                int a31 = labels[(y + 1) * width + (x - 1)];
+                                int a33 = labels[(y + 1) * width + (x + 1)];
+                                int a41 = labels[(y + 2) * width + (x - 1)];
+                                int a42 = labels[(y + 2) * width + (x)];
+                                int a43 = labels[(y + 2) * width + (x + 1)];
+                                if( checkSplit_vb(a31, a32, a33, a41, a42, a43) )
                                 {
-                                    update(labelA, (y + 1) * width + x, labelB);
-                                    y++;
+                                    if( probability(st, (y + 1) * width + x, labelB, labelA, priorB, priorA) )
+                                    {
+                                        update(st, labelA, (y + 1) * width + x, labelB);
+                                        y++;
+                                    }
                                 }
                             }
                         }
                     }
-                }
-                else
-                { // forwardbackward
-                    // vertical bidirectional
-                    int a31 = labels[(y + 1) * width + (x - 1)];
-                    int a33 = labels[(y + 1) * width + (x + 1)];
-                    int a41 = labels[(y + 2) * width + (x - 1)];
-                    int a42 = labels[(y + 2) * width + (x)];
-                    int a43 = labels[(y + 2) * width + (x + 1)];
-                    if( checkSplit_vb(a31, a32, a33, a41, a42, a43) )
-                    {
-                        if( seeds_prior )
+                    else
+                    { // forwardbackward
+                        // vertical bidirectional
+                        int a31 = labels[(y + 1) * width + (x - 1)];
+                        int a33 = labels[(y + 1) * width + (x + 1)];
+                        int a41 = labels[(y + 2) * width + (x - 1)];
+                        int a42 = labels[(y + 2) * width + (x)];
+                        int a43 = labels[(y + 2) * width + (x + 1)];
+                        if( checkSplit_vb(a31, a32, a33, a41, a42, a43) )
                         {
-                            priorA = fourbythree(x, y, labelA);
-                            priorB = fourbythree(x, y, labelB);
-                        }
+                            if( seeds_prior )
+                            {
+                                priorA = fourbythree(x, y, labelA);
+                                priorB = fourbythree(x, y, labelB);
+                            }
 
-                        if( probability((y + 1) * width + x, labelB, labelA, priorB, priorA) )
-                        {
-                            update(labelA, (y + 1) * width + x, labelB);
-                            y++;
-                        }
-                        else
-                        {
-                            int a11 = labels[(y - 1) * width + (x - 1)];
-                            int a12 = labels[(y - 1) * width + (x)];
-                            int a13 = labels[(y - 1) * width + (x + 1)];
-                            int a21 = labels[(y) * width + (x - 1)];
-                            int a23 = labels[(y) * width + (x + 1)];
-                            if( checkSplit_vf(a11, a12, a13, a21, a22, a23) )
+                            if( probability(st, (y + 1) * width + x, labelB, labelA, priorB, priorA) )
+                            {
+                                update(st, labelA, (y + 1) * width + x, labelB);
+                                y++;
+                            }
+                            else
                             {
-                                if( probability(y * width + x, labelA, labelB, priorA, priorB) )
+                                int a11 = labels[(y - 1) * width + (x - 1)];
+                                int a12 = labels[(y - 1) * width + (x)];
+                                int a13 = labels[(y - 1) * width + (x + 1)];
+                                int a21 = labels[(y) * width + (x - 1)];
+                                int a23 = labels[(y) * width + (x + 1)];
+                                if( checkSplit_vf(a11, a12, a13, a21, a22, a23) )
                                 {
-                                    update(labelB, y * width + x, labelA);
+                                    if( probability(st, y * width + x, labelA, labelB, priorA, priorB) )
+                                    {
+                                        update(st, labelB, y * width + x, labelA);
+                                    }
                                 }
                             }
                         }
                     }
-                }
-            } // labelA != labelB
-        } // for y
-    } // for x
-    forwardbackward = !forwardbackward;
-
-    // update border pixels
-    for (int x = 0; x < width; x++)
-    {
-        labelA = labels[x];
-        labelB = labels[width + x];
-        if( labelA != labelB )
-            update(labelB, x, labelA);
-        labelA = labels[(height - 1) * width + x];
-        labelB = labels[(height - 2) * width + x];
-        if( labelA != labelB )
-            update(labelB, (height - 1) * width + x, labelA);
-    }
-    for (int y = 0; y < height; y++)
-    {
-        labelA = labels[y * width];
-        labelB = labels[y * width + 1];
-        if( labelA != labelB )
-            update(labelB, y * width, labelA);
-        labelA = labels[y * width + width - 1];
-        labelB = labels[y * width + width - 2];
-        if( labelA != labelB )
-            update(labelB, y * width + width - 1, labelA);
+                } // labelA != labelB
+            } // for y
+        } // for x
     }
 }
 
@@ -860,6 +1101,19 @@ void SuperpixelSEEDSImpl::update(int label_new, int image_idx, int label_old)
     labels[image_idx] = label_new;
 }
 
+void SuperpixelSEEDSImpl::update(SeedsTileState& st, int label_new, int image_idx, int label_old)
+{
+    //change the label of a single pixel inside of a tile
+    int s_old = st.slot(label_old);
+    int s_new = st.slot(label_new);
+    unsigned int color = image_bins[image_idx];
+    st.row(s_old)[color]--;
+    st.count(s_old)--;
+    st.row(s_new)[color]++;
+    st.count(s_new)++;
+    labels[image_idx] = label_new;
+}
+
 void SuperpixelSEEDSImpl::addPixel(int level, int label, int image_idx)
 {
     histogram[level][label * histogram_size_aligned + image_bins[image_idx]]++;
@@ -901,15 +1155,39 @@ void SuperpixelSEEDSImpl::addBlock(int level, int label, int sublevel,
     T[level][label] += T[sublevel][sublabel];
 }
 
-void SuperpixelSEEDSImpl::addBlockToplevel(int label, int sublevel, int sublabel)
+void SuperpixelSEEDSImpl::addBlockToplevel(SeedsTileState& st, int label, int sublevel, int sublabel)
 {
-    addBlock(seeds_top_level, label, sublevel, sublabel);
-    nr_partitions[label]++;
+    parent[sublevel][sublabel] = label;
+
+    int s = st.slot(label);
+    HISTN* h_label = st.row(s);
+    HISTN* h_sublabel = &histogram[sublevel][sublabel * histogram_size_aligned];
+
+    int n = 0;
+#if CV_SSSE3
+    const int loop_end = histogram_size - 3;
+    for (; n < loop_end; n += 4)
+    {
+        //this does exactly the same as the loop peeling below, but 4 elements at a time
+        __m128 h_labelp = _mm_load_ps(h_label + n);
+        __m128 h_sublabelp = _mm_load_ps(h_sublabel + n);
+        h_labelp = _mm_add_ps(h_labelp, h_sublabelp);
+        _mm_store_ps(h_label + n, h_labelp);
+    }
+#endif
+
+    //loop peeling
+    for (; n < histogram_size; n++)
+        h_label[n] += h_sublabel[n];
+
+    st.count(s) += T[sublevel][sublabel];
+    st.partitionsAt(s)++;
 }
 
-void SuperpixelSEEDSImpl::deleteBlockToplevel(int label, int sublevel, int sublabel)
+void SuperpixelSEEDSImpl::deleteBlockToplevel(SeedsTileState& st, int label, int sublevel, int sublabel)
 {
-    HISTN* h_label = &histogram[seeds_top_level][label * histogram_size_aligned];
+    int s = st.slot(label);
+    HISTN* h_label = st.row(s);
     HISTN* h_sublabel = &histogram[sublevel][sublabel * histogram_size_aligned];
 
     //do the reverse operation of add_block_toplevel
@@ -930,9 +1208,9 @@ void SuperpixelSEEDSImpl::deleteBlockToplevel(int label, int sublevel, int subla
     for (; n < histogram_size; ++n)
         h_label[n] -= h_sublabel[n];
 
-    T[seeds_top_level][label] -= T[sublevel][sublabel];
+    st.count(s) -= T[sublevel][sublabel];
 
-    nr_partitions[label]--;
+    st.partitionsAt(s)--;
 }
 
 void SuperpixelSEEDSImpl::updateLabels()
@@ -941,14 +1219,14 @@ void SuperpixelSEEDSImpl::updateLabels()
         labels[i] = parent[0][labels_bottom[i]];
 }
 
-bool SuperpixelSEEDSImpl::probability(int image_idx, int label1, int label2,
+bool SuperpixelSEEDSImpl::probability(SeedsTileState& st, int image_idx, int label1, int label2,
         int prior1, int prior2)
 {
     unsigned int color = image_bins[image_idx];
-    float P_label1 = histogram[seeds_top_level][label1 * histogram_size_aligned + color]
-                                                * T[seeds_top_level][label2];
-    float P_label2 = histogram[seeds_top_level][label2 * histogram_size_aligned + color]
-                                                * T[seeds_top_level][label1];
+    int s1 = st.slot(label1);
+    int s2 = st.slot(label2);
+    float P_label1 = st.row(s1)[color] * st.count(s2);
+    float P_label2 = st.row(s2)[color] * st.count(s1);
 
     if( seeds_prior )
     {
@@ -967,8 +1245,8 @@ bool SuperpixelSEEDSImpl::probability(int image_idx, int label1, int label2,
             /* fallthrough */
         case 2:
             p *= p;
-            P_label1 *= T[seeds_top_level][label2];
-            P_label2 *= T[seeds_top_level][label1];
+            P_label1 *= st.count(s2);
+            P_label2 *= st.count(s1);
             /* fallthrough */
         case 1:
             P_label1 *= p;
@@ -1086,16 +1364,18 @@ int SuperpixelSEEDSImpl::fourbythree(int x, int y, int label)
 #endif
 }
 
-float SuperpixelSEEDSImpl::intersectConf(int level1, int label1A, int label1B,
+float SuperpixelSEEDSImpl::intersectConf(SeedsTileState& st, int label1A, int label1B,
         int level2, int label2)
 {
     float sumA = 0, sumB = 0;
-    float* h1A = &histogram[level1][label1A * histogram_size_aligned];
-    float* h1B = &histogram[level1][label1B * histogram_size_aligned];
+    int s1A = st.slot(label1A);
+    int s1B = st.slot(label1B);
+    float* h1A = st.row(s1A);
+    float* h1B = st.row(s1B);
     float* h2 = &histogram[level2][label2 * histogram_size_aligned];
-    const float count1A = T[level1][label1A];
+    const float count1A = st.count(s1A);
     const float count2 = T[level2][label2];
-    const float count1B = T[level1][label1B] - count2;
+    const float count1B = st.count(s1B) - count2;
 
     /* this calculates several things:
      * - normalized intersection of a histogram. which is equal to:
@@ -42,6 +42,8 @@ the use of this software, even if advised of the possibility of such damage.
 #include "opencv2/ximgproc/segmentation.hpp"
 
 #include <iostream>
+#include <queue>
+#include <climits>
 
 namespace cv {
     namespace ximgproc {
@@ -162,38 +164,72 @@ namespace cv {
 
                     histograms = Mat_<float>(nb_segs, histogram_size);
 
-                    for (int r = 0; r < nb_segs; r++) {
+                    if (img.depth() == CV_8U) {
+                        // Add every pixel to the histogram of its region in a single pass, with the same binning as calcHist
+                        uchar bins[256];
+                        for (int v = 0; v < 256; v++) {
+                            bins[v] = (uchar)std::min(cvFloor(v * (histogram_bins_size / (double)range[1])), histogram_bins_size - 1);
+                        }
 
-                        // Generate mask
-                        Mat mask = regions == r;
+                        Mat_<int> tmp_histograms = Mat_<int>::zeros(nb_segs, histogram_size);
+                        std::vector<int> totals(nb_segs, 0);
+                        const int cn = img.channels();
 
-                        // Compute histogram for each channels
-                        float tt = 0;
+                        for (int i = 0; i < img.rows; i++) {
+                            const uchar* pix = img.ptr<uchar>(i);
+                            const int* reg = regions.ptr<int>(i);
 
-                        Mat tmp_hists = Mat(histogram_size, 1, CV_32F);
-                        float *tmp_histogram = tmp_hists.ptr<float>(0);
-                        int h_pos = 0;
-                        Mat tmp_hist;
+                            for (int j = 0; j < img.cols; j++, pix += cn) {
+                                int* histogram = tmp_histograms.ptr<int>(reg[j]);
+                                for (int p = 0; p < cn; p++) {
+                                    histogram[p * histogram_bins_size + bins[pix[p]]]++;
+                                }
+                                totals[reg[j]] += cn;
+                            }
+                        }
 
-                        for (int p = 0; p < img.channels(); p++) {
+                        for (int r = 0; r < nb_segs; r++) {
+                            float* histogram = histograms.ptr<float>(r);
+                            const int* tmp_histogram = tmp_histograms.ptr<int>(r);
+
+                            for (int h_pos2 = 0; h_pos2 < histogram_size; h_pos2++) {
+                                histogram[h_pos2] = (float)tmp_histogram[h_pos2] / (float)totals[r];
+                            }
+                        }
+                    } else {
+                        for (int r = 0; r < nb_segs; r++) {
 
-                            calcHist(&img_planes[p], 1, 0, mask, tmp_hist, 1, &histogram_bins_size, &histogram_ranges);
+                            // Generate mask
+                            Mat mask = regions == r;
 
-                            float *tmp_hist_ = tmp_hist.ptr<float>(0);
+                            // Compute histogram for each channels
+                            float tt = 0;
 
-                            // Copy local histogram to global histogram
-                            for (int pos = 0; pos < histogram_bins_size; pos++) {
-                                tmp_histogram[pos + h_pos] = tmp_hist_[pos];
-                                tt += tmp_histogram[pos + h_pos];
+                            Mat tmp_hists = Mat(histogram_size, 1, CV_32F);
+                            float *tmp_histogram = tmp_hists.ptr<float>(0);
+                            int h_pos = 0;
+                            Mat tmp_hist;
+
+                            for (int p = 0; p < img.channels(); p++) {
+
+                                calcHist(&img_planes[p], 1, 0, mask, tmp_hist, 1, &histogram_bins_size, &histogram_ranges);
+
+                                float *tmp_hist_ = tmp_hist.ptr<float>(0);
+
+                                // Copy local histogram to global histogram
+                                for (int pos = 0; pos < histogram_bins_size; pos++) {
+                                    tmp_histogram[pos + h_pos] = tmp_hist_[pos];
+                                    tt += tmp_histogram[pos + h_pos];
+                                }
+                                h_pos += histogram_bins_size;
                             }
-                            h_pos += histogram_bins_size;
-                        }
 
-                        // Normalize historgrams
-                        float* histogram = histograms.ptr<float>(r);
+                            // Normalize historgrams
+                            float* histogram = histograms.ptr<float>(r);
 
-                        for (int h_pos2 = 0; h_pos2 < histogram_size; h_pos2++) {
-                            histogram[h_pos2] = tmp_histogram[h_pos2] / tt;
+                            for (int h_pos2 = 0; h_pos2 < histogram_size; h_pos2++) {
+                                histogram[h_pos2] = tmp_histogram[h_pos2] / tt;
+                            }
                         }
                     }
 
@@ -493,117 +529,141 @@ namespace cv {
 
                     int last_image_id; // If the image_id is not equal to -1 and the same as the previous call for setImage, computations are used again
                     Mat last_histograms;
+
+                    // The gaussians only depend on the image, they are kept for other segmentations of the same image when caching is on
+                    Mat last_gaussians_image;
+                    std::vector<Mat> last_gaussians;
+
+                    void computeGaussians(const Mat& img, std::vector<Mat>& img_gaussians);
             };
 
 
-            void SelectiveSearchSegmentationStrategyTextureImpl::setImage(InputArray img_, InputArray regions_, InputArray sizes_, int image_id) {
+            void SelectiveSearchSegmentationStrategyTextureImpl::computeGaussians(const Mat& img, std::vector<Mat>& img_gaussians) {
 
-                Mat img = img_.getMat();
-                Mat regions = regions_.getMat();
-                sizes = sizes_.getMat();
+                std::vector<Mat> img_planes;
+                split(img, img_planes);
 
-                if (image_id == -1 || last_image_id != image_id) {
+                float range[] = {0.0, 256.0};
 
-                    std::vector<Mat> img_planes;
-                    split(img, img_planes);
+                img_gaussians.clear();
 
-                    int histogram_bins_size = 10;
+                // Compute, for each channels, the 8 gaussians
+                for (int p = 0; p < img.channels(); p++) {
 
-                    float range[] = {0.0, 256.0};
+                    Mat tmp_gradiant;
+                    Mat tmp_gradiant_pos, tmp_gradiant_neg;
+                    Mat img_plane_rotated;
+                    Mat tmp_rot;
 
-                    double min, max;
-                    minMaxLoc(regions, &min, &max);
-                    int nb_segs = (int)max + 1;
+                    // X, no rot
+                    Scharr(img_planes[p], tmp_gradiant, CV_32F, 1, 0);
+                    threshold(tmp_gradiant, tmp_gradiant_pos, 0, 0, THRESH_TOZERO);
+                    threshold(tmp_gradiant, tmp_gradiant_neg, 0, 0, THRESH_TOZERO_INV);
 
-                    histogram_size = histogram_bins_size * img.channels() * 8;
+                    img_gaussians.push_back(tmp_gradiant_pos.clone());
+                    img_gaussians.push_back(tmp_gradiant_neg.clone());
 
-                    histograms = Mat_<float>(nb_segs, histogram_size);
+                    // Y, no rot
+                    Scharr(img_planes[p], tmp_gradiant, CV_32F, 0, 1);
+                    threshold(tmp_gradiant, tmp_gradiant_pos, 0, 0, THRESH_TOZERO);
+                    threshold(tmp_gradiant, tmp_gradiant_neg, 0, 0, THRESH_TOZERO_INV);
 
-                    // Compute, for each channels, the 8 gaussians
-                    std::vector<Mat> img_gaussians;
+                    img_gaussians.push_back(tmp_gradiant_pos.clone());
+                    img_gaussians.push_back(tmp_gradiant_neg.clone());
 
-                    for (int p = 0; p < img.channels(); p++) {
+                    Point2f center(img.cols / 2.0f, img.rows / 2.0f);
+                    Mat rot = cv::getRotationMatrix2D(center, 45.0, 1.0);
+                    Rect bbox = cv::RotatedRect(center, img.size(), 45.0).boundingRect();
+                    rot.at<double>(0,2) += bbox.width/2.0 - center.x;
+                    rot.at<double>(1,2) += bbox.height/2.0 - center.y;
 
-                        Mat tmp_gradiant;
-                        Mat tmp_gradiant_pos, tmp_gradiant_neg;
-                        Mat img_plane_rotated;
-                        Mat tmp_rot;
+                    warpAffine(img_planes[p], img_plane_rotated, rot, bbox.size());
 
-                        // X, no rot
-                        Scharr(img_planes[p], tmp_gradiant, CV_32F, 1, 0);
-                        threshold(tmp_gradiant, tmp_gradiant_pos, 0, 0, THRESH_TOZERO);
-                        threshold(tmp_gradiant, tmp_gradiant_neg, 0, 0, THRESH_TOZERO_INV);
+                    // X, rot
+                    Scharr(img_plane_rotated, tmp_gradiant, CV_32F, 1, 0);
 
-                        img_gaussians.push_back(tmp_gradiant_pos.clone());
-                        img_gaussians.push_back(tmp_gradiant_neg.clone());
+                    center = Point((int)(img_plane_rotated.cols / 2.0), (int)(img_plane_rotated.rows / 2.0));
+                    rot = cv::getRotationMatrix2D(center, -45.0, 1.0);
+                    // Using this bigger box avoids clipping the ends of narrow images
+                    Rect bbox2 = cv::RotatedRect(center, img_plane_rotated.size(), -45.0).boundingRect();\
+                    warpAffine(tmp_gradiant, tmp_rot, rot, bbox2.size());
 
-                        // Y, no rot
-                        Scharr(img_planes[p], tmp_gradiant, CV_32F, 0, 1);
-                        threshold(tmp_gradiant, tmp_gradiant_pos, 0, 0, THRESH_TOZERO);
-                        threshold(tmp_gradiant, tmp_gradiant_neg, 0, 0, THRESH_TOZERO_INV);
+                    // for narrow images, bbox might be less tall or wide than img
+                    int start_x = std::max(0, (bbox.width - img.cols) / 2);
+                    int start_y = std::max(0, (bbox.height - img.rows) / 2);
+                    tmp_gradiant = tmp_rot(Rect(start_x, start_y, img.cols, img.rows));
 
-                        img_gaussians.push_back(tmp_gradiant_pos.clone());
-                        img_gaussians.push_back(tmp_gradiant_neg.clone());
+                    threshold(tmp_gradiant, tmp_gradiant_pos, 0, 0, THRESH_TOZERO);
+                    threshold(tmp_gradiant, tmp_gradiant_neg, 0, 0, THRESH_TOZERO_INV);
 
-                        Point2f center(img.cols / 2.0f, img.rows / 2.0f);
-                        Mat rot = cv::getRotationMatrix2D(center, 45.0, 1.0);
-                        Rect bbox = cv::RotatedRect(center, img.size(), 45.0).boundingRect();
-                        rot.at<double>(0,2) += bbox.width/2.0 - center.x;
-                        rot.at<double>(1,2) += bbox.height/2.0 - center.y;
+                    img_gaussians.push_back(tmp_gradiant_pos.clone());
+                    img_gaussians.push_back(tmp_gradiant_neg.clone());
 
-                        warpAffine(img_planes[p], img_plane_rotated, rot, bbox.size());
+                    // Y, rot
+                    Scharr(img_plane_rotated, tmp_gradiant, CV_32F, 0, 1);
 
-                        // X, rot
-                        Scharr(img_plane_rotated, tmp_gradiant, CV_32F, 1, 0);
+                    center = Point((int)(img_plane_rotated.cols / 2.0), (int)(img_plane_rotated.rows / 2.0));
+                    rot = cv::getRotationMatrix2D(center, -45.0, 1.0);
+                    bbox2 = cv::RotatedRect(center, img_plane_rotated.size(), -45.0).boundingRect();\
+                    warpAffine(tmp_gradiant, tmp_rot, rot, bbox2.size());
 
-                        center = Point((int)(img_plane_rotated.cols / 2.0), (int)(img_plane_rotated.rows / 2.0));
-                        rot = cv::getRotationMatrix2D(center, -45.0, 1.0);
-                        // Using this bigger box avoids clipping the ends of narrow images
-                        Rect bbox2 = cv::RotatedRect(center, img_plane_rotated.size(), -45.0).boundingRect();\
-                        warpAffine(tmp_gradiant, tmp_rot, rot, bbox2.size());
+                    start_x = std::max(0, (bbox.width - img.cols) / 2);
+                    start_y = std::max(0, (bbox.height - img.rows) / 2);
+                    tmp_gradiant = tmp_rot(Rect(start_x, start_y, img.cols, img.rows));
 
-                        // for narrow images, bbox might be less tall or wide than img
-                        int start_x = std::max(0, (bbox.width - img.cols) / 2);
-                        int start_y = std::max(0, (bbox.height - img.rows) / 2);
-                        tmp_gradiant = tmp_rot(Rect(start_x, start_y, img.cols, img.rows));
+                    threshold(tmp_gradiant, tmp_gradiant_pos, 0, 0, THRESH_TOZERO);
+                    threshold(tmp_gradiant, tmp_gradiant_neg, 0, 0, THRESH_TOZERO_INV);
 
-                        threshold(tmp_gradiant, tmp_gradiant_pos, 0, 0, THRESH_TOZERO);
-                        threshold(tmp_gradiant, tmp_gradiant_neg, 0, 0, THRESH_TOZERO_INV);
+                    img_gaussians.push_back(tmp_gradiant_pos.clone());
+                    img_gaussians.push_back(tmp_gradiant_neg.clone());
 
-                        img_gaussians.push_back(tmp_gradiant_pos.clone());
-                        img_gaussians.push_back(tmp_gradiant_neg.clone());
+                }
 
-                        // Y, rot
-                        Scharr(img_plane_rotated, tmp_gradiant, CV_32F, 0, 1);
+                // Normalisze gaussiaans in 0-255 range (for faster computation of histograms)
+                for (int i = 0; i < img.channels() * 8; i++) {
 
-                        center = Point((int)(img_plane_rotated.cols / 2.0), (int)(img_plane_rotated.rows / 2.0));
-                        rot = cv::getRotationMatrix2D(center, -45.0, 1.0);
-                        bbox2 = cv::RotatedRect(center, img_plane_rotated.size(), -45.0).boundingRect();\
-                        warpAffine(tmp_gradiant, tmp_rot, rot, bbox2.size());
+                    double hmin, hmax;
+                    minMaxLoc(img_gaussians[i], &hmin, &hmax);
 
-                        start_x = std::max(0, (bbox.width - img.cols) / 2);
-                        start_y = std::max(0, (bbox.height - img.rows) / 2);
-                        tmp_gradiant = tmp_rot(Rect(start_x, start_y, img.cols, img.rows));
+                    Mat tmp;
+                    img_gaussians[i].convertTo(tmp, CV_8U, (range[1] - 1) / (hmax - hmin), -(range[1] - 1) * hmin / (hmax - hmin));
+                    img_gaussians[i] = tmp;
 
-                        threshold(tmp_gradiant, tmp_gradiant_pos, 0, 0, THRESH_TOZERO);
-                        threshold(tmp_gradiant, tmp_gradiant_neg, 0, 0, THRESH_TOZERO_INV);
+                }
+            }
 
-                        img_gaussians.push_back(tmp_gradiant_pos.clone());
-                        img_gaussians.push_back(tmp_gradiant_neg.clone());
+            void SelectiveSearchSegmentationStrategyTextureImpl::setImage(InputArray img_, InputArray regions_, InputArray sizes_, int image_id) {
 
+                Mat img = img_.getMat();
+                Mat regions = regions_.getMat();
+                sizes = sizes_.getMat();
+
+                if (image_id == -1 || last_image_id != image_id) {
+
+                    std::vector<Mat> gaussians;
+                    if (image_id != -1 && last_gaussians_image.data == img.data && last_gaussians_image.size == img.size &&
+                            last_gaussians_image.type() == img.type() && last_gaussians_image.step[0] == img.step[0]) {
+                        gaussians = last_gaussians; // Same image, other regions
+                    } else {
+                        computeGaussians(img, gaussians);
+                        if (image_id != -1) {
+                            last_gaussians_image = img;
+                            last_gaussians = gaussians;
+                        }
                     }
+                    const std::vector<Mat>& img_gaussians = gaussians;
 
-                    // Normalisze gaussiaans in 0-255 range (for faster computation of histograms)
-                    for (int i = 0; i < img.channels() * 8; i++) {
+                    int histogram_bins_size = 10;
 
-                        double hmin, hmax;
-                        minMaxLoc(img_gaussians[i], &hmin, &hmax);
+                    float range[] = {0.0, 256.0};
 
-                        Mat tmp;
-                        img_gaussians[i].convertTo(tmp, CV_8U, (range[1] - 1) / (hmax - hmin), -(range[1] - 1) * hmin / (hmax - hmin));
-                        img_gaussians[i] = tmp;
+                    double min, max;
+                    minMaxLoc(regions, &min, &max);
+                    int nb_segs = (int)max + 1;
 
-                    }
+                    histogram_size = histogram_bins_size * img.channels() * 8;
+
+                    histograms = Mat_<float>(nb_segs, histogram_size);
 
                     // We compute histograms manualy, directly addings bins based on the region instead of computing multiple histograms
                     // This speedup significantly computations
@@ -731,7 +791,60 @@ namespace cv {
                     std::vector<Ptr<GraphSegmentation> > segmentations;
                     std::vector<Ptr<SelectiveSearchSegmentationStrategy> > strategies;
 
-                    void hierarchicalGrouping(const Mat& img, Ptr<SelectiveSearchSegmentationStrategy>& s, const Mat& img_regions, const Mat_<char>& is_neighbour, const Mat_<int>& sizes, int& nb_segs, const std::vector<Rect>& bounding_rects, std::vector<Region>& regions, int region_id);
+                    // Initial segmentation of one (image, graph segmentation) couple
+                    struct Segmentation {
+                        Mat img_regions;
+                        Mat_<int> sizes;
+                        int nb_segs;
+                        std::vector<Rect> bounding_rects;
+                        std::vector<int> neighbours_start; // [region] start of the neighbours of region in neighbours, nb_segs + 1 entries
+                        std::vector<int> neighbours; // neighbours with a bigger id, in increasing order
+                    };
+
+                    class SegmentationInvoker;
+                    class GroupingInvoker;
+
+                    void segment(const Mat& img, Ptr<GraphSegmentation>& gs, Segmentation& seg);
+                    void hierarchicalGrouping(const Mat& img, Ptr<SelectiveSearchSegmentationStrategy>& s, const Segmentation& seg, RNG& rng, std::vector<Region>& regions, int image_id);
+            };
+
+            class SelectiveSearchSegmentationImpl::SegmentationInvoker CV_FINAL : public ParallelLoopBody {
+                public:
+                    SegmentationInvoker(SelectiveSearchSegmentationImpl* impl_, std::vector<Segmentation>& segs_) : impl(impl_), segs(segs_) {}
+
+                    virtual void operator()(const Range& range) const CV_OVERRIDE {
+                        const int nb_gs = (int)impl->segmentations.size();
+                        for (int i = range.start; i < range.end; i++) {
+                            impl->segment(impl->images[i / nb_gs], impl->segmentations[i % nb_gs], segs[i]);
+                        }
+                    }
+
+                private:
+                    SelectiveSearchSegmentationImpl* impl;
+                    std::vector<Segmentation>& segs;
+            };
+
+            // Each parallel job runs a range of strategies on all the segmentations, in the same order as a sequential run
+            class SelectiveSearchSegmentationImpl::GroupingInvoker CV_FINAL : public ParallelLoopBody {
+                public:
+                    GroupingInvoker(SelectiveSearchSegmentationImpl* impl_, const std::vector<Segmentation>& segs_, std::vector<std::vector<Region> >& results_) : impl(impl_), segs(segs_), results(results_) {}
+
+                    virtual void operator()(const Range& range) const CV_OVERRIDE {
+                        const int nb_gs = (int)impl->segmentations.size();
+                        const int nb_strategies = (int)impl->strategies.size();
+                        for (int st = range.start; st < range.end; st++) {
+                            for (int image_id = 0; image_id < (int)segs.size(); image_id++) {
+                                const int branch = image_id * nb_strategies + st;
+                                RNG rng((uint64)branch + 1);
+                                impl->hierarchicalGrouping(impl->images[image_id / nb_gs], impl->strategies[st], segs[image_id], rng, results[branch], image_id);
+                            }
+                        }
+                    }
+
+                private:
+                    SelectiveSearchSegmentationImpl* impl;
+                    const std::vector<Segmentation>& segs;
+                    std::vector<std::vector<Region> >& results;
             };
 
             void SelectiveSearchSegmentationImpl::setBaseImage(InputArray img) {
@@ -888,101 +1001,128 @@ namespace cv {
 
                 std::vector<Region> all_regions;
 
-                int image_id = 0;
+                // Initial segmentations of all the (image, graph segmentation) couples, the image_id of a couple is its index
+                std::vector<Segmentation> segs(images.size() * segmentations.size());
+                parallel_for_(Range(0, (int)segs.size()), SegmentationInvoker(this, segs));
 
-                for(std::vector<Mat>::iterator image = images.begin(); image != images.end(); ++image) {
-                    for(std::vector<Ptr<GraphSegmentation> >::iterator gs = segmentations.begin(); gs != segmentations.end(); ++gs) {
+                // Strategies keep their state between calls (histograms, caches), so a strategy runs on one thread at a time.
+                // Strategies shared between the list entries are run sequentially.
+                bool distinct = true;
+                for (size_t i = 0; i < strategies.size() && distinct; i++) {
+                    for (size_t j = i + 1; j < strategies.size() && distinct; j++) {
+                        distinct = strategies[i] != strategies[j];
+                    }
+                }
 
-                        Mat img_regions;
-                        Mat_<char> is_neighbour;
-                        Mat_<int> sizes;
+                std::vector<std::vector<Region> > results(segs.size() * strategies.size());
+                GroupingInvoker grouping(this, segs, results);
+                if (distinct) {
+                    parallel_for_(Range(0, (int)strategies.size()), grouping);
+                } else {
+                    grouping(Range(0, (int)strategies.size()));
+                }
 
-                        // Compute initial segmentation
-                        (*gs)->processImage(*image, img_regions);
+                for(std::vector<std::vector<Region> >::iterator regions = results.begin(); regions != results.end(); ++regions) {
+                    all_regions.insert(all_regions.end(), regions->begin(), regions->end());
+                }
 
-                        // Get number of regions
-                        double min, max;
-                        minMaxLoc(img_regions, &min, &max);
-                        int nb_segs = (int)max + 1;
+                std::sort(all_regions.begin(), all_regions.end());
 
-                        // Compute bouding rects and neighbours
-                        std::vector<Rect> bounding_rects;
-                        bounding_rects.resize(nb_segs);
+                std::map<Rect, char, rectComparator> processed_rect;
 
-                        std::vector<std::vector<cv::Point> > points;
+                rects.clear();
 
-                        points.resize(nb_segs);
+                // Remove duplicate in rect list
+                for(std::vector<Region>::iterator region = all_regions.begin(); region != all_regions.end(); ++region) {
+                    if (processed_rect.find((*region).bounding_box) == processed_rect.end()) {
+                        processed_rect[(*region).bounding_box] = true;
+                        rects.push_back((*region).bounding_box);
+                    }
+                }
 
-                        is_neighbour = Mat::zeros(nb_segs, nb_segs, CV_8UC1);
-                        sizes = Mat::zeros(nb_segs, 1, CV_32SC1);
+            }
 
-                        const int* previous_p = NULL;
+            void SelectiveSearchSegmentationImpl::segment(const Mat& img, Ptr<GraphSegmentation>& gs, Segmentation& seg) {
 
-                        for (int i = 0; i < (int)img_regions.rows; i++) {
-                            const int* p = img_regions.ptr<int>(i);
+                // Compute initial segmentation
+                gs->processImage(img, seg.img_regions);
 
-                            for (int j = 0; j < (int)img_regions.cols; j++) {
+                // Get number of regions
+                double min, max;
+                minMaxLoc(seg.img_regions, &min, &max);
+                int nb_segs = (int)max + 1;
+                seg.nb_segs = nb_segs;
 
-                                points[p[j]].push_back(cv::Point(j, i));
-                                sizes.at<int>(p[j], 0) = sizes.at<int>(p[j], 0) + 1;
+                // Compute bouding rects, sizes and neighbours
+                std::vector<Point> tl(nb_segs, Point(INT_MAX, INT_MAX)), br(nb_segs, Point(INT_MIN, INT_MIN));
+                std::vector<std::pair<int, int> > pairs;
 
-                                if (i > 0 && j > 0) {
+                seg.sizes = Mat::zeros(nb_segs, 1, CV_32SC1);
 
-                                    is_neighbour.at<char>(p[j], p[j - 1]) = 1;
-                                    is_neighbour.at<char>(p[j], previous_p[j]) = 1;
-                                    is_neighbour.at<char>(p[j], previous_p[j - 1]) = 1;
+                const int* previous_p = NULL;
 
-                                    is_neighbour.at<char>(p[j - 1], p[j]) = 1;
-                                    is_neighbour.at<char>(previous_p[j], p[j]) = 1;
-                                    is_neighbour.at<char>(previous_p[j - 1], p[j]) = 1;
-                                }
-                            }
-                            previous_p = p;
-                        }
+                for (int i = 0; i < (int)seg.img_regions.rows; i++) {
+                    const int* p = seg.img_regions.ptr<int>(i);
 
-                        for(int seg = 0; seg < nb_segs; seg++) {
-                            bounding_rects[seg] = cv::boundingRect(points[seg]);
-                        }
+                    for (int j = 0; j < (int)seg.img_regions.cols; j++) {
 
-                        for(std::vector<Ptr<SelectiveSearchSegmentationStrategy> >::iterator strategy = strategies.begin(); strategy != strategies.end(); ++strategy) {
-                            std::vector<Region> regions;
-                            hierarchicalGrouping(*image, *strategy, img_regions, is_neighbour, sizes, nb_segs, bounding_rects, regions, image_id);
+                        const int r = p[j];
+                        tl[r].x = std::min(tl[r].x, j);
+                        tl[r].y = std::min(tl[r].y, i);
+                        br[r].x = std::max(br[r].x, j);
+                        br[r].y = std::max(br[r].y, i);
+                        seg.sizes(r, 0)++;
 
-                            for(std::vector<Region>::iterator region = regions.begin(); region != regions.end(); ++region) {
-                                all_regions.push_back(*region);
+                        if (i > 0 && j > 0) {
+                            const int others[3] = { p[j - 1], previous_p[j], previous_p[j - 1] };
+                            for (int k = 0; k < 3; k++) {
+                                if (others[k] != r) {
+                                    pairs.push_back(std::make_pair(std::min(r, others[k]), std::max(r, others[k])));
+                                }
                             }
                         }
-
-                        image_id++;
                     }
+                    previous_p = p;
                 }
 
-                std::sort(all_regions.begin(), all_regions.end());
-
-                std::map<Rect, char, rectComparator> processed_rect;
+                seg.bounding_rects.resize(nb_segs);
+                for(int r = 0; r < nb_segs; r++) {
+                    seg.bounding_rects[r] = Rect(tl[r], br[r] + Point(1, 1));
+                }
 
-                rects.clear();
+                std::sort(pairs.begin(), pairs.end());
+                pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
 
-                // Remove duplicate in rect list
-                for(std::vector<Region>::iterator region = all_regions.begin(); region != all_regions.end(); ++region) {
-                    if (processed_rect.find((*region).bounding_box) == processed_rect.end()) {
-                        processed_rect[(*region).bounding_box] = true;
-                        rects.push_back((*region).bounding_box);
-                    }
+                seg.neighbours_start.assign(nb_segs + 1, 0);
+                seg.neighbours.resize(pairs.size());
+                for (size_t k = 0; k < pairs.size(); k++) {
+                    seg.neighbours_start[pairs[k].first + 1]++;
+                    seg.neighbours[k] = pairs[k].second;
+                }
+                for (int r = 0; r < nb_segs; r++) {
+                    seg.neighbours_start[r + 1] += seg.neighbours_start[r];
                 }
-
             }
 
-            void SelectiveSearchSegmentationImpl::hierarchicalGrouping(const Mat& img, Ptr<SelectiveSearchSegmentationStrategy>& s, const Mat& img_regions, const Mat_<char>& is_neighbour, const Mat_<int>& sizes_, int& nb_segs, const std::vector<Rect>& bounding_rects, std::vector<Region>& regions, int image_id) {
+            void SelectiveSearchSegmentationImpl::hierarchicalGrouping(const Mat& img, Ptr<SelectiveSearchSegmentationStrategy>& s, const Segmentation& seg, RNG& rng, std::vector<Region>& regions, int image_id) {
+
+                const int nb_segs = seg.nb_segs;
+                Mat sizes = seg.sizes.clone();
+
+                // Best similarity first. Entries of merged regions are left in the heap and skipped when they come up.
+                std::priority_queue<Neighbour> similarities;
 
-                Mat sizes = sizes_.clone();
+                // Neighbours of each region, merged regions included. All the regions of a grouping are allocated at once,
+                // they are nb_segs initial regions and at most nb_segs - 1 merges.
+                std::vector<std::vector<int> > neighbours(std::max(2 * nb_segs - 1, 0));
+                std::vector<int> visited(neighbours.size(), -1);
 
-                std::vector<Neighbour> similarities;
                 regions.clear();
+                regions.reserve(neighbours.size());
 
                 /////////////////////////////////////////
 
-                s->setImage(img, img_regions, sizes, image_id);
+                s->setImage(img, seg.img_regions, sizes, image_id);
 
                 // Compute initial similarities
                 for (int i = 0; i < nb_segs; i++) {
@@ -991,32 +1131,33 @@ namespace cv {
                     r.id = i;
                     r.level = 1;
                     r.merged_to = -1;
-                    r.bounding_box = bounding_rects[i];
+                    r.bounding_box = seg.bounding_rects[i];
 
                     regions.push_back(r);
 
-                    for (int j = i + 1; j < nb_segs; j++) {
-                        if (is_neighbour.at<char>(i, j)) {
-                            Neighbour n;
-                            n.from = i;
-                            n.to = j;
-                            n.similarity = s->get(i, j);
+                    for (int k = seg.neighbours_start[i]; k < seg.neighbours_start[i + 1]; k++) {
+                        const int j = seg.neighbours[k];
 
-                            similarities.push_back(n);
-                        }
+                        Neighbour n;
+                        n.from = i;
+                        n.to = j;
+                        n.similarity = s->get(i, j);
+
+                        similarities.push(n);
+
+                        neighbours[i].push_back(j);
+                        neighbours[j].push_back(i);
                     }
                 }
 
-                while(similarities.size() > 0) {
+                while(!similarities.empty()) {
 
-                    std::sort(similarities.begin(), similarities.end());
+                    Neighbour p = similarities.top();
+                    similarities.pop();
 
-                    // for(std::vector<Neighbour>::iterator similarity = similarities.begin(); similarity != similarities.end(); ++similarity) {
-                    //     std::cout << *similarity << std::endl;
-                    // }
-
-                    Neighbour p = similarities.back();
-                    similarities.pop_back();
+                    if (regions[p.from].merged_to != -1 || regions[p.to].merged_to != -1) {
+                        continue;
+                    }
 
                     Region region_from = regions[p.from];
                     Region region_to = regions[p.to];
@@ -1029,8 +1170,10 @@ namespace cv {
 
                     regions.push_back(new_r);
 
-                    regions[p.from].merged_to = (int)regions.size() - 1;
-                    regions[p.to].merged_to = (int)regions.size() - 1;
+                    const int new_id = (int)regions.size() - 1;
+
+                    regions[p.from].merged_to = new_id;
+                    regions[p.to].merged_to = new_id;
 
                     // Merge
                     s->merge(region_from.id, region_to.id);
@@ -1039,51 +1182,38 @@ namespace cv {
                     sizes.at<int>(region_from.id, 0) += sizes.at<int>(region_to.id, 0);
                     sizes.at<int>(region_to.id, 0) = sizes.at<int>(region_from.id, 0);
 
-                    std::vector<int> local_neighbours;
-
-                    for(std::vector<Neighbour>::iterator similarity = similarities.begin(); similarity != similarities.end();) {
-                        if ((*similarity).from == p.from || (*similarity).to == p.from || (*similarity).from == p.to || (*similarity).to == p.to) {
-                            int from = 0;
+                    // The neighbours of the new region are the regions still alive around the two merged ones
+                    std::vector<int>& local_neighbours = neighbours[new_id];
+                    const int merged[2] = { p.from, p.to };
 
-                            if ((*similarity).from == p.from || (*similarity).from == p.to) {
-                                from = (*similarity).to;
-                            } else {
-                                from = (*similarity).from;
+                    for (int m = 0; m < 2; m++) {
+                        std::vector<int>& around = neighbours[merged[m]];
+                        for (std::vector<int>::iterator local_neighbour = around.begin(); local_neighbour != around.end(); local_neighbour++) {
+                            if (regions[*local_neighbour].merged_to == -1 && visited[*local_neighbour] != new_id) {
+                                visited[*local_neighbour] = new_id;
+                                local_neighbours.push_back(*local_neighbour);
                             }
-
-                            bool already_neighboor = false;
-
-                            for(std::vector<int>::iterator local_neighbour = local_neighbours.begin(); local_neighbour != local_neighbours.end(); local_neighbour++) {
-                                if (*local_neighbour == from) {
-                                    already_neighboor = true;
-                                }
-                            }
-
-                            if (!already_neighboor) {
-                                local_neighbours.push_back(from);
-                            }
-
-                            similarity = similarities.erase(similarity);
-                        } else {
-                            similarity++;
                         }
+                        std::vector<int>().swap(around);
                     }
 
                     for(std::vector<int>::iterator local_neighbour = local_neighbours.begin(); local_neighbour != local_neighbours.end(); local_neighbour++) {
 
                         Neighbour n;
-                        n.from = (int)regions.size() - 1;
+                        n.from = new_id;
                         n.to = *local_neighbour;
                         n.similarity = s->get(regions[n.from].id, regions[n.to].id);
 
-                        similarities.push_back(n);
+                        similarities.push(n);
+
+                        neighbours[n.to].push_back(new_id);
                     }
                 }
 
                 // Compute regions' rank
                 for(std::vector<Region>::iterator region = regions.begin(); region != regions.end(); ++region) {
                     // Note: this is inverted from the paper, but we keep the lover region first so it's works
-                    (*region).rank = ((double) rand() / (RAND_MAX)) * ((*region).level);
+                    (*region).rank = rng.uniform(0., 1.) * ((*region).level);
                 }
 
             }
@@ -66,6 +66,34 @@ using namespace std;
 namespace cv {
 namespace ximgproc {
 
+/*
+ * SeedWindows
+ *
+ * Search windows of all seeds and, for every band
+ * of rows, the seeds whose window intersects it,
+ * in increasing order. Growing over rows then
+ * visits every pixel by the seeds in the same
+ * order as a loop over the seeds does.
+ */
+struct SeedWindows
+{
+    vector<int> x1, x2, y1, y2;
+    vector< vector<int> > bands;
+    int band_height;
+
+    inline void build( int height, int _band_height )
+    {
+        band_height = max(_band_height, 1);
+        bands.assign( (height + band_height - 1) / band_height, vector<int>() );
+        for( int n = 0; n < (int)y1.size(); n++ )
+        {
+            if( y1[n] >= y2[n] || x1[n] >= x2[n] ) continue;
+            for( int b = y1[n] / band_height; b <= (y2[n] - 1) / band_height; b++ )
+              bands[b].push_back(n);
+        }
+    }
+};
+
 class SuperpixelSLICImpl : public SuperpixelSLIC
 {
 public:
@@ -77,6 +105,9 @@ public:
     // perform amount of iteration
     virtual void iterate( int num_iterations = 10 ) CV_OVERRIDE;
 
+    // continue from current centers on next frame
+    virtual void updateImage( InputArray image, InputArray flow = noArray() ) CV_OVERRIDE;
+
     // get amount of superpixels
     virtual int getNumberOfSuperpixels() const CV_OVERRIDE;
 
@@ -174,6 +205,9 @@ private:
     // MSLIC
     inline void PerformMSLIC( const int& num_iterations );
 
+    // search windows of seeds
+    inline void GetSeedWindows( SeedWindows& windows, bool adaptive ) const;
+
     // MSLIC
     inline void SuperpixelSplit();
 
@@ -296,6 +330,69 @@ void SuperpixelSLICImpl::iterate( int num_iterations )
     m_numlabels = (int)m_kseeds[0].size();
 }
 
+void SuperpixelSLICImpl::updateImage( InputArray _image, InputArray _flow )
+{
+    vector<Mat> chvec;
+    if ( _image.isMat() )
+    {
+      Mat image = _image.getMat();
+      CV_Assert( !image.empty() );
+      split( image, chvec );
+    }
+    else if ( _image.isMatVector() )
+      _image.getMatVector( chvec );
+    else
+      CV_Error( Error::StsInternal, "Invalid InputArray." );
+
+    // frames should be alike
+    CV_Assert( (int) chvec.size() == m_nr_channels );
+    CV_Assert( chvec[0].size() == Size( m_width, m_height ) );
+    CV_Assert( chvec[0].depth() == m_chvec[0].depth() );
+    m_chvec = chvec;
+
+    // move centers along the motion
+    if ( !_flow.empty() )
+    {
+      Mat flow = _flow.getMat();
+      CV_Assert( flow.type() == CV_32FC2 && flow.size() == Size( m_width, m_height ) );
+      for( size_t n = 0; n < m_kseedsx.size(); n++ )
+      {
+        int x = min( max( cvRound(m_kseedsx[n]), 0 ), m_width - 1 );
+        int y = min( max( cvRound(m_kseedsy[n]), 0 ), m_height - 1 );
+        const Point2f& d = flow.at<Point2f>(y,x);
+        m_kseedsx[n] = min( max( m_kseedsx[n] + d.x, 0.0f ), (float)(m_width - 1) );
+        m_kseedsy[n] = min( max( m_kseedsy[n] + d.y, 0.0f ), (float)(m_height - 1) );
+      }
+    }
+
+    // labels may be relabeled by connectivity,
+    // start from the same state as a new grid
+    m_klabels.setTo( Scalar::all(0) );
+    m_numlabels = (int)m_kseeds[0].size();
+
+    if( m_algorithm == MSLIC )
+      m_adaptk.resize( m_numlabels, 1.0f );
+}
+
+inline void SuperpixelSLICImpl::GetSeedWindows( SeedWindows& windows, bool adaptive ) const
+{
+    windows.x1.resize( m_numlabels ); windows.x2.resize( m_numlabels );
+    windows.y1.resize( m_numlabels ); windows.y2.resize( m_numlabels );
+
+    int maxoffset = m_region_size;
+    for( int n = 0; n < m_numlabels; n++ )
+    {
+        int offset = adaptive ? int(m_region_size * m_adaptk[n]) : m_region_size;
+        maxoffset = max( maxoffset, offset );
+
+        windows.y1[n] = max(0,        (int) m_kseedsy[n] - offset);
+        windows.y2[n] = min(m_height, (int) m_kseedsy[n] + offset);
+        windows.x1[n] = max(0,        (int) m_kseedsx[n] - offset);
+        windows.x2[n] = min(m_width,  (int) m_kseedsx[n] + offset);
+    }
+    windows.build( m_height, maxoffset );
+}
+
 void SuperpixelSLICImpl::getLabels(OutputArray labels_out) const
 {
     labels_out.assign( m_klabels );
@@ -999,22 +1096,20 @@ struct SeedsCenters
 struct SLICOGrowInvoker : ParallelLoopBody
 {
     SLICOGrowInvoker( vector<Mat>* _chvec, Mat* _distchans, Mat* _distxy, Mat* _distvec,
-                      Mat* _klabels, float _kseedsxn, float _kseedsyn, float _xywt,
-                      float _maxchansn, vector< vector<float> > *_kseeds,
-                      int _x1, int _x2, int _nr_channels, int _n )
+                      Mat* _klabels, const vector<float>* _kseedsx, const vector<float>* _kseedsy,
+                      float _xywt, const vector<float>* _maxchans, vector< vector<float> > *_kseeds,
+                      const SeedWindows* _windows, int _nr_channels )
     {
       chvec = _chvec;
       distchans = _distchans;
       distxy = _distxy;
       distvec = _distvec;
-      kseedsxn = _kseedsxn;
-      kseedsyn = _kseedsyn;
+      kseedsx = _kseedsx;
+      kseedsy = _kseedsy;
       klabels = _klabels;
-      maxchansn = _maxchansn;
+      maxchans = _maxchans;
       kseeds = _kseeds;
-      x1 = _x1;
-      x2 = _x2;
-      n = _n;
+      windows = _windows;
       xywt = _xywt;
       nr_channels = _nr_channels;
     }
@@ -1025,7 +1120,16 @@ struct SLICOGrowInvoker : ParallelLoopBody
       int rows = klabels->rows;
       for (int y = range.start; y < range.end; ++y)
       {
-        for( int x = x1; x < x2; x++ )
+       const vector<int>& band = windows->bands[y / windows->band_height];
+       for( size_t k = 0; k < band.size(); k++ )
+       {
+        const int n = band[k];
+        if( y < windows->y1[n] || y >= windows->y2[n] ) continue;
+
+        const float kseedsxn = kseedsx->at(n);
+        const float kseedsyn = kseedsy->at(n);
+        const float maxchansn = maxchans->at(n);
+        for( int x = windows->x1[n]; x < windows->x2[n]; x++ )
         {
           CV_Assert( y < rows && x < cols && y >= 0 && x >= 0 );
           distchans->at<float>(y,x) = 0;
@@ -1115,16 +1219,19 @@ struct SLICOGrowInvoker : ParallelLoopBody
             klabels->at<int>(y,x) = n;
           }
         } // end for x
+       } // end for seeds
       } // end for y
     }
 
     Mat* klabels;
     vector< vector<float> > *kseeds;
-    float maxchansn, xywt;
+    const vector<float> *maxchans;
+    float xywt;
     vector<Mat>* chvec;
     Mat *distchans, *distxy, *distvec;
-    float kseedsxn, kseedsyn;
-    int x1, x2, nr_channels, n;
+    const vector<float> *kseedsx, *kseedsy;
+    const SeedWindows* windows;
+    int nr_channels;
 };
 
 /*
@@ -1161,17 +1268,12 @@ inline void SuperpixelSLICImpl::PerformSLICO( const int&  itrnum )
     for( int itr = 0; itr < itrnum; itr++ )
     {
         distvec.setTo(FLT_MAX);
-        for( int n = 0; n < m_numlabels; n++ )
-        {
-            int y1 = max(0, (int) m_kseedsy[n] - m_region_size);
-            int y2 = min(m_height, (int) m_kseedsy[n] + m_region_size);
-            int x1 = max(0, (int) m_kseedsx[n] - m_region_size);
-            int x2 = min((int) m_width,(int) m_kseedsx[n] + m_region_size);
-
-            parallel_for_( Range(y1, y2), SLICOGrowInvoker( &m_chvec, &distchans, &distxy, &distvec,
-                           &m_klabels, m_kseedsx[n], m_kseedsy[n], xywt, maxchans[n], &m_kseeds,
-                           x1, x2, m_nr_channels, n ) );
-        }
+
+        SeedWindows windows;
+        GetSeedWindows( windows, false );
+        parallel_for_( Range(0, m_height), SLICOGrowInvoker( &m_chvec, &distchans, &distxy, &distvec,
+                       &m_klabels, &m_kseedsx, &m_kseedsy, xywt, &maxchans, &m_kseeds,
+                       &windows, m_nr_channels ) );
         //-----------------------------------------------------------------
         // Assign the max color distance for a cluster
         //-----------------------------------------------------------------
@@ -1214,19 +1316,17 @@ inline void SuperpixelSLICImpl::PerformSLICO( const int&  itrnum )
 struct SLICGrowInvoker : ParallelLoopBody
 {
     SLICGrowInvoker( vector<Mat>* _chvec, Mat* _distvec, Mat* _klabels,
-                     float _kseedsxn, float _kseedsyn, float _xywt,
-                     vector< vector<float> > *_kseeds, int _x1, int _x2,
-                     int _nr_channels, int _n )
+                     const vector<float>* _kseedsx, const vector<float>* _kseedsy, float _xywt,
+                     vector< vector<float> > *_kseeds, const SeedWindows* _windows,
+                     int _nr_channels )
     {
       chvec = _chvec;
       distvec = _distvec;
-      kseedsxn = _kseedsxn;
-      kseedsyn = _kseedsyn;
+      kseedsx = _kseedsx;
+      kseedsy = _kseedsy;
       klabels = _klabels;
       kseeds = _kseeds;
-      x1 = _x1;
-      x2 = _x2;
-      n = _n;
+      windows = _windows;
       xywt = _xywt;
       nr_channels = _nr_channels;
     }
@@ -1235,7 +1335,15 @@ struct SLICGrowInvoker : ParallelLoopBody
     {
       for (int y = range.start; y < range.end; ++y)
       {
-        for( int x = x1; x < x2; x++ )
+       const vector<int>& band = windows->bands[y / windows->band_height];
+       for( size_t k = 0; k < band.size(); k++ )
+       {
+        const int n = band[k];
+        if( y < windows->y1[n] || y >= windows->y2[n] ) continue;
+
+        const float kseedsxn = kseedsx->at(n);
+        const float kseedsyn = kseedsy->at(n);
+        for( int x = windows->x1[n]; x < windows->x2[n]; x++ )
         {
           float dist = 0;
 
@@ -1317,6 +1425,7 @@ struct SLICGrowInvoker : ParallelLoopBody
             klabels->at<int>(y,x) = n;
           }
         } //end for x
+       } // end for seeds
       } // end for y
     }
 
@@ -1325,8 +1434,9 @@ struct SLICGrowInvoker : ParallelLoopBody
     float xywt;
     vector<Mat>* chvec;
     Mat *distvec;
-    float kseedsxn, kseedsyn;
-    int x1, x2, nr_channels, n;
+    const vector<float> *kseedsx, *kseedsy;
+    const SeedWindows* windows;
+    int nr_channels;
 };
 
 /*
@@ -1345,17 +1455,12 @@ inline void SuperpixelSLICImpl::PerformSLIC( const int&  itrnum )
     for( int itr = 0; itr < itrnum; itr++ )
     {
         distvec.setTo(FLT_MAX);
-        for( int n = 0; n < m_numlabels; n++ )
-        {
-            int y1 = max(0, (int) m_kseedsy[n] - m_region_size);
-            int y2 = min(m_height, (int) m_kseedsy[n] + m_region_size);
-            int x1 = max(0, (int) m_kseedsx[n] - m_region_size);
-            int x2 = min((int) m_width,(int) m_kseedsx[n] + m_region_size);
-
-            parallel_for_( Range(y1, y2), SLICGrowInvoker( &m_chvec, &distvec,
-                           &m_klabels, m_kseedsx[n], m_kseedsy[n], xywt, &m_kseeds,
-                           x1, x2, m_nr_channels, n ) );
-        }
+
+        SeedWindows windows;
+        GetSeedWindows( windows, false );
+        parallel_for_( Range(0, m_height), SLICGrowInvoker( &m_chvec, &distvec,
+                       &m_klabels, &m_kseedsx, &m_kseedsy, xywt, &m_kseeds,
+                       &windows, m_nr_channels ) );
 
         //-----------------------------------------------------------------
         // Recalculate the centroid and store in the seed values
@@ -1390,8 +1495,6 @@ inline void SuperpixelSLICImpl::PerformMSLIC( const int&  itrnum )
 
     const float xywt = (m_region_size/m_ruler)*(m_region_size/m_ruler);
 
-    int offset = m_region_size;
-
     // from paper
     m_split = 4.0f;
     m_ratio = 5.0f;
@@ -1401,22 +1504,12 @@ inline void SuperpixelSLICImpl::PerformMSLIC( const int&  itrnum )
         m_cur_iter = itr;
 
         distvec.setTo(FLT_MAX);
-        for( int n = 0; n < m_numlabels; n++ )
-        {
-            if ( m_adaptk[n] < 1.0f )
-                offset = int(m_region_size * m_adaptk[n]);
-            else
-                offset = int(m_region_size * m_adaptk[n]);
-
-            int y1 = max(0,        (int) m_kseedsy[n] - offset);
-            int y2 = min(m_height, (int) m_kseedsy[n] + offset);
-            int x1 = max(0,        (int) m_kseedsx[n] - offset);
-            int x2 = min(m_width,  (int) m_kseedsx[n] + offset);
 
-            parallel_for_( Range(y1, y2), SLICGrowInvoker( &m_chvec, &distvec,
-                           &m_klabels, m_kseedsx[n], m_kseedsy[n], xywt, &m_kseeds,
-                           x1, x2, m_nr_channels, n ) );
-        }
+        SeedWindows windows;
+        GetSeedWindows( windows, true );
+        parallel_for_( Range(0, m_height), SLICGrowInvoker( &m_chvec, &distvec,
+                       &m_klabels, &m_kseedsx, &m_kseedsy, xywt, &m_kseeds,
+                       &windows, m_nr_channels ) );
 
         //-----------------------------------------------------------------
         // Recalculate the centroid and store in the seed values
@@ -59,6 +59,8 @@ struct SparseMatch
 bool operator<(const SparseMatch& lhs,const SparseMatch& rhs);
 
 static void computeGradientMagnitude(Mat& src, Mat& dst);
+static void geodesicDistanceTransformTiled(Mat& distances, Mat& labels, const Mat& cost_map, int num_iter);
+static bool isSameReferenceImage(const Mat& src, const Mat& ref);
 static void weightedLeastSquaresAffineFit(int* labels, float* weights, int count, float lambda, const SparseMatch* matches, Mat& dst);
 static void generateHypothesis(int* labels, int count, RNG& rng, unsigned char* is_used, SparseMatch* matches, Mat& dst);
 static void verifyHypothesis(int* labels, float* weights, int count, SparseMatch* matches, float eps, float lambda, Mat& hypothesis_transform, Mat& old_transform, float& old_weighted_num_inliers);
@@ -88,6 +90,9 @@ protected:
     Mat NNdistances;
     Mat labels;
     Mat costMap;
+    // reference image of the previous call and its gradient magnitude, reused while the image is the same:
+    Mat refImage;
+    Mat refGradient;
     //tunable parameters:
     float lambda;
     int k;
@@ -241,8 +246,13 @@ void EdgeAwareInterpolatorImpl::preprocessData(Mat& src, vector<SparseMatch>& ma
 
     if (costMap.empty())
     {
-        costMap.create(h, w, CV_32FC1);
-        computeGradientMagnitude(src, costMap);
+        if (!isSameReferenceImage(src, refImage))
+        {
+            src.copyTo(refImage);
+            refGradient.create(h, w, CV_32FC1);
+            computeGradientMagnitude(src, refGradient);
+        }
+        refGradient.copyTo(costMap);
     }
     else
         CV_Assert(costMap.cols == w && costMap.rows == h);
@@ -254,94 +264,7 @@ void EdgeAwareInterpolatorImpl::preprocessData(Mat& src, vector<SparseMatch>& ma
 
 void EdgeAwareInterpolatorImpl::geodesicDistanceTransform(Mat& distances, Mat& cost_map)
 {
-    float c1 = 1.0f / 2.0f;
-    float c2 = sqrt(2.0f) / 2.0f;
-    float d = 0.0f;
-    int i, j;
-    float *dist_row, *cost_row;
-    float *dist_row_prev, *cost_row_prev;
-    int *label_row;
-    int *label_row_prev;
-
-#define CHECK(cur_dist,cur_label,cur_cost,prev_dist,prev_label,prev_cost,coef)\
-{\
-    d = prev_dist + coef*(cur_cost+prev_cost);\
-    if(cur_dist>d){\
-        cur_dist=d;\
-        cur_label = prev_label;}\
-}
-
-    for (int it = 0; it < distance_transform_num_iter; it++)
-    {
-        //first pass (left-to-right, top-to-bottom):
-        dist_row = distances.ptr<float>(0);
-        label_row = labels.ptr<int>(0);
-        cost_row = cost_map.ptr<float>(0);
-        for (j = 1; j < w; j++)
-            CHECK(dist_row[j], label_row[j], cost_row[j], dist_row[j - 1], label_row[j - 1], cost_row[j - 1], c1);
-
-        for (i = 1; i < h; i++)
-        {
-            dist_row = distances.ptr<float>(i);
-            dist_row_prev = distances.ptr<float>(i - 1);
-
-            label_row = labels.ptr<int>(i);
-            label_row_prev = labels.ptr<int>(i - 1);
-
-            cost_row = cost_map.ptr<float>(i);
-            cost_row_prev = cost_map.ptr<float>(i - 1);
-
-            j = 0;
-            CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
-            CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j + 1], label_row_prev[j + 1], cost_row_prev[j + 1], c2);
-            j++;
-            for (; j < w - 1; j++)
-            {
-                CHECK(dist_row[j], label_row[j], cost_row[j], dist_row[j - 1], label_row[j - 1], cost_row[j - 1], c1);
-                CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j - 1], label_row_prev[j - 1], cost_row_prev[j - 1], c2);
-                CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
-                CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j + 1], label_row_prev[j + 1], cost_row_prev[j + 1], c2);
-            }
-            CHECK(dist_row[j], label_row[j], cost_row[j], dist_row[j - 1], label_row[j - 1], cost_row[j - 1], c1);
-            CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j - 1], label_row_prev[j - 1], cost_row_prev[j - 1], c2);
-            CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
-        }
-
-        //second pass (right-to-left, bottom-to-top):
-        dist_row = distances.ptr<float>(h - 1);
-        label_row = labels.ptr<int>(h - 1);
-        cost_row = cost_map.ptr<float>(h - 1);
-        for (j = w - 2; j >= 0; j--)
-            CHECK(dist_row[j], label_row[j], cost_row[j], dist_row[j + 1], label_row[j + 1], cost_row[j + 1], c1);
-
-        for (i = h - 2; i >= 0; i--)
-        {
-            dist_row = distances.ptr<float>(i);
-            dist_row_prev = distances.ptr<float>(i + 1);
-
-            label_row = labels.ptr<int>(i);
-            label_row_prev = labels.ptr<int>(i + 1);
-
-            cost_row = cost_map.ptr<float>(i);
-            cost_row_prev = cost_map.ptr<float>(i + 1);
-
-            j = w - 1;
-            CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
-            CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j - 1], label_row_prev[j - 1], cost_row_prev[j - 1], c2);
-            j--;
-            for (; j > 0; j--)
-            {
-                CHECK(dist_row[j], label_row[j], cost_row[j], dist_row[j + 1], label_row[j + 1], cost_row[j + 1], c1);
-                CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j + 1], label_row_prev[j + 1], cost_row_prev[j + 1], c2);
-                CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
-                CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j - 1], label_row_prev[j - 1], cost_row_prev[j - 1], c2);
-            }
-            CHECK(dist_row[j], label_row[j], cost_row[j], dist_row[j + 1], label_row[j + 1], cost_row[j + 1], c1);
-            CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j + 1], label_row_prev[j + 1], cost_row_prev[j + 1], c2);
-            CHECK(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
-        }
-    }
-#undef CHECK
+    geodesicDistanceTransformTiled(distances, labels, cost_map, distance_transform_num_iter);
 }
 
 void EdgeAwareInterpolatorImpl::buildGraph(Mat& distances, Mat& cost_map)
@@ -748,6 +671,161 @@ static void computeGradientMagnitude(Mat& src, Mat& dst)
     }
 }
 
+static inline void geodesicCheck(float& cur_dist, int& cur_label, float cur_cost, float prev_dist, int prev_label, float prev_cost, float coef)
+{
+    float d = prev_dist + coef*(cur_cost+prev_cost);
+    if (cur_dist > d)
+    {
+        cur_dist = d;
+        cur_label = prev_label;
+    }
+}
+
+// columns [j0,j1) of the row i in the forward (left-to-right, top-to-bottom) pass
+static void geodesicForwardRow(Mat& distances, Mat& labels, const Mat& cost_map, int i, int j0, int j1)
+{
+    const float c1 = 1.0f / 2.0f;
+    const float c2 = sqrt(2.0f) / 2.0f;
+    int w = distances.cols;
+    float* dist_row = distances.ptr<float>(i);
+    int* label_row = labels.ptr<int>(i);
+    const float* cost_row = cost_map.ptr<float>(i);
+    int j = j0;
+
+    if (i == 0)
+    {
+        for (j = std::max(j0, 1); j < j1; j++)
+            geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row[j - 1], label_row[j - 1], cost_row[j - 1], c1);
+        return;
+    }
+
+    const float* dist_row_prev = distances.ptr<float>(i - 1);
+    const int* label_row_prev = labels.ptr<int>(i - 1);
+    const float* cost_row_prev = cost_map.ptr<float>(i - 1);
+
+    if (j == 0 && j < j1)
+    {
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
+        if (w > 1)
+            geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j + 1], label_row_prev[j + 1], cost_row_prev[j + 1], c2);
+        j++;
+    }
+    for (int jend = std::min(j1, w - 1); j < jend; j++)
+    {
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row[j - 1], label_row[j - 1], cost_row[j - 1], c1);
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j - 1], label_row_prev[j - 1], cost_row_prev[j - 1], c2);
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j + 1], label_row_prev[j + 1], cost_row_prev[j + 1], c2);
+    }
+    if (j < j1)
+    {
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row[j - 1], label_row[j - 1], cost_row[j - 1], c1);
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j - 1], label_row_prev[j - 1], cost_row_prev[j - 1], c2);
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
+    }
+}
+
+// columns [j0,j1) of the row i in the backward (right-to-left, bottom-to-top) pass
+static void geodesicBackwardRow(Mat& distances, Mat& labels, const Mat& cost_map, int i, int j0, int j1)
+{
+    const float c1 = 1.0f / 2.0f;
+    const float c2 = sqrt(2.0f) / 2.0f;
+    int w = distances.cols;
+    float* dist_row = distances.ptr<float>(i);
+    int* label_row = labels.ptr<int>(i);
+    const float* cost_row = cost_map.ptr<float>(i);
+    int j = j1 - 1;
+
+    if (i == distances.rows - 1)
+    {
+        for (j = std::min(j1, w - 1) - 1; j >= j0; j--)
+            geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row[j + 1], label_row[j + 1], cost_row[j + 1], c1);
+        return;
+    }
+
+    const float* dist_row_prev = distances.ptr<float>(i + 1);
+    const int* label_row_prev = labels.ptr<int>(i + 1);
+    const float* cost_row_prev = cost_map.ptr<float>(i + 1);
+
+    if (j == w - 1 && j >= j0)
+    {
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
+        if (w > 1)
+            geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j - 1], label_row_prev[j - 1], cost_row_prev[j - 1], c2);
+        j--;
+    }
+    for (int jend = std::max(j0, 1); j >= jend; j--)
+    {
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row[j + 1], label_row[j + 1], cost_row[j + 1], c1);
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j + 1], label_row_prev[j + 1], cost_row_prev[j + 1], c2);
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j - 1], label_row_prev[j - 1], cost_row_prev[j - 1], c2);
+    }
+    if (j >= j0)
+    {
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row[j + 1], label_row[j + 1], cost_row[j + 1], c1);
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j + 1], label_row_prev[j + 1], cost_row_prev[j + 1], c2);
+        geodesicCheck(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
+    }
+}
+
+/* Two-pass geodesic distance transform with label propagation.
+ * The image is cut into bands of tileRows rows and every band into parallelograms
+ * whose left edge moves one pixel left per row, so a tile depends only on its left neighbor
+ * and on the tiles tx and tx+1 of the previous band. Tiles with equal 2*ty+tx are independent
+ * and are processed in parallel wave by wave; every pixel sees exactly the same neighbor
+ * values as in the plain raster sweep, so the result does not depend on the number of threads.
+ */
+static void geodesicDistanceTransformTiled(Mat& distances, Mat& labels, const Mat& cost_map, int num_iter)
+{
+    const int tileRows = 16;
+    const int tileCols = 64; // must not be less than tileRows
+    int h = distances.rows, w = distances.cols;
+    int tilesY = (h + tileRows - 1) / tileRows;
+    int tilesX = (w + tileRows - 2) / tileCols + 1;
+    int numWaves = 2 * (tilesY - 1) + tilesX;
+
+    for (int it = 0; it < num_iter; it++)
+    {
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (int wave = 0; wave < numWaves; wave++)
+            {
+                int tyStart = std::max(0, (wave - tilesX + 2) / 2);
+                int tyEnd = std::min(tilesY, wave / 2 + 1);
+                if (tyStart >= tyEnd)
+                    continue;
+                parallel_for_(Range(tyStart, tyEnd), [&](const Range& range)
+                {
+                    for (int ty = range.start; ty < range.end; ty++)
+                    {
+                        int tx = wave - 2 * ty;
+                        int rEnd = std::min(tileRows, h - ty * tileRows);
+                        for (int r = 0; r < rEnd; r++)
+                        {
+                            int j0 = std::max(tx * tileCols - r, 0);
+                            int j1 = std::min((tx + 1) * tileCols - r, w);
+                            if (j0 >= j1)
+                                continue;
+                            if (pass == 0)
+                                geodesicForwardRow(distances, labels, cost_map, ty * tileRows + r, j0, j1);
+                            else
+                                geodesicBackwardRow(distances, labels, cost_map, h - 1 - (ty * tileRows + r), w - j1, w - j0);
+                        }
+                    }
+                }, tyEnd - tyStart);
+            }
+        }
+    }
+}
+
+static bool isSameReferenceImage(const Mat& src, const Mat& ref)
+{
+    if (ref.empty() || src.size() != ref.size() || src.type() != ref.type())
+        return false;
+    return norm(src, ref, NORM_INF) == 0;
+}
+
 EdgeAwareInterpolatorImpl::RansacInterpolation_ParBody::RansacInterpolation_ParBody(EdgeAwareInterpolatorImpl& _inst, Mat* _transforms, float* _weighted_inlier_nums, float* _eps, SparseMatch* _matches, int _num_stripes, int _inc):
 inst(&_inst), transforms(_transforms), weighted_inlier_nums(_weighted_inlier_nums), eps(_eps), matches(_matches), num_stripes(_num_stripes), inc(_inc)
 {
@@ -869,18 +947,19 @@ void EdgeAwareInterpolatorImpl::ransacInterpolation(vector<SparseMatch>& matches
     parallel_for_(Range(0,ransac_num_stripes),RansacInterpolation_ParBody(*this,transforms,weighted_inlier_nums,eps,&matches.front(),ransac_num_stripes,-1));
 
     //construct the final piecewise-affine interpolation:
-    int* label_row;
-    float* tr;
-    for(int i=0;i<h;i++)
+    parallel_for_(Range(0,h),[&](const Range& range)
     {
-        label_row = labels.ptr<int>(i);
-        Point2f* dst_row = dst_dense_flow.ptr<Point2f>(i);
-        for(int j=0;j<w;j++)
+        for(int i=range.start;i<range.end;i++)
         {
-            tr = transforms[label_row[j]].ptr<float>(0);
-            dst_row[j] = Point2f(tr[0]*j+tr[1]*i+tr[2],tr[3]*j+tr[4]*i+tr[5]) - Point2f((float)j,(float)i);
+            const int* label_row = labels.ptr<int>(i);
+            Point2f* dst_row = dst_dense_flow.ptr<Point2f>(i);
+            for(int j=0;j<w;j++)
+            {
+                const float* tr = transforms[label_row[j]].ptr<float>(0);
+                dst_row[j] = Point2f(tr[0]*j+tr[1]*i+tr[2],tr[3]*j+tr[4]*i+tr[5]) - Point2f((float)j,(float)i);
+            }
         }
-    }
+    });
 
     delete[] transforms;
     delete[] weighted_inlier_nums;
@@ -918,6 +997,20 @@ protected:
     static const int distance_transform_num_iter = 1;
     float lambda;
 
+    // reference image of the previous call and the data which depends only on it:
+    Mat refImage;
+    Mat refGradient;
+    Mat refSpLabels;
+    Mat refSpNN;
+    Mat refSpPos;
+    Mat refSpItems;
+    int refSpCnt;
+    // superpixel parameters refSp* were computed with:
+    int refSpSize;
+    float refSpRuler;
+    SLICType refSlicType;
+    int refSpMaxNeighbors;
+
     //tunable parameters:
     int max_neighbors;
     float alpha;
@@ -1007,6 +1100,11 @@ void RICInterpolatorImpl::init()
     fgs_sigma = 1.5f;
     slic_type = SLIC;
     costMap = Mat();
+    refSpCnt = 0;
+    refSpSize = 0;
+    refSpRuler = 0.f;
+    refSlicType = SLIC;
+    refSpMaxNeighbors = 0;
 }
 
 struct MinHeap
@@ -1153,10 +1251,21 @@ void RICInterpolatorImpl::interpolate(InputArray from_image, InputArray from_poi
     Mat matDistanceMap(src_size, CV_32FC1);
     matDistanceMap.setTo(1e10);
 
+    if (!isSameReferenceImage(src, refImage))
+    {
+        src.copyTo(refImage);
+        refGradient.release();
+        refSpLabels.release();
+    }
+
     if (costMap.empty())
     {
-        costMap.create(src_size, CV_32FC1);
-        computeGradientMagnitude(src, costMap);
+        if (refGradient.empty())
+        {
+            refGradient.create(src_size, CV_32FC1);
+            computeGradientMagnitude(src, refGradient);
+        }
+        refGradient.copyTo(costMap);
     }
     else
         CV_Assert(costMap.rows == src.rows && costMap.cols == src.cols );
@@ -1215,14 +1324,23 @@ void RICInterpolatorImpl::interpolate(InputArray from_image, InputArray from_poi
         }
     });
 
-    Mat spLabels;
-    Mat spNN;
-    Mat spPos;
-    Mat spItems;
+    // the superpixels depend only on the reference image and are kept for the next call
+    if (refSpLabels.empty() || refSpSize != sp_size || refSpRuler != sp_ruler ||
+        refSlicType != slic_type || refSpMaxNeighbors != max_neighbors)
+    {
+        refSpCnt = overSegmentaion(src, refSpLabels, sp_size);
+        superpixelNeighborConstruction(refSpLabels, refSpCnt, refSpNN);
+        superpixelLayoutAnalysis(refSpLabels, refSpCnt, refSpPos, refSpItems);
+        refSpSize = sp_size;
+        refSpRuler = sp_ruler;
+        refSlicType = slic_type;
+        refSpMaxNeighbors = max_neighbors;
+    }
 
-    int spCnt = overSegmentaion(src, spLabels, sp_size);
-    superpixelNeighborConstruction(spLabels, spCnt, spNN);
-    superpixelLayoutAnalysis(spLabels, spCnt, spPos, spItems);
+    int spCnt = refSpCnt;
+    Mat& spNN = refSpNN;
+    Mat& spPos = refSpPos;
+    Mat& spItems = refSpItems;
 
     vector<int> srcMatchIds(spCnt);
     for (int i = 0; i < spCnt; i++)
@@ -1265,28 +1383,31 @@ void RICInterpolatorImpl::interpolate(InputArray from_image, InputArray from_poi
 
     Mat U = Mat(src.rows, src.cols, CV_32FC1);
     Mat V = Mat(src.rows, src.cols, CV_32FC1);
-    for (int i = 0; i < spCnt; i++) {
-        for (int k = 0; k < spItems.cols; k++) {
-            int x = spItems.at<Point>(i,k).x;
-            int y = spItems.at<Point>(i,k).y;
-            if (x < 0 || y < 0) {
-                break;
-            }
-            float fx = fitModels.at<float>(i, 0) * x + fitModels.at<float>(i, 1) * y + fitModels.at<float>(i, 2);
-            float fy = fitModels.at<float>(i, 3) * x + fitModels.at<float>(i, 4) * y + fitModels.at<float>(i, 5);
-            //cout << fitModels << endl;
-            U.at<float>(y, x) = fx - x;
-            V.at<float>(y, x) = fy - y;
-            if (abs(fx - x) > max_flow || abs(fy - y) > max_flow)
-            {
-                // use the translational model directly
-                fx = transModels.at<float>(i, 0) * x + transModels.at<float>(i, 1) * y + transModels.at<float>(i, 2);
-                fy = transModels.at<float>(i, 3) * x + transModels.at<float>(i, 4) * y + transModels.at<float>(i, 5);
+    // every pixel belongs to exactly one superpixel, so the superpixels are written independently
+    parallel_for_(Range(0, spCnt), [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; i++) {
+            for (int k = 0; k < spItems.cols; k++) {
+                int x = spItems.at<Point>(i,k).x;
+                int y = spItems.at<Point>(i,k).y;
+                if (x < 0 || y < 0) {
+                    break;
+                }
+                float fx = fitModels.at<float>(i, 0) * x + fitModels.at<float>(i, 1) * y + fitModels.at<float>(i, 2);
+                float fy = fitModels.at<float>(i, 3) * x + fitModels.at<float>(i, 4) * y + fitModels.at<float>(i, 5);
                 U.at<float>(y, x) = fx - x;
                 V.at<float>(y, x) = fy - y;
+                if (abs(fx - x) > max_flow || abs(fy - y) > max_flow)
+                {
+                    // use the translational model directly
+                    fx = transModels.at<float>(i, 0) * x + transModels.at<float>(i, 1) * y + transModels.at<float>(i, 2);
+                    fy = transModels.at<float>(i, 3) * x + transModels.at<float>(i, 4) * y + transModels.at<float>(i, 5);
+                    U.at<float>(y, x) = fx - x;
+                    V.at<float>(y, x) = fy - y;
+                }
             }
         }
-    }
+    });
 
     Mat dst;
     Mat prevGrey, currGrey;
@@ -1317,94 +1438,7 @@ void RICInterpolatorImpl::interpolate(InputArray from_image, InputArray from_poi
 
 void RICInterpolatorImpl::geodesicDistanceTransform(Mat& distances, Mat& cost_map)
 {
-    float c1 = 1.0f / 2.0f;
-    float c2 = sqrt(2.0f) / 2.0f;
-    float d = 0.0f;
-    int i, j;
-    float *dist_row, *cost_row;
-    float *dist_row_prev, *cost_row_prev;
-    int *label_row;
-    int *label_row_prev;
-
-#define CHK_GD(cur_dist,cur_label,cur_cost,prev_dist,prev_label,prev_cost,coef)\
-{\
-    d = prev_dist + coef*(cur_cost+prev_cost);\
-    if(cur_dist>d){\
-        cur_dist=d;\
-        cur_label = prev_label;}\
-}
-
-    for (int it = 0; it < distance_transform_num_iter; it++)
-    {
-        //first pass (left-to-right, top-to-bottom):
-        dist_row = distances.ptr<float>(0);
-        label_row = labels.ptr<int>(0);
-        cost_row = cost_map.ptr<float>(0);
-        for (j = 1; j < distances.cols; j++)
-            CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row[j - 1], label_row[j - 1], cost_row[j - 1], c1);
-
-        for (i = 1; i < distances.rows; i++)
-        {
-            dist_row = distances.ptr<float>(i);
-            dist_row_prev = distances.ptr<float>(i - 1);
-
-            label_row = labels.ptr<int>(i);
-            label_row_prev = labels.ptr<int>(i - 1);
-
-            cost_row = cost_map.ptr<float>(i);
-            cost_row_prev = cost_map.ptr<float>(i - 1);
-
-            j = 0;
-            CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
-            CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j + 1], label_row_prev[j + 1], cost_row_prev[j + 1], c2);
-            j++;
-            for (; j < distances.cols - 1; j++)
-            {
-                CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row[j - 1], label_row[j - 1], cost_row[j - 1], c1);
-                CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j - 1], label_row_prev[j - 1], cost_row_prev[j - 1], c2);
-                CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
-                CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j + 1], label_row_prev[j + 1], cost_row_prev[j + 1], c2);
-            }
-            CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row[j - 1], label_row[j - 1], cost_row[j - 1], c1);
-            CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j - 1], label_row_prev[j - 1], cost_row_prev[j - 1], c2);
-            CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
-        }
-
-        //second pass (right-to-left, bottom-to-top):
-        dist_row = distances.ptr<float>(distances.rows - 1);
-        label_row = labels.ptr<int>(distances.rows - 1);
-        cost_row = cost_map.ptr<float>(distances.rows - 1);
-        for (j = distances.cols - 2; j >= 0; j--)
-            CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row[j + 1], label_row[j + 1], cost_row[j + 1], c1);
-
-        for (i = distances.rows - 2; i >= 0; i--)
-        {
-            dist_row = distances.ptr<float>(i);
-            dist_row_prev = distances.ptr<float>(i + 1);
-
-            label_row = labels.ptr<int>(i);
-            label_row_prev = labels.ptr<int>(i + 1);
-
-            cost_row = cost_map.ptr<float>(i);
-            cost_row_prev = cost_map.ptr<float>(i + 1);
-
-            j = distances.cols - 1;
-            CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
-            CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j - 1], label_row_prev[j - 1], cost_row_prev[j - 1], c2);
-            j--;
-            for (; j > 0; j--)
-            {
-                CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row[j + 1], label_row[j + 1], cost_row[j + 1], c1);
-                CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j + 1], label_row_prev[j + 1], cost_row_prev[j + 1], c2);
-                CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
-                CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j - 1], label_row_prev[j - 1], cost_row_prev[j - 1], c2);
-            }
-            CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row[j + 1], label_row[j + 1], cost_row[j + 1], c1);
-            CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j + 1], label_row_prev[j + 1], cost_row_prev[j + 1], c2);
-            CHK_GD(dist_row[j], label_row[j], cost_row[j], dist_row_prev[j], label_row_prev[j], cost_row_prev[j], c1);
-        }
-    }
-#undef CHK_GD
+    geodesicDistanceTransformTiled(distances, labels, cost_map, distance_transform_num_iter);
 }
 
 void RICInterpolatorImpl::buildGraph(Mat& distances, Mat& cost_map)
@@ -1624,51 +1658,56 @@ void RICInterpolatorImpl::findSupportMatches(vector<int> & srcIds, int srcCnt, i
     fill(outSupportDis.begin(), outSupportDis.end(), -1.f); // -1
 
     int allNodeCnt = matNN.rows;
-    MinHeap H(allNodeCnt); // min-heap
-    vector<float> currDis(allNodeCnt);
 
-    for (int i = 0; i < srcCnt; i++)
+    // the searches of different superpixels are independent
+    parallel_for_(Range(0, srcCnt), [&](const Range& range)
     {
-        int id = srcIds[i];
-        int* pSupportIds   = &outSupportIds[i * supportCnt];
-        float* pSupportDis = &outSupportDis[i * supportCnt];
+        MinHeap H(allNodeCnt); // min-heap
+        vector<float> currDis(allNodeCnt);
 
-        H.Clear();
-        fill(currDis.begin(), currDis.end(), numeric_limits<float>::max());
+        for (int i = range.start; i < range.end; i++)
+        {
+            int id = srcIds[i];
+            int* pSupportIds   = &outSupportIds[i * supportCnt];
+            float* pSupportDis = &outSupportDis[i * supportCnt];
 
-        int validSupportCnt = 0;
+            H.Clear();
+            fill(currDis.begin(), currDis.end(), numeric_limits<float>::max());
 
-        H.Push(static_cast<float>(id), 0); // min distance
-        currDis[id] = 0;
+            int validSupportCnt = 0;
 
-        while (H.Size()) {
-            float dis;
-            int idx = static_cast<int>(H.Pop(&dis));
+            H.Push(static_cast<float>(id), 0); // min distance
+            currDis[id] = 0;
 
-            if (dis > currDis[idx]) {
-                continue;
-            }
+            while (H.Size()) {
+                float dis;
+                int idx = static_cast<int>(H.Pop(&dis));
 
-            pSupportIds[validSupportCnt] = idx;
-            pSupportDis[validSupportCnt] = dis;
-            validSupportCnt++;
-            if (validSupportCnt >= supportCnt) {
-                break;
-            }
+                if (dis > currDis[idx]) {
+                    continue;
+                }
 
-            for (int k = 0; k < matNN.cols; k++) {
-                int nb = matNN.at<int>(idx, k);
-                if (nb < 0) {
+                pSupportIds[validSupportCnt] = idx;
+                pSupportDis[validSupportCnt] = dis;
+                validSupportCnt++;
+                if (validSupportCnt >= supportCnt) {
                     break;
                 }
-                float newDis = dis + matNNDis.at<float>(idx,k);
-                if (newDis < currDis[nb]) {
-                    H.Push(static_cast<float>(nb), newDis);
-                    currDis[nb] = newDis;
+
+                for (int k = 0; k < matNN.cols; k++) {
+                    int nb = matNN.at<int>(idx, k);
+                    if (nb < 0) {
+                        break;
+                    }
+                    float newDis = dis + matNNDis.at<float>(idx,k);
+                    if (newDis < currDis[nb]) {
+                        H.Push(static_cast<float>(nb), newDis);
+                        currDis[nb] = newDis;
+                    }
                 }
             }
         }
-    }
+    });
 }
 
 int RICInterpolatorImpl::PropagateModels(int spCnt, Mat & spNN, vector<int> & supportMatchIds, vector<float> & supportMatchDis, int supportCnt,
@@ -1679,8 +1718,6 @@ int RICInterpolatorImpl::PropagateModels(int spCnt, Mat & spNN, vector<int> & su
     srand(0);
 
     Mat inLierFlag(spCnt, supportCnt, CV_32SC1);
-    Mat tmpInlierFlag(1, supportCnt, CV_32SC1);
-    Mat tmpModel(1, 6, CV_32FC1);
 
     // prepare data
     vector<float> bestCost(spCnt);
@@ -1704,6 +1741,9 @@ int RICInterpolatorImpl::PropagateModels(int spCnt, Mat & spNN, vector<int> & su
     parallel_for_(Range(0, iterCnt), [&](const Range& range)
     {
         vector<int> vFlags(spCnt);
+        // hypothesis buffers are per worker, the iterations run concurrently
+        Mat tmpInlierFlag(1, supportCnt, CV_32SC1);
+        Mat tmpModel(1, 6, CV_32FC1);
         for (int iter = range.start; iter < range.end; iter++)
         {
             fill(vFlags.begin(), vFlags.end(), 0);
@@ -49,7 +49,7 @@
 
 #ifdef CV_CXX11
 #define CV_USE_PARALLEL_PREDICT_EDGES_1 1
-#define CV_USE_PARALLEL_PREDICT_EDGES_2 0  //1, see https://github.com/opencv/opencv_contrib/issues/2346
+#define CV_USE_PARALLEL_PREDICT_EDGES_2 1  // bands of output rows, see https://github.com/opencv/opencv_contrib/issues/2346
 #else
 #define CV_USE_PARALLEL_PREDICT_EDGES_1 0
 #define CV_USE_PARALLEL_PREDICT_EDGES_2 0
@@ -338,6 +338,104 @@ public:
   }
 };
 
+/*!
+ * A node of the random forest laid out for traversal. Nodes of all trees are
+ * stored in a single 16 byte aligned array, a node is one half of a cache line.
+ */
+struct RFNode
+{
+    float threshold;  /*!< go to child - 1 if the feature is below, to child otherwise */
+    int child;        /*!< offset of the right child from the root, 0 for leaves */
+    int offsetA;      /*!< offset of the regular feature or of the first self similarity cell */
+    int offsetB;      /*!< offset of the second self similarity cell, -1 for regular features */
+};
+
+static inline float featureValue(const float *p)
+{
+    return *p;
+}
+
+static inline float featureValue(const ushort *p)
+{
+    // IEEE half to float
+    const unsigned h = *p;
+    const unsigned sign = (h & 0x8000u) << 16;
+    const unsigned exponent = (h >> 10) & 0x1f;
+    const unsigned mantissa = h & 0x3ff;
+
+    Cv32suf out;
+    if (exponent == 0)
+    {
+        out.f = mantissa * (1.f / (1 << 24));
+        out.u |= sign;
+    }
+    else if (exponent == 31)
+        out.u = sign | 0x7f800000u | (mantissa << 13);
+    else
+        out.u = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    return out.f;
+}
+
+/*!
+ * The function finds the leaves reached by all (patch, tree) couples of a row of
+ * patches. Traversals are run by batches in lockstep, so the loads of different
+ * trees are in flight at the same time instead of waiting for each other.
+ *
+ * \param regFeatures : row of smoothed regular features
+ * \param ssFeatures : row of smoothed self similarity features
+ * \param nodes : flattened nodes of all trees
+ * \param indexPtr : [j*nTreesEval + k] leaf reached for patch j and tree k
+ */
+template <typename T>
+static void evaluateTreesRow(const T *regFeatures, const T *ssFeatures, const RFNode *nodes,
+                             const int i, const int width, const int nTreesEval, const int nTrees,
+                             const int nTreesNodes, const int stride, const int shrink,
+                             const int nchannels, int *indexPtr)
+{
+    enum { BATCH = 16 };
+
+    int baseNode[BATCH], currentNode[BATCH], offset[BATCH];
+    const int total = width*nTreesEval;
+
+    for (int t0 = 0; t0 < total; t0 += BATCH)
+    {
+        const int n = std::min(int(BATCH), total - t0);
+
+        for (int b = 0; b < n; ++b)
+        {
+            const int j = (t0 + b) / nTreesEval, k = (t0 + b) % nTreesEval;
+            baseNode[b] = ( ((i + j)%(2*nTreesEval) + k)%nTrees )*nTreesNodes;
+            currentNode[b] = baseNode[b];
+            offset[b] = (j*stride/shrink)*nchannels;
+        }
+
+        for (bool running = true; running; )
+        {
+            running = false;
+            for (int b = 0; b < n; ++b)
+            {
+                const RFNode &node = nodes[currentNode[b]];
+                if (node.child == 0)
+                    continue;
+                running = true;
+
+                float currentFeature;
+                if (node.offsetB >= 0)
+                    currentFeature = featureValue(ssFeatures + offset[b] + node.offsetA)
+                                   - featureValue(ssFeatures + offset[b] + node.offsetB);
+                else
+                    currentFeature = featureValue(regFeatures + offset[b] + node.offsetA);
+
+                // compare feature to threshold and move left or right accordingly
+                currentNode[b] = baseNode[b] + node.child - (currentFeature < node.threshold);
+            }
+        }
+
+        for (int b = 0; b < n; ++b)
+            indexPtr[t0 + b] = currentNode[b];
+    }
+}
+
 /********************* RFFeatureGetter class *********************/
 
 namespace cv
@@ -404,6 +502,9 @@ public:
 protected:
     /*! algorithm name */
     String name;
+
+    /*! keep the smoothed feature channels as 16 bit floats */
+    bool useFloat16Features;
 };
 
 Ptr<RFFeatureGetter> createRFFeatureGetter()
@@ -432,6 +533,7 @@ public:
     StructuredEdgeDetectionImpl(const cv::String &filename,
         Ptr<const RFFeatureGetter> _howToGetFeatures)
         : name("StructuredEdgeDetection"),
+          useFloat16Features(false),
           howToGetFeatures( (!_howToGetFeatures.empty())
                           ? _howToGetFeatures
                           : createRFFeatureGetter().staticCast<const RFFeatureGetter>() )
@@ -548,7 +650,7 @@ public:
             padding, padding, BORDER_REFLECT );
 
         NChannelsMat features;
-        createRFFeatureGetter()->getFeatures( nSrc, features,
+        howToGetFeatures->getFeatures( nSrc, features,
             __rf.options.gradientNormalizationRadius,
             __rf.options.gradientSmoothingRadius,
             __rf.options.shrinkNumber,
@@ -557,6 +659,16 @@ public:
         predictEdges( features, dst );
     }
 
+    void setUseFloat16Features(bool useFloat16) CV_OVERRIDE
+    {
+        useFloat16Features = useFloat16;
+    }
+
+    bool getUseFloat16Features() const CV_OVERRIDE
+    {
+        return useFloat16Features;
+    }
+
     /*!
      * The function computes orientation from edge image.
      *
@@ -738,53 +850,49 @@ protected:
             }
             // lookup tables for mapping linear index to offset pairs
 
+        // flattened forest, the feature offsets depend on the image width
+        cv::Mat nodesMat(1, nTrees*nTreesNodes, CV_32SC4);
+        RFNode *nodes = nodesMat.ptr<RFNode>();
+        for (int n = 0; n < nTrees*nTreesNodes; ++n)
+        {
+            int currentId = __rf.featureIds[n];
+
+            nodes[n].threshold = __rf.thresholds[n];
+            nodes[n].child = __rf.childs[n];
+            if (currentId >= nFeatures)
+            {
+                nodes[n].offsetA = offsetX[currentId - nFeatures];
+                nodes[n].offsetB = offsetY[currentId - nFeatures];
+            }
+            else
+            {
+                nodes[n].offsetA = offsetI[currentId];
+                nodes[n].offsetB = -1;
+            }
+        }
+
+        if (useFloat16Features)
+        {
+            regFeatures.convertTo(regFeatures, CV_16F);
+            ssFeatures.convertTo(ssFeatures, CV_16F);
+        }
+
         #if CV_USE_PARALLEL_PREDICT_EDGES_1
         parallel_for_(cv::Range(0, height), [&](const cv::Range& range)
         #else
         const cv::Range range(0, height);
         #endif
         {
-            for(int i = range.start; i < range.end; ++i) {
-                float *regFeaturesPtr = regFeatures.ptr<float>(i*stride/shrink);
-                float  *ssFeaturesPtr = ssFeatures.ptr<float>(i*stride/shrink);
-
+            for(int i = range.start; i < range.end; ++i)
+            {
                 int *indexPtr = indexes.ptr<int>(i);
 
-                for (int j = 0, k = 0; j < width; ++k, j += !(k %= nTreesEval))
-                    // for j,k in [0;width)x[0;nTreesEval)
-                {
-                    int baseNode = ( ((i + j)%(2*nTreesEval) + k)%nTrees )*nTreesNodes;
-                    int currentNode = baseNode;
-                    // select root node of the tree to evaluate
-
-                    int offset = (j*stride/shrink)*nchannels;
-                    while ( __rf.childs[currentNode] != 0 )
-                    {
-                        int currentId = __rf.featureIds[currentNode];
-                        float currentFeature;
-
-                        if (currentId >= nFeatures)
-                        {
-                            int xIndex = offsetX[currentId - nFeatures];
-                            float A = ssFeaturesPtr[offset + xIndex];
-
-                            int yIndex = offsetY[currentId - nFeatures];
-                            float B = ssFeaturesPtr[offset + yIndex];
-
-                            currentFeature = A - B;
-                        }
-                        else
-                            currentFeature = regFeaturesPtr[offset + offsetI[currentId]];
-
-                        // compare feature to threshold and move left or right accordingly
-                        if (currentFeature < __rf.thresholds[currentNode])
-                            currentNode = baseNode + __rf.childs[currentNode] - 1;
-                        else
-                            currentNode = baseNode + __rf.childs[currentNode];
-                    }
-
-                    indexPtr[j*nTreesEval + k] = currentNode;
-                }
+                if (useFloat16Features)
+                    evaluateTreesRow(regFeatures.ptr<ushort>(i*stride/shrink), ssFeatures.ptr<ushort>(i*stride/shrink),
+                        nodes, i, width, nTreesEval, nTrees, nTreesNodes, stride, shrink, nchannels, indexPtr);
+                else
+                    evaluateTreesRow(regFeatures.ptr<float>(i*stride/shrink), ssFeatures.ptr<float>(i*stride/shrink),
+                        nodes, i, width, nTreesEval, nTrees, nTreesNodes, stride, shrink, nchannels, indexPtr);
             }
         }
         #if CV_USE_PARALLEL_PREDICT_EDGES_1
@@ -795,34 +903,58 @@ protected:
             CV_MAKETYPE(DataType<float>::type, outNum));
         dstM.setTo(0);
 
+        // patches overlap, each band of output rows is owned by a single thread. it adds the
+        // contributions of all the patches which cover it in the same order as a sequential run
+        std::vector <int> rowE(/**/ CV_SQR(ipSize)*outNum, 0);
+        for (int i = 0; i < CV_SQR(ipSize)*outNum; ++i)
+        {
+            rowE[i] = ( i % CV_SQR(ipSize) )%ipSize;
+            offsetE[i] -= rowE[i]*dst.cols*outNum;
+        }
+
+        const int bandHeight = 4*ipSize;
+        const int nBands = (dst.rows + bandHeight - 1) / bandHeight;
+        const int nBnds = (int(__rf.edgeBoundaries.size()) - 1) / (nTreesNodes * nTrees);
+
         float step = 2.0f * CV_SQR(stride) / CV_SQR(ipSize) / nTreesEval;
         #if CV_USE_PARALLEL_PREDICT_EDGES_2
-        parallel_for_(cv::Range(0, height), [&](const cv::Range& range)
-        #elif CV_USE_PARALLEL_PREDICT_EDGES_1
-        const cv::Range range(0, height);
+        parallel_for_(cv::Range(0, nBands), [&](const cv::Range& range)
+        #else
+        const cv::Range range(0, nBands);
         #endif
         {
-            for(int i = range.start; i < range.end; ++i)
+            for (int band = range.start; band < range.end; ++band)
             {
-                int *pIndex = indexes.ptr<int>(i);
-                float *pDst = dstM.ptr<float>(i*stride);
+                const int r0 = band*bandHeight;
+                const int r1 = std::min(r0 + bandHeight, dst.rows);
+                const int iStart = std::max(0, (r0 - ipSize + stride) / stride);
+                const int iEnd = std::min(height, (r1 - 1) / stride + 1);
+
+                for (int i = iStart; i < iEnd; ++i)
+                {
+                    int *pIndex = indexes.ptr<int>(i);
+                    const int rowStart = i*stride;
+                    const bool inside = rowStart >= r0 && rowStart + ipSize <= r1;
 
-                for (int j = 0, k = 0; j < width; ++k, j += !(k %= nTreesEval))
-                {// for j,k in [0;width)x[0;nTreesEval)
+                    for (int j = 0, k = 0; j < width; ++k, j += !(k %= nTreesEval))
+                    {// for j,k in [0;width)x[0;nTreesEval)
 
-                    int currentNode = pIndex[j*nTreesEval + k];
-                    size_t sizeBoundaries = __rf.edgeBoundaries.size();
-                    int convertedBoundaries = static_cast<int>(sizeBoundaries);
-                    int nBnds = (convertedBoundaries - 1) / (nTreesNodes * nTrees);
-                    int start = __rf.edgeBoundaries[currentNode * nBnds];
-                    int finish = __rf.edgeBoundaries[currentNode * nBnds + 1];
+                        int currentNode = pIndex[j*nTreesEval + k];
+                        int start = __rf.edgeBoundaries[currentNode * nBnds];
+                        int finish = __rf.edgeBoundaries[currentNode * nBnds + 1];
 
-                    if (start == finish)
-                        continue;
+                        if (start == finish)
+                            continue;
 
-                    int offset = j*stride*outNum;
-                    for (int p = start; p < finish; ++p)
-                        pDst[offset + offsetE[__rf.edgeBins[p]]] += step;
+                        int offset = j*stride*outNum;
+                        for (int p = start; p < finish; ++p)
+                        {
+                            const int bin = __rf.edgeBins[p];
+                            const int row = rowStart + rowE[bin];
+                            if (inside || (row >= r0 && row < r1))
+                                dstM.ptr<float>(row)[offset + offsetE[bin]] += step;
+                        }
+                    }
                 }
             }
         }
@@ -839,6 +971,9 @@ protected:
     /*! algorithm name */
     String name;
 
+    /*! keep the smoothed feature channels as 16 bit floats */
+    bool useFloat16Features;
+
     /*! optional feature getter (getFeatures method) */
     Ptr<const RFFeatureGetter> howToGetFeatures;
 
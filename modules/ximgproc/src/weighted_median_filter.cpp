@@ -187,36 +187,13 @@ void float2D_release(float **p)
     delete []p;
 }
 
-/***************************************************************
- * Function: int2D
- * Description: allocate a 2D integer array with dimension "dim1 x dim2"
- ***************************************************************/
-int** int2D(int dim1, int dim2)
-{
-    int **ret = new int*[dim1];
-    ret[0] = new int[dim1*dim2];
-    for(int i=1;i<dim1;i++)ret[i] = ret[i-1]+dim2;
-
-    return ret;
-}
-
-/***************************************************************
- * Function: int2D_release
- * Description: deallocate the 2D array created by int2D()
- ***************************************************************/
-void int2D_release(int **p)
-{
-    delete []p[0];
-    delete []p;
-}
-
 /***************************************************************
  * Function: updateBCB
  * Description: maintain the necklace table of BCB
  ***************************************************************/
 inline void updateBCB(int &num,int *f,int *b,int i,int v)
 {
-    static int p1,p2;
+    int p1,p2;
 
     if(i)
     {
@@ -294,9 +271,9 @@ void featureIndexing(Mat &F, float **&wMap, int &nF, float sigmaI, int weightTyp
     {
         const int shift = 2; // 256(8-bit)->64(6-bit)
         const int LOW_NUM = 256>>shift;
-        static int hash[LOW_NUM][LOW_NUM][LOW_NUM]={{{0}}};
-
-        memset(hash,0,sizeof(hash));
+        // the table is local, so the concurrent calls of the filter do not share it
+        std::vector<int> hashBuf(LOW_NUM*LOW_NUM*LOW_NUM, 0);
+        int (*hash)[LOW_NUM][LOW_NUM] = (int (*)[LOW_NUM][LOW_NUM])&hashBuf[0];
 
         // throw pixels into a 2D histogram
         int candCnt = 0;
@@ -409,35 +386,70 @@ void featureIndexing(Mat &F, float **&wMap, int &nF, float sigmaI, int weightTyp
     F = FNew;
 }
 
-Mat filterCore(Mat &I, Mat &F, float **wMap, int r=20, int nF=256, int nI=256, Mat mask=Mat())
+/***************************************************************
+ * Struct: WMFWorkspace
+ * Description: joint-histogram, BCB and their necklace tables of one column tile.
+ *                Every tile scans its columns with its own workspace, the columns
+ *                do not depend on each other, so the tiles are filtered in parallel.
+ ***************************************************************/
+struct WMFWorkspace
+{
+    void create(int nI, int nF)
+    {
+        const size_t total = (size_t)nI * nF;
+        if (H.size() != total)
+        {
+            H.resize(total);
+            Hf.resize(total);
+            Hb.resize(total);
+        }
+        BCB.resize(nF);
+        BCBf.resize(nF);
+        BCBb.resize(nF);
+
+        HRows.resize(nI);
+        HfRows.resize(nI);
+        HbRows.resize(nI);
+        for (int i = 0; i < nI; i++)
+        {
+            HRows[i] = &H[(size_t)i * nF];
+            HfRows[i] = &Hf[(size_t)i * nF];
+            HbRows[i] = &Hb[(size_t)i * nF];
+        }
+    }
+
+    std::vector<int> H, Hf, Hb;
+    std::vector<int*> HRows, HfRows, HbRows;
+    std::vector<int> BCB, BCBf, BCBb;
+};
+
+/***************************************************************
+ * Function: filterCore
+ * Description: filters the columns [xStart, xEnd) of the 32SC1 image "I" into "outImg"
+ ***************************************************************/
+void filterCore(const Mat &I, const Mat &F, const Mat &mask, float **wMap, int r, int nF, int nI,
+                WMFWorkspace &ws, Mat &outImg, int xStart, int xEnd)
 {
     // Check validation
-    assert(I.depth() == CV_32S && I.channels()==1);//input image: 32SC1
-    assert(F.depth() == CV_32S && F.channels()==1);//feature image: 32SC1
+    CV_DbgAssert(I.depth() == CV_32S && I.channels()==1);//input image: 32SC1
+    CV_DbgAssert(F.depth() == CV_32S && F.channels()==1);//feature image: 32SC1
 
     // Configuration and declaration
     int rows = I.rows, cols = I.cols;
-    Mat outImg = I.clone();
 
-    // Handle Mask
-    if(mask.empty())
-    {
-        mask = Mat(I.size(),CV_8U);
-        mask = Scalar(1);
-    }
-
-    // Allocate memory for joint-histogram and BCB
-    int **H = int2D(nI,nF);
-    int *BCB = new int[nF];
+    // Joint-histogram and BCB
+    ws.create(nI, nF);
+    int **H = &ws.HRows[0];
+    int *BCB = &ws.BCB[0];
 
-    // Allocate links for necklace table
-    int **Hf = int2D(nI,nF);//forward link
-    int **Hb = int2D(nI,nF);//backward link
-    int *BCBf = new int[nF];//forward link
-    int *BCBb = new int[nF];//backward link
+    // Links for necklace table
+    int **Hf = &ws.HfRows[0];//forward link
+    int **Hb = &ws.HbRows[0];//backward link
+    int *BCBf = &ws.BCBf[0];//forward link
+    int *BCBb = &ws.BCBb[0];//backward link
 
     // Column Scanning
-    for(int x=0;x<cols;x++)
+    for(int x=xStart;x<xEnd;x++)
     {
         // Reset histogram and BCB for each column
         memset(BCB, 0, sizeof(int)*nF);
@@ -456,9 +468,9 @@ Mat filterCore(Mat &I, Mat &F, float **wMap, int r=20, int nF=256, int nI=256, M
         int upY = min(rows-1,r);
         for(int i=0;i<=upY;i++)
         {
-            int *IPtr = I.ptr<int>(i);
-            int *FPtr = F.ptr<int>(i);
-            uchar *maskPtr = mask.ptr<uchar>(i);
+            const int *IPtr = I.ptr<int>(i);
+            const int *FPtr = F.ptr<int>(i);
+            const uchar *maskPtr = mask.ptr<uchar>(i);
 
             for(int j=downX;j<=upX;j++)
             {
@@ -491,7 +503,7 @@ Mat filterCore(Mat &I, Mat &F, float **wMap, int r=20, int nF=256, int nI=256, M
         {
             // Find weighted median with help of BCB and joint-histogram
             float balanceWeight = 0;
-            int curIndex = F.ptr<int>(y,x)[0];
+            int curIndex = F.ptr<int>(y)[x];
             float *fPtr = wMap[curIndex];
             int &curMedianVal = medianVal;
 
@@ -557,9 +569,9 @@ Mat filterCore(Mat &I, Mat &F, float **wMap, int r=20, int nF=256, int nI=256, M
             if(curMedianVal != -1)
             {
                 if(balanceWeight < 0)
-                    outImg.ptr<int>(y,x)[0] = curMedianVal+1;
+                    outImg.ptr<int>(y)[x] = curMedianVal+1;
                 else
-                    outImg.ptr<int>(y,x)[0] = curMedianVal;
+                    outImg.ptr<int>(y)[x] = curMedianVal;
             }
 
             // Update joint-histogram and BCB when local window is shifted.
@@ -569,9 +581,9 @@ Mat filterCore(Mat &I, Mat &F, float **wMap, int r=20, int nF=256, int nI=256, M
             int rownum = y + r + 1;
             if(rownum < rows)
             {
-                    int *inputImgPtr = I.ptr<int>(rownum);
-                    int *guideImgPtr = F.ptr<int>(rownum);
-                    uchar *maskPtr = mask.ptr<uchar>(rownum);
+                    const int *inputImgPtr = I.ptr<int>(rownum);
+                    const int *guideImgPtr = F.ptr<int>(rownum);
+                    const uchar *maskPtr = mask.ptr<uchar>(rownum);
 
                     for(int j=downX;j<=upX;j++)
                     {
@@ -605,9 +617,9 @@ Mat filterCore(Mat &I, Mat &F, float **wMap, int r=20, int nF=256, int nI=256, M
                 rownum = y - r;
                 if(rownum >= 0)
                 {
-                    int *inputImgPtr = I.ptr<int>(rownum);
-                    int *guideImgPtr = F.ptr<int>(rownum);
-                    uchar *maskPtr = mask.ptr<uchar>(rownum);
+                    const int *inputImgPtr = I.ptr<int>(rownum);
+                    const int *guideImgPtr = F.ptr<int>(rownum);
+                    const uchar *maskPtr = mask.ptr<uchar>(rownum);
 
                     for(int j=downX;j<=upX;j++)
                     {
@@ -637,18 +649,7 @@ Mat filterCore(Mat &I, Mat &F, float **wMap, int r=20, int nF=256, int nI=256, M
         }
     }
 
-    // Deallocate the memory
-    {
-        delete []BCB;
-        delete []BCBf;
-        delete []BCBb;
-        int2D_release(H);
-        int2D_release(Hf);
-        int2D_release(Hb);
-    }
-
     // end of the function
-    return outImg;
 }
 }
 
@@ -656,10 +657,45 @@ namespace cv
 {
 namespace ximgproc
 {
+
+class WeightedMedianFilterImpl : public WeightedMedianFilter
+{
+public:
+    WeightedMedianFilterImpl(int _r, double _sigma, int _weightType)
+        : r(_r), sigma(_sigma), weightType(_weightType)
+    {
+        CV_Assert(r > 0 && sigma > 0);
+    }
+
+    void filter(InputArray joint, InputArray src, OutputArray dst, InputArray mask) CV_OVERRIDE;
+
+private:
+    int r;
+    double sigma;
+    int weightType;
+
+    // Working memory of the column tiles, kept to filter a stream of same-sized images without reallocations
+    std::vector<WMFWorkspace> workspaces;
+    Mat defaultMask;
+};
+
+Ptr<WeightedMedianFilter> createWeightedMedianFilter(int r, double sigma, int weightType)
+{
+    return makePtr<WeightedMedianFilterImpl>(r, sigma, weightType);
+}
+
 void weightedMedianFilter(InputArray joint, InputArray src, OutputArray dst, int r, double sigma, int weightType, InputArray mask)
+{
+    CV_INSTRUMENT_REGION();
+
+    CV_Assert(!src.empty());
+
+    WeightedMedianFilterImpl(r, sigma, weightType).filter(joint, src, dst, mask);
+}
+
+void WeightedMedianFilterImpl::filter(InputArray joint, InputArray src, OutputArray dst, InputArray mask)
 {
     CV_Assert(!src.empty());
-    CV_Assert(r > 0 && sigma > 0);
 
     int nI = 256;
     int nF = 256;
@@ -714,11 +750,42 @@ void weightedMedianFilter(InputArray joint, InputArray src, OutputArray dst, int
     float **wMap = NULL;
     featureIndexing(F, wMap, nF, float(sigma), weightType);
 
-    //Filtering - Joint-Histogram Framework
-    for(int i=0; i<(int)Is.size(); i++)
+    // Handle Mask
+    Mat M = mask.getMat();
+    if(M.empty())
     {
-        Is[i] = filterCore(Is[i], F, wMap, r, nF, nI, mask.getMat());
+        defaultMask.create(I.size(), CV_8U);
+        defaultMask = Scalar(1);
+        M = defaultMask;
     }
+    CV_Assert(M.type() == CV_8UC1 && M.size() == I.size());
+
+    //Filtering - Joint-Histogram Framework
+    //Every channel is split to column tiles which are filtered in parallel, one joint-histogram per tile.
+    const int cn = (int)Is.size();
+    const int cols = I.cols;
+    const int tilesPerChannel = std::max(1, std::min(cols, (getNumThreads() + cn - 1) / cn));
+    const int nTiles = cn * tilesPerChannel;
+    if ((int)workspaces.size() < nTiles)
+        workspaces.resize(nTiles);
+
+    vector<Mat> filtered(cn);
+    for(int i=0; i<cn; i++)
+        filtered[i] = Is[i].clone();
+
+    parallel_for_(Range(0, nTiles), [&](const Range& range)
+    {
+        for (int t = range.start; t < range.end; t++)
+        {
+            const int c = t / tilesPerChannel;
+            const int tile = t % tilesPerChannel;
+            const int xStart = cols * tile / tilesPerChannel;
+            const int xEnd = cols * (tile + 1) / tilesPerChannel;
+            filterCore(Is[c], F, M, wMap, r, nF, nI, workspaces[t], filtered[c], xStart, xEnd);
+        }
+    }, nTiles);
+
+    Is.swap(filtered);
     float2D_release(wMap);
 
     //Postprocess F
@@ -37,5 +37,22 @@ TEST(ximgproc_DericheFilter, regression)
     cv::transpose(dst2, dst2);
     EXPECT_LE(cv::norm(dst2, dst, NORM_INF), 1e-5);
 }
+
+TEST(ximgproc_DericheFilter, fusedXY)
+{
+    Mat img(97, 83, CV_16UC3);
+    RNG rng(0);
+    rng.fill(img, RNG::UNIFORM, 0, 1000);
+    double a = 1.0, w = 0.5;
+
+    Mat dx, dy, dxRef, dyRef;
+    ximgproc::GradientDericheXY(img, dx, dy, a, w);
+    ximgproc::GradientDericheX(img, dxRef, a, w);
+    ximgproc::GradientDericheY(img, dyRef, a, w);
+    ASSERT_EQ(CV_32FC3, dx.type());
+    ASSERT_EQ(CV_32FC3, dy.type());
+    EXPECT_LE(cvtest::norm(dxRef, dx, NORM_INF | NORM_RELATIVE), 1e-4);
+    EXPECT_LE(cvtest::norm(dyRef, dy, NORM_INF | NORM_RELATIVE), 1e-4);
+}
 }
 } // namespace
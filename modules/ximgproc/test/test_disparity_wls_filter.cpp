@@ -54,6 +54,50 @@ TEST(DisparityWLSFilterTest, ReferenceAccuracy)
     EXPECT_LE(BadPercent,ref_BadPercent+eps*ref_BadPercent);
 }
 
+TEST(DisparityWLSFilterTest, TiledAndReusedSolver)
+{
+    string dir = getDataDir() + "cv/disparityfilter";
+
+    Mat left = imread(dir + "/left_view.png",IMREAD_COLOR);
+    ASSERT_FALSE(left.empty());
+    Mat left_disp  = imread(dir + "/disparity_left_raw.png",IMREAD_GRAYSCALE);
+    ASSERT_FALSE(left_disp.empty());
+    left_disp.convertTo(left_disp,CV_16S,16);
+    Mat right_disp = imread(dir + "/disparity_right_raw.png",IMREAD_GRAYSCALE);
+    ASSERT_FALSE(right_disp.empty());
+    right_disp.convertTo(right_disp,CV_16S,-16);
+
+    Mat GT;
+    ASSERT_FALSE(readGT(dir + "/GT.png",GT));
+
+    FileStorage ROI_storage( dir + "/ROI.xml", FileStorage::READ );
+    Rect ROI((int)ROI_storage["x"],(int)ROI_storage["y"],(int)ROI_storage["width"],(int)ROI_storage["height"]);
+
+    Ptr<DisparityWLSFilter> wls_filter = createDisparityWLSFilterGeneric(true);
+    wls_filter->setLambda(8000.0);
+    wls_filter->setSigmaColor(0.5);
+
+    Mat res, res_reused;
+    wls_filter->filter(left_disp,left,res,right_disp,ROI);
+    wls_filter->filter(left_disp,left,res_reused,right_disp,ROI);
+    EXPECT_EQ(0, cvtest::norm(res, res_reused, NORM_INF));
+
+    // a tile covering the whole ROI is the untiled solution
+    wls_filter->setTileSize(std::max(left.cols, left.rows));
+    Mat res_one_tile;
+    wls_filter->filter(left_disp,left,res_one_tile,right_disp,ROI);
+    EXPECT_EQ(0, cvtest::norm(res, res_one_tile, NORM_INF));
+
+    wls_filter->setTileSize(160);
+    wls_filter->setTileOverlap(48);
+    Mat res_tiled;
+    wls_filter->filter(left_disp,left,res_tiled,right_disp,ROI);
+
+    double MSE = computeMSE(GT,res,ROI);
+    double MSE_tiled = computeMSE(GT,res_tiled,ROI);
+    EXPECT_LE(MSE_tiled, 1.5*MSE);
+}
+
 TEST_P(DisparityWLSFilterTest, MultiThreadReproducibility)
 {
     if (cv::getNumberOfCPUs() == 1)
@@ -214,4 +214,37 @@ TEST(DomainTransformTest, AuthorReferenceAccuracy)
     EXPECT_LE(cvtest::norm(res_IC, ref_IC, NORM_INF), 1);
 }
 
+TEST(DomainTransformTest, FilterMultiple_same_as_filter)
+{
+    RNG rng(0);
+    Size sz = szODD;
+    Mat guide = randomMat(rng, sz, CV_8UC3, 0, 255, false);
+
+    std::vector<Mat> srcs;
+    srcs.push_back(randomMat(rng, sz, CV_32FC1, 0, 255, false));
+    srcs.push_back(randomMat(rng, sz, CV_32FC2, 0, 255, false));
+    srcs.push_back(randomMat(rng, sz, CV_8UC3, 0, 255, false));
+    srcs.push_back(randomMat(rng, sz, CV_8UC1, 0, 255, false));
+    srcs.push_back(randomMat(rng, sz, CV_32FC4, 0, 255, false));
+
+    int modes[] = { DTF_NC, DTF_IC, DTF_RF };
+    for (int m = 0; m < 3; m++)
+    {
+        Ptr<DTFilter> dtf = createDTFilter(guide, 20.0, 30.0, modes[m]);
+
+        std::vector<Mat> dsts;
+        dtf->filterMultiple(srcs, dsts);
+        ASSERT_EQ(srcs.size(), dsts.size());
+
+        for (size_t k = 0; k < srcs.size(); k++)
+        {
+            Mat ref;
+            dtf->filter(srcs[k], ref);
+            ASSERT_EQ(ref.type(), dsts[k].type());
+            // the single channel RF path is vectorized, allow the rounding of 8-bit results to differ
+            EXPECT_LE(cvtest::norm(ref, dsts[k], NORM_INF), 1.0);
+        }
+    }
+}
+
 }} // namespace
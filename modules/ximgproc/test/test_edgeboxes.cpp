@@ -43,6 +43,14 @@ TEST(ximgproc_Edgeboxes, regression)
     EXPECT_EQ(expectedProposal.y, boxes[0].y);
     EXPECT_EQ(expectedProposal.height, boxes[0].height);
     EXPECT_EQ(expectedProposal.width, boxes[0].width);
+
+    //A second call on the same object must give the same proposal.
+    std::vector<Rect> boxes2;
+    std::vector<float> scores2;
+    edgeboxes->getBoundingBoxes(edgeImage, edgeOrientations, boxes2, scores2);
+    ASSERT_EQ(boxes.size(), boxes2.size());
+    EXPECT_EQ(boxes[0], boxes2[0]);
+    EXPECT_EQ(scores[0], scores2[0]);
 }
 
 }} // namespace
@@ -459,4 +459,39 @@ INSTANTIATE_TEST_CASE_P(FullSet, FastHoughTransformTest,
 #undef FHT_ALL_DEPTHS
 #undef FHT_ALL_CHANNELS
 
+typedef tuple<int, int> AngleRange_Skew;
+typedef TestWithParam<AngleRange_Skew> FastHoughTransformRowsTest;
+
+TEST_P(FastHoughTransformRowsTest, matches_full_transform)
+{
+    int const angleRange = get<0>(GetParam());
+    int const makeSkew   = get<1>(GetParam());
+
+    RNG& rng = TS::ptr()->get_rng();
+    Mat src(37, 23, CV_32FC3);
+    randu(src, 0.f, 1.f);
+
+    Mat fht;
+    FastHoughTransform(src, fht, CV_32F, angleRange, FHT_ADD, makeSkew);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        int first = rng.uniform(0, fht.rows);
+        int last = rng.uniform(first + 1, fht.rows + 1);
+
+        Mat band;
+        FastHoughTransformRows(src, band, CV_32F, Range(first, last), angleRange, FHT_ADD, makeSkew);
+
+        ASSERT_EQ(last - first, band.rows);
+        EXPECT_EQ(0, cvtest::norm(band, fht.rowRange(first, last), NORM_INF))
+            << "rows " << first << ".." << last;
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(FullSet, FastHoughTransformRowsTest,
+                        Combine(Values(ARO_0_45, ARO_45_90, ARO_90_135, ARO_315_0,
+                                       ARO_315_45, ARO_45_135, ARO_315_135,
+                                       ARO_CTR_HOR, ARO_CTR_VER),
+                                Values(HDO_RAW, HDO_DESKEW)));
+
 }} // namespace
@@ -123,6 +123,40 @@ TEST(FastBilateralSolverTest, ReferenceAccuracy)
 #endif
 }
 
+TEST(FastBilateralSolverTest, FilterMultiple)
+{
+    string dir = getDataDir() + "cv/edgefilter";
+
+    Mat guide = imread(dir + "/kodim23.png");
+    ASSERT_FALSE(guide.empty());
+
+    Mat confidence(guide.size(), CV_32FC1);
+    randu(confidence, 0.1f, 1.0f);
+
+    vector<Mat> src(3);
+    cvtColor(guide, src[0], COLOR_BGR2GRAY);
+    guide.convertTo(src[1], CV_16S, 64.0, -8192.0);
+    src[2].create(guide.size(), CV_32FC2);
+    randu(src[2], 0.0f, 1.0f);
+
+    Ptr<FastBilateralSolverFilter> fbs = createFastBilateralSolverFilter(guide, 16.0, 16.0, 16.0);
+
+    vector<Mat> res;
+    fbs->filterMultiple(src, confidence, res);
+    ASSERT_EQ(src.size(), res.size());
+
+    // lockstep solves follow the same iterations as the separate ones, only the summation order differs
+    double maxErr[] = { 1.0, 16.0, 1e-4 };
+    for (size_t k = 0; k < src.size(); k++)
+    {
+        Mat ref;
+        fbs->filter(src[k], confidence, ref);
+        ASSERT_EQ(ref.type(), res[k].type());
+        ASSERT_EQ(ref.size(), res[k].size());
+        EXPECT_LE(cvtest::norm(ref, res[k], NORM_INF), maxErr[k]);
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(FullSet, FastBilateralSolverTest,Combine(Values(szODD, szQVGA), SrcTypes::all(), GuideTypes::all()));
 
 }
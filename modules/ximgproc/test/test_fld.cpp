@@ -211,6 +211,25 @@ TEST_F(ximgproc_FLD, rotatedRect)
     ASSERT_EQ(EPOCHS, passedtests);
 }
 
+TEST_F(ximgproc_FLD, reusedDetector)
+{
+    Ptr<FastLineDetector> reused = createFastLineDetector(10, 1.414213562f, 50, 50, 0);
+    for (int i = 0; i < EPOCHS; ++i)
+    {
+        GenerateEdgeLines(test_image, 1);
+        Mat input = test_image.clone();
+        vector<Vec4f> ref_lines;
+        createFastLineDetector(10, 1.414213562f, 50, 50, 0)->detect(test_image, ref_lines);
+        reused->detect(test_image, lines);
+
+        EXPECT_EQ(0, cvtest::norm(input, test_image, NORM_INF));
+        if (ref_lines.size() == lines.size() &&
+            (lines.empty() || cvtest::norm(Mat(ref_lines), Mat(lines), NORM_INF) == 0))
+            ++passedtests;
+    }
+    ASSERT_EQ(EPOCHS, passedtests);
+}
+
 //************** EDGE DRAWING *******************
 
 TEST_F(ximgproc_ED, whiteNoise)
@@ -391,6 +391,31 @@ TEST_P(GuidedFilterTest, smallParamsIssue)
     EXPECT_LE(whiteRate, 0.1);
 }
 
+TEST(GuidedFilter, subsampled)
+{
+    Mat guide = imread(getOpenCVExtraDir() + "cv/shared/lena.png");
+    ASSERT_FALSE(guide.empty());
+    Mat src;
+    cvtColor(guide, src, COLOR_BGR2GRAY);
+
+    int radius = 8;
+    double eps = SQR(16.0);
+
+    Mat res, resRef;
+    guidedFilter(guide, src, resRef, radius, eps);
+    guidedFilter(guide, src, res, radius, eps, -1, 0.5);
+    ASSERT_EQ(resRef.size(), res.size());
+    ASSERT_EQ(resRef.type(), res.type());
+    EXPECT_GE(cvtest::PSNR(res, resRef), 30.0);
+
+    // every local linear model of a constant image is the constant itself
+    Mat constSrc(guide.size(), CV_32FC1, Scalar::all(100.0));
+    Ptr<GuidedFilter> gf = createGuidedFilter(guide, radius, eps, 0.25);
+    Mat constRes;
+    gf->filter(constSrc, constRes);
+    EXPECT_LE(cvtest::norm(constRes, constSrc, NORM_INF), 1e-2);
+}
+
 INSTANTIATE_TEST_CASE_P(TypicalSet, GuidedFilterTest,
     Combine(
     Values(1, 3),
@@ -34,6 +34,33 @@ TEST(L0SmoothTest, SplatSurfaceAccuracy)
     }
 }
 
+TEST(L0SmoothTest, SmootherReuse)
+{
+    RNG rnd(0);
+    Ptr<L0Smoother> smoother = createL0Smoother(0.03, 2.5);
+
+    const Size sizes[] = { Size(97, 75), Size(97, 75), Size(64, 81) };
+    const int types[] = { CV_8UC3, CV_8UC4, CV_32FC1 };
+    for (int i = 0; i < 3; i++)
+    {
+        Mat src(sizes[i], types[i]);
+        if (src.depth() == CV_8U)
+            randu(src, 0, 255);
+        else
+            randu(src, 0.0f, 1.0f);
+
+        Mat srcCopy = src.clone();
+        Mat res, ref;
+        smoother->smooth(src, res);
+        l0Smooth(src, ref, 0.03, 2.5);
+
+        EXPECT_EQ(src.type(), res.type());
+        EXPECT_EQ(src.size(), res.size());
+        EXPECT_EQ(0, cvtest::norm(ref, res, NORM_INF));
+        EXPECT_EQ(0, cvtest::norm(srcCopy, src, NORM_INF));
+    }
+}
+
 TEST_P(L0SmoothTest, MultiThreadReproducibility)
 {
     if (cv::getNumberOfCPUs() == 1)
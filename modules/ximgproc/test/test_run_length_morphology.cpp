@@ -245,5 +245,74 @@ TEST_P(RL_Paint, same_result)
 
 INSTANTIATE_TEST_CASE_P(TypicalSET, RL_Paint, Values(CV_8U, CV_16U, CV_16S, CV_32F, CV_64F));
 
+class RL_Operations : public RLTestBase, public testing::Test
+{
+public:
+    RL_Operations() { }
+protected:
+    virtual void SetUp() { setUp_impl(); }
+};
+
+TEST_F(RL_Operations, logical_operations)
+{
+    Mat resPix, resRLE;
+
+    bitwise_and(test_image[0], test_image[1], resPix);
+    rl::bitwise_and(test_image_rle[0], test_image_rle[1], resRLE);
+    ASSERT_TRUE(areImagesIdentical(resPix, resRLE));
+
+    bitwise_or(test_image[0], test_image[1], resPix);
+    rl::bitwise_or(test_image_rle[0], test_image_rle[1], resRLE);
+    ASSERT_TRUE(areImagesIdentical(resPix, resRLE));
+
+    bitwise_xor(test_image[0], test_image[1], resPix);
+    rl::bitwise_xor(test_image_rle[0], test_image_rle[1], resRLE);
+    ASSERT_TRUE(areImagesIdentical(resPix, resRLE));
+
+    subtract(test_image[0], test_image[1], resPix);
+    rl::subtract(test_image_rle[0], test_image_rle[1], resRLE);
+    ASSERT_TRUE(areImagesIdentical(resPix, resRLE));
+}
+
+TEST_F(RL_Operations, area_and_bounding_rect)
+{
+    for (size_t i = 0; i < test_image.size(); ++i)
+    {
+        EXPECT_EQ(cv::countNonZero(test_image[i]), rl::countNonZero(test_image_rle[i]));
+        EXPECT_EQ(cv::boundingRect(test_image[i]), rl::boundingRect(test_image_rle[i]));
+    }
+}
+
+TEST_F(RL_Operations, connected_components)
+{
+    Mat random(img_size, CV_8UC1), binary, binaryRLE;
+    randu(random, Scalar::all(0), Scalar::all(255));
+    cv::threshold(random, binary, 200.0, 255.0, THRESH_BINARY);
+    rl::threshold(random, binaryRLE, 200.0, THRESH_BINARY);
+
+    for (int connectivity = 4; connectivity <= 8; connectivity += 4)
+    {
+        Mat labels;
+        int nLabels = cv::connectedComponents(binary, labels, connectivity, CV_32S);
+
+        std::vector<Mat> components;
+        ASSERT_EQ(nLabels - 1, rl::connectedComponents(binaryRLE, components, connectivity));
+        ASSERT_EQ((size_t)(nLabels - 1), components.size());
+
+        Mat covered = Mat::zeros(img_size, CV_8UC1);
+        for (size_t k = 0; k < components.size(); ++k)
+        {
+            Rect rect = rl::boundingRect(components[k]);
+            ASSERT_GT(rect.area(), 0);
+            int label = labels.at<int>(rect.y, components[k].at<Point3i>(1).x);
+
+            Mat componentPix = (labels == label);
+            ASSERT_TRUE(areImagesIdentical(componentPix, components[k]));
+            rl::paint(covered, components[k], Scalar(255.0));
+        }
+        ASSERT_TRUE(arePixelImagesIdentical(binary, covered));
+    }
+}
+
 }
 }
\ No newline at end of file
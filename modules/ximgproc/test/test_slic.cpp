@@ -19,4 +19,56 @@ TEST(ximgproc_SuperpixelSLIC, smoke)
     EXPECT_GT(numSuperpixels, 0);
 }
 
+TEST(ximgproc_SuperpixelSLIC, updateImage)
+{
+    Mat img = imread(cvtest::findDataFile("cv/shared/lena.png"), IMREAD_COLOR);
+    ASSERT_FALSE(img.empty());
+    Mat labImg;
+    cvtColor(img, labImg, COLOR_BGR2Lab);
+
+    const int shift = 4;
+    Mat nextImg;
+    Mat M = (Mat_<double>(2, 3) << 1, 0, shift, 0, 1, 0);
+    warpAffine(labImg, nextImg, M, labImg.size(), INTER_NEAREST, BORDER_REPLICATE);
+    Mat flow(labImg.size(), CV_32FC2, Scalar(shift, 0));
+
+    Ptr<SuperpixelSLIC> slic = createSuperpixelSLIC(labImg);
+    slic->iterate(10);
+    Mat labels;
+    slic->getLabels(labels);
+    int numSuperpixels = slic->getNumberOfSuperpixels();
+
+    slic->updateImage(nextImg, flow);
+    slic->iterate(2);
+    Mat nextLabels;
+    slic->getLabels(nextLabels);
+    EXPECT_EQ(numSuperpixels, slic->getNumberOfSuperpixels());
+
+    // centers follow the motion, so the superpixels keep their labels
+    Rect inner(0, 0, labels.cols - shift, labels.rows);
+    Mat same = labels(inner) == nextLabels(inner + Point(shift, 0));
+    EXPECT_GE(countNonZero(same), 0.8 * inner.area());
+}
+
+TEST(ximgproc_SuperpixelLSC, updateImage)
+{
+    Mat img = imread(cvtest::findDataFile("cv/shared/lena.png"), IMREAD_COLOR);
+    ASSERT_FALSE(img.empty());
+    Mat labImg;
+    cvtColor(img, labImg, COLOR_BGR2Lab);
+
+    Ptr<SuperpixelLSC> lsc = createSuperpixelLSC(labImg);
+    lsc->iterate(10);
+    Mat labels;
+    lsc->getLabels(labels);
+
+    lsc->updateImage(labImg);
+    lsc->iterate(1);
+    Mat nextLabels;
+    lsc->getLabels(nextLabels);
+
+    Mat same = labels == nextLabels;
+    EXPECT_GE(countNonZero(same), 0.9 * labels.total());
+}
+
 }} // namespace
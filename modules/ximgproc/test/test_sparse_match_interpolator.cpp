@@ -158,6 +158,45 @@ TEST(InterpolatorTest, RICReferenceAccuracy)
     EXPECT_LE(cv::norm(res_flow, ref_flow, NORM_L1) , MAX_MEAN_DIF*res_flow.total());
 }
 
+TEST(InterpolatorTest, ReuseAcrossReferenceImages)
+{
+    RNG rng(0);
+    Size size(128, 96);
+    Mat from1(size, CV_8UC3), from2(size, CV_8UC3);
+    randu(from1, 0, 255);
+    randu(from2, 0, 255);
+
+    vector<Point2f> from_points, to_points;
+    for (int i = 0; i < 800; i++)
+    {
+        from_points.push_back(Point2f(rng.uniform(0.01f, size.width - 1.01f), rng.uniform(0.01f, size.height - 1.01f)));
+        to_points.push_back(from_points.back() + Point2f(rng.uniform(-3.f, 3.f), rng.uniform(-3.f, 3.f)));
+    }
+
+    // the second call with another image must not see the data cached for the first one
+    Mat eaiRef, eaiRes;
+    createEdgeAwareInterpolator()->interpolate(from2, from_points, Mat(), to_points, eaiRef);
+    Ptr<EdgeAwareInterpolator> eai = createEdgeAwareInterpolator();
+    eai->interpolate(from1, from_points, Mat(), to_points, eaiRes);
+    eai->interpolate(from2, from_points, Mat(), to_points, eaiRes);
+    EXPECT_EQ(0, cvtest::norm(eaiRef, eaiRes, NORM_INF));
+    eai->interpolate(from2, from_points, Mat(), to_points, eaiRes);
+    EXPECT_EQ(0, cvtest::norm(eaiRef, eaiRes, NORM_INF));
+
+    // model propagation draws random hypotheses, run it in one thread to get repeatable results
+    int nThreads = getNumThreads();
+    setNumThreads(1);
+    Mat ricRef, ricRes;
+    createRICInterpolator()->interpolate(from2, from_points, Mat(), to_points, ricRef);
+    Ptr<RICInterpolator> ric = createRICInterpolator();
+    ric->interpolate(from1, from_points, Mat(), to_points, ricRes);
+    ric->interpolate(from2, from_points, Mat(), to_points, ricRes);
+    EXPECT_EQ(0, cvtest::norm(ricRef, ricRes, NORM_INF));
+    ric->interpolate(from2, from_points, Mat(), to_points, ricRes);
+    EXPECT_EQ(0, cvtest::norm(ricRef, ricRes, NORM_INF));
+    setNumThreads(nThreads);
+}
+
 TEST_P(InterpolatorTest, MultiThreadReproducibility)
 {
     if (cv::getNumberOfCPUs() == 1)
@@ -39,4 +39,25 @@ TEST(ximgproc_StructuredEdgeDetection, regression)
     }
 }
 
+TEST(ximgproc_StructuredEdgeDetection, float16_features)
+{
+    cv::String dir = cvtest::TS::ptr()->get_data_path() + "cv/ximgproc/";
+    cv::Ptr<cv::ximgproc::StructuredEdgeDetection> pDollar =
+        cv::ximgproc::createStructuredEdgeDetection(dir + "model.yml.gz");
+
+    cv::Mat src = cv::imread( dir + "sources/01.png", 1 );
+    ASSERT_TRUE(!src.empty());
+    src.convertTo( src, CV_32F, 1/255.0 );
+
+    cv::Mat edges, edges16;
+    pDollar->detectEdges( src, edges );
+
+    pDollar->setUseFloat16Features(true);
+    EXPECT_TRUE(pDollar->getUseFloat16Features());
+    pDollar->detectEdges( src, edges16 );
+
+    cv::Mat sqrError = ( edges16 - edges ).mul( edges16 - edges );
+    EXPECT_LE( cv::sum(sqrError)[0] / double( sqrError.total() ), 1e-4 );
+}
+
 }} // namespace
@@ -70,6 +70,28 @@ TEST(WeightedMedianFilterTest, mask_zeros_no_crash)
     EXPECT_EQ(cv::norm(img, filtered, NORM_INF), 0.0);
 }
 
+TEST(WeightedMedianFilterTest, reusable_filter_matches_function)
+{
+    RNG rnd(0);
+    Ptr<WeightedMedianFilter> wmf = createWeightedMedianFilter(5, 20.0, WMF_EXP);
+
+    // the sizes change in the middle to check that the kept buffers are reinitialized
+    const Size sizes[] = { Size(67, 45), Size(67, 45), Size(31, 80), Size(67, 45) };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        Mat guide(sizes[i], CV_8UC1), src(sizes[i], CV_32FC2), mask(sizes[i], CV_8UC1);
+        rnd.fill(guide, RNG::UNIFORM, 0, 255);
+        rnd.fill(src, RNG::UNIFORM, -10.f, 10.f);
+        rnd.fill(mask, RNG::UNIFORM, 0, 2);
+
+        Mat ref, res;
+        weightedMedianFilter(guide, src, ref, 5, 20.0, WMF_EXP, mask);
+        wmf->filter(guide, src, res, mask);
+
+        EXPECT_EQ(0, cvtest::norm(ref, res, NORM_INF)) << sizes[i];
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(TypicalSET, WeightedMedianFilterTest, Combine(Values(szODD, szQVGA),  Values(WMF_EXP, WMF_IV2, WMF_OFF)));
 
 
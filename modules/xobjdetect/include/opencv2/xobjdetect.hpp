@@ -70,6 +70,17 @@ public:
     */
     virtual void write(FileStorage &fs) const = 0;
 
+    /** @brief Read detector from a binary file written by writeBinary.
+    The binary format loads faster than FileStorage.
+    @param filename Path of the input file
+    */
+    virtual void readBinary(const String &filename) = 0;
+
+    /** @brief Write detector to a binary file.
+    @param filename Path of the output file
+    */
+    virtual void writeBinary(const String &filename) const = 0;
+
     /** @brief Train WaldBoost detector
     @param pos_samples Path to directory with cropped positive samples
     @param neg_imgs Path to directory with negative (background) images
@@ -128,6 +128,15 @@ public:
     virtual void setWindow(const cv::Point& p) = 0;
     virtual void writeFeatures( cv::FileStorage &fs, const cv::Mat& featureMap ) const = 0;
     virtual float operator()(int featureIdx) = 0;
+
+    // offsets of the features feature_ind for channels whose rows are step elements apart
+    virtual void setChannelStep(int step, const std::vector<int> &feature_ind) = 0;
+    // computes the integral channels of an image, channels can be a view of a larger buffer
+    virtual void computeChannels(const cv::Mat& img, cv::Mat& channels) const = 0;
+    // value of a feature in the window of the channels whose top left corner is p.
+    // The evaluator is not modified, so windows can be evaluated concurrently
+    virtual float calc(int featureIdx, const cv::Mat& channels, const cv::Point& p) const = 0;
+
     static cv::Ptr<CvFeatureEvaluator> create();
 
     int getNumFeatures() const { return numFeatures; }
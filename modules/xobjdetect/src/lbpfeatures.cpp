@@ -74,6 +74,19 @@ void CvLBPEvaluator::setImage(const Mat &img, uchar clsLabel, int idx,
     }
 }
 
+void CvLBPEvaluator::setChannelStep(int step, const std::vector<int> &feature_ind)
+{
+    offset_ = step;
+    for (size_t i = 0; i < feature_ind.size(); ++i) {
+        features[feature_ind[i]].calcPoints(offset_);
+    }
+}
+
+void CvLBPEvaluator::computeChannels(const Mat &img, Mat &channels) const
+{
+    integral( img, channels );
+}
+
 void CvLBPEvaluator::writeFeatures( FileStorage &fs, const Mat& featureMap ) const
 {
     _writeFeatures( features, fs, featureMap );
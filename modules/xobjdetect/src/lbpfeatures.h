@@ -70,6 +70,10 @@ public:
     { cur_sum = sum.rowRange(p.y, p.y + winSize.height).colRange(p.x, p.x + winSize.width); }
     virtual float operator()(int featureIdx) CV_OVERRIDE
     { return (float)features[featureIdx].calc( cur_sum ); }
+    virtual void setChannelStep(int step, const std::vector<int> &feature_ind) CV_OVERRIDE;
+    virtual void computeChannels(const cv::Mat& img, cv::Mat& channels) const CV_OVERRIDE;
+    virtual float calc(int featureIdx, const cv::Mat& channels, const cv::Point& p) const CV_OVERRIDE
+    { return (float)features[featureIdx].calc( channels.ptr<int>(p.y) + p.x ); }
     virtual void writeFeatures( cv::FileStorage &fs, const cv::Mat& featureMap ) const CV_OVERRIDE;
 protected:
     virtual void generateFeatures() CV_OVERRIDE;
@@ -79,7 +83,8 @@ protected:
     public:
         Feature();
         Feature( int offset, int x, int y, int _block_w, int _block_h  );
-        uchar calc( const cv::Mat& _sum );
+        uchar calc( const cv::Mat& _sum ) const;
+        uchar calc( const int* psum ) const;
         void write( cv::FileStorage &fs ) const;
 
         cv::Rect rect;
@@ -94,10 +99,13 @@ protected:
     int offset_;
 };
 
-inline uchar CvLBPEvaluator::Feature::calc(const cv::Mat &_sum)
+inline uchar CvLBPEvaluator::Feature::calc(const cv::Mat &_sum) const
 {
-    const int* psum = _sum.ptr<int>();
+    return calc(_sum.ptr<int>());
+}
 
+inline uchar CvLBPEvaluator::Feature::calc(const int* psum) const
+{
     int cval = psum[p[5]] - psum[p[6]] - psum[p[9]] + psum[p[10]];
 
     return (uchar)((psum[p[0]] - psum[p[1]] - psum[p[4]] + psum[p[5]] >= cval ? 128 : 0) |   // 0
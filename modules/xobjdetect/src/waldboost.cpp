@@ -118,35 +118,115 @@ std::vector<int> WaldBoost::get_feature_indices()
     return feature_indices_;
 }
 
-void WaldBoost::detect(Ptr<CvFeatureEvaluator> eval,
+void WaldBoost::detectWindows(Ptr<CvFeatureEvaluator> eval,
             const Mat& img, const std::vector<float>& scales,
-            std::vector<Rect>& bboxes, Mat1f& confidences)
+            std::vector<Rect>& bboxes, std::vector<float>& confidences) const
 {
     bboxes.clear();
-    confidences.release();
+    confidences.clear();
+    if (weak_count_ == 0 || scales.empty())
+        return;
+    assert(feature_indices_.size() == size_t(weak_count_));
+    assert(cascade_thresholds_.size() == size_t(weak_count_));
 
-    Mat resized_img;
-    int step = 4;
-    float h;
-    for (size_t i = 0; i < scales.size(); ++i) {
-        float scale = scales[i];
-        resize(img, resized_img, Size(), scale, scale, INTER_LINEAR_EXACT);
-        eval->setImage(resized_img, 0, 0, feature_indices_);
-        int n_rows = (int)(24 / scale);
-        int n_cols = (int)(24 / scale);
-        for (int r = 0; r + 24 < resized_img.rows; r += step) {
-            for (int c = 0; c + 24 < resized_img.cols; c += step) {
-                //eval->setImage(resized_img(Rect(c, r, 24, 24)), 0, 0);
-                eval->setWindow(Point(c, r));
-                if (predict(eval, &h) == +1) {
+    const int win = 24;
+    const int step = 4;
+    const int n_levels = (int)scales.size();
+
+    std::vector<Mat> resized(n_levels);
+    parallel_for_(Range(0, n_levels), [&](const Range& range) {
+        for (int i = range.start; i < range.end; ++i)
+            resize(img, resized[i], Size(), scales[i], scales[i], INTER_LINEAR_EXACT);
+    });
+
+    // the integral channels of all the levels share the same row step, so the
+    // offsets of the features are computed once and then only read
+    int channel_step = 0;
+    std::vector<int> first_task(n_levels + 1, 0);
+    for (int i = 0; i < n_levels; ++i) {
+        channel_step = std::max(channel_step, resized[i].cols + 1);
+        int n_rows = resized[i].rows > win ? (resized[i].rows - win - 1) / step + 1 : 0;
+        first_task[i + 1] = first_task[i] + n_rows;
+    }
+    eval->setChannelStep(channel_step, feature_indices_);
+
+    std::vector<Mat> channels(n_levels);
+    parallel_for_(Range(0, n_levels), [&](const Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            Mat buf(resized[i].rows + 1, channel_step, CV_32S);
+            channels[i] = buf.colRange(0, resized[i].cols + 1);
+            eval->computeChannels(resized[i], channels[i]);
+        }
+    });
+
+    // every row of windows of every level is a task. The windows of a row are
+    // evaluated together stage by stage, dropping the ones rejected by the
+    // cascade, and the results are gathered in the order of a serial scan
+    const int n_tasks = first_task[n_levels];
+    std::vector<std::vector<Rect> > task_bboxes(n_tasks);
+    std::vector<std::vector<float> > task_confidences(n_tasks);
+    parallel_for_(Range(0, n_tasks), [&](const Range& range) {
+        std::vector<int> cols;
+        std::vector<float> res;
+        int level = 0;
+        for (int t = range.start; t < range.end; ++t) {
+            while (first_task[level + 1] <= t)
+                ++level;
+            const Mat& ch = channels[level];
+            const int r = (t - first_task[level]) * step;
+            const float scale = scales[level];
+
+            cols.clear();
+            res.clear();
+            for (int c = 0; c + win < resized[level].cols; c += step) {
+                cols.push_back(c);
+                res.push_back(0.f);
+            }
+
+            for (int i = 0; i < weak_count_ && !cols.empty(); ++i) {
+                size_t n = 0;
+                for (size_t k = 0; k < cols.size(); ++k) {
+                    float val = eval->calc(feature_indices_[i], ch, Point(cols[k], r));
+                    int label = polarities_[i] * (val - thresholds_[i]) > 0 ? +1: -1;
+                    float h = res[k] + alphas_[i] * label;
+                    if (h < cascade_thresholds_[i])
+                        continue;
+                    cols[n] = cols[k];
+                    res[n] = h;
+                    ++n;
+                }
+                cols.resize(n);
+                res.resize(n);
+            }
+
+            int n_rows = (int)(win / scale);
+            int n_cols = (int)(win / scale);
+            for (size_t k = 0; k < cols.size(); ++k) {
+                if (res[k] > cascade_thresholds_[weak_count_ - 1]) {
                     int row = (int)(r / scale);
-                    int col = (int)(c / scale);
-                    bboxes.push_back(Rect(col, row, n_cols, n_rows));
-                    confidences.push_back(h);
+                    int col = (int)(cols[k] / scale);
+                    task_bboxes[t].push_back(Rect(col, row, n_cols, n_rows));
+                    task_confidences[t].push_back(res[k]);
                 }
             }
         }
+    });
+
+    for (int t = 0; t < n_tasks; ++t) {
+        bboxes.insert(bboxes.end(), task_bboxes[t].begin(), task_bboxes[t].end());
+        confidences.insert(confidences.end(), task_confidences[t].begin(), task_confidences[t].end());
     }
+}
+
+void WaldBoost::detect(Ptr<CvFeatureEvaluator> eval,
+            const Mat& img, const std::vector<float>& scales,
+            std::vector<Rect>& bboxes, Mat1f& confidences)
+{
+    std::vector<float> h;
+    detectWindows(eval, img, scales, bboxes, h);
+    confidences.release();
+    if (!h.empty())
+        Mat1f(h, true).copyTo(confidences);
     groupRectangles(bboxes, 3, 0.7);
 }
 
@@ -154,30 +234,9 @@ void WaldBoost::detect(Ptr<CvFeatureEvaluator> eval,
             const Mat& img, const std::vector<float>& scales,
             std::vector<Rect>& bboxes, std::vector<double>& confidences)
 {
-    bboxes.clear();
-    confidences.clear();
-
-    Mat resized_img;
-    int step = 4;
-    float h;
-    for (size_t i = 0; i < scales.size(); ++i) {
-        float scale = scales[i];
-        resize(img, resized_img, Size(), scale, scale, INTER_LINEAR_EXACT);
-        eval->setImage(resized_img, 0, 0, feature_indices_);
-        int n_rows = (int)(24 / scale);
-        int n_cols = (int)(24 / scale);
-        for (int r = 0; r + 24 < resized_img.rows; r += step) {
-            for (int c = 0; c + 24 < resized_img.cols; c += step) {
-                eval->setWindow(Point(c, r));
-                if (predict(eval, &h) == +1) {
-                    int row = (int)(r / scale);
-                    int col = (int)(c / scale);
-                    bboxes.push_back(Rect(col, row, n_cols, n_rows));
-                    confidences.push_back(h);
-                }
-            }
-        }
-    }
+    std::vector<float> h;
+    detectWindows(eval, img, scales, bboxes, h);
+    confidences.assign(h.begin(), h.end());
     std::vector<int> levels(bboxes.size(), 0);
     groupRectangles(bboxes, levels, confidences, 3, 0.7);
 }
@@ -436,6 +495,64 @@ void WaldBoost::read(const FileNode &node)
         *n >> feature_indices_[i];
 }
 
+static const int WALDBOOST_MODEL_MAGIC = 0x4f424457; // "WDBO"
+static const int WALDBOOST_MODEL_VERSION = 1;
+
+void WaldBoost::save(const std::string& filename) const
+{
+    std::ofstream f(filename.c_str(), std::ios::binary);
+    if (!f.is_open())
+        CV_Error(Error::StsError, "Error while opening file to write model: " + filename);
+
+    // every array is stored as weak_count_ elements of 4 bytes
+    const int header[3] = { WALDBOOST_MODEL_MAGIC, WALDBOOST_MODEL_VERSION, weak_count_ };
+    CV_Assert(thresholds_.size() == size_t(weak_count_) && alphas_.size() == size_t(weak_count_) &&
+              polarities_.size() == size_t(weak_count_) && cascade_thresholds_.size() == size_t(weak_count_) &&
+              feature_indices_.size() == size_t(weak_count_));
+    const std::streamsize len = (std::streamsize)(weak_count_ * sizeof(int));
+    f.write((const char*)header, sizeof(header));
+    if (weak_count_ > 0) {
+        f.write((const char*)&thresholds_[0], len);
+        f.write((const char*)&alphas_[0], len);
+        f.write((const char*)&polarities_[0], len);
+        f.write((const char*)&cascade_thresholds_[0], len);
+        f.write((const char*)&feature_indices_[0], len);
+    }
+    if (!f)
+        CV_Error(Error::StsError, "Error while writing model: " + filename);
+}
+
+void WaldBoost::load(const std::string& filename)
+{
+    std::ifstream f(filename.c_str(), std::ios::binary);
+    if (!f.is_open())
+        CV_Error(Error::StsError, "Error while opening model file: " + filename);
+
+    int header[3] = { 0, 0, 0 };
+    f.read((char*)header, sizeof(header));
+    if (!f || header[0] != WALDBOOST_MODEL_MAGIC || header[1] != WALDBOOST_MODEL_VERSION || header[2] < 0)
+        CV_Error(Error::StsParseError, "Invalid WaldBoost model file: " + filename);
+
+    reset(header[2]);
+    thresholds_.resize(weak_count_);
+    alphas_.resize(weak_count_);
+    polarities_.resize(weak_count_);
+    cascade_thresholds_.resize(weak_count_);
+    feature_indices_.resize(weak_count_);
+    const std::streamsize len = (std::streamsize)(weak_count_ * sizeof(int));
+    if (weak_count_ > 0) {
+        f.read((char*)&thresholds_[0], len);
+        f.read((char*)&alphas_[0], len);
+        f.read((char*)&polarities_[0], len);
+        f.read((char*)&cascade_thresholds_[0], len);
+        f.read((char*)&feature_indices_[0], len);
+    }
+    if (!f) {
+        reset(0);
+        CV_Error(Error::StsParseError, "Truncated WaldBoost model file: " + filename);
+    }
+}
+
 void WaldBoost::reset(int weak_count)
 {
     weak_count_ = weak_count;
@@ -70,7 +70,8 @@ public:
 
     void fit(Mat& data_pos, Mat& data_neg);
     int predict(Ptr<CvFeatureEvaluator> eval, float *h) const;
-    void save(const std::string& filename);
+    // binary model, faster to load than FileStorage
+    void save(const std::string& filename) const;
     void load(const std::string& filename);
 
     void read(const FileNode &node);
@@ -80,6 +81,12 @@ public:
     ~WaldBoost();
 
 private:
+    void detectWindows(Ptr<CvFeatureEvaluator> eval,
+                       const Mat& img,
+                       const std::vector<float>& scales,
+                       std::vector<Rect>& bboxes,
+                       std::vector<float>& confidences) const;
+
     int weak_count_;
     std::vector<float> thresholds_;
     std::vector<float> alphas_;
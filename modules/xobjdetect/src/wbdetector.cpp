@@ -100,6 +100,16 @@ void WBDetectorImpl::write(FileStorage &fs) const
     boost_.write(fs);
 }
 
+void WBDetectorImpl::readBinary(const String &filename)
+{
+    boost_.load(filename);
+}
+
+void WBDetectorImpl::writeBinary(const String &filename) const
+{
+    boost_.save(filename);
+}
+
 void WBDetectorImpl::train(
     const string& pos_samples_path,
     const string& neg_imgs_path)
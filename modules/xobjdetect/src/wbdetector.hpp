@@ -56,6 +56,8 @@ class WBDetectorImpl CV_FINAL : public WBDetector {
 public:
     virtual void read(const FileNode &node) CV_OVERRIDE;
     virtual void write(FileStorage &fs) const CV_OVERRIDE;
+    virtual void readBinary(const String &filename) CV_OVERRIDE;
+    virtual void writeBinary(const String &filename) const CV_OVERRIDE;
 
     virtual void train(
         const std::string& pos_samples,
@@ -7,11 +7,17 @@ using namespace std;
 using namespace cv;
 using namespace cv::xobjdetect;
 
+static bool isBinaryModel(const string& filename)
+{
+    return filename.size() > 4 && filename.substr(filename.size() - 4) == ".bin";
+}
+
 int main(int argc, char **argv)
 {
     if (argc < 5) {
         cerr << "Usage: " << argv[0] << " train <model_filename> <pos_path> <neg_path>" << endl;
         cerr << "       " << argv[0] << " detect <model_filename> <img_filename> <out_filename> <labelling_filename>" << endl;
+        cerr << "Models named *.bin are stored in the binary format" << endl;
         return 0;
     }
 
@@ -20,16 +26,24 @@ int main(int argc, char **argv)
     if (mode == "train") {
         assert(argc == 5);
         detector->train(argv[3], argv[4]);
-        FileStorage fs(argv[2], FileStorage::WRITE);
-        fs << "waldboost";
-        detector->write(fs);
+        if (isBinaryModel(argv[2])) {
+            detector->writeBinary(argv[2]);
+        } else {
+            FileStorage fs(argv[2], FileStorage::WRITE);
+            fs << "waldboost";
+            detector->write(fs);
+        }
     } else if (mode == "detect") {
         assert(argc == 6);
         vector<Rect> bboxes;
         vector<double> confidences;
         Mat img = imread(argv[3], IMREAD_GRAYSCALE);
-        FileStorage fs(argv[2], FileStorage::READ);
-        detector->read(fs.getFirstTopLevelNode());
+        if (isBinaryModel(argv[2])) {
+            detector->readBinary(argv[2]);
+        } else {
+            FileStorage fs(argv[2], FileStorage::READ);
+            detector->read(fs.getFirstTopLevelNode());
+        }
         detector->detect(img, bboxes, confidences);
 
         FILE *fhandle = fopen(argv[5], "a");
@@ -65,11 +65,13 @@ namespace xphoto
     @param dst destination image
     @param sigma expected noise standard deviation
     @param psize size of block side where dct is computed
+    @param step step of the sliding window. Step 1 filters every patch, bigger steps average less
+    overlapping patches and are faster by about step^2.
 
     @sa
        fastNlMeansDenoising
      */
-    CV_EXPORTS_W void dctDenoising(const Mat &src, Mat &dst, const double sigma, const int psize = 16);
+    CV_EXPORTS_W void dctDenoising(const Mat &src, Mat &dst, const double sigma, const int psize = 16, const int step = 1);
 
 //! @}
 
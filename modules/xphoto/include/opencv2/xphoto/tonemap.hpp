@@ -15,7 +15,8 @@ namespace cv { namespace xphoto {
 /** @brief This algorithm decomposes image into two layers: base layer and detail layer using bilateral filter
 and compresses contrast of the base layer thus preserving all the details.
 
-This implementation uses regular bilateral filter from OpenCV.
+This implementation uses regular bilateral filter from OpenCV, or its bilateral grid approximation @cite PD06
+which is much faster for large images and sigmas.
 
 Saturation enhancement is possible as in cv::TonemapDrago.
 
@@ -36,6 +37,12 @@ public:
 
     CV_WRAP virtual float getSigmaColor() const = 0;
     CV_WRAP virtual void setSigmaColor(float sigma_color) = 0;
+
+    /** @brief Whether the base layer is computed on a bilateral grid instead of with cv::bilateralFilter.
+    The grid has a cell per sigma_space pixels and sigma_color of the log luminance, false by default.
+    */
+    CV_WRAP virtual bool getUseBilateralGrid() const = 0;
+    CV_WRAP virtual void setUseBilateralGrid(bool use_bilateral_grid) = 0;
 };
 
 /** @brief Creates TonemapDurand object
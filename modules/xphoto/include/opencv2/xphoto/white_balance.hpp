@@ -145,6 +145,21 @@ class CV_EXPORTS_W GrayworldWB : public WhiteBalancer
     CV_WRAP virtual float getSaturationThreshold() const = 0;
     /** @copybrief getSaturationThreshold @see getSaturationThreshold */
     CV_WRAP virtual void setSaturationThreshold(float val) = 0;
+
+    /** @brief Step of the grid of pixels the channel averages are computed on, 1 uses every pixel.
+        The statistics get about step^2 times cheaper, the gains are still applied to the whole image.
+    @see setSubsamplingStep */
+    CV_WRAP virtual int getSubsamplingStep() const = 0;
+    /** @copybrief getSubsamplingStep @see getSubsamplingStep */
+    CV_WRAP virtual void setSubsamplingStep(int val) = 0;
+
+    /** @brief Weight in [0, 1) of the gains of the previous image, for the frames of a video.
+        With a positive weight the gains are exponentially smoothed over the images given to balanceWhite,
+        0 processes every image independently. The smoothing starts over when the image size or type changes.
+    @see setTemporalSmoothing */
+    CV_WRAP virtual float getTemporalSmoothing() const = 0;
+    /** @copybrief getTemporalSmoothing @see getTemporalSmoothing */
+    CV_WRAP virtual void setTemporalSmoothing(float val) = 0;
 };
 
 /** @brief Creates an instance of GrayworldWB
@@ -205,6 +220,29 @@ class CV_EXPORTS_W LearningBasedWB : public WhiteBalancer
     CV_WRAP virtual int getHistBinNum() const = 0;
     /** @copybrief getHistBinNum @see getHistBinNum */
     CV_WRAP virtual void setHistBinNum(int val) = 0;
+
+    /** @brief Step of the grid of pixels the features are computed on by balanceWhite, 1 uses every pixel.
+        extractSimpleFeatures always uses the whole image.
+    @see setSubsamplingStep */
+    CV_WRAP virtual int getSubsamplingStep() const = 0;
+    /** @copybrief getSubsamplingStep @see getSubsamplingStep */
+    CV_WRAP virtual void setSubsamplingStep(int val) = 0;
+
+    /** @brief Weight in [0, 1) of the gains of the previous image, for the frames of a video.
+        With a positive weight the gains are exponentially smoothed over the images given to balanceWhite,
+        0 processes every image independently. The smoothing starts over when the image size or type changes.
+    @see setTemporalSmoothing */
+    CV_WRAP virtual float getTemporalSmoothing() const = 0;
+    /** @copybrief getTemporalSmoothing @see getTemporalSmoothing */
+    CV_WRAP virtual void setTemporalSmoothing(float val) = 0;
+
+    /** @brief Number of images balanceWhite keeps the predicted illuminant for, 1 predicts it for every image.
+        The illuminant is predicted again before that when the average chromaticity of the image moves away
+        from the one of the last prediction, i.e. on a scene change.
+    @see setFeatureUpdateInterval */
+    CV_WRAP virtual int getFeatureUpdateInterval() const = 0;
+    /** @copybrief getFeatureUpdateInterval @see getFeatureUpdateInterval */
+    CV_WRAP virtual void setFeatureUpdateInterval(int val) = 0;
 };
 
 /** @brief Creates an instance of LearningBasedWB
@@ -223,6 +261,21 @@ CV_EXPORTS_W Ptr<LearningBasedWB> createLearningBasedWB(const String& path_to_mo
 @param gainR gain for the R channel
 */
 CV_EXPORTS_W void applyChannelGains(InputArray src, OutputArray dst, float gainB, float gainG, float gainR);
+
+/** @brief Applies channel gains and the gamma encoding in a single pass over the image.
+
+The gains are scaled by their maximum as in the function above, then every channel value is mapped by a
+lookup table to \f$\texttt{max} \cdot (\texttt{gain} \cdot \texttt{src} / \texttt{max})^{1/\gamma}\f$,
+where max is the maximum value of the image depth.
+
+@param src Input three-channel image in the BGR color space (either CV_8UC3 or CV_16UC3)
+@param dst Output image of the same size and type as src.
+@param gainB gain for the B channel
+@param gainG gain for the G channel
+@param gainR gain for the R channel
+@param gamma gamma of the encoding, 1 only applies the gains
+*/
+CV_EXPORTS_W void applyChannelGains(InputArray src, OutputArray dst, float gainB, float gainG, float gainR, float gamma);
 //! @}
 }
 }
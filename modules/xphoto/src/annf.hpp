@@ -98,7 +98,7 @@ private:
     void operator =(const KDTree <Tp, cn> &) const {};
 
 public:
-    void updateDist(const int leaf, const int &idx0, int &bestIdx, double &dist);
+    void updateDist(const int leaf, const int &idx0, int &bestIdx, double &dist) const;
 
     KDTree(const cv::Mat &data, const int leafNumber = 8, const int zeroThresh = 16);
     ~KDTree(){};
@@ -178,7 +178,7 @@ KDTree(const cv::Mat &img, const int _leafNumber, const int _zeroThresh)
 }
 
 template <typename Tp, int cn> void KDTree <Tp, cn>::
-updateDist(const int leaf, const int &idx0, int &bestIdx, double &dist)
+updateDist(const int leaf, const int &idx0, int &bestIdx, double &dist) const
 {
     for (int k = nodes[leaf].x; k < nodes[leaf].y; ++k)
     {
@@ -232,23 +232,31 @@ static void dominantTransforms(const cv::Mat &img, std::vector <cv::Point2i> &tr
 
     /** Propagation-assisted kd-tree search **/
 
-    for (int i = 0; i < whs.rows; ++i)
-        for (int j = 0; j < whs.cols; ++j)
+    // the propagation starts over in each band of rows, so the bands are searched in parallel
+    const int bandRows = 32;
+    cv::parallel_for_(cv::Range(0, cv::divUp(whs.rows, bandRows)), [&](const cv::Range &range)
+    {
+        for (int i = range.start*bandRows; i < std::min(range.end*bandRows, whs.rows); ++i)
         {
-            double dist = std::numeric_limits <double>::max();
-            int current = i*whs.cols + j;
-
-            int dy[] = {0, 1, 0}, dx[] = {0, 0, 1};
-            for (int k = 0; k < int( sizeof(dy)/sizeof(int) ); ++k)
-                if ( i - dy[k] >= 0 && j - dx[k] >= 0 )
-                {
-                    int neighbor = (i - dy[k])*whs.cols + (j - dx[k]);
-                    int leafIdx = (dx[k] == 0 && dy[k] == 0)
-                        ? neighbor : annf[neighbor] + dy[k]*whs.cols + dx[k];
-                    kdTree.updateDist(leafIdx, current,
-                                annf[i*whs.cols + j], dist);
-                }
+            const int top = i - i % bandRows;
+            for (int j = 0; j < whs.cols; ++j)
+            {
+                double dist = std::numeric_limits <double>::max();
+                int current = i*whs.cols + j;
+
+                int dy[] = {0, 1, 0}, dx[] = {0, 0, 1};
+                for (int k = 0; k < int( sizeof(dy)/sizeof(int) ); ++k)
+                    if ( i - dy[k] >= top && j - dx[k] >= 0 )
+                    {
+                        int neighbor = (i - dy[k])*whs.cols + (j - dx[k]);
+                        int leafIdx = (dx[k] == 0 && dy[k] == 0)
+                            ? neighbor : annf[neighbor] + dy[k]*whs.cols + dx[k];
+                        kdTree.updateDist(leafIdx, current,
+                                    annf[i*whs.cols + j], dist);
+                    }
+            }
         }
+    });
 
     /** Local maxima extraction **/
 
@@ -75,6 +75,80 @@ inline bool isPowerOf2(int x)
 }
 
 
+// Upper bound of the memory used by the column sums of the block matching (per thread)
+const size_t BM3D_MAX_COL_DIST_SUMS_SIZE = (size_t)1 << 22;
+
+// Returns the number of columns processed at once, a multiple of the sliding step
+inline int getBm3dTileCols(int cols, int searchWindowSizeSq, int slidingStep)
+{
+    int tileCols = (int)(BM3D_MAX_COL_DIST_SUMS_SIZE / (sizeof(int) * searchWindowSizeSq));
+    tileCols = std::max(tileCols - tileCols % slidingStep, slidingStep);
+    return std::min(tileCols, cols);
+}
+
+#if CV_SIMD128
+// Loads 4 pixels to 32-bit integers, available for the single channel types only
+template <typename T>
+struct DistSumsLoad
+{
+    enum { enabled = 0 };
+    static inline v_int32x4 load(const T*) { return v_setzero_s32(); }
+};
+
+template <>
+struct DistSumsLoad<uchar>
+{
+    enum { enabled = 1 };
+    static inline v_int32x4 load(const uchar* ptr) { return v_reinterpret_as_s32(v_load_expand_q(ptr)); }
+};
+
+template <>
+struct DistSumsLoad<ushort>
+{
+    enum { enabled = 1 };
+    static inline v_int32x4 load(const ushort* ptr) { return v_reinterpret_as_s32(v_load_expand(ptr)); }
+};
+#endif
+
+// Moves the block matching sums one row down for a row of the search window:
+// the column sum is updated with the difference of the pixels leaving and entering the block
+// and replaces the oldest column sum in the total distance.
+template <typename D, typename T>
+inline static void updateDistSums(
+    int *distSums,
+    int *colDistSums,
+    int *lastColDistSums,
+    const T &a_up,
+    const T &a_down,
+    const T *b_up,
+    const T *b_down,
+    const int &searchWindowSize)
+{
+    int x = 0;
+#if CV_SIMD128
+    if (DistSumsLoad<T>::enabled)
+    {
+        const v_int32x4 va_up = v_setall_s32((int)a_up);
+        const v_int32x4 va_down = v_setall_s32((int)a_down);
+        for (; x <= searchWindowSize - v_int32x4::nlanes; x += v_int32x4::nlanes)
+        {
+            v_int32x4 colSum = v_load(lastColDistSums + x) + D::calcUpDownDist(
+                va_up, va_down, DistSumsLoad<T>::load(b_up + x), DistSumsLoad<T>::load(b_down + x));
+            v_store(distSums + x, v_load(distSums + x) - v_load(colDistSums + x) + colSum);
+            v_store(colDistSums + x, colSum);
+            v_store(lastColDistSums + x, colSum);
+        }
+    }
+#endif
+    for (; x < searchWindowSize; ++x)
+    {
+        distSums[x] -= colDistSums[x];
+        colDistSums[x] = lastColDistSums[x] + D::template calcUpDownDist<T>(a_up, a_down, b_up[x], b_down[x]);
+        distSums[x] += colDistSums[x];
+        lastColDistSums[x] = colDistSums[x];
+    }
+}
+
 template <typename T>
 inline static void shrink(T &val, T &nonZeroCount, const T &threshold)
 {
@@ -75,6 +75,7 @@ private:
 
     void calcDistSumsForFirstElementInRow(
         int i,
+        int col_from,
         Array2d<int>& distSums,
         Array3d<int>& colDistSums,
         Array3d<int>& lastColDistSums,
@@ -84,6 +85,7 @@ private:
     void calcDistSumsForAllElementsInFirstRow(
         int i,
         int j,
+        int col_from,
         int firstColNum,
         Array2d<int>& distSums,
         Array3d<int>& colDistSums,
@@ -213,183 +215,184 @@ void Bm3dDenoisingInvokerStep1<T, D, WT, TT, TC>::operator() (const Range& range
     // Sums of columns for current pixel (for lazy calc optimization)
     Array3d<int> colDistSums(blockSize, searchWindowSize, searchWindowSize);
 
-    // Last elements of column sum (for each element in a row)
-    Array3d<int> lastColDistSums(src_.cols, searchWindowSize, searchWindowSize);
+    // Last elements of column sum (for each element in a row of the current tile)
+    const int tileCols = getBm3dTileCols(src_.cols, searchWindowSizeSq, slidingStep_);
+    Array3d<int> lastColDistSums(tileCols, searchWindowSize, searchWindowSize);
 
-    int firstColNum = -1;
-    for (int j = row_from, jj = 0; j <= row_to; j += slidingStep_, jj += slidingStep_)
+    // The rows are processed in tiles of columns, so the scratch memory does not grow with the image width
+    for (int col_from = 0; col_from < src_.cols; col_from += tileCols)
     {
-        for (int i = 0; i < src_.cols; i += slidingStep_)
+        const int col_to = std::min(col_from + tileCols, src_.cols);
+        int firstColNum = -1;
+        for (int j = row_from, jj = 0; j <= row_to; j += slidingStep_, jj += slidingStep_)
         {
-            const T *currentPixel = srcExtended_.ptr<T>(0) + step*j + i;
-            int elementSize = 1;
-
-            // Calculate distSums using moving average filter approach.
-            if (i == 0)
-            {
-                // Calculate distSums for the first element in a row
-                calcDistSumsForFirstElementInRow(j, distSums, colDistSums, lastColDistSums, bm, elementSize);
-                firstColNum = 0;
-            }
-            else
+            for (int i = col_from; i < col_to; i += slidingStep_)
             {
-                if (j == row_from)
+                const T *currentPixel = srcExtended_.ptr<T>(0) + step*j + i;
+                int elementSize = 1;
+
+                // Calculate distSums using moving average filter approach.
+                if (i == col_from)
                 {
-                    // Calculate distSums for all elements in the first row
-                    calcDistSumsForAllElementsInFirstRow(
-                        j, i, firstColNum, distSums, colDistSums, lastColDistSums, bm, elementSize);
+                    // Calculate distSums for the first element in a row
+                    calcDistSumsForFirstElementInRow(j, col_from, distSums, colDistSums, lastColDistSums, bm, elementSize);
+                    firstColNum = 0;
                 }
                 else
                 {
-                    const int start_bx = blockSize + i - 1;
-                    const int start_by = j - 1;
-                    const int ax = halfSearchWindowSize + start_bx;
-                    const int ay = halfSearchWindowSize + start_by;
-
-                    const T a_up = srcExtended_.at<T>(ay, ax);
-                    const T a_down = srcExtended_.at<T>(ay + blockSize, ax);
-
-                    for (TT y = 0; y < searchWindowSize; y++)
+                    if (j == row_from)
+                    {
+                        // Calculate distSums for all elements in the first row
+                        calcDistSumsForAllElementsInFirstRow(
+                            j, i, col_from, firstColNum, distSums, colDistSums, lastColDistSums, bm, elementSize);
+                    }
+                    else
                     {
-                        int *distSumsRow = distSums.row_ptr(y);
-                        int *colDistSumsRow = colDistSums.row_ptr(firstColNum, y);
-                        int *lastColDistSumsRow = lastColDistSums.row_ptr(i, y);
+                        const int start_bx = blockSize + i - 1;
+                        const int start_by = j - 1;
+                        const int ax = halfSearchWindowSize + start_bx;
+                        const int ay = halfSearchWindowSize + start_by;
 
-                        const T *b_up_ptr = srcExtended_.ptr<T>(start_by + y);
-                        const T *b_down_ptr = srcExtended_.ptr<T>(start_by + y + blockSize);
+                        const T a_up = srcExtended_.at<T>(ay, ax);
+                        const T a_down = srcExtended_.at<T>(ay + blockSize, ax);
 
-                        for (TT x = 0; x < searchWindowSize; x++)
+                        for (TT y = 0; y < searchWindowSize; y++)
                         {
-                            // Remove from current pixel sum column sum with index "firstColNum"
-                            distSumsRow[x] -= colDistSumsRow[x];
-
-                            const int bx = start_bx + x;
-                            colDistSumsRow[x] = lastColDistSumsRow[x] +
-                                D::template calcUpDownDist<T>(a_up, a_down, b_up_ptr[bx], b_down_ptr[bx]);
-
-                            distSumsRow[x] += colDistSumsRow[x];
-                            lastColDistSumsRow[x] = colDistSumsRow[x];
-
-                            if (x == halfSearchWindowSize && y == halfSearchWindowSize)
-                                continue;
-
-                            // Save the distance, coordinate and increase the counter
-                            if (distSumsRow[x] < hBM)
-                                bm[elementSize++](distSumsRow[x], x, y);
+                            int *distSumsRow = distSums.row_ptr(y);
+                            int *colDistSumsRow = colDistSums.row_ptr(firstColNum, y);
+                            int *lastColDistSumsRow = lastColDistSums.row_ptr(i - col_from, y);
+
+                            const T *b_up_ptr = srcExtended_.ptr<T>(start_by + y) + start_bx;
+                            const T *b_down_ptr = srcExtended_.ptr<T>(start_by + y + blockSize) + start_bx;
+
+                            // Remove from current pixel sum column sum with index "firstColNum" and add the moved one
+                            updateDistSums<D, T>(
+                                distSumsRow, colDistSumsRow, lastColDistSumsRow,
+                                a_up, a_down, b_up_ptr, b_down_ptr, searchWindowSize);
+
+                            for (TT x = 0; x < searchWindowSize; x++)
+                            {
+                                if (x == halfSearchWindowSize && y == halfSearchWindowSize)
+                                    continue;
+
+                                // Save the distance, coordinate and increase the counter
+                                if (distSumsRow[x] < hBM)
+                                    bm[elementSize++](distSumsRow[x], x, y);
+                            }
                         }
                     }
-                }
 
-                firstColNum = (firstColNum + 1) % blockSize;
-            }
+                    firstColNum = (firstColNum + 1) % blockSize;
+                }
 
-            // Sort bm by distance (first element is already sorted)
-            std::sort(bm + 1, bm + elementSize);
+                // Sort bm by distance (first element is already sorted)
+                std::sort(bm + 1, bm + elementSize);
 
-            // Find the nearest power of 2 and cap the group size from the top
-            elementSize = getLargestPowerOf2SmallerThan(elementSize);
-            if (elementSize > groupSize)
-                elementSize = groupSize;
+                // Find the nearest power of 2 and cap the group size from the top
+                elementSize = getLargestPowerOf2SmallerThan(elementSize);
+                if (elementSize > groupSize)
+                    elementSize = groupSize;
 
-            // Transform 2D patches
-            for (int n = 0; n < elementSize; ++n)
-            {
-                const T *candidatePatch = currentPixel + step * bm[n].coord_y + bm[n].coord_x;
-                TC::forwardTransform2D(candidatePatch, bm[n].data(), step, blockSize);
-            }
-
-            // Transform and shrink 1D columns
-            TT sumNonZero = 0;
-            TT *thrMapPtr1D = thrMap_ + (elementSize - 1) * blockSizeSq;
-            switch (elementSize)
-            {
-            case 16:
-                for (int n = 0; n < blockSizeSq; n++)
+                // Transform 2D patches
+                for (int n = 0; n < elementSize; ++n)
                 {
-                    TC::forwardTransform16(bm, n);
-                    sumNonZero += HardThreshold<16>(bm, n, thrMapPtr1D);
-                    TC::inverseTransform16(bm, n);
+                    const T *candidatePatch = currentPixel + step * bm[n].coord_y + bm[n].coord_x;
+                    TC::forwardTransform2D(candidatePatch, bm[n].data(), step, blockSize);
                 }
-                break;
-            case 8:
-                for (int n = 0; n < blockSizeSq; n++)
-                {
-                    TC::forwardTransform8(bm, n);
-                    sumNonZero += HardThreshold<8>(bm, n, thrMapPtr1D);
-                    TC::inverseTransform8(bm, n);
-                }
-                break;
-            case 4:
-                for (int n = 0; n < blockSizeSq; n++)
-                {
-                    TC::forwardTransform4(bm, n);
-                    sumNonZero += HardThreshold<4>(bm, n, thrMapPtr1D);
-                    TC::inverseTransform4(bm, n);
-                }
-                break;
-            case 2:
-                for (int n = 0; n < blockSizeSq; n++)
-                {
-                    TC::forwardTransform2(bm, n);
-                    TC::forwardTransform2(bm, n);
-                    sumNonZero += HardThreshold<2>(bm, n, thrMapPtr1D);
-                    TC::inverseTransform2(bm, n);
-                }
-                break;
-            case 1:
+
+                // Transform and shrink 1D columns
+                TT sumNonZero = 0;
+                TT *thrMapPtr1D = thrMap_ + (elementSize - 1) * blockSizeSq;
+                switch (elementSize)
                 {
-                    TT *block = bm[0].data();
+                case 16:
                     for (int n = 0; n < blockSizeSq; n++)
-                        shrink(block[n], sumNonZero, *thrMapPtr1D++);
-                }
-                break;
-            default:
-                for (int n = 0; n < blockSizeSq; n++)
-                {
-                    TC::forwardTransformN(bm, n, elementSize);
-                    sumNonZero += HardThreshold(bm, n, thrMapPtr1D, elementSize);
-                    TC::inverseTransformN(bm, n, elementSize);
+                    {
+                        TC::forwardTransform16(bm, n);
+                        sumNonZero += HardThreshold<16>(bm, n, thrMapPtr1D);
+                        TC::inverseTransform16(bm, n);
+                    }
+                    break;
+                case 8:
+                    for (int n = 0; n < blockSizeSq; n++)
+                    {
+                        TC::forwardTransform8(bm, n);
+                        sumNonZero += HardThreshold<8>(bm, n, thrMapPtr1D);
+                        TC::inverseTransform8(bm, n);
+                    }
+                    break;
+                case 4:
+                    for (int n = 0; n < blockSizeSq; n++)
+                    {
+                        TC::forwardTransform4(bm, n);
+                        sumNonZero += HardThreshold<4>(bm, n, thrMapPtr1D);
+                        TC::inverseTransform4(bm, n);
+                    }
+                    break;
+                case 2:
+                    for (int n = 0; n < blockSizeSq; n++)
+                    {
+                        TC::forwardTransform2(bm, n);
+                        TC::forwardTransform2(bm, n);
+                        sumNonZero += HardThreshold<2>(bm, n, thrMapPtr1D);
+                        TC::inverseTransform2(bm, n);
+                    }
+                    break;
+                case 1:
+                    {
+                        TT *block = bm[0].data();
+                        for (int n = 0; n < blockSizeSq; n++)
+                            shrink(block[n], sumNonZero, *thrMapPtr1D++);
+                    }
+                    break;
+                default:
+                    for (int n = 0; n < blockSizeSq; n++)
+                    {
+                        TC::forwardTransformN(bm, n, elementSize);
+                        sumNonZero += HardThreshold(bm, n, thrMapPtr1D, elementSize);
+                        TC::inverseTransformN(bm, n, elementSize);
+                    }
                 }
-            }
 
-            // Inverse 2D transform
-            for (int n = 0; n < elementSize; ++n)
-                TC::inverseTransform2D(bm[n].data(), blockSize);
+                // Inverse 2D transform
+                for (int n = 0; n < elementSize; ++n)
+                    TC::inverseTransform2D(bm[n].data(), blockSize);
 
-            // Aggregate the results (increase sumNonZero to avoid division by zero)
-            float weight = 1.0f / (float)(++sumNonZero);
+                // Aggregate the results (increase sumNonZero to avoid division by zero)
+                float weight = 1.0f / (float)(++sumNonZero);
 
-            // Scale weight by element size
-            weight *= elementSize;
-            weight /= groupSize;
+                // Scale weight by element size
+                weight *= elementSize;
+                weight /= groupSize;
 
-            // Put patches back to their original positions
-            WT *dstPtr = weightedSum.data() + jj * dstStep + i;
-            WT *weiPtr = weights.data() + jj * dstStep + i;
-            const float *kaiser = kaiser_;
+                // Put patches back to their original positions
+                WT *dstPtr = weightedSum.data() + jj * dstStep + i;
+                WT *weiPtr = weights.data() + jj * dstStep + i;
+                const float *kaiser = kaiser_;
 
-            for (int l = 0; l < elementSize; ++l)
-            {
-                const TT *block = bm[l].data();
-                int offset = bm[l].coord_y * dstStep + bm[l].coord_x;
-                WT *d = dstPtr + offset;
-                WT *dw = weiPtr + offset;
-
-                for (int n = 0; n < blockSize; ++n)
+                for (int l = 0; l < elementSize; ++l)
                 {
-                    for (int m = 0; m < blockSize; ++m)
+                    const TT *block = bm[l].data();
+                    int offset = bm[l].coord_y * dstStep + bm[l].coord_x;
+                    WT *d = dstPtr + offset;
+                    WT *dw = weiPtr + offset;
+
+                    for (int n = 0; n < blockSize; ++n)
                     {
-                        unsigned idx = n * blockSize + m;
-                        *d += kaiser[idx] * block[idx] * weight;
-                        *dw += kaiser[idx] * weight;
-                        ++d, ++dw;
+                        for (int m = 0; m < blockSize; ++m)
+                        {
+                            unsigned idx = n * blockSize + m;
+                            *d += kaiser[idx] * block[idx] * weight;
+                            *dw += kaiser[idx] * weight;
+                            ++d, ++dw;
+                        }
+                        d += dstcstep;
+                        dw += weicstep;
                     }
-                    d += dstcstep;
-                    dw += weicstep;
                 }
-            }
-        } // i
-    } // j
+            } // i
+        } // j
+    } // col_from
 
     // Cleanup
     for (int i = 0; i < searchWindowSizeSq; ++i)
@@ -410,13 +413,14 @@ void Bm3dDenoisingInvokerStep1<T, D, WT, TT, TC>::operator() (const Range& range
 template <typename T, typename D, typename WT, typename TT, typename TC>
 inline void Bm3dDenoisingInvokerStep1<T, D, WT, TT, TC>::calcDistSumsForFirstElementInRow(
     int i,
+    int col_from,
     Array2d<int>& distSums,
     Array3d<int>& colDistSums,
     Array3d<int>& lastColDistSums,
     BlockMatch<TT, int, TT> *bm,
     int &elementSize) const
 {
-    int j = 0;
+    int j = col_from;
     const int hBM = hBM_;
     const int blockSize = templateWindowSize_;
     const int searchWindowSize = searchWindowSize_;
@@ -450,7 +454,7 @@ inline void Bm3dDenoisingInvokerStep1<T, D, WT, TT, TC>::calcDistSumsForFirstEle
                     colDistSums[tx][y][x] += dist;
                 }
 
-            lastColDistSums[j][y][x] = colDistSums[blockSize - 1][y][x];
+            lastColDistSums[0][y][x] = colDistSums[blockSize - 1][y][x];
 
             if (x == halfSearchWindowSize && y == halfSearchWindowSize)
                 continue;
@@ -465,6 +469,7 @@ template <typename T, typename D, typename WT, typename TT, typename TC>
 inline void Bm3dDenoisingInvokerStep1<T, D, WT, TT, TC>::calcDistSumsForAllElementsInFirstRow(
     int i,
     int j,
+    int col_from,
     int firstColNum,
     Array2d<int>& distSums,
     Array3d<int>& colDistSums,
@@ -500,7 +505,7 @@ inline void Bm3dDenoisingInvokerStep1<T, D, WT, TT, TC>::calcDistSumsForAllEleme
                     bx);
 
             distSums[y][x] += colDistSums[firstColNum][y][x];
-            lastColDistSums[j][y][x] = colDistSums[firstColNum][y][x];
+            lastColDistSums[j - col_from][y][x] = colDistSums[firstColNum][y][x];
 
             if (x == halfSearchWindowSize && y == halfSearchWindowSize)
                 continue;
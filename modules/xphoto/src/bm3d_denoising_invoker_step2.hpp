@@ -76,6 +76,7 @@ private:
 
     void calcDistSumsForFirstElementInRow(
         int i,
+        int col_from,
         Array2d<int>& distSums,
         Array3d<int>& colDistSums,
         Array3d<int>& lastColDistSums,
@@ -85,6 +86,7 @@ private:
     void calcDistSumsForAllElementsInFirstRow(
         int i,
         int j,
+        int col_from,
         int firstColNum,
         Array2d<int>& distSums,
         Array3d<int>& colDistSums,
@@ -223,190 +225,191 @@ void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::operator() (const Range& range
     // Sums of columns for current pixel (for lazy calc optimization)
     Array3d<int> colDistSums(blockSize, searchWindowSize, searchWindowSize);
 
-    // Last elements of column sum (for each element in a row)
-    Array3d<int> lastColDistSums(src_.cols, searchWindowSize, searchWindowSize);
+    // Last elements of column sum (for each element in a row of the current tile)
+    const int tileCols = getBm3dTileCols(src_.cols, searchWindowSizeSq, slidingStep_);
+    Array3d<int> lastColDistSums(tileCols, searchWindowSize, searchWindowSize);
 
-    int firstColNum = -1;
-    for (int j = row_from, jj = 0; j <= row_to; j += slidingStep_, jj += slidingStep_)
+    // The rows are processed in tiles of columns, so the scratch memory does not grow with the image width
+    for (int col_from = 0; col_from < src_.cols; col_from += tileCols)
     {
-        for (int i = 0; i < src_.cols; i += slidingStep_)
+        const int col_to = std::min(col_from + tileCols, src_.cols);
+        int firstColNum = -1;
+        for (int j = row_from, jj = 0; j <= row_to; j += slidingStep_, jj += slidingStep_)
         {
-            const T *currentPixelSrc = srcExtended_.ptr<T>(0) + step*j + i;
-            const T *currentPixelBasic = basicExtended_.ptr<T>(0) + step*j + i;
+            for (int i = col_from; i < col_to; i += slidingStep_)
+            {
+                const T *currentPixelSrc = srcExtended_.ptr<T>(0) + step*j + i;
+                const T *currentPixelBasic = basicExtended_.ptr<T>(0) + step*j + i;
 
-            int elementSize = 1;
+                int elementSize = 1;
 
-            // Calculate distSums using moving average filter approach.
-            if (i == 0)
-            {
-                // Calculate distSums for the first element in a row
-                calcDistSumsForFirstElementInRow(j, distSums, colDistSums, lastColDistSums, bmBasic, elementSize);
-                firstColNum = 0;
-            }
-            else
-            {
-                if (j == row_from)
+                // Calculate distSums using moving average filter approach.
+                if (i == col_from)
                 {
-                    // Calculate distSums for all elements in the first row
-                    calcDistSumsForAllElementsInFirstRow(
-                        j, i, firstColNum, distSums, colDistSums, lastColDistSums, bmBasic, elementSize);
+                    // Calculate distSums for the first element in a row
+                    calcDistSumsForFirstElementInRow(j, col_from, distSums, colDistSums, lastColDistSums, bmBasic, elementSize);
+                    firstColNum = 0;
                 }
                 else
                 {
-                    const int start_bx = blockSize + i - 1;
-                    const int start_by = j - 1;
-                    const int ax = halfSearchWindowSize + start_bx;
-                    const int ay = halfSearchWindowSize + start_by;
-
-                    const T a_up = basicExtended_.at<T>(ay, ax);
-                    const T a_down = basicExtended_.at<T>(ay + blockSize, ax);
-
-                    for (TT y = 0; y < searchWindowSize; y++)
+                    if (j == row_from)
                     {
-                        int *distSumsRow = distSums.row_ptr(y);
-                        int *colDistSumsRow = colDistSums.row_ptr(firstColNum, y);
-                        int *lastColDistSumsRow = lastColDistSums.row_ptr(i, y);
+                        // Calculate distSums for all elements in the first row
+                        calcDistSumsForAllElementsInFirstRow(
+                            j, i, col_from, firstColNum, distSums, colDistSums, lastColDistSums, bmBasic, elementSize);
+                    }
+                    else
+                    {
+                        const int start_bx = blockSize + i - 1;
+                        const int start_by = j - 1;
+                        const int ax = halfSearchWindowSize + start_bx;
+                        const int ay = halfSearchWindowSize + start_by;
 
-                        const T *b_up_ptr = basicExtended_.ptr<T>(start_by + y);
-                        const T *b_down_ptr = basicExtended_.ptr<T>(start_by + y + blockSize);
+                        const T a_up = basicExtended_.at<T>(ay, ax);
+                        const T a_down = basicExtended_.at<T>(ay + blockSize, ax);
 
-                        for (TT x = 0; x < searchWindowSize; x++)
+                        for (TT y = 0; y < searchWindowSize; y++)
                         {
-                            // Remove from current pixel sum column sum with index "firstColNum"
-                            distSumsRow[x] -= colDistSumsRow[x];
-
-                            const int bx = start_bx + x;
-                            colDistSumsRow[x] = lastColDistSumsRow[x] +
-                                D::template calcUpDownDist<T>(a_up, a_down, b_up_ptr[bx], b_down_ptr[bx]);
-
-                            distSumsRow[x] += colDistSumsRow[x];
-                            lastColDistSumsRow[x] = colDistSumsRow[x];
-
-                            if (x == halfSearchWindowSize && y == halfSearchWindowSize)
-                                continue;
-
-                            // Save the distance, coordinate and increase the counter
-                            if (distSumsRow[x] < hBM)
-                                bmBasic[elementSize++](distSumsRow[x], x, y);
+                            int *distSumsRow = distSums.row_ptr(y);
+                            int *colDistSumsRow = colDistSums.row_ptr(firstColNum, y);
+                            int *lastColDistSumsRow = lastColDistSums.row_ptr(i - col_from, y);
+
+                            const T *b_up_ptr = basicExtended_.ptr<T>(start_by + y) + start_bx;
+                            const T *b_down_ptr = basicExtended_.ptr<T>(start_by + y + blockSize) + start_bx;
+
+                            // Remove from current pixel sum column sum with index "firstColNum" and add the moved one
+                            updateDistSums<D, T>(
+                                distSumsRow, colDistSumsRow, lastColDistSumsRow,
+                                a_up, a_down, b_up_ptr, b_down_ptr, searchWindowSize);
+
+                            for (TT x = 0; x < searchWindowSize; x++)
+                            {
+                                if (x == halfSearchWindowSize && y == halfSearchWindowSize)
+                                    continue;
+
+                                // Save the distance, coordinate and increase the counter
+                                if (distSumsRow[x] < hBM)
+                                    bmBasic[elementSize++](distSumsRow[x], x, y);
+                            }
                         }
                     }
-                }
 
-                firstColNum = (firstColNum + 1) % blockSize;
-            }
+                    firstColNum = (firstColNum + 1) % blockSize;
+                }
 
-            // Sort bmBasic by distance (first element is already sorted)
-            std::sort(bmBasic + 1, bmBasic + elementSize);
+                // Sort bmBasic by distance (first element is already sorted)
+                std::sort(bmBasic + 1, bmBasic + elementSize);
 
-            // Find the nearest power of 2 and cap the group size from the top
-            elementSize = getLargestPowerOf2SmallerThan(elementSize);
-            if (elementSize > groupSize)
-                elementSize = groupSize;
+                // Find the nearest power of 2 and cap the group size from the top
+                elementSize = getLargestPowerOf2SmallerThan(elementSize);
+                if (elementSize > groupSize)
+                    elementSize = groupSize;
 
-            // Transform 2D patches
-            for (int n = 0; n < elementSize; ++n)
-            {
-                const T *candidatePatchSrc = currentPixelSrc + step * bmBasic[n].coord_y + bmBasic[n].coord_x;
-                const T *candidatePatchBasic = currentPixelBasic + step * bmBasic[n].coord_y + bmBasic[n].coord_x;
-                TC::forwardTransform2D(candidatePatchSrc, bmSrc[n].data(), step, blockSize);
-                TC::forwardTransform2D(candidatePatchBasic, bmBasic[n].data(), step, blockSize);
-            }
-
-            // Transform and shrink 1D columns
-            int wienerCoefficients = 0;
-            TT *thrMapPtr1D = thrMap_ + (elementSize - 1) * blockSizeSq;
-            switch (elementSize)
-            {
-            case 16:
-                for (int n = 0; n < blockSizeSq; n++)
+                // Transform 2D patches
+                for (int n = 0; n < elementSize; ++n)
                 {
-                    TC::forwardTransform16(bmSrc, n);
-                    TC::forwardTransform16(bmBasic, n);
-                    wienerCoefficients += WienerFiltering<16>(bmSrc, bmBasic, n, thrMapPtr1D);
-                    TC::inverseTransform16(bmBasic, n);
+                    const T *candidatePatchSrc = currentPixelSrc + step * bmBasic[n].coord_y + bmBasic[n].coord_x;
+                    const T *candidatePatchBasic = currentPixelBasic + step * bmBasic[n].coord_y + bmBasic[n].coord_x;
+                    TC::forwardTransform2D(candidatePatchSrc, bmSrc[n].data(), step, blockSize);
+                    TC::forwardTransform2D(candidatePatchBasic, bmBasic[n].data(), step, blockSize);
                 }
-                break;
-            case 8:
-                for (int n = 0; n < blockSizeSq; n++)
-                {
-                    TC::forwardTransform8(bmSrc, n);
-                    TC::forwardTransform8(bmBasic, n);
-                    wienerCoefficients += WienerFiltering<8>(bmSrc, bmBasic, n, thrMapPtr1D);
-                    TC::inverseTransform8(bmBasic, n);
-                }
-                break;
-            case 4:
-                for (int n = 0; n < blockSizeSq; n++)
+
+                // Transform and shrink 1D columns
+                int wienerCoefficients = 0;
+                TT *thrMapPtr1D = thrMap_ + (elementSize - 1) * blockSizeSq;
+                switch (elementSize)
                 {
-                    TC::forwardTransform4(bmSrc, n);
-                    TC::forwardTransform4(bmBasic, n);
-                    wienerCoefficients += WienerFiltering<4>(bmSrc, bmBasic, n, thrMapPtr1D);
-                    TC::inverseTransform4(bmBasic, n);
-                }
-                break;
-            case 2:
-                for (int n = 0; n < blockSizeSq; n++)
+                case 16:
+                    for (int n = 0; n < blockSizeSq; n++)
+                    {
+                        TC::forwardTransform16(bmSrc, n);
+                        TC::forwardTransform16(bmBasic, n);
+                        wienerCoefficients += WienerFiltering<16>(bmSrc, bmBasic, n, thrMapPtr1D);
+                        TC::inverseTransform16(bmBasic, n);
+                    }
+                    break;
+                case 8:
+                    for (int n = 0; n < blockSizeSq; n++)
+                    {
+                        TC::forwardTransform8(bmSrc, n);
+                        TC::forwardTransform8(bmBasic, n);
+                        wienerCoefficients += WienerFiltering<8>(bmSrc, bmBasic, n, thrMapPtr1D);
+                        TC::inverseTransform8(bmBasic, n);
+                    }
+                    break;
+                case 4:
+                    for (int n = 0; n < blockSizeSq; n++)
+                    {
+                        TC::forwardTransform4(bmSrc, n);
+                        TC::forwardTransform4(bmBasic, n);
+                        wienerCoefficients += WienerFiltering<4>(bmSrc, bmBasic, n, thrMapPtr1D);
+                        TC::inverseTransform4(bmBasic, n);
+                    }
+                    break;
+                case 2:
+                    for (int n = 0; n < blockSizeSq; n++)
+                    {
+                        TC::forwardTransform2(bmSrc, n);
+                        TC::forwardTransform2(bmBasic, n);
+                        wienerCoefficients += WienerFiltering<2>(bmSrc, bmBasic, n, thrMapPtr1D);
+                        TC::inverseTransform2(bmBasic, n);
+                    }
+                    break;
+                case 1:
                 {
-                    TC::forwardTransform2(bmSrc, n);
-                    TC::forwardTransform2(bmBasic, n);
-                    wienerCoefficients += WienerFiltering<2>(bmSrc, bmBasic, n, thrMapPtr1D);
-                    TC::inverseTransform2(bmBasic, n);
+                    for (int n = 0; n < blockSizeSq; n++)
+                        wienerCoefficients += WienerFiltering<1>(bmSrc, bmBasic, n, thrMapPtr1D);
                 }
                 break;
-            case 1:
-            {
-                for (int n = 0; n < blockSizeSq; n++)
-                    wienerCoefficients += WienerFiltering<1>(bmSrc, bmBasic, n, thrMapPtr1D);
-            }
-            break;
-            default:
-                for (int n = 0; n < blockSizeSq; n++)
-                {
-                    TC::forwardTransformN(bmSrc, n, elementSize);
-                    TC::forwardTransformN(bmBasic, n, elementSize);
-                    wienerCoefficients += WienerFiltering(bmSrc, bmBasic, n, thrMapPtr1D, elementSize);
-                    TC::inverseTransformN(bmBasic, n, elementSize);
+                default:
+                    for (int n = 0; n < blockSizeSq; n++)
+                    {
+                        TC::forwardTransformN(bmSrc, n, elementSize);
+                        TC::forwardTransformN(bmBasic, n, elementSize);
+                        wienerCoefficients += WienerFiltering(bmSrc, bmBasic, n, thrMapPtr1D, elementSize);
+                        TC::inverseTransformN(bmBasic, n, elementSize);
+                    }
                 }
-            }
 
-            // Inverse 2D transform
-            for (int n = 0; n < elementSize; ++n)
-                TC::inverseTransform2D(bmBasic[n].data(), blockSize);
+                // Inverse 2D transform
+                for (int n = 0; n < elementSize; ++n)
+                    TC::inverseTransform2D(bmBasic[n].data(), blockSize);
 
-            // Aggregate the results (increase sumNonZero to avoid division by zero)
-            float weight = 1.0f / (float)(++wienerCoefficients);
+                // Aggregate the results (increase sumNonZero to avoid division by zero)
+                float weight = 1.0f / (float)(++wienerCoefficients);
 
-            // Scale weight by element size
-            weight *= elementSize;
-            weight /= groupSize;
+                // Scale weight by element size
+                weight *= elementSize;
+                weight /= groupSize;
 
-            // Put patches back to their original positions
-            WT *dstPtr = weightedSum.data() + jj * dstStep + i;
-            WT *weiPtr = weights.data() + jj * dstStep + i;
-            const float *kaiser = kaiser_;
+                // Put patches back to their original positions
+                WT *dstPtr = weightedSum.data() + jj * dstStep + i;
+                WT *weiPtr = weights.data() + jj * dstStep + i;
+                const float *kaiser = kaiser_;
 
-            for (int l = 0; l < elementSize; ++l)
-            {
-                const TT *block = bmBasic[l].data();
-                int offset = bmBasic[l].coord_y * dstStep + bmBasic[l].coord_x;
-                WT *d = dstPtr + offset;
-                WT *dw = weiPtr + offset;
-
-                for (int n = 0; n < blockSize; ++n)
+                for (int l = 0; l < elementSize; ++l)
                 {
-                    for (int m = 0; m < blockSize; ++m)
+                    const TT *block = bmBasic[l].data();
+                    int offset = bmBasic[l].coord_y * dstStep + bmBasic[l].coord_x;
+                    WT *d = dstPtr + offset;
+                    WT *dw = weiPtr + offset;
+
+                    for (int n = 0; n < blockSize; ++n)
                     {
-                        unsigned idx = n * blockSize + m;
-                        *d += kaiser[idx] * block[idx] * weight;
-                        *dw += kaiser[idx] * weight;
-                        ++d, ++dw;
+                        for (int m = 0; m < blockSize; ++m)
+                        {
+                            unsigned idx = n * blockSize + m;
+                            *d += kaiser[idx] * block[idx] * weight;
+                            *dw += kaiser[idx] * weight;
+                            ++d, ++dw;
+                        }
+                        d += dstcstep;
+                        dw += weicstep;
                     }
-                    d += dstcstep;
-                    dw += weicstep;
                 }
-            }
-        } // i
-    } // j
+            } // i
+        } // j
+    } // col_from
 
     // Cleanup
     for (int i = 0; i < searchWindowSizeSq; ++i)
@@ -433,13 +436,14 @@ void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::operator() (const Range& range
 template <typename T, typename D, typename WT, typename TT, typename TC>
 inline void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::calcDistSumsForFirstElementInRow(
     int i,
+    int col_from,
     Array2d<int>& distSums,
     Array3d<int>& colDistSums,
     Array3d<int>& lastColDistSums,
     BlockMatch<TT, int, TT> *bm,
     int &elementSize) const
 {
-    int j = 0;
+    int j = col_from;
     const int hBM = hBM_;
     const int blockSize = templateWindowSize_;
     const int searchWindowSize = searchWindowSize_;
@@ -473,7 +477,7 @@ inline void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::calcDistSumsForFirstEle
                     colDistSums[tx][y][x] += dist;
                 }
 
-            lastColDistSums[j][y][x] = colDistSums[blockSize - 1][y][x];
+            lastColDistSums[0][y][x] = colDistSums[blockSize - 1][y][x];
 
             if (x == halfSearchWindowSize && y == halfSearchWindowSize)
                 continue;
@@ -488,6 +492,7 @@ template <typename T, typename D, typename WT, typename TT, typename TC>
 inline void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::calcDistSumsForAllElementsInFirstRow(
     int i,
     int j,
+    int col_from,
     int firstColNum,
     Array2d<int>& distSums,
     Array3d<int>& colDistSums,
@@ -523,7 +528,7 @@ inline void Bm3dDenoisingInvokerStep2<T, D, WT, TT, TC>::calcDistSumsForAllEleme
                     bx);
 
             distSums[y][x] += colDistSums[firstColNum][y][x];
-            lastColDistSums[j][y][x] = colDistSums[firstColNum][y][x];
+            lastColDistSums[j - col_from][y][x] = colDistSums[firstColNum][y][x];
 
             if (x == halfSearchWindowSize && y == halfSearchWindowSize)
                 continue;
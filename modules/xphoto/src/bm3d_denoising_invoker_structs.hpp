@@ -42,6 +42,8 @@
 #ifndef __OPENCV_BM3D_DENOISING_INVOKER_STRUCTS_HPP__
 #define __OPENCV_BM3D_DENOISING_INVOKER_STRUCTS_HPP__
 
+#include "opencv2/core/hal/intrin.hpp"
+
 namespace cv
 {
 namespace xphoto
@@ -179,6 +181,15 @@ public:
         return calcDist<T>(a_down, b_down) - calcDist<T>(a_up, b_up);
     };
 
+#if CV_SIMD128
+    // Vector version of calcUpDownDist for 4 single channel pixels
+    static inline v_int32x4 calcUpDownDist(
+        const v_int32x4& a_up, const v_int32x4& a_down, const v_int32x4& b_up, const v_int32x4& b_down)
+    {
+        return v_reinterpret_as_s32(v_abs(a_down - b_down)) - v_reinterpret_as_s32(v_abs(a_up - b_up));
+    }
+#endif
+
     template <typename T>
     static inline T calcBlockMatchingThreshold(const T &blockMatchThrL2, const T &blockSizeSq)
     {
@@ -273,6 +284,17 @@ public:
         return calcUpDownDist_<T>::f(a_up, a_down, b_up, b_down);
     };
 
+#if CV_SIMD128
+    // Vector version of calcUpDownDist for 4 single channel pixels
+    static inline v_int32x4 calcUpDownDist(
+        const v_int32x4& a_up, const v_int32x4& a_down, const v_int32x4& b_up, const v_int32x4& b_down)
+    {
+        v_int32x4 A = a_down - b_down;
+        v_int32x4 B = a_up - b_up;
+        return (A - B) * (A + B);
+    }
+#endif
+
     template <typename T>
     static inline T calcBlockMatchingThreshold(const T &blockMatchThrL2, const T &blockSizeSq)
     {
@@ -48,6 +48,7 @@
 
 #include "opencv2/core.hpp"
 #include "opencv2/core/core_c.h"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include "opencv2/core/types.hpp"
 #include "opencv2/core/types_c.h"
@@ -57,22 +58,79 @@ namespace cv
 namespace xphoto
 {
 
-    void grayDctDenoising(const Mat &, Mat &, const double, const int);
-    void rgbDctDenoising(const Mat &, Mat &, const double, const int);
-    void dctDenoising(const Mat &, Mat &, const double, const int);
+    void grayDctDenoising(const Mat &, Mat &, const double, const int, const int);
+    void rgbDctDenoising(const Mat &, Mat &, const double, const int, const int);
+    void dctDenoising(const Mat &, Mat &, const double, const int, const int);
 
 
+    /*! dst = a * b for psize x psize matrices, b is continuous */
+    static void mulPatch(const float *a, const size_t astep, const float *b, float *dst, const int n)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            const float *arow = a + i*astep;
+            float *drow = dst + i*n;
+            int j = 0;
+#if CV_SIMD128
+            for (; j <= n - v_float32x4::nlanes; j += v_float32x4::nlanes)
+            {
+                v_float32x4 sum = v_setzero_f32();
+                for (int k = 0; k < n; ++k)
+                    sum = v_muladd(v_setall_f32(arow[k]), v_load(b + k*n + j), sum);
+                v_store(drow + j, sum);
+            }
+#endif
+            for (; j < n; ++j)
+            {
+                float sum = 0.0f;
+                for (int k = 0; k < n; ++k)
+                    sum += arow[k] * b[k*n + j];
+                drow[j] = sum;
+            }
+        }
+    }
+
+    /*! top left corners of the patches along one axis, the last patch is always kept */
+    static std::vector <int> patchPositions(const int len, const int psize, const int step)
+    {
+        std::vector <int> pos;
+        for (int p = 0; p < len - psize; p += step)
+            pos.push_back(p);
+        if ( !pos.empty() && pos.back() != len - psize - 1 )
+            pos.push_back(len - psize - 1);
+        return pos;
+    }
+
+    /*! number of patches covering each pixel along one axis */
+    static std::vector <float> patchCounts(const std::vector <int> &pos, const int len, const int psize)
+    {
+        std::vector <float> counts(len, 0.0f);
+        for (size_t i = 0; i < pos.size(); ++i)
+            for (int k = 0; k < psize; ++k)
+                counts[pos[i] + k] += 1.0f;
+        return counts;
+    }
+
     struct grayDctDenoisingInvoker : public ParallelLoopBody
     {
     public:
-        grayDctDenoisingInvoker(const Mat &src, std::vector <Mat> &patches, const double sigma, const int psize);
+        grayDctDenoisingInvoker(const Mat &src, Mat &dst, const std::vector <int> &ys, const std::vector <int> &xs,
+                                const std::vector <int> &bands, const int parity, const Mat &dctMat,
+                                const double sigma, const int psize);
         ~grayDctDenoisingInvoker(){};
 
         void operator() (const Range &range) const CV_OVERRIDE;
 
     protected:
         const Mat &src;
-        std::vector <Mat> &patches; // image decomposition into sliding patches
+        Mat &dst; // sum of the filtered patches
+
+        const std::vector <int> &ys; // top of the patches
+        const std::vector <int> &xs; // left of the patches
+        const std::vector <int> &bands; // first index in ys of each band of rows
+        const int parity; // bands processed by this pass, the bands of the same parity do not overlap
+
+        const Mat &dctMat; // dct basis for the separable transform, empty to use cv::dct
 
         const int psize; // size of block to compute dct
         const double sigma; // expected noise standard deviation
@@ -81,59 +139,106 @@ namespace xphoto
         void operator =(const grayDctDenoisingInvoker&) const {};
     };
 
-    grayDctDenoisingInvoker::grayDctDenoisingInvoker(const Mat &_src, std::vector <Mat> &_patches,
-                                                     const double _sigma, const int _psize)
-        : src(_src), patches(_patches), psize(_psize), sigma(_sigma), thresh(3*_sigma) {}
+    grayDctDenoisingInvoker::grayDctDenoisingInvoker(const Mat &_src, Mat &_dst,
+                                                     const std::vector <int> &_ys, const std::vector <int> &_xs,
+                                                     const std::vector <int> &_bands, const int _parity,
+                                                     const Mat &_dctMat, const double _sigma, const int _psize)
+        : src(_src), dst(_dst), ys(_ys), xs(_xs), bands(_bands), parity(_parity), dctMat(_dctMat),
+          psize(_psize), sigma(_sigma), thresh(3*_sigma) {}
 
     void grayDctDenoisingInvoker::operator() (const Range &range) const
     {
-        for (int i = range.start; i <= range.end - 1; ++i)
-        {
-            int y = i / (src.cols - psize);
-            int x = i % (src.cols - psize);
-
-            Rect patchNum( x, y, psize, psize );
-
-            Mat patch(psize, psize, CV_32FC1);
-            src(patchNum).copyTo( patch );
+        const int n = psize;
+        Mat patch(psize, psize, CV_32FC1), tmp(psize, psize, CV_32FC1), dctMatT;
+        if ( !dctMat.empty() )
+            transpose(dctMat, dctMatT);
 
-            dct(patch, patch);
-            float *data = (float *) patch.data;
-            for (int k = 0; k < psize*psize; ++k)
-                data[k] *= fabs(data[k]) > thresh;
-            idct(patch, patches[i]);
+        for (int b = 2*range.start + parity; b < 2*range.end && b + 1 < (int)bands.size(); b += 2)
+        {
+            for (int i = bands[b]; i < bands[b + 1]; ++i)
+            {
+                for (size_t j = 0; j < xs.size(); ++j)
+                {
+                    Rect patchNum( xs[j], ys[i], psize, psize );
+
+                    if ( dctMat.empty() )
+                    {
+                        src(patchNum).copyTo( patch );
+                        dct(patch, patch);
+                    }
+                    else
+                    {
+                        // D * X * D^T
+                        mulPatch(src.ptr<float>(ys[i]) + xs[j], src.step1(), dctMatT.ptr<float>(), tmp.ptr<float>(), n);
+                        mulPatch(dctMat.ptr<float>(), n, tmp.ptr<float>(), patch.ptr<float>(), n);
+                    }
+
+                    float *data = (float *) patch.data;
+                    for (int k = 0; k < psize*psize; ++k)
+                        data[k] *= fabs(data[k]) > thresh;
+
+                    if ( dctMat.empty() )
+                    {
+                        idct(patch, patch);
+                    }
+                    else
+                    {
+                        // D^T * Y * D
+                        mulPatch(patch.ptr<float>(), n, dctMat.ptr<float>(), tmp.ptr<float>(), n);
+                        mulPatch(dctMatT.ptr<float>(), n, tmp.ptr<float>(), patch.ptr<float>(), n);
+                    }
+
+                    dst(patchNum) += patch;
+                }
+            }
         }
     }
 
-    void grayDctDenoising(const Mat &src, Mat &dst, const double sigma, const int psize)
+    void grayDctDenoising(const Mat &src, Mat &dst, const double sigma, const int psize, const int step)
     {
         CV_Assert( src.type() == CV_MAKE_TYPE(CV_32F, 1) );
+        CV_Assert( psize > 0 && step > 0 );
 
-        int npixels = (src.rows - psize)*(src.cols - psize);
-
-        std::vector <Mat> patches;
-        for (int i = 0; i < npixels; ++i)
-            patches.push_back( Mat(psize, psize, CV_32FC1) );
-        parallel_for_( cv::Range(0, npixels),
-            grayDctDenoisingInvoker(src, patches, sigma, psize) );
-
-        Mat res( src.size(), CV_32FC1, 0.0f ),
-            num( src.size(), CV_32FC1, 0.0f );
+        std::vector <int> ys = patchPositions(src.rows, psize, step),
+                          xs = patchPositions(src.cols, psize, step);
 
-        for (int k = 0; k < npixels; ++k)
+        // Orthonormal dct basis, the patches of small sizes are transformed as matrix products
+        Mat dctMat;
+        if ( psize <= 16 )
         {
-            int i = k / (src.cols - psize);
-            int j = k % (src.cols - psize);
+            dctMat.create(psize, psize, CV_32FC1);
+            for (int k = 0; k < psize; ++k)
+                for (int i = 0; i < psize; ++i)
+                    dctMat.at<float>(k, i) = (float)( std::sqrt((k == 0 ? 1.0 : 2.0) / psize)
+                        * std::cos(CV_PI * (2*i + 1) * k / (2.0 * psize)) );
+        }
 
-            res( Rect(j, i, psize, psize) ) += patches[k];
-            num( Rect(j, i, psize, psize) ) += Mat::ones(psize, psize, CV_32FC1);
+        // Bands of patch rows at least psize apart, so every other band can be aggregated in parallel
+        const int bandRows = 2*psize;
+        std::vector <int> bands;
+        for (int y = 0; bands.empty() || bands.back() < (int)ys.size(); y += bandRows)
+            bands.push_back( (int)(std::lower_bound(ys.begin(), ys.end(), y) - ys.begin()) );
+
+        Mat res( src.size(), CV_32FC1, 0.0f );
+        const int npairs = (int)bands.size() / 2;
+        for (int parity = 0; parity < 2; ++parity)
+            parallel_for_( cv::Range(0, npairs),
+                grayDctDenoisingInvoker(src, res, ys, xs, bands, parity, dctMat, sigma, psize) );
+
+        // Overlap-add weights are the number of patches covering a pixel
+        std::vector <float> cy = patchCounts(ys, src.rows, psize),
+                            cx = patchCounts(xs, src.cols, psize);
+        for (int i = 0; i < res.rows; ++i)
+        {
+            float *r = res.ptr<float>(i);
+            for (int j = 0; j < res.cols; ++j)
+                r[j] /= cy[i] * cx[j];
         }
-        res /= num;
 
         res.convertTo( dst, src.type() );
     }
 
-    void rgbDctDenoising(const Mat &src, Mat &dst, const double sigma, const int psize)
+    void rgbDctDenoising(const Mat &src, Mat &dst, const double sigma, const int psize, const int step)
     {
         CV_Assert( src.type() == CV_MAKE_TYPE(CV_32F, 3) );
 
@@ -147,7 +252,7 @@ namespace xphoto
         split(dst, mv);
 
         for (size_t i = 0; i < mv.size(); ++i)
-            grayDctDenoising(mv[i], mv[i], sigma, psize);
+            grayDctDenoising(mv[i], mv[i], sigma, psize, step);
 
         merge(mv, dst);
 
@@ -161,8 +266,9 @@ namespace xphoto
      *  \param dst : destination image
      *  \param sigma : expected noise standard deviation
      *  \param psize : size of block side where dct is computed
+     *  \param step : step of the sliding window
      */
-    void dctDenoising(const Mat &src, Mat &dst, const double sigma, const int psize)
+    void dctDenoising(const Mat &src, Mat &dst, const double sigma, const int psize, const int step)
     {
         CV_Assert( src.channels() == 3 || src.channels() == 1 );
 
@@ -171,9 +277,9 @@ namespace xphoto
         src.convertTo(img, xtype);
 
         if ( img.type() == CV_32FC3 )
-            rgbDctDenoising( img, img, sigma, psize );
+            rgbDctDenoising( img, img, sigma, psize, step );
         else if ( img.type() == CV_32FC1 )
-            grayDctDenoising( img, img, sigma, psize );
+            grayDctDenoising( img, img, sigma, psize, step );
         else
             CV_Error_( CV_StsNotImplemented,
             ("Unsupported source image format (=%d)", img.type()) );
@@ -39,7 +39,9 @@
 
 #include "opencv2/core.hpp"
 #include "opencv2/core/hal/intrin.hpp"
+#include "opencv2/imgproc.hpp"
 #include "opencv2/xphoto.hpp"
+#include <limits>
 
 namespace cv
 {
@@ -53,11 +55,36 @@ class GrayworldWBImpl CV_FINAL : public GrayworldWB
 {
   private:
     float thresh;
+    int subsampling_step;
+    float temporal_smoothing;
+
+    // gains of the previous image for the temporal smoothing, the state is valid for last_size and last_type
+    Vec3f last_gains;
+    Size last_size;
+    int last_type;
 
   public:
-    GrayworldWBImpl() { thresh = 0.9f; }
+    GrayworldWBImpl()
+    {
+        thresh = 0.9f;
+        subsampling_step = 1;
+        temporal_smoothing = 0.f;
+        last_type = -1;
+    }
     float getSaturationThreshold() const CV_OVERRIDE { return thresh; }
     void setSaturationThreshold(float val) CV_OVERRIDE { thresh = val; }
+    int getSubsamplingStep() const CV_OVERRIDE { return subsampling_step; }
+    void setSubsamplingStep(int val) CV_OVERRIDE
+    {
+        CV_Assert(val > 0);
+        subsampling_step = val;
+    }
+    float getTemporalSmoothing() const CV_OVERRIDE { return temporal_smoothing; }
+    void setTemporalSmoothing(float val) CV_OVERRIDE
+    {
+        CV_Assert(val >= 0.f && val < 1.f);
+        temporal_smoothing = val;
+    }
     void balanceWhite(InputArray _src, OutputArray _dst) CV_OVERRIDE
     {
         CV_Assert(!_src.empty());
@@ -65,21 +92,26 @@ class GrayworldWBImpl CV_FINAL : public GrayworldWB
         CV_Assert(_src.type() == CV_8UC3 || _src.type() == CV_16UC3);
         Mat src = _src.getMat();
 
-        int N = src.cols * src.rows, N3 = N * 3;
+        // Statistics on a grid of pixels
+        Mat stats = src;
+        if (subsampling_step > 1)
+            resize(src, stats, Size(), 1.0 / subsampling_step, 1.0 / subsampling_step, INTER_NEAREST);
+
+        int N = stats.cols * stats.rows, N3 = N * 3;
 
         double dsumB = 0.0, dsumG = 0.0, dsumR = 0.0;
-        if (src.type() == CV_8UC3)
+        if (stats.type() == CV_8UC3)
         {
             uint sumB = 0, sumG = 0, sumR = 0;
-            calculateChannelSums(sumB, sumG, sumR, src.ptr<uchar>(), N3, thresh);
+            calculateChannelSums(sumB, sumG, sumR, stats.ptr<uchar>(), N3, thresh);
             dsumB = (double)sumB;
             dsumG = (double)sumG;
             dsumR = (double)sumR;
         }
-        else if (src.type() == CV_16UC3)
+        else if (stats.type() == CV_16UC3)
         {
             uint64 sumB = 0, sumG = 0, sumR = 0;
-            calculateChannelSums(sumB, sumG, sumR, src.ptr<ushort>(), N3, thresh);
+            calculateChannelSums(sumB, sumG, sumR, stats.ptr<ushort>(), N3, thresh);
             dsumB = (double)sumB;
             dsumG = (double)sumG;
             dsumR = (double)sumR;
@@ -92,8 +124,16 @@ class GrayworldWBImpl CV_FINAL : public GrayworldWB
               dinvG = dsumG < eps ? 0.f : (float)(max_sum / dsumG),
               dinvR = dsumR < eps ? 0.f : (float)(max_sum / dsumR);
 
+        // Smooth the gains over the frames of a video
+        Vec3f gains(dinvB, dinvG, dinvR);
+        if (temporal_smoothing > 0.f && last_size == src.size() && last_type == src.type())
+            gains = temporal_smoothing * last_gains + (1.f - temporal_smoothing) * gains;
+        last_gains = gains;
+        last_size = src.size();
+        last_type = src.type();
+
         // Use the inverse of averages as channel gains:
-        applyChannelGains(src, _dst, dinvB, dinvG, dinvR);
+        applyChannelGains(src, _dst, gains[0], gains[1], gains[2]);
     }
 };
 
@@ -345,6 +385,65 @@ void applyChannelGains(InputArray _src, OutputArray _dst, float gainB, float gai
     }
 }
 
+template <typename T>
+static void applyChannelGainsLUT(const Mat &src, Mat &dst, const float gains[3], float gamma)
+{
+    const int max_val = std::numeric_limits<T>::max();
+    const double inv_gamma = 1.0 / gamma;
+    std::vector<T> lut(3 * (max_val + 1));
+    for (int v = 0; v <= max_val; v++)
+        for (int c = 0; c < 3; c++)
+            lut[3 * v + c] = saturate_cast<T>(max_val * std::pow(gains[c] * v / (double)max_val, inv_gamma));
+
+    if (src.depth() == CV_8U)
+    {
+        // cv::LUT maps every channel through its own table
+        LUT(src, Mat(1, max_val + 1, src.type(), &lut[0]), dst);
+        return;
+    }
+
+    parallel_for_(Range(0, src.rows), [&](const Range &range)
+    {
+        for (int y = range.start; y < range.end; y++)
+        {
+            const T *src_row = src.ptr<T>(y);
+            T *dst_row = dst.ptr<T>(y);
+            for (int x = 0; x < 3 * src.cols; x += 3)
+            {
+                dst_row[x] = lut[3 * src_row[x]];
+                dst_row[x + 1] = lut[3 * src_row[x + 1] + 1];
+                dst_row[x + 2] = lut[3 * src_row[x + 2] + 2];
+            }
+        }
+    });
+}
+
+void applyChannelGains(InputArray _src, OutputArray _dst, float gainB, float gainG, float gainR, float gamma)
+{
+    Mat src = _src.getMat();
+    CV_Assert(!src.empty());
+    CV_Assert(src.type() == CV_8UC3 || src.type() == CV_16UC3);
+    CV_Assert(gamma > 0);
+
+    _dst.create(src.size(), src.type());
+    Mat dst = _dst.getMat();
+
+    // Scale gains by their maximum, as the fixed point version does
+    float gain_max = max(gainB, max(gainG, gainR));
+    if (gain_max > 0)
+    {
+        gainB /= gain_max;
+        gainG /= gain_max;
+        gainR /= gain_max;
+    }
+    const float gains[3] = { gainB, gainG, gainR };
+
+    if (src.depth() == CV_8U)
+        applyChannelGainsLUT<uchar>(src, dst, gains, gamma);
+    else
+        applyChannelGainsLUT<ushort>(src, dst, gains, gamma);
+}
+
 Ptr<GrayworldWB> createGrayworldWB() { return makePtr<GrayworldWBImpl>(); }
 }
 }
@@ -93,7 +93,22 @@ icvStandardDeviation(const Mat& distorted_block_2d, const Mat& error_mask_2d) {
 }
 
 static void
-icvExtrapolateBlock(Mat& distorted_block, Mat& error_mask, fsr_parameters& fsr_params, double rho, double normedStdDev, Mat& extrapolated_block)
+icvFrequencyWeighting(const int fft_size, Mat& frequency_weighting)
+{
+    frequency_weighting = Mat::ones(fft_size, fft_size / 2 + 1, CV_64F);
+    for (int y = 0; y < fft_size; ++y)
+    {
+        for (int x = 0; x < (fft_size / 2 + 1); ++x)
+        {
+            double y2 = fft_size / 2 - std::abs(y - fft_size / 2);
+            double x2 = fft_size / 2 - std::abs(x - fft_size / 2);
+            frequency_weighting.at<double>(y, x) = 1 - std::sqrt(x2*x2 + y2 * y2)*std::sqrt(2) / fft_size;
+        }
+    }
+}
+
+static void
+icvExtrapolateBlock(Mat& distorted_block, Mat& error_mask, const fsr_parameters& fsr_params, const Mat& frequency_weighting, double rho, double normedStdDev, Mat& extrapolated_block)
 {
     double fft_size = fsr_params.fft_size;
     double orthogonality_correction = fsr_params.orthogonality_correction;
@@ -118,17 +133,6 @@ icvExtrapolateBlock(Mat& distorted_block, Mat& error_mask, fsr_parameters& fsr_p
     hconcat(W, W, W_padded);
     vconcat(W_padded, W_padded, W_padded);
 
-    // frequency weighting
-    Mat frequency_weighting = Mat::ones(fsr_params.fft_size, fsr_params.fft_size / 2 + 1, CV_64F);
-    for (int y = 0; y < fft_size; ++y)
-    {
-        for (int x = 0; x < (fft_size / 2 + 1); ++x)
-        {
-            double y2 = fft_size / 2 - std::abs(y - fft_size / 2);
-            double x2 = fft_size / 2 - std::abs(x - fft_size / 2);
-            frequency_weighting.at<double>(y, x) = 1 - std::sqrt(x2*x2 + y2 * y2)*std::sqrt(2) / fft_size;
-        }
-    }
     // pad image to fft window size
     Mat f(Size(fsr_params.fft_size, fsr_params.fft_size), CV_64F, Scalar::all(0));
     distorted_block.copyTo(f(Range(fft_y_offset, fft_y_offset + M), Range(fft_x_offset, fft_x_offset + N)));
@@ -383,6 +387,8 @@ icvDetermineProcessingOrder(
     double conc_weighting = fsr_params.conc_weighting;
     int fft_size = fsr_params.fft_size;
     double rho = fsr_params.rhos[0];
+    Mat frequency_weighting;
+    icvFrequencyWeighting(fft_size, frequency_weighting);
     Mat sampled_img, sampling_mask;
     _sampled_img.convertTo(sampled_img, CV_64F);
     reconstructed_img = sampled_img.clone();
@@ -650,36 +656,74 @@ icvDetermineProcessingOrder(
             {
                 all_blocks_finished = 1;
             }
-            // blockwise extrapolation of all blocks that can be processed in parallel
+            // blockwise extrapolation of all blocks that can be processed in parallel:
+            // a block joins the first wave after all the earlier blocks of the list whose pixels it reads
+            // or which read its pixels, so the waves give the same result as the blocks in list order
+            const int reach = border_width > 0 ? divUp(border_width, block_size) : 0;
+            Mat_<int> block_wave(blocks_per_column, blocks_per_line, -1);
+            std::vector< std::vector<int> > waves;
             for (bl_counter = 0; bl_counter < max_bl_counter; ++bl_counter)
             {
                 int yblock_counter = std::get<0>(block_list[bl_counter]);
                 int xblock_counter = std::get<1>(block_list[bl_counter]);
+                int wave = 0;
+                for (int y = std::max(0, yblock_counter - reach); y <= std::min(blocks_per_column - 1, yblock_counter + reach); ++y)
+                {
+                    for (int x = std::max(0, xblock_counter - reach); x <= std::min(blocks_per_line - 1, xblock_counter + reach); ++x)
+                    {
+                        wave = std::max(wave, block_wave(y, x) + 1);
+                    }
+                }
+                block_wave(yblock_counter, xblock_counter) = wave;
+                if (wave == (int)waves.size())
+                {
+                    waves.push_back(std::vector<int>());
+                }
+                waves[wave].push_back(bl_counter);
+            }
 
-                // calculation of the extrapolation area's borders
-                int left_border = std::min(xblock_counter*block_size, border_width);
-                int top_border = std::min(yblock_counter*block_size, border_width);
-                int right_border = std::max(0, std::min(img_width - (xblock_counter + 1)*block_size, border_width));
-                int bottom_border = std::max(0, std::min(img_height - (yblock_counter + 1)*block_size, border_width));
-
-                // extract blocks from images
-                Mat distorted_block_2d = reconstructed_img(Range(yblock_counter*block_size - top_border, std::min(img_height, (yblock_counter*block_size + block_size + bottom_border))), Range(xblock_counter*block_size - left_border, std::min(img_width, (xblock_counter*block_size + block_size + right_border))));
-                Mat error_mask_2d = sampling_mask(Range(yblock_counter*block_size - top_border, std::min(img_height, (yblock_counter*block_size + block_size + bottom_border))), Range(xblock_counter*block_size - left_border, std::min(img_width, xblock_counter*block_size + block_size + right_border)));
-                // get actual stddev value as it is needed to estimate the
-                // best number of iterations
-                double sigma_n_a = sigma_n_array.at<double>(yblock_counter, xblock_counter);
-
-                // actual extrapolation
-                Mat extrapolated_block_2d;
-                icvExtrapolateBlock(distorted_block_2d, error_mask_2d, fsr_params, rho, sigma_n_a, extrapolated_block_2d);
-
-                // update image and mask
-                extrapolated_block_2d(Range(top_border, extrapolated_block_2d.rows - bottom_border), Range(left_border, extrapolated_block_2d.cols - right_border)).copyTo(reconstructed_img(Range(yblock_counter*block_size, std::min(img_height, (yblock_counter + 1)*block_size)), Range(xblock_counter*block_size, std::min(img_width, (xblock_counter + 1)*block_size))));
-
-                Mat signs;
-                icvSgnMat(error_mask_2d(Range(top_border, error_mask_2d.rows - bottom_border), Range(left_border, error_mask_2d.cols - right_border)), signs);
-                Mat tmp_mask = error_mask_2d(Range(top_border, error_mask_2d.rows - bottom_border), Range(left_border, error_mask_2d.cols - right_border)) + (1 - signs) *conc_weighting;
-                tmp_mask.copyTo(sampling_mask(Range(yblock_counter*block_size, std::min(img_height, (yblock_counter + 1)*block_size)), Range(xblock_counter*block_size, std::min(img_width, (xblock_counter + 1)*block_size))));
+            for (size_t wave = 0; wave < waves.size(); ++wave)
+            {
+                const std::vector<int>& wave_blocks = waves[wave];
+                parallel_for_(Range(0, (int)wave_blocks.size()), [&](const Range& range)
+                {
+                    for (int i = range.start; i < range.end; ++i)
+                    {
+                        int yblock_counter = std::get<0>(block_list[wave_blocks[i]]);
+                        int xblock_counter = std::get<1>(block_list[wave_blocks[i]]);
+
+                        // calculation of the extrapolation area's borders
+                        int left_border = std::min(xblock_counter*block_size, border_width);
+                        int top_border = std::min(yblock_counter*block_size, border_width);
+                        int right_border = std::max(0, std::min(img_width - (xblock_counter + 1)*block_size, border_width));
+                        int bottom_border = std::max(0, std::min(img_height - (yblock_counter + 1)*block_size, border_width));
+
+                        // extract blocks from images
+                        Mat distorted_block_2d = reconstructed_img(Range(yblock_counter*block_size - top_border, std::min(img_height, (yblock_counter*block_size + block_size + bottom_border))), Range(xblock_counter*block_size - left_border, std::min(img_width, (xblock_counter*block_size + block_size + right_border))));
+                        Mat error_mask_2d = sampling_mask(Range(yblock_counter*block_size - top_border, std::min(img_height, (yblock_counter*block_size + block_size + bottom_border))), Range(xblock_counter*block_size - left_border, std::min(img_width, xblock_counter*block_size + block_size + right_border)));
+                        // get actual stddev value as it is needed to estimate the
+                        // best number of iterations
+                        double sigma_n_a = sigma_n_array.at<double>(yblock_counter, xblock_counter);
+
+                        // actual extrapolation
+                        Mat extrapolated_block_2d;
+                        icvExtrapolateBlock(distorted_block_2d, error_mask_2d, fsr_params, frequency_weighting, rho, sigma_n_a, extrapolated_block_2d);
+
+                        // update image and mask
+                        extrapolated_block_2d(Range(top_border, extrapolated_block_2d.rows - bottom_border), Range(left_border, extrapolated_block_2d.cols - right_border)).copyTo(reconstructed_img(Range(yblock_counter*block_size, std::min(img_height, (yblock_counter + 1)*block_size)), Range(xblock_counter*block_size, std::min(img_width, (xblock_counter + 1)*block_size))));
+
+                        Mat signs;
+                        icvSgnMat(error_mask_2d(Range(top_border, error_mask_2d.rows - bottom_border), Range(left_border, error_mask_2d.cols - right_border)), signs);
+                        Mat tmp_mask = error_mask_2d(Range(top_border, error_mask_2d.rows - bottom_border), Range(left_border, error_mask_2d.cols - right_border)) + (1 - signs) *conc_weighting;
+                        tmp_mask.copyTo(sampling_mask(Range(yblock_counter*block_size, std::min(img_height, (yblock_counter + 1)*block_size)), Range(xblock_counter*block_size, std::min(img_width, (xblock_counter + 1)*block_size))));
+                    }
+                });
+            }
+
+            for (bl_counter = 0; bl_counter < max_bl_counter; ++bl_counter)
+            {
+                int yblock_counter = std::get<0>(block_list[bl_counter]);
+                int xblock_counter = std::get<1>(block_list[bl_counter]);
 
                 // update nen-array
                 nen_array.at<double>(yblock_counter, xblock_counter) = -1;
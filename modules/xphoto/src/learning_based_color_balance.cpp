@@ -46,6 +46,9 @@
 using namespace std;
 #define EPS 0.00001f
 
+// distance between the average chromaticities of two images above which they are of different scenes
+static const float scene_change_thresh = 0.02f;
+
 namespace cv
 {
 namespace xphoto
@@ -78,6 +81,15 @@ class LearningBasedWBImpl : public LearningBasedWB
     Mat mask;
     int src_max_val;
 
+    // video mode: the last illuminant is kept for feature_update_interval images unless the scene changes
+    int subsampling_step, feature_update_interval;
+    float temporal_smoothing;
+    Vec3f last_gains;
+    Vec2f last_illuminant, last_mean_chromaticity;
+    int frames_since_update;
+    Size last_size;
+    int last_type;
+
     void preprocessing(Mat &src);
     void getAverageAndBrightestColorChromaticity(Vec2f &average_chromaticity, Vec2f &brightest_chromaticity, Mat &src);
     void getColorPaletteMode(Vec2f &dst, hist_elem *palette);
@@ -95,6 +107,11 @@ class LearningBasedWBImpl : public LearningBasedWB
         palette_size = 300;
         palette_bandwidth = 0.1f;
         prediction_thresh = 0.025f;
+        subsampling_step = 1;
+        feature_update_interval = 1;
+        temporal_smoothing = 0.f;
+        frames_since_update = 0;
+        last_type = -1;
         /* try to load model from file */
         FileStorage fs;
         if (!path_to_model.empty() && fs.open(path_to_model, FileStorage::READ))
@@ -135,6 +152,27 @@ class LearningBasedWBImpl : public LearningBasedWB
     int getHistBinNum() const CV_OVERRIDE { return hist_bin_num; }
     void setHistBinNum(int val) CV_OVERRIDE { hist_bin_num = val; }
 
+    int getSubsamplingStep() const CV_OVERRIDE { return subsampling_step; }
+    void setSubsamplingStep(int val) CV_OVERRIDE
+    {
+        CV_Assert(val > 0);
+        subsampling_step = val;
+    }
+
+    float getTemporalSmoothing() const CV_OVERRIDE { return temporal_smoothing; }
+    void setTemporalSmoothing(float val) CV_OVERRIDE
+    {
+        CV_Assert(val >= 0.f && val < 1.f);
+        temporal_smoothing = val;
+    }
+
+    int getFeatureUpdateInterval() const CV_OVERRIDE { return feature_update_interval; }
+    void setFeatureUpdateInterval(int val) CV_OVERRIDE
+    {
+        CV_Assert(val > 0);
+        feature_update_interval = val;
+    }
+
     void extractSimpleFeatures(InputArray _src, OutputArray _dst) CV_OVERRIDE
     {
         CV_Assert(!_src.empty());
@@ -156,15 +194,46 @@ class LearningBasedWBImpl : public LearningBasedWB
         CV_Assert(_src.type() == CV_8UC3 || _src.type() == CV_16UC3);
         Mat src = _src.getMat();
 
-        vector<Vec2f> features;
-        extractSimpleFeatures(src, features);
-        Vec2f illuminant = predictIlluminant(features);
+        // Features on a grid of pixels
+        Mat stats = src;
+        if (subsampling_step > 1)
+            resize(src, stats, Size(), 1.0 / subsampling_step, 1.0 / subsampling_step, INTER_NEAREST);
+
+        const bool same_stream = last_size == src.size() && last_type == src.type();
+        Vec2f illuminant = last_illuminant;
+        bool update = !same_stream || ++frames_since_update >= feature_update_interval;
+        Vec2f mean_chromaticity;
+        if (!update || feature_update_interval > 1)
+        {
+            // a scene change moves the average chromaticity, the illuminant is predicted again then
+            Scalar m = mean(stats);
+            getChromaticity(mean_chromaticity, (float)m[2], (float)m[1], (float)m[0]);
+            update = update || norm(mean_chromaticity - last_mean_chromaticity) > scene_change_thresh;
+        }
+        if (update)
+        {
+            vector<Vec2f> features;
+            extractSimpleFeatures(stats, features);
+            illuminant = predictIlluminant(features);
+            last_illuminant = illuminant;
+            last_mean_chromaticity = mean_chromaticity;
+            frames_since_update = 0;
+        }
 
         float denom = 1 - illuminant[0] - illuminant[1];
-        float gainB = 1.0f;
-        float gainG = denom / illuminant[1];
-        float gainR = denom / illuminant[0];
-        applyChannelGains(src, _dst, gainB, gainG, gainR);
+        Vec3f gains(1.0f, denom / illuminant[1], denom / illuminant[0]);
+
+        // Smooth the gains over the frames of a video, on the scale applyChannelGains uses
+        float gain_max = max(gains[0], max(gains[1], gains[2]));
+        if (gain_max > 0)
+            gains /= gain_max;
+        if (temporal_smoothing > 0.f && same_stream)
+            gains = temporal_smoothing * last_gains + (1.f - temporal_smoothing) * gains;
+        last_gains = gains;
+        last_size = src.size();
+        last_type = src.type();
+
+        applyChannelGains(src, _dst, gains[0], gains[1], gains[2]);
     }
 };
 
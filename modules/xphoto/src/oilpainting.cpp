@@ -56,71 +56,52 @@ private:
     Mat &imgLuminance;
     int halfsize;
     int dynRatio;
+    int levels;
+
+    // adds sign times the pixels of the column x between the rows y0 and y1 to the histogram
+    void updateColumn(std::vector<int> &histogram, std::vector<Vec3f> &meanBGR, int x, int y0, int y1, int sign) const
+    {
+        for (int yy = y0; yy <= y1; yy++)
+        {
+            const uchar l = imgLuminance.ptr(yy)[x];
+            histogram[l] += sign;
+            meanBGR[l] += sign * Vec3fTo<Type>(imgSrc.ptr<Type>(yy)[x]).make(dynRatio);
+        }
+    }
 
 public:
-    ParallelOilPainting<Type>(Mat& img, Mat &d, Mat &iLuminance, int r,int k) :
+    ParallelOilPainting<Type>(Mat& img, Mat &d, Mat &iLuminance, int r,int k, int l) :
         imgSrc(img),
         dst(d),
         imgLuminance(iLuminance),
         halfsize(r),
-        dynRatio(k)
+        dynRatio(k),
+        levels(l)
     {}
     virtual void operator()(const Range& range) const CV_OVERRIDE
     {
-        std::vector<int> histogram(256);
-        std::vector<Vec3f> meanBGR(256);
+        // only the levels of the quantized luminance are counted
+        std::vector<int> histogram(levels);
+        std::vector<Vec3f> meanBGR(levels);
 
         for (int y = range.start; y < range.end; y++)
         {
+            const int y0 = std::max(y - halfsize, 0), y1 = std::min(y + halfsize, imgSrc.rows - 1);
+            histogram.assign(levels, 0);
+            meanBGR.assign(levels, Vec3f(0, 0, 0));
+            for (int x = 0; x <= std::min(halfsize, imgSrc.cols - 1); x++)
+                updateColumn(histogram, meanBGR, x, y0, y1, 1);
+
             Type *vDst = dst.ptr<Type>(y);
             for (int x = 0; x < imgSrc.cols; x++, vDst++)
             {
-                if (x == 0)
-                {
-                    histogram.assign(256, 0);
-                    meanBGR.assign(256, Vec3f(0,0,0));
-                    for (int yy = -halfsize; yy <= halfsize; yy++)
-                    {
-                        if (y + yy >= 0 && y + yy < imgSrc.rows)
-                        {
-                            Type *vPtr = imgSrc.ptr<Type>(y + yy) + x - 0;
-                            uchar *uc = imgLuminance.ptr(y + yy) + x - 0;
-                            for (int xx = 0; xx <= halfsize; xx++, vPtr++, uc++)
-                            {
-                                if (x + xx >= 0 && x + xx < imgSrc.cols)
-                                {
-                                    histogram[*uc]++;
-                                    meanBGR[*uc] += Vec3fTo<Type>(*vPtr).make(dynRatio);
-                                }
-                            }
-                        }
-                    }
-
-                }
-                else
+                // the window slides along the row by a column
+                if (x > 0)
                 {
-                    for (int yy = -halfsize; yy <= halfsize; yy++)
-                    {
-                        if (y + yy >= 0 && y + yy < imgSrc.rows)
-                        {
-                            Type *vPtr = imgSrc.ptr<Type>(y + yy) + x - halfsize - 1;
-                            uchar *uc = imgLuminance.ptr(y + yy) + x - halfsize - 1;
-                            int xx = -halfsize - 1;
-                            if (x + xx >= 0 && x + xx < imgSrc.cols)
-                            {
-                                histogram[*uc]--;
-                                meanBGR[*uc] -= Vec3fTo<Type>(*vPtr).make(dynRatio);
-                            }
-                            vPtr = imgSrc.ptr<Type>(y + yy) + x + halfsize;
-                            uc = imgLuminance.ptr(y + yy) + x + halfsize;
-                            xx = halfsize;
-                            if (x + xx >= 0 && x + xx < imgSrc.cols)
-                            {
-                                histogram[*uc]++;
-                                meanBGR[*uc] += Vec3fTo<Type>(*vPtr).make(dynRatio);
-                            }
-                        }
-                    }
+                    if (x - halfsize - 1 >= 0)
+                        updateColumn(histogram, meanBGR, x - halfsize - 1, y0, y1, -1);
+                    if (x + halfsize < imgSrc.cols)
+                        updateColumn(histogram, meanBGR, x + halfsize, y0, y1, 1);
                 }
                 auto pos = distance(histogram.begin(), std::max_element(histogram.begin(), histogram.end()));
                 *vDst = Vec3fTo<Type>(meanBGR[pos] / histogram[pos]).extract();
@@ -155,18 +136,18 @@ void oilPainting(InputArray _src, OutputArray _dst, int size, int dynValue,int c
         lum = src.clone();
     double dratio = 1 / double(dynValue);
     lum.forEach<uchar>([=](uchar &pixel, const int * /*position*/) { pixel = saturate_cast<uchar>(cvRound(pixel * dratio)); });
+    const int levels = cvRound(255 * dratio) + 1;
     if (_src.type() == CV_8UC1)
     {
-        ParallelOilPainting<uchar> oilAlgo(src, dst, lum, size, dynValue);
+        ParallelOilPainting<uchar> oilAlgo(src, dst, lum, size, dynValue, levels);
         parallel_for_(Range(0, src.rows), oilAlgo);
     }
     else
     {
-        ParallelOilPainting<Vec3b> oilAlgo(src, dst, lum, size, dynValue);
+        ParallelOilPainting<Vec3b> oilAlgo(src, dst, lum, size, dynValue, levels);
         parallel_for_(Range(0, src.rows), oilAlgo);
     }
     dst.copyTo(_dst);
-    dst = (dst  / dynValue) * dynValue;
 }
 }
 }
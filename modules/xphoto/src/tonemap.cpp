@@ -30,6 +30,88 @@ void log_(const Mat& src, Mat& dst)
     log(dst, dst);
 }
 
+// blurs the cells of the grid along one of its axes with the binomial kernel of a unit sigma,
+// len is the number of cells along the axis and step the distance between two of them
+static void blurGridAxis(const std::vector<Vec2f>& src, std::vector<Vec2f>& dst, int len, int step)
+{
+    static const float kernel[] = { 1.f / 16, 4.f / 16, 6.f / 16, 4.f / 16, 1.f / 16 };
+    const int total = (int)src.size();
+    parallel_for_(Range(0, total), [&](const Range& range)
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            const int c = (i / step) % len;
+            Vec2f sum(0.f, 0.f);
+            for (int k = -2; k <= 2; k++)
+                if (c + k >= 0 && c + k < len)
+                    sum += kernel[k + 2] * src[i + k * step];
+            dst[i] = sum;
+        }
+    }, std::max(1., total / 65536.));
+}
+
+// bilateral filter of a single channel float image on a bilateral grid, see @cite PD06
+static void bilateralGrid(const Mat& src, Mat& dst, float sigma_color, float sigma_space)
+{
+    CV_Assert(src.type() == CV_32FC1);
+    double min_val, max_val;
+    minMaxLoc(src, &min_val, &max_val);
+
+    // a cell per sigma, the padding keeps the blurred weights of the border cells inside of the grid
+    const float ss = std::max(sigma_space, 1.f), sr = std::max(sigma_color, 1e-3f);
+    const float inv_ss = 1.f / ss, inv_sr = 1.f / sr;
+    const int pad = 2;
+    const int gx = cvFloor((src.cols - 1) * inv_ss) + 1 + 2 * pad;
+    const int gy = cvFloor((src.rows - 1) * inv_ss) + 1 + 2 * pad;
+    const int gz = cvFloor((float)(max_val - min_val) * inv_sr) + 1 + 2 * pad;
+    const float offset = (float)min_val;
+
+    // homogeneous sums of the values and the weights of the cells, the index is (z * gy + y) * gx + x
+    std::vector<Vec2f> grid((size_t)gx * gy * gz, Vec2f(0.f, 0.f)), buf(grid.size());
+    for (int y = 0; y < src.rows; y++)
+    {
+        const float* s = src.ptr<float>(y);
+        const int iy = cvRound(y * inv_ss) + pad;
+        for (int x = 0; x < src.cols; x++)
+        {
+            const int ix = cvRound(x * inv_ss) + pad;
+            const int iz = cvRound((s[x] - offset) * inv_sr) + pad;
+            grid[((size_t)iz * gy + iy) * gx + ix] += Vec2f(s[x], 1.f);
+        }
+    }
+
+    blurGridAxis(grid, buf, gx, 1);
+    blurGridAxis(buf, grid, gy, gx);
+    blurGridAxis(grid, buf, gz, gx * gy);
+
+    // trilinear interpolation of the grid at the pixels
+    dst.create(src.size(), CV_32FC1);
+    parallel_for_(Range(0, src.rows), [&](const Range& range)
+    {
+        for (int y = range.start; y < range.end; y++)
+        {
+            const float* s = src.ptr<float>(y);
+            float* d = dst.ptr<float>(y);
+            const float fy = y * inv_ss + pad;
+            const int y0 = std::min(cvFloor(fy), gy - 2);
+            const float wy = fy - y0;
+            for (int x = 0; x < src.cols; x++)
+            {
+                const float fx = x * inv_ss + pad, fz = (s[x] - offset) * inv_sr + pad;
+                const int x0 = std::min(cvFloor(fx), gx - 2), z0 = std::min(cvFloor(fz), gz - 2);
+                const float wx = fx - x0, wz = fz - z0;
+                const Vec2f* c = &buf[((size_t)z0 * gy + y0) * gx + x0];
+                const size_t sy = gx, sz = (size_t)gx * gy;
+                Vec2f v = (1.f - wz) * ((1.f - wy) * ((1.f - wx) * c[0] + wx * c[1]) +
+                                        wy * ((1.f - wx) * c[sy] + wx * c[sy + 1])) +
+                          wz * ((1.f - wy) * ((1.f - wx) * c[sz] + wx * c[sz + 1]) +
+                                wy * ((1.f - wx) * c[sz + sy] + wx * c[sz + sy + 1]));
+                d[x] = v[1] > 0.f ? v[0] / v[1] : s[x];
+            }
+        }
+    });
+}
+
 class TonemapDurandImpl CV_FINAL : public TonemapDurand
 {
 public:
@@ -39,7 +121,8 @@ public:
         contrast(_contrast),
         saturation(_saturation),
         sigma_color(_sigma_color),
-        sigma_space(_sigma_space)
+        sigma_space(_sigma_space),
+        use_bilateral_grid(false)
     {
     }
 
@@ -59,7 +142,10 @@ public:
         Mat log_img;
         log_(gray_img, log_img);
         Mat map_img;
-        bilateralFilter(log_img, map_img, -1, sigma_color, sigma_space);
+        if (use_bilateral_grid)
+            bilateralGrid(log_img, map_img, sigma_color, sigma_space);
+        else
+            bilateralFilter(log_img, map_img, -1, sigma_color, sigma_space);
 
         double min, max;
         minMaxLoc(map_img, &min, &max);
@@ -86,6 +172,9 @@ public:
     float getSigmaSpace() const CV_OVERRIDE { return sigma_space; }
     void setSigmaSpace(float val) CV_OVERRIDE { sigma_space = val; }
 
+    bool getUseBilateralGrid() const CV_OVERRIDE { return use_bilateral_grid; }
+    void setUseBilateralGrid(bool val) CV_OVERRIDE { use_bilateral_grid = val; }
+
     void write(FileStorage& fs) const CV_OVERRIDE
     {
         writeFormat(fs);
@@ -94,7 +183,8 @@ public:
            << "contrast" << contrast
            << "sigma_color" << sigma_color
            << "sigma_space" << sigma_space
-           << "saturation" << saturation;
+           << "saturation" << saturation
+           << "use_bilateral_grid" << (int)use_bilateral_grid;
     }
 
     void read(const FileNode& fn) CV_OVERRIDE
@@ -106,11 +196,13 @@ public:
         sigma_color = fn["sigma_color"];
         sigma_space = fn["sigma_space"];
         saturation = fn["saturation"];
+        use_bilateral_grid = (int)fn["use_bilateral_grid"] != 0;
     }
 
 protected:
     String name;
     float gamma, contrast, saturation, sigma_color, sigma_space;
+    bool use_bilateral_grid;
 };
 
 Ptr<TonemapDurand> createTonemapDurand(float gamma, float contrast, float saturation, float sigma_color, float sigma_space)
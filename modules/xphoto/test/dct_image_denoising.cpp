@@ -38,5 +38,19 @@ namespace opencv_test { namespace {
         }
     }
 
+    TEST(xphoto_dctimagedenoising, strided)
+    {
+        cv::String dir = cvtest::TS::ptr()->get_data_path() + "cv/xphoto/dct_image_denoising/";
+        cv::Mat src = cv::imread( dir + "sources/01.png", 1 );
+        ASSERT_TRUE(!src.empty());
+
+        cv::Mat dense, strided;
+        cv::xphoto::dctDenoising(src, dense, 9.0, 8);
+        cv::xphoto::dctDenoising(src, strided, 9.0, 8, 2);
+
+        ASSERT_EQ(strided.size(), src.size());
+        EXPECT_GT( cv::PSNR(dense, strided), 30.0 );
+    }
+
 
 }} // namespace
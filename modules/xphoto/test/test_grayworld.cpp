@@ -95,5 +95,50 @@ namespace opencv_test { namespace {
         }
     }
 
+    TEST(xphoto_grayworld_white_balance, video_mode)
+    {
+        String dir = cvtest::TS::ptr()->get_data_path() + "cv/xphoto/simple_white_balance/";
+        Mat src1 = imread(dir + "sources/01.png", IMREAD_COLOR);
+        Mat src2 = imread(dir + "sources/02.png", IMREAD_COLOR);
+        ASSERT_TRUE(!src1.empty() && !src2.empty());
+        resize(src2, src2, src1.size());
+
+        Ptr<xphoto::GrayworldWB> wb = xphoto::createGrayworldWB();
+        Mat reference, result;
+        wb->balanceWhite(src2, reference);
+
+        // the subsampled statistics are close to the exact ones
+        wb->setSubsamplingStep(2);
+        wb->balanceWhite(src2, result);
+        EXPECT_LE(cv::norm(result, reference, NORM_INF), 4.);
+
+        // the smoothed gains move from the ones of the previous frame towards the ones of the current frame
+        wb->setSubsamplingStep(1);
+        wb->setTemporalSmoothing(0.5f);
+        Mat previous;
+        wb->balanceWhite(src1, previous);
+        for (int i = 0; i < 20; i++)
+            wb->balanceWhite(src2, result);
+        EXPECT_LE(cv::norm(result, reference, NORM_INF), 2.);
+    }
+
+    TEST(xphoto_grayworld_white_balance, gains_with_gamma)
+    {
+        String dir = cvtest::TS::ptr()->get_data_path() + "cv/xphoto/simple_white_balance/";
+        Mat src = imread(dir + "sources/01.png", IMREAD_COLOR);
+        ASSERT_TRUE(!src.empty());
+
+        Mat reference, result;
+        xphoto::applyChannelGains(src, reference, 0.8f, 1.f, 0.6f);
+        xphoto::applyChannelGains(src, result, 0.8f, 1.f, 0.6f, 1.f);
+        EXPECT_LE(cv::norm(result, reference, NORM_INF), 1.);
+
+        Mat src_16U, result_16U;
+        src.convertTo(src_16U, CV_16UC3, 256.0);
+        xphoto::applyChannelGains(src_16U, result_16U, 0.8f, 1.f, 0.6f, 2.2f);
+        xphoto::applyChannelGains(src, result, 0.8f, 1.f, 0.6f, 2.2f);
+        result_16U.convertTo(result_16U, CV_8UC3, 1/256.0);
+        EXPECT_LE(cv::norm(result_16U, result, NORM_INF), 2.);
+    }
 
 }} // namespace
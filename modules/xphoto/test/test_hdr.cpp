@@ -38,6 +38,22 @@ TEST(Photo_Tonemap, Durand_regression)
     checkEqual(result, expected, 3, "Durand");
 }
 
+TEST(Photo_Tonemap, Durand_bilateral_grid)
+{
+    string test_path = string(cvtest::TS::ptr()->get_data_path()) + "cv/hdr/tonemap/";
+
+    Mat img, expected, result;
+    loadImage(test_path + "image.hdr", img);
+    float gamma = 2.2f;
+
+    Ptr<TonemapDurand> durand = createTonemapDurand(gamma);
+    durand->setUseBilateralGrid(true);
+    durand->process(img, result);
+    loadImage(test_path + "durand.png", expected);
+    result.convertTo(result, CV_8UC3, 255);
+    EXPECT_GT(cvtest::PSNR(result, expected), 30.);
+}
+
 TEST(Photo_Tonemap, Durand_property_regression)
 {
     const float gamma = 1.0f;